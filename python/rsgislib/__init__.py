@@ -87,6 +87,21 @@ Constants specifying how bands should be treated when sharpening
     * SHARP_RES_LOW = 1
     * SHARP_RES_HIGH = 2
 
+Types of spectral index (see rsgislib.imagecalc.calc_spectral_indices)
+
+    * SPECIDX_NORMDIFF = 0
+    * SPECIDX_RATIO = 1
+    * SPECIDX_EVI = 2
+    * SPECIDX_EVI2 = 3
+    * SPECIDX_EXP = 4
+
+Methods for finding the proportion of valid pixels in an image
+(see rsgislib.imageutils.order_img_using_prop_valid_pxls)
+
+    * VLD_PXL_EST_FULL = 0
+    * VLD_PXL_EST_OVERVIEW = 1
+    * VLD_PXL_EST_SAMPLE = 2
+
 Options for interpolating raster data:
 
     * INTERP_NEAREST_NEIGHBOUR = 0
@@ -236,6 +251,16 @@ SHARP_RES_IGNORE = 0
 SHARP_RES_LOW = 1
 SHARP_RES_HIGH = 2
 
+SPECIDX_NORMDIFF = 0
+SPECIDX_RATIO = 1
+SPECIDX_EVI = 2
+SPECIDX_EVI2 = 3
+SPECIDX_EXP = 4
+
+VLD_PXL_EST_FULL = 0
+VLD_PXL_EST_OVERVIEW = 1
+VLD_PXL_EST_SAMPLE = 2
+
 INTERP_NEAREST_NEIGHBOUR = 0
 INTERP_BILINEAR = 1
 INTERP_CUBIC = 2
@@ -292,6 +317,45 @@ STATS_CORR_POINT_BISERIAL = 4  # pointbiserialr
 LOGIC_AND = 1
 LOGIC_OR = 2
 
+# The submodules are imported on first attribute access (e.g.
+# rsgislib.imageutils.set_env_vars_lzw_gtiff_outs()) so a short task only
+# loads the C++ extensions it actually uses.
+_LAZY_SUBMODULES = (
+    "changedetect",
+    "classification",
+    "dataaccess",
+    "droneutils",
+    "elevation",
+    "imagecalc",
+    "imagecalibration",
+    "imagefilter",
+    "imagemorphology",
+    "imageregistration",
+    "imageutils",
+    "rastergis",
+    "regression",
+    "segmentation",
+    "timeseries",
+    "tools",
+    "vectorattrs",
+    "vectorgeoms",
+    "vectorstats",
+    "vectorutils",
+    "zonalstats",
+)
+
+
+def __getattr__(name: str):
+    if name in _LAZY_SUBMODULES:
+        import importlib
+
+        return importlib.import_module("rsgislib." + name)
+    raise AttributeError("module 'rsgislib' has no attribute '{}'".format(name))
+
+
+def __dir__():
+    return sorted(set(globals()) | set(_LAZY_SUBMODULES))
+
 
 def get_install_base_path() -> pathlib.PurePath:
     """
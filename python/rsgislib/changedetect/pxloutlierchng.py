@@ -542,3 +542,69 @@ def find_class_li_outliers(
         )
 
     return chng_thres
+
+
+def find_pxl_temporal_outliers(
+    input_imgs: List[str],
+    output_img: str,
+    threshold: float = 3.5,
+    min_obs: int = 3,
+    img_band: int = 1,
+    img_val_no_data: float = None,
+    out_scores: bool = False,
+    gdalformat: str = "KEA",
+    n_threads: int = 1,
+):
+    """
+    A function to find per-pixel outliers (changes) within a time series. For each
+    pixel the median and median absolute deviation (MAD) of the valid values across
+    the time series are calculated and each time step is given the robust z-score
+    abs(x - median) / (1.4826 * MAD). Time steps with a score above the threshold
+    are identified as changes. The calculation is performed in a single pass over
+    the images using rsgislib.imagecalc.calc_temporal_outlier_chng.
+
+    :param input_imgs: list of input images. If a single image is provided then its
+                       bands are the time series, otherwise img_band from each of the
+                       images (in the order of the list) is used.
+    :param output_img: output image with a band for each time step with pixel values
+                       of 1 for not outlier and 2 for outlier (0 is no data).
+    :param threshold: the robust z-score above which a value is an outlier.
+                      (Default: 3.5)
+    :param min_obs: the minimum number of valid observations for a pixel to be
+                    tested. (Default: 3)
+    :param img_band: the image band used when multiple input images are provided.
+    :param img_val_no_data: the input image no data value. If None then the value
+                            will be read from the header of the first image.
+    :param out_scores: if True, the output image is the robust z-scores (-1 is
+                       no data) rather than the outlier classes. (Default: False)
+    :param gdalformat: the output image file format. (Default: KEA)
+    :param n_threads: the number of threads used for the calculation. (Default: 1)
+
+    """
+    if img_val_no_data is None:
+        img_val_no_data = rsgislib.imageutils.get_img_no_data_value(input_imgs[0])
+    use_no_data = img_val_no_data is not None
+    if not use_no_data:
+        img_val_no_data = 0
+
+    rsgislib.imagecalc.calc_temporal_outlier_chng(
+        input_imgs,
+        output_img,
+        gdalformat=gdalformat,
+        img_band=img_band,
+        threshold=threshold,
+        min_obs=min_obs,
+        no_data_val=img_val_no_data,
+        use_no_data=use_no_data,
+        out_scores=out_scores,
+        n_threads=n_threads,
+    )
+
+    if out_scores:
+        rsgislib.imageutils.pop_img_stats(
+            output_img, use_no_data=True, no_data_val=-1, calc_pyramids=True
+        )
+    else:
+        rsgislib.imageutils.pop_thmt_img_stats(
+            output_img, add_clr_tab=True, calc_pyramids=True, ignore_zero=True
+        )
@@ -736,6 +736,87 @@ def calc_acc_metrics_vecsamples_img(
     return acc_metrics
 
 
+def calc_acc_metrics_ref_img(
+    cls_img: str,
+    ref_img: str,
+    cls_ids: List[int] = None,
+    cls_no_data: float = None,
+    ref_no_data: float = None,
+    strata_img: str = None,
+    strata_weights: Dict[int, float] = None,
+    out_json_file: str = None,
+) -> Dict:
+    """
+    A function which calculates the confusion matrix and the area adjusted accuracy
+    metrics (Olofsson et al., 2014) for a classification image against a wall-to-wall
+    reference image. The images are compared in a single (multi-threaded) pass
+    rather than by sampling points.
+
+    :param cls_img: the single band classification image.
+    :param ref_img: the single band reference image, using the same class ids as
+                    the classification.
+    :param cls_ids: the list of class ids to be assessed. If None then the unique
+                    values within the two images (excluding the no data values)
+                    are used.
+    :param cls_no_data: the no data value of the classification (Default: None)
+    :param ref_no_data: the no data value of the reference (Default: None). The
+                        mapped area of each class is still counted where the
+                        reference is no data.
+    :param strata_img: an optional single band image of strata used to weight
+                       the pixels within the confusion matrix.
+    :param strata_weights: a dict of stratum id: weight. Required if strata_img
+                           is provided.
+    :param out_json_file: if specified the generated metrics and confusion matrix
+                          are written to a JSON file (Default=None).
+    :return: dict (matching JSON output) with the classification accuracy stats
+
+    """
+    import rsgislib.classification
+    import rsgislib.imagecalc
+    import rsgislib.imageutils
+
+    if cls_ids is None:
+        unq_vals = numpy.union1d(
+            rsgislib.imagecalc.get_unique_values(cls_img, img_band=1),
+            rsgislib.imagecalc.get_unique_values(ref_img, img_band=1),
+        )
+        no_data_vals = [val for val in [cls_no_data, ref_no_data] if val is not None]
+        unq_vals = unq_vals[numpy.isin(unq_vals, no_data_vals, invert=True)]
+        cls_ids = [int(val) for val in unq_vals]
+
+    acc_metrics = rsgislib.classification.calc_img_confusion_matrix(
+        cls_img,
+        ref_img,
+        cls_ids,
+        cls_no_data=cls_no_data,
+        ref_no_data=ref_no_data,
+        strata_img=strata_img,
+        strata_weights=strata_weights,
+    )
+
+    pxl_size_x, pxl_size_y = rsgislib.imageutils.get_img_res(cls_img, abs_vals=True)
+    pxl_area = pxl_size_x * pxl_size_y
+    tot_area = sum(acc_metrics["mapped_pxl_counts"]) * pxl_area
+
+    # 95% confidence intervals.
+    conf_int_const = 1.96
+    acc_metrics["overall_accuracy_conf_interval"] = (
+        conf_int_const * acc_metrics["overall_accuracy_se"]
+    )
+    acc_metrics["est_cls_area"] = [
+        prop * tot_area for prop in acc_metrics["est_prop_cls_area"]
+    ]
+    acc_metrics["est_cls_area_conf_interval"] = [
+        conf_int_const * prop_se * tot_area
+        for prop_se in acc_metrics["est_prop_cls_area_se"]
+    ]
+
+    if out_json_file is not None:
+        rsgislib.tools.utils.write_dict_to_json(acc_metrics, out_json_file)
+
+    return acc_metrics
+
+
 def calc_acc_ptonly_metrics_vecsamples(
     vec_file: str,
     vec_lyr: str,
@@ -38,19 +38,12 @@ from __future__ import print_function
 import h5py
 import numpy
 from osgeo import gdal
-from rios import applier, cuiprogress, rat
+from rios import rat
 
 import rsgislib
+import rsgislib.classification
 import rsgislib.rastergis
 
-TQDM_AVAIL = True
-try:
-    import tqdm
-except ImportError:
-    import rios.cuiprogress
-
-    TQDM_AVAIL = False
-
 
 def train_keras_pixel_classifier(
     cls_mdl, cls_info_dict, out_mdl_file=None, train_epochs=5, train_batch_size=32
@@ -201,53 +194,6 @@ def apply_keras_pixel_classifier(
 
     """
 
-    def _applyKerasPxlClassifier(info, inputs, outputs, otherargs):
-        outClassIdVals = numpy.zeros_like(inputs.imageMask, dtype=numpy.uint16)
-        if numpy.any(inputs.imageMask == otherargs.mskVal):
-            n_pxls = inputs.imageMask.shape[1] * inputs.imageMask.shape[2]
-            outClassIdVals = outClassIdVals.flatten()
-            imgMaskVals = inputs.imageMask.flatten()
-            classVars = numpy.zeros(
-                (n_pxls, otherargs.numClassVars), dtype=numpy.float32
-            )
-            # Array index which can be used to populate the output array following masking etc.
-            ID = numpy.arange(imgMaskVals.shape[0])
-            classVarsIdx = 0
-            for imgFile in otherargs.imgFileInfo:
-                imgArr = inputs.__dict__[imgFile.name]
-                for band in imgFile.bands:
-                    classVars[..., classVarsIdx] = imgArr[(band - 1)].flatten()
-                    classVarsIdx = classVarsIdx + 1
-            classVars = classVars[imgMaskVals == otherargs.mskVal]
-            ID = ID[imgMaskVals == otherargs.mskVal]
-            preds_idxs = numpy.argmax(
-                otherargs.classifier.predict(
-                    classVars, batch_size=otherargs.pred_batch_size
-                ),
-                axis=1,
-            )
-            preds_cls_ids = numpy.zeros_like(preds_idxs, dtype=numpy.uint16)
-            for cld_id, idx in zip(
-                otherargs.cls_id_lut, numpy.arange(0, len(otherargs.cls_id_lut))
-            ):
-                preds_cls_ids[preds_idxs == idx] = cld_id
-
-            outClassIdVals[ID] = preds_cls_ids
-            outClassIdVals = numpy.expand_dims(
-                outClassIdVals.reshape(
-                    (inputs.imageMask.shape[1], inputs.imageMask.shape[2])
-                ),
-                axis=0,
-            )
-        outputs.outclsimage = outClassIdVals
-
-    infiles = applier.FilenameAssociations()
-    infiles.imageMask = in_img_mask
-    numClassVars = 0
-    for imgFile in img_file_info:
-        infiles.__dict__[imgFile.name] = imgFile.fileName
-        numClassVars = numClassVars + len(imgFile.bands)
-
     n_classes = len(class_train_info)
     cls_id_lut = numpy.zeros(n_classes)
     for clsname in class_train_info:
@@ -259,33 +205,25 @@ def apply_keras_pixel_classifier(
             )
         cls_id_lut[class_train_info[clsname].id] = class_train_info[clsname].out_id
 
-    outfiles = applier.FilenameAssociations()
-    outfiles.outclsimage = out_class_img
-    otherargs = applier.OtherInputs()
-    otherargs.classifier = keras_cls_mdl
-    otherargs.pred_batch_size = pred_batch_size
-    otherargs.mskVal = img_mask_val
-    otherargs.numClassVars = numClassVars
-    otherargs.imgFileInfo = img_file_info
-    otherargs.n_classes = n_classes
-    otherargs.cls_id_lut = cls_id_lut
-
-    if TQDM_AVAIL:
-        progress_bar = rsgislib.TQDMProgressBar()
-    else:
-        progress_bar = rios.cuiprogress.GDALProgressBar()
+    def _applyKerasPxlClassifier(classVars):
+        classVars = numpy.asarray(classVars)
+        preds_idxs = numpy.argmax(
+            keras_cls_mdl.predict(classVars, batch_size=pred_batch_size),
+            axis=1,
+        )
+        preds_cls_ids = numpy.zeros_like(preds_idxs, dtype=numpy.uint16)
+        for cld_id, idx in zip(cls_id_lut, numpy.arange(0, len(cls_id_lut))):
+            preds_cls_ids[preds_idxs == idx] = cld_id
+        return numpy.ascontiguousarray(preds_cls_ids, dtype=numpy.float32)
 
-    aControls = applier.ApplierControls()
-    aControls.progress = progress_bar
-    aControls.creationoptions = rsgislib.imageutils.get_rios_img_creation_opts(
-        gdalformat
-    )
-    aControls.drivername = gdalformat
-    aControls.omitPyramids = True
-    aControls.calcStats = False
     print("Applying the Classifier")
-    applier.apply(
-        _applyKerasPxlClassifier, infiles, outfiles, otherargs, controls=aControls
+    rsgislib.classification.apply_batch_predictor(
+        img_file_info,
+        in_img_mask,
+        img_mask_val,
+        _applyKerasPxlClassifier,
+        [(out_class_img, 1, rsgislib.TYPE_16UINT)],
+        gdalformat,
     )
     print("Completed Classification")
 
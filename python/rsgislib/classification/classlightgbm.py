@@ -42,7 +42,7 @@ from typing import List, Dict
 import h5py
 import numpy
 from osgeo import gdal
-from rios import applier, rat
+from rios import rat
 
 import rsgislib
 import rsgislib.imagecalc
@@ -57,14 +57,6 @@ try:
 except ImportError:
     HAVE_LIGHTGBM = False
 
-TQDM_AVAIL = True
-try:
-    import tqdm
-except ImportError:
-    import rios.cuiprogress
-
-    TQDM_AVAIL = False
-
 from sklearn.metrics import accuracy_score, roc_auc_score
 
 warnings.filterwarnings("ignore")
@@ -1275,67 +1267,21 @@ def apply_lightgbm_binary_classifier(
     if not HAVE_LIGHTGBM:
         raise rsgislib.RSGISPyException("Do not have lightgbm module installed.")
 
-    def _applyLGBMClassifier(info, inputs, outputs, otherargs):
-        out_class_vals = numpy.zeros_like(inputs.imageMask, dtype=numpy.uint16)
-        if numpy.any(inputs.imageMask == otherargs.mskVal):
-            out_class_vals = out_class_vals.flatten()
-            img_mask_vals = inputs.imageMask.flatten()
-            class_vars = numpy.zeros(
-                (out_class_vals.shape[0], otherargs.numClassVars), dtype=numpy.float32
-            )
-            # Array index which can be used to populate the output array following masking etc.
-            id_arr = numpy.arange(img_mask_vals.shape[0])
-            class_vars_idx = 0
-            for img_file in otherargs.imgFileInfo:
-                img_arr = inputs.__dict__[img_file.name]
-                for band in img_file.bands:
-                    class_vars[..., class_vars_idx] = img_arr[(band - 1)].flatten()
-                    class_vars_idx = class_vars_idx + 1
-            class_vars = class_vars[img_mask_vals == otherargs.mskVal]
-            id_arr = id_arr[img_mask_vals == otherargs.mskVal]
-            pred_class = numpy.around(otherargs.classifier.predict(class_vars) * 10000)
-            out_class_vals[id_arr] = pred_class
-            out_class_vals = numpy.expand_dims(
-                out_class_vals.reshape(
-                    (inputs.imageMask.shape[1], inputs.imageMask.shape[2])
-                ),
-                axis=0,
-            )
-        outputs.outimage = out_class_vals
-
     classifier = lgb.Booster(model_file=model_file)
 
-    infiles = applier.FilenameAssociations()
-    infiles.imageMask = in_msk_img
-    num_class_vars = 0
-    for imgFile in img_file_info:
-        infiles.__dict__[imgFile.name] = imgFile.file_name
-        num_class_vars = num_class_vars + len(imgFile.bands)
-
-    outfiles = applier.FilenameAssociations()
-    outfiles.outimage = out_score_img
-    otherargs = applier.OtherInputs()
-    otherargs.classifier = classifier
-    otherargs.mskVal = img_msk_val
-    otherargs.numClassVars = num_class_vars
-    otherargs.imgFileInfo = img_file_info
-
-    if TQDM_AVAIL:
-        progress_bar = rsgislib.TQDMProgressBar()
-    else:
-        progress_bar = rios.cuiprogress.GDALProgressBar()
+    def _applyLGBMClassifier(class_vars):
+        class_vars = numpy.asarray(class_vars)
+        pred_class = numpy.around(classifier.predict(class_vars) * 10000)
+        return numpy.ascontiguousarray(pred_class, dtype=numpy.float32)
 
-    aControls = applier.ApplierControls()
-    aControls.progress = progress_bar
-    aControls.creationoptions = rsgislib.imageutils.get_rios_img_creation_opts(
-        gdalformat
-    )
-    aControls.drivername = gdalformat
-    aControls.omitPyramids = True
-    aControls.calcStats = False
     print("Applying the Classifier")
-    applier.apply(
-        _applyLGBMClassifier, infiles, outfiles, otherargs, controls=aControls
+    rsgislib.classification.apply_batch_predictor(
+        img_file_info,
+        in_msk_img,
+        img_msk_val,
+        _applyLGBMClassifier,
+        [(out_score_img, 1, rsgislib.TYPE_16UINT)],
+        gdalformat,
     )
     print("Completed")
     rsgislib.imageutils.pop_img_stats(
@@ -2539,64 +2485,8 @@ def apply_lightgbm_multiclass_classifier(
     if not HAVE_LIGHTGBM:
         raise rsgislib.RSGISPyException("Do not have lightgbm module installed.")
 
-    def _applyLGMClassifier(info, inputs, outputs, otherargs):
-        out_class_vals = numpy.zeros(
-            (otherargs.n_classes, inputs.imageMask.shape[1], inputs.imageMask.shape[2]),
-            dtype=numpy.uint16,
-        )
-        out_class_id_vals = numpy.zeros_like(inputs.imageMask, dtype=numpy.uint16)
-        if numpy.any(inputs.imageMask == otherargs.mskVal):
-            n_pxls = inputs.imageMask.shape[1] * inputs.imageMask.shape[2]
-            out_class_vals = out_class_vals.reshape((n_pxls, otherargs.n_classes))
-            out_class_id_vals = out_class_id_vals.flatten()
-            img_mask_vals = inputs.imageMask.flatten()
-            class_vars = numpy.zeros(
-                (n_pxls, otherargs.numClassVars), dtype=numpy.float32
-            )
-            # Array index which can be used to populate the output array following masking etc.
-            id_arr = numpy.arange(img_mask_vals.shape[0])
-            class_vars_idx = 0
-            for img_file in otherargs.imgFileInfo:
-                img_arr = inputs.__dict__[img_file.name]
-                for band in img_file.bands:
-                    class_vars[..., class_vars_idx] = img_arr[(band - 1)].flatten()
-                    class_vars_idx = class_vars_idx + 1
-            class_vars = class_vars[img_mask_vals == otherargs.mskVal]
-            id_arr = id_arr[img_mask_vals == otherargs.mskVal]
-            pred_class_probs = numpy.around(
-                otherargs.classifier.predict(class_vars) * 10000
-            )
-            preds_idxs = numpy.argmax(pred_class_probs, axis=1)
-            if otherargs.n_classes != pred_class_probs.shape[1]:
-                raise rsgislib.RSGISPyException(
-                    "The number of classes expected and the number provided by the classifier do not match."
-                )
-            out_class_vals[id_arr] = pred_class_probs
-            preds_cls_ids = numpy.zeros_like(preds_idxs, dtype=numpy.uint16)
-            for cld_id, idx in zip(
-                otherargs.cls_id_lut, numpy.arange(0, len(otherargs.cls_id_lut))
-            ):
-                preds_cls_ids[preds_idxs == idx] = cld_id
-
-            out_class_id_vals[id_arr] = preds_cls_ids
-            out_class_id_vals = numpy.expand_dims(
-                out_class_id_vals.reshape(
-                    (inputs.imageMask.shape[1], inputs.imageMask.shape[2])
-                ),
-                axis=0,
-            )
-
-        outputs.outclsimage = out_class_id_vals
-
     classifier = lgb.Booster(model_file=model_file)
 
-    infiles = applier.FilenameAssociations()
-    infiles.imageMask = in_msk_img
-    num_class_vars = 0
-    for imgFile in img_file_info:
-        infiles.__dict__[imgFile.name] = imgFile.file_name
-        num_class_vars = num_class_vars + len(imgFile.bands)
-
     n_classes = len(cls_info_dict)
     cls_id_lut = numpy.zeros(n_classes)
     for cls_name in cls_info_dict:
@@ -2608,31 +2498,28 @@ def apply_lightgbm_multiclass_classifier(
             )
         cls_id_lut[cls_info_dict[cls_name].id] = cls_info_dict[cls_name].out_id
 
-    outfiles = applier.FilenameAssociations()
-    outfiles.outclsimage = out_class_img
-    otherargs = applier.OtherInputs()
-    otherargs.classifier = classifier
-    otherargs.mskVal = img_msk_val
-    otherargs.numClassVars = num_class_vars
-    otherargs.imgFileInfo = img_file_info
-    otherargs.n_classes = n_classes
-    otherargs.cls_id_lut = cls_id_lut
-
-    if TQDM_AVAIL:
-        progress_bar = rsgislib.TQDMProgressBar()
-    else:
-        progress_bar = rios.cuiprogress.GDALProgressBar()
+    def _applyLGMClassifier(class_vars):
+        class_vars = numpy.asarray(class_vars)
+        pred_class_probs = numpy.around(classifier.predict(class_vars) * 10000)
+        preds_idxs = numpy.argmax(pred_class_probs, axis=1)
+        if n_classes != pred_class_probs.shape[1]:
+            raise rsgislib.RSGISPyException(
+                "The number of classes expected and the number provided by the classifier do not match."
+            )
+        preds_cls_ids = numpy.zeros_like(preds_idxs, dtype=numpy.uint16)
+        for cld_id, idx in zip(cls_id_lut, numpy.arange(0, len(cls_id_lut))):
+            preds_cls_ids[preds_idxs == idx] = cld_id
+        return numpy.ascontiguousarray(preds_cls_ids, dtype=numpy.float32)
 
-    aControls = applier.ApplierControls()
-    aControls.progress = progress_bar
-    aControls.creationoptions = rsgislib.imageutils.get_rios_img_creation_opts(
-        gdalformat
-    )
-    aControls.drivername = gdalformat
-    aControls.omitPyramids = True
-    aControls.calcStats = False
     print("Applying the Classifier")
-    applier.apply(_applyLGMClassifier, infiles, outfiles, otherargs, controls=aControls)
+    rsgislib.classification.apply_batch_predictor(
+        img_file_info,
+        in_msk_img,
+        img_msk_val,
+        _applyLGMClassifier,
+        [(out_class_img, 1, rsgislib.TYPE_16UINT)],
+        gdalformat,
+    )
     print("Completed Classification")
 
     if class_clr_names:
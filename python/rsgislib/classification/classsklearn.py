@@ -38,7 +38,7 @@ from typing import Dict, List, Union
 import h5py
 import numpy
 from osgeo import gdal
-from rios import applier, rat, ratapplier
+from rios import rat
 from sklearn.base import BaseEstimator
 from sklearn.model_selection._search import BaseSearchCV
 
@@ -48,15 +48,6 @@ import rsgislib.imageutils
 import rsgislib.rastergis
 import rsgislib.classification
 
-TQDM_AVAIL = True
-try:
-    import tqdm
-except ImportError:
-    import rios.cuiprogress
-
-    TQDM_AVAIL = False
-
-
 def perform_sklearn_classifier_param_search(
     cls_train_info: Dict[str, rsgislib.classification.ClassInfoObj],
     search_obj: BaseSearchCV,
@@ -280,115 +271,39 @@ def apply_sklearn_classifier(
                 )
         cls_id_lut[cls_train_info[cls_name].id] = cls_train_info[cls_name].out_id
 
-    in_files = applier.FilenameAssociations()
-    in_files.image_mask = in_msk_img
-    num_class_vars = 0
-    for img_file in img_file_info:
-        in_files.__dict__[img_file.name] = img_file.file_name
-        num_class_vars = num_class_vars + len(img_file.bands)
-
-    outfiles = applier.FilenameAssociations()
-    outfiles.out_image = out_class_img
+    out_imgs = [(out_class_img, 1, rsgislib.TYPE_32UINT)]
     if create_out_score_img:
-        outfiles.out_score_img = out_score_img
-    otherargs = applier.OtherInputs()
-    otherargs.classifier = sk_classifier
-    otherargs.msk_val = img_msk_val
-    otherargs.num_class_vars = num_class_vars
-    otherargs.n_classes = n_classes
-    otherargs.img_file_info = img_file_info
-    otherargs.out_score_img = out_score_img
-    otherargs.cls_id_lut = cls_id_lut
-
-    if TQDM_AVAIL:
-        progress_bar = rsgislib.TQDMProgressBar()
-    else:
-        progress_bar = rios.cuiprogress.GDALProgressBar()
+        out_imgs.append((out_score_img, n_classes, rsgislib.TYPE_32FLOAT))
 
-    aControls = applier.ApplierControls()
-    aControls.progress = progress_bar
-    aControls.creationoptions = rsgislib.imageutils.get_rios_img_creation_opts(
-        gdalformat
-    )
-    aControls.drivername = gdalformat
-    aControls.omitPyramids = True
-    aControls.calcStats = False
-
-    # RIOS function to apply classifier
-    def _apply_sk_classifier(info, inputs, outputs, otherargs):
+    def _apply_sk_classifier(class_vars):
         """
-        Internal function for rios applier. Used within apply_sklearn_classifier.
+        Internal function for rsgislib.classification.apply_batch_predictor. Used
+        within apply_sklearn_classifier.
         """
-        out_class_vals = numpy.zeros_like(inputs.image_mask, dtype=numpy.uint32)
-
-        if otherargs.out_score_img:
-            out_score_vals = numpy.zeros(
-                (
-                    otherargs.n_classes,
-                    inputs.image_mask.shape[1],
-                    inputs.image_mask.shape[2],
-                ),
-                dtype=numpy.float32,
-            )
+        class_vars = numpy.asarray(class_vars)
 
-        if numpy.any(inputs.image_mask == otherargs.msk_val):
-            out_class_vals = out_class_vals.flatten()
-            if otherargs.out_score_img:
-                out_score_vals = out_score_vals.reshape(
-                    out_class_vals.shape[0], otherargs.n_classes
-                )
-            img_mask_vals = inputs.image_mask.flatten()
-            class_vars = numpy.zeros(
-                (out_class_vals.shape[0], otherargs.num_class_vars), dtype=numpy.float32
-            )
-            # Array index which can be used to populate the output
-            # array following masking etc.
-            pxl_id = numpy.arange(img_mask_vals.shape[0])
-            class_vars_idx = 0
-            for img_file in otherargs.img_file_info:
-                img_arr = inputs.__dict__[img_file.name]
-                for band in img_file.bands:
-                    class_vars[..., class_vars_idx] = img_arr[(band - 1)].flatten()
-                    class_vars_idx = class_vars_idx + 1
-            class_vars = class_vars[img_mask_vals == otherargs.msk_val]
-            pxl_id = pxl_id[img_mask_vals == otherargs.msk_val]
-
-            # Perform classification
-            preds_idxs = otherargs.classifier.predict(class_vars)
-
-            # Use the LUT to update the output class ids
-            preds_cls_ids = numpy.zeros_like(preds_idxs, dtype=numpy.uint16)
-            for cld_id, idx in zip(
-                otherargs.cls_id_lut, numpy.arange(0, otherargs.n_classes)
-            ):
-                preds_cls_ids[preds_idxs == idx] = cld_id
-
-            # Write the output classifiction to the output array.
-            out_class_vals[pxl_id] = preds_cls_ids
-            out_class_vals = numpy.expand_dims(
-                out_class_vals.reshape(
-                    (inputs.image_mask.shape[1], inputs.image_mask.shape[2])
-                ),
-                axis=0,
-            )
-            if otherargs.out_score_img:
-                pred_class_score = otherargs.classifier.predict_proba(class_vars)
-                out_score_vals[pxl_id] = pred_class_score
-                out_score_vals = out_score_vals.T
-                out_score_vals = out_score_vals.reshape(
-                    (
-                        otherargs.n_classes,
-                        inputs.image_mask.shape[1],
-                        inputs.image_mask.shape[2],
-                    )
-                )
-        outputs.out_image = out_class_vals
-        if otherargs.out_score_img:
-            outputs.out_score_img = out_score_vals
+        # Perform classification
+        preds_idxs = sk_classifier.predict(class_vars)
+
+        # Use the LUT to update the output class ids
+        preds_cls_ids = numpy.zeros_like(preds_idxs, dtype=numpy.uint16)
+        for cld_id, idx in zip(cls_id_lut, numpy.arange(0, n_classes)):
+            preds_cls_ids[preds_idxs == idx] = cld_id
+
+        out_vals = numpy.expand_dims(preds_cls_ids, axis=1)
+        if create_out_score_img:
+            pred_class_score = sk_classifier.predict_proba(class_vars)
+            out_vals = numpy.concatenate([out_vals, pred_class_score], axis=1)
+        return numpy.ascontiguousarray(out_vals, dtype=numpy.float32)
 
     print("Applying the Classifier")
-    applier.apply(
-        _apply_sk_classifier, in_files, outfiles, otherargs, controls=aControls
+    rsgislib.classification.apply_batch_predictor(
+        img_file_info,
+        in_msk_img,
+        img_msk_val,
+        _apply_sk_classifier,
+        out_imgs,
+        gdalformat,
     )
     print("Completed")
     if gdalformat == "KEA":
@@ -467,85 +382,9 @@ def apply_sklearn_classifier_rat(
 
     """
 
-    def _apply_rat_classifier(info, inputs, outputs, otherargs):
-        """
-        This function is used internally within apply_sklearn_classifier_rat
-        """
-        numpy_vars = []
-        for var in otherargs.vars:
-            var_vals = getattr(inputs.inrat, var)
-            numpy_vars.append(var_vals)
-
-        x_data = numpy.array(numpy_vars)
-        x_data = x_data.transpose()
-
-        row_id = numpy.arange(x_data.shape[0])
-        out_class_int_vals = numpy.zeros(x_data.shape[0], dtype=numpy.int16)
-        out_class_names_vals = numpy.empty(x_data.shape[0], dtype=numpy.dtype("a255"))
-        out_class_names_vals[...] = ""
-
-        row_id = row_id[numpy.isfinite(x_data).all(axis=1)]
-        v_data = x_data[numpy.isfinite(x_data).all(axis=1)]
-
-        if otherargs.roi_col is not None:
-            roi = getattr(inputs.inrat, otherargs.roi_col)
-            roi = roi[numpy.isfinite(x_data).all(axis=1)]
-            v_data = v_data[roi == otherargs.roi_val]
-            row_id = row_id[roi == otherargs.roi_val]
-
-        preds_idxs = otherargs.classifier.predict(v_data)
-
-        preds_cls_ids = numpy.zeros_like(preds_idxs, dtype=numpy.uint16)
-        for cld_id, idx in zip(
-            otherargs.cls_id_lut, numpy.arange(0, len(otherargs.cls_id_lut))
-        ):
-            preds_cls_ids[preds_idxs == idx] = cld_id
-
-        out_class_int_vals[row_id] = preds_cls_ids
-        setattr(outputs.outrat, otherargs.out_col_int, out_class_int_vals)
-
-        for cls_id in otherargs.cls_name_lut:
-            out_class_names_vals[out_class_int_vals == cls_id] = otherargs.cls_name_lut[
-                cls_id
-            ]
-        setattr(outputs.outrat, otherargs.out_col_str, out_class_names_vals)
-
-        if otherargs.class_colours:
-            red = getattr(inputs.inrat, "Red")
-            green = getattr(inputs.inrat, "Green")
-            blue = getattr(inputs.inrat, "Blue")
-
-            # Set Background to black
-            red[...] = 0
-            green[...] = 0
-            blue[...] = 0
-
-            # Set colours
-            for class_name in otherargs.class_train_info:
-                cls_id = otherargs.class_train_info[class_name].out_id
-                red = numpy.where(
-                    out_class_int_vals == cls_id,
-                    otherargs.class_train_info[class_name].red,
-                    red,
-                )
-                green = numpy.where(
-                    out_class_int_vals == cls_id,
-                    otherargs.class_train_info[class_name].green,
-                    green,
-                )
-                blue = numpy.where(
-                    out_class_int_vals == cls_id,
-                    otherargs.class_train_info[class_name].blue,
-                    blue,
-                )
-
-            setattr(outputs.outrat, "Red", red)
-            setattr(outputs.outrat, "Green", green)
-            setattr(outputs.outrat, "Blue", blue)
-
     n_classes = len(cls_train_info)
     cls_id_lut = numpy.zeros(n_classes)
-    cls_name_lut = dict()
+    cls_info_lut = dict()
     for cls_name in cls_train_info:
         if cls_train_info[cls_name].id >= n_classes:
             raise rsgislib.RSGISPyException(
@@ -554,36 +393,28 @@ def apply_sklearn_classifier_rat(
                 )
             )
         cls_id_lut[cls_train_info[cls_name].id] = cls_train_info[cls_name].out_id
-        cls_name_lut[cls_train_info[cls_name].out_id] = cls_name
-
-    in_rats = ratapplier.RatAssociations()
-    out_rats = ratapplier.RatAssociations()
-    in_rats.inrat = ratapplier.RatHandle(clumps_img)
-    out_rats.outrat = ratapplier.RatHandle(clumps_img)
-
-    otherargs = ratapplier.OtherArguments()
-    otherargs.vars = variables
-    otherargs.classifier = sk_classifier
-    otherargs.out_col_int = out_col_int
-    otherargs.out_col_str = out_col_str
-    otherargs.roi_col = roi_col
-    otherargs.roi_val = roi_val
-    otherargs.n_classes = n_classes
-    otherargs.cls_id_lut = cls_id_lut
-    otherargs.cls_name_lut = cls_name_lut
-    otherargs.class_colours = class_colours
-    otherargs.class_train_info = cls_train_info
-
-    if TQDM_AVAIL:
-        progress_bar = rsgislib.TQDMProgressBar()
-    else:
-        progress_bar = rios.cuiprogress.GDALProgressBar()
-
-    aControls = applier.ApplierControls()
-    aControls.progress = progress_bar
+        cls_info_lut[cls_train_info[cls_name].out_id] = (
+            cls_name,
+            cls_train_info[cls_name].red,
+            cls_train_info[cls_name].green,
+            cls_train_info[cls_name].blue,
+        )
 
-    ratapplier.apply(
-        _apply_rat_classifier, in_rats, out_rats, otherargs=otherargs, controls=None
+    def _predict_cls_ids(x_data):
+        preds_idxs = sk_classifier.predict(x_data).astype(int)
+        return cls_id_lut[preds_idxs].astype(numpy.float64)
+
+    # The rows are read, classified and written a chunk at a time natively.
+    rsgislib.classification.apply_rat_batch_predictor(
+        clumps_img,
+        variables,
+        _predict_cls_ids,
+        out_col_int,
+        roi_col=roi_col,
+        roi_val=roi_val,
+        cls_info=cls_info_lut,
+        out_col_str=out_col_str,
+        class_colours=class_colours,
     )
 
 
@@ -41,7 +41,7 @@ from typing import Dict, List, Union
 import h5py
 import numpy
 from osgeo import gdal
-from rios import applier, rat
+from rios import rat
 from sklearn.metrics import accuracy_score, roc_auc_score
 
 import rsgislib
@@ -963,71 +963,22 @@ def apply_xgboost_binary_classifier(
     if not HAVE_XGBOOST:
         raise rsgislib.RSGISPyException("Do not have xgboost module installed.")
 
-    def _apply_xgb_classifier(info, inputs, outputs, otherargs):
-        out_class_vals = numpy.zeros_like(inputs.imageMask, dtype=numpy.uint16)
-        if numpy.any(inputs.imageMask == otherargs.mskVal):
-            out_class_vals = out_class_vals.flatten()
-            img_mask_vals = inputs.imageMask.flatten()
-            class_vars = numpy.zeros(
-                (out_class_vals.shape[0], otherargs.numClassVars), dtype=numpy.float32
-            )
-            # Array index which can be used to populate the output
-            # array following masking etc.
-            id_arr = numpy.arange(img_mask_vals.shape[0])
-            class_vars_idx = 0
-            for img_file in otherargs.imgFileInfo:
-                img_arr = inputs.__dict__[img_file.name]
-                for band in img_file.bands:
-                    class_vars[..., class_vars_idx] = img_arr[(band - 1)].flatten()
-                    class_vars_idx = class_vars_idx + 1
-            class_vars = class_vars[img_mask_vals == otherargs.mskVal]
-            id_arr = id_arr[img_mask_vals == otherargs.mskVal]
-            pred_class = numpy.around(
-                otherargs.classifier.predict(xgb.DMatrix(class_vars)) * 10000
-            )
-            out_class_vals[id_arr] = pred_class
-            out_class_vals = numpy.expand_dims(
-                out_class_vals.reshape(
-                    (inputs.imageMask.shape[1], inputs.imageMask.shape[2])
-                ),
-                axis=0,
-            )
-        outputs.outimage = out_class_vals
-
     classifier = xgb.Booster({"nthread": n_threads})
     classifier.load_model(model_file)
 
-    infiles = applier.FilenameAssociations()
-    infiles.imageMask = in_msk_img
-    num_class_vars = 0
-    for imgFile in img_file_info:
-        infiles.__dict__[imgFile.name] = imgFile.file_name
-        num_class_vars = num_class_vars + len(imgFile.bands)
+    def _apply_xgb_classifier(class_vars):
+        class_vars = numpy.asarray(class_vars)
+        pred_class = numpy.around(classifier.predict(xgb.DMatrix(class_vars)) * 10000)
+        return numpy.ascontiguousarray(pred_class, dtype=numpy.float32)
 
-    outfiles = applier.FilenameAssociations()
-    outfiles.outimage = out_score_img
-    otherargs = applier.OtherInputs()
-    otherargs.classifier = classifier
-    otherargs.mskVal = img_msk_val
-    otherargs.numClassVars = num_class_vars
-    otherargs.imgFileInfo = img_file_info
-
-    if TQDM_AVAIL:
-        progress_bar = rsgislib.TQDMProgressBar()
-    else:
-        progress_bar = rios.cuiprogress.GDALProgressBar()
-
-    aControls = applier.ApplierControls()
-    aControls.progress = progress_bar
-    aControls.creationoptions = rsgislib.imageutils.get_rios_img_creation_opts(
-        gdalformat
-    )
-    aControls.drivername = gdalformat
-    aControls.omitPyramids = True
-    aControls.calcStats = False
     print("Applying the Classifier")
-    applier.apply(
-        _apply_xgb_classifier, infiles, outfiles, otherargs, controls=aControls
+    rsgislib.classification.apply_batch_predictor(
+        img_file_info,
+        in_msk_img,
+        img_msk_val,
+        _apply_xgb_classifier,
+        [(out_score_img, 1, rsgislib.TYPE_16UINT)],
+        gdalformat,
     )
     print("Completed")
     rsgislib.imageutils.pop_img_stats(
@@ -1979,53 +1930,9 @@ def apply_xgboost_multiclass_classifier(
     if not HAVE_XGBOOST:
         raise rsgislib.RSGISPyException("Do not have xgboost module installed.")
 
-    def _applyXGBMClassifier(info, inputs, outputs, otherargs):
-        out_class_id_vals = numpy.zeros_like(inputs.imageMask, dtype=numpy.uint16)
-        if numpy.any(inputs.imageMask == otherargs.mskVal):
-            n_pxls = inputs.imageMask.shape[1] * inputs.imageMask.shape[2]
-            out_class_id_vals = out_class_id_vals.flatten()
-            img_mask_vals = inputs.imageMask.flatten()
-            class_vars = numpy.zeros(
-                (n_pxls, otherargs.numClassVars), dtype=numpy.float32
-            )
-            # Array index which can be used to populate the output array
-            # following masking etc.
-            id_arr = numpy.arange(img_mask_vals.shape[0])
-            class_vars_idx = 0
-            for img_file in otherargs.imgFileInfo:
-                img_arr = inputs.__dict__[img_file.name]
-                for band in img_file.bands:
-                    class_vars[..., class_vars_idx] = img_arr[(band - 1)].flatten()
-                    class_vars_idx = class_vars_idx + 1
-            class_vars = class_vars[img_mask_vals == otherargs.mskVal]
-            id_arr = id_arr[img_mask_vals == otherargs.mskVal]
-            preds_idxs = otherargs.classifier.predict(xgb.DMatrix(class_vars))
-            preds_cls_ids = numpy.zeros_like(preds_idxs, dtype=numpy.uint16)
-            for cld_id, idx in zip(
-                otherargs.cls_id_lut, numpy.arange(0, len(otherargs.cls_id_lut))
-            ):
-                preds_cls_ids[preds_idxs == idx] = cld_id
-
-            out_class_id_vals[id_arr] = preds_cls_ids
-            out_class_id_vals = numpy.expand_dims(
-                out_class_id_vals.reshape(
-                    (inputs.imageMask.shape[1], inputs.imageMask.shape[2])
-                ),
-                axis=0,
-            )
-
-        outputs.outclsimage = out_class_id_vals
-
     classifier = xgb.Booster({"nthread": n_threads})
     classifier.load_model(model_file)
 
-    infiles = applier.FilenameAssociations()
-    infiles.imageMask = in_msk_img
-    num_class_vars = 0
-    for imgFile in img_file_info:
-        infiles.__dict__[imgFile.name] = imgFile.file_name
-        num_class_vars = num_class_vars + len(imgFile.bands)
-
     n_classes = len(cls_info_dict)
     cls_id_lut = numpy.zeros(n_classes)
     for cls_name in cls_info_dict:
@@ -2036,32 +1943,22 @@ def apply_xgboost_multiclass_classifier(
             )
         cls_id_lut[cls_info_dict[cls_name].id] = cls_info_dict[cls_name].out_id
 
-    outfiles = applier.FilenameAssociations()
-    outfiles.outclsimage = out_class_img
-    otherargs = applier.OtherInputs()
-    otherargs.classifier = classifier
-    otherargs.mskVal = img_msk_val
-    otherargs.numClassVars = num_class_vars
-    otherargs.imgFileInfo = img_file_info
-    otherargs.n_classes = n_classes
-    otherargs.cls_id_lut = cls_id_lut
-
-    if TQDM_AVAIL:
-        progress_bar = rsgislib.TQDMProgressBar()
-    else:
-        progress_bar = rios.cuiprogress.GDALProgressBar()
+    def _applyXGBMClassifier(class_vars):
+        class_vars = numpy.asarray(class_vars)
+        preds_idxs = classifier.predict(xgb.DMatrix(class_vars))
+        preds_cls_ids = numpy.zeros_like(preds_idxs, dtype=numpy.uint16)
+        for cld_id, idx in zip(cls_id_lut, numpy.arange(0, len(cls_id_lut))):
+            preds_cls_ids[preds_idxs == idx] = cld_id
+        return numpy.ascontiguousarray(preds_cls_ids, dtype=numpy.float32)
 
-    aControls = applier.ApplierControls()
-    aControls.progress = progress_bar
-    aControls.creationoptions = rsgislib.imageutils.get_rios_img_creation_opts(
-        gdalformat
-    )
-    aControls.drivername = gdalformat
-    aControls.omitPyramids = True
-    aControls.calcStats = False
     print("Applying the Classifier")
-    applier.apply(
-        _applyXGBMClassifier, infiles, outfiles, otherargs, controls=aControls
+    rsgislib.classification.apply_batch_predictor(
+        img_file_info,
+        in_msk_img,
+        img_msk_val,
+        _applyXGBMClassifier,
+        [(out_class_img, 1, rsgislib.TYPE_16UINT)],
+        gdalformat,
     )
     print("Completed Classification")
 
@@ -1,6 +1,9 @@
 #!/usr/bin/env python
 """
-A module to calculate roughness metrics for elevation data.
+A module to calculate roughness metrics for elevation data. The functions in
+this module calculate the metrics for sample points; to calculate the same
+metrics for the window around every pixel of a DEM see
+rsgislib.elevation.calc_dem_roughness.
 """
 
 from typing import Dict
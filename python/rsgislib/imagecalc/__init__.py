@@ -40,6 +40,31 @@ class BandDefn(object):
         self.img_band = img_band
 
 
+class SpecIndexDefn(object):
+    """
+    Create a list of these objects to pass to the calc_spectral_indices function
+    as the 'indices' parameter.
+
+    :param name: the name of the index (used as the output band name).
+    :param index: the type of index (rsgislib.SPECIDX_*).
+    :param bands: list of the image bands (starting at 1) used by the index.
+    :param params: optional list of the index coefficients (e.g., for EVI).
+    :param exp: the muparser expression for a rsgislib.SPECIDX_EXP index.
+    :param var_names: the variable names in exp, where var_names[i] is bands[i].
+
+    """
+
+    def __init__(
+        self, name=None, index=None, bands=None, params=None, exp=None, var_names=None
+    ):
+        self.name = name
+        self.index = index
+        self.bands = bands
+        self.params = params
+        self.exp = exp
+        self.var_names = var_names
+
+
 class StatsSummary:
     """
     This is passed to the imagePixelColumnSummary function"""
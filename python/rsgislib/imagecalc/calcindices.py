@@ -33,6 +33,8 @@
 #
 ###########################################################################
 
+from typing import List
+
 import rsgislib
 import rsgislib.imagecalc
 import rsgislib.imageutils
@@ -1298,6 +1300,124 @@ def calc_ior(
         rsgislib.imageutils.set_img_no_data_value(output_img, -999.0)
 
 
+def calc_spectral_indices(
+    input_img: str,
+    output_img: str,
+    indices: List[str],
+    img_blue_band: int = None,
+    img_green_band: int = None,
+    img_red_band: int = None,
+    img_nir_band: int = None,
+    img_swir1_band: int = None,
+    img_swir2_band: int = None,
+    custom_indices: List[rsgislib.imagecalc.SpecIndexDefn] = None,
+    calc_stats: bool = True,
+    gdalformat: str = "KEA",
+    n_threads: int = 1,
+):
+    """
+    Helper function to calculate a set of indices in a single pass over the input
+    image (using rsgislib.imagecalc.calc_spectral_indices) rather than reading the
+    image for each index. The output image has a band for each index, in the order
+    of the indices list followed by the custom indices. Note the output no data
+    value is -999.
+
+    The available indices, which are the same as the calc_* functions in this
+    module, are: NDVI, WBI, NDWI, GNDWI, GMNDWI, NDSI, NBR, GNDVI, NDGI, NDMI,
+    NPCRI, EVI and EVI2.
+
+    :param input_img: is a string specifying the input image file.
+    :param output_img: is a string specifying the output image file.
+    :param indices: a list of the names of the indices to be calculated.
+    :param img_blue_band: the blue band in the input image (band indexing starts at 1)
+    :param img_green_band: the green band in the input image
+    :param img_red_band: the red band in the input image
+    :param img_nir_band: the nir band in the input image
+    :param img_swir1_band: the swir #1 band in the input image
+    :param img_swir2_band: the swir #2 band in the input image
+    :param custom_indices: an optional list of rsgislib.imagecalc.SpecIndexDefn
+                           objects defining additional indices.
+    :param calc_stats: is a boolean specifying whether pyramids and stats should
+                       be calculated (Default: True)
+    :param gdalformat: is a string specifying the output image file format
+                       (Default: KEA)
+    :param n_threads: the number of threads used to calculate the indices.
+
+    .. code:: python
+
+        from rsgislib.imagecalc import calcindices
+
+        calcindices.calc_spectral_indices(
+            "sen2_img.kea",
+            "sen2_indices.kea",
+            ["NDVI", "NDWI", "EVI"],
+            img_blue_band=2,
+            img_red_band=4,
+            img_nir_band=8,
+            img_swir1_band=9,
+        )
+
+    """
+    bands = {
+        "blue": img_blue_band,
+        "green": img_green_band,
+        "red": img_red_band,
+        "nir": img_nir_band,
+        "swir1": img_swir1_band,
+        "swir2": img_swir2_band,
+    }
+    idx_bands = {
+        "NDVI": (rsgislib.SPECIDX_NORMDIFF, ["nir", "red"]),
+        "WBI": (rsgislib.SPECIDX_RATIO, ["blue", "nir"]),
+        "NDWI": (rsgislib.SPECIDX_NORMDIFF, ["nir", "swir1"]),
+        "GNDWI": (rsgislib.SPECIDX_NORMDIFF, ["green", "nir"]),
+        "GMNDWI": (rsgislib.SPECIDX_NORMDIFF, ["green", "swir1"]),
+        "NDSI": (rsgislib.SPECIDX_NORMDIFF, ["green", "swir1"]),
+        "NBR": (rsgislib.SPECIDX_NORMDIFF, ["nir", "swir2"]),
+        "GNDVI": (rsgislib.SPECIDX_NORMDIFF, ["nir", "green"]),
+        "NDGI": (rsgislib.SPECIDX_NORMDIFF, ["green", "red"]),
+        "NDMI": (rsgislib.SPECIDX_NORMDIFF, ["nir", "swir1"]),
+        "NPCRI": (rsgislib.SPECIDX_NORMDIFF, ["red", "blue"]),
+        "EVI": (rsgislib.SPECIDX_EVI, ["blue", "red", "nir"]),
+        "EVI2": (rsgislib.SPECIDX_EVI2, ["red", "nir"]),
+    }
+
+    idx_defns = list()
+    for idx_name in indices:
+        idx_name_upper = idx_name.upper()
+        if idx_name_upper not in idx_bands:
+            raise rsgislib.RSGISPyException(
+                "Index '{}' is not available.".format(idx_name)
+            )
+        idx_type, band_names = idx_bands[idx_name_upper]
+        img_bands = list()
+        for band_name in band_names:
+            if bands[band_name] is None:
+                raise rsgislib.RSGISPyException(
+                    "The {} band is needed for index '{}'.".format(band_name, idx_name)
+                )
+            img_bands.append(bands[band_name])
+        idx_defns.append(
+            rsgislib.imagecalc.SpecIndexDefn(idx_name_upper, idx_type, img_bands)
+        )
+    if custom_indices is not None:
+        idx_defns += custom_indices
+
+    rsgislib.imagecalc.calc_spectral_indices(
+        input_img,
+        output_img,
+        idx_defns,
+        gdalformat=gdalformat,
+        no_data_val=-999.0,
+        n_threads=n_threads,
+    )
+
+    if calc_stats:
+        rsgislib.imageutils.pop_img_stats(output_img, True, -999.0, True)
+    else:
+        rsgislib.imageutils.set_img_no_data_value(output_img, -999.0)
+
+
 # red-edge mangrove index (REMI) (red edge-red)/(SWIR1-green)
 
 """
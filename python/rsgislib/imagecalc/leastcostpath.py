@@ -32,71 +32,12 @@
 #
 ############################################################################
 
-import numpy
-from osgeo import gdal, osr
+import os
+import shutil
+import tempfile
 
-
-def _coord2pixelOffset(rasterfn, x, y):
-    raster = gdal.Open(rasterfn)
-    geotransform = raster.GetGeoTransform()
-    originX = geotransform[0]
-    originY = geotransform[3]
-    pixelWidth = geotransform[1]
-    pixelHeight = geotransform[5]
-    xOffset = int((x - originX) / pixelWidth)
-    yOffset = int((y - originY) / pixelHeight)
-    return xOffset, yOffset
-
-
-def _createPath(CostSurfaceImg, costSurfaceArray, startCoord, stopCoord):
-    import skimage.graph
-
-    # coordinates to array index
-    startCoordX = startCoord[0]
-    startCoordY = startCoord[1]
-    startIndexX, startIndexY = _coord2pixelOffset(
-        CostSurfaceImg, startCoordX, startCoordY
-    )
-
-    stopCoordX = stopCoord[0]
-    stopCoordY = stopCoord[1]
-    stopIndexX, stopIndexY = _coord2pixelOffset(CostSurfaceImg, stopCoordX, stopCoordY)
-
-    # create path
-    indices, weight = skimage.graph.route_through_array(
-        costSurfaceArray,
-        (startIndexY, startIndexX),
-        (stopIndexY, stopIndexX),
-        geometric=True,
-        fully_connected=True,
-    )
-    indices = numpy.array(indices).T
-    path = numpy.zeros_like(costSurfaceArray)
-    path[indices[0], indices[1]] = 1
-    return path
-
-
-def _array2raster(newRasterfn, rasterfn, array, outFormat):
-    raster = gdal.Open(rasterfn)
-    geotransform = raster.GetGeoTransform()
-    originX = geotransform[0]
-    originY = geotransform[3]
-    pixelWidth = geotransform[1]
-    pixelHeight = geotransform[5]
-    cols = array.shape[1]
-    rows = array.shape[0]
-
-    driver = gdal.GetDriverByName(outFormat)
-    outRaster = driver.Create(newRasterfn, cols, rows, 1, gdal.GDT_Byte)
-    outRaster.SetGeoTransform((originX, pixelWidth, 0, originY, 0, pixelHeight))
-    outband = outRaster.GetRasterBand(1)
-    outband.WriteArray(array)
-    outRasterSRS = osr.SpatialReference()
-    outRasterSRS.ImportFromWkt(raster.GetProjectionRef())
-    outRaster.SetProjection(outRasterSRS.ExportToWkt())
-    outband.FlushCache()
-    outRaster = None
-    raster = None
+import rsgislib
+import rsgislib.imagecalc
 
 
 def perform_least_cost_path_calc(
@@ -106,12 +47,14 @@ def perform_least_cost_path_calc(
     stop_coord: list,
     gdalformat: str = "KEA",
     cost_img_band: int = 1,
+    tile_size: int = 0,
+    tmp_dir: str = None,
 ):
     """
-    Calculates least cost path for a raster surface from start coord to stop coord:
-
-    Version of code from:
-    https://pcjericks.github.io/py-gdalogr-cookbook/raster_layers.html#create-least-cost-path
+    Calculates least cost path for a raster surface from start coord to stop coord.
+    The cost distance from the start coordinate is calculated natively (see
+    rsgislib.imagecalc.calc_cost_distance), so large cost surfaces can be
+    processed as tiles, and the path followed back from the stop coordinate.
 
     :param cost_surface_img: Input image to calculate cost path from
     :param output_img: Output image
@@ -119,14 +62,37 @@ def perform_least_cost_path_calc(
     :param stop_coord: End coordinate (e.g., (263000.1, 292263.7))
     :param gdalformat: GDAL format (default=KEA)
     :param cost_img_band: Band in input image to use for cost analysis (default=1)
+    :param tile_size: if not 0 the cost surface is processed as tiles of
+                      tile_size x tile_size pixels (default=0)
+    :param tmp_dir: a directory for the intermediate cost distance and direction
+                    images. If None a temporary directory is created (default=None)
+    :return: list of the (x, y) coordinates along the path from start_coord.
 
     """
-    # Read gdal raster as array.
-    gdalRasterDS = gdal.Open(cost_surface_img)
-    costSurfaceArray = gdalRasterDS.GetRasterBand(cost_img_band).ReadAsArray()
-
-    # Creates path array
-    pathArray = _createPath(cost_surface_img, costSurfaceArray, start_coord, stop_coord)
-
-    # Converts path array to raster
-    _array2raster(output_img, cost_surface_img, pathArray, gdalformat)
+    created_tmp_dir = False
+    if tmp_dir is None:
+        tmp_dir = tempfile.mkdtemp()
+        created_tmp_dir = True
+
+    try:
+        base_name = os.path.splitext(os.path.basename(output_img))[0]
+        dist_img = os.path.join(tmp_dir, "{}_cost_dist.kea".format(base_name))
+        dir_img = os.path.join(tmp_dir, "{}_cost_dir.kea".format(base_name))
+
+        rsgislib.imagecalc.calc_cost_distance(
+            cost_surface_img,
+            dist_img,
+            dir_img,
+            gdalformat="KEA",
+            src_coords=[start_coord],
+            img_band=cost_img_band,
+            tile_size=tile_size,
+        )
+        path_coords = rsgislib.imagecalc.get_least_cost_path(
+            dir_img, stop_coord, output_img=output_img, gdalformat=gdalformat
+        )
+    finally:
+        if created_tmp_dir:
+            shutil.rmtree(tmp_dir)
+
+    return path_coords
@@ -34,7 +34,6 @@
 
 
 import rsgislib
-import rsgislib.imageutils
 import os
 import numpy
 from osgeo import gdal
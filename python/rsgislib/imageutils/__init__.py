@@ -3718,11 +3718,13 @@ def subset_to_geoms_bbox(
     gdalformat: str = "KEA",
     datatype: int = None,
     out_img_ext: str = "kea",
+    n_threads: int = 1,
 ):
     """
     Subset an image to the bounding box of a each geometry in the input vector
     producing multiple output files. Useful for splitting an image into tiles
-    of unequal sizes or extracting sampling plots from a larger image.
+    of unequal sizes or extracting sampling plots from a larger image. The
+    input image is read once for all the subsets (see subset_bboxs).
 
     Note, if a vector feature does not intersect with the input image then
     it will silently ignore the feature (i.e., not output image will be produced).
@@ -3739,6 +3741,7 @@ def subset_to_geoms_bbox(
     :param datatype: output image data type. If None (default) then taken from
                      the input image.
     :param out_img_ext: output image file extension (e.g., kea)
+    :param n_threads: the number of threads used to write the output images.
 
     """
     import rsgislib.tools.geometrytools
@@ -3761,34 +3764,22 @@ def subset_to_geoms_bbox(
 
     in_img_bbox = get_img_bbox(input_img)
 
+    sub_bboxs = []
+    output_imgs = []
     for bbox_id, bbox in zip(unq_bbox_ids, bboxs):
         output_img = "{}{}.{}".format(out_img_base, bbox_id, out_img_ext)
-        print(output_img)
         if rsgislib.tools.geometrytools.does_bbox_contain(in_img_bbox, bbox):
-            subset_bbox(
-                input_img,
-                output_img,
-                gdalformat,
-                datatype,
-                bbox[0],
-                bbox[1],
-                bbox[2],
-                bbox[3],
-            )
+            sub_bboxs.append(bbox)
+            output_imgs.append(output_img)
         elif rsgislib.tools.geometrytools.do_bboxes_intersect(in_img_bbox, bbox):
-            inter_bbox = rsgislib.tools.geometrytools.bbox_intersection(
-                in_img_bbox, bbox
-            )
-            subset_bbox(
-                input_img,
-                output_img,
-                gdalformat,
-                datatype,
-                inter_bbox[0],
-                inter_bbox[1],
-                inter_bbox[2],
-                inter_bbox[3],
+            sub_bboxs.append(
+                rsgislib.tools.geometrytools.bbox_intersection(in_img_bbox, bbox)
             )
+            output_imgs.append(output_img)
+
+    subset_bboxs(
+        input_img, sub_bboxs, output_imgs, gdalformat, datatype, n_threads=n_threads
+    )
 
 
 def mask_img_with_vec(
@@ -5307,3 +5298,61 @@ def create_inmem_gdal_ds_subset(
         out_band_obj.WriteArray(raster_arr)
     in_img_ds_obj = None
     return out_img_ds_obj
+
+
+def sample_img_points(
+    input_img: str,
+    x_coords: numpy.array,
+    y_coords: numpy.array,
+    img_bands: List[int] = None,
+    interp: int = rsgislib.INTERP_NEAREST_NEIGHBOUR,
+    no_data_val: float = 0,
+    n_threads: int = 1,
+) -> numpy.array:
+    """
+    A function which samples the image band values at a set of points. Rather than
+    reading each point individually, the points are sorted by the image block they
+    are within and each block touched by a point is read once for all the bands.
+
+    :param input_img: the input image file path.
+    :param x_coords: the x coordinates of the points (in the image projection).
+    :param y_coords: the y coordinates of the points (in the image projection).
+    :param img_bands: an optional list of the bands (starting at 1) to be sampled.
+                      If None (default) then all the bands are sampled.
+    :param interp: the interpolation: rsgislib.INTERP_NEAREST_NEIGHBOUR (default),
+                   rsgislib.INTERP_BILINEAR or rsgislib.INTERP_CUBIC.
+    :param no_data_val: the value for points outside of the image.
+    :param n_threads: the number of threads used to read and interpolate the
+                      blocks (0 uses all the available cores).
+    :return: a numpy array with a row per point and a column per band.
+
+    .. code:: python
+
+        import numpy
+        import rsgislib.imageutils
+
+        x_coords = numpy.array([263450.5, 264012.0])
+        y_coords = numpy.array([289104.0, 288533.5])
+        vals = rsgislib.imageutils.sample_img_points("sen2_img.kea", x_coords, y_coords)
+
+    """
+    x_coords = numpy.ascontiguousarray(x_coords, dtype=numpy.float64).ravel()
+    y_coords = numpy.ascontiguousarray(y_coords, dtype=numpy.float64).ravel()
+    if img_bands is None:
+        n_bands = get_img_band_count(input_img)
+    else:
+        img_bands = [int(band) for band in img_bands]
+        n_bands = len(img_bands)
+
+    out_vals = numpy.zeros((x_coords.shape[0], n_bands), dtype=numpy.float64)
+    sample_img_points_to_array(
+        input_img,
+        x_coords,
+        y_coords,
+        out_vals,
+        img_bands=img_bands,
+        interp=interp,
+        no_data_val=no_data_val,
+        n_threads=n_threads,
+    )
+    return out_vals
@@ -269,20 +269,31 @@ def create_tile_mask_images_from_clumps(
 
 
 def create_tiles_from_masks(
-    inputImage, tilesBase, tilesMetaDIR, tilesImgDIR, datatype, gdalformat
+    inputImage,
+    tilesBase,
+    tilesMetaDIR,
+    tilesImgDIR,
+    datatype,
+    gdalformat,
+    n_threads=1,
 ):
     """
     A function to apply the image tile masks defined in createTileMaskImages to the input image to extract the individual tiles.
+    The input image is read once for all the tiles (see rsgislib.imageutils.create_tiles_from_masks).
 
     :param inputImage: is the input image being tiled.
     :param tileMasksBase: is the base path for the tile masks. glob will be used to find them with \*.kea added to the end.
     :param outTilesBase: is the base file name for the tiles.
+    :param n_threads: is the number of threads used to write the tiles.
 
     """
     maskFiles = glob.glob(os.path.join(tilesMetaDIR, tilesBase + "*.kea"))
 
-    idx = 1
+    tileImages = []
     for maskFile in maskFiles:
-        tileImage = os.path.join(tilesImgDIR, os.path.basename(maskFile))
-        imageutils.mask_img(inputImage, maskFile, tileImage, gdalformat, datatype, 0, 0)
+        tileImages.append(os.path.join(tilesImgDIR, os.path.basename(maskFile)))
+    imageutils.create_tiles_from_masks(
+        inputImage, maskFiles, tileImages, gdalformat, datatype, 0, 0, n_threads
+    )
+    for tileImage in tileImages:
         imageutils.pop_img_stats(tileImage, True, 0.0, True)
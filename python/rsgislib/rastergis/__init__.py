@@ -18,7 +18,10 @@ from ._rastergis import *
 
 
 class BandAttStats:
-    """This is passed to the populate_rat_with_stats function"""
+    """This is passed to the populate_rat_with_stats and
+    populate_rat_with_stats_single_pass functions. The count_field, mode_field,
+    percentiles and histogram parameters are only used by
+    populate_rat_with_stats_single_pass."""
 
     def __init__(
         self,
@@ -28,6 +31,12 @@ class BandAttStats:
         sum_field=None,
         std_dev_field=None,
         mean_field=None,
+        count_field=None,
+        mode_field=None,
+        percentiles=None,
+        hist_min=None,
+        hist_max=None,
+        n_hist_bins=200,
     ):
         self.band = band
         self.min_field = min_field
@@ -35,6 +44,12 @@ class BandAttStats:
         self.sum_field = sum_field
         self.mean_field = mean_field
         self.std_dev_field = std_dev_field
+        self.count_field = count_field
+        self.mode_field = mode_field
+        self.percentiles = percentiles
+        self.hist_min = hist_min
+        self.hist_max = hist_max
+        self.n_hist_bins = n_hist_bins
 
 
 class FieldAttStats:
@@ -81,6 +96,38 @@ class ChangeFeats:
         self.threshold = threshold
 
 
+SEP_JM_1D = 0
+SEP_JM_2D = 1
+SEP_BHATTACHARYYA = 2
+
+
+class SeparabilityCalc:
+    """This is passed to the calc_separabilities function. The measure is
+    one of SEP_JM_1D, SEP_JM_2D or SEP_BHATTACHARYYA; val2_col and the bin
+    widths are only used by the JM distances (val2_col and val2_bin_width
+    only by SEP_JM_2D)."""
+
+    def __init__(
+        self,
+        measure: int,
+        val1_col: str,
+        cls_col: str,
+        class1: str,
+        class2: str,
+        val2_col: str = None,
+        val1_bin_width: float = 0,
+        val2_bin_width: float = 0,
+    ):
+        self.measure = measure
+        self.val1_col = val1_col
+        self.cls_col = cls_col
+        self.class1 = class1
+        self.class2 = class2
+        self.val2_col = val2_col
+        self.val1_bin_width = float(val1_bin_width)
+        self.val2_bin_width = float(val2_bin_width)
+
+
 def export_cols_to_gdal_img(
     clumps_img: str,
     output_img: str,
@@ -785,35 +832,6 @@ def identify_small_units(
         shutil.rmtree(tmp_dir)
 
 
-def _computeProximityArrArgsFunc(arg_vals: list):
-    """
-    This function is used internally within calc_dist_to_classes for the
-    multiprocessing Pool
-
-    """
-    import rsgislib.imageutils
-
-    class_img_ds = gdal.Open(arg_vals[0], gdal.GA_ReadOnly)
-    class_img_band = class_img_ds.GetRasterBand(1)
-    rsgislib.imageutils.create_copy_img(
-        arg_vals[0], arg_vals[1], 1, arg_vals[3], arg_vals[4], rsgislib.TYPE_32FLOAT
-    )
-    dist_img_ds = gdal.Open(arg_vals[1], gdal.GA_Update)
-    dist_img_band = dist_img_ds.GetRasterBand(1)
-    try:
-        import tqdm
-
-        pbar = tqdm.tqdm(total=100)
-        callback = lambda *args, **kw: pbar.update()
-    except:
-        callback = gdal.TermProgress
-    gdal.ComputeProximity(class_img_band, dist_img_band, arg_vals[2], callback=callback)
-    dist_img_band = None
-    dist_img_ds = None
-    class_img_band = None
-    class_img_ds = None
-
-
 def calc_dist_to_classes(
     clumps_img: str,
     class_col: str,
@@ -826,29 +844,26 @@ def calc_dist_to_classes(
 ):
     """
     A function which will calculate proximity rasters for a set of classes
-    defined within the RAT.
+    defined within the RAT. The distances to all the classes are calculated
+    in a single pass over the image with an exact Euclidean distance transform
+    (see rsgislib.imageutils.calc_dist_to_img_classes).
 
     :param clumps_img: is a string specifying the input image with the associated RAT
     :param class_col: is the column in the RAT which has the classification
     :param out_img_base: is the base name of the output image - output files will
                        be KEA files.
-    :param tmp_dir: is a directory to be used for storing the image tiles and
-                   other temporary files - if not directory does not exist it
-                   will be created and deleted on completion (Default: tmp).
-    :param tile_size: is an int specifying in pixels the size of the image tiles
-                     used for processing (Default: 2000)
+    :param tmp_dir: is a directory to be used for storing the classification image
+                   - if not directory does not exist it will be created and deleted
+                   on completion (Default: tmp).
+    :param tile_size: not used (retained for compatibility).
     :param max_dist: is the maximum distance in units of the geographic units of
                     the projection of the input image (Default: 1000).
     :param no_data_val: is the value applied to the pixels outside of the maxDist
                    threshold (Default: 1000; i.e., the same as maxDist).
-    :param n_cores: is the number of processing cores which are available to be
-                   used for this processing. If -1 all available cores will be
-                   used. (Default: -1)
+    :param n_cores: not used (retained for compatibility); the distance transform
+                    uses the threads of the default execution context.
 
     """
-    import glob
-    import math
-    import multiprocessing
     import shutil
 
     from rios import rat
@@ -863,9 +878,6 @@ def calc_dist_to_classes(
         os.makedirs(tmp_dir)
         tmp_present = False
 
-    if n_cores <= 0:
-        n_cores = multiprocessing.cpu_count()
-
     uid_str = rsgislib.tools.utils.uid_generator()
 
     classes_img = os.path.join(tmp_dir, f"ClassImg_{uid_str}.kea")
@@ -877,100 +889,24 @@ def calc_dist_to_classes(
     class_col_int = rat.readColumn(rat_dataset, class_col)
     rat_dataset = None
 
-    class_ids = numpy.unique(class_col_int)
-
-    x_res, y_res = rsgislib.imageutils.get_img_res(classes_img)
-
-    x_max_dist_pxl = math.ceil(max_dist / x_res)
-    y_max_dist_pxl = math.ceil(max_dist / y_res)
-
-    print("Max Dist Pxls X = {}, Y = {}".format(x_max_dist_pxl, y_max_dist_pxl))
-
-    tile_overlap = x_max_dist_pxl
-    if y_max_dist_pxl > x_max_dist_pxl:
-        tile_overlap = y_max_dist_pxl
-
-    class_tiles_dir = os.path.join(tmp_dir, f"ClassTiles_{uid_str}")
-    class_tiles_dir_present = True
-    if not os.path.exists(class_tiles_dir):
-        os.makedirs(class_tiles_dir)
-        class_tiles_dir_present = False
+    class_ids = [int(class_id) for class_id in numpy.unique(class_col_int)]
+    dist_imgs = [
+        "{}_{}.kea".format(out_img_base, class_id) for class_id in class_ids
+    ]
 
-    classes_img_tile_base = os.path.join(class_tiles_dir, "ClassImgTile")
-    rsgislib.imageutils.create_tiles(
+    rsgislib.imageutils.calc_dist_to_img_classes(
         classes_img,
-        classes_img_tile_base,
-        tile_size,
-        tile_size,
-        tile_overlap,
-        0,
-        "KEA",
-        rsgislib.TYPE_32UINT,
-        "kea",
+        dist_imgs,
+        class_ids=class_ids,
+        gdalformat="KEA",
+        max_dist=max_dist,
+        no_data_val=no_data_val,
+        use_geo_units=True,
     )
-    img_tile_files = glob.glob(f"{classes_img_tile_base}*.kea")
-
-    dist_tiles_dir = os.path.join(tmp_dir, f"DistTiles_{uid_str}")
-    dist_tiles_dir_present = True
-    if not os.path.exists(dist_tiles_dir):
-        os.makedirs(dist_tiles_dir)
-        dist_tiles_dir_present = False
-
-    prox_options_base = [
-        "MAXDIST=" + str(max_dist),
-        "DISTUNITS=GEO",
-        "NODATA=" + str(no_data_val),
-    ]
-
-    for class_id in class_ids:
-        print("Class {}".format(class_id))
-        proxOptions = list(prox_options_base)
-        proxOptions.append("VALUES=" + str(class_id))
-
-        dist_tiles = []
-        dist_tile_args = []
-        for class_tile_file in img_tile_files:
-            base_tile_name = os.path.basename(class_tile_file)
-            dist_tile_file = os.path.join(dist_tiles_dir, base_tile_name)
-            tile_args = [
-                class_tile_file,
-                dist_tile_file,
-                proxOptions,
-                no_data_val,
-                "KEA",
-            ]
-            dist_tiles.append(dist_tile_file)
-            dist_tile_args.append(tile_args)
-
-        with multiprocessing.Pool(n_cores) as p:
-            p.map(_computeProximityArrArgsFunc, dist_tile_args)
-
-        dist_image = "{}_{}.kea".format(out_img_base, class_id)
-        # Mosaic Tiles
-        rsgislib.imageutils.create_img_mosaic(
-            dist_tiles,
-            dist_image,
-            no_data_val,
-            no_data_val,
-            1,
-            1,
-            "KEA",
-            rsgislib.TYPE_32FLOAT,
-        )
+    for dist_image in dist_imgs:
         rsgislib.imageutils.pop_img_stats(
             dist_image, use_no_data=True, no_data_val=no_data_val, calc_pyramids=True
         )
-        for img_file in dist_tiles:
-            rsgislib.tools.filetools.delete_file_with_basename(img_file)
-
-    if not class_tiles_dir_present:
-        shutil.rmtree(class_tiles_dir, ignore_errors=True)
-    else:
-        for class_tile_file in img_tile_files:
-            rsgislib.tools.filetools.delete_file_with_basename(class_tile_file)
-
-    if not dist_tiles_dir_present:
-        shutil.rmtree(dist_tiles_dir, ignore_errors=True)
 
     if not tmp_present:
         shutil.rmtree(tmp_dir, ignore_errors=True)
@@ -986,54 +922,29 @@ def calc_dist_between_clumps(
     max_dist_thres: float = 10,
 ):
     """
-    Calculate the distance between all clumps
+    Calculate the distance from each clump to the nearest other clump. The distance
+    is the shortest distance between the pixels of the clumps, so is 0 for clumps
+    which touch. The distances are calculated from a spatial index of the clump
+    boundary pixels (see calc_dist_to_nearest_clumps) so the clumps are not
+    polygonised.
 
     :param clumps_img: image clumps for which the distance will be calculated.
     :param out_col_name: output column within the clumps image.
-    :param tmp_dir: directory out temporary files will be outputted to.
-    :param use_idx: use a spatial index when calculating the distance between
-                   clumps (needed for large number of clumps).
-    :param max_dist_thres: if using an index than an upper limit on the distance
-                         between clumps can be defined.
+    :param tmp_dir: not used (retained for compatibility).
+    :param use_idx: if True then the max_dist_thres upper limit on the distance
+                    between clumps is used (the spatial index is always used).
+    :param max_dist_thres: if use_idx is True, an upper limit on the distance
+                           between clumps; clumps without another clump within
+                           the limit have a distance of max_dist_thres.
 
     """
-    import shutil
-
-    import rsgislib.tools.filetools
-    import rsgislib.tools.utils
-    import rsgislib.vectorutils
-
-    tmp_present = True
-    if not os.path.exists(tmp_dir):
-        os.makedirs(tmp_dir)
-        tmp_present = False
-
-    base_name = "{}_{}".format(
-        rsgislib.tools.filetools.get_file_basename(clumps_img),
-        rsgislib.tools.utils.uid_generator(),
-    )
-
-    polys_shp = os.path.join(tmp_dir, base_name + "_shp.shp")
-    rsgislib.vectorutils.polygoniseRaster(
-        clumps_img, polys_shp, imgBandNo=1, maskImg=clumps_img, imgMaskBandNo=1
-    )
+    max_dist = 0
+    if use_idx:
+        max_dist = max_dist_thres
 
-    print(
-        "Calculating Distance - can take some time. Try using index "
-        "and decreasing max distance threshold."
-    )
-    t_obj = rsgislib.RSGISTime()
-    t_obj.start(True)
-    polys_shp_geom_dist = os.path.join(tmp_dir, base_name + "_dist_shp.shp")
-    rsgislib.vectorutils.dist2NearestGeom(
-        polys_shp, polys_shp_geom_dist, out_col_name, True, use_idx, max_dist_thres
+    calc_dist_to_nearest_clumps(
+        clumps_img, out_col_name, exclude_self=True, max_dist=max_dist
     )
-    t_obj.end()
-
-    import_vec_atts(clumps_img, polys_shp_geom_dist, [out_col_name])
-
-    if not tmp_present:
-        shutil.rmtree(tmp_dir, ignore_errors=True)
 
 
 def calc_dist_to_large_clumps(
@@ -1046,128 +957,50 @@ def calc_dist_to_large_clumps(
 ):
     """
     Calculate the distance from each small clump to a large clump. Split defined by
-    the threshold provided.
+    the threshold provided. The large clumps have a distance of 0. The columns
+    smallUnits and largeUnits are written to the RAT to define the two sets of
+    clumps.
 
     :param clumps_img: image clumps for which the distance will be calculated.
     :param out_col_name: output column within the clumps image.
     :param size_thres: is a threshold to seperate the sets of large and small clumps.
-    :param tmp_dir: directory out temporary files will be outputted to.
-    :param use_idx: use a spatial index when calculating the distance between clumps
-                   (needed for large number of clumps).
-    :param max_dist_thres: if using an index than an upper limit on the distance
-                         between clumps can be defined.
+    :param tmp_dir: not used (retained for compatibility).
+    :param use_idx: if True then the max_dist_thres upper limit on the distance
+                    between clumps is used (the spatial index is always used).
+    :param max_dist_thres: if use_idx is True, an upper limit on the distance
+                           between clumps; small clumps without a large clump
+                           within the limit have a distance of max_dist_thres.
 
     """
-    import shutil
-
     from rios import rat
 
-    import rsgislib.tools.utils
-    import rsgislib.vectorutils
-
-    tmp_present = True
-    if not os.path.exists(tmp_dir):
-        os.makedirs(tmp_dir)
-        tmp_present = False
-
-    uid_str = rsgislib.tools.utils.uid_generator()
-    base_name = "{}_{}".format(
-        rsgislib.tools.filetools.get_file_basename(clumps_img), uid_str
-    )
-
     rat_dataset = gdal.Open(clumps_img, gdal.GA_Update)
     histogram = rat.readColumn(rat_dataset, "Histogram")
     small_units = numpy.zeros_like(histogram, dtype=numpy.int16)
     small_units[histogram < size_thres] = 1
+    small_units[0] = 0
+    large_units = numpy.zeros_like(histogram, dtype=numpy.int16)
+    large_units[histogram >= size_thres] = 1
+    large_units[0] = 0
     rat.writeColumn(rat_dataset, "smallUnits", small_units)
+    rat.writeColumn(rat_dataset, "largeUnits", large_units)
+    rat_dataset = None
 
-    id_vals = numpy.arange(histogram.shape[0])
-
-    sm_units_ids = id_vals[small_units == 1]
-    sm_units_ids = sm_units_ids[sm_units_ids > 0]
-    lrg_unit_ids = id_vals[small_units == 0]
-    lrg_unit_ids = lrg_unit_ids[lrg_unit_ids > 0]
-
-    print("There are {} small clumps.".format(sm_units_ids.shape[0]))
-    print("There are {} large clumps.".format(lrg_unit_ids.shape[0]))
-
-    sm_unit_fids = numpy.arange(sm_units_ids.shape[0])
-    lrg_unit_fids = numpy.arange(lrg_unit_ids.shape[0])
-
-    sm_unit_clump_ids = numpy.zeros_like(histogram, dtype=numpy.int16)
-    sm_unit_clump_ids[sm_units_ids] = sm_unit_fids
-    lrg_unit_clump_ids = numpy.zeros_like(histogram, dtype=numpy.int16)
-    lrg_unit_clump_ids[lrg_unit_ids] = lrg_unit_fids
-
-    rat.writeColumn(rat_dataset, "SmUnits", sm_unit_clump_ids)
-    rat.writeColumn(rat_dataset, "LrgUnits", lrg_unit_clump_ids)
-    rat.writeColumn(rat_dataset, "smallUnitsBin", small_units)
-
-    sm_clumps_img = os.path.join(tmp_dir, base_name + "_smclumps.kea")
-    export_col_to_gdal_img(
-        clumps_img, sm_clumps_img, "KEA", rsgislib.TYPE_32UINT, "SmUnits"
-    )
-    pop_rat_img_stats(
-        clumps_img=sm_clumps_img, add_clr_tab=True, calc_pyramids=True, ignore_zero=True
-    )
-
-    lrg_clumps_img = os.path.join(tmp_dir, base_name + "_lrgclumps.kea")
-    export_col_to_gdal_img(
-        clumps_img, lrg_clumps_img, "KEA", rsgislib.TYPE_32UINT, "LrgUnits"
-    )
-    pop_rat_img_stats(
-        clumps_img=lrg_clumps_img,
-        add_clr_tab=True,
-        calc_pyramids=True,
-        ignore_zero=True,
-    )
-
-    sm_polys_shp = os.path.join(tmp_dir, base_name + "_smClumps_shp.shp")
-    rsgislib.vectorutils.polygoniseRaster(
-        sm_clumps_img, sm_polys_shp, imgBandNo=1, maskImg=sm_clumps_img, imgMaskBandNo=1
-    )
+    print("There are {} small clumps.".format(numpy.sum(small_units)))
+    print("There are {} large clumps.".format(numpy.sum(large_units)))
 
-    lgr_polys_shp = os.path.join(tmp_dir, base_name + "_lgrClumps_shp.shp")
-    rsgislib.vectorutils.polygoniseRaster(
-        lrg_clumps_img,
-        lgr_polys_shp,
-        imgBandNo=1,
-        maskImg=lrg_clumps_img,
-        imgMaskBandNo=1,
-    )
+    max_dist = 0
+    if use_idx:
+        max_dist = max_dist_thres
 
-    print(
-        "Calculating Distance - can take some time. Try using index and "
-        "decreasing max distance threshold."
-    )
-    t = rsgislib.RSGISTime()
-    t.start(True)
-    sm_polys_dist_shp = os.path.join(tmp_dir, base_name + "_smClumps_dist_shp.shp")
-    rsgislib.vectorutils.dist2NearestSecGeomSet(
-        sm_polys_shp,
-        lgr_polys_shp,
-        sm_polys_dist_shp,
+    calc_dist_to_nearest_clumps(
+        clumps_img,
         out_col_name,
-        True,
-        use_idx,
-        max_dist_thres,
+        target_col="largeUnits",
+        query_col="smallUnits",
+        exclude_self=True,
+        max_dist=max_dist,
     )
-    t.end()
-    import_vec_atts(sm_clumps_img, sm_polys_dist_shp, [out_col_name])
-
-    sm_clumps_rat_dataset = gdal.Open(sm_clumps_img, gdal.GA_Update)
-    min_dist_col = rat.readColumn(sm_clumps_rat_dataset, out_col_name)
-
-    minDistSmlClumpsArr = numpy.zeros_like(histogram, dtype=numpy.float32)
-    minDistSmlClumpsArr[sm_units_ids] = min_dist_col
-
-    rat.writeColumn(rat_dataset, out_col_name, minDistSmlClumpsArr)
-
-    sm_clumps_rat_dataset = None
-    rat_dataset = None
-
-    if not tmp_present:
-        shutil.rmtree(tmp_dir, ignore_errors=True)
 
 
 def populate_rat_with_cat_vec_lyr(
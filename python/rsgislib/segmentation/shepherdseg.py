@@ -118,8 +118,10 @@ def run_shepherd_segmentation(
     :param sampling: specify the subsampling of the image for the data used within
                      the KMeans (default = 100; 1 == no subsampling).
     :param km_max_iter: maximum iterations for KMeans.
-    :param process_in_mem: where functions allow it perform processing in memory
-                           rather than on disk.
+    :param process_in_mem: run the whole segmentation with a single C++ call
+                           (rsgislib.segmentation.run_shepherd_segmentation)
+                           which holds the intermediate images in memory
+                           rather than writing them to tmp_dir.
     :param save_process_stats: is a bool which specifies that the image stretch
                                stats and the kMeans centre stats should be saved
                                along with a header.
@@ -159,177 +161,206 @@ def run_shepherd_segmentation(
                 "need to be provided."
             )
 
-    basefile = os.path.basename(input_img)
-    basename = os.path.splitext(basefile)[0]
-
-    out_file_ext = rsgislib.imageutils.get_file_img_extension(gdalformat)
-
-    createdDIR = False
-    if not os.path.isdir(tmp_dir):
-        os.makedirs(tmp_dir)
-        createdDIR = True
-
     # Get data type of input image
     input_datatype = rsgislib.imageutils.get_rsgislib_datatype_from_img(input_img)
 
-    # Select Image Bands if required
-    inputImgBands = input_img
-    selectBands = False
-    if bands is not None:
-        print("Subsetting the image bands")
-        selectBands = True
-        inputImgBands = os.path.join(
-            tmp_dir, "{}_bselect.{}".format(basename, out_file_ext)
+    if process_in_mem:
+        # The stretched image, the labels and the clumps are held in memory and
+        # only the final clumps are written.
+        print("Running the segmentation in memory.")
+        rsgislib.segmentation.run_shepherd_segmentation(
+            input_img,
+            out_clumps_img,
+            gdalformat=gdalformat,
+            bands=bands,
+            no_stretch=no_stretch,
+            num_clusters=num_clusters,
+            min_n_pxls=min_n_pxls,
+            dist_thres=dist_thres,
+            sampling=sampling,
+            km_max_iter=km_max_iter,
+            calc_stats=calc_stats,
+            img_stretch_stats=img_stretch_stats if save_process_stats else "",
+            kmeans_centres=kmeans_centres if save_process_stats else "",
+            tmp_dir=tmp_dir,
         )
-        rsgislib.imageutils.select_img_bands(
-            input_img, inputImgBands, gdalformat, input_datatype, bands
+    else:
+        basefile = os.path.basename(input_img)
+        basename = os.path.splitext(basefile)[0]
+
+        out_file_ext = rsgislib.imageutils.get_file_img_extension(gdalformat)
+
+        createdDIR = False
+        if not os.path.isdir(tmp_dir):
+            os.makedirs(tmp_dir)
+            createdDIR = True
+
+        # Select Image Bands if required
+        inputImgBands = input_img
+        selectBands = False
+        if bands is not None:
+            print("Subsetting the image bands")
+            selectBands = True
+            inputImgBands = os.path.join(
+                tmp_dir, "{}_bselect.{}".format(basename, out_file_ext)
+            )
+            rsgislib.imageutils.select_img_bands(
+                input_img, inputImgBands, gdalformat, input_datatype, bands
+            )
+
+        # Stretch input data if required.
+        segmentFile = inputImgBands
+        if not no_stretch:
+            segmentFile = os.path.join(
+                tmp_dir, "{}_stchd.{}".format(basename, out_file_ext)
+            )
+            strchFile = os.path.join(
+                tmp_dir, "{}_stchdonly.{}".format(basename, out_file_ext)
+            )
+            strchFileOffset = os.path.join(
+                tmp_dir, "{}_stchdonly_off.{}".format(basename, out_file_ext)
+            )
+            strchMaskFile = os.path.join(
+                tmp_dir, "{}_stchdmaskonly.{}".format(basename, out_file_ext)
+            )
+
+            print("Stretch Input Image")
+            rsgislib.imageutils.stretch_img(
+                inputImgBands,
+                strchFile,
+                save_process_stats,
+                img_stretch_stats,
+                True,
+                False,
+                gdalformat,
+                rsgislib.TYPE_8UINT,
+                rsgislib.imageutils.STRETCH_LINEARSTDDEV,
+                2,
+            )
+
+            print(
+                "Add 1 to stretched file to ensure there are no all "
+                "zeros (i.e., no data) regions created."
+            )
+            rsgislib.imagecalc.image_math(
+                strchFile, strchFileOffset, "b1+1", gdalformat, rsgislib.TYPE_8UINT
+            )
+
+            print("Create Input Image Mask.")
+            bandMathBands = [
+                rsgislib.imagecalc.BandDefn(
+                    band_name="b1", input_img=inputImgBands, img_band=1
+                )
+            ]
+            rsgislib.imagecalc.band_math(
+                strchMaskFile,
+                "b1==0?1:0",
+                gdalformat,
+                rsgislib.TYPE_8UINT,
+                bandMathBands,
+            )
+
+            print("Mask stretched Image.")
+            rsgislib.imageutils.mask_img(
+                strchFileOffset,
+                strchMaskFile,
+                segmentFile,
+                gdalformat,
+                rsgislib.TYPE_8UINT,
+                0,
+                1,
+            )
+
+            if not no_delete:
+                # Deleting extra files
+                rsgislib.tools.filetools.delete_file_with_basename(strchFile)
+                rsgislib.tools.filetools.delete_file_with_basename(strchFileOffset)
+                rsgislib.tools.filetools.delete_file_with_basename(strchMaskFile)
+
+        # Perform KMEANS
+        print("Performing KMeans.")
+        outMatrixFile = os.path.join(tmp_dir, "{}_kmeansclusters".format(basename))
+        if save_process_stats:
+            outMatrixFile = kmeans_centres
+        rsgislib.imagecalc.kmeans_clustering(
+            segmentFile,
+            outMatrixFile,
+            num_clusters,
+            km_max_iter,
+            sampling,
+            True,
+            0.0025,
+            rsgislib.imagecalc.INITCLUSTER_DIAGONAL_FULL_ATTACH,
         )
 
-    # Stretch input data if required.
-    segmentFile = inputImgBands
-    if not no_stretch:
-        segmentFile = os.path.join(
-            tmp_dir, "{}_stchd.{}".format(basename, out_file_ext)
+        # Apply KMEANS
+        print("Apply KMeans to image.")
+        kMeansFileZones = os.path.join(
+            tmp_dir, "{}_kmeans.{}".format(basename, out_file_ext)
         )
-        strchFile = os.path.join(
-            tmp_dir, "{}_stchdonly.{}".format(basename, out_file_ext)
+        rsgislib.segmentation.label_pixels_from_cluster_centres(
+            segmentFile,
+            kMeansFileZones,
+            outMatrixFile + str(".gmtxt"),
+            True,
+            gdalformat,
         )
-        strchFileOffset = os.path.join(
-            tmp_dir, "{}_stchdonly_off.{}".format(basename, out_file_ext)
+
+        # Eliminate Single Pixels
+        print("Eliminate Single Pixels.")
+        kMeansFileZonesNoSgls = os.path.join(
+            tmp_dir, "{}_kmeans_nosgl.{}".format(basename, out_file_ext)
         )
-        strchMaskFile = os.path.join(
-            tmp_dir, "{}_stchdmaskonly.{}".format(basename, out_file_ext)
+        kMeansFileZonesNoSglsTmp = os.path.join(
+            tmp_dir, "{}_kmeans_nosgl_tmp.{}".format(basename, out_file_ext)
         )
-
-        print("Stretch Input Image")
-        rsgislib.imageutils.stretch_img(
-            inputImgBands,
-            strchFile,
-            save_process_stats,
-            img_stretch_stats,
-            True,
-            False,
+        rsgislib.segmentation.eliminate_single_pixels(
+            segmentFile,
+            kMeansFileZones,
+            kMeansFileZonesNoSgls,
+            kMeansFileZonesNoSglsTmp,
             gdalformat,
-            rsgislib.TYPE_8UINT,
-            rsgislib.imageutils.STRETCH_LINEARSTDDEV,
-            2,
+            process_in_mem,
+            True,
         )
 
-        print(
-            "Add 1 to stretched file to ensure there are no all "
-            "zeros (i.e., no data) regions created."
+        # Clump
+        print("Perform clump.")
+        initClumpsFile = os.path.join(
+            tmp_dir, "{}_clumps.{}".format(basename, out_file_ext)
         )
-        rsgislib.imagecalc.image_math(
-            strchFile, strchFileOffset, "b1+1", gdalformat, rsgislib.TYPE_8UINT
+        rsgislib.segmentation.clump(
+            kMeansFileZonesNoSgls, initClumpsFile, gdalformat, process_in_mem, 0
         )
 
-        print("Create Input Image Mask.")
-        bandMathBands = [
-            rsgislib.imagecalc.BandDefn(
-                band_name="b1", input_img=inputImgBands, img_band=1
-            )
-        ]
-        rsgislib.imagecalc.band_math(
-            strchMaskFile, "b1==0?1:0", gdalformat, rsgislib.TYPE_8UINT, bandMathBands
+        # Elimininate small clumps
+        print("Eliminate small pixels.")
+        elimClumpsFile = os.path.join(
+            tmp_dir, "{}_clumps_elim.{}".format(basename, out_file_ext)
         )
-
-        print("Mask stretched Image.")
-        rsgislib.imageutils.mask_img(
-            strchFileOffset,
-            strchMaskFile,
+        rsgislib.segmentation.rm_small_clumps_stepwise(
             segmentFile,
+            initClumpsFile,
+            elimClumpsFile,
             gdalformat,
-            rsgislib.TYPE_8UINT,
-            0,
-            1,
+            False,
+            "",
+            False,
+            process_in_mem,
+            min_n_pxls,
+            dist_thres,
         )
 
-        if not no_delete:
-            # Deleting extra files
-            rsgislib.tools.filetools.delete_file_with_basename(strchFile)
-            rsgislib.tools.filetools.delete_file_with_basename(strchFileOffset)
-            rsgislib.tools.filetools.delete_file_with_basename(strchMaskFile)
-
-    # Perform KMEANS
-    print("Performing KMeans.")
-    outMatrixFile = os.path.join(tmp_dir, "{}_kmeansclusters".format(basename))
-    if save_process_stats:
-        outMatrixFile = kmeans_centres
-    rsgislib.imagecalc.kmeans_clustering(
-        segmentFile,
-        outMatrixFile,
-        num_clusters,
-        km_max_iter,
-        sampling,
-        True,
-        0.0025,
-        rsgislib.imagecalc.INITCLUSTER_DIAGONAL_FULL_ATTACH,
-    )
-
-    # Apply KMEANS
-    print("Apply KMeans to image.")
-    kMeansFileZones = os.path.join(
-        tmp_dir, "{}_kmeans.{}".format(basename, out_file_ext)
-    )
-    rsgislib.segmentation.label_pixels_from_cluster_centres(
-        segmentFile, kMeansFileZones, outMatrixFile + str(".gmtxt"), True, gdalformat
-    )
-
-    # Eliminate Single Pixels
-    print("Eliminate Single Pixels.")
-    kMeansFileZonesNoSgls = os.path.join(
-        tmp_dir, "{}_kmeans_nosgl.{}".format(basename, out_file_ext)
-    )
-    kMeansFileZonesNoSglsTmp = os.path.join(
-        tmp_dir, "{}_kmeans_nosgl_tmp.{}".format(basename, out_file_ext)
-    )
-    rsgislib.segmentation.eliminate_single_pixels(
-        segmentFile,
-        kMeansFileZones,
-        kMeansFileZonesNoSgls,
-        kMeansFileZonesNoSglsTmp,
-        gdalformat,
-        process_in_mem,
-        True,
-    )
-
-    # Clump
-    print("Perform clump.")
-    initClumpsFile = os.path.join(
-        tmp_dir, "{}_clumps.{}".format(basename, out_file_ext)
-    )
-    rsgislib.segmentation.clump(
-        kMeansFileZonesNoSgls, initClumpsFile, gdalformat, process_in_mem, 0
-    )
-
-    # Elimininate small clumps
-    print("Eliminate small pixels.")
-    elimClumpsFile = os.path.join(
-        tmp_dir, "{}_clumps_elim.{}".format(basename, out_file_ext)
-    )
-    rsgislib.segmentation.rm_small_clumps_stepwise(
-        segmentFile,
-        initClumpsFile,
-        elimClumpsFile,
-        gdalformat,
-        False,
-        "",
-        False,
-        process_in_mem,
-        min_n_pxls,
-        dist_thres,
-    )
-
-    # Relabel clumps
-    print("Relabel clumps.")
-    rsgislib.segmentation.relabel_clumps(
-        elimClumpsFile, out_clumps_img, gdalformat, process_in_mem
-    )
+        # Relabel clumps
+        print("Relabel clumps.")
+        rsgislib.segmentation.relabel_clumps(
+            elimClumpsFile, out_clumps_img, gdalformat, process_in_mem
+        )
 
-    # Populate with stats if required.
-    if calc_stats:
-        print("Calculate image statistics and build pyramids.")
-        rsgislib.rastergis.pop_rat_img_stats(out_clumps_img, True, True)
+        # Populate with stats if required.
+        if calc_stats:
+            print("Calculate image statistics and build pyramids.")
+            rsgislib.rastergis.pop_rat_img_stats(out_clumps_img, True, True)
 
     # Create mean image if required.
     if out_mean_img is not None:
@@ -377,7 +408,7 @@ def run_shepherd_segmentation(
 
         gdalDS = None
 
-    if not no_delete:
+    if (not process_in_mem) and (not no_delete):
         # Deleting extra files
         if not save_process_stats:
             rsgislib.tools.filetools.delete_file_with_basename(
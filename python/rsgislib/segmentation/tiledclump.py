@@ -104,7 +104,7 @@ def perform_clumping_single_thread(
         clumpedTile = os.path.join(tilesClumpsDIR, tilBaseName + "_clumps.kea")
         segmentation.clump(tile, clumpedTile, "KEA", True, 0, True)
 
-    clumpTiles = glob.glob(os.path.join(tilesClumpsDIR, "*_clumps.kea"))
+    clumpTiles = sorted(glob.glob(os.path.join(tilesClumpsDIR, "*_clumps.kea")))
     print("Create Blank Image")
     imageutils.create_copy_img(
         input_img, initMergedClumps, 1, 0, "KEA", rsgislib.TYPE_32UINT
@@ -204,7 +204,7 @@ def perform_clumping_multi_process(
     with Pool(n_cores) as p:
         p.map(_clump_img_func, clumpImgsVals)
 
-    clumpTiles = glob.glob(os.path.join(tilesClumpsDIR, "*_clumps.kea"))
+    clumpTiles = sorted(glob.glob(os.path.join(tilesClumpsDIR, "*_clumps.kea")))
     print("Create Blank Image")
     imageutils.create_copy_img(
         input_img, initMergedClumps, 1, 0, "KEA", rsgislib.TYPE_32UINT
@@ -296,7 +296,7 @@ def perform_union_clumping_single_thread(
         clumpedTile = os.path.join(tilesClumpsDIR, tilBaseName + "_clumps.kea")
         segmentation.union_of_clumps([tile, in_ref_img], clumpedTile, "KEA", 0, True)
 
-    clumpTiles = glob.glob(os.path.join(tilesClumpsDIR, "*_clumps.kea"))
+    clumpTiles = sorted(glob.glob(os.path.join(tilesClumpsDIR, "*_clumps.kea")))
     print("Create Blank Image")
     imageutils.create_copy_img(
         input_img, initMergedClumps, 1, 0, "KEA", rsgislib.TYPE_32UINT
@@ -400,7 +400,7 @@ def perform_union_clumping_multi_process(
     with Pool(n_cores) as p:
         p.map(_union_clump_img_func, clumpImgsVals)
 
-    clumpTiles = glob.glob(os.path.join(tilesClumpsDIR, "*_clumps.kea"))
+    clumpTiles = sorted(glob.glob(os.path.join(tilesClumpsDIR, "*_clumps.kea")))
     print("Create Blank Image")
     imageutils.create_copy_img(
         input_img, initMergedClumps, 1, 0, "KEA", rsgislib.TYPE_32UINT
@@ -723,3 +723,112 @@ def perform_tiled_segmentation(
     rsgislib.tools.filetools.delete_file_silent(tileSegInfo)
     if createdTmp:
         shutil.rmtree(tmp_dir)
+
+
+def perform_tiled_segmentation_threaded(
+    clusters_img,
+    spectral_img,
+    clumps_img,
+    tmp_dir="segtmp",
+    tile_width=2000,
+    tile_height=2000,
+    tile_overlap=100,
+    min_pxls=100,
+    dist_thres=100,
+    img_stretch_stats=None,
+    n_threads=0,
+):
+    """
+    Utility function to segment an image as a set of tiles which are segmented
+    concurrently on a pool of threads within this process (see
+    rsgislib.segmentation.create_seg_tile_plan, run_seg_tile_jobs and
+    merge_seg_tile_plan). The clumps within the body of each tile are kept
+    while the clumps on the boundaries between the tiles are segmented again as
+    a single region when the tiles are merged. The tiles are merged one at a
+    time in spatial order, so the whole output is never held in memory.
+
+    :param clusters_img: is a string containing the name of the image to be clumped
+                         (e.g., the pixels labelled with the k-means cluster centres
+                         using rsgislib.segmentation.label_pixels_from_cluster_centres;
+                         0 is no data).
+    :param spectral_img: is a string containing the name of the image used to
+                         eliminate the small clumps (e.g., the stretched image).
+    :param clumps_img: is a string containing the name of the output clump file.
+    :param tmp_dir: is a file path for intermediate files (default is to create a
+                    directory 'segtmp'). If path does current not exist then it will
+                    be created and deleted afterwards.
+    :param tile_width: is an int specifying the width of the tiles used for
+                       processing (Default 2000)
+    :param tile_height: is an int specifying the height of the tiles used for
+                        processing (Default 2000)
+    :param tile_overlap: is an int specifying the number of pixels each tile is
+                         extended by on the sides shared with another tile
+                         (Default 100)
+    :param min_pxls: is an int which specifies the minimum number pixels within a
+                     segments (default = 100).
+    :param dist_thres: specifies the distance threshold for joining the segments
+                       (default = 100, set to large number to turn off this option).
+    :param img_stretch_stats: is an optional string with the file name and path of
+                              the image stretch stats used when eliminating the
+                              small clumps.
+    :param n_threads: is the number of threads used to segment the tiles (0, the
+                      default, uses all the hardware threads).
+
+    .. code:: python
+
+        from rsgislib.segmentation import tiledsegsingle
+
+        tiledsegsingle.perform_tiled_segmentation_threaded('kmeans_labels.kea', 'stretched.kea', 'clumps.kea', tmp_dir='rsgislibsegtmp', n_threads=4)
+
+    """
+    import rsgislib.tools.filetools
+    import rsgislib.tools.utils
+
+    createdTmp = False
+    if not os.path.exists(tmp_dir):
+        os.makedirs(tmp_dir)
+        createdTmp = True
+    uidStr = rsgislib.tools.utils.uid_generator()
+
+    baseName = os.path.splitext(os.path.basename(clusters_img))[0] + "_" + uidStr
+    tilesDIR = os.path.join(tmp_dir, "segtiles_" + uidStr)
+    if not os.path.exists(tilesDIR):
+        os.makedirs(tilesDIR)
+    manifestFile = os.path.join(tmp_dir, baseName + "_tileplan.txt")
+
+    use_stch_stats = img_stretch_stats is not None
+    if img_stretch_stats is None:
+        img_stretch_stats = ""
+
+    segmentation.create_seg_tile_plan(
+        clusters_img,
+        spectral_img,
+        manifestFile,
+        os.path.join(tilesDIR, baseName + "_tile"),
+        "KEA",
+        "kea",
+        tile_width,
+        tile_height,
+        tile_overlap,
+    )
+    segmentation.run_seg_tile_jobs(
+        manifestFile,
+        min_pxls,
+        dist_thres,
+        use_stch_stats=use_stch_stats,
+        stch_stats_file=img_stretch_stats,
+        n_threads=n_threads,
+    )
+    segmentation.merge_seg_tile_plan(
+        manifestFile,
+        clumps_img,
+        min_pxls,
+        dist_thres,
+        use_stch_stats=use_stch_stats,
+        stch_stats_file=img_stretch_stats,
+    )
+
+    shutil.rmtree(tilesDIR)
+    rsgislib.tools.filetools.delete_file_silent(manifestFile)
+    if createdTmp:
+        shutil.rmtree(tmp_dir)
@@ -11,7 +11,6 @@ import tqdm
 from osgeo import gdal, ogr
 
 import rsgislib
-import rsgislib.vectorutils
 
 gdal.UseExceptions()
 
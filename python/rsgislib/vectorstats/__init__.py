@@ -4,7 +4,7 @@ The vector stats module provides tools to calculate statistics on vector dataset
 """
 
 import numpy
-import rsgislib.vectorutils
+import rsgislib
 
 
 def calc_empirical_semivariogram(
@@ -15,12 +15,6 @@ from osgeo import gdal, ogr, osr
 # Import the RSGISLib module
 import rsgislib
 
-# Import the RSGISLib Image Utils module
-import rsgislib.imageutils
-
-# Import the RSGISLib RasterGIS module
-import rsgislib.rastergis
-
 # import the C++ extension into this level
 from ._vectorutils import *
 
@@ -50,7 +50,6 @@ import tqdm
 from osgeo import gdal, ogr, osr
 
 import rsgislib
-import rsgislib.imageutils
 
 # import the C++ extension into this level
 from ._zonalstats import *
@@ -1506,6 +1505,44 @@ def ext_point_band_values(
 
         out_field_idx = vec_lyr_obj.FindFieldIndex(out_field.lower(), True)
 
+        # Read the point locations and sample them together so each image
+        # block is only read once.
+        x_pts = list()
+        y_pts = list()
+        vec_lyr_obj.ResetReading()
+        feat = vec_lyr_obj.GetNextFeature()
+        while feat is not None:
+            feat_geom = feat.geometry()
+            if feat_geom is not None:
+                x_pt = feat_geom.GetX()
+                y_pt = feat_geom.GetY()
+
+                if pt_reprj:
+                    x_pt, y_pt = rsgislib.tools.geometrytools.reproj_point(
+                        veclyr_spatial_ref, img_spatial_ref, x_pt, y_pt
+                    )
+                x_pts.append(x_pt)
+                y_pts.append(y_pt)
+            feat = vec_lyr_obj.GetNextFeature()
+
+        x_pts = numpy.array(x_pts, dtype=numpy.float64)
+        y_pts = numpy.array(y_pts, dtype=numpy.float64)
+        # Points on the top or left edge of the image are in the first pixel
+        # (i.e., allowing for floating-point error).
+        x_pts_off = x_pts - imgGeoTrans[0]
+        y_pts_off = y_pts - imgGeoTrans[3]
+        x_pts[numpy.isclose(x_pts_off, 0.0, rtol=1e-09, atol=1e-09)] = imgGeoTrans[0]
+        y_pts[numpy.isclose(y_pts_off, 0.0, rtol=1e-09, atol=1e-09)] = imgGeoTrans[3]
+        x_pxls = numpy.floor((x_pts - imgGeoTrans[0]) / pixel_width)
+        y_pxls = numpy.floor((y_pts - imgGeoTrans[3]) / pixel_height)
+        pts_in_img = (
+            (x_pxls >= 0) & (x_pxls < imgSizeX) & (y_pxls >= 0) & (y_pxls < imgSizeY)
+        )
+
+        pxl_vals = rsgislib.imageutils.sample_img_points(
+            input_img, x_pts, y_pts, img_bands=[img_band], no_data_val=out_no_data_val
+        )[:, 0]
+
         # Iterate through features.
         openTransaction = False
         transactionStep = 20000
@@ -1513,6 +1550,7 @@ def ext_point_band_values(
         nFeats = vec_lyr_obj.GetFeatureCount(True)
         pbar = tqdm.tqdm(total=nFeats)
         counter = 0
+        pt_idx = 0
         vec_lyr_obj.ResetReading()
         feat = vec_lyr_obj.GetNextFeature()
         while feat is not None:
@@ -1523,42 +1561,8 @@ def ext_point_band_values(
             if feat is not None:
                 feat_geom = feat.geometry()
                 if feat_geom is not None:
-                    pt_in_img = True
-                    x_pt = feat_geom.GetX()
-                    y_pt = feat_geom.GetY()
-
-                    if pt_reprj:
-                        x_pt, y_pt = rsgislib.tools.geometrytools.reproj_point(
-                            veclyr_spatial_ref, img_spatial_ref, x_pt, y_pt
-                        )
-
-                    x_pt_off = float(x_pt - imgGeoTrans[0])
-                    y_pt_off = float(y_pt - imgGeoTrans[3])
-
-                    if math.isclose(x_pt_off, 0.0, rel_tol=1e-09, abs_tol=1e-09):
-                        x_pxl = 0
-                    else:
-                        x_pxl = int(math.floor(x_pt_off / pixel_width))
-
-                    if math.isclose(y_pt_off, 0.0, rel_tol=1e-09, abs_tol=1e-09):
-                        y_pxl = 0
-                    else:
-                        y_pxl = int(math.floor(y_pt_off / pixel_height))
-
-                    if x_pxl < 0:
-                        pt_in_img = False
-                    elif x_pxl >= imgSizeX:
-                        pt_in_img = False
-
-                    if y_pxl < 0:
-                        pt_in_img = False
-                    elif y_pxl >= imgSizeY:
-                        pt_in_img = False
-
-                    if pt_in_img:
-                        src_offset = (x_pxl, y_pxl, 1, 1)
-                        src_array = img_band_obj.ReadAsArray(*src_offset)
-                        pxl_val = src_array[0][0]
+                    if pts_in_img[pt_idx]:
+                        pxl_val = pxl_vals[pt_idx]
                         out_val = float(pxl_val)
                         if pxl_val == imgNoDataVal:
                             out_val = out_no_data_val
@@ -1570,6 +1574,7 @@ def ext_point_band_values(
                         feat.SetField(out_field_idx, out_val)
                     else:
                         feat.SetField(out_field_idx, out_no_data_val)
+                    pt_idx = pt_idx + 1
 
                     vec_lyr_obj.SetFeature(feat)
 
@@ -1764,11 +1769,16 @@ def extract_chip_zone_image_band_values_to_hdf(
     output_hdf: str,
     rotate_chips: List[float] = None,
     datatype: int = None,
+    n_threads: int = 1,
 ):
     """
     A function which extracts a chip/window of image pixel values. The expectation is
     that this is used to train a classifier (see deep learning functions
     in classification) but it could be used to extract image 'chips' for other purposes.
+    Where the chips are not rotated they are extracted using
+    rsgislib.zonalstats.extract_chip_zone_img_band_values_to_hdf, which reads each
+    image block once, where the chips are in the order of the mask pixels (row by row)
+    and the input images need to be on the pixel grid of the mask.
 
     :param input_image_info: is a list of rsgislib.imageutils.ImageBandInfo objects
                              specifying the input images and bands
@@ -1786,16 +1796,30 @@ def extract_chip_zone_image_band_values_to_hdf(
     :param datatype: is the data type used for the output HDF5 file (e.g.,
                      rsgislib.TYPE_32FLOAT). If None (default)
                      then the output data type will be float32.
+    :param n_threads: the number of threads used to cut the chips when they are
+                      not rotated.
 
     """
+    if datatype is None:
+        datatype = rsgislib.TYPE_32FLOAT
+
+    if rotate_chips is None:
+        extract_chip_zone_img_band_values_to_hdf(
+            input_image_info,
+            image_mask,
+            mask_value,
+            chip_size,
+            output_hdf,
+            datatype,
+            n_threads=n_threads,
+        )
+        return
+
     # Import the RIOS image reader
     import h5py
     import tqdm
     from rios.imagereader import ImageReader
 
-    if datatype is None:
-        datatype = rsgislib.TYPE_32FLOAT
-
     chip_size_odd = False
     if (chip_size % 2) != 0:
         chip_size_odd = True
@@ -2203,11 +2227,16 @@ def extract_ref_chip_zone_image_band_values_to_hdf(
     output_hdf: str,
     rotate_chips: List[float] = None,
     datatype: int = None,
+    n_threads: int = 1,
 ):
     """
     A function which extracts a chip/window of image pixel values. The expectation is
     that this is used to train a classifier (see deep learning functions in
     classification) but it could be used to extract image 'chips' for other purposes.
+    Where the chips are not rotated they are extracted using
+    rsgislib.zonalstats.extract_chip_zone_img_band_values_to_hdf, which reads each
+    image block once, where the chips are in the order of the mask pixels (row by row)
+    and the input images need to be on the pixel grid of the mask.
 
     :param input_image_info: is a list of rsgislib.imageutils.ImageBandInfo objects
                              specifying the input images and bands
@@ -2229,19 +2258,35 @@ def extract_ref_chip_zone_image_band_values_to_hdf(
     :param datatype: is the data type used for the output HDF5 file
                      (e.g., rsgislib.TYPE_32FLOAT). If None (default)
                      then the output data type will be float32.
+    :param n_threads: the number of threads used to cut the chips when they are
+                      not rotated.
 
     """
-    # Import the RIOS image reader
-    import h5py
-    import tqdm
-    from rios.imagereader import ImageReader
-
     if datatype is None:
         datatype = rsgislib.TYPE_32FLOAT
 
     if (chip_size % 2) != 0:
         raise rsgislib.RSGISPyException("The chip size must be an even number.")
 
+    if rotate_chips is None:
+        extract_chip_zone_img_band_values_to_hdf(
+            input_image_info,
+            image_mask,
+            mask_value,
+            chip_size,
+            output_hdf,
+            datatype,
+            ref_img=ref_img,
+            ref_img_band=ref_img_band,
+            n_threads=n_threads,
+        )
+        return
+
+    # Import the RIOS image reader
+    import h5py
+    import tqdm
+    from rios.imagereader import ImageReader
+
     chipHSize = math.floor(chip_size / 2)
 
     rotate = False
@@ -23,6 +23,8 @@
 #include "rsgispy_common.h"
 #include "cmds/RSGISCmdClassification.h"
 #include <vector>
+#include <map>
+#include <algorithm>
 
 /* An exception object for this module */
 /* created in the init function */
@@ -75,6 +77,7 @@ static PyObject *Classification_CollapseClasses(PyObject *self, PyObject *args,
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCollapseRAT2Class(std::string(pszInputImage), std::string(pszOutputFile),
                                               std::string(pszGDALFormat), std::string(pszClassesColumn),
                                               classIntColStr, classIntColPresent);
@@ -100,6 +103,7 @@ static PyObject *Classification_Colour3Bands(PyObject *self, PyObject *args, PyO
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeGenerate3BandFromColourTable(std::string(pszInputImage), std::string(pszOutputFile),
                                                          std::string(pszGDALFormat));
     }
@@ -133,6 +137,7 @@ static PyObject *Classification_GenRandomAccuracyPts(PyObject *self, PyObject *a
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeGenerateRandomAccuracyPts(std::string(pszInputImage), std::string(pszOutputVecFile),
                                                       std::string(pszOutputVecLyr), std::string(pszFormat),
                                                       std::string(pszClassImgCol), std::string(pszClassImgVecCol),
@@ -170,6 +175,7 @@ static PyObject *Classification_GenStratifiedRandomAccuracyPts(PyObject *self, P
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeGenerateStratifiedRandomAccuracyPts(std::string(pszInputImage), std::string(pszOutputVecFile),
                                                                 std::string(pszOutputVecLyr), std::string(pszFormat),
                                                                 std::string(pszClassImgCol), std::string(pszClassImgVecCol),
@@ -207,6 +213,7 @@ static PyObject *Classification_GenStratifiedPropRandomAccuracyPts(PyObject *sel
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeGenerateStratifiedPropRandomAccuracyPts(std::string(pszInputImage), std::string(pszOutputVecFile),
                                                                 std::string(pszOutputVecLyr), std::string(pszFormat),
                                                                 std::string(pszClassImgCol), std::string(pszClassImgVecCol),
@@ -257,6 +264,7 @@ static PyObject *Classification_PopClassInfoAccuracyPts(PyObject *self, PyObject
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executePopClassInfoAccuracyPts(std::string(pszInputImage), std::string(pszVecFile),
                                                     std::string(pszVecLyr), std::string(pszClassImgCol),
                                                     std::string(pszClassImgVecCol),
@@ -272,8 +280,501 @@ static PyObject *Classification_PopClassInfoAccuracyPts(PyObject *self, PyObject
     Py_RETURN_NONE;
 }
 
+// Calls predict_func (from a thread without the GIL, which is reacquired) with a
+// (read only) memory view of the features (float32 or float64, as given by format)
+// and copies the C contiguous array returned, with numOutputs values for each sample,
+// to outputs. Throws leaving the Python error set if predict_func fails.
+template<typename T>
+static void Classification_CallPredictFunc(PyObject *pPredictFunc, PyObject *pError, char format, const T *features, size_t numSamples, unsigned int numFeatures, unsigned int numOutputs, T *outputs)
+{
+    PyGILState_STATE gilState = PyGILState_Ensure();
+    Py_ssize_t shape[2] = {(Py_ssize_t)numSamples, (Py_ssize_t)numFeatures};
+    Py_ssize_t strides[2] = {(Py_ssize_t)(numFeatures*sizeof(T)), (Py_ssize_t)sizeof(T)};
+    Py_buffer featsView;
+    featsView.buf = (void*)features;
+    featsView.obj = nullptr;
+    featsView.len = numSamples*numFeatures*sizeof(T);
+    featsView.itemsize = sizeof(T);
+    featsView.readonly = 1;
+    featsView.ndim = 2;
+    featsView.format = (char*)((format == 'd')?"d":"f");
+    featsView.shape = shape;
+    featsView.strides = strides;
+    featsView.suboffsets = nullptr;
+    featsView.internal = nullptr;
+    
+    bool ok = false;
+    PyObject *pFeats = PyMemoryView_FromBuffer(&featsView);
+    if(pFeats != nullptr)
+    {
+        PyObject *pResult = PyObject_CallFunctionObjArgs(pPredictFunc, pFeats, nullptr);
+        if(pResult != nullptr)
+        {
+            RSGISPyArrayBuffer resultBuf;
+            if(resultBuf.getBuffer(pResult, format, false, pError, "predict_func return value"))
+            {
+                if(resultBuf.getNumItems() == (numSamples*numOutputs))
+                {
+                    const T *resultData = (const T*)resultBuf.getData();
+                    std::copy(resultData, resultData + (numSamples*numOutputs), outputs);
+                    ok = true;
+                }
+                else
+                {
+                    PyErr_SetString(pError, "predict_func did not return the expected number of values for each sample.");
+                }
+            }
+            Py_DECREF(pResult);
+        }
+        // The features are only valid during the call so release the view, which
+        // fails (and is ignored) if predict_func has kept a reference to it.
+        PyObject *pErrType, *pErrValue, *pErrTraceback;
+        PyErr_Fetch(&pErrType, &pErrValue, &pErrTraceback);
+        PyObject *pRelease = PyObject_CallMethod(pFeats, "release", nullptr);
+        Py_XDECREF(pRelease);
+        PyErr_Clear();
+        PyErr_Restore(pErrType, pErrValue, pErrTraceback);
+        Py_DECREF(pFeats);
+    }
+    PyGILState_Release(gilState);
+    if(!ok)
+    {
+        throw rsgis::cmds::RSGISCmdException("predict_func failed.");
+    }
+}
+
+static PyObject *Classification_ApplyBatchPredictor(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("img_file_info"), RSGIS_PY_C_TEXT("in_msk_img"),
+                             RSGIS_PY_C_TEXT("img_msk_val"), RSGIS_PY_C_TEXT("predict_func"),
+                             RSGIS_PY_C_TEXT("out_imgs"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("batch_size"), RSGIS_PY_C_TEXT("no_data_val"),
+                             RSGIS_PY_C_TEXT("out_no_data_val"), nullptr};
+    PyObject *pImgFileInfoObj, *pMskImgObj, *pPredictFunc, *pOutImgsObj;
+    int mskVal;
+    const char *pszGDALFormat;
+    unsigned int batchSize = 65536;
+    PyObject *pNoDataValObj = Py_None;
+    float outNoDataVal = 0;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "OOiOOs|IOf:apply_batch_predictor", kwlist, &pImgFileInfoObj, &pMskImgObj,
+                                     &mskVal, &pPredictFunc, &pOutImgsObj, &pszGDALFormat, &batchSize, &pNoDataValObj, &outNoDataVal))
+    {
+        return nullptr;
+    }
+    
+    if(!PyCallable_Check(pPredictFunc))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "predict_func must be callable.");
+        return nullptr;
+    }
+    
+    std::string maskImage = "";
+    if(pMskImgObj != Py_None)
+    {
+        if(!RSGISPY_CHECK_STRING(pMskImgObj))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "in_msk_img must be a string or None.");
+            return nullptr;
+        }
+        maskImage = RSGISPY_STRING_EXTRACT(pMskImgObj);
+    }
+    
+    bool useNoData = false;
+    float noDataVal = 0;
+    if(pNoDataValObj != Py_None)
+    {
+        noDataVal = PyFloat_AsDouble(pNoDataValObj);
+        if(PyErr_Occurred())
+        {
+            PyErr_SetString(GETSTATE(self)->error, "no_data_val must be a number or None.");
+            return nullptr;
+        }
+        useNoData = true;
+    }
+    
+    if(!PySequence_Check(pImgFileInfoObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "img_file_info must be a sequence");
+        return nullptr;
+    }
+    std::vector<std::string> inputImages;
+    std::vector<std::vector<unsigned int> > inputBands;
+    Py_ssize_t nImgs = PySequence_Size(pImgFileInfoObj);
+    for( Py_ssize_t n = 0; n < nImgs; n++ )
+    {
+        PyObject *o = PySequence_GetItem(pImgFileInfoObj, n);
+        
+        PyObject *pFileName = PyObject_GetAttrString(o, "file_name");
+        if( ( pFileName == nullptr ) || ( pFileName == Py_None ) || !RSGISPY_CHECK_STRING(pFileName) )
+        {
+            PyErr_SetString(GETSTATE(self)->error, "could not find string attribute \'file_name\'" );
+            Py_XDECREF(pFileName);
+            Py_DECREF(o);
+            return nullptr;
+        }
+        
+        PyObject *pBands = PyObject_GetAttrString(o, "bands");
+        if( ( pBands == nullptr ) || ( pBands == Py_None ) || !PySequence_Check(pBands) )
+        {
+            PyErr_SetString(GETSTATE(self)->error, "could not find list attribute \'bands\'" );
+            Py_DECREF(pFileName);
+            Py_XDECREF(pBands);
+            Py_DECREF(o);
+            return nullptr;
+        }
+        
+        std::vector<unsigned int> bands;
+        Py_ssize_t nBands = PySequence_Size(pBands);
+        for( Py_ssize_t i = 0; i < nBands; i++ )
+        {
+            PyObject *pBand = PySequence_GetItem(pBands, i);
+            if( !RSGISPY_CHECK_INT(pBand) )
+            {
+                PyErr_SetString(GETSTATE(self)->error, "the \'bands\' must be integers" );
+                Py_DECREF(pBand);
+                Py_DECREF(pFileName);
+                Py_DECREF(pBands);
+                Py_DECREF(o);
+                return nullptr;
+            }
+            bands.push_back(RSGISPY_UINT_EXTRACT(pBand));
+            Py_DECREF(pBand);
+        }
+        
+        inputImages.push_back(RSGISPY_STRING_EXTRACT(pFileName));
+        inputBands.push_back(bands);
+        
+        Py_DECREF(pFileName);
+        Py_DECREF(pBands);
+        Py_DECREF(o);
+    }
+    
+    if(!PySequence_Check(pOutImgsObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "out_imgs must be a sequence");
+        return nullptr;
+    }
+    std::vector<std::string> outputImages;
+    std::vector<unsigned int> outNumBands;
+    std::vector<rsgis::RSGISLibDataType> outDataTypes;
+    unsigned int numOutputs = 0;
+    Py_ssize_t nOutImgs = PySequence_Size(pOutImgsObj);
+    for( Py_ssize_t n = 0; n < nOutImgs; n++ )
+    {
+        PyObject *o = PySequence_GetItem(pOutImgsObj, n);
+        const char *pszOutImg;
+        unsigned int nBands;
+        int nDataType;
+        if( !PyArg_ParseTuple(o, "sIi", &pszOutImg, &nBands, &nDataType) )
+        {
+            PyErr_SetString(GETSTATE(self)->error, "out_imgs must be a list of (file name, number of bands, datatype) tuples" );
+            Py_DECREF(o);
+            return nullptr;
+        }
+        outputImages.push_back(std::string(pszOutImg));
+        outNumBands.push_back(nBands);
+        outDataTypes.push_back((rsgis::RSGISLibDataType)nDataType);
+        numOutputs += nBands;
+        Py_DECREF(o);
+    }
+    
+    PyObject *pError = GETSTATE(self)->error;
+    auto predictFunc = [pPredictFunc, pError, numOutputs](const float *features, size_t numSamples, unsigned int numFeatures, float *outputs)
+    {
+        Classification_CallPredictFunc<float>(pPredictFunc, pError, 'f', features, numSamples, numFeatures, numOutputs, outputs);
+    };
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeBatchPredictImage(inputImages, inputBands, maskImage, mskVal, predictFunc, outputImages,
+                                              outNumBands, outDataTypes, std::string(pszGDALFormat), batchSize,
+                                              useNoData, noDataVal, outNoDataVal);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        // Keep the error raised within predict_func (if there is one).
+        if(!PyErr_Occurred())
+        {
+            PyErr_SetString(GETSTATE(self)->error, e.what());
+        }
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *Classification_ApplyRATBatchPredictor(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("clumps_img"), RSGIS_PY_C_TEXT("variables"),
+                             RSGIS_PY_C_TEXT("predict_func"), RSGIS_PY_C_TEXT("out_col_int"),
+                             RSGIS_PY_C_TEXT("roi_col"), RSGIS_PY_C_TEXT("roi_val"),
+                             RSGIS_PY_C_TEXT("cls_info"), RSGIS_PY_C_TEXT("out_col_str"),
+                             RSGIS_PY_C_TEXT("class_colours"), RSGIS_PY_C_TEXT("chunk_size"),
+                             RSGIS_PY_C_TEXT("rat_band"), nullptr};
+    const char *pszClumpsImage, *pszOutColInt;
+    PyObject *pVariablesObj, *pPredictFunc;
+    PyObject *pROIColObj = Py_None;
+    int roiVal = 1;
+    PyObject *pClsInfoObj = Py_None;
+    PyObject *pOutColStrObj = Py_None;
+    int classColours = false;
+    unsigned int chunkSize = 100000;
+    unsigned int ratBand = 1;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sOOs|OiOOpII:apply_rat_batch_predictor", kwlist, &pszClumpsImage, &pVariablesObj,
+                                     &pPredictFunc, &pszOutColInt, &pROIColObj, &roiVal, &pClsInfoObj, &pOutColStrObj,
+                                     &classColours, &chunkSize, &ratBand))
+    {
+        return nullptr;
+    }
+    
+    if(!PyCallable_Check(pPredictFunc))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "predict_func must be callable.");
+        return nullptr;
+    }
+    
+    if(!PySequence_Check(pVariablesObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "variables must be a sequence");
+        return nullptr;
+    }
+    std::vector<std::string> featCols;
+    Py_ssize_t nVariables = PySequence_Size(pVariablesObj);
+    for( Py_ssize_t n = 0; n < nVariables; n++ )
+    {
+        PyObject *o = PySequence_GetItem(pVariablesObj, n);
+        if( !RSGISPY_CHECK_STRING(o) )
+        {
+            PyErr_SetString(GETSTATE(self)->error, "variables must be a list of column names");
+            Py_DECREF(o);
+            return nullptr;
+        }
+        featCols.push_back(RSGISPY_STRING_EXTRACT(o));
+        Py_DECREF(o);
+    }
+    
+    std::string roiCol = "";
+    if(pROIColObj != Py_None)
+    {
+        if(!RSGISPY_CHECK_STRING(pROIColObj))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "roi_col must be a string or None.");
+            return nullptr;
+        }
+        roiCol = RSGISPY_STRING_EXTRACT(pROIColObj);
+    }
+    
+    std::string outColStr = "";
+    if(pOutColStrObj != Py_None)
+    {
+        if(!RSGISPY_CHECK_STRING(pOutColStrObj))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "out_col_str must be a string or None.");
+            return nullptr;
+        }
+        outColStr = RSGISPY_STRING_EXTRACT(pOutColStrObj);
+    }
+    
+    std::map<int, rsgis::cmds::RSGISCmdClassInfo> classes;
+    if(pClsInfoObj != Py_None)
+    {
+        if(!PyDict_Check(pClsInfoObj))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "cls_info must be a dict or None.");
+            return nullptr;
+        }
+        PyObject *pKey, *pValue;
+        Py_ssize_t pos = 0;
+        while(PyDict_Next(pClsInfoObj, &pos, &pKey, &pValue))
+        {
+            const char *pszClsName;
+            rsgis::cmds::RSGISCmdClassInfo clsInfo;
+            if( !RSGISPY_CHECK_INT(pKey) || !PyArg_ParseTuple(pValue, "siii", &pszClsName, &clsInfo.red, &clsInfo.green, &clsInfo.blue) )
+            {
+                PyErr_SetString(GETSTATE(self)->error, "cls_info must be a dict of class id: (name, red, green, blue)" );
+                return nullptr;
+            }
+            clsInfo.name = std::string(pszClsName);
+            classes[RSGISPY_INT_EXTRACT(pKey)] = clsInfo;
+        }
+    }
+    
+    PyObject *pError = GETSTATE(self)->error;
+    auto predictFunc = [pPredictFunc, pError](const double *features, size_t numSamples, unsigned int numFeatures, double *outputs)
+    {
+        Classification_CallPredictFunc<double>(pPredictFunc, pError, 'd', features, numSamples, numFeatures, 1, outputs);
+    };
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeBatchPredictRAT(std::string(pszClumpsImage), featCols, predictFunc, std::string(pszOutColInt),
+                                            roiCol, roiVal, classes, outColStr, classColours, chunkSize, ratBand);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        // Keep the error raised within predict_func (if there is one).
+        if(!PyErr_Occurred())
+        {
+            PyErr_SetString(GETSTATE(self)->error, e.what());
+        }
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
 
+static PyObject *Classification_DoubleVecToList(const std::vector<double> &vals)
+{
+    PyObject *pList = PyList_New(vals.size());
+    for(size_t i = 0; i < vals.size(); ++i)
+    {
+        PyList_SET_ITEM(pList, i, PyFloat_FromDouble(vals[i]));
+    }
+    return pList;
+}
 
+static PyObject *Classification_CalcImgConfusionMatrix(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("cls_img"), RSGIS_PY_C_TEXT("ref_img"),
+                             RSGIS_PY_C_TEXT("cls_ids"), RSGIS_PY_C_TEXT("cls_no_data"),
+                             RSGIS_PY_C_TEXT("ref_no_data"), RSGIS_PY_C_TEXT("strata_img"),
+                             RSGIS_PY_C_TEXT("strata_weights"), nullptr};
+    const char *pszClassImage, *pszRefImage;
+    PyObject *pClsIdsObj;
+    PyObject *pClsNoDataObj = Py_None;
+    PyObject *pRefNoDataObj = Py_None;
+    PyObject *pStrataImgObj = Py_None;
+    PyObject *pStrataWeightsObj = Py_None;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssO|OOOO:calc_img_confusion_matrix", kwlist, &pszClassImage, &pszRefImage,
+                                     &pClsIdsObj, &pClsNoDataObj, &pRefNoDataObj, &pStrataImgObj, &pStrataWeightsObj))
+    {
+        return nullptr;
+    }
+    
+    if(!PySequence_Check(pClsIdsObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "cls_ids must be a sequence");
+        return nullptr;
+    }
+    std::vector<long> classIds;
+    Py_ssize_t nClsIds = PySequence_Size(pClsIdsObj);
+    for( Py_ssize_t n = 0; n < nClsIds; n++ )
+    {
+        PyObject *o = PySequence_GetItem(pClsIdsObj, n);
+        long clsId = PyLong_AsLong(o);
+        Py_DECREF(o);
+        if((clsId == -1) && PyErr_Occurred())
+        {
+            PyErr_Clear();
+            PyErr_SetString(GETSTATE(self)->error, "cls_ids must be a list of integer class ids");
+            return nullptr;
+        }
+        classIds.push_back(clsId);
+    }
+    
+    bool useClsNoData = false;
+    float clsNoData = 0;
+    if(pClsNoDataObj != Py_None)
+    {
+        clsNoData = PyFloat_AsDouble(pClsNoDataObj);
+        if(PyErr_Occurred())
+        {
+            PyErr_Clear();
+            PyErr_SetString(GETSTATE(self)->error, "cls_no_data must be a number or None.");
+            return nullptr;
+        }
+        useClsNoData = true;
+    }
+    
+    bool useRefNoData = false;
+    float refNoData = 0;
+    if(pRefNoDataObj != Py_None)
+    {
+        refNoData = PyFloat_AsDouble(pRefNoDataObj);
+        if(PyErr_Occurred())
+        {
+            PyErr_Clear();
+            PyErr_SetString(GETSTATE(self)->error, "ref_no_data must be a number or None.");
+            return nullptr;
+        }
+        useRefNoData = true;
+    }
+    
+    std::string strataImage = "";
+    std::map<long, double> strataWeights;
+    if(pStrataImgObj != Py_None)
+    {
+        if(!RSGISPY_CHECK_STRING(pStrataImgObj))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "strata_img must be a string or None.");
+            return nullptr;
+        }
+        strataImage = RSGISPY_STRING_EXTRACT(pStrataImgObj);
+        
+        if(!PyDict_Check(pStrataWeightsObj))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "strata_weights must be a dict of stratum id: weight if strata_img is provided.");
+            return nullptr;
+        }
+        PyObject *pKey, *pValue;
+        Py_ssize_t pos = 0;
+        while(PyDict_Next(pStrataWeightsObj, &pos, &pKey, &pValue))
+        {
+            long strataId = PyLong_AsLong(pKey);
+            double weight = PyFloat_AsDouble(pValue);
+            if(PyErr_Occurred())
+            {
+                PyErr_Clear();
+                PyErr_SetString(GETSTATE(self)->error, "strata_weights must be a dict of stratum id: weight.");
+                return nullptr;
+            }
+            strataWeights[strataId] = weight;
+        }
+    }
+    
+    rsgis::cmds::RSGISCmdConfusionMatrix confMatrix;
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        confMatrix = rsgis::cmds::executeCalcClassConfusionMatrix(std::string(pszClassImage), std::string(pszRefImage), classIds, useClsNoData,
+                                                                  clsNoData, useRefNoData, refNoData, strataImage, strataWeights);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    PyObject *pClsIdsList = PyList_New(confMatrix.classIds.size());
+    for(size_t i = 0; i < confMatrix.classIds.size(); ++i)
+    {
+        PyList_SET_ITEM(pClsIdsList, i, PyLong_FromLong(confMatrix.classIds[i]));
+    }
+    PyObject *pMatrixList = PyList_New(confMatrix.matrix.size());
+    for(size_t i = 0; i < confMatrix.matrix.size(); ++i)
+    {
+        PyList_SET_ITEM(pMatrixList, i, Classification_DoubleVecToList(confMatrix.matrix[i]));
+    }
+    
+    // The 'N' format steals the references to the lists.
+    return Py_BuildValue("{s:N,s:N,s:N,s:k,s:k,s:d,s:d,s:N,s:N,s:N,s:N,s:N,s:N}",
+                         "cls_ids", pClsIdsList,
+                         "confusion_matrix", pMatrixList,
+                         "mapped_pxl_counts", Classification_DoubleVecToList(confMatrix.mappedPxlCounts),
+                         "n_compared_pxls", confMatrix.numComparedPxls,
+                         "n_unlisted_pxls", confMatrix.numUnlistedPxls,
+                         "overall_accuracy", confMatrix.overallAcc,
+                         "overall_accuracy_se", confMatrix.overallAccSE,
+                         "user_accuracy", Classification_DoubleVecToList(confMatrix.userAcc),
+                         "user_accuracy_se", Classification_DoubleVecToList(confMatrix.userAccSE),
+                         "producer_accuracy", Classification_DoubleVecToList(confMatrix.prodAcc),
+                         "producer_accuracy_se", Classification_DoubleVecToList(confMatrix.prodAccSE),
+                         "est_prop_cls_area", Classification_DoubleVecToList(confMatrix.propArea),
+                         "est_prop_cls_area_se", Classification_DoubleVecToList(confMatrix.propAreaSE));
+}
 
 // Our list of functions in this module
 static PyMethodDef ClassificationMethods[] = {
@@ -359,6 +860,58 @@ static PyMethodDef ClassificationMethods[] = {
 ":param vec_class_col: is a string specifying the output column in the vector file for the classified class names.\n"
 ":param vec_ref_col: is an optional string specifying an output column in the vector file which can be used in the accuracy assessment for the reference data.\n"
 ":param vec_process_col: is an optional string specifying an output column in the vector file which is used allocate points as processed or otherwise."
+},
+
+{"apply_batch_predictor", (PyCFunction)Classification_ApplyBatchPredictor, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.classification.apply_batch_predictor(img_file_info:list, in_msk_img:str, img_msk_val:int, predict_func, out_imgs:list, gdalformat:str, batch_size:int=65536, no_data_val:float=None, out_no_data_val:float=0)\n"
+"Applies a model (e.g., a trained scikit-learn classifier) to the pixels of a set of images.\n"
+"The features of the pixels within the mask are packed into batches of about batch_size\n"
+"pixels which are passed to predict_func, with the outputs written back to the output images.\n"
+"The images are read and written while predict_func is being called.\n"
+"\n"
+":param img_file_info: a list of rsgislib.imageutils.ImageBandInfo objects to identify the images and bands used as the features.\n"
+":param in_msk_img: an image file (band 1) specifying the region to be processed. If None then all the pixels are processed.\n"
+":param img_msk_val: the pixel value within in_msk_img of the region to be processed.\n"
+":param predict_func: a function which is given a 2D (n_samples x n_features) float32 array (only valid during the call) and returns a C contiguous float32 array of n_samples x n_outputs values, where n_outputs is the total number of bands in out_imgs.\n"
+":param out_imgs: a list of (file name, number of bands, rsgislib.TYPE_*) tuples for the output images, where the outputs of predict_func are written to the bands in order.\n"
+":param gdalformat: is a string with the output image format for the GDAL driver.\n"
+":param batch_size: the (approximate) number of pixels processed in each batch (Default: 65536).\n"
+":param no_data_val: if not None then pixels where any feature has this value (or NaN) are not processed (Default: None).\n"
+":param out_no_data_val: the output value for the pixels which are not processed (Default: 0).\n"
+},
+
+{"apply_rat_batch_predictor", (PyCFunction)Classification_ApplyRATBatchPredictor, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.classification.apply_rat_batch_predictor(clumps_img:str, variables:list, predict_func, out_col_int:str, roi_col:str=None, roi_val:int=1, cls_info:dict=None, out_col_str:str=None, class_colours:bool=False, chunk_size:int=100000, rat_band:int=1)\n"
+"Applies a classifier to the rows of a raster attribute table (RAT), a chunk of rows at a time\n"
+"so the memory used is bounded by chunk_size rather than the number of rows in the RAT.\n"
+"\n"
+":param clumps_img: is the clumps image with the RAT to be classified.\n"
+":param variables: a list of the names of the columns used as the features.\n"
+":param predict_func: a function which is given a 2D (n_rows x n_features) float64 array (only valid during the call) of the rows where all the features are finite (and within the roi) and returns a C contiguous float64 array with a class id for each row.\n"
+":param out_col_int: the output column for the class ids. The rows which are not classified are given 0.\n"
+":param roi_col: is a column name for a column which specifies the region to be classified. If None ignored (Default: None)\n"
+":param roi_val: is a int value used within the roi_col to select a region to be classified (Default: 1)\n"
+":param cls_info: an optional dict where the key is the class id and the value is a (name, red, green, blue) tuple.\n"
+":param out_col_str: if cls_info is provided, an optional output column for the class names.\n"
+":param class_colours: if cls_info is provided, whether the RAT colour table should be set to the class colours (Default: False).\n"
+":param chunk_size: the number of rows processed in each chunk (Default: 100000).\n"
+":param rat_band: the image band with the RAT (Default: 1).\n"
+},
+
+{"calc_img_confusion_matrix", (PyCFunction)Classification_CalcImgConfusionMatrix, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.classification.calc_img_confusion_matrix(cls_img:str, ref_img:str, cls_ids:list, cls_no_data:float=None, ref_no_data:float=None, strata_img:str=None, strata_weights:dict=None)\n"
+"Calculates the confusion matrix between a classification image and a (wall-to-wall) reference\n"
+"image within a single pass over the images, using multiple threads, and the area adjusted accuracy\n"
+"estimates and their standard errors (Olofsson et al., 2014).\n"
+"\n"
+":param cls_img: the single band classification image.\n"
+":param ref_img: the single band reference classification image, using the same class ids as cls_img.\n"
+":param cls_ids: a list of the class ids to be included within the confusion matrix.\n"
+":param cls_no_data: the no data value of cls_img. If None all the pixels are used (Default: None).\n"
+":param ref_no_data: the no data value of ref_img. If None all the pixels are used (Default: None). Pixels which are no data within the reference are still counted within the mapped area of each class.\n"
+":param strata_img: an optional single band image of strata. If provided, strata_weights must be provided.\n"
+":param strata_weights: a dict of stratum id: weight, where each pixel adds the weight of its stratum to the confusion matrix. Pixels within strata not in the dict are ignored.\n"
+":return: a dict with the 'cls_ids', the 'confusion_matrix' (rows are the classified classes and columns the reference classes, in the order of cls_ids), the 'mapped_pxl_counts', 'n_compared_pxls', 'n_unlisted_pxls' (pixels with a class id not within cls_ids), 'overall_accuracy', 'user_accuracy', 'producer_accuracy' and 'est_prop_cls_area' (the estimated proportion of the total area within each reference class) and their standard errors (e.g., 'overall_accuracy_se').\n"
 },
 
     {nullptr}        /* Sentinel */
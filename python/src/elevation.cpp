@@ -65,7 +65,10 @@ static PyObject *Elevation_calcSlope(PyObject *self, PyObject *args, PyObject *k
             throw rsgis::cmds::RSGISCmdException("The unit option needs to be specified as either 'degrees' or 'radians'.");
         }
         
-        rsgis::cmds::executeCalcSlope(std::string(pszInputImage), std::string(pszOutputFile), outAngleUnit, std::string(pszGDALFormat));
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeCalcSlope(std::string(pszInputImage), std::string(pszOutputFile), outAngleUnit, std::string(pszGDALFormat));
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -104,7 +107,10 @@ static PyObject *Elevation_calcSlopePxlResImg(PyObject *self, PyObject *args, Py
             throw rsgis::cmds::RSGISCmdException("The unit option needs to be specified as either 'degrees' or 'radians'.");
         }
 
-        rsgis::cmds::executeCalcSlopeImgPxlRes(std::string(pszInDEMImage), std::string(pszInPxlResImage), std::string(pszOutputFile), outAngleUnit, std::string(pszGDALFormat));
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeCalcSlopeImgPxlRes(std::string(pszInDEMImage), std::string(pszInPxlResImage), std::string(pszOutputFile), outAngleUnit, std::string(pszGDALFormat));
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -125,6 +131,7 @@ static PyObject *Elevation_calcAspect(PyObject *self, PyObject *args, PyObject *
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCalcAspect(std::string(pszInputImage), std::string(pszOutputFile), std::string(pszGDALFormat));
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -146,6 +153,7 @@ static PyObject *Elevation_calcAspectPxlResImg(PyObject *self, PyObject *args, P
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCalcAspectImgPxlRes(std::string(pszInDEMImage), std::string(pszInPxlResImage), std::string(pszOutputFile), std::string(pszGDALFormat));
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -167,6 +175,7 @@ static PyObject *Elevation_catAspect(PyObject *self, PyObject *args, PyObject *k
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCatagoriseAspect(std::string(pszInputImage), std::string(pszOutputFile), std::string(pszGDALFormat));
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -190,6 +199,7 @@ static PyObject *Elevation_calcHillshade(PyObject *self, PyObject *args, PyObjec
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCalcHillshade(std::string(pszInputImage), std::string(pszOutputFile), azimuth, zenith, std::string(pszGDALFormat));
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -213,6 +223,7 @@ static PyObject *Elevation_calcHillshadePxlResImg(PyObject *self, PyObject *args
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCalcHillshadeImgPxlRes(std::string(pszInDEMImage), std::string(pszInPxlResImage), std::string(pszOutputFile), azimuth, zenith, std::string(pszGDALFormat));
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -236,6 +247,7 @@ static PyObject *Elevation_calcShadowMask(PyObject *self, PyObject *args, PyObje
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCalcShadowMask(std::string(pszInputImage), std::string(pszOutputFile), azimuth, zenith, maxHeight, std::string(pszGDALFormat));
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -247,6 +259,52 @@ static PyObject *Elevation_calcShadowMask(PyObject *self, PyObject *args, PyObje
     Py_RETURN_NONE;
 }
 
+static PyObject *Elevation_calcShadowMasks(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"),
+                             RSGIS_PY_C_TEXT("azimuths"), RSGIS_PY_C_TEXT("zeniths"),
+                             RSGIS_PY_C_TEXT("gdalformat"), nullptr};
+    const char *pszInputImage, *pszOutputFile, *pszGDALFormat;
+    PyObject *azimuthsObj, *zenithsObj;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssOOs:shadow_masks", kwlist, &pszInputImage, &pszOutputFile, &azimuthsObj, &zenithsObj, &pszGDALFormat))
+        return nullptr;
+    
+    if( !PySequence_Check(azimuthsObj) || !PySequence_Check(zenithsObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "The azimuths and zeniths must be provided as lists.");
+        return nullptr;
+    }
+    std::vector<float> azimuths;
+    std::vector<float> zeniths;
+    Py_ssize_t nAzimuths = PySequence_Size(azimuthsObj);
+    for( Py_ssize_t n = 0; n < nAzimuths; n++ )
+    {
+        PyObject *o = PySequence_GetItem(azimuthsObj, n);
+        azimuths.push_back(RSGISPY_FLOAT_EXTRACT(o));
+        Py_DECREF(o);
+    }
+    Py_ssize_t nZeniths = PySequence_Size(zenithsObj);
+    for( Py_ssize_t n = 0; n < nZeniths; n++ )
+    {
+        PyObject *o = PySequence_GetItem(zenithsObj, n);
+        zeniths.push_back(RSGISPY_FLOAT_EXTRACT(o));
+        Py_DECREF(o);
+    }
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeCalcShadowMasks(std::string(pszInputImage), std::string(pszOutputFile), azimuths, zeniths, std::string(pszGDALFormat));
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
 static PyObject *Elevation_calcLocalIncidenceAngle(PyObject *self, PyObject *args, PyObject *keywds)
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"),
@@ -259,6 +317,7 @@ static PyObject *Elevation_calcLocalIncidenceAngle(PyObject *self, PyObject *arg
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCalcLocalIncidenceAngle(std::string(pszInputImage), std::string(pszOutputFile), azimuth, zenith, std::string(pszGDALFormat));
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -282,6 +341,7 @@ static PyObject *Elevation_calcLocalExistanceAngle(PyObject *self, PyObject *arg
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCalcLocalExitanceAngle(std::string(pszInputImage), std::string(pszOutputFile), azimuth, zenith, std::string(pszGDALFormat));
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -306,6 +366,7 @@ static PyObject *Elevation_dtmAspectMedianFilter(PyObject *self, PyObject *args,
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeDTMAspectMedianFilter(std::string(pszInputDTMImage), std::string(pszInputAspectImage), std::string(pszOutputFile), aspectRange, winHSize, std::string(pszGDALFormat));
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -328,6 +389,7 @@ static PyObject *Elevation_fillDEMSoilleGratin1994(PyObject *self, PyObject *arg
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeDEMFillSoilleGratin1994(std::string(pszInputDTMImage), std::string(pszValidMaskImage), std::string(pszOutputFile), std::string(pszGDALFormat));
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -339,6 +401,31 @@ static PyObject *Elevation_fillDEMSoilleGratin1994(PyObject *self, PyObject *arg
     Py_RETURN_NONE;
 }
 
+static PyObject *Elevation_fillDEMPriorityFlood(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("in_dem_img"), RSGIS_PY_C_TEXT("in_vld_img"),
+                             RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("tile_size"), nullptr};
+    const char *pszInputDTMImage, *pszValidMaskImage, *pszOutputFile, *pszGDALFormat;
+    unsigned int tileSize = 0;
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssss|I:fill_dem_priority_flood", kwlist, &pszInputDTMImage, &pszValidMaskImage, &pszOutputFile, &pszGDALFormat, &tileSize))
+        return nullptr;
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeDEMFillPriorityFlood(std::string(pszInputDTMImage), std::string(pszValidMaskImage), std::string(pszOutputFile), std::string(pszGDALFormat), tileSize);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
 static PyObject *Elevation_planeFitDetreadDEM(PyObject *self, PyObject *args, PyObject *keywds)
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"),
@@ -351,6 +438,7 @@ static PyObject *Elevation_planeFitDetreadDEM(PyObject *self, PyObject *args, Py
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executePlaneFitDetreadDEM(std::string(pszInputDEMImage), std::string(pszOutputFile), std::string(pszGDALFormat), winSize);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -363,6 +451,150 @@ static PyObject *Elevation_planeFitDetreadDEM(PyObject *self, PyObject *args, Py
 }
 
 
+static PyObject *Elevation_calcDEMRoughness(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"),
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("win_size"),
+                             RSGIS_PY_C_TEXT("metrics"), RSGIS_PY_C_TEXT("detrend"), nullptr};
+    const char *pszInputDEMImage, *pszOutputFile, *pszGDALFormat;
+    const char *pszMetrics = "profile";
+    int winSize;
+    int detrend = true;
+    
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssi|sp:calc_dem_roughness", kwlist, &pszInputDEMImage, &pszOutputFile, &pszGDALFormat, &winSize, &pszMetrics, &detrend))
+        return nullptr;
+    
+    rsgis::cmds::RSGISDEMRoughnessMetrics metrics;
+    std::string metricsStr = std::string(pszMetrics);
+    if(metricsStr == "profile")
+    {
+        metrics = rsgis::cmds::rsgis_dem_rough_profile;
+    }
+    else if(metricsStr == "munro")
+    {
+        metrics = rsgis::cmds::rsgis_dem_rough_munro;
+    }
+    else if(metricsStr == "smith")
+    {
+        metrics = rsgis::cmds::rsgis_dem_rough_smith;
+    }
+    else
+    {
+        PyErr_SetString(GETSTATE(self)->error, "The metrics must be one of 'profile', 'munro' or 'smith'.");
+        return nullptr;
+    }
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeCalcDEMRoughness(std::string(pszInputDEMImage), std::string(pszOutputFile), metrics, winSize, (bool)detrend, std::string(pszGDALFormat));
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *Elevation_calcTerrainDerivatives(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"),
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("derivatives"),
+                             RSGIS_PY_C_TEXT("unit"), RSGIS_PY_C_TEXT("azimuth"),
+                             RSGIS_PY_C_TEXT("zenith"), RSGIS_PY_C_TEXT("view_azimuth"),
+                             RSGIS_PY_C_TEXT("view_zenith"), nullptr};
+    const char *pszInputImage, *pszOutputFile, *pszGDALFormat;
+    const char *pszOutUnit = "degrees";
+    PyObject *derivativesObj;
+    float azimuth = 0.0;
+    float zenith = 0.0;
+    float viewAzimuth = 0.0;
+    float viewZenith = 0.0;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssO|sffff:terrain_derivatives", kwlist, &pszInputImage, &pszOutputFile, &pszGDALFormat, &derivativesObj, &pszOutUnit, &azimuth, &zenith, &viewAzimuth, &viewZenith))
+    {
+        return nullptr;
+    }
+    
+    if( !PySequence_Check(derivativesObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "The derivatives must be provided as a list.");
+        return nullptr;
+    }
+    std::vector<rsgis::cmds::RSGISDEMTerrainDerivative> derivatives;
+    Py_ssize_t nDerivatives = PySequence_Size(derivativesObj);
+    for( Py_ssize_t n = 0; n < nDerivatives; n++ )
+    {
+        PyObject *o = PySequence_GetItem(derivativesObj, n);
+        if(!RSGISPY_CHECK_STRING(o))
+        {
+            Py_DECREF(o);
+            PyErr_SetString(GETSTATE(self)->error, "The derivatives must be strings.");
+            return nullptr;
+        }
+        std::string derivStr = RSGISPY_STRING_EXTRACT(o);
+        Py_DECREF(o);
+        if(derivStr == "slope")
+        {
+            derivatives.push_back(rsgis::cmds::rsgis_dem_slope);
+        }
+        else if(derivStr == "aspect")
+        {
+            derivatives.push_back(rsgis::cmds::rsgis_dem_aspect);
+        }
+        else if(derivStr == "hillshade")
+        {
+            derivatives.push_back(rsgis::cmds::rsgis_dem_hillshade);
+        }
+        else if(derivStr == "incidence")
+        {
+            derivatives.push_back(rsgis::cmds::rsgis_dem_incidence);
+        }
+        else if(derivStr == "exitance")
+        {
+            derivatives.push_back(rsgis::cmds::rsgis_dem_exitance);
+        }
+        else
+        {
+            PyErr_SetString(GETSTATE(self)->error, "The derivatives must be one of 'slope', 'aspect', 'hillshade', 'incidence' or 'exitance'.");
+            return nullptr;
+        }
+    }
+    
+    try
+    {
+        rsgis::cmds::RSGISAngleMeasure outAngleUnit;
+        std::string angUnit = std::string(pszOutUnit);
+        if(angUnit == "degrees")
+        {
+            outAngleUnit = rsgis::cmds::rsgis_degrees;
+        }
+        else if(angUnit == "radians")
+        {
+            outAngleUnit = rsgis::cmds::rsgis_radians;
+        }
+        else
+        {
+            throw rsgis::cmds::RSGISCmdException("The unit option needs to be specified as either 'degrees' or 'radians'.");
+        }
+        
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeCalcTerrainDerivatives(std::string(pszInputImage), std::string(pszOutputFile), derivatives, outAngleUnit, azimuth, zenith, viewAzimuth, viewZenith, std::string(pszGDALFormat));
+        }
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+
+
 // Our list of functions in this module
 static PyMethodDef ElevationMethods[] = {
 {"slope", (PyCFunction)Elevation_calcSlope, METH_VARARGS | METH_KEYWORDS,
@@ -458,6 +690,20 @@ static PyMethodDef ElevationMethods[] = {
 ":param gdalformat: is a string with the output image format for the GDAL driver.\n"},
     
     
+{"shadow_masks", (PyCFunction)Elevation_calcShadowMasks, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.elevation.shadow_masks(input_img, output_img, azimuths, zeniths, gdalformat)\n"
+"Calculates a shadow mask band for each of a list of sun positions (e.g., for the\n"
+"acquisition dates of a time series) given an input elevation model. The DEM is read\n"
+"once and swept along the solar azimuth so the time for each sun position does not\n"
+"depend on the relief. As the horizon is interpolated between pixels the masks can\n"
+"differ slightly from the ray traced shadow_mask.\n"
+"\n"
+":param input_img: is a string containing the name and path of the input DEM file.\n"
+":param output_img: is a string containing the name and path of the output file.\n"
+":param azimuths: is a list of floats with the solar azimuths in degrees.\n"
+":param zeniths: is a list of floats with the solar zeniths in degrees (the same length as azimuths).\n"
+":param gdalformat: is a string with the output image format for the GDAL driver.\n"},
+
 {"local_incidence_angle", (PyCFunction)Elevation_calcLocalIncidenceAngle, METH_VARARGS | METH_KEYWORDS,
 "rsgislib.elevation.local_incidence_angle(input_img, output_img, azimuth, zenith, gdalformat)\n"
 "Calculates a local solar incidence angle layer given an input elevation model\n"
@@ -510,6 +756,31 @@ static PyMethodDef ElevationMethods[] = {
 "   rsgislib.elevation.fill_dem_soille_gratin_1994(inputDEMImage, validMaskImage, outFilledImage, 'KEA')\n"
 "\n"
 },
+
+{"fill_dem_priority_flood", (PyCFunction)Elevation_fillDEMPriorityFlood, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.elevation.fill_dem_priority_flood(in_dem_img, in_vld_img, output_img, gdalformat, tile_size)\n"
+"Filter the local minima in a DEM using a priority-flood, giving the same result as\n"
+"fill_dem_soille_gratin_1994 but significantly faster. For DEMs which are too large to\n"
+"be held in memory a tile size can be specified, in which case the tiled priority-flood\n"
+"of Barnes (2016) is used and only a single tile is held in memory at a time.\n\n"
+"Barnes, R. (2016). Parallel priority-flood depression filling for trillion cell digital\n"
+"elevation models on desktops or clusters. Computers & Geosciences. 96. 56-68.\n"
+"\n"
+":param in_dem_img: is a string containing the name and path of the input DEM file.\n"
+":param in_vld_img: is a string containing the name and path to a binary image specifying the valid data region (1 == valid)\n"
+":param output_img: is a string containing the name and path of the output file.\n"
+":param gdalformat: is a string with the output image format for the GDAL driver.\n"
+":param tile_size: is the size (in pixels) of the tiles used to process the image. If 0 (Default) the whole image is processed in memory.\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   import rsgislib.elevation\n"
+"   inputDEMImage = 'DEM.kea'\n"
+"   validMaskImage = 'ValidRegionMask.kea'\n"
+"   outFilledImage = 'DEM_filled.kea'\n"
+"   rsgislib.elevation.fill_dem_priority_flood(inputDEMImage, validMaskImage, outFilledImage, 'KEA', tile_size=2048)\n"
+"\n"
+},
     
 {"plane_fit_detreat_dem", (PyCFunction)Elevation_planeFitDetreadDEM, METH_VARARGS | METH_KEYWORDS,
 "rsgislib.elevation.plane_fit_detreat_dem(input_img, output_img, gdalformat, win_size)\n"
@@ -528,6 +799,62 @@ static PyMethodDef ElevationMethods[] = {
 "   outDEMImage = 'DEM_Detread.kea'\n"
 "   rsgislib.elevation.plane_fit_detreat_dem(inputDEMImage, outDEMImage, 'KEA', 11)\n"
 "\n"
+},
+    
+{"calc_dem_roughness", (PyCFunction)Elevation_calcDEMRoughness, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.elevation.calc_dem_roughness(input_img, output_img, gdalformat, win_size, metrics='profile', detrend=True)\n"
+"Calculate roughness metrics for the window around every pixel of a DEM, giving a\n"
+"roughness layer (one band per metric, named as the columns of the functions in\n"
+"rsgislib.elevation.roughness) rather than values for sample points. The profiles\n"
+"are the row and column through the centre of the window. Pixels where the window\n"
+"contains no data values are no data. Note, pixels within half the window of the\n"
+"image edge use 0 for the pixels outside the image.\n"
+"\n"
+":param input_img: is a string containing the name and path of the input DEM file.\n"
+":param output_img: is a string containing the name and path of the output file.\n"
+":param gdalformat: is a string with the output image format for the GDAL driver.\n"
+":param win_size: is an (odd) integer with the size of the window (e.g., 11).\n"
+":param metrics: the metrics to calculate: 'profile' (x, y and average of RA, RR, RQ,\n"
+"                MIF, RV, RP, RZ, RSK and RKU; 27 bands), 'munro' (Munro 1989 z0 of\n"
+"                the profiles; 9 bands) or 'smith' (Smith et al. 2016 z0 of the window\n"
+"                surface; 12 bands).\n"
+":param detrend: if True (default) the profiles are detrended with a linear fit and\n"
+"                the window surface with a plane fit.\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   import rsgislib.elevation\n"
+"   inputDEMImage = 'DEM.kea'\n"
+"   outRoughImage = 'DEM_smith_roughness.kea'\n"
+"   rsgislib.elevation.calc_dem_roughness(inputDEMImage, outRoughImage, 'KEA', 11, metrics='smith')\n"
+"\n"
+},
+    
+{"terrain_derivatives", (PyCFunction)Elevation_calcTerrainDerivatives, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.elevation.terrain_derivatives(input_img, output_img, gdalformat, derivatives, unit='degrees', azimuth=0, zenith=0, view_azimuth=0, view_zenith=0)\n"
+"Calculates a set of terrain derivatives of a DEM with a single pass over the DEM,\n"
+"giving an output band (named after the derivative) for each derivative in the order\n"
+"listed. The values are the same as those of the slope, aspect, hillshade,\n"
+"local_incidence_angle and local_existance_angle functions (all output as float).\n"
+"\n"
+":param input_img: is a string containing the name and path of the input DEM file.\n"
+":param output_img: is a string containing the name and path of the output file.\n"
+":param gdalformat: is a string with the output image format for the GDAL driver.\n"
+":param derivatives: is a list of the derivatives to calculate, from 'slope', 'aspect',\n"
+"                    'hillshade', 'incidence' and 'exitance'.\n"
+":param unit: is a string specifying the output unit of the slope ('degrees' or 'radians').\n"
+":param azimuth: is a float with the solar azimuth in degrees (hillshade and incidence).\n"
+":param zenith: is a float with the solar zenith in degrees (hillshade and incidence).\n"
+":param view_azimuth: is a float with the view azimuth in degrees (exitance).\n"
+":param view_zenith: is a float with the view zenith in degrees (exitance).\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   import rsgislib.elevation\n"
+"   inputDEMImage = 'DEM.kea'\n"
+"   outImage = 'DEM_terrain.kea'\n"
+"   rsgislib.elevation.terrain_derivatives(inputDEMImage, outImage, 'KEA', ['slope', 'aspect', 'incidence'], azimuth=150, zenith=35)\n"
+"\n"
 },
     
     {nullptr}        /* Sentinel */
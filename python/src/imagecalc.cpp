@@ -23,6 +23,9 @@
 #include <Python.h>
 #include "rsgispy_common.h"
 #include "cmds/RSGISCmdImageCalc.h"
+#include "cmds/RSGISCmdFilterImages.h"
+
+#include <vector>
 
 /* An exception object for this module */
 /* created in the init function */
@@ -114,7 +117,10 @@ static PyObject *ImageCalc_BandMath(PyObject *self, PyObject *args, PyObject *ke
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
         bool useExpAsbandName = (bool)bExpBandName;
         bool outputImgExists = (bool)bOutputImgExists;
-        rsgis::cmds::executeBandMaths(pRSGISStruct, nBandDefns, pszOutputFile, pszExpression, pszGDALFormat, type, useExpAsbandName, outputImgExists);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeBandMaths(pRSGISStruct, nBandDefns, pszOutputFile, pszExpression, pszGDALFormat, type, useExpAsbandName, outputImgExists);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -146,7 +152,10 @@ static PyObject *ImageCalc_ImageMath(PyObject *self, PyObject *args, PyObject *k
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
         bool useExpAsbandName = (bool)bExpBandName;
         bool outputImgExists = (bool)bOutputImgExists;
-        rsgis::cmds::executeImageMaths(pszInputImage, pszOutputFile, pszExpression, pszGDALFormat, type, useExpAsbandName, outputImgExists);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeImageMaths(pszInputImage, pszOutputFile, pszExpression, pszGDALFormat, type, useExpAsbandName, outputImgExists);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -176,7 +185,10 @@ static PyObject *ImageCalc_ImageBandMath(PyObject *self, PyObject *args, PyObjec
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
         bool useExpAsbandName = (bool)bExpBandName;
         bool outputImgExists = (bool)bOutputImgExists;
-        rsgis::cmds::executeImageBandMaths(pszInputImage, pszOutputFile, pszExpression, pszGDALFormat, type, useExpAsbandName, outputImgExists);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeImageBandMaths(pszInputImage, pszOutputFile, pszExpression, pszGDALFormat, type, useExpAsbandName, outputImgExists);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -192,23 +204,26 @@ static PyObject *ImageCalc_KMeansClustering(PyObject *self, PyObject *args, PyOb
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("out_file"),
                              RSGIS_PY_C_TEXT("n_clusters"), RSGIS_PY_C_TEXT("max_n_iters"),
                              RSGIS_PY_C_TEXT("sub_sample"), RSGIS_PY_C_TEXT("ignore_zeros"),
-                             RSGIS_PY_C_TEXT("degree_change"), RSGIS_PY_C_TEXT("init_cluster_method"), nullptr};
+                             RSGIS_PY_C_TEXT("degree_change"), RSGIS_PY_C_TEXT("init_cluster_method"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
 
     const char *pszInputImage, *pszOutputFile;
     unsigned int nNumClusters, nMaxNumIterations, nSubSample;
     int nIgnoreZeros; // passed as a bool - seems the only way to pass into C
     float fDegreeOfChange;
     int nClusterMethod;
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssIIIifi:kmeans_clustering", kwlist, &pszInputImage, &pszOutputFile, &nNumClusters,
-                                &nMaxNumIterations, &nSubSample, &nIgnoreZeros, &fDegreeOfChange, &nClusterMethod ))
+    unsigned int nThreads = 1;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssIIIifi|I:kmeans_clustering", kwlist, &pszInputImage, &pszOutputFile, &nNumClusters,
+                                &nMaxNumIterations, &nSubSample, &nIgnoreZeros, &fDegreeOfChange, &nClusterMethod, &nThreads ))
     {
         return nullptr;
     }
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeKMeansClustering(pszInputImage, pszOutputFile, nNumClusters, nMaxNumIterations,
-                            nSubSample, nIgnoreZeros, fDegreeOfChange, (rsgis::cmds::RSGISInitClustererMethods)nClusterMethod);
+                            nSubSample, nIgnoreZeros, fDegreeOfChange, (rsgis::cmds::RSGISInitClustererMethods)nClusterMethod, nThreads);
         
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -228,26 +243,29 @@ static PyObject *ImageCalc_ISODataClustering(PyObject *self, PyObject *args, PyO
                              RSGIS_PY_C_TEXT("degree_change"), RSGIS_PY_C_TEXT("init_cluster_method"),
                              RSGIS_PY_C_TEXT("min_dist_clusters"), RSGIS_PY_C_TEXT("min_n_feats"),
                              RSGIS_PY_C_TEXT("max_std_dev"), RSGIS_PY_C_TEXT("min_n_clusters"),
-                             RSGIS_PY_C_TEXT("start_iter"), RSGIS_PY_C_TEXT("end_iter"), nullptr};
+                             RSGIS_PY_C_TEXT("start_iter"), RSGIS_PY_C_TEXT("end_iter"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *pszInputImage, *pszOutputFile;
     unsigned int nNumClusters, nMaxNumIterations, nSubSample, minNumFeatures, minNumClusters;
     unsigned int startIteration, endIteration;
     int nIgnoreZeros; // passed as a bool - seems the only way to pass into C
     float fDegreeOfChange, fMinDistBetweenClusters, maxStdDev;
     int nClusterMethod;
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssIIIififIfIII:isodata_clustering", kwlist, &pszInputImage, &pszOutputFile, &nNumClusters,
+    unsigned int nThreads = 1;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssIIIififIfIII|I:isodata_clustering", kwlist, &pszInputImage, &pszOutputFile, &nNumClusters,
                                 &nMaxNumIterations, &nSubSample, &nIgnoreZeros, &fDegreeOfChange, &nClusterMethod,
                                 &fMinDistBetweenClusters, &minNumFeatures, &maxStdDev, &minNumClusters,
-                                &startIteration, &endIteration ))
+                                &startIteration, &endIteration, &nThreads ))
     {
         return nullptr;
     }
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeISODataClustering(pszInputImage, pszOutputFile, nNumClusters, nMaxNumIterations,
                             nSubSample, nIgnoreZeros, fDegreeOfChange, (rsgis::cmds::RSGISInitClustererMethods)nClusterMethod, fMinDistBetweenClusters,
-                            minNumFeatures, maxStdDev, minNumClusters, startIteration, endIteration);
+                            minNumFeatures, maxStdDev, minNumClusters, startIteration, endIteration, nThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -276,6 +294,7 @@ static PyObject *ImageCalc_MahalanobisDistFilter(PyObject *self, PyObject *args,
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeMahalanobisDistFilter(inputImage, outputImage, winSize, gdalFormat, type);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -305,6 +324,7 @@ static PyObject *ImageCalc_MahalanobisDist2ImgFilter(PyObject *self, PyObject *a
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeMahalanobisDist2ImgFilter(inputImage, outputImage, winSize, gdalFormat, type);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -561,6 +581,7 @@ static PyObject *ImageCalc_ImagePixelColumnSummary(PyObject *self, PyObject *arg
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImagePixelColumnSummary(inputImage, outputImage, summary, gdalFormat, type, noDataValue, useNoDataValue);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -615,6 +636,7 @@ static PyObject *ImageCalc_ImagePixelLinearFit(PyObject *self, PyObject *args, P
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImagePixelLinearFit(inputImage, outputImage, gdalFormat, bandValues, noDataValue, useNoDataValue);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -630,13 +652,15 @@ static PyObject *ImageCalc_PCA(PyObject *self, PyObject *args, PyObject *keywds)
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("eigen_vec_file"),
                              RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("n_comps"),
-                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("datatype"),  nullptr};
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("datatype"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *eigenVectors, *inputImage, *outputImage;
     unsigned int numComponents;
     const char *gdalFormat;
     int datatype;
+    unsigned int nThreads = 1;
 
-    if(!PyArg_ParseTupleAndKeywords(args, keywds, "sssIsi:pca", kwlist, &inputImage, &eigenVectors, &outputImage, &numComponents, &gdalFormat, &datatype))
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "sssIsi|I:pca", kwlist, &inputImage, &eigenVectors, &outputImage, &numComponents, &gdalFormat, &datatype, &nThreads))
     {
         return nullptr;
     }
@@ -644,7 +668,10 @@ static PyObject *ImageCalc_PCA(PyObject *self, PyObject *args, PyObject *keywds)
     try
     {
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)datatype;
-        rsgis::cmds::executePCA(std::string(inputImage), std::string(eigenVectors), std::string(outputImage), numComponents, std::string(gdalFormat), type);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executePCA(std::string(inputImage), std::string(eigenVectors), std::string(outputImage), numComponents, std::string(gdalFormat), type, nThreads);
+        }
     }
     catch (rsgis::cmds::RSGISCmdException &e)
     {
@@ -655,6 +682,57 @@ static PyObject *ImageCalc_PCA(PyObject *self, PyObject *args, PyObject *keywds)
     Py_RETURN_NONE;
 }
 
+static PyObject *ImageCalc_CalcPCAEigenVectors(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("out_matrix_file"),
+                             RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
+    const char *inputImage, *outputMatrix;
+    PyObject *noDataValueObj = Py_None;
+    unsigned int nThreads = 1;
+
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ss|OI:calc_pca_eigen_vectors", kwlist, &inputImage, &outputMatrix, &noDataValueObj, &nThreads))
+    {
+        return nullptr;
+    }
+
+    bool haveNoDataValue = false;
+    float noDataValue = 0.0;
+    if(noDataValueObj != Py_None)
+    {
+        if(RSGISPY_CHECK_FLOAT(noDataValueObj) | RSGISPY_CHECK_INT(noDataValueObj))
+        {
+            noDataValue = RSGISPY_FLOAT_EXTRACT(noDataValueObj);
+            haveNoDataValue = true;
+        }
+    }
+
+    PyObject *outVals = nullptr;
+    try
+    {
+        std::vector<double> varExplained;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            varExplained = rsgis::cmds::executeCalcPCAEigenVectors(std::string(inputImage), std::string(outputMatrix), haveNoDataValue, noDataValue, nThreads);
+        }
+
+        outVals = PyTuple_New(varExplained.size());
+        for(unsigned int i = 0; i < varExplained.size(); ++i)
+        {
+            if(PyTuple_SetItem(outVals, i, Py_BuildValue("d", varExplained.at(i))) == -1)
+            {
+                throw rsgis::cmds::RSGISCmdException("Failed to add the explained variance to the list...");
+            }
+        }
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    return outVals;
+}
+
 
 static PyObject *ImageCalc_CalculateRMSE(PyObject *self, PyObject *args, PyObject *keywds)
 {
@@ -672,7 +750,11 @@ static PyObject *ImageCalc_CalculateRMSE(PyObject *self, PyObject *args, PyObjec
     PyObject *outVal = PyTuple_New(1);
     try
     {
-        double rmseVal = rsgis::cmds::executeCalculateRMSE(inputImageA, bandA, inputImageB, bandB);
+        double rmseVal = 0;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rmseVal = rsgis::cmds::executeCalculateRMSE(inputImageA, bandA, inputImageB, bandB);
+        }
         if(PyTuple_SetItem(outVal, 0, Py_BuildValue("d", rmseVal)) == -1)
         {
             throw rsgis::cmds::RSGISCmdException("Failed to add \'RMSE\' value to the list...");
@@ -707,6 +789,7 @@ static PyObject *ImageCalc_AllBandsEqualTo(PyObject *self, PyObject *args, PyObj
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeAllBandsEqualTo(inputImage, imgValue, outputTrueVal, outputFalseVal, outputImage, imageFormat, type);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -738,6 +821,7 @@ static PyObject *ImageCalc_Histogram(PyObject *self, PyObject *args, PyObject *k
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeHistogram(inputImage, imageMask, outputFile, imgBand, imgValue, binWidth, calcInMinMax, inMin, inMax);
     } catch (rsgis::cmds::RSGISCmdException &e) {
         PyErr_SetString(GETSTATE(self)->error, e.what());
@@ -751,14 +835,16 @@ static PyObject *ImageCalc_GetHistogram(PyObject *self, PyObject *args, PyObject
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("img_band"),
                              RSGIS_PY_C_TEXT("bin_width"), RSGIS_PY_C_TEXT("calc_min_max"),
-                             RSGIS_PY_C_TEXT("min_val"), RSGIS_PY_C_TEXT("max_val"), nullptr};
+                             RSGIS_PY_C_TEXT("min_val"), RSGIS_PY_C_TEXT("max_val"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
 
     const char *inputImage;
     float binWidth, inMin, inMax;
     int calcInMinMax;
     unsigned int imgBand;
+    unsigned int nThreads = 1;
     
-    if(!PyArg_ParseTupleAndKeywords(args, keywds, "sIfiff:get_histogram", kwlist, &inputImage, &imgBand, &binWidth, &calcInMinMax, &inMin, &inMax))
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "sIfiff|I:get_histogram", kwlist, &inputImage, &imgBand, &binWidth, &calcInMinMax, &inMin, &inMax, &nThreads))
     {
         return nullptr;
     }
@@ -770,7 +856,11 @@ static PyObject *ImageCalc_GetHistogram(PyObject *self, PyObject *args, PyObject
         unsigned int nBins = 0;
         double inMinVal = inMin;
         double inMaxVal = inMax;
-        unsigned int *bins = rsgis::cmds::executeGetHistogram(inputImage, imgBand, binWidth, &nBins, calcInMinMax, &inMinVal, &inMaxVal);
+        unsigned int *bins = nullptr;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            bins = rsgis::cmds::executeGetHistogram(inputImage, imgBand, binWidth, &nBins, calcInMinMax, &inMinVal, &inMaxVal, nThreads);
+        }
         
         Py_ssize_t listLen = nBins;
         
@@ -817,12 +907,15 @@ static PyObject *ImageCalc_GetHistogram(PyObject *self, PyObject *args, PyObject
 static PyObject *ImageCalc_BandPercentile(PyObject *self, PyObject *args, PyObject *keywds)
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("percentile"),
-                             RSGIS_PY_C_TEXT("no_data_val"), nullptr};
+                             RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("approx"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *inputImage;
     float percentile;
     PyObject *noDataValueObj;
+    int approx = false;
+    unsigned int nThreads = 1;
 
-    if(!PyArg_ParseTupleAndKeywords(args, keywds, "sfO:calc_band_percentile", kwlist, &inputImage, &percentile, &noDataValueObj))
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "sfO|iI:calc_band_percentile", kwlist, &inputImage, &percentile, &noDataValueObj, &approx, &nThreads))
     {
         return nullptr;
     }
@@ -841,7 +934,11 @@ static PyObject *ImageCalc_BandPercentile(PyObject *self, PyObject *args, PyObje
     PyObject *outVals = nullptr;
     try
     {
-        std::vector<double> outPercentileVals = rsgis::cmds::executeBandPercentile(inputImage, percentile, noDataValue, haveNoDataValue);
+        std::vector<double> outPercentileVals;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            outPercentileVals = rsgis::cmds::executeBandPercentile(inputImage, percentile, noDataValue, haveNoDataValue, approx, nThreads);
+        }
         
         Py_ssize_t listLen = outPercentileVals.size();
         outVals = PyTuple_New(listLen);
@@ -880,6 +977,7 @@ static PyObject *ImageCalc_CorrelationWindow(PyObject *self, PyObject *args, PyO
     rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)datatype;
     try 
     {
+    RSGISPyReleaseGIL releaseGIL;
     rsgis::cmds::executeCorrelationWindow(pszInputImage, pszOutputImage, windowSize, bandA, bandB, pszGDALFormat, type);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -931,7 +1029,10 @@ static PyObject *ImageCalc_GetImageStatsInEnv(PyObject *self, PyObject *args, Py
         stats->stddev = 0;
         stats->sum = 0;
         
-        rsgis::cmds::executeImageBandStatsEnv(std::string(inputImage), stats, imgBand, noDataValueSpecified, noDataValue, longMin, longMax, latMin, latMax);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeImageBandStatsEnv(std::string(inputImage), stats, imgBand, noDataValueSpecified, noDataValue, longMin, longMax, latMin, latMax);
+        }
         
         
         if(PyTuple_SetItem(outValsList, 0, Py_BuildValue("d", stats->min)) == -1)
@@ -999,7 +1100,11 @@ static PyObject *ImageCalc_GetImageBandModeInEnv(PyObject *self, PyObject *args,
     PyObject *outVal = PyTuple_New(1);
     try
     {
-        float modeVal = rsgis::cmds::executeImageBandModeEnv(std::string(inputImage), binWidth, imgBand, noDataValueSpecified, noDataValue, longMin, longMax, latMin, latMax);
+        float modeVal = 0;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            modeVal = rsgis::cmds::executeImageBandModeEnv(std::string(inputImage), binWidth, imgBand, noDataValueSpecified, noDataValue, longMin, longMax, latMin, latMax);
+        }
         
         if(PyTuple_SetItem(outVal, 0, Py_BuildValue("f", modeVal)) == -1)
         {
@@ -1052,7 +1157,11 @@ static PyObject *ImageCalc_Get2DImageHistogram(PyObject *self, PyObject *args, P
         double binWidthImg1 = 0.0;
         double binWidthImg2 = 0.0;
         
-        double rSq = rsgis::cmds::executeImageComparison2dHisto(std::string(inputImage1), std::string(inputImage2), std::string(outputImage), std::string(gdalFormat), img1Band, img2Band, numBins, &binWidthImg1, &binWidthImg2, img1Min, img1Max, img2Min, img2Max, img1Scale, img2Scale, img1Off, img2Off, ((bool)normOutput));
+        double rSq = 0;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rSq = rsgis::cmds::executeImageComparison2dHisto(std::string(inputImage1), std::string(inputImage2), std::string(outputImage), std::string(gdalFormat), img1Band, img2Band, numBins, &binWidthImg1, &binWidthImg2, img1Min, img1Max, img2Min, img2Max, img1Scale, img2Scale, img1Off, img2Off, ((bool)normOutput));
+        }
                 
         if(PyTuple_SetItem(outVal, 0, Py_BuildValue("d", binWidthImg1)) == -1)
         {
@@ -1151,6 +1260,7 @@ static PyObject *ImageCalc_CalcMaskImgPxlValProb(PyObject *self, PyObject *args,
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCalcMaskImgPxlValProb(std::string(pszInputImage), inImgBandIdxs, std::string(pszMaskImage), maskImgVal, std::string(pszOutputImage), std::string(pszGDALFormat), histBinWidths, calcHistBinWidth, useImgNoData, rescaleProbs);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -1244,7 +1354,10 @@ static PyObject *ImageCalc_CalcPropTrueExp(PyObject *self, PyObject *args, PyObj
     float prop = 0.0;
     try
     {
-        prop = rsgis::cmds::executeCalcPropTrueExp(pRSGISStruct, nBandDefns, std::string(pszExpression), inValidImage, useValidImg);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            prop = rsgis::cmds::executeCalcPropTrueExp(pRSGISStruct, nBandDefns, std::string(pszExpression), inValidImage, useValidImg);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1359,208 +1472,658 @@ static PyObject *ImageCalc_calcMultiImgBandStats(PyObject *self, PyObject *args,
 }
 
 
-static PyObject *ImageCalc_CalcImageDifference(PyObject *self, PyObject *args, PyObject *keywds)
+// Reads the attributes of a rsgislib.imagecalc.SpecIndexDefn object, returning false (with the error set) if they are not valid.
+static bool ImageCalc_ExtractSpecIndexDefn(PyObject *self, PyObject *o, rsgis::cmds::SpectralIndexCmds *idxDefn)
 {
-    static char *kwlist[] = {RSGIS_PY_C_TEXT("in_a_img"), RSGIS_PY_C_TEXT("in_b_img"),
-                             RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
-                             RSGIS_PY_C_TEXT("datatype"), nullptr};
-
-    const char *inputImage1, *inputImage2, *outputImage, *gdalFormat;
-    int datatype;
-    
-    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssssi:calc_img_difference", kwlist, &inputImage1, &inputImage2, &outputImage, &gdalFormat, &datatype))
+    PyObject *pName = PyObject_GetAttrString(o, "name");
+    if( ( pName == nullptr ) || ( pName == Py_None ) || !RSGISPY_CHECK_STRING(pName) )
     {
-        return nullptr;
+        PyErr_SetString(GETSTATE(self)->error, "could not find string attribute \'name\'" );
+        Py_XDECREF(pName);
+        return false;
     }
-    
-    try
+    idxDefn->name = RSGISPY_STRING_EXTRACT(pName);
+    Py_DECREF(pName);
+
+    PyObject *pIndex = PyObject_GetAttrString(o, "index");
+    if( ( pIndex == nullptr ) || ( pIndex == Py_None ) || !RSGISPY_CHECK_INT(pIndex) )
     {
-        rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)datatype;
-        rsgis::cmds::calcImageDifference(std::string(inputImage1), std::string(inputImage2), std::string(outputImage), std::string(gdalFormat), type);
+        PyErr_SetString(GETSTATE(self)->error, "could not find integer attribute \'index\'" );
+        Py_XDECREF(pIndex);
+        return false;
     }
-    catch (rsgis::cmds::RSGISCmdException &e)
+    long index = RSGISPY_INT_EXTRACT(pIndex);
+    Py_DECREF(pIndex);
+    if((index < rsgis::cmds::rsgiscmds_sidx_normdiff) || (index > rsgis::cmds::rsgiscmds_sidx_expression))
     {
-        PyErr_SetString(GETSTATE(self)->error, e.what());
-        return nullptr;
+        PyErr_SetString(GETSTATE(self)->error, "Did not recognise the spectral index type (rsgislib.SPECIDX_*)." );
+        return false;
     }
-    
-    Py_RETURN_NONE;
-}
+    idxDefn->index = (rsgis::cmds::RSGISCmdSpectralIndex)index;
 
-static PyObject *ImageCalc_GetImageBandMinMax(PyObject *self, PyObject *args, PyObject *keywds)
-{
-    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("img_band"),
-                             RSGIS_PY_C_TEXT("use_no_data"), RSGIS_PY_C_TEXT("no_data_val"), nullptr};
-    const char *inputImage;
-    int imgBand;
-    int useNoDataVal = false;
-    float noDataVal = 0.0;
-    
-    if(!PyArg_ParseTupleAndKeywords(args, keywds, "si|if:get_img_band_min_max", kwlist, &inputImage, &imgBand, &useNoDataVal, &noDataVal))
+    PyObject *pBands = PyObject_GetAttrString(o, "bands");
+    if( ( pBands == nullptr ) || !PySequence_Check(pBands) )
     {
-        return nullptr;
+        PyErr_SetString(GETSTATE(self)->error, "could not find sequence attribute \'bands\'" );
+        Py_XDECREF(pBands);
+        return false;
     }
-    
-    PyObject *outList = PyTuple_New(2);
-    try
+    Py_ssize_t nBands = PySequence_Size(pBands);
+    for(Py_ssize_t i = 0; i < nBands; ++i)
     {
-        std::pair<double, double> outVals = rsgis::cmds::getImageBandMinMax(std::string(inputImage), imgBand, (bool)useNoDataVal, noDataVal);
-        
-        if(PyTuple_SetItem(outList, 0, Py_BuildValue("d", outVals.first)) == -1)
+        PyObject *pBand = PySequence_GetItem(pBands, i);
+        if(!RSGISPY_CHECK_INT(pBand))
         {
-            throw rsgis::cmds::RSGISCmdException("Failed to add min value to output tuple...");
+            PyErr_SetString(GETSTATE(self)->error, "The index bands must be integers." );
+            Py_DECREF(pBand);
+            Py_DECREF(pBands);
+            return false;
         }
-        if(PyTuple_SetItem(outList, 1, Py_BuildValue("d", outVals.second)) == -1)
+        idxDefn->bands.push_back(RSGISPY_UINT_EXTRACT(pBand));
+        Py_DECREF(pBand);
+    }
+    Py_DECREF(pBands);
+
+    PyObject *pParams = PyObject_GetAttrString(o, "params");
+    if( ( pParams != nullptr ) && ( pParams != Py_None ) )
+    {
+        if(!PySequence_Check(pParams))
         {
-            throw rsgis::cmds::RSGISCmdException("Failed to add max value to output tuple...");
+            PyErr_SetString(GETSTATE(self)->error, "The attribute \'params\' must be a sequence." );
+            Py_DECREF(pParams);
+            return false;
+        }
+        Py_ssize_t nParams = PySequence_Size(pParams);
+        for(Py_ssize_t i = 0; i < nParams; ++i)
+        {
+            PyObject *pParam = PySequence_GetItem(pParams, i);
+            double param = PyFloat_AsDouble(pParam);
+            Py_DECREF(pParam);
+            if(PyErr_Occurred())
+            {
+                PyErr_Clear();
+                PyErr_SetString(GETSTATE(self)->error, "The index parameters must be numbers." );
+                Py_DECREF(pParams);
+                return false;
+            }
+            idxDefn->params.push_back(param);
         }
     }
-    catch (rsgis::cmds::RSGISCmdException &e)
+    Py_XDECREF(pParams);
+    PyErr_Clear();
+
+    if(idxDefn->index == rsgis::cmds::rsgiscmds_sidx_expression)
     {
-        PyErr_SetString(GETSTATE(self)->error, e.what());
-        return nullptr;
+        PyObject *pExp = PyObject_GetAttrString(o, "exp");
+        if( ( pExp == nullptr ) || ( pExp == Py_None ) || !RSGISPY_CHECK_STRING(pExp) )
+        {
+            PyErr_SetString(GETSTATE(self)->error, "could not find string attribute \'exp\'" );
+            Py_XDECREF(pExp);
+            return false;
+        }
+        idxDefn->expression = RSGISPY_STRING_EXTRACT(pExp);
+        Py_DECREF(pExp);
+
+        PyObject *pVarNames = PyObject_GetAttrString(o, "var_names");
+        if( ( pVarNames == nullptr ) || !PySequence_Check(pVarNames) )
+        {
+            PyErr_SetString(GETSTATE(self)->error, "could not find sequence attribute \'var_names\'" );
+            Py_XDECREF(pVarNames);
+            return false;
+        }
+        Py_ssize_t nVarNames = PySequence_Size(pVarNames);
+        for(Py_ssize_t i = 0; i < nVarNames; ++i)
+        {
+            PyObject *pVarName = PySequence_GetItem(pVarNames, i);
+            if(!RSGISPY_CHECK_STRING(pVarName))
+            {
+                PyErr_SetString(GETSTATE(self)->error, "The variable names must be strings." );
+                Py_DECREF(pVarName);
+                Py_DECREF(pVarNames);
+                return false;
+            }
+            idxDefn->varNames.push_back(RSGISPY_STRING_EXTRACT(pVarName));
+            Py_DECREF(pVarName);
+        }
+        Py_DECREF(pVarNames);
     }
-    
-    return outList;
+    return true;
 }
 
-static PyObject *ImageCalc_CalcImageRescale(PyObject *self, PyObject *args, PyObject *keywds)
+static PyObject *ImageCalc_CalcSpectralIndices(PyObject *self, PyObject *args, PyObject *keywds)
 {
-    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("output_img"),
-                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("datatype"),
-                             RSGIS_PY_C_TEXT("c_no_data_val"),
-                             RSGIS_PY_C_TEXT("c_offset"), RSGIS_PY_C_TEXT("c_gain"),
-                             RSGIS_PY_C_TEXT("n_no_data_val"),
-                             RSGIS_PY_C_TEXT("n_offset"), RSGIS_PY_C_TEXT("n_gain"), nullptr};
-    PyObject *pInputImgsObj;
-    const char *outputImage, *gdalFormat;
-    int datatype;
-    float cNoDataVal, cOffset, cGain, nNoDataVal, nOffset, nGain = 0.0;
-    
-    if(!PyArg_ParseTupleAndKeywords(args, keywds, "Ossiffffff:calc_img_rescale", kwlist, &pInputImgsObj, &outputImage, &gdalFormat, &datatype, &cNoDataVal, &cOffset, &cGain, &nNoDataVal, &nOffset, &nGain))
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"),
+                             RSGIS_PY_C_TEXT("indices"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
+    const char *pszInputImage;
+    const char *pszOutputImage;
+    PyObject *pIndicesObj;
+    const char *pszGDALFormat = "KEA";
+    float noDataVal = -999;
+    unsigned int numThreads = 1;
+
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssO|sfI:calc_spectral_indices", kwlist, &pszInputImage, &pszOutputImage, &pIndicesObj, &pszGDALFormat, &noDataVal, &numThreads))
     {
         return nullptr;
     }
-    
-    std::vector<std::string> input_imgs;
-    if(RSGISPY_CHECK_STRING(pInputImgsObj))
+
+    if(!PySequence_Check(pIndicesObj))
     {
-        input_imgs.push_back(RSGISPY_STRING_EXTRACT(pInputImgsObj));
+        PyErr_SetString(GETSTATE(self)->error, "indices must be a sequence of rsgislib.imagecalc.SpecIndexDefn objects");
+        return nullptr;
     }
-    else if(PySequence_Check(pInputImgsObj))
+
+    Py_ssize_t nIndices = PySequence_Size(pIndicesObj);
+    std::vector<rsgis::cmds::SpectralIndexCmds> indices;
+    indices.reserve(nIndices);
+    for(Py_ssize_t i = 0; i < nIndices; ++i)
     {
-        Py_ssize_t nInputImgs = PySequence_Size(pInputImgsObj);
-        for( Py_ssize_t n = 0; n < nInputImgs; n++ )
+        PyObject *o = PySequence_GetItem(pIndicesObj, i);
+        rsgis::cmds::SpectralIndexCmds idxDefn;
+        bool valid = ImageCalc_ExtractSpecIndexDefn(self, o, &idxDefn);
+        Py_DECREF(o);
+        if(!valid)
         {
-            PyObject *strObj = PySequence_GetItem(pInputImgsObj, n);
-            if(RSGISPY_CHECK_STRING(strObj))
-            {
-                input_imgs.push_back(RSGISPY_STRING_EXTRACT(strObj));
-            }
-            else
-            {
-                PyErr_SetString(GETSTATE(self)->error, "Input images sequence must contain a list of strings");
-                return nullptr;
-            }
+            return nullptr;
         }
+        indices.push_back(idxDefn);
     }
-    else
-    {
-        PyErr_SetString(GETSTATE(self)->error, "Input images parameter must be either a single string or a sequence of strings");
-        return nullptr;
-    }
-    
+
     try
     {
-        rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)datatype;
-        rsgis::cmds::executeRescaleImages(input_imgs, std::string(outputImage), std::string(gdalFormat), type, cNoDataVal, cOffset, cGain, nNoDataVal, nOffset, nGain);
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeCalcSpectralIndices(std::string(pszInputImage), indices, std::string(pszOutputImage), std::string(pszGDALFormat), noDataVal, numThreads);
     }
-    catch (rsgis::cmds::RSGISCmdException &e)
+    catch(rsgis::cmds::RSGISCmdException &e)
     {
         PyErr_SetString(GETSTATE(self)->error, e.what());
         return nullptr;
     }
-    
+
     Py_RETURN_NONE;
 }
 
-static PyObject *ImageCalc_GetImgIdxForStat(PyObject *self, PyObject *args, PyObject *keywds)
+static PyObject *ImageCalc_CalcTemporalOutlierChng(PyObject *self, PyObject *args, PyObject *keywds)
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("output_img"),
-                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("no_data_val"),
-                             RSGIS_PY_C_TEXT("stat"), nullptr};
-    PyObject *pInputImages;
-    const char *pszOutputImage = "";
-    const char *pszGDALFormat = "";
-    float noDataVal = 0.0;
-    int statType;
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("img_band"),
+                             RSGIS_PY_C_TEXT("threshold"), RSGIS_PY_C_TEXT("min_obs"),
+                             RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("use_no_data"),
+                             RSGIS_PY_C_TEXT("out_scores"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
 
-    
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Ossfi:get_img_idx_for_stat", kwlist, &pInputImages, &pszOutputImage, &pszGDALFormat, &noDataVal, &statType))
+    PyObject *inImagesObj;
+    const char *outputImage;
+    const char *gdalFormat = "KEA";
+    unsigned int imgBand = 1;
+    float threshold = 3.5;
+    unsigned int minObs = 3;
+    float noDataVal = 0;
+    int useNoDataVal = false;
+    int outScores = false;
+    unsigned int numThreads = 1;
+
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "Os|sIfIfiiI:calc_temporal_outlier_chng", kwlist, &inImagesObj, &outputImage, &gdalFormat, &imgBand, &threshold, &minObs, &noDataVal, &useNoDataVal, &outScores, &numThreads))
     {
         return nullptr;
     }
-    
-    if( !PySequence_Check(pInputImages))
+
+    if(!PySequence_Check(inImagesObj))
     {
-        PyErr_SetString(GETSTATE(self)->error, "Input images must be a sequence");
+        PyErr_SetString(GETSTATE(self)->error, "input_imgs must be a sequence");
         return nullptr;
     }
-    
-    Py_ssize_t nImages = PySequence_Size(pInputImages);
+
+    Py_ssize_t nImages = PySequence_Size(inImagesObj);
     std::vector<std::string> inputImages;
     inputImages.reserve(nImages);
-    for( Py_ssize_t n = 0; n < nImages; n++ )
+    for(int i = 0; i < nImages; ++i)
     {
-        PyObject *o = PySequence_GetItem(pInputImages, n);
-        
-        if(!RSGISPY_CHECK_STRING(o))
+        PyObject *inImageObj = PySequence_GetItem(inImagesObj, i);
+        if(!RSGISPY_CHECK_STRING(inImageObj))
         {
+            Py_DECREF(inImageObj);
             PyErr_SetString(GETSTATE(self)->error, "Input images must be strings");
-            Py_DECREF(o);
             return nullptr;
         }
-        
-        inputImages.push_back(RSGISPY_STRING_EXTRACT(o));
-    }
-    
-    rsgis::cmds::RSGISCmdsSummariseStats summaryStats = rsgis::cmds::rsgiscmds_stat_none;
-    if(statType == 3)
-    {
-        summaryStats = rsgis::cmds::rsgiscmds_stat_median;
-    }
-    else if(statType == 4)
-    {
-        summaryStats = rsgis::cmds::rsgiscmds_stat_min;
-    }
-    else if(statType == 5)
-    {
-        summaryStats = rsgis::cmds::rsgiscmds_stat_max;
-    }
-    else
-    {
-        PyErr_SetString(GETSTATE(self)->error, "Do not recognise the summary statistic option - only min, max and median are supported here.");
-        return nullptr;
+        inputImages.push_back(RSGISPY_STRING_EXTRACT(inImageObj));
+        Py_DECREF(inImageObj);
     }
-    
+
     try
     {
-        rsgis::cmds::executeGetImgIdxForStat(inputImages, std::string(pszOutputImage), std::string(pszGDALFormat), noDataVal, summaryStats);
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeTemporalOutlierChange(inputImages, imgBand, std::string(outputImage), std::string(gdalFormat), threshold, minObs, (bool)useNoDataVal, noDataVal, (bool)outScores, numThreads);
     }
-    catch(rsgis::cmds::RSGISCmdException &e)
+    catch (rsgis::cmds::RSGISCmdException &e)
     {
         PyErr_SetString(GETSTATE(self)->error, e.what());
         return nullptr;
     }
-    
+
     Py_RETURN_NONE;
 }
 
+static bool ImageCalc_ParseTemporalFitInputs(PyObject *self, PyObject *inImagesObj, PyObject *datesObj, std::vector<std::string> *inputImages, std::vector<double> *dates)
+{
+    if(!PySequence_Check(inImagesObj) || !PySequence_Check(datesObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "input_imgs and dates must be sequences");
+        return false;
+    }
+
+    Py_ssize_t nImages = PySequence_Size(inImagesObj);
+    if(PySequence_Size(datesObj) != nImages)
+    {
+        PyErr_SetString(GETSTATE(self)->error, "A date must be provided for each input image");
+        return false;
+    }
+    for(Py_ssize_t i = 0; i < nImages; ++i)
+    {
+        PyObject *inImageObj = PySequence_GetItem(inImagesObj, i);
+        if(!RSGISPY_CHECK_STRING(inImageObj))
+        {
+            Py_DECREF(inImageObj);
+            PyErr_SetString(GETSTATE(self)->error, "Input images must be strings");
+            return false;
+        }
+        inputImages->push_back(RSGISPY_STRING_EXTRACT(inImageObj));
+        Py_DECREF(inImageObj);
 
+        PyObject *dateObj = PySequence_GetItem(datesObj, i);
+        double date = PyFloat_AsDouble(dateObj);
+        Py_DECREF(dateObj);
+        if(PyErr_Occurred())
+        {
+            PyErr_Clear();
+            PyErr_SetString(GETSTATE(self)->error, "The dates must be numbers (e.g., date ordinals)");
+            return false;
+        }
+        dates->push_back(date);
+    }
+    return true;
+}
 
-static PyObject *ImageCalc_GetImgSumStatsInPxl(PyObject *self, PyObject *args, PyObject *keywds)
+static PyObject *ImageCalc_CalcTemporalRobustFitOutliers(PyObject *self, PyObject *args, PyObject *keywds)
 {
-    static char *kwlist[] = {RSGIS_PY_C_TEXT("in_ref_img"), RSGIS_PY_C_TEXT("in_stats_img"),
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("dates"),
+                             RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("img_bands"), RSGIS_PY_C_TEXT("threshold"),
+                             RSGIS_PY_C_TEXT("min_obs"), RSGIS_PY_C_TEXT("max_iters"),
+                             RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("use_no_data"),
+                             RSGIS_PY_C_TEXT("ref_img"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
+
+    PyObject *inImagesObj;
+    PyObject *datesObj;
+    const char *outputImage;
+    const char *gdalFormat = "KEA";
+    PyObject *imgBandsObj = Py_None;
+    float threshold = 3;
+    unsigned int minObs = 12;
+    unsigned int maxIters = 50;
+    float noDataVal = 0;
+    int useNoDataVal = false;
+    const char *refImage = "";
+    unsigned int numThreads = 1;
+
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "OOs|sOfIIfizI:calc_temporal_robust_fit_outliers", kwlist, &inImagesObj, &datesObj, &outputImage, &gdalFormat, &imgBandsObj, &threshold, &minObs, &maxIters, &noDataVal, &useNoDataVal, &refImage, &numThreads))
+    {
+        return nullptr;
+    }
+
+    std::vector<std::string> inputImages;
+    std::vector<double> dates;
+    if(!ImageCalc_ParseTemporalFitInputs(self, inImagesObj, datesObj, &inputImages, &dates))
+    {
+        return nullptr;
+    }
+
+    // If no bands are specified (empty) all the image bands are used.
+    std::vector<unsigned int> imgBands;
+    if(imgBandsObj != Py_None)
+    {
+        if(!PySequence_Check(imgBandsObj))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "img_bands must be a sequence");
+            return nullptr;
+        }
+        Py_ssize_t nBands = PySequence_Size(imgBandsObj);
+        for(Py_ssize_t i = 0; i < nBands; ++i)
+        {
+            PyObject *bandObj = PySequence_GetItem(imgBandsObj, i);
+            if(!RSGISPY_CHECK_INT(bandObj))
+            {
+                Py_DECREF(bandObj);
+                PyErr_SetString(GETSTATE(self)->error, "The image bands must be integers");
+                return nullptr;
+            }
+            imgBands.push_back(RSGISPY_UINT_EXTRACT(bandObj));
+            Py_DECREF(bandObj);
+        }
+    }
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeTemporalRobustFit(inputImages, dates, imgBands, std::string(outputImage), std::string(gdalFormat), false, threshold, minObs, maxIters, (bool)useNoDataVal, noDataVal, std::string((refImage == nullptr)?"":refImage), numThreads);
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageCalc_CalcTemporalTMask(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("dates"),
+                             RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("green_band"), RSGIS_PY_C_TEXT("nir_band"),
+                             RSGIS_PY_C_TEXT("swir_band"), RSGIS_PY_C_TEXT("threshold"),
+                             RSGIS_PY_C_TEXT("min_obs"), RSGIS_PY_C_TEXT("max_iters"),
+                             RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("use_no_data"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
+
+    PyObject *inImagesObj;
+    PyObject *datesObj;
+    const char *outputImage;
+    const char *gdalFormat = "KEA";
+    unsigned int greenBand = 2;
+    unsigned int nirBand = 4;
+    unsigned int swirBand = 5;
+    float threshold = 40;
+    unsigned int minObs = 12;
+    unsigned int maxIters = 5;
+    float noDataVal = 0;
+    int useNoDataVal = false;
+    unsigned int numThreads = 1;
+
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "OOs|sIIIfIIfiI:calc_temporal_tmask", kwlist, &inImagesObj, &datesObj, &outputImage, &gdalFormat, &greenBand, &nirBand, &swirBand, &threshold, &minObs, &maxIters, &noDataVal, &useNoDataVal, &numThreads))
+    {
+        return nullptr;
+    }
+
+    std::vector<std::string> inputImages;
+    std::vector<double> dates;
+    if(!ImageCalc_ParseTemporalFitInputs(self, inImagesObj, datesObj, &inputImages, &dates))
+    {
+        return nullptr;
+    }
+
+    std::vector<unsigned int> imgBands;
+    imgBands.push_back(greenBand);
+    imgBands.push_back(nirBand);
+    imgBands.push_back(swirBand);
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeTemporalRobustFit(inputImages, dates, imgBands, std::string(outputImage), std::string(gdalFormat), true, threshold, minObs, maxIters, (bool)useNoDataVal, noDataVal, "", numThreads);
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageCalc_CalcImageDifference(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("in_a_img"), RSGIS_PY_C_TEXT("in_b_img"),
+                             RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("datatype"), nullptr};
+
+    const char *inputImage1, *inputImage2, *outputImage, *gdalFormat;
+    int datatype;
+    
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssssi:calc_img_difference", kwlist, &inputImage1, &inputImage2, &outputImage, &gdalFormat, &datatype))
+    {
+        return nullptr;
+    }
+    
+    try
+    {
+        rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)datatype;
+        rsgis::cmds::calcImageDifference(std::string(inputImage1), std::string(inputImage2), std::string(outputImage), std::string(gdalFormat), type);
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageCalc_CalcImageComparisonStats(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("in_a_img"), RSGIS_PY_C_TEXT("in_b_img"),
+                             RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("datatype"), nullptr};
+
+    const char *inputImage1, *inputImage2;
+    const char *outputImage = "";
+    const char *gdalFormat = "KEA";
+    int datatype = rsgis::rsgis_32float;
+    
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ss|ssi:calc_img_comparison_stats", kwlist, &inputImage1, &inputImage2, &outputImage, &gdalFormat, &datatype))
+    {
+        return nullptr;
+    }
+    
+    PyObject *outList = nullptr;
+    try
+    {
+        std::vector<rsgis::cmds::ImageComparisonStatsCmds> bandStats;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)datatype;
+            bandStats = rsgis::cmds::executeImageComparison(std::string(inputImage1), std::string(inputImage2), std::string(outputImage), std::string(gdalFormat), type);
+        }
+        
+        outList = PyList_New(bandStats.size());
+        for(size_t i = 0; i < bandStats.size(); ++i)
+        {
+            PyObject *bandDict = Py_BuildValue("{s:k,s:d,s:d,s:d,s:d}", "n_pxls", bandStats[i].numPxls, "rmse", bandStats[i].rmse, "bias", bandStats[i].bias, "mean_abs_diff", bandStats[i].meanAbsDiff, "correlation", bandStats[i].correlation);
+            if(PyList_SetItem(outList, i, bandDict) == -1)
+            {
+                throw rsgis::cmds::RSGISCmdException("Failed to add band comparison statistics to the list...");
+            }
+        }
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        Py_XDECREF(outList);
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    return outList;
+}
+
+static PyObject *ImageCalc_GetImageBandMinMax(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("img_band"),
+                             RSGIS_PY_C_TEXT("use_no_data"), RSGIS_PY_C_TEXT("no_data_val"), nullptr};
+    const char *inputImage;
+    int imgBand;
+    int useNoDataVal = false;
+    float noDataVal = 0.0;
+    
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "si|if:get_img_band_min_max", kwlist, &inputImage, &imgBand, &useNoDataVal, &noDataVal))
+    {
+        return nullptr;
+    }
+    
+    PyObject *outList = PyTuple_New(2);
+    try
+    {
+        std::pair<double, double> outVals = rsgis::cmds::getImageBandMinMax(std::string(inputImage), imgBand, (bool)useNoDataVal, noDataVal);
+        
+        if(PyTuple_SetItem(outList, 0, Py_BuildValue("d", outVals.first)) == -1)
+        {
+            throw rsgis::cmds::RSGISCmdException("Failed to add min value to output tuple...");
+        }
+        if(PyTuple_SetItem(outList, 1, Py_BuildValue("d", outVals.second)) == -1)
+        {
+            throw rsgis::cmds::RSGISCmdException("Failed to add max value to output tuple...");
+        }
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    return outList;
+}
+
+static PyObject *ImageCalc_CalcImageRescale(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("output_img"),
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("datatype"),
+                             RSGIS_PY_C_TEXT("c_no_data_val"),
+                             RSGIS_PY_C_TEXT("c_offset"), RSGIS_PY_C_TEXT("c_gain"),
+                             RSGIS_PY_C_TEXT("n_no_data_val"),
+                             RSGIS_PY_C_TEXT("n_offset"), RSGIS_PY_C_TEXT("n_gain"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
+    PyObject *pInputImgsObj;
+    const char *outputImage, *gdalFormat;
+    int datatype;
+    float cNoDataVal, cOffset, cGain, nNoDataVal, nOffset, nGain = 0.0;
+    unsigned int nThreads = 1;
+    
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "Ossiffffff|I:calc_img_rescale", kwlist, &pInputImgsObj, &outputImage, &gdalFormat, &datatype, &cNoDataVal, &cOffset, &cGain, &nNoDataVal, &nOffset, &nGain, &nThreads))
+    {
+        return nullptr;
+    }
+    
+    std::vector<std::string> input_imgs;
+    if(RSGISPY_CHECK_STRING(pInputImgsObj))
+    {
+        input_imgs.push_back(RSGISPY_STRING_EXTRACT(pInputImgsObj));
+    }
+    else if(PySequence_Check(pInputImgsObj))
+    {
+        Py_ssize_t nInputImgs = PySequence_Size(pInputImgsObj);
+        for( Py_ssize_t n = 0; n < nInputImgs; n++ )
+        {
+            PyObject *strObj = PySequence_GetItem(pInputImgsObj, n);
+            if(RSGISPY_CHECK_STRING(strObj))
+            {
+                input_imgs.push_back(RSGISPY_STRING_EXTRACT(strObj));
+            }
+            else
+            {
+                PyErr_SetString(GETSTATE(self)->error, "Input images sequence must contain a list of strings");
+                return nullptr;
+            }
+        }
+    }
+    else
+    {
+        PyErr_SetString(GETSTATE(self)->error, "Input images parameter must be either a single string or a sequence of strings");
+        return nullptr;
+    }
+    
+    try
+    {
+        rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)datatype;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeRescaleImages(input_imgs, std::string(outputImage), std::string(gdalFormat), type, cNoDataVal, cOffset, cGain, nNoDataVal, nOffset, nGain, nThreads);
+        }
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageCalc_GetImgIdxForStat(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("output_img"),
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("no_data_val"),
+                             RSGIS_PY_C_TEXT("stat"), nullptr};
+    PyObject *pInputImages;
+    const char *pszOutputImage = "";
+    const char *pszGDALFormat = "";
+    float noDataVal = 0.0;
+    int statType;
+
+    
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Ossfi:get_img_idx_for_stat", kwlist, &pInputImages, &pszOutputImage, &pszGDALFormat, &noDataVal, &statType))
+    {
+        return nullptr;
+    }
+    
+    if( !PySequence_Check(pInputImages))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "Input images must be a sequence");
+        return nullptr;
+    }
+    
+    Py_ssize_t nImages = PySequence_Size(pInputImages);
+    std::vector<std::string> inputImages;
+    inputImages.reserve(nImages);
+    for( Py_ssize_t n = 0; n < nImages; n++ )
+    {
+        PyObject *o = PySequence_GetItem(pInputImages, n);
+        
+        if(!RSGISPY_CHECK_STRING(o))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "Input images must be strings");
+            Py_DECREF(o);
+            return nullptr;
+        }
+        
+        inputImages.push_back(RSGISPY_STRING_EXTRACT(o));
+    }
+    
+    rsgis::cmds::RSGISCmdsSummariseStats summaryStats = rsgis::cmds::rsgiscmds_stat_none;
+    if(statType == 3)
+    {
+        summaryStats = rsgis::cmds::rsgiscmds_stat_median;
+    }
+    else if(statType == 4)
+    {
+        summaryStats = rsgis::cmds::rsgiscmds_stat_min;
+    }
+    else if(statType == 5)
+    {
+        summaryStats = rsgis::cmds::rsgiscmds_stat_max;
+    }
+    else
+    {
+        PyErr_SetString(GETSTATE(self)->error, "Do not recognise the summary statistic option - only min, max and median are supported here.");
+        return nullptr;
+    }
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeGetImgIdxForStat(inputImages, std::string(pszOutputImage), std::string(pszGDALFormat), noDataVal, summaryStats);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+
+
+static PyObject *ImageCalc_GetImgSumStatsInPxl(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("in_ref_img"), RSGIS_PY_C_TEXT("in_stats_img"),
                              RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
                              RSGIS_PY_C_TEXT("datatype"), RSGIS_PY_C_TEXT("sum_stats"),
                              RSGIS_PY_C_TEXT("stats_img_band"), RSGIS_PY_C_TEXT("use_no_data"),
@@ -1651,7 +2214,10 @@ static PyObject *ImageCalc_GetImgSumStatsInPxl(PyObject *self, PyObject *args, P
     {
         bool useNoData = (bool) useImgDataVal;
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)datatype;
-        rsgis::cmds::executeGetWithinPxlImgStatSummaries(std::string(pInputRefImage), std::string(pInputStatsImage), statsImgBand, std::string(pszOutputImage), std::string(pszGDALFormat), type, useNoData, cmdSumStats, xIOGrid, yIOGrid);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeGetWithinPxlImgStatSummaries(std::string(pInputRefImage), std::string(pInputStatsImage), statsImgBand, std::string(pszOutputImage), std::string(pszGDALFormat), type, useNoData, cmdSumStats, xIOGrid, yIOGrid);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1719,7 +2285,10 @@ static PyObject *ImageCalc_IdentifyMinPxlValueInWin(PyObject *self, PyObject *ar
     try
     {
         bool useNoData = (bool) useNoDataValue;
-        rsgis::cmds::executeIdentifyMinPxlValueInWin(std::string(pInputImage), std::string(pszOutputImage), std::string(pszOutputRefImage), bandsVec, winSize, std::string(pszGDALFormat), noDataValue, useNoData);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeIdentifyMinPxlValueInWin(std::string(pInputImage), std::string(pszOutputImage), std::string(pszOutputRefImage), bandsVec, winSize, std::string(pszGDALFormat), noDataValue, useNoData);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1782,7 +2351,10 @@ static PyObject *ImageCalc_CalcImgMeanInMask(PyObject *self, PyObject *args, PyO
     try
     {
         bool useNoData = (bool) useNoDataValue;
-        meanVal = rsgis::cmds::executeCalcImgMeanInMask(std::string(pInputImage), std::string(pInputImageMsk), mskValue, bandsVec, noDataValue, useNoData);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            meanVal = rsgis::cmds::executeCalcImgMeanInMask(std::string(pInputImage), std::string(pInputImageMsk), mskValue, bandsVec, noDataValue, useNoData);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1794,6 +2366,364 @@ static PyObject *ImageCalc_CalcImgMeanInMask(PyObject *self, PyObject *args, PyO
     return outVal;
 }
 
+static PyObject *ImageCalc_BandMathArray(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("out_arr"), RSGIS_PY_C_TEXT("exp"), RSGIS_PY_C_TEXT("band_arrs"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
+    PyObject *outArrObj;
+    const char *pszExpression;
+    PyObject *bandArrsObj;
+    unsigned int nThreads = 1;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "OsO|I:band_math_array", kwlist, &outArrObj, &pszExpression, &bandArrsObj, &nThreads))
+    {
+        return nullptr;
+    }
+    
+    if( !PyDict_Check(bandArrsObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "band_arrs must be a dict of the variable names and arrays");
+        return nullptr;
+    }
+    
+    RSGISPyArrayBuffer outBuf;
+    if(!outBuf.getBuffer(outArrObj, 'd', true, GETSTATE(self)->error, "out_arr"))
+    {
+        return nullptr;
+    }
+    size_t nPxls = outBuf.getNumItems();
+    
+    Py_ssize_t nVars = PyDict_Size(bandArrsObj);
+    std::vector<std::string> varNames;
+    std::vector<RSGISPyArrayBuffer> bandBufs(nVars);
+    std::vector<const float*> bands;
+    PyObject *key, *value;
+    Py_ssize_t pos = 0;
+    while(PyDict_Next(bandArrsObj, &pos, &key, &value))
+    {
+        if(!RSGISPY_CHECK_STRING(key))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "The variable names in band_arrs must be strings");
+            return nullptr;
+        }
+        size_t i = varNames.size();
+        varNames.push_back(RSGISPY_STRING_EXTRACT(key));
+        if(!bandBufs[i].getBuffer(value, 'f', false, GETSTATE(self)->error, varNames.back().c_str()))
+        {
+            return nullptr;
+        }
+        if(bandBufs[i].getNumItems() != nPxls)
+        {
+            PyErr_SetString(GETSTATE(self)->error, "The arrays in band_arrs must be the same size as out_arr");
+            return nullptr;
+        }
+        bands.push_back((const float*)bandBufs[i].getData());
+    }
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeBandMathsArrays(varNames, bands.data(), nPxls, std::string(pszExpression), (double*)outBuf.getData(), nThreads);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageCalc_GetBandStatsArray(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("band_arrs"), RSGIS_PY_C_TEXT("no_data_val"),
+                             RSGIS_PY_C_TEXT("calc_stddev"), nullptr};
+    PyObject *bandArrsObj;
+    PyObject *noDataValueObj = Py_None;
+    int calcStdDev = 1;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "O|Oi:get_band_stats_array", kwlist, &bandArrsObj, &noDataValueObj, &calcStdDev))
+    {
+        return nullptr;
+    }
+    
+    if( !PySequence_Check(bandArrsObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "band_arrs must be a sequence of arrays");
+        return nullptr;
+    }
+    
+    bool noDataValueSpecified = false;
+    float noDataValue = 0.0;
+    if( (noDataValueObj != Py_None) && (RSGISPY_CHECK_FLOAT(noDataValueObj) || RSGISPY_CHECK_INT(noDataValueObj)) )
+    {
+        noDataValueSpecified = true;
+        noDataValue = RSGISPY_FLOAT_EXTRACT(noDataValueObj);
+    }
+    
+    Py_ssize_t nBands = PySequence_Size(bandArrsObj);
+    if(nBands < 1)
+    {
+        PyErr_SetString(GETSTATE(self)->error, "band_arrs must contain at least one array");
+        return nullptr;
+    }
+    std::vector<RSGISPyArrayBuffer> bandBufs(nBands);
+    std::vector<const float*> bands(nBands);
+    size_t nPxls = 0;
+    for(Py_ssize_t i = 0; i < nBands; ++i)
+    {
+        PyObject *o = PySequence_GetItem(bandArrsObj, i);
+        bool gotBuf = bandBufs[i].getBuffer(o, 'f', false, GETSTATE(self)->error, "band_arrs");
+        Py_DECREF(o);
+        if(!gotBuf)
+        {
+            return nullptr;
+        }
+        if(i == 0)
+        {
+            nPxls = bandBufs[i].getNumItems();
+        }
+        else if(bandBufs[i].getNumItems() != nPxls)
+        {
+            PyErr_SetString(GETSTATE(self)->error, "The arrays in band_arrs must all be the same size");
+            return nullptr;
+        }
+        bands[i] = (const float*)bandBufs[i].getData();
+    }
+    
+    std::vector<rsgis::cmds::ImageStatsCmds> stats(nBands);
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeImageBandStatsArrays(bands.data(), nBands, nPxls, stats.data(), noDataValueSpecified, noDataValue, (bool)calcStdDev);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    PyObject *outStatsList = PyTuple_New(nBands);
+    for(Py_ssize_t i = 0; i < nBands; ++i)
+    {
+        PyObject *outValsList = Py_BuildValue("(ddddd)", stats[i].min, stats[i].max, stats[i].mean, stats[i].stddev, stats[i].sum);
+        if((outValsList == nullptr) || (PyTuple_SetItem(outStatsList, i, outValsList) == -1))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "Failed to add the band statistics to the list...");
+            Py_DECREF(outStatsList);
+            return nullptr;
+        }
+    }
+    
+    return outStatsList;
+}
+
+static PyObject *ImageCalc_FilterArray(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("in_arr"), RSGIS_PY_C_TEXT("out_arr"), RSGIS_PY_C_TEXT("filter_type"),
+                             RSGIS_PY_C_TEXT("size"), RSGIS_PY_C_TEXT("option"), RSGIS_PY_C_TEXT("n_threads"),
+                             RSGIS_PY_C_TEXT("stddev"), RSGIS_PY_C_TEXT("stddev_x"), RSGIS_PY_C_TEXT("stddev_y"),
+                             RSGIS_PY_C_TEXT("angle"), RSGIS_PY_C_TEXT("n_looks"), RSGIS_PY_C_TEXT("percentile"),
+                             RSGIS_PY_C_TEXT("hist_min"), RSGIS_PY_C_TEXT("hist_max"), RSGIS_PY_C_TEXT("hist_bin_width"), nullptr};
+    PyObject *inArrObj;
+    PyObject *outArrObj;
+    const char *pszFilterType;
+    unsigned int size = 3;
+    const char *pszOption = "";
+    unsigned int nThreads = 1;
+    rsgis::cmds::RSGISFilterParameters filterParams;
+    filterParams.stddev = 1;
+    filterParams.stddevX = 1;
+    filterParams.stddevY = 1;
+    filterParams.angle = 0;
+    filterParams.nLooks = 1;
+    filterParams.percentile = 50;
+    filterParams.histMin = 0;
+    filterParams.histMax = 0;
+    filterParams.histBinWidth = 1;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "OOs|IsIffffIffff:filter_array", kwlist, &inArrObj, &outArrObj, &pszFilterType, &size, &pszOption, &nThreads,
+                                     &filterParams.stddev, &filterParams.stddevX, &filterParams.stddevY, &filterParams.angle, &filterParams.nLooks,
+                                     &filterParams.percentile, &filterParams.histMin, &filterParams.histMax, &filterParams.histBinWidth))
+    {
+        return nullptr;
+    }
+    filterParams.type = std::string(pszFilterType);
+    filterParams.option = std::string(pszOption);
+    filterParams.size = size;
+    
+    RSGISPyArrayBuffer inBuf;
+    if(!inBuf.getBuffer(inArrObj, 'f', false, GETSTATE(self)->error, "in_arr"))
+    {
+        return nullptr;
+    }
+    RSGISPyArrayBuffer outBuf;
+    if(!outBuf.getBuffer(outArrObj, 'd', true, GETSTATE(self)->error, "out_arr"))
+    {
+        return nullptr;
+    }
+    
+    // The arrays are either [rows, cols] or [bands, rows, cols].
+    int nDims = inBuf.getNumDims();
+    if(((nDims != 2) && (nDims != 3)) || (outBuf.getNumDims() != nDims))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "in_arr and out_arr must both be 2D [rows, cols] or 3D [bands, rows, cols] arrays");
+        return nullptr;
+    }
+    for(int i = 0; i < nDims; ++i)
+    {
+        if(inBuf.getDimSize(i) != outBuf.getDimSize(i))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "in_arr and out_arr must be the same shape");
+            return nullptr;
+        }
+    }
+    unsigned int nBands = (nDims == 3)?inBuf.getDimSize(0):1;
+    size_t height = inBuf.getDimSize(nDims-2);
+    size_t width = inBuf.getDimSize(nDims-1);
+    std::vector<const float*> bands(nBands);
+    std::vector<double*> outBands(nBands);
+    for(unsigned int n = 0; n < nBands; ++n)
+    {
+        bands[n] = ((const float*)inBuf.getData()) + (n * width * height);
+        outBands[n] = ((double*)outBuf.getData()) + (n * width * height);
+    }
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeFilterArrays(bands.data(), nBands, width, height, &filterParams, outBands.data(), nThreads);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageCalc_CalcCostDistance(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("cost_img"), RSGIS_PY_C_TEXT("out_dist_img"),
+                             RSGIS_PY_C_TEXT("out_dir_img"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("src_img"), RSGIS_PY_C_TEXT("src_coords"),
+                             RSGIS_PY_C_TEXT("img_band"), RSGIS_PY_C_TEXT("no_data_val"),
+                             RSGIS_PY_C_TEXT("tile_size"), nullptr};
+    const char *pszCostImage, *pszOutDistImage, *pszOutDirImage;
+    const char *pszGDALFormat = "KEA";
+    PyObject *pSrcImgObj = Py_None;
+    PyObject *pSrcCoordsObj = Py_None;
+    unsigned int imgBand = 1;
+    PyObject *pNoDataValObj = Py_None;
+    unsigned int tileSize = 0;
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "sss|sOOIOI:calc_cost_distance", kwlist, &pszCostImage, &pszOutDistImage, &pszOutDirImage,
+                                    &pszGDALFormat, &pSrcImgObj, &pSrcCoordsObj, &imgBand, &pNoDataValObj, &tileSize))
+    {
+        return nullptr;
+    }
+    
+    std::string srcImage = "";
+    if(pSrcImgObj != Py_None)
+    {
+        if(!RSGISPY_CHECK_STRING(pSrcImgObj))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "src_img must be a string or None.");
+            return nullptr;
+        }
+        srcImage = RSGISPY_STRING_EXTRACT(pSrcImgObj);
+    }
+    
+    std::vector<std::pair<double, double> > srcCoords;
+    if(pSrcCoordsObj != Py_None)
+    {
+        if(!PySequence_Check(pSrcCoordsObj))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "src_coords must be a list of (x, y) coordinates.");
+            return nullptr;
+        }
+        Py_ssize_t nCoords = PySequence_Size(pSrcCoordsObj);
+        for(Py_ssize_t i = 0; i < nCoords; ++i)
+        {
+            PyObject *o = PySequence_GetItem(pSrcCoordsObj, i);
+            double x = 0;
+            double y = 0;
+            int parsed = PyArg_ParseTuple(o, "dd", &x, &y);
+            Py_DECREF(o);
+            if(!parsed)
+            {
+                PyErr_SetString(GETSTATE(self)->error, "src_coords must be a list of (x, y) coordinates.");
+                return nullptr;
+            }
+            srcCoords.push_back(std::pair<double, double>(x, y));
+        }
+    }
+    
+    if(srcImage.empty() && srcCoords.empty())
+    {
+        PyErr_SetString(GETSTATE(self)->error, "A src_img or src_coords must be provided.");
+        return nullptr;
+    }
+    
+    bool useNoData = false;
+    float noDataVal = 0;
+    if(pNoDataValObj != Py_None)
+    {
+        noDataVal = PyFloat_AsDouble(pNoDataValObj);
+        if(PyErr_Occurred())
+        {
+            PyErr_Clear();
+            PyErr_SetString(GETSTATE(self)->error, "no_data_val must be a number or None.");
+            return nullptr;
+        }
+        useNoData = true;
+    }
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeCostDistance(std::string(pszCostImage), imgBand, srcImage, srcCoords, std::string(pszOutDistImage),
+                                         std::string(pszOutDirImage), std::string(pszGDALFormat), useNoData, noDataVal, tileSize);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageCalc_GetLeastCostPath(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("dir_img"), RSGIS_PY_C_TEXT("coord"),
+                             RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"), nullptr};
+    const char *pszDirImage;
+    double x, y;
+    const char *pszOutputImage = "";
+    const char *pszGDALFormat = "KEA";
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "s(dd)|ss:get_least_cost_path", kwlist, &pszDirImage, &x, &y, &pszOutputImage, &pszGDALFormat))
+    {
+        return nullptr;
+    }
+    
+    std::vector<std::pair<double, double> > pathCoords;
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        pathCoords = rsgis::cmds::executeLeastCostPath(std::string(pszDirImage), x, y, std::string(pszOutputImage), std::string(pszGDALFormat));
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    PyObject *pPathList = PyList_New(pathCoords.size());
+    for(size_t i = 0; i < pathCoords.size(); ++i)
+    {
+        PyList_SET_ITEM(pPathList, i, Py_BuildValue("(dd)", pathCoords[i].first, pathCoords[i].second));
+    }
+    return pPathList;
+}
+
 // Our list of functions in this module
 static PyMethodDef ImageCalcMethods[] = {
     {"band_math", (PyCFunction)ImageCalc_BandMath, METH_VARARGS | METH_KEYWORDS,
@@ -1830,6 +2760,53 @@ static PyMethodDef ImageCalcMethods[] = {
 "   rsgislib.imagecalc.band_math('out.kea', '(b1==1) || (b2==1) || (b3==1)?1:0', 'KEA', rsgislib.TYPE_8UINT, band_defns)\n"
 "\n\n"},
 
+{"band_math_array", (PyCFunction)ImageCalc_BandMathArray, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imagecalc.band_math_array(out_arr:numpy.array, exp:str, band_arrs:dict, n_threads:int=1)\n"
+"Performs a band math calculation on arrays in memory (e.g., blocks read with numpy), "
+"using the same expression syntax as rsgislib.imagecalc.band_math. The arrays are used "
+"in place rather than copied.\n"
+"\n"
+":param out_arr: is a C contiguous numpy.float64 array the result is written to.\n"
+":param exp: is a string containing the expression to run over the arrays, uses muparser syntax.\n"
+":param band_arrs: is a dict of the variable names used in the expression and the C contiguous numpy.float32 arrays, each with the same number of values as out_arr.\n"
+":param n_threads: is an optional int specifying the number of threads used (Default: 1; 0 uses all the available cores).\n"
+"\n"
+".. code:: python\n"
+"   \n"
+"   import numpy\n"
+"   import rsgislib.imagecalc\n"
+"   \n"
+"   out_arr = numpy.zeros_like(b1_arr, dtype=numpy.float64)\n"
+"   rsgislib.imagecalc.band_math_array(out_arr, '(b2-b1)/(b2+b1)', {'b1':b1_arr.astype(numpy.float32), 'b2':b2_arr.astype(numpy.float32)})\n"
+"\n"},
+
+{"get_band_stats_array", (PyCFunction)ImageCalc_GetBandStatsArray, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imagecalc.get_band_stats_array(band_arrs:list, no_data_val:float=None, calc_stddev:bool=True)\n"
+"Calculates the statistics for each of a list of arrays in memory (e.g., the bands of a block read with numpy). "
+"The arrays are used in place rather than copied.\n"
+"\n"
+":param band_arrs: is a sequence of C contiguous numpy.float32 arrays (e.g., a [bands, rows, cols] array), each with the same number of values.\n"
+":param no_data_val: is an optional float for the no data value to be ignored (Default: None).\n"
+":param calc_stddev: is an optional bool specifying whether the standard deviation is calculated (Default: True).\n"
+":return: a list of [min, max, mean, stddev, sum] for each array\n"
+"\n"},
+
+{"filter_array", (PyCFunction)ImageCalc_FilterArray, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imagecalc.filter_array(in_arr:numpy.array, out_arr:numpy.array, filter_type:str, size:int=3, option:str='', n_threads:int=1, stddev:float=1, stddev_x:float=1, stddev_y:float=1, angle:float=0, n_looks:int=1, percentile:float=50, hist_min:float=0, hist_max:float=0, hist_bin_width:float=1)\n"
+"Applies one of the filters of rsgislib.imagefilter.apply_filters to arrays in memory "
+"(e.g., blocks read with numpy). The pixels outside of the array are taken as 0, so "
+"read the block with an overlap of size/2 pixels to avoid edge effects. The arrays are "
+"used in place rather than copied.\n"
+"\n"
+":param in_arr: is a C contiguous numpy.float32 array, either [rows, cols] or [bands, rows, cols].\n"
+":param out_arr: is a C contiguous numpy.float64 array of the same shape as in_arr the result is written to.\n"
+":param filter_type: is a string with the filter type (e.g., 'Mean', 'Median', 'StdDev', 'GaussianSmooth', 'Sobel'; see rsgislib.imagefilter.FilterParameters).\n"
+":param size: is an optional int with the size of the filter window (Default: 3).\n"
+":param option: is an optional string with the filter option (e.g., 'x', 'y' or 'xy' for 'Sobel'; Default: '').\n"
+":param n_threads: is an optional int specifying the number of threads used (Default: 1; 0 uses all the available cores).\n"
+":param stddev, stddev_x, stddev_y, angle, n_looks, percentile, hist_min, hist_max, hist_bin_width: are the optional filter parameters, as for rsgislib.imagefilter.FilterParameters.\n"
+"\n"},
+
 {"image_math", (PyCFunction)ImageCalc_ImageMath, METH_VARARGS | METH_KEYWORDS,
 "rsgislib.imagecalc.image_math(input_img, output_img, exp, gdalformat, datatype, exp_band_name, output_exists)\n"
 "Performs image math calculations. Produces an output image file with the same number of bands as the input image.\n"
@@ -1887,7 +2864,7 @@ static PyMethodDef ImageCalcMethods[] = {
 "\n"},
 
 {"kmeans_clustering", (PyCFunction)ImageCalc_KMeansClustering, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imagecalc.kmeans_clustering(input_img, out_file, n_clusters, max_n_iters, sub_sample, ignore_zeros, degree_change, init_cluster_method)\n"
+"rsgislib.imagecalc.kmeans_clustering(input_img, out_file, n_clusters, max_n_iters, sub_sample, ignore_zeros, degree_change, init_cluster_method, n_threads=1)\n"
 "Performs K Means Clustering and saves cluster centres to a text file.\n"
 "\n"
 ":param input_img: is a string providing the input image\n"
@@ -1898,6 +2875,7 @@ static PyMethodDef ImageCalcMethods[] = {
 ":param ignore_zeros: is a bool specifying if zeros in the image should be treated as no data.\n"
 ":param degree_change: is a float providing the minimum change between iterations before terminating.\n"
 ":param init_cluster_method: the method for initialising the clusters and is one of INITCLUSTER_* values\n"
+":param n_threads: is the number of threads used to assign the pixels to the clusters (Default: 1; 0 uses all the available cores).\n"
 "\n"
 ".. code:: python\n"
 "\n"
@@ -1914,7 +2892,7 @@ static PyMethodDef ImageCalcMethods[] = {
 "\n"},
 
 {"isodata_clustering", (PyCFunction)ImageCalc_ISODataClustering, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imagecalc.isodata_clustering(input_img, out_file, n_clusters, max_n_iters, sub_sample, ignore_zeros, degree_change, init_cluster_method, min_dist_clusters, min_n_feats, max_std_dev, min_n_clusters, start_iter, end_iter)\n"
+"rsgislib.imagecalc.isodata_clustering(input_img, out_file, n_clusters, max_n_iters, sub_sample, ignore_zeros, degree_change, init_cluster_method, min_dist_clusters, min_n_feats, max_std_dev, min_n_clusters, start_iter, end_iter, n_threads=1)\n"
 "Performs ISO Data Clustering and saves cluster centres to a text file.\n"
 "\n"
 ":param input_img: is a string providing the input image\n"
@@ -1931,6 +2909,7 @@ static PyMethodDef ImageCalcMethods[] = {
 ":param min_n_clusters: is an int\n"
 ":param start_iter: is an int\n"
 ":param end_iter: is an int\n"
+":param n_threads: is the number of threads used to assign the pixels to the clusters (Default: 1; 0 uses all the available cores).\n"
 "\n"
 ".. code:: python\n"
 "\n"
@@ -2003,7 +2982,7 @@ static PyMethodDef ImageCalcMethods[] = {
 },
 
 {"pca", (PyCFunction)ImageCalc_PCA, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imagecalc.pca(input_img, eigen_vec_file, output_img, n_comps, gdalformat, dataType)\n"
+"rsgislib.imagecalc.pca(input_img, eigen_vec_file, output_img, n_comps, gdalformat, dataType, n_threads=1)\n"
 "Performs a principal components analysis of an image using a defined set of eigenvectors.\n"
 "The eigenvectors can be calculated using the rsgislib.imagecalc.getPCAEigenVector function.\n"
 "\n"
@@ -2013,6 +2992,7 @@ static PyMethodDef ImageCalcMethods[] = {
 ":param n_comps: is an int containing number of components to use for PCA\n"
 ":param gdalformat: is a string containing the GDAL format for the output file - eg 'KEA'\n"
 ":param datatype: is an int containing one of the values from rsgislib.TYPE_*\n"
+":param n_threads: is the number of threads used to apply the eigenvectors to the image (Default: 1; 0 uses all the available cores).\n"
 "\n"
 ".. code:: python\n"
 "\n"
@@ -2028,6 +3008,23 @@ static PyMethodDef ImageCalcMethods[] = {
 "\n"
 },
 
+{"calc_pca_eigen_vectors", (PyCFunction)ImageCalc_CalcPCAEigenVectors, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imagecalc.calc_pca_eigen_vectors(input_img, out_matrix_file, no_data_val=None, n_threads=1)\n"
+"Calculates the eigenvectors for a principal components analysis from the covariance\n"
+"of all the image pixels, which is accumulated in a single pass over the image (i.e.,\n"
+"without holding the pixel values in memory or sampling the image). The eigenvectors\n"
+"are saved as an rsgislib matrix file which can be used with rsgislib.imagecalc.pca.\n"
+"\n"
+":param input_img: is a string containing the name of the input image file\n"
+":param out_matrix_file: is a string containing the name of the output matrix file (the\n"
+"                        .mtxt extension is added if the file does not have it).\n"
+":param no_data_val: is a float specifying the no data value, pixels where any band has\n"
+"                    this value are ignored (Default: None; all pixels are used).\n"
+":param n_threads: is the number of threads used to calculate the covariance (Default: 1; 0 uses all the available cores).\n"
+":return: list of the proportion of the variance explained by each component.\n"
+"\n"
+},
+
 {"calculate_img_band_rmse", (PyCFunction)ImageCalc_CalculateRMSE, METH_VARARGS | METH_KEYWORDS,
 "rsgislib.imagecalc.calculate_img_band_rmse(in_a_img, img_a_band, in_b_img, img_b_band)\n"
 "Calculates the root mean squared error between two images\n"
@@ -2071,8 +3068,9 @@ static PyMethodDef ImageCalcMethods[] = {
 },
     
 {"get_histogram", (PyCFunction)ImageCalc_GetHistogram, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imagecalc.get_histogram(input_img, img_band, bin_width, calc_min_max, min_val, max_val)\n"
-"Generates and returns a histogram for the image.\n"
+"rsgislib.imagecalc.get_histogram(input_img, img_band, bin_width, calc_min_max, min_val, max_val, n_threads=1)\n"
+"Generates and returns a histogram for the image. For 8 and 16 bit integer images\n"
+"the image is only read once, including when the min and max are calculated.\n"
 "\n"
 ":param input_img: is a string containing the name of the input image file\n"
 ":param img_band: is an unsigned int specifying the image band starting from 1.\n"
@@ -2080,18 +3078,25 @@ static PyMethodDef ImageCalcMethods[] = {
 ":param calc_min_max: is a boolean specifying whether inMin and inMax should be calculated\n"
 ":param min_val: is a float for the minimum image value to be included in the histogram\n"
 ":param max_val: is a float or the maximum image value to be included in the histogram\n"
+":param n_threads: is the number of threads used to calculate the histogram (Default: 1; 0 uses all the available cores).\n"
 "\n"
 ":return: list of ints"
 "\n"
 },
 
 {"calc_band_percentile", (PyCFunction)ImageCalc_BandPercentile, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imagecalc.calc_band_percentile(input_img, percentile, no_data_val)\n"
-"Calculates image band percentiles for the input image and results a list of values\n"
+"rsgislib.imagecalc.calc_band_percentile(input_img, percentile, no_data_val, approx=False, n_threads=1)\n"
+"Calculates image band percentiles for the input image and results a list of values.\n"
+"The percentiles of 8 and 16 bit integer bands are calculated exactly from a histogram\n"
+"of the bands, which are all read in a single pass.\n"
 "\n"
 ":param input_img: is a string containing the name of the input image file\n"
 ":param percentile: is a float between 0 -- 1 specifying the percentile to be calculated.\n"
 ":param no_data_val: is a float specifying the value used to represent no data (used None when no value is to be specified).\n"
+":param approx: is a boolean specifying whether the percentiles of the other (e.g., float) bands are\n"
+"               approximated using a streaming quantile sketch (within ~1% of the rank) rather than\n"
+"               reading and sorting all the values of the band (Default: False).\n"
+":param n_threads: is the number of threads used to calculate the percentiles (Default: 1; 0 uses all the available cores).\n"
 "\n"
 ":return: list of floats\n"
 "\n"
@@ -2259,6 +3264,109 @@ static PyMethodDef ImageCalcMethods[] = {
 ":param use_no_data: is a boolean specifying whether the no data value should be used (Optional, default False)\n"
 "\n"},
 
+{"calc_spectral_indices", (PyCFunction)ImageCalc_CalcSpectralIndices, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imagecalc.calc_spectral_indices(input_img, output_img, indices, gdalformat='KEA', no_data_val=-999, n_threads=1)\n"
+"Calculates a set of spectral indices in a single pass over the input image, outputting an image\n"
+"with a band for each index (named using the index name). Where the denominator of an index is 0\n"
+"the output is the no data value. The index types (rsgislib.SPECIDX_*) are:\n"
+"\n"
+"* SPECIDX_NORMDIFF: (b1 - b2) / (b1 + b2), bands=[b1, b2] (e.g., NDVI with [nir, red])\n"
+"* SPECIDX_RATIO: b1 / b2, bands=[b1, b2]\n"
+"* SPECIDX_EVI: bands=[blue, red, nir], params=[g, c1, c2, l, scale_factor] (Default: [2.5, 6, 7.5, 1, 1000])\n"
+"* SPECIDX_EVI2: bands=[red, nir], params=[g, c, l, scale_factor] (Default: [2.5, 2.4, 1, 1000])\n"
+"* SPECIDX_EXP: a muparser expression (exp) where var_names[i] is image band bands[i]\n"
+"\n"
+":param input_img: the input image.\n"
+":param output_img: the output image.\n"
+":param indices: a list of rsgislib.imagecalc.SpecIndexDefn objects defining the indices,\n"
+"                where the bands start at 1.\n"
+":param gdalformat: the output image format (Default: KEA).\n"
+":param no_data_val: the output no data value (Default: -999).\n"
+":param n_threads: the number of threads used to calculate the indices (Default: 1).\n"
+"\n"
+".. code:: python\n"
+"\n"
+"    import rsgislib\n"
+"    import rsgislib.imagecalc\n"
+"\n"
+"    indices = list()\n"
+"    indices.append(rsgislib.imagecalc.SpecIndexDefn('NDVI', rsgislib.SPECIDX_NORMDIFF, [8, 4]))\n"
+"    indices.append(rsgislib.imagecalc.SpecIndexDefn('EVI', rsgislib.SPECIDX_EVI, [2, 4, 8]))\n"
+"    indices.append(rsgislib.imagecalc.SpecIndexDefn('VisBright', rsgislib.SPECIDX_EXP, [2, 3, 4], exp='(blue+green+red)/3', var_names=['blue', 'green', 'red']))\n"
+"    rsgislib.imagecalc.calc_spectral_indices('sen2_img.kea', 'sen2_indices.kea', indices)\n"
+"\n"},
+
+{"calc_temporal_outlier_chng", (PyCFunction)ImageCalc_CalcTemporalOutlierChng, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imagecalc.calc_temporal_outlier_chng(input_imgs, output_img, gdalformat='KEA', img_band=1, threshold=3.5, min_obs=3, no_data_val=0, use_no_data=False, out_scores=False, n_threads=1)\n"
+"Detects per-pixel outliers (i.e., changes) within a time series. For each pixel the median and the\n"
+"median absolute deviation (MAD) of the valid values across the time steps are calculated and each\n"
+"time step is given the robust z-score abs(x - median) / (1.4826 * MAD), which is flagged as a\n"
+"change if it is greater than the threshold. Where the MAD is 0 any value not equal to the median\n"
+"is a change.\n"
+"\n"
+":param input_imgs: a list of input images. If a single image is provided then its bands are the\n"
+"                   time steps, otherwise img_band of each image (in the order of the list) is used\n"
+"                   and the images must have the same number of bands.\n"
+":param output_img: the output image, which has a band for each time step with values of 1 (no change),\n"
+"                   2 (change) and 0 (no data) or, if out_scores is True, the robust z-scores (-1 for no data).\n"
+":param gdalformat: the output image format (Default: KEA).\n"
+":param img_band: the band used from each image when multiple images are provided (Default: 1).\n"
+":param threshold: the robust z-score above which a value is a change (Default: 3.5).\n"
+":param min_obs: the minimum number of valid time steps for a pixel to be tested (Default: 3).\n"
+":param no_data_val: the no data value of the input images (Default: 0).\n"
+":param use_no_data: boolean specifying whether the no data value should be used (Default: False).\n"
+":param out_scores: if True, output the robust z-scores (as Float32) rather than the change flags (Default: False).\n"
+":param n_threads: the number of threads used to process the image blocks (Default: 1).\n"
+"\n"},
+
+{"calc_temporal_robust_fit_outliers", (PyCFunction)ImageCalc_CalcTemporalRobustFitOutliers, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imagecalc.calc_temporal_robust_fit_outliers(input_imgs, dates, output_img, gdalformat='KEA', img_bands=None, threshold=3, min_obs=12, max_iters=50, no_data_val=0, use_no_data=False, ref_img=None, n_threads=1)\n"
+"Fits a robust (Tukey biweight) season-trend model, with annual and inter-annual harmonics\n"
+"(Zhu and Woodcock, 2014), through the time series of each pixel and band and identifies the\n"
+"observations which are outliers from the model. The fits are batched over blocks of pixels\n"
+"and the blocks processed in parallel. Only the images where all the img_bands have data are\n"
+"used for a pixel.\n"
+"\n"
+":param input_imgs: a list of input images, which must have the same number of bands.\n"
+":param dates: a list with the date of each input image as a number of days (e.g., date.toordinal()).\n"
+":param output_img: the output image, which has a band for each input image and img_band (ordered by\n"
+"                   image and then band) with values of 1 (residual > threshold x RMSE), -1\n"
+"                   (residual < -threshold x RMSE) and 0 (inlier or no data).\n"
+":param gdalformat: the output image format (Default: KEA).\n"
+":param img_bands: a list of the bands (starting at 1) to be fitted. If None all the bands are used.\n"
+":param threshold: the multiple of the model RMSE beyond which a residual is an outlier (Default: 3).\n"
+":param min_obs: the minimum number of valid observations for a pixel to be fitted (Default: 12).\n"
+":param max_iters: the maximum number of robust fitting iterations (Default: 50).\n"
+":param no_data_val: the no data value of the input images (Default: 0).\n"
+":param use_no_data: boolean specifying whether the no data value should be used (Default: False).\n"
+":param ref_img: an optional image which the output is limited to the extent of (Default: None).\n"
+":param n_threads: the number of threads used to process the image blocks (Default: 1).\n"
+"\n"},
+
+{"calc_temporal_tmask", (PyCFunction)ImageCalc_CalcTemporalTMask, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imagecalc.calc_temporal_tmask(input_imgs, dates, output_img, gdalformat='KEA', green_band=2, nir_band=4, swir_band=5, threshold=40, min_obs=12, max_iters=5, no_data_val=0, use_no_data=False, n_threads=1)\n"
+"Applies the Tmask multi-temporal cloud, cloud shadow and snow screening (Zhu and Woodcock, 2014).\n"
+"For each pixel a robust (Tukey biweight) season-trend model is fitted to the green, NIR and SWIR\n"
+"time series and observations with a green residual of at least threshold (i.e., cloud or snow) or\n"
+"NIR and SWIR residuals of at most -threshold (i.e., shadow) are screened. The fits are batched over\n"
+"blocks of pixels and the blocks processed in parallel.\n"
+"\n"
+":param input_imgs: a list of input images, which must have the same number of bands.\n"
+":param dates: a list with the date of each input image as a number of days (e.g., date.toordinal()).\n"
+":param output_img: the output image, which has a band for each input image with a value of 1 for\n"
+"                   screened (cloud, cloud shadow or snow) and 0 for clear or no data.\n"
+":param gdalformat: the output image format (Default: KEA).\n"
+":param green_band: the green image band (Default: 2).\n"
+":param nir_band: the NIR image band (Default: 4).\n"
+":param swir_band: the SWIR image band (Default: 5).\n"
+":param threshold: the screening threshold on the model residuals (Default: 40).\n"
+":param min_obs: the minimum number of valid observations for a pixel to be screened (Default: 12).\n"
+":param max_iters: the maximum number of robust fitting iterations (Default: 5).\n"
+":param no_data_val: the no data value of the input images (Default: 0).\n"
+":param use_no_data: boolean specifying whether the no data value should be used (Default: False).\n"
+":param n_threads: the number of threads used to process the image blocks (Default: 1).\n"
+"\n"},
+
 {"calc_img_difference", (PyCFunction)ImageCalc_CalcImageDifference, METH_VARARGS | METH_KEYWORDS,
 "rsgislib.imagecalc.calc_img_difference(in_a_img, in_b_img, output_img, gdalformat, datatype)\n"
 "Calculate the difference between two images (Image1 - Image2). Note the two images must have the same number of image bands.\n"
@@ -2284,6 +3392,29 @@ static PyMethodDef ImageCalcMethods[] = {
 "   \n"
 "\n"},
     
+{"calc_img_comparison_stats", (PyCFunction)ImageCalc_CalcImageComparisonStats, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imagecalc.calc_img_comparison_stats(in_a_img, in_b_img, output_img='', gdalformat='KEA', datatype=rsgislib.TYPE_32FLOAT)\n"
+"Compare two images band by band (Image1 - Image2) in a single pass, calculating the RMSE, bias, mean\n"
+"absolute difference and correlation coefficient of each band and optionally outputting the difference\n"
+"image. Note the two images must have the same number of image bands.\n"
+"\n"
+":param in_a_img: is a string containing the name of the first input file\n"
+":param in_b_img: is a string containing the name of the second input file\n"
+":param output_img: is a string containing the name of the output difference image (Optional; if '' no image is output).\n"
+":param gdalformat: is a string containing the GDAL format for the output file - eg 'KEA'\n"
+":param datatype: is an containing one of the values from rsgislib.TYPE_*\n"
+":return: list with a dict for each band with the keys 'n_pxls', 'rmse', 'bias' (mean of Image1 - Image2), 'mean_abs_diff' and 'correlation'.\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   from rsgislib import imagecalc\n"
+"   \n"
+"   band_stats = imagecalc.calc_img_comparison_stats('img_orig.kea', 'img_new.kea')\n"
+"   for band_stat in band_stats:\n"
+"       print(band_stat['rmse'], band_stat['bias'], band_stat['correlation'])\n"
+"   \n"
+"\n"},
+    
 {"get_img_band_min_max", (PyCFunction)ImageCalc_GetImageBandMinMax, METH_VARARGS | METH_KEYWORDS,
 "rsgislib.imagecalc.get_img_band_min_max(input_img, img_band, use_no_data, no_data_val)\n"
 "Calculate and reutrn the maximum and minimum values of the input image.\n"
@@ -2308,7 +3439,7 @@ static PyMethodDef ImageCalcMethods[] = {
 "\n"},
     
 {"calc_img_rescale", (PyCFunction)ImageCalc_CalcImageRescale, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imagecalc.calc_img_rescale(input_imgs, output_img, gdalformat, datatype, c_no_data_val, c_offset, c_gain, n_no_data_val, n_offset, n_gain)\n"
+"rsgislib.imagecalc.calc_img_rescale(input_imgs, output_img, gdalformat, datatype, c_no_data_val, c_offset, c_gain, n_no_data_val, n_offset, n_gain, n_threads=1)\n"
 "A function which can take either a list of images or a single image to produce a single stacked output image.\n"
 "The image values are rescaled applying the input (current; c) gain and offset and then applying the new (n) gain"
 " and offset to the output image. Note, the nodata image value is also defined and can be changed. \n"
@@ -2324,6 +3455,7 @@ static PyMethodDef ImageCalcMethods[] = {
 ":param n_no_data_val: is a float for the new no-data value for the imagery (note, all input images have the same no-data value).\n"
 ":param n_offset: is a float for the new offset value.\n"
 ":param n_gain: is a float for the new gain value.\n"
+":param n_threads: is the number of threads used to process the image (Default: 1; 0 uses all the available cores).\n"
 "\n"
 "\n"},
     
@@ -2435,6 +3567,38 @@ static PyMethodDef ImageCalcMethods[] = {
 ":return: float with mean value.\n"
 "\n"},
 
+{"calc_cost_distance", (PyCFunction)ImageCalc_CalcCostDistance, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imagecalc.calc_cost_distance(cost_img, out_dist_img, out_dir_img, gdalformat='KEA', src_img=None, src_coords=None, img_band=1, no_data_val=None, tile_size=0)\n"
+"Calculates the accumulated cost distance from a set of sources across a cost surface (8 connected, where\n"
+"the cost between neighbouring pixels is the mean of their costs multiplied by the distance between them in\n"
+"map units). A direction image is also output, giving the neighbour (1-8) towards the nearest source, from\n"
+"which least cost paths can be extracted using get_least_cost_path. Pixels with a negative cost or the no\n"
+"data value cannot be crossed.\n"
+"\n"
+":param cost_img: the input cost surface image.\n"
+":param out_dist_img: the output (Float64) cost distance image; pixels which cannot be reached are -1.\n"
+":param out_dir_img: the output (Byte) direction image; sources are 0 and pixels which cannot be reached are 255.\n"
+":param gdalformat: the output image format (Default: KEA).\n"
+":param src_img: an optional image where pixels with a non-zero value are sources.\n"
+":param src_coords: an optional list of (x, y) coordinates of sources.\n"
+":param img_band: the band of the cost image to use (Default: 1).\n"
+":param no_data_val: the no data value of the cost image (Default: None).\n"
+":param tile_size: if not 0, the images are processed as tiles of tile_size x tile_size pixels so\n"
+"                  that only a single tile is held within memory at a time (Default: 0).\n"
+"\n"},
+
+{"get_least_cost_path", (PyCFunction)ImageCalc_GetLeastCostPath, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imagecalc.get_least_cost_path(dir_img, coord, output_img='', gdalformat='KEA')\n"
+"Extracts the least cost path from the nearest source to a coordinate using the direction image\n"
+"calculated by calc_cost_distance.\n"
+"\n"
+":param dir_img: the direction image output by calc_cost_distance.\n"
+":param coord: the (x, y) coordinate of the end of the path.\n"
+":param output_img: if not '', an output image where the path pixels are 1 (Default: '').\n"
+":param gdalformat: the output image format (Default: KEA).\n"
+":return: list of the (x, y) coordinates of the pixel centres along the path, starting at the source.\n"
+"\n"},
+
 {nullptr}        /* Sentinel */
 };
 
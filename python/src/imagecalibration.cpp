@@ -171,6 +171,7 @@ static PyObject *ImageCalibration_landsat2Radiance(PyObject *self, PyObject *arg
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeConvertLandsat2Radiance(pszOutputFile, pszGDALFormat, landsatRadGainOffs);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -281,6 +282,7 @@ static PyObject *ImageCalibration_landsat2RadianceMultiAdd(PyObject *self, PyObj
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeConvertLandsat2RadianceMultiAdd(pszOutputFile, pszGDALFormat, landsatRadGainOffs);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -340,7 +342,10 @@ static PyObject *ImageCalibration_Radiance2TOARefl(PyObject *self, PyObject *arg
     try
     {
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
-        rsgis::cmds::executeConvertRadiance2TOARefl(pszInputFile, pszOutputFile, pszGDALFormat, type, scaleFactor, 0, false, year, month, day, (solarZenith*(M_PI/180)), solarIrradiance, numSolarIrrVals);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeConvertRadiance2TOARefl(pszInputFile, pszOutputFile, pszGDALFormat, type, scaleFactor, 0, false, year, month, day, (solarZenith*(M_PI/180)), solarIrradiance, numSolarIrrVals);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -431,7 +436,10 @@ static PyObject *ImageCalibration_TOARefl2Radiance(PyObject *self, PyObject *arg
     try
     {
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
-        rsgis::cmds::executeConvertTOARefl2Radiance(inputImgFiles, pszOutputFile, pszGDALFormat, type, scaleFactor, solarDistance, (solarZenith*(M_PI/180)), solarIrradiance, numSolarIrrVals);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeConvertTOARefl2Radiance(inputImgFiles, pszOutputFile, pszGDALFormat, type, scaleFactor, solarDistance, (solarZenith*(M_PI/180)), solarIrradiance, numSolarIrrVals);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -533,7 +541,10 @@ static PyObject *ImageCalibration_Apply6SCoefficentsSingleParam(PyObject *self,
     try
     {
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
-        rsgis::cmds::executeRad2SREFSingle6sParams(pszInputFile, pszOutputFile, pszGDALFormat, type, scaleFactor, imageBands, aX, bX, cX, numValues, noDataVal, useNoDataVal);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeRad2SREFSingle6sParams(pszInputFile, pszOutputFile, pszGDALFormat, type, scaleFactor, imageBands, aX, bX, cX, numValues, noDataVal, useNoDataVal);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -671,7 +682,10 @@ static PyObject *ImageCalibration_Apply6SCoefficentsElevLUTParam(PyObject *self,
     try
     {
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
-        rsgis::cmds::executeRad2SREFElevLUT6sParams(std::string(pszInputRadFile), std::string(pszInputDEMFile), std::string(pszOutputFile), std::string(pszGDALFormat), type, scaleFactor, elevLUT, noDataVal, useNoDataVal);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeRad2SREFElevLUT6sParams(std::string(pszInputRadFile), std::string(pszInputDEMFile), std::string(pszOutputFile), std::string(pszGDALFormat), type, scaleFactor, elevLUT, noDataVal, useNoDataVal);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -857,7 +871,10 @@ static PyObject *ImageCalibration_Apply6SCoefficentsElevAOTLUTParam(PyObject *se
     try
     {
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
-        rsgis::cmds::executeRad2SREFElevAOTLUT6sParams(std::string(pszInputRadFile), std::string(pszInputDEMFile), std::string(pszInputAOTFile), std::string(pszOutputFile), std::string(pszGDALFormat), type, scaleFactor, elevAOTLUT, noDataVal, useNoDataVal);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeRad2SREFElevAOTLUT6sParams(std::string(pszInputRadFile), std::string(pszInputDEMFile), std::string(pszInputAOTFile), std::string(pszOutputFile), std::string(pszGDALFormat), type, scaleFactor, elevAOTLUT, noDataVal, useNoDataVal);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -899,7 +916,10 @@ static PyObject *ImageCalibration_ApplySubtractOffsets(PyObject *self, PyObject
     try
     {
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
-        rsgis::cmds::executeApplySubtractOffsets(std::string(pszInputFile), std::string(pszOutputFile), std::string(pszInputOffsetsFile), (bool)nonNegativeInt, std::string(pszGDALFormat), type, noDataVal, (bool)useNoDataValInt, darkObjReflVal);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeApplySubtractOffsets(std::string(pszInputFile), std::string(pszOutputFile), std::string(pszInputOffsetsFile), (bool)nonNegativeInt, std::string(pszGDALFormat), type, noDataVal, (bool)useNoDataValInt, darkObjReflVal);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -960,7 +980,10 @@ static PyObject *ImageCalibration_ApplySubtractSingleOffsets(PyObject *self, PyO
     try
     {
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
-        rsgis::cmds::executeApplySubtractSingleOffsets(std::string(pszInputFile), std::string(pszOutputFile), imageOffsVals, (bool)nonNegativeInt, std::string(pszGDALFormat), type, noDataVal, (bool)useNoDataValInt, darkObjReflVal);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeApplySubtractSingleOffsets(std::string(pszInputFile), std::string(pszOutputFile), imageOffsVals, (bool)nonNegativeInt, std::string(pszGDALFormat), type, noDataVal, (bool)useNoDataValInt, darkObjReflVal);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1054,6 +1077,7 @@ static PyObject *ImageCalibration_SaturatedPixelsMask(PyObject *self, PyObject *
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeGenerateSaturationMask(pszOutputFile, pszGDALFormat, satBandPxlInfo);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -1153,7 +1177,108 @@ static PyObject *ImageCalibration_landsatThermalRad2Brightness(PyObject *self, P
     try
     {
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
-        rsgis::cmds::executeLandsatThermalRad2ThermalBrightness(std::string(pszInputFile), std::string(pszOutputFile), std::string(pszGDALFormat), type, scaleFactor, thermBandPxlInfo);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeLandsatThermalRad2ThermalBrightness(std::string(pszInputFile), std::string(pszOutputFile), std::string(pszGDALFormat), type, scaleFactor, thermBandPxlInfo);
+        }
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageCalibration_landsatThermalDN2Brightness(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"),
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("datatype"),
+                             RSGIS_PY_C_TEXT("scale_factor"), RSGIS_PY_C_TEXT("band_defs"), nullptr};
+    const char *pszInputFile, *pszOutputFile, *pszGDALFormat;
+    int nDataType;
+    float scaleFactor;
+    PyObject *pBandDefnObj;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssifO:landsat_thermal_dn_to_brightness", kwlist, &pszInputFile, &pszOutputFile, &pszGDALFormat, &nDataType, &scaleFactor, &pBandDefnObj))
+    {
+        return nullptr;
+    }
+    
+    if( !PySequence_Check(pBandDefnObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "Last argument must be a sequence");
+        return nullptr;
+    }
+    
+    Py_ssize_t nBandDefns = PySequence_Size(pBandDefnObj);
+    std::vector<rsgis::cmds::CmdsLandsatThermalDNCoeffs> thermBandPxlInfo;
+    thermBandPxlInfo.reserve(nBandDefns);
+    
+    for( Py_ssize_t n = 0; n < nBandDefns; n++ )
+    {
+        PyObject *o = PySequence_GetItem(pBandDefnObj, n);
+        
+        PyObject *pBandName = PyObject_GetAttrString(o, "band_name");
+        if( ( pBandName == nullptr ) || ( pBandName == Py_None ) || !RSGISPY_CHECK_STRING(pBandName) )
+        {
+            PyErr_SetString(GETSTATE(self)->error, "Could not find string attribute \'band_name\'" );
+            Py_XDECREF(pBandName);
+            Py_DECREF(o);
+            return nullptr;
+        }
+        
+        PyObject *pBandIndex = PyObject_GetAttrString(o, "img_band");
+        if( ( pBandIndex == nullptr ) || ( pBandIndex == Py_None ) || !RSGISPY_CHECK_INT(pBandIndex) )
+        {
+            PyErr_SetString(GETSTATE(self)->error, "Could not find integer attribute \'img_band\'" );
+            Py_DECREF(pBandName);
+            Py_XDECREF(pBandIndex);
+            Py_DECREF(o);
+            return nullptr;
+        }
+        
+        const char *floatAttNames[] = {"multi_val", "add_val", "k1", "k2"};
+        float floatAttVals[4];
+        for(unsigned int i = 0; i < 4; ++i)
+        {
+            PyObject *pVal = PyObject_GetAttrString(o, floatAttNames[i]);
+            if( ( pVal == nullptr ) || ( pVal == Py_None ) || !RSGISPY_CHECK_FLOAT(pVal) )
+            {
+                std::string message = std::string("Could not find float attribute \'") + std::string(floatAttNames[i]) + std::string("\'");
+                PyErr_SetString(GETSTATE(self)->error, message.c_str());
+                Py_DECREF(pBandName);
+                Py_DECREF(pBandIndex);
+                Py_XDECREF(pVal);
+                Py_DECREF(o);
+                return nullptr;
+            }
+            floatAttVals[i] = RSGISPY_FLOAT_EXTRACT(pVal);
+            Py_DECREF(pVal);
+        }
+        
+        rsgis::cmds::CmdsLandsatThermalDNCoeffs thermVals;
+        thermVals.bandName = RSGISPY_STRING_EXTRACT(pBandName);
+        thermVals.band = RSGISPY_INT_EXTRACT(pBandIndex);
+        thermVals.multiVal = floatAttVals[0];
+        thermVals.addVal = floatAttVals[1];
+        thermVals.k1 = floatAttVals[2];
+        thermVals.k2 = floatAttVals[3];
+        
+        thermBandPxlInfo.push_back(thermVals);
+        
+        Py_DECREF(pBandName);
+        Py_DECREF(pBandIndex);
+        Py_DECREF(o);
+    }
+    
+    try
+    {
+        rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeLandsatThermalDN2ThermalBrightness(std::string(pszInputFile), std::string(pszOutputFile), std::string(pszGDALFormat), type, scaleFactor, thermBandPxlInfo);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1249,6 +1374,7 @@ static PyObject *ImageCalibration_worldview2ToRadiance(PyObject *self, PyObject
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeConvertWorldView2ToRadiance(std::string(pszInputFile), std::string(pszOutputFile), std::string(pszGDALFormat), wv2RadGainOffs);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -1345,6 +1471,7 @@ static PyObject *ImageCalibration_spot5ToRadiance(PyObject *self, PyObject *args
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeConvertSPOT5ToRadiance(std::string(pszInputFile), std::string(pszOutputFile), std::string(pszGDALFormat), spot5RadGainOffs);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -1363,19 +1490,23 @@ static PyObject *ImageCalibration_calcNadirImgViewAngle(PyObject *self, PyObject
                              RSGIS_PY_C_TEXT("min_xx_col"), RSGIS_PY_C_TEXT("min_xy_col"),
                              RSGIS_PY_C_TEXT("max_xx_col"), RSGIS_PY_C_TEXT("max_xy_col"),
                              RSGIS_PY_C_TEXT("min_yx_col"), RSGIS_PY_C_TEXT("min_yy_col"),
-                             RSGIS_PY_C_TEXT("max_yx_col"), RSGIS_PY_C_TEXT("max_yy_col"), nullptr};
+                             RSGIS_PY_C_TEXT("max_yx_col"), RSGIS_PY_C_TEXT("max_yy_col"),
+                             RSGIS_PY_C_TEXT("grid_spacing"), RSGIS_PY_C_TEXT("max_grid_error"), nullptr};
     const char *pszImgFootprint, *pszOutViewAngleImg, *pszGDALFormat;
     float sateAltitude = 0.0;
     const char *pszMinXXCol, *pszMinXYCol, *pszMaxXXCol, *pszMaxXYCol, *pszMinYXCol, *pszMinYYCol, *pszMaxYXCol, *pszMaxYYCol;
+    unsigned int gridSpacing = 64;
+    double maxGridError = 0.001;
     
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssfssssssss:calc_nadir_img_view_angle", kwlist, &pszImgFootprint, &pszOutViewAngleImg, &pszGDALFormat, &sateAltitude, &pszMinXXCol, &pszMinXYCol, &pszMaxXXCol, &pszMaxXYCol, &pszMinYXCol, &pszMinYYCol, &pszMaxYXCol, &pszMaxYYCol))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssfssssssss|Id:calc_nadir_img_view_angle", kwlist, &pszImgFootprint, &pszOutViewAngleImg, &pszGDALFormat, &sateAltitude, &pszMinXXCol, &pszMinXYCol, &pszMaxXXCol, &pszMaxXYCol, &pszMinYXCol, &pszMinYYCol, &pszMaxYXCol, &pszMaxYYCol, &gridSpacing, &maxGridError))
     {
         return nullptr;
     }
     
     try
     {
-        rsgis::cmds::executeCalcNadirImageViewAngle(std::string(pszImgFootprint), std::string(pszOutViewAngleImg), std::string(pszGDALFormat), sateAltitude, std::string(pszMinXXCol), std::string(pszMinXYCol), std::string(pszMaxXXCol), std::string(pszMaxXYCol), std::string(pszMinYXCol), std::string(pszMinYYCol), std::string(pszMaxYXCol), std::string(pszMaxYYCol));
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeCalcNadirImageViewAngle(std::string(pszImgFootprint), std::string(pszOutViewAngleImg), std::string(pszGDALFormat), sateAltitude, std::string(pszMinXXCol), std::string(pszMinXYCol), std::string(pszMaxXXCol), std::string(pszMaxXYCol), std::string(pszMinYXCol), std::string(pszMinYYCol), std::string(pszMaxYXCol), std::string(pszMaxYYCol), gridSpacing, maxGridError);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1517,6 +1648,7 @@ static PyObject *ImageCalibration_CalcIrradianceElevLUT(PyObject *self, PyObject
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCalcIrradianceElevLUT(std::string(pszInputDataMaskImg), std::string(pszInputDEMFile), std::string(pszInputIncidenceAngleImg), std::string(pszInputSlopeImg), std::string(pszShadowMaskImg), std::string(pszSrefInputImage), std::string(pszOutputFile), std::string(pszGDALFormat), solarZenith, reflScaleFactor, elevLUT);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -1563,6 +1695,7 @@ static PyObject *ImageCalibration_CalcStandardisedReflectanceSD2010(PyObject *se
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCalcStandardisedReflectanceSD2010(std::string(pszInputDataMaskImg), std::string(pszSrefInputImage), std::string(pszInputSolarIrradiance), std::string(pszInputIncidenceAngleImg), std::string(pszInputExitanceAngleImg), std::string(pszOutputFile), std::string(pszGDALFormat), brdfBeta, outIncidenceAngle, outExitanceAngle, reflScaleFactor);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -1630,18 +1763,20 @@ static PyObject *ImageCalibration_calcCloudShadowMask(PyObject *self, PyObject *
                              RSGIS_PY_C_TEXT("scale_factor"), RSGIS_PY_C_TEXT("tmp_img_base"),
                              RSGIS_PY_C_TEXT("tmp_img_ext"), RSGIS_PY_C_TEXT("solar_azimuth"),
                              RSGIS_PY_C_TEXT("solar_zenith"), RSGIS_PY_C_TEXT("sensor_azimuth"),
-                             RSGIS_PY_C_TEXT("sensor_zenith"),  RSGIS_PY_C_TEXT("rm_tmp_imgs"), nullptr};
+                             RSGIS_PY_C_TEXT("sensor_zenith"),  RSGIS_PY_C_TEXT("rm_tmp_imgs"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
 
     const char *pszInputReflFile, *pszInputCloudMaskFile, *pszValidAreaImg, *pszOutputFile, *pszTmpImgsBase, *pszTmpImgsFileExt, *pszGDALFormat;
     float sunAz, sunZen, senAz, senZen = 0.0;
     float scaleFactor;
     int darkImgBand;
     int rmTmpImages = true;
+    unsigned int nThreads = 1;
     
     
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssssisfssffff|i:calc_cloud_shadow_mask", kwlist, &pszInputCloudMaskFile, &pszInputReflFile,
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssssisfssffff|iI:calc_cloud_shadow_mask", kwlist, &pszInputCloudMaskFile, &pszInputReflFile,
                                      &pszValidAreaImg, &pszOutputFile, &darkImgBand, &pszGDALFormat, &scaleFactor, &pszTmpImgsBase,
-                                     &pszTmpImgsFileExt, &sunAz, &sunZen, &senAz, &senZen, &rmTmpImages))
+                                     &pszTmpImgsFileExt, &sunAz, &sunZen, &senAz, &senZen, &rmTmpImages, &nThreads))
     {
         return nullptr;
     }
@@ -1649,7 +1784,10 @@ static PyObject *ImageCalibration_calcCloudShadowMask(PyObject *self, PyObject *
     try
     {
         bool rmTmpImgs = (bool)rmTmpImages;
-        rsgis::cmds::executePerformCloudShadowMasking(std::string(pszInputCloudMaskFile), std::string(pszInputReflFile), std::string(pszValidAreaImg), darkImgBand, std::string(pszOutputFile), std::string(pszGDALFormat), scaleFactor, std::string(pszTmpImgsBase), std::string(pszTmpImgsFileExt), rmTmpImgs, sunAz, sunZen, senAz, senZen);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executePerformCloudShadowMasking(std::string(pszInputCloudMaskFile), std::string(pszInputReflFile), std::string(pszValidAreaImg), darkImgBand, std::string(pszOutputFile), std::string(pszGDALFormat), scaleFactor, std::string(pszTmpImgsBase), std::string(pszTmpImgsFileExt), rmTmpImgs, sunAz, sunZen, senAz, senZen, nThreads);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1844,6 +1982,26 @@ static PyMethodDef ImageCalibrationMethods[] = {
 "        *  k2 - k2 coefficient from Landsat header.\n"
 "\n"},
     
+{"landsat_thermal_dn_to_brightness", (PyCFunction)ImageCalibration_landsatThermalDN2Brightness, METH_VARARGS | METH_KEYWORDS,
+"imagecalibration.landsat_thermal_dn_to_brightness(input_img, output_img, gdalformat, datatype, scale_factor, band_defs)\n"
+"Converts Landsat thermal DNs directly to degrees celsius for at sensor temperature, without writing\n"
+"an intermediate radiance image. For 8 and 16 bit inputs the temperature of every DN is pre-calculated\n"
+"into a look up table. DNs of 0 in all bands are no data and output as 0.\n"
+"\n"
+":param input_img: is a string containing the name of the input file path.\n"
+":param output_img: is a string containing the name of the output file path.\n"
+":param gdalformat: is a string containing the GDAL format for the output file - eg 'KEA'\n"
+":param datatype: is an containing one of the values from rsgislib.TYPE_*\n"
+":param scale_factor: is a float which can be used to scale the output pixel values (e.g., multiple by 1000), set as 1 for no scaling.\n"
+":param band_defs: is a sequence of objects that define the inputs\n"
+"        *  band_name - Name of image band in output file.\n"
+"        *  img_band - Index (starting from 1) of the band in the image file.\n"
+"        *  multi_val - RADIANCE_MULT_BAND value from the Landsat header.\n"
+"        *  add_val - RADIANCE_ADD_BAND value from the Landsat header.\n"
+"        *  k1 - k1 coefficient from Landsat header.\n"
+"        *  k2 - k2 coefficient from Landsat header.\n"
+"\n"},
+    
 {"worldview2_to_radiance", (PyCFunction)ImageCalibration_worldview2ToRadiance, METH_VARARGS | METH_KEYWORDS,
 "imagecalibration.worldview2_to_radiance(input_img, output_img, gdalformat, band_defs)\n"
 "Converts WorldView2 DN values to at sensor radiance.\n"
@@ -1873,7 +2031,7 @@ static PyMethodDef ImageCalibrationMethods[] = {
 "\n"},
 
 {"calc_nadir_img_view_angle", (PyCFunction)ImageCalibration_calcNadirImgViewAngle, METH_VARARGS | METH_KEYWORDS,
-"imagecalibration.calc_nadir_img_view_angle(input_img, output_img, gdalformat, altitude, min_xx_col, min_xy_col, max_xx_col, max_xy_col, min_yx_col, min_yy_col, max_yx_col, max_yy_col)\n"
+"imagecalibration.calc_nadir_img_view_angle(input_img, output_img, gdalformat, altitude, min_xx_col, min_xy_col, max_xx_col, max_xy_col, min_yx_col, min_yy_col, max_yx_col, max_yy_col, grid_spacing=64, max_grid_error=0.001)\n"
 "Calculate the sensor view angle for each pixel for a nadir sensor. Need to provide the satellite altitude in metres, for Landsat this is 705000.0. \n"
 "\n"
 ":param input_img: is a string containing the name/path of the input file for the image footprint. This file needs to be to have a RAT with only one clump with pixel value 1.\n"
@@ -1888,6 +2046,10 @@ static PyMethodDef ImageCalibrationMethods[] = {
 ":param min_yy_col: is a string for the minYY column in the RAT.\n"
 ":param max_yx_col: is a string for the maxYX column in the RAT.\n"
 ":param max_yy_col: is a string for the maxYY column in the RAT.\n"
+":param grid_spacing: is the spacing (in pixels) of the grid the view angles are calculated\n"
+"                     on and linearly interpolated from. 0 calculates the angle of every pixel.\n"
+":param max_grid_error: is the maximum estimated interpolation error (degrees); grid cells\n"
+"                       with a larger error are calculated for every pixel.\n"
 "\n"},
 
 {"calc_irradiance_img_elev_lut", (PyCFunction)ImageCalibration_CalcIrradianceElevLUT, METH_VARARGS | METH_KEYWORDS,
@@ -1952,7 +2114,7 @@ static PyMethodDef ImageCalibrationMethods[] = {
 
     
 {"calc_cloud_shadow_mask", (PyCFunction)ImageCalibration_calcCloudShadowMask, METH_VARARGS | METH_KEYWORDS,
-"imagecalibration.calc_cloud_shadow_mask(in_cld_msk_img, in_refl_img, in_vld_img, output_img, dark_band, gdalformat, scale_factor, tmp_img_base, tmp_img_ext, solar_azimuth, solar_zenith, sensor_azimuth, sensor_zenith, rm_tmp_imgs)\n"
+"imagecalibration.calc_cloud_shadow_mask(in_cld_msk_img, in_refl_img, in_vld_img, output_img, dark_band, gdalformat, scale_factor, tmp_img_base, tmp_img_ext, solar_azimuth, solar_zenith, sensor_azimuth, sensor_zenith, rm_tmp_imgs, n_threads)\n"
 "Calculate a cloud shadow mask from an inputted cloud mask.\n"
 "\n"
 ":param in_cld_msk_img: is a string containing the name of the input cloud mask\n"
@@ -1969,6 +2131,7 @@ static PyMethodDef ImageCalibrationMethods[] = {
 ":param sensor_azimuth: is the sensor azimuth of the input image\n"
 ":param sensor_zenith: is the sensor azimuth of the input image\n"
 ":param rm_tmp_imgs: is a bool specifying whether the tmp images should be deleted at the end of the processing (Optional; Default = True)\n"
+":param n_threads: is the number of threads used to calculate the potential shadows and fit the cloud heights (Default: 1; 0 uses all the available cores).\n"
 "\n"
 },
     
@@ -48,13 +48,16 @@ static PyObject *ImageFilter_Filter(PyObject *self, PyObject *args, PyObject *ke
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("out_img_base"),
                              RSGIS_PY_C_TEXT("image_filters"), RSGIS_PY_C_TEXT("gdalformat"),
-                             RSGIS_PY_C_TEXT("out_img_ext"), RSGIS_PY_C_TEXT("datatype"), nullptr};
+                             RSGIS_PY_C_TEXT("out_img_ext"), RSGIS_PY_C_TEXT("datatype"),
+                             RSGIS_PY_C_TEXT("fused"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *pszInputImage, *pszOutputImageBase;
     const char *pszImageFormat = "KEA";
     const char *pszImageExt = "kea";
     int dataType = 9; // Default to 32 bit float
+    int fused = 1;
+    unsigned int numThreads = 1;
     PyObject *pImageFilterCmds;
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssO|ssi:apply_filters", kwlist, &pszInputImage, &pszOutputImageBase, &pImageFilterCmds, &pszImageFormat, &pszImageExt, &dataType))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssO|ssiiI:apply_filters", kwlist, &pszInputImage, &pszOutputImageBase, &pImageFilterCmds, &pszImageFormat, &pszImageExt, &dataType, &fused, &numThreads))
     {
         return nullptr;
     }
@@ -74,7 +77,7 @@ static PyObject *ImageFilter_Filter(PyObject *self, PyObject *args, PyObject *ke
         rsgis::cmds::RSGISFilterParameters *cmdObj = new rsgis::cmds::RSGISFilterParameters();   // the c++ object we need to pass pointers of
 
         // declare and initialise pointers for all the attributes of the struct
-        PyObject *pFilterType, *pFileEnding, *pSize, *pOption, *pNLooks, *pStdDev, *pStdDevX , *pStdDevY, *pAngle = nullptr;
+        PyObject *pFilterType, *pFileEnding, *pSize, *pOption, *pNLooks, *pStdDev, *pStdDevX , *pStdDevY, *pAngle, *pPercentile, *pHistMin, *pHistMax, *pHistBinWidth = nullptr;
 
         std::vector<PyObject*> extractedAttributes;     // store a list of extracted pyobjects to dereference
         extractedAttributes.push_back(o);
@@ -182,6 +185,38 @@ static PyObject *ImageFilter_Filter(PyObject *self, PyObject *args, PyObject *ke
             cmdObj->angle = RSGISPY_FLOAT_EXTRACT(pAngle);
             std::cout << "angle = " << cmdObj->angle << " ";
         }
+
+        pPercentile = PyObject_GetAttrString(o, "percentile");
+        extractedAttributes.push_back(pPercentile);
+        if( !(pPercentile == nullptr) & (RSGISPY_CHECK_FLOAT(pPercentile) | RSGISPY_CHECK_INT(pPercentile)) )
+        {
+            cmdObj->percentile = RSGISPY_FLOAT_EXTRACT(pPercentile);
+            std::cout << "percentile = " << cmdObj->percentile << " ";
+        }
+
+        pHistMin = PyObject_GetAttrString(o, "hist_min");
+        extractedAttributes.push_back(pHistMin);
+        if( !(pHistMin == nullptr) & (RSGISPY_CHECK_FLOAT(pHistMin) | RSGISPY_CHECK_INT(pHistMin)) )
+        {
+            cmdObj->histMin = RSGISPY_FLOAT_EXTRACT(pHistMin);
+            std::cout << "histMin = " << cmdObj->histMin << " ";
+        }
+
+        pHistMax = PyObject_GetAttrString(o, "hist_max");
+        extractedAttributes.push_back(pHistMax);
+        if( !(pHistMax == nullptr) & (RSGISPY_CHECK_FLOAT(pHistMax) | RSGISPY_CHECK_INT(pHistMax)) )
+        {
+            cmdObj->histMax = RSGISPY_FLOAT_EXTRACT(pHistMax);
+            std::cout << "histMax = " << cmdObj->histMax << " ";
+        }
+
+        pHistBinWidth = PyObject_GetAttrString(o, "hist_bin_width");
+        extractedAttributes.push_back(pHistBinWidth);
+        if( !(pHistBinWidth == nullptr) & (RSGISPY_CHECK_FLOAT(pHistBinWidth) | RSGISPY_CHECK_INT(pHistBinWidth)) )
+        {
+            cmdObj->histBinWidth = RSGISPY_FLOAT_EXTRACT(pHistBinWidth);
+            std::cout << "histBinWidth = " << cmdObj->histBinWidth << " ";
+        }
         std::cout << std::endl;
 
         FreePythonObjects(extractedAttributes);
@@ -191,7 +226,10 @@ static PyObject *ImageFilter_Filter(PyObject *self, PyObject *args, PyObject *ke
     try
     {
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType) dataType;
-        rsgis::cmds::executeFilter(pszInputImage, filterParameters, pszOutputImageBase, pszImageFormat, pszImageExt, type);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeFilter(pszInputImage, filterParameters, pszOutputImageBase, pszImageFormat, pszImageExt, type, fused != 0, numThreads);
+        }
 
         // Delete filter parameters
         for(auto iterFilter = filterParameters->begin(); iterFilter != filterParameters->end(); ++iterFilter)
@@ -214,12 +252,15 @@ static PyObject *ImageFilter_LeungMalikFilterBank(PyObject *self, PyObject *args
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("out_img_base"),
                              RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("out_img_ext"),
-                             RSGIS_PY_C_TEXT("datatype"), nullptr};
+                             RSGIS_PY_C_TEXT("datatype"), RSGIS_PY_C_TEXT("fused"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *pszInputImage, *pszOutputImageBase;
     const char *pszImageFormat = "KEA";
     const char *pszImageExt = "kea";
     int dataType = 9; // Default to 32 bit float
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ss|ssi:leung_malik_filter_bank", kwlist, &pszInputImage, &pszOutputImageBase, &pszImageFormat, &pszImageExt, &dataType))
+    int fused = 1;
+    unsigned int numThreads = 1;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ss|ssiiI:leung_malik_filter_bank", kwlist, &pszInputImage, &pszOutputImageBase, &pszImageFormat, &pszImageExt, &dataType, &fused, &numThreads))
     {
         return nullptr;
     }
@@ -235,7 +276,10 @@ static PyObject *ImageFilter_LeungMalikFilterBank(PyObject *self, PyObject *args
         
         // Excecute
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType) dataType;
-        rsgis::cmds::executeFilter(pszInputImage, filterParameters, pszOutputImageBase, pszImageFormat, pszImageExt, type);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeFilter(pszInputImage, filterParameters, pszOutputImageBase, pszImageFormat, pszImageExt, type, fused != 0, numThreads);
+        }
 
         // Delete filter parameters
         for(auto iterFilter = filterParameters->begin(); iterFilter != filterParameters->end(); ++iterFilter)
@@ -254,10 +298,44 @@ static PyObject *ImageFilter_LeungMalikFilterBank(PyObject *self, PyObject *args
     Py_RETURN_NONE;
 }
 
+static PyObject *ImageFilter_CalcGradient(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"),
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("datatype"),
+                             RSGIS_PY_C_TEXT("grad_operator"), RSGIS_PY_C_TEXT("output_xy"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
+    const char *pszInputImage, *pszOutputImage;
+    const char *pszImageFormat = "KEA";
+    const char *pszGradOperator = "Sobel";
+    int dataType = 9; // Default to 32 bit float
+    int outputXY = 0;
+    unsigned int numThreads = 1;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ss|sisiI:calc_gradient", kwlist, &pszInputImage, &pszOutputImage, &pszImageFormat, &dataType, &pszGradOperator, &outputXY, &numThreads))
+    {
+        return nullptr;
+    }
+
+    try
+    {
+        rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType) dataType;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeGradientFilter(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszImageFormat), type, std::string(pszGradOperator), outputXY != 0, numThreads);
+        }
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
 // Our list of functions in this module
 static PyMethodDef ImageFilterMethods[] = {
 {"apply_filters", (PyCFunction)ImageFilter_Filter, METH_VARARGS | METH_KEYWORDS,
-"imagefilter.apply_filters(input_img, out_img_base, image_filters, gdalformat, out_img_ext, datatype)\n"
+"imagefilter.apply_filters(input_img, out_img_base, image_filters, gdalformat, out_img_ext, datatype, fused=True, n_threads=1)\n"
 "Filters images\n"
 "\n"
 ":param input_img: is a string containing the name of the input image\n"
@@ -266,6 +344,10 @@ static PyMethodDef ImageFilterMethods[] = {
 ":param gdalformat: is a string containing the GDAL format for the output file - eg 'KEA'\n"
 ":param out_img_ext: is a string with the output image file extention (e.g., kea)"
 ":param datatype: is an int containing one of the values from rsgislib.TYPE_*\n"
+":param fused: if True (default) the input image is read once for all the filters, with \n"
+"              a halo of half the largest filter window, rather than once per filter.\n"
+":param n_threads: is the number of threads the filters are split between when fused \n"
+"                  (0 uses all available cores).\n"
 "\n"
 ".. code:: python\n"
 "\n"
@@ -290,6 +372,9 @@ static PyMethodDef ImageFilterMethods[] = {
 "   filters.append(imagefilter.FilterParameters(filterType = 'Mean', fileEnding = 'mean', size=3) )\n"
 "   filters.append(imagefilter.FilterParameters(filterType = 'Median', fileEnding = 'median', size=3) )\n"
 "   filters.append(imagefilter.FilterParameters(filterType = 'Mode', fileEnding = 'mode', size=3) )\n"
+"   filters.append(imagefilter.FilterParameters(filterType = 'MedianHist', fileEnding = 'medianhist', size=31, hist_min=0, hist_max=65535, hist_bin_width=1) )\n"
+"   filters.append(imagefilter.FilterParameters(filterType = 'PercentileHist', fileEnding = 'pc90hist', size=31, percentile=90, hist_min=0, hist_max=65535, hist_bin_width=1) )\n"
+"   filters.append(imagefilter.FilterParameters(filterType = 'ModeHist', fileEnding = 'modehist', size=31, hist_min=0, hist_max=255, hist_bin_width=1) )\n"
 "   filters.append(imagefilter.FilterParameters(filterType = 'StdDev', fileEnding = 'stddev', size=3) )\n"
 "   filters.append(imagefilter.FilterParameters(filterType = 'Range', fileEnding = 'range', size=3) )\n"
 "   filters.append(imagefilter.FilterParameters(filterType = 'CoeffOfVar', fileEnding = 'coeffofvar', size=3) )\n"
@@ -310,8 +395,33 @@ static PyMethodDef ImageFilterMethods[] = {
 "   imagefilter.apply_filters(inputImage, outputImageBase, filters, gdalformat, outExt, datatype)\n"
 "\n"},
 
+{"calc_gradient", (PyCFunction)ImageFilter_CalcGradient, METH_VARARGS | METH_KEYWORDS,
+"imagefilter.calc_gradient(input_img, output_img, gdalformat='KEA', datatype=rsgislib.TYPE_32FLOAT, grad_operator='Sobel', output_xy=False, n_threads=1)\n"
+"Calculates the Sobel or Prewitt gradient magnitude and direction of each band of the input\n"
+"image in one pass (rather than applying the x, y filters separately). 8 and 16 bit images are\n"
+"processed as integers. The direction is the direction of increasing value in degrees clockwise\n"
+"from the top of the image (0 - 360; 0 where the magnitude is 0). The image is zero padded at the edges.\n"
+"\n"
+":param input_img: is a string containing the name of the input image\n"
+":param output_img: is a string containing the name of the output image, which has the bands\n"
+"                   b1_mag, b1_dir, b2_mag, ... (or b1_x, b1_y, b1_mag, b1_dir, ... if output_xy)\n"
+":param gdalformat: is a string containing the GDAL format for the output file - eg 'KEA'\n"
+":param datatype: is an int containing one of the values from rsgislib.TYPE_*\n"
+":param grad_operator: is a string specifying the operator, either 'Sobel' or 'Prewitt'\n"
+":param output_xy: if True the x and y gradients (the same as the 'x' and 'y' options of the\n"
+"                  Sobel and Prewitt filters) are also output.\n"
+":param n_threads: is the number of threads the rows of each strip are split between\n"
+"                  (0 uses all available cores).\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   import rsgislib\n"
+"   from rsgislib import imagefilter\n"
+"   imagefilter.calc_gradient('sen2_img.kea', 'sen2_img_sobel.kea', 'KEA', rsgislib.TYPE_32FLOAT, 'Sobel')\n"
+"\n"},
+
 {"leung_malik_filter_bank", (PyCFunction)ImageFilter_LeungMalikFilterBank, METH_VARARGS | METH_KEYWORDS,
-"imagefilter.(input_img, out_img_base, gdalformat, out_img_ext, datatype)\n"
+"imagefilter.(input_img, out_img_base, gdalformat, out_img_ext, datatype, fused=True, n_threads=1)\n"
 "Implements the Leung-Malik filter bank described in:\n"
 "Leung, T., Malik, J., 2001. Representing and recognizing the visual appearance of materials using three-dimensional textons.\n"
 "International Journal of Computer Vision 43 (1), 29-44.\n"
@@ -321,6 +431,10 @@ static PyMethodDef ImageFilterMethods[] = {
 ":param gdalformat: is a string containing the GDAL format for the output file - eg 'KEA'\n"
 ":param out_img_ext: is a string with the output image file extention (e.g., kea)"
 ":param datatype: is an int containing one of the values from rsgislib.TYPE_*\n"
+":param fused: if True (default) the input image is read once for all 48 filters, rather \n"
+"              than once per filter.\n"
+":param n_threads: is the number of threads the filters are split between when fused \n"
+"                  (0 uses all available cores).\n"
 "\n"
 ".. code:: python\n"
 "\n"
@@ -61,6 +61,7 @@ static PyObject *ImageMorphology_CreateCircularOp(PyObject *self, PyObject *args
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCreateCircularOperator(std::string(pszOutputFile), morphOpSize);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -93,6 +94,7 @@ static PyObject *ImageMorphology_ImageDilate(PyObject *self, PyObject *args, PyO
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageDilate(std::string(pszInputImage), std::string(pszOutputImage),
                                         std::string(pszMorphOperator), (bool)useOperatorFile,
                                         morphOpSize, std::string(pszImageFormat), (rsgis::RSGISLibDataType)datatype);
@@ -127,6 +129,7 @@ static PyObject *ImageMorphology_ImageErode(PyObject *self, PyObject *args, PyOb
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageErode(std::string(pszInputImage), std::string(pszOutputImage),
                                        std::string(pszMorphOperator), (bool)useOperatorFile,
                                        morphOpSize, std::string(pszImageFormat), (rsgis::RSGISLibDataType)datatype);
@@ -161,6 +164,7 @@ static PyObject *ImageMorphology_ImageGradiant(PyObject *self, PyObject *args, P
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageGradiant(std::string(pszInputImage), std::string(pszOutputImage),
                                           std::string(pszMorphOperator), (bool)useOperatorFile,
                                           morphOpSize, std::string(pszImageFormat),
@@ -197,6 +201,7 @@ static PyObject *ImageMorphology_ImageDilateCombinedOut(PyObject *self, PyObject
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageDilateCombinedOut(std::string(pszInputImage), std::string(pszOutputImage),
                                                    std::string(pszMorphOperator), (bool)useOperatorFile,
                                                    morphOpSize, std::string(pszImageFormat),
@@ -233,6 +238,7 @@ static PyObject *ImageMorphology_ImageErodeCombinedOut(PyObject *self, PyObject
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageErodeCombinedOut(std::string(pszInputImage), std::string(pszOutputImage),
                                                   std::string(pszMorphOperator), (bool)useOperatorFile,
                                                   morphOpSize, std::string(pszImageFormat), (rsgis::RSGISLibDataType)datatype);
@@ -267,6 +273,7 @@ static PyObject *ImageMorphology_ImageGradiantCombinedOut(PyObject *self, PyObje
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageGradiantCombinedOut(std::string(pszInputImage), std::string(pszOutputImage),
                                                      std::string(pszMorphOperator), (bool)useOperatorFile,
                                                      morphOpSize, std::string(pszImageFormat), (rsgis::RSGISLibDataType)datatype);
@@ -305,6 +312,7 @@ static PyObject *ImageMorphology_ImageLocalMinima(PyObject *self, PyObject *args
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageLocalMinima(std::string(pszInputImage), std::string(pszOutputImage),
                                              (bool)outputSequencial, (bool)allowEquals,
                                              std::string(pszMorphOperator), (bool)useOperatorFile,
@@ -344,6 +352,7 @@ static PyObject *ImageMorphology_ImageLocalMinimaCombinedOut(PyObject *self, PyO
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageLocalMinimaCombinedOut(std::string(pszInputImage), std::string(pszOutputImage),
                                                         (bool)outputSequencial, (bool)allowEquals,
                                                         std::string(pszMorphOperator), (bool)useOperatorFile,
@@ -382,6 +391,7 @@ static PyObject *ImageMorphology_ImageOpening(PyObject *self, PyObject *args, Py
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageOpening(std::string(pszInputImage), std::string(pszOutputImage),
                                          std::string(pszTempImage), std::string(pszMorphOperator),
                                          (bool)useOperatorFile, morphOpSize, numIterations, std::string(pszImageFormat),
@@ -420,6 +430,7 @@ static PyObject *ImageMorphology_ImageClosing(PyObject *self, PyObject *args, Py
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageClosing(std::string(pszInputImage), std::string(pszOutputImage),
                                          std::string(pszTempImage), std::string(pszMorphOperator),
                                          (bool)useOperatorFile, morphOpSize, numIterations,
@@ -456,6 +467,7 @@ static PyObject *ImageMorphology_ImageBlackTopHat(PyObject *self, PyObject *args
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageBlackTopHat(std::string(pszInputImage), std::string(pszOutputImage),
                                              std::string(pszTempImage), std::string(pszMorphOperator),
                                              (bool)useOperatorFile, morphOpSize, std::string(pszImageFormat),
@@ -492,6 +504,7 @@ static PyObject *ImageMorphology_ImageWhiteTopHat(PyObject *self, PyObject *args
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageWhiteTopHat(std::string(pszInputImage), std::string(pszOutputImage),
                                              std::string(pszTempImage), std::string(pszMorphOperator),
                                              (bool)useOperatorFile, morphOpSize, std::string(pszImageFormat),
@@ -659,7 +672,7 @@ static PyMethodDef ImageMorphologyMethods[] = {
 "\n"
 ":param input_img: is a string specifying the name and path of the input file.\n"
 ":param output_img: is a string specifying the name and path of the output file.\n"
-":param tmp_img: is a string specifying the name and path of a tempory file used for intermediate processing step(s). If empty string ('') then an in memory image will be used.\n"
+":param tmp_img: is no longer used, the operations are applied within a single pass over the image without intermediate images (retained for compatibility).\n"
 ":param morph_op_file: is a string with the name and path to a .gmtxt file with a square binary matrix specifying the morphology operator\n"
 ":param use_op_file: is a boolean specifying whether the morph_op_file file is present or whether a square operator (specified via op_size) should be used. (True = morph_op_file, False = op_size)\n"
 ":param op_size: is a integer specifying the square operator size (only used if use_op_file is False)\n"
@@ -675,7 +688,7 @@ static PyMethodDef ImageMorphologyMethods[] = {
 "\n"
 ":param input_img: is a string specifying the name and path of the input file.\n"
 ":param output_img: is a string specifying the name and path of the output file.\n"
-":param tmp_img: is a string specifying the name and path of a tempory file used for intermediate processing step(s). If empty string ('') then an in memory image will be used.\n"
+":param tmp_img: is no longer used, the operations are applied within a single pass over the image without intermediate images (retained for compatibility).\n"
 ":param morph_op_file: is a string with the name and path to a .gmtxt file with a square binary matrix specifying the morphology operator\n"
 ":param use_op_file: is a boolean specifying whether the morph_op_file file is present or whether a square operator (specified via op_size) should be used. (True = morph_op_file, False = op_size)\n"
 ":param op_size: is a integer specifying the square operator size (only used if use_op_file is False)\n"
@@ -691,7 +704,7 @@ static PyMethodDef ImageMorphologyMethods[] = {
 "\n"
 ":param input_img: is a string specifying the name and path of the input file.\n"
 ":param output_img: is a string specifying the name and path of the output file.\n"
-":param tmp_img: is a string specifying the name and path of a tempory file used for intermediate processing step(s).\n"
+":param tmp_img: is no longer used, the operations are applied within a single pass over the image without intermediate images (retained for compatibility).\n"
 ":param morph_op_file: is a string with the name and path to a .gmtxt file with a square binary matrix specifying the morphology operator\n"
 ":param use_op_file: is a boolean specifying whether the morph_op_file file is present or whether a square operator (specified via op_size) should be used. (True = morph_op_file, False = op_size)\n"
 ":param op_size: is a integer specifying the square operator size (only used if use_op_file is False)\n"
@@ -706,7 +719,7 @@ static PyMethodDef ImageMorphologyMethods[] = {
 "\n"
 ":param input_img: is a string specifying the name and path of the input file.\n"
 ":param output_img: is a string specifying the name and path of the output file.\n"
-":param tmp_img: is a string specifying the name and path of a tempory file used for intermediate processing step(s).\n"
+":param tmp_img: is no longer used, the operations are applied within a single pass over the image without intermediate images (retained for compatibility).\n"
 ":param morph_op_file: is a string with the name and path to a .gmtxt file with a square binary matrix specifying the morphology operator\n"
 ":param use_op_file: is a boolean specifying whether the morph_op_file file is present or whether a square operator (specified via op_size) should be used. (True = morph_op_file, False = op_size)\n"
 ":param op_size: is a integer specifying the square operator size (only used if use_op_file is False)\n"
@@ -112,6 +112,71 @@ static PyObject *ImageRegistration_FindImageOffset(PyObject *self, PyObject *arg
 }
 
 
+static PyObject *ImageRegistration_FindImageOffsetPhaseCorr(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("in_ref_img"), RSGIS_PY_C_TEXT("in_float_img"),
+                             RSGIS_PY_C_TEXT("ref_img_bands"), RSGIS_PY_C_TEXT("flt_img_bands"),
+                             RSGIS_PY_C_TEXT("x_search"), RSGIS_PY_C_TEXT("y_search"),
+                             RSGIS_PY_C_TEXT("sub_pxl"), RSGIS_PY_C_TEXT("tile_size"), nullptr};
+    const char *pszInputRefImage, *pszInputFloatImage;
+    unsigned int xImgSearch = 0;
+    unsigned int yImgSearch = 0;
+    int calcSubPixel = true;
+    unsigned int tileSize = 0;
+    PyObject *pRefImageBandsObj;
+    PyObject *pFltImageBandsObj;
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssOOII|iI:find_image_offset_phase_corr", kwlist, &pszInputRefImage,
+                                     &pszInputFloatImage, &pRefImageBandsObj, &pFltImageBandsObj,
+                                     &xImgSearch, &yImgSearch, &calcSubPixel, &tileSize))
+    {
+        return nullptr;
+    }
+
+    std::vector<unsigned int> refImageBands;
+    if( !PySequence_Check(pRefImageBandsObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "ref_img_bands argument must be a sequence");
+        return nullptr;
+    }
+    Py_ssize_t nRefImgBands = PySequence_Size(pRefImageBandsObj);
+    for(Py_ssize_t n = 0; n < nRefImgBands; ++n)
+    {
+        PyObject *o = PySequence_GetItem(pRefImageBandsObj, n);
+        refImageBands.push_back(RSGISPY_UINT_EXTRACT(o));
+    }
+
+    std::vector<unsigned int> fltImageBands;
+    if( !PySequence_Check(pFltImageBandsObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "flt_img_bands argument must be a sequence");
+        return nullptr;
+    }
+    Py_ssize_t nFltImgBands = PySequence_Size(pFltImageBandsObj);
+    for(Py_ssize_t n = 0; n < nFltImgBands; ++n)
+    {
+        PyObject *o = PySequence_GetItem(pFltImageBandsObj, n);
+        fltImageBands.push_back(RSGISPY_UINT_EXTRACT(o));
+    }
+
+    std::pair<double, double> offsets;
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        offsets = rsgis::cmds::excecuteFindImageOffsetPhaseCorr(std::string(pszInputRefImage), std::string(pszInputFloatImage),
+                                                               refImageBands, fltImageBands, xImgSearch, yImgSearch,
+                                                               (bool)calcSubPixel, tileSize);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    return Py_BuildValue("(dd)", offsets.first, offsets.second);
+}
+
+
 static PyObject *ImageRegistration_BasicRegistration(PyObject *self, PyObject *args, PyObject *keywds)
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("in_ref_img"), RSGIS_PY_C_TEXT("in_float_img"),
@@ -119,14 +184,16 @@ static PyObject *ImageRegistration_BasicRegistration(PyObject *self, PyObject *a
                              RSGIS_PY_C_TEXT("threshold"), RSGIS_PY_C_TEXT("win_size"),
                              RSGIS_PY_C_TEXT("search_area"), RSGIS_PY_C_TEXT("sd_ref_thres"),
                              RSGIS_PY_C_TEXT("sd_flt_thres"), RSGIS_PY_C_TEXT("sub_pxl_res"),
-                             RSGIS_PY_C_TEXT("metric_type"), RSGIS_PY_C_TEXT("output_type"),  nullptr};
+                             RSGIS_PY_C_TEXT("metric_type"), RSGIS_PY_C_TEXT("output_type"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *pszInputReferenceImage, *pszInputFloatingmage, *pszOutputGCPFile;
     int pixelGap, windowSize, searchArea, subPixelResolution, metricType, outputType;
     float threshold, stdDevRefThreshold, stdDevFloatThreshold;
+    unsigned int nThreads = 1;
     
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssifiiffiii:basic_registration", kwlist, &pszInputReferenceImage, &pszInputFloatingmage,
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssifiiffiii|I:basic_registration", kwlist, &pszInputReferenceImage, &pszInputFloatingmage,
                                      &pszOutputGCPFile, &pixelGap, &threshold, &windowSize, &searchArea, &stdDevRefThreshold,
-                                     &stdDevFloatThreshold, &subPixelResolution, &metricType, &outputType))
+                                     &stdDevFloatThreshold, &subPixelResolution, &metricType, &outputType, &nThreads))
     {
         return nullptr;
     }
@@ -136,7 +203,7 @@ static PyObject *ImageRegistration_BasicRegistration(PyObject *self, PyObject *a
         rsgis::cmds:: excecuteBasicRegistration(pszInputReferenceImage, pszInputFloatingmage, pixelGap,
                                     threshold, windowSize, searchArea, stdDevRefThreshold,
                                     stdDevFloatThreshold, subPixelResolution, metricType,
-                                    outputType, pszOutputGCPFile);
+                                    outputType, pszOutputGCPFile, nThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -156,17 +223,19 @@ static PyObject *ImageRegistration_SingleLayerRegistration(PyObject *self, PyObj
                              RSGIS_PY_C_TEXT("sd_flt_thres"), RSGIS_PY_C_TEXT("sub_pxl_res"),
                              RSGIS_PY_C_TEXT("dist_threshold"), RSGIS_PY_C_TEXT("max_n_iters"),
                              RSGIS_PY_C_TEXT("move_chng_thres"), RSGIS_PY_C_TEXT("p_smooth"),
-                             RSGIS_PY_C_TEXT("metric_type"), RSGIS_PY_C_TEXT("output_type"),  nullptr};
+                             RSGIS_PY_C_TEXT("metric_type"), RSGIS_PY_C_TEXT("output_type"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *pszInputReferenceImage, *pszInputFloatingmage, *pszOutputGCPFile;
     int pixelGap, windowSize, searchArea, subPixelResolution, metricType, 
         outputType, maxNumIterations, distanceThreshold;
     float threshold, stdDevRefThreshold, stdDevFloatThreshold, moveChangeThreshold,
         pSmoothness;
+    unsigned int nThreads = 1;
     
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssifiiffiiiffii:single_layer_registration", kwlist, &pszInputReferenceImage,
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssifiiffiiiffii|I:single_layer_registration", kwlist, &pszInputReferenceImage,
                                      &pszInputFloatingmage, &pszOutputGCPFile, &pixelGap, &threshold, &windowSize, &searchArea,
                                      &stdDevRefThreshold, &stdDevFloatThreshold, &subPixelResolution, &distanceThreshold,
-                                     &maxNumIterations, &moveChangeThreshold, &pSmoothness, &metricType, &outputType))
+                                     &maxNumIterations, &moveChangeThreshold, &pSmoothness, &metricType, &outputType, &nThreads))
     {
         return nullptr;
     }
@@ -177,7 +246,7 @@ static PyObject *ImageRegistration_SingleLayerRegistration(PyObject *self, PyObj
                                     threshold, windowSize, searchArea, stdDevRefThreshold,
                                     stdDevFloatThreshold, subPixelResolution, distanceThreshold,
                                     maxNumIterations, moveChangeThreshold, pSmoothness, metricType,
-                                    outputType, pszOutputGCPFile);
+                                    outputType, pszOutputGCPFile, nThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -229,6 +298,7 @@ static PyObject *ImageRegistration_ApplyOffset2Image(PyObject *self, PyObject *a
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeApplyOffset2Image(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszGDALFormat), (rsgis::RSGISLibDataType) nOutDataType, xOff, yOff);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -240,6 +310,36 @@ static PyObject *ImageRegistration_ApplyOffset2Image(PyObject *self, PyObject *a
     Py_RETURN_NONE;
 }
 
+static PyObject *ImageRegistration_WarpWithGCPs(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("in_ref_img"), RSGIS_PY_C_TEXT("in_process_img"), RSGIS_PY_C_TEXT("output_img"),
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("datatype"), RSGIS_PY_C_TEXT("interp_method"),
+                             RSGIS_PY_C_TEXT("use_tps"), RSGIS_PY_C_TEXT("poly_order"), nullptr};
+    const char *pszRefImage, *pszInputImage, *pszOutputImage, *pszGDALFormat;
+    int nOutDataType;
+    unsigned int interpMethod = 0;
+    int useTPS = false;
+    unsigned int polyOrder = 3;
+    
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssssi|IiI:warp_with_gcps", kwlist, &pszRefImage, &pszInputImage, &pszOutputImage, &pszGDALFormat, &nOutDataType, &interpMethod, &useTPS, &polyOrder))
+    {
+        return nullptr;
+    }
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeWarpImgWithGCPs(std::string(pszRefImage), std::string(pszInputImage), std::string(pszOutputImage), std::string(pszGDALFormat), (rsgis::RSGISLibDataType) nOutDataType, interpMethod, (bool)useTPS, polyOrder);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
 // Our list of functions in this module
 static PyMethodDef ImageRegistrationMethods[] = {
 {"find_image_offset", (PyCFunction)ImageRegistration_FindImageOffset, METH_VARARGS | METH_KEYWORDS,
@@ -261,8 +361,32 @@ static PyMethodDef ImageRegistrationMethods[] = {
 "\n"
 },
 
+{"find_image_offset_phase_corr", (PyCFunction)ImageRegistration_FindImageOffsetPhaseCorr, METH_VARARGS | METH_KEYWORDS,
+"imageregistration.find_image_offset_phase_corr(in_ref_img:str, in_float_img:str, ref_img_bands:list, flt_img_bands:list, x_search:int, y_search:int, sub_pxl:bool=True, tile_size:int=0)\n"
+"Calculate the X/Y offset between the input reference and float images using FFT phase correlation.\n"
+"Each image is read once, rather than the similarity being calculated over the overlap for every\n"
+"shift as in find_image_offset, and the offsets have the same sign as find_image_offset. The images\n"
+"must have the same pixel size.\n"
+"\n"
+":param in_ref_img: is a string providing reference image which to which the floating image is to be registered.\n"
+":param in_float_img: is a string providing the floating image to be registered to the reference image\n"
+":param ref_img_bands: is a list of image bands from the reference image which are used for the correlation.\n"
+":param flt_img_bands: is a list of image bands from the floating image which are used for the correlation.\n"
+":param x_search: is the maximum number of pixels in the x-axis the image can be moved either side of the centre.\n"
+":param y_search: is the maximum number of pixels in the y-axis the image can be moved either side of the centre.\n"
+":param sub_pxl: is a boolean specifying whether a sub-pixel offset is estimated from the correlation peak (Default: True).\n"
+":param tile_size: if above 0 the overlap is split into tiles of tile_size x tile_size pixels and the median of the tile offsets is returned, which is robust to local changes between the images. If 0 (Default) the whole overlap is used as a single tile.\n"
+":return: (x_offset, y_offset)\n"
+"\n"
+".. code:: python\n"
+"\n"
+"    from rsgislib import imageregistration\n"
+"    x_off, y_off = imageregistration.find_image_offset_phase_corr('ref.kea', 'float.kea', [1,2,3], [1,2,3], 10, 10, tile_size=256)\n"
+"\n"
+},
+
 {"basic_registration", (PyCFunction)ImageRegistration_BasicRegistration, METH_VARARGS | METH_KEYWORDS,
-"imageregistration.basic_registration(in_ref_img:str, in_float_img:str, out_gcp_file:str, pixel_gap:int, threshold:float, win_size:int, search_area:int, sd_ref_thres:float, sd_flt_thres:float, sub_pxl_res:float, metric_type:int, output_type:int)\n"
+"imageregistration.basic_registration(in_ref_img:str, in_float_img:str, out_gcp_file:str, pixel_gap:int, threshold:float, win_size:int, search_area:int, sd_ref_thres:float, sd_flt_thres:float, sub_pxl_res:float, metric_type:int, output_type:int, n_threads:int=1)\n"
 "Generate tie points between floating and reference image using basic algorithm.\n"
 "\n"
 ":param in_ref_img: is a string providing reference image which to which the floating image is to be registered.n"
@@ -277,6 +401,7 @@ static PyMethodDef ImageRegistrationMethods[] = {
 ":param sub_pxl_res: is an int specifying the sub-pixel resolution to which the pixel shifts are estimated. Note that the values are positive integers such that a value of 2 will result in a sub pixel resolution of 0.5 of a pixel and a value 4 will be 0.25 of a pixel. \n"
 ":param metric_type: is an the similarity metric used to compare images of type rsgislib.imageregistration.METRIC_* \n"
 ":param output_type: is an the format of the output file of type rsgislib.imageregistration.TYPE_* \n"
+":param n_threads: is the number of threads used to match the tie points (Default: 1; 0 uses all the available cores). The tie points found are the same for any number of threads.\n"
 "\n"
 ".. code:: python\n"
 "\n"
@@ -297,7 +422,7 @@ static PyMethodDef ImageRegistrationMethods[] = {
 },
 
     {"single_layer_registration", (PyCFunction)ImageRegistration_SingleLayerRegistration, METH_VARARGS | METH_KEYWORDS,
-"imageregistration.single_layer_registration(in_ref_img:str, in_float_img:str, out_gcp_file:str, pixel_gap:int, threshold:float, win_size:int, search_area:int, sd_ref_thres:float, sd_flt_thres:float, sub_pxl_res:float, dist_threshold:float, max_n_iters:int, move_chng_thres:float, p_smooth:float, metric_type:int, output_type:int)\n"
+"imageregistration.single_layer_registration(in_ref_img:str, in_float_img:str, out_gcp_file:str, pixel_gap:int, threshold:float, win_size:int, search_area:int, sd_ref_thres:float, sd_flt_thres:float, sub_pxl_res:float, dist_threshold:float, max_n_iters:int, move_chng_thres:float, p_smooth:float, metric_type:int, output_type:int, n_threads:int=1)\n"
 "Generate tie points between floating and reference image using a single connected layer of tie points.\n"
 "\n"
 ":param in_ref_img: is a string providing reference image which to which the floating image is to be registered.n"
@@ -316,6 +441,7 @@ static PyMethodDef ImageRegistrationMethods[] = {
 ":param p_smooth: is a float providing the 'p' parameter for the inverse weighted distance calculation. A value of 2 should be used by default\n"
 ":param metric_type: is an the similarity metric used to compare images of type rsgislib.imageregistration.METRIC_* \n"
 ":param output_type: is an the format of the output file of type rsgislib.imageregistration.TYPE_* \n"
+":param n_threads: is the number of threads used to match the tie points (Default: 1; 0 uses all the available cores). The tie points found are the same for any number of threads.\n"
 "\n"
 ".. code:: python\n"
 "\n"
@@ -379,6 +505,29 @@ static PyMethodDef ImageRegistrationMethods[] = {
 "    datatype = rsgislib.TYPE_32INT\n"
 "    imageregistration.apply_offset_to_image(inputImage, outputImage, gdalformat, datatype, -3.0, -3.0)\n"
 "\n"
+},
+
+{"warp_with_gcps", (PyCFunction)ImageRegistration_WarpWithGCPs, METH_VARARGS | METH_KEYWORDS,
+"imageregistration.warp_with_gcps(in_ref_img:str, in_process_img:str, output_img:str, gdalformat:str, datatype:int, interp_method:int=0, use_tps:bool=False, poly_order:int=3)\n"
+"Warp an image onto the pixel grid of a reference image using the GCPs stored in the image header\n"
+"(e.g., from gcp_to_gdal). The transformation is evaluated on a coarse grid of output pixels and\n"
+"interpolated between the grid nodes, with the input image read and the output written in strips.\n"
+"\n"
+":param in_ref_img: is a string providing the reference image which defines the output pixel grid.\n"
+":param in_process_img: is a string providing the image to be warped, which has the GCPs in its header.\n"
+":param output_img: is a string providing the output image.\n"
+":param gdalformat: is a string providing the output format (e.g., KEA).\n"
+":param datatype: is a rsgislib.TYPE_* value providing the output data type.\n"
+":param interp_method: is the interpolation method (0 = nearest neighbour, 1 = bilinear, 2 = cubic).\n"
+":param use_tps: is a boolean specifying that a thin plate spline is used rather than a polynomial.\n"
+":param poly_order: is the order of the polynomial (1 - 3) used when use_tps is False.\n"
+"\n"
+".. code:: python\n"
+"\n"
+"    import rsgislib\n"
+"    from rsgislib import imageregistration\n"
+"    imageregistration.warp_with_gcps('ref_img.kea', 'img_with_gcps.kea', 'out_img.kea', 'KEA', rsgislib.TYPE_16UINT, interp_method=1, poly_order=2)\n"
+"\n"
 },
     
 	{nullptr}        /* Sentinel */
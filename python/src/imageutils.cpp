@@ -22,7 +22,9 @@
 
 #include "rsgispy_common.h"
 #include "cmds/RSGISCmdImageUtils.h"
+#include "cmds/RSGISCmdSegmentation.h"
 #include <vector>
+#include <algorithm>
 
 /* An exception object for this module */
 /* created in the init function */
@@ -134,6 +136,7 @@ static PyObject *ImageUtils_StretchImage(PyObject *self, PyObject *args, PyObjec
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeStretchImageNoData(pszInputImage, pszOutputFile, inNoData, saveOutStats,
                                                pszOutStatsFile, onePassSD, pszGDALFormat,
                                                (rsgis::RSGISLibDataType)nOutDataType, (rsgis::cmds::RSGISStretches)nStretchType, fStretchParam);
@@ -166,6 +169,7 @@ static PyObject *ImageUtils_StretchImageWithStats(PyObject *self, PyObject *args
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeStretchImageWithStatsNoData(pszInputImage, pszOutputFile, pszInStatsFile,
                                                         pszGDALFormat, (rsgis::RSGISLibDataType)nOutDataType,
                                                         (rsgis::cmds::RSGISStretches)nStretchType, fStretchParam, nodataval);
@@ -201,6 +205,7 @@ static PyObject *ImageUtils_NormaliseImagePxlVals(PyObject *self, PyObject *args
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeNormaliseImgPxlVals(std::string(pszInputImage), std::string(pszOutputFile),
                                                 std::string(pszGDALFormat), (rsgis::RSGISLibDataType)nOutDataType, inNoDataVal,
                                                 outNoDataVal, outMinVal, outMaxVal, (rsgis::cmds::RSGISStretches)nStretchType, fStretchParam);
@@ -219,12 +224,13 @@ static PyObject *ImageUtils_maskImage(PyObject *self, PyObject *args, PyObject *
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("in_msk_img"),
                              RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
                              RSGIS_PY_C_TEXT("datatype"), RSGIS_PY_C_TEXT("out_value"),
-                             RSGIS_PY_C_TEXT("mask_value"),  nullptr};
+                             RSGIS_PY_C_TEXT("mask_value"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *pszInputImage, *pszImageMask, *pszOutputImage, *pszGDALFormat;
     int nDataType;
-    float outValue;
+    PyObject *outValueObj;
     PyObject *maskValueObj;
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssssifO:mask_img", kwlist, &pszInputImage, &pszImageMask, &pszOutputImage, &pszGDALFormat, &nDataType, &outValue, &maskValueObj ))
+    unsigned int numThreads = 1;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssssiOO|I:mask_img", kwlist, &pszInputImage, &pszImageMask, &pszOutputImage, &pszGDALFormat, &nDataType, &outValueObj, &maskValueObj, &numThreads ))
     {
         return nullptr;
     }
@@ -262,9 +268,49 @@ static PyObject *ImageUtils_maskImage(PyObject *self, PyObject *args, PyObject *
         }
     }
     
+    // Either a single output value for all the mask values or one output value per mask value.
+    std::vector<double> outValues;
+    if( !PySequence_Check(outValueObj))
+    {
+        if(RSGISPY_CHECK_FLOAT(outValueObj) || RSGISPY_CHECK_INT(outValueObj))
+        {
+            outValues.assign(maskValues.size(), (float)RSGISPY_FLOAT_EXTRACT(outValueObj));
+        }
+        else
+        {
+            PyErr_SetString(GETSTATE(self)->error, "Output value must be numeric or a list of numeric.");
+            return nullptr;
+        }
+    }
+    else
+    {
+        Py_ssize_t numOutVals = PySequence_Size(outValueObj);
+        if(numOutVals != ((Py_ssize_t)maskValues.size()))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "If a list of output values is provided there must be one for each mask value.");
+            return nullptr;
+        }
+        for( Py_ssize_t n = 0; n < numOutVals; n++ )
+        {
+            PyObject *o = PySequence_GetItem(outValueObj, n);
+            bool validVal = RSGISPY_CHECK_FLOAT(o) || RSGISPY_CHECK_INT(o);
+            if(validVal)
+            {
+                outValues.push_back((float)RSGISPY_FLOAT_EXTRACT(o));
+            }
+            Py_DECREF(o);
+            if(!validVal)
+            {
+                PyErr_SetString(GETSTATE(self)->error, "Output value must be numeric or a list of numeric.");
+                return nullptr;
+            }
+        }
+    }
+    
     try
     {
-        rsgis::cmds::executeMaskImage(pszInputImage, pszImageMask, pszOutputImage, pszGDALFormat, (rsgis::RSGISLibDataType)nDataType, outValue, maskValues);
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeMaskImage(pszInputImage, pszImageMask, pszOutputImage, pszGDALFormat, (rsgis::RSGISLibDataType)nDataType, maskValues, outValues, numThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -281,13 +327,14 @@ static PyObject *ImageUtils_createTiles(PyObject *self, PyObject *args, PyObject
                              RSGIS_PY_C_TEXT("tile_width"), RSGIS_PY_C_TEXT("tile_height"),
                              RSGIS_PY_C_TEXT("tile_overlap"), RSGIS_PY_C_TEXT("offset_tiles"),
                              RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("datatype"),
-                             RSGIS_PY_C_TEXT("out_img_ext"), nullptr};
+                             RSGIS_PY_C_TEXT("out_img_ext"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *pszInputImage, *pszImageBase, *pszGDALFormat, *pszExt = "";
     unsigned int imgWidth, imgHeight, imgTileOverlap = 0;
     int offsetTiling = false;
     int nDataType;
+    unsigned int numThreads = 1;
     
-    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssIIIisis:create_tiles", kwlist, &pszInputImage, &pszImageBase, &imgWidth, &imgHeight, &imgTileOverlap, &offsetTiling, &pszGDALFormat, &nDataType, &pszExt))
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssIIIisis|I:create_tiles", kwlist, &pszInputImage, &pszImageBase, &imgWidth, &imgHeight, &imgTileOverlap, &offsetTiling, &pszGDALFormat, &nDataType, &pszExt, &numThreads))
     {
         return nullptr;
     }
@@ -296,7 +343,10 @@ static PyObject *ImageUtils_createTiles(PyObject *self, PyObject *args, PyObject
     try
     {
         std::vector<std::string> outFileNames;
-        rsgis::cmds::executeCreateTiles(pszInputImage, pszImageBase, imgWidth, imgHeight, imgTileOverlap, offsetTiling, pszGDALFormat, (rsgis::RSGISLibDataType)nDataType, pszExt, &outFileNames);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeCreateTiles(pszInputImage, pszImageBase, imgWidth, imgHeight, imgTileOverlap, offsetTiling, pszGDALFormat, (rsgis::RSGISLibDataType)nDataType, pszExt, &outFileNames, numThreads);
+        }
         
         pOutList = PyList_New(outFileNames.size());
         Py_ssize_t nIndex = 0;
@@ -316,24 +366,77 @@ static PyObject *ImageUtils_createTiles(PyObject *self, PyObject *args, PyObject
     return pOutList;
 }
 
+static PyObject *ImageUtils_createTilesFromMasks(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("in_msk_imgs"),
+                             RSGIS_PY_C_TEXT("output_imgs"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("datatype"), RSGIS_PY_C_TEXT("out_value"),
+                             RSGIS_PY_C_TEXT("mask_value"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
+    const char *pszInputImage, *pszGDALFormat;
+    PyObject *pMaskImages, *pOutputImages;
+    int nDataType;
+    float outValue = 0;
+    float maskValue = 0;
+    unsigned int numThreads = 1;
+    
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "sOOsi|ffI:create_tiles_from_masks", kwlist, &pszInputImage, &pMaskImages, &pOutputImages, &pszGDALFormat, &nDataType, &outValue, &maskValue, &numThreads))
+    {
+        return nullptr;
+    }
+    
+    if((!PySequence_Check(pMaskImages)) || (!PySequence_Check(pOutputImages)))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "in_msk_imgs and output_imgs must be sequences");
+        return nullptr;
+    }
+    std::vector<std::string> maskImages = ExtractStringVectorFromSequence(pMaskImages);
+    std::vector<std::string> outputImages = ExtractStringVectorFromSequence(pOutputImages);
+    if(PyErr_Occurred())
+    {
+        return nullptr;
+    }
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeCreateTilesFromMasks(pszInputImage, maskImages, outputImages, pszGDALFormat, (rsgis::RSGISLibDataType)nDataType, outValue, maskValue, numThreads);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
 static PyObject *ImageUtils_createImageMosaic(PyObject *self, PyObject *args, PyObject *keywds)
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("output_img"),
                              RSGIS_PY_C_TEXT("background_val"), RSGIS_PY_C_TEXT("skip_val"),
                              RSGIS_PY_C_TEXT("skip_band"), RSGIS_PY_C_TEXT("overlap_behaviour"),
-                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("datatype"), nullptr};
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("datatype"),
+                             RSGIS_PY_C_TEXT("n_threads"), RSGIS_PY_C_TEXT("out_ref_img"), nullptr};
     const char *pszOutputImage, *pszGDALFormat;
+    const char *pszOutRefImage = nullptr;
     float backgroundVal, skipVal;
     int skipBand, nDataType, overlapBehaviour;
+    unsigned int nThreads = 1;
     PyObject *pInputImages; // List of input images
 
     // Check parameters are present and of correct type
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Osffiisi:create_img_mosaic", kwlist, &pInputImages, &pszOutputImage,
-                                &backgroundVal, &skipVal, &skipBand, &overlapBehaviour,&pszGDALFormat, &nDataType))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Osffiisi|Iz:create_img_mosaic", kwlist, &pInputImages, &pszOutputImage,
+                                &backgroundVal, &skipVal, &skipBand, &overlapBehaviour,&pszGDALFormat, &nDataType, &nThreads, &pszOutRefImage))
     {
         return nullptr;
     }
 
+    std::string outRefImage = "";
+    if(pszOutRefImage != nullptr)
+    {
+        outRefImage = std::string(pszOutRefImage);
+    }
+
     // TODO: Look into this function - doesn't seem to catch when only a single image is provided.
     if(!PySequence_Check(pInputImages))
     {
@@ -352,15 +455,77 @@ static PyObject *ImageUtils_createImageMosaic(PyObject *self, PyObject *args, Py
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageMosaic(inputImages, numImages, pszOutputImage, backgroundVal, 
-                    skipVal, skipBand-1, overlapBehaviour, pszGDALFormat, (rsgis::RSGISLibDataType)nDataType);
+                    skipVal, skipBand-1, overlapBehaviour, pszGDALFormat, (rsgis::RSGISLibDataType)nDataType, nThreads, outRefImage);
+
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
 
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageUtils_updateImageMosaic(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("mosaic_img"),
+                             RSGIS_PY_C_TEXT("ref_img"), RSGIS_PY_C_TEXT("background_val"),
+                             RSGIS_PY_C_TEXT("skip_val"), RSGIS_PY_C_TEXT("skip_band"),
+                             RSGIS_PY_C_TEXT("overlap_behaviour"), RSGIS_PY_C_TEXT("update_stats"),
+                             RSGIS_PY_C_TEXT("update_overviews"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
+    const char *pszMosaicImage;
+    const char *pszRefImage = nullptr;
+    float backgroundVal = 0;
+    float skipVal = 0;
+    int skipBand = 1;
+    int overlapBehaviour = 0;
+    int updateStats = true;
+    int updateOverviews = true;
+    unsigned int nThreads = 1;
+    PyObject *pInputImages; // List of input images
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Os|zffiiiiI:update_img_mosaic", kwlist, &pInputImages, &pszMosaicImage,
+                                &pszRefImage, &backgroundVal, &skipVal, &skipBand, &overlapBehaviour, &updateStats, &updateOverviews, &nThreads))
+    {
+        return nullptr;
+    }
+
+    if(!PySequence_Check(pInputImages))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "First argument must be a sequence");
+        return nullptr;
+    }
+
+    int numImages = 0;
+    std::string *inputImages = ExtractStringArrayFromSequence(pInputImages, &numImages);
+    if(numImages == 0)
+    {
+        PyErr_SetString(GETSTATE(self)->error, "No input images provided");
+        return nullptr;
+    }
+
+    std::string refImage = "";
+    if(pszRefImage != nullptr)
+    {
+        refImage = std::string(pszRefImage);
+    }
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeImageMosaicUpdate(inputImages, numImages, pszMosaicImage, refImage, backgroundVal,
+                    skipVal, skipBand-1, overlapBehaviour, updateStats, updateOverviews, nThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
+        delete[] inputImages;
         PyErr_SetString(GETSTATE(self)->error, e.what());
         return nullptr;
     }
+    delete[] inputImages;
 
     Py_RETURN_NONE;
 }
@@ -368,14 +533,16 @@ static PyObject *ImageUtils_createImageMosaic(PyObject *self, PyObject *args, Py
 static PyObject *ImageUtils_IncludeImages(PyObject *self, PyObject *args, PyObject *keywds)
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("include_imgs"),
-                             RSGIS_PY_C_TEXT("input_bands"), RSGIS_PY_C_TEXT("skip_val"), nullptr};
+                             RSGIS_PY_C_TEXT("input_bands"), RSGIS_PY_C_TEXT("skip_val"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *pszBaseImage;
     PyObject *pInputImages; // List of input images
     PyObject *pInputBands = Py_None; // List of bands
     PyObject *pSkipVal = Py_None;
+    unsigned int nThreads = 1;
 
     // Check parameters are present and of correct type
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sO|OO:include_imgs", kwlist, &pszBaseImage, &pInputImages, &pInputBands, &pSkipVal))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sO|OOI:include_imgs", kwlist, &pszBaseImage, &pInputImages, &pInputBands, &pSkipVal, &nThreads))
         return nullptr;
 
     // TODO: Look into this function - doesn't seem to catch when only a single image is provided.
@@ -435,7 +602,8 @@ static PyObject *ImageUtils_IncludeImages(PyObject *self, PyObject *args, PyObje
     
     try
     {
-        rsgis::cmds::executeImageInclude(inputImages, numImages, pszBaseImage, bandsDefined, imgBands, skipVal, useSkipVal);
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeImageInclude(inputImages, numImages, pszBaseImage, bandsDefined, imgBands, skipVal, useSkipVal, nThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -478,6 +646,7 @@ static PyObject *ImageUtils_IncludeImagesOverlap(PyObject *self, PyObject *args,
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageIncludeOverlap(inputImages, numImages, pszBaseImage, pxlOverlap);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -519,6 +688,7 @@ static PyObject *ImageUtils_IncludeImagesIndImgIntersect(PyObject *self, PyObjec
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageIncludeIndImgIntersect(inputImages, numImages, pszBaseImage);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -536,11 +706,13 @@ static PyObject *ImageUtils_PopImageStats(PyObject *self, PyObject *args, PyObje
     int useNoDataValue = true;
     int buildPyramids = true;
     float noDataValue = 0;
+    unsigned int numThreads = 1;
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("use_no_data"),
-                             RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("calc_pyramids"), nullptr};
+                             RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("calc_pyramids"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
 
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "s|ifi:pop_img_stats", kwlist, &pszInputImage,
-                    &useNoDataValue, &noDataValue, &buildPyramids))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "s|ifiI:pop_img_stats", kwlist, &pszInputImage,
+                    &useNoDataValue, &noDataValue, &buildPyramids, &numThreads))
     {
         return nullptr;
     }
@@ -549,7 +721,8 @@ static PyObject *ImageUtils_PopImageStats(PyObject *self, PyObject *args, PyObje
     
     try
     {
-        rsgis::cmds::executePopulateImgStats(pszInputImage, useNoDataValue, noDataValue, buildPyramids, pyraScaleVals);
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executePopulateImgStats(pszInputImage, useNoDataValue, noDataValue, buildPyramids, pyraScaleVals, numThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -600,6 +773,7 @@ static PyObject *ImageUtils_AssignProj(PyObject *self, PyObject *args, PyObject
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeAssignProj(pszInputImage, pszInputProj, readWKTFromFile, pszInputProjFile);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -623,6 +797,7 @@ static PyObject *ImageUtils_CopyProjFromImage(PyObject *self, PyObject *args, Py
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCopyProj(pszInputImage, pszInputRefImage);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -646,6 +821,7 @@ static PyObject *ImageUtils_CopySpatialAndProjFromImage(PyObject *self, PyObject
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCopyProjSpatial(pszInputImage, pszInputRefImage);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -746,6 +922,7 @@ static PyObject *ImageUtils_AssignSpatialInfo(PyObject *self, PyObject *args, Py
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeAssignSpatialInfo(pszInputImage, xTL, yTL, xRes, yRes, xRot, yRot, xTLDef, yTLDef, xResDef, yResDef, xRotDef, yRotDef);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -800,6 +977,7 @@ static PyObject *ImageUtils_SelectImageBands(PyObject *self, PyObject *args, PyO
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeSubsetImageBands(std::string(pszInputImage), std::string(pszOutputFile),
                                              imgBands, std::string(pszGDALFormat), (rsgis::RSGISLibDataType)nDataType);
     }
@@ -827,6 +1005,7 @@ static PyObject *ImageUtils_Subset(PyObject *self, PyObject *args, PyObject *key
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeSubset(std::string(pszInputImage), std::string(pszInputVectorFile),
                                    std::string(pszInputVectorLyr), std::string(pszOutputImage),
                                    std::string(pszGDALFormat), (rsgis::RSGISLibDataType)nOutDataType);
@@ -858,6 +1037,7 @@ static PyObject *ImageUtils_SubsetBBox(PyObject *self, PyObject *args, PyObject
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeSubsetBBox(pszInputImage, pszOutputImage, pszGDALFormat, (rsgis::RSGISLibDataType)nOutDataType, xMin, xMax, yMin, yMax);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -869,6 +1049,93 @@ static PyObject *ImageUtils_SubsetBBox(PyObject *self, PyObject *args, PyObject
     Py_RETURN_NONE;
 }
 
+static PyObject *ImageUtils_SubsetBBoxes(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("bboxs"),
+                             RSGIS_PY_C_TEXT("output_imgs"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("datatype"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
+
+    const char *pszInputImage, *pszGDALFormat;
+    PyObject *pBBoxes, *pOutputImages;
+    int nOutDataType;
+    unsigned int numThreads = 1;
+    
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sOOsi|I:subset_bboxs", kwlist, &pszInputImage, &pBBoxes, &pOutputImages, &pszGDALFormat, &nOutDataType, &numThreads))
+    {
+        return nullptr;
+    }
+    
+    if((!PySequence_Check(pBBoxes)) || (!PySequence_Check(pOutputImages)))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "bboxs and output_imgs must be sequences");
+        return nullptr;
+    }
+    std::vector<std::string> outputImages = ExtractStringVectorFromSequence(pOutputImages);
+    if(PyErr_Occurred())
+    {
+        return nullptr;
+    }
+    
+    // Each bbox is (min_x, max_x, min_y, max_y) as for subset_bbox.
+    Py_ssize_t nBBoxes = PySequence_Size(pBBoxes);
+    std::vector<double> xMins, xMaxs, yMins, yMaxs;
+    for(Py_ssize_t i = 0; i < nBBoxes; ++i)
+    {
+        PyObject *pBBox = PySequence_GetItem(pBBoxes, i);
+        double bbox[4] = {0.0, 0.0, 0.0, 0.0};
+        bool validBBox = PySequence_Check(pBBox) && (PySequence_Size(pBBox) == 4);
+        for(Py_ssize_t n = 0; validBBox && (n < 4); ++n)
+        {
+            PyObject *pVal = PySequence_GetItem(pBBox, n);
+            if(RSGISPY_CHECK_FLOAT(pVal) || RSGISPY_CHECK_INT(pVal))
+            {
+                bbox[n] = RSGISPY_FLOAT_EXTRACT(pVal);
+            }
+            else
+            {
+                validBBox = false;
+            }
+            Py_DECREF(pVal);
+        }
+        Py_DECREF(pBBox);
+        if(!validBBox)
+        {
+            PyErr_SetString(GETSTATE(self)->error, "Each bbox must be a sequence of 4 numbers (min_x, max_x, min_y, max_y)");
+            return nullptr;
+        }
+        xMins.push_back(bbox[0]);
+        xMaxs.push_back(bbox[1]);
+        yMins.push_back(bbox[2]);
+        yMaxs.push_back(bbox[3]);
+    }
+    
+    PyObject *pOutList;
+    try
+    {
+        std::vector<std::string> outFileNames;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeSubsetBBoxes(pszInputImage, outputImages, pszGDALFormat, (rsgis::RSGISLibDataType)nOutDataType, xMins, xMaxs, yMins, yMaxs, numThreads, &outFileNames);
+        }
+        
+        pOutList = PyList_New(outFileNames.size());
+        Py_ssize_t nIndex = 0;
+        for( auto itr = outFileNames.begin(); itr != outFileNames.end(); itr++)
+        {
+            PyObject *pVal = RSGISPY_CREATE_STRING((*itr).c_str());
+            PyList_SetItem(pOutList, nIndex, pVal ); // steals a reference
+            nIndex++;
+        }
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    return pOutList;
+}
+
 static PyObject *ImageUtils_Subset2Img(PyObject *self, PyObject *args, PyObject *keywds)
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("in_roi_img"),
@@ -882,6 +1149,7 @@ static PyObject *ImageUtils_Subset2Img(PyObject *self, PyObject *args, PyObject
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeSubset2Img(std::string(pszInputImage), std::string(pszInputROI),
                                        std::string(pszOutputImage), std::string(pszGDALFormat),
                                        (rsgis::RSGISLibDataType)nOutDataType);
@@ -900,17 +1168,18 @@ static PyObject *ImageUtils_StackImageBands(PyObject *self, PyObject *args, PyOb
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("band_names"),
                              RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("skip_value"),
                              RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("gdalformat"),
-                             RSGIS_PY_C_TEXT("datatype"), nullptr};
+                             RSGIS_PY_C_TEXT("datatype"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *pszOutputFile;
     const char *pszGDALFormat;
     int nDataType;
     float noDataValue;
+    unsigned int numThreads = 1;
     PyObject *skipValueObj = nullptr;
     PyObject *pInputImages = nullptr;
     PyObject *pimageBandNames = nullptr;
     
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "OOsOfsi:stack_img_bands", kwlist, &pInputImages, &pimageBandNames,
-                                     &pszOutputFile, &skipValueObj, &noDataValue, &pszGDALFormat, &nDataType))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "OOsOfsi|I:stack_img_bands", kwlist, &pInputImages, &pimageBandNames,
+                                     &pszOutputFile, &skipValueObj, &noDataValue, &pszGDALFormat, &nDataType, &numThreads))
     {
         return nullptr;
     }
@@ -965,9 +1234,10 @@ static PyObject *ImageUtils_StackImageBands(PyObject *self, PyObject *args, PyOb
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeStackImageBands(inputImages, imageBandNames, numImages, std::string(pszOutputFile),
                                             skipPixels, skipValue, noDataValue, std::string(pszGDALFormat),
-                                            (rsgis::RSGISLibDataType)nDataType, replaceBandNames);
+                                            (rsgis::RSGISLibDataType)nDataType, replaceBandNames, numThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1004,6 +1274,7 @@ static PyObject *ImageUtils_CreateBlankImage(PyObject *self, PyObject *args, PyO
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCreateBlankImage(std::string(pszOutputImage), numBands, width, height, tlX, tlY,
                                              res_x, res_y, pxlVal, std::string(wktFile), std::string(wktString),
                                              std::string(pszGDALFormat), (rsgis::RSGISLibDataType)nOutDataType);
@@ -1036,6 +1307,7 @@ static PyObject *ImageUtils_CreateCopyImage(PyObject *self, PyObject *args, PyOb
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCreateCopyBlankImage(std::string(pszInputImage), std::string(pszOutputImage),
                                                  numBands, pxlVal, std::string(pszGDALFormat), (rsgis::RSGISLibDataType)nOutDataType);
     }
@@ -1072,6 +1344,7 @@ static PyObject *ImageUtils_CreateCopyImageDefExtent(PyObject *self, PyObject *a
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCreateCopyBlankDefExtImage(std::string(pszInputImage), std::string(pszOutputImage),
                                                  numBands, xMin, xMax, yMin, yMax, xRes, yRes, pxlVal,
                                                  std::string(pszGDALFormat), (rsgis::RSGISLibDataType)nOutDataType);
@@ -1105,6 +1378,7 @@ static PyObject *ImageUtils_CreateCopyImageVecExtent(PyObject *self, PyObject *a
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCreateCopyBlankImageVecExtent(std::string(pszInputImage), std::string(pszInputVectorFile),
                                                           std::string(pszInputVectorLyr), std::string(pszOutputImage),
                                                           numBands, pxlVal, std::string(pszGDALFormat),
@@ -1121,12 +1395,17 @@ static PyObject *ImageUtils_CreateCopyImageVecExtent(PyObject *self, PyObject *a
 
 static PyObject *ImageUtils_OrderImagesUsingPropValidData(PyObject *self, PyObject *args, PyObject *keywds)
 {
-    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("no_data_val"), nullptr};
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("est_mode"),
+                             RSGIS_PY_C_TEXT("err_tol"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
     float noDataValue;
     PyObject *pInputImages; // List of input images
+    unsigned int estMode = 0;
+    float errTolerance = 0.01;
+    unsigned int numThreads = 1;
     
     // Check parameters are present and of correct type
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Of:order_img_using_prop_valid_pxls", kwlist, &pInputImages, &noDataValue))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Of|IfI:order_img_using_prop_valid_pxls", kwlist, &pInputImages, &noDataValue,
+                                     &estMode, &errTolerance, &numThreads))
     {
         return nullptr;
     }
@@ -1149,7 +1428,11 @@ static PyObject *ImageUtils_OrderImagesUsingPropValidData(PyObject *self, PyObje
     PyObject *outImagesList = nullptr;
     try
     {
-        std::vector<std::string> orderedInputImages = rsgis::cmds::executeOrderImageUsingValidDataProp(inputImages, noDataValue);
+        std::vector<std::string> orderedInputImages;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            orderedInputImages = rsgis::cmds::executeOrderImageUsingValidDataProp(inputImages, noDataValue, estMode, errTolerance, numThreads);
+        }
         
         outImagesList = PyTuple_New(orderedInputImages.size());
         
@@ -1197,6 +1480,7 @@ static PyObject *ImageUtils_GenSamplingGrid(PyObject *self, PyObject *args, PyOb
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeProduceRegularGridImage(std::string(pszInputImage), std::string(pszOutputImage),
                                                     std::string(pszGDALFormat), pxlRes, minVal, maxVal, (bool)singleLine);
     }
@@ -1212,20 +1496,22 @@ static PyObject *ImageUtils_GenSamplingGrid(PyObject *self, PyObject *args, PyOb
 
 static PyObject *ImageUtils_GenFiniteMask(PyObject *self, PyObject *args, PyObject *keywds)
 {
-    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"), nullptr};
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *pszInputImage = "";
     const char *pszOutputImage = "";
     const char *pszGDALFormat = "";
+    unsigned int numThreads = 1;
     
-    
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sss:gen_finite_mask", kwlist, &pszInputImage, &pszOutputImage, &pszGDALFormat))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sss|I:gen_finite_mask", kwlist, &pszInputImage, &pszOutputImage, &pszGDALFormat, &numThreads))
     {
         return nullptr;
     }
     
     try
     {
-        rsgis::cmds::executeFiniteImageMask(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszGDALFormat));
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeFiniteImageMask(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszGDALFormat), numThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1239,13 +1525,17 @@ static PyObject *ImageUtils_GenFiniteMask(PyObject *self, PyObject *args, PyObje
 static PyObject *ImageUtils_GenValidMask(PyObject *self, PyObject *args, PyObject *keywds)
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("output_img"),
-                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("no_data_val"), nullptr};
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("no_data_val"),
+                             RSGIS_PY_C_TEXT("combine_mthd"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
     PyObject *pInputImages;
     const char *pszOutputImage = "";
     const char *pszGDALFormat = "";
     float noDataVal = 0.0;
+    int combineMthd = 1; // rsgislib.LOGIC_AND
+    unsigned int numThreads = 1;
     
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Oss|f:gen_valid_mask", kwlist, &pInputImages, &pszOutputImage, &pszGDALFormat, &noDataVal))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Oss|fiI:gen_valid_mask", kwlist, &pInputImages, &pszOutputImage, &pszGDALFormat, &noDataVal,
+                                     &combineMthd, &numThreads))
     {
         return nullptr;
     }
@@ -1279,9 +1569,17 @@ static PyObject *ImageUtils_GenValidMask(PyObject *self, PyObject *args, PyObjec
         return nullptr;
     }
     
+    if((combineMthd != 1) && (combineMthd != 2))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "combine_mthd must be either rsgislib.LOGIC_AND or rsgislib.LOGIC_OR");
+        return nullptr;
+    }
+    bool anyImgValid = (combineMthd == 2); // rsgislib.LOGIC_OR
+    
     try
     {
-        rsgis::cmds::executeValidImageMask(inputImages, std::string(pszOutputImage), std::string(pszGDALFormat), noDataVal);
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeValidImageMask(inputImages, std::string(pszOutputImage), std::string(pszGDALFormat), noDataVal, anyImgValid, numThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1308,6 +1606,7 @@ static PyObject *ImageUtils_GenImageEdgeMask(PyObject *self, PyObject *args, PyO
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageEdgeMask(std::string(pInputImage), std::string(pszOutputImage), std::string(pszGDALFormat), nEdgePixels);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -1322,15 +1621,15 @@ static PyObject *ImageUtils_GenImageEdgeMask(PyObject *self, PyObject *args, PyO
 static PyObject *ImageUtils_CombineImages2Band(PyObject *self, PyObject *args, PyObject *keywds)
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
-                             RSGIS_PY_C_TEXT("datatype"), RSGIS_PY_C_TEXT("no_data_val"), nullptr};
+                             RSGIS_PY_C_TEXT("datatype"), RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
     PyObject *pInputImages;
     const char *pszOutputImage = "";
     const char *pszGDALFormat = "";
     int nDataType;
     float noDataVal = 0.0;
+    unsigned int numThreads = 1;
     
-    
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Ossi|f:combine_imgs_to_band", kwlist, &pInputImages, &pszOutputImage, &pszGDALFormat, &nDataType, &noDataVal))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Ossi|fI:combine_imgs_to_band", kwlist, &pInputImages, &pszOutputImage, &pszGDALFormat, &nDataType, &noDataVal, &numThreads))
     {
         return nullptr;
     }
@@ -1362,7 +1661,8 @@ static PyObject *ImageUtils_CombineImages2Band(PyObject *self, PyObject *args, P
     
     try
     {
-        rsgis::cmds::executeCombineImagesSingleBandIgnoreNoData(inputImages, std::string(pszOutputImage), noDataVal, std::string(pszGDALFormat), type);
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeCombineImagesSingleBandIgnoreNoData(inputImages, std::string(pszOutputImage), noDataVal, std::string(pszGDALFormat), type, numThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1424,6 +1724,7 @@ static PyObject *ImageUtils_PerformRandomPxlSample(PyObject *self, PyObject *arg
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executePerformRandomPxlSample(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszGDALFormat), maskVals, numSamples);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -1439,15 +1740,17 @@ static PyObject *ImageUtils_PerformRandomPxlSampleSmallPxlCount(PyObject *self,
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"),
                              RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("mask_vals"),
-                             RSGIS_PY_C_TEXT("n_samples"), RSGIS_PY_C_TEXT("rnd_seed"), nullptr};
+                             RSGIS_PY_C_TEXT("n_samples"), RSGIS_PY_C_TEXT("rnd_seed"),
+                             RSGIS_PY_C_TEXT("use_row_counts"), nullptr};
     const char *pszInputImage = "";
     const char *pszOutputImage = "";
     const char *pszGDALFormat = "";
     PyObject *maskValsObj;
     unsigned int numSamples = 0;
     int rndSeed = 0;
+    int useRowCounts = false;
     
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssOI|i:perform_random_pxl_sample_in_mask_low_pxl_count", kwlist, &pszInputImage, &pszOutputImage, &pszGDALFormat, &maskValsObj, &numSamples, &rndSeed))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssOI|ii:perform_random_pxl_sample_in_mask_low_pxl_count", kwlist, &pszInputImage, &pszOutputImage, &pszGDALFormat, &maskValsObj, &numSamples, &rndSeed, &useRowCounts))
     {
         return nullptr;
     }
@@ -1487,7 +1790,33 @@ static PyObject *ImageUtils_PerformRandomPxlSampleSmallPxlCount(PyObject *self,
     
     try
     {
-        rsgis::cmds::executePerformRandomPxlSampleSmallPxlCount(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszGDALFormat), maskVals, numSamples, rndSeed);
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executePerformRandomPxlSampleSmallPxlCount(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszGDALFormat), maskVals, numSamples, rndSeed, (bool)useRowCounts);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageUtils_CreatePxlIndexSidecar(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("img_band"), nullptr};
+    const char *pszInputImage = "";
+    unsigned int imgBand = 1;
+    
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "s|I:create_pxl_index_sidecar", kwlist, &pszInputImage, &imgBand))
+    {
+        return nullptr;
+    }
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeCreatePxlIndexSidecar(std::string(pszInputImage), imgBand);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1502,15 +1831,17 @@ static PyObject *ImageUtils_PanSharpenHCS(PyObject *self, PyObject *args, PyObje
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"),
                              RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("datatype"),
-                             RSGIS_PY_C_TEXT("win_size"), RSGIS_PY_C_TEXT("use_naive_method"), nullptr};
+                             RSGIS_PY_C_TEXT("win_size"), RSGIS_PY_C_TEXT("use_naive_method"),
+                             RSGIS_PY_C_TEXT("stats_sample_size"), nullptr};
     const char *pszInputImage = "";
     const char *pszOutputImage = "";
     const char *pszGDALFormat = "";
     int nDataType;
     unsigned int winSize = 7;
     int useNaiveMethInt = false;
+    unsigned int statsSampleSize = 0;
     
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssi|Ii:pan_sharpen_hcs", kwlist, &pszInputImage, &pszOutputImage, &pszGDALFormat, &nDataType, &winSize, &useNaiveMethInt))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssi|IiI:pan_sharpen_hcs", kwlist, &pszInputImage, &pszOutputImage, &pszGDALFormat, &nDataType, &winSize, &useNaiveMethInt, &statsSampleSize))
     {
         return nullptr;
     }
@@ -1520,7 +1851,10 @@ static PyObject *ImageUtils_PanSharpenHCS(PyObject *self, PyObject *args, PyObje
     try
     {
         bool useNaiveMeth = (bool)useNaiveMethInt;
-        rsgis::cmds::executePerformHCSPanSharpen(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszGDALFormat), type, winSize, useNaiveMeth);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executePerformHCSPanSharpen(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszGDALFormat), type, winSize, useNaiveMeth, statsSampleSize);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1536,7 +1870,7 @@ static PyObject *ImageUtils_SharpenLowResImageBands(PyObject *self, PyObject *ar
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"),
                              RSGIS_PY_C_TEXT("band_info"), RSGIS_PY_C_TEXT("win_size"),
                              RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("gdalformat"),
-                             RSGIS_PY_C_TEXT("datatype"), nullptr};
+                             RSGIS_PY_C_TEXT("datatype"), RSGIS_PY_C_TEXT("use_running_sums"), nullptr};
     const char *pszInputImage = "";
     const char *pszOutputImage = "";
     PyObject *bandInfoPyObj;
@@ -1544,9 +1878,10 @@ static PyObject *ImageUtils_SharpenLowResImageBands(PyObject *self, PyObject *ar
     int nDataType;
     unsigned int winSize;
     int nodata;
+    int useRunningSums = false;
     
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssOIisi:sharpen_low_res_bands", kwlist, &pszInputImage, &pszOutputImage,
-                                     &bandInfoPyObj, &winSize, &nodata, &pszGDALFormat, &nDataType))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssOIisi|i:sharpen_low_res_bands", kwlist, &pszInputImage, &pszOutputImage,
+                                     &bandInfoPyObj, &winSize, &nodata, &pszGDALFormat, &nDataType, &useRunningSums))
     {
         return nullptr;
     }
@@ -1635,8 +1970,9 @@ static PyObject *ImageUtils_SharpenLowResImageBands(PyObject *self, PyObject *ar
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeSharpenLowResImgBands(std::string(pszInputImage), std::string(pszOutputImage),
-                                                  bandInfo, winSize, nodata, std::string(pszGDALFormat), type);
+                                                  bandInfo, winSize, nodata, std::string(pszGDALFormat), type, (bool)useRunningSums);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1692,6 +2028,7 @@ static PyObject *ImageUtils_CreateRefImageCompositeImg(PyObject *self, PyObject
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCreateRefImgCompsiteImage(inputImages, std::string(pszOutputImage),
                                                       std::string(pszRefImage), std::string(pszGDALFormat),
                                                       type, outNoData);
@@ -1705,87 +2042,239 @@ static PyObject *ImageUtils_CreateRefImageCompositeImg(PyObject *self, PyObject
     Py_RETURN_NONE;
 }
 
-static PyObject *ImageUtils_GenTimeseriesFillCompositeImg(PyObject *self, PyObject *args, PyObject *keywds)
+static PyObject *ImageUtils_CreatePercentileCompositeImg(PyObject *self, PyObject *args, PyObject *keywds)
 {
-    static char *kwlist[] = {RSGIS_PY_C_TEXT("comp_info"), RSGIS_PY_C_TEXT("in_vld_img"),
-                             RSGIS_PY_C_TEXT("out_ref_fill_img"), RSGIS_PY_C_TEXT("out_comp_img"),
-                             RSGIS_PY_C_TEXT("out_comp_ref_img"), RSGIS_PY_C_TEXT("gdalformat"),
-                             RSGIS_PY_C_TEXT("datatype"), nullptr};
-    PyObject *pCompInfo;
-    const char *pszValidMaskImage = "";
-    const char *pszOutRefFillImage = "";
-    const char *pszOutCompImage = "";
-    const char *pszOutCompRefImage = "";
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("output_img"),
+                             RSGIS_PY_C_TEXT("percentile"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("datatype"), RSGIS_PY_C_TEXT("no_data_val"),
+                             RSGIS_PY_C_TEXT("out_no_data"), nullptr};
+    PyObject *pInputImages;
+    const char *pszOutputImage = "";
+    float percentile = 50.0;
     const char *pszGDALFormat = "";
     int nDataType;
-
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Osssssi:gen_timeseries_fill_composite_img", kwlist, &pCompInfo, &pszValidMaskImage,
-                                     &pszOutRefFillImage, &pszOutCompImage, &pszOutCompRefImage, &pszGDALFormat, &nDataType))
+    float noDataVal = 0.0;
+    float outNoData = 0.0;
+    
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Osfsi|ff:create_percentile_composite_img", kwlist, &pInputImages,
+                                     &pszOutputImage, &percentile, &pszGDALFormat, &nDataType, &noDataVal, &outNoData))
     {
         return nullptr;
     }
     
-    if( !PySequence_Check(pCompInfo))
+    rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
+    
+    if( !PySequence_Check(pInputImages))
     {
-        PyErr_SetString(GETSTATE(self)->error, "Composite Info object must be a sequence");
+        PyErr_SetString(GETSTATE(self)->error, "Input images must be a sequence");
         return nullptr;
     }
     
-    Py_ssize_t nImages = PySequence_Size(pCompInfo);
-    std::vector<rsgis::cmds::RSGISCmdCompositeInfo> inCompInfo;
-    inCompInfo.reserve(nImages);
+    Py_ssize_t nImages = PySequence_Size(pInputImages);
+    std::vector<std::string> inputImages;
+    inputImages.reserve(nImages);
     for( Py_ssize_t n = 0; n < nImages; n++ )
     {
-        PyObject *o = PySequence_GetItem(pCompInfo, n);
-        
-        PyObject *pYear = PyObject_GetAttrString(o, "year");
-        if( ( pYear == nullptr ) || ( pYear == Py_None ) || !RSGISPY_CHECK_INT(pYear) )
-        {
-            PyErr_SetString(GETSTATE(self)->error, "could not find int attribute \'year\'" );
-            Py_DECREF(pYear);
-            Py_DECREF(o);
-            return nullptr;
-        }
-        
-        PyObject *pDay = PyObject_GetAttrString(o, "day");
-        if( ( pDay == nullptr ) || ( pDay == Py_None ) || !RSGISPY_CHECK_INT(pDay) )
-        {
-            PyErr_SetString(GETSTATE(self)->error, "could not find int attribute \'day\'" );
-            Py_DECREF(pYear);
-            Py_DECREF(pDay);
-            Py_DECREF(o);
-            return nullptr;
-        }
-        
-        PyObject *pCompImg = PyObject_GetAttrString(o, "compImg");
-        if( ( pCompImg == nullptr ) || ( pCompImg == Py_None ) || !RSGISPY_CHECK_STRING(pCompImg) )
-        {
-            PyErr_SetString(GETSTATE(self)->error, "could not find string attribute \'compImg\'" );
-            Py_DECREF(pYear);
-            Py_DECREF(pDay);
-            Py_DECREF(pCompImg);
-            Py_DECREF(o);
-            return nullptr;
-        }
+        PyObject *o = PySequence_GetItem(pInputImages, n);
         
-        PyObject *pImgRef = PyObject_GetAttrString(o, "imgRef");
-        if( ( pImgRef == nullptr ) || ( pImgRef == Py_None ) || !RSGISPY_CHECK_STRING(pImgRef) )
+        if(!RSGISPY_CHECK_STRING(o))
         {
-            PyErr_SetString(GETSTATE(self)->error, "could not find string attribute \'imgRef\'" );
-            Py_DECREF(pYear);
-            Py_DECREF(pDay);
-            Py_DECREF(pCompImg);
-            Py_DECREF(pImgRef);
+            PyErr_SetString(GETSTATE(self)->error, "Input images must be strings");
             Py_DECREF(o);
             return nullptr;
         }
         
-        PyObject *pOutRef = PyObject_GetAttrString(o, "outRef");
-        if( ( pOutRef == nullptr ) || ( pOutRef == Py_None ) || !RSGISPY_CHECK_INT(pOutRef) )
-        {
-            PyErr_SetString(GETSTATE(self)->error, "could not find string attribute \'outRef\'" );
-            Py_DECREF(pYear);
-            Py_DECREF(pDay);
+        inputImages.push_back(RSGISPY_STRING_EXTRACT(o));
+        Py_DECREF(o);
+    }
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeCreatePercentileCompositeImage(inputImages, std::string(pszOutputImage), percentile,
+                                                           noDataVal, outNoData, std::string(pszGDALFormat), type);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageUtils_CreateMedoidCompositeImg(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("output_img"),
+                             RSGIS_PY_C_TEXT("bands"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("datatype"), RSGIS_PY_C_TEXT("no_data_val"),
+                             RSGIS_PY_C_TEXT("out_no_data"), nullptr};
+    PyObject *pInputImages;
+    const char *pszOutputImage = "";
+    PyObject *pBands;
+    const char *pszGDALFormat = "";
+    int nDataType;
+    float noDataVal = 0.0;
+    float outNoData = 0.0;
+    
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "OsOsi|ff:create_medoid_composite_img", kwlist, &pInputImages,
+                                     &pszOutputImage, &pBands, &pszGDALFormat, &nDataType, &noDataVal, &outNoData))
+    {
+        return nullptr;
+    }
+    
+    rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
+    
+    if( !PySequence_Check(pInputImages))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "Input images must be a sequence");
+        return nullptr;
+    }
+    
+    Py_ssize_t nImages = PySequence_Size(pInputImages);
+    std::vector<std::string> inputImages;
+    inputImages.reserve(nImages);
+    for( Py_ssize_t n = 0; n < nImages; n++ )
+    {
+        PyObject *o = PySequence_GetItem(pInputImages, n);
+        
+        if(!RSGISPY_CHECK_STRING(o))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "Input images must be strings");
+            Py_DECREF(o);
+            return nullptr;
+        }
+        
+        inputImages.push_back(RSGISPY_STRING_EXTRACT(o));
+        Py_DECREF(o);
+    }
+    
+    if( !PySequence_Check(pBands))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "Bands must be a sequence");
+        return nullptr;
+    }
+    
+    Py_ssize_t nBands = PySequence_Size(pBands);
+    std::vector<unsigned int> bands;
+    bands.reserve(nBands);
+    for( Py_ssize_t n = 0; n < nBands; n++ )
+    {
+        PyObject *o = PySequence_GetItem(pBands, n);
+        
+        if(!RSGISPY_CHECK_INT(o))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "Bands must be integers");
+            Py_DECREF(o);
+            return nullptr;
+        }
+        
+        long band = RSGISPY_INT_EXTRACT(o);
+        Py_DECREF(o);
+        if(band < 1)
+        {
+            PyErr_SetString(GETSTATE(self)->error, "Bands are numbered from 1");
+            return nullptr;
+        }
+        bands.push_back(band-1);
+    }
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeCreateMedoidCompositeImage(inputImages, std::string(pszOutputImage), bands,
+                                                       noDataVal, outNoData, std::string(pszGDALFormat), type);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageUtils_GenTimeseriesFillCompositeImg(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("comp_info"), RSGIS_PY_C_TEXT("in_vld_img"),
+                             RSGIS_PY_C_TEXT("out_ref_fill_img"), RSGIS_PY_C_TEXT("out_comp_img"),
+                             RSGIS_PY_C_TEXT("out_comp_ref_img"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("datatype"), nullptr};
+    PyObject *pCompInfo;
+    const char *pszValidMaskImage = "";
+    const char *pszOutRefFillImage = "";
+    const char *pszOutCompImage = "";
+    const char *pszOutCompRefImage = "";
+    const char *pszGDALFormat = "";
+    int nDataType;
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Osssssi:gen_timeseries_fill_composite_img", kwlist, &pCompInfo, &pszValidMaskImage,
+                                     &pszOutRefFillImage, &pszOutCompImage, &pszOutCompRefImage, &pszGDALFormat, &nDataType))
+    {
+        return nullptr;
+    }
+    
+    if( !PySequence_Check(pCompInfo))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "Composite Info object must be a sequence");
+        return nullptr;
+    }
+    
+    Py_ssize_t nImages = PySequence_Size(pCompInfo);
+    std::vector<rsgis::cmds::RSGISCmdCompositeInfo> inCompInfo;
+    inCompInfo.reserve(nImages);
+    for( Py_ssize_t n = 0; n < nImages; n++ )
+    {
+        PyObject *o = PySequence_GetItem(pCompInfo, n);
+        
+        PyObject *pYear = PyObject_GetAttrString(o, "year");
+        if( ( pYear == nullptr ) || ( pYear == Py_None ) || !RSGISPY_CHECK_INT(pYear) )
+        {
+            PyErr_SetString(GETSTATE(self)->error, "could not find int attribute \'year\'" );
+            Py_DECREF(pYear);
+            Py_DECREF(o);
+            return nullptr;
+        }
+        
+        PyObject *pDay = PyObject_GetAttrString(o, "day");
+        if( ( pDay == nullptr ) || ( pDay == Py_None ) || !RSGISPY_CHECK_INT(pDay) )
+        {
+            PyErr_SetString(GETSTATE(self)->error, "could not find int attribute \'day\'" );
+            Py_DECREF(pYear);
+            Py_DECREF(pDay);
+            Py_DECREF(o);
+            return nullptr;
+        }
+        
+        PyObject *pCompImg = PyObject_GetAttrString(o, "compImg");
+        if( ( pCompImg == nullptr ) || ( pCompImg == Py_None ) || !RSGISPY_CHECK_STRING(pCompImg) )
+        {
+            PyErr_SetString(GETSTATE(self)->error, "could not find string attribute \'compImg\'" );
+            Py_DECREF(pYear);
+            Py_DECREF(pDay);
+            Py_DECREF(pCompImg);
+            Py_DECREF(o);
+            return nullptr;
+        }
+        
+        PyObject *pImgRef = PyObject_GetAttrString(o, "imgRef");
+        if( ( pImgRef == nullptr ) || ( pImgRef == Py_None ) || !RSGISPY_CHECK_STRING(pImgRef) )
+        {
+            PyErr_SetString(GETSTATE(self)->error, "could not find string attribute \'imgRef\'" );
+            Py_DECREF(pYear);
+            Py_DECREF(pDay);
+            Py_DECREF(pCompImg);
+            Py_DECREF(pImgRef);
+            Py_DECREF(o);
+            return nullptr;
+        }
+        
+        PyObject *pOutRef = PyObject_GetAttrString(o, "outRef");
+        if( ( pOutRef == nullptr ) || ( pOutRef == Py_None ) || !RSGISPY_CHECK_INT(pOutRef) )
+        {
+            PyErr_SetString(GETSTATE(self)->error, "could not find string attribute \'outRef\'" );
+            Py_DECREF(pYear);
+            Py_DECREF(pDay);
             Py_DECREF(pCompImg);
             Py_DECREF(pImgRef);
             Py_DECREF(pOutRef);
@@ -1805,10 +2294,596 @@ static PyObject *ImageUtils_GenTimeseriesFillCompositeImg(PyObject *self, PyObje
     
     try
     {
-        rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
-        rsgis::cmds::executeGenTimeseriesFillCompositeImg(inCompInfo, std::string(pszValidMaskImage),
-                                                          std::string(pszOutRefFillImage), std::string(pszOutCompImage),
-                                                          std::string(pszOutCompRefImage), std::string(pszGDALFormat), type);
+        rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeGenTimeseriesFillCompositeImg(inCompInfo, std::string(pszValidMaskImage),
+                                                              std::string(pszOutRefFillImage), std::string(pszOutCompImage),
+                                                              std::string(pszOutCompRefImage), std::string(pszGDALFormat), type);
+        }
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *ImageUtils_ExportSingleMergedImgBand(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("int_band_ref_img"),
+                             RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("datatype"), nullptr};
+    const char *pInputImg = "";
+    const char *pInputBandRefImg = "";
+    const char *pOutputImg = "";
+    const char *pszGDALFormat = "";
+    int nDataType;
+    
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssssi:export_single_merged_img_band", kwlist, &pInputImg, &pInputBandRefImg, &pOutputImg, &pszGDALFormat, &nDataType))
+    {
+        return nullptr;
+    }
+    
+    try
+    {
+        rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeExportSingleMergedImgBand(std::string(pInputImg), std::string(pInputBandRefImg), std::string(pOutputImg), std::string(pszGDALFormat), type);
+        }
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageUtils_GetGDALImageCreationOpts(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("gdalformat"), nullptr};
+    const char *pGDALFormat = "";
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "s:get_gdal_img_creation_opts", kwlist, &pGDALFormat))
+    {
+        return nullptr;
+    }
+    
+    bool rtn_dict = false;
+    PyObject *out_info_dict = nullptr;
+    try
+    {
+        std::map<std::string, std::string> gdalCreationOpts = rsgis::cmds::executeGetGDALImageCreationOpts(std::string(pGDALFormat));
+        
+        if(gdalCreationOpts.size() > 0)
+        {
+            out_info_dict = PyDict_New();
+            for(auto iterOpts = gdalCreationOpts.begin(); iterOpts != gdalCreationOpts.end(); ++iterOpts)
+            {
+                PyDict_SetItem(out_info_dict, Py_BuildValue("s", (iterOpts->first).c_str()), Py_BuildValue("s", (iterOpts->second).c_str()));
+            }
+            rtn_dict = true;
+        }
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    if(rtn_dict)
+    {
+        return out_info_dict;
+    }
+    else
+    {
+        Py_RETURN_NONE;
+    }
+}
+
+
+
+static PyObject *ImageUtils_UnPackPixelVals(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("img_band"),
+                             RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
+    const char *pInputImage = "";
+    unsigned int pInputImageBand = 1;
+    const char *pszOutputImage = "";
+    const char *pszGDALFormat = "";
+    unsigned int numThreads = 1;
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sIss|I:unpack_pxl_vals", kwlist, &pInputImage, &pInputImageBand, &pszOutputImage, &pszGDALFormat, &numThreads))
+    {
+        return nullptr;
+    }
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeUnpackPxlValues(std::string(pInputImage), pInputImageBand, std::string(pszOutputImage), std::string(pszGDALFormat), numThreads);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+/** Extract a sequence of sequences of nVals non-negative integers (e.g., bit fields) into vals. */
+static bool ExtractUIntTuplesFromSequence(PyObject *pSeq, Py_ssize_t nVals, std::vector<std::vector<unsigned long> > *vals)
+{
+    Py_ssize_t nItems = PySequence_Size(pSeq);
+    for(Py_ssize_t i = 0; i < nItems; ++i)
+    {
+        PyObject *pItem = PySequence_GetItem(pSeq, i);
+        std::vector<unsigned long> itemVals(nVals, 0);
+        bool validItem = PySequence_Check(pItem) && (PySequence_Size(pItem) == nVals);
+        for(Py_ssize_t n = 0; validItem && (n < nVals); ++n)
+        {
+            PyObject *pVal = PySequence_GetItem(pItem, n);
+            if(RSGISPY_CHECK_INT(pVal))
+            {
+                long val = RSGISPY_INT_EXTRACT(pVal);
+                if(val < 0)
+                {
+                    validItem = false;
+                }
+                itemVals[n] = (unsigned long)val;
+            }
+            else
+            {
+                validItem = false;
+            }
+            Py_DECREF(pVal);
+        }
+        Py_DECREF(pItem);
+        if(!validItem)
+        {
+            return false;
+        }
+        vals->push_back(itemVals);
+    }
+    return true;
+}
+
+static PyObject *ImageUtils_DecodeBitFields(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("img_band"),
+                             RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("bit_fields"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
+    const char *pInputImage = "";
+    unsigned int pInputImageBand = 1;
+    const char *pszOutputImage = "";
+    const char *pszGDALFormat = "";
+    PyObject *pBitFields;
+    unsigned int numThreads = 1;
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sIssO|I:decode_bit_fields", kwlist, &pInputImage, &pInputImageBand, &pszOutputImage, &pszGDALFormat, &pBitFields, &numThreads))
+    {
+        return nullptr;
+    }
+
+    std::vector<std::vector<unsigned long> > fieldVals;
+    if((!PySequence_Check(pBitFields)) || (!ExtractUIntTuplesFromSequence(pBitFields, 2, &fieldVals)))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "bit_fields must be a sequence of (offset, width) pairs of non-negative integers");
+        return nullptr;
+    }
+    std::vector<rsgis::cmds::RSGISCmdBitField> bitFields(fieldVals.size());
+    for(size_t i = 0; i < fieldVals.size(); ++i)
+    {
+        bitFields[i].offset = fieldVals[i][0];
+        bitFields[i].width = fieldVals[i][1];
+    }
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeDecodeBitFields(std::string(pInputImage), pInputImageBand, std::string(pszOutputImage), std::string(pszGDALFormat), bitFields, numThreads);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageUtils_GenBitPatternMask(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("img_band"),
+                             RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
+                             RSGIS_PY_C_TEXT("rules"), RSGIS_PY_C_TEXT("no_match_val"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
+    const char *pInputImage = "";
+    unsigned int pInputImageBand = 1;
+    const char *pszOutputImage = "";
+    const char *pszGDALFormat = "";
+    PyObject *pRules;
+    unsigned int noMatchVal = 0;
+    unsigned int numThreads = 1;
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sIssO|II:gen_bit_pattern_mask", kwlist, &pInputImage, &pInputImageBand, &pszOutputImage, &pszGDALFormat, &pRules, &noMatchVal, &numThreads))
+    {
+        return nullptr;
+    }
+
+    std::vector<std::vector<unsigned long> > ruleVals;
+    if((!PySequence_Check(pRules)) || (!ExtractUIntTuplesFromSequence(pRules, 3, &ruleVals)))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "rules must be a sequence of (bit_mask, bit_value, out_val) tuples of non-negative integers");
+        return nullptr;
+    }
+    std::vector<rsgis::cmds::RSGISCmdBitPatternRule> rules(ruleVals.size());
+    for(size_t i = 0; i < ruleVals.size(); ++i)
+    {
+        if((ruleVals[i][0] > 0xFFFFFFFFUL) || (ruleVals[i][1] > 0xFFFFFFFFUL) || (ruleVals[i][2] > 255))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "The bit_mask and bit_value of a rule must be 32 bit values and the out_val must be within the range 0-255");
+            return nullptr;
+        }
+        rules[i].bitMask = ruleVals[i][0];
+        rules[i].bitValue = ruleVals[i][1];
+        rules[i].outVal = ruleVals[i][2];
+    }
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeGenBitPatternMask(std::string(pInputImage), pInputImageBand, std::string(pszOutputImage), std::string(pszGDALFormat), rules, noMatchVal, numThreads);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *ImageUtils_SetCalcImgIOBuffers(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("n_buffers"), nullptr};
+    unsigned int numBuffers = 1;
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "I:set_calc_img_io_buffers", kwlist, &numBuffers))
+    {
+        return nullptr;
+    }
+
+    try
+    {
+        rsgis::cmds::executeSetCalcImageIOBuffers(numBuffers);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageUtils_GetCalcImgIOBuffers(PyObject *self, PyObject *args)
+{
+    unsigned int numBuffers = rsgis::cmds::executeGetCalcImageIOBuffers();
+    return Py_BuildValue("I", numBuffers);
+}
+
+static PyObject *ImageUtils_SetCalcImgExecContext(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("strip_mem_mb"), RSGIS_PY_C_TEXT("gdal_cache_mb"),
+                             RSGIS_PY_C_TEXT("n_threads"), RSGIS_PY_C_TEXT("n_io_buffers"),
+                             RSGIS_PY_C_TEXT("checkpoint_secs"), RSGIS_PY_C_TEXT("clumps_mem_mb"),
+                             RSGIS_PY_C_TEXT("remote_max_requests"), RSGIS_PY_C_TEXT("compress_threads"),
+                             RSGIS_PY_C_TEXT("memory_budget_mb"), RSGIS_PY_C_TEXT("preview_factor"),
+                             RSGIS_PY_C_TEXT("result_cache_dir"), RSGIS_PY_C_TEXT("result_cache_mb"),
+                             RSGIS_PY_C_TEXT("result_cache_hash_contents"), RSGIS_PY_C_TEXT("use_gpu"),
+                             RSGIS_PY_C_TEXT("numa_placement"), nullptr};
+    // Values which are not provided are not changed.
+    rsgis::RSGISExecutionContext context = rsgis::cmds::executeGetCalcImageExecContext();
+    PyObject *pResultCacheDir = nullptr;
+    int resultCacheHashContents = context.resultCacheHashContents;
+    int useGPU = context.useGPU;
+    int numaPlacement = context.numaPlacement;
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "|IIIIIIIIIIOIiii:set_calc_img_exec_context", kwlist, &context.stripMemoryMB, &context.gdalCacheMB, &context.numThreads, &context.numIOBuffers, &context.checkpointSecs, &context.clumpsMemoryMB, &context.remoteMaxRequests, &context.compressThreads, &context.memoryBudgetMB, &context.previewFactor, &pResultCacheDir, &context.resultCacheMB, &resultCacheHashContents, &useGPU, &numaPlacement))
+    {
+        return nullptr;
+    }
+    context.resultCacheHashContents = resultCacheHashContents;
+    context.useGPU = useGPU;
+    context.numaPlacement = numaPlacement;
+
+    // None (or an empty path) disables the result cache.
+    if(pResultCacheDir == Py_None)
+    {
+        context.resultCacheDir = "";
+    }
+    else if(pResultCacheDir != nullptr)
+    {
+        if(!RSGISPY_CHECK_STRING(pResultCacheDir))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "The result cache directory must be a string or None.");
+            return nullptr;
+        }
+        context.resultCacheDir = RSGISPY_STRING_EXTRACT(pResultCacheDir);
+    }
+
+    try
+    {
+        rsgis::cmds::executeSetCalcImageExecContext(context);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageUtils_GetCalcImgExecContext(PyObject *self, PyObject *args)
+{
+    rsgis::RSGISExecutionContext context = rsgis::cmds::executeGetCalcImageExecContext();
+    return Py_BuildValue("{s:I,s:I,s:I,s:I,s:I,s:I,s:I,s:I,s:I,s:I,s:s,s:I,s:O,s:O,s:O}", "strip_mem_mb", context.stripMemoryMB, "gdal_cache_mb", context.gdalCacheMB,
+                         "n_threads", context.numThreads, "n_io_buffers", context.numIOBuffers, "checkpoint_secs", context.checkpointSecs,
+                         "clumps_mem_mb", context.clumpsMemoryMB, "remote_max_requests", context.remoteMaxRequests,
+                         "compress_threads", context.compressThreads, "memory_budget_mb", context.memoryBudgetMB,
+                         "preview_factor", context.previewFactor, "result_cache_dir", context.resultCacheDir.c_str(),
+                         "result_cache_mb", context.resultCacheMB, "result_cache_hash_contents", context.resultCacheHashContents?Py_True:Py_False,
+                         "use_gpu", context.useGPU?Py_True:Py_False, "numa_placement", context.numaPlacement?Py_True:Py_False);
+}
+
+static PyObject *ImageUtils_GetGPUDevice(PyObject *self, PyObject *args)
+{
+    std::string deviceName = rsgis::cmds::executeGetGPUDeviceName();
+    if(deviceName == "")
+    {
+        Py_RETURN_NONE;
+    }
+    return Py_BuildValue("s", deviceName.c_str());
+}
+
+// The Python progress callback (see set_progress_reporting), or nullptr if none.
+static PyObject *pImageUtilsProgressCallback = nullptr;
+
+// Called on the thread which owns the progress of a command (see rsgis::RSGISProgress),
+// which may have released the GIL, so the GIL is taken for the call.
+static void ImageUtils_CallProgressCallback(const std::string &label, unsigned long long done, unsigned long long total)
+{
+    PyGILState_STATE gilState = PyGILState_Ensure();
+    if(pImageUtilsProgressCallback != nullptr)
+    {
+        PyObject *pResult = PyObject_CallFunction(pImageUtilsProgressCallback, "sKK", label.c_str(), done, total);
+        if(pResult == nullptr)
+        {
+            // An error in the callback is reported but does not stop the command.
+            PyErr_Print();
+        }
+        else
+        {
+            Py_DECREF(pResult);
+        }
+    }
+    PyGILState_Release(gilState);
+}
+
+static PyObject *ImageUtils_SetProgressReporting(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("enabled"), RSGIS_PY_C_TEXT("show_bar"),
+                             RSGIS_PY_C_TEXT("callback"), RSGIS_PY_C_TEXT("interval_ms"), nullptr};
+    // Values which are not provided are not changed.
+    bool enabledVal = true;
+    bool showBarVal = true;
+    unsigned int intervalMS = 0;
+    rsgis::cmds::executeGetProgressReporting(&enabledVal, &showBarVal, &intervalMS);
+    int enabled = enabledVal;
+    int showBar = showBarVal;
+    PyObject *pCallback = nullptr;
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "|iiOI:set_progress_reporting", kwlist, &enabled, &showBar, &pCallback, &intervalMS))
+    {
+        return nullptr;
+    }
+
+    if((pCallback != nullptr) && (pCallback != Py_None) && !PyCallable_Check(pCallback))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "The progress callback must be callable or None.");
+        return nullptr;
+    }
+
+    try
+    {
+        rsgis::cmds::executeSetProgressReporting(enabled, showBar, intervalMS);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    if(pCallback != nullptr)
+    {
+        Py_XDECREF(pImageUtilsProgressCallback);
+        pImageUtilsProgressCallback = nullptr;
+        if(pCallback == Py_None)
+        {
+            rsgis::cmds::executeSetProgressCallback(rsgis::RSGISProgressCallback());
+        }
+        else
+        {
+            Py_INCREF(pCallback);
+            pImageUtilsProgressCallback = pCallback;
+            rsgis::cmds::executeSetProgressCallback(ImageUtils_CallProgressCallback);
+        }
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageUtils_GetProgressReporting(PyObject *self, PyObject *args)
+{
+    bool enabled = true;
+    bool showBar = true;
+    unsigned int intervalMS = 0;
+    rsgis::cmds::executeGetProgressReporting(&enabled, &showBar, &intervalMS);
+    PyObject *pCallback = (pImageUtilsProgressCallback != nullptr)?pImageUtilsProgressCallback:Py_None;
+    return Py_BuildValue("{s:O,s:O,s:O,s:I}", "enabled", enabled?Py_True:Py_False, "show_bar", showBar?Py_True:Py_False,
+                         "callback", pCallback, "interval_ms", intervalMS);
+}
+
+static PyObject *ImageUtils_EstimateCmdResources(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("strategy"),
+                             RSGIS_PY_C_TEXT("n_out_bands"), RSGIS_PY_C_TEXT("datatype"),
+                             RSGIS_PY_C_TEXT("n_cols"), RSGIS_PY_C_TEXT("bytes_per_clump"), nullptr};
+    PyObject *pInputImages;
+    const char *pszStrategy = "strips";
+    unsigned int numOutBands = 1;
+    int nDataType = rsgis::rsgis_32float;
+    unsigned int numColumns = 1;
+    unsigned int bytesPerClump = 32;
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "O|sIiII:estimate_cmd_resources", kwlist, &pInputImages, &pszStrategy, &numOutBands, &nDataType, &numColumns, &bytesPerClump))
+    {
+        return nullptr;
+    }
+
+    std::vector<std::string> inputImages;
+    if(RSGISPY_CHECK_STRING(pInputImages))
+    {
+        inputImages.push_back(RSGISPY_STRING_EXTRACT(pInputImages));
+    }
+    else if(PySequence_Check(pInputImages))
+    {
+        inputImages = ExtractStringVectorFromSequence(pInputImages);
+        if(PyErr_Occurred())
+        {
+            return nullptr;
+        }
+    }
+    else
+    {
+        PyErr_SetString(GETSTATE(self)->error, "input_imgs must be a string or a sequence of strings");
+        return nullptr;
+    }
+
+    std::string strategyStr = std::string(pszStrategy);
+    rsgis::cmds::RSGISCmdMemoryStrategy strategy = rsgis::cmds::rsgis_mem_strips;
+    if(strategyStr == "strips")
+    {
+        strategy = rsgis::cmds::rsgis_mem_strips;
+    }
+    else if(strategyStr == "columns")
+    {
+        strategy = rsgis::cmds::rsgis_mem_columns;
+    }
+    else if(strategyStr == "bands")
+    {
+        strategy = rsgis::cmds::rsgis_mem_bands;
+    }
+    else if(strategyStr == "clumps")
+    {
+        strategy = rsgis::cmds::rsgis_mem_clumps;
+    }
+    else
+    {
+        PyErr_SetString(GETSTATE(self)->error, "strategy must be one of 'strips', 'columns', 'bands' or 'clumps'");
+        return nullptr;
+    }
+
+    rsgis::cmds::RSGISCmdResourceEstimate estimate;
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        estimate = rsgis::cmds::executeEstimateCmdResources(inputImages, strategy, numOutBands, (rsgis::RSGISLibDataType)nDataType, numColumns, bytesPerClump);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    return Py_BuildValue("{s:d,s:d,s:d,s:O,s:O}", "peak_mem_mb", estimate.peakMemoryMB, "read_mb", estimate.readMB,
+                         "write_mb", estimate.writeMB, "out_of_core", estimate.outOfCore?Py_True:Py_False,
+                         "within_budget", estimate.withinBudget?Py_True:Py_False);
+}
+
+static PyObject *ImageUtils_SetCalcImgProfiling(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("enable"), nullptr};
+    int enable = 1;
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "i:set_calc_img_profiling", kwlist, &enable))
+    {
+        return nullptr;
+    }
+
+    rsgis::cmds::executeSetCalcImageProfiling(enable != 0);
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageUtils_GetCalcImgProfile(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("reset"), nullptr};
+    int reset = 0;
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "|i:get_calc_img_profile", kwlist, &reset))
+    {
+        return nullptr;
+    }
+
+    rsgis::RSGISCalcImageProfile profile = rsgis::cmds::executeGetCalcImageProfile(reset != 0);
+    rsgis::RSGISProfilePhaseStats &readStats = profile.phases[rsgis::rsgis_profile_read];
+    rsgis::RSGISProfilePhaseStats &calcStats = profile.phases[rsgis::rsgis_profile_calc];
+    rsgis::RSGISProfilePhaseStats &writeStats = profile.phases[rsgis::rsgis_profile_write];
+    double timePerCallback = 0.0;
+    if(calcStats.callbacks > 0)
+    {
+        timePerCallback = calcStats.time / ((double)calcStats.callbacks);
+    }
+
+    return Py_BuildValue("{s:k,s:d,s:{s:d,s:K,s:K},s:{s:d,s:K,s:K,s:d},s:{s:d,s:K,s:K}}",
+                         "num_runs", profile.numRuns, "wall_time", profile.wallTime,
+                         "read", "time", readStats.time, "blocks", readStats.blocks, "bytes", readStats.bytes,
+                         "calc", "time", calcStats.time, "blocks", calcStats.blocks, "callbacks", calcStats.callbacks, "time_per_callback", timePerCallback,
+                         "write", "time", writeStats.time, "blocks", writeStats.blocks, "bytes", writeStats.bytes);
+}
+
+
+static PyObject *ImageUtils_RelabelClumpsArray(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("clumps_arr"), nullptr};
+    PyObject *clumpsArrObj;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "O:relabel_clumps_array", kwlist, &clumpsArrObj))
+    {
+        return nullptr;
+    }
+    
+    RSGISPyArrayBuffer clumpsBuf;
+    if(!clumpsBuf.getBuffer(clumpsArrObj, 'I', true, GETSTATE(self)->error, "clumps_arr"))
+    {
+        return nullptr;
+    }
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeRelabelClumpsArray((uint32_t*)clumpsBuf.getData(), clumpsBuf.getNumItems());
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1819,27 +2894,74 @@ static PyObject *ImageUtils_GenTimeseriesFillCompositeImg(PyObject *self, PyObje
     Py_RETURN_NONE;
 }
 
-
-static PyObject *ImageUtils_ExportSingleMergedImgBand(PyObject *self, PyObject *args, PyObject *keywds)
+static PyObject *ImageUtils_SampleImgPointsToArray(PyObject *self, PyObject *args, PyObject *keywds)
 {
-    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("int_band_ref_img"),
-                             RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"),
-                             RSGIS_PY_C_TEXT("datatype"), nullptr};
-    const char *pInputImg = "";
-    const char *pInputBandRefImg = "";
-    const char *pOutputImg = "";
-    const char *pszGDALFormat = "";
-    int nDataType;
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("x_coords"), RSGIS_PY_C_TEXT("y_coords"),
+                             RSGIS_PY_C_TEXT("out_vals"), RSGIS_PY_C_TEXT("img_bands"), RSGIS_PY_C_TEXT("interp"),
+                             RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
+    const char *pszInputImage;
+    PyObject *xCoordsObj, *yCoordsObj, *outValsObj;
+    PyObject *imgBandsObj = Py_None;
+    int interp = 0;
+    double noDataVal = 0.0;
+    unsigned int numThreads = 1;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sOOO|OidI:sample_img_points_to_array", kwlist, &pszInputImage, &xCoordsObj, &yCoordsObj, &outValsObj, &imgBandsObj, &interp, &noDataVal, &numThreads))
+    {
+        return nullptr;
+    }
     
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssssi:export_single_merged_img_band", kwlist, &pInputImg, &pInputBandRefImg, &pOutputImg, &pszGDALFormat, &nDataType))
+    RSGISPyArrayBuffer xCoordsBuf;
+    if(!xCoordsBuf.getBuffer(xCoordsObj, 'd', false, GETSTATE(self)->error, "x_coords"))
+    {
+        return nullptr;
+    }
+    RSGISPyArrayBuffer yCoordsBuf;
+    if(!yCoordsBuf.getBuffer(yCoordsObj, 'd', false, GETSTATE(self)->error, "y_coords"))
+    {
+        return nullptr;
+    }
+    RSGISPyArrayBuffer outValsBuf;
+    if(!outValsBuf.getBuffer(outValsObj, 'd', true, GETSTATE(self)->error, "out_vals"))
+    {
+        return nullptr;
+    }
+    if(xCoordsBuf.getNumItems() != yCoordsBuf.getNumItems())
     {
+        PyErr_SetString(GETSTATE(self)->error, "'x_coords' and 'y_coords' need to be the same length.");
         return nullptr;
     }
     
+    std::vector<unsigned int> bands;
+    if(imgBandsObj != Py_None)
+    {
+        if(!PySequence_Check(imgBandsObj))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "'img_bands' needs to be a sequence of integers.");
+            return nullptr;
+        }
+        Py_ssize_t nBands = PySequence_Size(imgBandsObj);
+        for(Py_ssize_t i = 0; i < nBands; ++i)
+        {
+            PyObject *bandObj = PySequence_GetItem(imgBandsObj, i);
+            if(!RSGISPY_CHECK_INT(bandObj))
+            {
+                Py_DECREF(bandObj);
+                PyErr_SetString(GETSTATE(self)->error, "'img_bands' needs to be a sequence of integers.");
+                return nullptr;
+            }
+            bands.push_back(RSGISPY_UINT_EXTRACT(bandObj));
+            Py_DECREF(bandObj);
+        }
+    }
+    
+    size_t numPts = xCoordsBuf.getNumItems();
+    double *xCoords = (double*)xCoordsBuf.getData();
+    double *yCoords = (double*)yCoordsBuf.getData();
+    std::vector<double> outVals;
     try
     {
-        rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
-        rsgis::cmds::executeExportSingleMergedImgBand(std::string(pInputImg), std::string(pInputBandRefImg), std::string(pOutputImg), std::string(pszGDALFormat), type);
+        RSGISPyReleaseGIL releaseGIL;
+        outVals = rsgis::cmds::executeSampleImagePoints(std::string(pszInputImage), std::vector<double>(xCoords, xCoords + numPts), std::vector<double>(yCoords, yCoords + numPts), bands, interp, noDataVal, numThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1847,34 +2969,44 @@ static PyObject *ImageUtils_ExportSingleMergedImgBand(PyObject *self, PyObject *
         return nullptr;
     }
     
+    if(outVals.size() != outValsBuf.getNumItems())
+    {
+        PyErr_SetString(GETSTATE(self)->error, "'out_vals' needs to have a value for each point and band.");
+        return nullptr;
+    }
+    std::copy(outVals.begin(), outVals.end(), (double*)outValsBuf.getData());
+    
     Py_RETURN_NONE;
 }
 
-static PyObject *ImageUtils_GetGDALImageCreationOpts(PyObject *self, PyObject *args, PyObject *keywds)
+static PyObject *ImageUtils_CalcDistToNearestFeature(PyObject *self, PyObject *args, PyObject *keywds)
 {
-    static char *kwlist[] = {RSGIS_PY_C_TEXT("gdalformat"), nullptr};
-    const char *pGDALFormat = "";
-
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "s:get_gdal_img_creation_opts", kwlist, &pGDALFormat))
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("out_dist_img"), RSGIS_PY_C_TEXT("out_label_img"),
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("img_band"), RSGIS_PY_C_TEXT("max_dist"),
+                             RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("use_geo_units"), nullptr};
+    const char *pszInputImage, *pszOutDistImage;
+    const char *pszOutLabelImage = nullptr;
+    const char *pszGDALFormat = "KEA";
+    unsigned int imgBand = 1;
+    double maxDist = 0;
+    float noDataVal = -1;
+    int useGeoUnits = true;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ss|zsIdfi:calc_dist_to_nearest_feature", kwlist, &pszInputImage, &pszOutDistImage,
+                                     &pszOutLabelImage, &pszGDALFormat, &imgBand, &maxDist, &noDataVal, &useGeoUnits))
     {
         return nullptr;
     }
     
-    bool rtn_dict = false;
-    PyObject *out_info_dict = nullptr;
+    std::string outLabelImage = "";
+    if(pszOutLabelImage != nullptr)
+    {
+        outLabelImage = std::string(pszOutLabelImage);
+    }
+    
     try
     {
-        std::map<std::string, std::string> gdalCreationOpts = rsgis::cmds::executeGetGDALImageCreationOpts(std::string(pGDALFormat));
-        
-        if(gdalCreationOpts.size() > 0)
-        {
-            out_info_dict = PyDict_New();
-            for(auto iterOpts = gdalCreationOpts.begin(); iterOpts != gdalCreationOpts.end(); ++iterOpts)
-            {
-                PyDict_SetItem(out_info_dict, Py_BuildValue("s", (iterOpts->first).c_str()), Py_BuildValue("s", (iterOpts->second).c_str()));
-            }
-            rtn_dict = true;
-        }
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeCalcDistToNearestFeature(std::string(pszInputImage), imgBand, std::string(pszOutDistImage), outLabelImage, std::string(pszGDALFormat), maxDist, noDataVal, useGeoUnits);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -1882,46 +3014,85 @@ static PyObject *ImageUtils_GetGDALImageCreationOpts(PyObject *self, PyObject *a
         return nullptr;
     }
     
-    if(rtn_dict)
+    Py_RETURN_NONE;
+}
+
+static PyObject *ImageUtils_CalcDistToImgClasses(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("out_dist_imgs"), RSGIS_PY_C_TEXT("class_ids"),
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("img_band"), RSGIS_PY_C_TEXT("max_dist"),
+                             RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("use_geo_units"), nullptr};
+    const char *pszInputImage;
+    PyObject *outDistImgsObj;
+    PyObject *classIDsObj = Py_None;
+    const char *pszGDALFormat = "KEA";
+    unsigned int imgBand = 1;
+    double maxDist = 0;
+    float noDataVal = -1;
+    int useGeoUnits = true;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sO|OsIdfi:calc_dist_to_img_classes", kwlist, &pszInputImage, &outDistImgsObj,
+                                     &classIDsObj, &pszGDALFormat, &imgBand, &maxDist, &noDataVal, &useGeoUnits))
     {
-        return out_info_dict;
+        return nullptr;
     }
-    else
+    
+    std::vector<std::string> outDistImages;
+    if(RSGISPY_CHECK_STRING(outDistImgsObj))
     {
-        Py_RETURN_NONE;
+        outDistImages.push_back(RSGISPY_STRING_EXTRACT(outDistImgsObj));
     }
-}
-
-
-
-static PyObject *ImageUtils_UnPackPixelVals(PyObject *self, PyObject *args, PyObject *keywds)
-{
-    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("img_band"),
-                             RSGIS_PY_C_TEXT("output_img"), RSGIS_PY_C_TEXT("gdalformat"), nullptr};
-    const char *pInputImage = "";
-    unsigned int pInputImageBand = 1;
-    const char *pszOutputImage = "";
-    const char *pszGDALFormat = "";
-
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sIss:unpack_pxl_vals", kwlist, &pInputImage, &pInputImageBand, &pszOutputImage, &pszGDALFormat))
+    else if(PySequence_Check(outDistImgsObj))
+    {
+        outDistImages = ExtractStringVectorFromSequence(outDistImgsObj);
+        if(outDistImages.empty())
+        {
+            PyErr_SetString(GETSTATE(self)->error, "'out_dist_imgs' needs to be a string or a sequence of strings.");
+            return nullptr;
+        }
+    }
+    else
     {
+        PyErr_SetString(GETSTATE(self)->error, "'out_dist_imgs' needs to be a string or a sequence of strings.");
         return nullptr;
     }
-
+    
+    std::vector<unsigned long> classIDs;
+    if(classIDsObj != Py_None)
+    {
+        if(!PySequence_Check(classIDsObj))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "'class_ids' needs to be a sequence of integers.");
+            return nullptr;
+        }
+        Py_ssize_t nClasses = PySequence_Size(classIDsObj);
+        for(Py_ssize_t i = 0; i < nClasses; ++i)
+        {
+            PyObject *classObj = PySequence_GetItem(classIDsObj, i);
+            if(!RSGISPY_CHECK_INT(classObj))
+            {
+                Py_DECREF(classObj);
+                PyErr_SetString(GETSTATE(self)->error, "'class_ids' needs to be a sequence of integers.");
+                return nullptr;
+            }
+            classIDs.push_back(PyLong_AsUnsignedLong(classObj));
+            Py_DECREF(classObj);
+        }
+    }
+    
     try
     {
-        rsgis::cmds::executeUnpackPxlValues(std::string(pInputImage), pInputImageBand, std::string(pszOutputImage), std::string(pszGDALFormat));
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeCalcDistToClasses(std::string(pszInputImage), imgBand, classIDs, outDistImages, std::string(pszGDALFormat), maxDist, noDataVal, useGeoUnits);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
         PyErr_SetString(GETSTATE(self)->error, e.what());
         return nullptr;
     }
-
+    
     Py_RETURN_NONE;
 }
 
-
 // Our list of functions in this module
 static PyMethodDef ImageUtilsMethods[] = {
 {"stretch_img", (PyCFunction)ImageUtils_StretchImage, METH_VARARGS | METH_KEYWORDS,
@@ -1939,6 +3110,7 @@ static PyMethodDef ImageUtilsMethods[] = {
 ":param stretch_type: is a STRETCH_* value providing the type of stretch, options are:\n"
 "        * imageutils.STRETCH_LINEARMINMAX - Stretches between min and max.\n"
 "        * imageutils.STRETCH_LINEARPERCENT - Stretches between percentage of image range. Parameter defines percent.\n"
+"        * imageutils.STRETCH_APPROXPERCENT - Stretches between the percent and 100-percent percentiles estimated from a sample (or the overviews) of the image; quicker than the other stretches for quick-looks. Parameter defines percent.\n"
 "        * imageutils.STRETCH_LINEARSTDDEV - Stretches between mean - sd to mean + sd. Parameter defines number of standard deviations.\n"
 "        * imageutils.STRETCH_EXPONENTIAL - Exponential stretch between mean - 2*sd to mean + 2*sd. No parameter.\n"
 "        * imageutils.STRETCH_LOGARITHMIC - Logarithmic stretch between mean - 2*sd to mean + 2*sd. No parameter.\n"
@@ -2008,6 +3180,7 @@ static PyMethodDef ImageUtilsMethods[] = {
 ":param stretch_type: is a STRETCH_* value providing the type of stretch, options are:\n"
 "        * imageutils.STRETCH_LINEARMINMAX - Stretches between min and max.\n"
 "        * imageutils.STRETCH_LINEARPERCENT - Stretches between percentage of image range. Parameter defines percent.\n"
+"        * imageutils.STRETCH_APPROXPERCENT - Stretches between the percent and 100-percent percentiles estimated from a sample (or the overviews) of the image; quicker than the other stretches for quick-looks. Parameter defines percent.\n"
 "        * imageutils.STRETCH_LINEARSTDDEV - Stretches between mean - sd to mean + sd. Parameter defines number of standard deviations.\n"
 "        * imageutils.STRETCH_EXPONENTIAL - Exponential stretch between mean - 2*sd to mean + 2*sd. No parameter.\n"
 "        * imageutils.STRETCH_LOGARITHMIC - Logarithmic stretch between mean - 2*sd to mean + 2*sd. No parameter.\n"
@@ -2034,16 +3207,20 @@ static PyMethodDef ImageUtilsMethods[] = {
 "\n"},
 
 {"mask_img", (PyCFunction)ImageUtils_maskImage, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.mask_img(input_img, in_msk_img, output_img, gdalformat, datatype, out_value, mask_value)\n"
+"rsgislib.imageutils.mask_img(input_img, in_msk_img, output_img, gdalformat, datatype, out_value, mask_value, n_threads)\n"
 "This command will mask an input image using a single band mask image - commonly this is a binary image.\n"
+"Where the mask is 8 or 16 bit unsigned integer and datatype is the data type of the input image, the \n"
+"mask values are looked up in a table and the image is masked without converting the pixel values.\n"
 "\n"
 ":param input_img: is a string containing the name and path of the input image file.\n"
 ":param in_msk_img: is a string containing the name and path of the mask image file.\n"
 ":param output_img: is a string containing the name and path for the output image following application of the mask.\n"
 ":param gdalformat: is a string representing the output image file format (e.g., KEA, ENVI, GTIFF, HFA etc).\n"
 ":param datatype: is a rsgislib.TYPE_* value for the data type of the output image.\n"
-":param out_value: is a float representing the value written to the output image in place of the regions being masked.\n"
+":param out_value: is a float representing the value written to the output image in place of the regions being masked \n"
+"                  or a list of floats with an output value for each of the mask values.\n"
 ":param mask_value: is a float or list of floats representing the value(s) within the mask image for the regions which are to be replaced with the outvalue.\n"
+":param n_threads: is the number of threads used to mask each strip of the image (Default: 1; 0 uses all the available cores).\n"
 "\n"
 ".. code:: python\n"
 "\n"
@@ -2059,7 +3236,7 @@ static PyMethodDef ImageUtilsMethods[] = {
 "\n"},
 
 {"create_tiles", (PyCFunction)ImageUtils_createTiles, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.create_tiles(input_img, out_img_base, tile_width, tile_height, tile_overlap, offset_tiles, gdalformat, datatype, out_img_ext)\n"
+"rsgislib.imageutils.create_tiles(input_img, out_img_base, tile_width, tile_height, tile_overlap, offset_tiles, gdalformat, datatype, out_img_ext, n_threads=1)\n"
 "Create tiles from a larger image, useful for splitting a large image into multiple smaller ones for processing.\n"
 "\n"
 "Where\n"
@@ -2073,6 +3250,7 @@ static PyMethodDef ImageUtilsMethods[] = {
 ":param gdalformat: is a string providing the output gdalformat of the tiles (e.g., KEA).\n"
 ":param datatype: is a rsgislib.TYPE_* value providing the output data type of the tiles.\n"
 ":param out_img_ext: is a string providing the extension for the tiles (as required by the specified data type).\n"
+":param n_threads: is the number of threads used to write the tiles (the input image is read once, in strips, for all the tiles).\n"
 "\n"
 ":return: list of tile file names\n"
 "\n"
@@ -2091,9 +3269,26 @@ static PyMethodDef ImageUtilsMethods[] = {
 "   ext='kea'\n"
 "   tiles = imageutils.create_tiles(inputImage, outBase, width, height, overlap, offsettiling, gdalformat, datatype, ext)\n"
 "\n"},
+
+{"create_tiles_from_masks", (PyCFunction)ImageUtils_createTilesFromMasks, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.create_tiles_from_masks(input_img, in_msk_imgs, output_imgs, gdalformat, datatype, out_value=0, mask_value=0, n_threads=1)\n"
+"Apply a list of tile masks to an image, as mask_img for each mask, but reading the input image once (in strips)\n"
+"for all the tiles rather than once per mask. The masks must have the same size as the input image.\n"
+"\n"
+"Where\n"
+"\n"
+":param input_img: is a string containing the name and path of the input image file.\n"
+":param in_msk_imgs: is a list of the mask image files (the first band is used).\n"
+":param output_imgs: is a list of the output image files, one for each mask.\n"
+":param gdalformat: is a string representing the output image file format (e.g., KEA, ENVI, GTIFF, HFA etc).\n"
+":param datatype: is a rsgislib.TYPE_* value for the data type of the output images.\n"
+":param out_value: is a float representing the value written to the output images in place of the regions being masked.\n"
+":param mask_value: is a float representing the value within the mask images for the regions which are to be replaced with the out_value.\n"
+":param n_threads: is the number of threads used to write the tiles.\n"
+"\n"},
     
 {"create_img_mosaic", (PyCFunction)ImageUtils_createImageMosaic, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.create_img_mosaic(input_imgs, output_img, background_val, skip_val, skip_band, overlap_behaviour, gdalformat, datatype)\n"
+"rsgislib.imageutils.create_img_mosaic(input_imgs, output_img, background_val, skip_val, skip_band, overlap_behaviour, gdalformat, datatype, n_threads=1, out_ref_img=None)\n"
 "Create mosaic from list of input images.\n"
 "\n"
 "Where\n"
@@ -2109,6 +3304,8 @@ static PyMethodDef ImageUtilsMethods[] = {
 "      * 2 - Overwrite if value of new pixel is higher (maximum)\n"
 ":param gdalformat: is a string providing the gdalformat of the output image (e.g., KEA).\n"
 ":param datatype: is a rsgislib.TYPE_* value providing the data type of the output image.\n"
+":param n_threads: is the number of threads used to mosaic the blocks of the output image (Default: 1; 0 uses all the available cores).\n"
+":param out_ref_img: is an optional output KEA image where each pixel is the row of the input image it came from in the 'FileName' column of its attribute table (row 0 is no input). It allows the mosaic to be updated with update_img_mosaic.\n"
 "\n"
 ".. code:: python\n"
 "\n"
@@ -2126,16 +3323,46 @@ static PyMethodDef ImageUtilsMethods[] = {
 "	gdalformat = 'KEA'\n"
 "	datatype = rsgislib.TYPE_32FLOAT\n"
 "	imageutils.create_img_mosaic(inputList, outImage, backgroundVal, skipVal, skipBand, overlapBehaviour, gdalformat, datatype)\n"
+"\n"},
+
+{"update_img_mosaic", (PyCFunction)ImageUtils_updateImageMosaic, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.update_img_mosaic(input_imgs, mosaic_img, ref_img=None, background_val=0, skip_val=0, skip_band=1, overlap_behaviour=0, update_stats=True, update_overviews=True, n_threads=1)\n"
+"Update an existing mosaic with newly arrived images, as though they had been the last\n"
+"images given to create_img_mosaic. Only the blocks of the mosaic covered by the new images\n"
+"are read and written, and the statistics and overviews are updated for the pixels changed\n"
+"rather than recalculated, so the time taken depends on the size of the new images rather\n"
+"than the mosaic. The new images need to be on the same pixel grid as the mosaic; any parts\n"
+"outside of the mosaic are ignored.\n"
+"\n"
+":param input_imgs: is a list of the new input images.\n"
+":param mosaic_img: is a string containing the name of the mosaic to be updated.\n"
+":param ref_img: is the reference image created with the mosaic (out_ref_img), which is updated along with the list of images in its 'FileName' column (optional).\n"
+":param background_val: is the background (nodata) value of the mosaic.\n"
+":param skip_val: is a float providing the value to be skipped (nodata values) in the input images\n"
+":param skip_band: is an integer providing the band to check for skip_val\n"
+":param overlap_behaviour: is an integer specifying the behaviour for overlaping regions\n"
+"      * 0 - Overwrite\n"
+"      * 1 - Overwrite if value of new pixel is lower (minimum)\n"
+"      * 2 - Overwrite if value of new pixel is higher (maximum)\n"
+":param update_stats: update the statistics of the mosaic bands which have statistics (Default: True).\n"
+":param update_overviews: update the overviews of the mosaic (and reference image) within the region changed (Default: True).\n"
+":param n_threads: is the number of threads used to update the blocks of the mosaic (Default: 1; 0 uses all the available cores).\n"
+"\n"
+".. code:: python\n"
+"\n"
+"	from rsgislib import imageutils\n"
+"	imageutils.update_img_mosaic(['./NewScenes/scene_0123.kea'], './mosaic.kea', ref_img='./mosaic_ref.kea', background_val=0, skip_val=0, skip_band=1)\n"
 "\n"},
  
     {"include_imgs", (PyCFunction)ImageUtils_IncludeImages, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.include_imgs(input_img, include_imgs, input_bands=None, skip_val=None)\n"
+"rsgislib.imageutils.include_imgs(input_img, include_imgs, input_bands=None, skip_val=None, n_threads=1)\n"
 "Create mosaic from list of input images.\n"
 "\n"
 ":param input_img: is a string containing the name of the input image to add image to\n"
 ":param include_imgs: is a list of input images\n"
 ":param input_bands: is a subset of input bands to use (optional)\n"
 ":param skip_val: is a float specifying a value which should be ignored and not copied into the new image (optional). To use you must also provided a list of subset image bands.\n"
+":param n_threads: is the number of threads used to include the images (Default: 1; 0 uses all the available cores).\n"
 "\n"
 ".. code:: python\n"
 "\n"
@@ -2190,13 +3417,14 @@ static PyMethodDef ImageUtilsMethods[] = {
 "\n"},
 
 {"pop_img_stats", (PyCFunction)ImageUtils_PopImageStats, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.pop_img_stats(input_img, use_no_data=True, no_data_val=0, calc_pyramids=True)\n"
+"rsgislib.imageutils.pop_img_stats(input_img, use_no_data=True, no_data_val=0, calc_pyramids=True, n_threads=1)\n"
 "Calculate the image statistics and build image pyramids populating the image file.\n"
 "\n"
 ":param input_img: is a string containing the name of the input file\n"
 ":param use_no_data: is a boolean stating whether the no data value is to be used (default=True).\n"
 ":param no_data_val: is a floating point value to be used as the no data value (default=0.0).\n"
 ":param calc_pyramids: is a boolean stating whether image pyramids should be calculated (default=True).\n"
+":param n_threads: is the number of threads used to calculate the statistics and pyramids (Default: 1; 0 uses all the available cores).\n"
 "\n"
 ".. code:: python\n"
 "\n"
@@ -2337,6 +3565,21 @@ static PyMethodDef ImageUtilsMethods[] = {
 "   yMin = 359470.8\n"
 "   yMax = 359500.8\n"
 "   imageutils.subset_bbox(inputImage, outputImage, gdalformat, datatype, xMin, xMax, yMin, yMax)\n"
+"\n"},
+
+{"subset_bboxs", (PyCFunction)ImageUtils_SubsetBBoxes, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.subset_bboxs(input_img, bboxs, output_imgs, gdalformat, datatype, n_threads=1)\n"
+"Subset an image to a list of bounding boxes, creating an output image for each. Rather than\n"
+"subsetting each bounding box in turn (as subset_bbox) the input image is read once, in strips,\n"
+"with the subsets written in parallel, so is much faster for many small subsets (e.g., chips).\n"
+"\n"
+":param input_img: is a string providing the name of the input file.\n"
+":param bboxs: is a list of bounding boxes (min_x, max_x, min_y, max_y).\n"
+":param output_imgs: is a list of the output images, one for each bounding box.\n"
+":param gdalformat: is a string providing the gdalformat of the output images (e.g., KEA).\n"
+":param datatype: is a rsgislib.TYPE_* value providing the data type of the output images.\n"
+":param n_threads: is the number of threads used to write the output images.\n"
+":return: list of the output images created (bounding boxes not overlapping the image are skipped).\n"
 "\n"},
 
     {"subset_to_img", (PyCFunction)ImageUtils_Subset2Img, METH_VARARGS | METH_KEYWORDS,
@@ -2363,8 +3606,10 @@ static PyMethodDef ImageUtilsMethods[] = {
     
     
 {"stack_img_bands", (PyCFunction)ImageUtils_StackImageBands, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.stack_img_bands(input_imgs, band_names, output_img, skip_value, no_data_val, gdalformat, datatype)\n"
+"rsgislib.imageutils.stack_img_bands(input_imgs, band_names, output_img, skip_value, no_data_val, gdalformat, datatype, n_threads=1)\n"
 "Create a single image from list of input images through band stacking.\n"
+"If gdalformat is 'VRT' then the output is a virtual stack which references the bands of the input\n"
+"images (keeping the band names and no data values) rather than copying them, useful for transient stacks.\n"
 "\n"
 ":param input_imgs: is a list of input images.\n"
 ":param band_names: is a list of band names (one for each input image). If None then ignored.\n"
@@ -2373,6 +3618,7 @@ static PyMethodDef ImageUtilsMethods[] = {
 ":param no_data_val: is float specifying a no data value.\n"
 ":param gdalformat: is a string providing the gdalformat of the output image (e.g., KEA).\n"
 ":param datatype: is a rsgislib.TYPE_* value providing the data type of the output image.\n"
+":param n_threads: is the number of threads used to read the input images when the bands are copied (i.e., skip_value is None and the output is not a VRT).\n"
 "\n"
 ".. code:: python\n"
 "\n"
@@ -2468,12 +3714,21 @@ static PyMethodDef ImageUtilsMethods[] = {
 "\n"},
 
 {"order_img_using_prop_valid_pxls", (PyCFunction)ImageUtils_OrderImagesUsingPropValidData, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.order_img_using_prop_valid_pxls(input_imgs, no_data_val)\n"
+"rsgislib.imageutils.order_img_using_prop_valid_pxls(input_imgs, no_data_val, est_mode=rsgislib.VLD_PXL_EST_FULL, err_tol=0.01, n_threads=1)\n"
 "Order the list of input images based on the their proportion of valid image pixels.\n"
 "The primary use of this function is expected to be order (rank) images ahead of mosaicing.\n"
+"Rather than counting every pixel, the proportion can be estimated from an image overview\n"
+"(the smallest overview with enough pixels for err_tol) or from a regularly strided sample of\n"
+"image blocks, which is much quicker for large sets of images.\n"
 "\n"
 ":param input_imgs: is a list of string containing the name and path for the input images.\n"
 ":param no_data_val: is a float which specifies the no data value used to defined \'invalid\' pixels.\n"
+":param est_mode: is the method used to find the proportion of valid pixels: rsgislib.VLD_PXL_EST_FULL (count\n"
+"                 all the pixels), rsgislib.VLD_PXL_EST_OVERVIEW (use an overview, falling back to the block\n"
+"                 sample if there is not a large enough overview) or rsgislib.VLD_PXL_EST_SAMPLE (a sample of blocks).\n"
+":param err_tol: is the maximum error (at 95% confidence) in the estimated proportion of valid pixels (Default: 0.01).\n"
+"                Not used with rsgislib.VLD_PXL_EST_FULL.\n"
+":param n_threads: is the number of images evaluated in parallel (Default: 1; 0 uses all the available cores).\n"
 "\n"
 ":return: a list of images ordered, from low to high (i.e., the first image will be the image with the smallest number of valid image pixels).\n"
 "\n"},
@@ -2492,12 +3747,13 @@ static PyMethodDef ImageUtilsMethods[] = {
 "\n"},
 
 {"gen_finite_mask", (PyCFunction)ImageUtils_GenFiniteMask, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.gen_finite_mask(input_img=string, output_img=string, gdalformat=string)\n"
+"rsgislib.imageutils.gen_finite_mask(input_img=string, output_img=string, gdalformat=string, n_threads=int)\n"
 "Generate a binary image mask defining the finite image regions.\n"
 "\n"
 ":param input_img: is a string containing the name of the input file\n"
 ":param output_img: is a string containing the name of the output file.\n"
 ":param gdalformat: is a string with the GDAL output file format.\n"
+":param n_threads: is the number of threads used to process each image strip (Default: 1; 0 uses all the available cores).\n"
 "\n"
 "\n.. code:: python\n"
 "\n"
@@ -2508,13 +3764,18 @@ static PyMethodDef ImageUtilsMethods[] = {
 "\n"},
     
 {"gen_valid_mask", (PyCFunction)ImageUtils_GenValidMask, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.gen_valid_mask(input_imgs=string|list, output_img=string, gdalformat=string, no_data_val=float)\n"
-"Generate a binary image mask defining the regions which are not 'no data'.\n"
+"rsgislib.imageutils.gen_valid_mask(input_imgs=string|list, output_img=string, gdalformat=string, no_data_val=float, combine_mthd=rsgislib.LOGIC_AND, n_threads=int)\n"
+"Generate a binary image mask defining the regions which are not 'no data'. A pixel of an\n"
+"image is valid if none of its bands are 'no data'. The masks are held as packed bits so\n"
+"large stacks of images can be processed efficiently.\n"
 "\n"
 ":param input_imgs: can be either a string or a list containing the input file(s)\n"
 ":param output_img: is a string containing the name of the output file.\n"
 ":param gdalformat: is a string with the GDAL output file format.\n"
 ":param no_data_val: is a float defining the no data value (Optional and default is 0.0)\n"
+":param combine_mthd: is the method used to combine the masks of the input images: rsgislib.LOGIC_AND (Default;\n"
+"                     valid in all the images) or rsgislib.LOGIC_OR (valid in any of the images).\n"
+":param n_threads: is the number of threads used to process each image strip (Default: 1; 0 uses all the available cores).\n"
 "\n"
 "\n.. code:: python\n"
 "\n"
@@ -2538,7 +3799,7 @@ static PyMethodDef ImageUtilsMethods[] = {
 
    
 {"combine_imgs_to_band", (PyCFunction)ImageUtils_CombineImages2Band, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.combine_imgs_to_band(input_imgs=list, output_img=string, gdalformat=string, datatype=int, no_data_val=float)\n"
+"rsgislib.imageutils.combine_imgs_to_band(input_imgs=list, output_img=string, gdalformat=string, datatype=int, no_data_val=float, n_threads=int)\n"
 "Combine images together into a single image band by excluding the no data value.\n"
 "\n"
 ":param input_imgs: is a list of strings containing the names and paths of the input image files\n"
@@ -2546,6 +3807,7 @@ static PyMethodDef ImageUtilsMethods[] = {
 ":param gdalformat: is a string with the GDAL output file format.\n"
 ":param datatype: is an containing one of the values from rsgislib.TYPE_*\n"
 ":param no_data_val: is the no data value which will be ignored (Default is 0)\n"
+":param n_threads: is the number of threads used to process each image strip (Default: 1; 0 uses all the available cores).\n"
 "\n"
 "\n.. code:: python\n"
 "\n"
@@ -2569,7 +3831,7 @@ static PyMethodDef ImageUtilsMethods[] = {
 "\n"},
     
 {"perform_random_pxl_sample_in_mask_low_pxl_count", (PyCFunction)ImageUtils_PerformRandomPxlSampleSmallPxlCount, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.perform_random_pxl_sample_in_mask_low_pxl_count(input_img=string, output_img=string, gdalformat=string, mask_vals=int|list, n_samples=unsigned int, rnd_seed=int)\n"
+"rsgislib.imageutils.perform_random_pxl_sample_in_mask_low_pxl_count(input_img=string, output_img=string, gdalformat=string, mask_vals=int|list, n_samples=unsigned int, rnd_seed=int, use_row_counts=bool)\n"
 "Randomly sample with a mask (e.g., classification). The same number of samples will be identified within each mask value listed by maskvals.\n"
 "This function produces a similar result to rsgislib.imageutils.perform_random_pxl_sample_in_mask but is more efficient for classes where only a small number of\n"
 "pixels have that value. However, this function uses much more memory.\n"
@@ -2580,10 +3842,27 @@ static PyMethodDef ImageUtilsMethods[] = {
 ":param mask_vals: can either be a single integer value or a list of values. If a list of values is specified then the total number of points identified (numSamples x n-maskVals).\n"
 ":param n_samples: is the number of samples to be created within each region.\n"
 ":param rnd_seed: is a an integer providing a seed for the random number generator. Please not that if this number is the same then the same random set of points will be generated.\n"
+":param use_row_counts: is a boolean specifying that, rather than an index of the pixel locations of each mask value (see \n"
+"                       rsgislib.imageutils.create_pxl_index_sidecar), only the number of pixels of each mask value within each row \n"
+"                       are counted and the rows containing samples are read again. This uses much less memory for large classes \n"
+"                       and selects the same pixels. (Default = False)\n"
+"\n"},
+    
+{"create_pxl_index_sidecar", (PyCFunction)ImageUtils_CreatePxlIndexSidecar, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.create_pxl_index_sidecar(input_img=string, img_band=unsigned int)\n"
+"Save an index of the pixel locations of each value within an image band (e.g., a classification)\n"
+"as a sidecar file (input_img.b[img_band].pxlidx) alongside the image. While the image is unchanged\n"
+"the index is used, in place of reading the whole image, by\n"
+"rsgislib.imageutils.perform_random_pxl_sample_in_mask_low_pxl_count and the accuracy point\n"
+"generation functions which use the pixel lists (rsgislib.classification.generate_stratified_random_accuracy_pts\n"
+"with use_pxl_lst=True and rsgislib.classification.generate_stratified_prop_random_accuracy_pts).\n"
+"\n"
+":param input_img: is a string for the input image (e.g., classification).\n"
+":param img_band: is the image band (starting at 1) to be indexed (Default: 1).\n"
 "\n"},
     
 {"pan_sharpen_hcs", (PyCFunction)ImageUtils_PanSharpenHCS, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.pan_sharpen_hcs(input_img=string, output_img=string, gdalformat=string, datatype=int, win_size=unsigned int, use_naive_method=boolean)\n"
+"rsgislib.imageutils.pan_sharpen_hcs(input_img=string, output_img=string, gdalformat=string, datatype=int, win_size=unsigned int, use_naive_method=boolean, stats_sample_size=unsigned int)\n"
 "A function which performs a Hyperspherical Colour Space (HSC) Pan Sharpening of an input image.\n"
 "Padwick, C., Deskevich, M., Pacifici, F., Smallwood, S. 2010. WorldView-2 Pan-Sharpening.\n"
 "ASPRS 2010 Annual Conference, San Diego, California (2010) pp. 26-30.\n"
@@ -2594,6 +3873,7 @@ static PyMethodDef ImageUtilsMethods[] = {
 ":param datatype: is an containing one of the values from rsgislib.TYPE_*\n"
 ":param win_size: is an optional integer, which must be an odd number, specifying the window size used for the analysis (Default = 7; Only used if useNaiveMethod=False).\n"
 ":param use_naive_method: is an optional boolean option to specify whether the naive or smart method should be used - False=Smart (Default), True=Naive Method.\n"
+":param stats_sample_size: is an optional integer which, if > 0, calculates the image statistics from the image down-sampled to at most this number of pixels along its longest side (using the image overviews if available) rather than from every pixel (Default = 0).\n"
 "\n"
 "\n.. code:: python\n"
 "\n"
@@ -2613,7 +3893,7 @@ static PyMethodDef ImageUtilsMethods[] = {
 "\n"},
     
 {"sharpen_low_res_bands", (PyCFunction)ImageUtils_SharpenLowResImageBands, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.sharpen_low_res_bands(input_img=string, output_img=string, band_info=list, win_size=unsigned int, no_data_val=int, gdalformat=string, datatype=int)\n"
+"rsgislib.imageutils.sharpen_low_res_bands(input_img=string, output_img=string, band_info=list, win_size=unsigned int, no_data_val=int, gdalformat=string, datatype=int, use_running_sums=False)\n"
 "A function which performs band sharpening using local linear fitting (orignal method proposed by Shepherd and Dymond).\n"
 "\n"
 ":param input_img: is a string for the input file where the high resolution input image bands have been resampled \n"
@@ -2628,6 +3908,9 @@ static PyMethodDef ImageUtilsMethods[] = {
 ":param no_data_val: is an integer specifying the no data value for the scene\n"
 ":param gdalformat: is a string with the GDAL output file format.\n"
 ":param datatype: is an containing one of the values from rsgislib.TYPE_*\n"
+":param use_running_sums: is a boolean specifying that the sums of the local linear fits are updated as the \n"
+"          window moves rather than recalculated for each pixel, which is much faster for large windows \n"
+"          (the results can differ very slightly due to the floating point rounding). (Default = False)\n"
 "\n"
 "\n.. code:: python\n"
 "\n"
@@ -2701,6 +3984,57 @@ static PyMethodDef ImageUtilsMethods[] = {
 "    rsgislib.imageutils.pop_img_stats(outCompImg, usenodataval=True, nodataval=0, calcpyramids=True)\n"
 "\n"
 "\n"},
+
+{"create_percentile_composite_img", (PyCFunction)ImageUtils_CreatePercentileCompositeImg, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.create_percentile_composite_img(input_imgs=list, output_img=string, percentile=float, gdalformat=string, datatype=int, no_data_val=float, out_no_data=float)\n"
+"A function which creates a composite image where each output pixel value is the percentile of the\n"
+"valid values for that pixel across the input images, calculated independently for each band. A\n"
+"percentile of 50 creates a median composite. Percentiles between observations are linearly interpolated.\n"
+"\n"
+":param input_imgs: is a list of input images, each image must have the same number of bands in the same order.\n"
+":param output_img: is a string with the name and path of the output image.\n"
+":param percentile: is the percentile (0 - 100) to be outputted (e.g., 50 for the median).\n"
+":param gdalformat: is a string with the GDAL output file format.\n"
+":param datatype: is an integer containing one of the values from rsgislib.TYPE_*\n"
+":param no_data_val: is the no data value in the input images, these values (and NaNs) are ignored. (Default: 0)\n"
+":param out_no_data: is the value which will be given to pixels with no valid input values. (Default: 0)\n"
+"\n"
+".. code:: python\n"
+"\n"
+"    import rsgislib\n"
+"    import rsgislib.imageutils\n"
+"    import glob\n"
+"\n"
+"    inImages = glob.glob('./Outputs/*stdsref.kea')\n"
+"    rsgislib.imageutils.create_percentile_composite_img(inImages, 'median_comp.kea', 50, 'KEA', rsgislib.TYPE_16UINT)\n"
+"\n"
+"\n"},
+
+{"create_medoid_composite_img", (PyCFunction)ImageUtils_CreateMedoidCompositeImg, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.create_medoid_composite_img(input_imgs=list, output_img=string, bands=list, gdalformat=string, datatype=int, no_data_val=float, out_no_data=float)\n"
+"A function which creates a composite image where, for each pixel, all the bands are outputted from the\n"
+"medoid scene. The medoid is the valid observation with the minimum sum of the Euclidean distances to the\n"
+"other valid observations, using the bands specified, so unlike a per-band median the output pixels retain\n"
+"the spectral relationships of a real observation.\n"
+"\n"
+":param input_imgs: is a list of input images, each image must have the same number of bands in the same order.\n"
+":param output_img: is a string with the name and path of the output image.\n"
+":param bands: is a list of the image bands (numbered from 1) used to calculate the distances between the observations.\n"
+":param gdalformat: is a string with the GDAL output file format.\n"
+":param datatype: is an integer containing one of the values from rsgislib.TYPE_*\n"
+":param no_data_val: is the no data value in the input images, an observation is not used if any of the bands specified are no data (or NaN). (Default: 0)\n"
+":param out_no_data: is the value which will be given to pixels with no valid observation. (Default: 0)\n"
+"\n"
+".. code:: python\n"
+"\n"
+"    import rsgislib\n"
+"    import rsgislib.imageutils\n"
+"    import glob\n"
+"\n"
+"    inImages = glob.glob('./Outputs/*stdsref.kea')\n"
+"    rsgislib.imageutils.create_medoid_composite_img(inImages, 'medoid_comp.kea', [2, 3, 4, 5, 6, 7], 'KEA', rsgislib.TYPE_16UINT)\n"
+"\n"
+"\n"},
     
     
 {"gen_timeseries_fill_composite_img", (PyCFunction)ImageUtils_GenTimeseriesFillCompositeImg, METH_VARARGS | METH_KEYWORDS,
@@ -2747,14 +4081,344 @@ static PyMethodDef ImageUtilsMethods[] = {
 "\n"},
 
 {"unpack_pxl_vals", (PyCFunction)ImageUtils_UnPackPixelVals, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.unpack_pxl_vals(input_img=string, img_band=int, output_img=string, gdalformat=string)\n"
+"rsgislib.imageutils.unpack_pxl_vals(input_img=string, img_band=int, output_img=string, gdalformat=string, n_threads=int)\n"
 "This function unpacks the image pixel values in the first band to a multiple band output image (1 band per bit).\n"
 "\n"
 ":param input_img: is a string specifying the input image file.\n"
 ":param img_band: is the image band in the input image to use (index starts at 1).\n"
 ":param output_img: is a string specifying the output image file\n"
 ":param gdalformat: is a string specifying the GDAL image file format for the output file.\n"
+":param n_threads: is the number of threads used to unpack each strip of the image (Default: 1; 0 uses all the available cores).\n"
+"\n"
+"\n"},
+
+{"decode_bit_fields", (PyCFunction)ImageUtils_DecodeBitFields, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.decode_bit_fields(input_img=string, img_band=int, output_img=string, gdalformat=string, bit_fields=list, n_threads=int)\n"
+"This function decodes bit fields from an 8, 16 or 32 bit integer image band (e.g., a QA band) \n"
+"to a multiple band output image (1 band per field). The input band is read once and all the \n"
+"fields are decoded in a single pass. The output image is the smallest unsigned integer data \n"
+"type which can hold the widest field.\n"
+"\n"
+":param input_img: is a string specifying the input image file.\n"
+":param img_band: is the image band in the input image to use (index starts at 1).\n"
+":param output_img: is a string specifying the output image file\n"
+":param gdalformat: is a string specifying the GDAL image file format for the output file.\n"
+":param bit_fields: is a list of (offset, width) tuples, where offset is the first bit of the \n"
+"                   field (0 is the least significant bit) and width is the number of bits.\n"
+":param n_threads: is the number of threads used to decode each strip of the image (Default: 1; 0 uses all the available cores).\n"
+"\n"
+"Example::\n"
+"\n"
+"    import rsgislib.imageutils\n"
+"    # Landsat Collection 2 QA_PIXEL: cloud, cloud shadow and the cloud confidence.\n"
+"    rsgislib.imageutils.decode_bit_fields('LC08_QA_PIXEL.tif', 1, 'qa_fields.kea', 'KEA', [(3, 1), (4, 1), (8, 2)])\n"
+"\n"},
+
+{"gen_bit_pattern_mask", (PyCFunction)ImageUtils_GenBitPatternMask, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.gen_bit_pattern_mask(input_img=string, img_band=int, output_img=string, gdalformat=string, rules=list, no_match_val=int, n_threads=int)\n"
+"This function creates a single band 8 bit mask (e.g., cloud and cloud shadow) from the bits \n"
+"of an 8, 16 or 32 bit integer image band (e.g., a QA band). A pixel matches a rule where \n"
+"(pixel & bit_mask) == bit_value and is given the out_val of the first rule it matches.\n"
+"\n"
+":param input_img: is a string specifying the input image file.\n"
+":param img_band: is the image band in the input image to use (index starts at 1).\n"
+":param output_img: is a string specifying the output image file\n"
+":param gdalformat: is a string specifying the GDAL image file format for the output file.\n"
+":param rules: is a list of (bit_mask, bit_value, out_val) tuples, in order of priority.\n"
+":param no_match_val: is the output value for pixels which do not match any of the rules (Default: 0).\n"
+":param n_threads: is the number of threads used to process each strip of the image (Default: 1; 0 uses all the available cores).\n"
+"\n"
+"Example::\n"
+"\n"
+"    import rsgislib.imageutils\n"
+"    # Landsat Collection 2 QA_PIXEL: 1 = cloud (bit 3), 2 = cloud shadow (bit 4).\n"
+"    rules = [(1 << 3, 1 << 3, 1), (1 << 4, 1 << 4, 2)]\n"
+"    rsgislib.imageutils.gen_bit_pattern_mask('LC08_QA_PIXEL.tif', 1, 'cld_msk.kea', 'KEA', rules)\n"
+"\n"},
+
+{"set_calc_img_io_buffers", (PyCFunction)ImageUtils_SetCalcImgIOBuffers, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.set_calc_img_io_buffers(n_buffers=int)\n"
+"Set the number of image strip buffers used by the image calculation engine when \n"
+"creating an output image. With 2 or more buffers the next strip is read and the \n"
+"previous strip is written on separate I/O threads while the current strip is \n"
+"processed, which is useful when the images are on slow (e.g., network) storage. \n"
+"Each buffer holds a strip of all the input and output bands in memory.\n"
+"\n"
+":param n_buffers: is the number of strip buffers (Default: 1; serial I/O). 3 allows \n"
+"                  reading, processing and writing to fully overlap.\n"
+"\n"
+"\n"},
+
+{"get_calc_img_io_buffers", (PyCFunction)ImageUtils_GetCalcImgIOBuffers, METH_NOARGS,
+"rsgislib.imageutils.get_calc_img_io_buffers()\n"
+"Get the number of image strip buffers used by the image calculation engine \n"
+"(see set_calc_img_io_buffers).\n"
+"\n"
+":returns: the number of buffers as an int.\n"
+"\n"
+"\n"},
+
+{"set_calc_img_exec_context", (PyCFunction)ImageUtils_SetCalcImgExecContext, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.set_calc_img_exec_context(strip_mem_mb=int, gdal_cache_mb=int, n_threads=int, n_io_buffers=int, checkpoint_secs=int, clumps_mem_mb=int, remote_max_requests=int, compress_threads=int, memory_budget_mb=int, preview_factor=int, result_cache_dir=str, result_cache_mb=int, result_cache_hash_contents=bool, use_gpu=bool, numa_placement=bool)\n"
+"Set the resources used by the image calculation engine for the functions called \n"
+"afterwards, allowing memory to be traded for throughput. Parameters which are not \n"
+"provided are not changed.\n"
+"\n"
+":param strip_mem_mb: is the target memory (MB) of the buffers for each image strip. \n"
+"                     The strips are then a multiple of the image block height, \n"
+"                     rather than a single block. 0 (the default) uses strips of \n"
+"                     the image block height.\n"
+":param gdal_cache_mb: is the size (MB) of the GDAL block cache (0 leaves the GDAL default).\n"
+":param n_threads: is the number of threads used to process each strip, where not \n"
+"                  specified by the function called (Default: 1).\n"
+":param n_io_buffers: is the number of image strip buffers (see set_calc_img_io_buffers).\n"
+":param checkpoint_secs: is the interval (seconds) between checkpoints of the output images \n"
+"                        of per-pixel calculations (e.g., band maths). The rows written are \n"
+"                        recorded in a sidecar file (output image + '.rsgischkpt') so if \n"
+"                        the output is created again from the same inputs (e.g., after the \n"
+"                        job was stopped) it resumes from the last checkpoint. The sidecar \n"
+"                        file is removed once the image is complete. 0 (the default) is \n"
+"                        no checkpoints.\n"
+":param clumps_mem_mb: is the maximum memory (MB) of the clumps image held in memory by \n"
+"                      the segmentation functions which eliminate or merge clumps \n"
+"                      (e.g., rsgislib.segmentation.rm_small_clumps_stepwise). Larger \n"
+"                      clumps images are held in a memory-mapped temporary file \n"
+"                      alongside the clumps image, so the operating system pages them \n"
+"                      to and from disk. 0 (the default) always holds them in memory.\n"
+":param remote_max_requests: is the maximum number of concurrent requests used to read each \n"
+"                            strip of an input image on a GDAL network file system (e.g., \n"
+"                            /vsis3/ or /vsigs/ cloud optimised GeoTIFFs). Each strip is split \n"
+"                            into windows aligned to the image tiles, which are read in \n"
+"                            parallel, and the next strip is fetched while the current strip \n"
+"                            is processed. 0 reads remote images in the same way as local \n"
+"                            images (Default: 4).\n"
+":param compress_threads: is the number of threads used by GDAL to compress the blocks of \n"
+"                         GTiff and COG outputs (the NUM_THREADS creation option, unless \n"
+"                         set in RSGISLIB_IMG_CRT_OPTS_GTIFF or RSGISLIB_IMG_CRT_OPTS_COG), \n"
+"                         sized independently of n_threads. 0 uses all available cores \n"
+"                         and 1 compresses on the writing thread (Default: 1). The KEA \n"
+"                         driver does not support multi-threaded compression.\n"
+":param memory_budget_mb: is the memory budget (MB) of each command (see estimate_cmd_resources). \n"
+"                         Where clumps_mem_mb is 0 the clumps arrays larger than the budget \n"
+"                         are held in memory-mapped temporary files (see clumps_mem_mb). \n"
+"                         0 (the default) is no budget.\n"
+":param preview_factor: is the decimation factor of a preview of the per-pixel calculations \n"
+"                       (e.g., band maths), for tuning parameters such as thresholds without \n"
+"                       processing the inputs at full resolution. The outputs are then \n"
+"                       preview_factor times coarser than the inputs, with a matching \n"
+"                       geotransform, and each output pixel is calculated from the input \n"
+"                       pixel at the centre of the block of input pixels it covers. Where \n"
+"                       the inputs have overviews GDAL reads the overview closest to the \n"
+"                       preview resolution (e.g., 4 reads the 4x overview of a pyramid of \n"
+"                       2x, 4x, 8x, ... overviews). 0 or 1 (the default is 0) is full resolution.\n"
+":param result_cache_dir: is a directory in which the outputs of deterministic commands \n"
+"                         (band_maths, clump and pop_img_stats) are cached, keyed on a hash \n"
+"                         of the command, its parameters and the identity of its input \n"
+"                         files (including sidecar files such as .aux.xml and .ovr). When \n"
+"                         the key matches a cached entry the outputs are copied from the \n"
+"                         cache instead of being recalculated; for commands which edit an \n"
+"                         image in place (i.e., pop_img_stats) the command is skipped if \n"
+"                         the image is unchanged since the command last ran on it. The \n"
+"                         directory can be shared between jobs. None or an empty string \n"
+"                         (the default) disables the cache.\n"
+":param result_cache_mb: is the maximum size of the result cache in megabytes; the least \n"
+"                        recently used entries are removed when it is exceeded. 0 (the default) \n"
+"                        is no limit.\n"
+":param result_cache_hash_contents: if True the input files are identified by a digest of \n"
+"                                   their contents rather than their path, size and \n"
+"                                   modification time, so copies of the same inputs share \n"
+"                                   cache entries and edits within the same second of the \n"
+"                                   previous run are detected, at the cost of reading the \n"
+"                                   inputs. (Default: False)\n"
+":param use_gpu: if True the calculations with a GPU implementation (currently the labelling \n"
+"                of pixels with the nearest cluster centre, e.g., of the KMeans classification) \n"
+"                are offloaded to the OpenCL device (see get_gpu_device), giving the same \n"
+"                results as the CPU. An error is raised if RSGISLib was not built with OpenCL \n"
+"                or there is no device. (Default: False, i.e., the CPU is used)\n"
+":param numa_placement: if True, on machines with more than one NUMA node (e.g., 2-socket \n"
+"                       nodes), the threads of the parallel commands are divided into \n"
+"                       groups pinned to the cores of each node, each group processes \n"
+"                       adjacent parts of each image strip and the strip and per-thread \n"
+"                       buffers are allocated in the memory of the node using them, so \n"
+"                       the threads do not access the memory of the other sockets. Only \n"
+"                       the cores the process is allowed to use are used (e.g., within a \n"
+"                       batch job). It has no effect on machines with one NUMA node or on \n"
+"                       operating systems other than Linux. Use False where several \n"
+"                       processes share the machine. (Default: False)\n"
+"\n"
+"\n"},
+
+{"get_calc_img_exec_context", (PyCFunction)ImageUtils_GetCalcImgExecContext, METH_NOARGS,
+"rsgislib.imageutils.get_calc_img_exec_context()\n"
+"Get the resources used by the image calculation engine (see set_calc_img_exec_context).\n"
+"\n"
+":returns: a dict with the 'strip_mem_mb', 'gdal_cache_mb', 'n_threads', 'n_io_buffers', \n"
+"          'checkpoint_secs', 'clumps_mem_mb', 'remote_max_requests', 'compress_threads', \n"
+"          'memory_budget_mb', 'preview_factor', 'result_cache_dir', 'result_cache_mb', \n"
+"          'result_cache_hash_contents', 'use_gpu' and 'numa_placement'.\n"
+"\n"
+"\n"},
+
+{"set_progress_reporting", (PyCFunction)ImageUtils_SetProgressReporting, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.set_progress_reporting(enabled=bool, show_bar=bool, callback=func, interval_ms=int)\n"
+"Set how the progress of the commands is reported. The worker threads of the parallel \n"
+"engines count their progress with atomic counters and the progress bar is drawn by a \n"
+"separate reporter thread at most every interval_ms, so the reporting does not slow \n"
+"down or garble the output of the parallel commands. Values which are not provided are \n"
+"not changed.\n"
+"\n"
+":param enabled: if False no progress is reported (no progress bars or callbacks), e.g., \n"
+"                for batch runs. The default is True unless the RSGISLIB_PROGRESS \n"
+"                environment variable is 'off'.\n"
+":param show_bar: if False the progress bars are not drawn on the terminal, e.g., where \n"
+"                 the progress is shown with the callback. (Default: True)\n"
+":param callback: a function func(label, n_done, n_total) called with the progress of \n"
+"                 the commands, at most every interval_ms and when each completes, on \n"
+"                 the thread which runs the command. Exceptions raised by the function \n"
+"                 are printed and do not stop the command. None (the default) removes \n"
+"                 the callback.\n"
+":param interval_ms: the interval (milliseconds) between the updates. (Default: 200)\n"
+"\n"
+"Example::\n"
+"\n"
+"    import rsgislib.imageutils\n"
+"\n"
+"    def print_progress(label, n_done, n_total):\n"
+"        print(label, n_done, n_total)\n"
+"\n"
+"    rsgislib.imageutils.set_progress_reporting(show_bar=False, callback=print_progress)\n"
+"\n"
+"\n"},
+
+{"get_progress_reporting", (PyCFunction)ImageUtils_GetProgressReporting, METH_NOARGS,
+"rsgislib.imageutils.get_progress_reporting()\n"
+"Get how the progress of the commands is reported (see set_progress_reporting).\n"
+"\n"
+":returns: a dict with the 'enabled', 'show_bar', 'callback' and 'interval_ms'.\n"
+"\n"
+"\n"},
+
+{"get_gpu_device", (PyCFunction)ImageUtils_GetGPUDevice, METH_NOARGS,
+"rsgislib.imageutils.get_gpu_device()\n"
+"Get the name of the OpenCL device used where use_gpu is True (see set_calc_img_exec_context). \n"
+"The device is the first GPU with double precision, which can be limited to the devices whose \n"
+"name contains the RSGISLIB_OPENCL_DEVICE environment variable.\n"
+"\n"
+":returns: the name of the device or None if RSGISLib was not built with OpenCL (the \n"
+"          RSGIS_OPENCL CMake option) or there is no device.\n"
+"\n"
+"\n"},
+
+{"estimate_cmd_resources", (PyCFunction)ImageUtils_EstimateCmdResources, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.estimate_cmd_resources(input_imgs, strategy='strips', n_out_bands=1, datatype=rsgislib.TYPE_32FLOAT, n_cols=1, bytes_per_clump=32)\n"
+"Estimate the peak memory and the I/O of a command from the metadata of its input images \n"
+"(size, bands, data type, block size and number of clumps) and the current execution \n"
+"context (see set_calc_img_exec_context), without reading the image data. This allows \n"
+"large jobs to be checked against the memory available (e.g., on a shared node) before \n"
+"they are run.\n"
+"\n"
+":param input_imgs: is the input image path or a list of the input image paths.\n"
+":param strategy: is how the command holds its data in memory: 'strips' for the image \n"
+"                 calculation engine commands (e.g., band maths), 'columns' for the \n"
+"                 rastergis commands reading whole attribute table columns (the inputs are \n"
+"                 the clumps images), 'bands' for the commands reading whole image bands \n"
+"                 or 'clumps' for the segmentation commands holding the clumps image and \n"
+"                 per-clump structures (e.g., rsgislib.segmentation.rm_small_clumps_stepwise).\n"
+":param n_out_bands: is the number of output image bands ('strips').\n"
+":param datatype: is the output image data type ('strips').\n"
+":param n_cols: is the number of attribute table columns read ('columns').\n"
+":param bytes_per_clump: is the size (bytes) of the per-clump structures ('clumps').\n"
+":returns: a dict with the 'peak_mem_mb', 'read_mb' and 'write_mb' and the bools \n"
+"          'out_of_core' (whether the clumps array will be memory-mapped as it is larger \n"
+"          than clumps_mem_mb, or memory_budget_mb if that is 0) and 'within_budget' \n"
+"          (whether the peak memory is within the memory_budget_mb).\n"
+"\n"
+"\n"},
+
+{"set_calc_img_profiling", (PyCFunction)ImageUtils_SetCalcImgProfiling, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.set_calc_img_profiling(enable=bool)\n"
+"Enable or disable the profiling of the image calculation engine, which records the \n"
+"time spent reading, processing and writing the image data. While enabled a one line \n"
+"JSON summary of each run of the engine is printed to the console. The profiling is \n"
+"disabled by default.\n"
+"\n"
+":param enable: is a boolean specifying whether the profiling is enabled.\n"
+"\n"
+"\n"},
+
+{"get_calc_img_profile", (PyCFunction)ImageUtils_GetCalcImgProfile, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.get_calc_img_profile(reset=False)\n"
+"Get the totals recorded by the image calculation engine profiling (see \n"
+"set_calc_img_profiling) since it was last reset. When the I/O buffers are used (see \n"
+"set_calc_img_io_buffers) the reading and writing overlap the processing so the phase \n"
+"times can sum to more than the wall time.\n"
+"\n"
+":param reset: is a boolean specifying whether the totals are reset once returned.\n"
+":returns: a dict with the number of runs ('num_runs'), the wall time in seconds \n"
+"          ('wall_time') and a dict for each of the 'read', 'calc' and 'write' phases \n"
+"          with the 'time' (seconds) and number of 'blocks', plus the 'bytes' read or \n"
+"          written or, for 'calc', the number of 'callbacks' (pixels) and the mean \n"
+"          'time_per_callback'.\n"
+"\n"
+"\n"},
+
+{"relabel_clumps_array", (PyCFunction)ImageUtils_RelabelClumpsArray, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.relabel_clumps_array(clumps_arr:numpy.array)\n"
+"Relabels the clumps within an array in memory (e.g., a block read with numpy) in place so \n"
+"they are numbered consecutively from 1, in the order they are first found. Pixels with \n"
+"a value of 0 are not changed. The array is not copied.\n"
+"\n"
+":param clumps_arr: is a C contiguous, writable numpy.uint32 array of clump IDs.\n"
+"\n"
+"\n"},
+
+{"sample_img_points_to_array", (PyCFunction)ImageUtils_SampleImgPointsToArray, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.sample_img_points_to_array(input_img, x_coords, y_coords, out_vals, img_bands=None, interp=rsgislib.INTERP_NEAREST_NEIGHBOUR, no_data_val=0, n_threads=1)\n"
+"Samples the image band values at a set of points into an existing array (see sample_img_points,\n"
+"which creates the array). The points are sorted by the image block they are within so each\n"
+"block touched by a point is read once for all the bands.\n"
+"\n"
+":param input_img: is a string containing the name of the input image file.\n"
+":param x_coords: is a C contiguous numpy.float64 array of the x coordinates of the points (in the image projection).\n"
+":param y_coords: is a C contiguous numpy.float64 array of the y coordinates of the points.\n"
+":param out_vals: is a C contiguous, writable numpy.float64 array with n_points x n_bands values, where the values of each point are a row.\n"
+":param img_bands: is an optional list of the bands (starting at 1) to sample (default None is all the bands).\n"
+":param interp: is the interpolation: rsgislib.INTERP_NEAREST_NEIGHBOUR, rsgislib.INTERP_BILINEAR or rsgislib.INTERP_CUBIC.\n"
+":param no_data_val: is the value of the points outside of the image.\n"
+":param n_threads: is the number of threads used to read and interpolate the blocks (0 uses all the available cores).\n"
+"\n"
+"\n"},
+
+{"calc_dist_to_nearest_feature", (PyCFunction)ImageUtils_CalcDistToNearestFeature, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.calc_dist_to_nearest_feature(input_img, out_dist_img, out_label_img=None, gdalformat='KEA', img_band=1, max_dist=0, no_data_val=-1, use_geo_units=True)\n"
+"Calculates the (exact Euclidean) distance from each pixel to the nearest non-zero (feature) pixel of the\n"
+"image band and, optionally, the value of that pixel (i.e., a Voronoi allocation of the features). The\n"
+"distance transform is separable (Felzenszwalb and Huttenlocher, 2012) so its run time is linear in the\n"
+"number of pixels. The distances are between the pixel centres, as gdal_proximity.\n"
+"\n"
+":param input_img: is a string containing the name of the input image file.\n"
+":param out_dist_img: is a string containing the name of the output (Float32) distance image.\n"
+":param out_label_img: is an optional string containing the name of the output image with the value of the nearest feature pixel (0 where there is no feature within max_dist).\n"
+":param gdalformat: is a string with the GDAL format of the output images (Default: KEA).\n"
+":param img_band: is the band of the input image (Default: 1).\n"
+":param max_dist: is the maximum distance; pixels further from a feature are given no_data_val. If greater than 0 the image is processed in strips, otherwise (Default: 0) in a single strip.\n"
+":param no_data_val: is the output value of the pixels without a feature within max_dist (Default: -1).\n"
+":param use_geo_units: is a bool specifying that the distances are in the units of the image projection (Default: True), otherwise they are in pixels.\n"
+"\n"},
+
+{"calc_dist_to_img_classes", (PyCFunction)ImageUtils_CalcDistToImgClasses, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imageutils.calc_dist_to_img_classes(input_img, out_dist_imgs, class_ids=None, gdalformat='KEA', img_band=1, max_dist=0, no_data_val=-1, use_geo_units=True)\n"
+"Calculates the (exact Euclidean) distance from each pixel to the nearest pixel of each class of the image\n"
+"band in a single pass over the input image (see calc_dist_to_nearest_feature).\n"
 "\n"
+":param input_img: is a string containing the name of the input image file.\n"
+":param out_dist_imgs: is either a string with a single output image, with a band per class (with the description class_<id>), or a list with an output image for each class.\n"
+":param class_ids: is an optional list of the class values (Default: None is all the non-zero values of the image).\n"
+":param gdalformat: is a string with the GDAL format of the output images (Default: KEA).\n"
+":param img_band: is the band of the input image (Default: 1).\n"
+":param max_dist: is the maximum distance; pixels further from a class are given no_data_val (Default: 0, no maximum).\n"
+":param no_data_val: is the output value of the pixels without a pixel of the class within max_dist (Default: -1).\n"
+":param use_geo_units: is a bool specifying that the distances are in the units of the image projection (Default: True), otherwise they are in pixels.\n"
 "\n"},
 
 {nullptr}        /* Sentinel */
@@ -2826,6 +4490,7 @@ init_imageutils(void)
     PyModule_AddIntConstant(pModule, "STRETCH_EXPONENTIAL", rsgis::cmds::exponential);
     PyModule_AddIntConstant(pModule, "STRETCH_LOGARITHMIC", rsgis::cmds::logarithmic);
     PyModule_AddIntConstant(pModule, "STRETCH_POWERLAW", rsgis::cmds::powerLaw);
+    PyModule_AddIntConstant(pModule, "STRETCH_APPROXPERCENT", rsgis::cmds::approxPercentile);
 
 #if PY_MAJOR_VERSION >= 3
     return pModule;
@@ -81,18 +81,20 @@ static PyObject *RasterGIS_PopulateStats(PyObject *self, PyObject *args, PyObjec
     int calcImgPyramids = 1;
     int ignoreZeroVal = 1;
     unsigned int ratBand = 1;
+    unsigned int numThreads = 1;
     static char *kwlist[] = {RSGIS_PY_C_TEXT("clumps_img"), RSGIS_PY_C_TEXT("add_clr_tab"),
                              RSGIS_PY_C_TEXT("calc_pyramids"), RSGIS_PY_C_TEXT("ignore_zero"),
-                             RSGIS_PY_C_TEXT("rat_band"), nullptr};
+                             RSGIS_PY_C_TEXT("rat_band"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
 
-    if(!PyArg_ParseTupleAndKeywords(args, keywds, "s|iiiI:pop_rat_img_stats", kwlist, &clumpsImage, &addColourTable2Img, &calcImgPyramids, &ignoreZeroVal, &ratBand))
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "s|iiiII:pop_rat_img_stats", kwlist, &clumpsImage, &addColourTable2Img, &calcImgPyramids, &ignoreZeroVal, &ratBand, &numThreads))
     {
         return nullptr;
     }
 
     try
     {
-        rsgis::cmds::executePopulateStats(std::string(clumpsImage), addColourTable2Img, calcImgPyramids, ignoreZeroVal, ratBand);
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executePopulateStats(std::string(clumpsImage), addColourTable2Img, calcImgPyramids, ignoreZeroVal, ratBand, numThreads);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
     {
@@ -115,6 +117,7 @@ static PyObject *RasterGIS_CopyRAT(PyObject *self, PyObject *args, PyObject *key
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCopyRAT(std::string(clumpsImage), std::string(inputImage),ratBand);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -126,6 +129,30 @@ static PyObject *RasterGIS_CopyRAT(PyObject *self, PyObject *args, PyObject *key
     Py_RETURN_NONE;
 }
 
+static PyObject *RasterGIS_RechunkKEARAT(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    const char *inputImage, *outputImage;
+    unsigned int chunkSize = 0;
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"),
+                             RSGIS_PY_C_TEXT("chunk_size"), nullptr};
+
+    if(!PyArg_ParseTupleAndKeywords(args, keywds,"ss|I:rechunk_kea_rat", kwlist, &inputImage, &outputImage, &chunkSize))
+        return nullptr;
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeRechunkKEARAT(std::string(inputImage), std::string(outputImage), chunkSize);
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
 static PyObject *RasterGIS_CopyGDALATTColumns(PyObject *self, PyObject *args, PyObject *keywds)
 {
     const char *clumpsImage, *inputImage;
@@ -154,6 +181,7 @@ static PyObject *RasterGIS_CopyGDALATTColumns(PyObject *self, PyObject *args, Py
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCopyGDALATTColumns(std::string(inputImage), std::string(clumpsImage), fields, copyColours, copyHist, ratBand);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -179,6 +207,7 @@ static PyObject *RasterGIS_SpatialLocation(PyObject *self, PyObject *args, PyObj
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeSpatialLocation(std::string(inputImage), ratBand, std::string(eastingsField), std::string(northingsField));
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -206,6 +235,7 @@ static PyObject *RasterGIS_SpatialExtent(PyObject *self, PyObject *args, PyObjec
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeSpatialLocationExtent(std::string(inputImage), ratBand, std::string(minXXCol), std::string(minXYCol), std::string(maxXXCol), std::string(maxXYCol), std::string(minYXCol), std::string(minYYCol), std::string(maxYXCol), std::string(maxYYCol));
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -317,6 +347,7 @@ static PyObject *RasterGIS_PopulateRATWithStats(PyObject *self, PyObject *args,
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executePopulateRATWithStats(std::string(inputImage), std::string(clumpsImage), &bandStatsCmds, ratBand);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -338,6 +369,170 @@ static PyObject *RasterGIS_PopulateRATWithStats(PyObject *self, PyObject *args,
     Py_RETURN_NONE;
 }
 
+static PyObject *RasterGIS_PopulateRATWithStatsSinglePass(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    const char *inputImage, *clumpsImage;
+    PyObject *pBandAttStatsCmds;
+    unsigned int ratBand = 1;
+    unsigned int nThreads = 1;
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("clumps_img"),
+                             RSGIS_PY_C_TEXT("band_stats"), RSGIS_PY_C_TEXT("rat_band"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
+
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssO|II:populate_rat_with_stats_single_pass", kwlist, &inputImage, &clumpsImage, &pBandAttStatsCmds, &ratBand, &nThreads))
+    {
+        return nullptr;
+    }
+
+    if(!PySequence_Check(pBandAttStatsCmds))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "bandstats argument must be a sequence");
+        return nullptr;
+    }
+
+    // extract the attributes from the sequence of objects into our structs
+    Py_ssize_t nCmds = PySequence_Size(pBandAttStatsCmds);
+    std::vector<rsgis::cmds::RSGISBandAttStatsCmds*> bandStatsCmds;
+    bandStatsCmds.reserve(nCmds);
+
+    for(int i = 0; i < nCmds; ++i)
+    {
+        PyObject *o = PySequence_GetItem(pBandAttStatsCmds, i);     // the python object
+
+        rsgis::cmds::RSGISBandAttStatsCmds *cmdObj = new rsgis::cmds::RSGISBandAttStatsCmds();   // the c++ object we need to pass pointers of
+
+        std::vector<PyObject*> extractedAttributes;     // store a list of extracted pyobjects to dereference
+        extractedAttributes.push_back(o);
+
+        PyObject *pBand = PyObject_GetAttrString(o, "band");
+        extractedAttributes.push_back(pBand);
+        if( ( pBand == nullptr ) || ( pBand == Py_None ) || !RSGISPY_CHECK_INT(pBand))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "could not find int attribute \'band\'" );
+            FreePythonObjects(extractedAttributes);
+            for(auto iter = bandStatsCmds.begin(); iter != bandStatsCmds.end(); ++iter) {
+                delete *iter;
+            }
+            delete cmdObj;
+            return nullptr;
+        }
+        cmdObj->band = RSGISPY_INT_EXTRACT(pBand);
+
+        // the field attributes are all optional so a missing attribute is the same as None
+        const char *fieldAttNames[] = {"min_field", "max_field", "mean_field", "std_dev_field", "sum_field", "count_field", "mode_field"};
+        bool *calcFlags[] = {&cmdObj->calcMin, &cmdObj->calcMax, &cmdObj->calcMean, &cmdObj->calcStdDev, &cmdObj->calcSum, &cmdObj->calcCount, &cmdObj->calcMode};
+        std::string *fieldNames[] = {&cmdObj->minField, &cmdObj->maxField, &cmdObj->meanField, &cmdObj->stdDevField, &cmdObj->sumField, &cmdObj->countField, &cmdObj->modeField};
+        for(unsigned int j = 0; j < 7; ++j)
+        {
+            PyObject *pField = PyObject_GetAttrString(o, fieldAttNames[j]);
+            if(pField == nullptr)
+            {
+                PyErr_Clear();
+            }
+            extractedAttributes.push_back(pField);
+            *calcFlags[j] = !(pField == nullptr || !RSGISPY_CHECK_STRING(pField));
+            if(*calcFlags[j])
+            {
+                *fieldNames[j] = RSGISPY_STRING_EXTRACT(pField);
+            }
+        }
+
+        cmdObj->histMin = 0;
+        cmdObj->histMax = 0;
+        cmdObj->numHistBins = 200;
+        PyObject *pHistMin = PyObject_GetAttrString(o, "hist_min");
+        PyErr_Clear();
+        PyObject *pHistMax = PyObject_GetAttrString(o, "hist_max");
+        PyErr_Clear();
+        PyObject *pNumHistBins = PyObject_GetAttrString(o, "n_hist_bins");
+        PyErr_Clear();
+        PyObject *pPercentiles = PyObject_GetAttrString(o, "percentiles");
+        PyErr_Clear();
+        extractedAttributes.push_back(pHistMin);
+        extractedAttributes.push_back(pHistMax);
+        extractedAttributes.push_back(pNumHistBins);
+        extractedAttributes.push_back(pPercentiles);
+        if((pHistMin != nullptr) && (pHistMax != nullptr) && (RSGISPY_CHECK_FLOAT(pHistMin) || RSGISPY_CHECK_INT(pHistMin)) && (RSGISPY_CHECK_FLOAT(pHistMax) || RSGISPY_CHECK_INT(pHistMax)))
+        {
+            cmdObj->histMin = RSGISPY_FLOAT_EXTRACT(pHistMin);
+            cmdObj->histMax = RSGISPY_FLOAT_EXTRACT(pHistMax);
+        }
+        if((pNumHistBins != nullptr) && RSGISPY_CHECK_INT(pNumHistBins))
+        {
+            cmdObj->numHistBins = RSGISPY_UINT_EXTRACT(pNumHistBins);
+        }
+
+        bool percentilesOK = true;
+        if((pPercentiles != nullptr) && (pPercentiles != Py_None))
+        {
+            if(!PySequence_Check(pPercentiles))
+            {
+                percentilesOK = false;
+            }
+            else
+            {
+                Py_ssize_t nPercentiles = PySequence_Size(pPercentiles);
+                for(Py_ssize_t j = 0; j < nPercentiles; ++j)
+                {
+                    PyObject *pPerObj = PySequence_GetItem(pPercentiles, j);
+                    PyObject *pPercentile = PyObject_GetAttrString(pPerObj, "percentile");
+                    PyErr_Clear();
+                    PyObject *pFieldName = PyObject_GetAttrString(pPerObj, "field_name");
+                    PyErr_Clear();
+                    extractedAttributes.push_back(pPerObj);
+                    extractedAttributes.push_back(pPercentile);
+                    extractedAttributes.push_back(pFieldName);
+                    if((pPercentile == nullptr) || !(RSGISPY_CHECK_FLOAT(pPercentile) || RSGISPY_CHECK_INT(pPercentile)) || (pFieldName == nullptr) || !RSGISPY_CHECK_STRING(pFieldName))
+                    {
+                        percentilesOK = false;
+                        break;
+                    }
+                    rsgis::cmds::RSGISBandAttPercentilesCmds percObj;
+                    percObj.percentile = RSGISPY_FLOAT_EXTRACT(pPercentile);
+                    percObj.fieldName = RSGISPY_STRING_EXTRACT(pFieldName);
+                    cmdObj->percentiles.push_back(percObj);
+                }
+            }
+        }
+        if(!percentilesOK)
+        {
+            PyErr_SetString(GETSTATE(self)->error, "\'percentiles\' must be a sequence of rsgislib.rastergis.BandAttPercentiles objects" );
+            FreePythonObjects(extractedAttributes);
+            for(auto iter = bandStatsCmds.begin(); iter != bandStatsCmds.end(); ++iter) {
+                delete *iter;
+            }
+            delete cmdObj;
+            return nullptr;
+        }
+
+        FreePythonObjects(extractedAttributes);
+        bandStatsCmds.push_back(cmdObj);
+    }
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executePopulateRATWithStatsSinglePass(std::string(inputImage), std::string(clumpsImage), &bandStatsCmds, ratBand, nThreads);
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        for(auto iter = bandStatsCmds.begin(); iter != bandStatsCmds.end(); ++iter)
+        {
+            delete *iter;
+        }
+        return nullptr;
+    }
+
+    // free temp structs
+    for(auto iter = bandStatsCmds.begin(); iter != bandStatsCmds.end(); ++iter)
+    {
+        delete *iter;
+    }
+
+    Py_RETURN_NONE;
+}
+
 static PyObject *RasterGIS_PopulateRATWithPercentiles(PyObject *self, PyObject *args, PyObject *keywds)
 {
     const char *inputImage, *clumpsImage;
@@ -415,6 +610,7 @@ static PyObject *RasterGIS_PopulateRATWithPercentiles(PyObject *self, PyObject *
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executePopulateRATWithPercentiles(std::string(inputImage), std::string(clumpsImage), band, &bandPercentilesCmds, ratBand, numHistBins);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -459,6 +655,7 @@ static PyObject *RasterGIS_PopulateCategoryProportions(PyObject *self, PyObject
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executePopulateCategoryProportions(std::string(categoriesImage), std::string(clumpsImage), std::string(outColsName), std::string(majorityColName),
                                                         (copyClassNames != 0), std::string(majClassNameField), std::string(classNameField), ratBandClumps, ratBandCats);
     }
@@ -494,7 +691,10 @@ static PyObject *RasterGIS_PopulateRATWithMode(PyObject *self, PyObject *args, P
     {
         bool useNoDataBool = (bool) useNoDataVal;
         bool outNoDataBool = (bool) outNoDataVal;
-        rsgis::cmds::executePopulateRATWithMode(std::string(inputImage), std::string(clumpsImage), std::string(outColsName), useNoDataBool, noDataVal, outNoDataBool, modeBand, ratBand);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executePopulateRATWithMode(std::string(inputImage), std::string(clumpsImage), std::string(outColsName), useNoDataBool, noDataVal, outNoDataBool, modeBand, ratBand);
+        }
     }
     catch (rsgis::cmds::RSGISCmdException &e)
     {
@@ -524,6 +724,7 @@ static PyObject *RasterGIS_ExportCol2GDALImage(PyObject *self, PyObject *args, P
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeExportCols2GDALImage(std::string(inputImage), std::string(outputFile), std::string(imageFormat), type, std::string(field), ratBand);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -562,6 +763,7 @@ static PyObject *RasterGIS_Export2Ascii(PyObject *self, PyObject *args, PyObject
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeExport2Ascii(std::string(inputImage), std::string(outputFile), fields, ratBand);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -674,11 +876,17 @@ static PyObject *RasterGIS_ColourClasses(PyObject *self, PyObject *args, PyObjec
     {
         if(intKet)
         {
-            rsgis::cmds::executeColourClasses(std::string(inputImage), std::string(classInField), classPairsInt, ratBand);
+            {
+                RSGISPyReleaseGIL releaseGIL;
+                rsgis::cmds::executeColourClasses(std::string(inputImage), std::string(classInField), classPairsInt, ratBand);
+            }
         }
         else
         {
-            rsgis::cmds::executeColourStrClasses(std::string(inputImage), std::string(classInField), classPairsStr, ratBand);
+            {
+                RSGISPyReleaseGIL releaseGIL;
+                rsgis::cmds::executeColourStrClasses(std::string(inputImage), std::string(classInField), classPairsStr, ratBand);
+            }
         }
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -709,6 +917,7 @@ static PyObject *RasterGIS_StrClassMajority(PyObject *self, PyObject *args, PyOb
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeStrClassMajority(std::string(baseSegment), std::string(infoSegment), std::string(baseClassCol), std::string(infoClassCol), infoRatBand, baseRatBand, infoRatBand);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -735,6 +944,7 @@ static PyObject *RasterGIS_FindNeighbours(PyObject *self, PyObject *args, PyObje
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeFindNeighbours(std::string(inputImage), ratBand);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -763,6 +973,7 @@ static PyObject *RasterGIS_FindBoundaryPixels(PyObject *self, PyObject *args, Py
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeFindBoundaryPixels(std::string(inputImage), ratBand, std::string(outputFile), std::string(imageFormat));
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -789,6 +1000,7 @@ static PyObject *RasterGIS_CalcBorderLength(PyObject *self, PyObject *args, PyOb
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCalcBorderLength(std::string(inputImage), (iIgnoreZeroEdges != 0), std::string(outColsName));
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -817,6 +1029,7 @@ static PyObject *RasterGIS_CalcRelBorder(PyObject *self, PyObject *args, PyObjec
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCalcRelBorder(std::string(inputImage), std::string(outColsName), std::string(classNameField), std::string(className), (iIgnoreZeroEdges != 0));
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -845,6 +1058,7 @@ static PyObject *RasterGIS_DefineClumpTilePositions(PyObject *self, PyObject *ar
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeDefineClumpTilePositions(std::string(clumpsImage), std::string(tileImage), std::string(outColsName), tileOverlap, tileBoundary, tileBody);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -870,6 +1084,7 @@ static PyObject *RasterGIS_DefineBorderClumps(PyObject *self, PyObject *args, Py
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeDefineBorderClumps(std::string(clumpsImage), std::string(outColsName));
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -940,6 +1155,7 @@ static PyObject *RasterGIS_GetGlobalClassStats(PyObject *self, PyObject *args, P
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeGetGlobalClassStats(std::string(clumpsImage), std::string(classField), attFields, classFields, ratBand);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -970,6 +1186,7 @@ static PyObject *RasterGIS_SelectClumpsOnGrid(PyObject *self, PyObject *args, Py
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeIdentifyClumpExtremesOnGrid(std::string(clumpsImage), std::string(inSelectField), std::string(outSelectField), std::string(eastingsCol), std::string(northingsCol), std::string(methodStr), rows, cols, std::string(metricField));
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -1064,7 +1281,10 @@ static PyObject *RasterGIS_CalcRelDiffNeighbourStats(PyObject *self, PyObject *a
     try
     {
         bool useAbsDiffBool = (bool)useAbsDiff;
-        rsgis::cmds::executeCalcRelDiffNeighbourStats(std::string(clumpsImage), cmdObj, useAbsDiffBool, ratBand);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeCalcRelDiffNeighbourStats(std::string(clumpsImage), cmdObj, useAbsDiffBool, ratBand);
+        }
     }
     catch (rsgis::cmds::RSGISCmdException &e)
     {
@@ -1180,6 +1400,7 @@ static PyObject *RasterGIS_PopulateRATWithMeanLitStats(PyObject *self, PyObject
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executePopulateRATWithMeanLitStats(std::string(inputImage), std::string(clumpsImage), std::string(meanLitImage), meanlitBand, std::string(meanLitCol), std::string(pxlCountCol), &bandStatsCmds, ratBand);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -1218,6 +1439,7 @@ static PyObject *RasterGIS_CollapseRAT(PyObject *self, PyObject *args, PyObject
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCollapseRAT(std::string(clumpsImage), ratBand, std::string(selectField), std::string(outputFile), std::string(imageFormat));
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -1262,7 +1484,10 @@ static PyObject *RasterGIS_ImportVecAtts(PyObject *self, PyObject *args, PyObjec
             }
         }
         
-        rsgis::cmds::executeImportVecAtts(std::string(clumpsImage), ratBand, std::string(vectorFile), std::string(vectorLyrName), std::string(fidColName), colNames);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeImportVecAtts(std::string(clumpsImage), ratBand, std::string(vectorFile), std::string(vectorLyrName), std::string(fidColName), colNames);
+        }
     }
     catch (rsgis::cmds::RSGISCmdException &e)
     {
@@ -1274,6 +1499,56 @@ static PyObject *RasterGIS_ImportVecAtts(PyObject *self, PyObject *args, PyObjec
 }
 
 
+static PyObject *RasterGIS_ImportVecAttsByOverlap(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    const char *clumpsImage, *vectorFile, *vectorLyrName;
+    PyObject *pColNamesList = Py_None;
+    float minPropOverlap = 0.0;
+    const char *outFIDCol = "";
+    int ratBand = 1;
+
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("clumps_img"), RSGIS_PY_C_TEXT("vec_file"),
+                             RSGIS_PY_C_TEXT("vec_lyr"), RSGIS_PY_C_TEXT("col_names"),
+                             RSGIS_PY_C_TEXT("min_prop_overlap"), RSGIS_PY_C_TEXT("out_fid_col"),
+                             RSGIS_PY_C_TEXT("rat_band"), nullptr};
+
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "sss|Ofsi:import_vec_atts_by_overlap", kwlist, &clumpsImage, &vectorFile, &vectorLyrName, &pColNamesList, &minPropOverlap, &outFIDCol, &ratBand))
+    {
+        return nullptr;
+    }
+
+    try
+    {
+        std::vector<std::string> colNames;
+        if(PySequence_Check(pColNamesList))
+        {
+            Py_ssize_t nCmds = PySequence_Size(pColNamesList);
+            colNames.reserve(nCmds);
+
+            for(int i = 0; i < nCmds; ++i)
+            {
+                PyObject *o = PySequence_GetItem(pColNamesList, i);     // get the python object
+
+                std::string strVal = RSGISPY_STRING_EXTRACT(o); // Get string
+                colNames.push_back(strVal);
+            }
+        }
+
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeImportVecAttsByOverlap(std::string(clumpsImage), ratBand, std::string(vectorFile), std::string(vectorLyrName), colNames, minPropOverlap, std::string(outFIDCol));
+        }
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+
 static PyObject *RasterGIS_ApplyKNN(PyObject *self, PyObject *args, PyObject *keywds)
 {
     const char *inClumpsImage = "";
@@ -1325,7 +1600,10 @@ static PyObject *RasterGIS_ApplyKNN(PyObject *self, PyObject *args, PyObject *ke
         rsgis::cmds::rsgisKNNDistCmd distKNN = static_cast<rsgis::cmds::rsgisKNNDistCmd>(distKNNInt);
         rsgis::cmds::rsgisKNNSummeriseCmd summeriseKNN = static_cast<rsgis::cmds::rsgisKNNSummeriseCmd>(summeriseKNNInt);
         
-        rsgis::cmds::executeApplyKNN(std::string(inClumpsImage), ratBand, std::string(inExtrapField), std::string(outExtrapField), std::string(trainRegionsField), applyRegionsField, applyRegions, fields, kFeatures, distKNN, distThreshold, summeriseKNN);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeApplyKNN(std::string(inClumpsImage), ratBand, std::string(inExtrapField), std::string(outExtrapField), std::string(trainRegionsField), applyRegionsField, applyRegions, fields, kFeatures, distKNN, distThreshold, summeriseKNN);
+        }
     }
     catch (rsgis::cmds::RSGISCmdException &e)
     {
@@ -1367,6 +1645,7 @@ static PyObject *RasterGIS_HistoSampling(PyObject *self, PyObject *args, PyObjec
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeHistSampling(std::string(inClumpsImage), ratBand, std::string(varCol), std::string(outSelectCol), propOfSample, binWidth, classRestrict, classColumn, std::string(classVal));
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -1410,6 +1689,7 @@ static PyObject *RasterGIS_FitHistGausianMixtureModel(PyObject *self, PyObject *
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeFitHistGausianMixtureModel(std::string(inClumpsImage), ratBand, std::string(outH5File), std::string(varCol), binWidth, std::string(classColumn), std::string(classVal), outputHist, outHistFile);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -1444,6 +1724,7 @@ static PyObject *RasterGIS_ClassSplitFitHistGausianMixtureModel(PyObject *self,
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeClassSplitFitHistGausianMixtureModel(std::string(inClumpsImage), ratBand, std::string(outColumn), std::string(varCol), binWidth, std::string(classColumn), std::string(classVal));
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -1472,6 +1753,7 @@ static PyObject *RasterGIS_PopulateRATWithPropValidPxls(PyObject *self, PyObject
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCalcPropOfValidPixelsInClump(std::string(inputImage), std::string(clumpsImage), ratBand, std::string(outColsName), noDataVal);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
@@ -1503,7 +1785,11 @@ static PyObject *RasterGIS_Calc1DJMDistance(PyObject *self, PyObject *args, PyOb
     PyObject *outVal = PyTuple_New(1);
     try
     {
-        double dist = rsgis::cmds::executeCalc1DJMDistance(std::string(clumpsImage), std::string(varCol), binWidth, std::string(classCol), std::string(class1Val), std::string(class2Val), ratBand);
+        double dist = 0;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            dist = rsgis::cmds::executeCalc1DJMDistance(std::string(clumpsImage), std::string(varCol), binWidth, std::string(classCol), std::string(class1Val), std::string(class2Val), ratBand);
+        }
         
         if(PyTuple_SetItem(outVal, 0, Py_BuildValue("d", dist)) == -1)
         {
@@ -1519,6 +1805,96 @@ static PyObject *RasterGIS_Calc1DJMDistance(PyObject *self, PyObject *args, PyOb
     return outVal;
 }
 
+static PyObject *RasterGIS_CalcSeparabilities(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    const char *clumpsImage;
+    PyObject *pSepCalcs;
+    unsigned int ratBand = 1;
+    unsigned int numThreads = 0;
+
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("clumps_img"), RSGIS_PY_C_TEXT("sep_calcs"),
+                             RSGIS_PY_C_TEXT("rat_band"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
+
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "sO|II:calc_separabilities", kwlist, &clumpsImage, &pSepCalcs, &ratBand, &numThreads))
+    {
+        return nullptr;
+    }
+
+    if(!PySequence_Check(pSepCalcs))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "sep_calcs argument must be a sequence");
+        return nullptr;
+    }
+
+    std::vector<rsgis::cmds::RSGISSeparabilityCalcCmds> sepCalcs;
+    Py_ssize_t nCalcs = PySequence_Size(pSepCalcs);
+    for(Py_ssize_t i = 0; i < nCalcs; ++i)
+    {
+        PyObject *o = PySequence_GetItem(pSepCalcs, i);
+
+        std::vector<PyObject*> extractedAttributes;     // store a list of extracted pyobjects to dereference
+        extractedAttributes.push_back(o);
+
+        PyObject *pMeasure = PyObject_GetAttrString(o, "measure");
+        extractedAttributes.push_back(pMeasure);
+        PyObject *pVal1Col = PyObject_GetAttrString(o, "val1_col");
+        extractedAttributes.push_back(pVal1Col);
+        PyObject *pVal2Col = PyObject_GetAttrString(o, "val2_col");
+        extractedAttributes.push_back(pVal2Col);
+        PyObject *pVal1BinWidth = PyObject_GetAttrString(o, "val1_bin_width");
+        extractedAttributes.push_back(pVal1BinWidth);
+        PyObject *pVal2BinWidth = PyObject_GetAttrString(o, "val2_bin_width");
+        extractedAttributes.push_back(pVal2BinWidth);
+        PyObject *pClsCol = PyObject_GetAttrString(o, "cls_col");
+        extractedAttributes.push_back(pClsCol);
+        PyObject *pClass1 = PyObject_GetAttrString(o, "class1");
+        extractedAttributes.push_back(pClass1);
+        PyObject *pClass2 = PyObject_GetAttrString(o, "class2");
+        extractedAttributes.push_back(pClass2);
+
+        if((pMeasure == nullptr) || !RSGISPY_CHECK_INT(pMeasure) || (pVal1Col == nullptr) || !RSGISPY_CHECK_STRING(pVal1Col) ||
+           (pClsCol == nullptr) || !RSGISPY_CHECK_STRING(pClsCol) || (pClass1 == nullptr) || !RSGISPY_CHECK_STRING(pClass1) ||
+           (pClass2 == nullptr) || !RSGISPY_CHECK_STRING(pClass2))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "could not find the attributes \'measure\' (int), \'val1_col\', \'cls_col\', \'class1\' and \'class2\' (strings)");
+            FreePythonObjects(extractedAttributes);
+            return nullptr;
+        }
+
+        rsgis::cmds::RSGISSeparabilityCalcCmds sepCalc;
+        sepCalc.measure = (rsgis::cmds::rsgisSeparabilityCmd)RSGISPY_INT_EXTRACT(pMeasure);
+        sepCalc.var1Col = RSGISPY_STRING_EXTRACT(pVal1Col);
+        sepCalc.var2Col = ((pVal2Col != nullptr) && RSGISPY_CHECK_STRING(pVal2Col))?RSGISPY_STRING_EXTRACT(pVal2Col):std::string("");
+        sepCalc.var1BinWidth = ((pVal1BinWidth != nullptr) && RSGISPY_CHECK_FLOAT(pVal1BinWidth))?RSGISPY_FLOAT_EXTRACT(pVal1BinWidth):0.0;
+        sepCalc.var2BinWidth = ((pVal2BinWidth != nullptr) && RSGISPY_CHECK_FLOAT(pVal2BinWidth))?RSGISPY_FLOAT_EXTRACT(pVal2BinWidth):0.0;
+        sepCalc.classColumn = RSGISPY_STRING_EXTRACT(pClsCol);
+        sepCalc.class1Val = RSGISPY_STRING_EXTRACT(pClass1);
+        sepCalc.class2Val = RSGISPY_STRING_EXTRACT(pClass2);
+        sepCalcs.push_back(sepCalc);
+
+        FreePythonObjects(extractedAttributes);
+    }
+
+    std::vector<float> dists;
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        dists = rsgis::cmds::executeCalcSeparabilities(std::string(clumpsImage), sepCalcs, ratBand, numThreads);
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    PyObject *outList = PyList_New(dists.size());
+    for(size_t i = 0; i < dists.size(); ++i)
+    {
+        PyList_SetItem(outList, i, Py_BuildValue("d", dists[i]));
+    }
+    return outList;
+}
+
 static PyObject *RasterGIS_Calc2DJMDistance(PyObject *self, PyObject *args, PyObject *keywds)
 {
     const char *clumpsImage, *var1Col, *var2Col, *classCol, *class1Val, *class2Val;
@@ -1540,7 +1916,11 @@ static PyObject *RasterGIS_Calc2DJMDistance(PyObject *self, PyObject *args, PyOb
     PyObject *outVal = PyTuple_New(1);
     try
     {
-        double dist = rsgis::cmds::executeCalc2DJMDistance(std::string(clumpsImage), std::string(var1Col), std::string(var2Col), var1BinWidth, var2BinWidth, std::string(classCol), std::string(class1Val), std::string(class2Val), ratBand);
+        double dist = 0;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            dist = rsgis::cmds::executeCalc2DJMDistance(std::string(clumpsImage), std::string(var1Col), std::string(var2Col), var1BinWidth, var2BinWidth, std::string(classCol), std::string(class1Val), std::string(class2Val), ratBand);
+        }
         
         if(PyTuple_SetItem(outVal, 0, Py_BuildValue("d", dist)) == -1)
         {
@@ -1573,7 +1953,11 @@ static PyObject *RasterGIS_CalcBhattacharyyaDistance(PyObject *self, PyObject *a
     PyObject *outVal = PyTuple_New(1);
     try
     {
-        double dist = rsgis::cmds::executeCalcBhattacharyyaDistance(std::string(clumpsImage), std::string(varCol), std::string(classCol), std::string(class1Val), std::string(class2Val), ratBand);
+        double dist = 0;
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            dist = rsgis::cmds::executeCalcBhattacharyyaDistance(std::string(clumpsImage), std::string(varCol), std::string(classCol), std::string(class1Val), std::string(class2Val), ratBand);
+        }
         
         if(PyTuple_SetItem(outVal, 0, Py_BuildValue("d", dist)) == -1)
         {
@@ -1589,24 +1973,248 @@ static PyObject *RasterGIS_CalcBhattacharyyaDistance(PyObject *self, PyObject *a
     return outVal;
 }
 
+static PyObject *RasterGIS_GetColumnSummary(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    const char *clumpsImage;
+    const char *colName;
+    const char *classColumn = "";
+    const char *classVal = "";
+    unsigned int ratBand = 1;
+
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("clumps_img"), RSGIS_PY_C_TEXT("col_name"), RSGIS_PY_C_TEXT("cls_col"),
+                             RSGIS_PY_C_TEXT("cls_val"), RSGIS_PY_C_TEXT("rat_band"), nullptr};
+
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ss|ssI:get_column_summary", kwlist, &clumpsImage, &colName, &classColumn, &classVal, &ratBand))
+    {
+        return nullptr;
+    }
+
+    rsgis::cmds::RSGISRATColumnSummaryCmds summary;
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        summary = rsgis::cmds::executeGetColumnSummary(std::string(clumpsImage), std::string(colName), std::string(classColumn), std::string(classVal), ratBand);
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    PyObject *histList = PyList_New(summary.histCounts.size());
+    for(size_t i = 0; i < summary.histCounts.size(); ++i)
+    {
+        PyList_SetItem(histList, i, Py_BuildValue("n", (Py_ssize_t)summary.histCounts[i]));
+    }
+    return Py_BuildValue("(dddnN)", summary.minVal, summary.maxVal, summary.mean, (Py_ssize_t)summary.numVals, histList);
+}
+
+// Gets a view of a float64 or int32 array for reading or writing a chunk of RAT column
+// rows, setting isReal for float64. Returns false, with the Python exception set, otherwise.
+static bool RasterGIS_GetColChunkBuffer(PyObject *arrObj, bool writable, PyObject *error, const char *name, RSGISPyArrayBuffer &arrBuf, bool *isReal)
+{
+    *isReal = true;
+    if(arrBuf.getBuffer(arrObj, 'd', writable, error, name))
+    {
+        return true;
+    }
+    PyErr_Clear();
+    *isReal = false;
+    if(arrBuf.getBuffer(arrObj, 'i', writable, error, name))
+    {
+        return true;
+    }
+    PyErr_Clear();
+    std::string message = std::string("'") + name + std::string("' needs to be a C contiguous") + (writable?std::string(", writable"):std::string("")) + std::string(" array of float64 or int32 values.");
+    PyErr_SetString(error, message.c_str());
+    return false;
+}
+
+static PyObject *RasterGIS_ReadRATColChunk(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    const char *clumpsImage;
+    const char *colName;
+    PyObject *outArrObj;
+    Py_ssize_t startRow = 0;
+    unsigned int ratBand = 1;
+
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("clumps_img"), RSGIS_PY_C_TEXT("col_name"), RSGIS_PY_C_TEXT("out_arr"),
+                             RSGIS_PY_C_TEXT("start_row"), RSGIS_PY_C_TEXT("rat_band"), nullptr};
+
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssO|nI:read_rat_col_chunk", kwlist, &clumpsImage, &colName, &outArrObj, &startRow, &ratBand))
+    {
+        return nullptr;
+    }
+    if(startRow < 0)
+    {
+        PyErr_SetString(GETSTATE(self)->error, "'start_row' must not be negative.");
+        return nullptr;
+    }
+
+    RSGISPyArrayBuffer outArrBuf;
+    bool isReal = true;
+    if(!RasterGIS_GetColChunkBuffer(outArrObj, true, GETSTATE(self)->error, "out_arr", outArrBuf, &isReal))
+    {
+        return nullptr;
+    }
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        if(isReal)
+        {
+            rsgis::cmds::executeReadRATColumnChunk(std::string(clumpsImage), std::string(colName), startRow, outArrBuf.getNumItems(), (double*)outArrBuf.getData(), ratBand);
+        }
+        else
+        {
+            rsgis::cmds::executeReadRATColumnChunk(std::string(clumpsImage), std::string(colName), startRow, outArrBuf.getNumItems(), (int*)outArrBuf.getData(), ratBand);
+        }
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *RasterGIS_WriteRATColChunk(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    const char *clumpsImage;
+    const char *colName;
+    PyObject *inArrObj;
+    Py_ssize_t startRow = 0;
+    unsigned int ratBand = 1;
+
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("clumps_img"), RSGIS_PY_C_TEXT("col_name"), RSGIS_PY_C_TEXT("in_arr"),
+                             RSGIS_PY_C_TEXT("start_row"), RSGIS_PY_C_TEXT("rat_band"), nullptr};
+
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssO|nI:write_rat_col_chunk", kwlist, &clumpsImage, &colName, &inArrObj, &startRow, &ratBand))
+    {
+        return nullptr;
+    }
+    if(startRow < 0)
+    {
+        PyErr_SetString(GETSTATE(self)->error, "'start_row' must not be negative.");
+        return nullptr;
+    }
+
+    RSGISPyArrayBuffer inArrBuf;
+    bool isReal = true;
+    if(!RasterGIS_GetColChunkBuffer(inArrObj, false, GETSTATE(self)->error, "in_arr", inArrBuf, &isReal))
+    {
+        return nullptr;
+    }
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        if(isReal)
+        {
+            rsgis::cmds::executeWriteRATColumnChunk(std::string(clumpsImage), std::string(colName), startRow, inArrBuf.getNumItems(), (double*)inArrBuf.getData(), ratBand);
+        }
+        else
+        {
+            rsgis::cmds::executeWriteRATColumnChunk(std::string(clumpsImage), std::string(colName), startRow, inArrBuf.getNumItems(), (int*)inArrBuf.getData(), ratBand);
+        }
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
 static PyObject *RasterGIS_ExportClumps2Images(PyObject *self, PyObject *args, PyObject *keywds)
 {
     const char *inputImage, *outputBaseName, *outFileExt, *imageFormat;
     int binaryOut = false;
     int ratBand = 1;
+    unsigned int maxOpenOutputs = 256;
     
     static char *kwlist[] = {RSGIS_PY_C_TEXT("clumps_img"), RSGIS_PY_C_TEXT("out_img_base"),
                              RSGIS_PY_C_TEXT("bin_out"), RSGIS_PY_C_TEXT("out_img_ext"),
-                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("rat_band"), nullptr};
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("rat_band"),
+                             RSGIS_PY_C_TEXT("max_open_outputs"), nullptr};
+    
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssiss|iI:export_clumps_to_images", kwlist, &inputImage, &outputBaseName, &binaryOut, &outFileExt, &imageFormat, &ratBand, &maxOpenOutputs))
+    {
+        return nullptr;
+    }
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeExportClumps2Images(std::string(inputImage), std::string(outputBaseName), std::string(outFileExt), std::string(imageFormat), (bool)binaryOut, ratBand, maxOpenOutputs);
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *RasterGIS_CalcDistToNearestClumps(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    const char *inputImage, *outColName;
+    const char *targetCol = "";
+    const char *queryCol = "";
+    const char *outClumpCol = "";
+    int excludeSelf = true;
+    double maxDist = 0;
+    unsigned int ratBand = 1;
+    unsigned int numThreads = 0;
+    
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("clumps_img"), RSGIS_PY_C_TEXT("out_col"),
+                             RSGIS_PY_C_TEXT("target_col"), RSGIS_PY_C_TEXT("query_col"),
+                             RSGIS_PY_C_TEXT("exclude_self"), RSGIS_PY_C_TEXT("max_dist"),
+                             RSGIS_PY_C_TEXT("out_clump_col"), RSGIS_PY_C_TEXT("rat_band"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
+    
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ss|ssidsII:calc_dist_to_nearest_clumps", kwlist, &inputImage, &outColName, &targetCol, &queryCol, &excludeSelf, &maxDist, &outClumpCol, &ratBand, &numThreads))
+    {
+        return nullptr;
+    }
+    
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeCalcDistToNearestClumps(std::string(inputImage), std::string(outColName), std::string(targetCol), std::string(queryCol), (bool)excludeSelf, maxDist, std::string(outClumpCol), ratBand, numThreads);
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *RasterGIS_CalcClumpDistToClasses(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    const char *inputImage, *classCol, *outColPrefix;
+    double maxDist = 0;
+    unsigned int ratBand = 1;
+    unsigned int numThreads = 0;
     
-    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssiss|i:export_clumps_to_images", kwlist, &inputImage, &outputBaseName, &binaryOut, &outFileExt, &imageFormat, &ratBand))
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("clumps_img"), RSGIS_PY_C_TEXT("cls_col"),
+                             RSGIS_PY_C_TEXT("out_col_prefix"), RSGIS_PY_C_TEXT("max_dist"),
+                             RSGIS_PY_C_TEXT("rat_band"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
+    
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "sss|dII:calc_clump_dist_to_classes", kwlist, &inputImage, &classCol, &outColPrefix, &maxDist, &ratBand, &numThreads))
     {
         return nullptr;
     }
     
     try
     {
-        rsgis::cmds::executeExportClumps2Images(std::string(inputImage), std::string(outputBaseName), std::string(outFileExt), std::string(imageFormat), (bool)binaryOut, ratBand);
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeCalcClumpDistToClasses(std::string(inputImage), std::string(classCol), std::string(outColPrefix), maxDist, ratBand, numThreads);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
     {
@@ -1620,7 +2228,7 @@ static PyObject *RasterGIS_ExportClumps2Images(PyObject *self, PyObject *args, P
 
 static PyMethodDef RasterGISMethods[] = {
     {"pop_rat_img_stats", (PyCFunction)RasterGIS_PopulateStats, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.rastergis.pop_rat_img_stats(clumps_img=string, add_clr_tab=boolean, calc_pyramids=boolean, ignore_zero=boolean, rat_band=int)\n"
+"rsgislib.rastergis.pop_rat_img_stats(clumps_img=string, add_clr_tab=boolean, calc_pyramids=boolean, ignore_zero=boolean, rat_band=int, n_threads=int)\n"
 "Populates header statics (e.g., builds histogram) and pyramids for thematic images.\n"
 "Note, this function expects that the image file format supports a raster attribute table (RAT) so will therefore not work with formats such as GTIFF\n"
 "\n"
@@ -1629,6 +2237,7 @@ static PyMethodDef RasterGISMethods[] = {
 ":param calc_pyramids: is a boolean to specify where overview images could be created (Optional, default = True)\n"
 ":param ignore_zero: is a boolean specifying whether zero should be ignored (i.e., set as a no data value). (Optional, default = True)\n"
 ":param rat_band: is an optional (default = 1) integer parameter specifying the image band to which the RAT is associated.\n"
+":param n_threads: is the number of threads used to build the pyramids (Default: 1; 0 uses all the available cores)\n"
 "\n"
 ".. code:: python\n"
 "\n"
@@ -1654,6 +2263,25 @@ static PyMethodDef RasterGISMethods[] = {
 "   clumps = './RATS/injune_p142_casi_sub_utm_clumps_elim_final_clumps_elim_final.kea'\n"
 "   output_img = './TestOutputs/RasterGIS/injune_p142_casi_sub_utm_segs_cptab.kea'\n"
 "   rastergis.copy_rat(clumps, output_img)\n"
+"\n"},
+
+    {"rechunk_kea_rat", (PyCFunction)RasterGIS_RechunkKEARAT, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.rastergis.rechunk_kea_rat(input_img, output_img, chunk_size=0)\n"
+"Copies an image with a RAT to a new KEA image where the RAT is stored with a\n"
+"chunk size suited to its number of rows. Large RATs read and write far faster\n"
+"with larger chunks while small RATs are better with small chunks.\n"
+"\n"
+":param input_img: is a string containing the name and path for the input image with the RAT.\n"
+":param output_img: is a string containing the name and path for the output KEA image.\n"
+":param chunk_size: is an optional (default = 0) unsigned integer specifying the number of RAT rows\n"
+"                   per chunk. If 0 the chunk size is chosen from the number of rows in the RAT.\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   from rsgislib import rastergis\n"
+"   clumps_img = 'clumps.kea'\n"
+"   output_img = 'clumps_rechunked.kea'\n"
+"   rastergis.rechunk_kea_rat(clumps_img, output_img)\n"
 "\n"},
 
 {"copy_gdal_rat_columns", (PyCFunction)RasterGIS_CopyGDALATTColumns, METH_VARARGS | METH_KEYWORDS,
@@ -1762,6 +2390,44 @@ static PyMethodDef RasterGISMethods[] = {
 "	bs.append(rastergis.BandAttStats(band=2, min_field='b2Min', max_field='b2Max', mean_field='b2Mean', sum_field='b2Sum', std_dev_field='b2StdDev'))\n"
 "	bs.append(rastergis.BandAttStats(band=3, min_field='b3Min', max_field='b3Max', mean_field='b3Mean', sum_field='b3Sum', std_dev_field='b3StdDev'))\n"
 "	rastergis.populate_rat_with_stats(input, clumps, bs)\n"
+"\n"},
+
+    {"populate_rat_with_stats_single_pass", (PyCFunction)RasterGIS_PopulateRATWithStatsSinglePass, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.rastergis.populate_rat_with_stats_single_pass(input_img=string, clumps_img=string, band_stats=rsgislib.rastergis.BandAttStats, rat_band=int, n_threads=int)\n"
+"Populates an attribute table with any mix of the min, max, mean, standard deviation, sum, count, mode and percentiles\n"
+"for each band of the input values image, reading the images once for all the statistics (rather than once for each\n"
+"statistic as populate_rat_with_stats and populate_rat_with_percentiles do). No data pixels are ignored and the mean\n"
+"and standard deviation are calculated from the valid pixels. Clumps with no valid pixels are given a value of zero.\n"
+"\n"
+":param input_img: is a string containing the name of the input image file from which the clumps are to populated.\n"
+":param clumps_img: is a string containing the name of the input clumps image file\n"
+":param band_stats: is a sequence of rsgislib.rastergis.BandAttStats objects that have attributes in line with rsgis.cmds.RSGISBandAttStatsCmds\n"
+"        * band: int defining the image band to process\n"
+"        * min_field: string defining the name of the field for min value\n"
+"        * max_field: string defining the name of the field for max value\n"
+"        * sum_field: string defining the name of the field for sum value\n"
+"        * mean_field: string defining the name of the field for mean value\n"
+"        * std_dev_field: string defining the name of the field for standard deviation value\n"
+"        * count_field: string defining the name of the field for the number of valid pixels\n"
+"        * mode_field: string defining the name of the field for the mode value\n"
+"        * percentiles: list of rsgislib.rastergis.BandAttPercentiles objects defining the percentiles to calculate\n"
+"        * hist_min: float defining the minimum of the histogram used for the mode and percentiles (if hist_min and hist_max are None the range of the band is used)\n"
+"        * hist_max: float defining the maximum of the histogram used for the mode and percentiles\n"
+"        * n_hist_bins: int defining the number of bins within the histogram (Default: 200). The mode and percentiles are the centre of a histogram bin.\n"
+":param rat_band: is an optional (default = 1) integer parameter specifying the image band to which the RAT is associated.\n"
+":param n_threads: is the number of threads used to process each strip of the image (Default: 1; 0 uses all the available cores).\n"
+"                  Each thread holds its own copy of the per clump statistics (and histograms) so the memory required\n"
+"                  increases with the number of threads.\n"
+"\n"
+".. code:: python\n"
+"\n"
+"	from rsgislib import rastergis\n"
+"	clumps='./TestOutputs/RasterGIS/injune_p142_casi_sub_utm_segs_popstats.kea'\n"
+"	input='./Rasters/injune_p142_casi_sub_utm.kea'\n"
+"	bs = []\n"
+"	bs.append(rastergis.BandAttStats(band=1, min_field='b1Min', max_field='b1Max', mean_field='b1Mean', std_dev_field='b1StdDev', count_field='b1Count'))\n"
+"	bs.append(rastergis.BandAttStats(band=2, mean_field='b2Mean', percentiles=[rastergis.BandAttPercentiles(25, 'b2P25'), rastergis.BandAttPercentiles(75, 'b2P75')], hist_min=0, hist_max=1000, n_hist_bins=1000))\n"
+"	rastergis.populate_rat_with_stats_single_pass(input, clumps, bs, n_threads=4)\n"
 "\n"},
 
     {"populate_rat_with_percentiles", (PyCFunction)RasterGIS_PopulateRATWithPercentiles, METH_VARARGS | METH_KEYWORDS,
@@ -2093,6 +2759,30 @@ static PyMethodDef RasterGISMethods[] = {
 "   rastergis.import_vec_atts(clumps, vectorFile, veclyr, 'pxlval', None)\n"
 "\n"},
 
+{"import_vec_atts_by_overlap", (PyCFunction)RasterGIS_ImportVecAttsByOverlap, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.rastergis.import_vec_atts_by_overlap(clumps_img, vec_file, vec_lyr, col_names=None, min_prop_overlap=0.0, out_fid_col='', rat_band=1)\n"
+"Copies the attributes from an input polygon vector layer to the RAT, where each clump takes the attributes\n"
+"of the polygon which covers most of its pixels (a pixel is within a polygon if its centre is within the\n"
+"polygon). Unlike import_vec_atts the features do not need a column of clump IDs; the polygons are\n"
+"rasterised once on to the clumps image, which is read once.\n"
+"\n"
+":param clumps_img: is a string containing the name of the input file with RAT\n"
+":param vec_file: is a string containing the file path of the input vector file\n"
+":param vec_lyr: is a string containing the layer name within the input vector file\n"
+":param col_names: is a list of strings specifying the columns to be copied to the RAT. If 'None' then all attributes will be copied.\n"
+":param min_prop_overlap: is the minimum proportion (0-1) of the pixels of a clump which the polygon must cover for the clump to take its attributes. Clumps without a polygon have the value 0 (or an empty string).\n"
+":param out_fid_col: is an optional string with the name of a column to which the FID of the polygon (or -1) is written.\n"
+":param rat_band: is an optional (default = 1) integer parameter specifying the image band to which the RAT is associated.\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   from rsgislib import rastergis\n"
+"   clumps = 'clumpsFiles.kea'\n"
+"   vectorFile = 'parcels.gpkg'\n"
+"   veclyr = 'parcels'\n"
+"   rastergis.import_vec_atts_by_overlap(clumps, vectorFile, veclyr, ['crop_type'], min_prop_overlap=0.5, out_fid_col='parcel_fid')\n"
+"\n"},
+
 {"apply_rat_knn", (PyCFunction)RasterGIS_ApplyKNN, METH_VARARGS | METH_KEYWORDS,
 "rsgislib.rastergis.apply_rat_knn(clumps_img=string, in_extrap_col=string, out_extrap_col=string, train_regions_col=string, apply_regions_col=string, val_cols=list<string>, k_feat=uint, dist_knn=int, summerise_knn=int, dist_thres=float, rat_band=int)\n"
 "This function uses the KNN algorithm to allow data values to be extrapolated to segments.\n"
@@ -2242,9 +2932,53 @@ static PyMethodDef RasterGISMethods[] = {
 ":return: double for distance\n"
 "\n"},
 
+{"calc_separabilities", (PyCFunction)RasterGIS_CalcSeparabilities, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.rastergis.calc_separabilities(clumps_img=string, sep_calcs=list, rat_band=uint, n_threads=uint)\n"
+"Calculate a batch of Jeffries and Matusita (1D or 2D) and Bhattacharyya distances between classes (e.g., for\n"
+"feature selection). Each column is read once and the values of each class are shared by the calculations,\n"
+"which are calculated in parallel. The distances are the same as those from calc_1d_jm_distance,\n"
+"calc_2d_jm_distance and calc_bhattacharyya_distance.\n"
+"\n"
+":param clumps_img: is a string containing the name of the input clump file\n"
+":param sep_calcs: is a list of rsgislib.rastergis.SeparabilityCalc objects defining the distances to calculate.\n"
+":param rat_band: is an optional (default = 1) integer parameter specifying the image band to which the RAT is associated in the clumps image.\n"
+":param n_threads: is an optional (default = 0, the number of available cores) number of threads used to calculate the distances.\n"
+"\n"
+":return: list of the distances (in the order of sep_calcs)\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   import rsgislib.rastergis\n"
+"   sep_calcs = []\n"
+"   for col in ['b1_mean', 'b2_mean', 'b3_mean']:\n"
+"       sep_calcs.append(rsgislib.rastergis.SeparabilityCalc(rsgislib.rastergis.SEP_JM_1D, col, 'class_names', 'Forest', 'Grass', val1_bin_width=2))\n"
+"   dists = rsgislib.rastergis.calc_separabilities('clumps.kea', sep_calcs)\n"
+"\n"},
+
+{"get_column_summary", (PyCFunction)RasterGIS_GetColumnSummary, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.rastergis.get_column_summary(clumps_img=string, col_name=string, cls_col=string, cls_val=string, rat_band=int)\n"
+"Get the summary of the finite values of a RAT column (from row 1, as row 0 is the no data clump), optionally\n"
+"only for the rows of a class. The summary is stored in the metadata of the RAT band (if the image can be\n"
+"opened for update) and is only calculated again if the column has been changed.\n"
+"\n"
+":param clumps_img: is a string containing the name of the input clump file\n"
+":param col_name: is a string containing the name of the column\n"
+":param cls_col: is an optional string containing the name of the class column (default is no class restriction)\n"
+":param cls_val: is an optional string specifying the class the summary is limited to\n"
+":param rat_band: is an optional (default = 1) integer parameter specifying the image band to which the RAT is associated in the clumps image.\n"
+"\n"
+":return: tuple (min, max, mean, n_vals, hist_counts) where hist_counts is a list of the counts of 64 equal width bins from min to max.\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   import rsgislib.rastergis\n"
+"   min_val, max_val, mean_val, n_vals, hist = rsgislib.rastergis.get_column_summary('clumps.kea', 'NDVI')\n"
+"\n"},
+
 {"export_clumps_to_images", (PyCFunction)RasterGIS_ExportClumps2Images, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.rastergis.export_clumps_to_images(clumps_img, out_img_base, bin_out, out_img_ext, gdalformat, rat_band=1)\n"
-"Exports each clump to a seperate raster which is the minimum extent for the clump.\n"
+"rsgislib.rastergis.export_clumps_to_images(clumps_img, out_img_base, bin_out, out_img_ext, gdalformat, rat_band=1, max_open_outputs=256)\n"
+"Exports each clump to a seperate raster which is the minimum extent for the clump. The clumps image is read\n"
+"once for each set of max_open_outputs output images which are open (i.e., being written) at the same time.\n"
 "\n"
 ":param clumps_img: is a string containing the name of the input image file with RAT\n"
 ":param out_img_base: is a string containing the base name of the output image file (C + FID will be added to identify files).\n"
@@ -2252,6 +2986,7 @@ static PyMethodDef RasterGISMethods[] = {
 ":param out_img_ext: is a sting with the output file extension (e.g., kea) without the preceeding dot to be appended to the file name.\n"
 ":param gdalformat: is a string containing the GDAL format for the output file - eg 'KEA'\n"
 ":param rat_band: is an optional (default = 1) integer parameter specifying the image band to which the RAT is associated.\n"
+":param max_open_outputs: is an optional (default = 256) maximum number of output images which are open at the same time.\n"
 "\n"
 ".. code:: python\n"
 "\n"
@@ -2263,6 +2998,91 @@ static PyMethodDef RasterGISMethods[] = {
 "   gdalformat = 'KEA'\n"
 "   binaryOut = False\n"
 "   rastergis.export_clumps_to_images(clumps, outimgbase, binaryOut, outimgext, gdalformat, rat_band)\n"
+"\n"},
+
+{"calc_dist_to_nearest_clumps", (PyCFunction)RasterGIS_CalcDistToNearestClumps, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.rastergis.calc_dist_to_nearest_clumps(clumps_img, out_col, target_col='', query_col='', exclude_self=True, max_dist=0, out_clump_col='', rat_band=1, n_threads=0)\n"
+"Calculates the distance from each clump to the nearest (target) clump, where the distance is the shortest\n"
+"distance between the pixels of the clumps (in the units of the image pixel size), so is 0 for clumps which\n"
+"touch. The boundary pixels of the clumps are found with a single read of the image and held in a kd-tree,\n"
+"so no vector polygons are created.\n"
+"\n"
+":param clumps_img: is a string containing the name of the input clumps image file with RAT\n"
+":param out_col: is a string with the name of the output column for the distances.\n"
+":param target_col: is an optional integer column where the clumps with a non-zero value are the targets (default '' is all the clumps).\n"
+":param query_col: is an optional integer column where the clumps with a non-zero value have their distance calculated (default '' is all the clumps). The other clumps have a distance of 0.\n"
+":param exclude_self: is an optional boolean (default = True) specifying that the distance to a clump itself is not used (otherwise a target clump has a distance of 0).\n"
+":param max_dist: is an optional maximum distance (default = 0 is no maximum). Clumps without a target within max_dist have a distance of max_dist (or -1 if there is no maximum or no target).\n"
+":param out_clump_col: is an optional column for the FID of the nearest target clump (0 if there is none).\n"
+":param rat_band: is an optional (default = 1) integer parameter specifying the image band to which the RAT is associated.\n"
+":param n_threads: is an optional number of threads (default = 0 uses all the available cores).\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   import rsgislib.rastergis\n"
+"   rsgislib.rastergis.calc_dist_to_nearest_clumps('clumps.kea', 'DistWater', target_col='Water', out_clump_col='NearWater')\n"
+"\n"},
+
+{"calc_clump_dist_to_classes", (PyCFunction)RasterGIS_CalcClumpDistToClasses, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.rastergis.calc_clump_dist_to_classes(clumps_img, cls_col, out_col_prefix, max_dist=0, rat_band=1, n_threads=0)\n"
+"Calculates the distance from each clump to the nearest clump of each class (the non-zero values of an integer\n"
+"column), creating a column per class named out_col_prefix + the class value. The clumps of a class have a distance\n"
+"of 0 to that class. The clumps image is only read once for all the classes.\n"
+"\n"
+":param clumps_img: is a string containing the name of the input clumps image file with RAT\n"
+":param cls_col: is a string with the name of the integer class column.\n"
+":param out_col_prefix: is a string with the prefix of the output columns.\n"
+":param max_dist: is an optional maximum distance (default = 0 is no maximum). Clumps without a class clump within max_dist have a distance of max_dist (or -1 if there is no maximum or no clump of the class).\n"
+":param rat_band: is an optional (default = 1) integer parameter specifying the image band to which the RAT is associated.\n"
+":param n_threads: is an optional number of threads (default = 0 uses all the available cores).\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   import rsgislib.rastergis\n"
+"   rsgislib.rastergis.calc_clump_dist_to_classes('clumps.kea', 'ClassInt', 'Dist2Cls')\n"
+"\n"},
+
+{"read_rat_col_chunk", (PyCFunction)RasterGIS_ReadRATColChunk, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.rastergis.read_rat_col_chunk(clumps_img, col_name, out_arr, start_row=0, rat_band=1)\n"
+"Reads len(out_arr) rows of a RAT column, from start_row, directly into out_arr so a large column can be\n"
+"processed in chunks without reading it all to memory or copying it. The values are converted to the type of\n"
+"out_arr.\n"
+"\n"
+":param clumps_img: is a string containing the name of the input clumps image file with RAT\n"
+":param col_name: is a string with the name of the column to be read.\n"
+":param out_arr: is a C contiguous, writable numpy array (numpy.float64 or numpy.int32) into which the values are read.\n"
+":param start_row: is an optional (default = 0) integer with the first row to be read.\n"
+":param rat_band: is an optional (default = 1) integer parameter specifying the image band to which the RAT is associated.\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   import numpy\n"
+"   import rsgislib.rastergis\n"
+"   n_rows = rsgislib.rastergis.get_rat_length('clumps.kea')\n"
+"   chunk = numpy.zeros(1000000, dtype=numpy.float64)\n"
+"   for start_row in range(0, n_rows, chunk.shape[0]):\n"
+"       chunk_arr = chunk[:min(chunk.shape[0], n_rows - start_row)]\n"
+"       rsgislib.rastergis.read_rat_col_chunk('clumps.kea', 'NDVI', chunk_arr, start_row)\n"
+"\n"},
+
+{"write_rat_col_chunk", (PyCFunction)RasterGIS_WriteRATColChunk, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.rastergis.write_rat_col_chunk(clumps_img, col_name, in_arr, start_row=0, rat_band=1)\n"
+"Writes the values of in_arr to len(in_arr) rows of a RAT column, from start_row, directly from the array so a\n"
+"large column can be written in chunks. If the column does not exist it is created, as a real column for a\n"
+"numpy.float64 array and an integer column for a numpy.int32 array.\n"
+"\n"
+":param clumps_img: is a string containing the name of the input clumps image file with RAT\n"
+":param col_name: is a string with the name of the column to be written.\n"
+":param in_arr: is a C contiguous numpy array (numpy.float64 or numpy.int32) with the values to be written.\n"
+":param start_row: is an optional (default = 0) integer with the first row to be written.\n"
+":param rat_band: is an optional (default = 1) integer parameter specifying the image band to which the RAT is associated.\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   import numpy\n"
+"   import rsgislib.rastergis\n"
+"   vals = numpy.ones(1000, dtype=numpy.int32)\n"
+"   rsgislib.rastergis.write_rat_col_chunk('clumps.kea', 'Flag', vals, start_row=1)\n"
 "\n"},
     
     {nullptr}        /* Sentinel */
@@ -117,5 +117,80 @@ inline double RSGISPY_FLOAT_EXTRACT(PyObject *o)
 #endif
 }
 
+// Releases the global interpreter lock (GIL) while the object is in scope so
+// other Python threads can run during a long running C++ command. All the
+// Python arguments must be converted before it is created and no Python API
+// functions can be called until it is destroyed. If the command throws, the
+// GIL is reacquired as the stack unwinds, before the exception is handled.
+class RSGISPyReleaseGIL
+{
+public:
+    RSGISPyReleaseGIL(){this->threadState = PyEval_SaveThread();};
+    ~RSGISPyReleaseGIL(){PyEval_RestoreThread(this->threadState);};
+private:
+    RSGISPyReleaseGIL(const RSGISPyReleaseGIL&);
+    RSGISPyReleaseGIL& operator=(const RSGISPyReleaseGIL&);
+    PyThreadState *threadState;
+};
+
+// Holds a view of the memory of an object supporting the buffer protocol
+// (e.g., a numpy array) so it can be passed to the C++ code without a copy.
+// The memory must be C contiguous with items of the type given by format
+// ('f' float32, 'd' float64, 'i' int32 or 'I' uint32). The view is released when
+// the object goes out of scope, which must be while the GIL is held.
+class RSGISPyArrayBuffer
+{
+public:
+    RSGISPyArrayBuffer(){this->acquired = false;};
+    // Returns false, with the Python exception set, if the buffer cannot be used.
+    // A view already held is released first, so another format can be tried.
+    bool getBuffer(PyObject *obj, char format, bool writable, PyObject *error, const char *name)
+    {
+        if(this->acquired)
+        {
+            PyBuffer_Release(&this->view);
+            this->acquired = false;
+        }
+        int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT;
+        if(writable)
+        {
+            flags = flags | PyBUF_WRITABLE;
+        }
+        if(PyObject_GetBuffer(obj, &this->view, flags) != 0)
+        {
+            PyErr_Clear();
+            std::string message = std::string("'") + name + std::string("' needs to be a C contiguous") + (writable?std::string(", writable"):std::string("")) + std::string(" array.");
+            PyErr_SetString(error, message.c_str());
+            return false;
+        }
+        this->acquired = true;
+        
+        size_t itemSize = (format == 'd')?8:4;
+        const char *fmt = (this->view.format == nullptr)?"B":this->view.format;
+        if((fmt[0] == '@') || (fmt[0] == '=') || (fmt[0] == '<'))
+        {
+            ++fmt;
+        }
+        bool formatMatch = (fmt[0] == format) || ((format == 'I') && (fmt[0] == 'L')) || ((format == 'i') && (fmt[0] == 'l'));
+        if(!formatMatch || (fmt[1] != '\0') || (((size_t)this->view.itemsize) != itemSize))
+        {
+            std::string typeName = (format == 'f')?"float32":((format == 'd')?"float64":((format == 'i')?"int32":"uint32"));
+            std::string message = std::string("'") + name + std::string("' needs to be an array of ") + typeName + std::string(" values.");
+            PyErr_SetString(error, message.c_str());
+            return false;
+        }
+        return true;
+    };
+    void* getData(){return this->view.buf;};
+    int getNumDims(){return this->view.ndim;};
+    size_t getDimSize(int i){return this->view.shape[i];};
+    size_t getNumItems(){return this->view.len / this->view.itemsize;};
+    ~RSGISPyArrayBuffer(){if(this->acquired){PyBuffer_Release(&this->view);}};
+private:
+    RSGISPyArrayBuffer(const RSGISPyArrayBuffer&);
+    RSGISPyArrayBuffer& operator=(const RSGISPyArrayBuffer&);
+    Py_buffer view;
+    bool acquired;
+};
 
 #endif // RSGISPY_COMMON_H
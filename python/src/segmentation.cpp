@@ -53,6 +53,7 @@ static PyObject *Segmentation_labelPixelsFromClusterCentres(PyObject *self, PyOb
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeLabelPixelsFromClusterCentres(std::string(pszInputImage), std::string(pszOutputImage),
                                                           std::string(pszClusterCentres),ignoreZeros,
                                                           std::string(pszgdalformat) );
@@ -83,6 +84,7 @@ static PyObject *Segmentation_eliminateSinglePixels(PyObject *self, PyObject *ar
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeEliminateSinglePixels(std::string(pszInputImage), std::string(pszClumpsImage),
                                                   std::string(pszOutputImage), std::string(pszTempImage),
                                                   std::string(pszgdalformat), processInMemory, ignoreZeros);
@@ -101,14 +103,16 @@ static PyObject *Segmentation_clump(PyObject *self, PyObject *args, PyObject *ke
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"),
                              RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("in_memory"),
-                             RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("add_to_rat"),  nullptr};
+                             RSGIS_PY_C_TEXT("no_data_val"), RSGIS_PY_C_TEXT("add_to_rat"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *pszInputImage, *pszOutputImage, *pszgdalformat;
     int processInMemory = false;
     bool nodataprovided;
     float fnodata;
     int addRatPxlVals = false;
+    unsigned int nThreads = 1;
     PyObject *pNoData = Py_None; //could be none or a number
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sss|iOi:clump", kwlist, &pszInputImage, &pszOutputImage, &pszgdalformat, &processInMemory, &pNoData, &addRatPxlVals))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sss|iOiI:clump", kwlist, &pszInputImage, &pszOutputImage, &pszgdalformat, &processInMemory, &pNoData, &addRatPxlVals, &nThreads))
     {
         return nullptr;
     }
@@ -135,8 +139,9 @@ static PyObject *Segmentation_clump(PyObject *self, PyObject *args, PyObject *ke
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeClump(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszgdalformat),
-                                processInMemory, nodataprovided, fnodata, addRatPxlVals);
+                                processInMemory, nodataprovided, fnodata, addRatPxlVals, nThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -167,6 +172,7 @@ static PyObject *Segmentation_RMSmallClumpsStepwise(PyObject *self, PyObject *ar
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeRMSmallClumpsStepwise(std::string(pszInputImage), std::string(pszClumpsImage),
                                                   std::string(pszOutputImage), std::string(pszgdalformat),
                                                   stretchStatsAvail, pszStretchStatsFile, storeMean,
@@ -196,6 +202,7 @@ static PyObject *Segmentation_relabelClumps(PyObject *self, PyObject *args, PyOb
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeRelabelClumps(std::string(pszInputImage), std::string(pszOutputImage),
                                           std::string(pszgdalformat), processInMemory);
     }
@@ -213,7 +220,8 @@ static PyObject *Segmentation_unionOfClumps(PyObject *self, PyObject *args, PyOb
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_imgs"), RSGIS_PY_C_TEXT("output_img"),
                              RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("no_data_val"),
-                             RSGIS_PY_C_TEXT("add_to_rat"), nullptr};
+                             RSGIS_PY_C_TEXT("add_to_rat"), RSGIS_PY_C_TEXT("tuple_ids"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *pszOutputImage, *pszgdalformat;
     std::string inputImage;
     bool nodataprovided;
@@ -221,7 +229,9 @@ static PyObject *Segmentation_unionOfClumps(PyObject *self, PyObject *args, PyOb
     PyObject *pNoData; //could be none or a number
     PyObject *pInputListObj;
     int addRatPxlVals = false;
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "OssOi:union_of_clumps", kwlist, &pInputListObj, &pszOutputImage, &pszgdalformat, &pNoData, &addRatPxlVals))
+    int tupleIDs = false;
+    unsigned int nThreads = 1;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "OssOi|iI:union_of_clumps", kwlist, &pInputListObj, &pszOutputImage, &pszgdalformat, &pNoData, &addRatPxlVals, &tupleIDs, &nThreads))
     {
         return nullptr;
     }
@@ -273,8 +283,9 @@ static PyObject *Segmentation_unionOfClumps(PyObject *self, PyObject *args, PyOb
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeUnionOfClumps(inputImagePaths, std::string(pszOutputImage),
-                                          std::string(pszgdalformat), nodataprovided, fnodata, addRatPxlVals);
+                                          std::string(pszgdalformat), nodataprovided, fnodata, addRatPxlVals, tupleIDs, nThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -329,6 +340,7 @@ static PyObject *Segmentation_mergeSegmentationTiles(PyObject *self, PyObject *a
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeMergeSegmentationTiles(std::string(pszOutputImage), std::string(pszBorderMaskImage),
                                                    inputImagePaths, tileBoundary, tileOverlap, tileBody, std::string(pszColsName));
     }
@@ -380,6 +392,7 @@ static PyObject *Segmentation_mergeClumpImages(PyObject *self, PyObject *args, P
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeMergeClumpImages(inputImagePaths, std::string(pszOutputImage), mergeRATs);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -435,6 +448,7 @@ static PyObject *Segmentation_findTileBordersMask(PyObject *self, PyObject *args
     try
     {
 
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeFindTileBordersMask(inputImagePaths, std::string(pszBorderMaskImage),
                         tileBoundary, tileOverlap, tileBody, std::string(pszColsName));
 
@@ -462,6 +476,7 @@ static PyObject *Segmentation_rmSmallClumps(PyObject *self, PyObject *args, PyOb
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeRMSmallClumps(std::string(pszInputClumps), std::string(pszOutputClumps), areaThreshold, std::string(pszgdalformat));
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -478,19 +493,51 @@ static PyObject *Segmentation_meanImage(PyObject *self, PyObject *args, PyObject
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("clumps_img"),
                              RSGIS_PY_C_TEXT("output_img"),  RSGIS_PY_C_TEXT("gdalformat"),
-                             RSGIS_PY_C_TEXT("datatype"), nullptr};
+                             RSGIS_PY_C_TEXT("datatype"), RSGIS_PY_C_TEXT("mean_cols"), nullptr};
     const char *pszInputImage, *pszInputClumps, *pszOutputImage, *pszgdalformat;
     int nDataType;
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssssi:mean_image", kwlist, &pszInputImage, &pszInputClumps, &pszOutputImage, &pszgdalformat, &nDataType))
+    PyObject *meanColsObj = Py_None;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "zsssi|O:mean_image", kwlist, &pszInputImage, &pszInputClumps, &pszOutputImage, &pszgdalformat, &nDataType, &meanColsObj))
     {
         return nullptr;
     }
 
+    std::vector<std::string> meanCols;
+    if(meanColsObj != Py_None)
+    {
+        if(!PySequence_Check(meanColsObj))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "'mean_cols' must be a list of strings");
+            return nullptr;
+        }
+        Py_ssize_t nMeanCols = PySequence_Size(meanColsObj);
+        for(Py_ssize_t n = 0; n < nMeanCols; n++)
+        {
+            PyObject *strObj = PySequence_GetItem(meanColsObj, n);
+            if( !RSGISPY_CHECK_STRING(strObj) )
+            {
+                PyErr_SetString(GETSTATE(self)->error, "'mean_cols' must be a list of strings");
+                Py_XDECREF(strObj);
+                return nullptr;
+            }
+            meanCols.push_back(RSGISPY_STRING_EXTRACT(strObj));
+            Py_DECREF(strObj);
+        }
+    }
+    if(meanCols.empty() && (pszInputImage == nullptr))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "'input_img' must be given unless the means are read from 'mean_cols'");
+        return nullptr;
+    }
+
     try
     {
         rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
-        rsgis::cmds::executeMeanImage(std::string(pszInputImage), std::string(pszInputClumps), std::string(pszOutputImage),
-                                      std::string(pszgdalformat), type, false);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeMeanImage((pszInputImage == nullptr)?std::string(""):std::string(pszInputImage), std::string(pszInputClumps), std::string(pszOutputImage),
+                                          std::string(pszgdalformat), type, false, meanCols);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -517,6 +564,7 @@ static PyObject *Segmentation_GenerateRegularGrid(PyObject *self, PyObject *args
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeGenerateRegularGrid(std::string(pszInputImage), std::string(pszOutputImage),
                                                 std::string(pszgdalformat), numXPxls, numYPxls, (bool)offset);
     }
@@ -543,6 +591,7 @@ static PyObject *Segmentation_IncludeRegionsInClumps(PyObject *self, PyObject *a
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeIncludeClumpedRegion(std::string(pszClumpsImage), std::string(pszRegionsImage),
                                                  std::string(pszOutputImage), std::string(pszgdalformat));
     }
@@ -569,6 +618,7 @@ static PyObject *Segmentation_mergeSegments2Neighbours(PyObject *self, PyObject
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeMergeSelectClumps2Neighbour(std::string(pszInputSpecImage), std::string(pszInputClumpsImage),
                                                         std::string(pszOutputImage), std::string(pszgdalformat),
                                                         std::string(selectClumpsCol), std::string(noDataClumpsCol));
@@ -595,6 +645,7 @@ static PyObject *Segmentation_dropSelectedSegments(PyObject *self, PyObject *arg
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeDropSelectedClumps(std::string(pszInputClumpsImage), std::string(pszOutputImage),
                                                std::string(pszgdalformat), std::string(selectClumpsCol));
     }
@@ -641,6 +692,7 @@ static PyObject *Segmentation_mergeEquivalentClumps(PyObject *self, PyObject *ar
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeMergeClumpsEquivalentVal(std::string(pszInputClumpsImage), std::string(pszOutputImage),
                                                      std::string(pszgdalformat), cols);
     }
@@ -654,6 +706,272 @@ static PyObject *Segmentation_mergeEquivalentClumps(PyObject *self, PyObject *ar
 }
 
 
+static PyObject *Segmentation_createSegTilePlan(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("clusters_img"), RSGIS_PY_C_TEXT("spectral_img"),
+                             RSGIS_PY_C_TEXT("manifest_file"), RSGIS_PY_C_TEXT("tiles_base"),
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("out_file_ext"),
+                             RSGIS_PY_C_TEXT("tile_x_size"), RSGIS_PY_C_TEXT("tile_y_size"),
+                             RSGIS_PY_C_TEXT("tile_overlap"), nullptr};
+    const char *pszClustersImage, *pszSpectralImage, *pszManifestFile, *pszTilesBase, *pszgdalformat, *pszOutFileExt;
+    unsigned int tileXSize, tileYSize, tileOverlap;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssssssIII:create_seg_tile_plan", kwlist, &pszClustersImage, &pszSpectralImage,
+                                     &pszManifestFile, &pszTilesBase, &pszgdalformat, &pszOutFileExt, &tileXSize, &tileYSize, &tileOverlap))
+    {
+        return nullptr;
+    }
+
+    unsigned int numJobs = 0;
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        numJobs = rsgis::cmds::executeCreateSegTilePlan(std::string(pszClustersImage), std::string(pszSpectralImage),
+                                                        std::string(pszManifestFile), std::string(pszTilesBase),
+                                                        std::string(pszgdalformat), std::string(pszOutFileExt),
+                                                        tileXSize, tileYSize, tileOverlap);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    return Py_BuildValue("I", numJobs);
+}
+
+static PyObject *Segmentation_runSegTileJob(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("manifest_file"), RSGIS_PY_C_TEXT("job_id"),
+                             RSGIS_PY_C_TEXT("min_clump_size"), RSGIS_PY_C_TEXT("pxl_val_thres"),
+                             RSGIS_PY_C_TEXT("use_stch_stats"), RSGIS_PY_C_TEXT("stch_stats_file"),
+                             RSGIS_PY_C_TEXT("in_memory"), nullptr};
+    const char *pszManifestFile;
+    const char *pszStretchStatsFile = "";
+    unsigned int jobID, minClumpSize;
+    float specThreshold;
+    int stretchStatsAvail = false;
+    int processInMemory = false;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sIIf|isi:run_seg_tile_job", kwlist, &pszManifestFile, &jobID, &minClumpSize,
+                                     &specThreshold, &stretchStatsAvail, &pszStretchStatsFile, &processInMemory))
+    {
+        return nullptr;
+    }
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeSegTileJob(std::string(pszManifestFile), jobID, minClumpSize, specThreshold,
+                                       stretchStatsAvail, std::string(pszStretchStatsFile), processInMemory);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *Segmentation_runSegTileJobs(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("manifest_file"), RSGIS_PY_C_TEXT("min_clump_size"),
+                             RSGIS_PY_C_TEXT("pxl_val_thres"), RSGIS_PY_C_TEXT("use_stch_stats"),
+                             RSGIS_PY_C_TEXT("stch_stats_file"), RSGIS_PY_C_TEXT("in_memory"),
+                             RSGIS_PY_C_TEXT("n_threads"), RSGIS_PY_C_TEXT("job_ids"), nullptr};
+    const char *pszManifestFile;
+    const char *pszStretchStatsFile = "";
+    unsigned int minClumpSize;
+    float specThreshold;
+    int stretchStatsAvail = false;
+    int processInMemory = false;
+    unsigned int numThreads = 0;
+    PyObject *jobIDsObj = Py_None;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sIf|isiIO:run_seg_tile_jobs", kwlist, &pszManifestFile, &minClumpSize,
+                                     &specThreshold, &stretchStatsAvail, &pszStretchStatsFile, &processInMemory,
+                                     &numThreads, &jobIDsObj))
+    {
+        return nullptr;
+    }
+
+    std::vector<unsigned int> jobIDs;
+    if(jobIDsObj != Py_None)
+    {
+        if(!PySequence_Check(jobIDsObj))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "'job_ids' needs to be a sequence of integers.");
+            return nullptr;
+        }
+        Py_ssize_t nJobs = PySequence_Size(jobIDsObj);
+        for(Py_ssize_t i = 0; i < nJobs; ++i)
+        {
+            PyObject *jobIDObj = PySequence_GetItem(jobIDsObj, i);
+            if(!RSGISPY_CHECK_INT(jobIDObj))
+            {
+                Py_DECREF(jobIDObj);
+                PyErr_SetString(GETSTATE(self)->error, "'job_ids' needs to be a sequence of integers.");
+                return nullptr;
+            }
+            jobIDs.push_back(RSGISPY_UINT_EXTRACT(jobIDObj));
+            Py_DECREF(jobIDObj);
+        }
+    }
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeRunSegTileJobs(std::string(pszManifestFile), jobIDs, minClumpSize, specThreshold,
+                                           stretchStatsAvail, std::string(pszStretchStatsFile), processInMemory, numThreads);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *Segmentation_mergeSegTilePlan(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("manifest_file"), RSGIS_PY_C_TEXT("output_img"),
+                             RSGIS_PY_C_TEXT("min_clump_size"), RSGIS_PY_C_TEXT("pxl_val_thres"),
+                             RSGIS_PY_C_TEXT("use_stch_stats"), RSGIS_PY_C_TEXT("stch_stats_file"),
+                             RSGIS_PY_C_TEXT("in_memory"), nullptr};
+    const char *pszManifestFile, *pszOutputImage;
+    const char *pszStretchStatsFile = "";
+    unsigned int minClumpSize;
+    float specThreshold;
+    int stretchStatsAvail = false;
+    int processInMemory = false;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ssIf|isi:merge_seg_tile_plan", kwlist, &pszManifestFile, &pszOutputImage, &minClumpSize,
+                                     &specThreshold, &stretchStatsAvail, &pszStretchStatsFile, &processInMemory))
+    {
+        return nullptr;
+    }
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeMergeSegTilePlan(std::string(pszManifestFile), std::string(pszOutputImage), minClumpSize, specThreshold,
+                                             stretchStatsAvail, std::string(pszStretchStatsFile), processInMemory);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *Segmentation_runShepherdSegmentation(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("out_clumps_img"),
+                             RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("bands"),
+                             RSGIS_PY_C_TEXT("no_stretch"), RSGIS_PY_C_TEXT("num_clusters"),
+                             RSGIS_PY_C_TEXT("min_n_pxls"), RSGIS_PY_C_TEXT("dist_thres"),
+                             RSGIS_PY_C_TEXT("sampling"), RSGIS_PY_C_TEXT("km_max_iter"),
+                             RSGIS_PY_C_TEXT("calc_stats"), RSGIS_PY_C_TEXT("img_stretch_stats"),
+                             RSGIS_PY_C_TEXT("kmeans_centres"), RSGIS_PY_C_TEXT("max_mem_mb"),
+                             RSGIS_PY_C_TEXT("tmp_dir"), nullptr};
+    const char *pszInputImage, *pszOutputImage;
+    const char *pszGDALFormat = "KEA";
+    const char *pszStretchStatsFile = "";
+    const char *pszKMeansCentresFile = "";
+    const char *pszTmpDir = ".";
+    PyObject *imgBandsObj = Py_None;
+    int noStretch = false;
+    unsigned int numClusters = 60;
+    unsigned int minClumpPxls = 100;
+    float specDistThres = 100;
+    unsigned int subSample = 100;
+    unsigned int maxKMeansIter = 200;
+    int calcStats = true;
+    unsigned long maxMemMB = 0;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "ss|sOiIIfIIissks:run_shepherd_segmentation", kwlist, &pszInputImage, &pszOutputImage,
+                                     &pszGDALFormat, &imgBandsObj, &noStretch, &numClusters, &minClumpPxls, &specDistThres,
+                                     &subSample, &maxKMeansIter, &calcStats, &pszStretchStatsFile, &pszKMeansCentresFile,
+                                     &maxMemMB, &pszTmpDir))
+    {
+        return nullptr;
+    }
+    
+    std::vector<unsigned int> bands;
+    if(imgBandsObj != Py_None)
+    {
+        if(!PySequence_Check(imgBandsObj))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "'bands' needs to be a sequence of integers.");
+            return nullptr;
+        }
+        Py_ssize_t nBands = PySequence_Size(imgBandsObj);
+        for(Py_ssize_t i = 0; i < nBands; ++i)
+        {
+            PyObject *bandObj = PySequence_GetItem(imgBandsObj, i);
+            if(!RSGISPY_CHECK_INT(bandObj))
+            {
+                Py_DECREF(bandObj);
+                PyErr_SetString(GETSTATE(self)->error, "'bands' needs to be a sequence of integers.");
+                return nullptr;
+            }
+            bands.push_back(RSGISPY_UINT_EXTRACT(bandObj));
+            Py_DECREF(bandObj);
+        }
+    }
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeShepherdSegmentation(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszGDALFormat),
+                                                 bands, noStretch, numClusters, minClumpPxls, specDistThres, subSample, maxKMeansIter,
+                                                 calcStats, std::string(pszStretchStatsFile), std::string(pszKMeansCentresFile),
+                                                 maxMemMB, std::string(pszTmpDir));
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *Segmentation_polygoniseClumps(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("clumps_img"), RSGIS_PY_C_TEXT("out_vec_file"),
+                             RSGIS_PY_C_TEXT("out_vec_lyr"), RSGIS_PY_C_TEXT("out_format"),
+                             RSGIS_PY_C_TEXT("img_band"), RSGIS_PY_C_TEXT("out_field"),
+                             RSGIS_PY_C_TEXT("use_8_conn"), RSGIS_PY_C_TEXT("del_exist_vec"), nullptr};
+    const char *pszClumpsImage, *pszOutVecFile, *pszOutVecLyr;
+    const char *pszOutFormat = "GPKG";
+    const char *pszOutField = "PXLVAL";
+    unsigned int imgBand = 1;
+    int use8Conn = false;
+    int delExistVec = false;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sss|sIsii:polygonise_clumps", kwlist, &pszClumpsImage, &pszOutVecFile,
+                                     &pszOutVecLyr, &pszOutFormat, &imgBand, &pszOutField, &use8Conn, &delExistVec))
+    {
+        return nullptr;
+    }
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executePolygoniseClumps(std::string(pszClumpsImage), imgBand, std::string(pszOutVecFile),
+                                             std::string(pszOutVecLyr), std::string(pszOutFormat), std::string(pszOutField),
+                                             use8Conn, delExistVec);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
 
 
 // Our list of functions in this module
@@ -671,19 +989,21 @@ static PyMethodDef SegmentationMethods[] = {
 
     {"eliminate_single_pixels", (PyCFunction)Segmentation_eliminateSinglePixels, METH_VARARGS | METH_KEYWORDS,
 "segmentation.eliminate_single_pixels(input_img, clumps_img, output_img, tmp_img, gdalformat, in_memory, ignorezeros)\n"
-"Eliminates single pixels\n"
+"Eliminates single pixels, merging each with the spectrally closest neighbouring pixel which \n"
+"is not a single pixel. The single pixels are found with one pass of the image and then processed \n"
+"in memory, using the number of threads of rsgislib.imageutils.set_calc_img_exec_context.\n"
 "\n"
 ":param input_img: is a string containing the name of the input file\n"
 ":param clumps_img: is a string containing the name of the clump file\n"
 ":param output_img: is a string containing the name of the output file\n"
-":param tmp_img: is a string containing the name of the temporary file to use\n"
+":param tmp_img: is no longer used (the single pixels are held in memory).\n"
 ":param gdalformat: is a string containing the GDAL format for the output file - eg 'KEA'\n"
-":param in_memory: is a bool specifying if processing should be carried out in memory (faster if sufficient RAM is available, set to False if unsure).\n"
-":param ignore_zeros: is a bool\n"
+":param in_memory: is no longer used (the single pixels are held in memory).\n"
+":param ignore_zeros: is a bool specifying whether zero is no data, in the clumps and input images.\n"
 "\n"},
 
     {"clump", (PyCFunction)Segmentation_clump, METH_VARARGS | METH_KEYWORDS,
-"segmentation.clump(input_img, output_img, gdalformat, in_memory, no_data_val, add_to_rat)\n"
+"segmentation.clump(input_img, output_img, gdalformat, in_memory, no_data_val, add_to_rat, n_threads)\n"
 "A function which clumps an input image (of int pixel data type) to identify connected independent sets of pixels.\n"
 "\n"
 ":param input_img: is a string containing the name of the input file\n"
@@ -692,6 +1012,7 @@ static PyMethodDef SegmentationMethods[] = {
 ":param in_memory: is a bool specifying if processing should be carried out in memory (faster if sufficient RAM is available, set to False if unsure).\n"
 ":param no_data_val: is None or float\n"
 ":param add_to_rat: is a boolean specifying whether the pixel value (from input_img) should be added as a RAT (Column Name: PixelVal).\n"
+":param n_threads: is the number of threads used to label tiles of the image concurrently (Default 1). The output is the same for any number of threads.\n"
 "\n"},
 
     {"rm_small_clumps_stepwise", (PyCFunction)Segmentation_RMSmallClumpsStepwise, METH_VARARGS | METH_KEYWORDS,
@@ -704,7 +1025,7 @@ static PyMethodDef SegmentationMethods[] = {
 ":param gdalformat: is a string containing the GDAL format for the output file - eg 'KEA'\n"
 ":param use_stch_stats: is a bool\n"
 ":param stch_stats_file: is a string containing the name of the stretch stats file\n"
-":param store_mean: is a bool\n"
+":param store_mean: is a bool specifying whether the clump means are stored (and updated as clumps are merged) using a region adjacency graph, which is much faster for large images.\n"
 ":param in_memory: is a bool specifying if processing should be carried out in memory (faster if sufficient RAM is available, set to False if unsure).\n"
 ":param min_clump_size: is an unsigned integer providing the minimum size for clumps.\n"
 ":param pxl_val_thres: is a float providing the maximum (Euclidian distance) spectral separation for which to merge clumps. Set to a large value to ignore spectral separation and always merge.\n"
@@ -721,7 +1042,7 @@ static PyMethodDef SegmentationMethods[] = {
 "\n"},
 
     {"union_of_clumps", (PyCFunction)Segmentation_unionOfClumps, METH_VARARGS | METH_KEYWORDS,
-"segmentation.union_of_clumps(input_imgs, output_img, gdalformat, no_data_val, add_to_rat)\n"
+"segmentation.union_of_clumps(input_imgs, output_img, gdalformat, no_data_val, add_to_rat, tuple_ids, n_threads)\n"
 "The function takes the union of clumps images, combining them so all lines from all clumps are preserved in the new outputted clumps image.\n"
 "\n"
 ":param input_imgs: is a list of input image paths\n"
@@ -729,12 +1050,16 @@ static PyMethodDef SegmentationMethods[] = {
 ":param gdalformat: is a string containing the GDAL format for the output file - eg 'KEA'\n"
 ":param no_data_val: is None or float\n"
 ":param add_to_rat: is a boolean specifying whether the pixel values (from input_imgs) should be added as a RAT; column names have prefix 'ClumpVal_' with index starting at 1 for each variable.\n"
+":param tuple_ids: is a boolean (Default False). If True, a single streaming pass gives each unique combination of input values one ID (numbered in the order first found), rather than a clump per connected region, so disconnected regions with the same values share an ID.\n"
+":param n_threads: is the number of threads used (Default 1). The output is the same for any number of threads.\n"
 "\n"
 },
 
     {"merge_segmentation_tiles", (PyCFunction)Segmentation_mergeSegmentationTiles, METH_VARARGS | METH_KEYWORDS,
 "segmentation.merge_segmentation_tiles(input_imgs, output_img, border_msk_img, tile_boundary, tile_overlap, tile_body, col_name)\n"
-"Merge body clumps from tile segmentations into output file\n"
+"Merge body clumps from tile segmentations into output file. The tiles are merged one at a time in spatial order\n"
+"(top to bottom and then left to right), so the result does not depend on the order of the input list\n"
+"(e.g., when the tiles were produced concurrently).\n"
 "\n"
 ":param input_imgs: is a list of input image paths\n"
 ":param output_img: is a string containing the name of the output file\n"
@@ -778,14 +1103,25 @@ static PyMethodDef SegmentationMethods[] = {
 "\n"},
 
     {"mean_image", (PyCFunction)Segmentation_meanImage, METH_VARARGS | METH_KEYWORDS,
-"segmentation.mean_image(input_img, clumps_img, output_img, gdalformat, datatype)\n"
+"segmentation.mean_image(input_img, clumps_img, output_img, gdalformat, datatype, mean_cols=None)\n"
 "A function to generate an image where with the mean value for each clump. Primarily for visualisation and evaluating segmentation.\n"
+"The means are calculated in a single parallel pass of the input and clumps images and applied in a second pass of the clumps image\n"
+"(using the threads and strip memory of the execution context). If the means are already in the RAT (e.g., from\n"
+"rsgislib.rastergis.populate_rat_with_stats) they can be read from the columns with mean_cols, so the input image is not read.\n"
 "\n"
-":param input_img: is a string containing the name of the input image file from which the mean is taken.\n"
+":param input_img: is a string containing the name of the input image file from which the mean is taken (can be None if mean_cols is given).\n"
 ":param clumps_img: is a string containing the name of the input clumps file\n"
 ":param output_img: is a string containing the name of the output image.\n"
 ":param gdalformat: is a string defining the format of the output image.\n"
 ":param datatype: is an containing one of the values from rsgislib.TYPE_*\n"
+":param mean_cols: is an optional list of the RAT columns with the clump means, giving an output band per column (with the\n"
+"                  geometry of the clumps image). Default None calculates the means from input_img.\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   import rsgislib\n"
+"   import rsgislib.segmentation\n"
+"   rsgislib.segmentation.mean_image(None, 'clumps.kea', 'mean_img.kea', 'KEA', rsgislib.TYPE_32FLOAT, mean_cols=['b1Mean', 'b2Mean', 'b3Mean'])\n"
 "\n"},
 
 {"generate_regular_grid", (PyCFunction)Segmentation_GenerateRegularGrid, METH_VARARGS | METH_KEYWORDS,
@@ -841,6 +1177,122 @@ static PyMethodDef SegmentationMethods[] = {
 ":param output_img: is a string containing the name and path of the output clumps image\n"
 ":param gdalformat: is a string defining the format of the output image.\n"
 ":param val_columns: is a list of strings defining the value(s) used to define equivalence (typically it might be the original pixel values when clumping through tiling).\n"
+"\n"},
+
+{"create_seg_tile_plan", (PyCFunction)Segmentation_createSegTilePlan, METH_VARARGS | METH_KEYWORDS,
+"segmentation.create_seg_tile_plan(clusters_img, spectral_img, manifest_file, tiles_base, gdalformat, out_file_ext, tile_x_size, tile_y_size, tile_overlap)\n"
+"A function to define a tiled segmentation as a set of independent tile jobs, which are written to a (text) manifest file. \n"
+"Each job can then be run by a separate process (e.g., a SLURM array task) using run_seg_tile_job and, once all the \n"
+"jobs have finished, the tiles are merged using merge_seg_tile_plan. The manifest lists the window of each job and \n"
+"the jobs it shares a border with.\n"
+"\n"
+":param clusters_img: is a string containing the filepath of the image to be clumped (e.g., the pixels labelled with the k-means cluster centres; 0 is no data).\n"
+":param spectral_img: is a string containing the filepath of the image used to eliminate the small clumps.\n"
+":param manifest_file: is a string containing the filepath of the output manifest file.\n"
+":param tiles_base: is a string containing the path and base name of the images written by the jobs.\n"
+":param gdalformat: is a string defining the format of the images, which must support raster attribute tables (e.g., KEA).\n"
+":param out_file_ext: is a string defining the file extension of the images (e.g., kea).\n"
+":param tile_x_size: is an unsigned integer with the width (in pixels) of the tiles.\n"
+":param tile_y_size: is an unsigned integer with the height (in pixels) of the tiles.\n"
+":param tile_overlap: is an unsigned integer with the number of pixels each tile is extended by on the sides shared with another tile.\n"
+":return: the number of jobs (the job ids are 0 to n-1).\n"
+"\n"},
+
+{"run_seg_tile_job", (PyCFunction)Segmentation_runSegTileJob, METH_VARARGS | METH_KEYWORDS,
+"segmentation.run_seg_tile_job(manifest_file, job_id, min_clump_size, pxl_val_thres, use_stch_stats=False, stch_stats_file='', in_memory=False)\n"
+"A function to run a single job of a segmentation tile plan (see create_seg_tile_plan). The window of the job is clumped, \n"
+"the small clumps eliminated (see rm_small_clumps_stepwise) and relabelled and the position of each clump within \n"
+"the tile is recorded in the 'TilePosition' column.\n"
+"\n"
+":param manifest_file: is a string containing the filepath of the manifest file.\n"
+":param job_id: is an unsigned integer with the id of the job to run.\n"
+":param min_clump_size: is an unsigned integer providing the minimum size for clumps.\n"
+":param pxl_val_thres: is a float providing the maximum (Euclidian distance) spectral separation for which to merge clumps.\n"
+":param use_stch_stats: is a bool specifying whether the stretch stats file is used.\n"
+":param stch_stats_file: is a string containing the name of the stretch stats file.\n"
+":param in_memory: is a bool specifying if processing should be carried out in memory.\n"
+"\n"},
+
+{"run_seg_tile_jobs", (PyCFunction)Segmentation_runSegTileJobs, METH_VARARGS | METH_KEYWORDS,
+"segmentation.run_seg_tile_jobs(manifest_file, min_clump_size, pxl_val_thres, use_stch_stats=False, stch_stats_file='', in_memory=False, n_threads=0, job_ids=None)\n"
+"A function to run the jobs of a segmentation tile plan (see create_seg_tile_plan) concurrently on a pool of threads \n"
+"within this process, each job being as run_seg_tile_job. Each thread takes the next job once it has finished its \n"
+"current job, so tiles which take longer to segment do not hold up the others. Once the function returns the tiles \n"
+"can be merged using merge_seg_tile_plan, which merges the tiles in spatial order whatever order they were produced in. \n"
+"Note, the GDAL driver of the tile images must support concurrent access to separate files (e.g., KEA requires a \n"
+"thread-safe build of HDF5).\n"
+"\n"
+":param manifest_file: is a string containing the filepath of the manifest file.\n"
+":param min_clump_size: is an unsigned integer providing the minimum size for clumps.\n"
+":param pxl_val_thres: is a float providing the maximum (Euclidian distance) spectral separation for which to merge clumps.\n"
+":param use_stch_stats: is a bool specifying whether the stretch stats file is used.\n"
+":param stch_stats_file: is a string containing the name of the stretch stats file.\n"
+":param in_memory: is a bool specifying if processing should be carried out in memory.\n"
+":param n_threads: is the number of threads used to run the jobs (0, the default, uses all the hardware threads).\n"
+":param job_ids: is an optional list of the ids of the jobs to run (None runs all the jobs of the plan).\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   import rsgislib.segmentation\n"
+"   n_jobs = rsgislib.segmentation.create_seg_tile_plan('kmeans.kea', 'stretched.kea', 'plan.txt', 'tiles/seg_tile', 'KEA', 'kea', 2000, 2000, 100)\n"
+"   rsgislib.segmentation.run_seg_tile_jobs('plan.txt', 100, 100, n_threads=4)\n"
+"   rsgislib.segmentation.merge_seg_tile_plan('plan.txt', 'clumps.kea', 100, 100)\n"
+"\n"},
+
+{"merge_seg_tile_plan", (PyCFunction)Segmentation_mergeSegTilePlan, METH_VARARGS | METH_KEYWORDS,
+"segmentation.merge_seg_tile_plan(manifest_file, output_img, min_clump_size, pxl_val_thres, use_stch_stats=False, stch_stats_file='', in_memory=False)\n"
+"A function to merge the jobs of a segmentation tile plan (see create_seg_tile_plan) once they have all been run. \n"
+"The clumps within the body of each tile are kept while those on the boundaries between the tiles are clumped and \n"
+"eliminated again as a single region, before the result is relabelled.\n"
+"\n"
+":param manifest_file: is a string containing the filepath of the manifest file.\n"
+":param output_img: is a string containing the name and path of the output clumps image.\n"
+":param min_clump_size: is an unsigned integer providing the minimum size for clumps.\n"
+":param pxl_val_thres: is a float providing the maximum (Euclidian distance) spectral separation for which to merge clumps.\n"
+":param use_stch_stats: is a bool specifying whether the stretch stats file is used.\n"
+":param stch_stats_file: is a string containing the name of the stretch stats file.\n"
+":param in_memory: is a bool specifying if processing should be carried out in memory.\n"
+"\n"},
+
+{"run_shepherd_segmentation", (PyCFunction)Segmentation_runShepherdSegmentation, METH_VARARGS | METH_KEYWORDS,
+"segmentation.run_shepherd_segmentation(input_img, out_clumps_img, gdalformat='KEA', bands=None, no_stretch=False, num_clusters=60, min_n_pxls=100, dist_thres=100, sampling=100, km_max_iter=200, calc_stats=True, img_stretch_stats='', kmeans_centres='', max_mem_mb=0, tmp_dir='.')\n"
+"A function to run the Shepherd et al. (2019) segmentation (see rsgislib.segmentation.shepherdseg) from the input image \n"
+"to the output clumps in one call. The stretched image, the k-means labels and the clumps are held in memory and only \n"
+"the final clumps (and their attribute table) are written.\n"
+"\n"
+":param input_img: is a string containing the name of the input file.\n"
+":param out_clumps_img: is a string containing the name of the output clump file.\n"
+":param gdalformat: is a string containing the GDAL format for the output file.\n"
+":param bands: is a list of the (1-based) image bands to use (None uses all the bands).\n"
+":param no_stretch: is a bool which specifies that the input image bands should not be stretched.\n"
+":param num_clusters: is an int which specifies the number of clusters within the KMeans clustering.\n"
+":param min_n_pxls: is an int which specifies the minimum number pixels within a segment.\n"
+":param dist_thres: specifies the distance threshold for joining the segments.\n"
+":param sampling: specify the subsampling of the image for the data used within the KMeans (1 == no subsampling).\n"
+":param km_max_iter: maximum iterations for KMeans.\n"
+":param calc_stats: is a bool which specifies that the RAT and pyramids should be built for the output image.\n"
+":param img_stretch_stats: is a string with the output file for the image stretch stats ('' to not write them).\n"
+":param kmeans_centres: is a string with the output file (.gmtxt is added) for the KMeans centres ('' to not write them).\n"
+":param max_mem_mb: if greater than 0 and the intermediate images need more memory (in MB) they are written to tmp_dir.\n"
+":param tmp_dir: is the directory for the intermediate images if they are not held in memory.\n"
+"\n"},
+
+{"polygonise_clumps", (PyCFunction)Segmentation_polygoniseClumps, METH_VARARGS | METH_KEYWORDS,
+"segmentation.polygonise_clumps(clumps_img, out_vec_file, out_vec_lyr, out_format='GPKG', img_band=1, out_field='PXLVAL', use_8_conn=False, del_exist_vec=False)\n"
+"A function to polygonise a clumps image (clump 0 is no data) to a vector layer, with a polygon for each connected \n"
+"region of a clump. Tiles of the image are polygonised concurrently (using the threads of the default execution \n"
+"context) and the clumps crossing the tile seams are merged by clump ID, so the polygons are the same for any \n"
+"number of threads.\n"
+"\n"
+":param clumps_img: is a string containing the name of the input clumps image.\n"
+":param out_vec_file: is a string containing the output vector file.\n"
+":param out_vec_lyr: is a string containing the output vector layer name.\n"
+":param out_format: is a string containing the output vector format (Default: GPKG).\n"
+":param img_band: is the band of the clumps image to polygonise (Default: 1).\n"
+":param out_field: is the name of the (64 bit integer) field the clump ID of each polygon is written to (Default: PXLVAL).\n"
+":param use_8_conn: is a bool specifying that pixels of a clump which only touch at a corner are within the same \n"
+"                   polygon (otherwise they are separate polygons, as with gdal.Polygonize).\n"
+":param del_exist_vec: is a bool specifying that the output vector should be deleted if it already exists.\n"
 "\n"},
 
     {nullptr}        /* Sentinel */
@@ -45,15 +45,17 @@ static PyObject *SpecUnmix_ExhconLinearSpecUnmix(PyObject *self, PyObject *args,
     static char *kwlist[] = {RSGIS_PY_C_TEXT("input_img"), RSGIS_PY_C_TEXT("output_img"),
                              RSGIS_PY_C_TEXT("gdalformat"), RSGIS_PY_C_TEXT("datatype"),
                              RSGIS_PY_C_TEXT("endmember_file"), RSGIS_PY_C_TEXT("step_res"),
-                             RSGIS_PY_C_TEXT("gain"), RSGIS_PY_C_TEXT("offset"), nullptr};
+                             RSGIS_PY_C_TEXT("gain"), RSGIS_PY_C_TEXT("offset"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
 
     const char *inputImage, *imageFormat, *outputFile, *endmembersFile;
     float lsumGain = 1;
     float lsumOffset = 0;
     float stepResolution;
     int datatype;
+    unsigned int numThreads = 1;
 
-    if(!PyArg_ParseTupleAndKeywords(args, keywds, "sssisf|ff:exhcon_linear_spec_unmix", kwlist, &inputImage, &outputFile, &imageFormat, &datatype, &endmembersFile, &stepResolution, &lsumGain, &lsumOffset))
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "sssisf|ffI:exhcon_linear_spec_unmix", kwlist, &inputImage, &outputFile, &imageFormat, &datatype, &endmembersFile, &stepResolution, &lsumGain, &lsumOffset, &numThreads))
     {
         return nullptr;
     }
@@ -62,7 +64,8 @@ static PyObject *SpecUnmix_ExhconLinearSpecUnmix(PyObject *self, PyObject *args,
 
     try
     {
-        rsgis::cmds::executeExhconLinearSpecUnmix(inputImage, imageFormat, type, lsumGain, lsumOffset, outputFile, endmembersFile, stepResolution);
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeExhconLinearSpecUnmix(inputImage, imageFormat, type, lsumGain, lsumOffset, outputFile, endmembersFile, stepResolution, numThreads);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
     {
@@ -87,6 +90,7 @@ static PyObject *SpecUnmix_ExtractAvgEndMembers(PyObject *self, PyObject *args,
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeExtractAvgEndMembers(std::string(pszInputImage), std::string(pszInputVector),
                                                  std::string(pszInputVecLyr), std::string(pszOutputMatrix), pixelInPolyMethod);
     }
@@ -103,7 +107,7 @@ static PyObject *SpecUnmix_ExtractAvgEndMembers(PyObject *self, PyObject *args,
 static PyMethodDef SpecUnmixMethods[] = {
 
 {"exhcon_linear_spec_unmix", (PyCFunction)SpecUnmix_ExhconLinearSpecUnmix, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imagecalc.specunmixing.exhcon_linear_spec_unmix(input_img, output_img, gdalformat, datatype, endmember_file, step_res, gain, offset)\n"
+"rsgislib.imagecalc.specunmixing.exhcon_linear_spec_unmix(input_img, output_img, gdalformat, datatype, endmember_file, step_res, gain, offset, n_threads)\n"
 "Performs an exhaustive constrained linear spectral unmixing of the input image for a set of endmembers.\n"
 "\n**Warning. This methods is slow (!!) to execute**\n\n"
 "Endmember polygons are extracted using rsgislib.imagecalc.specunmixing.extract_avg_endmembers() where each polygon \n"
@@ -117,6 +121,7 @@ static PyMethodDef SpecUnmixMethods[] = {
 ":param step_res: is a float specifying the gap between steps in the search space. Value needs to be between 0 and 1. (i.e., 0.05)\n"
 ":param gain: is a float specifying a gain which can be applied to the output pixel values (outvalue = offset + (gain * value)). Optional, default = 1.\n"
 ":param offset: is a float specifying an offset which can be applied to the output pixel values (outvalue = offset + (gain * value)). Optional, default = 0.\n"
+":param n_threads: is the number of threads used to unmix the image blocks (Default: 1; 0 uses all the available cores).\n"
 "\n"
 ".. code:: python\n"
 "\n"
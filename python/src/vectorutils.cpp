@@ -68,15 +68,16 @@ static PyObject *VectorUtils_VectorMaths(PyObject *self, PyObject *args, PyObjec
     static char *kwlist[] = {RSGIS_PY_C_TEXT("vec_file"), RSGIS_PY_C_TEXT("vec_lyr"),
                              RSGIS_PY_C_TEXT("out_vec_file"), RSGIS_PY_C_TEXT("out_vec_lyr"),
                              RSGIS_PY_C_TEXT("out_format"), RSGIS_PY_C_TEXT("out_col"), RSGIS_PY_C_TEXT("exp"),
-                             RSGIS_PY_C_TEXT("vars"), RSGIS_PY_C_TEXT("del_exist_vec"), nullptr};
+                             RSGIS_PY_C_TEXT("vars"), RSGIS_PY_C_TEXT("del_exist_vec"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
 
     const char *pszInputVectorFile, *pszInputVectorLyr, *pszOutputVectorFile, *pszOutputVectorLyr, *pszOutFormat, *pszOutColName, *pszExpression;
     int delExistVec = false;
+    unsigned int numThreads = 1;
     PyObject *pVarsObj;
 
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssssssO|i:vector_maths", kwlist, &pszInputVectorFile, &pszInputVectorLyr,
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssssssO|iI:vector_maths", kwlist, &pszInputVectorFile, &pszInputVectorLyr,
                                      &pszOutputVectorFile, &pszOutputVectorLyr, &pszOutFormat, &pszOutColName,
-                                     &pszExpression, &pVarsObj, &delExistVec))
+                                     &pszExpression, &pVarsObj, &delExistVec, &numThreads))
     {
         return nullptr;
     }
@@ -129,10 +130,11 @@ static PyObject *VectorUtils_VectorMaths(PyObject *self, PyObject *args, PyObjec
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeVectorMaths(std::string(pszInputVectorFile), std::string(pszInputVectorLyr),
                                         std::string(pszOutputVectorFile), std::string(pszOutputVectorLyr),
                                         std::string(pszOutFormat), std::string(pszOutColName),
-                                        std::string(pszExpression), (bool)delExistVec, vars);
+                                        std::string(pszExpression), (bool)delExistVec, vars, numThreads);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -163,6 +165,7 @@ static PyObject *VectorUtils_CreateLinesOfPoints(PyObject *self, PyObject *args,
     
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeCreateLinesOfPoints(std::string(pszInputVectorFile), std::string(pszInputVectorLyr),
                                                 std::string(pszOutputVectorFile), std::string(pszOutputVectorLyr),
                                                 std::string(pszOutFormat), step, (bool)delExistVec);
@@ -181,13 +184,14 @@ static PyObject *VectorUtils_CheckValidateGeometries(PyObject *self, PyObject *a
     static char *kwlist[] = {RSGIS_PY_C_TEXT("vec_file"), RSGIS_PY_C_TEXT("vec_lyr"),
                              RSGIS_PY_C_TEXT("out_vec_file"), RSGIS_PY_C_TEXT("out_vec_lyr"),
                              RSGIS_PY_C_TEXT("out_format"), RSGIS_PY_C_TEXT("print_err_geoms"),
-                             RSGIS_PY_C_TEXT("del_exist_vec"), nullptr};
+                             RSGIS_PY_C_TEXT("del_exist_vec"), RSGIS_PY_C_TEXT("n_threads"), nullptr};
     const char *pszInputVectorFile, *pszInputVectorLyr, *pszOutputVectorFile, *pszOutputVectorLyr, *pszOutFormat;
     int printGeomErrsInt = false;
     int delExistVec = false;
+    unsigned int numThreads = 1;
 
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssss|ii:check_validate_geometries", kwlist, &pszInputVectorFile, &pszInputVectorLyr,
-                                     &pszOutputVectorFile, &pszOutputVectorLyr, &pszOutFormat, &printGeomErrsInt, &delExistVec))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssss|iiI:check_validate_geometries", kwlist, &pszInputVectorFile, &pszInputVectorLyr,
+                                     &pszOutputVectorFile, &pszOutputVectorLyr, &pszOutFormat, &printGeomErrsInt, &delExistVec, &numThreads))
     {
         return nullptr;
     }
@@ -195,9 +199,12 @@ static PyObject *VectorUtils_CheckValidateGeometries(PyObject *self, PyObject *a
     try
     {
         bool printGeomErrs = (bool) printGeomErrsInt;
-        rsgis::cmds::executeCheckValidateGeometries(std::string(pszInputVectorFile), std::string(pszInputVectorLyr),
-                                                    std::string(pszOutputVectorFile), std::string(pszOutputVectorLyr),
-                                                    std::string(pszOutFormat), printGeomErrs, (bool)delExistVec);
+        {
+            RSGISPyReleaseGIL releaseGIL;
+            rsgis::cmds::executeCheckValidateGeometries(std::string(pszInputVectorFile), std::string(pszInputVectorLyr),
+                                                        std::string(pszOutputVectorFile), std::string(pszOutputVectorLyr),
+                                                        std::string(pszOutFormat), printGeomErrs, (bool)delExistVec, numThreads);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -213,7 +220,7 @@ static PyObject *VectorUtils_CheckValidateGeometries(PyObject *self, PyObject *a
 static PyMethodDef VectorUtilsMethods[] = {
 
 {"vector_maths", (PyCFunction)VectorUtils_VectorMaths, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.vectorutils.vector_maths(vec_file:str, vec_lyr:str, out_vec_file:str, out_vec_lyr:str, out_format:str, out_col:str, exp:str, vars:list, del_exist_vec:bool)\n"
+"rsgislib.vectorutils.vector_maths(vec_file:str, vec_lyr:str, out_vec_file:str, out_vec_lyr:str, out_format:str, out_col:str, exp:str, vars:list, del_exist_vec:bool, n_threads:int=1)\n"
 "A command to calculate a number column from data in existing columns.\n"
 "The syntax for the expression is from the `muparser library <http://muparser.beltoforion.de>`_ "
 "`see here for available operations and syntax <http://beltoforion.de/article.php?a=muparser&hl=en&p=features&s=idPageTop>`_\n."
@@ -229,6 +236,7 @@ static PyMethodDef VectorUtilsMethods[] = {
 ":param vars: is a list of rsgislib.vectorutils.VecColVar objects defining the names of the variables used \n"
 "             within the expression and defining which columns they are in the vec_file.\n"
 ":param del_exist_vec: is a bool, specifying whether to force removal of the output vector if it exists\n"
+":param n_threads: is the number of threads used to evaluate the expression for the features (Default: 1; 0 uses all the available cores).\n"
 "\n"},
 
 {"create_lines_of_points", (PyCFunction)VectorUtils_CreateLinesOfPoints, METH_VARARGS | METH_KEYWORDS,
@@ -245,8 +253,10 @@ static PyMethodDef VectorUtilsMethods[] = {
 "\n"},
 
 {"check_validate_geometries", (PyCFunction)VectorUtils_CheckValidateGeometries, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.vectorutils.check_validate_geometries(vec_file:str, vec_lyr:str, out_vec_file:str, out_vec_lyr:str, out_format:str, print_err_geoms:bool, del_exist_vec:bool)\n"
-"A command fit a polygon to the points inputted.\n"
+"rsgislib.vectorutils.check_validate_geometries(vec_file:str, vec_lyr:str, out_vec_file:str, out_vec_lyr:str, out_format:str, print_err_geoms:bool, del_exist_vec:bool, n_threads:int=1)\n"
+"A command to check the polygons within a vector layer, closing the polygon rings and repairing\n"
+"invalid polygons (using MakeValid). NULL, non-polygon and unrepairable features are dropped and\n"
+"a summary of the number of invalid geometries is printed at the end.\n"
 "\n"
 ":param vec_file: is a string containing the input vector file path\n"
 ":param vec_lyr: is a string containing the name of the input vector layer name\n"
@@ -255,6 +265,7 @@ static PyMethodDef VectorUtilsMethods[] = {
 ":param out_format: is a string specifying the output vector GDAL/OGR driver (e.g., GPKG).\n"
 ":param print_err_geoms: is a bool, specifying whether were errors are found they are printed to the console.\n"
 ":param del_exist_vec: is a bool, specifying whether to force removal of the output vector if it exists\n"
+":param n_threads: is the number of threads used to check and repair the geometries (Default: 1; 0 uses all the available cores).\n"
 "\n"},
     
 {nullptr}        /* Sentinel */
@@ -58,6 +58,7 @@ static PyObject *ZonalStats_ImageZoneToHDF(PyObject *self, PyObject *args, PyObj
         return nullptr;
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeZonesImage2HDF5(std::string(pszInputImage), std::string(pszInputVector), std::string(pszInputVecLyr),
                                             std::string(pszOutputHDF), (bool)noProjWarning, pixelInPolyMethod);
     }
@@ -92,6 +93,7 @@ static PyObject *ZonalStats_ExtractZoneImageValues2HDF(PyObject *self, PyObject
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageRasterZone2HDF(std::string(pszInputImage), std::string(pszInputMaskImage),
                                                 std::string(pszOutputFile), maskValue, type);
     }
@@ -104,34 +106,11 @@ static PyObject *ZonalStats_ExtractZoneImageValues2HDF(PyObject *self, PyObject
     Py_RETURN_NONE;
 }
 
-static PyObject *ZonalStats_ExtractZoneImageBandValues2HDF(PyObject *self, PyObject *args, PyObject *keywds)
+/** Extract the file names and bands from a sequence of rsgislib.imageutils.ImageBandInfo objects, returning false (with the error set) on failure. */
+static bool ExtractImageBandInfoFromSequence(PyObject *self, PyObject *inputImageFileInfoObj, std::vector<std::pair<std::string, std::vector<unsigned int> > > *imageFilesInfo)
 {
-    PyObject *inputImageFileInfoObj;
-    const char *pszInputMaskImage;
-    const char *pszOutputFile;
-    float maskValue = 0;
-    int nDataType = 9;
-
-    static char *kwlist[] = {RSGIS_PY_C_TEXT("in_img_info"), RSGIS_PY_C_TEXT("in_msk_img"),
-                             RSGIS_PY_C_TEXT("out_h5_file"), RSGIS_PY_C_TEXT("mask_val"),
-                             RSGIS_PY_C_TEXT("datatype"), nullptr};
-
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Ossf|i:extract_zone_img_band_values_to_hdf", kwlist, &inputImageFileInfoObj, &pszInputMaskImage, &pszOutputFile, &maskValue, &nDataType))
-    {
-        return nullptr;
-    }
-
-    if( !PySequence_Check(inputImageFileInfoObj))
-    {
-        PyErr_SetString(GETSTATE(self)->error, "First argument (imageFileInfo) must be a sequence");
-        return nullptr;
-    }
-
-    rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
-
     Py_ssize_t nFileInfo = PySequence_Size(inputImageFileInfoObj);
-    std::vector<std::pair<std::string, std::vector<unsigned int> > > imageFilesInfo;
-    imageFilesInfo.reserve(nFileInfo);
+    imageFilesInfo->reserve(nFileInfo);
     std::string tmpFileName = "";
 
     for( Py_ssize_t n = 0; n < nFileInfo; n++ )
@@ -144,7 +123,7 @@ static PyObject *ZonalStats_ExtractZoneImageBandValues2HDF(PyObject *self, PyObj
             PyErr_SetString(GETSTATE(self)->error, "Could not find string attribute \'file_name\'" );
             Py_XDECREF(pFileName);
             Py_DECREF(o);
-            return nullptr;
+            return false;
         }
 
         PyObject *pBands = PyObject_GetAttrString(o, "bands");
@@ -154,7 +133,7 @@ static PyObject *ZonalStats_ExtractZoneImageBandValues2HDF(PyObject *self, PyObj
             Py_DECREF(pFileName);
             Py_XDECREF(pBands);
             Py_DECREF(o);
-            return nullptr;
+            return false;
         }
 
         Py_ssize_t nBands = PySequence_Size(pBands);
@@ -164,7 +143,7 @@ static PyObject *ZonalStats_ExtractZoneImageBandValues2HDF(PyObject *self, PyObj
             Py_DECREF(pFileName);
             Py_DECREF(pBands);
             Py_DECREF(o);
-            return nullptr;
+            return false;
         }
         std::vector<unsigned int> bandsVec = std::vector<unsigned int>();
         bandsVec.reserve(nBands);
@@ -179,17 +158,55 @@ static PyObject *ZonalStats_ExtractZoneImageBandValues2HDF(PyObject *self, PyObj
                 Py_DECREF(pFileName);
                 Py_DECREF(pBands);
                 Py_DECREF(o);
-                return nullptr;
+                return false;
             }
             bandsVec.push_back(RSGISPY_INT_EXTRACT(bO));
+            Py_DECREF(bO);
         }
 
         tmpFileName = std::string(RSGISPY_STRING_EXTRACT(pFileName));
-        imageFilesInfo.push_back(std::pair<std::string, std::vector<unsigned int> >(tmpFileName, bandsVec));
+        imageFilesInfo->push_back(std::pair<std::string, std::vector<unsigned int> >(tmpFileName, bandsVec));
+        Py_DECREF(pFileName);
+        Py_DECREF(pBands);
+        Py_DECREF(o);
+    }
+    return true;
+}
+
+static PyObject *ZonalStats_ExtractZoneImageBandValues2HDF(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    PyObject *inputImageFileInfoObj;
+    const char *pszInputMaskImage;
+    const char *pszOutputFile;
+    float maskValue = 0;
+    int nDataType = 9;
+
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("in_img_info"), RSGIS_PY_C_TEXT("in_msk_img"),
+                             RSGIS_PY_C_TEXT("out_h5_file"), RSGIS_PY_C_TEXT("mask_val"),
+                             RSGIS_PY_C_TEXT("datatype"), nullptr};
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "Ossf|i:extract_zone_img_band_values_to_hdf", kwlist, &inputImageFileInfoObj, &pszInputMaskImage, &pszOutputFile, &maskValue, &nDataType))
+    {
+        return nullptr;
+    }
+
+    if( !PySequence_Check(inputImageFileInfoObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "First argument (imageFileInfo) must be a sequence");
+        return nullptr;
+    }
+
+    rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
+
+    std::vector<std::pair<std::string, std::vector<unsigned int> > > imageFilesInfo;
+    if(!ExtractImageBandInfoFromSequence(self, inputImageFileInfoObj, &imageFilesInfo))
+    {
+        return nullptr;
     }
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeImageBandRasterZone2HDF(imageFilesInfo, std::string(pszInputMaskImage),
                                                     std::string(pszOutputFile), maskValue, type);
     }
@@ -203,6 +220,59 @@ static PyObject *ZonalStats_ExtractZoneImageBandValues2HDF(PyObject *self, PyObj
 }
 
 
+static PyObject *ZonalStats_ExtractChipZoneImageBandValues2HDF(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    PyObject *inputImageFileInfoObj;
+    const char *pszInputMaskImage;
+    float maskValue = 0;
+    unsigned int chipSize = 0;
+    const char *pszOutputFile;
+    int nDataType = 9;
+    const char *pszRefImage = "";
+    unsigned int refBand = 1;
+    unsigned int numThreads = 1;
+
+    static char *kwlist[] = {RSGIS_PY_C_TEXT("in_img_info"), RSGIS_PY_C_TEXT("in_msk_img"),
+                             RSGIS_PY_C_TEXT("mask_val"), RSGIS_PY_C_TEXT("chip_size"),
+                             RSGIS_PY_C_TEXT("out_h5_file"), RSGIS_PY_C_TEXT("datatype"),
+                             RSGIS_PY_C_TEXT("ref_img"), RSGIS_PY_C_TEXT("ref_img_band"),
+                             RSGIS_PY_C_TEXT("n_threads"), nullptr};
+
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "OsfIs|isII:extract_chip_zone_img_band_values_to_hdf", kwlist, &inputImageFileInfoObj, &pszInputMaskImage, &maskValue, &chipSize, &pszOutputFile, &nDataType, &pszRefImage, &refBand, &numThreads))
+    {
+        return nullptr;
+    }
+
+    if( !PySequence_Check(inputImageFileInfoObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "First argument (imageFileInfo) must be a sequence");
+        return nullptr;
+    }
+
+    rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
+
+    std::vector<std::pair<std::string, std::vector<unsigned int> > > imageFilesInfo;
+    if(!ExtractImageBandInfoFromSequence(self, inputImageFileInfoObj, &imageFilesInfo))
+    {
+        return nullptr;
+    }
+
+    try
+    {
+        RSGISPyReleaseGIL releaseGIL;
+        rsgis::cmds::executeImageBandChipsRasterZone2HDF(imageFilesInfo, std::string(pszInputMaskImage), maskValue, chipSize,
+                                                         std::string(pszOutputFile), type, std::string(pszRefImage), refBand, numThreads);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+
 static PyObject *ZonalStats_RandomSampleHDF5File(PyObject *self, PyObject *args, PyObject *keywds)
 {
     static char *kwlist[] = {RSGIS_PY_C_TEXT("in_h5_file"), RSGIS_PY_C_TEXT("out_h5_file"),
@@ -222,6 +292,7 @@ static PyObject *ZonalStats_RandomSampleHDF5File(PyObject *self, PyObject *args,
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeRandomSampleH5File(std::string(pInputH5), std::string(pOutputH5), sampleSize, seed, type);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -254,6 +325,7 @@ static PyObject *ZonalStats_SplitSampleHDF5File(PyObject *self, PyObject *args,
 
     try
     {
+        RSGISPyReleaseGIL releaseGIL;
         rsgis::cmds::executeSplitSampleH5File(std::string(pInputH5), std::string(pOutputP1H5), std::string(pOutputP2H5), sampleSize, seed, type);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
@@ -305,7 +377,10 @@ static PyMethodDef ZonalStatsMethods[] = {
 {"extract_zone_img_band_values_to_hdf", (PyCFunction)ZonalStats_ExtractZoneImageBandValues2HDF, METH_VARARGS | METH_KEYWORDS,
 "rsgislib.zonalstats.extract_zone_img_band_values_to_hdf(in_img_info, in_msk_img, out_h5_file, mask_val, datatype)\n"
 "Extract the all the pixel values for raster regions to a HDF5 file (1 column for each image band).\n"
-"Multiple input rasters can be provided and the bands extracted selected.\n"
+"Multiple input rasters can be provided and the bands extracted selected. The input rasters\n"
+"do not need to be on the same grid as the mask (or each other), the mask pixel centres are\n"
+"mapped on to the pixels of each raster (nearest neighbour) and mask pixels outside of any\n"
+"of the rasters are not extracted.\n"
 "\n"
 ":param in_img_info: is a list of rsgislib::imageutils::ImageBandInfo objects with the file names and list of image bands within that file to be extracted.\n"
 ":param in_msk_img: is a string containing the name and path of the input image mask file; the mask file must have only 1 image band.\n"
@@ -323,9 +398,42 @@ static PyMethodDef ZonalStatsMethods[] = {
 "   rsgislib.zonalstats.extract_zone_img_band_values_to_hdf(fileInfo, 'ClassMask.kea', 'ForestRefl.h5', 1.0)\n"
 "\n\n"},
 
+{"extract_chip_zone_img_band_values_to_hdf", (PyCFunction)ZonalStats_ExtractChipZoneImageBandValues2HDF, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.zonalstats.extract_chip_zone_img_band_values_to_hdf(in_img_info, in_msk_img, mask_val, chip_size, out_h5_file, datatype=rsgislib.TYPE_32FLOAT, ref_img='', ref_img_band=1, n_threads=1)\n"
+"Extract a chip (window) of chip_size x chip_size pixels of the image band values centred on each\n"
+"mask pixel with the mask value to a HDF5 file, as used for training deep learning classifiers.\n"
+"The chips are written to DATA/DATA with the shape [n, chip_size, chip_size, n_bands] (indexed\n"
+"[chip, x, y, band]), with each chip as a HDF5 chunk. The mask is read in strips, each image band\n"
+"is read once for each strip (with a halo of half a chip) and the chips are cut in parallel, where\n"
+"the chips are in the order of the mask pixels (row by row) whatever the number of threads.\n"
+"The input images must be on the pixel grid of the mask but can have a different extent; pixels\n"
+"outside of an image are given a value of zero.\n"
+"\n"
+":param in_img_info: is a list of rsgislib::imageutils::ImageBandInfo objects with the file names and list of image bands within that file to be extracted.\n"
+":param in_msk_img: is a string containing the name and path of the input image mask file; the mask file must have only 1 image band.\n"
+":param mask_val: is a float containing the value of the pixel within the mask for which chips are to be extracted.\n"
+":param chip_size: is an int with the size (in pixels) of the chips.\n"
+":param out_h5_file: is a string containing the name and path of the output HDF5 file.\n"
+":param datatype: is a rsgislib.TYPE_* value providing the data type of the output chips.\n"
+":param ref_img: is an optional reference image (e.g., classes); if provided the chips of the reference band are written to DATA/REF as uint16 (indexed [chip, y, x]).\n"
+":param ref_img_band: is the band of the reference image to be used.\n"
+":param n_threads: is the number of threads used to cut the chips (0 is the number of hardware threads).\n"
+"\n"
+".. code:: python\n"
+"\n"
+"   import rsgislib\n"
+"   import rsgislib.zonalstats\n"
+"   import rsgislib.imageutils\n"
+"   fileInfo = []\n"
+"   fileInfo.append(rsgislib.imageutils.ImageBandInfo('InputImg1.kea', 'Image1', [1,3,4]))\n"
+"   rsgislib.zonalstats.extract_chip_zone_img_band_values_to_hdf(fileInfo, 'ClassMask.kea', 1, 21, 'ForestChips.h5', rsgislib.TYPE_32FLOAT, n_threads=4)\n"
+"\n\n"},
+
 {"random_sample_hdf5_file", (PyCFunction)ZonalStats_RandomSampleHDF5File, METH_VARARGS | METH_KEYWORDS,
 "rsgislib.zonalstats.random_sample_hdf5_file(in_h5_file, out_h5_file, sample, rnd_seed, datatype)\n"
-"A function which randomly samples a HDF5 of extracted values.\n"
+"A function which randomly samples a HDF5 of extracted values. The rows are sampled\n"
+"without replacement, keep the order of the input file and the input is read in chunks\n"
+"so the whole file is not loaded into memory.\n"
 "\n"
 ":param in_h5_file: is a string with the path to the input file.\n"
 ":param out_h5_file: is a string with the path to the output file.\n"
@@ -337,7 +445,9 @@ static PyMethodDef ZonalStatsMethods[] = {
 
 {"split_sample_hdf5_file", (PyCFunction)ZonalStats_SplitSampleHDF5File, METH_VARARGS | METH_KEYWORDS,
 "rsgislib.zonalstats.split_sample_hdf5_file(in_h5_file, out_h5_p1_file, out_h5_p2_file, sample, rnd_seed, datatype)\n"
-"A function which splits samples a HDF5 of extracted values.\n"
+"A function which splits samples a HDF5 of extracted values. The sample is written\n"
+"to out_h5_p1_file and the remaining rows to out_h5_p2_file, reading the input in chunks\n"
+"so the whole file is not loaded into memory.\n"
 "\n"
 ":param in_h5_file: is a string with the path to the input file.\n"
 ":param out_h5_p1_file: is a string with the path to the output file.\n"
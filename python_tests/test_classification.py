@@ -703,3 +703,70 @@ def test_get_class_info_dict(tmp_path):
     cls_out_info = rsgislib.classification.get_class_info_dict(
         cls_in_info, smpls_dir=tmp_path
     )
+
+
+def test_apply_batch_predictor(tmp_path):
+    import numpy
+    import rsgislib
+    import rsgislib.classification
+    import rsgislib.imageutils
+
+    s2_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset.kea")
+    s2_vld_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset_vldmsk.kea")
+
+    img_band_info = []
+    img_band_info.append(rsgislib.imageutils.ImageBandInfo(s2_img, "s2", [3, 8]))
+
+    def _predict(feats):
+        feats = numpy.asarray(feats)
+        out_vals = numpy.zeros((feats.shape[0], 2), dtype=numpy.float32)
+        out_vals[..., 0] = feats[..., 1] > feats[..., 0]
+        out_vals[..., 1] = feats[..., 1] - feats[..., 0]
+        return out_vals
+
+    out_cls_img = os.path.join(tmp_path, "out_cls_img.kea")
+    out_diff_img = os.path.join(tmp_path, "out_diff_img.kea")
+    rsgislib.classification.apply_batch_predictor(
+        img_band_info,
+        s2_vld_img,
+        1,
+        _predict,
+        [
+            (out_cls_img, 1, rsgislib.TYPE_8UINT),
+            (out_diff_img, 1, rsgislib.TYPE_32FLOAT),
+        ],
+        "KEA",
+        batch_size=5000,
+    )
+
+    assert os.path.exists(out_cls_img) and os.path.exists(out_diff_img)
+
+
+def test_apply_rat_batch_predictor(tmp_path):
+    import numpy
+    import rsgislib.classification
+    import rsgislib.rastergis
+
+    ref_clumps_img = os.path.join(
+        CLASSIFICATION_DATA_DIR, "sen2_20210527_aber_clumps_s2means.kea"
+    )
+    clumps_img = os.path.join(tmp_path, "sen2_20210527_aber_clumps_s2means.kea")
+    copy2(ref_clumps_img, clumps_img)
+
+    def _predict(feats):
+        feats = numpy.asarray(feats)
+        return numpy.where(feats[..., 1] > feats[..., 0], 1.0, 2.0)
+
+    rsgislib.classification.apply_rat_batch_predictor(
+        clumps_img,
+        ["b3Mean", "b8Mean"],
+        _predict,
+        "OutClass",
+        cls_info={1: ("Veg", 0, 255, 0), 2: ("Other", 128, 128, 128)},
+        out_col_str="OutClassName",
+        class_colours=True,
+        chunk_size=1000,
+    )
+
+    cls_col_vals = rsgislib.rastergis.get_column_data(clumps_img, "OutClass")
+    assert numpy.isin(cls_col_vals[1:], [1, 2]).all()
@@ -564,3 +564,19 @@ def test_calc_sampled_acc_metrics(tmp_path):
         out_ref_usr_plot=out_ref_usr_plot,
         out_ref_prod_plot=out_ref_prod_plot,
     )
+
+
+def test_calc_acc_metrics_ref_img(tmp_path):
+    import rsgislib.classification.classaccuracymetrics
+
+    in_cls_img = os.path.join(CLASS_ACC_DATA_DIR, "cls_rf_refl.kea")
+    out_json_file = os.path.join(tmp_path, "out_acc_stats.json")
+
+    acc_metrics = (
+        rsgislib.classification.classaccuracymetrics.calc_acc_metrics_ref_img(
+            in_cls_img, in_cls_img, cls_no_data=0, out_json_file=out_json_file
+        )
+    )
+
+    assert os.path.exists(out_json_file)
+    assert abs(acc_metrics["overall_accuracy"] - 1.0) < 1e-9
@@ -126,6 +126,38 @@ def test_fill_dem_soille_gratin_1994(tmp_path):
     assert img_eq
 
 
+def test_fill_dem_priority_flood(tmp_path):
+    import rsgislib.elevation
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "SRTM_aber.kea")
+    valid_mask_img = os.path.join(DATA_DIR, "SRTM_aber_valid_mask.kea")
+    output_img = os.path.join(tmp_path, "out_fill_priority_flood_tmpout.kea")
+    rsgislib.elevation.fill_dem_priority_flood(
+        input_img, valid_mask_img, output_img, "KEA"
+    )
+
+    fill_ref_img = os.path.join(DATA_DIR, "SRTM_aber_fill_soille_gratin_1994.kea")
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(output_img, fill_ref_img)
+    assert img_eq
+
+
+def test_fill_dem_priority_flood_tiled(tmp_path):
+    import rsgislib.elevation
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "SRTM_aber.kea")
+    valid_mask_img = os.path.join(DATA_DIR, "SRTM_aber_valid_mask.kea")
+    output_img = os.path.join(tmp_path, "out_fill_priority_flood_tiled_tmpout.kea")
+    rsgislib.elevation.fill_dem_priority_flood(
+        input_img, valid_mask_img, output_img, "KEA", tile_size=64
+    )
+
+    fill_ref_img = os.path.join(DATA_DIR, "SRTM_aber_fill_soille_gratin_1994.kea")
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(output_img, fill_ref_img)
+    assert img_eq
+
+
 def test_plane_fit_detreat_dem(tmp_path):
     import rsgislib.elevation
     import rsgislib.imagecalc
@@ -167,6 +199,31 @@ def test_shadow_mask(tmp_path):
     assert img_eq
 
 
+def test_shadow_masks(tmp_path):
+    import rsgislib.elevation
+    import rsgislib.imagecalc
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "SRTM_aber_subset.kea")
+    output_img = os.path.join(tmp_path, "out_SRTM_shadow_masks.kea")
+    gdalformat = "KEA"
+    rsgislib.elevation.shadow_masks(
+        input_img, output_img, [126.45, 200.0], [35.67, 60.0], gdalformat
+    )
+    assert rsgislib.imageutils.get_img_band_count(output_img) == 2
+
+    # The horizon is interpolated so is close to but not the same as the ray tracing.
+    output_single_img = os.path.join(tmp_path, "out_SRTM_shadow_mask_sweep.kea")
+    rsgislib.elevation.shadow_masks(
+        input_img, output_single_img, [126.45], [35.67], gdalformat
+    )
+    shadow_mask_ref_img = os.path.join(DATA_DIR, "SRTM_aber_shadow_mask.kea")
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(
+        output_single_img, shadow_mask_ref_img
+    )
+    assert prop_match > 0.8
+
+
 def test_local_incidence_angle(tmp_path):
     import rsgislib.elevation
     import rsgislib.imagecalc
@@ -205,6 +262,44 @@ def test_local_existance_angle(tmp_path):
     assert img_eq
 
 
+def test_terrain_derivatives(tmp_path):
+    import rsgislib.elevation
+    import rsgislib.imagecalc
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "SRTM_aber.kea")
+    output_img = os.path.join(tmp_path, "out_SRTM_localincangle.kea")
+    solar_azimuth = 126.45
+    solar_zenith = 35.67
+    gdalformat = "KEA"
+    rsgislib.elevation.terrain_derivatives(
+        input_img,
+        output_img,
+        gdalformat,
+        ["incidence"],
+        azimuth=solar_azimuth,
+        zenith=solar_zenith,
+    )
+
+    inc_angle_ref_img = os.path.join(DATA_DIR, "SRTM_aber_localincangle.kea")
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(
+        output_img, inc_angle_ref_img
+    )
+    assert img_eq
+
+    output_all_img = os.path.join(tmp_path, "out_SRTM_terrain.kea")
+    derivatives = ["slope", "aspect", "hillshade", "incidence", "exitance"]
+    rsgislib.elevation.terrain_derivatives(
+        input_img,
+        output_all_img,
+        gdalformat,
+        derivatives,
+        azimuth=solar_azimuth,
+        zenith=solar_zenith,
+    )
+    assert rsgislib.imageutils.get_band_names(output_all_img) == derivatives
+
+
 def test_hillshade(tmp_path):
     import rsgislib.elevation
     import rsgislib.imagecalc
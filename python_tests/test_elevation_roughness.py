@@ -384,3 +384,22 @@ def test_calc_all_roughness_profile_metrics(tmp_path):
         and (len(ys_smith_z0_arr) == 3)
         and (len(avg_smith_z0_arr) == 3)
     )
+
+
+def test_calc_dem_roughness(tmp_path):
+    import rsgislib.elevation
+    import rsgislib.imageutils
+
+    input_dem_img = os.path.join(DATA_DIR, "SRTM_aber.kea")
+    for metrics, n_bands, band_name in [
+        ("profile", 27, "avg_rku"),
+        ("munro", 9, "avg_munro_z0"),
+        ("smith", 12, "avg_smith_z0"),
+    ]:
+        output_img = os.path.join(tmp_path, f"out_{metrics}_roughness.kea")
+        rsgislib.elevation.calc_dem_roughness(
+            input_dem_img, output_img, "KEA", 7, metrics=metrics, detrend=True
+        )
+        assert os.path.exists(output_img)
+        assert rsgislib.imageutils.get_img_band_count(output_img) == n_bands
+        assert rsgislib.imageutils.get_band_names(output_img)[-1] == band_name
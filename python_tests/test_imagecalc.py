@@ -133,6 +133,93 @@ def test_band_maths_sgl_band(tmp_path):
     assert img_eq
 
 
+def test_band_maths_progress_callback(tmp_path):
+    import rsgislib.imagecalc
+    import rsgislib.imageutils
+
+    updates = list()
+
+    def _progress(label, n_done, n_total):
+        updates.append((n_done, n_total))
+
+    init_progress = rsgislib.imageutils.get_progress_reporting()
+    try:
+        rsgislib.imageutils.set_progress_reporting(show_bar=False, callback=_progress)
+        input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+        band_def_seq = list()
+        band_def_seq.append(
+            rsgislib.imagecalc.BandDefn(
+                band_name="Blue", input_img=input_img, img_band=1
+            )
+        )
+        output_img = os.path.join(tmp_path, "sen2_20210527_aber_b1.kea")
+        rsgislib.imagecalc.band_math(
+            output_img, "Blue", "KEA", rsgislib.TYPE_16UINT, band_defs=band_def_seq
+        )
+        assert len(updates) > 0
+        assert updates[-1][0] == updates[-1][1]
+
+        updates.clear()
+        rsgislib.imageutils.set_progress_reporting(enabled=False)
+        output_img = os.path.join(tmp_path, "sen2_20210527_aber_b1_no_prog.kea")
+        rsgislib.imagecalc.band_math(
+            output_img, "Blue", "KEA", rsgislib.TYPE_16UINT, band_defs=band_def_seq
+        )
+        assert len(updates) == 0
+    finally:
+        rsgislib.imageutils.set_progress_reporting(**init_progress)
+
+
+def test_band_maths_sgl_band_cog(tmp_path):
+    import rsgislib.imagecalc
+    from osgeo import gdal
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    band_def_seq = list()
+    band_def_seq.append(
+        rsgislib.imagecalc.BandDefn(band_name="Blue", input_img=input_img, img_band=1)
+    )
+    output_img = os.path.join(tmp_path, "sen2_20210527_aber_b1.tif")
+    rsgislib.imagecalc.band_math(
+        output_img, "Blue", "COG", rsgislib.TYPE_16UINT, band_defs=band_def_seq
+    )
+
+    img_eq, prop_match = rsgislib.imagecalc.are_img_bands_equal(
+        input_img, 1, output_img, 1
+    )
+    assert img_eq
+    img_ds = gdal.Open(output_img)
+    assert img_ds.GetMetadataItem("LAYOUT", "IMAGE_STRUCTURE") == "COG"
+    img_ds = None
+    assert not os.path.exists(output_img + "_cogtmp.tif")
+
+
+def test_band_maths_sgl_band_compress_threads(tmp_path):
+    import rsgislib.imagecalc
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    band_def_seq = list()
+    band_def_seq.append(
+        rsgislib.imagecalc.BandDefn(band_name="Blue", input_img=input_img, img_band=1)
+    )
+    output_img = os.path.join(tmp_path, "sen2_20210527_aber_b1.tif")
+    init_context = rsgislib.imageutils.get_calc_img_exec_context()
+    try:
+        rsgislib.imageutils.set_calc_img_exec_context(compress_threads=2)
+        assert rsgislib.imageutils.get_calc_img_exec_context()["compress_threads"] == 2
+        rsgislib.imagecalc.band_math(
+            output_img, "Blue", "GTiff", rsgislib.TYPE_16UINT, band_defs=band_def_seq
+        )
+    finally:
+        rsgislib.imageutils.set_calc_img_exec_context(**init_context)
+
+    img_eq, prop_match = rsgislib.imagecalc.are_img_bands_equal(
+        input_img, 1, output_img, 1
+    )
+    assert img_eq
+
+
 def test_band_maths_multi_band(tmp_path):
     import rsgislib.imagecalc
 
@@ -230,6 +317,65 @@ def test_image_math_binary_out(tmp_path):
     assert img_eq
 
 
+def test_image_math_preview(tmp_path):
+    import rsgislib.imagecalc
+    import rsgislib.imageutils
+
+    input_img = os.path.join(IMGCALC_DATA_DIR, "sen2_20210527_aber_ndvi.kea")
+    output_img = os.path.join(tmp_path, "ndvi_cats_preview.kea")
+    exp = "b1>0.95?1:b1>0.85?2:b1>0.75?3:0"
+    init_context = rsgislib.imageutils.get_calc_img_exec_context()
+    try:
+        rsgislib.imageutils.set_calc_img_exec_context(preview_factor=4)
+        rsgislib.imagecalc.image_math(
+            input_img, output_img, exp, "KEA", rsgislib.TYPE_8UINT
+        )
+    finally:
+        rsgislib.imageutils.set_calc_img_exec_context(**init_context)
+
+    in_x_size, in_y_size = rsgislib.imageutils.get_img_size(input_img)
+    out_x_size, out_y_size = rsgislib.imageutils.get_img_size(output_img)
+    assert out_x_size == in_x_size // 4
+    assert out_y_size == in_y_size // 4
+    in_x_res, in_y_res = rsgislib.imageutils.get_img_res(input_img)
+    out_x_res, out_y_res = rsgislib.imageutils.get_img_res(output_img)
+    assert abs(out_x_res - (in_x_res * 4)) < 1e-6
+    assert abs(out_y_res - (in_y_res * 4)) < 1e-6
+
+
+def test_band_maths_result_cache(tmp_path):
+    import rsgislib.imagecalc
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    band_def_seq = list()
+    band_def_seq.append(
+        rsgislib.imagecalc.BandDefn(band_name="Blue", input_img=input_img, img_band=1)
+    )
+    cache_dir = os.path.join(tmp_path, "result_cache")
+    init_context = rsgislib.imageutils.get_calc_img_exec_context()
+    try:
+        rsgislib.imageutils.set_calc_img_exec_context(result_cache_dir=cache_dir)
+        assert (
+            rsgislib.imageutils.get_calc_img_exec_context()["result_cache_dir"]
+            == cache_dir
+        )
+        for i in range(2):
+            output_img = os.path.join(
+                tmp_path, "sen2_20210527_aber_b1_{}.kea".format(i)
+            )
+            rsgislib.imagecalc.band_math(
+                output_img, "Blue", "KEA", rsgislib.TYPE_16UINT, band_defs=band_def_seq
+            )
+            img_eq, prop_match = rsgislib.imagecalc.are_img_bands_equal(
+                input_img, 1, output_img, 1
+            )
+            assert img_eq
+    finally:
+        rsgislib.imageutils.set_calc_img_exec_context(**init_context)
+
+    assert len(os.listdir(cache_dir)) == 1
+
 def test_buffer_img_pxl_vals(tmp_path):
     import rsgislib.imagecalc
 
@@ -525,6 +671,21 @@ def test_calc_band_percentile():
     assert ((percent_val[0] - 43) < 1) and ((percent_val[5] - 458) < 1)
 
 
+
+def test_calc_band_percentile_threads_approx():
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+
+    percent_val = rsgislib.imagecalc.calc_band_percentile(input_img, 0.5, 0)
+    thrd_percent_val = rsgislib.imagecalc.calc_band_percentile(
+        input_img, 0.5, 0, approx=True, n_threads=2
+    )
+
+    assert len(percent_val) == len(thrd_percent_val)
+    for val, thrd_val in zip(percent_val, thrd_percent_val):
+        assert abs(val - thrd_val) < 1
+
 def test_calc_img_rescale_sgl_img(tmp_path):
     import rsgislib.imagecalc
 
@@ -546,6 +707,36 @@ def test_calc_img_rescale_sgl_img(tmp_path):
     assert img_eq
 
 
+def test_calc_img_rescale_sgl_img_threads(tmp_path):
+    import rsgislib.imagecalc
+
+    rescale_ndvi_ref_img = os.path.join(
+        IMGCALC_DATA_DIR, "sen2_20210527_aber_ndvi_g100_o100_int.kea"
+    )
+    ndvi_img = os.path.join(IMGCALC_DATA_DIR, "sen2_20210527_aber_ndvi.kea")
+
+    output_img = os.path.join(tmp_path, "rescaled_ndvi_img.kea")
+
+    rsgislib.imagecalc.calc_img_rescale(
+        ndvi_img,
+        output_img,
+        "KEA",
+        rsgislib.TYPE_16INT,
+        -999,
+        0,
+        1,
+        999,
+        100,
+        100,
+        n_threads=4,
+    )
+
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(
+        output_img, rescale_ndvi_ref_img
+    )
+    assert img_eq
+
+
 def test_calc_img_rescale_multi_imgs(tmp_path):
     import rsgislib.imagecalc
 
@@ -600,6 +791,32 @@ def test_perform_image_pca(tmp_path):
     assert os.path.exists(output_img) and os.path.exists(out_eigen_vec_file)
 
 
+
+def test_calc_pca_eigen_vectors_pca(tmp_path):
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+
+    output_img = os.path.join(tmp_path, "pca_result_img.kea")
+    out_eigen_vec_file = os.path.join(tmp_path, "pca_eign_vec.mtxt")
+
+    var_explain = rsgislib.imagecalc.calc_pca_eigen_vectors(
+        input_img, out_eigen_vec_file, no_data_val=0, n_threads=2
+    )
+    assert abs(sum(var_explain) - 1.0) < 1e-6
+    assert all(a >= b for a, b in zip(var_explain, var_explain[1:]))
+
+    rsgislib.imagecalc.pca(
+        input_img,
+        out_eigen_vec_file,
+        output_img,
+        3,
+        "KEA",
+        rsgislib.TYPE_32FLOAT,
+        n_threads=2,
+    )
+    assert os.path.exists(output_img)
+
 @pytest.mark.skipif(SKLEARN_NOT_AVAIL, reason="scikit-learn dependency not available")
 def test_perform_image_mnf(tmp_path):
     import rsgislib.imagecalc
@@ -781,6 +998,67 @@ def test_calc_multi_img_band_stats(tmp_path):
     assert os.path.exists(output_img)
 
 
+def test_calc_temporal_outlier_chng(tmp_path):
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset.kea")
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.imagecalc.calc_temporal_outlier_chng(
+        [input_img, input_img, input_img],
+        output_img,
+        gdalformat="KEA",
+        img_band=1,
+        threshold=3.5,
+        no_data_val=0,
+        use_no_data=True,
+        n_threads=2,
+    )
+
+    assert os.path.exists(output_img)
+
+
+def test_calc_temporal_robust_fit_outliers(tmp_path):
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset.kea")
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    dates = [737000 + (i * 45) for i in range(12)]
+    rsgislib.imagecalc.calc_temporal_robust_fit_outliers(
+        [input_img] * 12,
+        dates,
+        output_img,
+        gdalformat="KEA",
+        img_bands=[1, 2],
+        no_data_val=0,
+        use_no_data=True,
+        n_threads=2,
+    )
+
+    assert os.path.exists(output_img)
+
+
+def test_calc_temporal_tmask(tmp_path):
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset.kea")
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    dates = [737000 + (i * 45) for i in range(12)]
+    rsgislib.imagecalc.calc_temporal_tmask(
+        [input_img] * 12,
+        dates,
+        output_img,
+        gdalformat="KEA",
+        green_band=2,
+        nir_band=4,
+        swir_band=5,
+        no_data_val=0,
+        use_no_data=True,
+        n_threads=2,
+    )
+
+    assert os.path.exists(output_img)
+
+
 def test_get_img_band_min_max():
     import rsgislib.imagecalc
 
@@ -901,6 +1179,23 @@ def test_calc_img_difference(tmp_path):
     assert os.path.exists(output_img)
 
 
+def test_calc_img_comparison_stats(tmp_path):
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset.kea")
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    band_stats = rsgislib.imagecalc.calc_img_comparison_stats(
+        input_img, input_img, output_img, "KEA", rsgislib.TYPE_32FLOAT
+    )
+    assert os.path.exists(output_img)
+    assert len(band_stats) > 0
+    for band_stat in band_stats:
+        assert band_stat["n_pxls"] > 0
+        assert band_stat["rmse"] == 0
+        assert band_stat["bias"] == 0
+        assert abs(band_stat["correlation"] - 1) < 1e-6
+
+
 def test_histogram(tmp_path):
     import rsgislib.imagecalc
 
@@ -921,6 +1216,21 @@ def test_get_histogram():
     rsgislib.imagecalc.get_histogram(input_img, 1, 1, True, 0, 0)
 
 
+
+def test_get_histogram_threads():
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset.kea")
+    bins, min_val, max_val = rsgislib.imagecalc.get_histogram(
+        input_img, 1, 1, True, 0, 0
+    )
+    thrd_bins, thrd_min_val, thrd_max_val = rsgislib.imagecalc.get_histogram(
+        input_img, 1, 1, True, 0, 0, n_threads=2
+    )
+
+    assert bins == thrd_bins
+    assert (min_val == thrd_min_val) and (max_val == thrd_max_val)
+
 def test_get_2d_img_histogram(tmp_path):
     import rsgislib.imagecalc
 
@@ -282,3 +282,38 @@ def test_calc_mvi(tmp_path):
         output_img, 1, ref_img, 1
     )
     assert prop_match > 0.95
+
+
+def test_calc_spectral_indices(tmp_path):
+    import rsgislib.imagecalc
+    import rsgislib.imagecalc.calcindices
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset.kea")
+    ndvi_ref_img = os.path.join(
+        IMGCALC_INDICES_DATA_DIR, "sen2_20210527_aber_subset_ndvi_ref.kea"
+    )
+    wbi_ref_img = os.path.join(
+        IMGCALC_INDICES_DATA_DIR, "sen2_20210527_aber_subset_wbi_ref.kea"
+    )
+
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.imagecalc.calcindices.calc_spectral_indices(
+        input_img,
+        output_img,
+        ["NDVI", "WBI"],
+        img_blue_band=1,
+        img_red_band=3,
+        img_nir_band=8,
+        calc_stats=True,
+        gdalformat="KEA",
+        n_threads=2,
+    )
+
+    img_eq, prop_match = rsgislib.imagecalc.are_img_bands_equal(
+        output_img, 1, ndvi_ref_img, 1
+    )
+    assert prop_match > 0.95
+    img_eq, prop_match = rsgislib.imagecalc.are_img_bands_equal(
+        output_img, 2, wbi_ref_img, 1
+    )
+    assert prop_match > 0.95
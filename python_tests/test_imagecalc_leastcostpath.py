@@ -4,14 +4,6 @@ import pytest
 DATA_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "data")
 
 
-SKIMAGE_NOT_AVAIL = False
-try:
-    import skimage
-except ImportError:
-    SKIMAGE_NOT_AVAIL = True
-
-
-@pytest.mark.skipif(SKIMAGE_NOT_AVAIL, reason="scikit-image dependency not available")
 def test_perform_least_cost_path_calc(tmp_path):
     import rsgislib.imagecalc.leastcostpath
 
@@ -28,3 +20,31 @@ def test_perform_least_cost_path_calc(tmp_path):
         cost_img_band=1,
     )
     assert os.path.exists(output_img)
+
+
+def test_calc_cost_distance_tiled(tmp_path):
+    import numpy
+    import rsgislib.imagecalc
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset.kea")
+    start_coord = (257938, 280795)
+    stop_coord = (260201, 280445)
+
+    dist_img = os.path.join(tmp_path, "dist_img.kea")
+    dir_img = os.path.join(tmp_path, "dir_img.kea")
+    rsgislib.imagecalc.calc_cost_distance(
+        input_img, dist_img, dir_img, src_coords=[start_coord]
+    )
+    tile_dist_img = os.path.join(tmp_path, "tile_dist_img.kea")
+    tile_dir_img = os.path.join(tmp_path, "tile_dir_img.kea")
+    rsgislib.imagecalc.calc_cost_distance(
+        input_img, tile_dist_img, tile_dir_img, src_coords=[start_coord], tile_size=50
+    )
+
+    dist_arr = rsgislib.imageutils.get_img_data_as_arr(dist_img)
+    tile_dist_arr = rsgislib.imageutils.get_img_data_as_arr(tile_dist_img)
+    assert numpy.allclose(dist_arr, tile_dist_arr)
+
+    path_coords = rsgislib.imagecalc.get_least_cost_path(dir_img, stop_coord)
+    assert len(path_coords) > 1
@@ -461,6 +461,33 @@ def test_exhcon_linear_spec_unmix(tmp_path):
     assert img_eq
 
 
+def test_exhcon_linear_spec_unmix_threads(tmp_path):
+    from rsgislib.imagecalc import specunmixing
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset.kea")
+    endmembers_file = os.path.join(SPECUNMIX_DATA_DIR, "sen2_endmembers.mtxt")
+
+    output_img = os.path.join(tmp_path, "sen2_unmixed_img.kea")
+    specunmixing.exhcon_linear_spec_unmix(
+        input_img,
+        output_img,
+        "KEA",
+        rsgislib.TYPE_32FLOAT,
+        endmembers_file,
+        0.1,
+        1,
+        0,
+        n_threads=2,
+    )
+
+    ref_unmix_img = os.path.join(
+        SPECUNMIX_DATA_DIR, "sen2_20210527_aber_subset_unmixed_exhcon.kea"
+    )
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(ref_unmix_img, output_img)
+    assert img_eq
+
+
 @pytest.mark.skipif(PYSPTOOLS_NOT_AVAIL, reason="pysptools dependency not available")
 def test_spec_unmix_spts_ucls_noWeight(tmp_path):
     from rsgislib.imagecalc import specunmixing
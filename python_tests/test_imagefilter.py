@@ -16,6 +16,48 @@ def test_apply_median_filter(tmp_path):
     assert os.path.exists(output_img)
 
 
+def test_apply_median_hist_filter(tmp_path):
+    import rsgislib.imagefilter
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset_b123.kea")
+    ref_img = os.path.join(tmp_path, "filter_ref.kea")
+    rsgislib.imagefilter.apply_median_filter(
+        input_img, ref_img, 7, "KEA", rsgislib.TYPE_16UINT
+    )
+    output_img = os.path.join(tmp_path, "filter_output.kea")
+    rsgislib.imagefilter.apply_median_hist_filter(
+        input_img, output_img, 7, 0, 65535, "KEA", rsgislib.TYPE_16UINT
+    )
+
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(ref_img, output_img)
+    assert img_eq
+
+
+def test_apply_percentile_hist_filter(tmp_path):
+    import rsgislib.imagefilter
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset_b123.kea")
+    output_img = os.path.join(tmp_path, "filter_output.kea")
+    rsgislib.imagefilter.apply_percentile_hist_filter(
+        input_img, output_img, 7, 90, 0, 65535, "KEA", rsgislib.TYPE_16UINT
+    )
+
+    assert os.path.exists(output_img)
+
+
+def test_apply_mode_hist_filter(tmp_path):
+    import rsgislib.imagefilter
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset_b123.kea")
+    output_img = os.path.join(tmp_path, "filter_output.kea")
+    rsgislib.imagefilter.apply_mode_hist_filter(
+        input_img, output_img, 7, 0, 65535, "KEA", rsgislib.TYPE_16UINT, 10
+    )
+
+    assert os.path.exists(output_img)
+
+
 def test_apply_mean_filter(tmp_path):
     import rsgislib.imagefilter
 
@@ -304,6 +346,26 @@ def test_apply_prewitt_y_filter(tmp_path):
     assert os.path.exists(output_img)
 
 
+def test_calc_gradient(tmp_path):
+    import rsgislib.imagefilter
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset_b123.kea")
+    output_img = os.path.join(tmp_path, "gradient_output.kea")
+    rsgislib.imagefilter.calc_gradient(
+        input_img,
+        output_img,
+        "KEA",
+        rsgislib.TYPE_32FLOAT,
+        grad_operator="Sobel",
+        output_xy=True,
+        n_threads=2,
+    )
+
+    assert os.path.exists(output_img)
+    assert rsgislib.imageutils.get_img_band_count(output_img) == 12
+
+
 def test_apply_gaussian_smooth_filter(tmp_path):
     import rsgislib.imagefilter
 
@@ -427,6 +489,53 @@ def test_apply_filters(tmp_path):
     assert len(imgs) == 3
 
 
+def test_apply_filters_fused_matches_unfused(tmp_path):
+    import rsgislib.imagefilter
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset_b123.kea")
+    fused_base = os.path.join(tmp_path, "fused")
+    unfused_base = os.path.join(tmp_path, "unfused")
+
+    filters = []
+    filters.append(
+        rsgislib.imagefilter.FilterParameters(
+            filter_type="Mean", file_ending="mean3", size=3
+        )
+    )
+    filters.append(
+        rsgislib.imagefilter.FilterParameters(
+            filter_type="Median", file_ending="median7", size=7
+        )
+    )
+    rsgislib.imagefilter.apply_filters(
+        input_img,
+        fused_base,
+        filters,
+        "KEA",
+        "kea",
+        rsgislib.TYPE_32FLOAT,
+        fused=True,
+        n_threads=2,
+    )
+    rsgislib.imagefilter.apply_filters(
+        input_img,
+        unfused_base,
+        filters,
+        "KEA",
+        "kea",
+        rsgislib.TYPE_32FLOAT,
+        fused=False,
+    )
+
+    for ending in ["mean3", "median7"]:
+        img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(
+            "{}{}.kea".format(fused_base, ending),
+            "{}{}.kea".format(unfused_base, ending),
+        )
+        assert img_eq
+
+
 def test_perform_tiled_img_multi_filter(tmp_path):
     import rsgislib.imagefilter.tiledfilter
 
@@ -33,6 +33,32 @@ def test_find_image_offset():
     assert abs((x_off - 3) < 0.5) and abs((y_off - 3) < 0.5)
 
 
+def test_find_image_offset_phase_corr():
+    import rsgislib.imageregistration
+
+    in_ref_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset_b123.kea")
+    in_float_img = os.path.join(
+        IMGREG_DATA_DIR, "sen2_20210527_aber_subset_b123_offset.kea"
+    )
+    x_off, y_off = rsgislib.imageregistration.find_image_offset_phase_corr(
+        in_ref_img, in_float_img, [1, 2, 3], [1, 2, 3], 4, 4, sub_pxl=True
+    )
+    assert (abs(x_off - 3) < 0.5) and (abs(y_off - 3) < 0.5)
+
+
+def test_find_image_offset_phase_corr_tiles():
+    import rsgislib.imageregistration
+
+    in_ref_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset_b123.kea")
+    in_float_img = os.path.join(
+        IMGREG_DATA_DIR, "sen2_20210527_aber_subset_b123_offset.kea"
+    )
+    x_off, y_off = rsgislib.imageregistration.find_image_offset_phase_corr(
+        in_ref_img, in_float_img, [1, 2, 3], [1, 2, 3], 4, 4, tile_size=64
+    )
+    assert (abs(x_off - 3) < 0.5) and (abs(y_off - 3) < 0.5)
+
+
 def test_apply_offset_to_image(tmp_path):
     import rsgislib.imageregistration
 
@@ -135,6 +161,27 @@ def test_warp_with_gcps_with_gdal(tmp_path):
     )
 
 
+def test_warp_with_gcps(tmp_path):
+    import rsgislib.imageregistration
+
+    in_ref_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset_b123.kea")
+    in_process_img = os.path.join(
+        IMGREG_DATA_DIR, "sen2_20210527_aber_subset_b123_offset_gcps.kea"
+    )
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.imageregistration.warp_with_gcps(
+        in_ref_img,
+        in_process_img,
+        output_img,
+        "KEA",
+        rsgislib.TYPE_16UINT,
+        interp_method=1,
+        use_tps=False,
+        poly_order=2,
+    )
+    assert os.path.exists(output_img)
+
+
 @pytest.mark.skipif(GEOPANDAS_NOT_AVAIL, reason="geopandas dependency not available")
 def test_add_vec_pts_as_gcps_to_img(tmp_path):
     import rsgislib.imageregistration
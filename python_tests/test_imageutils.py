@@ -263,6 +263,53 @@ def test_pop_img_stats(tmp_path):
     )
 
 
+def test_pop_img_stats_threads(tmp_path):
+    from osgeo import gdal
+    import rsgislib.imageutils
+
+    input_ref_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset.kea")
+    input_img = os.path.join(tmp_path, "sen2_20210527_aber_subset.kea")
+    copy2(input_ref_img, input_img)
+
+    rsgislib.imageutils.pop_img_stats(
+        input_img, use_no_data=True, no_data_val=0, calc_pyramids=True, n_threads=2
+    )
+
+    img_ds = gdal.Open(input_img)
+    assert img_ds.GetRasterBand(1).GetOverviewCount() > 0
+    img_ds = None
+
+
+def test_pop_img_stats_pyramids_same_stats(tmp_path):
+    from osgeo import gdal
+    import rsgislib.imageutils
+
+    input_ref_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset.kea")
+    input_img = os.path.join(tmp_path, "sen2_20210527_aber_subset.kea")
+    input_pyd_img = os.path.join(tmp_path, "sen2_20210527_aber_subset_pyd.kea")
+    copy2(input_ref_img, input_img)
+    copy2(input_ref_img, input_pyd_img)
+
+    rsgislib.imageutils.pop_img_stats(
+        input_img, use_no_data=True, no_data_val=0, calc_pyramids=False
+    )
+    rsgislib.imageutils.pop_img_stats(
+        input_pyd_img, use_no_data=True, no_data_val=0, calc_pyramids=True
+    )
+
+    img_ds = gdal.Open(input_img)
+    img_pyd_ds = gdal.Open(input_pyd_img)
+    for n in range(img_ds.RasterCount):
+        band = img_ds.GetRasterBand(n + 1)
+        band_pyd = img_pyd_ds.GetRasterBand(n + 1)
+        for stat in ["MINIMUM", "MAXIMUM", "MEAN", "STDDEV", "HISTOBINVALUES"]:
+            assert band.GetMetadataItem(
+                "STATISTICS_{}".format(stat)
+            ) == band_pyd.GetMetadataItem("STATISTICS_{}".format(stat))
+    img_ds = None
+    img_pyd_ds = None
+
+
 def test_pop_thmt_img_stats(tmp_path):
     import rsgislib.imageutils
 
@@ -546,6 +593,60 @@ def test_create_img_mosaic(tmp_path):
     assert os.path.exists(output_img)
 
 
+def test_create_img_mosaic_threads(tmp_path):
+    import rsgislib
+    import rsgislib.imageutils
+    import rsgislib.imagecalc
+    import glob
+
+    imgs = glob.glob(os.path.join(IMGUTILS_DATA_DIR, "s2_tiles", "*.kea"))
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.imageutils.create_img_mosaic(
+        imgs, output_img, 0, 0, 1, 0, "KEA", rsgislib.TYPE_16UINT
+    )
+    output_thrd_img = os.path.join(tmp_path, "out_thrd_img.kea")
+    rsgislib.imageutils.create_img_mosaic(
+        imgs, output_thrd_img, 0, 0, 1, 0, "KEA", rsgislib.TYPE_16UINT, n_threads=4
+    )
+
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(output_img, output_thrd_img)
+    assert img_eq
+
+
+def test_update_img_mosaic(tmp_path):
+    import rsgislib
+    import rsgislib.imageutils
+    import rsgislib.imagecalc
+    import glob
+
+    imgs = sorted(glob.glob(os.path.join(IMGUTILS_DATA_DIR, "s2_tiles", "*.kea")))
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.imageutils.create_img_mosaic(
+        imgs, output_img, 0, 0, 1, 2, "KEA", rsgislib.TYPE_16UINT
+    )
+    output_upd_img = os.path.join(tmp_path, "out_upd_img.kea")
+    output_ref_img = os.path.join(tmp_path, "out_ref_img.kea")
+    rsgislib.imageutils.create_img_mosaic(
+        imgs,
+        output_upd_img,
+        0,
+        0,
+        1,
+        2,
+        "KEA",
+        rsgislib.TYPE_16UINT,
+        out_ref_img=output_ref_img,
+    )
+    # Taking the maximum, adding an image again leaves the mosaic unchanged.
+    rsgislib.imageutils.update_img_mosaic(
+        imgs[:1], output_upd_img, ref_img=output_ref_img, overlap_behaviour=2
+    )
+
+    assert os.path.exists(output_ref_img)
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(output_img, output_upd_img)
+    assert img_eq
+
+
 def test_include_imgs(tmp_path):
     import rsgislib
     import rsgislib.imageutils
@@ -563,6 +664,31 @@ def test_include_imgs(tmp_path):
     assert os.path.exists(output_img)
 
 
+def test_include_imgs_threads(tmp_path):
+    import rsgislib
+    import rsgislib.imageutils
+    import rsgislib.imagecalc
+    import glob
+
+    input_ref_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    imgs = glob.glob(os.path.join(IMGUTILS_DATA_DIR, "s2_tiles", "*.kea"))
+
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.imageutils.create_copy_img(
+        input_ref_img, output_img, 10, 0, "KEA", rsgislib.TYPE_16UINT
+    )
+    rsgislib.imageutils.include_imgs(output_img, imgs, skip_val=0.0)
+
+    output_thrd_img = os.path.join(tmp_path, "out_thrd_img.kea")
+    rsgislib.imageutils.create_copy_img(
+        input_ref_img, output_thrd_img, 10, 0, "KEA", rsgislib.TYPE_16UINT
+    )
+    rsgislib.imageutils.include_imgs(output_thrd_img, imgs, skip_val=0.0, n_threads=4)
+
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(output_img, output_thrd_img)
+    assert img_eq
+
+
 def test_include_imgs_with_overlap(tmp_path):
     import rsgislib
     import rsgislib.imageutils
@@ -614,6 +740,44 @@ def test_combine_imgs_to_band(tmp_path):
 # TODO rsgislib.imageutils.create_ref_img_composite_img
 
 
+def test_create_percentile_composite_img(tmp_path):
+    import rsgislib
+    import rsgislib.imagecalc
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.imageutils.create_percentile_composite_img(
+        [input_img, input_img, input_img],
+        output_img,
+        50,
+        gdalformat="KEA",
+        datatype=rsgislib.TYPE_16UINT,
+    )
+
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(input_img, output_img)
+    assert img_eq
+
+
+def test_create_medoid_composite_img(tmp_path):
+    import rsgislib
+    import rsgislib.imagecalc
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.imageutils.create_medoid_composite_img(
+        [input_img, input_img, input_img],
+        output_img,
+        [1, 2, 3],
+        gdalformat="KEA",
+        datatype=rsgislib.TYPE_16UINT,
+    )
+
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(input_img, output_img)
+    assert img_eq
+
+
 def test_combine_binary_masks(tmp_path):
     import rsgislib
     import rsgislib.imageutils
@@ -642,7 +806,30 @@ def test_combine_binary_masks(tmp_path):
 
 
 # TODO rsgislib.imageutils.export_single_merged_img_band
-# TODO rsgislib.imageutils.order_img_using_prop_valid_pxls
+
+
+def test_order_img_using_prop_valid_pxls():
+    import rsgislib.imageutils
+    import glob
+
+    imgs = glob.glob(os.path.join(IMGUTILS_DATA_DIR, "s2_tiles", "*.kea"))
+    ordered_imgs = rsgislib.imageutils.order_img_using_prop_valid_pxls(imgs, 0)
+    assert sorted(ordered_imgs) == sorted(imgs)
+
+
+def test_order_img_using_prop_valid_pxls_est():
+    import rsgislib
+    import rsgislib.imageutils
+    import glob
+
+    imgs = glob.glob(os.path.join(IMGUTILS_DATA_DIR, "s2_tiles", "*.kea"))
+    for est_mode in [rsgislib.VLD_PXL_EST_OVERVIEW, rsgislib.VLD_PXL_EST_SAMPLE]:
+        ordered_imgs = rsgislib.imageutils.order_img_using_prop_valid_pxls(
+            imgs, 0, est_mode=est_mode, err_tol=0.05, n_threads=2
+        )
+        assert sorted(ordered_imgs) == sorted(imgs)
+
+
 # TODO rsgislib.imageutils.gen_timeseries_fill_composite_img
 
 
@@ -680,6 +867,36 @@ def test_create_tiles_outpath_exp(tmp_path):
         )
 
 
+def test_create_tiles_n_threads(tmp_path):
+    import rsgislib
+    import rsgislib.imageutils
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    out_img_base = os.path.join(tmp_path, "out_img")
+    tiles = rsgislib.imageutils.create_tiles(
+        input_img, out_img_base, 200, 200, 0, False, "KEA", rsgislib.TYPE_16UINT, "kea"
+    )
+    out_thrd_img_base = os.path.join(tmp_path, "out_thrd_img")
+    thrd_tiles = rsgislib.imageutils.create_tiles(
+        input_img,
+        out_thrd_img_base,
+        200,
+        200,
+        0,
+        False,
+        "KEA",
+        rsgislib.TYPE_16UINT,
+        "kea",
+        n_threads=4,
+    )
+
+    assert len(thrd_tiles) == len(tiles)
+    for tile_img, thrd_tile_img in zip(tiles, thrd_tiles):
+        img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(tile_img, thrd_tile_img)
+        assert img_eq
+
+
 def test_create_tiles_multi_core(tmp_path):
     import rsgislib
     import rsgislib.imageutils
@@ -729,6 +946,29 @@ def test_stretch_img(tmp_path):
     assert os.path.exists(output_img)
 
 
+def test_stretch_img_approx_percent(tmp_path):
+    import rsgislib
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset.kea")
+    output_img = os.path.join(tmp_path, "output_img.kea")
+    out_stats_file = os.path.join(tmp_path, "output_stats.txt")
+    rsgislib.imageutils.stretch_img(
+        input_img,
+        output_img,
+        True,
+        out_stats_file,
+        0,
+        False,
+        "KEA",
+        rsgislib.TYPE_8UINT,
+        rsgislib.imageutils.STRETCH_APPROXPERCENT,
+        2,
+    )
+
+    assert os.path.exists(output_img) and os.path.exists(out_stats_file)
+
+
 @pytest.mark.skipif(
     True,
     reason="Sometimes stretch_img_with_stats freezes on MacOS and haven't figured out why yet...",
@@ -850,6 +1090,115 @@ def test_mask_img(tmp_path):
     assert os.path.exists(output_img)
 
 
+def test_create_tiles_from_masks(tmp_path):
+    import rsgislib.imageutils
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    in_msk_img = os.path.join(DATA_DIR, "sen2_20210527_aber_vldmsk.kea")
+
+    # The tiles should match masking the image with each mask in turn.
+    ref_img = os.path.join(tmp_path, "ref_img.kea")
+    rsgislib.imageutils.mask_img(
+        input_img, in_msk_img, ref_img, "KEA", rsgislib.TYPE_16UINT, 0, 0
+    )
+    out_imgs = [
+        os.path.join(tmp_path, "out_img1.kea"),
+        os.path.join(tmp_path, "out_img2.kea"),
+    ]
+    rsgislib.imageutils.create_tiles_from_masks(
+        input_img,
+        [in_msk_img, in_msk_img],
+        out_imgs,
+        "KEA",
+        rsgislib.TYPE_16UINT,
+        out_value=0,
+        mask_value=0,
+        n_threads=2,
+    )
+
+    for out_img in out_imgs:
+        img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(ref_img, out_img)
+        assert img_eq
+
+
+def test_mask_img_native_type(tmp_path):
+    import rsgislib.imageutils
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    in_msk_img = os.path.join(DATA_DIR, "sen2_20210527_aber_vldmsk.kea")
+
+    # The 16 bit output uses the native pixel type path while the float output
+    # uses the float path so both should produce the same pixel values.
+    out_uint_img = os.path.join(tmp_path, "out_uint_img.kea")
+    rsgislib.imageutils.mask_img(
+        input_img, in_msk_img, out_uint_img, "KEA", rsgislib.TYPE_16UINT, 0, 0
+    )
+    out_flt_img = os.path.join(tmp_path, "out_flt_img.kea")
+    rsgislib.imageutils.mask_img(
+        input_img, in_msk_img, out_flt_img, "KEA", rsgislib.TYPE_32FLOAT, 0, 0
+    )
+
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(out_uint_img, out_flt_img)
+    assert img_eq
+
+
+def test_mask_img_multi_out_vals(tmp_path):
+    import rsgislib.imageutils
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    in_msk_img = os.path.join(DATA_DIR, "sen2_20210527_aber_vldmsk.kea")
+
+    # A list of output values (one per mask value) with threads should give
+    # the same result as the single output value.
+    out_sgl_img = os.path.join(tmp_path, "out_sgl_img.kea")
+    rsgislib.imageutils.mask_img(
+        input_img, in_msk_img, out_sgl_img, "KEA", rsgislib.TYPE_16UINT, 0, [0, 2]
+    )
+    out_multi_img = os.path.join(tmp_path, "out_multi_img.kea")
+    rsgislib.imageutils.mask_img(
+        input_img,
+        in_msk_img,
+        out_multi_img,
+        "KEA",
+        rsgislib.TYPE_16UINT,
+        [0, 0],
+        [0, 2],
+        n_threads=2,
+    )
+
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(out_sgl_img, out_multi_img)
+    assert img_eq
+
+
+def test_mask_img_io_buffers(tmp_path):
+    import rsgislib.imageutils
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    in_msk_img = os.path.join(DATA_DIR, "sen2_20210527_aber_vldmsk.kea")
+
+    out_serial_img = os.path.join(tmp_path, "out_serial_img.kea")
+    rsgislib.imageutils.mask_img(
+        input_img, in_msk_img, out_serial_img, "KEA", rsgislib.TYPE_32FLOAT, 0, 0
+    )
+
+    rsgislib.imageutils.set_calc_img_io_buffers(3)
+    try:
+        assert rsgislib.imageutils.get_calc_img_io_buffers() == 3
+        out_pipe_img = os.path.join(tmp_path, "out_pipe_img.kea")
+        rsgislib.imageutils.mask_img(
+            input_img, in_msk_img, out_pipe_img, "KEA", rsgislib.TYPE_32FLOAT, 0, 0
+        )
+    finally:
+        rsgislib.imageutils.set_calc_img_io_buffers(1)
+
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(out_serial_img, out_pipe_img)
+    assert img_eq
+
+
 def test_gen_finite_mask(tmp_path):
     import rsgislib.imageutils
 
@@ -872,6 +1221,25 @@ def test_gen_valid_mask(tmp_path):
     assert os.path.exists(output_img)
 
 
+def test_gen_valid_mask_multi_imgs_or(tmp_path):
+    import rsgislib
+    import rsgislib.imageutils
+    import glob
+
+    imgs = glob.glob(os.path.join(IMGUTILS_DATA_DIR, "s2_tiles", "*.kea"))
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.imageutils.gen_valid_mask(
+        imgs,
+        output_img,
+        gdalformat="KEA",
+        no_data_val=0.0,
+        combine_mthd=rsgislib.LOGIC_OR,
+        n_threads=2,
+    )
+
+    assert os.path.exists(output_img)
+
+
 def test_gen_img_edge_mask(tmp_path):
     import rsgislib.imageutils
 
@@ -1017,6 +1385,42 @@ def test_subset_bbox(tmp_path):
     assert os.path.exists(output_img)
 
 
+def test_subset_bboxs(tmp_path):
+    import rsgislib.imageutils
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    in_roi_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset.kea")
+    bbox = rsgislib.imageutils.get_img_bbox(in_roi_img)
+    ref_img = os.path.join(tmp_path, "ref_img.kea")
+    rsgislib.imageutils.subset_bbox(
+        input_img,
+        ref_img,
+        "KEA",
+        rsgislib.TYPE_16UINT,
+        bbox[0],
+        bbox[1],
+        bbox[2],
+        bbox[3],
+    )
+
+    # The second bbox does not overlap the image so is skipped.
+    out_bboxs = [bbox, [0.0, 10.0, 0.0, 10.0], bbox]
+    output_imgs = [
+        os.path.join(tmp_path, "out_img1.kea"),
+        os.path.join(tmp_path, "out_img2.kea"),
+        os.path.join(tmp_path, "out_img3.kea"),
+    ]
+    out_files = rsgislib.imageutils.subset_bboxs(
+        input_img, out_bboxs, output_imgs, "KEA", rsgislib.TYPE_16UINT, n_threads=2
+    )
+
+    assert out_files == [output_imgs[0], output_imgs[2]]
+    for out_file in out_files:
+        img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(ref_img, out_file)
+        assert img_eq
+
+
 def test_subset_pxl_bbox(tmp_path):
     import rsgislib.imageutils
 
@@ -1071,6 +1475,49 @@ def test_perform_random_pxl_sample_in_mask_low_pxl_count(tmp_path):
     assert os.path.exists(output_img)
 
 
+def test_perform_random_pxl_sample_in_mask_low_pxl_count_row_counts(tmp_path):
+    import rsgislib.imageutils
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "aber_osgb_multi_polys_rasters.kea")
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.imageutils.perform_random_pxl_sample_in_mask_low_pxl_count(
+        input_img,
+        output_img,
+        gdalformat="KEA",
+        mask_vals=[1, 2],
+        n_samples=10,
+        rnd_seed=5,
+    )
+    output_row_img = os.path.join(tmp_path, "out_row_img.kea")
+    rsgislib.imageutils.perform_random_pxl_sample_in_mask_low_pxl_count(
+        input_img,
+        output_row_img,
+        gdalformat="KEA",
+        mask_vals=[1, 2],
+        n_samples=10,
+        rnd_seed=5,
+        use_row_counts=True,
+    )
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(output_img, output_row_img)
+    assert img_eq
+
+
+def test_create_pxl_index_sidecar(tmp_path):
+    import rsgislib.imageutils
+
+    input_img = os.path.join(tmp_path, "aber_osgb_multi_polys_rasters.kea")
+    copy2(os.path.join(DATA_DIR, "aber_osgb_multi_polys_rasters.kea"), input_img)
+    rsgislib.imageutils.create_pxl_index_sidecar(input_img, img_band=1)
+    assert os.path.exists(input_img + ".b1.pxlidx")
+
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.imageutils.perform_random_pxl_sample_in_mask_low_pxl_count(
+        input_img, output_img, gdalformat="KEA", mask_vals=1, n_samples=10
+    )
+    assert os.path.exists(output_img)
+
+
 def test_extract_img_pxl_sample():
     import rsgislib.imageutils
 
@@ -1330,6 +1777,34 @@ def test_stack_img_bands(tmp_path):
     assert os.path.exists(output_img)
 
 
+def test_stack_img_bands_vrt(tmp_path):
+    import rsgislib.imageutils
+    import rsgislib.imagecalc
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset_b123.kea")
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.imageutils.stack_img_bands(
+        [input_img, input_img],
+        None,
+        output_img,
+        None,
+        0,
+        "KEA",
+        rsgislib.TYPE_16UINT,
+        n_threads=2,
+    )
+    # The virtual stack should have the same values and band names as the copy.
+    output_vrt = os.path.join(tmp_path, "out_img.vrt")
+    rsgislib.imageutils.stack_img_bands(
+        [input_img, input_img], None, output_vrt, None, 0, "VRT", rsgislib.TYPE_16UINT
+    )
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(output_img, output_vrt)
+    assert img_eq
+    assert rsgislib.imageutils.get_band_names(
+        output_vrt
+    ) == rsgislib.imageutils.get_band_names(output_img)
+
+
 # TODO rsgislib.imageutils.pan_sharpen_hcs
 # TODO rsgislib.imageutils.sharpen_low_res_bands
 
@@ -1706,3 +2181,147 @@ def test_get_img_pxl_coords():
         and (x_pxl_coords[1] == 284)
         and (y_pxl_coords[1] == 325)
     )
+
+
+def test_sample_img_points():
+    import rsgislib.imageutils
+    import numpy
+    from osgeo import gdal
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber_subset.kea")
+
+    x_coords = numpy.array([260453.28, 260430.37, 0.0])
+    y_coords = numpy.array([281327.15, 279581.76, 0.0])
+
+    vals = rsgislib.imageutils.sample_img_points(
+        input_img, x_coords, y_coords, img_bands=[1, 3], no_data_val=-1, n_threads=2
+    )
+    assert vals.shape == (3, 2)
+
+    img_ds = gdal.Open(input_img)
+    for band_idx, band in enumerate([1, 3]):
+        band_arr = img_ds.GetRasterBand(band).ReadAsArray()
+        assert vals[0, band_idx] == band_arr[151, 286]
+        assert vals[1, band_idx] == band_arr[325, 284]
+        # The last point is outside of the image.
+        assert vals[2, band_idx] == -1
+    img_ds = None
+
+
+def test_decode_bit_fields(tmp_path):
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.imageutils.decode_bit_fields(
+        input_img, 1, output_img, "KEA", [(0, 1), (3, 1), (8, 2)], n_threads=2
+    )
+
+    assert os.path.exists(output_img)
+
+
+def test_gen_bit_pattern_mask(tmp_path):
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rules = [(1 << 3, 1 << 3, 1), (1 << 4, 1 << 4, 2)]
+    rsgislib.imageutils.gen_bit_pattern_mask(
+        input_img, 1, output_img, "KEA", rules, no_match_val=0, n_threads=2
+    )
+
+    assert os.path.exists(output_img)
+
+
+def test_set_calc_img_exec_context_remote_max_requests():
+    import rsgislib.imageutils
+
+    init_context = rsgislib.imageutils.get_calc_img_exec_context()
+    try:
+        rsgislib.imageutils.set_calc_img_exec_context(remote_max_requests=8)
+        context = rsgislib.imageutils.get_calc_img_exec_context()
+        assert context["remote_max_requests"] == 8
+    finally:
+        rsgislib.imageutils.set_calc_img_exec_context(**init_context)
+
+
+def test_set_calc_img_exec_context_use_gpu():
+    import rsgislib.imageutils
+
+    init_context = rsgislib.imageutils.get_calc_img_exec_context()
+    assert not init_context["use_gpu"]
+    try:
+        if rsgislib.imageutils.get_gpu_device() is None:
+            with pytest.raises(Exception):
+                rsgislib.imageutils.set_calc_img_exec_context(use_gpu=True)
+        else:
+            rsgislib.imageutils.set_calc_img_exec_context(use_gpu=True)
+            context = rsgislib.imageutils.get_calc_img_exec_context()
+            assert context["use_gpu"]
+    finally:
+        rsgislib.imageutils.set_calc_img_exec_context(**init_context)
+
+
+def test_set_calc_img_exec_context_numa_placement(tmp_path):
+    import rsgislib.imageutils
+
+    init_context = rsgislib.imageutils.get_calc_img_exec_context()
+    assert not init_context["numa_placement"]
+    try:
+        rsgislib.imageutils.set_calc_img_exec_context(numa_placement=True)
+        context = rsgislib.imageutils.get_calc_img_exec_context()
+        assert context["numa_placement"]
+
+        input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+        output_img = os.path.join(tmp_path, "out_img.kea")
+        rules = [(1 << 3, 1 << 3, 1), (1 << 4, 1 << 4, 2)]
+        rsgislib.imageutils.gen_bit_pattern_mask(
+            input_img, 1, output_img, "KEA", rules, no_match_val=0, n_threads=2
+        )
+        assert os.path.exists(output_img)
+    finally:
+        rsgislib.imageutils.set_calc_img_exec_context(**init_context)
+
+
+def test_estimate_cmd_resources():
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    init_context = rsgislib.imageutils.get_calc_img_exec_context()
+    try:
+        rsgislib.imageutils.set_calc_img_exec_context(memory_budget_mb=1)
+        estimate = rsgislib.imageutils.estimate_cmd_resources(
+            [input_img], strategy="strips", n_out_bands=1
+        )
+        assert estimate["peak_mem_mb"] > 0
+        assert estimate["read_mb"] > 0
+        assert not estimate["within_budget"]
+
+        estimate = rsgislib.imageutils.estimate_cmd_resources(input_img, strategy="bands")
+        assert estimate["peak_mem_mb"] > estimate["read_mb"]
+    finally:
+        rsgislib.imageutils.set_calc_img_exec_context(**init_context)
+
+
+def test_calc_dist_to_nearest_feature(tmp_path):
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "imagecalc", "sen2_20210527_aber_ndvi_cats.kea")
+    out_dist_img = os.path.join(tmp_path, "out_dist.kea")
+    out_label_img = os.path.join(tmp_path, "out_label.kea")
+    rsgislib.imageutils.calc_dist_to_nearest_feature(
+        input_img, out_dist_img, out_label_img=out_label_img, max_dist=200
+    )
+    assert os.path.exists(out_dist_img)
+    assert os.path.exists(out_label_img)
+
+
+def test_calc_dist_to_img_classes(tmp_path):
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "imagecalc", "sen2_20210527_aber_ndvi_cats.kea")
+    out_dist_img = os.path.join(tmp_path, "out_dist.kea")
+    rsgislib.imageutils.calc_dist_to_img_classes(
+        input_img, out_dist_img, class_ids=[1, 2, 3]
+    )
+    assert rsgislib.imageutils.get_img_band_count(out_dist_img) == 3
@@ -0,0 +1,292 @@
+import json
+import math
+import os
+import time
+
+import pytest
+
+# End-to-end performance regression tests. These are slow and generate large
+# synthetic datasets so they are only run when RSGISLIB_PERF_TESTS=1 is set.
+#
+# Environment variables:
+#   RSGISLIB_PERF_TESTS           - set to 1 to enable the tests.
+#   RSGISLIB_PERF_SCALE           - multiplies the number of pixels and points
+#                                   (default 1 = 8192 x 8192 pixel scenes and
+#                                   1 million points; 32 gives ~2 Gpx scenes).
+#   RSGISLIB_PERF_BASELINE        - JSON file of baseline timings (default
+#                                   perf_baselines.json next to this file).
+#   RSGISLIB_PERF_UPDATE_BASELINE - set to 1 to (re)write the baselines from
+#                                   this run rather than checking against them.
+#   RSGISLIB_PERF_TOLERANCE       - fractional slowdown in throughput allowed
+#                                   before a test fails (default 0.25).
+#   RSGISLIB_PERF_RESULTS         - optional JSON file the timings of this run
+#                                   are written to.
+#
+# Baselines are machine specific so are not committed; create them on the
+# machine being used for the comparison before and after a change. Throughput
+# (units per second) rather than wall time is compared so baselines remain
+# meaningful if the scale is changed.
+
+PERF_TESTS_NOT_ENABLED = os.environ.get("RSGISLIB_PERF_TESTS", "0") != "1"
+PERF_SCALE = float(os.environ.get("RSGISLIB_PERF_SCALE", "1"))
+PERF_BASELINE_FILE = os.environ.get(
+    "RSGISLIB_PERF_BASELINE",
+    os.path.join(os.path.dirname(os.path.abspath(__file__)), "perf_baselines.json"),
+)
+PERF_UPDATE_BASELINE = os.environ.get("RSGISLIB_PERF_UPDATE_BASELINE", "0") == "1"
+PERF_TOLERANCE = float(os.environ.get("RSGISLIB_PERF_TOLERANCE", "0.25"))
+PERF_RESULTS_FILE = os.environ.get("RSGISLIB_PERF_RESULTS", None)
+PERF_SKIP_REASON = "set RSGISLIB_PERF_TESTS=1 to run the performance tests"
+
+# Keep the image size a multiple of 64 so the synthetic blocks tile exactly.
+PERF_IMG_SIZE = max(64, int(8192 * math.sqrt(PERF_SCALE)) // 64 * 64)
+PERF_N_PXLS = PERF_IMG_SIZE * PERF_IMG_SIZE
+PERF_N_PTS = max(1000, int(1000000 * PERF_SCALE))
+PERF_EPSG = 27700
+
+
+def _create_block_img(output_img, n_bands, block_size, out_vals, datatype, tmp_dir):
+    import rsgislib.imageutils
+    import rsgislib.tools.projection
+    import rsgislib.tools.testimages
+    from osgeo import gdal
+
+    n_blocks = PERF_IMG_SIZE // block_size
+    tmp_img = os.path.join(tmp_dir, "tmp_blks_{}".format(os.path.basename(output_img)))
+    rsgislib.tools.testimages.create_random_int_img(
+        tmp_img,
+        n_bands,
+        n_blocks,
+        n_blocks,
+        out_vals,
+        gdalformat="KEA",
+        datatype=datatype,
+        calc_stats=False,
+        tmp_path=tmp_dir,
+    )
+    # Nearest neighbour up-sampling gives the random values spatial structure
+    # so segmentation and clumping produce realistic numbers of segments.
+    gdal.Translate(
+        output_img,
+        tmp_img,
+        format="KEA",
+        width=PERF_IMG_SIZE,
+        height=PERF_IMG_SIZE,
+        resampleAlg="near",
+    )
+    rsgislib.imageutils.assign_wkt_proj(
+        output_img, rsgislib.tools.projection.get_wkt_from_epsg_code(PERF_EPSG)
+    )
+    rsgislib.imageutils.delete_gdal_layer(tmp_img)
+
+
+def _check_perf(test_name, elapsed, n_units, unit):
+    throughput = n_units / elapsed
+    result = {
+        "seconds": elapsed,
+        "throughput": throughput,
+        "unit": unit,
+        "n_units": n_units,
+        "scale": PERF_SCALE,
+    }
+    print(
+        "{}: {:.2f} s ({:.1f} {}/s)".format(test_name, elapsed, throughput, unit)
+    )
+
+    if PERF_RESULTS_FILE is not None:
+        results = dict()
+        if os.path.exists(PERF_RESULTS_FILE):
+            with open(PERF_RESULTS_FILE) as in_json_file:
+                results = json.load(in_json_file)
+        results[test_name] = result
+        with open(PERF_RESULTS_FILE, "w") as out_json_file:
+            json.dump(results, out_json_file, sort_keys=True, indent=4)
+
+    baselines = dict()
+    if os.path.exists(PERF_BASELINE_FILE):
+        with open(PERF_BASELINE_FILE) as in_json_file:
+            baselines = json.load(in_json_file)
+
+    if PERF_UPDATE_BASELINE or (test_name not in baselines):
+        baselines[test_name] = result
+        with open(PERF_BASELINE_FILE, "w") as out_json_file:
+            json.dump(baselines, out_json_file, sort_keys=True, indent=4)
+        return
+
+    base_throughput = baselines[test_name]["throughput"]
+    min_throughput = base_throughput / (1.0 + PERF_TOLERANCE)
+    assert throughput >= min_throughput, (
+        "{} regressed: {:.1f} {}/s against a baseline of "
+        "{:.1f} {}/s".format(test_name, throughput, unit, base_throughput, unit)
+    )
+
+
+@pytest.fixture(scope="module")
+def perf_scene_img(tmp_path_factory):
+    import rsgislib
+
+    tmp_dir = str(tmp_path_factory.mktemp("perf_scene"))
+    scene_img = os.path.join(tmp_dir, "perf_scene.kea")
+    _create_block_img(
+        scene_img, 3, 8, list(range(1, 256)), rsgislib.TYPE_8UINT, tmp_dir
+    )
+    return scene_img
+
+
+@pytest.fixture(scope="module")
+def perf_clumps_img(tmp_path_factory):
+    import rsgislib
+    import rsgislib.segmentation
+
+    tmp_dir = str(tmp_path_factory.mktemp("perf_clumps"))
+    cls_img = os.path.join(tmp_dir, "perf_cls.kea")
+    _create_block_img(cls_img, 1, 4, list(range(1, 21)), rsgislib.TYPE_8UINT, tmp_dir)
+    # 4 x 4 pixel blocks with 20 values gives millions of clumps at scale 1.
+    clumps_img = os.path.join(tmp_dir, "perf_clumps.kea")
+    rsgislib.segmentation.clump(cls_img, clumps_img, gdalformat="KEA")
+    return clumps_img
+
+
+@pytest.mark.skipif(PERF_TESTS_NOT_ENABLED, reason=PERF_SKIP_REASON)
+def test_perf_shepherd_segmentation(tmp_path, perf_scene_img):
+    import rsgislib.segmentation.shepherdseg
+
+    out_clumps_img = os.path.join(tmp_path, "perf_shep_clumps.kea")
+    tmp_dir = os.path.join(tmp_path, "seg_tmp")
+
+    start_time = time.perf_counter()
+    rsgislib.segmentation.shepherdseg.run_shepherd_segmentation(
+        perf_scene_img,
+        out_clumps_img,
+        tmp_dir=tmp_dir,
+        gdalformat="KEA",
+        calc_stats=False,
+        num_clusters=60,
+        min_n_pxls=100,
+    )
+    elapsed = time.perf_counter() - start_time
+
+    assert os.path.exists(out_clumps_img)
+    _check_perf("shepherd_segmentation", elapsed, PERF_N_PXLS, "pxls")
+
+
+@pytest.mark.skipif(PERF_TESTS_NOT_ENABLED, reason=PERF_SKIP_REASON)
+def test_perf_populate_rat_with_stats(perf_scene_img, perf_clumps_img):
+    import rsgislib.rastergis
+
+    band_stats = []
+    for band in range(1, 4):
+        band_stats.append(
+            rsgislib.rastergis.BandAttStats(
+                band=band,
+                min_field="b{}_min".format(band),
+                max_field="b{}_max".format(band),
+                mean_field="b{}_mean".format(band),
+                std_dev_field="b{}_std".format(band),
+            )
+        )
+
+    start_time = time.perf_counter()
+    rsgislib.rastergis.populate_rat_with_stats(
+        perf_scene_img, perf_clumps_img, band_stats
+    )
+    elapsed = time.perf_counter() - start_time
+
+    _check_perf("populate_rat_with_stats", elapsed, PERF_N_PXLS, "pxls")
+
+
+@pytest.mark.skipif(PERF_TESTS_NOT_ENABLED, reason=PERF_SKIP_REASON)
+def test_perf_create_img_mosaic(tmp_path, perf_scene_img):
+    import rsgislib
+    import rsgislib.imageutils
+    from osgeo import gdal
+
+    # Four tiles which overlap their neighbours by 64 pixels.
+    half_size = PERF_IMG_SIZE // 2
+    tile_size = half_size + 64
+    tile_imgs = []
+    for x_off in [0, half_size - 64]:
+        for y_off in [0, half_size - 64]:
+            tile_img = os.path.join(
+                tmp_path, "perf_tile_{}_{}.kea".format(x_off, y_off)
+            )
+            gdal.Translate(
+                tile_img,
+                perf_scene_img,
+                format="KEA",
+                srcWin=[x_off, y_off, tile_size, tile_size],
+            )
+            tile_imgs.append(tile_img)
+
+    out_img = os.path.join(tmp_path, "perf_mosaic.kea")
+    start_time = time.perf_counter()
+    rsgislib.imageutils.create_img_mosaic(
+        tile_imgs, out_img, 0, 0, 1, 0, "KEA", rsgislib.TYPE_8UINT
+    )
+    elapsed = time.perf_counter() - start_time
+
+    assert os.path.exists(out_img)
+    _check_perf("create_img_mosaic", elapsed, PERF_N_PXLS, "pxls")
+
+
+@pytest.mark.skipif(PERF_TESTS_NOT_ENABLED, reason=PERF_SKIP_REASON)
+def test_perf_ext_point_band_values(tmp_path, perf_scene_img):
+    import rsgislib.imageutils
+    import rsgislib.vectorutils.createvectors
+    import rsgislib.zonalstats
+
+    vec_file = os.path.join(tmp_path, "perf_pts.gpkg")
+    vec_lyr = "perf_pts"
+    rsgislib.vectorutils.createvectors.create_random_pts_in_bbox(
+        rsgislib.imageutils.get_img_bbox(perf_scene_img),
+        PERF_N_PTS,
+        PERF_EPSG,
+        vec_file,
+        vec_lyr,
+        out_format="GPKG",
+        rnd_seed=42,
+    )
+
+    start_time = time.perf_counter()
+    rsgislib.zonalstats.ext_point_band_values_file(
+        vec_file, vec_lyr, perf_scene_img, 1, 0, 255, 0, "b1"
+    )
+    elapsed = time.perf_counter() - start_time
+
+    _check_perf("ext_point_band_values", elapsed, PERF_N_PTS, "pts")
+
+
+@pytest.mark.skipif(PERF_TESTS_NOT_ENABLED, reason=PERF_SKIP_REASON)
+def test_perf_apply_batch_predictor(tmp_path, perf_scene_img):
+    import numpy
+    import rsgislib
+    import rsgislib.classification
+    import rsgislib.imageutils
+
+    img_band_info = []
+    img_band_info.append(
+        rsgislib.imageutils.ImageBandInfo(perf_scene_img, "scene", [1, 2, 3])
+    )
+
+    # A cheap predictor so the timing is dominated by the reading, batching
+    # and writing of the data rather than the model.
+    def _predict(feats):
+        feats = numpy.asarray(feats)
+        out_vals = numpy.zeros((feats.shape[0], 1), dtype=numpy.float32)
+        out_vals[..., 0] = numpy.argmax(feats, axis=1) + 1
+        return out_vals
+
+    out_cls_img = os.path.join(tmp_path, "perf_cls_img.kea")
+    start_time = time.perf_counter()
+    rsgislib.classification.apply_batch_predictor(
+        img_band_info,
+        None,
+        1,
+        _predict,
+        [(out_cls_img, 1, rsgislib.TYPE_8UINT)],
+        "KEA",
+    )
+    elapsed = time.perf_counter() - start_time
+
+    assert os.path.exists(out_cls_img)
+    _check_perf("apply_batch_predictor", elapsed, PERF_N_PXLS, "pxls")
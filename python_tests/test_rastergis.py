@@ -167,6 +167,85 @@ def test_populate_rat_with_stats(tmp_path):
     assert vars_eq_vals
 
 
+def test_populate_rat_with_stats_single_pass(tmp_path):
+    import rsgislib.rastergis
+    import numpy
+
+    base_clumps_img = os.path.join(DATA_DIR, "sen2_20210527_aber_clumps.kea")
+    clumps_img = os.path.join(tmp_path, "sen2_20210527_aber_clumps.kea")
+    copy2(base_clumps_img, clumps_img)
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+
+    band_stats = list()
+    band_stats.append(
+        rsgislib.rastergis.BandAttStats(
+            band=1, min_field="b1Min", mean_field="b1Mean", count_field="b1Count"
+        )
+    )
+    band_stats.append(rsgislib.rastergis.BandAttStats(band=2, max_field="b2Max"))
+    band_stats.append(
+        rsgislib.rastergis.BandAttStats(
+            band=3,
+            sum_field="b3Sum",
+            mode_field="b3Mode",
+            percentiles=[rsgislib.rastergis.BandAttPercentiles(50, "b3Median")],
+        )
+    )
+
+    rsgislib.rastergis.populate_rat_with_stats_single_pass(
+        input_img, clumps_img, band_stats
+    )
+
+    ref_clumps_img = os.path.join(
+        RASTERGIS_DATA_DIR, "sen2_20210527_aber_clumps_attref.kea"
+    )
+
+    for var in ["b1Min", "b2Max", "b3Sum"]:
+        ref_vals = rsgislib.rastergis.get_column_data(ref_clumps_img, var)
+        calcd_vals = rsgislib.rastergis.get_column_data(clumps_img, var)
+        assert calcd_vals.shape[0] == ref_vals.shape[0]
+        assert numpy.allclose(calcd_vals, ref_vals)
+
+    b1_count = rsgislib.rastergis.get_column_data(clumps_img, "b1Count")
+    b3_median = rsgislib.rastergis.get_column_data(clumps_img, "b3Median")
+    assert numpy.sum(b1_count > 0) > 0
+    assert numpy.all(numpy.isfinite(b3_median))
+
+
+def test_populate_rat_with_stats_single_pass_threads(tmp_path):
+    import rsgislib.rastergis
+    import numpy
+
+    base_clumps_img = os.path.join(DATA_DIR, "sen2_20210527_aber_clumps.kea")
+    clumps_img = os.path.join(tmp_path, "sen2_20210527_aber_clumps.kea")
+    copy2(base_clumps_img, clumps_img)
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+
+    band_stats = [
+        rsgislib.rastergis.BandAttStats(
+            band=1, min_field="b1Min1", max_field="b1Max1", std_dev_field="b1StdDev1"
+        )
+    ]
+    rsgislib.rastergis.populate_rat_with_stats_single_pass(
+        input_img, clumps_img, band_stats, n_threads=1
+    )
+    band_stats = [
+        rsgislib.rastergis.BandAttStats(
+            band=1, min_field="b1Min4", max_field="b1Max4", std_dev_field="b1StdDev4"
+        )
+    ]
+    rsgislib.rastergis.populate_rat_with_stats_single_pass(
+        input_img, clumps_img, band_stats, n_threads=4
+    )
+
+    for var in ["b1Min", "b1Max", "b1StdDev"]:
+        vals_1 = rsgislib.rastergis.get_column_data(clumps_img, "{}1".format(var))
+        vals_4 = rsgislib.rastergis.get_column_data(clumps_img, "{}4".format(var))
+        assert numpy.allclose(vals_1, vals_4)
+
+
 def test_pop_rat_img_stats(tmp_path):
     import rsgislib.rastergis
 
@@ -181,6 +260,20 @@ def test_pop_rat_img_stats(tmp_path):
     )
 
 
+def test_pop_rat_img_stats_threads(tmp_path):
+    import rsgislib.rastergis
+
+    input_ref_img = os.path.join(
+        RASTERGIS_DATA_DIR, "sen2_20210527_aber_clumps_nostats.kea"
+    )
+    clumps_img = os.path.join(tmp_path, "sen2_20210527_aber_clumps_nostats.kea")
+    copy2(input_ref_img, clumps_img)
+
+    rsgislib.rastergis.pop_rat_img_stats(
+        clumps_img, add_clr_tab=True, calc_pyramids=True, ignore_zero=True, n_threads=2
+    )
+
+
 def test_collapse_rat(tmp_path):
     import rsgislib.rastergis
 
@@ -533,6 +626,76 @@ def test_set_column_data(tmp_path):
     assert numpy.array_equal(read_col_vals, uid_col)
 
 
+def test_read_write_rat_col_chunk(tmp_path):
+    import rsgislib.rastergis
+    import numpy
+
+    input_ref_img = os.path.join(DATA_DIR, "sen2_20210527_aber_clumps.kea")
+    clumps_img = os.path.join(tmp_path, "sen2_20210527_aber_clumps.kea")
+    copy2(input_ref_img, clumps_img)
+
+    n_rows = rsgislib.rastergis.get_rat_length(clumps_img)
+    chunk_size = 1000
+    for start_row in range(0, n_rows, chunk_size):
+        n_chunk_rows = min(chunk_size, n_rows - start_row)
+        uid_chunk = numpy.arange(start_row, start_row + n_chunk_rows, dtype=numpy.int32)
+        rsgislib.rastergis.write_rat_col_chunk(
+            clumps_img, "test_col", uid_chunk, start_row=start_row
+        )
+
+    read_col_vals = numpy.zeros(n_rows, dtype=numpy.float64)
+    rsgislib.rastergis.read_rat_col_chunk(clumps_img, "test_col", read_col_vals)
+    assert numpy.array_equal(read_col_vals, numpy.arange(0, n_rows))
+
+    read_chunk = numpy.zeros(10, dtype=numpy.int32)
+    rsgislib.rastergis.read_rat_col_chunk(
+        clumps_img, "test_col", read_chunk, start_row=n_rows - 10
+    )
+    assert numpy.array_equal(read_chunk, numpy.arange(n_rows - 10, n_rows))
+
+    with pytest.raises(Exception):
+        rsgislib.rastergis.read_rat_col_chunk(
+            clumps_img, "test_col", read_chunk, start_row=n_rows - 5
+        )
+
+
+def test_get_column_summary(tmp_path):
+    import rsgislib.rastergis
+    import numpy
+
+    input_ref_img = os.path.join(
+        RASTERGIS_DATA_DIR, "sen2_20210527_aber_clumps_attref.kea"
+    )
+    clumps_img = os.path.join(tmp_path, "sen2_20210527_aber_clumps_attref.kea")
+    copy2(input_ref_img, clumps_img)
+
+    hist_col_vals = rsgislib.rastergis.get_column_data(clumps_img, "Histogram")[1:]
+    for i in range(2):
+        # The second call uses the stored summary.
+        min_val, max_val, mean_val, n_vals, hist = (
+            rsgislib.rastergis.get_column_summary(clumps_img, "Histogram")
+        )
+        assert n_vals == hist_col_vals.shape[0]
+        assert min_val == numpy.min(hist_col_vals)
+        assert max_val == numpy.max(hist_col_vals)
+        assert abs(mean_val - numpy.mean(hist_col_vals)) < 1e-6
+        assert sum(hist) == n_vals
+
+    # The stored summary is recalculated when the column is changed.
+    n_rows = rsgislib.rastergis.get_rat_length(clumps_img)
+    test_vals = numpy.arange(0, n_rows, 1, dtype=numpy.float64)
+    rsgislib.rastergis.set_column_data(clumps_img, "test_col", test_vals)
+    min_val, max_val, mean_val, n_vals, hist = rsgislib.rastergis.get_column_summary(
+        clumps_img, "test_col"
+    )
+    assert (min_val == 1) and (max_val == (n_rows - 1))
+    rsgislib.rastergis.set_column_data(clumps_img, "test_col", test_vals * 2)
+    min_val, max_val, mean_val, n_vals, hist = rsgislib.rastergis.get_column_summary(
+        clumps_img, "test_col"
+    )
+    assert (min_val == 2) and (max_val == ((n_rows - 1) * 2))
+
+
 def test_create_uid_col(tmp_path):
     import rsgislib.rastergis
 
@@ -561,6 +724,50 @@ def test_get_global_class_stats(tmp_path):
     )
 
 
+def test_calc_dist_to_nearest_clumps(tmp_path):
+    import rsgislib.rastergis
+    import numpy
+
+    input_ref_img = os.path.join(DATA_DIR, "sen2_20210527_aber_clumps.kea")
+    clumps_img = os.path.join(tmp_path, "sen2_20210527_aber_clumps.kea")
+    copy2(input_ref_img, clumps_img)
+
+    rsgislib.rastergis.calc_dist_to_nearest_clumps(
+        clumps_img, "dist", out_clump_col="near_clump"
+    )
+    dist_vals = rsgislib.rastergis.get_column_data(clumps_img, "dist")[1:]
+    near_vals = rsgislib.rastergis.get_column_data(clumps_img, "near_clump")[1:]
+    found = near_vals > 0
+    assert numpy.all(dist_vals[found] >= 0)
+    assert numpy.all(dist_vals[~found] == -1)
+    assert numpy.all(near_vals[found] != numpy.arange(1, near_vals.shape[0] + 1)[found])
+
+
+def test_calc_dist_between_clumps(tmp_path):
+    import rsgislib.rastergis
+
+    input_ref_img = os.path.join(DATA_DIR, "sen2_20210527_aber_clumps.kea")
+    clumps_img = os.path.join(tmp_path, "sen2_20210527_aber_clumps.kea")
+    copy2(input_ref_img, clumps_img)
+
+    rsgislib.rastergis.calc_dist_between_clumps(clumps_img, "dist")
+
+
+def test_rechunk_kea_rat(tmp_path):
+    import rsgislib.rastergis
+
+    ref_clumps_img = os.path.join(
+        RASTERGIS_DATA_DIR, "sen2_20210527_aber_clumps_attref.kea"
+    )
+    out_img = os.path.join(tmp_path, "sen2_20210527_aber_clumps_rechunk.kea")
+
+    rsgislib.rastergis.rechunk_kea_rat(ref_clumps_img, out_img)
+    assert os.path.exists(out_img)
+    assert rsgislib.rastergis.get_rat_length(out_img) == 11949
+    ref_columns = rsgislib.rastergis.get_rat_columns(ref_clumps_img)
+    assert rsgislib.rastergis.get_rat_columns(out_img) == ref_columns
+
+
 # TODO rsgislib.rastergis.str_class_majority
 # TODO rsgislib.rastergis.histo_sampling
 # TODO rsgislib.rastergis.class_split_fit_hist_gausian_mixture_model
@@ -577,7 +784,6 @@ def test_get_global_class_stats(tmp_path):
 # TODO rsgislib.rastergis.define_class_names
 # TODO rsgislib.rastergis.take_random_sample
 # TODO rsgislib.rastergis.set_class_names_colours
-# TODO rsgislib.rastergis.calc_dist_between_clumps
 # TODO rsgislib.rastergis.calc_dist_to_large_clumps
 # TODO rsgislib.rastergis.calc_dist_to_classes
 # TODO rsgislib.rastergis.identify_small_units
@@ -21,11 +21,106 @@ def test_clump(tmp_path):
     assert os.path.exists(clumps_img)
 
 
+def test_clump_threads(tmp_path):
+    import rsgislib.imagecalc
+    import rsgislib.segmentation
+
+    input_img = os.path.join(IMGCALC_DATA_DIR, "sen2_20210527_aber_ndvi_cats.kea")
+    clumps_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.segmentation.clump(
+        input_img,
+        clumps_img,
+        gdalformat="KEA",
+        in_memory=False,
+        no_data_val=0,
+        add_to_rat=False,
+    )
+    clumps_thrd_img = os.path.join(tmp_path, "out_thrd_img.kea")
+    rsgislib.segmentation.clump(
+        input_img,
+        clumps_thrd_img,
+        gdalformat="KEA",
+        in_memory=False,
+        no_data_val=0,
+        add_to_rat=False,
+        n_threads=4,
+    )
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(clumps_img, clumps_thrd_img)
+    assert img_eq
+
+
 # TODO rsgislib.segmentation.label_pixels_from_cluster_centres
 # TODO rsgislib.segmentation.relabel_clumps
-# TODO rsgislib.segmentation.eliminate_single_pixels
+
+
+def test_eliminate_single_pixels(tmp_path):
+    import rsgislib.imagecalc
+    import rsgislib.imageutils
+    import rsgislib.segmentation
+
+    input_img = os.path.join(IMGCALC_DATA_DIR, "sen2_20210527_aber_ndvi.kea")
+    cats_img = os.path.join(IMGCALC_DATA_DIR, "sen2_20210527_aber_ndvi_cats.kea")
+
+    # The output is the same for any number of threads.
+    out_imgs = []
+    init_context = rsgislib.imageutils.get_calc_img_exec_context()
+    try:
+        for n_threads in [1, 4]:
+            rsgislib.imageutils.set_calc_img_exec_context(n_threads=n_threads)
+            out_img = os.path.join(tmp_path, "no_sgls_{}_img.kea".format(n_threads))
+            rsgislib.segmentation.eliminate_single_pixels(
+                input_img,
+                cats_img,
+                out_img,
+                os.path.join(tmp_path, "tmp_img.kea"),
+                "KEA",
+                False,
+                True,
+            )
+            out_imgs.append(out_img)
+    finally:
+        rsgislib.imageutils.set_calc_img_exec_context(**init_context)
+
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(out_imgs[0], out_imgs[1])
+    assert img_eq
+
+
 # TODO rsgislib.segmentation.rm_small_clumps
-# TODO rsgislib.segmentation.rm_small_clumps_stepwise
+
+
+def test_rm_small_clumps_stepwise_clumps_mem(tmp_path):
+    import rsgislib.imagecalc
+    import rsgislib.imageutils
+    import rsgislib.segmentation
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    clumps_img = os.path.join(DATA_DIR, "sen2_20210527_aber_clumps.kea")
+
+    # The clumps are held in a memory-mapped file when over clumps_mem_mb.
+    out_imgs = []
+    init_context = rsgislib.imageutils.get_calc_img_exec_context()
+    try:
+        for clumps_mem_mb in [0, 1]:
+            rsgislib.imageutils.set_calc_img_exec_context(clumps_mem_mb=clumps_mem_mb)
+            out_img = os.path.join(tmp_path, "elim_{}_img.kea".format(clumps_mem_mb))
+            rsgislib.segmentation.rm_small_clumps_stepwise(
+                input_img,
+                clumps_img,
+                out_img,
+                "KEA",
+                False,
+                "",
+                False,
+                False,
+                20,
+                1000,
+            )
+            out_imgs.append(out_img)
+    finally:
+        rsgislib.imageutils.set_calc_img_exec_context(**init_context)
+
+    img_eq, prop_match = rsgislib.imagecalc.are_imgs_equal(out_imgs[0], out_imgs[1])
+    assert img_eq
 
 
 def test_union_of_clumps(tmp_path):
@@ -43,7 +138,80 @@ def test_union_of_clumps(tmp_path):
     assert os.path.exists(clumps_img)
 
 
-# TODO rsgislib.segmentation.mean_image
+def test_union_of_clumps_tuple_ids(tmp_path):
+    import rsgislib.segmentation
+
+    input_img = os.path.join(IMGCALC_DATA_DIR, "sen2_20210527_aber_ndvi_cats.kea")
+    clumps_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.segmentation.union_of_clumps(
+        [input_img, input_img],
+        clumps_img,
+        gdalformat="KEA",
+        no_data_val=0,
+        add_to_rat=True,
+        tuple_ids=True,
+        n_threads=2,
+    )
+    assert os.path.exists(clumps_img)
+
+
+def test_mean_image(tmp_path):
+    import rsgislib
+    import rsgislib.segmentation
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    clumps_img = os.path.join(DATA_DIR, "sen2_20210527_aber_clumps.kea")
+    output_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.segmentation.mean_image(
+        input_img, clumps_img, output_img, "KEA", rsgislib.TYPE_32FLOAT
+    )
+    assert os.path.exists(output_img)
+
+
+def test_mean_image_rat_cols(tmp_path):
+    from shutil import copy2
+
+    import numpy
+    from osgeo import gdal
+
+    import rsgislib
+    import rsgislib.rastergis
+    import rsgislib.segmentation
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    clumps_img = os.path.join(tmp_path, "sen2_20210527_aber_clumps.kea")
+    copy2(os.path.join(DATA_DIR, "sen2_20210527_aber_clumps.kea"), clumps_img)
+    band_stats = [
+        rsgislib.rastergis.BandAttStats(band=1, mean_field="b1Mean"),
+        rsgislib.rastergis.BandAttStats(band=2, mean_field="b2Mean"),
+    ]
+    rsgislib.rastergis.populate_rat_with_stats(input_img, clumps_img, band_stats)
+
+    calc_img = os.path.join(tmp_path, "out_calc_img.kea")
+    rsgislib.segmentation.mean_image(
+        input_img, clumps_img, calc_img, "KEA", rsgislib.TYPE_32FLOAT
+    )
+    rat_img = os.path.join(tmp_path, "out_rat_img.kea")
+    rsgislib.segmentation.mean_image(
+        None,
+        clumps_img,
+        rat_img,
+        "KEA",
+        rsgislib.TYPE_32FLOAT,
+        mean_cols=["b1Mean", "b2Mean"],
+    )
+
+    calc_ds = gdal.Open(calc_img)
+    rat_ds = gdal.Open(rat_img)
+    assert rat_ds.RasterCount == 2
+    for band in range(1, 3):
+        calc_arr = calc_ds.GetRasterBand(band).ReadAsArray()
+        rat_arr = rat_ds.GetRasterBand(band).ReadAsArray()
+        assert numpy.allclose(calc_arr, rat_arr, rtol=1e-5)
+    calc_ds = None
+    rat_ds = None
+
+
 # TODO rsgislib.segmentation.merge_segmentation_tiles
 
 
@@ -58,6 +226,81 @@ def test_generate_regular_grid(tmp_path):
     assert os.path.exists(clumps_img)
 
 
+def test_seg_tile_plan(tmp_path):
+    import rsgislib.segmentation
+
+    clusters_img = os.path.join(IMGCALC_DATA_DIR, "sen2_20210527_aber_ndvi_cats.kea")
+    spectral_img = os.path.join(IMGCALC_DATA_DIR, "sen2_20210527_aber_ndvi.kea")
+    manifest_file = os.path.join(tmp_path, "seg_tile_plan.txt")
+    n_jobs = rsgislib.segmentation.create_seg_tile_plan(
+        clusters_img,
+        spectral_img,
+        manifest_file,
+        os.path.join(tmp_path, "seg_tile"),
+        "KEA",
+        "kea",
+        250,
+        250,
+        25,
+    )
+    assert n_jobs > 1
+    for job_id in range(n_jobs):
+        rsgislib.segmentation.run_seg_tile_job(manifest_file, job_id, 10, 100000)
+    clumps_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.segmentation.merge_seg_tile_plan(manifest_file, clumps_img, 10, 100000)
+    assert os.path.exists(clumps_img)
+
+
+
+def test_seg_tile_plan_threaded(tmp_path):
+    import rsgislib.segmentation
+
+    clusters_img = os.path.join(IMGCALC_DATA_DIR, "sen2_20210527_aber_ndvi_cats.kea")
+    spectral_img = os.path.join(IMGCALC_DATA_DIR, "sen2_20210527_aber_ndvi.kea")
+    manifest_file = os.path.join(tmp_path, "seg_tile_plan.txt")
+    n_jobs = rsgislib.segmentation.create_seg_tile_plan(
+        clusters_img,
+        spectral_img,
+        manifest_file,
+        os.path.join(tmp_path, "seg_tile"),
+        "KEA",
+        "kea",
+        250,
+        250,
+        25,
+    )
+    assert n_jobs > 1
+    rsgislib.segmentation.run_seg_tile_jobs(manifest_file, 10, 100000, n_threads=2)
+    clumps_img = os.path.join(tmp_path, "out_img.kea")
+    rsgislib.segmentation.merge_seg_tile_plan(manifest_file, clumps_img, 10, 100000)
+    assert os.path.exists(clumps_img)
+
+
+def test_polygonise_clumps(tmp_path):
+    import rsgislib.segmentation
+    import rsgislib.vectorutils
+    import rsgislib.vectorutils.createvectors
+
+    clumps_img = os.path.join(DATA_DIR, "sen2_20210527_aber_clumps.kea")
+    out_vec_file = os.path.join(tmp_path, "out_vec.gpkg")
+    rsgislib.segmentation.polygonise_clumps(clumps_img, out_vec_file, "out_vec")
+    assert os.path.exists(out_vec_file)
+
+    gdal_vec_file = os.path.join(tmp_path, "gdal_vec.gpkg")
+    rsgislib.vectorutils.createvectors.polygonise_raster_to_vec_lyr(
+        gdal_vec_file,
+        "gdal_vec",
+        out_format="GPKG",
+        input_img=clumps_img,
+        img_band=1,
+        mask_img=clumps_img,
+        mask_band=1,
+    )
+    assert rsgislib.vectorutils.get_vec_feat_count(
+        out_vec_file, "out_vec"
+    ) == rsgislib.vectorutils.get_vec_feat_count(gdal_vec_file, "gdal_vec")
+
+
 # TODO rsgislib.segmentation.drop_selected_clumps
 # TODO rsgislib.segmentation.find_tile_borders_mask
 # TODO rsgislib.segmentation.include_regions_in_clumps
@@ -35,6 +35,27 @@ def test_run_shepherd_segmentation_sub_bands(tmp_path):
     assert os.path.exists(out_clumps_img) and os.path.exists(out_mean_img)
 
 
+def test_run_shepherd_segmentation_in_mem_sub_bands(tmp_path):
+    import rsgislib.segmentation.shepherdseg
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    tmp_dir = os.path.join(tmp_path, "seg_tmp")
+    out_clumps_img = os.path.join(tmp_path, "sen2_20210527_aber_clumps.kea")
+    out_mean_img = os.path.join(tmp_path, "sen2_20210527_aber_mean_img.kea")
+
+    rsgislib.segmentation.shepherdseg.run_shepherd_segmentation(
+        input_img,
+        out_clumps_img,
+        out_mean_img,
+        tmp_dir,
+        bands=[8, 9, 7],
+        process_in_mem=True,
+    )
+
+    assert os.path.exists(out_clumps_img) and os.path.exists(out_mean_img)
+    assert not os.path.exists(tmp_dir)
+
+
 @pytest.mark.skipif(
     True,
     reason="Sometimes stretch_img_with_stats freezes on MacOS and haven't figured out why yet...",
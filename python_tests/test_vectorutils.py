@@ -802,6 +802,45 @@ def test_vector_maths(tmp_path):
     assert os.path.exists(out_vec_file) and (total < 0.01)
 
 
+def test_vector_maths_threads(tmp_path):
+    import rsgislib.vectorutils
+    import rsgislib.vectorattrs
+    import numpy
+
+    vec_file = os.path.join(DATA_DIR, "aber_osgb_multi_polys.geojson")
+    vec_lyr = "aber_osgb_multi_polys"
+
+    out_vec_file = os.path.join(tmp_path, "out_vec.gpkg")
+    out_vec_lyr = "out_vec"
+
+    vars = list()
+    vars.append(rsgislib.vectorutils.VecColVar(name="val", field_name="val"))
+    rsgislib.vectorutils.vector_maths(
+        vec_file,
+        vec_lyr,
+        out_vec_file,
+        out_vec_lyr,
+        "GPKG",
+        "out_vals",
+        "val * val",
+        vars,
+        True,
+        n_threads=4,
+    )
+
+    # Check values are correct and in the same order as the input.
+    in_vals_lst = rsgislib.vectorattrs.read_vec_column(vec_file, vec_lyr, "val")
+    in_vals = numpy.array(in_vals_lst)
+    calcd_out_vals = in_vals * in_vals
+    out_vals_lst = rsgislib.vectorattrs.read_vec_column(
+        out_vec_file, out_vec_lyr, "out_vals"
+    )
+    out_vals = numpy.array(out_vals_lst)
+    diff = numpy.abs(calcd_out_vals - out_vals)
+    total = numpy.sum(diff)
+    assert os.path.exists(out_vec_file) and (total < 0.01)
+
+
 def test_create_lines_of_points(tmp_path):
     import rsgislib.vectorutils
 
@@ -844,6 +883,28 @@ def test_check_validate_geometries(tmp_path):
     assert os.path.exists(out_vec_file)
 
 
+def test_check_validate_geometries_threads(tmp_path):
+    import rsgislib.vectorutils
+
+    vec_file = os.path.join(DATA_DIR, "aber_osgb_multi_polys.geojson")
+    vec_lyr = "aber_osgb_multi_polys"
+
+    out_vec_file = os.path.join(tmp_path, "out_vec.gpkg")
+    out_vec_lyr = "out_vec"
+
+    rsgislib.vectorutils.check_validate_geometries(
+        vec_file,
+        vec_lyr,
+        out_vec_file,
+        out_vec_lyr,
+        "GPKG",
+        print_err_geoms=False,
+        del_exist_vec=True,
+        n_threads=2,
+    )
+    assert os.path.exists(out_vec_file)
+
+
 def test_does_vmsk_img_intersect(tmp_path):
     import rsgislib.vectorutils
 
@@ -1194,6 +1194,29 @@ def test_split_sample_hdf5_file(tmp_path):
     assert os.path.exists(out_h5_p1_file) and os.path.exists(out_h5_p2_file)
 
 
+@pytest.mark.skipif(H5PY_NOT_AVAIL, reason="h5py dependency not available")
+def test_split_sample_hdf5_file_n_rows(tmp_path):
+    import h5py
+    import rsgislib.zonalstats
+
+    in_h5_file = os.path.join(ZONALSTATS_DATA_DIR, "sen2_20210527_aber_b1-6_vals.h5")
+    out_h5_p1_file = os.path.join(tmp_path, "out_h5_p1_file.h5")
+    out_h5_p2_file = os.path.join(tmp_path, "out_h5_p2_file.h5")
+
+    rsgislib.zonalstats.split_sample_hdf5_file(
+        in_h5_file, out_h5_p1_file, out_h5_p2_file, 250, 42, rsgislib.TYPE_16INT
+    )
+
+    with h5py.File(in_h5_file, "r") as in_h5:
+        n_in_rows = in_h5["DATA/DATA"].shape[0]
+    with h5py.File(out_h5_p1_file, "r") as p1_h5:
+        n_p1_rows = p1_h5["DATA/DATA"].shape[0]
+    with h5py.File(out_h5_p2_file, "r") as p2_h5:
+        n_p2_rows = p2_h5["DATA/DATA"].shape[0]
+
+    assert (n_p1_rows == 250) and ((n_p1_rows + n_p2_rows) == n_in_rows)
+
+
 @pytest.mark.skipif(H5PY_NOT_AVAIL, reason="h5py dependency not available")
 def test_merge_extracted_hdf5_data(tmp_path):
     import rsgislib.zonalstats
@@ -1250,10 +1273,6 @@ def test_msk_h5_smpls_to_finite_values(tmp_path):
     assert os.path.exists(out_h5_file)
 
 
-# @pytest.mark.skipif(H5PY_NOT_AVAIL, reason="h5py dependency not available")
-@pytest.mark.skip(
-    reason="TODO: Function need updating to not use rios.imagereader.ImageReader"
-)
 def test_extract_chip_zone_image_band_values_to_hdf_no_rot(tmp_path):
     import rsgislib.zonalstats
     import rsgislib.imageutils
@@ -1282,6 +1301,47 @@ def test_extract_chip_zone_image_band_values_to_hdf_no_rot(tmp_path):
     assert os.path.exists(out_h5_file)
 
 
+@pytest.mark.skipif(H5PY_NOT_AVAIL, reason="h5py dependency not available")
+def test_extract_chip_zone_img_band_values_to_hdf_n_threads(tmp_path):
+    import h5py
+    import numpy
+    import rsgislib.zonalstats
+    import rsgislib.imageutils
+
+    input_img = os.path.join(DATA_DIR, "sen2_20210527_aber.kea")
+    in_msk_img = os.path.join(ZONALSTATS_DATA_DIR, "sen2_20210527_aber_pts.kea")
+
+    in_img_info = []
+    in_img_info.append(
+        rsgislib.imageutils.ImageBandInfo(input_img, "Image1", [1, 3, 4])
+    )
+    in_img_info.append(rsgislib.imageutils.ImageBandInfo(input_img, "Image2", [2]))
+
+    out_h5_file = os.path.join(tmp_path, "out_h5_file.h5")
+    rsgislib.zonalstats.extract_chip_zone_img_band_values_to_hdf(
+        in_img_info, in_msk_img, 1, 7, out_h5_file, rsgislib.TYPE_16INT
+    )
+    out_thrd_h5_file = os.path.join(tmp_path, "out_thrd_h5_file.h5")
+    rsgislib.zonalstats.extract_chip_zone_img_band_values_to_hdf(
+        in_img_info,
+        in_msk_img,
+        1,
+        7,
+        out_thrd_h5_file,
+        rsgislib.TYPE_16INT,
+        n_threads=4,
+    )
+
+    with h5py.File(out_h5_file, "r") as f, h5py.File(
+        out_thrd_h5_file, "r"
+    ) as f_thrd:
+        chips = f["DATA/DATA"][...]
+        assert chips.shape[1:] == (7, 7, 4)
+        assert chips.shape[0] > 0
+        assert f["DATA/DATA"].chunks == (1, 7, 7, 4)
+        assert numpy.array_equal(chips, f_thrd["DATA/DATA"][...])
+
+
 # @pytest.mark.skipif(H5PY_NOT_AVAIL, reason="h5py dependency not available")
 @pytest.mark.skip(
     reason="TODO: Function need updating to not use rios.imagereader.ImageReader"
@@ -1314,10 +1374,6 @@ def test_extract_chip_zone_image_band_values_to_hdf_with_rot(tmp_path):
     assert os.path.exists(out_h5_file)
 
 
-# @pytest.mark.skipif(H5PY_NOT_AVAIL, reason="h5py dependency not available")
-@pytest.mark.skip(
-    reason="TODO: Function need updating to not use rios.imagereader.ImageReader"
-)
 def test_extract_ref_chip_zone_image_band_values_to_hdf_no_rot(tmp_path):
     import rsgislib.zonalstats
     import rsgislib.imageutils
@@ -25,6 +25,138 @@
 
 namespace rsgis{namespace calib{
     
+    RSGIS6SLUTBinIndex::RSGIS6SLUTBinIndex()
+    {
+        this->useGrid = false;
+        this->gridMin = 0;
+        this->cellWidth = 0;
+        this->numCells = 0;
+    }
+    
+    RSGIS6SLUTBinIndex::RSGIS6SLUTBinIndex(std::vector<float> binVals)
+    {
+        this->binVals = binVals;
+        this->useGrid = false;
+        this->gridMin = 0;
+        this->cellWidth = 0;
+        this->numCells = 0;
+        for(unsigned int i = 0; i < binVals.size(); ++i)
+        {
+            this->allBins.push_back(i);
+        }
+        
+        std::vector<float> sortedVals = binVals;
+        std::sort(sortedVals.begin(), sortedVals.end());
+        if((sortedVals.size() < 2) || (!std::isfinite(sortedVals.front())) || (!std::isfinite(sortedVals.back())) || (sortedVals.front() == sortedVals.back()))
+        {
+            return;
+        }
+        double minVal = sortedVals.front();
+        double maxVal = sortedVals.back();
+        double range = maxVal - minVal;
+        double minGap = range;
+        for(size_t i = 1; i < sortedVals.size(); ++i)
+        {
+            double gap = ((double)sortedVals[i]) - ((double)sortedVals[i-1]);
+            if((gap > 0) && (gap < minGap))
+            {
+                minGap = gap;
+            }
+        }
+        
+        // The grid covers the range of the bins and the range again either side.
+        const size_t maxCells = 65536;
+        this->gridMin = minVal - range;
+        double gridRange = 3 * range;
+        this->cellWidth = minGap / 2;
+        if((gridRange / this->cellWidth) > maxCells)
+        {
+            this->cellWidth = gridRange / maxCells;
+        }
+        this->numCells = (size_t)std::ceil(gridRange / this->cellWidth);
+        
+        // A bin can be the nearest within the cell if its smallest (squared) distance to the cell is no more than
+        // the largest distance of every other bin, allowing for the rounding of the float distances.
+        const double distTol = 1e-5;
+        std::vector<double> lowerDist(binVals.size());
+        this->cellStart.push_back(0);
+        for(size_t c = 0; c < this->numCells; ++c)
+        {
+            double cellMin = this->gridMin + ((((double)c) - 1e-3) * this->cellWidth);
+            double cellMax = this->gridMin + ((((double)c) + 1 + 1e-3) * this->cellWidth);
+            double minUpperDist = 0;
+            for(unsigned int i = 0; i < binVals.size(); ++i)
+            {
+                double distMin = ((double)binVals[i]) - cellMin;
+                double distMax = ((double)binVals[i]) - cellMax;
+                double upperDist = std::max(distMin*distMin, distMax*distMax);
+                if((binVals[i] >= cellMin) && (binVals[i] <= cellMax))
+                {
+                    lowerDist[i] = 0;
+                }
+                else
+                {
+                    lowerDist[i] = std::min(distMin*distMin, distMax*distMax);
+                }
+                if((i == 0) || (upperDist < minUpperDist))
+                {
+                    minUpperDist = upperDist;
+                }
+            }
+            for(unsigned int i = 0; i < binVals.size(); ++i)
+            {
+                if(lowerDist[i] <= (minUpperDist * (1 + distTol)))
+                {
+                    this->cellBins.push_back(i);
+                }
+            }
+            this->cellStart.push_back(this->cellBins.size());
+        }
+        this->useGrid = true;
+    }
+    
+    unsigned int RSGIS6SLUTBinIndex::getNearestBin(float val) const
+    {
+        if(this->useGrid)
+        {
+            double cellPos = (((double)val) - this->gridMin) / this->cellWidth;
+            if((cellPos >= 0) && (cellPos < this->numCells))
+            {
+                size_t cell = (size_t)cellPos;
+                return this->findNearestBin(val, &this->cellBins[this->cellStart[cell]], this->cellStart[cell+1] - this->cellStart[cell]);
+            }
+        }
+        return this->findNearestBin(val, this->allBins.data(), this->allBins.size());
+    }
+    
+    unsigned int RSGIS6SLUTBinIndex::findNearestBin(float val, const unsigned int *bins, size_t numBins) const
+    {
+        // The same comparisons as a search of all the bins.
+        float dist = 0.0;
+        float minDist = 0.0;
+        unsigned int binIdx = 0;
+        for(size_t i = 0; i < numBins; ++i)
+        {
+            dist = (this->binVals[bins[i]] - val) * (this->binVals[bins[i]] - val);
+            if(i == 0)
+            {
+                minDist = dist;
+                binIdx = bins[i];
+            }
+            else if(dist < minDist)
+            {
+                minDist = dist;
+                binIdx = bins[i];
+            }
+        }
+        return binIdx;
+    }
+    
+    RSGIS6SLUTBinIndex::~RSGIS6SLUTBinIndex()
+    {
+        
+    }
+    
     RSGISApply6SCoefficientsSingleParam::RSGISApply6SCoefficientsSingleParam(unsigned int *imageBands, float *aX, float *bX, float *cX, int numValues, float noDataVal, bool useNoDataVal, float scaleFactor):rsgis::img::RSGISCalcImageValue(numValues)
     {
 		this->imageBands = imageBands;
@@ -124,6 +256,7 @@ namespace rsgis{namespace calib{
         this->useNoDataVal = useNoDataVal;
         
         double minElev = 0;
+        std::vector<float> elevVals;
         for(unsigned int i = 0; i < lut->size(); ++i)
         {
             if(i == 0)
@@ -136,17 +269,48 @@ namespace rsgis{namespace calib{
                 minElev = lut->at(i).elev;
                 minElevCoeffs = lut->at(i);
             }
+            elevVals.push_back(lut->at(i).elev);
         }
+        this->elevIndex = RSGIS6SLUTBinIndex(elevVals);
     }
     
     void RSGISApply6SCoefficientsElevLUTParam::calcImageValue(float *bandValues, int numBands, double *output) 
+    {
+        this->pxlBands.resize(numBands);
+        for(int i = 0; i < numBands; ++i)
+        {
+            this->pxlBands[i] = &bandValues[i];
+        }
+        this->pxlOutput.resize(this->numOutBands);
+        for(int i = 0; i < this->numOutBands; ++i)
+        {
+            this->pxlOutput[i] = &output[i];
+        }
+        this->calcPxlValue(this->pxlBands.data(), 0, numBands, this->pxlOutput.data());
+    }
+    
+    bool RSGISApply6SCoefficientsElevLUTParam::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            this->calcPxlValue(bands, p, numBands, output);
+        }
+        return true;
+    }
+    
+    rsgis::img::RSGISCalcImageValue* RSGISApply6SCoefficientsElevLUTParam::clone()
+    {
+        return new RSGISApply6SCoefficientsElevLUTParam(this->numOutBands, this->lut, this->demNoDataVal, this->noDataVal, this->useNoDataVal, this->scaleFactor);
+    }
+    
+    void RSGISApply6SCoefficientsElevLUTParam::calcPxlValue(const float* const* bands, size_t pxl, int numBands, double **output)
     {
         if(numBands-1 != this->numOutBands)
         {
             throw rsgis::img::RSGISImageCalcException("The number of input image bands needs to be equal to the number of output image bands.");
         }
         
-        float elevVal = bandValues[0];
+        float elevVal = bands[0][pxl];
         if(elevVal == demNoDataVal)
         {
             elevVal = minElevCoeffs.elev;
@@ -157,7 +321,7 @@ namespace rsgis{namespace calib{
         {
             for(int i = 1; i < numBands; ++i)
             {
-                if(bandValues[i] != this->noDataVal)
+                if(bands[i][pxl] != this->noDataVal)
                 {
                     nodata = false;
                     break;
@@ -175,35 +339,16 @@ namespace rsgis{namespace calib{
         {
             for(unsigned int i = 0; i < this->numOutBands; ++i)
             {
-                output[i] = 0;
+                output[i][pxl] = 0;
             }
         }
         else
         {
-            LUT6SElevation lutVal;
-            float dist = 0.0;
-            float minDist = 0.0;
-            unsigned int lutIdx = 0;
+            unsigned int lutIdx = this->elevIndex.getNearestBin(elevVal);
+            const LUT6SElevation &lutVal = lut->at(lutIdx);
             
-            LUT6SElevation lutVal2;
             unsigned int lutIdx2 = 0;
-            
-            for(unsigned int i = 0; i < lut->size(); ++i)
-            {
-                dist = (lut->at(i).elev - elevVal) * (lut->at(i).elev - elevVal);
-                if(i == 0)
-                {
-                    minDist = dist;
-                    lutIdx = i;
-                }
-                else if(dist < minDist)
-                {
-                    minDist = dist;
-                    lutIdx = i;
-                }
-            }
-            lutVal = lut->at(lutIdx);
-            
+            const LUT6SElevation *lutVal2 = nullptr;
             
             float elevLUTDiff = 0.0;
             float elevLUTDiff1 = 0.0;
@@ -233,11 +378,11 @@ namespace rsgis{namespace calib{
                         lutIdx2 = lutIdx+1;
                     }
                 }
-                lutVal2 = lut->at(lutIdx2);
+                lutVal2 = &lut->at(lutIdx2);
                 
-                elevLUTDiff = fabs(lutVal.elev - lutVal2.elev);
+                elevLUTDiff = fabs(lutVal.elev - lutVal2->elev);
                 elevLUTDiff1 = fabs(elevVal - lutVal.elev);
-                elevLUTDiff2 = fabs(elevVal - lutVal2.elev);
+                elevLUTDiff2 = fabs(elevVal - lutVal2->elev);
                 
                 elevProp1 = 1-(elevLUTDiff1/elevLUTDiff);
                 elevProp2 = 1-(elevLUTDiff2/elevLUTDiff);
@@ -246,46 +391,48 @@ namespace rsgis{namespace calib{
             double tmpVal = 0;
             double reflVal1 = 0.0;
             double reflVal2 = 0.0;
+            double outVal = 0.0;
             
             for(unsigned int i = 0; i < lutVal.numValues; ++i)
             {
-                if(lutVal.imageBands[i] > numBands)
+                if(lutVal.imageBands[i] >= numBands)
                 {
                     std::cout << "Image band: " << lutVal.imageBands[i] << std::endl;
                     throw rsgis::img::RSGISImageCalcException("Image band is not within image.");
                 }
                 
-                if(lut->size() > 1)
+                if(lutVal2 != nullptr)
                 {
-                    tmpVal=lutVal.aX[i]*bandValues[lutVal.imageBands[i]]-lutVal.bX[i];
+                    tmpVal=lutVal.aX[i]*bands[lutVal.imageBands[i]][pxl]-lutVal.bX[i];
                     reflVal1 = (tmpVal/(1.0+lutVal.cX[i]*tmpVal))*this->scaleFactor;
                     
-                    tmpVal=lutVal2.aX[i]*bandValues[lutVal2.imageBands[i]]-lutVal2.bX[i];
-                    reflVal2 = (tmpVal/(1.0+lutVal2.cX[i]*tmpVal))*this->scaleFactor;
+                    tmpVal=lutVal2->aX[i]*bands[lutVal2->imageBands[i]][pxl]-lutVal2->bX[i];
+                    reflVal2 = (tmpVal/(1.0+lutVal2->cX[i]*tmpVal))*this->scaleFactor;
                     
-                    output[i] = (reflVal1*elevProp1) + (reflVal2*elevProp2);
+                    outVal = (reflVal1*elevProp1) + (reflVal2*elevProp2);
                 }
                 else
                 {
-                    tmpVal=lutVal.aX[i]*bandValues[lutVal.imageBands[i]]-lutVal.bX[i];
-                    output[i] = (tmpVal/(1.0+lutVal.cX[i]*tmpVal))*this->scaleFactor;
+                    tmpVal=lutVal.aX[i]*bands[lutVal.imageBands[i]][pxl]-lutVal.bX[i];
+                    outVal = (tmpVal/(1.0+lutVal.cX[i]*tmpVal))*this->scaleFactor;
                 }
                 
                 if(this->useNoDataVal & (this->noDataVal == 0.0))
                 {
-                    if(output[i] < 1)
+                    if(outVal < 1)
                     {
-                        output[i] = 1.0;
+                        outVal = 1.0;
                     }
                     else
                     {
-                        output[i] = output[i] + 1.0;
+                        outVal = outVal + 1.0;
                     }
                 }
-                if(output[i] > this->scaleFactor)
+                if(outVal > this->scaleFactor)
                 {
-                    output[i] = this->scaleFactor;
+                    outVal = this->scaleFactor;
                 }
+                output[i][pxl] = outVal;
             }
         }
         
@@ -305,9 +452,51 @@ namespace rsgis{namespace calib{
         this->scaleFactor = scaleFactor;
         this->noDataVal = noDataVal;
         this->useNoDataVal = useNoDataVal;
+        
+        std::vector<float> elevVals;
+        for(unsigned int i = 0; i < lut->size(); ++i)
+        {
+            elevVals.push_back(lut->at(i).elev);
+            std::vector<float> aotVals;
+            for(unsigned int j = 0; j < lut->at(i).aotLUT.size(); ++j)
+            {
+                aotVals.push_back(lut->at(i).aotLUT.at(j).aot);
+            }
+            this->aotIndexes.push_back(RSGIS6SLUTBinIndex(aotVals));
+        }
+        this->elevIndex = RSGIS6SLUTBinIndex(elevVals);
     }
     
     void RSGISApply6SCoefficientsElevAOTLUTParam::calcImageValue(float *bandValues, int numBands, double *output) 
+    {
+        this->pxlBands.resize(numBands);
+        for(int i = 0; i < numBands; ++i)
+        {
+            this->pxlBands[i] = &bandValues[i];
+        }
+        this->pxlOutput.resize(this->numOutBands);
+        for(int i = 0; i < this->numOutBands; ++i)
+        {
+            this->pxlOutput[i] = &output[i];
+        }
+        this->calcPxlValue(this->pxlBands.data(), 0, numBands, this->pxlOutput.data());
+    }
+    
+    bool RSGISApply6SCoefficientsElevAOTLUTParam::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            this->calcPxlValue(bands, p, numBands, output);
+        }
+        return true;
+    }
+    
+    rsgis::img::RSGISCalcImageValue* RSGISApply6SCoefficientsElevAOTLUTParam::clone()
+    {
+        return new RSGISApply6SCoefficientsElevAOTLUTParam(this->numOutBands, this->lut, this->noDataVal, this->useNoDataVal, this->scaleFactor);
+    }
+    
+    void RSGISApply6SCoefficientsElevAOTLUTParam::calcPxlValue(const float* const* bands, size_t pxl, int numBands, double **output)
     {
         if(numBands-2 != this->numOutBands)
         {
@@ -315,15 +504,15 @@ namespace rsgis{namespace calib{
         }
         
         double tmpVal = 0;
-        float elevVal = bandValues[0];
-        float aotVal = bandValues[1];
+        float elevVal = bands[0][pxl];
+        float aotVal = bands[1][pxl];
 		
         bool nodata = true;
         if(this->useNoDataVal)
         {
             for(int i = 2; i < numBands; ++i)
             {
-                if(bandValues[i] != this->noDataVal)
+                if(bands[i][pxl] != this->noDataVal)
                 {
                     nodata = false;
                     break;
@@ -341,97 +530,53 @@ namespace rsgis{namespace calib{
         {
             for(unsigned int i = 0; i < this->numOutBands; ++i)
             {
-                output[i] = 0;
+                output[i][pxl] = 0;
             }
         }
         else
         {
-            LUT6SBaseElevAOT elevLUTVal;
-            unsigned int elevLUTIdx = 0;
-            float dist = 0.0;
-            float minDist = 0.0;
-                        
-            for(unsigned int i = 0; i < lut->size(); ++i)
+            if(lut->empty())
             {
-                dist = (lut->at(i).elev - elevVal) * (lut->at(i).elev - elevVal);
-                if(i == 0)
-                {
-                    minDist = dist;
-                    elevLUTIdx = i;
-                }
-                else if(dist < minDist)
-                {
-                    minDist = dist;
-                    elevLUTIdx = i;
-                }
-            }
-            
-            if(elevLUTIdx >= lut->size())
-            {
-                std::cerr << "elevVal = " << elevVal << std::endl;
-                std::cerr << "elevLUTIdx = " << elevLUTIdx << std::endl;
-                std::cerr << "lut->size() = " << lut->size() << std::endl;
-                
                 throw rsgis::img::RSGISImageCalcException("Elevation value is not within the LUT.");
             }
+            unsigned int elevLUTIdx = this->elevIndex.getNearestBin(elevVal);
+            const LUT6SBaseElevAOT &elevLUTVal = lut->at(elevLUTIdx);
             
-            elevLUTVal = lut->at(elevLUTIdx);
-            
-            LUT6SAOT aotLUTVal;
-            unsigned int aotLUTIdx = 0;
-            
-            for(unsigned int i = 0; i < elevLUTVal.aotLUT.size(); ++i)
+            if(elevLUTVal.aotLUT.empty())
             {
-                dist = (elevLUTVal.aotLUT.at(i).aot - aotVal) * (elevLUTVal.aotLUT.at(i).aot - aotVal);
-                if(i == 0)
-                {
-                    minDist = dist;
-                    aotLUTIdx = i;
-                }
-                else if(dist < minDist)
-                {
-                    minDist = dist;
-                    aotLUTIdx = i;
-                }
-            }
-                        
-            if(aotLUTIdx >= elevLUTVal.aotLUT.size())
-            {
-                std::cerr << "aotVal = " << aotVal << std::endl;
-                std::cerr << "aotLUTIdx = " << aotLUTIdx << std::endl;
-                std::cerr << "elevLUTVal.aotLUT.size() = " << elevLUTVal.aotLUT.size() << std::endl;
-                
                 throw rsgis::img::RSGISImageCalcException("AOT value is not within the LUT.");
             }
+            unsigned int aotLUTIdx = this->aotIndexes[elevLUTIdx].getNearestBin(aotVal);
+            const LUT6SAOT &aotLUTVal = elevLUTVal.aotLUT.at(aotLUTIdx);
             
-            aotLUTVal = elevLUTVal.aotLUT.at(aotLUTIdx);
-            
+            double outVal = 0.0;
             for(unsigned int i = 0; i < aotLUTVal.numValues; ++i)
             {
-                if(aotLUTVal.imageBands[i] > numBands)
+                if(aotLUTVal.imageBands[i] >= numBands)
                 {
                     std::cout << "Image band: " << aotLUTVal.imageBands[i] << std::endl;
                     throw rsgis::img::RSGISImageCalcException("Image band is not within image.");
                 }
                 
-                tmpVal=aotLUTVal.aX[i]*bandValues[aotLUTVal.imageBands[i]]-aotLUTVal.bX[i];
-                output[i] = (tmpVal/(1.0+aotLUTVal.cX[i]*tmpVal))*this->scaleFactor;
+                tmpVal=aotLUTVal.aX[i]*bands[aotLUTVal.imageBands[i]][pxl]-aotLUTVal.bX[i];
+                outVal = (tmpVal/(1.0+aotLUTVal.cX[i]*tmpVal))*this->scaleFactor;
 
                 if(this->useNoDataVal & (this->noDataVal == 0.0))
                 {
-                    if(output[i] < 1)
+                    if(outVal < 1)
                     {
-                        output[i] = 1.0;
+                        outVal = 1.0;
                     }
                     else
                     {
-                        output[i] = output[i] + 1.0;
+                        outVal = outVal + 1.0;
                     }
                 }
-                if(output[i] > this->scaleFactor)
+                if(outVal > this->scaleFactor)
                 {
-                    output[i] = this->scaleFactor;
+                    outVal = this->scaleFactor;
                 }
+                output[i][pxl] = outVal;
             }
         }
         
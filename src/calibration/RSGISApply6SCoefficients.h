@@ -29,6 +29,9 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
 
 #include "gdal_priv.h"
 
@@ -85,6 +88,35 @@ namespace rsgis{namespace calib{
         std::vector<LUT6SAOT> aotLUT;
     };
 	    
+    /**
+     * Finds the nearest of a set of LUT bins (e.g., the elevations or AOTs of
+     * the 6S coefficients) to a value without searching all the bins. A regular
+     * grid is defined over (and either side of) the range of the bins, with each
+     * cell listing the bins which can be the nearest to a value within the cell,
+     * so only those bins are compared. The bin returned is the same as a search
+     * of all the bins for the minimum squared difference (the first on ties),
+     * which is used for values outside of the grid.
+     */
+    class DllExport RSGIS6SLUTBinIndex
+    {
+    public:
+        RSGIS6SLUTBinIndex();
+        RSGIS6SLUTBinIndex(std::vector<float> binVals);
+        unsigned int getNearestBin(float val) const;
+        ~RSGIS6SLUTBinIndex();
+    protected:
+        unsigned int findNearestBin(float val, const unsigned int *bins, size_t numBins) const;
+        std::vector<float> binVals;
+        std::vector<unsigned int> allBins;
+        bool useGrid;
+        double gridMin;
+        double cellWidth;
+        size_t numCells;
+        // The bins for cell c are cellBins[cellStart[c]] to cellBins[cellStart[c+1]-1], in bin order.
+        std::vector<size_t> cellStart;
+        std::vector<unsigned int> cellBins;
+    };
+    
 	class DllExport RSGISApply6SCoefficientsSingleParam : public rsgis::img::RSGISCalcImageValue
     {
     public: 
@@ -109,10 +141,16 @@ namespace rsgis{namespace calib{
     public:
         RSGISApply6SCoefficientsElevLUTParam(unsigned int numOutBands, std::vector<LUT6SElevation> *lut, float demNoDataVal, float noDataVal = 0.0, bool useNoDataVal=false, float scaleFactor = 1.0);
         void calcImageValue(float *bandValues, int numBands, double *output);
+        bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        rsgis::img::RSGISCalcImageValue* clone();
         ~RSGISApply6SCoefficientsElevLUTParam();
     protected:
+        void calcPxlValue(const float* const* bands, size_t pxl, int numBands, double **output);
         std::vector<LUT6SElevation> *lut;
         LUT6SElevation minElevCoeffs;
+        RSGIS6SLUTBinIndex elevIndex;
+        std::vector<const float*> pxlBands;
+        std::vector<double*> pxlOutput;
         float scaleFactor;
         float demNoDataVal;
         float noDataVal;
@@ -125,9 +163,17 @@ namespace rsgis{namespace calib{
     public:
         RSGISApply6SCoefficientsElevAOTLUTParam(unsigned int numOutBands, std::vector<LUT6SBaseElevAOT> *lut, float noDataVal = 0.0, bool useNoDataVal=false, float scaleFactor = 1.0);
         void calcImageValue(float *bandValues, int numBands, double *output);
+        bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        rsgis::img::RSGISCalcImageValue* clone();
         ~RSGISApply6SCoefficientsElevAOTLUTParam();
     protected:
+        void calcPxlValue(const float* const* bands, size_t pxl, int numBands, double **output);
         std::vector<LUT6SBaseElevAOT> *lut;
+        RSGIS6SLUTBinIndex elevIndex;
+        // An index of the AOT bins for each elevation bin.
+        std::vector<RSGIS6SLUTBinIndex> aotIndexes;
+        std::vector<const float*> pxlBands;
+        std::vector<double*> pxlOutput;
         float scaleFactor;
         float noDataVal;
         bool useNoDataVal;
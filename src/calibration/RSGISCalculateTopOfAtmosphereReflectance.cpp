@@ -47,6 +47,11 @@ namespace rsgis{namespace calib{
         }
     }
     
+    rsgis::img::RSGISCalcImageValue* RSGISCalculateTopOfAtmosphereReflectance::clone()
+    {
+        return new RSGISCalculateTopOfAtmosphereReflectance(this->numOutBands, this->solarIrradiance, this->distance, this->solarZenith, this->scaleFactor);
+    }
+    
     RSGISCalculateTopOfAtmosphereReflectance::~RSGISCalculateTopOfAtmosphereReflectance()
     {
         
@@ -86,12 +91,96 @@ namespace rsgis{namespace calib{
         
     }
     
+    bool RSGISCalculateTOAThermalBrightness::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        if(numBands != this->numOutBands)
+        {
+            throw rsgis::img::RSGISImageCalcException("The number of input and output image bands needs to be the same.");
+        }
+        
+        // Same expression as calcImageValue so the output is identical.
+        for(int i = 0; i < numBands; ++i)
+        {
+            const float *inBand = bands[i];
+            double *outBand = output[i];
+            const float bandK1 = k1[i];
+            const float bandK2 = k2[i];
+            for(size_t p = 0; p < nPxls; ++p)
+            {
+                if(inBand[p] != 0.0)
+                {
+                    double temp =  bandK2 / log((bandK1 / inBand[p]) + 1.0);
+                    outBand[p] = (temp - 273.15) * this->scaleFactor;
+                }
+                else
+                {
+                    outBand[p] = 0.0;
+                }
+            }
+        }
+        return true;
+    }
+    
+    rsgis::img::RSGISCalcImageValue* RSGISCalculateTOAThermalBrightness::clone()
+    {
+        return new RSGISCalculateTOAThermalBrightness(this->numOutBands, this->k1, this->k2, this->scaleFactor);
+    }
+    
     RSGISCalculateTOAThermalBrightness::~RSGISCalculateTOAThermalBrightness()
     {
         
     }
     
     
+    RSGISCalculateTOAThermalBrightnessFromDN::RSGISCalculateTOAThermalBrightnessFromDN(int numberOutBands, float *multiVals, float *addVals, float *k1, float *k2, float scaleFactor):rsgis::img::RSGISCalcImageValue(numberOutBands)
+    {
+        this->multiVals = multiVals;
+        this->addVals = addVals;
+        this->k1 = k1;
+        this->k2 = k2;
+        this->scaleFactor = scaleFactor;
+    }
+    
+    void RSGISCalculateTOAThermalBrightnessFromDN::calcImageValue(float *bandValues, int numBands, double *output)
+    {
+        if(numBands != this->numOutBands)
+        {
+            throw rsgis::img::RSGISImageCalcException("The number of input and output image bands needs to be the same.");
+        }
+        
+        // If pixels values are 0 - consider image border
+        bool nodata = true;
+        for(int i = 0; i < numBands; ++i)
+        {
+            if(bandValues[i] != 0)
+            {
+                nodata = false;
+                break;
+            }
+        }
+        
+        for(int i = 0; i < numBands; ++i)
+        {
+            // The radiance is a float, as it would be if written to a Float32 radiance image.
+            float radiance = (this->multiVals[i] * bandValues[i]) + this->addVals[i];
+            if(!nodata && (radiance != 0.0))
+            {
+                double temp =  k2[i] / log((k1[i] / radiance) + 1.0);
+                output[i] = (temp - 273.15) * this->scaleFactor;
+            }
+            else
+            {
+                output[i] = 0.0;
+            }
+        }
+    }
+    
+    rsgis::img::RSGISCalcImageValue* RSGISCalculateTOAThermalBrightnessFromDN::clone()
+    {
+        return new RSGISCalculateTOAThermalBrightnessFromDN(this->numOutBands, this->multiVals, this->addVals, this->k1, this->k2, this->scaleFactor);
+    }
+    
+    
     
     
     
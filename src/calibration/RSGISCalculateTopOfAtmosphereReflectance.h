@@ -101,6 +101,7 @@ namespace rsgis{namespace calib{
     public: 
         RSGISCalculateTopOfAtmosphereReflectance(int numberOutBands, float *solarIrradiance, double distance, float solarZenith, float scaleFactor = 1);
         void calcImageValue(float *bandValues, int numBands, double *output);
+        rsgis::img::RSGISCalcImageValue* clone();
         ~RSGISCalculateTopOfAtmosphereReflectance();
     protected:
         float *solarIrradiance;
@@ -115,12 +116,37 @@ namespace rsgis{namespace calib{
     public:
         RSGISCalculateTOAThermalBrightness(int numberOutBands, float *k1, float *k2, float scaleFactor = 1);
         void calcImageValue(float *bandValues, int numBands, double *output);
+        bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        rsgis::img::RSGISCalcImageValue* clone();
         ~RSGISCalculateTOAThermalBrightness();
     protected:
         float *k1;
         float *k2;
         float scaleFactor;
     };
+    
+    /**
+     * Converts thermal DNs to at sensor brightness temperature (degrees C) in one step,
+     * i.e., the radiance ((multiVal * DN) + addVal, as RSGISLandsatRadianceCalibrationMultiAdd)
+     * converted as RSGISCalculateTOAThermalBrightness. Pixels where all the bands are 0
+     * (i.e., the image border) are 0. Each output band is only a function of the same
+     * input band, so for 8 and 16 bit DNs it can be applied with rsgis::img::RSGISCalcImageLUT
+     * (i.e., evaluated once per DN rather than per pixel).
+     */
+    class DllExport RSGISCalculateTOAThermalBrightnessFromDN : public rsgis::img::RSGISCalcImageValue
+    {
+    public:
+        RSGISCalculateTOAThermalBrightnessFromDN(int numberOutBands, float *multiVals, float *addVals, float *k1, float *k2, float scaleFactor = 1);
+        void calcImageValue(float *bandValues, int numBands, double *output);
+        rsgis::img::RSGISCalcImageValue* clone();
+        ~RSGISCalculateTOAThermalBrightnessFromDN(){};
+    protected:
+        float *multiVals;
+        float *addVals;
+        float *k1;
+        float *k2;
+        float scaleFactor;
+    };
 	
     
     class DllExport RSGISCalculateRadianceFromTOAReflectance : public rsgis::img::RSGISCalcImageValue
@@ -0,0 +1,382 @@
+/*
+ *  RSGISCalibrationPipeline.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISCalibrationPipeline.h"
+
+namespace rsgis{namespace calib{
+
+    RSGISCalibrationPipeline::RSGISCalibrationPipeline(unsigned int numThreads)
+    {
+        this->numThreads = numThreads;
+        if(this->numThreads == 0)
+        {
+            this->numThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+        }
+    }
+
+    int RSGISCalibrationPipeline::addStage(rsgis::img::RSGISCalcImageValue *calcValue, int inputStage, std::vector<GDALDataset*> auxDatasets, GDALDataType outDataType, std::string outputImage, std::string gdalFormat, std::vector<std::string> bandNames)
+    {
+        if(calcValue == NULL)
+        {
+            throw rsgis::img::RSGISImageCalcException("The calibration stage does not have a calculation.");
+        }
+        if((inputStage < -1) || (inputStage >= ((int)this->stages.size())))
+        {
+            throw rsgis::img::RSGISImageCalcException("The input to a calibration stage must be the input images or an earlier stage.");
+        }
+        if((!bandNames.empty()) && (bandNames.size() != ((size_t)calcValue->getNumOutBands())))
+        {
+            throw rsgis::img::RSGISImageCalcException("The number of band names is not the same as the number of output bands of the calibration stage.");
+        }
+        RSGISCalibrationStage stage;
+        stage.calcValue = calcValue;
+        stage.inputStage = inputStage;
+        stage.auxDatasets = auxDatasets;
+        stage.outDataType = outDataType;
+        stage.outputImage = outputImage;
+        stage.gdalFormat = gdalFormat;
+        stage.bandNames = bandNames;
+        this->stages.push_back(stage);
+        return this->stages.size() - 1;
+    }
+
+    void RSGISCalibrationPipeline::runPipeline(GDALDataset **datasets, int numDS)
+    {
+        if(this->stages.empty())
+        {
+            throw rsgis::img::RSGISImageCalcException("The calibration pipeline does not have any stages.");
+        }
+        unsigned int numStages = this->stages.size();
+        bool haveOutput = false;
+        for(unsigned int s = 0; s < numStages; ++s)
+        {
+            haveOutput = haveOutput || (this->stages[s].outputImage != "");
+        }
+        if(!haveOutput)
+        {
+            throw rsgis::img::RSGISImageCalcException("None of the calibration stages have an output image.");
+        }
+
+        // The input images are followed by the auxiliary images of each stage.
+        std::vector<GDALDataset*> allDatasets(datasets, datasets + numDS);
+        std::vector<unsigned int> stageAuxDS(numStages);
+        for(unsigned int s = 0; s < numStages; ++s)
+        {
+            stageAuxDS[s] = allDatasets.size();
+            allDatasets.insert(allDatasets.end(), this->stages[s].auxDatasets.begin(), this->stages[s].auxDatasets.end());
+        }
+        unsigned int numAllDS = allDatasets.size();
+        if(numAllDS == 0)
+        {
+            throw rsgis::img::RSGISImageCalcException("The calibration pipeline does not have any input images.");
+        }
+
+        rsgis::img::RSGISImageUtils imgUtils;
+        int width = 0;
+        int height = 0;
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        double gdalTranslation[6];
+        std::vector<int> dsOffsetVals(numAllDS * 2, 0);
+        std::vector<int*> dsOffsets(numAllDS);
+        for(unsigned int i = 0; i < numAllDS; ++i)
+        {
+            dsOffsets[i] = &dsOffsetVals[i * 2];
+        }
+        imgUtils.getImageOverlap(allDatasets.data(), numAllDS, dsOffsets.data(), &width, &height, gdalTranslation, &xBlockSize, &yBlockSize);
+
+        // The image bands (and the offsets of their images) read for each strip.
+        std::vector<GDALRasterBand*> readBands;
+        std::vector<unsigned int> readBandDS;
+        std::vector<unsigned int> dsFirstBand(numAllDS);
+        for(unsigned int i = 0; i < numAllDS; ++i)
+        {
+            dsFirstBand[i] = readBands.size();
+            for(int j = 0; j < allDatasets[i]->GetRasterCount(); ++j)
+            {
+                readBands.push_back(allDatasets[i]->GetRasterBand(j+1));
+                readBandDS.push_back(i);
+            }
+        }
+        unsigned int numInputBands = 0;
+        for(int i = 0; i < numDS; ++i)
+        {
+            numInputBands += datasets[i]->GetRasterCount();
+        }
+
+        // The number of input (auxiliary bands followed by the input values) and output bands of each stage.
+        std::vector<unsigned int> stageNumInBands(numStages);
+        std::vector<unsigned int> stageNumOutBands(numStages);
+        for(unsigned int s = 0; s < numStages; ++s)
+        {
+            stageNumOutBands[s] = this->stages[s].calcValue->getNumOutBands();
+            unsigned int numAuxBands = 0;
+            for(auto iterDS = this->stages[s].auxDatasets.begin(); iterDS != this->stages[s].auxDatasets.end(); ++iterDS)
+            {
+                numAuxBands += (*iterDS)->GetRasterCount();
+            }
+            int inStage = this->stages[s].inputStage;
+            stageNumInBands[s] = numAuxBands + ((inStage < 0)?numInputBands:stageNumOutBands[inStage]);
+        }
+
+        unsigned int stripRows = std::max((unsigned int)std::max(yBlockSize, 1), RSGIS_CALIB_STRIP_ROWS);
+        size_t stripPxls = ((size_t)width) * stripRows;
+        std::vector< std::vector<float> > readVals(readBands.size(), std::vector<float>(stripPxls));
+        std::vector< std::vector< std::vector<double> > > stageOutVals(numStages);
+        std::vector< std::vector< std::vector<float> > > stageVals(numStages);
+        for(unsigned int s = 0; s < numStages; ++s)
+        {
+            stageOutVals[s].assign(stageNumOutBands[s], std::vector<double>(stripPxls));
+            stageVals[s].assign(stageNumOutBands[s], std::vector<float>(stripPxls));
+        }
+
+        // The input values of each stage within the strip.
+        std::vector< std::vector<const float*> > stageInPtrs(numStages);
+        std::vector< std::vector<double*> > stageOutPtrs(numStages);
+        for(unsigned int s = 0; s < numStages; ++s)
+        {
+            for(auto iterDS = this->stages[s].auxDatasets.begin(); iterDS != this->stages[s].auxDatasets.end(); ++iterDS)
+            {
+                unsigned int dsIdx = stageAuxDS[s] + (iterDS - this->stages[s].auxDatasets.begin());
+                for(int j = 0; j < allDatasets[dsIdx]->GetRasterCount(); ++j)
+                {
+                    stageInPtrs[s].push_back(readVals[dsFirstBand[dsIdx] + j].data());
+                }
+            }
+            int inStage = this->stages[s].inputStage;
+            if(inStage < 0)
+            {
+                for(unsigned int n = 0; n < numInputBands; ++n)
+                {
+                    stageInPtrs[s].push_back(readVals[n].data());
+                }
+            }
+            else
+            {
+                for(unsigned int n = 0; n < stageNumOutBands[inStage]; ++n)
+                {
+                    stageInPtrs[s].push_back(stageVals[inStage][n].data());
+                }
+            }
+            for(unsigned int n = 0; n < stageNumOutBands[s]; ++n)
+            {
+                stageOutPtrs[s].push_back(stageOutVals[s][n].data());
+            }
+        }
+
+        // One copy of the stages per thread; threadCalcs[0] are the stages themselves.
+        std::vector< std::vector<rsgis::img::RSGISCalcImageValue*> > threadCalcs(1);
+        for(unsigned int s = 0; s < numStages; ++s)
+        {
+            threadCalcs[0].push_back(this->stages[s].calcValue);
+        }
+        bool cloned = true;
+        for(unsigned int t = 1; (t < this->numThreads) && cloned; ++t)
+        {
+            std::vector<rsgis::img::RSGISCalcImageValue*> calcs;
+            for(unsigned int s = 0; (s < numStages) && cloned; ++s)
+            {
+                rsgis::img::RSGISCalcImageValue *calc = this->stages[s].calcValue->clone();
+                if(calc == NULL)
+                {
+                    cloned = false;
+                }
+                else
+                {
+                    calcs.push_back(calc);
+                }
+            }
+            if(cloned)
+            {
+                threadCalcs.push_back(calcs);
+            }
+            else
+            {
+                for(auto iterCalc = calcs.begin(); iterCalc != calcs.end(); ++iterCalc)
+                {
+                    delete *iterCalc;
+                }
+            }
+        }
+        unsigned int nThreads = threadCalcs.size();
+
+        std::vector<GDALDataset*> outDatasets(numStages, NULL);
+        auto cleanUp = [&]()
+        {
+            for(unsigned int s = 0; s < numStages; ++s)
+            {
+                if(outDatasets[s] != NULL)
+                {
+                    GDALClose(outDatasets[s]);
+                    outDatasets[s] = NULL;
+                }
+            }
+            for(unsigned int t = 1; t < threadCalcs.size(); ++t)
+            {
+                for(auto iterCalc = threadCalcs[t].begin(); iterCalc != threadCalcs[t].end(); ++iterCalc)
+                {
+                    delete *iterCalc;
+                }
+            }
+            threadCalcs.resize(1);
+        };
+
+        try
+        {
+            for(unsigned int s = 0; s < numStages; ++s)
+            {
+                if(this->stages[s].outputImage == "")
+                {
+                    continue;
+                }
+                GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(this->stages[s].gdalFormat.c_str());
+                if(gdalDriver == NULL)
+                {
+                    throw rsgis::img::RSGISImageCalcException("Requested GDAL driver does not exists..");
+                }
+                char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(this->stages[s].gdalFormat);
+                std::cout << "New image width = " << width << " height = " << height << " bands = " << stageNumOutBands[s] << std::endl;
+                outDatasets[s] = gdalDriver->Create(this->stages[s].outputImage.c_str(), width, height, stageNumOutBands[s], this->stages[s].outDataType, papszOptions);
+                if(outDatasets[s] == NULL)
+                {
+                    throw rsgis::img::RSGISImageCalcException("Output image could not be created. Check filepath.");
+                }
+                outDatasets[s]->SetGeoTransform(gdalTranslation);
+                outDatasets[s]->SetProjection(allDatasets[0]->GetProjectionRef());
+                for(unsigned int n = 0; n < this->stages[s].bandNames.size(); ++n)
+                {
+                    outDatasets[s]->GetRasterBand(n+1)->SetDescription(this->stages[s].bandNames[n].c_str());
+                }
+            }
+
+            std::vector< std::vector<const float*> > threadInBlock(nThreads);
+            std::vector< std::vector<double*> > threadOutBlock(nThreads);
+            std::vector< std::vector<float> > threadInDataColumn(nThreads);
+            std::vector< std::vector<double> > threadOutDataColumn(nThreads);
+            std::vector< std::vector<unsigned char> > threadTypeVals(nThreads);
+
+            rsgis::RSGISThreadPool threadPool(nThreads);
+            rsgis_tqdm pbar;
+            for(int row = 0; row < height; row += stripRows)
+            {
+                pbar.progress(row, height);
+                int nRows = std::min((int)stripRows, height - row);
+                for(unsigned int n = 0; n < readBands.size(); ++n)
+                {
+                    int xOff = dsOffsets[readBandDS[n]][0];
+                    int yOff = dsOffsets[readBandDS[n]][1] + row;
+                    if(readBands[n]->RasterIO(GF_Read, xOff, yOff, width, nRows, readVals[n].data(), width, nRows, GDT_Float32, 0, 0) != CE_None)
+                    {
+                        throw rsgis::img::RSGISImageCalcException("Could not read the input image band.");
+                    }
+                }
+
+                threadPool.parallelFor(0, nRows, [&](unsigned int t, size_t startRow, size_t endRow)
+                {
+                    size_t pxlOff = startRow * width;
+                    size_t nPxls = (endRow - startRow) * width;
+                    for(unsigned int s = 0; s < numStages; ++s)
+                    {
+                        unsigned int numInBands = stageNumInBands[s];
+                        unsigned int numOutBands = stageNumOutBands[s];
+                        threadInBlock[t].resize(numInBands);
+                        threadOutBlock[t].resize(numOutBands);
+                        for(unsigned int n = 0; n < numInBands; ++n)
+                        {
+                            threadInBlock[t][n] = stageInPtrs[s][n] + pxlOff;
+                        }
+                        for(unsigned int n = 0; n < numOutBands; ++n)
+                        {
+                            threadOutBlock[t][n] = stageOutPtrs[s][n] + pxlOff;
+                        }
+
+                        if(!threadCalcs[t][s]->calcImageBlock(threadInBlock[t].data(), numInBands, nPxls, threadOutBlock[t].data()))
+                        {
+                            threadInDataColumn[t].resize(numInBands);
+                            threadOutDataColumn[t].resize(numOutBands);
+                            float *inDataColumn = threadInDataColumn[t].data();
+                            double *outDataColumn = threadOutDataColumn[t].data();
+                            for(size_t i = 0; i < nPxls; ++i)
+                            {
+                                for(unsigned int n = 0; n < numInBands; ++n)
+                                {
+                                    inDataColumn[n] = threadInBlock[t][n][i];
+                                }
+                                threadCalcs[t][s]->calcImageValue(inDataColumn, numInBands, outDataColumn);
+                                for(unsigned int n = 0; n < numOutBands; ++n)
+                                {
+                                    threadOutBlock[t][n][i] = outDataColumn[n];
+                                }
+                            }
+                        }
+
+                        // The values passed on are those which would be read back from an image of the stage data type.
+                        GDALDataType outDataType = this->stages[s].outDataType;
+                        int typeBytes = GDALGetDataTypeSizeBytes(outDataType);
+                        for(unsigned int n = 0; n < numOutBands; ++n)
+                        {
+                            float *vals = stageVals[s][n].data() + pxlOff;
+                            if((outDataType == GDT_Float32) || (outDataType == GDT_Float64))
+                            {
+                                GDALCopyWords(threadOutBlock[t][n], GDT_Float64, sizeof(double), vals, GDT_Float32, sizeof(float), nPxls);
+                            }
+                            else
+                            {
+                                threadTypeVals[t].resize(nPxls * typeBytes);
+                                GDALCopyWords(threadOutBlock[t][n], GDT_Float64, sizeof(double), threadTypeVals[t].data(), outDataType, typeBytes, nPxls);
+                                GDALCopyWords(threadTypeVals[t].data(), outDataType, typeBytes, vals, GDT_Float32, sizeof(float), nPxls);
+                            }
+                        }
+                    }
+                });
+
+                for(unsigned int s = 0; s < numStages; ++s)
+                {
+                    if(outDatasets[s] == NULL)
+                    {
+                        continue;
+                    }
+                    for(unsigned int n = 0; n < stageNumOutBands[s]; ++n)
+                    {
+                        if(outDatasets[s]->GetRasterBand(n+1)->RasterIO(GF_Write, 0, row, width, nRows, stageOutVals[s][n].data(), width, nRows, GDT_Float64, 0, 0) != CE_None)
+                        {
+                            throw rsgis::img::RSGISImageCalcException("Could not write the output image band.");
+                        }
+                    }
+                }
+            }
+            pbar.finish();
+        }
+        catch(std::exception&)
+        {
+            cleanUp();
+            throw;
+        }
+        cleanUp();
+    }
+
+    RSGISCalibrationPipeline::~RSGISCalibrationPipeline()
+    {
+
+    }
+
+}}
@@ -0,0 +1,99 @@
+/*
+ *  RSGISCalibrationPipeline.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISCalibrationPipeline_H
+#define RSGISCalibrationPipeline_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISImageException.h"
+#include "common/RSGISThreadPool.h"
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISCalcImageValue.h"
+#include "img/RSGISImageUtils.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_calib_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace calib{
+
+    static const unsigned int RSGIS_CALIB_STRIP_ROWS( 256 );
+
+    struct DllExport RSGISCalibrationStage
+    {
+        rsgis::img::RSGISCalcImageValue *calcValue;
+        /// The stage whose output is the input to this stage (-1 for the pipeline input images).
+        int inputStage;
+        /// Images whose bands are passed to the stage before the input values (e.g., a DEM).
+        std::vector<GDALDataset*> auxDatasets;
+        GDALDataType outDataType;
+        /// The image the output of the stage is written to (empty if not written).
+        std::string outputImage;
+        std::string gdalFormat;
+        std::vector<std::string> bandNames;
+    };
+
+    /**
+     * Applies a chain of per-pixel calibration steps (e.g., DN to radiance,
+     * radiance to TOA reflectance, radiance to surface reflectance) in a single
+     * pass over the input images. Each stage takes the output of an earlier
+     * stage (or the input images) and, optionally, the bands of some auxiliary
+     * images and only the stages with an output image are written to disk.
+     *
+     * The output of each stage is converted to the data type of the stage before
+     * it is passed on, so the results are the same as running each stage as a
+     * separate RSGISCalcImage job through an image of that data type.
+     */
+    class DllExport RSGISCalibrationPipeline
+    {
+    public:
+        /** If numThreads is 0 the number of hardware threads is used. */
+        RSGISCalibrationPipeline(unsigned int numThreads=1);
+        /** Add a stage to the pipeline, returning the index of the stage. The calcValue is not owned by the pipeline. */
+        int addStage(rsgis::img::RSGISCalcImageValue *calcValue, int inputStage, std::vector<GDALDataset*> auxDatasets, GDALDataType outDataType=GDT_Float32, std::string outputImage="", std::string gdalFormat="KEA", std::vector<std::string> bandNames=std::vector<std::string>());
+        /** Run the stages over the overlap of the input and auxiliary images. */
+        void runPipeline(GDALDataset **datasets, int numDS);
+        ~RSGISCalibrationPipeline();
+    protected:
+        std::vector<RSGISCalibrationStage> stages;
+        unsigned int numThreads;
+    };
+
+}}
+
+#endif
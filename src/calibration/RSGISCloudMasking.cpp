@@ -329,9 +329,20 @@ namespace rsgis{namespace calib{
         {
             this->numPCPPxls = this->numPCPPxls + 1.0;
         }
-        
+
     }
-    
+
+    void RSGISLandsatFMaskExportPass1LandWaterCloudMasking::reduce(rsgis::img::RSGISCalcImageValue *other)
+    {
+        RSGISLandsatFMaskExportPass1LandWaterCloudMasking *otherCounts = dynamic_cast<RSGISLandsatFMaskExportPass1LandWaterCloudMasking*>(other);
+        if(otherCounts == NULL)
+        {
+            throw rsgis::img::RSGISImageCalcException("Can only reduce with another RSGISLandsatFMaskExportPass1LandWaterCloudMasking object.");
+        }
+        this->numValidPxls = this->numValidPxls + otherCounts->numValidPxls;
+        this->numPCPPxls = this->numPCPPxls + otherCounts->numPCPPxls;
+    }
+
     double RSGISLandsatFMaskExportPass1LandWaterCloudMasking::propOfPCPPixels()
     {
         double outPCPProp = 0.0;
@@ -777,10 +788,15 @@ namespace rsgis{namespace calib{
     
     
     
-    void RSGISCalcCloudParams::calcCloudHeights(GDALDataset *thermal, GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, double lowerLandThres, double upperLandThres, float scaleFactor)
+    void RSGISCalcCloudParams::calcCloudHeights(GDALDataset *thermal, GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, double lowerLandThres, double upperLandThres, float scaleFactor, unsigned int numThreads)
     {
         try
         {
+            if(numThreads == 0)
+            {
+                numThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+            }
+            
             rsgis::rastergis::RSGISPopRATWithStats popRatStats;
             
             std::vector<rsgis::rastergis::RSGISBandAttStats *> bandStats = std::vector<rsgis::rastergis::RSGISBandAttStats *>();
@@ -824,32 +840,100 @@ namespace rsgis{namespace calib{
             double *hBaseMin = new double[numcloudsRATHistoRows];
             double *hBaseMax = new double[numcloudsRATHistoRows];
             
-            OGREnvelope *env = new OGREnvelope();
-            
-            rsgis::img::RSGISImagePercentiles calcImgPercentiles;
-            
-            double pi = 3.141592653589793;
-            double r = 0.0;
-            double percentile = 0.0;
-            cloudBase[0] = 0.0;
-            for(size_t i = 1; i < numcloudsRATHistoRows; ++i)
+            // Read the clumps and the thermal band into memory and get the pixels of each clump once.
+            double trans[6];
+            cloudClumpsDS->GetGeoTransform(trans);
+            int nXPxl = cloudClumpsDS->GetRasterXSize();
+            int nYPxl = cloudClumpsDS->GetRasterYSize();
+            if(!this->onSameGrid(thermal, trans, nXPxl, nYPxl))
+            {
+                throw rsgis::img::RSGISImageCalcException("The thermal and cloud clumps images must be on the same pixel grid.");
+            }
+            size_t nPxls = ((size_t)nXPxl) * nYPxl;
+            std::vector<unsigned int> clumpVals(nPxls);
+            std::vector<float> thermVals(nPxls);
+            for(int y = 0; y < nYPxl; ++y)
             {
-                r = sqrt(cloudsRATHisto[i] / (2 * pi));
-                if(r > 8)
+                size_t rowOff = ((size_t)y) * nXPxl;
+                if(cloudClumpsDS->GetRasterBand(1)->RasterIO(GF_Read, 0, y, nXPxl, 1, &clumpVals[rowOff], nXPxl, 1, GDT_UInt32, 0, 0) != CE_None)
                 {
-                    percentile = ((r-8.0)*(r-8.0)) / (r*r);
-                    env->MinX = minX[i];
-                    env->MaxX = maxX[i];
-                    env->MinY = minY[i];
-                    env->MaxY = maxY[i];
-
-                    cloudBase[i] = calcImgPercentiles.getPercentile(thermal, 1, cloudClumpsDS, i, percentile, 0, true, env, true);
+                    throw rsgis::img::RSGISImageCalcException("Could not read the cloud clumps image.");
                 }
-                else
+                if(thermal->GetRasterBand(1)->RasterIO(GF_Read, 0, y, nXPxl, 1, &thermVals[rowOff], nXPxl, 1, GDT_Float32, 0, 0) != CE_None)
                 {
-                    cloudBase[i] = minBT[i];
+                    throw rsgis::img::RSGISImageCalcException("Could not read the thermal image.");
                 }
-                
+            }
+            std::vector<size_t> clumpPxlStart;
+            std::vector<size_t> clumpPxls;
+            this->getClumpPxls(clumpVals, numcloudsRATHistoRows, &clumpPxlStart, &clumpPxls);
+            std::vector<unsigned int>().swap(clumpVals);
+            
+            // The cloud base of each large clump is a percentile of the thermal values within
+            // the extent of the clump (see RSGISImagePercentiles::getPercentile), where the
+            // clumps are interleaved between the threads as their sizes vary.
+            double pi = 3.141592653589793;
+            rsgis::RSGISThreadPool threadPool(numThreads);
+            unsigned int nThreads = threadPool.getNumThreads();
+            rsgis_tqdm pbar;
+            threadPool.parallelFor(0, nThreads, [&](unsigned int threadIdx, size_t tStart, size_t tEnd)
+            {
+                std::vector<double> dataVals;
+                for(size_t i = 1 + tStart; i < numcloudsRATHistoRows; i += nThreads)
+                {
+                    if(threadIdx == 0)
+                    {
+                        pbar.progress(i, numcloudsRATHistoRows);
+                    }
+                    
+                    double r = sqrt(cloudsRATHisto[i] / (2 * pi));
+                    if(r > 8)
+                    {
+                        double percentile = ((r-8.0)*(r-8.0)) / (r*r);
+                        OGREnvelope env;
+                        env.MinX = minX[i];
+                        env.MaxX = maxX[i];
+                        env.MinY = minY[i];
+                        env.MaxY = maxY[i];
+                        int xOff = 0;
+                        int yOff = 0;
+                        int width = 0;
+                        int height = 0;
+                        double winTLX = 0.0;
+                        double winTLY = 0.0;
+                        this->getEnvelopeWindow(env, trans, nXPxl, nYPxl, &xOff, &yOff, &width, &height, &winTLX, &winTLY);
+                        
+                        dataVals.clear();
+                        for(size_t p = clumpPxlStart[i]; p < clumpPxlStart[i+1]; ++p)
+                        {
+                            long x = ((long)(clumpPxls[p] % nXPxl)) - xOff;
+                            long y = ((long)(clumpPxls[p] / nXPxl)) - yOff;
+                            if((x >= 0) && (x < width) && (y >= 0) && (y < height))
+                            {
+                                dataVals.push_back(thermVals[clumpPxls[p]]);
+                            }
+                        }
+                        if(dataVals.empty())
+                        {
+                            cloudBase[i] = minBT[i];
+                        }
+                        else
+                        {
+                            std::sort(dataVals.begin(), dataVals.end());
+                            cloudBase[i] = gsl_stats_quantile_from_sorted_data(dataVals.data(), 1, dataVals.size(), percentile);
+                        }
+                    }
+                    else
+                    {
+                        cloudBase[i] = minBT[i];
+                    }
+                }
+            });
+            pbar.finish();
+            
+            cloudBase[0] = 0.0;
+            for(size_t i = 1; i < numcloudsRATHistoRows; ++i)
+            {
                 cloudBase[i] = cloudBase[i]/scaleFactor;
                 minBT[i] = minBT[i]/scaleFactor;
                 maxBT[i] = maxBT[i]/scaleFactor;
@@ -881,7 +965,6 @@ namespace rsgis{namespace calib{
             calcInitHeights.calcImage(datasets, 1, 1, initCloudHeights);
             delete[] datasets;
             
-            delete env;
             delete[] cloudBase;
             delete[] hBaseMin;
             delete[] hBaseMax;
@@ -961,10 +1044,32 @@ namespace rsgis{namespace calib{
     }
     
     
-    void RSGISCalcCloudParams::projFitCloudShadow(GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, GDALDataset *potentCloudShadowRegions, GDALDataset *cloudShadowTestRegionsDS, GDALDataset *cloudShadowRegionsDS, double sunAz, double sunZen, double senAz, double senZen)
+    void RSGISCalcCloudParams::projFitCloudShadow(GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, GDALDataset *potentCloudShadowRegions, GDALDataset *cloudShadowTestRegionsDS, GDALDataset *cloudShadowRegionsDS, double sunAz, double sunZen, double senAz, double senZen, unsigned int numThreads)
     {
         try
         {
+            if(numThreads == 0)
+            {
+                numThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+            }
+
+            double trans[6];
+            cloudClumpsDS->GetGeoTransform(trans);
+            int nXPxl = cloudClumpsDS->GetRasterXSize();
+            int nYPxl = cloudClumpsDS->GetRasterYSize();
+            GDALDataset *gridDatasets[4] = {initCloudHeights, potentCloudShadowRegions, cloudShadowTestRegionsDS, cloudShadowRegionsDS};
+            for(int n = 0; n < 4; ++n)
+            {
+                if(!this->onSameGrid(gridDatasets[n], trans, nXPxl, nYPxl))
+                {
+                    throw rsgis::img::RSGISImageCalcException("The cloud clumps, cloud heights, potential cloud shadows and cloud shadow images must be on the same pixel grid.");
+                }
+            }
+            if(initCloudHeights->GetRasterCount() < 2)
+            {
+                throw rsgis::img::RSGISImageCalcException("Specified value band is not in the image.");
+            }
+
             rsgis::rastergis::RSGISRasterAttUtils attUtils;
             GDALRasterAttributeTable *cloudsRAT = cloudClumpsDS->GetRasterBand(1)->GetDefaultRAT();
             size_t numClumps = 0;
@@ -976,103 +1081,288 @@ namespace rsgis{namespace calib{
             double *cloudBase = attUtils.readDoubleColumn(cloudsRAT, "CloudBase", &numClumps);
             double *hBaseMin = attUtils.readDoubleColumn(cloudsRAT, "hBaseMin", &numClumps);
             double *hBaseMax = attUtils.readDoubleColumn(cloudsRAT, "hBaseMax", &numClumps);
-            
-            RSGISEditCloudShadowImg editShadImg = RSGISEditCloudShadowImg(cloudShadowTestRegionsDS, 1);
-            RSGISEditCloudShadowImg editFinalShadImg = RSGISEditCloudShadowImg(cloudShadowRegionsDS, 1);
-            editFinalShadImg.reset();
-            rsgis::img::RSGISExtractPxlsAsPts getPxPts;
-            OGREnvelope *env = new OGREnvelope();
-            double baseHeight = 0.0;
-            double pxlX = 0.0;
-            double pxlY = 0.0;
-            double cloudHgt = 0.0;
-            double d = 0.0;
-            double xDash = 0.0;
-            double yDash = 0.0;
-            bool pxlOn = false;
-            bool first = true;
-            double maxH = 0.0;
-            double maxProp = 0.0;
-            unsigned long maxOverlap = 0;
-            double cloudPropOverlap = 0.0;
-            unsigned long numPxlOverlap = 0;
-            bool calcdShadProp = true;
-            double *bestFitBaseLine = new double[numClumps];
-            bestFitBaseLine[0] = 0.0;
-            
-            std::cout << "Iteratively finding optimal cloud height. This step may take a while; there are " << numClumps << " clumps\n";
-            rsgis_tqdm pbar;
-            for(size_t i = 1; i < numClumps; ++i)
+
+            // Read the clumps, the cloud heights and the potential shadows into memory.
+            size_t nPxls = ((size_t)nXPxl) * nYPxl;
+            std::vector<unsigned int> clumpVals(nPxls);
+            std::vector<float> cloudHgtVals(nPxls);
+            std::vector<unsigned char> potentVals(nPxls);
+            std::vector<unsigned int> rowVals(nXPxl);
+            for(int y = 0; y < nYPxl; ++y)
+            {
+                size_t rowOff = ((size_t)y) * nXPxl;
+                if(cloudClumpsDS->GetRasterBand(1)->RasterIO(GF_Read, 0, y, nXPxl, 1, &clumpVals[rowOff], nXPxl, 1, GDT_UInt32, 0, 0) != CE_None)
+                {
+                    throw rsgis::img::RSGISImageCalcException("Could not read the cloud clumps image.");
+                }
+                if(initCloudHeights->GetRasterBand(2)->RasterIO(GF_Read, 0, y, nXPxl, 1, &cloudHgtVals[rowOff], nXPxl, 1, GDT_Float32, 0, 0) != CE_None)
+                {
+                    throw rsgis::img::RSGISImageCalcException("Could not read the cloud heights image.");
+                }
+                if(potentCloudShadowRegions->GetRasterBand(1)->RasterIO(GF_Read, 0, y, nXPxl, 1, rowVals.data(), nXPxl, 1, GDT_UInt32, 0, 0) != CE_None)
+                {
+                    throw rsgis::img::RSGISImageCalcException("Could not read the potential cloud shadows image.");
+                }
+                for(int x = 0; x < nXPxl; ++x)
+                {
+                    potentVals[rowOff+x] = (rowVals[x] == 1);
+                }
+            }
+
+            // The pixels of each clump, in image order.
+            std::vector<size_t> clumpPxlStart;
+            std::vector<size_t> clumpPxls;
+            this->getClumpPxls(clumpVals, numClumps, &clumpPxlStart, &clumpPxls);
+
+            double tlX = trans[0];
+            double tlY = trans[3];
+            double xRes = trans[1];
+            double yRes = trans[5];
+            if(yRes < 0)
             {
-                pbar.progress(i, numClumps);
-                
-                std::vector<std::pair<std::pair<double,double>,double> > *pxPts = new std::vector<std::pair<std::pair<double,double>,double> >();
-                pxPts->reserve(cloudsRATHisto[i]);
-                env->MinX = minX[i];
-                env->MaxX = maxX[i];
-                env->MinY = minY[i];
-                env->MaxY = maxY[i];
-                getPxPts.exportPixelsAsPointsWithVal(cloudClumpsDS, (float)i, initCloudHeights, 2, pxPts, true, env);
-                
-                
-                first = true;
-                for(baseHeight=hBaseMin[i]; baseHeight < hBaseMax[i]; baseHeight+=0.25)
+                yRes = yRes * (-1);
+            }
+            double brX = tlX + (nXPxl * xRes);
+            double brY = tlY - (nYPxl * yRes);
+
+            // Get the pixel centres and cloud heights of a clump within the extent of the
+            // clump in the RAT, as RSGISExtractPxlsAsPts::exportPixelsAsPointsWithVal.
+            auto getClumpPts = [&](size_t i, std::vector<std::pair<std::pair<double,double>,double> > *pxPts, std::vector<double> *winXVals, std::vector<double> *winYVals)
+            {
+                pxPts->clear();
+                OGREnvelope env;
+                env.MinX = minX[i];
+                env.MaxX = maxX[i];
+                env.MinY = minY[i];
+                env.MaxY = maxY[i];
+                int xOff = 0;
+                int yOff = 0;
+                int width = 0;
+                int height = 0;
+                double pxlTLX = 0.0;
+                double pxlTLY = 0.0;
+                this->getEnvelopeWindow(env, trans, nXPxl, nYPxl, &xOff, &yOff, &width, &height, &pxlTLX, &pxlTLY);
+
+                // The pixel coordinates are accumulated along the window as RSGISCalcImage::calcImageExtent.
+                winXVals->resize(std::max(width, 0));
+                for(int x = 0; x < width; ++x)
+                {
+                    double pxlMinX = pxlTLX;
+                    double pxlMaxX = pxlTLX + xRes;
+                    (*winXVals)[x] = pxlMinX + (pxlMaxX - pxlMinX)/2;
+                    pxlTLX += xRes;
+                }
+                winYVals->resize(std::max(height, 0));
+                for(int y = 0; y < height; ++y)
+                {
+                    double pxlMinY = pxlTLY - yRes;
+                    double pxlMaxY = pxlTLY;
+                    (*winYVals)[y] = pxlMinY + (pxlMaxY - pxlMinY)/2;
+                    pxlTLY -= yRes;
+                }
+
+                pxPts->reserve(clumpPxlStart[i+1] - clumpPxlStart[i]);
+                for(size_t p = clumpPxlStart[i]; p < clumpPxlStart[i+1]; ++p)
                 {
-                    editShadImg.reset();
-                    for(std::vector<std::pair<std::pair<double,double>,double> >::iterator iterPts = pxPts->begin(); iterPts != pxPts->end(); ++iterPts)
+                    long x = ((long)(clumpPxls[p] % nXPxl)) - xOff;
+                    long y = ((long)(clumpPxls[p] / nXPxl)) - yOff;
+                    if((x >= 0) && (x < width) && (y >= 0) && (y < height))
                     {
-                        pxlX = (*iterPts).first.first;
-                        pxlY = (*iterPts).first.second;
-                        cloudHgt = (baseHeight+(*iterPts).second) * 1000; // Convert to metres.
-                        
-                        // calculation taken from python-fmask
-                        d = cloudHgt * tan(sunZen);
-                        
-                        // (x', y') are coordinates of each voxel projected onto the plane of the cloud base,
-                        // for every voxel in the solid cloud
-                        xDash = pxlX - d * sin(sunAz);
-                        yDash = pxlY - d * cos(sunAz);
-                        pxlOn = editShadImg.turnOnPxl(xDash, yDash);
+                        pxPts->push_back(std::pair<std::pair<double,double>,double>(std::pair<double,double>((*winXVals)[x], (*winYVals)[y]), cloudHgtVals[clumpPxls[p]]));
+                    }
+                }
+            };
+
+            // Project the cloud pixels onto the ground for a base height, returning the
+            // image pixels which are turned on and the extent of the projected points.
+            auto projectClumpPts = [&](std::vector<std::pair<std::pair<double,double>,double> > *pxPts, double baseHeight, std::vector<size_t> *onPxls, OGREnvelope *extent)
+            {
+                onPxls->clear();
+                extent->MinX = 0;
+                extent->MaxX = 0;
+                extent->MinY = 0;
+                extent->MaxY = 0;
+                bool firstPts = true;
+                for(std::vector<std::pair<std::pair<double,double>,double> >::iterator iterPts = pxPts->begin(); iterPts != pxPts->end(); ++iterPts)
+                {
+                    double pxlX = (*iterPts).first.first;
+                    double pxlY = (*iterPts).first.second;
+                    double cloudHgt = (baseHeight+(*iterPts).second) * 1000; // Convert to metres.
+
+                    // calculation taken from python-fmask
+                    double d = cloudHgt * tan(sunZen);
+
+                    // (x', y') are coordinates of each voxel projected onto the plane of the cloud base,
+                    // for every voxel in the solid cloud
+                    double xDash = pxlX - d * sin(sunAz);
+                    double yDash = pxlY - d * cos(sunAz);
+
+                    if((xDash < tlX) | (xDash > brX) | (yDash > tlY) | (yDash < brY))
+                    {
+                        continue;
                     }
-                    // Calculate shadow fit.
-                    calcdShadProp = editShadImg.calcCorrelation(cloudClumpsDS, potentCloudShadowRegions, cloudShadowTestRegionsDS, &cloudPropOverlap, &numPxlOverlap);
-                    if(calcdShadProp)
+                    long xPxlLoc = floor(((xDash - tlX) / xRes) + 0.5);
+                    long yPxlLoc = floor(((tlY - yDash) / yRes) + 0.5);
+                    if( (xPxlLoc >= 0) & (xPxlLoc < nXPxl) & (yPxlLoc >= 0) & (yPxlLoc < nYPxl) )
                     {
-                        if(first)
+                        onPxls->push_back((((size_t)yPxlLoc) * nXPxl) + xPxlLoc);
+                        if(firstPts)
                         {
-                            maxH = baseHeight;
-                            maxProp = cloudPropOverlap;
-                            maxOverlap = numPxlOverlap;
-                            first = false;
+                            extent->MinX = xDash;
+                            extent->MaxX = xDash;
+                            extent->MinY = yDash;
+                            extent->MaxY = yDash;
+                            firstPts = false;
                         }
-                        else if(cloudPropOverlap > maxProp)
+                        else
                         {
-                            maxH = baseHeight;
-                            maxProp = cloudPropOverlap;
-                            maxOverlap = numPxlOverlap;
+                            extent->Merge(xDash, yDash);
                         }
                     }
-                    else
+                }
+            };
+
+            std::vector<double> bestFitBaseLine(numClumps, 0.0);
+            // Clumps without any base heights to test take the height of the previous clump.
+            std::vector<unsigned char> fittedClumps(numClumps, 0);
+
+            std::cout << "Iteratively finding optimal cloud height. This step may take a while; there are " << numClumps << " clumps\n";
+            rsgis::RSGISThreadPool threadPool(numThreads);
+            unsigned int nThreads = threadPool.getNumThreads();
+            std::vector<std::vector<std::pair<std::pair<double,double>,double> > > threadPxPts(nThreads);
+            std::vector<std::vector<size_t> > threadOnPxls(nThreads);
+            std::vector<std::vector<double> > threadWinXVals(nThreads);
+            std::vector<std::vector<double> > threadWinYVals(nThreads);
+            rsgis_tqdm pbar;
+            // The clumps are interleaved between the threads as their sizes vary.
+            threadPool.parallelFor(0, nThreads, [&](unsigned int threadIdx, size_t tStart, size_t tEnd)
+            {
+                std::vector<std::pair<std::pair<double,double>,double> > *pxPts = &threadPxPts[threadIdx];
+                std::vector<size_t> *onPxls = &threadOnPxls[threadIdx];
+                OGREnvelope extent;
+                for(size_t i = 1 + tStart; i < numClumps; i += nThreads)
+                {
+                    if(threadIdx == 0)
                     {
-                        if(first)
+                        pbar.progress(i, numClumps);
+                    }
+
+                    getClumpPts(i, pxPts, &threadWinXVals[threadIdx], &threadWinYVals[threadIdx]);
+
+                    fittedClumps[i] = (hBaseMin[i] < hBaseMax[i]);
+                    bool first = true;
+                    double maxH = 0.0;
+                    double maxProp = 0.0;
+                    for(double baseHeight=hBaseMin[i]; baseHeight < hBaseMax[i]; baseHeight+=0.25)
+                    {
+                        projectClumpPts(pxPts, baseHeight, onPxls, &extent);
+
+                        // Calculate shadow fit (see RSGISEditCloudShadowImg::calcCorrelation).
+                        bool insideimg = true;
+                        if((extent.MinX < tlX) | (extent.MinX > brX))
                         {
-                            maxH = baseHeight;
-                            maxProp = 0.0;
-                            maxOverlap = 0.0;
+                            insideimg = false;
+                        }
+                        else if((extent.MaxX < tlX) | (extent.MaxX > brX))
+                        {
+                            insideimg = false;
+                        }
+                        else if((extent.MinY < brY) | (extent.MinY > tlY))
+                        {
+                            insideimg = false;
+                        }
+                        else if((extent.MaxY < brY) | (extent.MaxY > tlY))
+                        {
+                            insideimg = false;
+                        }
+                        else if((extent.MaxX - extent.MinX) < (xRes*2))
+                        {
+                            insideimg = false;
+                        }
+                        else if((extent.MaxY - extent.MinY) < (yRes*2))
+                        {
+                            insideimg = false;
+                        }
+
+                        double cloudPropOverlap = 0.0;
+                        if(insideimg)
+                        {
+                            int xOff = 0;
+                            int yOff = 0;
+                            int width = 0;
+                            int height = 0;
+                            double winTLX = 0.0;
+                            double winTLY = 0.0;
+                            this->getEnvelopeWindow(extent, trans, nXPxl, nYPxl, &xOff, &yOff, &width, &height, &winTLX, &winTLY);
+
+                            std::sort(onPxls->begin(), onPxls->end());
+                            onPxls->erase(std::unique(onPxls->begin(), onPxls->end()), onPxls->end());
+                            unsigned long nShadPxlsVal = 0;
+                            unsigned long numPxlOverlap = 0;
+                            for(std::vector<size_t>::iterator iterPxls = onPxls->begin(); iterPxls != onPxls->end(); ++iterPxls)
+                            {
+                                long x = ((long)((*iterPxls) % nXPxl)) - xOff;
+                                long y = ((long)((*iterPxls) / nXPxl)) - yOff;
+                                if((x >= 0) && (x < width) && (y >= 0) && (y < height) && (clumpVals[*iterPxls] == 0))
+                                {
+                                    ++nShadPxlsVal;
+                                    if(potentVals[*iterPxls])
+                                    {
+                                        ++numPxlOverlap;
+                                    }
+                                }
+                            }
+
+                            if(nShadPxlsVal == 0)
+                            {
+                                insideimg = false;
+                            }
+                            else
+                            {
+                                cloudPropOverlap = ((double)numPxlOverlap)/((double)nShadPxlsVal);
+                            }
+                        }
+
+                        if(insideimg)
+                        {
+                            if(first)
+                            {
+                                maxH = baseHeight;
+                                maxProp = cloudPropOverlap;
+                                first = false;
+                            }
+                            else if(cloudPropOverlap > maxProp)
+                            {
+                                maxH = baseHeight;
+                                maxProp = cloudPropOverlap;
+                            }
+                        }
+                        else
+                        {
+                            if(first)
+                            {
+                                maxH = baseHeight;
+                                maxProp = 0.0;
+                            }
+                            break;
                         }
-                        break;
                     }
+
+                    // Shadow best fit base height is 'maxH'
+                    bestFitBaseLine[i] = maxH;
                 }
-                
-                // Shadow best fit base height is 'maxH'
-                bestFitBaseLine[i] = maxH;
-                
-                delete pxPts;
-            }
+            });
             pbar.finish();
-            attUtils.writeRealColumn(cloudsRAT, "FitBaseLine", bestFitBaseLine, numClumps);
+            for(size_t i = 1; i < numClumps; ++i)
+            {
+                if(!fittedClumps[i])
+                {
+                    bestFitBaseLine[i] = bestFitBaseLine[i-1];
+                }
+            }
+            attUtils.writeRealColumn(cloudsRAT, "FitBaseLine", bestFitBaseLine.data(), numClumps);
             rsgis::math::RSGISMathsUtils mathUtils;
-            
+
             double histMinVal = 0.0;
             double histMaxVal = 0.0;
             unsigned int histNumBins = 0;
@@ -1081,7 +1371,7 @@ namespace rsgis{namespace calib{
             bool gotHist = true;
             try
             {
-                hist = mathUtils.calcHistogram(bestFitBaseLine, numClumps, histBinWidth, &histMinVal, &histMaxVal, &histNumBins, true);
+                hist = mathUtils.calcHistogram(bestFitBaseLine.data(), numClumps, histBinWidth, &histMinVal, &histMaxVal, &histNumBins, true);
             }
             catch(rsgis::math::RSGISMathException &e)
             {
@@ -1093,7 +1383,7 @@ namespace rsgis{namespace calib{
                 double bestFitBaseLineMedian = mathUtils.calcPercentile(50, histMinVal, histBinWidth, histNumBins, hist);
                 double bestFitBaseLineUpQuat = mathUtils.calcPercentile(75, histMinVal, histBinWidth, histNumBins, hist);
                 delete [] hist;
-                
+
                 for(size_t i = 1; i < numClumps; ++i)
                 {
                     if(bestFitBaseLine[i] < bestFitBaseLineLowQuat)
@@ -1106,44 +1396,32 @@ namespace rsgis{namespace calib{
                     }
                 }
             }
-            attUtils.writeRealColumn(cloudsRAT, "FitBaseLineEdit", bestFitBaseLine, numClumps);
-            
+            attUtils.writeRealColumn(cloudsRAT, "FitBaseLineEdit", bestFitBaseLine.data(), numClumps);
+
             pbar.reset();
             std::cout << "Producing cloud shadow mask using optimal heights:\n";
             // Add Shadow with most correspondance to Final Shadow Image.
+            std::vector<unsigned char> shadowVals(nPxls, 0);
+            OGREnvelope extent;
             for(size_t i = 1; i < numClumps; ++i)
             {
                 pbar.progress(i, numClumps);
-                
-                std::vector<std::pair<std::pair<double,double>,double> > *pxPts = new std::vector<std::pair<std::pair<double,double>,double> >();
-                pxPts->reserve(cloudsRATHisto[i]);
-                env->MinX = minX[i];
-                env->MaxX = maxX[i];
-                env->MinY = minY[i];
-                env->MaxY = maxY[i];
-                getPxPts.exportPixelsAsPointsWithVal(cloudClumpsDS, (float)i, initCloudHeights, 2, pxPts, true, env);
-                
-                for(std::vector<std::pair<std::pair<double,double>,double> >::iterator iterPts = pxPts->begin(); iterPts != pxPts->end(); ++iterPts)
+                getClumpPts(i, &threadPxPts[0], &threadWinXVals[0], &threadWinYVals[0]);
+                projectClumpPts(&threadPxPts[0], bestFitBaseLine[i], &threadOnPxls[0], &extent);
+                for(std::vector<size_t>::iterator iterPxls = threadOnPxls[0].begin(); iterPxls != threadOnPxls[0].end(); ++iterPxls)
                 {
-                    pxlX = (*iterPts).first.first;
-                    pxlY = (*iterPts).first.second;
-                    cloudHgt = (bestFitBaseLine[i]+(*iterPts).second) * 1000; // Conver to metres.
-                    
-                    // calculation taken from python-fmask
-                    d = cloudHgt * tan(sunZen);
-                    
-                    // (x', y') are coordinates of each voxel projected onto the plane of the cloud base,
-                    // for every voxel in the solid cloud
-                    xDash = pxlX - d * sin(sunAz);
-                    yDash = pxlY - d * cos(sunAz);
-                    pxlOn = editFinalShadImg.turnOnPxl(xDash, yDash);
+                    shadowVals[*iterPxls] = 1;
                 }
-                
-                delete pxPts;
             }
             pbar.finish();
-            
-            delete env;
+
+            if(cloudShadowRegionsDS->GetRasterBand(1)->RasterIO(GF_Write, 0, 0, nXPxl, nYPxl, shadowVals.data(), nXPxl, nYPxl, GDT_Byte, 0, 0) != CE_None)
+            {
+                throw rsgis::img::RSGISImageCalcException("Could not write the cloud shadows image.");
+            }
+            cloudShadowTestRegionsDS->GetRasterBand(1)->Fill(0.0);
+
+            delete[] cloudsRATHisto;
             delete[] cloudBase;
             delete[] hBaseMin;
             delete[] hBaseMax;
@@ -1165,8 +1443,153 @@ namespace rsgis{namespace calib{
             throw rsgis::img::RSGISImageCalcException(e.what());
         }
     }
+
+    bool RSGISCalcCloudParams::onSameGrid(GDALDataset *dataset, const double *trans, int nXPxl, int nYPxl)
+    {
+        double dsTrans[6];
+        dataset->GetGeoTransform(dsTrans);
+        bool sameGrid = (dataset->GetRasterXSize() == nXPxl) & (dataset->GetRasterYSize() == nYPxl);
+        for(int t = 0; t < 6; ++t)
+        {
+            if(dsTrans[t] != trans[t])
+            {
+                sameGrid = false;
+            }
+        }
+        return sameGrid;
+    }
     
-    
+    void RSGISCalcCloudParams::getClumpPxls(const std::vector<unsigned int> &clumpVals, size_t numClumps, std::vector<size_t> *clumpPxlStart, std::vector<size_t> *clumpPxls)
+    {
+        size_t nPxls = clumpVals.size();
+        clumpPxlStart->assign(numClumps+1, 0);
+        for(size_t idx = 0; idx < nPxls; ++idx)
+        {
+            if((clumpVals[idx] > 0) && (clumpVals[idx] < numClumps))
+            {
+                ++(*clumpPxlStart)[clumpVals[idx]+1];
+            }
+        }
+        for(size_t i = 0; i < numClumps; ++i)
+        {
+            (*clumpPxlStart)[i+1] += (*clumpPxlStart)[i];
+        }
+        clumpPxls->resize((*clumpPxlStart)[numClumps]);
+        std::vector<size_t> clumpPxlPos(clumpPxlStart->begin(), clumpPxlStart->end()-1);
+        for(size_t idx = 0; idx < nPxls; ++idx)
+        {
+            if((clumpVals[idx] > 0) && (clumpVals[idx] < numClumps))
+            {
+                (*clumpPxls)[clumpPxlPos[clumpVals[idx]]++] = idx;
+            }
+        }
+    }
+
+    void RSGISCalcCloudParams::getEnvelopeWindow(OGREnvelope env, const double *trans, int nXPxl, int nYPxl, int *xOff, int *yOff, int *width, int *height, double *winTLX, double *winTLY)
+    {
+        double pxlXRes = trans[1];
+        double pxlYRes = std::abs(trans[5]);
+        double tlX = trans[0];
+        double tlY = trans[3];
+
+        // Snap the envelope to the image grid (see RSGISImageUtils::snap2ImageGrid).
+        unsigned int nXPxls = ceil((std::abs(tlX - env.MinX) / pxlXRes)+0.5);
+        unsigned int nYPxls = ceil((std::abs(tlY - env.MaxY) / pxlYRes)+0.5);
+        double envMinX = 0.0;
+        double envMaxY = 0.0;
+        if(tlX > env.MinX)
+        {
+            envMinX = tlX - (nXPxls * pxlXRes);
+        }
+        else
+        {
+            envMinX = tlX + (nXPxls * pxlXRes);
+        }
+        if(tlY > env.MaxY)
+        {
+            envMaxY = tlY - (nYPxls * pxlYRes);
+        }
+        else
+        {
+            envMaxY = tlY + (nYPxls * pxlYRes);
+        }
+        unsigned int envWidthPxls = ceil(((env.MaxX - env.MinX)/pxlXRes)+0.5);
+        unsigned int envHeightPxls = ceil(((env.MaxY - env.MinY)/pxlYRes)+0.5);
+        double envMaxX = envMinX + (envWidthPxls * pxlXRes);
+        double envMinY = envMaxY - (envHeightPxls * pxlYRes);
+
+        // Cut the image to the envelope (see RSGISImageUtils::getImageOverlapCut2Env).
+        double minX = tlX;
+        double maxY = tlY;
+        double maxX = minX + (nXPxl * pxlXRes);
+        double minY = maxY - (nYPxl * pxlYRes);
+        if(envMinX > minX)
+        {
+            minX = envMinX;
+        }
+        if(envMinY > minY)
+        {
+            minY = envMinY;
+        }
+        if(envMaxX < maxX)
+        {
+            maxX = envMaxX;
+        }
+        if(envMaxY < maxY)
+        {
+            maxY = envMaxY;
+        }
+        if(maxX - minX <= 0)
+        {
+            throw rsgis::img::RSGISImageBandException("Images and Envelope do not overlap in the X axis");
+        }
+        if(maxY - minY <= 0)
+        {
+            throw rsgis::img::RSGISImageBandException("Images and Envelope do not overlap in the Y axis");
+        }
+
+        *width = floor(((maxX - minX)/pxlXRes)+0.5);
+        *height = floor(((maxY - minY)/pxlYRes)+0.5);
+
+        double diffX = minX - tlX;
+        double diffY = tlY - maxY;
+        *xOff = 0;
+        if(!((diffX > -0.0001) & (diffX < 0.0001)))
+        {
+            *xOff = floor((diffX/pxlXRes)+0.5);
+        }
+        *yOff = 0;
+        if(!((diffY > -0.0001) & (diffY < 0.0001)))
+        {
+            *yOff = floor((diffY/pxlYRes)+0.5);
+        }
+
+        double tmpMinX = tlX + ((*xOff) * pxlXRes);
+        double tmpMaxY = tlY - ((*yOff) * pxlYRes);
+        double tmpMaxX = tmpMinX + ((*width)*pxlXRes);
+        double tmpMinY = tmpMaxY - ((*height)*pxlYRes);
+        if(tmpMaxX > maxX)
+        {
+            int nPxl = floor(((tmpMaxX - maxX)/pxlXRes)+0.5);
+            if(nPxl > 0)
+            {
+                (*width) = (*width) - nPxl;
+            }
+        }
+        if(tmpMinY < minY)
+        {
+            int nPxl = floor(((minY - tmpMinY)/pxlYRes)+0.5);
+            if(nPxl > 0)
+            {
+                (*height) = (*height) - nPxl;
+            }
+        }
+
+        *winTLX = minX;
+        *winTLY = maxY;
+    }
+
+
     RSGISEditCloudShadowImg::RSGISEditCloudShadowImg(GDALDataset *testImg, int band)
     {
         this->testImg = testImg;
@@ -26,18 +26,22 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <cmath>
 
 #include "gdal_priv.h"
 
 #include "common/rsgis-tqdm.h"
 #include "common/RSGISException.h"
+#include "common/RSGISThreadPool.h"
 
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcImage.h"
 #include "img/RSGISImageStatistics.h"
 #include "img/RSGISExtractImageValues.h"
+#include "img/RSGISImageBandException.h"
 
 #include "rastergis/RSGISPopRATWithStats.h"
 #include "rastergis/RSGISRasterAttUtils.h"
@@ -65,6 +69,7 @@ namespace rsgis{namespace calib{
     public:
         RSGISLandsatFMaskPass1CloudMasking(unsigned int scaleFactor, unsigned int numLSBands, double whitenessThreshold=0.7);
         void calcImageValue(float *bandValues, int numBands, double *output);
+        rsgis::img::RSGISCalcImageValue* clone(){return new RSGISLandsatFMaskPass1CloudMasking(*this);};
         ~RSGISLandsatFMaskPass1CloudMasking();
     protected:
         unsigned int scaleFactor;
@@ -104,6 +109,8 @@ namespace rsgis{namespace calib{
     public:
         RSGISLandsatFMaskExportPass1LandWaterCloudMasking();
         void calcImageValue(float *bandValues, int numBands, double *output);
+        rsgis::img::RSGISCalcImageValue* clone(){return new RSGISLandsatFMaskExportPass1LandWaterCloudMasking();};
+        void reduce(rsgis::img::RSGISCalcImageValue *other);
         double propOfPCPPixels();
         ~RSGISLandsatFMaskExportPass1LandWaterCloudMasking();
     protected:
@@ -116,6 +123,7 @@ namespace rsgis{namespace calib{
     public:
         RSGISLandsatFMaskPass2ClearSkyCloudProbCloudMasking(unsigned int scaleFactor, unsigned int numLSBands, double water82ndThres, double land82ndThres, double land17thThres);
         void calcImageValue(float *bandValues, int numBands, double *output);
+        rsgis::img::RSGISCalcImageValue* clone(){return new RSGISLandsatFMaskPass2ClearSkyCloudProbCloudMasking(*this);};
         ~RSGISLandsatFMaskPass2ClearSkyCloudProbCloudMasking();
     protected:
         unsigned int scaleFactor;
@@ -152,6 +160,7 @@ namespace rsgis{namespace calib{
     public:
         RSGISLandsatFMaskPass2CloudMasking(unsigned int scaleFactor, unsigned int numLSBands, double landCloudProbUpperThres, double waterCloudProbUpperThres, double lowerLandTempThres);
         void calcImageValue(float *bandValues, int numBands, double *output);
+        rsgis::img::RSGISCalcImageValue* clone(){return new RSGISLandsatFMaskPass2CloudMasking(*this);};
         ~RSGISLandsatFMaskPass2CloudMasking();
     protected:
         unsigned int scaleFactor;
@@ -184,6 +193,7 @@ namespace rsgis{namespace calib{
     public:
         RSGISCalcImageCloudMajorityFilter():rsgis::img::RSGISCalcImageValue(1){};
         void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+        rsgis::img::RSGISCalcImageValue* clone(){return new RSGISCalcImageCloudMajorityFilter();};
         ~RSGISCalcImageCloudMajorityFilter(){};
     };
     
@@ -193,6 +203,7 @@ namespace rsgis{namespace calib{
     public:
         RSGISCalcImagePotentialCloudShadowsMask(unsigned int scaleFactor):rsgis::img::RSGISCalcImageValue(1){this->scaleFactor = scaleFactor;};
         void calcImageValue(float *bandValues, int numBands, double *output);
+        rsgis::img::RSGISCalcImageValue* clone(){return new RSGISCalcImagePotentialCloudShadowsMask(this->scaleFactor);};
         ~RSGISCalcImagePotentialCloudShadowsMask(){};
     protected:
         unsigned int scaleFactor;
@@ -203,6 +214,7 @@ namespace rsgis{namespace calib{
     public:
         RSGISCalcImagePotentialCloudShadowsMaskSingleInput(unsigned int scaleFactor):rsgis::img::RSGISCalcImageValue(1){this->scaleFactor = scaleFactor;};
         void calcImageValue(float *bandValues, int numBands, double *output);
+        rsgis::img::RSGISCalcImageValue* clone(){return new RSGISCalcImagePotentialCloudShadowsMaskSingleInput(this->scaleFactor);};
         ~RSGISCalcImagePotentialCloudShadowsMaskSingleInput(){};
     protected:
         unsigned int scaleFactor;
@@ -212,10 +224,32 @@ namespace rsgis{namespace calib{
     {
     public:
         RSGISCalcCloudParams(){};
-        void calcCloudHeights(GDALDataset *thermal, GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, double lowerLandThres, double upperLandThres, float scaleFactor);
+        /**
+         * Calculate the cloud base of each cloud clump from the thermal image and
+         * produce the initial cloud heights. The clumps and thermal band are held
+         * in memory and the cloud bases of the clumps are calculated in parallel
+         * (numThreads; 0 uses all the hardware threads). The images must be on the
+         * same pixel grid.
+         */
+        void calcCloudHeights(GDALDataset *thermal, GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, double lowerLandThres, double upperLandThres, float scaleFactor, unsigned int numThreads=1);
         void calcCloudHeightsNoThermal(GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeightsDS);
-        void projFitCloudShadow(GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, GDALDataset *potentCloudShadowRegions, GDALDataset *cloudShadowTestRegionsDS, GDALDataset *cloudShadowRegionsDS, double sunAz, double sunZen, double senAz, double senZen);
+        /**
+         * Fit the height of each cloud clump to the potential cloud shadows and
+         * produce the cloud shadow mask. The clumps, heights and potential shadows
+         * are held in memory and the clumps are fitted in parallel (numThreads;
+         * 0 uses all the hardware threads). The images must be on the same pixel
+         * grid. cloudShadowTestRegionsDS is no longer used for the tests and is
+         * filled with 0.
+         */
+        void projFitCloudShadow(GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, GDALDataset *potentCloudShadowRegions, GDALDataset *cloudShadowTestRegionsDS, GDALDataset *cloudShadowRegionsDS, double sunAz, double sunZen, double senAz, double senZen, unsigned int numThreads=1);
         ~RSGISCalcCloudParams(){};
+    protected:
+        /** Whether the dataset has the geotransform and size of the image grid. */
+        bool onSameGrid(GDALDataset *dataset, const double *trans, int nXPxl, int nYPxl);
+        /** The pixels of each clump in image order, where the pixels of clump i are clumpPxls[clumpPxlStart[i]] to clumpPxls[clumpPxlStart[i+1]-1]. */
+        void getClumpPxls(const std::vector<unsigned int> &clumpVals, size_t numClumps, std::vector<size_t> *clumpPxlStart, std::vector<size_t> *clumpPxls);
+        /** The pixel window (and its top left corner) read by RSGISCalcImage for an envelope, i.e., snapped to the grid and cut to the image. */
+        void getEnvelopeWindow(OGREnvelope env, const double *trans, int nXPxl, int nYPxl, int *xOff, int *yOff, int *width, int *height, double *winTLX, double *winTLY);
     };
     
     class DllExport RSGISCalcCloudShadowCorrespondance : public rsgis::img::RSGISCalcImageValue
@@ -0,0 +1,348 @@
+/*
+ *  RSGISDEMRoughness.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISDEMRoughness.h"
+
+namespace rsgis{namespace calib{
+
+    RSGISCalcDEMRoughness::RSGISCalcDEMRoughness(RSGISRoughnessMetrics metrics, double xRes, double yRes, bool detrend, bool useNoData, double noDataVal, double outNoDataVal) : rsgis::img::RSGISCalcImageValue(RSGISCalcDEMRoughness::getMetricBandNames(metrics).size())
+    {
+        this->metrics = metrics;
+        this->xRes = std::fabs(xRes);
+        this->yRes = std::fabs(yRes);
+        this->detrend = detrend;
+        this->useNoData = useNoData;
+        this->noDataVal = noDataVal;
+        this->outNoDataVal = outNoDataVal;
+    }
+
+    std::vector<std::string> RSGISCalcDEMRoughness::getMetricBandNames(RSGISRoughnessMetrics metrics)
+    {
+        std::vector<std::string> bandNames;
+        if(metrics == rsgis_rough_profile)
+        {
+            std::vector<std::string> metricNames = {"ra", "rr", "rq", "MIF", "rv", "rp", "rz", "rsk", "rku"};
+            for(auto &metricName : metricNames)
+            {
+                bandNames.push_back("x_" + metricName);
+                bandNames.push_back("y_" + metricName);
+                bandNames.push_back("avg_" + metricName);
+            }
+        }
+        else if(metrics == rsgis_rough_munro)
+        {
+            bandNames = {"x_munro_peaks", "x_munro_area", "x_munro_density", "x_munro_z0", "y_munro_peaks", "y_munro_area", "y_munro_density", "y_munro_z0", "avg_munro_z0"};
+        }
+        else if(metrics == rsgis_rough_smith)
+        {
+            bandNames = {"smith_hs", "xe_smith_frt", "xe_smith_z0", "xw_smith_frt", "xw_smith_z0", "x_avg_smith_z0", "yn_smith_frt", "yn_smith_z0", "ys_smith_frt", "ys_smith_z0", "y_avg_smith_z0", "avg_smith_z0"};
+        }
+        else
+        {
+            throw rsgis::img::RSGISImageCalcException("The roughness metrics were not recognised.");
+        }
+        return bandNames;
+    }
+
+    void RSGISCalcDEMRoughness::calcImageValue(float ***dataBlock, int numBands, int winSize, double *output)
+    {
+        // Copy the window of the first band so it can be processed as a view.
+        this->winBuffer.resize(((size_t)winSize) * winSize);
+        for(int i = 0; i < winSize; ++i)
+        {
+            for(int j = 0; j < winSize; ++j)
+            {
+                this->winBuffer[(((size_t)i) * winSize) + j] = dataBlock[0][i][j];
+            }
+        }
+        this->calcWindowMetrics(this->winBuffer.data(), winSize, winSize, output);
+    }
+
+    bool RSGISCalcDEMRoughness::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+    {
+        this->calcWindowMetrics(winData[0], stride, winSize, output);
+        return true;
+    }
+
+    rsgis::img::RSGISCalcImageValue* RSGISCalcDEMRoughness::clone()
+    {
+        return new RSGISCalcDEMRoughness(this->metrics, this->xRes, this->yRes, this->detrend, this->useNoData, this->noDataVal, this->outNoDataVal);
+    }
+
+    void RSGISCalcDEMRoughness::calcWindowMetrics(const float *winVals, size_t stride, int winSize, double *output)
+    {
+        int winMid = winSize / 2;
+        bool valid = true;
+        if(this->metrics == rsgis_rough_smith)
+        {
+            valid = this->calcSmithMetrics(winVals, stride, winSize, output);
+        }
+        else
+        {
+            this->xResids.resize(winSize);
+            this->yResids.resize(winSize);
+            // The x profile is the centre row and the y profile the centre column of the window.
+            valid = this->getProfileResiduals(&winVals[winMid * stride], 1, winSize, this->xResids.data());
+            valid = valid && this->getProfileResiduals(&winVals[winMid], stride, winSize, this->yResids.data());
+            if(valid && (this->metrics == rsgis_rough_profile))
+            {
+                double xMetrics[9];
+                double yMetrics[9];
+                this->calcProfileMetrics(this->xResids.data(), winSize, xMetrics);
+                this->calcProfileMetrics(this->yResids.data(), winSize, yMetrics);
+                for(int m = 0; m < 9; ++m)
+                {
+                    output[(m * 3)] = xMetrics[m];
+                    output[(m * 3) + 1] = yMetrics[m];
+                    output[(m * 3) + 2] = (xMetrics[m] + yMetrics[m]) / 2.0;
+                }
+            }
+            else if(valid)
+            {
+                this->calcMunroMetrics(this->xResids.data(), winSize, this->xRes, &output[0]);
+                this->calcMunroMetrics(this->yResids.data(), winSize, this->yRes, &output[4]);
+                output[8] = (output[3] + output[7]) / 2.0;
+            }
+        }
+
+        if(!valid)
+        {
+            for(int n = 0; n < this->numOutBands; ++n)
+            {
+                output[n] = this->outNoDataVal;
+            }
+        }
+    }
+
+    bool RSGISCalcDEMRoughness::getProfileResiduals(const float *vals, size_t step, int n, double *resids)
+    {
+        // Fit z = c + a(i - mid) where mid is the centre of the profile, so the
+        // offsets sum to 0 and the intercept is the mean of the profile.
+        double mid = ((double)(n - 1)) / 2.0;
+        double sumZ = 0.0;
+        double sumOffZ = 0.0;
+        double sumOffSq = 0.0;
+        for(int i = 0; i < n; ++i)
+        {
+            float val = vals[i * step];
+            if(!this->isValid(val))
+            {
+                return false;
+            }
+            double off = i - mid;
+            sumZ += val;
+            sumOffZ += off * val;
+            sumOffSq += off * off;
+        }
+        double mean = sumZ / n;
+        double slope = 0.0;
+        if(this->detrend && (sumOffSq > 0))
+        {
+            slope = sumOffZ / sumOffSq;
+        }
+
+        for(int i = 0; i < n; ++i)
+        {
+            resids[i] = vals[i * step] - mean - (slope * (i - mid));
+        }
+        return true;
+    }
+
+    void RSGISCalcDEMRoughness::calcProfileMetrics(const double *resids, int n, double *output)
+    {
+        // The residuals have a mean of 0 so the moments are about 0.
+        double sumAbs = 0.0;
+        double sumSq = 0.0;
+        double sumCube = 0.0;
+        double sumQuad = 0.0;
+        double sumAbsDiff = 0.0;
+        double nMIF = 0.0;
+        double minVal = resids[0];
+        double maxVal = resids[0];
+        for(int i = 0; i < n; ++i)
+        {
+            double val = resids[i];
+            double valSq = val * val;
+            sumAbs += std::fabs(val);
+            sumSq += valSq;
+            sumCube += valSq * val;
+            sumQuad += valSq * valSq;
+            if(val < minVal)
+            {
+                minVal = val;
+            }
+            if(val > maxVal)
+            {
+                maxVal = val;
+            }
+            if(i > 0)
+            {
+                sumAbsDiff += std::fabs(val - resids[i-1]);
+            }
+            if((i < (n - 2)) && ((resids[i+1] - val) > 0) && ((resids[i+2] - val) > 0))
+            {
+                nMIF = nMIF + 1;
+            }
+        }
+
+        double m2 = sumSq / n;
+        output[0] = sumAbs / n;
+        output[1] = std::sqrt(m2);
+        output[2] = sumAbsDiff;
+        output[3] = nMIF;
+        output[4] = minVal;
+        output[5] = maxVal;
+        output[6] = maxVal - minVal;
+        if(m2 > 0)
+        {
+            // Biased skewness and (Fisher) kurtosis, as scipy.stats.
+            output[7] = (sumCube / n) / std::pow(m2, 1.5);
+            output[8] = ((sumQuad / n) / (m2 * m2)) - 3.0;
+        }
+        else
+        {
+            output[7] = 0.0;
+            output[8] = 0.0;
+        }
+    }
+
+    void RSGISCalcDEMRoughness::calcMunroMetrics(const double *resids, int n, double res, double *output)
+    {
+        double sumSq = 0.0;
+        double nPosCross = 0.0;
+        double nNegCross = 0.0;
+        for(int i = 0; i < n; ++i)
+        {
+            sumSq += resids[i] * resids[i];
+            if((i > 0) && (i < (n - 1)) && (resids[i] > 0))
+            {
+                if(resids[i-1] < 0)
+                {
+                    nPosCross = nPosCross + 1;
+                }
+                if(resids[i+1] < 0)
+                {
+                    nNegCross = nNegCross + 1;
+                }
+            }
+        }
+        double nPeaks = std::max(nPosCross, nNegCross);
+        double profileLen = res * n;
+        // h* is an effective height for the roughness elements (Munro 1989)
+        double hStar = 2.0 * std::sqrt(sumSq / n);
+
+        output[0] = nPeaks;
+        output[1] = 0.0;
+        output[2] = 0.0;
+        output[3] = 0.0;
+        if(nPeaks > 0)
+        {
+            // s is the silhouette area and S the density of the roughness elements
+            double littleS = (hStar * profileLen) / (2.0 * nPeaks);
+            double bigS = (profileLen / nPeaks) * (profileLen / nPeaks);
+            output[1] = littleS;
+            output[2] = bigS;
+            output[3] = 0.5 * hStar * (littleS / bigS);
+        }
+    }
+
+    bool RSGISCalcDEMRoughness::calcSmithMetrics(const float *winVals, size_t stride, int winSize, double *output)
+    {
+        // Fit the plane z = c + a(x - mid) + b(y - mid) where the offsets are
+        // orthogonal on the regular grid so the coefficients are independent.
+        double mid = ((double)(winSize - 1)) / 2.0;
+        double n = ((double)winSize) * winSize;
+        double sumZ = 0.0;
+        double sumXZ = 0.0;
+        double sumYZ = 0.0;
+        double sumOffSq = 0.0;
+        for(int i = 0; i < winSize; ++i)
+        {
+            sumOffSq += (i - mid) * (i - mid);
+            const float *row = &winVals[i * stride];
+            for(int j = 0; j < winSize; ++j)
+            {
+                if(!this->isValid(row[j]))
+                {
+                    return false;
+                }
+                sumZ += row[j];
+                sumXZ += (j - mid) * row[j];
+                sumYZ += (i - mid) * row[j];
+            }
+        }
+        double mean = sumZ / n;
+        double a = 0.0;
+        double b = 0.0;
+        if(this->detrend)
+        {
+            // sum over the window of (x - mid)^2 is winSize * sumOffSq
+            a = sumXZ / (winSize * sumOffSq);
+            b = sumYZ / (winSize * sumOffSq);
+        }
+
+        // The frontal areas are from the positive differences between each pixel
+        // not on the window edge and its neighbours, where the plane adds a
+        // constant to the differences of the residuals.
+        double sumSq = 0.0;
+        double sumEast = 0.0;
+        double sumWest = 0.0;
+        double sumNorth = 0.0;
+        double sumSouth = 0.0;
+        for(int i = 0; i < winSize; ++i)
+        {
+            const float *row = &winVals[i * stride];
+            for(int j = 0; j < winSize; ++j)
+            {
+                double resid = row[j] - mean - (a * (j - mid)) - (b * (i - mid));
+                sumSq += resid * resid;
+                if((i > 0) && (i < (winSize - 1)) && (j > 0) && (j < (winSize - 1)))
+                {
+                    sumEast += std::max(0.0, (((double)row[j]) - row[j+1]) + a);
+                    sumWest += std::max(0.0, (((double)row[j]) - row[j-1]) - a);
+                    sumNorth += std::max(0.0, (((double)row[j]) - row[j-stride]) - b);
+                    sumSouth += std::max(0.0, (((double)row[j]) - row[j+stride]) + b);
+                }
+            }
+        }
+
+        double hStar = 2.0 * std::sqrt(sumSq / n);
+        double grdArea = (this->xRes * winSize) * (this->yRes * winSize);
+        double z0Scale = 0.5 * hStar / grdArea;
+        output[0] = hStar;
+        output[1] = sumEast * this->xRes;
+        output[2] = z0Scale * output[1];
+        output[3] = sumWest * this->xRes;
+        output[4] = z0Scale * output[3];
+        output[5] = (output[2] + output[4]) / 2.0;
+        output[6] = sumNorth * this->yRes;
+        output[7] = z0Scale * output[6];
+        output[8] = sumSouth * this->yRes;
+        output[9] = z0Scale * output[8];
+        output[10] = (output[7] + output[9]) / 2.0;
+        output[11] = (output[2] + output[4] + output[7] + output[9]) / 4.0;
+        return true;
+    }
+
+}}
+
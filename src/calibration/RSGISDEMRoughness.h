@@ -0,0 +1,110 @@
+/*
+ *  RSGISDEMRoughness.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISDEMRoughness_h
+#define RSGISDEMRoughness_h
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISCalcImageValue.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_calib_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace calib{
+
+    enum RSGISRoughnessMetrics
+    {
+        /// The surface roughness metrics of the x and y profiles (RA, RR, RQ, MIF, RV, RP, RZ, RSK and RKU).
+        rsgis_rough_profile = 0,
+        /// The Munro (1989) roughness length (z0) of the x and y profiles.
+        rsgis_rough_munro = 1,
+        /// The Smith et al. (2016) roughness length (z0) of the window surface.
+        rsgis_rough_smith = 2
+    };
+
+    /**
+     * Calculates the roughness metrics of the window around each pixel of a DEM,
+     * giving the values calculated for a sample window by the CalcProfileRoughMetrics,
+     * CalcMunroRoughnessMetric and CalcSmithRoughnessMetric classes of the python
+     * rsgislib.elevation.roughness module, so a roughness layer can be produced for
+     * the whole DEM. The profiles are the row and column through the centre of the
+     * window. If detrend is true the profiles are detrended with a linear fit
+     * (i.e., the python detrend_poly_order of 1) and the surface with a plane fit.
+     * As the pixel spacing is regular the fits are calculated from the sums of the
+     * window values so only a single pass over the window values is needed to fit
+     * and a second to sum the metrics of the residuals.
+     *
+     * If any of the window values used by the metrics is not finite or is the no
+     * data value (where useNoData is true) all the outputs are outNoDataVal. Where
+     * the variance of a profile is 0 the skewness and kurtosis are 0 and where a
+     * profile has no peaks the Munro area, density and z0 are 0. The windows are
+     * passed as views of the image data (see calcImageWindowView) and the class can
+     * be cloned, so RSGISCalcImage::calcImageWindowData runs it on multiple threads.
+     */
+    class DllExport RSGISCalcDEMRoughness : public rsgis::img::RSGISCalcImageValue
+    {
+    public:
+        RSGISCalcDEMRoughness(RSGISRoughnessMetrics metrics, double xRes, double yRes, bool detrend, bool useNoData=false, double noDataVal=0, double outNoDataVal=-9999);
+        void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+        bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+        rsgis::img::RSGISCalcImageValue* clone();
+        /** The names of the output bands for a set of metrics (as the python column names). */
+        static std::vector<std::string> getMetricBandNames(RSGISRoughnessMetrics metrics);
+        ~RSGISCalcDEMRoughness(){};
+    protected:
+        void calcWindowMetrics(const float *winVals, size_t stride, int winSize, double *output);
+        bool getProfileResiduals(const float *vals, size_t step, int n, double *resids);
+        void calcProfileMetrics(const double *resids, int n, double *output);
+        void calcMunroMetrics(const double *resids, int n, double res, double *output);
+        bool calcSmithMetrics(const float *winVals, size_t stride, int winSize, double *output);
+        bool isValid(float val){return std::isfinite(val) && !(this->useNoData && (val == this->noDataVal));};
+        RSGISRoughnessMetrics metrics;
+        double xRes;
+        double yRes;
+        bool detrend;
+        bool useNoData;
+        float noDataVal;
+        double outNoDataVal;
+        std::vector<float> winBuffer;
+        std::vector<double> xResids;
+        std::vector<double> yResids;
+    };
+
+}}
+
+#endif
@@ -727,186 +727,368 @@ namespace rsgis{namespace calib{
         {
             if( dataBlock[band][1][1] != this->noDataVal)
             {
-                bool flatGround = false;
-                bool pxlAwayFromSun = false;
+                int sunExposure = RSGISCalcShadowBinaryMask::calcLocalSunExposure(dataBlock, this->band, this->ewRes, this->nsRes, this->sunZenith, this->sunAzimuth, this->noDataVal);
+                if(sunExposure == 1)
+                {
+                    output[0] = 1;
+                }
+                else if(sunExposure == 2)
+                {
+                    // do ray tracing...
+                    // Location of active point.
+                    double x = extent.MinX + (extent.MaxX - extent.MinX)/2;
+                    double y = extent.MinY + (extent.MaxY - extent.MinY)/2;
+                    double z = dataBlock[band][1][1];
                 
-                double aspect = 0.0;
-                double slopeRad = 0.0;
                 
-                bool hasNoDataVal = false;
-                double sumVals = 0.0;
-                int nVals = 0;
-                for(int i = 0; i < winSize; ++i)
-                {
-                    for(int j = 0; j < winSize; ++j)
+                    double sunAzTrans = 360-this->sunAzimuth;
+                    sunAzTrans = sunAzTrans + 90;
+                    if(sunAzTrans > 360)
                     {
-                        if(dataBlock[band][i][j] == noDataVal)
-                        {
-                            hasNoDataVal = true;
-                        }
-                        else
-                        {
-                            sumVals += dataBlock[band][i][j];
-                            ++nVals;
-                        }
+                        sunAzTrans = sunAzTrans-360;
                     }
-                }
-                if(hasNoDataVal && (nVals>1))
-                {
-                    double meanVal = sumVals / nVals;
-                    for(int i = 0; i < winSize; ++i)
+                
+                    double sunZenRad = sunZenith * degreesToRadians;
+                    double sunAzRad = sunAzTrans * degreesToRadians;
+                
+                    // Location of the sun.
+                    //double sunX = x + (sunRange * sin(sunZenRad) * cos(sunAzRad));
+                    //double sunY = y + (sunRange * sin(sunZenRad) * sin(sunAzRad));
+                    //double sunZ = z + (sunRange * cos(sunZenRad));
+                
+                    // Create Ray Line
+                    OGRPoint *pxlPt = new OGRPoint(x, y, z);
+                    std::vector<rsgis::img::ImagePixelValuePt*> *imagePxlPts = extractPixels->getImagePixelValues(inputImage, band+1, pxlPt, sunAzRad, sunZenRad, maxElevHeight);
+                    delete pxlPt;
+                
+                    // Check whether pixel intersects with ray.
+                    for(std::vector<rsgis::img::ImagePixelValuePt*>::iterator iterPxls = imagePxlPts->begin(); iterPxls != imagePxlPts->end(); ++iterPxls)
                     {
-                        for(int j = 0; j < winSize; ++j)
+                        if((*iterPxls)->pt->getZ() < (*iterPxls)->value)
                         {
-                            if(dataBlock[band][i][j] == noDataVal)
-                            {
-                                dataBlock[band][i][j] = meanVal;
-                            }
+                            output[0] = 1;
+                            break;
                         }
                     }
-                }
                 
-                if(nVals > 1)
-                {
-                    const double radiansToDegrees = 180.0 / M_PI;
-                    
-                    double dxSlope, dySlope = 0.0;
-                    
-                    dxSlope = ((dataBlock[band][0][0] + dataBlock[band][1][0] + dataBlock[band][1][0] + dataBlock[band][2][0]) -
-                               (dataBlock[band][0][2] + dataBlock[band][1][2] + dataBlock[band][1][2] + dataBlock[band][2][2]))/ewRes;
-                    
-                    dySlope = ((dataBlock[band][2][0] + dataBlock[band][2][1] + dataBlock[band][2][1] + dataBlock[band][2][2]) -
-                               (dataBlock[band][0][0] + dataBlock[band][0][1] + dataBlock[band][0][1] + dataBlock[band][0][2]))/nsRes;
-                    
-                    slopeRad = atan(sqrt((dxSlope * dxSlope) + (dySlope * dySlope))/8);
-                    
-                    
-                    double dxAspect, dyAspect = 0.0;
-                    
-                    dxAspect = ((dataBlock[band][0][2] + dataBlock[band][1][2] + dataBlock[band][1][2] + dataBlock[band][2][2]) -
-                                (dataBlock[band][0][0] + dataBlock[band][1][0] + dataBlock[band][1][0] + dataBlock[band][2][0]))/ewRes;
-                    
-                    dyAspect = ((dataBlock[band][2][0] + dataBlock[band][2][1] + dataBlock[band][2][1] + dataBlock[band][2][2]) -
-                                (dataBlock[band][0][0] + dataBlock[band][0][1] + dataBlock[band][0][1] + dataBlock[band][0][2]))/nsRes;
-                    
-                    aspect = atan2(-dxAspect, dyAspect)*radiansToDegrees;
-                    
-                    if (dxAspect == 0 && dyAspect == 0)
-                    {
-                        // Flat area
-                        aspect = std::numeric_limits<double>::signaling_NaN();
-                        flatGround = true;
-                    }
-                    else if(aspect < 0)
+                    // Clean up memory..
+                    for(std::vector<rsgis::img::ImagePixelValuePt*>::iterator iterPxls = imagePxlPts->begin(); iterPxls != imagePxlPts->end(); )
                     {
-                        aspect += 360.0;
+                        delete (*iterPxls)->pt;
+                        delete (*iterPxls);
+                        iterPxls = imagePxlPts->erase(iterPxls);
                     }
-                    else if(aspect == 360.0)
-                    {
-                        aspect = 0.0;
-                    }
-                    else if(aspect > 360)
-                    {
-                        double num = aspect / 360.0;
-                        int num360s = floor(num);
-                        aspect = aspect - (360 * num360s);
-                    }
-                    
-                    aspect = aspect * degreesToRadians;
+                    delete imagePxlPts;
+                }
+            }
+        }
+        catch (rsgis::img::RSGISImageCalcException &e) 
+        {
+            throw e;
+        }
+    }
+
+    int RSGISCalcShadowBinaryMask::calcLocalSunExposure(float ***dataBlock, unsigned int band, float ewRes, float nsRes, float sunZenith, float sunAzimuth, double noDataVal)
+    {
+        const double degreesToRadians = M_PI / 180.0;
+        const int winSize = 3;
+        bool flatGround = false;
+        
+        double aspect = 0.0;
+        double slopeRad = 0.0;
+        
+        bool hasNoDataVal = false;
+        double sumVals = 0.0;
+        int nVals = 0;
+        for(int i = 0; i < winSize; ++i)
+        {
+            for(int j = 0; j < winSize; ++j)
+            {
+                if(dataBlock[band][i][j] == noDataVal)
+                {
+                    hasNoDataVal = true;
                 }
                 else
                 {
-                    slopeRad = 0;
-                    // No Data - call it flat ground...
-                    aspect = std::numeric_limits<double>::signaling_NaN();
-                    flatGround = true;
+                    sumVals += dataBlock[band][i][j];
+                    ++nVals;
                 }
-                
-                
-                if(!flatGround)
+            }
+        }
+        if(hasNoDataVal && (nVals>1))
+        {
+            double meanVal = sumVals / nVals;
+            for(int i = 0; i < winSize; ++i)
+            {
+                for(int j = 0; j < winSize; ++j)
                 {
-                    double sunZenRad = sunZenith * degreesToRadians;
-                    double sunAzRad = sunAzimuth * degreesToRadians;
-                    
-                    double ic = (cos(sunZenRad) * cos(slopeRad)) + (sin(sunZenRad) * sin(slopeRad) * cos((sunAzRad) - aspect));
-                    //output[0] = ic;
-                    if(ic < 0)
-                    {
-                        pxlAwayFromSun = true;
-                    }
-                    
-                    if(pxlAwayFromSun)
+                    if(dataBlock[band][i][j] == noDataVal)
                     {
-                        output[0] = 1;
+                        dataBlock[band][i][j] = meanVal;
                     }
-                    else
+                }
+            }
+        }
+        
+        if(nVals > 1)
+        {
+            const double radiansToDegrees = 180.0 / M_PI;
+            
+            double dxSlope, dySlope = 0.0;
+            
+            dxSlope = ((dataBlock[band][0][0] + dataBlock[band][1][0] + dataBlock[band][1][0] + dataBlock[band][2][0]) -
+                       (dataBlock[band][0][2] + dataBlock[band][1][2] + dataBlock[band][1][2] + dataBlock[band][2][2]))/ewRes;
+            
+            dySlope = ((dataBlock[band][2][0] + dataBlock[band][2][1] + dataBlock[band][2][1] + dataBlock[band][2][2]) -
+                       (dataBlock[band][0][0] + dataBlock[band][0][1] + dataBlock[band][0][1] + dataBlock[band][0][2]))/nsRes;
+            
+            slopeRad = atan(sqrt((dxSlope * dxSlope) + (dySlope * dySlope))/8);
+            
+            
+            double dxAspect, dyAspect = 0.0;
+            
+            dxAspect = ((dataBlock[band][0][2] + dataBlock[band][1][2] + dataBlock[band][1][2] + dataBlock[band][2][2]) -
+                        (dataBlock[band][0][0] + dataBlock[band][1][0] + dataBlock[band][1][0] + dataBlock[band][2][0]))/ewRes;
+            
+            dyAspect = ((dataBlock[band][2][0] + dataBlock[band][2][1] + dataBlock[band][2][1] + dataBlock[band][2][2]) -
+                        (dataBlock[band][0][0] + dataBlock[band][0][1] + dataBlock[band][0][1] + dataBlock[band][0][2]))/nsRes;
+            
+            aspect = atan2(-dxAspect, dyAspect)*radiansToDegrees;
+            
+            if (dxAspect == 0 && dyAspect == 0)
+            {
+                // Flat area
+                aspect = std::numeric_limits<double>::signaling_NaN();
+                flatGround = true;
+            }
+            else if(aspect < 0)
+            {
+                aspect += 360.0;
+            }
+            else if(aspect == 360.0)
+            {
+                aspect = 0.0;
+            }
+            else if(aspect > 360)
+            {
+                double num = aspect / 360.0;
+                int num360s = floor(num);
+                aspect = aspect - (360 * num360s);
+            }
+            
+            aspect = aspect * degreesToRadians;
+        }
+        else
+        {
+            slopeRad = 0;
+            // No Data - call it flat ground...
+            aspect = std::numeric_limits<double>::signaling_NaN();
+            flatGround = true;
+        }
+        
+        
+        if(flatGround)
+        {
+            return 0;
+        }
+        
+        double sunZenRad = sunZenith * degreesToRadians;
+        double sunAzRad = sunAzimuth * degreesToRadians;
+        
+        double ic = (cos(sunZenRad) * cos(slopeRad)) + (sin(sunZenRad) * sin(slopeRad) * cos((sunAzRad) - aspect));
+        if(ic < 0)
+        {
+            return 1;
+        }
+        return 2;
+    }
+    
+    RSGISCalcShadowBinaryMask::~RSGISCalcShadowBinaryMask()
+    {
+        delete extractPixels;
+    }
+
+
+
+    RSGISCalcTerrainShadowSweep::RSGISCalcTerrainShadowSweep(GDALDataset *demImage, unsigned int band, double noDataVal)
+    {
+        if(band >= ((unsigned int)demImage->GetRasterCount()))
+        {
+            throw rsgis::img::RSGISImageCalcException("Specified image band is not within the image.");
+        }
+        this->width = demImage->GetRasterXSize();
+        this->height = demImage->GetRasterYSize();
+        this->noDataVal = noDataVal;
+        
+        double transform[6];
+        demImage->GetGeoTransform(transform);
+        this->ewRes = transform[1];
+        this->nsRes = transform[5];
+        if(this->nsRes < 0)
+        {
+            this->nsRes = this->nsRes * (-1);
+        }
+        
+        // Read the DEM in strips of the image blocks.
+        GDALRasterBand *demBand = demImage->GetRasterBand(band+1);
+        this->demVals.resize(((size_t)this->width) * this->height);
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        demBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        int stripRows = std::max(yBlockSize, 1);
+        for(int y = 0; y < this->height; y += stripRows)
+        {
+            int nRows = std::min(stripRows, this->height - y);
+            if(demBand->RasterIO(GF_Read, 0, y, this->width, nRows, &this->demVals[((size_t)y)*this->width], this->width, nRows, GDT_Float32, 0, 0) != CE_None)
+            {
+                throw rsgis::img::RSGISImageCalcException("Could not read the DEM image band.");
+            }
+        }
+    }
+    
+    void RSGISCalcTerrainShadowSweep::calcShadowMask(float sunZenith, float sunAzimuth, unsigned char *mask)
+    {
+        const double degreesToRadians = M_PI / 180.0;
+        const double noHorizon = -std::numeric_limits<double>::infinity();
+        size_t nPxls = ((size_t)this->width) * this->height;
+        
+        // The local test, where the pixels outside the image are 0 as with the
+        // window engine used by RSGISCalcShadowBinaryMask.
+        float winVals[3][3];
+        float *winRows[3] = {winVals[0], winVals[1], winVals[2]};
+        float **winBands[1] = {winRows};
+        std::vector<unsigned char> sunFacing(nPxls, 0);
+        bool anySunFacing = false;
+        for(int y = 0; y < this->height; ++y)
+        {
+            for(int x = 0; x < this->width; ++x)
+            {
+                size_t idx = (((size_t)y) * this->width) + x;
+                mask[idx] = 0;
+                if(this->demVals[idx] == this->noDataVal)
+                {
+                    continue;
+                }
+                for(int i = 0; i < 3; ++i)
+                {
+                    int winY = y + i - 1;
+                    for(int j = 0; j < 3; ++j)
                     {
-                        // do ray tracing...
-                        // Location of active point.
-                        double x = extent.MinX + (extent.MaxX - extent.MinX)/2;
-                        double y = extent.MinY + (extent.MaxY - extent.MinY)/2;
-                        double z = dataBlock[band][1][1];
-                        
-                        
-                        double sunAzTrans = 360-this->sunAzimuth;
-                        sunAzTrans = sunAzTrans + 90;
-                        if(sunAzTrans > 360)
+                        int winX = x + j - 1;
+                        if((winY < 0) || (winY >= this->height) || (winX < 0) || (winX >= this->width))
                         {
-                            sunAzTrans = sunAzTrans-360;
+                            winVals[i][j] = 0;
                         }
-                        
-                        double sunZenRad = sunZenith * degreesToRadians;
-                        double sunAzRad = sunAzTrans * degreesToRadians;
-                        
-                        // Location of the sun.
-                        //double sunX = x + (sunRange * sin(sunZenRad) * cos(sunAzRad));
-                        //double sunY = y + (sunRange * sin(sunZenRad) * sin(sunAzRad));
-                        //double sunZ = z + (sunRange * cos(sunZenRad));
-                        
-                        // Create Ray Line
-                        OGRPoint *pxlPt = new OGRPoint(x, y, z);
-                        std::vector<rsgis::img::ImagePixelValuePt*> *imagePxlPts = extractPixels->getImagePixelValues(inputImage, band+1, pxlPt, sunAzRad, sunZenRad, maxElevHeight);
-                        delete pxlPt;
-                        
-                        // Check whether pixel intersects with ray.
-                        for(std::vector<rsgis::img::ImagePixelValuePt*>::iterator iterPxls = imagePxlPts->begin(); iterPxls != imagePxlPts->end(); ++iterPxls)
-                        {
-                            if((*iterPxls)->pt->getZ() < (*iterPxls)->value)
-                            {
-                                output[0] = 1;
-                                break;
-                            }
-                        }
-                        
-                        // Clean up memory..
-                        for(std::vector<rsgis::img::ImagePixelValuePt*>::iterator iterPxls = imagePxlPts->begin(); iterPxls != imagePxlPts->end(); )
+                        else
                         {
-                            delete (*iterPxls)->pt;
-                            delete (*iterPxls);
-                            iterPxls = imagePxlPts->erase(iterPxls);
+                            winVals[i][j] = this->demVals[(((size_t)winY) * this->width) + winX];
                         }
-                        delete imagePxlPts;
                     }
                 }
-                else
+                int sunExposure = RSGISCalcShadowBinaryMask::calcLocalSunExposure(winBands, 0, this->ewRes, this->nsRes, sunZenith, sunAzimuth, this->noDataVal);
+                if(sunExposure == 1)
                 {
-                    output[0] = 0;
+                    mask[idx] = 1;
+                }
+                else if(sunExposure == 2)
+                {
+                    sunFacing[idx] = 1;
+                    anySunFacing = true;
                 }
             }
-            else
+        }
+        
+        // With the sun overhead the ray cannot intersect the terrain.
+        double sunZenRad = sunZenith * degreesToRadians;
+        if((!anySunFacing) || (sin(sunZenRad) <= 0))
+        {
+            return;
+        }
+        
+        // The direction towards the sun in pixels per metre.
+        double sunAzRad = sunAzimuth * degreesToRadians;
+        double colsPerMetre = sin(sunAzRad) / this->ewRes;
+        double rowsPerMetre = -cos(sunAzRad) / this->nsRes;
+        double rayRise = cos(sunZenRad) / sin(sunZenRad);
+        
+        // Sweep the lines perpendicular to the major axis of the direction, so the
+        // position one line towards the sun is within one pixel along the line.
+        bool sweepCols = fabs(colsPerMetre) >= fabs(rowsPerMetre);
+        int numLines = sweepCols ? this->width : this->height;
+        int lineLen = sweepCols ? this->height : this->width;
+        double majorPerMetre = sweepCols ? colsPerMetre : rowsPerMetre;
+        double minorPerMetre = sweepCols ? rowsPerMetre : colsPerMetre;
+        double stepDist = 1.0 / fabs(majorPerMetre);
+        double stepShift = minorPerMetre * stepDist;
+        double stepDrop = rayRise * stepDist;
+        bool sunAtLineEnd = majorPerMetre > 0;
+        
+        // The surface of each pixel of the previous line is the maximum of its
+        // elevation and its horizon (the highest the terrain towards the sun gets
+        // above the ray through the pixel).
+        std::vector<double> prevSurface(lineLen, noHorizon);
+        std::vector<double> surface(lineLen, noHorizon);
+        for(int i = 0; i < numLines; ++i)
+        {
+            int line = sunAtLineEnd ? (numLines - 1 - i) : i;
+            for(int pos = 0; pos < lineLen; ++pos)
             {
-                output[0] = 0;
+                double horizon = noHorizon;
+                double sunPos = pos + stepShift;
+                if((i > 0) && (sunPos >= -0.5) && (sunPos <= (lineLen - 0.5)))
+                {
+                    int pos0 = floor(sunPos);
+                    double frac = sunPos - pos0;
+                    double surf0 = (pos0 >= 0) ? prevSurface[pos0] : noHorizon;
+                    double surf1 = ((pos0 + 1) < lineLen) ? prevSurface[pos0 + 1] : noHorizon;
+                    double sunSurf = noHorizon;
+                    if((surf0 != noHorizon) && (surf1 != noHorizon))
+                    {
+                        sunSurf = surf0 + ((surf1 - surf0) * frac);
+                    }
+                    else
+                    {
+                        sunSurf = (frac < 0.5) ? surf0 : surf1;
+                    }
+                    horizon = sunSurf - stepDrop;
+                }
+                
+                size_t idx = sweepCols ? ((((size_t)pos) * this->width) + line) : ((((size_t)line) * this->width) + pos);
+                float elev = this->demVals[idx];
+                if(sunFacing[idx] && (horizon > elev))
+                {
+                    mask[idx] = 1;
+                }
+                surface[pos] = this->isDEMVal(elev) ? std::max<double>(elev, horizon) : horizon;
             }
+            prevSurface.swap(surface);
         }
-        catch (rsgis::img::RSGISImageCalcException &e) 
+    }
+    
+    void RSGISCalcTerrainShadowSweep::calcShadowMasks(const std::vector<float> &sunZeniths, const std::vector<float> &sunAzimuths, std::vector< std::vector<unsigned char> > &masks)
+    {
+        if(sunZeniths.size() != sunAzimuths.size())
         {
-            throw e;
+            throw rsgis::img::RSGISImageCalcException("The same number of solar zenith and azimuth angles must be provided.");
         }
+        size_t nPxls = ((size_t)this->width) * this->height;
+        masks.resize(sunZeniths.size());
+        
+        // The DEM is only read, so the sun positions are independent.
+        rsgis::RSGISThreadPool threadPool(rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads);
+        threadPool.parallelFor(0, sunZeniths.size(), [&](unsigned int t, size_t start, size_t end)
+        {
+            for(size_t i = start; i < end; ++i)
+            {
+                masks[i].resize(nPxls);
+                this->calcShadowMask(sunZeniths[i], sunAzimuths[i], masks[i].data());
+            }
+        });
     }
     
-    RSGISCalcShadowBinaryMask::~RSGISCalcShadowBinaryMask()
+    RSGISCalcTerrainShadowSweep::~RSGISCalcTerrainShadowSweep()
     {
-        delete extractPixels;
+        
     }
     
     
@@ -1186,6 +1368,300 @@ namespace rsgis{namespace calib{
     }
 
     
+    RSGISCalcTerrainDerivatives::RSGISCalcTerrainDerivatives(std::vector<RSGISTerrainDerivative> derivatives, unsigned int band, float ewRes, float nsRes, int slopeOutType, float sunZenith, float sunAzimuth, float viewZenith, float viewAzimuth, double noDataVal) : rsgis::img::RSGISCalcImageValue(derivatives.size())
+    {
+        this->derivatives = derivatives;
+        this->band = band;
+        this->ewRes = ewRes;
+        this->nsRes = nsRes;
+        this->slopeOutType = slopeOutType;
+        this->sunZenith = sunZenith;
+        this->sunAzimuth = sunAzimuth;
+        this->viewZenith = viewZenith;
+        this->viewAzimuth = viewAzimuth;
+        this->noDataVal = noDataVal;
+        
+        // The sun azimuth as used by RSGISCalcHillShade.
+        this->hillShadeSunAzimuth = 360 - this->sunAzimuth;
+        this->hillShadeSunAzimuth = this->hillShadeSunAzimuth + 90;
+        if(this->hillShadeSunAzimuth > 360)
+        {
+            this->hillShadeSunAzimuth = this->hillShadeSunAzimuth - 360;
+        }
+    }
+    
+    void RSGISCalcTerrainDerivatives::calcImageValue(float ***dataBlock, int numBands, int winSize, double *output)
+    {
+        this->checkWindow(numBands, winSize);
+        float winVals[9];
+        for(int i = 0; i < 3; ++i)
+        {
+            for(int j = 0; j < 3; ++j)
+            {
+                winVals[(i*3)+j] = dataBlock[band][i][j];
+            }
+        }
+        this->calcWindowDerivatives(winVals, output);
+    }
+    
+    bool RSGISCalcTerrainDerivatives::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+    {
+        this->checkWindow(numBands, winSize);
+        float winVals[9];
+        for(int i = 0; i < 3; ++i)
+        {
+            for(int j = 0; j < 3; ++j)
+            {
+                winVals[(i*3)+j] = winData[band][(i*stride)+j];
+            }
+        }
+        this->calcWindowDerivatives(winVals, output);
+        return true;
+    }
+    
+    rsgis::img::RSGISCalcImageValue* RSGISCalcTerrainDerivatives::clone()
+    {
+        return new RSGISCalcTerrainDerivatives(this->derivatives, this->band, this->ewRes, this->nsRes, this->slopeOutType, this->sunZenith, this->sunAzimuth, this->viewZenith, this->viewAzimuth, this->noDataVal);
+    }
+    
+    std::string RSGISCalcTerrainDerivatives::getDerivativeBandName(RSGISTerrainDerivative derivative)
+    {
+        switch(derivative)
+        {
+            case rsgis_terrain_slope:
+                return "slope";
+            case rsgis_terrain_aspect:
+                return "aspect";
+            case rsgis_terrain_hillshade:
+                return "hillshade";
+            case rsgis_terrain_incidence:
+                return "incidence";
+            case rsgis_terrain_exitance:
+                return "exitance";
+        }
+        return "";
+    }
+    
+    void RSGISCalcTerrainDerivatives::checkWindow(int numBands, int winSize)
+    {
+        if(winSize != 3)
+        {
+            throw rsgis::img::RSGISImageCalcException("Window size must be equal to 3 for the calculate of the terrain derivatives.");
+        }
+        
+        if(band >= numBands)
+        {
+            throw rsgis::img::RSGISImageCalcException("Specified image band is not within the image.");
+        }
+    }
+    
+    void RSGISCalcTerrainDerivatives::calcWindowDerivatives(const float *winVals, double *output)
+    {
+        const double degreesToRadians = M_PI / 180.0;
+        const double radiansToDegrees = 180.0 / M_PI;
+        
+        // The no data values are replaced by the mean of the window, as for the single
+        // derivative classes (RSGISCalcAspect sums the window values as a float).
+        bool hasNoDataVal = false;
+        double sumVals = 0.0;
+        float sumValsAspect = 0.0;
+        int nVals = 0;
+        for(int k = 0; k < 9; ++k)
+        {
+            if(winVals[k] == noDataVal)
+            {
+                hasNoDataVal = true;
+            }
+            else
+            {
+                sumVals += winVals[k];
+                sumValsAspect += winVals[k];
+                ++nVals;
+            }
+        }
+        float win[9];
+        float winAspect[9];
+        for(int k = 0; k < 9; ++k)
+        {
+            win[k] = winVals[k];
+            winAspect[k] = winVals[k];
+        }
+        if(hasNoDataVal && (nVals>1))
+        {
+            float meanVal = sumVals / nVals;
+            float meanValAspect = sumValsAspect / nVals;
+            for(int k = 0; k < 9; ++k)
+            {
+                if(winVals[k] == noDataVal)
+                {
+                    win[k] = meanVal;
+                    winAspect[k] = meanValAspect;
+                }
+            }
+        }
+        
+        if(nVals <= 1)
+        {
+            // Input was no data region.
+            for(size_t i = 0; i < this->derivatives.size(); ++i)
+            {
+                switch(this->derivatives[i])
+                {
+                    case rsgis_terrain_slope:
+                        output[i] = 0.0;
+                        break;
+                    case rsgis_terrain_aspect:
+                        output[i] = std::numeric_limits<double>::signaling_NaN();
+                        break;
+                    case rsgis_terrain_hillshade:
+                        output[i] = 1.0;
+                        break;
+                    case rsgis_terrain_incidence:
+                        output[i] = sunZenith;
+                        break;
+                    case rsgis_terrain_exitance:
+                        output[i] = 0.0;
+                        break;
+                }
+            }
+            return;
+        }
+        
+        // The sums of the columns and rows of the window for the Horn gradients.
+        float leftSum = win[0] + win[3] + win[3] + win[6];
+        float rightSum = win[2] + win[5] + win[5] + win[8];
+        float topSum = win[0] + win[1] + win[1] + win[2];
+        float bottomSum = win[6] + win[7] + win[7] + win[8];
+        
+        double dxSlope = (leftSum - rightSum)/ewRes;
+        double dySlope = (bottomSum - topSum)/nsRes;
+        double slopeRad = atan(sqrt((dxSlope * dxSlope) + (dySlope * dySlope))/8);
+        
+        double dxAspect = (rightSum - leftSum)/ewRes;
+        double dyAspect = dySlope;
+        bool flat = (dxAspect == 0 && dyAspect == 0);
+        // The aspect used by the incidence and exitance angles.
+        double aspect = atan2(-dxAspect, dyAspect)*radiansToDegrees;
+        if (aspect < 0)
+        {
+            aspect += 360.0;
+        }
+        if (aspect == 360.0)
+        {
+            aspect = 0.0;
+        }
+        
+        for(size_t i = 0; i < this->derivatives.size(); ++i)
+        {
+            switch(this->derivatives[i])
+            {
+                case rsgis_terrain_slope:
+                {
+                    if(slopeOutType == 0)
+                    {
+                        output[i] = (slopeRad * radiansToDegrees);
+                    }
+                    else
+                    {
+                        output[i] = slopeRad;
+                    }
+                    break;
+                }
+                case rsgis_terrain_aspect:
+                {
+                    float aspLeftSum = winAspect[0] + winAspect[3] + winAspect[3] + winAspect[6];
+                    float aspRightSum = winAspect[2] + winAspect[5] + winAspect[5] + winAspect[8];
+                    float aspTopSum = winAspect[0] + winAspect[1] + winAspect[1] + winAspect[2];
+                    float aspBottomSum = winAspect[6] + winAspect[7] + winAspect[7] + winAspect[8];
+                    double dx = (aspRightSum - aspLeftSum)/ewRes;
+                    double dy = (aspBottomSum - aspTopSum)/nsRes;
+                    double aspectVal = atan2(-dx, dy)*radiansToDegrees;
+                    if (dx == 0 && dy == 0)
+                    {
+                        // Flat area
+                        aspectVal = std::numeric_limits<double>::signaling_NaN();
+                    }
+                    else if(aspectVal < 0)
+                    {
+                        aspectVal += 360.0;
+                    }
+                    else if(aspectVal == 360.0)
+                    {
+                        aspectVal = 0.0;
+                    }
+                    else if(aspectVal > 360)
+                    {
+                        double num = aspectVal / 360.0;
+                        int num360s = floor(num);
+                        aspectVal = aspectVal - (360 * num360s);
+                    }
+                    output[i] = aspectVal;
+                    break;
+                }
+                case rsgis_terrain_hillshade:
+                {
+                    double dx = (rightSum - leftSum)/(ewRes*8);
+                    double dy = (topSum - bottomSum)/(nsRes*8);
+                    double xx_plus_yy = dx * dx + dy * dy;
+                    double hsAspect = atan2(dy,dx);
+                    double sunZenRad = sunZenith * degreesToRadians;
+                    double sunAzRad = hillShadeSunAzimuth * degreesToRadians;
+                    double cang = (sin(sunZenRad) -
+                                   cos(sunZenRad) * sqrt(xx_plus_yy) *
+                                   sin(hsAspect - (sunAzRad-M_PI/2))) /
+                                  sqrt(1 + 1 * xx_plus_yy);
+                    if (cang <= 0.0)
+                    {
+                        cang = 1.0;
+                    }
+                    else
+                    {
+                        cang = 1.0 + (254.0 * cang);
+                    }
+                    output[i] = cang;
+                    break;
+                }
+                case rsgis_terrain_incidence:
+                case rsgis_terrain_exitance:
+                {
+                    bool incidence = (this->derivatives[i] == rsgis_terrain_incidence);
+                    double aspectRad = 0.0;
+                    if(flat)
+                    {
+                        // The incident angle is undefined (the sun zenith) for flat areas while the exitance uses an aspect of 0.
+                        aspectRad = incidence?std::numeric_limits<double>::signaling_NaN():0.0;
+                    }
+                    else
+                    {
+                        aspectRad = aspect*degreesToRadians;
+                    }
+                    
+                    // UNIT VECTOR FOR SURFACE
+                    double pA = sin(slopeRad) * cos(aspectRad);
+                    double pB = sin(slopeRad) * sin(aspectRad);
+                    double pC = cos(slopeRad);
+                    
+                    double rayZenRad = (incidence?sunZenith:viewZenith) * degreesToRadians;
+                    double rayAzRad = (incidence?sunAzimuth:viewAzimuth) * degreesToRadians;
+                    
+                    // UNIT VECTOR FOR INCIDENT OR EXITANCE RAY
+                    double rA = sin(rayZenRad) * cos(rayAzRad);
+                    double rB = sin(rayZenRad) * sin(rayAzRad);
+                    double rC = cos(rayZenRad);
+                    
+                    float outputValue = acos((pA*rA)+(pB*rB)+(pC*rC)) * radiansToDegrees;
+                    if(boost::math::isnan(outputValue))
+                    {
+                        outputValue = incidence?sunZenith:0;
+                    }
+                    output[i] = outputValue;
+                    break;
+                }
+            }
+        }
+    }
+
+    
     RSGISFilterDTMWithAspectMedianFilter::RSGISFilterDTMWithAspectMedianFilter(float aspectRange, double noDataVal) : rsgis::img::RSGISCalcImageValue(1)
     {
         this->aspectRange = aspectRange;
@@ -1261,17 +1737,98 @@ namespace rsgis{namespace calib{
         
     }
     
+    bool RSGISFilterDTMWithAspectMedianFilter::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+    {
+        int midPoint = floor(((float)winSize)/2.0);
+        
+        float aspectVal = winData[1][(midPoint*stride)+midPoint];
+        float lowerAspThres = aspectVal - aspectRange;
+        float upperAspThres = aspectVal + aspectRange;
+        
+        if(lowerAspThres < 0)
+        {
+            lowerAspThres = 360 + lowerAspThres;
+        }
+        
+        if(upperAspThres > 360)
+        {
+            upperAspThres = upperAspThres - 360;
+        }
+        
+        // The median is the same value as that of the sorted values but is selected,
+        // with the buffer reused between the windows.
+        this->winVals.clear();
+        for(int i = 0; i < winSize; ++i)
+        {
+            const float *demRow = winData[0] + (i*stride);
+            const float *aspRow = winData[1] + (i*stride);
+            for(int j = 0; j < winSize; ++j)
+            {
+                if(mathUtils.angleWithinRange(aspRow[j], lowerAspThres, upperAspThres))
+                {
+                    if(!boost::math::isnan(demRow[j]) && (demRow[j] != noDataVal))
+                    {
+                        this->winVals.push_back(demRow[j]);
+                    }
+                }
+            }
+        }
+        
+        if(this->winVals.empty())
+        {
+            for(int i = 0; i < winSize; ++i)
+            {
+                const float *demRow = winData[0] + (i*stride);
+                for(int j = 0; j < winSize; ++j)
+                {
+                    if(!boost::math::isnan(demRow[j]) && (demRow[j] != noDataVal))
+                    {
+                        this->winVals.push_back(demRow[j]);
+                    }
+                }
+            }
+        }
+        
+        if(this->winVals.size() > 0)
+        {
+            output[0] = rsgis::datastruct::rsgisSelectNth(this->winVals.data(), this->winVals.size(), this->winVals.size()/2);
+        }
+        else
+        {
+            output[0] = std::numeric_limits<float>::signaling_NaN();
+        }
+        return true;
+    }
+    
+    rsgis::img::RSGISCalcImageValue* RSGISFilterDTMWithAspectMedianFilter::clone()
+    {
+        return new RSGISFilterDTMWithAspectMedianFilter(this->aspectRange, this->noDataVal);
+    }
+    
     
     
     
     RSGISDetreadDEMUsingPlaneFit::RSGISDetreadDEMUsingPlaneFit(double noDataVal, int winSize) : rsgis::img::RSGISCalcImageValue(1)
     {
         this->noDataVal = noDataVal;
+        this->winSize = winSize;
         this->mathUtils = new rsgis::math::RSGISMathsUtils();
         this->xVals = new double[winSize*winSize];
         this->yVals = new double[winSize*winSize];
         this->zVals = new double[winSize*winSize];
         this->nVals = 0;
+        
+        // The coordinates of the rows and columns relative to the centre of the window,
+        // which are calculated as in calcImageValue (i.e., from the unsigned row and
+        // column indexes) so both give the same values.
+        int midPoint = floor(((float)winSize)/2.0);
+        this->coords = std::vector<double>(winSize);
+        for(unsigned int i = 0; i < winSize; ++i)
+        {
+            this->coords[i] = i-midPoint;
+        }
+        this->colSums = std::vector<double>(winSize*5, 0);
+        this->colStart = 0;
     }
     
     void RSGISDetreadDEMUsingPlaneFit::calcImageValue(float ***dataBlock, int numBands, int winSize, double *output) 
@@ -1314,6 +1871,100 @@ namespace rsgis{namespace calib{
         
     }
     
+    bool RSGISDetreadDEMUsingPlaneFit::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+    {
+        if(winSize != this->winSize)
+        {
+            throw rsgis::img::RSGISImageCalcException("Window sizes are different");
+        }
+        
+        for(int j = 0; j < winSize; ++j)
+        {
+            this->calcColumnSums(winData[0] + j, stride, j);
+        }
+        this->colStart = 0;
+        output[0] = this->calcPlaneOffset();
+        return true;
+    }
+    
+    bool RSGISDetreadDEMUsingPlaneFit::calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output)
+    {
+        // The sums of the column which has left the window are replaced with those of
+        // the column which has entered it, which is then the last column of the window.
+        this->calcColumnSums(inColumn[0], stride, this->colStart);
+        this->colStart = (this->colStart + 1) % winSize;
+        output[0] = this->calcPlaneOffset();
+        return true;
+    }
+    
+    void RSGISDetreadDEMUsingPlaneFit::calcColumnSums(const float *colData, size_t stride, int colIdx)
+    {
+        double *colSums = &this->colSums[colIdx*5];
+        for(int k = 0; k < 5; ++k)
+        {
+            colSums[k] = 0;
+        }
+        for(int i = 0; i < this->winSize; ++i)
+        {
+            float z = colData[i*stride];
+            if(!boost::math::isnan(z) && (z != noDataVal))
+            {
+                double y = this->coords[i];
+                colSums[0] += 1;
+                colSums[1] += y;
+                colSums[2] += y * y;
+                colSums[3] += z;
+                colSums[4] += y * z;
+            }
+        }
+    }
+    
+    double RSGISDetreadDEMUsingPlaneFit::calcPlaneOffset()
+    {
+        double sN = 0;
+        double sX = 0;
+        double sY = 0;
+        double sXX = 0;
+        double sYY = 0;
+        double sXY = 0;
+        double sZ = 0;
+        double sXZ = 0;
+        double sYZ = 0;
+        for(int j = 0; j < this->winSize; ++j)
+        {
+            const double *colSums = &this->colSums[((this->colStart + j) % this->winSize)*5];
+            double x = this->coords[j];
+            sN += colSums[0];
+            sX += x * colSums[0];
+            sXX += x * x * colSums[0];
+            sY += colSums[1];
+            sYY += colSums[2];
+            sXY += x * colSums[1];
+            sZ += colSums[3];
+            sXZ += x * colSums[3];
+            sYZ += colSums[4];
+        }
+        
+        if(sN == 0)
+        {
+            return 0;
+        }
+        // The last row of the inverse (from the cofactors) of the normal equations
+        // matrix [sXX sXY sX; sXY sYY sY; sX sY n] multiplied by [sXZ sYZ sZ], as
+        // rsgis::math::RSGISMathsUtils::fitPlane.
+        double cof0 = (sXY * sY) - (sYY * sX);
+        double cof1 = -((sXX * sY) - (sXY * sX));
+        double cof2 = (sXX * sYY) - (sXY * sXY);
+        double det = (sXX * ((sYY * sN) - (sY * sY))) - (sXY * ((sXY * sN) - (sY * sX))) + (sX * cof0);
+        double multiplier = 1/det;
+        return ((cof0 * multiplier) * sXZ) + ((cof1 * multiplier) * sYZ) + ((cof2 * multiplier) * sZ);
+    }
+    
+    rsgis::img::RSGISCalcImageValue* RSGISDetreadDEMUsingPlaneFit::clone()
+    {
+        return new RSGISDetreadDEMUsingPlaneFit(this->noDataVal, this->winSize);
+    }
+    
     RSGISDetreadDEMUsingPlaneFit::~RSGISDetreadDEMUsingPlaneFit()
     {
         delete this->mathUtils;
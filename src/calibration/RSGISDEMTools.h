@@ -26,10 +26,15 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <limits>
 #include <cmath>
 
 #include "gdal_priv.h"
 
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
+
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISImageUtils.h"
@@ -37,6 +42,8 @@
 
 #include "math/RSGISMathsUtils.h"
 
+#include "datastruct/RSGISSmallSortedBuffer.h"
+
 #include <boost/math/special_functions/fpclassify.hpp>
 
 #ifndef M_PI
@@ -176,6 +183,13 @@ namespace rsgis{namespace calib{
 	public: 
 		RSGISCalcShadowBinaryMask(GDALDataset *inputImage, unsigned int band, float ewRes, float nsRes, float sunZenith, float sunAzimuth, float maxElevHeight, double noDataVal);
         void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output, OGREnvelope extent);
+        /**
+         * The local test of the 3x3 window (the nodata values are replaced by the mean
+         * of the window): 0 if the slope cannot be calculated or is flat (never shadowed),
+         * 1 if the slope faces away from the sun (shadowed) and 2 if it faces the sun (so
+         * it is shadowed only if the terrain towards the sun is above the ray).
+         */
+        static int calcLocalSunExposure(float ***dataBlock, unsigned int band, float ewRes, float nsRes, float sunZenith, float sunAzimuth, double noDataVal);
 		~RSGISCalcShadowBinaryMask();
     private:
         unsigned int band;
@@ -195,6 +209,41 @@ namespace rsgis{namespace calib{
 	};
 
 
+    /**
+     * Calculates the shadow masks of a DEM (held in memory) for a set of sun positions.
+     * The local test is that of RSGISCalcShadowBinaryMask, but rather than tracing a ray
+     * towards the sun from every pixel the DEM is swept one line (row or column, whichever
+     * is closer to perpendicular to the solar azimuth) at a time starting from the sun side.
+     * The horizon of each pixel (the maximum height of the terrain towards the sun less the
+     * drop of the ray over the distance) is interpolated from the horizon and elevation of
+     * the pixels of the previous line, so each sun position is O(N) whatever the relief.
+     * Nodata pixels do not cast shadows and the ray ends at the edge of the image.
+     */
+    class DllExport RSGISCalcTerrainShadowSweep
+	{
+	public:
+		RSGISCalcTerrainShadowSweep(GDALDataset *demImage, unsigned int band, double noDataVal);
+        int getWidth(){return this->width;};
+        int getHeight(){return this->height;};
+        /** Get the mask (width x height, row-major) where shadowed pixels are 1 and all other pixels 0. */
+        void calcShadowMask(float sunZenith, float sunAzimuth, unsigned char *mask);
+        /**
+         * Calculate a mask for each sun position (sunZeniths[i], sunAzimuths[i]) into masks[i].
+         * The sun positions are split between the threads of the default execution context.
+         */
+        void calcShadowMasks(const std::vector<float> &sunZeniths, const std::vector<float> &sunAzimuths, std::vector< std::vector<unsigned char> > &masks);
+		~RSGISCalcTerrainShadowSweep();
+    protected:
+        bool isDEMVal(float val){return (val != this->noDataVal) && (boost::math::isfinite)(val);};
+        int width;
+        int height;
+        float ewRes;
+        float nsRes;
+        double noDataVal;
+        std::vector<float> demVals;
+	};
+
+
 
     class DllExport RSGISCalcRayIncidentAngle : public rsgis::img::RSGISCalcImageValue
 	{
@@ -227,34 +276,110 @@ namespace rsgis{namespace calib{
         double noDataVal;
 	};
 
+    
+    enum RSGISTerrainDerivative
+    {
+        rsgis_terrain_slope = 0,
+        rsgis_terrain_aspect = 1,
+        rsgis_terrain_hillshade = 2,
+        rsgis_terrain_incidence = 3,
+        rsgis_terrain_exitance = 4
+    };
+    
+    /**
+     * Calculates a set of terrain derivatives (one output band per derivative, in the
+     * order given) from the 3x3 window of a DEM, so the DEM is only read and the window
+     * sums of the Horn gradients only calculated once for all the derivatives. The
+     * values are those of RSGISCalcSlope, RSGISCalcAspect, RSGISCalcHillShade,
+     * RSGISCalcRayIncidentAngle and RSGISCalcRayExitanceAngle (slopeOutType is the
+     * outType of RSGISCalcSlope). The windows are passed as views of the image data
+     * (see calcImageWindowView) and the class can be cloned, so
+     * RSGISCalcImage::calcImageWindowData runs it on multiple threads.
+     */
+    class DllExport RSGISCalcTerrainDerivatives : public rsgis::img::RSGISCalcImageValue
+	{
+	public: 
+		RSGISCalcTerrainDerivatives(std::vector<RSGISTerrainDerivative> derivatives, unsigned int band, float ewRes, float nsRes, int slopeOutType, float sunZenith, float sunAzimuth, float viewZenith, float viewAzimuth, double noDataVal);
+		void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+        bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+        rsgis::img::RSGISCalcImageValue* clone();
+        /** The name of the output band of a derivative (e.g., 'slope'). */
+        static std::string getDerivativeBandName(RSGISTerrainDerivative derivative);
+		~RSGISCalcTerrainDerivatives(){};
+    protected:
+        void checkWindow(int numBands, int winSize);
+        void calcWindowDerivatives(const float *winVals, double *output);
+        std::vector<RSGISTerrainDerivative> derivatives;
+        unsigned int band;
+        float ewRes;
+        float nsRes;
+        int slopeOutType;
+        float sunZenith;
+        float sunAzimuth;
+        float hillShadeSunAzimuth;
+        float viewZenith;
+        float viewAzimuth;
+        double noDataVal;
+	};
+
 
     
+    /**
+     * Median filter of a DTM (band 1) using only the pixels within the window which have
+     * an aspect (band 2) within aspectRange of the aspect of the centre pixel. The median
+     * of the window views (see calcImageWindowView) is selected rather than sorted and
+     * the class can be cloned, so RSGISCalcImage::calcImageWindowData runs it on
+     * multiple threads.
+     */
     class DllExport RSGISFilterDTMWithAspectMedianFilter : public rsgis::img::RSGISCalcImageValue
 	{
 	public:
 		RSGISFilterDTMWithAspectMedianFilter(float aspectRange, double noDataVal);
 		void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+        bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+        rsgis::img::RSGISCalcImageValue* clone();
         ~RSGISFilterDTMWithAspectMedianFilter(){};
     private:
         float aspectRange;
         double noDataVal;
+        rsgis::math::RSGISMathsUtils mathUtils;
+        std::vector<float> winVals;
 	};
 
     
 
+    /**
+     * Detrends a DEM by fitting a plane to the valid pixels of the window and outputting
+     * the offset of the plane. For the window views (see calcImageWindowView and
+     * calcImageWindowViewSlide) the sums of the least squares normal equations are held
+     * per column of the window, so as the window moves along a row only the sums of the
+     * column entering the window are calculated. The class can be cloned, so
+     * RSGISCalcImage::calcImageWindowData runs it on multiple threads.
+     */
     class DllExport RSGISDetreadDEMUsingPlaneFit : public rsgis::img::RSGISCalcImageValue
     {
     public:
         RSGISDetreadDEMUsingPlaneFit(double noDataVal, int winSize);
         void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+        bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+        bool calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output);
+        rsgis::img::RSGISCalcImageValue* clone();
         ~RSGISDetreadDEMUsingPlaneFit();
+    protected:
+        void calcColumnSums(const float *colData, size_t stride, int colIdx);
+        double calcPlaneOffset();
     private:
         rsgis::math::RSGISMathsUtils *mathUtils;
         double noDataVal;
+        int winSize;
         double *xVals;
         double *yVals;
         double *zVals;
         int nVals;
+        std::vector<double> coords;
+        /** The n, sum(y), sum(y^2), sum(z) and sum(yz) of each column of the window. */
+        std::vector<double> colSums;
+        int colStart;
     };
     
     
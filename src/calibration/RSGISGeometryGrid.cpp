@@ -0,0 +1,220 @@
+/*
+ *  RSGISGeometryGrid.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISGeometryGrid.h"
+
+namespace rsgis{namespace calib{
+
+    RSGISGeometryGrid::RSGISGeometryGrid(unsigned int width, unsigned int height, const double *transform, unsigned int gridSpacing)
+    {
+        if((width == 0) || (height == 0))
+        {
+            throw rsgis::img::RSGISImageCalcException("The image for the geometry grid has no pixels.");
+        }
+        if(gridSpacing == 0)
+        {
+            throw rsgis::img::RSGISImageCalcException("The geometry grid spacing must be greater than 0.");
+        }
+        this->width = width;
+        this->height = height;
+        for(int i = 0; i < 6; ++i)
+        {
+            this->transform[i] = transform[i];
+        }
+        this->gridSpacing = gridSpacing;
+        // There is always a node after the last pixel so every pixel is within a cell.
+        this->nGridCols = ((width-1) / gridSpacing) + 2;
+        this->nGridRows = ((height-1) / gridSpacing) + 2;
+        this->func = NULL;
+        this->numValues = 0;
+        this->numExactCells = 0;
+    }
+    
+    void RSGISGeometryGrid::calcGrid(RSGISGeometryGridFunction *func, double maxError)
+    {
+        this->func = func;
+        this->numValues = func->getNumValues();
+        this->nodeVals.assign(((size_t)this->numValues)*this->nGridRows*this->nGridCols, 0);
+        this->cellExact.assign(((size_t)(this->nGridRows-1))*(this->nGridCols-1), 0);
+        this->numExactCells = 0;
+        this->maxErrors.assign(this->numValues, 0);
+        
+        size_t nNodes = ((size_t)this->nGridRows)*this->nGridCols;
+        std::vector<double> vals(this->numValues);
+        double x = 0;
+        double y = 0;
+        for(unsigned int r = 0; r < this->nGridRows; ++r)
+        {
+            for(unsigned int c = 0; c < this->nGridCols; ++c)
+            {
+                this->getPixelCentre(((double)c)*this->gridSpacing, ((double)r)*this->gridSpacing, &x, &y);
+                func->calcGeometry(x, y, vals.data());
+                for(unsigned int v = 0; v < this->numValues; ++v)
+                {
+                    this->nodeVals[(v*nNodes)+(((size_t)r)*this->nGridCols)+c] = vals[v];
+                }
+            }
+        }
+        
+        // The (fractional) positions within a cell of the check points, i.e., the
+        // centre and the mid-points of the edges.
+        const double checkCols[5] = {0.5, 0.5, 0.5, 0.0, 1.0};
+        const double checkRows[5] = {0.5, 0.0, 1.0, 0.5, 0.5};
+        std::vector<double> cellErrors(this->numValues);
+        for(unsigned int r = 0; r < (this->nGridRows-1); ++r)
+        {
+            for(unsigned int c = 0; c < (this->nGridCols-1); ++c)
+            {
+                for(unsigned int v = 0; v < this->numValues; ++v)
+                {
+                    cellErrors[v] = 0;
+                }
+                for(int k = 0; k < 5; ++k)
+                {
+                    this->getPixelCentre((c+checkCols[k])*this->gridSpacing, (r+checkRows[k])*this->gridSpacing, &x, &y);
+                    func->calcGeometry(x, y, vals.data());
+                    for(unsigned int v = 0; v < this->numValues; ++v)
+                    {
+                        const double *nodes = &this->nodeVals[(v*nNodes)+(((size_t)r)*this->nGridCols)+c];
+                        double top = nodes[0] + (checkCols[k] * (nodes[1] - nodes[0]));
+                        double bottom = nodes[this->nGridCols] + (checkCols[k] * (nodes[this->nGridCols+1] - nodes[this->nGridCols]));
+                        double interpVal = top + (checkRows[k] * (bottom - top));
+                        double err = std::fabs(interpVal - vals[v]);
+                        if(!(err <= cellErrors[v]))
+                        {
+                            // Also where either value is not a number.
+                            cellErrors[v] = std::isnan(err)?std::numeric_limits<double>::infinity():err;
+                        }
+                    }
+                }
+                
+                bool exact = false;
+                if(maxError > 0)
+                {
+                    for(unsigned int v = 0; v < this->numValues; ++v)
+                    {
+                        if(cellErrors[v] > maxError)
+                        {
+                            exact = true;
+                        }
+                    }
+                }
+                
+                if(exact)
+                {
+                    this->cellExact[(((size_t)r)*(this->nGridCols-1))+c] = 1;
+                    ++this->numExactCells;
+                }
+                else
+                {
+                    for(unsigned int v = 0; v < this->numValues; ++v)
+                    {
+                        if(cellErrors[v] > this->maxErrors[v])
+                        {
+                            this->maxErrors[v] = cellErrors[v];
+                        }
+                    }
+                }
+            }
+        }
+    }
+    
+    void RSGISGeometryGrid::interpolateRow(unsigned int row, unsigned int valIdx, unsigned int startCol, unsigned int nCols, double *out)
+    {
+        if(this->func == NULL)
+        {
+            throw rsgis::img::RSGISImageCalcException("The geometry grid has not been calculated.");
+        }
+        if((row >= this->height) || (valIdx >= this->numValues) || ((((size_t)startCol)+nCols) > this->width))
+        {
+            throw rsgis::img::RSGISImageCalcException("The row to interpolate is not within the geometry grid.");
+        }
+        
+        unsigned int gRow = row / this->gridSpacing;
+        double fRow = ((double)(row - (gRow * this->gridSpacing))) / this->gridSpacing;
+        size_t nNodes = ((size_t)this->nGridRows)*this->nGridCols;
+        const double *topNodes = &this->nodeVals[(valIdx*nNodes)+(((size_t)gRow)*this->nGridCols)];
+        const double *bottomNodes = topNodes + this->nGridCols;
+        const char *rowExact = &this->cellExact[((size_t)gRow)*(this->nGridCols-1)];
+        double invSpacing = 1.0 / this->gridSpacing;
+        std::vector<double> vals;
+        double x = 0;
+        double y = 0;
+        
+        unsigned int endCol = startCol + nCols;
+        unsigned int col = startCol;
+        while(col < endCol)
+        {
+            unsigned int gCol = col / this->gridSpacing;
+            unsigned int cellStartCol = gCol * this->gridSpacing;
+            unsigned int cellEndCol = std::min(cellStartCol + this->gridSpacing, endCol);
+            double *cellOut = out + (col - startCol);
+            unsigned int nCellPxls = cellEndCol - col;
+            if(rowExact[gCol])
+            {
+                vals.resize(this->numValues);
+                for(unsigned int i = 0; i < nCellPxls; ++i)
+                {
+                    this->getPixelCentre(col + i, row, &x, &y);
+                    this->func->calcGeometry(x, y, vals.data());
+                    cellOut[i] = vals[valIdx];
+                }
+            }
+            else
+            {
+                double left = topNodes[gCol] + (fRow * (bottomNodes[gCol] - topNodes[gCol]));
+                double right = topNodes[gCol+1] + (fRow * (bottomNodes[gCol+1] - topNodes[gCol+1]));
+                double step = (right - left) * invSpacing;
+                double first = left + (step * (col - cellStartCol));
+                for(unsigned int i = 0; i < nCellPxls; ++i)
+                {
+                    cellOut[i] = first + (step * i);
+                }
+            }
+            col = cellEndCol;
+        }
+    }
+    
+    bool RSGISGeometryGrid::getPixel(double x, double y, unsigned int *col, unsigned int *row)
+    {
+        double det = (this->transform[1] * this->transform[5]) - (this->transform[2] * this->transform[4]);
+        double dX = x - this->transform[0];
+        double dY = y - this->transform[3];
+        double pxlCol = std::floor(((this->transform[5] * dX) - (this->transform[2] * dY)) / det);
+        double pxlRow = std::floor(((this->transform[1] * dY) - (this->transform[4] * dX)) / det);
+        if((pxlCol < 0) || (pxlRow < 0) || (pxlCol >= this->width) || (pxlRow >= this->height))
+        {
+            return false;
+        }
+        *col = (unsigned int)pxlCol;
+        *row = (unsigned int)pxlRow;
+        return true;
+    }
+    
+    void RSGISGeometryGrid::getPixelCentre(double col, double row, double *x, double *y)
+    {
+        *x = this->transform[0] + ((col + 0.5) * this->transform[1]) + ((row + 0.5) * this->transform[2]);
+        *y = this->transform[3] + ((col + 0.5) * this->transform[4]) + ((row + 0.5) * this->transform[5]);
+    }
+
+}}
@@ -0,0 +1,122 @@
+/*
+ *  RSGISGeometryGrid.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISGeometryGrid_h
+#define RSGISGeometryGrid_h
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "img/RSGISImageCalcException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_calib_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace calib{
+
+    /**
+     * A set of numValues geometry values (e.g., view or solar angles) which vary
+     * smoothly across an image, calculated at the (map) coordinates x and y.
+     * calcGeometry needs to be safe to call from multiple threads at once.
+     */
+    class DllExport RSGISGeometryGridFunction
+    {
+    public:
+        RSGISGeometryGridFunction(unsigned int numValues){this->numValues = numValues;};
+        virtual void calcGeometry(double x, double y, double *vals) = 0;
+        unsigned int getNumValues(){return this->numValues;};
+        virtual ~RSGISGeometryGridFunction(){};
+    protected:
+        unsigned int numValues;
+    };
+
+    /**
+     * Calculates the values of a RSGISGeometryGridFunction at the centre of every
+     * gridSpacing pixels (in x and y) of an image, with the pixel grid defined by a
+     * GDAL geotransform, and bilinearly interpolates the values of the pixels between
+     * them. This avoids calculating trigonometric functions for every pixel where the
+     * values vary smoothly (e.g., view and solar angles for TOA, 6S and terrain
+     * illumination calculations).
+     *
+     * The interpolation error of each grid cell is estimated by calculating the values
+     * at the centre and the mid-points of the edges of the cell. Where maxError is
+     * greater than 0 the cells with an estimated error greater than maxError (e.g.,
+     * where the values are not smooth) are calculated for every pixel. getMaxError
+     * gives the largest estimated error of the interpolated cells. The function
+     * needs to exist until the grid is no longer used to interpolate values.
+     */
+    class DllExport RSGISGeometryGrid
+    {
+    public:
+        RSGISGeometryGrid(unsigned int width, unsigned int height, const double *transform, unsigned int gridSpacing=64);
+        void calcGrid(RSGISGeometryGridFunction *func, double maxError=0);
+        /**
+         * Interpolate value valIdx for nCols pixels of a row of the image, starting at
+         * startCol, into out. Each grid cell is a linear ramp along the row, so the
+         * loop over the pixels of a cell can be vectorised by the compiler.
+         */
+        void interpolateRow(unsigned int row, unsigned int valIdx, unsigned int startCol, unsigned int nCols, double *out);
+        /** The image pixel containing the (map) coordinate x, y. Returns false if outside the image. */
+        bool getPixel(double x, double y, unsigned int *col, unsigned int *row);
+        double getMaxError(unsigned int valIdx){return this->maxErrors.at(valIdx);};
+        /** The number of grid cells calculated for every pixel (see calcGrid). */
+        size_t getNumExactCells(){return this->numExactCells;};
+        size_t getNumCells(){return this->cellExact.size();};
+        unsigned int getGridSpacing(){return this->gridSpacing;};
+        unsigned int getWidth(){return this->width;};
+        unsigned int getHeight(){return this->height;};
+        ~RSGISGeometryGrid(){};
+    protected:
+        void getPixelCentre(double col, double row, double *x, double *y);
+        unsigned int width;
+        unsigned int height;
+        double transform[6];
+        unsigned int gridSpacing;
+        unsigned int nGridCols;
+        unsigned int nGridRows;
+        RSGISGeometryGridFunction *func;
+        unsigned int numValues;
+        /** The values of the grid nodes (value-major, i.e., nodeVals[(v*nGridRows+r)*nGridCols+c]). */
+        std::vector<double> nodeVals;
+        std::vector<char> cellExact;
+        size_t numExactCells;
+        std::vector<double> maxErrors;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,839 @@
+/*
+ *  RSGISHydroDEMFillPriorityFlood.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib. All rights reserved.
+ *  This file is part of RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISHydroDEMFillPriorityFlood.h"
+
+namespace rsgis{namespace calib{
+
+    // Pixel classes used by the fill.
+    static const unsigned char PF_PXL_NODATA = 0;
+    static const unsigned char PF_PXL_VALID = 1;
+    static const unsigned char PF_PXL_BOUNDARY = 2;
+    static const unsigned char PF_PXL_OUTSIDE = 3;
+
+    // Pixel states used while flooding.
+    static const unsigned char PF_STATE_BARRIER = 0;
+    static const unsigned char PF_STATE_OPEN = 1;
+    static const unsigned char PF_STATE_CLOSED = 2;
+
+    // Label of the pixels flooded from the boundary of the valid region.
+    static const unsigned long PF_BOUNDARY_LABEL = 1;
+
+    RSGISPackedPxlPriorityQueue::RSGISPackedPxlPriorityQueue(long minLevel, long maxLevel, uint64_t maxIdx)
+    {
+        this->minLevel = minLevel;
+
+        unsigned int levelBits = 1;
+        while((levelBits < 64) && ((((uint64_t)1) << levelBits) <= ((uint64_t)(maxLevel - minLevel))))
+        {
+            ++levelBits;
+        }
+        this->idxBits = 1;
+        while((this->idxBits < 64) && ((((uint64_t)1) << this->idxBits) <= maxIdx))
+        {
+            ++this->idxBits;
+        }
+        if((levelBits + this->idxBits) > 64)
+        {
+            throw rsgis::img::RSGISImageCalcException("The range of image values and number of pixels cannot be packed into a 64 bit priority queue; use a smaller tile size.");
+        }
+        this->idxMask = (this->idxBits == 64)?std::numeric_limits<uint64_t>::max():((((uint64_t)1) << this->idxBits) - 1);
+    }
+
+
+    RSGISHydroDEMFillPriorityFlood::RSGISHydroDEMFillPriorityFlood()
+    {
+        this->minVal = 0;
+        this->maxVal = 0;
+        this->borderVal = 0;
+        this->noDataVal = 0.0;
+        this->edgesAsBoundary = false;
+        this->imgWidth = 0;
+        this->imgHeight = 0;
+    }
+
+    void RSGISHydroDEMFillPriorityFlood::performPriorityFloodFill(GDALDataset *inDEMImgDS, GDALDataset *inValidImgDS, GDALDataset *outImgDS, bool calcBorderVal, long borderVal, unsigned int tileSize)
+    {
+        try
+        {
+            if(inDEMImgDS->GetRasterCount() != 1)
+            {
+                throw rsgis::img::RSGISImageCalcException("The image to be filled should only have 1 image band.");
+            }
+
+            GDALDataset **datasets = new GDALDataset*[3];
+            datasets[0] = inDEMImgDS;
+            datasets[1] = inValidImgDS;
+            datasets[2] = outImgDS;
+
+            rsgis::img::RSGISImageUtils imgUtils;
+            bool imgsMatch = imgUtils.doImageSpatAndExtMatch(datasets, 3);
+            delete[] datasets;
+            if(!imgsMatch)
+            {
+                throw rsgis::img::RSGISImageCalcException("The images provided do not all have the same size and/or spaital header. The input image (e.g., DEM) and valid area image must be excatly the same.");
+            }
+
+            this->imgWidth = inDEMImgDS->GetRasterXSize();
+            this->imgHeight = inDEMImgDS->GetRasterYSize();
+
+            this->calcFillParameters(inDEMImgDS, inValidImgDS, calcBorderVal, borderVal);
+
+            // If there are no pixels on the boundary of the valid region then the image edges are used.
+            this->edgesAsBoundary = !this->imageHasBoundaryPxls(inValidImgDS->GetRasterBand(1));
+
+            if(tileSize == 0)
+            {
+                this->performInMemoryFill(inDEMImgDS->GetRasterBand(1), inValidImgDS->GetRasterBand(1), outImgDS->GetRasterBand(1));
+            }
+            else
+            {
+                this->performTiledFill(inDEMImgDS->GetRasterBand(1), inValidImgDS->GetRasterBand(1), outImgDS->GetRasterBand(1), tileSize);
+            }
+        }
+        catch (rsgis::img::RSGISImageCalcException &e)
+        {
+            throw e;
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw rsgis::img::RSGISImageCalcException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw rsgis::img::RSGISImageCalcException(e.what());
+        }
+    }
+
+    void RSGISHydroDEMFillPriorityFlood::calcFillParameters(GDALDataset *inDEMImgDS, GDALDataset *inValidImgDS, bool calcBorderVal, long borderVal)
+    {
+        rsgis::img::ImageStats *stats = new rsgis::img::ImageStats();
+
+        int useNoData = false;
+        double noDataVal = inDEMImgDS->GetRasterBand(1)->GetNoDataValue(&useNoData);
+        if(useNoData)
+        {
+            std::cout << "Fill layer has a no data value of " << noDataVal << std::endl;
+        }
+
+        rsgis::img::RSGISImageStatistics imgStats;
+        imgStats.calcImageStatisticsMask(inDEMImgDS, inValidImgDS, 1, &stats, &noDataVal, useNoData, 1, calcBorderVal);
+        if(calcBorderVal)
+        {
+            if((stats->mean - stats->stddev) > stats->min)
+            {
+                borderVal = floor((stats->mean - stats->stddev)+0.5);
+            }
+            else
+            {
+                borderVal = floor((stats->mean)+0.5);
+            }
+            std::cout << "Calculated Border Value is " << borderVal << std::endl;
+        }
+
+        this->minVal = (long)stats->min;
+        this->maxVal = (long)stats->max;
+        this->borderVal = borderVal;
+        this->noDataVal = (useNoData)?noDataVal:0.0;
+        delete stats;
+
+        std::cout << "Range of Values [" << this->minVal << ", " << this->maxVal << "]" << std::endl;
+    }
+
+    bool RSGISHydroDEMFillPriorityFlood::imageHasBoundaryPxls(GDALRasterBand *validBand)
+    {
+        // As the pixels are 8-connected there is an invalid pixel next to a valid
+        // pixel if, and only if, the image contains both valid and invalid pixels.
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        validBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int nRows = (yBlockSize > 0)?yBlockSize:1;
+
+        std::vector<float> validRows(((size_t)this->imgWidth) * nRows);
+        bool foundValid = false;
+        bool foundInvalid = false;
+        for(unsigned int row = 0; row < this->imgHeight; row += nRows)
+        {
+            unsigned int nReadRows = std::min(nRows, this->imgHeight - row);
+            validBand->RasterIO(GF_Read, 0, row, this->imgWidth, nReadRows, validRows.data(), this->imgWidth, nReadRows, GDT_Float32, 0, 0);
+            size_t nPxls = ((size_t)this->imgWidth) * nReadRows;
+            for(size_t i = 0; i < nPxls; ++i)
+            {
+                if(validRows[i] == 1)
+                {
+                    foundValid = true;
+                }
+                else
+                {
+                    foundInvalid = true;
+                }
+            }
+            if(foundValid && foundInvalid)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void RSGISHydroDEMFillPriorityFlood::performInMemoryFill(GDALRasterBand *demBand, GDALRasterBand *validBand, GDALRasterBand *outBand)
+    {
+        const long width = this->imgWidth;
+        const long height = this->imgHeight;
+        size_t nPxls = ((size_t)width) * height;
+
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        outBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int nRows = (yBlockSize > 0)?yBlockSize:1;
+
+        // The DEM values are replaced by the filled values.
+        std::vector<long> elev(nPxls);
+        std::vector<unsigned char> pxlClass(nPxls);
+
+        std::cout << "Read the input images.\n";
+        std::vector<double> rowsBuffer(((size_t)width) * nRows);
+        std::vector<float> validRows(((size_t)width) * nRows);
+        for(long row = 0; row < height; row += nRows)
+        {
+            unsigned int nReadRows = std::min((long)nRows, height - row);
+            size_t rowsOff = ((size_t)row) * width;
+            size_t nRowsPxls = ((size_t)width) * nReadRows;
+            demBand->RasterIO(GF_Read, 0, row, width, nReadRows, rowsBuffer.data(), width, nReadRows, GDT_Float64, 0, 0);
+            validBand->RasterIO(GF_Read, 0, row, width, nReadRows, validRows.data(), width, nReadRows, GDT_Float32, 0, 0);
+            for(size_t i = 0; i < nRowsPxls; ++i)
+            {
+                elev[rowsOff+i] = (long)rowsBuffer[i];
+                pxlClass[rowsOff+i] = (validRows[i] == 1)?PF_PXL_VALID:PF_PXL_NODATA;
+            }
+        }
+        std::vector<float>().swap(validRows);
+
+        std::vector<unsigned char> state(nPxls, PF_STATE_BARRIER);
+        RSGISPackedPxlPriorityQueue pxlQ(this->minVal, this->maxVal, nPxls);
+        std::deque<uint64_t> pitQ;
+
+        std::cout << "Find boundary pixels.\n";
+        if(this->edgesAsBoundary)
+        {
+            for(long y = 0; y < height; ++y)
+            {
+                for(long x = 0; x < width; ++x)
+                {
+                    if((x == 0) || (y == 0) || (x == (width-1)) || (y == (height-1)))
+                    {
+                        pxlClass[(y*width)+x] = PF_PXL_BOUNDARY;
+                    }
+                }
+            }
+        }
+        for(long y = 0; y < height; ++y)
+        {
+            for(long x = 0; x < width; ++x)
+            {
+                size_t idx = (((size_t)y) * width) + x;
+                if(pxlClass[idx] == PF_PXL_VALID)
+                {
+                    state[idx] = PF_STATE_OPEN;
+                }
+                else if(pxlClass[idx] == PF_PXL_NODATA)
+                {
+                    for(long ny = std::max(y-1, 0L); (ny <= (y+1)) && (ny < height); ++ny)
+                    {
+                        for(long nx = std::max(x-1, 0L); (nx <= (x+1)) && (nx < width); ++nx)
+                        {
+                            if(pxlClass[(ny*width)+nx] == PF_PXL_VALID)
+                            {
+                                pxlClass[idx] = PF_PXL_BOUNDARY;
+                            }
+                        }
+                    }
+                }
+
+                if(pxlClass[idx] == PF_PXL_BOUNDARY)
+                {
+                    state[idx] = PF_STATE_CLOSED;
+                    elev[idx] = this->minVal;
+                    pxlQ.push(this->minVal, idx);
+                }
+            }
+        }
+
+        std::cout << "Perform Fill:\n";
+        rsgis_tqdm pbar;
+        long level = this->minVal;
+        uint64_t idx = 0;
+        long fillVal = 0;
+        while(true)
+        {
+            if(!pitQ.empty())
+            {
+                idx = pitQ.front();
+                pitQ.pop_front();
+                level = elev[idx];
+            }
+            else if(!pxlQ.empty())
+            {
+                pxlQ.pop(&level, &idx);
+                pbar.progress(level - this->minVal, (this->maxVal - this->minVal)+1);
+            }
+            else
+            {
+                break;
+            }
+
+            long x = idx % width;
+            long y = idx / width;
+            for(long ny = std::max(y-1, 0L); (ny <= (y+1)) && (ny < height); ++ny)
+            {
+                for(long nx = std::max(x-1, 0L); (nx <= (x+1)) && (nx < width); ++nx)
+                {
+                    size_t nIdx = (((size_t)ny) * width) + nx;
+                    if(state[nIdx] == PF_STATE_OPEN)
+                    {
+                        fillVal = std::max(level, elev[nIdx]);
+                        elev[nIdx] = fillVal;
+                        state[nIdx] = PF_STATE_CLOSED;
+                        // Pixels filled to the maximum value are not expanded (as in RSGISHydroDEMFillSoilleGratin94).
+                        if(fillVal == level)
+                        {
+                            pitQ.push_back(nIdx);
+                        }
+                        else if(fillVal < this->maxVal)
+                        {
+                            pxlQ.push(fillVal, nIdx);
+                        }
+                    }
+                }
+            }
+        }
+        pbar.finish();
+
+        std::cout << "Write the output image.\n";
+        for(long row = 0; row < height; row += nRows)
+        {
+            unsigned int nWriteRows = std::min((long)nRows, height - row);
+            size_t rowsOff = ((size_t)row) * width;
+            size_t nRowsPxls = ((size_t)width) * nWriteRows;
+            for(size_t i = 0; i < nRowsPxls; ++i)
+            {
+                if(pxlClass[rowsOff+i] == PF_PXL_BOUNDARY)
+                {
+                    rowsBuffer[i] = this->borderVal;
+                }
+                else if(pxlClass[rowsOff+i] == PF_PXL_NODATA)
+                {
+                    rowsBuffer[i] = this->noDataVal;
+                }
+                else if(state[rowsOff+i] == PF_STATE_OPEN)
+                {
+                    // The pixel could not be reached from the boundary.
+                    rowsBuffer[i] = this->maxVal;
+                }
+                else
+                {
+                    rowsBuffer[i] = elev[rowsOff+i];
+                }
+            }
+            outBand->RasterIO(GF_Write, 0, row, width, nWriteRows, rowsBuffer.data(), width, nWriteRows, GDT_Float64, 0, 0);
+        }
+    }
+
+    void RSGISHydroDEMFillPriorityFlood::performTiledFill(GDALRasterBand *demBand, GDALRasterBand *validBand, GDALRasterBand *outBand, unsigned int tileSize)
+    {
+        unsigned int nXTiles = (this->imgWidth + tileSize - 1) / tileSize;
+        unsigned int nYTiles = (this->imgHeight + tileSize - 1) / tileSize;
+        unsigned int nTiles = nXTiles * nYTiles;
+
+        RSGISPriorityFloodTile tile;
+        std::vector<RSGISPriorityFloodTileEdges> tileEdges(nTiles);
+        std::map<std::pair<unsigned long, unsigned long>, long> spillGraph;
+        unsigned long numLabels = PF_BOUNDARY_LABEL + 1;
+
+        auto setTileExtent = [&](unsigned int tX, unsigned int tY)
+        {
+            tile.xOff = tX * tileSize;
+            tile.yOff = tY * tileSize;
+            tile.xSize = std::min(tileSize, this->imgWidth - tile.xOff);
+            tile.ySize = std::min(tileSize, this->imgHeight - tile.yOff);
+        };
+        auto globalLabel = [](unsigned long label, unsigned long labelOffset)
+        {
+            return (label <= PF_BOUNDARY_LABEL)?label:(label + labelOffset);
+        };
+
+        // Stage 1: flood each tile from its edges and the boundary of the valid region,
+        // recording where the labelled regions spill into one another.
+        std::cout << "Perform Fill (Stage 1 of 3):\n";
+        rsgis_tqdm pbar;
+        for(unsigned int tY = 0; tY < nYTiles; ++tY)
+        {
+            for(unsigned int tX = 0; tX < nXTiles; ++tX)
+            {
+                pbar.progress((tY*nXTiles)+tX, nTiles);
+                setTileExtent(tX, tY);
+                this->readTile(&tile, demBand, validBand);
+                this->floodTile(&tile);
+
+                RSGISPriorityFloodTileEdges *edges = &tileEdges[(tY*nXTiles)+tX];
+                edges->labelOffset = numLabels - (PF_BOUNDARY_LABEL + 1);
+                numLabels += tile.numLabels;
+
+                for(std::map<std::pair<unsigned int, unsigned int>, long>::iterator iterEdges = tile.spillEdges.begin(); iterEdges != tile.spillEdges.end(); ++iterEdges)
+                {
+                    this->addSpillEdge(&spillGraph, globalLabel((*iterEdges).first.first, edges->labelOffset), globalLabel((*iterEdges).first.second, edges->labelOffset), (*iterEdges).second);
+                }
+
+                // Store the top, bottom, left and right edges of the tile.
+                unsigned int haloWidth = tile.xSize + 2;
+                for(unsigned int side = 0; side < 4; ++side)
+                {
+                    unsigned int nEdgePxls = (side < 2)?tile.xSize:tile.ySize;
+                    edges->edgeLabels[side].resize(nEdgePxls);
+                    edges->edgeFill[side].resize(nEdgePxls);
+                    for(unsigned int i = 0; i < nEdgePxls; ++i)
+                    {
+                        size_t hIdx = 0;
+                        if(side == 0)
+                        {
+                            hIdx = haloWidth + (i+1);
+                        }
+                        else if(side == 1)
+                        {
+                            hIdx = (((size_t)tile.ySize) * haloWidth) + (i+1);
+                        }
+                        else if(side == 2)
+                        {
+                            hIdx = (((size_t)(i+1)) * haloWidth) + 1;
+                        }
+                        else
+                        {
+                            hIdx = (((size_t)(i+1)) * haloWidth) + tile.xSize;
+                        }
+
+                        if((tile.pxlClass[hIdx] == PF_PXL_VALID) && (tile.labels[hIdx] != 0))
+                        {
+                            edges->edgeLabels[side][i] = globalLabel(tile.labels[hIdx], edges->labelOffset);
+                        }
+                        else
+                        {
+                            edges->edgeLabels[side][i] = 0;
+                        }
+                        edges->edgeFill[side][i] = tile.fill[hIdx];
+                    }
+                }
+            }
+        }
+        pbar.finish();
+
+        // Stage 2: join the tiles and find the level at which each labelled region spills
+        // to the boundary of the valid region.
+        std::cout << "Perform Fill (Stage 2 of 3):\n";
+        auto getEdgePxl = [&](unsigned int x, unsigned int y, unsigned long *label, long *fill)
+        {
+            unsigned int tX = x / tileSize;
+            unsigned int tY = y / tileSize;
+            setTileExtent(tX, tY);
+            RSGISPriorityFloodTileEdges *edges = &tileEdges[(tY*nXTiles)+tX];
+            unsigned int lX = x - tile.xOff;
+            unsigned int lY = y - tile.yOff;
+            if(lY == 0)
+            {
+                *label = edges->edgeLabels[0][lX];
+                *fill = edges->edgeFill[0][lX];
+            }
+            else if(lY == (tile.ySize-1))
+            {
+                *label = edges->edgeLabels[1][lX];
+                *fill = edges->edgeFill[1][lX];
+            }
+            else if(lX == 0)
+            {
+                *label = edges->edgeLabels[2][lY];
+                *fill = edges->edgeFill[2][lY];
+            }
+            else
+            {
+                *label = edges->edgeLabels[3][lY];
+                *fill = edges->edgeFill[3][lY];
+            }
+        };
+        auto joinPxls = [&](unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
+        {
+            unsigned long label1 = 0;
+            unsigned long label2 = 0;
+            long fill1 = 0;
+            long fill2 = 0;
+            getEdgePxl(x1, y1, &label1, &fill1);
+            getEdgePxl(x2, y2, &label2, &fill2);
+            if((label1 != 0) && (label2 != 0) && (label1 != label2))
+            {
+                this->addSpillEdge(&spillGraph, label1, label2, std::max(fill1, fill2));
+            }
+        };
+        for(unsigned int tY = 0; tY < nYTiles; ++tY)
+        {
+            for(unsigned int tX = 0; tX < nXTiles; ++tX)
+            {
+                setTileExtent(tX, tY);
+                unsigned int xOff = tile.xOff;
+                unsigned int yOff = tile.yOff;
+                unsigned int xEnd = tile.xOff + tile.xSize;
+                unsigned int yEnd = tile.yOff + tile.ySize;
+                if(xEnd < this->imgWidth)
+                {
+                    for(unsigned int y = yOff; y < yEnd; ++y)
+                    {
+                        for(long nY = ((long)y)-1; nY <= ((long)y)+1; ++nY)
+                        {
+                            if((nY >= 0) && (nY < this->imgHeight))
+                            {
+                                joinPxls(xEnd-1, y, xEnd, nY);
+                            }
+                        }
+                    }
+                }
+                if(yEnd < this->imgHeight)
+                {
+                    for(unsigned int x = xOff; x < xEnd; ++x)
+                    {
+                        for(long nX = ((long)x)-1; nX <= ((long)x)+1; ++nX)
+                        {
+                            if((nX >= 0) && (nX < this->imgWidth))
+                            {
+                                joinPxls(x, yEnd-1, nX, yEnd);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<std::vector<std::pair<unsigned long, long> > > spillNeighbours(numLabels);
+        for(std::map<std::pair<unsigned long, unsigned long>, long>::iterator iterEdges = spillGraph.begin(); iterEdges != spillGraph.end(); ++iterEdges)
+        {
+            spillNeighbours[(*iterEdges).first.first].push_back(std::pair<unsigned long, long>((*iterEdges).first.second, (*iterEdges).second));
+            spillNeighbours[(*iterEdges).first.second].push_back(std::pair<unsigned long, long>((*iterEdges).first.first, (*iterEdges).second));
+        }
+        std::map<std::pair<unsigned long, unsigned long>, long>().swap(spillGraph);
+
+        const long unreachedLevel = std::numeric_limits<long>::max();
+        std::vector<long> spillLevels(numLabels, unreachedLevel);
+        std::priority_queue<std::pair<long, unsigned long>, std::vector<std::pair<long, unsigned long> >, std::greater<std::pair<long, unsigned long> > > labelQ;
+        spillLevels[PF_BOUNDARY_LABEL] = this->minVal;
+        labelQ.push(std::pair<long, unsigned long>(this->minVal, PF_BOUNDARY_LABEL));
+        while(!labelQ.empty())
+        {
+            long level = labelQ.top().first;
+            unsigned long label = labelQ.top().second;
+            labelQ.pop();
+            if(level > spillLevels[label])
+            {
+                continue;
+            }
+            for(std::vector<std::pair<unsigned long, long> >::iterator iterNeighbours = spillNeighbours[label].begin(); iterNeighbours != spillNeighbours[label].end(); ++iterNeighbours)
+            {
+                long nLevel = std::max(level, (*iterNeighbours).second);
+                if(nLevel < spillLevels[(*iterNeighbours).first])
+                {
+                    spillLevels[(*iterNeighbours).first] = nLevel;
+                    labelQ.push(std::pair<long, unsigned long>(nLevel, (*iterNeighbours).first));
+                }
+            }
+        }
+        std::vector<std::vector<std::pair<unsigned long, long> > >().swap(spillNeighbours);
+
+        // Stage 3: re-flood each tile and raise the pixels to the spill level of their region.
+        std::cout << "Perform Fill (Stage 3 of 3):\n";
+        std::vector<double> outTile;
+        for(unsigned int tY = 0; tY < nYTiles; ++tY)
+        {
+            for(unsigned int tX = 0; tX < nXTiles; ++tX)
+            {
+                pbar.progress((tY*nXTiles)+tX, nTiles);
+                setTileExtent(tX, tY);
+                this->readTile(&tile, demBand, validBand);
+                this->floodTile(&tile);
+
+                unsigned long labelOffset = tileEdges[(tY*nXTiles)+tX].labelOffset;
+                unsigned int haloWidth = tile.xSize + 2;
+                outTile.resize(((size_t)tile.xSize) * tile.ySize);
+                for(unsigned int y = 0; y < tile.ySize; ++y)
+                {
+                    for(unsigned int x = 0; x < tile.xSize; ++x)
+                    {
+                        size_t hIdx = (((size_t)(y+1)) * haloWidth) + (x+1);
+                        double outVal = this->noDataVal;
+                        if(tile.pxlClass[hIdx] == PF_PXL_BOUNDARY)
+                        {
+                            outVal = this->borderVal;
+                        }
+                        else if(tile.pxlClass[hIdx] == PF_PXL_VALID)
+                        {
+                            long spillLevel = unreachedLevel;
+                            if(tile.labels[hIdx] != 0)
+                            {
+                                spillLevel = spillLevels[globalLabel(tile.labels[hIdx], labelOffset)];
+                            }
+                            // Pixels which cannot be reached from the boundary are given the maximum value.
+                            outVal = (spillLevel == unreachedLevel)?this->maxVal:std::max(tile.fill[hIdx], spillLevel);
+                        }
+                        outTile[(((size_t)y) * tile.xSize) + x] = outVal;
+                    }
+                }
+                outBand->RasterIO(GF_Write, tile.xOff, tile.yOff, tile.xSize, tile.ySize, outTile.data(), tile.xSize, tile.ySize, GDT_Float64, 0, 0);
+            }
+        }
+        pbar.finish();
+    }
+
+    void RSGISHydroDEMFillPriorityFlood::readTile(RSGISPriorityFloodTile *tile, GDALRasterBand *demBand, GDALRasterBand *validBand)
+    {
+        unsigned int haloWidth = tile->xSize + 2;
+        unsigned int haloHeight = tile->ySize + 2;
+        size_t nHaloPxls = ((size_t)haloWidth) * haloHeight;
+        tile->valid.assign(nHaloPxls, PF_PXL_OUTSIDE);
+        tile->dem.assign(nHaloPxls, this->minVal);
+
+        // Read the valid mask for the tile and the halo (clipped to the image).
+        unsigned int readXOff = (tile->xOff > 0)?(tile->xOff-1):0;
+        unsigned int readYOff = (tile->yOff > 0)?(tile->yOff-1):0;
+        unsigned int readXEnd = std::min(tile->xOff + tile->xSize + 1, this->imgWidth);
+        unsigned int readYEnd = std::min(tile->yOff + tile->ySize + 1, this->imgHeight);
+        unsigned int readXSize = readXEnd - readXOff;
+        unsigned int readYSize = readYEnd - readYOff;
+
+        std::vector<float> validData(((size_t)readXSize) * readYSize);
+        validBand->RasterIO(GF_Read, readXOff, readYOff, readXSize, readYSize, validData.data(), readXSize, readYSize, GDT_Float32, 0, 0);
+        for(unsigned int y = 0; y < readYSize; ++y)
+        {
+            for(unsigned int x = 0; x < readXSize; ++x)
+            {
+                size_t hIdx = (((size_t)((readYOff + y + 1) - tile->yOff)) * haloWidth) + ((readXOff + x + 1) - tile->xOff);
+                tile->valid[hIdx] = (validData[(((size_t)y) * readXSize) + x] == 1)?PF_PXL_VALID:PF_PXL_NODATA;
+            }
+        }
+
+        // The DEM values are limited to the range of the valid data so the levels fit in the queue.
+        std::vector<double> demData(((size_t)tile->xSize) * tile->ySize);
+        demBand->RasterIO(GF_Read, tile->xOff, tile->yOff, tile->xSize, tile->ySize, demData.data(), tile->xSize, tile->ySize, GDT_Float64, 0, 0);
+        for(unsigned int y = 0; y < tile->ySize; ++y)
+        {
+            for(unsigned int x = 0; x < tile->xSize; ++x)
+            {
+                long demVal = (long)demData[(((size_t)y) * tile->xSize) + x];
+                tile->dem[(((size_t)(y+1)) * haloWidth) + (x+1)] = std::min(std::max(demVal, this->minVal), this->maxVal);
+            }
+        }
+    }
+
+    void RSGISHydroDEMFillPriorityFlood::floodTile(RSGISPriorityFloodTile *tile)
+    {
+        const long haloWidth = tile->xSize + 2;
+        const long haloHeight = tile->ySize + 2;
+        size_t nHaloPxls = ((size_t)haloWidth) * haloHeight;
+
+        tile->pxlClass.assign(nHaloPxls, PF_PXL_OUTSIDE);
+        tile->fill.assign(nHaloPxls, this->minVal);
+        tile->labels.assign(nHaloPxls, 0);
+        tile->spillEdges.clear();
+        std::vector<unsigned char> state(nHaloPxls, PF_STATE_BARRIER);
+
+        RSGISPackedPxlPriorityQueue pxlQ(this->minVal, this->maxVal, nHaloPxls);
+        std::deque<uint64_t> pitQ;
+
+        // Classify the pixels; pixels outside of the valid region but with a valid neighbour
+        // are on the boundary, which is where the flood starts.
+        for(long y = 0; y < haloHeight; ++y)
+        {
+            for(long x = 0; x < haloWidth; ++x)
+            {
+                size_t hIdx = (((size_t)y) * haloWidth) + x;
+                if(tile->valid[hIdx] == PF_PXL_OUTSIDE)
+                {
+                    continue;
+                }
+
+                long imgX = ((long)tile->xOff) + x - 1;
+                long imgY = ((long)tile->yOff) + y - 1;
+                bool imgEdge = (imgX == 0) || (imgY == 0) || (imgX == (((long)this->imgWidth)-1)) || (imgY == (((long)this->imgHeight)-1));
+                if(this->edgesAsBoundary && imgEdge)
+                {
+                    tile->pxlClass[hIdx] = PF_PXL_BOUNDARY;
+                }
+                else if(tile->valid[hIdx] == PF_PXL_VALID)
+                {
+                    tile->pxlClass[hIdx] = PF_PXL_VALID;
+                }
+                else
+                {
+                    tile->pxlClass[hIdx] = PF_PXL_NODATA;
+                    for(long nY = std::max(y-1, 0L); (nY <= (y+1)) && (nY < haloHeight); ++nY)
+                    {
+                        for(long nX = std::max(x-1, 0L); (nX <= (x+1)) && (nX < haloWidth); ++nX)
+                        {
+                            if(tile->valid[(nY*haloWidth)+nX] == PF_PXL_VALID)
+                            {
+                                tile->pxlClass[hIdx] = PF_PXL_BOUNDARY;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // Seed the flood with the boundary pixels (within the tile and halo) and the
+        // pixels along the tile edges which are connected to valid pixels in other tiles.
+        for(long y = 0; y < haloHeight; ++y)
+        {
+            for(long x = 0; x < haloWidth; ++x)
+            {
+                size_t hIdx = (((size_t)y) * haloWidth) + x;
+                bool inHalo = (x == 0) || (y == 0) || (x == (haloWidth-1)) || (y == (haloHeight-1));
+                if(tile->pxlClass[hIdx] == PF_PXL_BOUNDARY)
+                {
+                    state[hIdx] = PF_STATE_CLOSED;
+                    tile->labels[hIdx] = PF_BOUNDARY_LABEL;
+                    pxlQ.push(this->minVal, hIdx);
+                }
+                else if((tile->pxlClass[hIdx] == PF_PXL_VALID) && !inHalo)
+                {
+                    state[hIdx] = PF_STATE_OPEN;
+                    bool tileEdgeSeed = false;
+                    for(long nY = y-1; nY <= (y+1); ++nY)
+                    {
+                        for(long nX = x-1; nX <= (x+1); ++nX)
+                        {
+                            bool nInHalo = (nX == 0) || (nY == 0) || (nX == (haloWidth-1)) || (nY == (haloHeight-1));
+                            if(nInHalo && (tile->pxlClass[(nY*haloWidth)+nX] == PF_PXL_VALID))
+                            {
+                                tileEdgeSeed = true;
+                            }
+                        }
+                    }
+                    if(tileEdgeSeed)
+                    {
+                        state[hIdx] = PF_STATE_CLOSED;
+                        tile->fill[hIdx] = tile->dem[hIdx];
+                        pxlQ.push(tile->fill[hIdx], hIdx);
+                    }
+                }
+            }
+        }
+
+        unsigned int nextLabel = PF_BOUNDARY_LABEL + 1;
+        long level = this->minVal;
+        uint64_t hIdx = 0;
+        while(true)
+        {
+            if(!pitQ.empty())
+            {
+                hIdx = pitQ.front();
+                pitQ.pop_front();
+            }
+            else if(!pxlQ.empty())
+            {
+                pxlQ.pop(&level, &hIdx);
+            }
+            else
+            {
+                break;
+            }
+            level = tile->fill[hIdx];
+
+            // A tile edge pixel which has not been reached by another region starts a new region.
+            if(tile->labels[hIdx] == 0)
+            {
+                tile->labels[hIdx] = nextLabel++;
+            }
+            unsigned int label = tile->labels[hIdx];
+
+            long x = hIdx % haloWidth;
+            long y = hIdx / haloWidth;
+            for(long nY = std::max(y-1, 0L); (nY <= (y+1)) && (nY < haloHeight); ++nY)
+            {
+                for(long nX = std::max(x-1, 0L); (nX <= (x+1)) && (nX < haloWidth); ++nX)
+                {
+                    size_t nIdx = (nY*haloWidth)+nX;
+                    if(state[nIdx] == PF_STATE_OPEN)
+                    {
+                        tile->fill[nIdx] = std::max(level, tile->dem[nIdx]);
+                        tile->labels[nIdx] = label;
+                        state[nIdx] = PF_STATE_CLOSED;
+                        if(tile->fill[nIdx] == level)
+                        {
+                            pitQ.push_back(nIdx);
+                        }
+                        else
+                        {
+                            pxlQ.push(tile->fill[nIdx], nIdx);
+                        }
+                    }
+                    else if(state[nIdx] == PF_STATE_CLOSED)
+                    {
+                        if(tile->labels[nIdx] == 0)
+                        {
+                            tile->labels[nIdx] = label;
+                        }
+                        else if(tile->labels[nIdx] != label)
+                        {
+                            std::pair<unsigned int, unsigned int> edge(std::min(label, tile->labels[nIdx]), std::max(label, tile->labels[nIdx]));
+                            long spillLevel = std::max(level, tile->fill[nIdx]);
+                            std::map<std::pair<unsigned int, unsigned int>, long>::iterator iterEdge = tile->spillEdges.find(edge);
+                            if(iterEdge == tile->spillEdges.end())
+                            {
+                                tile->spillEdges[edge] = spillLevel;
+                            }
+                            else if(spillLevel < (*iterEdge).second)
+                            {
+                                (*iterEdge).second = spillLevel;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        tile->numLabels = nextLabel - (PF_BOUNDARY_LABEL + 1);
+    }
+
+    void RSGISHydroDEMFillPriorityFlood::addSpillEdge(std::map<std::pair<unsigned long, unsigned long>, long> *edges, unsigned long labelA, unsigned long labelB, long level)
+    {
+        std::pair<unsigned long, unsigned long> edge(std::min(labelA, labelB), std::max(labelA, labelB));
+        std::map<std::pair<unsigned long, unsigned long>, long>::iterator iterEdge = edges->find(edge);
+        if(iterEdge == edges->end())
+        {
+            (*edges)[edge] = level;
+        }
+        else if(level < (*iterEdge).second)
+        {
+            (*iterEdge).second = level;
+        }
+    }
+
+    RSGISHydroDEMFillPriorityFlood::~RSGISHydroDEMFillPriorityFlood()
+    {
+
+    }
+
+}}
+
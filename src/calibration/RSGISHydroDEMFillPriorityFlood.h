@@ -0,0 +1,157 @@
+/*
+ *  RSGISHydroDEMFillPriorityFlood.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib. All rights reserved.
+ *  This file is part of RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  Priority-flood implementation of the local minima filling provided by
+ *  RSGISHydroDEMFillSoilleGratin94 (producing the same output) using contiguous
+ *  in memory buffers and a packed 64 bit priority queue. A tiled variant, for
+ *  images larger than the available memory, is also provided which follows
+ *  the approach of:
+ *
+ *  Barnes, R. (2016). Parallel priority-flood depression filling for trillion
+ *  cell digital elevation models on desktops or clusters. Computers & Geosciences.
+ *  96. 56-68.
+ *
+ */
+
+#ifndef RSGISHydroDEMFillPriorityFlood_h
+#define RSGISHydroDEMFillPriorityFlood_h
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <vector>
+#include <deque>
+#include <map>
+#include <queue>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <stdint.h>
+
+#include "gdal_priv.h"
+
+#include "common/rsgis-tqdm.h"
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageUtils.h"
+#include "img/RSGISImageStatistics.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_calib_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace calib{
+
+    /**
+     * A min priority queue of pixels where the level and pixel index are packed
+     * into a single 64 bit value so the queue is a flat array of integers.
+     */
+    class DllExport RSGISPackedPxlPriorityQueue
+    {
+    public:
+        RSGISPackedPxlPriorityQueue(long minLevel, long maxLevel, uint64_t maxIdx);
+        void push(long level, uint64_t idx){this->pxlQ.push((((uint64_t)(level - this->minLevel)) << this->idxBits) | idx);};
+        void pop(long *level, uint64_t *idx)
+        {
+            uint64_t val = this->pxlQ.top();
+            this->pxlQ.pop();
+            *level = ((long)(val >> this->idxBits)) + this->minLevel;
+            *idx = val & this->idxMask;
+        };
+        bool empty(){return this->pxlQ.empty();};
+        ~RSGISPackedPxlPriorityQueue(){};
+    protected:
+        std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t> > pxlQ;
+        long minLevel;
+        unsigned int idxBits;
+        uint64_t idxMask;
+    };
+
+    /** A tile of the image (with a 1 pixel halo) processed by the tiled fill. */
+    struct DllExport RSGISPriorityFloodTile
+    {
+        unsigned int xOff;
+        unsigned int yOff;
+        unsigned int xSize;
+        unsigned int ySize;
+        std::vector<unsigned char> valid;
+        std::vector<long> dem;
+        std::vector<unsigned char> pxlClass;
+        std::vector<long> fill;
+        std::vector<unsigned int> labels;
+        unsigned int numLabels;
+        std::map<std::pair<unsigned int, unsigned int>, long> spillEdges;
+    };
+
+    /** The labels and fill values of the pixels around the edge of a tile. */
+    struct DllExport RSGISPriorityFloodTileEdges
+    {
+        unsigned long labelOffset;
+        std::vector<unsigned long> edgeLabels[4];
+        std::vector<long> edgeFill[4];
+    };
+
+    class DllExport RSGISHydroDEMFillPriorityFlood
+    {
+    public:
+        RSGISHydroDEMFillPriorityFlood();
+        /**
+         * Fill the local minima in the DEM within the valid region (1 == valid). The
+         * whole image is processed in memory unless a tileSize (in pixels) is provided,
+         * in which case the image is processed as tiles of tileSize x tileSize pixels
+         * and only a single tile is held in memory at a time. Note, as the tiled fill
+         * limits the DEM values to the range of the valid data, DEM values above the
+         * maximum (i.e., no data values) within the valid region will be output as the
+         * maximum rather than the input value.
+         */
+        void performPriorityFloodFill(GDALDataset *inDEMImgDS, GDALDataset *inValidImgDS, GDALDataset *outImgDS, bool calcBorderVal, long borderVal=0, unsigned int tileSize=0);
+        ~RSGISHydroDEMFillPriorityFlood();
+    protected:
+        void calcFillParameters(GDALDataset *inDEMImgDS, GDALDataset *inValidImgDS, bool calcBorderVal, long borderVal);
+        bool imageHasBoundaryPxls(GDALRasterBand *validBand);
+        void performInMemoryFill(GDALRasterBand *demBand, GDALRasterBand *validBand, GDALRasterBand *outBand);
+        void performTiledFill(GDALRasterBand *demBand, GDALRasterBand *validBand, GDALRasterBand *outBand, unsigned int tileSize);
+        void readTile(RSGISPriorityFloodTile *tile, GDALRasterBand *demBand, GDALRasterBand *validBand);
+        void floodTile(RSGISPriorityFloodTile *tile);
+        void addSpillEdge(std::map<std::pair<unsigned long, unsigned long>, long> *edges, unsigned long labelA, unsigned long labelB, long level);
+        long minVal;
+        long maxVal;
+        long borderVal;
+        double noDataVal;
+        bool edgesAsBoundary;
+        unsigned int imgWidth;
+        unsigned int imgHeight;
+    };
+
+}}
+
+#endif
+
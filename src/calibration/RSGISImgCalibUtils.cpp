@@ -25,7 +25,7 @@
 
 namespace rsgis{namespace calib{
     
-    void RSGISImgCalibUtils::calcNadirImgViewAngle(GDALDataset *imgFPDataset, std::string outViewAngleImg, std::string gdalFormat, double sateAltitude, std::string minXXCol, std::string minXYCol, std::string maxXXCol, std::string maxXYCol, std::string minYXCol, std::string minYYCol, std::string maxYXCol, std::string maxYYCol) 
+    void RSGISImgCalibUtils::calcNadirImgViewAngle(GDALDataset *imgFPDataset, std::string outViewAngleImg, std::string gdalFormat, double sateAltitude, std::string minXXCol, std::string minXYCol, std::string maxXXCol, std::string maxXYCol, std::string minYXCol, std::string minYYCol, std::string maxYXCol, std::string maxYYCol, unsigned int gridSpacing, double maxGridError) 
     {
         try
         {
@@ -58,10 +58,26 @@ namespace rsgis{namespace calib{
             double clSlope = diffY / diffX;
             double clOff = cenLineTY - (clSlope*cenLineTX);
             
-            RSGISCalcNadirViewAngle calcNadirViewAngle = RSGISCalcNadirViewAngle(clSlope, clOff, sateAltitude);
+            RSGISGeometryGrid *viewAngleGrid = NULL;
+            RSGISNadirViewAngleGeometry viewGeom = RSGISNadirViewAngleGeometry(clSlope, clOff, sateAltitude);
+            if(gridSpacing > 0)
+            {
+                double transform[6];
+                imgFPDataset->GetGeoTransform(transform);
+                viewAngleGrid = new RSGISGeometryGrid(imgFPDataset->GetRasterXSize(), imgFPDataset->GetRasterYSize(), transform, gridSpacing);
+                viewAngleGrid->calcGrid(&viewGeom, maxGridError);
+                std::cout << "View angle grid: " << viewAngleGrid->getNumExactCells() << " of " << viewAngleGrid->getNumCells() << " cells calculated for every pixel, max. estimated error " << viewAngleGrid->getMaxError(0) << " degrees\n";
+            }
+            
+            RSGISCalcNadirViewAngle calcNadirViewAngle = RSGISCalcNadirViewAngle(clSlope, clOff, sateAltitude, viewAngleGrid);
             rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&calcNadirViewAngle, "", true);
             calcImage.calcImageExtent(&imgFPDataset, 1, outViewAngleImg, gdalFormat, GDT_Float32);
             
+            if(viewAngleGrid != NULL)
+            {
+                delete viewAngleGrid;
+            }
+            
         }
         catch(RSGISException &e)
         {
@@ -74,13 +90,35 @@ namespace rsgis{namespace calib{
     }
     
     
-    RSGISCalcNadirViewAngle::RSGISCalcNadirViewAngle(double clSlope, double clOff, double sateAltitude):rsgis::img::RSGISCalcImageValue(1)
+    RSGISNadirViewAngleGeometry::RSGISNadirViewAngleGeometry(double clSlope, double clOff, double sateAltitude):RSGISGeometryGridFunction(1)
     {
         this->clSlope = clSlope;
         this->clOff = clOff;
         this->sateAltitude = sateAltitude;
     }
     
+    void RSGISNadirViewAngleGeometry::calcGeometry(double x, double y, double *vals)
+    {
+        double orthSlope = -1/(clSlope);
+        double orthLineOff = y-(orthSlope*x);
+        
+        double intPtX = (orthLineOff-clOff)/(clSlope-orthSlope);
+        double intPtY = (intPtX*clSlope) + clOff;
+        
+        double dist = sqrt((intPtX - x)*(intPtX - x) + (intPtY - y)*(intPtY - y));
+        
+        double angleDeg = atan(sateAltitude/dist) * 180 / 3.141592653589793; // Divided by PI
+        
+        vals[0] = 90 - angleDeg; // From Sensor point of view.
+    }
+    
+    
+    RSGISCalcNadirViewAngle::RSGISCalcNadirViewAngle(double clSlope, double clOff, double sateAltitude, RSGISGeometryGrid *grid):rsgis::img::RSGISCalcImageValue(1), viewGeom(clSlope, clOff, sateAltitude)
+    {
+        this->grid = grid;
+        this->gridRow = -1;
+    }
+    
     void RSGISCalcNadirViewAngle::calcImageValue(float *bandValues, int numBands, double *output, OGREnvelope extent)
     {
         if(numBands != 1)
@@ -98,17 +136,24 @@ namespace rsgis{namespace calib{
             double ptX = extent.MinX + (extent.MaxX - extent.MinX)/2;
             double ptY = extent.MinY + (extent.MaxY - extent.MinY)/2;
             
-            double orthSlope = -1/(clSlope);
-            double orthLineOff = ptY-(orthSlope*ptX);
-            
-            double intPtX = (orthLineOff-clOff)/(clSlope-orthSlope);
-            double intPtY = (intPtX*clSlope) + clOff;
-            
-            double dist = sqrt((intPtX - ptX)*(intPtX - ptX) + (intPtY - ptY)*(intPtY - ptY));
-
-            double angleDeg = atan(sateAltitude/dist) * 180 / 3.141592653589793; // Divided by PI
-            
-            output[0] = 90 - angleDeg; // From Sensor point of view.
+            unsigned int col = 0;
+            unsigned int row = 0;
+            if((this->grid != NULL) && this->grid->getPixel(ptX, ptY, &col, &row))
+            {
+                // The pixels are processed a row at a time so the whole row is
+                // interpolated when the first pixel of a row is reached.
+                if(this->gridRow != ((long)row))
+                {
+                    this->rowVals.resize(this->grid->getWidth());
+                    this->grid->interpolateRow(row, 0, 0, this->grid->getWidth(), this->rowVals.data());
+                    this->gridRow = row;
+                }
+                output[0] = this->rowVals[col];
+            }
+            else
+            {
+                this->viewGeom.calcGeometry(ptX, ptY, output);
+            }
         }
     }
     
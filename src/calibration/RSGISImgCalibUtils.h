@@ -26,6 +26,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include <cmath>
 
 #include "gdal_priv.h"
@@ -37,6 +38,8 @@
 
 #include "rastergis/RSGISRasterAttUtils.h"
 
+#include "calibration/RSGISGeometryGrid.h"
+
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
 #undef DllExport
@@ -57,23 +60,52 @@ namespace rsgis{namespace calib{
     {
     public:
         RSGISImgCalibUtils(){};
-        void calcNadirImgViewAngle(GDALDataset *imgFPDataset, std::string outViewAngleImg, std::string gdalFormat, double sateAltitude, std::string minXXCol, std::string minXYCol, std::string maxXXCol, std::string maxXYCol, std::string minYXCol, std::string minYYCol, std::string maxYXCol, std::string maxYYCol);
+        /**
+         * Calculate the view angle of each pixel of the footprint image. Where
+         * gridSpacing is greater than 0 the angles are interpolated from a
+         * RSGISGeometryGrid with that spacing (in pixels), where grid cells with an
+         * estimated error above maxGridError (degrees) are calculated for every pixel.
+         */
+        void calcNadirImgViewAngle(GDALDataset *imgFPDataset, std::string outViewAngleImg, std::string gdalFormat, double sateAltitude, std::string minXXCol, std::string minXYCol, std::string maxXXCol, std::string maxXYCol, std::string minYXCol, std::string minYYCol, std::string maxYXCol, std::string maxYYCol, unsigned int gridSpacing=64, double maxGridError=0.001);
         ~RSGISImgCalibUtils(){};
     };
     
     
-    class DllExport RSGISCalcNadirViewAngle: public rsgis::img::RSGISCalcImageValue
+    /**
+     * The view angle (degrees from nadir) of a nadir sensor at the altitude
+     * sateAltitude above the centre line y = (clSlope * x) + clOff.
+     */
+    class DllExport RSGISNadirViewAngleGeometry: public RSGISGeometryGridFunction
     {
     public:
-        RSGISCalcNadirViewAngle(double clSlope, double clOff, double sateAltitude);
-        void calcImageValue(float *bandValues, int numBands, double *output, OGREnvelope extent);
-        ~RSGISCalcNadirViewAngle();
+        RSGISNadirViewAngleGeometry(double clSlope, double clOff, double sateAltitude);
+        void calcGeometry(double x, double y, double *vals);
+        ~RSGISNadirViewAngleGeometry(){};
     private:
         double clSlope;
         double clOff;
         double sateAltitude;
     };
     
+    /**
+     * Outputs the view angle of the pixels within the footprint (pixel value not 0)
+     * and 1000 outside it. If a grid is provided (calculated with a
+     * RSGISNadirViewAngleGeometry) the angles are interpolated from the grid one
+     * row at a time, otherwise they are calculated for each pixel.
+     */
+    class DllExport RSGISCalcNadirViewAngle: public rsgis::img::RSGISCalcImageValue
+    {
+    public:
+        RSGISCalcNadirViewAngle(double clSlope, double clOff, double sateAltitude, RSGISGeometryGrid *grid=NULL);
+        void calcImageValue(float *bandValues, int numBands, double *output, OGREnvelope extent);
+        ~RSGISCalcNadirViewAngle();
+    private:
+        RSGISNadirViewAngleGeometry viewGeom;
+        RSGISGeometryGrid *grid;
+        std::vector<double> rowVals;
+        long gridRow;
+    };
+    
     
     
 }}
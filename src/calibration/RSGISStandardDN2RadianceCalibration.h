@@ -136,6 +136,7 @@ namespace rsgis{namespace calib{
             this->radGainOff = radGainOff;
         };
         void calcImageValue(float *bandValues, int numBands, double *output);
+        rsgis::img::RSGISCalcImageValue* clone(){return new RSGISLandsatRadianceCalibration(this->numOutBands, this->radGainOff);};
         ~RSGISLandsatRadianceCalibration(){};
     protected:
         LandsatRadianceGainsOffsets *radGainOff;
@@ -149,6 +150,7 @@ namespace rsgis{namespace calib{
             this->radGainOff = radGainOff;
         };
         void calcImageValue(float *bandValues, int numBands, double *output);
+        rsgis::img::RSGISCalcImageValue* clone(){return new RSGISLandsatRadianceCalibrationMultiAdd(this->numOutBands, this->radGainOff);};
         ~RSGISLandsatRadianceCalibrationMultiAdd(){};
     protected:
         LandsatRadianceGainsOffsetsMultiAdd *radGainOff;
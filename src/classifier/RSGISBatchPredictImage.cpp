@@ -0,0 +1,312 @@
+/*
+ *  RSGISBatchPredictImage.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISBatchPredictImage.h"
+
+namespace rsgis{ namespace classifier{
+    
+    void RSGISBatchPredictImage::predictImage(std::vector<RSGISBatchPredictInput> inputs, GDALDataset *maskDS, int maskVal, RSGISBatchPredictor *predictor, std::vector<RSGISBatchPredictOutput> outputs, std::string gdalFormat, size_t batchSize, bool useNoData, float noDataVal, float outNoDataVal)
+    {
+        if(inputs.empty())
+        {
+            throw rsgis::RSGISClassificationException("At least one input image must be provided.");
+        }
+        if(outputs.empty())
+        {
+            throw rsgis::RSGISClassificationException("At least one output image must be provided.");
+        }
+        if(predictor == NULL)
+        {
+            throw rsgis::RSGISClassificationException("A predictor must be provided.");
+        }
+        
+        unsigned int numFeatures = 0;
+        for(std::vector<RSGISBatchPredictInput>::iterator iterIn = inputs.begin(); iterIn != inputs.end(); ++iterIn)
+        {
+            if((*iterIn).dataset == NULL)
+            {
+                throw rsgis::RSGISClassificationException("An input image has not been opened.");
+            }
+            if((*iterIn).bands.empty())
+            {
+                for(int n = 1; n <= (*iterIn).dataset->GetRasterCount(); ++n)
+                {
+                    (*iterIn).bands.push_back(n);
+                }
+            }
+            for(std::vector<unsigned int>::iterator iterBand = (*iterIn).bands.begin(); iterBand != (*iterIn).bands.end(); ++iterBand)
+            {
+                if(((*iterBand) == 0) || ((*iterBand) > (unsigned int)(*iterIn).dataset->GetRasterCount()))
+                {
+                    throw rsgis::RSGISClassificationException("A band specified is not within the input image.");
+                }
+            }
+            numFeatures += (*iterIn).bands.size();
+        }
+        
+        unsigned int numOutputs = predictor->getNumOutputs();
+        unsigned int numOutBands = 0;
+        for(std::vector<RSGISBatchPredictOutput>::iterator iterOut = outputs.begin(); iterOut != outputs.end(); ++iterOut)
+        {
+            if((*iterOut).numBands == 0)
+            {
+                throw rsgis::RSGISClassificationException("An output image must have at least one band.");
+            }
+            numOutBands += (*iterOut).numBands;
+        }
+        if(numOutBands != numOutputs)
+        {
+            throw rsgis::RSGISClassificationException("The number of output image bands is not equal to the number of outputs from the predictor.");
+        }
+        
+        GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(gdalFormat.c_str());
+        if(gdalDriver == NULL)
+        {
+            throw rsgis::RSGISClassificationException("Requested GDAL driver does not exists..");
+        }
+        
+        // The mask (if provided) is the last dataset.
+        std::vector<GDALDataset*> datasets;
+        for(std::vector<RSGISBatchPredictInput>::iterator iterIn = inputs.begin(); iterIn != inputs.end(); ++iterIn)
+        {
+            datasets.push_back((*iterIn).dataset);
+        }
+        if(maskDS != NULL)
+        {
+            datasets.push_back(maskDS);
+        }
+        unsigned int numDS = datasets.size();
+        
+        rsgis::img::RSGISImageUtils imgUtils;
+        int width = 0;
+        int height = 0;
+        double *gdalTransform = new double[6];
+        int **dsOffsets = new int*[numDS];
+        for(unsigned int i = 0; i < numDS; ++i)
+        {
+            dsOffsets[i] = new int[2];
+        }
+        std::vector<GDALDataset*> outDatasets;
+        try
+        {
+            imgUtils.getImageOverlap(datasets.data(), numDS, dsOffsets, &width, &height, gdalTransform);
+            
+            char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(gdalFormat);
+            for(std::vector<RSGISBatchPredictOutput>::iterator iterOut = outputs.begin(); iterOut != outputs.end(); ++iterOut)
+            {
+                GDALDataset *outDS = gdalDriver->Create((*iterOut).image.c_str(), width, height, (*iterOut).numBands, (*iterOut).dataType, papszOptions);
+                if(outDS == NULL)
+                {
+                    throw rsgis::RSGISClassificationException("Output image could not be created. Check filepath: " + (*iterOut).image);
+                }
+                outDS->SetGeoTransform(gdalTransform);
+                outDS->SetProjection(datasets[0]->GetProjectionRef());
+                outDatasets.push_back(outDS);
+            }
+            
+            // Input feature bands, in the order of the features passed to the predictor.
+            std::vector<GDALRasterBand*> featBands;
+            std::vector<int*> featOffsets;
+            for(unsigned int i = 0; i < inputs.size(); ++i)
+            {
+                for(std::vector<unsigned int>::iterator iterBand = inputs[i].bands.begin(); iterBand != inputs[i].bands.end(); ++iterBand)
+                {
+                    featBands.push_back(inputs[i].dataset->GetRasterBand(*iterBand));
+                    featOffsets.push_back(dsOffsets[i]);
+                }
+            }
+            GDALRasterBand *maskBand = NULL;
+            if(maskDS != NULL)
+            {
+                maskBand = maskDS->GetRasterBand(1);
+            }
+            std::vector<GDALRasterBand*> outBands;
+            for(std::vector<GDALDataset*>::iterator iterDS = outDatasets.begin(); iterDS != outDatasets.end(); ++iterDS)
+            {
+                for(int n = 1; n <= (*iterDS)->GetRasterCount(); ++n)
+                {
+                    outBands.push_back((*iterDS)->GetRasterBand(n));
+                }
+            }
+            
+            // Each strip holds (about) batchSize pixels.
+            if(batchSize == 0)
+            {
+                batchSize = 1;
+            }
+            int stripRowsMax = std::max<int>(1, std::min<size_t>(batchSize / width, height));
+            size_t stripPxls = ((size_t)stripRowsMax) * width;
+            size_t nStrips = (height + stripRowsMax - 1) / stripRowsMax;
+            
+            // At least two buffers so the reading and writing overlaps the predictions.
+            rsgis::RSGISStripIOPipeline ioPipeline(std::max<unsigned int>(2, rsgis::RSGISExecutionContextUtils::getDefaultContext().numIOBuffers));
+            unsigned int nIOBufs = ioPipeline.getNumBuffers();
+            std::vector<std::vector<float> > stripFeatData(nIOBufs, std::vector<float>(stripPxls*numFeatures));
+            std::vector<std::vector<int> > stripMaskData(nIOBufs);
+            if(maskBand != NULL)
+            {
+                for(unsigned int b = 0; b < nIOBufs; ++b)
+                {
+                    stripMaskData[b].resize(stripPxls);
+                }
+            }
+            std::vector<std::vector<float> > stripOutData(nIOBufs, std::vector<float>(stripPxls*numOutputs));
+            
+            // The valid pixels of the strip, packed row-major for the predictor.
+            std::vector<size_t> validPxls;
+            validPxls.reserve(stripPxls);
+            std::vector<float> batchFeats(stripPxls*numFeatures);
+            std::vector<float> batchOut(stripPxls*numOutputs);
+            
+            auto stripRows = [&](size_t strip)
+            {
+                return std::min<int>(stripRowsMax, height - (strip*stripRowsMax));
+            };
+            
+            rsgis_tqdm pbar;
+            auto readStrip = [&](size_t strip, unsigned int buf)
+            {
+                int nRows = stripRows(strip);
+                int rowOffset = strip * stripRowsMax;
+                for(unsigned int n = 0; n < numFeatures; ++n)
+                {
+                    featBands[n]->RasterIO(GF_Read, featOffsets[n][0], featOffsets[n][1] + rowOffset, width, nRows, stripFeatData[buf].data() + (n*stripPxls), width, nRows, GDT_Float32, 0, 0);
+                }
+                if(maskBand != NULL)
+                {
+                    maskBand->RasterIO(GF_Read, dsOffsets[numDS-1][0], dsOffsets[numDS-1][1] + rowOffset, width, nRows, stripMaskData[buf].data(), width, nRows, GDT_Int32, 0, 0);
+                }
+            };
+            auto computeStrip = [&](size_t strip, unsigned int buf)
+            {
+                pbar.progress((strip*stripRowsMax), height);
+                size_t nPxls = ((size_t)stripRows(strip)) * width;
+                const float *featData = stripFeatData[buf].data();
+                float *outData = stripOutData[buf].data();
+                
+                validPxls.clear();
+                for(size_t i = 0; i < nPxls; ++i)
+                {
+                    if((maskBand != NULL) && (stripMaskData[buf][i] != maskVal))
+                    {
+                        continue;
+                    }
+                    bool valid = true;
+                    if(useNoData)
+                    {
+                        for(unsigned int n = 0; n < numFeatures; ++n)
+                        {
+                            float val = featData[(n*stripPxls)+i];
+                            if((val == noDataVal) || std::isnan(val))
+                            {
+                                valid = false;
+                                break;
+                            }
+                        }
+                    }
+                    if(valid)
+                    {
+                        validPxls.push_back(i);
+                    }
+                }
+                
+                std::fill(outData, outData + (numOutputs*stripPxls), outNoDataVal);
+                size_t nValid = validPxls.size();
+                if(nValid == 0)
+                {
+                    return;
+                }
+                
+                for(size_t j = 0; j < nValid; ++j)
+                {
+                    float *featRow = batchFeats.data() + (j*numFeatures);
+                    for(unsigned int n = 0; n < numFeatures; ++n)
+                    {
+                        featRow[n] = featData[(n*stripPxls)+validPxls[j]];
+                    }
+                }
+                
+                predictor->predict(batchFeats.data(), nValid, numFeatures, batchOut.data());
+                
+                for(size_t j = 0; j < nValid; ++j)
+                {
+                    const float *outRow = batchOut.data() + (j*numOutputs);
+                    for(unsigned int n = 0; n < numOutputs; ++n)
+                    {
+                        outData[(n*stripPxls)+validPxls[j]] = outRow[n];
+                    }
+                }
+            };
+            auto writeStrip = [&](size_t strip, unsigned int buf)
+            {
+                int nRows = stripRows(strip);
+                int rowOffset = strip * stripRowsMax;
+                for(unsigned int n = 0; n < numOutputs; ++n)
+                {
+                    outBands[n]->RasterIO(GF_Write, 0, rowOffset, width, nRows, stripOutData[buf].data() + (n*stripPxls), width, nRows, GDT_Float32, 0, 0);
+                }
+            };
+            ioPipeline.run(nStrips, readStrip, computeStrip, writeStrip);
+            pbar.finish();
+        }
+        catch(rsgis::RSGISClassificationException &e)
+        {
+            for(std::vector<GDALDataset*>::iterator iterDS = outDatasets.begin(); iterDS != outDatasets.end(); ++iterDS)
+            {
+                GDALClose(*iterDS);
+            }
+            for(unsigned int i = 0; i < numDS; ++i)
+            {
+                delete[] dsOffsets[i];
+            }
+            delete[] dsOffsets;
+            delete[] gdalTransform;
+            throw e;
+        }
+        catch(std::exception &e)
+        {
+            for(std::vector<GDALDataset*>::iterator iterDS = outDatasets.begin(); iterDS != outDatasets.end(); ++iterDS)
+            {
+                GDALClose(*iterDS);
+            }
+            for(unsigned int i = 0; i < numDS; ++i)
+            {
+                delete[] dsOffsets[i];
+            }
+            delete[] dsOffsets;
+            delete[] gdalTransform;
+            throw rsgis::RSGISClassificationException(e.what());
+        }
+        
+        for(std::vector<GDALDataset*>::iterator iterDS = outDatasets.begin(); iterDS != outDatasets.end(); ++iterDS)
+        {
+            GDALClose(*iterDS);
+        }
+        for(unsigned int i = 0; i < numDS; ++i)
+        {
+            delete[] dsOffsets[i];
+        }
+        delete[] dsOffsets;
+        delete[] gdalTransform;
+    }
+    
+}}
@@ -0,0 +1,120 @@
+/*
+ *  RSGISBatchPredictImage.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISBatchPredictImage_H
+#define RSGISBatchPredictImage_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+
+#include "gdal_priv.h"
+
+#include "common/rsgis-tqdm.h"
+#include "common/RSGISClassificationException.h"
+#include "common/RSGISStripIOPipeline.h"
+#include "common/RSGISExecutionContext.h"
+
+#include "img/RSGISImageUtils.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_classify_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{ namespace classifier{
+    
+    /**
+     * A model (e.g., a scikit-learn, LightGBM or ONNX model) applied to a batch
+     * of samples. The features are row-major (numSamples x numFeatures) and the
+     * outputs are written row-major (numSamples x getNumOutputs()).
+     */
+    class DllExport RSGISBatchPredictor
+    {
+    public:
+        RSGISBatchPredictor(){};
+        virtual void predict(const float *features, size_t numSamples, unsigned int numFeatures, float *outputs) = 0;
+        virtual unsigned int getNumOutputs() = 0;
+        virtual ~RSGISBatchPredictor(){};
+    };
+    
+    /** A RSGISBatchPredictor which calls a function (e.g., a Python callback). */
+    class DllExport RSGISBatchPredictorFunction : public RSGISBatchPredictor
+    {
+    public:
+        RSGISBatchPredictorFunction(unsigned int numOutputs, std::function<void(const float*, size_t, unsigned int, float*)> predictFunc)
+        {
+            this->numOutputs = numOutputs;
+            this->predictFunc = predictFunc;
+        };
+        void predict(const float *features, size_t numSamples, unsigned int numFeatures, float *outputs){this->predictFunc(features, numSamples, numFeatures, outputs);};
+        unsigned int getNumOutputs(){return this->numOutputs;};
+        ~RSGISBatchPredictorFunction(){};
+    protected:
+        unsigned int numOutputs;
+        std::function<void(const float*, size_t, unsigned int, float*)> predictFunc;
+    };
+    
+    /** An input image and the (1-based) bands used as features. */
+    struct DllExport RSGISBatchPredictInput
+    {
+        GDALDataset *dataset;
+        std::vector<unsigned int> bands;
+    };
+    
+    /** An output image, which is written with numBands of the outputs of the predictor. */
+    struct DllExport RSGISBatchPredictOutput
+    {
+        std::string image;
+        unsigned int numBands;
+        GDALDataType dataType;
+    };
+    
+    /**
+     * Applies a RSGISBatchPredictor to the pixels of a set of images on the same
+     * grid. The image is processed as strips of about batchSize pixels, where the
+     * features of the pixels within the mask (and without a no data value) are
+     * packed into a contiguous matrix and predicted in one call. The outputs are
+     * then scattered back to the strip, with outNoDataVal elsewhere. The strips are
+     * read and written on separate threads (see rsgis::RSGISStripIOPipeline) while
+     * the predictor is called on the calling thread.
+     */
+    class DllExport RSGISBatchPredictImage
+    {
+    public:
+        static void predictImage(std::vector<RSGISBatchPredictInput> inputs, GDALDataset *maskDS, int maskVal, RSGISBatchPredictor *predictor, std::vector<RSGISBatchPredictOutput> outputs, std::string gdalFormat, size_t batchSize=65536, bool useNoData=false, float noDataVal=0, float outNoDataVal=0);
+    };
+    
+}}
+
+#endif
@@ -0,0 +1,193 @@
+/*
+ *  RSGISBatchPredictRAT.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISBatchPredictRAT.h"
+#include "rastergis/RSGISRATColumnSummary.h"
+
+namespace rsgis{ namespace classifier{
+    
+    void RSGISBatchPredictRAT::predictRAT(GDALRasterAttributeTable *gdalRAT, std::vector<std::string> featCols, std::function<void(const double*, size_t, unsigned int, double*)> predictFunc, std::string outIntCol, std::string roiCol, int roiVal, std::map<int, RSGISBatchPredictRATClass> *classes, std::string outStrCol, bool setColours, size_t chunkSize)
+    {
+        if(featCols.empty())
+        {
+            throw rsgis::RSGISClassificationException("At least one feature column must be provided.");
+        }
+        if(chunkSize == 0)
+        {
+            chunkSize = RAT_BLOCK_LENGTH;
+        }
+        bool useClasses = (classes != NULL) && (!classes->empty());
+        bool writeNames = useClasses && (outStrCol != "");
+        bool writeColours = useClasses && setColours;
+        
+        try
+        {
+            rsgis::rastergis::RSGISRasterAttUtils attUtils;
+            size_t numRows = gdalRAT->GetRowCount();
+            unsigned int numFeatures = featCols.size();
+            
+            std::vector<unsigned int> featColIdxs;
+            for(std::vector<std::string>::iterator iterCol = featCols.begin(); iterCol != featCols.end(); ++iterCol)
+            {
+                featColIdxs.push_back(attUtils.findColumnIndex(gdalRAT, *iterCol));
+            }
+            bool useROI = (roiCol != "");
+            std::vector<unsigned int> roiColIdxs;
+            if(useROI)
+            {
+                roiColIdxs.push_back(attUtils.findColumnIndex(gdalRAT, roiCol));
+            }
+            
+            unsigned int outIntColIdx = attUtils.findColumnIndexOrCreate(gdalRAT, outIntCol, GFT_Integer);
+            rsgis::rastergis::RSGISRATColumnSummaries::columnModified(gdalRAT, outIntCol);
+            unsigned int outStrColIdx = 0;
+            if(writeNames)
+            {
+                outStrColIdx = attUtils.findColumnIndexOrCreate(gdalRAT, outStrCol, GFT_String);
+            }
+            unsigned int redColIdx = 0;
+            unsigned int greenColIdx = 0;
+            unsigned int blueColIdx = 0;
+            if(writeColours)
+            {
+                redColIdx = attUtils.findColumnIndexOrCreate(gdalRAT, "Red", GFT_Integer, GFU_Red);
+                greenColIdx = attUtils.findColumnIndexOrCreate(gdalRAT, "Green", GFT_Integer, GFU_Green);
+                blueColIdx = attUtils.findColumnIndexOrCreate(gdalRAT, "Blue", GFT_Integer, GFU_Blue);
+            }
+            
+            size_t maxChunkRows = std::min(chunkSize, numRows);
+            std::vector<double> featData(maxChunkRows * numFeatures);
+            std::vector<double> roiData(useROI?maxChunkRows:0);
+            std::vector<size_t> validRows;
+            validRows.reserve(maxChunkRows);
+            std::vector<double> predData(maxChunkRows);
+            std::vector<int> outIntData(maxChunkRows);
+            std::vector<char*> outStrData(writeNames?maxChunkRows:0);
+            std::vector<int> redData(writeColours?maxChunkRows:0);
+            std::vector<int> greenData(writeColours?maxChunkRows:0);
+            std::vector<int> blueData(writeColours?maxChunkRows:0);
+            char emptyStr[] = "";
+            
+            rsgis_tqdm pbar;
+            for(size_t startRow = 0; startRow < numRows; startRow += chunkSize)
+            {
+                pbar.progress(startRow, numRows);
+                size_t numChunkRows = std::min(chunkSize, numRows - startRow);
+                
+                attUtils.readColumnsToMatrix(gdalRAT, featColIdxs, startRow, numChunkRows, featData.data());
+                if(useROI)
+                {
+                    attUtils.readColumnsToMatrix(gdalRAT, roiColIdxs, startRow, numChunkRows, roiData.data());
+                }
+                
+                // Pack the valid rows to the start of the feature matrix.
+                validRows.clear();
+                for(size_t i = 0; i < numChunkRows; ++i)
+                {
+                    const double *rowData = featData.data() + (i * numFeatures);
+                    bool valid = (!useROI) || (roiData[i] == roiVal);
+                    for(unsigned int n = 0; (n < numFeatures) && valid; ++n)
+                    {
+                        valid = std::isfinite(rowData[n]);
+                    }
+                    if(valid)
+                    {
+                        if(validRows.size() != i)
+                        {
+                            std::copy(rowData, rowData + numFeatures, featData.data() + (validRows.size() * numFeatures));
+                        }
+                        validRows.push_back(i);
+                    }
+                }
+                
+                std::fill(outIntData.begin(), outIntData.begin() + numChunkRows, 0);
+                if(!validRows.empty())
+                {
+                    predictFunc(featData.data(), validRows.size(), numFeatures, predData.data());
+                    for(size_t j = 0; j < validRows.size(); ++j)
+                    {
+                        outIntData[validRows[j]] = (int)predData[j];
+                    }
+                }
+                
+                if(gdalRAT->ValuesIO(GF_Write, outIntColIdx, startRow, numChunkRows, outIntData.data()) != CE_None)
+                {
+                    throw rsgis::RSGISClassificationException("Failed to write to the column '" + outIntCol + "'.");
+                }
+                
+                if(writeNames || writeColours)
+                {
+                    for(size_t i = 0; i < numChunkRows; ++i)
+                    {
+                        std::map<int, RSGISBatchPredictRATClass>::iterator iterClass = classes->find(outIntData[i]);
+                        bool found = (iterClass != classes->end());
+                        if(writeNames)
+                        {
+                            outStrData[i] = found?const_cast<char*>(iterClass->second.name.c_str()):emptyStr;
+                        }
+                        if(writeColours)
+                        {
+                            redData[i] = found?iterClass->second.red:0;
+                            greenData[i] = found?iterClass->second.green:0;
+                            blueData[i] = found?iterClass->second.blue:0;
+                        }
+                    }
+                    if(writeNames && (gdalRAT->ValuesIO(GF_Write, outStrColIdx, startRow, numChunkRows, outStrData.data()) != CE_None))
+                    {
+                        throw rsgis::RSGISClassificationException("Failed to write to the column '" + outStrCol + "'.");
+                    }
+                    if(writeColours)
+                    {
+                        if((gdalRAT->ValuesIO(GF_Write, redColIdx, startRow, numChunkRows, redData.data()) != CE_None) ||
+                           (gdalRAT->ValuesIO(GF_Write, greenColIdx, startRow, numChunkRows, greenData.data()) != CE_None) ||
+                           (gdalRAT->ValuesIO(GF_Write, blueColIdx, startRow, numChunkRows, blueData.data()) != CE_None))
+                        {
+                            throw rsgis::RSGISClassificationException("Failed to write to the colour columns.");
+                        }
+                    }
+                }
+            }
+            pbar.finish();
+            
+            if(writeNames)
+            {
+                rsgis::rastergis::RSGISRATColumnSummaries::columnModified(gdalRAT, outStrCol);
+            }
+            if(writeColours)
+            {
+                rsgis::rastergis::RSGISRATColumnSummaries::columnModified(gdalRAT, "Red");
+                rsgis::rastergis::RSGISRATColumnSummaries::columnModified(gdalRAT, "Green");
+                rsgis::rastergis::RSGISRATColumnSummaries::columnModified(gdalRAT, "Blue");
+            }
+        }
+        catch(rsgis::RSGISClassificationException &e)
+        {
+            throw e;
+        }
+        catch(std::exception &e)
+        {
+            throw rsgis::RSGISClassificationException(e.what());
+        }
+    }
+    
+}}
@@ -0,0 +1,86 @@
+/*
+ *  RSGISBatchPredictRAT.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISBatchPredictRAT_H
+#define RSGISBatchPredictRAT_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+
+#include "gdal_priv.h"
+#include "gdal_rat.h"
+
+#include "common/rsgis-tqdm.h"
+#include "common/RSGISClassificationException.h"
+#include "common/RSGISAttributeTableException.h"
+
+#include "rastergis/RSGISRasterAttUtils.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_classify_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{ namespace classifier{
+    
+    /** The name and colour given to the RAT rows classified with a class id. */
+    struct DllExport RSGISBatchPredictRATClass
+    {
+        std::string name;
+        int red;
+        int green;
+        int blue;
+    };
+    
+    /**
+     * Applies a classifier to the rows of a RAT a chunk of rows at a time, so the
+     * memory used is bounded by chunkSize rather than the number of rows. The rows
+     * where all the feature columns are finite (and the roi column equals roiVal, if
+     * provided) are packed into a row-major (numRows x numFeatures) matrix which is
+     * passed to predictFunc, which writes a class id for each row. The other rows are
+     * given class 0. If classes are provided then the class names are written to
+     * outStrCol (if not empty) and, if setColours, the Red, Green and Blue columns
+     * are set to the class colours (black for the other rows).
+     */
+    class DllExport RSGISBatchPredictRAT
+    {
+    public:
+        static void predictRAT(GDALRasterAttributeTable *gdalRAT, std::vector<std::string> featCols, std::function<void(const double*, size_t, unsigned int, double*)> predictFunc, std::string outIntCol, std::string roiCol="", int roiVal=1, std::map<int, RSGISBatchPredictRATClass> *classes=NULL, std::string outStrCol="", bool setColours=false, size_t chunkSize=RAT_BLOCK_LENGTH);
+    };
+    
+}}
+
+#endif
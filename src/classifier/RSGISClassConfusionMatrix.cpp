@@ -0,0 +1,285 @@
+/*
+ *  RSGISClassConfusionMatrix.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISClassConfusionMatrix.h"
+
+namespace rsgis{ namespace classifier{
+    
+    RSGISClassConfusionMatrix::RSGISClassConfusionMatrix(std::vector<long> classIds, bool useClsNoData, float clsNoData, bool useRefNoData, float refNoData, std::map<long, double> strataWeights): rsgis::img::RSGISCalcImageValue(0)
+    {
+        if(classIds.empty())
+        {
+            throw rsgis::RSGISClassificationException("At least one class id must be provided.");
+        }
+        this->classIds = classIds;
+        this->useClsNoData = useClsNoData;
+        this->clsNoData = clsNoData;
+        this->useRefNoData = useRefNoData;
+        this->refNoData = refNoData;
+        this->useStrata = !strataWeights.empty();
+        this->strataWeights = strataWeights;
+        
+        // Class ids are normally a small range so a look up table is used to
+        // find the class index of a pixel, otherwise a sorted list is searched.
+        std::vector<long> sortedIds = classIds;
+        std::sort(sortedIds.begin(), sortedIds.end());
+        if(std::adjacent_find(sortedIds.begin(), sortedIds.end()) != sortedIds.end())
+        {
+            throw rsgis::RSGISClassificationException("The class ids must be unique.");
+        }
+        this->minClassId = sortedIds.front();
+        long idRange = sortedIds.back() - sortedIds.front() + 1;
+        if(idRange <= 1048576)
+        {
+            this->classLUT = std::vector<long>(idRange, -1);
+            for(size_t i = 0; i < classIds.size(); ++i)
+            {
+                this->classLUT[classIds[i] - this->minClassId] = i;
+            }
+        }
+        
+        this->reset();
+    }
+    
+    long RSGISClassConfusionMatrix::findClassIdx(float val) const
+    {
+        if(!std::isfinite(val) || (val != std::floor(val)))
+        {
+            return -1;
+        }
+        long id = static_cast<long>(val);
+        if(!this->classLUT.empty())
+        {
+            long lutIdx = id - this->minClassId;
+            if((lutIdx < 0) || (lutIdx >= static_cast<long>(this->classLUT.size())))
+            {
+                return -1;
+            }
+            return this->classLUT[lutIdx];
+        }
+        for(size_t i = 0; i < this->classIds.size(); ++i)
+        {
+            if(this->classIds[i] == id)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+    
+    void RSGISClassConfusionMatrix::calcImageValue(float *bandValues, int numBands)
+    {
+        float clsVal = bandValues[0];
+        if(std::isnan(clsVal) || (this->useClsNoData && (clsVal == this->clsNoData)))
+        {
+            return;
+        }
+        long clsIdx = this->findClassIdx(clsVal);
+        if(clsIdx >= 0)
+        {
+            this->mappedCounts[clsIdx] += 1;
+        }
+        
+        float refVal = bandValues[1];
+        if(std::isnan(refVal) || (this->useRefNoData && (refVal == this->refNoData)))
+        {
+            return;
+        }
+        long refIdx = this->findClassIdx(refVal);
+        if((clsIdx < 0) || (refIdx < 0))
+        {
+            ++this->numUnlisted;
+            return;
+        }
+        
+        double weight = 1.0;
+        if(this->useStrata)
+        {
+            if(!std::isfinite(bandValues[2]))
+            {
+                return;
+            }
+            std::map<long, double>::const_iterator iterStrata = this->strataWeights.find(static_cast<long>(bandValues[2]));
+            if(iterStrata == this->strataWeights.end())
+            {
+                return;
+            }
+            weight = iterStrata->second;
+        }
+        
+        this->matrix[(clsIdx * this->classIds.size()) + refIdx] += weight;
+        ++this->numCompared;
+    }
+    
+    rsgis::img::RSGISCalcImageValue* RSGISClassConfusionMatrix::clone()
+    {
+        RSGISClassConfusionMatrix *threadCalc = new RSGISClassConfusionMatrix(*this);
+        threadCalc->reset();
+        return threadCalc;
+    }
+    
+    void RSGISClassConfusionMatrix::reduce(rsgis::img::RSGISCalcImageValue *other)
+    {
+        RSGISClassConfusionMatrix *otherCalc = dynamic_cast<RSGISClassConfusionMatrix*>(other);
+        if(otherCalc == NULL)
+        {
+            throw rsgis::img::RSGISImageCalcException("Can only reduce with another RSGISClassConfusionMatrix.");
+        }
+        for(size_t i = 0; i < this->matrix.size(); ++i)
+        {
+            this->matrix[i] += otherCalc->matrix[i];
+        }
+        for(size_t i = 0; i < this->mappedCounts.size(); ++i)
+        {
+            this->mappedCounts[i] += otherCalc->mappedCounts[i];
+        }
+        this->numCompared += otherCalc->numCompared;
+        this->numUnlisted += otherCalc->numUnlisted;
+    }
+    
+    void RSGISClassConfusionMatrix::reset()
+    {
+        size_t numClasses = this->classIds.size();
+        this->matrix = std::vector<double>(numClasses * numClasses, 0.0);
+        this->mappedCounts = std::vector<double>(numClasses, 0.0);
+        this->numCompared = 0;
+        this->numUnlisted = 0;
+    }
+    
+    RSGISAreaAdjustedAccuracy RSGISClassConfusionMatrix::calcAreaAdjustedAccuracy(const std::vector<double> &matrix, const std::vector<double> &mappedCounts, unsigned int numClasses)
+    {
+        if((matrix.size() != (static_cast<size_t>(numClasses) * numClasses)) || (mappedCounts.size() != numClasses))
+        {
+            throw rsgis::RSGISClassificationException("The confusion matrix and mapped counts do not match the number of classes.");
+        }
+        
+        RSGISAreaAdjustedAccuracy acc;
+        acc.overallAcc = 0.0;
+        acc.overallAccSE = 0.0;
+        acc.userAcc = std::vector<double>(numClasses, 0.0);
+        acc.userAccSE = std::vector<double>(numClasses, 0.0);
+        acc.prodAcc = std::vector<double>(numClasses, 0.0);
+        acc.prodAccSE = std::vector<double>(numClasses, 0.0);
+        acc.propArea = std::vector<double>(numClasses, 0.0);
+        acc.propAreaSE = std::vector<double>(numClasses, 0.0);
+        
+        double totalMapped = 0.0;
+        for(unsigned int i = 0; i < numClasses; ++i)
+        {
+            totalMapped += mappedCounts[i];
+        }
+        if(totalMapped == 0)
+        {
+            return acc;
+        }
+        
+        // The number of samples (n_i.), the proportion of the mapped area (W_i)
+        // of each mapped class and the estimated area proportions p_ij.
+        std::vector<double> rowTotals(numClasses, 0.0);
+        std::vector<double> mapProps(numClasses, 0.0);
+        std::vector<double> props(matrix.size(), 0.0);
+        for(unsigned int i = 0; i < numClasses; ++i)
+        {
+            for(unsigned int j = 0; j < numClasses; ++j)
+            {
+                rowTotals[i] += matrix[(i * numClasses) + j];
+            }
+            mapProps[i] = mappedCounts[i] / totalMapped;
+            if(rowTotals[i] > 0)
+            {
+                for(unsigned int j = 0; j < numClasses; ++j)
+                {
+                    props[(i * numClasses) + j] = mapProps[i] * matrix[(i * numClasses) + j] / rowTotals[i];
+                }
+            }
+        }
+        
+        double overallVar = 0.0;
+        for(unsigned int i = 0; i < numClasses; ++i)
+        {
+            acc.overallAcc += props[(i * numClasses) + i];
+            if(rowTotals[i] > 0)
+            {
+                double userAcc = matrix[(i * numClasses) + i] / rowTotals[i];
+                acc.userAcc[i] = userAcc;
+                if(rowTotals[i] > 1)
+                {
+                    double userVar = userAcc * (1 - userAcc) / (rowTotals[i] - 1);
+                    acc.userAccSE[i] = std::sqrt(userVar);
+                    overallVar += mapProps[i] * mapProps[i] * userVar;
+                }
+            }
+        }
+        acc.overallAccSE = std::sqrt(overallVar);
+        
+        for(unsigned int j = 0; j < numClasses; ++j)
+        {
+            double propVar = 0.0;
+            double estRefCount = 0.0;
+            for(unsigned int i = 0; i < numClasses; ++i)
+            {
+                double pij = props[(i * numClasses) + j];
+                acc.propArea[j] += pij;
+                if(rowTotals[i] > 1)
+                {
+                    propVar += ((mapProps[i] * pij) - (pij * pij)) / (rowTotals[i] - 1);
+                }
+                if(rowTotals[i] > 0)
+                {
+                    estRefCount += mappedCounts[i] * matrix[(i * numClasses) + j] / rowTotals[i];
+                }
+            }
+            acc.propAreaSE[j] = std::sqrt(std::max(propVar, 0.0));
+            
+            if(acc.propArea[j] > 0)
+            {
+                double prodAcc = props[(j * numClasses) + j] / acc.propArea[j];
+                acc.prodAcc[j] = prodAcc;
+                
+                double prodVar = 0.0;
+                if(rowTotals[j] > 1)
+                {
+                    double userAcc = acc.userAcc[j];
+                    prodVar += mappedCounts[j] * mappedCounts[j] * (1 - prodAcc) * (1 - prodAcc) * userAcc * (1 - userAcc) / (rowTotals[j] - 1);
+                }
+                for(unsigned int i = 0; i < numClasses; ++i)
+                {
+                    if((i != j) && (rowTotals[i] > 1))
+                    {
+                        double nProp = matrix[(i * numClasses) + j] / rowTotals[i];
+                        prodVar += prodAcc * prodAcc * mappedCounts[i] * mappedCounts[i] * nProp * (1 - nProp) / (rowTotals[i] - 1);
+                    }
+                }
+                acc.prodAccSE[j] = std::sqrt(prodVar) / estRefCount;
+            }
+        }
+        
+        return acc;
+    }
+    
+    RSGISClassConfusionMatrix::~RSGISClassConfusionMatrix()
+    {
+        
+    }
+    
+}}
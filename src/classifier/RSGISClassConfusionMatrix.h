@@ -0,0 +1,135 @@
+/*
+ *  RSGISClassConfusionMatrix.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISClassConfusionMatrix_H
+#define RSGISClassConfusionMatrix_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <algorithm>
+
+#include "common/RSGISClassificationException.h"
+
+#include "img/RSGISCalcImageValue.h"
+#include "img/RSGISImageCalcException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_classify_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{ namespace classifier{
+    
+    /**
+     * The area adjusted accuracy estimates (Olofsson et al., 2014, Good practices for
+     * estimating area and assessing accuracy of land change. Remote Sensing of
+     * Environment, 148, 42-57) with their standard errors. The class proportions
+     * are the estimated proportion of the mapped area within each reference class.
+     */
+    struct DllExport RSGISAreaAdjustedAccuracy
+    {
+        double overallAcc;
+        double overallAccSE;
+        std::vector<double> userAcc;
+        std::vector<double> userAccSE;
+        std::vector<double> prodAcc;
+        std::vector<double> prodAccSE;
+        std::vector<double> propArea;
+        std::vector<double> propAreaSE;
+    };
+    
+    /**
+     * Accumulates the confusion matrix between a classification (band 0) and a
+     * reference (band 1) image within a single pass of RSGISCalcImage. The matrix
+     * is indexed [clsIdx * numClasses + refIdx] (i.e., the rows are the classified
+     * classes). The number of pixels mapped to each class is also counted, including
+     * the pixels where the reference is no data, so the area adjusted estimates can
+     * be calculated where the reference only covers part of the classification.
+     *
+     * If strata weights are provided then band 2 is a strata image and each pixel
+     * adds the weight of its stratum to the confusion matrix; pixels within strata
+     * without a weight are ignored. Pixels with values which are not within classIds
+     * are counted (getNumUnlistedPxls) but not added to the matrix.
+     *
+     * clone() and reduce() are implemented so the parallel RSGISCalcImage code path
+     * accumulates thread-local matrices which are merged at the end.
+     */
+    class DllExport RSGISClassConfusionMatrix : public rsgis::img::RSGISCalcImageValue
+    {
+    public:
+        RSGISClassConfusionMatrix(std::vector<long> classIds, bool useClsNoData=false, float clsNoData=0, bool useRefNoData=false, float refNoData=0, std::map<long, double> strataWeights=std::map<long, double>());
+        void calcImageValue(float *bandValues, int numBands, double *output){throw rsgis::img::RSGISImageCalcException("Not implemented");};
+        void calcImageValue(float *bandValues, int numBands);
+        rsgis::img::RSGISCalcImageValue* clone();
+        void reduce(rsgis::img::RSGISCalcImageValue *other);
+        /** Clear the accumulated values. */
+        void reset();
+        
+        unsigned int getNumClasses() const {return this->classIds.size();};
+        const std::vector<long>& getClassIds() const {return this->classIds;};
+        /** The (weighted) confusion matrix, indexed [clsIdx * numClasses + refIdx]. */
+        const std::vector<double>& getMatrix() const {return this->matrix;};
+        /** The number of pixels classified as each class. */
+        const std::vector<double>& getMappedPxlCounts() const {return this->mappedCounts;};
+        /** The number of pixels added to the confusion matrix. */
+        unsigned long getNumComparedPxls() const {return this->numCompared;};
+        /** The number of valid pixels with a class or reference value not within classIds. */
+        unsigned long getNumUnlistedPxls() const {return this->numUnlisted;};
+        
+        /**
+         * Calculate the area adjusted accuracy estimates from a confusion matrix (indexed
+         * [clsIdx * numClasses + refIdx]) and the number of pixels mapped to each class.
+         */
+        static RSGISAreaAdjustedAccuracy calcAreaAdjustedAccuracy(const std::vector<double> &matrix, const std::vector<double> &mappedCounts, unsigned int numClasses);
+        ~RSGISClassConfusionMatrix();
+    protected:
+        long findClassIdx(float val) const;
+        std::vector<long> classIds;
+        long minClassId;
+        std::vector<long> classLUT;
+        bool useClsNoData;
+        float clsNoData;
+        bool useRefNoData;
+        float refNoData;
+        bool useStrata;
+        std::map<long, double> strataWeights;
+        std::vector<double> matrix;
+        std::vector<double> mappedCounts;
+        unsigned long numCompared;
+        unsigned long numUnlisted;
+    };
+    
+}}
+
+#endif
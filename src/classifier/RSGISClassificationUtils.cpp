@@ -21,6 +21,7 @@
  */
 
 #include "RSGISClassificationUtils.h"
+#include "common/RSGISGDALInit.h"
 
 
 namespace rsgis{ namespace classifier{
@@ -150,7 +151,7 @@ namespace rsgis{ namespace classifier{
 	void RSGISClassificationUtils::convertShapeFile2SpecLib(std::string vector, std::string outputFile, std::string classAttribute, std::vector<std::string> *attributes, bool group)
 	{
 	    /*
-		OGRRegisterAll();
+		rsgis::RSGISGDALInit::init();
 		
         rsgis::vec::RSGISVectorUtils vecUtils;
 		rsgis::math::RSGISMatrices matrixUtils;
@@ -669,7 +670,7 @@ namespace rsgis{ namespace classifier{
             singlePxl[1] = new unsigned int[width];
             singlePxl[2] = new unsigned int[width];
             
-            rsgis::datastruct::SortedGenericList<unsigned int> *sortedList = new rsgis::datastruct::SortedGenericList<unsigned int>();
+            rsgis::datastruct::RSGISSmallSortedBuffer<unsigned int, 8> sortedList;
             
             unsigned int *outData = new unsigned int[width];
             
@@ -695,77 +696,77 @@ namespace rsgis{ namespace classifier{
                                     //right
                                     if((j < width-1) && (singlePxl[1][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j+1]);
+                                        sortedList.add(inData[1][j+1]);
                                     }
                                     //bottom
                                     if(singlePxl[2][j] == 0)
                                     {
-                                        sortedList->add(&inData[2][j]);
+                                        sortedList.add(inData[2][j]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                                 else if(j == (width-1))
                                 {
                                     //left
                                     if((j > 0) && (singlePxl[1][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j-1]);
+                                        sortedList.add(inData[1][j-1]);
                                     }
                                     //bottom
                                     if(singlePxl[2][j] == 0)
                                     {
-                                        sortedList->add(&inData[2][j]);
+                                        sortedList.add(inData[2][j]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                                 else
                                 {
                                     //left
                                     if((j > 0) && (singlePxl[1][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j-1]);
+                                        sortedList.add(inData[1][j-1]);
                                     }
                                     //right
                                     if((j < width-1) && (singlePxl[1][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j+1]);
+                                        sortedList.add(inData[1][j+1]);
                                     }
                                     //bottom
                                     if(singlePxl[2][j] == 0)
                                     {
-                                        sortedList->add(&inData[2][j]);
+                                        sortedList.add(inData[2][j]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                             }
                             else
@@ -798,77 +799,77 @@ namespace rsgis{ namespace classifier{
                                     //top
                                     if(singlePxl[0][j] == 0)
                                     {
-                                        sortedList->add(&inData[0][j]);
+                                        sortedList.add(inData[0][j]);
                                     }
                                     //right
                                     if((j < width-1) && (singlePxl[1][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j+1]);
+                                        sortedList.add(inData[1][j+1]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                                 else if(j == (width-1))
                                 {
                                     //top
                                     if(singlePxl[0][j] == 0)
                                     {
-                                        sortedList->add(&inData[0][j]);
+                                        sortedList.add(inData[0][j]);
                                     }
                                     //left
                                     if((j > 0) && (singlePxl[1][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j-1]);
+                                        sortedList.add(inData[1][j-1]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                                 else
                                 {
                                     //top
                                     if(singlePxl[0][j] == 0)
                                     {
-                                        sortedList->add(&inData[0][j]);
+                                        sortedList.add(inData[0][j]);
                                     }
                                     //left
                                     if((j > 0) && (singlePxl[1][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j-1]);
+                                        sortedList.add(inData[1][j-1]);
                                     }
                                     //right
                                     if((j < width-1) && (singlePxl[1][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j+1]);
+                                        sortedList.add(inData[1][j+1]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                             }
                             else
@@ -902,92 +903,92 @@ namespace rsgis{ namespace classifier{
                                     //top
                                     if(singlePxl[0][j] == 0)
                                     {
-                                        sortedList->add(&inData[0][j]);
+                                        sortedList.add(inData[0][j]);
                                     }
                                     //right
                                     if((j < width-1) && (singlePxl[1][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j+1]);
+                                        sortedList.add(inData[1][j+1]);
                                     }
                                     //bottom
                                     if(singlePxl[2][j] == 0)
                                     {
-                                        sortedList->add(&inData[2][j]);
+                                        sortedList.add(inData[2][j]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                                 else if(j == (width-1))
                                 {
                                     //top
                                     if(singlePxl[0][j] == 0)
                                     {
-                                        sortedList->add(&inData[0][j]);
+                                        sortedList.add(inData[0][j]);
                                     }
                                     //left
                                     if((j > 0) && (singlePxl[1][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j-1]);
+                                        sortedList.add(inData[1][j-1]);
                                     }
                                     //bottom
                                     if(singlePxl[2][j] == 0)
                                     {
-                                        sortedList->add(&inData[2][j]);
+                                        sortedList.add(inData[2][j]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                                 else
                                 {
                                     //top
                                     if(singlePxl[0][j] == 0)
                                     {
-                                        sortedList->add(&inData[0][j]);
+                                        sortedList.add(inData[0][j]);
                                     }
                                     //left
                                     if((j > 0) && (singlePxl[1][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j-1]);
+                                        sortedList.add(inData[1][j-1]);
                                     }
                                     //right
                                     if((j < width-1) && (singlePxl[1][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j+1]);
+                                        sortedList.add(inData[1][j+1]);
                                     }
                                     //bottom
                                     if(singlePxl[2][j] == 0)
                                     {
-                                        sortedList->add(&inData[2][j]);
+                                        sortedList.add(inData[2][j]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                             }
                             else
@@ -1006,7 +1007,6 @@ namespace rsgis{ namespace classifier{
             }
             pbar.finish();
             
-            delete sortedList;
             delete[] inData[0];
             delete[] inData[1];
             delete[] inData[2];
@@ -1393,7 +1393,7 @@ namespace rsgis{ namespace classifier{
             singlePxl[1] = new unsigned int[width];
             singlePxl[2] = new unsigned int[width];
             
-            rsgis::datastruct::SortedGenericList<unsigned int> *sortedList = new rsgis::datastruct::SortedGenericList<unsigned int>();
+            rsgis::datastruct::RSGISSmallSortedBuffer<unsigned int, 8> sortedList;
             
             unsigned int *outData = new unsigned int[width];
             
@@ -1419,97 +1419,97 @@ namespace rsgis{ namespace classifier{
                                     //right
                                     if((j < width-1) && (singlePxl[1][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j+1]);
+                                        sortedList.add(inData[1][j+1]);
                                     }
                                     //bottom
                                     else if(singlePxl[2][j] == 0)
                                     {
-                                        sortedList->add(&inData[2][j]);
+                                        sortedList.add(inData[2][j]);
                                     }
                                     //bottom right
                                     else if((j < width-1) && (singlePxl[2][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[2][j+1]);
+                                        sortedList.add(inData[2][j+1]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                                 else if(j == (width-1))
                                 {
                                     //left
                                     if((j > 0) && (singlePxl[1][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j-1]);
+                                        sortedList.add(inData[1][j-1]);
                                     }
                                     //bottom left 
                                     else if((j > 0) && (singlePxl[2][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[2][j-1]);
+                                        sortedList.add(inData[2][j-1]);
                                     }
                                     //bottom
                                     else if(singlePxl[2][j] == 0)
                                     {
-                                        sortedList->add(&inData[2][j]);
+                                        sortedList.add(inData[2][j]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                                 else
                                 {
                                     //left
                                     if((j > 0) && (singlePxl[1][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j-1]);
+                                        sortedList.add(inData[1][j-1]);
                                     }
                                     //right
                                     else if((j < width-1) && (singlePxl[1][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j+1]);
+                                        sortedList.add(inData[1][j+1]);
                                     }
                                     //bottom left
                                     else if((j > 0) && (singlePxl[2][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[2][j-1]);
+                                        sortedList.add(inData[2][j-1]);
                                     }
                                     //bottom
                                     else if(singlePxl[2][j] == 0)
                                     {
-                                        sortedList->add(&inData[2][j]);
+                                        sortedList.add(inData[2][j]);
                                     }
                                     //bottom right
                                     else if((j < width-1) && (singlePxl[2][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[2][j+1]);
+                                        sortedList.add(inData[2][j+1]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                             }
                             else
@@ -1542,97 +1542,97 @@ namespace rsgis{ namespace classifier{
                                     //top
                                     if(singlePxl[0][j] == 0)
                                     {
-                                        sortedList->add(&inData[0][j]);
+                                        sortedList.add(inData[0][j]);
                                     }
                                     //top right
                                     if((j < width-1) && (singlePxl[0][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[0][j+1]);
+                                        sortedList.add(inData[0][j+1]);
                                     }
                                     //right
                                     else if((j < width-1) && (singlePxl[1][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j+1]);
+                                        sortedList.add(inData[1][j+1]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                                 else if(j == (width-1))
                                 {
                                     //top left
                                     if((j > 0) && (singlePxl[0][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[0][j-1]);
+                                        sortedList.add(inData[0][j-1]);
                                     }
                                     //top
                                     else if(singlePxl[0][j] == 0)
                                     {
-                                        sortedList->add(&inData[0][j]);
+                                        sortedList.add(inData[0][j]);
                                     }
                                     //left
                                     else if((j > 0) && (singlePxl[1][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j-1]);
+                                        sortedList.add(inData[1][j-1]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                                 else
                                 {
                                     //top left
                                     if((j > 0) && (singlePxl[0][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[0][j-1]);
+                                        sortedList.add(inData[0][j-1]);
                                     }
                                     //top
                                     else if(singlePxl[0][j] == 0)
                                     {
-                                        sortedList->add(&inData[0][j]);
+                                        sortedList.add(inData[0][j]);
                                     }
                                     //top right
                                     if((j < width-1) && (singlePxl[0][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[0][j+1]);
+                                        sortedList.add(inData[0][j+1]);
                                     }
                                     //left
                                     else if((j > 0) && (singlePxl[1][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j-1]);
+                                        sortedList.add(inData[1][j-1]);
                                     }
                                     //right
                                     else if((j < width-1) && (singlePxl[1][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j+1]);
+                                        sortedList.add(inData[1][j+1]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                             }
                             else
@@ -1666,132 +1666,132 @@ namespace rsgis{ namespace classifier{
                                     //top
                                     if(singlePxl[0][j] == 0)
                                     {
-                                        sortedList->add(&inData[0][j]);
+                                        sortedList.add(inData[0][j]);
                                     }
                                     //top right
                                     else if((j < width-1) && (singlePxl[0][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[0][j+1]);
+                                        sortedList.add(inData[0][j+1]);
                                     }
                                     //right
                                     else if((j < width-1) && (singlePxl[1][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j+1]);
+                                        sortedList.add(inData[1][j+1]);
                                     }
                                     //bottom
                                     else if(singlePxl[2][j] == 0)
                                     {
-                                        sortedList->add(&inData[2][j]);
+                                        sortedList.add(inData[2][j]);
                                     }
                                     //bottom right
                                     else if(singlePxl[2][j+1] == 0)
                                     {
-                                        sortedList->add(&inData[2][j+1]);
+                                        sortedList.add(inData[2][j+1]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                                 else if(j == (width-1))
                                 {
                                     //top left
                                     if((j > 0) && (singlePxl[0][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[0][j-1]);
+                                        sortedList.add(inData[0][j-1]);
                                     }
                                     //top
                                     else if(singlePxl[0][j] == 0)
                                     {
-                                        sortedList->add(&inData[0][j]);
+                                        sortedList.add(inData[0][j]);
                                     }
                                     //left
                                     else if((j > 0) && (singlePxl[1][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j-1]);
+                                        sortedList.add(inData[1][j-1]);
                                     }
                                     //bottom left
                                     else if((j > 0) && (singlePxl[2][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[2][j-1]);
+                                        sortedList.add(inData[2][j-1]);
                                     }
                                     //bottom
                                     else if(singlePxl[2][j] == 0)
                                     {
-                                        sortedList->add(&inData[2][j]);
+                                        sortedList.add(inData[2][j]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                                 else
                                 {
                                     //top left
                                     if((j > 0) && (singlePxl[0][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[0][j-1]);
+                                        sortedList.add(inData[0][j-1]);
                                     }
                                     //top
                                     else if(singlePxl[0][j] == 0)
                                     {
-                                        sortedList->add(&inData[0][j]);
+                                        sortedList.add(inData[0][j]);
                                     }
                                     //top right
                                     else if((j < width-1) && (singlePxl[0][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[0][j+1]);
+                                        sortedList.add(inData[0][j+1]);
                                     }
                                     //left
                                     else if((j > 0) && (singlePxl[1][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j-1]);
+                                        sortedList.add(inData[1][j-1]);
                                     }
                                     //right
                                     else if((j < width-1) && (singlePxl[1][j+1] == 0))
                                     {
-                                        sortedList->add(&inData[1][j+1]);
+                                        sortedList.add(inData[1][j+1]);
                                     }
                                     //bottom left
                                     else if((j > 0) && (singlePxl[2][j-1] == 0))
                                     {
-                                        sortedList->add(&inData[2][j-1]);
+                                        sortedList.add(inData[2][j-1]);
                                     }
                                     //bottom
                                     else if(singlePxl[2][j] == 0)
                                     {
-                                        sortedList->add(&inData[2][j]);
+                                        sortedList.add(inData[2][j]);
                                     }
                                     //bottom right
                                     else if(singlePxl[2][j+1] == 0)
                                     {
-                                        sortedList->add(&inData[2][j+1]);
+                                        sortedList.add(inData[2][j+1]);
                                     }
                                     
-                                    if(sortedList->getSize() <= 1)
+                                    if(sortedList.getSize() <= 1)
                                     {
                                         outData[j] = inData[1][j];
                                     }
                                     else
                                     {
-                                        outData[j] = *sortedList->getMostCommonValue();
+                                        outData[j] = sortedList.getMostCommonValue();
                                         hasChangeOccured = true;
                                     }
-                                    sortedList->clearList();
+                                    sortedList.clear();
                                 }
                             }
                             else
@@ -1810,7 +1810,6 @@ namespace rsgis{ namespace classifier{
             }
             pbar.finish();
             
-            delete sortedList;
             delete[] inData[0];
             delete[] inData[1];
             delete[] inData[2];
@@ -42,7 +42,7 @@
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISImageCalcException.h"
 
-#include "datastruct/SortedGenericList.cpp"
+#include "datastruct/RSGISSmallSortedBuffer.h"
 
 #include "ogrsf_frmts.h"
 #include "ogr_api.h"
@@ -31,6 +31,26 @@ namespace rsgis{ namespace classifier{
 		this->numVariables = trainingData[0]->data->n;
 	}
 	
+	void RSGISClassifier::getClassIDs(const float* const* bands, int numVars, size_t nPxls, int *classIDs)
+	{
+		std::vector<float> variables(numVars);
+		for(size_t p = 0; p < nPxls; ++p)
+		{
+			for(int i = 0; i < numVars; ++i)
+			{
+				variables[i] = bands[i][p];
+			}
+			try
+			{
+				classIDs[p] = this->getClassID(variables.data(), numVars);
+			}
+			catch(RSGISClassificationException &e)
+			{
+				classIDs[p] = -1;
+			}
+		}
+	}
+	
 	int RSGISClassifier::getNumVariables()
 	{
 		return this->numVariables;
@@ -70,6 +90,17 @@ namespace rsgis{ namespace classifier{
 		}
 	}
 	
+	bool RSGISApplyClassifier::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+	{
+		std::vector<int> classIDs(nPxls);
+		classifier->getClassIDs(bands, numBands, nPxls, classIDs.data());
+		for(size_t p = 0; p < nPxls; ++p)
+		{
+			output[0][p] = classIDs[p];
+		}
+		return true;
+	}
+	
 	RSGISApplyClassifier::~RSGISApplyClassifier()
 	{
 		
@@ -26,6 +26,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
 #include "math/RSGISMatrices.h"
 #include "math/RSGISVectors.h"
 #include "img/RSGISCalcImageValue.h"
@@ -80,6 +81,12 @@ namespace rsgis{ namespace classifier{
 		RSGISClassifier(ClassData **trainingData, int numClasses);
 		virtual int getClassID(float *variables, int numVars) = 0;
 		virtual std::string getClassName(float *variables, int numVars) = 0;
+		/**
+		 * Classify a block of nPxls pixels, where bands[i][p] is variable i of pixel p.
+		 * Pixels which cannot be classified (i.e., getClassID throws) are given -1. The
+		 * default calls getClassID for each pixel.
+		 */
+		virtual void getClassIDs(const float* const* bands, int numVars, size_t nPxls, int *classIDs);
 		int getNumVariables();
 		void printClassIDs();
 		virtual ~RSGISClassifier();
@@ -94,6 +101,7 @@ namespace rsgis{ namespace classifier{
 	public: 
 		RSGISApplyClassifier(int numberOutBands, RSGISClassifier *classifier);
 		void calcImageValue(float *bandValues, int numBands, double *output);
+		bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
 		~RSGISApplyClassifier();
 	protected:
 		RSGISClassifier *classifier;
@@ -67,6 +67,75 @@ namespace rsgis { namespace classifier {
 		delete[] cumulativeArea;
 	}
 	
+	bool RSGISCumulativeAreaClassifierGenRules::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+	{
+		if(this->samples->m != this->numOutBands)
+		{
+			throw rsgis::img::RSGISImageCalcException("The number of output image bands needs to be equal to the number of samples.");
+		}
+		
+		if(bandValuesWidths->n != numBands)
+		{
+			throw rsgis::img::RSGISImageCalcException("Band values (i.e., wavelength) and widths need to be defined for all image bands");
+		}
+		
+		if(this->samples->n > numBands)
+		{
+			return false;
+		}
+		
+		size_t numSamples = this->samples->m;
+		std::vector<float> cumulativeArea(RSGIS_CUMAREA_TILE_PXLS);
+		std::vector<double> sumSQs(numSamples * RSGIS_CUMAREA_TILE_PXLS);
+		for(size_t tileStart = 0; tileStart < nPxls; tileStart += RSGIS_CUMAREA_TILE_PXLS)
+		{
+			size_t nTilePxls = std::min(RSGIS_CUMAREA_TILE_PXLS, nPxls - tileStart);
+			float *cumArea = cumulativeArea.data();
+			std::fill(sumSQs.begin(), sumSQs.end(), 0.0);
+			for(int b = 0; b < this->samples->n; ++b)
+			{
+				double width = bandValuesWidths->matrix[(b*2)+1];
+				const float *bandVals = bands[b] + tileStart;
+				if(b == 0)
+				{
+					for(size_t p = 0; p < nTilePxls; ++p)
+					{
+						cumArea[p] = width * bandVals[p];
+					}
+				}
+				else
+				{
+					for(size_t p = 0; p < nTilePxls; ++p)
+					{
+						cumArea[p] = cumArea[p] + (width * bandVals[p]);
+					}
+				}
+				
+				for(size_t s = 0; s < numSamples; ++s)
+				{
+					double sampleVal = this->samples->matrix[(b*this->samples->m)+s];
+					double *sampleSumSQs = sumSQs.data() + (s * RSGIS_CUMAREA_TILE_PXLS);
+					for(size_t p = 0; p < nTilePxls; ++p)
+					{
+						float tempVal = sampleVal - cumArea[p];
+						sampleSumSQs[p] = sampleSumSQs[p] + (tempVal * tempVal);
+					}
+				}
+			}
+			
+			for(size_t s = 0; s < numSamples; ++s)
+			{
+				const double *sampleSumSQs = sumSQs.data() + (s * RSGIS_CUMAREA_TILE_PXLS);
+				for(size_t p = 0; p < nTilePxls; ++p)
+				{
+					float eucDist = sqrt(sampleSumSQs[p]);
+					output[s][tileStart + p] = eucDist;
+				}
+			}
+		}
+		return true;
+	}
+	
 	float RSGISCumulativeAreaClassifierGenRules::calcEuclideanDistance(rsgis::math::Matrix *samples, int sampleNum, float *data)
 	{
 		float eucDist = 0;
@@ -127,6 +196,42 @@ namespace rsgis { namespace classifier {
 		
 	}
 	
+	bool RSGISCumulativeAreaClassifierDecide::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+	{
+		std::vector<float> minVal(RSGIS_CUMAREA_TILE_PXLS);
+		std::vector<int> minIdx(RSGIS_CUMAREA_TILE_PXLS);
+		for(size_t tileStart = 0; tileStart < nPxls; tileStart += RSGIS_CUMAREA_TILE_PXLS)
+		{
+			size_t nTilePxls = std::min(RSGIS_CUMAREA_TILE_PXLS, nPxls - tileStart);
+			std::fill(minIdx.begin(), minIdx.begin() + nTilePxls, 0);
+			if(numBands > 0)
+			{
+				std::copy(bands[0] + tileStart, bands[0] + tileStart + nTilePxls, minVal.begin());
+			}
+			else
+			{
+				std::fill(minVal.begin(), minVal.begin() + nTilePxls, 0.0f);
+			}
+			for(int i = 1; i < numBands; ++i)
+			{
+				const float *ruleVals = bands[i] + tileStart;
+				for(size_t p = 0; p < nTilePxls; ++p)
+				{
+					if(ruleVals[p] < minVal[p])
+					{
+						minIdx[p] = i;
+						minVal[p] = ruleVals[p];
+					}
+				}
+			}
+			for(size_t p = 0; p < nTilePxls; ++p)
+			{
+				output[0][tileStart + p] = (minVal[p] < threshold)?(minIdx[p]+1):-1;
+			}
+		}
+		return true;
+	}
+	
 	RSGISCumulativeAreaClassifierDecide::~RSGISCumulativeAreaClassifierDecide()
 	{
 		
@@ -26,6 +26,8 @@
 
 #include <cmath>
 #include <limits>
+#include <vector>
+#include <algorithm>
 
 #include "img/RSGISCalcImage.h"
 #include "img/RSGISCalcImageValue.h"
@@ -49,6 +51,9 @@
 
 namespace rsgis { namespace classifier {
     
+    /// The number of pixels processed at a time by the cumulative area block implementations.
+    static const size_t RSGIS_CUMAREA_TILE_PXLS( 256 );
+    
 	/**
 	 * A pair of classes which generate the a rule image (distance to sample) using
 	 * the euclidean distance to measure the distance between two cumulative area
@@ -61,6 +66,14 @@ namespace rsgis { namespace classifier {
 	public:
 		RSGISCumulativeAreaClassifierGenRules(int numOutBands, rsgis::math::Matrix *bandValuesWidths, rsgis::math::Matrix *samples);
 		void calcImageValue(float *bandValues, int numBands, double *output);
+		/**
+		 * The cumulative areas of a tile of pixels are summed band by band and the squared
+		 * differences to all the samples are accumulated as each band is added, so the
+		 * per pixel profile is never stored. The sums are in the per pixel order and
+		 * precision so the distances are identical.
+		 */
+		bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+		rsgis::img::RSGISCalcImageValue* clone(){return new RSGISCumulativeAreaClassifierGenRules(this->numOutBands, this->bandValuesWidths, this->samples);};
 		float* calculateCumulativeArea(float *dataValues, int numVals);
 		float calcEuclideanDistance(rsgis::math::Matrix *sample, int sampleNum, float *data);
 		~RSGISCumulativeAreaClassifierGenRules();
@@ -75,6 +88,8 @@ namespace rsgis { namespace classifier {
 	public:
 		RSGISCumulativeAreaClassifierDecide(int numOutBands, double threshold);
 		void calcImageValue(float *bandValues, int numBands, double *output);
+		bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+		rsgis::img::RSGISCalcImageValue* clone(){return new RSGISCumulativeAreaClassifierDecide(this->numOutBands, this->threshold);};
 		~RSGISCumulativeAreaClassifierDecide();
 	private:
 		double threshold;
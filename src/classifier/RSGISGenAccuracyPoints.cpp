@@ -588,10 +588,11 @@ namespace rsgis{namespace classifier{
             int imgClassColIdx = featDefn->GetFieldIndex(vecClassImgCol.c_str());
             int refClassColIdx = featDefn->GetFieldIndex(vecClassRefCol.c_str());
             int processedColIdx = featDefn->GetFieldIndex("Processed");
+            rsgis::utils::RSGISOGRFeatureSink featSink(outputSHPLayer);
             
             for(std::list<RSGISAccPoint*>::iterator iterPts = accPts->begin(); iterPts != accPts->end(); ++iterPts)
             {
-                OGRFeature *poFeature = new OGRFeature(featDefn);
+                OGRFeature *poFeature = featSink.getFeature();
                 OGRPoint *pt = new OGRPoint((*iterPts)->eastings, (*iterPts)->northings, 0.0);
                 poFeature->SetGeometryDirectly(pt);
                 
@@ -599,8 +600,9 @@ namespace rsgis{namespace classifier{
                 poFeature->SetField(refClassColIdx, (*iterPts)->trueClassName.c_str());
                 poFeature->SetField(processedColIdx, 0);
                 
-                outputSHPLayer->CreateFeature(poFeature);
+                featSink.writeFeature(poFeature);
             }
+            featSink.close();
             
         }
         catch(rsgis::RSGISImageException &e)
@@ -796,12 +798,13 @@ namespace rsgis{namespace classifier{
             int imgClassColIdx = featDefn->GetFieldIndex(vecClassImgCol.c_str());
             int refClassColIdx = featDefn->GetFieldIndex(vecClassRefCol.c_str());
             int processedColIdx = featDefn->GetFieldIndex("Processed");
+            rsgis::utils::RSGISOGRFeatureSink featSink(outputSHPLayer);
             
             for(std::vector<std::vector<RSGISAccPoint*> >::iterator iterPtsVecs = accClassPts->begin(); iterPtsVecs != accClassPts->end(); ++iterPtsVecs)
             {
                 for(std::vector<RSGISAccPoint*>::iterator iterPts = (*iterPtsVecs).begin(); iterPts != (*iterPtsVecs).end(); ++iterPts)
                 {
-                    OGRFeature *poFeature = new OGRFeature(featDefn);
+                    OGRFeature *poFeature = featSink.getFeature();
                     OGRPoint *pt = new OGRPoint((*iterPts)->eastings, (*iterPts)->northings, 0.0);
                     poFeature->SetGeometryDirectly(pt);
                     
@@ -809,10 +812,11 @@ namespace rsgis{namespace classifier{
                     poFeature->SetField(refClassColIdx, (*iterPts)->trueClassName.c_str());
                     poFeature->SetField(processedColIdx, 0);
                     
-                    outputSHPLayer->CreateFeature(poFeature);
+                    featSink.writeFeature(poFeature);
                 }
             }
             
+            featSink.close();
             delete classNames;
             delete accClassPts;
             
@@ -883,24 +887,31 @@ namespace rsgis{namespace classifier{
             }
 
             unsigned long numClasses = classNames->size();
-            auto **classPxlLst = new std::vector<std::pair<double, double> >*[numClasses];
-            unsigned int idx = 0;
-            for(auto iterClasses = classNames->begin(); iterClasses != classNames->end(); ++iterClasses)
+            // The pixel values (RAT rows) for each class name.
+            std::vector<std::vector<long> > classPxlVals(numClasses);
+            for(auto iterLUT = pxlValLUT.begin(); iterLUT != pxlValLUT.end(); ++iterLUT)
             {
-                classPxlLst[idx] = new std::vector<std::pair<double, double> >();
-                ++idx;
+                if(iterLUT->first > 0)
+                {
+                    size_t clsIdx = std::find(classNames->begin(), classNames->end(), imgClassColVals->at(iterLUT->first)) - classNames->begin();
+                    classPxlVals[clsIdx].push_back(iterLUT->first);
+                }
             }
             
-            rsgis::img::RSGISCalcImageValue *exClassPxlLocs = new RSGISExtractClassPxllocs(classPxlLst, numClasses, pxlValLUT);
-            rsgis::img::RSGISCalcImage calcImg = rsgis::img::RSGISCalcImage(exClassPxlLocs);
-            calcImg.calcImageExtent(&inputImage, 1, 0);
-            delete exClassPxlLocs;
+            // The pixel locations of the classes, from the image's pixel index sidecar if one has been saved.
+            rsgis::img::RSGISClassPixelIndex pxlIndex;
+            pxlIndex.loadOrCreateIndex(inputImage, 1);
+            std::vector<size_t> classNumPxls(numClasses);
+            for(unsigned long i = 0; i < numClasses; ++i)
+            {
+                classNumPxls[i] = pxlIndex.getNumPxls(classPxlVals[i]);
+            }
             
             bool **usedPxl = new bool*[numClasses];
             for(unsigned long i = 0; i < numClasses; ++i)
             {
-                usedPxl[i] = new bool[classPxlLst[i]->size()];
-                for(unsigned long j = 0; j < classPxlLst[i]->size(); ++j)
+                usedPxl[i] = new bool[classNumPxls[i]];
+                for(unsigned long j = 0; j < classNumPxls[i]; ++j)
                 {
                     usedPxl[i][j] = false;
                 }
@@ -933,6 +944,7 @@ namespace rsgis{namespace classifier{
             int imgClassColIdx = featDefn->GetFieldIndex(vecClassImgCol.c_str());
             int refClassColIdx = featDefn->GetFieldIndex(vecClassRefCol.c_str());
             int processedColIdx = featDefn->GetFieldIndex("Processed");
+            rsgis::utils::RSGISOGRFeatureSink featSink(outputSHPLayer);
             unsigned long pxlIdx = 0;
             bool foundPxl = false;
             unsigned long findPxlIterCount = 0;
@@ -942,13 +954,13 @@ namespace rsgis{namespace classifier{
             {
                 std::cout << "Processing Class \"" << classNames->at(i) << "\"\n";
                 srand(seed);
-                checkPt = classPxlLst[i]->size();
+                checkPt = classNumPxls[i];
                 for(unsigned long j = 0; j < numPts; ++j)
                 {
                     foundPxl = false;
                     while(!foundPxl)
                     {
-                        pxlIdx = rand() % classPxlLst[i]->size();
+                        pxlIdx = rand() % classNumPxls[i];
                         if(!usedPxl[i][pxlIdx])
                         {
                             foundPxl = true;
@@ -957,7 +969,7 @@ namespace rsgis{namespace classifier{
                         else if(findPxlIterCount > checkPt)
                         {
                             usedAllPxls = true;
-                            for(unsigned long n = 0; n < classPxlLst[i]->size(); ++n)
+                            for(unsigned long n = 0; n < classNumPxls[i]; ++n)
                             {
                                 if(!usedPxl[i][n])
                                 {
@@ -969,32 +981,31 @@ namespace rsgis{namespace classifier{
                             if(usedAllPxls)
                             {
                                 rsgis::utils::RSGISTextUtils txtUtils;
-                                throw rsgis::RSGISImageException("All pixels (n="+txtUtils.sizettostring(classPxlLst[i]->size())+") for class \""+classNames->at(i)+"\" have been sampled within the image");
+                                throw rsgis::RSGISImageException("All pixels (n="+txtUtils.sizettostring(classNumPxls[i])+") for class \""+classNames->at(i)+"\" have been sampled within the image");
                             }
-                            checkPt = checkPt + classPxlLst[i]->size();
+                            checkPt = checkPt + classNumPxls[i];
                         }
                         
                         ++findPxlIterCount;
                     }
                     
-                    OGRFeature *poFeature = new OGRFeature(featDefn);
-                    OGRPoint *pt = new OGRPoint(classPxlLst[i]->at(pxlIdx).first, classPxlLst[i]->at(pxlIdx).second, 0.0);
+                    OGRFeature *poFeature = featSink.getFeature();
+                    double ptX = 0.0;
+                    double ptY = 0.0;
+                    pxlIndex.getPixelCentre(classPxlVals[i], pxlIdx, &ptX, &ptY);
+                    OGRPoint *pt = new OGRPoint(ptX, ptY, 0.0);
                     poFeature->SetGeometryDirectly(pt);
                     
                     poFeature->SetField(imgClassColIdx, classNames->at(i).c_str());
                     poFeature->SetField(refClassColIdx, classNames->at(i).c_str());
                     poFeature->SetField(processedColIdx, 0);
                     
-                    outputSHPLayer->CreateFeature(poFeature);
+                    featSink.writeFeature(poFeature);
                 }
             }
             
+            featSink.close();
             delete classNames;
-            for(idx = 0; idx < numClasses; ++idx)
-            {
-                delete classPxlLst[idx];
-            }
-            delete[] classPxlLst;
         }
         catch(rsgis::RSGISImageException &e)
         {
@@ -1063,24 +1074,31 @@ namespace rsgis{namespace classifier{
             }
 
             unsigned long numClasses = classNames->size();
-            auto **classPxlLst = new std::vector<std::pair<double, double> >*[numClasses];
-            unsigned int idx = 0;
-            for(auto iterClasses = classNames->begin(); iterClasses != classNames->end(); ++iterClasses)
+            // The pixel values (RAT rows) for each class name.
+            std::vector<std::vector<long> > classPxlVals(numClasses);
+            for(auto iterLUT = pxlValLUT.begin(); iterLUT != pxlValLUT.end(); ++iterLUT)
             {
-                classPxlLst[idx] = new std::vector<std::pair<double, double> >();
-                ++idx;
+                if(iterLUT->first > 0)
+                {
+                    size_t clsIdx = std::find(classNames->begin(), classNames->end(), imgClassColVals->at(iterLUT->first)) - classNames->begin();
+                    classPxlVals[clsIdx].push_back(iterLUT->first);
+                }
+            }
+            
+            // The pixel locations of the classes, from the image's pixel index sidecar if one has been saved.
+            rsgis::img::RSGISClassPixelIndex pxlIndex;
+            pxlIndex.loadOrCreateIndex(inputImage, 1);
+            std::vector<size_t> classNumPxls(numClasses);
+            for(unsigned long i = 0; i < numClasses; ++i)
+            {
+                classNumPxls[i] = pxlIndex.getNumPxls(classPxlVals[i]);
             }
-
-            rsgis::img::RSGISCalcImageValue *exClassPxlLocs = new RSGISExtractClassPxllocs(classPxlLst, numClasses, pxlValLUT);
-            rsgis::img::RSGISCalcImage calcImg = rsgis::img::RSGISCalcImage(exClassPxlLocs);
-            calcImg.calcImageExtent(&inputImage, 1, 0);
-            delete exClassPxlLocs;
 
             bool **usedPxl = new bool*[numClasses];
             for(unsigned long i = 0; i < numClasses; ++i)
             {
-                usedPxl[i] = new bool[classPxlLst[i]->size()];
-                for(unsigned long j = 0; j < classPxlLst[i]->size(); ++j)
+                usedPxl[i] = new bool[classNumPxls[i]];
+                for(unsigned long j = 0; j < classNumPxls[i]; ++j)
                 {
                     usedPxl[i][j] = false;
                 }
@@ -1088,7 +1106,7 @@ namespace rsgis{namespace classifier{
 
             double totNumPxls = 0;
             for(unsigned long i = 0; i < numClasses; ++i) {
-                totNumPxls += classPxlLst[i]->size();
+                totNumPxls += classNumPxls[i];
             }
             std::cout << "Total number of pixels is " << totNumPxls << std::endl;
 
@@ -1119,6 +1137,7 @@ namespace rsgis{namespace classifier{
             int imgClassColIdx = featDefn->GetFieldIndex(vecClassImgCol.c_str());
             int refClassColIdx = featDefn->GetFieldIndex(vecClassRefCol.c_str());
             int processedColIdx = featDefn->GetFieldIndex("Processed");
+            rsgis::utils::RSGISOGRFeatureSink featSink(outputSHPLayer);
             unsigned long pxlIdx = 0;
             bool foundPxl = false;
             unsigned long findPxlIterCount = 0;
@@ -1131,7 +1150,7 @@ namespace rsgis{namespace classifier{
             {
                 std::cout << "Processing Class \"" << classNames->at(i) << "\"\n";
                 srand(seed);
-                checkPt = classPxlLst[i]->size();
+                checkPt = classNumPxls[i];
                 propOfScn = checkPt/totNumPxls;
                 nSmplPts = floor((propOfScn * numPts)+0.5);
                 if (nSmplPts < minNumPts)
@@ -1149,7 +1168,7 @@ namespace rsgis{namespace classifier{
                     foundPxl = false;
                     while(!foundPxl)
                     {
-                        pxlIdx = rand() % classPxlLst[i]->size();
+                        pxlIdx = rand() % classNumPxls[i];
                         if(!usedPxl[i][pxlIdx])
                         {
                             foundPxl = true;
@@ -1158,7 +1177,7 @@ namespace rsgis{namespace classifier{
                         else if(findPxlIterCount > checkPt)
                         {
                             usedAllPxls = true;
-                            for(unsigned long n = 0; n < classPxlLst[i]->size(); ++n)
+                            for(unsigned long n = 0; n < classNumPxls[i]; ++n)
                             {
                                 if(!usedPxl[i][n])
                                 {
@@ -1170,33 +1189,32 @@ namespace rsgis{namespace classifier{
                             if(usedAllPxls)
                             {
                                 rsgis::utils::RSGISTextUtils txtUtils;
-                                throw rsgis::RSGISImageException("All pixels (n="+txtUtils.sizettostring(classPxlLst[i]->size())+") for class \""+classNames->at(i)+"\" have been sampled within the image");
+                                throw rsgis::RSGISImageException("All pixels (n="+txtUtils.sizettostring(classNumPxls[i])+") for class \""+classNames->at(i)+"\" have been sampled within the image");
                             }
-                            checkPt = checkPt + classPxlLst[i]->size();
+                            checkPt = checkPt + classNumPxls[i];
                         }
 
                         ++findPxlIterCount;
                     }
 
-                    OGRFeature *poFeature = new OGRFeature(featDefn);
-                    OGRPoint *pt = new OGRPoint(classPxlLst[i]->at(pxlIdx).first, classPxlLst[i]->at(pxlIdx).second, 0.0);
+                    OGRFeature *poFeature = featSink.getFeature();
+                    double ptX = 0.0;
+                    double ptY = 0.0;
+                    pxlIndex.getPixelCentre(classPxlVals[i], pxlIdx, &ptX, &ptY);
+                    OGRPoint *pt = new OGRPoint(ptX, ptY, 0.0);
                     poFeature->SetGeometryDirectly(pt);
 
                     poFeature->SetField(imgClassColIdx, classNames->at(i).c_str());
                     poFeature->SetField(refClassColIdx, classNames->at(i).c_str());
                     poFeature->SetField(processedColIdx, 0);
 
-                    outputSHPLayer->CreateFeature(poFeature);
+                    featSink.writeFeature(poFeature);
                 }
             }
 
+            featSink.close();
             std::cout << "Total number of samples: " << totNSmpls << std::endl;
             delete classNames;
-            for(idx = 0; idx < numClasses; ++idx)
-            {
-                delete classPxlLst[idx];
-            }
-            delete[] classPxlLst;
         }
         catch(rsgis::RSGISImageException &e)
         {
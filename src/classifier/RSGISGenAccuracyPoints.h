@@ -30,6 +30,7 @@
 #include <vector>
 #include <map>
 #include <utility>
+#include <algorithm>
 
 #include "gdal_priv.h"
 #include "gdal_rat.h"
@@ -38,6 +39,9 @@
 #include "common/rsgis-tqdm.h"
 #include "common/RSGISImageException.h"
 #include "utils/RSGISTextUtils.h"
+#include "utils/RSGISOGRFeatureSink.h"
+
+#include "img/RSGISClassPixelIndex.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
 
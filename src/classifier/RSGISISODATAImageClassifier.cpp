@@ -23,6 +23,7 @@
  */
 
 #include "RSGISISODATAImageClassifier.h"
+#include "common/RSGISGDALInit.h"
 
 
 namespace rsgis{ namespace classifier{
@@ -32,6 +33,7 @@ namespace rsgis{ namespace classifier{
 		this->inputImageFile = inputImageFile;
 		clusterIDVal = 0;
 		this->printinfo = printinfo;
+		this->numThreads = 1;
 	}
 	
 	void RSGISISODATAClassifier::initClusterCentresKpp(unsigned int numClusters)
@@ -40,7 +42,7 @@ namespace rsgis{ namespace classifier{
 		rsgis::math::RSGISVectors vecUtils;
 		
 		// Open Image
-		GDALAllRegister();		
+		rsgis::RSGISGDALInit::init();
 		try
 		{
 			this->numDatasets = 1;
@@ -138,7 +140,7 @@ namespace rsgis{ namespace classifier{
 		rsgis::math::RSGISVectors vecUtils;
 		
 		// Open Image
-		GDALAllRegister();		
+		rsgis::RSGISGDALInit::init();
 		try
 		{
 			this->numDatasets = 1;
@@ -244,6 +246,43 @@ namespace rsgis{ namespace classifier{
 	}
 	
 	void RSGISISODATAClassifier::calcClusterCentres(double terminalThreshold, unsigned int maxIterations, unsigned int minNumVals, double minDistanceBetweenCentres, double stddevThres, float propOverAvgDist)
+	{
+		this->runIterations(terminalThreshold, maxIterations, minNumVals, minDistanceBetweenCentres, stddevThres, propOverAvgDist, NULL);
+	}
+	
+	void RSGISISODATAClassifier::calcClusterCentresSampled(double terminalThreshold, unsigned int maxIterations, unsigned int minNumVals, double minDistanceBetweenCentres, double stddevThres, float propOverAvgDist, unsigned int subSample)
+	{
+		if(!hasInitClusterCentres)
+		{
+			throw RSGISClassificationException("The cluster centres have not been initialised.");
+		}
+		if(subSample == 0)
+		{
+			subSample = 1;
+		}
+		
+		// Read the sample into one contiguous array (pixel-major).
+		std::vector<float> pxlVals;
+		{
+			rsgis::img::RSGISImageClustering imgClustering;
+			std::vector< std::vector<float> > *samplePxls = imgClustering.sampleImage(datasets[0], subSample, false);
+			pxlVals.reserve(samplePxls->size()*numImageBands);
+			for(std::vector< std::vector<float> >::iterator iterPxls = samplePxls->begin(); iterPxls != samplePxls->end(); ++iterPxls)
+			{
+				pxlVals.insert(pxlVals.end(), (*iterPxls).begin(), (*iterPxls).end());
+			}
+			delete samplePxls;
+		}
+		if(pxlVals.empty())
+		{
+			throw RSGISClassificationException("No pixels were sampled from the image.");
+		}
+		std::cout << "Clustering " << (pxlVals.size()/numImageBands) << " sampled pixels\n";
+		
+		this->runIterations(terminalThreshold, maxIterations, minNumVals, minDistanceBetweenCentres, stddevThres, propOverAvgDist, &pxlVals);
+	}
+	
+	void RSGISISODATAClassifier::runIterations(double terminalThreshold, unsigned int maxIterations, unsigned int minNumVals, double minDistanceBetweenCentres, double stddevThres, float propOverAvgDist, std::vector<float> *samplePxls)
 	{
 		if(hasInitClusterCentres)
 		{
@@ -251,9 +290,48 @@ namespace rsgis{ namespace classifier{
 			try 
 			{
 				RSGISISODATACalcPixelClusterCalcImageVal *calcClusterCentre = new RSGISISODATACalcPixelClusterCalcImageVal(0, this->clusterCentres, this->numImageBands);
-				RSGISISODATACalcPixelClusterStdDevCalcImageVal *calcClusterStdDevs = new RSGISISODATACalcPixelClusterStdDevCalcImageVal(0, this->clusterCentres, this->numImageBands);
 				rsgis::img::RSGISCalcImage *calcImageClusterCentres = new rsgis::img::RSGISCalcImage(calcClusterCentre, "", true);
-				rsgis::img::RSGISCalcImage *calcImageClusterStddevs = new rsgis::img::RSGISCalcImage(calcClusterStdDevs, "", true);
+				calcImageClusterCentres->setNumThreads(this->numThreads);
+				rsgis::RSGISThreadPool threadPool(this->numThreads);
+				
+				// Accumulate the statistics of the new centres from the sample, with a copy
+				// of the calculator for each thread merged in thread order.
+				auto calcSampleCentres = [&]()
+				{
+					size_t numSamplePxls = samplePxls->size()/this->numImageBands;
+					std::vector<RSGISISODATACalcPixelClusterCalcImageVal*> threadCalcs(threadPool.getNumThreads(), NULL);
+					threadCalcs[0] = calcClusterCentre;
+					try
+					{
+						for(unsigned int t = 1; t < threadCalcs.size(); ++t)
+						{
+							threadCalcs[t] = dynamic_cast<RSGISISODATACalcPixelClusterCalcImageVal*>(calcClusterCentre->clone());
+						}
+						threadPool.parallelFor(0, numSamplePxls, [&](unsigned int t, size_t pStart, size_t pEnd)
+						{
+							for(size_t p = pStart; p < pEnd; ++p)
+							{
+								threadCalcs[t]->calcImageValue(&(*samplePxls)[p*this->numImageBands], this->numImageBands);
+							}
+						});
+						for(unsigned int t = 1; t < threadCalcs.size(); ++t)
+						{
+							calcClusterCentre->reduce(threadCalcs[t]);
+						}
+					}
+					catch(...)
+					{
+						for(unsigned int t = 1; t < threadCalcs.size(); ++t)
+						{
+							delete threadCalcs[t];
+						}
+						throw;
+					}
+					for(unsigned int t = 1; t < threadCalcs.size(); ++t)
+					{
+						delete threadCalcs[t];
+					}
+				};
 				
 				std::vector<ClusterCentreISO*> *newClusterCentres = NULL;
 				double centreMoveDistanceSum = 0;
@@ -273,7 +351,14 @@ namespace rsgis{ namespace classifier{
 					averageDistance = 0;
 					
 					// Identify new centres
-					calcImageClusterCentres->calcImage(datasets, numDatasets);
+					if(samplePxls == NULL)
+					{
+						calcImageClusterCentres->calcImage(datasets, numDatasets);
+					}
+					else
+					{
+						calcSampleCentres();
+					}
 					newClusterCentres = calcClusterCentre->getNewClusterCentres();					
 					// Calculate distance between new and old centres.
 					iterNewCentres = newClusterCentres->begin();
@@ -294,6 +379,10 @@ namespace rsgis{ namespace classifier{
 							{
 								(*iterNewCentres)->data->vector[j] = (*iterNewCentres)->data->vector[j] / (*iterNewCentres)->numVals;
 							}
+							// The squared differences were summed about the current centre so are moved to the new centre.
+							double centreShift = (*iterNewCentres)->data->vector[j] - (*iterCentres)->data->vector[j];
+							double sqDiffSum = (*iterNewCentres)->stddev->vector[j] - ((*iterNewCentres)->numVals * centreShift * centreShift);
+							(*iterNewCentres)->stddev->vector[j] = sqrt(std::max(sqDiffSum, 0.0)/(*iterNewCentres)->numVals);
 						}
 						
 						(*iterNewCentres)->avgDist = (*iterNewCentres)->avgDist / (*iterNewCentres)->numVals;
@@ -311,18 +400,6 @@ namespace rsgis{ namespace classifier{
 					}
 					else
 					{
-						// Calc cluster std devs
-						calcClusterStdDevs->reset(newClusterCentres);
-						calcImageClusterStddevs->calcImage(datasets, numDatasets);
-						for(iterNewCentres = newClusterCentres->begin(); iterNewCentres != newClusterCentres->end(); ++iterNewCentres)
-						{
-							for(unsigned int i = 0; i < this->numImageBands; ++i)
-							{
-								(*iterNewCentres)->stddev->vector[i] = sqrt((*iterNewCentres)->stddev->vector[i]/(*iterNewCentres)->numVals);
-							}
-						}
-						
-						
 						// Replace old cluster centres within new centres
 						// Clear current currentCentres
 						for(iterCentres = clusterCentres->begin(); iterCentres != clusterCentres->end();)
@@ -498,9 +575,7 @@ namespace rsgis{ namespace classifier{
 				}
 				
 				delete calcClusterCentre;
-				delete calcClusterStdDevs;
 				delete calcImageClusterCentres;
-				delete calcImageClusterStddevs;
 			}
 			catch (rsgis::img::RSGISImageCalcException &e) 
 			{
@@ -528,6 +603,7 @@ namespace rsgis{ namespace classifier{
 			
 			RSGISApplyISODATAClassifierCalcImageVal *applyClass = new RSGISApplyISODATAClassifierCalcImageVal(1, this->clusterCentres);
             rsgis::img::RSGISCalcImage *calcImage = new rsgis::img::RSGISCalcImage(applyClass, "", true);
+			calcImage->setNumThreads(this->numThreads);
 			calcImage->calcImage(this->datasets, this->numDatasets, outputImageFile);
 			
 			delete applyClass;
@@ -592,52 +668,81 @@ namespace rsgis{ namespace classifier{
 	{
 		// Identify cluster within which point is associated with
 		double minDistance = 0;
-		ClusterCentreISO *minClusterCentre = NULL;
+		size_t minClusterIdx = 0;
 		bool first = true;
 		double sum = 0;
 		double distance = 0;
-		std::vector<ClusterCentreISO*>::iterator iterCentres;
-		for(iterCentres = clusterCentres->begin(); iterCentres != clusterCentres->end(); ++iterCentres)
+		for(size_t c = 0; c < clusterCentres->size(); ++c)
 		{
+			const double *centreVals = clusterCentres->at(c)->data->vector;
 			sum = 0;
 			for(int j = 0; j < numBands; ++j)
 			{
-				sum += (((*iterCentres)->data->vector[j] - bandValues[j])*((*iterCentres)->data->vector[j] - bandValues[j]));
+				sum += ((centreVals[j] - bandValues[j])*(centreVals[j] - bandValues[j]));
 			}
 			distance = sum/numBands;
 			
 			if(first)
 			{
 				minDistance = distance;
-				minClusterCentre = *iterCentres;
+				minClusterIdx = c;
 				first = false;
 			}
 			else if(distance < minDistance)
 			{
 				minDistance = distance;
-				minClusterCentre = *iterCentres;
+				minClusterIdx = c;
 			}
 		}
+		if(first)
+		{
+			return;
+		}
 				
-		// add to sum for next centre
-		for(iterCentres = newClusterCentres->begin(); iterCentres != newClusterCentres->end(); ++iterCentres)
+		// add to sum for next centre (the new centres are in the same order as the current centres)
+		const double *centreVals = clusterCentres->at(minClusterIdx)->data->vector;
+		ClusterCentreISO *newCentre = newClusterCentres->at(minClusterIdx);
+		for(int i = 0; i < numBands; ++i)
 		{
-			if((*iterCentres)->classID == minClusterCentre->classID)
-			{
-				for(int i = 0; i < numBands; ++i)
-				{
-					(*iterCentres)->data->vector[i] += bandValues[i];
-				}
-				(*iterCentres)->numVals += 1;
-				(*iterCentres)->avgDist += minDistance;
-				break;
-			}
+			newCentre->data->vector[i] += bandValues[i];
+			newCentre->stddev->vector[i] += (centreVals[i] - bandValues[i])*(centreVals[i] - bandValues[i]);
 		}
+		newCentre->numVals += 1;
+		newCentre->avgDist += minDistance;
 		
 		sumDist += minDistance;
 		++numVals;
 	}
 	
+	rsgis::img::RSGISCalcImageValue* RSGISISODATACalcPixelClusterCalcImageVal::clone()
+	{
+		// The clone shares the (read only) current centres but has its own sums.
+		return new RSGISISODATACalcPixelClusterCalcImageVal(this->numOutBands, this->clusterCentres, this->numImageBands);
+	}
+	
+	void RSGISISODATACalcPixelClusterCalcImageVal::reduce(rsgis::img::RSGISCalcImageValue *other)
+	{
+		RSGISISODATACalcPixelClusterCalcImageVal *otherCalc = dynamic_cast<RSGISISODATACalcPixelClusterCalcImageVal*>(other);
+		if((otherCalc == NULL) || (otherCalc->newClusterCentres->size() != this->newClusterCentres->size()))
+		{
+			throw rsgis::img::RSGISImageCalcException("Can only reduce with another RSGISISODATACalcPixelClusterCalcImageVal with the same cluster centres.");
+		}
+		for(size_t c = 0; c < newClusterCentres->size(); ++c)
+		{
+			ClusterCentreISO *newCentre = newClusterCentres->at(c);
+			ClusterCentreISO *otherCentre = otherCalc->newClusterCentres->at(c);
+			for(unsigned int i = 0; i < numImageBands; ++i)
+			{
+				newCentre->data->vector[i] += otherCentre->data->vector[i];
+				newCentre->stddev->vector[i] += otherCentre->stddev->vector[i];
+			}
+			newCentre->numVals += otherCentre->numVals;
+			newCentre->avgDist += otherCentre->avgDist;
+		}
+		sumDist += otherCalc->sumDist;
+		numVals += otherCalc->numVals;
+	}
+	
 	std::vector<ClusterCentreISO*>* RSGISISODATACalcPixelClusterCalcImageVal::getNewClusterCentres()
 	{
 		return newClusterCentres;
@@ -786,6 +891,11 @@ namespace rsgis{ namespace classifier{
 		output[0] = minIdx;
 	}
 	
+	rsgis::img::RSGISCalcImageValue* RSGISApplyISODATAClassifierCalcImageVal::clone()
+	{
+		return new RSGISApplyISODATAClassifierCalcImageVal(this->numOutBands, this->clusterCentres);
+	}
+	
 	RSGISApplyISODATAClassifierCalcImageVal::~RSGISApplyISODATAClassifierCalcImageVal()
 	{
 		
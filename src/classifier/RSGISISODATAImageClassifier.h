@@ -31,11 +31,15 @@
 #include <fstream>
 #include <string>
 #include <vector>
+#include <cmath>
+#include <algorithm>
 
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISImageStatistics.h"
+#include "img/RSGISImageClustering.h"
 
+#include "common/RSGISThreadPool.h"
 #include "common/RSGISClassificationException.h"
 
 #include "classifier/RSGISClassifier.h"
@@ -68,9 +72,20 @@ namespace rsgis{ namespace classifier{
 		void initClusterCentresRandom(unsigned int numClusters);
 		void initClusterCentresKpp(unsigned int numClusters);
 		void calcClusterCentres(double terminalThreshold, unsigned int maxIterations, unsigned int minNumVals, double minDistanceBetweenCentres, double stddevThres, float propOverAvgDist);
+		/**
+		 * Calculate the cluster centres from a sample of the image pixels (every subSample
+		 * pixel of each row and column) held in memory rather than passes through the whole
+		 * image; generateOutputImage then labels the whole image. minNumVals applies to the
+		 * number of sampled pixels.
+		 */
+		void calcClusterCentresSampled(double terminalThreshold, unsigned int maxIterations, unsigned int minNumVals, double minDistanceBetweenCentres, double stddevThres, float propOverAvgDist, unsigned int subSample);
 		void generateOutputImage(std::string outputImageFile);
+		/** Set the number of threads used to calculate the cluster centres and output image (0 uses all the hardware threads). */
+		void setNumThreads(unsigned int numThreads){this->numThreads = numThreads;};
 		~RSGISISODATAClassifier();
 	protected:
+		/** The iterations of calcClusterCentres, over the sample pixels (pixel-major) if samplePxls is not NULL. */
+		void runIterations(double terminalThreshold, unsigned int maxIterations, unsigned int minNumVals, double minDistanceBetweenCentres, double stddevThres, float propOverAvgDist, std::vector<float> *samplePxls);
 		std::string inputImageFile;
 		std::vector<ClusterCentreISO*> *clusterCentres;
 		bool hasInitClusterCentres;
@@ -79,13 +94,22 @@ namespace rsgis{ namespace classifier{
 		unsigned int numImageBands;
 		unsigned int clusterIDVal;
 		bool printinfo;
+		unsigned int numThreads;
 	};
 	
+	/**
+	 * Assigns each pixel to its nearest cluster centre, summing the pixel values
+	 * (data), the squared differences to the current centre (stddev), the distances
+	 * (avgDist) and the number of pixels (numVals) for each of the new centres, so
+	 * the means and standard deviations come from a single pass.
+	 */
 	class DllExport RSGISISODATACalcPixelClusterCalcImageVal : public rsgis::img::RSGISCalcImageValue
 	{
 	public: 
 		RSGISISODATACalcPixelClusterCalcImageVal(int numOutBands, std::vector<ClusterCentreISO*> *clusterCentres, unsigned int numImageBands);
 		void calcImageValue(float *bandValues, int numBands);
+		rsgis::img::RSGISCalcImageValue* clone();
+		void reduce(rsgis::img::RSGISCalcImageValue *other);
 		std::vector<ClusterCentreISO*>* getNewClusterCentres();
 		void reset(std::vector<ClusterCentreISO*> *clusterCentres);
 		double getAverageDistance();
@@ -115,6 +139,7 @@ namespace rsgis{ namespace classifier{
 	public: 
 		RSGISApplyISODATAClassifierCalcImageVal(int numOutBands, std::vector<ClusterCentreISO*> *clusterCentres);
 		void calcImageValue(float *bandValues, int numBands, double *output);
+		rsgis::img::RSGISCalcImageValue* clone();
 		~RSGISApplyISODATAClassifierCalcImageVal();
 	protected:
 		std::vector<ClusterCentreISO*> *clusterCentres;
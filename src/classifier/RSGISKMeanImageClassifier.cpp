@@ -23,10 +23,70 @@
  */
 
 #include "RSGISKMeanImageClassifier.h"
+#include "common/RSGISGDALInit.h"
 
 namespace rsgis{ namespace classifier{
 	
-	RSGISKMeansClassifier::RSGISKMeansClassifier(std::string inputImageFile, bool printinfo): clusterCentres(NULL), numClusters(0), hasInitClusterCentres(false), datasets(NULL), numDatasets(0), printinfo(false)
+	RSGISKMeanCentreLookup::RSGISKMeanCentreLookup(): numClusters(0), numImageBands(0)
+	{
+		
+	}
+	
+	void RSGISKMeanCentreLookup::setClusterCentres(ClusterCentre **clusterCentres, unsigned int numClusters, unsigned int numImageBands)
+	{
+		this->numClusters = numClusters;
+		this->numImageBands = numImageBands;
+		this->centreVals.resize(numClusters*numImageBands);
+		for(unsigned int i = 0; i < numClusters; ++i)
+		{
+			for(unsigned int j = 0; j < numImageBands; ++j)
+			{
+				this->centreVals[(i*numImageBands)+j] = clusterCentres[i]->data->vector[j];
+			}
+		}
+		
+		this->centreSqDists.resize(numClusters*numClusters);
+		for(unsigned int i = 0; i < numClusters; ++i)
+		{
+			this->centreSqDists[(i*numClusters)+i] = 0;
+			for(unsigned int k = i+1; k < numClusters; ++k)
+			{
+				double sum = 0;
+				for(unsigned int j = 0; j < numImageBands; ++j)
+				{
+					double diff = this->centreVals[(i*numImageBands)+j] - this->centreVals[(k*numImageBands)+j];
+					sum += diff * diff;
+				}
+				this->centreSqDists[(i*numClusters)+k] = sum;
+				this->centreSqDists[(k*numClusters)+i] = sum;
+			}
+		}
+	}
+	
+	unsigned int RSGISKMeanCentreLookup::findNearestCentre(const float *pxlVals, double *sqDist)
+	{
+		unsigned int minIdx = 0;
+		double minSqDist = this->calcSqDistance(pxlVals, 0);
+		for(unsigned int i = 1; i < this->numClusters; ++i)
+		{
+			// Skip the centre if d(c_min, c_i)^2 >= 4 d(x, c_min)^2, a small margin is
+			// used so rounding in the squared distances cannot change the result.
+			if(this->centreSqDists[(minIdx*this->numClusters)+i] >= (minSqDist * 4.0000001))
+			{
+				continue;
+			}
+			double pxlSqDist = this->calcSqDistance(pxlVals, i);
+			if(pxlSqDist < minSqDist)
+			{
+				minSqDist = pxlSqDist;
+				minIdx = i;
+			}
+		}
+		*sqDist = minSqDist;
+		return minIdx;
+	}
+	
+	RSGISKMeansClassifier::RSGISKMeansClassifier(std::string inputImageFile, bool printinfo): clusterCentres(NULL), numClusters(0), hasInitClusterCentres(false), datasets(NULL), numDatasets(0), printinfo(false), numThreads(1)
 	{
 		this->inputImageFile = inputImageFile;
 		this->printinfo = printinfo;
@@ -39,7 +99,7 @@ namespace rsgis{ namespace classifier{
 		this->numClusters = numClusters;
 		
 		// Open Image
-		GDALAllRegister();		
+		rsgis::RSGISGDALInit::init();
 		try
 		{
 			this->numDatasets = 1;
@@ -139,7 +199,7 @@ namespace rsgis{ namespace classifier{
 		this->numClusters = numClusters;
 		
 		// Open Image
-		GDALAllRegister();		
+		rsgis::RSGISGDALInit::init();
 		try
 		{
 			this->numDatasets = 1;
@@ -243,11 +303,11 @@ namespace rsgis{ namespace classifier{
 		if(hasInitClusterCentres)
 		{
 			rsgis::math::RSGISVectors vecUtils;
-			rsgis::math::RSGISMathsUtils mathsUtil;
 			try 
 			{
 				RSGISKMeanCalcPixelClusterCalcImageVal *calcClusterCentre = new RSGISKMeanCalcPixelClusterCalcImageVal(0, this->clusterCentres, this->numClusters, this->numImageBands);
 				rsgis::img::RSGISCalcImage *calcImage = new rsgis::img::RSGISCalcImage(calcClusterCentre, "", true);
+				calcImage->setNumThreads(this->numThreads);
 				
 				ClusterCentre **newClusterCentres = NULL;
 				unsigned long *numPxlsInCluster = NULL;
@@ -325,34 +385,7 @@ namespace rsgis{ namespace classifier{
 				
 				if(saveCentres)
 				{
-			        // Open text file
-					std::ofstream outCentresFile;
-					outCentresFile.open(outCentresFileName.c_str());
-
-					// Write header file
-					outCentresFile << "Cluster,";
-					for(unsigned int j = 0; j < (numImageBands - 1); ++j)
-					{
-						std::string bandNumberStr = mathsUtil.inttostring(j + 1).c_str();
-						outCentresFile << "b" + bandNumberStr << ",";
-					}
-					std::string bandNumberStr = mathsUtil.inttostring(numImageBands).c_str();
-					outCentresFile << "b" + bandNumberStr;
-					outCentresFile << std::endl;
-
-					// Write out centres
-					for(unsigned int i = 0; i < numClusters; ++i)
-					{
-						outCentresFile << i << ",";
-						for(unsigned int j = 0; j < (numImageBands - 1); ++j)
-						{
-							outCentresFile << clusterCentres[i]->data->vector[j] << ",";
-						}
-						outCentresFile << clusterCentres[i]->data->vector[numImageBands-1];
-						outCentresFile << std::endl;
-					}
-					outCentresFile.flush();
-					outCentresFile.close();
+					this->saveClusterCentres(outCentresFileName);
 				}
 				
 								
@@ -370,12 +403,294 @@ namespace rsgis{ namespace classifier{
 		}
 	}
 	
+	void RSGISKMeansClassifier::saveClusterCentres(std::string outCentresFileName)
+	{
+		rsgis::math::RSGISMathsUtils mathsUtil;
+		
+		// Open text file
+		std::ofstream outCentresFile;
+		outCentresFile.open(outCentresFileName.c_str());
+		
+		// Write header file
+		outCentresFile << "Cluster,";
+		for(unsigned int j = 0; j < (numImageBands - 1); ++j)
+		{
+			std::string bandNumberStr = mathsUtil.inttostring(j + 1).c_str();
+			outCentresFile << "b" + bandNumberStr << ",";
+		}
+		std::string bandNumberStr = mathsUtil.inttostring(numImageBands).c_str();
+		outCentresFile << "b" + bandNumberStr;
+		outCentresFile << std::endl;
+		
+		// Write out centres
+		for(unsigned int i = 0; i < numClusters; ++i)
+		{
+			outCentresFile << i << ",";
+			for(unsigned int j = 0; j < (numImageBands - 1); ++j)
+			{
+				outCentresFile << clusterCentres[i]->data->vector[j] << ",";
+			}
+			outCentresFile << clusterCentres[i]->data->vector[numImageBands-1];
+			outCentresFile << std::endl;
+		}
+		outCentresFile.flush();
+		outCentresFile.close();
+	}
+	
+	void RSGISKMeansClassifier::calcClusterCentresSampled(double terminalThreshold, unsigned int maxIterations, unsigned int subSample, bool saveCentres, std::string outCentresFileName)
+	{
+		if(!hasInitClusterCentres)
+		{
+			throw RSGISClassificationException("The cluster centres have not been initialised.");
+		}
+		if(subSample == 0)
+		{
+			subSample = 1;
+		}
+		
+		try
+		{
+			// Read the sample into one contiguous array (pixel-major).
+			std::vector<float> pxlVals;
+			size_t numPxls = 0;
+			{
+				rsgis::img::RSGISImageClustering imgClustering;
+				std::vector< std::vector<float> > *samplePxls = imgClustering.sampleImage(datasets[0], subSample, false);
+				numPxls = samplePxls->size();
+				pxlVals.reserve(numPxls*numImageBands);
+				for(std::vector< std::vector<float> >::iterator iterPxls = samplePxls->begin(); iterPxls != samplePxls->end(); ++iterPxls)
+				{
+					pxlVals.insert(pxlVals.end(), (*iterPxls).begin(), (*iterPxls).end());
+				}
+				delete samplePxls;
+			}
+			if(numPxls == 0)
+			{
+				throw RSGISClassificationException("No pixels were sampled from the image.");
+			}
+			std::cout << "Clustering " << numPxls << " sampled pixels\n";
+			
+			rsgis::RSGISThreadPool threadPool(this->numThreads);
+			unsigned int nThreads = threadPool.getNumThreads();
+			
+			// Per pixel state (Hamerly, 2010): the assigned centre, an upper bound on the
+			// distance to that centre and a lower bound on the distance to any other centre.
+			std::vector<unsigned int> pxlCentre(numPxls, 0);
+			std::vector<double> upperBound(numPxls, 0);
+			std::vector<double> lowerBound(numPxls, 0);
+			
+			std::vector<double> centreVals(numClusters*numImageBands);
+			std::vector<double> centreHalfMinDist(numClusters);
+			std::vector<double> centreMoves(numClusters);
+			std::vector< std::vector<double> > threadSums(nThreads, std::vector<double>(numClusters*numImageBands));
+			std::vector< std::vector<unsigned long> > threadCounts(nThreads, std::vector<unsigned long>(numClusters));
+			
+			auto calcDistance = [&](const float *pxl, unsigned int centre)
+			{
+				const double *cVals = &centreVals[centre*numImageBands];
+				double sum = 0;
+				for(unsigned int j = 0; j < numImageBands; ++j)
+				{
+					double diff = cVals[j] - pxl[j];
+					sum += diff * diff;
+				}
+				return sqrt(sum);
+			};
+			
+			// Find the nearest and second nearest centres for a pixel.
+			auto assignPxl = [&](size_t p)
+			{
+				const float *pxl = &pxlVals[p*numImageBands];
+				double minDist = std::numeric_limits<double>::max();
+				double secMinDist = std::numeric_limits<double>::max();
+				unsigned int minIdx = 0;
+				for(unsigned int i = 0; i < numClusters; ++i)
+				{
+					double dist = calcDistance(pxl, i);
+					if(dist < minDist)
+					{
+						secMinDist = minDist;
+						minDist = dist;
+						minIdx = i;
+					}
+					else if(dist < secMinDist)
+					{
+						secMinDist = dist;
+					}
+				}
+				pxlCentre[p] = minIdx;
+				upperBound[p] = minDist;
+				lowerBound[p] = secMinDist;
+			};
+			
+			bool firstIteration = true;
+			auto processPxls = [&](unsigned int t, size_t pStart, size_t pEnd)
+			{
+				std::vector<double> &sums = threadSums[t];
+				std::vector<unsigned long> &counts = threadCounts[t];
+				std::fill(sums.begin(), sums.end(), 0);
+				std::fill(counts.begin(), counts.end(), 0);
+				for(size_t p = pStart; p < pEnd; ++p)
+				{
+					if(firstIteration)
+					{
+						assignPxl(p);
+					}
+					else
+					{
+						double bound = std::max(centreHalfMinDist[pxlCentre[p]], lowerBound[p]);
+						if(upperBound[p] > bound)
+						{
+							// Tighten the upper bound before testing all the centres.
+							upperBound[p] = calcDistance(&pxlVals[p*numImageBands], pxlCentre[p]);
+							if(upperBound[p] > bound)
+							{
+								assignPxl(p);
+							}
+						}
+					}
+					
+					const float *pxl = &pxlVals[p*numImageBands];
+					double *cSums = &sums[pxlCentre[p]*numImageBands];
+					for(unsigned int j = 0; j < numImageBands; ++j)
+					{
+						cSums[j] += pxl[j];
+					}
+					++counts[pxlCentre[p]];
+				}
+			};
+			
+			bool continueIterating = true;
+			unsigned int iterNum = 0;
+			while(continueIterating & (iterNum < maxIterations))
+			{
+				std::cout << "Iteration " << iterNum << ":\t" << std::flush;
+				
+				for(unsigned int i = 0; i < numClusters; ++i)
+				{
+					for(unsigned int j = 0; j < numImageBands; ++j)
+					{
+						centreVals[(i*numImageBands)+j] = clusterCentres[i]->data->vector[j];
+					}
+				}
+				for(unsigned int i = 0; i < numClusters; ++i)
+				{
+					double minDist = std::numeric_limits<double>::max();
+					for(unsigned int k = 0; k < numClusters; ++k)
+					{
+						if(k != i)
+						{
+							double sum = 0;
+							for(unsigned int j = 0; j < numImageBands; ++j)
+							{
+								double diff = centreVals[(i*numImageBands)+j] - centreVals[(k*numImageBands)+j];
+								sum += diff * diff;
+							}
+							minDist = std::min(minDist, sqrt(sum));
+						}
+					}
+					centreHalfMinDist[i] = minDist / 2;
+				}
+				
+				threadPool.parallelFor(0, numPxls, processPxls);
+				firstIteration = false;
+				
+				// Merge the thread sums (in thread order) and update the centres.
+				double centreMoveDistanceSum = 0;
+				for(unsigned int i = 0; i < numClusters; ++i)
+				{
+					unsigned long count = 0;
+					for(unsigned int t = 0; t < nThreads; ++t)
+					{
+						count += threadCounts[t][i];
+					}
+					double moveSqDist = 0;
+					if(count > 0)
+					{
+						for(unsigned int j = 0; j < numImageBands; ++j)
+						{
+							double sum = 0;
+							for(unsigned int t = 0; t < nThreads; ++t)
+							{
+								sum += threadSums[t][(i*numImageBands)+j];
+							}
+							double newVal = sum / count;
+							double diff = newVal - clusterCentres[i]->data->vector[j];
+							moveSqDist += diff * diff;
+							clusterCentres[i]->data->vector[j] = newVal;
+						}
+					}
+					centreMoves[i] = sqrt(moveSqDist);
+					centreMoveDistanceSum += centreMoves[i];
+				}
+				double centreMoveDistance = centreMoveDistanceSum/numClusters;
+				
+				// Update the bounds with the distances the centres have moved.
+				unsigned int maxMoveIdx = 0;
+				for(unsigned int i = 1; i < numClusters; ++i)
+				{
+					if(centreMoves[i] > centreMoves[maxMoveIdx])
+					{
+						maxMoveIdx = i;
+					}
+				}
+				double secMaxMove = 0;
+				for(unsigned int i = 0; i < numClusters; ++i)
+				{
+					if((i != maxMoveIdx) && (centreMoves[i] > secMaxMove))
+					{
+						secMaxMove = centreMoves[i];
+					}
+				}
+				threadPool.parallelFor(0, numPxls, [&](unsigned int t, size_t pStart, size_t pEnd)
+				{
+					for(size_t p = pStart; p < pEnd; ++p)
+					{
+						upperBound[p] += centreMoves[pxlCentre[p]];
+						lowerBound[p] -= (pxlCentre[p] == maxMoveIdx)?secMaxMove:centreMoves[maxMoveIdx];
+					}
+				});
+				
+				if(printinfo)
+				{
+					for(unsigned int i = 0; i < numClusters; ++i)
+					{
+						std::cout << "Cluster " << i << ": ";
+						for(unsigned int j = 0; j < numImageBands; ++j)
+						{
+							std::cout << clusterCentres[i]->data->vector[j] << ", ";
+						}
+						std::cout << std::endl;
+					}
+				}
+				std::cout << "Distance Moved = " << centreMoveDistance << std::endl;
+				
+				if(centreMoveDistance < terminalThreshold)
+				{
+					continueIterating = false;
+				}
+				
+				++iterNum;
+			}
+			
+			if(saveCentres)
+			{
+				this->saveClusterCentres(outCentresFileName);
+			}
+		}
+		catch (rsgis::RSGISImageException &e)
+		{
+			throw RSGISClassificationException(e.what());
+		}
+	}
+	
 	void RSGISKMeansClassifier::generateOutputImage(std::string outputImageFile)
 	{
 		if(hasInitClusterCentres)
 		{
 			RSGISApplyKMeanClassifierCalcImageVal *applyClass = new RSGISApplyKMeanClassifierCalcImageVal(1, this->clusterCentres, this->numClusters);
 			rsgis::img::RSGISCalcImage *calcImage = new rsgis::img::RSGISCalcImage(applyClass, "", true);
+			calcImage->setNumThreads(this->numThreads);
 			calcImage->calcImage(this->datasets, this->numDatasets, outputImageFile);
 			
 			delete applyClass;
@@ -425,38 +740,14 @@ namespace rsgis{ namespace classifier{
 			
 			numPxlInClusters[i] = 0;
 		}
-		
+		this->centreLookup.setClusterCentres(clusterCentres, numClusters, numImageBands);
 	}
 	
 	void RSGISKMeanCalcPixelClusterCalcImageVal::calcImageValue(float *bandValues, int numBands) 
 	{
 		// Identify cluster within which point is associated with
-		double minDistance = 0;
-		unsigned int minIdx = 0;
-		bool first = true;
-		double sum = 0;
-		double distance = 0;
-		for(unsigned int i = 0; i < numClusters; ++i)
-		{
-			sum = 0;
-			for(int j = 0; j < numBands; ++j)
-			{
-				sum += ((clusterCentres[i]->data->vector[j] - bandValues[j])*(clusterCentres[i]->data->vector[j] - bandValues[j]));
-			}
-			distance = sum/numBands;
-			
-			if(first)
-			{
-				minDistance = distance;
-				minIdx = i;
-				first = false;
-			}
-			else if(distance < minDistance)
-			{
-				minDistance = distance;
-				minIdx = i;
-			}
-		}
+		double minSqDist = 0;
+		unsigned int minIdx = this->centreLookup.findNearestCentre(bandValues, &minSqDist);
 		
 		// add to sum for next centre
 		for(int i = 0; i < numBands; ++i)
@@ -467,6 +758,29 @@ namespace rsgis{ namespace classifier{
 		
 	}
 	
+	rsgis::img::RSGISCalcImageValue* RSGISKMeanCalcPixelClusterCalcImageVal::clone()
+	{
+		// The clone shares the (read only) current centres but has its own sums.
+		return new RSGISKMeanCalcPixelClusterCalcImageVal(this->numOutBands, this->clusterCentres, this->numClusters, this->numImageBands);
+	}
+	
+	void RSGISKMeanCalcPixelClusterCalcImageVal::reduce(rsgis::img::RSGISCalcImageValue *other)
+	{
+		RSGISKMeanCalcPixelClusterCalcImageVal *otherCalc = dynamic_cast<RSGISKMeanCalcPixelClusterCalcImageVal*>(other);
+		if(otherCalc == NULL)
+		{
+			throw rsgis::img::RSGISImageCalcException("Can only reduce with another RSGISKMeanCalcPixelClusterCalcImageVal.");
+		}
+		for(unsigned int i = 0; i < numClusters; ++i)
+		{
+			for(unsigned int j = 0; j < numImageBands; ++j)
+			{
+				newClusterCentres[i]->data->vector[j] += otherCalc->newClusterCentres[i]->data->vector[j];
+			}
+			numPxlInClusters[i] += otherCalc->numPxlInClusters[i];
+		}
+	}
+	
 	unsigned long* RSGISKMeanCalcPixelClusterCalcImageVal::getPxlsInClusters()
 	{
 		return numPxlInClusters;
@@ -487,6 +801,7 @@ namespace rsgis{ namespace classifier{
 			}
 			numPxlInClusters[i] = 0;
 		}
+		this->centreLookup.setClusterCentres(clusterCentres, numClusters, numImageBands);
 	}
 	
 	RSGISKMeanCalcPixelClusterCalcImageVal::~RSGISKMeanCalcPixelClusterCalcImageVal()
@@ -625,37 +940,21 @@ namespace rsgis{ namespace classifier{
 	{
 		this->clusterCentres = clusterCentres;
 		this->numClusters = numClusters;
+		if(numClusters > 0)
+		{
+			this->centreLookup.setClusterCentres(clusterCentres, numClusters, clusterCentres[0]->data->n);
+		}
 	}
 	
 	void RSGISApplyKMeanClassifierCalcImageVal::calcImageValue(float *bandValues, int numBands, double *output) 
 	{
-		double minDistance = 0;
-		unsigned int minIdx = 0;
-		bool first = true;
-		double sum = 0;
-		double distance = 0;
-		for(unsigned int i = 0; i < numClusters; ++i)
-		{
-			sum = 0;
-			for(int j = 0; j < numBands; ++j)
-			{
-				sum += ((clusterCentres[i]->data->vector[j] - bandValues[j])*(clusterCentres[i]->data->vector[j] - bandValues[j]));
-			}
-			distance = sum/numBands;
-			
-			if(first)
-			{
-				minDistance = distance;
-				minIdx = i;
-				first = false;
-			}
-			else if(distance < minDistance)
-			{
-				minDistance = distance;
-				minIdx = i;
-			}
-		}
-		output[0] = minIdx;
+		double minSqDist = 0;
+		output[0] = this->centreLookup.findNearestCentre(bandValues, &minSqDist);
+	}
+	
+	rsgis::img::RSGISCalcImageValue* RSGISApplyKMeanClassifierCalcImageVal::clone()
+	{
+		return new RSGISApplyKMeanClassifierCalcImageVal(this->numOutBands, this->clusterCentres, this->numClusters);
 	}
 	
 	RSGISApplyKMeanClassifierCalcImageVal::~RSGISApplyKMeanClassifierCalcImageVal()
@@ -29,10 +29,16 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <cmath>
+#include <limits>
 
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISImageStatistics.h"
+#include "img/RSGISImageClustering.h"
+
+#include "common/RSGISThreadPool.h"
 
 #include "common/RSGISClassificationException.h"
  
@@ -59,6 +65,39 @@
 
 namespace rsgis{ namespace classifier{
 	
+	/**
+	 * Find the nearest cluster centre to a pixel. The centres are held in a single
+	 * contiguous array and the distances between the centres are used to skip centres
+	 * which cannot be nearer than the current nearest centre (i.e., if d(c_best, c_j) >=
+	 * 2 d(x, c_best) then d(x, c_j) >= d(x, c_best)), which gives the same result as
+	 * testing every centre.
+	 */
+	class DllExport RSGISKMeanCentreLookup
+	{
+	public:
+		RSGISKMeanCentreLookup();
+		void setClusterCentres(ClusterCentre **clusterCentres, unsigned int numClusters, unsigned int numImageBands);
+		/** Returns the index of the nearest centre (the first if there is a tie) and its squared distance. */
+		unsigned int findNearestCentre(const float *pxlVals, double *sqDist);
+		double calcSqDistance(const float *pxlVals, unsigned int centre)
+		{
+			const double *centreVals = &this->centreVals[centre*this->numImageBands];
+			double sum = 0;
+			for(unsigned int j = 0; j < this->numImageBands; ++j)
+			{
+				double diff = centreVals[j] - pxlVals[j];
+				sum += diff * diff;
+			}
+			return sum;
+		};
+		~RSGISKMeanCentreLookup(){};
+	protected:
+		unsigned int numClusters;
+		unsigned int numImageBands;
+		std::vector<double> centreVals;
+		std::vector<double> centreSqDists;
+	};
+	
 	class DllExport RSGISKMeansClassifier
 	{
 	public:
@@ -66,9 +105,19 @@ namespace rsgis{ namespace classifier{
 		void initClusterCentresRandom(unsigned int numClusters);
 		void initClusterCentresKpp(unsigned int numClusters);
 		void calcClusterCentres(double terminalThreshold, unsigned int maxIterations, bool saveCentres = false, std::string outCentresFileName = "");
+		/**
+		 * Calculate the cluster centres from a sample of the image pixels (every subSample
+		 * pixel) held in memory rather than passes through the whole image. Bounds on the
+		 * distances to the nearest and second nearest centres (Hamerly, 2010) are used to
+		 * skip the distance calculations for pixels which cannot change cluster.
+		 */
+		void calcClusterCentresSampled(double terminalThreshold, unsigned int maxIterations, unsigned int subSample, bool saveCentres = false, std::string outCentresFileName = "");
 		void generateOutputImage(std::string outputImageFile);
+		/** Set the number of threads used to calculate the cluster centres and output image (0 uses all the hardware threads). */
+		void setNumThreads(unsigned int numThreads){this->numThreads = numThreads;};
 		~RSGISKMeansClassifier();
 	protected:
+		void saveClusterCentres(std::string outCentresFileName);
 		std::string inputImageFile;
 		ClusterCentre **clusterCentres;
 		unsigned int numClusters;
@@ -77,6 +126,7 @@ namespace rsgis{ namespace classifier{
 		unsigned int numDatasets;
 		unsigned int numImageBands;
 		bool printinfo;
+		unsigned int numThreads;
 	};
 	
 	class DllExport RSGISKMeanCalcPixelClusterCalcImageVal : public rsgis::img::RSGISCalcImageValue
@@ -84,8 +134,11 @@ namespace rsgis{ namespace classifier{
 	public: 
 		RSGISKMeanCalcPixelClusterCalcImageVal(int numOutBands, ClusterCentre **clusterCentres, unsigned int numClusters, unsigned int numImageBands);
 		void calcImageValue(float *bandValues, int numBands);
+		rsgis::img::RSGISCalcImageValue* clone();
+		void reduce(rsgis::img::RSGISCalcImageValue *other);
 		unsigned long* getPxlsInClusters();
 		ClusterCentre** getNewClusterCentres();
+		/** Reset the new cluster centres, reading the (updated) current cluster centres. */
 		void reset();
 		~RSGISKMeanCalcPixelClusterCalcImageVal();
 	protected:
@@ -94,6 +147,7 @@ namespace rsgis{ namespace classifier{
 		ClusterCentre **newClusterCentres;
 		unsigned long *numPxlInClusters;
 		unsigned int numImageBands;
+		RSGISKMeanCentreLookup centreLookup;
 	};
 	
 	class DllExport RSGISCalcDist2NrCentreCalcImageVal : public rsgis::img::RSGISCalcImageValue
@@ -132,10 +186,12 @@ namespace rsgis{ namespace classifier{
 	public: 
 		RSGISApplyKMeanClassifierCalcImageVal(int numOutBands, ClusterCentre **clusterCentres, unsigned int numClusters);
 		void calcImageValue(float *bandValues, int numBands, double *output);
+		rsgis::img::RSGISCalcImageValue* clone();
 		~RSGISApplyKMeanClassifierCalcImageVal();
 	protected:
 		ClusterCentre **clusterCentres;
 		unsigned int numClusters;
+		RSGISKMeanCentreLookup centreLookup;
 	};
 }}
 
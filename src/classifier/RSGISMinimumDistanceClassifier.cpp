@@ -124,6 +124,11 @@ namespace rsgis{ namespace classifier{
 	
 	ClassData* RSGISMinimumDistanceClassifier::findClass(float *variables, int numVars)
 	{
+		if(numVars != this->numVariables)
+		{
+			throw RSGISClassificationException("The number of variables is not the same as the training data.");
+		}
+		
 		double distance = 0;
 		double minDistance = 0;
 		double sqSum = 0;
@@ -135,7 +140,7 @@ namespace rsgis{ namespace classifier{
 			sqSum = 0;
 			for(int j = 0; j < numVars; j++)
 			{
-				sumPair = clusterCentres->data->matrix[i] - variables[j]; 
+				sumPair = clusterCentres[i].data->matrix[j] - variables[j]; 
 				sqSum += (sumPair*sumPair);
 			}
 			distance = sqrt(sqSum);
@@ -157,6 +162,57 @@ namespace rsgis{ namespace classifier{
 		return minDistClass;
 	}
 	
+	void RSGISMinimumDistanceClassifier::getClassIDs(const float* const* bands, int numVars, size_t nPxls, int *classIDs)
+	{
+		if((numVars != this->numVariables) || (numClasses == 0))
+		{
+			for(size_t p = 0; p < nPxls; ++p)
+			{
+				classIDs[p] = -1;
+			}
+			return;
+		}
+		
+		// The distances are summed in the same order as findClass so the
+		// classes are the same; the inner loops run over the pixels of a tile.
+		const size_t tilePxls = 256;
+		std::vector<double> sqSum(tilePxls);
+		std::vector<double> minDistance(tilePxls);
+		std::vector<int> minDistClass(tilePxls);
+		for(size_t tileStart = 0; tileStart < nPxls; tileStart += tilePxls)
+		{
+			size_t nTilePxls = std::min(tilePxls, nPxls - tileStart);
+			for(int i = 0; i < numClasses; i++)
+			{
+				double *centre = clusterCentres[i].data->matrix;
+				std::fill(sqSum.begin(), sqSum.begin() + nTilePxls, 0.0);
+				for(int j = 0; j < numVars; j++)
+				{
+					const float *band = bands[j] + tileStart;
+					double centreVal = centre[j];
+					for(size_t p = 0; p < nTilePxls; ++p)
+					{
+						double sumPair = centreVal - band[p];
+						sqSum[p] += (sumPair*sumPair);
+					}
+				}
+				for(size_t p = 0; p < nTilePxls; ++p)
+				{
+					double distance = sqrt(sqSum[p]);
+					if((i == 0) || (distance < minDistance[p]))
+					{
+						minDistance[p] = distance;
+						minDistClass[p] = i;
+					}
+				}
+			}
+			for(size_t p = 0; p < nTilePxls; ++p)
+			{
+				classIDs[tileStart + p] = clusterCentres[minDistClass[p]].classID;
+			}
+		}
+	}
+	
 	RSGISMinimumDistanceClassifier::~RSGISMinimumDistanceClassifier()
 	{
 		
@@ -25,12 +25,15 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
 #include "classifier/RSGISClassifier.h"
 #include "math/RSGISMatrices.h"
 #include "common/RSGISClassificationException.h"
 
 // mark all exported classes/functions with DllExport to have
-// them exported by Visual Studio
+// them exported by Visual Studio
 #undef DllExport
 #ifdef _MSC_VER
     #ifdef rsgis_classify_EXPORTS
@@ -56,6 +59,8 @@ namespace rsgis{ namespace classifier{
 			RSGISMinimumDistanceClassifier(ClassData **trainingData, int numClasses, MinDistCentreType centreType);
 			virtual int getClassID(float *variables, int numVars);
 			virtual std::string getClassName(float *variables, int numVars);
+			/** Calculates the distances to the cluster centres for tiles of pixels at a time. */
+			virtual void getClassIDs(const float* const* bands, int numVars, size_t nPxls, int *classIDs);
 			~RSGISMinimumDistanceClassifier();
 		protected:
 			void calcClusterCentres();
@@ -26,7 +26,33 @@ namespace rsgis{ namespace classifier{
 
 	RSGISNearestNeighbourClassifier::RSGISNearestNeighbourClassifier(ClassData **trainingData, int numClasses) : RSGISClassifier(trainingData, numClasses)
 	{
-
+		this->kdTree = NULL;
+		this->emptyClassIdx = -1;
+		for(int i = 0; i < this->numClasses; i++)
+		{
+			rsgis::math::Matrix *data = trainingData[i]->data;
+			if(data->m == 0)
+			{
+				if(this->emptyClassIdx < 0)
+				{
+					this->emptyClassIdx = i;
+				}
+				continue;
+			}
+			if(data->n != this->numVariables)
+			{
+				throw RSGISClassificationException("All the classes must have the same number of variables.");
+			}
+			for(int j = 0; j < data->m; j++)
+			{
+				this->samples.push_back(&data->matrix[j * data->n]);
+				this->sampleClass.push_back(i);
+			}
+		}
+		if((!this->samples.empty()) && (this->numVariables > 0))
+		{
+			this->kdTree = new rsgis::math::RSGISKDTree(&this->samples[0], this->samples.size(), 0, this->numVariables);
+		}
 	}
 	
 	int RSGISNearestNeighbourClassifier::getClassID(float *variables, int numVars)
@@ -43,27 +69,43 @@ namespace rsgis{ namespace classifier{
 	
 	ClassData* RSGISNearestNeighbourClassifier::findClass(float *variables, int numVars)
 	{
-		double distance = 0;
-		double minDistance = 0;
-		ClassData *minDistData = nullptr;
-		for(int i = 0; i < this->numClasses; i++)
+		if(this->kdTree == NULL)
 		{
-			if(i == 0)
-			{
-				minDistance = this->findClosestPointInClass(trainingData[i], variables, numVars);
-				minDistData = trainingData[i];
-			}
-			else
+			double distance = 0;
+			double minDistance = 0;
+			ClassData *minDistData = nullptr;
+			for(int i = 0; i < this->numClasses; i++)
 			{
 				distance = this->findClosestPointInClass(trainingData[i], variables, numVars);
-				if(distance < minDistance)
+				if((i == 0) || (distance < minDistance))
 				{
 					minDistance = distance;
 					minDistData = trainingData[i];
 				}
 			}
+			return minDistData;
 		}
-		return minDistData;
+		
+		if(numVars != this->numVariables)
+		{
+			throw RSGISClassificationException("The number of variables is not the same as the training data.");
+		}
+		
+		std::vector<double> query(variables, variables + numVars);
+		std::vector<std::pair<double, size_t> > nearest;
+		this->kdTree->findKNearest(&query[0], 1, std::numeric_limits<double>::infinity(), NULL, &nearest);
+		
+		// An empty class has a distance of 0 so is only beaten by an earlier class with an identical sample.
+		int classIdx = this->emptyClassIdx;
+		if((!nearest.empty()) && ((classIdx < 0) || ((nearest[0].first == 0) && (this->sampleClass[nearest[0].second] < classIdx))))
+		{
+			classIdx = this->sampleClass[nearest[0].second];
+		}
+		if(classIdx < 0)
+		{
+			throw RSGISClassificationException("No training sample could be compared with the variables.");
+		}
+		return trainingData[classIdx];
 	}
 	
 	double RSGISNearestNeighbourClassifier::findClosestPointInClass(ClassData *data, float *variables, int numVars)
@@ -101,6 +143,9 @@ namespace rsgis{ namespace classifier{
 	
 	RSGISNearestNeighbourClassifier::~RSGISNearestNeighbourClassifier()
 	{
-		
+		if(this->kdTree != NULL)
+		{
+			delete this->kdTree;
+		}
 	}
 }}
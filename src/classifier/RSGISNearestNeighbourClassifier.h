@@ -25,8 +25,10 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include "classifier/RSGISClassifier.h"
 #include "math/RSGISMatrices.h"
+#include "math/RSGISKDTree.h"
 #include "common/RSGISClassificationException.h"
 #include <cmath>
 
@@ -45,6 +47,11 @@
 
 namespace rsgis{ namespace classifier{
     
+	/**
+	 * Assigns the class of the nearest (Euclidean) training sample. The samples
+	 * of all the classes are searched with a single kd-tree; where samples are
+	 * the same distance away the first class is returned.
+	 */
 	class DllExport RSGISNearestNeighbourClassifier : public RSGISClassifier
 		{
 		public:
@@ -55,6 +62,14 @@ namespace rsgis{ namespace classifier{
 		protected:
 			ClassData* findClass(float *variables, int numVars);
 			double findClosestPointInClass(ClassData *data, float *variables, int numVars);
+			RSGISNearestNeighbourClassifier(const RSGISNearestNeighbourClassifier&);
+			RSGISNearestNeighbourClassifier& operator=(const RSGISNearestNeighbourClassifier&);
+			/// The samples of all the classes (in class order) and the class of each.
+			std::vector<double*> samples;
+			std::vector<int> sampleClass;
+			rsgis::math::RSGISKDTree *kdTree;
+			/// The first class without any samples (which the closest point search treats as a distance of 0), -1 if none.
+			int emptyClassIdx;
 		};
 
 }}
@@ -25,6 +25,62 @@
 
 namespace rsgis { namespace classifier {
 	
+	/**
+	 * Calculate the spectral angles between a tile of pixels and each of the reference
+	 * spectra (angles[(i * nTilePxls) + p]). The sums are accumulated in the same order
+	 * as the per pixel implementations so the angles are identical.
+	 */
+	static void calcTileSpectralAngles(gsl_matrix *refSpectra, const float* const* bands, size_t tileStart, size_t nTilePxls, std::vector<double> *sumRefRef, std::vector<double> *sumImageImage, std::vector<double> *angles)
+	{
+		size_t numRefBands = refSpectra->size1;
+		size_t numRefs = refSpectra->size2;
+		if(sumRefRef->size() != numRefs)
+		{
+			sumRefRef->assign(numRefs, 0.0);
+			for(size_t i = 0; i < numRefs; i++)
+			{
+				for(size_t b = 0; b < numRefBands; b++)
+				{
+					double ref = gsl_matrix_get(refSpectra, b, i);
+					(*sumRefRef)[i] = (*sumRefRef)[i] + (ref * ref);
+				}
+			}
+		}
+		
+		sumImageImage->assign(nTilePxls, 0.0);
+		angles->assign(numRefs * nTilePxls, 0.0);
+		double *sumImageImageVals = sumImageImage->data();
+		for(size_t b = 0; b < numRefBands; b++)
+		{
+			const float *image = bands[b] + tileStart;
+			for(size_t p = 0; p < nTilePxls; p++)
+			{
+				double imageVal = image[p];
+				sumImageImageVals[p] = sumImageImageVals[p] + (imageVal * imageVal);
+			}
+			for(size_t i = 0; i < numRefs; i++)
+			{
+				double ref = gsl_matrix_get(refSpectra, b, i);
+				double *sumImageRef = angles->data() + (i * nTilePxls);
+				for(size_t p = 0; p < nTilePxls; p++)
+				{
+					double imageVal = image[p];
+					sumImageRef[p] = sumImageRef[p] + (imageVal * ref);
+				}
+			}
+		}
+		
+		for(size_t i = 0; i < numRefs; i++)
+		{
+			double *sumImageRef = angles->data() + (i * nTilePxls);
+			for(size_t p = 0; p < nTilePxls; p++)
+			{
+				double demononator = sqrt((*sumRefRef)[i]) * sqrt(sumImageImageVals[p]);
+				sumImageRef[p] = acos(sumImageRef[p] / demononator);
+			}
+		}
+	}
+	
 
 	RSGISSpectralAngleMapperRule::RSGISSpectralAngleMapperRule(int numOutBands, gsl_matrix *refSpectra) : RSGISCalcImageValue(numOutBands)
 	{
@@ -66,9 +122,33 @@ namespace rsgis { namespace classifier {
 			output[i] = angle;
 		}
 	}
+	bool RSGISSpectralAngleMapperRule::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+	{
+		if(((size_t)numBands) < refSpectra->size1)
+		{
+			return false;
+		}
+		std::vector<double> sumRefRef;
+		std::vector<double> sumImageImage;
+		std::vector<double> angles;
+		for(size_t tileStart = 0; tileStart < nPxls; tileStart += RSGIS_SAM_TILE_PXLS)
+		{
+			size_t nTilePxls = std::min(RSGIS_SAM_TILE_PXLS, nPxls - tileStart);
+			calcTileSpectralAngles(refSpectra, bands, tileStart, nTilePxls, &sumRefRef, &sumImageImage, &angles);
+			for(size_t i = 0; i < refSpectra->size2; i++)
+			{
+				for(size_t p = 0; p < nTilePxls; p++)
+				{
+					output[i][tileStart + p] = angles[(i * nTilePxls) + p];
+				}
+			}
+		}
+		return true;
+	}
+	
 	RSGISSpectralAngleMapperRule::~RSGISSpectralAngleMapperRule()
 	{
-		delete imageSpecArray;
+		delete[] imageSpecArray;
 	}
 	
 	RSGISSpectralAngleMapperED::RSGISSpectralAngleMapperED(int numOutBands, gsl_matrix *refSpectra) : RSGISCalcImageValue(numOutBands)
@@ -105,6 +185,30 @@ namespace rsgis { namespace classifier {
 			output[i] = euclidianDistance;
 		}
 	}
+	bool RSGISSpectralAngleMapperED::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+	{
+		if(((size_t)numBands) < refSpectra->size1)
+		{
+			return false;
+		}
+		std::vector<double> sumRefRef;
+		std::vector<double> sumImageImage;
+		std::vector<double> angles;
+		for(size_t tileStart = 0; tileStart < nPxls; tileStart += RSGIS_SAM_TILE_PXLS)
+		{
+			size_t nTilePxls = std::min(RSGIS_SAM_TILE_PXLS, nPxls - tileStart);
+			calcTileSpectralAngles(refSpectra, bands, tileStart, nTilePxls, &sumRefRef, &sumImageImage, &angles);
+			for(size_t i = 0; i < refSpectra->size2; i++)
+			{
+				for(size_t p = 0; p < nTilePxls; p++)
+				{
+					output[i][tileStart + p] = 2 * sin(angles[(i * nTilePxls) + p] / 2);
+				}
+			}
+		}
+		return true;
+	}
+	
 	RSGISSpectralAngleMapperED::~RSGISSpectralAngleMapperED()
 	{
 		
@@ -140,6 +244,35 @@ namespace rsgis { namespace classifier {
 		}
 
 	}
+	bool RSGISSpectralAngleMapperClassifier::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+	{
+		std::vector<double> minAngle(RSGIS_SAM_TILE_PXLS);
+		std::vector<int> outClass(RSGIS_SAM_TILE_PXLS);
+		for(size_t tileStart = 0; tileStart < nPxls; tileStart += RSGIS_SAM_TILE_PXLS)
+		{
+			size_t nTilePxls = std::min(RSGIS_SAM_TILE_PXLS, nPxls - tileStart);
+			std::fill(minAngle.begin(), minAngle.begin() + nTilePxls, 100.0);
+			std::fill(outClass.begin(), outClass.begin() + nTilePxls, 0);
+			for(int i = 0; i < numBands; i++)
+			{
+				const float *angles = bands[i] + tileStart;
+				for(size_t p = 0; p < nTilePxls; p++)
+				{
+					if(angles[p] < minAngle[p])
+					{
+						minAngle[p] = angles[p];
+						outClass[p] = i + 1;
+					}
+				}
+			}
+			for(size_t p = 0; p < nTilePxls; p++)
+			{
+				output[0][tileStart + p] = (minAngle[p] < this->threashold)?float(outClass[p]):0;
+			}
+		}
+		return true;
+	}
+	
 	RSGISSpectralAngleMapperClassifier::~RSGISSpectralAngleMapperClassifier()
 	{
 		
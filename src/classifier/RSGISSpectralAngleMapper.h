@@ -25,6 +25,8 @@
 #define RSGISSpectralAngleMapper_H
 
 #include <cmath>
+#include <vector>
+#include <algorithm>
 #include <gsl/gsl_matrix.h>
 
 #include "img/RSGISCalcImage.h"
@@ -47,11 +49,15 @@
 
 namespace rsgis { namespace classifier {
     
+    /// The number of pixels processed at a time by the SAM block implementations.
+    static const size_t RSGIS_SAM_TILE_PXLS( 256 );
+    
 	class DllExport RSGISSpectralAngleMapperRule : public rsgis::img::RSGISCalcImageValue
 	{
 	public:
 		RSGISSpectralAngleMapperRule(int numOutBands, gsl_matrix *refSpectra);
 		void calcImageValue(float *bandValues, int numBands, double *output);
+		bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
 		~RSGISSpectralAngleMapperRule();
 	private:
 		double *imageSpecArray;
@@ -63,6 +69,7 @@ namespace rsgis { namespace classifier {
 	public:
 		RSGISSpectralAngleMapperED(int numOutBands, gsl_matrix *refSpectra);
 		void calcImageValue(float *bandValues, int numBands, double *output);
+		bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
 		~RSGISSpectralAngleMapperED();
 	private:
 		gsl_matrix *refSpectra;
@@ -74,6 +81,7 @@ namespace rsgis { namespace classifier {
 	public:
 		RSGISSpectralAngleMapperClassifier(int numOutBands, double threashold);
 		void calcImageValue(float *bandValues, int numBands, double *output);
+		bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
 		~RSGISSpectralAngleMapperClassifier();
 	private:
 		double threashold;
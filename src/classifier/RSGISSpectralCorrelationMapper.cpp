@@ -80,9 +80,93 @@ namespace rsgis { namespace classifier {
 			output[i] = scm;
 		}
 	}
+	bool RSGISSpectralCorrelationMapperRule::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+	{
+		size_t numRefBands = refSpectra->size1;
+		size_t numRefs = refSpectra->size2;
+		if(((size_t)numBands) < numRefBands)
+		{
+			return false;
+		}
+		
+		// The reference means and sums of squares only depend on the reference spectra. All the
+		// sums are accumulated in the same order as calcImageValue so the values are identical.
+		std::vector<double> yMean(numRefs, 0.0);
+		std::vector<double> ssYY(numRefs, 0.0);
+		for(size_t i = 0; i < numRefs; i++)
+		{
+			double sumY = 0;
+			for(size_t b = 0; b < numRefBands; b++)
+			{
+				sumY = sumY + gsl_matrix_get(refSpectra, b, i);
+			}
+			yMean[i] = sumY / numRefBands;
+			for(size_t b = 0; b < numRefBands; b++)
+			{
+				double dataY = gsl_matrix_get(refSpectra, b, i);
+				ssYY[i] = ssYY[i] + ((dataY - yMean[i])*(dataY - yMean[i]));
+			}
+		}
+		
+		std::vector<double> xMean(RSGIS_SCM_TILE_PXLS);
+		std::vector<double> ssXX(RSGIS_SCM_TILE_PXLS);
+		std::vector<double> ssXY;
+		for(size_t tileStart = 0; tileStart < nPxls; tileStart += RSGIS_SCM_TILE_PXLS)
+		{
+			size_t nTilePxls = std::min(RSGIS_SCM_TILE_PXLS, nPxls - tileStart);
+			std::fill(xMean.begin(), xMean.begin() + nTilePxls, 0.0);
+			std::fill(ssXX.begin(), ssXX.begin() + nTilePxls, 0.0);
+			ssXY.assign(numRefs * nTilePxls, 0.0);
+			
+			for(size_t b = 0; b < numRefBands; b++)
+			{
+				const float *image = bands[b] + tileStart;
+				for(size_t p = 0; p < nTilePxls; p++)
+				{
+					xMean[p] = xMean[p] + image[p];
+				}
+			}
+			for(size_t p = 0; p < nTilePxls; p++)
+			{
+				xMean[p] = xMean[p] / numRefBands;
+			}
+			
+			for(size_t b = 0; b < numRefBands; b++)
+			{
+				const float *image = bands[b] + tileStart;
+				for(size_t p = 0; p < nTilePxls; p++)
+				{
+					double dataX = image[p];
+					ssXX[p] = ssXX[p] + ((dataX - xMean[p])*(dataX - xMean[p]));
+				}
+				for(size_t i = 0; i < numRefs; i++)
+				{
+					double dataYDiff = gsl_matrix_get(refSpectra, b, i) - yMean[i];
+					double *ssXYRef = ssXY.data() + (i * nTilePxls);
+					for(size_t p = 0; p < nTilePxls; p++)
+					{
+						double dataX = image[p];
+						ssXYRef[p] = ssXYRef[p] + ((dataX - xMean[p])*dataYDiff);
+					}
+				}
+			}
+			
+			for(size_t i = 0; i < numRefs; i++)
+			{
+				double *ssXYRef = ssXY.data() + (i * nTilePxls);
+				for(size_t p = 0; p < nTilePxls; p++)
+				{
+					double pCC = ssXYRef[p] / sqrt(ssXX[p] * ssYY[i]);
+					output[i][tileStart + p] = sqrt(pCC * pCC);
+				}
+			}
+		}
+		return true;
+	}
+	
 	RSGISSpectralCorrelationMapperRule::~RSGISSpectralCorrelationMapperRule()
 	{
-		delete imageSpecArray;
+		delete[] imageSpecArray;
 	}
 	
 	RSGISSpectralCorrelationMapperClassifier::RSGISSpectralCorrelationMapperClassifier(int numOutBands, double threashold) : RSGISCalcImageValue(numOutBands)
@@ -115,6 +199,35 @@ namespace rsgis { namespace classifier {
 		}
 		
 	}
+	bool RSGISSpectralCorrelationMapperClassifier::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+	{
+		std::vector<double> maxCorrelation(RSGIS_SCM_TILE_PXLS);
+		std::vector<int> outClass(RSGIS_SCM_TILE_PXLS);
+		for(size_t tileStart = 0; tileStart < nPxls; tileStart += RSGIS_SCM_TILE_PXLS)
+		{
+			size_t nTilePxls = std::min(RSGIS_SCM_TILE_PXLS, nPxls - tileStart);
+			std::fill(maxCorrelation.begin(), maxCorrelation.begin() + nTilePxls, 0.0);
+			std::fill(outClass.begin(), outClass.begin() + nTilePxls, 0);
+			for(int i = 0; i < numBands; i++)
+			{
+				const float *correlations = bands[i] + tileStart;
+				for(size_t p = 0; p < nTilePxls; p++)
+				{
+					if(correlations[p] > maxCorrelation[p])
+					{
+						maxCorrelation[p] = correlations[p];
+						outClass[p] = i + 1;
+					}
+				}
+			}
+			for(size_t p = 0; p < nTilePxls; p++)
+			{
+				output[0][tileStart + p] = (maxCorrelation[p] > this->threashold)?float(outClass[p]):0;
+			}
+		}
+		return true;
+	}
+	
 	RSGISSpectralCorrelationMapperClassifier::~RSGISSpectralCorrelationMapperClassifier()
 	{
 		
@@ -25,6 +25,8 @@
 #define RSGISSpectralCorrelationMapper_H
 
 #include <cmath>
+#include <vector>
+#include <algorithm>
 #include <gsl/gsl_matrix.h>
 
 #include "img/RSGISCalcImage.h"
@@ -46,6 +48,9 @@
 #endif
 
 namespace rsgis { namespace classifier {
+    
+    /// The number of pixels processed at a time by the SCM block implementations.
+    static const size_t RSGIS_SCM_TILE_PXLS( 256 );
 	    
 	/**
 	 This implements the Spectral Correlation mapper approach to calculate the correlation between image specta and a reference spectra.
@@ -62,6 +67,7 @@ namespace rsgis { namespace classifier {
 	public:
 		RSGISSpectralCorrelationMapperRule(int numOutBands, gsl_matrix *refSpectra);
 		void calcImageValue(float *bandValues, int numBands, double *output);
+		bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
 		~RSGISSpectralCorrelationMapperRule();
 	private:
 		double *imageSpecArray;
@@ -74,6 +80,7 @@ namespace rsgis { namespace classifier {
 	public:
 		RSGISSpectralCorrelationMapperClassifier(int numOutBands, double threashold);
 		void calcImageValue(float *bandValues, int numBands, double *output);
+		bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
 		~RSGISSpectralCorrelationMapperClassifier();
 	private:
 		double threashold;
@@ -25,15 +25,21 @@
 
 #include "common/RSGISException.h"
 #include "common/RSGISImageException.h"
+#include "common/RSGISGDALInit.h"
 
 #include "img/RSGISImageUtils.h"
+#include "img/RSGISCalcImage.h"
 #include "vec/RSGISVectorUtils.h"
 #include "vec/RSGISVectorOutputException.h"
 
 #include "classifier/RSGISRATClassificationUtils.h"
 #include "classifier/RSGISGenAccuracyPoints.h"
+#include "classifier/RSGISBatchPredictImage.h"
+#include "classifier/RSGISBatchPredictRAT.h"
+#include "classifier/RSGISClassConfusionMatrix.h"
 
 #include "utils/RSGISFileUtils.h"
+#include "utils/RSGISOGRFeatureSink.h"
 
 #include <boost/filesystem.hpp>
 
@@ -46,7 +52,7 @@ namespace rsgis{ namespace cmds {
             rsgis::img::RSGISImageUtils imgUtils;
             
             std::cout << "Opening an image\n";
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *imageDataset = NULL;
             imageDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_ReadOnly);
             if(imageDataset == NULL)
@@ -78,7 +84,7 @@ namespace rsgis{ namespace cmds {
             std::cout << "Openning input image.\n";
             rsgis::img::RSGISImageUtils imgUtils;
             
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **imageDataset = new GDALDataset*[1];
             imageDataset[0] = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_ReadOnly);
             if(imageDataset[0] == NULL)
@@ -120,8 +126,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
-            OGRRegisterAll();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *imgDataset = (GDALDataset *) GDALOpenShared(classImage.c_str(), GA_ReadOnly);
             if(imgDataset == NULL)
@@ -187,7 +192,9 @@ namespace rsgis{ namespace cmds {
                 std::string message = std::string("Could not create vector file ") + outputVecFile;
                 throw rsgis::vec::RSGISVectorOutputException(message.c_str());
             }
-            outVecLyrObj = outVecDS->CreateLayer(outputVecLyr.c_str(), ogrSpatialRef, wkbPoint, NULL );
+            char **lyrOptions = rsgis::utils::RSGISOGRFeatureSink::getDeferredSpatialIndexOptions(outVecFormat);
+            outVecLyrObj = outVecDS->CreateLayer(outputVecLyr.c_str(), ogrSpatialRef, wkbPoint, lyrOptions );
+            CSLDestroy(lyrOptions);
             if( outVecLyrObj == NULL )
             {
                 std::string message = std::string("Could not create vector layer ") + outputVecLyr;
@@ -196,6 +203,7 @@ namespace rsgis{ namespace cmds {
             
             rsgis::classifier::RSGISGenAccuracyPoints genAccPts;
             genAccPts.generateRandomPointsVecOut(imgDataset, outVecLyrObj, classImgCol, classImgVecCol, classRefVecCol, numPts, seed);
+            rsgis::utils::RSGISOGRFeatureSink::createDeferredSpatialIndex(outVecDS, outVecLyrObj, outVecFormat);
 
             GDALClose(imgDataset);
             GDALClose(outVecDS);
@@ -215,8 +223,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
-            OGRRegisterAll();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *imgDataset = (GDALDataset *) GDALOpenShared(classImage.c_str(), GA_ReadOnly);
             if(imgDataset == NULL)
@@ -282,7 +289,9 @@ namespace rsgis{ namespace cmds {
                 std::string message = std::string("Could not create vector file ") + outputVecFile;
                 throw rsgis::vec::RSGISVectorOutputException(message.c_str());
             }
-            outputVecLyrObj = outputVecDS->CreateLayer(outputVecLyr.c_str(), ogrSpatialRef, wkbPoint, NULL );
+            char **lyrOptions = rsgis::utils::RSGISOGRFeatureSink::getDeferredSpatialIndexOptions(outVecFormat);
+            outputVecLyrObj = outputVecDS->CreateLayer(outputVecLyr.c_str(), ogrSpatialRef, wkbPoint, lyrOptions );
+            CSLDestroy(lyrOptions);
             if( outputVecLyrObj == NULL )
             {
                 std::string message = std::string("Could not create vector layer ") + outputVecLyr;
@@ -298,6 +307,7 @@ namespace rsgis{ namespace cmds {
             {
                 genAccPts.generateStratifiedRandomPointsVecOutUsePxlLst(imgDataset, outputVecLyrObj, classImgCol, classImgVecCol, classRefVecCol, numPtsPerClass, seed);
             }
+            rsgis::utils::RSGISOGRFeatureSink::createDeferredSpatialIndex(outputVecDS, outputVecLyrObj, outVecFormat);
             
             GDALClose(imgDataset);
             GDALClose(outputVecDS);
@@ -316,8 +326,7 @@ namespace rsgis{ namespace cmds {
         {
             try
             {
-                GDALAllRegister();
-                OGRRegisterAll();
+                rsgis::RSGISGDALInit::init();
 
                 GDALDataset *imgDataset = (GDALDataset *) GDALOpenShared(classImage.c_str(), GA_ReadOnly);
                 if(imgDataset == NULL)
@@ -383,7 +392,9 @@ namespace rsgis{ namespace cmds {
                     std::string message = std::string("Could not create vector file ") + outputVecFile;
                     throw rsgis::vec::RSGISVectorOutputException(message.c_str());
                 }
-                outputVecLyrObj = outputVecDS->CreateLayer(outputVecLyr.c_str(), ogrSpatialRef, wkbPoint, NULL );
+                char **lyrOptions = rsgis::utils::RSGISOGRFeatureSink::getDeferredSpatialIndexOptions(outVecFormat);
+                outputVecLyrObj = outputVecDS->CreateLayer(outputVecLyr.c_str(), ogrSpatialRef, wkbPoint, lyrOptions );
+                CSLDestroy(lyrOptions);
                 if( outputVecLyrObj == NULL )
                 {
                     std::string message = std::string("Could not create vector layer ") + outputVecLyr;
@@ -392,6 +403,7 @@ namespace rsgis{ namespace cmds {
 
                 rsgis::classifier::RSGISGenAccuracyPoints genAccPts;
                 genAccPts.generateStratifiedRandomPointsVecOutUsePxlLstPropPts(imgDataset, outputVecLyrObj, classImgCol, classImgVecCol, classRefVecCol, numPts, minNumPts, seed);
+                rsgis::utils::RSGISOGRFeatureSink::createDeferredSpatialIndex(outputVecDS, outputVecLyrObj, outVecFormat);
 
                 GDALClose(imgDataset);
                 GDALClose(outputVecDS);
@@ -410,8 +422,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
-            OGRRegisterAll();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *imgDataset = (GDALDataset *) GDALOpenShared(classImage.c_str(), GA_ReadOnly);
             if(imgDataset == NULL)
@@ -459,5 +470,238 @@ namespace rsgis{ namespace cmds {
         }
     }
 
+
+    void executeBatchPredictImage(std::vector<std::string> inputImages, std::vector<std::vector<unsigned int> > inputBands, std::string maskImage, int maskVal, std::function<void(const float*, size_t, unsigned int, float*)> predictFunc, std::vector<std::string> outputImages, std::vector<unsigned int> outNumBands, std::vector<RSGISLibDataType> outDataTypes, std::string gdalFormat, size_t batchSize, bool useNoData, float noDataVal, float outNoDataVal)
+    {
+        if(inputImages.size() != inputBands.size())
+        {
+            throw RSGISCmdException("The number of input images and lists of bands must be the same.");
+        }
+        if((outputImages.size() != outNumBands.size()) || (outputImages.size() != outDataTypes.size()))
+        {
+            throw RSGISCmdException("The number of output images, numbers of bands and data types must be the same.");
+        }
+        
+        rsgis::RSGISGDALInit::init();
+        std::vector<GDALDataset*> datasets;
+        GDALDataset *maskDS = NULL;
+        try
+        {
+            std::vector<rsgis::classifier::RSGISBatchPredictInput> inputs;
+            for(unsigned int i = 0; i < inputImages.size(); ++i)
+            {
+                GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImages[i].c_str(), GA_ReadOnly);
+                if(dataset == NULL)
+                {
+                    std::string message = std::string("Could not open image ") + inputImages[i];
+                    throw rsgis::RSGISImageException(message.c_str());
+                }
+                datasets.push_back(dataset);
+                
+                rsgis::classifier::RSGISBatchPredictInput input;
+                input.dataset = dataset;
+                input.bands = inputBands[i];
+                inputs.push_back(input);
+            }
+            
+            if(maskImage != "")
+            {
+                maskDS = (GDALDataset *) GDALOpen(maskImage.c_str(), GA_ReadOnly);
+                if(maskDS == NULL)
+                {
+                    std::string message = std::string("Could not open image ") + maskImage;
+                    throw rsgis::RSGISImageException(message.c_str());
+                }
+            }
+            
+            std::vector<rsgis::classifier::RSGISBatchPredictOutput> outputs;
+            unsigned int numOutputs = 0;
+            for(unsigned int i = 0; i < outputImages.size(); ++i)
+            {
+                rsgis::classifier::RSGISBatchPredictOutput output;
+                output.image = outputImages[i];
+                output.numBands = outNumBands[i];
+                output.dataType = RSGIS_to_GDAL_Type(outDataTypes[i]);
+                outputs.push_back(output);
+                numOutputs += outNumBands[i];
+            }
+            
+            rsgis::classifier::RSGISBatchPredictorFunction predictor(numOutputs, predictFunc);
+            rsgis::classifier::RSGISBatchPredictImage::predictImage(inputs, maskDS, maskVal, &predictor, outputs, gdalFormat, batchSize, useNoData, noDataVal, outNoDataVal);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            for(std::vector<GDALDataset*>::iterator iterDS = datasets.begin(); iterDS != datasets.end(); ++iterDS)
+            {
+                GDALClose(*iterDS);
+            }
+            if(maskDS != NULL)
+            {
+                GDALClose(maskDS);
+            }
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            for(std::vector<GDALDataset*>::iterator iterDS = datasets.begin(); iterDS != datasets.end(); ++iterDS)
+            {
+                GDALClose(*iterDS);
+            }
+            if(maskDS != NULL)
+            {
+                GDALClose(maskDS);
+            }
+            throw RSGISCmdException(e.what());
+        }
+        
+        for(std::vector<GDALDataset*>::iterator iterDS = datasets.begin(); iterDS != datasets.end(); ++iterDS)
+        {
+            GDALClose(*iterDS);
+        }
+        if(maskDS != NULL)
+        {
+            GDALClose(maskDS);
+        }
+    }
+
+
+    void executeBatchPredictRAT(std::string clumpsImage, std::vector<std::string> featCols, std::function<void(const double*, size_t, unsigned int, double*)> predictFunc, std::string outIntCol, std::string roiCol, int roiVal, std::map<int, RSGISCmdClassInfo> classes, std::string outStrCol, bool setColours, size_t chunkSize, unsigned int ratBand)
+    {
+        rsgis::RSGISGDALInit::init();
+        GDALDataset *clumpsDS = NULL;
+        try
+        {
+            clumpsDS = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
+            if(clumpsDS == NULL)
+            {
+                std::string message = std::string("Could not open image ") + clumpsImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            if((ratBand == 0) || (ratBand > ((unsigned int)clumpsDS->GetRasterCount())))
+            {
+                throw rsgis::RSGISImageException("The RAT band specified is not within the image.");
+            }
+            GDALRasterAttributeTable *gdalRAT = clumpsDS->GetRasterBand(ratBand)->GetDefaultRAT();
+            
+            std::map<int, rsgis::classifier::RSGISBatchPredictRATClass> ratClasses;
+            for(std::map<int, RSGISCmdClassInfo>::iterator iterClass = classes.begin(); iterClass != classes.end(); ++iterClass)
+            {
+                rsgis::classifier::RSGISBatchPredictRATClass ratClass;
+                ratClass.name = iterClass->second.name;
+                ratClass.red = iterClass->second.red;
+                ratClass.green = iterClass->second.green;
+                ratClass.blue = iterClass->second.blue;
+                ratClasses[iterClass->first] = ratClass;
+            }
+            
+            rsgis::classifier::RSGISBatchPredictRAT::predictRAT(gdalRAT, featCols, predictFunc, outIntCol, roiCol, roiVal, &ratClasses, outStrCol, setColours, chunkSize);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            if(clumpsDS != NULL)
+            {
+                GDALClose(clumpsDS);
+            }
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            if(clumpsDS != NULL)
+            {
+                GDALClose(clumpsDS);
+            }
+            throw RSGISCmdException(e.what());
+        }
+        
+        GDALClose(clumpsDS);
+    }
+
+    RSGISCmdConfusionMatrix executeCalcClassConfusionMatrix(std::string classImage, std::string refImage, std::vector<long> classIds, bool useClsNoData, float clsNoData, bool useRefNoData, float refNoData, std::string strataImage, std::map<long, double> strataWeights)
+    {
+        RSGISCmdConfusionMatrix confMatrix;
+        rsgis::RSGISGDALInit::init();
+        bool useStrata = (strataImage != "");
+        unsigned int numDS = useStrata?3:2;
+        GDALDataset *datasets[3] = {NULL, NULL, NULL};
+        try
+        {
+            if(useStrata && strataWeights.empty())
+            {
+                throw rsgis::RSGISException("The strata weights must be provided with a strata image.");
+            }
+            
+            std::string imgFiles[3] = {classImage, refImage, strataImage};
+            for(unsigned int i = 0; i < numDS; ++i)
+            {
+                datasets[i] = (GDALDataset *) GDALOpen(imgFiles[i].c_str(), GA_ReadOnly);
+                if(datasets[i] == NULL)
+                {
+                    std::string message = std::string("Could not open image ") + imgFiles[i];
+                    throw rsgis::RSGISImageException(message.c_str());
+                }
+                if(datasets[i]->GetRasterCount() != 1)
+                {
+                    std::string message = std::string("Image must have a single band: ") + imgFiles[i];
+                    throw rsgis::RSGISImageException(message.c_str());
+                }
+            }
+            
+            // The thread-local confusion matrices are merged once the pass has completed.
+            rsgis::classifier::RSGISClassConfusionMatrix calcConfMatrix = rsgis::classifier::RSGISClassConfusionMatrix(classIds, useClsNoData, clsNoData, useRefNoData, refNoData, useStrata?strataWeights:std::map<long, double>());
+            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&calcConfMatrix, "", true);
+            calcImage.calcImage(datasets, numDS);
+            
+            for(unsigned int i = 0; i < numDS; ++i)
+            {
+                GDALClose(datasets[i]);
+                datasets[i] = NULL;
+            }
+            
+            unsigned int numClasses = calcConfMatrix.getNumClasses();
+            const std::vector<double> &matrix = calcConfMatrix.getMatrix();
+            confMatrix.classIds = calcConfMatrix.getClassIds();
+            for(unsigned int i = 0; i < numClasses; ++i)
+            {
+                confMatrix.matrix.push_back(std::vector<double>(matrix.begin() + (i * numClasses), matrix.begin() + ((i + 1) * numClasses)));
+            }
+            confMatrix.mappedPxlCounts = calcConfMatrix.getMappedPxlCounts();
+            confMatrix.numComparedPxls = calcConfMatrix.getNumComparedPxls();
+            confMatrix.numUnlistedPxls = calcConfMatrix.getNumUnlistedPxls();
+            
+            rsgis::classifier::RSGISAreaAdjustedAccuracy acc = rsgis::classifier::RSGISClassConfusionMatrix::calcAreaAdjustedAccuracy(matrix, confMatrix.mappedPxlCounts, numClasses);
+            confMatrix.overallAcc = acc.overallAcc;
+            confMatrix.overallAccSE = acc.overallAccSE;
+            confMatrix.userAcc = acc.userAcc;
+            confMatrix.userAccSE = acc.userAccSE;
+            confMatrix.prodAcc = acc.prodAcc;
+            confMatrix.prodAccSE = acc.prodAccSE;
+            confMatrix.propArea = acc.propArea;
+            confMatrix.propAreaSE = acc.propAreaSE;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            for(unsigned int i = 0; i < numDS; ++i)
+            {
+                if(datasets[i] != NULL)
+                {
+                    GDALClose(datasets[i]);
+                }
+            }
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            for(unsigned int i = 0; i < numDS; ++i)
+            {
+                if(datasets[i] != NULL)
+                {
+                    GDALClose(datasets[i]);
+                }
+            }
+            throw RSGISCmdException(e.what());
+        }
+        return confMatrix;
+    }
+    
 }}
 
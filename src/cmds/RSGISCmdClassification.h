@@ -27,6 +27,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <functional>
 
 #include "common/RSGISCommons.h"
 #include "RSGISCmdException.h"
@@ -46,6 +47,33 @@
 
 namespace rsgis{ namespace cmds {
 
+    /** The name and colour of a class (used when adding class names and colours to a RAT) */
+    struct DllExport RSGISCmdClassInfo
+    {
+        std::string name;
+        int red;
+        int green;
+        int blue;
+    };
+
+    /** The confusion matrix (rows are the classified classes) between a classification and a reference image, with the area adjusted accuracy estimates */
+    struct DllExport RSGISCmdConfusionMatrix
+    {
+        std::vector<long> classIds;
+        std::vector<std::vector<double> > matrix;
+        std::vector<double> mappedPxlCounts;
+        unsigned long numComparedPxls;
+        unsigned long numUnlistedPxls;
+        double overallAcc;
+        double overallAccSE;
+        std::vector<double> userAcc;
+        std::vector<double> userAccSE;
+        std::vector<double> prodAcc;
+        std::vector<double> prodAccSE;
+        std::vector<double> propArea;
+        std::vector<double> propAreaSE;
+    };
+
     /** A function to collapse a segmentation RAT to a classification (i.e., 1 row per class) */
     DllExport void executeCollapseRAT2Class(std::string clumpsImage, std::string outputImage, std::string outImageFormat, std::string classColumn, std::string classIntCol="", bool useIntCol=false);
     
@@ -63,6 +91,15 @@ namespace rsgis{ namespace cmds {
 
     /** A function to populate a set of points with the class information to assess the accuracy of a map */
     DllExport void executePopClassInfoAccuracyPts(std::string classImage, std::string vecFile, std::string vecLyr, std::string classImgCol, std::string classImgVecCol, std::string classRefVecCol="", bool addRefCol=false, std::string processVecCol="", bool addProcessCol=false);
+    
+    /** A function to apply a model (predictFunc) to the valid pixels of a set of images, in batches of about batchSize pixels. The features are passed row-major (numSamples x numFeatures) and predictFunc writes the outputs row-major (numSamples x sum(outNumBands)) */
+    DllExport void executeBatchPredictImage(std::vector<std::string> inputImages, std::vector<std::vector<unsigned int> > inputBands, std::string maskImage, int maskVal, std::function<void(const float*, size_t, unsigned int, float*)> predictFunc, std::vector<std::string> outputImages, std::vector<unsigned int> outNumBands, std::vector<RSGISLibDataType> outDataTypes, std::string gdalFormat, size_t batchSize=65536, bool useNoData=false, float noDataVal=0, float outNoDataVal=0);
+    
+    /** A function to apply a classifier (predictFunc) to the rows of a RAT, in chunks of chunkSize rows. The features are passed row-major (numRows x numFeatures) and predictFunc writes a class id for each row. If classes is not empty then the class names (outStrCol) and colours (if setColours) are also written */
+    DllExport void executeBatchPredictRAT(std::string clumpsImage, std::vector<std::string> featCols, std::function<void(const double*, size_t, unsigned int, double*)> predictFunc, std::string outIntCol, std::string roiCol, int roiVal, std::map<int, RSGISCmdClassInfo> classes, std::string outStrCol, bool setColours, size_t chunkSize=100000, unsigned int ratBand=1);
+
+    /** A function to calculate the confusion matrix between a classification and a reference image in a single (parallel) pass, optionally weighting the pixels by the weight of their stratum within a strata image */
+    DllExport RSGISCmdConfusionMatrix executeCalcClassConfusionMatrix(std::string classImage, std::string refImage, std::vector<long> classIds, bool useClsNoData=false, float clsNoData=0, bool useRefNoData=false, float refNoData=0, std::string strataImage="", std::map<long, double> strataWeights=std::map<long, double>());
 
 }}
 #endif
@@ -22,9 +22,15 @@
 
 #include "RSGISCmdElevationTools.h"
 #include "RSGISCmdParent.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISGDALInit.h"
 
 #include "calibration/RSGISDEMTools.h"
+#include "calibration/RSGISDEMRoughness.h"
 #include "calibration/RSGISHydroDEMFillSoilleGratin94.h"
+#include "calibration/RSGISHydroDEMFillPriorityFlood.h"
+
+#include "img/RSGISCalcImageT.h"
 
 namespace rsgis{ namespace cmds {
     
@@ -32,7 +38,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             std::cout << "Open " << demImage << std::endl;
             auto *dataset = (GDALDataset *) GDALOpen(demImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
@@ -80,7 +86,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             auto **datasets = new GDALDataset*[2];
 
             std::cout << "Open " << demImage << std::endl;
@@ -134,7 +140,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             std::cout << "Open " << demImage << std::endl;
             auto *dataset = (GDALDataset *) GDALOpen(demImage.c_str(), GA_ReadOnly);
@@ -183,7 +189,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             auto **datasets = new GDALDataset*[2];
 
             std::cout << "Open " << demImage << std::endl;
@@ -236,7 +242,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             std::cout << "Open Aspect Image: " << aspectImage << std::endl;
             auto *dataset = (GDALDataset *) GDALOpen(aspectImage.c_str(), GA_ReadOnly);
@@ -247,8 +253,12 @@ namespace rsgis{ namespace cmds {
             }
 
             auto catAspect = rsgis::calib::RSGISRecodeAspect();
-            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&catAspect, "", true);
-            calcImage.calcImage(&dataset, 1, outputImage, false, NULL, outImageFormat, GDT_Byte);
+            // Integer aspect images can be recoded with a look up table.
+            if(!rsgis::img::RSGISCalcImageLUT::calcImage(&catAspect, std::vector<int>(), &dataset, 1, outputImage, false, NULL, outImageFormat, GDT_Byte, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads))
+            {
+                rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&catAspect, "", true);
+                calcImage.calcImage(&dataset, 1, outputImage, false, NULL, outImageFormat, GDT_Byte);
+            }
             
             GDALClose(dataset);
         }
@@ -263,7 +273,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             if((solarZenith < 0) | (solarZenith > 90))
             {
@@ -323,7 +333,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             if((solarZenith < 0) | (solarZenith > 90))
             {
@@ -389,7 +399,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             if((solarZenith < 0) | (solarZenith > 90))
             {
@@ -446,11 +456,90 @@ namespace rsgis{ namespace cmds {
     }
 
     
+    void executeCalcShadowMasks(std::string demImage, std::string outputImage, std::vector<float> solarAzimuths, std::vector<float> solarZeniths, std::string outImageFormat)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            
+            if(solarAzimuths.size() != solarZeniths.size())
+            {
+                throw rsgis::RSGISException("The same number of solar azimuth and zenith angles must be provided.");
+            }
+            if(solarAzimuths.empty())
+            {
+                throw rsgis::RSGISException("At least one sun position must be provided.");
+            }
+            for(size_t i = 0; i < solarAzimuths.size(); ++i)
+            {
+                if((solarZeniths[i] < 0) | (solarZeniths[i] > 90))
+                {
+                    throw rsgis::RSGISException("The solar zenith should be between 0 and 90 degrees.");
+                }
+                
+                if((solarAzimuths[i] < 0) | (solarAzimuths[i] > 360))
+                {
+                    throw rsgis::RSGISException("The solar azimuth should be between 0 and 360 degrees.");
+                }
+            }
+            
+            std::cout << "Open " << demImage << std::endl;
+            auto *dataset = (GDALDataset *) GDALOpen(demImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + demImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            double demNoDataVal = 0.0;
+            int demNoDataValAvail = false;
+            demNoDataVal = dataset->GetRasterBand(1)->GetNoDataValue(&demNoDataValAvail);
+            if(!demNoDataValAvail)
+            {
+                GDALClose(dataset);
+                throw rsgis::RSGISException("The DEM image file does not have a no data value defined. ");
+            }
+            
+            // The DEM is read once for all the sun positions.
+            rsgis::calib::RSGISCalcTerrainShadowSweep calcShadowMasks(dataset, 0, demNoDataVal);
+            std::vector< std::vector<unsigned char> > masks;
+            calcShadowMasks.calcShadowMasks(solarZeniths, solarAzimuths, masks);
+            
+            double transformation[6];
+            dataset->GetGeoTransform(transformation);
+            std::vector<std::string> bandNames;
+            for(size_t i = 0; i < masks.size(); ++i)
+            {
+                bandNames.push_back("shadow_" + std::to_string(i+1));
+            }
+            rsgis::img::RSGISImageUtils imgUtils;
+            GDALDataset *outDataset = imgUtils.createBlankImage(outputImage, transformation, calcShadowMasks.getWidth(), calcShadowMasks.getHeight(), masks.size(), std::string(dataset->GetProjectionRef()), 0, bandNames, outImageFormat, GDT_Byte);
+            GDALClose(dataset);
+            if(outDataset == NULL)
+            {
+                throw rsgis::RSGISImageException("Could not create the output image: " + outputImage);
+            }
+            for(size_t i = 0; i < masks.size(); ++i)
+            {
+                if(outDataset->GetRasterBand(i+1)->RasterIO(GF_Write, 0, 0, calcShadowMasks.getWidth(), calcShadowMasks.getHeight(), masks[i].data(), calcShadowMasks.getWidth(), calcShadowMasks.getHeight(), GDT_Byte, 0, 0) != CE_None)
+                {
+                    GDALClose(outDataset);
+                    throw rsgis::RSGISImageException("Could not write the output image: " + outputImage);
+                }
+            }
+            GDALClose(outDataset);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+    
     void executeCalcLocalIncidenceAngle(std::string demImage, std::string outputImage, float solarAzimuth, float solarZenith, std::string outImageFormat)
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             std::cout << "Open " << demImage << std::endl;
             auto *dataset = (GDALDataset *) GDALOpen(demImage.c_str(), GA_ReadOnly);
@@ -499,7 +588,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             std::cout << "Open " << demImage << std::endl;
             auto *dataset = (GDALDataset *) GDALOpen(demImage.c_str(), GA_ReadOnly);
@@ -543,12 +632,106 @@ namespace rsgis{ namespace cmds {
             throw RSGISCmdException(e.what());
         }
     }
+    
+    void executeCalcTerrainDerivatives(std::string demImage, std::string outputImage, std::vector<RSGISDEMTerrainDerivative> derivatives, RSGISAngleMeasure slopeUnit, float solarAzimuth, float solarZenith, float viewAzimuth, float viewZenith, std::string outImageFormat)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            
+            if(derivatives.empty())
+            {
+                throw rsgis::RSGISException("At least one terrain derivative needs to be specified.");
+            }
+            
+            std::vector<rsgis::calib::RSGISTerrainDerivative> calibDerivatives;
+            std::vector<std::string> bandNames;
+            bool useSun = false;
+            for(auto derivative : derivatives)
+            {
+                rsgis::calib::RSGISTerrainDerivative calibDerivative = rsgis::calib::rsgis_terrain_slope;
+                if(derivative == rsgis_dem_aspect)
+                {
+                    calibDerivative = rsgis::calib::rsgis_terrain_aspect;
+                }
+                else if(derivative == rsgis_dem_hillshade)
+                {
+                    calibDerivative = rsgis::calib::rsgis_terrain_hillshade;
+                    useSun = true;
+                }
+                else if(derivative == rsgis_dem_incidence)
+                {
+                    calibDerivative = rsgis::calib::rsgis_terrain_incidence;
+                    useSun = true;
+                }
+                else if(derivative == rsgis_dem_exitance)
+                {
+                    calibDerivative = rsgis::calib::rsgis_terrain_exitance;
+                }
+                calibDerivatives.push_back(calibDerivative);
+                bandNames.push_back(rsgis::calib::RSGISCalcTerrainDerivatives::getDerivativeBandName(calibDerivative));
+            }
+            
+            if(useSun && ((solarZenith < 0) | (solarZenith > 90)))
+            {
+                throw rsgis::RSGISException("The solar zenith should be between 0 and 90 degrees.");
+            }
+            
+            std::cout << "Open " << demImage << std::endl;
+            auto *dataset = (GDALDataset *) GDALOpen(demImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + demImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            double demNoDataVal = 0.0;
+            int demNoDataValAvail = false;
+            demNoDataVal = dataset->GetRasterBand(1)->GetNoDataValue(&demNoDataValAvail);
+            if(!demNoDataValAvail)
+            {
+                GDALClose(dataset);
+                throw rsgis::RSGISException("The DEM image file does not have a no data value defined. ");
+            }
+            
+            double transformation[6];
+            dataset->GetGeoTransform(transformation);
+            
+            float imageEWRes = transformation[1];
+            float imageNSRes = transformation[5];
+            
+            if(imageNSRes < 0)
+            {
+                imageNSRes = imageNSRes * (-1);
+            }
+            
+            auto calcDerivatives = rsgis::calib::RSGISCalcTerrainDerivatives(calibDerivatives, 0, imageEWRes, imageNSRes, slopeUnit, solarZenith, solarAzimuth, viewZenith, viewAzimuth, demNoDataVal);
+            auto calcImage = rsgis::img::RSGISCalcImage(&calcDerivatives, "", true);
+            calcImage.calcImageWindowData(&dataset, 1, outputImage, 3, outImageFormat, GDT_Float32);
+            GDALClose(dataset);
+            
+            // Name the bands after the derivatives.
+            auto *outImgDS = (GDALDataset *) GDALOpen(outputImage.c_str(), GA_Update);
+            if(outImgDS == NULL)
+            {
+                std::string message = std::string("Could not open image ") + outputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            rsgis::img::RSGISImageUtils imgUtils;
+            imgUtils.setImageBandNames(outImgDS, bandNames, true);
+            GDALClose(outImgDS);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
             
     void executeDTMAspectMedianFilter(std::string demImage, std::string aspectImage, std::string outputImage, float aspectRange, int winHSize, std::string outImageFormat)
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             auto **datasets = new GDALDataset*[2];
             
             std::cout << "Open " << demImage << std::endl;
@@ -597,7 +780,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             std::cout << "Open " << inImage << std::endl;
             auto *inImgDS = (GDALDataset *) GDALOpen(inImage.c_str(), GA_ReadOnly);
@@ -640,11 +823,58 @@ namespace rsgis{ namespace cmds {
         }
     }
     
+    void executeDEMFillPriorityFlood(std::string inImage, std::string validDataImg, std::string outputImage, std::string outImageFormat, unsigned int tileSize)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            
+            std::cout << "Open " << inImage << std::endl;
+            auto *inImgDS = (GDALDataset *) GDALOpen(inImage.c_str(), GA_ReadOnly);
+            if(inImgDS == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            std::cout << "Open " << validDataImg << std::endl;
+            auto *inValidImgDS = (GDALDataset *) GDALOpen(validDataImg.c_str(), GA_ReadOnly);
+            if(inValidImgDS == NULL)
+            {
+                std::string message = std::string("Could not open image ") + validDataImg;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            GDALDataType imgDT = inImgDS->GetRasterBand(1)->GetRasterDataType();
+            if((imgDT == GDT_Float32) | (imgDT == GDT_Float64) | (imgDT == GDT_Unknown) | (imgDT == GDT_CInt16) | (imgDT == GDT_CInt32) | (imgDT == GDT_CFloat32) | (imgDT == GDT_CFloat64))
+            {
+                throw rsgis::RSGISImageException("Input image must be of an integer data type.");
+            }
+            
+            rsgis::img::RSGISImageUtils imgUtils;
+            GDALDataset *outImgDS = imgUtils.createCopy(inImgDS, 1, outputImage, outImageFormat, imgDT);
+            
+            rsgis::calib::RSGISHydroDEMFillPriorityFlood fillDEMInst;
+            fillDEMInst.performPriorityFloodFill(inImgDS, inValidImgDS, outImgDS, true, 0, tileSize);
+            
+            GDALClose(inImgDS);
+            GDALClose(inValidImgDS);
+            GDALClose(outImgDS);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+    
     void executePlaneFitDetreadDEM(std::string demImage, std::string outputImage, std::string outImageFormat, int winSize)
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             std::cout << "Open " << demImage << std::endl;
             auto *inImgDS = (GDALDataset *) GDALOpen(demImage.c_str(), GA_ReadOnly);
@@ -679,6 +909,71 @@ namespace rsgis{ namespace cmds {
         }
     }
     
+    void executeCalcDEMRoughness(std::string demImage, std::string outputImage, RSGISDEMRoughnessMetrics metrics, int winSize, bool detrend, std::string outImageFormat)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            
+            std::cout << "Open " << demImage << std::endl;
+            auto *inImgDS = (GDALDataset *) GDALOpen(demImage.c_str(), GA_ReadOnly);
+            if(inImgDS == NULL)
+            {
+                std::string message = std::string("Could not open image ") + demImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            int demNoDataValAvail = false;
+            double demNoDataVal = inImgDS->GetRasterBand(1)->GetNoDataValue(&demNoDataValAvail);
+            double outNoDataVal = -9999;
+            if(demNoDataValAvail)
+            {
+                outNoDataVal = demNoDataVal;
+            }
+            
+            double geoTrans[6];
+            inImgDS->GetGeoTransform(geoTrans);
+            
+            rsgis::calib::RSGISRoughnessMetrics calibMetrics = rsgis::calib::rsgis_rough_profile;
+            if(metrics == rsgis_dem_rough_munro)
+            {
+                calibMetrics = rsgis::calib::rsgis_rough_munro;
+            }
+            else if(metrics == rsgis_dem_rough_smith)
+            {
+                calibMetrics = rsgis::calib::rsgis_rough_smith;
+            }
+            
+            auto calcRoughness = rsgis::calib::RSGISCalcDEMRoughness(calibMetrics, geoTrans[1], geoTrans[5], detrend, demNoDataValAvail, demNoDataVal, outNoDataVal);
+            auto calcImage = rsgis::img::RSGISCalcImage(&calcRoughness, "", true);
+            calcImage.calcImageWindowData(&inImgDS, 1, outputImage, winSize, outImageFormat, GDT_Float32);
+            GDALClose(inImgDS);
+            
+            // Name the bands after the metrics and define the no data value.
+            auto *outImgDS = (GDALDataset *) GDALOpen(outputImage.c_str(), GA_Update);
+            if(outImgDS == NULL)
+            {
+                std::string message = std::string("Could not open image ") + outputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            rsgis::img::RSGISImageUtils imgUtils;
+            imgUtils.setImageBandNames(outImgDS, rsgis::calib::RSGISCalcDEMRoughness::getMetricBandNames(calibMetrics), true);
+            for(int n = 1; n <= outImgDS->GetRasterCount(); ++n)
+            {
+                outImgDS->GetRasterBand(n)->SetNoDataValue(outNoDataVal);
+            }
+            GDALClose(outImgDS);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+    
 }}
 
 
@@ -52,6 +52,22 @@ namespace rsgis{ namespace cmds {
         rsgis_radians = 1
     };
     
+    enum RSGISDEMRoughnessMetrics
+    {
+        rsgis_dem_rough_profile = 0,
+        rsgis_dem_rough_munro = 1,
+        rsgis_dem_rough_smith = 2
+    };
+    
+    enum RSGISDEMTerrainDerivative
+    {
+        rsgis_dem_slope = 0,
+        rsgis_dem_aspect = 1,
+        rsgis_dem_hillshade = 2,
+        rsgis_dem_incidence = 3,
+        rsgis_dem_exitance = 4
+    };
+    
     /** A function to generate a slope layer */
     DllExport void executeCalcSlope(std::string demImage, std::string outputImage, RSGISAngleMeasure outAngleUnit, std::string outImageFormat);
     /** A function to generate a slope layer using External Pixel Resolution Image */
@@ -68,16 +84,25 @@ namespace rsgis{ namespace cmds {
     DllExport void executeCalcHillshadeImgPxlRes(std::string demImage, std::string demPxlResImage, std::string outputImage, float solarAzimuth, float solarZenith, std::string outImageFormat);
     /** A function to generate a shadow mask layer */
     DllExport void executeCalcShadowMask(std::string demImage, std::string outputImage, float solarAzimuth, float solarZenith, float maxHeight, std::string outImageFormat);
+    /** A function to generate a shadow mask band for each sun position with a sweep of the DEM (see rsgis::calib::RSGISCalcTerrainShadowSweep) */
+    DllExport void executeCalcShadowMasks(std::string demImage, std::string outputImage, std::vector<float> solarAzimuths, std::vector<float> solarZeniths, std::string outImageFormat);
     /** A function to generate a local incidence angle layer given the sun position */
     DllExport void executeCalcLocalIncidenceAngle(std::string demImage, std::string outputImage, float solarAzimuth, float solarZenith, std::string outImageFormat);
     /** A function to generate a local exitance angle layer given a viewers position */
     DllExport void executeCalcLocalExitanceAngle(std::string demImage, std::string outputImage, float viewAzimuth, float viewZenith, std::string outImageFormat);
+    /** A function to calculate a set of terrain derivatives (one band per derivative, in the order given) with a single pass of the DEM (see rsgis::calib::RSGISCalcTerrainDerivatives) */
+    DllExport void executeCalcTerrainDerivatives(std::string demImage, std::string outputImage, std::vector<RSGISDEMTerrainDerivative> derivatives, RSGISAngleMeasure slopeUnit, float solarAzimuth, float solarZenith, float viewAzimuth, float viewZenith, std::string outImageFormat);
     /** A function to filter a DTM using a variable filter with respect to aspect */
     DllExport void executeDTMAspectMedianFilter(std::string demImage, std::string aspectImage, std::string outputImage, float aspectRange, int winHSize, std::string outImageFormat);
     /** A function to fill a DEM using the Soille and Gratin 1994 algorthm */
     DllExport void executeDEMFillSoilleGratin1994(std::string inImage, std::string validDataImg, std::string outputImage, std::string outImageFormat);
+    /** A function to fill a DEM using a priority-flood, processed in memory or (tileSize > 0) as tiles of tileSize x tileSize pixels */
+    DllExport void executeDEMFillPriorityFlood(std::string inImage, std::string validDataImg, std::string outputImage, std::string outImageFormat, unsigned int tileSize=0);
     /** A function which detreads an elevation model using local plane fitting */
     DllExport void executePlaneFitDetreadDEM(std::string demImage, std::string outputImage, std::string outImageFormat, int winSize);
+    
+    /** A function to calculate the roughness metrics of the window around each pixel of a DEM (one band per metric) */
+    DllExport void executeCalcDEMRoughness(std::string demImage, std::string outputImage, RSGISDEMRoughnessMetrics metrics, int winSize, bool detrend, std::string outImageFormat);
 }}
 
 
@@ -22,6 +22,7 @@
 
 
 #include "RSGISCmdFilterImages.h"
+#include "common/RSGISGDALInit.h"
 #include "RSGISCmdParent.h"
 
 #include "filtering/RSGISFilterBank.h"
@@ -34,214 +35,264 @@
 #include "filtering/RSGISStatsFilters.h"
 #include "filtering/RSGISSpeckleFilters.h"
 #include "filtering/RSGISSARTextureFilters.h"
+#include "filtering/RSGISSeparableGaussianFilterBank.h"
+#include "filtering/RSGISGradientFilter.h"
 
 
 namespace rsgis{ namespace cmds {
 
-    void executeFilter(std::string inputImage, std::vector<rsgis::cmds::RSGISFilterParameters*> *filterParameters, std::string outputImageBase, std::string imageFormat, std::string imageExt, RSGISLibDataType outDataType) 
+    /* Create the filter for the parameters, returning NULL if the filter is not recognised. */
+    static rsgis::filter::RSGISImageFilter* createImageFilter(rsgis::cmds::RSGISFilterParameters *filterParams)
+    {
+        rsgis::filter::RSGISImageFilter *filter = NULL;
+        if(filterParams->type == "")
+        {
+            std::cerr << "No type set, skipping filter" << std::endl;
+        }
+        else if(filterParams->type == "GaussianSmooth")
+        {
+            rsgis::filter::RSGISCalcGaussianSmoothFilter *calcGaussianSmoothFilter = new rsgis::filter::RSGISCalcGaussianSmoothFilter(filterParams->stddevX, filterParams->stddevY, filterParams->angle);
+            rsgis::filter::RSGISGenerateFilter *genFilter = new rsgis::filter::RSGISGenerateFilter(calcGaussianSmoothFilter);
+            rsgis::filter::ImageFilter *filterKernal = genFilter->generateFilter(filterParams->size);
+            filter = new rsgis::filter::RSGISImageKernelFilter(0, filterParams->size, filterParams->fileEnding, filterKernal);
+            delete calcGaussianSmoothFilter;
+            delete genFilter;
+        }
+        else if(filterParams->type == "Gaussian1st")
+        {
+            rsgis::filter::RSGISCalcGaussianFirstDerivativeFilter *calcGaussian1stDerivFilter = new rsgis::filter::RSGISCalcGaussianFirstDerivativeFilter(filterParams->stddevX, filterParams->stddevY, filterParams->angle);
+            rsgis::filter::RSGISGenerateFilter *genFilter = new rsgis::filter::RSGISGenerateFilter(calcGaussian1stDerivFilter);
+            rsgis::filter::ImageFilter *filterKernal = genFilter->generateFilter(filterParams->size);
+            filter = new rsgis::filter::RSGISImageKernelFilter(0, filterParams->size, filterParams->fileEnding, filterKernal);
+            delete calcGaussian1stDerivFilter;
+            delete genFilter;
+        }
+        else if(filterParams->type == "Gaussian2nd")
+        {
+             rsgis::filter::RSGISCalcGaussianSecondDerivativeFilter *calcGaussian2ndDerivFilter = new rsgis::filter::RSGISCalcGaussianSecondDerivativeFilter(filterParams->stddevX, filterParams->stddevY, filterParams->angle);
+            rsgis::filter::RSGISGenerateFilter *genFilter = new rsgis::filter::RSGISGenerateFilter(calcGaussian2ndDerivFilter);
+            rsgis::filter::ImageFilter *filterKernal = genFilter->generateFilter(filterParams->size);
+            filter = new rsgis::filter::RSGISImageKernelFilter(0, filterParams->size, filterParams->fileEnding, filterKernal);
+            delete calcGaussian2ndDerivFilter;
+            delete genFilter;
+        }
+        else if(filterParams->type == "Laplacian")
+        {
+            rsgis::filter::RSGISCalcLapacianFilter *calcLapacianFilter = new rsgis::filter::RSGISCalcLapacianFilter(filterParams->stddev);
+            rsgis::filter::RSGISGenerateFilter *genFilter = new rsgis::filter::RSGISGenerateFilter(calcLapacianFilter);
+            rsgis::filter::ImageFilter *filterKernal = genFilter->generateFilter(filterParams->size);
+            filter = new rsgis::filter::RSGISImageKernelFilter(0, filterParams->size, filterParams->fileEnding, filterKernal);
+            delete calcLapacianFilter;
+            delete genFilter;
+        }
+        else if(filterParams->type == "Sobel")
+        {
+            if(filterParams->option == "x")
+            {
+                filter = new rsgis::filter::RSGISSobelFilter(0, 3, filterParams->fileEnding, rsgis::filter::RSGISSobelFilter::x);
+            }
+            else if(filterParams->option == "y")
+            {
+                filter = new rsgis::filter::RSGISSobelFilter(0, 3, filterParams->fileEnding, rsgis::filter::RSGISSobelFilter::y);
+            }
+            else if (filterParams->option == "xy")
+            {
+                filter = new rsgis::filter::RSGISSobelFilter(0, 3, filterParams->fileEnding, rsgis::filter::RSGISSobelFilter::xy);
+            }
+            else
+            {
+                std::cerr << "Sobel type not recognised, skipping filter" << std::endl;
+            }
+        }
+        else if(filterParams->type == "Prewitt")
+        {
+            if(filterParams->option == "x")
+            {
+                filter = new rsgis::filter::RSGISPrewittFilter(0, 3, filterParams->fileEnding, rsgis::filter::RSGISPrewittFilter::x);
+            }
+            else if(filterParams->option == "y")
+            {
+                filter = new rsgis::filter::RSGISPrewittFilter(0, 3, filterParams->fileEnding, rsgis::filter::RSGISPrewittFilter::y);
+            }
+            else if (filterParams->option == "xy")
+            {
+                filter = new rsgis::filter::RSGISPrewittFilter(0, 3, filterParams->fileEnding, rsgis::filter::RSGISPrewittFilter::xy);
+            }
+            else
+            {
+                std::cerr << "Prewitt type not recognised, skipping filter" << std::endl;
+            }
+        }
+        else if(filterParams->type == "Mean")
+        {
+            filter = new rsgis::filter::RSGISMeanFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "Median")
+        {
+            filter = new rsgis::filter::RSGISMedianFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "Mode")
+        {
+            filter = new rsgis::filter::RSGISModeFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if( (filterParams->type == "MedianHist") | (filterParams->type == "PercentileHist") | (filterParams->type == "ModeHist") )
+        {
+            rsgis::filter::RSGISHistogramRankFilter::RankStat stat = rsgis::filter::RSGISHistogramRankFilter::median;
+            if(filterParams->type == "PercentileHist")
+            {
+                stat = rsgis::filter::RSGISHistogramRankFilter::percentile;
+            }
+            else if(filterParams->type == "ModeHist")
+            {
+                stat = rsgis::filter::RSGISHistogramRankFilter::mode;
+            }
+            double binWidth = filterParams->histBinWidth;
+            if(binWidth <= 0)
+            {
+                binWidth = 1;
+            }
+            filter = new rsgis::filter::RSGISHistogramRankFilter(0, filterParams->size, filterParams->fileEnding, stat, filterParams->histMin, filterParams->histMax, binWidth, filterParams->percentile);
+        }
+        else if(filterParams->type == "Range")
+        {
+            filter = new rsgis::filter::RSGISRangeFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "StdDev")
+        {
+            filter = new rsgis::filter::RSGISStdDevFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "CoeffOfVar")
+        {
+            filter = new rsgis::filter::RSGISCoeffOfVarFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "Min")
+        {
+            filter = new rsgis::filter::RSGISMinFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "Max")
+        {
+            filter = new rsgis::filter::RSGISMaxFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "Total")
+        {
+            filter = new rsgis::filter::RSGISTotalFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "Kuwahara")
+        {
+            filter = new rsgis::filter::RSGISKuwaharaFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "Lee")
+        {
+            filter = new rsgis::filter::RSGISLeeFilter(0, filterParams->size, filterParams->fileEnding, filterParams->nLooks);
+        }
+        else if( (filterParams->type == "NormVar") | (filterParams->type == "NormVarPower") )
+        {
+            filter = new rsgis::filter::RSGISNormVarPowerFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if( (filterParams->type == "NormVarSqrt") | (filterParams->type == "NormVarAmplitude") )
+        {
+            filter = new rsgis::filter::RSGISNormVarAmplitudeFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if( (filterParams->type == "NormVarLn") | (filterParams->type == "NormVarLnPower") )
+        {
+            filter = new rsgis::filter::RSGISNormVarLnPowerFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "NormLn")
+        {
+            filter = new rsgis::filter::RSGISNormLnFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "TextureVar")
+        {
+            filter = new rsgis::filter::RSGISTextureVar(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "MeanDiff")
+        {
+            filter = new rsgis::filter::RSGISMeanDiffFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "MeanDiffAbs")
+        {
+            filter = new rsgis::filter::RSGISMeanDiffAbsFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "TotalDiff")
+        {
+            filter = new rsgis::filter::RSGISTotalDiffFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else if(filterParams->type == "TotalDiffAbs")
+        {
+            filter = new rsgis::filter::RSGISTotalDiffAbsFilter(0, filterParams->size, filterParams->fileEnding);
+        }
+        else{std::cerr << "Filter not recognised - skipping" << std::endl;}
+        return filter;
+    }
+    
+    /* Add the filter to the separable Gaussian filter bank if it is a separable Gaussian filter, returning false otherwise. */
+    static bool addSeparableGaussianFilter(rsgis::filter::RSGISSeparableGaussianFilterBank *gaussianBank, rsgis::cmds::RSGISFilterParameters *filterParams)
+    {
+        if((filterParams->size % 2 == 0) || (filterParams->size < 3))
+        {
+            return false;
+        }
+        if(filterParams->type == "Laplacian")
+        {
+            if(filterParams->stddev <= 0)
+            {
+                return false;
+            }
+            gaussianBank->addFilter(rsgis::filter::RSGISSeparableGaussianFilterBank::gaussianLaplacian, filterParams->stddev, filterParams->stddev, 0, filterParams->size, filterParams->fileEnding);
+            return true;
+        }
+        
+        rsgis::filter::RSGISSeparableGaussianFilterBank::GaussianFilterType type = rsgis::filter::RSGISSeparableGaussianFilterBank::gaussianSmooth;
+        if(filterParams->type == "GaussianSmooth")
+        {
+            type = rsgis::filter::RSGISSeparableGaussianFilterBank::gaussianSmooth;
+        }
+        else if(filterParams->type == "Gaussian1st")
+        {
+            type = rsgis::filter::RSGISSeparableGaussianFilterBank::gaussianFirstDerivative;
+        }
+        else if(filterParams->type == "Gaussian2nd")
+        {
+            type = rsgis::filter::RSGISSeparableGaussianFilterBank::gaussianSecondDerivative;
+        }
+        else
+        {
+            return false;
+        }
+        
+        if((filterParams->stddevX <= 0) || (filterParams->stddevY <= 0) || !rsgis::filter::RSGISSeparableGaussianFilterBank::isSeparable(filterParams->stddevX, filterParams->stddevY, filterParams->angle))
+        {
+            return false;
+        }
+        gaussianBank->addFilter(type, filterParams->stddevX, filterParams->stddevY, filterParams->angle, filterParams->size, filterParams->fileEnding);
+        return true;
+    }
+
+    void executeFilter(std::string inputImage, std::vector<rsgis::cmds::RSGISFilterParameters*> *filterParameters, std::string outputImageBase, std::string imageFormat, std::string imageExt, RSGISLibDataType outDataType, bool fused, unsigned int numThreads)
     {
         try
         {
             // Set up filter bank
             rsgis::filter::RSGISFilterBank *filterBank = NULL;
             filterBank = new rsgis::filter::RSGISFilterBank();
+            // When fused, the separable Gaussian filters are calculated together with 1D passes.
+            rsgis::filter::RSGISSeparableGaussianFilterBank gaussianBank = rsgis::filter::RSGISSeparableGaussianFilterBank();
          
             // Get filter parameters and add to filter bank
             for(std::vector<rsgis::cmds::RSGISFilterParameters*>::iterator iterFilter = filterParameters->begin(); iterFilter != filterParameters->end(); ++iterFilter)
             {
-                if((*iterFilter)->type == "")
-                {
-                    std::cerr << "No type set, skipping filter" << std::endl;
-                }
-                else if((*iterFilter)->type == "GaussianSmooth")
-                {
-                    rsgis::filter::RSGISCalcGaussianSmoothFilter *calcGaussianSmoothFilter = new rsgis::filter::RSGISCalcGaussianSmoothFilter((*iterFilter)->stddevX, (*iterFilter)->stddevY, (*iterFilter)->angle);
-                    rsgis::filter::RSGISGenerateFilter *genFilter = new rsgis::filter::RSGISGenerateFilter(calcGaussianSmoothFilter);
-                    rsgis::filter::ImageFilter *filterKernal = genFilter->generateFilter((*iterFilter)->size);
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISImageKernelFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding, filterKernal);
-                    filterBank->addFilter(filter);
-                    delete calcGaussianSmoothFilter;
-                    delete genFilter;
-                }
-                else if((*iterFilter)->type == "Gaussian1st")
+                if(fused && addSeparableGaussianFilter(&gaussianBank, *iterFilter))
                 {
-                    rsgis::filter::RSGISCalcGaussianFirstDerivativeFilter *calcGaussian1stDerivFilter = new rsgis::filter::RSGISCalcGaussianFirstDerivativeFilter((*iterFilter)->stddevX, (*iterFilter)->stddevY, (*iterFilter)->angle);
-                    rsgis::filter::RSGISGenerateFilter *genFilter = new rsgis::filter::RSGISGenerateFilter(calcGaussian1stDerivFilter);
-                    rsgis::filter::ImageFilter *filterKernal = genFilter->generateFilter((*iterFilter)->size);
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISImageKernelFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding, filterKernal);
-                    filterBank->addFilter(filter);
-                    delete calcGaussian1stDerivFilter;
-                    delete genFilter;
-                }
-                else if((*iterFilter)->type == "Gaussian2nd")
-                {
-                     rsgis::filter::RSGISCalcGaussianSecondDerivativeFilter *calcGaussian2ndDerivFilter = new rsgis::filter::RSGISCalcGaussianSecondDerivativeFilter((*iterFilter)->stddevX, (*iterFilter)->stddevY, (*iterFilter)->angle);
-                    rsgis::filter::RSGISGenerateFilter *genFilter = new rsgis::filter::RSGISGenerateFilter(calcGaussian2ndDerivFilter);
-                    rsgis::filter::ImageFilter *filterKernal = genFilter->generateFilter((*iterFilter)->size);
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISImageKernelFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding, filterKernal);
-                    filterBank->addFilter(filter);
-                    delete calcGaussian2ndDerivFilter;
-                    delete genFilter;
+                    continue;
                 }
-                else if((*iterFilter)->type == "Laplacian")
+                rsgis::filter::RSGISImageFilter *filter = createImageFilter(*iterFilter);
+                if(filter != NULL)
                 {
-                    rsgis::filter::RSGISCalcLapacianFilter *calcLapacianFilter = new rsgis::filter::RSGISCalcLapacianFilter((*iterFilter)->stddev);
-                    rsgis::filter::RSGISGenerateFilter *genFilter = new rsgis::filter::RSGISGenerateFilter(calcLapacianFilter);
-                    rsgis::filter::ImageFilter *filterKernal = genFilter->generateFilter((*iterFilter)->size);
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISImageKernelFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding, filterKernal);
                     filterBank->addFilter(filter);
-                    delete calcLapacianFilter;
-                    delete genFilter;
                 }
-                else if((*iterFilter)->type == "Sobel")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = NULL;
-                    if((*iterFilter)->option == "x")
-                    {
-                        filter = new rsgis::filter::RSGISSobelFilter(0, 3, (*iterFilter)->fileEnding, rsgis::filter::RSGISSobelFilter::x);
-                    }
-                    else if((*iterFilter)->option == "y")
-                    {
-                        filter = new rsgis::filter::RSGISSobelFilter(0, 3, (*iterFilter)->fileEnding, rsgis::filter::RSGISSobelFilter::y);
-                    }
-                    else if ((*iterFilter)->option == "xy")
-                    {
-                        filter = new rsgis::filter::RSGISSobelFilter(0, 3, (*iterFilter)->fileEnding, rsgis::filter::RSGISSobelFilter::xy);
-                    }
-                    else
-                    {
-                        std::cerr << "Sobel type not recognised, skipping filter" << std::endl;
-                    }
-                    
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "Prewitt")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = NULL;
-                    
-                    if((*iterFilter)->option == "x")
-                    {
-                        filter = new rsgis::filter::RSGISPrewittFilter(0, 3, (*iterFilter)->fileEnding, rsgis::filter::RSGISPrewittFilter::x);
-                    }
-                    else if((*iterFilter)->option == "y")
-                    {
-                        filter = new rsgis::filter::RSGISPrewittFilter(0, 3, (*iterFilter)->fileEnding, rsgis::filter::RSGISPrewittFilter::y);
-                    }
-                    else if ((*iterFilter)->option == "xy")
-                    {
-                        filter = new rsgis::filter::RSGISPrewittFilter(0, 3, (*iterFilter)->fileEnding, rsgis::filter::RSGISPrewittFilter::xy);
-                    }
-                    else
-                    {
-                        std::cerr << "Prewitt type not recognised, skipping filter" << std::endl;
-                    }
-                    
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "Mean")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISMeanFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "Median")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISMedianFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "Mode")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISModeFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "Range")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISRangeFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "StdDev")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISStdDevFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "CoeffOfVar")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISCoeffOfVarFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "Min")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISMinFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "Max")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISMaxFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "Total")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISTotalFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "Kuwahara")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISKuwaharaFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "Lee")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISLeeFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding, (*iterFilter)->nLooks);
-                    filterBank->addFilter(filter);
-                }
-                else if( ((*iterFilter)->type == "NormVar") | ((*iterFilter)->type == "NormVarPower") )
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISNormVarPowerFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if( ((*iterFilter)->type == "NormVarSqrt") | ((*iterFilter)->type == "NormVarAmplitude") )
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISNormVarAmplitudeFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if( ((*iterFilter)->type == "NormVarLn") | ((*iterFilter)->type == "NormVarLnPower") )
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISNormVarLnPowerFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "NormLn")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISNormLnFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "TextureVar")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISTextureVar(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "MeanDiff")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISMeanDiffFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "MeanDiffAbs")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISMeanDiffAbsFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "TotalDiff")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISTotalDiffFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else if((*iterFilter)->type == "TotalDiffAbs")
-                {
-                    rsgis::filter::RSGISImageFilter *filter = new rsgis::filter::RSGISTotalDiffAbsFilter(0, (*iterFilter)->size, (*iterFilter)->fileEnding);
-                    filterBank->addFilter(filter);
-                }
-                else{std::cerr << "Filter not recognised - skipping" << std::endl;}
             }
             
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **dataset = NULL;
 
             dataset = new GDALDataset*[1];
@@ -253,7 +304,15 @@ namespace rsgis{ namespace cmds {
                 throw rsgis::RSGISImageException(message.c_str());
             }
             
-            filterBank->executeFilters(dataset, 1, outputImageBase, imageFormat, imageExt, RSGIS_to_GDAL_Type(outDataType));
+            if(fused)
+            {
+                gaussianBank.executeFilters(dataset, 1, outputImageBase, imageFormat, imageExt, RSGIS_to_GDAL_Type(outDataType), numThreads);
+                filterBank->executeFiltersFused(dataset, 1, outputImageBase, imageFormat, imageExt, RSGIS_to_GDAL_Type(outDataType), numThreads);
+            }
+            else
+            {
+                filterBank->executeFilters(dataset, 1, outputImageBase, imageFormat, imageExt, RSGIS_to_GDAL_Type(outDataType));
+            }
             
             GDALClose(dataset[0]);
             delete[] dataset;
@@ -268,8 +327,86 @@ namespace rsgis{ namespace cmds {
             throw RSGISCmdException(e.what());
         }
     }
+
+    void executeFilterArrays(const float* const* bands, unsigned int numBands, size_t width, size_t height, rsgis::cmds::RSGISFilterParameters *filterParams, double **output, unsigned int numThreads)
+    {
+        rsgis::filter::RSGISImageFilter *filter = NULL;
+        try
+        {
+            filter = createImageFilter(filterParams);
+            if(filter == NULL)
+            {
+                throw RSGISCmdException("The filter '" + filterParams->type + "' was not recognised.");
+            }
+            filter->runFilterArrays(bands, numBands, width, height, output, numThreads);
+            delete filter;
+        }
+        catch(RSGISCmdException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            delete filter;
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            delete filter;
+            throw RSGISCmdException(e.what());
+        }
+    }
                     
                     
+    void executeGradientFilter(std::string inputImage, std::string outputImage, std::string imageFormat, RSGISLibDataType outDataType, std::string gradOperator, bool outputXY, unsigned int numThreads)
+    {
+        try
+        {
+            rsgis::filter::RSGISGradientFilter::GradientOperator gradOp = rsgis::filter::RSGISGradientFilter::sobel;
+            if(gradOperator == "Sobel")
+            {
+                gradOp = rsgis::filter::RSGISGradientFilter::sobel;
+            }
+            else if(gradOperator == "Prewitt")
+            {
+                gradOp = rsgis::filter::RSGISGradientFilter::prewitt;
+            }
+            else
+            {
+                throw rsgis::RSGISImageException("The gradient operator must be 'Sobel' or 'Prewitt'.");
+            }
+            
+            rsgis::RSGISGDALInit::init();
+            GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            rsgis::filter::RSGISGradientFilter gradFilter = rsgis::filter::RSGISGradientFilter(gradOp, outputXY);
+            try
+            {
+                gradFilter.executeGradient(dataset, outputImage, imageFormat, RSGIS_to_GDAL_Type(outDataType), numThreads);
+            }
+            catch(rsgis::RSGISException &e)
+            {
+                GDALClose(dataset);
+                throw e;
+            }
+            
+            GDALClose(dataset);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+
     std::vector<rsgis::cmds::RSGISFilterParameters*> *createLeungMalikFilterBank() 
     {
         try
@@ -32,7 +32,7 @@
 #include "RSGISCmdException.h"
 
 // mark all exported classes/functions with DllExport to have
-// them exported by Visual Studio
+// them exported by Visual Studio
 #undef DllExport
 #ifdef _MSC_VER
     #ifdef rsgis_cmds_EXPORTS
@@ -57,10 +57,20 @@ namespace rsgis{ namespace cmds {
         float stddevX;
         float stddevY;
         float angle;
+        float percentile;
+        float histMin;
+        float histMax;
+        float histBinWidth;
     };
 
-    /** Function to apply filters to an image */
-    DllExport void executeFilter(std::string inputImage, std::vector <rsgis::cmds::RSGISFilterParameters*> *filterParameters, std::string outputImageBase, std::string imageFormat, std::string imageExt, RSGISLibDataType outDataType);
+    /** Function to apply filters to an image; if fused the input is read once for all the filters (using numThreads threads, with the separable Gaussian filters calculated together as 1D passes), otherwise once per filter */
+    DllExport void executeFilter(std::string inputImage, std::vector <rsgis::cmds::RSGISFilterParameters*> *filterParameters, std::string outputImageBase, std::string imageFormat, std::string imageExt, RSGISLibDataType outDataType, bool fused=true, unsigned int numThreads=1);
+
+    /** Function to apply a filter to numBands arrays of width x height pixels in memory (e.g., numpy arrays), writing one output array per band. The arrays are not copied. */
+    DllExport void executeFilterArrays(const float* const* bands, unsigned int numBands, size_t width, size_t height, rsgis::cmds::RSGISFilterParameters *filterParams, double **output, unsigned int numThreads=1);
+
+    /** Function to calculate the Sobel or Prewitt ('Sobel' or 'Prewitt') gradient magnitude and direction (and optionally the x and y gradients) of each image band in one pass */
+    DllExport void executeGradientFilter(std::string inputImage, std::string outputImage, std::string imageFormat, RSGISLibDataType outDataType, std::string gradOperator, bool outputXY=false, unsigned int numThreads=1);
 
     /** Function to set up LeuncMalik Filter Band */
     DllExport std::vector<rsgis::cmds::RSGISFilterParameters*> *createLeungMalikFilterBank();
@@ -22,8 +22,10 @@
 
 #include "RSGISCmdImageCalc.h"
 #include "RSGISCmdParent.h"
+#include "RSGISCmdResultCache.h"
 
 #include "common/RSGISImageException.h"
+#include "common/RSGISGDALInit.h"
 
 #include "img/RSGISBandMath.h"
 #include "img/RSGISImageMaths.h"
@@ -34,6 +36,7 @@
 #include "img/RSGISImageWindowStats.h"
 #include "img/RSGISImageStatistics.h"
 #include "img/RSGISCalcCovariance.h"
+#include "img/RSGISImageCovariance.h"
 #include "img/RSGISCalcEditImage.h"
 #include "img/RSGISCalcCorrelationCoefficient.h"
 #include "img/RSGISMeanVector.h"
@@ -48,10 +51,15 @@
 //#include "img/RSGISApplyFunction.h"
 #include "img/RSGISLinearSpectralUnmixing.h"
 #include "img/RSGISGenHistogram.h"
+#include "img/RSGISImageComparison.h"
+#include "img/RSGISImageHistogramEngine.h"
 #include "img/RSGISCalcImgValProb.h"
 #include "img/RSGISApplyGainOffset2Img.h"
 #include "img/RSGISImgSummaryStatsFromMultiResImgs.h"
 #include "img/RSGISCalcImageLocalMin.h"
+#include "img/RSGISTemporalSummary.h"
+#include "img/RSGISSpectralIndexBank.h"
+#include "img/RSGISCostDistance.h"
 
 #include "math/RSGISVectors.h"
 #include "math/RSGISMatrices.h"
@@ -73,7 +81,7 @@ namespace rsgis{ namespace cmds {
 
     void executeBandMaths(VariableStruct *variables, unsigned int numVars, std::string outputImage, std::string mathsExpression, std::string gdalFormat, RSGISLibDataType outDataType, bool useExpAsbandName, bool editOutputImg)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset **datasets = NULL;
         GDALDataset *outDataset = NULL;
         rsgis::img::RSGISBandMath *bandmaths = NULL;
@@ -83,6 +91,29 @@ namespace rsgis{ namespace cmds {
 
         try
         {
+            // Only new output images are cached, where the preview factor of the
+            // execution context also changes the output.
+            RSGISCmdResultCache resultCache("executeBandMaths");
+            bool useResultCache = resultCache.isEnabled() && (!editOutputImg);
+            if(useResultCache)
+            {
+                resultCache.addParam("expression", mathsExpression);
+                resultCache.addParam("format", gdalFormat);
+                resultCache.addParam("datatype", outDataType);
+                resultCache.addParam("exp_band_name", useExpAsbandName);
+                resultCache.addParam("preview_factor", rsgis::RSGISExecutionContextUtils::getDefaultContext().previewFactor);
+                for(unsigned int i = 0; i < numVars; ++i)
+                {
+                    resultCache.addParam("variable", variables[i].name + ":" + std::to_string(variables[i].bandNum));
+                    resultCache.addInputFile(variables[i].image);
+                }
+                if(resultCache.restoreOutputs(std::vector<std::string>(1, outputImage)))
+                {
+                    delete muParser;
+                    return;
+                }
+            }
+
             std::string *outBandName = NULL;
             if(useExpAsbandName)
             {
@@ -216,6 +247,11 @@ namespace rsgis{ namespace cmds {
             {
                 GDALClose(outDataset);
             }
+
+            if(useResultCache)
+            {
+                resultCache.storeOutputs(std::vector<std::string>(1, outputImage));
+            }
         }
         catch(rsgis::RSGISImageException &e)
         {
@@ -236,9 +272,57 @@ namespace rsgis{ namespace cmds {
         }
     }
 
+    void executeBandMathsArrays(std::vector<std::string> varNames, const float* const* bands, size_t nPxls, std::string mathsExpression, double *output, unsigned int numThreads)
+    {
+        unsigned int numVars = varNames.size();
+        rsgis::img::VariableBands **processVaribles = new rsgis::img::VariableBands*[numVars];
+        for(unsigned int i = 0; i < numVars; ++i)
+        {
+            processVaribles[i] = new rsgis::img::VariableBands();
+            processVaribles[i]->name = varNames.at(i);
+            processVaribles[i]->band = i;
+        }
+        mu::Parser *muParser = new mu::Parser();
+        rsgis::img::RSGISBandMath *bandmaths = NULL;
+        
+        try
+        {
+            bandmaths = new rsgis::img::RSGISBandMath(1, processVaribles, numVars, muParser);
+            muParser->SetExpr(mathsExpression.c_str());
+            
+            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(bandmaths, "", true);
+            calcImage.setNumThreads(numThreads);
+            calcImage.calcImageArrays(bands, numVars, nPxls, &output);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch (mu::ParserError &e)
+        {
+            std::string message = std::string("ERROR: ") + std::string(e.GetMsg()) + std::string(":\t \'") + std::string(e.GetExpr()) + std::string("\'");
+            throw RSGISCmdException(message);
+        }
+        catch (std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        
+        if(bandmaths != NULL)
+        {
+            delete bandmaths;
+        }
+        delete muParser;
+        for(unsigned int i = 0; i < numVars; ++i)
+        {
+            delete processVaribles[i];
+        }
+        delete[] processVaribles;
+    }
+
     void executeImageMaths(std::string inputImage, std::string outputImage, std::string mathsExpression, std::string imageFormat, RSGISLibDataType outDataType, bool useExpAsbandName, bool editOutputImg)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset **datasets = NULL;
         GDALDataset *outDataset = NULL;
         rsgis::img::RSGISImageMaths *imageMaths = NULL;
@@ -345,7 +429,7 @@ namespace rsgis{ namespace cmds {
                 
     void executeImageBandMaths(std::string inputImage, std::string outputImage, std::string mathsExpression, std::string imageFormat, RSGISLibDataType outDataType, bool useExpAsbandName, bool editOutputImg)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset **datasets = NULL;
         GDALDataset *outDataset = NULL;
         rsgis::img::RSGISImageBandMaths *imageMaths = NULL;
@@ -457,7 +541,7 @@ namespace rsgis{ namespace cmds {
         }
     }
 
-    void executeKMeansClustering(std::string inputImage, std::string outputMatrixFile, unsigned int numClusters, unsigned int maxNumIterations, unsigned int subSample, bool ignoreZeros, float degreeOfChange, RSGISInitClustererMethods initClusterMethod)
+    void executeKMeansClustering(std::string inputImage, std::string outputMatrixFile, unsigned int numClusters, unsigned int maxNumIterations, unsigned int subSample, bool ignoreZeros, float degreeOfChange, RSGISInitClustererMethods initClusterMethod, unsigned int numThreads)
     {
         
         std::cout << "inputImage = " << inputImage << std::endl;
@@ -473,7 +557,7 @@ namespace rsgis{ namespace cmds {
         
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpenShared(inputImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -510,7 +594,7 @@ namespace rsgis{ namespace cmds {
             }
 
             rsgis::img::RSGISImageClustering imgClustering;
-            imgClustering.findKMeansCentres(dataset, outputMatrixFile, numClusters, maxNumIterations, subSample, ignoreZeros, degreeOfChange, initMethod);
+            imgClustering.findKMeansCentres(dataset, outputMatrixFile, numClusters, maxNumIterations, subSample, ignoreZeros, degreeOfChange, initMethod, numThreads);
 
             GDALClose(dataset);
         }
@@ -524,11 +608,11 @@ namespace rsgis{ namespace cmds {
         }
     }
 
-    void executeISODataClustering(std::string inputImage, std::string outputMatrixFile, unsigned int numClusters, unsigned int maxNumIterations, unsigned int subSample, bool ignoreZeros, float degreeOfChange, RSGISInitClustererMethods initClusterMethod, float minDistBetweenClusters, unsigned int minNumFeatures, float maxStdDev, unsigned int minNumClusters, unsigned int startIteration, unsigned int endIteration)
+    void executeISODataClustering(std::string inputImage, std::string outputMatrixFile, unsigned int numClusters, unsigned int maxNumIterations, unsigned int subSample, bool ignoreZeros, float degreeOfChange, RSGISInitClustererMethods initClusterMethod, float minDistBetweenClusters, unsigned int minNumFeatures, float maxStdDev, unsigned int minNumClusters, unsigned int startIteration, unsigned int endIteration, unsigned int numThreads)
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpenShared(inputImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -564,7 +648,7 @@ namespace rsgis{ namespace cmds {
             }
 
             rsgis::img::RSGISImageClustering imgClustering;
-            imgClustering.findISODataCentres(dataset, outputMatrixFile, numClusters, maxNumIterations, subSample, ignoreZeros, degreeOfChange, initMethod, minDistBetweenClusters, minNumFeatures, maxStdDev, minNumClusters, startIteration, endIteration);
+            imgClustering.findISODataCentres(dataset, outputMatrixFile, numClusters, maxNumIterations, subSample, ignoreZeros, degreeOfChange, initMethod, minDistBetweenClusters, minNumFeatures, maxStdDev, minNumClusters, startIteration, endIteration, numThreads);
 
             GDALClose(dataset);
         }
@@ -582,7 +666,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[1];
 
             datasets[0] = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
@@ -620,7 +704,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[1];
 
             datasets[0] = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
@@ -715,7 +799,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *imgDataset = (GDALDataset *) GDALOpenShared(inputImage.c_str(), GA_ReadOnly);
             if(imgDataset == NULL)
             {
@@ -801,13 +885,52 @@ namespace rsgis{ namespace cmds {
                 bandNames[nameIdx++] = "StdDev";
             }
 
-            rsgis::img::RSGISImagePixelSummaries *pxlSummary = new rsgis::img::RSGISImagePixelSummaries(numOutBands, mathSummaryStats, noDataValue, useNoDataValue);
+            std::vector<rsgis::img::RSGISTemporalStatSpec> stats;
+            rsgis::img::RSGISTemporalStatSpec statSpec;
+            statSpec.percentile = 0.0;
+            std::vector<rsgis::img::RSGISTemporalStat> statTypes;
+            if(mathSummaryStats->calcMin)
+            {
+                statTypes.push_back(rsgis::img::rsgis_tstat_min);
+            }
+            if(mathSummaryStats->calcMax)
+            {
+                statTypes.push_back(rsgis::img::rsgis_tstat_max);
+            }
+            if(mathSummaryStats->calcMean)
+            {
+                statTypes.push_back(rsgis::img::rsgis_tstat_mean);
+            }
+            if(mathSummaryStats->calcMedian)
+            {
+                statTypes.push_back(rsgis::img::rsgis_tstat_median);
+            }
+            if(mathSummaryStats->calcMode)
+            {
+                statTypes.push_back(rsgis::img::rsgis_tstat_mode);
+            }
+            if(mathSummaryStats->calcSum)
+            {
+                statTypes.push_back(rsgis::img::rsgis_tstat_sum);
+            }
+            if(mathSummaryStats->calcStdDev)
+            {
+                statTypes.push_back(rsgis::img::rsgis_tstat_stddev);
+            }
+            for(std::vector<rsgis::img::RSGISTemporalStat>::iterator iterStat = statTypes.begin(); iterStat != statTypes.end(); ++iterStat)
+            {
+                statSpec.stat = *iterStat;
+                stats.push_back(statSpec);
+            }
+            
+            rsgis::img::RSGISTemporalSummary *pxlSummary = new rsgis::img::RSGISTemporalSummary(1, imgDataset->GetRasterCount(), 1, 1, stats, noDataValue, useNoDataValue);
 
             rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(pxlSummary, "", true);
             calcImage.calcImage(&imgDataset, 1, outputImage, true, bandNames, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
 
             delete[] bandNames;
             delete pxlSummary;
+            delete mathSummaryStats;
             GDALClose(imgDataset);
         }
         catch(rsgis::RSGISException &e)
@@ -824,7 +947,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *imgDataset = (GDALDataset *) GDALOpenShared(inputImage.c_str(), GA_ReadOnly);
             if(imgDataset == NULL)
             {
@@ -868,16 +991,12 @@ namespace rsgis{ namespace cmds {
 
     double** executeCorrelation(std::string inputImageA, std::string inputImageB, std::string outputMatrixFile, unsigned int *nrows, unsigned int *ncols) 
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset **datasetsA = NULL;
         GDALDataset **datasetsB = NULL;
 
         rsgis::math::RSGISMatrices matrixUtils;
 
-        rsgis::img::RSGISCalcImageSingle *calcImgSingle = NULL;
-        rsgis::img::RSGISCalcCC *calcCC = NULL;
-        rsgis::img::RSGISCalcImageMatrix *calcImgMatrix = NULL;
-
         rsgis::math::Matrix *correlationMatrix = NULL;
 
         try
@@ -901,10 +1020,36 @@ namespace rsgis{ namespace cmds {
                 throw rsgis::RSGISImageException(message.c_str());
             }
 
-            calcCC = new rsgis::img::RSGISCalcCC(1);
-            calcImgSingle = new rsgis::img::RSGISCalcImageSingle(calcCC);
-            calcImgMatrix = new rsgis::img::RSGISCalcImageMatrix(calcImgSingle);
-            correlationMatrix = calcImgMatrix->calcImageMatrix(datasetsA, datasetsB, 1);
+            unsigned int numBandsA = datasetsA[0]->GetRasterCount();
+            unsigned int numBandsB = datasetsB[0]->GetRasterCount();
+            if(numBandsA != numBandsB)
+            {
+                throw rsgis::RSGISImageException("The two image sets do not have the same number of bands.");
+            }
+            
+            // All the band combinations are correlated within a single pass over the two images.
+            std::vector<unsigned int> bandsA;
+            std::vector<unsigned int> bandsB;
+            for(unsigned int i = 0; i < numBandsA; ++i)
+            {
+                bandsA.push_back(i);
+                bandsB.push_back(numBandsA + i);
+            }
+            GDALDataset *datasets[2] = {datasetsA[0], datasetsB[0]};
+            rsgis::img::RSGISImageComparison compImgs = rsgis::img::RSGISImageComparison(std::vector<std::pair<unsigned int, unsigned int> >(), false);
+            compImgs.setCrossCorrelation(bandsA, bandsB);
+            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&compImgs, "", true);
+            calcImage.calcImage(datasets, 2);
+            
+            correlationMatrix = matrixUtils.createMatrix(numBandsB, numBandsA);
+            int idx = 0;
+            for(unsigned int i = 0; i < numBandsA; ++i)
+            {
+                for(unsigned int j = 0; j < numBandsB; ++j)
+                {
+                    correlationMatrix->matrix[idx++] = compImgs.getCrossCorrelation(i, j);
+                }
+            }
             // Save matrix to file (if provided)
             if(outputMatrixFile != "")
             {
@@ -928,9 +1073,7 @@ namespace rsgis{ namespace cmds {
                 }
             }
             
-            delete calcCC;
-            delete calcImgMatrix;
-            delete calcImgSingle;
+            matrixUtils.freeMatrix(correlationMatrix);
 
             if(datasetsA[0] != NULL)
             {
@@ -956,67 +1099,90 @@ namespace rsgis{ namespace cmds {
         }
     }
 
-    void executeCovariance(std::string inputImageA, std::string inputImageB, std::string inputMatrixA, std::string inputMatrixB, bool shouldCalcMean, std::string outputMatrix)
+    void executeCovariance(std::string inputImageA, std::string inputImageB, std::string inputMatrixA, std::string inputMatrixB, bool shouldCalcMean, std::string outputMatrix, unsigned int numThreads)
     {
-        GDALAllRegister();
-        GDALDataset **datasetsA = NULL;
-        GDALDataset **datasetsB = NULL;
+        rsgis::RSGISGDALInit::init();
+        GDALDataset **datasets = NULL;
+        int numDS = 0;
 
         rsgis::math::RSGISMatrices matrixUtils;
 
-        rsgis::img::RSGISCalcImageSingle *calcImgSingle = NULL;
-        rsgis::img::RSGISCalcCovariance *calcCovar = NULL;
-        rsgis::img::RSGISCalcImageMatrix *calcImgMatrix = NULL;
-
-        rsgis::img::RSGISCalcImageSingle *calcImgSingleMean = NULL;
-        rsgis::img::RSGISCalcMeanVectorIndividual *calcMean = NULL;
-        rsgis::img::RSGISCalcImageMatrix *calcImgMatrixMean = NULL;
-
         rsgis::math::Matrix *meanAMatrix = NULL;
         rsgis::math::Matrix *meanBMatrix = NULL;
         rsgis::math::Matrix *covarianceMatrix = NULL;
 
         try
         {
-            datasetsA = new GDALDataset*[1];
+            datasets = new GDALDataset*[2];
+            datasets[0] = NULL;
+            datasets[1] = NULL;
             std::cout << inputImageA << std::endl;
-            datasetsA[0] = (GDALDataset *) GDALOpenShared(inputImageA.c_str(), GA_ReadOnly);
-            if(datasetsA[0] == NULL)
+            datasets[0] = (GDALDataset *) GDALOpenShared(inputImageA.c_str(), GA_ReadOnly);
+            if(datasets[0] == NULL)
             {
                 std::string message = std::string("Could not open image ") + inputImageA;
                 throw rsgis::RSGISImageException(message.c_str());
             }
+            numDS = 1;
 
-            datasetsB = new GDALDataset*[1];
-            std::cout << inputImageB << std::endl;
-            datasetsB[0] = (GDALDataset *) GDALOpenShared(inputImageB.c_str(), GA_ReadOnly);
-            if(datasetsB[0] == NULL)
+            // The covariance of an image with itself only needs the bands of the image once.
+            if(inputImageB != inputImageA)
             {
-                std::string message = std::string("Could not open image ") + inputImageB;
-                throw rsgis::RSGISImageException(message.c_str());
+                std::cout << inputImageB << std::endl;
+                datasets[1] = (GDALDataset *) GDALOpenShared(inputImageB.c_str(), GA_ReadOnly);
+                if(datasets[1] == NULL)
+                {
+                    std::string message = std::string("Could not open image ") + inputImageB;
+                    throw rsgis::RSGISImageException(message.c_str());
+                }
+                numDS = 2;
+            }
+
+            int numBandsA = datasets[0]->GetRasterCount();
+            int numBandsB = (numDS == 2)?datasets[1]->GetRasterCount():numBandsA;
+            if(numBandsA != numBandsB)
+            {
+                throw rsgis::RSGISImageException("The two image sets do not have the same number of bands.");
             }
+            unsigned int bOffset = (numDS == 2)?numBandsA:0;
 
+            // A single pass over the images for the covariance of all the bands.
+            rsgis::img::RSGISCalcImageCovariance calcCovar = rsgis::img::RSGISCalcImageCovariance(numThreads);
+            rsgis::img::RSGISCovarianceAccumulator covarAcc = calcCovar.calcCovariance(datasets, numDS, false, 0.0);
 
+            std::vector<double> meansA;
+            std::vector<double> meansB;
+            std::vector<double> accMeans = covarAcc.getMeans();
             if(shouldCalcMean)
             {
-                std::cout << "Mean vectors will be calculated\n";
-                calcMean = new rsgis::img::RSGISCalcMeanVectorIndividual(1);
-                calcImgSingleMean = new rsgis::img::RSGISCalcImageSingle(calcMean);
-                calcImgMatrixMean = new rsgis::img::RSGISCalcImageMatrix(calcImgSingleMean);
-                meanAMatrix = calcImgMatrixMean->calcImageVector(datasetsA, 1);
-                meanBMatrix = calcImgMatrixMean->calcImageVector(datasetsB, 1);
-                std::cout << "Mean Vectors have been calculated\n";
+                std::cout << "Mean vectors have been calculated\n";
+                meansA.assign(accMeans.begin(), accMeans.begin() + numBandsA);
+                meansB.assign(accMeans.begin() + bOffset, accMeans.begin() + bOffset + numBandsB);
             }
             else
             {
                 meanAMatrix = matrixUtils.readMatrixFromTxt(inputMatrixA);
                 meanBMatrix = matrixUtils.readMatrixFromTxt(inputMatrixB);
+                if(((meanAMatrix->n * meanAMatrix->m) < numBandsA) || ((meanBMatrix->n * meanBMatrix->m) < numBandsB))
+                {
+                    throw rsgis::RSGISImageException("The mean vectors do not have a value for each image band.");
+                }
+                meansA.assign(meanAMatrix->matrix, meanAMatrix->matrix + numBandsA);
+                meansB.assign(meanBMatrix->matrix, meanBMatrix->matrix + numBandsB);
             }
 
-            calcCovar = new rsgis::img::RSGISCalcCovariance(1, meanAMatrix, meanBMatrix);
-            calcImgSingle = new rsgis::img::RSGISCalcImageSingle(calcCovar);
-            calcImgMatrix = new rsgis::img::RSGISCalcImageMatrix(calcImgSingle);
-            covarianceMatrix = calcImgMatrix->calcImageMatrix(datasetsA, datasetsB, 1);
+            covarianceMatrix = new rsgis::math::Matrix();
+            covarianceMatrix->m = numBandsA;
+            covarianceMatrix->n = numBandsB;
+            covarianceMatrix->matrix = new double[(covarianceMatrix->m * covarianceMatrix->n)];
+            int counter = 0;
+            for(int i = 0; i < numBandsA; i++)
+            {
+                for(int j = 0; j < numBandsB; j++)
+                {
+                    covarianceMatrix->matrix[counter++] = covarAcc.getCovarianceAbout(i, bOffset+j, meansA[i], meansB[j]);
+                }
+            }
             matrixUtils.saveMatrix2txt(covarianceMatrix, outputMatrix);
         }
         catch(rsgis::RSGISException &e) {
@@ -1025,33 +1191,6 @@ namespace rsgis{ namespace cmds {
         catch(rsgis::math::RSGISMatricesException &e) {
             throw RSGISCmdException(e.what());
         }
-        
-
-        if(calcImgSingle != NULL)
-        {
-            delete calcImgSingle;
-        }
-        if(calcCovar != NULL)
-        {
-            delete calcCovar;
-        }
-        if(calcImgMatrix != NULL)
-        {
-            delete calcImgMatrix;
-        }
-
-        if(calcImgSingleMean != NULL)
-        {
-            delete calcImgSingleMean;
-        }
-        if(calcMean != NULL)
-        {
-            delete calcMean;
-        }
-        if(calcImgMatrixMean != NULL)
-        {
-            delete calcImgMatrixMean;
-        }
 
         if(meanAMatrix != NULL)
         {
@@ -1066,21 +1205,20 @@ namespace rsgis{ namespace cmds {
             matrixUtils.freeMatrix(covarianceMatrix);
         }
 
-        if(datasetsA[0] != NULL) {
-            GDALClose(datasetsA[0]);
+        if(datasets[0] != NULL) {
+            GDALClose(datasets[0]);
         }
-        if(datasetsB[0] != NULL) {
-            GDALClose(datasetsB[0]);
+        if(datasets[1] != NULL) {
+            GDALClose(datasets[1]);
         }
 
-        delete [] datasetsA;
-        delete [] datasetsB;
+        delete [] datasets;
 
     }
 
     void executeMeanVector(std::string inputImage, std::string outputMatrix)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset **datasets = NULL;
 
         rsgis::img::RSGISCalcImageSingle *calcImgSingle = NULL;
@@ -1138,9 +1276,9 @@ namespace rsgis{ namespace cmds {
 
     }
 
-    void executePCA(std::string inputImage, std::string eigenvectors, std::string outputImage, int numComponents, std::string gdalFormat, RSGISLibDataType outDataType)
+    void executePCA(std::string inputImage, std::string eigenvectors, std::string outputImage, int numComponents, std::string gdalFormat, RSGISLibDataType outDataType, unsigned int numThreads)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset **datasets = NULL;
 
         rsgis::math::RSGISMatrices matrixUtils;
@@ -1167,9 +1305,14 @@ namespace rsgis{ namespace cmds {
             {
                 throw RSGISException("Number of component must be smaller or equal than the number image bands in the input image.");
             }
+            if(eigenvectorsMatrix->m != datasets[0]->GetRasterCount())
+            {
+                throw RSGISException("The length of the eigenvectors must be the same as the number of image bands in the input image.");
+            }
 
             applyPCA = new rsgis::img::RSGISApplyEigenvectors(numComponents, eigenvectorsMatrix);
             calcImage = new rsgis::img::RSGISCalcImage(applyPCA, "", true);
+            calcImage->setNumThreads(numThreads);
             calcImage->calcImage(datasets, 1, outputImage, false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
 
             if(datasets[0] != NULL)
@@ -1200,9 +1343,100 @@ namespace rsgis{ namespace cmds {
         delete [] datasets;
     }
 
+    std::vector<double> executeCalcPCAEigenVectors(std::string inputImage, std::string outputMatrix, bool useNoDataVal, float noDataVal, unsigned int numThreads)
+    {
+        rsgis::RSGISGDALInit::init();
+        GDALDataset *dataset = NULL;
+
+        rsgis::math::RSGISMatrices matrixUtils;
+        rsgis::math::Matrix *covarianceMatrix = NULL;
+        rsgis::math::Matrix *eigenvalues = NULL;
+        rsgis::math::Matrix *eigenvectors = NULL;
+        rsgis::math::Matrix *components = NULL;
+        std::vector<double> varExplained;
+
+        try
+        {
+            dataset = (GDALDataset *) GDALOpenShared(inputImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            int numBands = dataset->GetRasterCount();
+
+            rsgis::img::RSGISCalcImageCovariance calcCovar = rsgis::img::RSGISCalcImageCovariance(numThreads);
+            rsgis::img::RSGISCovarianceAccumulator covarAcc = calcCovar.calcCovariance(&dataset, 1, useNoDataVal, noDataVal);
+            if(covarAcc.getN() < 2)
+            {
+                throw rsgis::RSGISImageException("The image does not have enough valid pixels to calculate the covariance.");
+            }
+            std::cout << covarAcc.getN() << " pixels were used to calculate the covariance.\n";
+
+            std::vector<double> covariance = covarAcc.getCovariance();
+            covarianceMatrix = matrixUtils.createMatrix(numBands, numBands);
+            std::copy(covariance.begin(), covariance.end(), covarianceMatrix->matrix);
+
+            eigenvalues = matrixUtils.createMatrix(1, numBands);
+            eigenvectors = matrixUtils.createMatrix(numBands, numBands);
+            matrixUtils.calcEigenVectorValue(covarianceMatrix, eigenvalues, eigenvectors);
+
+            // One component (eigenvector) per row, as used by executePCA.
+            components = matrixUtils.createMatrix(numBands, numBands);
+            double sumEigenvalues = 0.0;
+            for(int i = 0; i < numBands; ++i)
+            {
+                for(int j = 0; j < numBands; ++j)
+                {
+                    components->matrix[(i*numBands)+j] = eigenvectors->matrix[(j*numBands)+i];
+                }
+                sumEigenvalues += eigenvalues->matrix[i];
+            }
+            matrixUtils.saveMatrix2txt(components, outputMatrix);
+
+            std::cout << "Prop. of variance explained:\n";
+            for(int i = 0; i < numBands; ++i)
+            {
+                varExplained.push_back((sumEigenvalues > 0)?(eigenvalues->matrix[i]/sumEigenvalues):0.0);
+                std::cout << "\t PCA Component " << i+1 << " = " << varExplained.back() << std::endl;
+            }
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(rsgis::math::RSGISMatricesException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+
+        if(covarianceMatrix != NULL)
+        {
+            matrixUtils.freeMatrix(covarianceMatrix);
+        }
+        if(eigenvalues != NULL)
+        {
+            matrixUtils.freeMatrix(eigenvalues);
+        }
+        if(eigenvectors != NULL)
+        {
+            matrixUtils.freeMatrix(eigenvectors);
+        }
+        if(components != NULL)
+        {
+            matrixUtils.freeMatrix(components);
+        }
+        if(dataset != NULL)
+        {
+            GDALClose(dataset);
+        }
+
+        return varExplained;
+    }
+
     void executeStandardise(std::string meanvectorStr, std::string inputImage, std::string outputImage)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset **datasets = NULL;
 
         rsgis::math::RSGISMatrices matrixUtils;
@@ -1244,7 +1478,7 @@ namespace rsgis{ namespace cmds {
 
     void executeUnitArea(std::string inputImage, std::string outputImage, std::string inMatrixfile)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset **datasets = NULL;
         rsgis::img::RSGISCalcImageValue *calcImageValue = NULL;
         rsgis::img::RSGISCalcImage *calcImage = NULL;
@@ -1305,7 +1539,7 @@ namespace rsgis{ namespace cmds {
 
     void executeCountValsInCols(std::string inputImage, float upper, float lower, std::string outputImage)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset **datasets = NULL;
         rsgis::img::RSGISCalcImage *calcImage = NULL;
         rsgis::img::RSGISCountValsAboveThresInCol *calcImageValue = NULL;
@@ -1338,19 +1572,15 @@ namespace rsgis{ namespace cmds {
 
     double executeCalculateRMSE(std::string inputImageA, int inputBandA, std::string inputImageB, int inputBandB)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset **datasetsA = NULL;
         GDALDataset **datasetsB = NULL;
 
-        rsgis::img::RSGISCalcImageSingle *calcImgSingle = NULL;
-        rsgis::img::RSGISCalcRMSE *calculateRSME = NULL;
-        
         double rmse = 0.0;
         std::cout << "Calculating RMSE between: " << inputImageA << " (Band " << inputBandA + 1 << ") and " << inputImageB << " (Band " << inputBandB + 1 << ")" << std::endl;
 
         try
         {
-            double *outRMSE = new double[1];
             datasetsA = new GDALDataset*[1];
             std::cout << inputImageA << std::endl;
             datasetsA[0] = (GDALDataset *) GDALOpenShared(inputImageA.c_str(), GA_ReadOnly);
@@ -1371,17 +1601,22 @@ namespace rsgis{ namespace cmds {
                 throw rsgis::RSGISImageException(message.c_str());
             }
 
-            calculateRSME = new rsgis::img::RSGISCalcRMSE(1);
-            calcImgSingle = new rsgis::img::RSGISCalcImageSingle(calculateRSME);
-            calcImgSingle->calcImage(datasetsA, datasetsB, 1, outRMSE, inputBandA, inputBandB);
+            int numBandsA = datasetsA[0]->GetRasterCount();
+            if((inputBandA < 0) || (inputBandA >= numBandsA) || (inputBandB < 0) || (inputBandB >= datasetsB[0]->GetRasterCount()))
+            {
+                throw rsgis::RSGISImageException("The band specified is not within the image.");
+            }
             
-            rmse = outRMSE[0];
+            std::vector<std::pair<unsigned int, unsigned int> > bandPairs;
+            bandPairs.push_back(std::pair<unsigned int, unsigned int>(inputBandA, numBandsA + inputBandB));
+            GDALDataset *datasets[2] = {datasetsA[0], datasetsB[0]};
+            rsgis::img::RSGISImageComparison compImgs = rsgis::img::RSGISImageComparison(bandPairs, false);
+            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&compImgs, "", true);
+            calcImage.calcImage(datasets, 2);
             
-            std::cout << "RMSE = " << outRMSE[0] << std::endl;
-
-            delete calculateRSME;
-            delete calcImgSingle;
-            delete[] outRMSE;
+            rmse = compImgs.getRMSE(0);
+            
+            std::cout << "RMSE = " << rmse << std::endl;
 
             if(datasetsA != NULL)
             {
@@ -1406,7 +1641,7 @@ namespace rsgis{ namespace cmds {
 
     void executeImageBandStats(std::string inputImage, std::string outputFile, bool ignoreZeros)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset **datasets = NULL;
 
         rsgis::img::RSGISImageStatistics calcImgStats;
@@ -1458,7 +1693,7 @@ namespace rsgis{ namespace cmds {
 
     void executeImageStats(std::string inputImage, std::string outputFile, bool ignoreZeros)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset **datasets = NULL;
 
         rsgis::img::RSGISImageStatistics calcImgStats;
@@ -1501,9 +1736,9 @@ namespace rsgis{ namespace cmds {
 
     }
 
-    void executeExhconLinearSpecUnmix(std::string inputImage, std::string imageFormat, RSGISLibDataType outDataType, float lsumGain, float lsumOffset, std::string outputFile, std::string endmembersFile, float stepResolution)
+    void executeExhconLinearSpecUnmix(std::string inputImage, std::string imageFormat, RSGISLibDataType outDataType, float lsumGain, float lsumOffset, std::string outputFile, std::string endmembersFile, float stepResolution, unsigned int numThreads)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset **datasets = NULL;
 
         try
@@ -1516,7 +1751,7 @@ namespace rsgis{ namespace cmds {
                 throw rsgis::RSGISImageException(message.c_str());
             }
 
-            rsgis::img::RSGISCalcLinearSpectralUnmixing calcSpecUnmix(imageFormat, RSGIS_to_GDAL_Type(outDataType), lsumGain, lsumOffset);
+            rsgis::img::RSGISCalcLinearSpectralUnmixing calcSpecUnmix(imageFormat, RSGIS_to_GDAL_Type(outDataType), lsumGain, lsumOffset, numThreads);
             calcSpecUnmix.performExhaustiveConstrainedSpectralUnmixing(datasets, 1, outputFile, endmembersFile, stepResolution);
 
             GDALClose(datasets[0]);
@@ -1533,7 +1768,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[1];
             datasets[0] = (GDALDataset *) GDALOpenShared(inputImage.c_str(), GA_ReadOnly);
             if(datasets[0] == NULL)
@@ -1560,7 +1795,7 @@ namespace rsgis{ namespace cmds {
     void executeHistogram(std::string inputImage, std::string imageMask, std::string outputFile, unsigned int imgBand, float imgValue, double binWidth, bool calcInMinMax, double inMin, double inMax)
     {
         try {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[2];
 
             datasets[0] = (GDALDataset *) GDALOpenShared(imageMask.c_str(), GA_ReadOnly);
@@ -1620,12 +1855,17 @@ namespace rsgis{ namespace cmds {
         }
     }
                 
-    unsigned int* executeGetHistogram(std::string inputImage, unsigned int imgBand, double binWidth, unsigned int *nBins, bool calcInMinMax, double *inMin, double *inMax)
+    unsigned int* executeGetHistogram(std::string inputImage, unsigned int imgBand, double binWidth, unsigned int *nBins, bool calcInMinMax, double *inMin, double *inMax, unsigned int numThreads)
     {
         unsigned int *bins = NULL;
         try
         {
-            GDALAllRegister();
+            if(!(binWidth > 0))
+            {
+                throw RSGISException("The bin width must be greater than zero.");
+            }
+            
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
@@ -1633,38 +1873,62 @@ namespace rsgis{ namespace cmds {
                 std::string message = std::string("Could not open image ") + inputImage;
                 throw rsgis::RSGISImageException(message.c_str());
             }
+            if((imgBand == 0) || (imgBand > (unsigned int)dataset->GetRasterCount()))
+            {
+                GDALClose(dataset);
+                throw RSGISException("The image band specified is not within the image.");
+            }
             
-            if(calcInMinMax)
+            rsgis::img::RSGISImageHistogramEngine histEngine = rsgis::img::RSGISImageHistogramEngine(numThreads);
+            std::vector<unsigned int> bands = std::vector<unsigned int>(1, imgBand);
+            if(rsgis::img::RSGISImageHistogramEngine::hasExactIntBins(dataset->GetRasterBand(imgBand)->GetRasterDataType()))
             {
-                unsigned int numImgBands = dataset->GetRasterCount();
-                rsgis::img::ImageStats **imgStats = new rsgis::img::ImageStats*[numImgBands];
-                for(unsigned int i = 0; i < numImgBands; ++i)
+                // A single pass for a bin per value, from which the min and max and the output bins are found.
+                std::vector<rsgis::img::RSGISBandHistogram> valHists = histEngine.calcExactHistograms(dataset, bands, false, 0.0);
+                if(calcInMinMax)
                 {
-                    imgStats[i] = new rsgis::img::ImageStats();
-                    imgStats[i]->max = 0;
-                    imgStats[i]->min = 0;
-                    imgStats[i]->mean = 0;
-                    imgStats[i]->stddev = 0;
-                    imgStats[i]->sum = 0;
+                    *inMin = valHists[0].minVal;
+                    *inMax = valHists[0].maxVal;
                 }
-                rsgis::img::RSGISImageStatistics calcStats;
-                calcStats.calcImageStatistics(&dataset, 1, imgStats, numImgBands, false, false);
                 
-                *inMin = imgStats[imgBand-1]->min;
-                *inMax = imgStats[imgBand-1]->max;
+                *inMin = floor((*inMin));
+                *inMax = ceil((*inMax));
                 
-                for(unsigned int i = 0; i < numImgBands; ++i)
+                *nBins = ceil((((*inMax) - (*inMin))/binWidth)+0.5);
+                bins = new unsigned int[(*nBins)];
+                for(unsigned int i = 0; i < (*nBins); ++i)
                 {
-                    delete imgStats[i];
+                    bins[i] = 0;
+                }
+                double binIdx = 0.0;
+                for(size_t i = 0; i < valHists[0].bins.size(); ++i)
+                {
+                    if(valHists[0].bins[i] > 0)
+                    {
+                        binIdx = floor(((valHists[0].binMin + i) - (*inMin))/binWidth);
+                        if((binIdx >= 0) && (binIdx < (*nBins)))
+                        {
+                            bins[(unsigned int)binIdx] += valHists[0].bins[i];
+                        }
+                    }
                 }
-                delete[] imgStats;
             }
-            
-            *inMin = floor((*inMin));
-            *inMax = ceil((*inMax));
-            
-            rsgis::img::RSGISGenHistogram genHistogram;
-            bins = genHistogram.genGetHistogram(dataset, imgBand-1, *inMin, *inMax, binWidth, nBins);
+            else
+            {
+                if(calcInMinMax)
+                {
+                    // A histogram with no bins just finds the range of the values.
+                    std::vector<rsgis::img::RSGISBandHistogram> rangeHists = histEngine.calcHistograms(dataset, bands, 0.0, 1.0, 0, false, 0.0);
+                    *inMin = rangeHists[0].minVal;
+                    *inMax = rangeHists[0].maxVal;
+                }
+                
+                *inMin = floor((*inMin));
+                *inMax = ceil((*inMax));
+                
+                rsgis::img::RSGISGenHistogram genHistogram;
+                bins = genHistogram.genGetHistogram(dataset, imgBand-1, *inMin, *inMax, binWidth, nBins, numThreads);
+            }
             
             GDALClose(dataset);
         }
@@ -1676,7 +1940,7 @@ namespace rsgis{ namespace cmds {
         return bins;
     }
 
-    std::vector<double> executeBandPercentile(std::string inputImage, float percentile, float noDataValue, bool noDataValueSpecified)
+    std::vector<double> executeBandPercentile(std::string inputImage, float percentile, float noDataValue, bool noDataValueSpecified, bool approxFloatBands, unsigned int numThreads)
     {
         std::vector<double> outVals;
         try
@@ -1686,30 +1950,71 @@ namespace rsgis{ namespace cmds {
                 throw RSGISException("Percentile value must be between 0 - 1.");
             }
             
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *imageDataset = (GDALDataset *) GDALOpenShared(inputImage.c_str(), GA_ReadOnly);
             if(imageDataset == NULL)
             {
                 std::string message = std::string("Could not open image ") + inputImage;
                 throw rsgis::RSGISImageException(message.c_str());
             }
-
-            rsgis::math::RSGISMatrices matrixUtils;
-            rsgis::img::RSGISImagePercentiles calcPercentiles;
-
-            rsgis::math::Matrix *bandPercentiles = calcPercentiles.getPercentilesForAllBands(imageDataset, percentile, noDataValue, noDataValueSpecified);
             
-            for(unsigned int i = 0; i < bandPercentiles->n; ++i)
+            unsigned int numImgBands = imageDataset->GetRasterCount();
+            std::vector<unsigned int> intBands;
+            std::vector<unsigned int> otherBands;
+            for(unsigned int n = 1; n <= numImgBands; ++n)
             {
-                outVals.push_back(bandPercentiles->matrix[i]);
+                if(rsgis::img::RSGISImageHistogramEngine::hasExactIntBins(imageDataset->GetRasterBand(n)->GetRasterDataType()))
+                {
+                    intBands.push_back(n);
+                }
+                else
+                {
+                    otherBands.push_back(n);
+                }
             }
+            outVals = std::vector<double>(numImgBands, 0.0);
             
-            matrixUtils.freeMatrix(bandPercentiles);
-
-            GDALClose(imageDataset);
-        }
-        catch(rsgis::RSGISException &e)
-        {
+            rsgis::img::RSGISImageHistogramEngine histEngine = rsgis::img::RSGISImageHistogramEngine(numThreads);
+            if(!intBands.empty())
+            {
+                // The integer bands are read together, with the percentiles found exactly from a bin per value.
+                std::vector<rsgis::img::RSGISBandHistogram> hists = histEngine.calcExactHistograms(imageDataset, intBands, noDataValueSpecified, noDataValue);
+                for(unsigned int i = 0; i < intBands.size(); ++i)
+                {
+                    outVals[intBands[i]-1] = rsgis::img::RSGISImageHistogramEngine::getPercentile(&hists[i], percentile);
+                }
+            }
+            
+            if(!otherBands.empty())
+            {
+                if(approxFloatBands)
+                {
+                    std::vector<rsgis::img::RSGISQuantileSketch> sketches = histEngine.calcQuantileSketches(imageDataset, otherBands, noDataValueSpecified, noDataValue);
+                    for(unsigned int i = 0; i < otherBands.size(); ++i)
+                    {
+                        outVals[otherBands[i]-1] = sketches[i].getQuantile(percentile);
+                    }
+                }
+                else
+                {
+                    // The other bands are refined together with a histogram per pass rather than read into memory and sorted.
+                    std::vector<double> pctVals = histEngine.calcExactPercentiles(imageDataset, otherBands, percentile, noDataValueSpecified, noDataValue);
+                    for(unsigned int i = 0; i < otherBands.size(); ++i)
+                    {
+                        outVals[otherBands[i]-1] = pctVals[i];
+                    }
+                }
+            }
+            
+            for(unsigned int n = 0; n < numImgBands; ++n)
+            {
+                std::cout << "\tPercentile " << percentile << " of band " << n+1 << " = " << outVals[n] << std::endl;
+            }
+
+            GDALClose(imageDataset);
+        }
+        catch(rsgis::RSGISException &e)
+        {
             throw RSGISCmdException(e.what());
         }
         
@@ -1729,7 +2034,7 @@ namespace rsgis{ namespace cmds {
             corrBandA = corrBandA - 1;
             corrBandB = corrBandB - 1;
             
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[1];
             
             datasets[0] = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
@@ -1739,14 +2044,14 @@ namespace rsgis{ namespace cmds {
                 throw rsgis::RSGISImageException(message.c_str());
             }
             
-            rsgis::img::RSGISCalcImage *calcImage = NULL;
-            
-            rsgis::img::RSGISCalcImage2ImageCorrelation *calcWindowCorr = new rsgis::img::RSGISCalcImage2ImageCorrelation(corrBandA, corrBandB);
-            
-            calcImage = new rsgis::img::RSGISCalcImage(calcWindowCorr, "", true);
-            calcImage->calcImageWindowData(datasets, 1, outputImage, winSize, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
-            delete calcWindowCorr;
-            delete calcImage;
+            // The window sums are updated as the window moves, so the time per pixel does not depend on the window size.
+            std::vector<unsigned int> corrBands;
+            corrBands.push_back(corrBandA);
+            corrBands.push_back(corrBandB);
+            rsgis::img::RSGISVirtualImageDataset inputNode(datasets, 1);
+            rsgis::img::RSGISCalcWindowSumsCorrelation calcWindowCorr;
+            rsgis::img::RSGISVirtualImageWindowSums corrNode(&inputNode, &calcWindowCorr, winSize, corrBands, true);
+            rsgis::img::RSGISVirtualImageSinks::writeImage(&corrNode, outputImage, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
             
             GDALClose(datasets[0]);
             delete[] datasets;
@@ -1768,7 +2073,7 @@ namespace rsgis{ namespace cmds {
         std::cout.precision(12);
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             
             if(dataset == NULL)
@@ -1864,13 +2169,60 @@ namespace rsgis{ namespace cmds {
     }
                 
                 
+    void executeImageBandStatsArrays(const float* const* bands, unsigned int numBands, size_t nPxls, rsgis::cmds::ImageStatsCmds *stats, bool noDataValueSpecified, float noDataVal, bool calcSD)
+    {
+        try
+        {
+            rsgis::img::ImageStats **imgStats = new rsgis::img::ImageStats*[numBands];
+            for(unsigned int i = 0; i < numBands; ++i)
+            {
+                imgStats[i] = new rsgis::img::ImageStats();
+                imgStats[i]->min = 0;
+                imgStats[i]->max = 0;
+                imgStats[i]->mean = 0;
+                imgStats[i]->sum = 0;
+                imgStats[i]->stddev = 0;
+            }
+            
+            rsgis::img::RSGISCalcImageStatisticsNoData calcImageStats(numBands, false, NULL, noDataValueSpecified, noDataVal, false);
+            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&calcImageStats, "", true);
+            calcImage.calcImageArrays(bands, numBands, nPxls);
+            if(calcSD)
+            {
+                calcImageStats.calcStdDev();
+                calcImage.calcImageArrays(bands, numBands, nPxls);
+            }
+            calcImageStats.getImageStats(imgStats, numBands);
+            
+            for(unsigned int i = 0; i < numBands; ++i)
+            {
+                stats[i].min = imgStats[i]->min;
+                stats[i].max = imgStats[i]->max;
+                stats[i].mean = imgStats[i]->mean;
+                stats[i].sum = imgStats[i]->sum;
+                stats[i].stddev = imgStats[i]->stddev;
+                delete imgStats[i];
+            }
+            delete[] imgStats;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+                
+                
     float executeImageBandModeEnv(std::string inputImage, float binWidth, unsigned int imgBand, bool noDataValueSpecified, float noDataVal, double longMin, double longMax, double latMin, double latMax)
     {
         std::cout.precision(12);
         float outputModeVal = 0.0;
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             
             if(dataset == NULL)
@@ -2048,7 +2400,7 @@ namespace rsgis{ namespace cmds {
         double rSq = 0.0;
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **imgDatasets = new GDALDataset*[2];
             
             imgDatasets[0] = (GDALDataset *) GDALOpen(inputImage1.c_str(), GA_ReadOnly);
@@ -2212,7 +2564,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset *inImgDS = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(inImgDS == NULL)
@@ -2258,7 +2610,7 @@ namespace rsgis{ namespace cmds {
                 
     float executeCalcPropTrueExp(VariableStruct *variables, unsigned int numVars, std::string mathsExpression, std::string inValidImage, bool useValidImg) 
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset **datasets = NULL;
         mu::Parser *muParser = new mu::Parser();
         float propPxls = 0.0;
@@ -2364,7 +2716,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             int numBands = 0;
             bool firstImg = true;
             int numImgs = inputImages.size();
@@ -2400,45 +2752,50 @@ namespace rsgis{ namespace cmds {
                 }
             }
             
-            rsgis::math::rsgissummarytype sumType = rsgis::math::sumtype_mean;
+            rsgis::img::RSGISTemporalStatSpec statSpec;
+            statSpec.stat = rsgis::img::rsgis_tstat_mean;
+            statSpec.percentile = 0.0;
             if(summaryStats == rsgis::cmds::rsgiscmds_stat_mean)
             {
-               sumType = rsgis::math::sumtype_mean;
+               statSpec.stat = rsgis::img::rsgis_tstat_mean;
             }
             else if(summaryStats == rsgis::cmds::rsgiscmds_stat_min)
             {
-                sumType = rsgis::math::sumtype_min;
+                statSpec.stat = rsgis::img::rsgis_tstat_min;
             }
             else if(summaryStats == rsgis::cmds::rsgiscmds_stat_max)
             {
-                sumType = rsgis::math::sumtype_max;
+                statSpec.stat = rsgis::img::rsgis_tstat_max;
             }
             else if(summaryStats == rsgis::cmds::rsgiscmds_stat_median)
             {
-                sumType = rsgis::math::sumtype_median;
+                statSpec.stat = rsgis::img::rsgis_tstat_median;
             }
             else if(summaryStats == rsgis::cmds::rsgiscmds_stat_range)
             {
-                sumType = rsgis::math::sumtype_range;
+                statSpec.stat = rsgis::img::rsgis_tstat_range;
             }
             else if(summaryStats == rsgis::cmds::rsgiscmds_stat_stddev)
             {
-                sumType = rsgis::math::sumtype_stddev;
+                statSpec.stat = rsgis::img::rsgis_tstat_stddev;
             }
             else if(summaryStats == rsgis::cmds::rsgiscmds_stat_sum)
             {
-                sumType = rsgis::math::sumtype_sum;
+                statSpec.stat = rsgis::img::rsgis_tstat_sum;
             }
             else if(summaryStats == rsgis::cmds::rsgiscmds_stat_mode)
             {
-                sumType = rsgis::math::sumtype_mode;
+                statSpec.stat = rsgis::img::rsgis_tstat_mode;
             }
             else
             {
                 throw RSGISCmdException("The summary type specified is unknown.");
             }
             
-            rsgis::img::RSGISCalcMultiImageStatSummaries calcMultiImgStats = rsgis::img::RSGISCalcMultiImageStatSummaries(numBands, sumType, numImgs, numBands, noDataVal, useNoData);
+            // Band i of image n is input layer (n * numBands) + i, so each output band is a series with a time stride of numBands.
+            std::vector<rsgis::img::RSGISTemporalStatSpec> stats;
+            stats.push_back(statSpec);
+            rsgis::img::RSGISTemporalSummary calcMultiImgStats = rsgis::img::RSGISTemporalSummary(numBands, numImgs, 1, numBands, stats, noDataVal, useNoData, true);
             
             rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&calcMultiImgStats, "", true);
             calcImage.calcImage(datasets, numImgs, outputImage, false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
@@ -2463,13 +2820,330 @@ namespace rsgis{ namespace cmds {
             throw RSGISCmdException(e.what());
         }
     }
+    
+    void executeTemporalOutlierChange(std::vector<std::string> inputImages, unsigned int imgBand, std::string outputImage, std::string gdalFormat, float threshold, unsigned int minObs, bool useNoData, float noDataVal, bool outScores, unsigned int numThreads)
+    {
+        GDALDataset **datasets = NULL;
+        int numImgs = inputImages.size();
+        try
+        {
+            if(numImgs == 0)
+            {
+                throw rsgis::RSGISImageException("At least one input image must be provided.");
+            }
+            
+            rsgis::RSGISGDALInit::init();
+            datasets = new GDALDataset*[numImgs];
+            for(int i = 0; i < numImgs; ++i)
+            {
+                datasets[i] = NULL;
+            }
+            
+            int numBands = 0;
+            for(int i = 0; i < numImgs; ++i)
+            {
+                std::cout << "Opening " << inputImages.at(i) << std::endl;
+                datasets[i] = (GDALDataset *) GDALOpen(inputImages.at(i).c_str(), GA_ReadOnly);
+                if(datasets[i] == NULL)
+                {
+                    std::string message = std::string("Could not open image ") + inputImages.at(i);
+                    throw rsgis::RSGISImageException(message.c_str());
+                }
+                
+                if(i == 0)
+                {
+                    numBands = datasets[i]->GetRasterCount();
+                }
+                else if(numBands != datasets[i]->GetRasterCount())
+                {
+                    throw rsgis::RSGISImageException("All input images must have the same number of image bands.");
+                }
+            }
+            
+            // A single image is a band stack, otherwise band imgBand of image n is input layer (n * numBands) + (imgBand - 1).
+            unsigned int numTimeSteps = numBands;
+            unsigned int firstBand = 0;
+            unsigned int timeStride = 1;
+            std::string *bandNames = new std::string[(numImgs == 1)?numBands:numImgs];
+            if(numImgs == 1)
+            {
+                for(int i = 0; i < numBands; ++i)
+                {
+                    bandNames[i] = std::string(datasets[0]->GetRasterBand(i+1)->GetDescription());
+                    if(bandNames[i] == "")
+                    {
+                        bandNames[i] = std::string("Band") + std::to_string(i+1);
+                    }
+                }
+            }
+            else
+            {
+                if((imgBand == 0) || (imgBand > ((unsigned int)numBands)))
+                {
+                    delete[] bandNames;
+                    throw rsgis::RSGISImageException("The image band specified is not within the input images.");
+                }
+                numTimeSteps = numImgs;
+                firstBand = imgBand - 1;
+                timeStride = numBands;
+                rsgis::utils::RSGISFileUtils fileUtils;
+                for(int i = 0; i < numImgs; ++i)
+                {
+                    bandNames[i] = fileUtils.getFileNameNoExtension(inputImages.at(i));
+                }
+            }
+            
+            rsgis::img::RSGISTemporalOutlierChange calcOutlierChng = rsgis::img::RSGISTemporalOutlierChange(numTimeSteps, firstBand, timeStride, threshold, minObs, noDataVal, useNoData, outScores);
+            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&calcOutlierChng, "", true);
+            calcImage.setNumThreads(numThreads);
+            calcImage.calcImage(datasets, numImgs, outputImage, true, bandNames, gdalFormat, outScores?GDT_Float32:GDT_Byte);
+            delete[] bandNames;
+            
+            for(int i = 0; i < numImgs; ++i)
+            {
+                GDALClose(datasets[i]);
+            }
+            delete[] datasets;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            if(datasets != NULL)
+            {
+                for(int i = 0; i < numImgs; ++i)
+                {
+                    if(datasets[i] != NULL)
+                    {
+                        GDALClose(datasets[i]);
+                    }
+                }
+                delete[] datasets;
+            }
+            throw RSGISCmdException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+    
+    void executeCalcSpectralIndices(std::string inputImage, std::vector<SpectralIndexCmds> indices, std::string outputImage, std::string gdalFormat, float outNoDataVal, unsigned int numThreads)
+    {
+        GDALDataset *dataset = NULL;
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            unsigned int numBands = dataset->GetRasterCount();
+            
+            std::vector<rsgis::img::RSGISSpectralIndexDefn> idxDefns;
+            std::string *bandNames = new std::string[indices.size()];
+            for(size_t i = 0; i < indices.size(); ++i)
+            {
+                rsgis::img::RSGISSpectralIndexDefn idxDefn;
+                switch(indices[i].index)
+                {
+                    case rsgiscmds_sidx_normdiff:
+                        idxDefn.type = rsgis::img::rsgis_sidx_normdiff;
+                        break;
+                    case rsgiscmds_sidx_ratio:
+                        idxDefn.type = rsgis::img::rsgis_sidx_ratio;
+                        break;
+                    case rsgiscmds_sidx_evi:
+                        idxDefn.type = rsgis::img::rsgis_sidx_evi;
+                        break;
+                    case rsgiscmds_sidx_evi2:
+                        idxDefn.type = rsgis::img::rsgis_sidx_evi2;
+                        break;
+                    case rsgiscmds_sidx_expression:
+                        idxDefn.type = rsgis::img::rsgis_sidx_expression;
+                        break;
+                    default:
+                        delete[] bandNames;
+                        throw rsgis::RSGISImageException("Did not recognise the spectral index type.");
+                }
+                idxDefn.name = indices[i].name;
+                for(std::vector<unsigned int>::iterator iterBand = indices[i].bands.begin(); iterBand != indices[i].bands.end(); ++iterBand)
+                {
+                    if(((*iterBand) == 0) || ((*iterBand) > numBands))
+                    {
+                        delete[] bandNames;
+                        std::string message = std::string("A band of the index '") + indices[i].name + std::string("' is not within the input image.");
+                        throw rsgis::RSGISImageException(message.c_str());
+                    }
+                    idxDefn.bands.push_back((*iterBand)-1);
+                }
+                idxDefn.params = indices[i].params;
+                idxDefn.expression = indices[i].expression;
+                idxDefn.varNames = indices[i].varNames;
+                idxDefns.push_back(idxDefn);
+                bandNames[i] = indices[i].name;
+            }
+            
+            rsgis::img::RSGISSpectralIndexBank idxBank = rsgis::img::RSGISSpectralIndexBank(idxDefns, outNoDataVal);
+            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&idxBank, "", true);
+            calcImage.setNumThreads(numThreads);
+            // Write the output strips on a separate I/O thread while the next strip is processed.
+            calcImage.setNumIOBuffers(std::max<unsigned int>(calcImage.getNumIOBuffers(), 2));
+            calcImage.calcImage(&dataset, 1, outputImage, true, bandNames, gdalFormat, GDT_Float32);
+            delete[] bandNames;
+            
+            GDALClose(dataset);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            if(dataset != NULL)
+            {
+                GDALClose(dataset);
+            }
+            throw RSGISCmdException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
                 
                 
-    void calcImageDifference(std::string inputImage1, std::string inputImage2, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType) 
+    void executeTemporalRobustFit(std::vector<std::string> inputImages, std::vector<double> dates, std::vector<unsigned int> imgBands, std::string outputImage, std::string gdalFormat, bool tmask, float threshold, unsigned int minObs, unsigned int maxIters, bool useNoData, float noDataVal, std::string refImage, unsigned int numThreads)
     {
+        GDALDataset **datasets = NULL;
+        int numImgs = inputImages.size();
+        int numDS = numImgs + ((refImage != "")?1:0);
         try
         {
+            if(numImgs == 0)
+            {
+                throw rsgis::RSGISImageException("At least one input image must be provided.");
+            }
+            if(dates.size() != inputImages.size())
+            {
+                throw rsgis::RSGISImageException("A date must be provided for each input image.");
+            }
+            
             GDALAllRegister();
+            datasets = new GDALDataset*[numDS];
+            for(int i = 0; i < numDS; ++i)
+            {
+                datasets[i] = NULL;
+            }
+            
+            int numBands = 0;
+            for(int i = 0; i < numImgs; ++i)
+            {
+                std::cout << "Opening " << inputImages.at(i) << std::endl;
+                datasets[i] = (GDALDataset *) GDALOpen(inputImages.at(i).c_str(), GA_ReadOnly);
+                if(datasets[i] == NULL)
+                {
+                    std::string message = std::string("Could not open image ") + inputImages.at(i);
+                    throw rsgis::RSGISImageException(message.c_str());
+                }
+                
+                if(i == 0)
+                {
+                    numBands = datasets[i]->GetRasterCount();
+                }
+                else if(numBands != datasets[i]->GetRasterCount())
+                {
+                    throw rsgis::RSGISImageException("All input images must have the same number of image bands.");
+                }
+            }
+            // The reference image is the last dataset so only limits the extent.
+            if(refImage != "")
+            {
+                datasets[numImgs] = (GDALDataset *) GDALOpen(refImage.c_str(), GA_ReadOnly);
+                if(datasets[numImgs] == NULL)
+                {
+                    std::string message = std::string("Could not open image ") + refImage;
+                    throw rsgis::RSGISImageException(message.c_str());
+                }
+            }
+            
+            if(imgBands.empty())
+            {
+                for(int b = 1; b <= numBands; ++b)
+                {
+                    imgBands.push_back(b);
+                }
+            }
+            
+            // Band b of image n is input layer (n * numBands) + (b - 1).
+            std::vector<unsigned int> fitBands;
+            for(std::vector<unsigned int>::iterator iterBand = imgBands.begin(); iterBand != imgBands.end(); ++iterBand)
+            {
+                if(((*iterBand) == 0) || ((*iterBand) > ((unsigned int)numBands)))
+                {
+                    throw rsgis::RSGISImageException("An image band specified is not within the input images.");
+                }
+                fitBands.push_back((*iterBand) - 1);
+            }
+            
+            rsgis::utils::RSGISFileUtils fileUtils;
+            unsigned int numOutBands = tmask?numImgs:(numImgs * imgBands.size());
+            std::string *bandNames = new std::string[numOutBands];
+            for(int i = 0; i < numImgs; ++i)
+            {
+                std::string imgName = fileUtils.getFileNameNoExtension(inputImages.at(i));
+                if(tmask)
+                {
+                    bandNames[i] = imgName;
+                    continue;
+                }
+                for(size_t b = 0; b < imgBands.size(); ++b)
+                {
+                    std::string bandName = std::string(datasets[i]->GetRasterBand(imgBands.at(b))->GetDescription());
+                    if(bandName == "")
+                    {
+                        bandName = std::string("Band") + std::to_string(imgBands.at(b));
+                    }
+                    bandNames[(i * imgBands.size()) + b] = imgName + std::string("_") + bandName;
+                }
+            }
+            
+            rsgis::img::RSGISTemporalRobustFitOutput outType = tmask?rsgis::img::rsgis_trfit_tmask:rsgis::img::rsgis_trfit_outliers;
+            rsgis::img::RSGISTemporalRobustFit calcRobustFit = rsgis::img::RSGISTemporalRobustFit(dates, fitBands, numBands, outType, threshold, minObs, maxIters, noDataVal, useNoData);
+            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&calcRobustFit, "", true);
+            calcImage.setNumThreads(numThreads);
+            calcImage.calcImage(datasets, numDS, outputImage, true, bandNames, gdalFormat, tmask?GDT_Byte:GDT_Int16);
+            delete[] bandNames;
+            
+            for(int i = 0; i < numDS; ++i)
+            {
+                GDALClose(datasets[i]);
+            }
+            delete[] datasets;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            if(datasets != NULL)
+            {
+                for(int i = 0; i < numDS; ++i)
+                {
+                    if(datasets[i] != NULL)
+                    {
+                        GDALClose(datasets[i]);
+                    }
+                }
+                delete[] datasets;
+            }
+            throw RSGISCmdException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+                
+                
+    void calcImageDifference(std::string inputImage1, std::string inputImage2, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType) 
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[2];
             
             std::cout << "Opening " << inputImage1 << std::endl;
@@ -2497,8 +3171,13 @@ namespace rsgis{ namespace cmds {
             }
             int numBands = datasets[0]->GetRasterCount();
 
-            rsgis::img::RSGISCalcImageDifference calcImgDiff = rsgis::img::RSGISCalcImageDifference(numBands);
-            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&calcImgDiff, "", true);
+            std::vector<std::pair<unsigned int, unsigned int> > bandPairs;
+            for(int i = 0; i < numBands; ++i)
+            {
+                bandPairs.push_back(std::pair<unsigned int, unsigned int>(i, numBands + i));
+            }
+            rsgis::img::RSGISImageComparison compImgs = rsgis::img::RSGISImageComparison(bandPairs, true);
+            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&compImgs, "", true);
             calcImage.calcImage(datasets, 2, outputImage, false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
             
             GDALClose(datasets[0]);
@@ -2519,12 +3198,92 @@ namespace rsgis{ namespace cmds {
         }
     }
                 
+    std::vector<ImageComparisonStatsCmds> executeImageComparison(std::string inputImage1, std::string inputImage2, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType)
+    {
+        std::vector<ImageComparisonStatsCmds> bandStats;
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            GDALDataset *datasets[2] = {NULL, NULL};
+            
+            datasets[0] = (GDALDataset *) GDALOpen(inputImage1.c_str(), GA_ReadOnly);
+            if(datasets[0] == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage1;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            datasets[1] = (GDALDataset *) GDALOpen(inputImage2.c_str(), GA_ReadOnly);
+            if(datasets[1] == NULL)
+            {
+                GDALClose(datasets[0]);
+                std::string message = std::string("Could not open image ") + inputImage2;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            if(datasets[0]->GetRasterCount() != datasets[1]->GetRasterCount())
+            {
+                GDALClose(datasets[0]);
+                GDALClose(datasets[1]);
+                throw rsgis::RSGISImageException("Images do not have the same number of image bands.");
+            }
+            int numBands = datasets[0]->GetRasterCount();
+            
+            std::vector<std::pair<unsigned int, unsigned int> > bandPairs;
+            for(int i = 0; i < numBands; ++i)
+            {
+                bandPairs.push_back(std::pair<unsigned int, unsigned int>(i, numBands + i));
+            }
+            
+            // The difference image (if requested) and the statistics are all calculated in
+            // one pass, with per-thread sums which are merged at the end.
+            bool outputDiff = (outputImage != "");
+            rsgis::img::RSGISImageComparison compImgs = rsgis::img::RSGISImageComparison(bandPairs, outputDiff);
+            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&compImgs, "", true);
+            if(outputDiff)
+            {
+                calcImage.calcImage(datasets, 2, outputImage, false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
+            }
+            else
+            {
+                calcImage.calcImage(datasets, 2);
+            }
+            
+            for(int i = 0; i < numBands; ++i)
+            {
+                ImageComparisonStatsCmds stats;
+                stats.numPxls = compImgs.getNumPxls();
+                stats.rmse = compImgs.getRMSE(i);
+                stats.bias = compImgs.getBias(i);
+                stats.meanAbsDiff = compImgs.getMeanAbsDiff(i);
+                stats.correlation = compImgs.getCorrelation(i);
+                bandStats.push_back(stats);
+            }
+            
+            GDALClose(datasets[0]);
+            GDALClose(datasets[1]);
+        }
+        catch(rsgis::RSGISImageException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        return bandStats;
+    }
+                
     std::pair<double,double> getImageBandMinMax(std::string inputImage, unsigned int imgBand, bool useNoData, float noDataVal) 
     {
         std::pair<double,double> outVals;
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *inImgDS = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(inImgDS == NULL)
@@ -2558,11 +3317,11 @@ namespace rsgis{ namespace cmds {
         return outVals;
     }
                 
-    void executeRescaleImages(std::vector<std::string> inputImgs, std::string outputImg, std::string gdalFormat, RSGISLibDataType outDataType, float cNoDataVal, float cOffset, float cGain, float nNoDataVal, float nOffset, float nGain) 
+    void executeRescaleImages(std::vector<std::string> inputImgs, std::string outputImg, std::string gdalFormat, RSGISLibDataType outDataType, float cNoDataVal, float cOffset, float cGain, float nNoDataVal, float nOffset, float nGain, unsigned int nThreads) 
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             unsigned int nImgs = inputImgs.size();
             unsigned int numBands = 0;
@@ -2581,8 +3340,13 @@ namespace rsgis{ namespace cmds {
             
             
             rsgis::img::RSGISRescaleImageData calcImgReScale = rsgis::img::RSGISRescaleImageData(numBands, cNoDataVal, cOffset, cGain, nNoDataVal, nOffset, nGain);
-            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&calcImgReScale, "", true);
-            calcImage.calcImage(datasets, nImgs, outputImg, false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
+            // The rescaling is applied with the native data types of the input and output images where they are supported.
+            if(!rsgis::img::RSGISCalcImageAffine::calcImage(calcImgReScale.getAffineTransform(), datasets, nImgs, outputImg, false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType), nThreads))
+            {
+                rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&calcImgReScale, "", true);
+                calcImage.setNumThreads(nThreads);
+                calcImage.calcImage(datasets, nImgs, outputImg, false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
+            }
             
             for(unsigned int i = 0; i < nImgs; ++i)
             {
@@ -2608,20 +3372,22 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
-            rsgis::math::rsgissummarytype sumType = rsgis::math::sumtype_mean;
+            rsgis::img::RSGISTemporalStatSpec statSpec;
+            statSpec.stat = rsgis::img::rsgis_tstat_argmin;
+            statSpec.percentile = 0.0;
             if(sumStat == rsgis::cmds::rsgiscmds_stat_min)
             {
-                sumType = rsgis::math::sumtype_min;
+                statSpec.stat = rsgis::img::rsgis_tstat_argmin;
             }
             else if(sumStat == rsgis::cmds::rsgiscmds_stat_max)
             {
-                sumType = rsgis::math::sumtype_max;
+                statSpec.stat = rsgis::img::rsgis_tstat_argmax;
             }
             else if(sumStat == rsgis::cmds::rsgiscmds_stat_median)
             {
-                sumType = rsgis::math::sumtype_median;
+                statSpec.stat = rsgis::img::rsgis_tstat_argmedian;
             }
             else
             {
@@ -2652,7 +3418,9 @@ namespace rsgis{ namespace cmds {
             }
             
             
-            rsgis::img::RSGISCalcImgStackIdxForStat calcImgStatIdxs = rsgis::img::RSGISCalcImgStackIdxForStat(noDataVal, sumType);
+            std::vector<rsgis::img::RSGISTemporalStatSpec> stats;
+            stats.push_back(statSpec);
+            rsgis::img::RSGISTemporalSummary calcImgStatIdxs = rsgis::img::RSGISTemporalSummary(1, nImgs, 1, 1, stats, noDataVal, true);
             rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&calcImgStatIdxs, "", true);
             calcImage.calcImage(datasets, nImgs, outputImg, false, NULL, gdalFormat, GDT_UInt16);
             
@@ -2681,7 +3449,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             std::vector<rsgis::math::rsgissummarytype> sumStats;
             for(std::vector<RSGISCmdsSummariseStats>::iterator iterSum = cmdSumStats.begin(); iterSum != cmdSumStats.end(); ++iterSum)
@@ -2766,7 +3534,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImg.c_str(), GA_ReadOnly);
             if(dataset == NULL)
@@ -2777,9 +3545,16 @@ namespace rsgis{ namespace cmds {
             
             GDALDataType gdalDataType = dataset->GetRasterBand(1)->GetRasterDataType();
             
-            rsgis::img::RSGISCalcLocalMinInWin calcLclWinMin = rsgis::img::RSGISCalcLocalMinInWin(bands, noDataValue, useNoDataValue);
-            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&calcLclWinMin, "", true);
-            calcImage.calcImageWindowData(&dataset, 1, outputImg, outputRefImg, winSize, gdalFormat, gdalDataType);
+            // The window minimum is found with sliding minimums along the rows and columns, so the time per pixel does not depend on the window size.
+            rsgis::img::RSGISVirtualImageDataset inputNode(&dataset, 1);
+            rsgis::img::RSGISVirtualImageWindowMin winMinNode(&inputNode, bands, winSize, noDataValue, useNoDataValue);
+            std::vector<std::string> outputImages;
+            outputImages.push_back(outputImg);
+            outputImages.push_back(outputRefImg);
+            std::vector<GDALDataType> outDataTypes;
+            outDataTypes.push_back(gdalDataType);
+            outDataTypes.push_back(GDT_UInt32);
+            rsgis::img::RSGISVirtualImageSinks::writeBandImages(&winMinNode, outputImages, gdalFormat, outDataTypes);
             
             GDALClose(dataset);
         }
@@ -2803,7 +3578,7 @@ namespace rsgis{ namespace cmds {
         float outImgVal = 0.0;
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset **datasets = new GDALDataset*[2];
             
@@ -2848,6 +3623,144 @@ namespace rsgis{ namespace cmds {
         }
         return outImgVal;
     }
+    
+    void executeCostDistance(std::string costImage, unsigned int costBand, std::string srcImage, std::vector<std::pair<double, double> > srcCoords, std::string outDistImage, std::string outDirImage, std::string gdalFormat, bool useNoData, float noDataVal, unsigned int tileSize)
+    {
+        GDALDataset *costDS = NULL;
+        GDALDataset *srcDS = NULL;
+        GDALDataset *outDistDS = NULL;
+        GDALDataset *outDirDS = NULL;
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            costDS = (GDALDataset *) GDALOpen(costImage.c_str(), GA_ReadOnly);
+            if(costDS == NULL)
+            {
+                std::string message = std::string("Could not open image ") + costImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            if(srcImage != "")
+            {
+                srcDS = (GDALDataset *) GDALOpen(srcImage.c_str(), GA_ReadOnly);
+                if(srcDS == NULL)
+                {
+                    std::string message = std::string("Could not open image ") + srcImage;
+                    throw rsgis::RSGISImageException(message.c_str());
+                }
+            }
+            
+            double geoTrans[6];
+            costDS->GetGeoTransform(geoTrans);
+            std::vector<std::pair<unsigned int, unsigned int> > srcPxls;
+            for(size_t i = 0; i < srcCoords.size(); ++i)
+            {
+                double pxlX = std::floor((srcCoords[i].first - geoTrans[0]) / geoTrans[1]);
+                double pxlY = std::floor((srcCoords[i].second - geoTrans[3]) / geoTrans[5]);
+                if((pxlX < 0) || (pxlY < 0) || (pxlX >= costDS->GetRasterXSize()) || (pxlY >= costDS->GetRasterYSize()))
+                {
+                    throw rsgis::RSGISImageException("A source coordinate is outside of the cost image.");
+                }
+                srcPxls.push_back(std::pair<unsigned int, unsigned int>(pxlX, pxlY));
+            }
+            
+            rsgis::img::RSGISImageUtils imgUtils;
+            outDistDS = imgUtils.createCopy(costDS, 1, outDistImage, gdalFormat, GDT_Float64);
+            outDirDS = imgUtils.createCopy(costDS, 1, outDirImage, gdalFormat, GDT_Byte);
+            
+            rsgis::img::RSGISCostDistance costDist = rsgis::img::RSGISCostDistance(useNoData, noDataVal);
+            costDist.calcCostDistance(costDS, costBand, srcDS, srcPxls, outDistDS, outDirDS, tileSize);
+            
+            GDALClose(costDS);
+            if(srcDS != NULL)
+            {
+                GDALClose(srcDS);
+            }
+            GDALClose(outDistDS);
+            GDALClose(outDirDS);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            GDALDataset *datasets[4] = {costDS, srcDS, outDistDS, outDirDS};
+            for(unsigned int i = 0; i < 4; ++i)
+            {
+                if(datasets[i] != NULL)
+                {
+                    GDALClose(datasets[i]);
+                }
+            }
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+    
+    std::vector<std::pair<double, double> > executeLeastCostPath(std::string dirImage, double x, double y, std::string outPathImage, std::string gdalFormat)
+    {
+        std::vector<std::pair<double, double> > pathCoords;
+        GDALDataset *dirDS = NULL;
+        GDALDataset *outPathDS = NULL;
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            dirDS = (GDALDataset *) GDALOpen(dirImage.c_str(), GA_ReadOnly);
+            if(dirDS == NULL)
+            {
+                std::string message = std::string("Could not open image ") + dirImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            double geoTrans[6];
+            dirDS->GetGeoTransform(geoTrans);
+            double pxlX = std::floor((x - geoTrans[0]) / geoTrans[1]);
+            double pxlY = std::floor((y - geoTrans[3]) / geoTrans[5]);
+            if((pxlX < 0) || (pxlY < 0) || (pxlX >= dirDS->GetRasterXSize()) || (pxlY >= dirDS->GetRasterYSize()))
+            {
+                throw rsgis::RSGISImageException("The path end coordinate is outside of the direction image.");
+            }
+            
+            std::vector<std::pair<unsigned int, unsigned int> > pathPxls = rsgis::img::RSGISCostDistance::extractPath(dirDS, pxlX, pxlY);
+            for(size_t i = 0; i < pathPxls.size(); ++i)
+            {
+                double pathX = geoTrans[0] + ((pathPxls[i].first + 0.5) * geoTrans[1]);
+                double pathY = geoTrans[3] + ((pathPxls[i].second + 0.5) * geoTrans[5]);
+                pathCoords.push_back(std::pair<double, double>(pathX, pathY));
+            }
+            
+            if(outPathImage != "")
+            {
+                rsgis::img::RSGISImageUtils imgUtils;
+                outPathDS = imgUtils.createCopy(dirDS, 1, outPathImage, gdalFormat, GDT_Byte);
+                imgUtils.zerosByteGDALDataset(outPathDS);
+                GDALRasterBand *pathBand = outPathDS->GetRasterBand(1);
+                unsigned char pathVal = 1;
+                for(size_t i = 0; i < pathPxls.size(); ++i)
+                {
+                    pathBand->RasterIO(GF_Write, pathPxls[i].first, pathPxls[i].second, 1, 1, &pathVal, 1, 1, GDT_Byte, 0, 0);
+                }
+                GDALClose(outPathDS);
+            }
+            GDALClose(dirDS);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            if(dirDS != NULL)
+            {
+                GDALClose(dirDS);
+            }
+            if(outPathDS != NULL)
+            {
+                GDALClose(outPathDS);
+            }
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        return pathCoords;
+    }
                 
 }}
 
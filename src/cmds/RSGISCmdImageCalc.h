@@ -65,7 +65,36 @@ namespace rsgis{ namespace cmds {
         double median;
         double mode;
 	};
+    
+    struct DllExport ImageComparisonStatsCmds
+    {
+        unsigned long numPxls;
+        double rmse;
+        double bias;
+        double meanAbsDiff;
+        double correlation;
+    };
 
+    enum RSGISCmdSpectralIndex
+    {
+        rsgiscmds_sidx_normdiff,
+        rsgiscmds_sidx_ratio,
+        rsgiscmds_sidx_evi,
+        rsgiscmds_sidx_evi2,
+        rsgiscmds_sidx_expression
+    };
+    
+    struct DllExport SpectralIndexCmds
+    {
+        std::string name;
+        RSGISCmdSpectralIndex index;
+        /** The image bands (starting at 1) used by the index; for an expression, bands[i] is varNames[i]. */
+        std::vector<unsigned int> bands;
+        std::vector<double> params;
+        std::string expression;
+        std::vector<std::string> varNames;
+    };
+    
     enum RSGISInitClustererMethods
     {
         rsgis_init_random,
@@ -92,14 +121,16 @@ namespace rsgis{ namespace cmds {
 
     /** Function to run the band maths tools */
     DllExport void executeBandMaths(VariableStruct *variables, unsigned int numVars, std::string outputImage, std::string mathsExpression, std::string gdalFormat, RSGISLibDataType outDataType, bool useExpAsbandName, bool editOutputImg=false);
+    /** Function to run the band maths tools on arrays in memory (e.g., numpy arrays), where varNames[i] is bands[i], each band and the output having nPxls values. The arrays are not copied. */
+    DllExport void executeBandMathsArrays(std::vector<std::string> varNames, const float* const* bands, size_t nPxls, std::string mathsExpression, double *output, unsigned int numThreads=1);
     /** Function to run the image maths tools */
     DllExport void executeImageMaths(std::string inputImage, std::string outputImage, std::string mathsExpression, std::string imageFormat, RSGISLibDataType outDataType, bool useExpAsbandName, bool editOutputImg=false);
     /** Function to run the image band maths tools */
     DllExport void executeImageBandMaths(std::string inputImage, std::string outputImage, std::string mathsExpression, std::string imageFormat, RSGISLibDataType outDataType, bool useExpAsbandName, bool editOutputImg=false);
     /** Function to run the KMeans tool */
-    DllExport void executeKMeansClustering(std::string inputImage, std::string outputMatrixFile, unsigned int numClusters, unsigned int maxNumIterations, unsigned int subSample, bool ignoreZeros, float degreeOfChange, RSGISInitClustererMethods initClusterMethod);
+    DllExport void executeKMeansClustering(std::string inputImage, std::string outputMatrixFile, unsigned int numClusters, unsigned int maxNumIterations, unsigned int subSample, bool ignoreZeros, float degreeOfChange, RSGISInitClustererMethods initClusterMethod, unsigned int numThreads=1);
     /** Function to run the KMeans tool */
-    DllExport void executeISODataClustering(std::string inputImage, std::string outputMatrixFile, unsigned int numClusters, unsigned int maxNumIterations, unsigned int subSample, bool ignoreZeros, float degreeOfChange, RSGISInitClustererMethods initClusterMethod, float minDistBetweenClusters, unsigned int minNumFeatures, float maxStdDev, unsigned int minNumClusters, unsigned int startIteration, unsigned int endIteration);
+    DllExport void executeISODataClustering(std::string inputImage, std::string outputMatrixFile, unsigned int numClusters, unsigned int maxNumIterations, unsigned int subSample, bool ignoreZeros, float degreeOfChange, RSGISInitClustererMethods initClusterMethod, float minDistBetweenClusters, unsigned int minNumFeatures, float maxStdDev, unsigned int minNumClusters, unsigned int startIteration, unsigned int endIteration, unsigned int numThreads=1);
     /** Function to run mahalanobis distance Window Filter */
     DllExport void executeMahalanobisDistFilter(std::string inputImage, std::string outputImage, unsigned int winSize, std::string gdalFormat, RSGISLibDataType outDataType);
     /** Function to run mahalanobis distance Image to Window Filter */
@@ -110,12 +141,14 @@ namespace rsgis{ namespace cmds {
     DllExport void executeImagePixelLinearFit(std::string inputImage, std::string outputImage, std::string gdalFormat, std::vector<float> bandValues, float noDataValue, bool useNoDataValue);
     /** Function to calculate the correlation between 2 images */
     DllExport double** executeCorrelation(std::string inputImageA, std::string inputImageB, std::string outputMatrixFile = "", unsigned int *nrows = 0, unsigned int *ncols = 0);
-    /** Function to calculate the covariance between 2 images */
-    DllExport void executeCovariance(std::string inputImageA, std::string inputImageB, std::string inputMatrixA, std::string inputMatrixB, bool shouldCalcMean, std::string outputMatrix);
+    /** Function to calculate the covariance between 2 images (the images are read once, in strips, on numThreads threads) */
+    DllExport void executeCovariance(std::string inputImageA, std::string inputImageB, std::string inputMatrixA, std::string inputMatrixB, bool shouldCalcMean, std::string outputMatrix, unsigned int numThreads=1);
     /** Function to calculate the mean vector of an image */
     DllExport void executeMeanVector(std::string inputImage, std::string outputMatrix);
     /** Function to perform principal components analysis of an image */
-    DllExport void executePCA(std::string inputImage, std::string eigenvectors, std::string outputImage, int numComponents, std::string gdalFormat, RSGISLibDataType outDataType);
+    DllExport void executePCA(std::string inputImage, std::string eigenvectors, std::string outputImage, int numComponents, std::string gdalFormat, RSGISLibDataType outDataType, unsigned int numThreads=1);
+    /** Function to calculate the eigenvectors for a principal components analysis from the covariance of all the image pixels, returning the proportion of the variance explained by each component */
+    DllExport std::vector<double> executeCalcPCAEigenVectors(std::string inputImage, std::string outputMatrix, bool useNoDataVal, float noDataVal, unsigned int numThreads=1);
     /** Function to generate a standardised image using the mean vector provided */
     DllExport void executeStandardise(std::string meanvectorStr, std::string inputImage, std::string outputImage);
     /** Function to convert the image spectra to unit area */
@@ -129,19 +162,21 @@ namespace rsgis{ namespace cmds {
     /** Function to calculate the statistics for the whole image across all bands */
     DllExport void executeImageStats(std::string inputImage, std::string outputFile, bool ignoreZeros);
       /** Function to undertake an exhaustive constrained linear spectral unmixing of the input image for a set of endmembers */
-    DllExport void executeExhconLinearSpecUnmix(std::string inputImage, std::string imageFormat, RSGISLibDataType outDataType, float lsumGain, float lsumOffset, std::string outputFile, std::string endmembersFile, float stepResolution);
+    DllExport void executeExhconLinearSpecUnmix(std::string inputImage, std::string imageFormat, RSGISLibDataType outDataType, float lsumGain, float lsumOffset, std::string outputFile, std::string endmembersFile, float stepResolution, unsigned int numThreads=1);
     /** Function to test whether all bands are equal to the same value */
     DllExport void executeAllBandsEqualTo(std::string inputImage, float imgValue, float outputTrueVal, float outputFalseVal, std::string outputImage, std::string imageFormat, RSGISLibDataType outDataType);
     /** Function to generate a histogram for the region of the mask selected */
     DllExport void executeHistogram(std::string inputImage, std::string imageMask, std::string outputFile, unsigned int imgBand, float imgValue, double binWidth, bool calcInMinMax, double inMin, double inMax);
-    /** Function to generate a histogram and return it */
-    DllExport unsigned int* executeGetHistogram(std::string inputImage, unsigned int imgBand, double binWidth, unsigned int *nBins, bool calcInMinMax, double *inMin, double *inMax);
-    /** Function to calculate image band percentiles */
-    DllExport std::vector<double> executeBandPercentile(std::string inputImage, float percentile, float noDataValue, bool noDataValueSpecified);
+    /** Function to generate a histogram and return it (8 and 16 bit integer bands are read once, with the min and max calculated in the same pass) */
+    DllExport unsigned int* executeGetHistogram(std::string inputImage, unsigned int imgBand, double binWidth, unsigned int *nBins, bool calcInMinMax, double *inMin, double *inMax, unsigned int numThreads=1);
+    /** Function to calculate image band percentiles (exact for integer bands from a single pass histogram; approxFloatBands uses a quantile sketch for the other bands rather than sorting their values) */
+    DllExport std::vector<double> executeBandPercentile(std::string inputImage, float percentile, float noDataValue, bool noDataValueSpecified, bool approxFloatBands=false, unsigned int numThreads=1);
     /** Function to calculate correlation for windows */
     DllExport void executeCorrelationWindow(std::string inputImage, std::string outputImage, unsigned int winSize, unsigned int corrBandA, unsigned int corrBandB, std::string gdalFormat, RSGISLibDataType outDataType);
     /** Function to calculate the statistics for an individual image band within an envelope defined in Lat / Long */
     DllExport void executeImageBandStatsEnv(std::string inputImage, rsgis::cmds::ImageStatsCmds *stats, unsigned int imgBand, bool noDataValueSpecified, float noDataVal, double longMin, double longMax, double latMin, double latMax);
+    /** Function to calculate the statistics for each of the numBands arrays (of nPxls values) in memory (e.g., numpy arrays); stats must have numBands elements. The median and mode are not calculated. */
+    DllExport void executeImageBandStatsArrays(const float* const* bands, unsigned int numBands, size_t nPxls, rsgis::cmds::ImageStatsCmds *stats, bool noDataValueSpecified, float noDataVal, bool calcSD=true);
     /** Function to calculate the mode for an individual image band within an envelope defined in Lat / Long */
     DllExport float executeImageBandModeEnv(std::string inputImage, float binWidth, unsigned int imgBand, bool noDataValueSpecified, float noDataVal, double longMin, double longMax, double latMin, double latMax);
     /** A function to calculate a 2D histogram comparison of two images */
@@ -152,12 +187,20 @@ namespace rsgis{ namespace cmds {
     DllExport float executeCalcPropTrueExp(VariableStruct *variables, unsigned int numVars, std::string mathsExpression, std::string inValidImage, bool useValidImg);
     /** A function to calculate statistic (e.g., min) across a number of images */
     DllExport void calcMultiImgBandsStats(std::vector<std::string> inputImages, std::string outputImage, RSGISCmdsSummariseStats summaryStats, std::string gdalFormat, RSGISLibDataType outDataType, bool useNoData, float noDataVal);
+    /** A function to detect per-pixel outliers (changes) within a time series using the median and median absolute deviation across the time steps. If a single image is provided its bands are the time steps, otherwise band imgBand of each image is used. The output has a band per time step which is 1 (no change), 2 (change; robust z-score > threshold) or 0 (no data), or the robust z-scores if outScores is true. */
+    DllExport void executeTemporalOutlierChange(std::vector<std::string> inputImages, unsigned int imgBand, std::string outputImage, std::string gdalFormat, float threshold=3.5, unsigned int minObs=3, bool useNoData=false, float noDataVal=0, bool outScores=false, unsigned int numThreads=1);
+    /** A function to fit a robust (Tukey biweight) season-trend model through the time series of each pixel (the images, in date order of the dates provided as days, e.g., ordinals) for the bands imgBands (starting at 1; all the bands if empty) and output the outliers. If tmask is false the output has a band per image and band which is 1 (residual > threshold x RMSE), -1 (residual < -threshold x RMSE) or 0 and otherwise imgBands must be the green, NIR and SWIR bands and the output is the Tmask cloud, shadow and snow mask with a band per image (1 = screened). Pixels with fewer than minObs valid images are 0. If refImage is not "" the output only covers the extent of that image. */
+    DllExport void executeTemporalRobustFit(std::vector<std::string> inputImages, std::vector<double> dates, std::vector<unsigned int> imgBands, std::string outputImage, std::string gdalFormat, bool tmask, float threshold, unsigned int minObs=12, unsigned int maxIters=50, bool useNoData=false, float noDataVal=0, std::string refImage="", unsigned int numThreads=1);
+    /** A function to calculate a bank of spectral indices (e.g., NDVI and EVI) in a single pass over the input image, outputting a band for each index. Where the denominator of an index is 0 the output is outNoDataVal. */
+    DllExport void executeCalcSpectralIndices(std::string inputImage, std::vector<SpectralIndexCmds> indices, std::string outputImage, std::string gdalFormat, float outNoDataVal=-999, unsigned int numThreads=1);
     /** A function to calculate the difference between two images */
     DllExport void calcImageDifference(std::string inputImage1, std::string inputImage2, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType);
+    /** A function to compare two images band by band in one pass, returning the RMSE, bias (mean of image 1 - image 2), mean absolute difference and correlation of each band and optionally outputting the difference image (if outputImage is not "") */
+    DllExport std::vector<ImageComparisonStatsCmds> executeImageComparison(std::string inputImage1, std::string inputImage2, std::string outputImage="", std::string gdalFormat="KEA", RSGISLibDataType outDataType=rsgis_32float);
     /** A function to get the min and max image values from the input image band specified */
     DllExport std::pair<double,double> getImageBandMinMax(std::string inputImage, unsigned int imgBand, bool useNoData=false, float noDataVal=0.0);
     /** A function to rescale an input image(s) to use a new scale and offset */
-    DllExport void executeRescaleImages(std::vector<std::string> inputImgs, std::string outputImg, std::string gdalFormat, RSGISLibDataType outDataType, float cNoDataVal, float cOffset, float cGain, float nNoDataVal, float nOffset, float nGain);
+    DllExport void executeRescaleImages(std::vector<std::string> inputImgs, std::string outputImg, std::string gdalFormat, RSGISLibDataType outDataType, float cNoDataVal, float cOffset, float cGain, float nNoDataVal, float nOffset, float nGain, unsigned int nThreads=1);
     /** A function to get the index of an input list of images for a particular stat (e.g., min, max, median) */
     DllExport void executeGetImgIdxForStat(std::vector<std::string> inputImgs, std::string outputImg, std::string gdalFormat, float noDataVal, RSGISCmdsSummariseStats sumStat);
     /** A function to derieve summary stats for the high resolution image pixels for regions defined by the low resolution image pixels */
@@ -166,6 +209,10 @@ namespace rsgis{ namespace cmds {
     DllExport void executeIdentifyMinPxlValueInWin(std::string inputImg, std::string outputImg, std::string outputRefImg, std::vector<unsigned int> bands, unsigned int winSize, std::string gdalFormat, float noDataValue, bool useNoDataValue);
     /** A function to calculate a mean value across a number of image bands within a mask */
     DllExport float executeCalcImgMeanInMask(std::string inputImg, std::string inputImgMsk, int mskValue, std::vector<unsigned int> bands, float noDataValue, bool useNoDataValue);
+    /** A function to calculate the accumulated cost distance (and the direction towards the nearest source) from a set of sources across a cost surface. The sources are the non-zero pixels of srcImage (if not "") and the pixels containing srcCoords. If tileSize is not 0 the image is processed as tiles of tileSize x tileSize pixels. */
+    DllExport void executeCostDistance(std::string costImage, unsigned int costBand, std::string srcImage, std::vector<std::pair<double, double> > srcCoords, std::string outDistImage, std::string outDirImage, std::string gdalFormat, bool useNoData=false, float noDataVal=0, unsigned int tileSize=0);
+    /** A function to extract the least cost path to the point (x, y) from the direction image generated by executeCostDistance, returning the coordinates of the pixel centres along the path from the source. If outPathImage is not "" then an image of the path is also output. */
+    DllExport std::vector<std::pair<double, double> > executeLeastCostPath(std::string dirImage, double x, double y, std::string outPathImage="", std::string gdalFormat="KEA");
 
 
 }}
@@ -22,6 +22,8 @@
 
 #include "RSGISCmdImageCalibration.h"
 #include "RSGISCmdParent.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISGDALInit.h"
 
 #include "calibration/RSGISStandardDN2RadianceCalibration.h"
 #include "calibration/RSGISCalculateTopOfAtmosphereReflectance.h"
@@ -30,10 +32,12 @@
 #include "calibration/RSGISCloudMasking.h"
 #include "calibration/RSGISHydroDEMFillSoilleGratin94.h"
 #include "calibration/RSGISImgCalibUtils.h"
+#include "calibration/RSGISCalibrationPipeline.h"
 
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISCalcImageT.h"
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISCalcEditImage.h"
 #include "img/RSGISCopyImage.h"
@@ -56,7 +60,7 @@ namespace rsgis{ namespace cmds {
     
     void executeConvertLandsat2Radiance(std::string outputImage, std::string gdalFormat, std::vector<CmdsLandsatRadianceGainsOffsets> landsatRadGainOffs)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         
         try
         {
@@ -100,9 +104,20 @@ namespace rsgis{ namespace cmds {
 			}
             
             rsgis::calib::RSGISLandsatRadianceCalibration *radianceCalibration = new rsgis::calib::RSGISLandsatRadianceCalibration(numBands, lsRadGainOffs);
-            rsgis::img::RSGISCalcImage *calcImage = new rsgis::img::RSGISCalcImage(radianceCalibration, "", true);
- 
-            calcImage->calcImage(datasets, numBands, outputImage, true, outBandNames, gdalFormat);
+            rsgis::img::RSGISCalcImage *calcImage = NULL;
+            
+            // Landsat DNs are 8 or 16 bit so each band can be calibrated with a look up table,
+            // where pixels which are 0 in all the bands are the image border.
+            std::vector<int> lutInBands;
+            for(unsigned int i = 0; i < numBands; ++i)
+            {
+                lutInBands.push_back(i);
+            }
+            if(!rsgis::img::RSGISCalcImageLUT::calcImage(radianceCalibration, lutInBands, datasets, numBands, outputImage, true, outBandNames, gdalFormat, GDT_Float32, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads, true, 0))
+            {
+                calcImage = new rsgis::img::RSGISCalcImage(radianceCalibration, "", true);
+                calcImage->calcImage(datasets, numBands, outputImage, true, outBandNames, gdalFormat);
+            }
             
             for(unsigned int i = 0; i < numBands; ++i)
             {
@@ -128,7 +143,7 @@ namespace rsgis{ namespace cmds {
     
     void executeConvertLandsat2RadianceMultiAdd(std::string outputImage, std::string gdalFormat, std::vector<CmdsLandsatRadianceGainsOffsetsMultiAdd> landsatRadGainOffs)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         
         try
         {
@@ -170,9 +185,20 @@ namespace rsgis{ namespace cmds {
 			}
             
             rsgis::calib::RSGISLandsatRadianceCalibrationMultiAdd *radianceCalibration = new rsgis::calib::RSGISLandsatRadianceCalibrationMultiAdd(numBands, lsRadGainOffs);
-            rsgis::img::RSGISCalcImage *calcImage = new rsgis::img::RSGISCalcImage(radianceCalibration, "", true);
+            rsgis::img::RSGISCalcImage *calcImage = NULL;
             
-            calcImage->calcImage(datasets, numBands, outputImage, true, outBandNames, gdalFormat);
+            // Landsat DNs are 8 or 16 bit so each band can be calibrated with a look up table,
+            // where pixels which are 0 in all the bands are the image border.
+            std::vector<int> lutInBands;
+            for(unsigned int i = 0; i < numBands; ++i)
+            {
+                lutInBands.push_back(i);
+            }
+            if(!rsgis::img::RSGISCalcImageLUT::calcImage(radianceCalibration, lutInBands, datasets, numBands, outputImage, true, outBandNames, gdalFormat, GDT_Float32, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads, true, 0))
+            {
+                calcImage = new rsgis::img::RSGISCalcImage(radianceCalibration, "", true);
+                calcImage->calcImage(datasets, numBands, outputImage, true, outBandNames, gdalFormat);
+            }
             
             for(unsigned int i = 0; i < numBands; ++i)
             {
@@ -198,7 +224,7 @@ namespace rsgis{ namespace cmds {
     
     void executeConvertRadiance2TOARefl(std::string inputImage, std::string outputImage, std::string gdalFormat, rsgis::RSGISLibDataType rsgisOutDataType, float scaleFactor, unsigned int julianDay, bool useJulianDay, unsigned int year, unsigned int month, unsigned int day, float solarZenith, float *solarIrradiance, unsigned int numBands) 
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         try
         {
             std::cout << "Open " << inputImage << std::endl;
@@ -241,7 +267,7 @@ namespace rsgis{ namespace cmds {
                 
     void executeConvertTOARefl2Radiance(std::vector<std::string> inputImages, std::string outputImage, std::string gdalFormat, rsgis::RSGISLibDataType rsgisOutDataType, float scaleFactor, float solarDistance, float solarZenith, float *solarIrradiance, unsigned int numBands) 
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         try
         {
             if(inputImages.size() == 1)
@@ -321,7 +347,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[1];
             std::cout << "Open image" << inputImage << std::endl;
             datasets[0] = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
@@ -370,7 +396,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[2];
             std::cout << "Open DEM image: \'" << inputDEM << "\'" << std::endl;
             datasets[0] = (GDALDataset *) GDALOpen(inputDEM.c_str(), GA_ReadOnly);
@@ -466,11 +492,146 @@ namespace rsgis{ namespace cmds {
         }
     }
                 
+    void executeLandsat2SREFElevLUT6sParams(std::vector<CmdsLandsatRadianceGainsOffsetsMultiAdd> landsatRadGainOffs, std::string inputDEM, std::string outputImage, std::string gdalFormat, rsgis::RSGISLibDataType rsgisOutDataType, float scaleFactor, std::vector<Cmds6SElevationLUT> *lut, float noDataVal, bool useNoDataVal, std::string outputRadImage, std::string outputTOAImage, rsgis::RSGISLibDataType toaOutDataType, float toaScaleFactor, unsigned int julianDay, float solarZenith, float *solarIrradiance, unsigned int numSolarIrrVals, unsigned int numThreads)
+    {
+        rsgis::RSGISGDALInit::init();
+        
+        unsigned int numBands = landsatRadGainOffs.size();
+        std::vector<GDALDataset*> datasets;
+        GDALDataset *demDataset = nullptr;
+        std::vector<rsgis::calib::LUT6SElevation> rsgisLUT;
+        auto cleanUp = [&]()
+        {
+            for(auto iterDS = datasets.begin(); iterDS != datasets.end(); ++iterDS)
+            {
+                GDALClose(*iterDS);
+            }
+            datasets.clear();
+            if(demDataset != nullptr)
+            {
+                GDALClose(demDataset);
+                demDataset = nullptr;
+            }
+            for(auto iterLUT = rsgisLUT.begin(); iterLUT != rsgisLUT.end(); ++iterLUT)
+            {
+                delete[] (*iterLUT).imageBands;
+                delete[] (*iterLUT).aX;
+                delete[] (*iterLUT).bX;
+                delete[] (*iterLUT).cX;
+            }
+            rsgisLUT.clear();
+        };
+        
+        try
+        {
+            std::vector<rsgis::calib::LandsatRadianceGainsOffsetsMultiAdd> lsRadGainOffs(numBands);
+            std::vector<std::string> outBandNames(numBands);
+            unsigned int totalNumRasterBands = 0;
+            for(unsigned int i = 0; i < numBands; ++i)
+            {
+                std::cout << "Opening: " << landsatRadGainOffs[i].imagePath << std::endl;
+                GDALDataset *dataset = (GDALDataset *) GDALOpen(landsatRadGainOffs[i].imagePath.c_str(), GA_ReadOnly);
+                if(dataset == nullptr)
+                {
+                    std::string message = std::string("Could not open image ") + landsatRadGainOffs[i].imagePath;
+                    throw RSGISImageException(message.c_str());
+                }
+                datasets.push_back(dataset);
+                
+                unsigned int numRasterBands = dataset->GetRasterCount();
+                if(landsatRadGainOffs[i].band > numRasterBands)
+                {
+                    throw RSGISImageException("You have specified a band which is not within the image");
+                }
+                lsRadGainOffs[i].band = totalNumRasterBands + landsatRadGainOffs[i].band-1;
+                lsRadGainOffs[i].addVal = landsatRadGainOffs[i].addVal;
+                lsRadGainOffs[i].multiVal = landsatRadGainOffs[i].multiVal;
+                outBandNames[i] = landsatRadGainOffs[i].bandName;
+                totalNumRasterBands += numRasterBands;
+            }
+            
+            std::cout << "Open DEM image: \'" << inputDEM << "\'" << std::endl;
+            demDataset = (GDALDataset *) GDALOpen(inputDEM.c_str(), GA_ReadOnly);
+            if(demDataset == nullptr)
+            {
+                std::string message = std::string("Could not open image ") + inputDEM;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            int demNoDataValAvail = false;
+            double demNoDataVal = demDataset->GetRasterBand(1)->GetNoDataValue(&demNoDataValAvail);
+            if(!demNoDataValAvail)
+            {
+                throw rsgis::RSGISException("The DEM image file does not have a no data value defined. ");
+            }
+            
+            for(std::vector<Cmds6SElevationLUT>::iterator iterLUT = lut->begin(); iterLUT != lut->end(); ++iterLUT)
+            {
+                for(unsigned int i = 0; i < (*iterLUT).numValues; ++i)
+                {
+                    if((*iterLUT).imageBands[i] > numBands)
+                    {
+                        throw rsgis::RSGISException("The number of input image bands is not equal to the number coefficients provided.");
+                    }
+                }
+                rsgis::calib::LUT6SElevation lutVal = rsgis::calib::LUT6SElevation();
+                lutVal.numValues = (*iterLUT).numValues;
+                lutVal.elev = (*iterLUT).elev;
+                lutVal.imageBands = new unsigned int[lutVal.numValues];
+                lutVal.aX = new float[lutVal.numValues];
+                lutVal.bX = new float[lutVal.numValues];
+                lutVal.cX = new float[lutVal.numValues];
+                for(unsigned int i = 0; i < (*iterLUT).numValues; ++i)
+                {
+                    lutVal.imageBands[i] = (*iterLUT).imageBands[i];
+                    lutVal.aX[i] = (*iterLUT).aX[i];
+                    lutVal.bX[i] = (*iterLUT).bX[i];
+                    lutVal.cX[i] = (*iterLUT).cX[i];
+                }
+                rsgisLUT.push_back(lutVal);
+            }
+            
+            if((outputTOAImage != "") && (numSolarIrrVals != numBands))
+            {
+                throw rsgis::RSGISException("The number of input image bands and solar irradiance values are different.");
+            }
+            
+            // The radiance is passed to the TOA and SREF stages, as it would be read from a Float32 radiance image.
+            rsgis::calib::RSGISCalibrationPipeline calibPipeline = rsgis::calib::RSGISCalibrationPipeline(numThreads);
+            rsgis::calib::RSGISLandsatRadianceCalibrationMultiAdd radianceCalibration = rsgis::calib::RSGISLandsatRadianceCalibrationMultiAdd(numBands, lsRadGainOffs.data());
+            int radStage = calibPipeline.addStage(&radianceCalibration, -1, std::vector<GDALDataset*>(), GDT_Float32, outputRadImage, gdalFormat, outBandNames);
+            
+            double solarDistance = rsgis::calib::rsgisCalcSolarDistance(julianDay);
+            rsgis::calib::RSGISCalculateTopOfAtmosphereReflectance calcTopAtmosRefl = rsgis::calib::RSGISCalculateTopOfAtmosphereReflectance(numBands, solarIrradiance, solarDistance, solarZenith, toaScaleFactor);
+            if(outputTOAImage != "")
+            {
+                calibPipeline.addStage(&calcTopAtmosRefl, radStage, std::vector<GDALDataset*>(), RSGIS_to_GDAL_Type(toaOutDataType), outputTOAImage, gdalFormat);
+            }
+            
+            rsgis::calib::RSGISApply6SCoefficientsElevLUTParam apply6SCoefficients = rsgis::calib::RSGISApply6SCoefficientsElevLUTParam(numBands, &rsgisLUT, demNoDataVal, noDataVal, useNoDataVal, scaleFactor);
+            calibPipeline.addStage(&apply6SCoefficients, radStage, std::vector<GDALDataset*>(1, demDataset), RSGIS_to_GDAL_Type(rsgisOutDataType), outputImage, gdalFormat);
+            
+            std::cout << "Apply the calibration to the input images...\n";
+            calibPipeline.runPipeline(datasets.data(), numBands);
+            
+            cleanUp();
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            cleanUp();
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            cleanUp();
+            throw RSGISCmdException(e.what());
+        }
+    }
+                
     void executeRad2SREFElevAOTLUT6sParams(std::string inputRadImage, std::string inputDEM, std::string inputAOTImg, std::string outputImage, std::string gdalFormat, rsgis::RSGISLibDataType rsgisOutDataType, float scaleFactor, std::vector<Cmds6SBaseElevAOTLUT> *lut, float noDataVal, bool useNoDataVal)
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[3];
             std::cout << "Open DEM image: \'" << inputDEM << "\'" << std::endl;
             datasets[0] = (GDALDataset *) GDALOpen(inputDEM.c_str(), GA_ReadOnly);
@@ -583,7 +744,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[2];
             
             std::cout << "Open input image: \'" << inputImage << "\'" << std::endl;
@@ -634,7 +795,7 @@ namespace rsgis{ namespace cmds {
                 
     void executeLandsatThermalRad2ThermalBrightness(std::string inputImage, std::string outputImage, std::string gdalFormat, rsgis::RSGISLibDataType rsgisOutDataType, float scaleFactor, std::vector<CmdsLandsatThermalCoeffs> landsatThermalCoeffs) 
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         try
         {
             unsigned int numBands = landsatThermalCoeffs.size();
@@ -696,9 +857,79 @@ namespace rsgis{ namespace cmds {
         }
     }
                 
+    void executeLandsatThermalDN2ThermalBrightness(std::string inputImage, std::string outputImage, std::string gdalFormat, rsgis::RSGISLibDataType rsgisOutDataType, float scaleFactor, std::vector<CmdsLandsatThermalDNCoeffs> landsatThermalCoeffs)
+    {
+        rsgis::RSGISGDALInit::init();
+        try
+        {
+            unsigned int numBands = landsatThermalCoeffs.size();
+            
+            std::cout << "Opening: " << inputImage << std::endl;
+            GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw RSGISImageException(message.c_str());
+            }
+            unsigned int numRasterBands = dataset->GetRasterCount();
+            
+            std::string *outBandNames = new std::string[numRasterBands];
+            float *multiVals = new float[numRasterBands];
+            float *addVals = new float[numRasterBands];
+            float *k1 = new float[numRasterBands];
+            float *k2 = new float[numRasterBands];
+            
+            unsigned int i = 0;
+            for(std::vector<rsgis::cmds::CmdsLandsatThermalDNCoeffs>::iterator iterBands = landsatThermalCoeffs.begin(); iterBands != landsatThermalCoeffs.end(); ++iterBands)
+            {
+                if((*iterBands).band != (i+1))
+                {
+                    throw RSGISImageException("The bands must be specified in order.");
+                }
+                
+                if((*iterBands).band > numRasterBands)
+                {
+                    throw RSGISImageException("You have specified a band which is not within the image");
+                }
+                
+                multiVals[i] = (*iterBands).multiVal;
+                addVals[i] = (*iterBands).addVal;
+                k1[i] = (*iterBands).k1;
+                k2[i] = (*iterBands).k2;
+                outBandNames[i] = (*iterBands).bandName;
+                
+                ++i;
+            }
+            
+            rsgis::calib::RSGISCalculateTOAThermalBrightnessFromDN calibThermalDN = rsgis::calib::RSGISCalculateTOAThermalBrightnessFromDN(numBands, multiVals, addVals, k1, k2, scaleFactor);
+            
+            // 8 and 16 bit DNs are converted with a table of the brightness of every DN.
+            if(!rsgis::img::RSGISCalcImageLUT::calcImage(&calibThermalDN, std::vector<int>(), &dataset, 1, outputImage, true, outBandNames, gdalFormat, RSGIS_to_GDAL_Type(rsgisOutDataType), rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads, true, 0))
+            {
+                rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&calibThermalDN, "", true);
+                calcImage.calcImage(&dataset, 1, outputImage, true, outBandNames, gdalFormat, RSGIS_to_GDAL_Type(rsgisOutDataType));
+            }
+            
+            GDALClose(dataset);
+            delete[] multiVals;
+            delete[] addVals;
+            delete[] k1;
+            delete[] k2;
+            delete[] outBandNames;
+        }
+        catch(RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+                
     void executeGenerateSaturationMask(std::string outputImage, std::string gdalFormat, std::vector<CmdsSaturatedPixel> imgBandInfo)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         try
         {
             unsigned int numBands = imgBandInfo.size();
@@ -762,9 +993,9 @@ namespace rsgis{ namespace cmds {
         }
     }
     
-    void executeLandsatTMCloudFMask(std::string inputTOAImage, std::string inputThermalImage, std::string inputSaturateImage, std::string validImg, std::string outputImage, std::string gdalFormat, double sunAz, double sunZen, double senAz, double senZen, float whitenessThreshold, float scaleFactorIn, std::string tmpImgsBase, std::string tmpImgFileExt, bool rmTmpImgs) 
+    void executeLandsatTMCloudFMask(std::string inputTOAImage, std::string inputThermalImage, std::string inputSaturateImage, std::string validImg, std::string outputImage, std::string gdalFormat, double sunAz, double sunZen, double senAz, double senZen, float whitenessThreshold, float scaleFactorIn, std::string tmpImgsBase, std::string tmpImgFileExt, bool rmTmpImgs, unsigned int numThreads) 
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         try
         {
             std::cout.precision(12);
@@ -850,6 +1081,7 @@ namespace rsgis{ namespace cmds {
             std::cout << "Apply first pass FMask to classifiy initial clear sky regions...\n";
             rsgis::calib::RSGISLandsatFMaskPass1CloudMasking cloudMaskPass1 = rsgis::calib::RSGISLandsatFMaskPass1CloudMasking(scaleFactorIn, (numReflBands+numThermBands), whitenessThreshold);
             rsgis::img::RSGISCalcImage *calcImage = new rsgis::img::RSGISCalcImage(&cloudMaskPass1, "", true);
+            calcImage->setNumThreads(numThreads);
             datasets = new GDALDataset*[3];
             datasets[0] = reflDataset;
             datasets[1] = thermDataset;
@@ -886,6 +1118,7 @@ namespace rsgis{ namespace cmds {
             datasets[0] = validAreaDataset;
             datasets[1] = pass1DS;
             calcImage = new rsgis::img::RSGISCalcImage(&exportLandWaterRegions, "", true);
+            calcImage->setNumThreads(numThreads);
             calcImage->calcImage(datasets, 2, landWaterClearSkyDS);
             double propPCP = exportLandWaterRegions.propOfPCPPixels();
             delete calcImage;
@@ -930,6 +1163,7 @@ namespace rsgis{ namespace cmds {
                 std::cout << "Calculate the cloud probability over the land area...\n";
                 rsgis::calib::RSGISLandsatFMaskPass2ClearSkyCloudProbCloudMasking cloudMaskPass2Part1 = rsgis::calib::RSGISLandsatFMaskPass2ClearSkyCloudProbCloudMasking(scaleFactorIn, (numReflBands+numThermBands), upperWaterThres, upperLandThres, lowerLandThres);
                 calcImage = new rsgis::img::RSGISCalcImage(&cloudMaskPass2Part1, "", true);
+                calcImage->setNumThreads(numThreads);
                 datasets = new GDALDataset*[4];
                 datasets[0] = landWaterClearSkyDS;
                 datasets[1] = reflDataset;
@@ -986,6 +1220,7 @@ namespace rsgis{ namespace cmds {
                 std::cout << "Apply second pass FMask to classify final clouds mask...\n";
                 rsgis::calib::RSGISLandsatFMaskPass2CloudMasking cloudMaskPass2Part2 = rsgis::calib::RSGISLandsatFMaskPass2CloudMasking(scaleFactorIn, (numReflBands+numThermBands), landCloudProbUpperThres, waterCloudProbUpperThres, lowerLandThres);
                 calcImage = new rsgis::img::RSGISCalcImage(&cloudMaskPass2Part2, "", true);
+                calcImage->setNumThreads(numThreads);
                 datasets = new GDALDataset*[5];
                 datasets[0] = landWaterClearSkyDS;
                 datasets[1] = reflDataset;
@@ -1103,6 +1338,7 @@ namespace rsgis{ namespace cmds {
                 GDALDataset *potentCloudShadowDS = imgUtils.createCopy(validAreaDataset, 1, tmpPotentShadows, gdalFormat, GDT_Int32);
                 rsgis::calib::RSGISCalcImagePotentialCloudShadowsMask imgCalcPotentShadows = rsgis::calib::RSGISCalcImagePotentialCloudShadowsMask(scaleFactorIn);
                 rsgis::img::RSGISCalcImage calcPotentShadowImage = rsgis::img::RSGISCalcImage(&imgCalcPotentShadows);
+                calcPotentShadowImage.setNumThreads(numThreads);
                 datasets = new GDALDataset*[5];
                 datasets[0] = validAreaDataset;
                 datasets[1] = nirBandDS;
@@ -1116,12 +1352,12 @@ namespace rsgis{ namespace cmds {
 
                 GDALDataset *initCloudHeightsDS = imgUtils.createCopy(pass1DS, 2, tmpCloudsInitHeights, gdalFormat, GDT_Float32);
                 rsgis::calib::RSGISCalcCloudParams calcCloudParams;
-                calcCloudParams.calcCloudHeights(thermDataset, cloudClumpsRMSmallReLblDS, initCloudHeightsDS, lowerLandThres, upperLandThres, scaleFactorIn);
+                calcCloudParams.calcCloudHeights(thermDataset, cloudClumpsRMSmallReLblDS, initCloudHeightsDS, lowerLandThres, upperLandThres, scaleFactorIn, numThreads);
                 
                 GDALDataset *cloudShadowTestRegionsDS = imgUtils.createCopy(pass1DS, 1, tmpCloudsShadowTestRegions, gdalFormat, GDT_Byte);
                 GDALDataset *cloudShadowRegionsDS = imgUtils.createCopy(pass1DS, 1, tmpCloudsShadows, gdalFormat, GDT_Byte);
                 
-                calcCloudParams.projFitCloudShadow(cloudClumpsRMSmallReLblDS, initCloudHeightsDS, potentCloudShadowDS, cloudShadowTestRegionsDS, cloudShadowRegionsDS, sunAz, sunZen, senAz, senZen);
+                calcCloudParams.projFitCloudShadow(cloudClumpsRMSmallReLblDS, initCloudHeightsDS, potentCloudShadowDS, cloudShadowTestRegionsDS, cloudShadowRegionsDS, sunAz, sunZen, senAz, senZen, numThreads);
                 
                 
                 std::cout << "Apply cloud shadow majority filter...\n";
@@ -1155,10 +1391,9 @@ namespace rsgis{ namespace cmds {
                 delete[] cloudsRATHisto;
                 
                 unsigned int columnIndex = attUtils.findColumnIndex(cloudsRATRelbl, "CloudMask");
-                rsgis::rastergis::RSGISExportColumns2ImageCalcImage calcImageVal = rsgis::rastergis::RSGISExportColumns2ImageCalcImage(1, cloudsRATRelbl, columnIndex);
-                rsgis::img::RSGISCalcImage calcImageExportRATCol(&calcImageVal);
+                rsgis::rastergis::RSGISExportColumns2Image exportCol;
                 GDALDataset *finalCloudsDS = imgUtils.createCopy(pass1DS, 1, tmpFinalClouds, gdalFormat, GDT_Byte);
-                calcImageExportRATCol.calcImage(&cloudClumpsRMSmallReLblDS, 1, 0, finalCloudsDS);
+                exportCol.exportColumn2Image(cloudClumpsRMSmallReLblDS, 1, columnIndex, finalCloudsDS);
       
                 
                 morphDialate.dilateImage(&finalCloudsDS, tmpFinalCloudsDialate, matrixMorphOperator, gdalFormat, GDT_Byte);
@@ -1340,7 +1575,7 @@ namespace rsgis{ namespace cmds {
                 
     void executeConvertWorldView2ToRadiance(std::string inputImage, std::string outputImage, std::string gdalFormat, std::vector<CmdsWorldView2RadianceGainsOffsets> wv2RadGainOffs)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         
         try
         {
@@ -1400,7 +1635,7 @@ namespace rsgis{ namespace cmds {
                 
     void executeConvertSPOT5ToRadiance(std::string inputImage, std::string outputImage, std::string gdalFormat, std::vector<CmdsSPOTRadianceGainsOffsets> spot5RadGainOffs)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         
         try
         {
@@ -1466,7 +1701,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             std::cout << "Open input image: \'" << inputImage << "\'" << std::endl;
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
@@ -1504,11 +1739,11 @@ namespace rsgis{ namespace cmds {
     }
     
                 
-    void executeCalcNadirImageViewAngle(std::string imgFootprint, std::string outViewAngleImg, std::string gdalFormat, double sateAltitude, std::string minXXCol, std::string minXYCol, std::string maxXXCol, std::string maxXYCol, std::string minYXCol, std::string minYYCol, std::string maxYXCol, std::string maxYYCol) 
+    void executeCalcNadirImageViewAngle(std::string imgFootprint, std::string outViewAngleImg, std::string gdalFormat, double sateAltitude, std::string minXXCol, std::string minXYCol, std::string maxXXCol, std::string maxXYCol, std::string minYXCol, std::string minYYCol, std::string maxYXCol, std::string maxYYCol, unsigned int gridSpacing, double maxGridError) 
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             std::cout << "Open input image: \'" << imgFootprint << "\'" << std::endl;
             GDALDataset *dataset = (GDALDataset *) GDALOpen(imgFootprint.c_str(), GA_ReadOnly);
@@ -1519,7 +1754,7 @@ namespace rsgis{ namespace cmds {
             }
             
             rsgis::calib::RSGISImgCalibUtils calibUtils;
-            calibUtils.calcNadirImgViewAngle(dataset, outViewAngleImg, gdalFormat, sateAltitude, minXXCol, minXYCol, maxXXCol, maxXYCol, minYXCol, minYYCol, maxYXCol, maxYYCol);
+            calibUtils.calcNadirImgViewAngle(dataset, outViewAngleImg, gdalFormat, sateAltitude, minXXCol, minXYCol, maxXXCol, maxXYCol, minYXCol, minYYCol, maxYXCol, maxYYCol, gridSpacing, maxGridError);
             
             GDALClose(dataset);
         }
@@ -1537,7 +1772,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[5];
             datasets[0] = (GDALDataset *) GDALOpen(inputDataMaskImg.c_str(), GA_ReadOnly);
             if(datasets[0] == NULL)
@@ -1703,7 +1938,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[5];
             datasets[0] = (GDALDataset *) GDALOpen(inputDataMaskImg.c_str(), GA_ReadOnly);
             if(datasets[0] == NULL)
@@ -1801,9 +2036,9 @@ namespace rsgis{ namespace cmds {
     }
                 
                 
-    void executePerformCloudShadowMasking(std::string cloudMsk, std::string inputImage, std::string validAreaImage, unsigned int darkFillBand, std::string outputImg, std::string gdalFormat, float scaleFactorIn, std::string tmpImgsBase, std::string tmpImgFileExt, bool rmTmpImgs, double sunAz, double sunZen, double senAz, double senZen) 
+    void executePerformCloudShadowMasking(std::string cloudMsk, std::string inputImage, std::string validAreaImage, unsigned int darkFillBand, std::string outputImg, std::string gdalFormat, float scaleFactorIn, std::string tmpImgsBase, std::string tmpImgFileExt, bool rmTmpImgs, double sunAz, double sunZen, double senAz, double senZen, unsigned int numThreads) 
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         try
         {
             std::cout.precision(12);
@@ -1888,6 +2123,7 @@ namespace rsgis{ namespace cmds {
             GDALDataset *potentCloudShadowDS = imgUtils.createCopy(validDataset, 1, tmpPotentShadows, gdalFormat, GDT_Int32);
             rsgis::calib::RSGISCalcImagePotentialCloudShadowsMaskSingleInput imgCalcPotentShadows = rsgis::calib::RSGISCalcImagePotentialCloudShadowsMaskSingleInput(scaleFactorIn);
             rsgis::img::RSGISCalcImage calcPotentShadowImage = rsgis::img::RSGISCalcImage(&imgCalcPotentShadows);
+            calcPotentShadowImage.setNumThreads(numThreads);
             datasets = new GDALDataset*[3];
             datasets[0] = validDataset;
             datasets[1] = darkBandDS;
@@ -1904,7 +2140,7 @@ namespace rsgis{ namespace cmds {
             
             rsgis::calib::RSGISCalcCloudParams calcCloudParams;
             calcCloudParams.calcCloudHeightsNoThermal(tmpClumpCloudsDS, initCloudHeightsDS);
-            calcCloudParams.projFitCloudShadow(tmpClumpCloudsDS, initCloudHeightsDS, potentCloudShadowDS, cloudShadowTestRegionsDS, cloudShadowRegionsDS, sunAz, sunZen, senAz, senZen);
+            calcCloudParams.projFitCloudShadow(tmpClumpCloudsDS, initCloudHeightsDS, potentCloudShadowDS, cloudShadowTestRegionsDS, cloudShadowRegionsDS, sunAz, sunZen, senAz, senZen, numThreads);
 
             std::cout << "Apply cloud shadow majority filter...\n";
             rsgis::calib::RSGISCalcImageCloudMajorityFilter cloudShadowMajFilter = rsgis::calib::RSGISCalcImageCloudMajorityFilter();
@@ -72,6 +72,16 @@ namespace rsgis{ namespace cmds {
         float k2;
     };
     
+    struct DllExport CmdsLandsatThermalDNCoeffs
+    {
+        std::string bandName;
+        unsigned int band;
+        float multiVal;
+        float addVal;
+        float k1;
+        float k2;
+    };
+    
     struct DllExport CmdsLandsatRadianceGainsOffsetsMultiAdd
     {
         std::string imagePath;
@@ -153,6 +163,9 @@ namespace rsgis{ namespace cmds {
     /** Function to convert radiance into surface reflectance using a LUT for surface elevation of 6S */
     DllExport void executeRad2SREFElevLUT6sParams(std::string inputRadImage, std::string inputDEM, std::string outputImage, std::string gdalFormat, rsgis::RSGISLibDataType rsgisOutDataType, float scaleFactor, std::vector<Cmds6SElevationLUT> *lut, float noDataVal, bool useNoDataVal);
     
+    /** Function to convert Landsat DN to surface reflectance, using a LUT for surface elevation of 6S, in a single pass with optional radiance and TOA reflectance outputs (not written if the image path is empty) */
+    DllExport void executeLandsat2SREFElevLUT6sParams(std::vector<CmdsLandsatRadianceGainsOffsetsMultiAdd> landsatRadGainOffs, std::string inputDEM, std::string outputImage, std::string gdalFormat, rsgis::RSGISLibDataType rsgisOutDataType, float scaleFactor, std::vector<Cmds6SElevationLUT> *lut, float noDataVal, bool useNoDataVal, std::string outputRadImage, std::string outputTOAImage, rsgis::RSGISLibDataType toaOutDataType, float toaScaleFactor, unsigned int julianDay, float solarZenith, float *solarIrradiance, unsigned int numSolarIrrVals, unsigned int numThreads=1);
+    
     /** Function to convert radiance into surface reflectance using a LUT for surface elevation and AOT of 6S */
     DllExport void executeRad2SREFElevAOTLUT6sParams(std::string inputRadImage, std::string inputDEM, std::string inputAOTImg, std::string outputImage, std::string gdalFormat, rsgis::RSGISLibDataType rsgisOutDataType, float scaleFactor, std::vector<Cmds6SBaseElevAOTLUT> *lut, float noDataVal, bool useNoDataVal);
     
@@ -162,17 +175,22 @@ namespace rsgis{ namespace cmds {
     /** Function to convert thermal radiance to thermal brightness for Landsat */
     DllExport void executeLandsatThermalRad2ThermalBrightness(std::string inputImage, std::string outputImage, std::string gdalFormat, rsgis::RSGISLibDataType rsgisOutDataType, float scaleFactor, std::vector<CmdsLandsatThermalCoeffs> landsatThermalCoeffs);
     
+    /** Function to convert thermal DNs to thermal brightness for Landsat in one step (with a look up table for 8 and 16 bit DNs) */
+    DllExport void executeLandsatThermalDN2ThermalBrightness(std::string inputImage, std::string outputImage, std::string gdalFormat, rsgis::RSGISLibDataType rsgisOutDataType, float scaleFactor, std::vector<CmdsLandsatThermalDNCoeffs> landsatThermalCoeffs);
+    
     /** Function to generate a per-band image band mask of the saturated image pixels */
     DllExport void executeGenerateSaturationMask(std::string outputImage, std::string gdalFormat, std::vector<CmdsSaturatedPixel> imgBandInfo);
     
     /** Function to apply the FMask algorithm for classifying cloud for Landsat TM and ETM+ data */
-    DllExport void executeLandsatTMCloudFMask(std::string inputTOAImage, std::string inputThermalImage, std::string inputSaturateImage, std::string validImg, std::string outputImage, std::string gdalFormat, double sunAz, double sunZen, double senAz, double senZen, float whitenessThreshold, float scaleFactorIn, std::string tmpImgsBase, std::string tmpImgFileExt, bool rmTmpImgs=true);
+    DllExport void executeLandsatTMCloudFMask(std::string inputTOAImage, std::string inputThermalImage, std::string inputSaturateImage, std::string validImg, std::string outputImage, std::string gdalFormat, double sunAz, double sunZen, double senAz, double senZen, float whitenessThreshold, float scaleFactorIn, std::string tmpImgsBase, std::string tmpImgFileExt, bool rmTmpImgs=true, unsigned int numThreads=1);
     
     /** Function to apply DOS offsets (per band) to the input image */
     DllExport void executeApplySubtractSingleOffsets(std::string inputImage, std::string outputImage, std::vector<double> offsetValues, bool nonNegative, std::string gdalFormat, rsgis::RSGISLibDataType rsgisOutDataType, float noDataVal, bool useNoDataVal, float darkObjReflVal);
     
-    /** Function to calculate the view angle across the swath of a nadir input image */
-    DllExport void executeCalcNadirImageViewAngle(std::string imgFootprint, std::string outViewAngleImg, std::string gdalFormat, double sateAltitude, std::string minXXCol, std::string minXYCol, std::string maxXXCol, std::string maxXYCol, std::string minYXCol, std::string minYYCol, std::string maxYXCol, std::string maxYYCol);
+    /** Function to calculate the view angle across the swath of a nadir input image, interpolated
+        from a grid with gridSpacing pixels (0 calculates every pixel) where the estimated error
+        is within maxGridError degrees */
+    DllExport void executeCalcNadirImageViewAngle(std::string imgFootprint, std::string outViewAngleImg, std::string gdalFormat, double sateAltitude, std::string minXXCol, std::string minXYCol, std::string maxXXCol, std::string maxXYCol, std::string minYXCol, std::string minYYCol, std::string maxYXCol, std::string maxYYCol, unsigned int gridSpacing=64, double maxGridError=0.001);
     
     /** Function to calculate the total, direct and diffuse irradiance using a LUT from 6S */
     DllExport void executeCalcIrradianceElevLUT(std::string inputDataMaskImg, std::string inputDEMImg, std::string inputIncidenceAngleImg, std::string inputSlopeImg, std::string shadowMaskImg, std::string srefInputImage, std::string outputImg, std::string gdalFormat, float solarZenith, float reflScaleFactor, std::vector<Cmds6SElevationLUT> *lut);
@@ -187,7 +205,7 @@ namespace rsgis{ namespace cmds {
     DllExport float executeGetEarthSunDistance(unsigned int julianDay);
     
     /** Function to identify cloud shadows */
-    DllExport void executePerformCloudShadowMasking(std::string cloudMsk, std::string inputImage, std::string validAreaImage, unsigned int darkFillBand, std::string outputImg, std::string gdalFormat, float scaleFactorIn, std::string tmpImgsBase, std::string tmpImgFileExt, bool rmTmpImgs, double sunAz, double sunZen, double senAz, double senZen);
+    DllExport void executePerformCloudShadowMasking(std::string cloudMsk, std::string inputImage, std::string validAreaImage, unsigned int darkFillBand, std::string outputImg, std::string gdalFormat, float scaleFactorIn, std::string tmpImgsBase, std::string tmpImgFileExt, bool rmTmpImgs, double sunAz, double sunZen, double senAz, double senZen, unsigned int numThreads=1);
     
 }}
 
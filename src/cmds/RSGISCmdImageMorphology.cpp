@@ -21,6 +21,7 @@
  */
 
 #include "RSGISCmdImageMorphology.h"
+#include "common/RSGISGDALInit.h"
 #include "RSGISCmdParent.h"
 
 #include "img/RSGISCalcImage.h"
@@ -72,7 +73,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -117,7 +118,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -162,7 +163,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -207,7 +208,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -252,7 +253,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -297,7 +298,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -342,7 +343,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -397,7 +398,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -452,7 +453,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -503,7 +504,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -554,7 +555,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -605,7 +606,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
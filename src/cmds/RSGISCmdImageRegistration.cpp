@@ -23,6 +23,7 @@
 #include <boost/filesystem.hpp>
 
 #include "RSGISCmdImageRegistration.h"
+#include "common/RSGISGDALInit.h"
 #include "RSGISCmdParent.h"
 
 #include "registration/RSGISImageRegistration.h"
@@ -32,11 +33,14 @@
 #include "registration/RSGISSingleConnectLayerImageRegistration.h"
 #include "registration/RSGISAddGCPsGDAL.h"
 #include "registration/RSGISFindImageOffset.h"
+#include "registration/RSGISWarpImageGCPs.h"
 
 
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcImage.h"
 #include "img/RSGISCopyImage.h"
+#include "img/RSGISImageUtils.h"
+#include "img/RSGISImagePointSampler.h"
 
 #include "utils/RSGISTextUtils.h"
 
@@ -55,7 +59,7 @@ namespace rsgis{ namespace cmds {
         try
         {
             rsgis::utils::RSGISTextUtils txtUtils;
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *inRefDataset = nullptr;
             GDALDataset *inFloatDataset = nullptr;
 
@@ -178,15 +182,59 @@ namespace rsgis{ namespace cmds {
         return imgOffsets;
     }
 
+    std::pair<double, double> excecuteFindImageOffsetPhaseCorr(std::string inputReferenceImage, std::string inputFloatingmage,
+                                                               std::vector<unsigned int> refImageBands,
+                                                               std::vector<unsigned int> fltImageBands,
+                                                               unsigned int xSearch, unsigned int ySearch,
+                                                               bool calcSubPixelRes, unsigned int tileSize)
+    {
+        std::pair<double, double> imgOffsets;
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            GDALDataset *inRefDataset = (GDALDataset *) GDALOpenShared(inputReferenceImage.c_str(), GA_ReadOnly);
+            if(inRefDataset == nullptr)
+            {
+                std::string message = std::string("Could not open image ") + inputReferenceImage;
+                throw rsgis::RSGISException(message.c_str());
+            }
+
+            GDALDataset *inFloatDataset = (GDALDataset *) GDALOpenShared(inputFloatingmage.c_str(), GA_ReadOnly);
+            if(inFloatDataset == nullptr)
+            {
+                GDALClose(inRefDataset);
+                std::string message = std::string("Could not open image ") + inputFloatingmage;
+                throw rsgis::RSGISException(message.c_str());
+            }
+
+            rsgis::reg::RSGISFindImageOffset findImageOffset;
+            imgOffsets = findImageOffset.findImageOffsetPhaseCorr(inRefDataset, inFloatDataset, refImageBands, fltImageBands,
+                                                                  xSearch, ySearch, calcSubPixelRes, tileSize);
+
+            GDALClose(inRefDataset);
+            GDALClose(inFloatDataset);
+        }
+        catch(RSGISException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+
+        return imgOffsets;
+    }
+
     void excecuteBasicRegistration(std::string inputReferenceImage, std::string inputFloatingmage, int gcpGap,
                                                   float metricThreshold, int windowSize, int searchArea, float stdDevRefThreshold,
                                                   float stdDevFloatThreshold, int subPixelResolution, unsigned int metricTypeInt,
-                                                  unsigned int outputType, std::string outputGCPFile) 
+                                                  unsigned int outputType, std::string outputGCPFile, unsigned int numThreads)
     {
         
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *inRefDataset = nullptr;
             GDALDataset *inFloatDataset = nullptr;
             
@@ -229,6 +277,7 @@ namespace rsgis{ namespace cmds {
             rsgis::reg::RSGISImageRegistration *regImgs = new rsgis::reg::RSGISBasicImageRegistration(inRefDataset, inFloatDataset, gcpGap, metricThreshold,
                                                                                                       windowSize, searchArea, similarityMetric, stdDevRefThreshold,
                                                                                                       stdDevFloatThreshold, subPixelResolution);
+            regImgs->setNumThreads(numThreads);
             
             regImgs->runCompleteRegistration();
             
@@ -269,12 +318,12 @@ namespace rsgis{ namespace cmds {
                                                   float metricThreshold, int windowSize, int searchArea, float stdDevRefThreshold,
                                                   float stdDevFloatThreshold, int subPixelResolution, int distanceThreshold,
                                                   int maxNumIterations, float moveChangeThreshold, float pSmoothness, unsigned int metricTypeInt,
-                                                  unsigned int outputType, std::string outputGCPFile) 
+                                                  unsigned int outputType, std::string outputGCPFile, unsigned int numThreads)
     {
                 
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *inRefDataset = nullptr;
             GDALDataset *inFloatDataset = nullptr;
             
@@ -320,6 +369,7 @@ namespace rsgis{ namespace cmds {
                                                                                                                    stdDevFloatThreshold, subPixelResolution,
                                                                                                                    distanceThreshold, maxNumIterations,
                                                                                                                    moveChangeThreshold, pSmoothness);
+            regImgs->setNumThreads(numThreads);
             
             regImgs->runCompleteRegistration();
             
@@ -380,7 +430,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             std::cout << inputImage << std::endl;
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
@@ -423,6 +473,83 @@ namespace rsgis{ namespace cmds {
         }
     }
     
+    void executeWarpImgWithGCPs(std::string inputRefImage, std::string inputImage, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, unsigned int interpMethod, bool useTPS, unsigned int polyOrder)
+    {
+        try
+        {
+            rsgis::img::RSGISPointSampleInterp interp = rsgis::img::pointSampleNearest;
+            if(interpMethod == 0)
+            {
+                interp = rsgis::img::pointSampleNearest;
+            }
+            else if(interpMethod == 1)
+            {
+                interp = rsgis::img::pointSampleBilinear;
+            }
+            else if(interpMethod == 2)
+            {
+                interp = rsgis::img::pointSampleCubic;
+            }
+            else
+            {
+                throw rsgis::RSGISException("The interpolation method must be 0 (nearest), 1 (bilinear) or 2 (cubic).");
+            }
+            
+            rsgis::RSGISGDALInit::init();
+            GDALDataset *refDataset = (GDALDataset *) GDALOpen(inputRefImage.c_str(), GA_ReadOnly);
+            if(refDataset == nullptr)
+            {
+                std::string message = std::string("Could not open image ") + inputRefImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(dataset == nullptr)
+            {
+                GDALClose(refDataset);
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            std::vector<double> mapX;
+            std::vector<double> mapY;
+            std::vector<double> pxlX;
+            std::vector<double> pxlY;
+            rsgis::reg::RSGISWarpImageGCPs::readImageGCPs(dataset, &mapX, &mapY, &pxlX, &pxlY);
+            rsgis::reg::RSGISGCPTransform transform = rsgis::reg::RSGISGCPTransform(mapX, mapY, pxlX, pxlY, useTPS, polyOrder);
+            
+            int noDataValAvail = false;
+            double noDataVal = dataset->GetRasterBand(1)->GetNoDataValue(&noDataValAvail);
+            if(!noDataValAvail)
+            {
+                noDataVal = 0.0;
+            }
+            
+            unsigned int numBands = dataset->GetRasterCount();
+            rsgis::img::RSGISImageUtils imgUtils;
+            GDALDataset *outDataset = imgUtils.createCopy(refDataset, numBands, outputImage, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
+            for(unsigned int i = 0; i < numBands; ++i)
+            {
+                outDataset->GetRasterBand(i+1)->SetNoDataValue(noDataVal);
+            }
+            
+            rsgis::reg::RSGISWarpImageGCPs warpImage;
+            warpImage.warpImage(dataset, outDataset, &transform, interp, noDataVal, noDataValAvail);
+            
+            GDALClose(outDataset);
+            GDALClose(dataset);
+            GDALClose(refDataset);
+        }
+        catch(RSGISException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+    
     
     
 }}
@@ -53,24 +53,34 @@ namespace rsgis{ namespace cmds {
                                                                 unsigned int metricTypeInt,
                                                                 int subPixelResolution);
 
+    /** Find the image offset using phase correlation, optionally as the median over tiles of tileSize pixels */
+    DllExport std::pair<double, double> excecuteFindImageOffsetPhaseCorr(std::string inputReferenceImage, std::string inputFloatingmage,
+                                                                         std::vector<unsigned int> refImageBands,
+                                                                         std::vector<unsigned int> fltImageBands,
+                                                                         unsigned int xSearch, unsigned int ySearch,
+                                                                         bool calcSubPixelRes, unsigned int tileSize);
+
     /** Basic image registration */
     DllExport void excecuteBasicRegistration(std::string inputReferenceImage, std::string inputFloatingmage, int gcpGap,
                                    float metricThreshold, int windowSize, int searchArea, float stdDevRefThreshold,
                                    float stdDevFloatThreshold, int subPixelResolution, unsigned int metricTypeInt,
-                                   unsigned int outputType, std::string outputGCPFile);
+                                   unsigned int outputType, std::string outputGCPFile, unsigned int numThreads=1);
     
     /** Single connected layer image registration */
     DllExport void excecuteSingleLayerConnectedRegistration(std::string inputReferenceImage, std::string inputFloatingmage, int gcpGap,
                                                   float metricThreshold, int windowSize, int searchArea, float stdDevRefThreshold,
                                                   float stdDevFloatThreshold, int subPixelResolution, int distanceThreshold,
                                                   int maxNumIterations, float moveChangeThreshold, float pSmoothness, unsigned int metricTypeInt,
-                                                  unsigned int outputType, std::string outputGCPFile);
+                                                  unsigned int outputType, std::string outputGCPFile, unsigned int numThreads=1);
 
     /** Add tie points to GCP */
     DllExport void excecuteAddGCPsGDAL(std::string inputImage, std::string inputGCPs, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType);
     
     /** Apply offset to image file */
     DllExport void executeApplyOffset2Image(std::string inputImage, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, double xOff, double yOff);
+    
+    /** Warp an image onto the pixel grid of a reference image using the GCPs in the image header (interpMethod: 0 nearest, 1 bilinear, 2 cubic). */
+    DllExport void executeWarpImgWithGCPs(std::string inputRefImage, std::string inputImage, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, unsigned int interpMethod, bool useTPS, unsigned int polyOrder);
 }}
 
 
@@ -24,8 +24,13 @@
 
 #include "RSGISCmdImageUtils.h"
 #include "RSGISCmdParent.h"
+#include "RSGISCmdResultCache.h"
 
 #include "common/RSGISImageException.h"
+#include "common/RSGISStripIOPipeline.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISOpenCL.h"
+#include "common/RSGISGDALInit.h"
 
 #include "utils/RSGISGeometryUtils.h"
 
@@ -38,12 +43,20 @@
 #include "img/RSGISCopyImage.h"
 #include "img/RSGISStretchImage.h"
 #include "img/RSGISMaskImage.h"
+#include "img/RSGISImageBitMask.h"
+#include "img/RSGISImageBitFields.h"
 #include "img/RSGISImageMosaic.h"
 #include "img/RSGISPopWithStats.h"
+#include "img/RSGISImagePyramids.h"
 #include "img/RSGISImageComposite.h"
 #include "img/RSGISSampleImage.h"
+#include "img/RSGISClassPixelIndex.h"
 #include "img/RSGISPanSharpen.h"
 #include "img/RSGISSharpenLowResImagery.h"
+#include "img/RSGISImagePointSampler.h"
+#include "img/RSGISImageTileCutter.h"
+#include "img/RSGISTemporalSummary.h"
+#include "img/RSGISDistanceTransform.h"
 
 #include "rastergis/RSGISCalcImageStatsAndPyramids.h"
 #include "rastergis/RSGISRasterAttUtils.h"
@@ -57,7 +70,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset *inDataset = (GDALDataset *) GDALOpenShared(inputImage.c_str(), GA_ReadOnly);
             if(inDataset == NULL)
@@ -77,6 +90,10 @@ namespace rsgis{ namespace cmds {
             {
                 stretchImg.executeLinearPercentStretch(stretchParam);
             }
+            else if(stretchType == approxPercentile)
+            {
+                stretchImg.executeApproxPercentileStretch(stretchParam);
+            }
             else if(stretchType == linearStdDev)
             {
                 stretchImg.executeLinearStdDevStretch(stretchParam);
@@ -118,7 +135,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset *inDataset = (GDALDataset *) GDALOpenShared(inputImage.c_str(), GA_ReadOnly);
             if(inDataset == NULL)
@@ -169,7 +186,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *inDataset = (GDALDataset *) GDALOpenShared(inputImage.c_str(), GA_ReadOnly);
             if(inDataset == NULL)
@@ -187,6 +204,10 @@ namespace rsgis{ namespace cmds {
             {
                 stretchImg.executeLinearPercentStretch(stretchParam);
             }
+            else if(stretchType == approxPercentile)
+            {
+                stretchImg.executeApproxPercentileStretch(stretchParam);
+            }
             else if(stretchType == linearStdDev)
             {
                 stretchImg.executeLinearStdDevStretch(stretchParam);
@@ -224,11 +245,17 @@ namespace rsgis{ namespace cmds {
         }
     }
 
-    void executeMaskImage(std::string inputImage, std::string imageMask, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, float outValue, std::vector<float> maskValues)
+    void executeMaskImage(std::string inputImage, std::string imageMask, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, float outValue, std::vector<float> maskValues, unsigned int numThreads)
+    {
+        std::vector<double> outValues(maskValues.size(), outValue);
+        executeMaskImage(inputImage, imageMask, outputImage, gdalFormat, outDataType, maskValues, outValues, numThreads);
+    }
+
+    void executeMaskImage(std::string inputImage, std::string imageMask, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, std::vector<float> maskValues, std::vector<double> outValues, unsigned int numThreads)
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpenShared(inputImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -244,7 +271,16 @@ namespace rsgis{ namespace cmds {
             }
 
             rsgis::img::RSGISMaskImage maskImage =  rsgis::img::RSGISMaskImage();
-            maskImage.maskImage(dataset, mask, outputImage, gdalFormat, RSGIS_to_GDAL_Type(outDataType), outValue, maskValues);
+            try
+            {
+                maskImage.maskImage(dataset, mask, outputImage, gdalFormat, RSGIS_to_GDAL_Type(outDataType), maskValues, outValues, numThreads);
+            }
+            catch(RSGISException& e)
+            {
+                GDALClose(dataset);
+                GDALClose(mask);
+                throw e;
+            }
 
             GDALClose(dataset);
             GDALClose(mask);
@@ -259,10 +295,10 @@ namespace rsgis{ namespace cmds {
         }
     }
 
-    void executeCreateTiles(std::string inputImage, std::string outputImageBase, unsigned int width, unsigned int height, unsigned int tileOverlap, bool offsetTiling, std::string gdalFormat, RSGISLibDataType outDataType, std::string outFileExtension, std::vector<std::string> *outFileNames)
+    void executeCreateTiles(std::string inputImage, std::string outputImageBase, unsigned int width, unsigned int height, unsigned int tileOverlap, bool offsetTiling, std::string gdalFormat, RSGISLibDataType outDataType, std::string outFileExtension, std::vector<std::string> *outFileNames, unsigned int numThreads)
     {
         std::cout.precision(12);
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         
         try
         {
@@ -273,8 +309,6 @@ namespace rsgis{ namespace cmds {
                 throw RSGISCmdException("Output file path specified does not exist.");
             }
 
-            rsgis::img::RSGISImageUtils imgUtils;
-            rsgis::utils::RSGISGeometryUtils geomUtils;
             // Open Image
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
@@ -283,25 +317,12 @@ namespace rsgis{ namespace cmds {
                 throw RSGISCmdException(message.c_str());
             }
             
-            // Set up envlopes for image tiles
-            std::vector<OGREnvelope*> *tileEnvelopes = new std::vector<OGREnvelope*>;
+            // Set up the pixel windows of the image tiles
+            std::vector<rsgis::img::RSGISImageTile> tiles;
             
-            int numImageBands = dataset->GetRasterCount();
             unsigned int imgSizeX = dataset->GetRasterXSize();
             unsigned int imgSizeY = dataset->GetRasterYSize();
             
-            double *gdalTransform = new double[6];
-            dataset->GetGeoTransform( gdalTransform );
-            double pxlXRes = gdalTransform[1];
-            double pxlYRes = gdalTransform[5];
-            if(pxlYRes < 0)
-            {
-                pxlYRes = pxlYRes * (-1);
-            }
-            double imgTLX = gdalTransform[0];
-            double imgTLY = gdalTransform[3];
-            delete[] gdalTransform;
-            
             if(offsetTiling)
             {
                 unsigned int xOff = width/2;
@@ -322,11 +343,6 @@ namespace rsgis{ namespace cmds {
                 long tileXMax = 0;
                 long tileYMin = 0;
                 long tileYMax = 0;
-                
-                double tileTLX = 0.0;
-                double tileTLY = 0.0;
-                double tileBRX = 0.0;
-                double tileBRY = 0.0;
                 if(yOff > 0)
                 {
                     cTileX = 0;
@@ -354,11 +370,7 @@ namespace rsgis{ namespace cmds {
                             tileYMax = imgSizeY;
                         }
                         
-                        tileTLX = imgTLX + (tileXMin*pxlXRes);
-                        tileTLY = imgTLY - (tileYMax*pxlYRes);
-                        tileBRX = imgTLX + (tileXMax*pxlXRes);
-                        tileBRY = imgTLY - (tileYMin*pxlYRes);
-                        tileEnvelopes->push_back(geomUtils.createOGREnvelopePointer(tileTLX, tileBRX, tileTLY, tileBRY));
+                        tiles.push_back(rsgis::img::RSGISImageTile(tileXMin, tileYMin, tileXMax-tileXMin, tileYMax-tileYMin, outputImageBase + "_tile" + boost::lexical_cast<std::string>(tiles.size()) + "." + outFileExtension));
                         
                         cTileX += xOff;
                         ++numTiles;
@@ -387,11 +399,7 @@ namespace rsgis{ namespace cmds {
                             tileYMax = imgSizeY;
                         }
                         
-                        tileTLX = imgTLX + (tileXMin*pxlXRes);
-                        tileTLY = imgTLY - (tileYMax*pxlYRes);
-                        tileBRX = imgTLX + (tileXMax*pxlXRes);
-                        tileBRY = imgTLY - (tileYMin*pxlYRes);
-                        tileEnvelopes->push_back(geomUtils.createOGREnvelopePointer(tileTLX, tileBRX, tileTLY, tileBRY));
+                        tiles.push_back(rsgis::img::RSGISImageTile(tileXMin, tileYMin, tileXMax-tileXMin, tileYMax-tileYMin, outputImageBase + "_tile" + boost::lexical_cast<std::string>(tiles.size()) + "." + outFileExtension));
                         
                         cTileX += width;
                         ++numTiles;
@@ -420,11 +428,7 @@ namespace rsgis{ namespace cmds {
                             tileYMax = imgSizeY;
                         }
                         
-                        tileTLX = imgTLX + (tileXMin*pxlXRes);
-                        tileTLY = imgTLY - (tileYMax*pxlYRes);
-                        tileBRX = imgTLX + (tileXMax*pxlXRes);
-                        tileBRY = imgTLY - (tileYMin*pxlYRes);
-                        tileEnvelopes->push_back(geomUtils.createOGREnvelopePointer(tileTLX, tileBRX, tileTLY, tileBRY));
+                        tiles.push_back(rsgis::img::RSGISImageTile(tileXMin, tileYMin, tileXMax-tileXMin, tileYMax-tileYMin, outputImageBase + "_tile" + boost::lexical_cast<std::string>(tiles.size()) + "." + outFileExtension));
                         
                         ++numTiles;
                     }
@@ -457,11 +461,7 @@ namespace rsgis{ namespace cmds {
                             tileYMax = imgSizeY;
                         }
                         
-                        tileTLX = imgTLX + (tileXMin*pxlXRes);
-                        tileTLY = imgTLY - (tileYMax*pxlYRes);
-                        tileBRX = imgTLX + (tileXMax*pxlXRes);
-                        tileBRY = imgTLY - (tileYMin*pxlYRes);
-                        tileEnvelopes->push_back(geomUtils.createOGREnvelopePointer(tileTLX, tileBRX, tileTLY, tileBRY));
+                        tiles.push_back(rsgis::img::RSGISImageTile(tileXMin, tileYMin, tileXMax-tileXMin, tileYMax-tileYMin, outputImageBase + "_tile" + boost::lexical_cast<std::string>(tiles.size()) + "." + outFileExtension));
                         
                         cTileX += xOff;
                         ++numTiles;
@@ -490,11 +490,7 @@ namespace rsgis{ namespace cmds {
                             tileYMax = imgSizeY;
                         }
                         
-                        tileTLX = imgTLX + (tileXMin*pxlXRes);
-                        tileTLY = imgTLY - (tileYMax*pxlYRes);
-                        tileBRX = imgTLX + (tileXMax*pxlXRes);
-                        tileBRY = imgTLY - (tileYMin*pxlYRes);
-                        tileEnvelopes->push_back(geomUtils.createOGREnvelopePointer(tileTLX, tileBRX, tileTLY, tileBRY));
+                        tiles.push_back(rsgis::img::RSGISImageTile(tileXMin, tileYMin, tileXMax-tileXMin, tileYMax-tileYMin, outputImageBase + "_tile" + boost::lexical_cast<std::string>(tiles.size()) + "." + outFileExtension));
                         
                         cTileX += width;
                         ++numTiles;
@@ -523,11 +519,7 @@ namespace rsgis{ namespace cmds {
                             tileYMax = imgSizeY;
                         }
                         
-                        tileTLX = imgTLX + (tileXMin*pxlXRes);
-                        tileTLY = imgTLY - (tileYMax*pxlYRes);
-                        tileBRX = imgTLX + (tileXMax*pxlXRes);
-                        tileBRY = imgTLY - (tileYMin*pxlYRes);
-                        tileEnvelopes->push_back(geomUtils.createOGREnvelopePointer(tileTLX, tileBRX, tileTLY, tileBRY));
+                        tiles.push_back(rsgis::img::RSGISImageTile(tileXMin, tileYMin, tileXMax-tileXMin, tileYMax-tileYMin, outputImageBase + "_tile" + boost::lexical_cast<std::string>(tiles.size()) + "." + outFileExtension));
                         
                         ++numTiles;
                     }
@@ -560,11 +552,7 @@ namespace rsgis{ namespace cmds {
                             tileYMax = imgSizeY;
                         }
                         
-                        tileTLX = imgTLX + (tileXMin*pxlXRes);
-                        tileTLY = imgTLY - (tileYMax*pxlYRes);
-                        tileBRX = imgTLX + (tileXMax*pxlXRes);
-                        tileBRY = imgTLY - (tileYMin*pxlYRes);
-                        tileEnvelopes->push_back(geomUtils.createOGREnvelopePointer(tileTLX, tileBRX, tileTLY, tileBRY));
+                        tiles.push_back(rsgis::img::RSGISImageTile(tileXMin, tileYMin, tileXMax-tileXMin, tileYMax-tileYMin, outputImageBase + "_tile" + boost::lexical_cast<std::string>(tiles.size()) + "." + outFileExtension));
                         
                         cTileX += xOff;
                         ++numTiles;
@@ -593,11 +581,7 @@ namespace rsgis{ namespace cmds {
                             tileYMax = imgSizeY;
                         }
                         
-                        tileTLX = imgTLX + (tileXMin*pxlXRes);
-                        tileTLY = imgTLY - (tileYMax*pxlYRes);
-                        tileBRX = imgTLX + (tileXMax*pxlXRes);
-                        tileBRY = imgTLY - (tileYMin*pxlYRes);
-                        tileEnvelopes->push_back(geomUtils.createOGREnvelopePointer(tileTLX, tileBRX, tileTLY, tileBRY));
+                        tiles.push_back(rsgis::img::RSGISImageTile(tileXMin, tileYMin, tileXMax-tileXMin, tileYMax-tileYMin, outputImageBase + "_tile" + boost::lexical_cast<std::string>(tiles.size()) + "." + outFileExtension));
                         
                         cTileX += width;
                         ++numTiles;
@@ -626,11 +610,7 @@ namespace rsgis{ namespace cmds {
                             tileYMax = imgSizeY;
                         }
                         
-                        tileTLX = imgTLX + (tileXMin*pxlXRes);
-                        tileTLY = imgTLY - (tileYMax*pxlYRes);
-                        tileBRX = imgTLX + (tileXMax*pxlXRes);
-                        tileBRY = imgTLY - (tileYMin*pxlYRes);
-                        tileEnvelopes->push_back(geomUtils.createOGREnvelopePointer(tileTLX, tileBRX, tileTLY, tileBRY));
+                        tiles.push_back(rsgis::img::RSGISImageTile(tileXMin, tileYMin, tileXMax-tileXMin, tileYMax-tileYMin, outputImageBase + "_tile" + boost::lexical_cast<std::string>(tiles.size()) + "." + outFileExtension));
                         
                         ++numTiles;
                     }
@@ -655,11 +635,6 @@ namespace rsgis{ namespace cmds {
                 long tileYMin = 0;
                 long tileYMax = 0;
                 
-                double tileTLX = 0.0;
-                double tileTLY = 0.0;
-                double tileBRX = 0.0;
-                double tileBRY = 0.0;
-                
                 for(unsigned int i = 0; i < numYTiles; ++i)
                 {
                     cTileX = 0;
@@ -687,11 +662,7 @@ namespace rsgis{ namespace cmds {
                             tileYMax = imgSizeY;
                         }
                         
-                        tileTLX = imgTLX + (tileXMin*pxlXRes);
-                        tileTLY = imgTLY - (tileYMax*pxlYRes);
-                        tileBRX = imgTLX + (tileXMax*pxlXRes);
-                        tileBRY = imgTLY - (tileYMin*pxlYRes);
-                        tileEnvelopes->push_back(geomUtils.createOGREnvelopePointer(tileTLX, tileBRX, tileTLY, tileBRY));
+                        tiles.push_back(rsgis::img::RSGISImageTile(tileXMin, tileYMin, tileXMax-tileXMin, tileYMax-tileYMin, outputImageBase + "_tile" + boost::lexical_cast<std::string>(tiles.size()) + "." + outFileExtension));
                         
                         cTileX += width;
                         ++numTiles;
@@ -720,11 +691,7 @@ namespace rsgis{ namespace cmds {
                             tileYMax = imgSizeY;
                         }
                         
-                        tileTLX = imgTLX + (tileXMin*pxlXRes);
-                        tileTLY = imgTLY - (tileYMax*pxlYRes);
-                        tileBRX = imgTLX + (tileXMax*pxlXRes);
-                        tileBRY = imgTLY - (tileYMin*pxlYRes);
-                        tileEnvelopes->push_back(geomUtils.createOGREnvelopePointer(tileTLX, tileBRX, tileTLY, tileBRY));
+                        tiles.push_back(rsgis::img::RSGISImageTile(tileXMin, tileYMin, tileXMax-tileXMin, tileYMax-tileYMin, outputImageBase + "_tile" + boost::lexical_cast<std::string>(tiles.size()) + "." + outFileExtension));
                         
                         ++numTiles;
                     }
@@ -757,11 +724,7 @@ namespace rsgis{ namespace cmds {
                             tileYMax = imgSizeY;
                         }
                         
-                        tileTLX = imgTLX + (tileXMin*pxlXRes);
-                        tileTLY = imgTLY - (tileYMax*pxlYRes);
-                        tileBRX = imgTLX + (tileXMax*pxlXRes);
-                        tileBRY = imgTLY - (tileYMin*pxlYRes);
-                        tileEnvelopes->push_back(geomUtils.createOGREnvelopePointer(tileTLX, tileBRX, tileTLY, tileBRY));
+                        tiles.push_back(rsgis::img::RSGISImageTile(tileXMin, tileYMin, tileXMax-tileXMin, tileYMax-tileYMin, outputImageBase + "_tile" + boost::lexical_cast<std::string>(tiles.size()) + "." + outFileExtension));
                         
                         cTileX += width;
                         ++numTiles;
@@ -790,37 +753,21 @@ namespace rsgis{ namespace cmds {
                             tileYMax = imgSizeY;
                         }
                         
-                        tileTLX = imgTLX + (tileXMin*pxlXRes);
-                        tileTLY = imgTLY - (tileYMax*pxlYRes);
-                        tileBRX = imgTLX + (tileXMax*pxlXRes);
-                        tileBRY = imgTLY - (tileYMin*pxlYRes);
-                        tileEnvelopes->push_back(geomUtils.createOGREnvelopePointer(tileTLX, tileBRX, tileTLY, tileBRY));
+                        tiles.push_back(rsgis::img::RSGISImageTile(tileXMin, tileYMin, tileXMax-tileXMin, tileYMax-tileYMin, outputImageBase + "_tile" + boost::lexical_cast<std::string>(tiles.size()) + "." + outFileExtension));
                         
                         ++numTiles;
                     }
                 }
             }
             
-            rsgis::img::RSGISCopyImage copyImage = rsgis::img::RSGISCopyImage(numImageBands);
-            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&copyImage, "", true);
-            
-            std::string outputFilePath = "";
-            for(unsigned int i = 0; i < tileEnvelopes->size(); ++i)
+            // The image is read once, in strips, which are scattered to the tiles.
+            rsgis::img::RSGISImageTileCutter tileCutter = rsgis::img::RSGISImageTileCutter(numThreads);
+            tileCutter.cutTiles(dataset, &tiles, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
+            if(outFileNames != NULL)
             {
-                std::cout << "Tile " << i+1 << "/" << tileEnvelopes->size() << std::endl;
-                outputFilePath = outputImageBase + "_tile" + boost::lexical_cast<std::string>(i) + "." + outFileExtension;
-                try
-                {
-                    calcImage.calcImageInEnv(&dataset, 1, outputFilePath, tileEnvelopes->at(i), false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
-
-                    if(outFileNames != NULL)
-                    {
-                        outFileNames->push_back(outputFilePath);
-                    }
-                }
-                catch (rsgis::img::RSGISImageBandException &e)
+                for(std::vector<rsgis::img::RSGISImageTile>::iterator iterTiles = tiles.begin(); iterTiles != tiles.end(); ++iterTiles)
                 {
-                    throw RSGISCmdException(e.what());
+                    outFileNames->push_back((*iterTiles).outputImage);
                 }
             }
             GDALClose(dataset);
@@ -835,11 +782,66 @@ namespace rsgis{ namespace cmds {
         }
     }
 
-    void executePopulateImgStats(std::string inputImage, bool useIgnoreVal, float nodataValue, bool calcImgPyramids, std::vector<int> pyraScaleVals)
+    void executeCreateTilesFromMasks(std::string inputImage, std::vector<std::string> maskImages, std::vector<std::string> outputImages, std::string gdalFormat, RSGISLibDataType outDataType, float outValue, float maskValue, unsigned int numThreads)
+    {
+        rsgis::RSGISGDALInit::init();
+        try
+        {
+            if(maskImages.size() != outputImages.size())
+            {
+                throw RSGISCmdException("The number of mask images and output images must be the same.");
+            }
+            
+            GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw RSGISCmdException(message.c_str());
+            }
+            
+            // Each tile covers the whole image, with the pixels outside its mask given the out value.
+            std::vector<rsgis::img::RSGISImageTile> tiles;
+            for(size_t i = 0; i < maskImages.size(); ++i)
+            {
+                tiles.push_back(rsgis::img::RSGISImageTile(0, 0, dataset->GetRasterXSize(), dataset->GetRasterYSize(), outputImages.at(i), maskImages.at(i)));
+            }
+            
+            rsgis::img::RSGISImageTileCutter tileCutter = rsgis::img::RSGISImageTileCutter(numThreads);
+            tileCutter.cutTiles(dataset, &tiles, gdalFormat, RSGIS_to_GDAL_Type(outDataType), maskValue, outValue);
+            
+            GDALClose(dataset);
+        }
+        catch(rsgis::RSGISException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+
+    void executePopulateImgStats(std::string inputImage, bool useIgnoreVal, float nodataValue, bool calcImgPyramids, std::vector<int> pyraScaleVals, unsigned int numThreads)
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
+
+            // The statistics are added to the image, so nothing needs to be done where
+            // the image is as it was left by the same command.
+            RSGISCmdResultCache resultCache("executePopulateImgStats");
+            resultCache.addParam("use_no_data", useIgnoreVal);
+            resultCache.addParam("no_data_val", nodataValue);
+            resultCache.addParam("pyramids", calcImgPyramids);
+            for(size_t i = 0; i < pyraScaleVals.size(); ++i)
+            {
+                resultCache.addParam("pyramid_scale", pyraScaleVals[i]);
+            }
+            resultCache.addParam("preview_factor", rsgis::RSGISExecutionContextUtils::getDefaultContext().previewFactor);
+            if(resultCache.isInPlaceResult(inputImage))
+            {
+                return;
+            }
             
             GDALDataset *inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_Update);
             if(inDataset == NULL)
@@ -849,10 +851,12 @@ namespace rsgis{ namespace cmds {
             }
 
             rsgis::img::RSGISPopWithStats popWithStats;
-            popWithStats.calcPopStats( inDataset, useIgnoreVal, nodataValue, calcImgPyramids, pyraScaleVals);
+            popWithStats.calcPopStats( inDataset, useIgnoreVal, nodataValue, calcImgPyramids, pyraScaleVals, numThreads);
 
 
             GDALClose(inDataset);
+
+            resultCache.storeInPlaceResult(inputImage);
         }
         catch(rsgis::RSGISException& e)
         {
@@ -864,14 +868,40 @@ namespace rsgis{ namespace cmds {
         }
     }
 
-    void executeImageMosaic(std::string *inputImages, int numDS, std::string outputImage, float background, float skipVal, unsigned int skipBand, unsigned int overlapBehaviour, std::string format, RSGISLibDataType outDataType) 
+    void executeImageMosaic(std::string *inputImages, int numDS, std::string outputImage, float background, float skipVal, unsigned int skipBand, unsigned int overlapBehaviour, std::string format, RSGISLibDataType outDataType, unsigned int numThreads, std::string outRefImage) 
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         try
         {
             rsgis::img::RSGISImageMosaic mosaic;
+            mosaic.setNumThreads(numThreads);
+            mosaic.setOutputRefImage(outRefImage, "KEA");
             // Projection hardcoded to from image (to simplify interface)
             mosaic.mosaicSkipVals(inputImages, numDS, outputImage, background, skipVal, true, "", skipBand, overlapBehaviour, format, RSGIS_to_GDAL_Type(outDataType));
+
+            if(outRefImage != "")
+            {
+                // Row 0 is the pixels which had no input.
+                GDALDataset *refDataset = (GDALDataset *) GDALOpen(outRefImage.c_str(), GA_Update);
+                if(refDataset == NULL)
+                {
+                    std::string message = std::string("Could not open image ") + outRefImage;
+                    throw RSGISImageException(message.c_str());
+                }
+                std::string *strFileNameArr = new std::string[numDS+1];
+                strFileNameArr[0] = "";
+                for(int i = 0; i < numDS; ++i)
+                {
+                    strFileNameArr[i+1] = inputImages[i];
+                }
+                rsgis::rastergis::RSGISRasterAttUtils ratUtils;
+                GDALRasterAttributeTable *gdalRAT = refDataset->GetRasterBand(1)->GetDefaultRAT();
+                gdalRAT->SetRowCount(numDS+1);
+                ratUtils.writeStrColumn(gdalRAT, "FileName", strFileNameArr, numDS+1);
+                delete[] strFileNameArr;
+                refDataset->GetRasterBand(1)->SetMetadataItem("LAYER_TYPE", "thematic");
+                GDALClose(refDataset);
+            }
         }
         catch (RSGISImageException& e)
         {
@@ -883,14 +913,127 @@ namespace rsgis{ namespace cmds {
         }
     }
 
-    std::vector<std::string> executeOrderImageUsingValidDataProp(std::vector<std::string> images, float noDataValue) 
+    void executeImageMosaicUpdate(std::string *inputImages, int numDS, std::string mosaicImage, std::string refImage, float background, float skipVal, unsigned int skipBand, unsigned int overlapBehaviour, bool updateStats, bool updateOverviews, unsigned int numThreads)
+    {
+        rsgis::RSGISGDALInit::init();
+        GDALDataset *mosaicDataset = NULL;
+        GDALDataset *refDataset = NULL;
+        rsgis::img::RSGISPopStatsUpdater *statsUpdater = NULL;
+        try
+        {
+            mosaicDataset = (GDALDataset *) GDALOpen(mosaicImage.c_str(), GA_Update);
+            if(mosaicDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + mosaicImage;
+                throw RSGISImageException(message.c_str());
+            }
+
+            rsgis::img::RSGISBlockMosaic blockMosaic;
+            blockMosaic.setSkipValue(skipVal, skipBand);
+            blockMosaic.setOverlapBehaviour(overlapBehaviour);
+            blockMosaic.setNumThreads(numThreads);
+
+            // The new images are appended to the rows of the reference image attribute table.
+            rsgis::rastergis::RSGISRasterAttUtils ratUtils;
+            std::vector<std::string> *refFileNames = NULL;
+            if(refImage != "")
+            {
+                refDataset = (GDALDataset *) GDALOpen(refImage.c_str(), GA_Update);
+                if(refDataset == NULL)
+                {
+                    std::string message = std::string("Could not open image ") + refImage;
+                    throw RSGISImageException(message.c_str());
+                }
+                refFileNames = ratUtils.readStrColumnAsVec(refDataset->GetRasterBand(1)->GetDefaultRAT(), "FileName");
+                if(refFileNames->empty())
+                {
+                    refFileNames->push_back("");
+                }
+                blockMosaic.setRefBand(refDataset->GetRasterBand(1), refFileNames->size());
+            }
+
+            if(updateStats)
+            {
+                statsUpdater = new rsgis::img::RSGISPopStatsUpdater(mosaicDataset);
+                blockMosaic.setStatsUpdater(statsUpdater);
+            }
+
+            blockMosaic.update(inputImages, numDS, mosaicDataset, background);
+
+            if(statsUpdater != NULL)
+            {
+                statsUpdater->updateStats(mosaicDataset);
+                delete statsUpdater;
+                statsUpdater = NULL;
+            }
+
+            int xOff = 0;
+            int yOff = 0;
+            int xSize = 0;
+            int ySize = 0;
+            bool pxlsChanged = blockMosaic.getChangedRegion(&xOff, &yOff, &xSize, &ySize);
+            if(updateOverviews && pxlsChanged)
+            {
+                rsgis::img::RSGISImagePyramidBuilder mosaicPyramids(rsgis::img::pyramidAverage, numThreads);
+                mosaicPyramids.updatePyramids(mosaicDataset, xOff, yOff, xSize, ySize);
+            }
+
+            if(refDataset != NULL)
+            {
+                std::vector<std::string> fileNames = *refFileNames;
+                delete refFileNames;
+                for(int i = 0; i < numDS; ++i)
+                {
+                    fileNames.push_back(inputImages[i]);
+                }
+                GDALRasterAttributeTable *gdalRAT = refDataset->GetRasterBand(1)->GetDefaultRAT();
+                gdalRAT->SetRowCount(fileNames.size());
+                ratUtils.writeStrColumn(gdalRAT, "FileName", fileNames.data(), fileNames.size());
+                if(updateOverviews && pxlsChanged)
+                {
+                    rsgis::img::RSGISImagePyramidBuilder refPyramids(rsgis::img::pyramidNearest, numThreads);
+                    refPyramids.updatePyramids(refDataset, xOff, yOff, xSize, ySize);
+                }
+                GDALClose(refDataset);
+                refDataset = NULL;
+            }
+            GDALClose(mosaicDataset);
+        }
+        catch (rsgis::RSGISException& e)
+        {
+            if(statsUpdater != NULL)
+            {
+                delete statsUpdater;
+            }
+            if(refDataset != NULL)
+            {
+                GDALClose(refDataset);
+            }
+            if(mosaicDataset != NULL)
+            {
+                GDALClose(mosaicDataset);
+            }
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+
+    std::vector<std::string> executeOrderImageUsingValidDataProp(std::vector<std::string> images, float noDataValue, unsigned int estMode, float errTolerance, unsigned int numThreads) 
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         std::vector<std::string> orderedImages;
         try
         {
+            if(estMode > rsgis::img::rsgis_validest_sample)
+            {
+                throw RSGISCmdException("The valid data estimation mode was not recognised.");
+            }
             rsgis::img::RSGISImageMosaic mosaic;
-            mosaic.orderInImagesValidData(images, &orderedImages, noDataValue);
+            mosaic.setNumThreads(numThreads);
+            mosaic.orderInImagesValidData(images, &orderedImages, noDataValue, (rsgis::img::RSGISValidDataEstimate)estMode, errTolerance);
         }
         catch (RSGISImageException& e)
         {
@@ -903,11 +1046,11 @@ namespace rsgis{ namespace cmds {
         return orderedImages;
     }
 
-    void executeImageInclude(std::string *inputImages, int numDS, std::string baseImage, bool bandsDefined, std::vector<int> bands, float skipVal, bool useSkipVal) 
+    void executeImageInclude(std::string *inputImages, int numDS, std::string baseImage, bool bandsDefined, std::vector<int> bands, float skipVal, bool useSkipVal, unsigned int numThreads) 
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset *baseDS = (GDALDataset *) GDALOpenShared(baseImage.c_str(), GA_Update);
             if(baseDS == NULL)
@@ -917,6 +1060,7 @@ namespace rsgis{ namespace cmds {
             }
 
             rsgis::img::RSGISImageMosaic mosaic;
+            mosaic.setNumThreads(numThreads);
             if(useSkipVal)
             {
                 mosaic.includeDatasetsSkipVals(baseDS, inputImages, numDS, bands, bandsDefined, skipVal);
@@ -943,7 +1087,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *baseDS = (GDALDataset *) GDALOpenShared(baseImage.c_str(), GA_Update);
             if(baseDS == NULL)
@@ -972,7 +1116,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *baseDS = (GDALDataset *) GDALOpenShared(baseImage.c_str(), GA_Update);
             if(baseDS == NULL)
@@ -1024,7 +1168,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *baseDS = (GDALDataset *) GDALOpenShared(baseImage.c_str(), GA_Update);
             if(baseDS == NULL)
@@ -1052,7 +1196,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *inDataset = NULL;
             inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_Update);
             if(inDataset == NULL)
@@ -1090,7 +1234,7 @@ namespace rsgis{ namespace cmds {
         try
         {
             std::cout.precision(12);
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *inDataset = NULL;
             inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_Update);
             if(inDataset == NULL)
@@ -1150,7 +1294,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *refDataset = (GDALDataset *) GDALOpen(refImageFile.c_str(), GA_ReadOnly);
             if(refDataset == NULL)
             {
@@ -1182,7 +1326,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *refDataset = (GDALDataset *) GDALOpen(refImageFile.c_str(), GA_ReadOnly);
             if(refDataset == NULL)
             {
@@ -1227,11 +1371,15 @@ namespace rsgis{ namespace cmds {
     }
 
 
-    void executeStackImageBands(std::string *imageFiles, std::string *imageBandNames, int numImages, std::string outputImage, bool skipPixels, float skipValue, float noDataValue, std::string gdalFormat, RSGISLibDataType outDataType, bool replaceBandNames)
+    void executeStackImageBands(std::string *imageFiles, std::string *imageBandNames, int numImages, std::string outputImage, bool skipPixels, float skipValue, float noDataValue, std::string gdalFormat, RSGISLibDataType outDataType, bool replaceBandNames, unsigned int numThreads)
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
+            if(skipPixels && (gdalFormat == "VRT"))
+            {
+                throw RSGISCmdException("Pixels cannot be skipped when the output is a VRT.");
+            }
             std::cout << "There are " << numImages << " images to stack\n";
             GDALDataset **datasets = new GDALDataset*[numImages];
             for(int i = 0; i < numImages; i++)
@@ -1246,7 +1394,19 @@ namespace rsgis{ namespace cmds {
             }
 
             rsgis::img::RSGISAddBands stackbands;
-            stackbands.stackImages(datasets, numImages, outputImage, imageBandNames, skipPixels, skipValue, noDataValue, gdalFormat, RSGIS_to_GDAL_Type(outDataType), replaceBandNames);
+            if(gdalFormat == "VRT")
+            {
+                // A virtual stack references the input bands rather than copying them.
+                stackbands.stackImagesVRT(datasets, numImages, outputImage, imageBandNames, RSGIS_to_GDAL_Type(outDataType), replaceBandNames);
+            }
+            else if(!skipPixels)
+            {
+                stackbands.stackImagesCopy(datasets, numImages, outputImage, imageBandNames, gdalFormat, RSGIS_to_GDAL_Type(outDataType), replaceBandNames, numThreads);
+            }
+            else
+            {
+                stackbands.stackImages(datasets, numImages, outputImage, imageBandNames, skipPixels, skipValue, noDataValue, gdalFormat, RSGIS_to_GDAL_Type(outDataType), replaceBandNames);
+            }
 
             if(datasets != NULL)
             {
@@ -1278,7 +1438,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset *imageDS = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(imageDS == NULL)
@@ -1323,8 +1483,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
-            OGRRegisterAll();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset **dataset = NULL;
             GDALDataset *inputVecDS = NULL;
@@ -1391,8 +1550,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
-            OGRRegisterAll();
+            rsgis::RSGISGDALInit::init();
             
             // Open Image
             std::cout << inputImage << std::endl;
@@ -1432,12 +1590,175 @@ namespace rsgis{ namespace cmds {
         }
     }
 
+    /** Cut the envelopes which overlap the image to the output images (skipping the others), where the input image is read once for all of them. */
+    static void subsetEnvelopesToImages(GDALDataset *dataset, std::vector<OGREnvelope> *envs, std::vector<std::string> *outputImages, std::string imageFormat, RSGISLibDataType outDataType, unsigned int numThreads, std::vector<std::string> *outFileNames)
+    {
+        rsgis::img::RSGISImageUtils imgUtils;
+        double gdalTransform[6];
+        dataset->GetGeoTransform(gdalTransform);
+        double imgMinX = gdalTransform[0];
+        double imgMaxX = gdalTransform[0] + (dataset->GetRasterXSize() * gdalTransform[1]);
+        double imgMaxY = gdalTransform[3];
+        double imgMinY = gdalTransform[3] - (dataset->GetRasterYSize() * fabs(gdalTransform[5]));
+        
+        // The windows are found as for a single subset (RSGISCalcImage::calcImageInEnv).
+        std::vector<rsgis::img::RSGISImageTile> tiles;
+        int offsetVals[2];
+        int *dsOffsets[1] = {offsetVals};
+        int width = 0;
+        int height = 0;
+        double tileTransform[6];
+        for(size_t i = 0; i < envs->size(); ++i)
+        {
+            OGREnvelope *env = &envs->at(i);
+            if((env->MaxX <= imgMinX) || (env->MinX >= imgMaxX) || (env->MaxY <= imgMinY) || (env->MinY >= imgMaxY))
+            {
+                std::cout << "Skipping " << outputImages->at(i) << " as it does not overlap the image." << std::endl;
+                continue;
+            }
+            imgUtils.getImageOverlapCut2Env(&dataset, 1, dsOffsets, &width, &height, tileTransform, env);
+            if((width <= 0) || (height <= 0))
+            {
+                std::cout << "Skipping " << outputImages->at(i) << " as it is smaller than a pixel." << std::endl;
+                continue;
+            }
+            tiles.push_back(rsgis::img::RSGISImageTile(dsOffsets[0][0], dsOffsets[0][1], width, height, outputImages->at(i)));
+        }
+        
+        rsgis::img::RSGISImageTileCutter tileCutter = rsgis::img::RSGISImageTileCutter(numThreads);
+        tileCutter.cutTiles(dataset, &tiles, imageFormat, RSGIS_to_GDAL_Type(outDataType));
+        if(outFileNames != NULL)
+        {
+            for(std::vector<rsgis::img::RSGISImageTile>::iterator iterTiles = tiles.begin(); iterTiles != tiles.end(); ++iterTiles)
+            {
+                outFileNames->push_back((*iterTiles).outputImage);
+            }
+        }
+    }
+    
+    void executeSubsetBBoxes(std::string inputImage, std::vector<std::string> outputImages, std::string imageFormat, RSGISLibDataType outDataType, std::vector<double> xMins, std::vector<double> xMaxs, std::vector<double> yMins, std::vector<double> yMaxs, unsigned int numThreads, std::vector<std::string> *outFileNames)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            if((xMins.size() != outputImages.size()) || (xMaxs.size() != outputImages.size()) || (yMins.size() != outputImages.size()) || (yMaxs.size() != outputImages.size()))
+            {
+                throw RSGISCmdException("The number of bounding boxes and output images must be the same.");
+            }
+            
+            GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            std::vector<OGREnvelope> envs(outputImages.size());
+            for(size_t i = 0; i < outputImages.size(); ++i)
+            {
+                envs[i].MinX = xMins[i];
+                envs[i].MaxX = xMaxs[i];
+                envs[i].MinY = yMins[i];
+                envs[i].MaxY = yMaxs[i];
+            }
+            subsetEnvelopesToImages(dataset, &envs, &outputImages, imageFormat, outDataType, numThreads, outFileNames);
+            
+            GDALClose(dataset);
+        }
+        catch (RSGISImageException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch (RSGISException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+    
+    void executeSubset2Polys(std::string inputImage, std::string inputVecFile, std::string inputVecLyr, std::string filenameAttribute, std::string outputImageBase, std::string imageFormat, RSGISLibDataType outDataType, std::string outFileExtension, std::vector<std::string> *outFileNames, unsigned int numThreads)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            
+            GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            GDALDataset *inputVecDS = (GDALDataset*) GDALOpenEx(inputVecFile.c_str(), GDAL_OF_VECTOR, NULL, NULL, NULL);
+            if(inputVecDS == NULL)
+            {
+                GDALClose(dataset);
+                std::string message = std::string("Could not open vector file ") + inputVecFile;
+                throw RSGISFileException(message.c_str());
+            }
+            OGRLayer *inputVecLayer = inputVecDS->GetLayerByName(inputVecLyr.c_str());
+            if(inputVecLayer == NULL)
+            {
+                GDALClose(dataset);
+                GDALClose(inputVecDS);
+                std::string message = std::string("Could not open vector layer ") + inputVecLyr;
+                throw RSGISFileException(message.c_str());
+            }
+            int fieldIdx = inputVecLayer->GetLayerDefn()->GetFieldIndex(filenameAttribute.c_str());
+            if(fieldIdx < 0)
+            {
+                GDALClose(dataset);
+                GDALClose(inputVecDS);
+                std::string message = std::string("The attribute ") + filenameAttribute + std::string(" is not within the vector layer.");
+                throw RSGISFileException(message.c_str());
+            }
+            
+            // Read the envelopes of all the polygons so the image is read once for all of them.
+            std::vector<OGREnvelope> envs;
+            std::vector<std::string> outputImages;
+            OGRFeature *feature = NULL;
+            inputVecLayer->ResetReading();
+            while((feature = inputVecLayer->GetNextFeature()) != NULL)
+            {
+                OGRGeometry *geom = feature->GetGeometryRef();
+                if((geom != NULL) && (!geom->IsEmpty()))
+                {
+                    OGREnvelope env;
+                    geom->getEnvelope(&env);
+                    envs.push_back(env);
+                    outputImages.push_back(outputImageBase + std::string(feature->GetFieldAsString(fieldIdx)) + std::string(".") + outFileExtension);
+                }
+                OGRFeature::DestroyFeature(feature);
+            }
+            GDALClose(inputVecDS);
+            std::cout << "There are " << envs.size() << " polygons to subset the image to." << std::endl;
+            
+            subsetEnvelopesToImages(dataset, &envs, &outputImages, imageFormat, outDataType, numThreads, outFileNames);
+            
+            GDALClose(dataset);
+        }
+        catch (RSGISImageException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch (RSGISException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+
     void executeSubset2Img(std::string inputImage, std::string inputROIImage, std::string outputImage, std::string imageFormat, RSGISLibDataType outDataType) 
     {
         try
         {
-			GDALAllRegister();
-			OGRRegisterAll();
+			rsgis::RSGISGDALInit::init();
 
 			GDALDataset **dataset = NULL;
             GDALDataset *roiDataset = NULL;
@@ -1502,7 +1823,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-			GDALAllRegister();
+			rsgis::RSGISGDALInit::init();
             double *transformation = new double[6];
             transformation[0] = tlX;
             transformation[1] = res_x;
@@ -1545,7 +1866,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-			GDALAllRegister();
+			rsgis::RSGISGDALInit::init();
             GDALDataset *inDataset = NULL;
             inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(inDataset == NULL)
@@ -1579,7 +1900,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *inDataset = NULL;
             inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(inDataset == NULL)
@@ -1615,8 +1936,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
-            OGRRegisterAll();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *inDataset = NULL;
             inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(inDataset == NULL)
@@ -1678,7 +1998,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = NULL;
             rsgis::img::RSGISCalcImage *calcImage = NULL;
 
@@ -1709,15 +2029,26 @@ namespace rsgis{ namespace cmds {
                 std::cout << "Calculating " << calcStat << " for every " << numBands << " bands of a " << numRasterBands << " band input image to create a " << numOutputBands << " band output image" << std::endl;
             }
 
+            if((numBands == 0) || (numOutputBands == 0))
+            {
+                GDALClose(datasets[0]);
+                delete[] datasets;
+                throw RSGISCmdException("The number of bands to summarise must be between 1 and the number of image bands.");
+            }
+
             // Convert from string to enum
-            rsgis::img::compositeStat outCompStat;
-            if(calcStat == "mean"){outCompStat = rsgis::img::compositeMean;}
-            else if(calcStat == "min"){outCompStat = rsgis::img::compositeMin;}
-            else if(calcStat == "max"){outCompStat = rsgis::img::compositeMax;}
-            else if(calcStat == "range"){outCompStat = rsgis::img::compositeRange;}
+            rsgis::img::RSGISTemporalStatSpec statSpec;
+            statSpec.percentile = 0.0;
+            if(calcStat == "mean"){statSpec.stat = rsgis::img::rsgis_tstat_mean;}
+            else if(calcStat == "min"){statSpec.stat = rsgis::img::rsgis_tstat_min;}
+            else if(calcStat == "max"){statSpec.stat = rsgis::img::rsgis_tstat_max;}
+            else if(calcStat == "range"){statSpec.stat = rsgis::img::rsgis_tstat_range;}
             else{throw RSGISCmdException("Statistic not recognized, options are: mean, min, max, range.");}
+            std::vector<rsgis::img::RSGISTemporalStatSpec> stats;
+            stats.push_back(statSpec);
 
-            rsgis::img::RSGISImageComposite *compositeImage = new rsgis::img::RSGISImageComposite(numOutputBands, numBands, outCompStat);
+            // Each output band summarises a series of numBands consecutive input bands.
+            rsgis::img::RSGISTemporalSummary *compositeImage = new rsgis::img::RSGISTemporalSummary(numOutputBands, numBands, numBands, 1, stats, 0.0, false);
             calcImage = new rsgis::img::RSGISCalcImage(compositeImage, "", true);
             calcImage->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, RSGIS_to_GDAL_Type(outDataType));
 
@@ -1746,7 +2077,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *inDataset = NULL;
             GDALDataset *outDataset = NULL;
             
@@ -1812,11 +2143,11 @@ namespace rsgis{ namespace cmds {
     }
             
     
-    void executeFiniteImageMask(std::string inputImage, std::string outputImage, std::string gdalFormat) 
+    void executeFiniteImageMask(std::string inputImage, std::string outputImage, std::string gdalFormat, unsigned int numThreads) 
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = NULL;
             
             dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
@@ -1827,7 +2158,7 @@ namespace rsgis{ namespace cmds {
             }
             
             rsgis::img::RSGISMaskImage maskImg;
-            maskImg.genFiniteImgMask(dataset, outputImage, gdalFormat);
+            maskImg.genFiniteImgMask(dataset, outputImage, gdalFormat, numThreads);
             
             
             GDALDataset *outDataset = (GDALDataset *) GDALOpen(outputImage.c_str(), GA_Update);
@@ -1856,11 +2187,11 @@ namespace rsgis{ namespace cmds {
         }
     }
             
-    void executeValidImageMask(std::vector<std::string> inputImages, std::string outputImage, std::string gdalFormat, float noDataVal) 
+    void executeValidImageMask(std::vector<std::string> inputImages, std::string outputImage, std::string gdalFormat, float noDataVal, bool anyImgValid, unsigned int numThreads) 
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             unsigned int numImages = inputImages.size();
             GDALDataset **datasets = new GDALDataset*[numImages];
             for(unsigned int i = 0; i < numImages; ++i)
@@ -1875,7 +2206,8 @@ namespace rsgis{ namespace cmds {
             }
             
             rsgis::img::RSGISMaskImage maskImg;
-            maskImg.genValidImgMask(datasets, numImages, outputImage, gdalFormat, noDataVal);
+            rsgis::img::RSGISBitMaskCombine imgCombine = anyImgValid?rsgis::img::rsgis_bitmask_or:rsgis::img::rsgis_bitmask_and;
+            maskImg.genValidImgMask(datasets, numImages, outputImage, gdalFormat, noDataVal, imgCombine, numThreads);
             
             GDALDataset *outDataset = (GDALDataset *) GDALOpen(outputImage.c_str(), GA_Update);
             if(outDataset == NULL)
@@ -1912,7 +2244,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             rsgis::img::RSGISMaskImage maskImg;
             maskImg.genImgEdgeMask(dataset, outputImage, gdalFormat, nEdgePxls);
@@ -1941,11 +2273,11 @@ namespace rsgis{ namespace cmds {
         }
     }
 
-    void executeCombineImagesSingleBandIgnoreNoData(std::vector<std::string> inputImages, std::string outputImage, float noDataVal, std::string gdalFormat, RSGISLibDataType outDataType) 
+    void executeCombineImagesSingleBandIgnoreNoData(std::vector<std::string> inputImages, std::string outputImage, float noDataVal, std::string gdalFormat, RSGISLibDataType outDataType, unsigned int numThreads) 
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             unsigned int numImages = inputImages.size();
             GDALDataset **datasets = new GDALDataset*[numImages];
             
@@ -1959,12 +2291,8 @@ namespace rsgis{ namespace cmds {
                 }
             }
             
-            rsgis::img::RSGISCombineImagesIgnoreNoData *combineImagesCalc = new rsgis::img::RSGISCombineImagesIgnoreNoData(noDataVal);
-            rsgis::img::RSGISCalcImage *calcImage = new rsgis::img::RSGISCalcImage(combineImagesCalc, "", true);
-            
-            calcImage->calcImage(datasets, numImages, outputImage, false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
-            
-            delete calcImage;
+            rsgis::img::RSGISImageBitMask bitMask = rsgis::img::RSGISImageBitMask(numThreads);
+            bitMask.combineImagesIgnoreNoData(datasets, numImages, outputImage, gdalFormat, RSGIS_to_GDAL_Type(outDataType), noDataVal);
             
             
             // Tidy up
@@ -1994,7 +2322,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset *inputImgDS = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(inputImgDS == NULL)
@@ -2035,11 +2363,11 @@ namespace rsgis{ namespace cmds {
         }
     }
                 
-    void executePerformRandomPxlSampleSmallPxlCount(std::string inputImage, std::string outputImage, std::string gdalFormat, std::vector<int> maskVals, unsigned long numSamples, int rndSeed) 
+    void executePerformRandomPxlSampleSmallPxlCount(std::string inputImage, std::string outputImage, std::string gdalFormat, std::vector<int> maskVals, unsigned long numSamples, int rndSeed, bool useRowCounts) 
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *inputImgDS = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(inputImgDS == NULL)
@@ -2059,7 +2387,14 @@ namespace rsgis{ namespace cmds {
             
             std::cout << "Performing sampling.\n";
             rsgis::img::RSGISSampleImage sampleImg;
-            sampleImg.randomSampleImageMaskSmallPxlCount(inputImgDS, 1, outImgDS, maskVals, numSamples, rndSeed);
+            if(useRowCounts)
+            {
+                sampleImg.randomSampleImageMaskRowCounts(inputImgDS, 1, outImgDS, maskVals, numSamples, rndSeed);
+            }
+            else
+            {
+                sampleImg.randomSampleImageMaskSmallPxlCount(inputImgDS, 1, outImgDS, maskVals, numSamples, rndSeed);
+            }
             std::cout << "Completed Sampling.\n";
             
             GDALClose(inputImgDS);
@@ -2081,41 +2416,74 @@ namespace rsgis{ namespace cmds {
                 
                 
                 
-    void executePerformHCSPanSharpen(std::string inputImage, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, unsigned int winSize, bool useNaiveMethod) 
+    void executeCreatePxlIndexSidecar(std::string inputImage, unsigned int imgBand)
     {
         try
         {
-            GDALAllRegister();
-            GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
-            if(dataset == NULL)
+            rsgis::RSGISGDALInit::init();
+            
+            GDALDataset *inputImgDS = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(inputImgDS == NULL)
             {
                 std::string message = std::string("Could not open image ") + inputImage;
                 throw RSGISImageException(message.c_str());
             }
             
-            int numRasterBands = dataset->GetRasterCount();
-            
-            // Calculate statistics
-            float *imageStats = new float[4];  // Set up an array to hold image stats
-            
-            std::cout << "Calculating image mean.." << std::endl;
-            rsgis::img::RSGISHCSPanSharpenCalcMeanStats panMean = rsgis::img::RSGISHCSPanSharpenCalcMeanStats(numRasterBands, imageStats);
-            rsgis::img::RSGISCalcImage calcImageMean = rsgis::img::RSGISCalcImage(&panMean, "", true);
-            calcImageMean.calcImage(&dataset, 1);
-            panMean.returnStats();
-            
-            std::cout << "Calculating image standard deviation.." << std::endl;
-            rsgis::img::RSGISHCSPanSharpenCalcSDStats panSD = rsgis::img::RSGISHCSPanSharpenCalcSDStats(numRasterBands, imageStats);
-            rsgis::img::RSGISCalcImage calcImageSD = rsgis::img::RSGISCalcImage(&panSD, "", true);
-            calcImageSD.calcImage(&dataset, 1);
-            panSD.returnStats();
-
+            rsgis::img::RSGISClassPixelIndex pxlIndex;
+            pxlIndex.createIndex(inputImgDS, imgBand);
+            pxlIndex.saveSidecar();
             
-            std::cout << "Pan sharpening.." << std::endl;
-            rsgis::img::RSGISHCSPanSharpen panSharpen = rsgis::img::RSGISHCSPanSharpen(numRasterBands - 1, imageStats);
-            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&panSharpen, "", true);
-            if(useNaiveMethod)
-            {
+            GDALClose(inputImgDS);
+        }
+        catch (RSGISImageException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch (RSGISException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+                
+    void executePerformHCSPanSharpen(std::string inputImage, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, unsigned int winSize, bool useNaiveMethod, unsigned int statsSampleSize) 
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw RSGISImageException(message.c_str());
+            }
+            
+            int numRasterBands = dataset->GetRasterCount();
+            
+            // Calculate statistics
+            float *imageStats = new float[4];  // Set up an array to hold image stats
+            
+            std::cout << "Calculating image statistics.." << std::endl;
+            rsgis::img::RSGISHCSPanSharpenCalcStats panStats = rsgis::img::RSGISHCSPanSharpenCalcStats(imageStats);
+            if(statsSampleSize > 0)
+            {
+                panStats.calcSampleStats(dataset, statsSampleSize);
+            }
+            else
+            {
+                rsgis::img::RSGISCalcImage calcImageStats = rsgis::img::RSGISCalcImage(&panStats, "", true);
+                calcImageStats.calcImage(&dataset, 1);
+            }
+            panStats.returnStats();
+            
+            std::cout << "Pan sharpening.." << std::endl;
+            rsgis::img::RSGISHCSPanSharpen panSharpen = rsgis::img::RSGISHCSPanSharpen(numRasterBands - 1, imageStats);
+            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&panSharpen, "", true);
+            if(useNaiveMethod)
+            {
                 // naive mode
                 calcImage.calcImage(&dataset, 1, outputImage, false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
             }
@@ -2144,13 +2512,13 @@ namespace rsgis{ namespace cmds {
         }
     }
                 
-    void executeSharpenLowResImgBands(std::string inputImage, std::string outputImage, std::vector<RSGISInitSharpenBandInfo> bandInfo, unsigned int winSize, int noDataVal, std::string gdalFormat, RSGISLibDataType outDataType) 
+    void executeSharpenLowResImgBands(std::string inputImage, std::string outputImage, std::vector<RSGISInitSharpenBandInfo> bandInfo, unsigned int winSize, int noDataVal, std::string gdalFormat, RSGISLibDataType outDataType, bool useRunningSums) 
     {
         try
         {
             rsgis::utils::RSGISTextUtils textUtils;
             
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(dataset == NULL)
             {
@@ -2265,7 +2633,7 @@ namespace rsgis{ namespace cmds {
             
             // Perform image band sharpening.
             std::cout << "Perform image band sharpening.\n";
-            rsgis::img::RSGISSharpenLowResBands sharpenImg = rsgis::img::RSGISSharpenLowResBands(numRasterBands, rsgisBandInfo, numRasterBands, lowResCount, highResCount, winSize, noDataVal, imgMinVal, imgMaxVal);
+            rsgis::img::RSGISSharpenLowResBands sharpenImg(numRasterBands, rsgisBandInfo, numRasterBands, lowResCount, highResCount, winSize, noDataVal, imgMinVal, imgMaxVal, useRunningSums);
             rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&sharpenImg, "", true);
             calcImage.calcImageWindowData(&dataset, 1, outputImage, winSize, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
             
@@ -2315,7 +2683,7 @@ namespace rsgis{ namespace cmds {
                 throw RSGISImageException("Input images list must have at least 2 images.");
             }
             
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[inputImages.size()];
             int imgIdx = 0;
             unsigned int numImgBands = 0;
@@ -2346,10 +2714,11 @@ namespace rsgis{ namespace cmds {
                 ++imgIdx;
             }
             
-            rsgis::img::RSGISMaxNDVIImageComposite imgCompPxlCalc = rsgis::img::RSGISMaxNDVIImageComposite(numImgBands, redBand, nirBand, inputImages.size());
-            
-            rsgis::img::RSGISCalcImage calcImg = rsgis::img::RSGISCalcImage(&imgCompPxlCalc, "", true);
-            calcImg.calcImage(datasets, inputImages.size(), outputImage, false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
+            // Only the red and NIR bands are read to select the scenes.
+            std::vector<GDALDataset*> scenes(datasets, datasets + inputImages.size());
+            rsgis::img::RSGISMaxNDVISceneSelector sceneSelector = rsgis::img::RSGISMaxNDVISceneSelector(scenes, redBand, nirBand);
+            rsgis::img::RSGISSelectiveImageComposite createComposite = rsgis::img::RSGISSelectiveImageComposite(&sceneSelector, 0.0);
+            createComposite.createComposite(scenes, outputImage, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
             
             // Tidy up
             for(int i = 0; i < inputImages.size(); ++i)
@@ -2381,7 +2750,7 @@ namespace rsgis{ namespace cmds {
                 throw RSGISImageException("Input images list must have at least 2 images.");
             }
             
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             unsigned int totNumImgs = inputImages.size()+1;
             GDALDataset **datasets = new GDALDataset*[totNumImgs];
             int imgIdx = 0;
@@ -2429,10 +2798,10 @@ namespace rsgis{ namespace cmds {
                 ++imgIdx;
             }
             
-            rsgis::img::RSGISRefImgImageComposite imgCompPxlCalc = rsgis::img::RSGISRefImgImageComposite(numImgBands, inputImages.size(), outNoDataVal);
-            
-            rsgis::img::RSGISCalcImage calcImg = rsgis::img::RSGISCalcImage(&imgCompPxlCalc, "", true);
-            calcImg.calcImage(datasets, 1, inputImages.size(), outputImage, false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
+            std::vector<GDALDataset*> scenes(datasets+1, datasets + totNumImgs);
+            rsgis::img::RSGISRefImgSceneSelector sceneSelector = rsgis::img::RSGISRefImgSceneSelector(datasets[0], inputImages.size());
+            rsgis::img::RSGISSelectiveImageComposite createComposite = rsgis::img::RSGISSelectiveImageComposite(&sceneSelector, outNoDataVal);
+            createComposite.createComposite(scenes, outputImage, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
             
             // Tidy up
             for(int i = 0; i < totNumImgs; ++i)
@@ -2454,6 +2823,129 @@ namespace rsgis{ namespace cmds {
             throw RSGISCmdException(e.what());
         }
     }
+    
+    void executeCreatePercentileCompositeImage(std::vector<std::string> inputImages, std::string outputImage, float percentile, float noDataVal, float outNoDataVal, std::string gdalFormat, RSGISLibDataType outDataType)
+    {
+        try
+        {
+            if(inputImages.empty())
+            {
+                throw RSGISImageException("Input images list must have at least 1 image.");
+            }
+            
+            rsgis::RSGISGDALInit::init();
+            std::vector<GDALDataset*> scenes;
+            for(std::vector<std::string>::iterator iterImgs = inputImages.begin(); iterImgs != inputImages.end(); ++iterImgs)
+            {
+                std::cout << "Openning: " << (*iterImgs) << std::endl;
+                GDALDataset *dataset = (GDALDataset *) GDALOpen((*iterImgs).c_str(), GA_ReadOnly);
+                if(dataset == NULL)
+                {
+                    for(std::vector<GDALDataset*>::iterator iterDS = scenes.begin(); iterDS != scenes.end(); ++iterDS)
+                    {
+                        GDALClose(*iterDS);
+                    }
+                    std::string message = std::string("Could not open image ") + (*iterImgs);
+                    throw RSGISImageException(message.c_str());
+                }
+                scenes.push_back(dataset);
+            }
+            
+            try
+            {
+                rsgis::img::RSGISPercentileImageComposite createComposite = rsgis::img::RSGISPercentileImageComposite(percentile, noDataVal, outNoDataVal);
+                createComposite.createComposite(scenes, outputImage, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
+            }
+            catch(std::exception &e)
+            {
+                for(std::vector<GDALDataset*>::iterator iterDS = scenes.begin(); iterDS != scenes.end(); ++iterDS)
+                {
+                    GDALClose(*iterDS);
+                }
+                throw;
+            }
+            
+            // Tidy up
+            for(std::vector<GDALDataset*>::iterator iterDS = scenes.begin(); iterDS != scenes.end(); ++iterDS)
+            {
+                GDALClose(*iterDS);
+            }
+        }
+        catch (RSGISImageException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch (RSGISException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+    
+    void executeCreateMedoidCompositeImage(std::vector<std::string> inputImages, std::string outputImage, std::vector<unsigned int> bands, float noDataVal, float outNoDataVal, std::string gdalFormat, RSGISLibDataType outDataType)
+    {
+        try
+        {
+            if(inputImages.empty())
+            {
+                throw RSGISImageException("Input images list must have at least 1 image.");
+            }
+            
+            rsgis::RSGISGDALInit::init();
+            std::vector<GDALDataset*> scenes;
+            for(std::vector<std::string>::iterator iterImgs = inputImages.begin(); iterImgs != inputImages.end(); ++iterImgs)
+            {
+                std::cout << "Openning: " << (*iterImgs) << std::endl;
+                GDALDataset *dataset = (GDALDataset *) GDALOpen((*iterImgs).c_str(), GA_ReadOnly);
+                if(dataset == NULL)
+                {
+                    for(std::vector<GDALDataset*>::iterator iterDS = scenes.begin(); iterDS != scenes.end(); ++iterDS)
+                    {
+                        GDALClose(*iterDS);
+                    }
+                    std::string message = std::string("Could not open image ") + (*iterImgs);
+                    throw RSGISImageException(message.c_str());
+                }
+                scenes.push_back(dataset);
+            }
+            
+            try
+            {
+                rsgis::img::RSGISMedoidSceneSelector sceneSelector = rsgis::img::RSGISMedoidSceneSelector(scenes, bands, noDataVal);
+                rsgis::img::RSGISSelectiveImageComposite createComposite = rsgis::img::RSGISSelectiveImageComposite(&sceneSelector, outNoDataVal);
+                createComposite.createComposite(scenes, outputImage, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
+            }
+            catch(std::exception &e)
+            {
+                for(std::vector<GDALDataset*>::iterator iterDS = scenes.begin(); iterDS != scenes.end(); ++iterDS)
+                {
+                    GDALClose(*iterDS);
+                }
+                throw;
+            }
+            
+            // Tidy up
+            for(std::vector<GDALDataset*>::iterator iterDS = scenes.begin(); iterDS != scenes.end(); ++iterDS)
+            {
+                GDALClose(*iterDS);
+            }
+        }
+        catch (RSGISImageException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch (RSGISException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
                 
                 
     void executeGenTimeseriesFillCompositeImg(std::vector<RSGISCmdCompositeInfo> inCompInfo, std::string validMaskImage, std::string outFillRefImg, std::string outCompImg, std::string outCompRefImg, std::string gdalFormat, RSGISLibDataType outDataType)  
@@ -2465,7 +2957,7 @@ namespace rsgis{ namespace cmds {
                 throw RSGISImageException("Input info list must have at least 2 datasets.");
             }
             
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             rsgis::rastergis::RSGISRasterAttUtils ratUtils;
             unsigned int countOutRefs = 0;
             std::string inRefImg = "";
@@ -2656,10 +3148,11 @@ namespace rsgis{ namespace cmds {
                 ++imgIdxAll;
             }
             
-            rsgis::img::RSGISTimeseriesFillImgImageComposite imgFillCompCalc = rsgis::img::RSGISTimeseriesFillImgImageComposite(compInfoVec, imgIdxLUT, totNumImgs, nBands);
-            calcImg = rsgis::img::RSGISCalcImage(&imgFillCompCalc, "", true);
-            calcImg.calcImage(datasets, 1, (imgIdx-1), outCompImg, false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
-            delete[] imgIdxLUT;
+            // Only the scenes used within the composite are read, and only where they are used.
+            std::vector<GDALDataset*> compScenes(datasets+1, datasets + imgIdx);
+            rsgis::img::RSGISTimeseriesFillSceneSelector fillSceneSelector = rsgis::img::RSGISTimeseriesFillSceneSelector(datasets[0], imgIdxLUT, totNumImgs);
+            rsgis::img::RSGISSelectiveImageComposite createComposite = rsgis::img::RSGISSelectiveImageComposite(&fillSceneSelector, 0.0);
+            createComposite.createComposite(compScenes, outCompImg, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
             // Tidy up
             for(int i = 0; i < imgIdx; ++i)
             {
@@ -2723,6 +3216,7 @@ namespace rsgis{ namespace cmds {
             rsgis::img::RSGISTimeseriesFillFinalRefImgImageComposite imgFillFinalRefCompCalc = rsgis::img::RSGISTimeseriesFillFinalRefImgImageComposite(compInfoVec, ratImgLst);
             calcImg = rsgis::img::RSGISCalcImage(&imgFillFinalRefCompCalc, "", true);
             calcImg.calcImage(datasets, imgIdx, 0, outCompRefImg, false, NULL, "KEA", GDT_Int32);
+            delete[] imgIdxLUT;
             // Tidy up
             for(int i = 0; i < imgIdx; ++i)
             {
@@ -2783,7 +3277,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[2];
             
             std::cout << "Openning: " << inputRefImage << std::endl;
@@ -2855,11 +3349,11 @@ namespace rsgis{ namespace cmds {
         return gdalCreationOpts;
     }
 
-    void executeUnpackPxlValues(std::string inputImage, unsigned int inputImgBand, std::string outputImage, std::string gdalFormat)
+    void executeUnpackPxlValues(std::string inputImage, unsigned int inputImgBand, std::string outputImage, std::string gdalFormat, unsigned int numThreads)
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             if(inputImgBand == 0)
             {
@@ -2894,7 +3388,7 @@ namespace rsgis{ namespace cmds {
             }
             else if((gdalDataType == GDT_UInt32) | (gdalDataType == GDT_Int32))
             {
-                nOutBands = 16;
+                nOutBands = 32;
             }
             else
             {
@@ -2902,9 +3396,24 @@ namespace rsgis{ namespace cmds {
                 throw RSGISImageException("The input image is not an integer data type.");
             }
 
-            rsgis::img::RSGISCopyImageBandToBits copyImgBandToBits = rsgis::img::RSGISCopyImageBandToBits(nOutBands, inputImgBand, gdalDataType);
-            rsgis::img::RSGISCalcImage calcImg = rsgis::img::RSGISCalcImage(&copyImgBandToBits, "", true);
-            calcImg.calcImage(&dataset, 1, 0, outputImage, false, NULL, gdalFormat, GDT_Byte);
+            // Each bit is a field with a width of 1.
+            std::vector<rsgis::img::RSGISBitField> fields(nOutBands);
+            for(int i = 0; i < nOutBands; ++i)
+            {
+                fields[i].offset = i;
+                fields[i].width = 1;
+            }
+
+            try
+            {
+                rsgis::img::RSGISImageBitFields bitFields = rsgis::img::RSGISImageBitFields(numThreads);
+                bitFields.decodeBitFields(dataset, inputImgBand, fields, outputImage, gdalFormat);
+            }
+            catch(rsgis::RSGISException &e)
+            {
+                GDALClose(dataset);
+                throw e;
+            }
 
             // Tidy up
             GDALClose(dataset);
@@ -2923,5 +3432,501 @@ namespace rsgis{ namespace cmds {
         }
     }
 
+    void executeDecodeBitFields(std::string inputImage, unsigned int inputImgBand, std::string outputImage, std::string gdalFormat, std::vector<RSGISCmdBitField> bitFields, unsigned int numThreads)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+
+            std::cout << "Opening: " << inputImage << std::endl;
+            GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw RSGISImageException(message.c_str());
+            }
+
+            std::vector<rsgis::img::RSGISBitField> fields(bitFields.size());
+            for(size_t i = 0; i < bitFields.size(); ++i)
+            {
+                fields[i].offset = bitFields[i].offset;
+                fields[i].width = bitFields[i].width;
+            }
+
+            try
+            {
+                rsgis::img::RSGISImageBitFields imgBitFields = rsgis::img::RSGISImageBitFields(numThreads);
+                imgBitFields.decodeBitFields(dataset, inputImgBand, fields, outputImage, gdalFormat);
+            }
+            catch(rsgis::RSGISException &e)
+            {
+                GDALClose(dataset);
+                throw e;
+            }
+
+            GDALClose(dataset);
+        }
+        catch (RSGISException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+
+    void executeGenBitPatternMask(std::string inputImage, unsigned int inputImgBand, std::string outputImage, std::string gdalFormat, std::vector<RSGISCmdBitPatternRule> rules, unsigned int noMatchVal, unsigned int numThreads)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+
+            if(noMatchVal > 255)
+            {
+                throw RSGISImageException("The no match value must be within the range 0-255.");
+            }
+
+            std::vector<rsgis::img::RSGISBitPatternRule> patternRules(rules.size());
+            for(size_t i = 0; i < rules.size(); ++i)
+            {
+                if(rules[i].outVal > 255)
+                {
+                    throw RSGISImageException("The output value of a rule must be within the range 0-255.");
+                }
+                patternRules[i].bitMask = rules[i].bitMask;
+                patternRules[i].bitValue = rules[i].bitValue;
+                patternRules[i].outVal = (uint8_t)rules[i].outVal;
+            }
+
+            std::cout << "Opening: " << inputImage << std::endl;
+            GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw RSGISImageException(message.c_str());
+            }
+
+            try
+            {
+                rsgis::img::RSGISImageBitFields imgBitFields = rsgis::img::RSGISImageBitFields(numThreads);
+                imgBitFields.genBitPatternMask(dataset, inputImgBand, patternRules, (uint8_t)noMatchVal, outputImage, gdalFormat);
+            }
+            catch(rsgis::RSGISException &e)
+            {
+                GDALClose(dataset);
+                throw e;
+            }
+
+            GDALClose(dataset);
+        }
+        catch (RSGISException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+
+    void executeSetCalcImageIOBuffers(unsigned int numBuffers)
+    {
+        if(numBuffers == 0)
+        {
+            throw RSGISCmdException("The number of I/O buffers must be at least 1.");
+        }
+        rsgis::RSGISStripIOPipeline::setDefaultNumBuffers(numBuffers);
+    }
+    
+    unsigned int executeGetCalcImageIOBuffers()
+    {
+        return rsgis::RSGISStripIOPipeline::getDefaultNumBuffers();
+    }
+    
+    void executeSetCalcImageExecContext(rsgis::RSGISExecutionContext context)
+    {
+        if(context.numIOBuffers == 0)
+        {
+            throw RSGISCmdException("The number of I/O buffers must be at least 1.");
+        }
+        if(context.useGPU && !rsgis::RSGISOpenCLDevice::isAvailable())
+        {
+            throw RSGISCmdException("There is no GPU: RSGISLib must be built with the RSGIS_OPENCL option and an OpenCL device with double precision is required.");
+        }
+        if(context.gdalCacheMB > 0)
+        {
+            GDALSetCacheMax64(((GIntBig)context.gdalCacheMB) * 1024 * 1024);
+        }
+        rsgis::RSGISExecutionContextUtils::setDefaultContext(context);
+    }
+    
+    rsgis::RSGISExecutionContext executeGetCalcImageExecContext()
+    {
+        return rsgis::RSGISExecutionContextUtils::getDefaultContext();
+    }
+    
+    std::string executeGetGPUDeviceName()
+    {
+        return rsgis::RSGISOpenCLDevice::getDeviceName();
+    }
+    
+    void executeSetProgressReporting(bool enabled, bool showBar, unsigned int intervalMS)
+    {
+        if(intervalMS == 0)
+        {
+            throw RSGISCmdException("The progress interval must be at least 1 millisecond.");
+        }
+        rsgis::RSGISProgress::setEnabled(enabled);
+        rsgis::RSGISProgress::setShowBar(showBar);
+        rsgis::RSGISProgress::setIntervalMS(intervalMS);
+    }
+    
+    void executeGetProgressReporting(bool *enabled, bool *showBar, unsigned int *intervalMS)
+    {
+        *enabled = rsgis::RSGISProgress::isEnabled();
+        *showBar = rsgis::RSGISProgress::getShowBar();
+        *intervalMS = rsgis::RSGISProgress::getIntervalMS();
+    }
+    
+    void executeSetProgressCallback(rsgis::RSGISProgressCallback callback)
+    {
+        rsgis::RSGISProgress::setCallback(callback);
+    }
+    
+    RSGISCmdResourceEstimate executeEstimateCmdResources(std::vector<std::string> inputImages, RSGISCmdMemoryStrategy strategy, unsigned int numOutBands, RSGISLibDataType outDataType, unsigned int numColumns, unsigned int bytesPerClump)
+    {
+        RSGISCmdResourceEstimate estimate;
+        estimate.peakMemoryMB = 0.0;
+        estimate.readMB = 0.0;
+        estimate.writeMB = 0.0;
+        estimate.outOfCore = false;
+        estimate.withinBudget = true;
+        if(inputImages.empty())
+        {
+            throw RSGISCmdException("At least one input image must be provided.");
+        }
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+            const double bytesPerMB = 1024.0 * 1024.0;
+            double peakBytes = 0.0;
+            double readBytes = 0.0;
+            double writeBytes = 0.0;
+            
+            // The output of the image calculation engine is the overlap of the inputs.
+            int width = 0;
+            int height = 0;
+            int blockRows = 1;
+            size_t inPxlBytes = 0;
+            double numClumps = 0.0;
+            for(size_t i = 0; i < inputImages.size(); ++i)
+            {
+                GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImages[i].c_str(), GA_ReadOnly);
+                if(dataset == NULL)
+                {
+                    std::string message = std::string("Could not open image ") + inputImages[i];
+                    throw RSGISCmdException(message.c_str());
+                }
+                int numBands = dataset->GetRasterCount();
+                int xSize = dataset->GetRasterXSize();
+                int ySize = dataset->GetRasterYSize();
+                width = (i == 0)?xSize:std::min(width, xSize);
+                height = (i == 0)?ySize:std::min(height, ySize);
+                inPxlBytes += numBands * sizeof(float);
+                double pxls = ((double)xSize) * ySize;
+                if(numBands > 0)
+                {
+                    GDALRasterBand *band = dataset->GetRasterBand(1);
+                    int xBlockSize = 0;
+                    int yBlockSize = 0;
+                    band->GetBlockSize(&xBlockSize, &yBlockSize);
+                    blockRows = std::max(blockRows, yBlockSize);
+                    double bandBytes = pxls * GDALGetDataTypeSizeBytes(band->GetRasterDataType());
+                    
+                    if(strategy == rsgis_mem_columns)
+                    {
+                        const GDALRasterAttributeTable *gdalATT = band->GetDefaultRAT();
+                        double numRows = (gdalATT == NULL)?0.0:(double)gdalATT->GetRowCount();
+                        peakBytes += numRows * sizeof(double) * numColumns;
+                        readBytes += numRows * sizeof(double) * numColumns;
+                    }
+                    else if(strategy == rsgis_mem_bands)
+                    {
+                        peakBytes += pxls * sizeof(double) * numBands;
+                        readBytes += bandBytes * numBands;
+                    }
+                    else if(strategy == rsgis_mem_clumps)
+                    {
+                        const GDALRasterAttributeTable *gdalATT = band->GetDefaultRAT();
+                        if((gdalATT != NULL) && (gdalATT->GetRowCount() > 0))
+                        {
+                            numClumps += gdalATT->GetRowCount();
+                        }
+                        else
+                        {
+                            // Without an attribute table the clump count is taken from the maximum clump ID.
+                            double minVal = 0.0;
+                            double maxVal = 0.0;
+                            if(band->GetStatistics(TRUE, FALSE, &minVal, &maxVal, NULL, NULL) == CE_None)
+                            {
+                                numClumps += maxVal + 1;
+                            }
+                            else
+                            {
+                                numClumps += pxls;
+                            }
+                        }
+                        double arrayBytes = pxls * sizeof(unsigned int);
+                        unsigned int outOfCoreMB = rsgis::RSGISExecutionContextUtils::getOutOfCoreMemoryMB();
+                        if((outOfCoreMB > 0) && (arrayBytes > (((double)outOfCoreMB) * bytesPerMB)))
+                        {
+                            estimate.outOfCore = true;
+                        }
+                        else
+                        {
+                            peakBytes += arrayBytes;
+                        }
+                        readBytes += bandBytes;
+                        writeBytes += bandBytes;
+                    }
+                    else
+                    {
+                        readBytes += bandBytes * numBands;
+                    }
+                }
+                GDALClose(dataset);
+            }
+            
+            if(strategy == rsgis_mem_strips)
+            {
+                size_t outPxlBytes = ((size_t)numOutBands) * sizeof(double);
+                int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(blockRows, width, height, inPxlBytes + outPxlBytes, context.stripMemoryMB);
+                stripRows = std::min(stripRows, std::max(height, 1));
+                peakBytes = ((double)context.numIOBuffers) * stripRows * width * (inPxlBytes + outPxlBytes);
+                writeBytes = ((double)width) * height * numOutBands * GDALGetDataTypeSizeBytes(RSGIS_to_GDAL_Type(outDataType));
+            }
+            else if(strategy == rsgis_mem_clumps)
+            {
+                peakBytes += numClumps * bytesPerClump;
+            }
+            // Blocks held in the GDAL cache are also resident.
+            peakBytes += (double)GDALGetCacheMax64();
+            
+            estimate.peakMemoryMB = peakBytes / bytesPerMB;
+            estimate.readMB = readBytes / bytesPerMB;
+            estimate.writeMB = writeBytes / bytesPerMB;
+            estimate.withinBudget = (context.memoryBudgetMB == 0) || (estimate.peakMemoryMB <= context.memoryBudgetMB);
+        }
+        catch(RSGISCmdException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        return estimate;
+    }
+    
+    void executeSetCalcImageProfiling(bool enable)
+    {
+        rsgis::RSGISCalcImageProfiler::setEnabled(enable);
+    }
+    
+    rsgis::RSGISCalcImageProfile executeGetCalcImageProfile(bool reset)
+    {
+        rsgis::RSGISCalcImageProfile profile = rsgis::RSGISCalcImageProfiler::getProfile();
+        if(reset)
+        {
+            rsgis::RSGISCalcImageProfiler::reset();
+        }
+        return profile;
+    }
+    
+    std::vector<double> executeSampleImagePoints(std::string inputImage, std::vector<double> xLocs, std::vector<double> yLocs, std::vector<unsigned int> bands, int interp, double noDataVal, unsigned int numThreads)
+    {
+        std::vector<double> outVals;
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            
+            if((interp < rsgis::img::pointSampleNearest) || (interp > rsgis::img::pointSampleCubic))
+            {
+                throw RSGISImageException("The interpolation must be nearest neighbour, bilinear or cubic.");
+            }
+            
+            GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw RSGISImageException(message.c_str());
+            }
+            
+            try
+            {
+                rsgis::img::RSGISImagePointSampler::samplePoints(dataset, bands, xLocs, yLocs, (rsgis::img::RSGISPointSampleInterp)interp, noDataVal, &outVals, numThreads);
+            }
+            catch(RSGISException& e)
+            {
+                GDALClose(dataset);
+                throw e;
+            }
+            
+            GDALClose(dataset);
+        }
+        catch(RSGISException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        return outVals;
+    }
+
+    void executeCalcDistToNearestFeature(std::string inputImage, unsigned int imgBand, std::string outDistImage, std::string outLabelImage, std::string gdalFormat, double maxDist, float noDataVal, bool useGeoUnits)
+    {
+        GDALDataset *inDataset = NULL;
+        GDALDataset *distDataset = NULL;
+        GDALDataset *labelDataset = NULL;
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(inDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw RSGISImageException(message.c_str());
+            }
+            if((imgBand == 0) || (imgBand > ((unsigned int)inDataset->GetRasterCount())))
+            {
+                throw RSGISImageException("The band specified is not within the input image.");
+            }
+            GDALRasterBand *labelsBand = inDataset->GetRasterBand(imgBand);
+            double transform[6];
+            inDataset->GetGeoTransform(transform);
+            
+            rsgis::img::RSGISImageUtils imgUtils;
+            distDataset = imgUtils.createCopy(inDataset, 1, outDistImage, gdalFormat, GDT_Float32);
+            distDataset->GetRasterBand(1)->SetNoDataValue(noDataVal);
+            GDALRasterBand *nearestLabelBand = NULL;
+            if(outLabelImage != "")
+            {
+                labelDataset = imgUtils.createCopy(inDataset, 1, outLabelImage, gdalFormat, labelsBand->GetRasterDataType());
+                labelDataset->GetRasterBand(1)->SetNoDataValue(0);
+                nearestLabelBand = labelDataset->GetRasterBand(1);
+            }
+            
+            rsgis::img::RSGISDistanceTransform distTrans = rsgis::img::RSGISDistanceTransform(maxDist, noDataVal, useGeoUnits);
+            distTrans.calcDistToNearestFeature(labelsBand, transform, distDataset->GetRasterBand(1), nearestLabelBand);
+            
+            GDALClose(inDataset);
+            GDALClose(distDataset);
+            if(labelDataset != NULL)
+            {
+                GDALClose(labelDataset);
+            }
+        }
+        catch(RSGISException& e)
+        {
+            GDALDataset *datasets[3] = {inDataset, distDataset, labelDataset};
+            for(unsigned int i = 0; i < 3; ++i)
+            {
+                if(datasets[i] != NULL)
+                {
+                    GDALClose(datasets[i]);
+                }
+            }
+            throw RSGISCmdException(e.what());
+        }
+    }
+    
+    void executeCalcDistToClasses(std::string inputImage, unsigned int imgBand, std::vector<unsigned long> classIDs, std::vector<std::string> outDistImages, std::string gdalFormat, double maxDist, float noDataVal, bool useGeoUnits)
+    {
+        GDALDataset *inDataset = NULL;
+        std::vector<GDALDataset*> distDatasets;
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(inDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw RSGISImageException(message.c_str());
+            }
+            if((imgBand == 0) || (imgBand > ((unsigned int)inDataset->GetRasterCount())))
+            {
+                throw RSGISImageException("The band specified is not within the input image.");
+            }
+            GDALRasterBand *labelsBand = inDataset->GetRasterBand(imgBand);
+            double transform[6];
+            inDataset->GetGeoTransform(transform);
+            
+            rsgis::img::RSGISDistanceTransform distTrans = rsgis::img::RSGISDistanceTransform(maxDist, noDataVal, useGeoUnits);
+            std::vector<uint64_t> classVals(classIDs.begin(), classIDs.end());
+            if(classVals.empty())
+            {
+                classVals = distTrans.findClassIDs(labelsBand);
+                if(classVals.empty())
+                {
+                    throw RSGISImageException("The input image does not have any non-zero pixels.");
+                }
+            }
+            
+            // Either a single output image with a band per class or an output image for each class.
+            rsgis::img::RSGISImageUtils imgUtils;
+            std::vector<GDALRasterBand*> distBands;
+            if((outDistImages.size() == 1) && (classVals.size() > 1))
+            {
+                distDatasets.push_back(imgUtils.createCopy(inDataset, classVals.size(), outDistImages[0], gdalFormat, GDT_Float32));
+                for(size_t i = 0; i < classVals.size(); ++i)
+                {
+                    distBands.push_back(distDatasets[0]->GetRasterBand(i+1));
+                }
+            }
+            else if(outDistImages.size() == classVals.size())
+            {
+                for(size_t i = 0; i < classVals.size(); ++i)
+                {
+                    distDatasets.push_back(imgUtils.createCopy(inDataset, 1, outDistImages[i], gdalFormat, GDT_Float32));
+                    distBands.push_back(distDatasets[i]->GetRasterBand(1));
+                }
+            }
+            else
+            {
+                throw RSGISImageException("Either one output image or an output image for each class must be provided.");
+            }
+            rsgis::utils::RSGISTextUtils textUtils;
+            for(size_t i = 0; i < classVals.size(); ++i)
+            {
+                distBands[i]->SetNoDataValue(noDataVal);
+                distBands[i]->SetDescription(("class_" + textUtils.uInt64bittostring(classVals[i])).c_str());
+            }
+            
+            distTrans.calcDistToClasses(labelsBand, transform, classVals, distBands);
+            
+            GDALClose(inDataset);
+            for(std::vector<GDALDataset*>::iterator iterDS = distDatasets.begin(); iterDS != distDatasets.end(); ++iterDS)
+            {
+                GDALClose(*iterDS);
+            }
+        }
+        catch(RSGISException& e)
+        {
+            if(inDataset != NULL)
+            {
+                GDALClose(inDataset);
+            }
+            for(std::vector<GDALDataset*>::iterator iterDS = distDatasets.begin(); iterDS != distDatasets.end(); ++iterDS)
+            {
+                GDALClose(*iterDS);
+            }
+            throw RSGISCmdException(e.what());
+        }
+    }
+    
 }}
 
@@ -29,6 +29,9 @@
 #include <map>
 
 #include "common/RSGISCommons.h"
+#include "common/RSGISCalcImageProfiler.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISProgress.h"
 #include "RSGISCmdException.h"
 
 // mark all exported classes/functions with DllExport to have
@@ -54,7 +57,8 @@ namespace rsgis{ namespace cmds {
         histogram,
         exponential,
         logarithmic,
-        powerLaw
+        powerLaw,
+        approxPercentile
     };
     
     enum RSGISInitSharpenBandStatus
@@ -80,6 +84,44 @@ namespace rsgis{ namespace cmds {
         bool outRef;
     };
     
+    struct DllExport RSGISCmdBitField
+    {
+        unsigned int offset;
+        unsigned int width;
+    };
+    
+    struct DllExport RSGISCmdBitPatternRule
+    {
+        unsigned int bitMask;
+        unsigned int bitValue;
+        unsigned int outVal;
+    };
+    
+    /** How a command holds its data in memory, used to estimate its resources. */
+    enum RSGISCmdMemoryStrategy
+    {
+        /// Strips of the input and output images (e.g., band maths and the other image calculation engine commands)
+        rsgis_mem_strips = 0,
+        /// Whole attribute table columns (e.g., the rastergis commands using readDoubleColumn)
+        rsgis_mem_columns = 1,
+        /// Whole image bands (e.g., the commands using getImageBandValues)
+        rsgis_mem_bands = 2,
+        /// A clumps array of the image and per-clump structures (e.g., the segmentation clump elimination)
+        rsgis_mem_clumps = 3
+    };
+    
+    struct DllExport RSGISCmdResourceEstimate
+    {
+        /// The estimated peak memory (MB), after any out-of-core strategy has been applied.
+        double peakMemoryMB;
+        double readMB;
+        double writeMB;
+        /// Whether the command will use its out-of-core strategy (i.e., memory-mapped arrays).
+        bool outOfCore;
+        /// Whether the peak memory is within the memoryBudgetMB of the default execution context (always true without a budget).
+        bool withinBudget;
+    };
+    
     /** Function to run the stretch image command */
     DllExport void executeStretchImageNoData(std::string inputImage, std::string outputImage, double inNoData, bool saveOutStats, std::string outStatsFile, bool onePassSD, std::string gdalFormat, RSGISLibDataType outDataType, RSGISStretches stretchType, float stretchParam);
     
@@ -90,17 +132,25 @@ namespace rsgis{ namespace cmds {
     DllExport void executeNormaliseImgPxlVals(std::string inputImage, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, float inNoDataVal, float outNoDataVal, float outMinVal, float outMaxVal, RSGISStretches stretchType, float stretchParam);
     
     /** Function to run the mask image command */
-    DllExport void executeMaskImage(std::string inputImage, std::string imageMask, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, float outValue, std::vector<float> maskValues);
+    DllExport void executeMaskImage(std::string inputImage, std::string imageMask, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, float outValue, std::vector<float> maskValues, unsigned int numThreads=1);
+    
+    /** Function to run the mask image command where each mask value has its own output value */
+    DllExport void executeMaskImage(std::string inputImage, std::string imageMask, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, std::vector<float> maskValues, std::vector<double> outValues, unsigned int numThreads=1);
     
     /** A function to split an image into image tiles.
         An overlap between tiles may be specified.
         Optionally the tiles may be offset from the image boundries by half a pixel, useful for creating two overlapping lots of tiles.
         The filenames for each tile are passed back as a vector.
      */
-    DllExport void executeCreateTiles(std::string inputImage, std::string outputImageBase, unsigned int width, unsigned int height, unsigned int tileOverlap, bool offsetTiling, std::string gdalFormat, RSGISLibDataType outDataType, std::string outFileExtension, std::vector<std::string> *outFileNames = NULL);
+    DllExport void executeCreateTiles(std::string inputImage, std::string outputImageBase, unsigned int width, unsigned int height, unsigned int tileOverlap, bool offsetTiling, std::string gdalFormat, RSGISLibDataType outDataType, std::string outFileExtension, std::vector<std::string> *outFileNames = NULL, unsigned int numThreads = 1);
+    
+    /** A function to apply a set of tile masks (each the same size as the input image) to an image, where the input image is read once
+        for all the tiles rather than once per mask. The output pixels where the mask has the value maskValue are given the value outValue.
+     */
+    DllExport void executeCreateTilesFromMasks(std::string inputImage, std::vector<std::string> maskImages, std::vector<std::string> outputImages, std::string gdalFormat, RSGISLibDataType outDataType, float outValue, float maskValue, unsigned int numThreads=1);
     
-    /** A function to run the populate statistics command */
-    DllExport void executePopulateImgStats(std::string inputImage, bool useIgnoreVal, float nodataValue, bool calcImgPyramids, std::vector<int> pyraScaleVals=std::vector<int>());
+    /** A function to run the populate statistics command using numThreads threads (0 uses all available cores) */
+    DllExport void executePopulateImgStats(std::string inputImage, bool useIgnoreVal, float nodataValue, bool calcImgPyramids, std::vector<int> pyraScaleVals=std::vector<int>(), unsigned int numThreads=1);
     
     /** A function to mosaic a set of input images
         Pixels with a value of 'skipValue' in band 'skipBand' are excluded (all bands).
@@ -108,11 +158,21 @@ namespace rsgis{ namespace cmds {
         - The pixel is overwritten by the next image (overlapBehaviour=0)
         - The minimum value is taken (overlapBehaviour=1)
         - The maximum behaviour is taken (overlapBehaviour=1)
+        If outRefImage is not empty a reference image is also created where each pixel is the
+        row of the input it came from in the 'FileName' column of its attribute table.
      */
-    DllExport void executeImageMosaic(std::string *inputImages, int numDS, std::string outputImage, float background, float skipVal, unsigned int skipBand, unsigned int overlapBehaviour, std::string format, RSGISLibDataType outDataType);
+    DllExport void executeImageMosaic(std::string *inputImages, int numDS, std::string outputImage, float background, float skipVal, unsigned int skipBand, unsigned int overlapBehaviour, std::string format, RSGISLibDataType outDataType, unsigned int numThreads=1, std::string outRefImage="");
+    
+    /** A command to update an existing mosaic (created with executeImageMosaic) with new images,
+        where only the blocks of the mosaic covered by the new images are read and written.
+        If refImage is not empty the reference image of the mosaic is also updated, and where
+        updateStats and updateOverviews are true the statistics and overviews of the mosaic
+        (and reference image) are updated for the pixels changed rather than recalculated.
+     */
+    DllExport void executeImageMosaicUpdate(std::string *inputImages, int numDS, std::string mosaicImage, std::string refImage, float background, float skipVal, unsigned int skipBand, unsigned int overlapBehaviour, bool updateStats=true, bool updateOverviews=true, unsigned int numThreads=1);
     
     /** A command to add images to an existing image*/
-    DllExport void executeImageInclude(std::string *inputImages, int numDS, std::string baseImage, bool bandsDefined, std::vector<int> bands, float skipVal=0.0, bool useSkipVal=false);
+    DllExport void executeImageInclude(std::string *inputImages, int numDS, std::string baseImage, bool bandsDefined, std::vector<int> bands, float skipVal=0.0, bool useSkipVal=false, unsigned int numThreads=1);
     
     /** A command to add images to an existing image ignoring the overlaps*/
     DllExport void executeImageIncludeOverlap(std::string *inputImages, int numDS, std::string baseImage, int numOverlapPxls);
@@ -123,8 +183,10 @@ namespace rsgis{ namespace cmds {
     /** A command to create overview images in the base image by mosaicking the overviews from the tiles/subsets images */
     DllExport void executeImageIncludeOverviews(std::string baseImage, std::vector<std::string> inputImages, std::vector<int> pyraScaleVals);
     
-    /** A command to order a set of input images based on the proportion of valid data within each of the scenes */
-    DllExport std::vector<std::string> executeOrderImageUsingValidDataProp(std::vector<std::string> images, float noDataValue);
+    /** A command to order a set of input images based on the proportion of valid data within each of the scenes.
+        estMode: 0 = count all the pixels, 1 = estimate from an overview, 2 = estimate from a strided sample of blocks.
+        errTolerance is the maximum error (95% confidence) of an estimated proportion. */
+    DllExport std::vector<std::string> executeOrderImageUsingValidDataProp(std::vector<std::string> images, float noDataValue, unsigned int estMode=0, float errTolerance=0.01, unsigned int numThreads=1);
     
     /** A function to assign the projection on an image file */
     DllExport void executeAssignProj(std::string inputImage, std::string wktStr, bool readWKTFromFile=false, std::string wktFile="");
@@ -138,8 +200,9 @@ namespace rsgis{ namespace cmds {
     /** A function to copy the projection and spaital info from one file to another (i.e., similar to executeAssignProj and executeAssignSpatialInfo combined) */
     DllExport void executeCopyProjSpatial(std::string inputImage, std::string refImageFile);
     
-    /** A function to stack image bands into a single output image */
-    DllExport void executeStackImageBands(std::string *imageFiles, std::string *imageBandNames, int numImages, std::string outputImage, bool skipPixels, float skipValue, float noDataValue, std::string gdalFormat, RSGISLibDataType outDataType, bool replaceBandNames);
+    /** A function to stack image bands into a single output image. If gdalFormat is VRT then the output is a virtual
+        stack referencing the input bands, otherwise (unless pixels are skipped) the bands are copied reading the inputs using numThreads threads. */
+    DllExport void executeStackImageBands(std::string *imageFiles, std::string *imageBandNames, int numImages, std::string outputImage, bool skipPixels, float skipValue, float noDataValue, std::string gdalFormat, RSGISLibDataType outDataType, bool replaceBandNames, unsigned int numThreads=1);
     
 
     /** A function to subset an image to the bounding box of a polygon */
@@ -148,8 +211,12 @@ namespace rsgis{ namespace cmds {
     /** A function to subset an image to a bounding box */
     DllExport void executeSubsetBBox(std::string inputImage, std::string outputImage, std::string imageFormat, RSGISLibDataType outDataType, double xMin, double xMax, double yMin, double yMax);
     
-    /** A function to subset an image to polygons within shapefile */
-    DllExport void executeSubset2Polys(std::string inputImage, std::string inputVecFile, std::string inputVecLyr, std::string filenameAttribute, std::string outputImageBase, std::string imageFormat, RSGISLibDataType outDataType, std::string outFileExtension, std::vector<std::string> *outFileNames = NULL);
+    /** A function to subset an image to a set of bounding boxes (one output image per box), where the image is read once for all the
+        subsets and numThreads threads write the outputs. Boxes which do not overlap the image are skipped, the outputs created are returned in outFileNames. */
+    DllExport void executeSubsetBBoxes(std::string inputImage, std::vector<std::string> outputImages, std::string imageFormat, RSGISLibDataType outDataType, std::vector<double> xMins, std::vector<double> xMaxs, std::vector<double> yMins, std::vector<double> yMaxs, unsigned int numThreads=1, std::vector<std::string> *outFileNames = NULL);
+    
+    /** A function to subset an image to the envelopes of the polygons within a vector layer, named with the filenameAttribute (see executeSubsetBBoxes) */
+    DllExport void executeSubset2Polys(std::string inputImage, std::string inputVecFile, std::string inputVecLyr, std::string filenameAttribute, std::string outputImageBase, std::string imageFormat, RSGISLibDataType outDataType, std::string outFileExtension, std::vector<std::string> *outFileNames = NULL, unsigned int numThreads=1);
     
     /** A function to subset an image to another image*/
     DllExport void executeSubset2Img(std::string inputImage, std::string inputROIImage, std::string outputImage, std::string imageFormat, RSGISLibDataType outDataType);
@@ -176,28 +243,31 @@ namespace rsgis{ namespace cmds {
     DllExport void executeProduceRegularGridImage(std::string inputImage, std::string outputImage, std::string gdalFormat, float pxlRes, int minVal=0, int maxVal=1, bool singleLine=false);
     
     /** A function to produce a binary image for regions with finite data values */
-    DllExport void executeFiniteImageMask(std::string inputImage, std::string outputImage, std::string gdalFormat);
+    DllExport void executeFiniteImageMask(std::string inputImage, std::string outputImage, std::string gdalFormat, unsigned int numThreads=1);
         
-    /** A function to produce a binary image for valid regions within all the input images (i.e., not the no data value) */
-    DllExport void executeValidImageMask(std::vector<std::string> inputImages, std::string outputImage, std::string gdalFormat, float noDataVal=0.0);
+    /** A function to produce a binary image for valid regions within all (or if anyImgValid any) of the input images (i.e., not the no data value) */
+    DllExport void executeValidImageMask(std::vector<std::string> inputImages, std::string outputImage, std::string gdalFormat, float noDataVal=0.0, bool anyImgValid=false, unsigned int numThreads=1);
 
     /** A function to produce a binary mask with the edge pixels of the input image identified */
     DllExport void executeImageEdgeMask(std::string inputImage, std::string outputImage, std::string gdalFormat, unsigned int nEdgePxls);
 
     /** A function to combine images together into a single image band by excluding the no data value */
-    DllExport void executeCombineImagesSingleBandIgnoreNoData(std::vector<std::string> inputImages, std::string outputImage, float noDataVal, std::string gdalFormat, RSGISLibDataType outDataType);
+    DllExport void executeCombineImagesSingleBandIgnoreNoData(std::vector<std::string> inputImages, std::string outputImage, float noDataVal, std::string gdalFormat, RSGISLibDataType outDataType, unsigned int numThreads=1);
     
     /** A function to create a random sample of points within a mask */
     DllExport void executePerformRandomPxlSample(std::string inputImage, std::string outputImage, std::string gdalFormat, std::vector<int> maskVals, unsigned long numSamples);
     
     /** A function to create a random sample of points within a mask - for regions with smaller number of pixels within large image */
-    DllExport void executePerformRandomPxlSampleSmallPxlCount(std::string inputImage, std::string outputImage, std::string gdalFormat, std::vector<int> maskVals, unsigned long numSamples, int rndSeed);
+    DllExport void executePerformRandomPxlSampleSmallPxlCount(std::string inputImage, std::string outputImage, std::string gdalFormat, std::vector<int> maskVals, unsigned long numSamples, int rndSeed, bool useRowCounts=false);
+    
+    /** A function to save a sidecar index of the pixel locations of each value within an image band, used when sampling within classes and masks */
+    DllExport void executeCreatePxlIndexSidecar(std::string inputImage, unsigned int imgBand);
     
     /** A function to perform a pan-sharpening using a Hyperspherical Colour Space technique */
-    DllExport void executePerformHCSPanSharpen(std::string inputImage, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, unsigned int winSize=7, bool useNaiveMethod=false);
+    DllExport void executePerformHCSPanSharpen(std::string inputImage, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, unsigned int winSize=7, bool useNaiveMethod=false, unsigned int statsSampleSize=0);
     
     /** A function to sharpen nn resampled lower resolution image bands using high native resolution image bands in the same stack */
-    DllExport void executeSharpenLowResImgBands(std::string inputImage, std::string outputImage, std::vector<RSGISInitSharpenBandInfo> bandInfo, unsigned int winSize, int noDataVal, std::string gdalFormat, RSGISLibDataType outDataType);
+    DllExport void executeSharpenLowResImgBands(std::string inputImage, std::string outputImage, std::vector<RSGISInitSharpenBandInfo> bandInfo, unsigned int winSize, int noDataVal, std::string gdalFormat, RSGISLibDataType outDataType, bool useRunningSums=false);
     
     /** A function to create a composite image where the pixel from the image with the high NDVI is outputted. */
     DllExport void executeCreateMaxNDVICompsiteImage(std::vector<std::string> inputImages, std::string outputImage, unsigned int redBand, unsigned int nirBand, std::string gdalFormat, RSGISLibDataType outDataType);
@@ -205,6 +275,12 @@ namespace rsgis{ namespace cmds {
     /** A function to create a composite image where the pixel defined in the reference image is outputted - note the order of the input images needs to correspond with the indexes in the reference image. */
     DllExport void executeCreateRefImgCompsiteImage(std::vector<std::string> inputImages, std::string outputImage, std::string refImage, std::string gdalFormat, RSGISLibDataType outDataType, float outNoDataVal);
     
+    /** A function to create a composite image where each output pixel is the percentile (e.g., 50 for the median) of the valid values in the input images, calculated band by band. */
+    DllExport void executeCreatePercentileCompositeImage(std::vector<std::string> inputImages, std::string outputImage, float percentile, float noDataVal, float outNoDataVal, std::string gdalFormat, RSGISLibDataType outDataType);
+    
+    /** A function to create a composite image where the pixel from the medoid scene (the observation with the minimum sum of distances to the other valid observations across the bands specified) is outputted. */
+    DllExport void executeCreateMedoidCompositeImage(std::vector<std::string> inputImages, std::string outputImage, std::vector<unsigned int> bands, float noDataVal, float outNoDataVal, std::string gdalFormat, RSGISLibDataType outDataType);
+    
     /** A function to use the composite reference images to identify regions which need filling and creates a new reference image for each composite as to where the fill should come from. */
     DllExport void executeGenTimeseriesFillCompositeImg(std::vector<RSGISCmdCompositeInfo> inCompInfo, std::string validMaskImage, std::string outFillRefImg, std::string outCompImg, std::string outCompRefImg, std::string gdalFormat, RSGISLibDataType outDataType);
     
@@ -215,7 +291,61 @@ namespace rsgis{ namespace cmds {
     DllExport std::map<std::string, std::string> executeGetGDALImageCreationOpts(std::string gdalFormat);
 
     /** A function which unpacks the image pixel values to a multi band image */
-    DllExport void executeUnpackPxlValues(std::string inputImage, unsigned int inputImgBand, std::string outputImage, std::string gdalFormat);
+    DllExport void executeUnpackPxlValues(std::string inputImage, unsigned int inputImgBand, std::string outputImage, std::string gdalFormat, unsigned int numThreads=1);
+    
+    /** A function which decodes bit fields (offset and width) of an integer image band to a multi band image (1 band per field) */
+    DllExport void executeDecodeBitFields(std::string inputImage, unsigned int inputImgBand, std::string outputImage, std::string gdalFormat, std::vector<RSGISCmdBitField> bitFields, unsigned int numThreads=1);
+    
+    /** A function which creates a mask (e.g., cloud and shadow) from the first bit pattern rule matched by each pixel of an integer image band */
+    DllExport void executeGenBitPatternMask(std::string inputImage, unsigned int inputImgBand, std::string outputImage, std::string gdalFormat, std::vector<RSGISCmdBitPatternRule> rules, unsigned int noMatchVal=0, unsigned int numThreads=1);
+    
+    /** Function to set the number of strip buffers used by default for the image calculation I/O (1 is serial I/O) */
+    DllExport void executeSetCalcImageIOBuffers(unsigned int numBuffers);
+    
+    /** Function to get the number of strip buffers used by default for the image calculation I/O */
+    DllExport unsigned int executeGetCalcImageIOBuffers();
+    
+    /** Function to set the default execution context (strip memory, GDAL cache, threads and I/O buffers) of the image calculation engine */
+    DllExport void executeSetCalcImageExecContext(rsgis::RSGISExecutionContext context);
+    
+    /** Function to get the default execution context of the image calculation engine */
+    DllExport rsgis::RSGISExecutionContext executeGetCalcImageExecContext();
+    
+    /** Function to get the name of the OpenCL device used where the useGPU of the execution context is true (an empty string if there is no device) */
+    DllExport std::string executeGetGPUDeviceName();
+    
+    /** Function to set whether progress is reported (see rsgis::RSGISProgress), whether it is rendered to the terminal and the interval (milliseconds) between updates */
+    DllExport void executeSetProgressReporting(bool enabled, bool showBar, unsigned int intervalMS);
+    
+    /** Function to get the progress reporting settings (see executeSetProgressReporting) */
+    DllExport void executeGetProgressReporting(bool *enabled, bool *showBar, unsigned int *intervalMS);
+    
+    /** Function to set the callback receiving the progress of the commands (an empty function removes the callback) */
+    DllExport void executeSetProgressCallback(rsgis::RSGISProgressCallback callback);
+    
+    /**
+     * Function to estimate the peak memory and I/O of a command, using the default execution context,
+     * from the metadata of the input images (size, bands, data type, block size and number of clumps)
+     * without reading the image data. numOutBands and outDataType are for rsgis_mem_strips, numColumns
+     * for rsgis_mem_columns (inputImages are clumps images with attribute tables), and bytesPerClump is
+     * the size of the per-clump structures for rsgis_mem_clumps.
+     */
+    DllExport RSGISCmdResourceEstimate executeEstimateCmdResources(std::vector<std::string> inputImages, RSGISCmdMemoryStrategy strategy, unsigned int numOutBands=1, RSGISLibDataType outDataType=rsgis_32float, unsigned int numColumns=1, unsigned int bytesPerClump=32);
+    
+    /** Function to enable or disable the profiling of the image calculation engine (see rsgis::RSGISCalcImageProfiler) */
+    DllExport void executeSetCalcImageProfiling(bool enable);
+    
+    /** Function to get the image calculation profile totals since the last reset, optionally resetting them */
+    DllExport rsgis::RSGISCalcImageProfile executeGetCalcImageProfile(bool reset);
+    
+    /** A function to sample the values of the image bands (all bands if empty) at a set of points, reading each image block touched by a point once. The values are returned with numBands values per point; interp is 0 (nearest), 1 (bilinear) or 2 (cubic). */
+    DllExport std::vector<double> executeSampleImagePoints(std::string inputImage, std::vector<double> xLocs, std::vector<double> yLocs, std::vector<unsigned int> bands, int interp, double noDataVal, unsigned int numThreads=1);
+    
+    /** Function to calculate the (exact Euclidean) distance from each pixel to the nearest non-zero pixel of an image band and, if outLabelImage is not empty, the value of that pixel. Pixels further than maxDist (if > 0) are given noDataVal. */
+    DllExport void executeCalcDistToNearestFeature(std::string inputImage, unsigned int imgBand, std::string outDistImage, std::string outLabelImage, std::string gdalFormat, double maxDist, float noDataVal, bool useGeoUnits);
+    
+    /** Function to calculate the distance from each pixel to the nearest pixel of each class (all the non-zero values if classIDs is empty) in one pass, output to a band per class of a single image or to an image per class. Pixels further than maxDist (if > 0) are given noDataVal. */
+    DllExport void executeCalcDistToClasses(std::string inputImage, unsigned int imgBand, std::vector<unsigned long> classIDs, std::vector<std::string> outDistImages, std::string gdalFormat, double maxDist, float noDataVal, bool useGeoUnits);
     
 }}
 
@@ -27,12 +27,14 @@
 
 #include "common/RSGISImageException.h"
 #include "common/RSGISAttributeTableException.h"
+#include "common/RSGISGDALInit.h"
 
 #include "math/RSGISMathsUtils.h"
 
 #include "img/RSGISCalcImage.h"
 
 #include "vec/RSGISVectorUtils.h"
+#include "vec/RSGISCopyVecAtts2RATByOverlap.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
 #include "rastergis/RSGISExportColumns2Image.h"
@@ -53,16 +55,18 @@
 #include "rastergis/RSGISRATFunctionFitting.h"
 #include "rastergis/RSGISDefineClumpsInTiles.h"
 #include "rastergis/RSGISRATStats.h"
+#include "rastergis/RSGISRATColumnSummary.h"
 #include "rastergis/RSGISExportClumps2Imgs.h"
+#include "rastergis/RSGISClumpDistances.h"
 
 
 namespace rsgis{ namespace cmds {
 
-    void executePopulateStats(std::string clumpsImage, bool addColourTable2Img, bool calcImgPyramids, bool ignoreZero, unsigned int ratBand)
+    void executePopulateStats(std::string clumpsImage, bool addColourTable2Img, bool calcImgPyramids, bool ignoreZero, unsigned int ratBand, unsigned int numThreads)
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
             if(clumpsDataset == NULL)
@@ -73,28 +77,34 @@ namespace rsgis{ namespace cmds {
             rsgis::rastergis::RSGISPopulateWithImageStats popImageStats;
             int numBands = clumpsDataset->GetRasterCount();
 
+            std::vector<unsigned int> ratBands;
             if(ratBand > numBands)
             {
-                unsigned int band = 1;
                 for(unsigned int i = 0; i < numBands; ++i)
                 {
-                    band = i+1;
-                    std::cout << "Processing band " << band << std::endl;
-                    clumpsDataset->GetRasterBand(band)->SetMetadataItem("LAYER_TYPE", "thematic");
-                    
-                    popImageStats.populateImageWithRasterGISStats(clumpsDataset, addColourTable2Img, ignoreZero, band);
+                    ratBands.push_back(i+1);
                 }
             }
             else
             {
-                clumpsDataset->GetRasterBand(ratBand)->SetMetadataItem("LAYER_TYPE", "thematic");
-                
-                popImageStats.populateImageWithRasterGISStats(clumpsDataset, addColourTable2Img, ignoreZero, ratBand);
+                ratBands.push_back(ratBand);
             }
-                    
+            
             if(calcImgPyramids)
             {
-                popImageStats.calcPyramids(clumpsDataset);
+                // The histograms are calculated from the same read of the image as the pyramids.
+                popImageStats.populateImageWithRasterGISStatsAndPyramids(clumpsDataset, addColourTable2Img, ignoreZero, ratBands, numThreads);
+            }
+            else
+            {
+                for(std::vector<unsigned int>::iterator iterBand = ratBands.begin(); iterBand != ratBands.end(); ++iterBand)
+                {
+                    if(ratBands.size() > 1)
+                    {
+                        std::cout << "Processing band " << (*iterBand) << std::endl;
+                    }
+                    popImageStats.populateImageWithRasterGISStats(clumpsDataset, addColourTable2Img, ignoreZero, *iterBand);
+                }
             }
 
             GDALClose(clumpsDataset);
@@ -113,7 +123,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *inputDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(inputDataset == NULL)
             {
@@ -148,11 +158,38 @@ namespace rsgis{ namespace cmds {
         }
     }
 
+    void executeRechunkKEARAT(std::string inputImage, std::string outputImage, unsigned int chunkSize)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            GDALDataset *inputDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(inputDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+
+            rsgis::rastergis::RSGISRasterAttUtils attUtils;
+            attUtils.rechunkKEARAT(inputDataset, outputImage, chunkSize);
+
+            GDALClose(inputDataset);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+
     void executeCopyGDALATTColumns(std::string inputImage, std::string clumpsImage, std::vector<std::string> fields, bool copyColours, bool copyHist, int ratBand) 
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *inputDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(inputDataset == NULL)
             {
@@ -189,7 +226,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset *inputDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_Update);
             if(inputDataset == NULL)
@@ -217,7 +254,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *inputDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_Update);
             if(inputDataset == NULL)
@@ -245,7 +282,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpenShared(clumpsImage.c_str(), GA_Update);
             if(clumpsDataset == NULL)
@@ -306,11 +343,92 @@ namespace rsgis{ namespace cmds {
         }
     }
 
+    void executePopulateRATWithStatsSinglePass(std::string inputImage, std::string clumpsImage, std::vector<rsgis::cmds::RSGISBandAttStatsCmds*> *bandStatsCmds, unsigned int ratBand, unsigned int numThreads)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+
+            GDALDataset *clumpsDataset = (GDALDataset *) GDALOpenShared(clumpsImage.c_str(), GA_Update);
+            if(clumpsDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + clumpsImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            GDALDataset *imageDataset = (GDALDataset *) GDALOpenShared(inputImage.c_str(), GA_ReadOnly);
+            if(imageDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+
+            std::vector<rsgis::rastergis::RSGISBandAttStats*> *bandStats = new std::vector<rsgis::rastergis::RSGISBandAttStats*>();
+            bandStats->reserve(bandStatsCmds->size());
+
+            rsgis::rastergis::RSGISBandAttStats *bandStat = NULL;
+            for(std::vector<rsgis::cmds::RSGISBandAttStatsCmds*>::iterator iterBand = bandStatsCmds->begin(); iterBand != bandStatsCmds->end(); ++iterBand)
+            {
+                bandStat = new rsgis::rastergis::RSGISBandAttStats();
+                bandStat->init();
+                bandStat->band = (*iterBand)->band;
+                bandStat->calcMin = (*iterBand)->calcMin;
+                bandStat->minField = (*iterBand)->minField;
+                bandStat->calcMax = (*iterBand)->calcMax;
+                bandStat->maxField = (*iterBand)->maxField;
+                bandStat->calcMean = (*iterBand)->calcMean;
+                bandStat->meanField = (*iterBand)->meanField;
+                bandStat->calcStdDev = (*iterBand)->calcStdDev;
+                bandStat->stdDevField = (*iterBand)->stdDevField;
+                bandStat->calcSum = (*iterBand)->calcSum;
+                bandStat->sumField = (*iterBand)->sumField;
+                bandStat->calcCount = (*iterBand)->calcCount;
+                bandStat->countField = (*iterBand)->countField;
+                bandStat->calcMode = (*iterBand)->calcMode;
+                bandStat->modeField = (*iterBand)->modeField;
+                for(std::vector<rsgis::cmds::RSGISBandAttPercentilesCmds>::iterator iterPer = (*iterBand)->percentiles.begin(); iterPer != (*iterBand)->percentiles.end(); ++iterPer)
+                {
+                    rsgis::rastergis::RSGISBandAttPercentiles percentile;
+                    percentile.percentile = (*iterPer).percentile;
+                    percentile.fieldName = (*iterPer).fieldName;
+                    percentile.fieldIdx = 0;
+                    bandStat->percentiles.push_back(percentile);
+                }
+                bandStat->histMin = (*iterBand)->histMin;
+                bandStat->histMax = (*iterBand)->histMax;
+                bandStat->numHistBins = (*iterBand)->numHistBins;
+
+                bandStats->push_back(bandStat);
+            }
+
+            rsgis::rastergis::RSGISPopRATWithStats clumpStats;
+            clumpStats.populateRATWithStatsSinglePass(clumpsDataset, imageDataset, bandStats, ratBand, numThreads);
+
+            for(std::vector<rsgis::rastergis::RSGISBandAttStats*>::iterator iterBand = bandStats->begin(); iterBand != bandStats->end(); ++iterBand)
+            {
+                delete *iterBand;
+            }
+            delete bandStats;
+
+            clumpsDataset->GetRasterBand(ratBand)->SetMetadataItem("LAYER_TYPE", "thematic");
+
+            GDALClose(clumpsDataset);
+            GDALClose(imageDataset);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+
     void executePopulateRATWithPercentiles(std::string inputImage, std::string clumpsImage, unsigned int band, std::vector<rsgis::cmds::RSGISBandAttPercentilesCmds*> *bandPercentilesCmds, unsigned int ratBand, unsigned int numHistBins)
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpenShared(clumpsImage.c_str(), GA_Update);
             if(clumpsDataset == NULL)
@@ -368,7 +486,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             std::cout << "Opening Clumps Image: " << clumpsImage << std::endl;
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpenShared(clumpsImage.c_str(), GA_Update);
             if(clumpsDataset == NULL)
@@ -406,7 +524,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             std::cout << "Opening Clumps Image: " << clumpsImage << std::endl;
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpenShared(clumpsImage.c_str(), GA_Update);
             if(clumpsDataset == NULL)
@@ -445,7 +563,7 @@ namespace rsgis{ namespace cmds {
     void executeCopyCategoriesColours(std::string categoriesImage, std::string clumpsImage, std::string classField) {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpenShared(clumpsImage.c_str(), GA_Update);
             if(clumpsDataset == NULL)
@@ -482,7 +600,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset *inputDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_Update);
             if(inputDataset == NULL)
@@ -494,19 +612,11 @@ namespace rsgis{ namespace cmds {
             rsgis::rastergis::RSGISRasterAttUtils attUtils;
             GDALRasterAttributeTable *gdalATT = inputDataset->GetRasterBand(ratBand)->GetDefaultRAT();
 
-            std::string *bandNames = new std::string[1];
-            bandNames[0] = field;
-
             // Get column intex in RAT
             unsigned int columnIndex = attUtils.findColumnIndex(gdalATT, field);
 
-            rsgis::rastergis::RSGISExportColumns2ImageCalcImage *calcImageVal = new rsgis::rastergis::RSGISExportColumns2ImageCalcImage(1, gdalATT, columnIndex);
-            rsgis::img::RSGISCalcImage calcImage(calcImageVal);
-
-            calcImage.calcImage(&inputDataset, 1, 0, outputFile, true, bandNames, imageFormat, RSGIS_to_GDAL_Type(outDataType));
-
-            delete calcImageVal;
-            delete[] bandNames;
+            rsgis::rastergis::RSGISExportColumns2Image exportCol;
+            exportCol.exportColumn2Image(inputDataset, ratBand, columnIndex, outputFile, imageFormat, RSGIS_to_GDAL_Type(outDataType), field);
 
             GDALClose(inputDataset);
         }
@@ -521,7 +631,7 @@ namespace rsgis{ namespace cmds {
     }
     /*
     void executeEucDistFromFeature(std::string inputImage, size_t fid, std::string outputField, std::vector<std::string> fields) {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
 
         try {
@@ -541,7 +651,7 @@ namespace rsgis{ namespace cmds {
     }
 
     void executeFindTopN(std::string inputImage, std::string spatialDistField, std::string distanceField, std::string outputField, unsigned int nFeatures, float distThreshold) {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
 
         try {
@@ -562,7 +672,7 @@ namespace rsgis{ namespace cmds {
     }
 
     void executeFindSpecClose(std::string inputImage, std::string distanceField, std::string spatialDistField, std::string outputField, float specDistThreshold, float distThreshold) {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
 
         try {
@@ -585,7 +695,7 @@ namespace rsgis{ namespace cmds {
 */
     void executeApplyKNN(std::string inClumpsImage, unsigned int ratBand, std::string inExtrapField, std::string outExtrapField, std::string trainRegionsField, std::string applyRegionsField, bool useApplyField, std::vector<std::string> fields, unsigned int kFeatures, rsgisKNNDistCmd distKNNCmd, float distThreshold, rsgisKNNSummeriseCmd summeriseKNNCmd) 
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *clumpsDataset;
 
         try
@@ -677,7 +787,7 @@ namespace rsgis{ namespace cmds {
 
     void executeExport2Ascii(std::string inputImage, std::string outputFile, std::vector<std::string> fields, int ratBand)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
 
         try {
@@ -699,7 +809,7 @@ namespace rsgis{ namespace cmds {
     }
 /*
     void executeClassTranslate(std::string inputImage, std::string classInField, std::string classOutField, std::map<size_t, size_t> classPairs) {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
 
         try {
@@ -721,7 +831,7 @@ namespace rsgis{ namespace cmds {
 */
     void executeColourClasses(std::string inputImage, std::string classInField, std::map<size_t, RSGISColourIntCmds> classColourPairs, int ratBand)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
 
         try
@@ -760,7 +870,7 @@ namespace rsgis{ namespace cmds {
 
     void executeColourStrClasses(std::string inputImage, std::string classInField, std::map<std::string, RSGISColourIntCmds> classStrColourPairs, int ratBand)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
         try
         {
@@ -796,7 +906,7 @@ namespace rsgis{ namespace cmds {
     }
 /*
     void executeGenerateColourTable(std::string inputImage, std::string clumpsImage, unsigned int redBand, unsigned int greenBand, unsigned int blueBand) {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset, *clumpsDataset;
         try {
             inputDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_Update);
@@ -827,7 +937,7 @@ namespace rsgis{ namespace cmds {
             
     void executeStrClassMajority(std::string baseSegment, std::string infoSegment, std::string baseClassCol, std::string infoClassCol, bool ignoreZero, int baseRatBand, int infoRatBand)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *baseSegDataset, *infoSegDataset;
         try
         {
@@ -859,7 +969,7 @@ namespace rsgis{ namespace cmds {
             
 /*
     void executeSpecDistMajorityClassifier(std::string inputImage, std::string inClassNameField, std::string outClassNameField, std::string trainingSelectCol, std::string eastingsField, std::string northingsField, std::string areaField, std::string majWeightField, std::vector<std::string> fields, float distThreshold, float specDistThreshold, SpectralDistanceMethodCmds distMethod, float specThresOriginDist) {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
         try {
             inputDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_Update);
@@ -881,7 +991,7 @@ namespace rsgis{ namespace cmds {
 
     void executeMaxLikelihoodClassifier(std::string inputImage, std::string inClassNameField, std::string outClassNameField, std::string trainingSelectCol,
             std::string classifySelectCol, std::string areaField, std::vector<std::string> fields, rsgismlpriorscmds priorsMethod, std::vector<std::string> priorStrs) {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
         std::vector<float> priors;
         try
@@ -919,7 +1029,7 @@ namespace rsgis{ namespace cmds {
     void executeMaxLikelihoodClassifierLocalPriors(std::string inputImage, std::string inClassNameField, std::string outClassNameField, std::string trainingSelectCol, std::string classifySelectCol,
                                                   std::string areaField, std::vector<std::string> fields, std::string eastingsField, std::string northingsField,
                                                   float distThreshold, rsgismlpriorscmds priorsMethod, float weightA, bool allowZeroPriors, bool forceChangeInClassification) {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
         try {
             inputDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_Update);
@@ -942,7 +1052,7 @@ namespace rsgis{ namespace cmds {
     }
 
     void executeClassMask(std::string inputImage, std::string classField, std::string className, std::string outputFile, std::string imageFormat, RSGISLibDataType dataType) {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
         try {
             inputDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_Update);
@@ -975,7 +1085,7 @@ namespace rsgis{ namespace cmds {
 */
     void executeFindNeighbours(std::string inputImage, unsigned int ratBand)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
         try
         {
@@ -1000,7 +1110,7 @@ namespace rsgis{ namespace cmds {
 
     void executeFindBoundaryPixels(std::string inputImage, unsigned int ratBand, std::string outputFile, std::string imageFormat)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
         try
         {
@@ -1027,7 +1137,7 @@ namespace rsgis{ namespace cmds {
 
     void executeCalcBorderLength(std::string inputImage, bool ignoreZeroEdges, std::string outColsName)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
         try
         {
@@ -1052,7 +1162,7 @@ namespace rsgis{ namespace cmds {
 
     void executeCalcRelBorder(std::string inputImage, std::string outColsName, std::string classNameField, std::string className, bool ignoreZeroEdges)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
         try
         {
@@ -1075,7 +1185,7 @@ namespace rsgis{ namespace cmds {
     }
 /*
     void executeCalcShapeIndices(std::string inputImage, std::vector<RSGISShapeParamCmds> shapeIndexes) {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *inputDataset;
         try
         {
@@ -1118,7 +1228,7 @@ namespace rsgis{ namespace cmds {
 */
 
     void executeDefineClumpTilePositions(std::string clumpsImage, std::string tileImage, std::string outColsName, unsigned int tileOverlap, unsigned int tileBoundary, unsigned int tileBody) {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *clumpsDataset, *tileDataset;
         try {
             clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
@@ -1145,7 +1255,7 @@ namespace rsgis{ namespace cmds {
 
     void executeDefineBorderClumps(std::string clumpsImage, std::string outColsName)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
 
         try
         {
@@ -1172,7 +1282,7 @@ namespace rsgis{ namespace cmds {
         try
         {
             std::cout << "Opening RAT" << std::endl;
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
             if(clumpsDataset == NULL)
             {
@@ -1250,7 +1360,7 @@ namespace rsgis{ namespace cmds {
         try
         {
             std::cout << "Opening RAT" << std::endl;
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
             if(clumpsDataset == NULL)
             {
@@ -1326,7 +1436,7 @@ namespace rsgis{ namespace cmds {
  
     void executeIdentifyClumpExtremesOnGrid(std::string clumpsImage, std::string inSelectField, std::string outSelectField, std::string eastingsCol, std::string northingsCol, std::string methodStr, unsigned int rows, unsigned int cols, std::string metricField)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *clumpsDataset;
 
         try
@@ -1375,7 +1485,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             std::cout.precision(12);
             
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
@@ -1417,7 +1527,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpenShared(clumpsImage.c_str(), GA_Update);
             if(clumpsDataset == NULL)
@@ -1493,7 +1603,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpenShared(clumpsImage.c_str(), GA_ReadOnly);
             if(clumpsDataset == NULL)
@@ -1521,8 +1631,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
-            OGRRegisterAll();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpenShared(clumpsImage.c_str(), GA_Update);
             if(clumpsDataset == NULL)
@@ -1574,6 +1683,57 @@ namespace rsgis{ namespace cmds {
         }
     }
             
+    void executeImportVecAttsByOverlap(std::string clumpsImage, unsigned int ratBand, std::string inputVector, std::string inputVectorLyr, std::vector<std::string> colNames, float minPropOverlap, std::string outFIDCol)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+
+            GDALDataset *clumpsDataset = (GDALDataset *) GDALOpenShared(clumpsImage.c_str(), GA_Update);
+            if(clumpsDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + clumpsImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+
+            inputVector = boost::filesystem::absolute(inputVector).string();
+            GDALDataset *inputVecDS = (GDALDataset*) GDALOpenEx(inputVector.c_str(), GDAL_OF_VECTOR, NULL, NULL, NULL);
+            if(inputVecDS == NULL)
+            {
+                std::string message = std::string("Could not open vector file ") + inputVector;
+                throw RSGISFileException(message.c_str());
+            }
+
+            OGRLayer *inputVecLyr = inputVecDS->GetLayerByName(inputVectorLyr.c_str());
+            if(inputVecLyr == NULL)
+            {
+                std::string message = std::string("Could not open vector layer ") + inputVectorLyr;
+                throw RSGISFileException(message.c_str());
+            }
+
+            if(colNames.empty())
+            {
+                std::cout << "No column names were specified so copying them all.\n";
+                rsgis::vec::RSGISVectorUtils vecUtils;
+                colNames = vecUtils.getColumnNamesLitVec(inputVecLyr);
+            }
+
+            rsgis::vec::RSGISCopyVecAtts2RATByOverlap copyVecAtts2RAT;
+            copyVecAtts2RAT.copyVectorAtt2Rat(clumpsDataset, ratBand, inputVecLyr, &colNames, minPropOverlap, outFIDCol);
+
+            GDALClose(clumpsDataset);
+            GDALClose(inputVecDS);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+
     void executeHistSampling(std::string clumpsImage, unsigned int ratBand, std::string varCol, std::string outSelectCol, float propOfSample, float binWidth, bool classRestrict, std::string classColumn, std::string classVal)
     {
         try
@@ -1583,7 +1743,7 @@ namespace rsgis{ namespace cmds {
                 throw rsgis::RSGISException("The proportion of the sample should be > 0 and < 1.");
             }
             
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             std::cout.precision(12);
             
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
@@ -1613,7 +1773,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             std::cout.precision(12);
             
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
@@ -1642,7 +1802,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             std::cout.precision(12);
             
             GDALDataset *clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
@@ -1671,7 +1831,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             std::cout.precision(12);
             
             std::cout << "Opening Clumps Image: " << clumpsImage << std::endl;
@@ -1715,7 +1875,7 @@ namespace rsgis{ namespace cmds {
         float dist = 0.0;
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             std::cout.precision(12);
             
             std::cout << "Opening Clumps Image: " << clumpsImage << std::endl;
@@ -1748,7 +1908,7 @@ namespace rsgis{ namespace cmds {
         float dist = 0.0;
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             std::cout.precision(12);
             
             std::cout << "Opening Clumps Image: " << clumpsImage << std::endl;
@@ -1781,7 +1941,7 @@ namespace rsgis{ namespace cmds {
         float dist = 0.0;
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             std::cout.precision(12);
             
             std::cout << "Opening Clumps Image: " << clumpsImage << std::endl;
@@ -1810,11 +1970,129 @@ namespace rsgis{ namespace cmds {
     }
     
     
-    void executeExportClumps2Images(std::string clumpsImage, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, unsigned int ratBand)
+    std::vector<float> executeCalcSeparabilities(std::string clumpsImage, std::vector<RSGISSeparabilityCalcCmds> sepCalcs, unsigned int ratBand, unsigned int numThreads)
+    {
+        std::vector<float> dists;
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            
+            std::cout << "Opening Clumps Image: " << clumpsImage << std::endl;
+            GDALDataset *clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_ReadOnly);
+            if(clumpsDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + clumpsImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            std::vector<rsgis::rastergis::RSGISSeparabilityCalc> calcs;
+            for(std::vector<RSGISSeparabilityCalcCmds>::iterator iterCalc = sepCalcs.begin(); iterCalc != sepCalcs.end(); ++iterCalc)
+            {
+                rsgis::rastergis::RSGISSeparabilityCalc calc;
+                if((*iterCalc).measure == rsgisSepJM1DCmd)
+                {
+                    calc.measure = rsgis::rastergis::rsgisSepJM1D;
+                }
+                else if((*iterCalc).measure == rsgisSepJM2DCmd)
+                {
+                    calc.measure = rsgis::rastergis::rsgisSepJM2D;
+                }
+                else if((*iterCalc).measure == rsgisSepBhattacharyyaCmd)
+                {
+                    calc.measure = rsgis::rastergis::rsgisSepBhattacharyya;
+                }
+                else
+                {
+                    GDALClose(clumpsDataset);
+                    throw RSGISCmdException("The separability measure is not recognised.");
+                }
+                calc.var1Col = (*iterCalc).var1Col;
+                calc.var2Col = (*iterCalc).var2Col;
+                calc.var1BinWidth = (*iterCalc).var1BinWidth;
+                calc.var2BinWidth = (*iterCalc).var2BinWidth;
+                calc.classColumn = (*iterCalc).classColumn;
+                calc.class1Val = (*iterCalc).class1Val;
+                calc.class2Val = (*iterCalc).class2Val;
+                calcs.push_back(calc);
+            }
+            
+            rsgis::rastergis::RSGISRATStats calcRATStats;
+            dists = calcRATStats.calcSeparabilities(clumpsDataset, calcs, ratBand, numThreads);
+            
+            GDALClose(clumpsDataset);
+        }
+        catch(RSGISCmdException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISAttributeTableException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        
+        return dists;
+    }
+    
+    
+    RSGISRATColumnSummaryCmds executeGetColumnSummary(std::string clumpsImage, std::string colName, std::string classColumn, std::string classVal, unsigned int ratBand)
     {
+        RSGISRATColumnSummaryCmds summaryCmds;
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
+            
+            // Open for update so the summary can be stored with the RAT.
+            GDALDataset *clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
+            if(clumpsDataset == NULL)
+            {
+                clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_ReadOnly);
+            }
+            if(clumpsDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + clumpsImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            if((ratBand == 0) || (ratBand > ((unsigned int)clumpsDataset->GetRasterCount())))
+            {
+                GDALClose(clumpsDataset);
+                throw RSGISCmdException("The RAT band is not within the image.");
+            }
+            
+            rsgis::rastergis::RSGISRATColumnSummary summary = rsgis::rastergis::RSGISRATColumnSummaries::getColumnSummary(clumpsDataset->GetRasterBand(ratBand), colName, classColumn, classVal);
+            summaryCmds.numVals = summary.numVals;
+            summaryCmds.minVal = summary.minVal;
+            summaryCmds.maxVal = summary.maxVal;
+            summaryCmds.mean = summary.mean;
+            summaryCmds.histCounts = summary.histCounts;
+            
+            GDALClose(clumpsDataset);
+        }
+        catch(RSGISCmdException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISAttributeTableException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        
+        return summaryCmds;
+    }
+    
+        void executeExportClumps2Images(std::string clumpsImage, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, unsigned int ratBand, unsigned int maxOpenOutputs)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
             std::cout.precision(12);
             
             std::cout << "Opening Clumps Image: " << clumpsImage << std::endl;
@@ -1830,7 +2108,7 @@ namespace rsgis{ namespace cmds {
             calcLoc.populateAttWithClumpPxlLocation(clumpsDataset, ratBand, "MinXPxl", "MaxXPxl", "MinYPxl", "MaxYPxl");
             
             rsgis::rastergis::RSGISExportClumps2Images exportClumps;
-            exportClumps.exportClumps2Images(clumpsDataset, outImgBase, imgFileExt, imageFormat, binaryOut, "MinXPxl", "MaxXPxl", "MinYPxl", "MaxYPxl", "MinXX", "MaxYY", ratBand);
+            exportClumps.exportClumps2Images(clumpsDataset, outImgBase, imgFileExt, imageFormat, binaryOut, "MinXPxl", "MaxXPxl", "MinYPxl", "MaxYPxl", "MinXX", "MaxYY", ratBand, maxOpenOutputs);
             
             GDALClose(clumpsDataset);
         }
@@ -1843,6 +2121,265 @@ namespace rsgis{ namespace cmds {
             throw RSGISCmdException(e.what());
         }
     }
+    
+    /** Read an integer RAT column as a selection (non-zero values) with a row per clump, where all the clumps are selected if colName is "". */
+    static std::vector<bool> readClumpSelection(rsgis::rastergis::RSGISRasterAttUtils *attUtils, GDALRasterAttributeTable *attTable, std::string colName, size_t numRows)
+    {
+        std::vector<bool> selected(numRows, true);
+        if(numRows > 0)
+        {
+            selected[0] = false;
+        }
+        if(colName != "")
+        {
+            size_t colLen = 0;
+            int *colVals = attUtils->readIntColumn(attTable, colName, &colLen);
+            for(size_t i = 0; i < numRows; ++i)
+            {
+                selected[i] = (i > 0) && (i < colLen) && (colVals[i] != 0);
+            }
+            delete[] colVals;
+        }
+        return selected;
+    }
+    
+    /** Open the clumps image for update, check its RAT band and create the distances index from its pixel size. */
+    static rsgis::rastergis::RSGISClumpDistances* openClumpDistances(std::string clumpsImage, unsigned int ratBand, GDALDataset **clumpsDataset)
+    {
+        *clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
+        if(*clumpsDataset == NULL)
+        {
+            std::string message = std::string("Could not open image ") + clumpsImage;
+            throw rsgis::RSGISImageException(message.c_str());
+        }
+        if((ratBand == 0) || (ratBand > ((unsigned int)(*clumpsDataset)->GetRasterCount())))
+        {
+            GDALClose(*clumpsDataset);
+            throw RSGISCmdException("The RAT band is not within the image.");
+        }
+        
+        double trans[6];
+        (*clumpsDataset)->GetGeoTransform(trans);
+        
+        rsgis::rastergis::RSGISClumpDistances *clumpDists = NULL;
+        try
+        {
+            clumpDists = new rsgis::rastergis::RSGISClumpDistances(*clumpsDataset, ratBand, fabs(trans[1]), fabs(trans[5]));
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            GDALClose(*clumpsDataset);
+            throw e;
+        }
+        
+        GDALRasterAttributeTable *attTable = (*clumpsDataset)->GetRasterBand(ratBand)->GetDefaultRAT();
+        if(((size_t)attTable->GetRowCount()) < clumpDists->getNumClumps())
+        {
+            attTable->SetRowCount(clumpDists->getNumClumps());
+        }
+        return clumpDists;
+    }
+    
+    void executeCalcDistToNearestClumps(std::string clumpsImage, std::string outColName, std::string targetCol, std::string queryCol, bool excludeSelf, double maxDist, std::string outClumpCol, unsigned int ratBand, unsigned int numThreads)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
             
+            GDALDataset *clumpsDataset = NULL;
+            rsgis::rastergis::RSGISClumpDistances *clumpDists = openClumpDistances(clumpsImage, ratBand, &clumpsDataset);
+            GDALRasterAttributeTable *attTable = clumpsDataset->GetRasterBand(ratBand)->GetDefaultRAT();
+            size_t numRows = attTable->GetRowCount();
+            
+            rsgis::rastergis::RSGISRasterAttUtils attUtils;
+            std::vector<bool> targetClumps = readClumpSelection(&attUtils, attTable, targetCol, numRows);
+            std::vector<bool> queryClumps = readClumpSelection(&attUtils, attTable, queryCol, numRows);
+            
+            // Clumps without a target within the distance are given maxDist (or -1 if there is no maximum).
+            double noDataVal = (maxDist > 0)?maxDist:-1;
+            std::vector<double> dists;
+            std::vector<size_t> nearest;
+            clumpDists->findNearestClumps(queryClumps, targetClumps, excludeSelf, maxDist, noDataVal, &dists, &nearest, numThreads);
+            delete clumpDists;
+            
+            for(size_t i = 0; i < numRows; ++i)
+            {
+                if(!queryClumps[i])
+                {
+                    dists[i] = 0;
+                }
+            }
+            attUtils.writeRealColumn(attTable, outColName, dists.data(), numRows);
+            
+            if(outClumpCol != "")
+            {
+                std::vector<int> nearestVals(numRows, 0);
+                for(size_t i = 0; i < numRows; ++i)
+                {
+                    nearestVals[i] = nearest[i];
+                }
+                attUtils.writeIntColumn(attTable, outClumpCol, nearestVals.data(), numRows);
+            }
+            
+            GDALClose(clumpsDataset);
+        }
+        catch(RSGISCmdException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISAttributeTableException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+    
+    void executeCalcClumpDistToClasses(std::string clumpsImage, std::string classCol, std::string outColPrefix, double maxDist, unsigned int ratBand, unsigned int numThreads)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            
+            GDALDataset *clumpsDataset = NULL;
+            rsgis::rastergis::RSGISClumpDistances *clumpDists = openClumpDistances(clumpsImage, ratBand, &clumpsDataset);
+            GDALRasterAttributeTable *attTable = clumpsDataset->GetRasterBand(ratBand)->GetDefaultRAT();
+            size_t numRows = attTable->GetRowCount();
+            
+            rsgis::rastergis::RSGISRasterAttUtils attUtils;
+            size_t colLen = 0;
+            int *classVals = attUtils.readIntColumn(attTable, classCol, &colLen);
+            std::vector<int> classes;
+            for(size_t i = 1; i < colLen; ++i)
+            {
+                if(classVals[i] != 0)
+                {
+                    classes.push_back(classVals[i]);
+                }
+            }
+            std::sort(classes.begin(), classes.end());
+            classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+            
+            // The same index is used for all the classes.
+            std::vector<bool> queryClumps(numRows, true);
+            queryClumps[0] = false;
+            double noDataVal = (maxDist > 0)?maxDist:-1;
+            std::vector<double> dists;
+            std::vector<size_t> nearest;
+            for(std::vector<int>::iterator iterClass = classes.begin(); iterClass != classes.end(); ++iterClass)
+            {
+                std::cout << "Class " << *iterClass << std::endl;
+                std::vector<bool> targetClumps(numRows, false);
+                for(size_t i = 1; i < colLen; ++i)
+                {
+                    targetClumps[i] = (classVals[i] == *iterClass);
+                }
+                clumpDists->findNearestClumps(queryClumps, targetClumps, false, maxDist, noDataVal, &dists, &nearest, numThreads);
+                dists[0] = 0;
+                attUtils.writeRealColumn(attTable, outColPrefix + std::to_string(*iterClass), dists.data(), numRows);
+            }
+            delete[] classVals;
+            delete clumpDists;
+            
+            GDALClose(clumpsDataset);
+        }
+        catch(RSGISCmdException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISAttributeTableException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+            
+    // Opens the clumps image (for update if writing) and reads or writes the rows of the column through the RAT
+    // utilities, directly to/from data.
+    template<typename T>
+    static void rsgisCmdRATColumnChunkIO(std::string clumpsImage, std::string colName, size_t startRow, size_t numRows, T *data, unsigned int ratBand, bool write)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            
+            GDALDataset *clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), write?GA_Update:GA_ReadOnly);
+            if(clumpsDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + clumpsImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            if((ratBand == 0) || (ratBand > ((unsigned int)clumpsDataset->GetRasterCount())))
+            {
+                GDALClose(clumpsDataset);
+                throw RSGISCmdException("The RAT band is not within the image.");
+            }
+            
+            GDALRasterAttributeTable *gdalRAT = clumpsDataset->GetRasterBand(ratBand)->GetDefaultRAT();
+            if(gdalRAT == NULL)
+            {
+                GDALClose(clumpsDataset);
+                throw RSGISCmdException("The image band does not have a RAT.");
+            }
+            
+            try
+            {
+                rsgis::rastergis::RSGISRasterAttUtils attUtils;
+                if(write)
+                {
+                    attUtils.writeColumnChunk(gdalRAT, colName, startRow, numRows, data);
+                }
+                else
+                {
+                    attUtils.readColumnChunk(gdalRAT, colName, startRow, numRows, data);
+                }
+            }
+            catch(rsgis::RSGISException &)
+            {
+                GDALClose(clumpsDataset);
+                throw;
+            }
+            
+            GDALClose(clumpsDataset);
+        }
+        catch(RSGISCmdException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISAttributeTableException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+    
+    void executeReadRATColumnChunk(std::string clumpsImage, std::string colName, size_t startRow, size_t numRows, double *data, unsigned int ratBand)
+    {
+        rsgisCmdRATColumnChunkIO<double>(clumpsImage, colName, startRow, numRows, data, ratBand, false);
+    }
+    
+    void executeReadRATColumnChunk(std::string clumpsImage, std::string colName, size_t startRow, size_t numRows, int *data, unsigned int ratBand)
+    {
+        rsgisCmdRATColumnChunkIO<int>(clumpsImage, colName, startRow, numRows, data, ratBand, false);
+    }
+    
+    void executeWriteRATColumnChunk(std::string clumpsImage, std::string colName, size_t startRow, size_t numRows, double *data, unsigned int ratBand)
+    {
+        rsgisCmdRATColumnChunkIO<double>(clumpsImage, colName, startRow, numRows, data, ratBand, true);
+    }
+    
+    void executeWriteRATColumnChunk(std::string clumpsImage, std::string colName, size_t startRow, size_t numRows, int *data, unsigned int ratBand)
+    {
+        rsgisCmdRATColumnChunkIO<int>(clumpsImage, colName, startRow, numRows, data, ratBand, true);
+    }
+    
 }}
-
@@ -101,6 +101,42 @@ namespace rsgis{ namespace cmds {
         rsgis_shapeindex = 16
     };
 
+    enum rsgisSeparabilityCmd
+    {
+        rsgisSepJM1DCmd = 0,
+        rsgisSepJM2DCmd = 1,
+        rsgisSepBhattacharyyaCmd = 2
+    };
+    
+    /** A separability calculation for executeCalcSeparabilities; var2Col and the bin widths are only used by the JM distances. */
+    struct DllExport RSGISSeparabilityCalcCmds
+    {
+        rsgisSeparabilityCmd measure;
+        std::string var1Col;
+        std::string var2Col;
+        float var1BinWidth;
+        float var2BinWidth;
+        std::string classColumn;
+        std::string class1Val;
+        std::string class2Val;
+    };
+
+    /** The summary of a RAT column returned by executeGetColumnSummary. */
+    struct DllExport RSGISRATColumnSummaryCmds
+    {
+        size_t numVals;
+        double minVal;
+        double maxVal;
+        double mean;
+        std::vector<size_t> histCounts;
+    };
+    
+    struct DllExport RSGISBandAttPercentilesCmds
+    {
+        float percentile;
+        std::string fieldName;
+    };
+    
     struct DllExport RSGISBandAttStatsCmds
     {
         unsigned int band;
@@ -114,6 +150,15 @@ namespace rsgis{ namespace cmds {
         std::string stdDevField;
         bool calcSum;
         std::string sumField;
+        /** The following are only used by executePopulateRATWithStatsSinglePass */
+        bool calcCount;
+        std::string countField;
+        bool calcMode;
+        std::string modeField;
+        std::vector<RSGISBandAttPercentilesCmds> percentiles;
+        double histMin;
+        double histMax;
+        unsigned int numHistBins;
     };
     
     struct DllExport RSGISFieldAttStatsCmds
@@ -131,11 +176,6 @@ namespace rsgis{ namespace cmds {
         std::string sumField;
     };
 
-    struct DllExport RSGISBandAttPercentilesCmds
-    {
-        float percentile;
-        std::string fieldName;
-    };
 /*
     struct DllExport RSGISShapeParamCmds
     {
@@ -184,11 +224,14 @@ namespace rsgis{ namespace cmds {
     };
 
     /** Function to populate statics for thermatic images */
-    DllExport void executePopulateStats(std::string clumpsImage, bool addColourTable2Img, bool calcImgPyramids, bool ignoreZero, unsigned int ratBand);
+    DllExport void executePopulateStats(std::string clumpsImage, bool addColourTable2Img, bool calcImgPyramids, bool ignoreZero, unsigned int ratBand, unsigned int numThreads=1);
 
     /** Function for copying a GDAL RAT from one image to anoother */
     DllExport void executeCopyRAT(std::string inputImage, std::string clumpsImage, int ratBand=1);
 
+    /** Function to copy an image to a KEA image with the RAT chunked with chunkSize rows (0 chooses the chunk size for the number of rows) */
+    DllExport void executeRechunkKEARAT(std::string inputImage, std::string outputImage, unsigned int chunkSize=0);
+
     /** Function for copying GDAL RAT columns from one image to another */
     DllExport void executeCopyGDALATTColumns(std::string inputImage, std::string clumpsImage, std::vector<std::string> fields, bool copyColours=false, bool copyHist=false, int ratBand=1);
 
@@ -201,6 +244,9 @@ namespace rsgis{ namespace cmds {
     /** Function for populating an attribute table from an image */
     DllExport void executePopulateRATWithStats(std::string inputImage, std::string clumpsImage, std::vector<rsgis::cmds::RSGISBandAttStatsCmds*> *bandStatsCmds, unsigned int ratBand);
 
+    /** Function for populating an attribute table with any mix of the basic statistics, count, mode and percentiles in a single pass of the images */
+    DllExport void executePopulateRATWithStatsSinglePass(std::string inputImage, std::string clumpsImage, std::vector<rsgis::cmds::RSGISBandAttStatsCmds*> *bandStatsCmds, unsigned int ratBand, unsigned int numThreads=1);
+
     /** Function for populating an attribute table with a percentile of the pixel values */
     DllExport void executePopulateRATWithPercentiles(std::string inputImage, std::string clumpsImage, unsigned int band, std::vector<rsgis::cmds::RSGISBandAttPercentilesCmds*> *bandPercentilesCmds, unsigned int ratBand, unsigned int numHistBins);
 
@@ -300,6 +346,9 @@ namespace rsgis{ namespace cmds {
     /** Function for importing attribute table from a shapefile into a RAT */
     DllExport void executeImportVecAtts(std::string clumpsImage, unsigned int ratBand, std::string inputVector, std::string inputVectorLyr, std::string fidColStr, std::vector<std::string> colNames);
 
+    /** Function for importing the attributes of polygons into a RAT, where each clump takes the attributes of the polygon covering most of its pixels */
+    DllExport void executeImportVecAttsByOverlap(std::string clumpsImage, unsigned int ratBand, std::string inputVector, std::string inputVectorLyr, std::vector<std::string> colNames, float minPropOverlap, std::string outFIDCol);
+
     /** Function to statistically sample the RAT using a histogram method for a single variable. */
     DllExport void executeHistSampling(std::string clumpsImage, unsigned int ratBand, std::string varCol, std::string outSelectCol, float propOfSample, float binWidth, bool classRestrict=false, std::string classColumn="", std::string classVal="");
     
@@ -321,8 +370,32 @@ namespace rsgis{ namespace cmds {
     /** Function to calculate the Bhattacharyya distance between two classes. */
     DllExport float executeCalcBhattacharyyaDistance(std::string clumpsImage, std::string varCol, std::string classColumn, std::string class1Val, std::string class2Val, unsigned int ratBand=1);
     
-    /** Function to export each clump to an individual image file */
-    DllExport void executeExportClumps2Images(std::string clumpsImage, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, unsigned int ratBand=1);
+    /** Function to calculate a batch of separabilities (JM and Bhattacharyya distances), reading each column once and calculating the distances in parallel. */
+    DllExport std::vector<float> executeCalcSeparabilities(std::string clumpsImage, std::vector<RSGISSeparabilityCalcCmds> sepCalcs, unsigned int ratBand=1, unsigned int numThreads=0);
+    
+    /** Function to get the summary (min, max, mean, count and histogram) of a RAT column, which is stored with the RAT so is only calculated if the column has changed. */
+    DllExport RSGISRATColumnSummaryCmds executeGetColumnSummary(std::string clumpsImage, std::string colName, std::string classColumn="", std::string classVal="", unsigned int ratBand=1);
+    
+    /** Function to export each clump to an individual image file, reading the clumps image once for each set of (at most) maxOpenOutputs open output images */
+    DllExport void executeExportClumps2Images(std::string clumpsImage, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, unsigned int ratBand=1, unsigned int maxOpenOutputs=256);
+    
+    /** Function to calculate the distance from each clump (where queryCol is non-zero, or all clumps if "") to the nearest other clump (where targetCol is non-zero, or all clumps if ""), using a kd-tree of the clump boundary pixels. */
+    DllExport void executeCalcDistToNearestClumps(std::string clumpsImage, std::string outColName, std::string targetCol="", std::string queryCol="", bool excludeSelf=true, double maxDist=0, std::string outClumpCol="", unsigned int ratBand=1, unsigned int numThreads=0);
+    
+    /** Function to calculate the distance from each clump to the nearest clump of each class (integer values of classCol, ignoring 0), creating a column outColPrefix + class value for each class. */
+    DllExport void executeCalcClumpDistToClasses(std::string clumpsImage, std::string classCol, std::string outColPrefix, double maxDist=0, unsigned int ratBand=1, unsigned int numThreads=0);
+    
+    /** Function to read numRows rows (from startRow) of a RAT column directly into data, which must have numRows values (the column values are converted to double). */
+    DllExport void executeReadRATColumnChunk(std::string clumpsImage, std::string colName, size_t startRow, size_t numRows, double *data, unsigned int ratBand=1);
+    
+    /** Function to read numRows rows (from startRow) of a RAT column directly into data, which must have numRows values (the column values are converted to int). */
+    DllExport void executeReadRATColumnChunk(std::string clumpsImage, std::string colName, size_t startRow, size_t numRows, int *data, unsigned int ratBand=1);
+    
+    /** Function to write data (numRows values) to numRows rows (from startRow) of a RAT column, which is created as a real column if it does not exist. */
+    DllExport void executeWriteRATColumnChunk(std::string clumpsImage, std::string colName, size_t startRow, size_t numRows, double *data, unsigned int ratBand=1);
+    
+    /** Function to write data (numRows values) to numRows rows (from startRow) of a RAT column, which is created as an integer column if it does not exist. */
+    DllExport void executeWriteRATColumnChunk(std::string clumpsImage, std::string colName, size_t startRow, size_t numRows, int *data, unsigned int ratBand=1);
     
     
 }}
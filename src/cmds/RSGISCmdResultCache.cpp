@@ -0,0 +1,452 @@
+/*
+ *  RSGISCmdResultCache.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISCmdResultCache.h"
+
+namespace rsgis{ namespace cmds {
+
+    // The first line of the manifest of each cache entry, identifying the layout of the entries.
+    static const std::string rsgisResultCacheVersion( "rsgis_result_cache 1" );
+    static const std::string rsgisResultCacheManifest( "manifest.txt" );
+
+    RSGISCmdResultCache::RSGISCmdResultCache(std::string command)
+    {
+        rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+        this->command = command;
+        this->cacheDir = context.resultCacheDir;
+        this->maxSizeMB = context.resultCacheMB;
+        this->hashContents = context.resultCacheHashContents;
+        this->enabled = (this->cacheDir != "");
+        this->keyText = rsgisResultCacheVersion + "\ncommand " + command + "\n";
+    }
+
+    RSGISCmdResultCache::RSGISCmdResultCache(std::string command, std::string cacheDir, unsigned int maxSizeMB, bool hashContents)
+    {
+        this->command = command;
+        this->cacheDir = cacheDir;
+        this->maxSizeMB = maxSizeMB;
+        this->hashContents = hashContents;
+        this->enabled = (this->cacheDir != "");
+        this->keyText = rsgisResultCacheVersion + "\ncommand " + command + "\n";
+    }
+
+    void RSGISCmdResultCache::addParam(std::string name, std::string value)
+    {
+        // The length is included so values containing new lines cannot be confused.
+        this->keyText += "param " + name + "=" + std::to_string(value.size()) + ":" + value + "\n";
+    }
+
+    void RSGISCmdResultCache::addParam(std::string name, double value)
+    {
+        std::stringstream valueStr;
+        valueStr << std::setprecision(17) << value;
+        this->addParam(name, valueStr.str());
+    }
+
+    void RSGISCmdResultCache::addInputFile(std::string file)
+    {
+        if(this->enabled)
+        {
+            this->keyText += "input " + this->fileIdentity(file) + "\n";
+        }
+    }
+
+    bool RSGISCmdResultCache::restoreOutputs(std::vector<std::string> outputFiles)
+    {
+        if(!this->enabled)
+        {
+            return false;
+        }
+        std::string key = this->getKey();
+        try
+        {
+            boost::filesystem::path entryDir = boost::filesystem::path(this->cacheDir) / key;
+            std::ifstream manifest((entryDir / rsgisResultCacheManifest).string().c_str());
+            if(!manifest.is_open())
+            {
+                return false;
+            }
+            std::string line;
+            std::getline(manifest, line);
+            if(line != rsgisResultCacheVersion)
+            {
+                return false;
+            }
+
+            // Each line is the index of the output, the file in the entry and, for the
+            // sidecar files, the end of their name following the stem of the output.
+            std::vector<std::pair<boost::filesystem::path, std::string> > copies;
+            std::vector<bool> outputFound(outputFiles.size(), false);
+            while(std::getline(manifest, line))
+            {
+                std::istringstream lineStream(line);
+                size_t output = 0;
+                std::string fileName = "";
+                lineStream >> output >> fileName;
+                std::string suffix = "";
+                std::getline(lineStream, suffix);
+                if(!suffix.empty() && (suffix[0] == ' '))
+                {
+                    suffix.erase(0, 1);
+                }
+                if((fileName == "") || (output >= outputFiles.size()))
+                {
+                    return false;
+                }
+                if(suffix == "")
+                {
+                    copies.push_back(std::make_pair(entryDir / fileName, outputFiles[output]));
+                    outputFound[output] = true;
+                }
+                else
+                {
+                    copies.push_back(std::make_pair(entryDir / fileName, RSGISCmdResultCache::getPathStem(outputFiles[output]) + suffix));
+                }
+            }
+            if(std::find(outputFound.begin(), outputFound.end(), false) != outputFound.end())
+            {
+                return false;
+            }
+
+            for(size_t i = 0; i < copies.size(); ++i)
+            {
+                boost::filesystem::path outPath(copies[i].second);
+                if(boost::filesystem::exists(outPath))
+                {
+                    boost::filesystem::remove(outPath);
+                }
+                boost::filesystem::copy_file(copies[i].first, outPath);
+            }
+            // The modification time of the entries orders them by when they were last used.
+            boost::filesystem::last_write_time(entryDir, std::time(NULL));
+        }
+        catch(boost::filesystem::filesystem_error &e)
+        {
+            std::cerr << "WARNING: Could not restore the result of " << this->command << " from the cache: " << e.what() << std::endl;
+            return false;
+        }
+        std::cout << "Using the cached result of " << this->command << std::endl;
+        return true;
+    }
+
+    void RSGISCmdResultCache::storeOutputs(std::vector<std::string> outputFiles)
+    {
+        if(!this->enabled)
+        {
+            return;
+        }
+        try
+        {
+            this->storeEntry(this->getKey(), outputFiles);
+            this->removeOldEntries();
+        }
+        catch(boost::filesystem::filesystem_error &e)
+        {
+            std::cerr << "WARNING: Could not store the result of " << this->command << " in the cache: " << e.what() << std::endl;
+        }
+    }
+
+    bool RSGISCmdResultCache::isInPlaceResult(std::string image)
+    {
+        if(!this->enabled)
+        {
+            return false;
+        }
+        std::string key = this->hashKey(this->keyText + "result " + this->fileIdentity(image) + "\n");
+        try
+        {
+            if(!this->hasEntry(key))
+            {
+                return false;
+            }
+            boost::filesystem::last_write_time(boost::filesystem::path(this->cacheDir) / key, std::time(NULL));
+        }
+        catch(boost::filesystem::filesystem_error &e)
+        {
+            return false;
+        }
+        std::cout << "Using the cached result of " << this->command << " (" << image << " is unchanged)" << std::endl;
+        return true;
+    }
+
+    void RSGISCmdResultCache::storeInPlaceResult(std::string image)
+    {
+        if(!this->enabled)
+        {
+            return;
+        }
+        try
+        {
+            this->storeEntry(this->hashKey(this->keyText + "result " + this->fileIdentity(image) + "\n"), std::vector<std::string>());
+            this->removeOldEntries();
+        }
+        catch(boost::filesystem::filesystem_error &e)
+        {
+            std::cerr << "WARNING: Could not store the result of " << this->command << " in the cache: " << e.what() << std::endl;
+        }
+    }
+
+    std::string RSGISCmdResultCache::getKey()
+    {
+        return this->hashKey(this->keyText);
+    }
+
+    void RSGISCmdResultCache::updateHash(uint64_t *hash, const unsigned char *data, size_t numBytes)
+    {
+        // Two FNV-1a hashes with different offsets and byte values, giving a 128 bit key.
+        for(size_t i = 0; i < numBytes; ++i)
+        {
+            hash[0] = (hash[0] ^ data[i]) * 1099511628211ULL;
+            hash[1] = (hash[1] ^ (data[i] ^ 0xA5)) * 1099511628211ULL;
+        }
+    }
+
+    std::string RSGISCmdResultCache::hashKey(std::string keyText)
+    {
+        uint64_t hash[2] = {14695981039346656037ULL, 0x84222325CBF29CE4ULL};
+        RSGISCmdResultCache::updateHash(hash, (const unsigned char *)keyText.data(), keyText.size());
+        std::stringstream hashStr;
+        hashStr << std::hex << std::setfill('0') << std::setw(16) << hash[0] << std::setw(16) << hash[1];
+        return hashStr.str();
+    }
+
+    std::string RSGISCmdResultCache::hashFileContents(std::string file)
+    {
+        uint64_t hash[2] = {14695981039346656037ULL, 0x84222325CBF29CE4ULL};
+        VSILFILE *fileHandle = VSIFOpenL(file.c_str(), "rb");
+        if(fileHandle == NULL)
+        {
+            return "unreadable";
+        }
+        std::vector<unsigned char> buffer(1024 * 1024);
+        size_t numRead = 0;
+        while((numRead = VSIFReadL(buffer.data(), 1, buffer.size(), fileHandle)) > 0)
+        {
+            RSGISCmdResultCache::updateHash(hash, buffer.data(), numRead);
+        }
+        VSIFCloseL(fileHandle);
+        std::stringstream hashStr;
+        hashStr << std::hex << std::setfill('0') << std::setw(16) << hash[0] << std::setw(16) << hash[1];
+        return hashStr.str();
+    }
+
+    std::string RSGISCmdResultCache::getPathStem(std::string file)
+    {
+        boost::filesystem::path filePath(file);
+        return (filePath.parent_path() / filePath.stem()).string();
+    }
+
+    std::vector<std::string> RSGISCmdResultCache::getFileList(std::string file)
+    {
+        // The file is first, followed by any other files of the dataset (e.g., a header,
+        // overviews or an .aux.xml with the statistics).
+        std::vector<std::string> files;
+        files.push_back(file);
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        GDALDataset *dataset = (GDALDataset *) GDALOpenEx(file.c_str(), GDAL_OF_RASTER | GDAL_OF_VECTOR | GDAL_OF_READONLY, NULL, NULL, NULL);
+        CPLPopErrorHandler();
+        if(dataset != NULL)
+        {
+            char **fileList = dataset->GetFileList();
+            for(int i = 0; (fileList != NULL) && (fileList[i] != NULL); ++i)
+            {
+                std::string datasetFile = std::string(fileList[i]);
+                if(std::find(files.begin(), files.end(), datasetFile) == files.end())
+                {
+                    files.push_back(datasetFile);
+                }
+            }
+            CSLDestroy(fileList);
+            GDALClose(dataset);
+        }
+        std::sort(files.begin()+1, files.end());
+        return files;
+    }
+
+    std::string RSGISCmdResultCache::fileIdentity(std::string file)
+    {
+        std::string stem = RSGISCmdResultCache::getPathStem(file);
+        std::vector<std::string> files = this->getFileList(file);
+        std::stringstream identity;
+        for(size_t i = 0; i < files.size(); ++i)
+        {
+            // Where the contents are hashed the files are identified relative to the input
+            // so a copy of the input elsewhere has the same identity.
+            std::string name = files[i];
+            if(this->hashContents)
+            {
+                name = (i == 0)?"":files[i].substr(std::min(stem.size(), files[i].size()));
+            }
+            else
+            {
+                try
+                {
+                    name = boost::filesystem::canonical(files[i]).string();
+                }
+                catch(boost::filesystem::filesystem_error &e)
+                {
+                    // Not a local file (e.g., /vsis3/) so its path is used as given.
+                }
+            }
+            identity << "[" << name.size() << ":" << name;
+
+            VSIStatBufL statBuf;
+            if(VSIStatL(files[i].c_str(), &statBuf) != 0)
+            {
+                identity << "|missing]";
+                continue;
+            }
+            identity << "|" << statBuf.st_size << "|";
+            if(this->hashContents)
+            {
+                identity << this->hashFileContents(files[i]);
+            }
+            else
+            {
+                identity << statBuf.st_mtime;
+            }
+            identity << "]";
+        }
+        return identity.str();
+    }
+
+    bool RSGISCmdResultCache::hasEntry(std::string key)
+    {
+        return boost::filesystem::exists(boost::filesystem::path(this->cacheDir) / key / rsgisResultCacheManifest);
+    }
+
+    void RSGISCmdResultCache::storeEntry(std::string key, std::vector<std::string> outputFiles)
+    {
+        boost::filesystem::path cachePath(this->cacheDir);
+        boost::filesystem::create_directories(cachePath);
+        boost::filesystem::path entryDir = cachePath / key;
+        if(this->hasEntry(key))
+        {
+            boost::filesystem::last_write_time(entryDir, std::time(NULL));
+            return;
+        }
+
+        // The entry is written to a temporary directory which is then renamed, so other
+        // jobs using the cache never see a partial entry.
+        std::random_device randDev;
+        std::stringstream tmpName;
+        tmpName << key << ".tmp" << std::hex << randDev();
+        boost::filesystem::path tmpDir = cachePath / tmpName.str();
+        boost::filesystem::create_directory(tmpDir);
+
+        bool allOutputsStored = true;
+        std::ofstream manifest((tmpDir / rsgisResultCacheManifest).string().c_str());
+        manifest << rsgisResultCacheVersion << "\n";
+        unsigned int fileIdx = 0;
+        for(size_t i = 0; i < outputFiles.size(); ++i)
+        {
+            std::string stem = RSGISCmdResultCache::getPathStem(outputFiles[i]);
+            std::vector<std::string> files = this->getFileList(outputFiles[i]);
+            if(!boost::filesystem::is_regular_file(files[0]))
+            {
+                // Only local outputs are stored.
+                allOutputsStored = false;
+                break;
+            }
+            for(size_t j = 0; j < files.size(); ++j)
+            {
+                std::string suffix = "";
+                if(j > 0)
+                {
+                    if((files[j].size() <= stem.size()) || (files[j].compare(0, stem.size(), stem) != 0) || !boost::filesystem::is_regular_file(files[j]))
+                    {
+                        continue;
+                    }
+                    suffix = files[j].substr(stem.size());
+                }
+                std::string fileName = std::string("file") + std::to_string(fileIdx++);
+                boost::filesystem::copy_file(files[j], tmpDir / fileName);
+                manifest << i << " " << fileName;
+                if(suffix != "")
+                {
+                    manifest << " " << suffix;
+                }
+                manifest << "\n";
+            }
+        }
+        manifest.close();
+
+        boost::system::error_code errCode;
+        if(allOutputsStored)
+        {
+            boost::filesystem::rename(tmpDir, entryDir, errCode);
+        }
+        if((!allOutputsStored) || errCode)
+        {
+            // Not stored, or another job stored the same result first.
+            boost::filesystem::remove_all(tmpDir, errCode);
+        }
+    }
+
+    void RSGISCmdResultCache::removeOldEntries()
+    {
+        if(this->maxSizeMB == 0)
+        {
+            return;
+        }
+        struct CacheEntry
+        {
+            std::time_t lastUsed;
+            boost::filesystem::path entryDir;
+            uintmax_t size;
+        };
+        std::vector<CacheEntry> entries;
+        uintmax_t totalSize = 0;
+        boost::filesystem::directory_iterator endDirIter;
+        for(boost::filesystem::directory_iterator iterDir(this->cacheDir); iterDir != endDirIter; ++iterDir)
+        {
+            // Skip anything which is not an entry, including entries being written.
+            if(!boost::filesystem::is_directory(iterDir->path()) || (iterDir->path().filename().string().find(".tmp") != std::string::npos) || !boost::filesystem::exists(iterDir->path() / rsgisResultCacheManifest))
+            {
+                continue;
+            }
+            CacheEntry entry;
+            entry.lastUsed = boost::filesystem::last_write_time(iterDir->path());
+            entry.entryDir = iterDir->path();
+            entry.size = 0;
+            for(boost::filesystem::directory_iterator iterFile(iterDir->path()); iterFile != endDirIter; ++iterFile)
+            {
+                if(boost::filesystem::is_regular_file(iterFile->path()))
+                {
+                    entry.size += boost::filesystem::file_size(iterFile->path());
+                }
+            }
+            totalSize += entry.size;
+            entries.push_back(entry);
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const CacheEntry &a, const CacheEntry &b){return a.lastUsed < b.lastUsed;});
+        uintmax_t maxSize = ((uintmax_t)this->maxSizeMB) * 1024 * 1024;
+        for(size_t i = 0; (i < entries.size()) && (totalSize > maxSize); ++i)
+        {
+            boost::filesystem::remove_all(entries[i].entryDir);
+            totalSize -= entries[i].size;
+        }
+    }
+
+}}
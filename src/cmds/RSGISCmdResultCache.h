@@ -0,0 +1,117 @@
+/*
+ *  RSGISCmdResultCache.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISCmdResultCache_H
+#define RSGISCmdResultCache_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <random>
+#include <ctime>
+#include <cstdint>
+
+#include "gdal_priv.h"
+#include "cpl_vsi.h"
+
+#include "common/RSGISExecutionContext.h"
+
+#include <boost/filesystem.hpp>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_cmds_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{ namespace cmds {
+
+    /**
+     * A content-addressed cache of the results of deterministic commands, so commands
+     * run again on unchanged inputs reuse their previous outputs rather than recomputing
+     * them. Each result is keyed on a hash of the command name, its parameters and the
+     * identity of its input files (their path, size and modification time, or a digest of
+     * their contents), including the sidecar files GDAL lists for them. The cache is a
+     * directory with an entry for each result, where the least recently used entries are
+     * removed to keep it within its maximum size.
+     *
+     * A command creating new outputs restores them (restoreOutputs) or, if there is no
+     * result, runs and then stores them (storeOutputs). A command which updates an image
+     * in place (e.g., adding statistics) checks whether the image is already its result
+     * (isInPlaceResult) and otherwise runs and records the image it left (storeInPlaceResult).
+     * Errors accessing the cache are reported but do not stop the command.
+     */
+    class DllExport RSGISCmdResultCache
+    {
+    public:
+        /** Use the cache of the default execution context (disabled where it has no cache directory). */
+        RSGISCmdResultCache(std::string command);
+        RSGISCmdResultCache(std::string command, std::string cacheDir, unsigned int maxSizeMB, bool hashContents);
+        bool isEnabled(){return this->enabled;};
+        void addParam(std::string name, std::string value);
+        void addParam(std::string name, double value);
+        /** Add an input file, identified with its sidecar files. */
+        void addInputFile(std::string file);
+        /** Copy the outputs (and their sidecar files) of a previous run to outputFiles, returning false if there is no result. */
+        bool restoreOutputs(std::vector<std::string> outputFiles);
+        /** Store outputFiles (and their sidecar files) as the result. */
+        void storeOutputs(std::vector<std::string> outputFiles);
+        /** Whether image is already the result of the command (image is not added as an input). */
+        bool isInPlaceResult(std::string image);
+        /** Record image as the result of the command. */
+        void storeInPlaceResult(std::string image);
+        /** Get the key of the result from the command, parameters and inputs added. */
+        std::string getKey();
+        ~RSGISCmdResultCache(){};
+    protected:
+        std::string hashKey(std::string keyText);
+        std::vector<std::string> getFileList(std::string file);
+        std::string fileIdentity(std::string file);
+        std::string hashFileContents(std::string file);
+        static std::string getPathStem(std::string file);
+        static void updateHash(uint64_t *hash, const unsigned char *data, size_t numBytes);
+        bool hasEntry(std::string key);
+        void storeEntry(std::string key, std::vector<std::string> outputFiles);
+        void removeOldEntries();
+        bool enabled;
+        std::string command;
+        std::string cacheDir;
+        unsigned int maxSizeMB;
+        bool hashContents;
+        std::string keyText;
+    };
+
+}}
+
+#endif
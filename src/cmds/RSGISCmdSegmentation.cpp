@@ -22,14 +22,22 @@
 
 #include "RSGISCmdSegmentation.h"
 #include "RSGISCmdParent.h"
+#include "RSGISCmdResultCache.h"
+
+#include <atomic>
+#include <algorithm>
 
 #include "common/RSGISImageException.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISGDALInit.h"
 
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcImage.h"
 #include "img/RSGISStretchImage.h"
 #include "img/RSGISImageUtils.h"
+#include "img/RSGISMaskImage.h"
 
 #include "segmentation/RSGISLabelPixelsUsingClusters.h"
 #include "segmentation/RSGISEliminateSinglePixels.h"
@@ -42,10 +50,20 @@
 #include "segmentation/RSGISMergeSegments.h"
 #include "segmentation/RSGISCreateImageGrid.h"
 #include "segmentation/RSGISDropClumps.h"
+#include "segmentation/RSGISSegTilePlan.h"
+#include "segmentation/RSGISShepherdSegmentation.h"
+#include "segmentation/RSGISPolygoniseClumps.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
 #include "rastergis/RSGISCalcImageStatsAndPyramids.h"
 #include "rastergis/RSGISExportColumns2Image.h"
+#include "rastergis/RSGISDefineClumpsInTiles.h"
+#include "vec/RSGISVectorUtils.h"
+#include "vec/RSGISVectorOutputException.h"
+#include "utils/RSGISFileUtils.h"
+#include "utils/RSGISOGRFeatureSink.h"
+
+#include <boost/filesystem.hpp>
 
 
 namespace rsgis{ namespace cmds {
@@ -54,7 +72,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset **datasets = new GDALDataset*[1];
             datasets[0] = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(datasets[0] == NULL)
@@ -83,9 +101,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            rsgis::img::RSGISImageUtils imgUtils;
-            
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *spectralDataset = NULL;
             spectralDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(spectralDataset == NULL)
@@ -102,27 +118,17 @@ namespace rsgis{ namespace cmds {
                 throw rsgis::RSGISImageException(message.c_str());
             }
             
-            GDALDataset *pixelMaskDataset = NULL;
-            if(processInMemory)
-            {
-                pixelMaskDataset = imgUtils.createCopy(clumpsDataset, 1, "", "MEM", GDT_Byte , true, "");
-            }
-            else
-            {
-                pixelMaskDataset = imgUtils.createCopy(clumpsDataset, 1, tempImage, imageFormat, GDT_Byte, true, "");
-            }
-            
-            
+            // The single pixels are held in memory (see RSGISEliminateSinglePixels::eliminateWorklist)
+            // so the temporary single pixel mask image is no longer required.
             std::cout << "Eliminating Individual Pixels\n";
             rsgis::segment::RSGISEliminateSinglePixels eliminate;
-            eliminate.eliminateBlocks(spectralDataset, clumpsDataset, pixelMaskDataset, outputImage, 0, ignoreZeros, true, "", imageFormat);
+            eliminate.eliminateWorklist(spectralDataset, clumpsDataset, outputImage, 0, ignoreZeros, true, "", imageFormat, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads);
             
             clumpsDataset->GetRasterBand(1)->SetMetadataItem("LAYER_TYPE", "thematic");
             
             // Tidy up
             GDALClose(spectralDataset);
             GDALClose(clumpsDataset);
-            GDALClose(pixelMaskDataset);
         }
         catch (rsgis::RSGISException &e)
         {
@@ -134,11 +140,24 @@ namespace rsgis{ namespace cmds {
         }
     }
     
-    void executeClump(std::string inputImage, std::string outputImage, std::string imageFormat, bool processInMemory, bool noDataValProvided, float noDataVal, bool addRatPxlVals) 
+    void executeClump(std::string inputImage, std::string outputImage, std::string imageFormat, bool processInMemory, bool noDataValProvided, float noDataVal, bool addRatPxlVals, unsigned int nThreads) 
     {        
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
+            // The number of threads is part of the key as the clumps are labelled by tile.
+            RSGISCmdResultCache resultCache("executeClump");
+            resultCache.addParam("format", imageFormat);
+            resultCache.addParam("no_data_provided", noDataValProvided);
+            resultCache.addParam("no_data_val", noDataVal);
+            resultCache.addParam("add_rat_pxl_vals", addRatPxlVals);
+            resultCache.addParam("n_threads", nThreads);
+            resultCache.addInputFile(inputImage);
+            if(resultCache.restoreOutputs(std::vector<std::string>(1, outputImage)))
+            {
+                return;
+            }
+
             GDALDataset *inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(inDataset == NULL)
             {
@@ -150,19 +169,20 @@ namespace rsgis{ namespace cmds {
             
             GDALDataset *catagoryDataset = NULL;
             GDALDataset *resultDataset = NULL;
+            GDALDataType clumpsType = rsgis::segment::RSGISClumpPxls::getClumpsDataType(inDataset->GetRasterXSize(), inDataset->GetRasterYSize());
             
             if(processInMemory)
             {
                 std::cout << "Processing in Memory\n";
                 catagoryDataset = imgUtils.createCopy(inDataset, "", "MEM", GDT_UInt32, true, "");
                 imgUtils.copyUIntGDALDataset(inDataset, catagoryDataset);
-                resultDataset = imgUtils.createCopy(inDataset, 1, "", "MEM", GDT_UInt32, true, "");
+                resultDataset = imgUtils.createCopy(inDataset, 1, "", "MEM", clumpsType, true, "");
             }
             else
             {
                 std::cout << "Processing using Disk\n";
                 catagoryDataset = inDataset;
-                resultDataset = imgUtils.createCopy(inDataset, 1, outputImage, imageFormat, GDT_UInt32, true, "");
+                resultDataset = imgUtils.createCopy(inDataset, 1, outputImage, imageFormat, clumpsType, true, "");
             }
             
             std::vector<unsigned int> *clumpPxlVals=NULL;
@@ -173,13 +193,26 @@ namespace rsgis{ namespace cmds {
             
             std::cout << "Performing Clump\n";
             rsgis::segment::RSGISClumpPxls clumpImg;
-            clumpImg.performClump(catagoryDataset, resultDataset, noDataValProvided, noDataVal, clumpPxlVals);
+            clumpImg.performClump(catagoryDataset, resultDataset, noDataValProvided, noDataVal, clumpPxlVals, nThreads);
             
             if(processInMemory)
             {
+                // The number of clumps is known before the output is created, so its RAT can be chunked for them.
+                double clumpsMinMax[2];
+                if(resultDataset->GetRasterBand(1)->ComputeRasterMinMax(FALSE, clumpsMinMax) == CE_None)
+                {
+                    imgUtils.setExpectedRATRows(((size_t)clumpsMinMax[1]) + 1);
+                }
                 std::cout << "Copying output to disk\n";
-                GDALDataset *outDataset = imgUtils.createCopy(inDataset, 1, outputImage, imageFormat, GDT_UInt32, true, "");
-                imgUtils.copyUIntGDALDataset(resultDataset, outDataset);
+                GDALDataset *outDataset = imgUtils.createCopy(inDataset, 1, outputImage, imageFormat, clumpsType, true, "");
+                if(clumpsType == GDT_UInt64)
+                {
+                    imgUtils.copyUInt64GDALDataset(resultDataset, outDataset);
+                }
+                else
+                {
+                    imgUtils.copyUIntGDALDataset(resultDataset, outDataset);
+                }
                 outDataset->GetRasterBand(1)->SetMetadataItem("LAYER_TYPE", "thematic");
                 if(addRatPxlVals)
                 {
@@ -226,6 +259,8 @@ namespace rsgis{ namespace cmds {
             // Tidy up
             GDALClose(inDataset);
             GDALClose(resultDataset);
+
+            resultCache.storeOutputs(std::vector<std::string>(1, outputImage));
         }
         catch (rsgis::RSGISException &e)
         {
@@ -241,7 +276,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(inDataset == NULL)
             {
@@ -257,6 +292,11 @@ namespace rsgis{ namespace cmds {
             }
             
             rsgis::img::RSGISImageUtils imgUtils;
+            // The merged clumps have no more rows than the input RAT.
+            if(inClumpDataset->GetRasterBand(1)->GetDefaultRAT() != NULL)
+            {
+                imgUtils.setExpectedRATRows(inClumpDataset->GetRasterBand(1)->GetDefaultRAT()->GetRowCount());
+            }
             
             std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats = NULL;
             if(stretchStatsAvail)
@@ -291,7 +331,8 @@ namespace rsgis{ namespace cmds {
             if(storeMean)
             {
                 //eliminate.stepwiseEliminateSmallClumps(spectralDataset, resultDataset, minClumpSize, specThreshold, bandStretchStats, stretchStatsAvail);
-                eliminate.stepwiseIterativeEliminateSmallClumps(spectralDataset, resultDataset, minClumpSize, specThreshold, bandStretchStats, stretchStatsAvail);
+                //eliminate.stepwiseIterativeEliminateSmallClumps(spectralDataset, resultDataset, minClumpSize, specThreshold, bandStretchStats, stretchStatsAvail);
+                eliminate.graphEliminateSmallClumps(spectralDataset, resultDataset, minClumpSize, specThreshold, bandStretchStats, stretchStatsAvail);
             }
             else
             {
@@ -334,7 +375,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             std::cout << "Opening clumps file: " << inputImage << std::endl;
             GDALDataset *inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(inDataset == NULL)
@@ -344,22 +385,36 @@ namespace rsgis{ namespace cmds {
             }
             
             rsgis::img::RSGISImageUtils imgUtils;
+            // The relabelled clumps have no more rows than the input RAT.
+            if(inDataset->GetRasterBand(1)->GetDefaultRAT() != NULL)
+            {
+                imgUtils.setExpectedRATRows(inDataset->GetRasterBand(1)->GetDefaultRAT()->GetRowCount());
+            }
             
             GDALDataset *catagoryDataset = NULL;
             GDALDataset *resultDataset = NULL;
+            // 64 bit clumps are kept as 64 bit, all other inputs are relabelled as 32 bit.
+            GDALDataType clumpsType = (inDataset->GetRasterBand(1)->GetRasterDataType() == GDT_UInt64)?GDT_UInt64:GDT_UInt32;
             
             if(processInMemory)
             {
                 std::cout << "Processing in Memory\n";
-                catagoryDataset = imgUtils.createCopy(inDataset, "", "MEM", GDT_UInt32, true, "");
-                imgUtils.copyUIntGDALDataset(inDataset, catagoryDataset);
-                resultDataset = imgUtils.createCopy(inDataset, 1, "", "MEM", GDT_UInt32, true, "");
+                catagoryDataset = imgUtils.createCopy(inDataset, "", "MEM", clumpsType, true, "");
+                if(clumpsType == GDT_UInt64)
+                {
+                    imgUtils.copyUInt64GDALDataset(inDataset, catagoryDataset);
+                }
+                else
+                {
+                    imgUtils.copyUIntGDALDataset(inDataset, catagoryDataset);
+                }
+                resultDataset = imgUtils.createCopy(inDataset, 1, "", "MEM", clumpsType, true, "");
             }
             else
             {
                 std::cout << "Processing using Disk\n";
                 catagoryDataset = inDataset;
-                resultDataset = imgUtils.createCopy(inDataset, 1, outputImage, imageFormat, GDT_UInt32, true, "");
+                resultDataset = imgUtils.createCopy(inDataset, 1, outputImage, imageFormat, clumpsType, true, "");
                 std::cout << "Created copy\n";
             }
             
@@ -370,8 +425,15 @@ namespace rsgis{ namespace cmds {
             if(processInMemory)
             {
                 std::cout << "Copying output to disk\n";
-                GDALDataset *outDataset = imgUtils.createCopy(inDataset, 1, outputImage, imageFormat, GDT_UInt32, true, "");
-                imgUtils.copyUIntGDALDataset(resultDataset, outDataset);
+                GDALDataset *outDataset = imgUtils.createCopy(inDataset, 1, outputImage, imageFormat, clumpsType, true, "");
+                if(clumpsType == GDT_UInt64)
+                {
+                    imgUtils.copyUInt64GDALDataset(resultDataset, outDataset);
+                }
+                else
+                {
+                    imgUtils.copyUIntGDALDataset(resultDataset, outDataset);
+                }
                 GDALClose(outDataset);
                 GDALClose(catagoryDataset);
             }
@@ -392,16 +454,38 @@ namespace rsgis{ namespace cmds {
         }
     }
     
-    void executeMeanImage(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string imageFormat, RSGISLibDataType outDataType, bool processInMemory) 
+    void executeRelabelClumpsArray(uint32_t *clumps, size_t nPxls)
     {
         try
         {
-            GDALAllRegister();
-            GDALDataset *inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
-            if(inDataset == NULL)
+            rsgis::segment::RSGISRelabelClumps relabelImg;
+            relabelImg.relabelClumps(clumps, nPxls);
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+    }
+    
+    void executeMeanImage(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string imageFormat, RSGISLibDataType outDataType, bool processInMemory, std::vector<std::string> meanCols) 
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            bool meansFromRAT = !meanCols.empty();
+            GDALDataset *inDataset = NULL;
+            if(!meansFromRAT)
             {
-                std::string message = std::string("Could not open image ") + inputImage;
-                throw rsgis::RSGISImageException(message.c_str());
+                inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+                if(inDataset == NULL)
+                {
+                    std::string message = std::string("Could not open image ") + inputImage;
+                    throw rsgis::RSGISImageException(message.c_str());
+                }
             }
             
             GDALDataset *inClumpDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_ReadOnly);
@@ -413,6 +497,10 @@ namespace rsgis{ namespace cmds {
             
             rsgis::img::RSGISImageUtils imgUtils;
             
+            // With the means from the RAT the output has the geometry of the clumps and a band per column.
+            GDALDataset *outGeomDataset = meansFromRAT?inClumpDataset:inDataset;
+            unsigned int numOutBands = meansFromRAT?meanCols.size():inDataset->GetRasterCount();
+            
             GDALDataset *spectralDataset = NULL;
             GDALDataset *clumpsDataset = NULL;
             GDALDataset *resultDataset = NULL;
@@ -420,36 +508,47 @@ namespace rsgis{ namespace cmds {
             if(processInMemory)
             {
                 std::cout << "Processing in Memory\n";
-                spectralDataset = imgUtils.createCopy(inDataset, "", "MEM", GDT_Float32, true, "");
-                imgUtils.copyFloat32GDALDataset(inDataset, spectralDataset);
-                clumpsDataset = imgUtils.createCopy(inClumpDataset, "", "MEM", GDT_UInt32, true, "");
-                imgUtils.copyUIntGDALDataset(inClumpDataset, clumpsDataset);
-                resultDataset = imgUtils.createCopy(inDataset, "", "MEM", RSGIS_to_GDAL_Type(outDataType), true, "");
+                // The clumps are only read once when the means are from the RAT, so are not copied.
+                clumpsDataset = inClumpDataset;
+                if(!meansFromRAT)
+                {
+                    spectralDataset = imgUtils.createCopy(inDataset, "", "MEM", GDT_Float32, true, "");
+                    imgUtils.copyFloat32GDALDataset(inDataset, spectralDataset);
+                    clumpsDataset = imgUtils.createCopy(inClumpDataset, "", "MEM", GDT_UInt32, true, "");
+                    imgUtils.copyUIntGDALDataset(inClumpDataset, clumpsDataset);
+                }
+                resultDataset = imgUtils.createCopy(outGeomDataset, numOutBands, "", "MEM", RSGIS_to_GDAL_Type(outDataType), true, "");
             }
             else
             {
                 std::cout << "Processing using Disk\n";
                 spectralDataset = inDataset;
                 clumpsDataset = inClumpDataset;
-                resultDataset = imgUtils.createCopy(inDataset, outputImage, imageFormat, RSGIS_to_GDAL_Type(outDataType), true, "");
+                resultDataset = imgUtils.createCopy(outGeomDataset, numOutBands, outputImage, imageFormat, RSGIS_to_GDAL_Type(outDataType), true, "");
             }
             
             std::cout << "Calculating Mean Image\n";
             rsgis::segment::RSGISGenMeanSegImage genMeanImg;
-            genMeanImg.generateMeanImageUsingCalcImage(spectralDataset, clumpsDataset, resultDataset);
+            genMeanImg.generateMeanImageFused(spectralDataset, clumpsDataset, resultDataset, meanCols);
             
             if(processInMemory)
             {
                 std::cout << "Copying output to disk\n";
-                GDALDataset *outDataset = imgUtils.createCopy(inDataset, outputImage, imageFormat, RSGIS_to_GDAL_Type(outDataType), true, "");
+                GDALDataset *outDataset = imgUtils.createCopy(outGeomDataset, numOutBands, outputImage, imageFormat, RSGIS_to_GDAL_Type(outDataType), true, "");
                 imgUtils.copyFloatGDALDataset(resultDataset, outDataset);
                 GDALClose(outDataset);
-                GDALClose(spectralDataset);
-                GDALClose(clumpsDataset);
+                if(!meansFromRAT)
+                {
+                    GDALClose(spectralDataset);
+                    GDALClose(clumpsDataset);
+                }
             }
             
             // Tidy up
-            GDALClose(inDataset);
+            if(inDataset != NULL)
+            {
+                GDALClose(inDataset);
+            }
             GDALClose(inClumpDataset);
             GDALClose(resultDataset);
         }
@@ -467,7 +566,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(inDataset == NULL)
             {
@@ -521,11 +620,11 @@ namespace rsgis{ namespace cmds {
         }
     }
     
-    void executeUnionOfClumps(std::vector<std::string> inputImagePaths, std::string outputImage, std::string imageFormat, bool noDataValProvided, float noDataVal, bool addRatPxlVals)
+    void executeUnionOfClumps(std::vector<std::string> inputImagePaths, std::string outputImage, std::string imageFormat, bool noDataValProvided, float noDataVal, bool addRatPxlVals, bool tupleIDs, unsigned int nThreads)
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             std::vector<GDALDataset*> *images = new std::vector<GDALDataset*>();
             images->reserve(inputImagePaths.size());
             for(std::vector<std::string>::iterator iterFiles = inputImagePaths.begin(); iterFiles != inputImagePaths.end(); ++iterFiles)
@@ -540,7 +639,7 @@ namespace rsgis{ namespace cmds {
             }
             
             rsgis::segment::RSGISClumpPxls clumpPxls;
-            clumpPxls.performMultiBandClump(images, outputImage, imageFormat, noDataValProvided, noDataVal, addRatPxlVals);
+            clumpPxls.performMultiBandClump(images, outputImage, imageFormat, noDataValProvided, noDataVal, addRatPxlVals, tupleIDs, nThreads);
             
             for(std::vector<GDALDataset*>::iterator iterImages = images->begin(); iterImages != images->end(); ++iterImages)
             {
@@ -563,7 +662,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *outputDataset = (GDALDataset *) GDALOpen(outputImage.c_str(), GA_Update);
             if(outputDataset == NULL)
@@ -603,7 +702,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *borderMaskDataset = (GDALDataset *) GDALOpen(borderMaskImage.c_str(), GA_Update);
             if(borderMaskDataset == NULL)
@@ -634,7 +733,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             
             GDALDataset *outputDataset = (GDALDataset *) GDALOpen(outputImage.c_str(), GA_Update);
             if(outputDataset == NULL)
@@ -663,7 +762,7 @@ namespace rsgis{ namespace cmds {
     
     void executeRMSmallClumps(std::string clumpsImage, std::string outputImage, float threshold, std::string imgFormat)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *clumpsDataset;
         
         try
@@ -710,7 +809,7 @@ namespace rsgis{ namespace cmds {
             
     void executeGenerateRegularGrid(std::string inputImage, std::string outputClumpImage, std::string imageFormat, unsigned int numXPxls, unsigned int numYPxls, bool offset)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         
         try
         {
@@ -722,6 +821,13 @@ namespace rsgis{ namespace cmds {
             }
             
             rsgis::img::RSGISImageUtils imgUtils;
+            // There is a clump for each cell of the grid (plus the partial cells of an offset grid).
+            if((numXPxls > 0) && (numYPxls > 0))
+            {
+                size_t numXCells = (inputDataset->GetRasterXSize() / numXPxls) + 2;
+                size_t numYCells = (inputDataset->GetRasterYSize() / numYPxls) + 2;
+                imgUtils.setExpectedRATRows((numXCells * numYCells) + 1);
+            }
             std::cout << "Creating Image Copy\n";
             GDALDataset *clumpsDataset = imgUtils.createCopy(inputDataset, 1, outputClumpImage, imageFormat, GDT_UInt32);
             GDALClose(inputDataset);
@@ -749,7 +855,7 @@ namespace rsgis{ namespace cmds {
             
     void executeIncludeClumpedRegion(std::string inputClumps, std::string inputRegion, std::string outputClumpImage, std::string imageFormat)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         
         try
         {
@@ -809,7 +915,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *spectralDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
             if(spectralDataset == NULL)
             {
@@ -834,11 +940,8 @@ namespace rsgis{ namespace cmds {
             // Get column intex in RAT
             unsigned int columnIndex = attUtils.findColumnIndex(gdalATT, "OutClumpIDs");
             
-            rsgis::rastergis::RSGISExportColumns2ImageCalcImage *calcImageVal = new rsgis::rastergis::RSGISExportColumns2ImageCalcImage(1, gdalATT, columnIndex);
-            rsgis::img::RSGISCalcImage calcImage(calcImageVal);
-            
-            calcImage.calcImage(&clumpDataset, 1, 0, outputImage, false, NULL, imageFormat, GDT_UInt32);
-            delete calcImageVal;
+            rsgis::rastergis::RSGISExportColumns2Image exportCol;
+            exportCol.exportColumn2Image(clumpDataset, 1, columnIndex, outputImage, imageFormat, GDT_UInt32);
             
             GDALDataset *outputClumpsDS = (GDALDataset *) GDALOpen(outputImage.c_str(), GA_Update);
             if(outputClumpsDS == NULL)
@@ -871,7 +974,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *clumpDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
             if(clumpDataset == NULL)
             {
@@ -899,7 +1002,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             GDALDataset *clumpDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
             if(clumpDataset == NULL)
             {
@@ -917,11 +1020,8 @@ namespace rsgis{ namespace cmds {
             // Get column intex in RAT
             unsigned int columnIndex = attUtils.findColumnIndex(gdalATT, "OutClumpIDs");
             
-            rsgis::rastergis::RSGISExportColumns2ImageCalcImage *calcImageVal = new rsgis::rastergis::RSGISExportColumns2ImageCalcImage(1, gdalATT, columnIndex);
-            rsgis::img::RSGISCalcImage calcImage(calcImageVal);
-            
-            calcImage.calcImage(&clumpDataset, 1, 0, outputImage, false, NULL, imageFormat, GDT_UInt32);
-            delete calcImageVal;
+            rsgis::rastergis::RSGISExportColumns2Image exportCol;
+            exportCol.exportColumn2Image(clumpDataset, 1, columnIndex, outputImage, imageFormat, GDT_UInt32);
             
             GDALDataset *outputClumpsDS = (GDALDataset *) GDALOpen(outputImage.c_str(), GA_Update);
             if(outputClumpsDS == NULL)
@@ -948,6 +1048,473 @@ namespace rsgis{ namespace cmds {
         }
     }
 
+    /** Copy the window (incl. the overlap) of the job from the input image to a new image. */
+    static void copySegTileJobWindow(GDALDataset *inDataset, std::string outputImage, std::string imageFormat, const rsgis::segment::RSGISSegTileJob &job)
+    {
+        GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(imageFormat.c_str());
+        if(gdalDriver == NULL)
+        {
+            throw rsgis::RSGISImageException("Image driver is not available.");
+        }
+        rsgis::img::RSGISImageUtils imgUtils;
+        unsigned int numBands = inDataset->GetRasterCount();
+        GDALDataType dataType = inDataset->GetRasterBand(1)->GetRasterDataType();
+        char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(imageFormat);
+        GDALDataset *outDataset = gdalDriver->Create(outputImage.c_str(), job.xSize, job.ySize, numBands, dataType, papszOptions);
+        if(outDataset == NULL)
+        {
+            std::string message = std::string("Could not create image ") + outputImage;
+            throw rsgis::RSGISImageException(message.c_str());
+        }
+        
+        double transformation[6];
+        inDataset->GetGeoTransform(transformation);
+        transformation[0] += (job.xOff * transformation[1]) + (job.yOff * transformation[2]);
+        transformation[3] += (job.xOff * transformation[4]) + (job.yOff * transformation[5]);
+        outDataset->SetGeoTransform(transformation);
+        outDataset->SetProjection(inDataset->GetProjectionRef());
+        
+        double *rowData = new double[job.xSize];
+        for(unsigned int n = 1; n <= numBands; ++n)
+        {
+            GDALRasterBand *inBand = inDataset->GetRasterBand(n);
+            GDALRasterBand *outBand = outDataset->GetRasterBand(n);
+            int hasNoData = false;
+            double noDataVal = inBand->GetNoDataValue(&hasNoData);
+            if(hasNoData)
+            {
+                outBand->SetNoDataValue(noDataVal);
+            }
+            for(unsigned int y = 0; y < job.ySize; ++y)
+            {
+                if((inBand->RasterIO(GF_Read, job.xOff, job.yOff + y, job.xSize, 1, rowData, job.xSize, 1, GDT_Float64, 0, 0) != CE_None)
+                   || (outBand->RasterIO(GF_Write, 0, y, job.xSize, 1, rowData, job.xSize, 1, GDT_Float64, 0, 0) != CE_None))
+                {
+                    delete[] rowData;
+                    GDALClose(outDataset);
+                    throw rsgis::RSGISImageException("Could not copy the tile window.");
+                }
+            }
+        }
+        delete[] rowData;
+        GDALClose(outDataset);
+    }
+    
+    unsigned int executeCreateSegTilePlan(std::string clustersImage, std::string spectralImage, std::string manifestFile, std::string tilesBase, std::string imageFormat, std::string outFileExt, unsigned int tileXSize, unsigned int tileYSize, unsigned int overlap)
+    {
+        unsigned int numJobs = 0;
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            GDALDataset *clustersDataset = (GDALDataset *) GDALOpen(clustersImage.c_str(), GA_ReadOnly);
+            if(clustersDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + clustersImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            GDALDataset *spectralDataset = (GDALDataset *) GDALOpen(spectralImage.c_str(), GA_ReadOnly);
+            if(spectralDataset == NULL)
+            {
+                GDALClose(clustersDataset);
+                std::string message = std::string("Could not open image ") + spectralImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            if((clustersDataset->GetRasterXSize() != spectralDataset->GetRasterXSize()) || (clustersDataset->GetRasterYSize() != spectralDataset->GetRasterYSize()))
+            {
+                GDALClose(clustersDataset);
+                GDALClose(spectralDataset);
+                throw rsgis::RSGISImageException("The clusters and spectral images must be the same size.");
+            }
+            
+            rsgis::segment::RSGISSegTilePlanInfo plan = rsgis::segment::RSGISSegTilePlan::createPlan(clustersDataset->GetRasterXSize(), clustersDataset->GetRasterYSize(), tileXSize, tileYSize, overlap, tilesBase, outFileExt);
+            plan.clustersImage = clustersImage;
+            plan.spectralImage = spectralImage;
+            plan.imageFormat = imageFormat;
+            rsgis::segment::RSGISSegTilePlan::writeManifest(manifestFile, plan);
+            numJobs = plan.jobs.size();
+            
+            GDALClose(clustersDataset);
+            GDALClose(spectralDataset);
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+        return numJobs;
+    }
+    
+    static void runSegTileJob(const rsgis::segment::RSGISSegTilePlanInfo &plan, unsigned int jobID, unsigned int minClumpSize, float specThreshold, bool stretchStatsAvail, std::string stretchStatsFile, bool processInMemory)
+    {
+        const rsgis::segment::RSGISSegTileJob &job = rsgis::segment::RSGISSegTilePlan::getJob(plan, jobID);
+        
+        std::string clustersTile = rsgis::segment::RSGISSegTilePlan::getJobImage(plan, jobID, "clusters");
+        std::string spectralTile = rsgis::segment::RSGISSegTilePlan::getJobImage(plan, jobID, "spectral");
+        std::string initClumpsTile = rsgis::segment::RSGISSegTilePlan::getJobImage(plan, jobID, "initclumps");
+        std::string elimClumpsTile = rsgis::segment::RSGISSegTilePlan::getJobImage(plan, jobID, "elimclumps");
+        std::string tileMask = rsgis::segment::RSGISSegTilePlan::getJobImage(plan, jobID, "tilemask");
+        
+        GDALDataset *inDataset = (GDALDataset *) GDALOpen(plan.clustersImage.c_str(), GA_ReadOnly);
+        if(inDataset == NULL)
+        {
+            std::string message = std::string("Could not open image ") + plan.clustersImage;
+            throw rsgis::RSGISImageException(message.c_str());
+        }
+        copySegTileJobWindow(inDataset, clustersTile, plan.imageFormat, job);
+        GDALClose(inDataset);
+        
+        inDataset = (GDALDataset *) GDALOpen(plan.spectralImage.c_str(), GA_ReadOnly);
+        if(inDataset == NULL)
+        {
+            std::string message = std::string("Could not open image ") + plan.spectralImage;
+            throw rsgis::RSGISImageException(message.c_str());
+        }
+        copySegTileJobWindow(inDataset, spectralTile, plan.imageFormat, job);
+        GDALClose(inDataset);
+        
+        std::cout << "Segmenting tile " << jobID << std::endl;
+        executeClump(clustersTile, initClumpsTile, plan.imageFormat, processInMemory, true, 0, false);
+        executeRMSmallClumpsStepwise(spectralTile, initClumpsTile, elimClumpsTile, plan.imageFormat, stretchStatsAvail, stretchStatsFile, false, processInMemory, minClumpSize, specThreshold);
+        executeRelabelClumps(elimClumpsTile, job.clumpsImage, plan.imageFormat, processInMemory);
+        
+        GDALDataset *clumpsDataset = (GDALDataset *) GDALOpen(job.clumpsImage.c_str(), GA_Update);
+        if(clumpsDataset == NULL)
+        {
+            std::string message = std::string("Could not open image ") + job.clumpsImage;
+            throw rsgis::RSGISImageException(message.c_str());
+        }
+        clumpsDataset->GetRasterBand(1)->SetMetadataItem("LAYER_TYPE", "thematic");
+        rsgis::rastergis::RSGISPopulateWithImageStats popImageStats;
+        popImageStats.populateImageWithRasterGISStats(clumpsDataset, true, true, true, 1);
+        
+        // Define the position of each clump within the tile.
+        rsgis::img::RSGISImageUtils imgUtils;
+        GDALDataset *maskDataset = imgUtils.createCopy(clumpsDataset, 1, tileMask, plan.imageFormat, GDT_Byte);
+        GDALRasterBand *maskBand = maskDataset->GetRasterBand(1);
+        unsigned char *maskRow = new unsigned char[job.xSize];
+        for(unsigned int y = 0; y < job.ySize; ++y)
+        {
+            for(unsigned int x = 0; x < job.xSize; ++x)
+            {
+                maskRow[x] = (unsigned char) rsgis::segment::RSGISSegTilePlan::getTilePxlPosition(plan, job, x, y);
+            }
+            maskBand->RasterIO(GF_Write, 0, y, job.xSize, 1, maskRow, job.xSize, 1, GDT_Byte, 0, 0);
+        }
+        delete[] maskRow;
+        
+        rsgis::rastergis::RSGISDefineClumpsInTiles defineClumpsInTiles;
+        defineClumpsInTiles.defineSegmentTilePos(clumpsDataset, maskDataset, "TilePosition", rsgis::segment::RSGIS_SEGTILE_OVERLAP, rsgis::segment::RSGIS_SEGTILE_BOUNDARY, rsgis::segment::RSGIS_SEGTILE_BODY);
+        
+        GDALClose(maskDataset);
+        GDALClose(clumpsDataset);
+        
+        GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(plan.imageFormat.c_str());
+        if(gdalDriver == NULL)
+        {
+            throw rsgis::RSGISImageException("Image driver is not available.");
+        }
+        gdalDriver->Delete(clustersTile.c_str());
+        gdalDriver->Delete(spectralTile.c_str());
+        gdalDriver->Delete(initClumpsTile.c_str());
+        gdalDriver->Delete(elimClumpsTile.c_str());
+        gdalDriver->Delete(tileMask.c_str());
+    }
+    
+    void executeSegTileJob(std::string manifestFile, unsigned int jobID, unsigned int minClumpSize, float specThreshold, bool stretchStatsAvail, std::string stretchStatsFile, bool processInMemory)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            rsgis::segment::RSGISSegTilePlanInfo plan = rsgis::segment::RSGISSegTilePlan::readManifest(manifestFile);
+            runSegTileJob(plan, jobID, minClumpSize, specThreshold, stretchStatsAvail, stretchStatsFile, processInMemory);
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+    }
+    
+    void executeRunSegTileJobs(std::string manifestFile, std::vector<unsigned int> jobIDs, unsigned int minClumpSize, float specThreshold, bool stretchStatsAvail, std::string stretchStatsFile, bool processInMemory, unsigned int numThreads)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            rsgis::segment::RSGISSegTilePlanInfo plan = rsgis::segment::RSGISSegTilePlan::readManifest(manifestFile);
+            if(jobIDs.empty())
+            {
+                for(std::vector<rsgis::segment::RSGISSegTileJob>::iterator iterJobs = plan.jobs.begin(); iterJobs != plan.jobs.end(); ++iterJobs)
+                {
+                    jobIDs.push_back((*iterJobs).id);
+                }
+            }
+            for(std::vector<unsigned int>::iterator iterIDs = jobIDs.begin(); iterIDs != jobIDs.end(); ++iterIDs)
+            {
+                // Check the ids before any jobs are started.
+                rsgis::segment::RSGISSegTilePlan::getJob(plan, (*iterIDs));
+            }
+            
+            // The tiles take different amounts of time to segment so each worker takes
+            // the next job from the list once it has finished its current job.
+            rsgis::RSGISThreadPool threadPool(numThreads);
+            unsigned int numWorkers = std::min<size_t>(threadPool.getNumThreads(), jobIDs.size());
+            std::atomic<size_t> nextJob(0);
+            std::atomic<bool> jobFailed(false);
+            threadPool.parallelFor(0, numWorkers, [&](unsigned int workerIdx, size_t chunkStart, size_t chunkEnd)
+            {
+                for(size_t w = chunkStart; w < chunkEnd; ++w)
+                {
+                    size_t jobIdx = nextJob++;
+                    while((jobIdx < jobIDs.size()) && (!jobFailed))
+                    {
+                        try
+                        {
+                            runSegTileJob(plan, jobIDs.at(jobIdx), minClumpSize, specThreshold, stretchStatsAvail, stretchStatsFile, processInMemory);
+                        }
+                        catch(...)
+                        {
+                            jobFailed = true;
+                            throw;
+                        }
+                        jobIdx = nextJob++;
+                    }
+                }
+            });
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+    }
+    
+    void executeMergeSegTilePlan(std::string manifestFile, std::string outputImage, unsigned int minClumpSize, float specThreshold, bool stretchStatsAvail, std::string stretchStatsFile, bool processInMemory)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            rsgis::segment::RSGISSegTilePlanInfo plan = rsgis::segment::RSGISSegTilePlan::readManifest(manifestFile);
+            
+            std::vector<std::string> tileClumps;
+            for(std::vector<rsgis::segment::RSGISSegTileJob>::iterator iterJobs = plan.jobs.begin(); iterJobs != plan.jobs.end(); ++iterJobs)
+            {
+                GDALDataset *tileDataset = (GDALDataset *) GDALOpen((*iterJobs).clumpsImage.c_str(), GA_ReadOnly);
+                if(tileDataset == NULL)
+                {
+                    std::stringstream message;
+                    message << "The output of job " << (*iterJobs).id << " is not available: " << (*iterJobs).clumpsImage;
+                    throw rsgis::RSGISImageException(message.str());
+                }
+                GDALClose(tileDataset);
+                tileClumps.push_back((*iterJobs).clumpsImage);
+            }
+            
+            std::string bodyClumps = plan.tilesBase + "_merge_bodies." + plan.outFileExt;
+            std::string borderMask = plan.tilesBase + "_merge_bordermask." + plan.outFileExt;
+            std::string borderClusters = plan.tilesBase + "_merge_borderclusters." + plan.outFileExt;
+            std::string borderInitClumps = plan.tilesBase + "_merge_borderinitclumps." + plan.outFileExt;
+            std::string borderElimClumps = plan.tilesBase + "_merge_borderelimclumps." + plan.outFileExt;
+            std::string combinedClumps = plan.tilesBase + "_merge_combined." + plan.outFileExt;
+            
+            GDALDataset *clustersDataset = (GDALDataset *) GDALOpen(plan.clustersImage.c_str(), GA_ReadOnly);
+            if(clustersDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + plan.clustersImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            rsgis::img::RSGISImageUtils imgUtils;
+            GDALDataset *bodyDataset = imgUtils.createCopy(clustersDataset, 1, bodyClumps, plan.imageFormat, GDT_UInt32);
+            imgUtils.assignValGDALDataset(bodyDataset, 0);
+            GDALDataset *borderMaskDataset = imgUtils.createCopy(clustersDataset, 1, borderMask, plan.imageFormat, GDT_Byte);
+            imgUtils.assignValGDALDataset(borderMaskDataset, 0);
+            
+            std::cout << "Merging the tile bodies\n";
+            rsgis::segment::RSGISMergeSegmentationTiles mergeSegmentTiles;
+            mergeSegmentTiles.mergeClumpBodies(bodyDataset, borderMaskDataset, tileClumps, rsgis::segment::RSGIS_SEGTILE_BOUNDARY, rsgis::segment::RSGIS_SEGTILE_OVERLAP, rsgis::segment::RSGIS_SEGTILE_BODY, "TilePosition");
+            GDALClose(bodyDataset);
+            
+            // The clumps on the tile boundaries are segmented again as a whole.
+            std::vector<float> maskValues;
+            maskValues.push_back(0);
+            rsgis::img::RSGISMaskImage maskImage;
+            maskImage.maskImage(clustersDataset, borderMaskDataset, borderClusters, plan.imageFormat, GDT_UInt32, 0, maskValues);
+            GDALClose(borderMaskDataset);
+            GDALClose(clustersDataset);
+            
+            std::cout << "Segmenting the tile boundaries\n";
+            executeClump(borderClusters, borderInitClumps, plan.imageFormat, processInMemory, true, 0, false);
+            executeRMSmallClumpsStepwise(plan.spectralImage, borderInitClumps, borderElimClumps, plan.imageFormat, stretchStatsAvail, stretchStatsFile, false, processInMemory, minClumpSize, specThreshold);
+            executeIncludeClumpedRegion(bodyClumps, borderElimClumps, combinedClumps, plan.imageFormat);
+            executeRelabelClumps(combinedClumps, outputImage, plan.imageFormat, processInMemory);
+            
+            GDALDataset *outputDataset = (GDALDataset *) GDALOpen(outputImage.c_str(), GA_Update);
+            if(outputDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + outputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            outputDataset->GetRasterBand(1)->SetMetadataItem("LAYER_TYPE", "thematic");
+            rsgis::rastergis::RSGISPopulateWithImageStats popImageStats;
+            popImageStats.populateImageWithRasterGISStats(outputDataset, true, true, true, 1);
+            GDALClose(outputDataset);
+            
+            GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(plan.imageFormat.c_str());
+            if(gdalDriver == NULL)
+            {
+                throw rsgis::RSGISImageException("Image driver is not available.");
+            }
+            gdalDriver->Delete(bodyClumps.c_str());
+            gdalDriver->Delete(borderMask.c_str());
+            gdalDriver->Delete(borderClusters.c_str());
+            gdalDriver->Delete(borderInitClumps.c_str());
+            gdalDriver->Delete(borderElimClumps.c_str());
+            gdalDriver->Delete(combinedClumps.c_str());
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+    }
+
+    void executeShepherdSegmentation(std::string inputImage, std::string outputImage, std::string imageFormat, std::vector<unsigned int> bands, bool noStretch, unsigned int numClusters, unsigned int minClumpPxls, float specDistThres, unsigned int subSample, unsigned int maxKMeansIter, bool calcStats, std::string stretchStatsFile, std::string kMeansCentresFile, unsigned long maxMemMB, std::string tmpDir)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            GDALDataset *inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(inDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            rsgis::segment::RSGISShepherdSegParams params;
+            params.bands = bands;
+            params.noStretch = noStretch;
+            params.numClusters = numClusters;
+            params.minClumpPxls = minClumpPxls;
+            params.specDistThres = specDistThres;
+            params.subSample = subSample;
+            params.maxKMeansIter = maxKMeansIter;
+            params.calcStats = calcStats;
+            params.stretchStatsFile = stretchStatsFile;
+            params.kMeansCentresFile = kMeansCentresFile;
+            params.maxMemMB = maxMemMB;
+            params.tmpDir = tmpDir;
+            params.numThreads = rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads;
+            
+            rsgis::segment::RSGISShepherdSegmentation::runSegmentation(inDataset, outputImage, imageFormat, params);
+            
+            GDALClose(inDataset);
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+    }
+
+    void executePolygoniseClumps(std::string clumpsImage, unsigned int imgBand, std::string outputVecFile, std::string outputVecLyr, std::string outVecFormat, std::string outField, bool use8Conn, bool del_exist_vec)
+    {
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            
+            GDALDataset *clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_ReadOnly);
+            if(clumpsDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + clumpsImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            rsgis::utils::RSGISFileUtils fileUtils;
+            rsgis::vec::RSGISVectorUtils vecUtils;
+            
+            outputVecFile = boost::filesystem::absolute(outputVecFile).string();
+            if(outVecFormat == "ESRI Shapefile")
+            {
+                std::string outputDIR = fileUtils.getFileDirectoryPath(outputVecFile);
+                if(vecUtils.checkDIR4SHP(outputDIR, outputVecLyr))
+                {
+                    if(del_exist_vec)
+                    {
+                        vecUtils.deleteSHP(outputDIR, outputVecLyr);
+                    }
+                    else
+                    {
+                        throw RSGISException("Vector file already exists, either delete or select del_exist_vec.");
+                    }
+                }
+            }
+            else if(fileUtils.checkFilePresent(outputVecFile))
+            {
+                if(del_exist_vec)
+                {
+                    fileUtils.removeFileIfPresent(outputVecFile);
+                }
+                else
+                {
+                    throw RSGISException("Vector file already exists, either delete or select del_exist_vec.");
+                }
+            }
+            
+            GDALDriver *vecDriver = GetGDALDriverManager()->GetDriverByName(outVecFormat.c_str());
+            if(vecDriver == NULL)
+            {
+                throw rsgis::vec::RSGISVectorOutputException("Vector driver not available: " + outVecFormat);
+            }
+            GDALDataset *outVecDS = vecDriver->Create(outputVecFile.c_str(), 0, 0, 0, GDT_Unknown, NULL);
+            if(outVecDS == NULL)
+            {
+                std::string message = std::string("Could not create vector file ") + outputVecFile;
+                throw rsgis::vec::RSGISVectorOutputException(message.c_str());
+            }
+            OGRSpatialReference *ogrSpatialRef = new OGRSpatialReference(clumpsDataset->GetProjectionRef());
+            char **lyrOptions = rsgis::utils::RSGISOGRFeatureSink::getDeferredSpatialIndexOptions(outVecFormat);
+            OGRLayer *outVecLyrObj = outVecDS->CreateLayer(outputVecLyr.c_str(), ogrSpatialRef, wkbPolygon, lyrOptions);
+            CSLDestroy(lyrOptions);
+            ogrSpatialRef->Release();
+            if(outVecLyrObj == NULL)
+            {
+                std::string message = std::string("Could not create vector layer ") + outputVecLyr;
+                throw rsgis::vec::RSGISVectorOutputException(message.c_str());
+            }
+            
+            rsgis::segment::RSGISPolygoniseClumps polyClumps;
+            polyClumps.polygoniseClumps(clumpsDataset, imgBand, outVecLyrObj, outField, use8Conn);
+            rsgis::utils::RSGISOGRFeatureSink::createDeferredSpatialIndex(outVecDS, outVecLyrObj, outVecFormat);
+            
+            GDALClose(outVecDS);
+            GDALClose(clumpsDataset);
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+    }
+
     
 }}
 
@@ -26,6 +26,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <stdint.h>
 
 #include "common/RSGISCommons.h"
 #include "RSGISCmdException.h"
@@ -65,26 +66,29 @@ namespace rsgis{ namespace cmds {
     /** Function to run the label pixels from clusters centres command */
     DllExport void executeLabelPixelsFromClusterCentres(std::string inputImage, std::string outputImage, std::string clusterCentresFile, bool ignoreZeros, std::string imageFormat);
     
-    /** Function to run the eliminate single pixels command */
+    /** Function to run the eliminate single pixels command (tempImage and processInMemory are no longer used) */
     DllExport void executeEliminateSinglePixels(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string tempImage, std::string imageFormat, bool processInMemory, bool ignoreZeros);
     
-    /** Function to run the clump command */
-    DllExport void executeClump(std::string inputImage, std::string outputImage, std::string imageFormat, bool processInMemory, bool noDataValProvided, float noDataVal, bool addRatPxlVals=true);
+    /** Function to run the clump command (the output is UInt64 if the image has more pixels than UInt32 can label) */
+    DllExport void executeClump(std::string inputImage, std::string outputImage, std::string imageFormat, bool processInMemory, bool noDataValProvided, float noDataVal, bool addRatPxlVals=true, unsigned int nThreads=1);
 
     /** Function to run the iterative stepwise elimination command */
     DllExport void executeRMSmallClumpsStepwise(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string imageFormat, bool stretchStatsAvail, std::string stretchStatsFile, bool storeMean, bool processInMemory, unsigned int minClumpSize, float specThreshold);
     
-    /** Function to run the relabel clumps command */
+    /** Function to run the relabel clumps command (UInt64 clumps are relabelled as UInt64, otherwise UInt32) */
     DllExport void executeRelabelClumps(std::string inputImage, std::string outputImage, std::string imageFormat, bool processInMemory);
     
-    /** Function to run generate mean image command */
-    DllExport void executeMeanImage(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string imageFormat, RSGISLibDataType outDataType, bool processInMemory);
+    /** Function to relabel the clumps within an array in memory (e.g., a numpy array) in place */
+    DllExport void executeRelabelClumpsArray(uint32_t *clumps, size_t nPxls);
+    
+    /** Function to run generate mean image command, where if meanCols is not empty the means are read from those columns of the clumps RAT (one per output band) and the input image is not used */
+    DllExport void executeMeanImage(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string imageFormat, RSGISLibDataType outDataType, bool processInMemory, std::vector<std::string> meanCols=std::vector<std::string>());
     
     /** Function to run assign random colours to clumps commands */
     DllExport void executeRandomColourClumps(std::string inputImage, std::string outputImage, std::string imageFormat, bool processInMemory, std::string importLUTFile, bool importLUT, std::string exportLUTFile, bool exportLUT);
     
     /** Function to run union of segmentations command */
-    DllExport void executeUnionOfClumps(std::vector<std::string> inputImagePaths, std::string outputImage, std::string imageFormat, bool noDataValProvided, float noDataVal, bool addRatPxlVals=true);
+    DllExport void executeUnionOfClumps(std::vector<std::string> inputImagePaths, std::string outputImage, std::string imageFormat, bool noDataValProvided, float noDataVal, bool addRatPxlVals=true, bool tupleIDs=false, unsigned int nThreads=1);
     
     /** Function to run merge segment tiles command */
     DllExport void executeMergeSegmentationTiles(std::string outputImage, std::string borderMaskImage, std::vector<std::string> inputImagePaths, unsigned int tileBoundary, unsigned int tileOverlap, unsigned int tileBody, std::string colsName);
@@ -113,6 +117,24 @@ namespace rsgis{ namespace cmds {
     /** Function merge clumps with same value */
     DllExport void executeMergeClumpsEquivalentVal(std::string clumpsImage, std::string outputImage, std::string imageFormat, std::vector<std::string> clumpsValCols);
 
+    /** Function to define a tiled segmentation as independent tile jobs, written to a manifest file. Returns the number of jobs. */
+    DllExport unsigned int executeCreateSegTilePlan(std::string clustersImage, std::string spectralImage, std::string manifestFile, std::string tilesBase, std::string imageFormat, std::string outFileExt, unsigned int tileXSize, unsigned int tileYSize, unsigned int overlap);
+    
+    /** Function to run (clump, eliminate small clumps and relabel) a single job of a segmentation tile plan */
+    DllExport void executeSegTileJob(std::string manifestFile, unsigned int jobID, unsigned int minClumpSize, float specThreshold, bool stretchStatsAvail, std::string stretchStatsFile, bool processInMemory);
+    
+    /** Function to run the jobs (all jobs if jobIDs is empty) of a segmentation tile plan concurrently on numThreads threads (0 uses all the hardware threads) within the calling process */
+    DllExport void executeRunSegTileJobs(std::string manifestFile, std::vector<unsigned int> jobIDs, unsigned int minClumpSize, float specThreshold, bool stretchStatsAvail, std::string stretchStatsFile, bool processInMemory, unsigned int numThreads=0);
+    
+    /** Function to merge the jobs of a segmentation tile plan, segmenting the regions on the tile boundaries again */
+    DllExport void executeMergeSegTilePlan(std::string manifestFile, std::string outputImage, unsigned int minClumpSize, float specThreshold, bool stretchStatsAvail, std::string stretchStatsFile, bool processInMemory);
+    
+    /** Function to run the Shepherd et al. (2019) segmentation from the input image to the output clumps, holding the intermediate images in memory (unless they require more than maxMemMB, when they are written to tmpDir). An empty bands vector uses all the bands; empty stats and centres file names are not written. */
+    DllExport void executeShepherdSegmentation(std::string inputImage, std::string outputImage, std::string imageFormat, std::vector<unsigned int> bands, bool noStretch, unsigned int numClusters, unsigned int minClumpPxls, float specDistThres, unsigned int subSample, unsigned int maxKMeansIter, bool calcStats, std::string stretchStatsFile, std::string kMeansCentresFile, unsigned long maxMemMB, std::string tmpDir);
+
+    /** Function to polygonise a clumps image (clump 0 is no data) to a vector layer, with the tiles of the image polygonised concurrently and the clumps crossing the tile seams merged by clump ID. */
+    DllExport void executePolygoniseClumps(std::string clumpsImage, unsigned int imgBand, std::string outputVecFile, std::string outputVecLyr, std::string outVecFormat, std::string outField, bool use8Conn, bool del_exist_vec);
+
     
 }}
 
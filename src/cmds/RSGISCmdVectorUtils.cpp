@@ -27,9 +27,11 @@
 
 #include "common/RSGISVectorException.h"
 #include "common/RSGISException.h"
+#include "common/RSGISGDALInit.h"
 
 #include "utils/RSGISTextUtils.h"
 #include "utils/RSGISFileUtils.h"
+#include "utils/RSGISOGRFeatureSink.h"
 
 #include "vec/RSGISProcessVector.h"
 #include "vec/RSGISVectorMaths.h"
@@ -40,11 +42,11 @@
 namespace rsgis{ namespace cmds {
 
             
-    void executeVectorMaths(std::string inputVectorFile, std::string inputVectorLyr, std::string outputVectorFile, std::string outputVectorLyr, std::string outFormat, std::string outColumn, std::string expression, bool delExistVec, std::vector<RSGISVariableFieldCmds> vars)
+    void executeVectorMaths(std::string inputVectorFile, std::string inputVectorLyr, std::string outputVectorFile, std::string outputVectorLyr, std::string outFormat, std::string outColumn, std::string expression, bool delExistVec, std::vector<RSGISVariableFieldCmds> vars, unsigned int numThreads)
     {
         try
         {
-            OGRRegisterAll();
+            rsgis::RSGISGDALInit::init();
 
             rsgis::utils::RSGISFileUtils fileUtils;
             rsgis::vec::RSGISVectorUtils vecUtils;
@@ -139,7 +141,7 @@ namespace rsgis{ namespace cmds {
             }
             
             processFeature = new rsgis::vec::RSGISVectorMaths(variables, numVars, expression, outColumn);
-            processVector = new rsgis::vec::RSGISProcessVector(processFeature);
+            processVector = new rsgis::vec::RSGISProcessVector(processFeature, numThreads);
             processVector->processVectors(inputVecLayer, outputVecLayer, true, true, false);
             
             for(unsigned i = 0; i < numVars; ++i)
@@ -173,8 +175,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            OGRRegisterAll();
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             rsgis::utils::RSGISFileUtils fileUtils;
             rsgis::vec::RSGISVectorUtils vecUtils;
@@ -252,7 +253,9 @@ namespace rsgis{ namespace cmds {
                 std::string message = std::string("Could not create vector file ") + outputVectorFile;
                 throw rsgis::vec::RSGISVectorOutputException(message.c_str());
             }
-            outputVecLayer = outputVecDS->CreateLayer(outputVectorLyr.c_str(), inputSpatialRef, wkbPoint, NULL );
+            char **lyrOptions = rsgis::utils::RSGISOGRFeatureSink::getDeferredSpatialIndexOptions(outFormat);
+            outputVecLayer = outputVecDS->CreateLayer(outputVectorLyr.c_str(), inputSpatialRef, wkbPoint, lyrOptions );
+            CSLDestroy(lyrOptions);
             if( outputVecLayer == NULL )
             {
                 std::string message = std::string("Could not create vector layer ") + outputVectorLyr;
@@ -272,6 +275,7 @@ namespace rsgis{ namespace cmds {
             
             rsgis::vec::RSGISVectorIO vecIO;
             vecIO.exportOGRPoints2Layer(outputVecLayer, pts);
+            rsgis::utils::RSGISOGRFeatureSink::createDeferredSpatialIndex(outputVecDS, outputVecLayer, outFormat);
             
             GDALClose(inputVecDS);
             GDALClose(outputVecDS);
@@ -292,12 +296,11 @@ namespace rsgis{ namespace cmds {
     }
             
 
-    void executeCheckValidateGeometries(std::string inputVectorFile, std::string inputVectorLyr, std::string outputVectorFile, std::string outputVectorLyr, std::string outFormat, bool printGeomErrs, bool delExistVec)
+    void executeCheckValidateGeometries(std::string inputVectorFile, std::string inputVectorLyr, std::string outputVectorFile, std::string outputVectorLyr, std::string outFormat, bool printGeomErrs, bool delExistVec, unsigned int numThreads)
     {
         try
         {
-            OGRRegisterAll();
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             rsgis::utils::RSGISFileUtils fileUtils;
             rsgis::vec::RSGISVectorUtils vecUtils;
@@ -381,7 +384,7 @@ namespace rsgis{ namespace cmds {
 
             std::cout.precision(12);
             rsgis::vec::RSGISCopyCheckPolygons checkPolys;
-            checkPolys.copyCheckPolygons(inputVecLayer, outputVecLayer, printGeomErrs);
+            checkPolys.copyCheckPolygons(inputVecLayer, outputVecLayer, printGeomErrs, numThreads);
 
             GDALClose(inputVecDS);
             GDALClose(outputVecDS);
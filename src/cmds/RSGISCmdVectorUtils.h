@@ -52,13 +52,13 @@ namespace rsgis{ namespace cmds{
     };
 
     /** Function to calculate a maths functions between  */
-    DllExport void executeVectorMaths(std::string inputVectorFile, std::string inputVectorLyr, std::string outputVectorFile, std::string outputVectorLyr, std::string outFormat, std::string outColumn, std::string expression, bool delExistVec, std::vector<RSGISVariableFieldCmds> vars);
+    DllExport void executeVectorMaths(std::string inputVectorFile, std::string inputVectorLyr, std::string outputVectorFile, std::string outputVectorLyr, std::string outFormat, std::string outColumn, std::string expression, bool delExistVec, std::vector<RSGISVariableFieldCmds> vars, unsigned int numThreads=1);
 
     /** Function to convert a set of lines into regularly spaced set of points */
     DllExport void executeCreateLinesOfPoints(std::string inputVectorFile, std::string inputVectorLyr, std::string outputVectorFile, std::string outputVectorLyr, std::string outFormat, double step, bool delExistVec);
 
-    /** Function to check and validate the geometries within the vector file */
-    DllExport void executeCheckValidateGeometries(std::string inputVectorFile, std::string inputVectorLyr, std::string outputVectorFile, std::string outputVectorLyr, std::string outFormat, bool printGeomErrs, bool delExistVec);
+    /** Function to check and validate the geometries within the vector file, repairing invalid polygons (numThreads of 0 uses all the available cores) */
+    DllExport void executeCheckValidateGeometries(std::string inputVectorFile, std::string inputVectorLyr, std::string outputVectorFile, std::string outputVectorLyr, std::string outFormat, bool printGeomErrs, bool delExistVec, unsigned int numThreads=1);
 }}
 
 
@@ -26,8 +26,10 @@
 #include "RSGISCmdParent.h"
 
 #include "common/RSGISException.h"
+#include "common/RSGISGDALInit.h"
 
 #include "img/RSGISExtractImageValues.h"
+#include "img/RSGISExtractImageChips.h"
 
 #include "vec/RSGISZonalImage2HDF.h"
 #include "vec/RSGISExtractEndMembers2Matrix.h"
@@ -41,8 +43,7 @@ namespace rsgis{ namespace cmds {
         // Convert to absolute path
         inputVecFile = std::string(boost::filesystem::absolute(inputVecFile).string());
 
-        GDALAllRegister();
-        OGRRegisterAll();
+        rsgis::RSGISGDALInit::init();
 
         GDALDataset *inputImageDS = NULL;
         GDALDataset *inputVecDS = NULL;
@@ -107,8 +108,7 @@ namespace rsgis{ namespace cmds {
         // Convert to absolute path
         inputVecFile = std::string(boost::filesystem::absolute(inputVecFile).string());
         
-        GDALAllRegister();
-        OGRRegisterAll();
+        rsgis::RSGISGDALInit::init();
 
         GDALDataset *inputImageDS = NULL;
         GDALDataset *inputVecDS = NULL;
@@ -168,7 +168,7 @@ namespace rsgis{ namespace cmds {
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
 
             GDALDataset *maskDS = (GDALDataset *) GDALOpen(maskImage.c_str(), GA_ReadOnly);
             if(maskDS == NULL)
@@ -226,6 +226,27 @@ namespace rsgis{ namespace cmds {
         }
     }
 
+    void executeImageBandChipsRasterZone2HDF(std::vector<std::pair<std::string, std::vector<unsigned int> > > imageFiles, std::string maskImage, float maskVal, unsigned int chipSize, std::string outputHDF, RSGISLibDataType dataType, std::string refImage, unsigned int refBand, unsigned int numThreads)
+    {
+        try
+        {
+            rsgis::img::RSGISExtractImageChips extractChips(numThreads);
+            extractChips.extractChipsWithinMask2HDF(imageFiles, maskImage, maskVal, chipSize, outputHDF, dataType, refImage, refBand);
+        }
+        catch (RSGISImageException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch (RSGISException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+
     void executeRandomSampleH5File(std::string inputH5, std::string outputH5, unsigned int nSample, int seed, RSGISLibDataType dataType)
     {
         try
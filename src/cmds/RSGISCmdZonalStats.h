@@ -57,6 +57,9 @@ namespace rsgis{ namespace cmds {
     /** A function to extract image band values to a HDF file */
     DllExport void executeImageBandRasterZone2HDF(std::vector<std::pair<std::string, std::vector<unsigned int> > > imageFiles, std::string maskImage, std::string outputHDF, float maskVal, RSGISLibDataType dataType);
 
+    /** A function to extract chips of image band values, centred on the mask pixels, to a HDF file (with chips of the reference image band if refImage is not empty) */
+    DllExport void executeImageBandChipsRasterZone2HDF(std::vector<std::pair<std::string, std::vector<unsigned int> > > imageFiles, std::string maskImage, float maskVal, unsigned int chipSize, std::string outputHDF, RSGISLibDataType dataType, std::string refImage="", unsigned int refBand=1, unsigned int numThreads=1);
+
     /** A function to sample a list of values saved in a HDF5 file */
     DllExport void executeRandomSampleH5File(std::string inputH5, std::string outputH5, unsigned int nSample, int seed, RSGISLibDataType dataType);
 
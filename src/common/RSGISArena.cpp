@@ -0,0 +1,109 @@
+/*
+ *  RSGISArena.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISArena.h"
+
+namespace rsgis
+{
+    
+    RSGISArena::RSGISArena(size_t blockSize)
+    {
+        this->blockSize = std::max<size_t>(blockSize, 64);
+        this->cBlock = 0;
+        this->cOffset = 0;
+        this->numBytesReserved = 0;
+    }
+    
+    void* RSGISArena::allocate(size_t nBytes, size_t alignment)
+    {
+        if(nBytes == 0)
+        {
+            nBytes = 1;
+        }
+        if(!this->blocks.empty())
+        {
+            RSGISArenaBlock &block = this->blocks[this->cBlock];
+            size_t pos = reinterpret_cast<size_t>(block.data) + this->cOffset;
+            size_t offset = this->cOffset + (((alignment - (pos % alignment)) % alignment));
+            if((offset + nBytes) <= block.size)
+            {
+                this->cOffset = offset + nBytes;
+                return block.data + offset;
+            }
+        }
+        
+        // Move on to the next block, reusing the blocks kept by reset() where they are large enough.
+        size_t minSize = nBytes + alignment;
+        size_t nextBlock = this->blocks.empty()?0:(this->cBlock + 1);
+        while((nextBlock < this->blocks.size()) && (this->blocks[nextBlock].size < minSize))
+        {
+            ++nextBlock;
+        }
+        if(nextBlock >= this->blocks.size())
+        {
+            RSGISArenaBlock block;
+            block.size = std::max(this->blockSize, minSize);
+            block.data = static_cast<char*>(::operator new(block.size));
+            this->numBytesReserved += block.size;
+            nextBlock = this->blocks.empty()?0:(this->cBlock + 1);
+            this->blocks.insert(this->blocks.begin() + nextBlock, block);
+        }
+        else if(nextBlock != (this->cBlock + 1))
+        {
+            // Swap the block into the next position so the skipped blocks stay available.
+            std::swap(this->blocks[nextBlock], this->blocks[this->cBlock + 1]);
+            nextBlock = this->cBlock + 1;
+        }
+        this->cBlock = nextBlock;
+        
+        RSGISArenaBlock &block = this->blocks[this->cBlock];
+        size_t pos = reinterpret_cast<size_t>(block.data);
+        size_t offset = (alignment - (pos % alignment)) % alignment;
+        this->cOffset = offset + nBytes;
+        return block.data + offset;
+    }
+    
+    void RSGISArena::reset()
+    {
+        this->cBlock = 0;
+        this->cOffset = 0;
+    }
+    
+    void RSGISArena::release()
+    {
+        for(size_t i = 0; i < this->blocks.size(); ++i)
+        {
+            ::operator delete(this->blocks[i].data);
+        }
+        this->blocks.clear();
+        this->cBlock = 0;
+        this->cOffset = 0;
+        this->numBytesReserved = 0;
+    }
+    
+    RSGISArena::~RSGISArena()
+    {
+        this->release();
+    }
+    
+}
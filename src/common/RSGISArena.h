@@ -0,0 +1,107 @@
+/*
+ *  RSGISArena.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISArena_H
+#define RSGISArena_H
+
+#include <iostream>
+#include <vector>
+#include <new>
+#include <utility>
+#include <cstddef>
+#include <type_traits>
+#include <algorithm>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_commons_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis
+{
+    /**
+     * A region (arena) allocator for the many small, short-lived objects of a job
+     * (e.g., a clump table), which are allocated by bumping a pointer within large
+     * blocks and are all released at once with reset() or when the arena is
+     * destroyed rather than being deleted individually. Only trivially destructible
+     * types can be created within the arena as their destructors are not called.
+     * An arena must not be used by more than one thread at a time.
+     */
+    class DllExport RSGISArena
+    {
+    public:
+        /** The blocks are blockSize bytes, other than for larger allocations which get their own block. */
+        RSGISArena(size_t blockSize=1048576);
+        /** Allocate nBytes with the alignment (a power of 2). */
+        void* allocate(size_t nBytes, size_t alignment=alignof(std::max_align_t));
+        /** Allocate an array of n value initialised (i.e., zeroed for numeric types) values. */
+        template <typename T>
+        T* allocArray(size_t n)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "Only trivially destructible types can be allocated in an RSGISArena.");
+            T *vals = static_cast<T*>(this->allocate(sizeof(T) * n, alignof(T)));
+            for(size_t i = 0; i < n; ++i)
+            {
+                new(vals + i) T();
+            }
+            return vals;
+        };
+        /** Construct an object within the arena. */
+        template <typename T, typename... Args>
+        T* create(Args&&... args)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "Only trivially destructible types can be allocated in an RSGISArena.");
+            return new(this->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        };
+        /** Release all the allocations at once, keeping the blocks to be reused (e.g., for the next block of a job). */
+        void reset();
+        /** Release all the allocations and free the blocks. */
+        void release();
+        /** The total size of the blocks allocated from the heap. */
+        size_t getNumBytesReserved() const {return this->numBytesReserved;};
+        ~RSGISArena();
+    protected:
+        RSGISArena(const RSGISArena&) = delete;
+        RSGISArena& operator=(const RSGISArena&) = delete;
+        struct RSGISArenaBlock
+        {
+            char *data;
+            size_t size;
+        };
+        std::vector<RSGISArenaBlock> blocks;
+        size_t blockSize;
+        size_t cBlock;
+        size_t cOffset;
+        size_t numBytesReserved;
+    };
+}
+
+#endif
@@ -0,0 +1,173 @@
+/*
+ *  RSGISCalcImageProfiler.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#include "RSGISCalcImageProfiler.h"
+
+namespace rsgis
+{
+    std::atomic<bool> RSGISCalcImageProfiler::rsgisCalcImageProfilerEnabled(false);
+
+    static std::mutex rsgisProfileMutex;
+    static RSGISCalcImageProfile rsgisProfileTotals = RSGISCalcImageProfile();
+    // The totals when the current (outer) run started.
+    static RSGISCalcImageProfile rsgisProfileRunStart = RSGISCalcImageProfile();
+    static unsigned int rsgisProfileRunDepth = 0;
+
+    void RSGISCalcImageProfiler::setEnabled(bool enabled)
+    {
+        rsgisCalcImageProfilerEnabled.store(enabled);
+    }
+
+    void RSGISCalcImageProfiler::reset()
+    {
+        std::lock_guard<std::mutex> lock(rsgisProfileMutex);
+        rsgisProfileTotals = RSGISCalcImageProfile();
+        rsgisProfileRunStart = RSGISCalcImageProfile();
+    }
+
+    RSGISCalcImageProfile RSGISCalcImageProfiler::getProfile()
+    {
+        std::lock_guard<std::mutex> lock(rsgisProfileMutex);
+        return rsgisProfileTotals;
+    }
+
+    std::string RSGISCalcImageProfiler::getJSON(const RSGISCalcImageProfile &profile, std::string engine)
+    {
+        const char *phaseNames[rsgis_profile_num_phases] = {"read", "calc", "write"};
+        std::ostringstream json;
+        json.precision(9);
+        json << "{";
+        if(engine != "")
+        {
+            json << "\"engine\": \"" << engine << "\", ";
+        }
+        json << "\"num_runs\": " << profile.numRuns << ", \"wall_time\": " << profile.wallTime;
+        for(int i = 0; i < rsgis_profile_num_phases; ++i)
+        {
+            const RSGISProfilePhaseStats &phase = profile.phases[i];
+            json << ", \"" << phaseNames[i] << "\": {\"time\": " << phase.time << ", \"blocks\": " << phase.blocks;
+            if(i == rsgis_profile_calc)
+            {
+                double timePerCallback = (phase.callbacks > 0)?(phase.time / phase.callbacks):0.0;
+                json << ", \"callbacks\": " << phase.callbacks << ", \"time_per_callback\": " << timePerCallback;
+            }
+            else
+            {
+                json << ", \"bytes\": " << phase.bytes;
+            }
+            json << "}";
+        }
+        json << "}";
+        return json.str();
+    }
+
+    void RSGISCalcImageProfiler::startRun()
+    {
+        std::lock_guard<std::mutex> lock(rsgisProfileMutex);
+        if(rsgisProfileRunDepth == 0)
+        {
+            rsgisProfileRunStart = rsgisProfileTotals;
+        }
+        ++rsgisProfileRunDepth;
+    }
+
+    void RSGISCalcImageProfiler::endRun(std::string engine, double wallTime)
+    {
+        RSGISCalcImageProfile run = RSGISCalcImageProfile();
+        {
+            std::lock_guard<std::mutex> lock(rsgisProfileMutex);
+            if(rsgisProfileRunDepth == 0)
+            {
+                return;
+            }
+            if(--rsgisProfileRunDepth > 0)
+            {
+                return;
+            }
+            rsgisProfileTotals.numRuns += 1;
+            rsgisProfileTotals.wallTime += wallTime;
+            run.numRuns = 1;
+            run.wallTime = wallTime;
+            for(int i = 0; i < rsgis_profile_num_phases; ++i)
+            {
+                run.phases[i].time = rsgisProfileTotals.phases[i].time - rsgisProfileRunStart.phases[i].time;
+                run.phases[i].bytes = rsgisProfileTotals.phases[i].bytes - rsgisProfileRunStart.phases[i].bytes;
+                run.phases[i].blocks = rsgisProfileTotals.phases[i].blocks - rsgisProfileRunStart.phases[i].blocks;
+                run.phases[i].callbacks = rsgisProfileTotals.phases[i].callbacks - rsgisProfileRunStart.phases[i].callbacks;
+            }
+        }
+        std::cout << RSGISCalcImageProfiler::getJSON(run, engine) << std::endl;
+    }
+
+    void RSGISCalcImageProfiler::addPhase(RSGISProfilePhase phase, double time, unsigned long long bytes, unsigned long long callbacks)
+    {
+        std::lock_guard<std::mutex> lock(rsgisProfileMutex);
+        RSGISProfilePhaseStats &stats = rsgisProfileTotals.phases[phase];
+        stats.time += time;
+        stats.bytes += bytes;
+        stats.blocks += 1;
+        stats.callbacks += callbacks;
+    }
+
+    RSGISProfileRun::RSGISProfileRun(std::string engine)
+    {
+        this->active = RSGISCalcImageProfiler::isEnabled();
+        if(this->active)
+        {
+            this->engine = engine;
+            this->startTime = std::chrono::steady_clock::now();
+            RSGISCalcImageProfiler::startRun();
+        }
+    }
+
+    RSGISProfileRun::~RSGISProfileRun()
+    {
+        if(this->active)
+        {
+            std::chrono::duration<double> wallTime = std::chrono::steady_clock::now() - this->startTime;
+            RSGISCalcImageProfiler::endRun(this->engine, wallTime.count());
+        }
+    }
+
+    RSGISProfileTimer::RSGISProfileTimer(RSGISProfilePhase phase, unsigned long long bytes, unsigned long long callbacks)
+    {
+        this->active = RSGISCalcImageProfiler::isEnabled();
+        this->phase = phase;
+        this->bytes = bytes;
+        this->callbacks = callbacks;
+        if(this->active)
+        {
+            this->startTime = std::chrono::steady_clock::now();
+        }
+    }
+
+    void RSGISProfileTimer::stop()
+    {
+        if(this->active)
+        {
+            std::chrono::duration<double> time = std::chrono::steady_clock::now() - this->startTime;
+            RSGISCalcImageProfiler::addPhase(this->phase, time.count(), this->bytes, this->callbacks);
+            this->active = false;
+        }
+    }
+}
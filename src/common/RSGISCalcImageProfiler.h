@@ -0,0 +1,134 @@
+/*
+ *  RSGISCalcImageProfiler.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifndef RSGISCalcImageProfiler_H
+#define RSGISCalcImageProfiler_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_commons_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis
+{
+    enum RSGISProfilePhase
+    {
+        rsgis_profile_read,
+        rsgis_profile_calc,
+        rsgis_profile_write,
+        rsgis_profile_num_phases
+    };
+
+    struct DllExport RSGISProfilePhaseStats
+    {
+        /// The wall time (seconds) summed over the timed sections of the phase.
+        double time;
+        /// The bytes read or written.
+        unsigned long long bytes;
+        /// The number of timed sections (i.e., blocks, strips or tiles).
+        unsigned long long blocks;
+        /// The number of calls to the calc object (calc phase only).
+        unsigned long long callbacks;
+    };
+
+    struct DllExport RSGISCalcImageProfile
+    {
+        unsigned long numRuns;
+        /// The wall time (seconds) of the runs.
+        double wallTime;
+        RSGISProfilePhaseStats phases[rsgis_profile_num_phases];
+    };
+
+    /**
+     * Opt-in instrumentation of the image calculation engines, recording the wall
+     * time, bytes and blocks of the read, calc and write phases of each run. When
+     * enabled the summary of each run is printed to the console as a single line
+     * of JSON when the run ends, and the totals over all the runs since the last
+     * reset can be retrieved with getProfile. When the I/O is on separate threads
+     * (see RSGISStripIOPipeline) the phases overlap, so the phase times can sum to
+     * more than the wall time. Runs on several threads at once are counted together.
+     */
+    class DllExport RSGISCalcImageProfiler
+    {
+    public:
+        static void setEnabled(bool enabled);
+        static bool isEnabled(){return rsgisCalcImageProfilerEnabled.load(std::memory_order_relaxed);};
+        static void reset();
+        static RSGISCalcImageProfile getProfile();
+        static std::string getJSON(const RSGISCalcImageProfile &profile, std::string engine="");
+        /** Called by RSGISProfileRun and RSGISProfileTimer. */
+        static void startRun();
+        static void endRun(std::string engine, double wallTime);
+        static void addPhase(RSGISProfilePhase phase, double time, unsigned long long bytes, unsigned long long callbacks);
+    protected:
+        static std::atomic<bool> rsgisCalcImageProfilerEnabled;
+    };
+
+    /**
+     * Records a run of an engine (named by engine) from construction to destruction
+     * when profiling is enabled. Runs within runs (e.g., an engine calling another)
+     * are part of the outer run.
+     */
+    class DllExport RSGISProfileRun
+    {
+    public:
+        RSGISProfileRun(std::string engine);
+        ~RSGISProfileRun();
+    protected:
+        bool active;
+        std::string engine;
+        std::chrono::steady_clock::time_point startTime;
+    };
+
+    /** Adds the wall time from construction to stop (or destruction) to a phase when profiling is enabled. */
+    class DllExport RSGISProfileTimer
+    {
+    public:
+        RSGISProfileTimer(RSGISProfilePhase phase, unsigned long long bytes=0, unsigned long long callbacks=0);
+        void stop();
+        ~RSGISProfileTimer(){this->stop();};
+    protected:
+        bool active;
+        RSGISProfilePhase phase;
+        unsigned long long bytes;
+        unsigned long long callbacks;
+        std::chrono::steady_clock::time_point startTime;
+    };
+}
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ *  RSGISExecutionContext.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#include "RSGISExecutionContext.h"
+
+namespace rsgis
+{
+    static unsigned int rsgisDefaultStripMemoryMB = 0;
+    static unsigned int rsgisDefaultGDALCacheMB = 0;
+    static unsigned int rsgisDefaultNumThreads = 1;
+    static unsigned int rsgisDefaultCheckpointSecs = 0;
+    static unsigned int rsgisDefaultClumpsMemoryMB = 0;
+    static unsigned int rsgisDefaultRemoteMaxRequests = 4;
+    static unsigned int rsgisDefaultCompressThreads = 1;
+    static unsigned int rsgisDefaultMemoryBudgetMB = 0;
+    static unsigned int rsgisDefaultPreviewFactor = 0;
+    static std::string rsgisDefaultResultCacheDir = "";
+    static unsigned int rsgisDefaultResultCacheMB = 0;
+    static bool rsgisDefaultResultCacheHashContents = false;
+    static bool rsgisDefaultUseGPU = false;
+    static bool rsgisDefaultNUMAPlacement = false;
+
+    void RSGISExecutionContextUtils::setDefaultContext(RSGISExecutionContext context)
+    {
+        rsgisDefaultStripMemoryMB = context.stripMemoryMB;
+        rsgisDefaultGDALCacheMB = context.gdalCacheMB;
+        rsgisDefaultNumThreads = context.numThreads;
+        rsgisDefaultCheckpointSecs = context.checkpointSecs;
+        rsgisDefaultClumpsMemoryMB = context.clumpsMemoryMB;
+        rsgisDefaultRemoteMaxRequests = context.remoteMaxRequests;
+        rsgisDefaultCompressThreads = context.compressThreads;
+        rsgisDefaultMemoryBudgetMB = context.memoryBudgetMB;
+        rsgisDefaultPreviewFactor = context.previewFactor;
+        rsgisDefaultResultCacheDir = context.resultCacheDir;
+        rsgisDefaultResultCacheMB = context.resultCacheMB;
+        rsgisDefaultResultCacheHashContents = context.resultCacheHashContents;
+        rsgisDefaultUseGPU = context.useGPU;
+        rsgisDefaultNUMAPlacement = context.numaPlacement;
+        RSGISStripIOPipeline::setDefaultNumBuffers(context.numIOBuffers);
+    }
+
+    RSGISExecutionContext RSGISExecutionContextUtils::getDefaultContext()
+    {
+        RSGISExecutionContext context;
+        context.stripMemoryMB = rsgisDefaultStripMemoryMB;
+        context.gdalCacheMB = rsgisDefaultGDALCacheMB;
+        context.numThreads = rsgisDefaultNumThreads;
+        context.numIOBuffers = RSGISStripIOPipeline::getDefaultNumBuffers();
+        context.checkpointSecs = rsgisDefaultCheckpointSecs;
+        context.clumpsMemoryMB = rsgisDefaultClumpsMemoryMB;
+        context.remoteMaxRequests = rsgisDefaultRemoteMaxRequests;
+        context.compressThreads = rsgisDefaultCompressThreads;
+        context.memoryBudgetMB = rsgisDefaultMemoryBudgetMB;
+        context.previewFactor = rsgisDefaultPreviewFactor;
+        context.resultCacheDir = rsgisDefaultResultCacheDir;
+        context.resultCacheMB = rsgisDefaultResultCacheMB;
+        context.resultCacheHashContents = rsgisDefaultResultCacheHashContents;
+        context.useGPU = rsgisDefaultUseGPU;
+        context.numaPlacement = rsgisDefaultNUMAPlacement;
+        return context;
+    }
+
+    int RSGISExecutionContextUtils::calcStripRows(int blockRows, int width, int height, size_t bytesPerPxl, unsigned int stripMemoryMB)
+    {
+        if((stripMemoryMB == 0) || (blockRows <= 0) || (width <= 0) || (bytesPerPxl == 0))
+        {
+            return blockRows;
+        }
+        size_t rowBytes = ((size_t)width) * bytesPerPxl;
+        size_t maxRows = (((size_t)stripMemoryMB) * 1024 * 1024) / rowBytes;
+        size_t rows = (maxRows / blockRows) * blockRows;
+        if(rows < ((size_t)blockRows))
+        {
+            rows = blockRows;
+        }
+        if(rows > ((size_t)height))
+        {
+            rows = std::max(height, blockRows);
+        }
+        return (int)rows;
+    }
+    
+    unsigned int RSGISExecutionContextUtils::getOutOfCoreMemoryMB()
+    {
+        if(rsgisDefaultClumpsMemoryMB > 0)
+        {
+            return rsgisDefaultClumpsMemoryMB;
+        }
+        return rsgisDefaultMemoryBudgetMB;
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ *  RSGISExecutionContext.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifndef RSGISExecutionContext_H
+#define RSGISExecutionContext_H
+
+#include <iostream>
+#include <string>
+#include <algorithm>
+
+#include "common/RSGISStripIOPipeline.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_commons_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis
+{
+    /**
+     * The resources used by the image calculation engines (see rsgis::img::RSGISCalcImage)
+     * which are created after the default context has been set.
+     */
+    struct DllExport RSGISExecutionContext
+    {
+        /// The target memory (MB) of the buffers for each strip of the image (0 uses a strip of the image block height).
+        unsigned int stripMemoryMB;
+        /// The size (MB) of the GDAL block cache (0 leaves the GDAL default).
+        unsigned int gdalCacheMB;
+        /// The number of threads used to process each strip.
+        unsigned int numThreads;
+        /// The number of strip buffers (see rsgis::RSGISStripIOPipeline).
+        unsigned int numIOBuffers;
+        /// The interval (seconds) between checkpoints of the output images so they can be resumed (0 is no checkpoints).
+        unsigned int checkpointSecs;
+        /// The maximum memory (MB) of the clumps arrays of the segmentation algorithms, above which they are memory-mapped files (0 is always in memory).
+        unsigned int clumpsMemoryMB;
+        /// The maximum number of concurrent requests used to read each strip of a remote (e.g., /vsis3/) input image (0 reads remote images as local images).
+        unsigned int remoteMaxRequests;
+        /// The number of threads used by GDAL to compress the blocks of the GTiff and COG outputs, independent of numThreads (0 uses all available cores, 1 compresses on the writing thread).
+        unsigned int compressThreads;
+        /// The memory budget (MB) of each command, above which commands use their out-of-core strategy where they have one (0 is no budget).
+        unsigned int memoryBudgetMB;
+        /// The decimation factor of the preview mode of the image calculations, where the outputs are previewFactor times coarser than the inputs (0 or 1 is full resolution).
+        unsigned int previewFactor;
+        /// The directory of the cache of command results (see rsgis::cmds::RSGISCmdResultCache), where an empty path is no cache.
+        std::string resultCacheDir;
+        /// The maximum size (MB) of the result cache, above which the least recently used results are removed (0 is no limit).
+        unsigned int resultCacheMB;
+        /// Whether the input files of the cached commands are identified by a digest of their contents rather than their path, size and modification time.
+        bool resultCacheHashContents;
+        /// Whether the kernels with an OpenCL implementation are offloaded to the GPU (see rsgis::RSGISOpenCLDevice), where false (the default) always uses the CPU.
+        bool useGPU;
+        /// Whether the workers of the parallel engines are pinned to the NUMA nodes of the machine, with the buffers of each worker allocated on its node (see rsgis::RSGISThreadPool), where false (the default) leaves the placement to the operating system.
+        bool numaPlacement;
+    };
+
+    class DllExport RSGISExecutionContextUtils
+    {
+    public:
+        /** Set the default context. The number of I/O buffers is also set as the rsgis::RSGISStripIOPipeline default. */
+        static void setDefaultContext(RSGISExecutionContext context);
+        static RSGISExecutionContext getDefaultContext();
+        /**
+         * Get the number of rows in a strip of an image of width x height pixels
+         * where each pixel of the strip buffers uses bytesPerPxl bytes. The strip is
+         * the largest multiple of blockRows within stripMemoryMB (but at least
+         * blockRows and no more than the height of the image, unless blockRows is
+         * larger). If stripMemoryMB is 0 then blockRows is returned.
+         */
+        static int calcStripRows(int blockRows, int width, int height, size_t bytesPerPxl, unsigned int stripMemoryMB);
+        /**
+         * Get the memory (MB) above which the clumps arrays (and other per-pixel or per-clump
+         * arrays with an out-of-core strategy) are memory-mapped files. This is the clumpsMemoryMB
+         * of the default context or, if that is 0, the memoryBudgetMB (0 is always in memory).
+         */
+        static unsigned int getOutOfCoreMemoryMB();
+    };
+}
+
+#endif
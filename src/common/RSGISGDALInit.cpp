@@ -0,0 +1,54 @@
+/*
+ *  RSGISGDALInit.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISGDALInit.h"
+
+#include <mutex>
+#include <atomic>
+
+#include "gdal_priv.h"
+
+namespace rsgis
+{
+    static std::once_flag rsgisGDALInitFlag;
+    static std::atomic<bool> rsgisGDALInitialised( false );
+
+    void RSGISGDALInit::init()
+    {
+        if(rsgisGDALInitialised.load(std::memory_order_acquire))
+        {
+            return;
+        }
+        std::call_once(rsgisGDALInitFlag, []()
+        {
+            // Since GDAL 2 this registers the vector (OGR) drivers as well.
+            GDALAllRegister();
+            rsgisGDALInitialised.store(true, std::memory_order_release);
+        });
+    }
+
+    bool RSGISGDALInit::isInitialised()
+    {
+        return rsgisGDALInitialised.load(std::memory_order_acquire);
+    }
+}
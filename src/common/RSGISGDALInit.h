@@ -0,0 +1,61 @@
+/*
+ *  RSGISGDALInit.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISGDALInit_H
+#define RSGISGDALInit_H
+
+#include <iostream>
+#include <string>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_commons_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis
+{
+    /**
+     * The process-wide initialisation of GDAL and OGR, used by the commands and engines
+     * in place of calling GDALAllRegister and OGRRegisterAll each time. The drivers are
+     * registered by the first call (from any thread, with the other threads waiting for
+     * it to complete); later calls only check a flag.
+     */
+    class DllExport RSGISGDALInit
+    {
+    public:
+        /** Register the GDAL (raster and vector) drivers, if they have not already been registered. */
+        static void init();
+        /** True once init has completed. */
+        static bool isInitialised();
+    };
+}
+
+#endif
@@ -0,0 +1,456 @@
+/*
+ *  RSGISOpenCL.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISOpenCL.h"
+
+#include <vector>
+#include <map>
+#include <mutex>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include "common/RSGISExecutionContext.h"
+
+#ifdef RSGISLIB_WITH_OPENCL
+    #define CL_TARGET_OPENCL_VERSION 120
+    #ifdef __APPLE__
+        #include <OpenCL/opencl.h>
+    #else
+        #include <CL/cl.h>
+    #endif
+#endif
+
+namespace rsgis
+{
+#ifdef RSGISLIB_WITH_OPENCL
+    /// The maximum number of pixels in each chunk transferred to the device.
+    static const size_t rsgisOpenCLMaxChunkPxls( 262144 );
+    /// The work items of a chunk are rounded up to a multiple of this.
+    static const size_t rsgisOpenCLWorkGroupMultiple( 64 );
+
+    struct RSGISOpenCLDeviceState
+    {
+        bool available;
+        cl_device_id device;
+        cl_context context;
+        std::string name;
+        std::mutex programsMutex;
+        std::map<std::string, cl_program> programs;
+    };
+
+    static void checkOpenCL(cl_int err, const std::string &call)
+    {
+        if(err != CL_SUCCESS)
+        {
+            throw RSGISException("OpenCL error " + std::to_string(err) + " from " + call + ".");
+        }
+    }
+
+    static std::string getOpenCLDeviceInfo(cl_device_id device, cl_device_info param)
+    {
+        size_t len = 0;
+        if((clGetDeviceInfo(device, param, 0, nullptr, &len) != CL_SUCCESS) || (len == 0))
+        {
+            return "";
+        }
+        std::vector<char> info(len);
+        if(clGetDeviceInfo(device, param, len, info.data(), nullptr) != CL_SUCCESS)
+        {
+            return "";
+        }
+        return std::string(info.data());
+    }
+
+    static RSGISOpenCLDeviceState* createOpenCLDeviceState()
+    {
+        RSGISOpenCLDeviceState *state = new RSGISOpenCLDeviceState();
+        state->available = false;
+        state->device = nullptr;
+        state->context = nullptr;
+
+        std::string nameFilter = "";
+        const char *envDevice = std::getenv("RSGISLIB_OPENCL_DEVICE");
+        if(envDevice != nullptr)
+        {
+            nameFilter = std::string(envDevice);
+        }
+
+        cl_uint numPlatforms = 0;
+        if((clGetPlatformIDs(0, nullptr, &numPlatforms) != CL_SUCCESS) || (numPlatforms == 0))
+        {
+            return state;
+        }
+        std::vector<cl_platform_id> platforms(numPlatforms);
+        if(clGetPlatformIDs(numPlatforms, platforms.data(), nullptr) != CL_SUCCESS)
+        {
+            return state;
+        }
+        for(cl_platform_id platform : platforms)
+        {
+            cl_uint numDevices = 0;
+            if((clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU | CL_DEVICE_TYPE_ACCELERATOR, 0, nullptr, &numDevices) != CL_SUCCESS) || (numDevices == 0))
+            {
+                continue;
+            }
+            std::vector<cl_device_id> devices(numDevices);
+            if(clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU | CL_DEVICE_TYPE_ACCELERATOR, numDevices, devices.data(), nullptr) != CL_SUCCESS)
+            {
+                continue;
+            }
+            for(cl_device_id device : devices)
+            {
+                // The kernels accumulate in double precision to give the same results as the CPU.
+                std::string name = getOpenCLDeviceInfo(device, CL_DEVICE_NAME);
+                std::string extensions = getOpenCLDeviceInfo(device, CL_DEVICE_EXTENSIONS);
+                if(extensions.find("cl_khr_fp64") == std::string::npos)
+                {
+                    continue;
+                }
+                if((nameFilter != "") && (name.find(nameFilter) == std::string::npos))
+                {
+                    continue;
+                }
+                cl_int err = CL_SUCCESS;
+                cl_context context = clCreateContext(nullptr, 1, &device, nullptr, nullptr, &err);
+                if(err != CL_SUCCESS)
+                {
+                    continue;
+                }
+                state->available = true;
+                state->device = device;
+                state->context = context;
+                state->name = name;
+                return state;
+            }
+        }
+        return state;
+    }
+
+    /** The device is found when first used and kept for the life of the process. */
+    static RSGISOpenCLDeviceState* getOpenCLDeviceState()
+    {
+        static RSGISOpenCLDeviceState *state = createOpenCLDeviceState();
+        return state;
+    }
+
+    static cl_program getOpenCLProgram(RSGISOpenCLDeviceState *device, const std::string &source)
+    {
+        std::lock_guard<std::mutex> lock(device->programsMutex);
+        std::map<std::string, cl_program>::iterator iterProg = device->programs.find(source);
+        if(iterProg != device->programs.end())
+        {
+            return iterProg->second;
+        }
+
+        const char *sourceStr = source.c_str();
+        const size_t sourceLen = source.size();
+        cl_int err = CL_SUCCESS;
+        cl_program program = clCreateProgramWithSource(device->context, 1, &sourceStr, &sourceLen, &err);
+        checkOpenCL(err, "clCreateProgramWithSource");
+        err = clBuildProgram(program, 1, &device->device, "", nullptr, nullptr);
+        if(err != CL_SUCCESS)
+        {
+            size_t logLen = 0;
+            std::string buildLog = "";
+            if((clGetProgramBuildInfo(program, device->device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &logLen) == CL_SUCCESS) && (logLen > 0))
+            {
+                std::vector<char> log(logLen);
+                if(clGetProgramBuildInfo(program, device->device, CL_PROGRAM_BUILD_LOG, logLen, log.data(), nullptr) == CL_SUCCESS)
+                {
+                    buildLog = std::string(log.data());
+                }
+            }
+            clReleaseProgram(program);
+            throw RSGISException("The OpenCL program did not compile (error " + std::to_string(err) + "): " + buildLog);
+        }
+        device->programs[source] = program;
+        return program;
+    }
+
+    /** A pinned host buffer, which stays mapped, and the device buffer it is transferred to or from. */
+    struct RSGISOpenCLStagingBuffer
+    {
+        cl_mem pinned;
+        void *hostPtr;
+        cl_mem device;
+        size_t bytes;
+    };
+
+    struct RSGISOpenCLKernelState
+    {
+        RSGISOpenCLDeviceState *device;
+        cl_kernel kernel;
+        cl_command_queue queues[2];
+        RSGISOpenCLStagingBuffer inBufs[2];
+        RSGISOpenCLStagingBuffer outBufs[2];
+        std::vector<cl_mem> constBuffers;
+        std::mutex runMutex;
+    };
+
+    static void releaseOpenCLStagingBuffer(cl_command_queue queue, RSGISOpenCLStagingBuffer *buf)
+    {
+        if(buf->pinned != nullptr)
+        {
+            if(buf->hostPtr != nullptr)
+            {
+                clEnqueueUnmapMemObject(queue, buf->pinned, buf->hostPtr, 0, nullptr, nullptr);
+                clFinish(queue);
+            }
+            clReleaseMemObject(buf->pinned);
+        }
+        if(buf->device != nullptr)
+        {
+            clReleaseMemObject(buf->device);
+        }
+        buf->pinned = nullptr;
+        buf->hostPtr = nullptr;
+        buf->device = nullptr;
+        buf->bytes = 0;
+    }
+
+    static void reserveOpenCLStagingBuffer(cl_context context, cl_command_queue queue, RSGISOpenCLStagingBuffer *buf, size_t bytes, cl_mem_flags deviceFlags)
+    {
+        if(buf->bytes >= bytes)
+        {
+            return;
+        }
+        releaseOpenCLStagingBuffer(queue, buf);
+        cl_int err = CL_SUCCESS;
+        buf->pinned = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, bytes, nullptr, &err);
+        checkOpenCL(err, "clCreateBuffer");
+        buf->hostPtr = clEnqueueMapBuffer(queue, buf->pinned, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, bytes, 0, nullptr, nullptr, &err);
+        checkOpenCL(err, "clEnqueueMapBuffer");
+        buf->device = clCreateBuffer(context, deviceFlags, bytes, nullptr, &err);
+        checkOpenCL(err, "clCreateBuffer");
+        buf->bytes = bytes;
+    }
+
+    static void releaseOpenCLKernelState(RSGISOpenCLKernelState *state)
+    {
+        for(int s = 0; s < 2; ++s)
+        {
+            if(state->queues[s] != nullptr)
+            {
+                clFinish(state->queues[s]);
+                releaseOpenCLStagingBuffer(state->queues[s], &state->inBufs[s]);
+                releaseOpenCLStagingBuffer(state->queues[s], &state->outBufs[s]);
+                clReleaseCommandQueue(state->queues[s]);
+            }
+        }
+        for(cl_mem buf : state->constBuffers)
+        {
+            clReleaseMemObject(buf);
+        }
+        if(state->kernel != nullptr)
+        {
+            clReleaseKernel(state->kernel);
+        }
+        delete state;
+    }
+#else
+    struct RSGISOpenCLKernelState
+    {
+    };
+#endif
+
+    bool RSGISOpenCLDevice::isAvailable()
+    {
+#ifdef RSGISLIB_WITH_OPENCL
+        return getOpenCLDeviceState()->available;
+#else
+        return false;
+#endif
+    }
+
+    std::string RSGISOpenCLDevice::getDeviceName()
+    {
+#ifdef RSGISLIB_WITH_OPENCL
+        return getOpenCLDeviceState()->name;
+#else
+        return "";
+#endif
+    }
+
+    bool RSGISOpenCLDevice::useDevice()
+    {
+        return RSGISExecutionContextUtils::getDefaultContext().useGPU && RSGISOpenCLDevice::isAvailable();
+    }
+
+    RSGISOpenCLKernel::RSGISOpenCLKernel(std::string source, std::string kernelName)
+    {
+        this->state = nullptr;
+#ifdef RSGISLIB_WITH_OPENCL
+        RSGISOpenCLDeviceState *device = getOpenCLDeviceState();
+        if(!device->available)
+        {
+            throw RSGISException("There is no OpenCL device with double precision.");
+        }
+        RSGISOpenCLKernelState *kernelState = new RSGISOpenCLKernelState();
+        kernelState->device = device;
+        kernelState->kernel = nullptr;
+        for(int s = 0; s < 2; ++s)
+        {
+            kernelState->queues[s] = nullptr;
+            kernelState->inBufs[s] = RSGISOpenCLStagingBuffer{nullptr, nullptr, nullptr, 0};
+            kernelState->outBufs[s] = RSGISOpenCLStagingBuffer{nullptr, nullptr, nullptr, 0};
+        }
+        try
+        {
+            cl_program program = getOpenCLProgram(device, source);
+            cl_int err = CL_SUCCESS;
+            kernelState->kernel = clCreateKernel(program, kernelName.c_str(), &err);
+            checkOpenCL(err, "clCreateKernel");
+            for(int s = 0; s < 2; ++s)
+            {
+                kernelState->queues[s] = clCreateCommandQueue(device->context, device->device, 0, &err);
+                checkOpenCL(err, "clCreateCommandQueue");
+            }
+        }
+        catch(RSGISException &e)
+        {
+            releaseOpenCLKernelState(kernelState);
+            throw e;
+        }
+        this->state = kernelState;
+#else
+        throw RSGISException("RSGISLib was not built with OpenCL (see the RSGIS_OPENCL CMake option).");
+#endif
+    }
+
+    void RSGISOpenCLKernel::setArg(unsigned int idx, const void *val, size_t bytes)
+    {
+#ifdef RSGISLIB_WITH_OPENCL
+        std::lock_guard<std::mutex> lock(this->state->runMutex);
+        checkOpenCL(clSetKernelArg(this->state->kernel, idx, bytes, val), "clSetKernelArg");
+#endif
+    }
+
+    void RSGISOpenCLKernel::setConstBuffer(unsigned int idx, const void *vals, size_t bytes)
+    {
+#ifdef RSGISLIB_WITH_OPENCL
+        std::lock_guard<std::mutex> lock(this->state->runMutex);
+        cl_int err = CL_SUCCESS;
+        // OpenCL does not allow empty buffers.
+        std::vector<char> placeholder(1, 0);
+        if(bytes == 0)
+        {
+            vals = placeholder.data();
+            bytes = 1;
+        }
+        cl_mem buf = clCreateBuffer(this->state->device->context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, bytes, const_cast<void*>(vals), &err);
+        checkOpenCL(err, "clCreateBuffer");
+        this->state->constBuffers.push_back(buf);
+        checkOpenCL(clSetKernelArg(this->state->kernel, idx, sizeof(cl_mem), &buf), "clSetKernelArg");
+#endif
+    }
+
+    void RSGISOpenCLKernel::run(const float* const* bands, unsigned int numBands, size_t nPxls, void *out, size_t outBytesPerPxl)
+    {
+#ifdef RSGISLIB_WITH_OPENCL
+        if((nPxls == 0) || (numBands == 0))
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(this->state->runMutex);
+        RSGISOpenCLKernelState *kernelState = this->state;
+
+        // At least two chunks, so the transfers overlap the kernels.
+        const size_t chunkPxls = std::max<size_t>(1, std::min(rsgisOpenCLMaxChunkPxls, (nPxls + 1) / 2));
+        for(int s = 0; s < 2; ++s)
+        {
+            reserveOpenCLStagingBuffer(kernelState->device->context, kernelState->queues[s], &kernelState->inBufs[s], chunkPxls * numBands * sizeof(float), CL_MEM_READ_ONLY);
+            reserveOpenCLStagingBuffer(kernelState->device->context, kernelState->queues[s], &kernelState->outBufs[s], chunkPxls * outBytesPerPxl, CL_MEM_WRITE_ONLY);
+        }
+
+        size_t pendingStart[2] = {0, 0};
+        size_t pendingLen[2] = {0, 0};
+        unsigned char *outBytes = static_cast<unsigned char*>(out);
+        try
+        {
+            size_t chunk = 0;
+            for(size_t start = 0; start < nPxls; start += chunkPxls, ++chunk)
+            {
+                const int s = chunk % 2;
+                cl_command_queue queue = kernelState->queues[s];
+                if(pendingLen[s] > 0)
+                {
+                    // The staging buffers of this queue are reused once its previous chunk has been read back.
+                    checkOpenCL(clFinish(queue), "clFinish");
+                    std::memcpy(outBytes + (pendingStart[s] * outBytesPerPxl), kernelState->outBufs[s].hostPtr, pendingLen[s] * outBytesPerPxl);
+                    pendingLen[s] = 0;
+                }
+
+                const size_t len = std::min(chunkPxls, nPxls - start);
+                float *inVals = static_cast<float*>(kernelState->inBufs[s].hostPtr);
+                for(unsigned int b = 0; b < numBands; ++b)
+                {
+                    std::memcpy(inVals + (((size_t)b) * len), bands[b] + start, len * sizeof(float));
+                }
+                checkOpenCL(clEnqueueWriteBuffer(queue, kernelState->inBufs[s].device, CL_FALSE, 0, len * numBands * sizeof(float), inVals, 0, nullptr, nullptr), "clEnqueueWriteBuffer");
+
+                // The arguments are captured when the kernel is enqueued, so they can be changed for the next chunk.
+                cl_uint chunkLen = static_cast<cl_uint>(len);
+                checkOpenCL(clSetKernelArg(kernelState->kernel, 0, sizeof(cl_mem), &kernelState->inBufs[s].device), "clSetKernelArg");
+                checkOpenCL(clSetKernelArg(kernelState->kernel, 1, sizeof(cl_uint), &chunkLen), "clSetKernelArg");
+                checkOpenCL(clSetKernelArg(kernelState->kernel, 2, sizeof(cl_mem), &kernelState->outBufs[s].device), "clSetKernelArg");
+                const size_t globalSize = ((len + rsgisOpenCLWorkGroupMultiple - 1) / rsgisOpenCLWorkGroupMultiple) * rsgisOpenCLWorkGroupMultiple;
+                checkOpenCL(clEnqueueNDRangeKernel(queue, kernelState->kernel, 1, nullptr, &globalSize, nullptr, 0, nullptr, nullptr), "clEnqueueNDRangeKernel");
+
+                checkOpenCL(clEnqueueReadBuffer(queue, kernelState->outBufs[s].device, CL_FALSE, 0, len * outBytesPerPxl, kernelState->outBufs[s].hostPtr, 0, nullptr, nullptr), "clEnqueueReadBuffer");
+                checkOpenCL(clFlush(queue), "clFlush");
+                pendingStart[s] = start;
+                pendingLen[s] = len;
+            }
+            for(int s = 0; s < 2; ++s)
+            {
+                if(pendingLen[s] > 0)
+                {
+                    checkOpenCL(clFinish(kernelState->queues[s]), "clFinish");
+                    std::memcpy(outBytes + (pendingStart[s] * outBytesPerPxl), kernelState->outBufs[s].hostPtr, pendingLen[s] * outBytesPerPxl);
+                    pendingLen[s] = 0;
+                }
+            }
+        }
+        catch(RSGISException &e)
+        {
+            // Wait for the queued transfers before the buffers can be reused or released.
+            for(int s = 0; s < 2; ++s)
+            {
+                clFinish(kernelState->queues[s]);
+            }
+            throw e;
+        }
+#endif
+    }
+
+    RSGISOpenCLKernel::~RSGISOpenCLKernel()
+    {
+#ifdef RSGISLIB_WITH_OPENCL
+        if(this->state != nullptr)
+        {
+            releaseOpenCLKernelState(this->state);
+        }
+#endif
+    }
+}
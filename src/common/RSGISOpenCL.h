@@ -0,0 +1,99 @@
+/*
+ *  RSGISOpenCL.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISOpenCL_H
+#define RSGISOpenCL_H
+
+#include <iostream>
+#include <string>
+#include <cstddef>
+
+#include "common/RSGISException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_commons_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis
+{
+    /// The OpenCL objects of a kernel (only defined where the library is built with OpenCL).
+    struct RSGISOpenCLKernelState;
+
+    /**
+     * The optional OpenCL backend of the block kernels (see rsgis::img::RSGISCalcImageValue::calcImageBlock),
+     * built where the RSGIS_OPENCL CMake option is on. The device is the first GPU (or accelerator) with
+     * double precision (cl_khr_fp64), which can be limited to the devices whose name contains the
+     * environment variable RSGISLIB_OPENCL_DEVICE. The kernels are only offloaded where the useGPU of
+     * the default execution context is true, so by default the CPU is used.
+     */
+    class DllExport RSGISOpenCLDevice
+    {
+    public:
+        /** True if the library was built with OpenCL and a device was found. */
+        static bool isAvailable();
+        /** The name of the device (an empty string if there is no device). */
+        static std::string getDeviceName();
+        /** True if the kernels are to be offloaded, i.e., the device is available and the useGPU of the default execution context is true. */
+        static bool useDevice();
+    };
+
+    /**
+     * An OpenCL kernel which is run over the pixels of a block in chunks. The chunks
+     * alternate between two command queues, each with pinned (page-locked) staging
+     * buffers, so the transfers of one chunk to and from the device overlap the kernel
+     * of the other and the copying of the next chunk into its staging buffer. The first
+     * three arguments of the kernel are (__global const float *in, const uint nPxls,
+     * __global <type> *out), where band b of pixel p of the chunk is in[(b*nPxls)+p] and
+     * the kernel is run for at least nPxls work items; the other arguments are set with
+     * setArg and setConstBuffer. The programs are compiled once for each source and the
+     * runs are serialised, so a kernel can be shared by the clones of a calculation.
+     */
+    class DllExport RSGISOpenCLKernel
+    {
+    public:
+        /** Creates kernelName from the source, throwing an RSGISException if there is no device or the source does not compile. */
+        RSGISOpenCLKernel(std::string source, std::string kernelName);
+        RSGISOpenCLKernel(const RSGISOpenCLKernel &kernel) = delete;
+        RSGISOpenCLKernel& operator=(const RSGISOpenCLKernel &kernel) = delete;
+        /** Set the scalar argument idx (3 or more) of the kernel. */
+        void setArg(unsigned int idx, const void *val, size_t bytes);
+        /** Copy the values to a read only buffer on the device and set it as the argument idx (3 or more) of the kernel. */
+        void setConstBuffer(unsigned int idx, const void *vals, size_t bytes);
+        /** Run the kernel on the nPxls pixels of the numBands bands, where out has outBytesPerPxl bytes for each pixel. */
+        void run(const float* const* bands, unsigned int numBands, size_t nPxls, void *out, size_t outBytesPerPxl);
+        ~RSGISOpenCLKernel();
+    protected:
+        RSGISOpenCLKernelState *state;
+    };
+}
+
+#endif
@@ -0,0 +1,236 @@
+/*
+ *  RSGISProgress.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISProgress.h"
+
+#include <cstdlib>
+#include <algorithm>
+
+namespace rsgis
+{
+    static bool rsgisProgressEnabledFromEnv()
+    {
+        const char *envProgress = std::getenv("RSGISLIB_PROGRESS");
+        if(envProgress == nullptr)
+        {
+            return true;
+        }
+        std::string val = std::string(envProgress);
+        return !((val == "off") || (val == "OFF") || (val == "0") || (val == "false") || (val == "FALSE"));
+    }
+
+    static std::atomic<bool> rsgisProgressEnabled( rsgisProgressEnabledFromEnv() );
+    static std::atomic<bool> rsgisProgressShowBar( true );
+    static std::atomic<unsigned int> rsgisProgressIntervalMS( 200 );
+    static std::atomic<bool> rsgisProgressHasCallback( false );
+    static std::mutex rsgisProgressCallbackMutex;
+    static std::shared_ptr<RSGISProgressCallback> rsgisProgressCallback;
+
+    RSGISProgress::RSGISProgress(): numDone(0), numTotal(0)
+    {
+        this->started = false;
+        this->rendered = false;
+        this->label = "";
+        this->reporterRunning = false;
+        this->stopRequested = false;
+        this->lastCallback = std::chrono::steady_clock::now();
+    }
+
+    void RSGISProgress::start(unsigned long long total)
+    {
+        this->stopReporter();
+        this->numDone.store(0, std::memory_order_relaxed);
+        this->numTotal.store(total, std::memory_order_relaxed);
+        this->started = true;
+        this->rendered = false;
+        this->lastCallback = std::chrono::steady_clock::now();
+        if(RSGISProgress::isEnabled() && RSGISProgress::getShowBar() && this->renders())
+        {
+            this->startReporter();
+        }
+    }
+
+    void RSGISProgress::update(unsigned long long done, unsigned long long total)
+    {
+        if(!this->started)
+        {
+            this->start(total);
+        }
+        this->numTotal.store(total, std::memory_order_relaxed);
+        this->numDone.store(done, std::memory_order_relaxed);
+        this->callCallback(false);
+    }
+
+    void RSGISProgress::poll()
+    {
+        this->callCallback(false);
+    }
+
+    void RSGISProgress::finish()
+    {
+        this->stopReporter();
+        unsigned long long total = this->numTotal.load(std::memory_order_relaxed);
+        this->numDone.store(total, std::memory_order_relaxed);
+        if(RSGISProgress::isEnabled() && RSGISProgress::getShowBar() && this->renders() && this->started && (total > 0))
+        {
+            std::lock_guard<std::mutex> lock(this->reporterMutex);
+            this->render(total, total, true);
+            this->rendered = true;
+        }
+        if(this->started)
+        {
+            this->callCallback(true);
+        }
+        this->started = false;
+    }
+
+    void RSGISProgress::setLabel(std::string label)
+    {
+        std::lock_guard<std::mutex> lock(this->reporterMutex);
+        this->label = label;
+    }
+
+    std::string RSGISProgress::getLabel()
+    {
+        std::lock_guard<std::mutex> lock(this->reporterMutex);
+        return this->label;
+    }
+
+    void RSGISProgress::startReporter()
+    {
+        if(this->reporterRunning)
+        {
+            return;
+        }
+        this->stopRequested = false;
+        this->reporterRunning = true;
+        this->reporter = std::thread(&RSGISProgress::reporterLoop, this);
+    }
+
+    void RSGISProgress::stopReporter()
+    {
+        if(!this->reporterRunning)
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(this->reporterMutex);
+            this->stopRequested = true;
+        }
+        this->reporterCond.notify_all();
+        this->reporter.join();
+        this->reporterRunning = false;
+    }
+
+    void RSGISProgress::reporterLoop()
+    {
+        std::unique_lock<std::mutex> lock(this->reporterMutex);
+        while(!this->stopRequested)
+        {
+            unsigned long long total = this->numTotal.load(std::memory_order_relaxed);
+            if(total > 0)
+            {
+                unsigned long long done = std::min(this->numDone.load(std::memory_order_relaxed), total);
+                this->render(done, total, false);
+                this->rendered = true;
+            }
+            this->reporterCond.wait_for(lock, std::chrono::milliseconds(RSGISProgress::getIntervalMS()), [this]{return this->stopRequested;});
+        }
+    }
+
+    void RSGISProgress::callCallback(bool force)
+    {
+        if(!rsgisProgressHasCallback.load(std::memory_order_relaxed) || !RSGISProgress::isEnabled())
+        {
+            return;
+        }
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if((!force) && ((now - this->lastCallback) < std::chrono::milliseconds(RSGISProgress::getIntervalMS())))
+        {
+            return;
+        }
+        this->lastCallback = now;
+
+        std::shared_ptr<RSGISProgressCallback> callback;
+        {
+            std::lock_guard<std::mutex> lock(rsgisProgressCallbackMutex);
+            callback = rsgisProgressCallback;
+        }
+        if(callback)
+        {
+            unsigned long long total = this->numTotal.load(std::memory_order_relaxed);
+            unsigned long long done = std::min(this->numDone.load(std::memory_order_relaxed), total);
+            (*callback)(this->getLabel(), done, total);
+        }
+    }
+
+    RSGISProgress::~RSGISProgress()
+    {
+        this->stopReporter();
+    }
+
+    void RSGISProgress::setEnabled(bool enabled)
+    {
+        rsgisProgressEnabled.store(enabled);
+    }
+
+    bool RSGISProgress::isEnabled()
+    {
+        return rsgisProgressEnabled.load(std::memory_order_relaxed);
+    }
+
+    void RSGISProgress::setShowBar(bool showBar)
+    {
+        rsgisProgressShowBar.store(showBar);
+    }
+
+    bool RSGISProgress::getShowBar()
+    {
+        return rsgisProgressShowBar.load(std::memory_order_relaxed);
+    }
+
+    void RSGISProgress::setCallback(RSGISProgressCallback callback)
+    {
+        std::lock_guard<std::mutex> lock(rsgisProgressCallbackMutex);
+        if(callback)
+        {
+            rsgisProgressCallback = std::make_shared<RSGISProgressCallback>(callback);
+            rsgisProgressHasCallback.store(true);
+        }
+        else
+        {
+            rsgisProgressCallback.reset();
+            rsgisProgressHasCallback.store(false);
+        }
+    }
+
+    void RSGISProgress::setIntervalMS(unsigned int intervalMS)
+    {
+        rsgisProgressIntervalMS.store(std::max<unsigned int>(intervalMS, 1));
+    }
+
+    unsigned int RSGISProgress::getIntervalMS()
+    {
+        return rsgisProgressIntervalMS.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,124 @@
+/*
+ *  RSGISProgress.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISProgress_H
+#define RSGISProgress_H
+
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_commons_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis
+{
+    /** A callback receiving the label, the number of completed items and the total number of items of a progress. */
+    typedef std::function<void(const std::string &label, unsigned long long done, unsigned long long total)> RSGISProgressCallback;
+
+    /**
+     * The progress of a parallel engine. Workers count their completed items with add,
+     * a relaxed atomic add which does not serialise the threads, and the owner (i.e.,
+     * the thread which calls start or update) can also set the count with update. The
+     * progress is rendered (see render) by a separate reporter thread at the reporting
+     * interval, so only one thread writes to the terminal, and the callback (see
+     * setCallback) is called at the same interval on the owner thread, from update,
+     * poll and finish, so a Python callback can take the GIL without blocking the
+     * workers. Progress can be disabled, with no reporter or callbacks, for batch runs
+     * with setEnabled or the environment variable RSGISLIB_PROGRESS=off.
+     */
+    class DllExport RSGISProgress
+    {
+    public:
+        RSGISProgress();
+        /** (Re)start the progress of total items, with none completed (called by the owner). */
+        void start(unsigned long long total);
+        /** Add n completed items; can be called from any thread. */
+        void add(unsigned long long n=1){this->numDone.fetch_add(n, std::memory_order_relaxed);};
+        /** Set the number of completed and total items (called by the owner), starting the progress if required. */
+        void update(unsigned long long done, unsigned long long total);
+        /** Call the callback if the reporting interval has passed (called by the owner, e.g., worker 0 of rsgis::RSGISThreadPool::parallelFor). */
+        void poll();
+        /** Complete the progress, stopping the reporter and rendering and reporting all the items as completed (called by the owner). */
+        void finish();
+        void setLabel(std::string label);
+        std::string getLabel();
+        unsigned long long getDone(){return this->numDone.load(std::memory_order_relaxed);};
+        unsigned long long getTotal(){return this->numTotal.load(std::memory_order_relaxed);};
+        virtual ~RSGISProgress();
+
+        /** Enable or disable (no rendering or callbacks) all progress reporting. */
+        static void setEnabled(bool enabled);
+        static bool isEnabled();
+        /** Whether the progress is rendered to the terminal (where the output is a terminal). */
+        static void setShowBar(bool showBar);
+        static bool getShowBar();
+        /** Set the callback, or remove it with an empty function. */
+        static void setCallback(RSGISProgressCallback callback);
+        /** The interval (milliseconds) between the updates of the terminal and the calls of the callback. */
+        static void setIntervalMS(unsigned int intervalMS);
+        static unsigned int getIntervalMS();
+    protected:
+        /** Render the progress; called from the reporter thread, or the owner once the reporter has stopped (final is then true). */
+        virtual void render(unsigned long long done, unsigned long long total, bool final){};
+        /** True if the progress is rendered, where the reporter thread is used. */
+        virtual bool renders(){return false;};
+        void startReporter();
+        void stopReporter();
+        void reporterLoop();
+        void callCallback(bool force);
+        std::atomic<unsigned long long> numDone;
+        std::atomic<unsigned long long> numTotal;
+        bool started;
+        bool rendered;
+        std::string label;
+        std::thread reporter;
+        bool reporterRunning;
+        bool stopRequested;
+        /// Guards the label and the rendering, and signals the reporter to stop.
+        std::mutex reporterMutex;
+        std::condition_variable reporterCond;
+        std::chrono::steady_clock::time_point lastCallback;
+    private:
+        RSGISProgress(const RSGISProgress&);
+        RSGISProgress& operator=(const RSGISProgress&);
+    };
+}
+
+#endif
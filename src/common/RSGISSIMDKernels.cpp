@@ -0,0 +1,485 @@
+/*
+ *  RSGISSIMDKernels.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISSIMDKernels.h"
+
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+// The kernels are compiled for AVX2 and AVX-512 with function target attributes
+// (GCC and Clang on x86), otherwise only for the baseline instruction set.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define RSGIS_SIMD_X86_DISPATCH 1
+    #define RSGIS_SIMD_INLINE inline __attribute__((always_inline))
+    #define RSGIS_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+    #if defined(__clang__)
+        #define RSGIS_SIMD_TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512bw,avx512dq,avx512vl"), min_vector_width(512)))
+    #else
+        #define RSGIS_SIMD_TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512bw,avx512dq,avx512vl,prefer-vector-width=512")))
+    #endif
+#else
+    #define RSGIS_SIMD_X86_DISPATCH 0
+    #define RSGIS_SIMD_INLINE inline
+#endif
+
+// The reductions use the GCC and Clang vector extensions for their partial sums,
+// with vectors of the width of the registers of each instruction set, as they are
+// not vectorised from plain loops without reassociating the sums.
+#if defined(__GNUC__) || defined(__clang__)
+    #define RSGIS_SIMD_VECTOR_EXT 1
+#else
+    #define RSGIS_SIMD_VECTOR_EXT 0
+#endif
+
+// The kernels are compiled without floating point contraction (i.e., into FMA)
+// so the results are the same for each instruction set.
+#if defined(__clang__)
+    #pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+    #pragma GCC optimize ("fp-contract=off")
+#endif
+
+namespace rsgis
+{
+    // The number of partial sums of the reductions, which is the same for all the
+    // instruction sets so the order of the additions (and the result) is the same.
+    static const size_t rsgisSIMDSumLanes( 8 );
+    // The number of outputs of a row convolution which are accumulated together.
+    static const size_t rsgisSIMDConvolveChunk( 256 );
+
+#if RSGIS_SIMD_VECTOR_EXT
+    // The vectors of W doubles, W floats and W 64 bit masks.
+    template <size_t W> struct RSGISSIMDVec;
+    template <> struct RSGISSIMDVec<2>
+    {
+        typedef double Doubles __attribute__((vector_size(2 * sizeof(double))));
+        typedef float Floats __attribute__((vector_size(2 * sizeof(float))));
+        typedef uint64_t Bits __attribute__((vector_size(2 * sizeof(uint64_t))));
+    };
+    template <> struct RSGISSIMDVec<4>
+    {
+        typedef double Doubles __attribute__((vector_size(4 * sizeof(double))));
+        typedef float Floats __attribute__((vector_size(4 * sizeof(float))));
+        typedef uint64_t Bits __attribute__((vector_size(4 * sizeof(uint64_t))));
+    };
+    template <> struct RSGISSIMDVec<8>
+    {
+        typedef double Doubles __attribute__((vector_size(8 * sizeof(double))));
+        typedef float Floats __attribute__((vector_size(8 * sizeof(float))));
+        typedef uint64_t Bits __attribute__((vector_size(8 * sizeof(uint64_t))));
+    };
+#endif
+
+    // The kernels, which are inlined into the wrapper of each instruction set.
+
+    static RSGIS_SIMD_INLINE void addSquaresKernel(const float *x, double *y, size_t n)
+    {
+        for(size_t i = 0; i < n; ++i)
+        {
+            const double v = x[i];
+            y[i] += v * v;
+        }
+    }
+
+    template <typename T> static RSGIS_SIMD_INLINE void addScaledKernel(double a, const T *x, double *y, size_t n)
+    {
+        for(size_t i = 0; i < n; ++i)
+        {
+            y[i] += a * static_cast<double>(x[i]);
+        }
+    }
+
+    static RSGIS_SIMD_INLINE void affineKernel(const double *x, size_t n, double inOffset, double inScale, double outScale, double outOffset, double inMin, double inMax, double outLow, double outHigh, double *out)
+    {
+        for(size_t i = 0; i < n; ++i)
+        {
+            const double v = x[i];
+            double t = (((v - inOffset) / inScale) * outScale) + outOffset;
+            t = (v < inMin)?outLow:t;
+            t = (v > inMax)?outHigh:t;
+            out[i] = t;
+        }
+    }
+
+    template <typename T> static RSGIS_SIMD_INLINE void replaceWhereEqualKernel(const T *mask, T maskVal, T outVal, T *vals, size_t n)
+    {
+        for(size_t i = 0; i < n; ++i)
+        {
+            vals[i] = (mask[i] == maskVal)?outVal:vals[i];
+        }
+    }
+
+    // Combine the partial sums in a fixed order.
+    static RSGIS_SIMD_INLINE double combineSums(const double *s)
+    {
+        return ((s[0] + s[1]) + (s[2] + s[3])) + ((s[4] + s[5]) + (s[6] + s[7]));
+    }
+
+#if RSGIS_SIMD_VECTOR_EXT
+    // Load W floats from VALS + IDX into the vector of doubles OUT.
+    #define RSGIS_SIMD_LOAD_DOUBLES(VALS, IDX, OUT) \
+        { \
+            typename RSGISSIMDVec<W>::Floats fVals; \
+            std::memcpy(&fVals, (VALS) + (IDX), sizeof(fVals)); \
+            OUT = __builtin_convertvector(fVals, typename RSGISSIMDVec<W>::Doubles); \
+        }
+#endif
+
+    // The reductions, with W (the vector width of the instruction set) lanes of the
+    // rsgisSIMDSumLanes partial sums per vector.
+    template <size_t W> static RSGIS_SIMD_INLINE void sumAndSquaresKernel(const float *x, size_t n, double *sum, double *sumSq)
+    {
+        double sums[rsgisSIMDSumLanes] = {0};
+        double sqSums[rsgisSIMDSumLanes] = {0};
+        const size_t nFull = n - (n % rsgisSIMDSumLanes);
+#if RSGIS_SIMD_VECTOR_EXT
+        typedef typename RSGISSIMDVec<W>::Doubles Doubles;
+        const size_t nVecs = rsgisSIMDSumLanes / W;
+        Doubles sumsVec[nVecs];
+        Doubles sqSumsVec[nVecs];
+        for(size_t k = 0; k < nVecs; ++k)
+        {
+            sumsVec[k] = Doubles{};
+            sqSumsVec[k] = Doubles{};
+        }
+        for(size_t i = 0; i < nFull; i += rsgisSIMDSumLanes)
+        {
+            for(size_t k = 0; k < nVecs; ++k)
+            {
+                Doubles v;
+                RSGIS_SIMD_LOAD_DOUBLES(x, i + (k * W), v)
+                sumsVec[k] += v;
+                sqSumsVec[k] += v * v;
+            }
+        }
+        std::memcpy(sums, sumsVec, sizeof(sums));
+        std::memcpy(sqSums, sqSumsVec, sizeof(sqSums));
+#else
+        for(size_t i = 0; i < nFull; i += rsgisSIMDSumLanes)
+        {
+            for(size_t j = 0; j < rsgisSIMDSumLanes; ++j)
+            {
+                const double v = x[i+j];
+                sums[j] += v;
+                sqSums[j] += v * v;
+            }
+        }
+#endif
+        for(size_t i = nFull; i < n; ++i)
+        {
+            const double v = x[i];
+            sums[i-nFull] += v;
+            sqSums[i-nFull] += v * v;
+        }
+        *sum = combineSums(sums);
+        *sumSq = combineSums(sqSums);
+    }
+
+    template <size_t W> static RSGIS_SIMD_INLINE double dotProductKernel(const float *a, const float *b, size_t n)
+    {
+        double sums[rsgisSIMDSumLanes] = {0};
+        const size_t nFull = n - (n % rsgisSIMDSumLanes);
+#if RSGIS_SIMD_VECTOR_EXT
+        typedef typename RSGISSIMDVec<W>::Doubles Doubles;
+        const size_t nVecs = rsgisSIMDSumLanes / W;
+        Doubles sumsVec[nVecs];
+        for(size_t k = 0; k < nVecs; ++k)
+        {
+            sumsVec[k] = Doubles{};
+        }
+        for(size_t i = 0; i < nFull; i += rsgisSIMDSumLanes)
+        {
+            for(size_t k = 0; k < nVecs; ++k)
+            {
+                Doubles aVec, bVec;
+                RSGIS_SIMD_LOAD_DOUBLES(a, i + (k * W), aVec)
+                RSGIS_SIMD_LOAD_DOUBLES(b, i + (k * W), bVec)
+                sumsVec[k] += aVec * bVec;
+            }
+        }
+        std::memcpy(sums, sumsVec, sizeof(sums));
+#else
+        for(size_t i = 0; i < nFull; i += rsgisSIMDSumLanes)
+        {
+            for(size_t j = 0; j < rsgisSIMDSumLanes; ++j)
+            {
+                sums[j] += static_cast<double>(a[i+j]) * static_cast<double>(b[i+j]);
+            }
+        }
+#endif
+        for(size_t i = nFull; i < n; ++i)
+        {
+            sums[i-nFull] += static_cast<double>(a[i]) * static_cast<double>(b[i]);
+        }
+        return combineSums(sums);
+    }
+
+    template <size_t W> static RSGIS_SIMD_INLINE void pairSumsKernel(const float *a, const float *b, size_t n, double *sums)
+    {
+        double laneSums[8][rsgisSIMDSumLanes] = {{0}};
+        const size_t nFull = n - (n % rsgisSIMDSumLanes);
+#if RSGIS_SIMD_VECTOR_EXT
+        typedef typename RSGISSIMDVec<W>::Doubles Doubles;
+        typedef typename RSGISSIMDVec<W>::Bits Bits;
+        const size_t nVecs = rsgisSIMDSumLanes / W;
+        const uint64_t absMask = ~(static_cast<uint64_t>(1) << 63);
+        Doubles sumsVec[8][nVecs];
+        for(size_t s = 0; s < 8; ++s)
+        {
+            for(size_t k = 0; k < nVecs; ++k)
+            {
+                sumsVec[s][k] = Doubles{};
+            }
+        }
+        for(size_t i = 0; i < nFull; i += rsgisSIMDSumLanes)
+        {
+            for(size_t k = 0; k < nVecs; ++k)
+            {
+                Doubles aVec, bVec;
+                RSGIS_SIMD_LOAD_DOUBLES(a, i + (k * W), aVec)
+                RSGIS_SIMD_LOAD_DOUBLES(b, i + (k * W), bVec)
+                const Doubles diffVec = aVec - bVec;
+                // The absolute difference clears the sign bit, as std::fabs.
+                const Doubles absDiffVec = (Doubles)(((Bits)diffVec) & absMask);
+                sumsVec[0][k] += diffVec;
+                sumsVec[1][k] += diffVec * diffVec;
+                sumsVec[2][k] += absDiffVec;
+                sumsVec[3][k] += aVec;
+                sumsVec[4][k] += bVec;
+                sumsVec[5][k] += aVec * aVec;
+                sumsVec[6][k] += bVec * bVec;
+                sumsVec[7][k] += aVec * bVec;
+            }
+        }
+        std::memcpy(laneSums, sumsVec, sizeof(laneSums));
+#else
+        for(size_t i = 0; i < nFull; i += rsgisSIMDSumLanes)
+        {
+            for(size_t j = 0; j < rsgisSIMDSumLanes; ++j)
+            {
+                const double aVal = a[i+j];
+                const double bVal = b[i+j];
+                const double diff = aVal - bVal;
+                laneSums[0][j] += diff;
+                laneSums[1][j] += diff * diff;
+                laneSums[2][j] += std::fabs(diff);
+                laneSums[3][j] += aVal;
+                laneSums[4][j] += bVal;
+                laneSums[5][j] += aVal * aVal;
+                laneSums[6][j] += bVal * bVal;
+                laneSums[7][j] += aVal * bVal;
+            }
+        }
+#endif
+        for(size_t i = nFull; i < n; ++i)
+        {
+            const size_t j = i - nFull;
+            const double aVal = a[i];
+            const double bVal = b[i];
+            const double diff = aVal - bVal;
+            laneSums[0][j] += diff;
+            laneSums[1][j] += diff * diff;
+            laneSums[2][j] += std::fabs(diff);
+            laneSums[3][j] += aVal;
+            laneSums[4][j] += bVal;
+            laneSums[5][j] += aVal * aVal;
+            laneSums[6][j] += bVal * bVal;
+            laneSums[7][j] += aVal * bVal;
+        }
+        for(size_t s = 0; s < 8; ++s)
+        {
+            sums[s] = combineSums(laneSums[s]);
+        }
+    }
+
+    static RSGIS_SIMD_INLINE void convolveRowKernel(const float *x, const double *kernel, int kSize, double *out, size_t n)
+    {
+        // The kernel is applied to a chunk of outputs at a time so the sums stay in
+        // the cache; each sum has the same order of additions as a loop over the kernel.
+        for(size_t start = 0; start < n; start += rsgisSIMDConvolveChunk)
+        {
+            const size_t len = std::min(rsgisSIMDConvolveChunk, n - start);
+            const float *xVals = x + start;
+            double *outVals = out + start;
+            std::fill(outVals, outVals + len, 0.0);
+            for(int k = 0; k < kSize; ++k)
+            {
+                const double kVal = kernel[k];
+                const float *kVals = xVals + k;
+                for(size_t i = 0; i < len; ++i)
+                {
+                    outVals[i] += kVal * static_cast<double>(kVals[i]);
+                }
+            }
+        }
+    }
+
+    // The wrappers for each instruction set, where WIDTH is the number of doubles of its vectors.
+    #define RSGIS_SIMD_DEFINE_KERNELS(SUFFIX, TARGET, WIDTH) \
+        static TARGET void addSquares##SUFFIX(const float *x, double *y, size_t n){addSquaresKernel(x, y, n);} \
+        static TARGET void addScaled##SUFFIX(double a, const float *x, double *y, size_t n){addScaledKernel(a, x, y, n);} \
+        static TARGET void addScaled##SUFFIX(double a, const double *x, double *y, size_t n){addScaledKernel(a, x, y, n);} \
+        static TARGET void affine##SUFFIX(const double *x, size_t n, double inOffset, double inScale, double outScale, double outOffset, double inMin, double inMax, double outLow, double outHigh, double *out){affineKernel(x, n, inOffset, inScale, outScale, outOffset, inMin, inMax, outLow, outHigh, out);} \
+        template <typename T> static TARGET void replaceWhereEqual##SUFFIX(const T *mask, T maskVal, T outVal, T *vals, size_t n){replaceWhereEqualKernel(mask, maskVal, outVal, vals, n);} \
+        static TARGET void sumAndSquares##SUFFIX(const float *x, size_t n, double *sum, double *sumSq){sumAndSquaresKernel<WIDTH>(x, n, sum, sumSq);} \
+        static TARGET double dotProduct##SUFFIX(const float *a, const float *b, size_t n){return dotProductKernel<WIDTH>(a, b, n);} \
+        static TARGET void pairSums##SUFFIX(const float *a, const float *b, size_t n, double *sums){pairSumsKernel<WIDTH>(a, b, n, sums);} \
+        static TARGET void convolveRow##SUFFIX(const float *x, const double *kernel, int kSize, double *out, size_t n){convolveRowKernel(x, kernel, kSize, out, n);}
+
+    // The baseline vectors are 128 bit (e.g., SSE2 and NEON).
+    RSGIS_SIMD_DEFINE_KERNELS(Scalar, , 2)
+    #if RSGIS_SIMD_X86_DISPATCH
+    RSGIS_SIMD_DEFINE_KERNELS(AVX2, RSGIS_SIMD_TARGET_AVX2, 4)
+    RSGIS_SIMD_DEFINE_KERNELS(AVX512, RSGIS_SIMD_TARGET_AVX512, 8)
+    #endif
+
+    #if RSGIS_SIMD_X86_DISPATCH
+        #define RSGIS_SIMD_DISPATCH(KERNEL, ...) \
+            switch(RSGISSIMDKernels::level) \
+            { \
+                case rsgis_simd_avx512: \
+                    return KERNEL##AVX512(__VA_ARGS__); \
+                case rsgis_simd_avx2: \
+                    return KERNEL##AVX2(__VA_ARGS__); \
+                default: \
+                    return KERNEL##Scalar(__VA_ARGS__); \
+            }
+    #else
+        #define RSGIS_SIMD_DISPATCH(KERNEL, ...) return KERNEL##Scalar(__VA_ARGS__);
+    #endif
+
+    RSGISSIMDLevel RSGISSIMDKernels::level = RSGISSIMDKernels::selectLevel();
+
+    RSGISSIMDLevel RSGISSIMDKernels::getSupportedLevel()
+    {
+    #if RSGIS_SIMD_X86_DISPATCH
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl"))
+        {
+            return rsgis_simd_avx512;
+        }
+        if(__builtin_cpu_supports("avx2"))
+        {
+            return rsgis_simd_avx2;
+        }
+    #endif
+        return rsgis_simd_scalar;
+    }
+
+    RSGISSIMDLevel RSGISSIMDKernels::selectLevel()
+    {
+        RSGISSIMDLevel selLevel = getSupportedLevel();
+        if(const char *envLevel = std::getenv("RSGISLIB_SIMD"))
+        {
+            std::string envLevelStr = std::string(envLevel);
+            if(envLevelStr == "scalar")
+            {
+                selLevel = rsgis_simd_scalar;
+            }
+            else if((envLevelStr == "avx2") && (selLevel > rsgis_simd_avx2))
+            {
+                selLevel = rsgis_simd_avx2;
+            }
+        }
+        return selLevel;
+    }
+
+    RSGISSIMDLevel RSGISSIMDKernels::getLevel()
+    {
+        return RSGISSIMDKernels::level;
+    }
+
+    RSGISSIMDLevel RSGISSIMDKernels::setLevel(RSGISSIMDLevel simdLevel)
+    {
+        RSGISSIMDKernels::level = std::min(simdLevel, getSupportedLevel());
+        return RSGISSIMDKernels::level;
+    }
+
+    std::string RSGISSIMDKernels::getLevelName(RSGISSIMDLevel simdLevel)
+    {
+        switch(simdLevel)
+        {
+            case rsgis_simd_avx512:
+                return "avx512";
+            case rsgis_simd_avx2:
+                return "avx2";
+            default:
+                return "scalar";
+        }
+    }
+
+    void RSGISSIMDKernels::addSquares(const float *x, double *y, size_t n)
+    {
+        RSGIS_SIMD_DISPATCH(addSquares, x, y, n)
+    }
+
+    void RSGISSIMDKernels::addScaled(double a, const float *x, double *y, size_t n)
+    {
+        RSGIS_SIMD_DISPATCH(addScaled, a, x, y, n)
+    }
+
+    void RSGISSIMDKernels::addScaled(double a, const double *x, double *y, size_t n)
+    {
+        RSGIS_SIMD_DISPATCH(addScaled, a, x, y, n)
+    }
+
+    void RSGISSIMDKernels::affine(const double *x, size_t n, double inOffset, double inScale, double outScale, double outOffset, double inMin, double inMax, double outLow, double outHigh, double *out)
+    {
+        RSGIS_SIMD_DISPATCH(affine, x, n, inOffset, inScale, outScale, outOffset, inMin, inMax, outLow, outHigh, out)
+    }
+
+    template <typename T> void RSGISSIMDKernels::replaceWhereEqual(const T *mask, T maskVal, T outVal, T *vals, size_t n)
+    {
+        RSGIS_SIMD_DISPATCH(replaceWhereEqual, mask, maskVal, outVal, vals, n)
+    }
+
+    template DllExport void RSGISSIMDKernels::replaceWhereEqual<uint8_t>(const uint8_t *mask, uint8_t maskVal, uint8_t outVal, uint8_t *vals, size_t n);
+    template DllExport void RSGISSIMDKernels::replaceWhereEqual<uint16_t>(const uint16_t *mask, uint16_t maskVal, uint16_t outVal, uint16_t *vals, size_t n);
+    template DllExport void RSGISSIMDKernels::replaceWhereEqual<int16_t>(const int16_t *mask, int16_t maskVal, int16_t outVal, int16_t *vals, size_t n);
+    template DllExport void RSGISSIMDKernels::replaceWhereEqual<uint32_t>(const uint32_t *mask, uint32_t maskVal, uint32_t outVal, uint32_t *vals, size_t n);
+    template DllExport void RSGISSIMDKernels::replaceWhereEqual<int32_t>(const int32_t *mask, int32_t maskVal, int32_t outVal, int32_t *vals, size_t n);
+    template DllExport void RSGISSIMDKernels::replaceWhereEqual<float>(const float *mask, float maskVal, float outVal, float *vals, size_t n);
+    template DllExport void RSGISSIMDKernels::replaceWhereEqual<double>(const double *mask, double maskVal, double outVal, double *vals, size_t n);
+
+    void RSGISSIMDKernels::sumAndSquares(const float *x, size_t n, double *sum, double *sumSq)
+    {
+        RSGIS_SIMD_DISPATCH(sumAndSquares, x, n, sum, sumSq)
+    }
+
+    double RSGISSIMDKernels::dotProduct(const float *a, const float *b, size_t n)
+    {
+        RSGIS_SIMD_DISPATCH(dotProduct, a, b, n)
+    }
+
+    void RSGISSIMDKernels::pairSums(const float *a, const float *b, size_t n, double *sums)
+    {
+        RSGIS_SIMD_DISPATCH(pairSums, a, b, n, sums)
+    }
+
+    void RSGISSIMDKernels::convolveRow(const float *x, const double *kernel, int kSize, double *out, size_t n)
+    {
+        RSGIS_SIMD_DISPATCH(convolveRow, x, kernel, kSize, out, n)
+    }
+}
@@ -0,0 +1,112 @@
+/*
+ *  RSGISSIMDKernels.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#ifndef RSGISSIMDKernels_H
+#define RSGISSIMDKernels_H
+
+#include <iostream>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_commons_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis
+{
+    /** The instruction sets for which the kernels of RSGISSIMDKernels are compiled. */
+    enum RSGISSIMDLevel
+    {
+        rsgis_simd_scalar = 0, // The baseline of the build (e.g., SSE2 on x86-64 and NEON on ARM64).
+        rsgis_simd_avx2 = 1,
+        rsgis_simd_avx512 = 2 // AVX-512 F, BW, DQ and VL.
+    };
+
+    /**
+     * The inner loops of the hot image, filtering and classification kernels,
+     * compiled for each of the instruction sets of RSGISSIMDLevel; when first
+     * used the widest instruction set supported by the CPU is selected, so a
+     * single build uses AVX2 or AVX-512 on the nodes which have them. The
+     * environment variable RSGISLIB_SIMD (scalar, avx2 or avx512) limits the
+     * selection. The loops are written for the compiler to vectorise and are
+     * compiled without floating point contraction (FMA) and with sums kept in
+     * a fixed number of partial sums, so all the instruction sets give the
+     * same results.
+     */
+    class DllExport RSGISSIMDKernels
+    {
+    public:
+        /** The instruction set used by the kernels. */
+        static RSGISSIMDLevel getLevel();
+        /** Select the instruction set (e.g., to compare them), limited to those the CPU supports; returns the level used. Not to be called while kernels are running. */
+        static RSGISSIMDLevel setLevel(RSGISSIMDLevel simdLevel);
+        /** The widest instruction set supported by the CPU (and the build). */
+        static RSGISSIMDLevel getSupportedLevel();
+        static std::string getLevelName(RSGISSIMDLevel simdLevel);
+
+        /** Distance: y[i] += x[i]^2 (the squared length term of an expanded squared Euclidean distance). */
+        static void addSquares(const float *x, double *y, size_t n);
+        /** Distance and convolution: y[i] += a x[i]. */
+        static void addScaled(double a, const float *x, double *y, size_t n);
+        static void addScaled(double a, const double *x, double *y, size_t n);
+
+        /**
+         * Affine: out[i] = (((x[i] - inOffset) / inScale) * outScale) + outOffset for
+         * x[i] within [inMin, inMax], outLow below inMin and outHigh above inMax.
+         * x and out can be the same array.
+         */
+        static void affine(const double *x, size_t n, double inOffset, double inScale, double outScale, double outOffset, double inMin, double inMax, double outLow, double outHigh, double *out);
+
+        /** Compare and mask: vals[i] = outVal where mask[i] == maskVal. */
+        template <typename T> static void replaceWhereEqual(const T *mask, T maskVal, T outVal, T *vals, size_t n);
+
+        /** Reduction: the sum and sum of squares of x. */
+        static void sumAndSquares(const float *x, size_t n, double *sum, double *sumSq);
+        /** Reduction: the sum of a[i] b[i]. */
+        static double dotProduct(const float *a, const float *b, size_t n);
+        /**
+         * Reduction: the sums of a - b, (a - b)^2, |a - b|, a, b, a^2, b^2 and a b,
+         * in that order, written to sums (which must have space for 8 values).
+         */
+        static void pairSums(const float *a, const float *b, size_t n, double *sums);
+
+        /** Convolution: out[i] = sum over k of kernel[k] x[i+k], where x has n + kSize - 1 values. */
+        static void convolveRow(const float *x, const double *kernel, int kSize, double *out, size_t n);
+    protected:
+        static RSGISSIMDLevel selectLevel();
+        static RSGISSIMDLevel level;
+    };
+}
+
+#endif
@@ -0,0 +1,169 @@
+/*
+ *  RSGISStripIOPipeline.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#include "RSGISStripIOPipeline.h"
+
+namespace rsgis
+{
+    static unsigned int rsgisDefaultNumStripIOBuffers = 1;
+
+    RSGISStripIOPipeline::RSGISStripIOPipeline(unsigned int numBuffers)
+    {
+        this->numBuffers = numBuffers;
+        if(this->numBuffers == 0)
+        {
+            this->numBuffers = 1;
+        }
+        this->nRead = 0;
+        this->nComputed = 0;
+        this->nWritten = 0;
+        this->failed = false;
+        this->pipeException = nullptr;
+    }
+
+    void RSGISStripIOPipeline::run(size_t nStrips, std::function<void(size_t, unsigned int)> readStrip, std::function<void(size_t, unsigned int)> computeStrip, std::function<void(size_t, unsigned int)> writeStrip)
+    {
+        if(this->numBuffers < 2)
+        {
+            for(size_t s = 0; s < nStrips; ++s)
+            {
+                readStrip(s, 0);
+                computeStrip(s, 0);
+                writeStrip(s, 0);
+            }
+            return;
+        }
+
+        this->nRead = 0;
+        this->nComputed = 0;
+        this->nWritten = 0;
+        this->failed = false;
+        this->pipeException = nullptr;
+        size_t nBufs = this->numBuffers;
+
+        // The buffer for strip s is free once strip s-numBuffers has been written.
+        std::thread readerThread([&]()
+        {
+            try
+            {
+                for(size_t s = 0; s < nStrips; ++s)
+                {
+                    if(!this->waitFor(&this->nWritten, (s < nBufs)?0:(s-nBufs+1)))
+                    {
+                        return;
+                    }
+                    readStrip(s, s % nBufs);
+                    this->setCounter(&this->nRead, s+1);
+                }
+            }
+            catch(...)
+            {
+                this->setFailed(std::current_exception());
+            }
+        });
+
+        std::thread writerThread([&]()
+        {
+            try
+            {
+                for(size_t s = 0; s < nStrips; ++s)
+                {
+                    if(!this->waitFor(&this->nComputed, s+1))
+                    {
+                        return;
+                    }
+                    writeStrip(s, s % nBufs);
+                    this->setCounter(&this->nWritten, s+1);
+                }
+            }
+            catch(...)
+            {
+                this->setFailed(std::current_exception());
+            }
+        });
+
+        try
+        {
+            for(size_t s = 0; s < nStrips; ++s)
+            {
+                if(!this->waitFor(&this->nRead, s+1))
+                {
+                    break;
+                }
+                computeStrip(s, s % nBufs);
+                this->setCounter(&this->nComputed, s+1);
+            }
+        }
+        catch(...)
+        {
+            this->setFailed(std::current_exception());
+        }
+
+        readerThread.join();
+        writerThread.join();
+
+        if(this->pipeException)
+        {
+            std::rethrow_exception(this->pipeException);
+        }
+    }
+
+    bool RSGISStripIOPipeline::waitFor(size_t *counter, size_t target)
+    {
+        std::unique_lock<std::mutex> lock(this->pipeMutex);
+        this->pipeCond.wait(lock, [&]{return this->failed || ((*counter) >= target);});
+        return !this->failed;
+    }
+
+    void RSGISStripIOPipeline::setCounter(size_t *counter, size_t val)
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->pipeMutex);
+            *counter = val;
+        }
+        this->pipeCond.notify_all();
+    }
+
+    void RSGISStripIOPipeline::setFailed(std::exception_ptr e)
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->pipeMutex);
+            if(!this->failed)
+            {
+                this->failed = true;
+                this->pipeException = e;
+            }
+        }
+        this->pipeCond.notify_all();
+    }
+
+    void RSGISStripIOPipeline::setDefaultNumBuffers(unsigned int numBuffers)
+    {
+        rsgisDefaultNumStripIOBuffers = numBuffers;
+    }
+
+    unsigned int RSGISStripIOPipeline::getDefaultNumBuffers()
+    {
+        return rsgisDefaultNumStripIOBuffers;
+    }
+}
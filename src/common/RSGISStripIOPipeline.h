@@ -0,0 +1,93 @@
+/*
+ *  RSGISStripIOPipeline.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifndef RSGISStripIOPipeline_H
+#define RSGISStripIOPipeline_H
+
+#include <iostream>
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_commons_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis
+{
+    /**
+     * Pipeline for processing an image as a sequence of strips, where the strips
+     * are read on a reader thread and written on a writer thread so reading strip
+     * n+1 and writing strip n-1 overlap with computing strip n on the calling
+     * thread. The caller provides numBuffers sets of strip buffers and strip s
+     * always uses buffer (s % numBuffers), so at most numBuffers strips are held
+     * in memory. The read and write functions must not access the same GDAL
+     * datasets as each other (or as the compute function) as a GDALDataset can
+     * only be accessed from one thread at a time.
+     */
+    class DllExport RSGISStripIOPipeline
+    {
+    public:
+        /** With fewer than 2 buffers the strips are read, computed and written serially on the calling thread. */
+        RSGISStripIOPipeline(unsigned int numBuffers);
+        unsigned int getNumBuffers(){return this->numBuffers;};
+        /**
+         * Call readStrip(strip, buffer), computeStrip(strip, buffer) and then
+         * writeStrip(strip, buffer) for the strips [0, nStrips). The call blocks
+         * until all the strips have been written. If any of the functions throw an
+         * exception the pipeline stops and the first exception is re-thrown on the
+         * calling thread.
+         */
+        void run(size_t nStrips, std::function<void(size_t, unsigned int)> readStrip, std::function<void(size_t, unsigned int)> computeStrip, std::function<void(size_t, unsigned int)> writeStrip);
+        /** Set the number of buffers used when numBuffers is not specified (default 1; i.e., serial I/O). */
+        static void setDefaultNumBuffers(unsigned int numBuffers);
+        static unsigned int getDefaultNumBuffers();
+        ~RSGISStripIOPipeline(){};
+    protected:
+        bool waitFor(size_t *counter, size_t target);
+        void setCounter(size_t *counter, size_t val);
+        void setFailed(std::exception_ptr e);
+        unsigned int numBuffers;
+        std::mutex pipeMutex;
+        std::condition_variable pipeCond;
+        size_t nRead;
+        size_t nComputed;
+        size_t nWritten;
+        bool failed;
+        std::exception_ptr pipeException;
+    };
+}
+
+#endif
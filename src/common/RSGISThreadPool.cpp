@@ -0,0 +1,372 @@
+/*
+ *  RSGISThreadPool.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISThreadPool.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "common/RSGISExecutionContext.h"
+
+namespace rsgis
+{
+    static std::once_flag rsgisNUMANodesFlag;
+    static std::vector<std::vector<int> > rsgisNUMANodeCPUs;
+    
+    // Parse a Linux CPU list (e.g., "0-31,64-95").
+    static std::vector<int> rsgisParseCPUList(const std::string &cpuList)
+    {
+        std::vector<int> cpus;
+        std::stringstream listStream(cpuList);
+        std::string range;
+        while(std::getline(listStream, range, ','))
+        {
+            size_t dashPos = range.find('-');
+            try
+            {
+                int first = std::stoi(range.substr(0, dashPos));
+                int last = (dashPos == std::string::npos)?first:std::stoi(range.substr(dashPos+1));
+                for(int cpu = first; cpu <= last; ++cpu)
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+            catch(std::exception &e)
+            {
+                // Ignore anything which is not a CPU number or range (e.g., the new line).
+            }
+        }
+        return cpus;
+    }
+    
+    static bool rsgisReadLine(const std::string &filePath, std::string &line)
+    {
+        std::ifstream inFile(filePath.c_str());
+        return (inFile.is_open() && std::getline(inFile, line));
+    }
+    
+    RSGISThreadPool::RSGISThreadPool(unsigned int numThreads)
+    {
+        if(numThreads == 0)
+        {
+            numThreads = RSGISThreadPool::getNumHardwareThreads();
+        }
+        this->numThreads = numThreads;
+        this->taskStart = 0;
+        this->taskEnd = 0;
+        this->generation = 0;
+        this->nPending = 0;
+        this->shutdown = false;
+        this->taskException = nullptr;
+
+        if((this->numThreads > 1) && RSGISThreadPool::useNUMAPlacement())
+        {
+            this->nodeCPUs = RSGISThreadPool::getNUMANodeCPUs();
+            
+            // The calling thread is worker 0 so is pinned until the pool is destroyed.
+            this->callerThreadId = std::this_thread::get_id();
+#ifdef __linux__
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            if(sched_getaffinity(0, sizeof(cpu_set_t), &cpuSet) == 0)
+            {
+                for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                {
+                    if(CPU_ISSET(cpu, &cpuSet))
+                    {
+                        this->callerCPUs.push_back(cpu);
+                    }
+                }
+            }
+#endif
+            this->pinToNode(this->getWorkerNode(0));
+        }
+
+        // Worker 0 is the calling thread so only numThreads-1 threads are created.
+        for(unsigned int i = 1; i < this->numThreads; ++i)
+        {
+            this->workers.push_back(std::thread(&RSGISThreadPool::workerLoop, this, i));
+        }
+    }
+
+    void RSGISThreadPool::parallelFor(size_t start, size_t end, std::function<void(unsigned int, size_t, size_t)> func)
+    {
+        if(end <= start)
+        {
+            return;
+        }
+
+        if(this->workers.empty())
+        {
+            func(0, start, end);
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(this->poolMutex);
+            this->task = func;
+            this->taskStart = start;
+            this->taskEnd = end;
+            this->taskException = nullptr;
+            this->nPending = this->workers.size();
+            ++this->generation;
+        }
+        this->startCond.notify_all();
+
+        this->runChunk(0);
+
+        std::exception_ptr exp = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(this->poolMutex);
+            this->doneCond.wait(lock, [this]{return this->nPending == 0;});
+            exp = this->taskException;
+            this->taskException = nullptr;
+            this->task = nullptr;
+        }
+
+        if(exp)
+        {
+            std::rethrow_exception(exp);
+        }
+    }
+
+    void RSGISThreadPool::forEachWorker(std::function<void(unsigned int)> func)
+    {
+        // With one item per worker each chunk of parallelFor is the index of its worker.
+        this->parallelFor(0, this->numThreads, [&func](unsigned int workerIdx, size_t chunkStart, size_t chunkEnd)
+        {
+            func(workerIdx);
+        });
+    }
+
+    void RSGISThreadPool::firstTouch(void *data, size_t nItems, size_t itemBytes)
+    {
+        if(this->nodeCPUs.empty() || (data == nullptr))
+        {
+            return;
+        }
+        char *bytes = static_cast<char*>(data);
+        this->parallelFor(0, nItems, [bytes, itemBytes](unsigned int workerIdx, size_t chunkStart, size_t chunkEnd)
+        {
+            std::memset(bytes + (chunkStart * itemBytes), 0, (chunkEnd - chunkStart) * itemBytes);
+        });
+    }
+
+    unsigned int RSGISThreadPool::getWorkerNode(unsigned int workerIdx)
+    {
+        if(this->nodeCPUs.empty())
+        {
+            return 0;
+        }
+        // Contiguous groups of workers, so contiguous chunks, are placed on each node.
+        return (unsigned int)((((size_t)workerIdx) * this->nodeCPUs.size()) / this->numThreads);
+    }
+
+    void RSGISThreadPool::pinToNode(unsigned int node)
+    {
+#ifdef __linux__
+        if(node >= this->nodeCPUs.size())
+        {
+            return;
+        }
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        for(std::vector<int>::iterator iterCPUs = this->nodeCPUs[node].begin(); iterCPUs != this->nodeCPUs[node].end(); ++iterCPUs)
+        {
+            if((*iterCPUs) < CPU_SETSIZE)
+            {
+                CPU_SET((*iterCPUs), &cpuSet);
+            }
+        }
+        // If the thread cannot be pinned then it is left to the scheduler.
+        sched_setaffinity(0, sizeof(cpu_set_t), &cpuSet);
+#endif
+    }
+
+    void RSGISThreadPool::runChunk(unsigned int workerIdx)
+    {
+        size_t nItems = this->taskEnd - this->taskStart;
+        size_t chunkStart = this->taskStart + ((nItems * workerIdx) / this->numThreads);
+        size_t chunkEnd = this->taskStart + ((nItems * (workerIdx+1)) / this->numThreads);
+        if(chunkEnd <= chunkStart)
+        {
+            return;
+        }
+
+        try
+        {
+            this->task(workerIdx, chunkStart, chunkEnd);
+        }
+        catch(...)
+        {
+            std::unique_lock<std::mutex> lock(this->poolMutex);
+            if(!this->taskException)
+            {
+                this->taskException = std::current_exception();
+            }
+        }
+    }
+
+    void RSGISThreadPool::workerLoop(unsigned int workerIdx)
+    {
+        if(!this->nodeCPUs.empty())
+        {
+            this->pinToNode(this->getWorkerNode(workerIdx));
+        }
+        
+        unsigned long seenGeneration = 0;
+        while(true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(this->poolMutex);
+                this->startCond.wait(lock, [this, &seenGeneration]{return this->shutdown || (this->generation != seenGeneration);});
+                if(this->shutdown)
+                {
+                    return;
+                }
+                seenGeneration = this->generation;
+            }
+
+            this->runChunk(workerIdx);
+
+            {
+                std::unique_lock<std::mutex> lock(this->poolMutex);
+                --this->nPending;
+                if(this->nPending == 0)
+                {
+                    this->doneCond.notify_one();
+                }
+            }
+        }
+    }
+
+    unsigned int RSGISThreadPool::getNumHardwareThreads()
+    {
+        unsigned int nThreads = std::thread::hardware_concurrency();
+        if(nThreads == 0)
+        {
+            nThreads = 1;
+        }
+        return nThreads;
+    }
+
+    std::vector<std::vector<int> > RSGISThreadPool::getNUMANodeCPUs()
+    {
+        std::call_once(rsgisNUMANodesFlag, []()
+        {
+#ifdef __linux__
+            // Only the CPUs the process is allowed to use (e.g., within a batch job) are used.
+            std::vector<bool> allowedCPUs;
+            std::ifstream statusFile("/proc/self/status");
+            std::string line;
+            while(statusFile.is_open() && std::getline(statusFile, line))
+            {
+                if(line.compare(0, 18, "Cpus_allowed_list:") == 0)
+                {
+                    std::vector<int> cpus = rsgisParseCPUList(line.substr(18));
+                    for(std::vector<int>::iterator iterCPUs = cpus.begin(); iterCPUs != cpus.end(); ++iterCPUs)
+                    {
+                        if(((size_t)(*iterCPUs)) >= allowedCPUs.size())
+                        {
+                            allowedCPUs.resize((*iterCPUs)+1, false);
+                        }
+                        allowedCPUs[(*iterCPUs)] = true;
+                    }
+                    break;
+                }
+            }
+            
+            std::string nodeList;
+            if(rsgisReadLine("/sys/devices/system/node/online", nodeList))
+            {
+                std::vector<int> nodes = rsgisParseCPUList(nodeList);
+                for(std::vector<int>::iterator iterNodes = nodes.begin(); iterNodes != nodes.end(); ++iterNodes)
+                {
+                    std::string cpuList;
+                    if(!rsgisReadLine("/sys/devices/system/node/node" + std::to_string(*iterNodes) + "/cpulist", cpuList))
+                    {
+                        continue;
+                    }
+                    std::vector<int> cpus = rsgisParseCPUList(cpuList);
+                    std::vector<int> nodeCPUs;
+                    for(std::vector<int>::iterator iterCPUs = cpus.begin(); iterCPUs != cpus.end(); ++iterCPUs)
+                    {
+                        if(allowedCPUs.empty() || ((((size_t)(*iterCPUs)) < allowedCPUs.size()) && allowedCPUs[(*iterCPUs)]))
+                        {
+                            nodeCPUs.push_back(*iterCPUs);
+                        }
+                    }
+                    if(!nodeCPUs.empty())
+                    {
+                        rsgisNUMANodeCPUs.push_back(nodeCPUs);
+                    }
+                }
+            }
+#endif
+            if(rsgisNUMANodeCPUs.empty())
+            {
+                rsgisNUMANodeCPUs.push_back(std::vector<int>());
+            }
+        });
+        return rsgisNUMANodeCPUs;
+    }
+
+    bool RSGISThreadPool::useNUMAPlacement()
+    {
+        return RSGISExecutionContextUtils::getDefaultContext().numaPlacement && (RSGISThreadPool::getNUMANodeCPUs().size() > 1);
+    }
+
+    RSGISThreadPool::~RSGISThreadPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(this->poolMutex);
+            this->shutdown = true;
+        }
+        this->startCond.notify_all();
+        for(std::vector<std::thread>::iterator iterThreads = this->workers.begin(); iterThreads != this->workers.end(); ++iterThreads)
+        {
+            if((*iterThreads).joinable())
+            {
+                (*iterThreads).join();
+            }
+        }
+        
+#ifdef __linux__
+        // Restore the CPUs of the calling thread (if the pool is destroyed on the same thread).
+        if(!this->callerCPUs.empty() && (this->callerThreadId == std::this_thread::get_id()))
+        {
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            for(std::vector<int>::iterator iterCPUs = this->callerCPUs.begin(); iterCPUs != this->callerCPUs.end(); ++iterCPUs)
+            {
+                CPU_SET((*iterCPUs), &cpuSet);
+            }
+            sched_setaffinity(0, sizeof(cpu_set_t), &cpuSet);
+        }
+#endif
+    }
+}
@@ -0,0 +1,129 @@
+/*
+ *  RSGISThreadPool.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISThreadPool_H
+#define RSGISThreadPool_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_commons_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis
+{
+    /**
+     * A small fixed size pool of worker threads used by the parallel processing
+     * engines. The calling thread takes part in the processing (as worker 0) so
+     * a pool with one thread does not create any additional threads.
+     *
+     * Where the numaPlacement of the default execution context is true and the
+     * machine has more than one NUMA node, the workers are divided into contiguous
+     * groups, one per node, and each worker is pinned to the CPUs of its node (the
+     * calling thread while the pool exists). The chunks of parallelFor processed by
+     * the workers of a node are therefore adjacent, so each node works on its own
+     * part of a strip, and buffers first touched by a worker (see firstTouch and
+     * forEachWorker) are allocated in the memory of its node.
+     */
+    class DllExport RSGISThreadPool
+    {
+    public:
+        /** Create the pool. If numThreads is 0 the number of hardware threads is used. */
+        RSGISThreadPool(unsigned int numThreads);
+        unsigned int getNumThreads(){return this->numThreads;};
+        /**
+         * Split the range [start, end) into one contiguous chunk per worker and
+         * call func(workerIdx, chunkStart, chunkEnd) for each non-empty chunk.
+         * The call blocks until all the chunks have been processed. If a worker
+         * throws an exception the first one is re-thrown on the calling thread.
+         */
+        void parallelFor(size_t start, size_t end, std::function<void(unsigned int, size_t, size_t)> func);
+        /**
+         * Call func(workerIdx) once on each worker, e.g., to allocate the buffers
+         * of each worker on the NUMA node of the worker. The call blocks until all
+         * the workers have returned.
+         */
+        void forEachWorker(std::function<void(unsigned int)> func);
+        /**
+         * Where the workers are placed on NUMA nodes, zero the nItems items (of
+         * itemBytes bytes) of data, which has not been written since it was
+         * allocated, in the chunks of parallelFor(0, nItems, ...). Each page of
+         * the buffer is then allocated on the node of the worker which processes
+         * it. Otherwise data is not changed.
+         */
+        void firstTouch(void *data, size_t nItems, size_t itemBytes);
+        /** Get the NUMA node (0 to getNumNodes()-1) the worker is placed on (0 if the workers are not placed). */
+        unsigned int getWorkerNode(unsigned int workerIdx);
+        /** Get the number of NUMA nodes the workers are placed on (1 if the workers are not placed). */
+        unsigned int getNumNodes(){return this->nodeCPUs.empty()?1:this->nodeCPUs.size();};
+        /** Get the number of threads available on the hardware (at least 1). */
+        static unsigned int getNumHardwareThreads();
+        /**
+         * Get the CPUs of each NUMA node of the machine which the process is allowed
+         * to run on (nodes without any are not included). On Linux the nodes are read
+         * from /sys/devices/system/node; otherwise (or if they cannot be read) a single
+         * node is returned with no CPUs listed.
+         */
+        static std::vector<std::vector<int> > getNUMANodeCPUs();
+        /** Get whether new pools place their workers on NUMA nodes, i.e., numaPlacement is set and there is more than one node. */
+        static bool useNUMAPlacement();
+        ~RSGISThreadPool();
+    protected:
+        void workerLoop(unsigned int workerIdx);
+        void pinToNode(unsigned int node);
+        void runChunk(unsigned int workerIdx);
+        unsigned int numThreads;
+        std::vector<std::thread> workers;
+        std::mutex poolMutex;
+        std::condition_variable startCond;
+        std::condition_variable doneCond;
+        std::function<void(unsigned int, size_t, size_t)> task;
+        size_t taskStart;
+        size_t taskEnd;
+        unsigned long generation;
+        unsigned int nPending;
+        bool shutdown;
+        std::exception_ptr taskException;
+        /// The CPUs of each node where the workers are placed (empty otherwise).
+        std::vector<std::vector<int> > nodeCPUs;
+        std::thread::id callerThreadId;
+        std::vector<int> callerCPUs;
+    };
+}
+
+#endif
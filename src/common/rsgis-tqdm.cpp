@@ -14,10 +14,13 @@ namespace rsgis {
 
     rsgis_tqdm::rsgis_tqdm()
     {
-        this->t_first = std::chrono::system_clock::now();
-        this->t_old = std::chrono::system_clock::now();
-        this->in_screen = (system("test $STY") == 0);
-        this->in_tmux = (system("test $TMUX") == 0);
+        this->t_first = std::chrono::steady_clock::now();
+        this->t_old = this->t_first;
+        // The same tests as 'test $STY' and 'test $TMUX', without starting a shell for each bar.
+        const char *envSTY = std::getenv("STY");
+        const char *envTMUX = std::getenv("TMUX");
+        this->in_screen = ((envSTY != nullptr) && (envSTY[0] != '\0'));
+        this->in_tmux = ((envTMUX != nullptr) && (envTMUX[0] != '\0'));
         this->is_tty = isatty(1);
         this->bars = {" ", "▏", "▎", "▍", "▌", "▋", "▊", "▉", "█"};
         if (in_screen)
@@ -33,15 +36,15 @@ namespace rsgis {
 
     void rsgis_tqdm::reset()
     {
-        this->t_first = std::chrono::system_clock::now();
-        this->t_old = std::chrono::system_clock::now();
+        this->stopReporter();
+        this->started = false;
+        this->rendered = false;
+        this->numDone.store(0);
+        this->numTotal.store(0);
         this->n_old = 0;
         this->deq_t.clear();
         this->deq_n.clear();
-        this->period = 1;
-        this->nupdates = 0;
-        this->total_ = 0;
-        this->label = "";
+        this->setLabel("");
     }
 
     void rsgis_tqdm::set_theme_line()
@@ -77,7 +80,7 @@ namespace rsgis {
 
     void rsgis_tqdm::set_label(std::string label_)
     {
-        this->label = label_;
+        this->setLabel(label_);
     }
 
     void rsgis_tqdm::enable_colors()
@@ -86,107 +89,108 @@ namespace rsgis {
         this->use_colors = true;
     }
 
-    void rsgis_tqdm::finish()
+    void rsgis_tqdm::progress(int curr, int tot)
     {
-        this->progress(total_,total_);
-        printf("\n");
-        fflush(stdout);
+        this->update((unsigned long long)(std::max)(curr, 0), (unsigned long long)(std::max)(tot, 0));
     }
 
-    void rsgis_tqdm::progress(int curr, int tot)
+    void rsgis_tqdm::render(unsigned long long done, unsigned long long total, bool final)
     {
-        if(is_tty && (curr%period == 0))
+        auto now = std::chrono::steady_clock::now();
+        if (!this->rendered)
+        {
+            // The first update since the progress started.
+            this->t_first = now;
+            this->t_old = now;
+            this->n_old = 0;
+            this->deq_t.clear();
+            this->deq_n.clear();
+        }
+        double dt = ((std::chrono::duration<double>)(now - t_old)).count();
+        double dt_tot = ((std::chrono::duration<double>)(now - t_first)).count();
+        if ((dt > 0) && (done >= n_old))
         {
-            total_ = tot;
-            nupdates++;
-            auto now = std::chrono::system_clock::now();
-            double dt = ((std::chrono::duration<double>)(now - t_old)).count();
-            double dt_tot = ((std::chrono::duration<double>)(now - t_first)).count();
-            int dn = curr - n_old;
-            n_old = curr;
+            double dn = (double)(done - n_old);
+            n_old = done;
             t_old = now;
             if (deq_n.size() >= smoothing) deq_n.erase(deq_n.begin());
             if (deq_t.size() >= smoothing) deq_t.erase(deq_t.begin());
             deq_t.push_back(dt);
             deq_n.push_back(dn);
+        }
 
-            double avgrate = 0.;
+        double avgrate = 0.;
+        if (!deq_t.empty())
+        {
             if (use_ema)
             {
                 avgrate = deq_n[0] / deq_t[0];
                 for (unsigned int i = 1; i < deq_t.size(); i++)
                 {
-                    double r = 1.0*deq_n[i]/deq_t[i];
+                    double r = deq_n[i]/deq_t[i];
                     avgrate = alpha_ema*r + (1.0-alpha_ema)*avgrate;
                 }
             }
             else
             {
                 double dtsum = std::accumulate(deq_t.begin(),deq_t.end(),0.);
-                int dnsum = std::accumulate(deq_n.begin(),deq_n.end(),0.);
+                double dnsum = std::accumulate(deq_n.begin(),deq_n.end(),0.);
                 avgrate = dnsum/dtsum;
             }
+        }
 
-            // learn an appropriate period length to avoid spamming stdout
-            // and slowing down the loop, shoot for ~25Hz and smooth over 3 seconds
-            if (nupdates > 10)
-            {
-                period = (int)( (std::min)((std::max)((1.0/25)*curr/dt_tot,1.0), 5e5));
-                smoothing = 25*3;
-            }
-            double peta = (tot-curr)/avgrate;
-            double pct = (double)curr/(tot*0.01);
-            if( ( tot - curr ) <= period )
-            {
-                pct = 100.0;
-                avgrate = tot/dt_tot;
-                curr = tot;
-                peta = 0;
-            }
+        double peta = (avgrate > 0)?((total-done)/avgrate):0;
+        double pct = (double)done/(total*0.01);
+        if (final)
+        {
+            pct = 100.0;
+            avgrate = (dt_tot > 0)?(total/dt_tot):0;
+            done = total;
+            peta = 0;
+        }
 
-            double fills = ((double)curr / tot * width);
-            int ifills = (int)fills;
+        double fills = ((double)done / total * width);
+        int ifills = (int)fills;
 
-            printf("\015 ");
-            if (use_colors)
-            {
-                if (color_transition)
-                {
-                    // red (hue=0) to green (hue=1/3)
-                    int r = 255, g = 255, b = 255;
-                    hsv_to_rgb(0.0+0.01*pct/3,0.65,1.0, r,g,b);
-                    printf("\033[38;2;%d;%d;%dm ", r, g, b);
-                }
-                else
-                {
-                    printf("\033[32m ");
-                }
-            }
-            for (int i = 0; i < ifills; i++) std::cout << bars[8];
-            if (!in_screen && (curr != tot)) printf("%s",bars[(int)(8.0*(fills-ifills))]);
-            for (int i = 0; i < width-ifills-1; i++) std::cout << bars[0];
-            printf("%s ", right_pad.c_str());
-            if (use_colors) printf("\033[1m\033[31m");
-            printf("%4.1f%% ", pct);
-            if (use_colors) printf("\033[34m");
-
-            std::string unit = "Hz";
-            double div = 1.;
-            if (avgrate > 1e6)
+        printf("\015 ");
+        if (use_colors)
+        {
+            if (color_transition)
             {
-                unit = "MHz"; div = 1.0e6;
+                // red (hue=0) to green (hue=1/3)
+                int r = 255, g = 255, b = 255;
+                hsv_to_rgb(0.0+0.01*pct/3,0.65,1.0, r,g,b);
+                printf("\033[38;2;%d;%d;%dm ", r, g, b);
             }
-            else if (avgrate > 1e3)
+            else
             {
-                unit = "kHz"; div = 1.0e3;
+                printf("\033[32m ");
             }
-            printf("[%4d/%4d | %3.1f %s | %.0fs<%.0fs] ", curr,tot,  avgrate/div, unit.c_str(), dt_tot, peta);
-            printf("%s ", label.c_str());
-            if (use_colors) printf("\033[0m\033[32m\033[0m\015 ");
-
-            if( ( tot - curr ) > period ) fflush(stdout);
-
         }
+        for (int i = 0; i < ifills; i++) std::cout << bars[8];
+        if (!in_screen && (done != total)) printf("%s",bars[(int)(8.0*(fills-ifills))]);
+        for (int i = 0; i < width-ifills-1; i++) std::cout << bars[0];
+        printf("%s ", right_pad.c_str());
+        if (use_colors) printf("\033[1m\033[31m");
+        printf("%4.1f%% ", pct);
+        if (use_colors) printf("\033[34m");
+
+        std::string unit = "Hz";
+        double div = 1.;
+        if (avgrate > 1e6)
+        {
+            unit = "MHz"; div = 1.0e6;
+        }
+        else if (avgrate > 1e3)
+        {
+            unit = "kHz"; div = 1.0e3;
+        }
+        printf("[%4llu/%4llu | %3.1f %s | %.0fs<%.0fs] ", done, total, avgrate/div, unit.c_str(), dt_tot, peta);
+        printf("%s ", label.c_str());
+        if (use_colors) printf("\033[0m\033[32m\033[0m\015 ");
+        if (final) printf("\n");
+        std::cout.flush();
+        fflush(stdout);
     }
 
     void rsgis_tqdm::hsv_to_rgb(float h, float s, float v, int& r, int& g, int& b)
@@ -213,6 +217,7 @@ namespace rsgis {
 
     rsgis_tqdm::~rsgis_tqdm()
     {
-
+        // The reporter calls render, so it is stopped before this object is destroyed.
+        this->stopReporter();
     }
 }//rsgis
@@ -35,6 +35,8 @@
     #include <sys/ioctl.h>
 #endif
 
+#include "common/RSGISProgress.h"
+
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
 #undef DllExport
@@ -50,7 +52,12 @@
 
 namespace rsgis
 {
-    class DllExport rsgis_tqdm 
+    /**
+     * A progress bar rendered to the terminal (where the output is a terminal) by the
+     * reporter thread of rsgis::RSGISProgress, so the bar can be updated from parallel
+     * workers (with add) as well as with progress.
+     */
+    class DllExport rsgis_tqdm : public RSGISProgress
     {
         public:
             rsgis_tqdm();
@@ -63,20 +70,20 @@ namespace rsgis
             void set_theme_basic();
             void set_label(std::string label_);
             void enable_colors();
-            void finish();
             void progress(int curr, int tot);
             ~rsgis_tqdm();
 
+        protected:
+            void render(unsigned long long done, unsigned long long total, bool final);
+            bool renders(){return this->is_tty;};
+
         private:
-            // time, iteration counters and deques for rate calculations
-            std::chrono::time_point<std::chrono::system_clock> t_first;
-            std::chrono::time_point<std::chrono::system_clock> t_old;
-            int n_old = 0;
+            // time, iteration counters and deques for rate calculations (only used by render)
+            std::chrono::time_point<std::chrono::steady_clock> t_first;
+            std::chrono::time_point<std::chrono::steady_clock> t_old;
+            unsigned long long n_old = 0;
             std::vector<double> deq_t;
-            std::vector<int> deq_n;
-            int nupdates = 0;
-            int total_ = 0;
-            int period = 1;
+            std::vector<double> deq_n;
             unsigned int smoothing = 50;
             bool use_ema = true;
             float alpha_ema = 0.1;
@@ -106,7 +113,6 @@ namespace rsgis
             }();
     
             std::string right_pad = "▏";
-            std::string label = "";
     
             void hsv_to_rgb(float h, float s, float v, int& r, int& g, int& b);
     };
@@ -0,0 +1,141 @@
+/*
+ *  RSGISSmallSortedBuffer.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISSmallSortedBuffer_H
+#define RSGISSmallSortedBuffer_H
+
+#include <iostream>
+#include <algorithm>
+#include <cstddef>
+
+#include "datastruct/RSGISListException.h"
+
+namespace rsgis{ namespace datastruct{
+    
+    /**
+     * Select the kth smallest (0-based) of the n values, which partially reorders
+     * the values in place (O(n) on average rather than sorting the values).
+     */
+    template <typename T>
+    T rsgisSelectNth(T *vals, size_t n, size_t k)
+    {
+        if(k >= n)
+        {
+            throw RSGISListException("The index to select is not within the values.");
+        }
+        std::nth_element(vals, vals + k, vals + n);
+        return vals[k];
+    }
+    
+    /**
+     * The most common of the n values, which sorts the values in place. If more
+     * than one value has the highest count the smallest of them is returned.
+     */
+    template <typename T>
+    T rsgisMostCommonValue(T *vals, size_t n)
+    {
+        if(n == 0)
+        {
+            throw RSGISListException("There are no values to find the most common value of.");
+        }
+        std::sort(vals, vals + n);
+        T modeVal = vals[0];
+        size_t modeCount = 0;
+        size_t runStart = 0;
+        for(size_t i = 1; i <= n; ++i)
+        {
+            if((i == n) || (vals[i] != vals[runStart]))
+            {
+                if((i - runStart) > modeCount)
+                {
+                    modeCount = i - runStart;
+                    modeVal = vals[runStart];
+                }
+                runStart = i;
+            }
+        }
+        return modeVal;
+    }
+    
+    /**
+     * A sorted (ascending) buffer of up to N values held within the object (i.e.,
+     * on the stack for a local variable), so small sets of values such as the
+     * neighbours of a pixel can be ranked without allocating memory.
+     */
+    template <typename T, size_t N>
+    class RSGISSmallSortedBuffer
+    {
+    public:
+        RSGISSmallSortedBuffer(): numVals(0){};
+        /** Insert the value, keeping the buffer sorted. Throws RSGISListException if the buffer is full. */
+        void add(T val)
+        {
+            if(this->numVals == N)
+            {
+                throw RSGISListException("The sorted buffer is full.");
+            }
+            size_t idx = this->numVals;
+            while((idx > 0) && (val < this->vals[idx-1]))
+            {
+                this->vals[idx] = this->vals[idx-1];
+                --idx;
+            }
+            this->vals[idx] = val;
+            ++this->numVals;
+        };
+        size_t getSize() const {return this->numVals;};
+        static size_t getCapacity() {return N;};
+        bool empty() const {return this->numVals == 0;};
+        void clear() {this->numVals = 0;};
+        T getAt(size_t idx) const {return this->vals[idx];};
+        T getMin() const {return this->vals[0];};
+        T getMax() const {return this->vals[this->numVals-1];};
+        /** The most common value, where ties are resolved to the smallest value. The buffer must not be empty. */
+        T getMostCommonValue() const
+        {
+            T modeVal = this->vals[0];
+            size_t modeCount = 0;
+            size_t runStart = 0;
+            for(size_t i = 1; i <= this->numVals; ++i)
+            {
+                if((i == this->numVals) || (this->vals[i] != this->vals[runStart]))
+                {
+                    if((i - runStart) > modeCount)
+                    {
+                        modeCount = i - runStart;
+                        modeVal = this->vals[runStart];
+                    }
+                    runStart = i;
+                }
+            }
+            return modeVal;
+        };
+        ~RSGISSmallSortedBuffer(){};
+    private:
+        T vals[N];
+        size_t numVals;
+    };
+    
+}}
+
+#endif
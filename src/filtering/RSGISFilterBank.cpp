@@ -21,6 +21,7 @@
  */
 
 #include "RSGISFilterBank.h"
+#include "common/RSGISGDALInit.h"
 
 namespace rsgis{namespace filter{
 	
@@ -71,6 +72,229 @@ namespace rsgis{namespace filter{
 		}
 	}
 	
+	void RSGISFilterBank::executeFiltersFused(GDALDataset **datasets, int numDS, std::string outImageBase, std::string gdalFormat, std::string imgExt, GDALDataType outDataType, unsigned int numThreads)
+	{
+		int numFilters = this->filters->size();
+		if(numFilters == 0)
+		{
+			return;
+		}
+		
+		int numInBands = 0;
+		for(int i = 0; i < numDS; i++)
+		{
+			numInBands += datasets[i]->GetRasterCount();
+		}
+		int halo = 0;
+		for(int f = 0; f < numFilters; f++)
+		{
+			int winSize = this->filters->at(f)->getWindowSize();
+			if((winSize % 2 == 0) || (winSize < 3))
+			{
+				throw RSGISImageFilterException("Window size needs to be 3 or greater and an odd number.");
+			}
+			halo = std::max(halo, winSize/2);
+		}
+		
+		rsgis::RSGISGDALInit::init();
+		rsgis::img::RSGISImageUtils imgUtils;
+		double gdalTranslation[6];
+		std::vector<int> dsOffsetVals(numDS*2);
+		std::vector<int*> dsOffsets(numDS);
+		for(int i = 0; i < numDS; i++)
+		{
+			dsOffsets[i] = &dsOffsetVals[i*2];
+		}
+		int width = 0;
+		int height = 0;
+		int xBlockSize = 0;
+		int yBlockSize = 0;
+		imgUtils.getImageOverlap(datasets, numDS, dsOffsets.data(), &width, &height, gdalTranslation, &xBlockSize, &yBlockSize);
+		
+		std::vector<GDALRasterBand*> inputRasterBands;
+		std::vector<int> bandDS;
+		for(int i = 0; i < numDS; i++)
+		{
+			for(int j = 0; j < datasets[i]->GetRasterCount(); j++)
+			{
+				inputRasterBands.push_back(datasets[i]->GetRasterBand(j+1));
+				bandDS.push_back(i);
+			}
+		}
+		
+		std::vector<GDALDataset*> outputDatasets;
+		try
+		{
+			for(int f = 0; f < numFilters; f++)
+			{
+				std::string filename = outImageBase + this->filters->at(f)->getFileNameEnding() + "." + imgExt;
+				dynamic_cast<rsgis::img::RSGISCalcImageValue*>(this->filters->at(f))->setNumOutBands(numInBands);
+				outputDatasets.push_back(imgUtils.createCopy(datasets, numDS, numInBands, filename, gdalFormat, outDataType));
+			}
+			
+			rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+			int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (numInBands*sizeof(float)) + (((size_t)numFilters)*numInBands*sizeof(double)), context.stripMemoryMB);
+			stripRows = std::max(1, std::min(stripRows, height));
+			size_t nStrips = (height + stripRows - 1) / stripRows;
+			size_t padWidth = width + (2*halo);
+			size_t padRows = stripRows + (2*halo);
+			
+			// The input strips (zero padded by the halo) and the outputs of each filter for each I/O buffer.
+			rsgis::RSGISStripIOPipeline ioPipeline(context.numIOBuffers);
+			unsigned int nIOBufs = ioPipeline.getNumBuffers();
+			std::vector<std::vector<std::vector<float> > > inData(nIOBufs, std::vector<std::vector<float> >(numInBands, std::vector<float>(padWidth*padRows, 0)));
+			std::vector<std::vector<std::vector<std::vector<double> > > > outData(nIOBufs, std::vector<std::vector<std::vector<double> > >(numFilters, std::vector<std::vector<double> >(numInBands, std::vector<double>(((size_t)width)*stripRows))));
+			
+			// Each filter is only used by one thread at a time, so has its own window buffers.
+			std::vector<std::vector<float> > blockData(numFilters);
+			std::vector<std::vector<float*> > blockRows(numFilters);
+			std::vector<std::vector<float**> > blockBands(numFilters);
+			std::vector<std::vector<const float*> > winView(numFilters, std::vector<const float*>(numInBands));
+			std::vector<std::vector<const float*> > winOutColumn(numFilters, std::vector<const float*>(numInBands));
+			std::vector<std::vector<const float*> > winInColumn(numFilters, std::vector<const float*>(numInBands));
+			std::vector<std::vector<double> > outDataColumn(numFilters, std::vector<double>(numInBands));
+			// Not std::vector<bool> as the elements are written by different threads.
+			std::vector<char> useWinView(numFilters, true);
+			std::vector<char> useWinViewSlide(numFilters, true);
+			for(int f = 0; f < numFilters; f++)
+			{
+				int winSize = this->filters->at(f)->getWindowSize();
+				blockData[f].resize(((size_t)numInBands)*winSize*winSize);
+				blockRows[f].resize(numInBands*winSize);
+				blockBands[f].resize(numInBands);
+				for(int n = 0; n < numInBands; n++)
+				{
+					for(int y = 0; y < winSize; y++)
+					{
+						blockRows[f][(n*winSize)+y] = blockData[f].data() + ((((size_t)n)*winSize) + y)*winSize;
+					}
+					blockBands[f][n] = blockRows[f].data() + (n*winSize);
+				}
+			}
+			
+			rsgis::RSGISThreadPool threadPool(numThreads);
+			rsgis_tqdm pbar;
+			auto stripNumRows = [&](size_t strip)
+			{
+				return std::min<int>(stripRows, height - (strip*stripRows));
+			};
+			auto readStrip = [&](size_t strip, unsigned int buf)
+			{
+				int row = strip*stripRows;
+				int nRows = stripNumRows(strip);
+				int readStart = std::max(0, row - halo);
+				int readEnd = std::min(height, row + nRows + halo);
+				// The rows of the buffer before readStart and after readEnd are outside of the image.
+				size_t padStart = readStart - (row - halo);
+				size_t padEnd = padStart + (readEnd - readStart);
+				for(int n = 0; n < numInBands; n++)
+				{
+					float *bandData = inData[buf][n].data();
+					std::fill(bandData, bandData + (padStart*padWidth), 0.0f);
+					std::fill(bandData + (padEnd*padWidth), bandData + (padRows*padWidth), 0.0f);
+					if(inputRasterBands[n]->RasterIO(GF_Read, dsOffsets[bandDS[n]][0], dsOffsets[bandDS[n]][1] + readStart, width, readEnd - readStart, bandData + (padStart*padWidth) + halo, width, readEnd - readStart, GDT_Float32, sizeof(float), ((GSpacing)padWidth)*sizeof(float)) != CE_None)
+					{
+						throw RSGISImageFilterException("Failed to read the input image data.");
+					}
+				}
+			};
+			auto computeStrip = [&](size_t strip, unsigned int buf)
+			{
+				int nRows = stripNumRows(strip);
+				pbar.progress(strip*stripRows, height);
+				threadPool.parallelFor(0, numFilters, [&](unsigned int t, size_t fStart, size_t fEnd)
+				{
+					for(size_t f = fStart; f < fEnd; ++f)
+					{
+						RSGISImageFilter *filter = this->filters->at(f);
+						int winSize = filter->getWindowSize();
+						// The window of this filter is centred within the (larger) halo.
+						size_t winStart = halo - (winSize/2);
+						double *outColumn = outDataColumn[f].data();
+						for(int m = 0; m < nRows; ++m)
+						{
+							size_t outOff = ((size_t)m)*width;
+							for(int j = 0; j < width; j++)
+							{
+								size_t winOff = ((m + winStart) * padWidth) + j + winStart;
+								bool calcDone = false;
+								if(useWinView[f])
+								{
+									if((j > 0) && useWinViewSlide[f])
+									{
+										for(int n = 0; n < numInBands; n++)
+										{
+											winOutColumn[f][n] = inData[buf][n].data() + (winOff - 1);
+											winInColumn[f][n] = inData[buf][n].data() + (winOff + (winSize - 1));
+										}
+										calcDone = filter->calcImageWindowViewSlide(winOutColumn[f].data(), winInColumn[f].data(), padWidth, numInBands, winSize, outColumn);
+										useWinViewSlide[f] = calcDone;
+									}
+									if(!calcDone)
+									{
+										for(int n = 0; n < numInBands; n++)
+										{
+											winView[f][n] = inData[buf][n].data() + winOff;
+										}
+										calcDone = filter->calcImageWindowView(winView[f].data(), padWidth, numInBands, winSize, outColumn);
+										useWinView[f] = calcDone;
+									}
+								}
+								if(!calcDone)
+								{
+									for(int n = 0; n < numInBands; n++)
+									{
+										for(int y = 0; y < winSize; y++)
+										{
+											const float *winRow = inData[buf][n].data() + (winOff + (y * padWidth));
+											std::copy(winRow, winRow + winSize, blockBands[f][n][y]);
+										}
+									}
+									filter->calcImageValue(blockBands[f].data(), numInBands, winSize, outColumn);
+								}
+								for(int n = 0; n < numInBands; n++)
+								{
+									outData[buf][f][n][outOff + j] = outColumn[n];
+								}
+							}
+						}
+					}
+				});
+			};
+			auto writeStrip = [&](size_t strip, unsigned int buf)
+			{
+				int row = strip*stripRows;
+				int nRows = stripNumRows(strip);
+				for(int f = 0; f < numFilters; f++)
+				{
+					for(int n = 0; n < numInBands; n++)
+					{
+						if(outputDatasets[f]->GetRasterBand(n+1)->RasterIO(GF_Write, 0, row, width, nRows, outData[buf][f][n].data(), width, nRows, GDT_Float64, 0, 0) != CE_None)
+						{
+							throw RSGISImageFilterException("Failed to write the output image data.");
+						}
+					}
+				}
+			};
+			std::cout << "Executing " << numFilters << " filters with a single read of the input" << std::endl;
+			ioPipeline.run(nStrips, readStrip, computeStrip, writeStrip);
+			pbar.finish();
+		}
+		catch(rsgis::RSGISImageException &e)
+		{
+			for(size_t f = 0; f < outputDatasets.size(); f++)
+			{
+				GDALClose(outputDatasets[f]);
+			}
+			throw e;
+		}
+		
+		for(size_t f = 0; f < outputDatasets.size(); f++)
+		{
+			GDALClose(outputDatasets[f]);
+		}
+	}
+	
 	void RSGISFilterBank::exectuteFilter(int i, GDALDataset **datasets, int numDS, std::string outImageBase, std::string gdalFormat, GDALDataType outDataType)
 	{
 		try
@@ -36,6 +36,12 @@
 #include "filtering/RSGISImageKernelFilter.h"
 
 #include "common/RSGISImageException.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISStripIOPipeline.h"
+#include "common/RSGISThreadPool.h"
+#include "common/rsgis-tqdm.h"
+
+#include "img/RSGISImageUtils.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -60,6 +66,15 @@ namespace rsgis{namespace filter{
 			RSGISImageFilter* getFilter(int i);
 			int getNumFilters();
 			void executeFilters(GDALDataset **datasets, int numDS, std::string outImageBase, std::string gdalFormat, std::string imgExt, GDALDataType outDataType);
+			/**
+			 * As executeFilters but the input is only read once for all the filters, rather than
+			 * once per filter. Each strip is read with a halo of half the largest filter window
+			 * into a zero padded buffer which all the filters are then applied to, with the
+			 * filters split between numThreads threads (0 uses all available cores). The results
+			 * are the same as executeFilters; reading and writing the outputs overlap with the
+			 * filtering when the default execution context has more than 1 I/O buffer.
+			 */
+			void executeFiltersFused(GDALDataset **datasets, int numDS, std::string outImageBase, std::string gdalFormat, std::string imgExt, GDALDataType outDataType, unsigned int numThreads=1);
 			void exectuteFilter(int i, GDALDataset **datasets, int numDS, std::string outImageBase, std::string gdalFormat, GDALDataType outDataType);
 			void exportFilterBankImages(std::string imagebase);
 			~RSGISFilterBank();
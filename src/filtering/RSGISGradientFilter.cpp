@@ -0,0 +1,192 @@
+/*
+ *  RSGISGradientFilter.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISGradientFilter.h"
+
+namespace rsgis{namespace filter{
+    
+    RSGISGradientFilter::RSGISGradientFilter(GradientOperator gradOperator, bool outputXY)
+    {
+        this->gradOperator = gradOperator;
+        this->outputXY = outputXY;
+        if(gradOperator == RSGISGradientFilter::sobel)
+        {
+            this->smoothWeight = 2;
+        }
+        else
+        {
+            this->smoothWeight = 1;
+        }
+    }
+    
+    void RSGISGradientFilter::executeGradient(GDALDataset *dataset, std::string outputImage, std::string gdalFormat, GDALDataType outDataType, unsigned int numThreads)
+    {
+        // 8 and 16 bit images are read as their native type.
+        bool allByte = true;
+        bool allUInt16 = true;
+        for(int n = 0; n < dataset->GetRasterCount(); n++)
+        {
+            GDALDataType bandDataType = dataset->GetRasterBand(n+1)->GetRasterDataType();
+            if(bandDataType != GDT_Byte)
+            {
+                allByte = false;
+            }
+            if((bandDataType != GDT_Byte) && (bandDataType != GDT_UInt16))
+            {
+                allUInt16 = false;
+            }
+        }
+        
+        if(allByte)
+        {
+            this->executeGradientT<uint8_t>(dataset, outputImage, gdalFormat, outDataType, numThreads);
+        }
+        else if(allUInt16)
+        {
+            this->executeGradientT<uint16_t>(dataset, outputImage, gdalFormat, outDataType, numThreads);
+        }
+        else
+        {
+            this->executeGradientT<float>(dataset, outputImage, gdalFormat, outDataType, numThreads);
+        }
+    }
+    
+    template <typename T> void RSGISGradientFilter::executeGradientT(GDALDataset *dataset, std::string outputImage, std::string gdalFormat, GDALDataType outDataType, unsigned int numThreads)
+    {
+        typedef typename RSGISGradientAccumT<T>::type AccT;
+        int numInBands = dataset->GetRasterCount();
+        int width = dataset->GetRasterXSize();
+        int height = dataset->GetRasterYSize();
+        unsigned int nOutPerBand = this->getNumOutBandsPerBand();
+        int numOutBands = numInBands * nOutPerBand;
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        dataset->GetRasterBand(1)->GetBlockSize(&xBlockSize, &yBlockSize);
+        
+        rsgis::img::RSGISImageUtils imgUtils;
+        GDALDataset *outputDataset = imgUtils.createCopy(dataset, numOutBands, outputImage, gdalFormat, outDataType);
+        std::vector<std::string> bandNames;
+        for(int n = 0; n < numInBands; n++)
+        {
+            std::string bandPrefix = std::string("b") + std::to_string(n+1) + std::string("_");
+            if(this->outputXY)
+            {
+                bandNames.push_back(bandPrefix + std::string("x"));
+                bandNames.push_back(bandPrefix + std::string("y"));
+            }
+            bandNames.push_back(bandPrefix + std::string("mag"));
+            bandNames.push_back(bandPrefix + std::string("dir"));
+        }
+        imgUtils.setImageBandNames(outputDataset, bandNames, true);
+        
+        try
+        {
+            rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+            int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (numInBands*sizeof(T)) + (((size_t)numOutBands)*sizeof(float)), context.stripMemoryMB);
+            stripRows = std::max(1, std::min(stripRows, height));
+            size_t nStrips = (height + stripRows - 1) / stripRows;
+            size_t padWidth = width + 2;
+            size_t padRows = stripRows + 2;
+            
+            // The input strips (zero padded by 1 pixel) and the output bands for each I/O buffer.
+            rsgis::RSGISStripIOPipeline ioPipeline(context.numIOBuffers);
+            unsigned int nIOBufs = ioPipeline.getNumBuffers();
+            std::vector<std::vector<std::vector<T> > > inData(nIOBufs, std::vector<std::vector<T> >(numInBands, std::vector<T>(padWidth*padRows, 0)));
+            std::vector<std::vector<std::vector<float> > > outData(nIOBufs, std::vector<std::vector<float> >(numOutBands, std::vector<float>(((size_t)width)*stripRows)));
+            
+            rsgis::RSGISThreadPool threadPool(numThreads);
+            // Each worker allocates its own row buffers, so they are on its NUMA node.
+            std::vector<std::vector<AccT> > rowDiffs(threadPool.getNumThreads());
+            std::vector<std::vector<AccT> > rowSmooths(threadPool.getNumThreads());
+            threadPool.forEachWorker([&](unsigned int t)
+            {
+                rowDiffs[t].resize(padWidth);
+                rowSmooths[t].resize(padWidth);
+            });
+            rsgis_tqdm pbar;
+            auto stripNumRows = [&](size_t strip)
+            {
+                return std::min<int>(stripRows, height - (strip*stripRows));
+            };
+            auto readStrip = [&](size_t strip, unsigned int buf)
+            {
+                int row = strip*stripRows;
+                int nRows = stripNumRows(strip);
+                int readStart = std::max(0, row - 1);
+                int readEnd = std::min(height, row + nRows + 1);
+                // The rows of the buffer before readStart and after readEnd are outside of the image.
+                size_t padStart = readStart - (row - 1);
+                size_t padEnd = padStart + (readEnd - readStart);
+                for(int n = 0; n < numInBands; n++)
+                {
+                    T *bandData = inData[buf][n].data();
+                    std::fill(bandData, bandData + (padStart*padWidth), (T)0);
+                    std::fill(bandData + (padEnd*padWidth), bandData + (padRows*padWidth), (T)0);
+                    if(dataset->GetRasterBand(n+1)->RasterIO(GF_Read, 0, readStart, width, readEnd - readStart, bandData + (padStart*padWidth) + 1, width, readEnd - readStart, rsgis::img::RSGISGDALDataTypeT<T>::type(), sizeof(T), ((GSpacing)padWidth)*sizeof(T)) != CE_None)
+                    {
+                        throw RSGISImageFilterException("Failed to read the input image data.");
+                    }
+                }
+            };
+            auto computeStrip = [&](size_t strip, unsigned int buf)
+            {
+                int nRows = stripNumRows(strip);
+                pbar.progress(strip*stripRows, height);
+                for(int n = 0; n < numInBands; n++)
+                {
+                    threadPool.parallelFor(0, nRows, [&](unsigned int t, size_t rStart, size_t rEnd)
+                    {
+                        std::vector<float*> outRows(nOutPerBand);
+                        for(unsigned int i = 0; i < nOutPerBand; ++i)
+                        {
+                            outRows[i] = outData[buf][(n*nOutPerBand)+i].data() + (rStart * width);
+                        }
+                        this->calcGradientRows<T>(inData[buf][n].data() + (rStart * padWidth), padWidth, width, rEnd - rStart, outRows.data(), rowDiffs[t].data(), rowSmooths[t].data());
+                    });
+                }
+            };
+            auto writeStrip = [&](size_t strip, unsigned int buf)
+            {
+                int row = strip*stripRows;
+                int nRows = stripNumRows(strip);
+                for(int b = 0; b < numOutBands; b++)
+                {
+                    if(outputDataset->GetRasterBand(b+1)->RasterIO(GF_Write, 0, row, width, nRows, outData[buf][b].data(), width, nRows, GDT_Float32, 0, 0) != CE_None)
+                    {
+                        throw RSGISImageFilterException("Failed to write the output image data.");
+                    }
+                }
+            };
+            ioPipeline.run(nStrips, readStrip, computeStrip, writeStrip);
+            pbar.finish();
+        }
+        catch(rsgis::RSGISImageException &e)
+        {
+            GDALClose(outputDataset);
+            throw e;
+        }
+        
+        GDALClose(outputDataset);
+    }
+    
+}}
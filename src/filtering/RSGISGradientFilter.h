@@ -0,0 +1,169 @@
+/*
+ *  RSGISGradientFilter.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISGradientFilter_H
+#define RSGISGradientFilter_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <stdint.h>
+
+#include "gdal_priv.h"
+
+#include "filtering/RSGISImageFilterException.h"
+
+#include "common/RSGISImageException.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISStripIOPipeline.h"
+#include "common/RSGISThreadPool.h"
+#include "common/rsgis-tqdm.h"
+
+#include "img/RSGISImageUtils.h"
+#include "img/RSGISCalcImageT.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_filter_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace filter{
+    
+    /** The type the gradients of a pixel type are summed in (exact integers for 8 and 16 bit images). */
+    template <typename T> struct RSGISGradientAccumT{typedef double type;};
+    template <> struct RSGISGradientAccumT<uint8_t>{typedef int32_t type;};
+    template <> struct RSGISGradientAccumT<uint16_t>{typedef int32_t type;};
+    
+    /**
+     * Calculates the Sobel or Prewitt gradients of each band of an image in one pass,
+     * outputting the magnitude and direction of the gradient (and optionally the
+     * gradients, which are the same as the 'x' and 'y' outputs of RSGISSobelFilter and
+     * RSGISPrewittFilter). The 3x3 kernels are separable, so for each row the
+     * difference of the rows above and below and the (1,2,1 or 1,1,1) smoothing of the
+     * three rows are calculated once and then combined along the row.
+     *
+     * The x gradient is the (smoothed) difference down the columns (i.e., the row below
+     * minus the row above) and the y gradient is the difference along the rows (i.e.,
+     * right minus left), as RSGISSobelFilter. The direction is the direction of increasing
+     * value in degrees clockwise from the top of the image (0 - 360; 0 where the
+     * magnitude is 0).
+     *
+     * 8 and 16 bit images are read as their native type and the gradients summed as
+     * integers. As RSGISFilterBank::executeFiltersFused the image is zero padded at the edges.
+     */
+    class DllExport RSGISGradientFilter
+    {
+    public:
+        enum GradientOperator
+        {
+            sobel,
+            prewitt
+        };
+        
+        RSGISGradientFilter(GradientOperator gradOperator, bool outputXY=false);
+        /** The number of output bands for each input band (magnitude and direction, plus x and y if outputXY). */
+        unsigned int getNumOutBandsPerBand(){return this->outputXY?4:2;};
+        /** Calculate the gradients of each band of the image, writing getNumOutBandsPerBand() bands per input band. */
+        void executeGradient(GDALDataset *dataset, std::string outputImage, std::string gdalFormat, GDALDataType outDataType, unsigned int numThreads=1);
+        /**
+         * Calculate the gradients of the nRows x width pixels starting at (1, 1) of padData,
+         * which is zero padded by 1 pixel, writing the output rows (x, y, magnitude and direction,
+         * or just magnitude and direction) to outRows. rowDiff and rowSmooth are padWidth buffers.
+         */
+        template <typename T> void calcGradientRows(const T *padData, size_t padWidth, size_t width, size_t nRows, float **outRows, typename RSGISGradientAccumT<T>::type *rowDiff, typename RSGISGradientAccumT<T>::type *rowSmooth);
+        ~RSGISGradientFilter(){};
+    protected:
+        template <typename T> void executeGradientT(GDALDataset *dataset, std::string outputImage, std::string gdalFormat, GDALDataType outDataType, unsigned int numThreads);
+        GradientOperator gradOperator;
+        bool outputXY;
+        int smoothWeight;
+    };
+    
+    template <typename T> void RSGISGradientFilter::calcGradientRows(const T *padData, size_t padWidth, size_t width, size_t nRows, float **outRows, typename RSGISGradientAccumT<T>::type *rowDiff, typename RSGISGradientAccumT<T>::type *rowSmooth)
+    {
+        typedef typename RSGISGradientAccumT<T>::type AccT;
+        const AccT weight = this->smoothWeight;
+        unsigned int outIdx = 0;
+        float *outX = NULL;
+        float *outY = NULL;
+        if(this->outputXY)
+        {
+            outX = outRows[0];
+            outY = outRows[1];
+            outIdx = 2;
+        }
+        float *outMag = outRows[outIdx];
+        float *outDir = outRows[outIdx+1];
+        
+        for(size_t m = 0; m < nRows; ++m)
+        {
+            const T *above = padData + (m * padWidth);
+            const T *centre = above + padWidth;
+            const T *below = centre + padWidth;
+            for(size_t i = 0; i < padWidth; ++i)
+            {
+                rowDiff[i] = ((AccT)below[i]) - ((AccT)above[i]);
+                rowSmooth[i] = ((AccT)above[i]) + (weight * ((AccT)centre[i])) + ((AccT)below[i]);
+            }
+            
+            size_t outOff = m * width;
+            for(size_t x = 0; x < width; ++x)
+            {
+                AccT gX = rowDiff[x] + (weight * rowDiff[x+1]) + rowDiff[x+2];
+                AccT gY = rowSmooth[x+2] - rowSmooth[x];
+                double dX = gX;
+                double dY = gY;
+                if(this->outputXY)
+                {
+                    outX[outOff+x] = dX;
+                    outY[outOff+x] = dY;
+                }
+                outMag[outOff+x] = sqrt((dX * dX) + (dY * dY));
+                
+                // The right (y) and up (-x) components give the bearing from the top of the image.
+                double dir = 0;
+                if((gX != 0) || (gY != 0))
+                {
+                    dir = atan2(dY, -dX) * (180.0 / M_PI);
+                    if(dir < 0)
+                    {
+                        dir = dir + 360.0;
+                    }
+                }
+                outDir[outOff+x] = dir;
+            }
+        }
+    }
+    
+}}
+
+#endif
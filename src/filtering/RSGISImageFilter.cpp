@@ -45,6 +45,23 @@ namespace rsgis{namespace filter{
 		}
 	}
 	
+	void RSGISImageFilter::runFilterArrays(const float* const* bands, int numBands, size_t width, size_t height, double **output, unsigned int numThreads)
+	{
+		this->setNumOutBands(numBands);
+		rsgis::img::RSGISCalcImage* calcImage = this->getCalcImage();
+		try
+		{
+			calcImage->setNumThreads(numThreads);
+			calcImage->calcImageWindowArrays(bands, numBands, width, height, this->size, output);
+			delete calcImage;
+		}
+		catch(RSGISImageException &e)
+		{
+			delete calcImage;
+			throw e;
+		}
+	}
+	
 	rsgis::img::RSGISCalcImage* RSGISImageFilter::getCalcImage()
 	{
 		return new rsgis::img::RSGISCalcImage(this, "", true);
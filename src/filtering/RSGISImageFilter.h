@@ -60,11 +60,15 @@ namespace rsgis{namespace filter{
 		public: 
 			RSGISImageFilter(int numberOutBands, int size, std::string filenameEnding);
 			void runFilter(GDALDataset **datasets, int numDS, std::string outputImage, std::string gdalFormat, GDALDataType outDataType);
+			/** Apply the filter to numBands arrays of width x height pixels in memory, writing one output array per band. */
+			void runFilterArrays(const float* const* bands, int numBands, size_t width, size_t height, double **output, unsigned int numThreads=1);
 			virtual rsgis::img::RSGISCalcImage* getCalcImage();
 			virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output)  = 0;
 			virtual bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output)  = 0;
 			virtual void exportAsImage(std::string filename) = 0;
 			virtual std::string getFileNameEnding();
+			/** The size of the (square) window of the filter. */
+			int getWindowSize(){return this->size;};
 			~RSGISImageFilter();
 		protected:
 			int size;
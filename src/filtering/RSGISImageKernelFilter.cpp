@@ -21,12 +21,63 @@
  */
 
 #include "RSGISImageKernelFilter.h"
+#include "common/RSGISGDALInit.h"
 
 namespace rsgis{namespace filter{
 
 	RSGISImageKernelFilter::RSGISImageKernelFilter(int numberOutBands, int size, std::string filenameEnding, ImageFilter *filter) : RSGISImageFilter(numberOutBands, size, filenameEnding)
 	{
 		this->filter = filter;
+		this->colSumsStart = 0;
+		this->findSeparableKernel();
+	}
+	
+	void RSGISImageKernelFilter::findSeparableKernel()
+	{
+		// The kernel is separable if it has a rank of 1, in which case the column and
+		// row through the largest (absolute) value of the kernel define the 1D kernels.
+		this->separable = false;
+		int fSize = this->filter->size;
+		int pivotRow = 0;
+		int pivotCol = 0;
+		double maxAbsVal = 0;
+		for(int j = 0; j < fSize; j++)
+		{
+			for(int k = 0; k < fSize; k++)
+			{
+				if(fabs(this->filter->filter[j][k]) > maxAbsVal)
+				{
+					maxAbsVal = fabs(this->filter->filter[j][k]);
+					pivotRow = j;
+					pivotCol = k;
+				}
+			}
+		}
+		
+		this->colKernel.assign(fSize, 0);
+		this->rowKernel.assign(fSize, 0);
+		if(maxAbsVal == 0)
+		{
+			this->separable = true;
+			return;
+		}
+		
+		double pivotVal = this->filter->filter[pivotRow][pivotCol];
+		for(int j = 0; j < fSize; j++)
+		{
+			this->colKernel[j] = this->filter->filter[j][pivotCol];
+			this->rowKernel[j] = this->filter->filter[pivotRow][j] / pivotVal;
+		}
+		
+		double maxDiff = 0;
+		for(int j = 0; j < fSize; j++)
+		{
+			for(int k = 0; k < fSize; k++)
+			{
+				maxDiff = std::max(maxDiff, fabs(this->filter->filter[j][k] - (this->colKernel[j] * this->rowKernel[k])));
+			}
+		}
+		this->separable = (maxDiff <= (maxAbsVal * 1e-6));
 	}
 	
 	void RSGISImageKernelFilter::calcImageValue(float ***dataBlock, int numBands, int winSize, double *output) 
@@ -52,6 +103,92 @@ namespace rsgis{namespace filter{
 		}
 	}
 	
+	bool RSGISImageKernelFilter::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+	{
+		if(winSize != size)
+		{
+			throw rsgis::img::RSGISImageCalcException("Filter Size and window size do not match.");
+		}
+		
+		if(this->separable)
+		{
+			this->colSums.resize(numBands);
+			this->colSumsStart = 0;
+			for(int i = 0; i < numBands; i++)
+			{
+				this->colSums[i].assign(size, 0);
+				for(int j = 0; j < size; j++)
+				{
+					const float *winRow = winData[i] + (j * stride);
+					for(int k = 0; k < size; k++)
+					{
+						this->colSums[i][k] = this->colSums[i][k] + (winRow[k] * this->colKernel[j]);
+					}
+				}
+				output[i] = this->calcSeparableOutput(i);
+			}
+		}
+		else
+		{
+			double outputValue = 0;
+			for(int i = 0; i < numBands; i++)
+			{
+				outputValue = 0;
+				for(int j = 0; j < size; j++)
+				{
+					const float *winRow = winData[i] + (j * stride);
+					const float *filterRow = filter->filter[j];
+					for(int k = 0; k < size; k++)
+					{
+						outputValue = outputValue + (winRow[k] * filterRow[k]);
+					}
+				}
+				output[i] = outputValue;
+			}
+		}
+		return true;
+	}
+	
+	bool RSGISImageKernelFilter::calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output)
+	{
+		if(!this->separable)
+		{
+			return false;
+		}
+		
+		// The column sum of the column which left the window is replaced with
+		// the column which has entered it, which becomes the last column.
+		size_t newCol = this->colSumsStart;
+		this->colSumsStart = (this->colSumsStart + 1) % size;
+		for(int i = 0; i < numBands; i++)
+		{
+			double colSum = 0;
+			for(int j = 0; j < size; j++)
+			{
+				colSum = colSum + (inColumn[i][j * stride] * this->colKernel[j]);
+			}
+			this->colSums[i][newCol] = colSum;
+			output[i] = this->calcSeparableOutput(i);
+		}
+		return true;
+	}
+	
+	double RSGISImageKernelFilter::calcSeparableOutput(int band)
+	{
+		double outputValue = 0;
+		const std::vector<double> &bandColSums = this->colSums[band];
+		size_t col = this->colSumsStart;
+		for(int k = 0; k < size; k++)
+		{
+			outputValue = outputValue + (bandColSums[col] * this->rowKernel[k]);
+			if(++col == ((size_t)size))
+			{
+				col = 0;
+			}
+		}
+		return outputValue;
+	}
+	
 	bool RSGISImageKernelFilter::calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) 
 	{
 		throw rsgis::img::RSGISImageCalcException("Not implemented");
@@ -59,7 +196,7 @@ namespace rsgis{namespace filter{
 
 	void RSGISImageKernelFilter::exportAsImage(std::string filename)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		GDALDataset *outputImageDS = NULL;
 		GDALRasterBand *outputRasterBand = NULL;
 		GDALDriver *gdalDriver = NULL;
@@ -25,6 +25,9 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
 
 #include "common/RSGISImageException.h"
 
@@ -35,7 +38,7 @@
 #include "filtering/RSGISImageFilter.h"
 
 // mark all exported classes/functions with DllExport to have
-// them exported by Visual Studio
+// them exported by Visual Studio
 #undef DllExport
 #ifdef _MSC_VER
     #ifdef rsgis_filter_EXPORTS
@@ -50,16 +53,33 @@
 namespace rsgis{namespace filter{
 	
 	
+	/**
+	 * Convolve the image with a kernel. Where the kernel is separable (i.e., it is the
+	 * outer product of a column and a row kernel, such as a Gaussian smoothing kernel)
+	 * the window is processed as two 1D passes, where the column pass is only calculated
+	 * for the column entering the window as it moves along the row, so the cost per
+	 * pixel is linear rather than quadratic in the window size.
+	 */
 	class DllExport RSGISImageKernelFilter : public RSGISImageFilter
 		{
 		public: 
 			RSGISImageKernelFilter(int numberOutBands, int size, std::string filenameEnding, ImageFilter *filter);
 			virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+			virtual bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+			virtual bool calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output);
 			virtual bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output);
 			virtual void exportAsImage(std::string filename);
+			bool isSeparable(){return this->separable;};
 			~RSGISImageKernelFilter();
 		protected:
+			void findSeparableKernel();
+			double calcSeparableOutput(int band);
 			ImageFilter *filter;
+			bool separable;
+			std::vector<double> colKernel;
+			std::vector<double> rowKernel;
+			std::vector<std::vector<double> > colSums;
+			size_t colSumsStart;
 		};
 }}
 
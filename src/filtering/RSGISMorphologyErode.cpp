@@ -36,12 +36,13 @@ namespace rsgis{namespace filter{
             throw rsgis::img::RSGISImageCalcException("Morphological operator must be a square matrix.");
         }
         
-		int numBands = datasets[0]->GetRasterCount();
-		RSGISMorphologyErode *erodeImage = new RSGISMorphologyErode(numBands, matrixOperator);
-		rsgis::img::RSGISCalcImage calcImg = rsgis::img::RSGISCalcImage(erodeImage, "", true);
-        try 
+        try
         {
-            calcImg.calcImageWindowData(datasets, 1, outputImage, matrixOperator->n, format, outDataType);
+            // A single pass over the image, separating rectangular operators into rows and columns.
+            RSGISImageMorphologySequence morphSeq(matrixOperator);
+            std::vector<RSGISMorphologyOperation> operations;
+            operations.push_back(morphErode);
+            morphSeq.performSequence(datasets[0], outputImage, operations, morphNoDiff, format, outDataType);
         }
         catch(rsgis::img::RSGISImageCalcException &e)
         {
@@ -51,7 +52,6 @@ namespace rsgis{namespace filter{
         {
             throw e;
         }
-        delete erodeImage;
 	}
     
     void RSGISImageMorphologyErode::erodeImageAll(GDALDataset **datasets, std::string outputImage, rsgis::math::Matrix *matrixOperator, std::string format, GDALDataType outDataType)
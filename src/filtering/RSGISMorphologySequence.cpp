@@ -0,0 +1,353 @@
+/*
+ *  RSGISMorphologySequence.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISMorphologySequence.h"
+
+namespace rsgis{namespace filter{
+
+    RSGISImageMorphologySequence::RSGISImageMorphologySequence(rsgis::math::Matrix *matrixOperator)
+    {
+        if(matrixOperator->n != matrixOperator->m)
+        {
+            throw rsgis::img::RSGISImageCalcException("Morphological operator must be a square matrix.");
+        }
+        if(matrixOperator->n % 2 == 0)
+        {
+            throw rsgis::img::RSGISImageCalcException("Window size needs to be an odd number (min = 3).");
+        }
+        else if(matrixOperator->n < 3)
+        {
+            throw rsgis::img::RSGISImageCalcException("Window size needs to be 3 or greater and an odd number.");
+        }
+        this->matrixOperator = matrixOperator;
+        this->winMid = matrixOperator->n / 2;
+
+        bool validOp = false;
+        for(int i = 0; i < (matrixOperator->n * matrixOperator->m); ++i)
+        {
+            if(matrixOperator->matrix[i] > 0)
+            {
+                validOp = true;
+                break;
+            }
+        }
+        if(!validOp)
+        {
+            throw rsgis::img::RSGISImageCalcException("The morphological operator does not have any values greater than 0.");
+        }
+        
+        // Find whether the operator pixels > 0 fill their bounding box.
+        this->rectRowStart = matrixOperator->n;
+        this->rectRowEnd = -1;
+        this->rectColStart = matrixOperator->m;
+        this->rectColEnd = -1;
+        unsigned int numOpPxls = 0;
+        for(int i = 0; i < matrixOperator->n; ++i)
+        {
+            for(int j = 0; j < matrixOperator->m; ++j)
+            {
+                if(matrixOperator->matrix[(i * matrixOperator->m) + j] > 0)
+                {
+                    this->rectRowStart = std::min(this->rectRowStart, i);
+                    this->rectRowEnd = std::max(this->rectRowEnd, i);
+                    this->rectColStart = std::min(this->rectColStart, j);
+                    this->rectColEnd = std::max(this->rectColEnd, j);
+                    ++numOpPxls;
+                }
+            }
+        }
+        this->rectOp = (numOpPxls == (unsigned int)((this->rectRowEnd - this->rectRowStart + 1) * (this->rectColEnd - this->rectColStart + 1)));
+        this->rectRowStart -= this->winMid;
+        this->rectRowEnd -= this->winMid;
+        this->rectColStart -= this->winMid;
+        this->rectColEnd -= this->winMid;
+    }
+
+    void RSGISImageMorphologySequence::performSequence(GDALDataset *dataset, std::string outputImage, std::vector<RSGISMorphologyOperation> operations, RSGISMorphologyDifference diff, std::string format, GDALDataType outDataType)
+    {
+        if(operations.empty())
+        {
+            throw rsgis::img::RSGISImageCalcException("At least one morphological operation is required.");
+        }
+
+        rsgis::img::RSGISImageUtils imgUtils;
+        unsigned int width = dataset->GetRasterXSize();
+        unsigned int height = dataset->GetRasterYSize();
+        int numBands = dataset->GetRasterCount();
+
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        dataset->GetRasterBand(1)->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = std::max((unsigned int)std::max(yBlockSize, 1), RSGIS_MORPH_STRIP_ROWS);
+        unsigned int haloRows = operations.size() * this->winMid;
+
+        // The strip buffers have winMid columns of zeros either side of the image.
+        unsigned int stride = width + (2 * this->winMid);
+        unsigned int bufRows = stripRows + (2 * haloRows);
+        this->opOffsets.clear();
+        for(int i = 0; i < this->matrixOperator->n; ++i)
+        {
+            for(int j = 0; j < this->matrixOperator->m; ++j)
+            {
+                if(this->matrixOperator->matrix[(i * this->matrixOperator->m) + j] > 0)
+                {
+                    this->opOffsets.push_back(((long)(i - this->winMid) * stride) + (j - this->winMid));
+                }
+            }
+        }
+
+        std::vector<float> inVals(((size_t)bufRows) * stride);
+        std::vector<float> valsA(((size_t)bufRows) * stride);
+        std::vector<float> valsB(((size_t)bufRows) * stride);
+        if(this->rectOp)
+        {
+            this->rectVals.assign(((size_t)bufRows) * stride, 0.0f);
+        }
+
+        GDALDataset *outDataset = imgUtils.createCopy(dataset, outputImage, format, outDataType);
+
+        rsgis_tqdm pbar;
+        for(unsigned int row = 0; row < height; row += stripRows)
+        {
+            pbar.progress(row, height);
+            unsigned int nRows = std::min(stripRows, height - row);
+            // The image row of the first row of the buffers (which can be above the image).
+            long bufStartRow = ((long)row) - haloRows;
+            unsigned int nBufRows = nRows + (2 * haloRows);
+            long readStartRow = std::max(bufStartRow, 0L);
+            long readEndRow = std::min(((long)row) + nRows + haloRows, (long)height);
+
+            for(int n = 0; n < numBands; ++n)
+            {
+                std::fill(inVals.begin(), inVals.end(), 0.0f);
+                float *readPtr = &inVals[((readStartRow - bufStartRow) * stride) + this->winMid];
+                if(dataset->GetRasterBand(n+1)->RasterIO(GF_Read, 0, readStartRow, width, readEndRow - readStartRow, readPtr, width, readEndRow - readStartRow, GDT_Float32, 0, sizeof(float) * stride) != CE_None)
+                {
+                    GDALClose(outDataset);
+                    throw rsgis::img::RSGISImageCalcException("Could not read the input image band.");
+                }
+
+                bool useRect = this->rectOp;
+                if(useRect)
+                {
+                    const float *readEnd = &inVals[(readEndRow - bufStartRow) * stride];
+                    useRect = std::none_of((const float*)readPtr, readEnd, [](float val){return std::isnan(val);});
+                }
+                
+                const float *srcVals = inVals.data();
+                float *dstVals = valsA.data();
+                for(unsigned int k = 0; k < operations.size(); ++k)
+                {
+                    std::fill(dstVals, dstVals + (((size_t)bufRows) * stride), 0.0f);
+                    // Only the buffer rows within the image, which can be calculated from the previous operation.
+                    long startRow = std::max((long)((k+1) * this->winMid), readStartRow - bufStartRow);
+                    long endRow = std::min((long)(nBufRows - ((k+1) * this->winMid)), readEndRow - bufStartRow);
+                    if(endRow > startRow)
+                    {
+                        if(useRect)
+                        {
+                            this->applyRectOperation(operations[k], srcVals, dstVals, startRow, endRow, width, stride);
+                        }
+                        else
+                        {
+                            this->applyOperation(operations[k], srcVals, dstVals, startRow, endRow, width, stride);
+                        }
+                        this->convertToDataType(&dstVals[(startRow * stride) + this->winMid], endRow - startRow, width, stride, outDataType);
+                    }
+                    srcVals = dstVals;
+                    dstVals = (dstVals == valsA.data())?valsB.data():valsA.data();
+                }
+
+                float *outVals = const_cast<float*>(srcVals) + (haloRows * stride) + this->winMid;
+                if(diff != morphNoDiff)
+                {
+                    const float *inStripVals = &inVals[(haloRows * stride) + this->winMid];
+                    for(unsigned int i = 0; i < nRows; ++i)
+                    {
+                        for(unsigned int j = 0; j < width; ++j)
+                        {
+                            size_t idx = (((size_t)i) * stride) + j;
+                            if(diff == morphInputMinusResult)
+                            {
+                                outVals[idx] = inStripVals[idx] - outVals[idx];
+                            }
+                            else
+                            {
+                                outVals[idx] = outVals[idx] - inStripVals[idx];
+                            }
+                        }
+                    }
+                }
+
+                if(outDataset->GetRasterBand(n+1)->RasterIO(GF_Write, 0, row, width, nRows, outVals, width, nRows, GDT_Float32, 0, sizeof(float) * stride) != CE_None)
+                {
+                    GDALClose(outDataset);
+                    throw rsgis::img::RSGISImageCalcException("Could not write the output image band.");
+                }
+            }
+        }
+        pbar.finish();
+
+        GDALClose(outDataset);
+    }
+
+    void RSGISImageMorphologySequence::applyOperation(RSGISMorphologyOperation operation, const float *inVals, float *outVals, unsigned int startRow, unsigned int endRow, unsigned int width, unsigned int stride)
+    {
+        size_t numOffsets = this->opOffsets.size();
+        const long *offsets = this->opOffsets.data();
+        for(unsigned int i = startRow; i < endRow; ++i)
+        {
+            size_t rowIdx = (((size_t)i) * stride) + this->winMid;
+            for(unsigned int j = 0; j < width; ++j)
+            {
+                const float *pxl = &inVals[rowIdx + j];
+                // The same comparisons as RSGISMorphologyErode and RSGISMorphologyDilate.
+                float val = pxl[offsets[0]];
+                if(operation == morphErode)
+                {
+                    for(size_t k = 1; k < numOffsets; ++k)
+                    {
+                        if(pxl[offsets[k]] < val)
+                        {
+                            val = pxl[offsets[k]];
+                        }
+                    }
+                }
+                else
+                {
+                    for(size_t k = 1; k < numOffsets; ++k)
+                    {
+                        if(pxl[offsets[k]] > val)
+                        {
+                            val = pxl[offsets[k]];
+                        }
+                    }
+                }
+                outVals[rowIdx + j] = val;
+            }
+        }
+    }
+
+    void RSGISImageMorphologySequence::applyRectOperation(RSGISMorphologyOperation operation, const float *inVals, float *outVals, unsigned int startRow, unsigned int endRow, unsigned int width, unsigned int stride)
+    {
+        // Along the rows of the rectangle (including those outside of the image, which are 0)...
+        long rowPassStart = ((long)startRow) + this->rectRowStart;
+        long rowPassEnd = ((long)endRow) + this->rectRowEnd;
+        for(long i = rowPassStart; i < rowPassEnd; ++i)
+        {
+            size_t rowIdx = (((size_t)i) * stride) + this->winMid;
+            this->runningMinMax(operation, &inVals[rowIdx], &this->rectVals[rowIdx], width, this->rectColStart, (this->rectColEnd - this->rectColStart) + 1, 1, 0, 1);
+        }
+        
+        // ...and then down the columns, processing the rows in turn.
+        size_t startIdx = (((size_t)startRow) * stride) + this->winMid;
+        this->runningMinMax(operation, &this->rectVals[startIdx], &outVals[startIdx], endRow - startRow, this->rectRowStart, (this->rectRowEnd - this->rectRowStart) + 1, stride, 1, width);
+    }
+    
+    void RSGISImageMorphologySequence::runningMinMax(RSGISMorphologyOperation operation, const float *inVals, float *outVals, long n, long winOff, long winLen, long step, long lineStep, long numLines)
+    {
+        bool isMin = (operation == morphErode);
+        // The values from in(winOff) to in(n-1+winOff+winLen-1), in blocks of winLen.
+        long numVals = n + winLen - 1;
+        this->prefixVals.resize(((size_t)numVals) * numLines);
+        this->suffixVals.resize(((size_t)numVals) * numLines);
+        const float *startVals = inVals + (winOff * step);
+        
+        for(long q = 0; q < numVals; ++q)
+        {
+            const float *vals = startVals + (q * step);
+            float *prefix = &this->prefixVals[((size_t)q) * numLines];
+            if((q % winLen) == 0)
+            {
+                for(long l = 0; l < numLines; ++l)
+                {
+                    prefix[l] = vals[l * lineStep];
+                }
+            }
+            else
+            {
+                const float *prevPrefix = prefix - numLines;
+                for(long l = 0; l < numLines; ++l)
+                {
+                    float val = vals[l * lineStep];
+                    prefix[l] = (isMin?(val < prevPrefix[l]):(val > prevPrefix[l]))?val:prevPrefix[l];
+                }
+            }
+        }
+        
+        for(long q = numVals-1; q >= 0; --q)
+        {
+            const float *vals = startVals + (q * step);
+            float *suffix = &this->suffixVals[((size_t)q) * numLines];
+            if(((q % winLen) == (winLen - 1)) || (q == (numVals - 1)))
+            {
+                for(long l = 0; l < numLines; ++l)
+                {
+                    suffix[l] = vals[l * lineStep];
+                }
+            }
+            else
+            {
+                const float *nextSuffix = suffix + numLines;
+                for(long l = 0; l < numLines; ++l)
+                {
+                    float val = vals[l * lineStep];
+                    suffix[l] = (isMin?(val < nextSuffix[l]):(val > nextSuffix[l]))?val:nextSuffix[l];
+                }
+            }
+        }
+        
+        for(long i = 0; i < n; ++i)
+        {
+            const float *suffix = &this->suffixVals[((size_t)i) * numLines];
+            const float *prefix = &this->prefixVals[((size_t)(i + winLen - 1)) * numLines];
+            float *out = outVals + (i * step);
+            for(long l = 0; l < numLines; ++l)
+            {
+                out[l * lineStep] = (isMin?(prefix[l] < suffix[l]):(prefix[l] > suffix[l]))?prefix[l]:suffix[l];
+            }
+        }
+    }
+    
+    void RSGISImageMorphologySequence::convertToDataType(float *vals, unsigned int nRows, unsigned int width, unsigned int stride, GDALDataType dataType)
+    {
+        if((dataType == GDT_Float32) || (dataType == GDT_Float64))
+        {
+            return;
+        }
+        // Round trip through the data type, as storing the values in an image of that type would.
+        int typeBytes = GDALGetDataTypeSizeBytes(dataType);
+        this->typeVals.resize(((size_t)width) * typeBytes);
+        for(unsigned int i = 0; i < nRows; ++i)
+        {
+            float *rowVals = &vals[((size_t)i) * stride];
+            GDALCopyWords(rowVals, GDT_Float32, sizeof(float), this->typeVals.data(), dataType, typeBytes, width);
+            GDALCopyWords(this->typeVals.data(), dataType, typeBytes, rowVals, GDT_Float32, sizeof(float), width);
+        }
+    }
+
+    RSGISImageMorphologySequence::~RSGISImageMorphologySequence()
+    {
+
+    }
+
+}}
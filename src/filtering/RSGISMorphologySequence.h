@@ -0,0 +1,123 @@
+/*
+ *  RSGISMorphologySequence.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISMorphologySequence_H
+#define RSGISMorphologySequence_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "gdal_priv.h"
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageUtils.h"
+
+#include "math/RSGISMatrices.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_filter_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace filter{
+
+    static const unsigned int RSGIS_MORPH_STRIP_ROWS( 256 );
+
+    enum RSGISMorphologyOperation
+    {
+        /// The minimum within the operator
+        morphErode,
+        /// The maximum within the operator
+        morphDilate
+    };
+
+    enum RSGISMorphologyDifference
+    {
+        /// Output the result of the operations
+        morphNoDiff,
+        /// Output the input image minus the result (e.g., white top hat)
+        morphInputMinusResult,
+        /// Output the result minus the input image (e.g., black top hat)
+        morphResultMinusInput
+    };
+
+    /**
+     * Applies a sequence of erosions and dilations to an image in a single sweep
+     * over the image, without intermediate images. Each strip of the image is
+     * read with a halo of (number of operations * operator radius) rows and the
+     * operations are applied in turn within the strip, each shrinking the valid
+     * rows by the operator radius.
+     *
+     * The result is the same as applying each operation as a separate pass with
+     * RSGISCalcImage::calcImageWindowData through images of the output data
+     * type: the pixels outside of the image are 0 for every operation and the
+     * result of each operation is converted to the output data type.
+     *
+     * Where the operator pixels > 0 are a rectangle (e.g., a square, or a line
+     * of pixels) the operation is separated into a pass along the rows and a
+     * pass down the columns, each using the van Herk/Gil-Werman running min/max
+     * so the number of comparisons per pixel does not depend on the size of the
+     * operator. The strips with NaN values use the operator directly, as the
+     * result with NaN values depends on the order of the comparisons.
+     */
+    class DllExport RSGISImageMorphologySequence
+    {
+    public:
+        RSGISImageMorphologySequence(rsgis::math::Matrix *matrixOperator);
+        void performSequence(GDALDataset *dataset, std::string outputImage, std::vector<RSGISMorphologyOperation> operations, RSGISMorphologyDifference diff, std::string format, GDALDataType outDataType);
+        ~RSGISImageMorphologySequence();
+    protected:
+        void applyOperation(RSGISMorphologyOperation operation, const float *inVals, float *outVals, unsigned int startRow, unsigned int endRow, unsigned int width, unsigned int stride);
+        void applyRectOperation(RSGISMorphologyOperation operation, const float *inVals, float *outVals, unsigned int startRow, unsigned int endRow, unsigned int width, unsigned int stride);
+        /** The van Herk/Gil-Werman running min/max of winLen values along n lines: out(i) = op(in(i+winOff) ... in(i+winOff+winLen-1)), for i in [0, n). */
+        void runningMinMax(RSGISMorphologyOperation operation, const float *inVals, float *outVals, long n, long winOff, long winLen, long step, long lineStep, long numLines);
+        void convertToDataType(float *vals, unsigned int nRows, unsigned int width, unsigned int stride, GDALDataType dataType);
+        rsgis::math::Matrix *matrixOperator;
+        int winMid;
+        // The offsets (within the strip buffer) of the operator pixels which are > 0, in the operator order.
+        std::vector<long> opOffsets;
+        std::vector<unsigned char> typeVals;
+        // Are the operator pixels > 0 a rectangle, with the rows and columns (relative to the centre) of the rectangle.
+        bool rectOp;
+        int rectRowStart;
+        int rectRowEnd;
+        int rectColStart;
+        int rectColEnd;
+        std::vector<float> rectVals;
+        std::vector<float> prefixVals;
+        std::vector<float> suffixVals;
+    };
+
+}}
+
+#endif
@@ -33,55 +33,11 @@ namespace rsgis{namespace filter{
     {
         try 
         {
-            if(matrixOperator->n != matrixOperator->m)
-            {
-                throw rsgis::img::RSGISImageCalcException("Morphological operator must be a square matrix.");
-            }
-            
-            rsgis::img::RSGISImageUtils imgUtils;
-            GDALDataset *outDataset = nullptr;
-            GDALDataset *tmpDataset = nullptr;
-            GDALDataset **tmpGDALDataArray = new GDALDataset*[2];
-            
-            outDataset = imgUtils.createCopy(dataset, outputImage, format, outDataType);
-            imgUtils.zerosFloatGDALDataset(outDataset);
-            
-            if(useMemory)
-            {
-                tmpDataset = imgUtils.createCopy(dataset, tempImage, "MEM", outDataType);
-            }
-            else
-            {
-                tmpDataset = imgUtils.createCopy(dataset, tempImage, format, outDataType);
-            }
-            imgUtils.zerosFloatGDALDataset(tmpDataset);
-            
-            
-            rsgis::img::RSGISCalcImageValue *imgErode = new RSGISMorphologyErode(dataset->GetRasterCount(), matrixOperator);
-            rsgis::img::RSGISCalcImage calcImageErode(imgErode);
-            rsgis::img::RSGISCalcImageValue *imgDilate = new RSGISMorphologyDilate(dataset->GetRasterCount(), matrixOperator);
-            rsgis::img::RSGISCalcImage calcImageDilate(imgDilate);
-            rsgis::img::RSGISCalcImageValue *imgDiff = new RSGISMorphologyImageDiff(dataset->GetRasterCount());
-            rsgis::img::RSGISCalcImage calcImageDiff(imgDiff);
-            
-            tmpGDALDataArray[0] = dataset;
-            calcImageDilate.calcImageWindowData(tmpGDALDataArray, 1, outDataset, matrixOperator->n);
-            tmpGDALDataArray[0] = outDataset;
-            calcImageErode.calcImageWindowData(tmpGDALDataArray, 1, tmpDataset, matrixOperator->n);
-            
-            // tmp - input
-            tmpGDALDataArray[0] = tmpDataset;
-            tmpGDALDataArray[1] = dataset;
-            calcImageDiff.calcImage(tmpGDALDataArray, 2, outDataset);
-            
-            delete imgErode;
-            delete imgDilate;
-            delete imgDiff;
-            
-            delete[] tmpGDALDataArray;
-            
-            GDALClose(outDataset);
-            GDALClose(tmpDataset);
+            RSGISImageMorphologySequence morphSeq(matrixOperator);
+            std::vector<RSGISMorphologyOperation> operations;
+            operations.push_back(morphDilate);
+            operations.push_back(morphErode);
+            morphSeq.performSequence(dataset, outputImage, operations, morphResultMinusInput, format, outDataType);
         } 
         catch (rsgis::img::RSGISImageCalcException &e) 
         {
@@ -102,55 +58,11 @@ namespace rsgis{namespace filter{
     {
         try 
         {
-            if(matrixOperator->n != matrixOperator->m)
-            {
-                throw rsgis::img::RSGISImageCalcException("Morphological operator must be a square matrix.");
-            }
-            
-            rsgis::img::RSGISImageUtils imgUtils;
-            GDALDataset *outDataset = NULL;
-            GDALDataset *tmpDataset = NULL;
-            GDALDataset **tmpGDALDataArray = new GDALDataset*[2];
-            
-            outDataset = imgUtils.createCopy(dataset, outputImage, format, outDataType);
-            imgUtils.zerosFloatGDALDataset(outDataset);
-            
-            if(useMemory)
-            {
-                tmpDataset = imgUtils.createCopy(dataset, tempImage, "MEM", outDataType);
-            }
-            else
-            {
-                tmpDataset = imgUtils.createCopy(dataset, tempImage, format, outDataType);
-            }
-            imgUtils.zerosFloatGDALDataset(tmpDataset);
-            
-            
-            rsgis::img::RSGISCalcImageValue *imgErode = new RSGISMorphologyErode(dataset->GetRasterCount(), matrixOperator);
-            rsgis::img::RSGISCalcImage calcImageErode(imgErode);
-            rsgis::img::RSGISCalcImageValue *imgDilate = new RSGISMorphologyDilate(dataset->GetRasterCount(), matrixOperator);
-            rsgis::img::RSGISCalcImage calcImageDilate(imgDilate);
-            rsgis::img::RSGISCalcImageValue *imgDiff = new RSGISMorphologyImageDiff(dataset->GetRasterCount());
-            rsgis::img::RSGISCalcImage calcImageDiff(imgDiff);
-            
-            tmpGDALDataArray[0] = dataset;
-            calcImageErode.calcImageWindowData(tmpGDALDataArray, 1, outDataset, matrixOperator->n);
-            tmpGDALDataArray[0] = outDataset;
-            calcImageDilate.calcImageWindowData(tmpGDALDataArray, 1, tmpDataset, matrixOperator->n);
-            
-            // input - tmp
-            tmpGDALDataArray[0] = dataset;
-            tmpGDALDataArray[1] = tmpDataset;
-            calcImageDiff.calcImage(tmpGDALDataArray, 2, outDataset);
-            
-            delete imgErode;
-            delete imgDilate;
-            delete imgDiff;
-            
-            delete[] tmpGDALDataArray;
-            
-            GDALClose(outDataset);
-            GDALClose(tmpDataset);
+            RSGISImageMorphologySequence morphSeq(matrixOperator);
+            std::vector<RSGISMorphologyOperation> operations;
+            operations.push_back(morphErode);
+            operations.push_back(morphDilate);
+            morphSeq.performSequence(dataset, outputImage, operations, morphInputMinusResult, format, outDataType);
         } 
         catch (rsgis::img::RSGISImageCalcException &e) 
         {
@@ -30,46 +30,26 @@ namespace rsgis{namespace filter{
     
     void RSGISApplyNonLocalDenoising::ApplyFilter(GDALDataset **inputImageDS, int numDS, std::string outputImage, unsigned int filterWindowSize, unsigned int searchWindowSize, double aPar, double hPar, std::string gdalFormat, GDALDataType gdalDataType)
 	{
-        
         rsgis::img::RSGISImageUtils imgUtils;
-        rsgis::math::RSGISVectors vectorUtils;
         
-		double *gdalTranslation = new double[6];
-		int **dsOffsets = new int*[numDS];
+		double gdalTranslation[6];
+		std::vector<int> dsOffsetVals(numDS*2);
+		std::vector<int*> dsOffsets(numDS);
 		for(int i = 0; i < numDS; i++)
 		{
-			dsOffsets[i] = new int[2];
+			dsOffsets[i] = &dsOffsetVals[i*2];
 		}
-		int **bandOffsets = NULL;
 		int height = 0;
 		int width = 0;
 		unsigned int numInBands = 0;
-        unsigned int numOutBands;
         int xBlockSize = 0;
         int yBlockSize = 0;
-        size_t numPxlsInSearchWindow = 0;
-		
-		float **inputDataSearchWindow = NULL;
-		float **outputData = NULL;
-
-        unsigned int searchWindowWidth = searchWindowSize;
-        unsigned int searchWindowHeight = searchWindowSize;
-        unsigned int searchWindowOverlap = 0;
         
-        double invHParSq = -1.0/hPar*hPar;
-        
-        double *swPixelValues = NULL; // Pixel values for search window.
-        double *swPixelWeights = NULL; // Pixel weights for search window.
-		
-		GDALRasterBand **inputRasterBands = NULL;
-		GDALRasterBand **outputRasterBands = NULL;
-        
-        GDALDriver *gdalDriver = NULL;
         GDALDataset *outputImageDS = NULL;
 		
 		try
 		{
-			if(filterWindowSize % 2 == 0)
+			if((filterWindowSize % 2 == 0) || (filterWindowSize < 3))
 			{
 				throw rsgis::img::RSGISImageCalcException("Window size needs to be an odd number (min = 3).");
 			}
@@ -77,429 +57,221 @@ namespace rsgis{namespace filter{
 			{
 				throw rsgis::img::RSGISImageCalcException("Search window size needs to at least twice the filter window size");
 			}
-			unsigned int filterWinPix = floor((float)filterWindowSize / 2); // Number of pixels each side of middle pixel
-			unsigned int windowMid = floor(((float)filterWindowSize)/2.0); // Pixel at centre of block
+			else if(hPar <= 0)
+			{
+				throw rsgis::img::RSGISImageCalcException("The filtering parameter (h) needs to be greater than zero.");
+			}
+			int filterWinPix = filterWindowSize / 2; // Number of pixels each side of middle pixel
+			int searchWinPix = searchWindowSize / 2; // Maximum offset of the search window in each direction
+			int halo = searchWinPix + filterWinPix; // Rows and columns needed around each strip
+			double invHParSq = -1.0/(hPar*hPar);
+			double invNumPatchPxls = 1.0/(filterWindowSize*filterWindowSize);
             
             std::cout << "Search window Size: " << searchWindowSize << std::endl;
             std::cout << "Filter window Size: " << filterWindowSize << std::endl;
             
 			// Find image overlap
-            imgUtils.getImageOverlap(inputImageDS, numDS, dsOffsets, &width, &height, gdalTranslation, &xBlockSize, &yBlockSize);
+            imgUtils.getImageOverlap(inputImageDS, numDS, dsOffsets.data(), &width, &height, gdalTranslation, &xBlockSize, &yBlockSize);
 			
-			// Count number of image bands
+			// Get Image Input Bands
+			std::vector<GDALRasterBand*> inputRasterBands;
+			std::vector<int*> bandOffsets;
 			for(int i = 0; i < numDS; i++)
 			{
-				numInBands += inputImageDS[i]->GetRasterCount();
+				for(int j = 0; j < inputImageDS[i]->GetRasterCount(); j++)
+				{
+					inputRasterBands.push_back(inputImageDS[i]->GetRasterBand(j+1));
+					bandOffsets.push_back(dsOffsets[i]);
+				}
 			}
-            
-            numOutBands = numInBands;
+            numInBands = inputRasterBands.size();
             
 			// Create new Image
-			gdalDriver = GetGDALDriverManager()->GetDriverByName(gdalFormat.c_str());
+			GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(gdalFormat.c_str());
 			if(gdalDriver == NULL)
 			{
 				throw rsgis::img::RSGISImageBandException("Driver does not exists..");
 			}
             char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(gdalFormat);
-			std::cout << "New image width = " << width << " height = " << height << " bands = " << numOutBands << std::endl;
+			std::cout << "New image width = " << width << " height = " << height << " bands = " << numInBands << std::endl;
             
-			outputImageDS = gdalDriver->Create(outputImage.c_str(), width, height, numOutBands, gdalDataType, papszOptions);
-			
+			outputImageDS = gdalDriver->Create(outputImage.c_str(), width, height, numInBands, gdalDataType, papszOptions);
+			CSLDestroy(papszOptions);
 			if(outputImageDS == NULL)
 			{
 				throw rsgis::img::RSGISImageBandException("Output image could not be created. Check filepath.");
 			}
-			
             outputImageDS->SetGeoTransform(gdalTranslation);
             outputImageDS->SetProjection(inputImageDS[0]->GetProjectionRef());
             
-			// Get Image Input Bands
-			bandOffsets = new int*[numInBands];
-			inputRasterBands = new GDALRasterBand*[numInBands];
-			int counter = 0;
-			for(int i = 0; i < numDS; i++)
-			{
-				for(int j = 0; j < inputImageDS[i]->GetRasterCount(); j++)
-				{
-					inputRasterBands[counter] = inputImageDS[i]->GetRasterBand(j+1);
-					bandOffsets[counter] = new int[2];
-					bandOffsets[counter][0] = dsOffsets[i][0];
-					bandOffsets[counter][1] = dsOffsets[i][1];
-					counter++;
-				}
-			}
-			
-			//Get Image Output Bands
-			outputRasterBands = new GDALRasterBand*[numOutBands];
-			for(int i = 0; i < numOutBands; i++)
-			{
-				outputRasterBands[i] = outputImageDS->GetRasterBand(i+1);
-			}
+            rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+            // Per pixel of a strip: the input, the sums of the weights and weighted values and the output.
+            int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, numInBands*((2*sizeof(float)) + (2*sizeof(double))), context.stripMemoryMB);
+            stripRows = std::max(1, std::min(stripRows, height));
+            size_t nStrips = (height + stripRows - 1) / stripRows;
+            size_t padWidth = width + (2*halo);
+            size_t padRows = stripRows + (2*halo);
             
-            // Subset window as multiple of block size.
-            int outXBlockSize = 0;
-            int outYBlockSize = 0;
-            inputRasterBands[0]->GetBlockSize (&outXBlockSize, &outYBlockSize);
+            // The input strips, padded by the halo, and filtered outputs for each I/O buffer.
+            rsgis::RSGISStripIOPipeline ioPipeline(context.numIOBuffers);
+            unsigned int nIOBufs = ioPipeline.getNumBuffers();
+            std::vector<std::vector<std::vector<float> > > inData(nIOBufs, std::vector<std::vector<float> >(numInBands, std::vector<float>(padWidth*padRows)));
+            std::vector<std::vector<std::vector<float> > > outData(nIOBufs, std::vector<std::vector<float> >(numInBands, std::vector<float>(((size_t)width)*stripRows)));
+            std::vector<double> sumWeights(((size_t)width)*stripRows);
+            std::vector<double> sumValues(((size_t)width)*stripRows);
             
-            std::cout << "outXBlockSize = " << outXBlockSize << ", outYBlockSize = " << outYBlockSize << std::endl;
+            rsgis::RSGISThreadPool threadPool(context.numThreads);
+            // The integral image of the squared differences of each thread (with the patch rows and columns around its rows).
+            size_t intWidth = width + (2*filterWinPix) + 1;
+            std::vector<std::vector<double> > intImages(threadPool.getNumThreads());
             
-            // Set search window height and width so multiples of block size
-            if(searchWindowWidth > outXBlockSize)
+            rsgis_tqdm pbar;
+            auto stripNumRows = [&](size_t strip)
             {
-                searchWindowWidth =  floor((float)searchWindowWidth / outXBlockSize) + outXBlockSize;
-            }
-            if(searchWindowHeight > outYBlockSize)
+                return std::min<int>(stripRows, height - (strip*stripRows));
+            };
+            auto readStrip = [&](size_t strip, unsigned int buf)
             {
-                searchWindowHeight = floor((float)searchWindowHeight / outYBlockSize) + outYBlockSize;
-            }
-            searchWindowOverlap = filterWindowSize*2;
-            if(searchWindowOverlap < outYBlockSize)
-            {
-                searchWindowOverlap = outYBlockSize;
-            }
-            
-			// Allocate memory
-            numPxlsInSearchWindow = searchWindowWidth*searchWindowHeight;
-            inputDataSearchWindow = new float*[numInBands];
-			for(int i = 0; i < numInBands; i++)
-			{
-                inputDataSearchWindow[i] = (float *) CPLMalloc(sizeof(float)*numPxlsInSearchWindow);
-                for(int k = 0; k < numPxlsInSearchWindow; k++)
+                int row = strip*stripRows;
+                int nRows = stripNumRows(strip);
+                int readStart = std::max(0, row - halo);
+                int readEnd = std::min(height, row + nRows + halo);
+                size_t padStart = readStart - (row - halo);
+                size_t padEnd = padStart + (readEnd - readStart);
+                for(unsigned int n = 0; n < numInBands; n++)
                 {
-                    inputDataSearchWindow[i][k] = 0;
+                    float *bandData = inData[buf][n].data();
+                    if(inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], bandOffsets[n][1] + readStart, width, readEnd - readStart, bandData + (padStart*padWidth) + halo, width, readEnd - readStart, GDT_Float32, sizeof(float), ((GSpacing)padWidth)*sizeof(float)) != CE_None)
+                    {
+                        throw rsgis::img::RSGISImageCalcException("Failed to read the input image data.");
+                    }
+                    // Replicate the edges of the image into the halo.
+                    for(size_t y = padStart; y < padEnd; ++y)
+                    {
+                        float *padRow = bandData + (y*padWidth);
+                        std::fill(padRow, padRow + halo, padRow[halo]);
+                        std::fill(padRow + halo + width, padRow + padWidth, padRow[halo + width - 1]);
+                    }
+                    for(size_t y = 0; y < padStart; ++y)
+                    {
+                        std::copy(bandData + (padStart*padWidth), bandData + ((padStart+1)*padWidth), bandData + (y*padWidth));
+                    }
+                    for(size_t y = padEnd; y < padRows; ++y)
+                    {
+                        std::copy(bandData + ((padEnd-1)*padWidth), bandData + (padEnd*padWidth), bandData + (y*padWidth));
+                    }
                 }
-			}
-			
-			outputData = new float*[numOutBands];
-			for(int i = 0; i < numOutBands; i++)
-			{
-				outputData[i] = (float *) CPLMalloc(sizeof(float)*numPxlsInSearchWindow);
-			}
-			
-            // Set up GSL vector for data to be filtered.
-            gsl_vector *inDataVector =  gsl_vector_alloc(filterWindowSize*filterWindowSize);
-            gsl_vector *inSearchBlockVector =  gsl_vector_alloc(filterWindowSize*filterWindowSize);
-            
-            //gsl_matrix *gaussKernel = gsl_matrix_alloc(filterWindowSize*filterWindowSize,filterWindowSize*filterWindowSize);
-            
-            swPixelValues = new double[numPxlsInSearchWindow];
-            swPixelWeights = new double[numPxlsInSearchWindow];
-            
-            // Initialise top corner at common overlap.
-            unsigned int startSearchX = bandOffsets[0][0];
-            unsigned int startSearchY = bandOffsets[0][1];
-            
-            unsigned int maxSearchX = width - searchWindowWidth;
-            unsigned int maxSearchY = height - searchWindowHeight;
-            unsigned int searchWinOffsetX = 0; // Offset for start pixel in search window
-            //unsigned int searchWinOffsetY = 0; // Offset for end pixel in search window
-            
-            std::cout << "height = " << height << ", searchWindowHeight = " << searchWindowHeight << std::endl;
-            std::cout << "width = " << width << ", searchWindowWidth = " << searchWindowWidth << std::endl;
-            
-            //unsigned int feedback = height*width / 10.0;
-			//int feedbackCounter = 0;
-			std::cout << "Started" << std::flush;
-			
-            while (startSearchY < maxSearchY)
+            };
+            auto computeStrip = [&](size_t strip, unsigned int buf)
             {
-                std::cout << "startSearchY = " << startSearchY << ", maxSearchY = " << maxSearchY << std::endl;
-                
-                startSearchX = 0; // Reset X
-                std::cout << "startSearchX = " << startSearchX << ", maxSearchX = " << maxSearchX << std::endl;
-                while (startSearchX < maxSearchX)
+                int row = strip*stripRows;
+                int nRows = stripNumRows(strip);
+                pbar.progress(row, height);
+                for(unsigned int n = 0; n < numInBands; n++)
                 {
-                    
-                    // Read search window into memory
-                    for(int n = 0; n < numOutBands; n++)
-                    {
-                        inputRasterBands[n]->RasterIO(GF_Read, startSearchX, startSearchY, searchWindowWidth, searchWindowHeight, inputDataSearchWindow[n], searchWindowWidth, searchWindowHeight, GDT_Float32, 0, 0);
-                    }
-                    
-                    // Loop through pixels in search window
-                    unsigned int cPxl = 0;
-                    for(unsigned int i = 0; i < searchWindowHeight; ++i)
+                    const float *bandData = inData[buf][n].data();
+                    threadPool.parallelFor(0, nRows, [&](unsigned int t, size_t rStart, size_t rEnd)
                     {
-                        searchWinOffsetX = 0; // Reset x offset
-                        for(unsigned int j = 0; j < searchWindowWidth; ++j)
+                        size_t nThreadRows = rEnd - rStart;
+                        size_t intRows = nThreadRows + (2*filterWinPix) + 1;
+                        std::vector<double> &intImage = intImages[t];
+                        intImage.assign(intRows*intWidth, 0.0);
+                        std::fill(sumWeights.begin() + (rStart*width), sumWeights.begin() + (rEnd*width), 0.0);
+                        std::fill(sumValues.begin() + (rStart*width), sumValues.begin() + (rEnd*width), 0.0);
+                        
+                        for(int dy = -searchWinPix; dy <= searchWinPix; ++dy)
                         {
-                            // Get data block
-                            int startDataBlockX = j - filterWinPix;
-                            int startDataBlockY = i - filterWinPix;
-                            int endDataBlockX = j + filterWinPix;
-                            int endDataBlockY = i + filterWinPix;
-                            
-                            if (startDataBlockX < 0)
-                            {
-                                startDataBlockX = 0;
-                                endDataBlockX = filterWindowSize;
-                            }
-                            if (startDataBlockY < 0)
-                            {
-                                startDataBlockY = 0;
-                                endDataBlockY = filterWindowSize;
-                            }
-                            if (endDataBlockX >= searchWindowWidth)
+                            for(int dx = -searchWinPix; dx <= searchWinPix; ++dx)
                             {
-                                startDataBlockX = searchWindowWidth-filterWinPix;
-                                endDataBlockX = searchWindowWidth;
-                            }
-                            if (endDataBlockY >= searchWindowHeight)
-                            {
-                                startDataBlockY = searchWindowHeight-filterWinPix;
-                                endDataBlockY = searchWindowHeight;
-                            }
-                            
-                            for(int n = 0; n < numOutBands; n++)
-                            {
-                                
-                                // Get vector for data block
-                                unsigned int pixVecNum = 0;
-                                for(unsigned int y = startDataBlockY;y < endDataBlockY; ++y)
+                                // Integral image of the squared differences with the offset image over the
+                                // rows of this thread and the surrounding patch pixels.
+                                for(size_t y = 1; y < intRows; ++y)
                                 {
-                                    for(unsigned int x = startDataBlockX; x < endDataBlockX; ++x)
+                                    const float *pxlRow = bandData + (((rStart + y - 1 + halo - filterWinPix)*padWidth) + (halo - filterWinPix));
+                                    const float *offRow = pxlRow + ((((long)dy)*((long)padWidth)) + dx);
+                                    const double *intPrev = intImage.data() + ((y-1)*intWidth);
+                                    double *intRow = intImage.data() + (y*intWidth);
+                                    double rowSum = 0;
+                                    for(size_t x = 1; x < intWidth; ++x)
                                     {
-                                        double pixVal = inputDataSearchWindow[n][(y*searchWindowWidth)+x];
-                                        gsl_vector_set(inDataVector, pixVecNum, pixVal);
-                                        ++pixVecNum;
+                                        double diff = pxlRow[x-1] - offRow[x-1];
+                                        rowSum += diff * diff;
+                                        intRow[x] = intPrev[x] + rowSum;
                                     }
                                 }
                                 
-                                // Calculate pixel values and weights for all blocks in search window
-                                unsigned int swValNum = 0;
-                                for(unsigned int searchWinY = 0; searchWinY < searchWindowHeight; ++searchWinY)
+                                // Only pixels within the image are used to estimate the denoised values.
+                                int xStart = std::max(0, -dx);
+                                int xEnd = std::min(width, width - dx);
+                                for(size_t r = rStart; r < rEnd; ++r)
                                 {
-                                    for(unsigned int searchWinX = 0; searchWinX < searchWindowWidth; ++searchWinX)
+                                    int offImgRow = row + r + dy;
+                                    if((offImgRow < 0) || (offImgRow >= height))
                                     {
-                                        // Get data block
-                                        int startSearchBlockX = j - filterWinPix;
-                                        int startSearchBlockY = i - filterWinPix;
-                                        int endSearchBlockX = j + filterWinPix;
-                                        int endSearchBlockY = i + filterWinPix;
-                                        
-                                        if (startSearchBlockX < 0)
-                                        {
-                                            startSearchBlockX = 0;
-                                            endSearchBlockX = filterWindowSize;
-                                        }
-                                        if (startSearchBlockY < 0)
-                                        {
-                                            startSearchBlockY = 0;
-                                            endSearchBlockY = filterWindowSize;
-                                        }
-                                        if (endSearchBlockX >= searchWindowWidth)
-                                        {
-                                            startSearchBlockX = searchWindowWidth-filterWinPix;
-                                            endSearchBlockX = searchWindowWidth;
-                                        }
-                                        if (endSearchBlockY >= searchWindowHeight)
-                                        {
-                                            startSearchBlockY = searchWindowHeight-filterWinPix;
-                                            endSearchBlockY = searchWindowHeight;
-                                        }
-                                                                                    
-                                        // Add to GSL vector
-                                        unsigned int pixVecNum = 0;
-                                        for(unsigned int y = startSearchBlockY;y < endSearchBlockY; ++y)
-                                        {
-                                            for(unsigned int x = startSearchBlockX; x < endSearchBlockX; ++x)
-                                            {
-                                                double pixVal = inputDataSearchWindow[n][(y*searchWindowWidth)+x];
-                                                double pixelDiff = pixVal - gsl_vector_get(inDataVector, pixVecNum);
-                                                gsl_vector_set(inSearchBlockVector, pixVecNum, pixelDiff);
-                                                
-                                                if((x == windowMid) && (y == windowMid))
-                                                {
-                                                    // Add centre pixel value to vector.
-                                                    swPixelValues[swValNum] = pixVal;
-                                                }
-                                                
-                                                ++pixVecNum;
-                                            }
-                                        }
-                                        
-                                        // Calculate weights
-                                        // v(Ni) . Gauss . v(Nj)
-                                        double inBlockSearchBlockGDiff = vectorUtils.dotProductVectorVectorGSL(inSearchBlockVector, inSearchBlockVector);
-                                        double swPixWeight = exp(invHParSq * inBlockSearchBlockGDiff);
-                                        
-                                        swPixelWeights[swValNum] = swPixWeight;
-                                        ++swValNum;
-
+                                        continue;
+                                    }
+                                    const double *intTop = intImage.data() + ((r - rStart)*intWidth);
+                                    const double *intBottom = intTop + ((2*filterWinPix + 1)*intWidth);
+                                    const float *offRow = bandData + (((r + halo + dy)*padWidth) + halo + dx);
+                                    double *rowWeights = sumWeights.data() + (r*width);
+                                    double *rowValues = sumValues.data() + (r*width);
+                                    for(int x = xStart; x < xEnd; ++x)
+                                    {
+                                        size_t x2 = x + (2*filterWinPix) + 1;
+                                        double patchDist = (intBottom[x2] - intTop[x2] - intBottom[x] + intTop[x]) * invNumPatchPxls;
+                                        double weight = exp(invHParSq * patchDist);
+                                        rowWeights[x] += weight;
+                                        rowValues[x] += weight * offRow[x];
                                     }
                                 }
-                                
-                                // Estimate denoised pixel values
-                                
-                                // Calculate sum of weights
-                                double sumWeights = 0;
-                                for(unsigned int w=0; w < numPxlsInSearchWindow; ++w)
-                                {
-                                    sumWeights+=swPixelWeights[w];
-                                }
-                                
-                                // Calculate weighted mean
-                                double denoisedPixVal = 0;
-                                double weightPixVal = 0;
-                                
-                                for(unsigned int w=0; w < numPxlsInSearchWindow; ++w)
-                                {
-                                    weightPixVal = (1. / sumWeights) * swPixelWeights[w] * swPixelValues[w];
-                                    denoisedPixVal+= weightPixVal;
-                                }
- 
-                                // Save filterd pixel value to output column
-                                outputData[n][cPxl] = denoisedPixVal;
-                                
                             }
-                            if(cPxl % 100 == 0){std::cout << cPxl << std::endl;}
-                            ++cPxl;
                         }
-                    }
-                    
-                    for(int n = 0; n < numOutBands; n++)
+                        
+                        // The offset (0,0) has a weight of 1 so the sum of the weights is always at least 1.
+                        float *outBand = outData[buf][n].data();
+                        for(size_t k = rStart*width; k < rEnd*width; ++k)
+                        {
+                            outBand[k] = sumValues[k] / sumWeights[k];
+                        }
+                    });
+                }
+            };
+            auto writeStrip = [&](size_t strip, unsigned int buf)
+            {
+                int row = strip*stripRows;
+                int nRows = stripNumRows(strip);
+                for(unsigned int n = 0; n < numInBands; n++)
+                {
+                    if(outputImageDS->GetRasterBand(n+1)->RasterIO(GF_Write, 0, row, width, nRows, outData[buf][n].data(), width, nRows, GDT_Float32, 0, 0) != CE_None)
                     {
-                        outputRasterBands[n]->RasterIO(GF_Write, startSearchX, startSearchY, searchWindowWidth, searchWindowHeight, outputData[n], searchWindowWidth, searchWindowHeight, GDT_Float32, 0, 0);
+                        throw rsgis::img::RSGISImageCalcException("Failed to write the output image data.");
                     }
-                    startSearchX+=searchWindowWidth;
                 }
-                startSearchY+=searchWindowWidth;
-            }
-
+            };
+            
+            std::cout << "Started" << std::endl;
+            ioPipeline.run(nStrips, readStrip, computeStrip, writeStrip);
+            pbar.finish();
             std::cout << " Complete.\n";
 		}
 		catch(rsgis::img::RSGISImageCalcException& e)
 		{
-			if(gdalTranslation != NULL)
-			{
-				delete[] gdalTranslation;
-			}
-			
-			if(dsOffsets != NULL)
-			{
-				for(int i = 0; i < numDS; i++)
-				{
-					delete dsOffsets[i];
-				}
-				delete[] dsOffsets;
-			}
-			
-			if(bandOffsets != NULL)
-			{
-				for(int i = 0; i < numInBands; i++)
-				{
-					delete bandOffsets[i];
-				}
-				delete[] bandOffsets;
-			}
-            
-            if(inputDataSearchWindow != NULL)
+			if(outputImageDS != NULL)
 			{
-				for(int i = 0; i < numInBands; i++)
-				{
-					delete[] inputDataSearchWindow[i];
-				}
-				delete[] inputDataSearchWindow;
-			}
-			
-			if(outputData != NULL)
-			{
-				for(int i = 0; i < numOutBands; i++)
-				{
-					delete outputData[i];
-				}
-				delete outputData;
+				GDALClose(outputImageDS);
 			}
-            
 			throw e;
 		}
 		catch(rsgis::img::RSGISImageBandException& e)
 		{
-			if(gdalTranslation != NULL)
+			if(outputImageDS != NULL)
 			{
-				delete[] gdalTranslation;
+				GDALClose(outputImageDS);
 			}
-			
-			if(dsOffsets != NULL)
-			{
-				for(int i = 0; i < numDS; i++)
-				{
-					delete dsOffsets[i];
-				}
-				delete[] dsOffsets;
-			}
-			
-			if(bandOffsets != NULL)
-			{
-				for(int i = 0; i < numInBands; i++)
-				{
-					delete bandOffsets[i];
-				}
-				delete[] bandOffsets;
-			}
-            
-            if(inputDataSearchWindow != NULL)
-			{
-				for(int i = 0; i < numInBands; i++)
-				{
-					delete[] inputDataSearchWindow[i];
-				}
-				delete[] inputDataSearchWindow;
-			}
-			
-			if(outputData != NULL)
-			{
-				for(int i = 0; i < numOutBands; i++)
-				{
-					delete outputData[i];
-				}
-				delete outputData;
-			}
-			
 			throw e;
 		}
 		
-		if(gdalTranslation != NULL)
-		{
-			delete[] gdalTranslation;
-		}
-		
-		if(dsOffsets != NULL)
-		{
-			for(int i = 0; i < numDS; i++)
-			{
-				delete dsOffsets[i];
-			}
-			delete[] dsOffsets;
-		}
-		
-		if(bandOffsets != NULL)
-		{
-			for(int i = 0; i < numInBands; i++)
-			{
-				delete bandOffsets[i];
-			}
-			delete[] bandOffsets;
-		}
-        
-        if(inputDataSearchWindow != NULL)
-        {
-            for(int i = 0; i < numInBands; i++)
-            {
-                delete[] inputDataSearchWindow[i];
-            }
-            delete[] inputDataSearchWindow;
-        }
-        
-		if(outputData != NULL)
-		{
-			for(int i = 0; i < numOutBands; i++)
-			{
-				delete outputData[i];
-			}
-			delete outputData;
-		}
-		
+		GDALClose(outputImageDS);
 	}
 	
 	
@@ -24,17 +24,17 @@
 #define RSGISNonLocalDenoising_H
 
 #include <iostream>
-
-#include <gsl/gsl_vector.h>
-#include <gsl/gsl_matrix.h>
+#include <vector>
+#include <cmath>
+#include <algorithm>
 
 #include "gdal_priv.h"
 
 #include "common/rsgis-tqdm.h"
 #include "common/RSGISImageException.h"
-
-#include "math/RSGISMatrices.h"
-#include "math/RSGISVectors.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISStripIOPipeline.h"
+#include "common/RSGISThreadPool.h"
 
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISImageCalcException.h"
@@ -63,7 +63,20 @@ namespace rsgis{namespace filter{
          
             Buades, A., Coll, B. & Morel, J.M., A non-local algorithm for image denoising. 2005.
             IEEE Computer Society Conference on Computer Vision and Pattern Recognition.
-
+         
+            The patch distances are calculated with the integral image formulation of:
+         
+            Darbon, J., Cunha, A., Chan, T.F., Osher, S. & Jensen, G.J., Fast nonlocal filtering
+            applied to electron cryomicroscopy. 2008. IEEE International Symposium on Biomedical Imaging.
+         
+            For each offset within the search window the squared differences between the image and
+            the offset image are summed into an integral image, so the distance between any pair of
+            patches is found in constant time rather than O(filterWindowSize^2). Each band is denoised
+            independently, with the weight of a pixel exp(-d/hPar^2) where d is the mean squared
+            difference between the patches. The image is processed in strips (with a halo of half the
+            search and filter windows, replicating the image edges), with the rows of each strip split
+            between the threads of the default rsgis::RSGISExecutionContext. The patches are uniformly
+            weighted (which the integral image requires) so aPar is not used.
          */
         
     public: 
@@ -21,6 +21,7 @@
  */
 
 #include "RSGISPrewittFilter.h"
+#include "common/RSGISGDALInit.h"
 
 
 namespace rsgis{namespace filter{
@@ -123,7 +124,7 @@ namespace rsgis{namespace filter{
 	
 	void RSGISPrewittFilter::exportAsImage(std::string filename)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		GDALDataset *outputImageDS = nullptr;
 		GDALRasterBand *outputRasterBand = nullptr;
 		GDALDriver *gdalDriver = nullptr;
@@ -24,7 +24,7 @@
 
 namespace rsgis{namespace filter{
 
-    RSGISNormVarPowerFilter::RSGISNormVarPowerFilter(int numberOutBands, int size, std::string filenameEnding) : RSGISImageFilter(numberOutBands, size, filenameEnding){}
+    RSGISNormVarPowerFilter::RSGISNormVarPowerFilter(int numberOutBands, int size, std::string filenameEnding) : RSGISImageFilter(numberOutBands, size, filenameEnding), winMoments(rsgis_moment_value){}
 
     void RSGISNormVarPowerFilter::calcImageValue(float ***dataBlock, int numBands, int winSize, double *output) 
 	{
@@ -81,7 +81,56 @@ namespace rsgis{namespace filter{
 	}
 
 
-    RSGISNormVarAmplitudeFilter::RSGISNormVarAmplitudeFilter(int numberOutBands, int size, std::string filenameEnding) : RSGISImageFilter(numberOutBands, size, filenameEnding){}
+    bool RSGISNormVarPowerFilter::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+    {
+        this->winMoments.initWindow(winData, stride, numBands, winSize);
+        this->calcWindowOutput(winData, stride, 0, numBands, output);
+        return true;
+    }
+
+    bool RSGISNormVarPowerFilter::calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output)
+    {
+        this->winMoments.slideWindow(inColumn, stride);
+        // The window now starts one column to the right of outColumn.
+        this->calcWindowOutput(outColumn, stride, 1, numBands, output);
+        return true;
+    }
+
+    void RSGISNormVarPowerFilter::calcWindowOutput(const float* const* winData, size_t stride, size_t colOffset, int numBands, double *output)
+    {
+        unsigned int middleVal = floor(((float)this->size) / 2);
+        unsigned int numVal = 0;
+        double sumA = 0;
+        double sumB = 0;
+        for(int i = 0; i < numBands; i++)
+        {
+            // Check for data at the centre of the block (skip if no data to preserve scene edges)
+            float centreVal = winData[i][(middleVal * stride) + colOffset + middleVal];
+            if((centreVal == 0) | ((boost::math::isnan)(centreVal)))
+            {
+                output[i] = 0;
+                continue;
+            }
+
+            this->winMoments.getMoments(i, &numVal, &sumA, &sumB);
+
+            // Check there were at least three data values
+            if(numVal > 3)
+            {
+                // (mean(I^2) / mean(I)^2) - 1, i.e., var(I) / mean(I)^2.
+                double shiftMean = sumA / numVal;
+                double iMean = this->winMoments.getShift(i) + shiftMean;
+                double iVar = (sumB / numVal) - (shiftMean * shiftMean);
+                output[i] = iVar / (iMean * iMean);
+            }
+            else
+            {
+                output[i] = 0;
+            }
+        }
+    }
+
+    RSGISNormVarAmplitudeFilter::RSGISNormVarAmplitudeFilter(int numberOutBands, int size, std::string filenameEnding) : RSGISImageFilter(numberOutBands, size, filenameEnding), winMoments(rsgis_moment_sqrtvalue){}
 
     void RSGISNormVarAmplitudeFilter::calcImageValue(float ***dataBlock, int numBands, int winSize, double *output) 
 	{
@@ -137,7 +186,54 @@ namespace rsgis{namespace filter{
 	}
 
 
-    RSGISNormVarLnPowerFilter::RSGISNormVarLnPowerFilter(int numberOutBands, int size, std::string filenameEnding) : RSGISImageFilter(numberOutBands, size, filenameEnding){}
+    bool RSGISNormVarAmplitudeFilter::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+    {
+        this->winMoments.initWindow(winData, stride, numBands, winSize);
+        this->calcWindowOutput(winData, stride, 0, numBands, output);
+        return true;
+    }
+
+    bool RSGISNormVarAmplitudeFilter::calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output)
+    {
+        this->winMoments.slideWindow(inColumn, stride);
+        // The window now starts one column to the right of outColumn.
+        this->calcWindowOutput(outColumn, stride, 1, numBands, output);
+        return true;
+    }
+
+    void RSGISNormVarAmplitudeFilter::calcWindowOutput(const float* const* winData, size_t stride, size_t colOffset, int numBands, double *output)
+    {
+        unsigned int middleVal = floor(((float)this->size) / 2);
+        unsigned int numVal = 0;
+        double sumA = 0;
+        double sumB = 0;
+        for(int i = 0; i < numBands; i++)
+        {
+            // Check for data at the centre of the block (skip if no data to preserve scene edges)
+            float centreVal = winData[i][(middleVal * stride) + colOffset + middleVal];
+            if((centreVal == 0) | ((boost::math::isnan)(centreVal)))
+            {
+                output[i] = 0;
+                continue;
+            }
+
+            this->winMoments.getMoments(i, &numVal, &sumA, &sumB);
+
+            // Check there were at least three data values
+            if(numVal > 3)
+            {
+                double iMean = sumA / numVal;
+                double iSqMean = sumB / numVal;
+                output[i] = (iSqMean / (iMean * iMean)) - 1;
+            }
+            else
+            {
+                output[i] = 0;
+            }
+        }
+    }
+
+    RSGISNormVarLnPowerFilter::RSGISNormVarLnPowerFilter(int numberOutBands, int size, std::string filenameEnding) : RSGISImageFilter(numberOutBands, size, filenameEnding), winMoments(rsgis_moment_lnvalue){}
 
     void RSGISNormVarLnPowerFilter::calcImageValue(float ***dataBlock, int numBands, int winSize, double *output) 
 	{
@@ -192,7 +288,54 @@ namespace rsgis{namespace filter{
         }
 	}
 
-    RSGISNormLnFilter::RSGISNormLnFilter(int numberOutBands, int size, std::string filenameEnding) : RSGISImageFilter(numberOutBands, size, filenameEnding){}
+    bool RSGISNormVarLnPowerFilter::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+    {
+        this->winMoments.initWindow(winData, stride, numBands, winSize);
+        this->calcWindowOutput(winData, stride, 0, numBands, output);
+        return true;
+    }
+
+    bool RSGISNormVarLnPowerFilter::calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output)
+    {
+        this->winMoments.slideWindow(inColumn, stride);
+        // The window now starts one column to the right of outColumn.
+        this->calcWindowOutput(outColumn, stride, 1, numBands, output);
+        return true;
+    }
+
+    void RSGISNormVarLnPowerFilter::calcWindowOutput(const float* const* winData, size_t stride, size_t colOffset, int numBands, double *output)
+    {
+        unsigned int middleVal = floor(((float)this->size) / 2);
+        unsigned int numVal = 0;
+        double sumA = 0;
+        double sumB = 0;
+        for(int i = 0; i < numBands; i++)
+        {
+            // Check for data at the centre of the block (skip if no data to preserve scene edges)
+            float centreVal = winData[i][(middleVal * stride) + colOffset + middleVal];
+            if((centreVal == 0) | ((boost::math::isnan)(centreVal)))
+            {
+                output[i] = 0;
+                continue;
+            }
+
+            this->winMoments.getMoments(i, &numVal, &sumA, &sumB);
+
+            // Check there were at least three data values
+            if(numVal > 3)
+            {
+                double iMean = sumA / numVal;
+                double iSqMean = sumB / numVal;
+                output[i] = (iSqMean / (iMean * iMean)) - 1;
+            }
+            else
+            {
+                output[i] = 0;
+            }
+        }
+    }
+
+    RSGISNormLnFilter::RSGISNormLnFilter(int numberOutBands, int size, std::string filenameEnding) : RSGISImageFilter(numberOutBands, size, filenameEnding), winMoments(rsgis_moment_valueln){}
 
     void RSGISNormLnFilter::calcImageValue(float ***dataBlock, int numBands, int winSize, double *output) 
 	{
@@ -247,7 +390,54 @@ namespace rsgis{namespace filter{
         }
 	}
 
-    RSGISTextureVar::RSGISTextureVar(int numberOutBands, int size, std::string filenameEnding) : RSGISImageFilter(numberOutBands, size, filenameEnding){}
+    bool RSGISNormLnFilter::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+    {
+        this->winMoments.initWindow(winData, stride, numBands, winSize);
+        this->calcWindowOutput(winData, stride, 0, numBands, output);
+        return true;
+    }
+
+    bool RSGISNormLnFilter::calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output)
+    {
+        this->winMoments.slideWindow(inColumn, stride);
+        // The window now starts one column to the right of outColumn.
+        this->calcWindowOutput(outColumn, stride, 1, numBands, output);
+        return true;
+    }
+
+    void RSGISNormLnFilter::calcWindowOutput(const float* const* winData, size_t stride, size_t colOffset, int numBands, double *output)
+    {
+        unsigned int middleVal = floor(((float)this->size) / 2);
+        unsigned int numVal = 0;
+        double sumA = 0;
+        double sumB = 0;
+        for(int i = 0; i < numBands; i++)
+        {
+            // Check for data at the centre of the block (skip if no data to preserve scene edges)
+            float centreVal = winData[i][(middleVal * stride) + colOffset + middleVal];
+            if((centreVal == 0) | ((boost::math::isnan)(centreVal)))
+            {
+                output[i] = 0;
+                continue;
+            }
+
+            this->winMoments.getMoments(i, &numVal, &sumA, &sumB);
+
+            // Check there were at least three data values
+            if(numVal > 3)
+            {
+                double iMeanLn = log(sumA / numVal);
+                double iLnMean = sumB / numVal;
+                output[i] = iLnMean - iMeanLn;
+            }
+            else
+            {
+                output[i] = 0;
+            }
+        }
+    }
+
+    RSGISTextureVar::RSGISTextureVar(int numberOutBands, int size, std::string filenameEnding) : RSGISImageFilter(numberOutBands, size, filenameEnding), winMoments(rsgis_moment_value){}
 
     void RSGISTextureVar::calcImageValue(float ***dataBlock, int numBands, int winSize, double *output) 
 	{
@@ -314,4 +504,57 @@ namespace rsgis{namespace filter{
         }
 	}
 
+    bool RSGISTextureVar::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+    {
+        this->winMoments.initWindow(winData, stride, numBands, winSize);
+        this->calcWindowOutput(winData, stride, 0, numBands, output);
+        return true;
+    }
+
+    bool RSGISTextureVar::calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output)
+    {
+        this->winMoments.slideWindow(inColumn, stride);
+        // The window now starts one column to the right of outColumn.
+        this->calcWindowOutput(outColumn, stride, 1, numBands, output);
+        return true;
+    }
+
+    void RSGISTextureVar::calcWindowOutput(const float* const* winData, size_t stride, size_t colOffset, int numBands, double *output)
+    {
+        unsigned int middleVal = floor(((float)this->size) / 2);
+        unsigned int numVal = 0;
+        double sumA = 0;
+        double sumB = 0;
+        for(int i = 0; i < numBands; i++)
+        {
+            // Check for data at the centre of the block (skip if no data to preserve scene edges)
+            float centreVal = winData[i][(middleVal * stride) + colOffset + middleVal];
+            if((centreVal == 0) | ((boost::math::isnan)(centreVal)))
+            {
+                output[i] = 0;
+                continue;
+            }
+
+            this->winMoments.getMoments(i, &numVal, &sumA, &sumB);
+
+            // Check there were at least three data values
+            if(numVal > 3)
+            {
+                double shiftMean = sumA / numVal;
+                double iMean = this->winMoments.getShift(i) + shiftMean;
+                double iVar = (sumB / numVal) - (shiftMean * shiftMean);
+                if(iVar < 0)
+                {
+                    iVar = 0;
+                }
+                double stDev = sqrt(iVar);
+                output[i] = (pow((stDev / iMean),2)-(1/numVal))/(1+(1/numVal));
+            }
+            else
+            {
+                output[i] = 0;
+            }
+        }
+    }
+
 }}
@@ -31,6 +31,7 @@
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 #include "filtering/RSGISImageFilter.h"
+#include "filtering/RSGISWindowMoments.h"
 
 #include <boost/math/special_functions/fpclassify.hpp>
 
@@ -63,9 +64,15 @@ namespace rsgis{namespace filter{
 
         RSGISNormVarPowerFilter(int numberOutBands, int size, std::string filenameEnding);
         virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+        virtual bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+        virtual bool calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output);
+        virtual rsgis::img::RSGISCalcImageValue* clone(){return new RSGISNormVarPowerFilter(this->numOutBands, this->size, this->filenameEnding);};
         virtual bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) {throw RSGISImageFilterException("Not implemented for NVarPower filter!");};;
         virtual void exportAsImage(std::string filename){throw RSGISImageFilterException("No image to output!");};
         ~RSGISNormVarPowerFilter(){};
+    protected:
+        void calcWindowOutput(const float* const* winData, size_t stride, size_t colOffset, int numBands, double *output);
+        RSGISWindowMoments winMoments;
     };
 
     class DllExport RSGISNormVarAmplitudeFilter : public RSGISImageFilter
@@ -82,9 +89,15 @@ namespace rsgis{namespace filter{
 
         RSGISNormVarAmplitudeFilter(int numberOutBands, int size, std::string filenameEnding);
         virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+        virtual bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+        virtual bool calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output);
+        virtual rsgis::img::RSGISCalcImageValue* clone(){return new RSGISNormVarAmplitudeFilter(this->numOutBands, this->size, this->filenameEnding);};
         virtual bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) {throw RSGISImageFilterException("Not implemented for NVarAmplitude filter!");};;
         virtual void exportAsImage(std::string filename){throw RSGISImageFilterException("No image to output!");};
         ~RSGISNormVarAmplitudeFilter(){};
+    protected:
+        void calcWindowOutput(const float* const* winData, size_t stride, size_t colOffset, int numBands, double *output);
+        RSGISWindowMoments winMoments;
     };
 
     class DllExport RSGISNormVarLnPowerFilter : public RSGISImageFilter
@@ -101,9 +114,15 @@ namespace rsgis{namespace filter{
 
         RSGISNormVarLnPowerFilter(int numberOutBands, int size, std::string filenameEnding);
         virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+        virtual bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+        virtual bool calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output);
+        virtual rsgis::img::RSGISCalcImageValue* clone(){return new RSGISNormVarLnPowerFilter(this->numOutBands, this->size, this->filenameEnding);};
         virtual bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) {throw RSGISImageFilterException("Not implemented for NVarLogPower filter!");};;
         virtual void exportAsImage(std::string filename){throw RSGISImageFilterException("No image to output!");};
         ~RSGISNormVarLnPowerFilter(){};
+    protected:
+        void calcWindowOutput(const float* const* winData, size_t stride, size_t colOffset, int numBands, double *output);
+        RSGISWindowMoments winMoments;
     };
 
     class DllExport RSGISNormLnFilter : public RSGISImageFilter
@@ -120,9 +139,15 @@ namespace rsgis{namespace filter{
 
         RSGISNormLnFilter(int numberOutBands, int size, std::string filenameEnding);
         virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+        virtual bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+        virtual bool calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output);
+        virtual rsgis::img::RSGISCalcImageValue* clone(){return new RSGISNormLnFilter(this->numOutBands, this->size, this->filenameEnding);};
         virtual bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) {throw RSGISImageFilterException("Not implemented for NVarLogPower filter!");};;
         virtual void exportAsImage(std::string filename){throw RSGISImageFilterException("No image to output!");};
         ~RSGISNormLnFilter(){};
+    protected:
+        void calcWindowOutput(const float* const* winData, size_t stride, size_t colOffset, int numBands, double *output);
+        RSGISWindowMoments winMoments;
     };
 
     class DllExport RSGISTextureVar : public RSGISImageFilter
@@ -141,9 +166,15 @@ namespace rsgis{namespace filter{
 
         RSGISTextureVar(int numberOutBands, int size, std::string filenameEnding);
         virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+        virtual bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+        virtual bool calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output);
+        virtual rsgis::img::RSGISCalcImageValue* clone(){return new RSGISTextureVar(this->numOutBands, this->size, this->filenameEnding);};
         virtual bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) {throw RSGISImageFilterException("Not implemented for NVarLogPower filter!");};;
         virtual void exportAsImage(std::string filename){throw RSGISImageFilterException("No image to output!");};
         ~RSGISTextureVar(){};
+    protected:
+        void calcWindowOutput(const float* const* winData, size_t stride, size_t colOffset, int numBands, double *output);
+        RSGISWindowMoments winMoments;
     };
 }}
 
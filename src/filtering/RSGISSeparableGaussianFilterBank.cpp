@@ -0,0 +1,435 @@
+/*
+ *  RSGISSeparableGaussianFilterBank.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISSeparableGaussianFilterBank.h"
+#include "common/RSGISGDALInit.h"
+
+namespace rsgis{namespace filter{
+    
+    RSGISSeparableGaussianFilterBank::RSGISSeparableGaussianFilterBank()
+    {
+        
+    }
+    
+    bool RSGISSeparableGaussianFilterBank::isSeparable(float stddevX, float stddevY, float angle)
+    {
+        // The cross term (b in RSGISCalcGaussianSmoothFilter) must be zero.
+        double xVar = ((double)stddevX) * stddevX;
+        double yVar = ((double)stddevY) * stddevY;
+        double a = ((cos(angle)*cos(angle))/xVar) + ((sin(angle)*sin(angle))/yVar);
+        double b = (sin(2*angle)/yVar) - (sin(2*angle)/xVar);
+        double c = ((sin(angle)*sin(angle))/xVar) + ((cos(angle)*cos(angle))/yVar);
+        return fabs(b) <= (std::max(a, c) * 1e-6);
+    }
+    
+    void RSGISSeparableGaussianFilterBank::addFilter(GaussianFilterType type, float stddevX, float stddevY, float angle, int size, std::string fileEnding)
+    {
+        if((size % 2 == 0) || (size < 3))
+        {
+            throw RSGISImageFilterException("Window size needs to be 3 or greater and an odd number.");
+        }
+        if((stddevX <= 0) || ((type != gaussianLaplacian) && (stddevY <= 0)))
+        {
+            throw RSGISImageFilterException("The standard deviation of the Gaussian must be greater than 0.");
+        }
+        
+        GaussianFilter filter;
+        filter.fileEnding = fileEnding;
+        for(unsigned int i = 0; i < NUM_BASIS; ++i)
+        {
+            filter.basisWeights[i] = 0;
+        }
+        
+        double a = 0;
+        double c = 0;
+        if(type == gaussianLaplacian)
+        {
+            // stddev^4 * exp(-(x^2+y^2)/(2 stddev^2)) * (x^2 + y^2 - 2 stddev^2), which is
+            // stddev^8 * (Gxx + Gyy) of the (unnormalised) Gaussian with a = c = 1/(2 stddev^2).
+            double var = ((double)stddevX) * stddevX;
+            a = 1.0 / (2 * var);
+            c = a;
+            filter.basisWeights[BASIS_GXX] = var * var * var * var;
+            filter.basisWeights[BASIS_GYY] = var * var * var * var;
+        }
+        else
+        {
+            if(!isSeparable(stddevX, stddevY, angle))
+            {
+                throw RSGISImageFilterException("The Gaussian is not separable; it must be isotropic or aligned with the image axes.");
+            }
+            double xVar = ((double)stddevX) * stddevX;
+            double yVar = ((double)stddevY) * stddevY;
+            a = ((cos(angle)*cos(angle))/xVar) + ((sin(angle)*sin(angle))/yVar);
+            c = ((sin(angle)*sin(angle))/xVar) + ((cos(angle)*cos(angle))/yVar);
+            double constNorm = 2 * M_PI * stddevX * stddevY;
+            
+            if(type == gaussianSmooth)
+            {
+                filter.basisWeights[BASIS_G] = 1.0 / constNorm;
+            }
+            else if(type == gaussianFirstDerivative)
+            {
+                filter.basisWeights[BASIS_GX] = sin(angle) / constNorm;
+                filter.basisWeights[BASIS_GY] = cos(angle) / constNorm;
+            }
+            else
+            {
+                filter.basisWeights[BASIS_GXX] = (sin(angle)*sin(angle)) / constNorm;
+                filter.basisWeights[BASIS_GXY] = (2*sin(angle)*cos(angle)) / constNorm;
+                filter.basisWeights[BASIS_GYY] = (cos(angle)*cos(angle)) / constNorm;
+            }
+        }
+        
+        filter.scaleIdx = this->findScale(a, c, size);
+        GaussianScale *scale = &this->scales[filter.scaleIdx];
+        for(unsigned int i = 0; i < NUM_BASIS; ++i)
+        {
+            if(filter.basisWeights[i] != 0)
+            {
+                scale->useBasis[i] = true;
+            }
+        }
+        scale->filterIdxs.push_back(this->filters.size());
+        this->filters.push_back(filter);
+    }
+    
+    unsigned int RSGISSeparableGaussianFilterBank::findScale(double a, double c, int size)
+    {
+        for(unsigned int i = 0; i < this->scales.size(); ++i)
+        {
+            if((this->scales[i].size == size) && (fabs(this->scales[i].a - a) <= (a * 1e-9)) && (fabs(this->scales[i].c - c) <= (c * 1e-9)))
+            {
+                return i;
+            }
+        }
+        
+        GaussianScale scale;
+        scale.a = a;
+        scale.c = c;
+        scale.size = size;
+        for(unsigned int i = 0; i < NUM_BASIS; ++i)
+        {
+            scale.useBasis[i] = false;
+        }
+        int halfSize = size / 2;
+        for(unsigned int d = 0; d < 3; ++d)
+        {
+            scale.rowKernels[d].resize(size);
+            scale.colKernels[d].resize(size);
+        }
+        for(int k = 0; k < size; ++k)
+        {
+            double x = k - halfSize;
+            double gA = exp(-a * x * x);
+            double gC = exp(-c * x * x);
+            scale.rowKernels[0][k] = gA;
+            scale.rowKernels[1][k] = -2 * a * x * gA;
+            scale.rowKernels[2][k] = ((-2 * a) + (4 * a * a * x * x)) * gA;
+            scale.colKernels[0][k] = gC;
+            scale.colKernels[1][k] = -2 * c * x * gC;
+            scale.colKernels[2][k] = ((-2 * c) + (4 * c * c * x * x)) * gC;
+        }
+        this->scales.push_back(scale);
+        return this->scales.size() - 1;
+    }
+    
+    int RSGISSeparableGaussianFilterBank::getHalo()
+    {
+        int halo = 0;
+        for(unsigned int i = 0; i < this->scales.size(); ++i)
+        {
+            halo = std::max(halo, this->scales[i].size / 2);
+        }
+        return halo;
+    }
+    
+    void RSGISSeparableGaussianFilterBank::filterPaddedBand(const float *padData, size_t padWidth, int halo, size_t width, size_t nRows, double **outRows, rsgis::RSGISThreadPool *threadPool)
+    {
+        // The order of the x (row pass) and y (column pass) derivative of each basis response.
+        const unsigned int basisXOrder[NUM_BASIS] = {0, 1, 0, 2, 1, 0};
+        const unsigned int basisYOrder[NUM_BASIS] = {0, 0, 1, 0, 1, 2};
+        
+        for(unsigned int s = 0; s < this->scales.size(); ++s)
+        {
+            GaussianScale *scale = &this->scales[s];
+            int halfSize = scale->size / 2;
+            size_t winStart = halo - halfSize;
+            size_t nPassRows = nRows + (2 * halfSize);
+            bool useRowPass[3] = {false, false, false};
+            for(unsigned int i = 0; i < NUM_BASIS; ++i)
+            {
+                if(scale->useBasis[i])
+                {
+                    useRowPass[basisXOrder[i]] = true;
+                }
+            }
+            
+            // Filter along the rows, including the rows of the halo needed by the column pass.
+            size_t passSize = nPassRows * width;
+            if(this->rowPassData.size() < (3 * passSize))
+            {
+                this->rowPassData.resize(3 * passSize);
+            }
+            double *rowPass = this->rowPassData.data();
+            threadPool->parallelFor(0, nPassRows, [&](unsigned int t, size_t rStart, size_t rEnd)
+            {
+                for(size_t r = rStart; r < rEnd; ++r)
+                {
+                    const float *inRow = padData + ((winStart + r) * padWidth) + winStart;
+                    for(unsigned int d = 0; d < 3; ++d)
+                    {
+                        if(!useRowPass[d])
+                        {
+                            continue;
+                        }
+                        rsgis::RSGISSIMDKernels::convolveRow(inRow, scale->rowKernels[d].data(), scale->size, rowPass + (d * passSize) + (r * width), width);
+                    }
+                }
+            });
+            
+            // Filter the row pass outputs along the columns to give the basis responses
+            // for each row, which are then combined into the outputs of the filters.
+            // Each worker allocates its own basis rows, so they are on its NUMA node.
+            size_t threadBasisSize = NUM_BASIS * width;
+            if(this->basisRowData.size() < threadPool->getNumThreads())
+            {
+                this->basisRowData.resize(threadPool->getNumThreads());
+            }
+            threadPool->forEachWorker([&](unsigned int t)
+            {
+                if(this->basisRowData[t].size() < threadBasisSize)
+                {
+                    this->basisRowData[t].resize(threadBasisSize);
+                }
+            });
+            threadPool->parallelFor(0, nRows, [&](unsigned int t, size_t mStart, size_t mEnd)
+            {
+                double *basisRows = this->basisRowData[t].data();
+                for(size_t m = mStart; m < mEnd; ++m)
+                {
+                    for(unsigned int i = 0; i < NUM_BASIS; ++i)
+                    {
+                        if(!scale->useBasis[i])
+                        {
+                            continue;
+                        }
+                        double *basisRow = basisRows + (i * width);
+                        std::fill(basisRow, basisRow + width, 0.0);
+                        const double *kernel = scale->colKernels[basisYOrder[i]].data();
+                        const double *passData = rowPass + (basisXOrder[i] * passSize);
+                        for(int j = 0; j < scale->size; ++j)
+                        {
+                            rsgis::RSGISSIMDKernels::addScaled(kernel[j], passData + ((m + j) * width), basisRow, width);
+                        }
+                    }
+                    
+                    for(std::vector<unsigned int>::iterator iterFilter = scale->filterIdxs.begin(); iterFilter != scale->filterIdxs.end(); ++iterFilter)
+                    {
+                        const double *weights = this->filters[*iterFilter].basisWeights;
+                        double *outRow = outRows[*iterFilter] + (m * width);
+                        std::fill(outRow, outRow + width, 0.0);
+                        for(unsigned int i = 0; i < NUM_BASIS; ++i)
+                        {
+                            if(weights[i] == 0)
+                            {
+                                continue;
+                            }
+                            const double *basisRow = basisRows + (i * width);
+                            double weight = weights[i];
+                            for(size_t x = 0; x < width; ++x)
+                            {
+                                outRow[x] += weight * basisRow[x];
+                            }
+                        }
+                    }
+                }
+            });
+        }
+    }
+    
+    void RSGISSeparableGaussianFilterBank::applyFilters(const float* const* bands, int numBands, size_t width, size_t height, double ***output, unsigned int numThreads)
+    {
+        if(this->filters.empty() || (width == 0) || (height == 0))
+        {
+            return;
+        }
+        int halo = this->getHalo();
+        size_t padWidth = width + (2*halo);
+        size_t padRows = height + (2*halo);
+        std::vector<float> padData(padWidth * padRows, 0);
+        std::vector<double*> outRows(this->filters.size());
+        rsgis::RSGISThreadPool threadPool(numThreads);
+        for(int n = 0; n < numBands; ++n)
+        {
+            for(size_t y = 0; y < height; ++y)
+            {
+                std::copy(bands[n] + (y * width), bands[n] + ((y + 1) * width), padData.data() + ((y + halo) * padWidth) + halo);
+            }
+            for(size_t f = 0; f < this->filters.size(); ++f)
+            {
+                outRows[f] = output[f][n];
+            }
+            this->filterPaddedBand(padData.data(), padWidth, halo, width, height, outRows.data(), &threadPool);
+        }
+    }
+    
+    void RSGISSeparableGaussianFilterBank::executeFilters(GDALDataset **datasets, int numDS, std::string outImageBase, std::string gdalFormat, std::string imgExt, GDALDataType outDataType, unsigned int numThreads)
+    {
+        int numFilters = this->filters.size();
+        if(numFilters == 0)
+        {
+            return;
+        }
+        
+        int numInBands = 0;
+        for(int i = 0; i < numDS; i++)
+        {
+            numInBands += datasets[i]->GetRasterCount();
+        }
+        int halo = this->getHalo();
+        
+        rsgis::RSGISGDALInit::init();
+        rsgis::img::RSGISImageUtils imgUtils;
+        double gdalTranslation[6];
+        std::vector<int> dsOffsetVals(numDS*2);
+        std::vector<int*> dsOffsets(numDS);
+        for(int i = 0; i < numDS; i++)
+        {
+            dsOffsets[i] = &dsOffsetVals[i*2];
+        }
+        int width = 0;
+        int height = 0;
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        imgUtils.getImageOverlap(datasets, numDS, dsOffsets.data(), &width, &height, gdalTranslation, &xBlockSize, &yBlockSize);
+        
+        std::vector<GDALRasterBand*> inputRasterBands;
+        std::vector<int> bandDS;
+        for(int i = 0; i < numDS; i++)
+        {
+            for(int j = 0; j < datasets[i]->GetRasterCount(); j++)
+            {
+                inputRasterBands.push_back(datasets[i]->GetRasterBand(j+1));
+                bandDS.push_back(i);
+            }
+        }
+        
+        std::vector<GDALDataset*> outputDatasets;
+        try
+        {
+            for(int f = 0; f < numFilters; f++)
+            {
+                std::string filename = outImageBase + this->filters[f].fileEnding + "." + imgExt;
+                outputDatasets.push_back(imgUtils.createCopy(datasets, numDS, numInBands, filename, gdalFormat, outDataType));
+            }
+            
+            rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+            // Per row: the input, the outputs and the 3 row pass intermediates (for one band).
+            int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (numInBands*sizeof(float)) + (((size_t)numFilters)*numInBands*sizeof(double)) + (3*sizeof(double)), context.stripMemoryMB);
+            stripRows = std::max(1, std::min(stripRows, height));
+            size_t nStrips = (height + stripRows - 1) / stripRows;
+            size_t padWidth = width + (2*halo);
+            size_t padRows = stripRows + (2*halo);
+            
+            // The input strips (zero padded by the halo) and the outputs of each filter for each I/O buffer.
+            rsgis::RSGISStripIOPipeline ioPipeline(context.numIOBuffers);
+            unsigned int nIOBufs = ioPipeline.getNumBuffers();
+            std::vector<std::vector<std::vector<float> > > inData(nIOBufs, std::vector<std::vector<float> >(numInBands, std::vector<float>(padWidth*padRows, 0)));
+            std::vector<std::vector<std::vector<std::vector<double> > > > outData(nIOBufs, std::vector<std::vector<std::vector<double> > >(numFilters, std::vector<std::vector<double> >(numInBands, std::vector<double>(((size_t)width)*stripRows))));
+            std::vector<double*> outRows(numFilters);
+            
+            rsgis::RSGISThreadPool threadPool(numThreads);
+            rsgis_tqdm pbar;
+            auto stripNumRows = [&](size_t strip)
+            {
+                return std::min<int>(stripRows, height - (strip*stripRows));
+            };
+            auto readStrip = [&](size_t strip, unsigned int buf)
+            {
+                int row = strip*stripRows;
+                int nRows = stripNumRows(strip);
+                int readStart = std::max(0, row - halo);
+                int readEnd = std::min(height, row + nRows + halo);
+                // The rows of the buffer before readStart and after readEnd are outside of the image.
+                size_t padStart = readStart - (row - halo);
+                size_t padEnd = padStart + (readEnd - readStart);
+                for(int n = 0; n < numInBands; n++)
+                {
+                    float *bandData = inData[buf][n].data();
+                    std::fill(bandData, bandData + (padStart*padWidth), 0.0f);
+                    std::fill(bandData + (padEnd*padWidth), bandData + (padRows*padWidth), 0.0f);
+                    if(inputRasterBands[n]->RasterIO(GF_Read, dsOffsets[bandDS[n]][0], dsOffsets[bandDS[n]][1] + readStart, width, readEnd - readStart, bandData + (padStart*padWidth) + halo, width, readEnd - readStart, GDT_Float32, sizeof(float), ((GSpacing)padWidth)*sizeof(float)) != CE_None)
+                    {
+                        throw RSGISImageFilterException("Failed to read the input image data.");
+                    }
+                }
+            };
+            auto computeStrip = [&](size_t strip, unsigned int buf)
+            {
+                int nRows = stripNumRows(strip);
+                pbar.progress(strip*stripRows, height);
+                for(int n = 0; n < numInBands; n++)
+                {
+                    for(int f = 0; f < numFilters; f++)
+                    {
+                        outRows[f] = outData[buf][f][n].data();
+                    }
+                    this->filterPaddedBand(inData[buf][n].data(), padWidth, halo, width, nRows, outRows.data(), &threadPool);
+                }
+            };
+            auto writeStrip = [&](size_t strip, unsigned int buf)
+            {
+                int row = strip*stripRows;
+                int nRows = stripNumRows(strip);
+                for(int f = 0; f < numFilters; f++)
+                {
+                    for(int n = 0; n < numInBands; n++)
+                    {
+                        if(outputDatasets[f]->GetRasterBand(n+1)->RasterIO(GF_Write, 0, row, width, nRows, outData[buf][f][n].data(), width, nRows, GDT_Float64, 0, 0) != CE_None)
+                        {
+                            throw RSGISImageFilterException("Failed to write the output image data.");
+                        }
+                    }
+                }
+            };
+            std::cout << "Executing " << numFilters << " Gaussian filters at " << this->scales.size() << " scales with separable passes" << std::endl;
+            ioPipeline.run(nStrips, readStrip, computeStrip, writeStrip);
+            pbar.finish();
+        }
+        catch(rsgis::RSGISImageException &e)
+        {
+            for(size_t f = 0; f < outputDatasets.size(); f++)
+            {
+                GDALClose(outputDatasets[f]);
+            }
+            throw e;
+        }
+        
+        for(size_t f = 0; f < outputDatasets.size(); f++)
+        {
+            GDALClose(outputDatasets[f]);
+        }
+    }
+    
+}}
@@ -0,0 +1,147 @@
+/*
+ *  RSGISSeparableGaussianFilterBank.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISSeparableGaussianFilterBank_H
+#define RSGISSeparableGaussianFilterBank_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include "gdal_priv.h"
+
+#include "filtering/RSGISImageFilterException.h"
+
+#include "common/RSGISImageException.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISStripIOPipeline.h"
+#include "common/RSGISSIMDKernels.h"
+#include "common/RSGISThreadPool.h"
+#include "common/rsgis-tqdm.h"
+
+#include "img/RSGISImageUtils.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_filter_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace filter{
+    
+    /**
+     * A bank of the Gaussian smoothing, first and second derivative and Laplacian
+     * filters of RSGISCalcImageFilters.h, where the kernels are separable (i.e., the
+     * Gaussian is isotropic or its axes are aligned with the image; see isSeparable).
+     *
+     * The filters are grouped by scale (and window size). For each scale the image is
+     * filtered along the rows with the 1D Gaussian and its first and second derivatives
+     * and these intermediates are then filtered along the columns to give the basis
+     * responses G, Gx, Gy, Gxx, Gxy and Gyy. Every filter of the scale (i.e., all the
+     * orientations and derivative orders) is a weighted sum of the basis responses:
+     *
+     *   smooth = G
+     *   first(angle) = sin(angle) Gx + cos(angle) Gy
+     *   second(angle) = sin^2(angle) Gxx + 2 sin(angle) cos(angle) Gxy + cos^2(angle) Gyy
+     *   laplacian = Gxx + Gyy (with the Laplacian's scaling)
+     *
+     * so the whole bank is calculated with at most 3 row and 6 column passes per scale
+     * rather than one 2D convolution per filter. As RSGISFilterBank::executeFiltersFused
+     * the input is read once and the image is zero padded at the edges.
+     */
+    class DllExport RSGISSeparableGaussianFilterBank
+    {
+    public:
+        enum GaussianFilterType
+        {
+            gaussianSmooth,
+            gaussianFirstDerivative,
+            gaussianSecondDerivative,
+            gaussianLaplacian
+        };
+        
+        RSGISSeparableGaussianFilterBank();
+        /** Whether a Gaussian with the standard deviations and angle (radians) is separable in x and y. */
+        static bool isSeparable(float stddevX, float stddevY, float angle);
+        /** Add a filter; for the Laplacian stddevX is used. Throws if the kernel is not separable. */
+        void addFilter(GaussianFilterType type, float stddevX, float stddevY, float angle, int size, std::string fileEnding);
+        unsigned int getNumFilters(){return this->filters.size();};
+        unsigned int getNumScales(){return this->scales.size();};
+        /** Apply the filters to numBands arrays of width x height pixels in memory, where output[filter][band] is a width x height array. */
+        void applyFilters(const float* const* bands, int numBands, size_t width, size_t height, double ***output, unsigned int numThreads=1);
+        /** Apply the filters to the image, creating an output image (outImageBase + fileEnding + "." + imgExt) per filter. */
+        void executeFilters(GDALDataset **datasets, int numDS, std::string outImageBase, std::string gdalFormat, std::string imgExt, GDALDataType outDataType, unsigned int numThreads=1);
+        ~RSGISSeparableGaussianFilterBank(){};
+    protected:
+        // The basis responses, named by the order of the x and y derivatives.
+        static const unsigned int BASIS_G = 0;
+        static const unsigned int BASIS_GX = 1;
+        static const unsigned int BASIS_GY = 2;
+        static const unsigned int BASIS_GXX = 3;
+        static const unsigned int BASIS_GXY = 4;
+        static const unsigned int BASIS_GYY = 5;
+        static const unsigned int NUM_BASIS = 6;
+        
+        struct GaussianScale
+        {
+            double a;
+            double c;
+            int size;
+            // The 1D Gaussian (order 0) and derivatives along x (row) and y (column).
+            std::vector<double> rowKernels[3];
+            std::vector<double> colKernels[3];
+            bool useBasis[NUM_BASIS];
+            std::vector<unsigned int> filterIdxs;
+        };
+        
+        struct GaussianFilter
+        {
+            std::string fileEnding;
+            unsigned int scaleIdx;
+            double basisWeights[NUM_BASIS];
+        };
+        
+        unsigned int findScale(double a, double c, int size);
+        int getHalo();
+        /**
+         * Filter the nRows x width pixels of a band starting at (halo, halo) of padData,
+         * which is zero padded by halo pixels, writing the output of filter f to outRows[f].
+         */
+        void filterPaddedBand(const float *padData, size_t padWidth, int halo, size_t width, size_t nRows, double **outRows, rsgis::RSGISThreadPool *threadPool);
+        std::vector<GaussianScale> scales;
+        std::vector<GaussianFilter> filters;
+        std::vector<double> rowPassData;
+        std::vector<std::vector<double> > basisRowData;
+    };
+    
+}}
+
+#endif
@@ -21,6 +21,7 @@
  */
 
 #include "RSGISSobelFilter.h"
+#include "common/RSGISGDALInit.h"
 
 namespace rsgis{namespace filter{
 
@@ -122,7 +123,7 @@ namespace rsgis{namespace filter{
 
 	void RSGISSobelFilter::exportAsImage(std::string filename)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		GDALDataset *outputImageDS = NULL;
 		GDALRasterBand *outputRasterBand = NULL;
 		GDALDriver *gdalDriver = NULL;
@@ -24,7 +24,7 @@
 
 namespace rsgis{namespace filter{
     
-	RSGISLeeFilter::RSGISLeeFilter(int numberOutBands, int size, std::string filenameEnding, unsigned int nLooks, float internalScaleFactor) : RSGISImageFilter(numberOutBands, size, filenameEnding)
+	RSGISLeeFilter::RSGISLeeFilter(int numberOutBands, int size, std::string filenameEnding, unsigned int nLooks, float internalScaleFactor) : RSGISImageFilter(numberOutBands, size, filenameEnding), winMoments(rsgis_moment_value, false)
     {
         this->nLooks = nLooks;
         this->internalScaleFactor = internalScaleFactor;
@@ -88,6 +88,62 @@ namespace rsgis{namespace filter{
         }
 	}
 	
+	bool RSGISLeeFilter::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+	{
+		this->winMoments.initWindow(winData, stride, numBands, winSize);
+		this->calcWindowOutput(winData, stride, 0, numBands, output);
+		return true;
+	}
+	
+	bool RSGISLeeFilter::calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output)
+	{
+		this->winMoments.slideWindow(inColumn, stride);
+		// The window now starts one column to the right of outColumn.
+		this->calcWindowOutput(outColumn, stride, 1, numBands, output);
+		return true;
+	}
+	
+	void RSGISLeeFilter::calcWindowOutput(const float* const* winData, size_t stride, size_t colOffset, int numBands, double *output)
+	{
+		unsigned int middleVal = floor(((float)this->size) / 2);
+		unsigned int numVal = 0;
+		double sumVals = 0;
+		double sumSqVals = 0;
+		float outI = 0;
+		float iVal = 0;
+		float iMean = 0;
+		float iVar = 0;
+		float cU = sqrt(1. / this->nLooks); // Noise variation coefficient;
+		float nNoiseMean = 1; // Mean multiplicative noise
+		float k = 0;
+		
+		for(int i = 0; i < numBands; i++)
+		{
+			this->winMoments.getMoments(i, &numVal, &sumVals, &sumSqVals);
+			
+			// As calcImageValue, if the centre is 0 the value from the previous band is used.
+			float centreVal = winData[i][(middleVal * stride) + colOffset + middleVal];
+			if(centreVal != 0)
+			{
+				iVal = centreVal*this->internalScaleFactor;
+			}
+			
+			// The sums are of the values minus the shift.
+			double shiftMean = sumVals / numVal;
+			double shiftVar = (sumSqVals / numVal) - (shiftMean * shiftMean);
+			if(shiftVar < 0)
+			{
+				shiftVar = 0;
+			}
+			iMean = (this->winMoments.getShift(i) + shiftMean) * this->internalScaleFactor;
+			iVar = shiftVar * this->internalScaleFactor * this->internalScaleFactor;
+			
+			k = (nNoiseMean * iVar) / (iMean*iMean*cU + nNoiseMean*nNoiseMean*iVar);
+			outI = iMean + k*(iVal - nNoiseMean + iMean);
+			output[i] = outI / this->internalScaleFactor;
+		}
+	}
+	
 	RSGISLeeFilter::~RSGISLeeFilter()
 	{
 		
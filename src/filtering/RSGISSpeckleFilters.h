@@ -31,6 +31,7 @@
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 #include "filtering/RSGISImageFilter.h"
+#include "filtering/RSGISWindowMoments.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -66,12 +67,18 @@ namespace rsgis{namespace filter{
         
         RSGISLeeFilter(int numberOutBands, int size, std::string filenameEnding, unsigned int nLooks, float internalScaleFactor=100);
         virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+        virtual bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+        virtual bool calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output);
+        virtual rsgis::img::RSGISCalcImageValue* clone(){return new RSGISLeeFilter(this->numOutBands, this->size, this->filenameEnding, this->nLooks, this->internalScaleFactor);};
         virtual bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) {throw RSGISImageFilterException("Not implemented for Lee filter!");};;
         virtual void exportAsImage(std::string filename){throw RSGISImageFilterException("No image to output!");};
         ~RSGISLeeFilter();
     protected:
+        void calcWindowOutput(const float* const* winData, size_t stride, size_t colOffset, int numBands, double *output);
         unsigned int nLooks;
         float internalScaleFactor;
+        // As calcImageValue, NaNs are not ignored.
+        RSGISWindowMoments winMoments;
     };
 }}
 
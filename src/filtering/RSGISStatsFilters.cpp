@@ -52,6 +52,50 @@ namespace rsgis{namespace filter{
 		}
 	}
 
+	bool RSGISMeanFilter::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+	{
+		if(this->size != winSize)
+		{
+			throw rsgis::img::RSGISImageCalcException("Window sizes are different");
+		}
+
+		int numberElements = this->size * this->size;
+		this->winSums.resize(numBands);
+		for(int i = 0; i < numBands; i++)
+		{
+			double sumVal = 0;
+			for(int j = 0; j < this->size; j++)
+			{
+				const float *winRow = winData[i] + (j * stride);
+				for(int k = 0; k < this->size; k++)
+				{
+					sumVal = sumVal + winRow[k];
+				}
+			}
+			this->winSums[i] = sumVal;
+			output[i] = sumVal/numberElements;
+		}
+		return true;
+	}
+
+	bool RSGISMeanFilter::calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output)
+	{
+		int numberElements = this->size * this->size;
+		for(int i = 0; i < numBands; i++)
+		{
+			double inSum = 0;
+			double outSum = 0;
+			for(int j = 0; j < this->size; j++)
+			{
+				inSum = inSum + inColumn[i][j * stride];
+				outSum = outSum + outColumn[i][j * stride];
+			}
+			this->winSums[i] = this->winSums[i] + (inSum - outSum);
+			output[i] = this->winSums[i]/numberElements;
+		}
+		return true;
+	}
+
 	bool RSGISMeanFilter::calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) 
 	{
 		throw rsgis::img::RSGISImageCalcException("Not implemented yet");
@@ -79,29 +123,49 @@ namespace rsgis{namespace filter{
 			throw rsgis::img::RSGISImageCalcException("Window sizes are different");
 		}
 
-		double outputValue = 0;
 		int numberElements = winSize * winSize;
 		int median = floor(((float)numberElements)/2.0);
-		std::vector<float> sortedList;
-        sortedList.reserve(numberElements);
+		this->winVals.resize(numberElements);
 
 		for(int i = 0; i < numBands; i++)
 		{
-			outputValue = 0;
 			for(int j = 0; j < size; j++)
 			{
 				for(int k = 0; k < size; k++)
 				{
-					sortedList.push_back(dataBlock[i][j][k]);
+					this->winVals[(j * size) + k] = dataBlock[i][j][k];
 				}
 			}
-            
-            std::sort(sortedList.begin(), sortedList.end());
-			output[i] = sortedList[median];
-			sortedList.clear();
+			output[i] = rsgis::datastruct::rsgisSelectNth(this->winVals.data(), numberElements, median);
 		}
 	}
 
+	bool RSGISMedianFilter::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+	{
+		if(this->size != winSize)
+		{
+			throw rsgis::img::RSGISImageCalcException("Window sizes are different");
+		}
+
+		int numberElements = winSize * winSize;
+		int median = floor(((float)numberElements)/2.0);
+		this->winVals.resize(numberElements);
+
+		for(int i = 0; i < numBands; i++)
+		{
+			for(int j = 0; j < size; j++)
+			{
+				const float *winRow = winData[i] + (j * stride);
+				for(int k = 0; k < size; k++)
+				{
+					this->winVals[(j * size) + k] = winRow[k];
+				}
+			}
+			output[i] = rsgis::datastruct::rsgisSelectNth(this->winVals.data(), numberElements, median);
+		}
+		return true;
+	}
+
 	bool RSGISMedianFilter::calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) 
 	{
 		throw rsgis::img::RSGISImageCalcException("Not implemented yet");
@@ -129,25 +193,45 @@ namespace rsgis{namespace filter{
 			throw rsgis::img::RSGISImageCalcException("Window sizes are different");
 		}
 
-		double outputValue = 0;
-
-        rsgis::datastruct::SortedGenericList<float> *sortedList = new rsgis::datastruct::SortedGenericList<float>();
+		int numberElements = winSize * winSize;
+		this->winVals.resize(numberElements);
 
 		for(int i = 0; i < numBands; i++)
 		{
-			outputValue = 0;
 			for(int j = 0; j < size; j++)
 			{
 				for(int k = 0; k < size; k++)
 				{
-					sortedList->add(&dataBlock[i][j][k]);
+					this->winVals[(j * size) + k] = dataBlock[i][j][k];
 				}
 			}
-			output[i] = *sortedList->getMostCommonValue();
-			sortedList->clearList();
+			output[i] = rsgis::datastruct::rsgisMostCommonValue(this->winVals.data(), numberElements);
+		}
+	}
+
+	bool RSGISModeFilter::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+	{
+		if(this->size != winSize)
+		{
+			throw rsgis::img::RSGISImageCalcException("Window sizes are different");
 		}
 
-		delete sortedList;
+		int numberElements = winSize * winSize;
+		this->winVals.resize(numberElements);
+
+		for(int i = 0; i < numBands; i++)
+		{
+			for(int j = 0; j < size; j++)
+			{
+				const float *winRow = winData[i] + (j * stride);
+				for(int k = 0; k < size; k++)
+				{
+					this->winVals[(j * size) + k] = winRow[k];
+				}
+			}
+			output[i] = rsgis::datastruct::rsgisMostCommonValue(this->winVals.data(), numberElements);
+		}
+		return true;
 	}
 
 	bool RSGISModeFilter::calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) 
@@ -272,6 +356,71 @@ namespace rsgis{namespace filter{
 		}
 	}
 
+	bool RSGISStdDevFilter::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+	{
+		if(this->size != winSize)
+		{
+			throw rsgis::img::RSGISImageCalcException("Window sizes are different");
+		}
+
+		this->winShifts.resize(numBands);
+		this->winSums.resize(numBands);
+		this->winSqSums.resize(numBands);
+		for(int i = 0; i < numBands; i++)
+		{
+			double shift = winData[i][0];
+			double sumVal = 0;
+			double sqSumVal = 0;
+			for(int j = 0; j < this->size; j++)
+			{
+				const float *winRow = winData[i] + (j * stride);
+				for(int k = 0; k < this->size; k++)
+				{
+					double val = winRow[k] - shift;
+					sumVal = sumVal + val;
+					sqSumVal = sqSumVal + (val * val);
+				}
+			}
+			this->winShifts[i] = shift;
+			this->winSums[i] = sumVal;
+			this->winSqSums[i] = sqSumVal;
+		}
+		this->calcStdDevOutput(numBands, output);
+		return true;
+	}
+
+	bool RSGISStdDevFilter::calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output)
+	{
+		for(int i = 0; i < numBands; i++)
+		{
+			double shift = this->winShifts[i];
+			for(int j = 0; j < this->size; j++)
+			{
+				double inVal = inColumn[i][j * stride] - shift;
+				double outVal = outColumn[i][j * stride] - shift;
+				this->winSums[i] = this->winSums[i] + (inVal - outVal);
+				this->winSqSums[i] = this->winSqSums[i] + ((inVal * inVal) - (outVal * outVal));
+			}
+		}
+		this->calcStdDevOutput(numBands, output);
+		return true;
+	}
+
+	void RSGISStdDevFilter::calcStdDevOutput(int numBands, double *output)
+	{
+		int numberElements = this->size * this->size;
+		for(int i = 0; i < numBands; i++)
+		{
+			double mean = this->winSums[i]/numberElements;
+			double variance = (this->winSqSums[i]/numberElements) - (mean * mean);
+			if(variance < 0)
+			{
+				variance = 0;
+			}
+			output[i] = sqrt(variance);
+		}
+	}
+
 	bool RSGISStdDevFilter::calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) 
 	{
 		throw rsgis::img::RSGISImageCalcException("Not implemented yet");
@@ -873,9 +1022,275 @@ namespace rsgis{namespace filter{
     {
         
     }
-    
-    
-    
 
-}}
+    RSGISWindowHistogram::RSGISWindowHistogram(double histMin, double histMax, double binWidth)
+    {
+        this->histMin = histMin;
+        this->binWidth = binWidth;
+        this->nBins = RSGISWindowHistogram::calcNumBins(histMin, histMax, binWidth);
+        this->nCoarseBins = (this->nBins + 255) / 256;
+        this->fineCounts.resize(this->nBins, 0);
+        this->coarseCounts.resize(this->nCoarseBins, 0);
+        this->coarseMaxCounts.resize(this->nCoarseBins, 0);
+        this->coarseMaxDirty.resize(this->nCoarseBins, false);
+        this->nValues = 0;
+    }
 
+    unsigned int RSGISWindowHistogram::calcNumBins(double histMin, double histMax, double binWidth)
+    {
+        if(binWidth <= 0)
+        {
+            throw RSGISImageFilterException("The histogram bin width must be greater than zero.");
+        }
+        if(histMax < histMin)
+        {
+            throw RSGISImageFilterException("The histogram maximum must be greater than the minimum.");
+        }
+        double nBinsVal = floor((histMax - histMin) / binWidth) + 1;
+        if(nBinsVal > 16777216)
+        {
+            throw RSGISImageFilterException("The histogram has too many bins (> 2^24), increase the bin width.");
+        }
+        return (unsigned int)nBinsVal;
+    }
+
+    void RSGISWindowHistogram::clear()
+    {
+        std::fill(this->fineCounts.begin(), this->fineCounts.end(), 0);
+        std::fill(this->coarseCounts.begin(), this->coarseCounts.end(), 0);
+        std::fill(this->coarseMaxCounts.begin(), this->coarseMaxCounts.end(), 0);
+        std::fill(this->coarseMaxDirty.begin(), this->coarseMaxDirty.end(), false);
+        this->nValues = 0;
+    }
+
+    unsigned int RSGISWindowHistogram::getBin(float val)
+    {
+        double binVal = floor((val - this->histMin) / this->binWidth);
+        if(!(binVal > 0))
+        {
+            return 0;
+        }
+        else if(binVal >= this->nBins)
+        {
+            return this->nBins - 1;
+        }
+        return (unsigned int)binVal;
+    }
+
+    void RSGISWindowHistogram::add(float val)
+    {
+        unsigned int bin = this->getBin(val);
+        unsigned int coarseBin = bin >> 8;
+        ++this->fineCounts[bin];
+        ++this->coarseCounts[coarseBin];
+        if((!this->coarseMaxDirty[coarseBin]) && (this->fineCounts[bin] > this->coarseMaxCounts[coarseBin]))
+        {
+            this->coarseMaxCounts[coarseBin] = this->fineCounts[bin];
+        }
+        ++this->nValues;
+    }
+
+    void RSGISWindowHistogram::remove(float val)
+    {
+        unsigned int bin = this->getBin(val);
+        unsigned int coarseBin = bin >> 8;
+        if(this->fineCounts[bin] == 0)
+        {
+            throw rsgis::img::RSGISImageCalcException("Value removed from the window histogram was not within the histogram.");
+        }
+        if(this->fineCounts[bin] == this->coarseMaxCounts[coarseBin])
+        {
+            // The maximum may have been reduced so recalculate it when next needed.
+            this->coarseMaxDirty[coarseBin] = true;
+        }
+        --this->fineCounts[bin];
+        --this->coarseCounts[coarseBin];
+        --this->nValues;
+    }
+
+    double RSGISWindowHistogram::getRankValue(unsigned long rank)
+    {
+        if(rank >= this->nValues)
+        {
+            throw rsgis::img::RSGISImageCalcException("The rank is greater than the number of values within the histogram.");
+        }
+        unsigned long cumCount = 0;
+        unsigned int coarseBin = 0;
+        while((cumCount + this->coarseCounts[coarseBin]) <= rank)
+        {
+            cumCount += this->coarseCounts[coarseBin];
+            ++coarseBin;
+        }
+        unsigned int bin = coarseBin << 8;
+        while((cumCount + this->fineCounts[bin]) <= rank)
+        {
+            cumCount += this->fineCounts[bin];
+            ++bin;
+        }
+        return this->histMin + (bin * this->binWidth);
+    }
+
+    double RSGISWindowHistogram::getModeValue()
+    {
+        unsigned int maxCount = 0;
+        unsigned int maxCoarseBin = 0;
+        for(unsigned int i = 0; i < this->nCoarseBins; ++i)
+        {
+            if(this->coarseCounts[i] <= maxCount)
+            {
+                continue;
+            }
+            if(this->coarseMaxDirty[i])
+            {
+                unsigned int binEnd = std::min(this->nBins, (i+1) << 8);
+                unsigned int coarseMax = 0;
+                for(unsigned int bin = (i << 8); bin < binEnd; ++bin)
+                {
+                    coarseMax = std::max(coarseMax, this->fineCounts[bin]);
+                }
+                this->coarseMaxCounts[i] = coarseMax;
+                this->coarseMaxDirty[i] = false;
+            }
+            if(this->coarseMaxCounts[i] > maxCount)
+            {
+                maxCount = this->coarseMaxCounts[i];
+                maxCoarseBin = i;
+            }
+        }
+        unsigned int bin = maxCoarseBin << 8;
+        while(this->fineCounts[bin] != maxCount)
+        {
+            ++bin;
+        }
+        return this->histMin + (bin * this->binWidth);
+    }
+
+
+    RSGISHistogramRankFilter::RSGISHistogramRankFilter(int numberOutBands, int size, std::string filenameEnding, RankStat stat, double histMin, double histMax, double binWidth, double percentileVal) : RSGISImageFilter(numberOutBands, size, filenameEnding)
+    {
+        if((percentileVal < 0) || (percentileVal > 100))
+        {
+            throw RSGISImageFilterException("The percentile must be between 0 and 100.");
+        }
+        this->stat = stat;
+        this->histMin = histMin;
+        this->histMax = histMax;
+        this->binWidth = binWidth;
+
+        // Check the histogram parameters are valid.
+        RSGISWindowHistogram::calcNumBins(histMin, histMax, binWidth);
+
+        // Use the same rank as RSGISMedianFilter for the median (i.e., the 50th percentile).
+        unsigned long numberElements = ((unsigned long)size) * ((unsigned long)size);
+        if(stat == median)
+        {
+            percentileVal = 50;
+        }
+        this->rank = (unsigned long)floor((percentileVal / 100.0) * numberElements);
+        if(this->rank >= numberElements)
+        {
+            this->rank = numberElements - 1;
+        }
+    }
+
+    void RSGISHistogramRankFilter::initHistograms(int numBands)
+    {
+        while(this->winHists.size() < ((size_t)numBands))
+        {
+            this->winHists.push_back(new RSGISWindowHistogram(this->histMin, this->histMax, this->binWidth));
+        }
+    }
+
+    void RSGISHistogramRankFilter::calcHistogramOutput(int numBands, double *output)
+    {
+        for(int i = 0; i < numBands; i++)
+        {
+            if(this->stat == mode)
+            {
+                output[i] = this->winHists[i]->getModeValue();
+            }
+            else
+            {
+                output[i] = this->winHists[i]->getRankValue(this->rank);
+            }
+        }
+    }
+
+    void RSGISHistogramRankFilter::calcImageValue(float ***dataBlock, int numBands, int winSize, double *output)
+    {
+        if(this->size != winSize)
+        {
+            throw rsgis::img::RSGISImageCalcException("Window sizes are different");
+        }
+
+        this->initHistograms(numBands);
+        for(int i = 0; i < numBands; i++)
+        {
+            this->winHists[i]->clear();
+            for(int j = 0; j < this->size; j++)
+            {
+                for(int k = 0; k < this->size; k++)
+                {
+                    this->winHists[i]->add(dataBlock[i][j][k]);
+                }
+            }
+        }
+        this->calcHistogramOutput(numBands, output);
+    }
+
+    bool RSGISHistogramRankFilter::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+    {
+        if(this->size != winSize)
+        {
+            throw rsgis::img::RSGISImageCalcException("Window sizes are different");
+        }
+
+        this->initHistograms(numBands);
+        for(int i = 0; i < numBands; i++)
+        {
+            this->winHists[i]->clear();
+            for(int j = 0; j < this->size; j++)
+            {
+                const float *winRow = winData[i] + (j * stride);
+                for(int k = 0; k < this->size; k++)
+                {
+                    this->winHists[i]->add(winRow[k]);
+                }
+            }
+        }
+        this->calcHistogramOutput(numBands, output);
+        return true;
+    }
+
+    bool RSGISHistogramRankFilter::calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output)
+    {
+        for(int i = 0; i < numBands; i++)
+        {
+            for(int j = 0; j < this->size; j++)
+            {
+                this->winHists[i]->remove(outColumn[i][j * stride]);
+                this->winHists[i]->add(inColumn[i][j * stride]);
+            }
+        }
+        this->calcHistogramOutput(numBands, output);
+        return true;
+    }
+
+    bool RSGISHistogramRankFilter::calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output)
+    {
+        throw rsgis::img::RSGISImageCalcException("Not implemented yet");
+    }
+
+    void RSGISHistogramRankFilter::exportAsImage(std::string filename)
+    {
+        std::cout << "No Image to output\n";
+    }
+
+    RSGISHistogramRankFilter::~RSGISHistogramRankFilter()
+    {
+        for(std::vector<RSGISWindowHistogram*>::iterator iterHists = this->winHists.begin(); iterHists != this->winHists.end(); ++iterHists)
+        {
+            delete *iterHists;
+        }
+    }
+}}
@@ -34,10 +34,10 @@
 #include "img/RSGISCalcImageValue.h"
 #include "filtering/RSGISImageFilter.h"
 
-#include "datastruct/SortedGenericList.cpp"
+#include "datastruct/RSGISSmallSortedBuffer.h"
 
 // mark all exported classes/functions with DllExport to have
-// them exported by Visual Studio
+// them exported by Visual Studio
 #undef DllExport
 #ifdef _MSC_VER
     #ifdef rsgis_filter_EXPORTS
@@ -56,9 +56,13 @@ namespace rsgis{namespace filter{
 		public:
 			RSGISMeanFilter(int numberOutBands, int size, std::string filenameEnding);
 			virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+			virtual bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+			virtual bool calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output);
 			virtual bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output);
 			virtual void exportAsImage(std::string filename);
 			~RSGISMeanFilter();
+		protected:
+			std::vector<double> winSums;
 		};
 
 	class DllExport RSGISMedianFilter : public RSGISImageFilter
@@ -66,9 +70,13 @@ namespace rsgis{namespace filter{
 		public:
 			RSGISMedianFilter(int numberOutBands, int size, std::string filenameEnding);
 			virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+			virtual bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
 			virtual bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output);
 			virtual void exportAsImage(std::string filename);
 			~RSGISMedianFilter();
+		protected:
+			/** The window values, which are reused between pixels to avoid allocating memory for each window. */
+			std::vector<float> winVals;
 		};
 
 	class DllExport RSGISModeFilter : public RSGISImageFilter
@@ -76,9 +84,13 @@ namespace rsgis{namespace filter{
 		public:
 			RSGISModeFilter(int numberOutBands, int size, std::string filenameEnding);
 			virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+			virtual bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
 			virtual bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output);
 			virtual void exportAsImage(std::string filename);
 			~RSGISModeFilter();
+		protected:
+			/** The window values, which are reused between pixels to avoid allocating memory for each window. */
+			std::vector<float> winVals;
 		};
 
 	class DllExport RSGISRangeFilter : public RSGISImageFilter
@@ -96,9 +108,18 @@ namespace rsgis{namespace filter{
 		public:
 			RSGISStdDevFilter(int numberOutBands, int size, std::string filenameEnding);
 			virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+			virtual bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+			virtual bool calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output);
 			virtual bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output);
 			virtual void exportAsImage(std::string filename);
 			~RSGISStdDevFilter();
+		protected:
+			void calcStdDevOutput(int numBands, double *output);
+			// The running sums are of the values minus a shift (the first value of the
+			// window at the start of each row) so large image values do not lose precision.
+			std::vector<double> winShifts;
+			std::vector<double> winSums;
+			std::vector<double> winSqSums;
 		};
 
     class DllExport RSGISCoeffOfVarFilter : public RSGISImageFilter
@@ -196,6 +217,74 @@ namespace rsgis{namespace filter{
         virtual void exportAsImage(std::string filename);
         ~RSGISTotalDiffAbsFilter();
     };
+    /**
+     * A histogram of the values within a filter window, where the bins are grouped
+     * into coarse bins of 256 so rank (e.g., median) and mode values can be found
+     * by scanning at most a few hundred bins rather than sorting the window.
+     * Values outside of the histogram range are counted in the first or last bin.
+     */
+    class DllExport RSGISWindowHistogram
+    {
+    public:
+        RSGISWindowHistogram(double histMin, double histMax, double binWidth);
+        void clear();
+        void add(float val);
+        void remove(float val);
+        /** Get the value (lower edge of the bin) of the value with rank (from 0) within the histogram. */
+        double getRankValue(unsigned long rank);
+        /** Get the value (lower edge of the bin) of the most common bin; ties are given to the lowest bin. */
+        double getModeValue();
+        unsigned long getNumValues(){return this->nValues;};
+        /** Get the number of bins for the histogram parameters, throwing an exception if they are not valid. */
+        static unsigned int calcNumBins(double histMin, double histMax, double binWidth);
+        ~RSGISWindowHistogram(){};
+    protected:
+        unsigned int getBin(float val);
+        double histMin;
+        double binWidth;
+        unsigned int nBins;
+        unsigned int nCoarseBins;
+        std::vector<unsigned int> fineCounts;
+        std::vector<unsigned int> coarseCounts;
+        std::vector<unsigned int> coarseMaxCounts;
+        std::vector<bool> coarseMaxDirty;
+        unsigned long nValues;
+    };
+
+    /**
+     * Median, percentile and mode filters using a histogram of the window which is
+     * updated as the window slides along each row (i.e., removing the column which
+     * leaves the window and adding the column which enters it) so the cost per pixel
+     * is linear in the window size rather than sorting the whole window. Intended for
+     * 8 and 16 bit integer images (with a bin width of 1 the output is identical to
+     * RSGISMedianFilter) or float images quantised with the bin width.
+     */
+    class DllExport RSGISHistogramRankFilter : public RSGISImageFilter
+    {
+    public:
+        enum RankStat
+        {
+            median,
+            percentile,
+            mode
+        };
+        RSGISHistogramRankFilter(int numberOutBands, int size, std::string filenameEnding, RankStat stat, double histMin, double histMax, double binWidth=1, double percentileVal=50);
+        virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+        virtual bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+        virtual bool calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output);
+        virtual bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output);
+        virtual void exportAsImage(std::string filename);
+        ~RSGISHistogramRankFilter();
+    protected:
+        void initHistograms(int numBands);
+        void calcHistogramOutput(int numBands, double *output);
+        RankStat stat;
+        double histMin;
+        double histMax;
+        double binWidth;
+        unsigned long rank;
+        std::vector<RSGISWindowHistogram*> winHists;
+    };
 }}
 
 #endif
@@ -0,0 +1,145 @@
+/*
+ *  RSGISWindowMoments.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISWindowMoments.h"
+
+namespace rsgis{namespace filter{
+    
+    RSGISWindowMoments::RSGISWindowMoments(RSGISWindowMomentType momentType, bool ignoreNaN)
+    {
+        this->momentType = momentType;
+        this->ignoreNaN = ignoreNaN;
+        this->numBands = 0;
+        this->winSize = 0;
+        this->colStart = 0;
+    }
+    
+    void RSGISWindowMoments::initWindow(const float* const* winData, size_t stride, int numBands, int winSize)
+    {
+        if(winSize <= 0)
+        {
+            throw rsgis::img::RSGISImageCalcException("The window size must be greater than 0.");
+        }
+        this->numBands = numBands;
+        this->winSize = winSize;
+        this->colStart = 0;
+        this->shifts.assign(numBands, 0.0);
+        this->colSums.resize(((size_t)numBands) * winSize * 3);
+        
+        for(int i = 0; i < numBands; ++i)
+        {
+            if(this->momentType == rsgis_moment_value)
+            {
+                bool found = false;
+                for(int j = 0; (j < winSize) && (!found); ++j)
+                {
+                    const float *winRow = winData[i] + (j * stride);
+                    for(int k = 0; k < winSize; ++k)
+                    {
+                        if((winRow[k] != 0) && !((boost::math::isnan)(winRow[k])))
+                        {
+                            this->shifts[i] = winRow[k];
+                            found = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            
+            for(int k = 0; k < winSize; ++k)
+            {
+                this->calcColumn(winData[i] + k, stride, i, &this->colSums[((((size_t)i) * winSize) + k) * 3]);
+            }
+        }
+    }
+    
+    void RSGISWindowMoments::slideWindow(const float* const* inColumn, size_t stride)
+    {
+        for(int i = 0; i < this->numBands; ++i)
+        {
+            this->calcColumn(inColumn[i], stride, i, &this->colSums[((((size_t)i) * this->winSize) + this->colStart) * 3]);
+        }
+        this->colStart = (this->colStart + 1) % this->winSize;
+    }
+    
+    void RSGISWindowMoments::getMoments(int band, unsigned int *numVals, double *sumA, double *sumB)
+    {
+        const double *bandSums = &this->colSums[((size_t)band) * this->winSize * 3];
+        double n = 0;
+        double sA = 0;
+        double sB = 0;
+        for(int k = 0; k < this->winSize; ++k)
+        {
+            n += bandSums[k*3];
+            sA += bandSums[(k*3)+1];
+            sB += bandSums[(k*3)+2];
+        }
+        *numVals = (unsigned int)n;
+        *sumA = sA;
+        *sumB = sB;
+    }
+    
+    void RSGISWindowMoments::calcColumn(const float *column, size_t stride, int band, double *colSums)
+    {
+        double n = 0;
+        double sA = 0;
+        double sB = 0;
+        double shift = this->shifts[band];
+        for(int j = 0; j < this->winSize; ++j)
+        {
+            float val = column[j * stride];
+            if((val == 0) || (this->ignoreNaN && (boost::math::isnan)(val)))
+            {
+                continue;
+            }
+            
+            if(this->momentType == rsgis_moment_value)
+            {
+                double shiftVal = val - shift;
+                sA += shiftVal;
+                sB += shiftVal * shiftVal;
+            }
+            else if(this->momentType == rsgis_moment_sqrtvalue)
+            {
+                sA += sqrt(val);
+                sB += val;
+            }
+            else if(this->momentType == rsgis_moment_lnvalue)
+            {
+                double lnVal = log(val);
+                sA += lnVal;
+                sB += lnVal * lnVal;
+            }
+            else
+            {
+                sA += val;
+                sB += log(val);
+            }
+            ++n;
+        }
+        colSums[0] = n;
+        colSums[1] = sA;
+        colSums[2] = sB;
+    }
+    
+}}
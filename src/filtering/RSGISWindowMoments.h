@@ -0,0 +1,100 @@
+/*
+ *  RSGISWindowMoments.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISWindowMoments_H
+#define RSGISWindowMoments_H
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include "img/RSGISImageCalcException.h"
+
+#include <boost/math/special_functions/fpclassify.hpp>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_filter_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace filter{
+    
+    enum RSGISWindowMomentType
+    {
+        rsgis_moment_value, // sumA = sum(x - shift); sumB = sum((x - shift)^2)
+        rsgis_moment_sqrtvalue, // sumA = sum(sqrt(x)); sumB = sum(x)
+        rsgis_moment_lnvalue, // sumA = sum(ln(x)); sumB = sum(ln(x)^2)
+        rsgis_moment_valueln // sumA = sum(x); sumB = sum(ln(x))
+    };
+    
+    /**
+     * Running moments (the number of values and two sums) of a square window which
+     * slides along a row of the image, for use by filters implementing
+     * RSGISCalcImageValue::calcImageWindowView and calcImageWindowViewSlide.
+     *
+     * The sums are held for each column of the window so when the window moves only
+     * the column entering the window is read (i.e., for the log variants ln is
+     * calculated once per pixel of the column rather than for the whole window). The
+     * window sums are then the total of the column sums, rather than adding and
+     * subtracting the columns from a running total, so there is no drift along the
+     * row and a no data (NaN) value only affects the windows it is within.
+     *
+     * Values of 0 are ignored, as are NaNs if ignoreNaN is true. For
+     * rsgis_moment_value the values are shifted by the first valid value of the
+     * window at the start of the row so the variance does not lose precision.
+     */
+    class DllExport RSGISWindowMoments
+    {
+    public:
+        RSGISWindowMoments(RSGISWindowMomentType momentType, bool ignoreNaN=true);
+        /** Calculate the column sums for a new window (i.e., the start of a row). */
+        void initWindow(const float* const* winData, size_t stride, int numBands, int winSize);
+        /** Replace the column which has left the window with inColumn. */
+        void slideWindow(const float* const* inColumn, size_t stride);
+        /** Get the moments of the current window for a band. */
+        void getMoments(int band, unsigned int *numVals, double *sumA, double *sumB);
+        double getShift(int band){return this->shifts[band];};
+        ~RSGISWindowMoments(){};
+    protected:
+        void calcColumn(const float *column, size_t stride, int band, double *colSums);
+        RSGISWindowMomentType momentType;
+        bool ignoreNaN;
+        int numBands;
+        int winSize;
+        unsigned int colStart;
+        std::vector<double> shifts;
+        // numBands x winSize columns of (n, sumA, sumB), where the oldest column is colStart.
+        std::vector<double> colSums;
+    };
+    
+}}
+
+#endif
@@ -24,6 +24,7 @@
  */
 
 #include "RSGISAddBands.h"
+#include "common/RSGISGDALInit.h"
 
 namespace rsgis{namespace img{
     
@@ -329,7 +330,7 @@ namespace rsgis{namespace img{
     
     void RSGISAddBands::stackImages(GDALDataset **datasets, int numDS, std::string outputImage, std::string *imageBandNames, bool skipPixels, float skipValue, float noDataValue, std::string gdalFormat, GDALDataType gdalDataType, bool replaceBandNames) 
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
         rsgis::math::RSGISMathsUtils mathUtils;
 		double *gdalTranslation = new double[6];
@@ -648,6 +649,263 @@ namespace rsgis{namespace img{
     }
     
     
+    void RSGISAddBands::stackImagesVRT(GDALDataset **datasets, int numDS, std::string outputImage, std::string *imageBandNames, GDALDataType gdalDataType, bool replaceBandNames)
+    {
+        rsgis::RSGISGDALInit::init();
+        RSGISImageUtils imgUtils;
+        double gdalTranslation[6];
+        std::vector<int*> dsOffsets(numDS, NULL);
+        std::vector<int> offsetVals(numDS * 2, 0);
+        for(int i = 0; i < numDS; i++)
+        {
+            dsOffsets[i] = &offsetVals[i * 2];
+        }
+        int height = 0;
+        int width = 0;
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        
+        // Find image overlap
+        imgUtils.getImageOverlap(datasets, numDS, dsOffsets.data(), &width, &height, gdalTranslation, &xBlockSize, &yBlockSize);
+        std::vector<std::string> bandNames = this->getStackBandNames(datasets, numDS, imageBandNames, replaceBandNames);
+        
+        GDALDriver *vrtDriver = GetGDALDriverManager()->GetDriverByName("VRT");
+        if(vrtDriver == NULL)
+        {
+            throw RSGISImageBandException("The GDAL VRT driver is not available.");
+        }
+        GDALDataset *outputImageDS = vrtDriver->Create(outputImage.c_str(), width, height, 0, gdalDataType, NULL);
+        if(outputImageDS == NULL)
+        {
+            throw RSGISImageBandException("Output image could not be created. Check filepath.");
+        }
+        outputImageDS->SetGeoTransform(gdalTranslation);
+        outputImageDS->SetProjection(datasets[0]->GetProjectionRef());
+        
+        char *currentDir = CPLGetCurrentDir();
+        std::string cwd = (currentDir != NULL)?std::string(currentDir):std::string("");
+        CPLFree(currentDir);
+        
+        int counter = 0;
+        for(int i = 0; i < numDS; i++)
+        {
+            // The sources are referenced by their absolute path so the VRT can be moved.
+            std::string srcFile = std::string(datasets[i]->GetDescription());
+            if(srcFile == "")
+            {
+                GDALClose(outputImageDS);
+                throw RSGISImageBandException("The input images must be files to be referenced by a VRT.");
+            }
+            if(CPLIsFilenameRelative(srcFile.c_str()) && (cwd != ""))
+            {
+                srcFile = std::string(CPLFormFilename(cwd.c_str(), srcFile.c_str(), NULL));
+            }
+            char *srcFileXML = CPLEscapeString(srcFile.c_str(), -1, CPLES_XML);
+            
+            for(int j = 0; j < datasets[i]->GetRasterCount(); j++)
+            {
+                GDALRasterBand *inBand = datasets[i]->GetRasterBand(j+1);
+                if(outputImageDS->AddBand(gdalDataType, NULL) != CE_None)
+                {
+                    CPLFree(srcFileXML);
+                    GDALClose(outputImageDS);
+                    throw RSGISImageBandException("Could not add a band to the VRT.");
+                }
+                GDALRasterBand *outBand = outputImageDS->GetRasterBand(counter+1);
+                
+                std::string sourceXML = std::string("<SimpleSource><SourceFilename relativeToVRT=\"0\">") + std::string(srcFileXML) + std::string("</SourceFilename>");
+                sourceXML += std::string("<SourceBand>") + std::to_string(j+1) + std::string("</SourceBand>");
+                sourceXML += std::string("<SrcRect xOff=\"") + std::to_string(dsOffsets[i][0]) + std::string("\" yOff=\"") + std::to_string(dsOffsets[i][1]) + std::string("\" xSize=\"") + std::to_string(width) + std::string("\" ySize=\"") + std::to_string(height) + std::string("\"/>");
+                sourceXML += std::string("<DstRect xOff=\"0\" yOff=\"0\" xSize=\"") + std::to_string(width) + std::string("\" ySize=\"") + std::to_string(height) + std::string("\"/></SimpleSource>");
+                outBand->SetMetadataItem("source_0", sourceXML.c_str(), "new_vrt_sources");
+                
+                outBand->SetDescription(bandNames[counter].c_str());
+                int hasNoData = false;
+                double noDataVal = inBand->GetNoDataValue(&hasNoData);
+                if(hasNoData)
+                {
+                    outBand->SetNoDataValue(noDataVal);
+                }
+                counter++;
+            }
+            CPLFree(srcFileXML);
+        }
+        
+        // Closing the dataset writes the VRT file.
+        GDALClose(outputImageDS);
+    }
+    
+    void RSGISAddBands::stackImagesCopy(GDALDataset **datasets, int numDS, std::string outputImage, std::string *imageBandNames, std::string gdalFormat, GDALDataType gdalDataType, bool replaceBandNames, unsigned int numThreads)
+    {
+        rsgis::RSGISGDALInit::init();
+        RSGISImageUtils imgUtils;
+        double gdalTranslation[6];
+        std::vector<int*> dsOffsets(numDS, NULL);
+        std::vector<int> offsetVals(numDS * 2, 0);
+        for(int i = 0; i < numDS; i++)
+        {
+            dsOffsets[i] = &offsetVals[i * 2];
+        }
+        int height = 0;
+        int width = 0;
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        
+        // Find image overlap
+        imgUtils.getImageOverlap(datasets, numDS, dsOffsets.data(), &width, &height, gdalTranslation, &xBlockSize, &yBlockSize);
+        std::vector<std::string> bandNames = this->getStackBandNames(datasets, numDS, imageBandNames, replaceBandNames);
+        int numInBands = bandNames.size();
+        
+        // Create new Image
+        GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(gdalFormat.c_str());
+        if(gdalDriver == NULL)
+        {
+            throw RSGISImageBandException("Requested GDAL driver does not exists..");
+        }
+        char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(gdalFormat);
+        std::cout << "New image width = " << width << " height = " << height << " bands = " << numInBands << std::endl;
+        
+        GDALDataset *outputImageDS = gdalDriver->Create(outputImage.c_str(), width, height, numInBands, gdalDataType, papszOptions);
+        if(outputImageDS == NULL)
+        {
+            throw RSGISImageBandException("Output image could not be created. Check filepath.");
+        }
+        outputImageDS->SetGeoTransform(gdalTranslation);
+        outputImageDS->SetProjection(datasets[0]->GetProjectionRef());
+        
+        // The first band of each input within the output, and the inputs grouped
+        // by dataset so a shared dataset is only read by one thread.
+        std::vector<int> firstBands(numDS, 0);
+        std::vector<std::vector<int> > readGroups;
+        std::map<GDALDataset*, size_t> groupIdxs;
+        int counter = 0;
+        for(int i = 0; i < numDS; i++)
+        {
+            firstBands[i] = counter;
+            for(int j = 0; j < datasets[i]->GetRasterCount(); j++)
+            {
+                GDALRasterBand *outBand = outputImageDS->GetRasterBand(counter+1);
+                outBand->SetDescription(bandNames[counter].c_str());
+                int hasNoData = false;
+                double noDataVal = datasets[i]->GetRasterBand(j+1)->GetNoDataValue(&hasNoData);
+                if(hasNoData)
+                {
+                    outBand->SetNoDataValue(noDataVal);
+                }
+                counter++;
+            }
+            if(groupIdxs.count(datasets[i]) == 0)
+            {
+                groupIdxs[datasets[i]] = readGroups.size();
+                readGroups.push_back(std::vector<int>());
+            }
+            readGroups[groupIdxs[datasets[i]]].push_back(i);
+        }
+        
+        int outXBlockSize = 0;
+        int outYBlockSize = 0;
+        outputImageDS->GetRasterBand(1)->GetBlockSize(&outXBlockSize, &outYBlockSize);
+        if(outYBlockSize > yBlockSize)
+        {
+            yBlockSize = outYBlockSize;
+        }
+        size_t pxlBytes = GDALGetDataTypeSizeBytes(gdalDataType);
+        int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, pxlBytes * numInBands, rsgis::RSGISExecutionContextUtils::getDefaultContext().stripMemoryMB);
+        if(stripRows < 1)
+        {
+            stripRows = 1;
+        }
+        size_t bandBytes = ((size_t)width) * stripRows * pxlBytes;
+        std::vector<unsigned char> stripData(bandBytes * numInBands);
+        
+        if(numThreads == 0)
+        {
+            numThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+        }
+        unsigned int numReadThreads = std::max<unsigned int>(std::min<size_t>(numThreads, readGroups.size()), 1);
+        rsgis::RSGISThreadPool threadPool(numReadThreads);
+        bool failed = false;
+        rsgis_tqdm pbar;
+        for(int row = 0; row < height; row += stripRows)
+        {
+            pbar.progress(row, height);
+            int nRows = std::min(stripRows, height - row);
+            bandBytes = ((size_t)width) * nRows * pxlBytes;
+            
+            // Read the input images in parallel, in the output data type.
+            std::atomic<size_t> nextGroup(0);
+            std::atomic<bool> readFailed(false);
+            threadPool.parallelFor(0, numReadThreads, [&](unsigned int w, size_t tStart, size_t tEnd)
+            {
+                for(size_t t = tStart; t < tEnd; ++t)
+                {
+                    size_t g = 0;
+                    while(((g = nextGroup.fetch_add(1)) < readGroups.size()) && (!readFailed))
+                    {
+                        for(std::vector<int>::iterator iterDS = readGroups[g].begin(); iterDS != readGroups[g].end(); ++iterDS)
+                        {
+                            int i = *iterDS;
+                            for(int j = 0; j < datasets[i]->GetRasterCount(); j++)
+                            {
+                                unsigned char *bandData = &stripData[bandBytes * (firstBands[i] + j)];
+                                if(datasets[i]->GetRasterBand(j+1)->RasterIO(GF_Read, dsOffsets[i][0], dsOffsets[i][1] + row, width, nRows, bandData, width, nRows, gdalDataType, 0, 0) != CE_None)
+                                {
+                                    readFailed = true;
+                                }
+                            }
+                        }
+                    }
+                }
+            });
+            if(readFailed)
+            {
+                failed = true;
+                break;
+            }
+            
+            // Write the strip with all the bands in a single call.
+            if(outputImageDS->RasterIO(GF_Write, 0, row, width, nRows, stripData.data(), width, nRows, gdalDataType, numInBands, NULL, 0, 0, 0) != CE_None)
+            {
+                failed = true;
+                break;
+            }
+        }
+        pbar.finish();
+        
+        GDALClose(outputImageDS);
+        if(failed)
+        {
+            throw RSGISImageBandException("Failed to copy the image bands into the output image.");
+        }
+    }
+    
+    std::vector<std::string> RSGISAddBands::getStackBandNames(GDALDataset **datasets, int numDS, std::string *imageBandNames, bool replaceBandNames)
+    {
+        rsgis::math::RSGISMathsUtils mathUtils;
+        std::vector<std::string> bandNames;
+        for(int i = 0; i < numDS; i++)
+        {
+            for(int j = 0; j < datasets[i]->GetRasterCount(); j++)
+            {
+                std::string bandName = "";
+                if(replaceBandNames)
+                {
+                    bandName = imageBandNames[i];
+                }
+                else
+                {
+                    bandName = datasets[i]->GetRasterBand(j+1)->GetDescription();
+                }
+                if(bandName == "")
+                {
+                    bandName = std::string("Band ") + mathUtils.inttostring(i+1);
+                }
+                bandNames.push_back(bandName);
+            }
+        }
+        return bandNames;
+    }
+    
     RSGISAddBands::~RSGISAddBands()
     {
         
@@ -28,10 +28,17 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <map>
+#include <atomic>
 
 #include "gdal_priv.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
 
 #include "common/rsgis-tqdm.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISExecutionContext.h"
 
 #include "img/RSGISImageBandException.h"
 #include "img/RSGISImageUtils.h"
@@ -64,7 +71,21 @@ namespace rsgis
 				void addMultipleBands(GDALDataset *input, GDALDataset **toAdd, std::string *outputFile, int *band, int numAddBands);
 				void addBandToFile(GDALDataset *input, GDALDataset *toAdd, std::string *outputFile, int band);
 				void stackImages(GDALDataset **datasets, int numDS, std::string outputImage, std::string *imageBandNames, bool skipPixels, float skipValue = 0, float noDataValue = 0, std::string gdalFormat="ENVI", GDALDataType gdalDataType=GDT_Float32, bool replaceBandNames=false);
+                /**
+                 * Stack the bands as a VRT which references the bands of the input images (for their overlap)
+                 * rather than copying the pixel values. The band names and no data values are kept.
+                 */
+                void stackImagesVRT(GDALDataset **datasets, int numDS, std::string outputImage, std::string *imageBandNames, GDALDataType gdalDataType=GDT_Float32, bool replaceBandNames=false);
+                /**
+                 * Copy the bands into a new image, reading the bands in the data type of the output image
+                 * (rather than as floats) in block aligned strips, where the input images are read in parallel
+                 * (one thread per input image) and each strip written once with all the bands.
+                 */
+                void stackImagesCopy(GDALDataset **datasets, int numDS, std::string outputImage, std::string *imageBandNames, std::string gdalFormat="ENVI", GDALDataType gdalDataType=GDT_Float32, bool replaceBandNames=false, unsigned int numThreads=1);
 				~RSGISAddBands();
+            protected:
+                /** The names of the stacked bands, as used by stackImages. */
+                std::vector<std::string> getStackBandNames(GDALDataset **datasets, int numDS, std::string *imageBandNames, bool replaceBandNames);
 		};
         
         
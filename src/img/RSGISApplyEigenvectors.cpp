@@ -49,6 +49,46 @@ namespace rsgis{namespace img{
 		}
 	}
 
+    bool RSGISApplyEigenvectors::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        if(this->numOutBands > this->eigenvectors->n)
+        {
+            throw RSGISImageCalcException("There are no enough eigenvectors for the number of output bands");
+        }
+        if(this->eigenvectors->m != numBands)
+        {
+            throw RSGISImageCalcException("The length of the eigenvectors is not the same as the number of image bands.");
+        }
+        if(nPxls == 0)
+        {
+            return true;
+        }
+        
+        // The block is stored by band (i.e., a numBands x nPxls matrix) so output = eigenvectors x block.
+        this->blockData.resize(((size_t)numBands) * nPxls);
+        for(int j = 0; j < numBands; ++j)
+        {
+            std::copy(bands[j], bands[j] + nPxls, this->blockData.begin() + (j * nPxls));
+        }
+        this->blockOutput.resize(((size_t)this->numOutBands) * nPxls);
+        
+        gsl_matrix_const_view eigenMatrix = gsl_matrix_const_view_array(this->eigenvectors->matrix, this->numOutBands, this->eigenvectors->m);
+        gsl_matrix_const_view dataMatrix = gsl_matrix_const_view_array(this->blockData.data(), numBands, nPxls);
+        gsl_matrix_view outMatrix = gsl_matrix_view_array(this->blockOutput.data(), this->numOutBands, nPxls);
+        gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, &eigenMatrix.matrix, &dataMatrix.matrix, 0.0, &outMatrix.matrix);
+        
+        for(int i = 0; i < this->numOutBands; ++i)
+        {
+            std::copy(this->blockOutput.begin() + (i * nPxls), this->blockOutput.begin() + ((i + 1) * nPxls), output[i]);
+        }
+        return true;
+    }
+    
+    RSGISCalcImageValue* RSGISApplyEigenvectors::clone()
+    {
+        return new RSGISApplyEigenvectors(this->numOutBands, this->eigenvectors);
+    }
+
 	RSGISApplyEigenvectors::~RSGISApplyEigenvectors()
 	{
 		
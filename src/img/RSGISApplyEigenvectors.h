@@ -24,12 +24,16 @@
 #define RSGISApplyEigenvectors_H
 
 #include <iostream>
+#include <vector>
 
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 
 #include "math/RSGISMatrices.h"
 
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_blas.h>
+
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
 #undef DllExport
@@ -52,9 +56,14 @@ namespace rsgis
 			public: 
 				RSGISApplyEigenvectors(int numberOutBands, rsgis::math::Matrix *eigenvectors);
 				void calcImageValue(float *bandValues, int numBands, double *output);
+                /** Apply the eigenvectors to a block of pixels as a single matrix multiplication (dgemm). */
+                bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+                RSGISCalcImageValue* clone();
 				~RSGISApplyEigenvectors();
 			protected:
                 rsgis::math::Matrix *eigenvectors;
+                std::vector<double> blockData;
+                std::vector<double> blockOutput;
 			};
 	}
 }
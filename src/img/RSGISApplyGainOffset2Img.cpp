@@ -52,6 +52,36 @@ namespace rsgis{namespace img{
         }
     }
     
+    bool RSGISRescaleImageData::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        // Same expression as calcImageValue so the output is identical.
+        for(int i = 0; i < numBands; ++i)
+        {
+            const float *inBand = bands[i];
+            double *outBand = output[i];
+            for(size_t p = 0; p < nPxls; ++p)
+            {
+                outBand[p] = (inBand[p] == this->cNoDataVal)?this->nNoDataVal:((((inBand[p]-cOffset)/cGain) * nGain) + nOffset);
+            }
+        }
+        return true;
+    }
+    
+    RSGISCalcImageValue* RSGISRescaleImageData::clone()
+    {
+        return new RSGISRescaleImageData(this->numOutBands, this->cNoDataVal, this->cOffset, this->cGain, this->nNoDataVal, this->nOffset, this->nGain);
+    }
+    
+    RSGISAffineTransform RSGISRescaleImageData::getAffineTransform()
+    {
+        RSGISAffineTransform transform;
+        transform.bands.assign(this->numOutBands, RSGISAffineBandParams(this->cOffset, this->cGain, this->nGain, this->nOffset));
+        transform.useNoData = true;
+        transform.inNoData = this->cNoDataVal;
+        transform.outNoData = this->nNoDataVal;
+        return transform;
+    }
+    
     RSGISRescaleImageData::~RSGISRescaleImageData()
     {
         
@@ -30,6 +30,7 @@
 
 #include "img/RSGISCalcImage.h"
 #include "img/RSGISCalcImageValue.h"
+#include "img/RSGISCalcImageAffine.h"
 #include "img/RSGISImageBandException.h"
 #include "img/RSGISImageCalcException.h"
 
@@ -56,6 +57,10 @@ namespace rsgis{namespace img{
     public:
         RSGISRescaleImageData(int numOutputBands, float cNoDataVal, float cOffset, float cGain, float nNoDataVal, float nOffset, float nGain);
         void calcImageValue(float *bandValues, int numBands, double *output);
+        bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        RSGISCalcImageValue* clone();
+        /** The same rescaling as a RSGISAffineTransform, for RSGISCalcImageAffine. */
+        RSGISAffineTransform getAffineTransform();
         ~RSGISRescaleImageData();
     protected:
         float cNoDataVal;
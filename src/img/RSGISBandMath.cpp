@@ -30,13 +30,25 @@ namespace rsgis{namespace img{
 		this->numVariables = numVariables;
 		
 		this->muParser = muParser;
+        this->ownParser = false;
+        this->bulkVarsDefined = false;
 		this->inVals = new mu::value_type[numVariables];
 		for(int i = 0; i < numVariables; ++i)
 		{
+            inVals[i] = 0;
 			muParser->DefineVar(_T(variables[i]->name.c_str()), &inVals[i]);
 		}
 		
 	}
+    
+    void RSGISBandMath::defineScalarVars()
+    {
+        for(int i = 0; i < numVariables; ++i)
+        {
+            muParser->DefineVar(_T(variables[i]->name.c_str()), &inVals[i]);
+        }
+        this->bulkVarsDefined = false;
+    }
 
 	void RSGISBandMath::calcImageValue(float *bandValues, int numBands, double *output) 
 	{
@@ -47,6 +59,10 @@ namespace rsgis{namespace img{
 		
 		try 
 		{
+            if(this->bulkVarsDefined)
+            {
+                this->defineScalarVars();
+            }
 			for(int i = 0; i < numVariables; ++i)
 			{
 				inVals[i] = bandValues[variables[i]->band];
@@ -63,8 +79,79 @@ namespace rsgis{namespace img{
 		}
 	}
 
+    bool RSGISBandMath::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        if(numOutBands != 1)
+        {
+            throw RSGISImageCalcException("Incorrect number of output Image bands (should be equal to 1).");
+        }
+        if(nPxls == 0)
+        {
+            return true;
+        }
+        
+        try
+        {
+            // The variables are bound to the arrays, so they only need to be
+            // redefined if the arrays have been reallocated.
+            if((!this->bulkVarsDefined) || (this->bulkResults.size() < nPxls))
+            {
+                this->bulkVals.resize(numVariables);
+                for(int i = 0; i < numVariables; ++i)
+                {
+                    if(this->bulkVals[i].size() < nPxls)
+                    {
+                        this->bulkVals[i].resize(nPxls);
+                    }
+                    muParser->DefineVar(_T(variables[i]->name.c_str()), this->bulkVals[i].data());
+                }
+                if(this->bulkResults.size() < nPxls)
+                {
+                    this->bulkResults.resize(nPxls);
+                }
+                this->bulkVarsDefined = true;
+            }
+            
+            for(int i = 0; i < numVariables; ++i)
+            {
+                const float *band = bands[variables[i]->band];
+                mu::value_type *vals = this->bulkVals[i].data();
+                for(size_t p = 0; p < nPxls; ++p)
+                {
+                    vals[p] = band[p];
+                }
+            }
+            
+            muParser->Eval(this->bulkResults.data(), (int)nPxls);
+            
+            const mu::value_type *results = this->bulkResults.data();
+            double *out = output[0];
+            for(size_t p = 0; p < nPxls; ++p)
+            {
+                out[p] = results[p];
+            }
+        }
+        catch (mu::ParserError &e)
+        {
+            std::string message = std::string("ERROR: ") + std::string(e.GetMsg()) + std::string(":\t \'") + std::string(e.GetExpr()) + std::string("\'");
+            throw RSGISImageCalcException(message);
+        }
+        return true;
+    }
+    
+    RSGISCalcImageValue* RSGISBandMath::clone()
+    {
+        RSGISBandMath *bandMath = new RSGISBandMath(this->numOutBands, this->variables, this->numVariables, new mu::Parser(*this->muParser));
+        bandMath->ownParser = true;
+        return bandMath;
+    }
+
 	RSGISBandMath::~RSGISBandMath()
 	{
+        if(this->ownParser)
+        {
+            delete muParser;
+        }
         delete[] inVals;
 	}
     
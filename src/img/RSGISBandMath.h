@@ -25,6 +25,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include <cmath>
 
 #include "gdal_priv.h"
@@ -61,12 +62,26 @@ namespace rsgis{namespace img{
 		public: 
 			RSGISBandMath(int numberOutBands, VariableBands **variables, int numVariables, mu::Parser *muParser);
 			void calcImageValue(float *bandValues, int numBands, double *output);
+            /**
+             * Evaluate the expression for a block of pixels using the muParser bulk
+             * mode, where the variables are bound to arrays of values so the expression
+             * bytecode is run over the whole block in one call rather than calling
+             * Eval() for each pixel.
+             */
+            bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+            /** The clone has its own copy of the parser (including any user defined functions and constants). */
+            RSGISCalcImageValue* clone();
 			~RSGISBandMath();
 		private:
+            void defineScalarVars();
 			VariableBands **variables;
 			int numVariables;
             mu::Parser *muParser;
             mu::value_type *inVals;
+            bool ownParser;
+            bool bulkVarsDefined;
+            std::vector<std::vector<mu::value_type> > bulkVals;
+            std::vector<mu::value_type> bulkResults;
 		};
     
     
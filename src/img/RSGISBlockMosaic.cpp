@@ -0,0 +1,642 @@
+/*
+ *  RSGISBlockMosaic.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISBlockMosaic.h"
+
+namespace rsgis { namespace img {
+
+    RSGISDatasetLRUPool::RSGISDatasetLRUPool(unsigned int maxOpenDatasets): maxOpenDatasets(std::max(maxOpenDatasets, 1u))
+    {
+
+    }
+
+    GDALDataset* RSGISDatasetLRUPool::getDataset(unsigned int id, const std::string &image)
+    {
+        std::unordered_map<unsigned int, DatasetList::iterator>::iterator iterIdx = this->datasetsIdx.find(id);
+        if(iterIdx != this->datasetsIdx.end())
+        {
+            // Move to the front as the most recently used.
+            this->datasets.splice(this->datasets.begin(), this->datasets, iterIdx->second);
+            return iterIdx->second->second;
+        }
+
+        if(this->datasets.size() >= this->maxOpenDatasets)
+        {
+            GDALClose(this->datasets.back().second);
+            this->datasetsIdx.erase(this->datasets.back().first);
+            this->datasets.pop_back();
+        }
+
+        // Not shared so each pool (and thread) has its own handle.
+        GDALDataset *dataset = (GDALDataset *) GDALOpen(image.c_str(), GA_ReadOnly);
+        if(dataset == NULL)
+        {
+            std::string message = std::string("Could not open image ") + image;
+            throw rsgis::RSGISImageException(message.c_str());
+        }
+        this->datasets.push_front(std::make_pair(id, dataset));
+        this->datasetsIdx[id] = this->datasets.begin();
+        return dataset;
+    }
+
+    void RSGISDatasetLRUPool::closeDatasets(std::function<bool(unsigned int)> closeDataset)
+    {
+        for(DatasetList::iterator iterDS = this->datasets.begin(); iterDS != this->datasets.end(); )
+        {
+            if(closeDataset(iterDS->first))
+            {
+                GDALClose(iterDS->second);
+                this->datasetsIdx.erase(iterDS->first);
+                iterDS = this->datasets.erase(iterDS);
+            }
+            else
+            {
+                ++iterDS;
+            }
+        }
+    }
+
+    void RSGISDatasetLRUPool::closeAll()
+    {
+        for(DatasetList::iterator iterDS = this->datasets.begin(); iterDS != this->datasets.end(); ++iterDS)
+        {
+            GDALClose(iterDS->second);
+        }
+        this->datasets.clear();
+        this->datasetsIdx.clear();
+    }
+
+    RSGISDatasetLRUPool::~RSGISDatasetLRUPool()
+    {
+        this->closeAll();
+    }
+
+
+    RSGISBlockMosaic::RSGISBlockMosaic(): pxlTest(noPxlTest), skipVal(0), lowerThresh(0), upperThresh(0), testBand(0), overlapBehaviour(0), inputBandsDefined(false), numThreads(1), maxOpenDatasets(32), refBand(NULL), firstRefVal(1), statsUpdater(NULL)
+    {
+        std::fill(this->changedRegion, this->changedRegion + 4, 0);
+
+    }
+
+    void RSGISBlockMosaic::setSkipValue(float skipVal, unsigned int skipBand)
+    {
+        this->pxlTest = skipValPxlTest;
+        this->skipVal = skipVal;
+        this->testBand = skipBand;
+    }
+
+    void RSGISBlockMosaic::setBandSkipValue(float skipVal)
+    {
+        this->pxlTest = bandSkipValPxlTest;
+        this->skipVal = skipVal;
+        this->testBand = 0;
+    }
+
+    void RSGISBlockMosaic::setSkipThresholds(float lowerThresh, float upperThresh, unsigned int threshBand)
+    {
+        this->pxlTest = threshPxlTest;
+        this->lowerThresh = lowerThresh;
+        this->upperThresh = upperThresh;
+        this->testBand = threshBand;
+    }
+
+    void RSGISBlockMosaic::setOverlapBehaviour(unsigned int overlapBehaviour)
+    {
+        if(overlapBehaviour > 2)
+        {
+            throw rsgis::RSGISImageException("The overlap behaviour is not recognised, it must be 0 (overwrite), 1 (min) or 2 (max).");
+        }
+        this->overlapBehaviour = overlapBehaviour;
+    }
+
+    void RSGISBlockMosaic::setInputBands(std::vector<int> bands)
+    {
+        if(bands.empty())
+        {
+            throw RSGISImageBandException("No input bands have been specified.");
+        }
+        this->inputBands = bands;
+        this->inputBandsDefined = true;
+    }
+
+    void RSGISBlockMosaic::setNumThreads(unsigned int numThreads)
+    {
+        this->numThreads = numThreads;
+        if(this->numThreads == 0)
+        {
+            this->numThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+        }
+    }
+
+    void RSGISBlockMosaic::setMaxOpenDatasets(unsigned int maxOpenDatasets)
+    {
+        if(maxOpenDatasets == 0)
+        {
+            throw rsgis::RSGISImageException("At least one input dataset needs to be open at a time.");
+        }
+        this->maxOpenDatasets = maxOpenDatasets;
+    }
+
+    void RSGISBlockMosaic::setRefBand(GDALRasterBand *refBand, unsigned int firstRefVal)
+    {
+        this->refBand = refBand;
+        this->firstRefVal = firstRefVal;
+    }
+
+    void RSGISBlockMosaic::setStatsUpdater(RSGISPopStatsUpdater *statsUpdater)
+    {
+        this->statsUpdater = statsUpdater;
+    }
+
+    bool RSGISBlockMosaic::getChangedRegion(int *xOff, int *yOff, int *xSize, int *ySize)
+    {
+        *xOff = this->changedRegion[0];
+        *yOff = this->changedRegion[1];
+        *xSize = this->changedRegion[2];
+        *ySize = this->changedRegion[3];
+        return (this->changedRegion[2] > 0) && (this->changedRegion[3] > 0);
+    }
+
+    void RSGISBlockMosaic::mosaic(std::string *inputImages, int numDS, GDALDataset *outputDataset, float background)
+    {
+        this->mosaicBlocks(inputImages, numDS, outputDataset, false, background);
+    }
+
+    void RSGISBlockMosaic::include(std::string *inputImages, int numDS, GDALDataset *baseDataset)
+    {
+        if(this->overlapBehaviour != 0)
+        {
+            throw rsgis::RSGISImageException("Only the overwrite overlap behaviour can be used when including images.");
+        }
+        this->mosaicBlocks(inputImages, numDS, baseDataset, true, 0);
+    }
+
+    void RSGISBlockMosaic::update(std::string *inputImages, int numDS, GDALDataset *mosaicDataset, float background)
+    {
+        this->mosaicBlocks(inputImages, numDS, mosaicDataset, true, background);
+    }
+
+    void RSGISBlockMosaic::mosaicBlocks(std::string *inputImages, int numDS, GDALDataset *outputDataset, bool readOutput, float background)
+    {
+        MosaicJob job;
+        job.inputImages = inputImages;
+        job.outputDataset = outputDataset;
+        job.readOutput = readOutput;
+        job.background = background;
+        job.width = outputDataset->GetRasterXSize();
+        job.height = outputDataset->GetRasterYSize();
+        std::fill(this->changedRegion, this->changedRegion + 4, 0);
+
+        if(!this->inputBandsDefined)
+        {
+            this->inputBands.clear();
+            for(int n = 1; n <= outputDataset->GetRasterCount(); ++n)
+            {
+                this->inputBands.push_back(n);
+            }
+        }
+        int numBands = this->inputBands.size();
+        if(numBands > outputDataset->GetRasterCount())
+        {
+            throw RSGISImageBandException("The output image does not have enough image bands for the input bands specified.");
+        }
+        if(this->testBand >= ((unsigned int)numBands))
+        {
+            throw RSGISImageBandException("The band used to skip pixels is not within the images.");
+        }
+        if((this->overlapBehaviour != 0) && (this->pxlTest == bandSkipValPxlTest))
+        {
+            throw rsgis::RSGISImageException("The minimum and maximum overlap behaviours need a single band to test the pixels.");
+        }
+        if((this->refBand != NULL) && ((this->refBand->GetXSize() != job.width) || (this->refBand->GetYSize() != job.height)))
+        {
+            throw rsgis::RSGISImageException("The reference image needs to be the same size as the output image.");
+        }
+        double transformation[6];
+        outputDataset->GetGeoTransform(transformation);
+
+        // Find the region of the output image covered by each input and build an
+        // R-tree of those regions, along with the region covered by all the inputs.
+        job.footprints.resize(numDS);
+        int inXMin = job.width;
+        int inYMin = job.height;
+        int inXMax = 0;
+        int inYMax = 0;
+        std::vector<FootprintValue> footprintVals;
+        double imgTransform[6];
+        for(int ds = 0; ds < numDS; ++ds)
+        {
+            GDALDataset *dataset = (GDALDataset *) GDALOpenShared(inputImages[ds].c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImages[ds];
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            if(this->inputBandsDefined)
+            {
+                for(std::vector<int>::iterator iterBands = this->inputBands.begin(); iterBands != this->inputBands.end(); ++iterBands)
+                {
+                    if(((*iterBands) <= 0) || ((*iterBands) > dataset->GetRasterCount()))
+                    {
+                        GDALClose(dataset);
+                        std::string message = std::string("Band is not within the input dataset ") + inputImages[ds];
+                        throw RSGISImageBandException(message.c_str());
+                    }
+                }
+            }
+            else if(dataset->GetRasterCount() != numBands)
+            {
+                GDALClose(dataset);
+                std::string message = std::string("All input images need to have the same number of bands as the output image (") + inputImages[ds] + ")";
+                throw RSGISImageBandException(message.c_str());
+            }
+            dataset->GetGeoTransform(imgTransform);
+
+            InputFootprint *footprint = &job.footprints[ds];
+            footprint->xStart = floor(((imgTransform[0] - transformation[0])/transformation[1])+0.5);
+            footprint->yStart = floor(((transformation[3] - imgTransform[3])/transformation[1])+0.5);
+            footprint->xMin = std::max(footprint->xStart, 0);
+            footprint->yMin = std::max(footprint->yStart, 0);
+            footprint->xMax = std::min(footprint->xStart + dataset->GetRasterXSize(), job.width);
+            footprint->yMax = std::min(footprint->yStart + dataset->GetRasterYSize(), job.height);
+            GDALClose(dataset);
+
+            if((footprint->xMin < footprint->xMax) && (footprint->yMin < footprint->yMax))
+            {
+                // The boxes include their corners so use the last pixel covered.
+                FootprintBox box(FootprintPoint(footprint->xMin, footprint->yMin), FootprintPoint(footprint->xMax-1, footprint->yMax-1));
+                footprintVals.push_back(std::make_pair(box, (unsigned int)ds));
+                inXMin = std::min(inXMin, footprint->xMin);
+                inYMin = std::min(inYMin, footprint->yMin);
+                inXMax = std::max(inXMax, footprint->xMax);
+                inYMax = std::max(inYMax, footprint->yMax);
+            }
+        }
+        job.footprintsIdx = FootprintRTree(footprintVals.begin(), footprintVals.end());
+        if(footprintVals.empty())
+        {
+            // None of the inputs overlap the output image.
+            return;
+        }
+
+        // Process whole blocks of the output image, reading at least 512 x 512 pixels
+        // at a time so inputs are not read a few rows at a time.
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        outputDataset->GetRasterBand(1)->GetBlockSize(&xBlockSize, &yBlockSize);
+        xBlockSize = std::max(xBlockSize, 1);
+        yBlockSize = std::max(yBlockSize, 1);
+        job.tileXSize = std::min(xBlockSize * std::max(1, 512/xBlockSize), job.width);
+        job.tileYSize = std::min(yBlockSize * std::max(1, 512/yBlockSize), job.height);
+        // Only the blocks covering the inputs are visited, so updating a large
+        // mosaic with a few images only reads and writes the blocks they cover.
+        job.tileColStart = inXMin / job.tileXSize;
+        job.tileRowStart = inYMin / job.tileYSize;
+        job.numTileCols = ((inXMax - 1) / job.tileXSize) + 1 - job.tileColStart;
+        size_t numTileRows = ((inYMax - 1) / job.tileYSize) + 1 - job.tileRowStart;
+        size_t numTiles = numTileRows * job.numTileCols;
+        job.changedXMin = job.width;
+        job.changedYMin = job.height;
+        job.changedXMax = 0;
+        job.changedYMax = 0;
+        size_t tileNumPxls = ((size_t)job.tileXSize) * job.tileYSize;
+
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        std::vector<MosaicWorker> workers(threadPool.getNumThreads());
+        for(size_t t = 0; t < workers.size(); ++t)
+        {
+            workers[t].inputsPool = new RSGISDatasetLRUPool(this->maxOpenDatasets);
+            workers[t].outData.resize(tileNumPxls * numBands);
+            workers[t].inData.resize(tileNumPxls * numBands);
+            workers[t].pxlFilled.resize(tileNumPxls);
+            if(this->refBand != NULL)
+            {
+                workers[t].refData.resize(tileNumPxls);
+            }
+            if(this->statsUpdater != NULL)
+            {
+                workers[t].prevOutData.resize(tileNumPxls * numBands);
+            }
+        }
+
+        // Each thread is given a run of neighbouring blocks so the inputs it has open
+        // are likely to be needed again.
+        auto mosaicTiles = [&](unsigned int t, size_t tStart, size_t tEnd)
+        {
+            for(size_t tile = tStart; tile < tEnd; ++tile)
+            {
+                this->mosaicTile(&job, &workers[t], tile);
+            }
+        };
+
+        try
+        {
+            size_t batchTiles = std::max(((size_t)threadPool.getNumThreads()) * 4, (size_t)job.numTileCols);
+            rsgis_tqdm pbar;
+            for(size_t batchStart = 0; batchStart < numTiles; batchStart += batchTiles)
+            {
+                size_t batchEnd = std::min(batchStart + batchTiles, numTiles);
+                pbar.progress(batchStart, numTiles);
+                threadPool.parallelFor(batchStart, batchEnd, mosaicTiles);
+
+                // Close the inputs which are not needed for the following blocks.
+                int nextTileY = (job.tileRowStart + (batchEnd / job.numTileCols)) * job.tileYSize;
+                for(size_t t = 0; t < workers.size(); ++t)
+                {
+                    workers[t].inputsPool->closeDatasets([&](unsigned int input){return job.footprints[input].yMax <= nextTileY;});
+                }
+            }
+            pbar.finish();
+        }
+        catch(rsgis::RSGISImageException &e)
+        {
+            for(size_t t = 0; t < workers.size(); ++t)
+            {
+                delete workers[t].inputsPool;
+            }
+            throw e;
+        }
+
+        for(size_t t = 0; t < workers.size(); ++t)
+        {
+            delete workers[t].inputsPool;
+        }
+
+        if((job.changedXMin < job.changedXMax) && (job.changedYMin < job.changedYMax))
+        {
+            this->changedRegion[0] = job.changedXMin;
+            this->changedRegion[1] = job.changedYMin;
+            this->changedRegion[2] = job.changedXMax - job.changedXMin;
+            this->changedRegion[3] = job.changedYMax - job.changedYMin;
+        }
+    }
+
+    void RSGISBlockMosaic::mosaicTile(MosaicJob *job, MosaicWorker *worker, size_t tile)
+    {
+        int tileX = (job->tileColStart + (tile % job->numTileCols)) * job->tileXSize;
+        int tileY = (job->tileRowStart + (tile / job->numTileCols)) * job->tileYSize;
+        int tileWidth = std::min(job->tileXSize, job->width - tileX);
+        int tileHeight = std::min(job->tileYSize, job->height - tileY);
+        size_t numPxls = ((size_t)tileWidth) * tileHeight;
+        int numBands = this->inputBands.size();
+
+        worker->tileInputVals.clear();
+        FootprintBox tileBox(FootprintPoint(tileX, tileY), FootprintPoint(tileX + tileWidth - 1, tileY + tileHeight - 1));
+        job->footprintsIdx.query(boost::geometry::index::intersects(tileBox), std::back_inserter(worker->tileInputVals));
+        if(worker->tileInputVals.empty())
+        {
+            // The output image already has the background (or base image) values.
+            return;
+        }
+        worker->tileInputs.clear();
+        for(size_t i = 0; i < worker->tileInputVals.size(); ++i)
+        {
+            worker->tileInputs.push_back(worker->tileInputVals[i].second);
+        }
+        std::sort(worker->tileInputs.begin(), worker->tileInputs.end());
+
+        if(job->readOutput)
+        {
+            std::lock_guard<std::mutex> lock(job->outputMutex);
+            for(int n = 0; n < numBands; ++n)
+            {
+                if(job->outputDataset->GetRasterBand(n+1)->RasterIO(GF_Read, tileX, tileY, tileWidth, tileHeight, &worker->outData[n * numPxls], tileWidth, tileHeight, GDT_Float32, 0, 0) != CE_None)
+                {
+                    throw rsgis::RSGISImageException("Failed to read the output image.");
+                }
+            }
+            if((this->refBand != NULL) && (this->refBand->RasterIO(GF_Read, tileX, tileY, tileWidth, tileHeight, worker->refData.data(), tileWidth, tileHeight, GDT_UInt32, 0, 0) != CE_None))
+            {
+                throw rsgis::RSGISImageException("Failed to read the reference image.");
+            }
+        }
+        else
+        {
+            std::fill(worker->outData.begin(), worker->outData.begin() + (numPxls * numBands), job->background);
+            if(this->refBand != NULL)
+            {
+                std::fill(worker->refData.begin(), worker->refData.begin() + numPxls, 0);
+            }
+        }
+        if(this->statsUpdater != NULL)
+        {
+            std::copy(worker->outData.begin(), worker->outData.begin() + (numPxls * numBands), worker->prevOutData.begin());
+        }
+
+        bool pxlsChanged = false;
+        if(this->overlapBehaviour == 0)
+        {
+            if(this->pxlTest == bandSkipValPxlTest)
+            {
+                // Each band is tested on its own so fill the bands one at a time.
+                for(int n = 0; n < numBands; ++n)
+                {
+                    pxlsChanged = (this->overwriteTile(job, worker, tileX, tileY, tileWidth, tileHeight, n, 1, n) > 0) || pxlsChanged;
+                }
+            }
+            else
+            {
+                pxlsChanged = (this->overwriteTile(job, worker, tileX, tileY, tileWidth, tileHeight, 0, numBands, this->testBand) > 0);
+            }
+        }
+        else
+        {
+            pxlsChanged = this->minMaxTile(job, worker, tileX, tileY, tileWidth, tileHeight);
+        }
+
+        if(pxlsChanged)
+        {
+            std::lock_guard<std::mutex> lock(job->outputMutex);
+            for(int n = 0; n < numBands; ++n)
+            {
+                if(job->outputDataset->GetRasterBand(n+1)->RasterIO(GF_Write, tileX, tileY, tileWidth, tileHeight, &worker->outData[n * numPxls], tileWidth, tileHeight, GDT_Float32, 0, 0) != CE_None)
+                {
+                    throw rsgis::RSGISImageException("Failed to write to the output image.");
+                }
+            }
+            if((this->refBand != NULL) && (this->refBand->RasterIO(GF_Write, tileX, tileY, tileWidth, tileHeight, worker->refData.data(), tileWidth, tileHeight, GDT_UInt32, 0, 0) != CE_None))
+            {
+                throw rsgis::RSGISImageException("Failed to write to the reference image.");
+            }
+            if(this->statsUpdater != NULL)
+            {
+                for(int n = 0; n < numBands; ++n)
+                {
+                    const float *prevData = &worker->prevOutData[n * numPxls];
+                    const float *newData = &worker->outData[n * numPxls];
+                    for(size_t i = 0; i < numPxls; ++i)
+                    {
+                        if(prevData[i] != newData[i])
+                        {
+                            this->statsUpdater->addChange(n, prevData[i], newData[i]);
+                        }
+                    }
+                }
+            }
+            job->changedXMin = std::min(job->changedXMin, tileX);
+            job->changedYMin = std::min(job->changedYMin, tileY);
+            job->changedXMax = std::max(job->changedXMax, tileX + tileWidth);
+            job->changedYMax = std::max(job->changedYMax, tileY + tileHeight);
+        }
+    }
+
+    size_t RSGISBlockMosaic::overwriteTile(MosaicJob *job, MosaicWorker *worker, int tileX, int tileY, int tileWidth, int tileHeight, int bandStart, int numTileBands, int tileTestBand)
+    {
+        // The last valid value is used so read the inputs from the last
+        // to the first, stopping once all the pixels have a value.
+        size_t numPxls = ((size_t)tileWidth) * tileHeight;
+        std::vector<unsigned char> &pxlFilled = worker->pxlFilled;
+        std::fill(pxlFilled.begin(), pxlFilled.begin() + numPxls, 0);
+        size_t numFilled = 0;
+        for(size_t k = worker->tileInputs.size(); (k > 0) && (numFilled < numPxls); --k)
+        {
+            InputFootprint *footprint = &job->footprints[worker->tileInputs[k-1]];
+            int xMin = std::max(footprint->xMin, tileX);
+            int yMin = std::max(footprint->yMin, tileY);
+            int winWidth = std::min(footprint->xMax, tileX + tileWidth) - xMin;
+            int winHeight = std::min(footprint->yMax, tileY + tileHeight) - yMin;
+            size_t winNumPxls = ((size_t)winWidth) * winHeight;
+
+            // Skip inputs which are under pixels which already have a value.
+            bool inputNeeded = false;
+            for(int y = 0; (y < winHeight) && (!inputNeeded); ++y)
+            {
+                const unsigned char *filledRow = &pxlFilled[(((size_t)(yMin - tileY + y)) * tileWidth) + (xMin - tileX)];
+                for(int x = 0; x < winWidth; ++x)
+                {
+                    if(!filledRow[x])
+                    {
+                        inputNeeded = true;
+                        break;
+                    }
+                }
+            }
+            if(!inputNeeded)
+            {
+                continue;
+            }
+
+            this->readInput(job, worker, worker->tileInputs[k-1], xMin, yMin, winWidth, winHeight, bandStart, numTileBands);
+            const float *inData = worker->inData.data();
+            float *outData = worker->outData.data();
+            const float *testData = &inData[(tileTestBand - bandStart) * winNumPxls];
+
+            for(int y = 0; y < winHeight; ++y)
+            {
+                for(int x = 0; x < winWidth; ++x)
+                {
+                    size_t inIdx = (((size_t)y) * winWidth) + x;
+                    size_t outIdx = (((size_t)(yMin - tileY + y)) * tileWidth) + (xMin - tileX + x);
+                    if((!pxlFilled[outIdx]) && this->validPxl(testData[inIdx]))
+                    {
+                        for(int n = 0; n < numTileBands; ++n)
+                        {
+                            outData[((bandStart + n) * numPxls) + outIdx] = inData[(n * winNumPxls) + inIdx];
+                        }
+                        if((this->refBand != NULL) && (bandStart == 0))
+                        {
+                            worker->refData[outIdx] = this->firstRefVal + worker->tileInputs[k-1];
+                        }
+                        pxlFilled[outIdx] = 1;
+                        ++numFilled;
+                    }
+                }
+            }
+        }
+        return numFilled;
+    }
+
+    bool RSGISBlockMosaic::minMaxTile(MosaicJob *job, MosaicWorker *worker, int tileX, int tileY, int tileWidth, int tileHeight)
+    {
+        // The minimum or maximum valid value is used so all the inputs are read
+        // in order. As for the first input of a new mosaic, pixels which are still
+        // the background value are replaced by the value of a later input.
+        size_t numPxls = ((size_t)tileWidth) * tileHeight;
+        int numBands = this->inputBands.size();
+        bool pxlsChanged = false;
+        for(size_t k = 0; k < worker->tileInputs.size(); ++k)
+        {
+            InputFootprint *footprint = &job->footprints[worker->tileInputs[k]];
+            int xMin = std::max(footprint->xMin, tileX);
+            int yMin = std::max(footprint->yMin, tileY);
+            int winWidth = std::min(footprint->xMax, tileX + tileWidth) - xMin;
+            int winHeight = std::min(footprint->yMax, tileY + tileHeight) - yMin;
+            size_t winNumPxls = ((size_t)winWidth) * winHeight;
+
+            this->readInput(job, worker, worker->tileInputs[k], xMin, yMin, winWidth, winHeight, 0, numBands);
+            const float *inData = worker->inData.data();
+            float *outData = worker->outData.data();
+
+            for(int y = 0; y < winHeight; ++y)
+            {
+                for(int x = 0; x < winWidth; ++x)
+                {
+                    size_t inIdx = (((size_t)y) * winWidth) + x;
+                    size_t outIdx = (((size_t)(yMin - tileY + y)) * tileWidth) + (xMin - tileX + x);
+                    float inVal = inData[(this->testBand * winNumPxls) + inIdx];
+                    float outVal = outData[(this->testBand * numPxls) + outIdx];
+                    if(!this->validPxl(inVal))
+                    {
+                        continue;
+                    }
+                    if((!job->readOutput && (worker->tileInputs[k] == 0)) || (outVal == job->background) || ((this->overlapBehaviour == 1) && (inVal < outVal)) || ((this->overlapBehaviour == 2) && (inVal > outVal)))
+                    {
+                        for(int n = 0; n < numBands; ++n)
+                        {
+                            outData[(n * numPxls) + outIdx] = inData[(n * winNumPxls) + inIdx];
+                        }
+                        if(this->refBand != NULL)
+                        {
+                            worker->refData[outIdx] = this->firstRefVal + worker->tileInputs[k];
+                        }
+                        pxlsChanged = true;
+                    }
+                }
+            }
+        }
+        return pxlsChanged;
+    }
+
+    void RSGISBlockMosaic::readInput(MosaicJob *job, MosaicWorker *worker, unsigned int input, int xMin, int yMin, int xSize, int ySize, int bandStart, int numReadBands)
+    {
+        const std::string &inputImage = job->inputImages[input];
+        InputFootprint *footprint = &job->footprints[input];
+        GDALDataset *dataset = worker->inputsPool->getDataset(input, inputImage);
+
+        size_t numPxls = ((size_t)xSize) * ySize;
+        for(int n = 0; n < numReadBands; ++n)
+        {
+            GDALRasterBand *band = dataset->GetRasterBand(this->inputBands[bandStart + n]);
+            if(band->RasterIO(GF_Read, xMin - footprint->xStart, yMin - footprint->yStart, xSize, ySize, &worker->inData[n * numPxls], xSize, ySize, GDT_Float32, 0, 0) != CE_None)
+            {
+                std::string message = std::string("Failed to read image ") + inputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+        }
+    }
+
+    RSGISBlockMosaic::~RSGISBlockMosaic()
+    {
+
+    }
+
+}}
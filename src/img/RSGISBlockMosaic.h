@@ -0,0 +1,245 @@
+/*
+ *  RSGISBlockMosaic.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISBlockMosaic_H
+#define RSGISBlockMosaic_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+
+#include "gdal_priv.h"
+
+#include "common/rsgis-tqdm.h"
+#include "common/RSGISImageException.h"
+#include "common/RSGISThreadPool.h"
+
+#include "img/RSGISImageBandException.h"
+#include "img/RSGISPopWithStats.h"
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/point.hpp>
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis { namespace img {
+
+    /**
+     * A bounded pool of read only GDAL datasets. When the pool is full the least recently
+     * used dataset is closed to make room. A pool is not thread safe so each thread needs
+     * its own pool.
+     */
+    class DllExport RSGISDatasetLRUPool
+    {
+    public:
+        RSGISDatasetLRUPool(unsigned int maxOpenDatasets);
+        /** Get the dataset for the image with the ID given, opening it if it is not in the pool. */
+        GDALDataset* getDataset(unsigned int id, const std::string &image);
+        /** Close the datasets in the pool for which closeDataset returns true. */
+        void closeDatasets(std::function<bool(unsigned int)> closeDataset);
+        void closeAll();
+        unsigned int getNumOpenDatasets(){return this->datasets.size();};
+        ~RSGISDatasetLRUPool();
+    protected:
+        typedef std::list<std::pair<unsigned int, GDALDataset*> > DatasetList;
+        unsigned int maxOpenDatasets;
+        // The most recently used dataset is at the front of the list.
+        DatasetList datasets;
+        std::unordered_map<unsigned int, DatasetList::iterator> datasetsIdx;
+    private:
+        RSGISDatasetLRUPool(const RSGISDatasetLRUPool&);
+        RSGISDatasetLRUPool& operator=(const RSGISDatasetLRUPool&);
+    };
+
+    /**
+     * Mosaic a list of images into an existing output image by visiting each block of the
+     * output image once. The inputs overlapping a block are found with an R-tree of the
+     * input footprints and only those inputs are read. Where inputs overlap, the later
+     * inputs take priority (overlapBehaviour 0), so the inputs are read from the last to
+     * the first and reading stops once every pixel of the block has a value. Otherwise,
+     * the minimum (1) or maximum (2) value is taken.
+     *
+     * The blocks are processed in parallel where each thread keeps its own bounded pool
+     * of open inputs, so the number of open files is limited to numThreads x maxOpenDatasets
+     * whatever the number of inputs. Input datasets are closed once the blocks have passed them.
+     *
+     * Only the blocks intersecting the input footprints are visited, so an existing mosaic
+     * can be updated with newly arrived images (update) in time proportional to their
+     * footprints rather than the mosaic. A reference image can record the input each pixel
+     * of the mosaic came from (setRefBand), and the statistics of the mosaic can be updated
+     * with the pixels changed (setStatsUpdater).
+     */
+    class DllExport RSGISBlockMosaic
+    {
+    public:
+        RSGISBlockMosaic();
+        /** Pixels where skipBand (from 0) is equal to skipVal are not copied. */
+        void setSkipValue(float skipVal, unsigned int skipBand);
+        /** Pixels equal to skipVal are not copied, where each band is tested on its own. */
+        void setBandSkipValue(float skipVal);
+        /** Only copy pixels where threshBand (from 0) is between the thresholds (exclusive). */
+        void setSkipThresholds(float lowerThresh, float upperThresh, unsigned int threshBand);
+        /** 0 - later inputs overwrite earlier ones, 1 - minimum value, 2 - maximum value (of the skip/thresh band). */
+        void setOverlapBehaviour(unsigned int overlapBehaviour);
+        /** Copy the input bands (from 1) into the output bands 1 to bands.size(), rather than all the bands. */
+        void setInputBands(std::vector<int> bands);
+        /** The number of threads used to process the output blocks (0 uses all the available cores). */
+        void setNumThreads(unsigned int numThreads);
+        /** The maximum number of input datasets each thread keeps open. */
+        void setMaxOpenDatasets(unsigned int maxOpenDatasets);
+        /** Mosaic the inputs into outputDataset, which has been filled with the background value. */
+        void mosaic(std::string *inputImages, int numDS, GDALDataset *outputDataset, float background);
+        /** Copy the inputs into baseDataset, keeping the existing values where there are no inputs. */
+        void include(std::string *inputImages, int numDS, GDALDataset *baseDataset);
+        /**
+         * Update an existing mosaic with new inputs, as if they had been the last inputs of
+         * the mosaic. For the minimum and maximum overlap behaviours the new inputs are compared
+         * with the values of the mosaic, where pixels which are the background value have no value.
+         */
+        void update(std::string *inputImages, int numDS, GDALDataset *mosaicDataset, float background);
+        /**
+         * Record the input each pixel of the output came from in refBand (of the same size as
+         * the output), as firstRefVal plus the index of the input. Pixels without an input are
+         * 0 for a new mosaic and otherwise keep their existing value.
+         */
+        void setRefBand(GDALRasterBand *refBand, unsigned int firstRefVal=1);
+        /** Give the old and new values of the pixels changed in the output to statsUpdater. */
+        void setStatsUpdater(RSGISPopStatsUpdater *statsUpdater);
+        /** Get the region of the output changed by the last mosaic, include or update (returns false if none). */
+        bool getChangedRegion(int *xOff, int *yOff, int *xSize, int *ySize);
+        ~RSGISBlockMosaic();
+    protected:
+        enum ValidPxlTest
+        {
+            noPxlTest,
+            skipValPxlTest,
+            threshPxlTest,
+            bandSkipValPxlTest
+        };
+        struct InputFootprint
+        {
+            // Position of the input in the output image.
+            int xStart;
+            int yStart;
+            // Region of the output image covered by the input.
+            int xMin;
+            int yMin;
+            int xMax;
+            int yMax;
+        };
+        typedef boost::geometry::model::point<int, 2, boost::geometry::cs::cartesian> FootprintPoint;
+        typedef boost::geometry::model::box<FootprintPoint> FootprintBox;
+        typedef std::pair<FootprintBox, unsigned int> FootprintValue;
+        typedef boost::geometry::index::rtree<FootprintValue, boost::geometry::index::quadratic<16> > FootprintRTree;
+        /** The buffers and open inputs used by each thread. */
+        struct MosaicWorker
+        {
+            RSGISDatasetLRUPool *inputsPool;
+            std::vector<float> outData;
+            std::vector<float> inData;
+            std::vector<unsigned char> pxlFilled;
+            std::vector<uint32_t> refData;
+            std::vector<float> prevOutData;
+            std::vector<FootprintValue> tileInputVals;
+            std::vector<unsigned int> tileInputs;
+        };
+        /** The output image, the inputs and the block layout shared by the threads. */
+        struct MosaicJob
+        {
+            std::string *inputImages;
+            std::vector<InputFootprint> footprints;
+            FootprintRTree footprintsIdx;
+            GDALDataset *outputDataset;
+            bool readOutput;
+            float background;
+            int width;
+            int height;
+            int tileXSize;
+            int tileYSize;
+            // The range of blocks visited, which cover the inputs.
+            int tileColStart;
+            int tileRowStart;
+            int numTileCols;
+            // The region of the output changed.
+            int changedXMin;
+            int changedYMin;
+            int changedXMax;
+            int changedYMax;
+            // Only one thread at a time can use the output dataset.
+            std::mutex outputMutex;
+        };
+        inline bool validPxl(float val)
+        {
+            if((this->pxlTest == skipValPxlTest) || (this->pxlTest == bandSkipValPxlTest))
+            {
+                return val != this->skipVal;
+            }
+            else if(this->pxlTest == threshPxlTest)
+            {
+                return (val > this->lowerThresh) && (val < this->upperThresh);
+            }
+            return true;
+        };
+        void mosaicBlocks(std::string *inputImages, int numDS, GDALDataset *outputDataset, bool readOutput, float background);
+        void mosaicTile(MosaicJob *job, MosaicWorker *worker, size_t tile);
+        size_t overwriteTile(MosaicJob *job, MosaicWorker *worker, int tileX, int tileY, int tileWidth, int tileHeight, int bandStart, int numTileBands, int tileTestBand);
+        bool minMaxTile(MosaicJob *job, MosaicWorker *worker, int tileX, int tileY, int tileWidth, int tileHeight);
+        void readInput(MosaicJob *job, MosaicWorker *worker, unsigned int input, int xMin, int yMin, int xSize, int ySize, int bandStart, int numReadBands);
+        ValidPxlTest pxlTest;
+        float skipVal;
+        float lowerThresh;
+        float upperThresh;
+        unsigned int testBand;
+        unsigned int overlapBehaviour;
+        std::vector<int> inputBands;
+        bool inputBandsDefined;
+        unsigned int numThreads;
+        unsigned int maxOpenDatasets;
+        GDALRasterBand *refBand;
+        unsigned int firstRefVal;
+        RSGISPopStatsUpdater *statsUpdater;
+        int changedRegion[4];
+    };
+
+}}
+
+#endif
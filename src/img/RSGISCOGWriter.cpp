@@ -0,0 +1,326 @@
+/*
+ *  RSGISCOGWriter.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISCOGWriter.h"
+
+namespace rsgis{namespace img{
+    
+    RSGISCOGWriter::RSGISCOGWriter(std::string outputImage, int width, int height, int numBands, GDALDataType eType, double *gdalTranslation, std::string proj, unsigned int numThreads)
+    {
+        this->outputImage = outputImage;
+        this->tmpImage = outputImage + std::string("_cogtmp.tif");
+        this->tmpDS = NULL;
+        this->width = width;
+        this->height = height;
+        this->numBands = numBands;
+        this->nextRow = 0;
+        this->useNoData = false;
+        this->noDataVal = 0.0;
+        this->threadPool = NULL;
+        
+        RSGISImageUtils imgUtils;
+        this->cogOptions = imgUtils.getGDALCreationOptionsForFormat("COG");
+        int blockSize = RSGIS_COG_DEFAULT_BLOCKSIZE;
+        const char *blockSizeOpt = CSLFetchNameValue(this->cogOptions, "BLOCKSIZE");
+        if((blockSizeOpt != NULL) && (atoi(blockSizeOpt) > 0))
+        {
+            blockSize = atoi(blockSizeOpt);
+        }
+        this->resampling = pyramidAverage;
+        const char *resamplingOpt = CSLFetchNameValue(this->cogOptions, "RESAMPLING");
+        if(resamplingOpt != NULL)
+        {
+            if(EQUAL(resamplingOpt, "NEAREST"))
+            {
+                this->resampling = pyramidNearest;
+            }
+            else if(EQUAL(resamplingOpt, "MODE"))
+            {
+                this->resampling = pyramidMode;
+            }
+        }
+        
+        if(GetGDALDriverManager()->GetDriverByName("COG") == NULL)
+        {
+            CSLDestroy(this->cogOptions);
+            throw RSGISImageException("The GDAL COG driver is not available (GDAL 3.1 or later is required).");
+        }
+        GDALDriver *gtiffDriver = GetGDALDriverManager()->GetDriverByName("GTiff");
+        if(gtiffDriver == NULL)
+        {
+            CSLDestroy(this->cogOptions);
+            throw RSGISImageException("The GDAL GTiff driver is not available.");
+        }
+        
+        // The temporary image has the tiles of the COG so the COG driver can copy the tiles.
+        std::string blockSizeStr = std::to_string(blockSize);
+        char **tmpOptions = NULL;
+        tmpOptions = CSLSetNameValue(tmpOptions, "TILED", "YES");
+        tmpOptions = CSLSetNameValue(tmpOptions, "BLOCKXSIZE", blockSizeStr.c_str());
+        tmpOptions = CSLSetNameValue(tmpOptions, "BLOCKYSIZE", blockSizeStr.c_str());
+        tmpOptions = CSLSetNameValue(tmpOptions, "COMPRESS", "LZW");
+        tmpOptions = CSLSetNameValue(tmpOptions, "BIGTIFF", "IF_SAFER");
+        if(CSLFetchNameValue(this->cogOptions, "NUM_THREADS") != NULL)
+        {
+            tmpOptions = CSLSetNameValue(tmpOptions, "NUM_THREADS", CSLFetchNameValue(this->cogOptions, "NUM_THREADS"));
+        }
+        this->tmpDS = gtiffDriver->Create(this->tmpImage.c_str(), width, height, numBands, eType, tmpOptions);
+        CSLDestroy(tmpOptions);
+        if(this->tmpDS == NULL)
+        {
+            CSLDestroy(this->cogOptions);
+            std::string message = std::string("Could not create the temporary image ") + this->tmpImage;
+            throw RSGISImageException(message.c_str());
+        }
+        this->tmpDS->SetGeoTransform(gdalTranslation);
+        this->tmpDS->SetProjection(proj.c_str());
+        
+        // Overviews are added (as the COG driver would) until the overview fits within a tile.
+        std::vector<int> factors;
+        int factor = 1;
+        while(((width + factor - 1) / factor > blockSize) || ((height + factor - 1) / factor > blockSize))
+        {
+            factor *= 2;
+            factors.push_back(factor);
+        }
+        try
+        {
+            if(!factors.empty())
+            {
+                // Only allocates the overviews; the pixel values are written by addLevelRows.
+                if(this->tmpDS->BuildOverviews("NONE", factors.size(), factors.data(), 0, NULL, GDALDummyProgress, NULL) != CE_None)
+                {
+                    throw RSGISImageException("Could not create the overviews of the temporary image.");
+                }
+            }
+            int srcWidth = width;
+            int srcHeight = height;
+            for(size_t i = 0; i < factors.size(); ++i)
+            {
+                RSGISCOGOverviewLevel level;
+                for(int n = 0; n < numBands; ++n)
+                {
+                    GDALRasterBand *ovBand = this->tmpDS->GetRasterBand(n+1)->GetOverview(i);
+                    if(ovBand == NULL)
+                    {
+                        throw RSGISImageException("Could not get the overviews of the temporary image.");
+                    }
+                    level.bands.push_back(ovBand);
+                }
+                level.srcWidth = srcWidth;
+                level.srcHeight = srcHeight;
+                level.width = level.bands[0]->GetXSize();
+                level.height = level.bands[0]->GetYSize();
+                RSGISImagePyramidBuilder::calcSrcWindows(this->resampling, srcWidth, level.width, &level.xOff, &level.xOff2);
+                RSGISImagePyramidBuilder::calcSrcWindows(this->resampling, srcHeight, level.height, &level.yOff, &level.yOff2);
+                level.srcVals.resize(numBands);
+                level.srcStartRow = 0;
+                level.srcNumRows = 0;
+                level.nextRow = 0;
+                this->levels.push_back(level);
+                srcWidth = level.width;
+                srcHeight = level.height;
+            }
+        }
+        catch(RSGISImageException &e)
+        {
+            GDALClose(this->tmpDS);
+            gtiffDriver->Delete(this->tmpImage.c_str());
+            this->tmpDS = NULL;
+            CSLDestroy(this->cogOptions);
+            throw e;
+        }
+        
+        this->threadPool = new rsgis::RSGISThreadPool(numThreads);
+    }
+    
+    void RSGISCOGWriter::setNoDataValue(double noDataVal)
+    {
+        if(this->nextRow > 0)
+        {
+            throw RSGISImageException("The no data value must be set before the image is written.");
+        }
+        this->useNoData = true;
+        this->noDataVal = noDataVal;
+        for(int n = 0; n < this->numBands; ++n)
+        {
+            this->tmpDS->GetRasterBand(n+1)->SetNoDataValue(noDataVal);
+        }
+    }
+    
+    void RSGISCOGWriter::writeStrip(int row, int nRows, double **bandVals)
+    {
+        if(this->tmpDS == NULL)
+        {
+            throw RSGISImageException("The COG writer has been closed.");
+        }
+        if((row != this->nextRow) || (nRows < 0) || ((row + nRows) > this->height))
+        {
+            throw RSGISImageException("The strips of a COG must be written in order down the image.");
+        }
+        for(int n = 0; n < this->numBands; ++n)
+        {
+            if(this->tmpDS->GetRasterBand(n+1)->RasterIO(GF_Write, 0, row, this->width, nRows, bandVals[n], this->width, nRows, GDT_Float64, 0, 0) != CE_None)
+            {
+                throw RSGISImageException("Could not write to the temporary image.");
+            }
+        }
+        this->nextRow += nRows;
+        if(!this->levels.empty())
+        {
+            this->addLevelRows(0, nRows, bandVals);
+        }
+    }
+    
+    void RSGISCOGWriter::addLevelRows(unsigned int levelIdx, int nRows, double **bandVals)
+    {
+        RSGISCOGOverviewLevel &level = this->levels[levelIdx];
+        size_t srcRowVals = level.srcWidth;
+        for(int n = 0; n < this->numBands; ++n)
+        {
+            level.srcVals[n].insert(level.srcVals[n].end(), bandVals[n], bandVals[n] + (srcRowVals * nRows));
+        }
+        level.srcNumRows += nRows;
+        
+        // The overview rows for which all of the source rows are available.
+        int firstRow = level.nextRow;
+        int lastRow = firstRow;
+        while((lastRow < level.height) && (level.yOff2[lastRow] <= (level.srcStartRow + level.srcNumRows)))
+        {
+            ++lastRow;
+        }
+        int nOutRows = lastRow - firstRow;
+        if(nOutRows == 0)
+        {
+            return;
+        }
+        
+        std::vector<std::vector<double> > outVals(this->numBands, std::vector<double>(((size_t)level.width) * nOutRows));
+        std::vector<double*> outPtrs(this->numBands);
+        for(int n = 0; n < this->numBands; ++n)
+        {
+            outPtrs[n] = outVals[n].data();
+        }
+        std::vector<std::vector<double> > modeVals(this->threadPool->getNumThreads());
+        this->threadPool->parallelFor(0, nOutRows, [&](unsigned int t, size_t yStart, size_t yEnd)
+        {
+            for(size_t y = yStart; y < yEnd; ++y)
+            {
+                int yOff = level.yOff[firstRow + y] - level.srcStartRow;
+                int yOff2 = level.yOff2[firstRow + y] - level.srcStartRow;
+                for(int n = 0; n < this->numBands; ++n)
+                {
+                    double *outRow = outPtrs[n] + (y * level.width);
+                    for(int x = 0; x < level.width; ++x)
+                    {
+                        outRow[x] = RSGISImagePyramidBuilder::resamplePxl(this->resampling, level.srcVals[n].data(), level.srcWidth, level.xOff[x], level.xOff2[x], yOff, yOff2, this->useNoData, this->noDataVal, &modeVals[t]);
+                    }
+                }
+            }
+        });
+        for(int n = 0; n < this->numBands; ++n)
+        {
+            if(level.bands[n]->RasterIO(GF_Write, 0, firstRow, level.width, nOutRows, outPtrs[n], level.width, nOutRows, GDT_Float64, 0, 0) != CE_None)
+            {
+                throw RSGISImageException("Could not write to the overviews of the temporary image.");
+            }
+        }
+        level.nextRow = lastRow;
+        
+        // The source rows before the window of the next overview row are no longer needed.
+        int keepRow = (lastRow < level.height)?level.yOff[lastRow]:(level.srcStartRow + level.srcNumRows);
+        int dropRows = std::max(0, std::min(keepRow - level.srcStartRow, level.srcNumRows));
+        if(dropRows > 0)
+        {
+            for(int n = 0; n < this->numBands; ++n)
+            {
+                level.srcVals[n].erase(level.srcVals[n].begin(), level.srcVals[n].begin() + (srcRowVals * dropRows));
+            }
+            level.srcStartRow += dropRows;
+            level.srcNumRows -= dropRows;
+        }
+        
+        if((levelIdx + 1) < this->levels.size())
+        {
+            this->addLevelRows(levelIdx + 1, nOutRows, outPtrs.data());
+        }
+    }
+    
+    void RSGISCOGWriter::close()
+    {
+        if(this->tmpDS == NULL)
+        {
+            throw RSGISImageException("The COG writer has already been closed.");
+        }
+        if(this->nextRow != this->height)
+        {
+            throw RSGISImageException("Not all the rows of the COG have been written.");
+        }
+        this->tmpDS->FlushCache();
+        
+        // The tiles and overviews of the temporary image are copied into the COG layout.
+        GDALDriver *cogDriver = GetGDALDriverManager()->GetDriverByName("COG");
+        char **options = CSLDuplicate(this->cogOptions);
+        if(CSLFetchNameValue(options, "OVERVIEWS") == NULL)
+        {
+            options = CSLSetNameValue(options, "OVERVIEWS", "FORCE_USE_EXISTING");
+        }
+        GDALDataset *cogDS = cogDriver->CreateCopy(this->outputImage.c_str(), this->tmpDS, FALSE, options, NULL, NULL);
+        CSLDestroy(options);
+        if(cogDS == NULL)
+        {
+            std::string message = std::string("Could not create the COG ") + this->outputImage;
+            throw RSGISImageException(message.c_str());
+        }
+        GDALClose(cogDS);
+        
+        GDALClose(this->tmpDS);
+        this->tmpDS = NULL;
+        GDALDriver *gtiffDriver = GetGDALDriverManager()->GetDriverByName("GTiff");
+        gtiffDriver->Delete(this->tmpImage.c_str());
+    }
+    
+    bool RSGISCOGWriter::isCOGFormat(std::string gdalFormat)
+    {
+        return EQUAL(gdalFormat.c_str(), "COG");
+    }
+    
+    RSGISCOGWriter::~RSGISCOGWriter()
+    {
+        if(this->tmpDS != NULL)
+        {
+            GDALClose(this->tmpDS);
+            GDALDriver *gtiffDriver = GetGDALDriverManager()->GetDriverByName("GTiff");
+            if(gtiffDriver != NULL)
+            {
+                gtiffDriver->Delete(this->tmpImage.c_str());
+            }
+        }
+        if(this->threadPool != NULL)
+        {
+            delete this->threadPool;
+        }
+        CSLDestroy(this->cogOptions);
+    }
+    
+}}
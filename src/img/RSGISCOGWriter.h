@@ -0,0 +1,134 @@
+/*
+ *  RSGISCOGWriter.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISCOGWriter_H
+#define RSGISCOGWriter_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "gdal_priv.h"
+#include "cpl_string.h"
+
+#include "common/RSGISImageException.h"
+#include "common/RSGISThreadPool.h"
+
+#include "img/RSGISImageUtils.h"
+#include "img/RSGISImagePyramids.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+    
+    /** The tile size of the cloud optimised GeoTIFFs if BLOCKSIZE is not in the COG creation options. */
+    static const unsigned int RSGIS_COG_DEFAULT_BLOCKSIZE( 512 );
+    
+    /**
+     * Writes an output image as a cloud optimised GeoTIFF (COG) as the strips of the
+     * image are produced, so a COG does not need a second pass (i.e., gdal_translate
+     * and gdaladdo) over the output. The strips are written, in order down the image,
+     * to a temporary tiled GeoTIFF with the same tile size as the COG. The overview
+     * levels (factors 2, 4, 8, ... until the overview fits within a tile) are built
+     * from the rows of the previous level as soon as the rows they need have been
+     * written, rather than being read back from the file. When the writer is closed
+     * the temporary image and its overviews are copied by the GDAL COG driver (using
+     * the existing overviews) to the COG layout and the temporary image is deleted.
+     *
+     * The COG creation options are taken from the RSGISLIB_IMG_CRT_OPTS_COG environment
+     * variable (see RSGISImageUtils::getGDALCreationOptionsForFormat). RESAMPLING=NEAREST
+     * or MODE selects the overview resampling, otherwise the average is used. No data
+     * values (and NaNs) are ignored by the average and mode resampling.
+     */
+    class DllExport RSGISCOGWriter
+    {
+    public:
+        /**
+         * Create a writer for a width x height image of numBands bands of type eType at outputImage.
+         * The overviews are resampled by numThreads threads (0 uses all available cores).
+         */
+        RSGISCOGWriter(std::string outputImage, int width, int height, int numBands, GDALDataType eType, double *gdalTranslation, std::string proj, unsigned int numThreads=1);
+        /**
+         * The temporary image being written; the band descriptions and metadata set on it
+         * are copied to the COG. It must not be written to directly, use writeStrip.
+         */
+        GDALDataset* getDataset(){return this->tmpDS;};
+        /** Set the no data value of all the bands; this must be called before the first strip is written. */
+        void setNoDataValue(double noDataVal);
+        /** Write the rows [row, row+nRows) of all the bands (each width x nRows values). The strips must be written in order. */
+        void writeStrip(int row, int nRows, double **bandVals);
+        /** Create the COG from the temporary image once all the rows have been written. */
+        void close();
+        /** Returns true if the format is to be written with a RSGISCOGWriter (i.e., COG). */
+        static bool isCOGFormat(std::string gdalFormat);
+        /** Deletes the temporary image (and the COG is not created) if close has not been called. */
+        ~RSGISCOGWriter();
+    protected:
+        struct RSGISCOGOverviewLevel
+        {
+            std::vector<GDALRasterBand*> bands;
+            int srcWidth;
+            int srcHeight;
+            int width;
+            int height;
+            std::vector<int> xOff;
+            std::vector<int> xOff2;
+            std::vector<int> yOff;
+            std::vector<int> yOff2;
+            // The rows [srcStartRow, srcStartRow+srcNumRows) of the previous level not yet fully used.
+            std::vector<std::vector<double> > srcVals;
+            int srcStartRow;
+            int srcNumRows;
+            int nextRow;
+        };
+        void addLevelRows(unsigned int level, int nRows, double **bandVals);
+        std::string outputImage;
+        std::string tmpImage;
+        char **cogOptions;
+        GDALDataset *tmpDS;
+        int width;
+        int height;
+        int numBands;
+        int nextRow;
+        RSGISPyramidResampling resampling;
+        bool useNoData;
+        double noDataVal;
+        std::vector<RSGISCOGOverviewLevel> levels;
+        rsgis::RSGISThreadPool *threadPool;
+    };
+    
+}}
+
+#endif
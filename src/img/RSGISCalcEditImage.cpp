@@ -28,436 +28,204 @@ namespace rsgis
 	{
         RSGISCalcEditImage::RSGISCalcEditImage(RSGISCalcImageValue *valueCalc)
         {
-            calc = valueCalc;
+            this->calc = valueCalc;
+            rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+            this->numThreads = context.numThreads;
+            this->stripMemoryMB = context.stripMemoryMB;
         }
             
         void RSGISCalcEditImage::calcImage(GDALDataset *dataset)
         {
-            RSGISImageUtils imgUtils;
-            double *gdalTranslation = new double[6];
-
-            int height = 0;
-            int width = 0;
-            int numInBands = 0;
+            if(dataset == NULL)
+            {
+                throw RSGISImageBandException("Dataset is not valid.");
+            }
+            
+            double gdalTranslation[6];
+            dataset->GetGeoTransform(gdalTranslation);
+            int numInBands = dataset->GetRasterCount();
+            int width = dataset->GetRasterXSize();
+            int height = dataset->GetRasterYSize();
+            
+            // Get Image Input Bands
+            std::vector<GDALRasterBand*> inputRasterBands(numInBands);
+            for(int i = 0; i < numInBands; i++)
+            {
+                inputRasterBands[i] = dataset->GetRasterBand(i+1);
+            }
             
-            float **inputData = NULL;
-            float *inDataColumn = NULL;
+            int stripRows = this->getStripRows(inputRasterBands[0], width, height, numInBands*sizeof(float));
+            std::vector<std::vector<float> > inputData(numInBands, std::vector<float>(((size_t)width)*stripRows));
             
-            GDALRasterBand **inputRasterBands = NULL;
+            double pxlTLX = gdalTranslation[0];
+            double pxlTLY = gdalTranslation[3];
+            double pxlWidth = gdalTranslation[1];
+            double pxlHeight = gdalTranslation[5];
+            if(pxlHeight < 0)
+            {
+                pxlHeight *= (-1);
+            }
             
+            std::vector<RSGISCalcImageValue*> threadCalcs = this->createThreadCalcs();
             try
             {
-                dataset->GetGeoTransform(gdalTranslation);
-                numInBands = dataset->GetRasterCount();
-                width = dataset->GetRasterXSize();
-                height = dataset->GetRasterYSize();
-                
-                // Get Image Input Bands
-                inputRasterBands = new GDALRasterBand*[numInBands];
-                for(int i = 0; i < numInBands; i++)
-				{
-					inputRasterBands[i] = dataset->GetRasterBand(i+1);
-                }
-                
-                // Allocate memory
-                inputData = new float*[numInBands];
-                for(int i = 0; i < numInBands; i++)
-                {
-                    inputData[i] = (float *) CPLMalloc(sizeof(float)*width);
-                }
-                inDataColumn = new float[numInBands];
-                
-                OGREnvelope extent;
-                double pxlTLX = 0;
-                double pxlTLY = 0;
-                double pxlWidth = 0;
-                double pxlHeight = 0;
-                
-                pxlTLX = gdalTranslation[0];
-                pxlTLY = gdalTranslation[3];
-                pxlWidth = gdalTranslation[1];
-                pxlHeight = gdalTranslation[5];
-                
-                if(pxlHeight < 0)
-                {
-                    pxlHeight *= (-1);
-                }
-                
+                rsgis::RSGISThreadPool threadPool(threadCalcs.size());
                 rsgis_tqdm pbar;
-                // Loop images to process data
-                for(int i = 0; i < height; i++)
+                for(int row = 0; row < height; row += stripRows)
                 {
-                    pbar.progress(i, height);
-                    
+                    pbar.progress(row, height);
+                    int nRows = std::min(stripRows, height - row);
                     for(int n = 0; n < numInBands; n++)
                     {
-                        inputRasterBands[n]->RasterIO(GF_Read, 0, i, width, 1, inputData[n], width, 1, GDT_Float32, 0, 0);
-                    }
-                    
-                    for(int j = 0; j < width; j++)
-                    {
-                        for(int n = 0; n < numInBands; n++)
+                        if(inputRasterBands[n]->RasterIO(GF_Read, 0, row, width, nRows, inputData[n].data(), width, nRows, GDT_Float32, 0, 0) != CE_None)
                         {
-                            inDataColumn[n] = inputData[n][j];
+                            throw RSGISImageBandException("Could not read the image band.");
                         }
-                        
-                        extent.MinX = pxlTLX;
-                        extent.MaxX = (pxlTLX+pxlWidth);
-                        extent.MinY = pxlTLY;
-                        extent.MaxY = (pxlTLY-pxlHeight);
-                        this->calc->calcImageValue(inDataColumn, numInBands, extent);
-                        
-                        for(int n = 0; n < numInBands; n++)
-                        {
-                            inputData[n][j] = inDataColumn[n];
-                        }
-                        
-                        pxlTLX += pxlWidth;
-                    }
-                    
-                    for(int n = 0; n < numInBands; n++)
-                    {
-                        inputRasterBands[n]->RasterIO(GF_Write, 0, i, width, 1, inputData[n], width, 1, GDT_Float32, 0, 0);
                     }
                     
-                    pxlTLY -= pxlHeight;
-                    pxlTLX = gdalTranslation[0];
-                }
-                pbar.finish();
-            }
-            catch(RSGISImageCalcException& e)
-            {
-                if(gdalTranslation != NULL)
-                {
-                    delete[] gdalTranslation;
-                }
-                
-                if(inputData != NULL)
-                {
-                    for(int i = 0; i < numInBands; i++)
+                    threadPool.parallelFor(0, nRows, [&](unsigned int t, size_t mStart, size_t mEnd)
                     {
-                        if(inputData[i] != NULL)
+                        std::vector<float> inDataColumn(numInBands);
+                        OGREnvelope extent;
+                        for(size_t m = mStart; m < mEnd; ++m)
                         {
-                            delete[] inputData[i];
+                            double rowTLY = pxlTLY - ((row + m) * pxlHeight);
+                            for(int j = 0; j < width; j++)
+                            {
+                                size_t pxl = (m*width)+j;
+                                for(int n = 0; n < numInBands; n++)
+                                {
+                                    inDataColumn[n] = inputData[n][pxl];
+                                }
+                                
+                                double colTLX = pxlTLX + (j * pxlWidth);
+                                extent.MinX = colTLX;
+                                extent.MaxX = (colTLX+pxlWidth);
+                                extent.MinY = rowTLY;
+                                extent.MaxY = (rowTLY-pxlHeight);
+                                threadCalcs[t]->calcImageValue(inDataColumn.data(), numInBands, extent);
+                                
+                                for(int n = 0; n < numInBands; n++)
+                                {
+                                    inputData[n][pxl] = inDataColumn[n];
+                                }
+                            }
                         }
-                    }
-                    delete[] inputData;
-                }		
-                if(inDataColumn != NULL)
-                {
-                    delete[] inDataColumn;
-                }
-                if(inputRasterBands != NULL)
-                {
-                    delete[] inputRasterBands;
-                }
-                throw e;
-            }
-            catch(RSGISImageBandException& e)
-            {
-                if(gdalTranslation != NULL)
-                {
-                    delete[] gdalTranslation;
-                }			
-                
-                if(inputData != NULL)
-                {
-                    for(int i = 0; i < numInBands; i++)
+                    });
+                    
+                    for(int n = 0; n < numInBands; n++)
                     {
-                        if(inputData[i] != NULL)
+                        if(inputRasterBands[n]->RasterIO(GF_Write, 0, row, width, nRows, inputData[n].data(), width, nRows, GDT_Float32, 0, 0) != CE_None)
                         {
-                            delete[] inputData[i];
+                            throw RSGISImageBandException("Could not write the image band.");
                         }
                     }
-                    delete[] inputData;
-                }		
-                if(inDataColumn != NULL)
-                {
-                    delete[] inDataColumn;
                 }
-                if(inputRasterBands != NULL)
-                {
-                    delete[] inputRasterBands;
-                }
-                throw e;
-            }
-            
-            if(gdalTranslation != NULL)
-            {
-                delete[] gdalTranslation;
-            }
-            
-            if(inputData != NULL)
-            {
-                for(int i = 0; i < numInBands; i++)
-                {
-                    if(inputData[i] != NULL)
-                    {
-                        delete[] inputData[i];
-                    }
-                }
-                delete[] inputData;
-            }		
-            if(inDataColumn != NULL)
-            {
-                delete[] inDataColumn;
+                pbar.finish();
             }
-            if(inputRasterBands != NULL)
+            catch(...)
             {
-                delete[] inputRasterBands;
+                this->deleteThreadCalcs(threadCalcs);
+                throw;
             }
+            this->deleteThreadCalcs(threadCalcs);
         }
         
         void RSGISCalcEditImage::calcImageUseOut(GDALDataset *dataset)
         {
-            RSGISImageUtils imgUtils;
+            if(dataset == NULL)
+            {
+                throw RSGISImageBandException("Dataset is not valid.");
+            }
             
-            int height = 0;
-            int width = 0;
-            int numBands = 0;
-            int xBlockSize = 0;
-            int yBlockSize = 0;
+            int width = dataset->GetRasterXSize();
+            int height = dataset->GetRasterYSize();
+            int numBands = dataset->GetRasterCount();
+            // The calculation writes a value for each band of the image.
+            int numOutVals = std::max(numBands, this->calc->getNumOutBands());
             
-            float **inputData = NULL;
-            double **outputData = NULL;
-            float *inDataColumn = NULL;
-            double *outDataColumn = NULL;
+            //Get Image Bands
+            std::vector<GDALRasterBand*> rasterBands(numBands);
+            for(int i = 0; i < numBands; i++)
+            {
+                rasterBands[i] = dataset->GetRasterBand(i+1);
+            }
             
-            GDALRasterBand **rasterBands = NULL;
+            int stripRows = this->getStripRows(rasterBands[0], width, height, numBands*(sizeof(float)+sizeof(double)));
+            size_t numStripPxls = ((size_t)width)*stripRows;
+            std::vector<std::vector<float> > inputData(numBands, std::vector<float>(numStripPxls));
+            std::vector<std::vector<double> > outputData(numOutVals, std::vector<double>(numStripPxls));
             
+            std::vector<RSGISCalcImageValue*> threadCalcs = this->createThreadCalcs();
             try
             {
-                width = dataset->GetRasterXSize();
-                height = dataset->GetRasterYSize();
-                numBands = dataset->GetRasterCount();
-                                
-                //Get Image Bands
-                rasterBands = new GDALRasterBand*[numBands];
-                for(int i = 0; i < numBands; i++)
-                {
-                    rasterBands[i] = dataset->GetRasterBand(i+1);
-                }
-
-                rasterBands[0]->GetBlockSize (&xBlockSize, &yBlockSize);
-                                
-                // Allocate memory
-                inputData = new float*[numBands];
-                for(int i = 0; i < numBands; i++)
-                {
-                    inputData[i] = (float *) CPLMalloc(sizeof(float)*(width*yBlockSize));
-                }
-                inDataColumn = new float[numBands];
-                
-                outputData = new double*[numBands];
-                for(int i = 0; i < numBands; i++)
-                {
-                    outputData[i] = (double *) CPLMalloc(sizeof(double)*(width*yBlockSize));
-                }
-                outDataColumn = new double[numBands];
-                
-                int nYBlocks = floor(((double)height) / ((double)yBlockSize));
-                int remainRows = height - (nYBlocks * yBlockSize);
-                int rowOffset = 0;
-                
+                rsgis::RSGISThreadPool threadPool(threadCalcs.size());
                 rsgis_tqdm pbar;
-                // Loop images to process data
-                for(int i = 0; i < nYBlocks; i++)
+                for(int row = 0; row < height; row += stripRows)
                 {
+                    pbar.progress(row, height);
+                    int nRows = std::min(stripRows, height - row);
                     for(int n = 0; n < numBands; n++)
                     {
-                        rowOffset = (yBlockSize * i);
-                        rasterBands[n]->RasterIO(GF_Read, 0, rowOffset, width, yBlockSize, inputData[n], width, yBlockSize, GDT_Float32, 0, 0);
-                    }
-                    
-                    for(int m = 0; m < yBlockSize; ++m)
-                    {
-                        pbar.progress((i*yBlockSize)+m, height);
-                        
-                        for(int j = 0; j < width; j++)
+                        if(rasterBands[n]->RasterIO(GF_Read, 0, row, width, nRows, inputData[n].data(), width, nRows, GDT_Float32, 0, 0) != CE_None)
                         {
-                            for(int n = 0; n < numBands; n++)
-                            {
-                                inDataColumn[n] = inputData[n][(m*width)+j];
-                            }
-                            
-                            this->calc->calcImageValue(inDataColumn, numBands, outDataColumn);
-                            
-                            for(int n = 0; n < numBands; n++)
-                            {
-                                outputData[n][(m*width)+j] = outDataColumn[n];
-                            }
-                            
+                            throw RSGISImageBandException("Could not read the image band.");
                         }
                     }
                     
-                    for(int n = 0; n < numBands; n++)
+                    threadPool.parallelFor(0, nRows, [&](unsigned int t, size_t mStart, size_t mEnd)
                     {
-                        rowOffset = yBlockSize * i;
-                        rasterBands[n]->RasterIO(GF_Write, 0, rowOffset, width, yBlockSize, outputData[n], width, yBlockSize, GDT_Float32, 0, 0);
-                    }
-                }
-                
-                if(remainRows > 0)
-                {
-                    for(int n = 0; n < numBands; n++)
-                    {
-                        rowOffset = (yBlockSize * nYBlocks);
-                        rasterBands[n]->RasterIO(GF_Read, 0, rowOffset, width, remainRows, inputData[n], width, remainRows, GDT_Float32, 0, 0);
-                    }
-                    
-                    for(int m = 0; m < remainRows; ++m)
-                    {
-                        pbar.progress((nYBlocks*yBlockSize)+m, height);
+                        // The rows are contiguous within the strip so try the block API first.
+                        size_t pxlOff = mStart*width;
+                        std::vector<const float*> inBlock(numBands);
+                        std::vector<double*> outBlock(numOutVals);
+                        for(int n = 0; n < numBands; n++)
+                        {
+                            inBlock[n] = inputData[n].data() + pxlOff;
+                        }
+                        for(int n = 0; n < numOutVals; n++)
+                        {
+                            outBlock[n] = outputData[n].data() + pxlOff;
+                        }
+                        if(threadCalcs[t]->calcImageBlock(inBlock.data(), numBands, (mEnd-mStart)*width, outBlock.data()))
+                        {
+                            return;
+                        }
                         
-                        for(int j = 0; j < width; j++)
+                        std::vector<float> inDataColumn(numBands);
+                        std::vector<double> outDataColumn(numOutVals);
+                        for(size_t pxl = pxlOff; pxl < (mEnd*width); ++pxl)
                         {
                             for(int n = 0; n < numBands; n++)
                             {
-                                inDataColumn[n] = inputData[n][(m*width)+j];
+                                inDataColumn[n] = inputData[n][pxl];
                             }
                             
-                            this->calc->calcImageValue(inDataColumn, numBands, outDataColumn);
+                            threadCalcs[t]->calcImageValue(inDataColumn.data(), numBands, outDataColumn.data());
                             
-                            for(int n = 0; n < numBands; n++)
+                            for(int n = 0; n < numOutVals; n++)
                             {
-                                outputData[n][(m*width)+j] = outDataColumn[n];
+                                outputData[n][pxl] = outDataColumn[n];
                             }
-                            
                         }
-                    }
+                    });
                     
                     for(int n = 0; n < numBands; n++)
                     {
-                        rowOffset = (yBlockSize * nYBlocks);
-                        rasterBands[n]->RasterIO(GF_Write, 0, rowOffset, width, remainRows, outputData[n], width, remainRows, GDT_Float32, 0, 0);
-                    }
-                }
-                pbar.finish();
-            }
-            catch(RSGISImageCalcException& e)
-            {                
-                if(inputData != NULL)
-                {
-                    for(int i = 0; i < numBands; i++)
-                    {
-                        if(inputData[i] != NULL)
-                        {
-                            delete[] inputData[i];
-                        }
-                    }
-                    delete[] inputData;
-                }
-                
-                if(outputData != NULL)
-                {
-                    for(int i = 0; i < numBands; i++)
-                    {
-                        if(outputData[i] != NULL)
-                        {
-                            delete[] outputData[i];
-                        }
-                    }
-                    delete[] outputData;
-                }
-                
-                if(inDataColumn != NULL)
-                {
-                    delete[] inDataColumn;
-                }
-                
-                if(outDataColumn != NULL)
-                {
-                    delete[] outDataColumn;
-                }
-                
-                if(rasterBands != NULL)
-                {
-                    delete[] rasterBands;
-                }
-                throw e;
-            }
-            catch(RSGISImageBandException& e)
-            {
-                if(inputData != NULL)
-                {
-                    for(int i = 0; i < numBands; i++)
-                    {
-                        if(inputData[i] != NULL)
+                        if(rasterBands[n]->RasterIO(GF_Write, 0, row, width, nRows, outputData[n].data(), width, nRows, GDT_Float64, 0, 0) != CE_None)
                         {
-                            delete[] inputData[i];
+                            throw RSGISImageBandException("Could not write the image band.");
                         }
                     }
-                    delete[] inputData;
                 }
-                
-                if(outputData != NULL)
-                {
-                    for(int i = 0; i < numBands; i++)
-                    {
-                        if(outputData[i] != NULL)
-                        {
-                            delete[] outputData[i];
-                        }
-                    }
-                    delete[] outputData;
-                }
-                
-                if(inDataColumn != NULL)
-                {
-                    delete[] inDataColumn;
-                }
-                
-                if(outDataColumn != NULL)
-                {
-                    delete[] outDataColumn;
-                }
-                
-                if(rasterBands != NULL)
-                {
-                    delete[] rasterBands;
-                }
-                
-                throw e;
-            }
-            
-            if(inputData != NULL)
-            {
-                for(int i = 0; i < numBands; i++)
-                {
-                    if(inputData[i] != NULL)
-                    {
-                        CPLFree(inputData[i]);
-                    }
-                }
-                delete[] inputData;
-            }
-            
-            if(outputData != NULL)
-            {
-                for(int i = 0; i < numBands; i++)
-                {
-                    if(outputData[i] != NULL)
-                    {
-                        CPLFree(outputData[i]);
-                    }
-                }
-                delete[] outputData;
-            }
-            
-            if(inDataColumn != NULL)
-            {
-                delete[] inDataColumn;
-            }
-            
-            if(outDataColumn != NULL)
-            {
-                delete[] outDataColumn;
+                pbar.finish();
             }
-            
-            if(rasterBands != NULL)
+            catch(...)
             {
-                delete[] rasterBands;
+                this->deleteThreadCalcs(threadCalcs);
+                throw;
             }
+            this->deleteThreadCalcs(threadCalcs);
         }
         
         void RSGISCalcEditImage::calcImageWindowData(GDALDataset *dataset, int windowSize, float fillval)
@@ -466,838 +234,221 @@ namespace rsgis
             {
                 throw RSGISImageBandException("Dataset is not valid.");
             }
+            if(windowSize % 2 == 0)
+            {
+                throw RSGISImageCalcException("Window size needs to be an odd number (min = 3).");
+            }
+            else if(windowSize < 3)
+            {
+                throw RSGISImageCalcException("Window size needs to be 3 or greater and an odd number.");
+            }
             
-            RSGISImageUtils imgUtils;
-            int height = 0;
-            int width = 0;
-            int numBands = 0;
-            int xBlockSize = 0;
-            int yBlockSize = 0;
-            size_t numPxlsInBlock = 0;
+            int windowMid = windowSize / 2;
+            int numBands = dataset->GetRasterCount();
+            int width = dataset->GetRasterXSize();
+            int height = dataset->GetRasterYSize();
+            // The calculation writes a value for each band of the image.
+            int numOutVals = std::max(numBands, this->calc->getNumOutBands());
             
-            float **inputDataUpper = NULL;
-            float **inputDataMain = NULL;
-            float **inputDataLower = NULL;
-            double **outputData = NULL;
-            float ***inDataBlock = NULL;
-            double *outDataColumn = NULL;
+            //Get Image Bands
+            std::vector<GDALRasterBand*> rasterBands(numBands);
+            for(int i = 0; i < numBands; i++)
+            {
+                rasterBands[i] = dataset->GetRasterBand(i+1);
+            }
             
-            GDALRasterBand **rasterBands = NULL;
+            // Each strip is held with windowMid rows (and columns) either side, where
+            // the rows above are the values from before the previous strip was written.
+            size_t padWidth = width + (2 * windowMid);
+            size_t haloRows = 2 * windowMid;
+            int stripRows = this->getStripRows(rasterBands[0], padWidth, height, numBands*(sizeof(float)+sizeof(double)));
+            size_t padRows = stripRows + haloRows;
+            std::vector<std::vector<float> > inputData(numBands, std::vector<float>(padWidth*padRows, fillval));
+            std::vector<std::vector<double> > outputData(numOutVals, std::vector<double>(((size_t)width)*stripRows));
             
+            std::vector<RSGISCalcImageValue*> threadCalcs = this->createThreadCalcs();
             try
             {
-                if(windowSize % 2 == 0)
-                {
-                    throw RSGISImageCalcException("Window size needs to be an odd number (min = 3).");
-                }
-                else if(windowSize < 3)
-                {
-                    throw RSGISImageCalcException("Window size needs to be 3 or greater and an odd number.");
-                }
-                int windowMid = floor(((float)windowSize)/2.0); // Starting at 0!! NOT 1 otherwise would be ceil.
-                
-                numBands = dataset->GetRasterCount();
-                width = dataset->GetRasterXSize();
-                height = dataset->GetRasterYSize();
-                
-                //Get Image Output Bands
-                rasterBands = new GDALRasterBand*[numBands];
-                for(int i = 0; i < numBands; i++)
-                {
-                    rasterBands[i] = dataset->GetRasterBand(i+1);
-                }
-                
-                rasterBands[0]->GetBlockSize (&xBlockSize, &yBlockSize);
-                
-                int numOfLines = yBlockSize;
-                if(yBlockSize < windowSize)
-                {
-                    numOfLines = ceil(((float)windowSize)/((float)yBlockSize))*yBlockSize;
-                }
-                
-                // Allocate memory
-                numPxlsInBlock = width*numOfLines;
-                inputDataUpper = new float*[numBands];
-                for(int i = 0; i < numBands; i++)
-                {
-                    inputDataUpper[i] = (float *) CPLMalloc(sizeof(float)*numPxlsInBlock);
-                    for(int k = 0; k < numPxlsInBlock; k++)
-                    {
-                        inputDataUpper[i][k] = 0;
-                    }
-                }
-                
-                inputDataMain = new float*[numBands];
-                for(int i = 0; i < numBands; i++)
-                {
-                    inputDataMain[i] = (float *) CPLMalloc(sizeof(float)*numPxlsInBlock);
-                    for(int k = 0; k < numPxlsInBlock; k++)
-                    {
-                        inputDataMain[i][k] = 0;
-                    }
-                }
-                
-                inputDataLower = new float*[numBands];
-                for(int i = 0; i < numBands; i++)
-                {
-                    inputDataLower[i] = (float *) CPLMalloc(sizeof(float)*numPxlsInBlock);
-                    for(int k = 0; k < numPxlsInBlock; k++)
-                    {
-                        inputDataLower[i][k] = 0;
-                    }
-                }
-                
-                inDataBlock = new float**[numBands];
-                for(int i = 0; i < numBands; i++)
-                {
-                    inDataBlock[i] = new float*[windowSize];
-                    for(int j = 0; j < windowSize; j++)
-                    {
-                        inDataBlock[i][j] = new float[windowSize];
-                    }
-                }
-                
-                outputData = new double*[numBands];
-                for(int i = 0; i < numBands; i++)
-                {
-                    outputData[i] = (double *) CPLMalloc(sizeof(double)*numPxlsInBlock);
-                }
-                outDataColumn = new double[numBands];
-                
-                
-                int nYBlocks = floor(((double)height) / ((double)numOfLines));
-                int remainRows = height - (nYBlocks * numOfLines);
-                int rowOffset = 0;
-                unsigned int line = 0;
-                long cLinePxl = 0;
-                long cPxl = 0;
-                long dLinePxls = 0;
-                int dWinX = 0;
-                int dWinY = 0;
-                
+                rsgis::RSGISThreadPool threadPool(threadCalcs.size());
                 rsgis_tqdm pbar;
-                
-                if(nYBlocks > 0)
+                int prevRows = 0;
+                for(int row = 0; row < height; row += stripRows)
                 {
-                    for(int i = 0; i < nYBlocks; i++)
+                    pbar.progress(row, height);
+                    int nRows = std::min(stripRows, height - row);
+                    
+                    size_t firstReadRow = windowMid;
+                    if(row > 0)
                     {
-                        if(i == 0)
-                        {
-                            // Set Upper Block with Zeros.
-                            for(int n = 0; n < numBands; n++)
-                            {
-                                for(int k = 0; k < numPxlsInBlock; k++)
-                                {
-                                    inputDataUpper[n][k] = fillval;
-                                }
-                            }
-                            
-                            // Read Main Block
-                            for(int n = 0; n < numBands; n++)
-                            {
-                                rowOffset = (numOfLines * i);
-                                rasterBands[n]->RasterIO(GF_Read, 0, rowOffset, width, numOfLines, inputDataMain[n], width, numOfLines, GDT_Float32, 0, 0);
-                            }
-                            // Read Lower Block
-                            for(int n = 0; n < numBands; n++)
-                            {
-                                if(nYBlocks == 1)
-                                {
-                                    if(remainRows > 0)
-                                    {
-                                        rowOffset = (numOfLines * (i+1));
-                                        rasterBands[n]->RasterIO(GF_Read, 0, rowOffset, width, remainRows, inputDataLower[n], width, remainRows, GDT_Float32, 0, 0);
-                                        for(int k = (remainRows*width); k < numPxlsInBlock; k++)
-                                        {
-                                            inputDataLower[n][k] = 0;
-                                        }
-                                    }
-                                    else
-                                    {
-                                        for(int k = 0; k < numPxlsInBlock; k++)
-                                        {
-                                            inputDataLower[n][k] = 0;
-                                        }
-                                    }
-                                }
-                                else
-                                {
-                                    rowOffset = (numOfLines * (i+1));
-                                    rasterBands[n]->RasterIO(GF_Read, 0, rowOffset, width, numOfLines, inputDataLower[n], width, numOfLines, GDT_Float32, 0, 0);
-                                }
-                            }
-                            
-                        }
-                        else if(i == (nYBlocks-1))
-                        {
-                            // Shift Lower Block to Main Block
-                            for(int n = 0; n < numBands; n++)
-                            {
-                                for(int k = 0; k < numPxlsInBlock; k++)
-                                {
-                                    inputDataUpper[n][k] = inputDataMain[n][k];
-                                }
-                            }
-                            
-                            // Shift Lower Block to Main Block
-                            for(int n = 0; n < numBands; n++)
-                            {
-                                for(int k = 0; k < numPxlsInBlock; k++)
-                                {
-                                    inputDataMain[n][k] = inputDataLower[n][k];
-                                }
-                            }
-                            
-                            // Set Lower Block with Zeros.
-                            for(int n = 0; n < numBands; n++)
-                            {
-                                if(remainRows > 0)
-                                {
-                                    rowOffset = (numOfLines * (i+1));
-                                    rasterBands[n]->RasterIO(GF_Read, 0, rowOffset, width, remainRows, inputDataLower[n], width, remainRows, GDT_Float32, 0, 0);
-                                    for(int k = (remainRows*width); k < numPxlsInBlock; k++)
-                                    {
-                                        inputDataLower[n][k] = fillval;
-                                    }
-                                }
-                                else
-                                {
-                                    for(int k = 0; k < numPxlsInBlock; k++)
-                                    {
-                                        inputDataLower[n][k] = fillval;
-                                    }
-                                }
-                            }
-                        }
-                        else
-                        {
-                            // Shift Lower Block to Main Block
-                            for(int n = 0; n < numBands; n++)
-                            {
-                                for(int k = 0; k < numPxlsInBlock; k++)
-                                {
-                                    inputDataUpper[n][k] = inputDataMain[n][k];
-                                }
-                            }
-                            
-                            // Shift Lower Block to Main Block
-                            for(int n = 0; n < numBands; n++)
-                            {
-                                for(int k = 0; k < numPxlsInBlock; k++)
-                                {
-                                    inputDataMain[n][k] = inputDataLower[n][k];
-                                }
-                            }
-                            
-                            // Read Lower Block
-                            for(int n = 0; n < numBands; n++)
-                            {
-                                rowOffset = (numOfLines * (i+1));
-                                rasterBands[n]->RasterIO(GF_Read, 0, rowOffset, width, numOfLines, inputDataLower[n], width, numOfLines, GDT_Float32, 0, 0);
-                            }
-                        }
-                        
-                        for(int m = 0; m < numOfLines; ++m)
-                        {
-                            pbar.progress((i*yBlockSize)+m, height);
-                            line = (i*numOfLines)+m;
-                            
-                            cLinePxl = m*width;
-                            
-                            for(int j = 0; j < width; j++)
-                            {
-                                cPxl = cLinePxl+j;
-                                if(m < windowMid)
-                                {
-                                    for(int y = 0; y < windowSize; y++)
-                                    {
-                                        dWinY = y-windowMid;
-                                        dLinePxls = dWinY * width;
-                                        
-                                        if((cPxl + dLinePxls) < 0)
-                                        {
-                                            for(int x = 0; x < windowSize; x++)
-                                            {
-                                                dWinX = x-windowMid;
-                                                
-                                                if((j+dWinX) < 0)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else if((j+dWinX) >= width)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = inputDataUpper[n][(numPxlsInBlock+(cPxl+dLinePxls))+dWinX];
-                                                    }
-                                                }
-                                            }
-                                        }
-                                        else
-                                        {
-                                            for(int x = 0; x < windowSize; x++)
-                                            {
-                                                dWinX = x-windowMid;
-                                                
-                                                if((j+dWinX) < 0)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else if((j+dWinX) >= width)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = inputDataMain[n][(cPxl+dLinePxls)+dWinX];
-                                                    }
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                                else if(m > ((numOfLines-1)-windowMid))
-                                {
-                                    for(int y = 0; y < windowSize; y++)
-                                    {
-                                        dWinY = y-windowMid;
-                                        dLinePxls = dWinY * width;
-                                        
-                                        if((cPxl + dLinePxls) >= numPxlsInBlock)
-                                        {
-                                            for(int x = 0; x < windowSize; x++)
-                                            {
-                                                dWinX = x-windowMid;
-                                                
-                                                if((j+dWinX) < 0)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else if((j+dWinX) >= width)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = inputDataLower[n][((cPxl+dLinePxls)-numPxlsInBlock)+dWinX];
-                                                    }
-                                                }
-                                            }
-                                        }
-                                        else
-                                        {
-                                            for(int x = 0; x < windowSize; x++)
-                                            {
-                                                dWinX = x-windowMid;
-                                                
-                                                if((j+dWinX) < 0)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else if((j+dWinX) >= width)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = inputDataMain[n][(cPxl+dLinePxls)+dWinX];
-                                                    }
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                                else
-                                {
-                                    for(int y = 0; y < windowSize; y++)
-                                    {
-                                        dWinY = y-windowMid;
-                                        dLinePxls = dWinY * width;
-                                        
-                                        for(int x = 0; x < windowSize; x++)
-                                        {
-                                            dWinX = x-windowMid;
-                                            
-                                            if((j+dWinX) < 0)
-                                            {
-                                                for(int n = 0; n < numBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = fillval;
-                                                }
-                                            }
-                                            else if((j+dWinX) >= width)
-                                            {
-                                                for(int n = 0; n < numBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = fillval;
-                                                }
-                                            }
-                                            else
-                                            {
-                                                for(int n = 0; n < numBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = inputDataMain[n][(cPxl+dLinePxls)+dWinX];
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                                
-                                this->calc->calcImageValue(inDataBlock, numBands, windowSize, outDataColumn);
-                                
-                                for(int n = 0; n < numBands; n++)
-                                {
-                                    outputData[n][cPxl] = outDataColumn[n];
-                                }
-                            }
-                            
-                        }
-                        
+                        // Move the last rows of the previous strip (which have not been edited) to the top.
                         for(int n = 0; n < numBands; n++)
                         {
-                            rasterBands[n]->RasterIO(GF_Write, 0, (numOfLines * i), width, numOfLines, outputData[n], width, numOfLines, GDT_Float64, 0, 0);
+                            float *bandData = inputData[n].data();
+                            std::copy(bandData + (prevRows*padWidth), bandData + ((prevRows+haloRows)*padWidth), bandData);
                         }
+                        firstReadRow = haloRows;
                     }
-                    
-                    if(remainRows > 0)
+                    size_t lastPadRow = nRows + haloRows;
+                    int imgReadRow = (row - windowMid) + firstReadRow;
+                    int numReadRows = std::max(std::min<int>(height - imgReadRow, lastPadRow - firstReadRow), 0);
+                    for(int n = 0; n < numBands; n++)
                     {
-                        // Shift Lower Block to Main Block
-                        for(int n = 0; n < numBands; n++)
+                        float *bandData = inputData[n].data();
+                        if(numReadRows > 0)
                         {
-                            for(int k = 0; k < numPxlsInBlock; k++)
+                            if(rasterBands[n]->RasterIO(GF_Read, 0, imgReadRow, width, numReadRows, bandData + ((firstReadRow*padWidth)+windowMid), width, numReadRows, GDT_Float32, 0, padWidth*sizeof(float)) != CE_None)
                             {
-                                inputDataUpper[n][k] = inputDataMain[n][k];
+                                throw RSGISImageBandException("Could not read the image band.");
                             }
                         }
-                        
-                        // Shift Lower Block to Main Block
-                        for(int n = 0; n < numBands; n++)
-                        {
-                            for(int k = 0; k < numPxlsInBlock; k++)
-                            {
-                                inputDataMain[n][k] = inputDataLower[n][k];
-                            }
-                        }
-                        
-                        // Read Lower Block
-                        for(int n = 0; n < numBands; n++)
-                        {
-                            for(int k = 0; k < numPxlsInBlock; k++)
-                            {
-                                inputDataLower[n][k] = fillval;
-                            }
-                        }
-                        
-                        for(int m = 0; m < remainRows; ++m)
+                        // The rows below the image.
+                        std::fill(bandData + ((firstReadRow+numReadRows)*padWidth), bandData + (lastPadRow*padWidth), fillval);
+                    }
+                    
+                    threadPool.parallelFor(0, nRows, [&](unsigned int t, size_t mStart, size_t mEnd)
+                    {
+                        RSGISCalcImageValue *tCalc = threadCalcs[t];
+                        std::vector<const float*> winView(numBands);
+                        std::vector<const float*> winOutColumn(numBands);
+                        std::vector<const float*> winInColumn(numBands);
+                        std::vector<double> outDataColumn(numOutVals);
+                        std::vector<float> winVals;
+                        std::vector<float*> winRows;
+                        std::vector<float**> inDataBlock;
+                        bool useWinView = true;
+                        bool useWinViewSlide = true;
+                        for(size_t m = mStart; m < mEnd; ++m)
                         {
-                            line = (nYBlocks*numOfLines)+m;
-
-                            pbar.progress((nYBlocks*yBlockSize)+m, height);
-                            
-                            cLinePxl = m*width;
-                            
                             for(int j = 0; j < width; j++)
                             {
-                                cPxl = cLinePxl+j;
-                                if(m < windowMid)
+                                size_t winOff = (m * padWidth) + j;
+                                bool calcDone = false;
+                                if(useWinView)
                                 {
-                                    for(int y = 0; y < windowSize; y++)
+                                    if((j > 0) && useWinViewSlide)
                                     {
-                                        dWinY = y-windowMid;
-                                        dLinePxls = dWinY * width;
-                                        
-                                        if((cPxl + dLinePxls) < 0)
+                                        for(int n = 0; n < numBands; n++)
                                         {
-                                            for(int x = 0; x < windowSize; x++)
-                                            {
-                                                dWinX = x-windowMid;
-                                                
-                                                if((j+dWinX) < 0)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else if((j+dWinX) >= width)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = inputDataUpper[n][(numPxlsInBlock+(cPxl+dLinePxls))+dWinX];
-                                                    }
-                                                }
-                                            }
+                                            winOutColumn[n] = inputData[n].data() + (winOff - 1);
+                                            winInColumn[n] = inputData[n].data() + (winOff + (windowSize - 1));
                                         }
-                                        else
+                                        calcDone = tCalc->calcImageWindowViewSlide(winOutColumn.data(), winInColumn.data(), padWidth, numBands, windowSize, outDataColumn.data());
+                                        useWinViewSlide = calcDone;
+                                    }
+                                    if(!calcDone)
+                                    {
+                                        for(int n = 0; n < numBands; n++)
                                         {
-                                            for(int x = 0; x < windowSize; x++)
-                                            {
-                                                dWinX = x-windowMid;
-                                                
-                                                if((j+dWinX) < 0)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else if((j+dWinX) >= width)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = inputDataMain[n][(cPxl+dLinePxls)+dWinX];
-                                                    }
-                                                }
-                                            }
+                                            winView[n] = inputData[n].data() + winOff;
                                         }
+                                        calcDone = tCalc->calcImageWindowView(winView.data(), padWidth, numBands, windowSize, outDataColumn.data());
+                                        useWinView = calcDone;
                                     }
                                 }
-                                else if(m > ((numOfLines-1)-windowMid))
+                                
+                                if(!calcDone)
                                 {
-                                    for(int y = 0; y < windowSize; y++)
+                                    if(inDataBlock.empty())
                                     {
-                                        dWinY = y-windowMid;
-                                        dLinePxls = dWinY * width;
-                                        
-                                        if((cPxl + dLinePxls) >= numPxlsInBlock)
+                                        winVals.resize(((size_t)numBands)*windowSize*windowSize);
+                                        winRows.resize(((size_t)numBands)*windowSize);
+                                        inDataBlock.resize(numBands);
+                                        for(size_t r = 0; r < winRows.size(); ++r)
                                         {
-                                            for(int x = 0; x < windowSize; x++)
-                                            {
-                                                dWinX = x-windowMid;
-                                                
-                                                if((j+dWinX) < 0)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else if((j+dWinX) >= width)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = inputDataLower[n][((cPxl+dLinePxls)-numPxlsInBlock)+dWinX];
-                                                    }
-                                                }
-                                            }
+                                            winRows[r] = winVals.data() + (r*windowSize);
                                         }
-                                        else
+                                        for(int n = 0; n < numBands; n++)
                                         {
-                                            for(int x = 0; x < windowSize; x++)
-                                            {
-                                                dWinX = x-windowMid;
-                                                
-                                                if((j+dWinX) < 0)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else if((j+dWinX) >= width)
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = fillval;
-                                                    }
-                                                }
-                                                else
-                                                {
-                                                    for(int n = 0; n < numBands; n++)
-                                                    {
-                                                        inDataBlock[n][y][x] = inputDataMain[n][(cPxl+dLinePxls)+dWinX];
-                                                    }
-                                                }
-                                            }
+                                            inDataBlock[n] = winRows.data() + (n*windowSize);
                                         }
                                     }
-                                }
-                                else
-                                {
-                                    for(int y = 0; y < windowSize; y++)
+                                    for(int n = 0; n < numBands; n++)
                                     {
-                                        dWinY = y-windowMid;
-                                        dLinePxls = dWinY * width;
-                                        
-                                        for(int x = 0; x < windowSize; x++)
+                                        for(int y = 0; y < windowSize; y++)
                                         {
-                                            dWinX = x-windowMid;
-                                            
-                                            if((j+dWinX) < 0)
-                                            {
-                                                for(int n = 0; n < numBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = fillval;
-                                                }
-                                            }
-                                            else if((j+dWinX) >= width)
-                                            {
-                                                for(int n = 0; n < numBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = fillval;
-                                                }
-                                            }
-                                            else
-                                            {
-                                                for(int n = 0; n < numBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = inputDataMain[n][(cPxl+dLinePxls)+dWinX];
-                                                }
-                                            }
+                                            const float *winRow = inputData[n].data() + (winOff + (y * padWidth));
+                                            std::copy(winRow, winRow + windowSize, inDataBlock[n][y]);
                                         }
                                     }
+                                    tCalc->calcImageValue(inDataBlock.data(), numBands, windowSize, outDataColumn.data());
                                 }
                                 
-                                this->calc->calcImageValue(inDataBlock, numBands, windowSize, outDataColumn);
-                                
-                                for(int n = 0; n < numBands; n++)
+                                for(int n = 0; n < numOutVals; n++)
                                 {
-                                    outputData[n][cPxl] = outDataColumn[n];
+                                    outputData[n][(m*width)+j] = outDataColumn[n];
                                 }
                             }
                         }
-                        
-                        for(int n = 0; n < numBands; n++)
-                        {
-                            rasterBands[n]->RasterIO(GF_Write, 0, (nYBlocks*numOfLines), width, remainRows, outputData[n], width, remainRows, GDT_Float32, 0, 0);
-                        }
-                    }
+                    });
                     
-                }
-                pbar.finish();
-            }
-            catch(RSGISImageCalcException& e)
-            {
-                if(inputDataUpper != NULL)
-                {
-                    for(int i = 0; i < numBands; i++)
-                    {
-                        delete[] inputDataUpper[i];
-                    }
-                    delete[] inputDataUpper;
-                }
-                
-                if(inputDataMain != NULL)
-                {
-                    for(int i = 0; i < numBands; i++)
-                    {
-                        delete[] inputDataMain[i];
-                    }
-                    delete[] inputDataMain;
-                }
-                
-                if(inputDataLower != NULL)
-                {
-                    for(int i = 0; i < numBands; i++)
-                    {
-                        delete[] inputDataLower[i];
-                    }
-                    delete[] inputDataLower;
-                }
-                
-                if(inDataBlock != NULL)
-                {
-                    for(int i = 0; i < numBands; i++)
-                    {
-                        for(int j = 0; j < windowSize; j++)
-                        {
-                            delete[] inDataBlock[i][j];
-                        }
-                        delete[] inDataBlock[i];
-                    }
-                    delete[] inDataBlock;
-                }
-                
-                if(outputData != NULL)
-                {
-                    for(int i = 0; i < numBands; i++)
-                    {
-                        delete outputData[i];
-                    }
-                    delete outputData;
-                }
-                
-                if(outDataColumn != NULL)
-                {
-                    delete[] outDataColumn;
-                }
-                
-                throw e;
-            }
-            catch(RSGISImageBandException& e)
-            {                
-                if(inputDataUpper != NULL)
-                {
-                    for(int i = 0; i < numBands; i++)
-                    {
-                        delete[] inputDataUpper[i];
-                    }
-                    delete[] inputDataUpper;
-                }
-                
-                if(inputDataMain != NULL)
-                {
-                    for(int i = 0; i < numBands; i++)
-                    {
-                        delete[] inputDataMain[i];
-                    }
-                    delete[] inputDataMain;
-                }
-                
-                if(inputDataLower != NULL)
-                {
-                    for(int i = 0; i < numBands; i++)
-                    {
-                        delete[] inputDataLower[i];
-                    }
-                    delete[] inputDataLower;
-                }
-                
-                if(inDataBlock != NULL)
-                {
-                    for(int i = 0; i < numBands; i++)
+                    for(int n = 0; n < numBands; n++)
                     {
-                        for(int j = 0; j < windowSize; j++)
+                        if(rasterBands[n]->RasterIO(GF_Write, 0, row, width, nRows, outputData[n].data(), width, nRows, GDT_Float64, 0, 0) != CE_None)
                         {
-                            delete[] inDataBlock[i][j];
+                            throw RSGISImageBandException("Could not write the image band.");
                         }
-                        delete[] inDataBlock[i];
                     }
-                    delete[] inDataBlock;
+                    prevRows = nRows;
                 }
-                
-                if(outputData != NULL)
-                {
-                    for(int i = 0; i < numBands; i++)
-                    {
-                        delete outputData[i];
-                    }
-                    delete outputData;
-                }
-                
-                if(outDataColumn != NULL)
-                {
-                    delete[] outDataColumn;
-                }
-                
-                throw e;
-            }
-            
-            if(inputDataUpper != NULL)
-            {
-                for(int i = 0; i < numBands; i++)
-                {
-                    delete[] inputDataUpper[i];
-                }
-                delete[] inputDataUpper;
+                pbar.finish();
             }
-            
-            if(inputDataMain != NULL)
+            catch(...)
             {
-                for(int i = 0; i < numBands; i++)
-                {
-                    delete[] inputDataMain[i];
-                }
-                delete[] inputDataMain;
+                this->deleteThreadCalcs(threadCalcs);
+                throw;
             }
+            this->deleteThreadCalcs(threadCalcs);
+        }
+        
+        std::vector<RSGISCalcImageValue*> RSGISCalcEditImage::createThreadCalcs()
+        {
+            std::vector<RSGISCalcImageValue*> threadCalcs;
+            threadCalcs.push_back(this->calc);
             
-            if(inputDataLower != NULL)
+            unsigned int nThreads = this->numThreads;
+            if(nThreads == 0)
             {
-                for(int i = 0; i < numBands; i++)
-                {
-                    delete[] inputDataLower[i];
-                }
-                delete[] inputDataLower;
+                nThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
             }
             
-            if(inDataBlock != NULL)
+            for(unsigned int i = 1; i < nThreads; ++i)
             {
-                for(int i = 0; i < numBands; i++)
+                RSGISCalcImageValue *threadCalc = this->calc->clone();
+                if(threadCalc == NULL)
                 {
-                    for(int j = 0; j < windowSize; j++)
-                    {
-                        delete[] inDataBlock[i][j];
-                    }
-                    delete[] inDataBlock[i];
+                    // Not thread safe so use the serial code path.
+                    this->deleteThreadCalcs(threadCalcs);
+                    break;
                 }
-                delete[] inDataBlock;
+                threadCalcs.push_back(threadCalc);
             }
             
-            if(outputData != NULL)
+            return threadCalcs;
+        }
+        
+        void RSGISCalcEditImage::deleteThreadCalcs(std::vector<RSGISCalcImageValue*> &threadCalcs)
+        {
+            for(size_t i = 1; i < threadCalcs.size(); ++i)
             {
-                for(int i = 0; i < numBands; i++)
-                {
-                    delete outputData[i];
-                }
-                delete outputData;
+                delete threadCalcs.at(i);
             }
-            
-            if(outDataColumn != NULL)
+            if(!threadCalcs.empty())
             {
-                delete[] outDataColumn;
+                threadCalcs.resize(1);
             }
         }
         
+        int RSGISCalcEditImage::getStripRows(GDALRasterBand *band, int width, int height, size_t bytesPerPxl)
+        {
+            int xBlockSize = 0;
+            int yBlockSize = 0;
+            band->GetBlockSize(&xBlockSize, &yBlockSize);
+            return rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), width, height, bytesPerPxl, this->stripMemoryMB);
+        }
+        
         RSGISCalcEditImage::~RSGISCalcEditImage()
         {
             
         }
 	}
 }
-
-
@@ -25,10 +25,14 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <algorithm>
 
 #include "gdal_priv.h"
 
 #include "common/rsgis-tqdm.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISExecutionContext.h"
 
 #include "img/RSGISPixelInPoly.h"
 #include "img/RSGISImageCalcException.h"
@@ -52,16 +56,45 @@ namespace rsgis
 {
 	namespace img
 	{
+		/**
+		 * Applies a calculation to a dataset in place. The image is processed in strips
+		 * of whole rows (see setStripMemory) and the rows of each strip are split between
+		 * threads (see setNumThreads) if the RSGISCalcImageValue implements clone().
+		 */
 		class DllExport RSGISCalcEditImage
         {
         public:
             RSGISCalcEditImage(RSGISCalcImageValue *valueCalc);
+            /** The band values of each pixel are edited by calcImageValue(float *bandValues, int numBands, OGREnvelope extent). */
             void calcImage(GDALDataset *dataset);
+            /** The band values of each pixel are replaced by the output of calcImageBlock or calcImageValue(float *bandValues, int numBands, double *output). */
             void calcImageUseOut(GDALDataset *dataset);
+            /**
+             * The band values of each pixel are replaced by the output of the window
+             * calculation (calcImageWindowView / calcImageWindowViewSlide if implemented,
+             * otherwise calcImageValue(float ***dataBlock, ...)). The windows are always
+             * of the values before the edit, with the pixels outside the image being
+             * fillval, as the rows either side of each strip are kept in memory.
+             */
             void calcImageWindowData(GDALDataset *dataset, int windowSize, float fillval=0);
+            /**
+             * Set the number of threads used to process each strip of the image
+             * (default from rsgis::RSGISExecutionContextUtils::getDefaultContext();
+             * 0 uses all the hardware threads).
+             */
+            void setNumThreads(unsigned int numThreads){this->numThreads = numThreads;};
+            unsigned int getNumThreads(){return this->numThreads;};
+            /** Set the target memory (MB) of the buffers for each strip (see RSGISExecutionContextUtils::calcStripRows). */
+            void setStripMemory(unsigned int stripMemoryMB){this->stripMemoryMB = stripMemoryMB;};
+            unsigned int getStripMemory(){return this->stripMemoryMB;};
             ~RSGISCalcEditImage();
         private:
+            std::vector<RSGISCalcImageValue*> createThreadCalcs();
+            void deleteThreadCalcs(std::vector<RSGISCalcImageValue*> &threadCalcs);
+            int getStripRows(GDALRasterBand *band, int width, int height, size_t bytesPerPxl);
             RSGISCalcImageValue *calc;
+            unsigned int numThreads;
+            unsigned int stripMemoryMB;
         };
 	}
 }
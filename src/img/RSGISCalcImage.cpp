@@ -21,6 +21,7 @@
  */
 
 #include "RSGISCalcImage.h"
+#include "common/RSGISGDALInit.h"
 
 namespace rsgis{namespace img{
 	
@@ -30,12 +31,28 @@ namespace rsgis{namespace img{
 		this->numOutBands = valueCalc->getNumOutBands();
 		this->proj = proj;
 		this->useImageProj = useImageProj;
+        rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+        this->numThreads = context.numThreads;
+        this->numIOBuffers = context.numIOBuffers;
+        this->stripMemoryMB = context.stripMemoryMB;
+        this->checkpointSecs = context.checkpointSecs;
+        this->remoteMaxRequests = context.remoteMaxRequests;
+        this->previewFactor = context.previewFactor;
+        this->useTileProcessing = false;
+        this->tileXSize = 0;
+        this->tileYSize = 0;
 	}
     
     
     void RSGISCalcImage::calcImage(GDALDataset **datasets, int numDS, std::string outputImage, bool setOutNames, std::string *bandNames, std::string gdalFormat, GDALDataType gdalDataType)
     {
-        GDALAllRegister();
+        rsgis::RSGISProfileRun profileRun("calcImage");
+        if(this->useTileProcessing && (this->previewFactor <= 1))
+        {
+            this->calcImageTiles(datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, gdalDataType, 0);
+            return;
+        }
+        rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numDS];
@@ -52,10 +69,12 @@ namespace rsgis{namespace img{
 		
 		float **inputData = NULL;
 		double **outputData = NULL;
-		float *inDataColumn = NULL;
-		double *outDataColumn = NULL;
+		std::vector<RSGISCalcImageValue*> threadCalcs;
 		
 		GDALDataset *outputImageDS = NULL;
+        // COGs are written through a RSGISCOGWriter as the GDAL COG driver cannot create images.
+        RSGISCOGWriter *cogWriter = NULL;
+        bool cogOutput = RSGISCOGWriter::isCOGFormat(gdalFormat);
 		GDALRasterBand **inputRasterBands = NULL;
 		GDALRasterBand **outputRasterBands = NULL;
 		GDALDriver *gdalDriver = NULL;
@@ -64,6 +83,9 @@ namespace rsgis{namespace img{
 		{
 			// Find image overlap
 			imgUtils.getImageOverlap(datasets, numDS, dsOffsets, &width, &height, gdalTranslation, &xBlockSize, &yBlockSize);
+            int fullWidth = 0;
+            int fullHeight = 0;
+            bool preview = this->calcPreviewOverlap(&width, &height, gdalTranslation, &fullWidth, &fullHeight);
                         
 			// Count number of image bands
 			for(int i = 0; i < numDS; i++)
@@ -77,24 +99,69 @@ namespace rsgis{namespace img{
 			{
 				throw RSGISImageBandException("Requested GDAL driver does not exists..");
 			}
-            char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(gdalFormat);
-			std::cout << "New image width = " << width << " height = " << height << " bands = " << this->numOutBands << std::endl;
-			
-			outputImageDS = gdalDriver->Create(outputImage.c_str(), width, height, this->numOutBands, gdalDataType, papszOptions);
-			
-			if(outputImageDS == NULL)
-			{
-				throw RSGISImageBandException("Output image could not be created. Check filepath.");
-			}
-			outputImageDS->SetGeoTransform(gdalTranslation);
-			if(useImageProj)
-			{
-				outputImageDS->SetProjection(datasets[0]->GetProjectionRef());
-			}
-			else
-			{
-				outputImageDS->SetProjection(proj.c_str());
-			}
+            
+            // Resume the output image from the last checkpoint if it was created from the same inputs.
+            std::string checkpointFile = RSGISCalcImageCheckpoint::getCheckpointFile(outputImage);
+            RSGISCalcImageCheckpointInfo checkpoint;
+            checkpoint.inputs = gdalFormat;
+            for(int i = 0; i < numDS; i++)
+            {
+                checkpoint.inputs += std::string(";") + datasets[i]->GetDescription();
+            }
+            checkpoint.width = width;
+            checkpoint.height = height;
+            checkpoint.numBands = this->numOutBands;
+            checkpoint.completedRows = 0;
+            // A COG cannot be updated in place so cannot be resumed.
+            unsigned int checkpointSecs = cogOutput?0:this->checkpointSecs;
+            if(checkpointSecs > 0)
+            {
+                RSGISCalcImageCheckpointInfo prevCheckpoint;
+                if(RSGISCalcImageCheckpoint::readCheckpoint(checkpointFile, &prevCheckpoint) && (prevCheckpoint.inputs == checkpoint.inputs) && (prevCheckpoint.width == checkpoint.width) && (prevCheckpoint.height == checkpoint.height) && (prevCheckpoint.numBands == checkpoint.numBands))
+                {
+                    outputImageDS = (GDALDataset *) GDALOpen(outputImage.c_str(), GA_Update);
+                    if(outputImageDS != NULL)
+                    {
+                        checkpoint.completedRows = prevCheckpoint.completedRows;
+                        std::cout << "Resuming " << outputImage << " from row " << checkpoint.completedRows << " of " << height << std::endl;
+                    }
+                }
+            }
+            
+            if((outputImageDS == NULL) && cogOutput)
+            {
+                std::cout << "New image width = " << width << " height = " << height << " bands = " << this->numOutBands << std::endl;
+                try
+                {
+                    cogWriter = new RSGISCOGWriter(outputImage, width, height, this->numOutBands, gdalDataType, gdalTranslation, useImageProj?std::string(datasets[0]->GetProjectionRef()):proj, this->numThreads);
+                }
+                catch(rsgis::RSGISImageException &e)
+                {
+                    throw RSGISImageBandException(e.what());
+                }
+                outputImageDS = cogWriter->getDataset();
+            }
+            else if(outputImageDS == NULL)
+            {
+                char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(gdalFormat);
+                std::cout << "New image width = " << width << " height = " << height << " bands = " << this->numOutBands << std::endl;
+                
+                outputImageDS = gdalDriver->Create(outputImage.c_str(), width, height, this->numOutBands, gdalDataType, papszOptions);
+                
+                if(outputImageDS == NULL)
+                {
+                    throw RSGISImageBandException("Output image could not be created. Check filepath.");
+                }
+                outputImageDS->SetGeoTransform(gdalTranslation);
+                if(useImageProj)
+                {
+                    outputImageDS->SetProjection(datasets[0]->GetProjectionRef());
+                }
+                else
+                {
+                    outputImageDS->SetProjection(proj.c_str());
+                }
+            }
             
 			// Get Image Input Bands
 			bandOffsets = new int*[numInBands];
@@ -130,6 +197,7 @@ namespace rsgis{namespace img{
             {
                 yBlockSize = outYBlockSize;
             }
+            yBlockSize = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (numInBands*sizeof(float))+(this->numOutBands*sizeof(double)), this->stripMemoryMB);
             
 			// Allocate memory
 			inputData = new float*[numInBands];
@@ -137,93 +205,191 @@ namespace rsgis{namespace img{
 			{
 				inputData[i] = (float *) CPLMalloc(sizeof(float)*(width*yBlockSize));
 			}
-			inDataColumn = new float[numInBands];
             
 			outputData = new double*[this->numOutBands];
 			for(int i = 0; i < this->numOutBands; i++)
 			{
 				outputData[i] = (double *) CPLMalloc(sizeof(double)*(width*yBlockSize));
 			}
-			outDataColumn = new double[this->numOutBands];
-                      
-            int nYBlocks = floor(((double)height) / ((double)yBlockSize));
-            int remainRows = height - (nYBlocks * yBlockSize);
-            int rowOffset = 0;
             
-			rsgis_tqdm pbar;
-			// Loop images to process data
-			for(int i = 0; i < nYBlocks; i++)
-			{
-				for(int n = 0; n < numInBands; n++)
-				{
-                    rowOffset = bandOffsets[n][1] + (yBlockSize * i);
-					inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], rowOffset, width, yBlockSize, inputData[n], width, yBlockSize, GDT_Float32, 0, 0);
-				}
+            // One calc object and pixel buffer per thread; threadCalcs[0] is this->calc.
+            threadCalcs = this->createThreadCalcs();
+            unsigned int nThreads = threadCalcs.size();
+            std::vector<std::vector<float> > threadInDataColumn(nThreads, std::vector<float>(numInBands));
+            std::vector<std::vector<double> > threadOutDataColumn(nThreads, std::vector<double>(this->numOutBands));
+            rsgis::RSGISThreadPool threadPool(nThreads);
+            
+            std::vector<std::vector<const float*> > threadInBlock(nThreads, std::vector<const float*>(numInBands));
+            std::vector<std::vector<double*> > threadOutBlock(nThreads, std::vector<double*>(this->numOutBands));
+            
+            // Strip buffers for the I/O pipeline; buffer 0 is inputData and outputData.
+            // The buffers are not initialised when allocated so, where the workers are
+            // placed on NUMA nodes, the rows of each strip are first touched, so
+            // allocated, on the node of the worker which processes them.
+            rsgis::RSGISStripIOPipeline ioPipeline(this->numIOBuffers);
+            unsigned int nIOBufs = ioPipeline.getNumBuffers();
+            std::vector<std::unique_ptr<float[]> > extraInData((nIOBufs-1)*numInBands);
+            std::vector<std::unique_ptr<double[]> > extraOutData((nIOBufs-1)*this->numOutBands);
+            std::vector<std::vector<float*> > stripInData(nIOBufs, std::vector<float*>(numInBands));
+            std::vector<std::vector<double*> > stripOutData(nIOBufs, std::vector<double*>(this->numOutBands));
+            for(unsigned int b = 0; b < nIOBufs; ++b)
+            {
+                for(int n = 0; n < numInBands; n++)
+                {
+                    if(b == 0)
+                    {
+                        stripInData[b][n] = inputData[n];
+                    }
+                    else
+                    {
+                        extraInData[((b-1)*numInBands)+n].reset(new float[((size_t)width)*yBlockSize]);
+                        stripInData[b][n] = extraInData[((b-1)*numInBands)+n].get();
+                    }
+                    threadPool.firstTouch(stripInData[b][n], yBlockSize, sizeof(float)*width);
+                }
+                for(int n = 0; n < this->numOutBands; n++)
+                {
+                    if(b == 0)
+                    {
+                        stripOutData[b][n] = outputData[n];
+                    }
+                    else
+                    {
+                        extraOutData[((b-1)*this->numOutBands)+n].reset(new double[((size_t)width)*yBlockSize]);
+                        stripOutData[b][n] = extraOutData[((b-1)*this->numOutBands)+n].get();
+                    }
+                    threadPool.firstTouch(stripOutData[b][n], yBlockSize, sizeof(double)*width);
+                }
+            }
+            float **curInData = inputData;
+            double **curOutData = outputData;
+            
+            // Process the rows [mStart, mEnd) of the current strip.
+            auto processRows = [&](unsigned int t, size_t mStart, size_t mEnd)
+            {
+                // The rows are contiguous within the strip so try the block API first.
+                size_t pxlOff = mStart*width;
+                for(int n = 0; n < numInBands; n++)
+                {
+                    threadInBlock[t][n] = curInData[n] + pxlOff;
+                }
+                for(int n = 0; n < this->numOutBands; n++)
+                {
+                    threadOutBlock[t][n] = curOutData[n] + pxlOff;
+                }
+                if(threadCalcs[t]->calcImageBlock(threadInBlock[t].data(), numInBands, (mEnd-mStart)*width, threadOutBlock[t].data()))
+                {
+                    return;
+                }
                 
-                for(int m = 0; m < yBlockSize; ++m)
+                float *inDataColumn = threadInDataColumn[t].data();
+                double *outDataColumn = threadOutDataColumn[t].data();
+                for(size_t m = mStart; m < mEnd; ++m)
                 {
-                    pbar.progress((i*yBlockSize)+m, height);
-                                        
                     for(int j = 0; j < width; j++)
                     {
                         for(int n = 0; n < numInBands; n++)
                         {
-                            inDataColumn[n] = inputData[n][(m*width)+j];
+                            inDataColumn[n] = curInData[n][(m*width)+j];
                         }
                         
-                        this->calc->calcImageValue(inDataColumn, numInBands, outDataColumn);
+                        threadCalcs[t]->calcImageValue(inDataColumn, numInBands, outDataColumn);
                         
                         for(int n = 0; n < this->numOutBands; n++)
                         {
-                            outputData[n][(m*width)+j] = outDataColumn[n];
+                            curOutData[n][(m*width)+j] = outDataColumn[n];
                         }
-                        
                     }
                 }
-				
-				for(int n = 0; n < this->numOutBands; n++)
-				{
-                    rowOffset = yBlockSize * i;
-					outputRasterBands[n]->RasterIO(GF_Write, 0, rowOffset, width, yBlockSize, outputData[n], width, yBlockSize, GDT_Float64, 0, 0);
-				}
-			}
+            };
             
-            if(remainRows > 0)
+            size_t nStrips = (height + yBlockSize - 1) / yBlockSize;
+            // Strips before the checkpoint have been written so are skipped.
+            size_t startStrip = std::min<size_t>(checkpoint.completedRows / yBlockSize, nStrips);
+            auto lastCheckpoint = std::chrono::steady_clock::now();
+            auto stripRows = [&](size_t strip)
+            {
+                return std::min<int>(yBlockSize, height - (strip*yBlockSize));
+            };
+            
+            // Remote (e.g., /vsis3/) inputs are read with tile aligned concurrent requests.
+            RSGISRemoteReadPlanner remotePlanner(datasets, numDS, dsOffsets, width, height, yBlockSize, preview?0:this->remoteMaxRequests);
+            
+			rsgis_tqdm pbar;
+            auto readStrip = [&](size_t strip, unsigned int buf)
             {
+                int nRows = stripRows(strip);
+                rsgis::RSGISProfileTimer readTimer(rsgis::rsgis_profile_read, ((unsigned long long)numInBands)*width*nRows*sizeof(float));
+                if(remotePlanner.hasRemoteInputs())
+                {
+                    remotePlanner.readStrip(yBlockSize * strip, nRows, stripInData[buf].data());
+                    return;
+                }
                 for(int n = 0; n < numInBands; n++)
 				{
-                    rowOffset = bandOffsets[n][1] + (yBlockSize * nYBlocks);
-					inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], rowOffset, width, remainRows, inputData[n], width, remainRows, GDT_Float32, 0, 0);
+                    this->readRows(inputRasterBands[n], bandOffsets[n][0], bandOffsets[n][1], (yBlockSize * strip), nRows, width, fullWidth, fullHeight, stripInData[buf][n], GDT_Float32);
 				}
-                                
-                for(int m = 0; m < remainRows; ++m)
+            };
+            auto computeStrip = [&](size_t strip, unsigned int buf)
+            {
+                pbar.progress((strip*yBlockSize), height);
+                curInData = stripInData[buf].data();
+                curOutData = stripOutData[buf].data();
+                rsgis::RSGISProfileTimer calcTimer(rsgis::rsgis_profile_calc, 0, ((unsigned long long)width)*stripRows(strip));
+                threadPool.parallelFor(0, stripRows(strip), processRows);
+            };
+            auto writeStrip = [&](size_t strip, unsigned int buf)
+            {
+                int nRows = stripRows(strip);
+                rsgis::RSGISProfileTimer writeTimer(rsgis::rsgis_profile_write, ((unsigned long long)this->numOutBands)*width*nRows*sizeof(double));
+                if(cogWriter != NULL)
                 {
-                    pbar.progress((nYBlocks*yBlockSize)+m, height);
-                    
-                    for(int j = 0; j < width; j++)
+                    try
                     {
-                        for(int n = 0; n < numInBands; n++)
-                        {
-                            inDataColumn[n] = inputData[n][(m*width)+j];
-                        }
-                        
-                        this->calc->calcImageValue(inDataColumn, numInBands, outDataColumn);
-                        
-                        for(int n = 0; n < this->numOutBands; n++)
-                        {
-                            outputData[n][(m*width)+j] = outDataColumn[n];
-                        }
-                        
+                        cogWriter->writeStrip(yBlockSize * strip, nRows, stripOutData[buf].data());
+                    }
+                    catch(rsgis::RSGISImageException &e)
+                    {
+                        throw RSGISImageBandException(e.what());
                     }
+                    return;
                 }
-				
-				for(int n = 0; n < this->numOutBands; n++)
+                for(int n = 0; n < this->numOutBands; n++)
 				{
-                    rowOffset = (yBlockSize * nYBlocks);
-					outputRasterBands[n]->RasterIO(GF_Write, 0, rowOffset, width, remainRows, outputData[n], width, remainRows, GDT_Float64, 0, 0);
+                    int rowOffset = yBlockSize * strip;
+					outputRasterBands[n]->RasterIO(GF_Write, 0, rowOffset, width, nRows, stripOutData[buf][n], width, nRows, GDT_Float64, 0, 0);
 				}
-            }
+                writeTimer.stop();
+                
+                if((checkpointSecs > 0) && ((strip+1) < nStrips) && (std::chrono::steady_clock::now() - lastCheckpoint) >= std::chrono::seconds(this->checkpointSecs))
+                {
+                    outputImageDS->FlushCache();
+                    checkpoint.completedRows = (strip * yBlockSize) + nRows;
+                    if(!RSGISCalcImageCheckpoint::writeCheckpoint(checkpointFile, checkpoint))
+                    {
+                        std::cerr << "Warning: could not write the checkpoint file " << checkpointFile << std::endl;
+                    }
+                    lastCheckpoint = std::chrono::steady_clock::now();
+                }
+            };
+            // Loop images to process data (reading and writing on separate threads if more than 1 I/O buffer).
+            ioPipeline.run(nStrips - startStrip, [&](size_t strip, unsigned int buf){readStrip(startStrip + strip, buf);}, [&](size_t strip, unsigned int buf){computeStrip(startStrip + strip, buf);}, [&](size_t strip, unsigned int buf){writeStrip(startStrip + strip, buf);});
 			pbar.finish();
+            if(checkpointSecs > 0)
+            {
+                RSGISCalcImageCheckpoint::removeCheckpoint(checkpointFile);
+            }
+            if(cogWriter != NULL)
+            {
+                try
+                {
+                    cogWriter->close();
+                }
+                catch(rsgis::RSGISImageException &e)
+                {
+                    throw RSGISImageBandException(e.what());
+                }
+            }
 		}
 		catch(RSGISImageCalcException& e)
 		{
@@ -280,15 +446,7 @@ namespace rsgis{namespace img{
 				delete[] outputData;
 			}
 			
-			if(inDataColumn != NULL)
-			{
-				delete[] inDataColumn;
-			}
-			
-			if(outDataColumn != NULL)
-			{
-				delete[] outDataColumn;
-			}
+			this->deleteThreadCalcs(threadCalcs);
 			
 			if(inputRasterBands != NULL)
 			{
@@ -299,6 +457,11 @@ namespace rsgis{namespace img{
 			{
 				delete[] outputRasterBands;
 			}
+            
+            if(cogWriter != NULL)
+            {
+                delete cogWriter;
+            }
 			throw e;
 		}
 		catch(RSGISImageBandException& e)
@@ -356,15 +519,7 @@ namespace rsgis{namespace img{
 				delete[] outputData;
 			}
 			
-			if(inDataColumn != NULL)
-			{
-				delete[] inDataColumn;
-			}
-			
-			if(outDataColumn != NULL)
-			{
-				delete[] outDataColumn;
-			}
+			this->deleteThreadCalcs(threadCalcs);
 			
 			if(inputRasterBands != NULL)
 			{
@@ -375,10 +530,25 @@ namespace rsgis{namespace img{
 			{
 				delete[] outputRasterBands;
 			}
+            
+            if(cogWriter != NULL)
+            {
+                delete cogWriter;
+            }
 			throw e;
 		}
 		
-		GDALClose(outputImageDS);
+        if(cogWriter != NULL)
+        {
+            delete cogWriter;
+        }
+        else
+        {
+            GDALClose(outputImageDS);
+        }
+        
+        this->reduceThreadCalcs(threadCalcs);
+        this->deleteThreadCalcs(threadCalcs);
 		
 		if(gdalTranslation != NULL)
 		{
@@ -433,15 +603,6 @@ namespace rsgis{namespace img{
 			delete[] outputData;
 		}
 		
-		if(inDataColumn != NULL)
-		{
-			delete[] inDataColumn;
-		}
-		
-		if(outDataColumn != NULL)
-		{
-			delete[] outDataColumn;
-		}
 		
 		if(inputRasterBands != NULL)
 		{
@@ -458,7 +619,7 @@ namespace rsgis{namespace img{
     
     void RSGISCalcImage::calcImage(GDALDataset **datasets, int numDS, std::string outputImage, std::string outputRefIntImage, std::string gdalFormat, GDALDataType gdalDataType)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         RSGISImageUtils imgUtils;
         double *gdalTranslation = new double[6];
         int **dsOffsets = new int*[numDS];
@@ -569,6 +730,7 @@ namespace rsgis{namespace img{
             {
                 yBlockSize = outYBlockSize;
             }
+            yBlockSize = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (numInBands*sizeof(float))+(this->numOutBands*sizeof(double)), this->stripMemoryMB);
             
             // Allocate memory
             inputData = new float*[numInBands];
@@ -919,7 +1081,7 @@ namespace rsgis{namespace img{
     
     void RSGISCalcImage::calcImage(GDALDataset **datasets, int numDS, GDALDataset *outputImageDS)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numDS];
@@ -941,6 +1103,7 @@ namespace rsgis{namespace img{
 		
 		GDALRasterBand **inputRasterBands = NULL;
 		GDALRasterBand **outputRasterBands = NULL;
+		std::vector<RSGISCalcImageValue*> threadCalcs;
 		
 		try
 		{
@@ -999,6 +1162,7 @@ namespace rsgis{namespace img{
             {
                 yBlockSize = outYBlockSize;
             }
+            yBlockSize = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (numInBands*sizeof(float))+(this->numOutBands*sizeof(double)), this->stripMemoryMB);
             
 			// Allocate memory
 			inputData = new float*[numInBands];
@@ -1015,24 +1179,47 @@ namespace rsgis{namespace img{
 			}
 			outDataColumn = new double[this->numOutBands];
             
-			int nYBlocks = height / yBlockSize;
-            int remainRows = height - (nYBlocks * yBlockSize);
-            int rowOffset = 0;
+            // One calc object and pixel buffer per thread; threadCalcs[0] is this->calc.
+            threadCalcs = this->createThreadCalcs();
+            unsigned int nThreads = threadCalcs.size();
+            std::vector<std::vector<float> > threadInDataColumn(nThreads, std::vector<float>(numInBands));
+            std::vector<std::vector<double> > threadOutDataColumn(nThreads, std::vector<double>(this->numOutBands));
+            std::vector<std::vector<const float*> > threadInBlock(nThreads, std::vector<const float*>(numInBands));
+            std::vector<std::vector<double*> > threadOutBlock(nThreads, std::vector<double*>(this->numOutBands));
+            rsgis::RSGISThreadPool threadPool(nThreads);
             
-			rsgis_tqdm pbar;
-			// Loop images to process data
-			for(int i = 0; i < nYBlocks; i++)
-			{
-				for(int n = 0; n < numInBands; n++)
-				{
-                    rowOffset = bandOffsets[n][1] + (yBlockSize * i);
-					inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], rowOffset, width, yBlockSize, inputData[n], width, yBlockSize, GDT_Float32, 0, 0);
-				}
+            // Allocate the rows of the strip buffers on the NUMA node processing them.
+            for(int i = 0; i < numInBands; i++)
+            {
+                threadPool.firstTouch(inputData[i], yBlockSize, sizeof(float)*width);
+            }
+            for(int i = 0; i < this->numOutBands; i++)
+            {
+                threadPool.firstTouch(outputData[i], yBlockSize, sizeof(double)*width);
+            }
+            
+            // Process the rows [mStart, mEnd) of the current strip.
+            auto processRows = [&](unsigned int t, size_t mStart, size_t mEnd)
+            {
+                // The rows are contiguous within the strip so try the block API first.
+                size_t pxlOff = mStart*width;
+                for(int n = 0; n < numInBands; n++)
+                {
+                    threadInBlock[t][n] = inputData[n] + pxlOff;
+                }
+                for(int n = 0; n < this->numOutBands; n++)
+                {
+                    threadOutBlock[t][n] = outputData[n] + pxlOff;
+                }
+                if(threadCalcs[t]->calcImageBlock(threadInBlock[t].data(), numInBands, (mEnd-mStart)*width, threadOutBlock[t].data()))
+                {
+                    return;
+                }
                 
-                for(int m = 0; m < yBlockSize; ++m)
+                float *inDataColumn = threadInDataColumn[t].data();
+                double *outDataColumn = threadOutDataColumn[t].data();
+                for(size_t m = mStart; m < mEnd; ++m)
                 {
-                    pbar.progress((i*yBlockSize)+m, height);
-                    
                     for(int j = 0; j < width; j++)
                     {
                         for(int n = 0; n < numInBands; n++)
@@ -1040,15 +1227,32 @@ namespace rsgis{namespace img{
                             inDataColumn[n] = inputData[n][(m*width)+j];
                         }
                         
-                        this->calc->calcImageValue(inDataColumn, numInBands, outDataColumn);
+                        threadCalcs[t]->calcImageValue(inDataColumn, numInBands, outDataColumn);
                         
                         for(int n = 0; n < this->numOutBands; n++)
                         {
                             outputData[n][(m*width)+j] = outDataColumn[n];
                         }
-                        
                     }
                 }
+            };
+            
+			int nYBlocks = height / yBlockSize;
+            int remainRows = height - (nYBlocks * yBlockSize);
+            int rowOffset = 0;
+            
+			rsgis_tqdm pbar;
+			// Loop images to process data
+			for(int i = 0; i < nYBlocks; i++)
+			{
+				for(int n = 0; n < numInBands; n++)
+				{
+                    rowOffset = bandOffsets[n][1] + (yBlockSize * i);
+					inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], rowOffset, width, yBlockSize, inputData[n], width, yBlockSize, GDT_Float32, 0, 0);
+				}
+                
+                pbar.progress((i*yBlockSize), height);
+                threadPool.parallelFor(0, yBlockSize, processRows);
 				
 				for(int n = 0; n < this->numOutBands; n++)
 				{
@@ -1065,26 +1269,8 @@ namespace rsgis{namespace img{
 					inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], rowOffset, width, remainRows, inputData[n], width, remainRows, GDT_Float32, 0, 0);
 				}
                 
-                for(int m = 0; m < remainRows; ++m)
-                {
-                    pbar.progress((nYBlocks*yBlockSize)+m, height);
-                    
-                    for(int j = 0; j < width; j++)
-                    {
-                        for(int n = 0; n < numInBands; n++)
-                        {
-                            inDataColumn[n] = inputData[n][(m*width)+j];
-                        }
-                        
-                        this->calc->calcImageValue(inDataColumn, numInBands, outDataColumn);
-                        
-                        for(int n = 0; n < this->numOutBands; n++)
-                        {
-                            outputData[n][(m*width)+j] = outDataColumn[n];
-                        }
-                        
-                    }
-                }
+                pbar.progress((nYBlocks*yBlockSize), height);
+                threadPool.parallelFor(0, remainRows, processRows);
 				
 				for(int n = 0; n < this->numOutBands; n++)
 				{
@@ -1096,6 +1282,7 @@ namespace rsgis{namespace img{
 		}
 		catch(RSGISImageCalcException& e)
 		{			
+			this->deleteThreadCalcs(threadCalcs);
 			if(gdalTranslation != NULL)
 			{
 				delete[] gdalTranslation;
@@ -1172,6 +1359,7 @@ namespace rsgis{namespace img{
 		}
 		catch(RSGISImageBandException& e)
 		{			
+			this->deleteThreadCalcs(threadCalcs);
 			if(gdalTranslation != NULL)
 			{
 				delete[] gdalTranslation;
@@ -1246,6 +1434,9 @@ namespace rsgis{namespace img{
 			}
 			throw e;
 		}
+		
+        this->reduceThreadCalcs(threadCalcs);
+        this->deleteThreadCalcs(threadCalcs);
 				
 		if(gdalTranslation != NULL)
 		{
@@ -1323,7 +1514,7 @@ namespace rsgis{namespace img{
     
     void RSGISCalcImage::calcImagePartialOutput(GDALDataset **datasets, int numDS, GDALDataset *outputImageDS)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         RSGISImageUtils imgUtils;
         double *gdalTranslation = new double[6];
         int **dsOffsets = new int*[numDS+1];
@@ -1401,6 +1592,7 @@ namespace rsgis{namespace img{
             {
                 yBlockSize = outYBlockSize;
             }
+            yBlockSize = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (numInBands*sizeof(float))+(this->numOutBands*sizeof(double)), this->stripMemoryMB);
             
             // Allocate memory
             inputData = new float*[numInBands];
@@ -1725,7 +1917,7 @@ namespace rsgis{namespace img{
     
     void RSGISCalcImage::calcImage(GDALDataset **datasets, int numIntDS, int numFloatDS, std::string outputImage, bool setOutNames, std::string *bandNames , std::string gdalFormat, GDALDataType gdalDataType)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
         int numDS = numIntDS + numFloatDS;
 		double *gdalTranslation = new double[6];
@@ -1763,7 +1955,9 @@ namespace rsgis{namespace img{
 		{
 			// Find image overlap
 			imgUtils.getImageOverlap(datasets, numDS, dsOffsets, &width, &height, gdalTranslation, &xBlockSize, &yBlockSize);
-
+            int fullWidth = 0;
+            int fullHeight = 0;
+            this->calcPreviewOverlap(&width, &height, gdalTranslation, &fullWidth, &fullHeight);
             
 			// Count number of image bands
 			for(int i = 0; i < numIntDS; i++)
@@ -1851,6 +2045,7 @@ namespace rsgis{namespace img{
             {
                 yBlockSize = outYBlockSize;
             }
+            yBlockSize = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (numIntBands*sizeof(unsigned int))+(numFloatBands*sizeof(float))+(this->numOutBands*sizeof(double)), this->stripMemoryMB);
 			
 			// Allocate memory
 			inputIntData = new unsigned int*[numIntBands];
@@ -1884,14 +2079,12 @@ namespace rsgis{namespace img{
 			{
 				for(int n = 0; n < numIntBands; n++)
 				{
-                    rowOffset = bandIntOffsets[n][1] + (yBlockSize * i);
-					inputRasterIntBands[n]->RasterIO(GF_Read, bandIntOffsets[n][0], rowOffset, width, yBlockSize, inputIntData[n], width, yBlockSize, GDT_UInt32, 0, 0);
+					this->readRows(inputRasterIntBands[n], bandIntOffsets[n][0], bandIntOffsets[n][1], (yBlockSize * i), yBlockSize, width, fullWidth, fullHeight, inputIntData[n], GDT_UInt32);
 				}
                 
                 for(int n = 0; n < numFloatBands; n++)
 				{
-                    rowOffset = bandFloatOffsets[n][1] + (yBlockSize * i);
-					inputRasterFloatBands[n]->RasterIO(GF_Read, bandFloatOffsets[n][0], rowOffset, width, yBlockSize, inputFloatData[n], width, yBlockSize, GDT_Float32, 0, 0);
+					this->readRows(inputRasterFloatBands[n], bandFloatOffsets[n][0], bandFloatOffsets[n][1], (yBlockSize * i), yBlockSize, width, fullWidth, fullHeight, inputFloatData[n], GDT_Float32);
 				}
                 
                 for(int m = 0; m < yBlockSize; ++m)
@@ -1930,14 +2123,12 @@ namespace rsgis{namespace img{
             {
                 for(int n = 0; n < numIntBands; n++)
 				{
-                    rowOffset = bandIntOffsets[n][1] + (yBlockSize * nYBlocks);
-					inputRasterIntBands[n]->RasterIO(GF_Read, bandIntOffsets[n][0], rowOffset, width, remainRows, inputIntData[n], width, remainRows, GDT_UInt32, 0, 0);
+					this->readRows(inputRasterIntBands[n], bandIntOffsets[n][0], bandIntOffsets[n][1], (yBlockSize * nYBlocks), remainRows, width, fullWidth, fullHeight, inputIntData[n], GDT_UInt32);
 				}
                 
                 for(int n = 0; n < numFloatBands; n++)
 				{
-                    rowOffset = bandFloatOffsets[n][1] + (yBlockSize * nYBlocks);
-					inputRasterFloatBands[n]->RasterIO(GF_Read, bandFloatOffsets[n][0], rowOffset, width, remainRows, inputFloatData[n], width, remainRows, GDT_Float32, 0, 0);
+					this->readRows(inputRasterFloatBands[n], bandFloatOffsets[n][0], bandFloatOffsets[n][1], (yBlockSize * nYBlocks), remainRows, width, fullWidth, fullHeight, inputFloatData[n], GDT_Float32);
 				}
                 
                 for(int m = 0; m < remainRows; ++m)
@@ -2309,7 +2500,7 @@ namespace rsgis{namespace img{
     
     void RSGISCalcImage::calcImage(GDALDataset **datasets, int numIntDS, int numFloatDS, std::string outputImage, std::string outputRefIntImage, std::string gdalFormat, GDALDataType gdalDataType)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         RSGISImageUtils imgUtils;
         int numDS = numIntDS + numFloatDS;
         double *gdalTranslation = new double[6];
@@ -2451,6 +2642,7 @@ namespace rsgis{namespace img{
             {
                 yBlockSize = outYBlockSize;
             }
+            yBlockSize = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (numIntBands*sizeof(unsigned int))+(numFloatBands*sizeof(float))+(this->numOutBands*sizeof(double)), this->stripMemoryMB);
             
             // Allocate memory
             inputIntData = new unsigned int*[numIntBands];
@@ -2918,7 +3110,7 @@ namespace rsgis{namespace img{
     
     void RSGISCalcImage::calcImage(GDALDataset **datasets, int numIntDS, int numFloatDS, OGREnvelope *env, bool quiet)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
         int numDS = numIntDS + numFloatDS;
 		double *gdalTranslation = new double[6];
@@ -2938,6 +3130,7 @@ namespace rsgis{namespace img{
 		float *inDataFloatColumn = NULL;
         unsigned int **inputIntData = NULL;
 		long *inDataIntColumn = NULL;
+		std::vector<RSGISCalcImageValue*> threadCalcs;
         int xBlockSize = 0;
         int yBlockSize = 0;
 		
@@ -3015,6 +3208,48 @@ namespace rsgis{namespace img{
 			inDataFloatColumn = new float[numFloatBands];
             
             
+            // One calc object and pixel buffer per thread; threadCalcs[0] is this->calc.
+            // The values accumulated by the cloned objects are merged using reduce().
+            threadCalcs = this->createThreadCalcs();
+            unsigned int nThreads = threadCalcs.size();
+            std::vector<std::vector<long> > threadInDataIntColumn(nThreads, std::vector<long>(numIntBands));
+            std::vector<std::vector<float> > threadInDataFloatColumn(nThreads, std::vector<float>(numFloatBands));
+            rsgis::RSGISThreadPool threadPool(nThreads);
+            
+            // Allocate the rows of the strip buffers on the NUMA node processing them.
+            for(int i = 0; i < numIntBands; i++)
+            {
+                threadPool.firstTouch(inputIntData[i], yBlockSize, sizeof(unsigned int)*width);
+            }
+            for(int i = 0; i < numFloatBands; i++)
+            {
+                threadPool.firstTouch(inputFloatData[i], yBlockSize, sizeof(float)*width);
+            }
+            
+            // Process the rows [mStart, mEnd) of the current strip.
+            auto processRows = [&](unsigned int t, size_t mStart, size_t mEnd)
+            {
+                long *intColumn = threadInDataIntColumn[t].data();
+                float *floatColumn = threadInDataFloatColumn[t].data();
+                for(size_t m = mStart; m < mEnd; ++m)
+                {
+                    for(int j = 0; j < width; j++)
+                    {
+                        for(int n = 0; n < numIntBands; n++)
+                        {
+                            intColumn[n] = inputIntData[n][(m*width)+j];
+                        }
+                        
+                        for(int n = 0; n < numFloatBands; n++)
+                        {
+                            floatColumn[n] = inputFloatData[n][(m*width)+j];
+                        }
+                        
+                        threadCalcs[t]->calcImageValue(intColumn, numIntBands, floatColumn, numFloatBands);
+                    }
+                }
+            };
+            
             int nYBlocks = height / yBlockSize;
             int remainRows = height - (nYBlocks * yBlockSize);
             int rowOffset = 0;
@@ -3039,29 +3274,11 @@ namespace rsgis{namespace img{
 					inputRasterFloatBands[n]->RasterIO(GF_Read, bandFloatOffsets[n][0], rowOffset, width, yBlockSize, inputFloatData[n], width, yBlockSize, GDT_Float32, 0, 0);
 				}
                 
-                for(int m = 0; m < yBlockSize; ++m)
+                if(!quiet)
                 {
-                    if(!quiet)
-                    {
-                        pbar->progress((i*yBlockSize)+m, height);
-                    }
-                    
-                    
-                    for(int j = 0; j < width; j++)
-                    {
-                        for(int n = 0; n < numIntBands; n++)
-                        {
-                            inDataIntColumn[n] = inputIntData[n][(m*width)+j];
-                        }
-                        
-                        for(int n = 0; n < numFloatBands; n++)
-                        {
-                            inDataFloatColumn[n] = inputFloatData[n][(m*width)+j];
-                        }
-                        
-                        this->calc->calcImageValue(inDataIntColumn, numIntBands, inDataFloatColumn, numFloatBands);
-                    }
+                    pbar->progress((i*yBlockSize), height);
                 }
+                threadPool.parallelFor(0, yBlockSize, processRows);
 			}
             
             if(remainRows > 0)
@@ -3079,28 +3296,11 @@ namespace rsgis{namespace img{
 					inputRasterFloatBands[n]->RasterIO(GF_Read, bandFloatOffsets[n][0], rowOffset, width, remainRows, inputFloatData[n], width, remainRows, GDT_Float32, 0, 0);
 				}
                 
-                for(int m = 0; m < remainRows; ++m)
+                if(!quiet)
                 {
-                    if(!quiet)
-                    {
-                        pbar->progress((nYBlocks*yBlockSize)+m, height);
-                    }
-                    
-                    for(int j = 0; j < width; j++)
-                    {
-                        for(int n = 0; n < numIntBands; n++)
-                        {
-                            inDataIntColumn[n] = inputIntData[n][(m*width)+j];
-                        }
-                        
-                        for(int n = 0; n < numFloatBands; n++)
-                        {
-                            inDataFloatColumn[n] = inputFloatData[n][(m*width)+j];
-                        }
-                        
-                        this->calc->calcImageValue(inDataIntColumn, numIntBands, inDataFloatColumn, numFloatBands);
-                    }
+                    pbar->progress((nYBlocks*yBlockSize), height);
                 }
+                threadPool.parallelFor(0, remainRows, processRows);
             }
             if(!quiet)
             {
@@ -3194,6 +3394,7 @@ namespace rsgis{namespace img{
 			{
 				delete[] inputRasterFloatBands;
 			}
+			this->deleteThreadCalcs(threadCalcs);
 			throw e;
 		}
 		catch(RSGISImageBandException& e)
@@ -3282,6 +3483,7 @@ namespace rsgis{namespace img{
 			{
 				delete[] inputRasterFloatBands;
 			}
+			this->deleteThreadCalcs(threadCalcs);
 			throw e;
 		}
         
@@ -3369,11 +3571,14 @@ namespace rsgis{namespace img{
         {
             delete[] inputRasterFloatBands;
         }
+        
+        this->reduceThreadCalcs(threadCalcs);
+        this->deleteThreadCalcs(threadCalcs);
     }
 	
     void RSGISCalcImage::calcImage(GDALDataset **datasets, int numIntDS, int numFloatDS, GDALDataset *outputImageDS)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
         int numDS = numIntDS + numFloatDS;
 		double *gdalTranslation = new double[6];
@@ -3482,6 +3687,7 @@ namespace rsgis{namespace img{
             {
                 yBlockSize = outYBlockSize;
             }
+            yBlockSize = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (numIntBands*sizeof(unsigned int))+(numFloatBands*sizeof(float))+(this->numOutBands*sizeof(double)), this->stripMemoryMB);
 			
 			// Allocate memory
 			inputIntData = new unsigned int*[numIntBands];
@@ -3938,7 +4144,8 @@ namespace rsgis{namespace img{
     
 	void RSGISCalcImage::calcImage(GDALDataset **datasets, int numDS)
 	{
-		GDALAllRegister();
+        rsgis::RSGISProfileRun profileRun("calcImage");
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numDS];
@@ -3952,7 +4159,7 @@ namespace rsgis{namespace img{
 		int numInBands = 0;
 		
 		float **inputData = NULL;
-		float *inDataColumn = NULL;
+		std::vector<RSGISCalcImageValue*> threadCalcs;
         int xBlockSize = 0;
         int yBlockSize = 0;
 		
@@ -3962,6 +4169,9 @@ namespace rsgis{namespace img{
 		{
 			// Find image overlap
 			imgUtils.getImageOverlap(datasets, numDS, dsOffsets, &width, &height, gdalTranslation, &xBlockSize, &yBlockSize);
+            int fullWidth = 0;
+            int fullHeight = 0;
+            bool preview = this->calcPreviewOverlap(&width, &height, gdalTranslation, &fullWidth, &fullHeight);
             
 			// Count number of image bands
 			for(int i = 0; i < numDS; i++)
@@ -3985,32 +4195,33 @@ namespace rsgis{namespace img{
 				}
 			}
 			
+            yBlockSize = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, numInBands*sizeof(float), this->stripMemoryMB);
 			// Allocate memory
 			inputData = new float*[numInBands];
 			for(int i = 0; i < numInBands; i++)
 			{
 				inputData[i] = (float *) CPLMalloc(sizeof(float)*width*yBlockSize);
 			}
-			inDataColumn = new float[numInBands];
             
-            int nYBlocks = height / yBlockSize;
-            int remainRows = height - (nYBlocks * yBlockSize);
-            int rowOffset = 0;
+            // One calc object and pixel buffer per thread; threadCalcs[0] is this->calc.
+            // The values accumulated by the cloned objects are merged using reduce().
+            threadCalcs = this->createThreadCalcs();
+            unsigned int nThreads = threadCalcs.size();
+            std::vector<std::vector<float> > threadInDataColumn(nThreads, std::vector<float>(numInBands));
+            rsgis::RSGISThreadPool threadPool(nThreads);
             
-			rsgis_tqdm pbar;
-			// Loop images to process data
-			for(int i = 0; i < nYBlocks; i++)
-			{
-				for(int n = 0; n < numInBands; n++)
-				{
-                    rowOffset = bandOffsets[n][1] + (yBlockSize * i);
-					inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], rowOffset, width, yBlockSize, inputData[n], width, yBlockSize, GDT_Float32, 0, 0);
-				}
-                
-                for(int m = 0; m < yBlockSize; ++m)
+            // Allocate the rows of the strip buffers on the NUMA node processing them.
+            for(int i = 0; i < numInBands; i++)
+            {
+                threadPool.firstTouch(inputData[i], yBlockSize, sizeof(float)*width);
+            }
+            
+            // Process the rows [mStart, mEnd) of the current strip.
+            auto processRows = [&](unsigned int t, size_t mStart, size_t mEnd)
+            {
+                float *inDataColumn = threadInDataColumn[t].data();
+                for(size_t m = mStart; m < mEnd; ++m)
                 {
-                    pbar.progress((i*yBlockSize)+m, height);
-                    
                     for(int j = 0; j < width; j++)
                     {
                         for(int n = 0; n < numInBands; n++)
@@ -4018,33 +4229,58 @@ namespace rsgis{namespace img{
                             inDataColumn[n] = inputData[n][(m*width)+j];
                         }
                         
-                        this->calc->calcImageValue(inDataColumn, numInBands);
+                        threadCalcs[t]->calcImageValue(inDataColumn, numInBands);
+                    }
+                }
+            };
+            
+            int nYBlocks = height / yBlockSize;
+            int remainRows = height - (nYBlocks * yBlockSize);
+            // Remote (e.g., /vsis3/) inputs are read with tile aligned concurrent requests.
+            RSGISRemoteReadPlanner remotePlanner(datasets, numDS, dsOffsets, width, height, yBlockSize, preview?0:this->remoteMaxRequests);
+            
+			rsgis_tqdm pbar;
+			// Loop images to process data
+			for(int i = 0; i < nYBlocks; i++)
+			{
+                rsgis::RSGISProfileTimer readTimer(rsgis::rsgis_profile_read, ((unsigned long long)numInBands)*width*yBlockSize*sizeof(float));
+                if(remotePlanner.hasRemoteInputs())
+                {
+                    remotePlanner.readStrip(yBlockSize * i, yBlockSize, inputData);
+                }
+                else
+                {
+                    for(int n = 0; n < numInBands; n++)
+                    {
+                        this->readRows(inputRasterBands[n], bandOffsets[n][0], bandOffsets[n][1], (yBlockSize * i), yBlockSize, width, fullWidth, fullHeight, inputData[n], GDT_Float32);
                     }
                 }
+                readTimer.stop();
+                
+                pbar.progress((i*yBlockSize), height);
+                rsgis::RSGISProfileTimer calcTimer(rsgis::rsgis_profile_calc, 0, ((unsigned long long)width)*yBlockSize);
+                threadPool.parallelFor(0, yBlockSize, processRows);
 			}
             
             if(remainRows > 0)
             {
-                for(int n = 0; n < numInBands; n++)
-				{
-                    rowOffset = bandOffsets[n][1] + (yBlockSize * nYBlocks);
-					inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], rowOffset, width, remainRows, inputData[n], width, remainRows, GDT_Float32, 0, 0);
-				}
-                
-                for(int m = 0; m < remainRows; ++m)
+                rsgis::RSGISProfileTimer readTimer(rsgis::rsgis_profile_read, ((unsigned long long)numInBands)*width*remainRows*sizeof(float));
+                if(remotePlanner.hasRemoteInputs())
                 {
-                    pbar.progress((nYBlocks*yBlockSize)+m, height);
-                    
-                    for(int j = 0; j < width; j++)
+                    remotePlanner.readStrip(yBlockSize * nYBlocks, remainRows, inputData);
+                }
+                else
+                {
+                    for(int n = 0; n < numInBands; n++)
                     {
-                        for(int n = 0; n < numInBands; n++)
-                        {
-                            inDataColumn[n] = inputData[n][(m*width)+j];
-                        }
-                        
-                        this->calc->calcImageValue(inDataColumn, numInBands);
+                        this->readRows(inputRasterBands[n], bandOffsets[n][0], bandOffsets[n][1], (yBlockSize * nYBlocks), remainRows, width, fullWidth, fullHeight, inputData[n], GDT_Float32);
                     }
                 }
+                readTimer.stop();
+                
+                pbar.progress((nYBlocks*yBlockSize), height);
+                rsgis::RSGISProfileTimer calcTimer(rsgis::rsgis_profile_calc, 0, ((unsigned long long)width)*remainRows);
+                threadPool.parallelFor(0, remainRows, processRows);
             }
 			pbar.finish();
 		}
@@ -4090,10 +4326,7 @@ namespace rsgis{namespace img{
 				}
 				delete[] inputData;
 			}		
-			if(inDataColumn != NULL)
-			{
-				delete[] inDataColumn;
-			}
+			this->deleteThreadCalcs(threadCalcs);
 			if(inputRasterBands != NULL)
 			{
 				delete[] inputRasterBands;
@@ -4142,10 +4375,7 @@ namespace rsgis{namespace img{
 				}
 				delete[] inputData;
 			}		
-			if(inDataColumn != NULL)
-			{
-				delete[] inDataColumn;
-			}
+			this->deleteThreadCalcs(threadCalcs);
 			if(inputRasterBands != NULL)
 			{
 				delete[] inputRasterBands;
@@ -4193,10 +4423,9 @@ namespace rsgis{namespace img{
 			}
 			delete[] inputData;
 		}		
-		if(inDataColumn != NULL)
-		{
-			delete[] inDataColumn;
-		}
+		
+		this->reduceThreadCalcs(threadCalcs);
+		this->deleteThreadCalcs(threadCalcs);
 		if(inputRasterBands != NULL)
 		{
 			delete[] inputRasterBands;
@@ -4205,7 +4434,7 @@ namespace rsgis{namespace img{
     
     void RSGISCalcImage::calcImageBand(GDALDataset **datasets, int numDS, std::string outputImageBase, std::string gdalFormat)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
         rsgis::math::RSGISMathsUtils mathUtils;
 		double *gdalTranslation = new double[6];
@@ -4448,7 +4677,7 @@ namespace rsgis{namespace img{
     
     void RSGISCalcImage::calcImageInEnv(GDALDataset **datasets, int numDS, std::string outputImage, OGREnvelope *env, bool setOutNames, std::string *bandNames, std::string gdalFormat, GDALDataType gdalDataType)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numDS];
@@ -4543,6 +4772,7 @@ namespace rsgis{namespace img{
             {
                 yBlockSize = outYBlockSize;
             }
+            yBlockSize = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (numInBands*sizeof(float))+(this->numOutBands*sizeof(double)), this->stripMemoryMB);
             
 			// Allocate memory
 			inputData = new float*[numInBands];
@@ -4869,7 +5099,7 @@ namespace rsgis{namespace img{
     
     void RSGISCalcImage::calcImageInEnv(GDALDataset **datasets, int numDS, OGREnvelope *env, bool quiet)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numDS];
@@ -5158,7 +5388,7 @@ namespace rsgis{namespace img{
     
     void RSGISCalcImage::calcImageInEnv(GDALDataset **datasets, int numIntDS, int numFloatDS, OGREnvelope *env, bool quiet)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         RSGISImageUtils imgUtils;
         int numDS = numIntDS + numFloatDS;
         double *gdalTranslation = new double[6];
@@ -5603,9 +5833,93 @@ namespace rsgis{namespace img{
         }
     }
     
+    void RSGISCalcImage::calcRowsWithPxlCoords(float **inputData, int numInBands, float *inDataColumn, unsigned int width, unsigned int nRows, unsigned int rowStart, const double *transform, bool pxlIdxExtent, bool *useBlockCoords, bool *usePxlCoords)
+    {
+        if(*useBlockCoords)
+        {
+            *useBlockCoords = this->calc->calcImageBlockAtPxls(inputData, numInBands, ((size_t)width)*nRows, RSGISPxlCoordsGenerator(transform, width, rowStart));
+            if(*useBlockCoords)
+            {
+                return;
+            }
+        }
+        
+        OGREnvelope extent;
+        for(unsigned int m = 0; m < nRows; ++m)
+        {
+            for(unsigned int j = 0; j < width; ++j)
+            {
+                for(int n = 0; n < numInBands; ++n)
+                {
+                    inDataColumn[n] = inputData[n][(((size_t)m)*width)+j];
+                }
+                
+                RSGISPxlCoords pxlCoords(transform, j, rowStart+m);
+                if(*usePxlCoords)
+                {
+                    *usePxlCoords = this->calc->calcImageValueAtPxl(inDataColumn, numInBands, pxlCoords);
+                    if(*usePxlCoords)
+                    {
+                        continue;
+                    }
+                }
+                
+                if(pxlIdxExtent)
+                {
+                    extent.MinX = pxlCoords.xPxl;
+                    extent.MaxX = pxlCoords.xPxl;
+                    extent.MinY = pxlCoords.yPxl;
+                    extent.MaxY = pxlCoords.yPxl;
+                }
+                else
+                {
+                    extent.MinX = pxlCoords.getMinX();
+                    extent.MaxX = pxlCoords.getMaxX();
+                    extent.MinY = pxlCoords.getMinY();
+                    extent.MaxY = pxlCoords.getMaxY();
+                }
+                this->calc->calcImageValue(inDataColumn, numInBands, extent);
+            }
+        }
+    }
+    
+    bool RSGISCalcImage::calcPreviewOverlap(int *width, int *height, double *transform, int *fullWidth, int *fullHeight)
+    {
+        *fullWidth = *width;
+        *fullHeight = *height;
+        if(this->previewFactor <= 1)
+        {
+            return false;
+        }
+        int factor = this->previewFactor;
+        // The preview pixels cover whole blocks of input pixels so they have the same origin and are decimated by exactly the factor.
+        *width = std::max(1, (*width) / factor);
+        *height = std::max(1, (*height) / factor);
+        transform[1] = transform[1] * factor;
+        transform[2] = transform[2] * factor;
+        transform[4] = transform[4] * factor;
+        transform[5] = transform[5] * factor;
+        std::cout << "Preview at 1/" << factor << " of the input resolution (" << (*width) << " x " << (*height) << " pixels)" << std::endl;
+        return true;
+    }
+    
+    CPLErr RSGISCalcImage::readRows(GDALRasterBand *band, int xOff, int yOff, int row, int nRows, int width, int fullWidth, int fullHeight, void *data, GDALDataType dataType)
+    {
+        if(this->previewFactor <= 1)
+        {
+            return band->RasterIO(GF_Read, xOff, yOff + row, width, nRows, data, width, nRows, dataType, 0, 0);
+        }
+        int factor = this->previewFactor;
+        // Reading the window into a smaller buffer uses the closest overview of the band (if any) with nearest neighbour resampling.
+        int winXSize = std::min(width * factor, fullWidth);
+        int winYOff = row * factor;
+        int winYSize = std::min((row + nRows) * factor, fullHeight) - winYOff;
+        return band->RasterIO(GF_Read, xOff, yOff + winYOff, winXSize, winYSize, data, width, nRows, dataType, 0, 0);
+    }
+    
     void RSGISCalcImage::calcImagePosPxl(GDALDataset **datasets, int numDS)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numDS];
@@ -5664,9 +5978,8 @@ namespace rsgis{namespace img{
             int remainRows = height - (nYBlocks * yBlockSize);
             int rowOffset = 0;
             
-            unsigned int xPxl = 0;
-            unsigned int yPxl = 0;
-            OGREnvelope extent;
+            bool useBlockCoords = true;
+            bool usePxlCoords = true;
 			rsgis_tqdm pbar;
 			// Loop images to process data
 			for(int i = 0; i < nYBlocks; i++)
@@ -5677,28 +5990,8 @@ namespace rsgis{namespace img{
 					inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], rowOffset, width, yBlockSize, inputData[n], width, yBlockSize, GDT_Float32, 0, 0);
 				}
                 
-                for(int m = 0; m < yBlockSize; ++m)
-                {
-                    pbar.progress((i*yBlockSize)+m, height);
-                    
-                    xPxl = 0;
-                    for(int j = 0; j < width; j++)
-                    {
-                        for(int n = 0; n < numInBands; n++)
-                        {
-                            inDataColumn[n] = inputData[n][(m*width)+j];
-                        }
-                        
-                        extent.MinX = xPxl;
-                        extent.MaxX = xPxl;
-                        extent.MinY = yPxl;
-                        extent.MaxY = yPxl;
-
-                        this->calc->calcImageValue(inDataColumn, numInBands, extent);
-                        ++xPxl;
-                    }
-                    ++yPxl;
-                }
+                pbar.progress(i*yBlockSize, height);
+                this->calcRowsWithPxlCoords(inputData, numInBands, inDataColumn, width, yBlockSize, i*yBlockSize, gdalTranslation, true, &useBlockCoords, &usePxlCoords);
 			}
             
             if(remainRows > 0)
@@ -5709,28 +6002,8 @@ namespace rsgis{namespace img{
 					inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], rowOffset, width, remainRows, inputData[n], width, remainRows, GDT_Float32, 0, 0);
 				}
                 
-                for(int m = 0; m < remainRows; ++m)
-                {
-                    pbar.progress((nYBlocks*yBlockSize)+m, height);
-                    
-                    xPxl = 0;
-                    for(int j = 0; j < width; j++)
-                    {
-                        for(int n = 0; n < numInBands; n++)
-                        {
-                            inDataColumn[n] = inputData[n][(m*width)+j];
-                        }
-
-                        extent.MinX = xPxl;
-                        extent.MaxX = xPxl;
-                        extent.MinY = yPxl;
-                        extent.MaxY = yPxl;
-                        
-                        this->calc->calcImageValue(inDataColumn, numInBands, extent);
-                        ++xPxl;
-                    }
-                    ++yPxl;
-                }
+                pbar.progress(nYBlocks*yBlockSize, height);
+                this->calcRowsWithPxlCoords(inputData, numInBands, inDataColumn, width, remainRows, nYBlocks*yBlockSize, gdalTranslation, true, &useBlockCoords, &usePxlCoords);
             }
 			pbar.finish();
 		}
@@ -5891,7 +6164,7 @@ namespace rsgis{namespace img{
     
     void RSGISCalcImage::calcImagePosPxl(GDALDataset **datasets, int numIntDS, int numFloatDS)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         RSGISImageUtils imgUtils;
         int numDS = numIntDS + numFloatDS;
         double *gdalTranslation = new double[6];
@@ -6345,7 +6618,8 @@ namespace rsgis{namespace img{
     
     void RSGISCalcImage::calcImageExtent(GDALDataset **datasets, int numDS, OGREnvelope *env, bool quiet)
 	{
-		GDALAllRegister();
+        rsgis::RSGISProfileRun profileRun("calcImageExtent");
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numDS];
@@ -6362,12 +6636,6 @@ namespace rsgis{namespace img{
 		float *inDataColumn = NULL;
 		
 		GDALRasterBand **inputRasterBands = NULL;
-        
-        OGREnvelope extent;
-		double pxlTLX = 0;
-		double pxlTLY = 0;
-		double pxlWidth = 0;
-		double pxlHeight = 0;
 		
 		try
 		{
@@ -6387,16 +6655,6 @@ namespace rsgis{namespace img{
 				numInBands += datasets[i]->GetRasterCount();
 			}
 			
-			pxlTLX = gdalTranslation[0];
-			pxlTLY = gdalTranslation[3];
-			pxlWidth = gdalTranslation[1];
-			pxlHeight = gdalTranslation[5];
-            
-            if(pxlHeight < 0)
-            {
-                pxlHeight *= (-1);
-            }
-			
 			// Get Image Input Bands
 			bandOffsets = new int*[numInBands];
 			inputRasterBands = new GDALRasterBand*[numInBands];
@@ -6421,6 +6679,8 @@ namespace rsgis{namespace img{
 			}
 			inDataColumn = new float[numInBands];
 			
+            bool useBlockCoords = true;
+            bool usePxlCoords = true;
 			rsgis_tqdm *pbar = NULL;
             if(!quiet)
             {
@@ -6434,29 +6694,15 @@ namespace rsgis{namespace img{
                     pbar->progress(i, height);
                 }
 				
+                rsgis::RSGISProfileTimer readTimer(rsgis::rsgis_profile_read, ((unsigned long long)numInBands)*width*sizeof(float));
 				for(int n = 0; n < numInBands; n++)
 				{
 					inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], (bandOffsets[n][1]+i), width, 1, inputData[n], width, 1, GDT_Float32, 0, 0);
 				}
+                readTimer.stop();
 
-                for(int j = 0; j < width; j++)
-				{
-                    for(int n = 0; n < numInBands; n++)
-					{
-						inDataColumn[n] = inputData[n][j];
-					}
-					
-                    extent.MinX = pxlTLX;
-                    extent.MaxX = (pxlTLX+pxlWidth);
-                    extent.MinY = (pxlTLY-pxlHeight);
-                    extent.MaxY = pxlTLY;
-					
-					this->calc->calcImageValue(inDataColumn, numInBands, extent);
-					
-					pxlTLX += pxlWidth;
-				}
-				pxlTLY -= pxlHeight;
-				pxlTLX = gdalTranslation[0];
+                rsgis::RSGISProfileTimer calcTimer(rsgis::rsgis_profile_calc, 0, width);
+                this->calcRowsWithPxlCoords(inputData, numInBands, inDataColumn, width, 1, i, gdalTranslation, false, &useBlockCoords, &usePxlCoords);
 			}
             if(!quiet)
             {
@@ -6627,7 +6873,7 @@ namespace rsgis{namespace img{
     
     void RSGISCalcImage::calcImageExtent(GDALDataset **datasets, int numIntDS, int numFloatDS)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
         int numDS = numIntDS + numFloatDS;
 		double *gdalTranslation = new double[6];
@@ -7097,7 +7343,7 @@ namespace rsgis{namespace img{
 	
 	void RSGISCalcImage::calcImageExtent(GDALDataset **datasets, int numDS, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numDS];
@@ -7482,7 +7728,7 @@ namespace rsgis{namespace img{
 	
     void RSGISCalcImage::calcImageWindowData(GDALDataset **datasets, int numDS, int windowSize)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numDS];
@@ -8341,7 +8587,13 @@ namespace rsgis{namespace img{
     
     void RSGISCalcImage::calcImageWindowData(GDALDataset **datasets, int numDS, std::string outputImage, int windowSize, std::string gdalFormat, GDALDataType gdalDataType)
 	{
-		GDALAllRegister();
+        rsgis::RSGISProfileRun profileRun("calcImageWindowData");
+        if(this->useTileProcessing)
+        {
+            this->calcImageTiles(datasets, numDS, outputImage, false, NULL, gdalFormat, gdalDataType, windowSize);
+            return;
+        }
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numDS];
@@ -8363,6 +8615,7 @@ namespace rsgis{namespace img{
 		double **outputData = NULL;
 		float ***inDataBlock = NULL;
 		double *outDataColumn = NULL;
+		std::vector<RSGISCalcImageValue*> threadCalcs;
 		
 		GDALDataset *outputImageDS = NULL;
 		GDALRasterBand **inputRasterBands = NULL;
@@ -8444,6 +8697,7 @@ namespace rsgis{namespace img{
             {
                 yBlockSize = outYBlockSize;
             }
+            yBlockSize = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (4*numInBands*sizeof(float))+(this->numOutBands*sizeof(double)), this->stripMemoryMB);
             
             int numOfLines = yBlockSize;
             if(yBlockSize < windowSize)
@@ -8503,18 +8757,137 @@ namespace rsgis{namespace img{
             int nYBlocks = floor(((double)height) / ((double)numOfLines));
             int remainRows = height - (nYBlocks * numOfLines);
             int rowOffset = 0;
-            unsigned int line = 0;
-            long cLinePxl = 0;
-            long cPxl = 0;
-            long dLinePxls = 0;
-            int dWinX = 0;
-            int dWinY = 0;
             
             rsgis_tqdm pbar;
+            
+            // The strips are copied into a single zero padded buffer (per band) so the
+            // window for each pixel can be accessed in place (with a row stride of padWidth).
+            size_t padWidth = width + (2*windowMid);
+            size_t padRows = numOfLines + (2*windowMid);
+            std::vector<std::vector<float> > winData(numInBands, std::vector<float>(padWidth*padRows, 0));
+            
+            // The rows of each strip are split between the threads, with one calc object
+            // and set of window buffers per thread; thread 0 uses this->calc, inDataBlock
+            // and outDataColumn.
+            threadCalcs = this->createThreadCalcs();
+            unsigned int nThreads = threadCalcs.size();
+            rsgis::RSGISThreadPool threadPool(nThreads);
+            std::vector<std::vector<double> > threadOutDataColumn(nThreads, std::vector<double>(this->numOutBands));
+            std::vector<std::vector<const float*> > threadWinView(nThreads, std::vector<const float*>(numInBands));
+            std::vector<std::vector<const float*> > threadWinOutColumn(nThreads, std::vector<const float*>(numInBands));
+            std::vector<std::vector<const float*> > threadWinInColumn(nThreads, std::vector<const float*>(numInBands));
+            std::vector<std::vector<std::vector<float> > > threadDataBlockVals(nThreads, std::vector<std::vector<float> >(numInBands*windowSize));
+            std::vector<std::vector<float*> > threadDataBlockRows(nThreads, std::vector<float*>(numInBands*windowSize));
+            std::vector<std::vector<float**> > threadDataBlock(nThreads, std::vector<float**>(numInBands));
+            for(unsigned int t = 1; t < nThreads; ++t)
+            {
+                for(int n = 0; n < numInBands; n++)
+                {
+                    for(int y = 0; y < windowSize; y++)
+                    {
+                        threadDataBlockVals[t][(n*windowSize)+y].resize(windowSize);
+                        threadDataBlockRows[t][(n*windowSize)+y] = threadDataBlockVals[t][(n*windowSize)+y].data();
+                    }
+                    threadDataBlock[t][n] = &threadDataBlockRows[t][n*windowSize];
+                }
+            }
+            // Not std::vector<bool> as the elements are written by different threads.
+            std::vector<char> threadUseWinView(nThreads, 1);
+            std::vector<char> threadUseWinViewSlide(nThreads, 1);
+            
+            auto processWindowLines = [&](int nLines, unsigned int lineOffset)
+            {
+                for(int n = 0; n < numInBands; n++)
+                {
+                    for(size_t r = 0; r < padRows; ++r)
+                    {
+                        long srcRow = ((long)r) - windowMid;
+                        float *srcData = NULL;
+                        if(srcRow < 0)
+                        {
+                            srcData = inputDataUpper[n] + ((numOfLines + srcRow) * width);
+                        }
+                        else if(srcRow >= numOfLines)
+                        {
+                            srcData = inputDataLower[n] + ((srcRow - numOfLines) * width);
+                        }
+                        else
+                        {
+                            srcData = inputDataMain[n] + (srcRow * width);
+                        }
+                        std::copy(srcData, srcData + width, winData[n].begin() + ((r * padWidth) + windowMid));
+                    }
+                }
+                
+                pbar.progress(lineOffset, height);
+                rsgis::RSGISProfileTimer calcTimer(rsgis::rsgis_profile_calc, 0, ((unsigned long long)width)*nLines);
+                threadPool.parallelFor(0, nLines, [&](unsigned int t, size_t mStart, size_t mEnd)
+                {
+                    RSGISCalcImageValue *tCalc = threadCalcs[t];
+                    float ***tDataBlock = (t == 0)?inDataBlock:threadDataBlock[t].data();
+                    double *tOutDataColumn = (t == 0)?outDataColumn:threadOutDataColumn[t].data();
+                    const float **winView = threadWinView[t].data();
+                    const float **winOutColumn = threadWinOutColumn[t].data();
+                    const float **winInColumn = threadWinInColumn[t].data();
+                    for(size_t m = mStart; m < mEnd; ++m)
+                    {
+                        size_t tLinePxl = m*width;
+                        for(int j = 0; j < width; j++)
+                        {
+                            size_t winOff = (m * padWidth) + j;
+                            bool calcDone = false;
+                            if(threadUseWinView[t])
+                            {
+                                if((j > 0) && threadUseWinViewSlide[t])
+                                {
+                                    for(int n = 0; n < numInBands; n++)
+                                    {
+                                        winOutColumn[n] = winData[n].data() + (winOff - 1);
+                                        winInColumn[n] = winData[n].data() + (winOff + (windowSize - 1));
+                                    }
+                                    calcDone = tCalc->calcImageWindowViewSlide(winOutColumn, winInColumn, padWidth, numInBands, windowSize, tOutDataColumn);
+                                    threadUseWinViewSlide[t] = calcDone;
+                                }
+                                if(!calcDone)
+                                {
+                                    for(int n = 0; n < numInBands; n++)
+                                    {
+                                        winView[n] = winData[n].data() + winOff;
+                                    }
+                                    calcDone = tCalc->calcImageWindowView(winView, padWidth, numInBands, windowSize, tOutDataColumn);
+                                    threadUseWinView[t] = calcDone;
+                                }
+                            }
+                            
+                            if(!calcDone)
+                            {
+                                for(int n = 0; n < numInBands; n++)
+                                {
+                                    for(int y = 0; y < windowSize; y++)
+                                    {
+                                        const float *winRow = winData[n].data() + (winOff + (y * padWidth));
+                                        for(int x = 0; x < windowSize; x++)
+                                        {
+                                            tDataBlock[n][y][x] = winRow[x];
+                                        }
+                                    }
+                                }
+                                tCalc->calcImageValue(tDataBlock, numInBands, windowSize, tOutDataColumn);
+                            }
+                            
+                            for(int n = 0; n < this->numOutBands; n++)
+                            {
+                                outputData[n][tLinePxl+j] = tOutDataColumn[n];
+                            }
+                        }
+                    }
+                });
+            };
             if(nYBlocks > 0)
             {
                 for(int i = 0; i < nYBlocks; i++)
                 {
+                    rsgis::RSGISProfileTimer readTimer(rsgis::rsgis_profile_read, ((unsigned long long)numInBands)*numPxlsInBlock*sizeof(float));
                     if(i == 0)
                     {
                         // Set Upper Block with Zeros.
@@ -8630,207 +9003,23 @@ namespace rsgis{namespace img{
                         }
                     }
                     
-                    for(int m = 0; m < numOfLines; ++m)
+                    readTimer.stop();
+                    
+                    processWindowLines(numOfLines, i*numOfLines);
+                    
+                    rsgis::RSGISProfileTimer writeTimer(rsgis::rsgis_profile_write, ((unsigned long long)this->numOutBands)*width*numOfLines*sizeof(double));
+                    for(int n = 0; n < this->numOutBands; n++)
                     {
-                        line = (i*numOfLines)+m;
-                        pbar.progress(line, height);
-                        
-                        cLinePxl = m*width;
-                        
-                        for(int j = 0; j < width; j++)
-                        {
-                            cPxl = cLinePxl+j;
-                            if(m < windowMid)
-                            {
-                                for(int y = 0; y < windowSize; y++)
-                                {
-                                    dWinY = y-windowMid;
-                                    dLinePxls = dWinY * width;
-                                    
-                                    if((cPxl + dLinePxls) < 0)
-                                    {
-                                        for(int x = 0; x < windowSize; x++)
-                                        {
-                                            dWinX = x-windowMid;
-                                            
-                                            if((j+dWinX) < 0)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else if((j+dWinX) >= width)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = inputDataUpper[n][(numPxlsInBlock+(cPxl+dLinePxls))+dWinX];
-                                                }
-                                            }
-                                        }
-                                    }
-                                    else
-                                    {
-                                        for(int x = 0; x < windowSize; x++)
-                                        {
-                                            dWinX = x-windowMid;
-                                            
-                                            if((j+dWinX) < 0)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else if((j+dWinX) >= width)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = inputDataMain[n][(cPxl+dLinePxls)+dWinX];
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                            else if(m > ((numOfLines-1)-windowMid))
-                            {
-                                for(int y = 0; y < windowSize; y++)
-                                {
-                                    dWinY = y-windowMid;
-                                    dLinePxls = dWinY * width;
-                                    
-                                    if((cPxl + dLinePxls) >= numPxlsInBlock)
-                                    {
-                                        for(int x = 0; x < windowSize; x++)
-                                        {
-                                            dWinX = x-windowMid;
-                                            
-                                            if((j+dWinX) < 0)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else if((j+dWinX) >= width)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = inputDataLower[n][((cPxl+dLinePxls)-numPxlsInBlock)+dWinX];
-                                                }
-                                            }
-                                        }
-                                    }
-                                    else
-                                    {
-                                        for(int x = 0; x < windowSize; x++)
-                                        {
-                                            dWinX = x-windowMid;
-                                            
-                                            if((j+dWinX) < 0)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else if((j+dWinX) >= width)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = inputDataMain[n][(cPxl+dLinePxls)+dWinX];
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                            else
-                            {
-                                for(int y = 0; y < windowSize; y++)
-                                {
-                                    dWinY = y-windowMid;
-                                    dLinePxls = dWinY * width;
-                                    
-                                    for(int x = 0; x < windowSize; x++)
-                                    {
-                                        dWinX = x-windowMid;
-                                        
-                                        if((j+dWinX) < 0)
-                                        {
-                                            for(int n = 0; n < numInBands; n++)
-                                            {
-                                                inDataBlock[n][y][x] = 0;
-                                            }
-                                        }
-                                        else if((j+dWinX) >= width)
-                                        {
-                                            for(int n = 0; n < numInBands; n++)
-                                            {
-                                                inDataBlock[n][y][x] = 0;
-                                            }
-                                        }
-                                        else
-                                        {
-                                            for(int n = 0; n < numInBands; n++)
-                                            {
-                                                inDataBlock[n][y][x] = inputDataMain[n][(cPxl+dLinePxls)+dWinX];
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                            
-                            this->calc->calcImageValue(inDataBlock, numInBands, windowSize, outDataColumn);
-                            
-                            for(int n = 0; n < this->numOutBands; n++)
-                            {
-                                outputData[n][cPxl] = outDataColumn[n];
-                            }
-                        }
-                    }
-                    
-                    for(int n = 0; n < this->numOutBands; n++)
-                    {
-                        outputRasterBands[n]->RasterIO(GF_Write, 0, (numOfLines * i), width, numOfLines, outputData[n], width, numOfLines, GDT_Float64, 0, 0);
-                    }
-                }
-                                
-                if(remainRows > 0)
-                {
-                    // Shift Lower Block to Main Block
-                    for(int n = 0; n < numInBands; n++)
-                    {
-                        for(int k = 0; k < numPxlsInBlock; k++)
+                        outputRasterBands[n]->RasterIO(GF_Write, 0, (numOfLines * i), width, numOfLines, outputData[n], width, numOfLines, GDT_Float64, 0, 0);
+                    }
+                }
+                                
+                if(remainRows > 0)
+                {
+                    // Shift Lower Block to Main Block
+                    for(int n = 0; n < numInBands; n++)
+                    {
+                        for(int k = 0; k < numPxlsInBlock; k++)
                         {
                             inputDataUpper[n][k] = inputDataMain[n][k];
                         }
@@ -8854,195 +9043,9 @@ namespace rsgis{namespace img{
                         }
                     }
                     
-                    for(int m = 0; m < remainRows; ++m)
-                    {
-                        line = (nYBlocks*numOfLines)+m;
-                        pbar.progress(line, height);
-                        
-                        cLinePxl = m*width;
-                        
-                        for(int j = 0; j < width; j++)
-                        {
-                            cPxl = cLinePxl+j;
-                            if(m < windowMid)
-                            {
-                                for(int y = 0; y < windowSize; y++)
-                                {
-                                    dWinY = y-windowMid;
-                                    dLinePxls = dWinY * width;
-                                    
-                                    if((cPxl + dLinePxls) < 0)
-                                    {
-                                        for(int x = 0; x < windowSize; x++)
-                                        {
-                                            dWinX = x-windowMid;
-                                            
-                                            if((j+dWinX) < 0)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else if((j+dWinX) >= width)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = inputDataUpper[n][(numPxlsInBlock+(cPxl+dLinePxls))+dWinX];
-                                                }
-                                            }
-                                        }
-                                    }
-                                    else
-                                    {
-                                        for(int x = 0; x < windowSize; x++)
-                                        {
-                                            dWinX = x-windowMid;
-                                            
-                                            if((j+dWinX) < 0)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else if((j+dWinX) >= width)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = inputDataMain[n][(cPxl+dLinePxls)+dWinX];
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                            else if(m > ((numOfLines-1)-windowMid))
-                            {
-                                for(int y = 0; y < windowSize; y++)
-                                {
-                                    dWinY = y-windowMid;
-                                    dLinePxls = dWinY * width;
-                                    
-                                    if((cPxl + dLinePxls) >= numPxlsInBlock)
-                                    {
-                                        for(int x = 0; x < windowSize; x++)
-                                        {
-                                            dWinX = x-windowMid;
-                                            
-                                            if((j+dWinX) < 0)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else if((j+dWinX) >= width)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = inputDataLower[n][((cPxl+dLinePxls)-numPxlsInBlock)+dWinX];
-                                                }
-                                            }
-                                        }
-                                    }
-                                    else
-                                    {
-                                        for(int x = 0; x < windowSize; x++)
-                                        {
-                                            dWinX = x-windowMid;
-                                            
-                                            if((j+dWinX) < 0)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else if((j+dWinX) >= width)
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = 0;
-                                                }
-                                            }
-                                            else
-                                            {
-                                                for(int n = 0; n < numInBands; n++)
-                                                {
-                                                    inDataBlock[n][y][x] = inputDataMain[n][(cPxl+dLinePxls)+dWinX];
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                            else
-                            {
-                                for(int y = 0; y < windowSize; y++)
-                                {
-                                    dWinY = y-windowMid;
-                                    dLinePxls = dWinY * width;
-                                    
-                                    for(int x = 0; x < windowSize; x++)
-                                    {
-                                        dWinX = x-windowMid;
-                                        
-                                        if((j+dWinX) < 0)
-                                        {
-                                            for(int n = 0; n < numInBands; n++)
-                                            {
-                                                inDataBlock[n][y][x] = 0;
-                                            }
-                                        }
-                                        else if((j+dWinX) >= width)
-                                        {
-                                            for(int n = 0; n < numInBands; n++)
-                                            {
-                                                inDataBlock[n][y][x] = 0;
-                                            }
-                                        }
-                                        else
-                                        {
-                                            for(int n = 0; n < numInBands; n++)
-                                            {
-                                                inDataBlock[n][y][x] = inputDataMain[n][(cPxl+dLinePxls)+dWinX];
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                            
-                            this->calc->calcImageValue(inDataBlock, numInBands, windowSize, outDataColumn);
-                            
-                            for(int n = 0; n < this->numOutBands; n++)
-                            {                                
-                                outputData[n][cPxl] = outDataColumn[n];
-                            }
-                        }
-                    }
+                    processWindowLines(remainRows, nYBlocks*numOfLines);
                     
+                    rsgis::RSGISProfileTimer writeTimer(rsgis::rsgis_profile_write, ((unsigned long long)this->numOutBands)*width*remainRows*sizeof(double));
                     for(int n = 0; n < this->numOutBands; n++)
                     {
                         outputRasterBands[n]->RasterIO(GF_Write, 0, (nYBlocks*numOfLines), width, remainRows, outputData[n], width, remainRows, GDT_Float64, 0, 0);
@@ -9131,6 +9134,7 @@ namespace rsgis{namespace img{
 				delete[] outDataColumn;
 			}
 
+			this->deleteThreadCalcs(threadCalcs);
 			throw e;
 		}
 		catch(RSGISImageBandException& e)
@@ -9212,6 +9216,8 @@ namespace rsgis{namespace img{
 				delete[] outDataColumn;
 			}
 			
+			
+			this->deleteThreadCalcs(threadCalcs);
 			throw e;
 		}
 		
@@ -9292,12 +9298,15 @@ namespace rsgis{namespace img{
 			delete[] outDataColumn;
 		}
 		
+		this->reduceThreadCalcs(threadCalcs);
+		this->deleteThreadCalcs(threadCalcs);
+		
 		GDALClose(outputImageDS);
 	}
     
     void RSGISCalcImage::calcImageWindowData(GDALDataset **datasets, int numDS, std::string outputImage, std::string outputRefIntImage, int windowSize, std::string gdalFormat, GDALDataType gdalDataType)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         RSGISImageUtils imgUtils;
         double *gdalTranslation = new double[6];
         int **dsOffsets = new int*[numDS];
@@ -9419,6 +9428,7 @@ namespace rsgis{namespace img{
             {
                 yBlockSize = outYBlockSize;
             }
+            yBlockSize = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (4*numInBands*sizeof(float))+(this->numOutBands*sizeof(double)), this->stripMemoryMB);
             
             int numOfLines = yBlockSize;
             if(yBlockSize < windowSize)
@@ -10391,6 +10401,7 @@ namespace rsgis{namespace img{
             {
                 yBlockSize = outYBlockSize;
             }
+            yBlockSize = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (4*numInBands*sizeof(float))+(this->numOutBands*sizeof(double)), this->stripMemoryMB);
             
             int numOfLines = yBlockSize;
             if(yBlockSize < windowSize)
@@ -11276,7 +11287,7 @@ namespace rsgis{namespace img{
     /* Keeps returning a window of data based upon the supplied windowSize until all finished provides the extent on the central pixel (as envelope) at each iteration */
 	void RSGISCalcImage::calcImageWindowDataExtent(GDALDataset **datasets, int numDS, std::string outputImage, int windowSize, std::string gdalFormat, GDALDataType gdalDataType)
 	{
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         RSGISImageUtils imgUtils;
         double *gdalTranslation = new double[6];
         int **dsOffsets = new int*[numDS];
@@ -11379,6 +11390,7 @@ namespace rsgis{namespace img{
             {
                 yBlockSize = outYBlockSize;
             }
+            yBlockSize = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, (4*numInBands*sizeof(float))+(this->numOutBands*sizeof(double)), this->stripMemoryMB);
             
             int numOfLines = yBlockSize;
             if(yBlockSize < windowSize)
@@ -12262,7 +12274,7 @@ namespace rsgis{namespace img{
 	
 	void RSGISCalcImage::calcImageWithinPolygon(GDALDataset **datasets, int numDS, std::string outputImage, OGREnvelope *env, OGRPolygon *poly, float nodata, pixelInPolyOption pixelPolyOption, std::string gdalFormat,  GDALDataType gdalDataType)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numDS];
@@ -12745,7 +12757,7 @@ namespace rsgis{namespace img{
 		 * numDS = numinput + 1 (output band)
 		 */
 		
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numDS];
@@ -13225,7 +13237,7 @@ namespace rsgis{namespace img{
     /* calcImageWithinPolygon - Does not use an output image */
 	void RSGISCalcImage::calcImageWithinPolygonExtent(GDALDataset **datasets, int numDS, OGREnvelope *env, OGRPolygon *poly, pixelInPolyOption pixelPolyOption)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numDS];
@@ -13610,7 +13622,7 @@ namespace rsgis{namespace img{
 
     void RSGISCalcImage::calcImageWithinPolygonExtentInMem(GDALDataset **datasets, int numDS, OGREnvelope *env, OGRPolygon *poly, pixelInPolyOption pixelPolyOption)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         RSGISImageUtils imgUtils;
         double *gdalTranslation = new double[6];
         int **dsOffsets = new int*[numDS];
@@ -14009,7 +14021,7 @@ namespace rsgis{namespace img{
 		 * numDS = numinput + 2 (mask + output band)
 		 */
 		
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numDS];
@@ -14427,7 +14439,7 @@ namespace rsgis{namespace img{
 	
     void RSGISCalcImage::calcImageBorderPixels(GDALDataset *dataset, bool returnInt)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         
         try
         {
@@ -14544,43 +14556,692 @@ namespace rsgis{namespace img{
         }
     }
     
-	RSGISCalcImage::~RSGISCalcImage()
-	{
-		
-	}
-    
-    
-    
-    RSGISCalcImageMultiImgRes::RSGISCalcImageMultiImgRes(RSGISCalcValuesFromMultiResInputs *valueCalcSum)
-    {
-        this->valueCalcSum = valueCalcSum;
-    }
-    
-    void RSGISCalcImageMultiImgRes::calcImageHighResForLowRegions(GDALDataset *refDataset, GDALDataset *statsDataset, unsigned int statsImgBand, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType, bool useNoDataVal, unsigned int xIOGrid, unsigned int yIOGrid, bool setOutNames, std::string *bandNames)
+    void RSGISCalcImage::calcImageTiles(GDALDataset **datasets, int numDS, std::string outputImage, bool setOutNames, std::string *bandNames, std::string gdalFormat, GDALDataType gdalDataType, int windowSize)
     {
+        rsgis::RSGISProfileRun profileRun("calcImageTiles");
+        rsgis::RSGISGDALInit::init();
+        RSGISImageUtils imgUtils;
+        GDALDataset *outputImageDS = NULL;
+        std::vector<RSGISCalcImageValue*> threadCalcs;
         try
         {
-            GDALAllRegister();
-            RSGISImageUtils imgUtils;
-            
-            if( (statsImgBand == 0) || (statsImgBand > statsDataset->GetRasterCount()) )
-            {
-                throw RSGISImageException("The image band specified for the stats image is not within the image. Don't forget, band numbering starts at 1.");
-            }
-            
-            double *refImgTrans = new double[6];
-            refDataset->GetGeoTransform(refImgTrans);
-            double *statsImgTrans = new double[6];
-            statsDataset->GetGeoTransform(statsImgTrans);
-            
-            // Check stats image has a resolution which is a multiple of the ref image resolution.
-            if(refImgTrans[1] <= statsImgTrans[1])
+            int windowMid = 0;
+            if(windowSize > 0)
             {
-                throw RSGISImageException("Reference image is less than or equal resolution to stats image in X axis.");
+                if((windowSize % 2 == 0) || (windowSize < 3))
+                {
+                    throw RSGISImageCalcException("Window size needs to be 3 or greater and an odd number.");
+                }
+                windowMid = windowSize/2;
             }
-            else if(fmod(refImgTrans[1], statsImgTrans[1]) != 0)
+
+            // Find image overlap
+            std::vector<int> dsOffsetVals(numDS*2);
+            std::vector<int*> dsOffsets(numDS);
+            for(int i = 0; i < numDS; i++)
             {
-                throw RSGISImageException("Stats image resolution is not a multiple  less than or equal resolution to stats image in X axis.");
+                dsOffsets[i] = &dsOffsetVals[i*2];
+            }
+            double gdalTranslation[6];
+            int width = 0;
+            int height = 0;
+            imgUtils.getImageOverlap(datasets, numDS, dsOffsets.data(), &width, &height, gdalTranslation);
+
+            // Create new Image
+            GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(gdalFormat.c_str());
+            if(gdalDriver == NULL)
+            {
+                throw RSGISImageBandException("Requested GDAL driver does not exists..");
+            }
+            char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(gdalFormat);
+            std::cout << "New image width = " << width << " height = " << height << " bands = " << this->numOutBands << std::endl;
+            outputImageDS = gdalDriver->Create(outputImage.c_str(), width, height, this->numOutBands, gdalDataType, papszOptions);
+            if(outputImageDS == NULL)
+            {
+                throw RSGISImageBandException("Output image could not be created. Check filepath.");
+            }
+            outputImageDS->SetGeoTransform(gdalTranslation);
+            if(useImageProj)
+            {
+                outputImageDS->SetProjection(datasets[0]->GetProjectionRef());
+            }
+            else
+            {
+                outputImageDS->SetProjection(proj.c_str());
+            }
+
+            // Get Image Input Bands
+            std::vector<GDALRasterBand*> inputRasterBands;
+            std::vector<int*> bandOffsets;
+            for(int i = 0; i < numDS; i++)
+            {
+                for(int j = 0; j < datasets[i]->GetRasterCount(); j++)
+                {
+                    inputRasterBands.push_back(datasets[i]->GetRasterBand(j+1));
+                    bandOffsets.push_back(dsOffsets[i]);
+                }
+            }
+            int numInBands = inputRasterBands.size();
+
+            //Get Image Output Bands
+            std::vector<GDALRasterBand*> outputRasterBands(this->numOutBands);
+            for(int i = 0; i < this->numOutBands; i++)
+            {
+                outputRasterBands[i] = outputImageDS->GetRasterBand(i+1);
+                if(setOutNames)
+                {
+                    outputRasterBands[i]->SetDescription(bandNames[i].c_str());
+                }
+            }
+
+            // The tiles are aligned to the block grid of the first input image.
+            int tileX = this->tileXSize;
+            int tileY = this->tileYSize;
+            int blockX = 0;
+            int blockY = 0;
+            datasets[0]->GetRasterBand(1)->GetBlockSize(&blockX, &blockY);
+            if(tileX == 0)
+            {
+                tileX = blockX;
+            }
+            if(tileY == 0)
+            {
+                tileY = blockY;
+            }
+            tileX = std::max(std::min(tileX, width), 1);
+            tileY = std::max(std::min(tileY, height), 1);
+
+            std::vector<int> tileXStarts;
+            for(int x = 0; x < width; x = (((x + dsOffsets[0][0]) / tileX) + 1) * tileX - dsOffsets[0][0])
+            {
+                tileXStarts.push_back(x);
+            }
+            tileXStarts.push_back(width);
+            size_t nTileCols = tileXStarts.size()-1;
+
+            // One set of buffers for each tile within a row of tiles, where the
+            // input tiles include a halo of windowMid pixels for the window.
+            size_t maxPadWidth = tileX + (2*windowMid);
+            size_t maxPadRows = tileY + (2*windowMid);
+            std::vector<std::vector<float> > tileInData(nTileCols*numInBands, std::vector<float>(maxPadWidth*maxPadRows));
+            std::vector<std::vector<double> > tileOutData(nTileCols*this->numOutBands, std::vector<double>(((size_t)tileX)*tileY));
+
+            threadCalcs = this->createThreadCalcs();
+            unsigned int nThreads = threadCalcs.size();
+            rsgis::RSGISThreadPool threadPool(nThreads);
+            std::vector<std::vector<float> > threadInDataColumn(nThreads, std::vector<float>(numInBands));
+            std::vector<std::vector<double> > threadOutDataColumn(nThreads, std::vector<double>(this->numOutBands));
+            std::vector<std::vector<const float*> > threadInBlock(nThreads, std::vector<const float*>(numInBands));
+            std::vector<std::vector<double*> > threadOutBlock(nThreads, std::vector<double*>(this->numOutBands));
+            std::vector<std::vector<const float*> > threadOutColumn(nThreads, std::vector<const float*>(numInBands));
+            std::vector<std::vector<const float*> > threadInColumn(nThreads, std::vector<const float*>(numInBands));
+            std::vector<std::vector<std::vector<float> > > threadDataBlockVals(nThreads);
+            std::vector<std::vector<float*> > threadDataBlockRows(nThreads);
+            std::vector<std::vector<float**> > threadDataBlock(nThreads);
+            if(windowSize > 0)
+            {
+                for(unsigned int t = 0; t < nThreads; ++t)
+                {
+                    threadDataBlockVals[t].resize(numInBands*windowSize, std::vector<float>(windowSize));
+                    threadDataBlockRows[t].resize(numInBands*windowSize);
+                    threadDataBlock[t].resize(numInBands);
+                    for(int n = 0; n < numInBands; n++)
+                    {
+                        for(int y = 0; y < windowSize; y++)
+                        {
+                            threadDataBlockRows[t][(n*windowSize)+y] = threadDataBlockVals[t][(n*windowSize)+y].data();
+                        }
+                        threadDataBlock[t][n] = &threadDataBlockRows[t][n*windowSize];
+                    }
+                }
+            }
+            std::vector<char> threadUseWinView(nThreads, 1);
+            std::vector<char> threadUseWinViewSlide(nThreads, 1);
+
+            int rowStart = 0;
+            int rowHeight = 0;
+
+            // Process the tiles [tStart, tEnd) within the current row of tiles.
+            auto processTiles = [&](unsigned int t, size_t tStart, size_t tEnd)
+            {
+                RSGISCalcImageValue *tCalc = threadCalcs[t];
+                float *inDataColumn = threadInDataColumn[t].data();
+                double *outDataColumn = threadOutDataColumn[t].data();
+                for(size_t tc = tStart; tc < tEnd; ++tc)
+                {
+                    int tWidth = tileXStarts[tc+1] - tileXStarts[tc];
+                    size_t padWidth = tWidth + (2*windowMid);
+                    size_t nPxls = ((size_t)tWidth) * rowHeight;
+                    for(int n = 0; n < numInBands; n++)
+                    {
+                        threadInBlock[t][n] = tileInData[(tc*numInBands)+n].data();
+                    }
+                    for(int n = 0; n < this->numOutBands; n++)
+                    {
+                        threadOutBlock[t][n] = tileOutData[(tc*this->numOutBands)+n].data();
+                    }
+
+                    if(windowSize == 0)
+                    {
+                        if(!tCalc->calcImageBlock(threadInBlock[t].data(), numInBands, nPxls, threadOutBlock[t].data()))
+                        {
+                            for(size_t p = 0; p < nPxls; ++p)
+                            {
+                                for(int n = 0; n < numInBands; n++)
+                                {
+                                    inDataColumn[n] = threadInBlock[t][n][p];
+                                }
+                                tCalc->calcImageValue(inDataColumn, numInBands, outDataColumn);
+                                for(int n = 0; n < this->numOutBands; n++)
+                                {
+                                    threadOutBlock[t][n][p] = outDataColumn[n];
+                                }
+                            }
+                        }
+                        continue;
+                    }
+
+                    for(int m = 0; m < rowHeight; ++m)
+                    {
+                        for(int j = 0; j < tWidth; ++j)
+                        {
+                            size_t winOff = (((size_t)m) * padWidth) + j;
+                            bool calcDone = false;
+                            if(threadUseWinView[t])
+                            {
+                                if((j > 0) && threadUseWinViewSlide[t])
+                                {
+                                    for(int n = 0; n < numInBands; n++)
+                                    {
+                                        threadOutColumn[t][n] = threadInBlock[t][n] + (winOff - 1);
+                                        threadInColumn[t][n] = threadInBlock[t][n] + (winOff + (windowSize - 1));
+                                    }
+                                    calcDone = tCalc->calcImageWindowViewSlide(threadOutColumn[t].data(), threadInColumn[t].data(), padWidth, numInBands, windowSize, outDataColumn);
+                                    threadUseWinViewSlide[t] = calcDone;
+                                }
+                                if(!calcDone)
+                                {
+                                    for(int n = 0; n < numInBands; n++)
+                                    {
+                                        threadInColumn[t][n] = threadInBlock[t][n] + winOff;
+                                    }
+                                    calcDone = tCalc->calcImageWindowView(threadInColumn[t].data(), padWidth, numInBands, windowSize, outDataColumn);
+                                    threadUseWinView[t] = calcDone;
+                                }
+                            }
+
+                            if(!calcDone)
+                            {
+                                for(int n = 0; n < numInBands; n++)
+                                {
+                                    for(int y = 0; y < windowSize; y++)
+                                    {
+                                        const float *winRow = threadInBlock[t][n] + (winOff + (y * padWidth));
+                                        for(int x = 0; x < windowSize; x++)
+                                        {
+                                            threadDataBlock[t][n][y][x] = winRow[x];
+                                        }
+                                    }
+                                }
+                                tCalc->calcImageValue(threadDataBlock[t].data(), numInBands, windowSize, outDataColumn);
+                            }
+
+                            for(int n = 0; n < this->numOutBands; n++)
+                            {
+                                threadOutBlock[t][n][(((size_t)m)*tWidth)+j] = outDataColumn[n];
+                            }
+                        }
+                    }
+                }
+            };
+
+            rsgis_tqdm pbar;
+            for(rowStart = 0; rowStart < height; rowStart += rowHeight)
+            {
+                rowHeight = std::min((((rowStart + dsOffsets[0][1]) / tileY) + 1) * tileY - dsOffsets[0][1], height) - rowStart;
+                pbar.progress(rowStart, height);
+
+                // Read the tiles with the halo, where pixels outside of the image are 0.
+                int y0 = std::max(rowStart - windowMid, 0);
+                int y1 = std::min(rowStart + rowHeight + windowMid, height);
+                unsigned long long readPxls = 0;
+                for(size_t tc = 0; tc < nTileCols; ++tc)
+                {
+                    readPxls += (std::min(tileXStarts[tc+1] + windowMid, width) - std::max(tileXStarts[tc] - windowMid, 0)) * (y1 - y0);
+                }
+                rsgis::RSGISProfileTimer readTimer(rsgis::rsgis_profile_read, readPxls*numInBands*sizeof(float));
+                for(size_t tc = 0; tc < nTileCols; ++tc)
+                {
+                    int tStart = tileXStarts[tc];
+                    int tWidth = tileXStarts[tc+1] - tStart;
+                    size_t padWidth = tWidth + (2*windowMid);
+                    int x0 = std::max(tStart - windowMid, 0);
+                    int x1 = std::min(tStart + tWidth + windowMid, width);
+                    size_t dataOff = (((size_t)(y0 - (rowStart - windowMid))) * padWidth) + (x0 - (tStart - windowMid));
+                    for(int n = 0; n < numInBands; n++)
+                    {
+                        std::vector<float> &inData = tileInData[(tc*numInBands)+n];
+                        if(windowMid > 0)
+                        {
+                            std::fill(inData.begin(), inData.end(), 0);
+                        }
+                        if(inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0] + x0, bandOffsets[n][1] + y0, x1 - x0, y1 - y0, inData.data() + dataOff, x1 - x0, y1 - y0, GDT_Float32, 0, padWidth * sizeof(float)) != CE_None)
+                        {
+                            throw RSGISImageBandException("Failed to read the input image.");
+                        }
+                    }
+                }
+
+                readTimer.stop();
+
+                rsgis::RSGISProfileTimer calcTimer(rsgis::rsgis_profile_calc, 0, ((unsigned long long)width)*rowHeight);
+                threadPool.parallelFor(0, nTileCols, processTiles);
+                calcTimer.stop();
+
+                rsgis::RSGISProfileTimer writeTimer(rsgis::rsgis_profile_write, ((unsigned long long)this->numOutBands)*width*rowHeight*sizeof(double));
+                for(size_t tc = 0; tc < nTileCols; ++tc)
+                {
+                    int tStart = tileXStarts[tc];
+                    int tWidth = tileXStarts[tc+1] - tStart;
+                    for(int n = 0; n < this->numOutBands; n++)
+                    {
+                        if(outputRasterBands[n]->RasterIO(GF_Write, tStart, rowStart, tWidth, rowHeight, tileOutData[(tc*this->numOutBands)+n].data(), tWidth, rowHeight, GDT_Float64, 0, 0) != CE_None)
+                        {
+                            throw RSGISImageBandException("Failed to write the output image.");
+                        }
+                    }
+                }
+            }
+            pbar.finish();
+        }
+        catch(RSGISImageCalcException& e)
+        {
+            this->deleteThreadCalcs(threadCalcs);
+            if(outputImageDS != NULL)
+            {
+                GDALClose(outputImageDS);
+            }
+            throw e;
+        }
+        catch(RSGISImageBandException& e)
+        {
+            this->deleteThreadCalcs(threadCalcs);
+            if(outputImageDS != NULL)
+            {
+                GDALClose(outputImageDS);
+            }
+            throw e;
+        }
+
+        GDALClose(outputImageDS);
+
+        this->reduceThreadCalcs(threadCalcs);
+        this->deleteThreadCalcs(threadCalcs);
+    }
+
+    void RSGISCalcImage::calcImageArrays(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        rsgis::RSGISProfileRun profileRun("calcImageArrays");
+        std::vector<RSGISCalcImageValue*> threadCalcs;
+        try
+        {
+            if((this->numOutBands > 0) && (output == NULL))
+            {
+                throw RSGISImageCalcException("Arrays for the output bands need to be provided.");
+            }
+            
+            threadCalcs = this->createThreadCalcs();
+            unsigned int nThreads = threadCalcs.size();
+            rsgis::RSGISThreadPool threadPool(nThreads);
+            std::vector<std::vector<float> > threadInDataColumn(nThreads, std::vector<float>(numBands));
+            std::vector<std::vector<double> > threadOutDataColumn(nThreads, std::vector<double>(this->numOutBands));
+            std::vector<std::vector<const float*> > threadInBlock(nThreads, std::vector<const float*>(numBands));
+            std::vector<std::vector<double*> > threadOutBlock(nThreads, std::vector<double*>(this->numOutBands));
+            
+            // Process the pixels [pStart, pEnd), trying the block API first.
+            auto processPxls = [&](unsigned int t, size_t pStart, size_t pEnd)
+            {
+                RSGISCalcImageValue *tCalc = threadCalcs[t];
+                for(int n = 0; n < numBands; n++)
+                {
+                    threadInBlock[t][n] = bands[n] + pStart;
+                }
+                for(int n = 0; n < this->numOutBands; n++)
+                {
+                    threadOutBlock[t][n] = output[n] + pStart;
+                }
+                if((this->numOutBands > 0) && tCalc->calcImageBlock(threadInBlock[t].data(), numBands, pEnd-pStart, threadOutBlock[t].data()))
+                {
+                    return;
+                }
+                
+                float *inDataColumn = threadInDataColumn[t].data();
+                double *outDataColumn = threadOutDataColumn[t].data();
+                for(size_t p = pStart; p < pEnd; ++p)
+                {
+                    for(int n = 0; n < numBands; n++)
+                    {
+                        inDataColumn[n] = bands[n][p];
+                    }
+                    
+                    if(this->numOutBands > 0)
+                    {
+                        tCalc->calcImageValue(inDataColumn, numBands, outDataColumn);
+                        for(int n = 0; n < this->numOutBands; n++)
+                        {
+                            output[n][p] = outDataColumn[n];
+                        }
+                    }
+                    else
+                    {
+                        tCalc->calcImageValue(inDataColumn, numBands);
+                    }
+                }
+            };
+            
+            rsgis::RSGISProfileTimer calcTimer(rsgis::rsgis_profile_calc, 0, nPxls);
+            threadPool.parallelFor(0, nPxls, processPxls);
+        }
+        catch(RSGISImageCalcException& e)
+        {
+            this->deleteThreadCalcs(threadCalcs);
+            throw e;
+        }
+        catch(RSGISImageBandException& e)
+        {
+            this->deleteThreadCalcs(threadCalcs);
+            throw e;
+        }
+        
+        this->reduceThreadCalcs(threadCalcs);
+        this->deleteThreadCalcs(threadCalcs);
+    }
+    
+    void RSGISCalcImage::calcImageWindowArrays(const float* const* bands, int numBands, size_t width, size_t height, int windowSize, double **output)
+    {
+        rsgis::RSGISProfileRun profileRun("calcImageWindowArrays");
+        std::vector<RSGISCalcImageValue*> threadCalcs;
+        try
+        {
+            if((windowSize % 2 == 0) || (windowSize < 3))
+            {
+                throw RSGISImageCalcException("Window size needs to be 3 or greater and an odd number.");
+            }
+            if((this->numOutBands > 0) && (output == NULL))
+            {
+                throw RSGISImageCalcException("Arrays for the output bands need to be provided.");
+            }
+            size_t windowMid = windowSize/2;
+            size_t winPxls = ((size_t)windowSize) * windowSize;
+            
+            threadCalcs = this->createThreadCalcs();
+            unsigned int nThreads = threadCalcs.size();
+            rsgis::RSGISThreadPool threadPool(nThreads);
+            std::vector<std::vector<double> > threadOutDataColumn(nThreads, std::vector<double>(this->numOutBands));
+            std::vector<std::vector<const float*> > threadWinView(nThreads, std::vector<const float*>(numBands));
+            std::vector<std::vector<const float*> > threadOutColumn(nThreads, std::vector<const float*>(numBands));
+            std::vector<std::vector<const float*> > threadInColumn(nThreads, std::vector<const float*>(numBands));
+            // Windows overlapping the edges are copied with the pixels outside of the arrays set to 0.
+            std::vector<std::vector<float> > threadEdgeWin(nThreads, std::vector<float>(numBands*winPxls));
+            std::vector<std::vector<std::vector<float> > > threadDataBlockVals(nThreads, std::vector<std::vector<float> >(numBands*windowSize, std::vector<float>(windowSize)));
+            std::vector<std::vector<float*> > threadDataBlockRows(nThreads, std::vector<float*>(numBands*windowSize));
+            std::vector<std::vector<float**> > threadDataBlock(nThreads, std::vector<float**>(numBands));
+            for(unsigned int t = 0; t < nThreads; ++t)
+            {
+                for(int n = 0; n < numBands; n++)
+                {
+                    for(int y = 0; y < windowSize; y++)
+                    {
+                        threadDataBlockRows[t][(n*windowSize)+y] = threadDataBlockVals[t][(n*windowSize)+y].data();
+                    }
+                    threadDataBlock[t][n] = &threadDataBlockRows[t][n*windowSize];
+                }
+            }
+            std::vector<char> threadUseWinView(nThreads, 1);
+            std::vector<char> threadUseWinViewSlide(nThreads, 1);
+            
+            // Process the rows [mStart, mEnd) of the arrays.
+            auto processRows = [&](unsigned int t, size_t mStart, size_t mEnd)
+            {
+                RSGISCalcImageValue *tCalc = threadCalcs[t];
+                double *outDataColumn = threadOutDataColumn[t].data();
+                float *edgeWin = threadEdgeWin[t].data();
+                for(size_t m = mStart; m < mEnd; ++m)
+                {
+                    bool rowInside = (m >= windowMid) && ((m + windowMid) < height);
+                    bool prevInside = false;
+                    for(size_t j = 0; j < width; ++j)
+                    {
+                        bool inside = rowInside && (j >= windowMid) && ((j + windowMid) < width);
+                        if(!inside)
+                        {
+                            for(int n = 0; n < numBands; n++)
+                            {
+                                for(int y = 0; y < windowSize; y++)
+                                {
+                                    long yPos = ((long)m) + y - ((long)windowMid);
+                                    for(int x = 0; x < windowSize; x++)
+                                    {
+                                        long xPos = ((long)j) + x - ((long)windowMid);
+                                        float val = 0;
+                                        if((yPos >= 0) && (yPos < (long)height) && (xPos >= 0) && (xPos < (long)width))
+                                        {
+                                            val = bands[n][(((size_t)yPos)*width)+xPos];
+                                        }
+                                        edgeWin[(n*winPxls)+(y*windowSize)+x] = val;
+                                    }
+                                }
+                                threadWinView[t][n] = edgeWin + (n*winPxls);
+                            }
+                        }
+                        size_t winStride = inside?width:windowSize;
+                        
+                        bool calcDone = false;
+                        if(threadUseWinView[t])
+                        {
+                            if(inside && prevInside && threadUseWinViewSlide[t])
+                            {
+                                size_t winOff = ((m - windowMid) * width) + (j - windowMid);
+                                for(int n = 0; n < numBands; n++)
+                                {
+                                    threadOutColumn[t][n] = bands[n] + (winOff - 1);
+                                    threadInColumn[t][n] = bands[n] + (winOff + (windowSize - 1));
+                                }
+                                calcDone = tCalc->calcImageWindowViewSlide(threadOutColumn[t].data(), threadInColumn[t].data(), width, numBands, windowSize, outDataColumn);
+                                threadUseWinViewSlide[t] = calcDone;
+                            }
+                            if(!calcDone)
+                            {
+                                if(inside)
+                                {
+                                    size_t winOff = ((m - windowMid) * width) + (j - windowMid);
+                                    for(int n = 0; n < numBands; n++)
+                                    {
+                                        threadWinView[t][n] = bands[n] + winOff;
+                                    }
+                                }
+                                calcDone = tCalc->calcImageWindowView(threadWinView[t].data(), winStride, numBands, windowSize, outDataColumn);
+                                threadUseWinView[t] = calcDone;
+                            }
+                        }
+                        
+                        if(!calcDone)
+                        {
+                            for(int n = 0; n < numBands; n++)
+                            {
+                                for(int y = 0; y < windowSize; y++)
+                                {
+                                    const float *winRow = NULL;
+                                    if(inside)
+                                    {
+                                        winRow = bands[n] + (((m + y - windowMid) * width) + (j - windowMid));
+                                    }
+                                    else
+                                    {
+                                        winRow = edgeWin + ((n*winPxls) + (y*windowSize));
+                                    }
+                                    for(int x = 0; x < windowSize; x++)
+                                    {
+                                        threadDataBlock[t][n][y][x] = winRow[x];
+                                    }
+                                }
+                            }
+                            tCalc->calcImageValue(threadDataBlock[t].data(), numBands, windowSize, outDataColumn);
+                        }
+                        
+                        for(int n = 0; n < this->numOutBands; n++)
+                        {
+                            output[n][(m*width)+j] = outDataColumn[n];
+                        }
+                        prevInside = inside;
+                    }
+                }
+            };
+            
+            rsgis::RSGISProfileTimer calcTimer(rsgis::rsgis_profile_calc, 0, ((unsigned long long)width)*height);
+            threadPool.parallelFor(0, height, processRows);
+        }
+        catch(RSGISImageCalcException& e)
+        {
+            this->deleteThreadCalcs(threadCalcs);
+            throw e;
+        }
+        catch(RSGISImageBandException& e)
+        {
+            this->deleteThreadCalcs(threadCalcs);
+            throw e;
+        }
+        
+        this->reduceThreadCalcs(threadCalcs);
+        this->deleteThreadCalcs(threadCalcs);
+    }
+    
+    std::vector<RSGISCalcImageValue*> RSGISCalcImage::createThreadCalcs()
+    {
+        std::vector<RSGISCalcImageValue*> threadCalcs;
+        threadCalcs.push_back(this->calc);
+        
+        unsigned int nThreads = this->numThreads;
+        if(nThreads == 0)
+        {
+            nThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+        }
+        
+        if((nThreads > 1) && rsgis::RSGISThreadPool::useNUMAPlacement())
+        {
+            // Clone on a worker placed on the same node as the worker of the processing
+            // pool which uses the clone, so its buffers (e.g., per-clump accumulators)
+            // are first touched on that node. The clones are created one at a time.
+            threadCalcs.resize(nThreads, NULL);
+            bool cloneFailed = false;
+            std::mutex cloneMutex;
+            rsgis::RSGISThreadPool clonePool(nThreads);
+            try
+            {
+                clonePool.forEachWorker([&](unsigned int t)
+                {
+                    if(t == 0)
+                    {
+                        return;
+                    }
+                    std::lock_guard<std::mutex> lock(cloneMutex);
+                    threadCalcs[t] = this->calc->clone();
+                    if(threadCalcs[t] == NULL)
+                    {
+                        cloneFailed = true;
+                    }
+                });
+            }
+            catch(...)
+            {
+                this->deleteThreadCalcs(threadCalcs);
+                throw;
+            }
+            if(cloneFailed)
+            {
+                // Not thread safe so use the serial code path.
+                this->deleteThreadCalcs(threadCalcs);
+            }
+            return threadCalcs;
+        }
+        
+        for(unsigned int i = 1; i < nThreads; ++i)
+        {
+            RSGISCalcImageValue *threadCalc = this->calc->clone();
+            if(threadCalc == NULL)
+            {
+                // Not thread safe so use the serial code path.
+                this->deleteThreadCalcs(threadCalcs);
+                break;
+            }
+            threadCalcs.push_back(threadCalc);
+        }
+        
+        return threadCalcs;
+    }
+    
+    void RSGISCalcImage::reduceThreadCalcs(std::vector<RSGISCalcImageValue*> &threadCalcs)
+    {
+        // Merge in thread order so the result does not depend on the scheduling.
+        for(size_t i = 1; i < threadCalcs.size(); ++i)
+        {
+            this->calc->reduce(threadCalcs.at(i));
+        }
+    }
+    
+    void RSGISCalcImage::deleteThreadCalcs(std::vector<RSGISCalcImageValue*> &threadCalcs)
+    {
+        for(size_t i = 1; i < threadCalcs.size(); ++i)
+        {
+            delete threadCalcs.at(i);
+        }
+        if(!threadCalcs.empty())
+        {
+            threadCalcs.resize(1);
+        }
+    }
+    
+	RSGISCalcImage::~RSGISCalcImage()
+	{
+		
+	}
+    
+    
+    
+    RSGISCalcImageMultiImgRes::RSGISCalcImageMultiImgRes(RSGISCalcValuesFromMultiResInputs *valueCalcSum)
+    {
+        this->valueCalcSum = valueCalcSum;
+        rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+        this->numThreads = context.numThreads;
+        this->stripMemoryMB = context.stripMemoryMB;
+    }
+    
+    void RSGISCalcImageMultiImgRes::calcImageHighResForLowRegions(GDALDataset *refDataset, GDALDataset *statsDataset, unsigned int statsImgBand, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType, bool useNoDataVal, unsigned int xIOGrid, unsigned int yIOGrid, bool setOutNames, std::string *bandNames)
+    {
+        std::vector<RSGISCalcValuesFromMultiResInputs*> threadCalcs;
+        try
+        {
+            rsgis::RSGISGDALInit::init();
+            RSGISImageUtils imgUtils;
+            
+            if( (statsImgBand == 0) || (statsImgBand > statsDataset->GetRasterCount()) )
+            {
+                throw RSGISImageException("The image band specified for the stats image is not within the image. Don't forget, band numbering starts at 1.");
+            }
+            
+            double *refImgTrans = new double[6];
+            refDataset->GetGeoTransform(refImgTrans);
+            double *statsImgTrans = new double[6];
+            statsDataset->GetGeoTransform(statsImgTrans);
+            
+            // Check stats image has a resolution which is a multiple of the ref image resolution.
+            if(refImgTrans[1] <= statsImgTrans[1])
+            {
+                throw RSGISImageException("Reference image is less than or equal resolution to stats image in X axis.");
+            }
+            else if(fmod(refImgTrans[1], statsImgTrans[1]) != 0)
+            {
+                throw RSGISImageException("Stats image resolution is not a multiple  less than or equal resolution to stats image in X axis.");
             }
             double xRefRes = refImgTrans[1];
             double xStatsRes = statsImgTrans[1];
@@ -14676,15 +15337,6 @@ namespace rsgis{namespace img{
             long refPxlWidth = floor((xMaxOverlap - xMinOverlap)/xRefRes);
             long refPxlHeight = floor((yMaxOverlap - yMinOverlap)/yRefRes);
             
-            // Define the number of blocks in the X and Y needed to tranverse the image.
-            long nXBlocks = refPxlWidth / xIOGrid;
-            long remainCols = refPxlWidth - (nXBlocks * xIOGrid);
-            long remainColsStats = (remainCols * nXPxls);
-            
-            long nYBlocks = refPxlHeight / yIOGrid;
-            long remainRows = refPxlHeight - (nYBlocks * yIOGrid);
-            long remainRowsStats = (remainRows * nYPxls);
-            
             // Get Input Stats image band.
             GDALRasterBand *statsBand = statsDataset->GetRasterBand(statsImgBand);
             double noDataVal = 0.0;
@@ -14722,279 +15374,121 @@ namespace rsgis{namespace img{
             outputImageDS->SetGeoTransform(outImgTrans);
             outputImageDS->SetProjection(refDataset->GetProjectionRef());
             
-            // Block width in stats image pixels
-            long xIOGridStats = nXPxls * xIOGrid;
-            long yIOGridStats = nYPxls * yIOGrid;
-            long nStatsPixelsInRefPxl = nXPxls * nYPxls;
+            // The position of the overlap within the stats image.
+            long statsXOff = (long) floor(((xMinOverlap - statsImgXMin)/xStatsRes)+0.5);
+            long statsYOff = (long) floor(((statsImgYMax - yMaxOverlap)/yStatsRes)+0.5);
+            long statsPxlWidth = refPxlWidth * nXPxls;
+            if((statsXOff < 0) || (statsYOff < 0) || ((statsXOff + statsPxlWidth) > statsImgXPxls) || ((statsYOff + (refPxlHeight * nYPxls)) > statsImgYPxls))
+            {
+                throw RSGISImageException("The overlap of the reference image is not within the stats image.");
+            }
             
-            // Create Data Arrays and open output bands
-            unsigned long numRefPxlsInBlock = xIOGrid * yIOGrid;
-            double **refDataArrOuts = new double*[numOutImgBands];
-            GDALRasterBand **outBands = new GDALRasterBand*[numOutImgBands];
-            for(unsigned int i = 0; i < numOutImgBands; ++i)
+            // The offsets of the stats pixels within a reference pixel from its first stats pixel in a strip.
+            long nStatsPixelsInRefPxl = nXPxls * nYPxls;
+            std::vector<size_t> cellPxlIdxs(nStatsPixelsInRefPxl);
+            for(unsigned int y = 0; y < nYPxls; ++y)
             {
-                outBands[i] = outputImageDS->GetRasterBand(i+1);
-                refDataArrOuts[i] = (double *) CPLMalloc(sizeof(double)*numRefPxlsInBlock);
+                for(unsigned int x = 0; x < nXPxls; ++x)
+                {
+                    cellPxlIdxs[(y*nXPxls)+x] = (((size_t)y)*statsPxlWidth) + x;
+                }
             }
             
-            unsigned long numStatsPxlsInBlock = xIOGridStats * yIOGridStats;
-            float *statsDataArr = (float *) CPLMalloc(sizeof(float)*numStatsPxlsInBlock);
+            // Read strips of whole rows of reference pixels, with at least yIOGrid rows.
+            size_t bytesPerRefPxl = (nStatsPixelsInRefPxl * sizeof(float)) + (numOutImgBands * sizeof(double));
+            long stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max<int>(yIOGrid, 1), refPxlWidth, refPxlHeight, bytesPerRefPxl, this->stripMemoryMB);
+            stripRows = std::max<long>(std::min<long>(stripRows, refPxlHeight), 1);
             
-            float *statsPxlsInRefPxl = new float[nStatsPixelsInRefPxl];
-            double *outImgBandVals = new double[numOutImgBands];
+            std::vector<float> statsDataArr(((size_t)statsPxlWidth) * (stripRows * nYPxls));
+            std::vector<std::vector<double> > refDataArrOuts(numOutImgBands, std::vector<double>(((size_t)refPxlWidth) * stripRows));
+            std::vector<GDALRasterBand*> outBands(numOutImgBands);
+            for(int i = 0; i < numOutImgBands; ++i)
+            {
+                outBands[i] = outputImageDS->GetRasterBand(i+1);
+                if(setOutNames && (bandNames != NULL))
+                {
+                    outBands[i]->SetDescription(bandNames[i].c_str());
+                }
+            }
             
-            // Sort out stats for user feedback
-            long nBlocks = nXBlocks * nYBlocks;
-            if(remainCols > 0)
+            // One calc object and buffer per thread; threadCalcs[0] is this->valueCalcSum.
+            unsigned int nThreads = this->numThreads;
+            if(nThreads == 0)
             {
-                nBlocks += nYBlocks;
+                nThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
             }
-            if(remainRows > 0)
+            threadCalcs.push_back(this->valueCalcSum);
+            for(unsigned int i = 1; i < nThreads; ++i)
             {
-                nBlocks += nXBlocks;
-                if(remainCols > 0)
+                RSGISCalcValuesFromMultiResInputs *threadCalc = this->valueCalcSum->clone();
+                if(threadCalc == NULL)
                 {
-                    nBlocks += 1;
+                    // Not thread safe so use the serial code path.
+                    break;
                 }
+                threadCalcs.push_back(threadCalc);
             }
+            nThreads = threadCalcs.size();
+            std::vector<std::vector<float> > threadStatsPxls(nThreads, std::vector<float>(nStatsPixelsInRefPxl));
+            std::vector<std::vector<double> > threadOutVals(nThreads, std::vector<double>(numOutImgBands));
+            rsgis::RSGISThreadPool threadPool(nThreads);
             
-            int rowOffsetRef = 0;
-            int colOffsetRef = 0;
-            int rowOffsetStats = 0;
-            int colOffsetStats = 0;
-            
-            int ib_rowOffStats = 0;
-            int ib_colOffStats = 0;
-            
-            long blockCounter = 0;
-            rsgis_tqdm pbar;
-            for(long i = 0; i < nYBlocks; i++)
+            // Summarise the reference pixels [cStart, cEnd) of the current strip.
+            auto processPxls = [&](unsigned int t, size_t cStart, size_t cEnd)
             {
-                colOffsetStats = 0;
-                colOffsetRef = 0;
-                for(long j = 0; j < nXBlocks; j++)
+                float *statsPxlsInRefPxl = threadStatsPxls[t].data();
+                double *outImgBandVals = threadOutVals[t].data();
+                for(size_t c = cStart; c < cEnd; ++c)
                 {
-                    pbar.progress(blockCounter, nBlocks);
-                    
-                    // Read Block
-                    if(statsBand->RasterIO(GF_Read, colOffsetStats, rowOffsetStats, xIOGridStats, yIOGridStats, statsDataArr, xIOGridStats, yIOGridStats, GDT_Float32, 0, 0))
-                    {
-                        throw RSGISImageException("Failed to read image data from stats band.");
-                    }
-                    
-                    // Process Block
-                    ib_rowOffStats = 0;
-                    ib_colOffStats = 0;
-                    for(int n = 0; n < yIOGrid; ++n)
+                    size_t row = c / refPxlWidth;
+                    size_t col = c - (row * refPxlWidth);
+                    const float *cellData = statsDataArr.data() + (row * nYPxls * statsPxlWidth) + (col * nXPxls);
+                    for(long k = 0; k < nStatsPixelsInRefPxl; ++k)
                     {
-                        ib_colOffStats = 0;
-                        for(int m = 0; m < xIOGrid; ++m)
-                        {
-                            for(int y = 0; y < nYPxls; ++y)
-                            {
-                                for(int x = 0; x < nXPxls; ++x)
-                                {
-                                    statsPxlsInRefPxl[(y*nYPxls)+x] = statsDataArr[(ib_colOffStats+x)+(ib_rowOffStats+(yIOGridStats*y))];
-                                }
-                            }
-                            
-                            valueCalcSum->calcImageValue(statsPxlsInRefPxl, nStatsPixelsInRefPxl, useNoDataVal, noDataVal, outImgBandVals);
-                            for(unsigned int b = 0; b < numOutImgBands; ++b)
-                            {
-                                refDataArrOuts[b][((n*xIOGrid)+m)] = outImgBandVals[b];
-                            }
-                            ib_colOffStats += nXPxls;
-                        }
-                        ib_rowOffStats += (nYPxls * (xIOGrid * nXPxls));
+                        statsPxlsInRefPxl[k] = cellData[cellPxlIdxs[k]];
                     }
                     
-                    // Write Block
-                    for(unsigned int n = 0; n < numOutImgBands; ++n)
+                    threadCalcs[t]->calcImageValue(statsPxlsInRefPxl, nStatsPixelsInRefPxl, useNoDataVal, noDataVal, outImgBandVals);
+                    for(int b = 0; b < numOutImgBands; ++b)
                     {
-                        if(outBands[n]->RasterIO(GF_Write, colOffsetRef, rowOffsetRef, xIOGrid, yIOGrid, refDataArrOuts[n], xIOGrid, yIOGrid, GDT_Float64, 0, 0))
-                        {
-                            throw RSGISImageException("Failed to write image data to output image.");
-                        }
+                        refDataArrOuts[b][c] = outImgBandVals[b];
                     }
-                    
-                    ++blockCounter;
-                    colOffsetStats += xIOGridStats;
-                    colOffsetRef += xIOGrid;
                 }
-                
-                if(remainCols > 0)
-                {
-                    pbar.progress(blockCounter, nBlocks);
-                    
-                    // Read Block
-                    if(statsBand->RasterIO(GF_Read, colOffsetStats, rowOffsetStats, remainColsStats, yIOGridStats, statsDataArr, remainColsStats, yIOGridStats, GDT_Float32, 0, 0))
-                    {
-                        throw RSGISImageException("Failed to read image data from stats band.");
-                    }
-                    
-                    // Process Block
-                    ib_rowOffStats = 0;
-                    ib_colOffStats = 0;
-                    for(int n = 0; n < yIOGrid; ++n)
-                    {
-                        ib_colOffStats = 0;
-                        for(int m = 0; m < remainCols; ++m)
-                        {
-                            for(int y = 0; y < nYPxls; ++y)
-                            {
-                                for(int x = 0; x < nXPxls; ++x)
-                                {
-                                    statsPxlsInRefPxl[(y*nYPxls)+x] = statsDataArr[(ib_colOffStats+x)+(ib_rowOffStats+(yIOGridStats*y))];
-                                }
-                            }
-                            
-                            valueCalcSum->calcImageValue(statsPxlsInRefPxl, nStatsPixelsInRefPxl, useNoDataVal, noDataVal, outImgBandVals);
-                            for(unsigned int b = 0; b < numOutImgBands; ++b)
-                            {
-                                refDataArrOuts[b][((n*remainCols)+m)] = outImgBandVals[b];
-                            }
-                            ib_colOffStats += nXPxls;
-                        }
-                        ib_rowOffStats += (nYPxls * (remainCols * nXPxls));
-                    }
-                    
-                    // Write Block
-                    for(unsigned int n = 0; n < numOutImgBands; ++n)
-                    {
-                        if(outBands[n]->RasterIO(GF_Write, colOffsetRef, rowOffsetRef, remainCols, yIOGrid, refDataArrOuts[n], remainCols, yIOGrid, GDT_Float64, 0, 0))
-                        {
-                            throw RSGISImageException("Failed to write image data to output image.");
-                        }
-                    }
-                    
-                    ++blockCounter;
-                    colOffsetStats += remainColsStats;
-                    colOffsetRef += remainCols;
-                }
-                
-                rowOffsetStats += yIOGridStats;
-                rowOffsetRef += yIOGrid;
-            }
+            };
             
-            if(remainRows > 0)
+            rsgis_tqdm pbar;
+            for(long rowOffsetRef = 0; rowOffsetRef < refPxlHeight; rowOffsetRef += stripRows)
             {
-                colOffsetStats = 0;
-                colOffsetRef = 0;
-                for(long j = 0; j < nXBlocks; j++)
+                pbar.progress(rowOffsetRef, refPxlHeight);
+                long nRows = std::min<long>(stripRows, refPxlHeight - rowOffsetRef);
+                
+                // Read Strip
+                if(statsBand->RasterIO(GF_Read, statsXOff, statsYOff + (rowOffsetRef * nYPxls), statsPxlWidth, nRows * nYPxls, statsDataArr.data(), statsPxlWidth, nRows * nYPxls, GDT_Float32, 0, 0) != CE_None)
                 {
-                    pbar.progress(blockCounter, nBlocks);
-                    
-                    // Read Block
-                    if(statsBand->RasterIO(GF_Read, colOffsetStats, rowOffsetStats, xIOGridStats, remainRowsStats, statsDataArr, xIOGridStats, remainRowsStats, GDT_Float32, 0, 0))
-                    {
-                        throw RSGISImageException("Failed to read image data from stats band.");
-                    }
-                    
-                    // Process Block
-                    ib_rowOffStats = 0;
-                    ib_colOffStats = 0;
-                    for(int n = 0; n < remainRows; ++n)
-                    {
-                        ib_colOffStats = 0;
-                        for(int m = 0; m < xIOGrid; ++m)
-                        {
-                            for(int y = 0; y < nYPxls; ++y)
-                            {
-                                for(int x = 0; x < nXPxls; ++x)
-                                {
-                                    statsPxlsInRefPxl[(y*nYPxls)+x] = statsDataArr[(ib_colOffStats+x)+(ib_rowOffStats+((remainRows*nYPxls)*y))];
-                                }
-                            }
-                            
-                            valueCalcSum->calcImageValue(statsPxlsInRefPxl, nStatsPixelsInRefPxl, useNoDataVal, noDataVal, outImgBandVals);
-                            for(unsigned int b = 0; b < numOutImgBands; ++b)
-                            {
-                                refDataArrOuts[b][((n*xIOGrid)+m)] = outImgBandVals[b];
-                            }
-                            ib_colOffStats += nXPxls;
-                        }
-                        ib_rowOffStats += (nYPxls * (xIOGrid * nXPxls));
-                    }
-                    
-                    // Write Block
-                    for(unsigned int n = 0; n < numOutImgBands; ++n)
-                    {
-                        if(outBands[n]->RasterIO(GF_Write, colOffsetRef, rowOffsetRef, xIOGrid, remainRows, refDataArrOuts[n], xIOGrid, remainRows, GDT_Float64, 0, 0))
-                        {
-                            throw RSGISImageException("Failed to write image data to output image.");
-                        }
-                    }
-                    
-                    ++blockCounter;
-                    colOffsetStats += xIOGridStats;
-                    colOffsetRef += xIOGrid;
+                    throw RSGISImageException("Failed to read image data from stats band.");
                 }
                 
-                if(remainCols > 0)
+                // Process Strip
+                threadPool.parallelFor(0, ((size_t)nRows) * refPxlWidth, processPxls);
+                
+                // Write Strip
+                for(int n = 0; n < numOutImgBands; ++n)
                 {
-                    pbar.progress(blockCounter, nBlocks);
-                    
-                    // Read Block
-                    if(statsBand->RasterIO(GF_Read, colOffsetStats, rowOffsetStats, remainColsStats, remainRowsStats, statsDataArr, remainColsStats, remainRowsStats, GDT_Float32, 0, 0))
+                    if(outBands[n]->RasterIO(GF_Write, 0, rowOffsetRef, refPxlWidth, nRows, refDataArrOuts[n].data(), refPxlWidth, nRows, GDT_Float64, 0, 0) != CE_None)
                     {
-                        throw RSGISImageException("Failed to read image data from stats band.");
+                        throw RSGISImageException("Failed to write image data to output image.");
                     }
-                    
-                    // Process Block
-                    ib_rowOffStats = 0;
-                    ib_colOffStats = 0;
-                    for(int n = 0; n < remainRows; ++n)
-                    {
-                        ib_colOffStats = 0;
-                        for(int m = 0; m < remainCols; ++m)
-                        {
-                            for(int y = 0; y < nYPxls; ++y)
-                            {
-                                for(int x = 0; x < nXPxls; ++x)
-                                {
-                                    statsPxlsInRefPxl[(y*nYPxls)+x] = statsDataArr[(ib_colOffStats+x)+(ib_rowOffStats+((remainRows*nYPxls)*y))];
-                                }
-                            }
-                            
-                            valueCalcSum->calcImageValue(statsPxlsInRefPxl, nStatsPixelsInRefPxl, useNoDataVal, noDataVal, outImgBandVals);
-                            for(unsigned int b = 0; b < numOutImgBands; ++b)
-                            {
-                                refDataArrOuts[b][((n*remainCols)+m)] = outImgBandVals[b];
-                            }
-                            ib_colOffStats += nXPxls;
-                        }
-                        ib_rowOffStats += (nYPxls * (remainCols * nXPxls));
-                    }
-                    
-                    // Write Block
-                    for(unsigned int n = 0; n < numOutImgBands; ++n)
-                    {
-                        if(outBands[n]->RasterIO(GF_Write, colOffsetRef, rowOffsetRef, remainCols, remainRows, refDataArrOuts[n], remainCols, remainRows, GDT_Float64, 0, 0))
-                        {
-                            throw RSGISImageException("Failed to write image data to output image.");
-                        }
-                    }
-                    
-                    ++blockCounter;
-                    colOffsetStats += remainColsStats;
-                    colOffsetRef += remainCols;
                 }
-                rowOffsetStats += remainRowsStats;
-                rowOffsetRef += remainRows;
             }
             pbar.finish();
             
-            GDALClose(outputImageDS);
-            
-            for(unsigned int i = 0; i < numOutImgBands; ++i)
+            for(size_t i = 1; i < threadCalcs.size(); ++i)
             {
-                delete[] refDataArrOuts[i];
+                delete threadCalcs[i];
             }
-            delete[] refDataArrOuts;
-            delete[] outBands;
-            delete[] statsDataArr;
-            delete[] statsPxlsInRefPxl;
-            delete[] outImgBandVals;
+            threadCalcs.clear();
+            
+            GDALClose(outputImageDS);
             
             delete[] refImgTrans;
             delete[] statsImgTrans;
@@ -15002,14 +15496,26 @@ namespace rsgis{namespace img{
         }
         catch (RSGISImageException &e)
         {
+            for(size_t i = 1; i < threadCalcs.size(); ++i)
+            {
+                delete threadCalcs[i];
+            }
             throw e;
         }
         catch (RSGISException &e)
         {
+            for(size_t i = 1; i < threadCalcs.size(); ++i)
+            {
+                delete threadCalcs[i];
+            }
             throw RSGISImageException(e.what());
         }
         catch (std::exception &e)
         {
+            for(size_t i = 1; i < threadCalcs.size(); ++i)
+            {
+                delete threadCalcs[i];
+            }
             throw RSGISImageException(e.what());
         }
     }
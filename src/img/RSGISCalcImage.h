@@ -25,15 +25,26 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <memory>
 
 #include "gdal_priv.h"
 
 #include "common/rsgis-tqdm.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISStripIOPipeline.h"
+#include "common/RSGISCalcImageProfiler.h"
+#include "common/RSGISExecutionContext.h"
 
 #include "img/RSGISPixelInPoly.h"
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
+#include "img/RSGISCalcImageCheckpoint.h"
 #include "img/RSGISImageUtils.h"
+#include "img/RSGISRemoteReadPlanner.h"
+#include "img/RSGISCOGWriter.h"
 
 #include "math/RSGISMathsUtils.h"
 
@@ -87,12 +98,139 @@ namespace rsgis
                 void calcImageWithinPolygonExtentInMem(GDALDataset **datasets, int numDS, OGREnvelope *env, OGRPolygon *poly, pixelInPolyOption pixelPolyOption);
 				void calcImageWithinRasterPolygon(GDALDataset **datasets, int numDS, OGREnvelope *env, long fid);
                 void calcImageBorderPixels(GDALDataset *dataset, bool returnInt);
+                /**
+                 * Process arrays already in memory (e.g., numpy arrays) rather than images.
+                 * bands holds numBands arrays of nPxls values and output holds the
+                 * getNumOutBands() arrays of nPxls values the result is written to, which
+                 * can be NULL if the calc object has no outputs (e.g., statistics). The
+                 * arrays are used in place (i.e., not copied) and the pixels are split
+                 * between the threads (see setNumThreads).
+                 */
+                void calcImageArrays(const float* const* bands, int numBands, size_t nPxls, double **output=NULL);
+                /**
+                 * As calcImageArrays but for windows of windowSize x windowSize pixels within
+                 * arrays of width x height pixels (row-major), with the pixels outside of
+                 * the arrays being 0 as for calcImageWindowData. Windows within the arrays
+                 * are passed to the calc object as views of the input arrays.
+                 */
+                void calcImageWindowArrays(const float* const* bands, int numBands, size_t width, size_t height, int windowSize, double **output);
+                /**
+                 * Set the number of threads used to process each strip of the image
+                 * (default from rsgis::RSGISExecutionContextUtils::getDefaultContext(),
+                 * i.e., 1; 0 uses all the hardware threads). Multiple threads are only
+                 * used if the RSGISCalcImageValue implements clone(), otherwise the
+                 * serial code path is used. Unless I/O buffers are used (see
+                 * setNumIOBuffers) the image data are read and written on the calling thread.
+                 */
+                void setNumThreads(unsigned int numThreads){this->numThreads = numThreads;};
+                unsigned int getNumThreads(){return this->numThreads;};
+                /**
+                 * Set the number of strip buffers used when creating an output image with
+                 * calcImage(datasets, numDS, outputImage, ...). With 2 or more buffers the
+                 * strips are read and written on separate I/O threads so the I/O overlaps
+                 * with the processing (see rsgis::RSGISStripIOPipeline). The default is
+                 * rsgis::RSGISStripIOPipeline::getDefaultNumBuffers() (i.e., 1; serial I/O).
+                 */
+                void setNumIOBuffers(unsigned int numIOBuffers){this->numIOBuffers = numIOBuffers;};
+                unsigned int getNumIOBuffers(){return this->numIOBuffers;};
+                /**
+                 * Set the target memory (MB) of the buffers for each strip of the image,
+                 * so the strips are a multiple of the image block height of as many rows
+                 * as fit within the memory (see RSGISExecutionContextUtils::calcStripRows).
+                 * With 0 (the default unless set in the default execution context) each
+                 * strip is the block height of the images.
+                 */
+                void setStripMemory(unsigned int stripMemoryMB){this->stripMemoryMB = stripMemoryMB;};
+                unsigned int getStripMemory(){return this->stripMemoryMB;};
+                /**
+                 * Checkpoint the output image of calcImage(datasets, numDS, outputImage, ...)
+                 * every checkpointSecs seconds (0, the default unless set in the default
+                 * execution context, is no checkpoints). The output is flushed and the rows
+                 * written are recorded in a sidecar file (see RSGISCalcImageCheckpoint). If
+                 * the same output is then created from the same inputs (e.g., after the
+                 * process was stopped) the existing image is updated from the last
+                 * checkpoint rather than starting again. The sidecar file is removed once
+                 * the image is complete. Only use with calc objects where the output of
+                 * each pixel depends only on its input values.
+                 */
+                void setCheckpointing(unsigned int checkpointSecs){this->checkpointSecs = checkpointSecs;};
+                unsigned int getCheckpointing(){return this->checkpointSecs;};
+                /**
+                 * Set the maximum number of concurrent requests used to read each strip of
+                 * the input images on GDAL network file systems (e.g., /vsis3/) within
+                 * calcImage(datasets, numDS, outputImage, ...) and calcImage(datasets, numDS)
+                 * (see RSGISRemoteReadPlanner). With 0 remote images are read in the same way
+                 * as local images. The default is from the default execution context (4).
+                 */
+                void setRemoteMaxRequests(unsigned int remoteMaxRequests){this->remoteMaxRequests = remoteMaxRequests;};
+                unsigned int getRemoteMaxRequests(){return this->remoteMaxRequests;};
+                /**
+                 * Process the image as 2D tiles aligned to the block grid of the first input
+                 * image (or tiles of tileXSize x tileYSize pixels where not 0) rather than
+                 * strips of whole rows. Used by calcImage(datasets, numDS, outputImage, ...)
+                 * and calcImageWindowData(datasets, numDS, outputImage, windowSize, ...), where
+                 * each tile is read with a halo of the window size. The tiles of each row of
+                 * tiles are processed independently by the threads (see setNumThreads). The
+                 * I/O buffers (see setNumIOBuffers) are not used when processing tiles.
+                 */
+                void setTileProcessing(bool useTiles, unsigned int tileXSize=0, unsigned int tileYSize=0){this->useTileProcessing = useTiles; this->tileXSize = tileXSize; this->tileYSize = tileYSize;};
+                /**
+                 * Preview the outputs of calcImage(datasets, numDS, outputImage, ...),
+                 * calcImage(datasets, numIntDS, numFloatDS, outputImage, ...) and
+                 * calcImage(datasets, numDS) at a resolution previewFactor times coarser
+                 * than the inputs (e.g., for tuning thresholds), using the same calc object.
+                 * Each output pixel is calculated from the input values of the centre of the
+                 * previewFactor x previewFactor input pixels it covers, which GDAL reads from
+                 * the band overview closest to the preview resolution where the inputs have
+                 * overviews (i.e., a factor of 2^n uses overview level n-1 of a standard
+                 * pyramid). The output has the geotransform of the preview resolution and
+                 * the same origin as the inputs. Tiles (see setTileProcessing) and remote
+                 * read requests (see setRemoteMaxRequests) are not used in preview mode.
+                 * The default is from the default execution context (0; full resolution).
+                 */
+                void setPreview(unsigned int previewFactor){this->previewFactor = previewFactor;};
+                unsigned int getPreview(){return this->previewFactor;};
                 virtual ~RSGISCalcImage();
 			private:
+                std::vector<RSGISCalcImageValue*> createThreadCalcs();
+                void reduceThreadCalcs(std::vector<RSGISCalcImageValue*> &threadCalcs);
+                void deleteThreadCalcs(std::vector<RSGISCalcImageValue*> &threadCalcs);
+                void calcImageTiles(GDALDataset **datasets, int numDS, std::string outputImage, bool setOutNames, std::string *bandNames, std::string gdalFormat, GDALDataType gdalDataType, int windowSize);
+                /**
+                 * Pass nRows rows (from rowStart) of band-major data to the calc object with their
+                 * locations, using calcImageBlockAtPxls, calcImageValueAtPxl or otherwise an
+                 * OGREnvelope per pixel which, if pxlIdxExtent, holds the pixel column and row
+                 * rather than the pixel extent. useBlockCoords and usePxlCoords are set to false
+                 * once the calc object has shown it does not implement the respective call.
+                 */
+                void calcRowsWithPxlCoords(float **inputData, int numInBands, float *inDataColumn, unsigned int width, unsigned int nRows, unsigned int rowStart, const double *transform, bool pxlIdxExtent, bool *useBlockCoords, bool *usePxlCoords);
+                /**
+                 * In preview mode (see setPreview) scale the overlap of the inputs, of width x
+                 * height pixels with the transform, to the preview resolution, with fullWidth
+                 * and fullHeight set to the size of the overlap at the input resolution.
+                 * Returns false, leaving the overlap unchanged, if not in preview mode.
+                 */
+                bool calcPreviewOverlap(int *width, int *height, double *transform, int *fullWidth, int *fullHeight);
+                /**
+                 * Read nRows rows (from row) of the overlap, of width pixels, from the band where
+                 * xOff and yOff are the offset of the overlap within the band. In preview mode
+                 * the rows are resampled from the input pixels they cover within the overlap of
+                 * fullWidth x fullHeight input pixels (see calcPreviewOverlap).
+                 */
+                CPLErr readRows(GDALRasterBand *band, int xOff, int yOff, int row, int nRows, int width, int fullWidth, int fullHeight, void *data, GDALDataType dataType);
 				RSGISCalcImageValue *calc;
 				int numOutBands;
 				std::string proj;
 				bool useImageProj;
+                unsigned int numThreads;
+                unsigned int numIOBuffers;
+                unsigned int stripMemoryMB;
+                unsigned int checkpointSecs;
+                unsigned int remoteMaxRequests;
+                unsigned int previewFactor;
+                bool useTileProcessing;
+                unsigned int tileXSize;
+                unsigned int tileYSize;
 			};
         
         
@@ -100,10 +238,22 @@ namespace rsgis
         {
         public:
             RSGISCalcImageMultiImgRes(RSGISCalcValuesFromMultiResInputs *valueCalcSum);
+            /** Set the number of threads used to summarise each strip (0 uses the number of hardware threads). */
+            void setNumThreads(unsigned int numThreads){this->numThreads = numThreads;};
+            /**
+             * Summarise the pixels of the stats image within each pixel of the reference
+             * image. The stats image is read in strips of whole rows of reference pixels
+             * (at least yIOGrid rows, and more up to the stripMemoryMB of the execution
+             * context) and the reference pixels of a strip are summarised in parallel
+             * if valueCalcSum can be cloned. xIOGrid is no longer used as the strips
+             * are the width of the image.
+             */
             void calcImageHighResForLowRegions(GDALDataset *refDataset, GDALDataset *statsDataset, unsigned int statsImgBand, std::string outputImage, std::string gdalFormat="KEA", GDALDataType gdalDataType=GDT_Float32, bool useNoDataVal=true, unsigned int xIOGrid=16, unsigned int yIOGrid=16, bool setOutNames = false, std::string *bandNames = NULL);
             virtual ~RSGISCalcImageMultiImgRes();
         protected:
             RSGISCalcValuesFromMultiResInputs *valueCalcSum;
+            unsigned int numThreads;
+            unsigned int stripMemoryMB;
         };
         
         
@@ -0,0 +1,198 @@
+/*
+ *  RSGISCalcImageAffine.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISCalcImageAffine.h"
+
+#include "img/RSGISCalcImageT.h"
+
+#include "common/RSGISSIMDKernels.h"
+
+namespace rsgis{namespace img{
+
+    /**
+     * The RSGISCalcImageT kernel of RSGISCalcImageAffine. Each band of a block is
+     * transformed as a whole: a branch free pass for the scales, offsets and clamping
+     * (rsgis::RSGISSIMDKernels::affine), a pass for the no data values (only if they
+     * are used) and a pass converting to the output type.
+     */
+    template <typename InT, typename OutT> class RSGISCalcImageValueAffineT : public RSGISCalcImageValueT<InT, OutT>
+    {
+    public:
+        RSGISCalcImageValueAffineT(const RSGISAffineTransform &transform): RSGISCalcImageValueT<InT, OutT>(transform.bands.size())
+        {
+            this->transform = transform;
+        };
+        void calcImageBlock(const InT* const* bands, int numBands, size_t nPxls, OutT* const* output)
+        {
+            this->vals.resize(nPxls);
+            double *bandVals = this->vals.data();
+            for(int b = 0; b < this->numOutBands; ++b)
+            {
+                const RSGISAffineBandParams &params = this->transform.bands[b];
+                const InT *inBand = bands[b];
+                const double inMin = params.inMin;
+                const double inMax = params.inMax;
+                const double outHigh = params.outHigh;
+                // Other types are converted to double in the output values, which are then transformed in place.
+                const double *inVals = reinterpret_cast<const double*>(inBand);
+                if(!std::is_same<InT, double>::value)
+                {
+                    for(size_t i = 0; i < nPxls; ++i)
+                    {
+                        bandVals[i] = inBand[i];
+                    }
+                    inVals = bandVals;
+                }
+                rsgis::RSGISSIMDKernels::affine(inVals, nPxls, params.inOffset, params.inScale, params.outScale, params.outOffset, inMin, inMax, params.outLow, outHigh, bandVals);
+
+                // NaN inputs are already NaN outputs unless another value was given for them.
+                if(std::is_floating_point<InT>::value && (!std::isnan(params.nanVal)))
+                {
+                    for(size_t i = 0; i < nPxls; ++i)
+                    {
+                        if(std::isnan((double)inBand[i]))
+                        {
+                            bandVals[i] = params.nanVal;
+                        }
+                    }
+                }
+
+                if(this->transform.useNoData || this->transform.avoidOutNoData)
+                {
+                    const double outNoData = this->transform.outNoData;
+                    for(size_t i = 0; i < nPxls; ++i)
+                    {
+                        const double x = inBand[i];
+                        if(this->transform.useNoData && (x == this->transform.inNoData))
+                        {
+                            bandVals[i] = outNoData;
+                        }
+                        else if(this->transform.avoidOutNoData && (bandVals[i] == outNoData) && (x >= inMin) && (x <= inMax))
+                        {
+                            bandVals[i] = (outNoData == outHigh)?(outNoData - 1):(outNoData + 1);
+                        }
+                    }
+                }
+
+                OutT *outBand = output[b];
+                for(size_t i = 0; i < nPxls; ++i)
+                {
+                    outBand[i] = rsgisConvertPixelValue<OutT>(bandVals[i]);
+                }
+            }
+        };
+        RSGISCalcImageValueT<InT, OutT>* clone(){return new RSGISCalcImageValueAffineT<InT, OutT>(this->transform);};
+        ~RSGISCalcImageValueAffineT(){};
+    protected:
+        RSGISAffineTransform transform;
+        std::vector<double> vals;
+    };
+
+    bool RSGISCalcImageAffine::calcImage(const RSGISAffineTransform &transform, GDALDataset **datasets, int numDS, std::string outputImage, bool setOutNames, std::string *bandNames, std::string gdalFormat, GDALDataType outDataType, unsigned int numThreads)
+    {
+        GDALDataType inDataType = GDT_Unknown;
+        size_t numInBands = 0;
+        for(int i = 0; i < numDS; ++i)
+        {
+            for(int j = 0; j < datasets[i]->GetRasterCount(); ++j)
+            {
+                GDALDataType bandDataType = datasets[i]->GetRasterBand(j+1)->GetRasterDataType();
+                if((bandDataType != GDT_Byte) && (bandDataType != GDT_UInt16) && (bandDataType != GDT_Int16) && (bandDataType != GDT_UInt32) && (bandDataType != GDT_Int32) && (bandDataType != GDT_Float32) && (bandDataType != GDT_Float64))
+                {
+                    return false;
+                }
+                if((numInBands > 0) && (bandDataType != inDataType))
+                {
+                    // Any of the supported types can be read exactly as double.
+                    bandDataType = GDT_Float64;
+                }
+                inDataType = bandDataType;
+                ++numInBands;
+            }
+        }
+        if(transform.bands.size() != numInBands)
+        {
+            throw RSGISImageCalcException("A transform is needed for each of the input image bands.");
+        }
+
+        switch(inDataType)
+        {
+            case GDT_Byte:
+                return calcImageInT<uint8_t>(transform, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, outDataType, numThreads);
+            case GDT_UInt16:
+                return calcImageInT<uint16_t>(transform, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, outDataType, numThreads);
+            case GDT_Int16:
+                return calcImageInT<int16_t>(transform, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, outDataType, numThreads);
+            case GDT_UInt32:
+                return calcImageInT<uint32_t>(transform, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, outDataType, numThreads);
+            case GDT_Int32:
+                return calcImageInT<int32_t>(transform, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, outDataType, numThreads);
+            case GDT_Float32:
+                return calcImageInT<float>(transform, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, outDataType, numThreads);
+            case GDT_Float64:
+                return calcImageInT<double>(transform, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, outDataType, numThreads);
+            default:
+                return false;
+        }
+    }
+
+    template <typename InT> bool RSGISCalcImageAffine::calcImageInT(const RSGISAffineTransform &transform, GDALDataset **datasets, int numDS, std::string outputImage, bool setOutNames, std::string *bandNames, std::string gdalFormat, GDALDataType outDataType, unsigned int numThreads)
+    {
+        switch(outDataType)
+        {
+            case GDT_Byte:
+                calcImageT<InT, uint8_t>(transform, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, numThreads);
+                break;
+            case GDT_UInt16:
+                calcImageT<InT, uint16_t>(transform, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, numThreads);
+                break;
+            case GDT_Int16:
+                calcImageT<InT, int16_t>(transform, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, numThreads);
+                break;
+            case GDT_UInt32:
+                calcImageT<InT, uint32_t>(transform, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, numThreads);
+                break;
+            case GDT_Int32:
+                calcImageT<InT, int32_t>(transform, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, numThreads);
+                break;
+            case GDT_Float32:
+                calcImageT<InT, float>(transform, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, numThreads);
+                break;
+            case GDT_Float64:
+                calcImageT<InT, double>(transform, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, numThreads);
+                break;
+            default:
+                return false;
+        }
+        return true;
+    }
+
+    template <typename InT, typename OutT> void RSGISCalcImageAffine::calcImageT(const RSGISAffineTransform &transform, GDALDataset **datasets, int numDS, std::string outputImage, bool setOutNames, std::string *bandNames, std::string gdalFormat, unsigned int numThreads)
+    {
+        RSGISCalcImageValueAffineT<InT, OutT> affineCalc = RSGISCalcImageValueAffineT<InT, OutT>(transform);
+        RSGISCalcImageT<InT, OutT> calcImg = RSGISCalcImageT<InT, OutT>(&affineCalc);
+        calcImg.setNumThreads(numThreads);
+        calcImg.calcImage(datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat);
+    }
+
+}}
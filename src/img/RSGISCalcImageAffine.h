@@ -0,0 +1,135 @@
+/*
+ *  RSGISCalcImageAffine.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISCalcImageAffine_H
+#define RSGISCalcImageAffine_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <limits>
+
+#include "gdal_priv.h"
+
+#include "img/RSGISImageCalcException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+
+    /**
+     * The transform of a band: values within [inMin, inMax] are
+     * (((x - inOffset) / inScale) * outScale) + outOffset, values below inMin are
+     * outLow and values above inMax are outHigh. NaN input values are output as
+     * nanVal. The scales are not combined into a single gain so the values are the
+     * same as those of the per pixel calculations (e.g., the maximum of a linear
+     * stretch is exactly the output maximum).
+     */
+    struct DllExport RSGISAffineBandParams
+    {
+        double inOffset;
+        double inScale;
+        double outScale;
+        double outOffset;
+        double inMin;
+        double inMax;
+        double outLow;
+        double outHigh;
+        double nanVal;
+        /** An unclamped transform of all the input values. */
+        RSGISAffineBandParams(double inOffset=0.0, double inScale=1.0, double outScale=1.0, double outOffset=0.0)
+        {
+            this->inOffset = inOffset;
+            this->inScale = inScale;
+            this->outScale = outScale;
+            this->outOffset = outOffset;
+            this->inMin = -std::numeric_limits<double>::infinity();
+            this->inMax = std::numeric_limits<double>::infinity();
+            this->outLow = -std::numeric_limits<double>::infinity();
+            this->outHigh = std::numeric_limits<double>::infinity();
+            this->nanVal = std::numeric_limits<double>::quiet_NaN();
+        };
+    };
+
+    /**
+     * A per-band affine transform of an image, where output band b is a transform of
+     * input band b. If useNoData is true, input values of inNoData are output as
+     * outNoData. If avoidOutNoData is true a transformed value (within the input
+     * range) equal to outNoData is moved by 1 away from outHigh (as the linear
+     * stretches do), so the no data value is only given to the no data pixels.
+     */
+    struct DllExport RSGISAffineTransform
+    {
+        std::vector<RSGISAffineBandParams> bands;
+        bool useNoData;
+        double inNoData;
+        double outNoData;
+        bool avoidOutNoData;
+        RSGISAffineTransform()
+        {
+            this->useNoData = false;
+            this->inNoData = 0.0;
+            this->outNoData = 0.0;
+            this->avoidOutNoData = false;
+        };
+    };
+
+    /**
+     * Applies a RSGISAffineTransform to an image with RSGISCalcImageT, so the bands
+     * are read and written with their native data types (e.g., uint16 to uint8) rather
+     * than converted to float and double, and the blocks are split between the threads.
+     * The transforms are applied to whole blocks of each band in loops the compiler
+     * can vectorise. As with GDAL, integer outputs are rounded and saturated
+     * to the range of the output type.
+     */
+    class DllExport RSGISCalcImageAffine
+    {
+    public:
+        /**
+         * Create the output image, returning false without processing the image if the
+         * input or output data types are not supported, in which case RSGISCalcImage
+         * should be used instead. There must be a band transform for each input band;
+         * if the input bands have different data types they are read as double. If
+         * numThreads is 0 all the available cores are used.
+         */
+        static bool calcImage(const RSGISAffineTransform &transform, GDALDataset **datasets, int numDS, std::string outputImage, bool setOutNames=false, std::string *bandNames=NULL, std::string gdalFormat="KEA", GDALDataType outDataType=GDT_Float32, unsigned int numThreads=1);
+    protected:
+        template <typename InT> static bool calcImageInT(const RSGISAffineTransform &transform, GDALDataset **datasets, int numDS, std::string outputImage, bool setOutNames, std::string *bandNames, std::string gdalFormat, GDALDataType outDataType, unsigned int numThreads);
+        template <typename InT, typename OutT> static void calcImageT(const RSGISAffineTransform &transform, GDALDataset **datasets, int numDS, std::string outputImage, bool setOutNames, std::string *bandNames, std::string gdalFormat, unsigned int numThreads);
+    };
+
+}}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ *  RSGISCalcImageCheckpoint.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#include "RSGISCalcImageCheckpoint.h"
+
+namespace rsgis{namespace img{
+
+    bool RSGISCalcImageCheckpoint::readCheckpoint(std::string checkpointFile, RSGISCalcImageCheckpointInfo *info)
+    {
+        std::ifstream chkptFile(checkpointFile.c_str());
+        if(!chkptFile.is_open())
+        {
+            return false;
+        }
+        std::string header;
+        std::string inputs;
+        if(!std::getline(chkptFile, header) || (header != "RSGISCalcImageCheckpoint 1") || !std::getline(chkptFile, inputs))
+        {
+            return false;
+        }
+        RSGISCalcImageCheckpointInfo chkpt;
+        chkpt.inputs = inputs;
+        if(!(chkptFile >> chkpt.width >> chkpt.height >> chkpt.numBands >> chkpt.completedRows))
+        {
+            return false;
+        }
+        *info = chkpt;
+        return true;
+    }
+
+    bool RSGISCalcImageCheckpoint::writeCheckpoint(std::string checkpointFile, const RSGISCalcImageCheckpointInfo &info)
+    {
+        std::string tmpFile = checkpointFile + ".tmp";
+        {
+            std::ofstream chkptFile(tmpFile.c_str(), std::ios::out | std::ios::trunc);
+            if(!chkptFile.is_open())
+            {
+                return false;
+            }
+            chkptFile << "RSGISCalcImageCheckpoint 1\n";
+            chkptFile << info.inputs << "\n";
+            chkptFile << info.width << " " << info.height << " " << info.numBands << " " << info.completedRows << "\n";
+            chkptFile.flush();
+            if(!chkptFile.good())
+            {
+                return false;
+            }
+        }
+        // rename does not replace an existing file on Windows.
+        std::remove(checkpointFile.c_str());
+        return (std::rename(tmpFile.c_str(), checkpointFile.c_str()) == 0);
+    }
+
+    void RSGISCalcImageCheckpoint::removeCheckpoint(std::string checkpointFile)
+    {
+        std::remove(checkpointFile.c_str());
+    }
+
+}}
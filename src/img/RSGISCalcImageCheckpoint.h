@@ -0,0 +1,79 @@
+/*
+ *  RSGISCalcImageCheckpoint.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifndef RSGISCalcImageCheckpoint_H
+#define RSGISCalcImageCheckpoint_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+
+    /** The progress of an output image recorded in its checkpoint (sidecar) file. */
+    struct DllExport RSGISCalcImageCheckpointInfo
+    {
+        /// The input images (and options) the output was created from.
+        std::string inputs;
+        unsigned int width;
+        unsigned int height;
+        unsigned int numBands;
+        /// The number of rows (from the top of the image) which have been written to the output image.
+        unsigned int completedRows;
+    };
+
+    /**
+     * Reads and writes the checkpoint file (outputImage + ".rsgischkpt") used by
+     * RSGISCalcImage to resume the creation of an output image. The file is written
+     * to a temporary file which is then renamed so a partly written checkpoint is
+     * never read.
+     */
+    class DllExport RSGISCalcImageCheckpoint
+    {
+    public:
+        static std::string getCheckpointFile(std::string outputImage){return outputImage + ".rsgischkpt";};
+        /** Returns false if the checkpoint file does not exist or cannot be read. */
+        static bool readCheckpoint(std::string checkpointFile, RSGISCalcImageCheckpointInfo *info);
+        /** Returns false if the checkpoint file could not be written. */
+        static bool writeCheckpoint(std::string checkpointFile, const RSGISCalcImageCheckpointInfo &info);
+        static void removeCheckpoint(std::string checkpointFile);
+    };
+
+}}
+
+#endif
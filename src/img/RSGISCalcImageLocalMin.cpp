@@ -128,5 +128,192 @@ namespace rsgis{namespace img{
         delete[] this->minVals;
         delete[] this->first;
     }
+
+    RSGISVirtualImageWindowMin::RSGISVirtualImageWindowMin(RSGISVirtualImageNode *input, std::vector<unsigned int> bands, int windowSize, float noDataValue, bool useNoDataValue) : RSGISVirtualImageNode()
+    {
+        if(input == NULL)
+        {
+            throw RSGISImageCalcException("A virtual image calculation needs an input.");
+        }
+        if(windowSize % 2 == 0)
+        {
+            throw RSGISImageCalcException("Window size needs to be an odd number (min = 3).");
+        }
+        else if(windowSize < 3)
+        {
+            throw RSGISImageCalcException("Window size needs to be 3 or greater and an odd number.");
+        }
+        if(bands.empty())
+        {
+            throw RSGISImageCalcException("At least one band is needed to find the minimum within the window.");
+        }
+        for(std::vector<unsigned int>::iterator iterBand = bands.begin(); iterBand != bands.end(); ++iterBand)
+        {
+            if(((*iterBand) == 0) || ((*iterBand) > ((unsigned int)input->getNumBands())))
+            {
+                throw RSGISImageCalcException("Requested band not in image");
+            }
+        }
+        this->input = input;
+        this->bands = bands;
+        this->windowSize = windowSize;
+        this->noDataValue = noDataValue;
+        this->useNoDataValue = useNoDataValue;
+        this->setGeometry(input);
+        this->numBands = 2;
+        
+        unsigned int numThreads = rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads;
+        this->threadPool = new RSGISThreadPool(numThreads);
+    }
+    
+    void RSGISVirtualImageWindowMin::readBlock(const RSGISVirtualImageBlock &block, float **bandData)
+    {
+        int windowMid = this->windowSize / 2;
+        RSGISVirtualImageBlock padBlock;
+        padBlock.xOff = block.xOff - windowMid;
+        padBlock.yOff = block.yOff - windowMid;
+        padBlock.xSize = block.xSize + (2 * windowMid);
+        padBlock.ySize = block.ySize + (2 * windowMid);
+        size_t padWidth = padBlock.xSize;
+        
+        int numInBands = this->input->getNumBands();
+        this->inVals.resize(numInBands);
+        std::vector<float*> inPtrs(numInBands);
+        for(int n = 0; n < numInBands; ++n)
+        {
+            this->inVals[n].resize(padWidth * padBlock.ySize);
+            inPtrs[n] = this->inVals[n].data();
+        }
+        this->input->readBlock(padBlock, inPtrs.data());
+        
+        // Each chunk of rows runs its own row and column passes over its rows plus the window halo, so the threads are independent.
+        this->threadPool->parallelFor(0, block.ySize, [&](unsigned int t, size_t rowStart, size_t rowEnd)
+        {
+            this->calcBlockRows(block, padWidth, rowStart, rowEnd, bandData);
+        });
+        this->zeroOutsideImage(block, bandData);
+    }
+    
+    void RSGISVirtualImageWindowMin::calcBlockRows(const RSGISVirtualImageBlock &block, size_t padWidth, size_t rowStart, size_t rowEnd, float **bandData)
+    {
+        size_t winSize = this->windowSize;
+        size_t winMid = winSize / 2;
+        size_t width = block.xSize;
+        size_t numRows = rowEnd - rowStart;
+        // The padded row of the block for output row y is y (the top of the window).
+        size_t numPadRows = numRows + winSize - 1;
+        
+        std::vector<unsigned char> pxlValid(padWidth);
+        std::vector<float> rowMinVals(numPadRows * width);
+        std::vector<unsigned char> rowMinValid(numPadRows * width);
+        std::vector<float> winMinVals(numRows * width);
+        std::vector<unsigned char> winMinValid(numRows * width);
+        std::vector<size_t> idxBuf(std::max(padWidth, numPadRows));
+        
+        float *outMinVals = bandData[0] + (rowStart * width);
+        float *outRefVals = bandData[1] + (rowStart * width);
+        for(size_t i = 0; i < (numRows * width); ++i)
+        {
+            outMinVals[i] = 0;
+            outRefVals[i] = 0;
+        }
+        
+        for(std::vector<unsigned int>::iterator iterBand = this->bands.begin(); iterBand != this->bands.end(); ++iterBand)
+        {
+            const float *bandVals = this->inVals[(*iterBand)-1].data();
+            for(size_t r = 0; r < numPadRows; ++r)
+            {
+                const float *rowVals = bandVals + ((rowStart + r) * padWidth);
+                for(size_t x = 0; x < padWidth; ++x)
+                {
+                    pxlValid[x] = !(this->useNoDataValue && (rowVals[x] == this->noDataValue));
+                }
+                slidingMin(rowVals, pxlValid.data(), 1, padWidth, winSize, rowMinVals.data() + (r * width), rowMinValid.data() + (r * width), 1, idxBuf.data());
+            }
+            for(size_t x = 0; x < width; ++x)
+            {
+                slidingMin(rowMinVals.data() + x, rowMinValid.data() + x, width, numPadRows, winSize, winMinVals.data() + x, winMinValid.data() + x, width, idxBuf.data());
+            }
+            
+            // The first band with the smallest minimum is kept.
+            for(size_t i = 0; i < (numRows * width); ++i)
+            {
+                if(winMinValid[i] && ((outRefVals[i] == 0) || (winMinVals[i] < outMinVals[i])))
+                {
+                    outMinVals[i] = winMinVals[i];
+                    outRefVals[i] = (*iterBand);
+                }
+            }
+        }
+        
+        if(this->useNoDataValue)
+        {
+            int numInBands = this->input->getNumBands();
+            for(size_t y = 0; y < numRows; ++y)
+            {
+                size_t padIdx = ((rowStart + y + winMid) * padWidth) + winMid;
+                for(size_t x = 0; x < width; ++x, ++padIdx)
+                {
+                    bool midPxlNoData = true;
+                    for(int n = 0; n < numInBands; ++n)
+                    {
+                        if(this->inVals[n][padIdx] != this->noDataValue)
+                        {
+                            midPxlNoData = false;
+                            break;
+                        }
+                    }
+                    if(midPxlNoData)
+                    {
+                        outMinVals[(y * width) + x] = 0;
+                        outRefVals[(y * width) + x] = 0;
+                    }
+                }
+            }
+        }
+    }
+    
+    void RSGISVirtualImageWindowMin::slidingMin(const float *vals, const unsigned char *valid, size_t inStride, size_t numVals, size_t winSize, float *minVals, unsigned char *minValid, size_t outStride, size_t *idxBuf)
+    {
+        // idxBuf holds the candidates of the current window in order of position and of increasing value.
+        size_t head = 0;
+        size_t tail = 0;
+        for(size_t i = 0; i < numVals; ++i)
+        {
+            if(valid[i * inStride])
+            {
+                float val = vals[i * inStride];
+                while((tail > head) && (vals[idxBuf[tail-1] * inStride] >= val))
+                {
+                    --tail;
+                }
+                idxBuf[tail++] = i;
+            }
+            if((i + 1) >= winSize)
+            {
+                size_t winStart = (i + 1) - winSize;
+                while((tail > head) && (idxBuf[head] < winStart))
+                {
+                    ++head;
+                }
+                size_t outIdx = winStart * outStride;
+                if(tail > head)
+                {
+                    minVals[outIdx] = vals[idxBuf[head] * inStride];
+                    minValid[outIdx] = 1;
+                }
+                else
+                {
+                    minVals[outIdx] = 0;
+                    minValid[outIdx] = 0;
+                }
+            }
+        }
+    }
+    
+    RSGISVirtualImageWindowMin::~RSGISVirtualImageWindowMin()
+    {
+        delete this->threadPool;
+    }
     
 }}
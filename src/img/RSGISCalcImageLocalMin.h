@@ -25,10 +25,15 @@
 
 #include <iostream>
 #include <cmath>
+#include <vector>
 #include <stdlib.h>
 
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
+
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
+#include "img/RSGISVirtualImage.h"
 
 
 // mark all exported classes/functions with DllExport to have
@@ -60,6 +65,41 @@ namespace rsgis{namespace img{
             bool *first;
         };
     
+        /**
+         * Gives the same result as RSGISCalcLocalMinInWin, as two bands: the minimum
+         * value within the window over the selected bands and the (1 based) band it
+         * came from (0 where there is no valid value or the central pixel is no data
+         * in all the bands). The window minimum of each band is separable, so it is
+         * calculated with a sliding minimum (a monotonic deque of the candidate
+         * pixels) along the rows followed by one down the columns, which takes a
+         * constant time per pixel whatever the window size. As with the window engines
+         * of RSGISCalcImage, the pixels outside the image are 0 (and valid). The rows
+         * of each block are split between the threads of the default execution context.
+         */
+        class DllExport RSGISVirtualImageWindowMin : public RSGISVirtualImageNode
+        {
+        public:
+            /** bands are the (1 based) bands of the input to find the minimum within. */
+            RSGISVirtualImageWindowMin(RSGISVirtualImageNode *input, std::vector<unsigned int> bands, int windowSize, float noDataValue, bool useNoDataValue);
+            void readBlock(const RSGISVirtualImageBlock &block, float **bandData);
+            ~RSGISVirtualImageWindowMin();
+        protected:
+            void calcBlockRows(const RSGISVirtualImageBlock &block, size_t padWidth, size_t rowStart, size_t rowEnd, float **bandData);
+            /**
+             * The minimum of each window of winSize values of vals (with a stride of
+             * inStride), where only the values flagged in valid are used. idxBuf needs
+             * space for numVals indexes.
+             */
+            static void slidingMin(const float *vals, const unsigned char *valid, size_t inStride, size_t numVals, size_t winSize, float *minVals, unsigned char *minValid, size_t outStride, size_t *idxBuf);
+            RSGISVirtualImageNode *input;
+            std::vector<unsigned int> bands;
+            int windowSize;
+            float noDataValue;
+            bool useNoDataValue;
+            RSGISThreadPool *threadPool;
+            std::vector< std::vector<float> > inVals;
+        };
+    
 }}
 
 #endif
@@ -21,6 +21,7 @@
  */
 
 #include "RSGISCalcImageMatrix.h"
+#include "common/RSGISGDALInit.h"
 
 namespace rsgis{namespace img{
 
@@ -31,7 +32,7 @@ namespace rsgis{namespace img{
 	
 	rsgis::math::Matrix* RSGISCalcImageMatrix::calcImageMatrix(GDALDataset **datasetsA, GDALDataset **datasetsB, int numDS)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		rsgis::math::RSGISMatrices matrixUtils;
 		RSGISCalcImageSingleValue *calcImageSingleValue = this->calcImage->getRSGISCalcImageSingleValue();
@@ -106,7 +107,7 @@ namespace rsgis{namespace img{
 	
 	rsgis::math::Matrix* RSGISCalcImageMatrix::calcImageVector(GDALDataset **datasetsA, int numDS)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		rsgis::math::RSGISMatrices matrixUtils;
 		RSGISCalcImageSingleValue *calcImageSingleValue = this->calcImage->getRSGISCalcImageSingleValue();
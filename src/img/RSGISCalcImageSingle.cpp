@@ -21,6 +21,7 @@
  */
 
 #include "RSGISCalcImageSingle.h"
+#include "common/RSGISGDALInit.h"
 
 namespace rsgis{namespace img{
 	
@@ -31,7 +32,7 @@ namespace rsgis{namespace img{
 	
 	void RSGISCalcImageSingle::calcImage(GDALDataset **datasetsA, GDALDataset **datasetsB, int numDS, double *outputValue, int bandA, int bandB)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = NULL;
 		
@@ -251,7 +252,7 @@ namespace rsgis{namespace img{
 	
 	void RSGISCalcImageSingle::calcImage(GDALDataset **datasetsA, int numDS, double *outputValue, int band)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = NULL;
 		
@@ -382,7 +383,7 @@ namespace rsgis{namespace img{
 	
 	void RSGISCalcImageSingle::calcImageWindow(GDALDataset **datasetsA, int numDS, double *outputValue)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = NULL;
 		
@@ -531,7 +532,7 @@ namespace rsgis{namespace img{
 	
 	void RSGISCalcImageSingle::calcImageWithinPolygon(GDALDataset **datasets, int numDS, double *outputValue, OGREnvelope *env, OGRPolygon *poly, bool output, pixelInPolyOption pixelPolyOption)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = NULL;
 
@@ -835,7 +836,7 @@ namespace rsgis{namespace img{
 	
 	void RSGISCalcImageSingle::calcImageWithinRasterPolygon(GDALDataset **datasets, int numDS, double *outputValue, OGREnvelope *env, long fid, bool output)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = NULL;
 		
@@ -0,0 +1,707 @@
+/*
+ *  RSGISCalcImageT.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  A version of RSGISCalcImage which reads and writes the image data with
+ *  the native (compile time) pixel types of the input and output images
+ *  rather than converting all the data to float and double. For example,
+ *  an 8 bit mask of a 16 bit image only needs 3 bytes per pixel rather than
+ *  12. The templates are defined in this header so the kernels are
+ *  instantiated for each pair of types they are used with.
+ *
+ */
+
+#ifndef RSGISCalcImageT_H
+#define RSGISCalcImageT_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+#include <memory>
+#include <stdint.h>
+
+#include "gdal_priv.h"
+
+#include "common/rsgis-tqdm.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISGDALInit.h"
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageBandException.h"
+#include "img/RSGISCalcImageValue.h"
+#include "img/RSGISImageUtils.h"
+
+namespace rsgis{namespace img{
+
+    /** The GDAL data type for a C++ pixel type. */
+    template <typename T> struct RSGISGDALDataTypeT;
+    template <> struct RSGISGDALDataTypeT<uint8_t>{static GDALDataType type(){return GDT_Byte;}};
+    template <> struct RSGISGDALDataTypeT<uint16_t>{static GDALDataType type(){return GDT_UInt16;}};
+    template <> struct RSGISGDALDataTypeT<int16_t>{static GDALDataType type(){return GDT_Int16;}};
+    template <> struct RSGISGDALDataTypeT<uint32_t>{static GDALDataType type(){return GDT_UInt32;}};
+    template <> struct RSGISGDALDataTypeT<int32_t>{static GDALDataType type(){return GDT_Int32;}};
+    template <> struct RSGISGDALDataTypeT<float>{static GDALDataType type(){return GDT_Float32;}};
+    template <> struct RSGISGDALDataTypeT<double>{static GDALDataType type(){return GDT_Float64;}};
+
+    /**
+     * Convert a value to the pixel type T. As with GDAL, integer outputs are
+     * rounded to the nearest integer and clamped to the range of the type,
+     * with NaN values output as 0.
+     */
+    template <typename T> inline T rsgisConvertPixelValue(double val)
+    {
+        if(std::is_integral<T>::value)
+        {
+            if(std::isnan(val))
+            {
+                return 0;
+            }
+            if(val <= ((double)std::numeric_limits<T>::min()))
+            {
+                return std::numeric_limits<T>::min();
+            }
+            if(val >= ((double)std::numeric_limits<T>::max()))
+            {
+                return std::numeric_limits<T>::max();
+            }
+            return (T)std::round(val);
+        }
+        return (T)val;
+    }
+
+    /** Returns true if val can be represented exactly by the pixel type T. */
+    template <typename T> inline bool rsgisPixelValueRepresentable(double val)
+    {
+        if(std::isnan(val))
+        {
+            return !std::is_integral<T>::value;
+        }
+        if((val < ((double)std::numeric_limits<T>::lowest())) || (val > ((double)std::numeric_limits<T>::max())))
+        {
+            return false;
+        }
+        return ((double)((T)val)) == val;
+    }
+
+    /**
+     * The per pixel (block) calculation for RSGISCalcImageT where the input
+     * and output data are of type InT and OutT. As with
+     * RSGISCalcImageValue::calcImageBlock the data are band-major, (i.e.,
+     * bands[b][p] and output[b][p] for pixel p of band b).
+     */
+    template <typename InT, typename OutT> class RSGISCalcImageValueT
+    {
+    public:
+        RSGISCalcImageValueT(int numberOutBands){this->numOutBands = numberOutBands;};
+        virtual void calcImageBlock(const InT* const* bands, int numBands, size_t nPxls, OutT* const* output) = 0;
+        /**
+         * Create an independent copy for use from another thread (see
+         * RSGISCalcImageValue::clone). The default returns NULL, in which
+         * case the image is processed on a single thread.
+         */
+        virtual RSGISCalcImageValueT<InT, OutT>* clone(){return NULL;};
+        /** Merge the state accumulated by a clone into this object. */
+        virtual void reduce(RSGISCalcImageValueT<InT, OutT> *other){};
+        int getNumOutBands(){return this->numOutBands;};
+        virtual ~RSGISCalcImageValueT(){};
+    protected:
+        int numOutBands;
+    };
+
+    /**
+     * Allows an existing RSGISCalcImageValue (float input and double output)
+     * to be used with RSGISCalcImageT. The block API of the wrapped object is
+     * used if it is implemented, otherwise calcImageValue(float *bandValues,
+     * int numBands, double *output) is called for each pixel.
+     */
+    template <typename InT, typename OutT> class RSGISCalcImageValueTAdapter : public RSGISCalcImageValueT<InT, OutT>
+    {
+    public:
+        RSGISCalcImageValueTAdapter(RSGISCalcImageValue *valueCalc, bool ownCalc=false): RSGISCalcImageValueT<InT, OutT>(valueCalc->getNumOutBands())
+        {
+            this->valueCalc = valueCalc;
+            this->ownCalc = ownCalc;
+        };
+        void calcImageBlock(const InT* const* bands, int numBands, size_t nPxls, OutT* const* output)
+        {
+            if(this->inData.size() != (((size_t)numBands)*nPxls))
+            {
+                this->inData.resize(((size_t)numBands)*nPxls);
+                this->outData.resize(((size_t)this->numOutBands)*nPxls);
+                this->inPtrs.resize(numBands);
+                this->outPtrs.resize(this->numOutBands);
+                for(int b = 0; b < numBands; ++b)
+                {
+                    this->inPtrs[b] = this->inData.data() + (b*nPxls);
+                }
+                for(int b = 0; b < this->numOutBands; ++b)
+                {
+                    this->outPtrs[b] = this->outData.data() + (b*nPxls);
+                }
+            }
+            for(int b = 0; b < numBands; ++b)
+            {
+                float *inBand = this->inData.data() + (b*nPxls);
+                for(size_t i = 0; i < nPxls; ++i)
+                {
+                    inBand[i] = (float)bands[b][i];
+                }
+            }
+
+            if(!this->valueCalc->calcImageBlock(this->inPtrs.data(), numBands, nPxls, this->outPtrs.data()))
+            {
+                std::vector<float> inColumn(numBands);
+                std::vector<double> outColumn(this->numOutBands);
+                for(size_t i = 0; i < nPxls; ++i)
+                {
+                    for(int b = 0; b < numBands; ++b)
+                    {
+                        inColumn[b] = this->inPtrs[b][i];
+                    }
+                    this->valueCalc->calcImageValue(inColumn.data(), numBands, outColumn.data());
+                    for(int b = 0; b < this->numOutBands; ++b)
+                    {
+                        this->outPtrs[b][i] = outColumn[b];
+                    }
+                }
+            }
+
+            for(int b = 0; b < this->numOutBands; ++b)
+            {
+                for(size_t i = 0; i < nPxls; ++i)
+                {
+                    output[b][i] = rsgisConvertPixelValue<OutT>(this->outPtrs[b][i]);
+                }
+            }
+        };
+        RSGISCalcImageValueT<InT, OutT>* clone()
+        {
+            RSGISCalcImageValue *threadCalc = this->valueCalc->clone();
+            if(threadCalc == NULL)
+            {
+                return NULL;
+            }
+            return new RSGISCalcImageValueTAdapter<InT, OutT>(threadCalc, true);
+        };
+        void reduce(RSGISCalcImageValueT<InT, OutT> *other)
+        {
+            this->valueCalc->reduce(static_cast<RSGISCalcImageValueTAdapter<InT, OutT>*>(other)->valueCalc);
+        };
+        ~RSGISCalcImageValueTAdapter()
+        {
+            if(this->ownCalc)
+            {
+                delete this->valueCalc;
+            }
+        };
+    protected:
+        RSGISCalcImageValue *valueCalc;
+        bool ownCalc;
+        std::vector<float> inData;
+        std::vector<double> outData;
+        std::vector<const float*> inPtrs;
+        std::vector<double*> outPtrs;
+    };
+
+    /**
+     * Evaluates an existing RSGISCalcImageValue once for every value of an 8 or
+     * 16 bit integer input (InT) so the image is processed with table look ups.
+     * This is only valid where each output band is a function of a single input
+     * band, lutInBands[b] (0-based) for output band b.
+     *
+     * Where allBandsNoData is true the calc is assumed to treat pixels where all
+     * the input bands are noDataVal as no data (e.g., the image border), so those
+     * pixels are given the output of the calc for that pixel and the tables are
+     * built with the other input bands set to a value which is not noDataVal.
+     */
+    template <typename InT, typename OutT> class RSGISCalcImageValueLUTT : public RSGISCalcImageValueT<InT, OutT>
+    {
+    public:
+        RSGISCalcImageValueLUTT(RSGISCalcImageValue *valueCalc, int numInBands, std::vector<int> lutInBands, bool allBandsNoData=false, InT noDataVal=0): RSGISCalcImageValueT<InT, OutT>(valueCalc->getNumOutBands())
+        {
+            if(((int)lutInBands.size()) != this->numOutBands)
+            {
+                throw RSGISImageCalcException("An input band must be specified for each output band of the look up table.");
+            }
+            for(size_t b = 0; b < lutInBands.size(); ++b)
+            {
+                if((lutInBands[b] < 0) || (lutInBands[b] >= numInBands))
+                {
+                    throw RSGISImageCalcException("The input band of the look up table is not within the input image bands.");
+                }
+            }
+            this->lutInBands = lutInBands;
+            this->numInBands = numInBands;
+            this->allBandsNoData = allBandsNoData;
+            this->noDataVal = noDataVal;
+
+            const size_t numLUTVals = ((size_t)std::numeric_limits<InT>::max()) + 1;
+            std::vector< std::vector<OutT> > *outLUT = new std::vector< std::vector<OutT> >(this->numOutBands, std::vector<OutT>(numLUTVals));
+            this->lut.reset(outLUT);
+            std::vector<float> inVals(numInBands);
+            std::vector<double> outVals(this->numOutBands);
+            if(allBandsNoData)
+            {
+                const float otherVal = (noDataVal == 0)?1.0f:0.0f;
+                std::vector<int> inBands = lutInBands;
+                std::sort(inBands.begin(), inBands.end());
+                inBands.erase(std::unique(inBands.begin(), inBands.end()), inBands.end());
+                for(std::vector<int>::iterator iterBand = inBands.begin(); iterBand != inBands.end(); ++iterBand)
+                {
+                    for(size_t v = 0; v < numLUTVals; ++v)
+                    {
+                        std::fill(inVals.begin(), inVals.end(), otherVal);
+                        inVals[*iterBand] = (float)v;
+                        valueCalc->calcImageValue(inVals.data(), numInBands, outVals.data());
+                        for(int b = 0; b < this->numOutBands; ++b)
+                        {
+                            if(lutInBands[b] == (*iterBand))
+                            {
+                                (*outLUT)[b][v] = rsgisConvertPixelValue<OutT>(outVals[b]);
+                            }
+                        }
+                    }
+                }
+                std::fill(inVals.begin(), inVals.end(), (float)noDataVal);
+                valueCalc->calcImageValue(inVals.data(), numInBands, outVals.data());
+                this->noDataOutVals.resize(this->numOutBands);
+                for(int b = 0; b < this->numOutBands; ++b)
+                {
+                    this->noDataOutVals[b] = rsgisConvertPixelValue<OutT>(outVals[b]);
+                }
+            }
+            else
+            {
+                // Each output only depends on one input band so all the inputs can be set to v.
+                for(size_t v = 0; v < numLUTVals; ++v)
+                {
+                    std::fill(inVals.begin(), inVals.end(), (float)v);
+                    valueCalc->calcImageValue(inVals.data(), numInBands, outVals.data());
+                    for(int b = 0; b < this->numOutBands; ++b)
+                    {
+                        (*outLUT)[b][v] = rsgisConvertPixelValue<OutT>(outVals[b]);
+                    }
+                }
+            }
+        };
+        void calcImageBlock(const InT* const* bands, int numBands, size_t nPxls, OutT* const* output)
+        {
+            for(int b = 0; b < this->numOutBands; ++b)
+            {
+                const InT *inBand = bands[this->lutInBands[b]];
+                const OutT *bandLUT = (*this->lut)[b].data();
+                OutT *outBand = output[b];
+                for(size_t i = 0; i < nPxls; ++i)
+                {
+                    outBand[i] = bandLUT[inBand[i]];
+                }
+            }
+            if(this->allBandsNoData)
+            {
+                for(size_t i = 0; i < nPxls; ++i)
+                {
+                    bool noData = true;
+                    for(int n = 0; n < numBands; ++n)
+                    {
+                        if(bands[n][i] != this->noDataVal)
+                        {
+                            noData = false;
+                            break;
+                        }
+                    }
+                    if(noData)
+                    {
+                        for(int b = 0; b < this->numOutBands; ++b)
+                        {
+                            output[b][i] = this->noDataOutVals[b];
+                        }
+                    }
+                }
+            }
+        };
+        /** The clones share the (read only) tables. */
+        RSGISCalcImageValueT<InT, OutT>* clone(){return new RSGISCalcImageValueLUTT<InT, OutT>(*this);};
+        ~RSGISCalcImageValueLUTT(){};
+    protected:
+        std::shared_ptr< const std::vector< std::vector<OutT> > > lut;
+        std::vector<int> lutInBands;
+        int numInBands;
+        bool allBandsNoData;
+        InT noDataVal;
+        std::vector<OutT> noDataOutVals;
+    };
+
+    /**
+     * Process the overlapping region of the input images, where all the input
+     * bands are read as InT and the output bands are written as OutT. The rows
+     * of each block are split between the threads if the calc can be cloned.
+     */
+    template <typename InT, typename OutT> class RSGISCalcImageT
+    {
+    public:
+        RSGISCalcImageT(RSGISCalcImageValueT<InT, OutT> *valueCalc)
+        {
+            this->calc = valueCalc;
+            this->numOutBands = valueCalc->getNumOutBands();
+            this->numThreads = 1;
+        };
+        /** If numThreads is 0 all the available cores are used. */
+        void setNumThreads(unsigned int numThreads){this->numThreads = numThreads;};
+        /** Create a new output image, with the GDAL data type of OutT. */
+        void calcImage(GDALDataset **datasets, int numDS, std::string outputImage, bool setOutNames=false, std::string *bandNames=NULL, std::string gdalFormat="KEA")
+        {
+            rsgis::RSGISGDALInit::init();
+            RSGISImageUtils imgUtils;
+            GDALDataset *outputImageDS = NULL;
+            try
+            {
+                std::vector<int> dsOffsetVals(numDS*2);
+                std::vector<int*> dsOffsets(numDS);
+                for(int i = 0; i < numDS; ++i)
+                {
+                    dsOffsets[i] = &dsOffsetVals[i*2];
+                }
+                double gdalTranslation[6];
+                int width = 0;
+                int height = 0;
+                imgUtils.getImageOverlap(datasets, numDS, dsOffsets.data(), &width, &height, gdalTranslation);
+
+                GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(gdalFormat.c_str());
+                if(gdalDriver == NULL)
+                {
+                    throw RSGISImageBandException("Requested GDAL driver does not exists..");
+                }
+                char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(gdalFormat);
+                std::cout << "New image width = " << width << " height = " << height << " bands = " << this->numOutBands << std::endl;
+                outputImageDS = gdalDriver->Create(outputImage.c_str(), width, height, this->numOutBands, RSGISGDALDataTypeT<OutT>::type(), papszOptions);
+                if(outputImageDS == NULL)
+                {
+                    throw RSGISImageBandException("Output image could not be created. Check filepath.");
+                }
+                outputImageDS->SetGeoTransform(gdalTranslation);
+                outputImageDS->SetProjection(datasets[0]->GetProjectionRef());
+                if(setOutNames)
+                {
+                    for(int i = 0; i < this->numOutBands; ++i)
+                    {
+                        outputImageDS->GetRasterBand(i+1)->SetDescription(bandNames[i].c_str());
+                    }
+                }
+
+                this->calcImage(datasets, numDS, outputImageDS);
+            }
+            catch(RSGISImageCalcException &e)
+            {
+                if(outputImageDS != NULL)
+                {
+                    GDALClose(outputImageDS);
+                }
+                throw e;
+            }
+            catch(RSGISImageBandException &e)
+            {
+                if(outputImageDS != NULL)
+                {
+                    GDALClose(outputImageDS);
+                }
+                throw e;
+            }
+            GDALClose(outputImageDS);
+        };
+        /** Write the output to an existing image, which must be the size of the input image overlap. */
+        void calcImage(GDALDataset **datasets, int numDS, GDALDataset *outputImageDS)
+        {
+            rsgis::RSGISGDALInit::init();
+            RSGISImageUtils imgUtils;
+            std::vector<RSGISCalcImageValueT<InT, OutT>*> threadCalcs;
+            try
+            {
+                std::vector<int> dsOffsetVals(numDS*2);
+                std::vector<int*> dsOffsets(numDS);
+                for(int i = 0; i < numDS; ++i)
+                {
+                    dsOffsets[i] = &dsOffsetVals[i*2];
+                }
+                double gdalTranslation[6];
+                int width = 0;
+                int height = 0;
+                int xBlockSize = 0;
+                int yBlockSize = 0;
+                imgUtils.getImageOverlap(datasets, numDS, dsOffsets.data(), &width, &height, gdalTranslation, &xBlockSize, &yBlockSize);
+
+                if(outputImageDS->GetRasterXSize() != width)
+                {
+                    throw RSGISImageCalcException("The output dataset does not have the correct width\n");
+                }
+                if(outputImageDS->GetRasterYSize() != height)
+                {
+                    throw RSGISImageCalcException("The output dataset does not have the correct height\n");
+                }
+                if(outputImageDS->GetRasterCount() != this->numOutBands)
+                {
+                    throw RSGISImageCalcException("The output dataset does not have the correct number of image bands\n");
+                }
+
+                std::vector<GDALRasterBand*> inputRasterBands;
+                std::vector<int*> bandOffsets;
+                for(int i = 0; i < numDS; ++i)
+                {
+                    for(int j = 0; j < datasets[i]->GetRasterCount(); ++j)
+                    {
+                        inputRasterBands.push_back(datasets[i]->GetRasterBand(j+1));
+                        bandOffsets.push_back(dsOffsets[i]);
+                    }
+                }
+                int numInBands = inputRasterBands.size();
+
+                std::vector<GDALRasterBand*> outputRasterBands(this->numOutBands);
+                for(int i = 0; i < this->numOutBands; ++i)
+                {
+                    outputRasterBands[i] = outputImageDS->GetRasterBand(i+1);
+                }
+                int outXBlockSize = 0;
+                int outYBlockSize = 0;
+                outputRasterBands[0]->GetBlockSize(&outXBlockSize, &outYBlockSize);
+                if(outYBlockSize > yBlockSize)
+                {
+                    yBlockSize = outYBlockSize;
+                }
+                if(yBlockSize < 1)
+                {
+                    yBlockSize = 1;
+                }
+
+                size_t blockPxls = ((size_t)width) * yBlockSize;
+                std::vector<std::vector<InT> > inputData(numInBands, std::vector<InT>(blockPxls));
+                std::vector<std::vector<OutT> > outputData(this->numOutBands, std::vector<OutT>(blockPxls));
+
+                // One calc object per thread; threadCalcs[0] is this->calc.
+                threadCalcs.push_back(this->calc);
+                unsigned int nThreads = this->numThreads;
+                if(nThreads == 0)
+                {
+                    nThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+                }
+                for(unsigned int i = 1; i < nThreads; ++i)
+                {
+                    RSGISCalcImageValueT<InT, OutT> *threadCalc = this->calc->clone();
+                    if(threadCalc == NULL)
+                    {
+                        // Not thread safe so use a single thread.
+                        this->deleteThreadCalcs(threadCalcs);
+                        break;
+                    }
+                    threadCalcs.push_back(threadCalc);
+                }
+                nThreads = threadCalcs.size();
+                rsgis::RSGISThreadPool threadPool(nThreads);
+
+                std::vector<std::vector<const InT*> > threadInBlock(nThreads, std::vector<const InT*>(numInBands));
+                std::vector<std::vector<OutT*> > threadOutBlock(nThreads, std::vector<OutT*>(this->numOutBands));
+
+                // Process the rows [mStart, mEnd) of the current block.
+                auto processRows = [&](unsigned int t, size_t mStart, size_t mEnd)
+                {
+                    size_t pxlOff = mStart * width;
+                    for(int n = 0; n < numInBands; ++n)
+                    {
+                        threadInBlock[t][n] = inputData[n].data() + pxlOff;
+                    }
+                    for(int n = 0; n < this->numOutBands; ++n)
+                    {
+                        threadOutBlock[t][n] = outputData[n].data() + pxlOff;
+                    }
+                    threadCalcs[t]->calcImageBlock(threadInBlock[t].data(), numInBands, (mEnd-mStart)*width, threadOutBlock[t].data());
+                };
+
+                GDALDataType inType = RSGISGDALDataTypeT<InT>::type();
+                GDALDataType outType = RSGISGDALDataTypeT<OutT>::type();
+                rsgis_tqdm pbar;
+                for(int row = 0; row < height; row += yBlockSize)
+                {
+                    int nRows = std::min(yBlockSize, height - row);
+                    pbar.progress(row, height);
+                    for(int n = 0; n < numInBands; ++n)
+                    {
+                        if(inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], bandOffsets[n][1] + row, width, nRows, inputData[n].data(), width, nRows, inType, 0, 0) != CE_None)
+                        {
+                            throw RSGISImageCalcException("Failed to read the input image data.");
+                        }
+                    }
+
+                    threadPool.parallelFor(0, nRows, processRows);
+
+                    for(int n = 0; n < this->numOutBands; ++n)
+                    {
+                        if(outputRasterBands[n]->RasterIO(GF_Write, 0, row, width, nRows, outputData[n].data(), width, nRows, outType, 0, 0) != CE_None)
+                        {
+                            throw RSGISImageCalcException("Failed to write the output image data.");
+                        }
+                    }
+                }
+                pbar.finish();
+
+                // Merge in thread order so the result does not depend on the scheduling.
+                for(size_t i = 1; i < threadCalcs.size(); ++i)
+                {
+                    this->calc->reduce(threadCalcs.at(i));
+                }
+                this->deleteThreadCalcs(threadCalcs);
+            }
+            catch(RSGISImageCalcException &e)
+            {
+                this->deleteThreadCalcs(threadCalcs);
+                throw e;
+            }
+            catch(RSGISImageBandException &e)
+            {
+                this->deleteThreadCalcs(threadCalcs);
+                throw e;
+            }
+            catch(rsgis::RSGISException &e)
+            {
+                this->deleteThreadCalcs(threadCalcs);
+                throw RSGISImageCalcException(e.what());
+            }
+        };
+        ~RSGISCalcImageT(){};
+    protected:
+        void deleteThreadCalcs(std::vector<RSGISCalcImageValueT<InT, OutT>*> &threadCalcs)
+        {
+            for(size_t i = 1; i < threadCalcs.size(); ++i)
+            {
+                delete threadCalcs.at(i);
+            }
+            if(!threadCalcs.empty())
+            {
+                threadCalcs.resize(1);
+            }
+        };
+        RSGISCalcImageValueT<InT, OutT> *calc;
+        int numOutBands;
+        unsigned int numThreads;
+    };
+
+    /**
+     * An option for RSGISCalcImage calculations which are a function of a single
+     * band of an 8 or 16 bit unsigned integer image (e.g., the calibration of DNs)
+     * where the calc is evaluated once per input value into look up tables (see
+     * RSGISCalcImageValueLUTT) which are applied block-wise with RSGISCalcImageT.
+     */
+    class RSGISCalcImageLUT
+    {
+    public:
+        /**
+         * Create the output image, returning false without processing the image if
+         * the input bands are not all uint8 or uint16 or the output data type is not
+         * supported, in which case RSGISCalcImage should be used instead. If
+         * lutInBands is empty each output band is a function of the same input band.
+         */
+        static bool calcImage(RSGISCalcImageValue *valueCalc, std::vector<int> lutInBands, GDALDataset **datasets, int numDS, std::string outputImage, bool setOutNames=false, std::string *bandNames=NULL, std::string gdalFormat="KEA", GDALDataType outDataType=GDT_Float32, unsigned int numThreads=1, bool allBandsNoData=false, double noDataVal=0)
+        {
+            GDALDataType inDataType = GDT_Unknown;
+            int numInBands = 0;
+            for(int i = 0; i < numDS; ++i)
+            {
+                for(int j = 0; j < datasets[i]->GetRasterCount(); ++j)
+                {
+                    GDALDataType bandDataType = datasets[i]->GetRasterBand(j+1)->GetRasterDataType();
+                    if((numInBands > 0) && (bandDataType != inDataType))
+                    {
+                        return false;
+                    }
+                    inDataType = bandDataType;
+                    ++numInBands;
+                }
+            }
+
+            if(lutInBands.empty())
+            {
+                for(int b = 0; b < numInBands; ++b)
+                {
+                    lutInBands.push_back(b);
+                }
+            }
+
+            if(inDataType == GDT_Byte)
+            {
+                if(allBandsNoData && !rsgisPixelValueRepresentable<uint8_t>(noDataVal))
+                {
+                    return false;
+                }
+                return calcImageInT<uint8_t>(valueCalc, lutInBands, numInBands, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, outDataType, numThreads, allBandsNoData, (uint8_t)noDataVal);
+            }
+            else if(inDataType == GDT_UInt16)
+            {
+                if(allBandsNoData && !rsgisPixelValueRepresentable<uint16_t>(noDataVal))
+                {
+                    return false;
+                }
+                return calcImageInT<uint16_t>(valueCalc, lutInBands, numInBands, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, outDataType, numThreads, allBandsNoData, (uint16_t)noDataVal);
+            }
+            return false;
+        };
+    protected:
+        template <typename InT> static bool calcImageInT(RSGISCalcImageValue *valueCalc, std::vector<int> lutInBands, int numInBands, GDALDataset **datasets, int numDS, std::string outputImage, bool setOutNames, std::string *bandNames, std::string gdalFormat, GDALDataType outDataType, unsigned int numThreads, bool allBandsNoData, InT noDataVal)
+        {
+            switch(outDataType)
+            {
+                case GDT_Byte:
+                    calcImageT<InT, uint8_t>(valueCalc, lutInBands, numInBands, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, numThreads, allBandsNoData, noDataVal);
+                    break;
+                case GDT_UInt16:
+                    calcImageT<InT, uint16_t>(valueCalc, lutInBands, numInBands, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, numThreads, allBandsNoData, noDataVal);
+                    break;
+                case GDT_Int16:
+                    calcImageT<InT, int16_t>(valueCalc, lutInBands, numInBands, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, numThreads, allBandsNoData, noDataVal);
+                    break;
+                case GDT_UInt32:
+                    calcImageT<InT, uint32_t>(valueCalc, lutInBands, numInBands, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, numThreads, allBandsNoData, noDataVal);
+                    break;
+                case GDT_Int32:
+                    calcImageT<InT, int32_t>(valueCalc, lutInBands, numInBands, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, numThreads, allBandsNoData, noDataVal);
+                    break;
+                case GDT_Float32:
+                    calcImageT<InT, float>(valueCalc, lutInBands, numInBands, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, numThreads, allBandsNoData, noDataVal);
+                    break;
+                case GDT_Float64:
+                    calcImageT<InT, double>(valueCalc, lutInBands, numInBands, datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat, numThreads, allBandsNoData, noDataVal);
+                    break;
+                default:
+                    return false;
+            }
+            return true;
+        };
+        template <typename InT, typename OutT> static void calcImageT(RSGISCalcImageValue *valueCalc, std::vector<int> lutInBands, int numInBands, GDALDataset **datasets, int numDS, std::string outputImage, bool setOutNames, std::string *bandNames, std::string gdalFormat, unsigned int numThreads, bool allBandsNoData, InT noDataVal)
+        {
+            RSGISCalcImageValueLUTT<InT, OutT> lutCalc = RSGISCalcImageValueLUTT<InT, OutT>(valueCalc, numInBands, lutInBands, allBandsNoData, noDataVal);
+            RSGISCalcImageT<InT, OutT> calcImg = RSGISCalcImageT<InT, OutT>(&lutCalc);
+            calcImg.setNumThreads(numThreads);
+            calcImg.calcImage(datasets, numDS, outputImage, setOutNames, bandNames, gdalFormat);
+        };
+    };
+
+}}
+
+#endif
@@ -25,6 +25,7 @@
 
 #include <iostream>
 #include <string>
+#include <cmath>
 #include "img/RSGISImageCalcException.h"
 
 #include "gdal_priv.h"
@@ -44,6 +45,39 @@
 
 namespace rsgis{namespace img{
 
+    /**
+     * The location of a pixel, given as its column and row within the image (overlap)
+     * being processed and the geotransform of that image. The coordinates of the pixel
+     * are only calculated when they are requested, rather than an OGREnvelope being
+     * created for every pixel.
+     */
+    struct DllExport RSGISPxlCoords
+    {
+        RSGISPxlCoords(const double *transform, unsigned int xPxl, unsigned int yPxl): transform(transform), xPxl(xPxl), yPxl(yPxl){};
+        double getMinX() const {return this->transform[0] + (this->xPxl * this->transform[1]);};
+        double getMaxX() const {return this->transform[0] + ((this->xPxl+1) * this->transform[1]);};
+        double getMinY() const {return this->transform[3] - ((this->yPxl+1) * std::abs(this->transform[5]));};
+        double getMaxY() const {return this->transform[3] - (this->yPxl * std::abs(this->transform[5]));};
+        double getCentreX() const {return this->transform[0] + ((this->xPxl+0.5) * this->transform[1]);};
+        double getCentreY() const {return this->transform[3] - ((this->yPxl+0.5) * std::abs(this->transform[5]));};
+        const double *transform;
+        unsigned int xPxl;
+        unsigned int yPxl;
+    };
+    
+    /**
+     * Generates the location of pixel p of a block of whole image rows (i.e., the
+     * band-major pixel index used by the block API) starting at row rowStart.
+     */
+    struct DllExport RSGISPxlCoordsGenerator
+    {
+        RSGISPxlCoordsGenerator(const double *transform, unsigned int width, unsigned int rowStart): transform(transform), width(width), rowStart(rowStart){};
+        RSGISPxlCoords getPxlCoords(size_t p) const {return RSGISPxlCoords(this->transform, p % this->width, this->rowStart + (p / this->width));};
+        const double *transform;
+        unsigned int width;
+        unsigned int rowStart;
+    };
+
     class DllExport RSGISCalcImageValue
     {
         public:
@@ -57,6 +91,19 @@ namespace rsgis{namespace img{
             virtual void calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals, OGREnvelope extent) {throw RSGISImageCalcException("Not Implemented - RSGISCalcImageValue Base Class");};
             virtual void calcImageValue(float *bandValues, int numBands, OGREnvelope extent) {throw RSGISImageCalcException("Not Implemented - RSGISCalcImageValue Base Class");};
             virtual void calcImageValue(float *bandValues, int numBands, double *output, OGREnvelope extent) {throw RSGISImageCalcException("Not Implemented - RSGISCalcImageValue Base Class");};
+            /**
+             * Process a pixel given its location (used by RSGISCalcImage::calcImageExtent and
+             * calcImagePosPxl) so the pixel coordinates are only calculated if needed. Returns
+             * false (the default) if not implemented, in which case calcImageValue(float *bandValues,
+             * int numBands, OGREnvelope extent) is called instead.
+             */
+            virtual bool calcImageValueAtPxl(float *bandValues, int numBands, const RSGISPxlCoords &pxlCoords){return false;};
+            /**
+             * Process a block of nPxls pixels (band-major, bands[b][p]) where the location of
+             * pixel p is given by pxlCoords.getPxlCoords(p). Returns false (the default) if not
+             * implemented, in which case the pixels are passed to calcImageValueAtPxl one at a time.
+             */
+            virtual bool calcImageBlockAtPxls(const float* const* bands, int numBands, size_t nPxls, const RSGISPxlCoordsGenerator &pxlCoords){return false;};
             virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output) {throw RSGISImageCalcException("Not Implemented - RSGISCalcImageValue Base Class");};
             virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output, double *outRefVal, unsigned int nOutRefVals) {throw RSGISImageCalcException("Not Implemented - RSGISCalcImageValue Base Class");};
             /**
@@ -64,6 +111,44 @@ namespace rsgis{namespace img{
              */
             virtual void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output, OGREnvelope extent) {throw RSGISImageCalcException("Not Implemented - RSGISCalcImageValue Base Class");};
             virtual bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) {throw RSGISImageCalcException("Not Implemented - RSGISCalcImageValue Base Class");};
+            /**
+             * Process the window around a pixel using a view into the image data held by
+             * RSGISCalcImage::calcImageWindowData rather than a copy of the window. The value
+             * at row y and column x of the window for band b is winData[b][(y*stride)+x].
+             * Returns false (the default) if the class does not implement the window view,
+             * in which case calcImageValue(float ***dataBlock, ...) is called instead.
+             */
+            virtual bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output){return false;};
+            /**
+             * Process the window after it has moved one pixel to the right of the window
+             * previously passed to calcImageWindowView or calcImageWindowViewSlide, where
+             * outColumn is the column which has left the window and inColumn is the column
+             * which has entered it (i.e., outColumn[b][y*stride] for row y of band b). This
+             * allows running values (e.g., sums) to be used. Returns false (the default) if
+             * not implemented, in which case calcImageWindowView is called for every pixel.
+             */
+            virtual bool calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output){return false;};
+            /**
+             * Process a block of nPxls pixels in one call. The data are band-major,
+             * (i.e., bands[b][p] and output[b][p] for pixel p of band b) so loops
+             * over the pixels of a band can be vectorised by the compiler. Returns
+             * false (the default) if the class does not implement the block API, in
+             * which case the engine calls calcImageValue for each pixel instead.
+             */
+            virtual bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output){return false;};
+            /**
+             * Create an independent copy of this object which can be used from another
+             * thread by the parallel code paths within RSGISCalcImage. The caller takes
+             * ownership of the returned object. The default returns NULL, which means
+             * the class is not thread safe and the serial code path will be used.
+             */
+            virtual RSGISCalcImageValue* clone(){return NULL;};
+            /**
+             * Merge the state accumulated by a clone (created with clone()) into this
+             * object. Only needs to be implemented by classes which accumulate values
+             * (e.g., statistics) rather than just writing an output image.
+             */
+            virtual void reduce(RSGISCalcImageValue *other){};
             virtual int getNumOutBands();
             virtual void setNumOutBands(int bands);
             virtual ~RSGISCalcImageValue(){};
@@ -78,6 +163,12 @@ namespace rsgis{namespace img{
     public:
         RSGISCalcValuesFromMultiResInputs(int numberOutBands);
         virtual void calcImageValue(float *bandValues, int numInVals, bool useNoData, float noDataVal, double *output)  = 0;
+        /**
+         * Create an independent copy of this object which can be used from another
+         * thread by RSGISCalcImageMultiImgRes. The caller takes ownership of the
+         * returned object. The default returns NULL (not thread safe).
+         */
+        virtual RSGISCalcValuesFromMultiResInputs* clone(){return NULL;};
         virtual int getNumOutBands();
         virtual void setNumOutBands(int bands);
         virtual ~RSGISCalcValuesFromMultiResInputs();
@@ -25,6 +25,162 @@
 
 namespace rsgis{namespace img{
     
+    const uint64_t RSGISNDHistBinTable::emptyKey;
+    
+    // Above this number of bins (128 MB of counts) the n-d histogram is held sparsely.
+    static const unsigned long RSGIS_NDHIST_MAX_DENSE_BINS = 16777216;
+    
+    RSGISNDHistBinTable::RSGISNDHistBinTable(size_t initCapacity)
+    {
+        size_t capacity = 16;
+        unsigned int bits = 4;
+        while(capacity < initCapacity)
+        {
+            capacity = capacity * 2;
+            ++bits;
+        }
+        this->keys.assign(capacity, emptyKey);
+        this->vals.assign(capacity, 0.0);
+        this->numUsed = 0;
+        this->hashShift = 64 - bits;
+    }
+    
+    size_t RSGISNDHistBinTable::findSlot(uint64_t key) const
+    {
+        // Fibonacci hashing spreads the neighbouring bin indexes over the table.
+        size_t mask = this->keys.size() - 1;
+        size_t slot = (size_t)((key * 11400714819323198485ull) >> this->hashShift);
+        while((this->keys[slot] != emptyKey) && (this->keys[slot] != key))
+        {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+    
+    void RSGISNDHistBinTable::rehash(size_t newCapacity)
+    {
+        std::vector<uint64_t> oldKeys;
+        std::vector<double> oldVals;
+        oldKeys.swap(this->keys);
+        oldVals.swap(this->vals);
+        
+        unsigned int bits = 0;
+        while((((size_t)1) << bits) < newCapacity)
+        {
+            ++bits;
+        }
+        this->keys.assign(((size_t)1) << bits, emptyKey);
+        this->vals.assign(((size_t)1) << bits, 0.0);
+        this->hashShift = 64 - bits;
+        
+        for(size_t i = 0; i < oldKeys.size(); ++i)
+        {
+            if(oldKeys[i] != emptyKey)
+            {
+                size_t slot = this->findSlot(oldKeys[i]);
+                this->keys[slot] = oldKeys[i];
+                this->vals[slot] = oldVals[i];
+            }
+        }
+    }
+    
+    void RSGISNDHistBinTable::increment(uint64_t key, double val)
+    {
+        size_t slot = this->findSlot(key);
+        if(this->keys[slot] == emptyKey)
+        {
+            if(((this->numUsed + 1) * 2) > this->keys.size())
+            {
+                this->rehash(this->keys.size() * 2);
+                slot = this->findSlot(key);
+            }
+            this->keys[slot] = key;
+            ++this->numUsed;
+        }
+        this->vals[slot] += val;
+    }
+    
+    double RSGISNDHistBinTable::getValue(uint64_t key) const
+    {
+        size_t slot = this->findSlot(key);
+        if(this->keys[slot] == emptyKey)
+        {
+            return 0.0;
+        }
+        return this->vals[slot];
+    }
+    
+    void RSGISNDHistBinTable::merge(const RSGISNDHistBinTable *other)
+    {
+        for(size_t i = 0; i < other->keys.size(); ++i)
+        {
+            if(other->keys[i] != emptyKey)
+            {
+                this->increment(other->keys[i], other->vals[i]);
+            }
+        }
+    }
+    
+    void RSGISNDHistBinTable::multiply(double val)
+    {
+        for(size_t i = 0; i < this->keys.size(); ++i)
+        {
+            if(this->keys[i] != emptyKey)
+            {
+                this->vals[i] = this->vals[i] * val;
+            }
+        }
+    }
+    
+    void RSGISNDHistBinTable::divide(double val)
+    {
+        for(size_t i = 0; i < this->keys.size(); ++i)
+        {
+            if(this->keys[i] != emptyKey)
+            {
+                this->vals[i] = this->vals[i] / val;
+            }
+        }
+    }
+    
+    double RSGISNDHistBinTable::getTotal() const
+    {
+        double total = 0.0;
+        for(size_t i = 0; i < this->keys.size(); ++i)
+        {
+            if(this->keys[i] != emptyKey)
+            {
+                total += this->vals[i];
+            }
+        }
+        return total;
+    }
+    
+    double RSGISNDHistBinTable::getMaxValue() const
+    {
+        double maxVal = 0.0;
+        bool first = true;
+        for(size_t i = 0; i < this->keys.size(); ++i)
+        {
+            if((this->keys[i] != emptyKey) && (this->vals[i] > 0))
+            {
+                if(first || (this->vals[i] > maxVal))
+                {
+                    maxVal = this->vals[i];
+                    first = false;
+                }
+            }
+        }
+        return maxVal;
+    }
+    
+    void RSGISNDHistBinTable::clear()
+    {
+        std::fill(this->keys.begin(), this->keys.end(), emptyKey);
+        std::fill(this->vals.begin(), this->vals.end(), 0.0);
+        this->numUsed = 0;
+    }
+    
 
     void RSGISCalcImgValProb::calcMaskImgPxlValProb(GDALDataset *inImgDS, std::vector<unsigned int> inImgBandIdxs, GDALDataset *inMaskDS, int maskVal, std::string outputImage, std::string gdalFormat, std::vector<float> histBinWidths, bool calcHistBinWidth, bool useImgNoData, bool rescaleProbs)
     {
@@ -97,16 +253,39 @@ namespace rsgis{namespace img{
             unsigned long totalNumBins = numBins[0];
             for(unsigned int i = 1; i < numHistDIMS; ++i)
             {
+                if((numBins[i] > 0) && (totalNumBins > ((std::numeric_limits<unsigned long>::max()-1) / numBins[i])))
+                {
+                    delete[] bandMin;
+                    delete[] bandMax;
+                    delete[] numBins;
+                    delete[] noDataVals;
+                    throw RSGISImageCalcException("The number of histogram bins is too large to be indexed; use wider histogram bins or fewer bands.");
+                }
                 totalNumBins = totalNumBins * numBins[i];
             }
-            double *hist = new double[totalNumBins];
-            for(unsigned long i = 0; i < totalNumBins; ++i)
+            
+            // A dense histogram grows exponentially with the number of bands so, when it
+            // would be large, only the occupied bins are held within a hash table.
+            bool useSparseHist = (totalNumBins > RSGIS_NDHIST_MAX_DENSE_BINS);
+            double *hist = NULL;
+            RSGISNDHistBinTable *sparseHist = NULL;
+            RSGISCalcImagePopNDHist *calcImageStats = NULL;
+            if(useSparseHist)
             {
-                hist[i] = 0.0;
+                std::cout << "Using a sparse histogram (" << totalNumBins << " bins)\n";
+                sparseHist = new RSGISNDHistBinTable();
+                calcImageStats = new RSGISCalcImagePopNDHist(inImgBandIdxs, maskVal, noDataVals, useImgNoData, bandMin, bandMax, histBinWidths, numBins, sparseHist, totalNumBins);
             }
-            
-            RSGISCalcImagePopNDHist calcImageStats = RSGISCalcImagePopNDHist(inImgBandIdxs, maskVal, noDataVals, useImgNoData, bandMin, bandMax, histBinWidths, numBins, hist, totalNumBins);
-            RSGISCalcImage calcImg = RSGISCalcImage(&calcImageStats, "", true);
+            else
+            {
+                hist = new double[totalNumBins];
+                for(unsigned long i = 0; i < totalNumBins; ++i)
+                {
+                    hist[i] = 0.0;
+                }
+                calcImageStats = new RSGISCalcImagePopNDHist(inImgBandIdxs, maskVal, noDataVals, useImgNoData, bandMin, bandMax, histBinWidths, numBins, hist, totalNumBins);
+            }
+            RSGISCalcImage calcImg = RSGISCalcImage(calcImageStats, "", true);
             
             GDALDataset **datasets = new GDALDataset*[2];
             datasets[0] = inMaskDS;
@@ -114,59 +293,81 @@ namespace rsgis{namespace img{
             calcImg.calcImage(datasets, 1, 1);
             delete[] datasets;
             
-            unsigned long nPxl = 0;
-            for(unsigned long i = 0; i < totalNumBins; ++i)
-            {
-                nPxl += hist[i];
-            }
-            
-            for(unsigned long i = 0; i < totalNumBins; ++i)
+            if(useSparseHist)
             {
-                if(hist[i] > 0)
+                unsigned long nPxl = sparseHist->getTotal();
+                sparseHist->divide(nPxl);
+                if(rescaleProbs)
                 {
-                    hist[i] = hist[i] / nPxl;
-                }
-                else
-                {
-                    hist[i] = 0.0;
+                    double maxVal = sparseHist->getMaxValue();
+                    double mulVal = 1/maxVal;
+                    sparseHist->multiply(mulVal);
                 }
             }
-            
-            if(rescaleProbs)
+            else
             {
-                double maxVal = 0;
-                bool first = true;
+                unsigned long nPxl = 0;
                 for(unsigned long i = 0; i < totalNumBins; ++i)
                 {
-                    if(hist[i] > 0)
-                    {
-                        if(first)
-                        {
-                            maxVal = hist[i];
-                            first = false;
-                        }
-                        else if(hist[i] > maxVal)
-                        {
-                            maxVal = hist[i];
-                        }
-                    }
+                    nPxl += hist[i];
                 }
                 
-                double mulVal = 1/maxVal;
                 for(unsigned long i = 0; i < totalNumBins; ++i)
                 {
                     if(hist[i] > 0)
                     {
-                        hist[i] = hist[i] * mulVal;
+                        hist[i] = hist[i] / nPxl;
+                    }
+                    else
+                    {
+                        hist[i] = 0.0;
                     }
                 }
                 
+                if(rescaleProbs)
+                {
+                    double maxVal = 0;
+                    bool first = true;
+                    for(unsigned long i = 0; i < totalNumBins; ++i)
+                    {
+                        if(hist[i] > 0)
+                        {
+                            if(first)
+                            {
+                                maxVal = hist[i];
+                                first = false;
+                            }
+                            else if(hist[i] > maxVal)
+                            {
+                                maxVal = hist[i];
+                            }
+                        }
+                    }
+                    
+                    double mulVal = 1/maxVal;
+                    for(unsigned long i = 0; i < totalNumBins; ++i)
+                    {
+                        if(hist[i] > 0)
+                        {
+                            hist[i] = hist[i] * mulVal;
+                        }
+                    }
+                    
+                }
             }
             
             std::cout << "Populate the output image\n";
             calcImg.calcImage(&inImgDS, 1, outputImage, false, nullptr, gdalFormat, GDT_Float32);
             
-            delete[] hist;
+            delete calcImageStats;
+            if(hist != NULL)
+            {
+                delete[] hist;
+            }
+            if(sparseHist != NULL)
+            {
+                delete sparseHist;
+            }
             delete[] bandMin;
             delete[] bandMax;
             delete[] numBins;
@@ -204,7 +405,66 @@ namespace rsgis{namespace img{
         this->histBinWidths = histBinWidths;
         this->numBins = numBins;
         this->hist = hist;
+        this->sparseHist = NULL;
+        this->localHist = NULL;
         this->totalNumBins = totalNumBins;
+        this->binIdxs.resize(inImgBandIdxs.size());
+    }
+    
+    RSGISCalcImagePopNDHist::RSGISCalcImagePopNDHist(std::vector<unsigned int> inImgBandIdxs, long maskVal, double *noDataVals, bool useNoData, double *bandMin, double *bandMax, std::vector<float> histBinWidths, unsigned long *numBins, RSGISNDHistBinTable *sparseHist, unsigned long totalNumBins):RSGISCalcImageValue(1)
+    {
+        this->inImgBandIdxs = inImgBandIdxs;
+        this->maskVal = maskVal;
+        this->noDataVals = noDataVals;
+        this->useNoData = useNoData;
+        this->bandMin = bandMin;
+        this->bandMax = bandMax;
+        this->histBinWidths = histBinWidths;
+        this->numBins = numBins;
+        this->hist = NULL;
+        this->sparseHist = sparseHist;
+        this->localHist = NULL;
+        this->totalNumBins = totalNumBins;
+        this->binIdxs.resize(inImgBandIdxs.size());
+    }
+    
+    bool RSGISCalcImagePopNDHist::calcBinIdx(float *bandValues, bool checkRange, unsigned long *idx)
+    {
+        unsigned int bIdx = 0;
+        for(unsigned int i = 0; i < inImgBandIdxs.size(); ++i)
+        {
+            bIdx = inImgBandIdxs.at(i)-1;
+            if(boost::math::isnan(bandValues[bIdx]))
+            {
+                return false;
+            }
+            if(checkRange && !((bandValues[bIdx] >= bandMin[i]) & (bandValues[bIdx] <= bandMax[i])))
+            {
+                return false;
+            }
+            if(useNoData && (bandValues[bIdx] == this->noDataVals[i]))
+            {
+                return false;
+            }
+            double binF = (bandValues[bIdx] - bandMin[i])/histBinWidths.at(i);
+            binIdxs[i] = floor(binF+0.5);
+        }
+        
+        unsigned long tDIMS = 0;
+        for(unsigned int i = 0; i < inImgBandIdxs.size(); ++i)
+        {
+            if(i == 0)
+            {
+                *idx = binIdxs[i];
+                tDIMS = this->numBins[i];
+            }
+            else
+            {
+                *idx = *idx + (binIdxs[i] * tDIMS);
+                tDIMS = tDIMS * this->numBins[i];
+            }
+        }
+        return (*idx < totalNumBins);
     }
     
     void RSGISCalcImagePopNDHist::calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals)
@@ -216,131 +476,71 @@ namespace rsgis{namespace img{
         
         if(intBandValues[0] == this->maskVal)
         {
-            unsigned int bIdx = 0;
-            unsigned long *binIdxs = new unsigned long[inImgBandIdxs.size()];
-            bool notValid = false;
-            for(unsigned int i = 0; i < inImgBandIdxs.size(); ++i)
+            unsigned long idx = 0;
+            if(this->calcBinIdx(floatBandValues, false, &idx))
             {
-                bIdx = inImgBandIdxs.at(i)-1;
-                if(!boost::math::isnan(floatBandValues[bIdx]))
-                {
-                    if((!useNoData) || (useNoData && (floatBandValues[bIdx] != this->noDataVals[i])))
-                    {
-                        double binF = (floatBandValues[bIdx] - bandMin[i])/histBinWidths.at(i);
-                        binIdxs[i] = floor(binF+0.5);
-                    }
-                    else
-                    {
-                        notValid = true;
-                        break;
-                    }
-                }
-                else
+                if(this->localHist != NULL)
                 {
-                    notValid = true;
-                    break;
+                    this->localHist->increment(idx);
                 }
-                
-            }
-            
-            if(!notValid)
-            {
-                unsigned long idx = 0;
-                unsigned long tDIMS = 0;
-                for(unsigned int i = 0; i < inImgBandIdxs.size(); ++i)
+                else if(this->sparseHist != NULL)
                 {
-                    if(i == 0)
-                    {
-                        idx = binIdxs[i];
-                        tDIMS = this->numBins[i];
-                    }
-                    else
-                    {
-                        idx = idx + (binIdxs[i] * tDIMS);
-                        tDIMS = tDIMS * this->numBins[i];
-                    }
+                    this->sparseHist->increment(idx);
                 }
-                if(idx < totalNumBins)
+                else
                 {
                     hist[idx] = hist[idx] + 1;
                 }
             }
-            
-            delete[] binIdxs;
         }
     }
     
     void RSGISCalcImagePopNDHist::calcImageValue(float *bandValues, int numBands, double *output) 
     {
         output[0] = 0.0;
-        unsigned long *binIdxs = new unsigned long[inImgBandIdxs.size()];
-        bool notValid = false;
-        unsigned int bIdx = 0;
-        for(unsigned int i = 0; i < inImgBandIdxs.size(); ++i)
+        unsigned long idx = 0;
+        if(this->calcBinIdx(bandValues, true, &idx))
         {
-            bIdx = inImgBandIdxs.at(i)-1;
-            if(!boost::math::isnan(bandValues[bIdx]))
+            if(this->sparseHist != NULL)
             {
-                if((bandValues[bIdx] >= bandMin[i]) & (bandValues[bIdx] <= bandMax[i]))
-                {
-                    if((!useNoData) || (useNoData && (bandValues[bIdx] != this->noDataVals[i])))
-                    {
-                        double binF = (bandValues[bIdx] - bandMin[i])/histBinWidths.at(i);
-                        binIdxs[i] = floor(binF+0.5);
-                    }
-                    else
-                    {
-                        notValid = true;
-                        break;
-                    }
-                }
-                else
-                {
-                    notValid = true;
-                    break;
-                }
+                output[0] = this->sparseHist->getValue(idx);
             }
             else
             {
-                notValid = true;
-                break;
+                output[0] = hist[idx];
             }
-            
         }
-        
-        if(!notValid)
+    }
+    
+    RSGISCalcImageValue* RSGISCalcImagePopNDHist::clone()
+    {
+        if(this->sparseHist == NULL)
         {
-            unsigned long idx = 0;
-            unsigned long tDIMS = 0;
-            for(unsigned int i = 0; i < inImgBandIdxs.size(); ++i)
-            {
-                if(i == 0)
-                {
-                    idx = binIdxs[i];
-                    tDIMS = this->numBins[i];
-                }
-                else
-                {
-                    idx = idx + (binIdxs[i] * tDIMS);
-                    tDIMS = tDIMS * this->numBins[i];
-                }
-            }
-            if(idx < totalNumBins)
-            {
-                output[0] = hist[idx];
-            }
-            else
-            {
-                output[0] = 0;
-            }
+            // The dense histogram is too large to be copied for each thread.
+            return NULL;
+        }
+        RSGISCalcImagePopNDHist *calc = new RSGISCalcImagePopNDHist(this->inImgBandIdxs, this->maskVal, this->noDataVals, this->useNoData, this->bandMin, this->bandMax, this->histBinWidths, this->numBins, this->sparseHist, this->totalNumBins);
+        calc->localHist = new RSGISNDHistBinTable();
+        return calc;
+    }
+    
+    void RSGISCalcImagePopNDHist::reduce(RSGISCalcImageValue *other)
+    {
+        RSGISCalcImagePopNDHist *otherCalc = static_cast<RSGISCalcImagePopNDHist*>(other);
+        if((otherCalc != NULL) && (otherCalc->localHist != NULL) && (otherCalc->localHist->getNumBins() > 0))
+        {
+            RSGISNDHistBinTable *target = (this->localHist != NULL)?this->localHist:this->sparseHist;
+            target->merge(otherCalc->localHist);
+            otherCalc->localHist->clear();
         }
-        
-        delete[] binIdxs;
     }
     
     RSGISCalcImagePopNDHist::~RSGISCalcImagePopNDHist()
     {
-        
+        if(this->localHist != NULL)
+        {
+            delete this->localHist;
+        }
     }
 }}
 
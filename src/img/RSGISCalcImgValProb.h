@@ -25,6 +25,9 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <limits>
+#include <stdint.h>
 
 #include "gdal_priv.h"
 
@@ -50,6 +53,35 @@
 
 namespace rsgis{namespace img{
     
+    /**
+     * A sparse n-dimensional histogram holding only the occupied bins, where the
+     * key of a bin is its (mixed radix) index within the equivalent dense histogram.
+     * The table uses open addressing with linear probing and is kept at most half full.
+     */
+    class DllExport RSGISNDHistBinTable
+    {
+    public:
+        RSGISNDHistBinTable(size_t initCapacity=1024);
+        void increment(uint64_t key, double val=1.0);
+        double getValue(uint64_t key) const;
+        void merge(const RSGISNDHistBinTable *other);
+        void multiply(double val);
+        void divide(double val);
+        double getTotal() const;
+        double getMaxValue() const;
+        size_t getNumBins() const{return this->numUsed;};
+        void clear();
+        ~RSGISNDHistBinTable(){};
+        static const uint64_t emptyKey = std::numeric_limits<uint64_t>::max();
+    protected:
+        size_t findSlot(uint64_t key) const;
+        void rehash(size_t newCapacity);
+        std::vector<uint64_t> keys;
+        std::vector<double> vals;
+        size_t numUsed;
+        unsigned int hashShift;
+    };
+    
     class DllExport RSGISCalcImgValProb
     {
     public:
@@ -62,10 +94,22 @@ namespace rsgis{namespace img{
     {
     public:
         RSGISCalcImagePopNDHist(std::vector<unsigned int> inImgBandIdxs, long maskVal, double *noDataVals, bool useNoData, double *bandMin, double *bandMax, std::vector<float> histBinWidths, unsigned long *numBins, double *hist, unsigned long totalNumBins);
+        /**
+         * Use a sparse histogram (sparseHist) rather than a dense array. The sparse
+         * histogram can be populated and read by multiple threads (see clone).
+         */
+        RSGISCalcImagePopNDHist(std::vector<unsigned int> inImgBandIdxs, long maskVal, double *noDataVals, bool useNoData, double *bandMin, double *bandMax, std::vector<float> histBinWidths, unsigned long *numBins, RSGISNDHistBinTable *sparseHist, unsigned long totalNumBins);
         void calcImageValue(float *bandValues, int numBands, double *output);
         void calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals);
+        /**
+         * Only the sparse histogram is thread safe; each clone counts into its own table,
+         * which is merged into the shared table by reduce, and reads the shared table.
+         */
+        RSGISCalcImageValue* clone();
+        void reduce(RSGISCalcImageValue *other);
         ~RSGISCalcImagePopNDHist();
     protected:
+        bool calcBinIdx(float *bandValues, bool checkRange, unsigned long *idx);
         std::vector<unsigned int> inImgBandIdxs;
         long maskVal;
         double *noDataVals;
@@ -75,7 +119,10 @@ namespace rsgis{namespace img{
         std::vector<float> histBinWidths;
         unsigned long *numBins;
         double *hist;
+        RSGISNDHistBinTable *sparseHist;
+        RSGISNDHistBinTable *localHist;
         unsigned long totalNumBins;
+        std::vector<unsigned long> binIdxs;
     };
     
 }}
@@ -0,0 +1,366 @@
+/*
+ *  RSGISClassPixelIndex.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISClassPixelIndex.h"
+
+namespace rsgis{namespace img{
+
+    static const char RSGIS_PXL_INDEX_MAGIC[8] = {'R', 'S', 'G', 'I', 'S', 'P', 'X', 'I'};
+    static const unsigned int RSGIS_PXL_INDEX_VERSION( 1 );
+
+    RSGISClassPixelIndex::RSGISClassPixelIndex()
+    {
+        this->imageFile = "";
+        this->imgBand = 0;
+        this->xSize = 0;
+        this->ySize = 0;
+        for(unsigned int i = 0; i < 6; ++i)
+        {
+            this->trans[i] = 0;
+        }
+    }
+
+    void RSGISClassPixelIndex::createIndex(GDALDataset *image, unsigned int imgBand)
+    {
+        if((imgBand < 1) || (imgBand > image->GetRasterCount()))
+        {
+            throw RSGISImageException("The band specified is not within the image; note band indexing starts at 1.");
+        }
+
+        this->valueRuns.clear();
+        this->imageFile = std::string(image->GetDescription());
+        this->imgBand = imgBand;
+        this->xSize = image->GetRasterXSize();
+        this->ySize = image->GetRasterYSize();
+        image->GetGeoTransform(this->trans);
+
+        GDALRasterBand *band = image->GetRasterBand(imgBand);
+        int blockXSize = 0;
+        int blockYSize = 0;
+        band->GetBlockSize(&blockXSize, &blockYSize);
+        unsigned int stripRows = std::max((unsigned int)blockYSize, RSGIS_PXL_INDEX_STRIP_ROWS);
+
+        std::vector<int> data(((size_t)stripRows) * this->xSize);
+        for(unsigned int yOff = 0; yOff < this->ySize; yOff += stripRows)
+        {
+            unsigned int nRows = std::min(stripRows, this->ySize - yOff);
+            if(band->RasterIO(GF_Read, 0, yOff, this->xSize, nRows, data.data(), this->xSize, nRows, GDT_Int32, 0, 0) != CE_None)
+            {
+                throw RSGISImageException("Could not read the image band to build the pixel index.");
+            }
+
+            for(unsigned int y = 0; y < nRows; ++y)
+            {
+                int *rowData = &data[((size_t)y) * this->xSize];
+                unsigned int xStart = 0;
+                for(unsigned int x = 1; x <= this->xSize; ++x)
+                {
+                    if((x == this->xSize) || (rowData[x] != rowData[xStart]))
+                    {
+                        this->addRun(rowData[xStart], yOff + y, xStart, x - xStart);
+                        xStart = x;
+                    }
+                }
+            }
+        }
+    }
+
+    void RSGISClassPixelIndex::loadOrCreateIndex(GDALDataset *image, unsigned int imgBand)
+    {
+        std::string sidecarFile = RSGISClassPixelIndex::getSidecarFilePath(image, imgBand);
+        if((sidecarFile != "") && boost::filesystem::exists(sidecarFile))
+        {
+            if(this->loadIndex(sidecarFile, image, imgBand))
+            {
+                return;
+            }
+            std::cerr << "WARNING: The pixel index '" << sidecarFile << "' does not match the image so is being ignored.\n";
+        }
+        this->createIndex(image, imgBand);
+    }
+
+    void RSGISClassPixelIndex::saveSidecar()
+    {
+        if(this->imgBand == 0)
+        {
+            throw RSGISImageException("The pixel index has not been created.");
+        }
+        this->saveIndex(this->imageFile + std::string(".b") + std::to_string(this->imgBand) + std::string(".pxlidx"));
+    }
+
+    void RSGISClassPixelIndex::saveIndex(std::string outputFile)
+    {
+        unsigned long long fileSize = 0;
+        long long fileTime = 0;
+        if(this->imgBand == 0)
+        {
+            throw RSGISImageException("The pixel index has not been created.");
+        }
+        if(!boost::filesystem::is_regular_file(this->imageFile))
+        {
+            throw RSGISImageException("The pixel index can only be saved for an image file: " + this->imageFile);
+        }
+        fileSize = boost::filesystem::file_size(this->imageFile);
+        fileTime = boost::filesystem::last_write_time(this->imageFile);
+
+        std::ofstream outFile(outputFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if(!outFile.is_open())
+        {
+            throw RSGISImageException("Could not create the pixel index file: " + outputFile);
+        }
+
+        unsigned long long nVals = this->valueRuns.size();
+        outFile.write(RSGIS_PXL_INDEX_MAGIC, 8);
+        outFile.write((char*)&RSGIS_PXL_INDEX_VERSION, sizeof(unsigned int));
+        outFile.write((char*)&this->imgBand, sizeof(unsigned int));
+        outFile.write((char*)&this->xSize, sizeof(unsigned int));
+        outFile.write((char*)&this->ySize, sizeof(unsigned int));
+        outFile.write((char*)this->trans, 6 * sizeof(double));
+        outFile.write((char*)&fileSize, sizeof(unsigned long long));
+        outFile.write((char*)&fileTime, sizeof(long long));
+        outFile.write((char*)&nVals, sizeof(unsigned long long));
+        for(std::map<long, RSGISValueRuns>::iterator iterVal = this->valueRuns.begin(); iterVal != this->valueRuns.end(); ++iterVal)
+        {
+            long long val = iterVal->first;
+            unsigned long long nRuns = iterVal->second.runs.size();
+            outFile.write((char*)&val, sizeof(long long));
+            outFile.write((char*)&nRuns, sizeof(unsigned long long));
+            for(std::vector<RSGISPixelRun>::iterator iterRun = iterVal->second.runs.begin(); iterRun != iterVal->second.runs.end(); ++iterRun)
+            {
+                outFile.write((char*)&(*iterRun).row, sizeof(unsigned int));
+                outFile.write((char*)&(*iterRun).xStart, sizeof(unsigned int));
+                outFile.write((char*)&(*iterRun).nPxls, sizeof(unsigned int));
+            }
+        }
+        outFile.flush();
+        if(!outFile.good())
+        {
+            throw RSGISImageException("Could not write the pixel index file: " + outputFile);
+        }
+        outFile.close();
+    }
+
+    bool RSGISClassPixelIndex::loadIndex(std::string inputFile, GDALDataset *image, unsigned int imgBand)
+    {
+        std::string fileName = "";
+        unsigned long long fileSize = 0;
+        long long fileTime = 0;
+        if(!RSGISClassPixelIndex::getImageFileInfo(image, &fileName, &fileSize, &fileTime))
+        {
+            return false;
+        }
+
+        std::ifstream inFile(inputFile.c_str(), std::ios::in | std::ios::binary);
+        if(!inFile.is_open())
+        {
+            return false;
+        }
+
+        char magic[8];
+        unsigned int version = 0;
+        unsigned int inBand = 0;
+        unsigned int inXSize = 0;
+        unsigned int inYSize = 0;
+        double inTrans[6];
+        unsigned long long inFileSize = 0;
+        long long inFileTime = 0;
+        unsigned long long nVals = 0;
+        inFile.read(magic, 8);
+        inFile.read((char*)&version, sizeof(unsigned int));
+        inFile.read((char*)&inBand, sizeof(unsigned int));
+        inFile.read((char*)&inXSize, sizeof(unsigned int));
+        inFile.read((char*)&inYSize, sizeof(unsigned int));
+        inFile.read((char*)inTrans, 6 * sizeof(double));
+        inFile.read((char*)&inFileSize, sizeof(unsigned long long));
+        inFile.read((char*)&inFileTime, sizeof(long long));
+        inFile.read((char*)&nVals, sizeof(unsigned long long));
+        if(!inFile.good())
+        {
+            return false;
+        }
+
+        // The index is only used if the image has not been modified since the index was saved.
+        double imgTrans[6];
+        image->GetGeoTransform(imgTrans);
+        if(!std::equal(magic, magic + 8, RSGIS_PXL_INDEX_MAGIC) || (version != RSGIS_PXL_INDEX_VERSION) || (inBand != imgBand) ||
+           (inXSize != (unsigned int)image->GetRasterXSize()) || (inYSize != (unsigned int)image->GetRasterYSize()) ||
+           !std::equal(inTrans, inTrans + 6, imgTrans) || (inFileSize != fileSize) || (inFileTime != fileTime))
+        {
+            return false;
+        }
+
+        this->valueRuns.clear();
+        RSGISPixelRun run;
+        for(unsigned long long i = 0; i < nVals; ++i)
+        {
+            long long val = 0;
+            unsigned long long nRuns = 0;
+            inFile.read((char*)&val, sizeof(long long));
+            inFile.read((char*)&nRuns, sizeof(unsigned long long));
+            for(unsigned long long j = 0; (j < nRuns) && inFile.good(); ++j)
+            {
+                inFile.read((char*)&run.row, sizeof(unsigned int));
+                inFile.read((char*)&run.xStart, sizeof(unsigned int));
+                inFile.read((char*)&run.nPxls, sizeof(unsigned int));
+                this->addRun(val, run.row, run.xStart, run.nPxls);
+            }
+            if(!inFile.good())
+            {
+                this->valueRuns.clear();
+                return false;
+            }
+        }
+        inFile.close();
+
+        this->imageFile = fileName;
+        this->imgBand = imgBand;
+        this->xSize = inXSize;
+        this->ySize = inYSize;
+        std::copy(imgTrans, imgTrans + 6, this->trans);
+        return true;
+    }
+
+    std::string RSGISClassPixelIndex::getSidecarFilePath(GDALDataset *image, unsigned int imgBand)
+    {
+        std::string fileName = "";
+        unsigned long long fileSize = 0;
+        long long fileTime = 0;
+        if(!RSGISClassPixelIndex::getImageFileInfo(image, &fileName, &fileSize, &fileTime))
+        {
+            return "";
+        }
+        return fileName + std::string(".b") + std::to_string(imgBand) + std::string(".pxlidx");
+    }
+
+    std::vector<long> RSGISClassPixelIndex::getValues()
+    {
+        std::vector<long> vals;
+        for(std::map<long, RSGISValueRuns>::iterator iterVal = this->valueRuns.begin(); iterVal != this->valueRuns.end(); ++iterVal)
+        {
+            vals.push_back(iterVal->first);
+        }
+        return vals;
+    }
+
+    size_t RSGISClassPixelIndex::getNumPxls(long val)
+    {
+        std::map<long, RSGISValueRuns>::iterator iterVal = this->valueRuns.find(val);
+        if(iterVal == this->valueRuns.end())
+        {
+            return 0;
+        }
+        return iterVal->second.nPxls;
+    }
+
+    size_t RSGISClassPixelIndex::getNumPxls(std::vector<long> vals)
+    {
+        size_t nPxls = 0;
+        for(std::vector<long>::iterator iterVal = vals.begin(); iterVal != vals.end(); ++iterVal)
+        {
+            nPxls += this->getNumPxls(*iterVal);
+        }
+        return nPxls;
+    }
+
+    const std::vector<RSGISPixelRun>* RSGISClassPixelIndex::getRuns(long val)
+    {
+        std::map<long, RSGISValueRuns>::iterator iterVal = this->valueRuns.find(val);
+        if(iterVal == this->valueRuns.end())
+        {
+            return NULL;
+        }
+        return &iterVal->second.runs;
+    }
+
+    void RSGISClassPixelIndex::getPixel(long val, size_t pxlIdx, unsigned int *x, unsigned int *y)
+    {
+        std::map<long, RSGISValueRuns>::iterator iterVal = this->valueRuns.find(val);
+        if((iterVal == this->valueRuns.end()) || (pxlIdx >= iterVal->second.nPxls))
+        {
+            throw RSGISImageException("The pixel index is not within the pixels of the value.");
+        }
+        RSGISValueRuns *vRuns = &iterVal->second;
+        size_t runIdx = (std::upper_bound(vRuns->cumPxls.begin(), vRuns->cumPxls.end(), pxlIdx) - vRuns->cumPxls.begin()) - 1;
+        *x = vRuns->runs[runIdx].xStart + (pxlIdx - vRuns->cumPxls[runIdx]);
+        *y = vRuns->runs[runIdx].row;
+    }
+
+    void RSGISClassPixelIndex::getPixel(std::vector<long> vals, size_t pxlIdx, unsigned int *x, unsigned int *y)
+    {
+        for(std::vector<long>::iterator iterVal = vals.begin(); iterVal != vals.end(); ++iterVal)
+        {
+            size_t nPxls = this->getNumPxls(*iterVal);
+            if(pxlIdx < nPxls)
+            {
+                this->getPixel(*iterVal, pxlIdx, x, y);
+                return;
+            }
+            pxlIdx -= nPxls;
+        }
+        throw RSGISImageException("The pixel index is not within the pixels of the values.");
+    }
+
+    void RSGISClassPixelIndex::getPixelCentre(std::vector<long> vals, size_t pxlIdx, double *x, double *y)
+    {
+        unsigned int col = 0;
+        unsigned int row = 0;
+        this->getPixel(vals, pxlIdx, &col, &row);
+        *x = this->trans[0] + ((col + 0.5) * this->trans[1]) + ((row + 0.5) * this->trans[2]);
+        *y = this->trans[3] + ((col + 0.5) * this->trans[4]) + ((row + 0.5) * this->trans[5]);
+    }
+
+    bool RSGISClassPixelIndex::getImageFileInfo(GDALDataset *image, std::string *fileName, unsigned long long *fileSize, long long *fileTime)
+    {
+        *fileName = std::string(image->GetDescription());
+        if((*fileName == "") || !boost::filesystem::is_regular_file(*fileName))
+        {
+            return false;
+        }
+        *fileSize = boost::filesystem::file_size(*fileName);
+        *fileTime = boost::filesystem::last_write_time(*fileName);
+        return true;
+    }
+
+    void RSGISClassPixelIndex::addRun(long val, unsigned int row, unsigned int xStart, unsigned int nPxls)
+    {
+        std::map<long, RSGISValueRuns>::iterator iterVal = this->valueRuns.find(val);
+        if(iterVal == this->valueRuns.end())
+        {
+            RSGISValueRuns vRuns;
+            vRuns.nPxls = 0;
+            iterVal = this->valueRuns.insert(std::pair<long, RSGISValueRuns>(val, vRuns)).first;
+        }
+        RSGISPixelRun run;
+        run.row = row;
+        run.xStart = xStart;
+        run.nPxls = nPxls;
+        iterVal->second.runs.push_back(run);
+        iterVal->second.cumPxls.push_back(iterVal->second.nPxls);
+        iterVal->second.nPxls += nPxls;
+    }
+
+    RSGISClassPixelIndex::~RSGISClassPixelIndex()
+    {
+
+    }
+
+}}
@@ -0,0 +1,125 @@
+/*
+ *  RSGISClassPixelIndex.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISClassPixelIndex_H
+#define RSGISClassPixelIndex_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISImageException.h"
+
+#include <boost/filesystem.hpp>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+
+    static const unsigned int RSGIS_PXL_INDEX_STRIP_ROWS( 256 );
+
+    /**
+     * A run of nPxls pixels on a row of the image, starting at column xStart.
+     */
+    struct DllExport RSGISPixelRun
+    {
+        unsigned int row;
+        unsigned int xStart;
+        unsigned int nPxls;
+    };
+
+    /**
+     * A sparse index of the pixel locations of each value within an integer
+     * (e.g., class or mask) image band. The pixels of each value are stored as
+     * runs ordered by row and then column (i.e., the order the image is scanned),
+     * so the n'th pixel of a value or the rows containing a value can be found
+     * without reading the image again.
+     *
+     * The index can be saved as a sidecar file alongside the image (see
+     * getSidecarFilePath), which is used in place of scanning the image while
+     * the image file is unchanged.
+     */
+    class DllExport RSGISClassPixelIndex
+    {
+    public:
+        RSGISClassPixelIndex();
+        /** Build the index by reading the image band, in strips, once. */
+        void createIndex(GDALDataset *image, unsigned int imgBand);
+        /** Load the index from the sidecar file if it exists and matches the image otherwise build it from the image. */
+        void loadOrCreateIndex(GDALDataset *image, unsigned int imgBand);
+        /** Save the index to the sidecar file for the image band it was built from. */
+        void saveSidecar();
+        /** Save the index to a file. */
+        void saveIndex(std::string outputFile);
+        /** Load an index from a file, returning false if the file does not match the image band. */
+        bool loadIndex(std::string inputFile, GDALDataset *image, unsigned int imgBand);
+        static std::string getSidecarFilePath(GDALDataset *image, unsigned int imgBand);
+
+        std::vector<long> getValues();
+        size_t getNumPxls(long val);
+        size_t getNumPxls(std::vector<long> vals);
+        /** Get the runs for a value (NULL if the value is not within the image). */
+        const std::vector<RSGISPixelRun>* getRuns(long val);
+        /** Get the image column and row of the pxlIdx'th pixel of a value. */
+        void getPixel(long val, size_t pxlIdx, unsigned int *x, unsigned int *y);
+        /** Get the image column and row of the pxlIdx'th pixel of the values, with the pixels of the values concatenated in the order given. */
+        void getPixel(std::vector<long> vals, size_t pxlIdx, unsigned int *x, unsigned int *y);
+        /** Get the coordinate of the centre of the pxlIdx'th pixel of the values. */
+        void getPixelCentre(std::vector<long> vals, size_t pxlIdx, double *x, double *y);
+        ~RSGISClassPixelIndex();
+    protected:
+        struct RSGISValueRuns
+        {
+            std::vector<RSGISPixelRun> runs;
+            // The number of pixels in the runs before each run.
+            std::vector<size_t> cumPxls;
+            size_t nPxls;
+        };
+        static bool getImageFileInfo(GDALDataset *image, std::string *fileName, unsigned long long *fileSize, long long *fileTime);
+        void addRun(long val, unsigned int row, unsigned int xStart, unsigned int nPxls);
+        std::map<long, RSGISValueRuns> valueRuns;
+        std::string imageFile;
+        unsigned int imgBand;
+        unsigned int xSize;
+        unsigned int ySize;
+        double trans[6];
+    };
+
+}}
+
+#endif
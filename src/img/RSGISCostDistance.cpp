@@ -0,0 +1,570 @@
+/*
+ *  RSGISCostDistance.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISCostDistance.h"
+
+namespace rsgis{namespace img{
+    
+    /** The (x, y) offsets of the 8 neighbours; direction value d refers to neighbour d-1. */
+    static const int costDistNbrXOff[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+    static const int costDistNbrYOff[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+    
+    /** A binary heap with the same interface as RSGISBucketPxlQueue, used when the costs can be zero. */
+    class RSGISCostPxlHeap
+    {
+    public:
+        void push(double key, uint64_t idx){this->pxlQ.push(std::pair<double, uint64_t>(key, idx));};
+        bool pop(double *key, uint64_t *idx)
+        {
+            if(this->pxlQ.empty())
+            {
+                return false;
+            }
+            *key = this->pxlQ.top().first;
+            *idx = this->pxlQ.top().second;
+            this->pxlQ.pop();
+            return true;
+        };
+        bool empty(){return this->pxlQ.empty();};
+    protected:
+        std::priority_queue<std::pair<double, uint64_t>, std::vector<std::pair<double, uint64_t> >, std::greater<std::pair<double, uint64_t> > > pxlQ;
+    };
+    
+    RSGISBucketPxlQueue::RSGISBucketPxlQueue(double bucketWidth, size_t numBuckets)
+    {
+        if(!(bucketWidth > 0) || (numBuckets == 0))
+        {
+            throw RSGISImageCalcException("The bucket width and number of buckets must be greater than zero.");
+        }
+        this->bucketWidth = bucketWidth;
+        this->numBuckets = numBuckets;
+        this->buckets.resize(numBuckets);
+        this->curBucket = 0;
+        this->baseBucket = 0;
+        this->numInBuckets = 0;
+    }
+    
+    void RSGISBucketPxlQueue::push(double key, uint64_t idx)
+    {
+        // Keys lower than the current bucket (i.e., the last key popped) go into the current bucket.
+        long bucket = std::max((long)std::floor(key / this->bucketWidth), this->baseBucket);
+        size_t bucketOff = bucket - this->baseBucket;
+        if(bucketOff < this->numBuckets)
+        {
+            this->buckets[(this->curBucket + bucketOff) % this->numBuckets].push_back(RSGISKeyPxl(key, idx));
+            ++this->numInBuckets;
+        }
+        else
+        {
+            this->overflow.push(RSGISKeyPxl(key, idx));
+        }
+    }
+    
+    bool RSGISBucketPxlQueue::pop(double *key, uint64_t *idx)
+    {
+        if(this->numInBuckets == 0)
+        {
+            if(this->overflow.empty())
+            {
+                return false;
+            }
+            // Jump the buckets forward to the lowest pixel within the overflow.
+            this->baseBucket = (long)std::floor(this->overflow.top().first / this->bucketWidth);
+            this->fillFromOverflow();
+        }
+        while(this->buckets[this->curBucket].empty())
+        {
+            this->curBucket = (this->curBucket + 1) % this->numBuckets;
+            ++this->baseBucket;
+            this->fillFromOverflow();
+        }
+        std::vector<RSGISKeyPxl> &bucket = this->buckets[this->curBucket];
+        *key = bucket.back().first;
+        *idx = bucket.back().second;
+        bucket.pop_back();
+        --this->numInBuckets;
+        return true;
+    }
+    
+    void RSGISBucketPxlQueue::fillFromOverflow()
+    {
+        while(!this->overflow.empty())
+        {
+            long bucket = (long)std::floor(this->overflow.top().first / this->bucketWidth);
+            size_t bucketOff = std::max(bucket - this->baseBucket, 0L);
+            if(bucketOff >= this->numBuckets)
+            {
+                break;
+            }
+            this->buckets[(this->curBucket + bucketOff) % this->numBuckets].push_back(this->overflow.top());
+            ++this->numInBuckets;
+            this->overflow.pop();
+        }
+    }
+    
+    
+    RSGISCostDistance::RSGISCostDistance(bool useNoData, double noDataVal)
+    {
+        this->useNoData = useNoData;
+        this->noDataVal = noDataVal;
+        this->xRes = 1;
+        this->yRes = 1;
+        this->imgWidth = 0;
+        this->imgHeight = 0;
+    }
+    
+    bool RSGISCostDistance::isPassable(float cost) const
+    {
+        if(!std::isfinite(cost) || (cost < 0))
+        {
+            return false;
+        }
+        if(this->useNoData && (cost == ((float)this->noDataVal)))
+        {
+            return false;
+        }
+        return true;
+    }
+    
+    void RSGISCostDistance::calcCostDistance(GDALDataset *costDS, unsigned int costBand, GDALDataset *srcDS, std::vector<std::pair<unsigned int, unsigned int> > srcPxls, GDALDataset *outDistDS, GDALDataset *outDirDS, unsigned int tileSize)
+    {
+        if((costBand == 0) || (costBand > (unsigned int)costDS->GetRasterCount()))
+        {
+            throw RSGISImageCalcException("The cost image band is not within the image.");
+        }
+        this->imgWidth = costDS->GetRasterXSize();
+        this->imgHeight = costDS->GetRasterYSize();
+        
+        GDALDataset *checkDS[3] = {srcDS, outDistDS, outDirDS};
+        for(unsigned int i = 0; i < 3; ++i)
+        {
+            if((checkDS[i] != NULL) && ((checkDS[i]->GetRasterXSize() != (int)this->imgWidth) || (checkDS[i]->GetRasterYSize() != (int)this->imgHeight)))
+            {
+                throw RSGISImageCalcException("The images must have the same number of pixels as the cost image.");
+            }
+        }
+        if((outDistDS == NULL) || (outDirDS == NULL))
+        {
+            throw RSGISImageCalcException("The distance and direction images must be provided.");
+        }
+        for(size_t i = 0; i < srcPxls.size(); ++i)
+        {
+            if((srcPxls[i].first >= this->imgWidth) || (srcPxls[i].second >= this->imgHeight))
+            {
+                throw RSGISImageCalcException("A source pixel is outside of the cost image.");
+            }
+        }
+        
+        double geoTrans[6];
+        costDS->GetGeoTransform(geoTrans);
+        this->xRes = std::fabs(geoTrans[1]);
+        this->yRes = std::fabs(geoTrans[5]);
+        if((this->xRes == 0) || (this->yRes == 0))
+        {
+            this->xRes = 1;
+            this->yRes = 1;
+        }
+        
+        GDALRasterBand *costImgBand = costDS->GetRasterBand(costBand);
+        GDALRasterBand *srcImgBand = (srcDS != NULL)?srcDS->GetRasterBand(1):NULL;
+        GDALRasterBand *distBand = outDistDS->GetRasterBand(1);
+        GDALRasterBand *dirBand = outDirDS->GetRasterBand(1);
+        distBand->SetNoDataValue(RSGIS_COSTDIST_DIST_NODATA);
+        dirBand->SetNoDataValue(RSGIS_COSTDIST_NODATA);
+        
+        if((tileSize == 0) || ((tileSize >= this->imgWidth) && (tileSize >= this->imgHeight)))
+        {
+            tileSize = std::max(this->imgWidth, this->imgHeight);
+        }
+        unsigned int nTilesX = (this->imgWidth + tileSize - 1) / tileSize;
+        unsigned int nTilesY = (this->imgHeight + tileSize - 1) / tileSize;
+        size_t nTiles = ((size_t)nTilesX) * nTilesY;
+        
+        // Initialise the tiles with the sources (on passable pixels); the tiles with a source are processed first.
+        std::deque<size_t> tileQ;
+        std::vector<bool> tileInQ(nTiles, false);
+        std::vector<bool> tileHasSrc(nTiles, false);
+        bool edgeChanged[8];
+        for(size_t t = 0; t < nTiles; ++t)
+        {
+            RSGISCostDistanceTile tile;
+            tile.xOff = (t % nTilesX) * tileSize;
+            tile.yOff = (t / nTilesX) * tileSize;
+            tile.xSize = std::min(tileSize, this->imgWidth - tile.xOff);
+            tile.ySize = std::min(tileSize, this->imgHeight - tile.yOff);
+            size_t haloWidth = tile.xSize + 2;
+            size_t nHaloPxls = haloWidth * (tile.ySize + 2);
+            this->readTile(&tile, costImgBand, NULL, NULL);
+            tile.dist.assign(nHaloPxls, std::numeric_limits<double>::infinity());
+            tile.dir.assign(nHaloPxls, RSGIS_COSTDIST_NODATA);
+            
+            std::vector<float> srcData;
+            if(srcImgBand != NULL)
+            {
+                srcData.resize(((size_t)tile.xSize) * tile.ySize);
+                srcImgBand->RasterIO(GF_Read, tile.xOff, tile.yOff, tile.xSize, tile.ySize, srcData.data(), tile.xSize, tile.ySize, GDT_Float32, 0, 0);
+            }
+            bool hasSrc = false;
+            for(size_t i = 0; i < srcData.size(); ++i)
+            {
+                size_t hIdx = (((i / tile.xSize) + 1) * haloWidth) + ((i % tile.xSize) + 1);
+                if((srcData[i] != 0) && !std::isnan(srcData[i]) && !std::isnan(tile.cost[hIdx]))
+                {
+                    tile.dist[hIdx] = 0;
+                    tile.dir[hIdx] = RSGIS_COSTDIST_SOURCE;
+                    hasSrc = true;
+                }
+            }
+            for(size_t i = 0; i < srcPxls.size(); ++i)
+            {
+                if((srcPxls[i].first >= tile.xOff) && (srcPxls[i].first < (tile.xOff + tile.xSize)) && (srcPxls[i].second >= tile.yOff) && (srcPxls[i].second < (tile.yOff + tile.ySize)))
+                {
+                    size_t hIdx = (((size_t)(srcPxls[i].second - tile.yOff + 1)) * haloWidth) + (srcPxls[i].first - tile.xOff + 1);
+                    if(!std::isnan(tile.cost[hIdx]))
+                    {
+                        tile.dist[hIdx] = 0;
+                        tile.dir[hIdx] = RSGIS_COSTDIST_SOURCE;
+                        hasSrc = true;
+                    }
+                }
+            }
+            
+            if(nTiles == 1)
+            {
+                // The whole image is in memory so is processed directly.
+                this->floodTile(&tile, edgeChanged);
+                this->writeTile(&tile, distBand, dirBand);
+                return;
+            }
+            
+            this->writeTile(&tile, distBand, dirBand);
+            if(hasSrc)
+            {
+                tileQ.push_back(t);
+                tileInQ[t] = true;
+                tileHasSrc[t] = true;
+            }
+        }
+        
+        // Process the tiles until the distances along the tile edges no longer change.
+        const int tileXOff[8] = {0, 0, -1, 1, -1, 1, -1, 1};
+        const int tileYOff[8] = {-1, 1, 0, 0, -1, -1, 1, 1};
+        unsigned long nTileRuns = 0;
+        while(!tileQ.empty())
+        {
+            size_t t = tileQ.front();
+            tileQ.pop_front();
+            tileInQ[t] = false;
+            
+            RSGISCostDistanceTile tile;
+            tile.xOff = (t % nTilesX) * tileSize;
+            tile.yOff = (t / nTilesX) * tileSize;
+            tile.xSize = std::min(tileSize, this->imgWidth - tile.xOff);
+            tile.ySize = std::min(tileSize, this->imgHeight - tile.yOff);
+            this->readTile(&tile, costImgBand, distBand, dirBand);
+            ++nTileRuns;
+            bool tileChanged = this->floodTile(&tile, edgeChanged);
+            if(tileChanged)
+            {
+                this->writeTile(&tile, distBand, dirBand);
+            }
+            if(tileHasSrc[t])
+            {
+                // The sources may be on the edge of the tile, so the neighbours are always processed.
+                std::fill(edgeChanged, edgeChanged + 8, true);
+                tileChanged = true;
+                tileHasSrc[t] = false;
+            }
+            if(tileChanged)
+            {
+                long tX = t % nTilesX;
+                long tY = t / nTilesX;
+                for(int e = 0; e < 8; ++e)
+                {
+                    long nX = tX + tileXOff[e];
+                    long nY = tY + tileYOff[e];
+                    if(edgeChanged[e] && (nX >= 0) && (nX < (long)nTilesX) && (nY >= 0) && (nY < (long)nTilesY))
+                    {
+                        size_t nT = (nY * nTilesX) + nX;
+                        if(!tileInQ[nT])
+                        {
+                            tileQ.push_back(nT);
+                            tileInQ[nT] = true;
+                        }
+                    }
+                }
+            }
+        }
+        std::cout << "Processed " << nTileRuns << " tiles (" << nTiles << " tiles in the image)" << std::endl;
+    }
+    
+    void RSGISCostDistance::readTile(RSGISCostDistanceTile *tile, GDALRasterBand *costBand, GDALRasterBand *distBand, GDALRasterBand *dirBand)
+    {
+        size_t haloWidth = tile->xSize + 2;
+        size_t nHaloPxls = haloWidth * (tile->ySize + 2);
+        tile->cost.assign(nHaloPxls, std::numeric_limits<float>::quiet_NaN());
+        
+        // Read the tile and the halo (clipped to the image).
+        unsigned int readXOff = (tile->xOff > 0)?(tile->xOff-1):0;
+        unsigned int readYOff = (tile->yOff > 0)?(tile->yOff-1):0;
+        unsigned int readXEnd = std::min(tile->xOff + tile->xSize + 1, this->imgWidth);
+        unsigned int readYEnd = std::min(tile->yOff + tile->ySize + 1, this->imgHeight);
+        unsigned int readXSize = readXEnd - readXOff;
+        unsigned int readYSize = readYEnd - readYOff;
+        size_t nReadPxls = ((size_t)readXSize) * readYSize;
+        
+        std::vector<float> costData(nReadPxls);
+        costBand->RasterIO(GF_Read, readXOff, readYOff, readXSize, readYSize, costData.data(), readXSize, readYSize, GDT_Float32, 0, 0);
+        std::vector<double> distData;
+        if(distBand != NULL)
+        {
+            tile->dist.assign(nHaloPxls, std::numeric_limits<double>::infinity());
+            distData.resize(nReadPxls);
+            distBand->RasterIO(GF_Read, readXOff, readYOff, readXSize, readYSize, distData.data(), readXSize, readYSize, GDT_Float64, 0, 0);
+        }
+        for(unsigned int y = 0; y < readYSize; ++y)
+        {
+            for(unsigned int x = 0; x < readXSize; ++x)
+            {
+                size_t hIdx = (((size_t)((readYOff + y + 1) - tile->yOff)) * haloWidth) + ((readXOff + x + 1) - tile->xOff);
+                size_t rIdx = (((size_t)y) * readXSize) + x;
+                tile->cost[hIdx] = this->isPassable(costData[rIdx])?costData[rIdx]:std::numeric_limits<float>::quiet_NaN();
+                if((distBand != NULL) && (distData[rIdx] >= 0))
+                {
+                    tile->dist[hIdx] = distData[rIdx];
+                }
+            }
+        }
+        
+        if(dirBand != NULL)
+        {
+            tile->dir.assign(nHaloPxls, RSGIS_COSTDIST_NODATA);
+            std::vector<unsigned char> dirData(((size_t)tile->xSize) * tile->ySize);
+            dirBand->RasterIO(GF_Read, tile->xOff, tile->yOff, tile->xSize, tile->ySize, dirData.data(), tile->xSize, tile->ySize, GDT_Byte, 0, 0);
+            for(unsigned int y = 0; y < tile->ySize; ++y)
+            {
+                std::copy(dirData.begin() + (((size_t)y) * tile->xSize), dirData.begin() + (((size_t)(y+1)) * tile->xSize), tile->dir.begin() + (((y + 1) * haloWidth) + 1));
+            }
+        }
+    }
+    
+    void RSGISCostDistance::writeTile(RSGISCostDistanceTile *tile, GDALRasterBand *distBand, GDALRasterBand *dirBand)
+    {
+        size_t haloWidth = tile->xSize + 2;
+        std::vector<double> distData(((size_t)tile->xSize) * tile->ySize);
+        std::vector<unsigned char> dirData(distData.size());
+        for(unsigned int y = 0; y < tile->ySize; ++y)
+        {
+            for(unsigned int x = 0; x < tile->xSize; ++x)
+            {
+                size_t hIdx = ((y + 1) * haloWidth) + (x + 1);
+                size_t tIdx = (((size_t)y) * tile->xSize) + x;
+                distData[tIdx] = std::isfinite(tile->dist[hIdx])?tile->dist[hIdx]:RSGIS_COSTDIST_DIST_NODATA;
+                dirData[tIdx] = tile->dir[hIdx];
+            }
+        }
+        distBand->RasterIO(GF_Write, tile->xOff, tile->yOff, tile->xSize, tile->ySize, distData.data(), tile->xSize, tile->ySize, GDT_Float64, 0, 0);
+        dirBand->RasterIO(GF_Write, tile->xOff, tile->yOff, tile->xSize, tile->ySize, dirData.data(), tile->xSize, tile->ySize, GDT_Byte, 0, 0);
+    }
+    
+    bool RSGISCostDistance::floodTile(RSGISCostDistanceTile *tile, bool *edgeChanged)
+    {
+        // The bucket queue is exact if the bucket width is not greater than the smallest
+        // edge cost, so a heap is used if a cost is zero or there would be too many buckets.
+        float minCost = std::numeric_limits<float>::max();
+        float maxCost = 0;
+        for(size_t i = 0; i < tile->cost.size(); ++i)
+        {
+            if(!std::isnan(tile->cost[i]))
+            {
+                minCost = std::min(minCost, tile->cost[i]);
+                maxCost = std::max(maxCost, tile->cost[i]);
+            }
+        }
+        double bucketWidth = ((double)minCost) * std::min(this->xRes, this->yRes);
+        double maxEdgeCost = ((double)maxCost) * std::sqrt((this->xRes * this->xRes) + (this->yRes * this->yRes));
+        if((minCost <= maxCost) && (bucketWidth > 0) && ((maxEdgeCost / bucketWidth) < 1048576.0))
+        {
+            RSGISBucketPxlQueue pxlQ(bucketWidth, ((size_t)(maxEdgeCost / bucketWidth)) + 2);
+            return this->floodTileQueue(tile, pxlQ, edgeChanged);
+        }
+        RSGISCostPxlHeap pxlQ;
+        return this->floodTileQueue(tile, pxlQ, edgeChanged);
+    }
+    
+    template<typename Queue> bool RSGISCostDistance::floodTileQueue(RSGISCostDistanceTile *tile, Queue &pxlQ, bool *edgeChanged)
+    {
+        const long haloWidth = tile->xSize + 2;
+        const long haloHeight = tile->ySize + 2;
+        for(int e = 0; e < 8; ++e)
+        {
+            edgeChanged[e] = false;
+        }
+        
+        double nbrStep[8];
+        long nbrIdxOff[8];
+        for(int n = 0; n < 8; ++n)
+        {
+            nbrStep[n] = std::sqrt((costDistNbrXOff[n] * costDistNbrXOff[n] * this->xRes * this->xRes) + (costDistNbrYOff[n] * costDistNbrYOff[n] * this->yRes * this->yRes));
+            nbrIdxOff[n] = (costDistNbrYOff[n] * haloWidth) + costDistNbrXOff[n];
+        }
+        
+        // Seed from every pixel with a distance, including the halo from the neighbouring tiles.
+        for(long i = 0; i < haloWidth * haloHeight; ++i)
+        {
+            if(std::isfinite(tile->dist[i]) && !std::isnan(tile->cost[i]))
+            {
+                pxlQ.push(tile->dist[i], i);
+            }
+        }
+        
+        bool changed = false;
+        double pxlDist = 0;
+        uint64_t pxlIdx = 0;
+        while(pxlQ.pop(&pxlDist, &pxlIdx))
+        {
+            if(pxlDist > tile->dist[pxlIdx])
+            {
+                // An out of date entry; the pixel has already been reached with a lower cost.
+                continue;
+            }
+            long pX = pxlIdx % haloWidth;
+            long pY = pxlIdx / haloWidth;
+            float pxlCost = tile->cost[pxlIdx];
+            for(int n = 0; n < 8; ++n)
+            {
+                long nX = pX + costDistNbrXOff[n];
+                long nY = pY + costDistNbrYOff[n];
+                if((nX < 1) || (nX > (long)tile->xSize) || (nY < 1) || (nY > (long)tile->ySize))
+                {
+                    // Only the pixels within the tile are updated.
+                    continue;
+                }
+                long nIdx = pxlIdx + nbrIdxOff[n];
+                float nbrCost = tile->cost[nIdx];
+                if(std::isnan(nbrCost))
+                {
+                    continue;
+                }
+                double nbrDist = pxlDist + ((((double)pxlCost) + nbrCost) / 2.0) * nbrStep[n];
+                if(nbrDist < tile->dist[nIdx])
+                {
+                    tile->dist[nIdx] = nbrDist;
+                    // The direction from the neighbour back to this pixel.
+                    tile->dir[nIdx] = (7 - n) + 1;
+                    pxlQ.push(nbrDist, nIdx);
+                    changed = true;
+                    
+                    bool top = (nY == 1);
+                    bool bottom = (nY == (long)tile->ySize);
+                    bool left = (nX == 1);
+                    bool right = (nX == (long)tile->xSize);
+                    edgeChanged[0] = edgeChanged[0] || top;
+                    edgeChanged[1] = edgeChanged[1] || bottom;
+                    edgeChanged[2] = edgeChanged[2] || left;
+                    edgeChanged[3] = edgeChanged[3] || right;
+                    edgeChanged[4] = edgeChanged[4] || (top && left);
+                    edgeChanged[5] = edgeChanged[5] || (top && right);
+                    edgeChanged[6] = edgeChanged[6] || (bottom && left);
+                    edgeChanged[7] = edgeChanged[7] || (bottom && right);
+                }
+            }
+        }
+        return changed;
+    }
+    
+    std::vector<std::pair<unsigned int, unsigned int> > RSGISCostDistance::extractPath(GDALDataset *dirDS, unsigned int x, unsigned int y, unsigned int blockSize)
+    {
+        unsigned int width = dirDS->GetRasterXSize();
+        unsigned int height = dirDS->GetRasterYSize();
+        if((x >= width) || (y >= height))
+        {
+            throw RSGISImageCalcException("The path end point is outside of the direction image.");
+        }
+        if(blockSize == 0)
+        {
+            blockSize = 256;
+        }
+        GDALRasterBand *dirBand = dirDS->GetRasterBand(1);
+        
+        // Only the block of the direction image the path is currently within is held in memory.
+        std::vector<unsigned char> block;
+        long blockXOff = -1;
+        long blockYOff = -1;
+        unsigned int blockXSize = 0;
+        unsigned int blockYSize = 0;
+        
+        std::vector<std::pair<unsigned int, unsigned int> > path;
+        unsigned long long maxPathLen = ((unsigned long long)width) * height;
+        while(true)
+        {
+            if((x < blockXOff) || (x >= (blockXOff + blockXSize)) || (y < blockYOff) || (y >= (blockYOff + blockYSize)))
+            {
+                blockXOff = (x / blockSize) * blockSize;
+                blockYOff = (y / blockSize) * blockSize;
+                blockXSize = std::min(blockSize, (unsigned int)(width - blockXOff));
+                blockYSize = std::min(blockSize, (unsigned int)(height - blockYOff));
+                block.resize(((size_t)blockXSize) * blockYSize);
+                dirBand->RasterIO(GF_Read, blockXOff, blockYOff, blockXSize, blockYSize, block.data(), blockXSize, blockYSize, GDT_Byte, 0, 0);
+            }
+            
+            path.push_back(std::pair<unsigned int, unsigned int>(x, y));
+            unsigned char dir = block[(((size_t)(y - blockYOff)) * blockXSize) + (x - blockXOff)];
+            if(dir == RSGIS_COSTDIST_SOURCE)
+            {
+                break;
+            }
+            if((dir > 8) || (path.size() > maxPathLen))
+            {
+                throw RSGISImageCalcException("The path end point cannot be reached from a source.");
+            }
+            int xOff = 0;
+            int yOff = 0;
+            getDirectionOffset(dir, &xOff, &yOff);
+            x += xOff;
+            y += yOff;
+            if((x >= width) || (y >= height))
+            {
+                throw RSGISImageCalcException("The direction image leads outside of the image.");
+            }
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+    
+    void RSGISCostDistance::getDirectionOffset(unsigned char dir, int *xOff, int *yOff)
+    {
+        if((dir < 1) || (dir > 8))
+        {
+            throw RSGISImageCalcException("Direction values must be between 1 and 8.");
+        }
+        *xOff = costDistNbrXOff[dir-1];
+        *yOff = costDistNbrYOff[dir-1];
+    }
+    
+    RSGISCostDistance::~RSGISCostDistance()
+    {
+        
+    }
+    
+}}
@@ -0,0 +1,166 @@
+/*
+ *  RSGISCostDistance.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISCostDistance_H
+#define RSGISCostDistance_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <queue>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include <stdint.h>
+
+#include "gdal_priv.h"
+
+#include "common/rsgis-tqdm.h"
+
+#include "img/RSGISImageCalcException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+    
+    /** The direction value of a source pixel within the direction image. */
+    static const unsigned char RSGIS_COSTDIST_SOURCE = 0;
+    /** The direction value of a pixel which cannot be reached from a source. */
+    static const unsigned char RSGIS_COSTDIST_NODATA = 255;
+    /** The distance value of a pixel which cannot be reached from a source. */
+    static const double RSGIS_COSTDIST_DIST_NODATA = -1;
+    
+    /**
+     * A min priority queue of pixels with a (non-negative) floating point priority,
+     * using circular buckets of a fixed width (Dial, 1969; Dinitz, 1978). The pixels
+     * within the lowest bucket are popped in any order, which is exact for Dijkstra's
+     * algorithm if the bucket width is not greater than the smallest edge cost. Pixels
+     * beyond the range of the buckets are held within a heap until they are in range.
+     * Keys pushed below the last key popped are added to the current bucket.
+     */
+    class DllExport RSGISBucketPxlQueue
+    {
+    public:
+        RSGISBucketPxlQueue(double bucketWidth, size_t numBuckets);
+        void push(double key, uint64_t idx);
+        /** Pop a pixel from the lowest bucket. Returns false if the queue is empty. */
+        bool pop(double *key, uint64_t *idx);
+        bool empty(){return (this->numInBuckets == 0) && this->overflow.empty();};
+        ~RSGISBucketPxlQueue(){};
+    protected:
+        typedef std::pair<double, uint64_t> RSGISKeyPxl;
+        void fillFromOverflow();
+        double bucketWidth;
+        size_t numBuckets;
+        std::vector<std::vector<RSGISKeyPxl> > buckets;
+        size_t curBucket;
+        long baseBucket;
+        size_t numInBuckets;
+        std::priority_queue<RSGISKeyPxl, std::vector<RSGISKeyPxl>, std::greater<RSGISKeyPxl> > overflow;
+    };
+    
+    /** A tile of the cost surface (with a 1 pixel halo) processed by RSGISCostDistance. */
+    struct DllExport RSGISCostDistanceTile
+    {
+        unsigned int xOff;
+        unsigned int yOff;
+        unsigned int xSize;
+        unsigned int ySize;
+        std::vector<float> cost;
+        std::vector<double> dist;
+        std::vector<unsigned char> dir;
+    };
+    
+    /**
+     * Calculates the accumulated cost distance from a set of source pixels over a cost
+     * surface using Dijkstra's algorithm on the 8 connected pixel graph. The cost of
+     * moving between neighbouring pixels is the mean of their costs multiplied by the
+     * distance between the pixel centres (in map units), as skimage's route_through_array
+     * with geometric=True. Pixels with a cost which is negative, not finite or the no
+     * data value cannot be crossed.
+     *
+     * The distance image (Float64) is output along with a direction image (Byte) where each
+     * pixel gives the neighbour towards the nearest source (1-8, see getDirectionOffset), so
+     * least cost paths can be extracted (extractPath) without repeating the calculation.
+     *
+     * If a tileSize is provided then only a single tile (with a 1 pixel halo) of the images
+     * is held in memory at a time, for cost surfaces larger than the available memory. A
+     * tile is reprocessed, seeded from the distances of its halo, whenever the distances
+     * along the edge of a neighbouring tile are reduced, until no distances change.
+     */
+    class DllExport RSGISCostDistance
+    {
+    public:
+        RSGISCostDistance(bool useNoData=false, double noDataVal=0);
+        /**
+         * Calculate the cost distance image (outDistDS, GDT_Float64) and the direction image
+         * (outDirDS) for the band of costDS. The sources are the pixels (x, y) within srcPxls
+         * and, if srcDS is not NULL, the pixels with a non-zero value within band 1 of srcDS.
+         */
+        void calcCostDistance(GDALDataset *costDS, unsigned int costBand, GDALDataset *srcDS, std::vector<std::pair<unsigned int, unsigned int> > srcPxls, GDALDataset *outDistDS, GDALDataset *outDirDS, unsigned int tileSize=0);
+        /**
+         * Follow the directions from the pixel (x, y) to the source, returning the path of
+         * pixels from the source to (x, y). The direction image is read in blocks of
+         * blockSize x blockSize pixels.
+         */
+        static std::vector<std::pair<unsigned int, unsigned int> > extractPath(GDALDataset *dirDS, unsigned int x, unsigned int y, unsigned int blockSize=256);
+        /** Get the (x, y) offset to the neighbour given by a direction value (1-8). */
+        static void getDirectionOffset(unsigned char dir, int *xOff, int *yOff);
+        ~RSGISCostDistance();
+    protected:
+        bool isPassable(float cost) const;
+        void readTile(RSGISCostDistanceTile *tile, GDALRasterBand *costBand, GDALRasterBand *distBand, GDALRasterBand *dirBand);
+        void writeTile(RSGISCostDistanceTile *tile, GDALRasterBand *distBand, GDALRasterBand *dirBand);
+        /**
+         * Run Dijkstra's algorithm within the tile, seeded from all the pixels (including the
+         * halo) with a distance. Only the pixels within the tile (not the halo) are updated.
+         * The edges of the tile (0 top, 1 bottom, 2 left, 3 right) and corners (4 top left,
+         * 5 top right, 6 bottom left, 7 bottom right) which changed are set in edgeChanged.
+         * Returns true if any distance within the tile changed.
+         */
+        bool floodTile(RSGISCostDistanceTile *tile, bool *edgeChanged);
+        template<typename Queue> bool floodTileQueue(RSGISCostDistanceTile *tile, Queue &pxlQ, bool *edgeChanged);
+        bool useNoData;
+        double noDataVal;
+        double xRes;
+        double yRes;
+        unsigned int imgWidth;
+        unsigned int imgHeight;
+    };
+    
+}}
+
+#endif
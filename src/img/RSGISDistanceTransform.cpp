@@ -0,0 +1,374 @@
+/*
+ *  RSGISDistanceTransform.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISDistanceTransform.h"
+
+namespace rsgis{namespace img{
+    
+    RSGISDistanceTransform::RSGISDistanceTransform(double maxDist, float noDataVal, bool useGeoUnits)
+    {
+        this->maxDist = maxDist;
+        this->noDataVal = noDataVal;
+        this->useGeoUnits = useGeoUnits;
+        rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+        this->numThreads = context.numThreads;
+        this->numIOBuffers = context.numIOBuffers;
+        this->stripMemoryMB = context.stripMemoryMB;
+    }
+    
+    void RSGISDistanceTransform::calcDistToNearestFeature(GDALRasterBand *labelsBand, double *transform, GDALRasterBand *distBand, GDALRasterBand *nearestLabelBand)
+    {
+        std::vector<uint64_t> classIDs;
+        classIDs.push_back(0);
+        std::vector<GDALRasterBand*> distBands;
+        distBands.push_back(distBand);
+        this->calcDistTransform(labelsBand, transform, true, classIDs, distBands, nearestLabelBand);
+    }
+    
+    void RSGISDistanceTransform::calcDistToClasses(GDALRasterBand *labelsBand, double *transform, std::vector<uint64_t> classIDs, std::vector<GDALRasterBand*> distBands)
+    {
+        if(classIDs.empty())
+        {
+            throw RSGISImageCalcException("At least one class must be provided.");
+        }
+        if(classIDs.size() != distBands.size())
+        {
+            throw RSGISImageCalcException("An output distance band is required for each class.");
+        }
+        this->calcDistTransform(labelsBand, transform, false, classIDs, distBands, NULL);
+    }
+    
+    std::vector<uint64_t> RSGISDistanceTransform::findClassIDs(GDALRasterBand *labelsBand)
+    {
+        unsigned int width = labelsBand->GetXSize();
+        unsigned int height = labelsBand->GetYSize();
+        std::set<uint64_t> classIDs;
+        if((width == 0) || (height == 0))
+        {
+            return std::vector<uint64_t>();
+        }
+        
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        labelsBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), width, height, sizeof(uint64_t), this->stripMemoryMB);
+        size_t nStrips = (height + stripRows - 1) / stripRows;
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        std::vector<std::set<uint64_t> > threadIDs(threadPool.getNumThreads());
+        rsgis::RSGISStripIOPipeline ioPipeline(this->numIOBuffers);
+        std::vector<std::vector<uint64_t> > labels(ioPipeline.getNumBuffers(), std::vector<uint64_t>(((size_t)width) * stripRows));
+        
+        ioPipeline.run(nStrips, [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            labelsBand->RasterIO(GF_Read, 0, rowStart, width, nRows, labels[buf].data(), width, nRows, GDT_UInt64, 0, 0);
+        },
+        [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            const uint64_t *vals = labels[buf].data();
+            threadPool.parallelFor(0, ((size_t)width) * nRows, [&](unsigned int threadIdx, size_t pStart, size_t pEnd)
+            {
+                std::set<uint64_t> &ids = threadIDs[threadIdx];
+                uint64_t lastVal = 0;
+                for(size_t i = pStart; i < pEnd; ++i)
+                {
+                    if((vals[i] != 0) && (vals[i] != lastVal))
+                    {
+                        ids.insert(vals[i]);
+                        lastVal = vals[i];
+                    }
+                }
+            });
+        },
+        [&](size_t strip, unsigned int buf){});
+        
+        for(std::vector<std::set<uint64_t> >::iterator iterIDs = threadIDs.begin(); iterIDs != threadIDs.end(); ++iterIDs)
+        {
+            classIDs.insert(iterIDs->begin(), iterIDs->end());
+        }
+        return std::vector<uint64_t>(classIDs.begin(), classIDs.end());
+    }
+    
+    void RSGISDistanceTransform::calcDistTransform(GDALRasterBand *labelsBand, double *transform, bool allFeatures, std::vector<uint64_t> classIDs, std::vector<GDALRasterBand*> distBands, GDALRasterBand *nearestLabelBand)
+    {
+        unsigned int width = labelsBand->GetXSize();
+        unsigned int height = labelsBand->GetYSize();
+        for(std::vector<GDALRasterBand*>::iterator iterBand = distBands.begin(); iterBand != distBands.end(); ++iterBand)
+        {
+            if(((*iterBand)->GetXSize() != ((int)width)) || ((*iterBand)->GetYSize() != ((int)height)))
+            {
+                throw RSGISImageCalcException("The output distance image is not the same size as the labels image.");
+            }
+        }
+        if((nearestLabelBand != NULL) && ((nearestLabelBand->GetXSize() != ((int)width)) || (nearestLabelBand->GetYSize() != ((int)height))))
+        {
+            throw RSGISImageCalcException("The output nearest label image is not the same size as the labels image.");
+        }
+        if((width == 0) || (height == 0))
+        {
+            return;
+        }
+        
+        double xRes = 1;
+        double yRes = 1;
+        if(this->useGeoUnits)
+        {
+            xRes = std::fabs(transform[1]);
+            yRes = std::fabs(transform[5]);
+        }
+        unsigned int nClasses = distBands.size();
+        
+        // Without a maximum distance any feature could be the nearest so the image is a single strip.
+        unsigned int haloRows = this->calcHaloRows(height, yRes);
+        unsigned int stripRows = height;
+        if(haloRows < height)
+        {
+            int xBlockSize = 0;
+            int yBlockSize = 0;
+            labelsBand->GetBlockSize(&xBlockSize, &yBlockSize);
+            size_t bytesPerPxl = sizeof(uint64_t) + sizeof(double) + sizeof(int32_t) + (nClasses * sizeof(float)) + ((nearestLabelBand != NULL)?sizeof(uint64_t):0);
+            stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), width, height, bytesPerPxl, this->stripMemoryMB);
+        }
+        size_t stripPxls = ((size_t)width) * stripRows;
+        size_t nStrips = (height + stripRows - 1) / stripRows;
+        
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        rsgis::RSGISStripIOPipeline ioPipeline(this->numIOBuffers);
+        unsigned int nBufs = ioPipeline.getNumBuffers();
+        std::vector<std::vector<uint64_t> > labels(nBufs, std::vector<uint64_t>(((size_t)width) * std::min(stripRows + (2 * haloRows), height)));
+        std::vector<std::vector<std::vector<float> > > dists(nBufs, std::vector<std::vector<float> >(nClasses, std::vector<float>(stripPxls)));
+        std::vector<std::vector<uint64_t> > nearestLabels(nBufs);
+        if(nearestLabelBand != NULL)
+        {
+            nearestLabels.assign(nBufs, std::vector<uint64_t>(stripPxls));
+        }
+        std::vector<double> colSqDist(stripPxls);
+        std::vector<int32_t> colFeatRow(stripPxls);
+        
+        rsgis_tqdm pbar;
+        ioPipeline.run(nStrips, [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            unsigned int bufRowStart = (rowStart > haloRows)?(rowStart - haloRows):0;
+            unsigned int bufRowEnd = std::min(rowStart + nRows + haloRows, height);
+            labelsBand->RasterIO(GF_Read, 0, bufRowStart, width, bufRowEnd - bufRowStart, labels[buf].data(), width, bufRowEnd - bufRowStart, GDT_UInt64, 0, 0);
+        },
+        [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            unsigned int bufRowStart = (rowStart > haloRows)?(rowStart - haloRows):0;
+            unsigned int bufRowEnd = std::min(rowStart + nRows + haloRows, height);
+            pbar.progress(rowStart, height);
+            for(unsigned int i = 0; i < nClasses; ++i)
+            {
+                this->calcStripDist(labels[buf].data(), width, bufRowStart, bufRowEnd, rowStart, nRows, allFeatures, classIDs[i], xRes * xRes, yRes * yRes, &threadPool, &colSqDist, &colFeatRow, dists[buf][i].data(), (nearestLabelBand != NULL)?nearestLabels[buf].data():NULL);
+            }
+        },
+        [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            for(unsigned int i = 0; i < nClasses; ++i)
+            {
+                distBands[i]->RasterIO(GF_Write, 0, rowStart, width, nRows, dists[buf][i].data(), width, nRows, GDT_Float32, 0, 0);
+            }
+            if(nearestLabelBand != NULL)
+            {
+                nearestLabelBand->RasterIO(GF_Write, 0, rowStart, width, nRows, nearestLabels[buf].data(), width, nRows, GDT_UInt64, 0, 0);
+            }
+        });
+        pbar.finish();
+    }
+    
+    void RSGISDistanceTransform::calcStripDist(const uint64_t *labels, unsigned int width, unsigned int bufRowStart, unsigned int bufRowEnd, unsigned int rowStart, unsigned int nRows, bool allFeatures, uint64_t classID, double xRes2, double yRes2, rsgis::RSGISThreadPool *threadPool, std::vector<double> *colSqDist, std::vector<int32_t> *colFeatRow, float *dist, uint64_t *nearestLabels)
+    {
+        const double inf = std::numeric_limits<double>::infinity();
+        unsigned int rowEnd = rowStart + nRows;
+        double *colDist = colSqDist->data();
+        int32_t *featRows = colFeatRow->data();
+        
+        // The nearest feature within each column, from scans down and up the rows (by blocks of columns).
+        threadPool->parallelFor(0, width, [&](unsigned int threadIdx, size_t xStart, size_t xEnd)
+        {
+            std::vector<int64_t> lastFeatRow(xEnd - xStart, -1);
+            for(unsigned int y = bufRowStart; y < rowEnd; ++y)
+            {
+                const uint64_t *row = labels + (((size_t)(y - bufRowStart)) * width);
+                for(size_t x = xStart; x < xEnd; ++x)
+                {
+                    if(allFeatures?(row[x] != 0):(row[x] == classID))
+                    {
+                        lastFeatRow[x - xStart] = y;
+                    }
+                    if(y >= rowStart)
+                    {
+                        featRows[(((size_t)(y - rowStart)) * width) + x] = lastFeatRow[x - xStart];
+                    }
+                }
+            }
+            std::fill(lastFeatRow.begin(), lastFeatRow.end(), -1);
+            for(unsigned int y = bufRowEnd; y > rowStart; --y)
+            {
+                const uint64_t *row = labels + (((size_t)(y - 1 - bufRowStart)) * width);
+                for(size_t x = xStart; x < xEnd; ++x)
+                {
+                    if(allFeatures?(row[x] != 0):(row[x] == classID))
+                    {
+                        lastFeatRow[x - xStart] = y - 1;
+                    }
+                    if(y <= rowEnd)
+                    {
+                        size_t idx = (((size_t)(y - 1 - rowStart)) * width) + x;
+                        int64_t aboveRow = featRows[idx];
+                        int64_t belowRow = lastFeatRow[x - xStart];
+                        int64_t nearRow = aboveRow;
+                        if((belowRow >= 0) && ((aboveRow < 0) || ((belowRow - (y - 1)) < ((y - 1) - aboveRow))))
+                        {
+                            nearRow = belowRow;
+                        }
+                        featRows[idx] = nearRow;
+                        if(nearRow >= 0)
+                        {
+                            double dy = ((double)nearRow) - ((double)(y - 1));
+                            colDist[idx] = yRes2 * dy * dy;
+                        }
+                        else
+                        {
+                            colDist[idx] = inf;
+                        }
+                    }
+                }
+            }
+        });
+        
+        // The lower envelope of the column distances along each row.
+        threadPool->parallelFor(0, nRows, [&](unsigned int threadIdx, size_t rStart, size_t rEnd)
+        {
+            std::vector<double> sqDist(width);
+            std::vector<int32_t> sites(width);
+            std::vector<int32_t> v(width);
+            std::vector<double> z(((size_t)width) + 1);
+            for(size_t r = rStart; r < rEnd; ++r)
+            {
+                size_t rowOff = r * width;
+                calcLowerEnvelope(colDist + rowOff, width, xRes2, sqDist.data(), sites.data(), v.data(), z.data());
+                for(unsigned int x = 0; x < width; ++x)
+                {
+                    double pxlDist = std::sqrt(sqDist[x]);
+                    bool valid = (sites[x] >= 0) && ((this->maxDist <= 0) || (pxlDist <= this->maxDist));
+                    dist[rowOff + x] = valid?((float)pxlDist):this->noDataVal;
+                    if(nearestLabels != NULL)
+                    {
+                        if(valid)
+                        {
+                            int32_t featRow = featRows[rowOff + sites[x]];
+                            nearestLabels[rowOff + x] = labels[(((size_t)(featRow - bufRowStart)) * width) + sites[x]];
+                        }
+                        else
+                        {
+                            nearestLabels[rowOff + x] = 0;
+                        }
+                    }
+                }
+            }
+        });
+    }
+    
+    void RSGISDistanceTransform::calcLowerEnvelope(const double *f, size_t n, double w, double *d, int32_t *site, int32_t *v, double *z)
+    {
+        const double inf = std::numeric_limits<double>::infinity();
+        long k = -1;
+        for(size_t q = 0; q < n; ++q)
+        {
+            if(f[q] == inf)
+            {
+                continue;
+            }
+            double fq = f[q] + (w * ((double)q) * ((double)q));
+            double s = -inf;
+            while(k >= 0)
+            {
+                double p = v[k];
+                s = (fq - (f[v[k]] + (w * p * p))) / (2 * w * (((double)q) - p));
+                if(s <= z[k])
+                {
+                    --k;
+                }
+                else
+                {
+                    break;
+                }
+            }
+            ++k;
+            v[k] = q;
+            z[k] = (k == 0)?-inf:s;
+        }
+        
+        if(k < 0)
+        {
+            for(size_t x = 0; x < n; ++x)
+            {
+                d[x] = inf;
+                site[x] = -1;
+            }
+            return;
+        }
+        z[k+1] = inf;
+        long j = 0;
+        for(size_t x = 0; x < n; ++x)
+        {
+            while(z[j+1] < ((double)x))
+            {
+                ++j;
+            }
+            double dx = ((double)x) - ((double)v[j]);
+            d[x] = (w * dx * dx) + f[v[j]];
+            site[x] = v[j];
+        }
+    }
+    
+    unsigned int RSGISDistanceTransform::calcHaloRows(int height, double yRes)
+    {
+        if((this->maxDist <= 0) || (yRes <= 0))
+        {
+            return height;
+        }
+        double haloRows = std::ceil(this->maxDist / yRes);
+        if(haloRows >= height)
+        {
+            return height;
+        }
+        return (unsigned int)haloRows;
+    }
+    
+    RSGISDistanceTransform::~RSGISDistanceTransform()
+    {
+        
+    }
+    
+}}
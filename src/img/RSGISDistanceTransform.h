@@ -0,0 +1,125 @@
+/*
+ *  RSGISDistanceTransform.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISDistanceTransform_H
+#define RSGISDistanceTransform_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdint.h>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISStripIOPipeline.h"
+#include "common/rsgis-tqdm.h"
+
+#include "img/RSGISImageCalcException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+    
+    /**
+     * Calculates the exact Euclidean distance transform of a label image with the
+     * separable algorithm of Felzenszwalb and Huttenlocher (2012): the distance to the
+     * nearest feature pixel within each column and then, for each row, the lower
+     * envelope of the parabolas centred on the pixels of the row, so the run time is
+     * linear in the number of pixels. The distances are between pixel centres, in map
+     * units (using the pixel size) if useGeoUnits is true, otherwise in pixels, as
+     * gdal_proximity.
+     *
+     * The image is processed in strips of rows (on the threads, strip memory and I/O
+     * buffers of the default execution context). With a maxDist (> 0), which gives
+     * pixels further from a feature the noDataVal, each strip is read with a halo of the
+     * rows within maxDist, otherwise (as any feature may be the nearest) the whole image
+     * is processed as a single strip.
+     */
+    class DllExport RSGISDistanceTransform
+    {
+    public:
+        RSGISDistanceTransform(double maxDist=0, float noDataVal=-1, bool useGeoUnits=true);
+        /**
+         * Calculate the distance from each pixel to the nearest non-zero pixel of the labels band
+         * and (if nearestLabelBand is not NULL) the label of that pixel (0 for no data).
+         */
+        void calcDistToNearestFeature(GDALRasterBand *labelsBand, double *transform, GDALRasterBand *distBand, GDALRasterBand *nearestLabelBand);
+        /**
+         * Calculate the distance from each pixel to the nearest pixel of each class; distBands
+         * holds an output band for each element of classIDs. Each strip is read once for all
+         * the classes.
+         */
+        void calcDistToClasses(GDALRasterBand *labelsBand, double *transform, std::vector<uint64_t> classIDs, std::vector<GDALRasterBand*> distBands);
+        /** Find the (sorted) non-zero values within the labels band. */
+        std::vector<uint64_t> findClassIDs(GDALRasterBand *labelsBand);
+        ~RSGISDistanceTransform();
+    protected:
+        /**
+         * Calculate the distances for each strip of the image, to the pixels of each of classIDs or
+         * (if allFeatures is true) to any non-zero pixel, for which distBands has a single band.
+         */
+        void calcDistTransform(GDALRasterBand *labelsBand, double *transform, bool allFeatures, std::vector<uint64_t> classIDs, std::vector<GDALRasterBand*> distBands, GDALRasterBand *nearestLabelBand);
+        /**
+         * Calculate the distance transform of the strip, where labels holds the rows from bufRowStart
+         * to bufRowEnd and the rows [rowStart, rowStart+nRows) are output. Feature pixels have the
+         * label classID or, if allFeatures is true, any non-zero label. If nearestLabels is not NULL
+         * the label of the nearest feature pixel is also output. colSqDist and colFeatRow are the
+         * workspaces for the squared distance to (and row of) the nearest feature within each column.
+         */
+        void calcStripDist(const uint64_t *labels, unsigned int width, unsigned int bufRowStart, unsigned int bufRowEnd, unsigned int rowStart, unsigned int nRows, bool allFeatures, uint64_t classID, double xRes2, double yRes2, rsgis::RSGISThreadPool *threadPool, std::vector<double> *colSqDist, std::vector<int32_t> *colFeatRow, float *dist, uint64_t *nearestLabels);
+        /**
+         * Calculate the lower envelope of the parabolas w(x-q)^2 + f(q) for the n values of f and
+         * output the squared distance (d) and the index of the nearest site (site) for each x,
+         * where the infinite values of f are not sites. v and z are workspaces of n and n+1 values.
+         */
+        static void calcLowerEnvelope(const double *f, size_t n, double w, double *d, int32_t *site, int32_t *v, double *z);
+        /** Get the rows within maxDist of a row (all the rows without a maxDist). */
+        unsigned int calcHaloRows(int height, double yRes);
+        double maxDist;
+        float noDataVal;
+        bool useGeoUnits;
+        unsigned int numThreads;
+        unsigned int numIOBuffers;
+        unsigned int stripMemoryMB;
+    };
+    
+}}
+
+#endif
@@ -0,0 +1,428 @@
+/*
+ *  RSGISExtractImageChips.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISExtractImageChips.h"
+#include "common/RSGISGDALInit.h"
+
+namespace rsgis{namespace img{
+    
+    RSGISExtractImageChips::RSGISExtractImageChips(unsigned int numThreads)
+    {
+        if(numThreads == 0)
+        {
+            numThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+        }
+        this->numThreads = numThreads;
+    }
+    
+    void RSGISExtractImageChips::extractChipsWithinMask2HDF(std::vector<std::pair<std::string, std::vector<unsigned int> > > imageFiles, std::string maskImage, float maskValue, unsigned int chipSize, std::string outHDFFile, RSGISLibDataType dataType, std::string refImage, unsigned int refBand)
+    {
+        if(imageFiles.size() == 0)
+        {
+            throw RSGISImageException("There were no images provided.");
+        }
+        if(chipSize == 0)
+        {
+            throw RSGISImageException("The chip size must be greater than zero.");
+        }
+        rsgis::RSGISGDALInit::init();
+        
+        GDALDataset *maskDataset = NULL;
+        std::vector<GDALDataset*> datasets;
+        try
+        {
+            maskDataset = (GDALDataset *) GDALOpen(maskImage.c_str(), GA_ReadOnly);
+            if(maskDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + maskImage;
+                throw RSGISImageException(message.c_str());
+            }
+            if(maskDataset->GetRasterCount() != 1)
+            {
+                throw RSGISImageException("Image mask must only have 1 image band.");
+            }
+            double maskTrans[6];
+            maskDataset->GetGeoTransform(maskTrans);
+            if((maskTrans[2] != 0) || (maskTrans[4] != 0))
+            {
+                throw RSGISImageException("The image mask cannot be rotated.");
+            }
+            unsigned int maskXSize = maskDataset->GetRasterXSize();
+            unsigned int maskYSize = maskDataset->GetRasterYSize();
+            
+            // The datasets are the images followed by the reference image (if provided),
+            // each with the output bands (or the reference band) read from it.
+            std::vector<std::vector<unsigned int> > dataBands;
+            std::vector<int> dataXOffs;
+            std::vector<int> dataYOffs;
+            unsigned int numOutBands = 0;
+            for(unsigned int i = 0; i < imageFiles.size(); ++i)
+            {
+                GDALDataset *dataset = (GDALDataset *) GDALOpen(imageFiles.at(i).first.c_str(), GA_ReadOnly);
+                if(dataset == NULL)
+                {
+                    std::string message = std::string("Could not open image ") + imageFiles.at(i).first.c_str();
+                    throw RSGISImageException(message.c_str());
+                }
+                datasets.push_back(dataset);
+                
+                for(std::vector<unsigned int>::iterator iterBands = imageFiles.at(i).second.begin(); iterBands != imageFiles.at(i).second.end(); ++iterBands)
+                {
+                    if(((*iterBands) < 1) || ((*iterBands) > dataset->GetRasterCount()))
+                    {
+                        std::cout << "Error for band number in \'" << imageFiles.at(i).first << "\': " << dataset->GetRasterCount() << "\n";
+                        throw RSGISImageException("Band numbers start at 1 and equal or less than the number of bands within the image file.");
+                    }
+                }
+                numOutBands += imageFiles.at(i).second.size();
+                dataBands.push_back(imageFiles.at(i).second);
+                
+                int xOff = 0;
+                int yOff = 0;
+                this->getMaskPxlOffset(dataset, maskTrans, imageFiles.at(i).first, &xOff, &yOff);
+                dataXOffs.push_back(xOff);
+                dataYOffs.push_back(yOff);
+            }
+            if(numOutBands == 0)
+            {
+                throw RSGISImageException("No image bands were provided.");
+            }
+            bool useRef = (refImage != "");
+            if(useRef)
+            {
+                GDALDataset *dataset = (GDALDataset *) GDALOpen(refImage.c_str(), GA_ReadOnly);
+                if(dataset == NULL)
+                {
+                    std::string message = std::string("Could not open image ") + refImage;
+                    throw RSGISImageException(message.c_str());
+                }
+                datasets.push_back(dataset);
+                if((refBand < 1) || (refBand > ((unsigned int)dataset->GetRasterCount())))
+                {
+                    throw RSGISImageException("The reference band number starts at 1 and is equal or less than the number of bands within the reference image.");
+                }
+                dataBands.push_back(std::vector<unsigned int>(1, refBand));
+                
+                int xOff = 0;
+                int yOff = 0;
+                this->getMaskPxlOffset(dataset, maskTrans, refImage, &xOff, &yOff);
+                dataXOffs.push_back(xOff);
+                dataYOffs.push_back(yOff);
+            }
+            unsigned int numStripBands = numOutBands + (useRef?1:0);
+            
+            // A chip centred on pixel x covers the pixels x-chipLow to x+chipHigh (as rsgislib.zonalstats).
+            int chipLow = chipSize / 2;
+            int chipHigh = chipSize - chipLow - 1;
+            
+            // Find the chip centres, in strips of the mask, keeping the first chip of each strip.
+            GDALRasterBand *maskBand = maskDataset->GetRasterBand(1);
+            int maskBlockXSize = 0;
+            int maskBlockYSize = 0;
+            maskBand->GetBlockSize(&maskBlockXSize, &maskBlockYSize);
+            rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+            unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(maskBlockYSize, maskXSize, maskYSize, numStripBands * sizeof(float), context.stripMemoryMB);
+            if(stripRows == 0)
+            {
+                stripRows = 1;
+            }
+            unsigned int numStrips = (maskYSize + stripRows - 1) / stripRows;
+            
+            std::vector<unsigned int> chipCols;
+            std::vector<unsigned int> chipRows;
+            std::vector<size_t> stripFirstChip(numStrips + 1, 0);
+            std::vector<float> maskData(((size_t)stripRows) * maskXSize);
+            for(unsigned int strip = 0; strip < numStrips; ++strip)
+            {
+                stripFirstChip[strip] = chipCols.size();
+                unsigned int yOff = strip * stripRows;
+                unsigned int nStripRows = std::min(stripRows, maskYSize - yOff);
+                if(maskBand->RasterIO(GF_Read, 0, yOff, maskXSize, nStripRows, maskData.data(), maskXSize, nStripRows, GDT_Float32, 0, 0) != CE_None)
+                {
+                    throw RSGISImageException("Could not read the image mask.");
+                }
+                for(unsigned int y = 0; y < nStripRows; ++y)
+                {
+                    for(unsigned int x = 0; x < maskXSize; ++x)
+                    {
+                        if(maskData[(((size_t)y) * maskXSize) + x] == maskValue)
+                        {
+                            chipCols.push_back(x);
+                            chipRows.push_back(yOff + y);
+                        }
+                    }
+                }
+            }
+            stripFirstChip[numStrips] = chipCols.size();
+            std::vector<float>().swap(maskData);
+            size_t numChips = chipCols.size();
+            if(numChips == 0)
+            {
+                throw RSGISImageException("There are no pixels within the mask with the mask value.");
+            }
+            std::cout << "There are " << numChips << " pixel samples in the mask." << std::endl;
+            
+            size_t chipPxls = ((size_t)chipSize) * chipSize;
+            size_t batchChips = RSGIS_CHIP_BATCH_SIZE;
+            if(context.stripMemoryMB > 0)
+            {
+                batchChips = std::max<size_t>((((size_t)context.stripMemoryMB) * 1024 * 1024) / (chipPxls * numStripBands * sizeof(float)), 1);
+            }
+            
+            try
+            {
+                H5::Exception::dontPrint();
+                
+                rsgis::utils::RSGISExportColumnData2HDF exportCols2HDF;
+                H5::DataType h5DataType = exportCols2HDF.getH5DataType(dataType);
+                
+                H5::FileAccPropList dataAccessPlist = H5::FileAccPropList(H5::FileAccPropList::DEFAULT);
+                dataAccessPlist.setCache(rsgis::utils::HDF5_WRITE_MDC_NELMTS, rsgis::utils::HDF5_WRITE_RDCC_NELMTS, rsgis::utils::HDF5_WRITE_RDCC_NBYTES, rsgis::utils::HDF5_WRITE_RDCC_W0);
+                dataAccessPlist.setSieveBufSize(rsgis::utils::HDF5_WRITE_SIEVE_BUF);
+                hsize_t metaBlockSize = rsgis::utils::HDF5_WRITE_META_BLOCKSIZE;
+                dataAccessPlist.setMetaBlockSize(metaBlockSize);
+                H5::H5File h5File(outHDFFile, H5F_ACC_TRUNC, H5::FileCreatPropList::DEFAULT, dataAccessPlist);
+                h5File.createGroup( "/DATA" );
+                h5File.createGroup( "/META-DATA" );
+                
+                hsize_t descDims[1] = { 1 };
+                H5::DataSpace descDataSpace(1, descDims);
+                H5::StrType strTypeAll(0, H5T_VARIABLE);
+                H5::DataSet descDataset = h5File.createDataSet( "/META-DATA/DESCRIPTION", strTypeAll, descDataSpace);
+                std::string description = useRef?std::string("IMAGE REF TILES"):std::string("IMAGE TILES");
+                const char *descStr[1] = { description.c_str() };
+                descDataset.write((void*)descStr, strTypeAll);
+                descDataset.close();
+                
+                // Each chip is a chunk so each is compressed and written on its own.
+                int initFillVal = 0;
+                hsize_t dataDims[4] = { numChips, chipSize, chipSize, numOutBands };
+                H5::DataSpace dataSpace(4, dataDims);
+                H5::DSetCreatPropList dataParams;
+                hsize_t dataChunkDims[4] = { 1, chipSize, chipSize, numOutBands };
+                dataParams.setChunk(4, dataChunkDims);
+                dataParams.setShuffle();
+                dataParams.setDeflate(rsgis::utils::HDF5_WRITE_DEFLATE);
+                dataParams.setFillValue(H5::PredType::NATIVE_INT, &initFillVal);
+                H5::DataSet dataDataset = h5File.createDataSet("/DATA/DATA", h5DataType, dataSpace, dataParams);
+                
+                H5::DataSet refDataset;
+                if(useRef)
+                {
+                    hsize_t refDims[3] = { numChips, chipSize, chipSize };
+                    H5::DataSpace refSpace(3, refDims);
+                    H5::DSetCreatPropList refParams;
+                    hsize_t refChunkDims[3] = { 1, chipSize, chipSize };
+                    refParams.setChunk(3, refChunkDims);
+                    refParams.setShuffle();
+                    refParams.setDeflate(rsgis::utils::HDF5_WRITE_DEFLATE);
+                    refParams.setFillValue(H5::PredType::NATIVE_INT, &initFillVal);
+                    refDataset = h5File.createDataSet("/DATA/REF", H5::PredType::STD_U16LE, refSpace, refParams);
+                }
+                
+                // Each strip is read with the halo of the chips around it.
+                unsigned int readWidth = maskXSize + chipSize - 1;
+                std::vector<float> stripVals;
+                std::vector<float> chipVals;
+                std::vector<float> refChipVals;
+                std::vector<unsigned int> bandStripIdx(datasets.size(), 0);
+                for(size_t d = 1; d < datasets.size(); ++d)
+                {
+                    bandStripIdx[d] = bandStripIdx[d-1] + dataBands[d-1].size();
+                }
+                std::atomic<bool> failed(false);
+                rsgis::RSGISThreadPool threadPool(this->numThreads);
+                rsgis_tqdm pbar;
+                for(unsigned int strip = 0; strip < numStrips; ++strip)
+                {
+                    pbar.progress(strip, numStrips);
+                    if(stripFirstChip[strip] == stripFirstChip[strip+1])
+                    {
+                        continue;
+                    }
+                    unsigned int stripStart = strip * stripRows;
+                    unsigned int nStripRows = std::min(stripRows, maskYSize - stripStart);
+                    unsigned int readHeight = nStripRows + chipSize - 1;
+                    size_t readPxls = ((size_t)readWidth) * readHeight;
+                    stripVals.resize(readPxls * numStripBands);
+                    
+                    // A dataset cannot be read by more than one thread so the datasets are read in parallel.
+                    threadPool.parallelFor(0, datasets.size(), [&](unsigned int w, size_t dStart, size_t dEnd)
+                    {
+                        for(size_t d = dStart; (d < dEnd) && (!failed); ++d)
+                        {
+                            for(size_t b = 0; b < dataBands[d].size(); ++b)
+                            {
+                                float *bandVals = &stripVals[(bandStripIdx[d] + b) * readPxls];
+                                if(!this->readWindow(datasets[d]->GetRasterBand(dataBands[d][b]), dataXOffs[d] - chipLow, dataYOffs[d] + ((int)stripStart) - chipLow, readWidth, readHeight, bandVals))
+                                {
+                                    failed = true;
+                                    break;
+                                }
+                            }
+                        }
+                    });
+                    if(failed)
+                    {
+                        throw RSGISImageException("Could not read the input images.");
+                    }
+                    
+                    for(size_t batchStart = stripFirstChip[strip]; batchStart < stripFirstChip[strip+1]; batchStart += batchChips)
+                    {
+                        size_t nBatch = std::min(batchChips, stripFirstChip[strip+1] - batchStart);
+                        chipVals.resize(nBatch * chipPxls * numOutBands);
+                        if(useRef)
+                        {
+                            refChipVals.resize(nBatch * chipPxls);
+                        }
+                        threadPool.parallelFor(0, nBatch, [&](unsigned int w, size_t cStart, size_t cEnd)
+                        {
+                            for(size_t c = cStart; c < cEnd; ++c)
+                            {
+                                // The chip pixel (cx, cy) is the strip pixel (col+cx, row-stripStart+cy) given the halo.
+                                size_t chipIdx = batchStart + c;
+                                size_t stripOff = (((size_t)(chipRows[chipIdx] - stripStart)) * readWidth) + chipCols[chipIdx];
+                                float *outVals = &chipVals[c * chipPxls * numOutBands];
+                                for(unsigned int cx = 0; cx < chipSize; ++cx)
+                                {
+                                    for(unsigned int cy = 0; cy < chipSize; ++cy)
+                                    {
+                                        size_t pxlOff = stripOff + (((size_t)cy) * readWidth) + cx;
+                                        for(unsigned int b = 0; b < numOutBands; ++b)
+                                        {
+                                            *(outVals++) = stripVals[(b * readPxls) + pxlOff];
+                                        }
+                                    }
+                                }
+                                if(useRef)
+                                {
+                                    const float *refVals = &stripVals[((size_t)numOutBands) * readPxls];
+                                    float *outRefVals = &refChipVals[c * chipPxls];
+                                    for(unsigned int cy = 0; cy < chipSize; ++cy)
+                                    {
+                                        for(unsigned int cx = 0; cx < chipSize; ++cx)
+                                        {
+                                            *(outRefVals++) = refVals[stripOff + (((size_t)cy) * readWidth) + cx];
+                                        }
+                                    }
+                                }
+                            }
+                        });
+                        
+                        hsize_t dataOffset[4] = { batchStart, 0, 0, 0 };
+                        hsize_t dataCount[4] = { nBatch, chipSize, chipSize, numOutBands };
+                        H5::DataSpace dataWriteSpace = dataDataset.getSpace();
+                        dataWriteSpace.selectHyperslab(H5S_SELECT_SET, dataCount, dataOffset);
+                        H5::DataSpace dataMemSpace(4, dataCount);
+                        dataDataset.write(chipVals.data(), H5::PredType::NATIVE_FLOAT, dataMemSpace, dataWriteSpace);
+                        if(useRef)
+                        {
+                            hsize_t refOffset[3] = { batchStart, 0, 0 };
+                            hsize_t refCount[3] = { nBatch, chipSize, chipSize };
+                            H5::DataSpace refWriteSpace = refDataset.getSpace();
+                            refWriteSpace.selectHyperslab(H5S_SELECT_SET, refCount, refOffset);
+                            H5::DataSpace refMemSpace(3, refCount);
+                            refDataset.write(refChipVals.data(), H5::PredType::NATIVE_FLOAT, refMemSpace, refWriteSpace);
+                        }
+                    }
+                }
+                pbar.finish();
+                
+                dataDataset.close();
+                if(useRef)
+                {
+                    refDataset.close();
+                }
+                h5File.close();
+            }
+            catch(H5::Exception &e)
+            {
+                throw RSGISImageException(e.getCDetailMsg());
+            }
+        }
+        catch(RSGISImageException &e)
+        {
+            if(maskDataset != NULL)
+            {
+                GDALClose(maskDataset);
+            }
+            for(std::vector<GDALDataset*>::iterator iterDatasets = datasets.begin(); iterDatasets != datasets.end(); ++iterDatasets)
+            {
+                GDALClose(*iterDatasets);
+            }
+            throw e;
+        }
+        
+        GDALClose(maskDataset);
+        for(std::vector<GDALDataset*>::iterator iterDatasets = datasets.begin(); iterDatasets != datasets.end(); ++iterDatasets)
+        {
+            GDALClose(*iterDatasets);
+        }
+    }
+    
+    void RSGISExtractImageChips::getMaskPxlOffset(GDALDataset *dataset, double *maskTrans, std::string fileName, int *xOff, int *yOff)
+    {
+        double trans[6];
+        dataset->GetGeoTransform(trans);
+        if((trans[2] != 0) || (trans[4] != 0))
+        {
+            std::string message = std::string("The image cannot be rotated: ") + fileName;
+            throw RSGISImageException(message.c_str());
+        }
+        if((std::fabs(trans[1] - maskTrans[1]) > (std::fabs(maskTrans[1]) * 1e-6)) || (std::fabs(trans[5] - maskTrans[5]) > (std::fabs(maskTrans[5]) * 1e-6)))
+        {
+            std::string message = std::string("The image must have the same pixel size as the mask: ") + fileName;
+            throw RSGISImageException(message.c_str());
+        }
+        double xPxlOff = (maskTrans[0] - trans[0]) / trans[1];
+        double yPxlOff = (maskTrans[3] - trans[3]) / trans[5];
+        if((std::fabs(xPxlOff - std::round(xPxlOff)) > 0.01) || (std::fabs(yPxlOff - std::round(yPxlOff)) > 0.01))
+        {
+            std::string message = std::string("The image is not aligned with the pixel grid of the mask: ") + fileName;
+            throw RSGISImageException(message.c_str());
+        }
+        *xOff = (int)std::round(xPxlOff);
+        *yOff = (int)std::round(yPxlOff);
+    }
+    
+    bool RSGISExtractImageChips::readWindow(GDALRasterBand *band, int xOff, int yOff, unsigned int width, unsigned int height, float *data)
+    {
+        std::fill(data, data + (((size_t)width) * height), 0.0f);
+        int xMin = std::max(xOff, 0);
+        int yMin = std::max(yOff, 0);
+        int xMax = std::min(xOff + ((int)width), band->GetXSize());
+        int yMax = std::min(yOff + ((int)height), band->GetYSize());
+        if((xMax <= xMin) || (yMax <= yMin))
+        {
+            return true;
+        }
+        float *winData = data + ((((size_t)(yMin - yOff)) * width) + (xMin - xOff));
+        return (band->RasterIO(GF_Read, xMin, yMin, xMax - xMin, yMax - yMin, winData, xMax - xMin, yMax - yMin, GDT_Float32, sizeof(float), ((GSpacing)width) * sizeof(float)) == CE_None);
+    }
+    
+    RSGISExtractImageChips::~RSGISExtractImageChips()
+    {
+        
+    }
+    
+}}
@@ -0,0 +1,99 @@
+/*
+ *  RSGISExtractImageChips.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#ifndef RSGISExtractImageChips_H
+#define RSGISExtractImageChips_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <atomic>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISCommons.h"
+#include "common/RSGISImageException.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/rsgis-tqdm.h"
+
+#include "utils/RSGISExportData2HDF.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+    
+    /// The number of chips written in each batch where the execution context has no strip memory.
+    static const unsigned int RSGIS_CHIP_BATCH_SIZE( 256 );
+    
+    /**
+     * Extracts a chip (window) of chipSize x chipSize pixels, centred on each of the
+     * pixels within the mask with the mask value, to a HDF5 file for training deep
+     * learning classifiers. The chips are written to DATA/DATA as an array with the
+     * shape [n, chipSize, chipSize, nBands], which is indexed [chip, x, y, band] (as
+     * the transposed arrays written by rsgislib.zonalstats) with each chip a chunk. If
+     * a reference image band is provided the chips of the reference image are written
+     * to DATA/REF as uint16, indexed [chip, y, x].
+     *
+     * The mask is read in strips and each image band is read once per strip, with a
+     * halo of half a chip above and below the strip, from which all the chips centred
+     * within the strip are cut on the thread pool. The chips are in the (row-major)
+     * order of the mask pixels so the output does not depend on the number of threads.
+     * The images must be on the pixel grid of the mask (same pixel size and aligned) but
+     * do not need to have the same extent; pixels outside of an image are given zero.
+     */
+    class DllExport RSGISExtractImageChips
+    {
+    public:
+        /** If numThreads is 0 the number of hardware threads is used. */
+        RSGISExtractImageChips(unsigned int numThreads=1);
+        void extractChipsWithinMask2HDF(std::vector<std::pair<std::string, std::vector<unsigned int> > > imageFiles, std::string maskImage, float maskValue, unsigned int chipSize, std::string outHDFFile, RSGISLibDataType dataType, std::string refImage="", unsigned int refBand=1);
+        ~RSGISExtractImageChips();
+    protected:
+        /** Find the pixel offset of the mask within the image, checking the image is on the pixel grid of the mask. */
+        void getMaskPxlOffset(GDALDataset *dataset, double *maskTrans, std::string fileName, int *xOff, int *yOff);
+        /** Read a window, which can extend beyond the image, into data (with rows of width pixels) where pixels outside of the image are zero. */
+        bool readWindow(GDALRasterBand *band, int xOff, int yOff, unsigned int width, unsigned int height, float *data);
+        unsigned int numThreads;
+    };
+    
+}}
+
+#endif
+
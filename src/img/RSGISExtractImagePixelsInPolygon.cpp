@@ -198,19 +198,29 @@ namespace rsgis
                         throw RSGISImageException("Image band is not within the GDAL dataset.");
                     }
                     
-                    GDALRasterBand *gdalImgBand = image->GetRasterBand(imageBand);
-                    
-                    boost::uint_fast32_t imgXSize = gdalImgBand->GetXSize();
-                    boost::uint_fast32_t imgYSize = gdalImgBand->GetYSize();
+                    boost::uint_fast32_t imgXSize = image->GetRasterXSize();
+                    boost::uint_fast32_t imgYSize = image->GetRasterYSize();
                     
+                    std::vector<unsigned int> xPxls;
+                    std::vector<unsigned int> yPxls;
+                    xPxls.reserve(ptPxlValues->size());
+                    yPxls.reserve(ptPxlValues->size());
                     for(std::vector<ImagePixelValuePt*>::iterator iterPxls = ptPxlValues->begin(); iterPxls != ptPxlValues->end(); ++iterPxls)
                     {
-                        if(((*iterPxls)->imgX > imgXSize) | ((*iterPxls)->imgY > imgYSize))
+                        if(((*iterPxls)->imgX >= imgXSize) | ((*iterPxls)->imgY >= imgYSize))
                         {
                             throw RSGISImageException("Required pixel is not within the image.");
                         }
-                        
-                        gdalImgBand->RasterIO(GF_Read, (*iterPxls)->imgX, (*iterPxls)->imgY, 1, 1, &(*iterPxls)->value, 1, 1, GDT_Float32, 0, 0);
+                        xPxls.push_back((*iterPxls)->imgX);
+                        yPxls.push_back((*iterPxls)->imgY);
+                    }
+                    
+                    // Read each block along the line once rather than a pixel at a time.
+                    std::vector<double> pxlVals;
+                    RSGISImagePointSampler::samplePixels(image, std::vector<unsigned int>(1, imageBand), xPxls, yPxls, 0.0, &pxlVals);
+                    for(size_t i = 0; i < ptPxlValues->size(); ++i)
+                    {
+                        ptPxlValues->at(i)->value = pxlVals[i];
                     }
                     
                 } 
@@ -40,6 +40,7 @@
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISCalcImage.h"
 #include "img/RSGISCalcImageValue.h"
+#include "img/RSGISImagePointSampler.h"
 
 #include <boost/cstdint.hpp>
 #include <boost/numeric/conversion/cast.hpp>
@@ -22,6 +22,7 @@
 
 
 #include "RSGISExtractImageValues.h"
+#include "common/RSGISGDALInit.h"
 
 
 namespace rsgis{namespace img{
@@ -95,86 +96,187 @@ namespace rsgis{namespace img{
     {
         try
         {
-            GDALAllRegister();
+            rsgis::RSGISGDALInit::init();
             if(imageFiles.size() == 0)
             {
                 throw RSGISImageException("There were no images provided.");
             }
             
-            GDALDataset **datasets = new GDALDataset*[imageFiles.size()+1];
-            
-            
-            
-            datasets[0] = (GDALDataset *) GDALOpen(maskImage.c_str(), GA_ReadOnly);
-            if(datasets[0] == NULL)
+            GDALDataset *maskDataset = (GDALDataset *) GDALOpen(maskImage.c_str(), GA_ReadOnly);
+            if(maskDataset == NULL)
             {
                 std::string message = std::string("Could not open image ") + maskImage;
                 throw RSGISImageException(message.c_str());
             }
             
-            if(datasets[0]->GetRasterCount() != 1)
+            if(maskDataset->GetRasterCount() != 1)
             {
                 throw RSGISImageException("Image mask must only have 1 image band.");
             }
+            double maskTrans[6];
+            maskDataset->GetGeoTransform(maskTrans);
+            if((maskTrans[2] != 0) || (maskTrans[4] != 0))
+            {
+                throw RSGISImageException("The image mask cannot be rotated.");
+            }
+            unsigned int maskXSize = maskDataset->GetRasterXSize();
+            unsigned int maskYSize = maskDataset->GetRasterYSize();
             
-            std::vector<unsigned int> imgBands;
-            unsigned int cImgBandCount = datasets[0]->GetRasterCount();
+            // Each image is read on its own grid so the images do not need to be stacked or resampled first.
+            std::vector<GDALDataset*> datasets;
+            std::vector<std::vector<double> > imgTrans;
+            unsigned int numOutImgBands = 0;
             for(unsigned int i = 0; i < imageFiles.size(); ++i)
             {
-                datasets[i+1] = (GDALDataset *) GDALOpen(imageFiles.at(i).first.c_str(), GA_ReadOnly);
-                if(datasets[i+1] == NULL)
+                GDALDataset *dataset = (GDALDataset *) GDALOpen(imageFiles.at(i).first.c_str(), GA_ReadOnly);
+                if(dataset == NULL)
                 {
                     std::string message = std::string("Could not open image ") + imageFiles.at(i).first.c_str();
                     throw RSGISImageException(message.c_str());
                 }
+                datasets.push_back(dataset);
                 
                 for(std::vector<unsigned int>::iterator iterBands = imageFiles.at(i).second.begin(); iterBands != imageFiles.at(i).second.end(); ++iterBands)
                 {
-                    if(((*iterBands) < 1) || ((*iterBands) > datasets[i+1]->GetRasterCount()))
+                    if(((*iterBands) < 1) || ((*iterBands) > dataset->GetRasterCount()))
                     {
-                        std::cout << "Error for band number in \'" << imageFiles.at(i).first << "\': " << datasets[i+1]->GetRasterCount() << "\n";
+                        std::cout << "Error for band number in \'" << imageFiles.at(i).first << "\': " << dataset->GetRasterCount() << "\n";
                         throw RSGISImageException("Band numbers start at 1 and equal or less than the number of bands within the image file.");
                     }
-                    imgBands.push_back(cImgBandCount+((*iterBands)-1));
                 }
-                cImgBandCount += datasets[i+1]->GetRasterCount();
-            }
-            
-            std::vector<float*> *pxlVals = new std::vector<float*>();
-            unsigned int numOutImgBands = imgBands.size();
-            
-            RSGISExtractImageBandValuesWithMask extractData = RSGISExtractImageBandValuesWithMask(pxlVals, imgBands, maskValue);
-            RSGISCalcImage calcImg = RSGISCalcImage(&extractData, "", true);
-            calcImg.calcImage(datasets, imageFiles.size()+1);
-            
-            
-            for(unsigned int i = 0; i < (imageFiles.size()+1); ++i)
-            {
-                GDALClose(datasets[i]);
+                numOutImgBands += imageFiles.at(i).second.size();
+                
+                std::vector<double> trans(6);
+                dataset->GetGeoTransform(trans.data());
+                if((trans[2] != 0) || (trans[4] != 0))
+                {
+                    std::string message = std::string("The image cannot be rotated: ") + imageFiles.at(i).first;
+                    throw RSGISImageException(message.c_str());
+                }
+                imgTrans.push_back(trans);
             }
-            delete[] datasets;
             
             rsgis::utils::RSGISExportColumnData2HDF exportCols2HDF;
             H5::DataType h5DataType = exportCols2HDF.getH5DataType(dataType);
             exportCols2HDF.createFile(outHDFFile, numOutImgBands, std::string("Pixels Extracted"), h5DataType);
-            float *row = new float[numOutImgBands];
-            for(unsigned int j = 0; j < pxlVals->size(); ++j)
+            
+            GDALRasterBand *maskBand = maskDataset->GetRasterBand(1);
+            int maskBlockXSize = 0;
+            int maskBlockYSize = 0;
+            maskBand->GetBlockSize(&maskBlockXSize, &maskBlockYSize);
+            unsigned int stripRows = std::max((unsigned int)maskBlockYSize, RSGIS_EXTRACT_MASK_STRIP_ROWS);
+            
+            std::vector<float> maskData(((size_t)stripRows) * maskXSize);
+            std::vector<unsigned int> pxlCols;
+            std::vector<unsigned int> pxlRows;
+            std::vector<int> imgCols;
+            std::vector<int> imgRows;
+            std::vector<bool> pxlValid;
+            std::vector<float> pxlVals;
+            std::vector<float> imgData;
+            for(unsigned int yOff = 0; yOff < maskYSize; yOff += stripRows)
             {
-                for(unsigned int i = 0; i < numOutImgBands; ++i)
+                unsigned int nStripRows = std::min(stripRows, maskYSize - yOff);
+                if(maskBand->RasterIO(GF_Read, 0, yOff, maskXSize, nStripRows, maskData.data(), maskXSize, nStripRows, GDT_Float32, 0, 0) != CE_None)
                 {
-                    row[i] = pxlVals->at(j)[i];
+                    throw RSGISImageException("Could not read the image mask.");
+                }
+                
+                pxlCols.clear();
+                pxlRows.clear();
+                for(unsigned int y = 0; y < nStripRows; ++y)
+                {
+                    for(unsigned int x = 0; x < maskXSize; ++x)
+                    {
+                        if(maskData[(((size_t)y) * maskXSize) + x] == maskValue)
+                        {
+                            pxlCols.push_back(x);
+                            pxlRows.push_back(yOff + y);
+                        }
+                    }
+                }
+                if(pxlCols.empty())
+                {
+                    continue;
+                }
+                
+                size_t nPxls = pxlCols.size();
+                pxlValid.assign(nPxls, true);
+                pxlVals.resize(nPxls * numOutImgBands);
+                imgCols.resize(nPxls);
+                imgRows.resize(nPxls);
+                unsigned int bandOff = 0;
+                for(unsigned int i = 0; i < datasets.size(); ++i)
+                {
+                    // Map the mask pixel centres on to the image pixels and find the window they are within.
+                    // As with the stacked images, pixels outside of any of the images are not extracted.
+                    int imgXSize = datasets[i]->GetRasterXSize();
+                    int imgYSize = datasets[i]->GetRasterYSize();
+                    int winXMin = imgXSize;
+                    int winXMax = -1;
+                    int winYMin = imgYSize;
+                    int winYMax = -1;
+                    for(size_t p = 0; p < nPxls; ++p)
+                    {
+                        double x = maskTrans[0] + ((pxlCols[p] + 0.5) * maskTrans[1]);
+                        double y = maskTrans[3] + ((pxlRows[p] + 0.5) * maskTrans[5]);
+                        double col = std::floor((x - imgTrans[i][0]) / imgTrans[i][1]);
+                        double row = std::floor((y - imgTrans[i][3]) / imgTrans[i][5]);
+                        if((col < 0) || (col >= imgXSize) || (row < 0) || (row >= imgYSize))
+                        {
+                            pxlValid[p] = false;
+                            imgCols[p] = -1;
+                            continue;
+                        }
+                        imgCols[p] = (int)col;
+                        imgRows[p] = (int)row;
+                        winXMin = std::min(winXMin, imgCols[p]);
+                        winXMax = std::max(winXMax, imgCols[p]);
+                        winYMin = std::min(winYMin, imgRows[p]);
+                        winYMax = std::max(winYMax, imgRows[p]);
+                    }
+                    if(winXMax < 0)
+                    {
+                        break;
+                    }
+                    
+                    // The bands are read one at a time so the memory is independent of the number of bands.
+                    int winXSize = (winXMax - winXMin) + 1;
+                    int winYSize = (winYMax - winYMin) + 1;
+                    imgData.resize(((size_t)winXSize) * winYSize);
+                    for(std::vector<unsigned int>::iterator iterBands = imageFiles.at(i).second.begin(); iterBands != imageFiles.at(i).second.end(); ++iterBands)
+                    {
+                        if(datasets[i]->GetRasterBand(*iterBands)->RasterIO(GF_Read, winXMin, winYMin, winXSize, winYSize, imgData.data(), winXSize, winYSize, GDT_Float32, 0, 0) != CE_None)
+                        {
+                            std::string message = std::string("Could not read image ") + imageFiles.at(i).first;
+                            throw RSGISImageException(message.c_str());
+                        }
+                        for(size_t p = 0; p < nPxls; ++p)
+                        {
+                            if(imgCols[p] >= 0)
+                            {
+                                pxlVals[(p * numOutImgBands) + bandOff] = imgData[(((size_t)(imgRows[p] - winYMin)) * winXSize) + (imgCols[p] - winXMin)];
+                            }
+                        }
+                        ++bandOff;
+                    }
+                }
+                
+                for(size_t p = 0; p < nPxls; ++p)
+                {
+                    if(pxlValid[p])
+                    {
+                        exportCols2HDF.addDataRow(&pxlVals[p * numOutImgBands], H5::PredType::NATIVE_FLOAT);
+                    }
                 }
-                exportCols2HDF.addDataRow(row, H5::PredType::NATIVE_FLOAT);
             }
             exportCols2HDF.close();
-            delete[] row;
             
-            for(std::vector<float*>::iterator iterVals = pxlVals->begin(); iterVals != pxlVals->end(); ++iterVals)
+            GDALClose(maskDataset);
+            for(std::vector<GDALDataset*>::iterator iterDatasets = datasets.begin(); iterDatasets != datasets.end(); ++iterDatasets)
             {
-                delete[] *iterVals;
+                GDALClose(*iterDatasets);
             }
-            delete pxlVals;
-            
         }
         catch (RSGISImageException &e)
         {
@@ -201,63 +303,13 @@ namespace rsgis{namespace img{
 
             if(nRows > nSamples)
             {
-                unsigned int blockSize = 1000;
-                unsigned int nFullBlocks = (int)floor(((double)nRows)/((double)blockSize));
-                unsigned int remain = nRows - (blockSize*nFullBlocks);
-                float *dataBlock = new float[nRows*nCols];
-
-                float propSamples = ((float)nSamples) / ((float)nRows);
-
-                unsigned int samplesPerBlock = (unsigned int)(ceil(((float)blockSize) * propSamples));
-                unsigned int samples4Remain = (unsigned int)(ceil(((float)remain) * propSamples));
-                //unsigned int totalSamples = (samplesPerBlock * nFullBlocks) + samples4Remain;
-
                 rsgis::utils::RSGISExportColumnData2HDF exportCols2HDF;
                 H5::DataType h5DataType = exportCols2HDF.getH5DataType(dataType);
                 exportCols2HDF.createFile(outputH5, nCols, std::string("Sampled Pixels Extracted"), h5DataType);
-                float *row = new float[nCols];
 
-                boost::mt19937 randomGen;
-                randomGen.seed(seed);
-                boost::uniform_int<> randomDist(0, blockSize);
-                boost::variate_generator<boost::mt19937&, boost::uniform_int<> > randomVal(randomGen, randomDist);
-
-                unsigned int ranIdx = 0;
-                unsigned int nRowsOff = 0;
-                for(unsigned int i = 0; i < nFullBlocks; ++i)
-                {
-                    readHDFCol.getDataRows(dataBlock, nCols, blockSize, H5::PredType::NATIVE_FLOAT, nRowsOff, blockSize);
+                this->sampleExtractedHDFRows(&readHDFCol, nRows, nCols, nSamples, seed, &exportCols2HDF, NULL);
 
-                    for(unsigned int j = 0; j < samplesPerBlock; ++j)
-                    {
-                        ranIdx = randomVal();
-                        for(unsigned int n = 0; n < nCols; ++n)
-                        {
-                            row[n] = dataBlock[(ranIdx*nCols)+n];
-                        }
-                        exportCols2HDF.addDataRow(row, H5::PredType::NATIVE_FLOAT);
-                    }
-                    nRowsOff += blockSize;
-                }
-                if(remain > 0)
-                {
-                    boost::uniform_int<> randomDist(0, remain);
-                    boost::variate_generator<boost::mt19937&, boost::uniform_int<> > randomVal(randomGen, randomDist);
-
-                    readHDFCol.getDataRows(dataBlock, nCols, blockSize, H5::PredType::NATIVE_FLOAT, nRowsOff, remain);
-                    for(unsigned int j = 0; j < samples4Remain; ++j)
-                    {
-                        ranIdx = randomVal();
-                        for(unsigned int n = 0; n < nCols; ++n)
-                        {
-                            row[n] = dataBlock[(ranIdx*nCols)+n];
-                        }
-                        exportCols2HDF.addDataRow(row, H5::PredType::NATIVE_FLOAT);
-                    }
-                }
                 exportCols2HDF.close();
-                delete[] row;
-                delete[] dataBlock;
             }
             else
             {
@@ -286,116 +338,16 @@ namespace rsgis{namespace img{
 
             if(nRows > nSamples)
             {
-                unsigned int blockSize = 1000;
-                unsigned int nFullBlocks = (int)floor(((double)nRows)/((double)blockSize));
-                unsigned int remain = nRows - (blockSize*nFullBlocks);
-                float *dataBlock = new float[nRows*nCols];
-
-                float propSamples = ((float)nSamples) / ((float)nRows);
-
-                unsigned int samplesPerBlock = (unsigned int)(ceil(((float)blockSize) * propSamples));
-                unsigned int samples4Remain = (unsigned int)(ceil(((float)remain) * propSamples));
-                //unsigned int totalSamples = (samplesPerBlock * nFullBlocks) + samples4Remain;
-
                 rsgis::utils::RSGISExportColumnData2HDF exportCols2HDF_P1;
                 H5::DataType h5DataType = exportCols2HDF_P1.getH5DataType(dataType);
                 exportCols2HDF_P1.createFile(outputP1H5, nCols, std::string("Sampled Pixels Extracted"), h5DataType);
                 rsgis::utils::RSGISExportColumnData2HDF exportCols2HDF_P2;
                 exportCols2HDF_P2.createFile(outputP2H5, nCols, std::string("Sampled Pixels Extracted"), h5DataType);
-                float *row = new float[nCols];
-                unsigned int *ranIdxes = new unsigned int[samplesPerBlock];
-
-                boost::mt19937 randomGen;
-                randomGen.seed(seed);
-                boost::uniform_int<> randomDist(0, blockSize);
-                boost::variate_generator<boost::mt19937&, boost::uniform_int<> > randomVal(randomGen, randomDist);
-
-                bool found = false;
-                unsigned int ranIdx = 0;
-                unsigned int nRowsOff = 0;
-                for(unsigned int i = 0; i < nFullBlocks; ++i)
-                {
-                    readHDFCol.getDataRows(dataBlock, nCols, blockSize, H5::PredType::NATIVE_FLOAT, nRowsOff, blockSize);
-
-                    for(unsigned int j = 0; j < samplesPerBlock; ++j)
-                    {
-                        ranIdx = randomVal();
-                        for(unsigned int n = 0; n < nCols; ++n)
-                        {
-                            row[n] = dataBlock[(ranIdx*nCols)+n];
-                        }
-                        exportCols2HDF_P1.addDataRow(row, H5::PredType::NATIVE_FLOAT);
-                        ranIdxes[j] = ranIdx;
-                    }
-
-                    for(unsigned int j = 0; j < blockSize; ++j)
-                    {
-                        found = false;
-                        for(unsigned int k = 0; k < samplesPerBlock; ++k)
-                        {
-                            if(ranIdxes[k] == j)
-                            {
-                                found = true;
-                                break;
-                            }
-                        }
-
-                        if(!found)
-                        {
-                            for(unsigned int n = 0; n < nCols; ++n)
-                            {
-                                row[n] = dataBlock[(j*nCols)+n];
-                            }
-                            exportCols2HDF_P2.addDataRow(row, H5::PredType::NATIVE_FLOAT);
-                        }
-                    }
-
-                    nRowsOff += blockSize;
-                }
-                if(remain > 0)
-                {
-                    boost::uniform_int<> randomDist(0, remain);
-                    boost::variate_generator<boost::mt19937&, boost::uniform_int<> > randomVal(randomGen, randomDist);
 
-                    readHDFCol.getDataRows(dataBlock, nCols, blockSize, H5::PredType::NATIVE_FLOAT, nRowsOff, remain);
-                    for(unsigned int j = 0; j < samples4Remain; ++j)
-                    {
-                        ranIdx = randomVal();
-                        for(unsigned int n = 0; n < nCols; ++n)
-                        {
-                            row[n] = dataBlock[(ranIdx*nCols)+n];
-                        }
-                        exportCols2HDF_P1.addDataRow(row, H5::PredType::NATIVE_FLOAT);
-                        ranIdxes[j] = ranIdx;
-                    }
+                this->sampleExtractedHDFRows(&readHDFCol, nRows, nCols, nSamples, seed, &exportCols2HDF_P1, &exportCols2HDF_P2);
 
-                    for(unsigned int j = 0; j < remain; ++j)
-                    {
-                        found = false;
-                        for(unsigned int k = 0; k < samples4Remain; ++k)
-                        {
-                            if(ranIdxes[k] == j)
-                            {
-                                found = true;
-                                break;
-                            }
-                        }
-
-                        if(!found)
-                        {
-                            for(unsigned int n = 0; n < nCols; ++n)
-                            {
-                                row[n] = dataBlock[(j*nCols)+n];
-                            }
-                            exportCols2HDF_P2.addDataRow(row, H5::PredType::NATIVE_FLOAT);
-                        }
-                    }
-                }
                 exportCols2HDF_P1.close();
                 exportCols2HDF_P2.close();
-                delete[] row;
-                delete[] dataBlock;
-                delete[] ranIdxes;
             }
             else
             {
@@ -413,6 +365,47 @@ namespace rsgis{namespace img{
         }
     }
 
+    void RSGISExtractImageValues::sampleExtractedHDFRows(rsgis::utils::RSGISReadHDFColumnData *readHDFCol, unsigned int nRows, unsigned int nCols, unsigned int nSamples, int seed, rsgis::utils::RSGISExportColumnData2HDF *sampleHDF, rsgis::utils::RSGISExportColumnData2HDF *remainHDF)
+    {
+        unsigned int chunkRows = std::min(RSGIS_HDF_SAMPLE_CHUNK_ROWS, nRows);
+        std::vector<float> dataBlock(((size_t)chunkRows) * nCols);
+
+        boost::mt19937 randomGen;
+        randomGen.seed(seed);
+        boost::uniform_real<double> randomDist(0, 1);
+        boost::variate_generator<boost::mt19937&, boost::uniform_real<double> > randomVal(randomGen, randomDist);
+
+        // Sequential selection sampling (Knuth's Algorithm S): each row is selected with
+        // probability (samples still needed) / (rows remaining), which gives exactly nSamples
+        // rows, without replacement and in the order of the input file, in a single pass.
+        unsigned int nSelected = 0;
+        for(unsigned int nRowsOff = 0; nRowsOff < nRows; nRowsOff += chunkRows)
+        {
+            if((remainHDF == NULL) && (nSelected == nSamples))
+            {
+                break;
+            }
+
+            unsigned int nRowsRead = std::min(chunkRows, nRows - nRowsOff);
+            readHDFCol->getDataRows(dataBlock.data(), nCols, chunkRows, H5::PredType::NATIVE_FLOAT, nRowsOff, nRowsRead);
+
+            for(unsigned int j = 0; j < nRowsRead; ++j)
+            {
+                float *row = &dataBlock[((size_t)j) * nCols];
+                double nRowsRemain = (double)(nRows - (nRowsOff + j));
+                if((nSelected < nSamples) && ((nRowsRemain * randomVal()) < (double)(nSamples - nSelected)))
+                {
+                    sampleHDF->addDataRow(row, H5::PredType::NATIVE_FLOAT);
+                    ++nSelected;
+                }
+                else if(remainHDF != NULL)
+                {
+                    remainHDF->addDataRow(row, H5::PredType::NATIVE_FLOAT);
+                }
+            }
+        }
+    }
+
     RSGISExtractImageValues::~RSGISExtractImageValues()
     {
         
@@ -492,10 +485,12 @@ namespace rsgis{namespace img{
     {
         try
         {
-            RSGISExtractPxlsAsPtsImgCalc *extractPxls = new RSGISExtractPxlsAsPtsImgCalc(vecLayer, maskVal);
+            rsgis::utils::RSGISOGRFeatureSink featSink(vecLayer);
+            RSGISExtractPxlsAsPtsImgCalc *extractPxls = new RSGISExtractPxlsAsPtsImgCalc(&featSink, maskVal);
             RSGISCalcImage calcImg = RSGISCalcImage(extractPxls, "", true);
             
             calcImg.calcImageExtent(&image, 1);
+            featSink.close();
             
             delete extractPxls;
         }
@@ -590,11 +585,10 @@ namespace rsgis{namespace img{
     }
     
 
-    RSGISExtractPxlsAsPtsImgCalc::RSGISExtractPxlsAsPtsImgCalc(OGRLayer *vecLayer, float maskValue) : RSGISCalcImageValue(0)
+    RSGISExtractPxlsAsPtsImgCalc::RSGISExtractPxlsAsPtsImgCalc(rsgis::utils::RSGISOGRFeatureSink *featSink, float maskValue) : RSGISCalcImageValue(0)
     {
-        this->vecLayer = vecLayer;
+        this->featSink = featSink;
         this->maskValue = maskValue;
-        this->featDefn = vecLayer->GetLayerDefn();
     }
     
     void RSGISExtractPxlsAsPtsImgCalc::calcImageValue(float *bandValues, int numBands, OGREnvelope extent) 
@@ -604,11 +598,21 @@ namespace rsgis{namespace img{
             double centre_x = extent.MinX + (extent.MaxX - extent.MinX)/2;
             double centre_y = extent.MinY + (extent.MaxY - extent.MinY)/2;
             
-            OGRFeature *poFeature = new OGRFeature(featDefn);
-            OGRPoint *pt = new OGRPoint(centre_x, centre_y, 0.0);
-            poFeature->SetGeometryDirectly(pt);
-            vecLayer->CreateFeature(poFeature);
+            this->featSink->writeGeometryDirectly(new OGRPoint(centre_x, centre_y, 0.0));
+        }
+    }
+    
+    bool RSGISExtractPxlsAsPtsImgCalc::calcImageBlockAtPxls(const float* const* bands, int numBands, size_t nPxls, const RSGISPxlCoordsGenerator &pxlCoords)
+    {
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            if(bands[0][p] == maskValue)
+            {
+                RSGISPxlCoords coords = pxlCoords.getPxlCoords(p);
+                this->featSink->writeGeometryDirectly(new OGRPoint(coords.getCentreX(), coords.getCentreY(), 0.0));
+            }
         }
+        return true;
     }
 
     RSGISExtractPxlsAsPtsImgCalc::~RSGISExtractPxlsAsPtsImgCalc()
@@ -634,6 +638,19 @@ namespace rsgis{namespace img{
         }
     }
     
+    bool RSGISExtractPxlsAsPts2VecImgCalc::calcImageBlockAtPxls(const float* const* bands, int numBands, size_t nPxls, const RSGISPxlCoordsGenerator &pxlCoords)
+    {
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            if(bands[0][p] == maskValue)
+            {
+                RSGISPxlCoords coords = pxlCoords.getPxlCoords(p);
+                pxPts->push_back(std::pair<double,double>(coords.getCentreX(), coords.getCentreY()));
+            }
+        }
+        return true;
+    }
+    
     RSGISExtractPxlsAsPts2VecImgCalc::~RSGISExtractPxlsAsPts2VecImgCalc()
     {
         
@@ -656,6 +673,19 @@ namespace rsgis{namespace img{
         }
     }
     
+    bool RSGISExtractPxlsAsPts2VecWithValImgCalc::calcImageBlockAtPxls(const float* const* bands, int numBands, size_t nPxls, const RSGISPxlCoordsGenerator &pxlCoords)
+    {
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            if(bands[0][p] == maskValue)
+            {
+                RSGISPxlCoords coords = pxlCoords.getPxlCoords(p);
+                pxPts->push_back(std::pair<std::pair<double,double>, double>(std::pair<double,double>(coords.getCentreX(), coords.getCentreY()), bands[valIdx][p]));
+            }
+        }
+        return true;
+    }
+    
     RSGISExtractPxlsAsPts2VecWithValImgCalc::~RSGISExtractPxlsAsPts2VecWithValImgCalc()
     {
         
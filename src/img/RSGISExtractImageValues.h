@@ -28,6 +28,8 @@
 #include <string>
 #include <vector>
 #include <utility>
+#include <algorithm>
+#include <cmath>
 
 #include "gdal_priv.h"
 
@@ -36,9 +38,11 @@
 #include "img/RSGISCalcImage.h"
 
 #include "utils/RSGISExportData2HDF.h"
+#include "utils/RSGISOGRFeatureSink.h"
 
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int.hpp>
+#include <boost/random/uniform_real.hpp>
 #include <boost/random/variate_generator.hpp>
 
 // mark all exported classes/functions with DllExport to have
@@ -56,6 +60,8 @@
 
 namespace rsgis{namespace img{
 	
+    static const unsigned int RSGIS_HDF_SAMPLE_CHUNK_ROWS( 100000 );
+    static const unsigned int RSGIS_EXTRACT_MASK_STRIP_ROWS( 256 );
     
     class DllExport RSGISExtractImageValues
     {
@@ -66,6 +72,9 @@ namespace rsgis{namespace img{
         void sampleExtractedHDFData(std::string inputH5, std::string outputH5, unsigned int nSamples, int seed, RSGISLibDataType dataType);
         void splitExtractedHDFData(std::string inputH5, std::string outputP1H5, std::string outputP2H5, unsigned int nSamples, int seed, RSGISLibDataType dataType);
         ~RSGISExtractImageValues();
+    protected:
+        /** Stream the rows of the input in chunks, writing nSamples randomly selected rows to sampleHDF and, if not NULL, the other rows to remainHDF. */
+        void sampleExtractedHDFRows(rsgis::utils::RSGISReadHDFColumnData *readHDFCol, unsigned int nRows, unsigned int nCols, unsigned int nSamples, int seed, rsgis::utils::RSGISExportColumnData2HDF *sampleHDF, rsgis::utils::RSGISExportColumnData2HDF *remainHDF);
     };
     
 	
@@ -111,12 +120,12 @@ namespace rsgis{namespace img{
     class DllExport RSGISExtractPxlsAsPtsImgCalc : public RSGISCalcImageValue
     {
     public:
-        RSGISExtractPxlsAsPtsImgCalc(OGRLayer *vecLayer, float maskValue);
+        RSGISExtractPxlsAsPtsImgCalc(rsgis::utils::RSGISOGRFeatureSink *featSink, float maskValue);
         void calcImageValue(float *bandValues, int numBands, OGREnvelope extent);
+        bool calcImageBlockAtPxls(const float* const* bands, int numBands, size_t nPxls, const RSGISPxlCoordsGenerator &pxlCoords);
         ~RSGISExtractPxlsAsPtsImgCalc();
     private:
-        OGRLayer *vecLayer;
-        OGRFeatureDefn *featDefn;
+        rsgis::utils::RSGISOGRFeatureSink *featSink;
         float maskValue;
     };
     
@@ -125,6 +134,7 @@ namespace rsgis{namespace img{
     public:
         RSGISExtractPxlsAsPts2VecImgCalc(std::vector<std::pair<double,double> > *pxPts, float maskValue);
         void calcImageValue(float *bandValues, int numBands, OGREnvelope extent);
+        bool calcImageBlockAtPxls(const float* const* bands, int numBands, size_t nPxls, const RSGISPxlCoordsGenerator &pxlCoords);
         ~RSGISExtractPxlsAsPts2VecImgCalc();
     private:
         std::vector<std::pair<double,double> > *pxPts;
@@ -136,6 +146,7 @@ namespace rsgis{namespace img{
     public:
         RSGISExtractPxlsAsPts2VecWithValImgCalc(std::vector<std::pair<std::pair<double,double>,double> > *pxPts, float maskValue, int valIdx);
         void calcImageValue(float *bandValues, int numBands, OGREnvelope extent);
+        bool calcImageBlockAtPxls(const float* const* bands, int numBands, size_t nPxls, const RSGISPxlCoordsGenerator &pxlCoords);
         ~RSGISExtractPxlsAsPts2VecWithValImgCalc();
     private:
         std::vector<std::pair<std::pair<double,double>,double> > *pxPts;
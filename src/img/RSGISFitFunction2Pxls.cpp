@@ -33,65 +33,155 @@ namespace rsgis{namespace img{
     
     void RSGISLinearFit2Column::calcImageValue(float *bandValues, int numBands, double *output) 
     {
-        try
+        if(numBands > this->bandXValues.size())
         {
-            std::vector<double> *dataVals = new std::vector<double>();
-            std::vector<double> *xVals = new std::vector<double>();
+            throw RSGISImageCalcException("The X and Y vectors need to be of the same length.");
+        }
+        
+        // The same fit as gsl_fit_linear using sums of the valid values.
+        double n = 0.0;
+        double sumX = 0.0;
+        double sumY = 0.0;
+        for(int i = 0; i < numBands; ++i)
+        {
+            if(!(this->useNoDataValue & (bandValues[i] == this->noDataValue)))
+            {
+                n += 1;
+                sumX += this->bandXValues[i];
+                sumY += bandValues[i];
+            }
+        }
+        
+        if(n > 0)
+        {
+            double meanX = sumX / n;
+            double meanY = sumY / n;
+            double sXX = 0.0;
+            double sXY = 0.0;
             for(int i = 0; i < numBands; ++i)
             {
-                if(this->useNoDataValue & (bandValues[i] == this->noDataValue))
-                {
-                    // ignore value.
-                }
-                else
+                if(!(this->useNoDataValue & (bandValues[i] == this->noDataValue)))
                 {
-                    dataVals->push_back(bandValues[i]);
-                    xVals->push_back(bandXValues.at(i));
+                    double dx = this->bandXValues[i] - meanX;
+                    sXX += dx * dx;
+                    sXY += dx * (bandValues[i] - meanY);
                 }
             }
+            double c1 = sXY / sXX;
+            double c0 = meanY - (meanX * c1);
             
-            if(dataVals->size() != xVals->size())
+            double sumsq = 0.0;
+            for(int i = 0; i < numBands; ++i)
             {
-                std::cout << "dataVals->size() = " << dataVals->size() << std::endl;
-                std::cout << "xVals->size() = " << xVals->size() << std::endl;
-                throw RSGISImageCalcException("The X and Y vectors need to be of the same length.");
+                if(!(this->useNoDataValue & (bandValues[i] == this->noDataValue)))
+                {
+                    double d = (bandValues[i] - meanY) - (c1 * (this->bandXValues[i] - meanX));
+                    sumsq += d * d;
+                }
             }
-            else if(dataVals->size() > 0)
+            
+            output[0] = c0;
+            output[1] = c1;
+            output[2] = sumsq;
+        }
+        else
+        {
+            output[0] = 0.0;
+            output[1] = 0.0;
+            output[2] = 0.0;
+        }
+    }
+    
+    bool RSGISLinearFit2Column::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        if(numBands > this->bandXValues.size())
+        {
+            throw RSGISImageCalcException("The X and Y vectors need to be of the same length.");
+        }
+        
+        this->blockN.assign(nPxls, 0.0);
+        this->blockSumX.assign(nPxls, 0.0);
+        this->blockSXX.assign(nPxls, 0.0);
+        this->blockSXY.assign(nPxls, 0.0);
+        double *n = this->blockN.data();
+        double *meanX = this->blockSumX.data();
+        double *sXX = this->blockSXX.data();
+        double *sXY = this->blockSXY.data();
+        double *meanY = output[0];
+        double *slope = output[1];
+        double *sumsq = output[2];
+        const bool useNoData = this->useNoDataValue;
+        const float noData = this->noDataValue;
+        
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            meanY[p] = 0.0;
+        }
+        for(int i = 0; i < numBands; ++i)
+        {
+            const float *yVals = bands[i];
+            const double x = this->bandXValues[i];
+            for(size_t p = 0; p < nPxls; ++p)
             {
-                double c0 = 0.0;
-                double c1 = 0.0;
-                double cov00 = 0.0;
-                double cov01 = 0.0;
-                double cov11 = 0.0;
-                double sumsq = 0.0;
-                
-                gsl_fit_linear(&(*xVals)[0], 1, &(*dataVals)[0], 1, dataVals->size(), &c0, &c1, &cov00, &cov01, &cov11, &sumsq);
-                
-                output[0] = c0;
-                output[1] = c1;
-                output[2] = sumsq;
+                bool valid = !(useNoData & (yVals[p] == noData));
+                n[p] += valid ? 1.0 : 0.0;
+                meanX[p] += valid ? x : 0.0;
+                meanY[p] += valid ? yVals[p] : 0.0;
             }
-            else
+        }
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            meanX[p] = meanX[p] / n[p];
+            meanY[p] = meanY[p] / n[p];
+        }
+        
+        for(int i = 0; i < numBands; ++i)
+        {
+            const float *yVals = bands[i];
+            const double x = this->bandXValues[i];
+            for(size_t p = 0; p < nPxls; ++p)
             {
-                output[0] = 0.0;
-                output[1] = 0.0;
-                output[2] = 0.0;
+                bool valid = !(useNoData & (yVals[p] == noData));
+                double dx = x - meanX[p];
+                sXX[p] += valid ? (dx * dx) : 0.0;
+                sXY[p] += valid ? (dx * (yVals[p] - meanY[p])) : 0.0;
             }
-            
-            
-            delete dataVals;
-            delete xVals;
         }
-        catch(RSGISException &e)
+        for(size_t p = 0; p < nPxls; ++p)
         {
-            throw RSGISImageCalcException(e.what());
+            slope[p] = sXY[p] / sXX[p];
+            sumsq[p] = 0.0;
         }
-        catch(std::exception &e)
+        
+        for(int i = 0; i < numBands; ++i)
         {
-            throw RSGISImageCalcException(e.what());
+            const float *yVals = bands[i];
+            const double x = this->bandXValues[i];
+            for(size_t p = 0; p < nPxls; ++p)
+            {
+                bool valid = !(useNoData & (yVals[p] == noData));
+                double d = (yVals[p] - meanY[p]) - (slope[p] * (x - meanX[p]));
+                sumsq[p] += valid ? (d * d) : 0.0;
+            }
         }
+        
+        // Output the intercept in place of the mean of y and 0 where there were no values.
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            if(n[p] > 0)
+            {
+                meanY[p] = meanY[p] - (meanX[p] * slope[p]);
+            }
+            else
+            {
+                meanY[p] = 0.0;
+                slope[p] = 0.0;
+                sumsq[p] = 0.0;
+            }
+        }
+        return true;
     }
-       
+    
     RSGISLinearFit2Column::~RSGISLinearFit2Column()
     {
         
@@ -25,6 +25,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
@@ -51,16 +52,28 @@
 namespace rsgis{namespace img{
     
     
+    /**
+     * Fits a line (as gsl_fit_linear) to the values of the bands of each pixel,
+     * ignoring the no data values, and outputs the intercept, the slope and the
+     * sum of the squared residuals. The block API accumulates the sums for all the
+     * pixels of a block one band at a time so the loops can be vectorised.
+     */
     class DllExport RSGISLinearFit2Column: public RSGISCalcImageValue
     {
     public:
         RSGISLinearFit2Column(std::vector<float> bandXValues, float noDataValue=0, bool useNoDataValue=false);
         void calcImageValue(float *bandValues, int numBands, double *output);
+        bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        RSGISCalcImageValue* clone(){return new RSGISLinearFit2Column(this->bandXValues, this->noDataValue, this->useNoDataValue);};
         ~RSGISLinearFit2Column();
     protected:
         std::vector<float> bandXValues;
         float noDataValue;
         bool useNoDataValue;
+        std::vector<double> blockN;
+        std::vector<double> blockSumX;
+        std::vector<double> blockSXX;
+        std::vector<double> blockSXY;
     };
     
     
@@ -85,30 +85,23 @@ namespace rsgis { namespace img {
         }
     }
     
-    unsigned int* RSGISGenHistogram::genGetHistogram(GDALDataset *dataset, unsigned int imgBand, double imgMin, double imgMax, float binWidth, unsigned int *nBins)
+    unsigned int* RSGISGenHistogram::genGetHistogram(GDALDataset *dataset, unsigned int imgBand, double imgMin, double imgMax, float binWidth, unsigned int *nBins, unsigned int numThreads)
     {
         unsigned int *bins = NULL;
         try
         {
             double range = (imgMax - imgMin);
             *nBins = ceil((range/binWidth)+0.5);
-            bins = new unsigned int[(*nBins)];
-            float *binRanges = new float[(*nBins)+1];
             
+            // Populate the Histogram - reading the band once on numThreads threads...
+            RSGISImageHistogramEngine histEngine = RSGISImageHistogramEngine(numThreads);
+            std::vector<RSGISBandHistogram> hists = histEngine.calcHistograms(dataset, std::vector<unsigned int>(1, imgBand+1), imgMin, binWidth, (*nBins), false, 0.0);
+            
+            bins = new unsigned int[(*nBins)];
             for(unsigned int i = 0; i < (*nBins); ++i)
             {
-                bins[i] = 0;
-                binRanges[i] = imgMin + (i * binWidth);
+                bins[i] = hists[0].bins[i];
             }
-            binRanges[(*nBins)] = imgMin + ((*nBins) * binWidth);
-            
-            // Populate the Histogram - using image calc...
-            RSGISGenHistogramNoMaskCalcVal *genHists = new RSGISGenHistogramNoMaskCalcVal(bins, binRanges, imgBand, (*nBins), binWidth);
-            RSGISCalcImage calcImage = RSGISCalcImage(genHists);
-            calcImage.calcImage(&dataset, 1);
-            
-            delete[] binRanges;
-            delete genHists;
         }
         catch (RSGISImageCalcException &e)
         {
@@ -126,52 +119,30 @@ namespace rsgis { namespace img {
     {
         try
         {
-            RSGISGen2DHistogramCalcVal *genHists = new RSGISGen2DHistogramCalcVal(img1BandIdx, img2BandIdx, histgramMatrix, numBins, img1Bins, img2Bins, img1Scale, img2Scale, img1Off, img2Off);
-            RSGISCalcImage calcImage = RSGISCalcImage(genHists);
+            // The histogram is accumulated with thread-local counts which are merged at the end.
+            RSGISImageComparison compImgs = RSGISImageComparison(std::vector<std::pair<unsigned int, unsigned int> >(), false);
+            compImgs.setHistogram(img1BandIdx, img2BandIdx, numBins, img1Bins, img2Bins, img1Scale, img2Scale, img1Off, img2Off);
+            RSGISCalcImage calcImage = RSGISCalcImage(&compImgs);
             calcImage.calcImage(datasets, numDS);
-            delete genHists;
             
-            double img1Mean = 0.0;
-            double img1N = 0.0;
-            double lclN = 0.0;
-            double binValImg1 = 0.0;
+            const std::vector<double> &hist = compImgs.getHistogram();
             for(unsigned int i = 0; i < numBins; ++i)
             {
-                lclN = 0.0;
-                binValImg1 = img1Bins[i] + ((img1Bins[i+1]-img1Bins[i])/2);
                 for(unsigned int j = 0; j < numBins; ++j)
                 {
-                    lclN += histgramMatrix[i][j];
+                    histgramMatrix[i][j] += hist[(i * numBins) + j];
                 }
-                img1Mean += (lclN * binValImg1);
-                img1N += lclN;
             }
-            img1Mean = img1Mean / img1N;
             
-            double img1Diff2Mean = 0.0;
-            double img1DiffImg2 = 0.0;
-            double binValImg2 = 0.0;
+            std::vector<double> histVals(numBins * numBins);
             for(unsigned int i = 0; i < numBins; ++i)
             {
-                lclN = 0.0;
-                binValImg1 = img1Bins[i] + ((img1Bins[i+1]-img1Bins[i])/2);
                 for(unsigned int j = 0; j < numBins; ++j)
                 {
-                    lclN += histgramMatrix[i][j];
-                    binValImg2 = img2Bins[j] + ((img2Bins[j+1]-img2Bins[j])/2);
-                    for(unsigned int n = 0; n < histgramMatrix[i][j]; ++n)
-                    {
-                        img1DiffImg2 += ((binValImg1 - binValImg2) * (binValImg1 - binValImg2));
-                    }
-                }
-                
-                for(unsigned int n = 0; n < lclN; ++n)
-                {
-                    img1Diff2Mean += ((binValImg1 - img1Mean) * (binValImg1 - img1Mean));
+                    histVals[(i * numBins) + j] = histgramMatrix[i][j];
                 }
             }
-            
-            *rSq = 1 - (img1DiffImg2 / img1Diff2Mean);
+            *rSq = RSGISImageComparison::calcHistogramRSq(histVals.data(), numBins, img1Bins, img2Bins);
         }
         catch (RSGISImageCalcException &e)
         {
@@ -32,6 +32,8 @@
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISImageBandException.h"
 #include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageHistogramEngine.h"
+#include "img/RSGISImageComparison.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -53,7 +55,7 @@ namespace rsgis { namespace img {
     public:
         RSGISGenHistogram();
         void genHistogram(GDALDataset **datasets, unsigned int numDS, std::string outputFile, unsigned int imgBand, double imgMin, double imgMax, float maskValue, float binWidth);
-        unsigned int* genGetHistogram(GDALDataset *dataset, unsigned int imgBand, double imgMin, double imgMax, float binWidth, unsigned int *nBins);
+        unsigned int* genGetHistogram(GDALDataset *dataset, unsigned int imgBand, double imgMin, double imgMax, float binWidth, unsigned int *nBins, unsigned int numThreads=1);
         void gen2DHistogram(GDALDataset **datasets, unsigned int numDS, unsigned int img1BandIdx, unsigned int img2BandIdx, double **histgramMatrix, unsigned int numBins, double *img1Bins, double *img2Bins, double img1Scale, double img2Scale, double img1Off, double img2Off, double *rSq);
         ~RSGISGenHistogram();
     };
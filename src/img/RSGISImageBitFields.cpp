@@ -0,0 +1,291 @@
+/*
+ *  RSGISImageBitFields.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISImageBitFields.h"
+
+namespace rsgis{namespace img{
+    
+    RSGISImageBitFields::RSGISImageBitFields(unsigned int numThreads)
+    {
+        this->numThreads = numThreads;
+    }
+    
+    void RSGISImageBitFields::decodeBitFields(GDALDataset *dataset, unsigned int imgBand, std::vector<RSGISBitField> fields, std::string outputImage, std::string imageFormat)
+    {
+        unsigned int nBits = 0;
+        GDALRasterBand *band = this->getInputBand(dataset, imgBand, &nBits);
+        if(fields.empty())
+        {
+            throw RSGISImageCalcException("At least one bit field must be provided.");
+        }
+        unsigned int maxWidth = 0;
+        for(std::vector<RSGISBitField>::iterator iterField = fields.begin(); iterField != fields.end(); ++iterField)
+        {
+            if((*iterField).width == 0)
+            {
+                throw RSGISImageCalcException("The width of a bit field must be at least 1.");
+            }
+            if(((*iterField).offset >= nBits) || ((*iterField).width > (nBits - (*iterField).offset)))
+            {
+                throw RSGISImageCalcException("A bit field is not within the bits of the input image band data type.");
+            }
+            maxWidth = std::max(maxWidth, (*iterField).width);
+        }
+        
+        GDALDataType outDataType = GDT_UInt32;
+        if(maxWidth <= 8)
+        {
+            outDataType = GDT_Byte;
+        }
+        else if(maxWidth <= 16)
+        {
+            outDataType = GDT_UInt16;
+        }
+        
+        int stripRows = 0;
+        GDALDataset *outputImageDS = this->createOutputImage(dataset, band, outputImage, imageFormat, fields.size(), outDataType, &stripRows);
+        int width = dataset->GetRasterXSize();
+        int height = dataset->GetRasterYSize();
+        GDALDataType readType = band->GetRasterDataType();
+        try
+        {
+            if(nBits == 8)
+            {
+                this->decodeBitFieldsT<uint8_t, uint8_t>(band, readType, fields, outputImageDS, width, height, stripRows);
+            }
+            else if(nBits == 16)
+            {
+                if(outDataType == GDT_Byte)
+                {
+                    this->decodeBitFieldsT<uint16_t, uint8_t>(band, readType, fields, outputImageDS, width, height, stripRows);
+                }
+                else
+                {
+                    this->decodeBitFieldsT<uint16_t, uint16_t>(band, readType, fields, outputImageDS, width, height, stripRows);
+                }
+            }
+            else
+            {
+                if(outDataType == GDT_Byte)
+                {
+                    this->decodeBitFieldsT<uint32_t, uint8_t>(band, readType, fields, outputImageDS, width, height, stripRows);
+                }
+                else if(outDataType == GDT_UInt16)
+                {
+                    this->decodeBitFieldsT<uint32_t, uint16_t>(band, readType, fields, outputImageDS, width, height, stripRows);
+                }
+                else
+                {
+                    this->decodeBitFieldsT<uint32_t, uint32_t>(band, readType, fields, outputImageDS, width, height, stripRows);
+                }
+            }
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            GDALClose(outputImageDS);
+            throw e;
+        }
+        GDALClose(outputImageDS);
+    }
+    
+    void RSGISImageBitFields::genBitPatternMask(GDALDataset *dataset, unsigned int imgBand, std::vector<RSGISBitPatternRule> rules, uint8_t noMatchVal, std::string outputImage, std::string imageFormat)
+    {
+        unsigned int nBits = 0;
+        GDALRasterBand *band = this->getInputBand(dataset, imgBand, &nBits);
+        if(rules.empty())
+        {
+            throw RSGISImageCalcException("At least one bit pattern rule must be provided.");
+        }
+        const uint32_t typeMask = (nBits == 32)?(~((uint32_t)0)):((((uint32_t)1) << nBits) - 1);
+        for(std::vector<RSGISBitPatternRule>::iterator iterRule = rules.begin(); iterRule != rules.end(); ++iterRule)
+        {
+            if(((*iterRule).bitMask & (~typeMask)) != 0)
+            {
+                throw RSGISImageCalcException("The bit mask of a rule is not within the bits of the input image band data type.");
+            }
+            if(((*iterRule).bitValue & (~(*iterRule).bitMask)) != 0)
+            {
+                throw RSGISImageCalcException("The bit value of a rule has bits set which are not within its bit mask so would never match.");
+            }
+        }
+        
+        int stripRows = 0;
+        GDALDataset *outputImageDS = this->createOutputImage(dataset, band, outputImage, imageFormat, 1, GDT_Byte, &stripRows);
+        int width = dataset->GetRasterXSize();
+        int height = dataset->GetRasterYSize();
+        GDALDataType readType = band->GetRasterDataType();
+        try
+        {
+            if(nBits == 8)
+            {
+                this->genBitPatternMaskT<uint8_t>(band, readType, rules, noMatchVal, outputImageDS, width, height, stripRows);
+            }
+            else if(nBits == 16)
+            {
+                this->genBitPatternMaskT<uint16_t>(band, readType, rules, noMatchVal, outputImageDS, width, height, stripRows);
+            }
+            else
+            {
+                this->genBitPatternMaskT<uint32_t>(band, readType, rules, noMatchVal, outputImageDS, width, height, stripRows);
+            }
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            GDALClose(outputImageDS);
+            throw e;
+        }
+        GDALClose(outputImageDS);
+    }
+    
+    template <typename InT, typename OutT> void RSGISImageBitFields::decodeBitFieldsT(GDALRasterBand *band, GDALDataType readType, std::vector<RSGISBitField> &fields, GDALDataset *outputImageDS, int width, int height, int stripRows)
+    {
+        size_t stripPxls = ((size_t)width) * stripRows;
+        size_t numFields = fields.size();
+        std::vector<InT> inData(stripPxls);
+        std::vector<std::vector<OutT> > outData(numFields, std::vector<OutT>(stripPxls));
+        GDALDataType outType = outputImageDS->GetRasterBand(1)->GetRasterDataType();
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        
+        rsgis_tqdm pbar;
+        for(int row = 0; row < height; row += stripRows)
+        {
+            pbar.progress(row, height);
+            int nRows = std::min(stripRows, height - row);
+            size_t nPxls = ((size_t)width) * nRows;
+            // Signed bands are read in their own type so the bit patterns are not clamped.
+            if(band->RasterIO(GF_Read, 0, row, width, nRows, inData.data(), width, nRows, readType, 0, 0) != CE_None)
+            {
+                throw RSGISImageCalcException("Failed to read the input image data.");
+            }
+            
+            threadPool.parallelFor(0, nPxls, [&](unsigned int t, size_t pStart, size_t pEnd)
+            {
+                for(size_t f = 0; f < numFields; ++f)
+                {
+                    RSGISImageBitFields::decodeField<InT, OutT>(inData.data(), pStart, pEnd, fields[f].offset, fields[f].width, outData[f].data());
+                }
+            });
+            
+            for(size_t f = 0; f < numFields; ++f)
+            {
+                if(outputImageDS->GetRasterBand(f+1)->RasterIO(GF_Write, 0, row, width, nRows, outData[f].data(), width, nRows, outType, 0, 0) != CE_None)
+                {
+                    throw RSGISImageCalcException("Failed to write the output image data.");
+                }
+            }
+        }
+        pbar.finish();
+    }
+    
+    template <typename InT> void RSGISImageBitFields::genBitPatternMaskT(GDALRasterBand *band, GDALDataType readType, std::vector<RSGISBitPatternRule> &rules, uint8_t noMatchVal, GDALDataset *outputImageDS, int width, int height, int stripRows)
+    {
+        size_t stripPxls = ((size_t)width) * stripRows;
+        std::vector<InT> inData(stripPxls);
+        std::vector<uint8_t> outData(stripPxls);
+        GDALRasterBand *outBand = outputImageDS->GetRasterBand(1);
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        
+        rsgis_tqdm pbar;
+        for(int row = 0; row < height; row += stripRows)
+        {
+            pbar.progress(row, height);
+            int nRows = std::min(stripRows, height - row);
+            size_t nPxls = ((size_t)width) * nRows;
+            if(band->RasterIO(GF_Read, 0, row, width, nRows, inData.data(), width, nRows, readType, 0, 0) != CE_None)
+            {
+                throw RSGISImageCalcException("Failed to read the input image data.");
+            }
+            
+            threadPool.parallelFor(0, nPxls, [&](unsigned int t, size_t pStart, size_t pEnd)
+            {
+                RSGISImageBitFields::applyBitPatternRules<InT>(inData.data(), pStart, pEnd, rules, noMatchVal, outData.data());
+            });
+            
+            if(outBand->RasterIO(GF_Write, 0, row, width, nRows, outData.data(), width, nRows, GDT_Byte, 0, 0) != CE_None)
+            {
+                throw RSGISImageCalcException("Failed to write the output image data.");
+            }
+        }
+        pbar.finish();
+    }
+    
+    GDALRasterBand* RSGISImageBitFields::getInputBand(GDALDataset *dataset, unsigned int imgBand, unsigned int *nBits)
+    {
+        if((imgBand == 0) || (imgBand > ((unsigned int)dataset->GetRasterCount())))
+        {
+            throw RSGISImageCalcException("The input image band is not within the input image.");
+        }
+        GDALRasterBand *band = dataset->GetRasterBand(imgBand);
+        switch(band->GetRasterDataType())
+        {
+            case GDT_Byte:
+                *nBits = 8;
+                break;
+            case GDT_UInt16:
+            case GDT_Int16:
+                *nBits = 16;
+                break;
+            case GDT_UInt32:
+            case GDT_Int32:
+                *nBits = 32;
+                break;
+            default:
+                throw RSGISImageCalcException("The input image band is not an 8, 16 or 32 bit integer data type.");
+        }
+        return band;
+    }
+    
+    GDALDataset* RSGISImageBitFields::createOutputImage(GDALDataset *dataset, GDALRasterBand *band, std::string outputImage, std::string imageFormat, int numOutBands, GDALDataType outDataType, int *stripRows)
+    {
+        RSGISImageUtils imgUtils;
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        band->GetBlockSize(&xBlockSize, &yBlockSize);
+        yBlockSize = std::max(yBlockSize, 1);
+        *stripRows = ((RSGIS_BITFIELD_STRIP_ROWS + yBlockSize - 1) / yBlockSize) * yBlockSize;
+        
+        GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(imageFormat.c_str());
+        if(gdalDriver == NULL)
+        {
+            throw RSGISImageBandException("Requested GDAL driver does not exists..");
+        }
+        char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(imageFormat);
+        std::cout << "New image width = " << dataset->GetRasterXSize() << " height = " << dataset->GetRasterYSize() << " bands = " << numOutBands << std::endl;
+        GDALDataset *outputImageDS = gdalDriver->Create(outputImage.c_str(), dataset->GetRasterXSize(), dataset->GetRasterYSize(), numOutBands, outDataType, papszOptions);
+        if(outputImageDS == NULL)
+        {
+            throw RSGISImageBandException("Output image could not be created. Check filepath.");
+        }
+        double gdalTranslation[6];
+        dataset->GetGeoTransform(gdalTranslation);
+        outputImageDS->SetGeoTransform(gdalTranslation);
+        outputImageDS->SetProjection(dataset->GetProjectionRef());
+        return outputImageDS;
+    }
+    
+    RSGISImageBitFields::~RSGISImageBitFields()
+    {
+        
+    }
+    
+}}
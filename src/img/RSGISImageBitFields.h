@@ -0,0 +1,136 @@
+/*
+ *  RSGISImageBitFields.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISImageBitFields_H
+#define RSGISImageBitFields_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+#include "gdal_priv.h"
+
+#include "common/rsgis-tqdm.h"
+#include "common/RSGISThreadPool.h"
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageBandException.h"
+#include "img/RSGISImageUtils.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+    
+    /** The minimum number of image rows processed at a time (rounded up to a multiple of the image block height). */
+    static const unsigned int RSGIS_BITFIELD_STRIP_ROWS( 256 );
+    
+    /** A field of width bits starting at bit offset (0 is the least significant bit). */
+    struct DllExport RSGISBitField
+    {
+        unsigned int offset;
+        unsigned int width;
+    };
+    
+    /** A pixel matches the rule where (value & bitMask) == bitValue, and is then given outVal. */
+    struct DllExport RSGISBitPatternRule
+    {
+        uint32_t bitMask;
+        uint32_t bitValue;
+        uint8_t outVal;
+    };
+    
+    /**
+     * Decodes bit packed integer bands, such as the QA bands provided with optical
+     * imagery (e.g., Landsat QA_PIXEL). Each strip of the input band is read once
+     * into a buffer of its own (unsigned) integer type and all the fields, or the
+     * rules, are applied to that buffer with plain shift and mask loops, which the
+     * compiler vectorises, before the output bands are written. Signed bands are
+     * decoded from their two's complement bit patterns. The pixels of each strip
+     * are split across numThreads threads (0 uses all the available cores).
+     */
+    class DllExport RSGISImageBitFields
+    {
+    public:
+        RSGISImageBitFields(unsigned int numThreads=1);
+        /**
+         * Output a band for each field, with the value of the field's bits. The output
+         * data type is the smallest unsigned integer type for the widest field.
+         */
+        void decodeBitFields(GDALDataset *dataset, unsigned int imgBand, std::vector<RSGISBitField> fields, std::string outputImage, std::string imageFormat);
+        /**
+         * Output a single band mask where each pixel is given the outVal of the first rule
+         * it matches or noMatchVal if it matches none of the rules (e.g., 1 for cloud and
+         * 2 for cloud shadow from the bits of a QA band).
+         */
+        void genBitPatternMask(GDALDataset *dataset, unsigned int imgBand, std::vector<RSGISBitPatternRule> rules, uint8_t noMatchVal, std::string outputImage, std::string imageFormat);
+        ~RSGISImageBitFields();
+        
+        /** Decode the field [offset, offset+width) of data[i] to out[i] for i in [pStart, pEnd). */
+        template <typename InT, typename OutT> static void decodeField(const InT *data, size_t pStart, size_t pEnd, unsigned int offset, unsigned int width, OutT *out)
+        {
+            const InT mask = (InT)((width >= (sizeof(InT)*8))?(~((InT)0)):((((uint64_t)1) << width) - 1));
+            for(size_t i = pStart; i < pEnd; ++i)
+            {
+                out[i] = (OutT)((data[i] >> offset) & mask);
+            }
+        };
+        /** Set out[i] to the outVal of the first rule matched by data[i], or noMatchVal, for i in [pStart, pEnd). */
+        template <typename InT> static void applyBitPatternRules(const InT *data, size_t pStart, size_t pEnd, const std::vector<RSGISBitPatternRule> &rules, uint8_t noMatchVal, uint8_t *out)
+        {
+            std::fill(out + pStart, out + pEnd, noMatchVal);
+            // The rules are applied in reverse so the first matching rule is the last to be written.
+            for(std::vector<RSGISBitPatternRule>::const_reverse_iterator iterRule = rules.rbegin(); iterRule != rules.rend(); ++iterRule)
+            {
+                const InT bitMask = (InT)(*iterRule).bitMask;
+                const InT bitValue = (InT)(*iterRule).bitValue;
+                const uint8_t outVal = (*iterRule).outVal;
+                for(size_t i = pStart; i < pEnd; ++i)
+                {
+                    out[i] = ((data[i] & bitMask) == bitValue)?outVal:out[i];
+                }
+            }
+        };
+    protected:
+        template <typename InT, typename OutT> void decodeBitFieldsT(GDALRasterBand *band, GDALDataType readType, std::vector<RSGISBitField> &fields, GDALDataset *outputImageDS, int width, int height, int stripRows);
+        template <typename InT> void genBitPatternMaskT(GDALRasterBand *band, GDALDataType readType, std::vector<RSGISBitPatternRule> &rules, uint8_t noMatchVal, GDALDataset *outputImageDS, int width, int height, int stripRows);
+        GDALRasterBand* getInputBand(GDALDataset *dataset, unsigned int imgBand, unsigned int *nBits);
+        GDALDataset* createOutputImage(GDALDataset *dataset, GDALRasterBand *band, std::string outputImage, std::string imageFormat, int numOutBands, GDALDataType outDataType, int *stripRows);
+        unsigned int numThreads;
+    };
+    
+}}
+
+#endif
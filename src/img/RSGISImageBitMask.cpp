@@ -0,0 +1,365 @@
+/*
+ *  RSGISImageBitMask.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISImageBitMask.h"
+
+namespace rsgis{namespace img{
+    
+    RSGISImageBitMask::RSGISImageBitMask(unsigned int numThreads)
+    {
+        this->numThreads = numThreads;
+    }
+    
+    void RSGISImageBitMask::genValidMask(GDALDataset **datasets, unsigned int numImages, std::string outputImage, std::string imageFormat, float noDataVal, RSGISBitMaskCombine imgCombine)
+    {
+        this->genMask(datasets, numImages, outputImage, imageFormat, false, noDataVal, imgCombine);
+    }
+    
+    void RSGISImageBitMask::genFiniteMask(GDALDataset **datasets, unsigned int numImages, std::string outputImage, std::string imageFormat, RSGISBitMaskCombine imgCombine)
+    {
+        this->genMask(datasets, numImages, outputImage, imageFormat, true, 0.0, imgCombine);
+    }
+    
+    void RSGISImageBitMask::genMask(GDALDataset **datasets, unsigned int numImages, std::string outputImage, std::string imageFormat, bool testFinite, float noDataVal, RSGISBitMaskCombine imgCombine)
+    {
+        GDALDataset *outputImageDS = NULL;
+        try
+        {
+            std::vector<int> dsOffsetVals;
+            int width = 0;
+            int height = 0;
+            int stripRows = 0;
+            outputImageDS = this->createOutputImage(datasets, numImages, outputImage, imageFormat, GDT_Byte, &dsOffsetVals, &width, &height, &stripRows);
+            GDALRasterBand *outBand = outputImageDS->GetRasterBand(1);
+            
+            size_t stripPxls = ((size_t)width) * stripRows;
+            size_t stripWords = (stripPxls + 63) / 64;
+            std::vector<uint64_t> maskWords(stripWords);
+            std::vector<uint64_t> imgWords(stripWords);
+            std::vector<uint64_t> bandWords(stripWords);
+            std::vector<double> bandBuffer(stripPxls);
+            std::vector<uint8_t> outData(stripPxls);
+            rsgis::RSGISThreadPool threadPool(this->numThreads);
+            
+            rsgis_tqdm pbar;
+            for(int row = 0; row < height; row += stripRows)
+            {
+                pbar.progress(row, height);
+                int nRows = std::min(stripRows, height - row);
+                size_t nPxls = ((size_t)width) * nRows;
+                size_t nWords = (nPxls + 63) / 64;
+                for(unsigned int i = 0; i < numImages; ++i)
+                {
+                    // The first image is combined directly into the output mask.
+                    uint64_t *imgMask = (i == 0)?maskWords.data():imgWords.data();
+                    std::fill(imgMask, imgMask + nWords, ~((uint64_t)0));
+                    for(int n = 0; n < datasets[i]->GetRasterCount(); ++n)
+                    {
+                        this->readPackBand(datasets[i]->GetRasterBand(n+1), dsOffsetVals[i*2], dsOffsetVals[(i*2)+1] + row, width, nRows, testFinite, noDataVal, &bandBuffer, bandWords.data(), &threadPool);
+                        const uint64_t *bWords = bandWords.data();
+                        threadPool.parallelFor(0, nWords, [&](unsigned int t, size_t wStart, size_t wEnd)
+                        {
+                            for(size_t w = wStart; w < wEnd; ++w)
+                            {
+                                imgMask[w] &= bWords[w];
+                            }
+                        });
+                    }
+                    
+                    if(i > 0)
+                    {
+                        uint64_t *mWords = maskWords.data();
+                        threadPool.parallelFor(0, nWords, [&](unsigned int t, size_t wStart, size_t wEnd)
+                        {
+                            if(imgCombine == rsgis_bitmask_or)
+                            {
+                                for(size_t w = wStart; w < wEnd; ++w)
+                                {
+                                    mWords[w] |= imgMask[w];
+                                }
+                            }
+                            else
+                            {
+                                for(size_t w = wStart; w < wEnd; ++w)
+                                {
+                                    mWords[w] &= imgMask[w];
+                                }
+                            }
+                        });
+                    }
+                }
+                
+                threadPool.parallelFor(0, nWords, [&](unsigned int t, size_t wStart, size_t wEnd)
+                {
+                    RSGISImageBitMask::expandBits(maskWords.data(), nPxls, wStart, wEnd, outData.data());
+                });
+                if(outBand->RasterIO(GF_Write, 0, row, width, nRows, outData.data(), width, nRows, GDT_Byte, 0, 0) != CE_None)
+                {
+                    throw RSGISImageCalcException("Failed to write the output image data.");
+                }
+            }
+            pbar.finish();
+            GDALClose(outputImageDS);
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            if(outputImageDS != NULL)
+            {
+                GDALClose(outputImageDS);
+            }
+            throw e;
+        }
+        catch(RSGISImageBandException &e)
+        {
+            if(outputImageDS != NULL)
+            {
+                GDALClose(outputImageDS);
+            }
+            throw e;
+        }
+    }
+    
+    void RSGISImageBitMask::combineImagesIgnoreNoData(GDALDataset **datasets, unsigned int numImages, std::string outputImage, std::string imageFormat, GDALDataType outDataType, float noDataVal)
+    {
+        GDALDataset *outputImageDS = NULL;
+        try
+        {
+            std::vector<int> dsOffsetVals;
+            int width = 0;
+            int height = 0;
+            int stripRows = 0;
+            outputImageDS = this->createOutputImage(datasets, numImages, outputImage, imageFormat, outDataType, &dsOffsetVals, &width, &height, &stripRows);
+            GDALRasterBand *outBand = outputImageDS->GetRasterBand(1);
+            
+            size_t stripPxls = ((size_t)width) * stripRows;
+            size_t stripWords = (stripPxls + 63) / 64;
+            std::vector<uint64_t> bandWords(stripWords);
+            std::vector<double> bandBuffer(stripPxls);
+            std::vector<double> outData(stripPxls);
+            rsgis::RSGISThreadPool threadPool(this->numThreads);
+            
+            rsgis_tqdm pbar;
+            for(int row = 0; row < height; row += stripRows)
+            {
+                pbar.progress(row, height);
+                int nRows = std::min(stripRows, height - row);
+                size_t nPxls = ((size_t)width) * nRows;
+                size_t nWords = (nPxls + 63) / 64;
+                std::fill(outData.begin(), outData.begin() + nPxls, (double)noDataVal);
+                for(unsigned int i = 0; i < numImages; ++i)
+                {
+                    for(int n = 0; n < datasets[i]->GetRasterCount(); ++n)
+                    {
+                        // As with RSGISCombineImagesIgnoreNoData the band values are compared as floats.
+                        float *floatData = (float *)bandBuffer.data();
+                        if(datasets[i]->GetRasterBand(n+1)->RasterIO(GF_Read, dsOffsetVals[i*2], dsOffsetVals[(i*2)+1] + row, width, nRows, floatData, width, nRows, GDT_Float32, 0, 0) != CE_None)
+                        {
+                            throw RSGISImageCalcException("Failed to read the input image data.");
+                        }
+                        threadPool.parallelFor(0, nWords, [&](unsigned int t, size_t wStart, size_t wEnd)
+                        {
+                            RSGISImageBitMask::packValidBits<float>(floatData, nPxls, wStart, wEnd, false, noDataVal, bandWords.data());
+                            for(size_t w = wStart; w < wEnd; ++w)
+                            {
+                                uint64_t bits = bandWords[w];
+                                size_t pStart = w * 64;
+                                if(bits == 0)
+                                {
+                                    continue;
+                                }
+                                else if(bits == ~((uint64_t)0))
+                                {
+                                    for(size_t j = 0; j < 64; ++j)
+                                    {
+                                        outData[pStart + j] = floatData[pStart + j];
+                                    }
+                                }
+                                else
+                                {
+                                    for(size_t j = 0; bits != 0; ++j, bits >>= 1)
+                                    {
+                                        if(bits & 1)
+                                        {
+                                            outData[pStart + j] = floatData[pStart + j];
+                                        }
+                                    }
+                                }
+                            }
+                        });
+                    }
+                }
+                
+                if(outBand->RasterIO(GF_Write, 0, row, width, nRows, outData.data(), width, nRows, GDT_Float64, 0, 0) != CE_None)
+                {
+                    throw RSGISImageCalcException("Failed to write the output image data.");
+                }
+            }
+            pbar.finish();
+            GDALClose(outputImageDS);
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            if(outputImageDS != NULL)
+            {
+                GDALClose(outputImageDS);
+            }
+            throw e;
+        }
+        catch(RSGISImageBandException &e)
+        {
+            if(outputImageDS != NULL)
+            {
+                GDALClose(outputImageDS);
+            }
+            throw e;
+        }
+    }
+    
+    void RSGISImageBitMask::expandBits(const uint64_t *words, size_t nPxls, size_t wStart, size_t wEnd, uint8_t *out)
+    {
+        for(size_t w = wStart; w < wEnd; ++w)
+        {
+            uint64_t bits = words[w];
+            uint8_t *wOut = out + (w * 64);
+            size_t nBits = std::min<size_t>(64, nPxls - (w * 64));
+            for(size_t j = 0; j < nBits; ++j)
+            {
+                wOut[j] = (uint8_t)((bits >> j) & 1);
+            }
+        }
+    }
+    
+    GDALDataset* RSGISImageBitMask::createOutputImage(GDALDataset **datasets, unsigned int numImages, std::string outputImage, std::string imageFormat, GDALDataType outDataType, std::vector<int> *dsOffsetVals, int *width, int *height, int *stripRows)
+    {
+        if(numImages == 0)
+        {
+            throw RSGISImageCalcException("At least one input image must be provided.");
+        }
+        RSGISImageUtils imgUtils;
+        dsOffsetVals->assign(numImages*2, 0);
+        std::vector<int*> dsOffsets(numImages);
+        for(unsigned int i = 0; i < numImages; ++i)
+        {
+            dsOffsets[i] = dsOffsetVals->data() + (i*2);
+        }
+        double gdalTranslation[6];
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        imgUtils.getImageOverlap(datasets, numImages, dsOffsets.data(), width, height, gdalTranslation, &xBlockSize, &yBlockSize);
+        yBlockSize = std::max(yBlockSize, 1);
+        *stripRows = ((RSGIS_BITMASK_STRIP_ROWS + yBlockSize - 1) / yBlockSize) * yBlockSize;
+        
+        GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(imageFormat.c_str());
+        if(gdalDriver == NULL)
+        {
+            throw RSGISImageBandException("Requested GDAL driver does not exists..");
+        }
+        char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(imageFormat);
+        std::cout << "New image width = " << (*width) << " height = " << (*height) << " bands = 1" << std::endl;
+        GDALDataset *outputImageDS = gdalDriver->Create(outputImage.c_str(), *width, *height, 1, outDataType, papszOptions);
+        if(outputImageDS == NULL)
+        {
+            throw RSGISImageBandException("Output image could not be created. Check filepath.");
+        }
+        outputImageDS->SetGeoTransform(gdalTranslation);
+        outputImageDS->SetProjection(datasets[0]->GetProjectionRef());
+        return outputImageDS;
+    }
+    
+    void RSGISImageBitMask::readPackBand(GDALRasterBand *band, int xOff, int yOff, int width, int nRows, bool testFinite, float noDataVal, std::vector<double> *bandBuffer, uint64_t *words, rsgis::RSGISThreadPool *threadPool)
+    {
+        size_t nPxls = ((size_t)width) * nRows;
+        size_t nWords = (nPxls + 63) / 64;
+        GDALDataType bandType = band->GetRasterDataType();
+        bool intType = (bandType == GDT_Byte) || (bandType == GDT_UInt16) || (bandType == GDT_Int16) || (bandType == GDT_UInt32) || (bandType == GDT_Int32);
+        
+        if(testFinite && intType)
+        {
+            // Integer values are always finite so the band does not need to be read.
+            std::fill(words, words + nWords, ~((uint64_t)0));
+            return;
+        }
+        
+        // Integer bands are read and compared in their own type where the no data value
+        // can be represented, otherwise (and for other types) the values are read as floats.
+        GDALDataType readType = GDT_Float32;
+        switch(bandType)
+        {
+            case GDT_Byte:
+                readType = (testFinite || rsgisPixelValueRepresentable<uint8_t>(noDataVal))?GDT_Byte:GDT_Float32;
+                break;
+            case GDT_UInt16:
+                readType = (testFinite || rsgisPixelValueRepresentable<uint16_t>(noDataVal))?GDT_UInt16:GDT_Float32;
+                break;
+            case GDT_Int16:
+                readType = (testFinite || rsgisPixelValueRepresentable<int16_t>(noDataVal))?GDT_Int16:GDT_Float32;
+                break;
+            case GDT_UInt32:
+                readType = (testFinite || rsgisPixelValueRepresentable<uint32_t>(noDataVal))?GDT_UInt32:GDT_Float32;
+                break;
+            case GDT_Int32:
+                readType = (testFinite || rsgisPixelValueRepresentable<int32_t>(noDataVal))?GDT_Int32:GDT_Float32;
+                break;
+            default:
+                readType = GDT_Float32;
+                break;
+        }
+        
+        void *data = bandBuffer->data();
+        if(band->RasterIO(GF_Read, xOff, yOff, width, nRows, data, width, nRows, readType, 0, 0) != CE_None)
+        {
+            throw RSGISImageCalcException("Failed to read the input image data.");
+        }
+        
+        threadPool->parallelFor(0, nWords, [&](unsigned int t, size_t wStart, size_t wEnd)
+        {
+            switch(readType)
+            {
+                case GDT_Byte:
+                    RSGISImageBitMask::packValidBits<uint8_t>((const uint8_t *)data, nPxls, wStart, wEnd, testFinite, (uint8_t)noDataVal, words);
+                    break;
+                case GDT_UInt16:
+                    RSGISImageBitMask::packValidBits<uint16_t>((const uint16_t *)data, nPxls, wStart, wEnd, testFinite, (uint16_t)noDataVal, words);
+                    break;
+                case GDT_Int16:
+                    RSGISImageBitMask::packValidBits<int16_t>((const int16_t *)data, nPxls, wStart, wEnd, testFinite, (int16_t)noDataVal, words);
+                    break;
+                case GDT_UInt32:
+                    RSGISImageBitMask::packValidBits<uint32_t>((const uint32_t *)data, nPxls, wStart, wEnd, testFinite, (uint32_t)noDataVal, words);
+                    break;
+                case GDT_Int32:
+                    RSGISImageBitMask::packValidBits<int32_t>((const int32_t *)data, nPxls, wStart, wEnd, testFinite, (int32_t)noDataVal, words);
+                    break;
+                default:
+                    RSGISImageBitMask::packValidBits<float>((const float *)data, nPxls, wStart, wEnd, testFinite, noDataVal, words);
+                    break;
+            }
+        });
+    }
+    
+    RSGISImageBitMask::~RSGISImageBitMask()
+    {
+        
+    }
+    
+}}
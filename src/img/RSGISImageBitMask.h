@@ -0,0 +1,128 @@
+/*
+ *  RSGISImageBitMask.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISImageBitMask_H
+#define RSGISImageBitMask_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdint.h>
+
+#include "gdal_priv.h"
+
+#include "common/rsgis-tqdm.h"
+#include "common/RSGISThreadPool.h"
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageBandException.h"
+#include "img/RSGISCalcImageT.h"
+#include "img/RSGISImageUtils.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+    
+    /** The minimum number of image rows processed at a time (rounded up to a multiple of the image block height). */
+    static const unsigned int RSGIS_BITMASK_STRIP_ROWS( 256 );
+    
+    /** How the per image masks are combined into the output mask. */
+    enum RSGISBitMaskCombine
+    {
+        rsgis_bitmask_and = 0,
+        rsgis_bitmask_or = 1
+    };
+    
+    /**
+     * Generates valid data masks for stacks of images. Each strip of every input band
+     * is read once, in its own pixel type where the no data value can be represented,
+     * and the validity of the pixels is packed into 64 bit words. The bands of an image
+     * are combined with AND and the images with AND or OR, so a whole stack is held as
+     * one bit per pixel rather than a float per pixel per band. The words are only
+     * expanded to bytes when the output strip is written. The packing, combining and
+     * expanding of each strip are split across numThreads threads (0 uses all the
+     * available cores).
+     */
+    class DllExport RSGISImageBitMask
+    {
+    public:
+        RSGISImageBitMask(unsigned int numThreads=1);
+        /** Output 1 where none of the bands of an image are noDataVal, combining the images with imgCombine; otherwise 0. */
+        void genValidMask(GDALDataset **datasets, unsigned int numImages, std::string outputImage, std::string imageFormat, float noDataVal, RSGISBitMaskCombine imgCombine=rsgis_bitmask_and);
+        /** Output 1 where all the bands of an image are finite, combining the images with imgCombine; otherwise 0. */
+        void genFiniteMask(GDALDataset **datasets, unsigned int numImages, std::string outputImage, std::string imageFormat, RSGISBitMaskCombine imgCombine=rsgis_bitmask_and);
+        /** Output the value of the last band (of all the images) which is not noDataVal, or noDataVal if all the bands are no data. */
+        void combineImagesIgnoreNoData(GDALDataset **datasets, unsigned int numImages, std::string outputImage, std::string imageFormat, GDALDataType outDataType, float noDataVal);
+        ~RSGISImageBitMask();
+        
+        /** Set bit (p % 64) of words[p / 64] where data[p] is valid (not noDataVal, or finite if testFinite), for p in [wStart*64, min(wEnd*64, nPxls)). */
+        template <typename T> static void packValidBits(const T *data, size_t nPxls, size_t wStart, size_t wEnd, bool testFinite, T noDataVal, uint64_t *words)
+        {
+            for(size_t w = wStart; w < wEnd; ++w)
+            {
+                const T *wData = data + (w * 64);
+                size_t nBits = std::min<size_t>(64, nPxls - (w * 64));
+                uint64_t bits = 0;
+                if(testFinite)
+                {
+                    // x - x is NaN for NaN and infinite values and 0 otherwise.
+                    for(size_t j = 0; j < nBits; ++j)
+                    {
+                        bits |= ((uint64_t)((wData[j] - wData[j]) == 0)) << j;
+                    }
+                }
+                else
+                {
+                    for(size_t j = 0; j < nBits; ++j)
+                    {
+                        bits |= ((uint64_t)(wData[j] != noDataVal)) << j;
+                    }
+                }
+                words[w] = bits;
+            }
+        };
+        /** Expand the bits of words to one byte (0 or 1) per pixel for the pixels [wStart*64, min(wEnd*64, nPxls)). */
+        static void expandBits(const uint64_t *words, size_t nPxls, size_t wStart, size_t wEnd, uint8_t *out);
+    protected:
+        void genMask(GDALDataset **datasets, unsigned int numImages, std::string outputImage, std::string imageFormat, bool testFinite, float noDataVal, RSGISBitMaskCombine imgCombine);
+        GDALDataset* createOutputImage(GDALDataset **datasets, unsigned int numImages, std::string outputImage, std::string imageFormat, GDALDataType outDataType, std::vector<int> *dsOffsetVals, int *width, int *height, int *stripRows);
+        void readPackBand(GDALRasterBand *band, int xOff, int yOff, int width, int nRows, bool testFinite, float noDataVal, std::vector<double> *bandBuffer, uint64_t *words, rsgis::RSGISThreadPool *threadPool);
+        unsigned int numThreads;
+    };
+    
+}}
+
+#endif
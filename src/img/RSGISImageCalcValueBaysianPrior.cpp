@@ -24,7 +24,7 @@
 
 namespace rsgis{namespace img{
 	
-	RSGISImageCalcValueBaysianPrior::RSGISImageCalcValueBaysianPrior(int numberOutBands, rsgis::math::RSGISMathFunction *function, rsgis::math::RSGISProbDistro *probDistro, double variance, double interval, double minVal, double maxVal, double lowerLimit, double upperLimit, rsgis::math::deltatypedef deltatype) : RSGISCalcImageValue(numberOutBands)
+	RSGISImageCalcValueBaysianPrior::RSGISImageCalcValueBaysianPrior(int numberOutBands, rsgis::math::RSGISMathFunction *function, rsgis::math::RSGISProbDistro *probDistro, double variance, double interval, double minVal, double maxVal, double lowerLimit, double upperLimit, rsgis::math::deltatypedef deltatype, double quantStep) : RSGISCalcImageValue(numberOutBands)
 	{
 		this->function = function;
 		this->probDistro = probDistro;
@@ -35,27 +35,40 @@ namespace rsgis{namespace img{
 		this->upperLimit = upperLimit;
 		this->lowerLimit = lowerLimit;
 		this->deltatype = deltatype;
-		baysianStats = new rsgis::math::RSGISBaysianStatsPrior(function, probDistro, variance, interval, minVal, maxVal, upperLimit, lowerLimit, deltatype);
-		std::cout << "Delta type " << deltatype << std::endl;
+		this->quantStep = quantStep;
+		likelihoodTable = new rsgis::math::RSGISBaysianLikelihoodTable(function, probDistro, variance, interval, minVal, maxVal, lowerLimit, upperLimit, deltatype, quantStep);
 	}
 	
 	void RSGISImageCalcValueBaysianPrior::calcImageValue(float *bandValues, int numBands, double *output) 
 	{
-		
-		outputVals = baysianStats->calcImageValuePrior(bandValues[0]);
-		
-		output[1] = outputVals[0]; // Maximum Likelyhood Value
-		output[0] = outputVals[1]; // Lower value
-		output[2] = outputVals[2]; // Upper value
+		// Maximum Likelyhood Value, Lower value and Upper value
+		likelihoodTable->calcValue(bandValues[0], &output[1], &output[0], &output[2]);
 		
 		// Calculate delta- and delta +
 		output[3] = sqrt((output[1] - output[0])*(output[1] - output[0]));
-		output[4] = sqrt((output[2] - output[1])*(output[2] - output[1]));	
-		delete[] outputVals;
+		output[4] = sqrt((output[2] - output[1])*(output[2] - output[1]));
+	}
+	
+	bool RSGISImageCalcValueBaysianPrior::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+	{
+		likelihoodTable->calcValues(bands[0], nPxls, output[1], output[0], output[2]);
+		
+		// Calculate delta- and delta +
+		for(size_t p = 0; p < nPxls; ++p)
+		{
+			output[3][p] = sqrt((output[1][p] - output[0][p])*(output[1][p] - output[0][p]));
+			output[4][p] = sqrt((output[2][p] - output[1][p])*(output[2][p] - output[1][p]));
+		}
+		return true;
+	}
+	
+	RSGISCalcImageValue* RSGISImageCalcValueBaysianPrior::clone()
+	{
+		return new RSGISImageCalcValueBaysianPrior(this->numOutBands, this->function, this->probDistro, this->variance, this->interval, this->minVal, this->maxVal, this->lowerLimit, this->upperLimit, this->deltatype, this->quantStep);
 	}
 	
 	RSGISImageCalcValueBaysianPrior::~RSGISImageCalcValueBaysianPrior()
 	{
-		delete baysianStats;
+		delete likelihoodTable;
 	}
 }}
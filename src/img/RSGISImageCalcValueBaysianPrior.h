@@ -29,6 +29,7 @@
 #include "img/RSGISImageBandException.h"
 #include "img/RSGISImageCalcException.h"
 #include "math/RSGISBaysianStatsPrior.h"
+#include "math/RSGISBaysianLikelihoodTable.h"
 #include "math/RSGISBaysianStatsException.h"
 #include "math/RSGISBaysianDeltaType.h"
 #include "math/RSGISProbDistro.h"
@@ -53,8 +54,15 @@ namespace rsgis{namespace img{
 	class DllExport RSGISImageCalcValueBaysianPrior	: public RSGISCalcImageValue
 		{
 		public:
-			RSGISImageCalcValueBaysianPrior(int numberOutBands, rsgis::math::RSGISMathFunction *function, rsgis::math::RSGISProbDistro *probDistro, double variance, double interval, double minVal, double maxVal, double lowerLimit, double upperLimit, rsgis::math::deltatypedef deltatype);
+			/**
+			 * The likelihoods are evaluated with an RSGISBaysianLikelihoodTable, which
+			 * memoises the results on the input value; quantStep > 0 quantises the input
+			 * values to multiples of quantStep (0 keeps the exact values).
+			 */
+			RSGISImageCalcValueBaysianPrior(int numberOutBands, rsgis::math::RSGISMathFunction *function, rsgis::math::RSGISProbDistro *probDistro, double variance, double interval, double minVal, double maxVal, double lowerLimit, double upperLimit, rsgis::math::deltatypedef deltatype, double quantStep=0);
 			void calcImageValue(float *bandValues, int numBands, double *output);
+			bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+			RSGISCalcImageValue* clone();
 			~RSGISImageCalcValueBaysianPrior();
 		protected:
 			rsgis::math::RSGISMathFunction *function;
@@ -65,9 +73,9 @@ namespace rsgis{namespace img{
 			double maxVal;
 			double upperLimit;
 			double lowerLimit;
-			double* outputVals;
 			rsgis::math::deltatypedef deltatype;
-			rsgis::math::RSGISBaysianStatsPrior *baysianStats;
+			double quantStep;
+			rsgis::math::RSGISBaysianLikelihoodTable *likelihoodTable;
 		};	
 }}
 #endif
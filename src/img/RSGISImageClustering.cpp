@@ -31,8 +31,29 @@ namespace rsgis{namespace img{
         
     }
         
-    void RSGISImageClustering::findKMeansCentres(GDALDataset *dataset, std::string outputMatrix, unsigned int numClusters, unsigned int maxNumIterations, unsigned int subSample, bool ignoreZeros, float degreeOfChange, rsgis::math::InitClustererMethods initMethod)
+    void RSGISImageClustering::findKMeansCentres(GDALDataset *dataset, std::string outputMatrix, unsigned int numClusters, unsigned int maxNumIterations, unsigned int subSample, bool ignoreZeros, float degreeOfChange, rsgis::math::InitClustererMethods initMethod, unsigned int numThreads)
     {
+        try 
+        {
+            rsgis::math::Matrix *clusterMatrix = this->findKMeansCentres(dataset, numClusters, maxNumIterations, subSample, ignoreZeros, degreeOfChange, initMethod, numThreads);
+            std::cout << "Exporting cluster centres to output file\n";
+            rsgis::math::RSGISMatrices matrixUtils;
+            matrixUtils.saveMatrix2GridTxt(clusterMatrix, outputMatrix);
+            matrixUtils.freeMatrix(clusterMatrix);
+        }
+        catch (rsgis::RSGISImageException &e) 
+        {
+            throw e;
+        }
+        catch(rsgis::math::RSGISClustererException &e)
+        {
+            throw e;
+        }
+    }
+    
+    rsgis::math::Matrix* RSGISImageClustering::findKMeansCentres(GDALDataset *dataset, unsigned int numClusters, unsigned int maxNumIterations, unsigned int subSample, bool ignoreZeros, float degreeOfChange, rsgis::math::InitClustererMethods initMethod, unsigned int numThreads)
+    {
+        rsgis::math::Matrix *clusterMatrix = NULL;
         try 
         {
             unsigned int numImgBands = dataset->GetRasterCount();
@@ -41,11 +62,20 @@ namespace rsgis{namespace img{
             
             std::cout << "Performing clustering\n";
             rsgis::math::RSGISKMeansClusterer clusterer(initMethod);
-            std::vector< rsgis::math::RSGISClusterCentre > *clusterCentres = clusterer.calcClusterCentres(pxlValues, numImgBands, numClusters, maxNumIterations, degreeOfChange);
+            clusterer.setNumThreads(numThreads);
+            // Copy the samples into one contiguous matrix and free the individual samples.
+            std::vector<float> pxlData;
+            clusterer.packSamples(pxlValues, numImgBands, &pxlData);
+            size_t numPxls = pxlValues->size();
+            delete pxlValues;
+            if(numPxls == 0)
+            {
+                throw rsgis::RSGISImageException("No pixel values were sampled from the image.");
+            }
+            std::vector< rsgis::math::RSGISClusterCentre > *clusterCentres = clusterer.calcClusterCentres(&pxlData[0], numPxls, numImgBands, numClusters, maxNumIterations, degreeOfChange);
             
-            std::cout << "Exporting cluster centres to output file\n";
             rsgis::math::RSGISMatrices matrixUtils;
-            rsgis::math::Matrix *clusterMatrix = matrixUtils.createMatrix(numImgBands, clusterCentres->size());
+            clusterMatrix = matrixUtils.createMatrix(numImgBands, clusterCentres->size());
             unsigned int matrixIdx = 0;
             for(unsigned int i = 0; i < clusterCentres->size(); ++i)
             {
@@ -55,9 +85,6 @@ namespace rsgis{namespace img{
                     clusterMatrix->matrix[matrixIdx] = clusterCentres->at(i).centre[j];
                 }
             }
-            matrixUtils.saveMatrix2GridTxt(clusterMatrix, outputMatrix);
-            matrixUtils.freeMatrix(clusterMatrix);
-            delete pxlValues;
             delete clusterCentres;
         }
         catch (rsgis::RSGISImageException &e) 
@@ -68,10 +95,11 @@ namespace rsgis{namespace img{
         {
             throw e;
         }
+        return clusterMatrix;
     }
         
     
-    void RSGISImageClustering::findISODataCentres(GDALDataset *dataset, std::string outputMatrix, unsigned int numClusters, unsigned int maxNumIterations, unsigned int subSample, bool ignoreZeros, float degreeOfChange, rsgis::math::InitClustererMethods initMethod, float minDistBetweenClusters, unsigned int minNumFeatures, float maxStdDev, unsigned int minNumClusters, unsigned int startIteration, unsigned int endIteration)
+    void RSGISImageClustering::findISODataCentres(GDALDataset *dataset, std::string outputMatrix, unsigned int numClusters, unsigned int maxNumIterations, unsigned int subSample, bool ignoreZeros, float degreeOfChange, rsgis::math::InitClustererMethods initMethod, float minDistBetweenClusters, unsigned int minNumFeatures, float maxStdDev, unsigned int minNumClusters, unsigned int startIteration, unsigned int endIteration, unsigned int numThreads)
     {
         try 
         {
@@ -81,7 +109,17 @@ namespace rsgis{namespace img{
             
             std::cout << "Performing clustering\n";
             rsgis::math::RSGISISODataClusterer clusterer(initMethod, minDistBetweenClusters, minNumFeatures, maxStdDev, minNumClusters, startIteration, endIteration);
-            std::vector< rsgis::math::RSGISClusterCentre > *clusterCentres = clusterer.calcClusterCentres(pxlValues, dataset->GetRasterCount(), numClusters, maxNumIterations, degreeOfChange);
+            clusterer.setNumThreads(numThreads);
+            // Copy the samples into one contiguous matrix and free the individual samples.
+            std::vector<float> pxlData;
+            clusterer.packSamples(pxlValues, numImgBands, &pxlData);
+            size_t numPxls = pxlValues->size();
+            delete pxlValues;
+            if(numPxls == 0)
+            {
+                throw rsgis::RSGISImageException("No pixel values were sampled from the image.");
+            }
+            std::vector< rsgis::math::RSGISClusterCentre > *clusterCentres = clusterer.calcClusterCentres(&pxlData[0], numPxls, numImgBands, numClusters, maxNumIterations, degreeOfChange);
             
             std::cout << "Exporting cluster centres to output file\n";
             rsgis::math::RSGISMatrices matrixUtils;
@@ -97,7 +135,6 @@ namespace rsgis{namespace img{
             }
             matrixUtils.saveMatrix2GridTxt(clusterMatrix, outputMatrix);
             matrixUtils.freeMatrix(clusterMatrix);
-            delete pxlValues;
             delete clusterCentres;
         }
         catch (rsgis::RSGISImageException &e) 
@@ -0,0 +1,366 @@
+/*
+ *  RSGISImageComparison.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISImageComparison.h"
+
+namespace rsgis{namespace img{
+    
+    RSGISImageComparison::RSGISImageComparison(std::vector<std::pair<unsigned int, unsigned int> > bandPairs, bool outputDiff):RSGISCalcImageValue(outputDiff?bandPairs.size():0)
+    {
+        this->bandPairs = bandPairs;
+        this->outputDiff = outputDiff;
+        this->calcHist = false;
+        this->histBandA = 0;
+        this->histBandB = 0;
+        this->histNumBins = 0;
+        this->histAScale = 1.0;
+        this->histBScale = 1.0;
+        this->histAOff = 0.0;
+        this->histBOff = 0.0;
+        this->reset();
+    }
+    
+    void RSGISImageComparison::setCrossCorrelation(std::vector<unsigned int> bandsA, std::vector<unsigned int> bandsB)
+    {
+        this->crossBandsA = bandsA;
+        this->crossBandsB = bandsB;
+        this->reset();
+    }
+    
+    void RSGISImageComparison::setHistogram(unsigned int bandA, unsigned int bandB, unsigned int numBins, const double *aBins, const double *bBins, double aScale, double bScale, double aOff, double bOff)
+    {
+        if(numBins == 0)
+        {
+            throw RSGISImageCalcException("The 2D histogram must have at least one bin.");
+        }
+        this->calcHist = true;
+        this->histBandA = bandA;
+        this->histBandB = bandB;
+        this->histNumBins = numBins;
+        this->histABins.assign(aBins, aBins + numBins + 1);
+        this->histBBins.assign(bBins, bBins + numBins + 1);
+        this->histAScale = aScale;
+        this->histBScale = bScale;
+        this->histAOff = aOff;
+        this->histBOff = bOff;
+        this->reset();
+    }
+    
+    void RSGISImageComparison::reset()
+    {
+        this->numPxls = 0;
+        RSGISComparisonSums zeroSums;
+        std::memset(&zeroSums, 0, sizeof(RSGISComparisonSums));
+        this->pairSums.assign(this->bandPairs.size(), zeroSums);
+        this->crossSumsA.assign(this->crossBandsA.size(), 0.0);
+        this->crossSqSumsA.assign(this->crossBandsA.size(), 0.0);
+        this->crossSumsB.assign(this->crossBandsB.size(), 0.0);
+        this->crossSqSumsB.assign(this->crossBandsB.size(), 0.0);
+        this->crossProdSums.assign(this->crossBandsA.size() * this->crossBandsB.size(), 0.0);
+        this->histogram.assign(this->calcHist?(this->histNumBins * this->histNumBins):0, 0.0);
+    }
+    
+    void RSGISImageComparison::calcImageValue(float *bandValues, int numBands, double *output)
+    {
+        this->accumulatePxl(bandValues, output);
+    }
+    
+    void RSGISImageComparison::calcImageValue(float *bandValues, int numBands)
+    {
+        this->accumulatePxl(bandValues, NULL);
+    }
+    
+    void RSGISImageComparison::accumulatePxl(const float *bandValues, double *output)
+    {
+        ++this->numPxls;
+        for(size_t i = 0; i < this->bandPairs.size(); ++i)
+        {
+            double a = bandValues[this->bandPairs[i].first];
+            double b = bandValues[this->bandPairs[i].second];
+            double diff = a - b;
+            RSGISComparisonSums &sums = this->pairSums[i];
+            sums.sumDiff += diff;
+            sums.sumSqDiff += diff * diff;
+            sums.sumAbsDiff += std::fabs(diff);
+            sums.sumA += a;
+            sums.sumB += b;
+            sums.sumAA += a * a;
+            sums.sumBB += b * b;
+            sums.sumAB += a * b;
+            if(this->outputDiff && (output != NULL))
+            {
+                output[i] = diff;
+            }
+        }
+        
+        size_t nCrossB = this->crossBandsB.size();
+        for(size_t j = 0; j < nCrossB; ++j)
+        {
+            double b = bandValues[this->crossBandsB[j]];
+            this->crossSumsB[j] += b;
+            this->crossSqSumsB[j] += b * b;
+        }
+        for(size_t i = 0; i < this->crossBandsA.size(); ++i)
+        {
+            double a = bandValues[this->crossBandsA[i]];
+            this->crossSumsA[i] += a;
+            this->crossSqSumsA[i] += a * a;
+            for(size_t j = 0; j < nCrossB; ++j)
+            {
+                this->crossProdSums[(i * nCrossB) + j] += a * bandValues[this->crossBandsB[j]];
+            }
+        }
+        
+        if(this->calcHist)
+        {
+            long aBin = this->findBin(this->histABins, this->histAOff + (bandValues[this->histBandA] * this->histAScale));
+            if(aBin >= 0)
+            {
+                long bBin = this->findBin(this->histBBins, this->histBOff + (bandValues[this->histBandB] * this->histBScale));
+                if(bBin >= 0)
+                {
+                    this->histogram[(aBin * this->histNumBins) + bBin] += 1;
+                }
+            }
+        }
+    }
+    
+    bool RSGISImageComparison::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        this->numPxls += nPxls;
+        for(size_t i = 0; i < this->bandPairs.size(); ++i)
+        {
+            const float *aVals = bands[this->bandPairs[i].first];
+            const float *bVals = bands[this->bandPairs[i].second];
+            double *diffVals = this->outputDiff?output[i]:NULL;
+            // The sums of a - b, (a - b)^2, |a - b|, a, b, a^2, b^2 and a b.
+            double blockSums[8];
+            rsgis::RSGISSIMDKernels::pairSums(aVals, bVals, nPxls, blockSums);
+            if(diffVals != NULL)
+            {
+                for(size_t p = 0; p < nPxls; ++p)
+                {
+                    diffVals[p] = static_cast<double>(aVals[p]) - static_cast<double>(bVals[p]);
+                }
+            }
+            RSGISComparisonSums &sums = this->pairSums[i];
+            sums.sumDiff += blockSums[0];
+            sums.sumSqDiff += blockSums[1];
+            sums.sumAbsDiff += blockSums[2];
+            sums.sumA += blockSums[3];
+            sums.sumB += blockSums[4];
+            sums.sumAA += blockSums[5];
+            sums.sumBB += blockSums[6];
+            sums.sumAB += blockSums[7];
+        }
+        
+        size_t nCrossB = this->crossBandsB.size();
+        for(size_t j = 0; j < nCrossB; ++j)
+        {
+            double sumB = 0;
+            double sumBB = 0;
+            rsgis::RSGISSIMDKernels::sumAndSquares(bands[this->crossBandsB[j]], nPxls, &sumB, &sumBB);
+            this->crossSumsB[j] += sumB;
+            this->crossSqSumsB[j] += sumBB;
+        }
+        for(size_t i = 0; i < this->crossBandsA.size(); ++i)
+        {
+            const float *aVals = bands[this->crossBandsA[i]];
+            double sumA = 0;
+            double sumAA = 0;
+            rsgis::RSGISSIMDKernels::sumAndSquares(aVals, nPxls, &sumA, &sumAA);
+            this->crossSumsA[i] += sumA;
+            this->crossSqSumsA[i] += sumAA;
+            for(size_t j = 0; j < nCrossB; ++j)
+            {
+                this->crossProdSums[(i * nCrossB) + j] += rsgis::RSGISSIMDKernels::dotProduct(aVals, bands[this->crossBandsB[j]], nPxls);
+            }
+        }
+        
+        if(this->calcHist)
+        {
+            const float *aVals = bands[this->histBandA];
+            const float *bVals = bands[this->histBandB];
+            for(size_t p = 0; p < nPxls; ++p)
+            {
+                long aBin = this->findBin(this->histABins, this->histAOff + (aVals[p] * this->histAScale));
+                if(aBin >= 0)
+                {
+                    long bBin = this->findBin(this->histBBins, this->histBOff + (bVals[p] * this->histBScale));
+                    if(bBin >= 0)
+                    {
+                        this->histogram[(aBin * this->histNumBins) + bBin] += 1;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+    
+    long RSGISImageComparison::findBin(const std::vector<double> &bins, float val) const
+    {
+        // The first bin i with bins[i] <= val < bins[i+1]; the edges are normally
+        // increasing so it is found with a binary search.
+        std::vector<double>::const_iterator iterBin = std::upper_bound(bins.begin(), bins.end(), static_cast<double>(val));
+        long bin = static_cast<long>(iterBin - bins.begin()) - 1;
+        if((bin >= 0) && (bin < static_cast<long>(this->histNumBins)) && (val >= bins[bin]) && (val < bins[bin+1]))
+        {
+            return bin;
+        }
+        return -1;
+    }
+    
+    RSGISCalcImageValue* RSGISImageComparison::clone()
+    {
+        RSGISImageComparison *comp = new RSGISImageComparison(this->bandPairs, this->outputDiff);
+        comp->crossBandsA = this->crossBandsA;
+        comp->crossBandsB = this->crossBandsB;
+        if(this->calcHist)
+        {
+            comp->setHistogram(this->histBandA, this->histBandB, this->histNumBins, this->histABins.data(), this->histBBins.data(), this->histAScale, this->histBScale, this->histAOff, this->histBOff);
+        }
+        comp->reset();
+        return comp;
+    }
+    
+    void RSGISImageComparison::reduce(RSGISCalcImageValue *other)
+    {
+        RSGISImageComparison *comp = dynamic_cast<RSGISImageComparison*>(other);
+        if(comp == NULL)
+        {
+            throw RSGISImageCalcException("RSGISImageComparison can only be reduced with another RSGISImageComparison.");
+        }
+        this->numPxls += comp->numPxls;
+        for(size_t i = 0; i < this->pairSums.size(); ++i)
+        {
+            RSGISComparisonSums &sums = this->pairSums[i];
+            const RSGISComparisonSums &oSums = comp->pairSums[i];
+            sums.sumDiff += oSums.sumDiff;
+            sums.sumSqDiff += oSums.sumSqDiff;
+            sums.sumAbsDiff += oSums.sumAbsDiff;
+            sums.sumA += oSums.sumA;
+            sums.sumB += oSums.sumB;
+            sums.sumAA += oSums.sumAA;
+            sums.sumBB += oSums.sumBB;
+            sums.sumAB += oSums.sumAB;
+        }
+        for(size_t i = 0; i < this->crossSumsA.size(); ++i)
+        {
+            this->crossSumsA[i] += comp->crossSumsA[i];
+            this->crossSqSumsA[i] += comp->crossSqSumsA[i];
+        }
+        for(size_t j = 0; j < this->crossSumsB.size(); ++j)
+        {
+            this->crossSumsB[j] += comp->crossSumsB[j];
+            this->crossSqSumsB[j] += comp->crossSqSumsB[j];
+        }
+        for(size_t i = 0; i < this->crossProdSums.size(); ++i)
+        {
+            this->crossProdSums[i] += comp->crossProdSums[i];
+        }
+        for(size_t i = 0; i < this->histogram.size(); ++i)
+        {
+            this->histogram[i] += comp->histogram[i];
+        }
+    }
+    
+    double RSGISImageComparison::getRMSE(unsigned int pair) const
+    {
+        return sqrt(this->pairSums.at(pair).sumSqDiff / this->numPxls);
+    }
+    
+    double RSGISImageComparison::getBias(unsigned int pair) const
+    {
+        return this->pairSums.at(pair).sumDiff / this->numPxls;
+    }
+    
+    double RSGISImageComparison::getMeanAbsDiff(unsigned int pair) const
+    {
+        return this->pairSums.at(pair).sumAbsDiff / this->numPxls;
+    }
+    
+    double RSGISImageComparison::getCorrelation(unsigned int pair) const
+    {
+        const RSGISComparisonSums &sums = this->pairSums.at(pair);
+        return calcCorrelation(this->numPxls, sums.sumA, sums.sumB, sums.sumAA, sums.sumBB, sums.sumAB);
+    }
+    
+    double RSGISImageComparison::getCrossCorrelation(unsigned int idxA, unsigned int idxB) const
+    {
+        if((idxA >= this->crossBandsA.size()) || (idxB >= this->crossBandsB.size()))
+        {
+            throw RSGISImageCalcException("The band index is not within the list of bands for the correlation.");
+        }
+        return calcCorrelation(this->numPxls, this->crossSumsA[idxA], this->crossSumsB[idxB], this->crossSqSumsA[idxA], this->crossSqSumsB[idxB], this->crossProdSums[(idxA * this->crossBandsB.size()) + idxB]);
+    }
+    
+    double RSGISImageComparison::calcCorrelation(double n, double sumA, double sumB, double sumAA, double sumBB, double sumAB)
+    {
+        // As RSGISCalcCC.
+        double topline = (n * sumAB) - (sumA * sumB);
+        double bottomline = sqrt(((n * sumAA) - (sumA * sumA)) * ((n * sumBB) - (sumB * sumB)));
+        return topline/bottomline;
+    }
+    
+    double RSGISImageComparison::calcHistogramRSq(const double *histogram, unsigned int numBins, const double *aBins, const double *bBins)
+    {
+        double img1Mean = 0.0;
+        double img1N = 0.0;
+        for(unsigned int i = 0; i < numBins; ++i)
+        {
+            double binValImg1 = aBins[i] + ((aBins[i+1]-aBins[i])/2);
+            double lclN = 0.0;
+            for(unsigned int j = 0; j < numBins; ++j)
+            {
+                lclN += histogram[(i * numBins) + j];
+            }
+            img1Mean += (lclN * binValImg1);
+            img1N += lclN;
+        }
+        img1Mean = img1Mean / img1N;
+        
+        double img1Diff2Mean = 0.0;
+        double img1DiffImg2 = 0.0;
+        for(unsigned int i = 0; i < numBins; ++i)
+        {
+            double binValImg1 = aBins[i] + ((aBins[i+1]-aBins[i])/2);
+            double lclN = 0.0;
+            for(unsigned int j = 0; j < numBins; ++j)
+            {
+                double count = histogram[(i * numBins) + j];
+                double binValImg2 = bBins[j] + ((bBins[j+1]-bBins[j])/2);
+                lclN += count;
+                img1DiffImg2 += count * ((binValImg1 - binValImg2) * (binValImg1 - binValImg2));
+            }
+            img1Diff2Mean += lclN * ((binValImg1 - img1Mean) * (binValImg1 - img1Mean));
+        }
+        
+        return 1 - (img1DiffImg2 / img1Diff2Mean);
+    }
+    
+    RSGISImageComparison::~RSGISImageComparison()
+    {
+        
+    }
+    
+}}
@@ -0,0 +1,137 @@
+/*
+ *  RSGISImageComparison.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISImageComparison_H
+#define RSGISImageComparison_H
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+
+#include "img/RSGISCalcImageValue.h"
+#include "img/RSGISImageCalcException.h"
+
+#include "common/RSGISSIMDKernels.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+    
+    /**
+     * Compares pairs of input bands (indexes into the input bands given to
+     * RSGISCalcImage, e.g., band i of image A and band numBandsA+i of image B)
+     * within a single pass over the images, accumulating everything needed for
+     * the RMSE, the bias (mean of A - B), the mean absolute difference and the
+     * correlation coefficient of each pair. Optionally:
+     *  - the difference (A - B) of each pair is output as an image band,
+     *  - the correlation coefficients between every band within a list of bands
+     *    and every band within a second list are calculated (setCrossCorrelation),
+     *  - a 2D histogram of a pair of bands is accumulated (setHistogram), with the
+     *    same binning as RSGISGen2DHistogramCalcVal.
+     *
+     * clone() and reduce() are implemented so the thread-local sums of the
+     * parallel RSGISCalcImage code paths are merged at the end, and calcImageBlock
+     * accumulates over strips of band-major pixels.
+     */
+    class DllExport RSGISImageComparison : public RSGISCalcImageValue
+    {
+    public:
+        RSGISImageComparison(std::vector<std::pair<unsigned int, unsigned int> > bandPairs, bool outputDiff);
+        /** Calculate the correlation coefficient between every band of bandsA and every band of bandsB. */
+        void setCrossCorrelation(std::vector<unsigned int> bandsA, std::vector<unsigned int> bandsB);
+        /** Accumulate a 2D histogram of ((bandA*aScale)+aOff, (bandB*bScale)+bOff) with the numBins+1 bin edges of each axis. */
+        void setHistogram(unsigned int bandA, unsigned int bandB, unsigned int numBins, const double *aBins, const double *bBins, double aScale, double bScale, double aOff, double bOff);
+        void calcImageValue(float *bandValues, int numBands, double *output);
+        void calcImageValue(float *bandValues, int numBands);
+        bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        RSGISCalcImageValue* clone();
+        void reduce(RSGISCalcImageValue *other);
+        /** Clear the accumulated values. */
+        void reset();
+        
+        unsigned long getNumPxls() const {return this->numPxls;};
+        double getRMSE(unsigned int pair) const;
+        double getBias(unsigned int pair) const;
+        double getMeanAbsDiff(unsigned int pair) const;
+        double getCorrelation(unsigned int pair) const;
+        double getCrossCorrelation(unsigned int idxA, unsigned int idxB) const;
+        /** The histogram counts, indexed [aBin * numBins + bBin]. */
+        const std::vector<double>& getHistogram() const {return this->histogram;};
+        /** Calculate the R^2 from the bin centres of the histogram, as RSGISGenHistogram::gen2DHistogram. */
+        static double calcHistogramRSq(const double *histogram, unsigned int numBins, const double *aBins, const double *bBins);
+        ~RSGISImageComparison();
+    protected:
+        struct RSGISComparisonSums
+        {
+            double sumDiff;
+            double sumSqDiff;
+            double sumAbsDiff;
+            double sumA;
+            double sumB;
+            double sumAA;
+            double sumBB;
+            double sumAB;
+        };
+        static double calcCorrelation(double n, double sumA, double sumB, double sumAA, double sumBB, double sumAB);
+        void accumulatePxl(const float *bandValues, double *output);
+        long findBin(const std::vector<double> &bins, float val) const;
+        std::vector<std::pair<unsigned int, unsigned int> > bandPairs;
+        bool outputDiff;
+        unsigned long numPxls;
+        std::vector<RSGISComparisonSums> pairSums;
+        std::vector<unsigned int> crossBandsA;
+        std::vector<unsigned int> crossBandsB;
+        std::vector<double> crossSumsA;
+        std::vector<double> crossSqSumsA;
+        std::vector<double> crossSumsB;
+        std::vector<double> crossSqSumsB;
+        std::vector<double> crossProdSums;
+        bool calcHist;
+        unsigned int histBandA;
+        unsigned int histBandB;
+        unsigned int histNumBins;
+        std::vector<double> histABins;
+        std::vector<double> histBBins;
+        double histAScale;
+        double histBScale;
+        double histAOff;
+        double histBOff;
+        std::vector<double> histogram;
+    };
+    
+}}
+
+#endif
@@ -398,5 +398,616 @@ void RSGISImageComposite::calcImageValue(float *bandValues, int numBands, double
     
     
     
+    RSGISMaxNDVISceneSelector::RSGISMaxNDVISceneSelector(std::vector<GDALDataset*> scenes, unsigned int redBand, unsigned int nirBand) : RSGISCompositeSceneSelector()
+    {
+        this->scenes = scenes;
+        this->redBand = redBand;
+        this->nirBand = nirBand;
+        for(std::vector<GDALDataset*>::iterator iterScenes = scenes.begin(); iterScenes != scenes.end(); ++iterScenes)
+        {
+            if((redBand >= ((unsigned int)(*iterScenes)->GetRasterCount())) || (nirBand >= ((unsigned int)(*iterScenes)->GetRasterCount())))
+            {
+                throw RSGISImageCalcException("The red and NIR bands need to be within the input images.");
+            }
+        }
+    }
+
+    void RSGISMaxNDVISceneSelector::selectScenes(int **dsOffsets, int yOff, int xSize, int ySize, int *pxlScenes)
+    {
+        size_t numPxls = ((size_t)xSize) * ySize;
+        this->redVals.resize(numPxls);
+        this->nirVals.resize(numPxls);
+        this->maxNDVIVals.resize(numPxls);
+
+        // Pixels without a valid scene use the first scene.
+        for(size_t i = 0; i < numPxls; ++i)
+        {
+            pxlScenes[i] = -1;
+        }
+
+        float *red = this->redVals.data();
+        float *nir = this->nirVals.data();
+        float *maxNDVI = this->maxNDVIVals.data();
+        for(size_t s = 0; s < this->scenes.size(); ++s)
+        {
+            if(this->scenes[s]->GetRasterBand(this->redBand+1)->RasterIO(GF_Read, dsOffsets[s][0], dsOffsets[s][1]+yOff, xSize, ySize, red, xSize, ySize, GDT_Float32, 0, 0) != CE_None)
+            {
+                throw RSGISImageCalcException("Failed to read the red band.");
+            }
+            if(this->scenes[s]->GetRasterBand(this->nirBand+1)->RasterIO(GF_Read, dsOffsets[s][0], dsOffsets[s][1]+yOff, xSize, ySize, nir, xSize, ySize, GDT_Float32, 0, 0) != CE_None)
+            {
+                throw RSGISImageCalcException("Failed to read the NIR band.");
+            }
+            for(size_t i = 0; i < numPxls; ++i)
+            {
+                if((nir[i] != 0) && (red[i] != 0))
+                {
+                    float ndviVal = (nir[i]-red[i])/(nir[i]+red[i]);
+                    if((pxlScenes[i] < 0) || (ndviVal > maxNDVI[i]))
+                    {
+                        maxNDVI[i] = ndviVal;
+                        pxlScenes[i] = s;
+                    }
+                }
+            }
+        }
+
+        for(size_t i = 0; i < numPxls; ++i)
+        {
+            if(pxlScenes[i] < 0)
+            {
+                pxlScenes[i] = 0;
+            }
+        }
+    }
+
+
+    RSGISRefImgSceneSelector::RSGISRefImgSceneSelector(GDALDataset *refImage, unsigned int numScenes) : RSGISCompositeSceneSelector()
+    {
+        this->refImage = refImage;
+        this->numScenes = numScenes;
+    }
+
+    void RSGISRefImgSceneSelector::selectScenes(int **dsOffsets, int yOff, int xSize, int ySize, int *pxlScenes)
+    {
+        size_t numPxls = ((size_t)xSize) * ySize;
+        this->refVals.resize(numPxls);
+        if(this->refImage->GetRasterBand(1)->RasterIO(GF_Read, dsOffsets[0][0], dsOffsets[0][1]+yOff, xSize, ySize, this->refVals.data(), xSize, ySize, GDT_Int32, 0, 0) != CE_None)
+        {
+            throw RSGISImageCalcException("Failed to read the reference image.");
+        }
+
+        for(size_t i = 0; i < numPxls; ++i)
+        {
+            int refVal = this->refVals[i];
+            if(refVal < 0)
+            {
+                std::cerr << "Reference pixel = " << refVal << std::endl;
+                throw RSGISImageCalcException("Reference pixel values cannot be negative");
+            }
+            else if(((unsigned int)refVal) > this->numScenes)
+            {
+                std::cerr << "Reference pixel = " << refVal << std::endl;
+                throw RSGISImageCalcException("Reference image is not within the stack.");
+            }
+            pxlScenes[i] = refVal - 1;
+        }
+    }
+
+
+    RSGISTimeseriesFillSceneSelector::RSGISTimeseriesFillSceneSelector(GDALDataset *fillRefImage, unsigned int *imgIdxLUT, unsigned int nLUT) : RSGISCompositeSceneSelector()
+    {
+        this->fillRefImage = fillRefImage;
+        this->imgIdxLUT = imgIdxLUT;
+        this->nLUT = nLUT;
+    }
+
+    void RSGISTimeseriesFillSceneSelector::selectScenes(int **dsOffsets, int yOff, int xSize, int ySize, int *pxlScenes)
+    {
+        size_t numPxls = ((size_t)xSize) * ySize;
+        this->refVals.resize(numPxls);
+        if(this->fillRefImage->GetRasterBand(1)->RasterIO(GF_Read, dsOffsets[0][0], dsOffsets[0][1]+yOff, xSize, ySize, this->refVals.data(), xSize, ySize, GDT_Int32, 0, 0) != CE_None)
+        {
+            throw RSGISImageCalcException("Failed to read the fill reference image.");
+        }
+
+        for(size_t i = 0; i < numPxls; ++i)
+        {
+            int refVal = this->refVals[i];
+            unsigned int imgIdx = 0;
+            if(refVal > 0)
+            {
+                if(((unsigned int)refVal) >= this->nLUT)
+                {
+                    throw RSGISImageCalcException("Fill reference pixel value is not within the LUT.");
+                }
+                imgIdx = this->imgIdxLUT[refVal];
+                if(imgIdx >= this->nLUT)
+                {
+                    throw RSGISImageCalcException("LUT has incorrect valid.");
+                }
+                if(imgIdx > 0)
+                {
+                    imgIdx = imgIdx - 1;
+                }
+            }
+            pxlScenes[i] = imgIdx;
+        }
+    }
+
+
+    int RSGISStripImageComposite::getColumnWindow(size_t numReadBands, int xSize, int ySize)
+    {
+        size_t colVals = std::max(numReadBands, (size_t)1) * std::max(ySize, 1);
+        size_t nCols = maxReadBufferVals / colVals;
+        return std::max(1, (int)std::min(nCols, (size_t)xSize));
+    }
+
+    GDALDataset* RSGISStripImageComposite::createOutputImage(std::vector<GDALDataset*> *datasets, int **dsOffsets, int numBands, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType, int *width, int *height, int *stripRows)
+    {
+        RSGISImageUtils imgUtils;
+        double gdalTranslation[6];
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        imgUtils.getImageOverlap(datasets->data(), datasets->size(), dsOffsets, width, height, gdalTranslation, &xBlockSize, &yBlockSize);
+
+        GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(gdalFormat.c_str());
+        if(gdalDriver == NULL)
+        {
+            throw RSGISImageBandException("Requested GDAL driver does not exists..");
+        }
+        char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(gdalFormat);
+        std::cout << "New image width = " << (*width) << " height = " << (*height) << " bands = " << numBands << std::endl;
+        GDALDataset *outputImageDS = gdalDriver->Create(outputImage.c_str(), *width, *height, numBands, gdalDataType, papszOptions);
+        if(outputImageDS == NULL)
+        {
+            throw RSGISImageBandException("Output image could not be created. Check filepath.");
+        }
+        outputImageDS->SetGeoTransform(gdalTranslation);
+        outputImageDS->SetProjection(datasets->at(0)->GetProjectionRef());
+
+        int outXBlockSize = 0;
+        int outYBlockSize = 0;
+        outputImageDS->GetRasterBand(1)->GetBlockSize(&outXBlockSize, &outYBlockSize);
+        *stripRows = std::max(std::max(yBlockSize, outYBlockSize), 1);
+        return outputImageDS;
+    }
+
+
+    RSGISMedoidSceneSelector::RSGISMedoidSceneSelector(std::vector<GDALDataset*> scenes, std::vector<unsigned int> bands, float noDataVal) : RSGISCompositeSceneSelector()
+    {
+        if(bands.empty())
+        {
+            throw RSGISImageCalcException("At least one band is needed to find the medoid.");
+        }
+        this->scenes = scenes;
+        this->bands = bands;
+        this->noDataVal = noDataVal;
+        for(std::vector<GDALDataset*>::iterator iterScenes = scenes.begin(); iterScenes != scenes.end(); ++iterScenes)
+        {
+            for(std::vector<unsigned int>::iterator iterBands = bands.begin(); iterBands != bands.end(); ++iterBands)
+            {
+                if((*iterBands) >= ((unsigned int)(*iterScenes)->GetRasterCount()))
+                {
+                    throw RSGISImageCalcException("The medoid bands need to be within the input images.");
+                }
+            }
+        }
+    }
+
+    void RSGISMedoidSceneSelector::selectScenes(int **dsOffsets, int yOff, int xSize, int ySize, int *pxlScenes)
+    {
+        size_t numScenes = this->scenes.size();
+        size_t numBands = this->bands.size();
+        int winCols = RSGISStripImageComposite::getColumnWindow(numScenes * numBands, xSize, ySize);
+        size_t winMaxPxls = ((size_t)winCols) * ySize;
+        this->sceneVals.resize(numScenes * numBands * winMaxPxls);
+        this->obsVals.resize(numScenes * numBands);
+        this->obsScenes.resize(numScenes);
+        this->obsDist.resize(numScenes);
+
+        for(int x0 = 0; x0 < xSize; x0 += winCols)
+        {
+            int winWidth = std::min(winCols, xSize - x0);
+            size_t winNumPxls = ((size_t)winWidth) * ySize;
+            for(size_t s = 0; s < numScenes; ++s)
+            {
+                for(size_t b = 0; b < numBands; ++b)
+                {
+                    float *bandVals = &this->sceneVals[((s * numBands) + b) * winNumPxls];
+                    if(this->scenes[s]->GetRasterBand(this->bands[b]+1)->RasterIO(GF_Read, dsOffsets[s][0]+x0, dsOffsets[s][1]+yOff, winWidth, ySize, bandVals, winWidth, ySize, GDT_Float32, 0, 0) != CE_None)
+                    {
+                        throw RSGISImageCalcException("Failed to read the input image.");
+                    }
+                }
+            }
+
+            for(size_t i = 0; i < winNumPxls; ++i)
+            {
+                // Compact the valid observations for the pixel, band by band.
+                size_t numObs = 0;
+                for(size_t s = 0; s < numScenes; ++s)
+                {
+                    bool valid = true;
+                    for(size_t b = 0; b < numBands; ++b)
+                    {
+                        float val = this->sceneVals[(((s * numBands) + b) * winNumPxls) + i];
+                        if((val == this->noDataVal) || std::isnan(val))
+                        {
+                            valid = false;
+                            break;
+                        }
+                    }
+                    if(valid)
+                    {
+                        this->obsScenes[numObs++] = s;
+                    }
+                }
+                for(size_t b = 0; b < numBands; ++b)
+                {
+                    float *obsBandVals = &this->obsVals[b * numObs];
+                    for(size_t k = 0; k < numObs; ++k)
+                    {
+                        obsBandVals[k] = this->sceneVals[(((this->obsScenes[k] * numBands) + b) * winNumPxls) + i];
+                    }
+                }
+
+                int medoid = -1;
+                double minDistSum = 0;
+                for(size_t k = 0; k < numObs; ++k)
+                {
+                    double *dist = this->obsDist.data();
+                    std::fill(dist, dist + numObs, 0.0);
+                    for(size_t b = 0; b < numBands; ++b)
+                    {
+                        const float *obsBandVals = &this->obsVals[b * numObs];
+                        double obsVal = obsBandVals[k];
+                        for(size_t j = 0; j < numObs; ++j)
+                        {
+                            double diff = obsBandVals[j] - obsVal;
+                            dist[j] += diff * diff;
+                        }
+                    }
+                    double distSum = 0;
+                    for(size_t j = 0; j < numObs; ++j)
+                    {
+                        distSum += std::sqrt(dist[j]);
+                    }
+                    if((medoid < 0) || (distSum < minDistSum))
+                    {
+                        minDistSum = distSum;
+                        medoid = this->obsScenes[k];
+                    }
+                }
+                pxlScenes[(((size_t)(i / winWidth)) * xSize) + x0 + (i % winWidth)] = medoid;
+            }
+        }
+    }
+
+
+    RSGISSelectiveImageComposite::RSGISSelectiveImageComposite(RSGISCompositeSceneSelector *selector, float outNoDataVal)
+    {
+        this->selector = selector;
+        this->outNoDataVal = outNoDataVal;
+    }
+
+    void RSGISSelectiveImageComposite::createComposite(std::vector<GDALDataset*> scenes, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType)
+    {
+        if(scenes.empty())
+        {
+            throw RSGISImageCalcException("No scenes have been provided for the composite.");
+        }
+        int numBands = scenes[0]->GetRasterCount();
+        for(std::vector<GDALDataset*>::iterator iterScenes = scenes.begin(); iterScenes != scenes.end(); ++iterScenes)
+        {
+            if((*iterScenes)->GetRasterCount() != numBands)
+            {
+                throw RSGISImageCalcException("Input images have different number of image bands.");
+            }
+        }
+
+        // The composite covers the overlap of the selection datasets and the scenes.
+        std::vector<GDALDataset*> datasets = this->selector->getSelectionDatasets();
+        unsigned int numSelDS = datasets.size();
+        datasets.insert(datasets.end(), scenes.begin(), scenes.end());
+        unsigned int numScenes = scenes.size();
+
+        int **dsOffsets = new int*[datasets.size()];
+        for(size_t i = 0; i < datasets.size(); ++i)
+        {
+            dsOffsets[i] = new int[2];
+        }
+        int width = 0;
+        int height = 0;
+        int yBlockSize = 0;
+        GDALDataset *outputImageDS = NULL;
+
+        try
+        {
+            outputImageDS = this->createOutputImage(&datasets, dsOffsets, numBands, outputImage, gdalFormat, gdalDataType, &width, &height, &yBlockSize);
+
+            size_t stripNumPxls = ((size_t)width) * yBlockSize;
+            std::vector<int> pxlScenes(stripNumPxls);
+            std::vector<float> outData(stripNumPxls * numBands);
+            std::vector<float> sceneData(stripNumPxls);
+            // The pixels of the strip ordered by the scene selected, with the
+            // region of the strip covered by each scene.
+            std::vector<size_t> scenePxlStart(numScenes+1);
+            std::vector<size_t> scenePxls(stripNumPxls);
+            std::vector<int> sceneMinX(numScenes);
+            std::vector<int> sceneMaxX(numScenes);
+            std::vector<int> sceneMinY(numScenes);
+            std::vector<int> sceneMaxY(numScenes);
+
+            rsgis_tqdm pbar;
+            for(int row = 0; row < height; row += yBlockSize)
+            {
+                pbar.progress(row, height);
+                int nRows = std::min(yBlockSize, height - row);
+                size_t numPxls = ((size_t)width) * nRows;
+
+                this->selector->selectScenes(dsOffsets, row, width, nRows, pxlScenes.data());
+
+                std::fill(scenePxlStart.begin(), scenePxlStart.end(), 0);
+                std::fill(sceneMinX.begin(), sceneMinX.end(), width);
+                std::fill(sceneMaxX.begin(), sceneMaxX.end(), -1);
+                std::fill(sceneMinY.begin(), sceneMinY.end(), nRows);
+                std::fill(sceneMaxY.begin(), sceneMaxY.end(), -1);
+                for(int y = 0; y < nRows; ++y)
+                {
+                    for(int x = 0; x < width; ++x)
+                    {
+                        int scene = pxlScenes[(((size_t)y) * width) + x];
+                        if(scene >= ((int)numScenes))
+                        {
+                            throw RSGISImageCalcException("The scene selected is not within the list of scenes.");
+                        }
+                        else if(scene >= 0)
+                        {
+                            ++scenePxlStart[scene+1];
+                            sceneMinX[scene] = std::min(sceneMinX[scene], x);
+                            sceneMaxX[scene] = std::max(sceneMaxX[scene], x);
+                            sceneMinY[scene] = std::min(sceneMinY[scene], y);
+                            sceneMaxY[scene] = std::max(sceneMaxY[scene], y);
+                        }
+                    }
+                }
+                for(unsigned int s = 0; s < numScenes; ++s)
+                {
+                    scenePxlStart[s+1] += scenePxlStart[s];
+                }
+                std::vector<size_t> sceneNextPxl(scenePxlStart.begin(), scenePxlStart.end()-1);
+                for(size_t i = 0; i < numPxls; ++i)
+                {
+                    if(pxlScenes[i] >= 0)
+                    {
+                        scenePxls[sceneNextPxl[pxlScenes[i]]++] = i;
+                    }
+                }
+
+                std::fill(outData.begin(), outData.begin() + (numPxls * numBands), this->outNoDataVal);
+                for(unsigned int s = 0; s < numScenes; ++s)
+                {
+                    if(scenePxlStart[s] == scenePxlStart[s+1])
+                    {
+                        continue;
+                    }
+                    // Only read the region of the strip where the scene was selected.
+                    int winX = sceneMinX[s];
+                    int winY = sceneMinY[s];
+                    int winWidth = sceneMaxX[s] - winX + 1;
+                    int winHeight = sceneMaxY[s] - winY + 1;
+                    int *sceneOffsets = dsOffsets[numSelDS + s];
+                    for(int n = 0; n < numBands; ++n)
+                    {
+                        if(scenes[s]->GetRasterBand(n+1)->RasterIO(GF_Read, sceneOffsets[0]+winX, sceneOffsets[1]+row+winY, winWidth, winHeight, sceneData.data(), winWidth, winHeight, GDT_Float32, 0, 0) != CE_None)
+                        {
+                            throw RSGISImageBandException("Failed to read the input image.");
+                        }
+                        float *outBandData = &outData[n * numPxls];
+                        for(size_t p = scenePxlStart[s]; p < scenePxlStart[s+1]; ++p)
+                        {
+                            size_t i = scenePxls[p];
+                            size_t winIdx = ((((i / width) - winY)) * winWidth) + ((i % width) - winX);
+                            outBandData[i] = sceneData[winIdx];
+                        }
+                    }
+                }
+
+                for(int n = 0; n < numBands; ++n)
+                {
+                    if(outputImageDS->GetRasterBand(n+1)->RasterIO(GF_Write, 0, row, width, nRows, &outData[n * numPxls], width, nRows, GDT_Float32, 0, 0) != CE_None)
+                    {
+                        throw RSGISImageBandException("Failed to write the output image.");
+                    }
+                }
+            }
+            pbar.finish();
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            if(outputImageDS != NULL)
+            {
+                GDALClose(outputImageDS);
+            }
+            for(size_t i = 0; i < datasets.size(); ++i)
+            {
+                delete[] dsOffsets[i];
+            }
+            delete[] dsOffsets;
+            throw e;
+        }
+        catch(RSGISImageBandException &e)
+        {
+            if(outputImageDS != NULL)
+            {
+                GDALClose(outputImageDS);
+            }
+            for(size_t i = 0; i < datasets.size(); ++i)
+            {
+                delete[] dsOffsets[i];
+            }
+            delete[] dsOffsets;
+            throw e;
+        }
+
+        GDALClose(outputImageDS);
+        for(size_t i = 0; i < datasets.size(); ++i)
+        {
+            delete[] dsOffsets[i];
+        }
+        delete[] dsOffsets;
+    }
+    
+    RSGISPercentileImageComposite::RSGISPercentileImageComposite(float percentile, float noDataVal, float outNoDataVal) : RSGISStripImageComposite()
+    {
+        if((percentile < 0) || (percentile > 100))
+        {
+            throw RSGISImageCalcException("The percentile must be between 0 and 100.");
+        }
+        this->percentile = percentile;
+        this->noDataVal = noDataVal;
+        this->outNoDataVal = outNoDataVal;
+    }
+
+    void RSGISPercentileImageComposite::createComposite(std::vector<GDALDataset*> scenes, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType)
+    {
+        if(scenes.empty())
+        {
+            throw RSGISImageCalcException("No scenes have been provided for the composite.");
+        }
+        int numBands = scenes[0]->GetRasterCount();
+        for(std::vector<GDALDataset*>::iterator iterScenes = scenes.begin(); iterScenes != scenes.end(); ++iterScenes)
+        {
+            if((*iterScenes)->GetRasterCount() != numBands)
+            {
+                throw RSGISImageCalcException("Input images have different number of image bands.");
+            }
+        }
+        size_t numScenes = scenes.size();
+
+        int **dsOffsets = new int*[numScenes];
+        for(size_t i = 0; i < numScenes; ++i)
+        {
+            dsOffsets[i] = new int[2];
+        }
+        int width = 0;
+        int height = 0;
+        int yBlockSize = 0;
+        GDALDataset *outputImageDS = NULL;
+
+        try
+        {
+            outputImageDS = this->createOutputImage(&scenes, dsOffsets, numBands, outputImage, gdalFormat, gdalDataType, &width, &height, &yBlockSize);
+
+            // The scene values and the valid values of each pixel are both buffered.
+            int winCols = this->getColumnWindow(numScenes * 2, width, yBlockSize);
+            size_t winMaxPxls = ((size_t)winCols) * yBlockSize;
+            std::vector<float> sceneVals(numScenes * winMaxPxls);
+            std::vector<float> pxlVals(numScenes * winMaxPxls);
+            std::vector<unsigned int> pxlNumVals(winMaxPxls);
+            std::vector<float> outData(((size_t)width) * yBlockSize);
+            double rankScale = this->percentile / 100.0;
+
+            rsgis_tqdm pbar;
+            for(int row = 0; row < height; row += yBlockSize)
+            {
+                pbar.progress(row, height);
+                int nRows = std::min(yBlockSize, height - row);
+                for(int n = 0; n < numBands; ++n)
+                {
+                    for(int x0 = 0; x0 < width; x0 += winCols)
+                    {
+                        int winWidth = std::min(winCols, width - x0);
+                        size_t winNumPxls = ((size_t)winWidth) * nRows;
+                        for(size_t s = 0; s < numScenes; ++s)
+                        {
+                            if(scenes[s]->GetRasterBand(n+1)->RasterIO(GF_Read, dsOffsets[s][0]+x0, dsOffsets[s][1]+row, winWidth, nRows, &sceneVals[s * winNumPxls], winWidth, nRows, GDT_Float32, 0, 0) != CE_None)
+                            {
+                                throw RSGISImageBandException("Failed to read the input image.");
+                            }
+                        }
+
+                        // Compact the valid values of each pixel so they are contiguous.
+                        std::fill(pxlNumVals.begin(), pxlNumVals.begin() + winNumPxls, 0);
+                        for(size_t s = 0; s < numScenes; ++s)
+                        {
+                            const float *vals = &sceneVals[s * winNumPxls];
+                            for(size_t i = 0; i < winNumPxls; ++i)
+                            {
+                                if((vals[i] != this->noDataVal) && (!std::isnan(vals[i])))
+                                {
+                                    pxlVals[(i * numScenes) + pxlNumVals[i]++] = vals[i];
+                                }
+                            }
+                        }
+
+                        for(size_t i = 0; i < winNumPxls; ++i)
+                        {
+                            float outVal = this->outNoDataVal;
+                            unsigned int numVals = pxlNumVals[i];
+                            if(numVals > 0)
+                            {
+                                float *vals = &pxlVals[i * numScenes];
+                                double rank = rankScale * (numVals - 1);
+                                unsigned int k = (unsigned int)std::floor(rank);
+                                double rankFrac = rank - k;
+                                std::nth_element(vals, vals + k, vals + numVals);
+                                double pVal = vals[k];
+                                if((rankFrac > 0) && ((k + 1) < numVals))
+                                {
+                                    // The next value is the smallest of those above the kth.
+                                    double nextVal = *std::min_element(vals + k + 1, vals + numVals);
+                                    pVal = pVal + (rankFrac * (nextVal - pVal));
+                                }
+                                outVal = pVal;
+                            }
+                            outData[(((size_t)(i / winWidth)) * width) + x0 + (i % winWidth)] = outVal;
+                        }
+                    }
+
+                    if(outputImageDS->GetRasterBand(n+1)->RasterIO(GF_Write, 0, row, width, nRows, outData.data(), width, nRows, GDT_Float32, 0, 0) != CE_None)
+                    {
+                        throw RSGISImageBandException("Failed to write the output image.");
+                    }
+                }
+            }
+            pbar.finish();
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            if(outputImageDS != NULL)
+            {
+                GDALClose(outputImageDS);
+            }
+            for(size_t i = 0; i < numScenes; ++i)
+            {
+                delete[] dsOffsets[i];
+            }
+            delete[] dsOffsets;
+            throw e;
+        }
+        catch(RSGISImageBandException &e)
+        {
+            if(outputImageDS != NULL)
+            {
+                GDALClose(outputImageDS);
+            }
+            for(size_t i = 0; i < numScenes; ++i)
+            {
+                delete[] dsOffsets[i];
+            }
+            delete[] dsOffsets;
+            throw e;
+        }
+
+        GDALClose(outputImageDS);
+        for(size_t i = 0; i < numScenes; ++i)
+        {
+            delete[] dsOffsets[i];
+        }
+        delete[] dsOffsets;
+    }
+    
 }}
 
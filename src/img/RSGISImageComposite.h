@@ -23,6 +23,10 @@
 
 #include <cmath>
 #include <set>
+#include <vector>
+#include <algorithm>
+
+#include "gdal_priv.h"
 
 #include "common/RSGISException.h"
 #include "common/RSGISImageException.h"
@@ -30,6 +34,10 @@
 
 #include "img/RSGISCalcImage.h"
 #include "img/RSGISCalcImageValue.h"
+#include "img/RSGISImageUtils.h"
+#include "img/RSGISImageBandException.h"
+
+#include "common/rsgis-tqdm.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -223,4 +231,169 @@ namespace rsgis { namespace img {
     };
     
     
+    /**
+     * Base class for composites which are created a strip of the output image at a time.
+     */
+    class DllExport RSGISStripImageComposite
+    {
+    public:
+        RSGISStripImageComposite(){};
+        /**
+         * The number of columns of a strip to read at a time so numReadBands bands
+         * of the strip fit within the read buffer (at least 1 column).
+         */
+        static int getColumnWindow(size_t numReadBands, int xSize, int ySize);
+        virtual ~RSGISStripImageComposite(){};
+    protected:
+        /**
+         * Create the output image for the overlap of the datasets, providing the offsets
+         * of the overlap within each dataset and the number of rows in each strip.
+         */
+        GDALDataset* createOutputImage(std::vector<GDALDataset*> *datasets, int **dsOffsets, int numBands, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType, int *width, int *height, int *stripRows);
+        static const size_t maxReadBufferVals = 16777216;
+    };
+
+    /**
+     * Selects the scene to be used for each pixel of a composite created with
+     * RSGISSelectiveImageComposite, reading only the image bands needed to
+     * make the selection.
+     */
+    class DllExport RSGISCompositeSceneSelector
+    {
+    public:
+        RSGISCompositeSceneSelector(){};
+        /** The datasets read to select the scenes, these define the composite extent with the scenes. */
+        virtual std::vector<GDALDataset*> getSelectionDatasets()=0;
+        /**
+         * Select the scene (from 0) for each pixel of a strip of the composite, where -1 is no data.
+         * The strip starts at row yOff of the composite and dsOffsets gives the pixel offset of
+         * the composite within each of the selection datasets.
+         */
+        virtual void selectScenes(int **dsOffsets, int yOff, int xSize, int ySize, int *pxlScenes)=0;
+        virtual ~RSGISCompositeSceneSelector(){};
+    };
+
+    /**
+     * Select the scene with the maximum NDVI, where only pixels with non-zero
+     * red and NIR values are used. If no scene is valid then the first scene is used.
+     */
+    class DllExport RSGISMaxNDVISceneSelector : public RSGISCompositeSceneSelector
+    {
+    public:
+        /** redBand and nirBand are indexed from 0. */
+        RSGISMaxNDVISceneSelector(std::vector<GDALDataset*> scenes, unsigned int redBand, unsigned int nirBand);
+        std::vector<GDALDataset*> getSelectionDatasets(){return this->scenes;};
+        void selectScenes(int **dsOffsets, int yOff, int xSize, int ySize, int *pxlScenes);
+        ~RSGISMaxNDVISceneSelector(){};
+    protected:
+        std::vector<GDALDataset*> scenes;
+        unsigned int redBand;
+        unsigned int nirBand;
+        std::vector<float> redVals;
+        std::vector<float> nirVals;
+        std::vector<float> maxNDVIVals;
+    };
+
+    /**
+     * Select the scene given by a reference image, where 0 is no data and
+     * 1 is the first scene.
+     */
+    class DllExport RSGISRefImgSceneSelector : public RSGISCompositeSceneSelector
+    {
+    public:
+        RSGISRefImgSceneSelector(GDALDataset *refImage, unsigned int numScenes);
+        std::vector<GDALDataset*> getSelectionDatasets(){return std::vector<GDALDataset*>(1, this->refImage);};
+        void selectScenes(int **dsOffsets, int yOff, int xSize, int ySize, int *pxlScenes);
+        ~RSGISRefImgSceneSelector(){};
+    protected:
+        GDALDataset *refImage;
+        unsigned int numScenes;
+        std::vector<int> refVals;
+    };
+
+    /**
+     * Select the scene for a time series fill composite, where the fill reference image
+     * values are looked up in imgIdxLUT to find the scene (from 1, with 0 also the first
+     * scene). Pixels not filled (value 0) use the first scene.
+     */
+    class DllExport RSGISTimeseriesFillSceneSelector : public RSGISCompositeSceneSelector
+    {
+    public:
+        RSGISTimeseriesFillSceneSelector(GDALDataset *fillRefImage, unsigned int *imgIdxLUT, unsigned int nLUT);
+        std::vector<GDALDataset*> getSelectionDatasets(){return std::vector<GDALDataset*>(1, this->fillRefImage);};
+        void selectScenes(int **dsOffsets, int yOff, int xSize, int ySize, int *pxlScenes);
+        ~RSGISTimeseriesFillSceneSelector(){};
+    protected:
+        GDALDataset *fillRefImage;
+        unsigned int *imgIdxLUT;
+        unsigned int nLUT;
+        std::vector<int> refVals;
+    };
+
+    /**
+     * Select the medoid scene, which is the valid scene with the smallest sum of the
+     * Euclidean distances (over the bands given) to the other valid scenes. Scenes
+     * where any of the bands are the no data value or NaN are not valid and pixels
+     * without a valid scene are no data.
+     */
+    class DllExport RSGISMedoidSceneSelector : public RSGISCompositeSceneSelector
+    {
+    public:
+        /** The bands are indexed from 0. */
+        RSGISMedoidSceneSelector(std::vector<GDALDataset*> scenes, std::vector<unsigned int> bands, float noDataVal);
+        std::vector<GDALDataset*> getSelectionDatasets(){return this->scenes;};
+        void selectScenes(int **dsOffsets, int yOff, int xSize, int ySize, int *pxlScenes);
+        ~RSGISMedoidSceneSelector(){};
+    protected:
+        std::vector<GDALDataset*> scenes;
+        std::vector<unsigned int> bands;
+        float noDataVal;
+        // The bands of each scene for a window of the strip (scene, band, pixel).
+        std::vector<float> sceneVals;
+        // The valid observations of a pixel (band, observation).
+        std::vector<float> obsVals;
+        std::vector<int> obsScenes;
+        std::vector<double> obsDist;
+    };
+
+    /**
+     * Create a composite in two passes over each strip of the output image. First the
+     * selector picks the scene for each pixel, reading only the bands it needs, then
+     * only the scenes which have been selected are read, each within the region of the
+     * strip where it was selected. The memory used is therefore independent of the
+     * number of scenes.
+     */
+    class DllExport RSGISSelectiveImageComposite : public RSGISStripImageComposite
+    {
+    public:
+        RSGISSelectiveImageComposite(RSGISCompositeSceneSelector *selector, float outNoDataVal);
+        /** All the scenes need to have the same number of bands, which are copied to the output image. */
+        void createComposite(std::vector<GDALDataset*> scenes, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType);
+        ~RSGISSelectiveImageComposite(){};
+    protected:
+        RSGISCompositeSceneSelector *selector;
+        float outNoDataVal;
+    };
+    
+    /**
+     * Create a composite where each output band is a percentile (e.g., 50 for the median)
+     * of the valid values of the band through the scenes, interpolating linearly between
+     * the closest ranks. Values equal to the no data value or NaN are ignored and pixels
+     * without any valid values are given outNoDataVal. Scenes are read a band and a
+     * window of the strip at a time, with the partial sort only over the valid values.
+     */
+    class DllExport RSGISPercentileImageComposite : public RSGISStripImageComposite
+    {
+    public:
+        /** percentile is between 0 and 100. */
+        RSGISPercentileImageComposite(float percentile, float noDataVal, float outNoDataVal);
+        /** All the scenes need to have the same number of bands. */
+        void createComposite(std::vector<GDALDataset*> scenes, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType);
+        ~RSGISPercentileImageComposite(){};
+    protected:
+        float percentile;
+        float noDataVal;
+        float outNoDataVal;
+    };
+    
 }}
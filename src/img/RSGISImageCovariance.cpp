@@ -0,0 +1,272 @@
+/*
+ *  RSGISImageCovariance.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISImageCovariance.h"
+
+namespace rsgis{namespace img{
+
+    RSGISCovarianceAccumulator::RSGISCovarianceAccumulator(unsigned int numVars)
+    {
+        if(numVars == 0)
+        {
+            throw RSGISImageException("The number of variables for the covariance must be at least 1.");
+        }
+        this->numVars = numVars;
+        this->n = 0;
+        this->mean.assign(numVars, 0.0);
+        this->m2.assign(((size_t)numVars) * numVars, 0.0);
+    }
+
+    void RSGISCovarianceAccumulator::addBlock(double *vals, size_t nObs)
+    {
+        if(nObs == 0)
+        {
+            return;
+        }
+
+        this->blockMean.assign(this->numVars, 0.0);
+        for(size_t i = 0; i < nObs; ++i)
+        {
+            const double *obs = &vals[i * this->numVars];
+            for(unsigned int j = 0; j < this->numVars; ++j)
+            {
+                this->blockMean[j] += obs[j];
+            }
+        }
+        for(unsigned int j = 0; j < this->numVars; ++j)
+        {
+            this->blockMean[j] /= (double)nObs;
+        }
+        for(size_t i = 0; i < nObs; ++i)
+        {
+            double *obs = &vals[i * this->numVars];
+            for(unsigned int j = 0; j < this->numVars; ++j)
+            {
+                obs[j] -= this->blockMean[j];
+            }
+        }
+
+        // The co-moments of the block are X'X of the centred observations (upper triangle).
+        this->blockM2.resize(((size_t)this->numVars) * this->numVars);
+        gsl_matrix_view obsMatrix = gsl_matrix_view_array(vals, nObs, this->numVars);
+        gsl_matrix_view m2Matrix = gsl_matrix_view_array(this->blockM2.data(), this->numVars, this->numVars);
+        gsl_blas_dsyrk(CblasUpper, CblasTrans, 1.0, &obsMatrix.matrix, 0.0, &m2Matrix.matrix);
+
+        this->mergeMoments(nObs, this->blockMean.data(), this->blockM2.data());
+    }
+
+    void RSGISCovarianceAccumulator::merge(const RSGISCovarianceAccumulator &acc)
+    {
+        if(acc.numVars != this->numVars)
+        {
+            throw RSGISImageException("The covariance accumulators have a different number of variables.");
+        }
+        this->mergeMoments(acc.n, acc.mean.data(), acc.m2.data());
+    }
+
+    std::vector<double> RSGISCovarianceAccumulator::getCovariance()
+    {
+        std::vector<double> covariance(((size_t)this->numVars) * this->numVars, 0.0);
+        if(this->n < 2)
+        {
+            return covariance;
+        }
+        double denom = (double)(this->n - 1);
+        for(unsigned int i = 0; i < this->numVars; ++i)
+        {
+            for(unsigned int j = i; j < this->numVars; ++j)
+            {
+                covariance[(i * this->numVars) + j] = this->m2[(i * this->numVars) + j] / denom;
+                covariance[(j * this->numVars) + i] = covariance[(i * this->numVars) + j];
+            }
+        }
+        return covariance;
+    }
+
+    double RSGISCovarianceAccumulator::getCovarianceAbout(unsigned int a, unsigned int b, double meanA, double meanB)
+    {
+        if((a >= this->numVars) || (b >= this->numVars))
+        {
+            throw RSGISImageException("The variable is not within the covariance accumulator.");
+        }
+        if(this->n < 2)
+        {
+            return 0.0;
+        }
+        // sum((x_a - meanA)(x_b - meanB)) = m2_ab + n(mean_a - meanA)(mean_b - meanB)
+        double coMoment = this->m2[(std::min(a, b) * this->numVars) + std::max(a, b)];
+        coMoment += ((double)this->n) * (this->mean[a] - meanA) * (this->mean[b] - meanB);
+        return coMoment / ((double)(this->n - 1));
+    }
+
+    void RSGISCovarianceAccumulator::mergeMoments(unsigned long long nB, const double *meanB, const double *m2B)
+    {
+        if(nB == 0)
+        {
+            return;
+        }
+        if(this->n == 0)
+        {
+            this->n = nB;
+            for(unsigned int i = 0; i < this->numVars; ++i)
+            {
+                this->mean[i] = meanB[i];
+                for(unsigned int j = i; j < this->numVars; ++j)
+                {
+                    this->m2[(i * this->numVars) + j] = m2B[(i * this->numVars) + j];
+                }
+            }
+            return;
+        }
+
+        double nA = (double)this->n;
+        double nTot = nA + (double)nB;
+        double scale = (nA * ((double)nB)) / nTot;
+        std::vector<double> delta(this->numVars);
+        for(unsigned int i = 0; i < this->numVars; ++i)
+        {
+            delta[i] = meanB[i] - this->mean[i];
+        }
+        for(unsigned int i = 0; i < this->numVars; ++i)
+        {
+            for(unsigned int j = i; j < this->numVars; ++j)
+            {
+                this->m2[(i * this->numVars) + j] += m2B[(i * this->numVars) + j] + (delta[i] * delta[j] * scale);
+            }
+            this->mean[i] += delta[i] * (((double)nB) / nTot);
+        }
+        this->n += nB;
+    }
+
+    RSGISCovarianceAccumulator::~RSGISCovarianceAccumulator()
+    {
+
+    }
+
+
+
+    RSGISCalcImageCovariance::RSGISCalcImageCovariance(unsigned int numThreads)
+    {
+        this->numThreads = numThreads;
+        if(this->numThreads == 0)
+        {
+            this->numThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+        }
+    }
+
+    RSGISCovarianceAccumulator RSGISCalcImageCovariance::calcCovariance(GDALDataset **datasets, int numDS, bool noDataDefined, double noDataVal)
+    {
+        RSGISImageUtils imgUtils;
+        int width = 0;
+        int height = 0;
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        double gdalTranslation[6];
+        std::vector<int> dsOffsetVals(numDS * 2, 0);
+        std::vector<int*> dsOffsets(numDS);
+        for(int i = 0; i < numDS; ++i)
+        {
+            dsOffsets[i] = &dsOffsetVals[i * 2];
+        }
+        imgUtils.getImageOverlap(datasets, numDS, dsOffsets.data(), &width, &height, gdalTranslation, &xBlockSize, &yBlockSize);
+
+        std::vector<GDALRasterBand*> bands;
+        std::vector<int> bandDS;
+        for(int i = 0; i < numDS; ++i)
+        {
+            for(int j = 0; j < datasets[i]->GetRasterCount(); ++j)
+            {
+                bands.push_back(datasets[i]->GetRasterBand(j+1));
+                bandDS.push_back(i);
+            }
+        }
+        unsigned int numBands = bands.size();
+        if(numBands == 0)
+        {
+            throw RSGISImageException("The input images do not have any image bands.");
+        }
+
+        unsigned int stripRows = std::max((unsigned int)std::max(yBlockSize, 1), RSGIS_COVAR_STRIP_ROWS);
+        // The strip is stored by pixel so each row of the strip is a block of observations.
+        std::vector<double> stripVals(((size_t)width) * stripRows * numBands);
+        std::vector< std::vector<double> > threadVals(this->numThreads);
+        std::vector<RSGISCovarianceAccumulator> threadAccs(this->numThreads, RSGISCovarianceAccumulator(numBands));
+
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        rsgis_tqdm pbar;
+        for(int row = 0; row < height; row += stripRows)
+        {
+            pbar.progress(row, height);
+            int nRows = std::min((int)stripRows, height - row);
+            for(unsigned int n = 0; n < numBands; ++n)
+            {
+                int xOff = dsOffsets[bandDS[n]][0];
+                int yOff = dsOffsets[bandDS[n]][1] + row;
+                if(bands[n]->RasterIO(GF_Read, xOff, yOff, width, nRows, &stripVals[n], width, nRows, GDT_Float64, sizeof(double) * numBands, sizeof(double) * numBands * width) != CE_None)
+                {
+                    throw RSGISImageException("Could not read the image band.");
+                }
+            }
+
+            threadPool.parallelFor(0, nRows, [&](unsigned int threadIdx, size_t startRow, size_t endRow)
+            {
+                std::vector<double> *obsVals = &threadVals[threadIdx];
+                obsVals->clear();
+                for(size_t i = startRow * width; i < endRow * width; ++i)
+                {
+                    const double *pxlVals = &stripVals[i * numBands];
+                    bool valid = true;
+                    for(unsigned int n = 0; n < numBands; ++n)
+                    {
+                        if(std::isnan(pxlVals[n]) || (noDataDefined && (pxlVals[n] == noDataVal)))
+                        {
+                            valid = false;
+                            break;
+                        }
+                    }
+                    if(valid)
+                    {
+                        obsVals->insert(obsVals->end(), pxlVals, pxlVals + numBands);
+                    }
+                }
+                threadAccs[threadIdx].addBlock(obsVals->data(), obsVals->size() / numBands);
+            });
+        }
+        pbar.finish();
+
+        // Merge the thread accumulators pairwise.
+        for(unsigned int step = 1; step < this->numThreads; step *= 2)
+        {
+            for(unsigned int t = 0; (t + step) < this->numThreads; t += (2 * step))
+            {
+                threadAccs[t].merge(threadAccs[t + step]);
+            }
+        }
+        return threadAccs[0];
+    }
+
+    RSGISCalcImageCovariance::~RSGISCalcImageCovariance()
+    {
+
+    }
+
+}}
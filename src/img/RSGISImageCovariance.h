@@ -0,0 +1,113 @@
+/*
+ *  RSGISImageCovariance.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISImageCovariance_H
+#define RSGISImageCovariance_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISImageException.h"
+#include "common/RSGISThreadPool.h"
+
+#include "img/RSGISImageUtils.h"
+
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_blas.h>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+
+    static const unsigned int RSGIS_COVAR_STRIP_ROWS( 256 );
+
+    /**
+     * Accumulates the means and co-moments (sums of the products of the
+     * deviations from the means) of a number of variables from blocks of
+     * observations. Each block is centred on its own mean and its co-moments
+     * calculated with a rank-k update (dsyrk), then merged with the running
+     * totals using the pairwise update of Chan et al., which avoids the loss
+     * of precision of accumulating the sums of the values and their squares.
+     */
+    class DllExport RSGISCovarianceAccumulator
+    {
+    public:
+        RSGISCovarianceAccumulator(unsigned int numVars);
+        /** Add nObs observations stored by observation (i.e., vals[(obs*numVars)+var]), the values are overwritten. */
+        void addBlock(double *vals, size_t nObs);
+        void merge(const RSGISCovarianceAccumulator &acc);
+        unsigned int getNumVars(){return this->numVars;};
+        unsigned long long getN(){return this->n;};
+        std::vector<double> getMeans(){return this->mean;};
+        /** Get the sample covariance (co-moments / (n-1)) as a symmetric numVars x numVars matrix (row-major). */
+        std::vector<double> getCovariance();
+        /** Get the covariance of variables a and b around the means specified rather than the sample means. */
+        double getCovarianceAbout(unsigned int a, unsigned int b, double meanA, double meanB);
+        ~RSGISCovarianceAccumulator();
+    protected:
+        void mergeMoments(unsigned long long nB, const double *meanB, const double *m2B);
+        unsigned int numVars;
+        unsigned long long n;
+        std::vector<double> mean;
+        // Only the upper triangle (i <= j) of the co-moments is accumulated.
+        std::vector<double> m2;
+        std::vector<double> blockMean;
+        std::vector<double> blockM2;
+    };
+
+    /**
+     * Calculates the covariance of all the bands of a set of images in a single
+     * pass over the images. The images are read, in strips, on the calling thread
+     * and the rows of each strip are accumulated on numThreads threads, with the
+     * thread accumulators merged pairwise once the images have been read.
+     */
+    class DllExport RSGISCalcImageCovariance
+    {
+    public:
+        /** If numThreads is 0 the number of hardware threads is used. */
+        RSGISCalcImageCovariance(unsigned int numThreads=1);
+        /** Accumulate the bands of the datasets (in order) over their overlap, ignoring pixels where any band is the no data value (or NaN). */
+        RSGISCovarianceAccumulator calcCovariance(GDALDataset **datasets, int numDS, bool noDataDefined, double noDataVal);
+        ~RSGISCalcImageCovariance();
+    protected:
+        unsigned int numThreads;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,720 @@
+/*
+ *  RSGISImageHistogramEngine.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISImageHistogramEngine.h"
+
+namespace rsgis{namespace img{
+
+    RSGISQuantileSketch::RSGISQuantileSketch(unsigned int k)
+    {
+        if(k < 8)
+        {
+            throw RSGISImageException("The size of the quantile sketch (k) must be at least 8.");
+        }
+        this->k = k;
+        this->n = 0;
+        this->minVal = 0;
+        this->maxVal = 0;
+        this->numItems = 0;
+        this->keepOdd = false;
+        this->levels.push_back(std::vector<double>());
+    }
+
+    void RSGISQuantileSketch::add(double val)
+    {
+        if(this->n == 0)
+        {
+            this->minVal = val;
+            this->maxVal = val;
+        }
+        else if(val < this->minVal)
+        {
+            this->minVal = val;
+        }
+        else if(val > this->maxVal)
+        {
+            this->maxVal = val;
+        }
+        ++this->n;
+
+        this->levels[0].push_back(val);
+        ++this->numItems;
+        if(this->numItems > this->getTotalCapacity())
+        {
+            this->compress();
+        }
+    }
+
+    void RSGISQuantileSketch::merge(const RSGISQuantileSketch &sketch)
+    {
+        if(sketch.n == 0)
+        {
+            return;
+        }
+        if(this->n == 0)
+        {
+            this->minVal = sketch.minVal;
+            this->maxVal = sketch.maxVal;
+        }
+        else
+        {
+            this->minVal = std::min(this->minVal, sketch.minVal);
+            this->maxVal = std::max(this->maxVal, sketch.maxVal);
+        }
+        this->n += sketch.n;
+
+        if(this->levels.size() < sketch.levels.size())
+        {
+            this->levels.resize(sketch.levels.size());
+        }
+        for(size_t h = 0; h < sketch.levels.size(); ++h)
+        {
+            this->levels[h].insert(this->levels[h].end(), sketch.levels[h].begin(), sketch.levels[h].end());
+            this->numItems += sketch.levels[h].size();
+        }
+        while(this->numItems > this->getTotalCapacity())
+        {
+            this->compress();
+        }
+    }
+
+    double RSGISQuantileSketch::getQuantile(double quantile)
+    {
+        if(this->n == 0)
+        {
+            return 0.0;
+        }
+        if(quantile <= 0)
+        {
+            return this->minVal;
+        }
+        if(quantile >= 1)
+        {
+            return this->maxVal;
+        }
+
+        std::vector< std::pair<double, unsigned long long> > items;
+        items.reserve(this->numItems);
+        for(size_t h = 0; h < this->levels.size(); ++h)
+        {
+            unsigned long long weight = 1ULL << h;
+            for(std::vector<double>::iterator iterVal = this->levels[h].begin(); iterVal != this->levels[h].end(); ++iterVal)
+            {
+                items.push_back(std::pair<double, unsigned long long>(*iterVal, weight));
+            }
+        }
+        std::sort(items.begin(), items.end());
+
+        // The (zero based) rank of the quantile, as used by gsl_stats_quantile_from_sorted_data.
+        double rank = quantile * (double)(this->n - 1);
+        unsigned long long cumWeight = 0;
+        for(std::vector< std::pair<double, unsigned long long> >::iterator iterItem = items.begin(); iterItem != items.end(); ++iterItem)
+        {
+            cumWeight += (*iterItem).second;
+            if((double)cumWeight > rank)
+            {
+                return (*iterItem).first;
+            }
+        }
+        return this->maxVal;
+    }
+
+    unsigned int RSGISQuantileSketch::getLevelCapacity(unsigned int level)
+    {
+        // The capacity decreases by 2/3 for each level below the top level.
+        unsigned int depth = (this->levels.size() - 1) - level;
+        unsigned int capacity = std::ceil(((double)this->k) * std::pow(2.0/3.0, (double)depth));
+        return std::max(capacity, (unsigned int)2);
+    }
+
+    size_t RSGISQuantileSketch::getTotalCapacity()
+    {
+        size_t capacity = 0;
+        for(unsigned int h = 0; h < this->levels.size(); ++h)
+        {
+            capacity += this->getLevelCapacity(h);
+        }
+        return capacity;
+    }
+
+    void RSGISQuantileSketch::compress()
+    {
+        for(unsigned int h = 0; h < this->levels.size(); ++h)
+        {
+            if(this->levels[h].size() >= this->getLevelCapacity(h))
+            {
+                if((h + 1) == this->levels.size())
+                {
+                    this->levels.push_back(std::vector<double>());
+                }
+                std::vector<double> *level = &this->levels[h];
+                std::sort(level->begin(), level->end());
+
+                // An odd item is kept on this level so the total weight is unchanged.
+                bool haveHeld = ((level->size() % 2) == 1);
+                double heldVal = 0;
+                if(haveHeld)
+                {
+                    heldVal = level->back();
+                    level->pop_back();
+                }
+
+                // Every other item is promoted with twice the weight.
+                size_t offset = this->keepOdd?1:0;
+                this->keepOdd = !this->keepOdd;
+                for(size_t i = offset; i < level->size(); i += 2)
+                {
+                    this->levels[h+1].push_back((*level)[i]);
+                }
+                this->numItems -= level->size() / 2;
+
+                level->clear();
+                if(haveHeld)
+                {
+                    level->push_back(heldVal);
+                }
+                return;
+            }
+        }
+    }
+
+    RSGISQuantileSketch::~RSGISQuantileSketch()
+    {
+
+    }
+
+
+
+    RSGISImageHistogramEngine::RSGISImageHistogramEngine(unsigned int numThreads)
+    {
+        this->numThreads = numThreads;
+        if(this->numThreads == 0)
+        {
+            this->numThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+        }
+    }
+
+    bool RSGISImageHistogramEngine::hasExactIntBins(GDALDataType dataType)
+    {
+        return ((dataType == GDT_Byte) | (dataType == GDT_UInt16) | (dataType == GDT_Int16));
+    }
+
+    std::vector<RSGISBandHistogram> RSGISImageHistogramEngine::calcExactHistograms(GDALDataset *dataset, std::vector<unsigned int> bands, bool noDataDefined, double noDataVal)
+    {
+        std::vector<RSGISBandHistogram> hists(bands.size());
+        for(size_t i = 0; i < bands.size(); ++i)
+        {
+            if((bands[i] == 0) || (bands[i] > (unsigned int)dataset->GetRasterCount()))
+            {
+                throw RSGISImageException("The band specified is not within the image.");
+            }
+            GDALDataType dataType = dataset->GetRasterBand(bands[i])->GetRasterDataType();
+            if(dataType == GDT_Byte)
+            {
+                hists[i].binMin = 0;
+                hists[i].bins.assign(256, 0);
+            }
+            else if(dataType == GDT_UInt16)
+            {
+                hists[i].binMin = 0;
+                hists[i].bins.assign(65536, 0);
+            }
+            else if(dataType == GDT_Int16)
+            {
+                hists[i].binMin = -32768;
+                hists[i].bins.assign(65536, 0);
+            }
+            else
+            {
+                throw RSGISImageException("A histogram with a bin per value can only be calculated for 8 or 16 bit integer image bands.");
+            }
+            hists[i].binWidth = 1;
+        }
+
+        this->accumulateHistograms(dataset, bands, &hists, noDataDefined, noDataVal);
+        return hists;
+    }
+
+    std::vector<RSGISBandHistogram> RSGISImageHistogramEngine::calcHistograms(GDALDataset *dataset, std::vector<unsigned int> bands, double binMin, double binWidth, unsigned int nBins, bool noDataDefined, double noDataVal)
+    {
+        if((nBins > 0) && !(binWidth > 0))
+        {
+            throw RSGISImageException("The histogram bin width must be greater than zero.");
+        }
+
+        std::vector<RSGISBandHistogram> hists(bands.size());
+        for(size_t i = 0; i < bands.size(); ++i)
+        {
+            hists[i].binMin = binMin;
+            hists[i].binWidth = binWidth;
+            hists[i].bins.assign(nBins, 0);
+        }
+
+        this->accumulateHistograms(dataset, bands, &hists, noDataDefined, noDataVal);
+        return hists;
+    }
+
+    std::vector<RSGISQuantileSketch> RSGISImageHistogramEngine::calcQuantileSketches(GDALDataset *dataset, std::vector<unsigned int> bands, bool noDataDefined, double noDataVal, unsigned int k)
+    {
+        std::vector< std::vector<RSGISQuantileSketch> > threadSketches(this->numThreads, std::vector<RSGISQuantileSketch>(bands.size(), RSGISQuantileSketch(k)));
+
+        this->scanBands(dataset, bands, [&](unsigned int threadIdx, unsigned int bandIdx, const double *vals, size_t nVals)
+        {
+            RSGISQuantileSketch *sketch = &threadSketches[threadIdx][bandIdx];
+            for(size_t i = 0; i < nVals; ++i)
+            {
+                if(std::isnan(vals[i]) || (noDataDefined && (vals[i] == noDataVal)))
+                {
+                    continue;
+                }
+                sketch->add(vals[i]);
+            }
+        });
+
+        std::vector<RSGISQuantileSketch> sketches = threadSketches[0];
+        for(unsigned int t = 1; t < this->numThreads; ++t)
+        {
+            for(size_t i = 0; i < bands.size(); ++i)
+            {
+                sketches[i].merge(threadSketches[t][i]);
+            }
+        }
+        return sketches;
+    }
+
+    double RSGISImageHistogramEngine::getPercentile(RSGISBandHistogram *hist, double percentile)
+    {
+        unsigned long long nInBins = 0;
+        for(std::vector<unsigned long long>::iterator iterBin = hist->bins.begin(); iterBin != hist->bins.end(); ++iterBin)
+        {
+            nInBins += *iterBin;
+        }
+        if(nInBins == 0)
+        {
+            return 0.0;
+        }
+
+        double index = percentile * (double)(nInBins - 1);
+        unsigned long long lhs = std::floor(index);
+        double delta = index - (double)lhs;
+        double lhsVal = getValueAtRank(hist, lhs);
+        if((lhs + 1) >= nInBins)
+        {
+            return lhsVal;
+        }
+        return ((1 - delta) * lhsVal) + (delta * getValueAtRank(hist, lhs + 1));
+    }
+
+    std::vector<double> RSGISImageHistogramEngine::calcExactPercentiles(GDALDataset *dataset, std::vector<unsigned int> bands, double percentile, bool noDataDefined, double noDataVal)
+    {
+        if((percentile < 0) || (percentile > 1))
+        {
+            throw RSGISImageException("The percentile must be between 0 and 1.");
+        }
+        std::vector<double> outVals(bands.size(), 0.0);
+        if(bands.empty())
+        {
+            return outVals;
+        }
+        
+        bool allExactInt = true;
+        for(size_t i = 0; i < bands.size(); ++i)
+        {
+            if((bands[i] == 0) || (bands[i] > (unsigned int)dataset->GetRasterCount()))
+            {
+                throw RSGISImageException("The band specified is not within the image.");
+            }
+            allExactInt = allExactInt && hasExactIntBins(dataset->GetRasterBand(bands[i])->GetRasterDataType());
+        }
+        if(allExactInt)
+        {
+            std::vector<RSGISBandHistogram> hists = this->calcExactHistograms(dataset, bands, noDataDefined, noDataVal);
+            for(size_t i = 0; i < bands.size(); ++i)
+            {
+                outVals[i] = getPercentile(&hists[i], percentile);
+            }
+            return outVals;
+        }
+        
+        // The state of the search of each band, where the values of the ranks are
+        // within [lo, hi] and inCount is (about) the number of values in the range.
+        struct PercentileSearch
+        {
+            unsigned long long ranks[2];
+            double rankVals[2];
+            double delta;
+            double lo;
+            double hi;
+            unsigned long long inCount;
+            bool collect;
+            bool countVals;
+            bool done;
+        };
+        std::vector<RSGISBandHistogram> rangeHists = this->calcHistograms(dataset, bands, 0.0, 1.0, 0, noDataDefined, noDataVal);
+        std::vector<PercentileSearch> searches(bands.size());
+        for(size_t i = 0; i < bands.size(); ++i)
+        {
+            PercentileSearch *search = &searches[i];
+            search->done = (rangeHists[i].nVals == 0) || (rangeHists[i].minVal == rangeHists[i].maxVal);
+            search->rankVals[0] = rangeHists[i].minVal;
+            search->rankVals[1] = rangeHists[i].minVal;
+            search->lo = rangeHists[i].minVal;
+            search->hi = rangeHists[i].maxVal;
+            search->inCount = rangeHists[i].nVals;
+            search->countVals = false;
+            search->ranks[0] = 0;
+            search->ranks[1] = 0;
+            search->delta = 0;
+            if(rangeHists[i].nVals > 0)
+            {
+                double index = percentile * (double)(rangeHists[i].nVals - 1);
+                search->ranks[0] = std::floor(index);
+                search->ranks[1] = std::min(search->ranks[0] + 1, rangeHists[i].nVals - 1);
+                search->delta = index - (double)search->ranks[0];
+            }
+        }
+        
+        // The values of a band within the range of its search from a single thread.
+        struct PercentileSearchVals
+        {
+            unsigned long long below;
+            std::vector<unsigned long long> bins;
+            std::vector<double> vals;
+            std::map<double, unsigned long long> valCounts;
+        };
+        
+        bool active = true;
+        while(active)
+        {
+            active = false;
+            std::vector<unsigned int> passBands;
+            std::vector<size_t> passIdxs;
+            for(size_t i = 0; i < bands.size(); ++i)
+            {
+                if(!searches[i].done)
+                {
+                    searches[i].collect = searches[i].countVals || (searches[i].inCount <= RSGIS_HIST_MAX_CANDIDATES);
+                    passBands.push_back(bands[i]);
+                    passIdxs.push_back(i);
+                }
+            }
+            if(passBands.empty())
+            {
+                break;
+            }
+            
+            std::vector< std::vector<PercentileSearchVals> > threadVals(this->numThreads, std::vector<PercentileSearchVals>(passBands.size()));
+            for(unsigned int t = 0; t < this->numThreads; ++t)
+            {
+                for(size_t b = 0; b < passBands.size(); ++b)
+                {
+                    threadVals[t][b].below = 0;
+                    if(!searches[passIdxs[b]].collect)
+                    {
+                        threadVals[t][b].bins.assign(RSGIS_HIST_REFINE_BINS, 0);
+                    }
+                }
+            }
+            
+            this->scanBands(dataset, passBands, [&](unsigned int threadIdx, unsigned int bandIdx, const double *vals, size_t nVals)
+            {
+                const PercentileSearch *search = &searches[passIdxs[bandIdx]];
+                PercentileSearchVals *searchVals = &threadVals[threadIdx][bandIdx];
+                double binWidth = (search->hi - search->lo) / RSGIS_HIST_REFINE_BINS;
+                for(size_t i = 0; i < nVals; ++i)
+                {
+                    if(std::isnan(vals[i]) || (noDataDefined && (vals[i] == noDataVal)) || (vals[i] > search->hi))
+                    {
+                        continue;
+                    }
+                    if(vals[i] < search->lo)
+                    {
+                        ++searchVals->below;
+                    }
+                    else if(search->countVals)
+                    {
+                        ++searchVals->valCounts[vals[i]];
+                    }
+                    else if(search->collect)
+                    {
+                        searchVals->vals.push_back(vals[i]);
+                    }
+                    else
+                    {
+                        double idx = std::floor((vals[i] - search->lo) / binWidth);
+                        ++searchVals->bins[std::min((size_t)idx, (size_t)(RSGIS_HIST_REFINE_BINS-1))];
+                    }
+                }
+            });
+            
+            for(size_t b = 0; b < passBands.size(); ++b)
+            {
+                PercentileSearch *search = &searches[passIdxs[b]];
+                unsigned long long below = 0;
+                for(unsigned int t = 0; t < this->numThreads; ++t)
+                {
+                    below += threadVals[t][b].below;
+                }
+                if((search->ranks[0] < below))
+                {
+                    throw RSGISImageException("The percentile is not within the range of values searched.");
+                }
+                
+                if(search->countVals)
+                {
+                    std::map<double, unsigned long long> valCounts;
+                    for(unsigned int t = 0; t < this->numThreads; ++t)
+                    {
+                        for(std::map<double, unsigned long long>::iterator iterVal = threadVals[t][b].valCounts.begin(); iterVal != threadVals[t][b].valCounts.end(); ++iterVal)
+                        {
+                            valCounts[iterVal->first] += iterVal->second;
+                        }
+                    }
+                    for(unsigned int r = 0; r < 2; ++r)
+                    {
+                        unsigned long long cumCount = below;
+                        std::map<double, unsigned long long>::iterator iterVal = valCounts.begin();
+                        for(; iterVal != valCounts.end(); ++iterVal)
+                        {
+                            cumCount += iterVal->second;
+                            if(cumCount > search->ranks[r])
+                            {
+                                break;
+                            }
+                        }
+                        if(iterVal == valCounts.end())
+                        {
+                            throw RSGISImageException("The percentile is not within the range of values searched.");
+                        }
+                        search->rankVals[r] = iterVal->first;
+                    }
+                    search->done = true;
+                }
+                else if(search->collect)
+                {
+                    std::vector<double> vals;
+                    for(unsigned int t = 0; t < this->numThreads; ++t)
+                    {
+                        vals.insert(vals.end(), threadVals[t][b].vals.begin(), threadVals[t][b].vals.end());
+                        std::vector<double>().swap(threadVals[t][b].vals);
+                    }
+                    if((search->ranks[1] - below) >= vals.size())
+                    {
+                        throw RSGISImageException("The percentile is not within the range of values searched.");
+                    }
+                    for(unsigned int r = 0; r < 2; ++r)
+                    {
+                        std::nth_element(vals.begin(), vals.begin() + (search->ranks[r] - below), vals.end());
+                        search->rankVals[r] = vals[search->ranks[r] - below];
+                    }
+                    search->done = true;
+                }
+                else
+                {
+                    std::vector<unsigned long long> bins(RSGIS_HIST_REFINE_BINS, 0);
+                    for(unsigned int t = 0; t < this->numThreads; ++t)
+                    {
+                        for(size_t j = 0; j < bins.size(); ++j)
+                        {
+                            bins[j] += threadVals[t][b].bins[j];
+                        }
+                    }
+                    size_t rankBins[2] = {0, 0};
+                    for(unsigned int r = 0; r < 2; ++r)
+                    {
+                        unsigned long long cumCount = below;
+                        size_t j = 0;
+                        for(; j < bins.size(); ++j)
+                        {
+                            cumCount += bins[j];
+                            if(cumCount > search->ranks[r])
+                            {
+                                break;
+                            }
+                        }
+                        if(j == bins.size())
+                        {
+                            throw RSGISImageException("The percentile is not within the range of values searched.");
+                        }
+                        rankBins[r] = j;
+                    }
+                    
+                    // Keep a bin either side so values on the edges of the bins are not lost to rounding.
+                    size_t startBin = (rankBins[0] > 0)?(rankBins[0]-1):0;
+                    size_t endBin = std::min(rankBins[1] + 2, (size_t)RSGIS_HIST_REFINE_BINS);
+                    double binWidth = (search->hi - search->lo) / RSGIS_HIST_REFINE_BINS;
+                    double lo = search->lo + (startBin * binWidth);
+                    double hi = (endBin == RSGIS_HIST_REFINE_BINS)?search->hi:(search->lo + (endBin * binWidth));
+                    search->inCount = 0;
+                    for(size_t j = startBin; j < endBin; ++j)
+                    {
+                        search->inCount += bins[j];
+                    }
+                    lo = std::max(lo, search->lo);
+                    hi = std::min(hi, search->hi);
+                    if((lo >= hi) || ((lo == search->lo) && (hi == search->hi)))
+                    {
+                        // The bins are too narrow to split the range, which can only hold a few distinct values.
+                        search->countVals = true;
+                    }
+                    else
+                    {
+                        search->lo = lo;
+                        search->hi = hi;
+                    }
+                }
+                active = true;
+            }
+        }
+        
+        for(size_t i = 0; i < bands.size(); ++i)
+        {
+            outVals[i] = searches[i].rankVals[0];
+            if(searches[i].ranks[1] > searches[i].ranks[0])
+            {
+                outVals[i] = ((1 - searches[i].delta) * searches[i].rankVals[0]) + (searches[i].delta * searches[i].rankVals[1]);
+            }
+        }
+        return outVals;
+    }
+
+    RSGISImageHistogramEngine::~RSGISImageHistogramEngine()
+    {
+
+    }
+
+    void RSGISImageHistogramEngine::scanBands(GDALDataset *dataset, std::vector<unsigned int> bands, std::function<void(unsigned int, unsigned int, const double*, size_t)> func)
+    {
+        if(bands.empty())
+        {
+            return;
+        }
+        for(std::vector<unsigned int>::iterator iterBand = bands.begin(); iterBand != bands.end(); ++iterBand)
+        {
+            if(((*iterBand) == 0) || ((*iterBand) > (unsigned int)dataset->GetRasterCount()))
+            {
+                throw RSGISImageException("The band specified is not within the image.");
+            }
+        }
+
+        unsigned int width = dataset->GetRasterXSize();
+        unsigned int height = dataset->GetRasterYSize();
+        int blockXSize = 0;
+        int blockYSize = 0;
+        dataset->GetRasterBand(bands[0])->GetBlockSize(&blockXSize, &blockYSize);
+        unsigned int stripRows = std::min(std::max((unsigned int)blockYSize, RSGIS_HIST_STRIP_ROWS), std::max(height, (unsigned int)1));
+
+        std::vector<double> vals(((size_t)width) * stripRows);
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        for(unsigned int row = 0; row < height; row += stripRows)
+        {
+            unsigned int nRows = std::min(stripRows, height - row);
+            for(unsigned int b = 0; b < bands.size(); ++b)
+            {
+                // GDAL datasets are not thread safe so the strip is read before it is processed on the pool.
+                if(dataset->GetRasterBand(bands[b])->RasterIO(GF_Read, 0, row, width, nRows, vals.data(), width, nRows, GDT_Float64, 0, 0) != CE_None)
+                {
+                    throw RSGISImageException("Could not read the image band.");
+                }
+                threadPool.parallelFor(0, nRows, [&](unsigned int threadIdx, size_t startRow, size_t endRow)
+                {
+                    func(threadIdx, b, &vals[startRow * width], (endRow - startRow) * width);
+                });
+            }
+        }
+    }
+
+    void RSGISImageHistogramEngine::accumulateHistograms(GDALDataset *dataset, std::vector<unsigned int> bands, std::vector<RSGISBandHistogram> *hists, bool noDataDefined, double noDataVal)
+    {
+        for(std::vector<RSGISBandHistogram>::iterator iterHist = hists->begin(); iterHist != hists->end(); ++iterHist)
+        {
+            (*iterHist).nVals = 0;
+            (*iterHist).minVal = std::numeric_limits<double>::max();
+            (*iterHist).maxVal = std::numeric_limits<double>::lowest();
+        }
+        std::vector< std::vector<RSGISBandHistogram> > threadHists(this->numThreads, *hists);
+
+        this->scanBands(dataset, bands, [&](unsigned int threadIdx, unsigned int bandIdx, const double *vals, size_t nVals)
+        {
+            RSGISBandHistogram *hist = &threadHists[threadIdx][bandIdx];
+            double nBins = hist->bins.size();
+            double idx = 0;
+            for(size_t i = 0; i < nVals; ++i)
+            {
+                if(std::isnan(vals[i]) || (noDataDefined && (vals[i] == noDataVal)))
+                {
+                    continue;
+                }
+                ++hist->nVals;
+                if(vals[i] < hist->minVal)
+                {
+                    hist->minVal = vals[i];
+                }
+                if(vals[i] > hist->maxVal)
+                {
+                    hist->maxVal = vals[i];
+                }
+                idx = std::floor((vals[i] - hist->binMin) / hist->binWidth);
+                if((idx >= 0) && (idx < nBins))
+                {
+                    ++hist->bins[(size_t)idx];
+                }
+            }
+        });
+
+        for(size_t i = 0; i < hists->size(); ++i)
+        {
+            RSGISBandHistogram *hist = &(*hists)[i];
+            for(unsigned int t = 0; t < this->numThreads; ++t)
+            {
+                RSGISBandHistogram *threadHist = &threadHists[t][i];
+                hist->nVals += threadHist->nVals;
+                hist->minVal = std::min(hist->minVal, threadHist->minVal);
+                hist->maxVal = std::max(hist->maxVal, threadHist->maxVal);
+                for(size_t j = 0; j < hist->bins.size(); ++j)
+                {
+                    hist->bins[j] += threadHist->bins[j];
+                }
+            }
+            if(hist->nVals == 0)
+            {
+                hist->minVal = 0;
+                hist->maxVal = 0;
+            }
+        }
+    }
+
+    double RSGISImageHistogramEngine::getValueAtRank(RSGISBandHistogram *hist, unsigned long long rank)
+    {
+        unsigned long long cumCount = 0;
+        for(size_t i = 0; i < hist->bins.size(); ++i)
+        {
+            cumCount += hist->bins[i];
+            if(cumCount > rank)
+            {
+                return hist->binMin + (((double)i) * hist->binWidth);
+            }
+        }
+        throw RSGISImageException("The rank is not within the histogram.");
+    }
+
+}}
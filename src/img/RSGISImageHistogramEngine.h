@@ -0,0 +1,154 @@
+/*
+ *  RSGISImageHistogramEngine.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISImageHistogramEngine_H
+#define RSGISImageHistogramEngine_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <map>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISImageException.h"
+#include "common/RSGISThreadPool.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+
+    static const unsigned int RSGIS_HIST_STRIP_ROWS( 256 );
+    static const unsigned int RSGIS_HIST_SKETCH_K( 200 );
+    static const unsigned int RSGIS_HIST_REFINE_BINS( 65536 );
+    static const size_t RSGIS_HIST_MAX_CANDIDATES( 1048576 );
+
+    /**
+     * The histogram of an image band, where bin i counts the values v with
+     * binMin + (i * binWidth) <= v < binMin + ((i+1) * binWidth). The number of
+     * values (i.e., excluding the no data value) and their range are also
+     * recorded, including those values which are outside of the bins.
+     */
+    struct DllExport RSGISBandHistogram
+    {
+        double binMin;
+        double binWidth;
+        std::vector<unsigned long long> bins;
+        unsigned long long nVals;
+        double minVal;
+        double maxVal;
+    };
+
+    /**
+     * An approximate streaming quantile sketch (KLL) for the values of an image
+     * band, using a fixed amount of memory (set by k) for any number of values.
+     * The rank error of the quantiles is roughly 1.7/k of the number of values.
+     */
+    class DllExport RSGISQuantileSketch
+    {
+    public:
+        RSGISQuantileSketch(unsigned int k=RSGIS_HIST_SKETCH_K);
+        void add(double val);
+        void merge(const RSGISQuantileSketch &sketch);
+        /** Get the quantile (0 -- 1) of the values added to the sketch. */
+        double getQuantile(double quantile);
+        unsigned long long getN(){return this->n;};
+        ~RSGISQuantileSketch();
+    protected:
+        unsigned int getLevelCapacity(unsigned int level);
+        size_t getTotalCapacity();
+        void compress();
+        unsigned int k;
+        unsigned long long n;
+        double minVal;
+        double maxVal;
+        size_t numItems;
+        // Level h holds items with a weight of 2^h.
+        std::vector< std::vector<double> > levels;
+        // Alternates the items kept by the compactions so the sketch is deterministic without bias.
+        bool keepOdd;
+    };
+
+    /**
+     * Calculates histograms, percentiles and quantile sketches for a number of
+     * image bands in a single pass over the image. The image is read, in strips,
+     * on the calling thread and the values of each strip are accumulated on
+     * numThreads threads into thread local histograms (or sketches) which are
+     * merged once the image has been read.
+     */
+    class DllExport RSGISImageHistogramEngine
+    {
+    public:
+        /** If numThreads is 0 the number of hardware threads is used. */
+        RSGISImageHistogramEngine(unsigned int numThreads=1);
+        /** Are the values of the data type integers with a range small enough for a histogram with a bin per value (i.e., 8 and 16 bit integers). */
+        static bool hasExactIntBins(GDALDataType dataType);
+        /** Histograms with a bin per value for bands (starting at 1) with an integer data type (see hasExactIntBins). */
+        std::vector<RSGISBandHistogram> calcExactHistograms(GDALDataset *dataset, std::vector<unsigned int> bands, bool noDataDefined, double noDataVal);
+        /** Histograms with nBins bins of binWidth from binMin for bands (starting at 1), nBins can be 0 to only find the range of the values. */
+        std::vector<RSGISBandHistogram> calcHistograms(GDALDataset *dataset, std::vector<unsigned int> bands, double binMin, double binWidth, unsigned int nBins, bool noDataDefined, double noDataVal);
+        /** Quantile sketches for bands (starting at 1). */
+        std::vector<RSGISQuantileSketch> calcQuantileSketches(GDALDataset *dataset, std::vector<unsigned int> bands, bool noDataDefined, double noDataVal, unsigned int k=RSGIS_HIST_SKETCH_K);
+        /**
+         * The exact percentile (0 -- 1) of bands (starting at 1) of any data type, interpolated
+         * the same as gsl_stats_quantile_from_sorted_data, without holding the values of the
+         * band. The 8 and 16 bit integer bands are found from a bin per value in a single pass.
+         * Otherwise, after a pass for the range of the values, each pass histograms the values
+         * within the range containing the ranks of the percentile in RSGIS_HIST_REFINE_BINS bins
+         * and narrows the range to the bins containing those ranks, until the range holds at most
+         * RSGIS_HIST_MAX_CANDIDATES values, which are read and sorted. All the bands are refined
+         * together so each pass reads the image once.
+         */
+        std::vector<double> calcExactPercentiles(GDALDataset *dataset, std::vector<unsigned int> bands, double percentile, bool noDataDefined, double noDataVal);
+        /**
+         * Get the percentile (0 -- 1) from a histogram taking each value as its
+         * bin's lower edge, so it is exact for a histogram from calcExactHistograms.
+         * The values are interpolated the same as gsl_stats_quantile_from_sorted_data.
+         */
+        static double getPercentile(RSGISBandHistogram *hist, double percentile);
+        ~RSGISImageHistogramEngine();
+    protected:
+        /** Read the bands, in strips, calling func(threadIdx, bandIdx, vals, nVals) on the pool for the values of each band. */
+        void scanBands(GDALDataset *dataset, std::vector<unsigned int> bands, std::function<void(unsigned int, unsigned int, const double*, size_t)> func);
+        void accumulateHistograms(GDALDataset *dataset, std::vector<unsigned int> bands, std::vector<RSGISBandHistogram> *hists, bool noDataDefined, double noDataVal);
+        static double getValueAtRank(RSGISBandHistogram *hist, unsigned long long rank);
+        unsigned int numThreads;
+    };
+
+}}
+
+#endif
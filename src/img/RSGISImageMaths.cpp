@@ -145,7 +145,29 @@ namespace rsgis{namespace img{
         }
 	}
 	
-    
+    bool RSGISAllBandsEqualTo::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        if(!(numOutBands > 0))
+        {
+            throw RSGISImageCalcException("The number of output image bands must great or equal to 1.");
+        }
+        
+        double *outBand = output[0];
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            outBand[p] = outTrueVal;
+        }
+        
+        for(int i = 0; i < numBands; ++i)
+        {
+            const float *inBand = bands[i];
+            for(size_t p = 0; p < nPxls; ++p)
+            {
+                outBand[p] = (inBand[p] != value)?outFalseVal:outBand[p];
+            }
+        }
+        return true;
+    }
 	
 	RSGISAllBandsEqualTo::~RSGISAllBandsEqualTo()
 	{
@@ -80,6 +80,7 @@ namespace rsgis{namespace img{
 	public: 
 		RSGISAllBandsEqualTo(int numberOutBands, float value, float outTrueVal, float outFalseVal);
 		void calcImageValue(float *bandValues, int numBands, double *output);
+        bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
 		~RSGISAllBandsEqualTo();
 	private:
 		float value;
@@ -29,37 +29,44 @@
  */
 
 #include "RSGISImageMosaic.h"
+#include "common/RSGISGDALInit.h"
 
 namespace rsgis{namespace img{
 
-	RSGISImageMosaic::RSGISImageMosaic()
+	RSGISImageMosaic::RSGISImageMosaic(): numThreads(1), maxOpenDatasets(32), refImage(""), refFormat("KEA")
 	{
 
 	}
 
+    void RSGISImageMosaic::setNumThreads(unsigned int numThreads)
+    {
+        this->numThreads = numThreads;
+    }
+
+    void RSGISImageMosaic::setMaxOpenDatasets(unsigned int maxOpenDatasets)
+    {
+        this->maxOpenDatasets = maxOpenDatasets;
+    }
+
+    void RSGISImageMosaic::setOutputRefImage(std::string refImage, std::string refFormat)
+    {
+        this->refImage = refImage;
+        this->refFormat = refFormat;
+    }
+
 	void RSGISImageMosaic::mosaic(std::string *inputImages, int numDS, std::string outputImage, float background, bool projFromImage, std::string proj, std::string format, GDALDataType imgDataType)
 	{
 		RSGISImageUtils imgUtils;
         rsgis::math::RSGISMathsUtils mathsUtils;
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *dataset = NULL;
         GDALRasterBand *imgBand = NULL;
 		int width;
 		int height;
 		double *transformation = new double[6];
-		double *imgTransform = new double[6];
 		int numberBands = 0;
-		int tileXSize = 0;
-		int tileYSize = 0;
-		double xDiff = 0;
-		double yDiff = 0;
-		int xStart = 0;
-		int yStart = 0;
 		std::string projection = proj;
 		GDALDataset *outputDataset = NULL;
-		GDALRasterBand **inputRasterBands = NULL;
-		GDALRasterBand **outputRasterBands = NULL;
-		float **inputData = NULL;
 
         std::vector<std::string> bandnames;
 
@@ -105,148 +112,31 @@ namespace rsgis{namespace img{
 
 			outputDataset = imgUtils.createBlankImage(outputImage, transformation, width, height, numberBands, projection, background, bandnames, format, imgDataType);
 
-			// COPY IMAGE DATA INTO THE BLANK IMAGE
-
-            //Get Image Output Bands
-            outputRasterBands = new GDALRasterBand*[numberBands];
-            for(int i = 0; i < numberBands; i++)
-            {
-                outputRasterBands[i] = outputDataset->GetRasterBand(i+1);
-            }
-
-            int xBlockSize = 0;
-            int yBlockSize = 0;
-            outputRasterBands[0]->GetBlockSize (&xBlockSize, &yBlockSize);
-
-			std::cout << "Started (total " << numDS << ") ." << std::flush;
-
-            for(int ds = 0; ds < numDS; ds++)
-			{
-				std::cout << "." << ds+1 << "." << std::flush;
-
-                dataset = (GDALDataset *) GDALOpenShared(inputImages[ds].c_str(), GA_ReadOnly);
-                if(dataset == NULL)
-                {
-                    std::string message = std::string("Could not open image ") + inputImages[ds];
-                    throw RSGISImageException(message.c_str());
-                }
-
-                inputRasterBands = new GDALRasterBand*[numberBands];
-                for(int i = 0; i < numberBands; i++)
-                {
-                    inputRasterBands[i] = dataset->GetRasterBand(i+1);
-                }
-
-				dataset->GetGeoTransform(imgTransform);
-				tileXSize = dataset->GetRasterXSize();
-				tileYSize = dataset->GetRasterYSize();
-
-				xDiff = imgTransform[0] - transformation[0];
-				yDiff = transformation[3] - imgTransform[3];
-
-				xStart = floor((xDiff/transformation[1])+0.5);
-				yStart = floor((yDiff/transformation[1])+0.5);
-
-                // Allocate memory
-                inputData = new float*[numberBands];
-                for(int i = 0; i < numberBands; i++)
-                {
-                    inputData[i] = (float *) CPLMalloc(sizeof(float)*(tileXSize*yBlockSize));
-                }
-
-                int nYBlocks = tileYSize / yBlockSize;
-                int remainRows = tileYSize - (nYBlocks * yBlockSize);
-                int rowOffset = 0;
-
-                for(int i = 0; i < nYBlocks; i++)
-                {
-                    for(int n = 0; n < numberBands; n++)
-                    {
-                        rowOffset = yBlockSize * i;
-                        inputRasterBands[n]->RasterIO(GF_Read, 0, rowOffset, tileXSize, yBlockSize, inputData[n], tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                        outputRasterBands[n]->RasterIO(GF_Write, xStart, (yStart + rowOffset), tileXSize, yBlockSize, inputData[n], tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                    }
-
-                }
-
-                if(remainRows > 0)
-                {
-                    for(int n = 0; n < numberBands; n++)
-                    {
-                        rowOffset = yBlockSize * nYBlocks;
-                        inputRasterBands[n]->RasterIO(GF_Read, 0, rowOffset, tileXSize, remainRows, inputData[n], tileXSize, remainRows, GDT_Float32, 0, 0);
-                        outputRasterBands[n]->RasterIO(GF_Write, xStart, (yStart + rowOffset), tileXSize, remainRows, inputData[n], tileXSize, remainRows, GDT_Float32, 0, 0);
-                    }
-                }
-
-                // Tidy up
-                if(inputData != NULL)
-                {
-                    for(int i = 0; i < numberBands; i++)
-                    {
-                        if(inputData[i] != NULL)
-                        {
-                            delete[] inputData[i];
-                        }
-                    }
-                    delete[] inputData;
-                }
-                if(inputRasterBands != NULL)
-                {
-                    delete[] inputRasterBands;
-                }
-
-                GDALClose(dataset);
-			}
-			std::cout << ".complete\n";
-
+			// Copy the image data into the blank image, visiting each block of the output once.
+			std::cout << "Started (total " << numDS << ")\n";
+            RSGISBlockMosaic blockMosaic;
+            blockMosaic.setNumThreads(this->numThreads);
+            blockMosaic.setMaxOpenDatasets(this->maxOpenDatasets);
+            blockMosaic.mosaic(inputImages, numDS, outputDataset, background);
+			std::cout << "Complete\n";
 		}
 		catch(RSGISImageBandException &e)
 		{
-            if(inputData != NULL)
-            {
-                for(int i = 0; i < numberBands; i++)
-                {
-                    if(inputData[i] != NULL)
-                    {
-                        delete[] inputData[i];
-                    }
-                }
-                delete[] inputData;
-            }
-            if(inputRasterBands != NULL)
+            if(outputDataset != NULL)
             {
-                delete[] inputRasterBands;
-            }
-            if(outputRasterBands != NULL)
-            {
-                delete[] outputRasterBands;
+                GDALClose(outputDataset);
             }
 			if(transformation != NULL)
 			{
 				delete[] transformation;
 			}
-			if(imgTransform != NULL)
-			{
-				delete[] imgTransform;
-			}
 			throw e;
 		}
 
-        // Tidy
-        if(outputRasterBands != NULL)
-        {
-            delete[] outputRasterBands;
-        }
-
 		if(transformation != NULL)
 		{
 			delete[] transformation;
 		}
-		if(imgTransform != NULL)
-		{
-			delete[] imgTransform;
-		}
 		GDALClose(outputDataset);
 	}
 
@@ -255,27 +145,16 @@ namespace rsgis{namespace img{
 		RSGISImageUtils imgUtils;
 		rsgis::math::RSGISMathsUtils mathsUtils;
 
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *dataset = NULL;
         GDALRasterBand *imgBand = NULL;
 		int width;
 		int height;
 		double *transformation = new double[6];
-		double *imgTransform = new double[6];
 		int numberBands = 0;
-		int tileXSize = 0;
-		int tileYSize = 0;
-		double xDiff = 0;
-		double yDiff = 0;
-		int xStart = 0;
-		int yStart = 0;
 		std::string projection = proj;
 		GDALDataset *outputDataset = NULL;
-		GDALRasterBand **inputRasterBands = NULL;
-		GDALRasterBand **outputRasterBands = NULL;
-		float **inputData = NULL;
-		float **outputData = NULL;
-		bool pixelsChanged;
+		GDALDataset *refDataset = NULL;
 
         std::vector<std::string> bandnames;
 
@@ -321,334 +200,62 @@ namespace rsgis{namespace img{
 
 			outputDataset = imgUtils.createBlankImage(outputImage, transformation, width, height, numberBands, projection, background, bandnames, format, imgDataType);
 
-			// COPY IMAGE DATA INTO THE BLANK IMAGE
-
-            //Get Image Output Bands
-            outputRasterBands = new GDALRasterBand*[numberBands];
-            for(int i = 0; i < numberBands; i++)
+			// Copy the image data into the blank image, visiting each block of the output once.
+			std::cout << "Started (total " << numDS << ")\n";
+            RSGISBlockMosaic blockMosaic;
+            blockMosaic.setSkipValue(skipVal, skipBand);
+            blockMosaic.setOverlapBehaviour(overlapBehaviour);
+            blockMosaic.setNumThreads(this->numThreads);
+            blockMosaic.setMaxOpenDatasets(this->maxOpenDatasets);
+            if(this->refImage != "")
             {
-                outputRasterBands[i] = outputDataset->GetRasterBand(i+1);
+                refDataset = imgUtils.createBlankImage(this->refImage, transformation, width, height, 1, projection, 0, this->refFormat, GDT_UInt32);
+                blockMosaic.setRefBand(refDataset->GetRasterBand(1), 1);
             }
-
-            int xBlockSize = 0;
-            int yBlockSize = 0;
-            outputRasterBands[0]->GetBlockSize (&xBlockSize, &yBlockSize);
-
-			std::cout << "Started (total " << numDS << ") ." << std::flush;
-
-            for(int ds = 0; ds < numDS; ds++)
-			{
-				std::cout << "." << ds+1 << "." << std::flush;
-
-                dataset = (GDALDataset *) GDALOpenShared(inputImages[ds].c_str(), GA_ReadOnly);
-                if(dataset == NULL)
-                {
-                    std::string message = std::string("Could not open image ") + inputImages[ds];
-                    throw RSGISImageException(message.c_str());
-                }
-
-                inputRasterBands = new GDALRasterBand*[numberBands];
-                for(int i = 0; i < numberBands; i++)
-                {
-                    inputRasterBands[i] = dataset->GetRasterBand(i+1);
-                }
-
-				dataset->GetGeoTransform(imgTransform);
-				tileXSize = dataset->GetRasterXSize();
-				tileYSize = dataset->GetRasterYSize();
-
-				xDiff = imgTransform[0] - transformation[0];
-				yDiff = transformation[3] - imgTransform[3];
-
-				xStart = floor((xDiff/transformation[1])+0.5);
-				yStart = floor((yDiff/transformation[1])+0.5);
-
-                // Allocate memory
-                inputData = new float*[numberBands];
-                outputData = new float*[numberBands];
-                for(int i = 0; i < numberBands; i++)
-                {
-                    inputData[i] = (float *) CPLMalloc(sizeof(float)*(tileXSize*yBlockSize));
-                    outputData[i] = (float *) CPLMalloc(sizeof(float)*(tileXSize*yBlockSize));
-                }
-
-                int nYBlocks = tileYSize / yBlockSize;
-                int remainRows = tileYSize - (nYBlocks * yBlockSize);
-                int rowOffset = 0;
-
-                for(int i = 0; i < nYBlocks; i++)
-                {
-                    // Read input and output data
-                    for(int n = 0; n < numberBands; n++)
-                    {
-                        rowOffset = yBlockSize * i;
-                        // Read input data
-                        inputRasterBands[n]->RasterIO(GF_Read, 0, rowOffset, tileXSize, yBlockSize, inputData[n], tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                        // Read output data
-                        outputRasterBands[n]->RasterIO(GF_Read, xStart, (yStart + rowOffset), tileXSize, yBlockSize, outputData[n], tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                    }
-
-                    pixelsChanged = false; // Keep track if there are changes that need writing out.
-
-                    for(int m = 0; m < yBlockSize; ++m)
-                    {
-                        for(int j = 0; j < tileXSize; j++)
-                        {
-                            // Check for skip value
-                            if(inputData[skipBand][(m*tileXSize)+j] != skipVal)
-                            {
-                                // Check if behaviour is defined for overlap and not the first image
-                                if( (overlapBehaviour > 0) && (ds > 0) )
-                                {
-                                    // Check if pixel is background value (no data has been written yet)
-                                    if( outputData[skipBand][(m*tileXSize)+j] == background )
-                                    {
-                                        for(int n = 0; n < numberBands; n++)
-                                        {
-                                            outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                        }
-                                        pixelsChanged = true;
-                                    }
-                                    // If data has been written - check if new value is less (min overlap behaviour)
-                                    else if( (overlapBehaviour == 1) &&  (inputData[skipBand][(m*tileXSize)+j] < outputData[skipBand][(m*tileXSize)+j]) )
-                                    {
-                                        for(int n = 0; n < numberBands; n++)
-                                        {
-                                            outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                        }
-                                        pixelsChanged = true;
-                                    }
-                                    // If data has been written - check if new value is greater (max overlap behaviour)
-                                    else if( (overlapBehaviour == 2) &&  (inputData[skipBand][(m*tileXSize)+j] > outputData[skipBand][(m*tileXSize)+j]) )
-                                    {
-                                        for(int n = 0; n < numberBands; n++)
-                                        {
-                                            outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                        }
-                                        pixelsChanged = true;
-                                    }
-                                }
-                                // If no overlap behaviour defined, write out,
-                                else
-                                {
-                                    for(int n = 0; n < numberBands; n++)
-                                    {
-                                        outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                    }
-                                    pixelsChanged = true;
-                                }
-
-
-                            }
-                        }
-                    }
-
-                    // Write out data to mosaic
-                    if(pixelsChanged)
-                    {
-                        for(int n = 0; n < numberBands; n++)
-                        {
-                            outputRasterBands[n]->RasterIO(GF_Write, xStart, (yStart + rowOffset), tileXSize, yBlockSize, outputData[n], tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                        }
-                    }
-
-                }
-
-                if(remainRows > 0)
-                {
-                    for(int n = 0; n < numberBands; n++)
-                    {
-                        rowOffset = yBlockSize * nYBlocks;
-                        // Read input data
-                        inputRasterBands[n]->RasterIO(GF_Read, 0, rowOffset, tileXSize, remainRows, inputData[n], tileXSize, remainRows, GDT_Float32, 0, 0);
-                        // Read output data
-                        outputRasterBands[n]->RasterIO(GF_Read, xStart, (yStart + rowOffset), tileXSize, remainRows, outputData[n], tileXSize, remainRows, GDT_Float32, 0, 0);
-                    }
-
-                    pixelsChanged = false; // Keep track if there are changes that need writing out.
-
-                    for(int m = 0; m < remainRows; ++m)
-                    {
-                        for(int j = 0; j < tileXSize; j++)
-                        {
-                            // Check for skip value
-                            if(inputData[skipBand][(m*tileXSize)+j] != skipVal)
-                            {
-                                // Check if behaviour is defined for overlap and not the first image
-                                if( (overlapBehaviour > 0) && (ds > 0) )
-                                {
-                                    // Check if pixel is background value (no data has been written yet)
-                                    if( outputData[skipBand][(m*tileXSize)+j] == background )
-                                    {
-                                        for(int n = 0; n < numberBands; n++)
-                                        {
-                                            outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                        }
-                                        pixelsChanged = true;
-                                    }
-                                    // If data has been written - check if new value is less (min overlap behaviour)
-                                    else if( (overlapBehaviour == 1) &&  (inputData[skipBand][(m*tileXSize)+j] < outputData[skipBand][(m*tileXSize)+j]) )
-                                    {
-                                        for(int n = 0; n < numberBands; n++)
-                                        {
-                                            outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                        }
-                                        pixelsChanged = true;
-                                    }
-                                    // If data has been written - check if new value is greater (max overlap behaviour)
-                                    else if( (overlapBehaviour == 2) &&  (inputData[skipBand][(m*tileXSize)+j] > outputData[skipBand][(m*tileXSize)+j]) )
-                                    {
-                                        for(int n = 0; n < numberBands; n++)
-                                        {
-                                            outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                        }
-                                        pixelsChanged = true;
-                                    }
-                                }
-                                // If no overlap behaviour defined, write out,
-                                else
-                                {
-                                    for(int n = 0; n < numberBands; n++)
-                                    {
-                                        outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                    }
-                                    pixelsChanged = true;
-                                }
-
-
-                            }
-                        }
-                    }
-
-                    // Write out data
-                    if(pixelsChanged)
-                    {
-                        for(int n = 0; n < numberBands; n++)
-                        {
-                            outputRasterBands[n]->RasterIO(GF_Write, xStart, (yStart + rowOffset), tileXSize, remainRows, outputData[n], tileXSize, remainRows, GDT_Float32, 0, 0);
-                        }
-                    }
-
-                }
-
-                // Tidy up
-                if(inputData != NULL)
-                {
-                    for(int i = 0; i < numberBands; i++)
-                    {
-                        if(inputData[i] != NULL)
-                        {
-                            delete[] inputData[i];
-                        }
-                    }
-                    delete[] inputData;
-                }
-                if(outputData != NULL)
-                {
-                    for(int i = 0; i < numberBands; i++)
-                    {
-                        if(outputData[i] != NULL)
-                        {
-                            delete[] outputData[i];
-                        }
-                    }
-                    delete[] outputData;
-                }
-                if(inputRasterBands != NULL)
-                {
-                    delete[] inputRasterBands;
-                }
-
-                GDALClose(dataset);
-			}
-			std::cout << ".complete\n";
-
+            blockMosaic.mosaic(inputImages, numDS, outputDataset, background);
+			std::cout << "Complete\n";
 		}
 		catch(RSGISImageBandException &e)
 		{
-            if(inputData != NULL)
+            if(outputDataset != NULL)
             {
-                for(int i = 0; i < numberBands; i++)
-                {
-                    if(inputData[i] != NULL)
-                    {
-                        delete[] inputData[i];
-                    }
-                }
-                delete[] inputData;
-            }
-            if(outputData != NULL)
-            {
-                for(int i = 0; i < numberBands; i++)
-                {
-                    if(outputData[i] != NULL)
-                    {
-                        delete[] outputData[i];
-                    }
-                }
-                delete[] outputData;
-            }
-            if(inputRasterBands != NULL)
-            {
-                delete[] inputRasterBands;
+                GDALClose(outputDataset);
             }
-            if(outputRasterBands != NULL)
+            if(refDataset != NULL)
             {
-                delete[] outputRasterBands;
+                GDALClose(refDataset);
             }
 			if(transformation != NULL)
 			{
 				delete[] transformation;
 			}
-			if(imgTransform != NULL)
-			{
-				delete[] imgTransform;
-			}
 			throw e;
 		}
 
-        // Tidy
-        if(outputRasterBands != NULL)
-        {
-            delete[] outputRasterBands;
-        }
-
 		if(transformation != NULL)
 		{
 			delete[] transformation;
 		}
-		if(imgTransform != NULL)
-		{
-			delete[] imgTransform;
-		}
 		GDALClose(outputDataset);
+        if(refDataset != NULL)
+        {
+            GDALClose(refDataset);
+        }
 	}
 
 	void RSGISImageMosaic::mosaicSkipThresh(std::string *inputImages, int numDS, std::string outputImage, float background, float skipLowerThresh, float skipUpperThresh, bool projFromImage, std::string proj, unsigned int threshBand, unsigned int overlapBehaviour, std::string format, GDALDataType imgDataType)
 	{
 		RSGISImageUtils imgUtils;
         rsgis::math::RSGISMathsUtils mathsUtils;
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *dataset = NULL;
         GDALRasterBand *imgBand = NULL;
 		int width;
 		int height;
 		double *transformation = new double[6];
-		double *imgTransform = new double[6];
 		int numberBands = 0;
-		int tileXSize = 0;
-		int tileYSize = 0;
-		double xDiff = 0;
-		double yDiff = 0;
-		int xStart = 0;
-		int yStart = 0;
 		std::string projection = proj;
 		GDALDataset *outputDataset = NULL;
-		GDALRasterBand **inputRasterBands = NULL;
-		GDALRasterBand **outputRasterBands = NULL;
-		float **inputData = NULL;
-		float **outputData = NULL;
-		bool pixelsChanged;
 
         std::vector<std::string> bandnames;
 
@@ -694,306 +301,33 @@ namespace rsgis{namespace img{
 
 			outputDataset = imgUtils.createBlankImage(outputImage, transformation, width, height, numberBands, projection, background, bandnames, format, imgDataType);
 
-			// COPY IMAGE DATA INTO THE BLANK IMAGE
-
-            //Get Image Output Bands
-            outputRasterBands = new GDALRasterBand*[numberBands];
-            for(int i = 0; i < numberBands; i++)
-            {
-                outputRasterBands[i] = outputDataset->GetRasterBand(i+1);
-            }
-
-            int xBlockSize = 0;
-            int yBlockSize = 0;
-            outputRasterBands[0]->GetBlockSize (&xBlockSize, &yBlockSize);
-
-			std::cout << "Started (total " << numDS << ") ." << std::flush;
-
-            for(int ds = 0; ds < numDS; ds++)
-			{
-				std::cout << "." << ds+1 << "." << std::flush;
-
-                dataset = (GDALDataset *) GDALOpenShared(inputImages[ds].c_str(), GA_ReadOnly);
-                if(dataset == NULL)
-                {
-                    std::string message = std::string("Could not open image ") + inputImages[ds];
-                    throw RSGISImageException(message.c_str());
-                }
-
-                inputRasterBands = new GDALRasterBand*[numberBands];
-                for(int i = 0; i < numberBands; i++)
-                {
-                    inputRasterBands[i] = dataset->GetRasterBand(i+1);
-                }
-
-				dataset->GetGeoTransform(imgTransform);
-				tileXSize = dataset->GetRasterXSize();
-				tileYSize = dataset->GetRasterYSize();
-
-				xDiff = imgTransform[0] - transformation[0];
-				yDiff = transformation[3] - imgTransform[3];
-
-				xStart = floor((xDiff/transformation[1])+0.5);
-				yStart = floor((yDiff/transformation[1])+0.5);
-
-                // Allocate memory
-                inputData = new float*[numberBands];
-                outputData = new float*[numberBands];
-                for(int i = 0; i < numberBands; i++)
-                {
-                    inputData[i] = (float *) CPLMalloc(sizeof(float)*(tileXSize*yBlockSize));
-                    outputData[i] = (float *) CPLMalloc(sizeof(float)*(tileXSize*yBlockSize));
-                }
-
-                int nYBlocks = tileYSize / yBlockSize;
-                int remainRows = tileYSize - (nYBlocks * yBlockSize);
-                int rowOffset = 0;
-
-                for(int i = 0; i < nYBlocks; i++)
-                {
-                    // Read input and output data
-                    for(int n = 0; n < numberBands; n++)
-                    {
-                        rowOffset = yBlockSize * i;
-                        // Read input data
-                        inputRasterBands[n]->RasterIO(GF_Read, 0, rowOffset, tileXSize, yBlockSize, inputData[n], tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                        // Read output data
-                        outputRasterBands[n]->RasterIO(GF_Read, xStart, (yStart + rowOffset), tileXSize, yBlockSize, outputData[n], tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                    }
-
-                    pixelsChanged = false; // Keep track if there are changes that need writing out.
-
-                    for(int m = 0; m < yBlockSize; ++m)
-                    {
-                        for(int j = 0; j < tileXSize; j++)
-                        {
-                            // Check value is between upper and lower limits
-                            if((inputData[threshBand][(m*tileXSize)+j] > skipLowerThresh) && (inputData[threshBand][(m*tileXSize)+j] < skipUpperThresh))
-                            {
-                                // Check if behaviour is defined for overlap and not the first image
-                                if( (overlapBehaviour > 0) && (ds > 0) )
-                                {
-                                    // Check if pixel is background value (no data has been written yet)
-                                    if( outputData[threshBand][(m*tileXSize)+j] == background )
-                                    {
-                                        for(int n = 0; n < numberBands; n++)
-                                        {
-                                            outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                        }
-                                        pixelsChanged = true;
-                                    }
-                                    // If data has been written - check if new value is less (min overlap behaviour)
-                                    else if( (overlapBehaviour == 1) &&  (inputData[threshBand][(m*tileXSize)+j] < outputData[threshBand][(m*tileXSize)+j]) )
-                                    {
-                                        for(int n = 0; n < numberBands; n++)
-                                        {
-                                            outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                        }
-                                        pixelsChanged = true;
-                                    }
-                                    // If data has been written - check if new value is greater (max overlap behaviour)
-                                    else if( (overlapBehaviour == 2) &&  (inputData[threshBand][(m*tileXSize)+j] > outputData[threshBand][(m*tileXSize)+j]) )
-                                    {
-                                        for(int n = 0; n < numberBands; n++)
-                                        {
-                                            outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                        }
-                                        pixelsChanged = true;
-                                    }
-                                }
-                                // If no overlap behaviour defined, write out,
-                                else
-                                {
-                                    for(int n = 0; n < numberBands; n++)
-                                    {
-                                        outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                    }
-                                    pixelsChanged = true;
-                                }
-
-
-                            }
-                        }
-                    }
-
-                    // Write out data to mosaic
-                    if(pixelsChanged)
-                    {
-                        for(int n = 0; n < numberBands; n++)
-                        {
-                            outputRasterBands[n]->RasterIO(GF_Write, xStart, (yStart + rowOffset), tileXSize, yBlockSize, outputData[n], tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                        }
-                    }
-
-                }
-
-                if(remainRows > 0)
-                {
-                    for(int n = 0; n < numberBands; n++)
-                    {
-                        rowOffset = yBlockSize * nYBlocks;
-                        // Read input data
-                        inputRasterBands[n]->RasterIO(GF_Read, 0, rowOffset, tileXSize, remainRows, inputData[n], tileXSize, remainRows, GDT_Float32, 0, 0);
-                        // Read output data
-                        outputRasterBands[n]->RasterIO(GF_Read, xStart, (yStart + rowOffset), tileXSize, remainRows, outputData[n], tileXSize, remainRows, GDT_Float32, 0, 0);
-                    }
-
-                    pixelsChanged = false; // Keep track if there are changes that need writing out.
-
-                    for(int m = 0; m < remainRows; ++m)
-                    {
-                        for(int j = 0; j < tileXSize; j++)
-                        {
-                            // Check value is between upper and lower limits
-                            if((inputData[threshBand][(m*tileXSize)+j] > skipLowerThresh) && (inputData[threshBand][(m*tileXSize)+j] < skipUpperThresh))
-                            {
-                                // Check if behaviour is defined for overlap and not the first image
-                                if( (overlapBehaviour > 0) && (ds > 0) )
-                                {
-                                    // Check if pixel is background value (no data has been written yet)
-                                    if( outputData[threshBand][(m*tileXSize)+j] == background )
-                                    {
-                                        for(int n = 0; n < numberBands; n++)
-                                        {
-                                            outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                        }
-                                        pixelsChanged = true;
-                                    }
-                                    // If data has been written - check if new value is less (min overlap behaviour)
-                                    else if( (overlapBehaviour == 1) &&  (inputData[threshBand][(m*tileXSize)+j] < outputData[threshBand][(m*tileXSize)+j]) )
-                                    {
-                                        for(int n = 0; n < numberBands; n++)
-                                        {
-                                            outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                        }
-                                        pixelsChanged = true;
-                                    }
-                                    // If data has been written - check if new value is greater (max overlap behaviour)
-                                    else if( (overlapBehaviour == 2) &&  (inputData[threshBand][(m*tileXSize)+j] > outputData[threshBand][(m*tileXSize)+j]) )
-                                    {
-                                        for(int n = 0; n < numberBands; n++)
-                                        {
-                                            outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                        }
-                                        pixelsChanged = true;
-                                    }
-                                }
-                                // If no overlap behaviour defined, write out,
-                                else
-                                {
-                                    for(int n = 0; n < numberBands; n++)
-                                    {
-                                        outputData[n][(m*tileXSize)+j] = inputData[n][(m*tileXSize)+j];
-                                    }
-                                    pixelsChanged = true;
-                                }
-
-
-                            }
-                        }
-                    }
-
-                    // Write out data
-                    if(pixelsChanged)
-                    {
-                        for(int n = 0; n < numberBands; n++)
-                        {
-                            outputRasterBands[n]->RasterIO(GF_Write, xStart, (yStart + rowOffset), tileXSize, remainRows, outputData[n], tileXSize, remainRows, GDT_Float32, 0, 0);
-                        }
-                    }
-
-                }
-
-                // Tidy up
-                if(inputData != NULL)
-                {
-                    for(int i = 0; i < numberBands; i++)
-                    {
-                        if(inputData[i] != NULL)
-                        {
-                            delete[] inputData[i];
-                        }
-                    }
-                    delete[] inputData;
-                }
-                if(outputData != NULL)
-                {
-                    for(int i = 0; i < numberBands; i++)
-                    {
-                        if(outputData[i] != NULL)
-                        {
-                            delete[] outputData[i];
-                        }
-                    }
-                    delete[] outputData;
-                }
-                if(inputRasterBands != NULL)
-                {
-                    delete[] inputRasterBands;
-                }
-
-                GDALClose(dataset);
-			}
-			std::cout << ".complete\n";
-
+			// Copy the image data into the blank image, visiting each block of the output once.
+			std::cout << "Started (total " << numDS << ")\n";
+            RSGISBlockMosaic blockMosaic;
+            blockMosaic.setSkipThresholds(skipLowerThresh, skipUpperThresh, threshBand);
+            blockMosaic.setOverlapBehaviour(overlapBehaviour);
+            blockMosaic.setNumThreads(this->numThreads);
+            blockMosaic.setMaxOpenDatasets(this->maxOpenDatasets);
+            blockMosaic.mosaic(inputImages, numDS, outputDataset, background);
+			std::cout << "Complete\n";
 		}
 		catch(RSGISImageBandException &e)
 		{
-            if(inputData != NULL)
-            {
-                for(int i = 0; i < numberBands; i++)
-                {
-                    if(inputData[i] != NULL)
-                    {
-                        delete[] inputData[i];
-                    }
-                }
-                delete[] inputData;
-            }
-            if(outputData != NULL)
-            {
-                for(int i = 0; i < numberBands; i++)
-                {
-                    if(outputData[i] != NULL)
-                    {
-                        delete[] outputData[i];
-                    }
-                }
-                delete[] outputData;
-            }
-            if(inputRasterBands != NULL)
-            {
-                delete[] inputRasterBands;
-            }
-            if(outputRasterBands != NULL)
+            if(outputDataset != NULL)
             {
-                delete[] outputRasterBands;
+                GDALClose(outputDataset);
             }
 			if(transformation != NULL)
 			{
 				delete[] transformation;
 			}
-			if(imgTransform != NULL)
-			{
-				delete[] imgTransform;
-			}
 			throw e;
-		}
-
-        // Tidy
-        if(outputRasterBands != NULL)
-        {
-            delete[] outputRasterBands;
-        }
+		}
 
 		if(transformation != NULL)
 		{
 			delete[] transformation;
 		}
-		if(imgTransform != NULL)
-		{
-			delete[] imgTransform;
-		}
 		GDALClose(outputDataset);
 	}
 
@@ -1005,21 +339,10 @@ namespace rsgis{namespace img{
 		int height;
 
 		double *transformation = new double[6];
-		double *imgTransform = new double[6];
 		double *baseTransform = new double[6];
 		int numberBands = 0;
-		int tileXSize = 0;
-		int tileYSize = 0;
-		double xDiff = 0;
-		double yDiff = 0;
-		int xStart = 0;
-		int yStart = 0;
 		std::string projection;
 
-		GDALRasterBand *inputBand = NULL;
-		GDALRasterBand **outputBand = NULL;
-		float *imgData = NULL;
-
 		try
 		{
 			numberBands = baseImage->GetRasterCount();
@@ -1098,138 +421,24 @@ namespace rsgis{namespace img{
 				throw RSGISImageException("Images do not fit within the base image (Northings Min)");
 			}
 
-			height = baseImage->GetRasterYSize();
-			width = baseImage->GetRasterXSize();
-
-            outputBand = new GDALRasterBand*[numberBands];
-            for(int i = 0; i < numberBands; i++)
+			// Copy the image data into the base image, visiting each block of the base image once.
+			std::cout << "Started (total " << numDS << ")\n";
+            RSGISBlockMosaic blockMosaic;
+            if(bandsDefined)
             {
-                outputBand[i] = baseImage->GetRasterBand(i+1);
+                blockMosaic.setInputBands(bands);
             }
-
-            int xBlockSize = 0;
-            int yBlockSize = 0;
-            outputBand[0]->GetBlockSize (&xBlockSize, &yBlockSize);
-
-			std::cout << "Started (total " << numDS << ") ." << std::flush;
-
-			for(int i = 0; i < numDS; i++)
-			{
-				std::cout << "." << i << "." << std::flush;
-                dataset = (GDALDataset *) GDALOpenShared(inputImages[i].c_str(), GA_ReadOnly);
-                if(dataset == NULL)
-                {
-                    std::string message = std::string("Could not open image ") + inputImages[i];
-                    throw RSGISImageException(message.c_str());
-                }
-
-				dataset->GetGeoTransform(imgTransform);
-				tileXSize = dataset->GetRasterXSize();
-				tileYSize = dataset->GetRasterYSize();
-
-				xDiff = imgTransform[0] - baseTransform[0];
-				yDiff = baseTransform[3] - imgTransform[3];
-
-				xStart = floor((xDiff/baseTransform[1])+0.5);
-				yStart = floor((yDiff/baseTransform[1])+0.5);
-				imgData = (float *) CPLMalloc(sizeof(float)*(tileXSize*yBlockSize));
-
-                int nYBlocks = tileYSize / yBlockSize;
-                int remainRows = tileYSize - (nYBlocks * yBlockSize);
-                int rowOffset = 0;
-
-                for(int i = 0; i < nYBlocks; i++)
-                {
-                    rowOffset = yBlockSize * i;
-                    if(bandsDefined)
-                    {
-                        int nBand = 1;
-                        for(std::vector<int>::iterator iterBands = bands.begin(); iterBands != bands.end(); ++iterBands)
-                        {
-                            if(((*iterBands) <= 0) | ((*iterBands) > dataset->GetRasterCount()))
-                            {
-                                throw RSGISImageException("Band is not within the input dataset.");
-                            }
-                            inputBand = dataset->GetRasterBand(*iterBands);
-
-                            inputBand->RasterIO(GF_Read, 0, rowOffset, tileXSize, yBlockSize, imgData, tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                            outputBand[nBand-1]->RasterIO(GF_Write, xStart, (yStart + rowOffset), tileXSize, yBlockSize, imgData, tileXSize, yBlockSize, GDT_Float32, 0, 0);
-
-                            ++nBand;
-                        }
-                    }
-                    else
-                    {
-                        if(numberBands != dataset->GetRasterCount())
-                        {
-                            throw RSGISImageException("The number of bands in the input datasets and base dataset need to be the same.");
-                        }
-
-                        for(int n = 1; n <= numberBands; n++)
-                        {
-                            inputBand = dataset->GetRasterBand(n);
-
-                            inputBand->RasterIO(GF_Read, 0, rowOffset, tileXSize, yBlockSize, imgData, tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                            outputBand[n-1]->RasterIO(GF_Write, xStart, (yStart + rowOffset), tileXSize, yBlockSize, imgData, tileXSize, yBlockSize, GDT_Float32, 0, 0);
-
-                        }
-                    }
-                }
-                if(remainRows > 0)
-                {
-                    rowOffset = yBlockSize * nYBlocks;
-                    if(bandsDefined)
-                    {
-                        int nBand = 1;
-                        for(std::vector<int>::iterator iterBands = bands.begin(); iterBands != bands.end(); ++iterBands)
-                        {
-                            if(((*iterBands) <= 0) | ((*iterBands) > dataset->GetRasterCount()))
-                            {
-                                throw RSGISImageException("Band is not within the input dataset.");
-                            }
-                            inputBand = dataset->GetRasterBand(*iterBands);
-
-                            inputBand->RasterIO(GF_Read, 0, rowOffset, tileXSize, remainRows, imgData, tileXSize, remainRows, GDT_Float32, 0, 0);
-                            outputBand[nBand-1]->RasterIO(GF_Write, xStart, (yStart + rowOffset), tileXSize, remainRows, imgData, tileXSize, remainRows, GDT_Float32, 0, 0);
-
-                            ++nBand;
-                        }
-                    }
-                    else
-                    {
-                        if(numberBands != dataset->GetRasterCount())
-                        {
-                            throw RSGISImageException("The number of bands in the input datasets and base dataset need to be the same.");
-                        }
-
-                        for(int n = 1; n <= numberBands; n++)
-                        {
-                            inputBand = dataset->GetRasterBand(n);
-
-                            inputBand->RasterIO(GF_Read, 0, rowOffset, tileXSize, remainRows, imgData, tileXSize, remainRows, GDT_Float32, 0, 0);
-                            outputBand[n-1]->RasterIO(GF_Write, xStart, (yStart + rowOffset), tileXSize, remainRows, imgData, tileXSize, remainRows, GDT_Float32, 0, 0);
-                        }
-                    }
-                }
-				CPLFree(imgData);
-                GDALClose(dataset);
-			}
-			std::cout << ".complete\n";
+            blockMosaic.setNumThreads(this->numThreads);
+            blockMosaic.setMaxOpenDatasets(this->maxOpenDatasets);
+            blockMosaic.include(inputImages, numDS, baseImage);
+			std::cout << "Complete\n";
 		}
 		catch(RSGISImageBandException &e)
 		{
-			if(imgData != NULL)
-			{
-				delete imgData;
-			}
 			if(transformation != NULL)
 			{
 				delete[] transformation;
 			}
-			if(imgTransform != NULL)
-			{
-				delete[] imgTransform;
-			}
 			throw e;
 		}
 
@@ -1237,10 +446,6 @@ namespace rsgis{namespace img{
 		{
 			delete[] transformation;
 		}
-		if(imgTransform != NULL)
-		{
-			delete[] imgTransform;
-		}
 	}
 
     void RSGISImageMosaic::includeDatasetsSkipVals(GDALDataset *baseImage, std::string *inputImages, int numDS, std::vector<int> bands, bool bandsDefined, float skipVal)
@@ -1251,22 +456,10 @@ namespace rsgis{namespace img{
         int height;
         
         double *transformation = new double[6];
-        double *imgTransform = new double[6];
         double *baseTransform = new double[6];
         int numberBands = 0;
-        int tileXSize = 0;
-        int tileYSize = 0;
-        double xDiff = 0;
-        double yDiff = 0;
-        int xStart = 0;
-        int yStart = 0;
         std::string projection;
         
-        GDALRasterBand *inputBand = NULL;
-        GDALRasterBand **outputBand = NULL;
-        float *imgBaseData = NULL;
-        float *imgInData = NULL;
-        
         try
         {
             numberBands = baseImage->GetRasterCount();
@@ -1345,194 +538,25 @@ namespace rsgis{namespace img{
                 throw RSGISImageException("Images do not fit within the base image (Northings Min)");
             }
             
-            height = baseImage->GetRasterYSize();
-            width = baseImage->GetRasterXSize();
-            
-            outputBand = new GDALRasterBand*[numberBands];
-            for(int i = 0; i < numberBands; i++)
-            {
-                outputBand[i] = baseImage->GetRasterBand(i+1);
-            }
-            
-            int xBlockSize = 0;
-            int yBlockSize = 0;
-            outputBand[0]->GetBlockSize (&xBlockSize, &yBlockSize);
-                        
-            std::cout << "Started (total " << numDS << ") ." << std::flush;
-            
-            for(int i = 0; i < numDS; i++)
+            // Copy the image data into the base image, visiting each block of the base image once.
+            std::cout << "Started (total " << numDS << ")\n";
+            RSGISBlockMosaic blockMosaic;
+            if(bandsDefined)
             {
-                std::cout << "." << i << "." << std::flush;
-                dataset = (GDALDataset *) GDALOpenShared(inputImages[i].c_str(), GA_ReadOnly);
-                if(dataset == NULL)
-                {
-                    std::string message = std::string("Could not open image ") + inputImages[i];
-                    throw RSGISImageException(message.c_str());
-                }
-                
-                dataset->GetGeoTransform(imgTransform);
-                tileXSize = dataset->GetRasterXSize();
-                tileYSize = dataset->GetRasterYSize();
-                
-                xDiff = imgTransform[0] - baseTransform[0];
-                yDiff = baseTransform[3] - imgTransform[3];
-                
-                xStart = floor((xDiff/baseTransform[1])+0.5);
-                yStart = floor((yDiff/baseTransform[1])+0.5);
-                imgBaseData = (float *) CPLMalloc(sizeof(float)*(tileXSize*yBlockSize));
-                imgInData = (float *) CPLMalloc(sizeof(float)*(tileXSize*yBlockSize));
-                unsigned long numPxlsInBlock = tileXSize*yBlockSize;
-                
-                int nYBlocks = (tileYSize / yBlockSize);
-                int remainRows = tileYSize - (nYBlocks * yBlockSize);
-                int rowOffset = 0;
-                
-                for(int j = 0; j < nYBlocks; j++)
-                {
-                    rowOffset = yBlockSize * j;
-                    if(bandsDefined)
-                    {
-                        int nBand = 1;
-                        for(std::vector<int>::iterator iterBands = bands.begin(); iterBands != bands.end(); ++iterBands)
-                        {
-                            if(((*iterBands) <= 0) | ((*iterBands) > dataset->GetRasterCount()))
-                            {
-                                throw RSGISImageException("Band is not within the input dataset.");
-                            }
-                            inputBand = dataset->GetRasterBand(*iterBands);
-                            
-                            inputBand->RasterIO(GF_Read, 0, rowOffset, tileXSize, yBlockSize, imgInData, tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                            outputBand[nBand-1]->RasterIO(GF_Read, xStart, (yStart + rowOffset), tileXSize, yBlockSize, imgBaseData, tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                            
-                            for(unsigned long m = 0; m < numPxlsInBlock; ++m)
-                            {
-                                if(imgInData[m] == skipVal)
-                                {
-                                    imgInData[m] = imgBaseData[m];
-                                }
-                            }
-                            
-                            outputBand[nBand-1]->RasterIO(GF_Write, xStart, (yStart + rowOffset), tileXSize, yBlockSize, imgInData, tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                            
-                            ++nBand;
-                        }
-                    }
-                    else
-                    {
-                        if(numberBands != dataset->GetRasterCount())
-                        {
-                            throw RSGISImageException("The number of bands in the input datasets and base dataset need to be the same.");
-                        }
-                        
-                        for(int n = 1; n <= numberBands; n++)
-                        {
-                            inputBand = dataset->GetRasterBand(n);
-                            
-                            inputBand->RasterIO(GF_Read, 0, rowOffset, tileXSize, yBlockSize, imgInData, tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                            outputBand[n-1]->RasterIO(GF_Read, xStart, (yStart + rowOffset), tileXSize, yBlockSize, imgBaseData, tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                            
-                            for(unsigned long m = 0; m < numPxlsInBlock; ++m)
-                            {
-                                if(imgInData[m] == skipVal)
-                                {
-                                    imgInData[m] = imgBaseData[m];
-                                }
-                            }
-                            
-                            outputBand[n-1]->RasterIO(GF_Write, xStart, (yStart + rowOffset), tileXSize, yBlockSize, imgInData, tileXSize, yBlockSize, GDT_Float32, 0, 0);
-                            
-                        }
-                    }
-                }
-                
-                if(remainRows > 0)
-                {
-                    for(unsigned long m = 0; m < numPxlsInBlock; ++m)
-                    {
-                        imgInData[m] = 0;
-                        imgBaseData[m] = 0;
-                    }
-                 
-                    rowOffset = yBlockSize * nYBlocks;
-                    numPxlsInBlock = tileXSize * remainRows;
-                    if(bandsDefined)
-                    {
-                        int nBand = 1;
-                        for(std::vector<int>::iterator iterBands = bands.begin(); iterBands != bands.end(); ++iterBands)
-                        {
-                            if(((*iterBands) <= 0) | ((*iterBands) > dataset->GetRasterCount()))
-                            {
-                                throw RSGISImageException("Band is not within the input dataset.");
-                            }
-                            inputBand = dataset->GetRasterBand(*iterBands);
-                            
-                            inputBand->RasterIO(GF_Read, 0, rowOffset, tileXSize, remainRows, imgInData, tileXSize, remainRows, GDT_Float32, 0, 0);
-                            outputBand[nBand-1]->RasterIO(GF_Read, xStart, (yStart + rowOffset), tileXSize, remainRows, imgBaseData, tileXSize, remainRows, GDT_Float32, 0, 0);
-                            
-                            for(unsigned long m = 0; m < numPxlsInBlock; ++m)
-                            {
-                                if(imgInData[m] == skipVal)
-                                {
-                                    imgInData[m] = imgBaseData[m];
-                                }
-                            }
-
-                            outputBand[nBand-1]->RasterIO(GF_Write, xStart, (yStart + rowOffset), tileXSize, remainRows, imgInData, tileXSize, remainRows, GDT_Float32, 0, 0);
-                            
-                            ++nBand;
-                        }
-                    }
-                    else
-                    {
-                        if(numberBands != dataset->GetRasterCount())
-                        {
-                            throw RSGISImageException("The number of bands in the input datasets and base dataset need to be the same.");
-                        }
-                        
-                        for(int n = 1; n <= numberBands; n++)
-                        {
-                            inputBand = dataset->GetRasterBand(n);
-                            
-                            inputBand->RasterIO(GF_Read, 0, rowOffset, tileXSize, remainRows, imgInData, tileXSize, remainRows, GDT_Float32, 0, 0);
-                            outputBand[n-1]->RasterIO(GF_Read, xStart, (yStart + rowOffset), tileXSize, remainRows, imgBaseData, tileXSize, remainRows, GDT_Float32, 0, 0);
-
-                            for(unsigned long m = 0; m < numPxlsInBlock; ++m)
-                            {
-                                if(imgInData[m] == skipVal)
-                                {
-                                    imgInData[m] = imgBaseData[m];
-                                }
-                            }
-                            
-                            outputBand[n-1]->RasterIO(GF_Write, xStart, (yStart + rowOffset), tileXSize, remainRows, imgBaseData, tileXSize, remainRows, GDT_Float32, 0, 0);
-                        }
-                    }
-                }
-                
-                CPLFree(imgInData);
-                CPLFree(imgBaseData);
-                GDALClose(dataset);
+                blockMosaic.setInputBands(bands);
             }
-            std::cout << ".complete\n";
+            blockMosaic.setBandSkipValue(skipVal);
+            blockMosaic.setNumThreads(this->numThreads);
+            blockMosaic.setMaxOpenDatasets(this->maxOpenDatasets);
+            blockMosaic.include(inputImages, numDS, baseImage);
+            std::cout << "Complete\n";
         }
         catch(RSGISImageBandException &e)
         {
-            if(imgInData != NULL)
-            {
-                CPLFree(imgInData);
-            }
-            if(imgBaseData != NULL)
-            {
-                CPLFree(imgBaseData);
-            }
             if(transformation != NULL)
             {
                 delete[] transformation;
             }
-            if(imgTransform != NULL)
-            {
-                delete[] imgTransform;
-            }
             throw e;
         }
         
@@ -1540,10 +564,6 @@ namespace rsgis{namespace img{
         {
             delete[] transformation;
         }
-        if(imgTransform != NULL)
-        {
-            delete[] imgTransform;
-        }
     }
     
     void RSGISImageMosaic::includeDatasetsIgnoreOverlap(GDALDataset *baseImage, std::string *inputImages, int numDS, int numOverlapPxls)
@@ -1730,72 +750,46 @@ namespace rsgis{namespace img{
         }
     }
     
-    void RSGISImageMosaic::orderInImagesValidData(std::vector<std::string> images, std::vector<std::string> *orderedImages, float noDataValue)
+    void RSGISImageMosaic::orderInImagesValidData(std::vector<std::string> images, std::vector<std::string> *orderedImages, float noDataValue, RSGISValidDataEstimate estMode, float errTolerance)
     {
         try
         {
-            RSGISImageValidDataMetric *validPxlCountObj = new RSGISImageValidDataMetric();
-            RSGISCountValidPixels *calcImageValidPxlCount = new RSGISCountValidPixels(validPxlCountObj, noDataValue);
-			RSGISCalcImage calcImg = RSGISCalcImage(calcImageValidPxlCount, "", true);
-
-            std::list<RSGISImageValidDataMetric> validDataImageMetrics;
-            for(std::vector<std::string>::iterator iterImage = images.begin(); iterImage != images.end(); ++iterImage)
+            size_t nReqPxls = 0;
+            if(estMode != rsgis_validest_full)
             {
-                // Calculate Valid Pixel Count.
-                validPxlCountObj->totalNumPxls = 0;
-                validPxlCountObj->validPxlCount = 0;
-                validPxlCountObj->noDataPxlCount = 0;
-                calcImageValidPxlCount->resetValidPxlsObj();
-
-                std::cout << "Processing Image: " << (*iterImage) << std::endl;
-                GDALDataset *dataset = (GDALDataset *) GDALOpen((*iterImage).c_str(), GA_ReadOnly);
-                if(dataset == NULL)
-                {
-                    std::string message = std::string("Could not open image ") + (*iterImage);
-                    throw rsgis::RSGISImageException(message.c_str());
-                }
-
-                try
+                if((errTolerance <= 0) || (errTolerance >= 1))
                 {
-                    calcImg.calcImage(&dataset, 1);
-
-                    RSGISImageValidDataMetric imgDataMetric;
-                    imgDataMetric.imageFile = (*iterImage);
-                    imgDataMetric.totalNumPxls = validPxlCountObj->totalNumPxls;
-                    imgDataMetric.validPxlCount = validPxlCountObj->validPxlCount;
-                    imgDataMetric.noDataPxlCount = validPxlCountObj->noDataPxlCount;
-                    imgDataMetric.validPxlFunc = ((double)validPxlCountObj->validPxlCount) / ((double)validPxlCountObj->totalNumPxls);
-
-                    validDataImageMetrics.push_back(imgDataMetric);
-
-                    GDALClose(dataset);
-                }
-                catch (rsgis::RSGISException &e)
-                {
-                    delete validPxlCountObj;
-                    delete calcImageValidPxlCount;
-                    GDALClose(dataset);
-                    throw RSGISImageException(e.what());
+                    throw RSGISImageException("The error tolerance must be greater than 0 and less than 1.");
                 }
-                catch (std::exception &e)
+                // Worst case (p = 0.5) sample size for the 95% confidence interval of a proportion.
+                nReqPxls = (size_t)std::ceil((1.96 * 1.96 * 0.25) / (errTolerance * errTolerance));
+            }
+            
+            std::vector<RSGISImageValidDataMetric> validDataImageMetrics(images.size());
+            rsgis::RSGISThreadPool threadPool(this->numThreads);
+            std::cout << "Ordering " << images.size() << " images using " << threadPool.getNumThreads() << " threads.\n";
+            std::mutex pbarMutex;
+            size_t nImgsDone = 0;
+            rsgis_tqdm pbar;
+            threadPool.parallelFor(0, images.size(), [&](unsigned int t, size_t start, size_t end)
+            {
+                for(size_t i = start; i < end; ++i)
                 {
-                    delete validPxlCountObj;
-                    delete calcImageValidPxlCount;
-                    GDALClose(dataset);
-                    throw RSGISImageException(e.what());
+                    this->calcImageValidData(images.at(i), noDataValue, estMode, nReqPxls, &validDataImageMetrics.at(i));
+                    std::lock_guard<std::mutex> lock(pbarMutex);
+                    pbar.progress(++nImgsDone, images.size());
                 }
-            }
-
-            validDataImageMetrics.sort(compare_ImageValidPxlCounts);
+            });
+            pbar.finish();
+            
+            // Stable so images with the same proportion keep their input order.
+            std::stable_sort(validDataImageMetrics.begin(), validDataImageMetrics.end(), compare_ImageValidPxlCounts);
 
             orderedImages->clear();
-            for(std::list<RSGISImageValidDataMetric>::iterator iterImage = validDataImageMetrics.begin(); iterImage != validDataImageMetrics.end(); ++iterImage)
+            for(std::vector<RSGISImageValidDataMetric>::iterator iterImage = validDataImageMetrics.begin(); iterImage != validDataImageMetrics.end(); ++iterImage)
             {
                 orderedImages->push_back((*iterImage).imageFile);
             }
-
-            delete validPxlCountObj;
-            delete calcImageValidPxlCount;
         }
         catch (RSGISImageException &e)
         {
@@ -1810,6 +804,168 @@ namespace rsgis{namespace img{
             throw RSGISImageException(e.what());
         }
     }
+    
+    void RSGISImageMosaic::calcImageValidData(std::string image, float noDataValue, RSGISValidDataEstimate estMode, size_t nReqPxls, RSGISImageValidDataMetric *imgDataMetric)
+    {
+        imgDataMetric->imageFile = image;
+        imgDataMetric->totalNumPxls = 0;
+        imgDataMetric->validPxlCount = 0;
+        imgDataMetric->noDataPxlCount = 0;
+        imgDataMetric->validPxlFunc = 0;
+        
+        GDALDataset *dataset = (GDALDataset *) GDALOpen(image.c_str(), GA_ReadOnly);
+        if(dataset == NULL)
+        {
+            std::string message = std::string("Could not open image ") + image;
+            throw rsgis::RSGISImageException(message.c_str());
+        }
+        
+        try
+        {
+            int numBands = dataset->GetRasterCount();
+            int xSize = dataset->GetRasterXSize();
+            int ySize = dataset->GetRasterYSize();
+            std::vector<GDALRasterBand*> bands(numBands);
+            for(int n = 0; n < numBands; ++n)
+            {
+                bands[n] = dataset->GetRasterBand(n+1);
+            }
+            size_t nImgPxls = ((size_t)xSize) * ((size_t)ySize);
+            
+            bool calcDone = false;
+            if((estMode == rsgis_validest_full) || (nImgPxls <= nReqPxls))
+            {
+                this->countValidPxls(bands.data(), numBands, 0, 0, xSize, ySize, noDataValue, imgDataMetric);
+                calcDone = true;
+            }
+            else if(estMode == rsgis_validest_overview)
+            {
+                // Find the smallest overview level (present for all the bands) with enough pixels.
+                int numOverviews = (numBands > 0)?bands[0]->GetOverviewCount():0;
+                for(int n = 1; n < numBands; ++n)
+                {
+                    numOverviews = std::min(numOverviews, bands[n]->GetOverviewCount());
+                }
+                int ovIdx = -1;
+                size_t ovPxls = nImgPxls;
+                for(int i = 0; i < numOverviews; ++i)
+                {
+                    GDALRasterBand *ovBand = bands[0]->GetOverview(i);
+                    if(ovBand == NULL)
+                    {
+                        continue;
+                    }
+                    size_t nPxls = ((size_t)ovBand->GetXSize()) * ((size_t)ovBand->GetYSize());
+                    if((nPxls >= nReqPxls) && (nPxls < ovPxls))
+                    {
+                        ovIdx = i;
+                        ovPxls = nPxls;
+                    }
+                }
+                
+                if(ovIdx >= 0)
+                {
+                    std::vector<GDALRasterBand*> ovBands(numBands);
+                    bool ovOK = true;
+                    for(int n = 0; n < numBands; ++n)
+                    {
+                        ovBands[n] = bands[n]->GetOverview(ovIdx);
+                        if((ovBands[n] == NULL) || (ovBands[n]->GetXSize() != ovBands[0]->GetXSize()) || (ovBands[n]->GetYSize() != ovBands[0]->GetYSize()))
+                        {
+                            ovOK = false;
+                            break;
+                        }
+                    }
+                    if(ovOK)
+                    {
+                        this->countValidPxls(ovBands.data(), numBands, 0, 0, ovBands[0]->GetXSize(), ovBands[0]->GetYSize(), noDataValue, imgDataMetric);
+                        calcDone = true;
+                    }
+                }
+            }
+            
+            if(!calcDone)
+            {
+                // Sample a regular grid of blocks, with enough blocks for at least nReqPxls to be counted.
+                int blockXSize = 0;
+                int blockYSize = 0;
+                bands[0]->GetBlockSize(&blockXSize, &blockYSize);
+                blockXSize = std::max(std::min(blockXSize, xSize), 1);
+                blockYSize = std::max(std::min(blockYSize, ySize), 1);
+                size_t nXBlocks = (xSize + blockXSize - 1) / blockXSize;
+                size_t nYBlocks = (ySize + blockYSize - 1) / blockYSize;
+                // Pixels within a block are not independent so a minimum number of blocks are sampled across the image.
+                size_t nReqBlocks = (nReqPxls + (((size_t)blockXSize) * blockYSize) - 1) / (((size_t)blockXSize) * blockYSize);
+                nReqBlocks = std::max<size_t>(nReqBlocks, RSGIS_VALID_DATA_MIN_SAMPLE_BLOCKS);
+                double sampleFrac = std::min(((double)nReqBlocks) / ((double)(nXBlocks * nYBlocks)), 1.0);
+                size_t xStride = std::min(std::max<size_t>((size_t)std::floor(1.0 / std::sqrt(sampleFrac)), 1), nXBlocks);
+                size_t nReqRows = (nReqBlocks + (nXBlocks / xStride) - 1) / (nXBlocks / xStride);
+                size_t yStride = std::max<size_t>(nYBlocks / std::max<size_t>(nReqRows, 1), 1);
+                
+                // Start half a stride in so the sampled blocks are centred on the image.
+                for(size_t by = (yStride-1)/2; by < nYBlocks; by += yStride)
+                {
+                    for(size_t bx = (xStride-1)/2; bx < nXBlocks; bx += xStride)
+                    {
+                        int xOff = bx * blockXSize;
+                        int yOff = by * blockYSize;
+                        this->countValidPxls(bands.data(), numBands, xOff, yOff, std::min(blockXSize, xSize - xOff), std::min(blockYSize, ySize - yOff), noDataValue, imgDataMetric);
+                    }
+                }
+            }
+            
+            if(imgDataMetric->totalNumPxls > 0)
+            {
+                imgDataMetric->validPxlFunc = ((double)imgDataMetric->validPxlCount) / ((double)imgDataMetric->totalNumPxls);
+            }
+            GDALClose(dataset);
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            GDALClose(dataset);
+            throw RSGISImageException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            GDALClose(dataset);
+            throw RSGISImageException(e.what());
+        }
+    }
+    
+    void RSGISImageMosaic::countValidPxls(GDALRasterBand **bands, int numBands, int xOff, int yOff, int xSize, int ySize, float noDataValue, RSGISImageValidDataMetric *imgDataMetric)
+    {
+        // Read the window a strip of rows at a time to limit the memory used.
+        int stripRows = std::max(std::min(ySize, (int)(1048576 / std::max(xSize, 1))), 1);
+        std::vector<float> bandData(((size_t)xSize) * stripRows);
+        std::vector<char> pxlValid(((size_t)xSize) * stripRows);
+        for(int row = 0; row < ySize; row += stripRows)
+        {
+            int nRows = std::min(stripRows, ySize - row);
+            size_t nPxls = ((size_t)xSize) * nRows;
+            std::fill(pxlValid.begin(), pxlValid.begin() + nPxls, 0);
+            for(int n = 0; n < numBands; ++n)
+            {
+                if(bands[n]->RasterIO(GF_Read, xOff, yOff + row, xSize, nRows, bandData.data(), xSize, nRows, GDT_Float32, 0, 0) != CE_None)
+                {
+                    throw RSGISImageException("Could not read the image data.");
+                }
+                // A pixel is valid if any of the bands are not no data.
+                for(size_t i = 0; i < nPxls; ++i)
+                {
+                    pxlValid[i] |= (bandData[i] != noDataValue);
+                }
+            }
+            
+            unsigned int nValid = 0;
+            for(size_t i = 0; i < nPxls; ++i)
+            {
+                nValid += pxlValid[i];
+            }
+            imgDataMetric->validPxlCount += nValid;
+            imgDataMetric->noDataPxlCount += nPxls - nValid;
+            imgDataMetric->totalNumPxls += nPxls;
+        }
+    }
 
 	RSGISImageMosaic::~RSGISImageMosaic()
 	{
@@ -30,14 +30,20 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <mutex>
 
 #include "libkea/KEAImageIO.h"
 
 #include "common/rsgis-tqdm.h"
+#include "common/RSGISThreadPool.h"
 
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISImageUtils.h"
+#include "img/RSGISBlockMosaic.h"
 #include "img/RSGISCalcImage.h"
 
 // mark all exported classes/functions with DllExport to have
@@ -55,6 +61,9 @@
 
 namespace rsgis{namespace img{
     
+    /** The minimum number of blocks sampled when estimating the proportion of valid pixels from a block sample. */
+    static const unsigned int RSGIS_VALID_DATA_MIN_SAMPLE_BLOCKS( 64 );
+    
     struct DllExport RSGISImageValidDataMetric
     {
         std::string imageFile;
@@ -64,6 +73,20 @@ namespace rsgis{namespace img{
         double validPxlFunc;
     };
     
+    /**
+     * How the proportion of valid pixels is found when ordering images:
+     *  rsgis_validest_full - count every pixel at full resolution.
+     *  rsgis_validest_overview - count the pixels of the smallest overview with enough pixels
+     *                            for the error tolerance (the block sample is used if there is none).
+     *  rsgis_validest_sample - count the pixels of a regularly strided sample of image blocks.
+     */
+    enum RSGISValidDataEstimate
+    {
+        rsgis_validest_full = 0,
+        rsgis_validest_overview = 1,
+        rsgis_validest_sample = 2
+    };
+    
     inline bool compare_ImageValidPxlCounts (const RSGISImageValidDataMetric& first, const RSGISImageValidDataMetric& second)
     {
         return ( first.validPxlFunc < second.validPxlFunc );
@@ -80,14 +103,37 @@ namespace rsgis{namespace img{
     {
     public:
         RSGISImageMosaic();
+        /** The number of threads used to mosaic the output blocks (0 uses all the available cores). */
+        void setNumThreads(unsigned int numThreads);
+        /** The maximum number of input images each thread keeps open at a time. */
+        void setMaxOpenDatasets(unsigned int maxOpenDatasets);
+        /**
+         * Also create a reference image (UInt32) with mosaicSkipVals, where each pixel is the
+         * index of the input it came from plus 1, and 0 where there was no input. An empty
+         * file name does not create a reference image.
+         */
+        void setOutputRefImage(std::string refImage, std::string refFormat="KEA");
         void mosaic(std::string *inputImages, int numDS, std::string outputImage, float background, bool projFromImage, std::string proj, std::string format="ENVI", GDALDataType imgDataType=GDT_Float32);
         void mosaicSkipVals(std::string *inputImages, int numDS, std::string outputImage, float background, float skipVal, bool projFromImage, std::string proj, unsigned int skipBand = 0, unsigned int overlapBehaviour = 0, std::string format="KEA", GDALDataType imgDataType=GDT_Float32);
         void mosaicSkipThresh(std::string *inputImages, int numDS, std::string outputImage, float background, float skipLowerThresh, float skipUpperThresh, bool projFromImage, std::string proj, unsigned int threshBand = 0, unsigned int overlapBehaviour = 0, std::string format="KEA", GDALDataType imgDataType=GDT_Float32);
         void includeDatasets(GDALDataset *baseImage, std::string *inputImages, int numDS, std::vector<int> bands, bool bandsDefined);
         void includeDatasetsSkipVals(GDALDataset *baseImage, std::string *inputImages, int numDS, std::vector<int> bands, bool bandsDefined, float skipVal);
         void includeDatasetsIgnoreOverlap(GDALDataset *baseImage, std::string *inputImages, int numDS, int numOverlapPxls);
-        void orderInImagesValidData(std::vector<std::string> images, std::vector<std::string> *orderedImages, float noDataValue);
+        /**
+         * Order the images from the lowest to highest proportion of valid pixels. The images are
+         * evaluated in parallel using the number of threads set with setNumThreads. When estimating
+         * (overview or sample) enough pixels are counted for the estimated proportion to be within
+         * errTolerance of the full resolution value at 95% confidence.
+         */
+        void orderInImagesValidData(std::vector<std::string> images, std::vector<std::string> *orderedImages, float noDataValue, RSGISValidDataEstimate estMode=rsgis_validest_full, float errTolerance=0.01);
         ~RSGISImageMosaic();
+    protected:
+        void calcImageValidData(std::string image, float noDataValue, RSGISValidDataEstimate estMode, size_t nReqPxls, RSGISImageValidDataMetric *imgDataMetric);
+        void countValidPxls(GDALRasterBand **bands, int numBands, int xOff, int yOff, int xSize, int ySize, float noDataValue, RSGISImageValidDataMetric *imgDataMetric);
+        unsigned int numThreads;
+        unsigned int maxOpenDatasets;
+        std::string refImage;
+        std::string refFormat;
     };
     
     class DllExport RSGISCountValidPixels : public RSGISCalcImageValue
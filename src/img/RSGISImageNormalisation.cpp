@@ -78,8 +78,12 @@ namespace rsgis{namespace img{
 			}
 			
 			normImage = new RSGISNormaliseImage(numBands, imageMax, imageMin, outMax, outMin); //??? creates what we are to do with the calc image?
-			calcImg = new RSGISCalcImage(normImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage);
+			// The normalisation is applied with the native data type of the input image where it is supported.
+			if(!RSGISCalcImageAffine::calcImage(normImage->getAffineTransform(), datasets, 1, outputImage, false, NULL, "KEA", GDT_Float32, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads))
+			{
+				calcImg = new RSGISCalcImage(normImage, "", true);
+				calcImg->calcImage(datasets, 1, outputImage);
+			}
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -138,6 +142,21 @@ namespace rsgis{namespace img{
 		}
 	}
 
+	RSGISAffineTransform RSGISNormaliseImage::getAffineTransform()
+	{
+		RSGISAffineTransform transform;
+		for(int i = 0; i < this->numOutBands; i++)
+		{
+			RSGISAffineBandParams params = RSGISAffineBandParams(imageMin[i], imageMax[i] - imageMin[i], outMax[i] - outMin[i], outMin[i]);
+			params.inMin = imageMin[i];
+			params.inMax = imageMax[i];
+			params.outLow = outMin[i];
+			params.outHigh = outMax[i];
+			transform.bands.push_back(params);
+		}
+		return transform;
+	}
+	
 	RSGISNormaliseImage::~RSGISNormaliseImage()
 	{
 		
@@ -29,10 +29,13 @@
 
 #include "gdal_priv.h"
 
+#include "common/RSGISExecutionContext.h"
+
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISCalcImageAffine.h"
 #include "img/RSGISImageStatistics.h"
 
 // mark all exported classes/functions with DllExport to have
@@ -62,6 +65,8 @@ namespace rsgis{namespace img{
 		public: 
 			RSGISNormaliseImage(int numberOutBands, double *imageMaxIn, double *imageMinIn, double *outMaxIn, double *outMinIn);
 			void calcImageValue(float *bandValues, int numBands, double *output);
+			/** The same normalisation as a RSGISAffineTransform, for RSGISCalcImageAffine. */
+			RSGISAffineTransform getAffineTransform();
 			~RSGISNormaliseImage();
 		protected:
 			double *imageMax;
@@ -0,0 +1,301 @@
+/*
+ *  RSGISImagePointSampler.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISImagePointSampler.h"
+
+namespace rsgis{namespace img{
+    
+    void RSGISImagePointSampler::samplePoints(GDALDataset *image, std::vector<unsigned int> bands, const std::vector<double> &xLocs, const std::vector<double> &yLocs, RSGISPointSampleInterp interp, double noDataVal, std::vector<double> *outVals, unsigned int numThreads)
+    {
+        if(xLocs.size() != yLocs.size())
+        {
+            throw rsgis::RSGISImageException("The number of x and y point coordinates are not the same.");
+        }
+        double geoTransform[6];
+        if(image->GetGeoTransform(geoTransform) != CE_None)
+        {
+            throw rsgis::RSGISImageException("Could not read Geo Transform.");
+        }
+        
+        std::vector<double> pxlX(xLocs.size());
+        std::vector<double> pxlY(yLocs.size());
+        for(size_t p = 0; p < xLocs.size(); ++p)
+        {
+            pxlX[p] = (xLocs[p] - geoTransform[0]) / geoTransform[1];
+            pxlY[p] = (yLocs[p] - geoTransform[3]) / geoTransform[5];
+        }
+        sampleImageCoords(image, bands, pxlX, pxlY, interp, noDataVal, outVals, numThreads);
+    }
+    
+    void RSGISImagePointSampler::samplePixels(GDALDataset *image, std::vector<unsigned int> bands, const std::vector<unsigned int> &xPxls, const std::vector<unsigned int> &yPxls, double noDataVal, std::vector<double> *outVals, unsigned int numThreads)
+    {
+        if(xPxls.size() != yPxls.size())
+        {
+            throw rsgis::RSGISImageException("The number of x and y pixel coordinates are not the same.");
+        }
+        // The centres of the pixels.
+        std::vector<double> pxlX(xPxls.size());
+        std::vector<double> pxlY(yPxls.size());
+        for(size_t p = 0; p < xPxls.size(); ++p)
+        {
+            pxlX[p] = xPxls[p] + 0.5;
+            pxlY[p] = yPxls[p] + 0.5;
+        }
+        sampleImageCoords(image, bands, pxlX, pxlY, pointSampleNearest, noDataVal, outVals, numThreads);
+    }
+    
+    void RSGISImagePointSampler::sampleImageCoords(GDALDataset *image, std::vector<unsigned int> bands, const std::vector<double> &pxlX, const std::vector<double> &pxlY, RSGISPointSampleInterp interp, double noDataVal, std::vector<double> *outVals, unsigned int numThreads)
+    {
+        if(image == NULL)
+        {
+            throw rsgis::RSGISImageException("GDAL Dataset is not open.");
+        }
+        if(bands.empty())
+        {
+            for(int b = 1; b <= image->GetRasterCount(); ++b)
+            {
+                bands.push_back(b);
+            }
+        }
+        for(std::vector<unsigned int>::iterator iterBand = bands.begin(); iterBand != bands.end(); ++iterBand)
+        {
+            if(((*iterBand) == 0) || ((*iterBand) > ((unsigned int)image->GetRasterCount())))
+            {
+                throw rsgis::RSGISImageException("Image band is not within the GDAL dataset.");
+            }
+        }
+        
+        size_t numPts = pxlX.size();
+        size_t numBands = bands.size();
+        outVals->assign(numPts * numBands, noDataVal);
+        if((numPts == 0) || (numBands == 0))
+        {
+            return;
+        }
+        
+        long width = image->GetRasterXSize();
+        long height = image->GetRasterYSize();
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        image->GetRasterBand(bands[0])->GetBlockSize(&xBlockSize, &yBlockSize);
+        xBlockSize = std::max(xBlockSize, 1);
+        yBlockSize = std::max(yBlockSize, 1);
+        long numXBlocks = (width + xBlockSize - 1) / xBlockSize;
+        // The number of pixels around the pixel containing a point used by the interpolation.
+        long halo = (interp == pointSampleNearest)?0:((interp == pointSampleBilinear)?1:2);
+        
+        // Sort the points within the image by the block they are within.
+        std::vector<long> ptPxlX(numPts, 0);
+        std::vector<long> ptPxlY(numPts, 0);
+        std::vector< std::pair<long, size_t> > ptBlocks;
+        ptBlocks.reserve(numPts);
+        for(size_t p = 0; p < numPts; ++p)
+        {
+            if((!std::isfinite(pxlX[p])) || (!std::isfinite(pxlY[p])) || (pxlX[p] < 0) || (pxlY[p] < 0) || (pxlX[p] > width) || (pxlY[p] > height))
+            {
+                continue;
+            }
+            // Points on the right or bottom edge of the image are within the last pixel.
+            ptPxlX[p] = std::min<long>(floor(pxlX[p]), width-1);
+            ptPxlY[p] = std::min<long>(floor(pxlY[p]), height-1);
+            ptBlocks.push_back(std::pair<long, size_t>(((ptPxlY[p] / yBlockSize) * numXBlocks) + (ptPxlX[p] / xBlockSize), p));
+        }
+        std::sort(ptBlocks.begin(), ptBlocks.end());
+        std::vector<size_t> blockStarts;
+        for(size_t i = 0; i < ptBlocks.size(); ++i)
+        {
+            if((i == 0) || (ptBlocks[i].first != ptBlocks[i-1].first))
+            {
+                blockStarts.push_back(i);
+            }
+        }
+        blockStarts.push_back(ptBlocks.size());
+        size_t numTouchedBlocks = blockStarts.size() - 1;
+        if(numTouchedBlocks == 0)
+        {
+            return;
+        }
+        
+        unsigned int nThreads = (numThreads == 0)?rsgis::RSGISThreadPool::getNumHardwareThreads():numThreads;
+        nThreads = std::max<unsigned int>(std::min<size_t>(nThreads, numTouchedBlocks), 1);
+        
+        // Each thread reads from its own handle to the image file, if it can be reopened.
+        std::vector<GDALDataset*> threadDatasets(nThreads, image);
+        std::vector<bool> threadOpened(nThreads, false);
+        std::string imageFile = image->GetDescription();
+        bool sharedDataset = true;
+        if((nThreads > 1) && (imageFile != "") && (image->GetDriver() != NULL) && (std::string(image->GetDriver()->GetDescription()) != "MEM"))
+        {
+            sharedDataset = false;
+            for(unsigned int t = 1; t < nThreads; ++t)
+            {
+                GDALDataset *dataset = (GDALDataset *) GDALOpen(imageFile.c_str(), GA_ReadOnly);
+                if((dataset == NULL) || (dataset->GetRasterCount() != image->GetRasterCount()) || (dataset->GetRasterXSize() != width) || (dataset->GetRasterYSize() != height))
+                {
+                    if(dataset != NULL)
+                    {
+                        GDALClose(dataset);
+                    }
+                    sharedDataset = true;
+                    break;
+                }
+                threadDatasets[t] = dataset;
+                threadOpened[t] = true;
+            }
+        }
+        
+        std::mutex ioMutex;
+        std::atomic<size_t> nextBlock(0);
+        std::atomic<bool> readFailed(false);
+        rsgis::RSGISThreadPool threadPool(nThreads);
+        threadPool.parallelFor(0, nThreads, [&](unsigned int w, size_t tStart, size_t tEnd)
+        {
+            for(size_t t = tStart; t < tEnd; ++t)
+            {
+                GDALDataset *dataset = threadDatasets[t];
+                std::vector<double> blockVals;
+                double xWeights[4];
+                double yWeights[4];
+                long xTaps[4];
+                long yTaps[4];
+                size_t blk = 0;
+                while(((blk = nextBlock.fetch_add(1)) < numTouchedBlocks) && (!readFailed))
+                {
+                    long blockID = ptBlocks[blockStarts[blk]].first;
+                    long blockX = (blockID % numXBlocks) * xBlockSize;
+                    long blockY = (blockID / numXBlocks) * yBlockSize;
+                    long winX = std::max<long>(blockX - halo, 0);
+                    long winY = std::max<long>(blockY - halo, 0);
+                    long winXEnd = std::min<long>(blockX + xBlockSize + halo, width);
+                    long winYEnd = std::min<long>(blockY + yBlockSize + halo, height);
+                    long winWidth = winXEnd - winX;
+                    long winHeight = winYEnd - winY;
+                    size_t winPxls = ((size_t)winWidth) * winHeight;
+                    
+                    blockVals.resize(winPxls * numBands);
+                    {
+                        std::unique_lock<std::mutex> lock(ioMutex, std::defer_lock);
+                        if(sharedDataset)
+                        {
+                            lock.lock();
+                        }
+                        for(size_t b = 0; b < numBands; ++b)
+                        {
+                            if(dataset->GetRasterBand(bands[b])->RasterIO(GF_Read, winX, winY, winWidth, winHeight, &blockVals[b * winPxls], winWidth, winHeight, GDT_Float64, 0, 0) != CE_None)
+                            {
+                                readFailed = true;
+                                break;
+                            }
+                        }
+                    }
+                    if(readFailed)
+                    {
+                        break;
+                    }
+                    
+                    for(size_t i = blockStarts[blk]; i < blockStarts[blk+1]; ++i)
+                    {
+                        size_t p = ptBlocks[i].second;
+                        double *ptVals = &(*outVals)[p * numBands];
+                        if(interp == pointSampleNearest)
+                        {
+                            size_t idx = ((ptPxlY[p] - winY) * winWidth) + (ptPxlX[p] - winX);
+                            for(size_t b = 0; b < numBands; ++b)
+                            {
+                                ptVals[b] = blockVals[(b * winPxls) + idx];
+                            }
+                            continue;
+                        }
+                        
+                        // The kernel is relative to the pixel centres.
+                        double fx = pxlX[p] - 0.5;
+                        double fy = pxlY[p] - 0.5;
+                        long x0 = floor(fx);
+                        long y0 = floor(fy);
+                        unsigned int numTaps = 2;
+                        if(interp == pointSampleBilinear)
+                        {
+                            xWeights[0] = 1.0 - (fx - x0);
+                            xWeights[1] = fx - x0;
+                            yWeights[0] = 1.0 - (fy - y0);
+                            yWeights[1] = fy - y0;
+                        }
+                        else
+                        {
+                            numTaps = 4;
+                            cubicWeights(fx - x0, xWeights);
+                            cubicWeights(fy - y0, yWeights);
+                            x0 = x0 - 1;
+                            y0 = y0 - 1;
+                        }
+                        for(unsigned int k = 0; k < numTaps; ++k)
+                        {
+                            // Clamp the kernel to the edges of the image.
+                            xTaps[k] = std::min<long>(std::max<long>(x0 + k, 0), width-1) - winX;
+                            yTaps[k] = std::min<long>(std::max<long>(y0 + k, 0), height-1) - winY;
+                        }
+                        for(size_t b = 0; b < numBands; ++b)
+                        {
+                            const double *bandVals = &blockVals[b * winPxls];
+                            double val = 0.0;
+                            for(unsigned int ky = 0; ky < numTaps; ++ky)
+                            {
+                                double rowVal = 0.0;
+                                for(unsigned int kx = 0; kx < numTaps; ++kx)
+                                {
+                                    rowVal += xWeights[kx] * bandVals[(yTaps[ky] * winWidth) + xTaps[kx]];
+                                }
+                                val += yWeights[ky] * rowVal;
+                            }
+                            ptVals[b] = val;
+                        }
+                    }
+                }
+            }
+        });
+        
+        for(unsigned int t = 0; t < nThreads; ++t)
+        {
+            if(threadOpened[t])
+            {
+                GDALClose(threadDatasets[t]);
+            }
+        }
+        if(readFailed)
+        {
+            throw rsgis::RSGISImageException("Could not read a block of the image.");
+        }
+    }
+    
+    void RSGISImagePointSampler::cubicWeights(double t, double *weights)
+    {
+        // Catmull-Rom (a = -0.5) cubic convolution.
+        double t2 = t * t;
+        double t3 = t2 * t;
+        weights[0] = 0.5 * ((-t3) + (2 * t2) - t);
+        weights[1] = 0.5 * ((3 * t3) - (5 * t2) + 2);
+        weights[2] = 0.5 * ((-3 * t3) + (4 * t2) + t);
+        weights[3] = 0.5 * (t3 - t2);
+    }
+    
+}}
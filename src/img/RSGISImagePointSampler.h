@@ -0,0 +1,96 @@
+/*
+ *  RSGISImagePointSampler.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISImagePointSampler_H
+#define RSGISImagePointSampler_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <cmath>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISImageException.h"
+#include "common/RSGISThreadPool.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+    
+    /** The interpolation of the sampled values (the values match rsgislib.INTERP_*). */
+    enum RSGISPointSampleInterp
+    {
+        /// The value of the pixel containing the point
+        pointSampleNearest = 0,
+        /// Bilinear interpolation between the 2 x 2 nearest pixel centres
+        pointSampleBilinear = 1,
+        /// Cubic convolution (Catmull-Rom) of the 4 x 4 nearest pixel centres
+        pointSampleCubic = 2
+    };
+    
+    /**
+     * Samples the values of a set of points from the bands of an image. Rather
+     * than a 1 x 1 RasterIO call per point and band (as with RSGISImageUtils::getPixelValue)
+     * the points are sorted by the image block they are within and each block
+     * touched by a point is read once for all the bands. The blocks are processed
+     * in parallel, where each thread opens its own handle to the image if the image
+     * is a file (GDAL datasets cannot be read by more than one thread at a time);
+     * otherwise the reads are serialised.
+     *
+     * The output values are a dense matrix with a row per point, i.e., the value of
+     * point p and band b is outVals[(p * numBands) + b]. Points outside the image have
+     * the value noDataVal. The interpolation kernels are clamped at the edges of the
+     * image.
+     */
+    class DllExport RSGISImagePointSampler
+    {
+    public:
+        /** Sample the points with the map coordinates (xLocs[p], yLocs[p]). If bands is empty then all the bands are sampled. */
+        static void samplePoints(GDALDataset *image, std::vector<unsigned int> bands, const std::vector<double> &xLocs, const std::vector<double> &yLocs, RSGISPointSampleInterp interp, double noDataVal, std::vector<double> *outVals, unsigned int numThreads=1);
+        /** Sample the pixels (xPxls[p], yPxls[p]) where (0, 0) is the top-left pixel of the image. If bands is empty then all the bands are sampled. */
+        static void samplePixels(GDALDataset *image, std::vector<unsigned int> bands, const std::vector<unsigned int> &xPxls, const std::vector<unsigned int> &yPxls, double noDataVal, std::vector<double> *outVals, unsigned int numThreads=1);
+        /** The 4 Catmull-Rom cubic convolution weights for the offset t (0-1) from the second tap. */
+        static void cubicWeights(double t, double *weights);
+    protected:
+        /** Sample the points at the image coordinates (pxlX[p], pxlY[p]) where the pixel (x, y) covers [x, x+1) x [y, y+1). */
+        static void sampleImageCoords(GDALDataset *image, std::vector<unsigned int> bands, const std::vector<double> &pxlX, const std::vector<double> &pxlY, RSGISPointSampleInterp interp, double noDataVal, std::vector<double> *outVals, unsigned int numThreads);
+    };
+    
+}}
+
+#endif
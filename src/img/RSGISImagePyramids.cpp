@@ -0,0 +1,449 @@
+/*
+ *  RSGISImagePyramids.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISImagePyramids.h"
+
+namespace rsgis { namespace img {
+
+    RSGISImagePyramidBuilder::RSGISImagePyramidBuilder(RSGISPyramidResampling resampling, unsigned int numThreads)
+    {
+        this->resampling = resampling;
+        this->numThreads = numThreads;
+        if(this->numThreads == 0)
+        {
+            this->numThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+        }
+    }
+
+    void RSGISImagePyramidBuilder::buildPyramids(GDALDataset *imgDS, std::vector<int> decimatFactors, RSGISImageStripObserver *observer)
+    {
+        if(decimatFactors.empty())
+        {
+            if(observer != NULL)
+            {
+                rsgis::RSGISThreadPool threadPool(this->numThreads);
+                for(int n = 0; n < imgDS->GetRasterCount(); ++n)
+                {
+                    this->observeBand(imgDS->GetRasterBand(n+1), n+1, observer, &threadPool);
+                }
+            }
+            return;
+        }
+        std::sort(decimatFactors.begin(), decimatFactors.end());
+        decimatFactors.erase(std::unique(decimatFactors.begin(), decimatFactors.end()), decimatFactors.end());
+        if(decimatFactors.front() < 2)
+        {
+            throw rsgis::RSGISImageException("The pyramid decimation factors must be greater than 1.");
+        }
+        int numLevels = decimatFactors.size();
+
+        // Create the overview bands; the pixel values are calculated below.
+        if(imgDS->BuildOverviews("NONE", numLevels, decimatFactors.data(), 0, NULL, GDALDummyProgress, NULL) != CE_None)
+        {
+            throw rsgis::RSGISImageException("Could not create the image overviews.");
+        }
+
+        int numBands = imgDS->GetRasterCount();
+        int xSize = imgDS->GetRasterXSize();
+        int ySize = imgDS->GetRasterYSize();
+        size_t totalRows = 0;
+        std::vector< std::vector<GDALRasterBand*> > ovrBands(numBands);
+        for(int n = 0; n < numBands; ++n)
+        {
+            GDALRasterBand *band = imgDS->GetRasterBand(n+1);
+            int numOvrs = band->GetOverviewCount();
+            std::vector<bool> ovrUsed(numOvrs, false);
+            for(int i = 0; i < numLevels; ++i)
+            {
+                // Drivers round the overview size differently so use the closest overview.
+                double expX = ((double)xSize) / decimatFactors[i];
+                double expY = ((double)ySize) / decimatFactors[i];
+                int ovrIdx = -1;
+                double bestDiff = 0.0;
+                for(int j = 0; j < numOvrs; ++j)
+                {
+                    if(ovrUsed[j])
+                    {
+                        continue;
+                    }
+                    GDALRasterBand *tmpBand = band->GetOverview(j);
+                    double diff = std::fabs(tmpBand->GetXSize() - expX) + std::fabs(tmpBand->GetYSize() - expY);
+                    if((ovrIdx < 0) || (diff < bestDiff))
+                    {
+                        ovrIdx = j;
+                        bestDiff = diff;
+                    }
+                }
+                if((ovrIdx < 0) || (bestDiff > 2))
+                {
+                    throw rsgis::RSGISImageException("Could not find the overview created for a decimation factor.");
+                }
+                ovrUsed[ovrIdx] = true;
+                GDALRasterBand *ovrBand = band->GetOverview(ovrIdx);
+                ovrBands[n].push_back(ovrBand);
+                totalRows += ovrBand->GetYSize();
+            }
+        }
+
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        rsgis_tqdm pbar;
+        size_t rowsDone = 0;
+        for(int n = 0; n < numBands; ++n)
+        {
+            GDALRasterBand *band = imgDS->GetRasterBand(n+1);
+            int hasNoData = false;
+            double noDataVal = band->GetNoDataValue(&hasNoData);
+
+            GDALRasterBand *srcBand = band;
+            for(int i = 0; i < numLevels; ++i)
+            {
+                this->buildLevel(srcBand, ovrBands[n][i], hasNoData, noDataVal, &threadPool, &pbar, &rowsDone, totalRows, (i == 0)?observer:NULL, n+1);
+                srcBand = ovrBands[n][i];
+            }
+        }
+        pbar.finish();
+    }
+
+    std::vector<int> RSGISImagePyramidBuilder::getDefaultDecimationFactors(int xSize, int ySize, int minOverviewDim)
+    {
+        int minDim = std::min(xSize, ySize);
+        std::vector<int> decimatFactors;
+        int nLevels[] = { 4, 8, 16, 32, 64, 128, 256, 512 };
+        for(int i = 0; i < 8; i++)
+        {
+            if( (minDim/nLevels[i]) > minOverviewDim )
+            {
+                decimatFactors.push_back(nLevels[i]);
+            }
+        }
+        return decimatFactors;
+    }
+
+    void RSGISImagePyramidBuilder::buildLevel(GDALRasterBand *srcBand, GDALRasterBand *dstBand, bool useNoData, double noDataVal, rsgis::RSGISThreadPool *threadPool, rsgis_tqdm *pbar, size_t *rowsDone, size_t totalRows, RSGISImageStripObserver *observer, unsigned int observerBand)
+    {
+        int srcWidth = srcBand->GetXSize();
+        int srcHeight = srcBand->GetYSize();
+        int dstWidth = dstBand->GetXSize();
+        int dstHeight = dstBand->GetYSize();
+        if((dstWidth < 1) || (dstHeight < 1))
+        {
+            if(observer != NULL)
+            {
+                this->observeBand(srcBand, observerBand, observer, threadPool);
+            }
+            return;
+        }
+
+        std::vector<int> xOff, xOff2, yOff, yOff2;
+        RSGISImagePyramidBuilder::calcSrcWindows(this->resampling, srcWidth, dstWidth, &xOff, &xOff2);
+        RSGISImagePyramidBuilder::calcSrcWindows(this->resampling, srcHeight, dstHeight, &yOff, &yOff2);
+
+        // Strips are a multiple of the output block height, limited by the size of the input strip.
+        int dstBlockX = 0;
+        int dstBlockY = 0;
+        dstBand->GetBlockSize(&dstBlockX, &dstBlockY);
+        if(dstBlockY < 1)
+        {
+            dstBlockY = 1;
+        }
+        size_t srcRowsPerDstRow = (size_t)std::ceil(((double)srcHeight) / dstHeight) + 1;
+        size_t maxDstRows = maxStripVals / (((size_t)srcWidth) * srcRowsPerDstRow);
+        int stripRows = (int)std::min<size_t>(dstHeight, std::max<size_t>(dstBlockY, (maxDstRows / dstBlockY) * dstBlockY));
+
+        std::vector<double> srcVals;
+        std::vector<double> dstVals(((size_t)dstWidth) * stripRows);
+        std::vector< std::vector<double> > modeVals(threadPool->getNumThreads());
+
+        // The observer needs to see every row so the rows between windows are also read.
+        int observedRows = 0;
+        for(int row = 0; row < dstHeight; row += stripRows)
+        {
+            int nRows = std::min(stripRows, dstHeight - row);
+            int srcRow = yOff[row];
+            int srcEndRow = yOff2[row + nRows - 1];
+            if(observer != NULL)
+            {
+                srcRow = std::min(srcRow, observedRows);
+                srcEndRow = std::max(srcEndRow, ((row + nRows) < dstHeight)?yOff[row + nRows]:srcHeight);
+            }
+            int nSrcRows = srcEndRow - srcRow;
+            srcVals.resize(((size_t)srcWidth) * nSrcRows);
+            if(srcBand->RasterIO(GF_Read, 0, srcRow, srcWidth, nSrcRows, srcVals.data(), srcWidth, nSrcRows, GDT_Float64, 0, 0) != CE_None)
+            {
+                throw rsgis::RSGISImageException("Could not read the image data used to create the overview.");
+            }
+            if((observer != NULL) && (srcEndRow > observedRows))
+            {
+                observer->observeStrip(observerBand, observedRows, srcEndRow - observedRows, srcWidth, srcVals.data() + (((size_t)(observedRows - srcRow)) * srcWidth), threadPool);
+                observedRows = srcEndRow;
+            }
+
+            threadPool->parallelFor(row, row + nRows, [&](unsigned int t, size_t start, size_t end)
+            {
+                for(size_t y = start; y < end; ++y)
+                {
+                    double *dstRow = dstVals.data() + ((y - row) * dstWidth);
+                    for(int x = 0; x < dstWidth; ++x)
+                    {
+                        dstRow[x] = RSGISImagePyramidBuilder::resamplePxl(this->resampling, srcVals.data(), srcWidth, xOff[x], xOff2[x], yOff[y] - srcRow, yOff2[y] - srcRow, useNoData, noDataVal, &modeVals[t]);
+                    }
+                }
+            });
+
+            if(dstBand->RasterIO(GF_Write, 0, row, dstWidth, nRows, dstVals.data(), dstWidth, nRows, GDT_Float64, 0, 0) != CE_None)
+            {
+                throw rsgis::RSGISImageException("Could not write the overview image data.");
+            }
+
+            *rowsDone += nRows;
+            pbar->progress((int)((*rowsDone * 100) / totalRows), 100);
+        }
+    }
+
+    void RSGISImagePyramidBuilder::updatePyramids(GDALDataset *imgDS, int xOff, int yOff, int xSize, int ySize)
+    {
+        if((xSize < 1) || (ySize < 1))
+        {
+            return;
+        }
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        for(int n = 0; n < imgDS->GetRasterCount(); ++n)
+        {
+            GDALRasterBand *band = imgDS->GetRasterBand(n+1);
+            int hasNoData = false;
+            double noDataVal = band->GetNoDataValue(&hasNoData);
+
+            // As when they were built, each level is updated from the previous (next finer) level.
+            std::vector<GDALRasterBand*> ovrBands;
+            for(int j = 0; j < band->GetOverviewCount(); ++j)
+            {
+                ovrBands.push_back(band->GetOverview(j));
+            }
+            std::sort(ovrBands.begin(), ovrBands.end(), [](GDALRasterBand *a, GDALRasterBand *b){return a->GetXSize() > b->GetXSize();});
+
+            int xMin = std::max(xOff, 0);
+            int yMin = std::max(yOff, 0);
+            int xMax = std::min(xOff + xSize, band->GetXSize());
+            int yMax = std::min(yOff + ySize, band->GetYSize());
+            GDALRasterBand *srcBand = band;
+            for(size_t i = 0; i < ovrBands.size(); ++i)
+            {
+                if(!this->updateLevel(srcBand, ovrBands[i], hasNoData, noDataVal, &threadPool, &xMin, &yMin, &xMax, &yMax))
+                {
+                    break;
+                }
+                srcBand = ovrBands[i];
+            }
+        }
+    }
+
+    bool RSGISImagePyramidBuilder::updateLevel(GDALRasterBand *srcBand, GDALRasterBand *dstBand, bool useNoData, double noDataVal, rsgis::RSGISThreadPool *threadPool, int *xMin, int *yMin, int *xMax, int *yMax)
+    {
+        int srcWidth = srcBand->GetXSize();
+        int srcHeight = srcBand->GetYSize();
+        int dstWidth = dstBand->GetXSize();
+        int dstHeight = dstBand->GetYSize();
+        if((dstWidth < 1) || (dstHeight < 1) || (*xMin >= *xMax) || (*yMin >= *yMax))
+        {
+            return false;
+        }
+
+        std::vector<int> xOff, xOff2, yOff, yOff2;
+        RSGISImagePyramidBuilder::calcSrcWindows(this->resampling, srcWidth, dstWidth, &xOff, &xOff2);
+        RSGISImagePyramidBuilder::calcSrcWindows(this->resampling, srcHeight, dstHeight, &yOff, &yOff2);
+
+        // The source windows are in order so the overview pixels with a window intersecting the region are a range.
+        int dstX0 = std::upper_bound(xOff2.begin(), xOff2.end(), *xMin) - xOff2.begin();
+        int dstX1 = std::lower_bound(xOff.begin(), xOff.end(), *xMax) - xOff.begin();
+        int dstY0 = std::upper_bound(yOff2.begin(), yOff2.end(), *yMin) - yOff2.begin();
+        int dstY1 = std::lower_bound(yOff.begin(), yOff.end(), *yMax) - yOff.begin();
+        if((dstX0 >= dstX1) || (dstY0 >= dstY1))
+        {
+            return false;
+        }
+        int srcX0 = xOff[dstX0];
+        int srcWinWidth = xOff2[dstX1-1] - srcX0;
+        int dstWinWidth = dstX1 - dstX0;
+
+        size_t srcRowsPerDstRow = (size_t)std::ceil(((double)srcHeight) / dstHeight) + 1;
+        size_t maxDstRows = maxStripVals / (((size_t)srcWinWidth) * srcRowsPerDstRow);
+        int stripRows = (int)std::min<size_t>(dstY1 - dstY0, std::max<size_t>(1, maxDstRows));
+
+        std::vector<double> srcVals;
+        std::vector<double> dstVals(((size_t)dstWinWidth) * stripRows);
+        std::vector< std::vector<double> > modeVals(threadPool->getNumThreads());
+        for(int row = dstY0; row < dstY1; row += stripRows)
+        {
+            int nRows = std::min(stripRows, dstY1 - row);
+            int srcRow = yOff[row];
+            int nSrcRows = yOff2[row + nRows - 1] - srcRow;
+            srcVals.resize(((size_t)srcWinWidth) * nSrcRows);
+            if(srcBand->RasterIO(GF_Read, srcX0, srcRow, srcWinWidth, nSrcRows, srcVals.data(), srcWinWidth, nSrcRows, GDT_Float64, 0, 0) != CE_None)
+            {
+                throw rsgis::RSGISImageException("Could not read the image data used to update the overview.");
+            }
+
+            threadPool->parallelFor(row, row + nRows, [&](unsigned int t, size_t start, size_t end)
+            {
+                for(size_t y = start; y < end; ++y)
+                {
+                    double *dstRow = dstVals.data() + ((y - row) * dstWinWidth);
+                    for(int x = dstX0; x < dstX1; ++x)
+                    {
+                        dstRow[x - dstX0] = RSGISImagePyramidBuilder::resamplePxl(this->resampling, srcVals.data(), srcWinWidth, xOff[x] - srcX0, xOff2[x] - srcX0, yOff[y] - srcRow, yOff2[y] - srcRow, useNoData, noDataVal, &modeVals[t]);
+                    }
+                }
+            });
+
+            if(dstBand->RasterIO(GF_Write, dstX0, row, dstWinWidth, nRows, dstVals.data(), dstWinWidth, nRows, GDT_Float64, 0, 0) != CE_None)
+            {
+                throw rsgis::RSGISImageException("Could not write the overview image data.");
+            }
+        }
+
+        *xMin = dstX0;
+        *yMin = dstY0;
+        *xMax = dstX1;
+        *yMax = dstY1;
+        return true;
+    }
+
+    void RSGISImagePyramidBuilder::observeBand(GDALRasterBand *band, unsigned int bandIdx, RSGISImageStripObserver *observer, rsgis::RSGISThreadPool *threadPool)
+    {
+        int width = band->GetXSize();
+        int height = band->GetYSize();
+        int blockX = 0;
+        int blockY = 0;
+        band->GetBlockSize(&blockX, &blockY);
+        if(blockY < 1)
+        {
+            blockY = 1;
+        }
+        size_t maxRows = maxStripVals / ((size_t)std::max(width, 1));
+        int stripRows = (int)std::min<size_t>(std::max(height, 1), std::max<size_t>(blockY, (maxRows / blockY) * blockY));
+
+        std::vector<double> vals(((size_t)width) * stripRows);
+        for(int row = 0; row < height; row += stripRows)
+        {
+            int nRows = std::min(stripRows, height - row);
+            if(band->RasterIO(GF_Read, 0, row, width, nRows, vals.data(), width, nRows, GDT_Float64, 0, 0) != CE_None)
+            {
+                throw rsgis::RSGISImageException("Could not read the image data.");
+            }
+            observer->observeStrip(bandIdx, row, nRows, width, vals.data(), threadPool);
+        }
+    }
+
+    void RSGISImagePyramidBuilder::calcSrcWindows(RSGISPyramidResampling resampling, int srcSize, int dstSize, std::vector<int> *srcOff, std::vector<int> *srcOff2)
+    {
+        double ratio = ((double)srcSize) / dstSize;
+        srcOff->resize(dstSize);
+        srcOff2->resize(dstSize);
+        for(int i = 0; i < dstSize; ++i)
+        {
+            int off = 0;
+            int off2 = 0;
+            if(resampling == pyramidNearest)
+            {
+                off = std::min(srcSize - 1, (int)((i + 0.5) * ratio));
+                off2 = off + 1;
+            }
+            else
+            {
+                off = std::min(srcSize - 1, (int)(0.5 + (i * ratio)));
+                off2 = std::min(srcSize, (int)(0.5 + ((i + 1) * ratio)));
+                if(off2 <= off)
+                {
+                    off2 = off + 1;
+                }
+            }
+            (*srcOff)[i] = off;
+            (*srcOff2)[i] = off2;
+        }
+    }
+
+    double RSGISImagePyramidBuilder::resamplePxl(RSGISPyramidResampling resampling, double *srcVals, int srcWidth, int xOff, int xOff2, int yOff, int yOff2, bool useNoData, double noDataVal, std::vector<double> *modeVals)
+    {
+        double outVal = useNoData?noDataVal:std::numeric_limits<double>::quiet_NaN();
+        if(resampling == pyramidNearest)
+        {
+            outVal = srcVals[(((size_t)yOff) * srcWidth) + xOff];
+        }
+        else if(resampling == pyramidAverage)
+        {
+            double sum = 0.0;
+            size_t count = 0;
+            for(int y = yOff; y < yOff2; ++y)
+            {
+                double *srcRow = srcVals + (((size_t)y) * srcWidth);
+                for(int x = xOff; x < xOff2; ++x)
+                {
+                    if(!std::isnan(srcRow[x]) && !(useNoData && (srcRow[x] == noDataVal)))
+                    {
+                        sum += srcRow[x];
+                        ++count;
+                    }
+                }
+            }
+            if(count > 0)
+            {
+                outVal = sum / count;
+            }
+        }
+        else
+        {
+            // Mode; where values are equally frequent the smallest is used.
+            modeVals->clear();
+            for(int y = yOff; y < yOff2; ++y)
+            {
+                double *srcRow = srcVals + (((size_t)y) * srcWidth);
+                for(int x = xOff; x < xOff2; ++x)
+                {
+                    if(!std::isnan(srcRow[x]) && !(useNoData && (srcRow[x] == noDataVal)))
+                    {
+                        modeVals->push_back(srcRow[x]);
+                    }
+                }
+            }
+            if(!modeVals->empty())
+            {
+                std::sort(modeVals->begin(), modeVals->end());
+                size_t bestCount = 0;
+                size_t runStart = 0;
+                for(size_t i = 1; i <= modeVals->size(); ++i)
+                {
+                    if((i == modeVals->size()) || ((*modeVals)[i] != (*modeVals)[runStart]))
+                    {
+                        if((i - runStart) > bestCount)
+                        {
+                            bestCount = i - runStart;
+                            outVal = (*modeVals)[runStart];
+                        }
+                        runStart = i;
+                    }
+                }
+            }
+        }
+        return outVal;
+    }
+
+}}
@@ -0,0 +1,124 @@
+/*
+ *  RSGISImagePyramids.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISImagePyramids_H
+#define RSGISImagePyramids_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#include "gdal_priv.h"
+
+#include "common/rsgis-tqdm.h"
+#include "common/RSGISImageException.h"
+#include "common/RSGISThreadPool.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis { namespace img {
+
+    enum RSGISPyramidResampling
+    {
+        /// The pixel at the centre of the window (e.g., clumps)
+        pyramidNearest,
+        /// The mean of the valid pixels within the window (continuous data)
+        pyramidAverage,
+        /// The most frequent valid value within the window (thematic classes)
+        pyramidMode
+    };
+
+    /**
+     * Interface for classes which need to see the pixel values of the image as the
+     * pyramids are built, allowing statistics to be calculated without another read
+     * of the image.
+     */
+    class DllExport RSGISImageStripObserver
+    {
+    public:
+        RSGISImageStripObserver(){};
+        /**
+         * Called for each strip of nRows rows (starting at row) of band (numbered from 1),
+         * in order down the image so every pixel is seen once. The threadPool can be used
+         * to process the strip in parallel.
+         */
+        virtual void observeStrip(unsigned int band, int row, int nRows, int width, double *vals, rsgis::RSGISThreadPool *threadPool) = 0;
+        virtual ~RSGISImageStripObserver(){};
+    };
+
+    /**
+     * Builds the image pyramids (overviews) for a dataset. The overview bands are
+     * created through GDAL and then each level is generated from the previous
+     * (next finer) level rather than the full resolution image. Each level is
+     * processed in strips of rows, the strip is read and written by the calling
+     * thread and the output rows are resampled in parallel by numThreads threads
+     * (0 uses all available cores). No data values (and NaNs) are ignored by the
+     * average and mode resampling. If an observer is provided it is given the rows
+     * of the image as they are read to build the first level.
+     */
+    class DllExport RSGISImagePyramidBuilder
+    {
+    public:
+        RSGISImagePyramidBuilder(RSGISPyramidResampling resampling, unsigned int numThreads=1);
+        /** Build the overviews for the decimation factors (e.g., 4, 8, 16) for all the bands of imgDS. */
+        void buildPyramids(GDALDataset *imgDS, std::vector<int> decimatFactors, RSGISImageStripObserver *observer=NULL);
+        /**
+         * Update the existing overviews of all the bands of imgDS where the region of
+         * xSize x ySize pixels from [xOff, yOff] of the image has changed, rather than
+         * rebuilding them. Only the overview pixels whose source windows intersect the
+         * region are resampled, with each level updated from the previous level.
+         */
+        void updatePyramids(GDALDataset *imgDS, int xOff, int yOff, int xSize, int ySize);
+        /** Get the default decimation factors (4 to 512) where the overview is larger than minOverviewDim pixels. */
+        static std::vector<int> getDefaultDecimationFactors(int xSize, int ySize, int minOverviewDim=33);
+        /** Calculate the source window [srcOff, srcOff2) of each of the dstSize overview pixels along one axis. */
+        static void calcSrcWindows(RSGISPyramidResampling resampling, int srcSize, int dstSize, std::vector<int> *srcOff, std::vector<int> *srcOff2);
+        /** Resample the window [xOff, xOff2) x [yOff, yOff2) of srcVals (srcWidth pixels per row); modeVals is a working buffer. */
+        static double resamplePxl(RSGISPyramidResampling resampling, double *srcVals, int srcWidth, int xOff, int xOff2, int yOff, int yOff2, bool useNoData, double noDataVal, std::vector<double> *modeVals);
+        ~RSGISImagePyramidBuilder(){};
+    protected:
+        void buildLevel(GDALRasterBand *srcBand, GDALRasterBand *dstBand, bool useNoData, double noDataVal, rsgis::RSGISThreadPool *threadPool, rsgis_tqdm *pbar, size_t *rowsDone, size_t totalRows, RSGISImageStripObserver *observer, unsigned int observerBand);
+        void observeBand(GDALRasterBand *band, unsigned int bandIdx, RSGISImageStripObserver *observer, rsgis::RSGISThreadPool *threadPool);
+        /** Update the pixels of dstBand covering the region [xMin, xMax) x [yMin, yMax) of srcBand, which is set to the region of dstBand updated (returns false if none). */
+        bool updateLevel(GDALRasterBand *srcBand, GDALRasterBand *dstBand, bool useNoData, double noDataVal, rsgis::RSGISThreadPool *threadPool, int *xMin, int *yMin, int *xMax, int *yMax);
+        RSGISPyramidResampling resampling;
+        unsigned int numThreads;
+        static const size_t maxStripVals = 8388608;
+    };
+
+}}
+
+#endif
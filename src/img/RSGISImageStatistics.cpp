@@ -961,11 +961,18 @@ namespace rsgis{namespace img{
         {
             unsigned numImageBands = dataset->GetRasterCount();
             outPercentiles = matrixUtils.createMatrix(numImageBands, 1);
+            std::vector<unsigned int> bands;
             for(unsigned int n = 0; n < numImageBands; ++n)
             {
-                std::cout << "\tCalculating Percentile " << percentile << " of band " << n+1 << std::flush;
-                outPercentiles->matrix[n] = this->getPercentile(dataset, n+1, percentile, noDataVal, noDataDefined);
-                std::cout << " = " << outPercentiles->matrix[n] << std::endl;
+                bands.push_back(n+1);
+            }
+            // All the bands are found together so each pass reads the image once.
+            RSGISImageHistogramEngine histEngine(rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads);
+            std::vector<double> percentileVals = histEngine.calcExactPercentiles(dataset, bands, percentile, noDataDefined, noDataVal);
+            for(unsigned int n = 0; n < numImageBands; ++n)
+            {
+                outPercentiles->matrix[n] = percentileVals.at(n);
+                std::cout << "\tPercentile " << percentile << " of band " << n+1 << " = " << outPercentiles->matrix[n] << std::endl;
             }
         }
         catch (rsgis::RSGISImageException &e)
@@ -989,11 +996,8 @@ namespace rsgis{namespace img{
         double percentileVal = 0.0;
         try
         {
-            RSGISImageUtils imageUtils;
-            std::vector<double> *dataVals = imageUtils.getImageBandValues(dataset, band, noDataDefined, noDataVal);
-            std::sort(dataVals->begin(), dataVals->end());            
-            percentileVal = gsl_stats_quantile_from_sorted_data(&(*dataVals)[0], 1, dataVals->size(), percentile);
-            delete dataVals;
+            RSGISImageHistogramEngine histEngine(rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads);
+            percentileVal = histEngine.calcExactPercentiles(dataset, std::vector<unsigned int>(1, band), percentile, noDataDefined, noDataVal).at(0);
         }
         catch (rsgis::RSGISImageException &e)
         {
@@ -33,6 +33,9 @@
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISImageHistogramEngine.h"
+
+#include "common/RSGISExecutionContext.h"
 
 #include "math/RSGISMathFunction.h"
 #include "math/RSGISMatrices.h"
@@ -0,0 +1,409 @@
+/*
+ *  RSGISImageTileCutter.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISImageTileCutter.h"
+
+#include "img/RSGISImageUtils.h"
+
+namespace rsgis{namespace img{
+    
+    RSGISImageTileCutter::RSGISImageTileCutter(unsigned int numThreads, unsigned int maxOpenTiles)
+    {
+        if(numThreads == 0)
+        {
+            numThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+        }
+        this->numThreads = numThreads;
+        this->maxOpenTiles = std::max<unsigned int>(maxOpenTiles, 1);
+    }
+    
+    void RSGISImageTileCutter::cutTiles(GDALDataset *dataset, std::vector<RSGISImageTile> *tiles, std::string gdalFormat, GDALDataType outDataType, double maskValue, double outValue)
+    {
+        unsigned int width = dataset->GetRasterXSize();
+        unsigned int height = dataset->GetRasterYSize();
+        unsigned int numBands = dataset->GetRasterCount();
+        if(numBands == 0)
+        {
+            throw RSGISImageException("The input image does not have any bands.");
+        }
+        
+        for(std::vector<RSGISImageTile>::iterator iterTile = tiles->begin(); iterTile != tiles->end(); ++iterTile)
+        {
+            if(((*iterTile).xSize == 0) || ((*iterTile).ySize == 0))
+            {
+                throw RSGISImageException("A tile has no pixels: " + (*iterTile).outputImage);
+            }
+            if((((*iterTile).xOff + (*iterTile).xSize) > width) || (((*iterTile).yOff + (*iterTile).ySize) > height))
+            {
+                throw RSGISImageException("A tile is not within the input image: " + (*iterTile).outputImage);
+            }
+            if((*iterTile).outputImage == "")
+            {
+                throw RSGISImageException("A tile does not have an output image file name.");
+            }
+        }
+        if(tiles->empty())
+        {
+            return;
+        }
+        
+        GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(gdalFormat.c_str());
+        if(gdalDriver == NULL)
+        {
+            throw RSGISImageException("Requested GDAL driver does not exists..");
+        }
+        RSGISImageUtils imgUtils;
+        char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(gdalFormat);
+        
+        // Strips are a multiple of the block height within the memory for a strip of all the bands.
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        dataset->GetRasterBand(1)->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(yBlockSize, width, height, numBands * sizeof(double), rsgis::RSGISExecutionContextUtils::getDefaultContext().stripMemoryMB);
+        if(stripRows == 0)
+        {
+            stripRows = 1;
+        }
+        
+        try
+        {
+            std::vector<std::vector<size_t> > sweeps = this->assignSweeps(tiles, stripRows);
+            for(size_t i = 0; i < sweeps.size(); ++i)
+            {
+                if(sweeps.size() > 1)
+                {
+                    std::cout << "Sweep " << i+1 << " of " << sweeps.size() << " (" << sweeps[i].size() << " tiles)" << std::endl;
+                }
+                this->cutSweep(dataset, tiles, &sweeps[i], stripRows, gdalDriver, papszOptions, outDataType, maskValue, outValue);
+            }
+        }
+        catch(RSGISImageException &e)
+        {
+            CSLDestroy(papszOptions);
+            throw e;
+        }
+        CSLDestroy(papszOptions);
+    }
+    
+    std::vector<std::vector<size_t> > RSGISImageTileCutter::assignSweeps(std::vector<RSGISImageTile> *tiles, unsigned int stripRows)
+    {
+        std::vector<size_t> order(tiles->size());
+        for(size_t i = 0; i < tiles->size(); ++i)
+        {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [tiles, stripRows](size_t a, size_t b)
+        {
+            unsigned int stripA = tiles->at(a).yOff / stripRows;
+            unsigned int stripB = tiles->at(b).yOff / stripRows;
+            if(stripA != stripB)
+            {
+                return stripA < stripB;
+            }
+            return tiles->at(a).xOff < tiles->at(b).xOff;
+        });
+        
+        // Taking the tiles in the order of their first strip, each is added to the first
+        // sweep with fewer than maxOpenTiles tiles still open (i.e., an interval partitioning).
+        std::vector<std::vector<size_t> > sweeps;
+        std::vector<std::priority_queue<unsigned int, std::vector<unsigned int>, std::greater<unsigned int> > > sweepOpen;
+        for(std::vector<size_t>::iterator iterOrder = order.begin(); iterOrder != order.end(); ++iterOrder)
+        {
+            RSGISImageTile *tile = &tiles->at(*iterOrder);
+            unsigned int firstStrip = tile->yOff / stripRows;
+            unsigned int lastStrip = (tile->yOff + tile->ySize - 1) / stripRows;
+            bool assigned = false;
+            for(size_t s = 0; s < sweeps.size(); ++s)
+            {
+                while((!sweepOpen[s].empty()) && (sweepOpen[s].top() < firstStrip))
+                {
+                    sweepOpen[s].pop();
+                }
+                if(sweepOpen[s].size() < this->maxOpenTiles)
+                {
+                    sweepOpen[s].push(lastStrip);
+                    sweeps[s].push_back(*iterOrder);
+                    assigned = true;
+                    break;
+                }
+            }
+            if(!assigned)
+            {
+                sweeps.push_back(std::vector<size_t>(1, *iterOrder));
+                sweepOpen.push_back(std::priority_queue<unsigned int, std::vector<unsigned int>, std::greater<unsigned int> >());
+                sweepOpen.back().push(lastStrip);
+            }
+        }
+        return sweeps;
+    }
+    
+    void RSGISImageTileCutter::cutSweep(GDALDataset *dataset, std::vector<RSGISImageTile> *tiles, std::vector<size_t> *sweep, unsigned int stripRows, GDALDriver *gdalDriver, char **papszOptions, GDALDataType outDataType, double maskValue, double outValue)
+    {
+        unsigned int width = dataset->GetRasterXSize();
+        unsigned int height = dataset->GetRasterYSize();
+        unsigned int numBands = dataset->GetRasterCount();
+        
+        // The input is only read on this thread, so its metadata is copied before writing the tiles.
+        double gdalTransform[6];
+        dataset->GetGeoTransform(gdalTransform);
+        std::string projection = std::string(dataset->GetProjectionRef());
+        std::vector<std::string> bandNames;
+        for(unsigned int b = 0; b < numBands; ++b)
+        {
+            bandNames.push_back(std::string(dataset->GetRasterBand(b+1)->GetDescription()));
+        }
+        
+        size_t numTiles = sweep->size();
+        std::vector<GDALDataset*> outDatasets(numTiles, NULL);
+        std::vector<GDALDataset*> maskDatasets(numTiles, NULL);
+        std::vector<unsigned int> firstStrips(numTiles, 0);
+        unsigned int sweepFirstStrip = tiles->at(sweep->at(0)).yOff / stripRows;
+        unsigned int sweepLastStrip = 0;
+        for(size_t i = 0; i < numTiles; ++i)
+        {
+            RSGISImageTile *tile = &tiles->at(sweep->at(i));
+            firstStrips[i] = tile->yOff / stripRows;
+            sweepLastStrip = std::max(sweepLastStrip, (tile->yOff + tile->ySize - 1) / stripRows);
+        }
+        
+        std::vector<double> stripVals;
+        std::vector<size_t> active;
+        size_t nextTile = 0;
+        std::mutex errorMutex;
+        std::string errorMessage = "";
+        std::atomic<bool> failed(false);
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        rsgis_tqdm pbar;
+        for(unsigned int strip = sweepFirstStrip; strip <= sweepLastStrip; ++strip)
+        {
+            pbar.progress(strip - sweepFirstStrip, (sweepLastStrip - sweepFirstStrip) + 1);
+            while((nextTile < numTiles) && (firstStrips[nextTile] <= strip))
+            {
+                active.push_back(nextTile++);
+            }
+            if(active.empty())
+            {
+                continue;
+            }
+            
+            // Read the part of the strip covered by the open tiles.
+            unsigned int stripStart = strip * stripRows;
+            unsigned int stripEnd = std::min(stripStart + stripRows, height);
+            unsigned int readXMin = width;
+            unsigned int readXMax = 0;
+            unsigned int readYMin = stripEnd;
+            unsigned int readYMax = stripStart;
+            for(std::vector<size_t>::iterator iterActive = active.begin(); iterActive != active.end(); ++iterActive)
+            {
+                RSGISImageTile *tile = &tiles->at(sweep->at(*iterActive));
+                readXMin = std::min(readXMin, tile->xOff);
+                readXMax = std::max(readXMax, tile->xOff + tile->xSize);
+                readYMin = std::min(readYMin, std::max(tile->yOff, stripStart));
+                readYMax = std::max(readYMax, std::min(tile->yOff + tile->ySize, stripEnd));
+            }
+            unsigned int readWidth = readXMax - readXMin;
+            unsigned int readHeight = readYMax - readYMin;
+            size_t readPxls = ((size_t)readWidth) * readHeight;
+            stripVals.resize(readPxls * numBands);
+            for(unsigned int b = 0; b < numBands; ++b)
+            {
+                if(dataset->GetRasterBand(b+1)->RasterIO(GF_Read, readXMin, readYMin, readWidth, readHeight, &stripVals[b * readPxls], readWidth, readHeight, GDT_Float64, 0, 0) != CE_None)
+                {
+                    errorMessage = "Could not read the input image.";
+                    failed = true;
+                    break;
+                }
+            }
+            if(failed)
+            {
+                break;
+            }
+            
+            // Scatter the strip to the tiles, which are written on the pool.
+            std::atomic<size_t> nextActive(0);
+            threadPool.parallelFor(0, this->numThreads, [&](unsigned int w, size_t tStart, size_t tEnd)
+            {
+                for(size_t t = tStart; t < tEnd; ++t)
+                {
+                    std::vector<double> tileVals;
+                    std::vector<double> maskVals;
+                    size_t a = 0;
+                    while(((a = nextActive.fetch_add(1)) < active.size()) && (!failed))
+                    {
+                        size_t idx = active[a];
+                        RSGISImageTile *tile = &tiles->at(sweep->at(idx));
+                        std::string tileError = "";
+                        if(outDatasets[idx] == NULL)
+                        {
+                            GDALDataset *outDataset = gdalDriver->Create(tile->outputImage.c_str(), tile->xSize, tile->ySize, numBands, outDataType, papszOptions);
+                            if(outDataset == NULL)
+                            {
+                                tileError = "Could not create the tile image: " + tile->outputImage;
+                            }
+                            else
+                            {
+                                double tileTransform[6];
+                                for(unsigned int i = 0; i < 6; ++i)
+                                {
+                                    tileTransform[i] = gdalTransform[i];
+                                }
+                                tileTransform[0] = gdalTransform[0] + (tile->xOff * gdalTransform[1]) + (tile->yOff * gdalTransform[2]);
+                                tileTransform[3] = gdalTransform[3] + (tile->xOff * gdalTransform[4]) + (tile->yOff * gdalTransform[5]);
+                                outDataset->SetGeoTransform(tileTransform);
+                                outDataset->SetProjection(projection.c_str());
+                                for(unsigned int b = 0; b < numBands; ++b)
+                                {
+                                    if(bandNames[b] != "")
+                                    {
+                                        outDataset->GetRasterBand(b+1)->SetDescription(bandNames[b].c_str());
+                                    }
+                                }
+                                outDatasets[idx] = outDataset;
+                            }
+                            if((tileError == "") && (tile->maskImage != ""))
+                            {
+                                GDALDataset *maskDataset = (GDALDataset *) GDALOpen(tile->maskImage.c_str(), GA_ReadOnly);
+                                if(maskDataset == NULL)
+                                {
+                                    tileError = "Could not open the mask image: " + tile->maskImage;
+                                }
+                                else if((((unsigned int)maskDataset->GetRasterXSize()) != width) || (((unsigned int)maskDataset->GetRasterYSize()) != height))
+                                {
+                                    GDALClose(maskDataset);
+                                    tileError = "The mask image is not the same size as the input image: " + tile->maskImage;
+                                }
+                                else
+                                {
+                                    maskDatasets[idx] = maskDataset;
+                                }
+                            }
+                        }
+                        
+                        unsigned int tileYEnd = tile->yOff + tile->ySize;
+                        unsigned int rowStart = std::max(tile->yOff, readYMin);
+                        unsigned int rowEnd = std::min(tileYEnd, readYMax);
+                        unsigned int numRows = rowEnd - rowStart;
+                        size_t offset = (((size_t)(rowStart - readYMin)) * readWidth) + (tile->xOff - readXMin);
+                        if((tileError == "") && (maskDatasets[idx] == NULL))
+                        {
+                            // The tile is written directly from the strip.
+                            for(unsigned int b = 0; b < numBands; ++b)
+                            {
+                                if(outDatasets[idx]->GetRasterBand(b+1)->RasterIO(GF_Write, 0, rowStart - tile->yOff, tile->xSize, numRows, &stripVals[(b * readPxls) + offset], tile->xSize, numRows, GDT_Float64, sizeof(double), ((GSpacing)readWidth) * sizeof(double)) != CE_None)
+                                {
+                                    tileError = "Could not write the tile image: " + tile->outputImage;
+                                    break;
+                                }
+                            }
+                        }
+                        else if(tileError == "")
+                        {
+                            size_t tilePxls = ((size_t)tile->xSize) * numRows;
+                            maskVals.resize(tilePxls);
+                            tileVals.resize(tilePxls);
+                            if(maskDatasets[idx]->GetRasterBand(1)->RasterIO(GF_Read, tile->xOff, rowStart, tile->xSize, numRows, maskVals.data(), tile->xSize, numRows, GDT_Float64, 0, 0) != CE_None)
+                            {
+                                tileError = "Could not read the mask image: " + tile->maskImage;
+                            }
+                            for(unsigned int b = 0; (b < numBands) && (tileError == ""); ++b)
+                            {
+                                for(unsigned int y = 0; y < numRows; ++y)
+                                {
+                                    const double *rowVals = &stripVals[(b * readPxls) + offset + (((size_t)y) * readWidth)];
+                                    double *outRowVals = &tileVals[((size_t)y) * tile->xSize];
+                                    const double *maskRowVals = &maskVals[((size_t)y) * tile->xSize];
+                                    for(unsigned int x = 0; x < tile->xSize; ++x)
+                                    {
+                                        outRowVals[x] = (maskRowVals[x] == maskValue)?outValue:rowVals[x];
+                                    }
+                                }
+                                if(outDatasets[idx]->GetRasterBand(b+1)->RasterIO(GF_Write, 0, rowStart - tile->yOff, tile->xSize, numRows, tileVals.data(), tile->xSize, numRows, GDT_Float64, 0, 0) != CE_None)
+                                {
+                                    tileError = "Could not write the tile image: " + tile->outputImage;
+                                }
+                            }
+                        }
+                        
+                        if(tileError != "")
+                        {
+                            std::lock_guard<std::mutex> lock(errorMutex);
+                            if(!failed)
+                            {
+                                errorMessage = tileError;
+                                failed = true;
+                            }
+                        }
+                        else if(rowEnd == tileYEnd)
+                        {
+                            // The tile is complete so is closed (which flushes it on this thread).
+                            GDALClose(outDatasets[idx]);
+                            outDatasets[idx] = NULL;
+                            if(maskDatasets[idx] != NULL)
+                            {
+                                GDALClose(maskDatasets[idx]);
+                                maskDatasets[idx] = NULL;
+                            }
+                        }
+                    }
+                }
+            });
+            if(failed)
+            {
+                break;
+            }
+            
+            std::vector<size_t> stillOpen;
+            for(std::vector<size_t>::iterator iterActive = active.begin(); iterActive != active.end(); ++iterActive)
+            {
+                if(outDatasets[*iterActive] != NULL)
+                {
+                    stillOpen.push_back(*iterActive);
+                }
+            }
+            active = stillOpen;
+        }
+        pbar.finish();
+        
+        for(size_t i = 0; i < numTiles; ++i)
+        {
+            if(outDatasets[i] != NULL)
+            {
+                GDALClose(outDatasets[i]);
+            }
+            if(maskDatasets[i] != NULL)
+            {
+                GDALClose(maskDatasets[i]);
+            }
+        }
+        if(failed)
+        {
+            throw RSGISImageException(errorMessage);
+        }
+    }
+    
+    RSGISImageTileCutter::~RSGISImageTileCutter()
+    {
+        
+    }
+    
+}}
@@ -0,0 +1,106 @@
+/*
+ *  RSGISImageTileCutter.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#ifndef RSGISImageTileCutter_H
+#define RSGISImageTileCutter_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <queue>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <functional>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISImageException.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/rsgis-tqdm.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+    
+    static const unsigned int RSGIS_TILE_CUTTER_MAX_OPEN( 256 );
+    
+    /**
+     * An output tile, as a window (in pixels) of the input image. If maskImage is
+     * not empty then it is an image with the same size as the input image, of which the
+     * first band is read for the window of the tile, and the output pixels where the mask
+     * has the mask value are given the out value (as RSGISMaskImage).
+     */
+    struct DllExport RSGISImageTile
+    {
+        RSGISImageTile(): xOff(0), yOff(0), xSize(0), ySize(0), outputImage(""), maskImage("") {};
+        RSGISImageTile(unsigned int xOff, unsigned int yOff, unsigned int xSize, unsigned int ySize, std::string outputImage, std::string maskImage=""): xOff(xOff), yOff(yOff), xSize(xSize), ySize(ySize), outputImage(outputImage), maskImage(maskImage) {};
+        unsigned int xOff;
+        unsigned int yOff;
+        unsigned int xSize;
+        unsigned int ySize;
+        std::string outputImage;
+        std::string maskImage;
+    };
+    
+    /**
+     * Cuts a set of tiles from an image while reading the image once, in strips,
+     * rather than once per tile. Each strip is scattered to the tiles it intersects,
+     * which are written in parallel on the thread pool (each tile is an independent
+     * dataset so can be written by any thread). A tile is created when the strip with
+     * its first row is read and closed once its last row has been written, so only the
+     * tiles intersecting a strip are open. Where that would be more than maxOpenTiles
+     * (e.g., for tiles covering the whole image) the tiles are split into sweeps, each
+     * of which reads the rows (and columns) covered by its tiles.
+     */
+    class DllExport RSGISImageTileCutter
+    {
+    public:
+        /** If numThreads is 0 the number of hardware threads is used. */
+        RSGISImageTileCutter(unsigned int numThreads=1, unsigned int maxOpenTiles=RSGIS_TILE_CUTTER_MAX_OPEN);
+        void cutTiles(GDALDataset *dataset, std::vector<RSGISImageTile> *tiles, std::string gdalFormat, GDALDataType outDataType, double maskValue=0, double outValue=0);
+        ~RSGISImageTileCutter();
+    protected:
+        /** Split the tiles so no strip of stripRows rows intersects more than maxOpenTiles tiles of a sweep. */
+        std::vector<std::vector<size_t> > assignSweeps(std::vector<RSGISImageTile> *tiles, unsigned int stripRows);
+        void cutSweep(GDALDataset *dataset, std::vector<RSGISImageTile> *tiles, std::vector<size_t> *sweep, unsigned int stripRows, GDALDriver *gdalDriver, char **papszOptions, GDALDataType outDataType, double maskValue, double outValue);
+        unsigned int numThreads;
+        unsigned int maxOpenTiles;
+    };
+    
+}}
+
+#endif
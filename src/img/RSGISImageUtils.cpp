@@ -21,12 +21,14 @@
  */
 
 #include "RSGISImageUtils.h"
+#include "common/RSGISGDALInit.h"
 
 namespace rsgis{namespace img{
 
 	RSGISImageUtils::RSGISImageUtils(double resDiffThresh)
 	{
 		 this->resDiffThresh = resDiffThresh;
+		 this->expectedRATRows = 0;
 	}
 
     void RSGISImageUtils::snap2ImageGrid(GDALDataset *dataset, OGREnvelope *env)
@@ -3361,7 +3363,7 @@ namespace rsgis{namespace img{
 	
 	GDALDataset* RSGISImageUtils::createBlankImage(std::string imageFile, double *transformation, int xSize, int ySize, int numBands, std::string projection, float value, std::string gdalFormat, GDALDataType imgDataType)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		GDALDriver *poDriver = NULL;
 		GDALDataset *outputImage = NULL;
         GDALRasterBand **outputRasterBands = NULL;
@@ -3479,7 +3481,7 @@ namespace rsgis{namespace img{
     
     GDALDataset* RSGISImageUtils::createBlankImage(std::string imageFile, double *transformation, int xSize, int ySize, int numBands, std::string projection, float value, std::vector<std::string> bandNames, std::string gdalFormat, GDALDataType imgDataType)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		GDALDriver *poDriver = NULL;
 		GDALDataset *outputImage = NULL;
         GDALRasterBand **outputRasterBands = NULL;
@@ -3597,7 +3599,7 @@ namespace rsgis{namespace img{
 	
 	GDALDataset* RSGISImageUtils::createBlankImage(std::string imageFile, OGREnvelope extent, double resolution, int numBands, std::string projection, float value, std::string gdalFormat, GDALDataType imgDataType)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		GDALDriver *poDriver = NULL;
 		GDALDataset *outputImage = NULL;
 		
@@ -3698,7 +3700,7 @@ namespace rsgis{namespace img{
 	
 	void RSGISImageUtils::exportImageBands(std::string imageFile, std::string outputFilebase, std::string format)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		GDALDataset *dataset = NULL;
 		GDALDriver *gdalDriver = NULL;
 		GDALRasterBand *inputImgBand = NULL;
@@ -3782,7 +3784,7 @@ namespace rsgis{namespace img{
 	
 	void RSGISImageUtils::exportImageStack(std::string *inputImages, std::string *outputImages, std::string outputFormat, int numImages) 
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		GDALDataset **inDatasets = NULL;
 		GDALDriver *gdalDriver = NULL;
 		GDALDataset *outputImageDS = NULL;
@@ -3877,7 +3879,7 @@ namespace rsgis{namespace img{
 	
 	void RSGISImageUtils::exportImageStackWithMask(std::string *inputImages, std::string *outputImages, std::string imageMask, std::string outputFormat, int numImages, float maskValue) 
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		GDALDataset **inDatasets = NULL;
 		GDALDriver *gdalDriver = NULL;
 		GDALDataset *outputImageDS = NULL;
@@ -3997,7 +3999,7 @@ namespace rsgis{namespace img{
 	
 	void RSGISImageUtils::convertImageFileFormat(std::string inputImage, std::string outputImage, std::string outputImageFormat, bool projFromImage, std::string wktProjStr)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		GDALDataset *inDataset = NULL;
 		GDALDriver *gdalDriver = NULL;
 		GDALDataset *outDataset = NULL;
@@ -4161,7 +4163,7 @@ namespace rsgis{namespace img{
                 
                 for(unsigned int i = 0; i < bufSize; ++i)
                 {
-                    if(noDataValDefined && (imgData[i] != noDataVal))
+                    if((!noDataValDefined) || (imgData[i] != noDataVal))
                     {
                         imgVals->push_back(imgData[i]);
                     }
@@ -4178,7 +4180,7 @@ namespace rsgis{namespace img{
                 
                 for(unsigned int i = 0; i < bufSize; ++i)
                 {
-                    if(noDataValDefined && (imgData[i] != noDataVal))
+                    if((!noDataValDefined) || (imgData[i] != noDataVal))
                     {
                         imgVals->push_back(imgData[i]);
                     }
@@ -4206,7 +4208,7 @@ namespace rsgis{namespace img{
 	
 	void RSGISImageUtils::copyImageRemoveSpatialReference(std::string inputImage, std::string outputImage)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		GDALDataset *inDataset = NULL;
 		GDALDriver *gdalDriver = NULL;
 		GDALDataset *outDataset = NULL;
@@ -4307,7 +4309,7 @@ namespace rsgis{namespace img{
 
 	void RSGISImageUtils::copyImageDefiningSpatialReference(std::string inputImage, std::string outputImage, std::string proj, double tlX, double tlY, float xRes, float yRes)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		GDALDataset *inDataset = NULL;
 		GDALDriver *gdalDriver = NULL;
 		GDALDataset *outDataset = NULL;
@@ -4642,6 +4644,57 @@ namespace rsgis{namespace img{
         }
     }
     
+    void RSGISImageUtils::copyUInt64GDALDataset(GDALDataset *inData, GDALDataset *outData)
+    {
+        try
+        {
+            // Change dimensions are the same.
+            if(inData->GetRasterXSize() != outData->GetRasterXSize())
+            {
+                throw RSGISImageException("Widths are not the same");
+            }
+            if(inData->GetRasterYSize() != outData->GetRasterYSize())
+            {
+                throw RSGISImageException("Heights are not the same");
+            }
+            if(inData->GetRasterCount() != outData->GetRasterCount())
+            {
+                throw RSGISImageException("Number of bands are not the same");
+            }
+            
+            unsigned long width = inData->GetRasterXSize();
+            unsigned long height = inData->GetRasterYSize();
+            unsigned int numBands = inData->GetRasterCount();
+            
+            GDALRasterBand **inputRasterBands = new GDALRasterBand*[numBands];
+            GDALRasterBand **outputRasterBands = new GDALRasterBand*[numBands];
+            uint64_t *data = new uint64_t[width];
+            
+            for(unsigned int n = 0; n < numBands; ++n)
+            {
+                inputRasterBands[n] = inData->GetRasterBand(n+1);
+                outputRasterBands[n] = outData->GetRasterBand(n+1);
+            }
+            
+            for(unsigned long y = 0; y < height; ++y)
+            {
+                for(unsigned int n = 0; n < numBands; ++n)
+                {
+                    inputRasterBands[n]->RasterIO(GF_Read, 0, y, width, 1, data, width, 1, GDT_UInt64, 0, 0);
+                    outputRasterBands[n]->RasterIO(GF_Write, 0, y, width, 1, data, width, 1, GDT_UInt64, 0, 0);
+                }
+            }
+            
+            delete[] inputRasterBands;
+            delete[] outputRasterBands;
+            delete[] data;
+        }
+        catch(RSGISImageException &e)
+        {
+            throw e;
+        }
+    }
+    
     void RSGISImageUtils::copyFloat32GDALDataset(GDALDataset *inData, GDALDataset *outData)
     {
         try
@@ -5368,7 +5421,7 @@ namespace rsgis{namespace img{
         std::ofstream outKML;
         outKML.open(outKMLFile.c_str());
         
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         GDALDataset *dataset = NULL;
         dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
         
@@ -5801,9 +5854,44 @@ namespace rsgis{namespace img{
     char** RSGISImageUtils::getGDALCreationOptionsForFormat(std::string gdalFormat)
     {
         std::map<std::string, std::string> gdal_creation_options = this->getCreateGDALImgEnvVars(gdalFormat);
+        // The blocks are compressed by a GDAL worker pool for the formats supporting it, unless set by the user.
+        unsigned int compressThreads = rsgis::RSGISExecutionContextUtils::getDefaultContext().compressThreads;
+        if((compressThreads != 1) && RSGISImageUtils::supportsThreadedCompression(gdalFormat) && (gdal_creation_options.count("NUM_THREADS") == 0))
+        {
+            gdal_creation_options["NUM_THREADS"] = (compressThreads == 0)?std::string("ALL_CPUS"):std::to_string(compressThreads);
+        }
+        // The KEA RAT is chunked for the number of rows expected, unless set by the user.
+        if((this->expectedRATRows > 0) && EQUAL(gdalFormat.c_str(), "KEA") && (gdal_creation_options.count("ATTBLOCKSIZE") == 0))
+        {
+            gdal_creation_options["ATTBLOCKSIZE"] = std::to_string(RSGISImageUtils::getKEARATChunkSize(this->expectedRATRows));
+        }
         char **papszOptions = this->getGDALCreationOptions(gdal_creation_options);
         return papszOptions;
     }
+    
+    bool RSGISImageUtils::supportsThreadedCompression(std::string gdalFormat)
+    {
+        return EQUAL(gdalFormat.c_str(), "GTiff") || EQUAL(gdalFormat.c_str(), "COG");
+    }
+    
+    void RSGISImageUtils::setExpectedRATRows(size_t numRows)
+    {
+        this->expectedRATRows = numRows;
+    }
+    
+    unsigned int RSGISImageUtils::getKEARATChunkSize(size_t numRows)
+    {
+        // Small tables keep the KEA default, larger tables use fewer, larger chunks.
+        if(numRows > 10000000)
+        {
+            return 100000;
+        }
+        else if(numRows > 100000)
+        {
+            return 10000;
+        }
+        return 1000;
+    }
 
 	RSGISImageUtils::~RSGISImageUtils()
 	{
@@ -41,6 +41,7 @@
 
 #include "common/RSGISImageException.h"
 #include "common/RSGISOutputStreamException.h"
+#include "common/RSGISExecutionContext.h"
 
 #include "utils/RSGISTextUtils.h"
 
@@ -183,6 +184,7 @@ namespace rsgis
                 void copyFloatGDALDataset(GDALDataset *inData, GDALDataset *outData);
                 void copyIntGDALDataset(GDALDataset *inData, GDALDataset *outData);
                 void copyUIntGDALDataset(GDALDataset *inData, GDALDataset *outData);
+                void copyUInt64GDALDataset(GDALDataset *inData, GDALDataset *outData);
                 void copyFloat32GDALDataset(GDALDataset *inData, GDALDataset *outData);
                 void copyByteGDALDataset(GDALDataset *inData, GDALDataset *outData);
                 void zerosUIntGDALDataset(GDALDataset *data);
@@ -205,10 +207,30 @@ namespace rsgis
                 void setImageBandNames(GDALDataset *dataset, std::vector<std::string> bandNames, bool quiet=false);
                 std::map<std::string, std::string> getCreateGDALImgEnvVars(std::string gdalFormat);
                 char** getGDALCreationOptions(std::map<std::string, std::string> gdal_creation_options);
+                /**
+                 * Get the creation options for the format from the RSGISLIB_IMG_CRT_OPTS_<FORMAT> environment
+                 * variable. NUM_THREADS is added for the formats which compress blocks on multiple threads
+                 * if the compressThreads of the default execution context is not 1.
+                 */
                 char** getGDALCreationOptionsForFormat(std::string gdalFormat);
+                /** Returns true if the GDAL driver for the format compresses blocks on the threads given by NUM_THREADS. */
+                static bool supportsThreadedCompression(std::string gdalFormat);
+                /**
+                 * Set the number of rows expected in the RATs of the KEA images created by this object.
+                 * The KEA RAT chunk size (ATTBLOCKSIZE) is then chosen for that number of rows, unless
+                 * it is set in RSGISLIB_IMG_CRT_OPTS_KEA. 0 (the default) leaves the KEA default.
+                 */
+                void setExpectedRATRows(size_t numRows);
+                /**
+                 * Get the KEA RAT chunk size (rows) suited to a RAT of numRows rows. The sizes divide
+                 * RAT_BLOCK_LENGTH (see rastergis/RSGISRasterAttUtils.h) so the blocks of rows read
+                 * and written by the RAT functions are aligned with the chunks.
+                 */
+                static unsigned int getKEARATChunkSize(size_t numRows);
                 ~RSGISImageUtils();
 			private:
                 double resDiffThresh; // Maximum difference between image resolutions (as a fraction).
+                size_t expectedRATRows; // Number of RAT rows expected in the KEA images created (0 is unknown).
 			};
         
         
@@ -275,6 +275,32 @@ namespace rsgis{namespace img{
     
     
     RSGISCalcImage2ImageCorrelation::~RSGISCalcImage2ImageCorrelation(){}
+
+    RSGISCalcWindowSumsCorrelation::RSGISCalcWindowSumsCorrelation() : RSGISCalcWindowSumsValue(1)
+    {
+
+    }
+
+    void RSGISCalcWindowSumsCorrelation::calcWindowValue(const RSGISWindowSums &sums, double *output)
+    {
+        if((sums.numBands != 2) | sums.sumProds.empty())
+        {
+            throw rsgis::img::RSGISImageCalcException("The window correlation needs the sums and products of two bands.");
+        }
+
+        double nPixels = sums.n;
+        double sumR = sums.sums[0];
+        double sumF = sums.sums[1];
+        float blockCorrelation = 0;
+        if(nPixels > 1.5)
+        {
+            blockCorrelation = (((nPixels * sums.getSumProd(0, 1)) - (sumR * sumF))/sqrt(((nPixels*sums.getSumProd(0, 0))-(sumR*sumR))*((nPixels*sums.getSumProd(1, 1))-(sumF*sumF))));
+        }
+        if( !(boost::math::isfinite)(blockCorrelation)){blockCorrelation = 0;}
+        output[0] = blockCorrelation;
+    }
+
+    RSGISCalcWindowSumsCorrelation::~RSGISCalcWindowSumsCorrelation(){}
 	
 }}
 
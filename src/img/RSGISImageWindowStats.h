@@ -34,6 +34,7 @@
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcCovariance.h"
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISImageWindowSums.h"
 
 #include <gsl/gsl_matrix.h>
 #include <gsl/gsl_vector.h>
@@ -99,6 +100,18 @@ namespace rsgis{namespace img{
         unsigned int bandA;
         unsigned int bandB;
     };
+
+    /** The same correlation as RSGISCalcImage2ImageCorrelation from the window sums
+        (see RSGISVirtualImageWindowSums) of the two bands, with the products.
+     */
+    class DllExport RSGISCalcWindowSumsCorrelation: public RSGISCalcWindowSumsValue
+    {
+    public:
+        RSGISCalcWindowSumsCorrelation();
+        void calcWindowValue(const RSGISWindowSums &sums, double *output);
+        RSGISCalcWindowSumsValue* clone(){return new RSGISCalcWindowSumsCorrelation();};
+        ~RSGISCalcWindowSumsCorrelation();
+    };
     
     
 }}
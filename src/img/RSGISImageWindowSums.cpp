@@ -0,0 +1,241 @@
+/*
+ *  RSGISImageWindowSums.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISImageWindowSums.h"
+
+namespace rsgis{namespace img{
+
+    RSGISVirtualImageWindowSums::RSGISVirtualImageWindowSums(RSGISVirtualImageNode *input, RSGISCalcWindowSumsValue *calc, int windowSize, std::vector<unsigned int> bands, bool calcProducts) : RSGISVirtualImageNode()
+    {
+        if((input == NULL) || (calc == NULL))
+        {
+            throw RSGISImageCalcException("A virtual image calculation needs an input and a calculation.");
+        }
+        if(windowSize % 2 == 0)
+        {
+            throw RSGISImageCalcException("Window size needs to be an odd number (min = 3).");
+        }
+        else if(windowSize < 3)
+        {
+            throw RSGISImageCalcException("Window size needs to be 3 or greater and an odd number.");
+        }
+        if(bands.empty())
+        {
+            throw RSGISImageCalcException("At least one band is needed to calculate the window sums.");
+        }
+        for(std::vector<unsigned int>::iterator iterBand = bands.begin(); iterBand != bands.end(); ++iterBand)
+        {
+            if((*iterBand) >= ((unsigned int)input->getNumBands()))
+            {
+                throw RSGISImageCalcException("Requested band not in image");
+            }
+        }
+        this->input = input;
+        this->calc = calc;
+        this->windowSize = windowSize;
+        this->bands = bands;
+        this->calcProducts = calcProducts;
+        size_t numSumBands = bands.size();
+        this->numSums = 1 + numSumBands;
+        if(calcProducts)
+        {
+            this->numSums += (numSumBands * (numSumBands + 1)) / 2;
+        }
+        this->setGeometry(input);
+        this->numBands = calc->getNumOutBands();
+
+        unsigned int numThreads = rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads;
+        this->threadPool = new RSGISThreadPool(numThreads);
+        this->threadCalcs.push_back(calc);
+        for(unsigned int t = 1; t < this->threadPool->getNumThreads(); ++t)
+        {
+            RSGISCalcWindowSumsValue *threadCalc = calc->clone();
+            if(threadCalc == NULL)
+            {
+                for(size_t i = 1; i < this->threadCalcs.size(); ++i)
+                {
+                    delete this->threadCalcs[i];
+                }
+                this->threadCalcs.resize(1);
+                delete this->threadPool;
+                this->threadPool = new RSGISThreadPool(1);
+                break;
+            }
+            this->threadCalcs.push_back(threadCalc);
+        }
+    }
+
+    void RSGISVirtualImageWindowSums::readBlock(const RSGISVirtualImageBlock &block, float **bandData)
+    {
+        int windowMid = this->windowSize / 2;
+        RSGISVirtualImageBlock padBlock;
+        padBlock.xOff = block.xOff - windowMid;
+        padBlock.yOff = block.yOff - windowMid;
+        padBlock.xSize = block.xSize + (2 * windowMid);
+        padBlock.ySize = block.ySize + (2 * windowMid);
+        size_t padWidth = padBlock.xSize;
+
+        int numInBands = this->input->getNumBands();
+        this->inVals.resize(numInBands);
+        std::vector<float*> inPtrs(numInBands);
+        for(int n = 0; n < numInBands; ++n)
+        {
+            this->inVals[n].resize(padWidth * padBlock.ySize);
+            inPtrs[n] = this->inVals[n].data();
+        }
+        this->input->readBlock(padBlock, inPtrs.data());
+
+        // Each chunk of rows starts its own running sums, so the threads are independent.
+        this->threadPool->parallelFor(0, block.ySize, [&](unsigned int t, size_t rowStart, size_t rowEnd)
+        {
+            this->calcBlockRows(this->threadCalcs[t], block, padWidth, rowStart, rowEnd, bandData);
+        });
+        this->zeroOutsideImage(block, bandData);
+    }
+
+    void RSGISVirtualImageWindowSums::calcBlockRows(RSGISCalcWindowSumsValue *rowCalc, const RSGISVirtualImageBlock &block, size_t padWidth, size_t rowStart, size_t rowEnd, float **bandData)
+    {
+        size_t numSumBands = this->bands.size();
+        size_t numSums = this->numSums;
+        std::vector<double> colSums(padWidth * numSums, 0.0);
+        std::vector<double> rowPrefix((padWidth + 1) * numSums, 0.0);
+        std::vector<double> pxlVals(numSumBands);
+        std::vector<const float*> rowVals(numSumBands);
+        std::vector<double> outVals(this->numBands);
+
+        RSGISWindowSums winSums;
+        winSums.numBands = numSumBands;
+        winSums.sums.resize(numSumBands);
+        if(this->calcProducts)
+        {
+            winSums.sumProds.resize(numSums - 1 - numSumBands);
+        }
+
+        // The padded row of the block for output row y is y (the top of the window).
+        auto setRowVals = [&](size_t padRow)
+        {
+            for(size_t b = 0; b < numSumBands; ++b)
+            {
+                rowVals[b] = this->inVals[this->bands[b]].data() + (padRow * padWidth);
+            }
+        };
+
+        for(size_t j = 0; j < ((size_t)this->windowSize); ++j)
+        {
+            setRowVals(rowStart + j);
+            this->addWindowRow(rowVals.data(), padWidth, 1.0, colSums.data(), pxlVals);
+        }
+
+        for(size_t y = rowStart; y < rowEnd; ++y)
+        {
+            if(y > rowStart)
+            {
+                setRowVals(y - 1);
+                this->addWindowRow(rowVals.data(), padWidth, -1.0, colSums.data(), pxlVals);
+                setRowVals(y + (this->windowSize - 1));
+                this->addWindowRow(rowVals.data(), padWidth, 1.0, colSums.data(), pxlVals);
+            }
+
+            for(size_t x = 0; x < padWidth; ++x)
+            {
+                const double *colVals = colSums.data() + (x * numSums);
+                const double *prevVals = rowPrefix.data() + (x * numSums);
+                double *nextVals = rowPrefix.data() + ((x + 1) * numSums);
+                for(size_t q = 0; q < numSums; ++q)
+                {
+                    nextVals[q] = prevVals[q] + colVals[q];
+                }
+            }
+
+            for(size_t x = 0; x < ((size_t)block.xSize); ++x)
+            {
+                const double *leftVals = rowPrefix.data() + (x * numSums);
+                const double *rightVals = rowPrefix.data() + ((x + this->windowSize) * numSums);
+                winSums.n = rightVals[0] - leftVals[0];
+                for(size_t b = 0; b < numSumBands; ++b)
+                {
+                    winSums.sums[b] = rightVals[1 + b] - leftVals[1 + b];
+                }
+                for(size_t p = 0; p < winSums.sumProds.size(); ++p)
+                {
+                    winSums.sumProds[p] = rightVals[1 + numSumBands + p] - leftVals[1 + numSumBands + p];
+                }
+                rowCalc->calcWindowValue(winSums, outVals.data());
+                for(int n = 0; n < this->numBands; ++n)
+                {
+                    bandData[n][(y * block.xSize) + x] = outVals[n];
+                }
+            }
+        }
+    }
+
+    void RSGISVirtualImageWindowSums::addWindowRow(const float *const *rowVals, size_t padWidth, double sign, double *colSums, std::vector<double> &pxlVals)
+    {
+        size_t numSumBands = this->bands.size();
+        for(size_t x = 0; x < padWidth; ++x)
+        {
+            bool valid = true;
+            for(size_t b = 0; b < numSumBands; ++b)
+            {
+                pxlVals[b] = rowVals[b][x];
+                if(!std::isfinite(pxlVals[b]))
+                {
+                    valid = false;
+                    break;
+                }
+            }
+            if(!valid)
+            {
+                continue;
+            }
+
+            double *colVals = colSums + (x * this->numSums);
+            colVals[0] += sign;
+            for(size_t b = 0; b < numSumBands; ++b)
+            {
+                colVals[1 + b] += sign * pxlVals[b];
+            }
+            if(this->calcProducts)
+            {
+                size_t p = 1 + numSumBands;
+                for(size_t i = 0; i < numSumBands; ++i)
+                {
+                    double signVal = sign * pxlVals[i];
+                    for(size_t j = i; j < numSumBands; ++j)
+                    {
+                        colVals[p++] += signVal * pxlVals[j];
+                    }
+                }
+            }
+        }
+    }
+
+    RSGISVirtualImageWindowSums::~RSGISVirtualImageWindowSums()
+    {
+        for(size_t i = 1; i < this->threadCalcs.size(); ++i)
+        {
+            delete this->threadCalcs[i];
+        }
+        delete this->threadPool;
+    }
+
+}}
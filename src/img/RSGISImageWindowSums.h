@@ -0,0 +1,137 @@
+/*
+ *  RSGISImageWindowSums.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISImageWindowSums_H
+#define RSGISImageWindowSums_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISVirtualImage.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+
+    /**
+     * The sums of the valid pixels of a window for a set of bands, where a pixel is
+     * valid if the values of all the bands are finite. The products are only
+     * available if the engine was asked to calculate them. The variance and
+     * covariance are population values (i.e., divided by n).
+     */
+    struct DllExport RSGISWindowSums
+    {
+        unsigned int numBands;
+        double n;
+        /// The sum of each band.
+        std::vector<double> sums;
+        /// The sums of the products of each pair of bands (i <= j) in the order (0,0), (0,1), ..., (1,1), (1,2), ...
+        std::vector<double> sumProds;
+
+        size_t getProdIdx(unsigned int i, unsigned int j) const
+        {
+            if(i > j){std::swap(i, j);}
+            return (((size_t)i) * this->numBands) - ((((size_t)i) * (i - 1)) / 2) + (j - i);
+        };
+        double getSumProd(unsigned int i, unsigned int j) const {return this->sumProds[this->getProdIdx(i, j)];};
+        double getMean(unsigned int i) const {return this->sums[i] / this->n;};
+        double getCovariance(unsigned int i, unsigned int j) const {return (this->getSumProd(i, j) - ((this->sums[i] * this->sums[j]) / this->n)) / this->n;};
+        double getVariance(unsigned int i) const {return this->getCovariance(i, i);};
+    };
+
+    /**
+     * A window calculation which only needs the number of valid pixels and the sums
+     * (and the sums of the products) of the bands within the window, which
+     * RSGISVirtualImageWindowSums calculates in a constant time per pixel whatever
+     * the size of the window.
+     */
+    class DllExport RSGISCalcWindowSumsValue
+    {
+    public:
+        RSGISCalcWindowSumsValue(int numOutBands){this->numOutBands = numOutBands;};
+        int getNumOutBands(){return this->numOutBands;};
+        virtual void calcWindowValue(const RSGISWindowSums &sums, double *output) = 0;
+        /**
+         * Create a copy of the calculation for each worker thread. If the calculation
+         * cannot be used from more than one thread this returns NULL and the engine
+         * runs in a single thread.
+         */
+        virtual RSGISCalcWindowSumsValue* clone(){return NULL;};
+        virtual ~RSGISCalcWindowSumsValue(){};
+    protected:
+        int numOutBands;
+    };
+
+    /**
+     * Applies a RSGISCalcWindowSumsValue to windows of the bands of the input.
+     * For each block the window sums are calculated as a separable summed-area
+     * table: running column sums of the window rows, which are updated by adding
+     * the row entering and subtracting the row leaving the window, and a prefix sum
+     * along each row of the column sums. As with the window engines of RSGISCalcImage,
+     * the pixels outside the image are 0 (and valid). The rows of each block are
+     * split between the threads of the default execution context.
+     */
+    class DllExport RSGISVirtualImageWindowSums : public RSGISVirtualImageNode
+    {
+    public:
+        /**
+         * bands are the (0 based) input bands passed to the calculation, in order,
+         * and if calcProducts is false the sums of the products are not calculated.
+         */
+        RSGISVirtualImageWindowSums(RSGISVirtualImageNode *input, RSGISCalcWindowSumsValue *calc, int windowSize, std::vector<unsigned int> bands, bool calcProducts=true);
+        void readBlock(const RSGISVirtualImageBlock &block, float **bandData);
+        ~RSGISVirtualImageWindowSums();
+    protected:
+        void calcBlockRows(RSGISCalcWindowSumsValue *rowCalc, const RSGISVirtualImageBlock &block, size_t padWidth, size_t rowStart, size_t rowEnd, float **bandData);
+        void addWindowRow(const float *const *rowVals, size_t padWidth, double sign, double *colSums, std::vector<double> &pxlVals);
+        RSGISVirtualImageNode *input;
+        RSGISCalcWindowSumsValue *calc;
+        int windowSize;
+        std::vector<unsigned int> bands;
+        bool calcProducts;
+        unsigned int numSums;
+        std::vector<RSGISCalcWindowSumsValue*> threadCalcs;
+        RSGISThreadPool *threadPool;
+        std::vector< std::vector<float> > inVals;
+    };
+
+}}
+
+#endif
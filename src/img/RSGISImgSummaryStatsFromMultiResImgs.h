@@ -66,6 +66,7 @@ namespace rsgis{namespace img{
     public:
         RSGISCalcHighResImgSummaryStats(int numberOutBands, std::vector<rsgis::math::rsgissummarytype> sumStats);
         void calcImageValue(float *bandValues, int numInVals, bool useNoData, float noDataVal, double *output);
+        rsgis::img::RSGISCalcValuesFromMultiResInputs* clone(){return new RSGISCalcHighResImgSummaryStats(this->getNumOutBands(), this->sumStats);};
         ~RSGISCalcHighResImgSummaryStats();
     protected:
         std::vector<rsgis::math::rsgissummarytype> sumStats;
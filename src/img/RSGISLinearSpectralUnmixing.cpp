@@ -25,12 +25,13 @@
 
 namespace rsgis{namespace img{
 
-    RSGISCalcLinearSpectralUnmixing::RSGISCalcLinearSpectralUnmixing(std::string gdalFormat, GDALDataType gdalDataType, float gain, float offset)
+    RSGISCalcLinearSpectralUnmixing::RSGISCalcLinearSpectralUnmixing(std::string gdalFormat, GDALDataType gdalDataType, float gain, float offset, unsigned int numThreads)
     {
         this->gdalFormat = gdalFormat;
         this->gdalDataType = gdalDataType;
         this->gain = gain;
         this->offset = offset;
+        this->numThreads = numThreads;
     }
 
     void RSGISCalcLinearSpectralUnmixing::performExhaustiveConstrainedSpectralUnmixing(GDALDataset **datasets, int numDatasets, std::string outputImage, std::string endmembersFilePath, float stepResolution)
@@ -59,17 +60,13 @@ namespace rsgis{namespace img{
                 throw RSGISImageCalcException("The number of endmember samples should be less than the number of input image bands.");
             }
             
-            if((endmembersRaw->size2 != 3) & (endmembersRaw->size2 != 2))
-            {
-                throw RSGISImageCalcException("Unmixing is only implemented for 2 or 3 endmembers.");
-            }
-            
             gsl_matrix *endmembersNorm = matrixUtils.normalisedColumnsMatrix(endmembersRaw);
             matrixUtils.printGSLMatrix(endmembersNorm);
             std::cout << std::endl;
             
             RSGISExhaustiveLinearSpectralUnmixing *calcExhaustive = new RSGISExhaustiveLinearSpectralUnmixing(endmembersNorm->size2+1, endmembersNorm, stepResolution, this->gain, this->offset);
             RSGISCalcImage calcImage(calcExhaustive);
+            calcImage.setNumThreads(this->numThreads);
             calcImage.calcImage(datasets, numDatasets, outputImage, false, NULL, gdalFormat, gdalDataType);
             
             delete calcExhaustive;
@@ -89,212 +86,251 @@ namespace rsgis{namespace img{
     
     RSGISExhaustiveLinearSpectralUnmixing::RSGISExhaustiveLinearSpectralUnmixing(int numberOutBands, gsl_matrix *endmembers, float stepRes, float gain, float offset):RSGISCalcImageValue(numberOutBands)
     {
+        if(!(stepRes > 0) || (stepRes > 1))
+        {
+            throw RSGISImageCalcException("The step resolution must be greater than 0 and no more than 1.");
+        }
         this->endmembers = endmembers;
         this->stepRes = stepRes;
         this->numOfEndMembers = endmembers->size2;
         this->gain = gain;
         this->offset = offset;
-    }
-    
-    void RSGISExhaustiveLinearSpectralUnmixing::calcImageValue(float *bandValues, int numBands, double *output) 
-    {
-        // All values have to be greater than zero.
-        
-        // Find the linear combination which is closest to 1 but less than 1. 
-        
-        // Also find the linear combination which is closest to 1 but greater than 1.
-        
-        // Provide option to except greater than 1 if closer result than less than 1 and under some threshold.
         
+        // The fraction of each step, accumulated as floats (as the search always has been).
         unsigned int numOfSteps = (1/this->stepRes)+1;
-        
         float threshold = 1 + this->stepRes;
+        std::vector<float> stepVals(numOfSteps);
+        float stepVal = 0;
+        for(unsigned int i = 0; i < numOfSteps; ++i)
+        {
+            stepVals[i] = stepVal;
+            stepVal += this->stepRes;
+        }
+        std::vector<float> emVals(this->numOfEndMembers);
+        this->addCombinations(0, 0, &emVals, &stepVals, threshold);
+        this->numCombs = this->combVals.size() / this->numOfEndMembers;
+        
+        unsigned int numBands = endmembers->size1;
+        this->endmembersTrans.resize(this->numOfEndMembers * numBands);
+        for(unsigned int i = 0; i < numBands; ++i)
+        {
+            for(unsigned int e = 0; e < this->numOfEndMembers; ++e)
+            {
+                this->endmembersTrans[(e * numBands) + i] = gsl_matrix_get(endmembers, i, e);
+            }
+        }
         
-        float *normBandVals = new float[numBands];
+        // E'E and then a'(E'E)a for each combination.
+        std::vector<double> emGram(this->numOfEndMembers * this->numOfEndMembers, 0.0);
+        for(unsigned int e1 = 0; e1 < this->numOfEndMembers; ++e1)
+        {
+            for(unsigned int e2 = 0; e2 < this->numOfEndMembers; ++e2)
+            {
+                for(unsigned int i = 0; i < numBands; ++i)
+                {
+                    emGram[(e1 * this->numOfEndMembers) + e2] += this->endmembersTrans[(e1 * numBands) + i] * this->endmembersTrans[(e2 * numBands) + i];
+                }
+            }
+        }
+        this->combMatrix.assign(this->combVals.begin(), this->combVals.end());
+        this->combQuad.assign(this->numCombs, 0.0);
+        for(size_t c = 0; c < this->numCombs; ++c)
+        {
+            const double *comb = &this->combMatrix[c * this->numOfEndMembers];
+            for(unsigned int e1 = 0; e1 < this->numOfEndMembers; ++e1)
+            {
+                for(unsigned int e2 = 0; e2 < this->numOfEndMembers; ++e2)
+                {
+                    this->combQuad[c] += comb[e1] * emGram[(e1 * this->numOfEndMembers) + e2] * comb[e2];
+                }
+            }
+        }
         
-        double sqSum = 0;
+        // Limit the size of the block of scores (pixels x combinations).
+        this->blockPxls = std::max((size_t)1, std::min((size_t)RSGIS_LSU_BLOCK_PXLS, RSGIS_LSU_MAX_BLOCK_SCORES / this->numCombs));
+        this->genSpectra.resize(numBands);
+    }
+    
+    void RSGISExhaustiveLinearSpectralUnmixing::calcImageValue(float *bandValues, int numBands, double *output) 
+    {
+        std::vector<const float*> bands(numBands);
         for(int i = 0; i < numBands; ++i)
         {
-            sqSum += (bandValues[i]*bandValues[i]);
+            bands[i] = &bandValues[i];
+        }
+        std::vector<double*> outBands(this->numOutBands);
+        for(int i = 0; i < this->numOutBands; ++i)
+        {
+            outBands[i] = &output[i];
+        }
+        this->calcImageBlock(bands.data(), numBands, 1, outBands.data());
+    }
+    
+    bool RSGISExhaustiveLinearSpectralUnmixing::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        if(((unsigned int)numBands) != this->endmembers->size1)
+        {
+            throw RSGISImageCalcException("The number of image bands and wavelengths within the endmemebers should match.");
         }
         
-        float normVal = sqrt(sqSum);
+        // Allows for the rounding of the float distances of the per pixel search, which are summed over the bands.
+        const double relTol = 1e-5 + (numBands * 1.2e-7);
+        const double absTol = 1e-6;
         
-        if(this->numOfEndMembers == 2)
+        for(size_t blockStart = 0; blockStart < nPxls; blockStart += this->blockPxls)
         {
-            float em1Val = 0;
-            float em2Val = 0;
-            
-            bool first = true;
-            float distVal = 0;
-            float minError = 0;
-            float minEM1Val = 0;
-            float minEM2Val = 0;
+            size_t nBlockPxls = std::min((size_t)this->blockPxls, nPxls - blockStart);
+            this->blockNormVals.resize(nBlockPxls * numBands);
+            this->blockSpectra.resize(numBands * nBlockPxls);
+            std::vector<bool> pxlValid(nBlockPxls, false);
+            std::vector<double> pxlSqSum(nBlockPxls, 0.0);
             
-            if( normVal > 0)
+            for(size_t p = 0; p < nBlockPxls; ++p)
             {
+                double sqSum = 0;
                 for(int i = 0; i < numBands; ++i)
                 {
-                    normBandVals[i] = bandValues[i]/normVal;
+                    float bandVal = bands[i][blockStart + p];
+                    sqSum += (bandVal*bandVal);
                 }
-                
-                for(unsigned int i = 0; i < numOfSteps; ++i)
+                float normVal = sqrt(sqSum);
+                pxlValid[p] = (normVal > 0);
+                for(int i = 0; i < numBands; ++i)
                 {
-                    em2Val = 0;
-                    for(unsigned int j = 0; j < numOfSteps; ++j)
-                    {
-                        if((em1Val+em2Val) < threshold)
-                        {
-                            distVal = this->calcDistance2MeasuredSpectra(em1Val, em2Val, normBandVals, numBands);
-                            
-                            if(first)
-                            {
-                                minError = distVal;
-                                minEM1Val = em1Val;
-                                minEM2Val = em2Val;
-                                first = false;
-                            }
-                            else if(distVal < minError)
-                            {
-                                minError = distVal;
-                                minEM1Val = em1Val;
-                                minEM2Val = em2Val;
-                            }
-                        }
-                        em2Val += this->stepRes;
-                    }
-                    em1Val += this->stepRes;
+                    float normBandVal = pxlValid[p]?(bands[i][blockStart + p]/normVal):0;
+                    this->blockNormVals[(p * numBands) + i] = normBandVal;
+                    this->blockSpectra[(i * nBlockPxls) + p] = normBandVal;
+                    pxlSqSum[p] += ((double)normBandVal) * normBandVal;
                 }
             }
             
-            if(!first)
-            {
-                output[0] = offset + (minEM1Val * gain);
-                output[1] = offset + (minEM2Val * gain);
-                output[2] = offset + (minError * gain);
-            }
-            else
-            {
-                output[0] = 0;
-                output[1] = 0;
-                output[2] = 0;
-            }
-        }
-        else if(this->numOfEndMembers == 3)
-        {
-            float em1Val = 0;
-            float em2Val = 0;
-            float em3Val = 0;
+            // E's for each pixel and then a'(E's) for each pixel and combination.
+            this->blockProj.resize(this->numOfEndMembers * nBlockPxls);
+            this->blockScores.resize(nBlockPxls * this->numCombs);
+            gsl_matrix_const_view emTransMatrix = gsl_matrix_const_view_array(this->endmembersTrans.data(), this->numOfEndMembers, numBands);
+            gsl_matrix_const_view spectraMatrix = gsl_matrix_const_view_array(this->blockSpectra.data(), numBands, nBlockPxls);
+            gsl_matrix_view projMatrix = gsl_matrix_view_array(this->blockProj.data(), this->numOfEndMembers, nBlockPxls);
+            gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, &emTransMatrix.matrix, &spectraMatrix.matrix, 0.0, &projMatrix.matrix);
+            gsl_matrix_const_view combsMatrix = gsl_matrix_const_view_array(this->combMatrix.data(), this->numCombs, this->numOfEndMembers);
+            gsl_matrix_view scoresMatrix = gsl_matrix_view_array(this->blockScores.data(), nBlockPxls, this->numCombs);
+            gsl_blas_dgemm(CblasTrans, CblasTrans, 1.0, &projMatrix.matrix, &combsMatrix.matrix, 0.0, &scoresMatrix.matrix);
             
-            bool first = true;
-            float distVal = 0;
-            float minError = 0;
-            float minEM1Val = 0;
-            float minEM2Val = 0;
-            float minEM3Val = 0;
-                        
-            if( normVal > 0)
+            for(size_t p = 0; p < nBlockPxls; ++p)
             {
-                for(int i = 0; i < numBands; ++i)
+                size_t pxl = blockStart + p;
+                if(!pxlValid[p])
+                {
+                    for(int n = 0; n < this->numOutBands; ++n)
+                    {
+                        output[n][pxl] = 0;
+                    }
+                    continue;
+                }
+                
+                const double *scores = &this->blockScores[p * this->numCombs];
+                double minSqDist = 0;
+                for(size_t c = 0; c < this->numCombs; ++c)
                 {
-                    normBandVals[i] = bandValues[i]/normVal;
+                    double sqDist = this->combQuad[c] - (2 * scores[c]);
+                    if((c == 0) || (sqDist < minSqDist))
+                    {
+                        minSqDist = sqDist;
+                    }
                 }
+                double minDist = sqrt(std::max(minSqDist + pxlSqSum[p], 0.0) / numBands);
+                double thresDist = (minDist * (1 + relTol)) + absTol;
+                double thresSqDist = (thresDist * thresDist * numBands) - pxlSqSum[p];
                 
-                for(unsigned int i = 0; i < numOfSteps; ++i)
+                // Evaluate the candidate combinations as the per pixel search, in the same order.
+                const float *normBandVals = &this->blockNormVals[p * numBands];
+                bool first = true;
+                float distVal = 0;
+                float minError = 0;
+                size_t minComb = 0;
+                for(size_t c = 0; c < this->numCombs; ++c)
                 {
-                    em2Val = 0;
-                    for(unsigned int j = 0; j < numOfSteps; ++j)
+                    if((this->combQuad[c] - (2 * scores[c])) <= thresSqDist)
                     {
-                        em3Val = 0;
-                        for(unsigned int k = 0; k < numOfSteps; ++k)
+                        distVal = this->calcDistance2MeasuredSpectra(&this->combVals[c * this->numOfEndMembers], normBandVals, numBands);
+                        if(first || (distVal < minError))
                         {
-                            if((em1Val+em2Val+em3Val) < threshold)
-                            {
-                                distVal = this->calcDistance2MeasuredSpectra(em1Val, em2Val, em3Val, normBandVals, numBands);
-                                
-                                if(first)
-                                {
-                                    minError = distVal;
-                                    minEM1Val = em1Val;
-                                    minEM2Val = em2Val;
-                                    minEM3Val = em3Val;
-                                    first = false;
-                                }
-                                else if(distVal < minError)
-                                {
-                                    minError = distVal;
-                                    minEM1Val = em1Val;
-                                    minEM2Val = em2Val;
-                                    minEM3Val = em3Val; 
-                                }
-                            }
-                            em3Val += this->stepRes;
+                            minError = distVal;
+                            minComb = c;
+                            first = false;
                         }
-                        em2Val += this->stepRes;
                     }
-                    em1Val += this->stepRes;
                 }
-            }
-            
-            if(!first)
-            {
-                output[0] = offset + (minEM1Val * gain);
-                output[1] = offset + (minEM2Val * gain);
-                output[2] = offset + (minEM3Val * gain);
-                output[3] = offset + (minError * gain);
-            }
-            else
-            {
-                output[0] = 0;
-                output[1] = 0;
-                output[2] = 0;
-                output[3] = 0;
+                if(first)
+                {
+                    // The distances were not finite so search all the combinations.
+                    for(size_t c = 0; c < this->numCombs; ++c)
+                    {
+                        distVal = this->calcDistance2MeasuredSpectra(&this->combVals[c * this->numOfEndMembers], normBandVals, numBands);
+                        if(first || (distVal < minError))
+                        {
+                            minError = distVal;
+                            minComb = c;
+                            first = false;
+                        }
+                    }
+                }
+                
+                const float *minEMVals = &this->combVals[minComb * this->numOfEndMembers];
+                for(unsigned int e = 0; e < this->numOfEndMembers; ++e)
+                {
+                    output[e][pxl] = offset + (minEMVals[e] * gain);
+                }
+                output[this->numOfEndMembers][pxl] = offset + (minError * gain);
             }
         }
-        else
-        {
-            throw RSGISImageCalcException("Unmixing is only implemented for 3 endmembers.");
-        }
-                
-        delete[] normBandVals;
+        return true;
     }
     
-    float RSGISExhaustiveLinearSpectralUnmixing::calcDistance2MeasuredSpectra(float em1Val, float em2Val, float em3Val, float *normSpectra, unsigned int numBands) 
+    RSGISCalcImageValue* RSGISExhaustiveLinearSpectralUnmixing::clone()
     {
-        float *genSpectra = new float[numBands];
-        for(unsigned int i = 0; i < numBands; ++i)
-        {
-            genSpectra[i] = (gsl_matrix_get(endmembers, i, 0) * em1Val) + (gsl_matrix_get(endmembers, i, 1) * em2Val) + (gsl_matrix_get(endmembers, i, 2) * em3Val);
-        }
-        
-        float errorVal = 0;
-        for(unsigned int i = 0; i < numBands; ++i)
+        return new RSGISExhaustiveLinearSpectralUnmixing(this->numOutBands, this->endmembers, this->stepRes, this->gain, this->offset);
+    }
+    
+    void RSGISExhaustiveLinearSpectralUnmixing::addCombinations(unsigned int emIdx, float sumVal, std::vector<float> *emVals, std::vector<float> *stepVals, float threshold)
+    {
+        for(unsigned int i = 0; i < stepVals->size(); ++i)
         {
-            errorVal += ((genSpectra[i] - normSpectra[i])*(genSpectra[i] - normSpectra[i]));
+            float emSum = sumVal + stepVals->at(i);
+            if(!(emSum < threshold))
+            {
+                // The steps increase so none of the remaining combinations are within the threshold.
+                break;
+            }
+            emVals->at(emIdx) = stepVals->at(i);
+            if((emIdx + 1) == this->numOfEndMembers)
+            {
+                this->combVals.insert(this->combVals.end(), emVals->begin(), emVals->end());
+            }
+            else
+            {
+                this->addCombinations(emIdx + 1, emSum, emVals, stepVals, threshold);
+            }
         }
-        
-        delete[] genSpectra;
-        
-        errorVal = sqrt(errorVal/numBands);
-        
-        return errorVal;
     }
     
-    float RSGISExhaustiveLinearSpectralUnmixing::calcDistance2MeasuredSpectra(float em1Val, float em2Val, float *normSpectra, unsigned int numBands) 
+    float RSGISExhaustiveLinearSpectralUnmixing::calcDistance2MeasuredSpectra(const float *emVals, const float *normSpectra, unsigned int numBands) 
     {
-        float *genSpectra = new float[numBands];
+        double genVal = 0;
         for(unsigned int i = 0; i < numBands; ++i)
         {
-            genSpectra[i] = (gsl_matrix_get(endmembers, i, 0) * em1Val) + (gsl_matrix_get(endmembers, i, 1) * em2Val);
+            genVal = 0;
+            for(unsigned int e = 0; e < this->numOfEndMembers; ++e)
+            {
+                genVal += (gsl_matrix_get(endmembers, i, e) * emVals[e]);
+            }
+            this->genSpectra[i] = genVal;
         }
         
         float errorVal = 0;
         for(unsigned int i = 0; i < numBands; ++i)
         {
-            errorVal += ((genSpectra[i] - normSpectra[i])*(genSpectra[i] - normSpectra[i]));
+            errorVal += ((this->genSpectra[i] - normSpectra[i])*(this->genSpectra[i] - normSpectra[i]));
         }
-                
-        delete[] genSpectra;
         
         errorVal = sqrt(errorVal/numBands);
         
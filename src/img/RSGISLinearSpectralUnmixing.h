@@ -26,6 +26,8 @@
 #include <iostream>
 #include <string>
 #include <cmath>
+#include <vector>
+#include <algorithm>
 #include <stdlib.h>
 
 #include "img/RSGISImageCalcException.h"
@@ -61,10 +63,13 @@
 
 namespace rsgis{namespace img{
     
+    static const unsigned int RSGIS_LSU_BLOCK_PXLS( 256 );
+    static const size_t RSGIS_LSU_MAX_BLOCK_SCORES( 1 << 20 );
+    
     class DllExport RSGISCalcLinearSpectralUnmixing
     {
     public:
-        RSGISCalcLinearSpectralUnmixing(std::string gdalFormat="KEA", GDALDataType gdalDataType=GDT_Float32, float gain=1, float offset=0);
+        RSGISCalcLinearSpectralUnmixing(std::string gdalFormat="KEA", GDALDataType gdalDataType=GDT_Float32, float gain=1, float offset=0, unsigned int numThreads=1);
         void performExhaustiveConstrainedSpectralUnmixing(GDALDataset **datasets, int numDatasets, std::string outputImage, std::string endmembersFilePath, float stepResolution);
         ~RSGISCalcLinearSpectralUnmixing();
     protected:
@@ -72,22 +77,49 @@ namespace rsgis{namespace img{
         GDALDataType gdalDataType;
         float gain;
         float offset;
+        unsigned int numThreads;
     };
     
+    /**
+     * Searches the combinations of the endmember fractions, in steps of stepRes
+     * with a sum less than 1 + stepRes, for the combination closest to the
+     * (normalised) pixel spectra. For a block of pixels the squared distances
+     * to all the combinations are found with two matrix multiplications, as
+     * |Ea - s|^2 = a'(E'E)a - 2a'(E's) + s's where a'(E'E)a is calculated once
+     * for each combination. The few combinations within the rounding error of
+     * the closest are then evaluated for the pixel as the original per pixel
+     * search did, so the output is unchanged.
+     */
     class DllExport RSGISExhaustiveLinearSpectralUnmixing : public RSGISCalcImageValue
     {
     public: 
         RSGISExhaustiveLinearSpectralUnmixing(int numberOutBands, gsl_matrix *endmembers, float stepRes, float gain, float offset);
         void calcImageValue(float *bandValues, int numBands, double *output);
+        bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        RSGISCalcImageValue* clone();
         ~RSGISExhaustiveLinearSpectralUnmixing();
     protected:
-        float calcDistance2MeasuredSpectra(float em1Val, float em2Val, float em3Val, float *normSpectra, unsigned int numBands);
-        float calcDistance2MeasuredSpectra(float em1Val, float em2Val, float *normSpectra, unsigned int numBands);
+        void addCombinations(unsigned int emIdx, float sumVal, std::vector<float> *emVals, std::vector<float> *stepVals, float threshold);
+        float calcDistance2MeasuredSpectra(const float *emVals, const float *normSpectra, unsigned int numBands);
         gsl_matrix *endmembers;
         float stepRes;
         unsigned int numOfEndMembers;
         float gain;
         float offset;
+        size_t numCombs;
+        // The endmember fractions of each combination (numCombs x numOfEndMembers).
+        std::vector<float> combVals;
+        std::vector<double> combMatrix;
+        // a'(E'E)a for each combination.
+        std::vector<double> combQuad;
+        // The transposed endmembers (numOfEndMembers x bands).
+        std::vector<double> endmembersTrans;
+        unsigned int blockPxls;
+        std::vector<float> blockNormVals;
+        std::vector<double> blockSpectra;
+        std::vector<double> blockProj;
+        std::vector<double> blockScores;
+        std::vector<float> genSpectra;
     };
     
     
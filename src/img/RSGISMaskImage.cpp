@@ -29,17 +29,127 @@ namespace rsgis{namespace img{
 		
 	}
 	
-	void RSGISMaskImage::maskImage(GDALDataset *dataset, GDALDataset *mask, std::string outputImage, std::string imageFormat, GDALDataType outDataType, double outputValue, std::vector<float> maskValues)
+	void RSGISMaskImage::maskImage(GDALDataset *dataset, GDALDataset *mask, std::string outputImage, std::string imageFormat, GDALDataType outDataType, double outputValue, std::vector<float> maskValues, unsigned int numThreads)
 	{
+        std::vector<double> outputValues(maskValues.size(), outputValue);
+        this->maskImage(dataset, mask, outputImage, imageFormat, outDataType, maskValues, outputValues, numThreads);
+	}
+    
+	void RSGISMaskImage::maskImage(GDALDataset *dataset, GDALDataset *mask, std::string outputImage, std::string imageFormat, GDALDataType outDataType, std::vector<float> maskValues, std::vector<double> outputValues, unsigned int numThreads)
+	{
+        if(maskValues.size() != outputValues.size())
+        {
+            throw RSGISImageCalcException("An output value must be provided for each mask value.");
+        }
+        
 		GDALDataset **datasets = NULL;
 		try
 		{
+            // The output needs to have the same pixel type as the image for it to be masked in its own type.
+            bool nativeType = true;
+            GDALDataType imgType = dataset->GetRasterBand(1)->GetRasterDataType();
+            if(imgType != outDataType)
+            {
+                nativeType = false;
+            }
+            for(int i = 1; i <= dataset->GetRasterCount(); ++i)
+            {
+                if(dataset->GetRasterBand(i)->GetRasterDataType() != imgType)
+                {
+                    nativeType = false;
+                }
+            }
+            
+            // An 8 or 16 bit integer mask can be looked up in a table for any image type.
+            GDALDataType maskType = mask->GetRasterBand(1)->GetRasterDataType();
+            if(nativeType && ((maskType == GDT_Byte) || (maskType == GDT_UInt16)))
+            {
+                bool processed = false;
+                switch(imgType)
+                {
+                    case GDT_Byte:
+                        processed = this->maskImageLUTImgType<uint8_t>(dataset, mask, outputImage, imageFormat, maskValues, outputValues, numThreads);
+                        break;
+                    case GDT_UInt16:
+                        processed = this->maskImageLUTImgType<uint16_t>(dataset, mask, outputImage, imageFormat, maskValues, outputValues, numThreads);
+                        break;
+                    case GDT_Int16:
+                        processed = this->maskImageLUTImgType<int16_t>(dataset, mask, outputImage, imageFormat, maskValues, outputValues, numThreads);
+                        break;
+                    case GDT_UInt32:
+                        processed = this->maskImageLUTImgType<uint32_t>(dataset, mask, outputImage, imageFormat, maskValues, outputValues, numThreads);
+                        break;
+                    case GDT_Int32:
+                        processed = this->maskImageLUTImgType<int32_t>(dataset, mask, outputImage, imageFormat, maskValues, outputValues, numThreads);
+                        break;
+                    case GDT_Float32:
+                        processed = this->maskImageLUTImgType<float>(dataset, mask, outputImage, imageFormat, maskValues, outputValues, numThreads);
+                        break;
+                    case GDT_Float64:
+                        processed = this->maskImageLUTImgType<double>(dataset, mask, outputImage, imageFormat, maskValues, outputValues, numThreads);
+                        break;
+                    default:
+                        processed = false;
+                        break;
+                }
+                if(processed)
+                {
+                    return;
+                }
+            }
+            
 			int numDS = 2;
 			datasets = new GDALDataset*[numDS];
 			datasets[0] = mask;
 			datasets[1] = dataset;
+            
+            // Otherwise, if the mask values can be represented by the image pixel
+            // type, process the data with the native type.
+            for(int i = 1; i <= mask->GetRasterCount(); ++i)
+            {
+                if(GDALDataTypeUnion(mask->GetRasterBand(i)->GetRasterDataType(), imgType) != imgType)
+                {
+                    nativeType = false;
+                }
+            }
+            
+            bool processed = false;
+            if(nativeType)
+            {
+                unsigned int numOutBands = dataset->GetRasterCount();
+                switch(imgType)
+                {
+                    case GDT_Byte:
+                        processed = this->maskImageNativeType<uint8_t>(datasets, numDS, numOutBands, outputImage, imageFormat, maskValues, outputValues, numThreads);
+                        break;
+                    case GDT_UInt16:
+                        processed = this->maskImageNativeType<uint16_t>(datasets, numDS, numOutBands, outputImage, imageFormat, maskValues, outputValues, numThreads);
+                        break;
+                    case GDT_Int16:
+                        processed = this->maskImageNativeType<int16_t>(datasets, numDS, numOutBands, outputImage, imageFormat, maskValues, outputValues, numThreads);
+                        break;
+                    case GDT_UInt32:
+                        processed = this->maskImageNativeType<uint32_t>(datasets, numDS, numOutBands, outputImage, imageFormat, maskValues, outputValues, numThreads);
+                        break;
+                    case GDT_Int32:
+                        processed = this->maskImageNativeType<int32_t>(datasets, numDS, numOutBands, outputImage, imageFormat, maskValues, outputValues, numThreads);
+                        break;
+                    case GDT_Float32:
+                        processed = this->maskImageNativeType<float>(datasets, numDS, numOutBands, outputImage, imageFormat, maskValues, outputValues, numThreads);
+                        break;
+                    default:
+                        processed = false;
+                        break;
+                }
+            }
+            
+            if(processed)
+            {
+                delete[] datasets;
+                return;
+            }
 			
-			RSGISApplyImageMask applyMask = RSGISApplyImageMask(dataset->GetRasterCount(), outputValue, maskValues);
+			RSGISApplyImageMask applyMask = RSGISApplyImageMask(dataset->GetRasterCount(), maskValues, outputValues);
 			RSGISCalcImage calcImg = RSGISCalcImage(&applyMask, "", true);
 			calcImg.calcImage(datasets, numDS, outputImage, false, NULL, imageFormat, outDataType);
 			
@@ -68,13 +178,167 @@ namespace rsgis{namespace img{
 		}
 	}
     
-    void RSGISMaskImage::genFiniteImgMask(GDALDataset *dataset, std::string outputImage, std::string imageFormat)
+    template <typename T> bool RSGISMaskImage::maskImageNativeType(GDALDataset **datasets, int numDS, unsigned int numOutBands, std::string outputImage, std::string imageFormat, std::vector<float> maskValues, std::vector<double> outputValues, unsigned int numThreads)
+    {
+        // Mask values which cannot be represented by the pixel type cannot be within the mask.
+        std::vector<T> maskValuesT;
+        std::vector<T> outputValuesT;
+        for(size_t i = 0; i < maskValues.size(); ++i)
+        {
+            if(!rsgisPixelValueRepresentable<T>(outputValues[i]))
+            {
+                return false;
+            }
+            if(rsgisPixelValueRepresentable<T>(maskValues[i]))
+            {
+                maskValuesT.push_back((T)maskValues[i]);
+                outputValuesT.push_back((T)outputValues[i]);
+            }
+        }
+        
+        RSGISApplyImageMaskT<T> applyMask = RSGISApplyImageMaskT<T>(numOutBands, maskValuesT, outputValuesT);
+        RSGISCalcImageT<T, T> calcImg = RSGISCalcImageT<T, T>(&applyMask);
+        calcImg.setNumThreads(numThreads);
+        calcImg.calcImage(datasets, numDS, outputImage, false, NULL, imageFormat);
+        return true;
+    }
+    
+    template <typename T> bool RSGISMaskImage::maskImageLUTImgType(GDALDataset *dataset, GDALDataset *mask, std::string outputImage, std::string imageFormat, std::vector<float> &maskValues, std::vector<double> &outputValues, unsigned int numThreads)
     {
+        // The table holds the (1-based) index of the output value for each mask value.
+        if(maskValues.size() > 255)
+        {
+            return false;
+        }
+        std::vector<T> outputValuesT;
+        for(std::vector<double>::iterator iterVals = outputValues.begin(); iterVals != outputValues.end(); ++iterVals)
+        {
+            if(!rsgisPixelValueRepresentable<T>(*iterVals))
+            {
+                return false;
+            }
+            outputValuesT.push_back((T)(*iterVals));
+        }
+        
+        if(mask->GetRasterBand(1)->GetRasterDataType() == GDT_Byte)
+        {
+            this->maskImageLUT<uint8_t, T>(dataset, mask, outputImage, imageFormat, maskValues, outputValuesT, numThreads);
+        }
+        else
+        {
+            this->maskImageLUT<uint16_t, T>(dataset, mask, outputImage, imageFormat, maskValues, outputValuesT, numThreads);
+        }
+        return true;
+    }
+    
+    template <typename MaskT, typename T> void RSGISMaskImage::maskImageLUT(GDALDataset *dataset, GDALDataset *mask, std::string outputImage, std::string imageFormat, std::vector<float> &maskValues, std::vector<T> &outputValues, unsigned int numThreads)
+    {
+        // Index 0 is not masked; filled in reverse so the first matching mask value is used.
+        std::vector<uint8_t> maskLUT(((size_t)std::numeric_limits<MaskT>::max()) + 1, 0);
+        std::vector<T> outValsLUT(outputValues.size() + 1, 0);
+        for(size_t n = maskValues.size(); n > 0; --n)
+        {
+            if(rsgisPixelValueRepresentable<MaskT>(maskValues[n-1]))
+            {
+                maskLUT[(MaskT)maskValues[n-1]] = (uint8_t)n;
+            }
+            outValsLUT[n] = outputValues[n-1];
+        }
+        
+        RSGISImageUtils imgUtils;
+        GDALDataset *datasets[2] = {mask, dataset};
+        int dsOffsetVals[4] = {0, 0, 0, 0};
+        int *dsOffsets[2] = {&dsOffsetVals[0], &dsOffsetVals[2]};
+        int width = 0;
+        int height = 0;
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        double gdalTranslation[6];
+        imgUtils.getImageOverlap(datasets, 2, dsOffsets, &width, &height, gdalTranslation, &xBlockSize, &yBlockSize);
+        yBlockSize = std::max(yBlockSize, 1);
+        int stripRows = ((RSGIS_MASKIMG_STRIP_ROWS + yBlockSize - 1) / yBlockSize) * yBlockSize;
+        int numBands = dataset->GetRasterCount();
+        
+        GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(imageFormat.c_str());
+        if(gdalDriver == NULL)
+        {
+            throw RSGISImageBandException("Requested GDAL driver does not exists..");
+        }
+        char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(imageFormat);
+        std::cout << "New image width = " << width << " height = " << height << " bands = " << numBands << std::endl;
+        GDALDataset *outputImageDS = gdalDriver->Create(outputImage.c_str(), width, height, numBands, RSGISGDALDataTypeT<T>::type(), papszOptions);
+        if(outputImageDS == NULL)
+        {
+            throw RSGISImageBandException("Output image could not be created. Check filepath.");
+        }
+        outputImageDS->SetGeoTransform(gdalTranslation);
+        outputImageDS->SetProjection(dataset->GetProjectionRef());
+        
         try
         {
-            RSGISCreateFiniteImageMask createMask = RSGISCreateFiniteImageMask();
-            RSGISCalcImage calcImg = RSGISCalcImage(&createMask, "", true);
-            calcImg.calcImage(&dataset, 1, outputImage, false, NULL, imageFormat, GDT_Byte);
+            size_t stripPxls = ((size_t)width) * stripRows;
+            std::vector<MaskT> maskData(stripPxls);
+            std::vector<uint8_t> maskIdx(stripPxls);
+            std::vector<T> bandData(stripPxls);
+            GDALRasterBand *maskBand = mask->GetRasterBand(1);
+            GDALDataType maskType = RSGISGDALDataTypeT<MaskT>::type();
+            GDALDataType imgType = RSGISGDALDataTypeT<T>::type();
+            rsgis::RSGISThreadPool threadPool(numThreads);
+            
+            rsgis_tqdm pbar;
+            for(int row = 0; row < height; row += stripRows)
+            {
+                pbar.progress(row, height);
+                int nRows = std::min(stripRows, height - row);
+                size_t nPxls = ((size_t)width) * nRows;
+                if(maskBand->RasterIO(GF_Read, dsOffsets[0][0], dsOffsets[0][1] + row, width, nRows, maskData.data(), width, nRows, maskType, 0, 0) != CE_None)
+                {
+                    throw RSGISImageCalcException("Failed to read the input image data.");
+                }
+                // The table is only looked up once per strip rather than for each band.
+                threadPool.parallelFor(0, nPxls, [&](unsigned int t, size_t pStart, size_t pEnd)
+                {
+                    for(size_t i = pStart; i < pEnd; ++i)
+                    {
+                        maskIdx[i] = maskLUT[maskData[i]];
+                    }
+                });
+                
+                for(int n = 0; n < numBands; ++n)
+                {
+                    if(dataset->GetRasterBand(n+1)->RasterIO(GF_Read, dsOffsets[1][0], dsOffsets[1][1] + row, width, nRows, bandData.data(), width, nRows, imgType, 0, 0) != CE_None)
+                    {
+                        throw RSGISImageCalcException("Failed to read the input image data.");
+                    }
+                    threadPool.parallelFor(0, nPxls, [&](unsigned int t, size_t pStart, size_t pEnd)
+                    {
+                        for(size_t i = pStart; i < pEnd; ++i)
+                        {
+                            bandData[i] = (maskIdx[i] != 0)?outValsLUT[maskIdx[i]]:bandData[i];
+                        }
+                    });
+                    if(outputImageDS->GetRasterBand(n+1)->RasterIO(GF_Write, 0, row, width, nRows, bandData.data(), width, nRows, imgType, 0, 0) != CE_None)
+                    {
+                        throw RSGISImageCalcException("Failed to write the output image data.");
+                    }
+                }
+            }
+            pbar.finish();
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            GDALClose(outputImageDS);
+            throw e;
+        }
+        GDALClose(outputImageDS);
+    }
+    
+    void RSGISMaskImage::genFiniteImgMask(GDALDataset *dataset, std::string outputImage, std::string imageFormat, unsigned int numThreads)
+    {
+        try
+        {
+            RSGISImageBitMask bitMask = RSGISImageBitMask(numThreads);
+            bitMask.genFiniteMask(&dataset, 1, outputImage, imageFormat);
         }
         catch(RSGISImageCalcException &e)
         {
@@ -86,13 +350,12 @@ namespace rsgis{namespace img{
         }
     }
     
-    void RSGISMaskImage::genValidImgMask(GDALDataset **dataset, unsigned int numImages, std::string outputImage, std::string imageFormat, float noDataVal)
+    void RSGISMaskImage::genValidImgMask(GDALDataset **dataset, unsigned int numImages, std::string outputImage, std::string imageFormat, float noDataVal, RSGISBitMaskCombine imgCombine, unsigned int numThreads)
     {
         try
         {
-            RSGISGenValidImageMask createMask = RSGISGenValidImageMask(noDataVal);
-            RSGISCalcImage calcImg = RSGISCalcImage(&createMask, "", true);
-            calcImg.calcImage(dataset, numImages, outputImage, false, NULL, imageFormat, GDT_Byte);
+            RSGISImageBitMask bitMask = RSGISImageBitMask(numThreads);
+            bitMask.genValidMask(dataset, numImages, outputImage, imageFormat, noDataVal, imgCombine);
         }
         catch(RSGISImageCalcException &e)
         {
@@ -128,18 +391,26 @@ namespace rsgis{namespace img{
 	
 	RSGISApplyImageMask::RSGISApplyImageMask(int numberOutBands, double outputValue, std::vector<float> maskValues) : RSGISCalcImageValue(numberOutBands)
 	{
-		this->outputValue = outputValue;
         this->maskValues = maskValues;
+        this->outputValues = std::vector<double>(maskValues.size(), outputValue);
+	}
+    
+	RSGISApplyImageMask::RSGISApplyImageMask(int numberOutBands, std::vector<float> maskValues, std::vector<double> outputValues) : RSGISCalcImageValue(numberOutBands)
+	{
+        this->maskValues = maskValues;
+        this->outputValues = outputValues;
 	}
 	
 	void RSGISApplyImageMask::calcImageValue(float *bandValues, int numBands, double *output) 
 	{
         bool foundMaskVal = false;
-        for(std::vector<float>::iterator iterVals = maskValues.begin(); iterVals != maskValues.end(); ++iterVals)
+        double outputValue = 0.0;
+        for(size_t n = 0; n < this->maskValues.size(); ++n)
         {
-            if(bandValues[0] == (*iterVals))
+            if(bandValues[0] == this->maskValues[n])
             {
                 foundMaskVal = true;
+                outputValue = this->outputValues[n];
                 break;
             }
         }
@@ -25,13 +25,18 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "gdal_priv.h"
 
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISCalcImageT.h"
 #include "img/RSGISImageUtils.h"
+#include "img/RSGISImageBitMask.h"
+
+#include "common/RSGISSIMDKernels.h"
 
 #include "boost/math/special_functions/fpclassify.hpp"
 
@@ -49,28 +54,82 @@
 #endif
 
 namespace rsgis{namespace img{
+    
+    /** The minimum number of image rows masked at a time (rounded up to a multiple of the image block height). */
+    static const unsigned int RSGIS_MASKIMG_STRIP_ROWS( 256 );
 	
 	class DllExport RSGISMaskImage
 		{
 		public: 
 			RSGISMaskImage();
-			void maskImage(GDALDataset *dataset, GDALDataset *mask, std::string outputImage, std::string imageFormat, GDALDataType outDataType, double outputValue, std::vector<float> maskValues);
-            void genFiniteImgMask(GDALDataset *dataset, std::string outputImage, std::string imageFormat);
-            void genValidImgMask(GDALDataset **dataset, unsigned int numImages, std::string outputImage, std::string imageFormat, float noDataVal);
+			void maskImage(GDALDataset *dataset, GDALDataset *mask, std::string outputImage, std::string imageFormat, GDALDataType outDataType, double outputValue, std::vector<float> maskValues, unsigned int numThreads=1);
+            /**
+             * Replace the image pixels where the (first band of the) mask is maskValues[i] with
+             * outputValues[i], where the first matching value is used if a mask value is repeated.
+             * Where the mask is 8 or 16 bit unsigned integer and the output has the pixel type
+             * of the image, the mask values are looked up in a table and the image is masked in
+             * its own pixel type, with the pixels of each strip split across numThreads threads.
+             */
+            void maskImage(GDALDataset *dataset, GDALDataset *mask, std::string outputImage, std::string imageFormat, GDALDataType outDataType, std::vector<float> maskValues, std::vector<double> outputValues, unsigned int numThreads=1);
+            void genFiniteImgMask(GDALDataset *dataset, std::string outputImage, std::string imageFormat, unsigned int numThreads=1);
+            void genValidImgMask(GDALDataset **dataset, unsigned int numImages, std::string outputImage, std::string imageFormat, float noDataVal, RSGISBitMaskCombine imgCombine=rsgis_bitmask_and, unsigned int numThreads=1);
             void genImgEdgeMask(GDALDataset *dataset, std::string outputImage, std::string imageFormat, unsigned int nEdgePxls);
+        protected:
+            template <typename T> bool maskImageNativeType(GDALDataset **datasets, int numDS, unsigned int numOutBands, std::string outputImage, std::string imageFormat, std::vector<float> maskValues, std::vector<double> outputValues, unsigned int numThreads);
+            template <typename T> bool maskImageLUTImgType(GDALDataset *dataset, GDALDataset *mask, std::string outputImage, std::string imageFormat, std::vector<float> &maskValues, std::vector<double> &outputValues, unsigned int numThreads);
+            template <typename MaskT, typename T> void maskImageLUT(GDALDataset *dataset, GDALDataset *mask, std::string outputImage, std::string imageFormat, std::vector<float> &maskValues, std::vector<T> &outputValues, unsigned int numThreads);
         };
 	
 	class DllExport RSGISApplyImageMask : public RSGISCalcImageValue
 		{
 		public: 
 			RSGISApplyImageMask(int numberOutBands, double outputValue, std::vector<float> maskValues);
+            RSGISApplyImageMask(int numberOutBands, std::vector<float> maskValues, std::vector<double> outputValues);
 			void calcImageValue(float *bandValues, int numBands, double *output);
 			~RSGISApplyImageMask();
 		protected:
-			double outputValue;
             std::vector<float> maskValues;
+            std::vector<double> outputValues;
 		};
     
+    /**
+     * A version of RSGISApplyImageMask for RSGISCalcImageT where the image,
+     * mask and output all have the pixel type T. As with RSGISApplyImageMask
+     * the first band is the mask and the remaining bands are the image.
+     */
+    template <typename T> class RSGISApplyImageMaskT : public RSGISCalcImageValueT<T, T>
+    {
+    public:
+        RSGISApplyImageMaskT(int numberOutBands, std::vector<T> maskValues, std::vector<T> outputValues): RSGISCalcImageValueT<T, T>(numberOutBands)
+        {
+            this->maskValues = maskValues;
+            this->outputValues = outputValues;
+        };
+        void calcImageBlock(const T* const* bands, int numBands, size_t nPxls, T* const* output)
+        {
+            const T *maskBand = bands[0];
+            for(int b = 0; b < this->numOutBands; ++b)
+            {
+                const T *inBand = bands[b+1];
+                T *outBand = output[b];
+                for(size_t i = 0; i < nPxls; ++i)
+                {
+                    outBand[i] = inBand[i];
+                }
+                // Applied in reverse so the first matching mask value is the last to be written.
+                for(size_t n = this->maskValues.size(); n > 0; --n)
+                {
+                    rsgis::RSGISSIMDKernels::replaceWhereEqual<T>(maskBand, this->maskValues[n-1], this->outputValues[n-1], outBand, nPxls);
+                }
+            }
+        };
+        RSGISCalcImageValueT<T, T>* clone(){return new RSGISApplyImageMaskT<T>(this->numOutBands, this->maskValues, this->outputValues);};
+        ~RSGISApplyImageMaskT(){};
+    protected:
+        std::vector<T> maskValues;
+        std::vector<T> outputValues;
+    };
+    
     class DllExport RSGISCreateFiniteImageMask : public RSGISCalcImageValue
     {
     public:
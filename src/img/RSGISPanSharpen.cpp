@@ -32,6 +32,9 @@ namespace rsgis { namespace img {
 	{
 		this->numberOutBands = numberOutBands;
 		this->imageStats = imageStats;
+        this->centreVals.resize(numberOutBands+1);
+        this->phi.resize(numberOutBands);
+        this->panWinSum = 0;
 	}
 	
 	void RSGISHCSPanSharpen::calcImageValue(float *bandValues, int numBands, double *output) 
@@ -49,58 +52,14 @@ namespace rsgis { namespace img {
 			iAdj = 0;
 		}
 		
-		float *phi = new float[this->numberOutBands - 1];
-		
-		// CALCULATE FORWARD TRANSFORM
-		for(unsigned int i = 0; i < this->numberOutBands - 1; ++i)
-		{
-			float sumMSSq = 0;
-			
-			for(unsigned int j = i; j < this->numberOutBands; ++j) // Loop through band values
-			{
-				sumMSSq = sumMSSq + pow(bandValues[j],2);
-			}
-			
-			phi[i] = atan(sqrt(sumMSSq) / bandValues[i]);
-		}
-		
-		// APPLY REVERSE TRANSFORM
-		float prodPhi = 1;
-		for(unsigned int i = 0; i < (this->numberOutBands - 1); ++i)
-		{
-			prodPhi = 1;
-			for(unsigned int j = 0; j < i; ++j) // Loop through band values
-			{
-				prodPhi = prodPhi*sin(phi[j]);
-			}
-			prodPhi = prodPhi*cos(phi[i]);
-			
-			output[i] = iAdj * prodPhi;
-		}
-		
-		// Last band
-		prodPhi = 1;
-		for(unsigned int j = 0; j < (this->numberOutBands - 1); ++j) // Loop through band values
-		{
-			prodPhi = prodPhi*sin(phi[j]);
-		}
-		
-		output[this->numberOutBands - 1] = iAdj * prodPhi;
-		
-		delete[] phi;
+        this->calcSharpenedValues(bandValues, iAdj, output);
 	}
 	
 	
 	void RSGISHCSPanSharpen::calcImageValue(float ***dataBlock, int numBands, int winSize, double *output) 
 	{
-		
 		//dataBlock[k][i][j]; k = band; j = y axis; i = x axis
 		
-		float meanMS = this->imageStats[0];
-		float meanPAN = this->imageStats[1];
-		float sdMS = this->imageStats[2];
-		float sdPAN = this->imageStats[3];
-		
 		// Centre pixel
 		unsigned int cPix = int(winSize / 2.);
 		
@@ -113,65 +72,175 @@ namespace rsgis { namespace img {
 			}
 		}
 		
-		float panSmooth = panSmoothSum / float(winSize * winSize);
+		// The multispectral values and the pan value of the centre pixel.
+		for(unsigned int i = 0; i <= this->numberOutBands; ++i)
+		{
+            this->centreVals[i] = dataBlock[i][cPix][cPix];
+		}
+        this->calcSmartValue(panSmoothSum, winSize, output);
+	}
+    
+    bool RSGISHCSPanSharpen::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        float meanMS = this->imageStats[0];
+        float meanPAN = this->imageStats[1];
+        float sdMS = this->imageStats[2];
+        float sdPAN = this->imageStats[3];
+        const unsigned int numMSBands = this->numberOutBands;
+        
+        if(this->blockIAdj.size() != nPxls)
+        {
+            this->blockIAdj.resize(nPxls);
+            this->blockSumSq.resize(nPxls);
+            this->blockProdSin.resize(nPxls);
+            this->blockPhi.assign(numMSBands, std::vector<float>(nPxls));
+        }
+        float *iAdj = this->blockIAdj.data();
+        float *sumSq = this->blockSumSq.data();
+        float *prodSin = this->blockProdSin.data();
+        
+        const float *pan = bands[numMSBands];
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            float pSq = ((sdMS / sdPAN) * ((pan[p]*pan[p]) - meanPAN + sdPAN)) + (meanMS - sdMS);
+            iAdj[p] = (pSq < 0)?0:sqrt(pSq);
+        }
+        
+        // CALCULATE FORWARD TRANSFORM, where the sum of squares of bands i to n-1 is accumulated from the last band.
+        const float *lastBand = bands[numMSBands-1];
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            sumSq[p] = lastBand[p]*lastBand[p];
+        }
+        for(int i = ((int)numMSBands) - 2; i >= 0; --i)
+        {
+            const float *msBand = bands[i];
+            float *bandPhi = this->blockPhi[i].data();
+            for(size_t p = 0; p < nPxls; ++p)
+            {
+                sumSq[p] = sumSq[p] + (msBand[p]*msBand[p]);
+                bandPhi[p] = atan(sqrt(sumSq[p]) / msBand[p]);
+            }
+        }
+        
+        // APPLY REVERSE TRANSFORM
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            prodSin[p] = 1;
+        }
+        for(unsigned int i = 0; i < (numMSBands - 1); ++i)
+        {
+            const float *bandPhi = this->blockPhi[i].data();
+            double *outBand = output[i];
+            for(size_t p = 0; p < nPxls; ++p)
+            {
+                outBand[p] = iAdj[p] * (prodSin[p]*cos(bandPhi[p]));
+                prodSin[p] = prodSin[p]*sin(bandPhi[p]);
+            }
+        }
+        
+        // Last band
+        double *outBand = output[numMSBands-1];
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            outBand[p] = iAdj[p] * prodSin[p];
+        }
+        return true;
+    }
+    
+    bool RSGISHCSPanSharpen::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
+    {
+        const float *panWin = winData[this->numberOutBands];
+        double sumVal = 0;
+        for(int j = 0; j < winSize; ++j)
+        {
+            const float *winRow = panWin + (j * stride);
+            for(int i = 0; i < winSize; ++i)
+            {
+                sumVal = sumVal + winRow[i];
+            }
+        }
+        this->panWinSum = sumVal;
+        
+        size_t cOff = (winSize/2) * (stride + 1);
+        for(unsigned int i = 0; i <= this->numberOutBands; ++i)
+        {
+            this->centreVals[i] = winData[i][cOff];
+        }
+        this->calcSmartValue(this->panWinSum, winSize, output);
+        return true;
+    }
+    
+    bool RSGISHCSPanSharpen::calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output)
+    {
+        const float *panOutColumn = outColumn[this->numberOutBands];
+        const float *panInColumn = inColumn[this->numberOutBands];
+        double inSum = 0;
+        double outSum = 0;
+        for(int j = 0; j < winSize; ++j)
+        {
+            inSum = inSum + panInColumn[j * stride];
+            outSum = outSum + panOutColumn[j * stride];
+        }
+        this->panWinSum = this->panWinSum + (inSum - outSum);
+        
+        // The columns are views of the image data so the centre pixel is to the left of the centre of the in column.
+        int cPix = winSize/2;
+        size_t cOff = (cPix * stride) - (winSize - 1 - cPix);
+        for(unsigned int i = 0; i <= this->numberOutBands; ++i)
+        {
+            this->centreVals[i] = inColumn[i][cOff];
+        }
+        this->calcSmartValue(this->panWinSum, winSize, output);
+        return true;
+    }
+    
+    void RSGISHCSPanSharpen::calcSmartValue(float panSum, int winSize, double *output)
+    {
+        float meanMS = this->imageStats[0];
+        float meanPAN = this->imageStats[1];
+        float sdMS = this->imageStats[2];
+        float sdPAN = this->imageStats[3];
+        
+        float panSmooth = panSum / float(winSize * winSize);
 		
 		float iSq = 0;
-		
 		for(unsigned int i = 0; i < (this->numberOutBands - 1); ++i)
 		{
-			iSq = iSq + pow(dataBlock[i][cPix][cPix],2);
-			
+			iSq = iSq + (this->centreVals[i]*this->centreVals[i]);
 		}
 		
-		float pan = dataBlock[this->numberOutBands][cPix][cPix];
+		float pan = this->centreVals[this->numberOutBands];
 		float pSq = ((sdMS / sdPAN) * ((pan*pan) - meanPAN + sdPAN)) + (meanMS - sdMS);
 		float pSqSmooth = ((sdMS / sdPAN) * ((panSmooth*panSmooth) - meanPAN + sdPAN)) + (meanMS - sdMS);
 		
-		
 		// Calculate iAdj
 		float iAdj = sqrt((pSq / pSqSmooth) * iSq);
-		
-		float *phi = new float[this->numberOutBands - 1];
-		
-		// CALCULATE FORWARD TRANSFORM
-		for(unsigned int i = 0; i < this->numberOutBands - 1; ++i)
+        
+        this->calcSharpenedValues(this->centreVals.data(), iAdj, output);
+    }
+    
+    void RSGISHCSPanSharpen::calcSharpenedValues(const float *msVals, float iAdj, double *output)
+    {
+		// CALCULATE FORWARD TRANSFORM, where the sum of squares of bands i to n-1 is accumulated from the last band.
+        float sumMSSq = msVals[this->numberOutBands-1]*msVals[this->numberOutBands-1];
+		for(int i = ((int)this->numberOutBands) - 2; i >= 0; --i)
 		{
-			float sumMSSq = 0;
-			
-			for(unsigned int j = i; j < this->numberOutBands; ++j) // Loop through band values
-			{
-				sumMSSq = sumMSSq + pow(dataBlock[j][cPix][cPix],2);
-			}
-			
-			phi[i] = atan(sqrt(sumMSSq) / dataBlock[i][cPix][cPix]);
+            sumMSSq = sumMSSq + (msVals[i]*msVals[i]);
+			this->phi[i] = atan(sqrt(sumMSSq) / msVals[i]);
 		}
 		
 		// APPLY REVERSE TRANSFORM
 		float prodPhi = 1;
 		for(unsigned int i = 0; i < (this->numberOutBands - 1); ++i)
 		{
-			prodPhi = 1;
-			for(unsigned int j = 0; j < i; ++j) // Loop through band values
-			{
-				prodPhi = prodPhi*sin(phi[j]);
-			}
-			prodPhi = prodPhi*cos(phi[i]);
-			
-			output[i] = iAdj * prodPhi;
+			output[i] = iAdj * (prodPhi*cos(this->phi[i]));
+            prodPhi = prodPhi*sin(this->phi[i]);
 		}
 		
 		// Last band
-		prodPhi = 1;
-		for(unsigned int j = 0; j < (this->numberOutBands - 1); ++j) // Loop through band values
-		{
-			prodPhi = prodPhi*sin(phi[j]);
-		}
-		
 		output[this->numberOutBands - 1] = iAdj * prodPhi;
-		
-		delete[] phi;
-		
-	}
+    }
 	
 	RSGISHCSPanSharpenCalcMeanStats::RSGISHCSPanSharpenCalcMeanStats(int numberOutBands, float *outStats) : RSGISCalcImageValue(numberOutBands)
 	{
@@ -239,4 +308,101 @@ namespace rsgis { namespace img {
 		this->outStats[3] = sqrt(this->sumPAN / this->nPix);
 	}
 
+	RSGISHCSPanSharpenCalcStats::RSGISHCSPanSharpenCalcStats(float *outStats) : RSGISCalcImageValue(0)
+	{
+		this->outStats = outStats;
+		this->meanMS = 0.;
+		this->meanPAN = 0.;
+		this->m2MS = 0.;
+		this->m2PAN = 0.;
+		this->nPix = 0;
+	}
+	
+	void RSGISHCSPanSharpenCalcStats::calcImageValue(float *bandValues, int numBands) 
+	{
+		if(bandValues[0] > 0)
+		{
+			this->nPix = this->nPix + 1;
+            double pixPAN = bandValues[numBands-1]*bandValues[numBands-1]; // P^2
+			double pixMSSum = 0;
+			for(int i = 0; i < (numBands - 1); ++i)
+			{
+				pixMSSum = pixMSSum + (bandValues[i]*bandValues[i]);
+			}
+			
+            double deltaMS = pixMSSum - this->meanMS;
+            this->meanMS = this->meanMS + (deltaMS / this->nPix);
+            this->m2MS = this->m2MS + (deltaMS * (pixMSSum - this->meanMS));
+            
+            double deltaPAN = pixPAN - this->meanPAN;
+            this->meanPAN = this->meanPAN + (deltaPAN / this->nPix);
+            this->m2PAN = this->m2PAN + (deltaPAN * (pixPAN - this->meanPAN));
+		}
+	}
+    
+    void RSGISHCSPanSharpenCalcStats::calcSampleStats(GDALDataset *dataset, unsigned int sampleSize)
+    {
+        int width = dataset->GetRasterXSize();
+        int height = dataset->GetRasterYSize();
+        int numBands = dataset->GetRasterCount();
+        double sampleScale = std::max(1.0, ((double)std::max(width, height))/sampleSize);
+        int sampleWidth = std::max(1, (int)(width/sampleScale));
+        int sampleHeight = std::max(1, (int)(height/sampleScale));
+        size_t numSamplePxls = ((size_t)sampleWidth)*((size_t)sampleHeight);
+        
+        std::vector< std::vector<float> > sampleVals(numBands, std::vector<float>(numSamplePxls));
+        for(int n = 0; n < numBands; ++n)
+        {
+            if(dataset->GetRasterBand(n+1)->RasterIO(GF_Read, 0, 0, width, height, sampleVals[n].data(), sampleWidth, sampleHeight, GDT_Float32, 0, 0) != CE_None)
+            {
+                throw RSGISImageCalcException("Could not read a sample of the input image.");
+            }
+        }
+        
+        std::vector<float> bandValues(numBands);
+        for(size_t p = 0; p < numSamplePxls; ++p)
+        {
+            for(int n = 0; n < numBands; ++n)
+            {
+                bandValues[n] = sampleVals[n][p];
+            }
+            this->calcImageValue(bandValues.data(), numBands);
+        }
+    }
+	
+	void RSGISHCSPanSharpenCalcStats::returnStats()
+	{
+        if(this->nPix == 0)
+        {
+            throw RSGISImageCalcException("There are no pixels with a value > 0 in the first band to calculate the statistics.");
+        }
+		this->outStats[0] = this->meanMS;
+		this->outStats[1] = this->meanPAN;
+		this->outStats[2] = sqrt(this->m2MS / this->nPix);
+		this->outStats[3] = sqrt(this->m2PAN / this->nPix);
+	}
+    
+    void RSGISHCSPanSharpenCalcStats::reduce(RSGISCalcImageValue *other)
+    {
+        // Combine the mean and sum of squared differences of the two sets of pixels (Chan et al.).
+        RSGISHCSPanSharpenCalcStats *otherStats = static_cast<RSGISHCSPanSharpenCalcStats*>(other);
+        if(otherStats->nPix == 0)
+        {
+            return;
+        }
+        double nA = this->nPix;
+        double nB = otherStats->nPix;
+        double nAB = nA + nB;
+        
+        double deltaMS = otherStats->meanMS - this->meanMS;
+        this->meanMS = this->meanMS + (deltaMS * (nB / nAB));
+        this->m2MS = this->m2MS + otherStats->m2MS + (deltaMS * deltaMS * ((nA * nB) / nAB));
+        
+        double deltaPAN = otherStats->meanPAN - this->meanPAN;
+        this->meanPAN = this->meanPAN + (deltaPAN * (nB / nAB));
+        this->m2PAN = this->m2PAN + otherStats->m2PAN + (deltaPAN * deltaPAN * ((nA * nB) / nAB));
+        
+        this->nPix = this->nPix + otherStats->nPix;
+    }
+
 }}
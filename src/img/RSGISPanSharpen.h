@@ -23,6 +23,9 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
 
 #include "common/RSGISException.h"
 #include "common/RSGISImageException.h"
@@ -63,11 +66,58 @@ namespace rsgis { namespace img {
 		RSGISHCSPanSharpen(int numberOutBands, float *imageStats);
 		void calcImageValue(float *bandValues, int numBands, double *output);
 		void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+        /** The naive method for a strip of pixels. */
+        bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        /** The smart method, where the smoothed pan value is a running sum of the window. */
+        bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+        bool calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output);
+        RSGISCalcImageValue* clone(){return new RSGISHCSPanSharpen(this->numberOutBands, this->imageStats);};
 		~RSGISHCSPanSharpen(){};
 	private:
+        /** The forward and reverse transforms of the multispectral values with the adjusted intensity. */
+        void calcSharpenedValues(const float *msVals, float iAdj, double *output);
+        void calcSmartValue(float panWinSum, int winSize, double *output);
 		unsigned int numberOutBands;
 		float *imageStats;
+        std::vector<float> centreVals;
+        std::vector<float> phi;
+        std::vector<float> blockIAdj;
+        std::vector<float> blockSumSq;
+        std::vector<float> blockProdSin;
+        std::vector< std::vector<float> > blockPhi;
+        double panWinSum;
 	};
+    
+    /**
+     * Calculates the statistics used by RSGISHCSPanSharpen (meanMS, meanPAN, sdMS
+     * and sdPAN, of the sum of the squared multispectral values and the squared pan
+     * value of the pixels where the first band is > 0) in a single pass using
+     * Welford's method, rather than the two passes of RSGISHCSPanSharpenCalcMeanStats
+     * and RSGISHCSPanSharpenCalcSDStats.
+     */
+    class DllExport RSGISHCSPanSharpenCalcStats : public RSGISCalcImageValue
+    {
+    public:
+        RSGISHCSPanSharpenCalcStats(float *outStats);
+        void calcImageValue(float *bandValues, int numBands);
+        /**
+         * Calculate the statistics from the image down-sampled to at most sampleSize
+         * pixels along its longest side (using the overviews if available) rather
+         * than from every pixel of the image.
+         */
+        void calcSampleStats(GDALDataset *dataset, unsigned int sampleSize);
+        void returnStats();
+        RSGISCalcImageValue* clone(){return new RSGISHCSPanSharpenCalcStats(this->outStats);};
+        void reduce(RSGISCalcImageValue *other);
+        ~RSGISHCSPanSharpenCalcStats(){};
+    private:
+        float *outStats;
+        double meanMS;
+        double meanPAN;
+        double m2MS;
+        double m2PAN;
+        long int nPix;
+    };
 
 	class DllExport RSGISHCSPanSharpenCalcMeanStats : public RSGISCalcImageValue
 	{
@@ -27,7 +27,7 @@
 namespace rsgis { namespace img {
 
     
-    void RSGISPopWithStats::calcPopStats( GDALDataset *imgDS, bool useNoDataVal, float noDataVal, bool calcPyramid, std::vector<int> decimatFactors )
+    void RSGISPopWithStats::calcPopStats( GDALDataset *imgDS, bool useNoDataVal, float noDataVal, bool calcPyramid, std::vector<int> decimatFactors, unsigned int numThreads )
     {
         rsgis::utils::RSGISTextUtils textUtils;
         
@@ -43,27 +43,73 @@ namespace rsgis { namespace img {
             }
         }
         
-        // Iteration 1 through image: Min, Max and Mean
-        double *minVal = new double[numBands];
-        double *maxVal = new double[numBands];
-        double *meanVal = new double[numBands];
-        unsigned long *nVals = new unsigned long[numBands];
-        
+        // Iteration 1 through image: Min, Max, Mean and Std Dev. For 8 and 16 bit integer
+        // bands a histogram of the pixel values is also calculated, from which the output
+        // histogram is derived, so these images do not need to be read a second time.
+        std::vector<long> directHistMin(numBands, 0);
+        std::vector<unsigned long> directHistSize(numBands, 0);
         for(int i = 0; i < numBands; ++i)
         {
-            minVal[i] = 0;
-            maxVal[i] = 0;
-            meanVal[i] = 0;
-            nVals[i] = 0;
+            GDALDataType dataType = imgDS->GetRasterBand( i+1 )->GetRasterDataType();
+            if( dataType == GDT_Byte )
+            {
+                directHistMin[i] = 0;
+                directHistSize[i] = 256;
+            }
+            else if( dataType == GDT_UInt16 )
+            {
+                directHistMin[i] = 0;
+                directHistSize[i] = 65536;
+            }
+            else if( dataType == GDT_Int16 )
+            {
+                directHistMin[i] = -32768;
+                directHistSize[i] = 65536;
+            }
         }
         
-        RSGISCalcImageMinMaxMean calcImageStats = RSGISCalcImageMinMaxMean(numBands, useNoDataVal, noDataVal, minVal, maxVal, meanVal, nVals);
-        RSGISCalcImage calcImg = RSGISCalcImage(&calcImageStats, "", true);
-        calcImg.calcImage(&imgDS, 1);
+        RSGISCalcImagePopStatsSinglePass calcImageStats = RSGISCalcImagePopStatsSinglePass(numBands, useNoDataVal, noDataVal, directHistMin, directHistSize);
+        if(calcPyramid)
+        {
+            // The statistics are calculated from the same read of the image as the
+            // first pyramid level. The no data value is needed for the pyramids.
+            std::cout << "Calculating Image Statistics and Pyramids.\n";
+            if(decimatFactors.size() == 0)
+            {
+                decimatFactors = RSGISImagePyramidBuilder::getDefaultDecimationFactors(imgDS->GetRasterXSize(), imgDS->GetRasterYSize());
+            }
+            if(useNoDataVal)
+            {
+                for(int i = 0; i < numBands; ++i)
+                {
+                    imgDS->GetRasterBand(i+1)->SetNoDataValue(noDataVal);
+                }
+            }
+            
+            RSGISPopStatsStripObserver statsObserver = RSGISPopStatsStripObserver(&calcImageStats);
+            RSGISImagePyramidBuilder pyramidBuilder = RSGISImagePyramidBuilder(pyramidAverage, numThreads);
+            pyramidBuilder.buildPyramids(imgDS, decimatFactors, &statsObserver);
+            statsObserver.reduce();
+        }
+        else
+        {
+            RSGISCalcImage calcImg = RSGISCalcImage(&calcImageStats, "", true);
+            calcImg.setNumThreads(numThreads);
+            calcImg.calcImage(&imgDS, 1);
+        }
         
+        std::vector<double> minVal(numBands);
+        std::vector<double> maxVal(numBands);
+        std::vector<double> meanVal(numBands);
+        std::vector<double> stdDevVal(numBands);
+        std::vector<unsigned long> nVals(numBands);
         for(int i = 0; i < numBands; ++i)
         {
-            meanVal[i] = meanVal[i] / nVals[i];
+            minVal[i] = calcImageStats.getMin(i);
+            maxVal[i] = calcImageStats.getMax(i);
+            meanVal[i] = calcImageStats.getMean(i);
+            stdDevVal[i] = calcImageStats.getStdDev(i);
+            nVals[i] = calcImageStats.getNumVals(i);
             
             band = imgDS->GetRasterBand(i+1);
             band->SetMetadataItem( "STATISTICS_MINIMUM", textUtils.doubletostring(minVal[i]).c_str(), NULL );
@@ -77,14 +123,14 @@ namespace rsgis { namespace img {
             }
         }
         
-        // Iteration 2 through image: Std Dev + Histogram
+        // Histogram: where there isn't a histogram of the pixel values from iteration 1 a
+        // second iteration through the image is needed as the bins depend on the range.
         unsigned int numHistBins = 256;
-        unsigned int **bandHist = new unsigned int*[numBands];
         
-        std::string *histoType = new std::string[numBands];
-        double *histMin = new double[numBands];
-        double *histMax = new double[numBands];
-        double *histWidth = new double[numBands];
+        std::vector<std::string> histoType(numBands);
+        std::vector<double> histMin(numBands);
+        std::vector<double> histMax(numBands);
+        std::vector<double> histWidth(numBands);
         double range = 0.0;
         
         for(int i = 0; i < numBands; ++i)
@@ -132,129 +178,127 @@ namespace rsgis { namespace img {
             }
         }
         
-        double *stdDevVal = new double[numBands];
-        unsigned long *nVals2 = new unsigned long[numBands];
+        std::vector<bool> calcBandHist(numBands, false);
+        bool calcHistPass = false;
         for(int i = 0; i < numBands; ++i)
         {
-            stdDevVal[i] = 0;
-            nVals2[i] = 0;
-            bandHist[i] = new unsigned int[numHistBins];
-            for(unsigned int j = 0; j < numHistBins; ++j)
+            if(directHistSize[i] == 0)
             {
-                bandHist[i][j] = 0;
+                calcBandHist[i] = true;
+                calcHistPass = true;
             }
         }
-        RSGISCalcImageStdDevPopHist calcImageHistSD = RSGISCalcImageStdDevPopHist(numBands, useNoDataVal, noDataVal, minVal, maxVal, meanVal, stdDevVal, nVals2, histMin, histMax, histWidth, bandHist, numHistBins);
-        calcImg = RSGISCalcImage(&calcImageHistSD, "", true);
-        calcImg.calcImage(&imgDS, 1);
         
+        RSGISCalcImagePopHist calcImageHist = RSGISCalcImagePopHist(numBands, useNoDataVal, noDataVal, minVal, histWidth, calcBandHist, numHistBins);
+        if(calcHistPass)
+        {
+            RSGISCalcImage calcImgHist = RSGISCalcImage(&calcImageHist, "", true);
+            calcImgHist.setNumThreads(numThreads);
+            calcImgHist.calcImage(&imgDS, 1);
+        }
         
+        std::vector< std::vector<unsigned int> > bandHist(numBands, std::vector<unsigned int>(numHistBins, 0));
         for(int i = 0; i < numBands; ++i)
         {
-            stdDevVal[i] = sqrt(stdDevVal[i] / nVals2[i]);
-            
-            band = imgDS->GetRasterBand(i+1);
-            band->SetMetadataItem( "STATISTICS_STDDEV", textUtils.doubletostring(stdDevVal[i]).c_str(), NULL );
-            band->SetMetadataItem( "STATISTICS_HISTOMIN", textUtils.doubletostring(minVal[i]).c_str(), NULL );
-            band->SetMetadataItem( "STATISTICS_HISTOMAX", textUtils.doubletostring(maxVal[i]).c_str(), NULL );
-            band->SetMetadataItem( "STATISTICS_HISTONUMBINS", "256", NULL );
-            band->SetMetadataItem( "STATISTICS_HISTOBINFUNCTION", histoType[i].c_str(), NULL );
-            
-            // Calc Mode and Median:
-            double modeVal = 0.0;
-            double medianVal = 0.0;
-            long pxlCount = 0;
-            bool foundMedian = false;
-            long medianPxl = nVals2[i]/2;
-            unsigned long modeBinFreq = 0;
-            std::string histBinsStr = "";
-            for(int j = 0; j < 256; ++j)
-            {
-                if(j == 0)
-                {
-                    modeBinFreq = bandHist[i][j];
-                    modeVal = minVal[i] + (j * histWidth[i]);
-                }
-                else if(bandHist[i][j] >  modeBinFreq)
-                {
-                    modeBinFreq = bandHist[i][j];
-                    modeVal = minVal[i] + (j * histWidth[i]);
-                }
-                
-                if(j == 0)
-                {
-                    histBinsStr = histBinsStr + textUtils.uInt64bittostring(bandHist[i][j]);
-                }
-                else
+            if(calcBandHist[i])
+            {
+                const std::vector<unsigned long> &popHist = calcImageHist.getHistogram(i);
+                for(unsigned int j = 0; j < numHistBins; ++j)
                 {
-                    histBinsStr = histBinsStr + "|" + textUtils.uInt64bittostring(bandHist[i][j]);
+                    bandHist[i][j] = popHist[j];
                 }
-                
-                pxlCount = pxlCount + bandHist[i][j];
-                
-                if((pxlCount > medianPxl) & (!foundMedian))
+            }
+            else
+            {
+                const std::vector<unsigned long> &directHist = calcImageStats.getDirectHistogram(i);
+                for(unsigned long k = 0; k < directHistSize[i]; ++k)
                 {
-                    if( labs(pxlCount-medianPxl) > labs((pxlCount-bandHist[i][j])-medianPxl) )
-                    {
-                        medianVal = minVal[i] + ((j-1) * histWidth[i]);
-                    }
-                    else
+                    if(directHist[k] > 0)
                     {
-                        medianVal = minVal[i] + (j * histWidth[i]);
+                        double pxlVal = directHistMin[i] + ((long)k);
+                        bandHist[i][RSGISCalcImagePopHist::findHistBin(pxlVal, minVal[i], histWidth[i], numHistBins)] += directHist[k];
                     }
-                    foundMedian = true;
                 }
             }
+        }
+        
+        for(int i = 0; i < numBands; ++i)
+        {
+            band = imgDS->GetRasterBand(i+1);
+            band->SetMetadataItem( "STATISTICS_STDDEV", textUtils.doubletostring(stdDevVal[i]).c_str(), NULL );
+            band->SetMetadataItem( "STATISTICS_HISTOMIN", textUtils.doubletostring(minVal[i]).c_str(), NULL );
+            band->SetMetadataItem( "STATISTICS_HISTOMAX", textUtils.doubletostring(maxVal[i]).c_str(), NULL );
+            band->SetMetadataItem( "STATISTICS_HISTONUMBINS", "256", NULL );
+            band->SetMetadataItem( "STATISTICS_HISTOBINFUNCTION", histoType[i].c_str(), NULL );
             
-            band->SetMetadataItem( "STATISTICS_MODE", textUtils.doubletostring(modeVal).c_str(), NULL );
-            band->SetMetadataItem( "STATISTICS_MEDIAN", textUtils.doubletostring(medianVal).c_str(), NULL );
-            band->SetMetadataItem( "STATISTICS_HISTOBINVALUES", histBinsStr.c_str(), NULL );
+            RSGISPopWithStats::writeHistogram(band, bandHist[i], minVal[i], histWidth[i], nVals[i]);
+        }
+    }
+    
+    void RSGISPopWithStats::writeHistogram(GDALRasterBand *band, std::vector<unsigned int> &hist, double histMin, double histWidth, unsigned long nVals)
+    {
+        rsgis::utils::RSGISTextUtils textUtils;
+        unsigned int numHistBins = hist.size();
+        
+        // Calc Mode and Median:
+        double modeVal = 0.0;
+        double medianVal = 0.0;
+        long pxlCount = 0;
+        bool foundMedian = false;
+        long medianPxl = nVals/2;
+        unsigned long modeBinFreq = 0;
+        std::string histBinsStr = "";
+        for(unsigned int j = 0; j < numHistBins; ++j)
+        {
+            if(j == 0)
+            {
+                modeBinFreq = hist[j];
+                modeVal = histMin + (j * histWidth);
+            }
+            else if(hist[j] >  modeBinFreq)
+            {
+                modeBinFreq = hist[j];
+                modeVal = histMin + (j * histWidth);
+            }
             
-            GDALRasterAttributeTable *attTable = imgDS->GetRasterBand( i+1 )->GetDefaultRAT();
-            if(attTable == NULL)
+            if(j == 0)
             {
-                attTable = new GDALDefaultRasterAttributeTable();
+                histBinsStr = histBinsStr + textUtils.uInt64bittostring(hist[j]);
+            }
+            else
+            {
+                histBinsStr = histBinsStr + "|" + textUtils.uInt64bittostring(hist[j]);
             }
-            attTable->SetRowCount(256);
             
-            unsigned int histoColIdx = this->findColumnIndexOrCreate(attTable, "Histogram", GFT_Real, GFU_PixelCount);
-            attTable->ValuesIO(GF_Write, histoColIdx, 0, 256, (int*) bandHist[i]);
-        }
-        
-        if(calcPyramid)
-        {
-            std::cout << "Calculating Image Pyramids.\n";
-            if(decimatFactors.size() == 0)
+            pxlCount = pxlCount + hist[j];
+            
+            if((pxlCount > medianPxl) & (!foundMedian))
             {
-                int minOverviewDim = 33;
-                
-                int minDim = imgDS->GetRasterXSize();
-                if(imgDS->GetRasterYSize() < minDim)
+                if( labs(pxlCount-medianPxl) > labs((pxlCount-((long)hist[j]))-medianPxl) )
                 {
-                    minDim = imgDS->GetRasterYSize();
+                    medianVal = histMin + ((((double)j)-1) * histWidth);
                 }
-                
-                int nLevels[] = { 4, 8, 16, 32, 64, 128, 256, 512 };
-                for(int i = 0; i < 8; i++)
+                else
                 {
-                    if( (minDim/nLevels[i]) > minOverviewDim )
-                    {
-                        decimatFactors.push_back(nLevels[i]);
-                    }
+                    medianVal = histMin + (j * histWidth);
                 }
+                foundMedian = true;
             }
-            
-            this->addPyramids(imgDS, decimatFactors);
         }
-    }
-    
-    void RSGISPopWithStats::addPyramids(GDALDataset *imgDS, std::vector<int> decimatFactors)
-    {
-        int nOverviews = decimatFactors.size();
         
-        rsgis_tqdm *pbar = new rsgis_tqdm();
-        imgDS->BuildOverviews("AVERAGE", nOverviews, decimatFactors.data(), 0, NULL,  (GDALProgressFunc)RSGISTQDMProgress, pbar );
-        delete pbar;
+        band->SetMetadataItem( "STATISTICS_MODE", textUtils.doubletostring(modeVal).c_str(), NULL );
+        band->SetMetadataItem( "STATISTICS_MEDIAN", textUtils.doubletostring(medianVal).c_str(), NULL );
+        band->SetMetadataItem( "STATISTICS_HISTOBINVALUES", histBinsStr.c_str(), NULL );
+        
+        GDALRasterAttributeTable *attTable = band->GetDefaultRAT();
+        if(attTable == NULL)
+        {
+            attTable = new GDALDefaultRasterAttributeTable();
+        }
+        attTable->SetRowCount(numHistBins);
+        
+        unsigned int histoColIdx = RSGISPopWithStats::findColumnIndexOrCreate(attTable, "Histogram", GFT_Real, GFU_PixelCount);
+        attTable->ValuesIO(GF_Write, histoColIdx, 0, numHistBins, (int*) hist.data());
     }
     
     unsigned int RSGISPopWithStats::findColumnIndexOrCreate(GDALRasterAttributeTable *gdalATT, std::string colName, GDALRATFieldType dType, GDALRATFieldUsage dUsage)
@@ -282,25 +326,28 @@ namespace rsgis { namespace img {
     }
     
     
-    RSGISCalcImageMinMaxMean::RSGISCalcImageMinMaxMean(int numVals, bool useNoData, double noDataVal, double *minVal, double *maxVal, double *sumVal, unsigned long *nVals): RSGISCalcImageValue(0)
+    RSGISCalcImagePopStatsSinglePass::RSGISCalcImagePopStatsSinglePass(int numVals, bool useNoData, double noDataVal, std::vector<long> directHistMin, std::vector<unsigned long> directHistSize): RSGISCalcImageValue(0)
     {
         this->numVals = numVals;
         this->useNoData = useNoData;
         this->noDataVal = noDataVal;
-        this->minVal = minVal;
-        this->maxVal = maxVal;
-        this->sumVal = sumVal;
-        this->nVals = nVals;
+        this->directHistMin = directHistMin;
+        this->directHistSize = directHistSize;
         
-        this->first = new bool[numVals];
+        this->minVal = std::vector<double>(numVals, 0.0);
+        this->maxVal = std::vector<double>(numVals, 0.0);
+        this->sumVal = std::vector<double>(numVals, 0.0);
+        this->meanVal = std::vector<double>(numVals, 0.0);
+        this->m2Val = std::vector<double>(numVals, 0.0);
+        this->nVals = std::vector<unsigned long>(numVals, 0);
+        this->directHist = std::vector< std::vector<unsigned long> >(numVals);
         for(int i = 0; i < numVals; ++i)
         {
-            this->first[i] = true;
+            this->directHist[i] = std::vector<unsigned long>(directHistSize[i], 0);
         }
-        
     }
     
-    void RSGISCalcImageMinMaxMean::calcImageValue(float *bandValues, int numBands) 
+    void RSGISCalcImagePopStatsSinglePass::calcImageValue(float *bandValues, int numBands)
     {
         if(numVals != numBands)
         {
@@ -309,92 +356,163 @@ namespace rsgis { namespace img {
         
         for(int i = 0; i < numBands; ++i)
         {
-            if(this->useNoData)
+            this->addValue(i, bandValues[i]);
+        }
+    }
+    
+    void RSGISCalcImagePopStatsSinglePass::addBandValues(int band, double *vals, size_t numPxls)
+    {
+        if((band < 0) || (band >= this->numVals))
+        {
+            throw RSGISImageCalcException("Band is not within the statistics being calculated.");
+        }
+        
+        for(size_t k = 0; k < numPxls; ++k)
+        {
+            this->addValue(band, vals[k]);
+        }
+    }
+    
+    void RSGISCalcImagePopStatsSinglePass::addValue(int band, double val)
+    {
+        if(this->useNoData && (val == this->noDataVal))
+        {
+            return;
+        }
+        
+        if(this->nVals[band] == 0)
+        {
+            this->minVal[band] = val;
+            this->maxVal[band] = val;
+        }
+        else if(val < this->minVal[band])
+        {
+            this->minVal[band] = val;
+        }
+        else if(val > this->maxVal[band])
+        {
+            this->maxVal[band] = val;
+        }
+        this->sumVal[band] += val;
+        
+        // Welford's algorithm so the standard deviation is calculated in the same pass.
+        ++this->nVals[band];
+        double diff = val - this->meanVal[band];
+        this->meanVal[band] += diff / this->nVals[band];
+        this->m2Val[band] += diff * (val - this->meanVal[band]);
+        
+        if(this->directHistSize[band] > 0)
+        {
+            long histIdx = ((long)val) - this->directHistMin[band];
+            if((histIdx >= 0) && (((unsigned long)histIdx) < this->directHistSize[band]))
             {
-                if(bandValues[i] != this->noDataVal)
-                {
-                    if(first[i])
-                    {
-                        this->minVal[i] = bandValues[i];
-                        this->maxVal[i] = bandValues[i];
-                        this->sumVal[i] = bandValues[i];
-                        ++this->nVals[i];
-                        first[i] = false;
-                    }
-                    else
-                    {
-                        if(bandValues[i] < this->minVal[i])
-                        {
-                            this->minVal[i] = bandValues[i];
-                        }
-                        else if(bandValues[i] > this->maxVal[i])
-                        {
-                            this->maxVal[i] = bandValues[i];
-                        }
-                        this->sumVal[i] += bandValues[i];
-                        ++this->nVals[i];
-                    }
-                }
+                ++this->directHist[band][histIdx];
+            }
+        }
+    }
+    
+    RSGISCalcImageValue* RSGISCalcImagePopStatsSinglePass::clone()
+    {
+        return new RSGISCalcImagePopStatsSinglePass(this->numVals, this->useNoData, this->noDataVal, this->directHistMin, this->directHistSize);
+    }
+    
+    void RSGISCalcImagePopStatsSinglePass::reduce(RSGISCalcImageValue *other)
+    {
+        RSGISCalcImagePopStatsSinglePass *otherStats = dynamic_cast<RSGISCalcImagePopStatsSinglePass*>(other);
+        if(otherStats == NULL)
+        {
+            throw RSGISImageCalcException("Can only reduce with another RSGISCalcImagePopStatsSinglePass object.");
+        }
+        
+        for(int i = 0; i < this->numVals; ++i)
+        {
+            unsigned long nOther = otherStats->nVals[i];
+            if(nOther == 0)
+            {
+                continue;
+            }
+            
+            if(this->nVals[i] == 0)
+            {
+                this->minVal[i] = otherStats->minVal[i];
+                this->maxVal[i] = otherStats->maxVal[i];
+                this->meanVal[i] = otherStats->meanVal[i];
+                this->m2Val[i] = otherStats->m2Val[i];
             }
             else
             {
-                if(first[i])
+                if(otherStats->minVal[i] < this->minVal[i])
                 {
-                    this->minVal[i] = bandValues[i];
-                    this->maxVal[i] = bandValues[i];
-                    this->sumVal[i] = bandValues[i];
-                    ++this->nVals[i];
-                    first[i] = false;
+                    this->minVal[i] = otherStats->minVal[i];
                 }
-                else
+                if(otherStats->maxVal[i] > this->maxVal[i])
                 {
-                    if(bandValues[i] < this->minVal[i])
-                    {
-                        this->minVal[i] = bandValues[i];
-                    }
-                    else if(bandValues[i] > this->maxVal[i])
-                    {
-                        this->maxVal[i] = bandValues[i];
-                    }
-                    this->sumVal[i] += bandValues[i];
-                    ++this->nVals[i];
+                    this->maxVal[i] = otherStats->maxVal[i];
                 }
+                
+                // Combine the means and sum of squared differences (Chan et al.).
+                double nA = this->nVals[i];
+                double nB = nOther;
+                double nAB = nA + nB;
+                double diff = otherStats->meanVal[i] - this->meanVal[i];
+                this->meanVal[i] += diff * (nB / nAB);
+                this->m2Val[i] += otherStats->m2Val[i] + (diff * diff * ((nA * nB) / nAB));
+            }
+            this->sumVal[i] += otherStats->sumVal[i];
+            this->nVals[i] += nOther;
+            
+            for(unsigned long k = 0; k < this->directHistSize[i]; ++k)
+            {
+                this->directHist[i][k] += otherStats->directHist[i][k];
             }
         }
-        
     }
     
-    RSGISCalcImageMinMaxMean::~RSGISCalcImageMinMaxMean()
+    double RSGISCalcImagePopStatsSinglePass::getMean(int band)
+    {
+        if(this->nVals[band] == 0)
+        {
+            return 0.0;
+        }
+        return this->sumVal[band] / this->nVals[band];
+    }
+    
+    double RSGISCalcImagePopStatsSinglePass::getStdDev(int band)
+    {
+        if(this->nVals[band] == 0)
+        {
+            return 0.0;
+        }
+        return sqrt(this->m2Val[band] / this->nVals[band]);
+    }
+    
+    RSGISCalcImagePopStatsSinglePass::~RSGISCalcImagePopStatsSinglePass()
     {
         
     }
     
     
-    RSGISCalcImageStdDevPopHist::RSGISCalcImageStdDevPopHist(int numVals, bool useNoData, double noDataVal, double *minVal, double *maxVal, double *meanVal, double *sumVal, unsigned long *nVals, double *histMin, double *histMax, double *histWidth, unsigned int **bandHist, unsigned int numBins): RSGISCalcImageValue(0)
+    RSGISCalcImagePopHist::RSGISCalcImagePopHist(int numVals, bool useNoData, double noDataVal, std::vector<double> minVal, std::vector<double> histWidth, std::vector<bool> calcBandHist, unsigned int numBins): RSGISCalcImageValue(0)
     {
         this->numVals = numVals;
         this->useNoData = useNoData;
         this->noDataVal = noDataVal;
         this->minVal = minVal;
-        this->maxVal = maxVal;
-        this->meanVal = meanVal;
-        this->sumVal = sumVal;
-        this->nVals = nVals;
-        this->histMin = histMin;
-        this->histMax = histMax;
         this->histWidth = histWidth;
-        this->bandHist = bandHist;
+        this->calcBandHist = calcBandHist;
         this->numBins = numBins;
         
-        this->first = new bool[numVals];
+        this->bandHist = std::vector< std::vector<unsigned long> >(numVals);
         for(int i = 0; i < numVals; ++i)
         {
-            this->first[i] = true;
+            if(calcBandHist[i])
+            {
+                this->bandHist[i] = std::vector<unsigned long>(numBins, 0);
+            }
         }
-        
     }
     
-    void RSGISCalcImageStdDevPopHist::calcImageValue(float *bandValues, int numBands) 
+    void RSGISCalcImagePopHist::calcImageValue(float *bandValues, int numBands)
     {
         if(numVals != numBands)
         {
@@ -403,56 +521,232 @@ namespace rsgis { namespace img {
         
         for(int i = 0; i < numBands; ++i)
         {
-            if(this->useNoData)
+            if((!this->calcBandHist[i]) || (this->useNoData && (bandValues[i] == this->noDataVal)))
             {
-                if(bandValues[i] != this->noDataVal)
-                {
-                    if(first[i])
-                    {
-                        double diff = (bandValues[i] - this->meanVal[i]);
-                        this->sumVal[i] = this->sumVal[i] + (diff * diff);
-                        ++this->nVals[i];
-                        first[i] = false;
-                    }
-                    else
-                    {
-                        double diff = (bandValues[i] - this->meanVal[i]);
-                        this->sumVal[i] = this->sumVal[i] + (diff * diff);
-                        ++this->nVals[i];
-                    }
-                    
-                    unsigned int histIdx = floor(((bandValues[i] - this->minVal[i]) / this->histWidth[i])+0.5);
-                    if(histIdx >= this->numBins)
-                    {
-                        histIdx = (this->numBins-1);
-                    }
-                    ++bandHist[i][histIdx];
-                }
+                continue;
             }
-            else
+            ++this->bandHist[i][findHistBin(bandValues[i], this->minVal[i], this->histWidth[i], this->numBins)];
+        }
+    }
+    
+    RSGISCalcImageValue* RSGISCalcImagePopHist::clone()
+    {
+        return new RSGISCalcImagePopHist(this->numVals, this->useNoData, this->noDataVal, this->minVal, this->histWidth, this->calcBandHist, this->numBins);
+    }
+    
+    void RSGISCalcImagePopHist::reduce(RSGISCalcImageValue *other)
+    {
+        RSGISCalcImagePopHist *otherHist = dynamic_cast<RSGISCalcImagePopHist*>(other);
+        if(otherHist == NULL)
+        {
+            throw RSGISImageCalcException("Can only reduce with another RSGISCalcImagePopHist object.");
+        }
+        
+        for(int i = 0; i < this->numVals; ++i)
+        {
+            if(this->calcBandHist[i])
             {
-                if(first[i])
-                {
-                    double diff = (bandValues[i] - this->meanVal[i]);
-                    this->sumVal[i] = this->sumVal[i] + (diff * diff);
-                    ++this->nVals[i];
-                    first[i] = false;
-                }
-                else
+                for(unsigned int j = 0; j < this->numBins; ++j)
                 {
-                    double diff = (bandValues[i] - this->meanVal[i]);
-                    this->sumVal[i] = this->sumVal[i] + (diff * diff);
-                    ++this->nVals[i];
+                    this->bandHist[i][j] += otherHist->bandHist[i][j];
                 }
             }
         }
     }
     
-    RSGISCalcImageStdDevPopHist::~RSGISCalcImageStdDevPopHist()
+    unsigned int RSGISCalcImagePopHist::findHistBin(double val, double minVal, double histWidth, unsigned int numBins)
+    {
+        if((histWidth <= 0) || (val <= minVal))
+        {
+            return 0;
+        }
+        double histIdx = floor(((val - minVal) / histWidth)+0.5);
+        if(histIdx >= numBins)
+        {
+            return numBins-1;
+        }
+        return (unsigned int)histIdx;
+    }
+    
+    RSGISCalcImagePopHist::~RSGISCalcImagePopHist()
     {
         
     }
     
+
+    RSGISPopStatsStripObserver::RSGISPopStatsStripObserver(RSGISCalcImagePopStatsSinglePass *calcStats): RSGISImageStripObserver()
+    {
+        this->calcStats = calcStats;
+    }
+    
+    void RSGISPopStatsStripObserver::observeStrip(unsigned int band, int row, int nRows, int width, double *vals, rsgis::RSGISThreadPool *threadPool)
+    {
+        while(this->threadStats.size() < threadPool->getNumThreads())
+        {
+            this->threadStats.push_back(static_cast<RSGISCalcImagePopStatsSinglePass*>(this->calcStats->clone()));
+        }
+        
+        threadPool->parallelFor(0, nRows, [&](unsigned int t, size_t start, size_t end)
+        {
+            this->threadStats[t]->addBandValues(band-1, vals + (start * width), (end - start) * width);
+        });
+    }
+    
+    void RSGISPopStatsStripObserver::reduce()
+    {
+        for(std::vector<RSGISCalcImagePopStatsSinglePass*>::iterator iterStats = this->threadStats.begin(); iterStats != this->threadStats.end(); ++iterStats)
+        {
+            this->calcStats->reduce(*iterStats);
+            delete *iterStats;
+        }
+        this->threadStats.clear();
+    }
+    
+    RSGISPopStatsStripObserver::~RSGISPopStatsStripObserver()
+    {
+        for(std::vector<RSGISCalcImagePopStatsSinglePass*>::iterator iterStats = this->threadStats.begin(); iterStats != this->threadStats.end(); ++iterStats)
+        {
+            delete *iterStats;
+        }
+    }
+    
+    
+    RSGISPopStatsUpdater::RSGISPopStatsUpdater(GDALDataset *imgDS)
+    {
+        rsgis::utils::RSGISTextUtils textUtils;
+        int numBands = imgDS->GetRasterCount();
+        this->bandStats.resize(numBands);
+        for(int i = 0; i < numBands; ++i)
+        {
+            GDALRasterBand *band = imgDS->GetRasterBand(i+1);
+            BandStatsChange *stats = &this->bandStats[i];
+            int hasNoData = false;
+            stats->noDataVal = band->GetNoDataValue(&hasNoData);
+            stats->useNoData = hasNoData;
+            stats->numChange = 0;
+            stats->sumChange = 0.0;
+            stats->sumSqChange = 0.0;
+            stats->hasNewVals = false;
+            stats->newMin = 0.0;
+            stats->newMax = 0.0;
+            
+            const char *histMin = band->GetMetadataItem("STATISTICS_HISTOMIN");
+            const char *histMax = band->GetMetadataItem("STATISTICS_HISTOMAX");
+            const char *numBins = band->GetMetadataItem("STATISTICS_HISTONUMBINS");
+            const char *binFunc = band->GetMetadataItem("STATISTICS_HISTOBINFUNCTION");
+            stats->hasStats = (band->GetMetadataItem("STATISTICS_MEAN") != NULL) && (band->GetMetadataItem("STATISTICS_STDDEV") != NULL) && (band->GetMetadataItem("STATISTICS_HISTOBINVALUES") != NULL) && (histMin != NULL) && (histMax != NULL) && (numBins != NULL) && (binFunc != NULL);
+            if(!stats->hasStats)
+            {
+                continue;
+            }
+            // The bins are as defined by RSGISPopWithStats::calcPopStats.
+            unsigned int nBins = textUtils.strtoUInt(numBins);
+            stats->histMin = textUtils.strtodouble(histMin);
+            stats->histWidth = 1.0;
+            if(std::string(binFunc) != "direct")
+            {
+                stats->histWidth = (textUtils.strtodouble(histMax) - stats->histMin) / nBins;
+            }
+            stats->histChange.resize(nBins, 0);
+        }
+    }
+    
+    void RSGISPopStatsUpdater::addChange(int band, double oldVal, double newVal)
+    {
+        BandStatsChange *stats = &this->bandStats[band];
+        if(!stats->hasStats)
+        {
+            return;
+        }
+        unsigned int nBins = stats->histChange.size();
+        if(this->validVal(*stats, oldVal))
+        {
+            --stats->numChange;
+            stats->sumChange -= oldVal;
+            stats->sumSqChange -= oldVal * oldVal;
+            --stats->histChange[RSGISCalcImagePopHist::findHistBin(oldVal, stats->histMin, stats->histWidth, nBins)];
+        }
+        if(this->validVal(*stats, newVal))
+        {
+            ++stats->numChange;
+            stats->sumChange += newVal;
+            stats->sumSqChange += newVal * newVal;
+            ++stats->histChange[RSGISCalcImagePopHist::findHistBin(newVal, stats->histMin, stats->histWidth, nBins)];
+            if(!stats->hasNewVals)
+            {
+                stats->newMin = newVal;
+                stats->newMax = newVal;
+                stats->hasNewVals = true;
+            }
+            else if(newVal < stats->newMin)
+            {
+                stats->newMin = newVal;
+            }
+            else if(newVal > stats->newMax)
+            {
+                stats->newMax = newVal;
+            }
+        }
+    }
+    
+    void RSGISPopStatsUpdater::updateStats(GDALDataset *imgDS)
+    {
+        rsgis::utils::RSGISTextUtils textUtils;
+        for(size_t i = 0; i < this->bandStats.size(); ++i)
+        {
+            BandStatsChange *stats = &this->bandStats[i];
+            if(!stats->hasStats)
+            {
+                continue;
+            }
+            GDALRasterBand *band = imgDS->GetRasterBand(i+1);
+            
+            // The number of valid pixels is the total of the histogram.
+            std::vector<std::string> binTokens;
+            textUtils.tokenizeString(std::string(band->GetMetadataItem("STATISTICS_HISTOBINVALUES")), '|', &binTokens);
+            if(binTokens.size() != stats->histChange.size())
+            {
+                continue;
+            }
+            std::vector<unsigned int> hist(binTokens.size());
+            long long numVals = 0;
+            for(size_t j = 0; j < binTokens.size(); ++j)
+            {
+                long long binCount = std::max<long long>(textUtils.strto64bitInt(binTokens[j]) + stats->histChange[j], 0);
+                hist[j] = binCount;
+                numVals += textUtils.strto64bitInt(binTokens[j]);
+            }
+            
+            // Update the sums of the (population) mean and standard deviation.
+            double mean = textUtils.strtodouble(band->GetMetadataItem("STATISTICS_MEAN"));
+            double stdDev = textUtils.strtodouble(band->GetMetadataItem("STATISTICS_STDDEV"));
+            double sum = (mean * numVals) + stats->sumChange;
+            double sumSq = (((stdDev * stdDev) + (mean * mean)) * numVals) + stats->sumSqChange;
+            numVals = std::max<long long>(numVals + stats->numChange, 0);
+            mean = 0.0;
+            stdDev = 0.0;
+            if(numVals > 0)
+            {
+                mean = sum / numVals;
+                stdDev = sqrt(std::max((sumSq / numVals) - (mean * mean), 0.0));
+            }
+            band->SetMetadataItem( "STATISTICS_MEAN", textUtils.doubletostring(mean).c_str(), NULL );
+            band->SetMetadataItem( "STATISTICS_STDDEV", textUtils.doubletostring(stdDev).c_str(), NULL );
+            
+            if(stats->hasNewVals)
+            {
+                const char *minStr = band->GetMetadataItem("STATISTICS_MINIMUM");
+                const char *maxStr = band->GetMetadataItem("STATISTICS_MAXIMUM");
+                double minVal = (minStr == NULL)?stats->newMin:std::min(textUtils.strtodouble(minStr), stats->newMin);
+                double maxVal = (maxStr == NULL)?stats->newMax:std::max(textUtils.strtodouble(maxStr), stats->newMax);
+                band->SetMetadataItem( "STATISTICS_MINIMUM", textUtils.doubletostring(minVal).c_str(), NULL );
+                band->SetMetadataItem( "STATISTICS_MAXIMUM", textUtils.doubletostring(maxVal).c_str(), NULL );
+            }
+            
+            RSGISPopWithStats::writeHistogram(band, hist, stats->histMin, stats->histWidth, numVals);
+        }
+    }
+    
 }}
  
 
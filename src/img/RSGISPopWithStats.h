@@ -33,6 +33,7 @@
 #include <stdlib.h>
 #include <ctime>
 #include <cmath>
+#include <vector>
 
 #include "gdal_priv.h"
 #include "gdal_rat.h"
@@ -46,6 +47,7 @@
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISImagePyramids.h"
 
 #include "utils/RSGISTextUtils.h"
 
@@ -83,55 +85,151 @@ namespace rsgis { namespace img {
     {
     public:
         RSGISPopWithStats(){};
-        void calcPopStats( GDALDataset *imgDS, bool useNoDataVal, float noDataVal, bool calcPyramid, std::vector<int> decimatFactors=std::vector<int>());
+        /**
+         * Populate the image with statistics (min, max, mean, stddev, mode, median and
+         * histogram). Bands with 8 and 16 bit integer data types are read once, other
+         * data types need a second read of the image to populate the histogram. The
+         * pyramids are built from the same read of the image as the statistics. The
+         * image is processed using numThreads threads (0 uses all available cores).
+         */
+        void calcPopStats( GDALDataset *imgDS, bool useNoDataVal, float noDataVal, bool calcPyramid, std::vector<int> decimatFactors=std::vector<int>(), unsigned int numThreads=1);
+        /**
+         * Write the histogram (bins of histWidth from histMin) of the nVals pixels of the band
+         * with the mode and median derived from it, as the band metadata and the Histogram
+         * column of the attribute table.
+         */
+        static void writeHistogram(GDALRasterBand *band, std::vector<unsigned int> &hist, double histMin, double histWidth, unsigned long nVals);
         ~RSGISPopWithStats(){};
     private:
-        void addPyramids(GDALDataset *imgDS, std::vector<int> decimatFactors);
-        unsigned int findColumnIndexOrCreate(GDALRasterAttributeTable *gdalATT, std::string colName, GDALRATFieldType dType, GDALRATFieldUsage dUsage=GFU_Generic);
+        static unsigned int findColumnIndexOrCreate(GDALRasterAttributeTable *gdalATT, std::string colName, GDALRATFieldType dType, GDALRATFieldUsage dUsage=GFU_Generic);
     };
     
+    /**
+     * Updates the statistics populated by RSGISPopWithStats::calcPopStats where pixels
+     * of the image have changed (e.g., new images included in a mosaic) without reading
+     * the rest of the image. The old and new value of each changed pixel is given to
+     * addChange, from which the number of valid pixels, the mean, the standard deviation
+     * and the histogram (and so the mode and median) are updated exactly. The minimum and
+     * maximum can only be widened, as the values removed might have been the extremes,
+     * and new values outside of the histogram range are counted in the end bins. Pixels
+     * equal to the no data value of the band (or NaN) are not valid.
+     */
+    class DllExport RSGISPopStatsUpdater
+    {
+    public:
+        RSGISPopStatsUpdater(GDALDataset *imgDS);
+        /** Whether band (from 0) has statistics which can be updated. */
+        bool hasStats(int band){return this->bandStats[band].hasStats;};
+        /** Record that a pixel of band (from 0) has changed from oldVal to newVal. */
+        void addChange(int band, double oldVal, double newVal);
+        /** Write the updated statistics of the bands which have statistics to imgDS. */
+        void updateStats(GDALDataset *imgDS);
+        ~RSGISPopStatsUpdater(){};
+    protected:
+        struct BandStatsChange
+        {
+            bool hasStats;
+            bool useNoData;
+            double noDataVal;
+            double histMin;
+            double histWidth;
+            // The change in the number, sum and sum of squares of the valid pixel values.
+            long long numChange;
+            double sumChange;
+            double sumSqChange;
+            bool hasNewVals;
+            double newMin;
+            double newMax;
+            std::vector<long long> histChange;
+        };
+        inline bool validVal(const BandStatsChange &stats, double val)
+        {
+            return !(std::isnan(val) || (stats.useNoData && (val == stats.noDataVal)));
+        };
+        std::vector<BandStatsChange> bandStats;
+    };
     
     
     
-    class DllExport RSGISCalcImageMinMaxMean : public RSGISCalcImageValue
+    
+    /**
+     * Calculates the min, max, mean and standard deviation (using Welford's algorithm)
+     * of each band in a single pass. For bands where directHistSize is greater than 0 a
+     * histogram of the (integer) pixel values, starting at directHistMin, is also counted.
+     * Threads accumulate their own values which are merged with reduce.
+     */
+    class DllExport RSGISCalcImagePopStatsSinglePass : public RSGISCalcImageValue
     {
     public:
-        RSGISCalcImageMinMaxMean(int numVals, bool useNoData, double noDataVal, double *minVal, double *maxVal, double *sumVal, unsigned long *nVals);
+        RSGISCalcImagePopStatsSinglePass(int numVals, bool useNoData, double noDataVal, std::vector<long> directHistMin, std::vector<unsigned long> directHistSize);
         void calcImageValue(float *bandValues, int numBands);
-        ~RSGISCalcImageMinMaxMean();
+        RSGISCalcImageValue* clone();
+        void reduce(RSGISCalcImageValue *other);
+        double getMin(int band){return this->minVal[band];};
+        double getMax(int band){return this->maxVal[band];};
+        double getMean(int band);
+        double getStdDev(int band);
+        unsigned long getNumVals(int band){return this->nVals[band];};
+        const std::vector<unsigned long>& getDirectHistogram(int band){return this->directHist[band];};
+        /** Add numPxls values of a single band (numbered from 0). */
+        void addBandValues(int band, double *vals, size_t numPxls);
+        ~RSGISCalcImagePopStatsSinglePass();
     protected:
-        bool *first;
+        void addValue(int band, double val);
         int numVals;
         bool useNoData;
         double noDataVal;
-        double *minVal;
-        double *maxVal;
-        double *sumVal;
-        unsigned long *nVals;
+        std::vector<long> directHistMin;
+        std::vector<unsigned long> directHistSize;
+        std::vector<double> minVal;
+        std::vector<double> maxVal;
+        std::vector<double> sumVal;
+        std::vector<double> meanVal;
+        std::vector<double> m2Val;
+        std::vector<unsigned long> nVals;
+        std::vector< std::vector<unsigned long> > directHist;
     };
     
+    /**
+     * Passes the image strips read while the pyramids are built by the
+     * RSGISImagePyramidBuilder to a RSGISCalcImagePopStatsSinglePass object, with
+     * a copy for each thread which are merged into calcStats by reduce().
+     */
+    class DllExport RSGISPopStatsStripObserver : public RSGISImageStripObserver
+    {
+    public:
+        RSGISPopStatsStripObserver(RSGISCalcImagePopStatsSinglePass *calcStats);
+        void observeStrip(unsigned int band, int row, int nRows, int width, double *vals, rsgis::RSGISThreadPool *threadPool);
+        void reduce();
+        ~RSGISPopStatsStripObserver();
+    protected:
+        RSGISCalcImagePopStatsSinglePass *calcStats;
+        std::vector<RSGISCalcImagePopStatsSinglePass*> threadStats;
+    };
     
-    class DllExport RSGISCalcImageStdDevPopHist : public RSGISCalcImageValue
+    /**
+     * Calculates the histogram (numBins bins of width histWidth from minVal) for
+     * the bands where calcBandHist is true.
+     */
+    class DllExport RSGISCalcImagePopHist : public RSGISCalcImageValue
     {
     public:
-        RSGISCalcImageStdDevPopHist(int numVals, bool useNoData, double noDataVal, double *minVal, double *maxVal, double *meanVal, double *sumVal, unsigned long *nVals, double *histMin, double *histMax, double *histWidth, unsigned int **bandHist, unsigned int numBins);
+        RSGISCalcImagePopHist(int numVals, bool useNoData, double noDataVal, std::vector<double> minVal, std::vector<double> histWidth, std::vector<bool> calcBandHist, unsigned int numBins);
         void calcImageValue(float *bandValues, int numBands);
-        ~RSGISCalcImageStdDevPopHist();
+        RSGISCalcImageValue* clone();
+        void reduce(RSGISCalcImageValue *other);
+        const std::vector<unsigned long>& getHistogram(int band){return this->bandHist[band];};
+        static unsigned int findHistBin(double val, double minVal, double histWidth, unsigned int numBins);
+        ~RSGISCalcImagePopHist();
     protected:
-        bool *first;
         int numVals;
         bool useNoData;
         double noDataVal;
-        double *minVal;
-        double *maxVal;
-        double *meanVal;
-        double *sumVal;
-        unsigned long *nVals;
-        double *histMin;
-        double *histMax;
-        double *histWidth;
-        unsigned int **bandHist;
+        std::vector<double> minVal;
+        std::vector<double> histWidth;
+        std::vector<bool> calcBandHist;
         unsigned int numBins;
+        std::vector< std::vector<unsigned long> > bandHist;
     };
 
 }}
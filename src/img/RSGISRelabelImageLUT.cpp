@@ -0,0 +1,231 @@
+/*
+ *  RSGISRelabelImageLUT.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISRelabelImageLUT.h"
+
+namespace rsgis { namespace img {
+
+    RSGISRelabelImageLUT::RSGISRelabelImageLUT(unsigned int numThreads)
+    {
+        this->numThreads = numThreads;
+        if(this->numThreads == 0)
+        {
+            this->numThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+        }
+    }
+
+    void RSGISRelabelImageLUT::relabelImage(GDALDataset *inImage, unsigned int inBand, GDALDataset *outImage, unsigned int outBand, const std::vector<uint32_t> &lut)
+    {
+        if((inBand == 0) || (inBand > ((unsigned int)inImage->GetRasterCount())))
+        {
+            throw RSGISImageCalcException("The input band is not within the input image.");
+        }
+        if((outBand == 0) || (outBand > ((unsigned int)outImage->GetRasterCount())))
+        {
+            throw RSGISImageCalcException("The output band is not within the output image.");
+        }
+        this->relabelBand<uint32_t, uint32_t>(inImage->GetRasterBand(inBand), outImage->GetRasterBand(outBand), lut, GDT_UInt32, GDT_UInt32);
+    }
+
+    void RSGISRelabelImageLUT::relabelImage(GDALDataset *inImage, unsigned int inBand, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType, const std::vector<uint32_t> &lut)
+    {
+        GDALDataset *outImage = this->createOutputImage(inImage, outputImage, gdalFormat, gdalDataType);
+        try
+        {
+            this->relabelImage(inImage, inBand, outImage, 1, lut);
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            GDALClose(outImage);
+            throw e;
+        }
+        GDALClose(outImage);
+    }
+
+    void RSGISRelabelImageLUT::relabelImage(GDALDataset *inImage, unsigned int inBand, GDALDataset *outImage, unsigned int outBand, const std::vector<uint64_t> &lut)
+    {
+        if((inBand == 0) || (inBand > ((unsigned int)inImage->GetRasterCount())))
+        {
+            throw RSGISImageCalcException("The input band is not within the input image.");
+        }
+        if((outBand == 0) || (outBand > ((unsigned int)outImage->GetRasterCount())))
+        {
+            throw RSGISImageCalcException("The output band is not within the output image.");
+        }
+        this->relabelBand<uint64_t, uint64_t>(inImage->GetRasterBand(inBand), outImage->GetRasterBand(outBand), lut, GDT_UInt64, GDT_UInt64);
+    }
+
+    void RSGISRelabelImageLUT::relabelImage(GDALDataset *inImage, unsigned int inBand, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType, const std::vector<uint64_t> &lut)
+    {
+        GDALDataset *outImage = this->createOutputImage(inImage, outputImage, gdalFormat, gdalDataType);
+        try
+        {
+            this->relabelImage(inImage, inBand, outImage, 1, lut);
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            GDALClose(outImage);
+            throw e;
+        }
+        GDALClose(outImage);
+    }
+
+    void RSGISRelabelImageLUT::relabelImage(GDALDataset *inImage, unsigned int inBand, GDALDataset *outImage, unsigned int outBand, const std::vector<double> &lut)
+    {
+        if((inBand == 0) || (inBand > ((unsigned int)inImage->GetRasterCount())))
+        {
+            throw RSGISImageCalcException("The input band is not within the input image.");
+        }
+        if((outBand == 0) || (outBand > ((unsigned int)outImage->GetRasterCount())))
+        {
+            throw RSGISImageCalcException("The output band is not within the output image.");
+        }
+        this->relabelBand<uint32_t, double>(inImage->GetRasterBand(inBand), outImage->GetRasterBand(outBand), lut, GDT_UInt32, GDT_Float64);
+    }
+
+    void RSGISRelabelImageLUT::relabelImage(GDALDataset *inImage, unsigned int inBand, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType, const std::vector<double> &lut, std::string bandName)
+    {
+        GDALDataset *outImage = this->createOutputImage(inImage, outputImage, gdalFormat, gdalDataType);
+        try
+        {
+            if(bandName != "")
+            {
+                outImage->GetRasterBand(1)->SetDescription(bandName.c_str());
+            }
+            this->relabelImage(inImage, inBand, outImage, 1, lut);
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            GDALClose(outImage);
+            throw e;
+        }
+        GDALClose(outImage);
+    }
+
+    template <typename InT, typename T> void RSGISRelabelImageLUT::relabelBand(GDALRasterBand *inBand, GDALRasterBand *outBand, const std::vector<T> &lut, GDALDataType inBufType, GDALDataType bufType)
+    {
+        if(lut.empty())
+        {
+            throw RSGISImageCalcException("The look up table is empty.");
+        }
+
+        unsigned int width = inBand->GetXSize();
+        unsigned int height = inBand->GetYSize();
+        if((outBand->GetXSize() != (int)width) || (outBand->GetYSize() != (int)height))
+        {
+            throw RSGISImageCalcException("The input and output images are not the same size.");
+        }
+
+        // Read strips which are a multiple of the block height and at least 64 rows
+        // so each thread has a reasonable number of pixels to process.
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        inBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        if(yBlockSize < 1)
+        {
+            yBlockSize = 1;
+        }
+        unsigned int stripRows = yBlockSize * ((64 + yBlockSize - 1) / yBlockSize);
+        if(stripRows > height)
+        {
+            stripRows = height;
+        }
+
+        std::vector<InT> inData(((size_t)width) * stripRows);
+        std::vector<T> outData(((size_t)width) * stripRows);
+        const InT *inPtr = inData.data();
+        T *outPtr = outData.data();
+        const T *lutPtr = lut.data();
+        const InT lutMax = (((uint64_t)lut.size()-1) > std::numeric_limits<InT>::max())?std::numeric_limits<InT>::max():(lut.size()-1);
+
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        std::vector<InT> threadMaxVals(threadPool.getNumThreads());
+
+        // Check the strip is within the look up table before the gather so both
+        // loops are branch free and can be vectorised by the compiler.
+        auto findMaxVal = [&](unsigned int t, size_t s, size_t e)
+        {
+            InT maxVal = 0;
+            for(size_t i = s; i < e; ++i)
+            {
+                maxVal = std::max(maxVal, inPtr[i]);
+            }
+            threadMaxVals[t] = std::max(threadMaxVals[t], maxVal);
+        };
+        auto applyLUT = [&](unsigned int t, size_t s, size_t e)
+        {
+            for(size_t i = s; i < e; ++i)
+            {
+                outPtr[i] = lutPtr[inPtr[i]];
+            }
+        };
+
+        rsgis_tqdm pbar;
+        for(unsigned int row = 0; row < height; row += stripRows)
+        {
+            unsigned int nRows = std::min(stripRows, height - row);
+            size_t nPxls = ((size_t)width) * nRows;
+            pbar.progress(row, height);
+
+            if(inBand->RasterIO(GF_Read, 0, row, width, nRows, inData.data(), width, nRows, inBufType, 0, 0) != CE_None)
+            {
+                throw RSGISImageCalcException("Failed to read the input image.");
+            }
+
+            std::fill(threadMaxVals.begin(), threadMaxVals.end(), 0);
+            threadPool.parallelFor(0, nPxls, findMaxVal);
+            if(*std::max_element(threadMaxVals.begin(), threadMaxVals.end()) > lutMax)
+            {
+                throw RSGISImageCalcException("Image pixel value was not within the look up table.");
+            }
+
+            threadPool.parallelFor(0, nPxls, applyLUT);
+
+            if(outBand->RasterIO(GF_Write, 0, row, width, nRows, outData.data(), width, nRows, bufType, 0, 0) != CE_None)
+            {
+                throw RSGISImageCalcException("Failed to write the output image.");
+            }
+        }
+        pbar.finish();
+    }
+
+    GDALDataset* RSGISRelabelImageLUT::createOutputImage(GDALDataset *inImage, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType)
+    {
+        GDALDataset *outImage = NULL;
+        try
+        {
+            RSGISImageUtils imgUtils;
+            outImage = imgUtils.createCopy(inImage, 1, outputImage, gdalFormat, gdalDataType);
+        }
+        catch(rsgis::RSGISImageException &e)
+        {
+            throw RSGISImageCalcException(e.what());
+        }
+        return outImage;
+    }
+
+    RSGISRelabelImageLUT::~RSGISRelabelImageLUT()
+    {
+
+    }
+
+}}
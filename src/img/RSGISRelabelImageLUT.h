@@ -0,0 +1,91 @@
+/*
+ *  RSGISRelabelImageLUT.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISRelabelImageLUT_H
+#define RSGISRelabelImageLUT_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <stdint.h>
+
+#include "gdal_priv.h"
+
+#include "common/rsgis-tqdm.h"
+#include "common/RSGISThreadPool.h"
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageUtils.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis { namespace img {
+
+    /**
+     * Relabel an integer image (e.g., clumps) using a look up table, such that
+     * out[i] = lut[in[i]]. Strips of rows are read and written as unsigned 32 bit
+     * integers (unsigned 64 bit integers for a 64 bit look up table, or doubles
+     * for a floating point look up table) and the pixels of
+     * each strip are split between the threads, rather than calling an
+     * RSGISCalcImageValue for each pixel. Pixel values outside of the look up
+     * table result in an RSGISImageCalcException.
+     */
+    class DllExport RSGISRelabelImageLUT
+    {
+    public:
+        /** If numThreads is 0 all the available cores are used. */
+        RSGISRelabelImageLUT(unsigned int numThreads=1);
+        /** Relabel inBand (from 1) of inImage into outBand of outImage, which must be the same size. */
+        void relabelImage(GDALDataset *inImage, unsigned int inBand, GDALDataset *outImage, unsigned int outBand, const std::vector<uint32_t> &lut);
+        /** Relabel inBand (from 1) of inImage into a new single band image. */
+        void relabelImage(GDALDataset *inImage, unsigned int inBand, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType, const std::vector<uint32_t> &lut);
+        /** Relabel inBand (from 1) of inImage into outBand of outImage, which must be the same size, with 64 bit input and output values. */
+        void relabelImage(GDALDataset *inImage, unsigned int inBand, GDALDataset *outImage, unsigned int outBand, const std::vector<uint64_t> &lut);
+        /** Relabel inBand (from 1) of inImage into a new single band image, with 64 bit input and output values. */
+        void relabelImage(GDALDataset *inImage, unsigned int inBand, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType, const std::vector<uint64_t> &lut);
+        /** Relabel inBand (from 1) of inImage into outBand of outImage, which must be the same size. */
+        void relabelImage(GDALDataset *inImage, unsigned int inBand, GDALDataset *outImage, unsigned int outBand, const std::vector<double> &lut);
+        /** Relabel inBand (from 1) of inImage into a new single band image, where the output band is named bandName (if not empty). */
+        void relabelImage(GDALDataset *inImage, unsigned int inBand, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType, const std::vector<double> &lut, std::string bandName="");
+        ~RSGISRelabelImageLUT();
+    protected:
+        template <typename InT, typename T> void relabelBand(GDALRasterBand *inBand, GDALRasterBand *outBand, const std::vector<T> &lut, GDALDataType inBufType, GDALDataType bufType);
+        GDALDataset* createOutputImage(GDALDataset *inImage, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType);
+        unsigned int numThreads;
+    };
+
+}}
+
+#endif
@@ -39,12 +39,16 @@ namespace rsgis { namespace img {
             gsl_matrix *lut = matrixUtils.readGSLMatrixFromGridTxt(matrixLUTFile);
             
 			RSGISCalcImageValue *calcImageValue = new RSGISRelabelPixelValuesFromLUTCalcVal(inData->GetRasterCount(), lut);            
-            RSGISCalcImage calcImage = RSGISCalcImage(calcImageValue, "", true);
             
             GDALDataset **datasets = new GDALDataset*[1];
             datasets[0] = inData;
             
-            calcImage.calcImage(datasets, 1, outputFile, false, NULL, imageFormat);
+            // For 8 and 16 bit images search the LUT once for each pixel value rather than for each pixel.
+            if(!RSGISCalcImageLUT::calcImage(calcImageValue, std::vector<int>(), datasets, 1, outputFile, false, NULL, imageFormat, GDT_Float32, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads))
+            {
+                RSGISCalcImage calcImage = RSGISCalcImage(calcImageValue, "", true);
+                calcImage.calcImage(datasets, 1, outputFile, false, NULL, imageFormat);
+            }
             
             delete[] datasets;
             delete calcImageValue;
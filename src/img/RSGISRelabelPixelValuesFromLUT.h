@@ -26,8 +26,10 @@
 
 #include <cmath>
 #include <limits>
+#include <vector>
 
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISCalcImageT.h"
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISImageBandException.h"
 #include "img/RSGISImageCalcException.h"
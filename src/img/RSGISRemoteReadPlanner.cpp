@@ -0,0 +1,266 @@
+/*
+ *  RSGISRemoteReadPlanner.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISRemoteReadPlanner.h"
+
+namespace rsgis{namespace img{
+    
+    RSGISRemoteReadPlanner::RSGISRemoteReadPlanner(GDALDataset **datasets, int numDS, int **dsOffsets, int width, int height, int stripRows, unsigned int maxRequests)
+    {
+        this->datasets = datasets;
+        this->numDS = numDS;
+        this->width = width;
+        this->height = height;
+        this->stripRows = stripRows;
+        this->maxRequests = maxRequests;
+        this->numRemoteDS = 0;
+        this->requestPool = NULL;
+        this->stagedRow = -1;
+        this->stagedRows = 0;
+        
+        this->handles.resize(numDS);
+        int numBands = 0;
+        try
+        {
+            for(int i = 0; i < numDS; ++i)
+            {
+                this->dsXOff.push_back(dsOffsets[i][0]);
+                this->dsYOff.push_back(dsOffsets[i][1]);
+                this->dsFirstBand.push_back(numBands);
+                numBands += datasets[i]->GetRasterCount();
+                
+                bool remote = (maxRequests > 0) && (datasets[i]->GetRasterCount() > 0) && RSGISRemoteReadPlanner::isRemotePath(datasets[i]->GetDescription());
+                this->dsRemote.push_back(remote);
+                int xBlockSize = 0;
+                int yBlockSize = 0;
+                if(remote)
+                {
+                    datasets[i]->GetRasterBand(1)->GetBlockSize(&xBlockSize, &yBlockSize);
+                    ++this->numRemoteDS;
+                    // Each request thread needs its own handle as a GDALDataset can only be used by one thread at a time.
+                    for(unsigned int t = 0; t < maxRequests; ++t)
+                    {
+                        GDALDataset *handle = (GDALDataset *) GDALOpen(datasets[i]->GetDescription(), GA_ReadOnly);
+                        if(handle == NULL)
+                        {
+                            std::string message = std::string("Could not open the remote image ") + datasets[i]->GetDescription();
+                            throw RSGISImageCalcException(message.c_str());
+                        }
+                        this->handles[i].push_back(handle);
+                    }
+                }
+                this->tileXSize.push_back(std::max(xBlockSize, 1));
+                this->tileYSize.push_back(std::max(yBlockSize, 1));
+            }
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            for(size_t i = 0; i < this->handles.size(); ++i)
+            {
+                for(size_t t = 0; t < this->handles[i].size(); ++t)
+                {
+                    GDALClose(this->handles[i][t]);
+                }
+            }
+            throw e;
+        }
+        
+        if(this->numRemoteDS > 0)
+        {
+            this->stagingData.resize(numBands);
+            for(int i = 0; i < numDS; ++i)
+            {
+                if(this->dsRemote[i])
+                {
+                    for(int n = 0; n < datasets[i]->GetRasterCount(); ++n)
+                    {
+                        this->stagingData[this->dsFirstBand[i] + n].resize(((size_t)width) * stripRows);
+                    }
+                }
+            }
+            this->requestPool = new rsgis::RSGISThreadPool(maxRequests);
+        }
+    }
+    
+    void RSGISRemoteReadPlanner::readStrip(int row, int nRows, float **stripBands)
+    {
+        size_t stripPxls = ((size_t)this->width) * nRows;
+        if(this->numRemoteDS > 0)
+        {
+            this->waitForPrefetch();
+            if((this->stagedRow != row) || (this->stagedRows != nRows))
+            {
+                this->fetchStrip(row, nRows);
+            }
+            for(int i = 0; i < this->numDS; ++i)
+            {
+                if(this->dsRemote[i])
+                {
+                    for(int n = 0; n < this->datasets[i]->GetRasterCount(); ++n)
+                    {
+                        int band = this->dsFirstBand[i] + n;
+                        std::copy(this->stagingData[band].begin(), this->stagingData[band].begin() + stripPxls, stripBands[band]);
+                    }
+                }
+            }
+        }
+        
+        for(int i = 0; i < this->numDS; ++i)
+        {
+            if(!this->dsRemote[i])
+            {
+                for(int n = 0; n < this->datasets[i]->GetRasterCount(); ++n)
+                {
+                    if(this->datasets[i]->GetRasterBand(n+1)->RasterIO(GF_Read, this->dsXOff[i], this->dsYOff[i] + row, this->width, nRows, stripBands[this->dsFirstBand[i] + n], this->width, nRows, GDT_Float32, 0, 0) != CE_None)
+                    {
+                        throw RSGISImageCalcException("Failed to read the input image data.");
+                    }
+                }
+            }
+        }
+        
+        // Fetch the next strip of the remote images while the caller processes this strip.
+        int nextRow = row + nRows;
+        if((this->numRemoteDS > 0) && (nextRow < this->height))
+        {
+            int nextRows = std::min(this->stripRows, this->height - nextRow);
+            this->prefetch = std::async(std::launch::async, [this, nextRow, nextRows](){this->fetchStrip(nextRow, nextRows);});
+        }
+    }
+    
+    bool RSGISRemoteReadPlanner::isRemotePath(std::string path)
+    {
+        // The network file systems may also be chained with others (e.g., /vsizip//vsis3/).
+        const char *remotePrefixes[] = {"/vsicurl/", "/vsicurl_streaming/", "/vsis3/", "/vsis3_streaming/", "/vsigs/", "/vsigs_streaming/", "/vsiaz/", "/vsiaz_streaming/", "/vsiadls/", "/vsioss/", "/vsioss_streaming/", "/vsiswift/", "/vsiswift_streaming/", "/vsiwebhdfs/", "/vsihdfs/"};
+        for(const char *prefix : remotePrefixes)
+        {
+            if(path.find(prefix) != std::string::npos)
+            {
+                return true;
+            }
+        }
+        return (path.compare(0, 7, "http://") == 0) || (path.compare(0, 8, "https://") == 0);
+    }
+    
+    void RSGISRemoteReadPlanner::planWindows(unsigned int ds, int row, int nRows, std::vector<RSGISRemoteReadWindow> *windows)
+    {
+        int tileX = this->tileXSize[ds];
+        int tileY = this->tileYSize[ds];
+        int x0 = this->dsXOff[ds];
+        int x1 = x0 + this->width;
+        int y0 = this->dsYOff[ds] + row;
+        int y1 = y0 + nRows;
+        int firstTileCol = x0 / tileX;
+        int firstTileRow = y0 / tileY;
+        int nTileCols = ((x1 - 1) / tileX) - firstTileCol + 1;
+        int nTileRows = ((y1 - 1) / tileY) - firstTileRow + 1;
+        
+        // Split the tile columns between the requests and, if there are fewer tile columns than requests, the tile rows.
+        int colGroups = std::min<int>(this->maxRequests, nTileCols);
+        int rowGroups = std::min<int>(std::max<int>(1, this->maxRequests / colGroups), nTileRows);
+        for(int r = 0; r < rowGroups; ++r)
+        {
+            int wY0 = std::max(y0, (firstTileRow + ((r * nTileRows) / rowGroups)) * tileY);
+            int wY1 = std::min(y1, (firstTileRow + (((r + 1) * nTileRows) / rowGroups)) * tileY);
+            for(int c = 0; c < colGroups; ++c)
+            {
+                int wX0 = std::max(x0, (firstTileCol + ((c * nTileCols) / colGroups)) * tileX);
+                int wX1 = std::min(x1, (firstTileCol + (((c + 1) * nTileCols) / colGroups)) * tileX);
+                RSGISRemoteReadWindow window;
+                window.ds = ds;
+                window.xOff = wX0;
+                window.yOff = wY0;
+                window.xSize = wX1 - wX0;
+                window.ySize = wY1 - wY0;
+                windows->push_back(window);
+            }
+        }
+    }
+    
+    void RSGISRemoteReadPlanner::fetchStrip(int row, int nRows)
+    {
+        this->stagedRow = -1;
+        std::vector<RSGISRemoteReadWindow> windows;
+        for(int i = 0; i < this->numDS; ++i)
+        {
+            if(this->dsRemote[i])
+            {
+                this->planWindows(i, row, nRows, &windows);
+            }
+        }
+        
+        this->requestPool->parallelFor(0, windows.size(), [&](unsigned int t, size_t wStart, size_t wEnd)
+        {
+            for(size_t w = wStart; w < wEnd; ++w)
+            {
+                const RSGISRemoteReadWindow &window = windows[w];
+                GDALDataset *handle = this->handles[window.ds][t];
+                int numBands = handle->GetRasterCount();
+                handle->AdviseRead(window.xOff, window.yOff, window.xSize, window.ySize, window.xSize, window.ySize, GDT_Float32, numBands, NULL, NULL);
+                size_t pxlOff = (((size_t)(window.yOff - (this->dsYOff[window.ds] + row))) * this->width) + (window.xOff - this->dsXOff[window.ds]);
+                for(int n = 0; n < numBands; ++n)
+                {
+                    float *bandData = this->stagingData[this->dsFirstBand[window.ds] + n].data() + pxlOff;
+                    if(handle->GetRasterBand(n+1)->RasterIO(GF_Read, window.xOff, window.yOff, window.xSize, window.ySize, bandData, window.xSize, window.ySize, GDT_Float32, sizeof(float), ((GSpacing)this->width) * sizeof(float)) != CE_None)
+                    {
+                        throw RSGISImageCalcException("Failed to read the remote input image data.");
+                    }
+                }
+            }
+        });
+        this->stagedRow = row;
+        this->stagedRows = nRows;
+    }
+    
+    void RSGISRemoteReadPlanner::waitForPrefetch()
+    {
+        if(this->prefetch.valid())
+        {
+            this->prefetch.get();
+        }
+    }
+    
+    RSGISRemoteReadPlanner::~RSGISRemoteReadPlanner()
+    {
+        try
+        {
+            this->waitForPrefetch();
+        }
+        catch(std::exception &e)
+        {
+            // The strip is no longer needed.
+        }
+        if(this->requestPool != NULL)
+        {
+            delete this->requestPool;
+        }
+        for(size_t i = 0; i < this->handles.size(); ++i)
+        {
+            for(size_t t = 0; t < this->handles[i].size(); ++t)
+            {
+                GDALClose(this->handles[i][t]);
+            }
+        }
+    }
+    
+}}
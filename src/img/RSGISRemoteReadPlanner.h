@@ -0,0 +1,120 @@
+/*
+ *  RSGISRemoteReadPlanner.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISRemoteReadPlanner_H
+#define RSGISRemoteReadPlanner_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <future>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISThreadPool.h"
+
+#include "img/RSGISImageCalcException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+    
+    /** A tile aligned window of a remote input image which is read with a single handle. */
+    struct DllExport RSGISRemoteReadWindow
+    {
+        unsigned int ds;
+        int xOff;
+        int yOff;
+        int xSize;
+        int ySize;
+    };
+    
+    /**
+     * Reads the strips of the input images for the image calculation engines where some
+     * of the inputs are read through the GDAL network file systems (e.g., /vsis3/ or
+     * /vsigs/ cloud optimised GeoTIFFs). Reading a full width strip of a remote image band
+     * by band results in many small range requests, so each strip of a remote image is
+     * instead split into (at most maxRequests) windows aligned to the tiles of the image.
+     * Each window is read for all the bands on its own thread with its own handle on the
+     * image, after GDALDataset::AdviseRead so the driver can merge the tiles of the window
+     * into large range requests. Once a strip has been read the next strip is fetched in
+     * the background, while the caller processes the current strip. Local inputs are read
+     * as normal on the calling thread.
+     */
+    class DllExport RSGISRemoteReadPlanner
+    {
+    public:
+        /**
+         * The strips are stripRows (or fewer for the last strip) of the width x height overlap of
+         * the datasets, where dsOffsets are the pixel offsets of the overlap in each dataset. If
+         * maxRequests is 0 the remote inputs are read in the same way as the local inputs.
+         */
+        RSGISRemoteReadPlanner(GDALDataset **datasets, int numDS, int **dsOffsets, int width, int height, int stripRows, unsigned int maxRequests);
+        /** Whether any of the inputs are remote, otherwise readStrip does not need to be used. */
+        bool hasRemoteInputs(){return this->numRemoteDS > 0;};
+        /** Read the rows [row, row+nRows) of the overlap for all the bands of all the datasets (in order) as floats. */
+        void readStrip(int row, int nRows, float **stripBands);
+        /** Returns true if the path is read through one of the GDAL network file systems. */
+        static bool isRemotePath(std::string path);
+        ~RSGISRemoteReadPlanner();
+    protected:
+        void planWindows(unsigned int ds, int row, int nRows, std::vector<RSGISRemoteReadWindow> *windows);
+        void fetchStrip(int row, int nRows);
+        void waitForPrefetch();
+        GDALDataset **datasets;
+        int numDS;
+        int width;
+        int height;
+        int stripRows;
+        unsigned int maxRequests;
+        unsigned int numRemoteDS;
+        std::vector<int> dsXOff;
+        std::vector<int> dsYOff;
+        std::vector<int> dsFirstBand;
+        std::vector<bool> dsRemote;
+        std::vector<int> tileXSize;
+        std::vector<int> tileYSize;
+        // handles[ds][t] is the handle on remote dataset ds used by request thread t.
+        std::vector<std::vector<GDALDataset*> > handles;
+        std::vector<std::vector<float> > stagingData;
+        rsgis::RSGISThreadPool *requestPool;
+        std::future<void> prefetch;
+        int stagedRow;
+        int stagedRows;
+    };
+    
+}}
+
+#endif
@@ -164,23 +164,20 @@ namespace rsgis{namespace img{
         {
             RSGISImageUtils imgUtils;
             
-            unsigned int numMskVals = maskVals.size();
-            std::vector<std::pair<long, long> > *maskPxlLocs = new std::vector<std::pair<long, long> >[numMskVals];
-            
-            RSGISGetPxlLocAsVec getPxlLoc = RSGISGetPxlLocAsVec(maskVals, maskPxlLocs, imgBand);
-            RSGISCalcImage calcImg = RSGISCalcImage(&getPxlLoc, "", true);
-            calcImg.calcImagePosPxl(&inputImage, 1, 0);
+            // The pixel locations of the mask values, from the image's pixel index sidecar if one has been saved.
+            RSGISClassPixelIndex pxlIndex;
+            pxlIndex.loadOrCreateIndex(inputImage, imgBand);
             
             unsigned int maxNPxls = 0;
             for(int i = 0; i < maskVals.size(); ++i)
             {
                 if(i == 0)
                 {
-                    maxNPxls = maskPxlLocs[i].size();
+                    maxNPxls = pxlIndex.getNumPxls(maskVals.at(i));
                 }
-                else if(maskPxlLocs[i].size() > maxNPxls)
+                else if(pxlIndex.getNumPxls(maskVals.at(i)) > maxNPxls)
                 {
-                    maxNPxls = maskPxlLocs[i].size();
+                    maxNPxls = pxlIndex.getNumPxls(maskVals.at(i));
                 }
             }
             
@@ -200,18 +197,18 @@ namespace rsgis{namespace img{
             {
                 foundSamples = false;
                 samplesCount = 0;
-                if(!maskPxlLocs[i].empty())
+                unsigned int nMaskValPxls = pxlIndex.getNumPxls(maskVals.at(i));
+                if(nMaskValPxls > 0)
                 {
                     for(unsigned long j = 0; j < numSamples; ++j)
                     {
                         pxlIdx = pxlGen();
-                        while(pxlIdx >= maskPxlLocs[i].size())
+                        while(pxlIdx >= nMaskValPxls)
                         {
                             pxlIdx = pxlGen();
                         }
                         
-                        xPxl = maskPxlLocs[i].at(pxlIdx).first;
-                        yPxl = maskPxlLocs[i].at(pxlIdx).second;
+                        pxlIndex.getPixel(maskVals.at(i), pxlIdx, &xPxl, &yPxl);
                         
                         imgUtils.setPixelValue(outputImage, imgBand, xPxl, yPxl, maskVals.at(i));
                     }
@@ -219,11 +216,165 @@ namespace rsgis{namespace img{
                 else
                 {
                     std::cerr << "No samples with mask value " << maskVals.at(i) << std::endl;
-                    delete[] maskPxlLocs;
                     throw RSGISImageException("There weren't any pixels within the mask");
                 }
             }
-            delete[] maskPxlLocs;
+        }
+        catch (RSGISImageCalcException &e)
+        {
+            throw RSGISImageException(e.what());
+        }
+        catch (RSGISImageException &e)
+        {
+            throw e;
+        }
+        catch (RSGISException &e)
+        {
+            throw RSGISImageException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw RSGISImageException(e.what());
+        }
+    }
+    
+    void RSGISSampleImage::randomSampleImageMaskRowCounts(GDALDataset *inputImage, unsigned int imgBand, GDALDataset *outputImage, std::vector<int> maskVals, unsigned long numSamples, int rndSeed)
+    {
+        try
+        {
+            if((imgBand < 1) || (imgBand > inputImage->GetRasterCount()))
+            {
+                throw RSGISImageException("The band specified is not within the image; note band indexing starts at 1.");
+            }
+            RSGISImageUtils imgUtils;
+            GDALRasterBand *band = inputImage->GetRasterBand(imgBand);
+            unsigned int xSize = inputImage->GetRasterXSize();
+            unsigned int ySize = inputImage->GetRasterYSize();
+            unsigned int nMaskVals = maskVals.size();
+            
+            // Count the pixels of each mask value within each row.
+            int blockXSize = 0;
+            int blockYSize = 0;
+            band->GetBlockSize(&blockXSize, &blockYSize);
+            unsigned int stripRows = std::max((unsigned int)blockYSize, RSGIS_PXL_INDEX_STRIP_ROWS);
+            std::vector<int> data(((size_t)stripRows) * xSize);
+            std::vector< std::vector<unsigned int> > rowCounts(nMaskVals, std::vector<unsigned int>(ySize, 0));
+            std::vector<size_t> nMaskValPxls(nMaskVals, 0);
+            for(unsigned int yOff = 0; yOff < ySize; yOff += stripRows)
+            {
+                unsigned int nRows = std::min(stripRows, ySize - yOff);
+                if(band->RasterIO(GF_Read, 0, yOff, xSize, nRows, data.data(), xSize, nRows, GDT_Int32, 0, 0) != CE_None)
+                {
+                    throw RSGISImageException("Could not read the image band.");
+                }
+                for(unsigned int y = 0; y < nRows; ++y)
+                {
+                    const int *rowData = &data[((size_t)y) * xSize];
+                    for(unsigned int x = 0; x < xSize; ++x)
+                    {
+                        for(unsigned int i = 0; i < nMaskVals; ++i)
+                        {
+                            if(rowData[x] == maskVals[i])
+                            {
+                                ++rowCounts[i][yOff + y];
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+            
+            size_t maxNPxls = 0;
+            for(unsigned int i = 0; i < nMaskVals; ++i)
+            {
+                for(unsigned int y = 0; y < ySize; ++y)
+                {
+                    nMaskValPxls[i] += rowCounts[i][y];
+                }
+                if(nMaskValPxls[i] == 0)
+                {
+                    std::cerr << "No samples with mask value " << maskVals.at(i) << std::endl;
+                    throw RSGISImageException("There weren't any pixels within the mask");
+                }
+                maxNPxls = std::max(maxNPxls, nMaskValPxls[i]);
+            }
+            std::cout << "Max Number of Pixels within a class is " << maxNPxls << std::endl;
+            
+            // Draw the samples as randomSampleImageMaskSmallPxlCount so the same pixels are selected.
+            boost::mt19937 rng (rndSeed);
+            boost::uniform_int<> pxlRange( 0, maxNPxls );
+            boost::variate_generator< boost::mt19937, boost::uniform_int<> > pxlGen(rng, pxlRange);
+            
+            // The samples as (row, mask value index, index of the pixel of the mask value within the row).
+            std::vector<std::pair<unsigned int, std::pair<unsigned int, unsigned int> > > samples;
+            samples.reserve(((size_t)numSamples) * nMaskVals);
+            std::vector<size_t> pxlIdxs(numSamples);
+            for(unsigned int i = 0; i < nMaskVals; ++i)
+            {
+                for(unsigned long j = 0; j < numSamples; ++j)
+                {
+                    size_t pxlIdx = pxlGen();
+                    while(pxlIdx >= nMaskValPxls[i])
+                    {
+                        pxlIdx = pxlGen();
+                    }
+                    pxlIdxs[j] = pxlIdx;
+                }
+                std::sort(pxlIdxs.begin(), pxlIdxs.end());
+                
+                unsigned int row = 0;
+                size_t rowStartIdx = 0;
+                for(unsigned long j = 0; j < numSamples; ++j)
+                {
+                    while(pxlIdxs[j] >= (rowStartIdx + rowCounts[i][row]))
+                    {
+                        rowStartIdx += rowCounts[i][row];
+                        ++row;
+                    }
+                    samples.push_back(std::pair<unsigned int, std::pair<unsigned int, unsigned int> >(row, std::pair<unsigned int, unsigned int>(i, pxlIdxs[j] - rowStartIdx)));
+                }
+            }
+            std::vector< std::vector<unsigned int> >().swap(rowCounts);
+            std::sort(samples.begin(), samples.end());
+            
+            // Read the rows with samples and find the pixels.
+            std::vector<int> rowData(xSize);
+            size_t s = 0;
+            while(s < samples.size())
+            {
+                unsigned int row = samples[s].first;
+                if(band->RasterIO(GF_Read, 0, row, xSize, 1, rowData.data(), xSize, 1, GDT_Int32, 0, 0) != CE_None)
+                {
+                    throw RSGISImageException("Could not read the image band.");
+                }
+                while((s < samples.size()) && (samples[s].first == row))
+                {
+                    unsigned int maskIdx = samples[s].second.first;
+                    unsigned int count = 0;
+                    unsigned int x = 0;
+                    for(; x < xSize; ++x)
+                    {
+                        if(rowData[x] == maskVals[maskIdx])
+                        {
+                            // The samples of a row and mask value are in order so write each as it is found.
+                            while((s < samples.size()) && (samples[s].first == row) && (samples[s].second.first == maskIdx) && (samples[s].second.second == count))
+                            {
+                                imgUtils.setPixelValue(outputImage, imgBand, x, row, maskVals[maskIdx]);
+                                ++s;
+                            }
+                            if((s == samples.size()) || (samples[s].first != row) || (samples[s].second.first != maskIdx))
+                            {
+                                break;
+                            }
+                            ++count;
+                        }
+                    }
+                    if(x == xSize)
+                    {
+                        throw RSGISImageException("The image changed while it was being sampled.");
+                    }
+                }
+            }
         }
         catch (RSGISImageCalcException &e)
         {
@@ -25,6 +25,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <vector>
+#include <algorithm>
 
 #include "boost/random.hpp"
 #include "boost/generator_iterator.hpp"
@@ -34,6 +36,7 @@
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISImageBandException.h"
 #include "img/RSGISImageCalcException.h"
+#include "img/RSGISClassPixelIndex.h"
 
 #include "utils/RSGISExportData2HDF.h"
 #include "math/RSGISMathsUtils.h"
@@ -62,6 +65,14 @@ namespace rsgis{namespace img{
         void subSampleImage(GDALDataset *inputImage, std::string outputFile, unsigned int sample, float noData, bool useNoData);
         void randomSampleImageMask(GDALDataset *inputImage, unsigned int imgBand, GDALDataset *outputImage, std::vector<int> maskVals, unsigned long numSamples);
         void randomSampleImageMaskSmallPxlCount(GDALDataset *inputImage, unsigned int imgBand, GDALDataset *outputImage, std::vector<int> maskVals, unsigned long numSamples, int rndSeed);
+        /**
+         * Selects the same pixels as randomSampleImageMaskSmallPxlCount without an index
+         * of the pixel locations. The number of pixels of each mask value within each row
+         * is counted in one pass of the image, the samples are drawn as indexes into
+         * those counts and then only the rows which contain a sample are read again. The
+         * memory used is the row counts and the samples, rather than the pixel locations.
+         */
+        void randomSampleImageMaskRowCounts(GDALDataset *inputImage, unsigned int imgBand, GDALDataset *outputImage, std::vector<int> maskVals, unsigned long numSamples, int rndSeed);
         ~RSGISSampleImage();
     };
     
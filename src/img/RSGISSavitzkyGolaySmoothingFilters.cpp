@@ -18,9 +18,50 @@ namespace rsgis{namespace img{
 		this->order = order;
 		this->window = window;
 		this->imagebandValues = imagebandValues;
+		
+		// The fit is linear in the band values so the coefficient of each band within a window
+		// is the value predicted when that band is 1 and the others are 0.
+		int numBands = imagebandValues->n;
+		this->winStart.resize(numBands);
+		this->coeffs.resize(numBands);
+		rsgis::math::RSGISPolyFit polyFit;
+		for(int i = 0; i < numBands; ++i)
+		{
+			int startVal = std::max(i - window, 0);
+			int numRows = std::min(i + window, numBands - 1) - startVal + 1;
+			if(numRows < order)
+			{
+				throw RSGISImageCalcException("The window does not contain enough bands to fit the polynomial.");
+			}
+			this->winStart[i] = startVal;
+			this->coeffs[i].resize(numRows);
+			
+			gsl_matrix *inputValues = gsl_matrix_alloc(numRows, 2);
+			for(int j = 0; j < numRows; ++j)
+			{
+				gsl_matrix_set(inputValues, j, 0, imagebandValues->vector[(startVal+j)]);
+			}
+			for(int k = 0; k < numRows; ++k)
+			{
+				for(int j = 0; j < numRows; ++j)
+				{
+					gsl_matrix_set(inputValues, j, 1, (j == k)?1.0:0.0);
+				}
+				
+				gsl_vector *coefficients = polyFit.PolyfitOneDimensionQuiet(this->order, inputValues);
+				double yPredicted = 0;
+				for(int j = 0; j < order; j++)
+				{
+					yPredicted += gsl_vector_get(coefficients, j) * pow(imagebandValues->vector[i], j); // a_n * x^n
+				}
+				this->coeffs[i][k] = yPredicted;
+				gsl_vector_free(coefficients);
+			}
+			gsl_matrix_free(inputValues);
+		}
 	}
 	
-	void RSGISSavitzkyGolaySmoothingFilters::calcImageValue(float *bandValues, int numBands, double *output) 
+	void RSGISSavitzkyGolaySmoothingFilters::checkNumBands(int numBands)
 	{
 		if(numBands != numOutBands)
 		{
@@ -31,55 +72,48 @@ namespace rsgis{namespace img{
 		{
 			throw RSGISImageCalcException("The number of input images bands and defined values need to be equal");
 		}
-		
-		int numCols = 2;
-		int numRows = 0;
-		int startVal = 0;
-		
-        rsgis::math::RSGISPolyFit polyFit;
-		gsl_vector *coefficients = NULL;
-		gsl_matrix *inputValues = NULL;
+	}
+	
+	void RSGISSavitzkyGolaySmoothingFilters::calcImageValue(float *bandValues, int numBands, double *output) 
+	{
+		this->checkNumBands(numBands);
 		
 		for(int i = 0; i < numBands; ++i)
 		{
-			if((i-window) < 0)
-			{
-				numRows = (window + 1) + i;
-				startVal = 0;
-			}
-			else if((i+window) >= numBands)
-			{
-				numRows = (window + 1) + (numBands - i);
-				startVal = i - window;
-			}
-			else 
+			const std::vector<double> &bandCoeffs = this->coeffs[i];
+			const float *winVals = bandValues + this->winStart[i];
+			double yPredicted = 0;
+			for(size_t j = 0; j < bandCoeffs.size(); ++j)
 			{
-				numRows = (window * 2) + 1;
-				startVal = i - window;
+				yPredicted += bandCoeffs[j] * winVals[j];
 			}
-				
-			inputValues = gsl_matrix_alloc (numRows,numCols);
-			for(int j = 0; j < numRows; ++j)
+			output[i] = yPredicted;
+		}
+	}
+	
+	bool RSGISSavitzkyGolaySmoothingFilters::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+	{
+		this->checkNumBands(numBands);
+		
+		for(int i = 0; i < numBands; ++i)
+		{
+			const std::vector<double> &bandCoeffs = this->coeffs[i];
+			double *outVals = output[i];
+			for(size_t p = 0; p < nPxls; ++p)
 			{
-				gsl_matrix_set (inputValues, j, 0, imagebandValues->vector[(startVal+j)]);
-				gsl_matrix_set (inputValues, j, 1, bandValues[(startVal+j)]);
+				outVals[p] = 0;
 			}
-			
-			coefficients = polyFit.PolyfitOneDimensionQuiet(this->order, inputValues);	
-			
-			double yPredicted = 0;
-			for(int j = 0; j < order; j++)
+			for(size_t j = 0; j < bandCoeffs.size(); ++j)
 			{
-				double xPow = pow(imagebandValues->vector[i], j); // x^n;
-				double coeff = gsl_vector_get(coefficients, j); // a_n
-				double coeffXPow = coeff * xPow; // a_n * x^n				
-				yPredicted = yPredicted + coeffXPow;
+				const double coeff = bandCoeffs[j];
+				const float *inVals = bands[this->winStart[i]+j];
+				for(size_t p = 0; p < nPxls; ++p)
+				{
+					outVals[p] += coeff * inVals[p];
+				}
 			}
-			output[i] = yPredicted;
-			
-			gsl_matrix_free(inputValues);
-			gsl_vector_free(coefficients);
 		}
+		return true;
 	}
 
 	RSGISSavitzkyGolaySmoothingFilters::~RSGISSavitzkyGolaySmoothingFilters()
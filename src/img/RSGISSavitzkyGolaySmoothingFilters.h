@@ -26,6 +26,8 @@
 #include <iostream>
 #include <string>
 #include <cmath>
+#include <vector>
+#include <algorithm>
 
 #include "gdal_priv.h"
 
@@ -60,6 +62,11 @@ namespace rsgis{namespace img{
 	 *
 	 * Smoothing is undertaken through a process of polynominal fitting.
 	 *
+	 * As the fitted value of each band is a linear combination of the band values
+	 * within its window, which only depends on the band (x) values, the filter
+	 * coefficients are calculated once when the object is created and applied
+	 * to the pixels (or blocks of pixels) as a dot product.
+	 *
 	 */
 	
 	class DllExport RSGISSavitzkyGolaySmoothingFilters : public RSGISCalcImageValue
@@ -67,11 +74,17 @@ namespace rsgis{namespace img{
 	public: 
 		RSGISSavitzkyGolaySmoothingFilters(int numberOutBands, int order, int window, rsgis::math::Vector *imagebandValues);
 		void calcImageValue(float *bandValues, int numBands, double *output);
+		bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+		RSGISCalcImageValue* clone(){return new RSGISSavitzkyGolaySmoothingFilters(*this);};
 		~RSGISSavitzkyGolaySmoothingFilters();
 	private:
+		void checkNumBands(int numBands);
 		int order;
 		int window;
-        rsgis::math::Vector *imagebandValues; 
+        rsgis::math::Vector *imagebandValues;
+        /// The first band of the window of each band and the coefficients of the window bands.
+        std::vector<int> winStart;
+        std::vector< std::vector<double> > coeffs;
 	};
 	
 }}
@@ -25,7 +25,7 @@
 
 namespace rsgis { namespace img {
 
-    RSGISSharpenLowResBands::RSGISSharpenLowResBands(int numberOutBands, RSGISSharpenBandInfo *bandInfo, unsigned int nBandInfo, unsigned int nLowResBands, unsigned int nHighResBands, unsigned int defWinSize, int noDataVal, double *imgMinVal, double *imgMaxVal):RSGISCalcImageValue(numberOutBands)
+    RSGISSharpenLowResBands::RSGISSharpenLowResBands(int numberOutBands, RSGISSharpenBandInfo *bandInfo, unsigned int nBandInfo, unsigned int nLowResBands, unsigned int nHighResBands, unsigned int defWinSize, int noDataVal, double *imgMinVal, double *imgMaxVal, bool useRunningSums):RSGISCalcImageValue(numberOutBands)
     {
         this->bandInfo = bandInfo;
         this->nBandInfo = nBandInfo;
@@ -76,6 +76,10 @@ namespace rsgis { namespace img {
         }
         
         this->mathUtils = rsgis::math::RSGISMathsUtils();
+        
+        this->useRunningSums = useRunningSums;
+        this->fitSums.resize(nLowResBands * nHighResBands);
+        this->centreVals.resize(nBandInfo);
     }
     
     void RSGISSharpenLowResBands::calcImageValue(float ***dataBlock, int numBands, int winSize, double *output) 
@@ -187,9 +191,215 @@ namespace rsgis { namespace img {
         }
     }
     
-    RSGISSharpenLowResBands::~RSGISSharpenLowResBands()
+    bool RSGISSharpenLowResBands::calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output)
     {
+        if(!this->useRunningSums)
+        {
+            return false;
+        }
+        if(this->nBandInfo != numBands)
+        {
+            throw RSGISImageCalcException("The number of input bands and the number of band info objects must be the same.");
+        }
+        
+        for(std::vector<RSGISSharpenFitSums>::iterator iterSums = this->fitSums.begin(); iterSums != this->fitSums.end(); ++iterSums)
+        {
+            (*iterSums).n = 0.0;
+            (*iterSums).sumX = 0.0;
+            (*iterSums).sumXSq = 0.0;
+            (*iterSums).sumY = 0.0;
+            (*iterSums).sumYSq = 0.0;
+            (*iterSums).sumXY = 0.0;
+        }
+        
+        std::vector<const float*> column(numBands);
+        for(int x = 0; x < winSize; ++x)
+        {
+            for(int b = 0; b < numBands; ++b)
+            {
+                column[b] = winData[b] + x;
+            }
+            this->updateFitSums(column.data(), stride, winSize, 1.0);
+        }
+        
+        size_t centreOff = ((winSize-1)/2) * (stride + 1);
+        for(int b = 0; b < numBands; ++b)
+        {
+            this->centreVals[b] = winData[b][centreOff];
+        }
+        this->calcOutputFromFitSums(this->centreVals.data(), output);
+        
+        return true;
+    }
+    
+    bool RSGISSharpenLowResBands::calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output)
+    {
+        if(!this->useRunningSums)
+        {
+            return false;
+        }
+        if(this->nBandInfo != numBands)
+        {
+            throw RSGISImageCalcException("The number of input bands and the number of band info objects must be the same.");
+        }
         
+        this->updateFitSums(outColumn, stride, winSize, -1.0);
+        this->updateFitSums(inColumn, stride, winSize, 1.0);
+        
+        // The centre of the window relative to the column which has entered it.
+        size_t winHSize = (winSize-1)/2;
+        size_t centreOff = (winHSize * stride) - (winSize - 1 - winHSize);
+        for(int b = 0; b < numBands; ++b)
+        {
+            this->centreVals[b] = inColumn[b][centreOff];
+        }
+        this->calcOutputFromFitSums(this->centreVals.data(), output);
+        
+        return true;
+    }
+    
+    void RSGISSharpenLowResBands::updateFitSums(const float* const* column, size_t stride, unsigned int winSize, double sign)
+    {
+        double noData = this->noDataVal;
+        for(unsigned int i = 0; i < this->nLowResBands; ++i)
+        {
+            const float *yCol = column[this->lowResBandIdxs[i]];
+            for(unsigned int j = 0; j < this->nHighResBands; ++j)
+            {
+                const float *xCol = column[this->highResBandIdxs[j]];
+                RSGISSharpenFitSums &sums = this->fitSums[(i*this->nHighResBands)+j];
+                for(unsigned int n = 0; n < winSize; ++n)
+                {
+                    double x = xCol[n*stride];
+                    double y = yCol[n*stride];
+                    if(!((x == noData) | (y == noData)))
+                    {
+                        sums.n += sign;
+                        sums.sumX += sign * x;
+                        sums.sumXSq += sign * (x*x);
+                        sums.sumY += sign * y;
+                        sums.sumYSq += sign * (y*y);
+                        sums.sumXY += sign * (x*y);
+                    }
+                }
+            }
+        }
+    }
+    
+    void RSGISSharpenLowResBands::calcOutputFromFitSums(const float *centreVals, double *output)
+    {
+        bool isNoData = true;
+        for(unsigned int i = 0; i < this->nBandInfo; ++i)
+        {
+            if((int(centreVals[i])) != this->noDataVal)
+            {
+                isNoData = false;
+            }
+        }
+        
+        if(isNoData)
+        {
+            for(unsigned int i = 0; i < this->nBandInfo; ++i)
+            {
+                output[i] = this->noDataVal;
+            }
+            return;
+        }
+        
+        for(unsigned int i = 0; i < this->nBandInfo; ++i)
+        {
+            if((this->bandInfo[i].status == rsgis_sharp_band_ignore) | (this->bandInfo[i].status == rsgis_sharp_band_highres))
+            {
+                output[i] = centreVals[i];
+            }
+            else if(this->bandInfo[i].status != rsgis_sharp_band_lowres)
+            {
+                throw RSGISImageCalcException("Band status is not recognised - must be either ignore, low res or high res.");
+            }
+        }
+        
+        bool first = true;
+        double maxCoeff = 0.0;
+        unsigned int maxHRIdx = 0;
+        for(unsigned int i = 0; i < this->nLowResBands; ++i)
+        {
+            first = true;
+            maxCoeff = 0.0;
+            maxHRIdx = 0;
+            for(unsigned int j = 0; j < this->nHighResBands; ++j)
+            {
+                // The same fit as rsgis::math::RSGISMathsUtils::performLinearFit but from the sums.
+                const RSGISSharpenFitSums &sums = this->fitSums[(i*this->nHighResBands)+j];
+                rsgis::math::RSGISLinearFitVals *fit = this->linFits[j];
+                fit->coeff = 0.0;
+                fit->intercept = 0.0;
+                fit->pvar = 0.0;
+                fit->slope = 0.0;
+                double n = std::round(sums.n);
+                if(n >= 3)
+                {
+                    fit->pvar = n*sums.sumXSq - sums.sumX*sums.sumX;
+                    fit->intercept = (sums.sumY*sums.sumXSq - sums.sumX*sums.sumXY)/fit->pvar;
+                    fit->slope = (n*sums.sumXY - sums.sumX*sums.sumY)/fit->pvar;
+                    
+                    // The estimated and actual sums of squares about the mean of y.
+                    double sumyest = fit->slope*fit->slope*(sums.sumXSq - (sums.sumX*sums.sumX)/n);
+                    double sumyact = sums.sumYSq - (sums.sumY*sums.sumY)/n;
+                    if(sumyact > 0)
+                    {
+                        fit->coeff = sqrt(sumyest/sumyact);
+                    }
+                    if(std::isnan(fit->coeff))
+                    {
+                        fit->coeff = 0.0;
+                    }
+                }
+                
+                if(first)
+                {
+                    first = false;
+                    maxCoeff = fit->coeff;
+                    maxHRIdx = j;
+                }
+                else if(fit->coeff > maxCoeff)
+                {
+                    maxCoeff = fit->coeff;
+                    maxHRIdx = j;
+                }
+            }
+            
+            if( (!first) & (maxCoeff > 0.5))
+            {
+                output[this->lowResBandIdxs[i]] = this->mathUtils.predFromLinearFit(centreVals[this->highResBandIdxs[maxHRIdx]], this->linFits[maxHRIdx], this->imgMinVal[this->lowResBandIdxs[i]], this->imgMaxVal[this->lowResBandIdxs[i]]);
+            }
+            else
+            {
+                output[this->lowResBandIdxs[i]] = centreVals[this->lowResBandIdxs[i]];
+            }
+        }
+    }
+    
+    RSGISCalcImageValue* RSGISSharpenLowResBands::clone()
+    {
+        return new RSGISSharpenLowResBands(this->numOutBands, this->bandInfo, this->nBandInfo, this->nLowResBands, this->nHighResBands, this->defWinSize, this->noDataVal, this->imgMinVal, this->imgMaxVal, this->useRunningSums);
+    }
+    
+    RSGISSharpenLowResBands::~RSGISSharpenLowResBands()
+    {
+        for(unsigned int i = 0; i < this->nLowResBands; ++i)
+        {
+            delete[] this->lowResPxlVals[i];
+        }
+        delete[] this->lowResPxlVals;
+        for(unsigned int i = 0; i < this->nHighResBands; ++i)
+        {
+            delete[] this->highResPxlVals[i];
+            delete this->linFits[i];
+        }
+        delete[] this->highResPxlVals;
+        delete[] this->linFits;
+        delete[] this->lowResBandIdxs;
+        delete[] this->highResBandIdxs;
     }
     
     
@@ -26,6 +26,8 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
+#include <cmath>
 
 #include "common/RSGISException.h"
 #include "common/RSGISImageException.h"
@@ -66,13 +68,41 @@ namespace rsgis { namespace img {
         std::string bandName;
     };
     
+    /** Running sums of the pixels of a window used to fit a high res (x) to a low res (y) band. */
+    struct DllExport RSGISSharpenFitSums
+    {
+        double n;
+        double sumX;
+        double sumXSq;
+        double sumY;
+        double sumYSq;
+        double sumXY;
+    };
+    
+    /**
+     * Sharpens the low resolution bands with a local linear fit to the high resolution
+     * band with the best fit within the window around each pixel. If useRunningSums is
+     * true the sums of the fits are updated as the window moves along a row (using
+     * calcImageWindowView / calcImageWindowViewSlide) rather than being recalculated
+     * for each pixel, so the fits are O(winSize) rather than O(winSize^2) per pixel.
+     */
     class DllExport RSGISSharpenLowResBands : public RSGISCalcImageValue
     {
     public:
-        RSGISSharpenLowResBands(int numberOutBands, RSGISSharpenBandInfo *bandInfo, unsigned int nBandInfo, unsigned int nLowResBands, unsigned int nHighResBands, unsigned int defWinSize, int noDataVal, double *imgMinVal, double *imgMaxVal);
+        RSGISSharpenLowResBands(int numberOutBands, RSGISSharpenBandInfo *bandInfo, unsigned int nBandInfo, unsigned int nLowResBands, unsigned int nHighResBands, unsigned int defWinSize, int noDataVal, double *imgMinVal, double *imgMaxVal, bool useRunningSums=false);
         void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
+        bool calcImageWindowView(const float* const* winData, size_t stride, int numBands, int winSize, double *output);
+        bool calcImageWindowViewSlide(const float* const* outColumn, const float* const* inColumn, size_t stride, int numBands, int winSize, double *output);
+        RSGISCalcImageValue* clone();
         ~RSGISSharpenLowResBands();
     private:
+        /** Add (sign = 1) or remove (sign = -1) a column of the window to the fit sums. */
+        void updateFitSums(const float* const* column, size_t stride, unsigned int winSize, double sign);
+        /** Calculate the output values from the fit sums, where centreVals are the window centre values of each band. */
+        void calcOutputFromFitSums(const float *centreVals, double *output);
+        bool useRunningSums;
+        std::vector<RSGISSharpenFitSums> fitSums;
+        std::vector<float> centreVals;
         rsgis::math::RSGISMathsUtils mathUtils;
         RSGISSharpenBandInfo *bandInfo;
         unsigned int nBandInfo;
@@ -0,0 +1,243 @@
+/*
+ *  RSGISSpectralIndexBank.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISSpectralIndexBank.h"
+
+namespace rsgis{namespace img{
+    
+    RSGISSpectralIndexBank::RSGISSpectralIndexBank(std::vector<RSGISSpectralIndexDefn> indices, double noDataVal): RSGISCalcImageValue(indices.size())
+    {
+        if(indices.empty())
+        {
+            throw RSGISImageCalcException("No spectral indices were specified.");
+        }
+        
+        this->indices = indices;
+        this->noDataVal = noDataVal;
+        this->numReqBands = 0;
+        this->parsers.resize(this->indices.size(), NULL);
+        this->expVars.resize(this->indices.size(), NULL);
+        this->expCalcs.resize(this->indices.size(), NULL);
+        
+        try
+        {
+            for(size_t i = 0; i < this->indices.size(); ++i)
+            {
+                RSGISSpectralIndexDefn &defn = this->indices[i];
+                size_t numIdxBands = 0;
+                std::vector<double> defaultParams;
+                switch(defn.type)
+                {
+                    case rsgis_sidx_normdiff:
+                    case rsgis_sidx_ratio:
+                        numIdxBands = 2;
+                        break;
+                    case rsgis_sidx_evi:
+                        numIdxBands = 3;
+                        defaultParams = {2.5, 6.0, 7.5, 1.0, 1000.0};
+                        break;
+                    case rsgis_sidx_evi2:
+                        numIdxBands = 2;
+                        defaultParams = {2.5, 2.4, 1.0, 1000.0};
+                        break;
+                    case rsgis_sidx_expression:
+                        numIdxBands = defn.varNames.size();
+                        if((numIdxBands == 0) || (defn.expression == ""))
+                        {
+                            throw RSGISImageCalcException("An expression and its variables must be provided for an expression index.");
+                        }
+                        break;
+                    default:
+                        throw RSGISImageCalcException("Did not recognise the spectral index type.");
+                }
+                
+                if(defn.bands.size() != numIdxBands)
+                {
+                    std::string message = std::string("The wrong number of image bands were specified for the index '") + defn.name + std::string("'.");
+                    throw RSGISImageCalcException(message);
+                }
+                if(defn.params.empty())
+                {
+                    defn.params = defaultParams;
+                }
+                else if(defn.params.size() != defaultParams.size())
+                {
+                    std::string message = std::string("The wrong number of parameters were specified for the index '") + defn.name + std::string("'.");
+                    throw RSGISImageCalcException(message);
+                }
+                for(std::vector<unsigned int>::iterator iterBand = defn.bands.begin(); iterBand != defn.bands.end(); ++iterBand)
+                {
+                    this->numReqBands = std::max(this->numReqBands, (*iterBand)+1);
+                }
+                
+                if(defn.type == rsgis_sidx_expression)
+                {
+                    this->expVars[i] = new VariableBands*[numIdxBands];
+                    for(size_t j = 0; j < numIdxBands; ++j)
+                    {
+                        this->expVars[i][j] = new VariableBands();
+                        this->expVars[i][j]->name = defn.varNames[j];
+                        this->expVars[i][j]->band = defn.bands[j];
+                    }
+                    this->parsers[i] = new mu::Parser();
+                    this->expCalcs[i] = new RSGISBandMath(1, this->expVars[i], numIdxBands, this->parsers[i]);
+                    this->parsers[i]->SetExpr(defn.expression.c_str());
+                }
+            }
+        }
+        catch (mu::ParserError &e)
+        {
+            std::string message = std::string("ERROR: ") + std::string(e.GetMsg()) + std::string(":\t \'") + std::string(e.GetExpr()) + std::string("\'");
+            throw RSGISImageCalcException(message);
+        }
+    }
+    
+    void RSGISSpectralIndexBank::calcImageValue(float *bandValues, int numBands, double *output)
+    {
+        std::vector<const float*> bandPtrs(numBands);
+        for(int i = 0; i < numBands; ++i)
+        {
+            bandPtrs[i] = &bandValues[i];
+        }
+        std::vector<double*> outPtrs(this->numOutBands);
+        for(int i = 0; i < this->numOutBands; ++i)
+        {
+            outPtrs[i] = &output[i];
+        }
+        this->calcImageBlock(bandPtrs.data(), numBands, 1, outPtrs.data());
+    }
+    
+    bool RSGISSpectralIndexBank::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        if(((unsigned int)numBands) < this->numReqBands)
+        {
+            throw RSGISImageCalcException("The input image has fewer bands than needed for the spectral indices.");
+        }
+        
+        for(size_t i = 0; i < this->indices.size(); ++i)
+        {
+            const RSGISSpectralIndexDefn &defn = this->indices[i];
+            switch(defn.type)
+            {
+                case rsgis_sidx_normdiff:
+                    this->calcNormDiff(bands[defn.bands[0]], bands[defn.bands[1]], nPxls, output[i]);
+                    break;
+                case rsgis_sidx_ratio:
+                    this->calcRatio(bands[defn.bands[0]], bands[defn.bands[1]], nPxls, output[i]);
+                    break;
+                case rsgis_sidx_evi:
+                    this->calcEVI(bands[defn.bands[0]], bands[defn.bands[1]], bands[defn.bands[2]], defn.params, nPxls, output[i]);
+                    break;
+                case rsgis_sidx_evi2:
+                    this->calcEVI2(bands[defn.bands[0]], bands[defn.bands[1]], defn.params, nPxls, output[i]);
+                    break;
+                case rsgis_sidx_expression:
+                    this->expCalcs[i]->calcImageBlock(bands, numBands, nPxls, &output[i]);
+                    break;
+                default:
+                    throw RSGISImageCalcException("Did not recognise the spectral index type.");
+            }
+        }
+        return true;
+    }
+    
+    void RSGISSpectralIndexBank::calcNormDiff(const float *a, const float *b, size_t nPxls, double *output)
+    {
+        double noData = this->noDataVal;
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            double aVal = a[p];
+            double bVal = b[p];
+            double sum = aVal + bVal;
+            output[p] = (sum != 0)?((aVal - bVal) / sum):noData;
+        }
+    }
+    
+    void RSGISSpectralIndexBank::calcRatio(const float *a, const float *b, size_t nPxls, double *output)
+    {
+        double noData = this->noDataVal;
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            double bVal = b[p];
+            output[p] = (bVal != 0)?(((double)a[p]) / bVal):noData;
+        }
+    }
+    
+    void RSGISSpectralIndexBank::calcEVI(const float *blue, const float *red, const float *nir, const std::vector<double> &params, size_t nPxls, double *output)
+    {
+        double g = params[0];
+        double c1 = params[1];
+        double c2 = params[2];
+        double l = params[3];
+        double scale = params[4];
+        double noData = this->noDataVal;
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            double blueVal = blue[p] / scale;
+            double redVal = red[p] / scale;
+            double nirVal = nir[p] / scale;
+            double denom = nirVal + (c1 * redVal) - (c2 * blueVal) + l;
+            output[p] = (denom != 0)?(g * ((nirVal - redVal) / denom)):noData;
+        }
+    }
+    
+    void RSGISSpectralIndexBank::calcEVI2(const float *red, const float *nir, const std::vector<double> &params, size_t nPxls, double *output)
+    {
+        double g = params[0];
+        double c = params[1];
+        double l = params[2];
+        double scale = params[3];
+        double noData = this->noDataVal;
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            double redVal = red[p] / scale;
+            double nirVal = nir[p] / scale;
+            double denom = nirVal + (c * redVal) + l;
+            output[p] = (denom != 0)?(g * (nirVal - redVal) / denom):noData;
+        }
+    }
+    
+    RSGISCalcImageValue* RSGISSpectralIndexBank::clone()
+    {
+        // Each clone has its own parsers for the expression indices.
+        return new RSGISSpectralIndexBank(this->indices, this->noDataVal);
+    }
+    
+    RSGISSpectralIndexBank::~RSGISSpectralIndexBank()
+    {
+        for(size_t i = 0; i < this->indices.size(); ++i)
+        {
+            if(this->expCalcs[i] != NULL)
+            {
+                delete this->expCalcs[i];
+                delete this->parsers[i];
+                for(size_t j = 0; j < this->indices[i].varNames.size(); ++j)
+                {
+                    delete this->expVars[i][j];
+                }
+                delete[] this->expVars[i];
+            }
+        }
+    }
+    
+}}
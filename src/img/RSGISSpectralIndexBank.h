@@ -0,0 +1,104 @@
+/*
+ *  RSGISSpectralIndexBank.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISSpectralIndexBank_H
+#define RSGISSpectralIndexBank_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "img/RSGISCalcImageValue.h"
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISBandMath.h"
+
+#include "muParser.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+    
+    enum RSGISSpectralIndexType
+    {
+        rsgis_sidx_normdiff, // (a - b) / (a + b)
+        rsgis_sidx_ratio, // a / b
+        rsgis_sidx_evi, // bands: blue, red, nir; params: g, c1, c2, l, scale
+        rsgis_sidx_evi2, // bands: red, nir; params: g, c, l, scale
+        rsgis_sidx_expression // muParser expression where varNames[i] is bands[i]
+    };
+    
+    struct DllExport RSGISSpectralIndexDefn
+    {
+        RSGISSpectralIndexType type;
+        std::string name;
+        /// Input image bands (starting at 0) used by the index.
+        std::vector<unsigned int> bands;
+        /// Coefficients of the index (the defaults are used if empty).
+        std::vector<double> params;
+        std::string expression;
+        std::vector<std::string> varNames;
+    };
+    
+    /**
+     * Calculates a bank of spectral indices, with an output band for each index, from a
+     * single read of the input image. The predefined indices are calculated by a loop over
+     * the block (calcImageBlock) for each index, without branches so the compiler can
+     * vectorise them, and the expression indices use the muParser bulk mode of
+     * RSGISBandMath. The indices are the same as the rsgislib.imagecalc.calcindices
+     * expressions: where the denominator is 0 the output is noDataVal.
+     */
+    class DllExport RSGISSpectralIndexBank : public RSGISCalcImageValue
+    {
+    public:
+        RSGISSpectralIndexBank(std::vector<RSGISSpectralIndexDefn> indices, double noDataVal=-999);
+        void calcImageValue(float *bandValues, int numBands, double *output);
+        bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        RSGISCalcImageValue* clone();
+        ~RSGISSpectralIndexBank();
+    protected:
+        void calcNormDiff(const float *a, const float *b, size_t nPxls, double *output);
+        void calcRatio(const float *a, const float *b, size_t nPxls, double *output);
+        void calcEVI(const float *blue, const float *red, const float *nir, const std::vector<double> &params, size_t nPxls, double *output);
+        void calcEVI2(const float *red, const float *nir, const std::vector<double> &params, size_t nPxls, double *output);
+        std::vector<RSGISSpectralIndexDefn> indices;
+        double noDataVal;
+        unsigned int numReqBands;
+        std::vector<mu::Parser*> parsers;
+        std::vector<VariableBands**> expVars;
+        std::vector<RSGISBandMath*> expCalcs;
+    };
+    
+}}
+
+#endif
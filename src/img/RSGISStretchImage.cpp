@@ -111,8 +111,11 @@ namespace rsgis { namespace img {
 			delete calcImageStats;
 
 			linearStretchImage = new RSGISLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData);
-			calcImg = new RSGISCalcImage(linearStretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            if(!RSGISCalcImageLUT::calcImage(linearStretchImage, std::vector<int>(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads) && !RSGISCalcImageAffine::calcImage(linearStretchImage->getAffineTransform(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads))
+            {
+                calcImg = new RSGISCalcImage(linearStretchImage, "", true);
+                calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            }
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -224,8 +227,11 @@ namespace rsgis { namespace img {
 			delete calcImageStats;
 			
 			linearStretchImage = new RSGISLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData);
-			calcImg = new RSGISCalcImage(linearStretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            if(!RSGISCalcImageLUT::calcImage(linearStretchImage, std::vector<int>(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads) && !RSGISCalcImageAffine::calcImage(linearStretchImage->getAffineTransform(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads))
+            {
+                calcImg = new RSGISCalcImage(linearStretchImage, "", true);
+                calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            }
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -260,6 +266,131 @@ namespace rsgis { namespace img {
 		
 	}
 	
+	void RSGISStretchImage::executeApproxPercentileStretch(float percent)
+	{
+        if((percent < 0) || (percent >= 50))
+        {
+            throw RSGISImageCalcException("The percentile must be at least 0 and less than 50.");
+        }
+        
+		GDALDataset **datasets = NULL;
+		RSGISCalcImage *calcImg = NULL;
+		RSGISLinearStretchImage *linearStretchImage = NULL;
+		double *imageMax = NULL;
+		double *imageMin = NULL;
+		double *outMax = NULL;
+		double *outMin = NULL;
+		try
+		{
+			int numBands = inputImage->GetRasterCount();
+			datasets = new GDALDataset*[1];
+			datasets[0] = inputImage;
+			
+			imageMax = new double[numBands];
+			imageMin = new double[numBands];
+			outMax = new double[numBands];
+			outMin = new double[numBands];
+            
+            // Read each band down-sampled to at most RSGIS_APPROX_STRETCH_SAMPLE_SIZE
+            // pixels along its longest side, which GDAL reads from the overviews if available.
+            int width = inputImage->GetRasterXSize();
+            int height = inputImage->GetRasterYSize();
+            double sampleScale = std::max(1.0, ((double)std::max(width, height))/RSGIS_APPROX_STRETCH_SAMPLE_SIZE);
+            int sampleWidth = std::max(1, (int)(width/sampleScale));
+            int sampleHeight = std::max(1, (int)(height/sampleScale));
+            std::vector<float> sampleVals(((size_t)sampleWidth)*((size_t)sampleHeight));
+            
+            std::ofstream outTxtFile;
+            if(this->outStats)
+            {
+                outTxtFile.open(this->outStatsFile.c_str());
+                if(!outTxtFile.is_open())
+                {
+                    throw RSGISImageCalcException("Output file for the statistics could not be opened.");
+                }
+                outTxtFile << "#approxpercent\n";
+                outTxtFile << "#band,img_min,img_max,out_min,out_max\n";
+            }
+            
+			for(int i = 0; i < numBands; i++)
+			{
+                if(inputImage->GetRasterBand(i+1)->RasterIO(GF_Read, 0, 0, width, height, sampleVals.data(), sampleWidth, sampleHeight, GDT_Float32, 0, 0) != CE_None)
+                {
+                    throw RSGISImageCalcException("Could not read a sample of the input image.");
+                }
+                
+                size_t nVals = 0;
+                for(size_t n = 0; n < sampleVals.size(); ++n)
+                {
+                    if((!boost::math::isnan(sampleVals[n])) && !(this->useNoData && (sampleVals[n] == this->inNoData)))
+                    {
+                        sampleVals[nVals++] = sampleVals[n];
+                    }
+                }
+                if(nVals == 0)
+                {
+                    throw RSGISImageCalcException("The sample of the input image only contains no data values.");
+                }
+                
+                size_t lowerIdx = (size_t)((percent/100.0) * (nVals-1));
+                size_t upperIdx = (nVals-1) - lowerIdx;
+                std::nth_element(sampleVals.begin(), sampleVals.begin()+lowerIdx, sampleVals.begin()+nVals);
+                imageMin[i] = sampleVals[lowerIdx];
+                std::nth_element(sampleVals.begin(), sampleVals.begin()+upperIdx, sampleVals.begin()+nVals);
+                imageMax[i] = sampleVals[upperIdx];
+				outMax[i] = this->outMaxVal;
+				outMin[i] = this->outMinVal;
+                
+                if(this->outStats)
+                {
+                    outTxtFile << i+1 << "," << imageMin[i] << "," << imageMax[i] << "," << outMin[i] << "," << outMax[i] << std::endl;
+                }
+			}
+            
+            if(this->outStats)
+            {
+                outTxtFile.flush();
+                outTxtFile.close();
+            }
+            
+            linearStretchImage = new RSGISLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData);
+            if(!RSGISCalcImageLUT::calcImage(linearStretchImage, std::vector<int>(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads) && !RSGISCalcImageAffine::calcImage(linearStretchImage->getAffineTransform(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads))
+            {
+                calcImg = new RSGISCalcImage(linearStretchImage, "", true);
+                calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            }
+		}
+		catch(RSGISImageCalcException &e)
+		{
+			if(datasets != NULL)
+			{
+				delete[] datasets;
+			}
+			throw e;
+		}
+		catch(RSGISImageBandException &e)
+		{
+			if(datasets != NULL)
+			{
+				delete[] datasets;
+			}
+			throw RSGISImageCalcException(e.what());
+		}
+		
+		delete[] imageMax;
+		delete[] imageMin;
+		delete[] outMax;
+		delete[] outMin;
+		
+		delete linearStretchImage;
+		delete calcImg;
+		
+		if(datasets != NULL)
+		{
+			delete[] datasets;
+		}
+	}
+    
 	void RSGISStretchImage::executeLinearStdDevStretch(float stddev) 
 	{
 		GDALDataset **datasets = NULL;
@@ -341,8 +472,11 @@ namespace rsgis { namespace img {
 			delete calcImageStats;
 			
 			linearStretchImage = new RSGISLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData);
-			calcImg = new RSGISCalcImage(linearStretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            if(!RSGISCalcImageLUT::calcImage(linearStretchImage, std::vector<int>(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads) && !RSGISCalcImageAffine::calcImage(linearStretchImage->getAffineTransform(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads))
+            {
+                calcImg = new RSGISCalcImage(linearStretchImage, "", true);
+                calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            }
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -461,8 +595,11 @@ namespace rsgis { namespace img {
 			delete calcImageStats;
 			
 			stretchImage = new RSGISFuncLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData, function);
-			calcImg = new RSGISCalcImage(stretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            if(!RSGISCalcImageLUT::calcImage(stretchImage, std::vector<int>(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads))
+            {
+                calcImg = new RSGISCalcImage(stretchImage, "", true);
+                calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            }
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -577,8 +714,11 @@ namespace rsgis { namespace img {
 			delete calcImageStats;
 			
 			stretchImage = new RSGISFuncLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData, function);
-			calcImg = new RSGISCalcImage(stretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            if(!RSGISCalcImageLUT::calcImage(stretchImage, std::vector<int>(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads))
+            {
+                calcImg = new RSGISCalcImage(stretchImage, "", true);
+                calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            }
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -688,8 +828,11 @@ namespace rsgis { namespace img {
 			delete calcImageStats;
 			
 			stretchImage = new RSGISFuncLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData, function);
-			calcImg = new RSGISCalcImage(stretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            if(!RSGISCalcImageLUT::calcImage(stretchImage, std::vector<int>(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads))
+            {
+                calcImg = new RSGISCalcImage(stretchImage, "", true);
+                calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            }
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -783,8 +926,11 @@ namespace rsgis { namespace img {
 			delete stats;
 			
 			linearStretchImage = new RSGISLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData);
-			calcImg = new RSGISCalcImage(linearStretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            if(!RSGISCalcImageLUT::calcImage(linearStretchImage, std::vector<int>(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads) && !RSGISCalcImageAffine::calcImage(linearStretchImage->getAffineTransform(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads))
+            {
+                calcImg = new RSGISCalcImage(linearStretchImage, "", true);
+                calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            }
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -861,8 +1007,11 @@ namespace rsgis { namespace img {
 			delete stats;
 			
 			stretchImage = new RSGISFuncLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData, function);
-			calcImg = new RSGISCalcImage(stretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            if(!RSGISCalcImageLUT::calcImage(stretchImage, std::vector<int>(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads))
+            {
+                calcImg = new RSGISCalcImage(stretchImage, "", true);
+                calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            }
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -935,8 +1084,11 @@ namespace rsgis { namespace img {
 			delete stats;
 			
 			stretchImage = new RSGISFuncLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData, function);
-			calcImg = new RSGISCalcImage(stretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            if(!RSGISCalcImageLUT::calcImage(stretchImage, std::vector<int>(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads))
+            {
+                calcImg = new RSGISCalcImage(stretchImage, "", true);
+                calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            }
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -1009,8 +1161,11 @@ namespace rsgis { namespace img {
 			delete stats;
 			
 			stretchImage = new RSGISFuncLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin,  this->useNoData, this->inNoData, this->outNoData, function);
-			calcImg = new RSGISCalcImage(stretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            if(!RSGISCalcImageLUT::calcImage(stretchImage, std::vector<int>(), datasets, 1, outputImage, false, NULL, imageFormat, outDataType, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads))
+            {
+                calcImg = new RSGISCalcImage(stretchImage, "", true);
+                calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+            }
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -1147,6 +1302,26 @@ namespace rsgis { namespace img {
 		}
 	}
 	
+	RSGISAffineTransform RSGISLinearStretchImage::getAffineTransform()
+	{
+		RSGISAffineTransform transform;
+		for(int i = 0; i < this->numOutBands; i++)
+		{
+			RSGISAffineBandParams params = RSGISAffineBandParams(imageMin[i], imageMax[i] - imageMin[i], outMax[i] - outMin[i], outMin[i]);
+			params.inMin = imageMin[i];
+			params.inMax = imageMax[i];
+			params.outLow = outMin[i];
+			params.outHigh = outMax[i];
+			params.nanVal = this->useNoData?this->outNoData:outMin[i];
+			transform.bands.push_back(params);
+		}
+		transform.useNoData = this->useNoData;
+		transform.inNoData = this->inNoData;
+		transform.outNoData = this->outNoData;
+		transform.avoidOutNoData = true;
+		return transform;
+	}
+	
 	RSGISLinearStretchImage::~RSGISLinearStretchImage()
 	{
 		
@@ -28,12 +28,17 @@
 #include <fstream>
 #include <cmath>
 #include <float.h>
+#include <vector>
+#include <algorithm>
 
 #include "common/RSGISFileException.h"
+#include "common/RSGISExecutionContext.h"
 
 #include "utils/RSGISTextUtils.h"
 
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISCalcImageT.h"
+#include "img/RSGISCalcImageAffine.h"
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISImageBandException.h"
 #include "img/RSGISImageCalcException.h"
@@ -60,6 +65,9 @@
 
 namespace rsgis { namespace img {
     
+    /// The maximum number of pixels along the longest side of the sample used to estimate the percentiles.
+    static const int RSGIS_APPROX_STRETCH_SAMPLE_SIZE( 1024 );
+    
     struct DllExport BandSpecThresholdStats
     {
         BandSpecThresholdStats(){};
@@ -89,6 +97,15 @@ namespace rsgis { namespace img {
 		RSGISStretchImage(GDALDataset *inputImage, std::string outputImage, bool outStats, std::string outStatsFile, bool onePassSD, std::string imageFormat, GDALDataType outDataType, float outMinVal, float outMaxVal, bool useNoData, double inNoData, double outNoData);
 		void executeLinearMinMaxStretch();
 		void executeLinearPercentStretch(float percent);
+        /**
+         * A linear stretch between the percent and 100-percent percentiles of each
+         * band, estimated from a down-sampled read of the band (so GDAL uses the
+         * overviews where the image has them) rather than a pass over the image.
+         * The image is then stretched in a single pass which, as with the other
+         * stretches of 8 and 16 bit unsigned integer images, looks the output values
+         * up in a table per band (see RSGISCalcImageLUT).
+         */
+		void executeApproxPercentileStretch(float percent);
 		void executeLinearStdDevStretch(float stddev);
 		void executeHistogramStretch();
 		void executeExponentialStretch();
@@ -295,6 +312,8 @@ namespace rsgis { namespace img {
 	public:
 		RSGISLinearStretchImage(int numberOutBands, double *imageMaxIn, double *imageMinIn, double *outMaxIn, double *outMinIn, bool useNoData, double inNoData, double outNoData);
 		void calcImageValue(float *bandValues, int numBands, double *output);
+		/** The same stretch as a RSGISAffineTransform, for RSGISCalcImageAffine. */
+		RSGISAffineTransform getAffineTransform();
 		~RSGISLinearStretchImage();
 	protected:
 		double *imageMax;
@@ -306,7 +325,6 @@ namespace rsgis { namespace img {
         double outNoData;
 	};
 
-
 	class DllExport RSGISFuncLinearStretchImage : public RSGISCalcImageValue
 	{
 	public:
@@ -0,0 +1,1105 @@
+/*
+ *  RSGISTemporalSummary.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISTemporalSummary.h"
+
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_linalg.h>
+
+namespace rsgis{namespace img{
+    
+    // Number of pixels reduced at a time so the running values stay in cache.
+    static const size_t RSGIS_TEMPORAL_TILE_PXLS = 256;
+    
+    // Number of season-trend model coefficients and of the unique terms of their normal matrix.
+    static const size_t RSGIS_TRFIT_NUM_COEFFS = 5;
+    static const size_t RSGIS_TRFIT_NUM_NORM_TERMS = 15;
+    
+    RSGISTemporalSummary::RSGISTemporalSummary(unsigned int numSeries, unsigned int numTimeSteps, unsigned int seriesStride, unsigned int timeStride, std::vector<RSGISTemporalStatSpec> stats, float noDataVal, bool useNoData, bool passSingleValue): RSGISCalcImageValue(numSeries * stats.size())
+    {
+        if((numSeries == 0) || (numTimeSteps == 0))
+        {
+            throw RSGISImageCalcException("The temporal summary needs at least one series and one time step.");
+        }
+        if(stats.empty())
+        {
+            throw RSGISImageCalcException("No temporal summaries were specified.");
+        }
+        
+        this->numSeries = numSeries;
+        this->numTimeSteps = numTimeSteps;
+        this->seriesStride = seriesStride;
+        this->timeStride = timeStride;
+        this->stats = stats;
+        this->noDataVal = noDataVal;
+        this->useNoData = useNoData;
+        this->passSingleValue = passSingleValue;
+        
+        this->needMinMax = passSingleValue;
+        this->needSum = false;
+        this->needSSq = false;
+        this->needOrder = false;
+        this->needSort = false;
+        for(std::vector<RSGISTemporalStatSpec>::iterator iterStat = this->stats.begin(); iterStat != this->stats.end(); ++iterStat)
+        {
+            switch((*iterStat).stat)
+            {
+                case rsgis_tstat_min:
+                case rsgis_tstat_max:
+                case rsgis_tstat_range:
+                case rsgis_tstat_argmin:
+                case rsgis_tstat_argmax:
+                    this->needMinMax = true;
+                    break;
+                case rsgis_tstat_stddev:
+                    this->needSSq = true;
+                    this->needSum = true;
+                    break;
+                case rsgis_tstat_mean:
+                case rsgis_tstat_sum:
+                    this->needSum = true;
+                    break;
+                case rsgis_tstat_count:
+                    break;
+                case rsgis_tstat_percentile:
+                    if(((*iterStat).percentile < 0) || ((*iterStat).percentile > 100))
+                    {
+                        throw RSGISImageCalcException("Percentiles must be between 0 and 100.");
+                    }
+                    this->needOrder = true;
+                    break;
+                case rsgis_tstat_mode:
+                    this->needSort = true;
+                    this->needOrder = true;
+                    break;
+                case rsgis_tstat_median:
+                case rsgis_tstat_argmedian:
+                    this->needOrder = true;
+                    break;
+                default:
+                    throw RSGISImageCalcException("Did not recognise the temporal summary type.");
+            }
+        }
+        
+        this->count.resize(RSGIS_TEMPORAL_TILE_PXLS);
+        if(this->needSum)
+        {
+            this->sum.resize(RSGIS_TEMPORAL_TILE_PXLS);
+        }
+        if(this->needSSq)
+        {
+            this->ssq.resize(RSGIS_TEMPORAL_TILE_PXLS);
+            this->mean.resize(RSGIS_TEMPORAL_TILE_PXLS);
+        }
+        if(this->needMinMax)
+        {
+            this->minVal.resize(RSGIS_TEMPORAL_TILE_PXLS);
+            this->maxVal.resize(RSGIS_TEMPORAL_TILE_PXLS);
+            this->minIdx.resize(RSGIS_TEMPORAL_TILE_PXLS);
+            this->maxIdx.resize(RSGIS_TEMPORAL_TILE_PXLS);
+        }
+        if(this->needOrder)
+        {
+            this->pxlVals.resize(RSGIS_TEMPORAL_TILE_PXLS * ((size_t)numTimeSteps));
+        }
+        this->validIdxs.resize(RSGIS_TEMPORAL_TILE_PXLS);
+    }
+    
+    void RSGISTemporalSummary::calcImageValue(float *bandValues, int numBands, double *output)
+    {
+        std::vector<const float*> bandPtrs(numBands);
+        for(int i = 0; i < numBands; ++i)
+        {
+            bandPtrs[i] = &bandValues[i];
+        }
+        std::vector<double*> outPtrs(this->numOutBands);
+        for(int i = 0; i < this->numOutBands; ++i)
+        {
+            outPtrs[i] = &output[i];
+        }
+        this->calcImageBlock(bandPtrs.data(), numBands, 1, outPtrs.data());
+    }
+    
+    bool RSGISTemporalSummary::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        size_t numReqBands = (((size_t)(this->numSeries-1)) * this->seriesStride) + (((size_t)(this->numTimeSteps-1)) * this->timeStride) + 1;
+        if(((size_t)numBands) < numReqBands)
+        {
+            throw RSGISImageCalcException("The number of input image bands is less than the number expected for the temporal summary.");
+        }
+        
+        size_t numStats = this->stats.size();
+        for(size_t tileStart = 0; tileStart < nPxls; tileStart += RSGIS_TEMPORAL_TILE_PXLS)
+        {
+            size_t nTile = std::min(RSGIS_TEMPORAL_TILE_PXLS, nPxls - tileStart);
+            for(unsigned int s = 0; s < this->numSeries; ++s)
+            {
+                this->reduceTile(bands, s, tileStart, nTile);
+                
+                for(size_t k = 0; k < numStats; ++k)
+                {
+                    double *outVals = output[(s * numStats) + k] + tileStart;
+                    RSGISTemporalStat stat = this->stats[k].stat;
+                    for(size_t p = 0; p < nTile; ++p)
+                    {
+                        uint32_t n = this->count[p];
+                        if(n == 0)
+                        {
+                            outVals[p] = 0.0;
+                            continue;
+                        }
+                        else if(this->passSingleValue && (n == 1))
+                        {
+                            outVals[p] = this->minVal[p];
+                            continue;
+                        }
+                        
+                        float *vals = NULL;
+                        if(this->needOrder)
+                        {
+                            vals = &this->pxlVals[p * this->numTimeSteps];
+                        }
+                        
+                        switch(stat)
+                        {
+                            case rsgis_tstat_min:
+                                outVals[p] = this->minVal[p];
+                                break;
+                            case rsgis_tstat_max:
+                                outVals[p] = this->maxVal[p];
+                                break;
+                            case rsgis_tstat_range:
+                                outVals[p] = ((double)this->maxVal[p]) - ((double)this->minVal[p]);
+                                break;
+                            case rsgis_tstat_argmin:
+                                outVals[p] = this->minIdx[p] + 1;
+                                break;
+                            case rsgis_tstat_argmax:
+                                outVals[p] = this->maxIdx[p] + 1;
+                                break;
+                            case rsgis_tstat_count:
+                                outVals[p] = n;
+                                break;
+                            case rsgis_tstat_sum:
+                                outVals[p] = this->sum[p];
+                                break;
+                            case rsgis_tstat_mean:
+                                outVals[p] = this->sum[p] / n;
+                                break;
+                            case rsgis_tstat_stddev:
+                                outVals[p] = sqrt(this->ssq[p] / (n - 1));
+                                break;
+                            case rsgis_tstat_median:
+                                outVals[p] = this->calcQuantile(vals, n, 0.5);
+                                break;
+                            case rsgis_tstat_percentile:
+                                outVals[p] = this->calcQuantile(vals, n, this->stats[k].percentile / 100.0);
+                                break;
+                            case rsgis_tstat_mode:
+                                outVals[p] = this->calcMode(vals, n);
+                                break;
+                            case rsgis_tstat_argmedian:
+                            {
+                                // The first valid time step equal to the median, if there is one.
+                                double median = this->calcQuantile(vals, n, 0.5);
+                                outVals[p] = 0.0;
+                                for(unsigned int t = 0; t < this->numTimeSteps; ++t)
+                                {
+                                    float val = bands[(s * this->seriesStride) + (t * this->timeStride)][tileStart + p];
+                                    if(((!this->useNoData) || (val != this->noDataVal)) && (val == median))
+                                    {
+                                        outVals[p] = t + 1;
+                                        break;
+                                    }
+                                }
+                                break;
+                            }
+                            default:
+                                throw RSGISImageCalcException("Did not recognise the temporal summary type.");
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+    
+    void RSGISTemporalSummary::reduceTile(const float* const* bands, unsigned int series, size_t tileStart, size_t nTile)
+    {
+        uint32_t *cnt = this->count.data();
+        double *sumVals = this->needSum?this->sum.data():NULL;
+        float *minVals = this->needMinMax?this->minVal.data():NULL;
+        float *maxVals = this->needMinMax?this->maxVal.data():NULL;
+        uint32_t *minIdxs = this->needMinMax?this->minIdx.data():NULL;
+        uint32_t *maxIdxs = this->needMinMax?this->maxIdx.data():NULL;
+        float *vals = this->needOrder?this->pxlVals.data():NULL;
+        uint32_t *idxs = this->validIdxs.data();
+        size_t nTime = this->numTimeSteps;
+        
+        std::fill(cnt, cnt + nTile, 0);
+        if(this->needSum)
+        {
+            std::fill(sumVals, sumVals + nTile, 0.0);
+        }
+        
+        for(uint32_t t = 0; t < this->numTimeSteps; ++t)
+        {
+            const float *layer = bands[(series * this->seriesStride) + (t * this->timeStride)] + tileStart;
+            
+            size_t nValid = nTile;
+            if(this->useNoData)
+            {
+                nValid = 0;
+                for(size_t p = 0; p < nTile; ++p)
+                {
+                    idxs[nValid] = p;
+                    nValid += (layer[p] != this->noDataVal)?1:0;
+                }
+            }
+            
+            if(nValid == nTile)
+            {
+                // Every pixel is valid so use contiguous loops which can be vectorised.
+                if(this->needMinMax)
+                {
+                    if(t == 0)
+                    {
+                        std::copy(layer, layer + nTile, minVals);
+                        std::copy(layer, layer + nTile, maxVals);
+                        std::fill(minIdxs, minIdxs + nTile, 0);
+                        std::fill(maxIdxs, maxIdxs + nTile, 0);
+                    }
+                    else
+                    {
+                        for(size_t p = 0; p < nTile; ++p)
+                        {
+                            bool first = (cnt[p] == 0);
+                            bool lower = first || (layer[p] < minVals[p]);
+                            bool higher = first || (layer[p] > maxVals[p]);
+                            minVals[p] = lower?layer[p]:minVals[p];
+                            minIdxs[p] = lower?t:minIdxs[p];
+                            maxVals[p] = higher?layer[p]:maxVals[p];
+                            maxIdxs[p] = higher?t:maxIdxs[p];
+                        }
+                    }
+                }
+                if(this->needSum)
+                {
+                    for(size_t p = 0; p < nTile; ++p)
+                    {
+                        sumVals[p] += layer[p];
+                    }
+                }
+                if(this->needOrder)
+                {
+                    for(size_t p = 0; p < nTile; ++p)
+                    {
+                        vals[(p * nTime) + cnt[p]] = layer[p];
+                    }
+                }
+                for(size_t p = 0; p < nTile; ++p)
+                {
+                    ++cnt[p];
+                }
+            }
+            else
+            {
+                for(size_t i = 0; i < nValid; ++i)
+                {
+                    size_t p = idxs[i];
+                    float val = layer[p];
+                    if(this->needMinMax)
+                    {
+                        if((cnt[p] == 0) || (val < minVals[p]))
+                        {
+                            minVals[p] = val;
+                            minIdxs[p] = t;
+                        }
+                        if((cnt[p] == 0) || (val > maxVals[p]))
+                        {
+                            maxVals[p] = val;
+                            maxIdxs[p] = t;
+                        }
+                    }
+                    if(this->needSum)
+                    {
+                        sumVals[p] += val;
+                    }
+                    if(this->needOrder)
+                    {
+                        vals[(p * nTime) + cnt[p]] = val;
+                    }
+                    ++cnt[p];
+                }
+            }
+        }
+        
+        if(this->needSSq)
+        {
+            // Second pass about the mean, as GSL, rather than the (less stable) sum of squares.
+            double *ssqVals = this->ssq.data();
+            double *meanVals = this->mean.data();
+            std::fill(ssqVals, ssqVals + nTile, 0.0);
+            for(size_t p = 0; p < nTile; ++p)
+            {
+                meanVals[p] = (cnt[p] > 0)?(sumVals[p] / cnt[p]):0.0;
+            }
+            for(uint32_t t = 0; t < this->numTimeSteps; ++t)
+            {
+                const float *layer = bands[(series * this->seriesStride) + (t * this->timeStride)] + tileStart;
+                for(size_t p = 0; p < nTile; ++p)
+                {
+                    double diff = layer[p] - meanVals[p];
+                    bool valid = (!this->useNoData) || (layer[p] != this->noDataVal);
+                    ssqVals[p] += valid?(diff * diff):0.0;
+                }
+            }
+        }
+        
+        if(this->needSort)
+        {
+            for(size_t p = 0; p < nTile; ++p)
+            {
+                std::sort(vals + (p * nTime), vals + (p * nTime) + cnt[p]);
+            }
+        }
+    }
+    
+    double RSGISTemporalSummary::calcQuantile(float *vals, size_t n, double fraction)
+    {
+        // Same interpolation as gsl_stats_quantile_from_sorted_data but only the values
+        // either side of the quantile need to be put in order.
+        double index = fraction * (n - 1);
+        size_t lhs = (size_t)index;
+        double delta = index - lhs;
+        if(lhs >= (n - 1))
+        {
+            lhs = n - 1;
+            delta = 0.0;
+        }
+        
+        if(this->needSort)
+        {
+            if(delta == 0.0)
+            {
+                return vals[lhs];
+            }
+            else if(fraction == 0.5)
+            {
+                return (((double)vals[lhs]) + ((double)vals[lhs+1])) / 2.0;
+            }
+            return ((1 - delta) * vals[lhs]) + (delta * vals[lhs+1]);
+        }
+        
+        std::nth_element(vals, vals + lhs, vals + n);
+        double lower = vals[lhs];
+        if(delta == 0.0)
+        {
+            return lower;
+        }
+        double upper = *std::min_element(vals + lhs + 1, vals + n);
+        if(fraction == 0.5)
+        {
+            // GSL averages the two central values for the median.
+            return (lower + upper) / 2.0;
+        }
+        return ((1 - delta) * lower) + (delta * upper);
+    }
+    
+    double RSGISTemporalSummary::calcMode(float *vals, size_t n)
+    {
+        // The values are sorted so the whole number bins are runs of values.
+        double modeBin = floor(vals[0]);
+        size_t modeFreq = 0;
+        double curBin = modeBin;
+        size_t curFreq = 0;
+        for(size_t i = 0; i < n; ++i)
+        {
+            double bin = floor(vals[i]);
+            if(bin != curBin)
+            {
+                curBin = bin;
+                curFreq = 0;
+            }
+            ++curFreq;
+            if(curFreq > modeFreq)
+            {
+                modeFreq = curFreq;
+                modeBin = curBin;
+            }
+        }
+        return modeBin;
+    }
+    
+    RSGISCalcImageValue* RSGISTemporalSummary::clone()
+    {
+        return new RSGISTemporalSummary(this->numSeries, this->numTimeSteps, this->seriesStride, this->timeStride, this->stats, this->noDataVal, this->useNoData, this->passSingleValue);
+    }
+    
+    RSGISTemporalSummary::~RSGISTemporalSummary()
+    {
+        
+    }
+    
+    
+    RSGISTemporalOutlierChange::RSGISTemporalOutlierChange(unsigned int numTimeSteps, unsigned int firstBand, unsigned int timeStride, float threshold, unsigned int minObs, float noDataVal, bool useNoData, bool outScores): RSGISTemporalSummary(1, numTimeSteps, 1, timeStride, RSGISTemporalOutlierChange::medianStatSpec(), noDataVal, useNoData)
+    {
+        if(threshold < 0)
+        {
+            throw RSGISImageCalcException("The outlier threshold must be positive.");
+        }
+        this->numOutBands = numTimeSteps;
+        this->firstBand = firstBand;
+        this->threshold = threshold;
+        this->minObs = std::max<unsigned int>(minObs, 1);
+        this->outScores = outScores;
+    }
+    
+    std::vector<RSGISTemporalStatSpec> RSGISTemporalOutlierChange::medianStatSpec()
+    {
+        RSGISTemporalStatSpec statSpec;
+        statSpec.stat = rsgis_tstat_median;
+        statSpec.percentile = 50.0;
+        return std::vector<RSGISTemporalStatSpec>(1, statSpec);
+    }
+    
+    bool RSGISTemporalOutlierChange::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        size_t numReqBands = ((size_t)this->firstBand) + (((size_t)(this->numTimeSteps-1)) * this->timeStride) + 1;
+        if(((size_t)numBands) < numReqBands)
+        {
+            throw RSGISImageCalcException("The number of input image bands is less than the number expected for the outlier change detection.");
+        }
+        
+        const float* const* series = bands + this->firstBand;
+        double noDataOut = this->outScores?-1.0:0.0;
+        for(size_t tileStart = 0; tileStart < nPxls; tileStart += RSGIS_TEMPORAL_TILE_PXLS)
+        {
+            size_t nTile = std::min(RSGIS_TEMPORAL_TILE_PXLS, nPxls - tileStart);
+            this->reduceTile(series, 0, tileStart, nTile);
+            
+            for(size_t p = 0; p < nTile; ++p)
+            {
+                uint32_t n = this->count[p];
+                size_t pxl = tileStart + p;
+                if(n < this->minObs)
+                {
+                    for(unsigned int t = 0; t < this->numTimeSteps; ++t)
+                    {
+                        output[t][pxl] = noDataOut;
+                    }
+                    continue;
+                }
+                
+                // The valid values are replaced by their absolute deviations to find the MAD.
+                float *vals = &this->pxlVals[p * this->numTimeSteps];
+                double median = this->calcQuantile(vals, n, 0.5);
+                for(uint32_t i = 0; i < n; ++i)
+                {
+                    vals[i] = std::fabs(vals[i] - median);
+                }
+                double mad = 1.4826 * this->calcQuantile(vals, n, 0.5);
+                
+                for(unsigned int t = 0; t < this->numTimeSteps; ++t)
+                {
+                    float val = series[t * this->timeStride][pxl];
+                    if(this->useNoData && (val == this->noDataVal))
+                    {
+                        output[t][pxl] = noDataOut;
+                        continue;
+                    }
+                    
+                    double dev = std::fabs(val - median);
+                    double score = 0.0;
+                    if(mad > 0)
+                    {
+                        score = dev / mad;
+                    }
+                    else if(dev > 0)
+                    {
+                        score = std::numeric_limits<double>::infinity();
+                    }
+                    
+                    if(this->outScores)
+                    {
+                        output[t][pxl] = score;
+                    }
+                    else
+                    {
+                        output[t][pxl] = (score > this->threshold)?2.0:1.0;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+    
+    RSGISCalcImageValue* RSGISTemporalOutlierChange::clone()
+    {
+        return new RSGISTemporalOutlierChange(this->numTimeSteps, this->firstBand, this->timeStride, this->threshold, this->minObs, this->noDataVal, this->useNoData, this->outScores);
+    }
+    
+    RSGISTemporalOutlierChange::~RSGISTemporalOutlierChange()
+    {
+        
+    }
+    
+    
+    RSGISTemporalRobustFit::RSGISTemporalRobustFit(std::vector<double> dates, std::vector<unsigned int> fitBands, unsigned int timeStride, RSGISTemporalRobustFitOutput outType, float threshold, unsigned int minObs, unsigned int maxIters, float noDataVal, bool useNoData, double tukeyC): RSGISCalcImageValue((outType == rsgis_trfit_tmask)?dates.size():(dates.size() * fitBands.size()))
+    {
+        if(dates.empty())
+        {
+            throw RSGISImageCalcException("The robust temporal fit needs at least one time step.");
+        }
+        if(fitBands.empty())
+        {
+            throw RSGISImageCalcException("The robust temporal fit needs at least one band to fit.");
+        }
+        if((outType == rsgis_trfit_tmask) && (fitBands.size() != 3))
+        {
+            throw RSGISImageCalcException("Tmask needs three fit bands (green, NIR and SWIR).");
+        }
+        if(threshold < 0)
+        {
+            throw RSGISImageCalcException("The robust temporal fit threshold must be positive.");
+        }
+        if(tukeyC <= 0)
+        {
+            throw RSGISImageCalcException("The Tukey biweight tuning constant must be greater than zero.");
+        }
+        
+        this->dates = dates;
+        this->fitBands = fitBands;
+        this->numTimeSteps = dates.size();
+        this->timeStride = timeStride;
+        this->outType = outType;
+        this->threshold = threshold;
+        // The residual degrees of freedom (minObs - 5) must be positive.
+        this->minObs = std::max<unsigned int>(minObs, RSGIS_TRFIT_NUM_COEFFS + 1);
+        this->maxIters = std::max<unsigned int>(maxIters, 1);
+        this->noDataVal = noDataVal;
+        this->useNoData = useNoData;
+        this->tukeyC = tukeyC;
+        
+        // The fitted values, and so the robust fit, do not depend on the time origin so
+        // the design matrix for all the dates is shared by every pixel.
+        double minDate = *std::min_element(dates.begin(), dates.end());
+        double maxDate = *std::max_element(dates.begin(), dates.end());
+        double numYears = std::max(std::ceil((maxDate - minDate) / 365.0), 1.0);
+        double annualFreq = (2.0 * M_PI) / 365.25;
+        double trendFreq = (2.0 * M_PI) / (numYears * 365.25);
+        
+        size_t n = this->numTimeSteps;
+        this->design = rsgis::math::RSGISDenseMatrix(n, RSGIS_TRFIT_NUM_COEFFS);
+        this->designOuter = rsgis::math::RSGISDenseMatrix(n, RSGIS_TRFIT_NUM_NORM_TERMS);
+        for(size_t t = 0; t < n; ++t)
+        {
+            double time = dates.at(t) - minDate;
+            double *x = this->design.row(t);
+            x[0] = 1.0;
+            x[1] = std::cos(annualFreq * time);
+            x[2] = std::sin(annualFreq * time);
+            x[3] = std::cos(trendFreq * time);
+            x[4] = std::sin(trendFreq * time);
+            
+            double *xOuter = this->designOuter.row(t);
+            size_t idx = 0;
+            for(size_t j = 0; j < RSGIS_TRFIT_NUM_COEFFS; ++j)
+            {
+                for(size_t k = j; k < RSGIS_TRFIT_NUM_COEFFS; ++k)
+                {
+                    xOuter[idx++] = x[j] * x[k];
+                }
+            }
+        }
+        
+        this->yVals = rsgis::math::RSGISDenseMatrix(RSGIS_TEMPORAL_TILE_PXLS, n);
+        this->weights = rsgis::math::RSGISDenseMatrix(RSGIS_TEMPORAL_TILE_PXLS, n);
+        this->wYVals = rsgis::math::RSGISDenseMatrix(RSGIS_TEMPORAL_TILE_PXLS, n);
+        this->normMatrices = rsgis::math::RSGISDenseMatrix(RSGIS_TEMPORAL_TILE_PXLS, RSGIS_TRFIT_NUM_NORM_TERMS);
+        this->normVals = rsgis::math::RSGISDenseMatrix(RSGIS_TEMPORAL_TILE_PXLS, RSGIS_TRFIT_NUM_COEFFS);
+        this->coeffs = rsgis::math::RSGISDenseMatrix(RSGIS_TEMPORAL_TILE_PXLS, RSGIS_TRFIT_NUM_COEFFS);
+        this->fitted = rsgis::math::RSGISDenseMatrix(RSGIS_TEMPORAL_TILE_PXLS, n);
+        this->svdU = rsgis::math::RSGISDenseMatrix(n, RSGIS_TRFIT_NUM_COEFFS);
+        this->svdV = rsgis::math::RSGISDenseMatrix(RSGIS_TRFIT_NUM_COEFFS, RSGIS_TRFIT_NUM_COEFFS);
+        this->svdS.resize(RSGIS_TRFIT_NUM_COEFFS);
+        this->valid.resize(RSGIS_TEMPORAL_TILE_PXLS * n);
+        this->numValid.resize(RSGIS_TEMPORAL_TILE_PXLS);
+        this->actIdxs.reserve(RSGIS_TEMPORAL_TILE_PXLS);
+        this->scale.resize(RSGIS_TEMPORAL_TILE_PXLS);
+        this->prevDev.resize(RSGIS_TEMPORAL_TILE_PXLS);
+        this->absResids.resize(n);
+        // Tmask combines the residuals of its three bands so keeps all of them.
+        this->resids.resize(((outType == rsgis_trfit_tmask)?fitBands.size():1) * RSGIS_TEMPORAL_TILE_PXLS * n);
+    }
+    
+    void RSGISTemporalRobustFit::calcImageValue(float *bandValues, int numBands, double *output)
+    {
+        std::vector<const float*> bandPtrs(numBands);
+        for(int i = 0; i < numBands; ++i)
+        {
+            bandPtrs[i] = &bandValues[i];
+        }
+        std::vector<double*> outPtrs(this->numOutBands);
+        for(int i = 0; i < this->numOutBands; ++i)
+        {
+            outPtrs[i] = &output[i];
+        }
+        this->calcImageBlock(bandPtrs.data(), numBands, 1, outPtrs.data());
+    }
+    
+    bool RSGISTemporalRobustFit::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        size_t n = this->numTimeSteps;
+        size_t numFitBands = this->fitBands.size();
+        unsigned int maxFitBand = *std::max_element(this->fitBands.begin(), this->fitBands.end());
+        size_t numReqBands = ((size_t)maxFitBand) + ((n-1) * this->timeStride) + 1;
+        if(((size_t)numBands) < numReqBands)
+        {
+            throw RSGISImageCalcException("The number of input image bands is less than the number expected for the robust temporal fit.");
+        }
+        
+        for(size_t tileStart = 0; tileStart < nPxls; tileStart += RSGIS_TEMPORAL_TILE_PXLS)
+        {
+            size_t nTile = std::min(RSGIS_TEMPORAL_TILE_PXLS, nPxls - tileStart);
+            
+            // A time step is only used where all the fit bands have data.
+            std::fill(this->valid.begin(), this->valid.begin() + (nTile * n), 1);
+            if(this->useNoData)
+            {
+                for(size_t t = 0; t < n; ++t)
+                {
+                    for(size_t b = 0; b < numFitBands; ++b)
+                    {
+                        const float *vals = bands[this->fitBands[b] + (t * this->timeStride)] + tileStart;
+                        for(size_t p = 0; p < nTile; ++p)
+                        {
+                            if(vals[p] == this->noDataVal)
+                            {
+                                this->valid[(p * n) + t] = 0;
+                            }
+                        }
+                    }
+                }
+            }
+            for(size_t p = 0; p < nTile; ++p)
+            {
+                const uint8_t *pxlValid = &this->valid[p * n];
+                this->numValid[p] = std::count(pxlValid, pxlValid + n, 1);
+            }
+            
+            for(size_t b = 0; b < numFitBands; ++b)
+            {
+                for(size_t t = 0; t < n; ++t)
+                {
+                    const float *vals = bands[this->fitBands[b] + (t * this->timeStride)] + tileStart;
+                    for(size_t p = 0; p < nTile; ++p)
+                    {
+                        this->yVals(p, t) = vals[p];
+                    }
+                }
+                
+                double *bandResids = &this->resids[(this->outType == rsgis_trfit_tmask)?(b * RSGIS_TEMPORAL_TILE_PXLS * n):0];
+                this->fitTile(nTile, bandResids);
+                
+                if(this->outType == rsgis_trfit_outliers)
+                {
+                    for(size_t p = 0; p < nTile; ++p)
+                    {
+                        size_t pxl = tileStart + p;
+                        const double *pxlResids = &bandResids[p * n];
+                        const uint8_t *pxlValid = &this->valid[p * n];
+                        double rmseThres = 0.0;
+                        if(this->numValid[p] >= this->minObs)
+                        {
+                            double ssq = 0.0;
+                            for(size_t t = 0; t < n; ++t)
+                            {
+                                if(pxlValid[t])
+                                {
+                                    ssq += pxlResids[t] * pxlResids[t];
+                                }
+                            }
+                            rmseThres = std::sqrt(ssq / this->numValid[p]) * this->threshold;
+                        }
+                        
+                        for(size_t t = 0; t < n; ++t)
+                        {
+                            double outVal = 0.0;
+                            if((this->numValid[p] >= this->minObs) && pxlValid[t])
+                            {
+                                if(pxlResids[t] > rmseThres)
+                                {
+                                    outVal = 1.0;
+                                }
+                                else if(pxlResids[t] < -rmseThres)
+                                {
+                                    outVal = -1.0;
+                                }
+                            }
+                            output[(t * numFitBands) + b][pxl] = outVal;
+                        }
+                    }
+                }
+            }
+            
+            if(this->outType == rsgis_trfit_tmask)
+            {
+                const double *greenResids = &this->resids[0];
+                const double *nirResids = &this->resids[RSGIS_TEMPORAL_TILE_PXLS * n];
+                const double *swirResids = &this->resids[2 * RSGIS_TEMPORAL_TILE_PXLS * n];
+                for(size_t p = 0; p < nTile; ++p)
+                {
+                    size_t pxl = tileStart + p;
+                    bool fitPxl = this->numValid[p] >= this->minObs;
+                    for(size_t t = 0; t < n; ++t)
+                    {
+                        size_t idx = (p * n) + t;
+                        double outVal = 0.0;
+                        if(fitPxl && this->valid[idx])
+                        {
+                            bool clear = (greenResids[idx] < this->threshold) && ((nirResids[idx] > -this->threshold) || (swirResids[idx] > -this->threshold));
+                            outVal = clear?0.0:1.0;
+                        }
+                        output[t][pxl] = outVal;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+    
+    void RSGISTemporalRobustFit::fitTile(size_t nTile, double *resids)
+    {
+        size_t n = this->numTimeSteps;
+        std::fill(resids, resids + (nTile * n), 0.0);
+        
+        this->actIdxs.clear();
+        for(size_t p = 0; p < nTile; ++p)
+        {
+            if(this->numValid[p] >= this->minObs)
+            {
+                this->actIdxs.push_back(p);
+            }
+        }
+        
+        unsigned int iteration = 0;
+        while(!this->actIdxs.empty())
+        {
+            // The first fit is OLS, following fits are weighted by the residuals of the previous fit.
+            size_t nAct = this->actIdxs.size();
+            for(size_t k = 0; k < nAct; ++k)
+            {
+                size_t p = this->actIdxs[k];
+                const uint8_t *pxlValid = &this->valid[p * n];
+                const double *pxlResids = &resids[p * n];
+                const double *pxlY = this->yVals.row(p);
+                double *pxlW = this->weights.row(k);
+                double *pxlWY = this->wYVals.row(k);
+                for(size_t t = 0; t < n; ++t)
+                {
+                    double w = 0.0;
+                    if(pxlValid[t])
+                    {
+                        w = (iteration == 0)?1.0:this->tukeyWeight(pxlResids[t] / this->scale[p]);
+                    }
+                    pxlW[t] = w;
+                    pxlWY[t] = w * pxlY[t];
+                }
+            }
+            
+            this->solveWeighted(nAct, resids);
+            ++iteration;
+            
+            // Convergence is on the deviance, scaled by the (weighted least squares) residual variance.
+            size_t nKeep = 0;
+            for(size_t k = 0; k < nAct; ++k)
+            {
+                size_t p = this->actIdxs[k];
+                const uint8_t *pxlValid = &this->valid[p * n];
+                const double *pxlResids = &resids[p * n];
+                const double *pxlW = this->weights.row(k);
+                
+                double wssq = 0.0;
+                for(size_t t = 0; t < n; ++t)
+                {
+                    if(pxlValid[t])
+                    {
+                        wssq += pxlW[t] * pxlResids[t] * pxlResids[t];
+                    }
+                }
+                double wlsScale = wssq / (this->numValid[p] - RSGIS_TRFIT_NUM_COEFFS);
+                double dev = std::numeric_limits<double>::quiet_NaN();
+                if(wlsScale > 0)
+                {
+                    dev = 0.0;
+                    for(size_t t = 0; t < n; ++t)
+                    {
+                        if(pxlValid[t])
+                        {
+                            dev += this->tukeyRho(pxlResids[t] / wlsScale);
+                        }
+                    }
+                }
+                
+                this->scale[p] = this->calcMADScale(resids, p);
+                bool converged = false;
+                if(iteration > 1)
+                {
+                    converged = !((std::fabs(dev - this->prevDev[p]) > 1e-8) && (iteration < this->maxIters));
+                }
+                this->prevDev[p] = dev;
+                // A scale of 0 (a perfect fit of the weighted data) also stops the fit.
+                if(!converged && (this->scale[p] != 0.0))
+                {
+                    this->actIdxs[nKeep++] = p;
+                }
+            }
+            this->actIdxs.resize(nKeep);
+        }
+    }
+    
+    void RSGISTemporalRobustFit::solveWeighted(size_t nAct, double *resids)
+    {
+        size_t n = this->numTimeSteps;
+        
+        // The weighted normal equations, X'WX and X'Wy, of every active pixel.
+        gsl_matrix_view wView = this->weights.gslView();
+        gsl_matrix_view wSub = gsl_matrix_submatrix(&wView.matrix, 0, 0, nAct, n);
+        gsl_matrix_view wYView = this->wYVals.gslView();
+        gsl_matrix_view wYSub = gsl_matrix_submatrix(&wYView.matrix, 0, 0, nAct, n);
+        gsl_matrix_view normMtxView = this->normMatrices.gslView();
+        gsl_matrix_view normMtxSub = gsl_matrix_submatrix(&normMtxView.matrix, 0, 0, nAct, RSGIS_TRFIT_NUM_NORM_TERMS);
+        gsl_matrix_view normValsView = this->normVals.gslView();
+        gsl_matrix_view normValsSub = gsl_matrix_submatrix(&normValsView.matrix, 0, 0, nAct, RSGIS_TRFIT_NUM_COEFFS);
+        gsl_matrix_const_view designView = this->design.gslConstView();
+        gsl_matrix_const_view designOuterView = this->designOuter.gslConstView();
+        gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, &wSub.matrix, &designOuterView.matrix, 0.0, &normMtxSub.matrix);
+        gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, &wYSub.matrix, &designView.matrix, 0.0, &normValsSub.matrix);
+        
+        for(size_t k = 0; k < nAct; ++k)
+        {
+            this->solveNormalEqs(this->normMatrices.row(k), this->normVals.row(k), this->weights.row(k), this->yVals.row(this->actIdxs[k]), this->coeffs.row(k));
+        }
+        
+        gsl_matrix_view coeffsView = this->coeffs.gslView();
+        gsl_matrix_view coeffsSub = gsl_matrix_submatrix(&coeffsView.matrix, 0, 0, nAct, RSGIS_TRFIT_NUM_COEFFS);
+        gsl_matrix_view fittedView = this->fitted.gslView();
+        gsl_matrix_view fittedSub = gsl_matrix_submatrix(&fittedView.matrix, 0, 0, nAct, n);
+        gsl_blas_dgemm(CblasNoTrans, CblasTrans, 1.0, &coeffsSub.matrix, &designView.matrix, 0.0, &fittedSub.matrix);
+        
+        for(size_t k = 0; k < nAct; ++k)
+        {
+            size_t p = this->actIdxs[k];
+            const uint8_t *pxlValid = &this->valid[p * n];
+            const double *pxlY = this->yVals.row(p);
+            const double *pxlFitted = this->fitted.row(k);
+            double *pxlResids = &resids[p * n];
+            for(size_t t = 0; t < n; ++t)
+            {
+                pxlResids[t] = pxlValid[t]?(pxlY[t] - pxlFitted[t]):0.0;
+            }
+        }
+    }
+    
+    void RSGISTemporalRobustFit::solveNormalEqs(const double *xtwx, const double *xtwy, const double *pxlW, const double *pxlY, double *coeffs)
+    {
+        const size_t nc = RSGIS_TRFIT_NUM_COEFFS;
+        double a[RSGIS_TRFIT_NUM_COEFFS][RSGIS_TRFIT_NUM_COEFFS];
+        size_t idx = 0;
+        double maxDiag = 0.0;
+        for(size_t j = 0; j < nc; ++j)
+        {
+            for(size_t k = j; k < nc; ++k)
+            {
+                a[j][k] = xtwx[idx];
+                a[k][j] = xtwx[idx];
+                ++idx;
+            }
+            maxDiag = std::max(maxDiag, a[j][j]);
+        }
+        
+        if(!(maxDiag > 0))
+        {
+            // Every weight is 0 so there is nothing to fit.
+            std::fill(coeffs, coeffs + nc, 0.0);
+            return;
+        }
+        
+        // Ill-conditioned (or rank deficient) systems are solved from the weighted observations.
+        double tol = 1e-8 * maxDiag;
+        double l[RSGIS_TRFIT_NUM_COEFFS][RSGIS_TRFIT_NUM_COEFFS];
+        bool posDef = true;
+        for(size_t j = 0; (j < nc) && posDef; ++j)
+        {
+            double diag = a[j][j];
+            for(size_t k = 0; k < j; ++k)
+            {
+                diag -= l[j][k] * l[j][k];
+            }
+            if(!(diag > tol))
+            {
+                posDef = false;
+                break;
+            }
+            l[j][j] = std::sqrt(diag);
+            for(size_t i = j+1; i < nc; ++i)
+            {
+                double val = a[i][j];
+                for(size_t k = 0; k < j; ++k)
+                {
+                    val -= l[i][k] * l[j][k];
+                }
+                l[i][j] = val / l[j][j];
+            }
+        }
+        
+        if(posDef)
+        {
+            double z[RSGIS_TRFIT_NUM_COEFFS];
+            for(size_t i = 0; i < nc; ++i)
+            {
+                double val = xtwy[i];
+                for(size_t k = 0; k < i; ++k)
+                {
+                    val -= l[i][k] * z[k];
+                }
+                z[i] = val / l[i][i];
+            }
+            for(size_t i = nc; i-- > 0;)
+            {
+                double val = z[i];
+                for(size_t k = i+1; k < nc; ++k)
+                {
+                    val -= l[k][i] * coeffs[k];
+                }
+                coeffs[i] = val / l[i][i];
+            }
+        }
+        else
+        {
+            this->solveMinNorm(pxlW, pxlY, coeffs);
+        }
+    }
+    
+    void RSGISTemporalRobustFit::solveMinNorm(const double *pxlW, const double *pxlY, double *coeffs)
+    {
+        // Minimum norm least squares solution of sqrt(W) X b = sqrt(W) y from the SVD of
+        // sqrt(W) X, as the pseudo-inverse used by statsmodels (numpy pinv, rcond=1e-15).
+        size_t n = this->numTimeSteps;
+        const size_t nc = RSGIS_TRFIT_NUM_COEFFS;
+        for(size_t t = 0; t < n; ++t)
+        {
+            double sqrtW = std::sqrt(pxlW[t]);
+            const double *x = this->design.row(t);
+            double *a = this->svdU.row(t);
+            for(size_t j = 0; j < nc; ++j)
+            {
+                a[j] = sqrtW * x[j];
+            }
+        }
+        gsl_matrix_view uView = this->svdU.gslView();
+        gsl_matrix_view vView = this->svdV.gslView();
+        gsl_vector_view sView = gsl_vector_view_array(this->svdS.data(), nc);
+        gsl_linalg_SV_decomp_jacobi(&uView.matrix, &vView.matrix, &sView.vector);
+        
+        double maxS = *std::max_element(this->svdS.begin(), this->svdS.end());
+        std::fill(coeffs, coeffs + nc, 0.0);
+        for(size_t j = 0; j < nc; ++j)
+        {
+            double sVal = this->svdS[j];
+            if(!(sVal > (1e-15 * maxS)))
+            {
+                continue;
+            }
+            double proj = 0.0;
+            for(size_t t = 0; t < n; ++t)
+            {
+                proj += this->svdU(t, j) * std::sqrt(pxlW[t]) * pxlY[t];
+            }
+            proj /= sVal;
+            for(size_t i = 0; i < nc; ++i)
+            {
+                coeffs[i] += this->svdV(i, j) * proj;
+            }
+        }
+    }
+    
+    double RSGISTemporalRobustFit::calcMADScale(const double *resids, size_t pxl)
+    {
+        // Median absolute residual (about 0) normalised by the standard normal upper quartile.
+        size_t n = this->numTimeSteps;
+        const double normQuartile = 0.6744897501960817;
+        const uint8_t *pxlValid = &this->valid[pxl * n];
+        const double *pxlResids = &resids[pxl * n];
+        size_t nVals = 0;
+        for(size_t t = 0; t < n; ++t)
+        {
+            if(pxlValid[t])
+            {
+                this->absResids[nVals++] = std::fabs(pxlResids[t]) / normQuartile;
+            }
+        }
+        
+        std::vector<double>::iterator midIter = this->absResids.begin() + (nVals / 2);
+        std::nth_element(this->absResids.begin(), midIter, this->absResids.begin() + nVals);
+        double median = *midIter;
+        if((nVals % 2) == 0)
+        {
+            double lowMid = *std::max_element(this->absResids.begin(), midIter);
+            median = (lowMid + median) / 2.0;
+        }
+        return median;
+    }
+    
+    double RSGISTemporalRobustFit::tukeyRho(double z)
+    {
+        double factor = (this->tukeyC * this->tukeyC) / 6.0;
+        if(std::fabs(z) <= this->tukeyC)
+        {
+            double u = 1.0 - ((z / this->tukeyC) * (z / this->tukeyC));
+            return factor - (u * u * u * factor);
+        }
+        return factor;
+    }
+    
+    double RSGISTemporalRobustFit::tukeyWeight(double z)
+    {
+        if(std::fabs(z) <= this->tukeyC)
+        {
+            double u = 1.0 - ((z / this->tukeyC) * (z / this->tukeyC));
+            return u * u;
+        }
+        return 0.0;
+    }
+    
+    RSGISCalcImageValue* RSGISTemporalRobustFit::clone()
+    {
+        return new RSGISTemporalRobustFit(this->dates, this->fitBands, this->timeStride, this->outType, this->threshold, this->minObs, this->maxIters, this->noDataVal, this->useNoData, this->tukeyC);
+    }
+    
+    RSGISTemporalRobustFit::~RSGISTemporalRobustFit()
+    {
+        
+    }
+    
+}}
@@ -0,0 +1,242 @@
+/*
+ *  RSGISTemporalSummary.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISTemporalSummary_H
+#define RSGISTemporalSummary_H
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdint.h>
+#include <limits>
+
+#include "img/RSGISCalcImageValue.h"
+#include "img/RSGISImageCalcException.h"
+#include "math/RSGISDenseMatrix.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+    
+    enum RSGISTemporalStat
+    {
+        rsgis_tstat_min,
+        rsgis_tstat_max,
+        rsgis_tstat_mean,
+        rsgis_tstat_stddev,
+        rsgis_tstat_sum,
+        rsgis_tstat_range,
+        rsgis_tstat_count,
+        rsgis_tstat_median,
+        rsgis_tstat_mode,
+        rsgis_tstat_percentile,
+        rsgis_tstat_argmin,
+        rsgis_tstat_argmax,
+        rsgis_tstat_argmedian
+    };
+    
+    enum RSGISTemporalRobustFitOutput
+    {
+        rsgis_trfit_outliers,
+        rsgis_trfit_tmask
+    };
+    
+    struct DllExport RSGISTemporalStatSpec
+    {
+        RSGISTemporalStat stat;
+        /// Percentile (0-100), only used for rsgis_tstat_percentile.
+        double percentile;
+    };
+    
+    /**
+     * Calculates per-pixel summaries of one or more series of layers (e.g., a time series
+     * of images), where the value for time step t of series s is input band
+     * (s * seriesStride) + (t * timeStride). Every requested summary is calculated in one
+     * call of calcImageBlock, on the band-major (i.e., time-major) strips read by
+     * RSGISCalcImage: min, max, count, sum, mean and the argmin/argmax are running
+     * reductions over a contiguous layer, the valid pixels of each layer are compacted
+     * into an index list when a no data value is used and the order statistics (median,
+     * percentiles, mode and argmedian) are only calculated, with std::nth_element, when
+     * they have been requested.
+     *
+     * The output bands are ordered by series and then summary (i.e., output band
+     * (s * stats.size()) + k for summary k of series s). Pixels without any valid values
+     * are given 0; the arg summaries output the time step index starting at 1 so 0 is
+     * no data. If passSingleValue is true a pixel with a single valid value is given that
+     * value for every summary, otherwise the summaries are calculated as usual (with the
+     * sample standard deviation being NaN). The median and percentiles are interpolated
+     * in the same way as GSL (gsl_stats_quantile_from_sorted_data) and the mode is the
+     * most frequent whole number bin (the lowest if tied), as RSGISMathsUtils::generateStats.
+     */
+    class DllExport RSGISTemporalSummary : public RSGISCalcImageValue
+    {
+    public:
+        RSGISTemporalSummary(unsigned int numSeries, unsigned int numTimeSteps, unsigned int seriesStride, unsigned int timeStride, std::vector<RSGISTemporalStatSpec> stats, float noDataVal, bool useNoData, bool passSingleValue=false);
+        void calcImageValue(float *bandValues, int numBands, double *output);
+        bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        RSGISCalcImageValue* clone();
+        ~RSGISTemporalSummary();
+    protected:
+        void reduceTile(const float* const* bands, unsigned int series, size_t tileStart, size_t nTile);
+        double calcQuantile(float *vals, size_t n, double fraction);
+        double calcMode(float *vals, size_t n);
+        unsigned int numSeries;
+        unsigned int numTimeSteps;
+        unsigned int seriesStride;
+        unsigned int timeStride;
+        std::vector<RSGISTemporalStatSpec> stats;
+        float noDataVal;
+        bool useNoData;
+        bool passSingleValue;
+        bool needMinMax;
+        bool needSum;
+        bool needSSq;
+        bool needOrder;
+        bool needSort;
+        std::vector<uint32_t> count;
+        std::vector<double> sum;
+        std::vector<double> ssq;
+        std::vector<double> mean;
+        std::vector<float> minVal;
+        std::vector<float> maxVal;
+        std::vector<uint32_t> minIdx;
+        std::vector<uint32_t> maxIdx;
+        std::vector<uint32_t> validIdxs;
+        std::vector<float> pxlVals;
+    };
+    
+    /**
+     * Detects per-pixel outliers (changes) within a time series of layers, where the value
+     * for time step t is input band firstBand + (t * timeStride). In the same pass as
+     * RSGISTemporalSummary reduces the series to the valid values of each pixel, the
+     * median and the median absolute deviation (MAD) are calculated and every time step is
+     * given the robust z-score |x - median| / (1.4826 * MAD). There is an output band for
+     * each time step: if outScores is false it is 1 (no change) or 2 (change, where the
+     * score is greater than threshold) and 0 for no data (including pixels with fewer than
+     * minObs valid values); otherwise the score is output, with -1 for no data. Where
+     * the MAD is 0, values not equal to the median have an infinite score.
+     */
+    class DllExport RSGISTemporalOutlierChange : public RSGISTemporalSummary
+    {
+    public:
+        RSGISTemporalOutlierChange(unsigned int numTimeSteps, unsigned int firstBand, unsigned int timeStride, float threshold, unsigned int minObs, float noDataVal, bool useNoData, bool outScores=false);
+        bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        RSGISCalcImageValue* clone();
+        ~RSGISTemporalOutlierChange();
+    protected:
+        static std::vector<RSGISTemporalStatSpec> medianStatSpec();
+        unsigned int firstBand;
+        float threshold;
+        unsigned int minObs;
+        bool outScores;
+    };
+    
+    /**
+     * Fits the season-trend model of Zhu and Woodcock (2014),
+     * y = a0 + a1 cos(wt) + b1 sin(wt) + c1 cos(wt/N) + d1 sin(wt/N) with w = 2 pi / 365.25 and
+     * N the (whole) number of years spanned by the dates, to every pixel of each fit band with a
+     * robust Tukey biweight fit by iteratively reweighted least squares. The fit follows
+     * statsmodels RLM (an OLS start, the MAD scale re-estimated every iteration and convergence
+     * on the change in deviance, to tol=1e-8 or maxIters). The value for time step t of fit
+     * band b is input band fitBands[b] + (t * timeStride) and a time step is only used where
+     * every fit band has data.
+     *
+     * The design matrix, and the outer products of its rows, are shared by every pixel so for
+     * each iteration the weighted normal equations of a tile of pixels are formed with two
+     * BLAS dgemm calls (time steps without data have a weight of 0) and the fitted values with
+     * a third; only the 5x5 solve is per pixel (a Cholesky decomposition, falling back to the
+     * pseudo-inverse of the weighted observations, from their SVD, when the weighted system is
+     * ill-conditioned or rank deficient).
+     *
+     * For rsgis_trfit_outliers output band (t * fitBands.size()) + b is 1 where the residual of
+     * band b at time t is greater than threshold x RMSE, -1 where it is less than
+     * -threshold x RMSE and 0 otherwise. For rsgis_trfit_tmask the fit bands must be the
+     * green, NIR and SWIR bands and output band t is 1 (cloud, cloud shadow or snow) where the
+     * green residual is at least threshold or both the NIR and SWIR residuals are at most
+     * -threshold (i.e., Tmask) and 0 otherwise. Time steps without data and pixels with fewer
+     * than minObs valid time steps are 0.
+     */
+    class DllExport RSGISTemporalRobustFit : public RSGISCalcImageValue
+    {
+    public:
+        RSGISTemporalRobustFit(std::vector<double> dates, std::vector<unsigned int> fitBands, unsigned int timeStride, RSGISTemporalRobustFitOutput outType, float threshold, unsigned int minObs, unsigned int maxIters, float noDataVal, bool useNoData, double tukeyC=0.4685);
+        void calcImageValue(float *bandValues, int numBands, double *output);
+        bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        RSGISCalcImageValue* clone();
+        ~RSGISTemporalRobustFit();
+    protected:
+        void fitTile(size_t nTile, double *resids);
+        void solveWeighted(size_t nAct, double *resids);
+        void solveNormalEqs(const double *xtwx, const double *xtwy, const double *pxlW, const double *pxlY, double *coeffs);
+        void solveMinNorm(const double *pxlW, const double *pxlY, double *coeffs);
+        double calcMADScale(const double *resids, size_t pxl);
+        double tukeyRho(double z);
+        double tukeyWeight(double z);
+        std::vector<double> dates;
+        std::vector<unsigned int> fitBands;
+        unsigned int numTimeSteps;
+        unsigned int timeStride;
+        RSGISTemporalRobustFitOutput outType;
+        float threshold;
+        unsigned int minObs;
+        unsigned int maxIters;
+        float noDataVal;
+        bool useNoData;
+        double tukeyC;
+        rsgis::math::RSGISDenseMatrix design;
+        rsgis::math::RSGISDenseMatrix designOuter;
+        rsgis::math::RSGISDenseMatrix yVals;
+        rsgis::math::RSGISDenseMatrix weights;
+        rsgis::math::RSGISDenseMatrix wYVals;
+        rsgis::math::RSGISDenseMatrix normMatrices;
+        rsgis::math::RSGISDenseMatrix normVals;
+        rsgis::math::RSGISDenseMatrix coeffs;
+        rsgis::math::RSGISDenseMatrix fitted;
+        rsgis::math::RSGISDenseMatrix svdU;
+        rsgis::math::RSGISDenseMatrix svdV;
+        std::vector<double> svdS;
+        std::vector<uint8_t> valid;
+        std::vector<uint32_t> numValid;
+        std::vector<uint32_t> actIdxs;
+        std::vector<double> scale;
+        std::vector<double> prevDev;
+        std::vector<double> absResids;
+        std::vector<double> resids;
+    };
+    
+}}
+
+#endif
+
+
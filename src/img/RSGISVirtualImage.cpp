@@ -0,0 +1,591 @@
+/*
+ *  RSGISVirtualImage.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISVirtualImage.h"
+
+namespace rsgis{namespace img{
+
+    RSGISVirtualImageNode::RSGISVirtualImageNode()
+    {
+        this->width = 0;
+        this->height = 0;
+        this->numBands = 0;
+        this->transform[0] = 0;
+        this->transform[1] = 1;
+        this->transform[2] = 0;
+        this->transform[3] = 0;
+        this->transform[4] = 0;
+        this->transform[5] = -1;
+        this->projection = "";
+    }
+
+    void RSGISVirtualImageNode::getGeoTransform(double *transform)
+    {
+        for(int i = 0; i < 6; ++i)
+        {
+            transform[i] = this->transform[i];
+        }
+    }
+
+    void RSGISVirtualImageNode::setGeometry(RSGISVirtualImageNode *node)
+    {
+        this->width = node->getWidth();
+        this->height = node->getHeight();
+        node->getGeoTransform(this->transform);
+        this->projection = node->getProjection();
+    }
+
+    void RSGISVirtualImageNode::zeroOutsideImage(const RSGISVirtualImageBlock &block, float **bandData)
+    {
+        int x0 = std::min(std::max(-block.xOff, 0), block.xSize);
+        int x1 = std::max(std::min(this->width - block.xOff, block.xSize), x0);
+        for(int y = 0; y < block.ySize; ++y)
+        {
+            int imgY = block.yOff + y;
+            bool rowOutside = (imgY < 0) || (imgY >= this->height);
+            for(int n = 0; n < this->numBands; ++n)
+            {
+                float *row = bandData[n] + (((size_t)y) * block.xSize);
+                if(rowOutside)
+                {
+                    std::fill(row, row + block.xSize, 0.0f);
+                }
+                else
+                {
+                    std::fill(row, row + x0, 0.0f);
+                    std::fill(row + x1, row + block.xSize, 0.0f);
+                }
+            }
+        }
+    }
+
+
+    RSGISVirtualImageDataset::RSGISVirtualImageDataset(GDALDataset **datasets, int numDS) : RSGISVirtualImageNode()
+    {
+        if(numDS <= 0)
+        {
+            throw RSGISImageCalcException("A virtual image needs at least one input image.");
+        }
+        RSGISImageUtils imgUtils;
+        std::vector<int> dsOffsetVals(numDS * 2, 0);
+        std::vector<int*> dsOffsets(numDS);
+        for(int i = 0; i < numDS; ++i)
+        {
+            dsOffsets[i] = &dsOffsetVals[i * 2];
+        }
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        imgUtils.getImageOverlap(datasets, numDS, dsOffsets.data(), &this->width, &this->height, this->transform, &xBlockSize, &yBlockSize);
+        this->projection = std::string(datasets[0]->GetProjectionRef());
+
+        for(int i = 0; i < numDS; ++i)
+        {
+            for(int j = 0; j < datasets[i]->GetRasterCount(); ++j)
+            {
+                this->bands.push_back(datasets[i]->GetRasterBand(j+1));
+                this->bandXOff.push_back(dsOffsets[i][0]);
+                this->bandYOff.push_back(dsOffsets[i][1]);
+            }
+        }
+        this->numBands = this->bands.size();
+    }
+
+    void RSGISVirtualImageDataset::readBlock(const RSGISVirtualImageBlock &block, float **bandData)
+    {
+        this->zeroOutsideImage(block, bandData);
+        int x0 = std::max(block.xOff, 0);
+        int y0 = std::max(block.yOff, 0);
+        int x1 = std::min(block.xOff + block.xSize, this->width);
+        int y1 = std::min(block.yOff + block.ySize, this->height);
+        if((x1 <= x0) || (y1 <= y0))
+        {
+            return;
+        }
+        size_t bufOff = (((size_t)(y0 - block.yOff)) * block.xSize) + (x0 - block.xOff);
+        for(int n = 0; n < this->numBands; ++n)
+        {
+            if(this->bands[n]->RasterIO(GF_Read, this->bandXOff[n] + x0, this->bandYOff[n] + y0, x1 - x0, y1 - y0, bandData[n] + bufOff, x1 - x0, y1 - y0, GDT_Float32, sizeof(float), ((GSpacing)sizeof(float)) * block.xSize) != CE_None)
+            {
+                throw RSGISImageCalcException("Could not read the input image band.");
+            }
+        }
+    }
+
+    RSGISVirtualImageDataset::~RSGISVirtualImageDataset()
+    {
+
+    }
+
+
+    RSGISVirtualImageStack::RSGISVirtualImageStack(std::vector<RSGISVirtualImageNode*> inputs) : RSGISVirtualImageNode()
+    {
+        if(inputs.empty())
+        {
+            throw RSGISImageCalcException("A virtual image stack needs at least one input.");
+        }
+        this->inputs = inputs;
+        this->setGeometry(inputs[0]);
+        for(auto iterNode = inputs.begin(); iterNode != inputs.end(); ++iterNode)
+        {
+            if(((*iterNode)->getWidth() != this->width) || ((*iterNode)->getHeight() != this->height))
+            {
+                throw RSGISImageCalcException("The inputs of a virtual image stack must be the same size.");
+            }
+            this->numBands += (*iterNode)->getNumBands();
+        }
+    }
+
+    void RSGISVirtualImageStack::readBlock(const RSGISVirtualImageBlock &block, float **bandData)
+    {
+        int band = 0;
+        for(auto iterNode = this->inputs.begin(); iterNode != this->inputs.end(); ++iterNode)
+        {
+            (*iterNode)->readBlock(block, bandData + band);
+            band += (*iterNode)->getNumBands();
+        }
+    }
+
+    RSGISVirtualImageStack::~RSGISVirtualImageStack()
+    {
+
+    }
+
+
+    /** Convert the calculated values to valsDataType and then to float. */
+    static void convertVirtualImageVals(const double *vals, float *outVals, size_t nPxls, GDALDataType valsDataType, std::vector<unsigned char> *typeVals)
+    {
+        if((valsDataType == GDT_Float32) || (valsDataType == GDT_Float64))
+        {
+            GDALCopyWords(vals, GDT_Float64, sizeof(double), outVals, GDT_Float32, sizeof(float), nPxls);
+        }
+        else
+        {
+            int typeBytes = GDALGetDataTypeSizeBytes(valsDataType);
+            typeVals->resize(nPxls * typeBytes);
+            GDALCopyWords(vals, GDT_Float64, sizeof(double), typeVals->data(), valsDataType, typeBytes, nPxls);
+            GDALCopyWords(typeVals->data(), valsDataType, typeBytes, outVals, GDT_Float32, sizeof(float), nPxls);
+        }
+    }
+
+    RSGISVirtualImageCalc::RSGISVirtualImageCalc(RSGISVirtualImageNode *input, RSGISCalcImageValue *calc, GDALDataType valsDataType) : RSGISVirtualImageNode()
+    {
+        if((input == NULL) || (calc == NULL))
+        {
+            throw RSGISImageCalcException("A virtual image calculation needs an input and a calculation.");
+        }
+        this->input = input;
+        this->calc = calc;
+        this->valsDataType = valsDataType;
+        this->setGeometry(input);
+        this->numBands = calc->getNumOutBands();
+    }
+
+    void RSGISVirtualImageCalc::readBlock(const RSGISVirtualImageBlock &block, float **bandData)
+    {
+        size_t nPxls = ((size_t)block.xSize) * block.ySize;
+        int numInBands = this->input->getNumBands();
+        this->inVals.resize(numInBands);
+        this->outVals.resize(this->numBands);
+        std::vector<float*> inPtrs(numInBands);
+        std::vector<double*> outPtrs(this->numBands);
+        for(int n = 0; n < numInBands; ++n)
+        {
+            this->inVals[n].resize(nPxls);
+            inPtrs[n] = this->inVals[n].data();
+        }
+        for(int n = 0; n < this->numBands; ++n)
+        {
+            this->outVals[n].resize(nPxls);
+            outPtrs[n] = this->outVals[n].data();
+        }
+        this->input->readBlock(block, inPtrs.data());
+
+        std::vector<const float*> inBlock(inPtrs.begin(), inPtrs.end());
+        if(!this->calc->calcImageBlock(inBlock.data(), numInBands, nPxls, outPtrs.data()))
+        {
+            std::vector<float> inDataColumn(numInBands);
+            std::vector<double> outDataColumn(this->numBands);
+            for(size_t i = 0; i < nPxls; ++i)
+            {
+                for(int n = 0; n < numInBands; ++n)
+                {
+                    inDataColumn[n] = inPtrs[n][i];
+                }
+                this->calc->calcImageValue(inDataColumn.data(), numInBands, outDataColumn.data());
+                for(int n = 0; n < this->numBands; ++n)
+                {
+                    outPtrs[n][i] = outDataColumn[n];
+                }
+            }
+        }
+
+        for(int n = 0; n < this->numBands; ++n)
+        {
+            convertVirtualImageVals(outPtrs[n], bandData[n], nPxls, this->valsDataType, &this->typeVals);
+        }
+        this->zeroOutsideImage(block, bandData);
+    }
+
+    RSGISVirtualImageCalc::~RSGISVirtualImageCalc()
+    {
+
+    }
+
+
+    RSGISVirtualImageWindowCalc::RSGISVirtualImageWindowCalc(RSGISVirtualImageNode *input, RSGISCalcImageValue *calc, int windowSize, GDALDataType valsDataType) : RSGISVirtualImageNode()
+    {
+        if((input == NULL) || (calc == NULL))
+        {
+            throw RSGISImageCalcException("A virtual image calculation needs an input and a calculation.");
+        }
+        if(windowSize % 2 == 0)
+        {
+            throw RSGISImageCalcException("Window size needs to be an odd number (min = 3).");
+        }
+        else if(windowSize < 3)
+        {
+            throw RSGISImageCalcException("Window size needs to be 3 or greater and an odd number.");
+        }
+        this->input = input;
+        this->calc = calc;
+        this->windowSize = windowSize;
+        this->valsDataType = valsDataType;
+        this->setGeometry(input);
+        this->numBands = calc->getNumOutBands();
+    }
+
+    void RSGISVirtualImageWindowCalc::readBlock(const RSGISVirtualImageBlock &block, float **bandData)
+    {
+        int windowMid = this->windowSize / 2;
+        RSGISVirtualImageBlock padBlock;
+        padBlock.xOff = block.xOff - windowMid;
+        padBlock.yOff = block.yOff - windowMid;
+        padBlock.xSize = block.xSize + (2 * windowMid);
+        padBlock.ySize = block.ySize + (2 * windowMid);
+        size_t padWidth = padBlock.xSize;
+        size_t nPxls = ((size_t)block.xSize) * block.ySize;
+
+        int numInBands = this->input->getNumBands();
+        this->inVals.resize(numInBands);
+        this->outVals.resize(this->numBands);
+        std::vector<float*> inPtrs(numInBands);
+        for(int n = 0; n < numInBands; ++n)
+        {
+            this->inVals[n].resize(padWidth * padBlock.ySize);
+            inPtrs[n] = this->inVals[n].data();
+        }
+        for(int n = 0; n < this->numBands; ++n)
+        {
+            this->outVals[n].resize(nPxls);
+        }
+        this->input->readBlock(padBlock, inPtrs.data());
+
+        std::vector<const float*> winView(numInBands);
+        std::vector<const float*> winOutColumn(numInBands);
+        std::vector<const float*> winInColumn(numInBands);
+        std::vector<double> outDataColumn(this->numBands);
+        float ***inDataBlock = NULL;
+        bool useWinView = true;
+        bool useWinViewSlide = true;
+        for(int y = 0; y < block.ySize; ++y)
+        {
+            for(int x = 0; x < block.xSize; ++x)
+            {
+                size_t winOff = (((size_t)y) * padWidth) + x;
+                bool calcDone = false;
+                if(useWinView)
+                {
+                    if((x > 0) && useWinViewSlide)
+                    {
+                        for(int n = 0; n < numInBands; ++n)
+                        {
+                            winOutColumn[n] = inPtrs[n] + (winOff - 1);
+                            winInColumn[n] = inPtrs[n] + (winOff + (this->windowSize - 1));
+                        }
+                        calcDone = this->calc->calcImageWindowViewSlide(winOutColumn.data(), winInColumn.data(), padWidth, numInBands, this->windowSize, outDataColumn.data());
+                        useWinViewSlide = calcDone;
+                    }
+                    if(!calcDone)
+                    {
+                        for(int n = 0; n < numInBands; ++n)
+                        {
+                            winView[n] = inPtrs[n] + winOff;
+                        }
+                        calcDone = this->calc->calcImageWindowView(winView.data(), padWidth, numInBands, this->windowSize, outDataColumn.data());
+                        useWinView = calcDone;
+                    }
+                }
+
+                if(!calcDone)
+                {
+                    if(inDataBlock == NULL)
+                    {
+                        inDataBlock = new float**[numInBands];
+                        for(int n = 0; n < numInBands; ++n)
+                        {
+                            inDataBlock[n] = new float*[this->windowSize];
+                            for(int j = 0; j < this->windowSize; ++j)
+                            {
+                                inDataBlock[n][j] = new float[this->windowSize];
+                            }
+                        }
+                    }
+                    for(int n = 0; n < numInBands; ++n)
+                    {
+                        for(int j = 0; j < this->windowSize; ++j)
+                        {
+                            const float *winRow = inPtrs[n] + (winOff + (j * padWidth));
+                            std::copy(winRow, winRow + this->windowSize, inDataBlock[n][j]);
+                        }
+                    }
+                    this->calc->calcImageValue(inDataBlock, numInBands, this->windowSize, outDataColumn.data());
+                }
+
+                for(int n = 0; n < this->numBands; ++n)
+                {
+                    this->outVals[n][(((size_t)y) * block.xSize) + x] = outDataColumn[n];
+                }
+            }
+        }
+
+        if(inDataBlock != NULL)
+        {
+            for(int n = 0; n < numInBands; ++n)
+            {
+                for(int j = 0; j < this->windowSize; ++j)
+                {
+                    delete[] inDataBlock[n][j];
+                }
+                delete[] inDataBlock[n];
+            }
+            delete[] inDataBlock;
+        }
+
+        for(int n = 0; n < this->numBands; ++n)
+        {
+            convertVirtualImageVals(this->outVals[n].data(), bandData[n], nPxls, this->valsDataType, &this->typeVals);
+        }
+        this->zeroOutsideImage(block, bandData);
+    }
+
+    RSGISVirtualImageWindowCalc::~RSGISVirtualImageWindowCalc()
+    {
+
+    }
+
+
+    int RSGISVirtualImageSinks::getStripRows(RSGISVirtualImageNode *node)
+    {
+        size_t bytesPerPxl = ((size_t)node->getNumBands()) * (sizeof(float) + sizeof(double));
+        unsigned int stripMemoryMB = rsgis::RSGISExecutionContextUtils::getDefaultContext().stripMemoryMB;
+        int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(RSGIS_VIRTUAL_IMAGE_STRIP_ROWS, node->getWidth(), node->getHeight(), bytesPerPxl, stripMemoryMB);
+        return std::max(std::min(stripRows, node->getHeight()), 1);
+    }
+
+    void RSGISVirtualImageSinks::writeImage(RSGISVirtualImageNode *node, std::string outputImage, std::string gdalFormat, GDALDataType outDataType, std::vector<std::string> bandNames)
+    {
+        int numBands = node->getNumBands();
+        if((!bandNames.empty()) && (bandNames.size() != ((size_t)numBands)))
+        {
+            throw RSGISImageCalcException("The number of band names is not the same as the number of bands of the virtual image.");
+        }
+
+        GDALDataset *outDataset = RSGISVirtualImageSinks::createImage(node, outputImage, gdalFormat, numBands, outDataType);
+        for(unsigned int n = 0; n < bandNames.size(); ++n)
+        {
+            outDataset->GetRasterBand(n+1)->SetDescription(bandNames[n].c_str());
+        }
+
+        try
+        {
+            std::vector<GDALRasterBand*> outBands(numBands);
+            for(int n = 0; n < numBands; ++n)
+            {
+                outBands[n] = outDataset->GetRasterBand(n+1);
+            }
+            RSGISVirtualImageSinks::writeBlocks(node, outBands);
+        }
+        catch(std::exception&)
+        {
+            GDALClose(outDataset);
+            throw;
+        }
+        GDALClose(outDataset);
+    }
+
+    void RSGISVirtualImageSinks::writeBandImages(RSGISVirtualImageNode *node, std::vector<std::string> outputImages, std::string gdalFormat, std::vector<GDALDataType> outDataTypes)
+    {
+        int numBands = node->getNumBands();
+        if((outputImages.size() != ((size_t)numBands)) || (outDataTypes.size() != ((size_t)numBands)))
+        {
+            throw RSGISImageCalcException("An output image and data type are needed for each band of the virtual image.");
+        }
+
+        std::vector<GDALDataset*> outDatasets;
+        try
+        {
+            std::vector<GDALRasterBand*> outBands(numBands);
+            for(int n = 0; n < numBands; ++n)
+            {
+                outDatasets.push_back(RSGISVirtualImageSinks::createImage(node, outputImages[n], gdalFormat, 1, outDataTypes[n]));
+                outBands[n] = outDatasets[n]->GetRasterBand(1);
+            }
+            RSGISVirtualImageSinks::writeBlocks(node, outBands);
+        }
+        catch(std::exception&)
+        {
+            for(size_t n = 0; n < outDatasets.size(); ++n)
+            {
+                GDALClose(outDatasets[n]);
+            }
+            throw;
+        }
+        for(size_t n = 0; n < outDatasets.size(); ++n)
+        {
+            GDALClose(outDatasets[n]);
+        }
+    }
+
+    GDALDataset* RSGISVirtualImageSinks::createImage(RSGISVirtualImageNode *node, std::string outputImage, std::string gdalFormat, int numBands, GDALDataType outDataType)
+    {
+        int width = node->getWidth();
+        int height = node->getHeight();
+        if((width <= 0) || (height <= 0) || (numBands <= 0))
+        {
+            throw RSGISImageCalcException("The virtual image does not have any pixels to write.");
+        }
+
+        GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName(gdalFormat.c_str());
+        if(gdalDriver == NULL)
+        {
+            throw RSGISImageCalcException("Requested GDAL driver does not exists..");
+        }
+        RSGISImageUtils imgUtils;
+        char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(gdalFormat);
+        std::cout << "New image width = " << width << " height = " << height << " bands = " << numBands << std::endl;
+        GDALDataset *outDataset = gdalDriver->Create(outputImage.c_str(), width, height, numBands, outDataType, papszOptions);
+        if(outDataset == NULL)
+        {
+            throw RSGISImageCalcException("Output image could not be created. Check filepath.");
+        }
+        double transform[6];
+        node->getGeoTransform(transform);
+        outDataset->SetGeoTransform(transform);
+        outDataset->SetProjection(node->getProjection().c_str());
+        return outDataset;
+    }
+
+    void RSGISVirtualImageSinks::writeBlocks(RSGISVirtualImageNode *node, std::vector<GDALRasterBand*> outBands)
+    {
+        int width = node->getWidth();
+        int height = node->getHeight();
+        int numBands = node->getNumBands();
+        int stripRows = RSGISVirtualImageSinks::getStripRows(node);
+        std::vector< std::vector<float> > stripVals(numBands, std::vector<float>(((size_t)width) * stripRows));
+        std::vector<float*> stripPtrs(numBands);
+        for(int n = 0; n < numBands; ++n)
+        {
+            stripPtrs[n] = stripVals[n].data();
+        }
+
+        rsgis_tqdm pbar;
+        for(int row = 0; row < height; row += stripRows)
+        {
+            pbar.progress(row, height);
+            RSGISVirtualImageBlock block;
+            block.xOff = 0;
+            block.yOff = row;
+            block.xSize = width;
+            block.ySize = std::min(stripRows, height - row);
+            node->readBlock(block, stripPtrs.data());
+            for(int n = 0; n < numBands; ++n)
+            {
+                if(outBands[n]->RasterIO(GF_Write, 0, row, width, block.ySize, stripPtrs[n], width, block.ySize, GDT_Float32, 0, 0) != CE_None)
+                {
+                    throw RSGISImageCalcException("Could not write the output image band.");
+                }
+            }
+        }
+        pbar.finish();
+    }
+
+    void RSGISVirtualImageSinks::calcImage(RSGISVirtualImageNode *node, RSGISCalcImageValue *calc, unsigned int numIntBands)
+    {
+        int width = node->getWidth();
+        int height = node->getHeight();
+        int numBands = node->getNumBands();
+        if(((int)numIntBands) > numBands)
+        {
+            throw RSGISImageCalcException("There are more integer bands than bands in the virtual image.");
+        }
+        if((width <= 0) || (height <= 0))
+        {
+            return;
+        }
+
+        int stripRows = RSGISVirtualImageSinks::getStripRows(node);
+        std::vector< std::vector<float> > stripVals(numBands, std::vector<float>(((size_t)width) * stripRows));
+        std::vector<float*> stripPtrs(numBands);
+        for(int n = 0; n < numBands; ++n)
+        {
+            stripPtrs[n] = stripVals[n].data();
+        }
+        unsigned int numFloatBands = numBands - numIntBands;
+        std::vector<long> intDataColumn(numIntBands);
+        std::vector<float> floatDataColumn(numFloatBands);
+
+        rsgis_tqdm pbar;
+        for(int row = 0; row < height; row += stripRows)
+        {
+            pbar.progress(row, height);
+            RSGISVirtualImageBlock block;
+            block.xOff = 0;
+            block.yOff = row;
+            block.xSize = width;
+            block.ySize = std::min(stripRows, height - row);
+            node->readBlock(block, stripPtrs.data());
+
+            size_t nPxls = ((size_t)width) * block.ySize;
+            for(size_t i = 0; i < nPxls; ++i)
+            {
+                for(unsigned int n = 0; n < numIntBands; ++n)
+                {
+                    intDataColumn[n] = (long)stripPtrs[n][i];
+                }
+                for(unsigned int n = 0; n < numFloatBands; ++n)
+                {
+                    floatDataColumn[n] = stripPtrs[numIntBands + n][i];
+                }
+                if(numIntBands == 0)
+                {
+                    calc->calcImageValue(floatDataColumn.data(), numFloatBands);
+                }
+                else
+                {
+                    calc->calcImageValue(intDataColumn.data(), numIntBands, floatDataColumn.data(), numFloatBands);
+                }
+            }
+        }
+        pbar.finish();
+    }
+
+}}
@@ -0,0 +1,194 @@
+/*
+ *  RSGISVirtualImage.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISVirtualImage_H
+#define RSGISVirtualImage_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISImageException.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/rsgis-tqdm.h"
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISCalcImageValue.h"
+#include "img/RSGISImageUtils.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+
+    static const int RSGIS_VIRTUAL_IMAGE_STRIP_ROWS( 256 );
+
+    /** A window of pixels within the image of a virtual image node. */
+    struct DllExport RSGISVirtualImageBlock
+    {
+        int xOff;
+        int yOff;
+        int xSize;
+        int ySize;
+    };
+
+    /**
+     * A node of a lazy image processing graph. Nothing is computed until a sink
+     * (see RSGISVirtualImageSinks) reads the blocks of the final node, which reads
+     * the blocks it needs from its inputs, so only the final product is written
+     * to disk. The inputs of a node are not owned by the node and must exist for
+     * as long as it is used.
+     */
+    class DllExport RSGISVirtualImageNode
+    {
+    public:
+        RSGISVirtualImageNode();
+        int getWidth(){return this->width;};
+        int getHeight(){return this->height;};
+        int getNumBands(){return this->numBands;};
+        void getGeoTransform(double *transform);
+        std::string getProjection(){return this->projection;};
+        /**
+         * Read the values of the block into bandData, where the value of column x
+         * and row y of band b is bandData[b][(y*block.xSize)+x]. The block can extend
+         * outside of the image, where the values are 0 (as with the window engines of
+         * RSGISCalcImage).
+         */
+        virtual void readBlock(const RSGISVirtualImageBlock &block, float **bandData) = 0;
+        virtual ~RSGISVirtualImageNode(){};
+    protected:
+        void setGeometry(RSGISVirtualImageNode *node);
+        /** Set the values of the block outside of the image to 0. */
+        void zeroOutsideImage(const RSGISVirtualImageBlock &block, float **bandData);
+        int width;
+        int height;
+        int numBands;
+        double transform[6];
+        std::string projection;
+    };
+
+    /** The bands of the overlap of a set of images (as used by RSGISCalcImage::calcImage). */
+    class DllExport RSGISVirtualImageDataset : public RSGISVirtualImageNode
+    {
+    public:
+        RSGISVirtualImageDataset(GDALDataset **datasets, int numDS);
+        void readBlock(const RSGISVirtualImageBlock &block, float **bandData);
+        ~RSGISVirtualImageDataset();
+    protected:
+        std::vector<GDALRasterBand*> bands;
+        std::vector<int> bandXOff;
+        std::vector<int> bandYOff;
+    };
+
+    /** The bands of a set of nodes (which must be the same size) stacked in order. */
+    class DllExport RSGISVirtualImageStack : public RSGISVirtualImageNode
+    {
+    public:
+        RSGISVirtualImageStack(std::vector<RSGISVirtualImageNode*> inputs);
+        void readBlock(const RSGISVirtualImageBlock &block, float **bandData);
+        ~RSGISVirtualImageStack();
+    protected:
+        std::vector<RSGISVirtualImageNode*> inputs;
+    };
+
+    /**
+     * Applies a per-pixel calculation (calcImageBlock if implemented, otherwise
+     * calcImageValue(float *bandValues, int numBands, double *output)) to the input.
+     * The output values are converted to valsDataType, so they are the same as
+     * those read back from an intermediate image of that data type.
+     */
+    class DllExport RSGISVirtualImageCalc : public RSGISVirtualImageNode
+    {
+    public:
+        RSGISVirtualImageCalc(RSGISVirtualImageNode *input, RSGISCalcImageValue *calc, GDALDataType valsDataType=GDT_Float32);
+        void readBlock(const RSGISVirtualImageBlock &block, float **bandData);
+        ~RSGISVirtualImageCalc();
+    protected:
+        RSGISVirtualImageNode *input;
+        RSGISCalcImageValue *calc;
+        GDALDataType valsDataType;
+        std::vector< std::vector<float> > inVals;
+        std::vector< std::vector<double> > outVals;
+        std::vector<unsigned char> typeVals;
+    };
+
+    /**
+     * Applies a window calculation (calcImageWindowView / calcImageWindowViewSlide if
+     * implemented, otherwise calcImageValue(float ***dataBlock, ...)) to the input
+     * as RSGISCalcImage::calcImageWindowData does, including the windows at the
+     * edges of the image where the pixels outside the image are 0.
+     */
+    class DllExport RSGISVirtualImageWindowCalc : public RSGISVirtualImageNode
+    {
+    public:
+        RSGISVirtualImageWindowCalc(RSGISVirtualImageNode *input, RSGISCalcImageValue *calc, int windowSize, GDALDataType valsDataType=GDT_Float32);
+        void readBlock(const RSGISVirtualImageBlock &block, float **bandData);
+        ~RSGISVirtualImageWindowCalc();
+    protected:
+        RSGISVirtualImageNode *input;
+        RSGISCalcImageValue *calc;
+        int windowSize;
+        GDALDataType valsDataType;
+        std::vector< std::vector<float> > inVals;
+        std::vector< std::vector<double> > outVals;
+        std::vector<unsigned char> typeVals;
+    };
+
+    /** The terminal steps of a graph, which read all the blocks of the final node. */
+    class DllExport RSGISVirtualImageSinks
+    {
+    public:
+        /** Write the node to a new image. */
+        static void writeImage(RSGISVirtualImageNode *node, std::string outputImage, std::string gdalFormat, GDALDataType outDataType, std::vector<std::string> bandNames=std::vector<std::string>());
+        /** Write each band of the node to its own single band image, with the data type given for that band. */
+        static void writeBandImages(RSGISVirtualImageNode *node, std::vector<std::string> outputImages, std::string gdalFormat, std::vector<GDALDataType> outDataTypes);
+        /**
+         * Pass every pixel of the node to a calculation which accumulates values
+         * (e.g., statistics or the columns of a RAT). If numIntBands is 0 then
+         * calcImageValue(float *bandValues, int numBands) is called, otherwise the
+         * first numIntBands bands (e.g., the clumps) are passed as integers with
+         * calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals).
+         */
+        static void calcImage(RSGISVirtualImageNode *node, RSGISCalcImageValue *calc, unsigned int numIntBands=0);
+    protected:
+        static int getStripRows(RSGISVirtualImageNode *node);
+        static GDALDataset* createImage(RSGISVirtualImageNode *node, std::string outputImage, std::string gdalFormat, int numBands, GDALDataType outDataType);
+        /** Read all the blocks of the node and write band n to outBands[n]. */
+        static void writeBlocks(RSGISVirtualImageNode *node, std::vector<GDALRasterBand*> outBands);
+    };
+
+}}
+
+#endif
@@ -0,0 +1,301 @@
+/*
+ *  RSGISBaysianLikelihoodTable.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISBaysianLikelihoodTable.h"
+
+namespace rsgis{namespace math{
+    
+    RSGISBaysianLikelihoodTable::RSGISBaysianLikelihoodTable(RSGISMathFunction *function, RSGISProbDistro *probDistro, double variance, double interval, double minVal, double maxVal, double lowerLimit, double upperLimit, deltatypedef deltatype, double quantStep, size_t maxCacheSize)
+    {
+        if((deltatype != area) && (deltatype != prob))
+        {
+            throw RSGISBaysianStatsException("Unknown delta type. Valid types are area and prob");
+        }
+        double nSegs = ceil((maxVal-minVal)/interval);
+        if(!(nSegs > 0))
+        {
+            throw RSGISMathException("Incorrect min, max or division values provided");
+        }
+        if(quantStep < 0)
+        {
+            throw RSGISMathException("The quantisation step for the cache cannot be negative.");
+        }
+        
+        this->deltatype = deltatype;
+        this->var2 = 2 * (variance * variance);
+        this->interval = interval;
+        this->minVal = minVal;
+        this->lowerLimit = lowerLimit;
+        this->upperLimit = upperLimit;
+        this->quantStep = quantStep;
+        this->maxCacheSize = maxCacheSize;
+        this->numSegments = static_cast<size_t>(nSegs);
+        
+        size_t numPts = this->numSegments + 1;
+        this->fTable.resize(numPts);
+        this->priorTable.resize(numPts, 1.0);
+        for(size_t i = 0; i < numPts; ++i)
+        {
+            double x = minVal + (i * interval);
+            this->fTable[i] = function->calcFunction(x);
+            if(probDistro != NULL)
+            {
+                this->priorTable[i] = probDistro->calcProb(x);
+                if(this->priorTable[i] < 0)
+                {
+                    throw RSGISMathException("The prior probability cannot be negative as the areas are calculated for positive values of y.");
+                }
+            }
+        }
+        this->segAreas.resize(this->numSegments);
+    }
+    
+    void RSGISBaysianLikelihoodTable::calcValue(float value, double *mlVal, double *lowerVal, double *upperVal)
+    {
+        int64_t key = 0;
+        double evalValue = 0;
+        if(this->calcCacheKey(value, &key, &evalValue))
+        {
+            std::unordered_map<int64_t, size_t>::iterator iterCache = this->cacheIdx.find(key);
+            if(iterCache != this->cacheIdx.end())
+            {
+                const double *result = &this->cacheResults[iterCache->second * 3];
+                *mlVal = result[0];
+                *lowerVal = result[1];
+                *upperVal = result[2];
+                return;
+            }
+        }
+        this->calcValues(&value, 1, mlVal, lowerVal, upperVal);
+    }
+    
+    void RSGISBaysianLikelihoodTable::calcValues(const float *values, size_t n, double *mlVals, double *lowerVals, double *upperVals)
+    {
+        // Find the values which are not within the cache (each only once) and
+        // record where the result for each value is to be read from; indexes
+        // >= 0 are within the cache and < 0 within the new results.
+        std::vector<int64_t> &resultIdx = this->resultIdx;
+        std::unordered_map<int64_t, size_t> &newIdx = this->newIdx;
+        std::vector<char> &missCache = this->missCache;
+        resultIdx.resize(n);
+        newIdx.clear();
+        missCache.clear();
+        this->missVals.clear();
+        this->missKeys.clear();
+        int64_t key = 0;
+        double evalValue = 0;
+        for(size_t p = 0; p < n; ++p)
+        {
+            if(this->calcCacheKey(values[p], &key, &evalValue))
+            {
+                std::unordered_map<int64_t, size_t>::iterator iterCache = this->cacheIdx.find(key);
+                if(iterCache != this->cacheIdx.end())
+                {
+                    resultIdx[p] = static_cast<int64_t>(iterCache->second);
+                    continue;
+                }
+                std::unordered_map<int64_t, size_t>::iterator iterNew = newIdx.find(key);
+                if(iterNew != newIdx.end())
+                {
+                    resultIdx[p] = -static_cast<int64_t>(iterNew->second) - 1;
+                    continue;
+                }
+                newIdx[key] = this->missVals.size();
+                missCache.push_back(true);
+            }
+            else
+            {
+                missCache.push_back(false);
+            }
+            resultIdx[p] = -static_cast<int64_t>(this->missVals.size()) - 1;
+            this->missVals.push_back(evalValue);
+            this->missKeys.push_back(key);
+        }
+        
+        this->missResults.resize(this->missVals.size() * 3);
+        const size_t batchSize = 64;
+        for(size_t s = 0; s < this->missVals.size(); s += batchSize)
+        {
+            size_t nBatch = std::min(batchSize, this->missVals.size() - s);
+            this->calcBatch(&this->missVals[s], nBatch, &this->missResults[s * 3]);
+        }
+        
+        for(size_t p = 0; p < n; ++p)
+        {
+            const double *result = (resultIdx[p] >= 0)?&this->cacheResults[resultIdx[p] * 3]:&this->missResults[(-resultIdx[p] - 1) * 3];
+            mlVals[p] = result[0];
+            lowerVals[p] = result[1];
+            upperVals[p] = result[2];
+        }
+        
+        // Add the new results to the cache, starting again once it is full.
+        if(!this->missVals.empty() && (this->maxCacheSize > 0))
+        {
+            if((this->getCacheSize() + this->missVals.size()) > this->maxCacheSize)
+            {
+                this->cacheIdx.clear();
+                this->cacheResults.clear();
+            }
+            for(size_t m = 0; (m < this->missVals.size()) && (this->getCacheSize() < this->maxCacheSize); ++m)
+            {
+                if(missCache[m])
+                {
+                    this->cacheIdx[this->missKeys[m]] = this->getCacheSize();
+                    this->cacheResults.insert(this->cacheResults.end(), &this->missResults[m * 3], &this->missResults[m * 3] + 3);
+                }
+            }
+        }
+    }
+    
+    bool RSGISBaysianLikelihoodTable::calcCacheKey(float value, int64_t *key, double *evalValue) const
+    {
+        *evalValue = value;
+        if(this->quantStep > 0)
+        {
+            double q = std::floor((value / this->quantStep) + 0.5);
+            if(!(std::fabs(q) < 4.0e15))
+            {
+                // Not finite or too large to be used as a key; not cached.
+                return false;
+            }
+            *key = static_cast<int64_t>(q);
+            *evalValue = q * this->quantStep;
+        }
+        else
+        {
+            uint32_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(float));
+            *key = bits;
+        }
+        return true;
+    }
+    
+    void RSGISBaysianLikelihoodTable::calcBatch(const double *values, size_t n, double *results)
+    {
+        // The likelihoods are sample-major so the inner loop is over the values
+        // of the batch (a contiguous run the compiler can vectorise).
+        size_t numPts = this->numSegments + 1;
+        this->yBatch.resize(numPts * n);
+        for(size_t i = 0; i < numPts; ++i)
+        {
+            const double fVal = this->fTable[i];
+            const double priorVal = this->priorTable[i];
+            double *yVals = &this->yBatch[i * n];
+            for(size_t j = 0; j < n; ++j)
+            {
+                double diff = values[j] - fVal;
+                yVals[j] = std::exp((-1) * ((diff * diff) / this->var2)) * priorVal;
+            }
+        }
+        
+        for(size_t j = 0; j < n; ++j)
+        {
+            this->summariseLikelihood(&this->yBatch[j], n, &results[j * 3]);
+        }
+    }
+    
+    void RSGISBaysianLikelihoodTable::summariseLikelihood(const double *yVals, size_t stride, double *result)
+    {
+        // Trapezium areas of the segments and the maximum likelihood (the segment
+        // with the largest area), as TrapeziumIntegration::calcArea and calcMaxValue.
+        double totalArea = 0;
+        size_t maxSegment = 0;
+        for(size_t i = 0; i < this->numSegments; ++i)
+        {
+            double yL = yVals[i * stride];
+            double yU = yVals[(i + 1) * stride];
+            double minHeight = std::min(yL, yU);
+            double maxHeight = std::max(yL, yU);
+            this->segAreas[i] = (minHeight * this->interval) + (((maxHeight - minHeight) * this->interval)/2);
+            totalArea += this->segAreas[i];
+            if(this->segAreas[i] > this->segAreas[maxSegment])
+            {
+                maxSegment = i;
+            }
+        }
+        result[0] = this->minVal + (static_cast<double>(maxSegment) * this->interval);
+        
+        if(this->deltatype == area)
+        {
+            // The values at which the proportions of the total area are passed (TrapeziumIntegration::calcValue4ProportionArea).
+            double limits[2] = {totalArea * this->lowerLimit, totalArea * this->upperLimit};
+            for(unsigned int l = 0; l < 2; ++l)
+            {
+                double sum = 0;
+                long index = 0;
+                for(size_t i = 0; i < this->numSegments; ++i)
+                {
+                    sum += this->segAreas[i];
+                    if((limits[l] - sum) < 0)
+                    {
+                        index = static_cast<long>(i) - 1;
+                        break;
+                    }
+                }
+                result[1 + l] = this->minVal + (index * this->interval);
+            }
+        }
+        else
+        {
+            // The samples either side of the peak closest to the proportion of its
+            // height (TrapeziumIntegration::getUpperLowerValues).
+            size_t numPts = this->numSegments + 1;
+            size_t maxIndex = 0;
+            for(size_t i = 1; i < numPts; ++i)
+            {
+                if(yVals[i * stride] > yVals[maxIndex * stride])
+                {
+                    maxIndex = i;
+                }
+            }
+            double threshold = yVals[maxIndex * stride] * this->lowerLimit;
+            
+            size_t lowerIndex = 0;
+            size_t upperIndex = 0;
+            double minLowerDiff = 0;
+            double minUpperDiff = 0;
+            double diff = 0;
+            for(size_t i = 0; i < numPts; ++i)
+            {
+                diff = threshold - yVals[i * stride];
+                diff = diff * diff;
+                if(i < maxIndex)
+                {
+                    if((i == 0) || (diff < minLowerDiff))
+                    {
+                        lowerIndex = i;
+                        minLowerDiff = diff;
+                    }
+                }
+                else if((i == maxIndex) || (diff < minUpperDiff))
+                {
+                    upperIndex = i;
+                    minUpperDiff = diff;
+                }
+            }
+            result[1] = (lowerIndex == 0)?0:(this->minVal + ((static_cast<double>(lowerIndex) - 1) * this->interval));
+            result[2] = (upperIndex == 0)?0:(this->minVal + ((static_cast<double>(upperIndex) - 1) * this->interval));
+        }
+    }
+    
+}}
@@ -0,0 +1,117 @@
+/*
+ *  RSGISBaysianLikelihoodTable.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISBaysianLikelihoodTable_H
+#define RSGISBaysianLikelihoodTable_H
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+#include "math/RSGISMathFunction.h"
+#include "math/RSGISProbDistro.h"
+#include "math/RSGISMathException.h"
+#include "math/RSGISBaysianStatsException.h"
+#include "math/RSGISBaysianDeltaType.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_maths_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace math{
+    
+    /**
+     * Evaluates the same maximum likelihood value and lower/upper limits as
+     * RSGISBaysianStatsNoPrior / RSGISBaysianStatsPrior (trapezium integration
+     * of exp(-(value-f(x))^2/(2 variance^2)) [* prior(x)] over [minVal, maxVal])
+     * for many values at once. The forward function and prior are only a function
+     * of the integration sample locations, so they are tabulated once when the
+     * object is created and the per value integration is a tight loop over the
+     * tables (run over a batch of values at a time) without any virtual calls.
+     *
+     * The results are memoised on the input value, which can be quantised
+     * (quantStep > 0; the value is rounded to the nearest multiple of quantStep)
+     * so neighbouring values share a result. With quantStep = 0 the memoisation
+     * is on the exact value and the results are not changed by the cache.
+     *
+     * An object must not be used by more than one thread at a time.
+     */
+    class DllExport RSGISBaysianLikelihoodTable
+    {
+    public:
+        /** probDistro is NULL for no prior. The function and prior are only used within the constructor. */
+        RSGISBaysianLikelihoodTable(RSGISMathFunction *function, RSGISProbDistro *probDistro, double variance, double interval, double minVal, double maxVal, double lowerLimit, double upperLimit, deltatypedef deltatype, double quantStep=0, size_t maxCacheSize=1048576);
+        /** Calculate the maximum likelihood value and the lower and upper values for a single value. */
+        void calcValue(float value, double *mlVal, double *lowerVal, double *upperVal);
+        /** Calculate the maximum likelihood, lower and upper values for n values (output arrays of length n). */
+        void calcValues(const float *values, size_t n, double *mlVals, double *lowerVals, double *upperVals);
+        /** The number of values currently held within the cache. */
+        size_t getCacheSize() const {return this->cacheResults.size()/3;};
+        ~RSGISBaysianLikelihoodTable(){};
+    protected:
+        bool calcCacheKey(float value, int64_t *key, double *evalValue) const;
+        void calcBatch(const double *values, size_t n, double *results);
+        void summariseLikelihood(const double *yVals, size_t stride, double *result);
+        deltatypedef deltatype;
+        double var2;
+        double interval;
+        double minVal;
+        double lowerLimit;
+        double upperLimit;
+        double quantStep;
+        size_t maxCacheSize;
+        size_t numSegments;
+        /// The forward function and prior at the numSegments+1 sample locations.
+        std::vector<double> fTable;
+        std::vector<double> priorTable;
+        /// Scratch buffers for a batch of values (the likelihoods are sample-major).
+        std::vector<double> yBatch;
+        std::vector<double> segAreas;
+        /// The memoised results (3 values per entry) and their index from the cache key.
+        std::unordered_map<int64_t, size_t> cacheIdx;
+        std::vector<double> cacheResults;
+        /// The values of a call not within the cache and where the result for each value is read from.
+        std::unordered_map<int64_t, size_t> newIdx;
+        std::vector<int64_t> resultIdx;
+        std::vector<char> missCache;
+        std::vector<double> missVals;
+        std::vector<int64_t> missKeys;
+        std::vector<double> missResults;
+    };
+    
+}}
+
+#endif
@@ -51,7 +51,7 @@ namespace rsgis
 			public:
 				RSGISBaysianStatsNoPrior(RSGISMathFunction *function, double variance, double interval, double minVal, double maxVal, double lowerLimit, double upperLimit, deltatypedef deltatype);
 				virtual double* calcImageValueNoPrior(float value);
-				virtual ~RSGISBaysianStatsNoPrior(){};
+				virtual ~RSGISBaysianStatsNoPrior(){delete baysianFunction;};
 			protected:
 				deltatypedef deltatype;
 				double variance;
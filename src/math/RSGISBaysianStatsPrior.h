@@ -52,7 +52,7 @@ namespace rsgis
 			public:
 				RSGISBaysianStatsPrior(RSGISMathFunction *function, RSGISProbDistro *probDist , double variance, double interval, double minVal, double maxVal, double lowerLimit, double upperLimit, deltatypedef deltatype);
 				virtual double* calcImageValuePrior(float value);
-				virtual ~RSGISBaysianStatsPrior(){};
+				virtual ~RSGISBaysianStatsPrior(){delete baysianFunction;};
 			protected:
 				deltatypedef deltatype;
 				double variance;
@@ -25,32 +25,54 @@
 
 namespace rsgis {namespace math{
 
+    void RSGISClusterer::packSamples(std::vector< std::vector<float> > *input, unsigned int numFeatures, std::vector<float> *data)
+    {
+        data->resize(input->size() * numFeatures);
+        size_t n = 0;
+        for(std::vector< std::vector<float> >::iterator iterFeatures = input->begin(); iterFeatures != input->end(); ++iterFeatures, ++n)
+        {
+            if((*iterFeatures).size() < numFeatures)
+            {
+                throw RSGISClustererException("A sample has fewer values than the number of features.");
+            }
+            for(unsigned int i = 0; i < numFeatures; ++i)
+            {
+                (*data)[(n * numFeatures) + i] = (*iterFeatures)[i];
+            }
+        }
+    }
+    
     void RSGISClusterer::calcDataRanges(std::vector< std::vector<float> > *input, unsigned int numFeatures, float *min, float *max)
     {
-        bool first = true;
-        std::vector< std::vector<float> >::iterator iterFeatures;
-        for(iterFeatures = input->begin(); iterFeatures != input->end(); ++iterFeatures)
+        std::vector<float> data;
+        this->packSamples(input, numFeatures, &data);
+        this->calcDataRanges(data.empty()?NULL:&data[0], input->size(), numFeatures, min, max);
+    }
+    
+    void RSGISClusterer::calcDataRanges(const float *data, size_t numSamples, unsigned int numFeatures, float *min, float *max)
+    {
+        for(size_t n = 0; n < numSamples; ++n)
         {
-            if(first)
+            const float *sample = &data[n * numFeatures];
+            if(n == 0)
             {
                 for(unsigned int i = 0; i < numFeatures; ++i)
                 {
-                    min[i] = (*iterFeatures)[i];
-                    max[i] = (*iterFeatures)[i];
+                    min[i] = sample[i];
+                    max[i] = sample[i];
                 }
-                first = false;
             }
             else
             {
                 for(unsigned int i = 0; i < numFeatures; ++i)
                 {
-                    if((*iterFeatures)[i] < min[i])
+                    if(sample[i] < min[i])
                     {
-                         min[i] = (*iterFeatures)[i];
+                         min[i] = sample[i];
                     }
-                    else if((*iterFeatures)[i] > max[i])
+                    else if(sample[i] > max[i])
                     {
-                        max[i] = (*iterFeatures)[i];
+                        max[i] = sample[i];
                     }
                 }
             }
@@ -59,65 +81,69 @@ namespace rsgis {namespace math{
     
     void RSGISClusterer::calcDataStats(std::vector< std::vector<float> > *input, unsigned int numFeatures, float *min, float *max, float *mean, float *stddev)
     {
-        bool first = true;
-        std::vector< std::vector<float> >::iterator iterFeatures;
-        for(iterFeatures = input->begin(); iterFeatures != input->end(); ++iterFeatures)
+        std::vector<float> data;
+        this->packSamples(input, numFeatures, &data);
+        this->calcDataStats(data.empty()?NULL:&data[0], input->size(), numFeatures, min, max, mean, stddev);
+    }
+    
+    void RSGISClusterer::calcDataStats(const float *data, size_t numSamples, unsigned int numFeatures, float *min, float *max, float *mean, float *stddev)
+    {
+        for(size_t n = 0; n < numSamples; ++n)
         {
-            if(first)
+            const float *sample = &data[n * numFeatures];
+            if(n == 0)
             {
                 for(unsigned int i = 0; i < numFeatures; ++i)
                 {
-                    min[i] = (*iterFeatures)[i];
-                    max[i] = (*iterFeatures)[i];
-                    mean[i] = (*iterFeatures)[i];
+                    min[i] = sample[i];
+                    max[i] = sample[i];
+                    mean[i] = sample[i];
                 }
-                first = false;
             }
             else
             {
                 for(unsigned int i = 0; i < numFeatures; ++i)
                 {
-                    if((*iterFeatures)[i] < min[i])
+                    if(sample[i] < min[i])
                     {
-                        min[i] = (*iterFeatures)[i];
+                        min[i] = sample[i];
                     }
-                    else if((*iterFeatures)[i] > max[i])
+                    else if(sample[i] > max[i])
                     {
-                        max[i] = (*iterFeatures)[i];
+                        max[i] = sample[i];
                     }
-                    mean[i] += (*iterFeatures)[i];
+                    mean[i] += sample[i];
                 }
             }
         }
         
         for(unsigned int i = 0; i < numFeatures; ++i)
         {
-            mean[i] = mean[i]/input->size();
+            mean[i] = mean[i]/numSamples;
         }
         
-        first = true;
-        for(iterFeatures = input->begin(); iterFeatures != input->end(); ++iterFeatures)
+        for(size_t n = 0; n < numSamples; ++n)
         {
-            if(first)
+            const float *sample = &data[n * numFeatures];
+            if(n == 0)
             {
                 for(unsigned int i = 0; i < numFeatures; ++i)
                 {
-                    stddev[i] = (((*iterFeatures)[i] - mean[i]) * ((*iterFeatures)[i] - mean[i]));
+                    stddev[i] = ((sample[i] - mean[i]) * (sample[i] - mean[i]));
                 }
-                first = false;
             }
             else
             {
                 for(unsigned int i = 0; i < numFeatures; ++i)
                 {
-                    stddev[i] += (((*iterFeatures)[i] - mean[i]) * ((*iterFeatures)[i] - mean[i]));
+                    stddev[i] += ((sample[i] - mean[i]) * (sample[i] - mean[i]));
                 }
             }
         }
         
         for(unsigned int i = 0; i < numFeatures; ++i)
         {
-            stddev[i] = sqrt(stddev[i]/input->size());
+            stddev[i] = sqrt(stddev[i]/numSamples);
         }
         
     }
@@ -161,20 +187,26 @@ namespace rsgis {namespace math{
     
     std::vector< RSGISClusterCentre >* RSGISClusterer::initializeClusterCentresRandom(std::vector< std::vector<float> > *input, unsigned int numFeatures, unsigned int numClusters)
     {
+        std::vector<float> data;
+        this->packSamples(input, numFeatures, &data);
+        return this->initializeClusterCentresRandom(data.empty()?NULL:&data[0], input->size(), numFeatures, numClusters);
+    }
+    
+    std::vector< RSGISClusterCentre >* RSGISClusterer::initializeClusterCentresRandom(const float *data, size_t numSamples, unsigned int numFeatures, unsigned int numClusters)
+    {
+        if(numSamples < numClusters)
+        {
+            throw RSGISClustererException("Too many clusters. There needs to be more data points than clusters.");
+        }
+        
         std::vector< RSGISClusterCentre > *clusterCentres = new std::vector< RSGISClusterCentre >();
         clusterCentres->reserve(numClusters);
         
         RSGISPsudoRandDistroUniformDouble probDist(0, 1);
         
-        unsigned int sampleIndex = 0;
-        size_t numVals = input->size(); 
+        size_t sampleIndex = 0;
         
-        if(numVals < numClusters)
-        {
-            throw RSGISClustererException("Too many clusters. There needs to be more data points than clusters.");
-        }
-        
-        std::vector<unsigned int> indexesUsed;
+        std::vector<size_t> indexesUsed;
         bool findingIdx = true;
         bool idxUsed = false;
         bool sameSeed = true;
@@ -189,10 +221,14 @@ namespace rsgis {namespace math{
             findingIdx = true;
             while(findingIdx)
             {
-                sampleIndex = (probDist.calcRand()*numVals);
+                sampleIndex = (probDist.calcRand()*numSamples);
+                if(sampleIndex >= numSamples)
+                {
+                    sampleIndex = numSamples - 1;
+                }
                 idxUsed = false;
                 
-                for(std::vector<unsigned int>::iterator iterIdxs = indexesUsed.begin(); iterIdxs != indexesUsed.end(); ++iterIdxs)
+                for(std::vector<size_t>::iterator iterIdxs = indexesUsed.begin(); iterIdxs != indexesUsed.end(); ++iterIdxs)
                 {
                     if((*iterIdxs) == sampleIndex)
                     {
@@ -203,7 +239,7 @@ namespace rsgis {namespace math{
                     sameSeed = true;
                     for(unsigned int j = 0; j < numFeatures; ++j)
                     {
-                        if(input->at(*iterIdxs)[j] != input->at(sampleIndex)[j])
+                        if(data[((*iterIdxs) * numFeatures) + j] != data[(sampleIndex * numFeatures) + j])
                         {
                             sameSeed = false;
                         }
@@ -224,7 +260,7 @@ namespace rsgis {namespace math{
                 }
             }
             
-            std::vector<float> sample = input->at(sampleIndex);
+            const float *sample = &data[sampleIndex * numFeatures];
             
             for(unsigned int j = 0; j < numFeatures; ++j)
             {
@@ -402,6 +438,13 @@ namespace rsgis {namespace math{
     }
     
     std::vector< RSGISClusterCentre >* RSGISClusterer::initializeClusterCentresDiagonal(std::vector< std::vector<float> > *input, unsigned int numFeatures, float *min, float *max, unsigned int numClusters)
+    {
+        std::vector<float> data;
+        this->packSamples(input, numFeatures, &data);
+        return this->initializeClusterCentresDiagonal(data.empty()?NULL:&data[0], input->size(), numFeatures, min, max, numClusters);
+    }
+    
+    std::vector< RSGISClusterCentre >* RSGISClusterer::initializeClusterCentresDiagonal(const float *data, size_t numSamples, unsigned int numFeatures, float *min, float *max, unsigned int numClusters)
     {
         std::vector< RSGISClusterCentre > *clusterCentres = new std::vector< RSGISClusterCentre >();
         clusterCentres->reserve(numClusters);
@@ -430,7 +473,7 @@ namespace rsgis {namespace math{
                     cCentre.stdDev.push_back(0);
                 }
 
-                this->assign2ClosestDataPoint(&cCentre, input, numFeatures, clusterCentres);
+                this->assign2ClosestDataPoint(&cCentre, data, numSamples, numFeatures, clusterCentres);
                 clusterCentres->push_back(cCentre);
             }
             
@@ -445,6 +488,13 @@ namespace rsgis {namespace math{
     }
     
     std::vector< RSGISClusterCentre >* RSGISClusterer::initializeClusterCentresDiagonal(std::vector< std::vector<float> > *input, unsigned int numFeatures, float *min, float *max, float *mean, float *stddev, unsigned int numClusters)
+    {
+        std::vector<float> data;
+        this->packSamples(input, numFeatures, &data);
+        return this->initializeClusterCentresDiagonal(data.empty()?NULL:&data[0], input->size(), numFeatures, min, max, mean, stddev, numClusters);
+    }
+    
+    std::vector< RSGISClusterCentre >* RSGISClusterer::initializeClusterCentresDiagonal(const float *data, size_t numSamples, unsigned int numFeatures, float *min, float *max, float *mean, float *stddev, unsigned int numClusters)
     {
         std::vector< RSGISClusterCentre > *clusterCentres = new std::vector< RSGISClusterCentre >();
         clusterCentres->reserve(numClusters);
@@ -506,7 +556,7 @@ namespace rsgis {namespace math{
                 cCentreMin.centre.push_back(max[j]);
                 cCentreMin.stdDev.push_back(0);
             }
-            this->assign2ClosestDataPoint(&cCentreMin, input, numFeatures, clusterCentres);
+            this->assign2ClosestDataPoint(&cCentreMin, data, numSamples, numFeatures, clusterCentres);
             clusterCentres->push_back(cCentreMin);
             
             RSGISClusterCentre cCentreMinMid;
@@ -518,7 +568,7 @@ namespace rsgis {namespace math{
                 cCentreMinMid.centre.push_back(min[j] + ((m2StdDev[j]-min[j])/2));
                 cCentreMinMid.stdDev.push_back(0);
             }
-            this->assign2ClosestDataPoint(&cCentreMinMid, input, numFeatures, clusterCentres);
+            this->assign2ClosestDataPoint(&cCentreMinMid, data, numSamples, numFeatures, clusterCentres);
             clusterCentres->push_back(cCentreMinMid);
         }        
         
@@ -535,7 +585,7 @@ namespace rsgis {namespace math{
                 cCentre.centre.push_back(value);
                 cCentre.stdDev.push_back(0);
             }
-            this->assign2ClosestDataPoint(&cCentre, input, numFeatures, clusterCentres);
+            this->assign2ClosestDataPoint(&cCentre, data, numSamples, numFeatures, clusterCentres);
             clusterCentres->push_back(cCentre);
         }
         
@@ -550,7 +600,7 @@ namespace rsgis {namespace math{
                 cCentreMaxMid.centre.push_back(p2StdDev[j] + ((max[j]-p2StdDev[j])/2));
                 cCentreMaxMid.stdDev.push_back(0);
             }
-            this->assign2ClosestDataPoint(&cCentreMaxMid, input, numFeatures, clusterCentres);
+            this->assign2ClosestDataPoint(&cCentreMaxMid, data, numSamples, numFeatures, clusterCentres);
             clusterCentres->push_back(cCentreMaxMid);
             
             RSGISClusterCentre cCentreMax;
@@ -562,7 +612,7 @@ namespace rsgis {namespace math{
                 cCentreMax.centre.push_back(max[j]);
                 cCentreMax.stdDev.push_back(0);
             }
-            this->assign2ClosestDataPoint(&cCentreMax, input, numFeatures, clusterCentres);
+            this->assign2ClosestDataPoint(&cCentreMax, data, numSamples, numFeatures, clusterCentres);
             clusterCentres->push_back(cCentreMax);            
         }
         
@@ -725,6 +775,13 @@ namespace rsgis {namespace math{
     }
     
     void RSGISClusterer::assign2ClosestDataPoint(RSGISClusterCentre *cc, std::vector< std::vector<float> > *input, unsigned int numFeatures, std::vector< RSGISClusterCentre > *used)
+    {
+        std::vector<float> data;
+        this->packSamples(input, numFeatures, &data);
+        this->assign2ClosestDataPoint(cc, data.empty()?NULL:&data[0], input->size(), numFeatures, used);
+    }
+    
+    void RSGISClusterer::assign2ClosestDataPoint(RSGISClusterCentre *cc, const float *data, size_t numSamples, unsigned int numFeatures, std::vector< RSGISClusterCentre > *used)
     {
         bool first = true;
         bool alreadyUsed = 0;
@@ -738,8 +795,9 @@ namespace rsgis {namespace math{
         }
         try 
         {
-            for(std::vector< std::vector<float> >::iterator iterData = input->begin(); iterData != input->end(); ++iterData)
+            for(size_t n = 0; n < numSamples; ++n)
             {
+                const float *sample = &data[n * numFeatures];
                 if(first)
                 {
                     if(used->size() > 0)
@@ -749,7 +807,7 @@ namespace rsgis {namespace math{
                             alreadyUsed = true;
                             for(unsigned int i = 0; i < numFeatures; ++i)
                             {
-                                if((*iterData)[i] != (*iterCC).centre[i])
+                                if(sample[i] != (*iterCC).centre[i])
                                 {
                                     alreadyUsed = false;
                                 }
@@ -767,17 +825,17 @@ namespace rsgis {namespace math{
                     
                     if(!alreadyUsed)
                     {
-                        minDist = this->calcEucDistance(cc->centre, (*iterData));
+                        minDist = this->calcEucDistance(&cc->centre[0], sample, numFeatures);
                         for(unsigned int i = 0; i < numFeatures; ++i)
                         {
-                            cClosest[i] = (*iterData)[i];
+                            cClosest[i] = sample[i];
                         }
                         first = false;
                     }
                 }
                 else
                 {
-                    dist = this->calcEucDistance(cc->centre, (*iterData));
+                    dist = this->calcEucDistance(&cc->centre[0], sample, numFeatures);
                     
                     if(dist < minDist)
                     {
@@ -788,7 +846,7 @@ namespace rsgis {namespace math{
                                 alreadyUsed = true;
                                 for(unsigned int i = 0; i < numFeatures; ++i)
                                 {
-                                    if((*iterData)[i] != (*iterCC).centre[i])
+                                    if(sample[i] != (*iterCC).centre[i])
                                     {
                                         alreadyUsed = false;
                                     }
@@ -809,7 +867,7 @@ namespace rsgis {namespace math{
                             minDist = dist;
                             for(unsigned int i = 0; i < numFeatures; ++i)
                             {
-                                cClosest[i] = (*iterData)[i];
+                                cClosest[i] = sample[i];
                             }
                         }
                     }
@@ -835,76 +893,297 @@ namespace rsgis {namespace math{
         }
     }
     
-
-
-    RSGISKMeansClusterer::RSGISKMeansClusterer(InitClustererMethods initCentres)
-    {
-        this->initCentres = initCentres;
-    }
-        
-    std::vector< RSGISClusterCentre >* RSGISKMeansClusterer::calcClusterCentres(std::vector< std::vector<float> > *input, unsigned int numFeatures, unsigned int numClusters, unsigned int maxNumIterations, float degreeOfChange)
+    std::vector< RSGISClusterCentre >* RSGISClusterer::initializeClusterCentres(InitClustererMethods initCentres, const float *data, size_t numSamples, unsigned int numFeatures, unsigned int numClusters, bool useStdDevDiagonal)
     {
         std::vector< RSGISClusterCentre > *clusterCentres = NULL;
-        try 
+        float *minVals = new float[numFeatures];
+        float *maxVals = new float[numFeatures];
+        float *meanVals = new float[numFeatures];
+        float *stddevVals = new float[numFeatures];
+        try
         {
-            float *minVals = new float[numFeatures];
-            float *maxVals = new float[numFeatures];
-                       
-            if(this->initCentres == init_random)
+            if(initCentres == init_random)
             {
-                //this->calcDataRanges(input, numFeatures, minVals, maxVals);
-                //clusterCentres = this->initializeClusterCentresRandom(numFeatures, minVals, maxVals, numClusters);
-                clusterCentres = this->initializeClusterCentresRandom(input, numFeatures, numClusters);
+                clusterCentres = this->initializeClusterCentresRandom(data, numSamples, numFeatures, numClusters);
             }
-            else if(this->initCentres == init_diagonal_full)
+            else if(initCentres == init_diagonal_full)
             {
-                this->calcDataRanges(input, numFeatures, minVals, maxVals);
+                this->calcDataRanges(data, numSamples, numFeatures, minVals, maxVals);
                 clusterCentres = this->initializeClusterCentresDiagonal(numFeatures, minVals, maxVals, numClusters);
             }
-            else if(this->initCentres == init_diagonal_stddev)
+            else if(initCentres == init_diagonal_stddev)
             {
-                float *meanVals = new float[numFeatures];
-                float *stddevVals = new float[numFeatures];
-                
-                this->calcDataStats(input, numFeatures, minVals, maxVals, meanVals, stddevVals);
-                clusterCentres = this->initializeClusterCentresDiagonal(numFeatures, minVals, maxVals, meanVals, stddevVals, numClusters);
-                
-                delete[] meanVals;
-                delete[] stddevVals;
+                this->calcDataStats(data, numSamples, numFeatures, minVals, maxVals, meanVals, stddevVals);
+                if(useStdDevDiagonal)
+                {
+                    clusterCentres = this->initializeClusterCentresDiagonal(numFeatures, minVals, maxVals, meanVals, stddevVals, numClusters);
+                }
+                else
+                {
+                    clusterCentres = this->initializeClusterCentresDiagonal(numFeatures, minVals, maxVals, numClusters);
+                }
             }
-            else if(this->initCentres == init_diagonal_full_attach)
+            else if(initCentres == init_diagonal_full_attach)
             {
-                this->calcDataRanges(input, numFeatures, minVals, maxVals);
-                clusterCentres = this->initializeClusterCentresDiagonal(input, numFeatures, minVals, maxVals, numClusters);
+                this->calcDataRanges(data, numSamples, numFeatures, minVals, maxVals);
+                clusterCentres = this->initializeClusterCentresDiagonal(data, numSamples, numFeatures, minVals, maxVals, numClusters);
             }
-            else if(this->initCentres == init_diagonal_stddev_attach)
+            else if(initCentres == init_diagonal_stddev_attach)
             {
-                float *meanVals = new float[numFeatures];
-                float *stddevVals = new float[numFeatures];
-                
-                this->calcDataStats(input, numFeatures, minVals, maxVals, meanVals, stddevVals);
-                clusterCentres = this->initializeClusterCentresDiagonal(input, numFeatures, minVals, maxVals, meanVals, stddevVals, numClusters);
-                
-                delete[] meanVals;
-                delete[] stddevVals;
+                this->calcDataStats(data, numSamples, numFeatures, minVals, maxVals, meanVals, stddevVals);
+                clusterCentres = this->initializeClusterCentresDiagonal(data, numSamples, numFeatures, minVals, maxVals, meanVals, stddevVals, numClusters);
             }
-            else if(this->initCentres == init_kpp)
+            else if(initCentres == init_kpp)
             {
-                this->calcDataRanges(input, numFeatures, minVals, maxVals);
-                clusterCentres = this->initializeClusterCentresKPP(input, numFeatures, minVals, maxVals, numClusters);
+                throw RSGISClustererException("initializeClusterCentresKPP is not implemented.");
             }
             else
             {
                 throw RSGISClustererException("Cluster initaliser was now recognised.");
             }
-            
+        }
+        catch (RSGISClustererException &e)
+        {
             delete[] minVals;
             delete[] maxVals;
+            delete[] meanVals;
+            delete[] stddevVals;
+            throw e;
+        }
+        
+        delete[] minVals;
+        delete[] maxVals;
+        delete[] meanVals;
+        delete[] stddevVals;
+        
+        return clusterCentres;
+    }
+    
+    size_t RSGISClusterer::assignSamples(const float *data, size_t numSamples, unsigned int numFeatures, std::vector< RSGISClusterCentre > *clusterCentres, std::vector<unsigned int> *clusterIDs, bool calcStdDev, std::vector<double> *diffSums, std::vector<double> *sqDiffSums, std::vector<size_t> *counts)
+    {
+        size_t numClusters = clusterCentres->size();
+        if(numClusters == 0)
+        {
+            throw RSGISClustererException("There are no cluster centres to assign the samples to.");
+        }
+        if(clusterIDs->size() != numSamples)
+        {
+            throw RSGISClustererException("The number of cluster IDs is not the same as the number of samples.");
+        }
+        
+        // The centres are also stored feature by feature (numFeatures x numClusters) so
+        // the distances to all the centres are accumulated in one vectorisable loop.
+        std::vector<float> centres(numClusters * numFeatures);
+        std::vector<float> centresT(numFeatures * numClusters);
+        for(size_t c = 0; c < numClusters; ++c)
+        {
+            if(clusterCentres->at(c).centre.size() != numFeatures)
+            {
+                throw RSGISClustererException("A cluster centre does not have the same number of features as the samples.");
+            }
+            for(unsigned int f = 0; f < numFeatures; ++f)
+            {
+                centres[(c * numFeatures) + f] = clusterCentres->at(c).centre[f];
+                centresT[(f * numClusters) + c] = clusterCentres->at(c).centre[f];
+            }
+        }
+        
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        unsigned int nThreads = threadPool.getNumThreads();
+        size_t numSumVals = numClusters * numFeatures;
+        std::vector< std::vector<double> > threadDiffSums(nThreads, std::vector<double>(numSumVals, 0.0));
+        std::vector< std::vector<double> > threadSqDiffSums(nThreads, std::vector<double>(calcStdDev?numSumVals:0, 0.0));
+        std::vector< std::vector<size_t> > threadCounts(nThreads, std::vector<size_t>(numClusters, 0));
+        std::vector<size_t> threadChanges(nThreads, 0);
+        
+        const float *cVals = &centres[0];
+        const float *cTVals = &centresT[0];
+        unsigned int *ids = &(*clusterIDs)[0];
+        threadPool.parallelFor(0, numSamples, [&](unsigned int threadIdx, size_t sIdx, size_t eIdx)
+        {
+            std::vector<float> dists(numClusters);
+            float *dist = &dists[0];
+            double *tDiffSums = &threadDiffSums[threadIdx][0];
+            double *tSqDiffSums = calcStdDev?&threadSqDiffSums[threadIdx][0]:NULL;
+            size_t *tCounts = &threadCounts[threadIdx][0];
+            size_t nChange = 0;
+            for(size_t n = sIdx; n < eIdx; ++n)
+            {
+                const float *sample = &data[n * numFeatures];
+                for(size_t c = 0; c < numClusters; ++c)
+                {
+                    dist[c] = 0;
+                }
+                for(unsigned int f = 0; f < numFeatures; ++f)
+                {
+                    const float val = sample[f];
+                    const float *cTRow = &cTVals[f * numClusters];
+                    for(size_t c = 0; c < numClusters; ++c)
+                    {
+                        const float diff = val - cTRow[c];
+                        dist[c] += diff * diff;
+                    }
+                }
+                
+                unsigned int clusterID = 0;
+                float minDist = dist[0];
+                for(size_t c = 1; c < numClusters; ++c)
+                {
+                    if(dist[c] < minDist)
+                    {
+                        minDist = dist[c];
+                        clusterID = c;
+                    }
+                }
+                
+                if(ids[n] != clusterID)
+                {
+                    ids[n] = clusterID;
+                    ++nChange;
+                }
+                
+                ++tCounts[clusterID];
+                const float *centre = &cVals[clusterID * numFeatures];
+                double *cDiffSums = &tDiffSums[clusterID * numFeatures];
+                double diff = 0;
+                if(calcStdDev)
+                {
+                    double *cSqDiffSums = &tSqDiffSums[clusterID * numFeatures];
+                    for(unsigned int f = 0; f < numFeatures; ++f)
+                    {
+                        diff = sample[f] - centre[f];
+                        cDiffSums[f] += diff;
+                        cSqDiffSums[f] += diff * diff;
+                    }
+                }
+                else
+                {
+                    for(unsigned int f = 0; f < numFeatures; ++f)
+                    {
+                        cDiffSums[f] += sample[f] - centre[f];
+                    }
+                }
+            }
+            threadChanges[threadIdx] = nChange;
+        });
+        
+        // Merge the thread sums in thread order.
+        size_t nChange = 0;
+        diffSums->assign(numSumVals, 0.0);
+        sqDiffSums->assign(calcStdDev?numSumVals:0, 0.0);
+        counts->assign(numClusters, 0);
+        for(unsigned int t = 0; t < nThreads; ++t)
+        {
+            for(size_t i = 0; i < numSumVals; ++i)
+            {
+                (*diffSums)[i] += threadDiffSums[t][i];
+            }
+            if(calcStdDev)
+            {
+                for(size_t i = 0; i < numSumVals; ++i)
+                {
+                    (*sqDiffSums)[i] += threadSqDiffSums[t][i];
+                }
+            }
+            for(size_t c = 0; c < numClusters; ++c)
+            {
+                (*counts)[c] += threadCounts[t][c];
+            }
+            nChange += threadChanges[t];
+        }
+        
+        return nChange;
+    }
+    
+    void RSGISClusterer::updateClusterCentres(unsigned int numFeatures, std::vector< RSGISClusterCentre > *clusterCentres, std::vector<unsigned int> *clusterIDs, bool calcStdDev, std::vector<double> *diffSums, std::vector<double> *sqDiffSums, std::vector<size_t> *counts)
+    {
+        size_t numClusters = clusterCentres->size();
+        if(counts->size() != numClusters)
+        {
+            throw RSGISClustererException("The cluster sums do not match the cluster centres.");
+        }
+        
+        std::vector<unsigned int> newClusterIDs(numClusters, 0);
+        std::vector< RSGISClusterCentre > updatedCentres;
+        updatedCentres.reserve(numClusters);
+        bool removed = false;
+        double meanDiff = 0;
+        double variance = 0;
+        for(size_t c = 0; c < numClusters; ++c)
+        {
+            if((*counts)[c] == 0)
+            {
+                removed = true;
+                continue;
+            }
+            
+            RSGISClusterCentre &cCentre = clusterCentres->at(c);
+            double numPxls = (*counts)[c];
+            for(unsigned int f = 0; f < numFeatures; ++f)
+            {
+                // The sums are of the differences to the previous centre.
+                meanDiff = (*diffSums)[(c * numFeatures) + f] / numPxls;
+                if(calcStdDev)
+                {
+                    variance = ((*sqDiffSums)[(c * numFeatures) + f] / numPxls) - (meanDiff * meanDiff);
+                    cCentre.stdDev[f] = (variance > 0)?sqrt(variance):0;
+                }
+                else
+                {
+                    cCentre.stdDev[f] = 0;
+                }
+                cCentre.centre[f] = cCentre.centre[f] + meanDiff;
+            }
+            cCentre.numPxl = (*counts)[c];
+            
+            newClusterIDs[c] = updatedCentres.size();
+            updatedCentres.push_back(cCentre);
+        }
+        
+        if(removed)
+        {
+            *clusterCentres = updatedCentres;
+            for(std::vector<unsigned int>::iterator iterIDs = clusterIDs->begin(); iterIDs != clusterIDs->end(); ++iterIDs)
+            {
+                *iterIDs = newClusterIDs[*iterIDs];
+            }
+        }
+    }
+    
+
+
+    RSGISKMeansClusterer::RSGISKMeansClusterer(InitClustererMethods initCentres)
+    {
+        this->initCentres = initCentres;
+    }
+        
+    std::vector< RSGISClusterCentre >* RSGISKMeansClusterer::calcClusterCentres(std::vector< std::vector<float> > *input, unsigned int numFeatures, unsigned int numClusters, unsigned int maxNumIterations, float degreeOfChange)
+    {
+        std::vector<float> data;
+        this->packSamples(input, numFeatures, &data);
+        return this->calcClusterCentres(data.empty()?NULL:&data[0], input->size(), numFeatures, numClusters, maxNumIterations, degreeOfChange);
+    }
+    
+    std::vector< RSGISClusterCentre >* RSGISKMeansClusterer::calcClusterCentres(const float *data, size_t numSamples, unsigned int numFeatures, unsigned int numClusters, unsigned int maxNumIterations, float degreeOfChange)
+    {
+        if(numSamples == 0)
+        {
+            throw RSGISClustererException("There are no samples to cluster.");
+        }
+        
+        std::vector< RSGISClusterCentre > *clusterCentres = NULL;
+        try 
+        {
+            clusterCentres = this->initializeClusterCentres(this->initCentres, data, numSamples, numFeatures, numClusters, true);
             
-            std::vector< std::pair< unsigned int, std::vector<float> > > *clusterData = this->createClusterDataInitClusterIDs(input, clusterCentres);
+            std::vector<unsigned int> clusterIDs(numSamples, 0);
+            std::vector<double> diffSums;
+            std::vector<double> sqDiffSums;
+            std::vector<size_t> counts;
+            this->assignSamples(data, numSamples, numFeatures, clusterCentres, &clusterIDs, false, &diffSums, &sqDiffSums, &counts);
             
             unsigned int nIter = 0;
-            unsigned int nChange = 0;
+            size_t nChange = 0;
             float amountOfChange = 0;
             
             std::cout << "Starting Iterative processing...\n";
@@ -913,11 +1192,11 @@ namespace rsgis {namespace math{
             {
                 contProcess = false;
                 
-                this->recalcClusterCentres(clusterData, clusterCentres, false);
+                this->updateClusterCentres(numFeatures, clusterCentres, &clusterIDs, false, &diffSums, &sqDiffSums, &counts);
                 
-                nChange = this->reassignClusterIDs(clusterData, clusterCentres);
+                nChange = this->assignSamples(data, numSamples, numFeatures, clusterCentres, &clusterIDs, false, &diffSums, &sqDiffSums, &counts);
                 
-                amountOfChange = ((float)nChange)/clusterData->size();
+                amountOfChange = ((float)nChange)/numSamples;
                 
                 std::cout << "Iteration " << nIter << " has change " << amountOfChange*100 << " % of data clump IDs (" << clusterCentres->size() << " clusters).\n";
                 
@@ -930,6 +1209,10 @@ namespace rsgis {namespace math{
         } 
         catch (RSGISClustererException &e) 
         {
+            if(clusterCentres != NULL)
+            {
+                delete clusterCentres;
+            }
             throw e;
         }
         
@@ -959,67 +1242,31 @@ namespace rsgis {namespace math{
     
     std::vector< RSGISClusterCentre >* RSGISISODataClusterer::calcClusterCentres(std::vector< std::vector<float> > *input, unsigned int numFeatures, unsigned int numClusters, unsigned int maxNumIterations, float degreeOfChange)
     {
+        std::vector<float> data;
+        this->packSamples(input, numFeatures, &data);
+        return this->calcClusterCentres(data.empty()?NULL:&data[0], input->size(), numFeatures, numClusters, maxNumIterations, degreeOfChange);
+    }
+    
+    std::vector< RSGISClusterCentre >* RSGISISODataClusterer::calcClusterCentres(const float *data, size_t numSamples, unsigned int numFeatures, unsigned int numClusters, unsigned int maxNumIterations, float degreeOfChange)
+    {
+        if(numSamples == 0)
+        {
+            throw RSGISClustererException("There are no samples to cluster.");
+        }
+        
         std::vector< RSGISClusterCentre > *clusterCentres = NULL;
         try 
         {
-            float *minVals = new float[numFeatures];
-            float *maxVals = new float[numFeatures];
+            clusterCentres = this->initializeClusterCentres(this->initCentres, data, numSamples, numFeatures, numClusters, false);
             
-            if(this->initCentres == init_random)
-            {
-                //this->calcDataRanges(input, numFeatures, minVals, maxVals);
-                //clusterCentres = this->initializeClusterCentresRandom(numFeatures, minVals, maxVals, numClusters);
-                clusterCentres = this->initializeClusterCentresRandom(input, numFeatures, numClusters);
-            }
-            else if(this->initCentres == init_diagonal_full)
-            {
-                this->calcDataRanges(input, numFeatures, minVals, maxVals);
-                clusterCentres = this->initializeClusterCentresDiagonal(numFeatures, minVals, maxVals, numClusters);
-            }
-            else if(this->initCentres == init_diagonal_stddev)
-            {
-                float *meanVals = new float[numFeatures];
-                float *stddevVals = new float[numFeatures];
-                
-                this->calcDataStats(input, numFeatures, minVals, maxVals, meanVals, stddevVals);
-                clusterCentres = this->initializeClusterCentresDiagonal(numFeatures, minVals, maxVals, numClusters);
-                
-                delete[] meanVals;
-                delete[] stddevVals;
-            }
-            else if(this->initCentres == init_diagonal_full_attach)
-            {
-                this->calcDataRanges(input, numFeatures, minVals, maxVals);
-                clusterCentres = this->initializeClusterCentresDiagonal(input, numFeatures, minVals, maxVals, numClusters);
-            }
-            else if(this->initCentres == init_diagonal_stddev_attach)
-            {
-                float *meanVals = new float[numFeatures];
-                float *stddevVals = new float[numFeatures];
-                
-                this->calcDataStats(input, numFeatures, minVals, maxVals, meanVals, stddevVals);
-                clusterCentres = this->initializeClusterCentresDiagonal(input, numFeatures, minVals, maxVals, meanVals, stddevVals, numClusters);
-                
-                delete[] meanVals;
-                delete[] stddevVals;
-            }
-            else if(this->initCentres == init_kpp)
-            {
-                this->calcDataRanges(input, numFeatures, minVals, maxVals);
-                clusterCentres = this->initializeClusterCentresKPP(input, numFeatures, minVals, maxVals, numClusters);
-            }
-            else
-            {
-                throw RSGISClustererException("Cluster initaliser was now recognised.");
-            }
-            
-            delete[] minVals;
-            delete[] maxVals;
-            
-            std::vector< std::pair< unsigned int, std::vector<float> > > *clusterData = this->createClusterDataInitClusterIDs(input, clusterCentres);
+            std::vector<unsigned int> clusterIDs(numSamples, 0);
+            std::vector<double> diffSums;
+            std::vector<double> sqDiffSums;
+            std::vector<size_t> counts;
+            this->assignSamples(data, numSamples, numFeatures, clusterCentres, &clusterIDs, true, &diffSums, &sqDiffSums, &counts);
             
             unsigned int nIter = 0;
-            unsigned int nChange = 0;
+            size_t nChange = 0;
             float amountOfChange = 0;
             
             std::cout << "Starting Iterative processing...\n";
@@ -1028,16 +1275,16 @@ namespace rsgis {namespace math{
             {
                 contProcess = false;
                 
-                this->recalcClusterCentres(clusterData, clusterCentres, true);
+                this->updateClusterCentres(numFeatures, clusterCentres, &clusterIDs, true, &diffSums, &sqDiffSums, &counts);
                 
                 if((nIter > this->startIteration) & (nIter < this->endIteration))
                 {
                     this->addRemoveClusters(clusterCentres);
                 }                
                 
-                nChange = this->reassignClusterIDs(clusterData, clusterCentres);
+                nChange = this->assignSamples(data, numSamples, numFeatures, clusterCentres, &clusterIDs, true, &diffSums, &sqDiffSums, &counts);
                 
-                amountOfChange = ((float)nChange)/clusterData->size();
+                amountOfChange = ((float)nChange)/numSamples;
                 
                 std::cout << "Iteration " << nIter << " has change " << amountOfChange*100 << " % of data clump IDs for " << clusterCentres->size() << " cluster centres.\n";
                 
@@ -1052,6 +1299,10 @@ namespace rsgis {namespace math{
         } 
         catch (RSGISClustererException &e) 
         {
+            if(clusterCentres != NULL)
+            {
+                delete clusterCentres;
+            }
             throw e;
         }
         
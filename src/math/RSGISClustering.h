@@ -26,6 +26,9 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
+#include <algorithm>
+
+#include "common/RSGISThreadPool.h"
 
 #include "math/RSGISProbabilityDistributions.h"
 #include "math/RSGISRandomDistro.h"
@@ -53,35 +56,78 @@ namespace rsgis {namespace math{
         std::vector<float> stdDev;
     };
     
+    enum InitClustererMethods
+    {
+        init_random,
+        init_diagonal_full,
+        init_diagonal_stddev,
+        init_diagonal_full_attach,
+        init_diagonal_stddev_attach,
+        init_kpp
+    };
+    
+    /**
+     * The clusterers work on a contiguous row-major matrix of samples (numSamples x
+     * numFeatures) so samples are not allocated individually. The interface taking
+     * a vector of samples copies them into a matrix and calls the matrix interface.
+     */
     class DllExport RSGISClusterer
 	{
 	public:
-		RSGISClusterer(){};
+		RSGISClusterer(){this->numThreads = 1;};
+        /** Set the number of threads used to assign the samples to clusters (0 uses all the available cores). */
+        void setNumThreads(unsigned int numThreads){this->numThreads = numThreads;};
         virtual std::vector< RSGISClusterCentre >* calcClusterCentres(std::vector< std::vector<float> > *input, unsigned int numFeatures, unsigned int numClusters, unsigned int maxNumIterations, float degreeOfChange) = 0;
+        virtual std::vector< RSGISClusterCentre >* calcClusterCentres(const float *data, size_t numSamples, unsigned int numFeatures, unsigned int numClusters, unsigned int maxNumIterations, float degreeOfChange) = 0;
+        /** Copy the samples into a row-major matrix (numSamples x numFeatures). */
+        void packSamples(std::vector< std::vector<float> > *input, unsigned int numFeatures, std::vector<float> *data);
         void calcDataRanges(std::vector< std::vector<float> > *input, unsigned int numFeatures, float *min, float *max);
+        void calcDataRanges(const float *data, size_t numSamples, unsigned int numFeatures, float *min, float *max);
         void calcDataStats(std::vector< std::vector<float> > *input, unsigned int numFeatures, float *min, float *max, float *mean, float *stddev);
+        void calcDataStats(const float *data, size_t numSamples, unsigned int numFeatures, float *min, float *max, float *mean, float *stddev);
         std::vector< RSGISClusterCentre >* initializeClusterCentresRandom(unsigned int numFeatures, float *min, float *max, unsigned int numClusters);
         std::vector< RSGISClusterCentre >* initializeClusterCentresRandom(std::vector< std::vector<float> > *input, unsigned int numFeatures, unsigned int numClusters);
+        std::vector< RSGISClusterCentre >* initializeClusterCentresRandom(const float *data, size_t numSamples, unsigned int numFeatures, unsigned int numClusters);
         std::vector< RSGISClusterCentre >* initializeClusterCentresDiagonal(unsigned int numFeatures, float *min, float *max, unsigned int numClusters);
         std::vector< RSGISClusterCentre >* initializeClusterCentresDiagonal(unsigned int numFeatures, float *min, float *max, float *mean, float *stddev, unsigned int numClusters);
         std::vector< RSGISClusterCentre >* initializeClusterCentresDiagonal(std::vector< std::vector<float> > *input, unsigned int numFeatures, float *min, float *max, unsigned int numClusters);
+        std::vector< RSGISClusterCentre >* initializeClusterCentresDiagonal(const float *data, size_t numSamples, unsigned int numFeatures, float *min, float *max, unsigned int numClusters);
         std::vector< RSGISClusterCentre >* initializeClusterCentresDiagonal(std::vector< std::vector<float> > *input, unsigned int numFeatures, float *min, float *max, float *mean, float *stddev, unsigned int numClusters);
+        std::vector< RSGISClusterCentre >* initializeClusterCentresDiagonal(const float *data, size_t numSamples, unsigned int numFeatures, float *min, float *max, float *mean, float *stddev, unsigned int numClusters);
         std::vector< RSGISClusterCentre >* initializeClusterCentresKPP(std::vector< std::vector<float> > *input, unsigned int numFeatures, float *min, float *max, unsigned int numClusters);
         
         std::vector< std::pair< unsigned int, std::vector<float> > >* createClusterDataInitClusterIDs(std::vector< std::vector<float> > *input, std::vector< RSGISClusterCentre > *clusterCentres);
         unsigned int reassignClusterIDs( std::vector< std::pair< unsigned int, std::vector<float> > > *clusterData, std::vector< RSGISClusterCentre > *clusterCentres);
         void recalcClusterCentres( std::vector< std::pair< unsigned int, std::vector<float> > > *clusterData, std::vector< RSGISClusterCentre > *clusterCentres, bool calcStdDev);
         void assign2ClosestDataPoint(RSGISClusterCentre *cc, std::vector< std::vector<float> > *input, unsigned int numFeatures, std::vector< RSGISClusterCentre > *used);
+        void assign2ClosestDataPoint(RSGISClusterCentre *cc, const float *data, size_t numSamples, unsigned int numFeatures, std::vector< RSGISClusterCentre > *used);
         
-        ~RSGISClusterer(){};
+        virtual ~RSGISClusterer(){};
     protected:
-        double calcEucDistance(std::vector<float> d1, std::vector<float> d2)
+        std::vector< RSGISClusterCentre >* initializeClusterCentres(InitClustererMethods initCentres, const float *data, size_t numSamples, unsigned int numFeatures, unsigned int numClusters, bool useStdDevDiagonal);
+        /**
+         * Assign each sample to its closest cluster centre (on numThreads threads) and
+         * sum the differences (and, if calcStdDev, the squared differences) of the
+         * samples to the centre they are assigned to. Returns the number of samples
+         * for which the cluster ID changed.
+         */
+        size_t assignSamples(const float *data, size_t numSamples, unsigned int numFeatures, std::vector< RSGISClusterCentre > *clusterCentres, std::vector<unsigned int> *clusterIDs, bool calcStdDev, std::vector<double> *diffSums, std::vector<double> *sqDiffSums, std::vector<size_t> *counts);
+        /**
+         * Update the cluster centres (and standard deviations) from the sums of the
+         * last assignment. Empty clusters are removed and the cluster IDs renumbered.
+         */
+        void updateClusterCentres(unsigned int numFeatures, std::vector< RSGISClusterCentre > *clusterCentres, std::vector<unsigned int> *clusterIDs, bool calcStdDev, std::vector<double> *diffSums, std::vector<double> *sqDiffSums, std::vector<size_t> *counts);
+        double calcEucDistance(const std::vector<float> &d1, const std::vector<float> &d2)
         {
             unsigned int numVals = d1.size(); 
             if(numVals != d2.size())
             {
                 throw RSGISClustererException("Cannot calculate Euclidean distance for vectors of different length.");
             }
+            return this->calcEucDistance(&d1[0], &d2[0], numVals);
+        };
+        double calcEucDistance(const float *d1, const float *d2, unsigned int numVals)
+        {
             double dist = 0;
             for(unsigned int i = 0; i < numVals; ++i)
             {
@@ -95,23 +141,16 @@ namespace rsgis {namespace math{
             
             return dist;
         };
+        unsigned int numThreads;
 	};
     
-    enum InitClustererMethods
-    {
-        init_random,
-        init_diagonal_full,
-        init_diagonal_stddev,
-        init_diagonal_full_attach,
-        init_diagonal_stddev_attach,
-        init_kpp
-    };
     
     class DllExport RSGISKMeansClusterer: public RSGISClusterer
     {
     public:
 		RSGISKMeansClusterer(InitClustererMethods initCentres);
         std::vector< RSGISClusterCentre >* calcClusterCentres(std::vector< std::vector<float> > *input, unsigned int numFeatures, unsigned int numClusters, unsigned int maxNumIterations, float degreeOfChange);
+        std::vector< RSGISClusterCentre >* calcClusterCentres(const float *data, size_t numSamples, unsigned int numFeatures, unsigned int numClusters, unsigned int maxNumIterations, float degreeOfChange);
 		~RSGISKMeansClusterer();
     private:
         InitClustererMethods initCentres;
@@ -122,6 +161,7 @@ namespace rsgis {namespace math{
     public:
 		RSGISISODataClusterer(InitClustererMethods initCentres, float minDistBetweenClusters, unsigned int minNumFeatures, float maxStdDev, unsigned int minNumClusters, unsigned int startIteration, unsigned int endIteration);
         std::vector< RSGISClusterCentre >* calcClusterCentres(std::vector< std::vector<float> > *input, unsigned int numFeatures, unsigned int numClusters, unsigned int maxNumIterations, float degreeOfChange);
+        std::vector< RSGISClusterCentre >* calcClusterCentres(const float *data, size_t numSamples, unsigned int numFeatures, unsigned int numClusters, unsigned int maxNumIterations, float degreeOfChange);
 		void addRemoveClusters(std::vector< RSGISClusterCentre > *clusterCentres);
         ~RSGISISODataClusterer();
     private:
@@ -0,0 +1,344 @@
+/*
+ *  RSGISDenseMatrix.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISDenseMatrix.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <new>
+
+#ifdef _MSC_VER
+    #include <malloc.h>
+#endif
+
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_linalg.h>
+#include <gsl/gsl_permutation.h>
+#include <gsl/gsl_eigen.h>
+
+namespace rsgis{namespace math{
+
+    RSGISDenseMatrix::RSGISDenseMatrix(): vals(nullptr), nRows(0), nCols(0)
+    {
+
+    }
+
+    RSGISDenseMatrix::RSGISDenseMatrix(size_t nRows, size_t nCols, double val): vals(nullptr), nRows(nRows), nCols(nCols)
+    {
+        this->vals = RSGISDenseMatrix::allocAligned(this->size());
+        this->fill(val);
+    }
+
+    RSGISDenseMatrix::RSGISDenseMatrix(const RSGISDenseMatrix &other): vals(nullptr), nRows(other.nRows), nCols(other.nCols)
+    {
+        this->vals = RSGISDenseMatrix::allocAligned(this->size());
+        if(!this->empty())
+        {
+            std::memcpy(this->vals, other.vals, this->size() * sizeof(double));
+        }
+    }
+
+    RSGISDenseMatrix::RSGISDenseMatrix(RSGISDenseMatrix &&other) noexcept: vals(other.vals), nRows(other.nRows), nCols(other.nCols)
+    {
+        other.vals = nullptr;
+        other.nRows = 0;
+        other.nCols = 0;
+    }
+
+    RSGISDenseMatrix& RSGISDenseMatrix::operator=(const RSGISDenseMatrix &other)
+    {
+        if(this != &other)
+        {
+            RSGISDenseMatrix tmp(other);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    RSGISDenseMatrix& RSGISDenseMatrix::operator=(RSGISDenseMatrix &&other) noexcept
+    {
+        if(this != &other)
+        {
+            RSGISDenseMatrix::freeAligned(this->vals);
+            this->vals = other.vals;
+            this->nRows = other.nRows;
+            this->nCols = other.nCols;
+            other.vals = nullptr;
+            other.nRows = 0;
+            other.nCols = 0;
+        }
+        return *this;
+    }
+
+    RSGISDenseMatrix RSGISDenseMatrix::fromGSLMatrix(const gsl_matrix *matrix)
+    {
+        if(matrix == nullptr)
+        {
+            throw RSGISMatricesException("The gsl_matrix to be copied is NULL.");
+        }
+        RSGISDenseMatrix outMatrix(matrix->size1, matrix->size2);
+        for(size_t i = 0; i < matrix->size1; ++i)
+        {
+            std::memcpy(outMatrix.row(i), matrix->data + (i * matrix->tda), matrix->size2 * sizeof(double));
+        }
+        return outMatrix;
+    }
+
+    RSGISDenseMatrix RSGISDenseMatrix::fromMatrix(const Matrix *matrix)
+    {
+        if((matrix == nullptr) || (matrix->matrix == nullptr))
+        {
+            throw RSGISMatricesException("The matrix to be copied is NULL.");
+        }
+        if((matrix->n < 1) || (matrix->m < 1))
+        {
+            throw RSGISMatricesException("Sizes of m and n must be at least 1.");
+        }
+        RSGISDenseMatrix outMatrix(matrix->n, matrix->m);
+        std::memcpy(outMatrix.vals, matrix->matrix, outMatrix.size() * sizeof(double));
+        return outMatrix;
+    }
+
+    Matrix* RSGISDenseMatrix::toMatrix() const
+    {
+        RSGISMatrices matrixUtils;
+        Matrix *outMatrix = matrixUtils.createMatrix(this->nRows, this->nCols);
+        std::memcpy(outMatrix->matrix, this->vals, this->size() * sizeof(double));
+        return outMatrix;
+    }
+
+    gsl_matrix_view RSGISDenseMatrix::gslView()
+    {
+        if(this->empty())
+        {
+            throw RSGISMatricesException("A gsl_matrix view cannot be created for an empty matrix.");
+        }
+        return gsl_matrix_view_array(this->vals, this->nRows, this->nCols);
+    }
+
+    gsl_matrix_const_view RSGISDenseMatrix::gslConstView() const
+    {
+        if(this->empty())
+        {
+            throw RSGISMatricesException("A gsl_matrix view cannot be created for an empty matrix.");
+        }
+        return gsl_matrix_const_view_array(this->vals, this->nRows, this->nCols);
+    }
+
+    void RSGISDenseMatrix::fill(double val)
+    {
+        double *end = this->vals + this->size();
+        for(double *v = this->vals; v < end; ++v)
+        {
+            *v = val;
+        }
+    }
+
+    RSGISDenseMatrix RSGISDenseMatrix::transpose() const
+    {
+        RSGISDenseMatrix outMatrix(this->nCols, this->nRows);
+        // Blocked so both the reads and the writes stay within a few cache lines.
+        const size_t blockSize = 32;
+        for(size_t r0 = 0; r0 < this->nRows; r0 += blockSize)
+        {
+            size_t r1 = std::min(r0 + blockSize, this->nRows);
+            for(size_t c0 = 0; c0 < this->nCols; c0 += blockSize)
+            {
+                size_t c1 = std::min(c0 + blockSize, this->nCols);
+                for(size_t r = r0; r < r1; ++r)
+                {
+                    const double *inRow = this->row(r);
+                    for(size_t c = c0; c < c1; ++c)
+                    {
+                        outMatrix.vals[(c * this->nRows) + r] = inRow[c];
+                    }
+                }
+            }
+        }
+        return outMatrix;
+    }
+
+    RSGISDenseMatrix RSGISDenseMatrix::multiply(const RSGISDenseMatrix &a, const RSGISDenseMatrix &b, bool transA, bool transB)
+    {
+        size_t aRows = transA?a.nCols:a.nRows;
+        size_t aCols = transA?a.nRows:a.nCols;
+        size_t bRows = transB?b.nCols:b.nRows;
+        size_t bCols = transB?b.nRows:b.nCols;
+        if(aCols != bRows)
+        {
+            throw RSGISMatricesException("Multipication required the number of columns to match the number of rows.");
+        }
+
+        RSGISDenseMatrix outMatrix(aRows, bCols);
+        if(outMatrix.empty() || (aCols == 0))
+        {
+            return outMatrix;
+        }
+
+        gsl_matrix_const_view aView = a.gslConstView();
+        gsl_matrix_const_view bView = b.gslConstView();
+        gsl_matrix_view cView = outMatrix.gslView();
+        gsl_blas_dgemm(transA?CblasTrans:CblasNoTrans, transB?CblasTrans:CblasNoTrans, 1.0, &aView.matrix, &bView.matrix, 0.0, &cView.matrix);
+        return outMatrix;
+    }
+
+    void RSGISDenseMatrix::multiplyVector(const double *x, double *y, bool trans) const
+    {
+        size_t outLen = trans?this->nCols:this->nRows;
+        size_t inLen = trans?this->nRows:this->nCols;
+        if(outLen == 0)
+        {
+            return;
+        }
+        if(inLen == 0)
+        {
+            std::memset(y, 0, outLen * sizeof(double));
+            return;
+        }
+
+        gsl_matrix_const_view aView = this->gslConstView();
+        gsl_vector_const_view xView = gsl_vector_const_view_array(x, inLen);
+        gsl_vector_view yView = gsl_vector_view_array(y, outLen);
+        gsl_blas_dgemv(trans?CblasTrans:CblasNoTrans, 1.0, &aView.matrix, &xView.vector, 0.0, &yView.vector);
+    }
+
+    RSGISDenseMatrix RSGISDenseMatrix::solve(const RSGISDenseMatrix &b) const
+    {
+        if(this->nRows != this->nCols)
+        {
+            throw RSGISMatricesException("To solve a linear system the matrix needs to be square.");
+        }
+        if(b.nRows != this->nRows)
+        {
+            throw RSGISMatricesException("The right hand side needs the same number of rows as the matrix.");
+        }
+        if(this->empty())
+        {
+            throw RSGISMatricesException("A linear system cannot be solved for an empty matrix.");
+        }
+
+        RSGISDenseMatrix lu(*this);
+        RSGISDenseMatrix x(b);
+        gsl_matrix_view luView = lu.gslView();
+        gsl_permutation *perm = gsl_permutation_alloc(this->nRows);
+        int signum = 0;
+        gsl_linalg_LU_decomp(&luView.matrix, perm, &signum);
+
+        // GSL reports a singular system through its error handler, which aborts by default.
+        for(size_t i = 0; i < this->nRows; ++i)
+        {
+            if(lu(i, i) == 0.0)
+            {
+                gsl_permutation_free(perm);
+                throw RSGISMatricesException("The matrix is singular so the linear system cannot be solved.");
+            }
+        }
+
+        if(!x.empty())
+        {
+            gsl_matrix_view xView = x.gslView();
+            for(size_t j = 0; j < x.nCols; ++j)
+            {
+                gsl_vector_view col = gsl_matrix_column(&xView.matrix, j);
+                gsl_linalg_LU_svx(&luView.matrix, perm, &col.vector);
+            }
+        }
+        gsl_permutation_free(perm);
+        return x;
+    }
+
+    void RSGISDenseMatrix::symmetricEigen(std::vector<double> *eigenvalues, RSGISDenseMatrix *eigenvectors) const
+    {
+        if(this->nRows != this->nCols)
+        {
+            throw RSGISMatricesException("The eigen decomposition of a symmetric matrix needs a square matrix.");
+        }
+        if(this->empty())
+        {
+            throw RSGISMatricesException("The eigen decomposition cannot be calculated for an empty matrix.");
+        }
+
+        // gsl_eigen_symmv destroys its input so work on a copy.
+        RSGISDenseMatrix work(*this);
+        if((eigenvectors->nRows != this->nRows) || (eigenvectors->nCols != this->nRows))
+        {
+            *eigenvectors = RSGISDenseMatrix(this->nRows, this->nRows);
+        }
+        gsl_matrix_view workView = work.gslView();
+        gsl_matrix_view eigenVecsView = eigenvectors->gslView();
+        gsl_vector *eigenValsGSL = gsl_vector_alloc(this->nRows);
+
+        gsl_eigen_symmv_workspace *workspace = gsl_eigen_symmv_alloc(this->nRows);
+        gsl_eigen_symmv(&workView.matrix, eigenValsGSL, &eigenVecsView.matrix, workspace);
+        gsl_eigen_symmv_free(workspace);
+        gsl_eigen_symmv_sort(eigenValsGSL, &eigenVecsView.matrix, GSL_EIGEN_SORT_ABS_DESC);
+
+        eigenvalues->resize(this->nRows);
+        for(size_t i = 0; i < this->nRows; ++i)
+        {
+            eigenvalues->at(i) = gsl_vector_get(eigenValsGSL, i);
+        }
+        gsl_vector_free(eigenValsGSL);
+    }
+
+    double* RSGISDenseMatrix::allocAligned(size_t nVals)
+    {
+        if(nVals == 0)
+        {
+            return nullptr;
+        }
+        void *ptr = nullptr;
+#ifdef _MSC_VER
+        ptr = _aligned_malloc(nVals * sizeof(double), RSGIS_DENSE_MATRIX_ALIGN);
+#else
+        if(posix_memalign(&ptr, RSGIS_DENSE_MATRIX_ALIGN, nVals * sizeof(double)) != 0)
+        {
+            ptr = nullptr;
+        }
+#endif
+        if(ptr == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<double*>(ptr);
+    }
+
+    void RSGISDenseMatrix::freeAligned(double *ptr)
+    {
+        if(ptr != nullptr)
+        {
+#ifdef _MSC_VER
+            _aligned_free(ptr);
+#else
+            std::free(ptr);
+#endif
+        }
+    }
+
+    RSGISDenseMatrix::~RSGISDenseMatrix()
+    {
+        RSGISDenseMatrix::freeAligned(this->vals);
+    }
+
+}}
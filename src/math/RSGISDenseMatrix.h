@@ -0,0 +1,124 @@
+/*
+ *  RSGISDenseMatrix.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISDenseMatrix_H
+#define RSGISDenseMatrix_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+
+#include "math/RSGISMatrices.h"
+#include "math/RSGISMatricesException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_maths_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace math{
+
+    /** Byte alignment of the RSGISDenseMatrix storage (a cache line and an AVX-512 register). */
+    static const size_t RSGIS_DENSE_MATRIX_ALIGN(64);
+
+    /**
+     * A contiguous, row-major, aligned matrix of doubles. The products, solves and
+     * eigen decompositions are computed with the (C)BLAS and linear algebra
+     * routines of GSL, so linking an optimised CBLAS (see GSL_CBLAS_LIB in the
+     * CMake configuration) in place of gslcblas speeds up every caller.
+     *
+     * gslView() and gslConstView() wrap the storage as a gsl_matrix without a copy
+     * so the matrix can be passed directly to the existing gsl_matrix functions.
+     */
+    class DllExport RSGISDenseMatrix
+    {
+    public:
+        RSGISDenseMatrix();
+        RSGISDenseMatrix(size_t nRows, size_t nCols, double val=0.0);
+        RSGISDenseMatrix(const RSGISDenseMatrix &other);
+        RSGISDenseMatrix(RSGISDenseMatrix &&other) noexcept;
+        RSGISDenseMatrix& operator=(const RSGISDenseMatrix &other);
+        RSGISDenseMatrix& operator=(RSGISDenseMatrix &&other) noexcept;
+
+        /** Copy a gsl_matrix (any tda) into a new dense matrix. */
+        static RSGISDenseMatrix fromGSLMatrix(const gsl_matrix *matrix);
+        /** Copy a Matrix created by RSGISMatrices::createMatrix (n rows, m columns). */
+        static RSGISDenseMatrix fromMatrix(const Matrix *matrix);
+        /** Return a new Matrix (n = rows, m = columns) which must be freed with RSGISMatrices::freeMatrix. */
+        Matrix* toMatrix() const;
+
+        size_t rows() const {return this->nRows;};
+        size_t cols() const {return this->nCols;};
+        size_t size() const {return this->nRows * this->nCols;};
+        bool empty() const {return this->size() == 0;};
+        double* data() {return this->vals;};
+        const double* data() const {return this->vals;};
+        double* row(size_t r) {return this->vals + (r * this->nCols);};
+        const double* row(size_t r) const {return this->vals + (r * this->nCols);};
+        double& operator()(size_t r, size_t c) {return this->vals[(r * this->nCols) + c];};
+        double operator()(size_t r, size_t c) const {return this->vals[(r * this->nCols) + c];};
+
+        /** Zero-copy views of the storage; the matrix must not be empty. */
+        gsl_matrix_view gslView();
+        gsl_matrix_const_view gslConstView() const;
+
+        void fill(double val);
+        RSGISDenseMatrix transpose() const;
+
+        /** C = op(A) op(B), where op() optionally transposes its argument (BLAS dgemm). */
+        static RSGISDenseMatrix multiply(const RSGISDenseMatrix &a, const RSGISDenseMatrix &b, bool transA=false, bool transB=false);
+        /** y = op(A) x (BLAS dgemv); x and y must not overlap. */
+        void multiplyVector(const double *x, double *y, bool trans=false) const;
+        /** Solve A X = B for a square A using an LU decomposition with partial pivoting. */
+        RSGISDenseMatrix solve(const RSGISDenseMatrix &b) const;
+        /**
+         * Eigen decomposition of a symmetric matrix, sorted by descending absolute
+         * eigenvalue. Column i of eigenvectors is the vector for eigenvalue i. The
+         * matrix itself is left unchanged.
+         */
+        void symmetricEigen(std::vector<double> *eigenvalues, RSGISDenseMatrix *eigenvectors) const;
+
+        ~RSGISDenseMatrix();
+    protected:
+        static double* allocAligned(size_t nVals);
+        static void freeAligned(double *ptr);
+        double *vals;
+        size_t nRows;
+        size_t nCols;
+    };
+
+}}
+
+#endif
+
@@ -194,6 +194,44 @@ namespace rsgis{namespace math{
         return dist;
     }
     
+    bool RSGISCalcMahalanobisDistMetric::calcWhiteningTransform(double **transform)
+    {
+        if(!this->initalised)
+        {
+            throw RSGISMathException("The metric calulator was not initialised.");
+        }
+        
+        // The distance only depends on the symmetric part of the inverse.
+        gsl_matrix *cholMatrix = gsl_matrix_alloc(n, n);
+        for(size_t i = 0; i < n; ++i)
+        {
+            for(size_t j = 0; j < n; ++j)
+            {
+                gsl_matrix_set(cholMatrix, i, j, (gsl_matrix_get(this->invCovarianceMatrix, i, j) + gsl_matrix_get(this->invCovarianceMatrix, j, i))/2);
+            }
+        }
+        
+        gsl_error_handler_t *errHandler = gsl_set_error_handler_off();
+        int status = gsl_linalg_cholesky_decomp(cholMatrix);
+        gsl_set_error_handler(errHandler);
+        
+        bool valid = (status == GSL_SUCCESS);
+        for(size_t i = 0; (i < n) && valid; ++i)
+        {
+            for(size_t j = 0; j < n; ++j)
+            {
+                // The lower triangle holds L where inverse = L L^T; the transform is L^T.
+                transform[i][j] = (j >= i)?gsl_matrix_get(cholMatrix, j, i):0.0;
+                if(!std::isfinite(transform[i][j]))
+                {
+                    valid = false;
+                }
+            }
+        }
+        gsl_matrix_free(cholMatrix);
+        return valid;
+    }
+    
     RSGISCalcMahalanobisDistMetric::~RSGISCalcMahalanobisDistMetric()
     {
         for(size_t i = 0; i < n; ++i)
@@ -36,9 +36,10 @@
 #include <gsl/gsl_vector.h>
 #include <gsl/gsl_linalg.h>
 #include <gsl/gsl_blas.h>
+#include <gsl/gsl_errno.h>
 
 // mark all exported classes/functions with DllExport to have
-// them exported by Visual Studio
+// them exported by Visual Studio
 #undef DllExport
 #ifdef _MSC_VER
     #ifdef rsgis_maths_EXPORTS
@@ -89,6 +90,12 @@ namespace rsgis{namespace math{
         RSGISCalcMahalanobisDistMetric(double **covarMatrixm, size_t n);
         virtual void init();
         virtual double calcDist(double *vals1, size_t sIdx1, size_t eIdx1, double *vals2, size_t sIdx2, size_t eIdx2);
+        /**
+         * Calculate the n x n transform T (the transpose of the Cholesky factor of the
+         * inverse covariance matrix) for which the distance is |T(vals1 - vals2)|.
+         * Returns false if the inverse covariance matrix is not positive definite.
+         */
+        bool calcWhiteningTransform(double **transform);
         virtual ~RSGISCalcMahalanobisDistMetric();
     protected:
         double **covarMatrix;
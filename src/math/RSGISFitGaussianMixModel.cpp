@@ -365,4 +365,412 @@ namespace rsgis{namespace math{
     }
     
     
+    RSGISFitGaussianMixModelEM::RSGISFitGaussianMixModelEM(unsigned int numThreads)
+    {
+        this->numThreads = numThreads;
+    }
+    
+    std::vector<GaussianMixComponent> RSGISFitGaussianMixModelEM::performFit(const double *data, size_t numPts, unsigned int numDims, unsigned int numComps, const double *ptWeights, unsigned int maxIters, double llTol, double minVar, unsigned int seed, double *logLikelihood, unsigned int *numIters)
+    {
+        std::vector<GaussianMixComponent> comps;
+        try
+        {
+            if((numDims == 0) || (numComps == 0))
+            {
+                throw RSGISMathException("RSGISFitGaussianMixModelEM: The number of dimensions and components must be at least 1.");
+            }
+            if(numPts < numComps)
+            {
+                throw RSGISMathException("RSGISFitGaussianMixModelEM: There must be at least as many samples as components.");
+            }
+            
+            this->initComponents(data, numPts, numDims, numComps, ptWeights, minVar, seed, &comps);
+            
+            double totalWeight = 0.0;
+            for(size_t i = 0; i < numPts; ++i)
+            {
+                totalWeight += (ptWeights == NULL)?1.0:ptWeights[i];
+            }
+            
+            // Per block sums of the responsibilities (r), r(x - mean) and r(x - mean)(x - mean)^T
+            // about the current means, allocated once for all the iterations.
+            size_t compStatsSize = 1 + numDims + (numDims * numDims);
+            size_t statsSize = numComps * compStatsSize;
+            size_t numBlocks = (numPts + RSGIS_GMM_EM_BLOCK_PTS - 1) / RSGIS_GMM_EM_BLOCK_PTS;
+            std::vector<double> blockStats(numBlocks * statsSize);
+            std::vector<double> blockLL(numBlocks);
+            std::vector<double> stats(statsSize);
+            
+            rsgis::RSGISThreadPool threadPool(this->numThreads);
+            unsigned int nThreads = threadPool.getNumThreads();
+            std::vector<std::vector<double> > threadDiff(nThreads, std::vector<double>(numComps * numDims));
+            std::vector<std::vector<double> > threadZ(nThreads, std::vector<double>(numDims));
+            std::vector<std::vector<double> > threadLogP(nThreads, std::vector<double>(numComps));
+            
+            std::vector<std::vector<double> > compChol(numComps);
+            std::vector<double> compLogNorm(numComps);
+            const double log2Pi = log(2.0 * M_PI);
+            
+            double prevLL = 0.0;
+            double ll = 0.0;
+            unsigned int iter = 0;
+            bool converged = false;
+            while((iter < maxIters) && (!converged))
+            {
+                for(unsigned int k = 0; k < numComps; ++k)
+                {
+                    compChol[k] = comps[k].covariance;
+                    if(comps[k].weight <= 0)
+                    {
+                        compLogNorm[k] = -std::numeric_limits<double>::infinity();
+                        continue;
+                    }
+                    if(!this->choleskyDecomp(&compChol[k], numDims))
+                    {
+                        throw RSGISMathException("RSGISFitGaussianMixModelEM: A covariance matrix is not positive definite; try increasing the minimum variance.");
+                    }
+                    double logDet = 0.0;
+                    for(unsigned int d = 0; d < numDims; ++d)
+                    {
+                        logDet += 2.0 * log(compChol[k][(d * numDims) + d]);
+                    }
+                    compLogNorm[k] = log(comps[k].weight) - (0.5 * ((numDims * log2Pi) + logDet));
+                }
+                
+                // E-step, accumulating the statistics for the M-step.
+                threadPool.parallelFor(0, numBlocks, [&](unsigned int threadIdx, size_t sBlock, size_t eBlock)
+                {
+                    double *diff = threadDiff[threadIdx].data();
+                    double *z = threadZ[threadIdx].data();
+                    double *logP = threadLogP[threadIdx].data();
+                    for(size_t b = sBlock; b < eBlock; ++b)
+                    {
+                        double *bStats = &blockStats[b * statsSize];
+                        std::fill(bStats, bStats + statsSize, 0.0);
+                        double bLL = 0.0;
+                        size_t ePt = std::min(numPts, (b + 1) * RSGIS_GMM_EM_BLOCK_PTS);
+                        for(size_t i = b * RSGIS_GMM_EM_BLOCK_PTS; i < ePt; ++i)
+                        {
+                            double ptWeight = (ptWeights == NULL)?1.0:ptWeights[i];
+                            if(ptWeight == 0)
+                            {
+                                continue;
+                            }
+                            const double *pt = data + (i * numDims);
+                            
+                            // log(w_k N(x | mean_k, cov_k)) using the Cholesky factor (L) of cov_k.
+                            double maxLogP = -std::numeric_limits<double>::infinity();
+                            for(unsigned int k = 0; k < numComps; ++k)
+                            {
+                                logP[k] = compLogNorm[k];
+                                if(comps[k].weight <= 0)
+                                {
+                                    continue;
+                                }
+                                const double *chol = compChol[k].data();
+                                double *kDiff = diff + (k * numDims);
+                                double maha = 0.0;
+                                for(unsigned int d = 0; d < numDims; ++d)
+                                {
+                                    kDiff[d] = pt[d] - comps[k].mean[d];
+                                    double val = kDiff[d];
+                                    for(unsigned int e = 0; e < d; ++e)
+                                    {
+                                        val -= chol[(d * numDims) + e] * z[e];
+                                    }
+                                    z[d] = val / chol[(d * numDims) + d];
+                                    maha += z[d] * z[d];
+                                }
+                                logP[k] -= 0.5 * maha;
+                                if(logP[k] > maxLogP)
+                                {
+                                    maxLogP = logP[k];
+                                }
+                            }
+                            
+                            double sumP = 0.0;
+                            for(unsigned int k = 0; k < numComps; ++k)
+                            {
+                                sumP += exp(logP[k] - maxLogP);
+                            }
+                            double logSumP = maxLogP + log(sumP);
+                            bLL += ptWeight * logSumP;
+                            
+                            for(unsigned int k = 0; k < numComps; ++k)
+                            {
+                                double resp = ptWeight * exp(logP[k] - logSumP);
+                                if(resp == 0)
+                                {
+                                    continue;
+                                }
+                                const double *kDiff = diff + (k * numDims);
+                                double *kStats = bStats + (k * compStatsSize);
+                                double *kSum = kStats + 1;
+                                double *kSqSum = kStats + 1 + numDims;
+                                kStats[0] += resp;
+                                for(unsigned int d = 0; d < numDims; ++d)
+                                {
+                                    double rDiff = resp * kDiff[d];
+                                    kSum[d] += rDiff;
+                                    for(unsigned int e = d; e < numDims; ++e)
+                                    {
+                                        kSqSum[(d * numDims) + e] += rDiff * kDiff[e];
+                                    }
+                                }
+                            }
+                        }
+                        blockLL[b] = bLL;
+                    }
+                });
+                
+                // Merge the blocks in order, so the sums do not depend on the number of threads.
+                std::fill(stats.begin(), stats.end(), 0.0);
+                ll = 0.0;
+                for(size_t b = 0; b < numBlocks; ++b)
+                {
+                    const double *bStats = &blockStats[b * statsSize];
+                    for(size_t j = 0; j < statsSize; ++j)
+                    {
+                        stats[j] += bStats[j];
+                    }
+                    ll += blockLL[b];
+                }
+                if(!std::isfinite(ll))
+                {
+                    throw RSGISMathException("RSGISFitGaussianMixModelEM: The log-likelihood is not finite; check the samples are finite.");
+                }
+                
+                // M-step.
+                for(unsigned int k = 0; k < numComps; ++k)
+                {
+                    const double *kStats = &stats[k * compStatsSize];
+                    const double *kSum = kStats + 1;
+                    const double *kSqSum = kStats + 1 + numDims;
+                    if(kStats[0] <= (totalWeight * 1e-12))
+                    {
+                        // The component no longer has any samples.
+                        comps[k].weight = 0.0;
+                        continue;
+                    }
+                    comps[k].weight = kStats[0] / totalWeight;
+                    std::vector<double> shift(numDims);
+                    for(unsigned int d = 0; d < numDims; ++d)
+                    {
+                        shift[d] = kSum[d] / kStats[0];
+                    }
+                    for(unsigned int d = 0; d < numDims; ++d)
+                    {
+                        for(unsigned int e = d; e < numDims; ++e)
+                        {
+                            double cov = (kSqSum[(d * numDims) + e] / kStats[0]) - (shift[d] * shift[e]);
+                            if(d == e)
+                            {
+                                cov += minVar;
+                            }
+                            comps[k].covariance[(d * numDims) + e] = cov;
+                            comps[k].covariance[(e * numDims) + d] = cov;
+                        }
+                        comps[k].mean[d] += shift[d];
+                    }
+                }
+                
+                ++iter;
+                if((iter > 1) && (fabs(ll - prevLL) <= (llTol * fabs(ll))))
+                {
+                    converged = true;
+                }
+                prevLL = ll;
+            }
+            
+            if(logLikelihood != NULL)
+            {
+                *logLikelihood = ll;
+            }
+            if(numIters != NULL)
+            {
+                *numIters = iter;
+            }
+        }
+        catch (RSGISMathException &e)
+        {
+            throw e;
+        }
+        catch(RSGISException &e)
+        {
+            throw RSGISMathException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISMathException(e.what());
+        }
+        return comps;
+    }
+    
+    std::vector<GaussianMixComponent> RSGISFitGaussianMixModelEM::performHistFit(std::vector<std::pair<double, double> > *hist, unsigned int numComps, unsigned int maxIters, double llTol, double minVar, unsigned int seed)
+    {
+        std::vector<double> binVals(hist->size());
+        std::vector<double> binFreqs(hist->size());
+        for(size_t i = 0; i < hist->size(); ++i)
+        {
+            binVals[i] = hist->at(i).first;
+            binFreqs[i] = hist->at(i).second;
+        }
+        return this->performFit(binVals.data(), binVals.size(), 1, numComps, binFreqs.data(), maxIters, llTol, minVar, seed);
+    }
+    
+    void RSGISFitGaussianMixModelEM::initComponents(const double *data, size_t numPts, unsigned int numDims, unsigned int numComps, const double *ptWeights, double minVar, unsigned int seed, std::vector<GaussianMixComponent> *comps)
+    {
+        // The weighted mean and covariance of all the samples are used for each component.
+        double totalWeight = 0.0;
+        std::vector<double> mean(numDims, 0.0);
+        for(size_t i = 0; i < numPts; ++i)
+        {
+            double ptWeight = (ptWeights == NULL)?1.0:ptWeights[i];
+            if(!(ptWeight >= 0) || !std::isfinite(ptWeight))
+            {
+                throw RSGISMathException("RSGISFitGaussianMixModelEM: The sample weights must be finite and not negative.");
+            }
+            totalWeight += ptWeight;
+            for(unsigned int d = 0; d < numDims; ++d)
+            {
+                if(!std::isfinite(data[(i * numDims) + d]))
+                {
+                    throw RSGISMathException("RSGISFitGaussianMixModelEM: The samples must be finite.");
+                }
+                mean[d] += ptWeight * data[(i * numDims) + d];
+            }
+        }
+        if(totalWeight <= 0)
+        {
+            throw RSGISMathException("RSGISFitGaussianMixModelEM: The total weight of the samples must be greater than 0.");
+        }
+        for(unsigned int d = 0; d < numDims; ++d)
+        {
+            mean[d] /= totalWeight;
+        }
+        std::vector<double> covariance(numDims * numDims, 0.0);
+        for(size_t i = 0; i < numPts; ++i)
+        {
+            double ptWeight = (ptWeights == NULL)?1.0:ptWeights[i];
+            const double *pt = data + (i * numDims);
+            for(unsigned int d = 0; d < numDims; ++d)
+            {
+                for(unsigned int e = 0; e < numDims; ++e)
+                {
+                    covariance[(d * numDims) + e] += ptWeight * (pt[d] - mean[d]) * (pt[e] - mean[e]);
+                }
+            }
+        }
+        for(unsigned int d = 0; d < numDims; ++d)
+        {
+            for(unsigned int e = 0; e < numDims; ++e)
+            {
+                covariance[(d * numDims) + e] /= totalWeight;
+            }
+            covariance[(d * numDims) + d] += minVar;
+        }
+        
+        // Select the initial means with k-means++ (weighted by the sample weights).
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::vector<double> minSqDist(numPts, std::numeric_limits<double>::infinity());
+        std::vector<size_t> centreIdxs;
+        for(unsigned int k = 0; k < numComps; ++k)
+        {
+            double sumWeight = 0.0;
+            for(size_t i = 0; i < numPts; ++i)
+            {
+                double ptWeight = (ptWeights == NULL)?1.0:ptWeights[i];
+                sumWeight += (k == 0)?ptWeight:(ptWeight * minSqDist[i]);
+            }
+            bool useDist = (k > 0) && (sumWeight > 0);
+            if(!useDist)
+            {
+                sumWeight = totalWeight;
+            }
+            
+            double target = uniform(rng) * sumWeight;
+            size_t centreIdx = numPts;
+            double cumWeight = 0.0;
+            for(size_t i = 0; i < numPts; ++i)
+            {
+                double ptWeight = (ptWeights == NULL)?1.0:ptWeights[i];
+                double selWeight = useDist?(ptWeight * minSqDist[i]):ptWeight;
+                if(selWeight <= 0)
+                {
+                    continue;
+                }
+                centreIdx = i;
+                cumWeight += selWeight;
+                if(cumWeight > target)
+                {
+                    break;
+                }
+            }
+            centreIdxs.push_back(centreIdx);
+            
+            const double *centre = data + (centreIdx * numDims);
+            for(size_t i = 0; i < numPts; ++i)
+            {
+                const double *pt = data + (i * numDims);
+                double sqDist = 0.0;
+                for(unsigned int d = 0; d < numDims; ++d)
+                {
+                    sqDist += (pt[d] - centre[d]) * (pt[d] - centre[d]);
+                }
+                if(sqDist < minSqDist[i])
+                {
+                    minSqDist[i] = sqDist;
+                }
+            }
+        }
+        
+        comps->clear();
+        comps->reserve(numComps);
+        for(unsigned int k = 0; k < numComps; ++k)
+        {
+            GaussianMixComponent comp;
+            comp.weight = 1.0 / numComps;
+            comp.mean = std::vector<double>(data + (centreIdxs[k] * numDims), data + ((centreIdxs[k] + 1) * numDims));
+            comp.covariance = covariance;
+            comps->push_back(comp);
+        }
+    }
+    
+    bool RSGISFitGaussianMixModelEM::choleskyDecomp(std::vector<double> *matrix, unsigned int n)
+    {
+        // In place lower triangular factor (L L^T); the upper triangle is set to 0.
+        double *a = matrix->data();
+        for(unsigned int j = 0; j < n; ++j)
+        {
+            double sum = a[(j * n) + j];
+            for(unsigned int k = 0; k < j; ++k)
+            {
+                sum -= a[(j * n) + k] * a[(j * n) + k];
+            }
+            if(!(sum > 0))
+            {
+                return false;
+            }
+            a[(j * n) + j] = sqrt(sum);
+            for(unsigned int i = j + 1; i < n; ++i)
+            {
+                double val = a[(i * n) + j];
+                for(unsigned int k = 0; k < j; ++k)
+                {
+                    val -= a[(i * n) + k] * a[(j * n) + k];
+                }
+                a[(i * n) + j] = val / a[(j * n) + j];
+                a[(j * n) + i] = 0.0;
+            }
+        }
+        return true;
+    }
+    
+    RSGISFitGaussianMixModelEM::~RSGISFitGaussianMixModelEM()
+    {
+        
+    }
+    
+    
 }}
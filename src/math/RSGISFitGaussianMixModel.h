@@ -28,6 +28,10 @@
 #include <vector>
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <random>
+
+#include "common/RSGISThreadPool.h"
 
 #include "math/RSGISMathException.h"
 #include "math/cmpfit/rsgis_mpfit.h"
@@ -112,6 +116,46 @@ namespace rsgis{namespace math{
         
     };
     
+    /// The number of samples in each of the blocks the EM steps are split into.
+    static const size_t RSGIS_GMM_EM_BLOCK_PTS( 4096 );
+    
+    struct DllExport GaussianMixComponent
+    {
+        double weight;
+        std::vector<double> mean;
+        /// The covariance matrix (numDims x numDims, row major).
+        std::vector<double> covariance;
+    };
+    
+    /**
+     * Fits a mixture of multivariate Gaussians to a set of (optionally weighted)
+     * samples using expectation maximisation. The samples are processed in fixed
+     * blocks across the threads, each accumulating into its own preallocated
+     * buffers, and the blocks are merged in order so the result does not depend
+     * on the number of threads. Iterations stop once the relative change in the
+     * log-likelihood is below llTol or after maxIters iterations.
+     */
+    class DllExport RSGISFitGaussianMixModelEM
+    {
+    public:
+        /** If numThreads is 0 the number of hardware threads is used. */
+        RSGISFitGaussianMixModelEM(unsigned int numThreads=1);
+        /**
+         * Fit numComps Gaussians to numPts samples (data[(i * numDims) + d]). The sample
+         * weights (e.g., histogram counts) are optional (NULL gives each a weight of 1).
+         * minVar is added to the diagonal of the covariance matrices so they remain
+         * invertible. The initial means are selected with k-means++ using the seed.
+         */
+        std::vector<GaussianMixComponent> performFit(const double *data, size_t numPts, unsigned int numDims, unsigned int numComps, const double *ptWeights=NULL, unsigned int maxIters=100, double llTol=1e-6, double minVar=1e-6, unsigned int seed=42, double *logLikelihood=NULL, unsigned int *numIters=NULL);
+        /** Fit numComps 1D Gaussians to a histogram of (bin value, frequency) pairs. */
+        std::vector<GaussianMixComponent> performHistFit(std::vector<std::pair<double, double> > *hist, unsigned int numComps, unsigned int maxIters=100, double llTol=1e-6, double minVar=1e-6, unsigned int seed=42);
+        ~RSGISFitGaussianMixModelEM();
+    protected:
+        void initComponents(const double *data, size_t numPts, unsigned int numDims, unsigned int numComps, const double *ptWeights, double minVar, unsigned int seed, std::vector<GaussianMixComponent> *comps);
+        bool choleskyDecomp(std::vector<double> *matrix, unsigned int n);
+        unsigned int numThreads;
+    };
+    
     
     
 }}
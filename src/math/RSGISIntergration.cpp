@@ -149,6 +149,8 @@ namespace rsgis{namespace math{
 		}
 		else 
 		{
+			minHeight = tl.y;
+			maxHeight = tl.y;
 			equalHeight = true;
 		}
 		
@@ -229,7 +231,7 @@ namespace rsgis{namespace math{
 		return (areaMin + (maxSegment * division));
 	}
 	
-	void TrapeziumIntegration::getUpperLowerValues(double lower, double upper, double prob)
+	void TrapeziumIntegration::getUpperLowerValues(double &lower, double &upper, double prob)
 	{
 		if(!totalCalulated)
 		{
@@ -74,7 +74,7 @@ namespace rsgis{namespace math{
 			virtual double calcValue4Area(double area);
 			virtual double calcValue4ProportionArea(double propArea);
 			double calcMaxValue();
-			void getUpperLowerValues(double lower, double upper, double prob);
+			void getUpperLowerValues(double &lower, double &upper, double prob);
 			virtual ~TrapeziumIntegration();
 		protected:
 			double calcTrapziumArea(point2D bl, point2D tl, point2D tr, point2D br);
@@ -0,0 +1,327 @@
+/*
+ *  RSGISKDTree.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISKDTree.h"
+
+namespace rsgis{namespace math{
+
+    RSGISKDTree::RSGISKDTree(double **points, size_t numPts, size_t sIdx, size_t eIdx, double **transform, unsigned int leafSize)
+    {
+        if(eIdx <= sIdx)
+        {
+            throw RSGISMathException("The tree must have at least one dimension.");
+        }
+        this->points = points;
+        this->numPts = numPts;
+        this->sIdx = sIdx;
+        this->eIdx = eIdx;
+        this->numDims = eIdx - sIdx;
+        this->leafSize = std::max<unsigned int>(leafSize, 1);
+
+        if(transform != NULL)
+        {
+            this->transform.resize(this->numDims * this->numDims);
+            for(size_t i = 0; i < this->numDims; ++i)
+            {
+                for(size_t j = 0; j < this->numDims; ++j)
+                {
+                    this->transform[(i * this->numDims) + j] = transform[i][j];
+                }
+            }
+        }
+
+        // The (transformed) values of the points the tree is split on.
+        std::vector<double> coords(this->numPts * this->numDims);
+        for(size_t i = 0; i < this->numPts; ++i)
+        {
+            double *coord = &coords[i * this->numDims];
+            if(this->transform.empty())
+            {
+                for(size_t d = 0; d < this->numDims; ++d)
+                {
+                    coord[d] = this->points[i][this->sIdx + d];
+                }
+            }
+            else
+            {
+                for(size_t d = 0; d < this->numDims; ++d)
+                {
+                    coord[d] = 0.0;
+                    for(size_t j = 0; j < this->numDims; ++j)
+                    {
+                        coord[d] += this->transform[(d * this->numDims) + j] * this->points[i][this->sIdx + j];
+                    }
+                }
+            }
+        }
+
+        this->ptIdxs.resize(this->numPts);
+        for(size_t i = 0; i < this->numPts; ++i)
+        {
+            this->ptIdxs[i] = i;
+        }
+        if(this->numPts > 0)
+        {
+            this->buildNode(&coords, 0, this->numPts);
+        }
+    }
+
+    size_t RSGISKDTree::buildNode(std::vector<double> *coords, size_t start, size_t end)
+    {
+        size_t node = this->nodes.size();
+        RSGISKDTreeNode treeNode;
+        treeNode.start = start;
+        treeNode.end = end;
+        treeNode.left = 0;
+        treeNode.right = 0;
+        this->nodes.push_back(treeNode);
+
+        // Values which are NaN are left out of the box; those points are
+        // never within the search distance.
+        double *nMin = NULL;
+        double *nMax = NULL;
+        this->nodeMin.resize(this->nodes.size() * this->numDims, std::numeric_limits<double>::infinity());
+        this->nodeMax.resize(this->nodes.size() * this->numDims, -std::numeric_limits<double>::infinity());
+        nMin = &this->nodeMin[node * this->numDims];
+        nMax = &this->nodeMax[node * this->numDims];
+        for(size_t i = start; i < end; ++i)
+        {
+            double *coord = &(*coords)[this->ptIdxs[i] * this->numDims];
+            for(size_t d = 0; d < this->numDims; ++d)
+            {
+                if(coord[d] < nMin[d])
+                {
+                    nMin[d] = coord[d];
+                }
+                if(coord[d] > nMax[d])
+                {
+                    nMax[d] = coord[d];
+                }
+            }
+        }
+
+        if((end - start) > this->leafSize)
+        {
+            // Split at the median of the dimension with the largest spread.
+            size_t splitDim = 0;
+            double maxSpread = -1;
+            for(size_t d = 0; d < this->numDims; ++d)
+            {
+                double spread = nMax[d] - nMin[d];
+                if(spread > maxSpread)
+                {
+                    maxSpread = spread;
+                    splitDim = d;
+                }
+            }
+
+            size_t nDims = this->numDims;
+            size_t mid = start + ((end - start) / 2);
+            std::nth_element(this->ptIdxs.begin() + start, this->ptIdxs.begin() + mid, this->ptIdxs.begin() + end, [coords, nDims, splitDim](size_t a, size_t b)
+            {
+                double valA = (*coords)[(a * nDims) + splitDim];
+                double valB = (*coords)[(b * nDims) + splitDim];
+                if(std::isnan(valA) || std::isnan(valB))
+                {
+                    return !std::isnan(valA) && std::isnan(valB);
+                }
+                return valA < valB;
+            });
+
+            size_t left = this->buildNode(coords, start, mid);
+            size_t right = this->buildNode(coords, mid, end);
+            this->nodes[node].left = left;
+            this->nodes[node].right = right;
+        }
+        return node;
+    }
+
+    double RSGISKDTree::calcPointDist(size_t ptIdx, double *query, RSGISCalcDistMetric *calcDist)
+    {
+        if(calcDist != NULL)
+        {
+            return calcDist->calcDist(this->points[ptIdx], this->sIdx, this->eIdx, query, this->sIdx, this->eIdx);
+        }
+        double sqSum = 0.0;
+        double diff = 0.0;
+        for(size_t d = this->sIdx; d < this->eIdx; ++d)
+        {
+            diff = this->points[ptIdx][d] - query[d];
+            sqSum += (diff * diff);
+        }
+        return sqrt(sqSum);
+    }
+
+    double RSGISKDTree::calcNodeBound(size_t node, double *query, double *queryT, RSGISCalcDistMetric *calcDist, double *boxPt)
+    {
+        double *nMin = &this->nodeMin[node * this->numDims];
+        double *nMax = &this->nodeMax[node * this->numDims];
+        if(this->transform.empty())
+        {
+            // The distance to the nearest position within the box.
+            for(size_t d = 0; d < this->numDims; ++d)
+            {
+                double val = query[this->sIdx + d];
+                if(val < nMin[d])
+                {
+                    val = nMin[d];
+                }
+                else if(val > nMax[d])
+                {
+                    val = nMax[d];
+                }
+                boxPt[this->sIdx + d] = val;
+            }
+            if(calcDist != NULL)
+            {
+                return calcDist->calcDist(boxPt, this->sIdx, this->eIdx, query, this->sIdx, this->eIdx);
+            }
+            double sqSum = 0.0;
+            double diff = 0.0;
+            for(size_t d = this->sIdx; d < this->eIdx; ++d)
+            {
+                diff = boxPt[d] - query[d];
+                sqSum += (diff * diff);
+            }
+            return sqrt(sqSum);
+        }
+
+        // The Euclidean distance in the transformed space, reduced slightly so
+        // rounding differences from the metric cannot skip a neighbour.
+        double sqSum = 0.0;
+        double diff = 0.0;
+        for(size_t d = 0; d < this->numDims; ++d)
+        {
+            diff = 0.0;
+            if(queryT[d] < nMin[d])
+            {
+                diff = nMin[d] - queryT[d];
+            }
+            else if(queryT[d] > nMax[d])
+            {
+                diff = queryT[d] - nMax[d];
+            }
+            sqSum += (diff * diff);
+        }
+        return sqrt(sqSum) * (1.0 - 1e-6);
+    }
+
+    void RSGISKDTree::findKNearest(double *query, unsigned int k, double maxDist, RSGISCalcDistMetric *calcDist, std::vector<std::pair<double, size_t> > *neighbours)
+    {
+        neighbours->clear();
+        if((k == 0) || (this->numPts == 0))
+        {
+            return;
+        }
+
+        std::vector<double> queryT;
+        std::vector<double> boxPt;
+        if(this->transform.empty())
+        {
+            boxPt.resize(this->eIdx, 0.0);
+        }
+        else
+        {
+            queryT.resize(this->numDims, 0.0);
+            for(size_t d = 0; d < this->numDims; ++d)
+            {
+                for(size_t j = 0; j < this->numDims; ++j)
+                {
+                    queryT[d] += this->transform[(d * this->numDims) + j] * query[this->sIdx + j];
+                }
+            }
+        }
+        double *queryTPtr = queryT.empty()?NULL:&queryT[0];
+        double *boxPtPtr = boxPt.empty()?NULL:&boxPt[0];
+
+        // A max-heap of the k best (distance, index) pairs found so far.
+        std::vector<std::pair<double, size_t> > heap;
+        heap.reserve(k + 1);
+
+        std::vector<std::pair<double, size_t> > nodeStack;
+        nodeStack.push_back(std::pair<double, size_t>(this->calcNodeBound(0, query, queryTPtr, calcDist, boxPtPtr), 0));
+        while(!nodeStack.empty())
+        {
+            double bound = nodeStack.back().first;
+            size_t node = nodeStack.back().second;
+            nodeStack.pop_back();
+
+            // Nodes with a bound equal to the k-th distance are still searched as a
+            // point with that distance and a lower index replaces the k-th point.
+            if((bound >= maxDist) || ((heap.size() == k) && (bound > heap.front().first)))
+            {
+                continue;
+            }
+
+            RSGISKDTreeNode &treeNode = this->nodes[node];
+            if(treeNode.left == 0)
+            {
+                for(size_t i = treeNode.start; i < treeNode.end; ++i)
+                {
+                    size_t ptIdx = this->ptIdxs[i];
+                    double dist = this->calcPointDist(ptIdx, query, calcDist);
+                    if(!(dist < maxDist))
+                    {
+                        continue;
+                    }
+                    std::pair<double, size_t> cand(dist, ptIdx);
+                    if(heap.size() < k)
+                    {
+                        heap.push_back(cand);
+                        std::push_heap(heap.begin(), heap.end());
+                    }
+                    else if(cand < heap.front())
+                    {
+                        std::pop_heap(heap.begin(), heap.end());
+                        heap.back() = cand;
+                        std::push_heap(heap.begin(), heap.end());
+                    }
+                }
+            }
+            else
+            {
+                double leftBound = this->calcNodeBound(treeNode.left, query, queryTPtr, calcDist, boxPtPtr);
+                double rightBound = this->calcNodeBound(treeNode.right, query, queryTPtr, calcDist, boxPtPtr);
+                // Push the nearer child last so it is searched first.
+                if(leftBound < rightBound)
+                {
+                    nodeStack.push_back(std::pair<double, size_t>(rightBound, treeNode.right));
+                    nodeStack.push_back(std::pair<double, size_t>(leftBound, treeNode.left));
+                }
+                else
+                {
+                    nodeStack.push_back(std::pair<double, size_t>(leftBound, treeNode.left));
+                    nodeStack.push_back(std::pair<double, size_t>(rightBound, treeNode.right));
+                }
+            }
+        }
+
+        std::sort_heap(heap.begin(), heap.end());
+        *neighbours = heap;
+    }
+
+    RSGISKDTree::~RSGISKDTree()
+    {
+
+    }
+
+}}
@@ -0,0 +1,114 @@
+/*
+ *  RSGISKDTree.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISKDTree_H
+#define RSGISKDTree_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "math/RSGISMathException.h"
+#include "math/RSGISDistMetrics.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_maths_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace math{
+
+    struct DllExport RSGISKDTreeNode
+    {
+        /// The range [start, end) of the tree ordered point indexes within the node.
+        size_t start;
+        size_t end;
+        /// The child nodes (0 for a leaf; the root is never a child).
+        size_t left;
+        size_t right;
+    };
+
+    /**
+     * A kd-tree for exact k nearest neighbour searches over the values [sIdx, eIdx)
+     * of a set of points. The points are not copied so must not be changed or freed
+     * while the tree is in use. A search does not change the tree so searches can be
+     * run on several threads at once (as long as the distance metric allows it).
+     *
+     * Without a transform a node is skipped using the distance (with the given
+     * metric) to the nearest position within the bounding box of the node, so the
+     * metric must not decrease as the difference on any one axis increases (e.g.,
+     * Euclidean or Manhattan). For the Mahalanobis distance the tree is built on the
+     * points multiplied by the whitening transform of the metric (see
+     * RSGISCalcMahalanobisDistMetric::calcWhiteningTransform) in which it is the
+     * Euclidean distance. In both cases the distances of the neighbours returned are
+     * calculated with the metric itself, so the result is the same as a linear search.
+     */
+    class DllExport RSGISKDTree
+    {
+    public:
+        /** transform (optional) is a (eIdx-sIdx) x (eIdx-sIdx) matrix applied to the values of the points and queries. */
+        RSGISKDTree(double **points, size_t numPts, size_t sIdx, size_t eIdx, double **transform=NULL, unsigned int leafSize=16);
+        /**
+         * Find the (up to) k points with the smallest distance to the query which is
+         * less than maxDist. The neighbours are returned as (distance, point index)
+         * in ascending order of distance, with ties in the order of the points. The
+         * distance is calcDist->calcDist(point, sIdx, eIdx, query, sIdx, eIdx) or, if
+         * calcDist is NULL, the Euclidean distance sqrt(sum((point - query)^2)).
+         */
+        void findKNearest(double *query, unsigned int k, double maxDist, RSGISCalcDistMetric *calcDist, std::vector<std::pair<double, size_t> > *neighbours);
+        size_t getNumPoints(){return this->numPts;};
+        size_t getNumDims(){return this->numDims;};
+        ~RSGISKDTree();
+    protected:
+        size_t buildNode(std::vector<double> *coords, size_t start, size_t end);
+        double calcPointDist(size_t ptIdx, double *query, RSGISCalcDistMetric *calcDist);
+        double calcNodeBound(size_t node, double *query, double *queryT, RSGISCalcDistMetric *calcDist, double *boxPt);
+        double **points;
+        size_t numPts;
+        size_t sIdx;
+        size_t eIdx;
+        size_t numDims;
+        unsigned int leafSize;
+        /// The transform (row-major numDims x numDims), empty if not used.
+        std::vector<double> transform;
+        std::vector<size_t> ptIdxs;
+        std::vector<RSGISKDTreeNode> nodes;
+        /// The bounding box of each node (numDims values per node).
+        std::vector<double> nodeMin;
+        std::vector<double> nodeMax;
+    };
+
+}}
+
+#endif
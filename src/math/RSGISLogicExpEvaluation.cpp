@@ -22,6 +22,8 @@
 
 #include "RSGISLogicExpEvaluation.h"
 
+#include <cstring>
+
 namespace rsgis{namespace math{
 
 
@@ -54,6 +56,16 @@ namespace rsgis{namespace math{
         
         return outVal;
     }
+    
+    void RSGISLogicAndExpression::compile(RSGISLogicExpProgram *program)
+    {
+        size_t idx = program->beginNode(rsgis_logic_and);
+        for(std::vector<RSGISLogicExpression*>::iterator iterExps = exps->begin(); iterExps != exps->end(); ++iterExps)
+        {
+            (*iterExps)->compile(program);
+        }
+        program->endNode(idx);
+    }
 
     
     bool RSGISLogicOrExpression::evaluate()
@@ -86,6 +98,16 @@ namespace rsgis{namespace math{
         return outVal;
     }
     
+    void RSGISLogicOrExpression::compile(RSGISLogicExpProgram *program)
+    {
+        size_t idx = program->beginNode(rsgis_logic_or);
+        for(std::vector<RSGISLogicExpression*>::iterator iterExps = exps->begin(); iterExps != exps->end(); ++iterExps)
+        {
+            (*iterExps)->compile(program);
+        }
+        program->endNode(idx);
+    }
+    
 
     bool RSGISLogicNotExpression::evaluate()
     {
@@ -110,6 +132,13 @@ namespace rsgis{namespace math{
         return outVal;
     }
     
+    void RSGISLogicNotExpression::compile(RSGISLogicExpProgram *program)
+    {
+        size_t idx = program->beginNode(rsgis_logic_not);
+        exp->compile(program);
+        program->endNode(idx);
+    }
+    
     bool RSGISLogicEqualsExpression::evaluate()
     {
         bool outVal = true;
@@ -148,6 +177,16 @@ namespace rsgis{namespace math{
         return outVal;
     }
     
+    void RSGISLogicEqualsExpression::compile(RSGISLogicExpProgram *program)
+    {
+        size_t idx = program->beginNode(rsgis_logic_equals);
+        for(std::vector<RSGISLogicExpression*>::iterator iterExps = exps->begin(); iterExps != exps->end(); ++iterExps)
+        {
+            (*iterExps)->compile(program);
+        }
+        program->endNode(idx);
+    }
+    
     
     
 
@@ -183,6 +222,11 @@ namespace rsgis{namespace math{
         return outVal;
     }
     
+    void RSGISLogicEqualsValueExpression::compile(RSGISLogicExpProgram *program)
+    {
+        program->addComparison(rsgis_logic_eq_val, val1, val2);
+    }
+    
     bool RSGISLogicGreaterThanValueExpression::evaluate()
     {
         bool outVal = false;
@@ -215,6 +259,11 @@ namespace rsgis{namespace math{
         return outVal;
     }
     
+    void RSGISLogicGreaterThanValueExpression::compile(RSGISLogicExpProgram *program)
+    {
+        program->addComparison(rsgis_logic_gt_val, val1, val2);
+    }
+    
     bool RSGISLogicLessThanValueExpression::evaluate()
     {
         bool outVal = false;
@@ -247,6 +296,11 @@ namespace rsgis{namespace math{
         return outVal;
     }
     
+    void RSGISLogicLessThanValueExpression::compile(RSGISLogicExpProgram *program)
+    {
+        program->addComparison(rsgis_logic_lt_val, val1, val2);
+    }
+    
     bool RSGISLogicGreaterEqualToValueExpression::evaluate()
     {
         bool outVal = false;
@@ -279,6 +333,11 @@ namespace rsgis{namespace math{
         return outVal;
     }
     
+    void RSGISLogicGreaterEqualToValueExpression::compile(RSGISLogicExpProgram *program)
+    {
+        program->addComparison(rsgis_logic_gteq_val, val1, val2);
+    }
+    
     bool RSGISLogicLessEqualToValueExpression::evaluate()
     {
         bool outVal = false;
@@ -311,6 +370,11 @@ namespace rsgis{namespace math{
         return outVal;
     }
     
+    void RSGISLogicLessEqualToValueExpression::compile(RSGISLogicExpProgram *program)
+    {
+        program->addComparison(rsgis_logic_lteq_val, val1, val2);
+    }
+    
     bool RSGISLogicNotValueExpression::evaluate()
     {
         bool outVal = false;
@@ -343,8 +407,363 @@ namespace rsgis{namespace math{
         return outVal;
     }
     
+    void RSGISLogicNotValueExpression::compile(RSGISLogicExpProgram *program)
+    {
+        program->addComparison(rsgis_logic_neq_val, val1, val2);
+    }
+    
+    
+    /** Compare two blocks of values, where a NULL block is the single value, with loops which can be vectorised. */
+    template<typename CmpOp> static void compareBlock(const double *vals1, double val1, const double *vals2, double val2, size_t n, unsigned char *cmpVals, CmpOp cmpOp)
+    {
+        if((vals1 != NULL) && (vals2 != NULL))
+        {
+            for(size_t i = 0; i < n; ++i)
+            {
+                cmpVals[i] = cmpOp(vals1[i], vals2[i]);
+            }
+        }
+        else if(vals1 != NULL)
+        {
+            for(size_t i = 0; i < n; ++i)
+            {
+                cmpVals[i] = cmpOp(vals1[i], val2);
+            }
+        }
+        else if(vals2 != NULL)
+        {
+            for(size_t i = 0; i < n; ++i)
+            {
+                cmpVals[i] = cmpOp(val1, vals2[i]);
+            }
+        }
+        else
+        {
+            std::fill(cmpVals, cmpVals + n, (unsigned char)cmpOp(val1, val2));
+        }
+    }
+    
+    RSGISLogicExpProgram::RSGISLogicExpProgram(RSGISLogicExpression *exp)
+    {
+        if(exp == NULL)
+        {
+            throw RSGISMathLogicException("An expression must be provided to be compiled.");
+        }
+        this->depth = 0;
+        this->maxDepth = 0;
+        exp->compile(this);
+        if(!this->openNodes.empty())
+        {
+            throw RSGISMathLogicException("The expression was not completely compiled; a node was not ended.");
+        }
+        if(this->instructions.empty())
+        {
+            throw RSGISMathLogicException("The expression did not compile to any instructions.");
+        }
+        this->bound.assign(this->variables.size(), NULL);
+    }
+    
+    void RSGISLogicExpProgram::bindVariable(double *var, const double *vals)
+    {
+        std::vector<double*>::iterator iterVar = std::find(this->variables.begin(), this->variables.end(), var);
+        if(iterVar == this->variables.end())
+        {
+            throw RSGISMathLogicException("The variable is not used by the expression.");
+        }
+        this->bound[iterVar - this->variables.begin()] = vals;
+    }
+    
+    void RSGISLogicExpProgram::unbindVariables()
+    {
+        this->bound.assign(this->variables.size(), NULL);
+    }
+    
+    void RSGISLogicExpProgram::evaluate(size_t start, size_t n, unsigned char *outVals) const
+    {
+        std::vector<uint64_t> scratch;
+        std::vector<uint64_t> blockMask(RSGIS_LOGIC_BLOCK_SIZE / 64);
+        for(size_t off = 0; off < n; off += RSGIS_LOGIC_BLOCK_SIZE)
+        {
+            size_t nBlock = std::min<size_t>(RSGIS_LOGIC_BLOCK_SIZE, n - off);
+            this->evaluateBlock(start + off, nBlock, blockMask.data(), &scratch);
+            for(size_t i = 0; i < nBlock; ++i)
+            {
+                outVals[off + i] = (unsigned char)((blockMask[i / 64] >> (i % 64)) & 1);
+            }
+        }
+    }
+    
+    void RSGISLogicExpProgram::evaluateMask(size_t start, size_t n, std::vector<uint64_t> *outMask) const
+    {
+        std::vector<uint64_t> scratch;
+        outMask->assign((n + 63) / 64, 0);
+        for(size_t off = 0; off < n; off += RSGIS_LOGIC_BLOCK_SIZE)
+        {
+            size_t nBlock = std::min<size_t>(RSGIS_LOGIC_BLOCK_SIZE, n - off);
+            this->evaluateBlock(start + off, nBlock, outMask->data() + (off / 64), &scratch);
+        }
+    }
+    
+    RSGISLogicExpProgram::~RSGISLogicExpProgram()
+    {
+        
+    }
+    
+    size_t RSGISLogicExpProgram::beginNode(RSGISLogicOp op)
+    {
+        if((op != rsgis_logic_and) && (op != rsgis_logic_or) && (op != rsgis_logic_not) && (op != rsgis_logic_equals))
+        {
+            throw RSGISMathLogicException("A node must be an And, Or, Not or Equals operation.");
+        }
+        LogicInstruction inst;
+        inst.op = op;
+        inst.nInstructions = 1;
+        inst.var1 = 0;
+        inst.var2 = 0;
+        size_t idx = this->instructions.size();
+        this->instructions.push_back(inst);
+        this->openNodes.push_back(idx);
+        this->depth++;
+        this->maxDepth = std::max(this->maxDepth, this->depth);
+        return idx;
+    }
+    
+    void RSGISLogicExpProgram::endNode(size_t idx)
+    {
+        if(this->openNodes.empty() || (this->openNodes.back() != idx))
+        {
+            throw RSGISMathLogicException("The nodes of the expression must be ended in the reverse order they were begun.");
+        }
+        this->openNodes.pop_back();
+        this->depth--;
+        this->instructions[idx].nInstructions = this->instructions.size() - idx;
+        if((this->instructions[idx].op == rsgis_logic_not) && (this->instructions[idx].nInstructions != (this->instructions[idx+1].nInstructions + 1)))
+        {
+            throw RSGISMathLogicException("A Not expression must have a single expression.");
+        }
+    }
+    
+    void RSGISLogicExpProgram::addComparison(RSGISLogicOp op, double *val1, double *val2)
+    {
+        if((op == rsgis_logic_and) || (op == rsgis_logic_or) || (op == rsgis_logic_not) || (op == rsgis_logic_equals))
+        {
+            throw RSGISMathLogicException("A comparison cannot be an And, Or, Not or Equals operation.");
+        }
+        LogicInstruction inst;
+        inst.op = op;
+        inst.nInstructions = 1;
+        inst.var1 = this->getVariableIdx(val1);
+        inst.var2 = this->getVariableIdx(val2);
+        this->instructions.push_back(inst);
+    }
+    
+    unsigned int RSGISLogicExpProgram::getVariableIdx(double *var)
+    {
+        if(var == NULL)
+        {
+            throw RSGISMathLogicException("The value of a comparison is NULL.");
+        }
+        std::vector<double*>::iterator iterVar = std::find(this->variables.begin(), this->variables.end(), var);
+        if(iterVar != this->variables.end())
+        {
+            return iterVar - this->variables.begin();
+        }
+        this->variables.push_back(var);
+        return this->variables.size() - 1;
+    }
+    
+    void RSGISLogicExpProgram::evaluateBlock(size_t start, size_t n, uint64_t *outMask, std::vector<uint64_t> *scratch) const
+    {
+        // Each level of the tree has three masks: the result of a child and two for the node.
+        const unsigned int nWordsBlock = RSGIS_LOGIC_BLOCK_SIZE / 64;
+        scratch->resize(((size_t)this->maxDepth + 2) * 3 * nWordsBlock);
+        uint64_t *active = scratch->data() + (scratch->size() - nWordsBlock);
+        size_t nWords = (n + 63) / 64;
+        for(size_t w = 0; w < nWords; ++w)
+        {
+            size_t nBits = std::min<size_t>(64, n - (w * 64));
+            active[w] = (nBits == 64)?(~((uint64_t)0)):((((uint64_t)1) << nBits) - 1);
+        }
+        this->evaluateNode(0, 0, start, n, active, outMask, scratch->data());
+    }
+    
+    void RSGISLogicExpProgram::evaluateNode(size_t pc, unsigned int depth, size_t start, size_t n, const uint64_t *active, uint64_t *out, uint64_t *scratch) const
+    {
+        // The output is only set for the active elements (i.e., those which are evaluated).
+        const unsigned int nWordsBlock = RSGIS_LOGIC_BLOCK_SIZE / 64;
+        size_t nWords = (n + 63) / 64;
+        const LogicInstruction *inst = &this->instructions[pc];
+        uint64_t *childOut = scratch + (((size_t)depth) * 3 * nWordsBlock);
+        uint64_t *nodeMask = childOut + nWordsBlock;
+        uint64_t *firstOut = nodeMask + nWordsBlock;
+        size_t end = pc + inst->nInstructions;
+        size_t child = pc + 1;
+        
+        if(inst->op == rsgis_logic_and)
+        {
+            // The elements still true are the active elements of the next expression.
+            std::copy(active, active + nWords, out);
+            for(; child < end; child += this->instructions[child].nInstructions)
+            {
+                if(std::find_if(out, out + nWords, [](uint64_t v){return v != 0;}) == (out + nWords))
+                {
+                    break;
+                }
+                this->evaluateNode(child, depth + 1, start, n, out, childOut, scratch);
+                for(size_t w = 0; w < nWords; ++w)
+                {
+                    out[w] &= childOut[w];
+                }
+            }
+        }
+        else if(inst->op == rsgis_logic_or)
+        {
+            // The elements not yet true are the active elements of the next expression.
+            std::fill(out, out + nWords, 0);
+            std::copy(active, active + nWords, nodeMask);
+            for(; child < end; child += this->instructions[child].nInstructions)
+            {
+                if(std::find_if(nodeMask, nodeMask + nWords, [](uint64_t v){return v != 0;}) == (nodeMask + nWords))
+                {
+                    break;
+                }
+                this->evaluateNode(child, depth + 1, start, n, nodeMask, childOut, scratch);
+                for(size_t w = 0; w < nWords; ++w)
+                {
+                    out[w] |= childOut[w];
+                    nodeMask[w] &= ~childOut[w];
+                }
+            }
+        }
+        else if(inst->op == rsgis_logic_not)
+        {
+            this->evaluateNode(child, depth + 1, start, n, active, childOut, scratch);
+            for(size_t w = 0; w < nWords; ++w)
+            {
+                out[w] = active[w] & (~childOut[w]);
+            }
+        }
+        else if(inst->op == rsgis_logic_equals)
+        {
+            // The elements where the expressions are still equal to the first are the active elements of the next.
+            std::copy(active, active + nWords, out);
+            if(child < end)
+            {
+                this->evaluateNode(child, depth + 1, start, n, active, firstOut, scratch);
+                child += this->instructions[child].nInstructions;
+            }
+            for(; child < end; child += this->instructions[child].nInstructions)
+            {
+                if(std::find_if(out, out + nWords, [](uint64_t v){return v != 0;}) == (out + nWords))
+                {
+                    break;
+                }
+                this->evaluateNode(child, depth + 1, start, n, out, childOut, scratch);
+                for(size_t w = 0; w < nWords; ++w)
+                {
+                    out[w] &= ~(childOut[w] ^ firstOut[w]);
+                }
+            }
+        }
+        else
+        {
+            this->evaluateComparison(inst, start, n, active, out);
+        }
+    }
+    
+    void RSGISLogicExpProgram::evaluateComparison(const LogicInstruction *inst, size_t start, size_t n, const uint64_t *active, uint64_t *out) const
+    {
+        unsigned char cmpVals[RSGIS_LOGIC_BLOCK_SIZE];
+        size_t nWords = (n + 63) / 64;
+        size_t nPad = nWords * 64;
+        
+        const double *vals1 = this->bound[inst->var1];
+        const double *vals2 = this->bound[inst->var2];
+        double val1 = *this->variables[inst->var1];
+        double val2 = *this->variables[inst->var2];
+        if(vals1 != NULL)
+        {
+            vals1 += start;
+        }
+        if(vals2 != NULL)
+        {
+            vals2 += start;
+        }
+        
+        // As RSGISLogicExpression::evaluate, the first evaluated element with a NaN raises an exception.
+        uint64_t anyNaN = ((vals1 == NULL) && (val1 != val1)) || ((vals2 == NULL) && (val2 != val2));
+        if(vals1 != NULL)
+        {
+            for(size_t i = 0; i < n; ++i)
+            {
+                anyNaN |= (uint64_t)(vals1[i] != vals1[i]);
+            }
+        }
+        if(vals2 != NULL)
+        {
+            for(size_t i = 0; i < n; ++i)
+            {
+                anyNaN |= (uint64_t)(vals2[i] != vals2[i]);
+            }
+        }
+        if(anyNaN)
+        {
+            for(size_t i = 0; i < n; ++i)
+            {
+                if((active[i / 64] >> (i % 64)) & 1)
+                {
+                    double v1 = (vals1 != NULL)?vals1[i]:val1;
+                    double v2 = (vals2 != NULL)?vals2[i]:val2;
+                    if((boost::math::isnan)(v1))
+                    {
+                        throw RSGISMathLogicException("Value 1 is NaN.");
+                    }
+                    if((boost::math::isnan)(v2))
+                    {
+                        throw RSGISMathLogicException("Value 2 is NaN.");
+                    }
+                }
+            }
+        }
+        
+        switch(inst->op)
+        {
+            case rsgis_logic_eq_val:
+                compareBlock(vals1, val1, vals2, val2, n, cmpVals, [](double a, double b){return a == b;});
+                break;
+            case rsgis_logic_gt_val:
+                compareBlock(vals1, val1, vals2, val2, n, cmpVals, [](double a, double b){return a > b;});
+                break;
+            case rsgis_logic_lt_val:
+                compareBlock(vals1, val1, vals2, val2, n, cmpVals, [](double a, double b){return a < b;});
+                break;
+            case rsgis_logic_gteq_val:
+                compareBlock(vals1, val1, vals2, val2, n, cmpVals, [](double a, double b){return a >= b;});
+                break;
+            case rsgis_logic_lteq_val:
+                compareBlock(vals1, val1, vals2, val2, n, cmpVals, [](double a, double b){return a <= b;});
+                break;
+            case rsgis_logic_neq_val:
+                compareBlock(vals1, val1, vals2, val2, n, cmpVals, [](double a, double b){return a != b;});
+                break;
+            default:
+                throw RSGISMathLogicException("The instruction is not a comparison.");
+        }
+        std::fill(cmpVals + n, cmpVals + nPad, 0);
+        
+        // Pack the bytes (each 0 or 1) to bits, 8 at a time.
+        for(size_t w = 0; w < nWords; ++w)
+        {
+            uint64_t cmpMask = 0;
+            for(unsigned int k = 0; k < 8; ++k)
+            {
+                uint64_t bytes = 0;
+                std::memcpy(&bytes, &cmpVals[(w * 64) + (k * 8)], 8);
+                cmpMask |= ((bytes * 0x0102040810204080ULL) >> 56) << (k * 8);
+            }
+            out[w] = cmpMask & active[w];
+        }
+    }
     
-}}
-
-
 
+}}
@@ -24,6 +24,9 @@
 #define RSGISLogicExpEvaluation_H
 
 #include <vector>
+#include <string>
+#include <algorithm>
+#include <stdint.h>
 #include "math/RSGISMathsUtils.h"
 #include "math/RSGISMathException.h"
 
@@ -42,6 +45,9 @@
 
 namespace rsgis{namespace math{
     
+    /// The number of elements (a multiple of 64) evaluated together by RSGISLogicExpProgram.
+    static const unsigned int RSGIS_LOGIC_BLOCK_SIZE( 1024 );
+    
     class DllExport RSGISMathLogicException : public RSGISMathException
     {
     public:
@@ -50,12 +56,18 @@ namespace rsgis{namespace math{
         RSGISMathLogicException(std::string message) : RSGISMathException(message){};
     };
     
+    class RSGISLogicExpProgram;
     
 	class DllExport RSGISLogicExpression
     {
     public:
         RSGISLogicExpression(std::string expName){this->expName = expName;};
         virtual bool evaluate() = 0;
+        /** Append the expression to a program (see RSGISLogicExpProgram), throwing an exception if it cannot be compiled. */
+        virtual void compile(RSGISLogicExpProgram *program)
+        {
+            throw RSGISMathLogicException("The expression \'" + this->expName + "\' cannot be compiled.");
+        };
         std::string getExpName(){return expName;};
         virtual ~RSGISLogicExpression(){};
     protected:
@@ -71,6 +83,7 @@ namespace rsgis{namespace math{
             this->exps = exps;
         };
         bool evaluate();
+        void compile(RSGISLogicExpProgram *program);
         ~RSGISLogicAndExpression()
         {
             for(std::vector<RSGISLogicExpression*>::iterator iterExps = exps->begin(); iterExps != exps->end(); ++iterExps)
@@ -91,6 +104,7 @@ namespace rsgis{namespace math{
             this->exps = exps;
         };
         bool evaluate();
+        void compile(RSGISLogicExpProgram *program);
         ~RSGISLogicOrExpression()
         {
             for(std::vector<RSGISLogicExpression*>::iterator iterExps = exps->begin(); iterExps != exps->end(); ++iterExps)
@@ -111,6 +125,7 @@ namespace rsgis{namespace math{
             this->exp = exp;
         };
         bool evaluate();
+        void compile(RSGISLogicExpProgram *program);
         ~RSGISLogicNotExpression()
         {
             delete exp;
@@ -127,6 +142,7 @@ namespace rsgis{namespace math{
             this->exps = exps;
         };
         bool evaluate();
+        void compile(RSGISLogicExpProgram *program);
         ~RSGISLogicEqualsExpression()
         {
             for(std::vector<RSGISLogicExpression*>::iterator iterExps = exps->begin(); iterExps != exps->end(); ++iterExps)
@@ -148,6 +164,7 @@ namespace rsgis{namespace math{
             this->val2 = val2;
         };
         bool evaluate();
+        void compile(RSGISLogicExpProgram *program);
         ~RSGISLogicEqualsValueExpression(){};
     protected:
         double *val1;
@@ -163,6 +180,7 @@ namespace rsgis{namespace math{
             this->val2 = val2;
         };
         bool evaluate();
+        void compile(RSGISLogicExpProgram *program);
         
         ~RSGISLogicGreaterThanValueExpression(){};
     protected:
@@ -180,6 +198,7 @@ namespace rsgis{namespace math{
             this->val2 = val2;
         };
         bool evaluate();
+        void compile(RSGISLogicExpProgram *program);
         ~RSGISLogicLessThanValueExpression(){};
     protected:
         double *val1;
@@ -196,6 +215,7 @@ namespace rsgis{namespace math{
             this->val2 = val2;
         };
         bool evaluate();
+        void compile(RSGISLogicExpProgram *program);
         ~RSGISLogicGreaterEqualToValueExpression(){};
     protected:
         double *val1;
@@ -212,6 +232,7 @@ namespace rsgis{namespace math{
             this->val2 = val2;
         };
         bool evaluate();
+        void compile(RSGISLogicExpProgram *program);
         ~RSGISLogicLessEqualToValueExpression(){};
     protected:
         double *val1;
@@ -227,13 +248,79 @@ namespace rsgis{namespace math{
             this->val2 = val2;
         };
         bool evaluate();
+        void compile(RSGISLogicExpProgram *program);
         ~RSGISLogicNotValueExpression(){};
     protected:
         double *val1;
         double *val2;
     };
+
+    enum RSGISLogicOp
+    {
+        rsgis_logic_and,
+        rsgis_logic_or,
+        rsgis_logic_not,
+        rsgis_logic_equals,
+        rsgis_logic_eq_val,
+        rsgis_logic_gt_val,
+        rsgis_logic_lt_val,
+        rsgis_logic_gteq_val,
+        rsgis_logic_lteq_val,
+        rsgis_logic_neq_val
+    };
     
-    
+    /**
+     * A RSGISLogicExpression tree compiled to a linear program which is evaluated over
+     * spans of values (e.g., columns of a RAT or strips of an image) rather than by a
+     * virtual call for each node and value. The values pointed to by the comparisons of the
+     * tree are the variables of the program; a variable can be bound to an array of values,
+     * otherwise the value it points to is used for all the elements (i.e., a threshold).
+     * The span is evaluated in blocks of RSGIS_LOGIC_BLOCK_SIZE elements as bit masks where
+     * a node is only evaluated for the elements it would be by RSGISLogicExpression::evaluate
+     * (e.g., the expressions of an And after one which is false are not) so a block is skipped
+     * by a node when none of its elements are evaluated, and NaN values raise the same
+     * exceptions as they would when evaluating the tree.
+     */
+    class DllExport RSGISLogicExpProgram
+    {
+    public:
+        /** Compile the tree, which is not owned by the program and must not be changed while it is in use. */
+        RSGISLogicExpProgram(RSGISLogicExpression *exp);
+        /** Bind a variable (any value pointed to by the tree) to an array of values; NULL unbinds it. */
+        void bindVariable(double *var, const double *vals);
+        void unbindVariables();
+        /** Evaluate elements start to start+n of the bound arrays, writing 1 (true) or 0 to outVals[0] to outVals[n-1]. Spans can be evaluated by several threads. */
+        void evaluate(size_t start, size_t n, unsigned char *outVals) const;
+        /** As evaluate but the output is a bit mask, where bit i%64 of word i/64 is element start+i. */
+        void evaluateMask(size_t start, size_t n, std::vector<uint64_t> *outMask) const;
+        size_t getNumInstructions() const {return this->instructions.size();};
+        size_t getNumVariables() const {return this->variables.size();};
+        ~RSGISLogicExpProgram();
+        
+        /** Used by RSGISLogicExpression::compile to begin a node with child expressions, which are compiled before the node is ended. */
+        size_t beginNode(RSGISLogicOp op);
+        void endNode(size_t idx);
+        /** Used by RSGISLogicExpression::compile to add a comparison of two values. */
+        void addComparison(RSGISLogicOp op, double *val1, double *val2);
+    protected:
+        struct LogicInstruction
+        {
+            RSGISLogicOp op;
+            size_t nInstructions;
+            unsigned int var1;
+            unsigned int var2;
+        };
+        unsigned int getVariableIdx(double *var);
+        void evaluateBlock(size_t start, size_t n, uint64_t *outMask, std::vector<uint64_t> *scratch) const;
+        void evaluateNode(size_t pc, unsigned int depth, size_t start, size_t n, const uint64_t *active, uint64_t *out, uint64_t *scratch) const;
+        void evaluateComparison(const LogicInstruction *inst, size_t start, size_t n, const uint64_t *active, uint64_t *out) const;
+        std::vector<LogicInstruction> instructions;
+        std::vector<double*> variables;
+        std::vector<const double*> bound;
+        std::vector<size_t> openNodes;
+        unsigned int depth;
+        unsigned int maxDepth;
+    };
     
 }}
 
@@ -21,6 +21,10 @@
  */
 
 #include "RSGISMatrices.h"
+#include "common/RSGISGDALInit.h"
+#include "RSGISDenseMatrix.h"
+
+#include <gsl/gsl_blas.h>
 
 namespace rsgis{namespace math{
 	
@@ -313,26 +317,11 @@ namespace rsgis{namespace math{
         
 		Matrix *newMatrix = this->createMatrix(matrix2->n, matrix1->m);
 		
-		double value = 0;
-		int row = 0;
-		int col = 0;
-		int index = 0;
-		for(int i = 0; i < matrix1->m; i++)
-		{
-			for(int j = 0; j < matrix2->n; j++)
-			{
-				value = 0;
-				for(int n = 0; n < matrix1->n; n++)
-				{
-					row = (i * matrix1->n) + n;
-					col = (n * matrix2->n) + j;
-
-                    value += matrix1->matrix[row] * matrix2->matrix[col];
-				}
-				newMatrix->matrix[index] = value;
-				index++;
-			}
-		}
+		// matrix1 is read as m rows of n columns and matrix2 as matrix1->n rows of matrix2->n columns.
+		gsl_matrix_const_view matrix1View = gsl_matrix_const_view_array(matrix1->matrix, matrix1->m, matrix1->n);
+		gsl_matrix_const_view matrix2View = gsl_matrix_const_view_array(matrix2->matrix, matrix2->m, matrix2->n);
+		gsl_matrix_view newMatrixView = gsl_matrix_view_array(newMatrix->matrix, matrix1->m, matrix2->n);
+		gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, &matrix1View.matrix, &matrix2View.matrix, 0.0, &newMatrixView.matrix);
 		
 		return newMatrix;
 	}
@@ -348,19 +337,13 @@ namespace rsgis{namespace math{
 			throw RSGISMatricesException("Input vector has less elements than number of matrix colums");
 		}
 		
-		for(unsigned int i = 0; i < inMatrix->size1; i++) // Loop through matirx rows
+		if(outVector->size < inMatrix->size1)
 		{
-			double mvsum = 0.0;
-			for(unsigned int j = 0; j < inMatrix->size2; j++) // Loop through colums
-			{
-				double melement = gsl_matrix_get(inMatrix, i, j);
-				double velement = gsl_vector_get(inVector, j);
-				mvsum = mvsum + (melement * velement);
-			}
-
-            gsl_vector_set(outVector, i, mvsum);
-		
+			throw RSGISMatricesException("Output vector has less elements than number of matrix rows");
 		}
+		
+		gsl_vector_view outVectorView = gsl_vector_subvector(outVector, 0, inMatrix->size1);
+		gsl_blas_dgemv(CblasNoTrans, 1.0, inMatrix, inVector, 0.0, &outVectorView.vector);
 	}
 	
 	void RSGISMatrices::printMatrix(Matrix *matrix)
@@ -845,36 +828,27 @@ namespace rsgis{namespace math{
 			throw RSGISMatricesException("Eigenvalues and Eigenvectors matrix need to be the same length");
 		}
 		
-		gsl_eigen_symmv_workspace *workspace = gsl_eigen_symmv_alloc(matrix->n);
-		gsl_matrix_view inputMatrix = gsl_matrix_view_array (matrix->matrix, matrix->n, matrix->m);
-		gsl_vector *eigenValuesGSL = gsl_vector_alloc (matrix->n);
-		gsl_matrix *eigenVectorsGSL = gsl_matrix_alloc (matrix->n, matrix->n);
-		gsl_eigen_symmv(&inputMatrix.matrix, eigenValuesGSL, eigenVectorsGSL, workspace);
-		gsl_eigen_symmv_free(workspace);
-		gsl_eigen_symmv_sort (eigenValuesGSL, eigenVectorsGSL, GSL_EIGEN_SORT_ABS_DESC);
+		RSGISDenseMatrix inputMatrix = RSGISDenseMatrix::fromMatrix(matrix);
+		std::vector<double> eigenValuesVec;
+		RSGISDenseMatrix eigenVectorsMat;
+		inputMatrix.symmetricEigen(&eigenValuesVec, &eigenVectorsMat);
 		
-		gsl_vector_view evec_i;
 		int index = 0;
-		
 		for (int i = 0; i < eigenvectors->m; i++)
 		{
-			eigenvalues->matrix[i] = gsl_vector_get(eigenValuesGSL, i);
+			eigenvalues->matrix[i] = eigenValuesVec.at(i);
 			
-			evec_i = gsl_matrix_column(eigenVectorsGSL, i);
 			for(int j = 0; j < eigenvectors->n; j++)
 			{
 				index = (j*matrix->n)+i;
-				eigenvectors->matrix[index] = gsl_vector_get(&evec_i.vector, j);
+				eigenvectors->matrix[index] = eigenVectorsMat(j, i);
 			}
 		}
-		
-		gsl_vector_free (eigenValuesGSL);
-		gsl_matrix_free (eigenVectorsGSL);
 	}
 	
 	void RSGISMatrices::exportAsImage(Matrix *matrix, std::string filepath, std::string format)
 	{
-		GDALAllRegister();
+		rsgis::RSGISGDALInit::init();
 		GDALDataset *outputImageDS = NULL;
 		GDALRasterBand *outputRasterBand = NULL;
 		GDALDriver *gdalDriver = NULL;
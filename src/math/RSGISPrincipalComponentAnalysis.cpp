@@ -78,30 +78,8 @@ namespace rsgis{namespace math{
 	Matrix* RSGISPrincipalComponentAnalysis::getAllComponents()
 	{
 		RSGISMatrices matrixUtils;
-		Matrix *pcaMatrix = matrixUtils.createMatrix(inputData->n, inputData->m);
-		
-		int outputIndex = 0;
-		int inputIndex = 0;
-		int eigenIndex = 0;
-		double newValue = 0;
-		double value = 0;
-		
-		for(int i = 0; i < eigenvectors->n; i++)
-		{
-			for(int j = 0; j < inputData->m; j++)
-			{
-				newValue = 0;
-				for(int k = 0; k < inputData->n; k++)
-				{
-					inputIndex = (j * inputData->n) + k;
-					eigenIndex = (k * eigenvectors->n) + i;
-					value = stdInputData->matrix[inputIndex] * eigenvectors->matrix[eigenIndex];
-					newValue += value;
-				}
-				outputIndex = (j * inputData->n) + i;
-				pcaMatrix->matrix[outputIndex] = newValue;
-			}
-		}
+		// Project the standardised data onto the eigenvectors (one BLAS product).
+		Matrix *pcaMatrix = matrixUtils.multiplication(stdInputData, eigenvectors);
 		
 		return pcaMatrix;
 	}
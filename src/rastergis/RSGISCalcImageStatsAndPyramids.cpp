@@ -30,14 +30,19 @@ namespace rsgis{namespace rastergis{
         
     }
     
-    void RSGISPopulateWithImageStats::populateImageWithRasterGISStats(GDALDataset *clumpsDataset, bool addColourTable, bool calcImagePyramids, bool ignoreZero, unsigned int ratBand)
+    void RSGISPopulateWithImageStats::populateImageWithRasterGISStats(GDALDataset *clumpsDataset, bool addColourTable, bool calcImagePyramids, bool ignoreZero, unsigned int ratBand, unsigned int numThreads)
     {
         try
         {
-            this->populateImageWithRasterGISStats(clumpsDataset, addColourTable, ignoreZero, ratBand);
             if(calcImagePyramids)
             {
-                this->calcPyramids(clumpsDataset);
+                std::vector<unsigned int> ratBands;
+                ratBands.push_back(ratBand);
+                this->populateImageWithRasterGISStatsAndPyramids(clumpsDataset, addColourTable, ignoreZero, ratBands, numThreads);
+            }
+            else
+            {
+                this->populateImageWithRasterGISStats(clumpsDataset, addColourTable, ignoreZero, ratBand);
             }
         }
         catch(rsgis::RSGISImageException &e)
@@ -58,26 +63,7 @@ namespace rsgis{namespace rastergis{
     {
         try
         {
-            if(ratBand == 0)
-            {
-                throw rsgis::RSGISAttributeTableException("RAT Band must be greater than zero.");
-            }
-            if(ratBand > clumpsDataset->GetRasterCount())
-            {
-                throw rsgis::RSGISAttributeTableException("RAT Band is larger than the number of bands within the image.");
-            }
-            
-            rsgis::utils::RSGISTextUtils txtUtils;
-            RSGISRasterAttUtils attUtils;
-                        
-            GDALRasterBand *band = clumpsDataset->GetRasterBand(ratBand);
-            
-            band->SetMetadataItem("LAYER_TYPE", "thematic");
-            
-            if(ignoreZero)
-            {
-                band->SetNoDataValue(0.0);
-            }
+            GDALRasterBand *band = this->prepareRATBand(clumpsDataset, ratBand, ignoreZero);
             
             long max = 0;
             long min = 0;
@@ -86,58 +72,8 @@ namespace rsgis{namespace rastergis{
             rsgis::img::RSGISCalcImage calcImageMinMax(&calcMinMac);
             calcImageMinMax.calcImage(&clumpsDataset, 1, 0);
             
-            
-            if((min == 0) & (max == 0))
-            {
-                band->SetMetadataItem("STATISTICS_HISTOBINFUNCTION", "direct");
-                band->SetMetadataItem("STATISTICS_HISTOMIN", "0");
-                band->SetMetadataItem("STATISTICS_HISTOMAX", "0");
-                band->SetMetadataItem("STATISTICS_HISTONUMBINS", "1");
-                
-                GDALRasterAttributeTable *attTable = band->GetDefaultRAT();
-                attTable->SetRowCount(1);
-                unsigned int histoColIdx = attUtils.findColumnIndexOrCreate(attTable, "Histogram", GFT_Real, GFU_PixelCount);
-                
-                unsigned int redColIdx = 0;
-                unsigned int greenColIdx = 0;
-                unsigned int blueColIdx = 0;
-                unsigned int alphaColIdx = 0;
-                if(addColourTable)
-                {
-                    redColIdx = attUtils.findColumnIndexOrCreate(attTable, "Red", GFT_Integer, GFU_Red);
-                    greenColIdx = attUtils.findColumnIndexOrCreate(attTable, "Green", GFT_Integer, GFU_Green);
-                    blueColIdx = attUtils.findColumnIndexOrCreate(attTable, "Blue", GFT_Integer, GFU_Blue);
-                    alphaColIdx = attUtils.findColumnIndexOrCreate(attTable, "Alpha", GFT_Integer, GFU_Alpha);
-                }
-                
-                double *dataBlock = new double[1];
-                dataBlock[0] = 0;
-                int *redBlock = NULL;
-                int *greenBlock = NULL;
-                int *blueBlock = NULL;
-                int *alphaBlock = NULL;
-                if(addColourTable)
-                {
-                    redBlock = new int[1];
-                    redBlock[0] = 0;
-                    greenBlock = new int[1];
-                    greenBlock[0] = 0;
-                    blueBlock = new int[1];
-                    blueBlock[0] = 0;
-                    alphaBlock = new int[1];
-                    alphaBlock[0] = 0;
-                }
-                
-                attTable->ValuesIO(GF_Write, histoColIdx, 0, 1, dataBlock);
-                if(addColourTable)
-                {
-                    attTable->ValuesIO(GF_Write, redColIdx, 0, 1, redBlock);
-                    attTable->ValuesIO(GF_Write, greenColIdx, 0, 1, greenBlock);
-                    attTable->ValuesIO(GF_Write, blueColIdx, 0, 1, blueBlock);
-                    attTable->ValuesIO(GF_Write, alphaColIdx, 0, 1, alphaBlock);
-                }
-            }
-            else
+            size_t *histo = NULL;
+            if(!((min == 0) & (max == 0)))
             {
                 if(min < 0)
                 {
@@ -145,7 +81,7 @@ namespace rsgis{namespace rastergis{
                 }
                 
                 size_t maxHistVal = max+1;
-                size_t *histo = new size_t[maxHistVal];
+                histo = new size_t[maxHistVal];
                 
                 for(size_t i = 0; i < maxHistVal; ++i)
                 {
@@ -156,132 +92,14 @@ namespace rsgis{namespace rastergis{
                 RSGISGetClumpsHistogram calcImgHisto = RSGISGetClumpsHistogram(histo, maxHistVal, (ratBand-1));
                 rsgis::img::RSGISCalcImage calcImageStats(&calcImgHisto);
                 calcImageStats.calcImage(&clumpsDataset, 1, 0);
-                
-                if(ignoreZero)
-                {
-                    histo[0] = 0.0;
-                }
-                
-                if(addColourTable)
-                {
-                    std::cout << "Adding Histogram and Colour Table to image file\n";
-                }
-                else
-                {
-                    std::cout << "Adding Histogram to image file\n";
-                }
-                
-                GDALRasterAttributeTable *attTable = band->GetDefaultRAT();
-                attTable->SetRowCount(maxHistVal);
-                
-                band->SetMetadataItem("STATISTICS_HISTOBINFUNCTION", "direct");
-                band->SetMetadataItem("STATISTICS_HISTOMIN", "0");
-                band->SetMetadataItem("STATISTICS_HISTOMAX", txtUtils.int64bittostring(maxHistVal).c_str());
-                band->SetMetadataItem("STATISTICS_HISTONUMBINS", txtUtils.int64bittostring(maxHistVal).c_str());
-                
-                unsigned int histoColIdx = attUtils.findColumnIndexOrCreate(attTable, "Histogram", GFT_Real, GFU_PixelCount);
-                
-                unsigned int redColIdx = 0;
-                unsigned int greenColIdx = 0;
-                unsigned int blueColIdx = 0;
-                unsigned int alphaColIdx = 0;
-                if(addColourTable)
-                {
-                    redColIdx = attUtils.findColumnIndexOrCreate(attTable, "Red", GFT_Integer, GFU_Red);
-                    greenColIdx = attUtils.findColumnIndexOrCreate(attTable, "Green", GFT_Integer, GFU_Green);
-                    blueColIdx = attUtils.findColumnIndexOrCreate(attTable, "Blue", GFT_Integer, GFU_Blue);
-                    alphaColIdx = attUtils.findColumnIndexOrCreate(attTable, "Alpha", GFT_Integer, GFU_Alpha);
-                }
-                
-                double *dataBlock = new double[RAT_BLOCK_LENGTH];
-                int *redBlock = NULL;
-                int *greenBlock = NULL;
-                int *blueBlock = NULL;
-                int *alphaBlock = NULL;
-                if(addColourTable)
-                {
-                    redBlock = new int[RAT_BLOCK_LENGTH];
-                    greenBlock = new int[RAT_BLOCK_LENGTH];
-                    blueBlock = new int[RAT_BLOCK_LENGTH];
-                    alphaBlock = new int[RAT_BLOCK_LENGTH];
-                }
-                size_t numBlocks = floor((double)maxHistVal/(double)RAT_BLOCK_LENGTH);
-                size_t rowsRemain = maxHistVal - (numBlocks * RAT_BLOCK_LENGTH);
-                size_t startRow = 0;
-                size_t rowID = 0;
-                srand(time(NULL));
-                for(size_t i = 0; i < numBlocks; ++i)
-                {
-                    for(size_t j = 0; j < RAT_BLOCK_LENGTH; ++j)
-                    {
-                        if(addColourTable)
-                        {
-                            if((rowID == 0) & ignoreZero)
-                            {
-                                redBlock[j] = 0;
-                                greenBlock[j] = 0;
-                                blueBlock[j] = 0;
-                                alphaBlock[j] = 255;
-                            }
-                            else
-                            {
-                                redBlock[j] = rand() % 255 + 1;
-                                greenBlock[j] = rand() % 255 + 1;
-                                blueBlock[j] = rand() % 255 + 1;
-                                alphaBlock[j] = 255;
-                            }
-                        }
-                        dataBlock[j] = histo[rowID];
-                        ++rowID;
-                    }
-                    attTable->ValuesIO(GF_Write, histoColIdx, startRow, RAT_BLOCK_LENGTH, dataBlock);
-                    if(addColourTable)
-                    {
-                        attTable->ValuesIO(GF_Write, redColIdx, startRow, RAT_BLOCK_LENGTH, redBlock);
-                        attTable->ValuesIO(GF_Write, greenColIdx, startRow, RAT_BLOCK_LENGTH, greenBlock);
-                        attTable->ValuesIO(GF_Write, blueColIdx, startRow, RAT_BLOCK_LENGTH, blueBlock);
-                        attTable->ValuesIO(GF_Write, alphaColIdx, startRow, RAT_BLOCK_LENGTH, alphaBlock);
-                    }
-                    
-                    startRow += RAT_BLOCK_LENGTH;
-                }
-                if(rowsRemain > 0)
-                {
-                    for(size_t j = 0; j < rowsRemain; ++j)
-                    {
-                        if(addColourTable)
-                        {
-                            if((rowID == 0) & ignoreZero)
-                            {
-                                redBlock[j] = 0;
-                                greenBlock[j] = 0;
-                                blueBlock[j] = 0;
-                                alphaBlock[j] = 255;
-                            }
-                            else
-                            {
-                                redBlock[j] = rand() % 255 + 1;
-                                greenBlock[j] = rand() % 255 + 1;
-                                blueBlock[j] = rand() % 255 + 1;
-                                alphaBlock[j] = 255;
-                            }
-                        }
-                        dataBlock[j] = histo[rowID];
-                        ++rowID;
-                    }
-                    attTable->ValuesIO(GF_Write, histoColIdx, startRow, rowsRemain, dataBlock);
-                    if(addColourTable)
-                    {
-                        attTable->ValuesIO(GF_Write, redColIdx, startRow, rowsRemain, redBlock);
-                        attTable->ValuesIO(GF_Write, greenColIdx, startRow, rowsRemain, greenBlock);
-                        attTable->ValuesIO(GF_Write, blueColIdx, startRow, rowsRemain, blueBlock);
-                        attTable->ValuesIO(GF_Write, alphaColIdx, startRow, rowsRemain, alphaBlock);
-                    }
-                }
-                delete[] histo;
             }
-
             
+            this->writeRATHistogram(band, min, max, histo, addColourTable, ignoreZero);
+            
+            if(histo != NULL)
+            {
+                delete[] histo;
+            }
         }
         catch(rsgis::RSGISImageException &e)
         {
@@ -297,38 +115,278 @@ namespace rsgis{namespace rastergis{
         }
     }
     
-    void RSGISPopulateWithImageStats::calcPyramids(GDALDataset *clumpsDataset)
+    void RSGISPopulateWithImageStats::populateImageWithRasterGISStatsAndPyramids(GDALDataset *clumpsDataset, bool addColourTable, bool ignoreZero, std::vector<unsigned int> ratBands, unsigned int numThreads)
     {
         try
         {
-            std::cout << "Calculating Image Pyramids.\n";
-            int nLevels[] = { 4, 8, 16, 32, 64, 128, 256, 512 };
-            int nOverviews = 0;
-            int mindim = 0;
-            const char *pszType = "NEAREST";
+            std::vector<GDALRasterBand*> bands;
+            for(std::vector<unsigned int>::iterator iterBand = ratBands.begin(); iterBand != ratBands.end(); ++iterBand)
+            {
+                bands.push_back(this->prepareRATBand(clumpsDataset, *iterBand, ignoreZero));
+            }
+            
+            std::cout << "Calculating Image Histogram and Pyramids.\n";
+            std::vector<int> decimatFactors = rsgis::img::RSGISImagePyramidBuilder::getDefaultDecimationFactors(clumpsDataset->GetRasterXSize(), clumpsDataset->GetRasterYSize());
+            RSGISClumpsHistStripObserver histObserver = RSGISClumpsHistStripObserver(ratBands);
+            rsgis::img::RSGISImagePyramidBuilder pyramidBuilder = rsgis::img::RSGISImagePyramidBuilder(rsgis::img::pyramidNearest, numThreads);
+            pyramidBuilder.buildPyramids(clumpsDataset, decimatFactors, &histObserver);
             
-            /* first we work out how many overviews to build based on the size */
-            if(clumpsDataset->GetRasterXSize() < clumpsDataset->GetRasterYSize())
+            for(size_t i = 0; i < ratBands.size(); ++i)
             {
-                mindim = clumpsDataset->GetRasterXSize();
+                long min = histObserver.getMin(ratBands[i]);
+                long max = histObserver.getMax(ratBands[i]);
+                if(!((min == 0) & (max == 0)) && (min < 0))
+                {
+                    throw rsgis::RSGISImageException("The minimum value is less than zero.");
+                }
+                this->writeRATHistogram(bands[i], min, max, histObserver.getHistogram(ratBands[i]), addColourTable, ignoreZero);
+            }
+        }
+        catch(rsgis::RSGISImageException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw rsgis::RSGISImageException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw rsgis::RSGISImageException(e.what());
+        }
+    }
+    
+    GDALRasterBand* RSGISPopulateWithImageStats::prepareRATBand(GDALDataset *clumpsDataset, unsigned int ratBand, bool ignoreZero)
+    {
+        if(ratBand == 0)
+        {
+            throw rsgis::RSGISAttributeTableException("RAT Band must be greater than zero.");
+        }
+        if(ratBand > clumpsDataset->GetRasterCount())
+        {
+            throw rsgis::RSGISAttributeTableException("RAT Band is larger than the number of bands within the image.");
+        }
+        
+        GDALRasterBand *band = clumpsDataset->GetRasterBand(ratBand);
+        
+        band->SetMetadataItem("LAYER_TYPE", "thematic");
+        
+        if(ignoreZero)
+        {
+            band->SetNoDataValue(0.0);
+        }
+        return band;
+    }
+    
+    void RSGISPopulateWithImageStats::writeRATHistogram(GDALRasterBand *band, long min, long max, size_t *histo, bool addColourTable, bool ignoreZero)
+    {
+        rsgis::utils::RSGISTextUtils txtUtils;
+        RSGISRasterAttUtils attUtils;
+        
+        if((min == 0) & (max == 0))
+        {
+            band->SetMetadataItem("STATISTICS_HISTOBINFUNCTION", "direct");
+            band->SetMetadataItem("STATISTICS_HISTOMIN", "0");
+            band->SetMetadataItem("STATISTICS_HISTOMAX", "0");
+            band->SetMetadataItem("STATISTICS_HISTONUMBINS", "1");
+            
+            GDALRasterAttributeTable *attTable = band->GetDefaultRAT();
+            attTable->SetRowCount(1);
+            unsigned int histoColIdx = attUtils.findColumnIndexOrCreate(attTable, "Histogram", GFT_Real, GFU_PixelCount);
+            
+            unsigned int redColIdx = 0;
+            unsigned int greenColIdx = 0;
+            unsigned int blueColIdx = 0;
+            unsigned int alphaColIdx = 0;
+            if(addColourTable)
+            {
+                redColIdx = attUtils.findColumnIndexOrCreate(attTable, "Red", GFT_Integer, GFU_Red);
+                greenColIdx = attUtils.findColumnIndexOrCreate(attTable, "Green", GFT_Integer, GFU_Green);
+                blueColIdx = attUtils.findColumnIndexOrCreate(attTable, "Blue", GFT_Integer, GFU_Blue);
+                alphaColIdx = attUtils.findColumnIndexOrCreate(attTable, "Alpha", GFT_Integer, GFU_Alpha);
+            }
+            
+            double *dataBlock = new double[1];
+            dataBlock[0] = 0;
+            int *redBlock = NULL;
+            int *greenBlock = NULL;
+            int *blueBlock = NULL;
+            int *alphaBlock = NULL;
+            if(addColourTable)
+            {
+                redBlock = new int[1];
+                redBlock[0] = 0;
+                greenBlock = new int[1];
+                greenBlock[0] = 0;
+                blueBlock = new int[1];
+                blueBlock[0] = 0;
+                alphaBlock = new int[1];
+                alphaBlock[0] = 0;
+            }
+            
+            attTable->ValuesIO(GF_Write, histoColIdx, 0, 1, dataBlock);
+            if(addColourTable)
+            {
+                attTable->ValuesIO(GF_Write, redColIdx, 0, 1, redBlock);
+                attTable->ValuesIO(GF_Write, greenColIdx, 0, 1, greenBlock);
+                attTable->ValuesIO(GF_Write, blueColIdx, 0, 1, blueBlock);
+                attTable->ValuesIO(GF_Write, alphaColIdx, 0, 1, alphaBlock);
+            }
+            
+            delete[] dataBlock;
+            if(addColourTable)
+            {
+                delete[] redBlock;
+                delete[] greenBlock;
+                delete[] blueBlock;
+                delete[] alphaBlock;
+            }
+        }
+        else
+        {
+            size_t maxHistVal = max+1;
+            
+            if(ignoreZero)
+            {
+                histo[0] = 0.0;
+            }
+            
+            if(addColourTable)
+            {
+                std::cout << "Adding Histogram and Colour Table to image file\n";
             }
             else
             {
-                mindim = clumpsDataset->GetRasterYSize();
+                std::cout << "Adding Histogram to image file\n";
+            }
+            
+            GDALRasterAttributeTable *attTable = band->GetDefaultRAT();
+            attTable->SetRowCount(maxHistVal);
+            
+            band->SetMetadataItem("STATISTICS_HISTOBINFUNCTION", "direct");
+            band->SetMetadataItem("STATISTICS_HISTOMIN", "0");
+            band->SetMetadataItem("STATISTICS_HISTOMAX", txtUtils.int64bittostring(maxHistVal).c_str());
+            band->SetMetadataItem("STATISTICS_HISTONUMBINS", txtUtils.int64bittostring(maxHistVal).c_str());
+            
+            unsigned int histoColIdx = attUtils.findColumnIndexOrCreate(attTable, "Histogram", GFT_Real, GFU_PixelCount);
+            
+            unsigned int redColIdx = 0;
+            unsigned int greenColIdx = 0;
+            unsigned int blueColIdx = 0;
+            unsigned int alphaColIdx = 0;
+            if(addColourTable)
+            {
+                redColIdx = attUtils.findColumnIndexOrCreate(attTable, "Red", GFT_Integer, GFU_Red);
+                greenColIdx = attUtils.findColumnIndexOrCreate(attTable, "Green", GFT_Integer, GFU_Green);
+                blueColIdx = attUtils.findColumnIndexOrCreate(attTable, "Blue", GFT_Integer, GFU_Blue);
+                alphaColIdx = attUtils.findColumnIndexOrCreate(attTable, "Alpha", GFT_Integer, GFU_Alpha);
             }
             
-            nOverviews = 0;
-            for(int i = 0; i < 8; i++)
+            double *dataBlock = new double[RAT_BLOCK_LENGTH];
+            int *redBlock = NULL;
+            int *greenBlock = NULL;
+            int *blueBlock = NULL;
+            int *alphaBlock = NULL;
+            if(addColourTable)
             {
-                if( (mindim/nLevels[i]) > 33 )
+                redBlock = new int[RAT_BLOCK_LENGTH];
+                greenBlock = new int[RAT_BLOCK_LENGTH];
+                blueBlock = new int[RAT_BLOCK_LENGTH];
+                alphaBlock = new int[RAT_BLOCK_LENGTH];
+            }
+            size_t numBlocks = floor((double)maxHistVal/(double)RAT_BLOCK_LENGTH);
+            size_t rowsRemain = maxHistVal - (numBlocks * RAT_BLOCK_LENGTH);
+            size_t startRow = 0;
+            size_t rowID = 0;
+            srand(time(NULL));
+            for(size_t i = 0; i < numBlocks; ++i)
+            {
+                for(size_t j = 0; j < RAT_BLOCK_LENGTH; ++j)
+                {
+                    if(addColourTable)
+                    {
+                        if((rowID == 0) & ignoreZero)
+                        {
+                            redBlock[j] = 0;
+                            greenBlock[j] = 0;
+                            blueBlock[j] = 0;
+                            alphaBlock[j] = 255;
+                        }
+                        else
+                        {
+                            redBlock[j] = rand() % 255 + 1;
+                            greenBlock[j] = rand() % 255 + 1;
+                            blueBlock[j] = rand() % 255 + 1;
+                            alphaBlock[j] = 255;
+                        }
+                    }
+                    dataBlock[j] = histo[rowID];
+                    ++rowID;
+                }
+                attTable->ValuesIO(GF_Write, histoColIdx, startRow, RAT_BLOCK_LENGTH, dataBlock);
+                if(addColourTable)
+                {
+                    attTable->ValuesIO(GF_Write, redColIdx, startRow, RAT_BLOCK_LENGTH, redBlock);
+                    attTable->ValuesIO(GF_Write, greenColIdx, startRow, RAT_BLOCK_LENGTH, greenBlock);
+                    attTable->ValuesIO(GF_Write, blueColIdx, startRow, RAT_BLOCK_LENGTH, blueBlock);
+                    attTable->ValuesIO(GF_Write, alphaColIdx, startRow, RAT_BLOCK_LENGTH, alphaBlock);
+                }
+                
+                startRow += RAT_BLOCK_LENGTH;
+            }
+            if(rowsRemain > 0)
+            {
+                for(size_t j = 0; j < rowsRemain; ++j)
+                {
+                    if(addColourTable)
+                    {
+                        if((rowID == 0) & ignoreZero)
+                        {
+                            redBlock[j] = 0;
+                            greenBlock[j] = 0;
+                            blueBlock[j] = 0;
+                            alphaBlock[j] = 255;
+                        }
+                        else
+                        {
+                            redBlock[j] = rand() % 255 + 1;
+                            greenBlock[j] = rand() % 255 + 1;
+                            blueBlock[j] = rand() % 255 + 1;
+                            alphaBlock[j] = 255;
+                        }
+                    }
+                    dataBlock[j] = histo[rowID];
+                    ++rowID;
+                }
+                attTable->ValuesIO(GF_Write, histoColIdx, startRow, rowsRemain, dataBlock);
+                if(addColourTable)
                 {
-                    ++nOverviews;
+                    attTable->ValuesIO(GF_Write, redColIdx, startRow, rowsRemain, redBlock);
+                    attTable->ValuesIO(GF_Write, greenColIdx, startRow, rowsRemain, greenBlock);
+                    attTable->ValuesIO(GF_Write, blueColIdx, startRow, rowsRemain, blueBlock);
+                    attTable->ValuesIO(GF_Write, alphaColIdx, startRow, rowsRemain, alphaBlock);
                 }
             }
+            delete[] dataBlock;
+            if(addColourTable)
+            {
+                delete[] redBlock;
+                delete[] greenBlock;
+                delete[] blueBlock;
+                delete[] alphaBlock;
+            }
+        }
+    }
+    
+    void RSGISPopulateWithImageStats::calcPyramids(GDALDataset *clumpsDataset, unsigned int numThreads)
+    {
+        try
+        {
+            std::cout << "Calculating Image Pyramids.\n";
+            std::vector<int> decimatFactors = rsgis::img::RSGISImagePyramidBuilder::getDefaultDecimationFactors(clumpsDataset->GetRasterXSize(), clumpsDataset->GetRasterYSize());
             
-            rsgis_tqdm *pbar = new rsgis_tqdm();
-            clumpsDataset->BuildOverviews(pszType, nOverviews, nLevels, 0, NULL,  (GDALProgressFunc)RSGISRATStatsTextProgress, pbar);
-            delete pbar;
+            rsgis::img::RSGISImagePyramidBuilder pyramidBuilder = rsgis::img::RSGISImagePyramidBuilder(rsgis::img::pyramidNearest, numThreads);
+            pyramidBuilder.buildPyramids(clumpsDataset, decimatFactors);
         }
         catch(rsgis::RSGISImageException &e)
         {
@@ -378,5 +436,90 @@ namespace rsgis{namespace rastergis{
     
     
     
+    RSGISClumpsHistStripObserver::RSGISClumpsHistStripObserver(std::vector<unsigned int> bands): rsgis::img::RSGISImageStripObserver()
+    {
+        this->bands = bands;
+        this->minVals = std::vector<long>(bands.size(), 0);
+        this->maxVals = std::vector<long>(bands.size(), 0);
+        this->foundVal = std::vector<bool>(bands.size(), false);
+        this->histos = std::vector< std::vector<size_t> >(bands.size());
+    }
+    
+    void RSGISClumpsHistStripObserver::observeStrip(unsigned int band, int row, int nRows, int width, double *vals, rsgis::RSGISThreadPool *threadPool)
+    {
+        std::vector<unsigned int>::iterator iterBand = std::find(this->bands.begin(), this->bands.end(), band);
+        if(iterBand == this->bands.end())
+        {
+            return;
+        }
+        size_t idx = iterBand - this->bands.begin();
+        
+        // The counts are just incremented so a histogram per thread is not worth the memory.
+        std::vector<size_t> &histo = this->histos[idx];
+        size_t numPxls = ((size_t)nRows) * width;
+        for(size_t i = 0; i < numPxls; ++i)
+        {
+            long val = (long)vals[i];
+            if(!this->foundVal[idx])
+            {
+                this->minVals[idx] = val;
+                this->maxVals[idx] = val;
+                this->foundVal[idx] = true;
+            }
+            else if(val < this->minVals[idx])
+            {
+                this->minVals[idx] = val;
+            }
+            else if(val > this->maxVals[idx])
+            {
+                this->maxVals[idx] = val;
+            }
+            
+            if(val >= 0)
+            {
+                if(((size_t)val) >= histo.size())
+                {
+                    histo.resize(val+1, 0);
+                }
+                ++histo[val];
+            }
+        }
+    }
+    
+    long RSGISClumpsHistStripObserver::getMin(unsigned int band)
+    {
+        return this->minVals.at(this->findBandIdx(band));
+    }
+    
+    long RSGISClumpsHistStripObserver::getMax(unsigned int band)
+    {
+        return this->maxVals.at(this->findBandIdx(band));
+    }
+    
+    size_t* RSGISClumpsHistStripObserver::getHistogram(unsigned int band)
+    {
+        std::vector<size_t> &histo = this->histos.at(this->findBandIdx(band));
+        if(histo.empty())
+        {
+            histo.push_back(0);
+        }
+        return histo.data();
+    }
+    
+    size_t RSGISClumpsHistStripObserver::findBandIdx(unsigned int band)
+    {
+        std::vector<unsigned int>::iterator iterBand = std::find(this->bands.begin(), this->bands.end(), band);
+        if(iterBand == this->bands.end())
+        {
+            throw rsgis::RSGISImageException("Histogram was not calculated for the band.");
+        }
+        return iterBand - this->bands.begin();
+    }
+    
+    RSGISClumpsHistStripObserver::~RSGISClumpsHistStripObserver()
+    {
+        
+    }
+    
 }}
 
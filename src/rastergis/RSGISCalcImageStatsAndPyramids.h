@@ -26,6 +26,7 @@
 #include <string>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 
 #include "gdal_priv.h"
 #include "gdal_rat.h"
@@ -38,6 +39,7 @@
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISImagePyramids.h"
 
 #include <boost/numeric/conversion/cast.hpp>
 #include <boost/lexical_cast.hpp>
@@ -62,10 +64,42 @@ namespace rsgis{namespace rastergis{
     {
     public:
         RSGISPopulateWithImageStats();
-        void populateImageWithRasterGISStats(GDALDataset *clumpsDataset, bool addColourTable, bool calcImagePyramids, bool ignoreZero, unsigned int ratBand);
+        void populateImageWithRasterGISStats(GDALDataset *clumpsDataset, bool addColourTable, bool calcImagePyramids, bool ignoreZero, unsigned int ratBand, unsigned int numThreads=1);
         void populateImageWithRasterGISStats(GDALDataset *clumpsDataset, bool addColourTable, bool ignoreZero, unsigned int ratBand);
-        void calcPyramids(GDALDataset *clumpsDataset);
+        /**
+         * Populate the histogram (and colour table) for the RAT bands (numbered from 1)
+         * while building the pyramids so only a single read of the image is needed.
+         */
+        void populateImageWithRasterGISStatsAndPyramids(GDALDataset *clumpsDataset, bool addColourTable, bool ignoreZero, std::vector<unsigned int> ratBands, unsigned int numThreads=1);
+        /** Build the image pyramids using nearest neighbour resampling with numThreads threads (0 uses all available cores). */
+        void calcPyramids(GDALDataset *clumpsDataset, unsigned int numThreads=1);
         ~RSGISPopulateWithImageStats();
+    protected:
+        GDALRasterBand* prepareRATBand(GDALDataset *clumpsDataset, unsigned int ratBand, bool ignoreZero);
+        void writeRATHistogram(GDALRasterBand *band, long min, long max, size_t *histo, bool addColourTable, bool ignoreZero);
+    };
+    
+    /**
+     * Calculates the min, max and histogram of the clump IDs of the bands (numbered
+     * from 1) from the image strips read while the pyramids are built.
+     */
+    class DllExport RSGISClumpsHistStripObserver : public rsgis::img::RSGISImageStripObserver
+    {
+    public:
+        RSGISClumpsHistStripObserver(std::vector<unsigned int> bands);
+        void observeStrip(unsigned int band, int row, int nRows, int width, double *vals, rsgis::RSGISThreadPool *threadPool);
+        long getMin(unsigned int band);
+        long getMax(unsigned int band);
+        /** Histogram of (getMax(band)+1) bins, the pointer is owned by this object. */
+        size_t* getHistogram(unsigned int band);
+        ~RSGISClumpsHistStripObserver();
+    protected:
+        size_t findBandIdx(unsigned int band);
+        std::vector<unsigned int> bands;
+        std::vector<long> minVals;
+        std::vector<long> maxVals;
+        std::vector<bool> foundVal;
+        std::vector< std::vector<size_t> > histos;
     };
     
     
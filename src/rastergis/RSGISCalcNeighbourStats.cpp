@@ -30,16 +30,15 @@ namespace rsgis{namespace rastergis{
     }
     
     void RSGISCalcNeighbourStats::populateStatsDiff2Neighbours(GDALDataset *inputClumps, RSGISFieldAttStats fieldStats, bool useAbsDiff, unsigned int ratBand)
+    {
+        this->populateStatsDiff2Neighbours(inputClumps, std::vector<RSGISFieldAttStats>(1, fieldStats), useAbsDiff, ratBand);
+    }
+    
+    void RSGISCalcNeighbourStats::populateStatsDiff2Neighbours(GDALDataset *inputClumps, std::vector<RSGISFieldAttStats> fieldStats, bool useAbsDiff, unsigned int ratBand)
     {
         try
         {
             RSGISRasterAttUtils attUtils;
-            rsgis::math::RSGISMathsUtils mathUtils;
-            double *minDiffCol = NULL;
-            double *maxDiffCol = NULL;
-            double *sumDiffCol = NULL;
-            double *meanDiffCol = NULL;
-            double *stddevDiffCol = NULL;
             
             if(ratBand == 0)
             {
@@ -58,149 +57,113 @@ namespace rsgis{namespace rastergis{
                 throw rsgis::RSGISAttributeTableException("RAT has no rows, i.e., it is empty!");
             }
             
-            fieldStats.fieldIdx = attUtils.findColumnIndex(rat, fieldStats.field);
-            
-            std::vector<std::vector<size_t>* > *neighbours = attUtils.getRATNeighbours(inputClumps, ratBand);
-            
-            if(numRows != neighbours->size())
+            size_t numFields = fieldStats.size();
+            std::vector< std::vector<double> > dataVals(numFields);
+            for(size_t f = 0; f < numFields; ++f)
             {
-                for(auto iterNeigh = neighbours->begin(); iterNeigh != neighbours->end(); ++iterNeigh)
+                fieldStats[f].fieldIdx = attUtils.findColumnIndex(rat, fieldStats[f].field);
+                
+                size_t colLen = 0;
+                double *colVals = attUtils.readDoubleColumn(rat, fieldStats[f].field, &colLen);
+                if(colLen != numRows)
                 {
-                    delete *iterNeigh;
+                    delete[] colVals;
+                    throw rsgis::RSGISAttributeTableException("The column does not have enough values ");
                 }
+                dataVals[f].assign(colVals, colVals+colLen);
+                delete[] colVals;
+            }
+            
+            RSGISClumpNeighbourGraph *neighbours = attUtils.getRATNeighbours(inputClumps, ratBand);
+            
+            if(numRows != neighbours->getNumClumps())
+            {
                 delete neighbours;
                 
                 throw rsgis::RSGISAttributeTableException("RAT size is different to the number of neighbours retrieved.");
             }
             
-            size_t colLen = 0;
-            double *dataVals = attUtils.readDoubleColumn(rat, fieldStats.field, &colLen);
-            
-            if(colLen != numRows)
-            {
-                for(auto iterNeigh = neighbours->begin(); iterNeigh != neighbours->end(); ++iterNeigh)
+            // The output columns ([field][min, max, mean, stddev, sum]).
+            std::vector< std::vector< std::vector<double> > > outVals(numFields, std::vector< std::vector<double> >(5));
+            std::vector<RSGISNeighbourAggColumn> aggCols(numFields);
+            for(size_t f = 0; f < numFields; ++f)
+            {
+                RSGISNeighbourAggColumn *aggCol = &aggCols[f];
+                aggCol->vals = dataVals[f].data();
+                aggCol->useDiff = true;
+                aggCol->useAbsDiff = useAbsDiff;
+                aggCol->minVals = NULL;
+                aggCol->maxVals = NULL;
+                aggCol->meanVals = NULL;
+                aggCol->stdDevVals = NULL;
+                aggCol->sumVals = NULL;
+                
+                if(fieldStats[f].calcMin)
                 {
-                    delete *iterNeigh;
+                    fieldStats[f].minFieldIdx = attUtils.findColumnIndexOrCreate(rat, fieldStats[f].minField, GFT_Real);
+                    outVals[f][0].resize(numRows);
+                    aggCol->minVals = outVals[f][0].data();
+                }
+                if(fieldStats[f].calcMax)
+                {
+                    fieldStats[f].maxFieldIdx = attUtils.findColumnIndexOrCreate(rat, fieldStats[f].maxField, GFT_Real);
+                    outVals[f][1].resize(numRows);
+                    aggCol->maxVals = outVals[f][1].data();
+                }
+                if(fieldStats[f].calcMean)
+                {
+                    fieldStats[f].meanFieldIdx = attUtils.findColumnIndexOrCreate(rat, fieldStats[f].meanField, GFT_Real);
+                    outVals[f][2].resize(numRows);
+                    aggCol->meanVals = outVals[f][2].data();
+                }
+                if(fieldStats[f].calcStdDev)
+                {
+                    fieldStats[f].stdDevFieldIdx = attUtils.findColumnIndexOrCreate(rat, fieldStats[f].stdDevField, GFT_Real);
+                    outVals[f][3].resize(numRows);
+                    aggCol->stdDevVals = outVals[f][3].data();
+                }
+                if(fieldStats[f].calcSum)
+                {
+                    fieldStats[f].sumFieldIdx = attUtils.findColumnIndexOrCreate(rat, fieldStats[f].sumField, GFT_Real);
+                    outVals[f][4].resize(numRows);
+                    aggCol->sumVals = outVals[f][4].data();
                 }
-                delete neighbours;
-                delete[] dataVals;
-                throw rsgis::RSGISAttributeTableException("The column does not have enough values ");
-            }
-
-            std::vector<double> *diffClumpVals = new std::vector<double>();
-            rsgis::math::RSGISStatsSummary *stats2Calc = new rsgis::math::RSGISStatsSummary();
-
-            if(fieldStats.calcMin)
-            {
-                stats2Calc->calcMin = true;
-                fieldStats.minFieldIdx = attUtils.findColumnIndexOrCreate(rat, fieldStats.minField, GFT_Real);
-                minDiffCol = new double[numRows];
-            }
-            if(fieldStats.calcMax)
-            {
-                stats2Calc->calcMax = true;
-                fieldStats.maxFieldIdx = attUtils.findColumnIndexOrCreate(rat, fieldStats.maxField, GFT_Real);
-                maxDiffCol = new double[numRows];
-            }
-            if(fieldStats.calcMean)
-            {
-                stats2Calc->calcMean = true;
-                fieldStats.meanFieldIdx = attUtils.findColumnIndexOrCreate(rat, fieldStats.meanField, GFT_Real);
-                meanDiffCol = new double[numRows];
             }
-            if(fieldStats.calcStdDev)
+            
+            try
             {
-                stats2Calc->calcStdDev = true;
-                fieldStats.stdDevFieldIdx = attUtils.findColumnIndexOrCreate(rat, fieldStats.stdDevField, GFT_Real);
-                stddevDiffCol = new double[numRows];
+                RSGISNeighbourAggregation::aggregate(neighbours, aggCols, rsgis::RSGISExecutionContextUtils::getDefaultContext().numThreads);
             }
-            if(fieldStats.calcSum)
+            catch(...)
             {
-                stats2Calc->calcSum = true;
-                fieldStats.sumFieldIdx = attUtils.findColumnIndexOrCreate(rat, fieldStats.sumField, GFT_Real);
-                sumDiffCol = new double[numRows];
+                delete neighbours;
+                throw;
             }
-
-            for(size_t i  = 0; i <  numRows; ++i)
+            delete neighbours;
+            
+            for(size_t f = 0; f < numFields; ++f)
             {
-                diffClumpVals->clear();
-                std::vector<size_t> *clumpNeigh = neighbours->at(i);
-                diffClumpVals->reserve(clumpNeigh->size());
-                stats2Calc->min = 0.0;
-                stats2Calc->max = 0.0;
-                stats2Calc->mean = 0.0;
-                stats2Calc->stdDev = 0.0;
-                stats2Calc->sum = 0.0;
-
-                for(std::vector<size_t>::iterator iterNeigh = clumpNeigh->begin(); iterNeigh != clumpNeigh->end(); ++iterNeigh)
-                {
-                    if(useAbsDiff)
-                    {
-                        diffClumpVals->push_back(fabs(dataVals[i] - dataVals[*iterNeigh]));
-                    }
-                    else
-                    {
-                        diffClumpVals->push_back((dataVals[i] - dataVals[*iterNeigh]));
-                    }
-                }
-
-                mathUtils.generateStats(diffClumpVals, stats2Calc);
-                if(stats2Calc->calcMin)
+                if(fieldStats[f].calcMin)
                 {
-                    minDiffCol[i] = stats2Calc->min;
+                    rat->ValuesIO(GF_Write, fieldStats[f].minFieldIdx, 0, numRows, outVals[f][0].data());
                 }
-                if(stats2Calc->calcMax)
+                if(fieldStats[f].calcMax)
                 {
-                    maxDiffCol[i] = stats2Calc->max;
+                    rat->ValuesIO(GF_Write, fieldStats[f].maxFieldIdx, 0, numRows, outVals[f][1].data());
                 }
-                if(stats2Calc->calcMean)
+                if(fieldStats[f].calcMean)
                 {
-                    meanDiffCol[i] = stats2Calc->mean;
+                    rat->ValuesIO(GF_Write, fieldStats[f].meanFieldIdx, 0, numRows, outVals[f][2].data());
                 }
-                if(stats2Calc->calcStdDev)
+                if(fieldStats[f].calcStdDev)
                 {
-                    stddevDiffCol[i] = stats2Calc->stdDev;
+                    rat->ValuesIO(GF_Write, fieldStats[f].stdDevFieldIdx, 0, numRows, outVals[f][3].data());
                 }
-                if(stats2Calc->calcSum)
+                if(fieldStats[f].calcSum)
                 {
-                    sumDiffCol[i] = stats2Calc->sum;
+                    rat->ValuesIO(GF_Write, fieldStats[f].sumFieldIdx, 0, numRows, outVals[f][4].data());
                 }
             }
-
-            if(fieldStats.calcMin)
-            {
-                rat->ValuesIO(GF_Write, fieldStats.minFieldIdx, 0, numRows, minDiffCol);
-                delete[] minDiffCol;
-            }
-            if(fieldStats.calcMax)
-            {
-                rat->ValuesIO(GF_Write, fieldStats.maxFieldIdx, 0, numRows, maxDiffCol);
-                delete[] maxDiffCol;
-            }
-            if(fieldStats.calcMean)
-            {
-                rat->ValuesIO(GF_Write, fieldStats.meanFieldIdx, 0, numRows, meanDiffCol);
-                delete[] meanDiffCol;
-            }
-            if(fieldStats.calcStdDev)
-            {
-                rat->ValuesIO(GF_Write, fieldStats.stdDevFieldIdx, 0, numRows, stddevDiffCol);
-                delete[] stddevDiffCol;
-            }
-            if(fieldStats.calcSum)
-            {
-                rat->ValuesIO(GF_Write, fieldStats.sumFieldIdx, 0, numRows, sumDiffCol);
-                delete[] sumDiffCol;
-            }
-            delete stats2Calc;
-            delete diffClumpVals;
-
-            for(auto iterNeigh = neighbours->begin(); iterNeigh != neighbours->end(); ++iterNeigh)
-            {
-                delete *iterNeigh;
-            }
-            delete neighbours;
-            
         }
         catch(RSGISAttributeTableException &e)
         {
@@ -31,10 +31,12 @@
 #include "gdal_rat.h"
 
 #include "common/RSGISAttributeTableException.h"
+#include "common/RSGISExecutionContext.h"
 
 #include "math/RSGISMathsUtils.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
+#include "rastergis/RSGISNeighbourAggregation.h"
 
 #include <boost/numeric/conversion/cast.hpp>
 #include <boost/lexical_cast.hpp>
@@ -81,6 +83,8 @@ namespace rsgis{namespace rastergis{
     public:
         RSGISCalcNeighbourStats();
         void populateStatsDiff2Neighbours(GDALDataset *inputClumps, RSGISFieldAttStats fieldStats, bool useAbsDiff, unsigned int ratBand);
+        /** Calculate the statistics of the differences to the neighbours for several fields in one pass over the neighbours. */
+        void populateStatsDiff2Neighbours(GDALDataset *inputClumps, std::vector<RSGISFieldAttStats> fieldStats, bool useAbsDiff, unsigned int ratBand);
         ~RSGISCalcNeighbourStats();
     };
     
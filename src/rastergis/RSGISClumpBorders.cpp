@@ -60,23 +60,18 @@ namespace rsgis{namespace rastergis{
             }
             delete[] trans;
             
-            double *borderLenPxls = new double[numRows];
-            for(size_t i = 0; i < numRows; ++i)
+            RSGISClumpTopology topology(clumpImage, 1, xRes, yRes);
+            
+            std::vector<double> borderLenPxls(numRows, 0.0);
+            size_t numTopoClumps = std::min<size_t>(numRows, topology.getNumClumps());
+            for(size_t i = 1; i < numTopoClumps; ++i)
             {
-                borderLenPxls[i] = 0;
+                borderLenPxls[i] = topology.getBorderLength(i, includeZeroEdges);
             }
             
-            rsgis::img::RSGISCalcImageValue *calcBorderLen = new RSGISCalcBorderLenInPixels(borderLenPxls, numRows, xRes, yRes, includeZeroEdges);
-            rsgis::img::RSGISCalcImage imgCalc = rsgis::img::RSGISCalcImage(calcBorderLen);
-            
-            imgCalc.calcImageWindowData(&clumpImage, 1, 3);
-            
-            
             unsigned int borderLenColIdx = attUtils.findColumnIndexOrCreate(attTable, colName, GFT_Real);
             
-            attTable->ValuesIO(GF_Write, borderLenColIdx, 0, numRows, borderLenPxls);
-            
-            delete[] borderLenPxls;
+            attTable->ValuesIO(GF_Write, borderLenColIdx, 0, numRows, borderLenPxls.data());
         }
         catch (rsgis::img::RSGISImageCalcException &e)
         {
@@ -123,44 +118,55 @@ namespace rsgis{namespace rastergis{
             }
             delete[] trans;
             
-            double *borderLen = new double[numRows];
-            double *classborderLen = new double[numRows];
-            double *relborderLen = new double[numRows];
-            for(size_t i = 0; i < numRows; ++i)
-            {
-                borderLen[i] = 0.0;
-                classborderLen[i] = 0.0;
-                relborderLen[i] = 0.0;
-            }
-            
+            // The class of each clump is only compared once rather than for each pixel.
             size_t colClassNameLen = 0;
             char **classNamesChar = attUtils.readStrColumn(attTable, classColName, &colClassNameLen);
-            std::string *classNames = new std::string[colClassNameLen];
+            std::vector<bool> inClass(numRows, false);
             for(size_t i = 0; i < colClassNameLen; ++i)
             {
-                classNames[i] = std::string(classNamesChar[i]);
+                if(i < numRows)
+                {
+                    inClass[i] = (className == std::string(classNamesChar[i]));
+                }
+                CPLFree(classNamesChar[i]);
             }
+            delete[] classNamesChar;
             
-            rsgis::img::RSGISCalcImageValue *calcBorderLen = new RSGISCalcBorderLenInPixelsWithClass(borderLen, classborderLen, classNames, numRows, xRes, yRes, className, includeZeroEdges);
-            rsgis::img::RSGISCalcImage imgCalc = rsgis::img::RSGISCalcImage(calcBorderLen);
-            
-            imgCalc.calcImageWindowData(&clumpImage, 1, 3);
-            
+            RSGISClumpTopology topology(clumpImage, 1, xRes, yRes);
+            size_t numTopoClumps = std::min<size_t>(numRows, topology.getNumClumps());
             
-            unsigned int relBorderLenColIdx = attUtils.findColumnIndexOrCreate(attTable, colName, GFT_Real);
+            // The length of the border of each clump (not of the class) with clumps of the class.
+            std::vector<double> classBorderLen(numRows, 0.0);
+            for(size_t i = 0; i < topology.getNumEdges(); ++i)
+            {
+                const RSGISClumpEdge &edge = topology.getEdge(i);
+                if((edge.clumpA >= numTopoClumps) || (edge.clumpB >= numTopoClumps))
+                {
+                    continue;
+                }
+                if(inClass[edge.clumpB] && (!inClass[edge.clumpA]))
+                {
+                    classBorderLen[edge.clumpA] += topology.getEdgeLength(i);
+                }
+                else if(inClass[edge.clumpA] && (!inClass[edge.clumpB]))
+                {
+                    classBorderLen[edge.clumpB] += topology.getEdgeLength(i);
+                }
+            }
             
-            for(size_t i = 0; i < numRows; ++i)
+            std::vector<double> relborderLen(numRows, 0.0);
+            for(size_t i = 1; i < numTopoClumps; ++i)
             {
-                relborderLen[i] = classborderLen[i]/borderLen[i];
+                if(includeZeroEdges && inClass[0] && (!inClass[i]))
+                {
+                    classBorderLen[i] += topology.getZeroEdgeLength(i);
+                }
+                relborderLen[i] = classBorderLen[i]/topology.getBorderLength(i, includeZeroEdges);
             }
             
-            attTable->ValuesIO(GF_Write, relBorderLenColIdx, 0, numRows, relborderLen);
+            unsigned int relBorderLenColIdx = attUtils.findColumnIndexOrCreate(attTable, colName, GFT_Real);
             
-            delete[] borderLen;
-            delete[] classborderLen;
-            delete[] relborderLen;
-            delete[] classNamesChar;
-            delete[] classNames;
+            attTable->ValuesIO(GF_Write, relBorderLenColIdx, 0, numRows, relborderLen.data());
         }
         catch (rsgis::img::RSGISImageCalcException &e)
         {
@@ -35,6 +35,7 @@
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcImage.h"
 #include "rastergis/RSGISRasterAttUtils.h"
+#include "rastergis/RSGISClumpTopology.h"
 
 #include "gdal_priv.h"
 #include "ogrsf_frmts.h"
@@ -59,6 +60,7 @@ namespace rsgis{namespace rastergis{
     {
     public:
         RSGISClumpBorders();
+        /** The border lengths are calculated from a single scan of the clumps image (see RSGISClumpTopology). */
         void calcClumpBorderLength(GDALDataset *clumpImage, bool includeZeroEdges, std::string colName);
         void calcClumpRelBorderLen2Class(GDALDataset *clumpImage, bool includeZeroEdges, std::string colName, std::string classColName, std::string className);
         ~RSGISClumpBorders();
@@ -0,0 +1,140 @@
+/*
+ *  RSGISClumpCategoryCounts.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISClumpCategoryCounts.h"
+
+#ifndef _MSC_VER
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+#endif
+
+namespace rsgis{namespace rastergis{
+
+    RSGISClumpCategoryCounts::RSGISClumpCategoryCounts(GDALDataset *clumps, size_t numClumps, unsigned int numCats)
+    {
+        this->numClumps = numClumps;
+        this->numCats = numCats;
+        this->data = NULL;
+        this->mapped = false;
+        this->mapFD = -1;
+        size_t numCells = numClumps * numCats;
+        this->mapBytes = numCells * sizeof(unsigned int);
+
+        unsigned int maxMemoryMB = rsgis::RSGISExecutionContextUtils::getOutOfCoreMemoryMB();
+#ifndef _MSC_VER
+        if((maxMemoryMB > 0) && (this->mapBytes > (((size_t)maxMemoryMB) * 1024 * 1024)))
+        {
+            std::string clumpsFile = clumps->GetDescription();
+            if((clumpsFile == "") || (std::string(clumps->GetDriver()->GetDescription()) == "MEM"))
+            {
+                this->mapFile = std::string(CPLGenerateTempFilename("rsgiscatcounts"));
+            }
+            else
+            {
+                this->mapFile = clumpsFile + ".rsgiscatcounts";
+            }
+
+            this->mapFD = open(this->mapFile.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+            if(this->mapFD < 0)
+            {
+                throw rsgis::RSGISAttributeTableException("Could not create the category counts file: " + this->mapFile);
+            }
+            // The file is extended with zeros so all the counts start at 0.
+            void *mapData = MAP_FAILED;
+            if(ftruncate(this->mapFD, (off_t)this->mapBytes) == 0)
+            {
+                mapData = mmap(NULL, this->mapBytes, PROT_READ | PROT_WRITE, MAP_SHARED, this->mapFD, 0);
+            }
+            if(mapData == MAP_FAILED)
+            {
+                close(this->mapFD);
+                std::remove(this->mapFile.c_str());
+                throw rsgis::RSGISAttributeTableException("Could not memory-map the category counts file: " + this->mapFile);
+            }
+            this->data = static_cast<unsigned int*>(mapData);
+            this->mapped = true;
+        }
+#endif
+        if(!this->mapped)
+        {
+            this->memData.resize(numCells, 0);
+            this->data = this->memData.data();
+        }
+
+        this->numRanges = 64;
+        this->rangeCells = std::max<size_t>((numCells + this->numRanges - 1) / this->numRanges, 1);
+        this->rangeMutexes.reset(new std::mutex[this->numRanges]);
+    }
+
+    void RSGISClumpCategoryCounts::addCounts(std::vector<RSGISClumpCategoryCount> *counts)
+    {
+        if(counts->empty())
+        {
+            return;
+        }
+
+        // Group the counts by clump range (a counting sort) so each range is locked once.
+        std::vector<size_t> rangeStarts(this->numRanges + 1, 0);
+        for(std::vector<RSGISClumpCategoryCount>::iterator iterCount = counts->begin(); iterCount != counts->end(); ++iterCount)
+        {
+            ++rangeStarts[((*iterCount).cell / this->rangeCells) + 1];
+        }
+        for(size_t r = 0; r < this->numRanges; ++r)
+        {
+            rangeStarts[r+1] += rangeStarts[r];
+        }
+        std::vector<RSGISClumpCategoryCount> rangeCounts(counts->size());
+        std::vector<size_t> rangeNext(rangeStarts.begin(), rangeStarts.end()-1);
+        for(std::vector<RSGISClumpCategoryCount>::iterator iterCount = counts->begin(); iterCount != counts->end(); ++iterCount)
+        {
+            rangeCounts[rangeNext[(*iterCount).cell / this->rangeCells]++] = *iterCount;
+        }
+
+        for(size_t r = 0; r < this->numRanges; ++r)
+        {
+            if(rangeStarts[r] == rangeStarts[r+1])
+            {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(this->rangeMutexes[r]);
+            for(size_t i = rangeStarts[r]; i < rangeStarts[r+1]; ++i)
+            {
+                this->data[rangeCounts[i].cell] += rangeCounts[i].count;
+            }
+        }
+        counts->clear();
+    }
+
+    RSGISClumpCategoryCounts::~RSGISClumpCategoryCounts()
+    {
+#ifndef _MSC_VER
+        if(this->mapped)
+        {
+            munmap(this->data, this->mapBytes);
+            close(this->mapFD);
+            std::remove(this->mapFile.c_str());
+        }
+#endif
+    }
+
+}}
@@ -0,0 +1,100 @@
+/*
+ *  RSGISClumpCategoryCounts.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISClumpCategoryCounts_H
+#define RSGISClumpCategoryCounts_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISAttributeTableException.h"
+#include "common/RSGISExecutionContext.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_rastergis_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace rastergis{
+
+    /** A number of pixels to be added to a cell (clump * numCats + category index) of the counts. */
+    struct DllExport RSGISClumpCategoryCount
+    {
+        size_t cell;
+        unsigned int count;
+    };
+
+    /**
+     * The number of pixels of each category (mapped to the indexes 0 to numCats-1)
+     * within each clump, held as a dense uint32 matrix (clumps x categories). This
+     * is intended for a modest number of categories (e.g., up to a few hundred
+     * classes); the matrix is a memory-mapped temporary file when it is larger
+     * than the clumpsMemoryMB (or, if 0, the memoryBudgetMB) of the default
+     * execution context (see rsgis::segment::RSGISClumpsArray).
+     *
+     * The counts are added in batches (e.g., the partial counts accumulated by
+     * each thread), which are split by clump range so threads only wait for
+     * each other when adding to the same range of clumps.
+     */
+    class DllExport RSGISClumpCategoryCounts
+    {
+    public:
+        RSGISClumpCategoryCounts(GDALDataset *clumps, size_t numClumps, unsigned int numCats);
+        size_t getNumClumps(){return this->numClumps;};
+        unsigned int getNumCats(){return this->numCats;};
+        /** The counts of the categories (numCats values) of the clump. */
+        const unsigned int* getClumpCounts(size_t clump){return &this->data[clump * this->numCats];};
+        /** Add a batch of counts, which is then cleared. This can be called from multiple threads. */
+        void addCounts(std::vector<RSGISClumpCategoryCount> *counts);
+        ~RSGISClumpCategoryCounts();
+    protected:
+        size_t numClumps;
+        unsigned int numCats;
+        unsigned int *data;
+        std::vector<unsigned int> memData;
+        bool mapped;
+        std::string mapFile;
+        int mapFD;
+        size_t mapBytes;
+        size_t numRanges;
+        size_t rangeCells;
+        std::unique_ptr<std::mutex[]> rangeMutexes;
+    };
+
+}}
+
+#endif
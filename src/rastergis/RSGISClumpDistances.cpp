@@ -0,0 +1,329 @@
+/*
+ *  RSGISClumpDistances.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISClumpDistances.h"
+
+namespace rsgis{namespace rastergis{
+    
+    RSGISClumpDistances::RSGISClumpDistances(GDALDataset *clumpImage, unsigned int band, double xRes, double yRes, unsigned int leafSize)
+    {
+        if((band == 0) || (band > ((unsigned int)clumpImage->GetRasterCount())))
+        {
+            throw rsgis::RSGISImageException("The clumps band is not within the image.");
+        }
+        this->xRes = std::fabs(xRes);
+        this->yRes = std::fabs(yRes);
+        this->leafSize = std::max<unsigned int>(leafSize, 1);
+        this->numClumps = 1;
+        this->clumpPresent.assign(1, false);
+        
+        this->extractBoundaryPxls(clumpImage->GetRasterBand(band), clumpImage->GetRasterXSize(), clumpImage->GetRasterYSize());
+        
+        if(!this->pxls.empty())
+        {
+            this->nodes.reserve(((this->pxls.size() / this->leafSize) + 1) * 2);
+            this->buildNode(0, this->pxls.size());
+        }
+        
+        // The boundary pixels of each clump.
+        this->clumpPxlsStart.assign(this->numClumps+1, 0);
+        for(std::vector<RSGISClumpBoundaryPxl>::iterator iterPxl = this->pxls.begin(); iterPxl != this->pxls.end(); ++iterPxl)
+        {
+            ++this->clumpPxlsStart[(*iterPxl).clump+1];
+        }
+        for(size_t i = 0; i < this->numClumps; ++i)
+        {
+            this->clumpPxlsStart[i+1] += this->clumpPxlsStart[i];
+        }
+        this->clumpPxlIdxs.resize(this->pxls.size());
+        std::vector<size_t> clumpPos(this->clumpPxlsStart.begin(), this->clumpPxlsStart.end()-1);
+        for(size_t i = 0; i < this->pxls.size(); ++i)
+        {
+            this->clumpPxlIdxs[clumpPos[this->pxls[i].clump]++] = i;
+        }
+    }
+    
+    void RSGISClumpDistances::findNearestClumps(const std::vector<bool> &queryClumps, const std::vector<bool> &targetClumps, bool excludeSelf, double maxDist, double noDataVal, std::vector<double> *dists, std::vector<size_t> *nearest, unsigned int numThreads)
+    {
+        dists->assign(queryClumps.size(), noDataVal);
+        nearest->assign(queryClumps.size(), 0);
+        
+        // Whether each node contains a boundary pixel of a target clump (the children are after their parent).
+        std::vector<char> nodeHasTarget(this->nodes.size(), 0);
+        for(size_t n = this->nodes.size(); n > 0; --n)
+        {
+            RSGISClumpBoundaryNode &node = this->nodes[n-1];
+            if(node.left == 0)
+            {
+                for(size_t i = node.start; (i < node.end) && (nodeHasTarget[n-1] == 0); ++i)
+                {
+                    if((this->pxls[i].clump < targetClumps.size()) && targetClumps[this->pxls[i].clump])
+                    {
+                        nodeHasTarget[n-1] = 1;
+                    }
+                }
+            }
+            else
+            {
+                nodeHasTarget[n-1] = nodeHasTarget[node.left] | nodeHasTarget[node.right];
+            }
+        }
+        
+        double maxSqDist = (maxDist > 0)?(maxDist * maxDist):std::numeric_limits<double>::infinity();
+        size_t numQueries = std::min(queryClumps.size(), this->numClumps);
+        
+        // The clumps are taken in small batches as the time for each clump varies with its size.
+        const size_t batchSize = 64;
+        std::atomic<size_t> nextClump(1);
+        rsgis::RSGISThreadPool threadPool(numThreads);
+        unsigned int nThreads = (numThreads == 0)?rsgis::RSGISThreadPool::getNumHardwareThreads():numThreads;
+        rsgis_tqdm pbar;
+        pbar.start(numQueries);
+        threadPool.parallelFor(0, std::max<unsigned int>(nThreads, 1), [&](unsigned int t, size_t tStart, size_t tEnd)
+        {
+            std::vector<size_t> stack;
+            for(size_t w = tStart; w < tEnd; ++w)
+            {
+                size_t startClump = 0;
+                while((startClump = nextClump.fetch_add(batchSize)) < numQueries)
+                {
+                    size_t endClump = std::min(startClump + batchSize, numQueries);
+                    for(size_t c = startClump; c < endClump; ++c)
+                    {
+                        if(!queryClumps[c])
+                        {
+                            continue;
+                        }
+                        if((!excludeSelf) && (c < targetClumps.size()) && targetClumps[c] && this->clumpPresent[c])
+                        {
+                            (*dists)[c] = 0.0;
+                            (*nearest)[c] = c;
+                            continue;
+                        }
+                        
+                        double bestSqDist = maxSqDist;
+                        size_t bestClump = 0;
+                        for(size_t i = this->clumpPxlsStart[c]; i < this->clumpPxlsStart[c+1]; ++i)
+                        {
+                            const RSGISClumpBoundaryPxl &pxl = this->pxls[this->clumpPxlIdxs[i]];
+                            this->findNearest(pxl.x, pxl.y, c, targetClumps, nodeHasTarget, &bestSqDist, &bestClump, &stack);
+                            if((bestClump != 0) && (bestSqDist == 0))
+                            {
+                                break;
+                            }
+                        }
+                        if(bestClump != 0)
+                        {
+                            (*dists)[c] = sqrt(bestSqDist);
+                            (*nearest)[c] = bestClump;
+                        }
+                    }
+                    pbar.add(endClump - startClump);
+                    if(t == 0)
+                    {
+                        // The calling thread is worker 0, so it delivers the progress callbacks.
+                        pbar.poll();
+                    }
+                }
+            }
+        });
+        pbar.finish();
+    }
+    
+    void RSGISClumpDistances::extractBoundaryPxls(GDALRasterBand *clumpBand, unsigned int width, unsigned int height)
+    {
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        clumpBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), width, height, sizeof(unsigned int), rsgis::RSGISExecutionContextUtils::getDefaultContext().stripMemoryMB);
+        
+        // The strip is read with the row above and below it (where within the image).
+        std::vector<unsigned int> stripData(((size_t)width) * (stripRows+2), 0);
+        rsgis_tqdm pbar;
+        for(unsigned int row = 0; row < height; row += stripRows)
+        {
+            pbar.progress(row, height);
+            unsigned int nRows = std::min(stripRows, height - row);
+            unsigned int readStart = (row > 0)?(row-1):0;
+            unsigned int readEnd = std::min(row + nRows + 1, height);
+            if(clumpBand->RasterIO(GF_Read, 0, readStart, width, readEnd - readStart, stripData.data(), width, readEnd - readStart, GDT_UInt32, 0, 0) != CE_None)
+            {
+                throw rsgis::RSGISImageException("Could not read the clumps image band.");
+            }
+            
+            for(unsigned int y = row; y < (row + nRows); ++y)
+            {
+                const unsigned int *rowVals = &stripData[((size_t)(y - readStart)) * width];
+                const unsigned int *aboveVals = (y > 0)?(rowVals - width):NULL;
+                const unsigned int *belowVals = ((y+1) < height)?(rowVals + width):NULL;
+                for(unsigned int x = 0; x < width; ++x)
+                {
+                    unsigned int clump = rowVals[x];
+                    if(clump == 0)
+                    {
+                        continue;
+                    }
+                    if(clump >= this->numClumps)
+                    {
+                        this->numClumps = ((size_t)clump) + 1;
+                        this->clumpPresent.resize(this->numClumps, false);
+                    }
+                    this->clumpPresent[clump] = true;
+                    
+                    unsigned int xStart = (x > 0)?(x-1):x;
+                    unsigned int xEnd = ((x+1) < width)?(x+1):x;
+                    bool boundary = (rowVals[xStart] != clump) || (rowVals[xEnd] != clump);
+                    for(unsigned int n = xStart; (!boundary) && (n <= xEnd); ++n)
+                    {
+                        boundary = ((aboveVals != NULL) && (aboveVals[n] != clump)) || ((belowVals != NULL) && (belowVals[n] != clump));
+                    }
+                    if(boundary)
+                    {
+                        RSGISClumpBoundaryPxl pxl;
+                        pxl.x = x;
+                        pxl.y = y;
+                        pxl.clump = clump;
+                        this->pxls.push_back(pxl);
+                    }
+                }
+            }
+        }
+        pbar.finish();
+    }
+    
+    size_t RSGISClumpDistances::buildNode(size_t start, size_t end)
+    {
+        size_t nodeIdx = this->nodes.size();
+        RSGISClumpBoundaryNode node;
+        node.start = start;
+        node.end = end;
+        node.left = 0;
+        node.right = 0;
+        node.minX = this->pxls[start].x;
+        node.maxX = this->pxls[start].x;
+        node.minY = this->pxls[start].y;
+        node.maxY = this->pxls[start].y;
+        node.clump = this->pxls[start].clump;
+        for(size_t i = start+1; i < end; ++i)
+        {
+            const RSGISClumpBoundaryPxl &pxl = this->pxls[i];
+            node.minX = std::min(node.minX, pxl.x);
+            node.maxX = std::max(node.maxX, pxl.x);
+            node.minY = std::min(node.minY, pxl.y);
+            node.maxY = std::max(node.maxY, pxl.y);
+            if(pxl.clump != node.clump)
+            {
+                node.clump = 0;
+            }
+        }
+        this->nodes.push_back(node);
+        
+        if((end - start) > this->leafSize)
+        {
+            // Split the longer side of the bounding box at the median.
+            size_t mid = start + ((end - start) / 2);
+            if((node.maxX - node.minX) >= (node.maxY - node.minY))
+            {
+                std::nth_element(this->pxls.begin() + start, this->pxls.begin() + mid, this->pxls.begin() + end, [](const RSGISClumpBoundaryPxl &a, const RSGISClumpBoundaryPxl &b){return a.x < b.x;});
+            }
+            else
+            {
+                std::nth_element(this->pxls.begin() + start, this->pxls.begin() + mid, this->pxls.begin() + end, [](const RSGISClumpBoundaryPxl &a, const RSGISClumpBoundaryPxl &b){return a.y < b.y;});
+            }
+            size_t left = this->buildNode(start, mid);
+            size_t right = this->buildNode(mid, end);
+            this->nodes[nodeIdx].left = left;
+            this->nodes[nodeIdx].right = right;
+        }
+        return nodeIdx;
+    }
+    
+    double RSGISClumpDistances::calcSqDist(unsigned int dx, unsigned int dy)
+    {
+        // The gap between the pixel squares.
+        double gapX = (dx > 0)?((dx - 1) * this->xRes):0.0;
+        double gapY = (dy > 0)?((dy - 1) * this->yRes):0.0;
+        return (gapX * gapX) + (gapY * gapY);
+    }
+    
+    void RSGISClumpDistances::findNearest(unsigned int x, unsigned int y, unsigned int clump, const std::vector<bool> &targetClumps, const std::vector<char> &nodeHasTarget, double *bestSqDist, size_t *bestClump, std::vector<size_t> *stack)
+    {
+        stack->clear();
+        stack->push_back(0);
+        while(!stack->empty())
+        {
+            const RSGISClumpBoundaryNode &node = this->nodes[stack->back()];
+            stack->pop_back();
+            if((!nodeHasTarget[&node - this->nodes.data()]) || (node.clump == clump))
+            {
+                continue;
+            }
+            unsigned int dx = (x < node.minX)?(node.minX - x):((x > node.maxX)?(x - node.maxX):0);
+            unsigned int dy = (y < node.minY)?(node.minY - y):((y > node.maxY)?(y - node.maxY):0);
+            double bound = this->calcSqDist(dx, dy);
+            if((bound > (*bestSqDist)) || ((*bestClump != 0) && (bound >= (*bestSqDist))))
+            {
+                continue;
+            }
+            
+            if(node.left == 0)
+            {
+                for(size_t i = node.start; i < node.end; ++i)
+                {
+                    const RSGISClumpBoundaryPxl &pxl = this->pxls[i];
+                    if((pxl.clump == clump) || (pxl.clump >= targetClumps.size()) || (!targetClumps[pxl.clump]))
+                    {
+                        continue;
+                    }
+                    double sqDist = this->calcSqDist((pxl.x > x)?(pxl.x - x):(x - pxl.x), (pxl.y > y)?(pxl.y - y):(y - pxl.y));
+                    if((sqDist < (*bestSqDist)) || ((*bestClump == 0) && (sqDist <= (*bestSqDist))))
+                    {
+                        *bestSqDist = sqDist;
+                        *bestClump = pxl.clump;
+                    }
+                }
+            }
+            else
+            {
+                // Search the nearer child first (it is pushed last).
+                const RSGISClumpBoundaryNode &left = this->nodes[node.left];
+                unsigned int ldx = (x < left.minX)?(left.minX - x):((x > left.maxX)?(x - left.maxX):0);
+                unsigned int ldy = (y < left.minY)?(left.minY - y):((y > left.maxY)?(y - left.maxY):0);
+                const RSGISClumpBoundaryNode &right = this->nodes[node.right];
+                unsigned int rdx = (x < right.minX)?(right.minX - x):((x > right.maxX)?(x - right.maxX):0);
+                unsigned int rdy = (y < right.minY)?(right.minY - y):((y > right.maxY)?(y - right.maxY):0);
+                if(this->calcSqDist(ldx, ldy) <= this->calcSqDist(rdx, rdy))
+                {
+                    stack->push_back(node.right);
+                    stack->push_back(node.left);
+                }
+                else
+                {
+                    stack->push_back(node.left);
+                    stack->push_back(node.right);
+                }
+            }
+        }
+    }
+    
+}}
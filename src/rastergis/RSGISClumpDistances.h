@@ -0,0 +1,131 @@
+/*
+ *  RSGISClumpDistances.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISClumpDistances_H
+#define RSGISClumpDistances_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISImageException.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
+#include "common/rsgis-tqdm.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_rastergis_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace rastergis{
+    
+    /** A pixel of a (non-zero) clump which has an 8 connected neighbour in another clump. */
+    struct DllExport RSGISClumpBoundaryPxl
+    {
+        unsigned int x;
+        unsigned int y;
+        unsigned int clump;
+    };
+    
+    /** A node of the kd-tree of the boundary pixels; the bounding box is in pixels. */
+    struct DllExport RSGISClumpBoundaryNode
+    {
+        /// The range [start, end) of the (tree ordered) boundary pixels within the node.
+        size_t start;
+        size_t end;
+        /// The child nodes (0 for a leaf; the root is never a child).
+        size_t left;
+        size_t right;
+        unsigned int minX;
+        unsigned int maxX;
+        unsigned int minY;
+        unsigned int maxY;
+        /// The clump of all the pixels within the node, or 0 if there is more than one.
+        unsigned int clump;
+    };
+    
+    /**
+     * The distances between the clumps of a clumps image. The boundary pixels of the
+     * clumps (the only pixels which can be the nearest pixel of a clump to another
+     * clump) are extracted with a single scan of the image and held in a kd-tree, so
+     * the nearest clump of a set (e.g., of a class) to each clump is found without
+     * reading the image again.
+     *
+     * The distance between two clumps is the shortest distance between their pixels
+     * (as squares of xRes by yRes), as with the distance between the polygons of the
+     * clumps, so it is 0 for clumps which touch (including diagonally).
+     */
+    class DllExport RSGISClumpDistances
+    {
+    public:
+        RSGISClumpDistances(GDALDataset *clumpImage, unsigned int band, double xRes, double yRes, unsigned int leafSize=32);
+        /** The number of clumps, including clump 0 (i.e., the maximum clump ID + 1). */
+        size_t getNumClumps(){return this->numClumps;};
+        size_t getNumBoundaryPxls(){return this->pxls.size();};
+        /**
+         * For each clump c (from 1) where queryClumps[c] is true, find the nearest clump t
+         * where targetClumps[t] is true. If excludeSelf then t is not c, otherwise a clump
+         * which is a target (and has pixels) has a distance of 0 to itself. A clump without a target within
+         * maxDist (or at all, if maxDist is not greater than 0) has a distance of noDataVal
+         * and a nearest clump of 0. Clumps beyond the end of queryClumps or targetClumps are
+         * not queries or targets; dists and nearest are resized to queryClumps.size().
+         */
+        void findNearestClumps(const std::vector<bool> &queryClumps, const std::vector<bool> &targetClumps, bool excludeSelf, double maxDist, double noDataVal, std::vector<double> *dists, std::vector<size_t> *nearest, unsigned int numThreads=0);
+        ~RSGISClumpDistances(){};
+    protected:
+        void extractBoundaryPxls(GDALRasterBand *clumpBand, unsigned int width, unsigned int height);
+        size_t buildNode(size_t start, size_t end);
+        double calcSqDist(unsigned int dx, unsigned int dy);
+        void findNearest(unsigned int x, unsigned int y, unsigned int clump, const std::vector<bool> &targetClumps, const std::vector<char> &nodeHasTarget, double *bestSqDist, size_t *bestClump, std::vector<size_t> *stack);
+        double xRes;
+        double yRes;
+        unsigned int leafSize;
+        size_t numClumps;
+        /// The boundary pixels in the order of the tree.
+        std::vector<RSGISClumpBoundaryPxl> pxls;
+        std::vector<RSGISClumpBoundaryNode> nodes;
+        /// Whether each clump has any pixels within the image.
+        std::vector<bool> clumpPresent;
+        /// The boundary pixels of each clump as indexes into pxls (clumpPxlIdxs[clumpPxlsStart[c]] to clumpPxlIdxs[clumpPxlsStart[c+1]-1]).
+        std::vector<size_t> clumpPxlsStart;
+        std::vector<size_t> clumpPxlIdxs;
+    };
+    
+}}
+
+#endif
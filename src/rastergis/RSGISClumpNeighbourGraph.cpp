@@ -0,0 +1,108 @@
+/*
+ *  RSGISClumpNeighbourGraph.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISClumpNeighbourGraph.h"
+
+namespace rsgis{namespace rastergis{
+    
+    RSGISClumpNeighbourGraph::RSGISClumpNeighbourGraph(size_t numClumps)
+    {
+        this->numClumps = numClumps;
+        this->wideIdxs = (numClumps > ((size_t)std::numeric_limits<uint32_t>::max()));
+        this->offsets.reserve(numClumps+1);
+        this->offsets.push_back(0);
+    }
+    
+    void RSGISClumpNeighbourGraph::addClumpNeighbours(const std::vector<size_t> &neighbours)
+    {
+        if(this->getNumClumps() >= this->numClumps)
+        {
+            throw RSGISAttributeTableException("The neighbours of all the clumps have already been added to the graph.");
+        }
+        
+        for(std::vector<size_t>::const_iterator iterNeigh = neighbours.begin(); iterNeigh != neighbours.end(); ++iterNeigh)
+        {
+            if((*iterNeigh) >= this->numClumps)
+            {
+                throw RSGISAttributeTableException("Neighbour index is larger than the number of clumps.");
+            }
+            if(this->wideIdxs)
+            {
+                this->idxs64.push_back(*iterNeigh);
+            }
+            else
+            {
+                this->idxs32.push_back((uint32_t)(*iterNeigh));
+            }
+        }
+        this->offsets.push_back(this->offsets.back() + neighbours.size());
+    }
+    
+    RSGISClumpNeighbourGraph* RSGISClumpNeighbourGraph::createFromEdges(size_t numClumps, std::vector<std::pair<size_t, size_t> > *edges)
+    {
+        std::sort(edges->begin(), edges->end());
+        edges->erase(std::unique(edges->begin(), edges->end()), edges->end());
+        
+        RSGISClumpNeighbourGraph *graph = new RSGISClumpNeighbourGraph(numClumps);
+        if(graph->wideIdxs)
+        {
+            graph->idxs64.reserve(edges->size());
+        }
+        else
+        {
+            graph->idxs32.reserve(edges->size());
+        }
+        
+        std::vector<size_t> clumpNeighbours;
+        std::vector<std::pair<size_t, size_t> >::iterator iterEdge = edges->begin();
+        for(size_t i = 0; i < numClumps; ++i)
+        {
+            clumpNeighbours.clear();
+            while((iterEdge != edges->end()) && ((*iterEdge).first == i))
+            {
+                clumpNeighbours.push_back((*iterEdge).second);
+                ++iterEdge;
+            }
+            graph->addClumpNeighbours(clumpNeighbours);
+        }
+        
+        if(iterEdge != edges->end())
+        {
+            delete graph;
+            throw RSGISAttributeTableException("Clump index is larger than the number of clumps.");
+        }
+        
+        return graph;
+    }
+    
+    void RSGISClumpNeighbourGraph::getClumpNeighbours(size_t clump, std::vector<size_t> *neighbours)
+    {
+        size_t numNeighbours = this->getNumNeighbours(clump);
+        neighbours->clear();
+        neighbours->reserve(numNeighbours);
+        for(size_t n = 0; n < numNeighbours; ++n)
+        {
+            neighbours->push_back(this->getNeighbour(clump, n));
+        }
+    }
+    
+}}
@@ -0,0 +1,94 @@
+/*
+ *  RSGISClumpNeighbourGraph.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISClumpNeighbourGraph_H
+#define RSGISClumpNeighbourGraph_H
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <stdint.h>
+
+#include "common/RSGISAttributeTableException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_rastergis_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace rastergis{
+    
+    /**
+     * The neighbours of each clump stored as a compressed sparse row (CSR) graph,
+     * i.e., a single array of neighbour indexes and an array of offsets into it for
+     * each clump, rather than a heap allocated list per clump. The neighbour indexes
+     * are stored as 32 bit integers unless there are more than 2^32 clumps.
+     * The graph is built by adding the neighbours of each clump in turn (from clump 0).
+     */
+    class DllExport RSGISClumpNeighbourGraph
+    {
+    public:
+        RSGISClumpNeighbourGraph(size_t numClumps);
+        /** Add the neighbours of the next clump. */
+        void addClumpNeighbours(const std::vector<size_t> &neighbours);
+        /** Create the graph from a list of (clump, neighbour) pairs, removing duplicates. The list is sorted in place. */
+        static RSGISClumpNeighbourGraph* createFromEdges(size_t numClumps, std::vector<std::pair<size_t, size_t> > *edges);
+        size_t getNumClumps(){return this->offsets.size()-1;};
+        size_t getNumEdges(){return this->offsets.back();};
+        size_t getNumNeighbours(size_t clump){return this->offsets[clump+1] - this->offsets[clump];};
+        /** Get the n'th neighbour of the clump. */
+        size_t getNeighbour(size_t clump, size_t n)
+        {
+            if(this->wideIdxs)
+            {
+                return this->idxs64[this->offsets[clump] + n];
+            }
+            return this->idxs32[this->offsets[clump] + n];
+        };
+        /** The neighbours of clump i are at [offsets[i], offsets[i+1]) of the (32 or 64 bit) index array. */
+        const uint64_t* getOffsets(){return this->offsets.data();};
+        bool hasWideIdxs(){return this->wideIdxs;};
+        const uint32_t* getIdxs32(){return this->idxs32.data();};
+        const uint64_t* getIdxs64(){return this->idxs64.data();};
+        /** Get the neighbours of the clump as a vector (e.g., for writing back to the RAT). */
+        void getClumpNeighbours(size_t clump, std::vector<size_t> *neighbours);
+        ~RSGISClumpNeighbourGraph(){};
+    protected:
+        size_t numClumps;
+        bool wideIdxs;
+        std::vector<uint64_t> offsets;
+        std::vector<uint32_t> idxs32;
+        std::vector<uint64_t> idxs64;
+    };
+    
+}}
+
+#endif
@@ -0,0 +1,226 @@
+/*
+ *  RSGISClumpTopology.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISClumpTopology.h"
+
+namespace rsgis{namespace rastergis{
+    
+    RSGISClumpTopology::RSGISClumpTopology(GDALDataset *clumpImage, unsigned int band, double xRes, double yRes)
+    {
+        if((band == 0) || (band > ((unsigned int)clumpImage->GetRasterCount())))
+        {
+            throw rsgis::RSGISImageException("The clumps band is not within the image.");
+        }
+        this->xRes = xRes;
+        this->yRes = yRes;
+        this->nonZeroHorizSides.resize(1, 0);
+        this->nonZeroVertSides.resize(1, 0);
+        this->zeroHorizSides.resize(1, 0);
+        this->zeroVertSides.resize(1, 0);
+        
+        GDALRasterBand *clumpBand = clumpImage->GetRasterBand(band);
+        unsigned int width = clumpImage->GetRasterXSize();
+        unsigned int height = clumpImage->GetRasterYSize();
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        clumpBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), width, height, sizeof(unsigned int), rsgis::RSGISExecutionContextUtils::getDefaultContext().stripMemoryMB);
+        
+        // The strip is stored after the last row of the previous strip (row 0 of the buffer).
+        std::vector<unsigned int> stripData(((size_t)width) * (stripRows+1), 0);
+        std::vector<RSGISClumpEdge> stripEdges;
+        
+        rsgis_tqdm pbar;
+        for(unsigned int row = 0; row < height; row += stripRows)
+        {
+            pbar.progress(row, height);
+            unsigned int nRows = std::min(stripRows, height - row);
+            if(row > 0)
+            {
+                std::copy(stripData.begin() + (((size_t)width) * stripRows), stripData.begin() + (((size_t)width) * (stripRows+1)), stripData.begin());
+            }
+            if(clumpBand->RasterIO(GF_Read, 0, row, width, nRows, &stripData[width], width, nRows, GDT_UInt32, 0, 0) != CE_None)
+            {
+                throw rsgis::RSGISImageException("Could not read the clumps image band.");
+            }
+            
+            unsigned int maxVal = *std::max_element(stripData.begin() + width, stripData.begin() + (((size_t)width) * (nRows+1)));
+            if(maxVal >= this->nonZeroHorizSides.size())
+            {
+                this->nonZeroHorizSides.resize(((size_t)maxVal)+1, 0);
+                this->nonZeroVertSides.resize(((size_t)maxVal)+1, 0);
+                this->zeroHorizSides.resize(((size_t)maxVal)+1, 0);
+                this->zeroVertSides.resize(((size_t)maxVal)+1, 0);
+            }
+            
+            for(unsigned int i = 0; i < nRows; ++i)
+            {
+                const unsigned int *rowVals = &stripData[((size_t)(i+1)) * width];
+                const unsigned int *aboveVals = &stripData[((size_t)i) * width];
+                bool topRow = ((row + i) == 0);
+                bool bottomRow = ((row + i + 1) == height);
+                for(unsigned int j = 0; j < width; ++j)
+                {
+                    size_t clump = rowVals[j];
+                    
+                    // The edges of the image are borders with clump 0.
+                    if(j == 0)
+                    {
+                        this->addSide(clump, 0, true, &stripEdges);
+                    }
+                    if((j + 1) == width)
+                    {
+                        this->addSide(clump, 0, true, &stripEdges);
+                    }
+                    else if(rowVals[j+1] != clump)
+                    {
+                        this->addSide(clump, rowVals[j+1], true, &stripEdges);
+                        this->addSide(rowVals[j+1], clump, true, &stripEdges);
+                    }
+                    
+                    if(topRow)
+                    {
+                        this->addSide(clump, 0, false, &stripEdges);
+                    }
+                    else if(aboveVals[j] != clump)
+                    {
+                        this->addSide(clump, aboveVals[j], false, &stripEdges);
+                        this->addSide(aboveVals[j], clump, false, &stripEdges);
+                    }
+                    if(bottomRow)
+                    {
+                        this->addSide(clump, 0, false, &stripEdges);
+                    }
+                }
+            }
+            
+            // Merge the edges of the strips once there are more than have been merged so the cost is amortised.
+            if(stripEdges.size() >= std::max<size_t>(this->edges.size(), 1048576))
+            {
+                this->mergeEdges(&stripEdges);
+            }
+        }
+        this->mergeEdges(&stripEdges);
+        pbar.finish();
+    }
+    
+    double RSGISClumpTopology::getBorderLength(size_t clump, bool includeZeroEdges)
+    {
+        double borderLen = (this->nonZeroHorizSides[clump] * this->yRes) + (this->nonZeroVertSides[clump] * this->xRes);
+        if(includeZeroEdges)
+        {
+            borderLen += this->getZeroEdgeLength(clump);
+        }
+        return borderLen;
+    }
+    
+    RSGISClumpNeighbourGraph* RSGISClumpTopology::createNeighbourGraph()
+    {
+        std::vector<std::pair<size_t, size_t> > neighbourEdges;
+        neighbourEdges.reserve(this->edges.size() * 2);
+        for(std::vector<RSGISClumpEdge>::iterator iterEdge = this->edges.begin(); iterEdge != this->edges.end(); ++iterEdge)
+        {
+            neighbourEdges.push_back(std::pair<size_t, size_t>((*iterEdge).clumpA-1, (*iterEdge).clumpB-1));
+            neighbourEdges.push_back(std::pair<size_t, size_t>((*iterEdge).clumpB-1, (*iterEdge).clumpA-1));
+        }
+        return RSGISClumpNeighbourGraph::createFromEdges(this->getNumClumps()-1, &neighbourEdges);
+    }
+    
+    void RSGISClumpTopology::addSide(size_t clump, size_t neighbour, bool horizontal, std::vector<RSGISClumpEdge> *stripEdges)
+    {
+        if(clump == 0)
+        {
+            return;
+        }
+        
+        if(neighbour == 0)
+        {
+            if(horizontal)
+            {
+                ++this->zeroHorizSides[clump];
+            }
+            else
+            {
+                ++this->zeroVertSides[clump];
+            }
+        }
+        else
+        {
+            if(horizontal)
+            {
+                ++this->nonZeroHorizSides[clump];
+            }
+            else
+            {
+                ++this->nonZeroVertSides[clump];
+            }
+            
+            // Each edge is recorded once (from the clump with the lower ID).
+            if(clump < neighbour)
+            {
+                RSGISClumpEdge edge;
+                edge.clumpA = clump;
+                edge.clumpB = neighbour;
+                edge.numHorizSides = horizontal?1:0;
+                edge.numVertSides = horizontal?0:1;
+                stripEdges->push_back(edge);
+            }
+        }
+    }
+    
+    static bool compareClumpEdges(const RSGISClumpEdge &a, const RSGISClumpEdge &b)
+    {
+        return (a.clumpA < b.clumpA) || ((a.clumpA == b.clumpA) && (a.clumpB < b.clumpB));
+    }
+    
+    void RSGISClumpTopology::mergeEdges(std::vector<RSGISClumpEdge> *stripEdges)
+    {
+        if(stripEdges->empty())
+        {
+            return;
+        }
+        
+        std::vector<RSGISClumpEdge> mergedEdges;
+        mergedEdges.reserve(this->edges.size() + stripEdges->size());
+        std::sort(stripEdges->begin(), stripEdges->end(), compareClumpEdges);
+        std::merge(this->edges.begin(), this->edges.end(), stripEdges->begin(), stripEdges->end(), std::back_inserter(mergedEdges), compareClumpEdges);
+        
+        // Sum the sides of the records of the same pair of clumps.
+        this->edges.clear();
+        for(std::vector<RSGISClumpEdge>::iterator iterEdge = mergedEdges.begin(); iterEdge != mergedEdges.end(); ++iterEdge)
+        {
+            if((!this->edges.empty()) && (this->edges.back().clumpA == (*iterEdge).clumpA) && (this->edges.back().clumpB == (*iterEdge).clumpB))
+            {
+                this->edges.back().numHorizSides += (*iterEdge).numHorizSides;
+                this->edges.back().numVertSides += (*iterEdge).numVertSides;
+            }
+            else
+            {
+                this->edges.push_back(*iterEdge);
+            }
+        }
+        stripEdges->clear();
+    }
+    
+}}
+
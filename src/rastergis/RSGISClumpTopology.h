@@ -0,0 +1,113 @@
+/*
+ *  RSGISClumpTopology.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISClumpTopology_H
+#define RSGISClumpTopology_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISImageException.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/rsgis-tqdm.h"
+
+#include "rastergis/RSGISClumpNeighbourGraph.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_rastergis_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace rastergis{
+    
+    /**
+     * The shared edge of two (non-zero) clumps, counted in pixel sides. A side between
+     * horizontally adjacent pixels has the length of the pixel height (yRes) and a side
+     * between vertically adjacent pixels the length of the pixel width (xRes).
+     */
+    struct DllExport RSGISClumpEdge
+    {
+        size_t clumpA;
+        size_t clumpB;
+        size_t numHorizSides;
+        size_t numVertSides;
+    };
+    
+    /**
+     * The (4 connected) topology of a clumps image found with a single scan of the
+     * image in strips: the pairs of neighbouring clumps with the length of their
+     * shared edge and, for each clump, its border with other clumps and its border
+     * with clump 0 (which includes the edge of the image). The neighbour graph and
+     * the border lengths can then be derived without reading the image again.
+     */
+    class DllExport RSGISClumpTopology
+    {
+    public:
+        RSGISClumpTopology(GDALDataset *clumpImage, unsigned int band, double xRes, double yRes);
+        /** The number of clumps, including clump 0 (i.e., the maximum clump ID + 1). */
+        size_t getNumClumps(){return this->nonZeroHorizSides.size();};
+        /** The number of pairs of neighbouring non-zero clumps (each pair is stored once, with clumpA < clumpB). */
+        size_t getNumEdges(){return this->edges.size();};
+        const RSGISClumpEdge& getEdge(size_t i){return this->edges[i];};
+        double getEdgeLength(size_t i){return (this->edges[i].numHorizSides * this->yRes) + (this->edges[i].numVertSides * this->xRes);};
+        /** The length of the border of the clump with other non-zero clumps, plus with clump 0 if includeZeroEdges. */
+        double getBorderLength(size_t clump, bool includeZeroEdges);
+        /** The length of the border of the clump with clump 0 and the edge of the image. */
+        double getZeroEdgeLength(size_t clump){return (this->zeroHorizSides[clump] * this->yRes) + (this->zeroVertSides[clump] * this->xRes);};
+        /** The number of pixel sides of the clump shared with clump 0 or the edge of the image. */
+        size_t getZeroEdgeCount(size_t clump){return this->zeroHorizSides[clump] + this->zeroVertSides[clump];};
+        /**
+         * Create the neighbour graph of the non-zero clumps, where clump 1 is index 0
+         * (as RSGISFindClumpNeighbours::findNeighbours). The graph is owned by the caller.
+         */
+        RSGISClumpNeighbourGraph* createNeighbourGraph();
+        ~RSGISClumpTopology(){};
+    protected:
+        void addSide(size_t clump, size_t neighbour, bool horizontal, std::vector<RSGISClumpEdge> *stripEdges);
+        void mergeEdges(std::vector<RSGISClumpEdge> *stripEdges);
+        double xRes;
+        double yRes;
+        std::vector<size_t> nonZeroHorizSides;
+        std::vector<size_t> nonZeroVertSides;
+        std::vector<size_t> zeroHorizSides;
+        std::vector<size_t> zeroVertSides;
+        std::vector<RSGISClumpEdge> edges;
+    };
+    
+}}
+
+#endif
+
@@ -60,11 +60,10 @@ namespace rsgis{namespace rastergis{
             
             size_t outAttRowCount = fidCount;
             
-            rsgis::img::RSGISCalcImageValue *collapseGenNewImg = new RSGISCollapseRATPopNewImage(collapsedIDs, numRows, ratBand);
-            rsgis::img::RSGISCalcImage imgCalc = rsgis::img::RSGISCalcImage(collapseGenNewImg);
-            imgCalc.calcImage(&inputClumps, 1, 0, outImage, false, NULL, gdalFormat, GDT_UInt32);
-            delete collapseGenNewImg;
+            std::vector<uint32_t> collapseLUT(collapsedIDs, collapsedIDs+numRows);
             delete[] collapsedIDs;
+            rsgis::img::RSGISRelabelImageLUT relabelImg;
+            relabelImg.relabelImage(inputClumps, ratBand, outImage, gdalFormat, GDT_UInt32, collapseLUT);
             
             GDALDataset *outClumpsDataset = (GDALDataset *) GDALOpenShared(outImage.c_str(), GA_Update);
             if(outClumpsDataset == NULL)
@@ -40,6 +40,7 @@
 
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISRelabelImageLUT.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -74,7 +74,7 @@ namespace rsgis{namespace rastergis{
 
             delete[] datasets;
             
-            int *colVals = new int[numRows];
+            int *colVals = new int[numRows]();
             for(size_t i = 1; i < numRows; ++i)
             {
                 if(clumpTilePos[i].boundary)
@@ -172,7 +172,7 @@ namespace rsgis{namespace rastergis{
                 throw rsgis::RSGISAttributeTableException("Current and new RAT have different number of records. Bad programming is here.");
             }            
                      
-            int *colVals = new int[numRows];
+            int *colVals = new int[numRows]();
             for(size_t i = 1; i < numRows; ++i)
             {
                 if((clumpTilePos[i].boundary) && (currentColVals[i] != tileOverlap))
@@ -30,19 +30,31 @@ namespace rsgis{namespace rastergis{
         
     }
     
-    void RSGISExportClumps2Images::exportClumps2Images(GDALDataset *clumpsDataset, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, std::string minXPxl, std::string maxXPxl, std::string minYPxl, std::string maxYPxl, std::string tlX, std::string tlY, unsigned int ratBand)
+    void RSGISExportClumps2Images::exportClumps2Images(GDALDataset *clumpsDataset, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, std::string minXPxl, std::string maxXPxl, std::string minYPxl, std::string maxYPxl, std::string tlX, std::string tlY, unsigned int ratBand, unsigned int maxOpenOutputs)
     {
+        std::list<RSGISClumpExportOutput> openOutputs;
         try
         {
+            if((ratBand == 0) || (ratBand > ((unsigned int)clumpsDataset->GetRasterCount())))
+            {
+                throw RSGISAttributeTableException("The RAT band is not within the image.");
+            }
+            if(maxOpenOutputs == 0)
+            {
+                throw rsgis::RSGISImageException("At least one output image must be allowed to be open.");
+            }
+            
             RSGISRasterAttUtils attUtils;
-            GDALRasterAttributeTable *attTable = clumpsDataset->GetRasterBand(ratBand)->GetDefaultRAT();
+            GDALRasterBand *clumpsBand = clumpsDataset->GetRasterBand(ratBand);
+            GDALRasterAttributeTable *attTable = clumpsBand->GetDefaultRAT();
             if(attTable == NULL)
             {
                 throw RSGISAttributeTableException("GDAL Dataset does not have a RAT.");
             }
             
             size_t numRows = attTable->GetRowCount();
-            
+            unsigned int width = clumpsDataset->GetRasterXSize();
+            unsigned int height = clumpsDataset->GetRasterYSize();
             
             std::vector<int> *minXPxlVals = attUtils.readIntColumnAsVec(attTable, minXPxl);
             std::vector<int> *maxXPxlVals = attUtils.readIntColumnAsVec(attTable, maxXPxl);
@@ -60,9 +72,24 @@ namespace rsgis{namespace rastergis{
 
             std::cout << "Res: [" << geoTransform[1] << ", " << geoTransform[5] << "]\n";
             
-            unsigned int xSize = 0;
-            unsigned int ySize = 0;
-            double *outTransform = new double[6];
+            // The clumps to export in order of the first row of their bounding box.
+            std::vector<size_t> exportFIDs;
+            for(size_t i = 1; i < numRows; ++i)
+            {
+                if( (maxXPxlVals->at(i) > 0) | (maxYPxlVals->at(i) > 0) )
+                {
+                    if((minXPxlVals->at(i) < 0) || (minYPxlVals->at(i) < 0) || (minXPxlVals->at(i) > maxXPxlVals->at(i)) || (minYPxlVals->at(i) > maxYPxlVals->at(i)) || (((unsigned int)maxXPxlVals->at(i)) >= width) || (((unsigned int)maxYPxlVals->at(i)) >= height))
+                    {
+                        throw rsgis::RSGISImageException("The pixel extent of clump " + std::to_string(i) + " is not within the image.");
+                    }
+                    exportFIDs.push_back(i);
+                }
+            }
+            std::stable_sort(exportFIDs.begin(), exportFIDs.end(), [&](size_t a, size_t b){return minYPxlVals->at(a) < minYPxlVals->at(b);});
+            size_t numExport = exportFIDs.size();
+            std::cout << "Exporting " << numExport << " clumps\n";
+            
+            double outTransform[6];
             outTransform[0] = 0.0; // X Origin.
             outTransform[1] = geoTransform[1];
             outTransform[2] = geoTransform[2];
@@ -70,65 +97,145 @@ namespace rsgis{namespace rastergis{
             outTransform[4] = geoTransform[4];
             outTransform[5] = geoTransform[5];
             
-            GDALDataset *outClumpImg = NULL;
-            GDALDataset **datasets = new GDALDataset*[2];
-            datasets[0] = clumpsDataset;
+            int xBlockSize = 0;
+            int yBlockSize = 0;
+            clumpsBand->GetBlockSize(&xBlockSize, &yBlockSize);
+            unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), width, height, sizeof(unsigned int), rsgis::RSGISExecutionContextUtils::getDefaultContext().stripMemoryMB);
+            std::vector<unsigned int> stripData(((size_t)width) * stripRows, 0);
+            std::vector<unsigned int> outData;
+            
             RSGISPopulateWithImageStats addClrTab;
-            RSGISCopyImageBand4ClumpExport valueCalc = RSGISCopyImageBand4ClumpExport(ratBand, 0, binaryOut);
-            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&valueCalc);
             rsgis::img::RSGISImageUtils imgUtils;
             rsgis::utils::RSGISTextUtils textUtils;
-            for(size_t i = 1; i < numRows; ++i)
+            std::string projection = std::string(clumpsDataset->GetProjectionRef());
+            size_t numExported = 0;
+            rsgis_tqdm pbar;
+            while(!exportFIDs.empty())
             {
-                if( (maxXPxlVals->at(i) > 0) | (maxYPxlVals->at(i) > 0) )
+                // The clumps which did not fit within maxOpenOutputs are exported by the next pass.
+                std::vector<size_t> deferredFIDs;
+                size_t nextIdx = 0;
+                unsigned int row = minYPxlVals->at(exportFIDs[0]);
+                while((nextIdx < exportFIDs.size()) || (!openOutputs.empty()))
                 {
-                    std::string outImgFileName = outImgBase + "C" + textUtils.sizettostring(i) + "." + imgFileExt;
-                    std::cout << "Output Img: " << outImgFileName << std::endl;
-                    
-                    xSize = (maxXPxlVals->at(i) - minXPxlVals->at(i)) + 1;
-                    ySize = (maxYPxlVals->at(i) - minYPxlVals->at(i)) + 1;
-                    
-                    std::cout << "Size: [" << xSize << ", " << ySize << "]\n";
-                    std::cout << "TL: [" << tlXVals->at(i) << ", " << tlYVals->at(i) << "]\n";
+                    if(openOutputs.empty() && (((unsigned int)minYPxlVals->at(exportFIDs[nextIdx])) > row))
+                    {
+                        // Skip the rows which no clump of this pass covers.
+                        row = minYPxlVals->at(exportFIDs[nextIdx]);
+                    }
+                    unsigned int nRows = std::min(stripRows, height - row);
                     
-                    outTransform[0] = tlXVals->at(i);
-                    outTransform[3] = tlYVals->at(i);
+                    // Create the outputs of the clumps which start within the strip.
+                    for(; (nextIdx < exportFIDs.size()) && (((unsigned int)minYPxlVals->at(exportFIDs[nextIdx])) < (row + nRows)); ++nextIdx)
+                    {
+                        size_t fid = exportFIDs[nextIdx];
+                        if(openOutputs.size() >= maxOpenOutputs)
+                        {
+                            deferredFIDs.push_back(fid);
+                            continue;
+                        }
+                        std::string outImgFileName = outImgBase + "C" + textUtils.sizettostring(fid) + "." + imgFileExt;
+                        unsigned int xSize = (maxXPxlVals->at(fid) - minXPxlVals->at(fid)) + 1;
+                        unsigned int ySize = (maxYPxlVals->at(fid) - minYPxlVals->at(fid)) + 1;
+                        outTransform[0] = tlXVals->at(fid);
+                        outTransform[3] = tlYVals->at(fid);
+                        
+                        RSGISClumpExportOutput output;
+                        output.fid = fid;
+                        output.dataset = imgUtils.createBlankImage(outImgFileName, outTransform, xSize, ySize, 1, projection, 0.0, imageFormat, GDT_UInt32);
+                        openOutputs.push_back(output);
+                    }
                     
-                    outClumpImg = imgUtils.createBlankImage(outImgFileName, outTransform, xSize, ySize, 1, "", 0.0, imageFormat, GDT_UInt32);
-                    outClumpImg->SetProjection(clumpsDataset->GetProjectionRef());
-                    GDALClose(outClumpImg);
-                    
-                    valueCalc.setFid(i);
-                    outClumpImg = (GDALDataset *) GDALOpen(outImgFileName.c_str(), GA_Update);
-                    datasets[1] = outClumpImg;
-                    calcImage.calcImage(datasets, 2, 0, outClumpImg);
-                    addClrTab.populateImageWithRasterGISStats(outClumpImg, true, true, 1);
-                    GDALClose(outClumpImg);
+                    if(clumpsBand->RasterIO(GF_Read, 0, row, width, nRows, stripData.data(), width, nRows, GDT_UInt32, 0, 0) != CE_None)
+                    {
+                        throw rsgis::RSGISImageException("Could not read the clumps image band.");
+                    }
                     
+                    std::list<RSGISClumpExportOutput>::iterator iterOut = openOutputs.begin();
+                    while(iterOut != openOutputs.end())
+                    {
+                        size_t fid = (*iterOut).fid;
+                        unsigned int minX = minXPxlVals->at(fid);
+                        unsigned int minY = minYPxlVals->at(fid);
+                        unsigned int maxY = maxYPxlVals->at(fid);
+                        unsigned int xSize = (maxXPxlVals->at(fid) - minX) + 1;
+                        unsigned int startRow = std::max(minY, row);
+                        unsigned int endRow = std::min(maxY + 1, row + nRows);
+                        unsigned int outVal = binaryOut?1:fid;
+                        
+                        outData.resize(((size_t)xSize) * (endRow - startRow));
+                        for(unsigned int y = startRow; y < endRow; ++y)
+                        {
+                            const unsigned int *stripRow = &stripData[(((size_t)(y - row)) * width) + minX];
+                            unsigned int *outRow = &outData[((size_t)(y - startRow)) * xSize];
+                            for(unsigned int x = 0; x < xSize; ++x)
+                            {
+                                outRow[x] = (stripRow[x] == fid)?outVal:0;
+                            }
+                        }
+                        if((*iterOut).dataset->GetRasterBand(1)->RasterIO(GF_Write, 0, startRow - minY, xSize, endRow - startRow, outData.data(), xSize, endRow - startRow, GDT_UInt32, 0, 0) != CE_None)
+                        {
+                            throw rsgis::RSGISImageException("Could not write the image of clump " + textUtils.sizettostring(fid) + ".");
+                        }
+                        
+                        if(endRow == (maxY + 1))
+                        {
+                            // The last row of the clump has been written.
+                            addClrTab.populateImageWithRasterGISStats((*iterOut).dataset, true, true, 1);
+                            GDALClose((*iterOut).dataset);
+                            iterOut = openOutputs.erase(iterOut);
+                            pbar.progress(++numExported, numExport);
+                        }
+                        else
+                        {
+                            ++iterOut;
+                        }
+                    }
+                    row += nRows;
                 }
+                exportFIDs = deferredFIDs;
             }
-            delete[] datasets;
+            pbar.finish();
             
+            delete minXPxlVals;
+            delete maxXPxlVals;
+            delete minYPxlVals;
+            delete maxYPxlVals;
+            delete tlXVals;
+            delete tlYVals;
         }
         catch(RSGISAttributeTableException &e)
         {
+            this->closeOutputs(&openOutputs);
             throw rsgis::RSGISImageException(e.what());
         }
         catch(rsgis::img::RSGISImageBandException &e)
         {
+            this->closeOutputs(&openOutputs);
             throw e;
         }
         catch(rsgis::RSGISImageException &e)
         {
+            this->closeOutputs(&openOutputs);
             throw rsgis::RSGISImageException(e.what());
         }
         catch(std::exception &e)
         {
+            this->closeOutputs(&openOutputs);
             throw rsgis::RSGISImageException(e.what());
         }
 
     }
     
+    void RSGISExportClumps2Images::closeOutputs(std::list<RSGISClumpExportOutput> *openOutputs)
+    {
+        for(std::list<RSGISClumpExportOutput>::iterator iterOut = openOutputs->begin(); iterOut != openOutputs->end(); ++iterOut)
+        {
+            GDALClose((*iterOut).dataset);
+        }
+        openOutputs->clear();
+    }
+    
     RSGISExportClumps2Images::~RSGISExportClumps2Images()
     {
         
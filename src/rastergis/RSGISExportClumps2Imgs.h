@@ -23,8 +23,12 @@
 #ifndef RSGISExportClumps2Imgs_H
 #define RSGISExportClumps2Imgs_H
 
+#define RSGIS_CLUMP_EXPORT_MAX_OPEN_OUTPUTS 256 // Define the default number of output images RSGISExportClumps2Images has open at once
+
 #include <iostream>
 #include <string>
+#include <vector>
+#include <list>
 #include <cmath>
 #include <algorithm>
 
@@ -33,6 +37,8 @@
 
 #include "common/RSGISAttributeTableException.h"
 #include "common/RSGISImageException.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/rsgis-tqdm.h"
 
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
@@ -62,12 +68,29 @@
 
 namespace rsgis{namespace rastergis{
     
+    /** An output image of RSGISExportClumps2Images which is being written. */
+    struct DllExport RSGISClumpExportOutput
+    {
+        size_t fid;
+        GDALDataset *dataset;
+    };
+    
+    /**
+     * Exports each clump to an image of its bounding box (from the pixel extent columns
+     * of the RAT). The clumps image is read in strips and the rows of each strip are
+     * written to the output images of the clumps which intersect it, so an output is
+     * open from the first to the last row of its bounding box. If more than
+     * maxOpenOutputs clumps would be open at once the extra clumps are left to another
+     * pass, which only reads the rows of the clumps image those clumps cover.
+     */
     class DllExport RSGISExportClumps2Images
     {
     public:
         RSGISExportClumps2Images();
-        void exportClumps2Images(GDALDataset *clumpsDataset, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, std::string minXPxl, std::string maxXPxl, std::string minYPxl, std::string maxYPxl, std::string tlX, std::string tlY, unsigned int ratBand=1);
+        void exportClumps2Images(GDALDataset *clumpsDataset, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, std::string minXPxl, std::string maxXPxl, std::string minYPxl, std::string maxYPxl, std::string tlX, std::string tlY, unsigned int ratBand=1, unsigned int maxOpenOutputs=RSGIS_CLUMP_EXPORT_MAX_OPEN_OUTPUTS);
         ~RSGISExportClumps2Images();
+    protected:
+        void closeOutputs(std::list<RSGISClumpExportOutput> *openOutputs);
     };
     
     
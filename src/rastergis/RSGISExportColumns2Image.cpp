@@ -120,6 +120,95 @@ namespace rsgis{namespace rastergis{
     {
         delete[] this->columnData;
     }
+    
+    
+    RSGISExportColumns2Image::RSGISExportColumns2Image(unsigned int numThreads)
+    {
+        this->numThreads = numThreads;
+    }
+    
+    void RSGISExportColumns2Image::exportColumn2Image(GDALDataset *clumpsImage, unsigned int ratBand, unsigned int columnIndex, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType, std::string bandName)
+    {
+        try
+        {
+            if((ratBand == 0) || (ratBand > ((unsigned int)clumpsImage->GetRasterCount())))
+            {
+                throw rsgis::RSGISAttributeTableException("The RAT band is not within the clumps image.");
+            }
+            std::vector<double> colLUT = this->readColumnLUT(clumpsImage->GetRasterBand(ratBand)->GetDefaultRAT(), columnIndex);
+            
+            rsgis::img::RSGISRelabelImageLUT relabelImg(this->numThreads);
+            relabelImg.relabelImage(clumpsImage, ratBand, outputImage, gdalFormat, gdalDataType, colLUT, bandName);
+        }
+        catch(rsgis::RSGISAttributeTableException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw rsgis::RSGISAttributeTableException(e.what());
+        }
+    }
+    
+    void RSGISExportColumns2Image::exportColumn2Image(GDALDataset *clumpsImage, unsigned int ratBand, unsigned int columnIndex, GDALDataset *outImage, unsigned int outBand)
+    {
+        try
+        {
+            if((ratBand == 0) || (ratBand > ((unsigned int)clumpsImage->GetRasterCount())))
+            {
+                throw rsgis::RSGISAttributeTableException("The RAT band is not within the clumps image.");
+            }
+            std::vector<double> colLUT = this->readColumnLUT(clumpsImage->GetRasterBand(ratBand)->GetDefaultRAT(), columnIndex);
+            
+            rsgis::img::RSGISRelabelImageLUT relabelImg(this->numThreads);
+            relabelImg.relabelImage(clumpsImage, ratBand, outImage, outBand, colLUT);
+        }
+        catch(rsgis::RSGISAttributeTableException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw rsgis::RSGISAttributeTableException(e.what());
+        }
+    }
+    
+    std::vector<double> RSGISExportColumns2Image::readColumnLUT(GDALRasterAttributeTable *attTable, unsigned int columnIndex)
+    {
+        if(attTable == NULL)
+        {
+            throw rsgis::RSGISAttributeTableException("The clumps image does not have an attribute table.");
+        }
+        size_t nRows = attTable->GetRowCount();
+        if(nRows == 0)
+        {
+            throw rsgis::RSGISAttributeTableException("There are no rows in the input attribute table.");
+        }
+        if(columnIndex >= ((unsigned int)attTable->GetColumnCount()))
+        {
+            throw rsgis::RSGISAttributeTableException("The column is not within the attribute table.");
+        }
+        if(attTable->GetTypeOfCol(columnIndex) == GFT_String)
+        {
+            throw rsgis::RSGISAttributeTableException("Can't export a column containing strings to an image");
+        }
+        
+        std::vector<double> colLUT(nRows);
+        for(size_t rowOffset = 0; rowOffset < nRows; rowOffset += RAT_BLOCK_LENGTH)
+        {
+            size_t nBlockRows = std::min<size_t>(RAT_BLOCK_LENGTH, nRows - rowOffset);
+            attTable->ValuesIO(GF_Read, columnIndex, rowOffset, nBlockRows, &colLUT[rowOffset]);
+        }
+        // Clump 0 is no data so is always output as 0.
+        colLUT[0] = 0;
+        
+        return colLUT;
+    }
+    
+    RSGISExportColumns2Image::~RSGISExportColumns2Image()
+    {
+        
+    }
 
 }}
 
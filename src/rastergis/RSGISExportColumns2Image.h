@@ -27,6 +27,7 @@
 #include <string>
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 #include "gdal_priv.h"
 #include "gdal_rat.h"
@@ -38,6 +39,7 @@
 
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
+#include "img/RSGISRelabelImageLUT.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
 
@@ -71,6 +73,23 @@ namespace rsgis{namespace rastergis{
         unsigned int nRows;
         double *columnData;
 	};
+    
+    /**
+     * Export a column of the RAT to an image using the block-wise look up table
+     * relabelling of rsgis::img::RSGISRelabelImageLUT, where clump 0 is always
+     * output as 0. Clump IDs outside of the RAT result in an exception.
+     */
+    class DllExport RSGISExportColumns2Image
+    {
+    public:
+        RSGISExportColumns2Image(unsigned int numThreads=1);
+        void exportColumn2Image(GDALDataset *clumpsImage, unsigned int ratBand, unsigned int columnIndex, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType, std::string bandName="");
+        void exportColumn2Image(GDALDataset *clumpsImage, unsigned int ratBand, unsigned int columnIndex, GDALDataset *outImage, unsigned int outBand=1);
+        ~RSGISExportColumns2Image();
+    protected:
+        std::vector<double> readColumnLUT(GDALRasterAttributeTable *attTable, unsigned int columnIndex);
+        unsigned int numThreads;
+    };
 	
 }}
 
@@ -64,7 +64,7 @@ namespace rsgis{namespace rastergis{
             long maxVal = 0;
             attUtils.getImageBandMinMax(clumpsDS, ratBandClumps, &minVal, &maxVal);
             
-            if(maxVal > numRows)
+            if(maxVal >= numRows)
             {
                 attTableClumps->SetRowCount(maxVal+1);
                 numRows = maxVal+1;
@@ -130,6 +130,7 @@ namespace rsgis{namespace rastergis{
                     cats->insert(std::pair<size_t,CategoryField>(catField.category, catField));
                 }
             }
+            delete[] catsCount;
                         
             std::cout << "Categories Found\n";
             for(std::map<size_t,CategoryField>::iterator iterCats = cats->begin(); iterCats != cats->end(); ++iterCats)
@@ -138,192 +139,77 @@ namespace rsgis{namespace rastergis{
             }
             std::cout << std::endl;
             
-            // Calculate the ratios.
-            unsigned int **catStats = new unsigned int*[numRows];
-            for(size_t i = 0; i < numRows; ++i)
+            // Count the pixels of each category within each clump.
+            std::vector<int> catLocalIdxs(numCatVals, -1);
+            std::vector<std::map<size_t,CategoryField>::iterator> catsList;
+            for(std::map<size_t,CategoryField>::iterator iterCats = cats->begin(); iterCats != cats->end(); ++iterCats)
             {
-                catStats[i] = new unsigned int[numCatVals];
-                for(unsigned int j = 0; j < numCatVals; ++j)
-                {
-                    catStats[i][j] = 0;
-                }
+                (*iterCats).second.localIdx = catsList.size();
+                catLocalIdxs[(*iterCats).first - minCat] = catsList.size();
+                catsList.push_back(iterCats);
             }
+            unsigned int numCats = catsList.size();
+            RSGISClumpCategoryCounts catCounts(clumpsDS, numRows, numCats);
             
             unsigned int ratClumpsBandIdx = ratBandClumps - 1;
             unsigned int ratCatsBandIdx = clumpsDS->GetRasterCount() + ratBandCats - 1;
             datasets[0] = clumpsDS;
             datasets[1] = catsDS;
-            RSGISCountNumPxlsInCatsPerClump *calcCatClumpCounts = new RSGISCountNumPxlsInCatsPerClump(catStats, cats, ratClumpsBandIdx, ratCatsBandIdx);
+            RSGISCountNumPxlsInCatsPerClump *calcCatClumpCounts = new RSGISCountNumPxlsInCatsPerClump(&catCounts, &catLocalIdxs, ratClumpsBandIdx, ratCatsBandIdx);
             rsgis::img::RSGISCalcImage calcImageCatClumpCounts(calcCatClumpCounts);
             calcImageCatClumpCounts.calcImage(datasets, 2, 0);
+            calcCatClumpCounts->flush();
             delete calcCatClumpCounts;
             delete[] datasets;
             
+            // Write the proportions of all the categories and the majority, block by block, in a single sweep of the RAT.
             std::cout << "Writing Majority Values to Output RAT\n";
-            size_t numBlocks = floor((double)numRows/(double)RAT_BLOCK_LENGTH);
-            size_t rowsRemain = numRows - (numBlocks * RAT_BLOCK_LENGTH);
-            
-            rsgis::math::RSGISMathsUtils mathUtils;
-            double *dataBlock = new double[RAT_BLOCK_LENGTH];
-            double *histDataBlock = new double[RAT_BLOCK_LENGTH];
-            
-            int *majBlock = new int[RAT_BLOCK_LENGTH];
-            double *majBlockProp = new double[RAT_BLOCK_LENGTH];
-            bool *majBlockFirst = new bool[RAT_BLOCK_LENGTH];
-            for(size_t j = 0; j < RAT_BLOCK_LENGTH; ++j)
-            {
-                majBlock[j] = -1;
-                majBlockProp[j] = 0;
-                majBlockFirst[j] = true;
-            }
-            char **majClassNamesBlock = NULL;
-            if(copyClassName)
-            {
-                majClassNamesBlock = new char*[RAT_BLOCK_LENGTH];
-            }
-            size_t startRow = 0;
-            size_t rowID = 0;
-            
-            for(size_t i = 0; i < numBlocks; ++i)
+            std::vector<double> histDataBlock(RAT_BLOCK_LENGTH);
+            std::vector< std::vector<double> > propBlocks(numCats, std::vector<double>(RAT_BLOCK_LENGTH));
+            std::vector<int> majBlock(RAT_BLOCK_LENGTH);
+            std::vector<char*> majClassNamesBlock(RAT_BLOCK_LENGTH);
+            for(size_t startRow = 0; startRow < numRows; startRow += RAT_BLOCK_LENGTH)
             {
-                attTableClumps->ValuesIO(GF_Read, histoIdx, startRow, RAT_BLOCK_LENGTH, histDataBlock);
-                for(size_t j = 0; j < RAT_BLOCK_LENGTH; ++j)
+                size_t blockLen = std::min<size_t>(RAT_BLOCK_LENGTH, numRows - startRow);
+                attTableClumps->ValuesIO(GF_Read, histoIdx, startRow, blockLen, histDataBlock.data());
+                for(size_t j = 0; j < blockLen; ++j)
                 {
-                    majBlock[j] = -1;
-                    majBlockProp[j] = 0;
-                    majBlockFirst[j] = true;
-                    if(copyClassName)
-                    {
-                        majClassNamesBlock[j] = RSGIS_C_TEXT("");
-                    }
-                }
-                for(std::map<size_t,CategoryField>::iterator iterCats = cats->begin(); iterCats != cats->end(); ++iterCats)
-                {
-                    rowID = startRow;
-                    for(size_t j = 0; j < RAT_BLOCK_LENGTH; ++j)
+                    const unsigned int *clumpCounts = catCounts.getClumpCounts(startRow + j);
+                    // The majority is the first category with the largest (non-zero) proportion.
+                    int majCat = -1;
+                    double majProp = 0;
+                    for(unsigned int c = 0; c < numCats; ++c)
                     {
+                        double prop = 0.0;
                         if(histDataBlock[j] > 0)
                         {
-                            dataBlock[j] = ((double)catStats[rowID][(*iterCats).second.localIdx]) / ((double)histDataBlock[j]);
-
-                            if(majBlockFirst[j])
-                            {
-                                if(dataBlock[j] > 0)
-                                {
-                                    majBlock[j] = (*iterCats).first;
-                                    majBlockProp[j] = dataBlock[j];
-                                    majBlockFirst[j] = false;
-                                    if(copyClassName)
-                                    {
-                                        majClassNamesBlock[j] = const_cast<char*>((*iterCats).second.className.c_str());
-                                    }
-                                }
-                            }
-                            else if(dataBlock[j] > majBlockProp[j])
-                            {
-                                majBlock[j] = (*iterCats).first;
-                                majBlockProp[j] = dataBlock[j];
-                                if(copyClassName)
-                                {
-                                    majClassNamesBlock[j] = const_cast<char*>((*iterCats).second.className.c_str());
-                                }
-                            }
+                            prop = ((double)clumpCounts[c]) / histDataBlock[j];
                         }
-                        else
+                        propBlocks[c][j] = prop;
+                        if(prop > majProp)
                         {
-                            dataBlock[j] = 0.0;
+                            majCat = c;
+                            majProp = prop;
                         }
-                        ++rowID;
                     }
-                    attTableClumps->ValuesIO(GF_Write, (*iterCats).second.fieldIdx, startRow, RAT_BLOCK_LENGTH, dataBlock);
-                }
-                attTableClumps->ValuesIO(GF_Write, majorityColIdx, startRow, RAT_BLOCK_LENGTH, majBlock);
-                if(copyClassName)
-                {
-                    attTableClumps->ValuesIO(GF_Write, majClassNameColIdx, startRow, RAT_BLOCK_LENGTH, majClassNamesBlock);
-                }
-                
-                startRow += RAT_BLOCK_LENGTH;
-            }
-            if(rowsRemain > 0)
-            {
-                attTableClumps->ValuesIO(GF_Read, histoIdx, startRow, rowsRemain, histDataBlock);
-                for(size_t j = 0; j < RAT_BLOCK_LENGTH; ++j)
-                {
-                    majBlock[j] = -1;
-                    majBlockProp[j] = 0;
-                    majBlockFirst[j] = true;
+                    majBlock[j] = (majCat < 0)?-1:((int)(*catsList[majCat]).first);
                     if(copyClassName)
                     {
-                        majClassNamesBlock[j] = RSGIS_C_TEXT("");
+                        majClassNamesBlock[j] = (majCat < 0)?RSGIS_C_TEXT(""):const_cast<char*>((*catsList[majCat]).second.className.c_str());
                     }
                 }
-                for(std::map<size_t,CategoryField>::iterator iterCats = cats->begin(); iterCats != cats->end(); ++iterCats)
+                for(unsigned int c = 0; c < numCats; ++c)
                 {
-                    rowID = startRow;
-                    for(size_t j = 0; j < rowsRemain; ++j)
-                    {
-                        if(histDataBlock[j] > 0)
-                        {
-                            dataBlock[j] = ((double)catStats[rowID][(*iterCats).second.localIdx]) / ((double)histDataBlock[j]);
-
-                            if(majBlockFirst[j])
-                            {
-                                if(dataBlock[j] > 0)
-                                {
-                                    majBlock[j] = (*iterCats).first;
-                                    majBlockProp[j] = dataBlock[j];
-                                    majBlockFirst[j] = false;
-                                    if(copyClassName)
-                                    {
-                                        majClassNamesBlock[j] = const_cast<char*>((*iterCats).second.className.c_str());
-                                    }
-                                }
-                            }
-                            else if(dataBlock[j] > majBlockProp[j])
-                            {
-                                majBlock[j] = (*iterCats).first;
-                                majBlockProp[j] = dataBlock[j];
-                                if(copyClassName)
-                                {
-                                    majClassNamesBlock[j] = const_cast<char*>((*iterCats).second.className.c_str());
-                                }
-                            }
-                        }
-                        else
-                        {
-                            dataBlock[j] = 0.0;
-                        }
-                        
-                        ++rowID;
-                    }
-                    attTableClumps->ValuesIO(GF_Write, (*iterCats).second.fieldIdx, startRow, rowsRemain, dataBlock);
+                    attTableClumps->ValuesIO(GF_Write, (*catsList[c]).second.fieldIdx, startRow, blockLen, propBlocks[c].data());
                 }
-                attTableClumps->ValuesIO(GF_Write, majorityColIdx, startRow, rowsRemain, majBlock);
+                attTableClumps->ValuesIO(GF_Write, majorityColIdx, startRow, blockLen, majBlock.data());
                 if(copyClassName)
                 {
-                    attTableClumps->ValuesIO(GF_Write, majClassNameColIdx, startRow, rowsRemain, majClassNamesBlock);
+                    attTableClumps->ValuesIO(GF_Write, majClassNameColIdx, startRow, blockLen, majClassNamesBlock.data());
                 }
             }
-
-            delete[] dataBlock;
-            delete[] histDataBlock;
             
-            delete[] majBlock;
-            delete[] majBlockProp;
-            delete[] majBlockFirst;
-            if(copyClassName)
-            {
-                delete[] majClassNamesBlock;
-            }
-            
-            
-            
-            for(size_t i = 0; i < numRows; ++i)
-            {
-                delete[] catStats[i];
-            }
-            delete[] catStats;
+            delete cats;
         }
         catch(rsgis::img::RSGISImageBandException &e)
         {
@@ -361,6 +247,11 @@ namespace rsgis{namespace rastergis{
         this->minCat = minCat;
         this->numCatVals = numCatVals;
         this->ratBandCats = ratBandCats;
+        if(this->catsCount == NULL)
+        {
+            this->localCatsCount.resize(numCatVals, 0);
+            this->catsCount = this->localCatsCount.data();
+        }
     }
     
     void RSGISCountNumPxlsInCats::calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals) 
@@ -369,6 +260,20 @@ namespace rsgis{namespace rastergis{
         ++catsCount[cat-minCat];
     }
     
+    rsgis::img::RSGISCalcImageValue* RSGISCountNumPxlsInCats::clone()
+    {
+        return new RSGISCountNumPxlsInCats(NULL, this->minCat, this->numCatVals, this->ratBandCats);
+    }
+    
+    void RSGISCountNumPxlsInCats::reduce(rsgis::img::RSGISCalcImageValue *other)
+    {
+        RSGISCountNumPxlsInCats *otherCalc = static_cast<RSGISCountNumPxlsInCats*>(other);
+        for(size_t i = 0; i < this->numCatVals; ++i)
+        {
+            this->catsCount[i] += otherCalc->catsCount[i];
+        }
+    }
+    
     RSGISCountNumPxlsInCats::~RSGISCountNumPxlsInCats()
     {
         
@@ -380,36 +285,63 @@ namespace rsgis{namespace rastergis{
     
     
     
-    RSGISCountNumPxlsInCatsPerClump::RSGISCountNumPxlsInCatsPerClump(unsigned int **catStats, std::map<size_t,CategoryField> *cats, unsigned int ratClumpsBand, unsigned int ratCatsBand) : rsgis::img::RSGISCalcImageValue(0)
+    RSGISCountNumPxlsInCatsPerClump::RSGISCountNumPxlsInCatsPerClump(RSGISClumpCategoryCounts *catCounts, std::vector<int> *catLocalIdxs, unsigned int ratClumpsBand, unsigned int ratCatsBand) : rsgis::img::RSGISCalcImageValue(0)
     {
-        this->catStats = catStats;
-        this->cats = cats;
+        this->catCounts = catCounts;
+        this->catLocalIdxs = catLocalIdxs;
         this->ratClumpsBand = ratClumpsBand;
         this->ratCatsBand = ratCatsBand;
+        this->maxBatchLen = 65536;
+        this->batch.reserve(this->maxBatchLen);
     }
 		
     void RSGISCountNumPxlsInCatsPerClump::calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals) 
     {
         if(intBandValues[ratClumpsBand] > 0)
         {
-            size_t fid = boost::lexical_cast<size_t>(intBandValues[ratClumpsBand]);
-            size_t cat = boost::lexical_cast<size_t>(intBandValues[ratCatsBand]);
-            size_t localIdx = 0;
-            
-            std::map<size_t,CategoryField>::iterator iterCats = cats->find(cat);
-            if(iterCats == cats->end())
+            size_t fid = intBandValues[ratClumpsBand];
+            long cat = intBandValues[ratCatsBand];
+            if((cat < 0) || (((size_t)cat) >= this->catLocalIdxs->size()) || ((*this->catLocalIdxs)[cat] < 0))
             {
                 std::cout << "FID: " << fid << std::endl;
                 std::cout << "Cat: " << cat << std::endl;
                 throw rsgis::img::RSGISImageCalcException("Could not find the catergory.");
             }
             
-            localIdx = (*iterCats).second.localIdx;
-            
-            ++this->catStats[fid][localIdx];
+            size_t cell = (fid * this->catCounts->getNumCats()) + (*this->catLocalIdxs)[cat];
+            if((!this->batch.empty()) && (this->batch.back().cell == cell))
+            {
+                ++this->batch.back().count;
+            }
+            else
+            {
+                if(this->batch.size() == this->maxBatchLen)
+                {
+                    this->catCounts->addCounts(&this->batch);
+                }
+                RSGISClumpCategoryCount count;
+                count.cell = cell;
+                count.count = 1;
+                this->batch.push_back(count);
+            }
         }
     }
     
+    rsgis::img::RSGISCalcImageValue* RSGISCountNumPxlsInCatsPerClump::clone()
+    {
+        return new RSGISCountNumPxlsInCatsPerClump(this->catCounts, this->catLocalIdxs, this->ratClumpsBand, this->ratCatsBand);
+    }
+    
+    void RSGISCountNumPxlsInCatsPerClump::reduce(rsgis::img::RSGISCalcImageValue *other)
+    {
+        static_cast<RSGISCountNumPxlsInCatsPerClump*>(other)->flush();
+    }
+    
+    void RSGISCountNumPxlsInCatsPerClump::flush()
+    {
+        this->catCounts->addCounts(&this->batch);
+    }
+    
     RSGISCountNumPxlsInCatsPerClump::~RSGISCountNumPxlsInCatsPerClump()
     {
         
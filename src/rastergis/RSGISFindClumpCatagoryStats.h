@@ -37,6 +37,7 @@
 #include "math/RSGISMathException.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
+#include "rastergis/RSGISClumpCategoryCounts.h"
 
 #include "utils/RSGISTextUtils.h"
 
@@ -83,28 +84,45 @@ namespace rsgis{namespace rastergis{
     class DllExport RSGISCountNumPxlsInCats : public rsgis::img::RSGISCalcImageValue
 	{
 	public: 
+        /** If catsCount is NULL then the counts are held by the object (e.g., for a clone). */
 		RSGISCountNumPxlsInCats(size_t *catsCount, size_t minCat, size_t numCatVals, unsigned int ratBandCats);
         void calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals);
+        rsgis::img::RSGISCalcImageValue* clone();
+        void reduce(rsgis::img::RSGISCalcImageValue *other);
 		~RSGISCountNumPxlsInCats();
     private:
         size_t *catsCount;
+        std::vector<size_t> localCatsCount;
         size_t minCat;
         size_t numCatVals;
         unsigned int ratBandCats;
 	};
     
     
+    /**
+     * Counts the pixels of each category within each clump. The pixels are added
+     * to a local batch of counts (consecutive pixels of the same clump and
+     * category are a single count) which is added to the shared counts when it
+     * is full, so each thread has its own batch. flush() must be called once the
+     * image has been processed (the batches of the clones are added by reduce()).
+     */
     class DllExport RSGISCountNumPxlsInCatsPerClump : public rsgis::img::RSGISCalcImageValue
 	{
 	public: 
-		RSGISCountNumPxlsInCatsPerClump(unsigned int **catStats, std::map<size_t,CategoryField> *cats, unsigned int ratClumpsBand, unsigned int ratCatsBand);
+        /** catLocalIdxs maps each category value to its index within the counts (or -1 if it is not a category). */
+		RSGISCountNumPxlsInCatsPerClump(RSGISClumpCategoryCounts *catCounts, std::vector<int> *catLocalIdxs, unsigned int ratClumpsBand, unsigned int ratCatsBand);
         void calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals);
+        rsgis::img::RSGISCalcImageValue* clone();
+        void reduce(rsgis::img::RSGISCalcImageValue *other);
+        void flush();
 		~RSGISCountNumPxlsInCatsPerClump();
     private:
-        unsigned int **catStats;
-        std::map<size_t,CategoryField> *cats;
+        RSGISClumpCategoryCounts *catCounts;
+        std::vector<int> *catLocalIdxs;
         unsigned int ratClumpsBand;
         unsigned int ratCatsBand;
+        std::vector<RSGISClumpCategoryCount> batch;
+        size_t maxBatchLen;
 	};
     
     
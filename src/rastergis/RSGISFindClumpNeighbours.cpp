@@ -29,190 +29,26 @@ namespace rsgis{namespace rastergis{
         
     }
     
-    std::vector<std::list<size_t>* >* RSGISFindClumpNeighbours::findNeighbours(GDALDataset *clumpImage, unsigned int ratBand) 
+    RSGISClumpNeighbourGraph* RSGISFindClumpNeighbours::findNeighbours(GDALDataset *clumpImage, unsigned int ratBand) 
     {
-        std::vector<std::list<size_t>* > *neighbours = new std::vector<std::list<size_t>* >();
+        RSGISClumpNeighbourGraph *neighbours = NULL;
         try
         {
+            // A single scan of the image finds the number of clumps and the neighbouring pairs.
+            RSGISClumpTopology topology(clumpImage, ratBand, 1.0, 1.0);
             
-            unsigned int width = clumpImage->GetRasterXSize();
-            unsigned int height = clumpImage->GetRasterYSize();
-            GDALRasterBand *imgBand = clumpImage->GetRasterBand(ratBand);
+            std::cout << "Number of clumps = " << (topology.getNumClumps()-1) << std::endl;
             
-            unsigned int *clumpIdxs = new unsigned int[width];
-            unsigned long maxClumpIdx = 0;
-            
-            rsgis_tqdm pbar;
-            for(unsigned int i = 0; i < height; ++i)
-            {
-                pbar.progress(i, height);
-                imgBand->RasterIO(GF_Read, 0, i, width, 1, clumpIdxs, width, 1, GDT_UInt32, 0, 0);
-                for(unsigned int j = 0; j < width; ++j)
-                {
-                    if((i == 0) & (j == 0))
-                    {
-                        maxClumpIdx = clumpIdxs[j];
-                    }
-                    else if(clumpIdxs[j] > maxClumpIdx)
-                    {
-                        maxClumpIdx = clumpIdxs[j];
-                    }
-                }
-            }
-            pbar.finish();
-            delete[] clumpIdxs;
-            
-            std::cout << "Number of clumps = " << maxClumpIdx << std::endl;
-            
-            neighbours->reserve(maxClumpIdx);
-            
-            for(unsigned long i = 0; i < maxClumpIdx; ++i)
-            {
-                neighbours->push_back(new std::list<size_t>());
-            }
-            
-            int windowSize = 3;
-            
-            unsigned int **inputData = new unsigned int*[3];
-			for(int i = 0; i < windowSize; i++)
-            {
-                inputData[i] = new unsigned int[width];
-                for(int j = 0; j < width; j++)
-                {
-                    inputData[i][j] = 0;
-                }
-            }
-            
-            unsigned int **dataBlock = new unsigned int*[windowSize];
-            for(int i = 0; i < windowSize; i++)
-            {
-                dataBlock[i] = new unsigned int[windowSize];
-            }
-            
-            unsigned long clumpID = 0;
-            
-			pbar.reset();
-			// Loop images to process data
-			for(int i = 0; i < height; i++)
-			{				
-				pbar.progress(i, height);
-				                
-				for(int m = 0; m < windowSize; m++)
-				{
-					if(m == 0)
-					{
-						if(i == 0)
-						{
-							for(int k = 0; k < width; k++)
-                            {
-                                inputData[m][k] = 0;
-                            }
-						}
-						else
-						{
-							imgBand->RasterIO(GF_Read, 0, i-1, width, 1, inputData[m], width, 1, GDT_UInt32, 0, 0);
-						}
-					}
-					else if(m == 2)
-					{
-						if((i + 1) >= height)
-						{
-							for(int k = 0; k < width; k++)
-                            {
-                                inputData[m][k] = 0;
-                            }
-						}
-						else
-						{
-							imgBand->RasterIO(GF_Read, 0, i+1, width, 1, inputData[m], width, 1, GDT_UInt32, 0, 0);
-						}
-					}
-					else
-					{
-						imgBand->RasterIO(GF_Read, 0, i, width, 1, inputData[m], width, 1, GDT_UInt32, 0, 0);
-					}
-				}
-				
-				for(int j = 0; j < width; j++)
-				{
-					for(int m = 0; m < windowSize; m++)
-					{
-						for(int k = 0; k < windowSize; k++)
-						{
-                            
-							if(k == 0)
-							{
-								if(j == 0)
-								{
-									dataBlock[m][k] = 0;
-								}
-								else
-								{
-									dataBlock[m][k] = inputData[m][(j-1)];
-								}
-							}
-							else if(k == 2)
-							{
-								if((j + 1) >= width)
-								{
-									dataBlock[m][k] = 0;
-								}
-								else
-								{
-                                    dataBlock[m][k] = inputData[m][(j+1)];
-								}
-							}
-							else
-							{
-								dataBlock[m][k] = inputData[m][j];
-							}
-						}
-					}
-					
-					
-                    // Process Window.
-                    clumpID = dataBlock[1][1];
-                    if(clumpID > 0)
-                    {
-                        if((dataBlock[0][1] > 0) & (dataBlock[0][1] != clumpID))
-                        {
-                            neighbours->at(clumpID-1)->push_back(dataBlock[0][1]-1);
-                        }
-                        if((dataBlock[1][0] > 0) & (dataBlock[1][0] != clumpID))
-                        {
-                            neighbours->at(clumpID-1)->push_back(dataBlock[1][0]-1);
-                        }
-                        if((dataBlock[1][2] > 0) & (dataBlock[1][2] != clumpID))
-                        {
-                            neighbours->at(clumpID-1)->push_back(dataBlock[1][2]-1);
-                        }
-                        if((dataBlock[2][1] > 0) & (dataBlock[2][1] != clumpID))
-                        {
-                            neighbours->at(clumpID-1)->push_back(dataBlock[2][1]-1);
-                        }
-                    }
-				}
-			}
-			pbar.finish();
-            
-			for(int i = 0; i < windowSize; i++)
-            {
-                delete[] dataBlock[i];
-                delete[] inputData[i];
-            }
-            delete[] dataBlock;
-            delete[] inputData;
-            
-            for(unsigned long i = 0; i < maxClumpIdx; ++i)
-            {
-                neighbours->at(i)->sort();
-                neighbours->at(i)->unique();
-            }
+            neighbours = topology.createNeighbourGraph();
         }
         catch(rsgis::img::RSGISImageCalcException &e)
         {
             throw e;
         }
+        catch(rsgis::RSGISImageException &e)
+        {
+            throw rsgis::img::RSGISImageCalcException(e.what());
+        }
         
         return neighbours;
     }
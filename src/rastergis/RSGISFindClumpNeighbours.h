@@ -40,6 +40,8 @@
 #include "common/rsgis-tqdm.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
+#include "rastergis/RSGISClumpNeighbourGraph.h"
+#include "rastergis/RSGISClumpTopology.h"
 
 #include "gdal_priv.h"
 #include "ogrsf_frmts.h"
@@ -64,7 +66,8 @@ namespace rsgis{namespace rastergis{
     {
     public:
         RSGISFindClumpNeighbours();
-        std::vector<std::list<size_t>* >* findNeighbours(GDALDataset *clumpImage, unsigned int ratBand);
+        /** Find the (4 connected) neighbours of the clumps (clump 1 is index 0 in the graph). The graph is owned by the caller. */
+        RSGISClumpNeighbourGraph* findNeighbours(GDALDataset *clumpImage, unsigned int ratBand);
         void findNeighboursKEAImageCalc(GDALDataset *clumpImage, unsigned int ratBand);
         ~RSGISFindClumpNeighbours();
     };
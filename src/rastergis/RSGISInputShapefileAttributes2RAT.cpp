@@ -108,6 +108,7 @@ namespace rsgis{namespace rastergis{
                         fid = feat->GetFieldAsInteger(fididx);
                         intDataVal[fid] = feat->GetFieldAsInteger(fieldIdx);
                         ++i;
+                        OGRFeature::DestroyFeature(feat);
                     }
                     std::cout << " Complete.\n";
                     ratUtils.writeIntColumn(rat, (*iterColNames), intDataVal, numRows);
@@ -136,6 +137,7 @@ namespace rsgis{namespace rastergis{
                         fid = feat->GetFieldAsInteger(fididx);
                         realDataVal[fid] = feat->GetFieldAsDouble(fieldIdx);
                         ++i;
+                        OGRFeature::DestroyFeature(feat);
                     }
                     std::cout << " Complete.\n";
                     ratUtils.writeRealColumn(rat, (*iterColNames), realDataVal, numRows);
@@ -164,6 +166,7 @@ namespace rsgis{namespace rastergis{
                         fid = feat->GetFieldAsInteger(fididx);
                         strDataVal[fid] = std::string(feat->GetFieldAsString(fieldIdx));
                         ++i;
+                        OGRFeature::DestroyFeature(feat);
                     }
                     std::cout << " Complete.\n";
                     ratUtils.writeStrColumn(rat, (*iterColNames), strDataVal, numRows);
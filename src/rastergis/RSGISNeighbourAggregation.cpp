@@ -0,0 +1,199 @@
+/*
+ *  RSGISNeighbourAggregation.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISNeighbourAggregation.h"
+
+namespace rsgis{namespace rastergis{
+    
+    void RSGISNeighbourAggregation::aggregate(RSGISClumpNeighbourGraph *graph, const std::vector<RSGISNeighbourAggColumn> &columns, unsigned int numThreads)
+    {
+        size_t numClumps = graph->getNumClumps();
+        size_t numCols = columns.size();
+        if((numClumps == 0) || (numCols == 0))
+        {
+            return;
+        }
+        
+        for(size_t c = 0; c < numCols; ++c)
+        {
+            if(columns[c].vals == NULL)
+            {
+                throw RSGISAttributeTableException("The values of a column to aggregate across the neighbours were not provided.");
+            }
+        }
+        
+        // Interleave the columns so the values of a clump are contiguous.
+        std::vector<double> vals(numClumps * numCols);
+        for(size_t i = 0; i < numClumps; ++i)
+        {
+            for(size_t c = 0; c < numCols; ++c)
+            {
+                vals[(i * numCols) + c] = columns[c].vals[i];
+            }
+        }
+        
+        const uint64_t *offsets = graph->getOffsets();
+        bool wideIdxs = graph->hasWideIdxs();
+        const uint32_t *idxs32 = graph->getIdxs32();
+        const uint64_t *idxs64 = graph->getIdxs64();
+        
+        rsgis::RSGISThreadPool threadPool(numThreads);
+        threadPool.parallelFor(0, numClumps, [&](unsigned int t, size_t start, size_t end)
+        {
+            if(wideIdxs)
+            {
+                aggregateClumps<uint64_t>(offsets, idxs64, vals.data(), columns, start, end);
+            }
+            else
+            {
+                aggregateClumps<uint32_t>(offsets, idxs32, vals.data(), columns, start, end);
+            }
+        });
+    }
+    
+    template<typename T> void RSGISNeighbourAggregation::aggregateClumps(const uint64_t *offsets, const T *idxs, const double *vals, const std::vector<RSGISNeighbourAggColumn> &columns, size_t startClump, size_t endClump)
+    {
+        size_t numCols = columns.size();
+        std::vector<double> minVals(numCols);
+        std::vector<double> maxVals(numCols);
+        std::vector<double> sumVals(numCols);
+        std::vector<double> meanVals(numCols);
+        std::vector<double> sqDevVals(numCols);
+        bool calcStdDev = false;
+        for(size_t c = 0; c < numCols; ++c)
+        {
+            calcStdDev = calcStdDev || (columns[c].stdDevVals != NULL);
+        }
+        
+        for(size_t i = startClump; i < endClump; ++i)
+        {
+            const double *clumpVals = &vals[i * numCols];
+            uint64_t nStart = offsets[i];
+            uint64_t nEnd = offsets[i+1];
+            size_t numNeighbours = nEnd - nStart;
+            
+            std::fill(minVals.begin(), minVals.end(), 0.0);
+            std::fill(maxVals.begin(), maxVals.end(), 0.0);
+            std::fill(sumVals.begin(), sumVals.end(), 0.0);
+            std::fill(meanVals.begin(), meanVals.end(), 0.0);
+            std::fill(sqDevVals.begin(), sqDevVals.end(), 0.0);
+            
+            for(uint64_t n = nStart; n < nEnd; ++n)
+            {
+                const double *neighVals = &vals[((size_t)idxs[n]) * numCols];
+                for(size_t c = 0; c < numCols; ++c)
+                {
+                    double val = neighVals[c];
+                    if(columns[c].useDiff)
+                    {
+                        val = clumpVals[c] - val;
+                        if(columns[c].useAbsDiff)
+                        {
+                            val = std::fabs(val);
+                        }
+                    }
+                    
+                    if(n == nStart)
+                    {
+                        minVals[c] = val;
+                        maxVals[c] = val;
+                    }
+                    else
+                    {
+                        minVals[c] = std::min(minVals[c], val);
+                        maxVals[c] = std::max(maxVals[c], val);
+                    }
+                    sumVals[c] += val;
+                }
+            }
+            
+            if(numNeighbours > 0)
+            {
+                for(size_t c = 0; c < numCols; ++c)
+                {
+                    meanVals[c] = sumVals[c] / numNeighbours;
+                }
+                
+                if(calcStdDev)
+                {
+                    // The neighbour lists are short so a second pass is cheap and more accurate than the sum of squares.
+                    for(uint64_t n = nStart; n < nEnd; ++n)
+                    {
+                        const double *neighVals = &vals[((size_t)idxs[n]) * numCols];
+                        for(size_t c = 0; c < numCols; ++c)
+                        {
+                            double val = neighVals[c];
+                            if(columns[c].useDiff)
+                            {
+                                val = clumpVals[c] - val;
+                                if(columns[c].useAbsDiff)
+                                {
+                                    val = std::fabs(val);
+                                }
+                            }
+                            sqDevVals[c] += (val - meanVals[c]) * (val - meanVals[c]);
+                        }
+                    }
+                }
+            }
+            
+            for(size_t c = 0; c < numCols; ++c)
+            {
+                const RSGISNeighbourAggColumn &col = columns[c];
+                if(col.minVals != NULL)
+                {
+                    col.minVals[i] = minVals[c];
+                }
+                if(col.maxVals != NULL)
+                {
+                    col.maxVals[i] = maxVals[c];
+                }
+                if(col.meanVals != NULL)
+                {
+                    col.meanVals[i] = meanVals[c];
+                }
+                if(col.sumVals != NULL)
+                {
+                    col.sumVals[i] = sumVals[c];
+                }
+                if(col.stdDevVals != NULL)
+                {
+                    if(numNeighbours == 0)
+                    {
+                        col.stdDevVals[i] = 0.0;
+                    }
+                    else if(numNeighbours == 1)
+                    {
+                        col.stdDevVals[i] = std::numeric_limits<double>::quiet_NaN();
+                    }
+                    else
+                    {
+                        col.stdDevVals[i] = std::sqrt(sqDevVals[c] / (numNeighbours - 1));
+                    }
+                }
+            }
+        }
+    }
+    
+}}
+
@@ -0,0 +1,94 @@
+/*
+ *  RSGISNeighbourAggregation.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISNeighbourAggregation_H
+#define RSGISNeighbourAggregation_H
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "common/RSGISAttributeTableException.h"
+#include "common/RSGISThreadPool.h"
+
+#include "rastergis/RSGISClumpNeighbourGraph.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_rastergis_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace rastergis{
+    
+    /**
+     * A column of values (one per clump) to aggregate across the neighbours of each
+     * clump. The outputs have a value per clump and are not calculated if NULL.
+     */
+    struct DllExport RSGISNeighbourAggColumn
+    {
+        const double *vals;
+        /// Aggregate the differences between the clump and its neighbours (vals[clump] - vals[neighbour]) rather than the neighbour values.
+        bool useDiff;
+        /// Use the absolute differences (if useDiff).
+        bool useAbsDiff;
+        double *minVals;
+        double *maxVals;
+        double *meanVals;
+        double *stdDevVals;
+        double *sumVals;
+    };
+    
+    /**
+     * Calculates the statistics of columns across the neighbours of each clump of a
+     * CSR neighbour graph in a single sweep over the graph.
+     */
+    class DllExport RSGISNeighbourAggregation
+    {
+    public:
+        /**
+         * Calculate the statistics of all the columns in one pass, where the clumps
+         * are split between numThreads threads (0 is the number of hardware threads).
+         * The column values are interleaved so the values of a neighbour are read
+         * together. The standard deviation is the sample standard deviation (as
+         * gsl_stats_sd), so is NaN for a clump with one neighbour, and the statistics
+         * of a clump without neighbours are 0.
+         */
+        static void aggregate(RSGISClumpNeighbourGraph *graph, const std::vector<RSGISNeighbourAggColumn> &columns, unsigned int numThreads);
+    protected:
+        template<typename T> static void aggregateClumps(const uint64_t *offsets, const T *idxs, const double *vals, const std::vector<RSGISNeighbourAggColumn> &columns, size_t startClump, size_t endClump);
+    };
+    
+}}
+
+#endif
+
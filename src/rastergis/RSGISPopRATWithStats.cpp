@@ -1240,6 +1240,223 @@ namespace rsgis{namespace rastergis{
         }
     }
     
+    void RSGISPopRATWithStats::populateRATWithStatsSinglePass(GDALDataset *inputClumps, GDALDataset *inputValsImage, std::vector<RSGISBandAttStats*> *bandStats, unsigned int ratBand, unsigned int numThreads)
+    {
+        try
+        {
+            if(ratBand == 0)
+            {
+                throw rsgis::RSGISAttributeTableException("RAT Band must be greater than zero.");
+            }
+            if(ratBand > inputClumps->GetRasterCount())
+            {
+                throw rsgis::RSGISAttributeTableException("RAT Band is larger than the number of bands within the image.");
+            }
+            RSGISRasterAttUtils attUtils;
+            GDALRasterAttributeTable *rat = inputClumps->GetRasterBand(ratBand)->GetDefaultRAT();
+            size_t numRows = rat->GetRowCount();
+            
+            long minClumpID = 0;
+            long maxClumpID = 0;
+            attUtils.getImageBandMinMax(inputClumps, ratBand, &minClumpID, &maxClumpID);
+            
+            if(maxClumpID >= numRows)
+            {
+                numRows = boost::lexical_cast<size_t>(maxClumpID) + 1;
+                rat->SetRowCount(numRows);
+            }
+            
+            for(std::vector<rsgis::rastergis::RSGISBandAttStats*>::iterator iterBands = bandStats->begin(); iterBands != bandStats->end(); ++iterBands)
+            {
+                if(((*iterBands)->band == 0) || ((*iterBands)->band > inputValsImage->GetRasterCount()))
+                {
+                    throw rsgis::RSGISAttributeTableException("Values image band is not within the image.");
+                }
+                
+                if((*iterBands)->calcMin)
+                {
+                    (*iterBands)->minFieldIdx = attUtils.findColumnIndexOrCreate(rat, (*iterBands)->minField, GFT_Real);
+                }
+                if((*iterBands)->calcMax)
+                {
+                    (*iterBands)->maxFieldIdx = attUtils.findColumnIndexOrCreate(rat, (*iterBands)->maxField, GFT_Real);
+                }
+                if((*iterBands)->calcMean)
+                {
+                    (*iterBands)->meanFieldIdx = attUtils.findColumnIndexOrCreate(rat, (*iterBands)->meanField, GFT_Real);
+                }
+                if((*iterBands)->calcStdDev)
+                {
+                    (*iterBands)->stdDevFieldIdx = attUtils.findColumnIndexOrCreate(rat, (*iterBands)->stdDevField, GFT_Real);
+                }
+                if((*iterBands)->calcSum)
+                {
+                    (*iterBands)->sumFieldIdx = attUtils.findColumnIndexOrCreate(rat, (*iterBands)->sumField, GFT_Real);
+                }
+                if((*iterBands)->calcCount)
+                {
+                    (*iterBands)->countFieldIdx = attUtils.findColumnIndexOrCreate(rat, (*iterBands)->countField, GFT_Integer);
+                }
+                if((*iterBands)->calcMode)
+                {
+                    (*iterBands)->modeFieldIdx = attUtils.findColumnIndexOrCreate(rat, (*iterBands)->modeField, GFT_Real);
+                }
+                for(std::vector<RSGISBandAttPercentiles>::iterator iterPer = (*iterBands)->percentiles.begin(); iterPer != (*iterBands)->percentiles.end(); ++iterPer)
+                {
+                    if(((*iterPer).percentile < 0) || ((*iterPer).percentile > 100))
+                    {
+                        throw rsgis::RSGISAttributeTableException("Percentiles must be between 0 and 100.");
+                    }
+                    (*iterPer).fieldIdx = attUtils.findColumnIndexOrCreate(rat, (*iterPer).fieldName, GFT_Real);
+                }
+                
+                if((*iterBands)->calcMode || (!(*iterBands)->percentiles.empty()))
+                {
+                    if((*iterBands)->numHistBins == 0)
+                    {
+                        throw rsgis::RSGISAttributeTableException("The number of histogram bins must be greater than zero to calculate the mode or percentiles.");
+                    }
+                    if((*iterBands)->histMin >= (*iterBands)->histMax)
+                    {
+                        double imageValMin = 0.0;
+                        double imageValMax = 0.0;
+                        rsgis_tqdm *pbar = new rsgis_tqdm();
+                        inputValsImage->GetRasterBand((*iterBands)->band)->ComputeStatistics(false, &imageValMin, &imageValMax, NULL, NULL,  (GDALProgressFunc)RSGISRATStatsTextProgress, pbar);
+                        delete pbar;
+                        (*iterBands)->histMin = imageValMin;
+                        (*iterBands)->histMax = imageValMax;
+                        if((*iterBands)->histMin >= (*iterBands)->histMax)
+                        {
+                            (*iterBands)->histMax = (*iterBands)->histMin + 1;
+                        }
+                    }
+                }
+            }
+            
+            int n_bands = inputValsImage->GetRasterCount();
+            double *no_data_vals = new double[n_bands];
+            bool *use_no_data_vals = new bool[n_bands];
+            int use_no_data_val_int = 0;
+            for(unsigned int i = 0; i < n_bands; ++i)
+            {
+                use_no_data_val_int = false;
+                GDALRasterBand *image_band = inputValsImage->GetRasterBand(i+1);
+                no_data_vals[i] = image_band->GetNoDataValue(&use_no_data_val_int);
+                use_no_data_vals[i] = (bool)use_no_data_val_int;
+            }
+            
+            GDALDataset **datasets = new GDALDataset*[2];
+            datasets[0] = inputClumps;
+            datasets[1] = inputValsImage;
+            
+            RSGISCalcClusterPxlValueStatsSinglePass calcImgValStats(numRows, bandStats, ratBand, no_data_vals, use_no_data_vals);
+            rsgis::img::RSGISCalcImage calcImageStats(&calcImgValStats);
+            calcImageStats.setNumThreads(numThreads);
+            calcImageStats.calcImage(datasets, 1, 1);
+            delete[] datasets;
+            
+            std::cout << "Writing Stats to Output RAT\n";
+            double *dataBlock = new double[RAT_BLOCK_LENGTH];
+            int *intDataBlock = new int[RAT_BLOCK_LENGTH];
+            size_t blockLen = 0;
+            unsigned int statIdx = 0;
+            for(size_t startRow = 0; startRow < numRows; startRow += RAT_BLOCK_LENGTH)
+            {
+                blockLen = RAT_BLOCK_LENGTH;
+                if((startRow + blockLen) > numRows)
+                {
+                    blockLen = numRows - startRow;
+                }
+                
+                statIdx = 0;
+                for(std::vector<rsgis::rastergis::RSGISBandAttStats*>::iterator iterBands = bandStats->begin(); iterBands != bandStats->end(); ++iterBands, ++statIdx)
+                {
+                    if((*iterBands)->calcCount)
+                    {
+                        for(size_t j = 0; j < blockLen; ++j)
+                        {
+                            intDataBlock[j] = calcImgValStats.getCount(statIdx, startRow+j);
+                        }
+                        rat->ValuesIO(GF_Write, (*iterBands)->countFieldIdx, startRow, blockLen, intDataBlock);
+                    }
+                    if((*iterBands)->calcMin)
+                    {
+                        for(size_t j = 0; j < blockLen; ++j)
+                        {
+                            dataBlock[j] = calcImgValStats.getMin(statIdx, startRow+j);
+                        }
+                        rat->ValuesIO(GF_Write, (*iterBands)->minFieldIdx, startRow, blockLen, dataBlock);
+                    }
+                    if((*iterBands)->calcMax)
+                    {
+                        for(size_t j = 0; j < blockLen; ++j)
+                        {
+                            dataBlock[j] = calcImgValStats.getMax(statIdx, startRow+j);
+                        }
+                        rat->ValuesIO(GF_Write, (*iterBands)->maxFieldIdx, startRow, blockLen, dataBlock);
+                    }
+                    if((*iterBands)->calcMean)
+                    {
+                        for(size_t j = 0; j < blockLen; ++j)
+                        {
+                            dataBlock[j] = calcImgValStats.getMean(statIdx, startRow+j);
+                        }
+                        rat->ValuesIO(GF_Write, (*iterBands)->meanFieldIdx, startRow, blockLen, dataBlock);
+                    }
+                    if((*iterBands)->calcStdDev)
+                    {
+                        for(size_t j = 0; j < blockLen; ++j)
+                        {
+                            dataBlock[j] = calcImgValStats.getStdDev(statIdx, startRow+j);
+                        }
+                        rat->ValuesIO(GF_Write, (*iterBands)->stdDevFieldIdx, startRow, blockLen, dataBlock);
+                    }
+                    if((*iterBands)->calcSum)
+                    {
+                        for(size_t j = 0; j < blockLen; ++j)
+                        {
+                            dataBlock[j] = calcImgValStats.getSum(statIdx, startRow+j);
+                        }
+                        rat->ValuesIO(GF_Write, (*iterBands)->sumFieldIdx, startRow, blockLen, dataBlock);
+                    }
+                    if((*iterBands)->calcMode)
+                    {
+                        for(size_t j = 0; j < blockLen; ++j)
+                        {
+                            dataBlock[j] = calcImgValStats.getMode(statIdx, startRow+j);
+                        }
+                        rat->ValuesIO(GF_Write, (*iterBands)->modeFieldIdx, startRow, blockLen, dataBlock);
+                    }
+                    for(std::vector<RSGISBandAttPercentiles>::iterator iterPer = (*iterBands)->percentiles.begin(); iterPer != (*iterBands)->percentiles.end(); ++iterPer)
+                    {
+                        for(size_t j = 0; j < blockLen; ++j)
+                        {
+                            dataBlock[j] = calcImgValStats.getPercentile(statIdx, startRow+j, (*iterPer).percentile);
+                        }
+                        rat->ValuesIO(GF_Write, (*iterPer).fieldIdx, startRow, blockLen, dataBlock);
+                    }
+                }
+            }
+            
+            delete[] dataBlock;
+            delete[] intDataBlock;
+            delete[] no_data_vals;
+            delete[] use_no_data_vals;
+        }
+        catch(RSGISAttributeTableException &e)
+        {
+            throw e;
+        }
+        catch(RSGISException &e)
+        {
+            throw RSGISAttributeTableException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISAttributeTableException(e.what());
+        }
+    }
+    
     RSGISPopRATWithStats::~RSGISPopRATWithStats()
     {
         
@@ -1336,6 +1553,219 @@ namespace rsgis{namespace rastergis{
         
     }
     
+    RSGISCalcClusterPxlValueStatsSinglePass::RSGISCalcClusterPxlValueStatsSinglePass(size_t numClumps, std::vector<rsgis::rastergis::RSGISBandAttStats*> *bandStats, unsigned int ratBand, double *no_data_vals, bool *use_no_data_vals) : rsgis::img::RSGISCalcImageValue(0)
+    {
+        this->numClumps = numClumps;
+        this->bandStats = bandStats;
+        this->ratBand = ratBand;
+        this->no_data_vals = no_data_vals;
+        this->use_no_data_vals = use_no_data_vals;
+        
+        size_t numStats = bandStats->size();
+        this->counts.resize(numStats);
+        this->mins.resize(numStats);
+        this->maxs.resize(numStats);
+        this->means.resize(numStats);
+        this->m2s.resize(numStats);
+        this->sums.resize(numStats);
+        this->hists.resize(numStats);
+        this->binWidths.resize(numStats, 0.0);
+        
+        // Only allocate the per clump arrays for the statistics which have been requested.
+        for(size_t i = 0; i < numStats; ++i)
+        {
+            RSGISBandAttStats *stats = bandStats->at(i);
+            this->counts[i].resize(numClumps, 0);
+            if(stats->calcMin)
+            {
+                this->mins[i].resize(numClumps, 0.0);
+            }
+            if(stats->calcMax)
+            {
+                this->maxs[i].resize(numClumps, 0.0);
+            }
+            if(stats->calcMean || stats->calcStdDev)
+            {
+                this->means[i].resize(numClumps, 0.0);
+            }
+            if(stats->calcStdDev)
+            {
+                this->m2s[i].resize(numClumps, 0.0);
+            }
+            if(stats->calcSum)
+            {
+                this->sums[i].resize(numClumps, 0.0);
+            }
+            if(stats->calcMode || (!stats->percentiles.empty()))
+            {
+                this->hists[i].resize(numClumps * stats->numHistBins, 0);
+                this->binWidths[i] = (stats->histMax - stats->histMin) / ((double)stats->numHistBins);
+            }
+        }
+    }
+    
+    void RSGISCalcClusterPxlValueStatsSinglePass::calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals)
+    {
+        if((intBandValues[ratBand-1] > 0) && (((size_t)intBandValues[ratBand-1]) < this->numClumps))
+        {
+            size_t fid = intBandValues[ratBand-1];
+            
+            for(size_t i = 0; i < bandStats->size(); ++i)
+            {
+                RSGISBandAttStats *stats = (*bandStats)[i];
+                double val = floatBandValues[stats->band-1];
+                if(!(boost::math::isfinite)(val))
+                {
+                    continue;
+                }
+                if(this->use_no_data_vals[stats->band-1] && (this->no_data_vals[stats->band-1] == floatBandValues[stats->band-1]))
+                {
+                    continue;
+                }
+                
+                unsigned long n = ++this->counts[i][fid];
+                if(stats->calcMin && ((n == 1) || (val < this->mins[i][fid])))
+                {
+                    this->mins[i][fid] = val;
+                }
+                if(stats->calcMax && ((n == 1) || (val > this->maxs[i][fid])))
+                {
+                    this->maxs[i][fid] = val;
+                }
+                if(stats->calcSum)
+                {
+                    this->sums[i][fid] += val;
+                }
+                if(stats->calcMean || stats->calcStdDev)
+                {
+                    double delta = val - this->means[i][fid];
+                    this->means[i][fid] += delta / n;
+                    if(stats->calcStdDev)
+                    {
+                        this->m2s[i][fid] += delta * (val - this->means[i][fid]);
+                    }
+                }
+                if(!this->hists[i].empty())
+                {
+                    long bin = 0;
+                    if(val > stats->histMin)
+                    {
+                        bin = floor((val - stats->histMin) / this->binWidths[i]);
+                        if(bin >= stats->numHistBins)
+                        {
+                            bin = stats->numHistBins - 1;
+                        }
+                    }
+                    ++this->hists[i][(fid * stats->numHistBins) + bin];
+                }
+            }
+        }
+    }
+    
+    rsgis::img::RSGISCalcImageValue* RSGISCalcClusterPxlValueStatsSinglePass::clone()
+    {
+        return new RSGISCalcClusterPxlValueStatsSinglePass(this->numClumps, this->bandStats, this->ratBand, this->no_data_vals, this->use_no_data_vals);
+    }
+    
+    void RSGISCalcClusterPxlValueStatsSinglePass::reduce(rsgis::img::RSGISCalcImageValue *other)
+    {
+        RSGISCalcClusterPxlValueStatsSinglePass *otherStats = dynamic_cast<RSGISCalcClusterPxlValueStatsSinglePass*>(other);
+        if(otherStats == NULL)
+        {
+            throw rsgis::img::RSGISImageCalcException("Can only reduce with another RSGISCalcClusterPxlValueStatsSinglePass object.");
+        }
+        
+        for(size_t i = 0; i < this->bandStats->size(); ++i)
+        {
+            RSGISBandAttStats *stats = (*bandStats)[i];
+            for(size_t fid = 0; fid < this->numClumps; ++fid)
+            {
+                unsigned long nB = otherStats->counts[i][fid];
+                if(nB == 0)
+                {
+                    continue;
+                }
+                unsigned long nA = this->counts[i][fid];
+                unsigned long n = nA + nB;
+                if(stats->calcMin && ((nA == 0) || (otherStats->mins[i][fid] < this->mins[i][fid])))
+                {
+                    this->mins[i][fid] = otherStats->mins[i][fid];
+                }
+                if(stats->calcMax && ((nA == 0) || (otherStats->maxs[i][fid] > this->maxs[i][fid])))
+                {
+                    this->maxs[i][fid] = otherStats->maxs[i][fid];
+                }
+                if(stats->calcSum)
+                {
+                    this->sums[i][fid] += otherStats->sums[i][fid];
+                }
+                if(stats->calcMean || stats->calcStdDev)
+                {
+                    // Combine the means and sums of squared differences (Chan et al.).
+                    double delta = otherStats->means[i][fid] - this->means[i][fid];
+                    this->means[i][fid] += delta * ((double)nB / (double)n);
+                    if(stats->calcStdDev)
+                    {
+                        this->m2s[i][fid] += otherStats->m2s[i][fid] + (delta * delta * (((double)nA * (double)nB) / (double)n));
+                    }
+                }
+                if(!this->hists[i].empty())
+                {
+                    unsigned int *histA = &this->hists[i][fid * stats->numHistBins];
+                    unsigned int *histB = &otherStats->hists[i][fid * stats->numHistBins];
+                    for(unsigned int j = 0; j < stats->numHistBins; ++j)
+                    {
+                        histA[j] += histB[j];
+                    }
+                }
+                this->counts[i][fid] = n;
+            }
+        }
+    }
+    
+    double RSGISCalcClusterPxlValueStatsSinglePass::getStdDev(unsigned int statIdx, size_t clump)
+    {
+        if(this->counts[statIdx][clump] == 0)
+        {
+            return 0.0;
+        }
+        return sqrt(this->m2s[statIdx][clump] / this->counts[statIdx][clump]);
+    }
+    
+    double RSGISCalcClusterPxlValueStatsSinglePass::getMode(unsigned int statIdx, size_t clump)
+    {
+        if(this->counts[statIdx][clump] == 0)
+        {
+            return 0.0;
+        }
+        RSGISBandAttStats *stats = (*bandStats)[statIdx];
+        unsigned int *hist = &this->hists[statIdx][clump * stats->numHistBins];
+        unsigned int modeBin = 0;
+        for(unsigned int i = 1; i < stats->numHistBins; ++i)
+        {
+            if(hist[i] > hist[modeBin])
+            {
+                modeBin = i;
+            }
+        }
+        return stats->histMin + (this->binWidths[statIdx] * modeBin) + (this->binWidths[statIdx] / 2);
+    }
+    
+    double RSGISCalcClusterPxlValueStatsSinglePass::getPercentile(unsigned int statIdx, size_t clump, float percentile)
+    {
+        if(this->counts[statIdx][clump] == 0)
+        {
+            return 0.0;
+        }
+        RSGISBandAttStats *stats = (*bandStats)[statIdx];
+        return this->mathUtils.calcPercentile(percentile, stats->histMin, this->binWidths[statIdx], stats->numHistBins, &this->hists[statIdx][clump * stats->numHistBins]);
+    }
+    
+    RSGISCalcClusterPxlValueStatsSinglePass::~RSGISCalcClusterPxlValueStatsSinglePass()
+    {
+        
+    }
+    
     RSGISCalcClusterPxlValueStdDev::RSGISCalcClusterPxlValueStdDev(double **stdDevData, double **statsData, std::vector<rsgis::rastergis::RSGISBandAttStats*> *bandStats, bool *firstVal, unsigned int ratBand, double *no_data_vals, bool *use_no_data_vals) : rsgis::img::RSGISCalcImageValue(0)
     {
         this->stdDevData = stdDevData;
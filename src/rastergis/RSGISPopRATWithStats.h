@@ -59,6 +59,13 @@
 
 namespace rsgis{namespace rastergis{
 	
+    struct DllExport RSGISBandAttPercentiles
+    {
+        float percentile;
+        std::string fieldName;
+        unsigned int fieldIdx;
+    };
+    
     struct DllExport RSGISBandAttStats
     {
         unsigned int band;
@@ -82,6 +89,18 @@ namespace rsgis{namespace rastergis{
         std::string sumField;
         unsigned int sumFieldIdx;
         unsigned int sumLocalIdx;
+        /** The following are only used by populateRATWithStatsSinglePass */
+        bool calcCount;
+        std::string countField;
+        unsigned int countFieldIdx;
+        bool calcMode;
+        std::string modeField;
+        unsigned int modeFieldIdx;
+        std::vector<RSGISBandAttPercentiles> percentiles;
+        /** The range and number of bins of the histogram used for the mode and percentiles (if histMin >= histMax the range of the band is used). */
+        double histMin;
+        double histMax;
+        unsigned int numHistBins;
         
         void init()
         {
@@ -106,16 +125,19 @@ namespace rsgis{namespace rastergis{
             sumField = "";
             sumFieldIdx = 0;
             sumLocalIdx = 0;
+            calcCount = false;
+            countField = "";
+            countFieldIdx = 0;
+            calcMode = false;
+            modeField = "";
+            modeFieldIdx = 0;
+            percentiles.clear();
+            histMin = 0;
+            histMax = 0;
+            numHistBins = 0;
         };
     };
     
-    struct DllExport RSGISBandAttPercentiles
-    {
-        float percentile;
-        std::string fieldName;
-        unsigned int fieldIdx;
-    };
-    
     class DllExport RSGISPopRATWithStats
     {
     public:
@@ -125,6 +147,18 @@ namespace rsgis{namespace rastergis{
         void populateRATWithMeanLitStats(GDALDataset *inputClumps, GDALDataset *inputValsImage, GDALDataset *inputMeanLitImage, unsigned int meanLitBand, std::string meanLitCol, std::string pxlCountCol, std::vector<RSGISBandAttStats*> *bandStats, unsigned int ratBand);
         void populateRATWithModeStats(GDALDataset *inputClumps, GDALDataset *inputValsImage, std::string outColsName, bool useNoDataVal, long noDataVal, bool outNoDataVal, unsigned int modeBand, unsigned int ratBand);
         void populateRATWithPopValidPixels(GDALDataset *inputClumps, GDALDataset *inputValsImage, std::string outColsName, double noDataVal, unsigned int ratBand);
+        /**
+         * Populate the RAT with any mix of the min, max, mean, standard deviation, sum,
+         * count (of valid pixels), mode and percentiles for each of the bands in a single
+         * pass over the clumps and values images. The mode and percentiles are calculated
+         * from a histogram with numHistBins bins between histMin and histMax per clump
+         * (values outside of the range are counted in the first or last bin) and are
+         * the centre of the bin. All the columns are written once the pass is complete.
+         * Each strip of the image can be processed with numThreads threads (0 uses all
+         * the available cores), where each thread accumulates into its own copy of the
+         * per clump arrays so the memory required increases with the number of threads.
+         */
+        void populateRATWithStatsSinglePass(GDALDataset *inputClumps, GDALDataset *inputValsImage, std::vector<RSGISBandAttStats*> *bandStats, unsigned int ratBand, unsigned int numThreads=1);
         ~RSGISPopRATWithStats();
     };
     
@@ -143,6 +177,44 @@ namespace rsgis{namespace rastergis{
         bool *use_no_data_vals;
     };
     
+    /**
+     * Accumulates the statistics for populateRATWithStatsSinglePass, using Welford's
+     * algorithm for the mean and standard deviation so only a single pass is needed.
+     */
+    class DllExport RSGISCalcClusterPxlValueStatsSinglePass : public rsgis::img::RSGISCalcImageValue
+    {
+    public:
+        RSGISCalcClusterPxlValueStatsSinglePass(size_t numClumps, std::vector<rsgis::rastergis::RSGISBandAttStats*> *bandStats, unsigned int ratBand, double *no_data_vals, bool *use_no_data_vals);
+        void calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals);
+        /** Each clone holds its own dense per clump arrays which are merged into this object by reduce(). */
+        rsgis::img::RSGISCalcImageValue* clone();
+        void reduce(rsgis::img::RSGISCalcImageValue *other);
+        unsigned long getCount(unsigned int statIdx, size_t clump){return this->counts[statIdx][clump];};
+        double getMin(unsigned int statIdx, size_t clump){return this->mins[statIdx][clump];};
+        double getMax(unsigned int statIdx, size_t clump){return this->maxs[statIdx][clump];};
+        double getMean(unsigned int statIdx, size_t clump){return this->means[statIdx][clump];};
+        double getStdDev(unsigned int statIdx, size_t clump);
+        double getSum(unsigned int statIdx, size_t clump){return this->sums[statIdx][clump];};
+        double getMode(unsigned int statIdx, size_t clump);
+        double getPercentile(unsigned int statIdx, size_t clump, float percentile);
+        ~RSGISCalcClusterPxlValueStatsSinglePass();
+    private:
+        size_t numClumps;
+        std::vector<rsgis::rastergis::RSGISBandAttStats*> *bandStats;
+        unsigned int ratBand;
+        double *no_data_vals;
+        bool *use_no_data_vals;
+        std::vector<std::vector<unsigned long> > counts;
+        std::vector<std::vector<double> > mins;
+        std::vector<std::vector<double> > maxs;
+        std::vector<std::vector<double> > means;
+        std::vector<std::vector<double> > m2s;
+        std::vector<std::vector<double> > sums;
+        std::vector<std::vector<unsigned int> > hists;
+        std::vector<double> binWidths;
+        rsgis::math::RSGISMathsUtils mathUtils;
+    };
+    
     class DllExport RSGISCalcClusterPxlValueStdDev : public rsgis::img::RSGISCalcImageValue
 	{
 	public:
@@ -21,401 +21,380 @@
  */
 
 #include "RSGISRATCalc.h"
+#include "RSGISRATColumnSummary.h"
 
 
 namespace rsgis{namespace rastergis{
     
-    RSGISRATCalc::RSGISRATCalc(RSGISRATCalcValue *ratCalcVal)
+    RSGISRATCalc::RSGISRATCalc(RSGISRATCalcValue *ratCalcVal, RSGISRATColumnCache *colCache)
     {
         this->ratCalcVal = ratCalcVal;
+        this->colCache = colCache;
+        rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+        this->numThreads = context.numThreads;
+        this->numIOBuffers = std::max<unsigned int>(context.numIOBuffers, 2);
     }
     
     void RSGISRATCalc::calcRATValues(GDALRasterAttributeTable *gdalRAT, std::vector<unsigned int> inRealColIdx, std::vector<unsigned int> inIntColIdx, std::vector<unsigned int> inStrColIdx, std::vector<unsigned int> outRealColIdx, std::vector<unsigned int> outIntColIdx, std::vector<unsigned int> outStrColIdx)
     {
         try
         {
-            unsigned int numInRealCols = inRealColIdx.size();
-            unsigned int numInIntCols = inIntColIdx.size();
-            unsigned int numInStrCols = inStrColIdx.size();
-            unsigned int numOutRealCols = outRealColIdx.size();
-            unsigned int numOutIntCols = outIntColIdx.size();
-            unsigned int numOutStrCols = outStrColIdx.size();
-            
-            double *dCalcInVals = NULL;
-            if(numInRealCols > 0)
-            {
-                dCalcInVals = new double[numInRealCols];
-            }
-            int *iCalcInVals = NULL;
-            if(numInIntCols > 0)
-            {
-                iCalcInVals = new int[numInIntCols];
-            }
-            std::string *sCalcInVals = NULL;
-            if(numInStrCols > 0)
+            if((this->colCache != NULL) && (this->colCache->getRAT() != gdalRAT))
             {
-                sCalcInVals = new std::string[numInStrCols];
+                throw RSGISAttributeTableException("The column cache is for a different RAT.");
             }
             
-            double *dCalcOutVals = NULL;
-            if(numOutRealCols > 0)
-            {
-                dCalcOutVals = new double[numOutRealCols];
-            }
-            int *iCalcOutVals = NULL;
-            if(numOutIntCols > 0)
-            {
-                iCalcOutVals = new int[numOutIntCols];
-            }
-            std::string *sCalcOutVals = NULL;
-            if(numOutStrCols > 0)
-            {
-                sCalcOutVals = new std::string[numOutStrCols];
-            }
-            
-            // Iterate through blocks
-            size_t nRows = gdalRAT->GetRowCount();
-            unsigned int nBlocks = floor(((double) nRows) / ((double) RAT_BLOCK_LENGTH));
-            unsigned int remainRows = nRows - (nBlocks * RAT_BLOCK_LENGTH );
-            
-            // Allocate Memory
-            double **inRealData = NULL;
-            if(numInRealCols > 0)
-            {
-                inRealData = new double*[numInRealCols];
-                for(unsigned int i = 0; i < numInRealCols; ++i)
-                {
-                    inRealData[i] = new double[RAT_BLOCK_LENGTH];
-                    for(int j = 0; j < RAT_BLOCK_LENGTH; ++j)
-                    {
-                        inRealData[i][j] = 0.0;
-                    }
-                }
-            }
-            double **outRealData = NULL;
-            if(numOutRealCols > 0)
+            std::vector<std::vector<unsigned int>*> outColIdxs;
+            outColIdxs.push_back(&outRealColIdx);
+            outColIdxs.push_back(&outIntColIdx);
+            outColIdxs.push_back(&outStrColIdx);
+            for(std::vector<std::vector<unsigned int>*>::iterator iterCols = outColIdxs.begin(); iterCols != outColIdxs.end(); ++iterCols)
             {
-                outRealData = new double*[numOutRealCols];
-                for(unsigned int i = 0; i < numOutRealCols; ++i)
+                for(std::vector<unsigned int>::iterator iterCol = (*iterCols)->begin(); iterCol != (*iterCols)->end(); ++iterCol)
                 {
-                    outRealData[i] = new double[RAT_BLOCK_LENGTH];
-                    for(int j = 0; j < RAT_BLOCK_LENGTH; ++j)
-                    {
-                        outRealData[i][j] = 0.0;
-                    }
-                }
-            }
-            int **inIntData = NULL;
-            if(numInIntCols > 0)
-            {
-                inIntData = new int*[numInIntCols];
-                for(unsigned int i = 0; i < numInIntCols; ++i)
-                {
-                    inIntData[i] = new int[RAT_BLOCK_LENGTH];
-                    for(int j = 0; j < RAT_BLOCK_LENGTH; ++j)
-                    {
-                        inIntData[i][j] = 0.0;
-                    }
-                }
-            }
-            int **outIntData = NULL;
-            if(numOutIntCols > 0)
-            {
-                outIntData = new int*[numOutIntCols];
-                for(unsigned int i = 0; i < numOutIntCols; ++i)
-                {
-                    outIntData[i] = new int[RAT_BLOCK_LENGTH];
-                    for(int j = 0; j < RAT_BLOCK_LENGTH; ++j)
-                    {
-                        outIntData[i][j] = 0.0;
-                    }
-                }
-            }
-            char ***inStrData = NULL;
-            if(numInStrCols > 0)
-            {
-                inStrData = new char**[numInStrCols];
-                for(unsigned int i = 0; i < numInStrCols; ++i)
-                {
-                    inStrData[i] = new char*[RAT_BLOCK_LENGTH];
-                    for(int j = 0; j < RAT_BLOCK_LENGTH; ++j)
-                    {
-                        inStrData[i][j] = RSGIS_C_TEXT("");
-                    }
-                }
-            }
-            char ***outStrData = NULL;
-            if(numOutStrCols > 0)
-            {
-                outStrData = new char**[numOutStrCols];
-                for(unsigned int i = 0; i < numOutStrCols; ++i)
-                {
-                    outStrData[i] = new char*[RAT_BLOCK_LENGTH];
-                    for(int j = 0; j < RAT_BLOCK_LENGTH; ++j)
-                    {
-                        outStrData[i][j] = RSGIS_C_TEXT("");
-                    }
+                    RSGISRATColumnSummaries::columnModified(gdalRAT, gdalRAT->GetNameOfCol(*iterCol));
                 }
             }
             
-            rsgis_tqdm pbar;
-            size_t startRow = 0;
-            size_t rowID = 0;
-            for(int i = 0; i < nBlocks; i++)
+            std::vector<RSGISRATCalcValue*> threadCalcs = this->createThreadCalcs();
+            unsigned int nThreads = threadCalcs.size();
+            try
             {
-                // Read blocks
-                for(unsigned int n = 0; n < numInRealCols; ++n)
+                std::vector<RSGISRATCalcThread> threads(nThreads);
+                for(unsigned int t = 0; t < nThreads; ++t)
                 {
-                    gdalRAT->ValuesIO(GF_Read, inRealColIdx[n], startRow, RAT_BLOCK_LENGTH, inRealData[n]);
+                    threads[t].calc = threadCalcs[t];
+                    // Use the block calculation until it reports it is not implemented.
+                    threads[t].useBlockCalc = true;
+                    threads[t].inRealVals.resize(inRealColIdx.size());
+                    threads[t].inIntVals.resize(inIntColIdx.size());
+                    threads[t].inStrVals.resize(inStrColIdx.size());
+                    threads[t].outRealVals.resize(outRealColIdx.size());
+                    threads[t].outIntVals.resize(outIntColIdx.size());
+                    threads[t].outStrVals.resize(outStrColIdx.size());
                 }
                 
-                for(unsigned int n = 0; n < numInIntCols; ++n)
+                // Each block buffer has a chunk of rows for each thread.
+                unsigned int numBuffers = (nThreads > 1)?this->numIOBuffers:1;
+                std::vector< std::vector<RSGISRATCalcChunk> > buffers(numBuffers, std::vector<RSGISRATCalcChunk>(nThreads));
+                for(unsigned int b = 0; b < numBuffers; ++b)
                 {
-                    gdalRAT->ValuesIO(GF_Read, inIntColIdx[n], startRow, RAT_BLOCK_LENGTH, inIntData[n]);
+                    for(unsigned int t = 0; t < nThreads; ++t)
+                    {
+                        RSGISRATCalcChunk *chunk = &buffers[b][t];
+                        chunk->inRealData.resize(inRealColIdx.size());
+                        chunk->inIntData.resize(inIntColIdx.size());
+                        chunk->inStrData.resize(inStrColIdx.size());
+                        chunk->outRealData.resize(outRealColIdx.size());
+                        chunk->outIntData.resize(outIntColIdx.size());
+                        chunk->outStrData.resize(outStrColIdx.size());
+                    }
                 }
                 
-                for(unsigned int n = 0; n < numInStrCols; ++n)
-                {
-                    gdalRAT->ValuesIO(GF_Read, inStrColIdx[n], startRow, RAT_BLOCK_LENGTH, inStrData[n]);
-                }
+                size_t nRows = gdalRAT->GetRowCount();
+                size_t nBlocks = (nRows + RAT_BLOCK_LENGTH - 1) / RAT_BLOCK_LENGTH;
                 
-                // Loop through block
-                for(int j = 0; j < RAT_BLOCK_LENGTH; ++j)
+                // The RAT (and column cache) can only be accessed by one thread at a time.
+                std::mutex ioMutex;
+                rsgis::RSGISThreadPool threadPool(nThreads);
+                rsgis::RSGISStripIOPipeline ioPipeline(numBuffers);
+                rsgis_tqdm pbar;
+                ioPipeline.run(nBlocks, [&](size_t blk, unsigned int buf)
                 {
-                    // Show progress
-                    pbar.progress(rowID, nRows);
-                    
-                    for(unsigned int n = 0; n < numInRealCols; ++n)
+                    size_t startRow = blk * RAT_BLOCK_LENGTH;
+                    size_t blockRows = std::min<size_t>(RAT_BLOCK_LENGTH, nRows - startRow);
+                    std::lock_guard<std::mutex> lock(ioMutex);
+                    for(unsigned int t = 0; t < nThreads; ++t)
                     {
-                        dCalcInVals[n] = inRealData[n][j];
+                        RSGISRATCalcChunk *chunk = &buffers[buf][t];
+                        chunk->startRow = startRow + ((blockRows * t) / nThreads);
+                        chunk->numRows = (startRow + ((blockRows * (t+1)) / nThreads)) - chunk->startRow;
+                        this->readChunk(gdalRAT, inRealColIdx, inIntColIdx, inStrColIdx, chunk);
                     }
-                    
-                    for(unsigned int n = 0; n < numInIntCols; ++n)
-                    {
-                        iCalcInVals[n] = inIntData[n][j];
-                    }
-                    
-                    for(unsigned int n = 0; n < numInStrCols; ++n)
-                    {
-                        sCalcInVals[n] = std::string(inStrData[n][j]);
-                    }
-                    
-                    this->ratCalcVal->calcRATValue(rowID, dCalcInVals, numInRealCols, iCalcInVals, numInIntCols, sCalcInVals, numInStrCols, dCalcOutVals, numOutRealCols, iCalcOutVals, numOutIntCols, sCalcOutVals, numOutStrCols);
-                    
-                    for(unsigned int n = 0; n < numOutRealCols; ++n)
-                    {
-                        outRealData[n][j] = dCalcOutVals[n];
-                    }
-                    
-                    for(unsigned int n = 0; n < numOutIntCols; ++n)
-                    {
-                        outIntData[n][j] = iCalcOutVals[n];
-                    }
-                    
-                    for(unsigned int n = 0; n < numOutStrCols; ++n)
+                },
+                [&](size_t blk, unsigned int buf)
+                {
+                    pbar.progress(blk * RAT_BLOCK_LENGTH, nRows);
+                    threadPool.parallelFor(0, nThreads, [&](unsigned int w, size_t tStart, size_t tEnd)
                     {
-                        outStrData[n][j] = new char[sCalcOutVals[n].size()];
-                        strcpy(outStrData[n][j], sCalcOutVals[n].c_str());
-                        //outStrData[n][j] = const_cast<char*>(sCalcOutVals[n].c_str());
-                    }
-                    
-                    ++rowID;
-                }
-                
-                //Write blocks
-                for(unsigned int n = 0; n < numOutRealCols; ++n)
+                        for(size_t t = tStart; t < tEnd; ++t)
+                        {
+                            this->calcChunk(&threads[t], &buffers[buf][t]);
+                        }
+                    });
+                },
+                [&](size_t blk, unsigned int buf)
                 {
-                    gdalRAT->ValuesIO(GF_Write, outRealColIdx[n], startRow, RAT_BLOCK_LENGTH, outRealData[n]);
-                    for(int j = 0; j < RAT_BLOCK_LENGTH; ++j)
+                    std::lock_guard<std::mutex> lock(ioMutex);
+                    for(unsigned int t = 0; t < nThreads; ++t)
                     {
-                        outRealData[n][j] = 0.0;
+                        this->writeChunk(gdalRAT, outRealColIdx, outIntColIdx, outStrColIdx, &buffers[buf][t]);
                     }
-                }
+                });
+                pbar.finish();
                 
-                for(unsigned int n = 0; n < numOutIntCols; ++n)
+                for(unsigned int t = 1; t < nThreads; ++t)
                 {
-                    gdalRAT->ValuesIO(GF_Write, outIntColIdx[n], startRow, RAT_BLOCK_LENGTH, outIntData[n]);
-                    for(int j = 0; j < RAT_BLOCK_LENGTH; ++j)
-                    {
-                        outIntData[n][j] = 0.0;
-                    }
+                    this->ratCalcVal->reduce(threadCalcs[t]);
                 }
-                
-                for(unsigned int n = 0; n < numOutStrCols; ++n)
+            }
+            catch(...)
+            {
+                this->deleteThreadCalcs(threadCalcs);
+                throw;
+            }
+            this->deleteThreadCalcs(threadCalcs);
+        }
+        catch (RSGISAttributeTableException &e)
+        {
+            throw e;
+        }
+        catch (RSGISException &e)
+        {
+            throw RSGISAttributeTableException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw RSGISAttributeTableException(e.what());
+        }
+    }
+    
+    std::vector<RSGISRATCalcValue*> RSGISRATCalc::createThreadCalcs()
+    {
+        std::vector<RSGISRATCalcValue*> threadCalcs;
+        threadCalcs.push_back(this->ratCalcVal);
+        
+        unsigned int nThreads = this->numThreads;
+        if(nThreads == 0)
+        {
+            nThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+        }
+        
+        for(unsigned int i = 1; i < nThreads; ++i)
+        {
+            RSGISRATCalcValue *threadCalc = this->ratCalcVal->clone();
+            if(threadCalc == NULL)
+            {
+                // The rows are not independent so use the serial code path.
+                this->deleteThreadCalcs(threadCalcs);
+                break;
+            }
+            threadCalcs.push_back(threadCalc);
+        }
+        
+        return threadCalcs;
+    }
+    
+    void RSGISRATCalc::deleteThreadCalcs(std::vector<RSGISRATCalcValue*> &threadCalcs)
+    {
+        for(size_t i = 1; i < threadCalcs.size(); ++i)
+        {
+            delete threadCalcs.at(i);
+        }
+        if(!threadCalcs.empty())
+        {
+            threadCalcs.resize(1);
+        }
+    }
+    
+    void RSGISRATCalc::readChunk(GDALRasterAttributeTable *gdalRAT, const std::vector<unsigned int> &inRealColIdx, const std::vector<unsigned int> &inIntColIdx, const std::vector<unsigned int> &inStrColIdx, RSGISRATCalcChunk *chunk)
+    {
+        if(chunk->numRows == 0)
+        {
+            return;
+        }
+        
+        for(unsigned int n = 0; n < inRealColIdx.size(); ++n)
+        {
+            chunk->inRealData[n].resize(chunk->numRows);
+            this->readRealValues(gdalRAT, inRealColIdx[n], chunk->startRow, chunk->numRows, chunk->inRealData[n].data());
+        }
+        
+        for(unsigned int n = 0; n < inIntColIdx.size(); ++n)
+        {
+            chunk->inIntData[n].resize(chunk->numRows);
+            this->readIntValues(gdalRAT, inIntColIdx[n], chunk->startRow, chunk->numRows, chunk->inIntData[n].data());
+        }
+        
+        std::vector<char*> strPtrs(chunk->numRows, NULL);
+        for(unsigned int n = 0; n < inStrColIdx.size(); ++n)
+        {
+            // The strings read are allocated by GDAL, so pack them into the column buffer and free them.
+            RSGISRATStringColumn *strCol = &chunk->inStrData[n];
+            gdalRAT->ValuesIO(GF_Read, inStrColIdx[n], chunk->startRow, chunk->numRows, strPtrs.data());
+            strCol->offsets.resize(chunk->numRows);
+            strCol->data.clear();
+            for(size_t j = 0; j < chunk->numRows; ++j)
+            {
+                strCol->offsets[j] = strCol->data.size();
+                if(strPtrs[j] != NULL)
                 {
-                    gdalRAT->ValuesIO(GF_Write, outStrColIdx[n], startRow, RAT_BLOCK_LENGTH, outStrData[n]);
-                    for(int j = 0; j < RAT_BLOCK_LENGTH; ++j)
-                    {
-                        outStrData[n][j] = RSGIS_C_TEXT("");
-                    }
+                    strCol->data.insert(strCol->data.end(), strPtrs[j], strPtrs[j] + strlen(strPtrs[j]));
+                    CPLFree(strPtrs[j]);
+                    strPtrs[j] = NULL;
                 }
-                
-                startRow += RAT_BLOCK_LENGTH;
+                strCol->data.push_back('\0');
             }
-            if(remainRows > 0)
+        }
+    }
+    
+    void RSGISRATCalc::calcChunk(RSGISRATCalcThread *thread, RSGISRATCalcChunk *chunk)
+    {
+        unsigned int numInRealCols = chunk->inRealData.size();
+        unsigned int numInIntCols = chunk->inIntData.size();
+        unsigned int numInStrCols = chunk->inStrData.size();
+        unsigned int numOutRealCols = chunk->outRealData.size();
+        unsigned int numOutIntCols = chunk->outIntData.size();
+        unsigned int numOutStrCols = chunk->outStrData.size();
+        
+        std::vector<double*> inRealCols(numInRealCols);
+        std::vector<int*> inIntCols(numInIntCols);
+        std::vector<double*> outRealCols(numOutRealCols);
+        std::vector<int*> outIntCols(numOutIntCols);
+        std::vector<std::string*> outStrCols(numOutStrCols);
+        for(unsigned int n = 0; n < numInRealCols; ++n)
+        {
+            inRealCols[n] = chunk->inRealData[n].data();
+        }
+        for(unsigned int n = 0; n < numInIntCols; ++n)
+        {
+            inIntCols[n] = chunk->inIntData[n].data();
+        }
+        for(unsigned int n = 0; n < numOutRealCols; ++n)
+        {
+            chunk->outRealData[n].assign(chunk->numRows, 0.0);
+            outRealCols[n] = chunk->outRealData[n].data();
+        }
+        for(unsigned int n = 0; n < numOutIntCols; ++n)
+        {
+            chunk->outIntData[n].assign(chunk->numRows, 0);
+            outIntCols[n] = chunk->outIntData[n].data();
+        }
+        for(unsigned int n = 0; n < numOutStrCols; ++n)
+        {
+            chunk->outStrData[n].assign(chunk->numRows, std::string());
+            outStrCols[n] = chunk->outStrData[n].data();
+        }
+        
+        if(thread->useBlockCalc)
+        {
+            thread->useBlockCalc = thread->calc->calcRATBlock(chunk->startRow, chunk->numRows, inRealCols.data(), numInRealCols, inIntCols.data(), numInIntCols, chunk->inStrData.data(), numInStrCols, outRealCols.data(), numOutRealCols, outIntCols.data(), numOutIntCols, outStrCols.data(), numOutStrCols);
+        }
+        
+        if(!thread->useBlockCalc)
+        {
+            // Loop through the rows
+            for(size_t j = 0; j < chunk->numRows; ++j)
             {
-                // Read blocks
                 for(unsigned int n = 0; n < numInRealCols; ++n)
                 {
-                    gdalRAT->ValuesIO(GF_Read, inRealColIdx[n], startRow, remainRows, inRealData[n]);
+                    thread->inRealVals[n] = inRealCols[n][j];
                 }
                 
                 for(unsigned int n = 0; n < numInIntCols; ++n)
                 {
-                    gdalRAT->ValuesIO(GF_Read, inIntColIdx[n], startRow, remainRows, inIntData[n]);
+                    thread->inIntVals[n] = inIntCols[n][j];
                 }
                 
                 for(unsigned int n = 0; n < numInStrCols; ++n)
                 {
-                    gdalRAT->ValuesIO(GF_Read, inStrColIdx[n], startRow, remainRows, inStrData[n]);
+                    thread->inStrVals[n] = chunk->inStrData[n].getValue(j);
                 }
                 
-                // Loop through block
-                for(int j = 0; j < remainRows; ++j)
-                {
-                    // Show progress
-                    pbar.progress(rowID, nRows);
-                    
-                    for(unsigned int n = 0; n < numInRealCols; ++n)
-                    {
-                        dCalcInVals[n] = inRealData[n][j];
-                    }
-                    
-                    for(unsigned int n = 0; n < numInIntCols; ++n)
-                    {
-                        iCalcInVals[n] = inIntData[n][j];
-                    }
-                    
-                    for(unsigned int n = 0; n < numInStrCols; ++n)
-                    {
-                        sCalcInVals[n] = std::string(inStrData[n][j]);
-                    }
-                    
-                    this->ratCalcVal->calcRATValue(rowID, dCalcInVals, numInRealCols, iCalcInVals, numInIntCols, sCalcInVals, numInStrCols, dCalcOutVals, numOutRealCols, iCalcOutVals, numOutIntCols, sCalcOutVals, numOutStrCols);
-                    
-                    for(unsigned int n = 0; n < numOutRealCols; ++n)
-                    {
-                        outRealData[n][j] = dCalcOutVals[n];
-                    }
-                    
-                    for(unsigned int n = 0; n < numOutIntCols; ++n)
-                    {
-                        outIntData[n][j] = iCalcOutVals[n];
-                    }
-                    
-                    for(unsigned int n = 0; n < numOutStrCols; ++n)
-                    {
-                        outStrData[n][j] = new char[sCalcOutVals[n].size()];
-                        strcpy(outStrData[n][j], sCalcOutVals[n].c_str());
-                        //outStrData[n][j] =  const_cast<char*>(sCalcOutVals[n].c_str());
-                    }
-                    
-                    ++rowID;
-                }
+                thread->calc->calcRATValue(chunk->startRow + j, thread->inRealVals.data(), numInRealCols, thread->inIntVals.data(), numInIntCols, thread->inStrVals.data(), numInStrCols, thread->outRealVals.data(), numOutRealCols, thread->outIntVals.data(), numOutIntCols, thread->outStrVals.data(), numOutStrCols);
                 
-                // Write blocks
                 for(unsigned int n = 0; n < numOutRealCols; ++n)
                 {
-                    gdalRAT->ValuesIO(GF_Write, outRealColIdx[n], startRow, remainRows, outRealData[n]);
+                    outRealCols[n][j] = thread->outRealVals[n];
                 }
                 
                 for(unsigned int n = 0; n < numOutIntCols; ++n)
                 {
-                    gdalRAT->ValuesIO(GF_Write, outIntColIdx[n], startRow, remainRows, outIntData[n]);
+                    outIntCols[n][j] = thread->outIntVals[n];
                 }
                 
                 for(unsigned int n = 0; n < numOutStrCols; ++n)
                 {
-                    gdalRAT->ValuesIO(GF_Write, outStrColIdx[n], startRow, remainRows, outStrData[n]);
-                }
-            }
-            pbar.finish();
-            
-            // Clean out and release memory...
-            if(numInRealCols > 0)
-            {
-                for(unsigned int i = 0; i < numInRealCols; ++i)
-                {
-                    delete[] inRealData[i];
-                }
-                delete[] inRealData;
-            }
-            if(numOutRealCols > 0)
-            {
-                for(unsigned int i = 0; i < numOutRealCols; ++i)
-                {
-                    delete[] outRealData[i];
-                }
-                delete[] outRealData;
-            }
-            if(numInIntCols > 0)
-            {
-                for(unsigned int i = 0; i < numInIntCols; ++i)
-                {
-                    delete[] inIntData[i];
-                }
-                delete[] inIntData;
-            }
-            if(numOutIntCols > 0)
-            {
-                for(unsigned int i = 0; i < numOutIntCols; ++i)
-                {
-                    delete[] outIntData[i];
-                }
-                delete[] outIntData;
-            }
-            if(numInStrCols > 0)
-            {
-                for(unsigned int i = 0; i < numInStrCols; ++i)
-                {
-                    delete[] inStrData[i];
-                }
-                delete[] inStrData;
-            }
-            if(numOutStrCols > 0)
-            {
-                for(unsigned int i = 0; i < numOutStrCols; ++i)
-                {
-                    delete[] outStrData[i];
+                    outStrCols[n][j] = thread->outStrVals[n];
                 }
-                delete[] outStrData;
-            }
-            if(numInRealCols > 0)
-            {
-                delete[] dCalcInVals;
-            }
-            if(numInIntCols > 0)
-            {
-                delete[] iCalcInVals;
-            }
-            if(numInStrCols > 0)
-            {
-                delete[] sCalcInVals;
-            }
-            if(numOutRealCols > 0)
-            {
-                delete[] dCalcOutVals;
             }
-            if(numOutIntCols > 0)
+        }
+    }
+    
+    void RSGISRATCalc::writeChunk(GDALRasterAttributeTable *gdalRAT, const std::vector<unsigned int> &outRealColIdx, const std::vector<unsigned int> &outIntColIdx, const std::vector<unsigned int> &outStrColIdx, RSGISRATCalcChunk *chunk)
+    {
+        if(chunk->numRows == 0)
+        {
+            return;
+        }
+        
+        for(unsigned int n = 0; n < outRealColIdx.size(); ++n)
+        {
+            this->writeRealValues(gdalRAT, outRealColIdx[n], chunk->startRow, chunk->numRows, chunk->outRealData[n].data());
+        }
+        
+        for(unsigned int n = 0; n < outIntColIdx.size(); ++n)
+        {
+            this->writeIntValues(gdalRAT, outIntColIdx[n], chunk->startRow, chunk->numRows, chunk->outIntData[n].data());
+        }
+        
+        // GDAL copies the strings written.
+        std::vector<char*> strPtrs(chunk->numRows, NULL);
+        for(unsigned int n = 0; n < outStrColIdx.size(); ++n)
+        {
+            for(size_t j = 0; j < chunk->numRows; ++j)
             {
-                delete[] iCalcOutVals;
+                strPtrs[j] = const_cast<char*>(chunk->outStrData[n][j].c_str());
             }
-            if(numOutStrCols > 0)
-            {
-                delete[] sCalcOutVals;
-            }            
+            gdalRAT->ValuesIO(GF_Write, outStrColIdx[n], chunk->startRow, chunk->numRows, strPtrs.data());
         }
-        catch (RSGISAttributeTableException &e)
+    }
+    
+    void RSGISRATCalc::readRealValues(GDALRasterAttributeTable *gdalRAT, unsigned int colIdx, size_t startRow, size_t numRows, double *data)
+    {
+        if(this->colCache != NULL)
         {
-            throw e;
+            this->colCache->readRealValues(colIdx, startRow, numRows, data);
         }
-        catch (RSGISException &e)
+        else
         {
-            throw RSGISAttributeTableException(e.what());
+            gdalRAT->ValuesIO(GF_Read, colIdx, startRow, numRows, data);
         }
-        catch (std::exception &e)
+    }
+    
+    void RSGISRATCalc::writeRealValues(GDALRasterAttributeTable *gdalRAT, unsigned int colIdx, size_t startRow, size_t numRows, double *data)
+    {
+        if(this->colCache != NULL)
         {
-            throw RSGISAttributeTableException(e.what());
+            this->colCache->writeRealValues(colIdx, startRow, numRows, data);
+        }
+        else
+        {
+            gdalRAT->ValuesIO(GF_Write, colIdx, startRow, numRows, data);
+        }
+    }
+    
+    void RSGISRATCalc::readIntValues(GDALRasterAttributeTable *gdalRAT, unsigned int colIdx, size_t startRow, size_t numRows, int *data)
+    {
+        if(this->colCache != NULL)
+        {
+            this->colCache->readIntValues(colIdx, startRow, numRows, data);
+        }
+        else
+        {
+            gdalRAT->ValuesIO(GF_Read, colIdx, startRow, numRows, data);
+        }
+    }
+    
+    void RSGISRATCalc::writeIntValues(GDALRasterAttributeTable *gdalRAT, unsigned int colIdx, size_t startRow, size_t numRows, int *data)
+    {
+        if(this->colCache != NULL)
+        {
+            this->colCache->writeIntValues(colIdx, startRow, numRows, data);
+        }
+        else
+        {
+            gdalRAT->ValuesIO(GF_Write, colIdx, startRow, numRows, data);
         }
     }
     
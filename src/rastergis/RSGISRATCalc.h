@@ -25,15 +25,23 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <cstring>
 #include <cmath>
+#include <algorithm>
+#include <mutex>
 
 #include "gdal_priv.h"
 
 #include "common/rsgis-tqdm.h"
 #include "common/RSGISAttributeTableException.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISStripIOPipeline.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
 #include "rastergis/RSGISRATCalcValue.h"
+#include "rastergis/RSGISRATColumnCache.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -50,14 +58,74 @@
 
 namespace rsgis{namespace rastergis{
     
+    /** The values of a chunk of the rows of a RAT, stored by column. */
+    struct DllExport RSGISRATCalcChunk
+    {
+        size_t startRow;
+        size_t numRows;
+        std::vector< std::vector<double> > inRealData;
+        std::vector< std::vector<int> > inIntData;
+        std::vector<RSGISRATStringColumn> inStrData;
+        std::vector< std::vector<double> > outRealData;
+        std::vector< std::vector<int> > outIntData;
+        std::vector< std::vector<std::string> > outStrData;
+    };
+    
+    /** The calculation used by a thread and the values of a row passed to calcRATValue. */
+    struct DllExport RSGISRATCalcThread
+    {
+        RSGISRATCalcValue *calc;
+        bool useBlockCalc;
+        std::vector<double> inRealVals;
+        std::vector<int> inIntVals;
+        std::vector<std::string> inStrVals;
+        std::vector<double> outRealVals;
+        std::vector<int> outIntVals;
+        std::vector<std::string> outStrVals;
+    };
+    
     class DllExport RSGISRATCalc
     {
     public:
-        RSGISRATCalc(RSGISRATCalcValue *ratCalcVal);
+        /**
+         * If a column cache is provided the real and integer columns are read and
+         * written through the cache (which must be for the RAT being processed),
+         * otherwise they are read directly from the RAT.
+         *
+         * The rows are read in blocks of RAT_BLOCK_LENGTH, which are passed to
+         * RSGISRATCalcValue::calcRATBlock if it is implemented, otherwise the
+         * rows of the block are passed to calcRATValue one at a time.
+         *
+         * If the RSGISRATCalcValue implements clone() the rows of each block are
+         * split between threads (see setNumThreads), and the next block is read
+         * and the previous block written while a block is calculated (see
+         * setNumIOBuffers). The column I/O is serialised so the RAT (and column
+         * cache) is only accessed by one thread at a time and the blocks are
+         * written in order.
+         */
+        RSGISRATCalc(RSGISRATCalcValue *ratCalcVal, RSGISRATColumnCache *colCache=NULL);
         virtual void calcRATValues(GDALRasterAttributeTable *gdalRAT, std::vector<unsigned int> inRealColIdx, std::vector<unsigned int> inIntColIdx, std::vector<unsigned int> inStrColIdx, std::vector<unsigned int> outRealColIdx, std::vector<unsigned int> outIntColIdx, std::vector<unsigned int> outStrColIdx);
+        /** Set the number of threads (0 is the number of hardware threads); the default is from the default execution context. */
+        void setNumThreads(unsigned int numThreads){this->numThreads = numThreads;};
+        unsigned int getNumThreads(){return this->numThreads;};
+        /** Set the number of block buffers when multiple threads are used (at least 2 so the I/O overlaps with the calculation). */
+        void setNumIOBuffers(unsigned int numIOBuffers){this->numIOBuffers = numIOBuffers;};
+        unsigned int getNumIOBuffers(){return this->numIOBuffers;};
         virtual ~RSGISRATCalc();
     protected:
+        std::vector<RSGISRATCalcValue*> createThreadCalcs();
+        void deleteThreadCalcs(std::vector<RSGISRATCalcValue*> &threadCalcs);
+        void readChunk(GDALRasterAttributeTable *gdalRAT, const std::vector<unsigned int> &inRealColIdx, const std::vector<unsigned int> &inIntColIdx, const std::vector<unsigned int> &inStrColIdx, RSGISRATCalcChunk *chunk);
+        void calcChunk(RSGISRATCalcThread *thread, RSGISRATCalcChunk *chunk);
+        void writeChunk(GDALRasterAttributeTable *gdalRAT, const std::vector<unsigned int> &outRealColIdx, const std::vector<unsigned int> &outIntColIdx, const std::vector<unsigned int> &outStrColIdx, RSGISRATCalcChunk *chunk);
+        void readRealValues(GDALRasterAttributeTable *gdalRAT, unsigned int colIdx, size_t startRow, size_t numRows, double *data);
+        void writeRealValues(GDALRasterAttributeTable *gdalRAT, unsigned int colIdx, size_t startRow, size_t numRows, double *data);
+        void readIntValues(GDALRasterAttributeTable *gdalRAT, unsigned int colIdx, size_t startRow, size_t numRows, int *data);
+        void writeIntValues(GDALRasterAttributeTable *gdalRAT, unsigned int colIdx, size_t startRow, size_t numRows, int *data);
         RSGISRATCalcValue *ratCalcVal;
+        RSGISRATColumnCache *colCache;
+        unsigned int numThreads;
+        unsigned int numIOBuffers;
     };
     
 }}
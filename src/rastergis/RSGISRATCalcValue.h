@@ -25,6 +25,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include <cmath>
 
 #include "common/RSGISAttributeTableException.h"
@@ -46,11 +47,45 @@
 
 namespace rsgis{namespace rastergis{
     
+    /**
+     * The values of a block of rows of a string column packed into one buffer,
+     * where the (null terminated) value of row i is &data[offsets[i]].
+     */
+    struct DllExport RSGISRATStringColumn
+    {
+        std::vector<size_t> offsets;
+        std::vector<char> data;
+        const char* getValue(size_t i) const {return &this->data[this->offsets[i]];};
+    };
+    
     class DllExport RSGISRATCalcValue
     {
     public:
         RSGISRATCalcValue(){};
         virtual void calcRATValue(size_t fid, double *inRealCols, unsigned int numInRealCols, int *inIntCols, unsigned int numInIntCols, std::string *inStringCols, unsigned int numInStringCols, double *outRealCols, unsigned int numOutRealCols, int *outIntCols, unsigned int numOutIntCols, std::string *outStringCols, unsigned int numOutStringCols) = 0;
+        /**
+         * Calculate the values of numRows rows (from startFID) at once, where the
+         * value of row i of real input column n is inRealCols[n][i] (and likewise
+         * for the integer columns and the outputs). The output columns are 0 (or
+         * empty strings) when called. Returns false if it is not implemented, in
+         * which case calcRATValue is called for each row, so an implementation
+         * which returns false must not have changed any values.
+         */
+        virtual bool calcRATBlock(size_t startFID, size_t numRows, double **inRealCols, unsigned int numInRealCols, int **inIntCols, unsigned int numInIntCols, const RSGISRATStringColumn *inStringCols, unsigned int numInStringCols, double **outRealCols, unsigned int numOutRealCols, int **outIntCols, unsigned int numOutIntCols, std::string **outStringCols, unsigned int numOutStringCols){return false;};
+        /**
+         * Create an independent copy of this object which can be used from another
+         * thread to calculate a different set of rows, so should only be implemented
+         * by calculations where the values of a row do not depend on the rows before
+         * it. The caller takes ownership of the returned object. The default returns
+         * NULL, which means the rows are calculated in order on one thread.
+         */
+        virtual RSGISRATCalcValue* clone(){return NULL;};
+        /**
+         * Merge the state accumulated by a clone (created with clone()) into this
+         * object. Only needs to be implemented by classes which accumulate values
+         * (e.g., counts) rather than just writing output columns.
+         */
+        virtual void reduce(RSGISRATCalcValue *other){};
         virtual ~RSGISRATCalcValue(){};
     };
     
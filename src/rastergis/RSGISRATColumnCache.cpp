@@ -0,0 +1,329 @@
+/*
+ *  RSGISRATColumnCache.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISRATColumnCache.h"
+#include "RSGISRATColumnSummary.h"
+
+namespace rsgis{namespace rastergis{
+    
+    RSGISRATColumnCache::RSGISRATColumnCache(GDALRasterAttributeTable *gdalRAT, size_t maxBytes)
+    {
+        if(gdalRAT == NULL)
+        {
+            throw RSGISAttributeTableException("The RAT passed to the column cache is NULL.");
+        }
+        this->gdalRAT = gdalRAT;
+        this->numRows = gdalRAT->GetRowCount();
+        this->maxBytes = maxBytes;
+        this->cacheBytes = 0;
+        this->useCounter = 0;
+        this->pinnedBytes = 0;
+    }
+    
+    void RSGISRATColumnCache::readRealValues(unsigned int colIdx, size_t startRow, size_t numRows, double *data)
+    {
+        this->checkRows(startRow, numRows);
+        size_t row = startRow;
+        size_t endRow = startRow + numRows;
+        while(row < endRow)
+        {
+            size_t chunkIdx = row / RAT_BLOCK_LENGTH;
+            size_t chunkOff = row - (chunkIdx * RAT_BLOCK_LENGTH);
+            size_t nChunkRows = std::min(this->getChunkNumRows(chunkIdx) - chunkOff, endRow - row);
+            RSGISRATColumnChunk *chunk = this->getChunk(colIdx, chunkIdx, false, true);
+            std::copy(chunk->realVals.begin() + chunkOff, chunk->realVals.begin() + chunkOff + nChunkRows, data + (row - startRow));
+            row += nChunkRows;
+        }
+        this->checkMemoryBudget();
+    }
+    
+    void RSGISRATColumnCache::writeRealValues(unsigned int colIdx, size_t startRow, size_t numRows, double *data)
+    {
+        this->checkRows(startRow, numRows);
+        size_t row = startRow;
+        size_t endRow = startRow + numRows;
+        while(row < endRow)
+        {
+            size_t chunkIdx = row / RAT_BLOCK_LENGTH;
+            size_t chunkOff = row - (chunkIdx * RAT_BLOCK_LENGTH);
+            size_t nChunkRows = std::min(this->getChunkNumRows(chunkIdx) - chunkOff, endRow - row);
+            // The existing values only need reading if part of the block is being written.
+            bool partialChunk = (nChunkRows != this->getChunkNumRows(chunkIdx));
+            RSGISRATColumnChunk *chunk = this->getChunk(colIdx, chunkIdx, false, partialChunk);
+            std::copy(data + (row - startRow), data + (row - startRow) + nChunkRows, chunk->realVals.begin() + chunkOff);
+            chunk->dirty = true;
+            row += nChunkRows;
+        }
+        this->checkMemoryBudget();
+    }
+    
+    void RSGISRATColumnCache::readIntValues(unsigned int colIdx, size_t startRow, size_t numRows, int *data)
+    {
+        this->checkRows(startRow, numRows);
+        size_t row = startRow;
+        size_t endRow = startRow + numRows;
+        while(row < endRow)
+        {
+            size_t chunkIdx = row / RAT_BLOCK_LENGTH;
+            size_t chunkOff = row - (chunkIdx * RAT_BLOCK_LENGTH);
+            size_t nChunkRows = std::min(this->getChunkNumRows(chunkIdx) - chunkOff, endRow - row);
+            RSGISRATColumnChunk *chunk = this->getChunk(colIdx, chunkIdx, true, true);
+            std::copy(chunk->intVals.begin() + chunkOff, chunk->intVals.begin() + chunkOff + nChunkRows, data + (row - startRow));
+            row += nChunkRows;
+        }
+        this->checkMemoryBudget();
+    }
+    
+    void RSGISRATColumnCache::writeIntValues(unsigned int colIdx, size_t startRow, size_t numRows, int *data)
+    {
+        this->checkRows(startRow, numRows);
+        size_t row = startRow;
+        size_t endRow = startRow + numRows;
+        while(row < endRow)
+        {
+            size_t chunkIdx = row / RAT_BLOCK_LENGTH;
+            size_t chunkOff = row - (chunkIdx * RAT_BLOCK_LENGTH);
+            size_t nChunkRows = std::min(this->getChunkNumRows(chunkIdx) - chunkOff, endRow - row);
+            bool partialChunk = (nChunkRows != this->getChunkNumRows(chunkIdx));
+            RSGISRATColumnChunk *chunk = this->getChunk(colIdx, chunkIdx, true, partialChunk);
+            std::copy(data + (row - startRow), data + (row - startRow) + nChunkRows, chunk->intVals.begin() + chunkOff);
+            chunk->dirty = true;
+            row += nChunkRows;
+        }
+        this->checkMemoryBudget();
+    }
+    
+    double RSGISRATColumnCache::getRealValue(unsigned int colIdx, size_t row)
+    {
+        double val = 0.0;
+        this->readRealValues(colIdx, row, 1, &val);
+        return val;
+    }
+    
+    int RSGISRATColumnCache::getIntValue(unsigned int colIdx, size_t row)
+    {
+        int val = 0;
+        this->readIntValues(colIdx, row, 1, &val);
+        return val;
+    }
+    
+    std::vector<double>* RSGISRATColumnCache::readRealColumnAsVec(unsigned int colIdx)
+    {
+        std::vector<double> *colVals = new std::vector<double>(this->numRows, 0.0);
+        if(this->numRows > 0)
+        {
+            try
+            {
+                this->readRealValues(colIdx, 0, this->numRows, colVals->data());
+            }
+            catch(RSGISAttributeTableException &e)
+            {
+                delete colVals;
+                throw e;
+            }
+        }
+        return colVals;
+    }
+    
+    bool RSGISRATColumnCache::pinColumn(unsigned int colIdx)
+    {
+        if(this->pinnedCols.count(colIdx) > 0)
+        {
+            return true;
+        }
+        // Assume the column is held as real values (i.e., the larger of the two types).
+        size_t colBytes = this->numRows * sizeof(double);
+        if((this->pinnedBytes + colBytes) > this->maxBytes)
+        {
+            return false;
+        }
+        this->pinnedCols.insert(colIdx);
+        this->pinnedBytes += colBytes;
+        return true;
+    }
+    
+    void RSGISRATColumnCache::unpinColumn(unsigned int colIdx)
+    {
+        if(this->pinnedCols.erase(colIdx) > 0)
+        {
+            this->pinnedBytes -= this->numRows * sizeof(double);
+        }
+        this->checkMemoryBudget();
+    }
+    
+    void RSGISRATColumnCache::flush()
+    {
+        // The map is ordered by column and then block so blocks are written in row order.
+        for(std::map<std::pair<unsigned int, size_t>, RSGISRATColumnChunk*>::iterator iterChunk = this->chunks.begin(); iterChunk != this->chunks.end(); ++iterChunk)
+        {
+            if(iterChunk->second->dirty)
+            {
+                this->writeChunk(iterChunk->first.first, iterChunk->first.second, iterChunk->second);
+            }
+        }
+    }
+    
+    RSGISRATColumnChunk* RSGISRATColumnCache::getChunk(unsigned int colIdx, size_t chunkIdx, bool isInt, bool readVals)
+    {
+        if(colIdx >= ((unsigned int)this->gdalRAT->GetColumnCount()))
+        {
+            throw RSGISAttributeTableException("Column index is not within the RAT.");
+        }
+        
+        std::pair<unsigned int, size_t> chunkKey = std::pair<unsigned int, size_t>(colIdx, chunkIdx);
+        std::map<std::pair<unsigned int, size_t>, RSGISRATColumnChunk*>::iterator iterChunk = this->chunks.find(chunkKey);
+        if(iterChunk != this->chunks.end())
+        {
+            if(iterChunk->second->isInt == isInt)
+            {
+                iterChunk->second->lastUsed = ++this->useCounter;
+                return iterChunk->second;
+            }
+            // The column is being accessed as the other type so write back and re-read the block.
+            this->removeChunk(iterChunk);
+            readVals = true;
+        }
+        
+        size_t nChunkRows = this->getChunkNumRows(chunkIdx);
+        RSGISRATColumnChunk *chunk = new RSGISRATColumnChunk();
+        chunk->isInt = isInt;
+        chunk->dirty = false;
+        chunk->lastUsed = ++this->useCounter;
+        if(isInt)
+        {
+            chunk->intVals.resize(nChunkRows, 0);
+            if(readVals && (this->gdalRAT->ValuesIO(GF_Read, colIdx, chunkIdx * RAT_BLOCK_LENGTH, nChunkRows, chunk->intVals.data()) != CE_None))
+            {
+                delete chunk;
+                throw RSGISAttributeTableException("Failed to read a block of an integer column from the RAT.");
+            }
+        }
+        else
+        {
+            chunk->realVals.resize(nChunkRows, 0.0);
+            if(readVals && (this->gdalRAT->ValuesIO(GF_Read, colIdx, chunkIdx * RAT_BLOCK_LENGTH, nChunkRows, chunk->realVals.data()) != CE_None))
+            {
+                delete chunk;
+                throw RSGISAttributeTableException("Failed to read a block of a real column from the RAT.");
+            }
+        }
+        this->chunks[chunkKey] = chunk;
+        this->cacheBytes += this->getChunkBytes(chunk);
+        
+        return chunk;
+    }
+    
+    void RSGISRATColumnCache::writeChunk(unsigned int colIdx, size_t chunkIdx, RSGISRATColumnChunk *chunk)
+    {
+        size_t nChunkRows = this->getChunkNumRows(chunkIdx);
+        CPLErr err = CE_None;
+        RSGISRATColumnSummaries::columnModified(this->gdalRAT, this->gdalRAT->GetNameOfCol(colIdx));
+        if(chunk->isInt)
+        {
+            err = this->gdalRAT->ValuesIO(GF_Write, colIdx, chunkIdx * RAT_BLOCK_LENGTH, nChunkRows, chunk->intVals.data());
+        }
+        else
+        {
+            err = this->gdalRAT->ValuesIO(GF_Write, colIdx, chunkIdx * RAT_BLOCK_LENGTH, nChunkRows, chunk->realVals.data());
+        }
+        if(err != CE_None)
+        {
+            throw RSGISAttributeTableException("Failed to write a block of a column to the RAT.");
+        }
+        chunk->dirty = false;
+    }
+    
+    void RSGISRATColumnCache::removeChunk(std::map<std::pair<unsigned int, size_t>, RSGISRATColumnChunk*>::iterator iterChunk)
+    {
+        if(iterChunk->second->dirty)
+        {
+            this->writeChunk(iterChunk->first.first, iterChunk->first.second, iterChunk->second);
+        }
+        this->cacheBytes -= this->getChunkBytes(iterChunk->second);
+        delete iterChunk->second;
+        this->chunks.erase(iterChunk);
+    }
+    
+    void RSGISRATColumnCache::checkMemoryBudget()
+    {
+        while(this->cacheBytes > this->maxBytes)
+        {
+            // Find the least recently used block which isn't pinned.
+            std::map<std::pair<unsigned int, size_t>, RSGISRATColumnChunk*>::iterator lruChunk = this->chunks.end();
+            for(std::map<std::pair<unsigned int, size_t>, RSGISRATColumnChunk*>::iterator iterChunk = this->chunks.begin(); iterChunk != this->chunks.end(); ++iterChunk)
+            {
+                if(this->pinnedCols.count(iterChunk->first.first) > 0)
+                {
+                    continue;
+                }
+                if((lruChunk == this->chunks.end()) || (iterChunk->second->lastUsed < lruChunk->second->lastUsed))
+                {
+                    lruChunk = iterChunk;
+                }
+            }
+            
+            if(lruChunk == this->chunks.end())
+            {
+                // Only pinned columns are left in the cache (which fit within the budget).
+                break;
+            }
+            this->removeChunk(lruChunk);
+        }
+    }
+    
+    size_t RSGISRATColumnCache::getChunkNumRows(size_t chunkIdx)
+    {
+        size_t chunkStart = chunkIdx * RAT_BLOCK_LENGTH;
+        return std::min<size_t>(RAT_BLOCK_LENGTH, this->numRows - chunkStart);
+    }
+    
+    size_t RSGISRATColumnCache::getChunkBytes(RSGISRATColumnChunk *chunk)
+    {
+        return (chunk->realVals.size() * sizeof(double)) + (chunk->intVals.size() * sizeof(int));
+    }
+    
+    void RSGISRATColumnCache::checkRows(size_t startRow, size_t numRows)
+    {
+        if((startRow + numRows) > this->numRows)
+        {
+            throw RSGISAttributeTableException("Rows requested from the column cache are beyond the end of the RAT.");
+        }
+    }
+    
+    RSGISRATColumnCache::~RSGISRATColumnCache()
+    {
+        try
+        {
+            this->flush();
+        }
+        catch(RSGISAttributeTableException &e)
+        {
+            std::cerr << "Error writing the RAT column cache: " << e.what() << std::endl;
+        }
+        
+        for(std::map<std::pair<unsigned int, size_t>, RSGISRATColumnChunk*>::iterator iterChunk = this->chunks.begin(); iterChunk != this->chunks.end(); ++iterChunk)
+        {
+            delete iterChunk->second;
+        }
+    }
+    
+}}
@@ -0,0 +1,123 @@
+/*
+ *  RSGISRATColumnCache.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISRATColumnCache_H
+#define RSGISRATColumnCache_H
+
+#define RAT_COLUMN_CACHE_BYTES 1073741824 // Define the default memory budget (1 GB) for RSGISRATColumnCache
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+
+#include "gdal_priv.h"
+#include "gdal_rat.h"
+
+#include "common/RSGISAttributeTableException.h"
+
+#include "rastergis/RSGISRasterAttUtils.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_rastergis_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace rastergis{
+    
+    /** A block of RAT_BLOCK_LENGTH rows of a column held by RSGISRATColumnCache. */
+    struct DllExport RSGISRATColumnChunk
+    {
+        bool isInt;
+        bool dirty;
+        size_t lastUsed;
+        std::vector<double> realVals;
+        std::vector<int> intVals;
+    };
+    
+    /**
+     * A cache of the real and integer columns of a RAT, which are read (when first
+     * accessed) in blocks of RAT_BLOCK_LENGTH rows. This lets algorithms which read
+     * the same columns several times (e.g., using RSGISRATCalc more than once) share
+     * the values rather than re-reading them. When the cache exceeds the memory budget
+     * the least recently used blocks are removed, except for pinned columns which are
+     * kept in memory. Writes are held in the cache until flush() is called (or the block
+     * is removed), when the modified blocks are written to the RAT in row order.
+     * Note, the RAT should not be written to other than through the cache while it is in use.
+     */
+    class DllExport RSGISRATColumnCache
+    {
+    public:
+        RSGISRATColumnCache(GDALRasterAttributeTable *gdalRAT, size_t maxBytes=RAT_COLUMN_CACHE_BYTES);
+        void readRealValues(unsigned int colIdx, size_t startRow, size_t numRows, double *data);
+        void writeRealValues(unsigned int colIdx, size_t startRow, size_t numRows, double *data);
+        void readIntValues(unsigned int colIdx, size_t startRow, size_t numRows, int *data);
+        void writeIntValues(unsigned int colIdx, size_t startRow, size_t numRows, int *data);
+        double getRealValue(unsigned int colIdx, size_t row);
+        int getIntValue(unsigned int colIdx, size_t row);
+        /** Read the whole column into a vector owned by the caller. */
+        std::vector<double>* readRealColumnAsVec(unsigned int colIdx);
+        /**
+         * Keep the blocks of the column in memory rather than removing them when the
+         * cache is full. Columns are only pinned while the pinned columns fit within
+         * the memory budget; returns false if the column could not be pinned.
+         */
+        bool pinColumn(unsigned int colIdx);
+        void unpinColumn(unsigned int colIdx);
+        /** Write all the modified blocks back to the RAT. */
+        void flush();
+        GDALRasterAttributeTable* getRAT(){return this->gdalRAT;};
+        size_t getNumRows(){return this->numRows;};
+        size_t getCacheBytes(){return this->cacheBytes;};
+        /** Writes any modified blocks back to the RAT. */
+        ~RSGISRATColumnCache();
+    protected:
+        RSGISRATColumnChunk* getChunk(unsigned int colIdx, size_t chunkIdx, bool isInt, bool readVals);
+        void writeChunk(unsigned int colIdx, size_t chunkIdx, RSGISRATColumnChunk *chunk);
+        void removeChunk(std::map<std::pair<unsigned int, size_t>, RSGISRATColumnChunk*>::iterator iterChunk);
+        void checkMemoryBudget();
+        size_t getChunkNumRows(size_t chunkIdx);
+        size_t getChunkBytes(RSGISRATColumnChunk *chunk);
+        void checkRows(size_t startRow, size_t numRows);
+        GDALRasterAttributeTable *gdalRAT;
+        size_t numRows;
+        size_t maxBytes;
+        size_t cacheBytes;
+        size_t useCounter;
+        std::map<std::pair<unsigned int, size_t>, RSGISRATColumnChunk*> chunks;
+        std::set<unsigned int> pinnedCols;
+        size_t pinnedBytes;
+    };
+    
+}}
+
+#endif
@@ -0,0 +1,286 @@
+/*
+ *  RSGISRATColumnSummary.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISRATColumnSummary.h"
+
+namespace rsgis{namespace rastergis{
+    
+    std::mutex RSGISRATColumnSummaries::modMutex;
+    size_t RSGISRATColumnSummaries::modCounter = 0;
+    std::map<std::pair<const void*, std::string>, size_t> RSGISRATColumnSummaries::modifiedCols;
+    std::map<std::pair<const void*, std::string>, size_t> RSGISRATColumnSummaries::validatedSummaries;
+    
+    RSGISRATColumnSummary RSGISRATColumnSummaries::getColumnSummary(GDALRasterBand *ratBand, std::string colName, std::string classColumn, std::string classVal)
+    {
+        if(ratBand == NULL)
+        {
+            throw RSGISAttributeTableException("The RAT band is NULL.");
+        }
+        GDALRasterAttributeTable *gdalRAT = ratBand->GetDefaultRAT();
+        if(gdalRAT == NULL)
+        {
+            throw RSGISAttributeTableException("The band does not have a RAT.");
+        }
+        
+        RSGISRasterAttUtils ratUtils;
+        unsigned int colIdx = ratUtils.findColumnIndex(gdalRAT, colName);
+        bool useClass = (classColumn != "");
+        unsigned int classColIdx = 0;
+        if(useClass)
+        {
+            classColIdx = ratUtils.findColumnIndex(gdalRAT, classColumn);
+        }
+        
+        std::string metadataKey = getMetadataKey(colName, classColumn, classVal);
+        std::string token = calcToken(gdalRAT, colIdx, useClass, classColIdx);
+        
+        RSGISRATColumnSummary summary;
+        const char *summaryStr = ratBand->GetMetadataItem(metadataKey.c_str());
+        if((summaryStr != NULL) && (!modifiedSinceValidated(gdalRAT, metadataKey, colName, classColumn)) && summaryFromString(std::string(summaryStr), token, &summary))
+        {
+            return summary;
+        }
+        
+        summary = calcColumnSummary(gdalRAT, colIdx, useClass, classColIdx, classVal);
+        GDALDataset *dataset = ratBand->GetDataset();
+        if((dataset != NULL) && (dataset->GetAccess() == GA_Update))
+        {
+            if(ratBand->SetMetadataItem(metadataKey.c_str(), summaryToString(summary, token).c_str()) == CE_None)
+            {
+                setValidated(gdalRAT, metadataKey);
+            }
+        }
+        return summary;
+    }
+    
+    void RSGISRATColumnSummaries::columnModified(const GDALRasterAttributeTable *gdalRAT, std::string colName)
+    {
+        std::lock_guard<std::mutex> lock(modMutex);
+        modifiedCols[std::pair<const void*, std::string>(gdalRAT, colName)] = ++modCounter;
+    }
+    
+    RSGISRATColumnSummary RSGISRATColumnSummaries::calcColumnSummary(GDALRasterAttributeTable *gdalRAT, unsigned int colIdx, bool useClass, unsigned int classColIdx, std::string classVal)
+    {
+        RSGISRATColumnSummary summary;
+        summary.numVals = 0;
+        summary.minVal = 0.0;
+        summary.maxVal = 0.0;
+        summary.mean = 0.0;
+        summary.histCounts.assign(RAT_COLUMN_SUMMARY_HIST_BINS, 0);
+        
+        size_t numRows = gdalRAT->GetRowCount();
+        if(numRows < 2)
+        {
+            return summary;
+        }
+        
+        // The rows (from row 1) which are summarised, found by the first pass.
+        std::vector<bool> useRows(numRows, false);
+        std::vector<double> vals(RAT_BLOCK_LENGTH);
+        std::vector<char*> classVals(useClass?RAT_BLOCK_LENGTH:0);
+        double sumVals = 0.0;
+        for(size_t startRow = 1; startRow < numRows; startRow += RAT_BLOCK_LENGTH)
+        {
+            size_t nBlockRows = std::min<size_t>(RAT_BLOCK_LENGTH, numRows - startRow);
+            if(gdalRAT->ValuesIO(GF_Read, colIdx, startRow, nBlockRows, vals.data()) != CE_None)
+            {
+                throw RSGISAttributeTableException("Could not read the column values.");
+            }
+            if(useClass)
+            {
+                if(gdalRAT->ValuesIO(GF_Read, classColIdx, startRow, nBlockRows, classVals.data()) != CE_None)
+                {
+                    throw RSGISAttributeTableException("Could not read the class column values.");
+                }
+            }
+            
+            for(size_t i = 0; i < nBlockRows; ++i)
+            {
+                bool useRow = std::isfinite(vals[i]);
+                if(useClass)
+                {
+                    useRow = useRow && (classVal == classVals[i]);
+                    CPLFree(classVals[i]);
+                }
+                if(useRow)
+                {
+                    if(summary.numVals == 0)
+                    {
+                        summary.minVal = vals[i];
+                        summary.maxVal = vals[i];
+                    }
+                    else if(vals[i] < summary.minVal)
+                    {
+                        summary.minVal = vals[i];
+                    }
+                    else if(vals[i] > summary.maxVal)
+                    {
+                        summary.maxVal = vals[i];
+                    }
+                    sumVals += vals[i];
+                    ++summary.numVals;
+                    useRows[startRow+i] = true;
+                }
+            }
+        }
+        
+        if(summary.numVals == 0)
+        {
+            return summary;
+        }
+        summary.mean = sumVals / summary.numVals;
+        
+        double range = summary.maxVal - summary.minVal;
+        for(size_t startRow = 1; startRow < numRows; startRow += RAT_BLOCK_LENGTH)
+        {
+            size_t nBlockRows = std::min<size_t>(RAT_BLOCK_LENGTH, numRows - startRow);
+            if(gdalRAT->ValuesIO(GF_Read, colIdx, startRow, nBlockRows, vals.data()) != CE_None)
+            {
+                throw RSGISAttributeTableException("Could not read the column values.");
+            }
+            for(size_t i = 0; i < nBlockRows; ++i)
+            {
+                if(useRows[startRow+i])
+                {
+                    size_t binIdx = 0;
+                    if(range > 0)
+                    {
+                        binIdx = std::min<size_t>(floor(((vals[i] - summary.minVal) / range) * RAT_COLUMN_SUMMARY_HIST_BINS), RAT_COLUMN_SUMMARY_HIST_BINS-1);
+                    }
+                    ++summary.histCounts[binIdx];
+                }
+            }
+        }
+        
+        return summary;
+    }
+    
+    std::string RSGISRATColumnSummaries::calcToken(GDALRasterAttributeTable *gdalRAT, unsigned int colIdx, bool useClass, unsigned int classColIdx)
+    {
+        // A FNV-1a hash of (up to) 256 evenly spaced rows of the columns.
+        size_t numRows = gdalRAT->GetRowCount();
+        size_t numSamples = std::min<size_t>(numRows, 256);
+        unsigned long long hash = 14695981039346656037ULL;
+        for(size_t n = 0; n < numSamples; ++n)
+        {
+            size_t row = (numSamples > 1)?((n * (numRows - 1)) / (numSamples - 1)):0;
+            double val = gdalRAT->GetValueAsDouble(row, colIdx);
+            std::string sampleStr = std::string(reinterpret_cast<const char*>(&val), sizeof(double));
+            if(useClass)
+            {
+                sampleStr += std::string(gdalRAT->GetValueAsString(row, classColIdx)) + '\n';
+            }
+            for(std::string::iterator iterChar = sampleStr.begin(); iterChar != sampleStr.end(); ++iterChar)
+            {
+                hash ^= (unsigned char)(*iterChar);
+                hash *= 1099511628211ULL;
+            }
+        }
+        
+        std::stringstream tokenStr;
+        tokenStr << numRows << ":" << std::hex << hash;
+        return tokenStr.str();
+    }
+    
+    std::string RSGISRATColumnSummaries::getMetadataKey(std::string colName, std::string classColumn, std::string classVal)
+    {
+        // The names can contain any characters so the key uses a hash of them.
+        std::string names = colName + '\n' + classColumn + '\n' + classVal;
+        unsigned long long hash = 14695981039346656037ULL;
+        for(std::string::iterator iterChar = names.begin(); iterChar != names.end(); ++iterChar)
+        {
+            hash ^= (unsigned char)(*iterChar);
+            hash *= 1099511628211ULL;
+        }
+        std::stringstream keyStr;
+        keyStr << "RSGIS_COLSUMMARY_" << std::hex << hash;
+        return keyStr.str();
+    }
+    
+    std::string RSGISRATColumnSummaries::summaryToString(const RSGISRATColumnSummary &summary, std::string token)
+    {
+        std::stringstream summaryStr;
+        summaryStr.precision(17);
+        summaryStr << token << ";" << summary.numVals << ";" << summary.minVal << ";" << summary.maxVal << ";" << summary.mean << ";" << summary.histCounts.size();
+        for(size_t i = 0; i < summary.histCounts.size(); ++i)
+        {
+            summaryStr << ((i == 0)?";":",") << summary.histCounts[i];
+        }
+        return summaryStr.str();
+    }
+    
+    bool RSGISRATColumnSummaries::summaryFromString(std::string summaryStr, std::string token, RSGISRATColumnSummary *summary)
+    {
+        std::stringstream inStr(summaryStr);
+        std::string storedToken;
+        if((!std::getline(inStr, storedToken, ';')) || (storedToken != token))
+        {
+            return false;
+        }
+        
+        char sep1, sep2, sep3, sep4;
+        size_t numBins = 0;
+        if(!(inStr >> summary->numVals >> sep1 >> summary->minVal >> sep2 >> summary->maxVal >> sep3 >> summary->mean >> sep4 >> numBins) || (sep1 != ';') || (sep2 != ';') || (sep3 != ';') || (sep4 != ';'))
+        {
+            return false;
+        }
+        summary->histCounts.assign(numBins, 0);
+        for(size_t i = 0; i < numBins; ++i)
+        {
+            char sep = 0;
+            if(!(inStr >> sep >> summary->histCounts[i]) || (sep != ((i == 0)?';':',')))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    bool RSGISRATColumnSummaries::modifiedSinceValidated(const GDALRasterAttributeTable *gdalRAT, std::string metadataKey, std::string colName, std::string classColumn)
+    {
+        std::lock_guard<std::mutex> lock(modMutex);
+        std::map<std::pair<const void*, std::string>, size_t>::iterator iterValid = validatedSummaries.find(std::pair<const void*, std::string>(gdalRAT, metadataKey));
+        std::vector<std::string> cols;
+        cols.push_back(colName);
+        if(classColumn != "")
+        {
+            cols.push_back(classColumn);
+        }
+        for(std::vector<std::string>::iterator iterCol = cols.begin(); iterCol != cols.end(); ++iterCol)
+        {
+            std::map<std::pair<const void*, std::string>, size_t>::iterator iterMod = modifiedCols.find(std::pair<const void*, std::string>(gdalRAT, *iterCol));
+            if((iterMod != modifiedCols.end()) && ((iterValid == validatedSummaries.end()) || ((*iterValid).second < (*iterMod).second)))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void RSGISRATColumnSummaries::setValidated(const GDALRasterAttributeTable *gdalRAT, std::string metadataKey)
+    {
+        std::lock_guard<std::mutex> lock(modMutex);
+        validatedSummaries[std::pair<const void*, std::string>(gdalRAT, metadataKey)] = ++modCounter;
+    }
+    
+}}
@@ -0,0 +1,115 @@
+/*
+ *  RSGISRATColumnSummary.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISRATColumnSummary_H
+#define RSGISRATColumnSummary_H
+
+#define RAT_COLUMN_SUMMARY_HIST_BINS 64 // Define the number of bins of the histogram sketch of RSGISRATColumnSummary
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <cmath>
+#include <algorithm>
+
+#include "gdal_priv.h"
+#include "gdal_rat.h"
+
+#include "common/RSGISAttributeTableException.h"
+
+#include "rastergis/RSGISRasterAttUtils.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_rastergis_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace rastergis{
+    
+    /**
+     * The summary of the finite values of a real or integer column (optionally only
+     * those rows of a class) from row 1 onwards, as row 0 is the no data clump. The
+     * histogram sketch has RAT_COLUMN_SUMMARY_HIST_BINS equal width bins over
+     * [minVal, maxVal]. If there are no values then numVals is 0 and the other
+     * values are 0.
+     */
+    struct DllExport RSGISRATColumnSummary
+    {
+        size_t numVals;
+        double minVal;
+        double maxVal;
+        double mean;
+        std::vector<size_t> histCounts;
+    };
+    
+    /**
+     * Column summaries which are stored in the metadata of the RAT band (so they are
+     * saved in a KEA file) so the analysis functions which need the range of a column
+     * do not need to read the whole column each time.
+     *
+     * Each summary is stored with a token (the number of rows and a hash of a sample
+     * of the column values) which is checked before it is used. The RAT writing
+     * functions (RSGISRasterAttUtils::write*Column, RSGISRATCalc and RSGISRATColumnCache)
+     * also call columnModified() so summaries of columns changed within the process
+     * are always recalculated. Columns changed by other software are only detected by
+     * the token.
+     */
+    class DllExport RSGISRATColumnSummaries
+    {
+    public:
+        /**
+         * Get the summary of a column, calculating it (and storing it if the dataset is
+         * open for update) if there is no valid stored summary. If classColumn is not
+         * "" then only the rows where the value of classColumn is classVal are summarised.
+         */
+        static RSGISRATColumnSummary getColumnSummary(GDALRasterBand *ratBand, std::string colName, std::string classColumn="", std::string classVal="");
+        /** Record that the values of a column have been changed. */
+        static void columnModified(const GDALRasterAttributeTable *gdalRAT, std::string colName);
+    protected:
+        static RSGISRATColumnSummary calcColumnSummary(GDALRasterAttributeTable *gdalRAT, unsigned int colIdx, bool useClass, unsigned int classColIdx, std::string classVal);
+        static std::string calcToken(GDALRasterAttributeTable *gdalRAT, unsigned int colIdx, bool useClass, unsigned int classColIdx);
+        static std::string getMetadataKey(std::string colName, std::string classColumn, std::string classVal);
+        static std::string summaryToString(const RSGISRATColumnSummary &summary, std::string token);
+        static bool summaryFromString(std::string summaryStr, std::string token, RSGISRATColumnSummary *summary);
+        static bool modifiedSinceValidated(const GDALRasterAttributeTable *gdalRAT, std::string metadataKey, std::string colName, std::string classColumn);
+        static void setValidated(const GDALRasterAttributeTable *gdalRAT, std::string metadataKey);
+        static std::mutex modMutex;
+        static size_t modCounter;
+        static std::map<std::pair<const void*, std::string>, size_t> modifiedCols;
+        static std::map<std::pair<const void*, std::string>, size_t> validatedSummaries;
+    };
+    
+}}
+
+#endif
@@ -53,11 +53,16 @@ namespace rsgis{namespace rastergis{
             unsigned int outExtrapFieldIdx = attUtils.findColumnIndexOrCreate(gdalAtt, outExtrapField, gdalAtt->GetTypeOfCol(inExtrapFieldIdx));
             
             
+            // The training and feature columns are read by each of the passes through
+            // the RAT below so they are shared through a column cache.
+            RSGISRATColumnCache colCache(gdalAtt);
+            colCache.pinColumn(trainRegFieldIdx);
+            
             // Find out how many training samples there are.
             std::cout << "Count Number of Training Sample\n";
             size_t numTrainFeats = 0;
             RSGISCountTrainingValues countTrainSamplesVals = RSGISCountTrainingValues(&numTrainFeats);
-            RSGISRATCalc ratCalc = RSGISRATCalc(&countTrainSamplesVals);
+            RSGISRATCalc ratCalc = RSGISRATCalc(&countTrainSamplesVals, &colCache);
             std::vector<unsigned int> inRealColIdx;
             std::vector<unsigned int> inIntColIdx;
             inIntColIdx.push_back(trainRegFieldIdx);
@@ -87,6 +92,10 @@ namespace rsgis{namespace rastergis{
                 fieldsIdx.push_back(idx);
                 inRealColIdx.push_back(idx);
             }
+            for(std::vector<unsigned int>::iterator iterIdx = inRealColIdx.begin(); iterIdx != inRealColIdx.end(); ++iterIdx)
+            {
+                colCache.pinColumn(*iterIdx);
+            }
             
             
             // Allocate memory for training data
@@ -104,9 +113,10 @@ namespace rsgis{namespace rastergis{
             // Extract training data
             std::cout << "Extract Training Data\n";
             RSGISExtractTrainingValues extractVals = RSGISExtractTrainingValues(trainData, numTrainFeats, numFloatVals);
-            ratCalc = RSGISRATCalc(&extractVals);
+            ratCalc = RSGISRATCalc(&extractVals, &colCache);
             extractVals.resetCounter();
             ratCalc.calcRATValues(gdalAtt, inRealColIdx, inIntColIdx, inStrColIdx, outRealColIdx, outIntColIdx, outStrColIdx);
+            colCache.unpinColumn(trainRegFieldIdx);
             
             rsgis::math::RSGISMathsUtils mathUtils;
             rsgis::math::RSGISStatsSummary *mathSumStats = new rsgis::math::RSGISStatsSummary();
@@ -180,9 +190,10 @@ namespace rsgis{namespace rastergis{
                 inIntColIdx.push_back(applyRegFieldIdx);
             }
             outRealColIdx.push_back(outExtrapFieldIdx);
-            RSGISPerformKNNCalcValues performKNN = RSGISPerformKNNCalcValues(trainData, numTrainFeats, numFloatVals, kFeatures, calcDist, distThreshold, mathSumStats);
-            ratCalc = RSGISRATCalc(&performKNN);
+            RSGISPerformKNNCalcValues performKNN(trainData, numTrainFeats, numFloatVals, kFeatures, calcDist, distThreshold, mathSumStats);
+            ratCalc = RSGISRATCalc(&performKNN, &colCache);
             ratCalc.calcRATValues(gdalAtt, inRealColIdx, inIntColIdx, inStrColIdx, outRealColIdx, outIntColIdx, outStrColIdx);
+            colCache.flush();
             
             // Deallocate memory
             for(size_t i = 0; i < numTrainFeats; ++i)
@@ -214,7 +225,12 @@ namespace rsgis{namespace rastergis{
     
     RSGISCountTrainingValues::RSGISCountTrainingValues(size_t *numTrainPts): RSGISRATCalcValue()
     {
+        this->ownNumTrainPts = 0;
         this->numTrainPts = numTrainPts;
+        if(this->numTrainPts == NULL)
+        {
+            this->numTrainPts = &this->ownNumTrainPts;
+        }
     }
     
     void RSGISCountTrainingValues::calcRATValue(size_t fid, double *inRealCols, unsigned int numInRealCols, int *inIntCols, unsigned int numInIntCols, std::string *inStringCols, unsigned int numInStringCols, double *outRealCols, unsigned int numOutRealCols, int *outIntCols, unsigned int numOutIntCols, std::string *outStringCols, unsigned int numOutStringCols)
@@ -230,6 +246,12 @@ namespace rsgis{namespace rastergis{
         }
     }
     
+    void RSGISCountTrainingValues::reduce(RSGISRATCalcValue *other)
+    {
+        RSGISCountTrainingValues *otherCount = static_cast<RSGISCountTrainingValues*>(other);
+        *this->numTrainPts += *otherCount->numTrainPts;
+    }
+    
     RSGISCountTrainingValues::~RSGISCountTrainingValues()
     {
         
@@ -292,6 +314,37 @@ namespace rsgis{namespace rastergis{
         this->calcDist = calcDist;
         this->distThreshold = distThreshold;
         this->mathSumStats = mathSumStats;
+        
+        // The training features are searched with a kd-tree for the metrics for which
+        // the distance to the box of a node is a lower bound (the Mahalanobis distance
+        // through its whitening transform); otherwise they are searched linearly.
+        this->kdTree = NULL;
+        if(m > 1)
+        {
+            rsgis::math::RSGISCalcMahalanobisDistMetric *mahalanobisDist = dynamic_cast<rsgis::math::RSGISCalcMahalanobisDistMetric*>(calcDist);
+            if((dynamic_cast<rsgis::math::RSGISCalcEuclideanDistMetric*>(calcDist) != NULL) | (dynamic_cast<rsgis::math::RSGISCalcManhattenDistMetric*>(calcDist) != NULL))
+            {
+                this->kdTree = new rsgis::math::RSGISKDTree(trainData, n, 1, m);
+            }
+            else if(mahalanobisDist != NULL)
+            {
+                size_t numVals = m - 1;
+                double **transform = new double*[numVals];
+                for(size_t i = 0; i < numVals; ++i)
+                {
+                    transform[i] = new double[numVals];
+                }
+                if(mahalanobisDist->calcWhiteningTransform(transform))
+                {
+                    this->kdTree = new rsgis::math::RSGISKDTree(trainData, n, 1, m, transform);
+                }
+                for(size_t i = 0; i < numVals; ++i)
+                {
+                    delete[] transform[i];
+                }
+                delete[] transform;
+            }
+        }
     }
     
     void RSGISPerformKNNCalcValues::calcRATValue(size_t fid, double *inRealCols, unsigned int numInRealCols, int *inIntCols, unsigned int numInIntCols, std::string *inStringCols, unsigned int numInStringCols, double *outRealCols, unsigned int numOutRealCols, int *outIntCols, unsigned int numOutIntCols, std::string *outStringCols, unsigned int numOutStringCols)
@@ -319,17 +372,16 @@ namespace rsgis{namespace rastergis{
             if(performKNN)
             {
                 // Find K NN samples from training data
-                std::list<std::pair<double, double*> > *kVals = new std::list<std::pair<double, double*> >();
-                this->findKVals(kVals, inRealCols);
+                this->findKVals(&this->kVals, inRealCols);
                 
                 // Derive new value from K NN samples
-                std::vector<double> data;
-                for(std::list<std::pair<double, double*> >::iterator iterFeat = kVals->begin(); iterFeat != kVals->end(); ++iterFeat)
+                this->kData.clear();
+                for(std::vector<std::pair<double, double*> >::iterator iterFeat = this->kVals.begin(); iterFeat != this->kVals.end(); ++iterFeat)
                 {
-                    data.push_back((*iterFeat).second[0]);
+                    this->kData.push_back((*iterFeat).second[0]);
                 }
                 rsgis::math::RSGISMathsUtils mathUtils;
-                mathUtils.generateStats(&data, this->mathSumStats);
+                mathUtils.generateStats(&this->kData, this->mathSumStats);
                 
                 // Write to output column
                 if(this->mathSumStats->calcMean)
@@ -364,7 +416,6 @@ namespace rsgis{namespace rastergis{
                 {
                     throw RSGISAttributeTableException("Summarise option unknown.");
                 }
-                delete kVals;
             }
             else
             {
@@ -387,37 +438,46 @@ namespace rsgis{namespace rastergis{
         
     }
     
-    void RSGISPerformKNNCalcValues::findKVals(std::list<std::pair<double, double*> > *kVals, double *featVals)
+    void RSGISPerformKNNCalcValues::findKVals(std::vector<std::pair<double, double*> > *kVals, double *featVals)
     {
         try
         {
-            double dist = 0.0;
-            for(size_t i = 0; i < this->n; ++i)
+            kVals->clear();
+            std::vector<std::pair<double, size_t> > &neighbours = this->neighbours;
+            neighbours.clear();
+            if(this->kdTree != NULL)
             {
-                dist = this->calcDist->calcDist(this->trainData[i], 1, m, featVals, 1, m);
-
-                if(dist < this->distThreshold)
+                this->kdTree->findKNearest(featVals, this->kFeatures, this->distThreshold, this->calcDist, &neighbours);
+            }
+            else
+            {
+                // Keep a max-heap of the k nearest (distance, index) pairs.
+                double dist = 0.0;
+                for(size_t i = 0; i < this->n; ++i)
                 {
-                    if(kVals->empty())
+                    dist = this->calcDist->calcDist(this->trainData[i], 1, m, featVals, 1, m);
+                    if((dist < this->distThreshold) && (this->kFeatures > 0))
                     {
-                        kVals->push_back(std::pair<double, double*>(dist, this->trainData[i]));
-                    }
-                    else
-                    {
-                        for(std::list<std::pair<double, double*> >::iterator iterFeat = kVals->begin(); iterFeat != kVals->end(); ++iterFeat)
+                        std::pair<double, size_t> cand(dist, i);
+                        if(neighbours.size() < this->kFeatures)
                         {
-                            if(dist < (*iterFeat).first)
-                            {
-                                kVals->insert(iterFeat, std::pair<double, double*>(dist, this->trainData[i]));
-                                break;
-                            }
+                            neighbours.push_back(cand);
+                            std::push_heap(neighbours.begin(), neighbours.end());
                         }
-                        if(kVals->size() > this->kFeatures)
+                        else if(cand < neighbours.front())
                         {
-                            kVals->pop_back();
+                            std::pop_heap(neighbours.begin(), neighbours.end());
+                            neighbours.back() = cand;
+                            std::push_heap(neighbours.begin(), neighbours.end());
                         }
                     }
                 }
+                std::sort_heap(neighbours.begin(), neighbours.end());
+            }
+            
+            for(std::vector<std::pair<double, size_t> >::iterator iterNN = neighbours.begin(); iterNN != neighbours.end(); ++iterNN)
+            {
+                kVals->push_back(std::pair<double, double*>((*iterNN).first, this->trainData[(*iterNN).second]));
             }
         }
         catch (RSGISAttributeTableException &e)
@@ -436,7 +496,10 @@ namespace rsgis{namespace rastergis{
     
     RSGISPerformKNNCalcValues::~RSGISPerformKNNCalcValues()
     {
-        
+        if(this->kdTree != NULL)
+        {
+            delete this->kdTree;
+        }
     }
 
     
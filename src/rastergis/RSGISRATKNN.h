@@ -39,9 +39,10 @@
 
 #include "math/RSGISMathsUtils.h"
 #include "math/RSGISDistMetrics.h"
+#include "math/RSGISKDTree.h"
 
 // mark all exported classes/functions with DllExport to have
-// them exported by Visual Studio
+// them exported by Visual Studio
 #undef DllExport
 #ifdef _MSC_VER
     #ifdef rsgis_rastergis_EXPORTS
@@ -67,11 +68,15 @@ namespace rsgis{namespace rastergis{
     class DllExport RSGISCountTrainingValues : public RSGISRATCalcValue
     {
     public:
+        /** If numTrainPts is NULL the count is held by the object (as used by clone()). */
         RSGISCountTrainingValues(size_t *numTrainPts);
         void calcRATValue(size_t fid, double *inRealCols, unsigned int numInRealCols, int *inIntCols, unsigned int numInIntCols, std::string *inStringCols, unsigned int numInStringCols, double *outRealCols, unsigned int numOutRealCols, int *outIntCols, unsigned int numOutIntCols, std::string *outStringCols, unsigned int numOutStringCols);
+        RSGISRATCalcValue* clone(){return new RSGISCountTrainingValues(NULL);};
+        void reduce(RSGISRATCalcValue *other);
         ~RSGISCountTrainingValues();
     private:
         size_t *numTrainPts;
+        size_t ownNumTrainPts;
     };
     
     class DllExport RSGISExtractTrainingValues : public RSGISRATCalcValue
@@ -93,9 +98,12 @@ namespace rsgis{namespace rastergis{
     public:
         RSGISPerformKNNCalcValues(double **trainData, size_t n, size_t m, unsigned int kFeatures, rsgis::math::RSGISCalcDistMetric *calcDist, float distThreshold, rsgis::math::RSGISStatsSummary *mathSumStats);
         void calcRATValue(size_t fid, double *inRealCols, unsigned int numInRealCols, int *inIntCols, unsigned int numInIntCols, std::string *inStringCols, unsigned int numInStringCols, double *outRealCols, unsigned int numOutRealCols, int *outIntCols, unsigned int numOutIntCols, std::string *outStringCols, unsigned int numOutStringCols);
-        void findKVals(std::list<std::pair<double, double*> > *kVals, double *featVals);
+        /** Find the (up to) k training samples nearest to the feature values within the distance threshold, in ascending order of distance (kVals is cleared first). */
+        void findKVals(std::vector<std::pair<double, double*> > *kVals, double *featVals);
         ~RSGISPerformKNNCalcValues();
     private:
+        RSGISPerformKNNCalcValues(const RSGISPerformKNNCalcValues&);
+        RSGISPerformKNNCalcValues& operator=(const RSGISPerformKNNCalcValues&);
         double **trainData;
         size_t n;
         size_t m;
@@ -103,6 +111,12 @@ namespace rsgis{namespace rastergis{
         rsgis::math::RSGISCalcDistMetric *calcDist;
         float distThreshold;
         rsgis::math::RSGISStatsSummary *mathSumStats;
+        /// The tree over the training features (NULL if the metric cannot be searched with a tree).
+        rsgis::math::RSGISKDTree *kdTree;
+        /// Buffers reused across rows so no memory is allocated per feature.
+        std::vector<std::pair<double, size_t> > neighbours;
+        std::vector<std::pair<double, double*> > kVals;
+        std::vector<double> kData;
     };
     
     
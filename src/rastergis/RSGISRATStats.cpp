@@ -25,340 +25,190 @@
 
 namespace rsgis{namespace rastergis{
     
-    RSGISRATStats::RSGISRATStats()
+    RSGISRATStats::RSGISRATStats(RSGISRATColumnCache *colCache)
     {
-        
+        this->colCache = colCache;
     }
     
     float RSGISRATStats::calc1DJMDistance(GDALDataset *clumpsImage, std::string varCol, float binWidth, std::string classColumn, std::string class1Val, std::string class2Val, unsigned int ratBand)
     {
-        float dist = 0.0;
+        RSGISSeparabilityCalc calc;
+        calc.measure = rsgisSepJM1D;
+        calc.var1Col = varCol;
+        calc.var1BinWidth = binWidth;
+        calc.var2BinWidth = 0;
+        calc.classColumn = classColumn;
+        calc.class1Val = class1Val;
+        calc.class2Val = class2Val;
+        return this->calcSeparability(clumpsImage, calc, ratBand);
+    }
+    
+    float RSGISRATStats::calc2DJMDistance(GDALDataset *clumpsImage, std::string var1Col, std::string var2Col, float var1binWidth, float var2binWidth, std::string classColumn, std::string class1Val, std::string class2Val, unsigned int ratBand)
+    {
+        RSGISSeparabilityCalc calc;
+        calc.measure = rsgisSepJM2D;
+        calc.var1Col = var1Col;
+        calc.var2Col = var2Col;
+        calc.var1BinWidth = var1binWidth;
+        calc.var2BinWidth = var2binWidth;
+        calc.classColumn = classColumn;
+        calc.class1Val = class1Val;
+        calc.class2Val = class2Val;
+        return this->calcSeparability(clumpsImage, calc, ratBand);
+    }
+    
+    float RSGISRATStats::calcBhattacharyyaDistance(GDALDataset *clumpsImage, std::string varCol, std::string classColumn, std::string class1Val, std::string class2Val, unsigned int ratBand)
+    {
+        RSGISSeparabilityCalc calc;
+        calc.measure = rsgisSepBhattacharyya;
+        calc.var1Col = varCol;
+        calc.var1BinWidth = 0;
+        calc.var2BinWidth = 0;
+        calc.classColumn = classColumn;
+        calc.class1Val = class1Val;
+        calc.class2Val = class2Val;
+        return this->calcSeparability(clumpsImage, calc, ratBand);
+    }
+    
+    float RSGISRATStats::calcSeparability(GDALDataset *clumpsImage, RSGISSeparabilityCalc calc, unsigned int ratBand)
+    {
+        std::vector<RSGISSeparabilityCalc> calcs;
+        calcs.push_back(calc);
+        return this->calcSeparabilities(clumpsImage, calcs, ratBand, 1).at(0);
+    }
+    
+    std::vector<float> RSGISRATStats::calcSeparabilities(GDALDataset *clumpsImage, const std::vector<RSGISSeparabilityCalc> &calcs, unsigned int ratBand, unsigned int numThreads)
+    {
+        std::vector<float> dists(calcs.size(), 0.0);
         try
         {
+            if((ratBand == 0) || (ratBand > ((unsigned int)clumpsImage->GetRasterCount())))
+            {
+                throw RSGISAttributeTableException("The RAT band is not within the image.");
+            }
+            
             // Get attribute table...
-            GDALRasterAttributeTable *attTable = clumpsImage->GetRasterBand(1)->GetDefaultRAT();
+            GDALRasterAttributeTable *attTable = clumpsImage->GetRasterBand(ratBand)->GetDefaultRAT();
             
             if(attTable == NULL)
             {
                 throw RSGISAttributeTableException("The image dataset does not have an attribute table.");
             }
             
-            rsgis::rastergis::RSGISRasterAttUtils ratUtils;
-            std::vector<std::string> *imgClassColVals = ratUtils.readStrColumnAsVec(attTable, classColumn);
-            std::vector<double> *varVals = ratUtils.readDoubleColumnAsVec(attTable, varCol);
-            
-            std::vector<double> *valsClass1 = new std::vector<double>();
-            std::vector<double> *valsClass2 = new std::vector<double>();
-            
-            double minVal1 = 0.0;
-            double maxVal1 = 0.0;
-            bool first1 = true;
-            
-            double minVal2 = 0.0;
-            double maxVal2 = 0.0;
-            bool first2 = true;
-            
-            size_t numRows = varVals->size();
-            for(size_t i = 0; i < numRows; ++i)
+            // The classes (class column and value) and variables (column and class) needed by the calculations.
+            typedef std::pair<std::string, std::string> ClassKey;
+            typedef std::pair<std::string, ClassKey> VarClassKey;
+            std::map<ClassKey, size_t> classIdxs;
+            std::map<VarClassKey, size_t> varClassIdxs;
+            std::vector<std::pair<size_t, size_t> > calcClassIdxs;
+            std::vector<std::pair<size_t, size_t> > calcVar1ClassIdxs;
+            std::vector<std::pair<size_t, size_t> > calcVar2ClassIdxs;
+            for(std::vector<RSGISSeparabilityCalc>::const_iterator iterCalc = calcs.begin(); iterCalc != calcs.end(); ++iterCalc)
             {
-                if(imgClassColVals->at(i) == class1Val)
-                {
-                    valsClass1->push_back(varVals->at(i));
-                    if(first1)
-                    {
-                        minVal1 = varVals->at(i);
-                        maxVal1 = varVals->at(i);
-                        first1 = false;
-                    }
-                    else
-                    {
-                        if(varVals->at(i) < minVal1)
-                        {
-                            minVal1 = varVals->at(i);
-                        }
-                        else if(varVals->at(i) > maxVal1)
-                        {
-                            maxVal1 = varVals->at(i);
-                        }
-                    }
-                }
-                else if(imgClassColVals->at(i) == class2Val)
+                ClassKey class1((*iterCalc).classColumn, (*iterCalc).class1Val);
+                ClassKey class2((*iterCalc).classColumn, (*iterCalc).class2Val);
+                classIdxs.insert(std::pair<ClassKey, size_t>(class1, classIdxs.size()));
+                classIdxs.insert(std::pair<ClassKey, size_t>(class2, classIdxs.size()));
+                calcClassIdxs.push_back(std::pair<size_t, size_t>(classIdxs[class1], classIdxs[class2]));
+                
+                varClassIdxs.insert(std::pair<VarClassKey, size_t>(VarClassKey((*iterCalc).var1Col, class1), varClassIdxs.size()));
+                varClassIdxs.insert(std::pair<VarClassKey, size_t>(VarClassKey((*iterCalc).var1Col, class2), varClassIdxs.size()));
+                calcVar1ClassIdxs.push_back(std::pair<size_t, size_t>(varClassIdxs[VarClassKey((*iterCalc).var1Col, class1)], varClassIdxs[VarClassKey((*iterCalc).var1Col, class2)]));
+                if((*iterCalc).measure == rsgisSepJM2D)
                 {
-                    valsClass2->push_back(varVals->at(i));
-                    
-                    if(first2)
-                    {
-                        minVal2 = varVals->at(i);
-                        maxVal2 = varVals->at(i);
-                        first2 = false;
-                    }
-                    else
-                    {
-                        if(varVals->at(i) < minVal2)
-                        {
-                            minVal2 = varVals->at(i);
-                        }
-                        else if(varVals->at(i) > maxVal2)
-                        {
-                            maxVal2 = varVals->at(i);
-                        }
-                    }
+                    varClassIdxs.insert(std::pair<VarClassKey, size_t>(VarClassKey((*iterCalc).var2Col, class1), varClassIdxs.size()));
+                    varClassIdxs.insert(std::pair<VarClassKey, size_t>(VarClassKey((*iterCalc).var2Col, class2), varClassIdxs.size()));
+                    calcVar2ClassIdxs.push_back(std::pair<size_t, size_t>(varClassIdxs[VarClassKey((*iterCalc).var2Col, class1)], varClassIdxs[VarClassKey((*iterCalc).var2Col, class2)]));
                 }
-            }
-            
-            double min = minVal1;
-            if(minVal2 < min)
-            {
-                min = minVal2;
-            }
-            
-            double max = maxVal1;
-            if(maxVal2 > max)
-            {
-                max = maxVal2;
-            }
-            
-            rsgis::math::RSGISMathsUtils mathUtils;
-            std::vector<std::pair<double, double> > *hist1 =  mathUtils.calcHistogram(valsClass1, min, max, binWidth, true);
-            std::vector<std::pair<double, double> > *hist2 =  mathUtils.calcHistogram(valsClass2, min, max, binWidth, true);
-            
-            if(hist1->size() != hist2->size())
-            {
-                throw rsgis::RSGISAttributeTableException("Histograms must have the same number of bins.");
-            }
-            
-            double sumVals = 0.0;
-            double tmpVal = 0.0;
-            for(size_t i = 0; i < hist1->size(); ++i)
-            {
-                tmpVal = hist1->at(i).second * hist2->at(i).second;
-                if(tmpVal != 0.0)
+                else
                 {
-                    sumVals += sqrt(tmpVal);
+                    calcVar2ClassIdxs.push_back(std::pair<size_t, size_t>(0, 0));
                 }
             }
             
-            dist = sqrt(2 * (1 - sumVals));
-            
-            delete valsClass1;
-            delete valsClass2;
-            delete imgClassColVals;
-            delete varVals;
-        }
-        catch(rsgis::RSGISAttributeTableException &e)
-        {
-            throw e;
-        }
-        catch(rsgis::RSGISException &e)
-        {
-            throw RSGISAttributeTableException(e.what());
-        }
-        return dist;
-    }
-    
-    float RSGISRATStats::calc2DJMDistance(GDALDataset *clumpsImage, std::string var1Col, std::string var2Col, float var1binWidth, float var2binWidth, std::string classColumn, std::string class1Val, std::string class2Val, unsigned int ratBand)
-    {
-        float dist = 0.0;
-        try
-        {
-            // Get attribute table...
-            GDALRasterAttributeTable *attTable = clumpsImage->GetRasterBand(1)->GetDefaultRAT();
-            
-            if(attTable == NULL)
-            {
-                throw RSGISAttributeTableException("The image dataset does not have an attribute table.");
-            }
-            
+            // Read each class column once to find the rows of each class.
             rsgis::rastergis::RSGISRasterAttUtils ratUtils;
-            std::vector<std::string> *imgClassColVals = ratUtils.readStrColumnAsVec(attTable, classColumn);
-            std::vector<double> *varVals1 = ratUtils.readDoubleColumnAsVec(attTable, var1Col);
-            std::vector<double> *varVals2 = ratUtils.readDoubleColumnAsVec(attTable, var2Col);
-            
-            size_t numRows = imgClassColVals->size();
-            
-            std::vector<double> *vals1Class1 = new std::vector<double>();
-            std::vector<double> *vals1Class2 = new std::vector<double>();
-            
-            double minVal1C1 = 0.0;
-            double maxVal1C1 = 0.0;
-            bool first1C1 = true;
-            
-            double minVal1C2 = 0.0;
-            double maxVal1C2 = 0.0;
-            bool first1C2 = true;
-            
-            for(size_t i = 0; i < numRows; ++i)
+            std::vector< std::vector<size_t> > classRows(classIdxs.size());
+            std::map<ClassKey, size_t>::iterator iterClass = classIdxs.begin();
+            while(iterClass != classIdxs.end())
             {
-                if(imgClassColVals->at(i) == class1Val)
+                std::string classColumn = (*iterClass).first.first;
+                std::map<std::string, size_t> colClassIdxs;
+                for(; (iterClass != classIdxs.end()) && ((*iterClass).first.first == classColumn); ++iterClass)
                 {
-                    vals1Class1->push_back(varVals1->at(i));
-                    if(first1C1)
-                    {
-                        minVal1C1 = varVals1->at(i);
-                        maxVal1C1 = varVals1->at(i);
-                        first1C1 = false;
-                    }
-                    else
-                    {
-                        if(varVals1->at(i) < minVal1C1)
-                        {
-                            minVal1C1 = varVals1->at(i);
-                        }
-                        else if(varVals1->at(i) > maxVal1C1)
-                        {
-                            maxVal1C1 = varVals1->at(i);
-                        }
-                    }
+                    colClassIdxs[(*iterClass).first.second] = (*iterClass).second;
                 }
-                else if(imgClassColVals->at(i) == class2Val)
+                
+                std::vector<std::string> *classColVals = ratUtils.readStrColumnAsVec(attTable, classColumn);
+                for(size_t i = 0; i < classColVals->size(); ++i)
                 {
-                    vals1Class2->push_back(varVals1->at(i));
-                    
-                    if(first1C2)
+                    std::map<std::string, size_t>::iterator iterColClass = colClassIdxs.find(classColVals->at(i));
+                    if(iterColClass != colClassIdxs.end())
                     {
-                        minVal1C2 = varVals1->at(i);
-                        maxVal1C2 = varVals1->at(i);
-                        first1C2 = false;
-                    }
-                    else
-                    {
-                        if(varVals1->at(i) < minVal1C2)
-                        {
-                            minVal1C2 = varVals1->at(i);
-                        }
-                        else if(varVals1->at(i) > maxVal1C2)
-                        {
-                            maxVal1C2 = varVals1->at(i);
-                        }
+                        classRows[(*iterColClass).second].push_back(i);
                     }
                 }
+                delete classColVals;
             }
             
-            std::vector<double> *vals2Class1 = new std::vector<double>();
-            std::vector<double> *vals2Class2 = new std::vector<double>();
-
-            double minVal2C1 = 0.0;
-            double maxVal2C1 = 0.0;
-            bool first2C1 = true;
-            
-            double minVal2C2 = 0.0;
-            double maxVal2C2 = 0.0;
-            bool first2C2 = true;
-            
-            for(size_t i = 0; i < numRows; ++i)
+            // Read each variable column once to extract the values of each class.
+            std::vector<RSGISSeparabilityClassVals> varClassVals(varClassIdxs.size());
+            std::map<VarClassKey, size_t>::iterator iterVarClass = varClassIdxs.begin();
+            while(iterVarClass != varClassIdxs.end())
             {
-                if(imgClassColVals->at(i) == class1Val)
+                std::string varCol = (*iterVarClass).first.first;
+                std::vector<double> *varVals = this->readRealColumn(attTable, varCol);
+                for(; (iterVarClass != varClassIdxs.end()) && ((*iterVarClass).first.first == varCol); ++iterVarClass)
                 {
-                    vals2Class1->push_back(varVals2->at(i));
-                    if(first2C1)
-                    {
-                        minVal2C1 = varVals2->at(i);
-                        maxVal2C1 = varVals2->at(i);
-                        first2C1 = false;
-                    }
-                    else
+                    RSGISSeparabilityClassVals &classVals = varClassVals[(*iterVarClass).second];
+                    std::vector<size_t> &rows = classRows[classIdxs[(*iterVarClass).first.second]];
+                    classVals.vals.reserve(rows.size());
+                    classVals.minVal = 0.0;
+                    classVals.maxVal = 0.0;
+                    for(std::vector<size_t>::iterator iterRow = rows.begin(); iterRow != rows.end(); ++iterRow)
                     {
-                        if(varVals2->at(i) < minVal2C1)
+                        double val = varVals->at(*iterRow);
+                        if(classVals.vals.empty())
                         {
-                            minVal2C1 = varVals2->at(i);
+                            classVals.minVal = val;
+                            classVals.maxVal = val;
                         }
-                        else if(varVals2->at(i) > maxVal2C1)
-                        {
-                            maxVal2C1 = varVals2->at(i);
-                        }
-                    }
-                }
-                else if(imgClassColVals->at(i) == class2Val)
-                {
-                    vals2Class2->push_back(varVals2->at(i));
-                    
-                    if(first2C2)
-                    {
-                        minVal2C2 = varVals2->at(i);
-                        maxVal2C2 = varVals2->at(i);
-                        first2C2 = false;
-                    }
-                    else
-                    {
-                        if(varVals2->at(i) < minVal2C2)
+                        else if(val < classVals.minVal)
                         {
-                            minVal2C2 = varVals2->at(i);
+                            classVals.minVal = val;
                         }
-                        else if(varVals2->at(i) > maxVal2C2)
+                        else if(val > classVals.maxVal)
                         {
-                            maxVal2C2 = varVals2->at(i);
+                            classVals.maxVal = val;
                         }
+                        classVals.vals.push_back(val);
                     }
                 }
+                delete varVals;
             }
             
-            double minVal1 = minVal1C1;
-            if(minVal1C2 < minVal1)
-            {
-                minVal1 = minVal1C2;
-            }
-            double maxVal1 = maxVal1C1;
-            if(maxVal1C2 > maxVal1)
-            {
-                maxVal1 = maxVal1C2;
-            }
-            
-            double minVal2 = minVal2C1;
-            if(minVal2C2 < minVal2)
-            {
-                minVal2 = minVal2C2;
-            }
-            double maxVal2 = maxVal2C1;
-            if(maxVal2C2 > maxVal2)
-            {
-                maxVal2 = maxVal2C2;
-            }
-            
-            rsgis::math::RSGISMathsUtils mathUtils;
-            std::vector<std::vector<rsgis::math::RSGIS2DHistBin>* > *hist1 =  mathUtils.calc2DHistogram(vals1Class1, minVal1, maxVal1, var1binWidth, vals2Class1, minVal2, maxVal2, var2binWidth, true);
-            std::vector<std::vector<rsgis::math::RSGIS2DHistBin>* > *hist2 =  mathUtils.calc2DHistogram(vals1Class2, minVal1, maxVal1, var1binWidth, vals2Class2, minVal2, maxVal2, var2binWidth, true);
-
-            if(hist1->size() != hist2->size())
-            {
-                throw RSGISAttributeTableException("Histograms are not the same size (first axis).");
-            }
-            
-            double sumVals = 0.0;
-            double tmpVal = 0.0;
-            for(size_t i = 0; i < hist1->size(); ++i)
+            // Calculate the separabilities in parallel.
+            rsgis::RSGISThreadPool threadPool(numThreads);
+            threadPool.parallelFor(0, calcs.size(), [&](unsigned int t, size_t start, size_t end)
             {
-                
-                if(hist1->at(i)->size() != hist2->at(i)->size())
-                {
-                    std::cerr << "Histograms are not the same size - " << i << "th row\n" << std::endl;
-                    throw RSGISAttributeTableException("Histograms are not the same size (second axis).");
-                }
-                
-                for(size_t j = 0; j < hist1->at(i)->size(); ++j)
+                for(size_t i = start; i < end; ++i)
                 {
-                    tmpVal = hist1->at(i)->at(j).freq * hist2->at(i)->at(j).freq;
-                    if(tmpVal != 0.0)
+                    RSGISSeparabilityClassVals *var1Vals1 = &varClassVals[calcVar1ClassIdxs[i].first];
+                    RSGISSeparabilityClassVals *var1Vals2 = &varClassVals[calcVar1ClassIdxs[i].second];
+                    if(calcs[i].measure == rsgisSepJM1D)
                     {
-                        sumVals += sqrt(tmpVal);
+                        dists[i] = calc1DJMDistance(var1Vals1, var1Vals2, calcs[i].var1BinWidth);
+                    }
+                    else if(calcs[i].measure == rsgisSepJM2D)
+                    {
+                        dists[i] = calc2DJMDistance(var1Vals1, &varClassVals[calcVar2ClassIdxs[i].first], var1Vals2, &varClassVals[calcVar2ClassIdxs[i].second], calcs[i].var1BinWidth, calcs[i].var2BinWidth);
+                    }
+                    else
+                    {
+                        dists[i] = calcBhattacharyyaDistance(var1Vals1, var1Vals2);
                     }
                 }
-                
-                delete hist1->at(i);
-                delete hist2->at(i);
-            }
-            delete hist1;
-            delete hist2;
-            
-            dist = sqrt(2 * (1 - sumVals));
-            
-            delete imgClassColVals;
-            delete varVals1;
-            delete varVals2;
-            delete vals1Class1;
-            delete vals1Class2;
-            delete vals2Class1;
-            delete vals2Class2;
-            
+            });
         }
         catch(rsgis::RSGISAttributeTableException &e)
         {
@@ -368,86 +218,130 @@ namespace rsgis{namespace rastergis{
         {
             throw RSGISAttributeTableException(e.what());
         }
-        return dist;
+        return dists;
     }
     
-    float RSGISRATStats::calcBhattacharyyaDistance(GDALDataset *clumpsImage, std::string varCol, std::string classColumn, std::string class1Val, std::string class2Val, unsigned int ratBand)
+    float RSGISRATStats::calc1DJMDistance(RSGISSeparabilityClassVals *vals1, RSGISSeparabilityClassVals *vals2, float binWidth)
     {
-        float dist = 0.0;
-        try
+        double min = std::min(vals1->minVal, vals2->minVal);
+        double max = std::max(vals1->maxVal, vals2->maxVal);
+        
+        rsgis::math::RSGISMathsUtils mathUtils;
+        std::vector<std::pair<double, double> > *hist1 =  mathUtils.calcHistogram(&vals1->vals, min, max, binWidth, true);
+        std::vector<std::pair<double, double> > *hist2 =  mathUtils.calcHistogram(&vals2->vals, min, max, binWidth, true);
+        
+        if(hist1->size() != hist2->size())
         {
-            // Get attribute table...
-            GDALRasterAttributeTable *attTable = clumpsImage->GetRasterBand(1)->GetDefaultRAT();
-            
-            if(attTable == NULL)
+            delete hist1;
+            delete hist2;
+            throw rsgis::RSGISAttributeTableException("Histograms must have the same number of bins.");
+        }
+        
+        double sumVals = 0.0;
+        double tmpVal = 0.0;
+        for(size_t i = 0; i < hist1->size(); ++i)
+        {
+            tmpVal = hist1->at(i).second * hist2->at(i).second;
+            if(tmpVal != 0.0)
             {
-                throw RSGISAttributeTableException("The image dataset does not have an attribute table.");
+                sumVals += sqrt(tmpVal);
+            }
+        }
+        delete hist1;
+        delete hist2;
+        
+        return sqrt(2 * (1 - sumVals));
+    }
+    
+    float RSGISRATStats::calc2DJMDistance(RSGISSeparabilityClassVals *var1Vals1, RSGISSeparabilityClassVals *var2Vals1, RSGISSeparabilityClassVals *var1Vals2, RSGISSeparabilityClassVals *var2Vals2, float var1binWidth, float var2binWidth)
+    {
+        double minVal1 = std::min(var1Vals1->minVal, var1Vals2->minVal);
+        double maxVal1 = std::max(var1Vals1->maxVal, var1Vals2->maxVal);
+        double minVal2 = std::min(var2Vals1->minVal, var2Vals2->minVal);
+        double maxVal2 = std::max(var2Vals1->maxVal, var2Vals2->maxVal);
+        
+        rsgis::math::RSGISMathsUtils mathUtils;
+        std::vector<std::vector<rsgis::math::RSGIS2DHistBin>* > *hist1 =  mathUtils.calc2DHistogram(&var1Vals1->vals, minVal1, maxVal1, var1binWidth, &var2Vals1->vals, minVal2, maxVal2, var2binWidth, true);
+        std::vector<std::vector<rsgis::math::RSGIS2DHistBin>* > *hist2 =  mathUtils.calc2DHistogram(&var1Vals2->vals, minVal1, maxVal1, var1binWidth, &var2Vals2->vals, minVal2, maxVal2, var2binWidth, true);
+        
+        bool sameSize = (hist1->size() == hist2->size());
+        double sumVals = 0.0;
+        double tmpVal = 0.0;
+        for(size_t i = 0; sameSize && (i < hist1->size()); ++i)
+        {
+            if(hist1->at(i)->size() != hist2->at(i)->size())
+            {
+                sameSize = false;
+                break;
             }
             
-            rsgis::rastergis::RSGISRasterAttUtils ratUtils;
-            std::vector<std::string> *imgClassColVals = ratUtils.readStrColumnAsVec(attTable, classColumn);
-            std::vector<double> *varVals = ratUtils.readDoubleColumnAsVec(attTable, varCol);
-            
-            std::vector<double> *valsClass1 = new std::vector<double>();
-            std::vector<double> *valsClass2 = new std::vector<double>();
-            
-            size_t numRows = varVals->size();
-            for(size_t i = 0; i < numRows; ++i)
+            for(size_t j = 0; j < hist1->at(i)->size(); ++j)
             {
-                if(imgClassColVals->at(i) == class1Val)
-                {
-                    valsClass1->push_back(varVals->at(i));
-                }
-                else if(imgClassColVals->at(i) == class2Val)
+                tmpVal = hist1->at(i)->at(j).freq * hist2->at(i)->at(j).freq;
+                if(tmpVal != 0.0)
                 {
-                    valsClass2->push_back(varVals->at(i));
+                    sumVals += sqrt(tmpVal);
                 }
             }
-            
-            rsgis::math::RSGISMathsUtils mathUtils;
-           
-            rsgis::math::RSGISStatsSummary *stats1 = new rsgis::math::RSGISStatsSummary();
-            mathUtils.initStatsSummary(stats1);
-            stats1->calcMean = true;
-            stats1->calcVariance = true;
-            mathUtils.generateStats(valsClass1, stats1);
-            
-            
-            rsgis::math::RSGISStatsSummary *stats2 = new rsgis::math::RSGISStatsSummary();
-            mathUtils.initStatsSummary(stats2);
-            stats2->calcMean = true;
-            stats2->calcVariance = true;
-            mathUtils.generateStats(valsClass2, stats2);
-            
-            // https://en.wikipedia.org/wiki/Bhattacharyya_distance
-            
-            double varPQ = stats1->variance / stats2->variance;
-            double varQP = stats2->variance / stats1->variance;
-            double diffMeanPQ = (stats1->mean / stats2->mean) * (stats1->mean / stats2->mean);
-            double sumVarPQ = stats1->variance + stats2->variance;
-            
-            double partA = log((varPQ + varQP + 2) / 4)/4;
-            
-            double partB = (diffMeanPQ/sumVarPQ) / 4;
-            
-            dist = partA + partB;
-            
-            delete valsClass1;
-            delete valsClass2;
-            delete imgClassColVals;
-            delete varVals;
-            delete stats1;
-            delete stats2;
         }
-        catch(rsgis::RSGISAttributeTableException &e)
+        
+        for(size_t i = 0; i < hist1->size(); ++i)
         {
-            throw e;
+            delete hist1->at(i);
         }
-        catch(rsgis::RSGISException &e)
+        for(size_t i = 0; i < hist2->size(); ++i)
         {
-            throw RSGISAttributeTableException(e.what());
+            delete hist2->at(i);
+        }
+        delete hist1;
+        delete hist2;
+        
+        if(!sameSize)
+        {
+            throw RSGISAttributeTableException("Histograms are not the same size.");
+        }
+        
+        return sqrt(2 * (1 - sumVals));
+    }
+    
+    float RSGISRATStats::calcBhattacharyyaDistance(RSGISSeparabilityClassVals *vals1, RSGISSeparabilityClassVals *vals2)
+    {
+        rsgis::math::RSGISMathsUtils mathUtils;
+        
+        rsgis::math::RSGISStatsSummary stats1;
+        mathUtils.initStatsSummary(&stats1);
+        stats1.calcMean = true;
+        stats1.calcVariance = true;
+        mathUtils.generateStats(&vals1->vals, &stats1);
+        
+        rsgis::math::RSGISStatsSummary stats2;
+        mathUtils.initStatsSummary(&stats2);
+        stats2.calcMean = true;
+        stats2.calcVariance = true;
+        mathUtils.generateStats(&vals2->vals, &stats2);
+        
+        // https://en.wikipedia.org/wiki/Bhattacharyya_distance
+        
+        double varPQ = stats1.variance / stats2.variance;
+        double varQP = stats2.variance / stats1.variance;
+        double diffMeanPQ = (stats1.mean / stats2.mean) * (stats1.mean / stats2.mean);
+        double sumVarPQ = stats1.variance + stats2.variance;
+        
+        double partA = log((varPQ + varQP + 2) / 4)/4;
+        
+        double partB = (diffMeanPQ/sumVarPQ) / 4;
+        
+        return partA + partB;
+    }
+    
+    std::vector<double>* RSGISRATStats::readRealColumn(GDALRasterAttributeTable *attTable, std::string colName)
+    {
+        rsgis::rastergis::RSGISRasterAttUtils ratUtils;
+        if((this->colCache != NULL) && (this->colCache->getRAT() == attTable))
+        {
+            return this->colCache->readRealColumnAsVec(ratUtils.findColumnIndex(attTable, colName));
         }
-        return dist;
+        return ratUtils.readDoubleColumnAsVec(attTable, colName);
     }
     
     RSGISRATStats::~RSGISRATStats()
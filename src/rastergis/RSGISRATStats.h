@@ -26,13 +26,17 @@
 #include <iostream>
 #include <string>
 #include <cmath>
+#include <vector>
+#include <map>
 
 #include "gdal_priv.h"
 
 #include "common/RSGISAttributeTableException.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
+#include "rastergis/RSGISRATColumnCache.h"
 #include "math/RSGISMathsUtils.h"
+#include "common/RSGISThreadPool.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -49,14 +53,58 @@
 
 namespace rsgis{namespace rastergis{
     
+    enum RSGISSeparabilityMeasure
+    {
+        rsgisSepJM1D = 0,
+        rsgisSepJM2D = 1,
+        rsgisSepBhattacharyya = 2
+    };
+    
+    /** A separability calculation between two classes of the RAT (see RSGISRATStats::calcSeparabilities). */
+    struct DllExport RSGISSeparabilityCalc
+    {
+        RSGISSeparabilityMeasure measure;
+        std::string var1Col;
+        /// The second variable and the bin widths are only used by the JM distances.
+        std::string var2Col;
+        float var1BinWidth;
+        float var2BinWidth;
+        std::string classColumn;
+        std::string class1Val;
+        std::string class2Val;
+    };
+    
+    /** The values of a variable for the rows of a class, with their range (0 to 0 if there are no rows). */
+    struct DllExport RSGISSeparabilityClassVals
+    {
+        std::vector<double> vals;
+        double minVal;
+        double maxVal;
+    };
+    
     class DllExport RSGISRATStats
     {
     public:
-        RSGISRATStats();
+        /** If a column cache (for the RAT of the clumps image) is provided the real columns are read through it. */
+        RSGISRATStats(RSGISRATColumnCache *colCache=NULL);
         float calc1DJMDistance(GDALDataset *clumpsImage, std::string varCol, float binWidth, std::string classColumn, std::string class1Val, std::string class2Val, unsigned int ratBand);
         float calc2DJMDistance(GDALDataset *clumpsImage, std::string var1Col, std::string var2Col, float var1binWidth, float var2binWidth, std::string classColumn, std::string class1Val, std::string class2Val, unsigned int ratBand);
         float calcBhattacharyyaDistance(GDALDataset *clumpsImage, std::string varCol, std::string classColumn, std::string class1Val, std::string class2Val, unsigned int ratBand);
+        /**
+         * Calculate a batch of separabilities (e.g., for feature selection). Each class and
+         * variable column is read once, the values of each variable for each class are
+         * extracted once and shared by the calculations, which are run in parallel
+         * using numThreads (0 is the number of hardware threads).
+         */
+        std::vector<float> calcSeparabilities(GDALDataset *clumpsImage, const std::vector<RSGISSeparabilityCalc> &calcs, unsigned int ratBand, unsigned int numThreads=1);
         ~RSGISRATStats();
+    protected:
+        float calcSeparability(GDALDataset *clumpsImage, RSGISSeparabilityCalc calc, unsigned int ratBand);
+        static float calc1DJMDistance(RSGISSeparabilityClassVals *vals1, RSGISSeparabilityClassVals *vals2, float binWidth);
+        static float calc2DJMDistance(RSGISSeparabilityClassVals *var1Vals1, RSGISSeparabilityClassVals *var2Vals1, RSGISSeparabilityClassVals *var1Vals2, RSGISSeparabilityClassVals *var2Vals2, float var1binWidth, float var2binWidth);
+        static float calcBhattacharyyaDistance(RSGISSeparabilityClassVals *vals1, RSGISSeparabilityClassVals *vals2);
+        std::vector<double>* readRealColumn(GDALRasterAttributeTable *attTable, std::string colName);
+        RSGISRATColumnCache *colCache;
     };
     
 }}
@@ -21,6 +21,9 @@
  */
 
 #include "RSGISRasterAttUtils.h"
+#include "RSGISRATColumnSummary.h"
+
+#include "img/RSGISImageUtils.h"
 
 namespace rsgis{namespace rastergis{
 
@@ -2154,9 +2157,9 @@ namespace rsgis{namespace rastergis{
     
     
     
-    std::vector<std::vector<size_t>* >* RSGISRasterAttUtils::getRATNeighbours(GDALDataset *clumpImage, unsigned int ratBand)
+    RSGISClumpNeighbourGraph* RSGISRasterAttUtils::getRATNeighbours(GDALDataset *clumpImage, unsigned int ratBand)
     {
-        std::vector<std::vector<size_t>* > *neighbours = new std::vector<std::vector<size_t>* >();
+        RSGISClumpNeighbourGraph *neighbours = NULL;
         
         try
         {
@@ -2193,22 +2196,57 @@ namespace rsgis{namespace rastergis{
             
             kealib::KEAAttributeTable *keaAtt = keaImgIO->getAttributeTable(kealib::kea_att_file, ratBand);
             size_t numRows = keaAtt->getSize();
-            neighbours->reserve(numRows);
-            
-            keaAtt->getNeighbours(0, numRows, neighbours);
-            
+            neighbours = new RSGISClumpNeighbourGraph(numRows);
             
+            // Read the neighbours in blocks so only a block of lists is held in memory at a time.
+            std::vector<std::vector<size_t>* > *blockNeighbours = new std::vector<std::vector<size_t>* >();
+            for(size_t startRow = 0; startRow < numRows; startRow += RAT_BLOCK_LENGTH)
+            {
+                size_t blockLen = std::min<size_t>(RAT_BLOCK_LENGTH, numRows - startRow);
+                blockNeighbours->clear();
+                blockNeighbours->reserve(blockLen);
+                keaAtt->getNeighbours(startRow, blockLen, blockNeighbours);
+                
+                if(blockNeighbours->size() != blockLen)
+                {
+                    for(auto iterNeigh = blockNeighbours->begin(); iterNeigh != blockNeighbours->end(); ++iterNeigh)
+                    {
+                        delete *iterNeigh;
+                    }
+                    delete blockNeighbours;
+                    throw RSGISAttributeTableException("RAT size is different to the number of neighbours retrieved.");
+                }
+                
+                for(auto iterNeigh = blockNeighbours->begin(); iterNeigh != blockNeighbours->end(); ++iterNeigh)
+                {
+                    neighbours->addClumpNeighbours(*(*iterNeigh));
+                    delete *iterNeigh;
+                }
+            }
+            delete blockNeighbours;
         }
         catch (RSGISAttributeTableException &e)
         {
+            if(neighbours != NULL)
+            {
+                delete neighbours;
+            }
             throw e;
         }
         catch (rsgis::RSGISException &e)
         {
+            if(neighbours != NULL)
+            {
+                delete neighbours;
+            }
             throw RSGISAttributeTableException(e.what());
         }
         catch (std::exception &e)
         {
+            if(neighbours != NULL)
+            {
+                delete neighbours;
+            }
             throw RSGISAttributeTableException(e.what());
         }
         
@@ -2229,6 +2267,7 @@ namespace rsgis{namespace rastergis{
             }
             
             unsigned int columnIndex = this->findColumnIndexOrCreate(attTable, colName, GFT_String);
+            RSGISRATColumnSummaries::columnModified(attTable, colName);
             
             unsigned int nBlocks = floor(((double) nRows) / ((double) RAT_BLOCK_LENGTH));
             unsigned int remainRows = nRows - (nBlocks * RAT_BLOCK_LENGTH );
@@ -2408,6 +2447,7 @@ namespace rsgis{namespace rastergis{
             }
             
             unsigned int columnIndex = this->findColumnIndexOrCreate(attTable, colName, GFT_Integer);
+            RSGISRATColumnSummaries::columnModified(attTable, colName);
             
             unsigned int nBlocks = floor(((double) nRows) / ((double) RAT_BLOCK_LENGTH));
             unsigned int remainRows = nRows - (nBlocks * RAT_BLOCK_LENGTH );
@@ -2498,6 +2538,7 @@ namespace rsgis{namespace rastergis{
             }
             
             unsigned int columnIndex = this->findColumnIndexOrCreate(attTable, colName, GFT_Real);
+            RSGISRATColumnSummaries::columnModified(attTable, colName);
             
             unsigned int nBlocks = floor(((double) nRows) / ((double) RAT_BLOCK_LENGTH));
             unsigned int remainRows = nRows - (nBlocks * RAT_BLOCK_LENGTH );
@@ -2574,6 +2615,129 @@ namespace rsgis{namespace rastergis{
         }
     }
     
+    void RSGISRasterAttUtils::readColumnsToMatrix(GDALRasterAttributeTable *attTable, std::vector<unsigned int> colIdxs, size_t startRow, size_t numRows, double *data)
+    {
+        size_t numCols = colIdxs.size();
+        if((startRow + numRows) > ((size_t)attTable->GetRowCount()))
+        {
+            throw RSGISAttributeTableException("The rows requested are not within the RAT.");
+        }
+        for(std::vector<unsigned int>::iterator iterCol = colIdxs.begin(); iterCol != colIdxs.end(); ++iterCol)
+        {
+            if((*iterCol) >= ((unsigned int)attTable->GetColumnCount()))
+            {
+                throw RSGISAttributeTableException("A column requested is not within the RAT.");
+            }
+        }
+        
+        // Read each column a block at a time and interleave into the rows of the matrix.
+        std::vector<double> blockData(std::min<size_t>(numRows, RAT_BLOCK_LENGTH));
+        for(size_t rowOffset = 0; rowOffset < numRows; rowOffset += RAT_BLOCK_LENGTH)
+        {
+            size_t numBlockRows = std::min<size_t>(RAT_BLOCK_LENGTH, numRows - rowOffset);
+            for(size_t c = 0; c < numCols; ++c)
+            {
+                if(attTable->ValuesIO(GF_Read, colIdxs[c], startRow + rowOffset, numBlockRows, blockData.data()) != CE_None)
+                {
+                    throw RSGISAttributeTableException("Failed to read a block of the RAT column '" + std::string(attTable->GetNameOfCol(colIdxs[c])) + "'.");
+                }
+                double *rowData = data + (rowOffset * numCols) + c;
+                for(size_t r = 0; r < numBlockRows; ++r)
+                {
+                    rowData[r * numCols] = blockData[r];
+                }
+            }
+        }
+    }
+    
+    void RSGISRasterAttUtils::writeMatrixToColumns(GDALRasterAttributeTable *attTable, std::vector<unsigned int> colIdxs, size_t startRow, size_t numRows, const double *data)
+    {
+        size_t numCols = colIdxs.size();
+        if((startRow + numRows) > ((size_t)attTable->GetRowCount()))
+        {
+            throw RSGISAttributeTableException("The rows requested are not within the RAT.");
+        }
+        for(std::vector<unsigned int>::iterator iterCol = colIdxs.begin(); iterCol != colIdxs.end(); ++iterCol)
+        {
+            if((*iterCol) >= ((unsigned int)attTable->GetColumnCount()))
+            {
+                throw RSGISAttributeTableException("A column requested is not within the RAT.");
+            }
+            RSGISRATColumnSummaries::columnModified(attTable, attTable->GetNameOfCol(*iterCol));
+        }
+        
+        std::vector<double> blockData(std::min<size_t>(numRows, RAT_BLOCK_LENGTH));
+        for(size_t rowOffset = 0; rowOffset < numRows; rowOffset += RAT_BLOCK_LENGTH)
+        {
+            size_t numBlockRows = std::min<size_t>(RAT_BLOCK_LENGTH, numRows - rowOffset);
+            for(size_t c = 0; c < numCols; ++c)
+            {
+                const double *rowData = data + (rowOffset * numCols) + c;
+                for(size_t r = 0; r < numBlockRows; ++r)
+                {
+                    blockData[r] = rowData[r * numCols];
+                }
+                if(attTable->ValuesIO(GF_Write, colIdxs[c], startRow + rowOffset, numBlockRows, blockData.data()) != CE_None)
+                {
+                    throw RSGISAttributeTableException("Failed to write a block of the RAT column '" + std::string(attTable->GetNameOfCol(colIdxs[c])) + "'.");
+                }
+            }
+        }
+    }
+    
+    // Reads or writes the rows directly to/from data a block at a time, so there is no copy of the column.
+    template<typename T>
+    static void rsgisRATColumnChunkIO(GDALRasterAttributeTable *attTable, GDALRWFlag rwFlag, unsigned int colIdx, size_t startRow, size_t numRows, T *data)
+    {
+        if((startRow + numRows) > ((size_t)attTable->GetRowCount()))
+        {
+            throw RSGISAttributeTableException("The rows requested are not within the RAT.");
+        }
+        for(size_t rowOffset = 0; rowOffset < numRows; rowOffset += RAT_BLOCK_LENGTH)
+        {
+            size_t numBlockRows = std::min<size_t>(RAT_BLOCK_LENGTH, numRows - rowOffset);
+            if(attTable->ValuesIO(rwFlag, colIdx, startRow + rowOffset, numBlockRows, data + rowOffset) != CE_None)
+            {
+                std::string ioType = (rwFlag == GF_Read)?"read":"write";
+                throw RSGISAttributeTableException("Failed to " + ioType + " a block of the RAT column '" + std::string(attTable->GetNameOfCol(colIdx)) + "'.");
+            }
+        }
+    }
+    
+    void RSGISRasterAttUtils::readColumnChunk(GDALRasterAttributeTable *attTable, std::string colName, size_t startRow, size_t numRows, double *data)
+    {
+        unsigned int colIdx = this->findColumnIndex(attTable, colName);
+        rsgisRATColumnChunkIO<double>(attTable, GF_Read, colIdx, startRow, numRows, data);
+    }
+    
+    void RSGISRasterAttUtils::readColumnChunk(GDALRasterAttributeTable *attTable, std::string colName, size_t startRow, size_t numRows, int *data)
+    {
+        unsigned int colIdx = this->findColumnIndex(attTable, colName);
+        rsgisRATColumnChunkIO<int>(attTable, GF_Read, colIdx, startRow, numRows, data);
+    }
+    
+    void RSGISRasterAttUtils::writeColumnChunk(GDALRasterAttributeTable *attTable, std::string colName, size_t startRow, size_t numRows, double *data)
+    {
+        if((startRow + numRows) > ((size_t)attTable->GetRowCount()))
+        {
+            throw RSGISAttributeTableException("The rows requested are not within the RAT.");
+        }
+        unsigned int colIdx = this->findColumnIndexOrCreate(attTable, colName, GFT_Real);
+        RSGISRATColumnSummaries::columnModified(attTable, colName);
+        rsgisRATColumnChunkIO<double>(attTable, GF_Write, colIdx, startRow, numRows, data);
+    }
+    
+    void RSGISRasterAttUtils::writeColumnChunk(GDALRasterAttributeTable *attTable, std::string colName, size_t startRow, size_t numRows, int *data)
+    {
+        if((startRow + numRows) > ((size_t)attTable->GetRowCount()))
+        {
+            throw RSGISAttributeTableException("The rows requested are not within the RAT.");
+        }
+        unsigned int colIdx = this->findColumnIndexOrCreate(attTable, colName, GFT_Integer);
+        RSGISRATColumnSummaries::columnModified(attTable, colName);
+        rsgisRATColumnChunkIO<int>(attTable, GF_Write, colIdx, startRow, numRows, data);
+    }
+    
     void RSGISRasterAttUtils::getImageBandMinMax(GDALDataset *inImage, int band, long *minVal, long *maxVal)
     {
         try
@@ -2592,6 +2756,61 @@ namespace rsgis{namespace rastergis{
         }
     }
 
+    void RSGISRasterAttUtils::rechunkKEARAT(GDALDataset *inImage, std::string outputImage, unsigned int chunkSize)
+    {
+        try
+        {
+            if(chunkSize == 0)
+            {
+                size_t numRows = 0;
+                for(int n = 1; n <= inImage->GetRasterCount(); ++n)
+                {
+                    GDALRasterAttributeTable *gdalATT = inImage->GetRasterBand(n)->GetDefaultRAT();
+                    if((gdalATT != NULL) && (((size_t)gdalATT->GetRowCount()) > numRows))
+                    {
+                        numRows = gdalATT->GetRowCount();
+                    }
+                }
+                chunkSize = rsgis::img::RSGISImageUtils::getKEARATChunkSize(numRows);
+            }
+            
+            GDALDriver *keaDriver = GetGDALDriverManager()->GetDriverByName("KEA");
+            if(keaDriver == NULL)
+            {
+                throw RSGISAttributeTableException("The KEA GDAL driver is not available.");
+            }
+            
+            // The KEA creation options are taken from the environment, with the RAT chunk size replaced.
+            rsgis::img::RSGISImageUtils imgUtils;
+            std::map<std::string, std::string> creationOpts = imgUtils.getCreateGDALImgEnvVars("KEA");
+            creationOpts["ATTBLOCKSIZE"] = std::to_string(chunkSize);
+            char **papszOptions = imgUtils.getGDALCreationOptions(creationOpts);
+            
+            std::cout << "Copying to " << outputImage << " with a RAT chunk size of " << chunkSize << " rows\n";
+            rsgis_tqdm pbar;
+            GDALDataset *outImage = keaDriver->CreateCopy(outputImage.c_str(), inImage, FALSE, papszOptions, (GDALProgressFunc)RSGISRATStatsTextProgress, &pbar);
+            CSLDestroy(papszOptions);
+            if(outImage == NULL)
+            {
+                std::string message = std::string("Could not create image ") + outputImage;
+                throw RSGISAttributeTableException(message);
+            }
+            GDALClose(outImage);
+        }
+        catch(RSGISAttributeTableException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISAttributeTableException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISAttributeTableException(e.what());
+        }
+    }
+    
     RSGISRasterAttUtils::~RSGISRasterAttUtils()
     {
 
@@ -23,7 +23,7 @@
 #ifndef RSGISRasterAttUtils_H
 #define RSGISRasterAttUtils_H
 
-#define RAT_BLOCK_LENGTH 100000 // Define block length (Default block length for KEA is 1000)
+#define RAT_BLOCK_LENGTH 100000 // Define block length (a multiple of the KEA RAT chunk sizes, see RSGISImageUtils::getKEARATChunkSize)
 
 #include <iostream>
 #include <fstream>
@@ -31,6 +31,7 @@
 #include <map>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 
 #include "gdal_priv.h"
 #include "gdal_rat.h"
@@ -43,6 +44,8 @@
 #include "common/rsgis-tqdm.h"
 #include "common/RSGISAttributeTableException.h"
 
+#include "rastergis/RSGISClumpNeighbourGraph.h"
+
 #include "utils/RSGISColour.h"
 
 #include "img/RSGISImageCalcException.h"
@@ -132,13 +135,32 @@ namespace rsgis{namespace rastergis{
         std::vector<double>* readDoubleColumnAsVec(GDALRasterAttributeTable *attTable, std::string colName);
         std::vector<int>* readIntColumnAsVec(GDALRasterAttributeTable *attTable, std::string colName);
         std::vector<std::string>* readStrColumnAsVec(GDALRasterAttributeTable *attTable, std::string colName);
-        std::vector<std::vector<size_t>* >* getRATNeighbours(GDALDataset *clumpImage, unsigned int ratBand);
+        /** Read the neighbours of each clump from the KEA RAT (in blocks) into a CSR graph which is owned by the caller. */
+        RSGISClumpNeighbourGraph* getRATNeighbours(GDALDataset *clumpImage, unsigned int ratBand);
         void writeStrColumn(GDALRasterAttributeTable *attTable, std::string colName, std::string *strDataVal, size_t colLen);
         void writeIntColumn(GDALRasterAttributeTable *attTable, std::string colName, int *intDataVal, size_t colLen);
         void writeRealColumn(GDALRasterAttributeTable *attTable, std::string colName, double *realDataVal, size_t colLen);
+        /** Reads numRows rows (from startRow) of the columns colIdxs into data, which is row-major (numRows x colIdxs.size()). */
+        void readColumnsToMatrix(GDALRasterAttributeTable *attTable, std::vector<unsigned int> colIdxs, size_t startRow, size_t numRows, double *data);
+        /** Writes data, which is row-major (numRows x colIdxs.size()), to numRows rows (from startRow) of the columns colIdxs. */
+        void writeMatrixToColumns(GDALRasterAttributeTable *attTable, std::vector<unsigned int> colIdxs, size_t startRow, size_t numRows, const double *data);
+        /** Reads numRows rows (from startRow) of the column colName directly into data, which must have numRows values. */
+        void readColumnChunk(GDALRasterAttributeTable *attTable, std::string colName, size_t startRow, size_t numRows, double *data);
+        /** Reads numRows rows (from startRow) of the column colName directly into data, which must have numRows values. */
+        void readColumnChunk(GDALRasterAttributeTable *attTable, std::string colName, size_t startRow, size_t numRows, int *data);
+        /** Writes data (numRows values) to numRows rows (from startRow) of the column colName, which is created (as a real column) if needed. */
+        void writeColumnChunk(GDALRasterAttributeTable *attTable, std::string colName, size_t startRow, size_t numRows, double *data);
+        /** Writes data (numRows values) to numRows rows (from startRow) of the column colName, which is created (as an integer column) if needed. */
+        void writeColumnChunk(GDALRasterAttributeTable *attTable, std::string colName, size_t startRow, size_t numRows, int *data);
         std::vector<RSGISRATCol>* getRatColumnsList(GDALRasterAttributeTable *gdalATT);
         std::vector<RSGISRATCol>* getVectorColumns(OGRLayer *layer, bool ignoreErr=false);
         void getImageBandMinMax(GDALDataset *inImage, int band, long *minVal, long *maxVal);
+        /**
+         * Copy an image to a KEA image (outputImage) where the RATs are chunked with chunkSize rows
+         * (the KEA ATTBLOCKSIZE). If chunkSize is 0 the chunk size is chosen for the number of
+         * rows of the largest RAT (see RSGISImageUtils::getKEARATChunkSize).
+         */
+        void rechunkKEARAT(GDALDataset *inImage, std::string outputImage, unsigned int chunkSize=0);
         ~RSGISRasterAttUtils();
     };
     
@@ -217,56 +217,74 @@ namespace rsgis{namespace rastergis{
     {
         if(inIntCols[0] == 1)
         {
-            bool foundTile = false;
-            unsigned int idx = 0;
-            unsigned int foundTileIdx = 0;
-            double eastings = inRealCols[0];
-            double northings = inRealCols[1];
-            for(unsigned int r = 0; r < numRows; ++r)
+            this->addClump(fid, inRealCols[0], inRealCols[1], inRealCols[2]);
+        }
+    }
+    
+    bool RSGISCalcTileStats::calcRATBlock(size_t startFID, size_t numRows, double **inRealCols, unsigned int numInRealCols, int **inIntCols, unsigned int numInIntCols, const RSGISRATStringColumn *inStringCols, unsigned int numInStringCols, double **outRealCols, unsigned int numOutRealCols, int **outIntCols, unsigned int numOutIntCols, std::string **outStringCols, unsigned int numOutStringCols)
+    {
+        const int *selected = inIntCols[0];
+        const double *eastings = inRealCols[0];
+        const double *northings = inRealCols[1];
+        const double *metric = inRealCols[2];
+        for(size_t i = 0; i < numRows; ++i)
+        {
+            if(selected[i] == 1)
             {
-                for(unsigned int c = 0; c < numCols; ++c)
-                {
-                    idx = c + (r * numCols);
-                    if( ((eastings >= tilesEnvs[idx]->MinX) & (eastings <= tilesEnvs[idx]->MaxX)) &
-                       ((northings >= tilesEnvs[idx]->MinY) & (northings <= tilesEnvs[idx]->MaxY)))
-                    {
-                        tileIdxs[idx]->push_back(fid);
-                        foundTileIdx = idx;
-                        foundTile = true;
-                        break;
-                    }
-                }
-                if(foundTile)
+                this->addClump(startFID + i, eastings[i], northings[i], metric[i]);
+            }
+        }
+        return true;
+    }
+    
+    void RSGISCalcTileStats::addClump(size_t fid, double eastings, double northings, double metricVal)
+    {
+        bool foundTile = false;
+        unsigned int idx = 0;
+        unsigned int foundTileIdx = 0;
+        for(unsigned int r = 0; r < numRows; ++r)
+        {
+            for(unsigned int c = 0; c < numCols; ++c)
+            {
+                idx = c + (r * numCols);
+                if( ((eastings >= tilesEnvs[idx]->MinX) & (eastings <= tilesEnvs[idx]->MaxX)) &
+                   ((northings >= tilesEnvs[idx]->MinY) & (northings <= tilesEnvs[idx]->MaxY)))
                 {
+                    tileIdxs[idx]->push_back(fid);
+                    foundTileIdx = idx;
+                    foundTile = true;
                     break;
                 }
             }
-            
             if(foundTile)
             {
-                double metricVal = inRealCols[2];
-                if(first[foundTileIdx])
+                break;
+            }
+        }
+        
+        if(foundTile)
+        {
+            if(first[foundTileIdx])
+            {
+                first[foundTileIdx] = false;
+                selectVal[foundTileIdx] = metricVal;
+                selectIdx[foundTileIdx] = fid;
+            }
+            else
+            {
+                if(method == meanMethod)
+                {
+                    selectVal[foundTileIdx] += metricVal;
+                }
+                else if((method == minMethod) & (metricVal < selectVal[foundTileIdx]))
                 {
-                    first[foundTileIdx] = false;
                     selectVal[foundTileIdx] = metricVal;
                     selectIdx[foundTileIdx] = fid;
                 }
-                else
+                else if((method == maxMethod) & (metricVal > selectVal[foundTileIdx]))
                 {
-                    if(method == meanMethod)
-                    {
-                        selectVal[foundTileIdx] += metricVal;
-                    }
-                    else if((method == minMethod) & (metricVal < selectVal[foundTileIdx]))
-                    {
-                        selectVal[foundTileIdx] = metricVal;
-                        selectIdx[foundTileIdx] = fid;
-                    }
-                    else if((method == minMethod) & (metricVal > selectVal[foundTileIdx]))
-                    {
-                        selectVal[foundTileIdx] = metricVal;
-                        selectIdx[foundTileIdx] = fid;
-                    }
+                    selectVal[foundTileIdx] = metricVal;
+                    selectIdx[foundTileIdx] = fid;
                 }
             }
         }
@@ -390,8 +408,13 @@ namespace rsgis{namespace rastergis{
     {
         try
         {
+            if((ratBand == 0) || (ratBand > ((unsigned int)clumpsDataset->GetRasterCount())))
+            {
+                throw rsgis::RSGISAttributeTableException("The RAT band is not within the image.");
+            }
             std::cout << "Import attribute tables to memory.\n";
-            GDALRasterAttributeTable *gdalRAT = clumpsDataset->GetRasterBand(1)->GetDefaultRAT();
+            GDALRasterBand *gdalRATBand = clumpsDataset->GetRasterBand(ratBand);
+            GDALRasterAttributeTable *gdalRAT = gdalRATBand->GetDefaultRAT();
             size_t numClumps = gdalRAT->GetRowCount();
             
             
@@ -401,12 +424,12 @@ namespace rsgis{namespace rastergis{
             unsigned int varColIdx = ratUtils.findColumnIndex(gdalRAT, varCol);
             unsigned int classNamesColIdx = 0;
             
-            double minVal = 0.0;
-            double maxVal = 0.0;
-            size_t numVals = 0;
+            // The range of the values is held with the RAT so is only calculated if the column has changed.
+            RSGISRATColumnSummary colSummary = RSGISRATColumnSummaries::getColumnSummary(gdalRATBand, varCol, (classRestrict?classColumn:""), classVal);
+            double minVal = colSummary.minVal;
+            double maxVal = colSummary.maxVal;
+            size_t numVals = colSummary.numVals;
             
-            RSGISCalcClassMinMax calcMinMaxStats = RSGISCalcClassMinMax(classRestrict, classVal, &minVal, &maxVal, &numVals);
-            RSGISRATCalc ratCalcMinMax = RSGISRATCalc(&calcMinMaxStats);
             std::vector<unsigned int> inRealColIdx;
             inRealColIdx.push_back(varColIdx);
             std::vector<unsigned int> inIntColIdx;
@@ -419,7 +442,6 @@ namespace rsgis{namespace rastergis{
             std::vector<unsigned int> outRealColIdx;
             std::vector<unsigned int> outIntColIdx;
             std::vector<unsigned int> outStrColIdx;
-            ratCalcMinMax.calcRATValues(gdalRAT, inRealColIdx, inIntColIdx, inStrColIdx, outRealColIdx, outIntColIdx, outStrColIdx);
             
             std::cout << "DATA [" << minVal << ", " << maxVal << "]: " << (maxVal-minVal) << "\t Num Vals = " << numVals << "\n";
             
@@ -482,64 +504,76 @@ namespace rsgis{namespace rastergis{
     {
         if(fid > 0)
         {
-            if(numInRealCols == 0)
+            this->checkColumns(numInRealCols, numInStringCols);
+            if((!useClassName) || (inStringCols[0] == className))
             {
-                throw rsgis::RSGISAttributeTableException("RSGISCalcClassMinMax::calcRATValue must have at least 1 double column specified.");
+                this->addValue(inRealCols[0]);
             }
-            
-            if(useClassName)
+        }
+    }
+    
+    bool RSGISCalcClassMinMax::calcRATBlock(size_t startFID, size_t numRows, double **inRealCols, unsigned int numInRealCols, int **inIntCols, unsigned int numInIntCols, const RSGISRATStringColumn *inStringCols, unsigned int numInStringCols, double **outRealCols, unsigned int numOutRealCols, int **outIntCols, unsigned int numOutIntCols, std::string **outStringCols, unsigned int numOutStringCols)
+    {
+        this->checkColumns(numInRealCols, numInStringCols);
+        
+        // Row 0 is ignored.
+        size_t i = (startFID == 0)?1:0;
+        const double *vals = inRealCols[0];
+        if(useClassName)
+        {
+            const char *classNameStr = className.c_str();
+            for(; i < numRows; ++i)
             {
-                if(numInStringCols != 1)
+                if(strcmp(inStringCols[0].getValue(i), classNameStr) == 0)
                 {
-                    throw rsgis::RSGISAttributeTableException("RSGISCalcClassMinMax::calcRATValue must have 1 string column specified if class names are to be used.");
-                }
-                
-                if(inStringCols[0] == className)
-                {
-                    if(firstVal)
-                    {
-                        *minVal = inRealCols[0];
-                        *maxVal = inRealCols[0];
-                        firstVal = false;
-                    }
-                    else
-                    {
-                        if(inRealCols[0] < (*minVal))
-                        {
-                            *minVal = inRealCols[0];
-                        }
-                        
-                        if(inRealCols[0] > (*maxVal))
-                        {
-                            *maxVal = inRealCols[0];
-                        }
-                    }
-                    ++(*numVals);
+                    this->addValue(vals[i]);
                 }
             }
-            else
+        }
+        else
+        {
+            for(; i < numRows; ++i)
             {
-                if(firstVal)
-                {
-                    *minVal = inRealCols[0];
-                    *maxVal = inRealCols[0];
-                    firstVal = false;
-                }
-                else
-                {
-                    if(inRealCols[0] < (*minVal))
-                    {
-                        *minVal = inRealCols[0];
-                    }
-                    
-                    if(inRealCols[0] > (*maxVal))
-                    {
-                        *maxVal = inRealCols[0];
-                    }
-                }
-                ++(*numVals);
+                this->addValue(vals[i]);
             }
         }
+        return true;
+    }
+    
+    void RSGISCalcClassMinMax::checkColumns(unsigned int numInRealCols, unsigned int numInStringCols)
+    {
+        if(numInRealCols == 0)
+        {
+            throw rsgis::RSGISAttributeTableException("RSGISCalcClassMinMax::calcRATValue must have at least 1 double column specified.");
+        }
+        
+        if(useClassName && (numInStringCols != 1))
+        {
+            throw rsgis::RSGISAttributeTableException("RSGISCalcClassMinMax::calcRATValue must have 1 string column specified if class names are to be used.");
+        }
+    }
+    
+    void RSGISCalcClassMinMax::addValue(double val)
+    {
+        if(firstVal)
+        {
+            *minVal = val;
+            *maxVal = val;
+            firstVal = false;
+        }
+        else
+        {
+            if(val < (*minVal))
+            {
+                *minVal = val;
+            }
+            
+            if(val > (*maxVal))
+            {
+                *maxVal = val;
+            }
+        }
+        ++(*numVals);
     }
     
     RSGISCalcClassMinMax::~RSGISCalcClassMinMax()
@@ -603,8 +637,13 @@ namespace rsgis{namespace rastergis{
     {
         try
         {
+            if((ratBand == 0) || (ratBand > ((unsigned int)clumpsDataset->GetRasterCount())))
+            {
+                throw rsgis::RSGISAttributeTableException("The RAT band is not within the image.");
+            }
             std::cout << "Import attribute tables to memory.\n";
-            GDALRasterAttributeTable *gdalRAT = clumpsDataset->GetRasterBand(1)->GetDefaultRAT();
+            GDALRasterBand *gdalRATBand = clumpsDataset->GetRasterBand(ratBand);
+            GDALRasterAttributeTable *gdalRAT = gdalRATBand->GetDefaultRAT();
             
             size_t ratLen = gdalRAT->GetRowCount();
             
@@ -614,13 +653,12 @@ namespace rsgis{namespace rastergis{
             unsigned int varColIdx = ratUtils.findColumnIndex(gdalRAT, varCol);
             unsigned int classNamesColIdx = ratUtils.findColumnIndex(gdalRAT, classColumn);
             
-            double minVal = 0.0;
-            double maxVal = 0.0;
-            size_t numVals = 0;
-            
             std::cout << "Calculate Min / Max.\n";
-            RSGISCalcClassMinMax calcMinMaxStats = RSGISCalcClassMinMax(true, classVal, &minVal, &maxVal, &numVals);
-            RSGISRATCalc ratCalcMinMax = RSGISRATCalc(&calcMinMaxStats);
+            RSGISRATColumnSummary colSummary = RSGISRATColumnSummaries::getColumnSummary(gdalRATBand, varCol, classColumn, classVal);
+            double minVal = colSummary.minVal;
+            double maxVal = colSummary.maxVal;
+            size_t numVals = colSummary.numVals;
+            
             std::vector<unsigned int> inRealColIdx;
             inRealColIdx.push_back(varColIdx);
             std::vector<unsigned int> inIntColIdx;
@@ -630,7 +668,6 @@ namespace rsgis{namespace rastergis{
             std::vector<unsigned int> outRealColIdx;
             std::vector<unsigned int> outIntColIdx;
             std::vector<unsigned int> outStrColIdx;
-            ratCalcMinMax.calcRATValues(gdalRAT, inRealColIdx, inIntColIdx, inStrColIdx, outRealColIdx, outIntColIdx, outStrColIdx);
             
             std::cout << "DATA [" << minVal << ", " << maxVal << "]: " << (maxVal-minVal) << "\t Num Vals = " << numVals << "\n";
             
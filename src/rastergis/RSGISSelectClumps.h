@@ -39,6 +39,7 @@
 #include "rastergis/RSGISRasterAttUtils.h"
 #include "rastergis/RSGISRATCalcValue.h"
 #include "rastergis/RSGISRATCalc.h"
+#include "rastergis/RSGISRATColumnSummary.h"
 
 #include "math/RSGISMathsUtils.h"
 #include "math/RSGISFitGaussianMixModel.h"
@@ -85,8 +86,10 @@ namespace rsgis{namespace rastergis{
     public:
         RSGISCalcTileStats(unsigned int numRows, unsigned int numCols, double *selectVal, unsigned int *selectIdx, std::vector<unsigned int> **tileIdxs, OGREnvelope **tilesEnvs, bool *first, RSGISSelectMethods method);
         void calcRATValue(size_t fid, double *inRealCols, unsigned int numInRealCols, int *inIntCols, unsigned int numInIntCols, std::string *inStringCols, unsigned int numInStringCols, double *outRealCols, unsigned int numOutRealCols, int *outIntCols, unsigned int numOutIntCols, std::string *outStringCols, unsigned int numOutStringCols);
+        bool calcRATBlock(size_t startFID, size_t numRows, double **inRealCols, unsigned int numInRealCols, int **inIntCols, unsigned int numInIntCols, const RSGISRATStringColumn *inStringCols, unsigned int numInStringCols, double **outRealCols, unsigned int numOutRealCols, int **outIntCols, unsigned int numOutIntCols, std::string **outStringCols, unsigned int numOutStringCols);
         ~RSGISCalcTileStats();
     private:
+        void addClump(size_t fid, double eastings, double northings, double metricVal);
         unsigned int numRows;
         unsigned int numCols;
         double *selectVal;
@@ -120,6 +123,7 @@ namespace rsgis{namespace rastergis{
     public:
         RSGISWriteSelectedClumpsColumn(unsigned int *selectIdx, unsigned int numIdxes);
         void calcRATValue(size_t fid, double *inRealCols, unsigned int numInRealCols, int *inIntCols, unsigned int numInIntCols, std::string *inStringCols, unsigned int numInStringCols, double *outRealCols, unsigned int numOutRealCols, int *outIntCols, unsigned int numOutIntCols, std::string *outStringCols, unsigned int numOutStringCols);
+        RSGISRATCalcValue* clone(){return new RSGISWriteSelectedClumpsColumn(this->selectIdx, this->numIdxes);};
         ~RSGISWriteSelectedClumpsColumn();
     private:
         unsigned int *selectIdx;
@@ -142,8 +146,11 @@ namespace rsgis{namespace rastergis{
     public:
         RSGISCalcClassMinMax(bool useClassName, std::string className, double *minVal, double *maxVal, size_t *numVals);
         void calcRATValue(size_t fid, double *inRealCols, unsigned int numInRealCols, int *inIntCols, unsigned int numInIntCols, std::string *inStringCols, unsigned int numInStringCols, double *outRealCols, unsigned int numOutRealCols, int *outIntCols, unsigned int numOutIntCols, std::string *outStringCols, unsigned int numOutStringCols);
+        bool calcRATBlock(size_t startFID, size_t numRows, double **inRealCols, unsigned int numInRealCols, int **inIntCols, unsigned int numInIntCols, const RSGISRATStringColumn *inStringCols, unsigned int numInStringCols, double **outRealCols, unsigned int numOutRealCols, int **outIntCols, unsigned int numOutIntCols, std::string **outStringCols, unsigned int numOutStringCols);
         ~RSGISCalcClassMinMax();
     private:
+        void checkColumns(unsigned int numInRealCols, unsigned int numInStringCols);
+        void addValue(double val);
         bool useClassName;
         std::string className;
         double *minVal;
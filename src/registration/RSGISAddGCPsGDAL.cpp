@@ -23,13 +23,14 @@
  */
 
 #include "RSGISAddGCPsGDAL.h"
+#include "common/RSGISGDALInit.h"
 
 namespace rsgis{namespace reg{
 
     RSGISAddGCPsGDAL::RSGISAddGCPsGDAL(std::string inFileName, std::string gcpFilePath, std::string outFileName, std::string gdalFormat, GDALDataType gdalDataType)
     {
         std::string gcpImage = "";
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         
         // Check if new dataset should be created
         if (outFileName != "")
@@ -148,7 +149,7 @@ namespace rsgis{namespace reg{
     
     void RSGISAddGCPsGDAL::copyImageWithoutSpatialRef(std::string inFileName, std::string outFileName, std::string gdalFormat, GDALDataType gdalDataType)
     {
-        GDALAllRegister();
+        rsgis::RSGISGDALInit::init();
         rsgis::img::RSGISImageUtils imgUtils;
 
 		int height = 0;
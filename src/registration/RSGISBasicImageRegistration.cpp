@@ -132,21 +132,48 @@ namespace rsgis{namespace reg{
 		
 		std::cout << "Started ." << std::flush;
 		
-		float xShift = 0;
-		float yShift = 0;
+		// The tie points are independent so are matched in parallel, with each
+		// thread reading the images through its own datasets.
+		std::vector<TiePoint*> tiePtsVec(tiePoints->begin(), tiePoints->end());
+		std::vector<GDALDataset*> refImgs;
+		std::vector<GDALDataset*> floatImgs;
+		unsigned int nThreads = this->openThreadDatasets(&refImgs, &floatImgs);
+		rsgis::RSGISThreadPool threadPool(nThreads);
 		
-		std::list<TiePoint*>::iterator iterTiePts;
-		for(iterTiePts = tiePoints->begin(); iterTiePts != tiePoints->end(); ++iterTiePts)
+		auto matchTiePts = [&](unsigned int t, size_t s, size_t e)
 		{
-			if(giveFeedback && ((counter % feedback) == 0))
+			float xShift = 0;
+			float yShift = 0;
+			for(size_t i = s; i < e; ++i)
 			{
-				std::cout << "." << feedbackVal << "." << std::flush;
-				feedbackVal += 10;
+				this->findTiePointLocation(tiePtsVec[i], windowSize, searchArea, metric, metricThreshold, subPixelResolution, &xShift, &yShift, refImgs[t], floatImgs[t]);
 			}
-			
-			this->findTiePointLocation(*iterTiePts, windowSize, searchArea, metric, metricThreshold, subPixelResolution, &xShift, &yShift);            
-			++counter;
+		};
+		
+		try
+		{
+			// Match the tie points in batches so progress can be reported.
+			size_t numTiePts = tiePtsVec.size();
+			size_t batchSize = giveFeedback?feedback:numTiePts;
+			for(size_t i = 0; i < numTiePts; i += batchSize)
+			{
+				if(giveFeedback && ((counter % feedback) == 0))
+				{
+					std::cout << "." << feedbackVal << "." << std::flush;
+					feedbackVal += 10;
+				}
+				
+				size_t batchEnd = std::min(i + batchSize, numTiePts);
+				threadPool.parallelFor(i, batchEnd, matchTiePts);
+				counter += (batchEnd - i);
+			}
+		}
+		catch(RSGISRegistrationException &e)
+		{
+			this->closeThreadDatasets(&refImgs, &floatImgs);
+			throw e;
 		}
+		this->closeThreadDatasets(&refImgs, &floatImgs);
 		std::cout << ". Complete\n";
 	}
 	
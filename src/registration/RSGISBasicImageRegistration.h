@@ -30,6 +30,8 @@
 #include <string>
 #include <cmath>
 #include <list>
+#include <vector>
+#include <algorithm>
 
 #include "gdal_priv.h"
 #include "ogrsf_frmts.h"
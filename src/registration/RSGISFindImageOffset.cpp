@@ -392,6 +392,383 @@ namespace rsgis{namespace reg{
         return extremeX;
     }
 
+    std::pair<double, double> RSGISFindImageOffset::findImageOffsetPhaseCorr(GDALDataset *refDataset, GDALDataset *fltDataset,
+                                                                             std::vector<unsigned int> refBands, std::vector<unsigned int> fltBands,
+                                                                             unsigned int xSearch, unsigned int ySearch,
+                                                                             bool calcSubPixelRes, unsigned int tileSize)
+    {
+        if(refBands.empty() || (refBands.size() != fltBands.size()))
+        {
+            throw RSGISRegistrationException("The same number of bands (at least 1) must be specified for the reference and floating images.");
+        }
+        unsigned int numBands = refBands.size();
+        for(unsigned int b = 0; b < numBands; ++b)
+        {
+            if((refBands[b] < 1) || (refBands[b] > ((unsigned int)refDataset->GetRasterCount())) || (fltBands[b] < 1) || (fltBands[b] > ((unsigned int)fltDataset->GetRasterCount())))
+            {
+                throw RSGISRegistrationException("A band is not within the reference or floating image (band numbering starts at 1).");
+            }
+        }
+        
+        double refTrans[6];
+        double fltTrans[6];
+        refDataset->GetGeoTransform(refTrans);
+        fltDataset->GetGeoTransform(fltTrans);
+        double pxlResX = std::fabs(refTrans[1]);
+        double pxlResY = std::fabs(refTrans[5]);
+        if((std::fabs(pxlResX - std::fabs(fltTrans[1])) > (pxlResX * 1e-6)) || (std::fabs(pxlResY - std::fabs(fltTrans[5])) > (pxlResY * 1e-6)))
+        {
+            throw RSGISRegistrationException("The reference and floating images must have the same pixel size.");
+        }
+        
+        // Find the overlapping region of the images.
+        unsigned int refWidth = refDataset->GetRasterXSize();
+        unsigned int refHeight = refDataset->GetRasterYSize();
+        unsigned int fltWidth = fltDataset->GetRasterXSize();
+        unsigned int fltHeight = fltDataset->GetRasterYSize();
+        double xMin = std::max(refTrans[0], fltTrans[0]);
+        double xMax = std::min(refTrans[0] + (refWidth * pxlResX), fltTrans[0] + (fltWidth * pxlResX));
+        double yMax = std::min(refTrans[3], fltTrans[3]);
+        double yMin = std::max(refTrans[3] - (refHeight * pxlResY), fltTrans[3] - (fltHeight * pxlResY));
+        if((xMax <= xMin) || (yMax <= yMin))
+        {
+            throw RSGISRegistrationException("The reference and floating images do not overlap.");
+        }
+        long refXOff = floor(((xMin - refTrans[0]) / pxlResX) + 0.5);
+        long refYOff = floor(((refTrans[3] - yMax) / pxlResY) + 0.5);
+        long fltXOff = floor(((xMin - fltTrans[0]) / pxlResX) + 0.5);
+        long fltYOff = floor(((fltTrans[3] - yMax) / pxlResY) + 0.5);
+        long width = floor(((xMax - xMin) / pxlResX) + 1e-6);
+        long height = floor(((yMax - yMin) / pxlResY) + 1e-6);
+        width = std::min(width, std::min(((long)refWidth) - refXOff, ((long)fltWidth) - fltXOff));
+        height = std::min(height, std::min(((long)refHeight) - refYOff, ((long)fltHeight) - fltYOff));
+        
+        unsigned int tileWidth = width;
+        unsigned int tileHeight = height;
+        if((tileSize > 0) && (tileSize < width))
+        {
+            tileWidth = tileSize;
+        }
+        if((tileSize > 0) && (tileSize < height))
+        {
+            tileHeight = tileSize;
+        }
+        if((width < 3) || (height < 3) || (tileWidth < 3) || (tileHeight < 3))
+        {
+            throw RSGISRegistrationException("The overlap between the images and the tiles must be at least 3 x 3 pixels.");
+        }
+        unsigned int nTilesX = width / tileWidth;
+        unsigned int nTilesY = height / tileHeight;
+        
+        std::vector<GDALRasterBand*> refImgBands(numBands);
+        std::vector<GDALRasterBand*> fltImgBands(numBands);
+        std::vector<double> refNoData(numBands, 0.0);
+        std::vector<int> useRefNoData(numBands, false);
+        std::vector<double> fltNoData(numBands, 0.0);
+        std::vector<int> useFltNoData(numBands, false);
+        for(unsigned int b = 0; b < numBands; ++b)
+        {
+            refImgBands[b] = refDataset->GetRasterBand(refBands[b]);
+            fltImgBands[b] = fltDataset->GetRasterBand(fltBands[b]);
+            refNoData[b] = refImgBands[b]->GetNoDataValue(&useRefNoData[b]);
+            fltNoData[b] = fltImgBands[b]->GetNoDataValue(&useFltNoData[b]);
+        }
+        
+        // A Hann window is applied to the tiles to reduce the effect of the tile edges on the correlation.
+        std::vector<double> xWindow(tileWidth);
+        std::vector<double> yWindow(tileHeight);
+        for(unsigned int i = 0; i < tileWidth; ++i)
+        {
+            xWindow[i] = 0.5 - (0.5 * cos((2.0 * M_PI * (i + 0.5)) / tileWidth));
+        }
+        for(unsigned int i = 0; i < tileHeight; ++i)
+        {
+            yWindow[i] = 0.5 - (0.5 * cos((2.0 * M_PI * (i + 0.5)) / tileHeight));
+        }
+        
+        unsigned int fftXSize = RSGISSimilaritySurfaceSums::findFFTSize(tileWidth);
+        unsigned int fftYSize = RSGISSimilaritySurfaceSums::findFFTSize(tileHeight);
+        size_t fftSize = ((size_t)fftXSize) * fftYSize;
+        
+        rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+        rsgis::RSGISThreadPool threadPool(context.numThreads);
+        unsigned int nThreads = threadPool.getNumThreads();
+        gsl_fft_complex_wavetable *xWavetable = gsl_fft_complex_wavetable_alloc(fftXSize);
+        gsl_fft_complex_wavetable *yWavetable = gsl_fft_complex_wavetable_alloc(fftYSize);
+        std::vector<RSGISPhaseCorrBuffers> threadBuffers(nThreads);
+        for(unsigned int t = 0; t < nThreads; ++t)
+        {
+            threadBuffers[t].xWorkspace = gsl_fft_complex_workspace_alloc(fftXSize);
+            threadBuffers[t].yWorkspace = gsl_fft_complex_workspace_alloc(fftYSize);
+            threadBuffers[t].refFFT.resize(fftSize * 2);
+            threadBuffers[t].fltFFT.resize(fftSize * 2);
+            threadBuffers[t].crossFFT.resize(fftSize * 2);
+        }
+        
+        size_t stripPxls = ((size_t)width) * tileHeight;
+        std::vector<float> refStrip(stripPxls * numBands);
+        std::vector<float> fltStrip(stripPxls * numBands);
+        std::vector<double> tileXOffs(nTilesX);
+        std::vector<double> tileYOffs(nTilesX);
+        std::vector<char> tileValid(nTilesX);
+        std::vector<double> xOffs;
+        std::vector<double> yOffs;
+        try
+        {
+            // Read each row of tiles from both images and then correlate the tiles in parallel.
+            for(unsigned int tY = 0; tY < nTilesY; ++tY)
+            {
+                for(unsigned int b = 0; b < numBands; ++b)
+                {
+                    if(refImgBands[b]->RasterIO(GF_Read, refXOff, refYOff + (tY * tileHeight), width, tileHeight, &refStrip[b * stripPxls], width, tileHeight, GDT_Float32, 0, 0) != CE_None)
+                    {
+                        throw RSGISRegistrationException("Could not read the reference image.");
+                    }
+                    if(fltImgBands[b]->RasterIO(GF_Read, fltXOff, fltYOff + (tY * tileHeight), width, tileHeight, &fltStrip[b * stripPxls], width, tileHeight, GDT_Float32, 0, 0) != CE_None)
+                    {
+                        throw RSGISRegistrationException("Could not read the floating image.");
+                    }
+                }
+                
+                threadPool.parallelFor(0, nTilesX, [&](unsigned int threadIdx, size_t start, size_t end)
+                {
+                    std::vector<const float*> refData(numBands);
+                    std::vector<const float*> fltData(numBands);
+                    for(size_t tX = start; tX < end; ++tX)
+                    {
+                        for(unsigned int b = 0; b < numBands; ++b)
+                        {
+                            refData[b] = refStrip.data() + (b * stripPxls) + (tX * tileWidth);
+                            fltData[b] = fltStrip.data() + (b * stripPxls) + (tX * tileWidth);
+                        }
+                        tileValid[tX] = this->calcTilePhaseCorr(refData, fltData, width, tileWidth, tileHeight, refNoData, useRefNoData, fltNoData, useFltNoData, xWindow, yWindow, fftXSize, fftYSize, xWavetable, yWavetable, &threadBuffers[threadIdx], xSearch, ySearch, calcSubPixelRes, &tileXOffs[tX], &tileYOffs[tX]);
+                    }
+                });
+                
+                for(unsigned int tX = 0; tX < nTilesX; ++tX)
+                {
+                    if(tileValid[tX])
+                    {
+                        xOffs.push_back(tileXOffs[tX]);
+                        yOffs.push_back(tileYOffs[tX]);
+                    }
+                }
+            }
+        }
+        catch(std::exception &e)
+        {
+            for(unsigned int t = 0; t < nThreads; ++t)
+            {
+                gsl_fft_complex_workspace_free(threadBuffers[t].xWorkspace);
+                gsl_fft_complex_workspace_free(threadBuffers[t].yWorkspace);
+            }
+            gsl_fft_complex_wavetable_free(xWavetable);
+            gsl_fft_complex_wavetable_free(yWavetable);
+            throw;
+        }
+        for(unsigned int t = 0; t < nThreads; ++t)
+        {
+            gsl_fft_complex_workspace_free(threadBuffers[t].xWorkspace);
+            gsl_fft_complex_workspace_free(threadBuffers[t].yWorkspace);
+        }
+        gsl_fft_complex_wavetable_free(xWavetable);
+        gsl_fft_complex_wavetable_free(yWavetable);
+        
+        std::cout << "Phase correlation used " << xOffs.size() << " of " << (nTilesX * nTilesY) << " tiles." << std::endl;
+        if(xOffs.empty())
+        {
+            throw RSGISRegistrationException("None of the tiles had enough valid data for the phase correlation.");
+        }
+        
+        // The tile shift is the floating image position within the reference image whereas
+        // the header shift is in map coordinates (i.e., the y axis is flipped).
+        double outShiftX = calcMedian(xOffs);
+        double outShiftY = -1.0 * calcMedian(yOffs);
+        std::cout << "Pixel Shift: [" << outShiftX << ", " << outShiftY <<"]\n\n";
+        
+        return std::pair<double, double>(outShiftX, outShiftY);
+    }
+    
+    bool RSGISFindImageOffset::calcTilePhaseCorr(const std::vector<const float*> &refData, const std::vector<const float*> &fltData, size_t rowStride,
+                                                 unsigned int width, unsigned int height, const std::vector<double> &refNoData, const std::vector<int> &useRefNoData,
+                                                 const std::vector<double> &fltNoData, const std::vector<int> &useFltNoData, const std::vector<double> &xWindow,
+                                                 const std::vector<double> &yWindow, unsigned int fftXSize, unsigned int fftYSize,
+                                                 gsl_fft_complex_wavetable *xWavetable, gsl_fft_complex_wavetable *yWavetable, RSGISPhaseCorrBuffers *buffers,
+                                                 unsigned int xSearch, unsigned int ySearch, bool calcSubPixelRes, double *xOff, double *yOff)
+    {
+        size_t fftSize = ((size_t)fftXSize) * fftYSize;
+        size_t minValid = (((size_t)width) * height) / 2;
+        double *refFFT = buffers->refFFT.data();
+        double *fltFFT = buffers->fltFFT.data();
+        double *crossFFT = buffers->crossFFT.data();
+        std::fill(buffers->crossFFT.begin(), buffers->crossFFT.end(), 0.0);
+        
+        bool bandUsed = false;
+        for(unsigned int b = 0; b < refData.size(); ++b)
+        {
+            // The no data values are replaced with the mean so they do not contribute to the correlation.
+            double sumRef = 0.0;
+            double sumFlt = 0.0;
+            size_t nRef = 0;
+            size_t nFlt = 0;
+            for(unsigned int y = 0; y < height; ++y)
+            {
+                const float *refRow = refData[b] + (y * rowStride);
+                const float *fltRow = fltData[b] + (y * rowStride);
+                for(unsigned int x = 0; x < width; ++x)
+                {
+                    if(std::isfinite(refRow[x]) && !(useRefNoData[b] && (refRow[x] == refNoData[b])))
+                    {
+                        sumRef += refRow[x];
+                        ++nRef;
+                    }
+                    if(std::isfinite(fltRow[x]) && !(useFltNoData[b] && (fltRow[x] == fltNoData[b])))
+                    {
+                        sumFlt += fltRow[x];
+                        ++nFlt;
+                    }
+                }
+            }
+            if((nRef == 0) || (nFlt == 0) || (nRef < minValid) || (nFlt < minValid))
+            {
+                continue;
+            }
+            double meanRef = sumRef / nRef;
+            double meanFlt = sumFlt / nFlt;
+            
+            std::fill(buffers->refFFT.begin(), buffers->refFFT.end(), 0.0);
+            std::fill(buffers->fltFFT.begin(), buffers->fltFFT.end(), 0.0);
+            double sumSqRef = 0.0;
+            double sumSqFlt = 0.0;
+            for(unsigned int y = 0; y < height; ++y)
+            {
+                const float *refRow = refData[b] + (y * rowStride);
+                const float *fltRow = fltData[b] + (y * rowStride);
+                double *refFFTRow = refFFT + ((((size_t)y) * fftXSize) * 2);
+                double *fltFFTRow = fltFFT + ((((size_t)y) * fftXSize) * 2);
+                for(unsigned int x = 0; x < width; ++x)
+                {
+                    double weight = xWindow[x] * yWindow[y];
+                    if(std::isfinite(refRow[x]) && !(useRefNoData[b] && (refRow[x] == refNoData[b])))
+                    {
+                        refFFTRow[x*2] = (refRow[x] - meanRef) * weight;
+                        sumSqRef += refFFTRow[x*2] * refFFTRow[x*2];
+                    }
+                    if(std::isfinite(fltRow[x]) && !(useFltNoData[b] && (fltRow[x] == fltNoData[b])))
+                    {
+                        fltFFTRow[x*2] = (fltRow[x] - meanFlt) * weight;
+                        sumSqFlt += fltFFTRow[x*2] * fltFFTRow[x*2];
+                    }
+                }
+            }
+            if((sumSqRef == 0.0) || (sumSqFlt == 0.0))
+            {
+                continue;
+            }
+            RSGISSimilaritySurfaceSums::fft2D(refFFT, fftXSize, fftYSize, xWavetable, buffers->xWorkspace, yWavetable, buffers->yWorkspace, false);
+            RSGISSimilaritySurfaceSums::fft2D(fltFFT, fftXSize, fftYSize, xWavetable, buffers->xWorkspace, yWavetable, buffers->yWorkspace, false);
+            
+            // The cross-power spectrum (reference multiplied by the complex conjugate
+            // of the floating FFT) is summed over the bands.
+            for(size_t i = 0; i < fftSize; ++i)
+            {
+                double rRe = refFFT[i*2];
+                double rIm = refFFT[(i*2)+1];
+                double fRe = fltFFT[i*2];
+                double fIm = fltFFT[(i*2)+1];
+                crossFFT[i*2] += (rRe * fRe) + (rIm * fIm);
+                crossFFT[(i*2)+1] += (rIm * fRe) - (rRe * fIm);
+            }
+            bandUsed = true;
+        }
+        if(!bandUsed)
+        {
+            return false;
+        }
+        
+        // Normalise the cross-power spectrum so only the phase difference remains.
+        double maxMag = 0.0;
+        for(size_t i = 0; i < fftSize; ++i)
+        {
+            maxMag = std::max(maxMag, std::hypot(crossFFT[i*2], crossFFT[(i*2)+1]));
+        }
+        for(size_t i = 0; i < fftSize; ++i)
+        {
+            double mag = std::hypot(crossFFT[i*2], crossFFT[(i*2)+1]);
+            if(mag > (maxMag * 1e-12))
+            {
+                crossFFT[i*2] /= mag;
+                crossFFT[(i*2)+1] /= mag;
+            }
+            else
+            {
+                crossFFT[i*2] = 0.0;
+                crossFFT[(i*2)+1] = 0.0;
+            }
+        }
+        RSGISSimilaritySurfaceSums::fft2D(crossFFT, fftXSize, fftYSize, xWavetable, buffers->xWorkspace, yWavetable, buffers->yWorkspace, true);
+        
+        // The peak of the correlation surface is at the shift (sX, sY) where
+        // flt(x, y) = ref(x + sX, y + sY), with the negative shifts wrapped around.
+        int xLimit = std::min<int>(xSearch, (fftXSize - 1) / 2);
+        int yLimit = std::min<int>(ySearch, (fftYSize - 1) / 2);
+        auto corrVal = [&](int sX, int sY)
+        {
+            size_t idxX = (sX < 0)?(sX + fftXSize):sX;
+            size_t idxY = (sY < 0)?(sY + fftYSize):sY;
+            return crossFFT[((idxY * fftXSize) + idxX) * 2];
+        };
+        int peakX = 0;
+        int peakY = 0;
+        double peakVal = corrVal(0, 0);
+        for(int sY = -yLimit; sY <= yLimit; ++sY)
+        {
+            for(int sX = -xLimit; sX <= xLimit; ++sX)
+            {
+                double val = corrVal(sX, sY);
+                if(val > peakVal)
+                {
+                    peakVal = val;
+                    peakX = sX;
+                    peakY = sY;
+                }
+            }
+        }
+        
+        *xOff = peakX;
+        *yOff = peakY;
+        if(calcSubPixelRes)
+        {
+            // Fit a parabola through the peak and its neighbours on each axis.
+            double prevVal = corrVal(peakX - 1, peakY);
+            double nextVal = corrVal(peakX + 1, peakY);
+            double denom = prevVal - (2.0 * peakVal) + nextVal;
+            if(denom < 0.0)
+            {
+                *xOff += std::min(0.5, std::max(-0.5, (prevVal - nextVal) / (2.0 * denom)));
+            }
+            prevVal = corrVal(peakX, peakY - 1);
+            nextVal = corrVal(peakX, peakY + 1);
+            denom = prevVal - (2.0 * peakVal) + nextVal;
+            if(denom < 0.0)
+            {
+                *yOff += std::min(0.5, std::max(-0.5, (prevVal - nextVal) / (2.0 * denom)));
+            }
+        }
+        return true;
+    }
+    
+    double RSGISFindImageOffset::calcMedian(std::vector<double> vals)
+    {
+        size_t n = vals.size();
+        std::sort(vals.begin(), vals.end());
+        if((n % 2) == 1)
+        {
+            return vals[n/2];
+        }
+        return (vals[(n/2)-1] + vals[n/2]) / 2.0;
+    }
+    
     RSGISFindImageOffset::~RSGISFindImageOffset()
     {
 
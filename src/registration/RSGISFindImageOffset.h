@@ -29,16 +29,23 @@
 #include <string>
 #include <cmath>
 #include <list>
+#include <vector>
+#include <algorithm>
 
 #include "gdal_priv.h"
 
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISCalcImage.h"
 #include "registration/RSGISImageSimilarityMetric.h"
+#include "registration/RSGISSimilaritySurface.h"
 #include "math/RSGISPolyFit.h"
+#include "common/RSGISRegistrationException.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
 
 #include <gsl/gsl_vector.h>
 #include <gsl/gsl_matrix.h>
+#include <gsl/gsl_fft_complex.h>
 
 #include "boost/math/special_functions/fpclassify.hpp"
 
@@ -67,7 +74,41 @@ namespace rsgis{namespace reg{
                                                   bool calcSubPixelRes=false, unsigned int subPixelRes=0);
         float findExtreme(bool findMin, gsl_vector *coefficients, unsigned int order, float minRange,
                           float maxRange, unsigned int resolution, float *extremeVal);
+        /**
+         * Find the offset of the floating image (in pixels, with the same sign as findImageOffset)
+         * by phase correlation of the overlapping region of the images, which reads each image
+         * once rather than calculating a metric over the overlap for every shift. If tileSize
+         * is above 0 the overlap is split into tiles of tileSize x tileSize pixels, the offset
+         * of each tile is found and the median of the tile offsets is returned; otherwise the
+         * whole overlap is used as a single tile. The images must have the same pixel size
+         * and the bands are numbered from 1.
+         */
+        std::pair<double, double> findImageOffsetPhaseCorr(GDALDataset *refDataset, GDALDataset *fltDataset,
+                                                           std::vector<unsigned int> refBands, std::vector<unsigned int> fltBands,
+                                                           unsigned int xSearch, unsigned int ySearch,
+                                                           bool calcSubPixelRes=true, unsigned int tileSize=0);
         ~RSGISFindImageOffset();
+    protected:
+        /**
+         * The buffers for the phase correlation of a tile, where the FFT wavetables
+         * are shared between the threads but the workspaces are not.
+         */
+        struct RSGISPhaseCorrBuffers
+        {
+            gsl_fft_complex_workspace *xWorkspace;
+            gsl_fft_complex_workspace *yWorkspace;
+            std::vector<double> refFFT;
+            std::vector<double> fltFFT;
+            std::vector<double> crossFFT;
+        };
+        /** Find the phase correlation peak of a tile, returning false if the tile does not have enough valid data. */
+        bool calcTilePhaseCorr(const std::vector<const float*> &refData, const std::vector<const float*> &fltData, size_t rowStride,
+                               unsigned int width, unsigned int height, const std::vector<double> &refNoData, const std::vector<int> &useRefNoData,
+                               const std::vector<double> &fltNoData, const std::vector<int> &useFltNoData, const std::vector<double> &xWindow,
+                               const std::vector<double> &yWindow, unsigned int fftXSize, unsigned int fftYSize,
+                               gsl_fft_complex_wavetable *xWavetable, gsl_fft_complex_wavetable *yWavetable, RSGISPhaseCorrBuffers *buffers,
+                               unsigned int xSearch, unsigned int ySearch, bool calcSubPixelRes, double *xOff, double *yOff);
+        static double calcMedian(std::vector<double> vals);
     };
 
 
@@ -26,7 +26,70 @@
 
 namespace rsgis{namespace reg{
     
-    RSGISImagePixelRegistration::RSGISImagePixelRegistration(GDALDataset *reference, GDALDataset *floating, std::string outputImagePath, std::string outputFormat, unsigned int windowSize, unsigned int searchArea, RSGISImageSimilarityMetric *metric, unsigned int subPixelResolution):RSGISImageRegistration(reference, floating)
+    RSGISImagePyramidLevelRegistration::RSGISImagePyramidLevelRegistration(GDALDataset *reference, GDALDataset *floating, unsigned int windowSize, RSGISImageSimilarityMetric *metric, unsigned int subPixelResolution):RSGISImageRegistration(reference, floating)
+    {
+        this->windowSize = windowSize;
+        this->metric = metric;
+        this->subPixelResolution = subPixelResolution;
+    }
+    
+    void RSGISImagePyramidLevelRegistration::initRegistration()
+    {
+        this->findOverlap();
+    }
+    
+    void RSGISImagePyramidLevelRegistration::exportTiePointsENVIImage2Map(std::string filepath)
+    {
+        throw RSGISRegistrationException("Tie point export is not implemented.");
+    }
+    
+    void RSGISImagePyramidLevelRegistration::exportTiePointsENVIImage2Image(std::string filepath)
+    {
+        throw RSGISRegistrationException("Tie point export is not implemented.");
+    }
+    
+    void RSGISImagePyramidLevelRegistration::exportTiePointsRSGISImage2Map(std::string filepath)
+    {
+        throw RSGISRegistrationException("Tie point export is not implemented.");
+    }
+    
+    void RSGISImagePyramidLevelRegistration::exportTiePointsRSGISMapOffs(std::string filepath)
+    {
+        throw RSGISRegistrationException("Tie point export is not implemented.");
+    }
+    
+    void RSGISImagePyramidLevelRegistration::matchPixel(unsigned int xPxl, unsigned int yPxl, unsigned int searchArea, float *xShift, float *yShift)
+    {
+        TiePoint tiePt;
+        tiePt.eastings = this->overlap->tlX + (((double)xPxl)*this->overlap->xRes);
+        tiePt.northings = this->overlap->tlY - (((double)yPxl)*this->overlap->yRes);
+        tiePt.xRef = this->overlap->refXStart + xPxl;
+        tiePt.yRef = this->overlap->refYStart + yPxl;
+        tiePt.xFloat = this->overlap->floatXStart + xPxl;
+        tiePt.yFloat = this->overlap->floatYStart + yPxl;
+        tiePt.xShift = *xShift;
+        tiePt.yShift = *yShift;
+        tiePt.metricVal = std::numeric_limits<double>::signaling_NaN();
+        
+        float moveInX = 0;
+        float moveInY = 0;
+        this->findTiePointLocation(&tiePt, this->windowSize, searchArea, this->metric, this->subPixelResolution, &moveInX, &moveInY);
+        
+        // Keep the starting shift if a match could not be found.
+        if(!((boost::math::isnan)(tiePt.xShift) || (boost::math::isnan)(tiePt.yShift)))
+        {
+            *xShift = tiePt.xShift;
+            *yShift = tiePt.yShift;
+        }
+    }
+    
+    RSGISImagePyramidLevelRegistration::~RSGISImagePyramidLevelRegistration()
+    {
+        
+    }
+    
+    
+    RSGISImagePixelRegistration::RSGISImagePixelRegistration(GDALDataset *reference, GDALDataset *floating, std::string outputImagePath, std::string outputFormat, unsigned int windowSize, unsigned int searchArea, RSGISImageSimilarityMetric *metric, unsigned int subPixelResolution):RSGISImageRegistration(reference, floating), outputImage(NULL), initExecuted(false), numPyramidLevels(0), pyramidSearchArea(2)
     {
         this->outputImagePath = outputImagePath;
         this->outputFormat = outputFormat;
@@ -36,6 +99,16 @@ namespace rsgis{namespace reg{
         this->subPixelResolution = subPixelResolution;
     }
     
+    void RSGISImagePixelRegistration::setPyramidLevels(unsigned int numLevels, unsigned int levelSearchArea)
+    {
+        if((numLevels > 0) && (levelSearchArea == 0))
+        {
+            throw RSGISRegistrationException("The search area for each pyramid level needs to be at least 1 pixel.");
+        }
+        this->numPyramidLevels = numLevels;
+        this->pyramidSearchArea = levelSearchArea;
+    }
+    
     void RSGISImagePixelRegistration::initRegistration()
     {
         try
@@ -83,6 +156,11 @@ namespace rsgis{namespace reg{
             outputImage->GetRasterBand(3)->SetDescription("Metric Value");
             
             delete[] gdalTranslation;
+            
+            if(this->numPyramidLevels > 0)
+            {
+                this->buildPyramid();
+            }
         }
         catch (RSGISRegistrationException &e)
         {
@@ -120,6 +198,19 @@ namespace rsgis{namespace reg{
             double currentEastings = overlap->tlX;
             double currentNorthings = overlap->tlY;
             
+            // With a pyramid the search at full resolution starts from the shifts found
+            // at the finest level of the pyramid so only a small area is searched.
+            std::vector<float> pyramidXShifts;
+            std::vector<float> pyramidYShifts;
+            OverlapRegion *pyramidOverlap = NULL;
+            unsigned int pxlSearchArea = this->searchArea;
+            if(!this->pyramidLevels.empty())
+            {
+                this->matchPyramidLevels(&pyramidXShifts, &pyramidYShifts);
+                pyramidOverlap = this->pyramidLevels.front()->getOverlap();
+                pxlSearchArea = this->pyramidSearchArea;
+            }
+            
             int feedback = this->overlap->ySize/10;
 			int feedbackCounter = 0;
 			std::cout << "Started" << std::flush;
@@ -146,7 +237,14 @@ namespace rsgis{namespace reg{
                     tiePt->yShift = 0;
                     tiePt->metricVal = std::numeric_limits<double>::signaling_NaN();
                     
-                    this->findTiePointLocation(tiePt, windowSize, searchArea, metric, subPixelResolution, &xShiftPxl, &yShiftPxl);
+                    if(pyramidOverlap != NULL)
+                    {
+                        this->getCoarseShift(pyramidOverlap, &pyramidXShifts, &pyramidYShifts, currentEastings + (overlap->xRes/2), currentNorthings - (overlap->yRes/2), &xShiftPxl, &yShiftPxl);
+                        tiePt->xShift = xShiftPxl;
+                        tiePt->yShift = yShiftPxl;
+                    }
+                    
+                    this->findTiePointLocation(tiePt, windowSize, pxlSearchArea, metric, subPixelResolution, &xShiftPxl, &yShiftPxl);
                                         
                     xShift[j] = tiePt->xShift;
                     yShift[j] = tiePt->yShift;
@@ -191,6 +289,7 @@ namespace rsgis{namespace reg{
     {
         try
         {
+            this->clearPyramid();
             GDALClose(outputImage);
         }
         catch (RSGISRegistrationException &e)
@@ -211,6 +310,167 @@ namespace rsgis{namespace reg{
         }
     }
     
+    void RSGISImagePixelRegistration::buildPyramid()
+    {
+        this->clearPyramid();
+        
+        unsigned int minSize = (this->windowSize*2)+1;
+        unsigned int factor = 1;
+        for(unsigned int i = 0; i < this->numPyramidLevels; ++i)
+        {
+            factor *= 2;
+            // Stop once the overlap is too small for a level to contain a matching window.
+            if(((this->overlap->xSize/factor) < minSize) || ((this->overlap->ySize/factor) < minSize))
+            {
+                std::cerr << "WARNING: Only " << i << " pyramid levels can be used as the image overlap is too small.\n";
+                break;
+            }
+            
+            std::cout << "Building pyramid level " << (i+1) << " (1/" << factor << " resolution)\n";
+            this->pyramidRefImgs.push_back(this->createPyramidLevel(this->referenceIMG, factor));
+            this->pyramidFloatImgs.push_back(this->createPyramidLevel(this->floatingIMG, factor));
+            this->pyramidLevels.push_back(new RSGISImagePyramidLevelRegistration(this->pyramidRefImgs.back(), this->pyramidFloatImgs.back(), this->windowSize, this->metric, this->subPixelResolution));
+            this->pyramidLevels.back()->initRegistration();
+        }
+    }
+    
+    GDALDataset* RSGISImagePixelRegistration::createPyramidLevel(GDALDataset *dataset, unsigned int factor)
+    {
+        // The level covers a whole number of pixels of the image so the pixel size is
+        // exactly factor times the image pixel size.
+        unsigned int xSize = dataset->GetRasterXSize()/factor;
+        unsigned int ySize = dataset->GetRasterYSize()/factor;
+        unsigned int numBands = dataset->GetRasterCount();
+        if((xSize == 0) || (ySize == 0))
+        {
+            throw RSGISRegistrationException("The image is too small for the pyramid level.");
+        }
+        
+        double transform[6];
+        dataset->GetGeoTransform(transform);
+        transform[1] *= factor;
+        transform[2] *= factor;
+        transform[4] *= factor;
+        transform[5] *= factor;
+        
+        rsgis::img::RSGISImageUtils imgUtils;
+        GDALDataset *levelDS = imgUtils.createBlankImage("", transform, xSize, ySize, numBands, dataset->GetProjectionRef(), 0, "MEM", GDT_Float32);
+        
+        // Reading with a smaller buffer uses the overviews of the image where available.
+        GDALRasterIOExtraArg extraArg;
+        INIT_RASTERIO_EXTRA_ARG(extraArg);
+        extraArg.eResampleAlg = GRIORA_Average;
+        
+        std::vector<float> data(((size_t)xSize)*ySize);
+        for(unsigned int n = 0; n < numBands; ++n)
+        {
+            if(dataset->GetRasterBand(n+1)->RasterIO(GF_Read, 0, 0, xSize*factor, ySize*factor, data.data(), xSize, ySize, GDT_Float32, 0, 0, &extraArg) != CE_None)
+            {
+                GDALClose(levelDS);
+                throw RSGISRegistrationException("Failed to read the image for the pyramid level.");
+            }
+            if(levelDS->GetRasterBand(n+1)->RasterIO(GF_Write, 0, 0, xSize, ySize, data.data(), xSize, ySize, GDT_Float32, 0, 0) != CE_None)
+            {
+                GDALClose(levelDS);
+                throw RSGISRegistrationException("Failed to write the pyramid level.");
+            }
+        }
+        
+        return levelDS;
+    }
+    
+    void RSGISImagePixelRegistration::clearPyramid()
+    {
+        for(size_t i = 0; i < this->pyramidLevels.size(); ++i)
+        {
+            delete this->pyramidLevels.at(i);
+        }
+        this->pyramidLevels.clear();
+        for(size_t i = 0; i < this->pyramidRefImgs.size(); ++i)
+        {
+            GDALClose(this->pyramidRefImgs.at(i));
+        }
+        this->pyramidRefImgs.clear();
+        for(size_t i = 0; i < this->pyramidFloatImgs.size(); ++i)
+        {
+            GDALClose(this->pyramidFloatImgs.at(i));
+        }
+        this->pyramidFloatImgs.clear();
+    }
+    
+    void RSGISImagePixelRegistration::matchPyramidLevels(std::vector<float> *xShifts, std::vector<float> *yShifts)
+    {
+        std::vector<float> coarseXShifts;
+        std::vector<float> coarseYShifts;
+        OverlapRegion *coarseOverlap = NULL;
+        
+        for(size_t l = this->pyramidLevels.size(); l > 0; --l)
+        {
+            RSGISImagePyramidLevelRegistration *level = this->pyramidLevels.at(l-1);
+            OverlapRegion *levelOverlap = level->getOverlap();
+            
+            // The coarsest level is searched far enough to cover the full search area.
+            unsigned int levelSearchArea = this->pyramidSearchArea;
+            if(coarseOverlap == NULL)
+            {
+                unsigned int factor = 1 << l;
+                levelSearchArea = std::max(this->pyramidSearchArea, (this->searchArea + factor - 1)/factor);
+            }
+            
+            std::cout << "Matching pyramid level " << l << " [" << levelOverlap->xSize << "," << levelOverlap->ySize << "] with a search area of " << levelSearchArea << " pixels\n";
+            
+            xShifts->assign(levelOverlap->xSize * levelOverlap->ySize, 0);
+            yShifts->assign(levelOverlap->xSize * levelOverlap->ySize, 0);
+            
+            rsgis_tqdm pbar;
+            float xShift = 0;
+            float yShift = 0;
+            size_t idx = 0;
+            for(unsigned int i = 0; i < levelOverlap->ySize; ++i)
+            {
+                pbar.progress(i, levelOverlap->ySize);
+                for(unsigned int j = 0; j < levelOverlap->xSize; ++j)
+                {
+                    xShift = 0;
+                    yShift = 0;
+                    if(coarseOverlap != NULL)
+                    {
+                        double eastings = levelOverlap->tlX + ((((double)j)+0.5)*levelOverlap->xRes);
+                        double northings = levelOverlap->tlY - ((((double)i)+0.5)*levelOverlap->yRes);
+                        this->getCoarseShift(coarseOverlap, &coarseXShifts, &coarseYShifts, eastings, northings, &xShift, &yShift);
+                    }
+                    
+                    level->matchPixel(j, i, levelSearchArea, &xShift, &yShift);
+                    
+                    idx = (((size_t)i)*levelOverlap->xSize) + j;
+                    (*xShifts)[idx] = xShift;
+                    (*yShifts)[idx] = yShift;
+                }
+            }
+            pbar.finish();
+            
+            coarseXShifts.swap(*xShifts);
+            coarseYShifts.swap(*yShifts);
+            coarseOverlap = levelOverlap;
+        }
+        
+        xShifts->swap(coarseXShifts);
+        yShifts->swap(coarseYShifts);
+    }
+    
+    void RSGISImagePixelRegistration::getCoarseShift(OverlapRegion *coarseOverlap, std::vector<float> *xShifts, std::vector<float> *yShifts, double eastings, double northings, float *xShift, float *yShift)
+    {
+        long x = (long)floor((eastings - coarseOverlap->tlX)/coarseOverlap->xRes);
+        long y = (long)floor((coarseOverlap->tlY - northings)/coarseOverlap->yRes);
+        x = std::max(0L, std::min(x, ((long)coarseOverlap->xSize)-1));
+        y = std::max(0L, std::min(y, ((long)coarseOverlap->ySize)-1));
+        
+        // The coarser level has half the resolution so the shift in pixels doubles.
+        size_t idx = (((size_t)y)*coarseOverlap->xSize) + x;
+        *xShift = xShifts->at(idx) * 2;
+        *yShift = yShifts->at(idx) * 2;
+    }
+    
     void RSGISImagePixelRegistration::exportTiePointsENVIImage2Map(std::string filepath)
     {
         throw RSGISRegistrationException("Tie point export is not implemented.");
@@ -233,7 +493,7 @@ namespace rsgis{namespace reg{
     
     RSGISImagePixelRegistration::~RSGISImagePixelRegistration()
     {
-        
+        this->clearPyramid();
     }
 }}
 
@@ -30,6 +30,8 @@
 #include <string>
 #include <cmath>
 #include <list>
+#include <vector>
+#include <algorithm>
 
 #include "gdal_priv.h"
 #include "ogrsf_frmts.h"
@@ -58,10 +60,49 @@
 
 namespace rsgis{namespace reg{
     
+    /**
+     * Matches the pixels of one level of an image pyramid built from the
+     * reference and floating images, used by RSGISImagePixelRegistration
+     * to estimate the shifts at a coarse resolution.
+     */
+    class DllExport RSGISImagePyramidLevelRegistration : public RSGISImageRegistration
+    {
+    public:
+        RSGISImagePyramidLevelRegistration(GDALDataset *reference, GDALDataset *floating, unsigned int windowSize, RSGISImageSimilarityMetric *metric, unsigned int subPixelResolution);
+        void initRegistration();
+        void executeRegistration(){};
+        void finaliseRegistration(){};
+        void exportTiePointsENVIImage2Map(std::string filepath);
+        void exportTiePointsENVIImage2Image(std::string filepath);
+        void exportTiePointsRSGISImage2Map(std::string filepath);
+        void exportTiePointsRSGISMapOffs(std::string filepath);
+        OverlapRegion* getOverlap(){return this->overlap;};
+        /**
+         * Match the pixel (from the top left of the overlap) searching searchArea pixels
+         * around the shift provided in xShift and yShift, which are updated with the
+         * shift found (in pixels of this level).
+         */
+        void matchPixel(unsigned int xPxl, unsigned int yPxl, unsigned int searchArea, float *xShift, float *yShift);
+        ~RSGISImagePyramidLevelRegistration();
+    private:
+        unsigned int windowSize;
+        RSGISImageSimilarityMetric *metric;
+        unsigned int subPixelResolution;
+    };
+    
 	class DllExport RSGISImagePixelRegistration : public RSGISImageRegistration
 	{
 	public:
 		RSGISImagePixelRegistration(GDALDataset *reference, GDALDataset *floating, std::string outputImagePath, std::string outputFormat, unsigned int windowSize, unsigned int searchArea, RSGISImageSimilarityMetric *metric, unsigned int subPixelResolution);
+        /**
+         * Use a coarse to fine search, where the shifts are first estimated on numLevels
+         * levels of an image pyramid (each half the resolution of the previous one) and
+         * then refined at each finer level (and the full resolution) with a search of
+         * levelSearchArea pixels. The coarsest level is searched far enough to cover
+         * searchArea, so large shifts can be found without searching the full area for
+         * every pixel. A numLevels of 0 (the default) searches the full area for every pixel.
+         */
+        void setPyramidLevels(unsigned int numLevels, unsigned int levelSearchArea=2);
 		void initRegistration();
 		void executeRegistration();
 		void finaliseRegistration();
@@ -71,6 +112,11 @@ namespace rsgis{namespace reg{
         void exportTiePointsRSGISMapOffs(std::string filepath);
 		~RSGISImagePixelRegistration();
 	private:
+        void buildPyramid();
+        GDALDataset* createPyramidLevel(GDALDataset *dataset, unsigned int factor);
+        void clearPyramid();
+        void matchPyramidLevels(std::vector<float> *xShifts, std::vector<float> *yShifts);
+        void getCoarseShift(OverlapRegion *coarseOverlap, std::vector<float> *xShifts, std::vector<float> *yShifts, double eastings, double northings, float *xShift, float *yShift);
 		std::string outputImagePath;
         std::string outputFormat;
         GDALDataset *outputImage;
@@ -79,6 +125,11 @@ namespace rsgis{namespace reg{
 		unsigned int searchArea;
 		RSGISImageSimilarityMetric *metric;
 		unsigned int subPixelResolution;
+        unsigned int numPyramidLevels;
+        unsigned int pyramidSearchArea;
+        std::vector<GDALDataset*> pyramidRefImgs;
+        std::vector<GDALDataset*> pyramidFloatImgs;
+        std::vector<RSGISImagePyramidLevelRegistration*> pyramidLevels;
 	};
 }}
 
@@ -28,12 +28,21 @@
 namespace rsgis{namespace reg{
 
 		
-	RSGISImageRegistration::RSGISImageRegistration(GDALDataset *reference, GDALDataset *floating): referenceIMG(NULL), floatingIMG(NULL), overlap(NULL), overlapDefined(false)
+	RSGISImageRegistration::RSGISImageRegistration(GDALDataset *reference, GDALDataset *floating): referenceIMG(NULL), floatingIMG(NULL), overlap(NULL), overlapDefined(false), numThreads(1)
 	{
 		this->referenceIMG = reference;
 		this->floatingIMG = floating;
 	}
 	
+	void RSGISImageRegistration::setNumThreads(unsigned int numThreads)
+	{
+		this->numThreads = numThreads;
+		if(this->numThreads == 0)
+		{
+			this->numThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+		}
+	}
+	
 	void RSGISImageRegistration::runCompleteRegistration()
 	{
 		std::cout << "Initialising the registration process\n"; 
@@ -114,7 +123,7 @@ namespace rsgis{namespace reg{
 
 	}
 	
-	float RSGISImageRegistration::findTiePointLocation(TiePoint *tiePt, unsigned int windowSize, unsigned int searchArea, RSGISImageSimilarityMetric *metric, float metricThreshold, unsigned int subPixelResolution, float *moveInX, float *moveInY)
+	float RSGISImageRegistration::findTiePointLocation(TiePoint *tiePt, unsigned int windowSize, unsigned int searchArea, RSGISImageSimilarityMetric *metric, float metricThreshold, unsigned int subPixelResolution, float *moveInX, float *moveInY, GDALDataset *refImg, GDALDataset *floatImg)
 	{
 		float distanceMoved = 0;
 		
@@ -122,8 +131,15 @@ namespace rsgis{namespace reg{
 		{
 			throw RSGISRegistrationException("The overlap needs to be defined before tie location can be defined.");
 		}
+		if(refImg == NULL)
+		{
+			refImg = this->referenceIMG;
+		}
+		if(floatImg == NULL)
+		{
+			floatImg = this->floatingIMG;
+		}
 		
-		rsgis::img::RSGISImageUtils imgUtils;
 		try 
 		{
 			// Setup overlapping region variables.
@@ -178,6 +194,35 @@ namespace rsgis{namespace reg{
             float currentRemainderX = 0;
             float currentRemainderY = 0;
 			
+            // Read the region covering the windows for all the shifts once, rather
+            // than reading the images for every shift.
+            RSGISImageWindowCache refCache(refImg);
+            RSGISImageWindowCache floatCache(floatImg);
+            for(int yShift = yShiftStart; yShift <= yShiftEnd; ++yShift)
+            {
+                for(int xShift = xShiftStart; xShift <= xShiftEnd; ++xShift)
+                {
+                    try
+                    {
+                        this->getImageOverlapWithFloatShift((((float)xShift)+tiePt->xShift), (((float)yShift)+tiePt->yShift), dsOffsets, &overlapWidth, &overlapHeight, overlapTransform, env, &remainderX, &remainderY, refImg, floatImg);
+                        if((overlapWidth > 0) & (overlapHeight > 0))
+                        {
+                            refCache.addWindow(dsOffsets[0][0], dsOffsets[0][1], overlapWidth, overlapHeight);
+                            floatCache.addWindow(dsOffsets[1][0], dsOffsets[1][1], overlapWidth, overlapHeight);
+                        }
+                    }
+                    catch (RSGISRegistrationException &e)
+                    {
+                        // Reported when the shift is processed below.
+                    }
+                }
+            }
+            refCache.readWindows();
+            floatCache.readWindows();
+            
+            // Where possible calculate the metric for all the shifts in one go.
+            bool useSurface = this->calcSimilaritySurface(tiePt, env, searchArea, metric, &refCache, &floatCache, imageSimilarity, refImg, floatImg);
+			
             // Move floating window over search space
 			for(int yShift = yShiftStart; yShift <= yShiftEnd; ++yShift)
 			{
@@ -186,24 +231,31 @@ namespace rsgis{namespace reg{
 				{
 					try
 					{
-						this->getImageOverlapWithFloatShift((((float)xShift)+tiePt->xShift), (((float)yShift)+tiePt->yShift), dsOffsets, &overlapWidth, &overlapHeight, overlapTransform, env, &remainderX, &remainderY);
+						this->getImageOverlapWithFloatShift((((float)xShift)+tiePt->xShift), (((float)yShift)+tiePt->yShift), dsOffsets, &overlapWidth, &overlapHeight, overlapTransform, env, &remainderX, &remainderY, refImg, floatImg);
 						
 						if((overlapWidth > 0) & (overlapHeight > 0))
 						{
-							numRefDataVals = 0;
-							numFloatDataVals = 0;
-							
-							refDataBlock = imgUtils.getImageDataBlock(referenceIMG, dsOffsets[0], overlapWidth, overlapHeight, &numRefDataVals);
-							floatDataBlock = imgUtils.getImageDataBlock(floatingIMG, dsOffsets[1], overlapWidth, overlapHeight, &numFloatDataVals);
-							
-							if(numRefDataVals != numFloatDataVals)
-							{
-								throw RSGISRegistrationException("The number of data values read from the images does not match.");
-							}
-							
-							metricVal = metric->calcValue(refDataBlock, floatDataBlock, numRefDataVals, overlap->numRefBands);
-							
-							imageSimilarity[yIdx][xIdx] = metricVal;
+                            if(useSurface)
+                            {
+                                metricVal = imageSimilarity[yIdx][xIdx];
+                            }
+                            else
+                            {
+                                numRefDataVals = 0;
+                                numFloatDataVals = 0;
+                                
+                                refDataBlock = refCache.getDataBlock(dsOffsets[0], overlapWidth, overlapHeight, &numRefDataVals);
+                                floatDataBlock = floatCache.getDataBlock(dsOffsets[1], overlapWidth, overlapHeight, &numFloatDataVals);
+                                
+                                if(numRefDataVals != numFloatDataVals)
+                                {
+                                    throw RSGISRegistrationException("The number of data values read from the images does not match.");
+                                }
+                                
+                                metricVal = metric->calcValue(refDataBlock, floatDataBlock, numRefDataVals, overlap->numRefBands);
+                                
+                                imageSimilarity[yIdx][xIdx] = metricVal;
+                            }
 							
 							if(!((boost::math::isnan)(metricVal)))
 							{
@@ -239,14 +291,6 @@ namespace rsgis{namespace reg{
                                     currentRemainderY = remainderY;
 								}
 							}
-							
-							for(unsigned int i = 0; i < overlap->numRefBands; ++i)
-							{
-								delete[] refDataBlock[i];
-								delete[] floatDataBlock[i];
-							}
-							delete[] refDataBlock;
-							delete[] floatDataBlock;
 						}
 					}
 					catch (RSGISRegistrationException &e) 
@@ -409,7 +453,7 @@ namespace rsgis{namespace reg{
 		return distanceMoved;
 	}
     
-    float RSGISImageRegistration::findTiePointLocation(TiePoint *tiePt, unsigned int windowSize, unsigned int searchArea, RSGISImageSimilarityMetric *metric, unsigned int subPixelResolution, float *moveInX, float *moveInY)
+    float RSGISImageRegistration::findTiePointLocation(TiePoint *tiePt, unsigned int windowSize, unsigned int searchArea, RSGISImageSimilarityMetric *metric, unsigned int subPixelResolution, float *moveInX, float *moveInY, GDALDataset *refImg, GDALDataset *floatImg)
 	{
 		float distanceMoved = 0;
 		
@@ -417,8 +461,15 @@ namespace rsgis{namespace reg{
 		{
 			throw RSGISRegistrationException("The overlap needs to be defined before tie location can be defined.");
 		}
+		if(refImg == NULL)
+		{
+			refImg = this->referenceIMG;
+		}
+		if(floatImg == NULL)
+		{
+			floatImg = this->floatingIMG;
+		}
 		
-		rsgis::img::RSGISImageUtils imgUtils;
 		try
 		{
 			// Setup overlapping region variables.
@@ -473,6 +524,35 @@ namespace rsgis{namespace reg{
             float currentRemainderX = 0;
             float currentRemainderY = 0;
 			
+            // Read the region covering the windows for all the shifts once, rather
+            // than reading the images for every shift.
+            RSGISImageWindowCache refCache(refImg);
+            RSGISImageWindowCache floatCache(floatImg);
+            for(int yShift = yShiftStart; yShift <= yShiftEnd; ++yShift)
+            {
+                for(int xShift = xShiftStart; xShift <= xShiftEnd; ++xShift)
+                {
+                    try
+                    {
+                        this->getImageOverlapWithFloatShift((((float)xShift)+tiePt->xShift), (((float)yShift)+tiePt->yShift), dsOffsets, &overlapWidth, &overlapHeight, overlapTransform, env, &remainderX, &remainderY, refImg, floatImg);
+                        if((overlapWidth > 0) & (overlapHeight > 0))
+                        {
+                            refCache.addWindow(dsOffsets[0][0], dsOffsets[0][1], overlapWidth, overlapHeight);
+                            floatCache.addWindow(dsOffsets[1][0], dsOffsets[1][1], overlapWidth, overlapHeight);
+                        }
+                    }
+                    catch (RSGISRegistrationException &e)
+                    {
+                        // Reported when the shift is processed below.
+                    }
+                }
+            }
+            refCache.readWindows();
+            floatCache.readWindows();
+            
+            // Where possible calculate the metric for all the shifts in one go.
+            bool useSurface = this->calcSimilaritySurface(tiePt, env, searchArea, metric, &refCache, &floatCache, imageSimilarity, refImg, floatImg);
+			
 			for(int yShift = yShiftStart; yShift <= yShiftEnd; ++yShift)
 			{
 				xIdx = 0;
@@ -480,24 +560,31 @@ namespace rsgis{namespace reg{
 				{
 					try
 					{
-						this->getImageOverlapWithFloatShift((((float)xShift)+tiePt->xShift), (((float)yShift)+tiePt->yShift), dsOffsets, &overlapWidth, &overlapHeight, overlapTransform, env, &remainderX, &remainderY);
+						this->getImageOverlapWithFloatShift((((float)xShift)+tiePt->xShift), (((float)yShift)+tiePt->yShift), dsOffsets, &overlapWidth, &overlapHeight, overlapTransform, env, &remainderX, &remainderY, refImg, floatImg);
 						
 						if((overlapWidth > 0) & (overlapHeight > 0))
 						{
-							numRefDataVals = 0;
-							numFloatDataVals = 0;
-							
-							refDataBlock = imgUtils.getImageDataBlock(referenceIMG, dsOffsets[0], overlapWidth, overlapHeight, &numRefDataVals);
-							floatDataBlock = imgUtils.getImageDataBlock(floatingIMG, dsOffsets[1], overlapWidth, overlapHeight, &numFloatDataVals);
-							
-							if(numRefDataVals != numFloatDataVals)
-							{
-								throw RSGISRegistrationException("The number of data values read from the images does not match.");
-							}
-							
-							metricVal = metric->calcValue(refDataBlock, floatDataBlock, numRefDataVals, overlap->numRefBands);
-							
-							imageSimilarity[yIdx][xIdx] = metricVal;
+                            if(useSurface)
+                            {
+                                metricVal = imageSimilarity[yIdx][xIdx];
+                            }
+                            else
+                            {
+                                numRefDataVals = 0;
+                                numFloatDataVals = 0;
+                                
+                                refDataBlock = refCache.getDataBlock(dsOffsets[0], overlapWidth, overlapHeight, &numRefDataVals);
+                                floatDataBlock = floatCache.getDataBlock(dsOffsets[1], overlapWidth, overlapHeight, &numFloatDataVals);
+                                
+                                if(numRefDataVals != numFloatDataVals)
+                                {
+                                    throw RSGISRegistrationException("The number of data values read from the images does not match.");
+                                }
+                                
+                                metricVal = metric->calcValue(refDataBlock, floatDataBlock, numRefDataVals, overlap->numRefBands);
+                                
+                                imageSimilarity[yIdx][xIdx] = metricVal;
+                            }
 							
 							if(!((boost::math::isnan)(metricVal)))
 							{
@@ -533,14 +620,6 @@ namespace rsgis{namespace reg{
                                     currentRemainderY = remainderY;
 								}
 							}
-							
-							for(unsigned int i = 0; i < overlap->numRefBands; ++i)
-							{
-								delete[] refDataBlock[i];
-								delete[] floatDataBlock[i];
-							}
-							delete[] refDataBlock;
-							delete[] floatDataBlock;
 						}
 					}
 					catch (RSGISRegistrationException &e)
@@ -686,6 +765,127 @@ namespace rsgis{namespace reg{
 		return distanceMoved;
 	}
 	
+    bool RSGISImageRegistration::calcSimilaritySurface(TiePoint *tiePt, OGREnvelope *env, unsigned int searchArea, RSGISImageSimilarityMetric *metric, RSGISImageWindowCache *refCache, RSGISImageWindowCache *floatCache, float **imageSimilarity, GDALDataset *refImg, GDALDataset *floatImg)
+    {
+        if(overlap->numRefBands != overlap->numFloatBands)
+        {
+            return false;
+        }
+        
+        // The surface can only be used if the reference window is the same for all the
+        // shifts and the floating window moves by one pixel for each shift (i.e., the
+        // windows are not clipped by the edges of the images).
+        unsigned int numSearchPoints = (searchArea*2)+1;
+        int refOffsets[2] = {0, 0};
+        int floatOffsets[2] = {0, 0};
+        int *dsOffsets[2] = {refOffsets, floatOffsets};
+        double overlapTransform[6];
+        int overlapWidth = 0;
+        int overlapHeight = 0;
+        float remainderX = 0;
+        float remainderY = 0;
+        
+        int refXOff = 0;
+        int refYOff = 0;
+        int winWidth = 0;
+        int winHeight = 0;
+        float firstRemainderX = 0;
+        float firstRemainderY = 0;
+        std::vector<int> floatXOffs(numSearchPoints);
+        std::vector<int> floatYOffs(numSearchPoints);
+        
+        int shiftStart = searchArea * (-1);
+        for(unsigned int yIdx = 0; yIdx < numSearchPoints; ++yIdx)
+        {
+            int yShift = shiftStart + ((int)yIdx);
+            for(unsigned int xIdx = 0; xIdx < numSearchPoints; ++xIdx)
+            {
+                int xShift = shiftStart + ((int)xIdx);
+                try
+                {
+                    this->getImageOverlapWithFloatShift((((float)xShift)+tiePt->xShift), (((float)yShift)+tiePt->yShift), dsOffsets, &overlapWidth, &overlapHeight, overlapTransform, env, &remainderX, &remainderY, refImg, floatImg);
+                }
+                catch (RSGISRegistrationException &e)
+                {
+                    return false;
+                }
+                if((overlapWidth <= 0) || (overlapHeight <= 0))
+                {
+                    return false;
+                }
+                
+                if((xIdx == 0) && (yIdx == 0))
+                {
+                    refXOff = refOffsets[0];
+                    refYOff = refOffsets[1];
+                    winWidth = overlapWidth;
+                    winHeight = overlapHeight;
+                    firstRemainderX = remainderX;
+                    firstRemainderY = remainderY;
+                }
+                else if((refOffsets[0] != refXOff) || (refOffsets[1] != refYOff) || (overlapWidth != winWidth) || (overlapHeight != winHeight) || (fabs(remainderX - firstRemainderX) > 0.0001) || (fabs(remainderY - firstRemainderY) > 0.0001))
+                {
+                    return false;
+                }
+                
+                if(yIdx == 0)
+                {
+                    floatXOffs[xIdx] = floatOffsets[0];
+                }
+                if(xIdx == 0)
+                {
+                    floatYOffs[yIdx] = floatOffsets[1];
+                }
+                if((floatOffsets[0] != floatXOffs[xIdx]) || (floatOffsets[1] != floatYOffs[yIdx]))
+                {
+                    return false;
+                }
+            }
+        }
+        
+        for(unsigned int i = 1; i < numSearchPoints; ++i)
+        {
+            if((abs(floatXOffs[i] - floatXOffs[i-1]) != 1) || ((floatXOffs[i] - floatXOffs[i-1]) != (floatXOffs[1] - floatXOffs[0])))
+            {
+                return false;
+            }
+            if((abs(floatYOffs[i] - floatYOffs[i-1]) != 1) || ((floatYOffs[i] - floatYOffs[i-1]) != (floatYOffs[1] - floatYOffs[0])))
+            {
+                return false;
+            }
+        }
+        
+        int floatXMin = *std::min_element(floatXOffs.begin(), floatXOffs.end());
+        int floatYMin = *std::min_element(floatYOffs.begin(), floatYOffs.end());
+        unsigned int regionWidth = winWidth + (numSearchPoints - 1);
+        unsigned int regionHeight = winHeight + (numSearchPoints - 1);
+        
+        unsigned int numRefDataVals = 0;
+        unsigned int numFloatDataVals = 0;
+        refOffsets[0] = refXOff;
+        refOffsets[1] = refYOff;
+        floatOffsets[0] = floatXMin;
+        floatOffsets[1] = floatYMin;
+        float **refDataBlock = refCache->getDataBlock(refOffsets, winWidth, winHeight, &numRefDataVals);
+        float **floatDataBlock = floatCache->getDataBlock(floatOffsets, regionWidth, regionHeight, &numFloatDataVals);
+        
+        std::vector<float> surface(((size_t)numSearchPoints) * numSearchPoints);
+        if(!metric->calcSurface(refDataBlock, winWidth, winHeight, floatDataBlock, regionWidth, regionHeight, overlap->numRefBands, surface.data()))
+        {
+            return false;
+        }
+        
+        for(unsigned int yIdx = 0; yIdx < numSearchPoints; ++yIdx)
+        {
+            for(unsigned int xIdx = 0; xIdx < numSearchPoints; ++xIdx)
+            {
+                imageSimilarity[yIdx][xIdx] = surface[(((size_t)(floatYOffs[yIdx] - floatYMin)) * numSearchPoints) + (floatXOffs[xIdx] - floatXMin)];
+            }
+        }
+        
+        return true;
+    }
+	
 	float RSGISImageRegistration::findExtreme(bool findMin, gsl_vector *coefficients, unsigned int order, float minRange, float maxRange, unsigned int resolution, float *extremeVal)
 	{
 		double division = ((float)1)/((float)resolution);
@@ -1023,24 +1223,32 @@ namespace rsgis{namespace reg{
 		}
 	}
     
-    void RSGISImageRegistration::getImageOverlapWithFloatShift(float xShift, float yShift, int **dsOffsets, int *width, int *height, double *gdalTransform, OGREnvelope *env, float *remainderX, float *remainderY)
+    void RSGISImageRegistration::getImageOverlapWithFloatShift(float xShift, float yShift, int **dsOffsets, int *width, int *height, double *gdalTransform, OGREnvelope *env, float *remainderX, float *remainderY, GDALDataset *refImg, GDALDataset *floatImg)
 	{
 		if(!overlapDefined)
 		{
 			throw RSGISRegistrationException("The overlap needs to be defined.");
 		}
+		if(refImg == NULL)
+		{
+			refImg = this->referenceIMG;
+		}
+		if(floatImg == NULL)
+		{
+			floatImg = this->floatingIMG;
+		}
 		double *refTransform = new double[6];
 		double *floatTransform = new double[6];
 		try 
 		{
 			// Find transformations
-			referenceIMG->GetGeoTransform(refTransform);
-			int refSizeX = referenceIMG->GetRasterXSize();
-			int refSizeY = referenceIMG->GetRasterYSize();
+			refImg->GetGeoTransform(refTransform);
+			int refSizeX = refImg->GetRasterXSize();
+			int refSizeY = refImg->GetRasterYSize();
 			
-			floatingIMG->GetGeoTransform(floatTransform);
-			int floatSizeX = floatingIMG->GetRasterXSize();
-			int floatSizeY = floatingIMG->GetRasterYSize();
+			floatImg->GetGeoTransform(floatTransform);
+			int floatSizeX = floatImg->GetRasterXSize();
+			int floatSizeY = floatImg->GetRasterYSize();
 			
 			// Apply Shift
 			floatTransform[0] += (((float)xShift)*overlap->xRes);
@@ -1486,6 +1694,55 @@ namespace rsgis{namespace reg{
 		outPtsFile.close();
     }
 	
+    unsigned int RSGISImageRegistration::openThreadDatasets(std::vector<GDALDataset*> *refImgs, std::vector<GDALDataset*> *floatImgs)
+    {
+        refImgs->clear();
+        floatImgs->clear();
+        refImgs->push_back(this->referenceIMG);
+        floatImgs->push_back(this->floatingIMG);
+        
+        for(unsigned int i = 1; i < this->numThreads; ++i)
+        {
+            GDALDataset *refImg = (GDALDataset *) GDALOpen(this->referenceIMG->GetDescription(), GA_ReadOnly);
+            GDALDataset *floatImg = (GDALDataset *) GDALOpen(this->floatingIMG->GetDescription(), GA_ReadOnly);
+            if((refImg == NULL) || (floatImg == NULL))
+            {
+                if(refImg != NULL)
+                {
+                    GDALClose(refImg);
+                }
+                if(floatImg != NULL)
+                {
+                    GDALClose(floatImg);
+                }
+                this->closeThreadDatasets(refImgs, floatImgs);
+                refImgs->push_back(this->referenceIMG);
+                floatImgs->push_back(this->floatingIMG);
+                std::cerr << "WARNING: Could not open the images for each thread so the tie points will be matched using a single thread.\n";
+                break;
+            }
+            refImgs->push_back(refImg);
+            floatImgs->push_back(floatImg);
+        }
+        
+        return refImgs->size();
+    }
+    
+    void RSGISImageRegistration::closeThreadDatasets(std::vector<GDALDataset*> *refImgs, std::vector<GDALDataset*> *floatImgs)
+    {
+        // The first datasets are owned by the caller.
+        for(size_t i = 1; i < refImgs->size(); ++i)
+        {
+            GDALClose(refImgs->at(i));
+        }
+        for(size_t i = 1; i < floatImgs->size(); ++i)
+        {
+            GDALClose(floatImgs->at(i));
+        }
+        refImgs->clear();
+        floatImgs->clear();
+    }
+    
 	RSGISImageRegistration::~RSGISImageRegistration()
 	{
 		if(overlap != NULL)
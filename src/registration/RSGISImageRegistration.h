@@ -30,13 +30,17 @@
 #include <string>
 #include <cmath>
 #include <list>
+#include <vector>
+#include <algorithm>
 
 #include "gdal_priv.h"
 #include "ogrsf_frmts.h"
 
 #include "common/RSGISRegistrationException.h"
+#include "common/RSGISThreadPool.h"
 
 #include "registration/RSGISImageSimilarityMetric.h"
+#include "registration/RSGISImageWindowCache.h"
 
 #include "img/RSGISImageBandException.h"
 #include "img/RSGISImageUtils.h"
@@ -135,6 +139,8 @@ namespace rsgis{namespace reg{
 		};
 		
 		RSGISImageRegistration(GDALDataset *reference, GDALDataset *floating);
+		/** Set the number of threads used to match the tie points (0 uses all the available cores). */
+		void setNumThreads(unsigned int numThreads);
 		void runCompleteRegistration();
 		virtual void initRegistration()=0;
 		virtual void executeRegistration()=0;
@@ -147,21 +153,36 @@ namespace rsgis{namespace reg{
 	protected:
 		void findOverlap();
 		void defineFirstTiePoint(unsigned int *startXOff, unsigned int *startYOff, unsigned int numXPts, unsigned int numYPts, unsigned int gap);
-		float findTiePointLocation(TiePoint *tiePt, unsigned int windowSize, unsigned int searchArea, RSGISImageSimilarityMetric *metric, float metricThreshold, unsigned int subPixelResolution, float *moveInX, float *moveInY);
-        float findTiePointLocation(TiePoint *tiePt, unsigned int windowSize, unsigned int searchArea, RSGISImageSimilarityMetric *metric, unsigned int subPixelResolution, float *moveInX, float *moveInY);
+		float findTiePointLocation(TiePoint *tiePt, unsigned int windowSize, unsigned int searchArea, RSGISImageSimilarityMetric *metric, float metricThreshold, unsigned int subPixelResolution, float *moveInX, float *moveInY, GDALDataset *refImg=NULL, GDALDataset *floatImg=NULL);
+        float findTiePointLocation(TiePoint *tiePt, unsigned int windowSize, unsigned int searchArea, RSGISImageSimilarityMetric *metric, unsigned int subPixelResolution, float *moveInX, float *moveInY, GDALDataset *refImg=NULL, GDALDataset *floatImg=NULL);
+        /**
+         * Calculate the metric for all the shifts of the search area in one go using
+         * RSGISImageSimilarityMetric::calcSurface, returning false if the metric does not
+         * support it or the windows are clipped by the image edges for some shifts.
+         */
+        bool calcSimilaritySurface(TiePoint *tiePt, OGREnvelope *env, unsigned int searchArea, RSGISImageSimilarityMetric *metric, RSGISImageWindowCache *refCache, RSGISImageWindowCache *floatCache, float **imageSimilarity, GDALDataset *refImg=NULL, GDALDataset *floatImg=NULL);
 		float findExtreme(bool findMin, gsl_vector *coefficients, unsigned int order, float minRange, float maxRange, unsigned int resolution, float *extremeVal);
         void getImageOverlapFloat(GDALDataset **datasets, int numDS,  float **dsOffsets, int *width, int *height, double *gdalTransform);
-		void getImageOverlapWithFloatShift(float xShift, float yShift, int **dsOffsets, int *width, int *height, double *gdalTransform, OGREnvelope *env, float *remainderX, float *remainderY);
+		void getImageOverlapWithFloatShift(float xShift, float yShift, int **dsOffsets, int *width, int *height, double *gdalTransform, OGREnvelope *env, float *remainderX, float *remainderY, GDALDataset *refImg=NULL, GDALDataset *floatImg=NULL);
 		void removeTiePointsWithLowStdDev(std::list<TiePoint*> *tiePts, unsigned int windowSize, float stdDevRefThreshold, float stdDevFloatThreshold);
 		double calcStdDev(float **data, unsigned int numVals, unsigned int numDims);
 		void exportTiePointsENVIImage2MapImpl(std::string filepath, std::list<TiePoint*> *tiePts);
 		void exportTiePointsENVIImage2ImageImpl(std::string filepath, std::list<TiePoint*> *tiePts);
 		void exportTiePointsRSGISImage2MapImpl(std::string filepath, std::list<TiePoint*> *tiePts);
         void exportTiePointsRSGISMapOffsImpl(std::string filepath, std::list<TiePoint*> *tiePts);
+        /**
+         * Open a read only handle to the reference and floating images for each thread, as GDAL
+         * datasets cannot be read from more than one thread, where the first thread uses referenceIMG
+         * and floatingIMG. Returns the number of threads which can be used (1 if the images cannot
+         * be opened again, e.g., in memory datasets).
+         */
+        unsigned int openThreadDatasets(std::vector<GDALDataset*> *refImgs, std::vector<GDALDataset*> *floatImgs);
+        void closeThreadDatasets(std::vector<GDALDataset*> *refImgs, std::vector<GDALDataset*> *floatImgs);
 		GDALDataset *referenceIMG;
 		GDALDataset *floatingIMG;
 		OverlapRegion* overlap;
 		bool overlapDefined;
+		unsigned int numThreads;
 	};
 }}
 
@@ -49,6 +49,15 @@ namespace rsgis{namespace reg{
 	{
 	public:
 		virtual float calcValue(float **reference, float **floating, unsigned int numVals, unsigned int numDims)=0;
+        /**
+         * Calculate the metric for every position of the reference window (refWidth x refHeight)
+         * within the floating region (floatWidth x floatHeight) in one go, where the value for the
+         * window with the top-left pixel (x, y) of the floating region is written to
+         * surface[(y*((floatWidth-refWidth)+1))+x]. The data are band-major, as for calcValue.
+         * Returns false (the default) if not implemented or the data cannot be used (e.g., it
+         * contains NaN values), in which case calcValue is called for each position.
+         */
+        virtual bool calcSurface(float **reference, unsigned int refWidth, unsigned int refHeight, float **floating, unsigned int floatWidth, unsigned int floatHeight, unsigned int numDims, float *surface){return false;};
 		virtual bool findMin()=0;
 		virtual ~RSGISImageSimilarityMetric(){};
 	};
@@ -0,0 +1,149 @@
+/*
+ *  RSGISImageWindowCache.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib. All rights reserved.
+ *  This file is part of RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISImageWindowCache.h"
+
+namespace rsgis{namespace reg{
+
+    RSGISImageWindowCache::RSGISImageWindowCache(GDALDataset *dataset)
+    {
+        this->dataset = dataset;
+        this->numBands = dataset->GetRasterCount();
+        this->cacheData.resize(this->numBands);
+        this->blockData.resize(this->numBands);
+        this->blockPtrs.resize(this->numBands);
+        this->reset();
+    }
+    
+    void RSGISImageWindowCache::reset()
+    {
+        this->windowsDefined = false;
+        this->dataRead = false;
+        this->cacheXMin = 0;
+        this->cacheYMin = 0;
+        this->cacheXMax = 0;
+        this->cacheYMax = 0;
+    }
+    
+    void RSGISImageWindowCache::addWindow(int xOff, int yOff, unsigned int width, unsigned int height)
+    {
+        if((width == 0) || (height == 0))
+        {
+            return;
+        }
+        if(!this->windowsDefined)
+        {
+            this->cacheXMin = xOff;
+            this->cacheYMin = yOff;
+            this->cacheXMax = xOff + width;
+            this->cacheYMax = yOff + height;
+            this->windowsDefined = true;
+        }
+        else
+        {
+            this->cacheXMin = std::min(this->cacheXMin, xOff);
+            this->cacheYMin = std::min(this->cacheYMin, yOff);
+            this->cacheXMax = std::max(this->cacheXMax, (int)(xOff + width));
+            this->cacheYMax = std::max(this->cacheYMax, (int)(yOff + height));
+        }
+        this->dataRead = false;
+    }
+    
+    void RSGISImageWindowCache::readWindows()
+    {
+        if(!this->windowsDefined)
+        {
+            return;
+        }
+        
+        // Only read the part of the region within the image; windows outside
+        // of the image are read directly by getDataBlock.
+        this->cacheXMin = std::max(this->cacheXMin, 0);
+        this->cacheYMin = std::max(this->cacheYMin, 0);
+        this->cacheXMax = std::min(this->cacheXMax, this->dataset->GetRasterXSize());
+        this->cacheYMax = std::min(this->cacheYMax, this->dataset->GetRasterYSize());
+        if((this->cacheXMax <= this->cacheXMin) || (this->cacheYMax <= this->cacheYMin))
+        {
+            this->windowsDefined = false;
+            return;
+        }
+        
+        unsigned int cacheWidth = this->cacheXMax - this->cacheXMin;
+        unsigned int cacheHeight = this->cacheYMax - this->cacheYMin;
+        for(unsigned int n = 0; n < this->numBands; ++n)
+        {
+            this->cacheData[n].resize(((size_t)cacheWidth)*cacheHeight);
+            if(this->dataset->GetRasterBand(n+1)->RasterIO(GF_Read, this->cacheXMin, this->cacheYMin, cacheWidth, cacheHeight, this->cacheData[n].data(), cacheWidth, cacheHeight, GDT_Float32, 0, 0) != CE_None)
+            {
+                throw rsgis::RSGISRegistrationException("Could not read the tie point search region from the image.");
+            }
+        }
+        this->dataRead = true;
+    }
+    
+    float** RSGISImageWindowCache::getDataBlock(int *dsOffsets, unsigned int width, unsigned int height, unsigned int *numVals)
+    {
+        *numVals = width*height;
+        for(unsigned int n = 0; n < this->numBands; ++n)
+        {
+            if(this->blockData[n].size() < *numVals)
+            {
+                this->blockData[n].resize(*numVals);
+            }
+            this->blockPtrs[n] = this->blockData[n].data();
+        }
+        
+        bool inCache = this->dataRead && (dsOffsets[0] >= this->cacheXMin) && (dsOffsets[1] >= this->cacheYMin) && ((dsOffsets[0] + ((int)width)) <= this->cacheXMax) && ((dsOffsets[1] + ((int)height)) <= this->cacheYMax);
+        
+        if(inCache)
+        {
+            size_t cacheWidth = this->cacheXMax - this->cacheXMin;
+            for(unsigned int n = 0; n < this->numBands; ++n)
+            {
+                const float *cacheRow = this->cacheData[n].data() + (((size_t)(dsOffsets[1] - this->cacheYMin)) * cacheWidth) + (dsOffsets[0] - this->cacheXMin);
+                float *blockRow = this->blockPtrs[n];
+                for(unsigned int i = 0; i < height; ++i)
+                {
+                    std::copy(cacheRow, cacheRow + width, blockRow);
+                    cacheRow += cacheWidth;
+                    blockRow += width;
+                }
+            }
+        }
+        else
+        {
+            for(unsigned int n = 0; n < this->numBands; ++n)
+            {
+                this->dataset->GetRasterBand(n+1)->RasterIO(GF_Read, dsOffsets[0], dsOffsets[1], width, height, this->blockPtrs[n], width, height, GDT_Float32, 0, 0);
+            }
+        }
+        
+        return this->blockPtrs.data();
+    }
+    
+    RSGISImageWindowCache::~RSGISImageWindowCache()
+    {
+        
+    }
+    
+}}
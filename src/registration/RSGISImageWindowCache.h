@@ -0,0 +1,92 @@
+/*
+ *  RSGISImageWindowCache.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib. All rights reserved.
+ *  This file is part of RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISImageWindowCache_H
+#define RSGISImageWindowCache_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISRegistrationException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_registration_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace reg{
+
+    /**
+     * Holds a region of an image in memory so the windows of a tie point search
+     * (i.e., one window for each shift) can be extracted without reading the image
+     * for every shift. The windows are added with addWindow, the region covering
+     * all of them is read with readWindows and then getDataBlock returns the same
+     * band-major data as RSGISImageUtils::getImageDataBlock for each window.
+     */
+    class DllExport RSGISImageWindowCache
+    {
+    public:
+        RSGISImageWindowCache(GDALDataset *dataset);
+        /** Remove the windows (and data) so the cache can be used for the next tie point. */
+        void reset();
+        /** Add a window (in pixels) which will be requested from getDataBlock. */
+        void addWindow(int xOff, int yOff, unsigned int width, unsigned int height);
+        /** Read the region of the image covering all the windows which have been added. */
+        void readWindows();
+        /**
+         * Get the data for a window, where dsOffsets is the x and y pixel offset. The
+         * returned data (data[band][(y*width)+x]) is owned by the cache and is valid
+         * until the next call. Windows outside of the cached region are read from the image.
+         */
+        float** getDataBlock(int *dsOffsets, unsigned int width, unsigned int height, unsigned int *numVals);
+        ~RSGISImageWindowCache();
+    protected:
+        GDALDataset *dataset;
+        unsigned int numBands;
+        bool windowsDefined;
+        bool dataRead;
+        int cacheXMin;
+        int cacheYMin;
+        int cacheXMax;
+        int cacheYMax;
+        std::vector<std::vector<float> > cacheData;
+        std::vector<std::vector<float> > blockData;
+        std::vector<float*> blockPtrs;
+    };
+
+}}
+
+#endif
+
@@ -0,0 +1,285 @@
+/*
+ *  RSGISSimilaritySurface.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib. All rights reserved.
+ *  This file is part of RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISSimilaritySurface.h"
+
+namespace rsgis{namespace reg{
+
+    RSGISSimilaritySurfaceSums::RSGISSimilaritySurfaceSums()
+    {
+        this->surfaceWidth = 0;
+        this->surfaceHeight = 0;
+        this->n = 0;
+        this->sumR = 0;
+        this->sumRSq = 0;
+    }
+    
+    double RSGISSimilaritySurfaceSums::calcMean(float **data, unsigned int numVals, unsigned int numDims)
+    {
+        double sum = 0;
+        for(unsigned int i = 0; i < numDims; ++i)
+        {
+            for(unsigned int j = 0; j < numVals; ++j)
+            {
+                sum += data[i][j];
+            }
+        }
+        return sum / (((double)numVals) * numDims);
+    }
+    
+    bool RSGISSimilaritySurfaceSums::calcSums(float **reference, unsigned int refWidth, unsigned int refHeight, float **floating, unsigned int floatWidth, unsigned int floatHeight, unsigned int numDims, double refShift, double floatShift)
+    {
+        if((refWidth == 0) || (refHeight == 0) || (floatWidth < refWidth) || (floatHeight < refHeight) || (numDims == 0))
+        {
+            return false;
+        }
+        this->surfaceWidth = (floatWidth - refWidth) + 1;
+        this->surfaceHeight = (floatHeight - refHeight) + 1;
+        size_t numSurfaceVals = ((size_t)this->surfaceWidth) * this->surfaceHeight;
+        
+        // Copy the shifted values, checking for NaNs.
+        size_t numRefVals = ((size_t)refWidth) * refHeight;
+        size_t numFloatVals = ((size_t)floatWidth) * floatHeight;
+        std::vector<std::vector<double> > refVals(numDims, std::vector<double>(numRefVals));
+        std::vector<std::vector<double> > floatVals(numDims, std::vector<double>(numFloatVals));
+        this->n = ((double)numRefVals) * numDims;
+        this->sumR = 0;
+        this->sumRSq = 0;
+        for(unsigned int b = 0; b < numDims; ++b)
+        {
+            for(size_t i = 0; i < numRefVals; ++i)
+            {
+                if((boost::math::isnan)(reference[b][i]))
+                {
+                    return false;
+                }
+                refVals[b][i] = reference[b][i] - refShift;
+                this->sumR += refVals[b][i];
+                this->sumRSq += refVals[b][i] * refVals[b][i];
+            }
+            for(size_t i = 0; i < numFloatVals; ++i)
+            {
+                if((boost::math::isnan)(floating[b][i]))
+                {
+                    return false;
+                }
+                floatVals[b][i] = floating[b][i] - floatShift;
+            }
+        }
+        
+        // Integral images of the floating values and squared values (summed over the bands).
+        size_t intWidth = floatWidth + 1;
+        std::vector<double> intSum(intWidth * (floatHeight + 1), 0.0);
+        std::vector<double> intSumSq(intWidth * (floatHeight + 1), 0.0);
+        for(unsigned int y = 0; y < floatHeight; ++y)
+        {
+            double rowSum = 0;
+            double rowSumSq = 0;
+            for(unsigned int x = 0; x < floatWidth; ++x)
+            {
+                for(unsigned int b = 0; b < numDims; ++b)
+                {
+                    double val = floatVals[b][(((size_t)y) * floatWidth) + x];
+                    rowSum += val;
+                    rowSumSq += val * val;
+                }
+                intSum[((y + 1) * intWidth) + (x + 1)] = intSum[(y * intWidth) + (x + 1)] + rowSum;
+                intSumSq[((y + 1) * intWidth) + (x + 1)] = intSumSq[(y * intWidth) + (x + 1)] + rowSumSq;
+            }
+        }
+        
+        this->sumF.resize(numSurfaceVals);
+        this->sumFSq.resize(numSurfaceVals);
+        for(unsigned int y = 0; y < this->surfaceHeight; ++y)
+        {
+            for(unsigned int x = 0; x < this->surfaceWidth; ++x)
+            {
+                size_t tl = (y * intWidth) + x;
+                size_t tr = tl + refWidth;
+                size_t bl = ((y + refHeight) * intWidth) + x;
+                size_t br = bl + refWidth;
+                size_t idx = (((size_t)y) * this->surfaceWidth) + x;
+                this->sumF[idx] = (intSum[br] - intSum[bl]) - (intSum[tr] - intSum[tl]);
+                this->sumFSq[idx] = (intSumSq[br] - intSumSq[bl]) - (intSumSq[tr] - intSumSq[tl]);
+            }
+        }
+        
+        // Use the FFT if summing the window at each position would be slower.
+        unsigned int fftXSize = findFFTSize(floatWidth);
+        unsigned int fftYSize = findFFTSize(floatHeight);
+        double fftSize = ((double)fftXSize) * fftYSize;
+        double directCost = ((double)numRefVals) * numSurfaceVals * numDims;
+        double fftCost = 5.0 * ((2.0 * numDims) + 1.0) * fftSize * std::log2(fftSize + 1.0);
+        if(directCost > fftCost)
+        {
+            this->calcCrossCorrelationFFT(refVals, floatVals, refWidth, refHeight, floatWidth, floatHeight);
+        }
+        else
+        {
+            this->calcCrossCorrelationDirect(refVals, floatVals, refWidth, refHeight, floatWidth);
+        }
+        
+        return true;
+    }
+    
+    void RSGISSimilaritySurfaceSums::calcCrossCorrelationDirect(const std::vector<std::vector<double> > &refVals, const std::vector<std::vector<double> > &floatVals, unsigned int refWidth, unsigned int refHeight, unsigned int floatWidth)
+    {
+        this->sumRF.assign(((size_t)this->surfaceWidth) * this->surfaceHeight, 0.0);
+        for(unsigned int b = 0; b < refVals.size(); ++b)
+        {
+            const double *ref = refVals[b].data();
+            const double *flt = floatVals[b].data();
+            for(unsigned int y = 0; y < this->surfaceHeight; ++y)
+            {
+                for(unsigned int x = 0; x < this->surfaceWidth; ++x)
+                {
+                    double sum = 0;
+                    for(unsigned int j = 0; j < refHeight; ++j)
+                    {
+                        const double *refRow = ref + (((size_t)j) * refWidth);
+                        const double *fltRow = flt + ((((size_t)(y + j)) * floatWidth) + x);
+                        for(unsigned int i = 0; i < refWidth; ++i)
+                        {
+                            sum += refRow[i] * fltRow[i];
+                        }
+                    }
+                    this->sumRF[(((size_t)y) * this->surfaceWidth) + x] += sum;
+                }
+            }
+        }
+    }
+    
+    void RSGISSimilaritySurfaceSums::calcCrossCorrelationFFT(const std::vector<std::vector<double> > &refVals, const std::vector<std::vector<double> > &floatVals, unsigned int refWidth, unsigned int refHeight, unsigned int floatWidth, unsigned int floatHeight)
+    {
+        // The positions of the surface do not wrap around the FFT so no extra padding is needed.
+        unsigned int xSize = findFFTSize(floatWidth);
+        unsigned int ySize = findFFTSize(floatHeight);
+        size_t fftSize = ((size_t)xSize) * ySize;
+        
+        gsl_fft_complex_wavetable *xWavetable = gsl_fft_complex_wavetable_alloc(xSize);
+        gsl_fft_complex_workspace *xWorkspace = gsl_fft_complex_workspace_alloc(xSize);
+        gsl_fft_complex_wavetable *yWavetable = gsl_fft_complex_wavetable_alloc(ySize);
+        gsl_fft_complex_workspace *yWorkspace = gsl_fft_complex_workspace_alloc(ySize);
+        
+        std::vector<double> refFFT(fftSize * 2);
+        std::vector<double> floatFFT(fftSize * 2);
+        std::vector<double> sumFFT(fftSize * 2, 0.0);
+        for(unsigned int b = 0; b < refVals.size(); ++b)
+        {
+            std::fill(refFFT.begin(), refFFT.end(), 0.0);
+            std::fill(floatFFT.begin(), floatFFT.end(), 0.0);
+            for(unsigned int y = 0; y < refHeight; ++y)
+            {
+                for(unsigned int x = 0; x < refWidth; ++x)
+                {
+                    refFFT[((((size_t)y) * xSize) + x) * 2] = refVals[b][(((size_t)y) * refWidth) + x];
+                }
+            }
+            for(unsigned int y = 0; y < floatHeight; ++y)
+            {
+                for(unsigned int x = 0; x < floatWidth; ++x)
+                {
+                    floatFFT[((((size_t)y) * xSize) + x) * 2] = floatVals[b][(((size_t)y) * floatWidth) + x];
+                }
+            }
+            this->fft2D(refFFT.data(), xSize, ySize, xWavetable, xWorkspace, yWavetable, yWorkspace, false);
+            this->fft2D(floatFFT.data(), xSize, ySize, xWavetable, xWorkspace, yWavetable, yWorkspace, false);
+            
+            // The cross-correlation is the inverse of the floating FFT multiplied by
+            // the complex conjugate of the reference FFT, which is summed over the bands.
+            for(size_t i = 0; i < fftSize; ++i)
+            {
+                double rRe = refFFT[i*2];
+                double rIm = refFFT[(i*2)+1];
+                double fRe = floatFFT[i*2];
+                double fIm = floatFFT[(i*2)+1];
+                sumFFT[i*2] += (fRe * rRe) + (fIm * rIm);
+                sumFFT[(i*2)+1] += (fIm * rRe) - (fRe * rIm);
+            }
+        }
+        this->fft2D(sumFFT.data(), xSize, ySize, xWavetable, xWorkspace, yWavetable, yWorkspace, true);
+        
+        this->sumRF.resize(((size_t)this->surfaceWidth) * this->surfaceHeight);
+        for(unsigned int y = 0; y < this->surfaceHeight; ++y)
+        {
+            for(unsigned int x = 0; x < this->surfaceWidth; ++x)
+            {
+                this->sumRF[(((size_t)y) * this->surfaceWidth) + x] = sumFFT[((((size_t)y) * xSize) + x) * 2];
+            }
+        }
+        
+        gsl_fft_complex_wavetable_free(xWavetable);
+        gsl_fft_complex_workspace_free(xWorkspace);
+        gsl_fft_complex_wavetable_free(yWavetable);
+        gsl_fft_complex_workspace_free(yWorkspace);
+    }
+    
+    void RSGISSimilaritySurfaceSums::fft2D(double *data, unsigned int xSize, unsigned int ySize, gsl_fft_complex_wavetable *xWavetable, gsl_fft_complex_workspace *xWorkspace, gsl_fft_complex_wavetable *yWavetable, gsl_fft_complex_workspace *yWorkspace, bool inverse)
+    {
+        // Transform the rows and then the columns (where the stride is the row length).
+        for(unsigned int y = 0; y < ySize; ++y)
+        {
+            double *row = data + (((size_t)y) * xSize * 2);
+            if(inverse)
+            {
+                gsl_fft_complex_inverse(row, 1, xSize, xWavetable, xWorkspace);
+            }
+            else
+            {
+                gsl_fft_complex_forward(row, 1, xSize, xWavetable, xWorkspace);
+            }
+        }
+        for(unsigned int x = 0; x < xSize; ++x)
+        {
+            double *col = data + (((size_t)x) * 2);
+            if(inverse)
+            {
+                gsl_fft_complex_inverse(col, xSize, ySize, yWavetable, yWorkspace);
+            }
+            else
+            {
+                gsl_fft_complex_forward(col, xSize, ySize, yWavetable, yWorkspace);
+            }
+        }
+    }
+    
+    unsigned int RSGISSimilaritySurfaceSums::findFFTSize(unsigned int minSize)
+    {
+        // Find the smallest size with only factors of 2, 3 and 5, which GSL
+        // transforms efficiently.
+        unsigned int size = std::max(minSize, (unsigned int)1);
+        while(true)
+        {
+            unsigned int val = size;
+            while((val % 2) == 0){val /= 2;}
+            while((val % 3) == 0){val /= 3;}
+            while((val % 5) == 0){val /= 5;}
+            if(val == 1)
+            {
+                return size;
+            }
+            ++size;
+        }
+    }
+    
+}}
@@ -0,0 +1,105 @@
+/*
+ *  RSGISSimilaritySurface.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib. All rights reserved.
+ *  This file is part of RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISSimilaritySurface_H
+#define RSGISSimilaritySurface_H
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "boost/math/special_functions/fpclassify.hpp"
+
+#include <gsl/gsl_fft_complex.h>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_registration_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace reg{
+
+    /**
+     * Calculates the sums needed by the similarity metrics for every position of a
+     * reference window within a larger floating region (i.e., all the shifts of a
+     * tie point search) in one go. The sums of the floating values and squared values
+     * for each position are found from integral images and the sum of the products
+     * of the reference and floating values is a cross-correlation, which is found
+     * with an FFT when that is quicker than summing the window at each position.
+     * The data are band-major (data[band][(y*width)+x]) and all the bands are summed
+     * together, as in RSGISImageSimilarityMetric::calcValue. The surface position
+     * (x, y) is the floating window with the top-left pixel (x, y) of the floating region.
+     */
+    class DllExport RSGISSimilaritySurfaceSums
+    {
+    public:
+        RSGISSimilaritySurfaceSums();
+        /**
+         * Calculate the sums, returning false if the data contains NaN values (which
+         * the metrics ignore, so the number of values would differ between positions).
+         * The refShift is subtracted from the reference values and floatShift from the
+         * floating values before the sums are calculated to reduce the loss of precision.
+         */
+        bool calcSums(float **reference, unsigned int refWidth, unsigned int refHeight, float **floating, unsigned int floatWidth, unsigned int floatHeight, unsigned int numDims, double refShift, double floatShift);
+        /** The mean of all the values (over all bands), which is NaN if there is a NaN value. */
+        static double calcMean(float **data, unsigned int numVals, unsigned int numDims);
+        unsigned int getSurfaceWidth(){return this->surfaceWidth;};
+        unsigned int getSurfaceHeight(){return this->surfaceHeight;};
+        /** The number of values within the window (over all bands). */
+        double getN(){return this->n;};
+        double getSumR(){return this->sumR;};
+        double getSumRSq(){return this->sumRSq;};
+        const std::vector<double>& getSumF(){return this->sumF;};
+        const std::vector<double>& getSumFSq(){return this->sumFSq;};
+        const std::vector<double>& getSumRF(){return this->sumRF;};
+        /** In place 2D complex FFT of interleaved (re, im) row-major data (the inverse is scaled by 1/(xSize*ySize)). */
+        static void fft2D(double *data, unsigned int xSize, unsigned int ySize, gsl_fft_complex_wavetable *xWavetable, gsl_fft_complex_workspace *xWorkspace, gsl_fft_complex_wavetable *yWavetable, gsl_fft_complex_workspace *yWorkspace, bool inverse);
+        /** The smallest size of at least minSize with only factors of 2, 3 and 5. */
+        static unsigned int findFFTSize(unsigned int minSize);
+        ~RSGISSimilaritySurfaceSums(){};
+    protected:
+        void calcCrossCorrelationDirect(const std::vector<std::vector<double> > &refVals, const std::vector<std::vector<double> > &floatVals, unsigned int refWidth, unsigned int refHeight, unsigned int floatWidth);
+        void calcCrossCorrelationFFT(const std::vector<std::vector<double> > &refVals, const std::vector<std::vector<double> > &floatVals, unsigned int refWidth, unsigned int refHeight, unsigned int floatWidth, unsigned int floatHeight);
+        unsigned int surfaceWidth;
+        unsigned int surfaceHeight;
+        double n;
+        double sumR;
+        double sumRSq;
+        std::vector<double> sumF;
+        std::vector<double> sumFSq;
+        std::vector<double> sumRF;
+    };
+
+}}
+
+#endif
+
@@ -150,50 +150,78 @@ namespace rsgis{namespace reg{
 			throw RSGISRegistrationException("The algorithm needs to be initialised before being executed.");
 		}
 		
-		unsigned int counter = 0;
-		unsigned int feedback = 0;
+		size_t counter = 0;
+		size_t feedback = 0;
+		size_t nextFeedback = 0;
 		unsigned int feedbackVal = 0;
 		bool giveFeedback = false;
 		if(tiePoints->size() > 10)
 		{
 			feedback = tiePoints->size()/10;
 			giveFeedback = true;
-		}		
+		}
 		
-		float xShift = 0;
-		float yShift = 0;
 		double totalMovement = 0;
 		double averageMovement = 0;
-		
-		double distance = 0;
-		double invDist = 0;
-		float xShiftDiff = 0;
-		float yShiftDiff = 0;
 		bool first = true;
 		float prevAverage = 0;
 		
-		std::list<TiePointInSingleLayer*>::iterator iterTiePts;
+		// Matching a tie point moves the tie points connected to it, so to get the same
+		// result as matching the tie points in order they are grouped into levels, where
+		// a tie point is placed in the level after any earlier tie point which shares a
+		// connected tie point (or itself) with it. The tie points within a level do not
+		// affect each other so are matched in parallel and the levels are processed in order.
+		std::vector<TiePointInSingleLayer*> tiePtsVec(tiePoints->begin(), tiePoints->end());
+		size_t numTiePts = tiePtsVec.size();
+		std::vector<std::vector<size_t> > levels;
+		std::map<TiePoint*, size_t> nextLevel;
 		std::list<TiePoint*>::iterator iterNrTiePts;
-            
-        
-		for(unsigned int i = 0; i < maxNumIterations; ++i)
+		for(size_t n = 0; n < numTiePts; ++n)
+		{
+			size_t level = nextLevel[tiePtsVec[n]->tiePt];
+			for(iterNrTiePts = tiePtsVec[n]->nrTiePts->begin(); iterNrTiePts != tiePtsVec[n]->nrTiePts->end(); ++iterNrTiePts)
+			{
+				level = std::max(level, nextLevel[*iterNrTiePts]);
+			}
+			if(level == levels.size())
+			{
+				levels.push_back(std::vector<size_t>());
+			}
+			levels[level].push_back(n);
+			
+			nextLevel[tiePtsVec[n]->tiePt] = level + 1;
+			for(iterNrTiePts = tiePtsVec[n]->nrTiePts->begin(); iterNrTiePts != tiePtsVec[n]->nrTiePts->end(); ++iterNrTiePts)
+			{
+				nextLevel[*iterNrTiePts] = level + 1;
+			}
+		}
+		nextLevel.clear();
+		
+		std::vector<GDALDataset*> refImgs;
+		std::vector<GDALDataset*> floatImgs;
+		unsigned int nThreads = this->openThreadDatasets(&refImgs, &floatImgs);
+		rsgis::RSGISThreadPool threadPool(nThreads);
+		std::vector<float> movement(numTiePts, 0);
+		const std::vector<size_t> *levelTiePts = NULL;
+		
+		auto matchTiePts = [&](unsigned int t, size_t s, size_t e)
 		{
-			std::cout << "Started (Iteration " << i << ")." << std::flush;
-			totalMovement = 0;
-			counter = 0;
-			feedbackVal = 0;
-			for(iterTiePts = tiePoints->begin(); iterTiePts != tiePoints->end(); ++iterTiePts)
+			float xShift = 0;
+			float yShift = 0;
+			double distance = 0;
+			double invDist = 0;
+			float xShiftDiff = 0;
+			float yShiftDiff = 0;
+			std::list<TiePoint*>::iterator iterNrTiePt;
+			for(size_t k = s; k < e; ++k)
 			{
-				if(giveFeedback && ((counter % feedback) == 0))
+				size_t n = levelTiePts->at(k);
+				TiePointInSingleLayer *tiePtInLayer = tiePtsVec[n];
+				movement[n] = this->findTiePointLocation(tiePtInLayer->tiePt, windowSize, searchArea, metric, metricThreshold, subPixelResolution, &xShift, &yShift, refImgs[t], floatImgs[t]);
+				
+				for(iterNrTiePt = tiePtInLayer->nrTiePts->begin(); iterNrTiePt != tiePtInLayer->nrTiePts->end(); ++iterNrTiePt)
 				{
-					std::cout << "." << feedbackVal << "." << std::flush;
-					feedbackVal += 10;
-				}
-                totalMovement += this->findTiePointLocation((*iterTiePts)->tiePt, windowSize, searchArea, metric, metricThreshold, subPixelResolution, &xShift, &yShift);
-
-                for(iterNrTiePts = (*iterTiePts)->nrTiePts->begin(); iterNrTiePts != (*iterTiePts)->nrTiePts->end(); ++iterNrTiePts)
-                {
-					distance = (*iterTiePts)->tiePt->floatDistance((*iterNrTiePts));
+					distance = tiePtInLayer->tiePt->floatDistance((*iterNrTiePt));
 					if(distance < 1)
 					{
 						invDist = 1;
@@ -203,34 +231,66 @@ namespace rsgis{namespace reg{
 						invDist = 1/(distance*pSmoothness);
 					}
 					
-					xShiftDiff = xShift - (*iterNrTiePts)->xShift;
-					yShiftDiff = yShift - (*iterNrTiePts)->yShift;
+					xShiftDiff = xShift - (*iterNrTiePt)->xShift;
+					yShiftDiff = yShift - (*iterNrTiePt)->yShift;
 					
-					(*iterNrTiePts)->xShift += invDist*xShiftDiff;
-					(*iterNrTiePts)->yShift += invDist*yShiftDiff;
+					(*iterNrTiePt)->xShift += invDist*xShiftDiff;
+					(*iterNrTiePt)->yShift += invDist*yShiftDiff;
 				}
-				++counter;
 			}
-			averageMovement = totalMovement/tiePoints->size();
-			std::cout << ". Complete - Movement = "<< averageMovement << std::endl;
-			if(first)
-			{
-				prevAverage = averageMovement;
-				first = false;
-			}
-			else
+		};
+		
+		try
+		{
+			for(unsigned int i = 0; i < maxNumIterations; ++i)
 			{
-				float moveDiff = sqrt(((averageMovement - prevAverage)*(averageMovement - prevAverage)));
-				if(moveDiff < moveChangeThreshold)
+				std::cout << "Started (Iteration " << i << ")." << std::flush;
+				totalMovement = 0;
+				counter = 0;
+				nextFeedback = 0;
+				feedbackVal = 0;
+				for(size_t l = 0; l < levels.size(); ++l)
 				{
-					break;
+					while(giveFeedback && (counter >= nextFeedback))
+					{
+						std::cout << "." << feedbackVal << "." << std::flush;
+						feedbackVal += 10;
+						nextFeedback += feedback;
+					}
+					levelTiePts = &levels[l];
+					threadPool.parallelFor(0, levelTiePts->size(), matchTiePts);
+					counter += levelTiePts->size();
+				}
+				
+				// Sum the movement in the original order so the result does not depend on the number of threads.
+				for(size_t n = 0; n < numTiePts; ++n)
+				{
+					totalMovement += movement[n];
+				}
+				averageMovement = totalMovement/tiePoints->size();
+				std::cout << ". Complete - Movement = "<< averageMovement << std::endl;
+				if(first)
+				{
+					prevAverage = averageMovement;
+					first = false;
+				}
+				else
+				{
+					float moveDiff = sqrt(((averageMovement - prevAverage)*(averageMovement - prevAverage)));
+					if(moveDiff < moveChangeThreshold)
+					{
+						break;
+					}
+					prevAverage = averageMovement;
 				}
-				prevAverage = averageMovement;
 			}
 		}
-		
-		
-		
+		catch(RSGISRegistrationException &e)
+		{
+			this->closeThreadDatasets(&refImgs, &floatImgs);
+			throw e;
+		}
+		this->closeThreadDatasets(&refImgs, &floatImgs);
 	}
 	
 	void RSGISSingleConnectLayerImageRegistration::finaliseRegistration()
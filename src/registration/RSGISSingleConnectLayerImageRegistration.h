@@ -30,6 +30,9 @@
 #include <string>
 #include <cmath>
 #include <list>
+#include <vector>
+#include <map>
+#include <algorithm>
 
 #include "gdal_priv.h"
 #include "ogrsf_frmts.h"
@@ -48,6 +48,30 @@ namespace rsgis{namespace reg{
 		return sqrt(sqDiff/totalNumVals);
 	}
 	
+    bool RSGISEuclideanSimilarityMetric::calcSurface(float **reference, unsigned int refWidth, unsigned int refHeight, float **floating, unsigned int floatWidth, unsigned int floatHeight, unsigned int numDims, float *surface)
+    {
+        // The squared difference is not changed by subtracting the same value from both images.
+        double shift = RSGISSimilaritySurfaceSums::calcMean(reference, refWidth*refHeight, numDims);
+        RSGISSimilaritySurfaceSums sums;
+        if(!sums.calcSums(reference, refWidth, refHeight, floating, floatWidth, floatHeight, numDims, shift, shift))
+        {
+            return false;
+        }
+        const std::vector<double> &sumFSq = sums.getSumFSq();
+        const std::vector<double> &sumRF = sums.getSumRF();
+        size_t numSurfaceVals = ((size_t)sums.getSurfaceWidth()) * sums.getSurfaceHeight();
+        for(size_t i = 0; i < numSurfaceVals; ++i)
+        {
+            double sqDiff = (sums.getSumRSq() - (2 * sumRF[i])) + sumFSq[i];
+            if(sqDiff < 0)
+            {
+                sqDiff = 0;
+            }
+            surface[i] = sqrt(sqDiff/sums.getN());
+        }
+        return true;
+    }
+	
 	float RSGISSquaredDifferenceSimilarityMetric::calcValue(float **reference, float **floating, unsigned int numVals, unsigned int numDims)
 	{
 		unsigned int totalNumVals = 0;
@@ -69,6 +93,30 @@ namespace rsgis{namespace reg{
 		return sqDiff/totalNumVals;
 	}
 	
+    bool RSGISSquaredDifferenceSimilarityMetric::calcSurface(float **reference, unsigned int refWidth, unsigned int refHeight, float **floating, unsigned int floatWidth, unsigned int floatHeight, unsigned int numDims, float *surface)
+    {
+        // The squared difference is not changed by subtracting the same value from both images.
+        double shift = RSGISSimilaritySurfaceSums::calcMean(reference, refWidth*refHeight, numDims);
+        RSGISSimilaritySurfaceSums sums;
+        if(!sums.calcSums(reference, refWidth, refHeight, floating, floatWidth, floatHeight, numDims, shift, shift))
+        {
+            return false;
+        }
+        const std::vector<double> &sumFSq = sums.getSumFSq();
+        const std::vector<double> &sumRF = sums.getSumRF();
+        size_t numSurfaceVals = ((size_t)sums.getSurfaceWidth()) * sums.getSurfaceHeight();
+        for(size_t i = 0; i < numSurfaceVals; ++i)
+        {
+            double sqDiff = (sums.getSumRSq() - (2 * sumRF[i])) + sumFSq[i];
+            if(sqDiff < 0)
+            {
+                sqDiff = 0;
+            }
+            surface[i] = sqDiff/sums.getN();
+        }
+        return true;
+    }
+	
 	float RSGISManhattanSimilarityMetric::calcValue(float **reference, float **floating, unsigned int numVals, unsigned int numDims)
 	{
 		unsigned int totalNumVals = 0;
@@ -125,6 +173,42 @@ namespace rsgis{namespace reg{
 		
 		return val;
 	}
+	
+    bool RSGISCorrelationSimilarityMetric::calcSurface(float **reference, unsigned int refWidth, unsigned int refHeight, float **floating, unsigned int floatWidth, unsigned int floatHeight, unsigned int numDims, float *surface)
+    {
+        // The correlation is not changed by subtracting a value from either image.
+        double refShift = RSGISSimilaritySurfaceSums::calcMean(reference, refWidth*refHeight, numDims);
+        double floatShift = RSGISSimilaritySurfaceSums::calcMean(floating, floatWidth*floatHeight, numDims);
+        RSGISSimilaritySurfaceSums sums;
+        if(!sums.calcSums(reference, refWidth, refHeight, floating, floatWidth, floatHeight, numDims, refShift, floatShift))
+        {
+            return false;
+        }
+        const std::vector<double> &sumF = sums.getSumF();
+        const std::vector<double> &sumFSq = sums.getSumFSq();
+        const std::vector<double> &sumRF = sums.getSumRF();
+        double n = sums.getN();
+        double sumR = sums.getSumR();
+        double refVar = (n*sums.getSumRSq())-(sumR*sumR);
+        size_t numSurfaceVals = ((size_t)sums.getSurfaceWidth()) * sums.getSurfaceHeight();
+        for(size_t i = 0; i < numSurfaceVals; ++i)
+        {
+            double floatVar = (n*sumFSq[i])-(sumF[i]*sumF[i]);
+            // A window with a constant value has no correlation (as calcValue, which divides by 0)
+            // but rounding errors in the sums must not give a very small variance.
+            if(floatVar <= (1e-10 * n * sumFSq[i]))
+            {
+                floatVar = 0;
+            }
+            float val = (((n * sumRF[i]) - (sumR * sumF[i]))/sqrt(refVar*floatVar));
+            if(val < 0)
+            {
+                val *= -1;
+            }
+            surface[i] = val;
+        }
+        return true;
+    }
 
 
 
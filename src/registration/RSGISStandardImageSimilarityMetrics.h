@@ -30,6 +30,7 @@
 #include "math/RSGISMathException.h"
 
 #include "registration/RSGISImageSimilarityMetric.h"
+#include "registration/RSGISSimilaritySurface.h"
 
 #include "boost/math/special_functions/fpclassify.hpp"
 
@@ -53,6 +54,7 @@ namespace rsgis{namespace reg{
 	public:
 		RSGISEuclideanSimilarityMetric(){};
 		float calcValue(float **reference, float **floating, unsigned int numVals, unsigned int numDims);
+        bool calcSurface(float **reference, unsigned int refWidth, unsigned int refHeight, float **floating, unsigned int floatWidth, unsigned int floatHeight, unsigned int numDims, float *surface);
 		bool findMin(){return true;};
 		~RSGISEuclideanSimilarityMetric(){};
 	};
@@ -71,6 +73,7 @@ namespace rsgis{namespace reg{
 	public:
 		RSGISSquaredDifferenceSimilarityMetric(){};
 		float calcValue(float **reference, float **floating, unsigned int numVals, unsigned int numDims);
+        bool calcSurface(float **reference, unsigned int refWidth, unsigned int refHeight, float **floating, unsigned int floatWidth, unsigned int floatHeight, unsigned int numDims, float *surface);
 		bool findMin(){return true;};
 		~RSGISSquaredDifferenceSimilarityMetric(){};
 	};
@@ -80,6 +83,7 @@ namespace rsgis{namespace reg{
 	public:
 		RSGISCorrelationSimilarityMetric(){};
 		float calcValue(float **reference, float **floating, unsigned int numVals, unsigned int numDims);
+        bool calcSurface(float **reference, unsigned int refWidth, unsigned int refHeight, float **floating, unsigned int floatWidth, unsigned int floatHeight, unsigned int numDims, float *surface);
 		bool findMin(){return false;};
 		~RSGISCorrelationSimilarityMetric(){};
 	};
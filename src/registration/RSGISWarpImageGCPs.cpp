@@ -0,0 +1,561 @@
+/*
+ *  RSGISWarpImageGCPs.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISWarpImageGCPs.h"
+
+namespace rsgis{namespace reg{
+    
+    RSGISGCPTransform::RSGISGCPTransform(const std::vector<double> &mapX, const std::vector<double> &mapY, const std::vector<double> &pxlX, const std::vector<double> &pxlY, bool useTPS, unsigned int polyOrder)
+    {
+        size_t numGCPs = mapX.size();
+        if((mapY.size() != numGCPs) || (pxlX.size() != numGCPs) || (pxlY.size() != numGCPs))
+        {
+            throw RSGISRegistrationException("The GCP map and image coordinate lists must be the same length.");
+        }
+        if((!useTPS) && ((polyOrder < 1) || (polyOrder > 3)))
+        {
+            throw RSGISRegistrationException("The polynomial order must be 1, 2 or 3.");
+        }
+        this->useTPS = useTPS;
+        this->polyOrder = polyOrder;
+        
+        if(useTPS)
+        {
+            this->numTerms = 3;
+        }
+        else
+        {
+            this->numTerms = ((polyOrder + 1) * (polyOrder + 2)) / 2;
+        }
+        if(numGCPs < this->numTerms)
+        {
+            throw RSGISRegistrationException("There are not enough GCPs to fit the transformation.");
+        }
+        
+        this->centreX = 0.0;
+        this->centreY = 0.0;
+        for(size_t i = 0; i < numGCPs; ++i)
+        {
+            this->centreX += mapX[i];
+            this->centreY += mapY[i];
+        }
+        this->centreX = this->centreX / numGCPs;
+        this->centreY = this->centreY / numGCPs;
+        this->scale = 0.0;
+        for(size_t i = 0; i < numGCPs; ++i)
+        {
+            this->scale = std::max(this->scale, std::max(std::fabs(mapX[i] - this->centreX), std::fabs(mapY[i] - this->centreY)));
+        }
+        if(this->scale == 0.0)
+        {
+            this->scale = 1.0;
+        }
+        
+        this->ctrlX.resize(numGCPs);
+        this->ctrlY.resize(numGCPs);
+        for(size_t i = 0; i < numGCPs; ++i)
+        {
+            this->ctrlX[i] = (mapX[i] - this->centreX) / this->scale;
+            this->ctrlY[i] = (mapY[i] - this->centreY) / this->scale;
+        }
+        
+        rsgis::math::RSGISDenseMatrix coeffs;
+        try
+        {
+            if(useTPS)
+            {
+                // [K P; P' 0][w; a] = [v; 0], with the spline weights w and the affine terms a.
+                size_t n = numGCPs + 3;
+                rsgis::math::RSGISDenseMatrix lMatrix(n, n, 0.0);
+                rsgis::math::RSGISDenseMatrix vals(n, 2, 0.0);
+                for(size_t i = 0; i < numGCPs; ++i)
+                {
+                    for(size_t j = 0; j < numGCPs; ++j)
+                    {
+                        double dX = this->ctrlX[i] - this->ctrlX[j];
+                        double dY = this->ctrlY[i] - this->ctrlY[j];
+                        lMatrix(i, j) = tpsKernel((dX * dX) + (dY * dY));
+                    }
+                    lMatrix(i, numGCPs) = 1.0;
+                    lMatrix(i, numGCPs+1) = this->ctrlX[i];
+                    lMatrix(i, numGCPs+2) = this->ctrlY[i];
+                    lMatrix(numGCPs, i) = 1.0;
+                    lMatrix(numGCPs+1, i) = this->ctrlX[i];
+                    lMatrix(numGCPs+2, i) = this->ctrlY[i];
+                    vals(i, 0) = pxlX[i];
+                    vals(i, 1) = pxlY[i];
+                }
+                coeffs = lMatrix.solve(vals);
+            }
+            else
+            {
+                // Least squares fit through the normal equations (A'A) c = A'b.
+                rsgis::math::RSGISDenseMatrix terms(numGCPs, this->numTerms, 0.0);
+                rsgis::math::RSGISDenseMatrix vals(numGCPs, 2, 0.0);
+                for(size_t i = 0; i < numGCPs; ++i)
+                {
+                    this->calcPolyTerms(this->ctrlX[i], this->ctrlY[i], terms.row(i));
+                    vals(i, 0) = pxlX[i];
+                    vals(i, 1) = pxlY[i];
+                }
+                rsgis::math::RSGISDenseMatrix normMatrix = rsgis::math::RSGISDenseMatrix::multiply(terms, terms, true, false);
+                rsgis::math::RSGISDenseMatrix normVals = rsgis::math::RSGISDenseMatrix::multiply(terms, vals, true, false);
+                coeffs = normMatrix.solve(normVals);
+            }
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISRegistrationException(std::string("Could not fit the GCP transformation (check for duplicated or collinear GCPs): ") + e.what());
+        }
+        
+        this->coeffsX.resize(coeffs.rows());
+        this->coeffsY.resize(coeffs.rows());
+        for(size_t i = 0; i < coeffs.rows(); ++i)
+        {
+            this->coeffsX[i] = coeffs(i, 0);
+            this->coeffsY[i] = coeffs(i, 1);
+        }
+        
+        if(!useTPS)
+        {
+            // The control points are only needed for the spline.
+            this->ctrlX.clear();
+            this->ctrlY.clear();
+        }
+    }
+    
+    double RSGISGCPTransform::tpsKernel(double dist2)
+    {
+        // U(r) = r^2 log(r^2); the 1/2 factor of r^2 log(r) is absorbed by the weights.
+        if(dist2 <= 0.0)
+        {
+            return 0.0;
+        }
+        return dist2 * log(dist2);
+    }
+    
+    size_t RSGISGCPTransform::calcPolyTerms(double x, double y, double *terms) const
+    {
+        size_t idx = 0;
+        for(unsigned int d = 0; d <= this->polyOrder; ++d)
+        {
+            for(unsigned int j = 0; j <= d; ++j)
+            {
+                terms[idx++] = pow(x, (double)(d - j)) * pow(y, (double)j);
+            }
+        }
+        return idx;
+    }
+    
+    void RSGISGCPTransform::transform(double x, double y, double *outX, double *outY) const
+    {
+        double nX = (x - this->centreX) / this->scale;
+        double nY = (y - this->centreY) / this->scale;
+        if(this->useTPS)
+        {
+            size_t numCtrl = this->ctrlX.size();
+            double valX = this->coeffsX[numCtrl] + (this->coeffsX[numCtrl+1] * nX) + (this->coeffsX[numCtrl+2] * nY);
+            double valY = this->coeffsY[numCtrl] + (this->coeffsY[numCtrl+1] * nX) + (this->coeffsY[numCtrl+2] * nY);
+            for(size_t i = 0; i < numCtrl; ++i)
+            {
+                double dX = nX - this->ctrlX[i];
+                double dY = nY - this->ctrlY[i];
+                double kVal = tpsKernel((dX * dX) + (dY * dY));
+                valX += this->coeffsX[i] * kVal;
+                valY += this->coeffsY[i] * kVal;
+            }
+            *outX = valX;
+            *outY = valY;
+        }
+        else
+        {
+            double terms[10];
+            size_t nTerms = this->calcPolyTerms(nX, nY, terms);
+            double valX = 0.0;
+            double valY = 0.0;
+            for(size_t i = 0; i < nTerms; ++i)
+            {
+                valX += this->coeffsX[i] * terms[i];
+                valY += this->coeffsY[i] * terms[i];
+            }
+            *outX = valX;
+            *outY = valY;
+        }
+    }
+    
+    
+    
+    RSGISWarpImageGCPs::RSGISWarpImageGCPs()
+    {
+        rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+        this->numThreads = context.numThreads;
+        this->numIOBuffers = context.numIOBuffers;
+        this->stripMemoryMB = context.stripMemoryMB;
+    }
+    
+    void RSGISWarpImageGCPs::readImageGCPs(GDALDataset *image, std::vector<double> *mapX, std::vector<double> *mapY, std::vector<double> *pxlX, std::vector<double> *pxlY)
+    {
+        int numGCPs = image->GetGCPCount();
+        if(numGCPs <= 0)
+        {
+            throw RSGISRegistrationException("The image does not have any GCPs.");
+        }
+        const GDAL_GCP *gcps = image->GetGCPs();
+        for(int i = 0; i < numGCPs; ++i)
+        {
+            mapX->push_back(gcps[i].dfGCPX);
+            mapY->push_back(gcps[i].dfGCPY);
+            pxlX->push_back(gcps[i].dfGCPPixel);
+            pxlY->push_back(gcps[i].dfGCPLine);
+        }
+    }
+    
+    void RSGISWarpImageGCPs::warpImage(GDALDataset *inImage, GDALDataset *outImage, const RSGISGCPTransform *transform, rsgis::img::RSGISPointSampleInterp interp, double noDataVal, bool useNoData, unsigned int gridStep)
+    {
+        long inWidth = inImage->GetRasterXSize();
+        long inHeight = inImage->GetRasterYSize();
+        unsigned int numBands = inImage->GetRasterCount();
+        if(((unsigned int)outImage->GetRasterCount()) != numBands)
+        {
+            throw RSGISRegistrationException("The output image must have the same number of bands as the input image.");
+        }
+        unsigned int outWidth = outImage->GetRasterXSize();
+        unsigned int outHeight = outImage->GetRasterYSize();
+        if((numBands == 0) || (outWidth == 0) || (outHeight == 0))
+        {
+            return;
+        }
+        double trans[6];
+        outImage->GetGeoTransform(trans);
+        gridStep = std::max<unsigned int>(gridStep, 1);
+        
+        std::vector<GDALRasterBand*> inBands(numBands);
+        std::vector<GDALRasterBand*> outBands(numBands);
+        for(unsigned int b = 0; b < numBands; ++b)
+        {
+            inBands[b] = inImage->GetRasterBand(b+1);
+            outBands[b] = outImage->GetRasterBand(b+1);
+        }
+        
+        // The columns of the warp grid nodes, which always include the last column.
+        std::vector<unsigned int> nodeCols;
+        for(unsigned int c = 0; c < outWidth; c += gridStep)
+        {
+            nodeCols.push_back(c);
+        }
+        if(nodeCols.back() != (outWidth-1))
+        {
+            nodeCols.push_back(outWidth-1);
+        }
+        size_t nNodeCols = nodeCols.size();
+        
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        outBands[0]->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), outWidth, outHeight, 2 * sizeof(float) * numBands, this->stripMemoryMB);
+        size_t nStrips = (outHeight + stripRows - 1) / stripRows;
+        size_t stripPxls = ((size_t)outWidth) * stripRows;
+        
+        unsigned int numTaps = 1;
+        if(interp == rsgis::img::pointSampleBilinear)
+        {
+            numTaps = 2;
+        }
+        else if(interp == rsgis::img::pointSampleCubic)
+        {
+            numTaps = 4;
+        }
+        
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        rsgis::RSGISStripIOPipeline ioPipeline(this->numIOBuffers);
+        unsigned int numBuffers = std::max<unsigned int>(ioPipeline.getNumBuffers(), 1);
+        std::vector<std::vector<unsigned int> > stripNodeRows(numBuffers);
+        std::vector<std::vector<double> > stripNodeX(numBuffers);
+        std::vector<std::vector<double> > stripNodeY(numBuffers);
+        std::vector<long> winXs(numBuffers, 0);
+        std::vector<long> winYs(numBuffers, 0);
+        std::vector<long> winWidths(numBuffers, 0);
+        std::vector<long> winHeights(numBuffers, 0);
+        std::vector<std::vector<float> > inData(numBuffers);
+        std::vector<std::vector<float> > outData(numBuffers, std::vector<float>(stripPxls * numBands));
+        
+        unsigned int nThreads = threadPool.getNumThreads();
+        std::vector<std::vector<double> > threadPxlX(nThreads, std::vector<double>(outWidth));
+        std::vector<std::vector<double> > threadPxlY(nThreads, std::vector<double>(outWidth));
+        std::vector<std::vector<double> > threadRowX(nThreads, std::vector<double>(nNodeCols));
+        std::vector<std::vector<double> > threadRowY(nThreads, std::vector<double>(nNodeCols));
+        
+        rsgis_tqdm pbar;
+        ioPipeline.run(nStrips, [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, outHeight - rowStart);
+            
+            // Evaluate the transformation at the nodes of the warp grid for the strip.
+            std::vector<unsigned int> &nodeRows = stripNodeRows[buf];
+            nodeRows.clear();
+            for(unsigned int r = 0; r < nRows; r += gridStep)
+            {
+                nodeRows.push_back(rowStart + r);
+            }
+            if(nodeRows.back() != (rowStart + nRows - 1))
+            {
+                nodeRows.push_back(rowStart + nRows - 1);
+            }
+            std::vector<double> &nodeX = stripNodeX[buf];
+            std::vector<double> &nodeY = stripNodeY[buf];
+            nodeX.resize(nodeRows.size() * nNodeCols);
+            nodeY.resize(nodeRows.size() * nNodeCols);
+            
+            double minX = 0.0;
+            double maxX = 0.0;
+            double minY = 0.0;
+            double maxY = 0.0;
+            bool first = true;
+            for(size_t i = 0; i < nodeRows.size(); ++i)
+            {
+                for(size_t j = 0; j < nNodeCols; ++j)
+                {
+                    double mapX = trans[0] + ((nodeCols[j] + 0.5) * trans[1]) + ((nodeRows[i] + 0.5) * trans[2]);
+                    double mapY = trans[3] + ((nodeCols[j] + 0.5) * trans[4]) + ((nodeRows[i] + 0.5) * trans[5]);
+                    size_t idx = (i * nNodeCols) + j;
+                    transform->transform(mapX, mapY, &nodeX[idx], &nodeY[idx]);
+                    if(std::isfinite(nodeX[idx]) && std::isfinite(nodeY[idx]))
+                    {
+                        if(first)
+                        {
+                            minX = maxX = nodeX[idx];
+                            minY = maxY = nodeY[idx];
+                            first = false;
+                        }
+                        else
+                        {
+                            minX = std::min(minX, nodeX[idx]);
+                            maxX = std::max(maxX, nodeX[idx]);
+                            minY = std::min(minY, nodeY[idx]);
+                            maxY = std::max(maxY, nodeY[idx]);
+                        }
+                    }
+                }
+            }
+            
+            // The pixels are interpolated between the nodes, so the input window
+            // needed is the node bounding box plus the interpolation kernel.
+            winWidths[buf] = 0;
+            winHeights[buf] = 0;
+            if(!first)
+            {
+                long x0 = std::max<double>(floor(minX - 0.5) - 2, 0);
+                long x1 = std::min<double>(floor(maxX - 0.5) + 3, inWidth - 1);
+                long y0 = std::max<double>(floor(minY - 0.5) - 2, 0);
+                long y1 = std::min<double>(floor(maxY - 0.5) + 3, inHeight - 1);
+                if((x0 <= x1) && (y0 <= y1))
+                {
+                    winXs[buf] = x0;
+                    winYs[buf] = y0;
+                    winWidths[buf] = (x1 - x0) + 1;
+                    winHeights[buf] = (y1 - y0) + 1;
+                }
+            }
+            
+            size_t winPxls = ((size_t)winWidths[buf]) * winHeights[buf];
+            inData[buf].resize(winPxls * numBands);
+            if(winPxls > 0)
+            {
+                for(unsigned int b = 0; b < numBands; ++b)
+                {
+                    if(inBands[b]->RasterIO(GF_Read, winXs[buf], winYs[buf], winWidths[buf], winHeights[buf], &inData[buf][b * winPxls], winWidths[buf], winHeights[buf], GDT_Float32, 0, 0) != CE_None)
+                    {
+                        throw RSGISRegistrationException("Could not read the input image window.");
+                    }
+                }
+            }
+        },
+        [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, outHeight - rowStart);
+            pbar.progress(rowStart, outHeight);
+            
+            const std::vector<unsigned int> &nodeRows = stripNodeRows[buf];
+            const double *nodeX = stripNodeX[buf].data();
+            const double *nodeY = stripNodeY[buf].data();
+            size_t nNodeRows = nodeRows.size();
+            long winX = winXs[buf];
+            long winY = winYs[buf];
+            long winWidth = winWidths[buf];
+            long winHeight = winHeights[buf];
+            size_t winPxls = ((size_t)winWidth) * winHeight;
+            const float *winData = inData[buf].data();
+            float *stripData = outData[buf].data();
+            
+            threadPool.parallelFor(0, nRows, [&](unsigned int threadIdx, size_t rStart, size_t rEnd)
+            {
+                double *pxlX = threadPxlX[threadIdx].data();
+                double *pxlY = threadPxlY[threadIdx].data();
+                double *rowX = threadRowX[threadIdx].data();
+                double *rowY = threadRowY[threadIdx].data();
+                double xWeights[4];
+                double yWeights[4];
+                long xTaps[4];
+                long yTaps[4];
+                for(size_t r = rStart; r < rEnd; ++r)
+                {
+                    // Interpolate the node rows either side of the row and then along the row.
+                    unsigned int row = rowStart + r;
+                    size_t k = 0;
+                    double tRow = 0.0;
+                    if(nNodeRows > 1)
+                    {
+                        k = std::min<size_t>(r / gridStep, nNodeRows - 2);
+                        tRow = ((double)(row - nodeRows[k])) / ((double)(nodeRows[k+1] - nodeRows[k]));
+                    }
+                    const double *nodeX0 = nodeX + (k * nNodeCols);
+                    const double *nodeY0 = nodeY + (k * nNodeCols);
+                    const double *nodeX1 = (nNodeRows > 1)?(nodeX0 + nNodeCols):nodeX0;
+                    const double *nodeY1 = (nNodeRows > 1)?(nodeY0 + nNodeCols):nodeY0;
+                    for(size_t j = 0; j < nNodeCols; ++j)
+                    {
+                        rowX[j] = ((1.0 - tRow) * nodeX0[j]) + (tRow * nodeX1[j]);
+                        rowY[j] = ((1.0 - tRow) * nodeY0[j]) + (tRow * nodeY1[j]);
+                    }
+                    for(unsigned int c = 0; c < outWidth; ++c)
+                    {
+                        size_t j = 0;
+                        double tCol = 0.0;
+                        if(nNodeCols > 1)
+                        {
+                            j = std::min<size_t>(c / gridStep, nNodeCols - 2);
+                            tCol = ((double)(c - nodeCols[j])) / ((double)(nodeCols[j+1] - nodeCols[j]));
+                        }
+                        size_t j1 = (nNodeCols > 1)?(j + 1):j;
+                        pxlX[c] = ((1.0 - tCol) * rowX[j]) + (tCol * rowX[j1]);
+                        pxlY[c] = ((1.0 - tCol) * rowY[j]) + (tCol * rowY[j1]);
+                    }
+                    
+                    size_t outOff = ((size_t)r) * outWidth;
+                    for(unsigned int c = 0; c < outWidth; ++c)
+                    {
+                        double pX = pxlX[c];
+                        double pY = pxlY[c];
+                        bool inside = (pX >= 0) && (pY >= 0) && (pX <= inWidth) && (pY <= inHeight) && (winPxls > 0);
+                        if(inside)
+                        {
+                            long x0 = 0;
+                            long y0 = 0;
+                            if(interp == rsgis::img::pointSampleNearest)
+                            {
+                                x0 = std::min<long>(floor(pX), inWidth - 1);
+                                y0 = std::min<long>(floor(pY), inHeight - 1);
+                                xWeights[0] = 1.0;
+                                yWeights[0] = 1.0;
+                            }
+                            else
+                            {
+                                double fX = pX - 0.5;
+                                double fY = pY - 0.5;
+                                x0 = floor(fX);
+                                y0 = floor(fY);
+                                if(interp == rsgis::img::pointSampleBilinear)
+                                {
+                                    xWeights[1] = fX - x0;
+                                    xWeights[0] = 1.0 - xWeights[1];
+                                    yWeights[1] = fY - y0;
+                                    yWeights[0] = 1.0 - yWeights[1];
+                                }
+                                else
+                                {
+                                    rsgis::img::RSGISImagePointSampler::cubicWeights(fX - x0, xWeights);
+                                    rsgis::img::RSGISImagePointSampler::cubicWeights(fY - y0, yWeights);
+                                    x0 = x0 - 1;
+                                    y0 = y0 - 1;
+                                }
+                            }
+                            for(unsigned int t = 0; t < numTaps; ++t)
+                            {
+                                // Clamp the kernel to the edges of the image.
+                                xTaps[t] = std::min<long>(std::max<long>(x0 + t, 0), inWidth - 1) - winX;
+                                yTaps[t] = std::min<long>(std::max<long>(y0 + t, 0), inHeight - 1) - winY;
+                                if((xTaps[t] < 0) || (xTaps[t] >= winWidth) || (yTaps[t] < 0) || (yTaps[t] >= winHeight))
+                                {
+                                    inside = false;
+                                }
+                            }
+                        }
+                        
+                        for(unsigned int b = 0; b < numBands; ++b)
+                        {
+                            double val = noDataVal;
+                            if(inside)
+                            {
+                                const float *bandData = winData + (b * winPxls);
+                                double sum = 0.0;
+                                double sumWeights = 0.0;
+                                bool hasNoData = false;
+                                for(unsigned int ty = 0; ty < numTaps; ++ty)
+                                {
+                                    const float *rowData = bandData + (yTaps[ty] * winWidth);
+                                    for(unsigned int tx = 0; tx < numTaps; ++tx)
+                                    {
+                                        float tapVal = rowData[xTaps[tx]];
+                                        double weight = xWeights[tx] * yWeights[ty];
+                                        if(useNoData && (tapVal == noDataVal))
+                                        {
+                                            hasNoData = true;
+                                            continue;
+                                        }
+                                        sum += weight * tapVal;
+                                        sumWeights += weight;
+                                    }
+                                }
+                                if(!hasNoData)
+                                {
+                                    val = sum;
+                                }
+                                else if(std::fabs(sumWeights) > 1e-6)
+                                {
+                                    // Renormalise the weights of the valid pixels.
+                                    val = sum / sumWeights;
+                                }
+                            }
+                            stripData[(b * stripPxls) + outOff + c] = val;
+                        }
+                    }
+                }
+            });
+        },
+        [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, outHeight - rowStart);
+            for(unsigned int b = 0; b < numBands; ++b)
+            {
+                if(outBands[b]->RasterIO(GF_Write, 0, rowStart, outWidth, nRows, &outData[buf][b * stripPxls], outWidth, nRows, GDT_Float32, 0, 0) != CE_None)
+                {
+                    throw RSGISRegistrationException("Could not write the output image strip.");
+                }
+            }
+        });
+        pbar.finish();
+    }
+    
+}}
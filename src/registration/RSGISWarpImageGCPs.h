@@ -0,0 +1,119 @@
+/*
+ *  RSGISWarpImageGCPs.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISWarpImageGCPs_H
+#define RSGISWarpImageGCPs_H
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISRegistrationException.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISStripIOPipeline.h"
+#include "common/rsgis-tqdm.h"
+
+#include "math/RSGISDenseMatrix.h"
+#include "img/RSGISImagePointSampler.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_registration_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace reg{
+    
+    /**
+     * A transformation from map coordinates to the image (pixel, line) coordinates
+     * of an image fitted to a set of GCPs, where the pixel (x, y) covers [x, x+1) x [y, y+1)
+     * (i.e., the GDAL GCP convention). The transformation is either a least squares
+     * polynomial (order 1-3) or a thin plate spline, which passes through every GCP.
+     * The map coordinates are normalised about the centre of the GCPs before fitting
+     * so the systems are well conditioned.
+     */
+    class DllExport RSGISGCPTransform
+    {
+    public:
+        RSGISGCPTransform(const std::vector<double> &mapX, const std::vector<double> &mapY, const std::vector<double> &pxlX, const std::vector<double> &pxlY, bool useTPS=false, unsigned int polyOrder=1);
+        void transform(double x, double y, double *outX, double *outY) const;
+        ~RSGISGCPTransform(){};
+    protected:
+        size_t calcPolyTerms(double x, double y, double *terms) const;
+        static double tpsKernel(double dist2);
+        bool useTPS;
+        unsigned int polyOrder;
+        size_t numTerms;
+        double centreX;
+        double centreY;
+        double scale;
+        std::vector<double> ctrlX;
+        std::vector<double> ctrlY;
+        std::vector<double> coeffsX;
+        std::vector<double> coeffsY;
+    };
+    
+    /**
+     * Warps (resamples) an image onto the pixel grid of an output image using a
+     * transformation fitted to GCPs; i.e., an in-process alternative to gdalwarp for
+     * images with GCPs (e.g., from RSGISAddGCPsGDAL). Instead of evaluating the
+     * transformation for every pixel, it is evaluated on a coarse grid of nodes
+     * (every gridStep output pixels) and the image coordinates of the pixels are
+     * interpolated bilinearly between the nodes. The output image is processed in
+     * strips: the input window needed by each strip is read, the strip is resampled
+     * (nearest neighbour, bilinear or cubic, as RSGISImagePointSampler) one row per task
+     * on the threads of the execution context and written, with the reads and
+     * writes overlapping the resampling when more than one I/O buffer is used.
+     *
+     * Output pixels outside of the input image are given noDataVal; if useNoData is
+     * true input pixels with the noDataVal are not used by the interpolation.
+     */
+    class DllExport RSGISWarpImageGCPs
+    {
+    public:
+        RSGISWarpImageGCPs();
+        /** Read the GCPs of an image (e.g., added with RSGISAddGCPsGDAL). */
+        static void readImageGCPs(GDALDataset *image, std::vector<double> *mapX, std::vector<double> *mapY, std::vector<double> *pxlX, std::vector<double> *pxlY);
+        void warpImage(GDALDataset *inImage, GDALDataset *outImage, const RSGISGCPTransform *transform, rsgis::img::RSGISPointSampleInterp interp, double noDataVal, bool useNoData, unsigned int gridStep=16);
+        ~RSGISWarpImageGCPs(){};
+    protected:
+        unsigned int numThreads;
+        unsigned int numIOBuffers;
+        unsigned int stripMemoryMB;
+    };
+    
+}}
+
+#endif
+
@@ -25,167 +25,97 @@
 
 namespace rsgis{namespace segment{
     
-    RSGISClumpPxls::RSGISClumpPxls()
+    RSGISClumpTupleTable::RSGISClumpTupleTable(unsigned int numBands)
     {
-        
+        this->numBands = numBands;
+        this->numTuples = 0;
+        this->rehash(64);
     }
-        
-    void RSGISClumpPxls::performClump(GDALDataset *catagories, GDALDataset *clumps, bool noDataValProvided, unsigned int noDataVal, std::vector<unsigned int> *clumpPxlVals) 
+    
+    unsigned long RSGISClumpTupleTable::findOrInsert(const unsigned int *tuple, uint64_t key)
     {
-        if(catagories->GetRasterXSize() != clumps->GetRasterXSize())
+        // Keep the load factor at or below a half so the probe sequences stay short.
+        if(((this->numTuples+1)*2) > this->slotIDs.size())
         {
-            throw rsgis::img::RSGISImageCalcException("Widths are not the same");
+            this->rehash(this->slotIDs.size()*2);
         }
-        if(catagories->GetRasterYSize() != clumps->GetRasterYSize())
+        
+        uint64_t hash = key * 0x9E3779B97F4A7C15ULL;
+        size_t slot = (hash ^ (hash >> 32)) & this->slotMask;
+        while(this->slotIDs[slot] != 0)
         {
-            throw rsgis::img::RSGISImageCalcException("Heights are not the same");
+            if((this->slotKeys[slot] == key) && ((this->numBands <= 2) || std::equal(tuple, tuple+this->numBands, this->getTuple(this->slotIDs[slot]))))
+            {
+                return this->slotIDs[slot];
+            }
+            slot = (slot + 1) & this->slotMask;
         }
         
-        rsgis::img::RSGISImageUtils imgUtils;
-        imgUtils.zerosUIntGDALDataset(clumps);
-        
-        unsigned int width = catagories->GetRasterXSize();
-        unsigned int height = catagories->GetRasterYSize();
-        
-        GDALRasterBand *catagoryBand = catagories->GetRasterBand(1);
-        GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
-        
-        unsigned long clumpIdx = 1;
-        std::vector<rsgis::img::PxlLoc> clumpPxls;
-        std::queue<rsgis::img::PxlLoc> clumpSearchPxls;
-        unsigned int catPxlVal = 0;
-        unsigned int catCPxlVal = 0;
-        
-        unsigned int uiPxlVal = 0;
+        this->tuples.insert(this->tuples.end(), tuple, tuple+this->numBands);
+        this->slotKeys[slot] = key;
+        this->slotIDs[slot] = ++this->numTuples;
+        return this->numTuples;
+    }
+    
+    void RSGISClumpTupleTable::clear()
+    {
+        this->numTuples = 0;
+        this->tuples.clear();
+        std::fill(this->slotIDs.begin(), this->slotIDs.end(), 0);
+    }
+    
+    uint64_t RSGISClumpTupleTable::createKey(const unsigned int *tuple, unsigned int numBands)
+    {
+        if(numBands == 1)
+        {
+            return tuple[0];
+        }
+        else if(numBands == 2)
+        {
+            return ((uint64_t)tuple[0]) | (((uint64_t)tuple[1]) << 32);
+        }
         
-        rsgis_tqdm pbar;
-        for(unsigned int i = 0; i < height; ++i)
+        uint64_t key = numBands;
+        for(unsigned int n = 0; n < numBands; ++n)
         {
-            pbar.progress(i, height);
-            
-            for(unsigned int j = 0; j < width; ++j)
-            {
-                // Get pixel value from clump image for (j,i)
-                clumpBand->RasterIO(GF_Read, j, i, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                
-                // if value is zero create new clump
-                if(uiPxlVal == 0) 
-                {
-                    catagoryBand->RasterIO(GF_Read, j, i, 1, 1, &catPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                    if((!noDataValProvided) | (noDataValProvided & (catPxlVal != noDataVal)))
-                    {     
-                        // Make sure all lists are empty.
-                        clumpPxls.clear();
-                        if(!clumpSearchPxls.empty())
-                        {
-                            while(clumpSearchPxls.size() > 0)
-                            {
-                                clumpSearchPxls.pop();
-                            }
-                        }
-                        
-                        if(clumpPxlVals != NULL)
-                        {
-                            clumpPxlVals->push_back(catPxlVal);
-                        }
-                            
-                        clumpPxls.push_back(rsgis::img::PxlLoc(j, i));
-                        clumpSearchPxls.push(rsgis::img::PxlLoc(j, i));
-                        clumpBand->RasterIO(GF_Write, j, i, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                        
-                        // Add neigbouring pixels to clump.
-                        // If no more pixels to add then stop.
-                        while(clumpSearchPxls.size() > 0)
-                        {
-                            rsgis::img::PxlLoc pxl = clumpSearchPxls.front();
-                            clumpSearchPxls.pop();
-                            
-                            // Above
-                            if(((long)pxl.yPos)-1 >= 0)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
-
-                                    if(catPxlVal == catCPxlVal)
-                                    {
-                                        clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                        clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos-1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                    }
-                                }
-                            }
-                            // Below
-                            if((pxl.yPos+1) < height)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                    
-                                    if(catPxlVal == catCPxlVal)
-                                    {
-                                        clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                        clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos+1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                    }
-                                }
-                                
-                            }
-                            // Left
-                            if(((long)pxl.xPos)-1 >= 0)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                    
-                                    if(catPxlVal == catCPxlVal)
-                                    {
-                                        clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                        clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos-1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                    }
-                                }
-                            }
-                            // Right
-                            if((pxl.xPos+1) < width)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                    
-                                    if(catPxlVal == catCPxlVal)
-                                    {
-                                        clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                        clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos+1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                    }
-                                }
-                            }
-                        }
-                        
-                        ++clumpIdx;
-                    }
-                }
-            }
+            key = (key ^ tuple[n]) * 0xFF51AFD7ED558CCDULL;
+            key ^= (key >> 33);
         }
-        pbar.finish();
-        std::cout << "(Generated " << clumpIdx-1 << " clumps).\n";
-        if(clumpPxlVals != NULL)
+        return key;
+    }
+    
+    void RSGISClumpTupleTable::rehash(size_t numSlots)
+    {
+        std::vector<uint64_t> oldKeys;
+        std::vector<unsigned long> oldIDs;
+        oldKeys.swap(this->slotKeys);
+        oldIDs.swap(this->slotIDs);
+        
+        this->slotKeys.assign(numSlots, 0);
+        this->slotIDs.assign(numSlots, 0);
+        this->slotMask = numSlots - 1;
+        for(size_t i = 0; i < oldIDs.size(); ++i)
         {
-            if(clumpPxlVals->size() != (clumpIdx-1))
+            if(oldIDs[i] != 0)
             {
-                std::cout << "Number of clump pixel values: " << clumpPxlVals->size() << std::endl;
-                throw rsgis::img::RSGISImageCalcException("Number of clump pixel values in list is not equal to the number of clumps.");
+                uint64_t hash = oldKeys[i] * 0x9E3779B97F4A7C15ULL;
+                size_t slot = (hash ^ (hash >> 32)) & this->slotMask;
+                while(this->slotIDs[slot] != 0)
+                {
+                    slot = (slot + 1) & this->slotMask;
+                }
+                this->slotKeys[slot] = oldKeys[i];
+                this->slotIDs[slot] = oldIDs[i];
             }
         }
-        
     }
     
-    void RSGISClumpPxls::performClumpPosVals(GDALDataset *catagories, GDALDataset *clumps) 
+    RSGISClumpPxls::RSGISClumpPxls()
+    {
+        
+    }
+        
+    void RSGISClumpPxls::performClump(GDALDataset *catagories, GDALDataset *clumps, bool noDataValProvided, unsigned int noDataVal, std::vector<unsigned int> *clumpPxlVals, unsigned int nThreads) 
     {
         if(catagories->GetRasterXSize() != clumps->GetRasterXSize())
         {
@@ -196,137 +126,37 @@ namespace rsgis{namespace segment{
             throw rsgis::img::RSGISImageCalcException("Heights are not the same");
         }
         
-        rsgis::img::RSGISImageUtils imgUtils;
-        imgUtils.zerosUIntGDALDataset(clumps);
-        
         unsigned int width = catagories->GetRasterXSize();
         unsigned int height = catagories->GetRasterYSize();
         
-        GDALRasterBand *catagoryBand = catagories->GetRasterBand(1);
+        std::vector<GDALRasterBand*> catBands;
+        catBands.push_back(catagories->GetRasterBand(1));
+        std::vector<std::pair<int, int> > bandOffsets;
+        bandOffsets.push_back(std::pair<int, int>(0, 0));
         GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
         
-        unsigned long clumpIdx = 1;
-        std::vector<rsgis::img::PxlLoc> clumpPxls;
-        std::queue<rsgis::img::PxlLoc> clumpSearchPxls;
-        unsigned int catPxlVal = 0;
-        unsigned int catCPxlVal = 0;
+        std::vector<unsigned int> clumpCatVals;
+        unsigned long numClumps = this->performTwoPassClump(catBands, bandOffsets, clumpBand, width, height, noDataValProvided, noDataVal, &clumpCatVals, nThreads);
         
-        unsigned int uiPxlVal = 0;
-        
-        rsgis_tqdm pbar;
-        for(unsigned int i = 0; i < height; ++i)
+        std::cout << "(Generated " << numClumps << " clumps).\n";
+        if(clumpPxlVals != NULL)
         {
-            pbar.progress(i, height);
-            
-            for(unsigned int j = 0; j < width; ++j)
+            clumpPxlVals->insert(clumpPxlVals->end(), clumpCatVals.begin(), clumpCatVals.end());
+            if(clumpPxlVals->size() != numClumps)
             {
-                // Get pixel value from clump image for (j,i)
-                clumpBand->RasterIO(GF_Read, j, i, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                
-                // if value is zero create new clump
-                if(uiPxlVal == 0)
-                {
-                    catagoryBand->RasterIO(GF_Read, j, i, 1, 1, &catPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                    if(catPxlVal > 0)
-                    {
-                        // Make sure all lists are empty.
-                        clumpPxls.clear();
-                        if(!clumpSearchPxls.empty())
-                        {
-                            while(clumpSearchPxls.size() > 0)
-                            {
-                                clumpSearchPxls.pop();
-                            }
-                        }
-                        
-                        clumpPxls.push_back(rsgis::img::PxlLoc(j, i));
-                        clumpSearchPxls.push(rsgis::img::PxlLoc(j, i));
-                        clumpBand->RasterIO(GF_Write, j, i, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                        
-                        // Add neigbouring pixels to clump.
-                        // If no more pixels to add then stop.
-                        while(clumpSearchPxls.size() > 0)
-                        {
-                            rsgis::img::PxlLoc pxl = clumpSearchPxls.front();
-                            clumpSearchPxls.pop();
-                            
-                            // Above
-                            if(((long)pxl.yPos)-1 >= 0)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                    
-                                    if(catPxlVal == catCPxlVal)
-                                    {
-                                        clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                        clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos-1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                    }
-                                }
-                            }
-                            // Below
-                            if((pxl.yPos+1) < height)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                    
-                                    if(catPxlVal == catCPxlVal)
-                                    {
-                                        clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                        clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos+1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                    }
-                                }
-                                
-                            }
-                            // Left
-                            if(((long)pxl.xPos)-1 >= 0)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                    
-                                    if(catPxlVal == catCPxlVal)
-                                    {
-                                        clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                        clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos-1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                    }
-                                }
-                            }
-                            // Right
-                            if((pxl.xPos+1) < width)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                    
-                                    if(catPxlVal == catCPxlVal)
-                                    {
-                                        clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                        clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos+1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                    }
-                                }
-                            }
-                        }
-                        
-                        ++clumpIdx;
-                    }
-                }
+                std::cout << "Number of clump pixel values: " << clumpPxlVals->size() << std::endl;
+                throw rsgis::img::RSGISImageCalcException("Number of clump pixel values in list is not equal to the number of clumps.");
             }
         }
-        pbar.finish();
-        std::cout << "(Generated " << clumpIdx-1 << " clumps).\n";
     }
     
-    void RSGISClumpPxls::performMultiBandClump(std::vector<GDALDataset*> *catagories, std::string clumpsOutputPath, std::string outFormat, bool noDataValProvided, unsigned int noDataVal, bool addRatPxlVals) 
+    void RSGISClumpPxls::performClumpPosVals(GDALDataset *catagories, GDALDataset *clumps) 
+    {
+        // Only values > 0 are clumped, which is the same as using 0 as the no data value.
+        this->performClump(catagories, clumps, true, 0, NULL);
+    }
+    
+    void RSGISClumpPxls::performMultiBandClump(std::vector<GDALDataset*> *catagories, std::string clumpsOutputPath, std::string outFormat, bool noDataValProvided, unsigned int noDataVal, bool addRatPxlVals, bool tupleIDs, unsigned int nThreads) 
     {
         try
         {
@@ -359,7 +189,7 @@ namespace rsgis{namespace segment{
             char **papszOptions = imgUtils.getGDALCreationOptionsForFormat(outFormat);
 			std::cout << "New image width = " << width << " height = " << height << std::endl;
             
-            GDALDataset *clumpsDS = gdalDriver->Create(clumpsOutputPath.c_str(), width, height, 1, GDT_UInt32, papszOptions);
+            GDALDataset *clumpsDS = gdalDriver->Create(clumpsOutputPath.c_str(), width, height, 1, getClumpsDataType(width, height), papszOptions);
 			
 			if(clumpsDS == NULL)
 			{
@@ -374,7 +204,6 @@ namespace rsgis{namespace segment{
 			}
 			clumpsDS->SetGeoTransform(gdalTransform);
 			clumpsDS->SetProjection(catagories->at(0)->GetProjectionRef());
-            imgUtils.zerosUIntGDALDataset(clumpsDS);
             
             // Count number of image bands
 			unsigned int numInBands = 0;
@@ -403,194 +232,51 @@ namespace rsgis{namespace segment{
 			GDALRasterBand *clumpBand = clumpsDS->GetRasterBand(1);
             clumpBand->SetDescription("Clumps");
                         
-            unsigned long clumpIdx = 1;
-            std::vector<rsgis::img::PxlLoc> clumpPxls;
-            std::queue<rsgis::img::PxlLoc> clumpSearchPxls;
-            unsigned int *catPxlVals = new unsigned int[numInBands];
-            unsigned int *catCPxlVals = new unsigned int[numInBands];
-            
-            unsigned int uiPxlVal = 0;
-            std::vector<int*> outRATVals;
+            std::vector<GDALRasterBand*> catBandsVec(catBands, catBands+numInBands);
+            std::vector<std::pair<int, int> > bandOffsetsVec;
+            for(unsigned int n = 0; n < numInBands; ++n)
+            {
+                bandOffsetsVec.push_back(std::pair<int, int>(bandOffsets[n][0], bandOffsets[n][1]));
+            }
             
-            rsgis_tqdm pbar;
-            for(unsigned int i = 0; i < height; ++i)
+            std::vector<unsigned int> clumpCatVals;
+            unsigned long numClumps = 0;
+            if(tupleIDs)
             {
-                pbar.progress(i, height);
-                
-                for(unsigned int j = 0; j < width; ++j)
-                {
-                    // Get pixel value from clump image for (j,i)
-                    clumpBand->RasterIO(GF_Read, j, i, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                    
-                    // if value is zero create new clump
-                    if(uiPxlVal == 0)
-                    {
-                        for(unsigned int n = 0; n < numInBands; ++n)
-                        {
-                            catBands[n]->RasterIO(GF_Read, bandOffsets[n][0]+j, bandOffsets[n][1]+i, 1, 1, &catPxlVals[n], 1, 1, GDT_UInt32, 0, 0);
-                        }
-                        
-                        if((!noDataValProvided) | (noDataValProvided & (!this->allValueEqual(catPxlVals, numInBands, noDataVal))))
-                        {
-                            // Make sure all lists are empty.
-                            clumpPxls.clear();
-                            if(!clumpSearchPxls.empty())
-                            {
-                                while(clumpSearchPxls.size() > 0)
-                                {
-                                    clumpSearchPxls.pop();
-                                }
-                            }
-                            
-                            if(addRatPxlVals)
-                            {
-                                int *vals = new int[numInBands];
-                                for(unsigned int n = 0; n < numInBands; ++n)
-                                {
-                                    vals[n] = catPxlVals[n];
-                                }
-                                outRATVals.push_back(vals);
-                            }
-                            
-                            clumpPxls.push_back(rsgis::img::PxlLoc(j, i));
-                            clumpSearchPxls.push(rsgis::img::PxlLoc(j, i));
-                            clumpBand->RasterIO(GF_Write, j, i, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                            
-                            // Add neigbouring pixels to clump.
-                            // If no more pixels to add then stop.
-                            while(clumpSearchPxls.size() > 0)
-                            {
-                                rsgis::img::PxlLoc pxl = clumpSearchPxls.front();
-                                clumpSearchPxls.pop();
-                                
-                                // Above
-                                if(((long)pxl.yPos)-1 >= 0)
-                                {
-                                    clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                    if(uiPxlVal == 0)
-                                    {
-                                        for(unsigned int n = 0; n < numInBands; ++n)
-                                        {
-                                            catBands[n]->RasterIO(GF_Read, bandOffsets[n][0]+pxl.xPos, bandOffsets[n][1]+(pxl.yPos-1), 1, 1, &catCPxlVals[n], 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                        
-                                        if(this->allValueEqual(catPxlVals, catCPxlVals, numInBands))
-                                        {
-                                            clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                            clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos-1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                    }
-                                }
-                                // Below
-                                if((pxl.yPos+1) < height)
-                                {
-                                    clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                    if(uiPxlVal == 0)
-                                    {
-                                        for(unsigned int n = 0; n < numInBands; ++n)
-                                        {
-                                            catBands[n]->RasterIO(GF_Read, bandOffsets[n][0]+pxl.xPos, bandOffsets[n][1]+(pxl.yPos+1), 1, 1, &catCPxlVals[n], 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                        
-                                        if(this->allValueEqual(catPxlVals, catCPxlVals, numInBands))
-                                        {
-                                            clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                            clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos+1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                    }
-                                    
-                                }
-                                // Left
-                                if(((long)pxl.xPos)-1 >= 0)
-                                {
-                                    clumpBand->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                    if(uiPxlVal == 0)
-                                    {
-                                        for(unsigned int n = 0; n < numInBands; ++n)
-                                        {
-                                            catBands[n]->RasterIO(GF_Read, bandOffsets[n][0]+(pxl.xPos-1), bandOffsets[n][1]+pxl.yPos, 1, 1, &catCPxlVals[n], 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                        
-                                        if(this->allValueEqual(catPxlVals, catCPxlVals, numInBands))
-                                        {
-                                            clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                            clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos-1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                    }
-                                }
-                                // Right
-                                if((pxl.xPos+1) < width)
-                                {
-                                    clumpBand->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                    if(uiPxlVal == 0)
-                                    {
-                                        for(unsigned int n = 0; n < numInBands; ++n)
-                                        {
-                                            catBands[n]->RasterIO(GF_Read, bandOffsets[n][0]+(pxl.xPos+1), bandOffsets[n][1]+pxl.yPos, 1, 1, &catCPxlVals[n], 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                        
-                                        if(this->allValueEqual(catPxlVals, catCPxlVals, numInBands))
-                                        {
-                                            clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                            clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos+1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                    }
-                                }
-                            }
-                            
-                            ++clumpIdx;
-                        }
-                    }
-                }
+                numClumps = this->performTupleLabelling(catBandsVec, bandOffsetsVec, clumpBand, width, height, noDataValProvided, noDataVal, &clumpCatVals, nThreads);
             }
-            pbar.finish();
-            std::cout << "(Generated " << clumpIdx-1 << " clumps).\n";
+            else
+            {
+                numClumps = this->performTwoPassClump(catBandsVec, bandOffsetsVec, clumpBand, width, height, noDataValProvided, noDataVal, &clumpCatVals, nThreads);
+            }
+            std::cout << "(Generated " << numClumps << " clumps).\n";
             
             clumpBand->SetMetadataItem("LAYER_TYPE", "thematic");
             if(addRatPxlVals)
             {
                 GDALRasterAttributeTable *rat = clumpBand->GetDefaultRAT();
                 size_t numRows = rat->GetRowCount();
-                if((outRATVals.size()+1) > numRows)
+                if((numClumps+1) > numRows)
                 {
-                    numRows = outRATVals.size()+1;
+                    numRows = numClumps+1;
                     rat->SetRowCount(numRows);
                 }
                 rastergis::RSGISRasterAttUtils attUtils;
                 utils::RSGISTextUtils txtUtils;
-                int *ratColVals = new int[numRows];
+                // Each column is written in one call directly from the clump category values.
+                std::vector<int> ratColVals(numRows, 0);
                 for(size_t i = 0; i < numInBands; ++i)
                 {
-                    for(size_t j = 0; j < numRows; ++j)
+                    for(size_t j = 1; j <= numClumps; ++j)
                     {
-                        if(j == 0)
-                        {
-                            ratColVals[j] = 0;
-                        }
-                        else
-                        {
-                            ratColVals[j] = outRATVals.at(j-1)[i];
-                        }
+                        ratColVals[j] = clumpCatVals[((j-1)*numInBands)+i];
                     }
-                    attUtils.writeIntColumn(rat, "ClumpVal_"+txtUtils.sizettostring(i+1), ratColVals, numRows);
-                }
-                delete[] ratColVals;
-                
-                for(size_t i = 0; i < outRATVals.size(); ++i)
-                {
-                    delete[] outRATVals.at(i);
+                    attUtils.writeIntColumn(rat, "ClumpVal_"+txtUtils.sizettostring(i+1), ratColVals.data(), numRows);
                 }
             }
             
             GDALClose(clumpsDS);
             
-            delete[] catPxlVals;
-            delete[] catCPxlVals;
-            
             delete[] catBands;
             for(unsigned int i = 0; i < numInBands; ++i)
             {
@@ -614,6 +300,503 @@ namespace rsgis{namespace segment{
         }
     }
     
+    unsigned long RSGISClumpPxls::performTwoPassClump(std::vector<GDALRasterBand*> &catBands, std::vector<std::pair<int, int> > &bandOffsets, GDALRasterBand *clumpBand, unsigned int width, unsigned int height, bool noDataValProvided, unsigned int noDataVal, std::vector<unsigned int> *clumpCatVals, unsigned int nThreads)
+    {
+        unsigned int numBands = catBands.size();
+        
+        // The image is processed as tiles of whole rows (a block of the output image high),
+        // where a batch of tiles (one per thread) is held in memory at a time.
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        clumpBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int tileRows = (yBlockSize > 0)?yBlockSize:1;
+        if(tileRows > height)
+        {
+            tileRows = height;
+        }
+        size_t tilePxls = ((size_t)width) * tileRows;
+        
+        // The labels are only held as 64 bit integers when the output band is 64 bit.
+        bool labels64 = (clumpBand->GetRasterDataType() == GDT_UInt64);
+        
+        rsgis::RSGISThreadPool threadPool(nThreads);
+        unsigned int nBatchTiles = threadPool.getNumThreads();
+        std::vector<RSGISClumpTile> tiles(nBatchTiles);
+        for(unsigned int t = 0; t < nBatchTiles; ++t)
+        {
+            tiles[t].catVals.resize(numBands, std::vector<unsigned int>(tilePxls));
+            tiles[t].labels.resize(tilePxls);
+            if(labels64)
+            {
+                tiles[t].labels64.resize(tilePxls);
+            }
+        }
+        
+        // The last row of the previous tile so clumps can be joined across the tile boundaries.
+        std::vector<std::vector<unsigned int> > prevCatRow(numBands, std::vector<unsigned int>(width));
+        std::vector<unsigned long> prevLabelRow(width, 0);
+        
+        // Global union-find equivalence table for the tile labels (offset by the number of
+        // labels in the previous tiles), where label 0 is no data. The root of each set is
+        // always the smallest label in the set, which is the label of the clump's first pixel
+        // (in scan order) as tiles are numbered from the top of the image.
+        std::vector<unsigned long> parent;
+        parent.push_back(0);
+        std::vector<unsigned int> provCatVals;
+        
+        unsigned int nTiles = (height + tileRows - 1) / tileRows;
+        
+        // Pass 1: label the tiles in parallel and then join them at the tile boundaries.
+        rsgis_tqdm pbar;
+        for(unsigned int batchStart = 0; batchStart < nTiles; batchStart += nBatchTiles)
+        {
+            unsigned int nTilesInBatch = std::min(nBatchTiles, nTiles - batchStart);
+            pbar.progress((batchStart*tileRows)/2, height);
+            
+            for(unsigned int t = 0; t < nTilesInBatch; ++t)
+            {
+                tiles[t].rowStart = (batchStart + t) * tileRows;
+                tiles[t].nRows = std::min(tileRows, height - tiles[t].rowStart);
+                for(unsigned int n = 0; n < numBands; ++n)
+                {
+                    catBands[n]->RasterIO(GF_Read, bandOffsets[n].first, bandOffsets[n].second+tiles[t].rowStart, width, tiles[t].nRows, tiles[t].catVals[n].data(), width, tiles[t].nRows, GDT_UInt32, 0, 0);
+                }
+            }
+            
+            threadPool.parallelFor(0, nTilesInBatch, [&](unsigned int threadIdx, size_t tStart, size_t tEnd)
+            {
+                for(size_t t = tStart; t < tEnd; ++t)
+                {
+                    this->labelClumpTile(&tiles[t], numBands, width, noDataValProvided, noDataVal);
+                }
+            });
+            
+            for(unsigned int t = 0; t < nTilesInBatch; ++t)
+            {
+                RSGISClumpTile *tile = &tiles[t];
+                unsigned long labelOffset = parent.size() - 1;
+                if((!labels64) && ((labelOffset + tile->numLabels) > std::numeric_limits<unsigned int>::max()))
+                {
+                    throw rsgis::img::RSGISImageCalcException("The number of provisional clump labels has exceeded the range of the output image data type, use a 64 bit (GDT_UInt64) clumps image.");
+                }
+                for(unsigned long l = 1; l <= tile->numLabels; ++l)
+                {
+                    parent.push_back(labelOffset + l);
+                }
+                provCatVals.insert(provCatVals.end(), tile->labelCatVals.begin(), tile->labelCatVals.end());
+                
+                size_t nPxls = ((size_t)width) * tile->nRows;
+                if(labels64)
+                {
+                    for(size_t i = 0; i < nPxls; ++i)
+                    {
+                        tile->labels64[i] = (tile->labels[i] != 0)?(((uint64_t)tile->labels[i]) + labelOffset):0;
+                    }
+                }
+                else
+                {
+                    for(size_t i = 0; i < nPxls; ++i)
+                    {
+                        if(tile->labels[i] != 0)
+                        {
+                            tile->labels[i] += labelOffset;
+                        }
+                    }
+                }
+                auto tileLabel = [&](size_t i) -> unsigned long
+                {
+                    return labels64?tile->labels64[i]:tile->labels[i];
+                };
+                
+                if(tile->rowStart > 0)
+                {
+                    for(unsigned int c = 0; c < width; ++c)
+                    {
+                        if((prevLabelRow[c] == 0) || (tileLabel(c) == 0))
+                        {
+                            continue;
+                        }
+                        bool catsEqual = true;
+                        for(unsigned int n = 0; n < numBands; ++n)
+                        {
+                            if(prevCatRow[n][c] != tile->catVals[n][c])
+                            {
+                                catsEqual = false;
+                                break;
+                            }
+                        }
+                        if(catsEqual)
+                        {
+                            unsigned long rootA = this->findClumpRoot(parent, prevLabelRow[c]);
+                            unsigned long rootB = this->findClumpRoot(parent, tileLabel(c));
+                            if(rootA < rootB)
+                            {
+                                parent[rootB] = rootA;
+                            }
+                            else if(rootB < rootA)
+                            {
+                                parent[rootA] = rootB;
+                            }
+                        }
+                    }
+                }
+                
+                if(labels64)
+                {
+                    clumpBand->RasterIO(GF_Write, 0, tile->rowStart, width, tile->nRows, tile->labels64.data(), width, tile->nRows, GDT_UInt64, 0, 0);
+                }
+                else
+                {
+                    clumpBand->RasterIO(GF_Write, 0, tile->rowStart, width, tile->nRows, tile->labels.data(), width, tile->nRows, GDT_UInt32, 0, 0);
+                }
+                
+                size_t lastRowOff = ((size_t)(tile->nRows-1)) * width;
+                for(unsigned int n = 0; n < numBands; ++n)
+                {
+                    std::copy(tile->catVals[n].begin()+lastRowOff, tile->catVals[n].begin()+lastRowOff+width, prevCatRow[n].begin());
+                }
+                for(unsigned int c = 0; c < width; ++c)
+                {
+                    prevLabelRow[c] = tileLabel(lastRowOff+c);
+                }
+            }
+        }
+        
+        // Pass 2: resolve the equivalences and relabel the provisional labels.
+        unsigned long numClumps = 0;
+        if(labels64)
+        {
+            numClumps = this->resolveClumpLabels<uint64_t>(parent, provCatVals, numBands, clumpCatVals, clumpBand, width, height, tileRows, GDT_UInt64, pbar);
+        }
+        else
+        {
+            numClumps = this->resolveClumpLabels<unsigned int>(parent, provCatVals, numBands, clumpCatVals, clumpBand, width, height, tileRows, GDT_UInt32, pbar);
+        }
+        pbar.finish();
+        
+        return numClumps;
+    }
+    
+    template <typename LabelT> unsigned long RSGISClumpPxls::resolveClumpLabels(std::vector<unsigned long> &parent, std::vector<unsigned int> &provCatVals, unsigned int numBands, std::vector<unsigned int> *clumpCatVals, GDALRasterBand *clumpBand, unsigned int width, unsigned int height, unsigned int tileRows, GDALDataType labelType, rsgis_tqdm &pbar)
+    {
+        // Resolve the equivalences to consecutive final labels. As roots are the smallest
+        // label in each set, they are always resolved before the labels which reference them.
+        std::vector<LabelT> finalLabels(parent.size(), 0);
+        unsigned long numClumps = 0;
+        for(unsigned long l = 1; l < parent.size(); ++l)
+        {
+            unsigned long root = this->findClumpRoot(parent, l);
+            if(root == l)
+            {
+                finalLabels[l] = ++numClumps;
+                if(clumpCatVals != NULL)
+                {
+                    for(unsigned int n = 0; n < numBands; ++n)
+                    {
+                        clumpCatVals->push_back(provCatVals.at(((l-1)*numBands)+n));
+                    }
+                }
+            }
+            else
+            {
+                finalLabels[l] = finalLabels[root];
+            }
+        }
+        std::vector<unsigned long>().swap(parent);
+        std::vector<unsigned int>().swap(provCatVals);
+        
+        std::vector<LabelT> labelStrip(((size_t)width) * tileRows);
+        unsigned int nTiles = (height + tileRows - 1) / tileRows;
+        for(unsigned int s = 0; s < nTiles; ++s)
+        {
+            unsigned int rowStart = s * tileRows;
+            unsigned int nRows = std::min(tileRows, height - rowStart);
+            pbar.progress((height+rowStart)/2, height);
+            
+            clumpBand->RasterIO(GF_Read, 0, rowStart, width, nRows, labelStrip.data(), width, nRows, labelType, 0, 0);
+            size_t nPxls = ((size_t)width) * nRows;
+            for(size_t i = 0; i < nPxls; ++i)
+            {
+                labelStrip[i] = finalLabels[labelStrip[i]];
+            }
+            clumpBand->RasterIO(GF_Write, 0, rowStart, width, nRows, labelStrip.data(), width, nRows, labelType, 0, 0);
+        }
+        return numClumps;
+    }
+    
+    unsigned long RSGISClumpPxls::performTupleLabelling(std::vector<GDALRasterBand*> &catBands, std::vector<std::pair<int, int> > &bandOffsets, GDALRasterBand *clumpBand, unsigned int width, unsigned int height, bool noDataValProvided, unsigned int noDataVal, std::vector<unsigned int> *clumpCatVals, unsigned int nThreads)
+    {
+        unsigned int numBands = catBands.size();
+        
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        clumpBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), width, height, sizeof(unsigned int)*(numBands+1), rsgis::RSGISExecutionContextUtils::getDefaultContext().stripMemoryMB);
+        size_t stripPxls = ((size_t)width) * stripRows;
+        
+        std::vector<std::vector<unsigned int> > catVals(numBands, std::vector<unsigned int>(stripPxls));
+        std::vector<unsigned int> labels(stripPxls);
+        // The IDs are only held as 64 bit integers when the output band is 64 bit.
+        bool labels64 = (clumpBand->GetRasterDataType() == GDT_UInt64);
+        std::vector<uint64_t> labelsOut64;
+        if(labels64)
+        {
+            labelsOut64.resize(stripPxls);
+        }
+        
+        rsgis::RSGISThreadPool threadPool(nThreads);
+        unsigned int nChunks = threadPool.getNumThreads();
+        std::vector<RSGISClumpTupleTable> chunkTables(nChunks, RSGISClumpTupleTable(numBands));
+        std::vector<std::vector<unsigned long> > chunkGlobalIDs(nChunks);
+        RSGISClumpTupleTable globalTable(numBands);
+        
+        rsgis_tqdm pbar;
+        for(unsigned int rowStart = 0; rowStart < height; rowStart += stripRows)
+        {
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            size_t nPxls = ((size_t)width) * nRows;
+            pbar.progress(rowStart, height);
+            
+            for(unsigned int n = 0; n < numBands; ++n)
+            {
+                catBands[n]->RasterIO(GF_Read, bandOffsets[n].first, bandOffsets[n].second+rowStart, width, nRows, catVals[n].data(), width, nRows, GDT_UInt32, 0, 0);
+            }
+            
+            // Label each chunk of pixels with IDs local to the chunk's table.
+            size_t chunkPxls = (nPxls + nChunks - 1) / nChunks;
+            threadPool.parallelFor(0, nChunks, [&](unsigned int threadIdx, size_t cStart, size_t cEnd)
+            {
+                std::vector<unsigned int> tuple(numBands);
+                for(size_t c = cStart; c < cEnd; ++c)
+                {
+                    RSGISClumpTupleTable &table = chunkTables[c];
+                    table.clear();
+                    size_t pStart = std::min(nPxls, c * chunkPxls);
+                    size_t pEnd = std::min(nPxls, pStart + chunkPxls);
+                    uint64_t prevKey = 0;
+                    unsigned long prevID = 0;
+                    for(size_t i = pStart; i < pEnd; ++i)
+                    {
+                        bool noData = noDataValProvided;
+                        for(unsigned int n = 0; n < numBands; ++n)
+                        {
+                            tuple[n] = catVals[n][i];
+                            noData = noData && (tuple[n] == noDataVal);
+                        }
+                        if(noData)
+                        {
+                            labels[i] = 0;
+                            continue;
+                        }
+                        
+                        // Neighbouring pixels are usually in the same clump in every band.
+                        uint64_t key = RSGISClumpTupleTable::createKey(tuple.data(), numBands);
+                        if((prevID == 0) || (key != prevKey) || !std::equal(tuple.begin(), tuple.end(), table.getTuple(prevID)))
+                        {
+                            prevID = table.findOrInsert(tuple.data(), key);
+                            prevKey = key;
+                        }
+                        labels[i] = prevID;
+                    }
+                }
+            });
+            
+            // Merge the chunk tables in order, so IDs follow the raster scan order.
+            for(unsigned int c = 0; c < nChunks; ++c)
+            {
+                RSGISClumpTupleTable &table = chunkTables[c];
+                std::vector<unsigned long> &globalIDs = chunkGlobalIDs[c];
+                globalIDs.assign(table.getNumTuples()+1, 0);
+                for(unsigned long l = 1; l <= table.getNumTuples(); ++l)
+                {
+                    const unsigned int *tuple = table.getTuple(l);
+                    unsigned long globalID = globalTable.findOrInsert(tuple, RSGISClumpTupleTable::createKey(tuple, numBands));
+                    if((!labels64) && (globalID > std::numeric_limits<unsigned int>::max()))
+                    {
+                        throw rsgis::img::RSGISImageCalcException("The number of unique clump tuples has exceeded the range of the output image data type, use a 64 bit (GDT_UInt64) clumps image.");
+                    }
+                    globalIDs[l] = globalID;
+                }
+            }
+            
+            threadPool.parallelFor(0, nChunks, [&](unsigned int threadIdx, size_t cStart, size_t cEnd)
+            {
+                for(size_t c = cStart; c < cEnd; ++c)
+                {
+                    const std::vector<unsigned long> &globalIDs = chunkGlobalIDs[c];
+                    size_t pStart = std::min(nPxls, c * chunkPxls);
+                    size_t pEnd = std::min(nPxls, pStart + chunkPxls);
+                    if(labels64)
+                    {
+                        for(size_t i = pStart; i < pEnd; ++i)
+                        {
+                            labelsOut64[i] = globalIDs[labels[i]];
+                        }
+                    }
+                    else
+                    {
+                        for(size_t i = pStart; i < pEnd; ++i)
+                        {
+                            labels[i] = globalIDs[labels[i]];
+                        }
+                    }
+                }
+            });
+            
+            if(labels64)
+            {
+                clumpBand->RasterIO(GF_Write, 0, rowStart, width, nRows, labelsOut64.data(), width, nRows, GDT_UInt64, 0, 0);
+            }
+            else
+            {
+                clumpBand->RasterIO(GF_Write, 0, rowStart, width, nRows, labels.data(), width, nRows, GDT_UInt32, 0, 0);
+            }
+        }
+        pbar.finish();
+        
+        unsigned long numClumps = globalTable.getNumTuples();
+        if(clumpCatVals != NULL)
+        {
+            clumpCatVals->reserve(clumpCatVals->size() + (numClumps * numBands));
+            for(unsigned long l = 1; l <= numClumps; ++l)
+            {
+                clumpCatVals->insert(clumpCatVals->end(), globalTable.getTuple(l), globalTable.getTuple(l) + numBands);
+            }
+        }
+        
+        return numClumps;
+    }
+    
+    void RSGISClumpPxls::labelClumpTile(RSGISClumpTile *tile, unsigned int numBands, unsigned int width, bool noDataValProvided, unsigned int noDataVal)
+    {
+        std::vector<unsigned long> parent;
+        parent.push_back(0);
+        std::vector<unsigned int> labelCatVals;
+        
+        auto catsEqual = [&](size_t idxA, size_t idxB)
+        {
+            for(unsigned int n = 0; n < numBands; ++n)
+            {
+                if(tile->catVals[n][idxA] != tile->catVals[n][idxB])
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+        
+        std::vector<unsigned int> &labels = tile->labels;
+        for(unsigned int r = 0; r < tile->nRows; ++r)
+        {
+            for(unsigned int c = 0; c < width; ++c)
+            {
+                size_t idx = (((size_t)r) * width) + c;
+                
+                bool noData = false;
+                if(noDataValProvided)
+                {
+                    noData = true;
+                    for(unsigned int n = 0; n < numBands; ++n)
+                    {
+                        if(tile->catVals[n][idx] != noDataVal)
+                        {
+                            noData = false;
+                            break;
+                        }
+                    }
+                }
+                if(noData)
+                {
+                    labels[idx] = 0;
+                    continue;
+                }
+                
+                unsigned long leftLabel = 0;
+                unsigned long aboveLabel = 0;
+                if((c > 0) && (labels[idx-1] != 0) && catsEqual(idx-1, idx))
+                {
+                    leftLabel = labels[idx-1];
+                }
+                if((r > 0) && (labels[idx-width] != 0) && catsEqual(idx-width, idx))
+                {
+                    aboveLabel = labels[idx-width];
+                }
+                
+                if((leftLabel == 0) && (aboveLabel == 0))
+                {
+                    unsigned long newLabel = parent.size();
+                    parent.push_back(newLabel);
+                    for(unsigned int n = 0; n < numBands; ++n)
+                    {
+                        labelCatVals.push_back(tile->catVals[n][idx]);
+                    }
+                    labels[idx] = newLabel;
+                }
+                else if(aboveLabel == 0)
+                {
+                    labels[idx] = leftLabel;
+                }
+                else
+                {
+                    labels[idx] = aboveLabel;
+                    if((leftLabel != 0) && (leftLabel != aboveLabel))
+                    {
+                        unsigned long rootA = this->findClumpRoot(parent, leftLabel);
+                        unsigned long rootB = this->findClumpRoot(parent, aboveLabel);
+                        if(rootA < rootB)
+                        {
+                            parent[rootB] = rootA;
+                        }
+                        else if(rootB < rootA)
+                        {
+                            parent[rootA] = rootB;
+                        }
+                    }
+                }
+            }
+        }
+        
+        // Compact the tile labels to 1..n, keeping the order of the first pixel of each clump.
+        std::vector<unsigned int> tileLabels(parent.size(), 0);
+        tile->numLabels = 0;
+        tile->labelCatVals.clear();
+        for(unsigned long l = 1; l < parent.size(); ++l)
+        {
+            unsigned long root = this->findClumpRoot(parent, l);
+            if(root == l)
+            {
+                tileLabels[l] = ++tile->numLabels;
+                tile->labelCatVals.insert(tile->labelCatVals.end(), labelCatVals.begin()+((l-1)*numBands), labelCatVals.begin()+(l*numBands));
+            }
+            else
+            {
+                tileLabels[l] = tileLabels[root];
+            }
+        }
+        
+        size_t nPxls = ((size_t)width) * tile->nRows;
+        for(size_t i = 0; i < nPxls; ++i)
+        {
+            labels[i] = tileLabels[labels[i]];
+        }
+    }
+    
+    unsigned long RSGISClumpPxls::findClumpRoot(std::vector<unsigned long> &parent, unsigned long label)
+    {
+        unsigned long root = label;
+        while(parent[root] != root)
+        {
+            root = parent[root];
+        }
+        while(parent[label] != root)
+        {
+            unsigned long next = parent[label];
+            parent[label] = root;
+            label = next;
+        }
+        return root;
+    }
+    
     bool RSGISClumpPxls::allValueEqual(unsigned int *vals, unsigned int numVals, unsigned int equalVal)
     {
         for(unsigned int i = 0; i < numVals; ++i)
@@ -759,6 +942,12 @@ namespace rsgis{namespace segment{
                 throw rsgis::img::RSGISImageCalcException("Heights are not the same");
             }
             
+            if(catagories->GetRasterBand(1)->GetRasterDataType() == GDT_UInt64)
+            {
+                this->relabelClumps64(catagories, clumps);
+                return;
+            }
+            
             std::cout << "Finding maximum image value\n";
             rsgis::rastergis::RSGISRasterAttUtils ratUtils;
             long minVal = 0;
@@ -781,12 +970,10 @@ namespace rsgis{namespace segment{
             
             
             std::cout << "Applying Look up table.\n";
-            RSGISApplyRelabelLookupTable *applyLookUp = new RSGISApplyRelabelLookupTable(clumpIdxLookUp, maxClumpIdx);
-            rsgis::img::RSGISCalcImage calcImgApplyLookUp = rsgis::img::RSGISCalcImage(applyLookUp);
-            calcImgApplyLookUp.calcImage(&catagories, 1, 0, clumps);
-            delete applyLookUp;
-            
+            std::vector<uint32_t> relabelLUT(clumpIdxLookUp, clumpIdxLookUp+maxClumpIdx);
             delete[] clumpIdxLookUp;
+            rsgis::img::RSGISRelabelImageLUT relabelImg;
+            relabelImg.relabelImage(catagories, 1, clumps, 1, relabelLUT);
             
         }
         catch(rsgis::img::RSGISImageCalcException &e)
@@ -803,6 +990,95 @@ namespace rsgis{namespace segment{
         }
     }
     
+    void RSGISRelabelClumps::relabelClumps(uint32_t *clumps, size_t nPxls)
+    {
+        uint32_t maxVal = 0;
+        for(size_t i = 0; i < nPxls; ++i)
+        {
+            if(clumps[i] > maxVal)
+            {
+                maxVal = clumps[i];
+            }
+        }
+        
+        std::vector<uint32_t> relabelLUT(((size_t)maxVal)+1, 0);
+        uint32_t nextVal = 1;
+        for(size_t i = 0; i < nPxls; ++i)
+        {
+            if((clumps[i] > 0) && (relabelLUT[clumps[i]] == 0))
+            {
+                relabelLUT[clumps[i]] = nextVal++;
+            }
+        }
+        
+        for(size_t i = 0; i < nPxls; ++i)
+        {
+            clumps[i] = relabelLUT[clumps[i]];
+        }
+    }
+    
+    void RSGISRelabelClumps::relabelClumps64(GDALDataset *catagories, GDALDataset *clumps)
+    {
+        unsigned int width = catagories->GetRasterXSize();
+        unsigned int height = catagories->GetRasterYSize();
+        if((width == 0) || (height == 0))
+        {
+            return;
+        }
+        GDALRasterBand *catagoryBand = catagories->GetRasterBand(1);
+        
+        rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        catagoryBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), width, height, sizeof(uint64_t), context.stripMemoryMB);
+        std::vector<uint64_t> clumpIdxs(((size_t)width) * stripRows);
+        
+        std::cout << "Finding maximum image value\n";
+        uint64_t maxVal = 0;
+        rsgis_tqdm pbar;
+        for(unsigned int rowStart = 0; rowStart < height; rowStart += stripRows)
+        {
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            size_t nPxls = ((size_t)width) * nRows;
+            pbar.progress(rowStart, height);
+            catagoryBand->RasterIO(GF_Read, 0, rowStart, width, nRows, clumpIdxs.data(), width, nRows, GDT_UInt64, 0, 0);
+            maxVal = std::max(maxVal, *std::max_element(clumpIdxs.begin(), clumpIdxs.begin()+nPxls));
+        }
+        pbar.finish();
+        
+        // Number the clumps in the order they are first found, where 0 is not changed.
+        std::cout << "Creating Look up table.\n";
+        std::vector<uint64_t> relabelLUT(maxVal+1, 0);
+        uint64_t nextVal = 1;
+        pbar.reset();
+        for(unsigned int rowStart = 0; rowStart < height; rowStart += stripRows)
+        {
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            size_t nPxls = ((size_t)width) * nRows;
+            pbar.progress(rowStart, height);
+            catagoryBand->RasterIO(GF_Read, 0, rowStart, width, nRows, clumpIdxs.data(), width, nRows, GDT_UInt64, 0, 0);
+            for(size_t i = 0; i < nPxls; ++i)
+            {
+                if((clumpIdxs[i] > 0) && (relabelLUT[clumpIdxs[i]] == 0))
+                {
+                    relabelLUT[clumpIdxs[i]] = nextVal++;
+                }
+            }
+        }
+        pbar.finish();
+        std::vector<uint64_t>().swap(clumpIdxs);
+        
+        if(((nextVal-1) > std::numeric_limits<unsigned int>::max()) && (clumps->GetRasterBand(1)->GetRasterDataType() != GDT_UInt64))
+        {
+            throw rsgis::img::RSGISImageCalcException("The number of clumps has exceeded the range of the output image data type, use a 64 bit (GDT_UInt64) output image.");
+        }
+        
+        std::cout << "Applying Look up table.\n";
+        rsgis::img::RSGISRelabelImageLUT relabelImg(context.numThreads);
+        relabelImg.relabelImage(catagories, 1, clumps, 1, relabelLUT);
+    }
+    
     RSGISRelabelClumps::~RSGISRelabelClumps()
     {
         
@@ -27,16 +27,22 @@
 #include <vector>
 #include <queue>
 #include <cmath>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
 
 #include "gdal_priv.h"
 
 #include "common/rsgis-tqdm.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
 
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISImageCalcException.h"
 
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISRelabelImageLUT.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
 
@@ -57,15 +63,106 @@
 
 namespace rsgis{namespace segment{
 
+    /**
+     * A tile of whole image rows used by the two-pass clumping. The labels are local
+     * to the tile, and labels64 holds the image wide labels when the output is 64 bit.
+     */
+    struct DllExport RSGISClumpTile
+    {
+        unsigned int rowStart;
+        unsigned int nRows;
+        std::vector<std::vector<unsigned int> > catVals;
+        std::vector<unsigned int> labels;
+        std::vector<uint64_t> labels64;
+        unsigned long numLabels;
+        std::vector<unsigned int> labelCatVals;
+    };
+
+    /**
+     * An open-addressing (linear probing) hash table which assigns consecutive IDs,
+     * from 1, to tuples of numBands category values in the order they are first
+     * inserted. Each tuple is folded into a 64-bit key (an exact packing for up to
+     * two values) which is compared before the tuple itself.
+     */
+    class DllExport RSGISClumpTupleTable
+    {
+    public:
+        RSGISClumpTupleTable(unsigned int numBands);
+        /** Return the ID of the tuple, adding it with the next ID if it is not in the table. */
+        unsigned long findOrInsert(const unsigned int *tuple, uint64_t key);
+        unsigned long getNumTuples() const {return this->numTuples;};
+        /** The values of the tuple with the ID (1..getNumTuples()). */
+        const unsigned int* getTuple(unsigned long id) const {return this->tuples.data() + ((id-1) * this->numBands);};
+        void clear();
+        static uint64_t createKey(const unsigned int *tuple, unsigned int numBands);
+        ~RSGISClumpTupleTable(){};
+    protected:
+        void rehash(size_t numSlots);
+        unsigned int numBands;
+        unsigned long numTuples;
+        size_t slotMask;
+        std::vector<uint64_t> slotKeys;
+        std::vector<unsigned long> slotIDs;
+        std::vector<unsigned int> tuples;
+    };
+
     class DllExport RSGISClumpPxls
     {
     public:
         RSGISClumpPxls();
-        void performClump(GDALDataset *catagories, GDALDataset *clumps, bool noDataValProvided, unsigned int noDataVal, std::vector<unsigned int> *clumpPxlVals=NULL);
+        /**
+         * Clump the first band of catagories into clumps. If nThreads > 1 tiles of the
+         * image are labelled concurrently and joined using a global equivalence table,
+         * giving the same output as nThreads = 1. If the clumps band is GDT_UInt64 the
+         * labels are read and written as 64 bit integers, otherwise as 32 bit integers.
+         */
+        void performClump(GDALDataset *catagories, GDALDataset *clumps, bool noDataValProvided, unsigned int noDataVal, std::vector<unsigned int> *clumpPxlVals=NULL, unsigned int nThreads=1);
         void performClumpPosVals(GDALDataset *catagories, GDALDataset *clumps);
-        void performMultiBandClump(std::vector<GDALDataset*> *catagories, std::string clumpsOutputPath, std::string outFormat, bool noDataValProvided, unsigned int noDataVal, bool addRatPxlVals=false);
+        /**
+         * Take the union of the category images. Usually the output is each 4-connected
+         * region of pixels with the same values in all the bands. If tupleIDs is true
+         * then the output has one ID per unique tuple of band values, numbered in the
+         * order they are first found in a raster scan, whether or not the pixels are
+         * connected. This is a single streaming pass over the images. The output is
+         * GDT_UInt64 if the image has more pixels than can be labelled with GDT_UInt32.
+         */
+        void performMultiBandClump(std::vector<GDALDataset*> *catagories, std::string clumpsOutputPath, std::string outFormat, bool noDataValProvided, unsigned int noDataVal, bool addRatPxlVals=false, bool tupleIDs=false, unsigned int nThreads=1);
+        /**
+         * The data type for a clumps image of the size. There cannot be more clumps than
+         * pixels so GDT_UInt32 is used unless the image has more pixels than it can label.
+         */
+        static GDALDataType getClumpsDataType(unsigned int width, unsigned int height)
+        {
+            return ((((uint64_t)width) * height) > std::numeric_limits<unsigned int>::max())?GDT_UInt64:GDT_UInt32;
+        };
         ~RSGISClumpPxls();
     protected:
+        /**
+         * Two-pass (union-find) connected component labelling of the category bands,
+         * reading and writing the data in tiles of whole rows. Each batch of tiles is
+         * labelled in parallel (one tile per thread) and the tiles are then joined at
+         * their boundaries. Clumps are 4-connected and labelled 1..n in the order their
+         * first pixel is found in a raster scan, which is the same labelling as the
+         * original region growing implementation. The categories of each clump are
+         * appended to clumpCatVals (numBands values per clump). Returns the number of clumps.
+         */
+        unsigned long performTwoPassClump(std::vector<GDALRasterBand*> &catBands, std::vector<std::pair<int, int> > &bandOffsets, GDALRasterBand *clumpBand, unsigned int width, unsigned int height, bool noDataValProvided, unsigned int noDataVal, std::vector<unsigned int> *clumpCatVals, unsigned int nThreads=1);
+        /**
+         * Label each pixel with the ID of its tuple of category values in a single pass
+         * over strips of the image. The rows of each strip are split into chunks which
+         * are labelled in parallel with a hash table per chunk, and the chunk tables are
+         * then merged in order so the IDs are the same for any number of threads. The
+         * category values of each ID are appended to clumpCatVals. Returns the number of IDs.
+         */
+        unsigned long performTupleLabelling(std::vector<GDALRasterBand*> &catBands, std::vector<std::pair<int, int> > &bandOffsets, GDALRasterBand *clumpBand, unsigned int width, unsigned int height, bool noDataValProvided, unsigned int noDataVal, std::vector<unsigned int> *clumpCatVals, unsigned int nThreads=1);
+        /**
+         * Resolve the provisional labels to the final consecutive labels, appending the
+         * categories of each clump to clumpCatVals, and relabel the clumps band reading
+         * and writing the labels as LabelT (labelType). Returns the number of clumps.
+         */
+        template <typename LabelT> unsigned long resolveClumpLabels(std::vector<unsigned long> &parent, std::vector<unsigned int> &provCatVals, unsigned int numBands, std::vector<unsigned int> *clumpCatVals, GDALRasterBand *clumpBand, unsigned int width, unsigned int height, unsigned int tileRows, GDALDataType labelType, rsgis_tqdm &pbar);
+        void labelClumpTile(RSGISClumpTile *tile, unsigned int numBands, unsigned int width, bool noDataValProvided, unsigned int noDataVal);
+        unsigned long findClumpRoot(std::vector<unsigned long> &parent, unsigned long label);
         inline bool allValueEqual(unsigned int *vals, unsigned int numVals, unsigned int equalVal);
         inline bool allValueEqual(unsigned int *vals1, unsigned int *vals2, unsigned int numVals);
     };
@@ -75,8 +172,16 @@ namespace rsgis{namespace segment{
     public:
         RSGISRelabelClumps();
         void relabelClumps(GDALDataset *catagories, GDALDataset *clumps);
+        /**
+         * Relabel the clumps to 1..n in the order they are first found. If the categories
+         * band is a 64 bit integer type the labels are read and written as 64 bit integers.
+         */
         void relabelClumpsCalcImg(GDALDataset *catagories, GDALDataset *clumps);
+        /** Relabel the clumps within an array in place, numbering from 1 in the order the clumps are first found (0 is not changed). */
+        void relabelClumps(uint32_t *clumps, size_t nPxls);
         ~RSGISRelabelClumps();
+    protected:
+        void relabelClumps64(GDALDataset *catagories, GDALDataset *clumps);
     };
     
     class DllExport RSGISCreateRelabelLookupTable : public rsgis::img::RSGISCalcImageValue
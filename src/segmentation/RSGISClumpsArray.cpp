@@ -0,0 +1,150 @@
+/*
+ *  RSGISClumpsArray.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISClumpsArray.h"
+
+#ifndef _MSC_VER
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+#endif
+
+namespace rsgis{namespace segment{
+
+    RSGISClumpsArray::RSGISClumpsArray(GDALDataset *clumps, unsigned int band)
+    {
+        if((band == 0) || (band > ((unsigned int)clumps->GetRasterCount())))
+        {
+            throw rsgis::RSGISImageException("The clumps band is not within the image.");
+        }
+        this->clumpBand = clumps->GetRasterBand(band);
+        this->width = clumps->GetRasterXSize();
+        this->height = clumps->GetRasterYSize();
+        this->data = NULL;
+        this->mapped = false;
+        this->mapFD = -1;
+        this->mapBytes = ((size_t)this->width) * ((size_t)this->height) * sizeof(unsigned int);
+
+        unsigned int maxMemoryMB = rsgis::RSGISExecutionContextUtils::getOutOfCoreMemoryMB();
+#ifndef _MSC_VER
+        if((maxMemoryMB > 0) && (this->mapBytes > (((size_t)maxMemoryMB) * 1024 * 1024)))
+        {
+            std::string clumpsFile = clumps->GetDescription();
+            if((clumpsFile == "") || (std::string(clumps->GetDriver()->GetDescription()) == "MEM"))
+            {
+                this->mapFile = std::string(CPLGenerateTempFilename("rsgisclumps"));
+            }
+            else
+            {
+                this->mapFile = clumpsFile + ".rsgisclumps";
+            }
+
+            this->mapFD = open(this->mapFile.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+            if(this->mapFD < 0)
+            {
+                throw rsgis::RSGISImageException("Could not create the clumps array file: " + this->mapFile);
+            }
+            void *mapData = MAP_FAILED;
+            if(ftruncate(this->mapFD, (off_t)this->mapBytes) == 0)
+            {
+                mapData = mmap(NULL, this->mapBytes, PROT_READ | PROT_WRITE, MAP_SHARED, this->mapFD, 0);
+            }
+            if(mapData == MAP_FAILED)
+            {
+                close(this->mapFD);
+                std::remove(this->mapFile.c_str());
+                throw rsgis::RSGISImageException("Could not memory-map the clumps array file: " + this->mapFile);
+            }
+            this->data = static_cast<unsigned int*>(mapData);
+            this->mapped = true;
+        }
+#endif
+        if(!this->mapped)
+        {
+            this->memData.resize(((size_t)this->width) * ((size_t)this->height));
+            this->data = this->memData.data();
+        }
+
+        try
+        {
+            this->readBand();
+        }
+        catch(rsgis::RSGISImageException &e)
+        {
+#ifndef _MSC_VER
+            if(this->mapped)
+            {
+                munmap(this->data, this->mapBytes);
+                close(this->mapFD);
+                std::remove(this->mapFile.c_str());
+            }
+#endif
+            throw e;
+        }
+    }
+
+    void RSGISClumpsArray::readBand()
+    {
+        // Read in strips of the image blocks so the cache is not thrashed.
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        this->clumpBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = std::max(yBlockSize, 1);
+        for(unsigned int y = 0; y < this->height; y += stripRows)
+        {
+            unsigned int nRows = std::min(stripRows, this->height - y);
+            if(this->clumpBand->RasterIO(GF_Read, 0, y, this->width, nRows, &this->data[((size_t)y)*this->width], this->width, nRows, GDT_UInt32, 0, 0) != CE_None)
+            {
+                throw rsgis::RSGISImageException("Could not read the clumps image band.");
+            }
+        }
+    }
+
+    void RSGISClumpsArray::flush()
+    {
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        this->clumpBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = std::max(yBlockSize, 1);
+        for(unsigned int y = 0; y < this->height; y += stripRows)
+        {
+            unsigned int nRows = std::min(stripRows, this->height - y);
+            if(this->clumpBand->RasterIO(GF_Write, 0, y, this->width, nRows, &this->data[((size_t)y)*this->width], this->width, nRows, GDT_UInt32, 0, 0) != CE_None)
+            {
+                throw rsgis::RSGISImageException("Could not write the clumps image band.");
+            }
+        }
+    }
+
+    RSGISClumpsArray::~RSGISClumpsArray()
+    {
+#ifndef _MSC_VER
+        if(this->mapped)
+        {
+            munmap(this->data, this->mapBytes);
+            close(this->mapFD);
+            std::remove(this->mapFile.c_str());
+        }
+#endif
+    }
+
+}}
@@ -0,0 +1,95 @@
+/*
+ *  RSGISClumpsArray.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISClumpsArray_H
+#define RSGISClumpsArray_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISImageException.h"
+#include "common/RSGISExecutionContext.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_segmentation_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace segment{
+
+    /**
+     * A band of a clumps image held as a uint32 array so the random neighbour
+     * reads and writes of the segmentation algorithms are array lookups rather
+     * than a RasterIO call per pixel. The values are read when the array is
+     * created and are only written back to the band by flush().
+     *
+     * If the array is larger than the clumpsMemoryMB (or, if 0, the memoryBudgetMB)
+     * of the default execution context (see
+     * rsgis::RSGISExecutionContextUtils::getOutOfCoreMemoryMB) it is a memory-mapped
+     * temporary file (the clumps image file name + '.rsgisclumps', or a GDAL
+     * temporary file for in-memory datasets) which is removed when the array is
+     * deleted, so the operating system pages it to and from disk. Memory-mapped
+     * files are not supported on Windows, where the array is always in memory.
+     */
+    class DllExport RSGISClumpsArray
+    {
+    public:
+        RSGISClumpsArray(GDALDataset *clumps, unsigned int band=1);
+        unsigned int getWidth(){return this->width;};
+        unsigned int getHeight(){return this->height;};
+        bool isMemoryMapped(){return this->mapped;};
+        unsigned int getValue(unsigned int x, unsigned int y){return this->data[(((size_t)y)*this->width)+x];};
+        void setValue(unsigned int x, unsigned int y, unsigned int val){this->data[(((size_t)y)*this->width)+x] = val;};
+        /** The values, where the value of column x and row y is at (y*width)+x. */
+        unsigned int* getData(){return this->data;};
+        /** Write the values back to the band of the clumps image. */
+        void flush();
+        ~RSGISClumpsArray();
+    protected:
+        void readBand();
+        GDALRasterBand *clumpBand;
+        unsigned int width;
+        unsigned int height;
+        unsigned int *data;
+        std::vector<unsigned int> memData;
+        bool mapped;
+        std::string mapFile;
+        int mapFD;
+        size_t mapBytes;
+    };
+
+}}
+
+#endif
@@ -27,7 +27,10 @@ namespace rsgis{namespace segment{
 
     RSGISCreateImageGrid::RSGISCreateImageGrid()
     {
-        
+        rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+        this->numThreads = context.numThreads;
+        this->numIOBuffers = context.numIOBuffers;
+        this->stripMemoryMB = context.stripMemoryMB;
     }
     
     void RSGISCreateImageGrid::createClumpsGrid(GDALDataset *clumpsImage, unsigned int numXPxls, unsigned int numYPxls)
@@ -41,6 +44,10 @@ namespace rsgis{namespace segment{
             {
                 throw RSGISImageException("Data must only have 1 image band.");
             }
+            if((numXPxls == 0) || (numYPxls == 0))
+            {
+                throw rsgis::img::RSGISImageCalcException("The tile size must be at least 1 pixel.");
+            }
             
             unsigned int numFullCols = (width/numXPxls);
             unsigned int extraColsPxls = width - (numFullCols * numXPxls);
@@ -58,52 +65,22 @@ namespace rsgis{namespace segment{
                 ++numRows;
             }
             
-            unsigned int numTiles = numRows * numCols;
+            unsigned long numTiles = ((unsigned long)numRows) * numCols;
             
             std::cout << "Num Tiles [" << numCols << ", " << numRows << "] = " << numTiles << std::endl;
             
-            unsigned int startPxlXIdx = 0;
-            unsigned int startPxlYIdx = 0;
-            unsigned int endPxlXIdx = 0;
-            unsigned int endPxlYIdx = 0;
-            unsigned int tileID = 1;
-            for(unsigned int i = 0; i < numFullRows; ++i)
+            std::vector<unsigned int> colIdxs(width);
+            for(unsigned long x = 0; x < width; ++x)
             {
-                startPxlYIdx = i * numYPxls;
-                endPxlYIdx = startPxlYIdx + numYPxls;
-                for(unsigned int j = 0; j < numFullCols; ++j)
-                {
-                    startPxlXIdx = j * numXPxls;
-                    endPxlXIdx = startPxlXIdx + numXPxls;
-                    this->writeImagePxlVal2Region(clumpsImage, tileID++, startPxlXIdx, endPxlXIdx, startPxlYIdx, endPxlYIdx);
-                }
-                
-                if(extraColsPxls > 0)
-                {
-                    startPxlXIdx = numFullCols * numXPxls;
-                    endPxlXIdx = startPxlXIdx + extraColsPxls;
-                    this->writeImagePxlVal2Region(clumpsImage, tileID++, startPxlXIdx, endPxlXIdx, startPxlYIdx, endPxlYIdx);
-                }
+                colIdxs[x] = x / numXPxls;
             }
-            
-            if(extraRowsPxls > 0)
+            std::vector<unsigned int> rowIdxs(height);
+            for(unsigned long y = 0; y < height; ++y)
             {
-                startPxlYIdx = numFullRows * numYPxls;
-                endPxlYIdx = startPxlYIdx + extraRowsPxls;
-                for(unsigned int j = 0; j < numFullCols; ++j)
-                {
-                    startPxlXIdx = j * numXPxls;
-                    endPxlXIdx = startPxlXIdx + numXPxls;
-                    this->writeImagePxlVal2Region(clumpsImage, tileID++, startPxlXIdx, endPxlXIdx, startPxlYIdx, endPxlYIdx);
-                }
-                
-                if(extraColsPxls > 0)
-                {
-                    startPxlXIdx = numFullCols * numXPxls;
-                    endPxlXIdx = startPxlXIdx + extraColsPxls;
-                    this->writeImagePxlVal2Region(clumpsImage, tileID++, startPxlXIdx, endPxlXIdx, startPxlYIdx, endPxlYIdx);
-                }
+                rowIdxs[y] = y / numYPxls;
             }
+            
+            this->writeGridLabels(clumpsImage, colIdxs, rowIdxs, numCols, numRows);
         }
         catch(rsgis::img::RSGISImageCalcException &e)
         {
@@ -128,6 +105,10 @@ namespace rsgis{namespace segment{
             {
                 throw RSGISImageException("Data must only have 1 image band.");
             }
+            if((numXPxls == 0) || (numYPxls == 0))
+            {
+                throw rsgis::img::RSGISImageCalcException("The tile size must be at least 1 pixel.");
+            }
             
             unsigned int hNumXPxls = numXPxls/2;
             unsigned int hNumYPxls = numYPxls/2;
@@ -151,90 +132,23 @@ namespace rsgis{namespace segment{
                 numRows += 1;
             }
             
-            unsigned int numTiles = numRows * numCols;
+            unsigned long numTiles = ((unsigned long)numRows) * numCols;
             
             std::cout << "Num Tiles [" << numCols << ", " << numRows << "] = " << numTiles << std::endl;
             
-            unsigned int startPxlXIdx = 0;
-            unsigned int startPxlYIdx = 0;
-            unsigned int endPxlXIdx = 0;
-            unsigned int endPxlYIdx = 0;
-            unsigned int tileID = 1;
-            
-            // First row of half tiles
-            startPxlYIdx = 0;
-            endPxlYIdx = hNumYPxls;
-            
-            // First tile in row.
-            startPxlXIdx = 0;
-            endPxlXIdx = hNumXPxls;
-            
-            this->writeImagePxlVal2Region(clumpsImage, tileID++, startPxlXIdx, endPxlXIdx, startPxlYIdx, endPxlYIdx);
-            
-            for(unsigned int j = 0; j < numFullCols; ++j)
+            // Column (and row) 0 is the half tile, which is empty for a tile size of 1.
+            std::vector<unsigned int> colIdxs(width);
+            for(unsigned long x = 0; x < width; ++x)
             {
-                startPxlXIdx = (j * numXPxls) + hNumXPxls;
-                endPxlXIdx = startPxlXIdx + numXPxls;
-                this->writeImagePxlVal2Region(clumpsImage, tileID++, startPxlXIdx, endPxlXIdx, startPxlYIdx, endPxlYIdx);
+                colIdxs[x] = (x < hNumXPxls)?0:(1 + ((x - hNumXPxls) / numXPxls));
             }
-            
-            if(extraColsPxls > 0)
+            std::vector<unsigned int> rowIdxs(height);
+            for(unsigned long y = 0; y < height; ++y)
             {
-                startPxlXIdx = hNumXPxls + (numFullCols * numXPxls);
-                endPxlXIdx = startPxlXIdx + extraColsPxls;
-                this->writeImagePxlVal2Region(clumpsImage, tileID++, startPxlXIdx, endPxlXIdx, startPxlYIdx, endPxlYIdx);
+                rowIdxs[y] = (y < hNumYPxls)?0:(1 + ((y - hNumYPxls) / numYPxls));
             }
             
-            
-            for(unsigned int i = 0; i < numFullRows; ++i)
-            {
-                startPxlYIdx = (i * numYPxls) + hNumYPxls;
-                endPxlYIdx = startPxlYIdx + numYPxls;
-                
-                // First tile in row.
-                startPxlXIdx = 0;
-                endPxlXIdx = hNumXPxls;
-                this->writeImagePxlVal2Region(clumpsImage, tileID++, startPxlXIdx, endPxlXIdx, startPxlYIdx, endPxlYIdx);
-                
-                for(unsigned int j = 0; j < numFullCols; ++j)
-                {
-                    startPxlXIdx = (j * numXPxls) + hNumXPxls;
-                    endPxlXIdx = startPxlXIdx + numXPxls;
-                    this->writeImagePxlVal2Region(clumpsImage, tileID++, startPxlXIdx, endPxlXIdx, startPxlYIdx, endPxlYIdx);
-                }
-                
-                if(extraColsPxls > 0)
-                {
-                    startPxlXIdx = hNumXPxls + (numFullCols * numXPxls);
-                    endPxlXIdx = startPxlXIdx + extraColsPxls;
-                    this->writeImagePxlVal2Region(clumpsImage, tileID++, startPxlXIdx, endPxlXIdx, startPxlYIdx, endPxlYIdx);
-                }
-            }
-            
-            if(extraRowsPxls > 0)
-            {
-                startPxlYIdx = hNumYPxls + (numFullRows * numYPxls);
-                endPxlYIdx = startPxlYIdx + extraRowsPxls;
-                
-                // First tile in row.
-                startPxlXIdx = 0;
-                endPxlXIdx = hNumXPxls;
-                this->writeImagePxlVal2Region(clumpsImage, tileID++, startPxlXIdx, endPxlXIdx, startPxlYIdx, endPxlYIdx);
-                
-                for(unsigned int j = 0; j < numFullCols; ++j)
-                {
-                    startPxlXIdx = (j * numXPxls) + hNumXPxls;
-                    endPxlXIdx = startPxlXIdx + numXPxls;
-                    this->writeImagePxlVal2Region(clumpsImage, tileID++, startPxlXIdx, endPxlXIdx, startPxlYIdx, endPxlYIdx);
-                }
-                
-                if(extraColsPxls > 0)
-                {
-                    startPxlXIdx = hNumXPxls + (numFullCols * numXPxls);
-                    endPxlXIdx = startPxlXIdx + extraColsPxls;
-                    this->writeImagePxlVal2Region(clumpsImage, tileID++, startPxlXIdx, endPxlXIdx, startPxlYIdx, endPxlYIdx);
-                }
-            }
+            this->writeGridLabels(clumpsImage, colIdxs, rowIdxs, numCols, numRows);
         }
         catch(rsgis::img::RSGISImageCalcException &e)
         {
@@ -242,25 +156,60 @@ namespace rsgis{namespace segment{
         }
     }
     
-    void RSGISCreateImageGrid::writeImagePxlVal2Region(GDALDataset *clumpsImage, unsigned int pxlVal, unsigned int startX, unsigned int endX, unsigned int startY, unsigned int endY) 
+    void RSGISCreateImageGrid::writeGridLabels(GDALDataset *clumpsImage, const std::vector<unsigned int> &colIdxs, const std::vector<unsigned int> &rowIdxs, unsigned int numCols, unsigned int numRows)
     {
-        try
+        if((((unsigned long)numRows) * numCols) > std::numeric_limits<unsigned int>::max())
         {
-            unsigned int blockWidth = endX - startX;
-            unsigned int blockHeight = endY - startY;
-            unsigned int blockSize = blockWidth * blockHeight;
-            unsigned int *block = new unsigned int[blockSize];
-            for(unsigned int i = 0; i < blockSize; ++i)
-            {
-                block[i] = pxlVal;
-            }
-            clumpsImage->GetRasterBand(1)->RasterIO(GF_Write, startX, startY, blockWidth, blockHeight, block, blockWidth, blockHeight, GDT_UInt32, 0, 0);
-            delete[] block;
+            throw rsgis::img::RSGISImageCalcException("The number of tiles exceeds the range of the output image data type.");
         }
-        catch(rsgis::img::RSGISImageCalcException &e)
+        
+        GDALRasterBand *clumpBand = clumpsImage->GetRasterBand(1);
+        unsigned int width = colIdxs.size();
+        unsigned int height = rowIdxs.size();
+        if((width == 0) || (height == 0))
         {
-            throw e;
+            return;
         }
+        
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        clumpBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), width, height, sizeof(unsigned int), this->stripMemoryMB);
+        size_t nStrips = (height + stripRows - 1) / stripRows;
+        
+        // There is nothing to read, so with more than one buffer the strips are computed while the previous strips are written.
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        rsgis::RSGISStripIOPipeline ioPipeline(this->numIOBuffers);
+        std::vector<std::vector<unsigned int> > stripLabels(ioPipeline.getNumBuffers(), std::vector<unsigned int>(((size_t)width) * stripRows));
+        
+        rsgis_tqdm pbar;
+        ioPipeline.run(nStrips, [&](size_t strip, unsigned int buf){},
+        [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            pbar.progress(rowStart, height);
+            unsigned int *labels = stripLabels[buf].data();
+            threadPool.parallelFor(0, nRows, [&](unsigned int threadIdx, size_t rStart, size_t rEnd)
+            {
+                for(size_t r = rStart; r < rEnd; ++r)
+                {
+                    unsigned int rowLabel = (rowIdxs[rowStart + r] * numCols) + 1;
+                    unsigned int *rowLabels = labels + (r * width);
+                    for(unsigned int x = 0; x < width; ++x)
+                    {
+                        rowLabels[x] = rowLabel + colIdxs[x];
+                    }
+                }
+            });
+        },
+        [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            clumpBand->RasterIO(GF_Write, 0, rowStart, width, nRows, stripLabels[buf].data(), width, nRows, GDT_UInt32, 0, 0);
+        });
+        pbar.finish();
     }
 
     RSGISCreateImageGrid::~RSGISCreateImageGrid()
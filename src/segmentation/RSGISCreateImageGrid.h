@@ -27,8 +27,15 @@
 #include <string>
 #include <cmath>
 #include <stdlib.h>
+#include <vector>
+#include <limits>
+#include <algorithm>
 
 #include "common/RSGISAttributeTableException.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISStripIOPipeline.h"
+#include "common/rsgis-tqdm.h"
 
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISImageCalcException.h"
@@ -57,15 +64,26 @@
 namespace rsgis{namespace segment{
     
     
+    /**
+     * Create regular grids of clumps. The label of each pixel is computed from its
+     * column and row of the grid (tiles are numbered from 1 along the rows), so the
+     * image is written in strips in parallel using the threads, strip memory and
+     * I/O buffers of the default execution context.
+     */
     class DllExport RSGISCreateImageGrid
     {
     public:
         RSGISCreateImageGrid();
         void createClumpsGrid(GDALDataset *clumpsImage, unsigned int numXPxls, unsigned int numYPxls);
+        /** As createClumpsGrid but the first row and column of tiles are half the size. */
         void createClumpsOffsetGrid(GDALDataset *clumpsImage, unsigned int numXPxls, unsigned int numYPxls);
         ~RSGISCreateImageGrid();
     protected:
-        void writeImagePxlVal2Region(GDALDataset *clumpsImage, unsigned int pxlVal, unsigned int startX, unsigned int endX, unsigned int startY, unsigned int endY);
+        /** Write label (rowIdxs[y] * numCols) + colIdxs[x] + 1 to each pixel of the image. */
+        void writeGridLabels(GDALDataset *clumpsImage, const std::vector<unsigned int> &colIdxs, const std::vector<unsigned int> &rowIdxs, unsigned int numCols, unsigned int numRows);
+        unsigned int numThreads;
+        unsigned int numIOBuffers;
+        unsigned int stripMemoryMB;
     };
     
     
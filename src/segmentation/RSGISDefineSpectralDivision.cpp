@@ -29,22 +29,42 @@ namespace rsgis{namespace segment{
     
     RSGISDefineSpectralDivision::RSGISDefineSpectralDivision()
     {
-        
+        rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+        this->numThreads = context.numThreads;
+        this->numIOBuffers = context.numIOBuffers;
+        this->stripMemoryMB = context.stripMemoryMB;
     }
         
     void RSGISDefineSpectralDivision::findSpectralDivision(GDALDataset *inData, std::string outputImage, unsigned int subDivision, float noDataVal, bool noDataValProvided, bool projFromImage, std::string proj, std::string format)
     {
         try
         {
+            if(subDivision == 0)
+            {
+                throw rsgis::img::RSGISImageCalcException("The number of subdivisions must be greater than zero.");
+            }
+            
             GDALDataset **datasets = new GDALDataset*[1];
             datasets[0] = inData;
             
+            int numBands = inData->GetRasterCount();
+            
+            unsigned long long numCatsCheck = subDivision;
+            for(int n = 0; n < numBands-1; ++n)
+            {
+                numCatsCheck *= subDivision;
+                if(numCatsCheck > std::numeric_limits<unsigned int>::max())
+                {
+                    delete[] datasets;
+                    throw rsgis::img::RSGISImageCalcException("The number of categories is too large to be represented in the output image.");
+                }
+            }
+            unsigned int numCats = numCatsCheck;
+            
             rsgis::img::RSGISImageUtils imgUtils;
             
             GDALDataset *outImageDataset = imgUtils.createCopy(inData, 1, outputImage, format, GDT_UInt32, projFromImage, proj);
-            imgUtils.zerosUIntGDALDataset(outImageDataset);
             
-            int numBands = inData->GetRasterCount();
             rsgis::img::ImageStats **stats = new rsgis::img::ImageStats*[numBands];
             for(int n = 0; n < numBands; ++n)
             {
@@ -60,16 +80,8 @@ namespace rsgis{namespace segment{
             rsgis::img::RSGISImageStatistics imgStats;
             imgStats.calcImageStatistics(datasets, 1, stats, numBands, false);
             
-            unsigned int numCats = subDivision;
-            for(int n = 0; n < numBands-1; ++n)
-            {
-                numCats *= subDivision;
-            }
-            
             std::cout << "Generating " << numCats << " categories\n";
             
-            
-            std::vector<std::pair<float, float> > **catThresholds = new std::vector<std::pair<float, float> >*[numBands];
             std::vector<std::pair<float, float> > **bandThresholds = new std::vector<std::pair<float, float> >*[numBands];
             
             float bandStep = 0;
@@ -77,8 +89,6 @@ namespace rsgis{namespace segment{
             float bandMax = 0;
             for(int n = 0; n < numBands; ++n)
             {
-                catThresholds[n] = new std::vector<std::pair<float, float> >();
-                catThresholds[n]->reserve(numCats);
                 bandThresholds[n] = new std::vector<std::pair<float, float> >();
                 bandThresholds[n]->reserve(subDivision);
                 bandStep = (stats[n]->max - stats[n]->min)/subDivision;
@@ -92,39 +102,17 @@ namespace rsgis{namespace segment{
                 }
             }
             
-            std::pair<float, float> *pThreshold = NULL;
-            for(unsigned j = 0; j < subDivision; ++j)
-            {
-                pThreshold = new std::pair<float, float>[numBands];
-                for(int n = 0; n < numBands; ++n)
-                {
-                    pThreshold[n] = std::pair<float, float>(0,0);
-                }
-                pThreshold[0] = std::pair<float,float>(bandThresholds[0]->at(j).first, bandThresholds[0]->at(j).second);
-                
-                this->generateSpectralDivThresholds(pThreshold, 1, numBands, subDivision, bandThresholds, catThresholds);
-            }
-            
-            std::cout << "Number of categories: " << catThresholds[0]->size() << std::endl;
-            
-            if(catThresholds[0]->size() != numCats)
-            {
-                throw rsgis::img::RSGISImageCalcException("The number of categories generated is not what was expected.");
-            }
-            
             std::cout << "Applying to output image\n";
-            this->assignToCategory(inData, outImageDataset, catThresholds, numBands, numCats, noDataVal, noDataValProvided);
+            this->assignToCategory(inData, outImageDataset, bandThresholds, numBands, subDivision, numCats, noDataVal, noDataValProvided);
             
             std::cout << "Completed\n";
             GDALClose(outImageDataset);
             for(int n = 0; n < numBands; ++n)
             {
-                delete catThresholds[n];
                 delete bandThresholds[n];
                 delete stats[n];
             }
             delete[] stats;
-            delete[] catThresholds;
             delete[] bandThresholds;
             delete[] datasets;
         }
@@ -134,40 +122,7 @@ namespace rsgis{namespace segment{
         }
     }
     
-    void RSGISDefineSpectralDivision::generateSpectralDivThresholds(std::pair<float, float> *pThreshold, unsigned int bandIdx, unsigned int numBands, unsigned int subDivision, std::vector<std::pair<float, float> > **bandThresholds, std::vector<std::pair<float, float> > **catThresholds)
-    {
-        if(bandIdx == numBands)
-        {
-            for(unsigned int n = 0; n < numBands; ++n)
-            {
-                catThresholds[n]->push_back(std::pair<float, float>(pThreshold[n].first, pThreshold[n].second));
-            }
-        }
-        else
-        {
-            std::pair<float, float> *cThreshold = NULL;
-            for(unsigned j = 0; j < subDivision; ++j)
-            {
-                cThreshold = new std::pair<float, float>[numBands];
-                for(unsigned int n = 0; n < numBands; ++n)
-                {
-                    cThreshold[n] = std::pair<float, float>(0,0);
-                }
-                for(unsigned int n = 0; n < bandIdx; ++n)
-                {
-                    cThreshold[n] = std::pair<float, float>(pThreshold[n].first, pThreshold[n].second);
-                }
-                
-                cThreshold[bandIdx] = std::pair<float,float>(bandThresholds[bandIdx]->at(j).first, bandThresholds[bandIdx]->at(j).second);
-                
-                this->generateSpectralDivThresholds(cThreshold, bandIdx+1, numBands, subDivision, bandThresholds, catThresholds);
-            }
-        }
-        
-        delete[] pThreshold;
-    }
-    
-    void RSGISDefineSpectralDivision::assignToCategory(GDALDataset *reflDataset, GDALDataset *catsDataset, std::vector<std::pair<float, float> > **catThresholds, unsigned int numBands, unsigned int numCats, float noDataVal, bool noDataValProvided)
+    void RSGISDefineSpectralDivision::assignToCategory(GDALDataset *reflDataset, GDALDataset *catsDataset, std::vector<std::pair<float, float> > **bandThresholds, unsigned int numBands, unsigned int subDivision, unsigned int numCats, float noDataVal, bool noDataValProvided)
     {
         try 
         {
@@ -188,88 +143,119 @@ namespace rsgis{namespace segment{
             
             unsigned int width = reflDataset->GetRasterXSize();
             unsigned int height = reflDataset->GetRasterYSize();
+            if((width == 0) || (height == 0))
+            {
+                return;
+            }
             
-            unsigned int *catData = new unsigned int[width];
-            float **reflData = new float*[numBands];
+            // Per band interval edges for the binary search and the mixed-radix
+            // place value of each band (the first band most significant).
+            std::vector<std::vector<float> > lowerEdges(numBands);
+            std::vector<std::vector<float> > upperEdges(numBands);
+            std::vector<unsigned int> placeVals(numBands, 1);
+            for(unsigned int n = 0; n < numBands; ++n)
+            {
+                for(unsigned int j = 0; j < subDivision; ++j)
+                {
+                    lowerEdges[n].push_back(bandThresholds[n]->at(j).first);
+                    upperEdges[n].push_back(bandThresholds[n]->at(j).second);
+                }
+            }
+            for(int n = ((int)numBands)-2; n >= 0; --n)
+            {
+                placeVals[n] = placeVals[n+1] * subDivision;
+            }
             
             GDALRasterBand *catBand = catsDataset->GetRasterBand(1);
             GDALRasterBand **reflBands = new GDALRasterBand*[numBands];
-            
             for(unsigned int n = 0; n < numBands; ++n)
             {
                 reflBands[n] = reflDataset->GetRasterBand(n+1);
-                reflData[n] = new float[width];
             }
             
-            bool foundCat = true;
-            bool noDataFound = false;
-            for(unsigned int i = 0; i < height; ++i)
+            int xBlockSize = 0;
+            int yBlockSize = 0;
+            reflBands[0]->GetBlockSize(&xBlockSize, &yBlockSize);
+            unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), width, height, (sizeof(float)*numBands)+sizeof(unsigned int), this->stripMemoryMB);
+            size_t stripPxls = ((size_t)width) * stripRows;
+            size_t nStrips = (height + stripRows - 1) / stripRows;
+            
+            rsgis::RSGISThreadPool threadPool(this->numThreads);
+            rsgis::RSGISStripIOPipeline ioPipeline(this->numIOBuffers);
+            unsigned int nBufs = ioPipeline.getNumBuffers();
+            std::vector<std::vector<float> > reflData(nBufs, std::vector<float>(stripPxls*numBands));
+            std::vector<std::vector<unsigned int> > catData(nBufs, std::vector<unsigned int>(stripPxls));
+            
+            rsgis_tqdm pbar;
+            ioPipeline.run(nStrips, [&](size_t strip, unsigned int buf)
             {
+                unsigned int rowStart = strip * stripRows;
+                unsigned int nRows = std::min(stripRows, height - rowStart);
+                size_t nPxls = ((size_t)width) * nRows;
                 for(unsigned int n = 0; n < numBands; ++n)
                 {
-                    reflBands[n]->RasterIO(GF_Read, 0, i, width, 1, reflData[n], width, 1, GDT_Float32, 0, 0);
+                    reflBands[n]->RasterIO(GF_Read, 0, rowStart, width, nRows, reflData[buf].data()+(n*nPxls), width, nRows, GDT_Float32, 0, 0);
                 }
-                
-                for(unsigned int j = 0; j < width; ++j)
+            },
+            [&](size_t strip, unsigned int buf)
+            {
+                unsigned int rowStart = strip * stripRows;
+                unsigned int nRows = std::min(stripRows, height - rowStart);
+                size_t nPxls = ((size_t)width) * nRows;
+                pbar.progress(rowStart, height);
+                const float *refl = reflData[buf].data();
+                unsigned int *cats = catData[buf].data();
+                threadPool.parallelFor(0, nPxls, [&](unsigned int threadIdx, size_t pStart, size_t pEnd)
                 {
-                    noDataFound = false;
-                    if(noDataValProvided)
+                    for(size_t i = pStart; i < pEnd; ++i)
                     {
-                        noDataFound = true;
-                        for(unsigned int n = 0; n < numBands; ++n)
+                        bool noDataFound = false;
+                        if(noDataValProvided)
                         {
-                            if(reflData[n][j] != noDataVal)
-                            {
-                                noDataFound = false;
-                                break;
-                            }
-                        }
-                    }
-                    
-                    if(noDataFound)
-                    {
-                        catData[j] = 0;
-                    }
-                    else
-                    {
-                        for(unsigned int c = 0; c < numCats; ++c)
-                        {
-                            foundCat = true;
+                            noDataFound = true;
                             for(unsigned int n = 0; n < numBands; ++n)
                             {
-                                if((reflData[n][j] < catThresholds[n]->at(c).first) | (reflData[n][j] > catThresholds[n]->at(c).second))
+                                if(refl[(n*nPxls)+i] != noDataVal)
                                 {
-                                    foundCat = false;
+                                    noDataFound = false;
                                     break;
                                 }
                             }
-                            
-                            if(foundCat)
-                            {
-                                catData[j] = c+1;
-                                break;
-                            }
                         }
                         
-                        if(!foundCat)
+                        if(noDataFound)
                         {
-                            catData[j] = numCats;
+                            cats[i] = 0;
+                            continue;
                         }
+                        
+                        // A pixel outside the intervals of any band is not within any
+                        // category and is given the value numCats.
+                        unsigned int catIdx = 0;
+                        bool foundCat = true;
+                        for(unsigned int n = 0; n < numBands; ++n)
+                        {
+                            unsigned int bandIdx = findBandInterval(refl[(n*nPxls)+i], lowerEdges[n], upperEdges[n]);
+                            if(bandIdx == subDivision)
+                            {
+                                foundCat = false;
+                                break;
+                            }
+                            catIdx += bandIdx * placeVals[n];
+                        }
+                        cats[i] = foundCat?(catIdx+1):numCats;
                     }
-                }
-                
-                catBand->RasterIO(GF_Write, 0, i, width, 1, catData, width, 1, GDT_UInt32, 0, 0);
-            }
-            
-            
-            delete[] catData;
-            for(unsigned int n = 0; n < numBands; ++n)
+                });
+            },
+            [&](size_t strip, unsigned int buf)
             {
-                delete[] reflData[n];
-            }
-            delete[] reflData;
-            delete[] reflBands;
+                unsigned int rowStart = strip * stripRows;
+                unsigned int nRows = std::min(stripRows, height - rowStart);
+                catBand->RasterIO(GF_Write, 0, rowStart, width, nRows, catData[buf].data(), width, nRows, GDT_UInt32, 0, 0);
+            });
+            pbar.finish();
             
+            delete[] reflBands;
         } 
         catch (RSGISException &e) 
         {
@@ -27,8 +27,15 @@
 #include <string>
 #include <cmath>
 #include <stdlib.h>
+#include <vector>
+#include <algorithm>
+#include <limits>
 
 #include "common/RSGISAttributeTableException.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISStripIOPipeline.h"
+#include "common/rsgis-tqdm.h"
 
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISImageCalcException.h"
@@ -58,15 +65,42 @@
 
 namespace rsgis{namespace segment{
     
+    /**
+     * Divide the spectral space into subDivision equal intervals per band and label each
+     * pixel with the category (from 1) of the box it falls within. Rather than testing each
+     * pixel against the list of every category, each band value is quantised to its interval
+     * index with a binary search of the band's interval edges and the category is formed as
+     * a mixed-radix number of those indexes (the first band most significant), so the cost
+     * is linear in the pixels whatever the number of categories. Strips of the image are
+     * processed in parallel using the threads, strip memory and I/O buffers of the default
+     * execution context.
+     */
     class DllExport RSGISDefineSpectralDivision
     {
     public:
         RSGISDefineSpectralDivision();
         void findSpectralDivision(GDALDataset *inData, std::string outputImage, unsigned int subDivision, float noDataVal, bool noDataValProvided, bool projFromImage, std::string proj, std::string format);
         ~RSGISDefineSpectralDivision();
+        /**
+         * Return the interval index of val within the band intervals ([lower, upper] inclusive,
+         * contiguous and ascending), with a value on an edge given to the lower interval. If
+         * val is not within any interval the number of intervals is returned. As with the
+         * interval tests this replaces, a NaN value is given the first interval.
+         */
+        static unsigned int findBandInterval(float val, const std::vector<float> &lowerEdges, const std::vector<float> &upperEdges)
+        {
+            unsigned int idx = std::lower_bound(upperEdges.begin(), upperEdges.end(), val) - upperEdges.begin();
+            if((idx < upperEdges.size()) && !(val < lowerEdges[idx]))
+            {
+                return idx;
+            }
+            return upperEdges.size();
+        };
     private:
-        void assignToCategory(GDALDataset *reflDataset, GDALDataset *catsDataset, std::vector<std::pair<float, float> > **catThresholds, unsigned int numBands, unsigned int numCats, float noDataVal, bool noDataValProvided);
-        void generateSpectralDivThresholds(std::pair<float, float> *pThreshold, unsigned int bandIdx, unsigned int numBands, unsigned int subDivision, std::vector<std::pair<float, float> > **bandThresholds, std::vector<std::pair<float, float> > **catThresholds);
+        void assignToCategory(GDALDataset *reflDataset, GDALDataset *catsDataset, std::vector<std::pair<float, float> > **bandThresholds, unsigned int numBands, unsigned int subDivision, unsigned int numCats, float noDataVal, bool noDataValProvided);
+        unsigned int numThreads;
+        unsigned int numIOBuffers;
+        unsigned int stripMemoryMB;
     };
     
 }}
@@ -50,7 +50,7 @@ namespace rsgis{namespace segment{
                 throw rsgis::img::RSGISImageCalcException("Number of rows read is not what was expected.");
             }
             
-            size_t *newClumpIds = new size_t[numRows];
+            std::vector<uint32_t> newClumpIds(numRows, 0);
             size_t clumpID = 1;
             for(size_t i = 1; i < numRows; ++i)
             {
@@ -64,10 +64,10 @@ namespace rsgis{namespace segment{
                 }
             }
             
-            RSGISDropClumpsRelabelling *calcImgValRelabel = new RSGISDropClumpsRelabelling(newClumpIds, numRows);
-            rsgis::img::RSGISCalcImage calcImageRelabel(calcImgValRelabel);
-            calcImageRelabel.calcImage(&clumpsImage, 1, 0, outputImage, false, NULL, gdalFormat, GDT_UInt32);
-            delete calcImgValRelabel;
+            delete[] selectCol;
+            
+            rsgis::img::RSGISRelabelImageLUT relabelImg;
+            relabelImg.relabelImage(clumpsImage, ratBand, outputImage, gdalFormat, GDT_UInt32, newClumpIds);
             
             GDALDataset *outClumpsDataset = (GDALDataset *) GDALOpen(outputImage.c_str(), GA_Update);
             if(outClumpsDataset == NULL)
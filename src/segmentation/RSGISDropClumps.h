@@ -36,6 +36,7 @@
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISRelabelImageLUT.h"
 #include "img/RSGISImageStatistics.h"
 
 #include "gdal_priv.h"
@@ -175,6 +175,323 @@ namespace rsgis{namespace segment{
         }
     }
     
+    void RSGISEliminateSinglePixels::eliminateWorklist(GDALDataset *inSpecData, GDALDataset *inClumpsData, std::string outputImage, float noDataVal, bool noDataValProvided, bool projFromImage, std::string proj, std::string format, unsigned int nThreads)
+    {
+        try
+        {
+            rsgis::img::RSGISImageUtils imgUtils;
+            GDALDataset *outData = imgUtils.createCopy(inClumpsData, outputImage, format, GDT_UInt32, projFromImage, proj);
+            this->eliminateWorklist(inSpecData, inClumpsData, outData, noDataVal, noDataValProvided, nThreads);
+            GDALClose(outData);
+        }
+        catch(rsgis::img::RSGISImageCalcException &e)
+        {
+            throw e;
+        }
+        catch(RSGISImageException &e)
+        {
+            throw rsgis::img::RSGISImageCalcException(e.what());
+        }
+    }
+    
+    void RSGISEliminateSinglePixels::eliminateWorklist(GDALDataset *inSpecData, GDALDataset *inClumpsData, GDALDataset *outData, float noDataVal, bool noDataValProvided, unsigned int nThreads)
+    {
+        try
+        {
+            // Check images have the same size!
+            if(inSpecData->GetRasterXSize() != inClumpsData->GetRasterXSize())
+            {
+                throw rsgis::img::RSGISImageCalcException("Widths are not the same (spectral and categories)");
+            }
+            if(inSpecData->GetRasterYSize() != inClumpsData->GetRasterYSize())
+            {
+                throw rsgis::img::RSGISImageCalcException("Heights are not the same (spectral and categories)");
+            }
+            
+            unsigned int width = inClumpsData->GetRasterXSize();
+            unsigned int height = inClumpsData->GetRasterYSize();
+            unsigned int numBands = inSpecData->GetRasterCount();
+            GDALRasterBand *clumpBand = inClumpsData->GetRasterBand(1);
+            
+            // Find the single pixels, i.e., those with no 4-connected neighbour of the same
+            // value (outside of the image is 0, as with the window of eliminateBlocks), and
+            // record the value of them and their neighbours.
+            std::vector<size_t> singles;
+            std::vector< std::pair<size_t, unsigned int> > pxlVals;
+            std::vector< std::vector<unsigned int> > rows(3, std::vector<unsigned int>(width, 0));
+            std::cout << "Find the single pixels\n";
+            rsgis_tqdm pbarFind;
+            clumpBand->RasterIO(GF_Read, 0, 0, width, 1, rows[1].data(), width, 1, GDT_UInt32, 0, 0);
+            for(unsigned int y = 0; y < height; ++y)
+            {
+                pbarFind.progress(y, height);
+                if((y+1) < height)
+                {
+                    clumpBand->RasterIO(GF_Read, 0, y+1, width, 1, rows[2].data(), width, 1, GDT_UInt32, 0, 0);
+                }
+                else
+                {
+                    std::fill(rows[2].begin(), rows[2].end(), 0);
+                }
+                
+                for(unsigned int x = 0; x < width; ++x)
+                {
+                    unsigned int val = rows[1][x];
+                    if(noDataValProvided && (val == noDataVal))
+                    {
+                        continue;
+                    }
+                    if((rows[0][x] == val) || (rows[2][x] == val) || (((x > 0)?rows[1][x-1]:0) == val) || (((x+1 < width)?rows[1][x+1]:0) == val))
+                    {
+                        continue;
+                    }
+                    size_t idx = (((size_t)y)*width)+x;
+                    singles.push_back(idx);
+                    pxlVals.push_back(std::pair<size_t, unsigned int>(idx, val));
+                    if(y > 0)
+                    {
+                        pxlVals.push_back(std::pair<size_t, unsigned int>(idx-width, rows[0][x]));
+                    }
+                    if((y+1) < height)
+                    {
+                        pxlVals.push_back(std::pair<size_t, unsigned int>(idx+width, rows[2][x]));
+                    }
+                    if(x > 0)
+                    {
+                        pxlVals.push_back(std::pair<size_t, unsigned int>(idx-1, rows[1][x-1]));
+                    }
+                    if((x+1) < width)
+                    {
+                        pxlVals.push_back(std::pair<size_t, unsigned int>(idx+1, rows[1][x+1]));
+                    }
+                }
+                std::swap(rows[0], rows[1]);
+                std::swap(rows[1], rows[2]);
+            }
+            pbarFind.finish();
+            std::cout << "There are " << singles.size() << " single pixels within the image\n";
+            
+            std::sort(pxlVals.begin(), pxlVals.end());
+            pxlVals.erase(std::unique(pxlVals.begin(), pxlVals.end()), pxlVals.end());
+            size_t numPxls = pxlVals.size();
+            std::vector<size_t> pxls(numPxls);
+            std::vector<unsigned int> pxlLabels(numPxls);
+            for(size_t i = 0; i < numPxls; ++i)
+            {
+                pxls[i] = pxlVals[i].first;
+                pxlLabels[i] = pxlVals[i].second;
+            }
+            std::vector< std::pair<size_t, unsigned int> >().swap(pxlVals);
+            
+            std::vector<unsigned char> pxlSingle(numPxls, 0);
+            for(std::vector<size_t>::iterator iterPxl = singles.begin(); iterPxl != singles.end(); ++iterPxl)
+            {
+                pxlSingle[findPxl(pxls, *iterPxl)] = 1;
+            }
+            
+            // Read the spectral values of the single pixels and their neighbours, where a
+            // neighbour can only be merged with if it has data.
+            std::vector<float> pxlSpec(numPxls*numBands);
+            std::vector<unsigned char> pxlHasData(numPxls, 1);
+            std::vector<float> specRow(width);
+            size_t pxlStart = 0;
+            while(pxlStart < numPxls)
+            {
+                unsigned int y = pxls[pxlStart] / width;
+                size_t pxlEnd = pxlStart;
+                while((pxlEnd < numPxls) && ((pxls[pxlEnd] / width) == y))
+                {
+                    ++pxlEnd;
+                }
+                for(unsigned int n = 0; n < numBands; ++n)
+                {
+                    inSpecData->GetRasterBand(n+1)->RasterIO(GF_Read, 0, y, width, 1, specRow.data(), width, 1, GDT_Float32, 0, 0);
+                    for(size_t i = pxlStart; i < pxlEnd; ++i)
+                    {
+                        pxlSpec[(i*numBands)+n] = specRow[pxls[i] % width];
+                    }
+                }
+                if(noDataValProvided)
+                {
+                    for(size_t i = pxlStart; i < pxlEnd; ++i)
+                    {
+                        pxlHasData[i] = 0;
+                        for(unsigned int n = 0; n < numBands; ++n)
+                        {
+                            if(pxlSpec[(i*numBands)+n] != noDataVal)
+                            {
+                                pxlHasData[i] = 1;
+                                break;
+                            }
+                        }
+                    }
+                }
+                pxlStart = pxlEnd;
+            }
+            
+            // The position of the 4-connected neighbours (above, below, left and right) of
+            // each pixel within pxls (numPxls if the neighbour is outside the image).
+            std::vector<size_t> pxlNeighbours(numPxls*4, numPxls);
+            for(std::vector<size_t>::iterator iterPxl = singles.begin(); iterPxl != singles.end(); ++iterPxl)
+            {
+                size_t i = findPxl(pxls, *iterPxl);
+                size_t x = (*iterPxl) % width;
+                size_t y = (*iterPxl) / width;
+                if(y > 0)
+                {
+                    pxlNeighbours[(i*4)] = findPxl(pxls, (*iterPxl)-width);
+                }
+                if((y+1) < height)
+                {
+                    pxlNeighbours[(i*4)+1] = findPxl(pxls, (*iterPxl)+width);
+                }
+                if(x > 0)
+                {
+                    pxlNeighbours[(i*4)+2] = findPxl(pxls, (*iterPxl)-1);
+                }
+                if((x+1) < width)
+                {
+                    pxlNeighbours[(i*4)+3] = findPxl(pxls, (*iterPxl)+1);
+                }
+            }
+            
+            std::vector<size_t> worklist;
+            worklist.reserve(singles.size());
+            for(std::vector<size_t>::iterator iterPxl = singles.begin(); iterPxl != singles.end(); ++iterPxl)
+            {
+                worklist.push_back(findPxl(pxls, *iterPxl));
+            }
+            std::vector<size_t>().swap(singles);
+            
+            rsgis::RSGISThreadPool threadPool(nThreads);
+            std::vector<unsigned int> mergeLabels;
+            std::vector<unsigned char> merged;
+            std::vector<size_t> changedPxls;
+            std::vector<unsigned char> queued(numPxls, 0);
+            unsigned long numMerged = 0;
+            unsigned int numRounds = 0;
+            while(!worklist.empty())
+            {
+                ++numRounds;
+                mergeLabels.assign(worklist.size(), 0);
+                merged.assign(worklist.size(), 0);
+                
+                // Only the labels of pixels which are not single are read and only single pixels
+                // are changed, so the pixels of the round are independent.
+                threadPool.parallelFor(0, worklist.size(), [&](unsigned int workerIdx, size_t start, size_t end)
+                {
+                    for(size_t w = start; w < end; ++w)
+                    {
+                        size_t i = worklist[w];
+                        bool first = true;
+                        float minDist = 0;
+                        for(unsigned int k = 0; k < 4; ++k)
+                        {
+                            size_t nIdx = pxlNeighbours[(i*4)+k];
+                            if((nIdx == numPxls) || (pxlSingle[nIdx] == 1) || (pxlHasData[nIdx] == 0))
+                            {
+                                continue;
+                            }
+                            float dist = this->eucDistance(&pxlSpec[i*numBands], &pxlSpec[nIdx*numBands], numBands);
+                            if(first || (dist < minDist))
+                            {
+                                minDist = dist;
+                                mergeLabels[w] = pxlLabels[nIdx];
+                                first = false;
+                            }
+                        }
+                        merged[w] = first?0:1;
+                    }
+                });
+                
+                changedPxls.clear();
+                for(size_t w = 0; w < worklist.size(); ++w)
+                {
+                    if(merged[w] == 1)
+                    {
+                        pxlLabels[worklist[w]] = mergeLabels[w];
+                        pxlSingle[worklist[w]] = 0;
+                        changedPxls.push_back(worklist[w]);
+                        ++numMerged;
+                    }
+                }
+                // A single pixel which now has a neighbour of the same value is no longer single.
+                size_t numMergedPxls = changedPxls.size();
+                for(size_t c = 0; c < numMergedPxls; ++c)
+                {
+                    size_t i = changedPxls[c];
+                    for(unsigned int k = 0; k < 4; ++k)
+                    {
+                        size_t nIdx = pxlNeighbours[(i*4)+k];
+                        if((nIdx != numPxls) && (pxlSingle[nIdx] == 1) && (pxlLabels[nIdx] == pxlLabels[i]))
+                        {
+                            pxlSingle[nIdx] = 0;
+                            changedPxls.push_back(nIdx);
+                        }
+                    }
+                }
+                
+                // Only the single pixels next to a pixel which is no longer single can change.
+                worklist.clear();
+                for(std::vector<size_t>::iterator iterPxl = changedPxls.begin(); iterPxl != changedPxls.end(); ++iterPxl)
+                {
+                    for(unsigned int k = 0; k < 4; ++k)
+                    {
+                        size_t nIdx = pxlNeighbours[((*iterPxl)*4)+k];
+                        if((nIdx != numPxls) && (pxlSingle[nIdx] == 1) && (queued[nIdx] == 0))
+                        {
+                            queued[nIdx] = 1;
+                            worklist.push_back(nIdx);
+                        }
+                    }
+                }
+                std::sort(worklist.begin(), worklist.end());
+                for(std::vector<size_t>::iterator iterPxl = worklist.begin(); iterPxl != worklist.end(); ++iterPxl)
+                {
+                    queued[*iterPxl] = 0;
+                }
+            }
+            std::cout << "Eliminated " << numMerged << " single pixels in " << numRounds << " rounds\n";
+            
+            // Write the output image, updating the values of the single pixels.
+            GDALRasterBand *outBand = outData->GetRasterBand(1);
+            std::vector<unsigned int> outRow(width);
+            size_t pxlIdx = 0;
+            rsgis_tqdm pbarOut;
+            for(unsigned int y = 0; y < height; ++y)
+            {
+                pbarOut.progress(y, height);
+                clumpBand->RasterIO(GF_Read, 0, y, width, 1, outRow.data(), width, 1, GDT_UInt32, 0, 0);
+                size_t rowEnd = ((size_t)(y+1))*width;
+                for(; (pxlIdx < numPxls) && (pxls[pxlIdx] < rowEnd); ++pxlIdx)
+                {
+                    outRow[pxls[pxlIdx] % width] = pxlLabels[pxlIdx];
+                }
+                outBand->RasterIO(GF_Write, 0, y, width, 1, outRow.data(), width, 1, GDT_UInt32, 0, 0);
+            }
+            pbarOut.finish();
+            std::cout << "Complete, all connected single pixels have been removed\n";
+        }
+        catch(rsgis::img::RSGISImageCalcException &e)
+        {
+            throw e;
+        }
+        catch(RSGISImageException &e)
+        {
+            throw rsgis::img::RSGISImageCalcException(e.what());
+        }
+    }
+    
+    size_t RSGISEliminateSinglePixels::findPxl(const std::vector<size_t> &pxls, size_t idx)
+    {
+        std::vector<size_t>::const_iterator iterPxl = std::lower_bound(pxls.begin(), pxls.end(), idx);
+        if((iterPxl == pxls.end()) || ((*iterPxl) != idx))
+        {
+            return pxls.size();
+        }
+        return iterPxl - pxls.begin();
+    }
+    
     unsigned long RSGISEliminateSinglePixels::findSinglePixels(GDALDataset *inClumpsData, GDALDataset *tmpData, float noDataVal, bool noDataValProvided) 
     {
         unsigned long countSingles = 0;
@@ -1161,6 +1478,21 @@ namespace rsgis{namespace segment{
         }
         return dist;
     }
+    
+    float RSGISEliminateSinglePixels::eucDistance(float *vals1, float *vals2, unsigned int numBands)
+    {
+        float dist = 0;
+        for(unsigned int i = 0; i < numBands; ++i)
+        {
+            dist += (vals1[i] - vals2[i]) * (vals1[i] - vals2[i]);
+        }
+        
+        if(dist > 0)
+        {
+            dist = sqrt(dist/numBands);
+        }
+        return dist;
+    }
         
     RSGISEliminateSinglePixels::~RSGISEliminateSinglePixels()
     {
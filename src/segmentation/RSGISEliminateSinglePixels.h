@@ -25,10 +25,13 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <cmath>
 #include <stdlib.h>
 
 #include "common/rsgis-tqdm.h"
+#include "common/RSGISThreadPool.h"
 
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISImageCalcException.h"
@@ -64,11 +67,28 @@ namespace rsgis{namespace segment{
         RSGISEliminateSinglePixels();
         void eliminate(GDALDataset *inSpecData, GDALDataset *inClumpsData, GDALDataset *tmpData, std::string outputImage, float noDataVal, bool noDataValProvided, bool projFromImage, std::string proj, std::string format);
         void eliminateBlocks(GDALDataset *inSpecData, GDALDataset *inClumpsData, GDALDataset *tmpData, std::string outputImage, float noDataVal, bool noDataValProvided, bool projFromImage, std::string proj, std::string format);
+        /**
+         * Eliminates the single pixels as eliminateBlocks does, but the single pixels
+         * (and their neighbours) are found with one pass of the image and then held
+         * in memory and processed as a worklist, rather than passing over the image
+         * until no change occurs. Each round of the worklist is an iteration of
+         * eliminateBlocks, where the single pixels of the round are merged with the
+         * spectrally closest neighbour which was not single at the start of the round,
+         * so the pixels of a round are independent of each other and are processed
+         * with nThreads threads (0 is the number of hardware threads). The next round
+         * is only the single pixels next to those which have changed.
+         */
+        void eliminateWorklist(GDALDataset *inSpecData, GDALDataset *inClumpsData, std::string outputImage, float noDataVal, bool noDataValProvided, bool projFromImage, std::string proj, std::string format, unsigned int nThreads=1);
+        /** As eliminateWorklist but writes into an existing dataset, which may be inClumpsData to update the clumps in place. */
+        void eliminateWorklist(GDALDataset *inSpecData, GDALDataset *inClumpsData, GDALDataset *outData, float noDataVal, bool noDataValProvided, unsigned int nThreads=1);
         ~RSGISEliminateSinglePixels();
     private:
+        /** The position of pixel idx within the sorted pixels, or pxls.size() if it is not present. */
+        static size_t findPxl(const std::vector<size_t> &pxls, size_t idx);
         unsigned long findSinglePixels(GDALDataset *inClumpsData, GDALDataset *tmpData, float noDataVal, bool noDataValProvided);
         bool eliminateSinglePixels(GDALDataset *inSpecData, GDALDataset *inClumpsData, GDALDataset *tmpData, GDALDataset *outDataset, float noDataVal, bool noDataValProvided);
         inline float eucDistance(float **vals1, float **vals2, unsigned int numBands, unsigned int col1, unsigned int col2);
+        inline float eucDistance(float *vals1, float *vals2, unsigned int numBands);
     };
     
     
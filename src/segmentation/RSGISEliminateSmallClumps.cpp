@@ -53,6 +53,8 @@ namespace rsgis{namespace segment{
             spectralVals[n] = new float[width];
         }
         GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
+        // The random neighbour reads and writes are within the clumps array, which is written back at the end.
+        RSGISClumpsArray clumpsArr(clumps, 1);
         
         unsigned int uiPxlVal = 0;
         
@@ -69,11 +71,13 @@ namespace rsgis{namespace segment{
         
         rsgis::img::ImgClump *cClump = NULL;
         rsgis::img::ImgClump *tClump = NULL;
+        // The clumps and their band values are held in an arena which is released with the table.
+        rsgis::RSGISArena clumpArena;
         for(unsigned int i = 0; i < maxClumpIdx; ++i)
         {
-            cClump = new rsgis::img::ImgClump(i+1);
-            cClump->sumVals = new float[numSpecBands];
-            cClump->meanVals = new float[numSpecBands];
+            cClump = clumpArena.create<rsgis::img::ImgClump>(i+1);
+            cClump->sumVals = clumpArena.allocArray<float>(numSpecBands);
+            cClump->meanVals = clumpArena.allocArray<float>(numSpecBands);
             cClump->pxls = new std::vector<rsgis::img::PxlLoc>();
             cClump->active = true;
             for(unsigned int n = 0; n < numSpecBands; ++n)
@@ -121,7 +125,7 @@ namespace rsgis{namespace segment{
         std::cout << "There are " << clumpTable->size() << " clumps. " << smallClumps.size() << " are too small\n";
         
         rsgis::img::PxlLoc tLoc;
-        std::list<unsigned long> neighbours;
+        std::vector<unsigned long> neighbours;
         unsigned long closestNeighbour = 0;
         bool firstNeighbourTested = true;
         float closestNeighbourDist = 0;
@@ -141,14 +145,14 @@ namespace rsgis{namespace segment{
             // Check that the clump was not selected for a merging already and therefore over minimum size...
             if((cClump->active) & (cClump->pxls->size() < minClumpSize))
             {
-                // Get std::list of neighbours.
+                // Get the neighbours.
                 neighbours.clear();
                 for(std::vector<rsgis::img::PxlLoc>::iterator iterPxls = cClump->pxls->begin(); iterPxls != cClump->pxls->end(); ++iterPxls)
                 {
                     // Above
                     if(((long)(*iterPxls).yPos)-1 >= 0)
                     {
-                        clumpBand->RasterIO(GF_Read, (*iterPxls).xPos, (*iterPxls).yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                        uiPxlVal = clumpsArr.getValue((*iterPxls).xPos, (*iterPxls).yPos-1);
                         if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                         {
                             neighbours.push_back(uiPxlVal);
@@ -157,7 +161,7 @@ namespace rsgis{namespace segment{
                     // Below
                     if(((long)(*iterPxls).yPos)+1 < height)
                     {
-                        clumpBand->RasterIO(GF_Read, (*iterPxls).xPos, (*iterPxls).yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                        uiPxlVal = clumpsArr.getValue((*iterPxls).xPos, (*iterPxls).yPos+1);
                         if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                         {
                             neighbours.push_back(uiPxlVal);
@@ -166,7 +170,7 @@ namespace rsgis{namespace segment{
                     // Left
                     if(((long)(*iterPxls).xPos-1) >= 0)
                     {
-                        clumpBand->RasterIO(GF_Read, (*iterPxls).xPos-1, (*iterPxls).yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                        uiPxlVal = clumpsArr.getValue((*iterPxls).xPos-1, (*iterPxls).yPos);
                         if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                         {
                             neighbours.push_back(uiPxlVal);
@@ -175,19 +179,19 @@ namespace rsgis{namespace segment{
                     // Right
                     if(((long)(*iterPxls).xPos+1) < width)
                     {
-                        clumpBand->RasterIO(GF_Read, (*iterPxls).xPos+1, (*iterPxls).yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                        uiPxlVal = clumpsArr.getValue((*iterPxls).xPos+1, (*iterPxls).yPos);
                         if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                         {
                             neighbours.push_back(uiPxlVal);
                         }
                     }
                 }
-                neighbours.sort();
-                neighbours.unique();
+                std::sort(neighbours.begin(), neighbours.end());
+                neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
                 
                 // Decide on which neighbour to measure with.
                 firstNeighbourTested = true;
-                for(std::list<unsigned long>::iterator iterClumps = neighbours.begin(); iterClumps != neighbours.end(); ++iterClumps)
+                for(std::vector<unsigned long>::iterator iterClumps = neighbours.begin(); iterClumps != neighbours.end(); ++iterClumps)
                 {
                     for(unsigned int b = 0; b < numSpecBands; ++b)
                     {
@@ -227,7 +231,7 @@ namespace rsgis{namespace segment{
                             tLoc = cClump->pxls->at(n);
                             tClump->pxls->push_back(tLoc);
                             // Update Pixel Values - in clump image.
-                            clumpBand->RasterIO(GF_Write, tLoc.xPos, tLoc.yPos, 1, 1, &closestNeighbour, 1, 1, GDT_UInt32, 0, 0);
+                            clumpsArr.setValue(tLoc.xPos, tLoc.yPos, closestNeighbour);
                         }
                         for(unsigned int b = 0; b < numSpecBands; ++b)
                         {
@@ -235,8 +239,6 @@ namespace rsgis{namespace segment{
                             tClump->meanVals[b] = tClump->sumVals[b]/tClump->pxls->size();
                         }
                         
-                        delete cClump->sumVals;
-                        delete cClump->meanVals;
                         delete cClump->pxls;
                         cClump->active = false;
 
@@ -256,17 +258,16 @@ namespace rsgis{namespace segment{
         
         
         
+        clumpsArr.flush();
+        
         for(std::vector<rsgis::img::ImgClump*>::iterator iterClumps = clumpTable->begin(); iterClumps != clumpTable->end(); ++iterClumps)
         {
             if((*iterClumps) != NULL)
             {
                 if((*iterClumps)->active)
                 {
-                    delete (*iterClumps)->sumVals;
-                    delete (*iterClumps)->meanVals;
                     delete (*iterClumps)->pxls;
                 }
-                delete (*iterClumps);
             }
         }
         delete clumpTable;
@@ -313,7 +314,8 @@ namespace rsgis{namespace segment{
             }
         }
         
-        GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
+        // The random neighbour reads and writes are within the clumps array, which is written back at the end.
+        RSGISClumpsArray clumpsArr(clumps, 1);
         
         unsigned int uiPxlVal = 0;
         
@@ -330,11 +332,13 @@ namespace rsgis{namespace segment{
         std::cout << "Build clump table\n";
         rsgis::img::ImgClump *cClump = NULL;
         rsgis::img::ImgClump *tClump = NULL;
+        // The clumps and their band values are held in an arena which is released with the table.
+        rsgis::RSGISArena clumpArena;
         for(unsigned int i = 0; i < maxClumpIdx; ++i)
         {
-            cClump = new rsgis::img::ImgClump(i+1);
-            cClump->sumVals = new float[numSpecBands];
-            cClump->meanVals = new float[numSpecBands];
+            cClump = clumpArena.create<rsgis::img::ImgClump>(i+1);
+            cClump->sumVals = clumpArena.allocArray<float>(numSpecBands);
+            cClump->meanVals = clumpArena.allocArray<float>(numSpecBands);
             cClump->pxls = new std::vector<rsgis::img::PxlLoc>();
             cClump->active = true;
             for(unsigned int n = 0; n < numSpecBands; ++n)
@@ -369,7 +373,7 @@ namespace rsgis{namespace segment{
         std::cout << "There are " << clumpTable->size() << " clumps.\n";
         
         rsgis::img::PxlLoc tLoc;
-        std::list<unsigned long> neighbours;
+        std::vector<unsigned long> neighbours;
         unsigned long closestNeighbour = 0;
         bool firstNeighbourTested = true;
         float closestNeighbourDist = 0;
@@ -401,14 +405,14 @@ namespace rsgis{namespace segment{
                 // Check that the clump was not selected for a merging already and therefore over minimum size...
                 if((cClump->active) & (cClump->pxls->size() < minClumpSize))
                 {
-                    // Get std::list of neighbours.
+                    // Get the neighbours.
                     neighbours.clear();
                     for(std::vector<rsgis::img::PxlLoc>::iterator iterPxls = cClump->pxls->begin(); iterPxls != cClump->pxls->end(); ++iterPxls)
                     {
                         // Above
                         if(((long)(*iterPxls).yPos)-1 >= 0)
                         {
-                            clumpBand->RasterIO(GF_Read, (*iterPxls).xPos, (*iterPxls).yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                            uiPxlVal = clumpsArr.getValue((*iterPxls).xPos, (*iterPxls).yPos-1);
                             if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                             {
                                 neighbours.push_back(uiPxlVal);
@@ -417,7 +421,7 @@ namespace rsgis{namespace segment{
                         // Below
                         if(((long)(*iterPxls).yPos)+1 < height)
                         {
-                            clumpBand->RasterIO(GF_Read, (*iterPxls).xPos, (*iterPxls).yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                            uiPxlVal = clumpsArr.getValue((*iterPxls).xPos, (*iterPxls).yPos+1);
                             if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                             {
                                 neighbours.push_back(uiPxlVal);
@@ -426,7 +430,7 @@ namespace rsgis{namespace segment{
                         // Left
                         if(((long)(*iterPxls).xPos-1) >= 0)
                         {
-                            clumpBand->RasterIO(GF_Read, (*iterPxls).xPos-1, (*iterPxls).yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                            uiPxlVal = clumpsArr.getValue((*iterPxls).xPos-1, (*iterPxls).yPos);
                             if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                             {
                                 neighbours.push_back(uiPxlVal);
@@ -435,19 +439,19 @@ namespace rsgis{namespace segment{
                         // Right
                         if(((long)(*iterPxls).xPos+1) < width)
                         {
-                            clumpBand->RasterIO(GF_Read, (*iterPxls).xPos+1, (*iterPxls).yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                            uiPxlVal = clumpsArr.getValue((*iterPxls).xPos+1, (*iterPxls).yPos);
                             if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                             {
                                 neighbours.push_back(uiPxlVal);
                             }
                         }
                     }
-                    neighbours.sort();
-                    neighbours.unique();
+                    std::sort(neighbours.begin(), neighbours.end());
+                    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
                     
                     // Decide on which neighbour to measure with.
                     firstNeighbourTested = true;
-                    for(std::list<unsigned long>::iterator iterClumps = neighbours.begin(); iterClumps != neighbours.end(); ++iterClumps)
+                    for(std::vector<unsigned long>::iterator iterClumps = neighbours.begin(); iterClumps != neighbours.end(); ++iterClumps)
                     {
                         if(clumpTable->at((*iterClumps)-1)->pxls->size() > cClump->pxls->size())
                         {
@@ -521,7 +525,7 @@ namespace rsgis{namespace segment{
                     pair2Merge.second->pxls->push_back(tLoc);
                      
                     // Update Pixel Values - in clump image.
-                    clumpBand->RasterIO(GF_Write, tLoc.xPos, tLoc.yPos, 1, 1, &closestNeighbour, 1, 1, GDT_UInt32, 0, 0);
+                    clumpsArr.setValue(tLoc.xPos, tLoc.yPos, closestNeighbour);
                 }
                 
                 for(unsigned int b = 0; b < numSpecBands; ++b)
@@ -530,8 +534,6 @@ namespace rsgis{namespace segment{
                     pair2Merge.second->meanVals[b] = pair2Merge.second->sumVals[b]/pair2Merge.second->pxls->size();
                 }
 
-                delete[] pair2Merge.first->sumVals;
-                delete[] pair2Merge.first->meanVals;
                 delete pair2Merge.first->pxls;
                 pair2Merge.first->active = false;
             }
@@ -541,17 +543,16 @@ namespace rsgis{namespace segment{
         }        
         
         
+        clumpsArr.flush();
+        
         for(std::vector<rsgis::img::ImgClump*>::iterator iterClumps = clumpTable->begin(); iterClumps != clumpTable->end(); ++iterClumps)
         {
             if((*iterClumps) != NULL)
             {
                 if((*iterClumps)->active)
                 {
-                    delete[] (*iterClumps)->sumVals;
-                    delete[] (*iterClumps)->meanVals;
                     delete (*iterClumps)->pxls;
                 }
-                delete (*iterClumps);
             }
         }
         delete clumpTable;
@@ -595,7 +596,8 @@ namespace rsgis{namespace segment{
             }
         }
 
-        GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
+        // The random neighbour reads and writes are within the clumps array, which is written back at the end.
+        RSGISClumpsArray clumpsArr(clumps, 1);
         
         unsigned int uiPxlVal = 0;
         
@@ -613,11 +615,13 @@ namespace rsgis{namespace segment{
         std::cout << "Build clump table\n";
         rsgis::img::ImgClump *cClump = NULL;
         rsgis::img::ImgClump *tClump = NULL;
+        // The clumps and their band values are held in an arena which is released with the table.
+        rsgis::RSGISArena clumpArena;
         for(unsigned int i = 0; i < maxClumpIdx; ++i)
         {
-            cClump = new rsgis::img::ImgClump(i+1);
-            cClump->sumVals = new float[numSpecBands];
-            cClump->meanVals = new float[numSpecBands];
+            cClump = clumpArena.create<rsgis::img::ImgClump>(i+1);
+            cClump->sumVals = clumpArena.allocArray<float>(numSpecBands);
+            cClump->meanVals = clumpArena.allocArray<float>(numSpecBands);
             cClump->pxls = new std::vector<rsgis::img::PxlLoc>();
             cClump->active = true;
             for(unsigned int n = 0; n < numSpecBands; ++n)
@@ -652,7 +656,7 @@ namespace rsgis{namespace segment{
         std::cout << "There are " << clumpTable->size() << " clumps.\n";
         
         rsgis::img::PxlLoc tLoc;
-        std::list<unsigned long> neighbours;
+        std::vector<unsigned long> neighbours;
         unsigned long closestNeighbour = 0;
         bool firstNeighbourTested = true;
         float closestNeighbourDist = 0;
@@ -691,14 +695,14 @@ namespace rsgis{namespace segment{
                     // Check that the clump was not selected for a merging already and therefore over minimum size...
                     if((cClump->active) & (cClump->pxls->size() < minClumpSize))
                     {
-                        // Get std::list of neighbours.
+                        // Get the neighbours.
                         neighbours.clear();
                         for(std::vector<rsgis::img::PxlLoc>::iterator iterPxls = cClump->pxls->begin(); iterPxls != cClump->pxls->end(); ++iterPxls)
                         {
                             // Above
                             if(((long)(*iterPxls).yPos)-1 >= 0)
                             {
-                                clumpBand->RasterIO(GF_Read, (*iterPxls).xPos, (*iterPxls).yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                uiPxlVal = clumpsArr.getValue((*iterPxls).xPos, (*iterPxls).yPos-1);
                                 if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                                 {
                                     neighbours.push_back(uiPxlVal);
@@ -707,7 +711,7 @@ namespace rsgis{namespace segment{
                             // Below
                             if(((long)(*iterPxls).yPos)+1 < height)
                             {
-                                clumpBand->RasterIO(GF_Read, (*iterPxls).xPos, (*iterPxls).yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                uiPxlVal = clumpsArr.getValue((*iterPxls).xPos, (*iterPxls).yPos+1);
                                 if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                                 {
                                     neighbours.push_back(uiPxlVal);
@@ -716,7 +720,7 @@ namespace rsgis{namespace segment{
                             // Left
                             if(((long)(*iterPxls).xPos-1) >= 0)
                             {
-                                clumpBand->RasterIO(GF_Read, (*iterPxls).xPos-1, (*iterPxls).yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                uiPxlVal = clumpsArr.getValue((*iterPxls).xPos-1, (*iterPxls).yPos);
                                 if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                                 {
                                     neighbours.push_back(uiPxlVal);
@@ -725,19 +729,19 @@ namespace rsgis{namespace segment{
                             // Right
                             if(((long)(*iterPxls).xPos+1) < width)
                             {
-                                clumpBand->RasterIO(GF_Read, (*iterPxls).xPos+1, (*iterPxls).yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                uiPxlVal = clumpsArr.getValue((*iterPxls).xPos+1, (*iterPxls).yPos);
                                 if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                                 {
                                     neighbours.push_back(uiPxlVal);
                                 }
                             }
                         }
-                        neighbours.sort();
-                        neighbours.unique();
+                        std::sort(neighbours.begin(), neighbours.end());
+                        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
                         
                         // Decide on which neighbour to measure with.
                         firstNeighbourTested = true;
-                        for(std::list<unsigned long>::iterator iterClumps = neighbours.begin(); iterClumps != neighbours.end(); ++iterClumps)
+                        for(std::vector<unsigned long>::iterator iterClumps = neighbours.begin(); iterClumps != neighbours.end(); ++iterClumps)
                         {
                             if(clumpTable->at((*iterClumps)-1)->pxls->size() > cClump->pxls->size())
                             {
@@ -812,7 +816,7 @@ namespace rsgis{namespace segment{
                         pair2Merge.second->pxls->push_back(tLoc);
                         
                         // Update Pixel Values - in clump image.
-                        clumpBand->RasterIO(GF_Write, tLoc.xPos, tLoc.yPos, 1, 1, &closestNeighbour, 1, 1, GDT_UInt32, 0, 0);
+                        clumpsArr.setValue(tLoc.xPos, tLoc.yPos, closestNeighbour);
                     }
                     
                     for(unsigned int b = 0; b < numSpecBands; ++b)
@@ -821,8 +825,6 @@ namespace rsgis{namespace segment{
                         pair2Merge.second->meanVals[b] = pair2Merge.second->sumVals[b]/pair2Merge.second->pxls->size();
                     }
                     
-                    delete[] pair2Merge.first->sumVals;
-                    delete[] pair2Merge.first->meanVals;
                     delete pair2Merge.first->pxls;
                     pair2Merge.first->active = false;
                 }
@@ -857,17 +859,16 @@ namespace rsgis{namespace segment{
         }
         
         
+        clumpsArr.flush();
+        
         for(std::vector<rsgis::img::ImgClump*>::iterator iterClumps = clumpTable->begin(); iterClumps != clumpTable->end(); ++iterClumps)
         {
             if((*iterClumps) != NULL)
             {
                 if((*iterClumps)->active)
                 {
-                    delete[] (*iterClumps)->sumVals;
-                    delete[] (*iterClumps)->meanVals;
                     delete (*iterClumps)->pxls;
                 }
-                delete (*iterClumps);
             }
         }
         delete clumpTable;
@@ -903,6 +904,8 @@ namespace rsgis{namespace segment{
             spectralVals[n] = new float[width];
         }
         GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
+        // The random neighbour reads and writes are within the clumps array, which is written back at the end.
+        RSGISClumpsArray clumpsArr(clumps, 1);
         
         unsigned int uiPxlVal = 0;
         
@@ -918,10 +921,12 @@ namespace rsgis{namespace segment{
         std::cout << "Build clump table\n";
         rsgis::img::ImgClumpSum *tClump = NULL;
         unsigned int cClumpIdx = 0;
+        // The clumps and their band sums are held in an arena which is released with the table.
+        rsgis::RSGISArena clumpArena;
         for(unsigned int i = 0; i < maxClumpIdx; ++i)
         {
-            clumpTable[i] = new rsgis::img::ImgClumpSum(i+1);
-            clumpTable[i]->sumVals = new float[numSpecBands];
+            clumpTable[i] = clumpArena.create<rsgis::img::ImgClumpSum>(i+1);
+            clumpTable[i]->sumVals = clumpArena.allocArray<float>(numSpecBands);
             clumpTable[i]->pxls = new std::vector<rsgis::img::PxlLoc>();
             clumpTable[i]->active = true;
             for(unsigned int n = 0; n < numSpecBands; ++n)
@@ -958,7 +963,7 @@ namespace rsgis{namespace segment{
         std::cout << "There are " << maxClumpIdx << " clumps.\n";
         
         rsgis::img::PxlLoc tLoc;
-        std::list<unsigned int> neighbours;
+        std::vector<unsigned int> neighbours;
         unsigned int closestNeighbour = 0;
         bool firstNeighbourTested = true;
         float closestNeighbourDist = 0;
@@ -992,14 +997,14 @@ namespace rsgis{namespace segment{
                 // Check that the clump was not selected for a merging already and therefore over minimum size...
                 if((clumpTable[cClumpIdx]->active) & (clumpTable[cClumpIdx]->pxls->size() < minClumpSize))
                 {
-                    // Get std::list of neighbours.
+                    // Get the neighbours.
                     neighbours.clear();
                     for(std::vector<rsgis::img::PxlLoc>::iterator iterPxls = clumpTable[cClumpIdx]->pxls->begin(); iterPxls != clumpTable[cClumpIdx]->pxls->end(); ++iterPxls)
                     {
                         // Above
                         if(((long)(*iterPxls).yPos)-1 >= 0)
                         {
-                            clumpBand->RasterIO(GF_Read, (*iterPxls).xPos, (*iterPxls).yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                            uiPxlVal = clumpsArr.getValue((*iterPxls).xPos, (*iterPxls).yPos-1);
                             if((uiPxlVal != clumpTable[cClumpIdx]->clumpID) & (uiPxlVal != 0))
                             {
                                 neighbours.push_back(uiPxlVal);
@@ -1008,7 +1013,7 @@ namespace rsgis{namespace segment{
                         // Below
                         if(((long)(*iterPxls).yPos)+1 < height)
                         {
-                            clumpBand->RasterIO(GF_Read, (*iterPxls).xPos, (*iterPxls).yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                            uiPxlVal = clumpsArr.getValue((*iterPxls).xPos, (*iterPxls).yPos+1);
                             if((uiPxlVal != clumpTable[cClumpIdx]->clumpID) & (uiPxlVal != 0))
                             {
                                 neighbours.push_back(uiPxlVal);
@@ -1017,7 +1022,7 @@ namespace rsgis{namespace segment{
                         // Left
                         if(((long)(*iterPxls).xPos-1) >= 0)
                         {
-                            clumpBand->RasterIO(GF_Read, (*iterPxls).xPos-1, (*iterPxls).yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                            uiPxlVal = clumpsArr.getValue((*iterPxls).xPos-1, (*iterPxls).yPos);
                             if((uiPxlVal != clumpTable[cClumpIdx]->clumpID) & (uiPxlVal != 0))
                             {
                                 neighbours.push_back(uiPxlVal);
@@ -1026,19 +1031,19 @@ namespace rsgis{namespace segment{
                         // Right
                         if(((long)(*iterPxls).xPos+1) < width)
                         {
-                            clumpBand->RasterIO(GF_Read, (*iterPxls).xPos+1, (*iterPxls).yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                            uiPxlVal = clumpsArr.getValue((*iterPxls).xPos+1, (*iterPxls).yPos);
                             if((uiPxlVal != clumpTable[cClumpIdx]->clumpID) & (uiPxlVal != 0))
                             {
                                 neighbours.push_back(uiPxlVal);
                             }
                         }
                     }
-                    neighbours.sort();
-                    neighbours.unique();
+                    std::sort(neighbours.begin(), neighbours.end());
+                    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
                     
                     // Decide on which neighbour to measure with.
                     firstNeighbourTested = true;
-                    for(std::list<unsigned int>::iterator iterClumps = neighbours.begin(); iterClumps != neighbours.end(); ++iterClumps)
+                    for(std::vector<unsigned int>::iterator iterClumps = neighbours.begin(); iterClumps != neighbours.end(); ++iterClumps)
                     {
                         if(clumpTable[(*iterClumps)-1]->pxls->size() > clumpTable[cClumpIdx]->pxls->size())
                         {
@@ -1099,17 +1104,15 @@ namespace rsgis{namespace segment{
                     clumpTable[pair2Merge.second]->pxls->push_back(tLoc);
                     
                     // Update Pixel Values - in clump image.
-                    clumpBand->RasterIO(GF_Write, tLoc.xPos, tLoc.yPos, 1, 1, &closestNeighbour, 1, 1, GDT_UInt32, 0, 0);
+                    clumpsArr.setValue(tLoc.xPos, tLoc.yPos, closestNeighbour);
                 }
                 for(unsigned int b = 0; b < numSpecBands; ++b)
                 {
                     clumpTable[pair2Merge.second]->sumVals[b] += clumpTable[pair2Merge.first]->sumVals[b];
                 }
                 
-                delete[] clumpTable[pair2Merge.first]->sumVals;
                 delete clumpTable[pair2Merge.first]->pxls;
                 clumpTable[pair2Merge.first]->active = false;
-                delete clumpTable[pair2Merge.first];
                 clumpTable[pair2Merge.first] = NULL;
             }
             std::cout << "Eliminated " << smallClumpsCounter << " small clumps\n";
@@ -1118,16 +1121,16 @@ namespace rsgis{namespace segment{
         
         
         
+        clumpsArr.flush();
+        
         for(unsigned int i = 0; i < maxClumpIdx; ++i)
         {
             if(clumpTable[i] != NULL)
             {
                 if(clumpTable[i]->active)
                 {
-                    delete[] clumpTable[i]->sumVals;
                     delete clumpTable[i]->pxls;
                 }
-                delete clumpTable[i];
             }
         }
         delete[] clumpTable;
@@ -1142,6 +1145,303 @@ namespace rsgis{namespace segment{
         delete[] spectralVals;
     }
   
+    void RSGISEliminateSmallClumps::graphEliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail)
+    {
+        if(spectral->GetRasterXSize() != clumps->GetRasterXSize())
+        {
+            throw rsgis::img::RSGISImageCalcException("Widths are not the same");
+        }
+        if(spectral->GetRasterYSize() != clumps->GetRasterYSize())
+        {
+            throw rsgis::img::RSGISImageCalcException("Heights are not the same");
+        }
+        
+        unsigned int width = spectral->GetRasterXSize();
+        unsigned int height = spectral->GetRasterYSize();
+        unsigned int numSpecBands = spectral->GetRasterCount();
+        
+        std::vector<double> stretch2reflOffs;
+        std::vector<double> stretch2reflGains;
+        if(bandStatsAvail && (numSpecBands != bandStretchStats->size()))
+        {
+            throw rsgis::img::RSGISImageCalcException("The number of image bands and the number band statistics are not the same.");
+        }
+        else if(bandStatsAvail)
+        {
+            for(unsigned int i = 0; i < numSpecBands; ++i)
+            {
+                stretch2reflOffs.push_back(bandStretchStats->at(i).origMin);
+                stretch2reflGains.push_back((bandStretchStats->at(i).origMax - bandStretchStats->at(i).origMin) / (bandStretchStats->at(i).imgMax - bandStretchStats->at(i).imgMin));
+            }
+        }
+        
+        GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
+        std::vector<GDALRasterBand*> spectralBands;
+        for(unsigned int n = 0; n < numSpecBands; ++n)
+        {
+            spectralBands.push_back(spectral->GetRasterBand(n+1));
+        }
+        
+        std::cout << "Calc Number of clumps\n";
+        rsgis::rastergis::RSGISRasterAttUtils ratUtils;
+        long minVal = 0;
+        long maxVal = 0;
+        ratUtils.getImageBandMinMax(clumps, 1, &minVal, &maxVal);
+        size_t numClumps = boost::lexical_cast<size_t>(maxVal) + 1;
+        std::cout << "There are " << maxVal << " initial clumps." << std::endl;
+        
+        // The clump sizes, sums of the pixel values and the (undirected) neighbours are
+        // indexed by clump ID, with 0 (no data) not used.
+        std::vector<unsigned long> clumpSizes(numClumps, 0);
+        std::vector<double> sumVals(numClumps * numSpecBands, 0.0);
+        std::vector<std::vector<unsigned int> > neighbours(numClumps);
+        
+        auto addEdge = [&](unsigned int clumpA, unsigned int clumpB)
+        {
+            if(neighbours[clumpA].empty() || (neighbours[clumpA].back() != clumpB))
+            {
+                neighbours[clumpA].push_back(clumpB);
+            }
+            if(neighbours[clumpB].empty() || (neighbours[clumpB].back() != clumpA))
+            {
+                neighbours[clumpB].push_back(clumpA);
+            }
+        };
+        
+        std::cout << "Calculate the clump means and region adjacency graph\n";
+        std::vector<unsigned int> clumpRow(width);
+        std::vector<unsigned int> prevClumpRow(width);
+        std::vector<std::vector<float> > spectralRows(numSpecBands, std::vector<float>(width));
+        rsgis_tqdm pbar;
+        for(unsigned int y = 0; y < height; ++y)
+        {
+            pbar.progress(y, height);
+            clumpBand->RasterIO(GF_Read, 0, y, width, 1, clumpRow.data(), width, 1, GDT_UInt32, 0, 0);
+            for(unsigned int n = 0; n < numSpecBands; ++n)
+            {
+                spectralBands[n]->RasterIO(GF_Read, 0, y, width, 1, spectralRows[n].data(), width, 1, GDT_Float32, 0, 0);
+            }
+            for(unsigned int x = 0; x < width; ++x)
+            {
+                unsigned int clumpID = clumpRow[x];
+                if(clumpID == 0)
+                {
+                    continue;
+                }
+                ++clumpSizes[clumpID];
+                for(unsigned int n = 0; n < numSpecBands; ++n)
+                {
+                    sumVals[(clumpID * numSpecBands) + n] += spectralRows[n][x];
+                }
+                if((x > 0) && (clumpRow[x-1] != clumpID) && (clumpRow[x-1] != 0))
+                {
+                    addEdge(clumpID, clumpRow[x-1]);
+                }
+                if((y > 0) && (prevClumpRow[x] != clumpID) && (prevClumpRow[x] != 0))
+                {
+                    addEdge(clumpID, prevClumpRow[x]);
+                }
+            }
+            clumpRow.swap(prevClumpRow);
+        }
+        pbar.finish();
+        
+        for(size_t i = 0; i < numClumps; ++i)
+        {
+            std::sort(neighbours[i].begin(), neighbours[i].end());
+            neighbours[i].erase(std::unique(neighbours[i].begin(), neighbours[i].end()), neighbours[i].end());
+            neighbours[i].shrink_to_fit();
+        }
+        
+        // Merged clumps point to the clump they were merged into. The neighbour lists
+        // are not updated when a clump is merged, instead the IDs are resolved using
+        // findMergedClump, which compresses the paths as it goes.
+        std::vector<unsigned int> mergedInto(numClumps);
+        for(size_t i = 0; i < numClumps; ++i)
+        {
+            mergedInto[i] = i;
+        }
+        auto findMergedClump = [&](unsigned int clumpID)
+        {
+            while(mergedInto[clumpID] != clumpID)
+            {
+                mergedInto[clumpID] = mergedInto[mergedInto[clumpID]];
+                clumpID = mergedInto[clumpID];
+            }
+            return clumpID;
+        };
+        
+        auto calcSpecDist = [&](unsigned int clumpA, unsigned int clumpB, bool inRefl)
+        {
+            double dist = 0.0;
+            double diff = 0.0;
+            for(unsigned int b = 0; b < numSpecBands; ++b)
+            {
+                diff = (sumVals[(clumpA * numSpecBands) + b] / clumpSizes[clumpA]) - (sumVals[(clumpB * numSpecBands) + b] / clumpSizes[clumpB]);
+                if(inRefl)
+                {
+                    diff *= stretch2reflGains[b];
+                }
+                dist += diff * diff;
+            }
+            return sqrt(dist);
+        };
+        
+        // Find the spectrally closest neighbour which is larger than the clump,
+        // removing merged and duplicate clumps from the neighbour list.
+        auto findClosestNeighbour = [&](unsigned int clumpID, unsigned int *closestNeighbour, double *closestDist)
+        {
+            std::vector<unsigned int> &clumpNeighbours = neighbours[clumpID];
+            for(size_t n = 0; n < clumpNeighbours.size(); ++n)
+            {
+                clumpNeighbours[n] = findMergedClump(clumpNeighbours[n]);
+            }
+            std::sort(clumpNeighbours.begin(), clumpNeighbours.end());
+            clumpNeighbours.erase(std::unique(clumpNeighbours.begin(), clumpNeighbours.end()), clumpNeighbours.end());
+            clumpNeighbours.erase(std::remove(clumpNeighbours.begin(), clumpNeighbours.end(), clumpID), clumpNeighbours.end());
+            
+            bool found = false;
+            double dist = 0.0;
+            for(std::vector<unsigned int>::iterator iterNeigh = clumpNeighbours.begin(); iterNeigh != clumpNeighbours.end(); ++iterNeigh)
+            {
+                if(clumpSizes[*iterNeigh] > clumpSizes[clumpID])
+                {
+                    dist = calcSpecDist(clumpID, *iterNeigh, false);
+                    if((!found) || (dist < *closestDist))
+                    {
+                        *closestNeighbour = *iterNeigh;
+                        *closestDist = dist;
+                        found = true;
+                    }
+                }
+            }
+            return found;
+        };
+        
+        std::priority_queue<RSGISClumpMergeCandidate, std::vector<RSGISClumpMergeCandidate>, std::greater<RSGISClumpMergeCandidate> > mergeQueue;
+        std::vector<unsigned int> versions(numClumps, 0);
+        std::vector<bool> queued(numClumps, false);
+        
+        auto queueClump = [&](unsigned int clumpID)
+        {
+            if((clumpSizes[clumpID] == 0) || (clumpSizes[clumpID] >= minClumpSize) || (mergedInto[clumpID] != clumpID))
+            {
+                return;
+            }
+            RSGISClumpMergeCandidate candidate;
+            unsigned int closestNeighbour = 0;
+            if(findClosestNeighbour(clumpID, &closestNeighbour, &candidate.dist))
+            {
+                candidate.size = clumpSizes[clumpID];
+                candidate.clumpID = clumpID;
+                candidate.version = ++versions[clumpID];
+                mergeQueue.push(candidate);
+                queued[clumpID] = true;
+            }
+        };
+        
+        std::cout << "Eliminating Small Clumps." << std::endl;
+        unsigned long numMerges = 0;
+        unsigned long numRoundMerges = 0;
+        do
+        {
+            // Clumps which were not merged (i.e., above the spectral threshold) are queued
+            // again as the merges of other clumps may have changed their neighbours.
+            numRoundMerges = 0;
+            for(size_t i = 1; i < numClumps; ++i)
+            {
+                if(!queued[i])
+                {
+                    queueClump(i);
+                }
+            }
+            
+            while(!mergeQueue.empty())
+            {
+                RSGISClumpMergeCandidate candidate = mergeQueue.top();
+                mergeQueue.pop();
+                unsigned int clumpID = candidate.clumpID;
+                if((candidate.version != versions[clumpID]) || (mergedInto[clumpID] != clumpID))
+                {
+                    continue;
+                }
+                queued[clumpID] = false;
+                
+                unsigned int closestNeighbour = 0;
+                double closestDist = 0.0;
+                if(!findClosestNeighbour(clumpID, &closestNeighbour, &closestDist))
+                {
+                    continue;
+                }
+                if((clumpSizes[clumpID] != candidate.size) || (closestDist != candidate.dist))
+                {
+                    // The clump or its neighbours have changed since it was queued.
+                    queueClump(clumpID);
+                    continue;
+                }
+                
+                if(bandStatsAvail)
+                {
+                    closestDist = calcSpecDist(clumpID, closestNeighbour, true);
+                }
+                if(closestDist >= specThreshold)
+                {
+                    continue;
+                }
+                
+                // Merge the clump into its closest neighbour.
+                clumpSizes[closestNeighbour] += clumpSizes[clumpID];
+                clumpSizes[clumpID] = 0;
+                for(unsigned int b = 0; b < numSpecBands; ++b)
+                {
+                    sumVals[(closestNeighbour * numSpecBands) + b] += sumVals[(clumpID * numSpecBands) + b];
+                }
+                mergedInto[clumpID] = closestNeighbour;
+                
+                std::vector<unsigned int> mergedNeighbours;
+                mergedNeighbours.swap(neighbours[clumpID]);
+                neighbours[closestNeighbour].insert(neighbours[closestNeighbour].end(), mergedNeighbours.begin(), mergedNeighbours.end());
+                ++numMerges;
+                ++numRoundMerges;
+                
+                // The merged clump and the neighbours of the clump which has been removed
+                // (which are now neighbours of the merged clump) may now be merged.
+                if(!queued[closestNeighbour])
+                {
+                    queueClump(closestNeighbour);
+                }
+                for(std::vector<unsigned int>::iterator iterNeigh = mergedNeighbours.begin(); iterNeigh != mergedNeighbours.end(); ++iterNeigh)
+                {
+                    unsigned int neighID = findMergedClump(*iterNeigh);
+                    if(!queued[neighID])
+                    {
+                        queueClump(neighID);
+                    }
+                }
+            }
+            std::cout << "Eliminated " << numRoundMerges << " small clumps\n";
+        }
+        while(numRoundMerges > 0);
+        std::cout << "Eliminated " << numMerges << " small clumps in total\n";
+        
+        std::cout << "Relabelling the clumps\n";
+        for(size_t i = 0; i < numClumps; ++i)
+        {
+            findMergedClump(i);
+        }
+        for(unsigned int y = 0; y < height; ++y)
+        {
+            pbar.progress(y, height);
+            clumpBand->RasterIO(GF_Read, 0, y, width, 1, clumpRow.data(), width, 1, GDT_UInt32, 0, 0);
+            for(unsigned int x = 0; x < width; ++x)
+            {
+                clumpRow[x] = mergedInto[clumpRow[x]];
+            }
+            clumpBand->RasterIO(GF_Write, 0, y, width, 1, clumpRow.data(), width, 1, GDT_UInt32, 0, 0);
+        }
+        pbar.finish();
+    }
+    
     RSGISEliminateSmallClumps::~RSGISEliminateSmallClumps()
     {
         
@@ -1201,6 +1501,32 @@ namespace rsgis{namespace segment{
         }
     }
 
+    bool RSGISPopulateMeansPxlLocs::calcImageBlockAtPxls(const float* const* bands, int numBands, size_t nPxls, const rsgis::img::RSGISPxlCoordsGenerator &pxlCoords)
+    {
+        size_t numClumps = clumpTable->size();
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            if(bands[0][p] > 0)
+            {
+                size_t fid = bands[0][p];
+                if((fid != bands[0][p]) || (fid > numClumps))
+                {
+                    throw rsgis::img::RSGISImageCalcException("Clump ID is not an integer within the clump table.");
+                }
+                
+                rsgis::img::ImgClump *cClump = clumpTable->at(fid - 1);
+                for(unsigned int n = 0; n < numSpecBands; ++n)
+                {
+                    cClump->sumVals[n] += bands[n+1][p];
+                }
+                
+                rsgis::img::RSGISPxlCoords coords = pxlCoords.getPxlCoords(p);
+                cClump->pxls->push_back(rsgis::img::PxlLoc(coords.xPxl, coords.yPxl));
+            }
+        }
+        return true;
+    }
+    
     RSGISPopulateMeansPxlLocs::~RSGISPopulateMeansPxlLocs()
     {
         
@@ -30,10 +30,13 @@
 #include <deque>
 #include <list>
 #include <cmath>
+#include <functional>
+#include <algorithm>
 
 #include "gdal_priv.h"
 
 #include "common/RSGISAttributeTableException.h"
+#include "common/RSGISArena.h"
 #include "common/RSGISFileException.h"
 
 #include "utils/RSGISTextUtils.h"
@@ -46,6 +49,8 @@
 
 #include "rastergis/RSGISRasterAttUtils.h"
 
+#include "segmentation/RSGISClumpsArray.h"
+
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
 #undef DllExport
@@ -61,10 +66,43 @@
 
 namespace rsgis{namespace segment{
     
+    /** An entry in the queue of small clumps to be merged by graphEliminateSmallClumps. */
+    struct DllExport RSGISClumpMergeCandidate
+    {
+        unsigned long size;
+        double dist;
+        unsigned int clumpID;
+        unsigned int version;
+        
+        bool operator>(const RSGISClumpMergeCandidate &other) const
+        {
+            if(this->size != other.size)
+            {
+                return this->size > other.size;
+            }
+            if(this->dist != other.dist)
+            {
+                return this->dist > other.dist;
+            }
+            return this->clumpID > other.clumpID;
+        };
+    };
+    
     class DllExport RSGISEliminateSmallClumps
     {
     public:
         RSGISEliminateSmallClumps();
+        /**
+         * Eliminate the clumps smaller than minClumpSize by merging them with their
+         * spectrally closest larger neighbour (if the distance is below specThreshold)
+         * using a region adjacency graph built in a single pass of the images. The
+         * small clumps are merged from a min-heap ordered by (size, spectral distance)
+         * with the clump means updated as each merge is performed and the clumps image
+         * is relabelled in a single pass once all the merges have been performed. The
+         * clump IDs are not renumbered (i.e., merged clumps take the ID of the clump
+         * they were merged into).
+         */
+        void graphEliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail);
         void eliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold);
         void stepwiseEliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail);
         void stepwiseIterativeEliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail);
@@ -77,6 +115,8 @@ namespace rsgis{namespace segment{
     public:
         RSGISPopulateMeansPxlLocs(std::vector<rsgis::img::ImgClump*> *clumpTable, unsigned int numSpecBands);
         void calcImageValue(float *bandValues, int numBands, OGREnvelope extent);
+        /** Add each block of pixels to the clumps, using the pixel column and row of each pixel. */
+        bool calcImageBlockAtPxls(const float* const* bands, int numBands, size_t nPxls, const rsgis::img::RSGISPxlCoordsGenerator &pxlCoords);
         ~RSGISPopulateMeansPxlLocs();
     protected:
         std::vector<rsgis::img::ImgClump*> *clumpTable;
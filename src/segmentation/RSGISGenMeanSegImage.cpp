@@ -27,7 +27,10 @@ namespace rsgis{namespace segment{
     
     RSGISGenMeanSegImage::RSGISGenMeanSegImage()
     {
-        
+        rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+        this->numThreads = context.numThreads;
+        this->numIOBuffers = context.numIOBuffers;
+        this->stripMemoryMB = context.stripMemoryMB;
     }
     
     void RSGISGenMeanSegImage::generateMeanImage(GDALDataset *spectral, GDALDataset *clumps, GDALDataset *meanImg) 
@@ -494,6 +497,230 @@ namespace rsgis{namespace segment{
     }
     
     
+    void RSGISGenMeanSegImage::generateMeanImageFused(GDALDataset *spectral, GDALDataset *clumps, GDALDataset *meanImg, std::vector<std::string> meanCols)
+    {
+        bool meansFromRAT = !meanCols.empty();
+        unsigned int width = clumps->GetRasterXSize();
+        unsigned int height = clumps->GetRasterYSize();
+        unsigned int numBands = meanImg->GetRasterCount();
+        if((((unsigned int)meanImg->GetRasterXSize()) != width) || (meansFromRAT?false:(((unsigned int)spectral->GetRasterXSize()) != width)))
+        {
+            throw rsgis::img::RSGISImageCalcException("Widths are not the same");
+        }
+        if((((unsigned int)meanImg->GetRasterYSize()) != height) || (meansFromRAT?false:(((unsigned int)spectral->GetRasterYSize()) != height)))
+        {
+            throw rsgis::img::RSGISImageCalcException("Heights are not the same");
+        }
+        if(meansFromRAT && (meanCols.size() != numBands))
+        {
+            throw rsgis::img::RSGISImageCalcException("The number of mean columns is not the same as the number of output bands");
+        }
+        if((!meansFromRAT) && (((unsigned int)spectral->GetRasterCount()) != numBands))
+        {
+            throw rsgis::img::RSGISImageCalcException("The number of bands is not the same");
+        }
+        
+        GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        clumpBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), width, height, sizeof(unsigned int) + (sizeof(float) * numBands), this->stripMemoryMB);
+        size_t stripPxls = ((size_t)width) * stripRows;
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        
+        // Dense band-major means (index band * numMeans + clump ID), so each output band is a gather.
+        std::vector<double> meanVals;
+        size_t numMeans = 0;
+        if(meansFromRAT)
+        {
+            GDALRasterAttributeTable *gdalRAT = clumpBand->GetDefaultRAT();
+            if(gdalRAT == NULL)
+            {
+                throw rsgis::img::RSGISImageCalcException("The clumps image does not have a RAT to read the means from.");
+            }
+            numMeans = gdalRAT->GetRowCount();
+            meanVals.assign(numMeans * numBands, 0);
+            rsgis::rastergis::RSGISRasterAttUtils attUtils;
+            for(unsigned int n = 0; n < numBands; ++n)
+            {
+                attUtils.readColumnChunk(gdalRAT, meanCols[n], 0, numMeans, meanVals.data() + (n * numMeans));
+                if(numMeans > 0)
+                {
+                    meanVals[n * numMeans] = 0;
+                }
+            }
+        }
+        else
+        {
+            std::cout << "Calculating the clump means\n";
+            this->calcClumpMeans(spectral, clumpBand, stripRows, threadPool, &meanVals, &numMeans);
+        }
+        
+        if((width == 0) || (height == 0))
+        {
+            return;
+        }
+        
+        std::cout << "Applying the clump means\n";
+        size_t nStrips = (height + stripRows - 1) / stripRows;
+        rsgis::RSGISStripIOPipeline ioPipeline(this->numIOBuffers);
+        unsigned int nBufs = ioPipeline.getNumBuffers();
+        std::vector<std::vector<unsigned int> > clumpIdxs(nBufs, std::vector<unsigned int>(stripPxls));
+        std::vector<std::vector<float> > outVals(nBufs, std::vector<float>(stripPxls * numBands));
+        
+        rsgis_tqdm pbar;
+        ioPipeline.run(nStrips, [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            clumpBand->RasterIO(GF_Read, 0, rowStart, width, nRows, clumpIdxs[buf].data(), width, nRows, GDT_UInt32, 0, 0);
+        },
+        [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            pbar.progress(rowStart, height);
+            const unsigned int *ids = clumpIdxs[buf].data();
+            float *outData = outVals[buf].data();
+            threadPool.parallelFor(0, ((size_t)width) * nRows, [&](unsigned int threadIdx, size_t pStart, size_t pEnd)
+            {
+                for(size_t i = pStart; i < pEnd; ++i)
+                {
+                    if(ids[i] >= numMeans)
+                    {
+                        throw rsgis::img::RSGISImageCalcException("A clump ID is not within the clump means.");
+                    }
+                }
+                for(unsigned int n = 0; n < numBands; ++n)
+                {
+                    const double *bandMeans = meanVals.data() + (n * numMeans);
+                    float *bandOut = outData + (n * stripPxls);
+                    for(size_t i = pStart; i < pEnd; ++i)
+                    {
+                        bandOut[i] = bandMeans[ids[i]];
+                    }
+                }
+            });
+        },
+        [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            for(unsigned int n = 0; n < numBands; ++n)
+            {
+                meanImg->GetRasterBand(n+1)->RasterIO(GF_Write, 0, rowStart, width, nRows, outVals[buf].data() + (n * stripPxls), width, nRows, GDT_Float32, 0, 0);
+            }
+        });
+        pbar.finish();
+    }
+    
+    void RSGISGenMeanSegImage::calcClumpMeans(GDALDataset *spectral, GDALRasterBand *clumpBand, unsigned int stripRows, rsgis::RSGISThreadPool &threadPool, std::vector<double> *meanVals, size_t *numMeans)
+    {
+        unsigned int width = clumpBand->GetXSize();
+        unsigned int height = clumpBand->GetYSize();
+        unsigned int numBands = spectral->GetRasterCount();
+        size_t stripPxls = ((size_t)width) * stripRows;
+        unsigned int nThreads = threadPool.getNumThreads();
+        
+        // Each thread has its own dense sums (index clump ID * numBands + band) and counts,
+        // which grow to the largest clump ID it has seen, so no locks are needed.
+        std::vector<std::vector<double> > threadSums(nThreads);
+        std::vector<std::vector<size_t> > threadCounts(nThreads);
+        
+        if((width > 0) && (height > 0))
+        {
+            size_t nStrips = (height + stripRows - 1) / stripRows;
+            rsgis::RSGISStripIOPipeline ioPipeline(this->numIOBuffers);
+            unsigned int nBufs = ioPipeline.getNumBuffers();
+            std::vector<std::vector<unsigned int> > clumpIdxs(nBufs, std::vector<unsigned int>(stripPxls));
+            std::vector<std::vector<float> > specVals(nBufs, std::vector<float>(stripPxls * numBands));
+            
+            rsgis_tqdm pbar;
+            ioPipeline.run(nStrips, [&](size_t strip, unsigned int buf)
+            {
+                unsigned int rowStart = strip * stripRows;
+                unsigned int nRows = std::min(stripRows, height - rowStart);
+                clumpBand->RasterIO(GF_Read, 0, rowStart, width, nRows, clumpIdxs[buf].data(), width, nRows, GDT_UInt32, 0, 0);
+                for(unsigned int n = 0; n < numBands; ++n)
+                {
+                    spectral->GetRasterBand(n+1)->RasterIO(GF_Read, 0, rowStart, width, nRows, specVals[buf].data() + (n * stripPxls), width, nRows, GDT_Float32, 0, 0);
+                }
+            },
+            [&](size_t strip, unsigned int buf)
+            {
+                unsigned int rowStart = strip * stripRows;
+                unsigned int nRows = std::min(stripRows, height - rowStart);
+                pbar.progress(rowStart, height);
+                const unsigned int *ids = clumpIdxs[buf].data();
+                const float *specData = specVals[buf].data();
+                threadPool.parallelFor(0, ((size_t)width) * nRows, [&](unsigned int threadIdx, size_t pStart, size_t pEnd)
+                {
+                    std::vector<double> &sums = threadSums[threadIdx];
+                    std::vector<size_t> &counts = threadCounts[threadIdx];
+                    for(size_t i = pStart; i < pEnd; ++i)
+                    {
+                        size_t id = ids[i];
+                        if(id == 0)
+                        {
+                            continue;
+                        }
+                        if(id >= counts.size())
+                        {
+                            counts.resize(id+1, 0);
+                            sums.resize((id+1) * numBands, 0);
+                        }
+                        ++counts[id];
+                        double *clumpSums = sums.data() + (id * numBands);
+                        for(unsigned int n = 0; n < numBands; ++n)
+                        {
+                            clumpSums[n] += specData[(n * stripPxls) + i];
+                        }
+                    }
+                });
+            },
+            [&](size_t strip, unsigned int buf){});
+            pbar.finish();
+        }
+        
+        // Merge the partial sums of the threads, in parallel over ranges of clump IDs.
+        size_t nClumps = 1;
+        for(unsigned int t = 0; t < nThreads; ++t)
+        {
+            nClumps = std::max(nClumps, threadCounts[t].size());
+        }
+        *numMeans = nClumps;
+        meanVals->assign(nClumps * numBands, 0);
+        double *means = meanVals->data();
+        threadPool.parallelFor(1, nClumps, [&](unsigned int threadIdx, size_t cStart, size_t cEnd)
+        {
+            std::vector<double> clumpSums(numBands);
+            for(size_t c = cStart; c < cEnd; ++c)
+            {
+                size_t count = 0;
+                std::fill(clumpSums.begin(), clumpSums.end(), 0.0);
+                for(unsigned int t = 0; t < nThreads; ++t)
+                {
+                    if(c < threadCounts[t].size())
+                    {
+                        count += threadCounts[t][c];
+                        const double *tSums = threadSums[t].data() + (c * numBands);
+                        for(unsigned int n = 0; n < numBands; ++n)
+                        {
+                            clumpSums[n] += tSums[n];
+                        }
+                    }
+                }
+                if(count > 0)
+                {
+                    for(unsigned int n = 0; n < numBands; ++n)
+                    {
+                        means[(n * nClumps) + c] = clumpSums[n] / count;
+                    }
+                }
+            }
+        });
+    }
+    
     RSGISGenMeanSegImage::~RSGISGenMeanSegImage()
     {
         
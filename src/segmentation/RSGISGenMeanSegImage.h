@@ -28,9 +28,13 @@
 #include <vector>
 #include <queue>
 #include <cmath>
+#include <algorithm>
 
 #include "gdal_priv.h"
 
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISStripIOPipeline.h"
 #include "common/rsgis-tqdm.h"
 
 #include "img/RSGISImageUtils.h"
@@ -62,7 +66,22 @@ namespace rsgis{namespace segment{
         void generateMeanImage(GDALDataset *spectral, GDALDataset *clumps, GDALDataset *meanImg);
         void generateMeanImageUsingClumpTable(GDALDataset *spectral, GDALDataset *clumps, GDALDataset *meanImg);
         void generateMeanImageUsingCalcImage(GDALDataset *spectral, GDALDataset *clumps, GDALDataset *meanImg);
+        /**
+         * Generate the mean image using dense per-clump sums, which each thread accumulates
+         * for its part of each strip and are then merged, and write each strip of the output
+         * with a gather of the clump means, in parallel (using the threads, strip memory and
+         * I/O buffers of the default execution context). If meanCols is not empty, the means
+         * are read from those columns of the clumps RAT (one per output band) and the spectral
+         * image is not read (so can be NULL). Clump 0 is no data, with an output of 0.
+         */
+        void generateMeanImageFused(GDALDataset *spectral, GDALDataset *clumps, GDALDataset *meanImg, std::vector<std::string> meanCols=std::vector<std::string>());
         ~RSGISGenMeanSegImage();
+    protected:
+        /** Calculate the band-major (index band * numMeans + clump ID) means of the clumps (0 to numMeans-1). */
+        void calcClumpMeans(GDALDataset *spectral, GDALRasterBand *clumpBand, unsigned int stripRows, rsgis::RSGISThreadPool &threadPool, std::vector<double> *meanVals, size_t *numMeans);
+        unsigned int numThreads;
+        unsigned int numIOBuffers;
+        unsigned int stripMemoryMB;
     };
     
     
@@ -25,6 +25,55 @@
 
 namespace rsgis{namespace segment{
     
+    /**
+     * The OpenCL kernel of RSGISLabelPixelsUsingClustersCalcImg, with the same operations
+     * as calcImageValue (a float distance summing double precision squared differences,
+     * without contraction) so the labels are identical to the CPU.
+     */
+    static const std::string rsgisLabelPxlsOpenCLSource(
+        "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+        "#pragma OPENCL FP_CONTRACT OFF\n"
+        "__kernel void rsgisLabelPxlsUsingClusters(__global const float *in, const uint nPxls, __global uint *out,\n"
+        "                                          const uint numBands, const uint numClusters, const int ignoreZeros,\n"
+        "                                          __global const double *centres)\n"
+        "{\n"
+        "    const size_t p = get_global_id(0);\n"
+        "    if(p >= nPxls)\n"
+        "    {\n"
+        "        return;\n"
+        "    }\n"
+        "    bool nonZeroFound = false;\n"
+        "    for(uint b = 0; b < numBands; ++b)\n"
+        "    {\n"
+        "        if(in[(((size_t)b)*nPxls)+p] != 0)\n"
+        "        {\n"
+        "            nonZeroFound = true;\n"
+        "        }\n"
+        "    }\n"
+        "    if(ignoreZeros && !nonZeroFound)\n"
+        "    {\n"
+        "        out[p] = 0;\n"
+        "        return;\n"
+        "    }\n"
+        "    uint clusterID = 1;\n"
+        "    float minDist = 0;\n"
+        "    for(uint c = 0; c < numClusters; ++c)\n"
+        "    {\n"
+        "        float dist = 0;\n"
+        "        for(uint b = 0; b < numBands; ++b)\n"
+        "        {\n"
+        "            const double diff = ((double)in[(((size_t)b)*nPxls)+p]) - centres[(b*numClusters)+c];\n"
+        "            dist = (float)(((double)dist) + (diff*diff));\n"
+        "        }\n"
+        "        dist = (float)sqrt((double)dist);\n"
+        "        if((c == 0) || (dist < minDist))\n"
+        "        {\n"
+        "            clusterID = c+1;\n"
+        "            minDist = dist;\n"
+        "        }\n"
+        "    }\n"
+        "    out[p] = clusterID;\n"
+        "}\n" );
 
     RSGISLabelPixelsUsingClusters::RSGISLabelPixelsUsingClusters()
     {
@@ -41,7 +90,7 @@ namespace rsgis{namespace segment{
             std::string *bandNames = new std::string[1];
             bandNames[0] = "Clusters";
             
-            RSGISLabelPixelsUsingClustersCalcImg *calcValue = new RSGISLabelPixelsUsingClustersCalcImg(1, clusterCentres, ignoreZeros);
+            RSGISLabelPixelsUsingClustersCalcImg *calcValue = new RSGISLabelPixelsUsingClustersCalcImg(1, clusterCentres, ignoreZeros, this->isByteImage(datasets, numDatasets));
             rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(calcValue, outProjStr, useImageProj);
             calcImage.calcImage(datasets, numDatasets, output, true, bandNames, imageFormat);
             
@@ -66,6 +115,44 @@ namespace rsgis{namespace segment{
         }
     }
 
+    void RSGISLabelPixelsUsingClusters::labelPixelsUsingClusters(GDALDataset **datasets, int numDatasets, GDALDataset *outputDS, rsgis::math::Matrix *clusterCentres, bool ignoreZeros)
+    {
+        try 
+        {
+            RSGISLabelPixelsUsingClustersCalcImg *calcValue = new RSGISLabelPixelsUsingClustersCalcImg(1, clusterCentres, ignoreZeros, this->isByteImage(datasets, numDatasets));
+            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(calcValue, "", true);
+            calcImage.calcImage(datasets, numDatasets, outputDS);
+            delete calcValue;
+        } 
+        catch(rsgis::img::RSGISImageCalcException &e)
+        {
+            throw rsgis::RSGISImageException(e.what());
+        }
+        catch (rsgis::RSGISImageException &e) 
+        {
+            throw e;
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw rsgis::RSGISImageException(e.what());
+        }
+    }
+
+    bool RSGISLabelPixelsUsingClusters::isByteImage(GDALDataset **datasets, int numDatasets)
+    {
+        for(int i = 0; i < numDatasets; ++i)
+        {
+            for(int n = 1; n <= datasets[i]->GetRasterCount(); ++n)
+            {
+                if(datasets[i]->GetRasterBand(n)->GetRasterDataType() != GDT_Byte)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
     RSGISLabelPixelsUsingClusters::~RSGISLabelPixelsUsingClusters()
     {
         
@@ -73,10 +160,64 @@ namespace rsgis{namespace segment{
     
     
 
-    RSGISLabelPixelsUsingClustersCalcImg::RSGISLabelPixelsUsingClustersCalcImg(int numberOutBands, rsgis::math::Matrix *clusterCentres, bool ignoreZeros) : RSGISCalcImageValue(numberOutBands)
+    RSGISLabelPixelsUsingClustersCalcImg::RSGISLabelPixelsUsingClustersCalcImg(int numberOutBands, rsgis::math::Matrix *clusterCentres, bool ignoreZeros, bool useByteLUT) : RSGISCalcImageValue(numberOutBands)
     {
         this->clusterCentres = clusterCentres;
         this->ignoreZeros = ignoreZeros;
+        this->useByteLUT = useByteLUT;
+        
+        const unsigned int numClusters = clusterCentres->m;
+        const unsigned int numCentreBands = clusterCentres->n;
+        this->centreSqLens.assign(numClusters, 0.0);
+        this->maxCentreSqLen = 0;
+        for(unsigned int c = 0; c < numClusters; ++c)
+        {
+            for(unsigned int b = 0; b < numCentreBands; ++b)
+            {
+                double val = clusterCentres->matrix[(b*numClusters)+c];
+                this->centreSqLens[c] += val * val;
+            }
+            this->maxCentreSqLen = std::max(this->maxCentreSqLen, this->centreSqLens[c]);
+        }
+        
+        this->byteLUTBands = 0;
+        if(useByteLUT)
+        {
+            std::vector<double> *lut = new std::vector<double>(((size_t)numCentreBands) * 256 * numClusters);
+            for(unsigned int b = 0; b < numCentreBands; ++b)
+            {
+                for(unsigned int v = 0; v < 256; ++v)
+                {
+                    double *lutVals = lut->data() + ((((size_t)b)*256)+v)*numClusters;
+                    for(unsigned int c = 0; c < numClusters; ++c)
+                    {
+                        // The same expression as calcImageValue so the sums are identical.
+                        float bandVal = v;
+                        lutVals[c] = ((bandVal-clusterCentres->matrix[(b*numClusters)+c])*(bandVal-clusterCentres->matrix[(b*numClusters)+c]));
+                    }
+                }
+            }
+            this->byteLUT.reset(lut);
+            this->byteLUTBands = numCentreBands;
+        }
+        
+        if(rsgis::RSGISOpenCLDevice::useDevice())
+        {
+            try
+            {
+                this->gpuKernel = std::make_shared<rsgis::RSGISOpenCLKernel>(rsgisLabelPxlsOpenCLSource, "rsgisLabelPxlsUsingClusters");
+                int ignoreZerosArg = ignoreZeros;
+                this->gpuKernel->setArg(3, &numCentreBands, sizeof(unsigned int));
+                this->gpuKernel->setArg(4, &numClusters, sizeof(unsigned int));
+                this->gpuKernel->setArg(5, &ignoreZerosArg, sizeof(int));
+                this->gpuKernel->setConstBuffer(6, clusterCentres->matrix, ((size_t)numCentreBands) * numClusters * sizeof(double));
+            }
+            catch(rsgis::RSGISException &e)
+            {
+                std::cerr << "Warning: The pixels will be labelled on the CPU as the GPU could not be used: " << e.what() << std::endl;
+                this->gpuKernel.reset();
+            }
+        }
     }
     
     void RSGISLabelPixelsUsingClustersCalcImg::calcImageValue(float *bandValues, int numBands, double *output) 
@@ -123,6 +264,231 @@ namespace rsgis{namespace segment{
         output[0] = clusterID;
     }
     
+    bool RSGISLabelPixelsUsingClustersCalcImg::calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        const unsigned int numClusters = this->clusterCentres->m;
+        if((numClusters == 0) || (numBands < 1) || (numBands != this->clusterCentres->n))
+        {
+            return false;
+        }
+        
+        if(this->gpuKernel && this->calcGPUBlock(bands, numBands, nPxls, output))
+        {
+            return true;
+        }
+        
+        if(this->useByteLUT && (numBands == this->byteLUTBands) && this->calcByteLUTBlock(bands, numBands, nPxls, output))
+        {
+            return true;
+        }
+        
+        // The error of the float sum of calcImageValue (relative) and of the expansion (absolute).
+        const double floatErr = 3.0 * (numBands + 2) * std::ldexp(1.0, -23);
+        const double expErr = 4.0 * (numBands + 3) * std::ldexp(1.0, -50);
+        const size_t stripLen = 64;
+        this->stripDists.resize(stripLen * numClusters);
+        this->stripSqLens.resize(stripLen);
+        this->candidates.resize(numClusters);
+        const double *centres = this->clusterCentres->matrix;
+        for(size_t start = 0; start < nPxls; start += stripLen)
+        {
+            const size_t len = std::min(stripLen, nPxls - start);
+            double *sqLens = this->stripSqLens.data();
+            std::fill(sqLens, sqLens + len, 0.0);
+            for(int b = 0; b < numBands; ++b)
+            {
+                rsgis::RSGISSIMDKernels::addSquares(bands[b] + start, sqLens, len);
+            }
+            for(unsigned int c = 0; c < numClusters; ++c)
+            {
+                double *dists = this->stripDists.data() + (c * stripLen);
+                for(size_t p = 0; p < len; ++p)
+                {
+                    dists[p] = sqLens[p] + this->centreSqLens[c];
+                }
+            }
+            for(int b = 0; b < numBands; ++b)
+            {
+                const float *bandVals = bands[b] + start;
+                for(unsigned int c = 0; c < numClusters; ++c)
+                {
+                    const double weight = -2.0 * centres[(b*numClusters)+c];
+                    rsgis::RSGISSIMDKernels::addScaled(weight, bandVals, this->stripDists.data() + (c * stripLen), len);
+                }
+            }
+            
+            for(size_t p = 0; p < len; ++p)
+            {
+                const size_t pxl = start + p;
+                bool nonZeroFound = false;
+                for(int b = 0; b < numBands; ++b)
+                {
+                    if(bands[b][pxl] != 0)
+                    {
+                        nonZeroFound = true;
+                        break;
+                    }
+                }
+                if(this->ignoreZeros && !nonZeroFound)
+                {
+                    output[0][pxl] = 0;
+                    continue;
+                }
+                if(!std::isfinite(sqLens[p]))
+                {
+                    // NaN or infinite values, so use the per pixel distance for all the centres.
+                    for(unsigned int c = 0; c < numClusters; ++c)
+                    {
+                        this->candidates[c] = c;
+                    }
+                    output[0][pxl] = this->labelPxl(bands, numBands, pxl, this->candidates.data(), numClusters);
+                    continue;
+                }
+                
+                double minDist = this->stripDists[p];
+                for(unsigned int c = 1; c < numClusters; ++c)
+                {
+                    minDist = std::min(minDist, this->stripDists[(c * stripLen) + p]);
+                }
+                const double thres = minDist + (floatErr * std::max(minDist, 0.0)) + (expErr * (sqLens[p] + this->maxCentreSqLen + 1.0));
+                unsigned int numCandidates = 0;
+                for(unsigned int c = 0; c < numClusters; ++c)
+                {
+                    if(this->stripDists[(c * stripLen) + p] <= thres)
+                    {
+                        this->candidates[numCandidates++] = c;
+                    }
+                }
+                if(numCandidates == 1)
+                {
+                    output[0][pxl] = this->candidates[0] + 1;
+                }
+                else
+                {
+                    output[0][pxl] = this->labelPxl(bands, numBands, pxl, this->candidates.data(), numCandidates);
+                }
+            }
+        }
+        return true;
+    }
+    
+    bool RSGISLabelPixelsUsingClustersCalcImg::calcByteLUTBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        for(int b = 0; b < numBands; ++b)
+        {
+            for(size_t p = 0; p < nPxls; ++p)
+            {
+                float val = bands[b][p];
+                if(!((val >= 0) && (val <= 255) && (val == std::floor(val))))
+                {
+                    return false;
+                }
+            }
+        }
+        
+        const unsigned int numClusters = this->clusterCentres->m;
+        const size_t stripLen = 64;
+        this->stripDistsF.resize(stripLen * numClusters);
+        const double *lut = this->byteLUT->data();
+        for(size_t start = 0; start < nPxls; start += stripLen)
+        {
+            const size_t len = std::min(stripLen, nPxls - start);
+            std::fill(this->stripDistsF.begin(), this->stripDistsF.end(), 0.0f);
+            for(int b = 0; b < numBands; ++b)
+            {
+                const float *bandVals = bands[b] + start;
+                for(size_t p = 0; p < len; ++p)
+                {
+                    const double *lutVals = lut + ((((size_t)b)*256)+((unsigned int)bandVals[p]))*numClusters;
+                    float *dists = this->stripDistsF.data() + (p * numClusters);
+                    for(unsigned int c = 0; c < numClusters; ++c)
+                    {
+                        dists[c] += lutVals[c];
+                    }
+                }
+            }
+            
+            for(size_t p = 0; p < len; ++p)
+            {
+                const size_t pxl = start + p;
+                bool nonZeroFound = false;
+                for(int b = 0; b < numBands; ++b)
+                {
+                    if(bands[b][pxl] != 0)
+                    {
+                        nonZeroFound = true;
+                        break;
+                    }
+                }
+                if(this->ignoreZeros && !nonZeroFound)
+                {
+                    output[0][pxl] = 0;
+                    continue;
+                }
+                
+                const float *dists = this->stripDistsF.data() + (p * numClusters);
+                unsigned int clusterID = 1;
+                float minDist = std::sqrt(dists[0]);
+                for(unsigned int c = 1; c < numClusters; ++c)
+                {
+                    float dist = std::sqrt(dists[c]);
+                    if(dist < minDist)
+                    {
+                        clusterID = c+1;
+                        minDist = dist;
+                    }
+                }
+                output[0][pxl] = clusterID;
+            }
+        }
+        return true;
+    }
+    
+    bool RSGISLabelPixelsUsingClustersCalcImg::calcGPUBlock(const float* const* bands, int numBands, size_t nPxls, double **output)
+    {
+        this->gpuLabels.resize(nPxls);
+        try
+        {
+            this->gpuKernel->run(bands, numBands, nPxls, this->gpuLabels.data(), sizeof(unsigned int));
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            std::cerr << "Warning: The pixels will be labelled on the CPU as the GPU failed: " << e.what() << std::endl;
+            this->gpuKernel.reset();
+            return false;
+        }
+        for(size_t p = 0; p < nPxls; ++p)
+        {
+            output[0][p] = this->gpuLabels[p];
+        }
+        return true;
+    }
+    
+    unsigned int RSGISLabelPixelsUsingClustersCalcImg::labelPxl(const float* const* bands, int numBands, size_t p, const unsigned int *candidates, unsigned int numCandidates)
+    {
+        unsigned int clusterID = 0;
+        float minDist = 0;
+        float dist = 0;
+        int clustIdx = 0;
+        for(unsigned int i = 0; i < numCandidates; ++i)
+        {
+            const unsigned int cluster = candidates[i];
+            dist = 0;
+            for(int b = 0; b < numBands; ++b)
+            {
+                clustIdx = (b*clusterCentres->m)+cluster;
+                dist += ((bands[b][p]-clusterCentres->matrix[clustIdx])*(bands[b][p]-clusterCentres->matrix[clustIdx]));
+            }
+            dist = sqrt(dist);
+            if((i == 0) || (dist < minDist))
+            {
+                clusterID = cluster+1;
+                minDist = dist;
+            }
+        }
+        return clusterID;
+    }
+    
     RSGISLabelPixelsUsingClustersCalcImg::~RSGISLabelPixelsUsingClustersCalcImg()
     {
         
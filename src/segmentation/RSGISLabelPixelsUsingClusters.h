@@ -25,9 +25,14 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
 #include <cmath>
 
 #include "common/RSGISImageException.h"
+#include "common/RSGISSIMDKernels.h"
+#include "common/RSGISOpenCL.h"
 
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
@@ -59,18 +64,57 @@ namespace rsgis{namespace segment{
     public:
         RSGISLabelPixelsUsingClusters();
         void labelPixelsUsingClusters(GDALDataset **datasets, int numDatasets, std::string output, std::string clusterCentresFile, bool ignoreZeros, std::string imageFormat, bool useImageProj, std::string outProjStr);
+        /** Labels the pixels into the existing (e.g., in memory) output dataset using the provided cluster centres. */
+        void labelPixelsUsingClusters(GDALDataset **datasets, int numDatasets, GDALDataset *outputDS, rsgis::math::Matrix *clusterCentres, bool ignoreZeros);
         ~RSGISLabelPixelsUsingClusters();
+    private:
+        /** True if all the bands are 8 bit, so the values can be looked up (see RSGISLabelPixelsUsingClustersCalcImg). */
+        bool isByteImage(GDALDataset **datasets, int numDatasets);
     };
     
+    /**
+     * Labels each pixel with the (1-based) index of the nearest cluster centre.
+     *
+     * The block API finds the nearest centres for strips of pixels with the
+     * expansion ||x||^2 + ||c||^2 - 2x.c, computed one band at a time so the loops
+     * over the pixels are vectorised, and only the centres within the rounding
+     * error of the nearest are compared with the per pixel distance, so the labels
+     * are the same as calcImageValue. If useByteLUT is true, blocks where all the
+     * values are integers from 0 to 255 (e.g., stretched 8 bit images) instead sum
+     * a table of the squared differences for each band value and centre. Where the
+     * GPU is used (see rsgis::RSGISOpenCLDevice::useDevice) the blocks are labelled
+     * on the device with the same operations as calcImageValue, falling back to the
+     * CPU if the device fails.
+     */
     class DllExport RSGISLabelPixelsUsingClustersCalcImg : public rsgis::img::RSGISCalcImageValue
     {
     public: 
-        RSGISLabelPixelsUsingClustersCalcImg(int numberOutBands, rsgis::math::Matrix *clusterCentres, bool ignoreZeros);
+        RSGISLabelPixelsUsingClustersCalcImg(int numberOutBands, rsgis::math::Matrix *clusterCentres, bool ignoreZeros, bool useByteLUT=false);
         void calcImageValue(float *bandValues, int numBands, double *output);
+        bool calcImageBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        rsgis::img::RSGISCalcImageValue* clone(){return new RSGISLabelPixelsUsingClustersCalcImg(*this);};
         ~RSGISLabelPixelsUsingClustersCalcImg();
     private:
+        bool calcByteLUTBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        bool calcGPUBlock(const float* const* bands, int numBands, size_t nPxls, double **output);
+        /** The label of calcImageValue for pixel p, only considering the candidate centres (in ascending order). */
+        unsigned int labelPxl(const float* const* bands, int numBands, size_t p, const unsigned int *candidates, unsigned int numCandidates);
         rsgis::math::Matrix *clusterCentres;
         bool ignoreZeros;
+        bool useByteLUT;
+        /// The squared length of each centre.
+        std::vector<double> centreSqLens;
+        double maxCentreSqLen;
+        /// (v - c)^2 for band b, value v and centre c at ((b*256)+v)*numClusters + c (shared by the clones).
+        std::shared_ptr< const std::vector<double> > byteLUT;
+        int byteLUTBands;
+        std::vector<double> stripDists;
+        std::vector<float> stripDistsF;
+        std::vector<double> stripSqLens;
+        std::vector<unsigned int> candidates;
+        /// The OpenCL kernel (shared by the clones) where the GPU is used, otherwise null.
+        std::shared_ptr<rsgis::RSGISOpenCLKernel> gpuKernel;
+        std::vector<unsigned int> gpuLabels;
     };
     
 }}
@@ -39,6 +39,8 @@ namespace rsgis{namespace segment{
             long minVal = 0;
             size_t numRows = 0;
             
+            inputImagePaths = RSGISMergeSegmentationTiles::sortTilesSpatially(inputImagePaths);
+            
             for(std::vector<std::string>::iterator iterFiles = inputImagePaths.begin(); iterFiles != inputImagePaths.end(); ++iterFiles)
             {
                 std::cout << "\t Opening - " << (*iterFiles) << std::endl;
@@ -97,9 +99,12 @@ namespace rsgis{namespace segment{
             size_t numRows = 0;
             long maxVal = 0;
             long minVal = 0;
-            size_t clumpsOffset = 0;
+            // Clump ID 0 is no data so the first body clump is 1.
+            size_t clumpsOffset = 1;
             size_t numClumps = 0;
                            
+            inputImagePaths = RSGISMergeSegmentationTiles::sortTilesSpatially(inputImagePaths);
+            
             for(std::vector<std::string>::iterator iterFiles = inputImagePaths.begin(); iterFiles != inputImagePaths.end(); ++iterFiles)
             {
                 std::cout << "\t Opening - " << (*iterFiles) << std::endl;
@@ -266,6 +271,39 @@ namespace rsgis{namespace segment{
         }
     }
     
+    std::vector<std::string> RSGISMergeSegmentationTiles::sortTilesSpatially(std::vector<std::string> inputImagePaths)
+    {
+        // The key of each tile is its origin in pixels, so the rows are ordered
+        // from the top of the image whatever the sign of the y resolution.
+        std::vector<std::pair<std::pair<double, double>, std::string> > tileKeys;
+        tileKeys.reserve(inputImagePaths.size());
+        double geoTrans[6];
+        for(std::vector<std::string>::iterator iterFiles = inputImagePaths.begin(); iterFiles != inputImagePaths.end(); ++iterFiles)
+        {
+            GDALDataset *inImage = (GDALDataset *) GDALOpen((*iterFiles).c_str(), GA_ReadOnly);
+            if(inImage == NULL)
+            {
+                std::string message = std::string("Could not open image ") + (*iterFiles);
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            inImage->GetGeoTransform(geoTrans);
+            GDALClose(inImage);
+            
+            double rowKey = (geoTrans[5] != 0)?(geoTrans[3] / geoTrans[5]):geoTrans[3];
+            double colKey = (geoTrans[1] != 0)?(geoTrans[0] / geoTrans[1]):geoTrans[0];
+            tileKeys.push_back(std::pair<std::pair<double, double>, std::string>(std::pair<double, double>(rowKey, colKey), (*iterFiles)));
+        }
+        std::sort(tileKeys.begin(), tileKeys.end());
+        
+        std::vector<std::string> sortedPaths;
+        sortedPaths.reserve(tileKeys.size());
+        for(size_t i = 0; i < tileKeys.size(); ++i)
+        {
+            sortedPaths.push_back(tileKeys[i].second);
+        }
+        return sortedPaths;
+    }
+    
     size_t RSGISMergeSegmentationTiles::numberBodyClumps(GDALRasterAttributeTable *gdalATT, std::string outColName, std::string clumpPosColName, int tileBody, size_t clumpsOffset)
     {
         size_t numBodyClumps = 0;
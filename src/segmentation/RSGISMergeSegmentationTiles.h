@@ -27,6 +27,8 @@
 #include <string>
 #include <cmath>
 #include <stdlib.h>
+#include <vector>
+#include <algorithm>
 
 #include "common/rsgis-tqdm.h"
 
@@ -66,6 +68,14 @@ namespace rsgis{namespace segment{
         void createTileBorderClumpMask(GDALDataset *borderMaskDataset, std::vector<std::string> inputImagePaths, unsigned int tileBoundary, unsigned int tileOverlap, unsigned int tileBody, std::string colsName);
         void mergeClumpBodies(GDALDataset *outputDataset, GDALDataset *borderMaskDataset, std::vector<std::string> inputImagePaths, unsigned int tileBoundary, unsigned int tileOverlap, unsigned int tileBody, std::string colsName);
         void mergeClumpImages(GDALDataset *outputDataset, std::vector<std::string> inputImagePaths, bool mergeRATs=false);
+        /**
+         * Sort tile images into spatial order (top to bottom and then left to right,
+         * from the origin of each image) so the result of merging tiles does not
+         * depend on the order the tiles were listed in (e.g., the order in which they
+         * were produced by concurrent jobs). Used by createTileBorderClumpMask and
+         * mergeClumpBodies, which read one tile at a time.
+         */
+        static std::vector<std::string> sortTilesSpatially(std::vector<std::string> inputImagePaths);
         ~RSGISMergeSegmentationTiles();
     protected:
         size_t numberBodyClumps(GDALRasterAttributeTable *gdalATT, std::string outColName, std::string clumpPosColName, int tileBody, size_t clumpsOffset);
@@ -88,14 +88,10 @@ namespace rsgis{namespace segment{
             std::cout << "Number of clumps is " << numRows << "\n";
             
             std::cout << "Read in neighbours\n";
-            std::vector<std::vector<size_t>* > *neighbours = attUtils.getRATNeighbours(clumpsImage, 1);
+            rastergis::RSGISClumpNeighbourGraph *neighbours = attUtils.getRATNeighbours(clumpsImage, 1);
             
-            if(numRows != neighbours->size())
+            if(numRows != neighbours->getNumClumps())
             {
-                for(std::vector<std::vector<size_t>* >::iterator iterNeigh = neighbours->begin(); iterNeigh != neighbours->end(); ++iterNeigh)
-                {
-                    delete *iterNeigh;
-                }
                 delete neighbours;
                 
                 throw rsgis::RSGISAttributeTableException("RAT size is different to the number of neighbours retrieved.");
@@ -106,214 +102,53 @@ namespace rsgis{namespace segment{
             int *noDataCol = attUtils.readIntColumn(rat, noDataClumpsCol, &tmpNumRows);
             std::cout << "Read input column\n";
             
-            double *numPxls = new double[numRows];
-            
-            double **meanVals = new double*[numSpecBands];
-            double **sumVals = new double*[numSpecBands];
+            // The means, sums and pixel counts of each clump (flat, numSpecBands values per clump).
+            std::vector<double> meanVals(numRows * numSpecBands);
+            std::vector<double> sumVals(numRows * numSpecBands);
+            std::vector<double> numPxls(numRows);
             
-            for(int i = 0; i < numSpecBands; ++i)
+            for(int n = 0; n < numSpecBands; ++n)
             {
                 tmpNumRows = 0;
-                meanVals[i] = attUtils.readDoubleColumn(rat, "Mean"+colNames.at(i), &tmpNumRows);
+                double *meanCol = attUtils.readDoubleColumn(rat, "Mean"+colNames.at(n), &tmpNumRows);
                 if(tmpNumRows != numRows)
                 {
+                    delete[] meanCol;
+                    delete neighbours;
                     throw rsgis::img::RSGISImageCalcException("Number of rows was incorrect. (Mean)");
                 }
                 tmpNumRows = 0;
-                sumVals[i] = attUtils.readDoubleColumn(rat, "Sum"+colNames.at(i), &tmpNumRows);
+                double *sumCol = attUtils.readDoubleColumn(rat, "Sum"+colNames.at(n), &tmpNumRows);
                 if(tmpNumRows != numRows)
                 {
+                    delete[] meanCol;
+                    delete[] sumCol;
+                    delete neighbours;
                     throw rsgis::img::RSGISImageCalcException("Number of rows was incorrect. (Sum)");
                 }
-            }
-            
-            
-            
-            std::vector<rsgisClumpInfo*> clumps;
-            for(size_t i = 0; i < numRows; ++i)
-            {
-                rsgisClumpInfo *clump = new rsgisClumpInfo();
-                clump->clumpID = i;
-                if(noDataCol[i] == 1)
-                {
-                    clump->clumpID = 0;
-                }
-                clump->origClumpIDs.push_back(i);
-                clump->merge = false;
-                clump->removed = false;
-                clump->mergeTo = NULL;
-                clump->meanVals = new double[numSpecBands];
-                clump->sumVals = new double[numSpecBands];
-                clump->numVals = numSpecBands;
-                for(size_t j = 0; j < numSpecBands; ++j)
+                for(size_t i = 0; i < numRows; ++i)
                 {
-                    clump->meanVals[j] = meanVals[j][i];
-                    clump->sumVals[j] = sumVals[j][i];
-                }
-                clump->numPxls = sumVals[0][i] / meanVals[0][i];
-                clump->neighbours.clear();
-                clump->selected = selectCol[i];
-                clump->noDataRegion = noDataCol[i];
-                clumps.push_back(clump);
-            }
-            for(size_t i = 0; i < numRows; ++i)
-            {
-                for(size_t j = 0; j < neighbours->at(i)->size(); ++j)
-                {
-                    clumps.at(i)->neighbours.push_back(clumps.at(neighbours->at(i)->at(j)));
-                }
-            }
-            
-            
-            double val = 0.0;
-            bool process = true;
-            bool first = true;
-            rsgisClumpInfo *minClump = NULL;
-            double minVal = 0.0;
-            bool found = false;
-            unsigned int processIter = 1;
-            rsgisClumpInfo *cClump;
-            rsgisClumpInfo *mClump;
-            while(process)
-            {
-                std::cout << "Processing Iteration " << processIter++ << std::endl;
-                process = false;
-                for(size_t i = 0; i < clumps.size(); ++i)
-                {
-                    cClump = clumps.at(i);
-                    if((cClump->selected == 1) & (!cClump->removed))
-                    {
-                        first = true;
-
-                        for(std::list<rsgisClumpInfo*>::iterator iterNeigh = cClump->neighbours.begin(); iterNeigh != cClump->neighbours.end(); ++iterNeigh)
-                        {
-                            if(((*iterNeigh)->selected != 1) & (!(*iterNeigh)->removed) & ((*iterNeigh)->noDataRegion != 1))
-                            {
-                                val = this->calcDist(cClump->meanVals, (*iterNeigh)->meanVals, numSpecBands);
-                                if(first)
-                                {
-                                    minClump = (*iterNeigh);
-                                    minVal = val;
-                                    first = false;
-                                }
-                                else if(val < minVal)
-                                {
-                                    minClump = (*iterNeigh);
-                                    minVal = val;
-                                }
-                            }
-                        }
-                        
-                        if(!first)
-                        {
-                            cClump->merge = true;
-                            cClump->mergeTo = minClump;
-
-                            process = true;
-                        }
-                    }
+                    meanVals[(i * numSpecBands) + n] = meanCol[i];
+                    sumVals[(i * numSpecBands) + n] = sumCol[i];
                 }
-                
-                if(process)
+                if(n == 0)
                 {
-                    for(size_t i = 0; i < clumps.size(); ++i)
+                    for(size_t i = 0; i < numRows; ++i)
                     {
-                        cClump = clumps.at(i);
-                        if(cClump->merge)
-                        {
-                            mClump = cClump->mergeTo;
-                            cClump->removed = true;
-                            mClump->origClumpIDs.push_back(cClump->clumpID);
-                            
-                            mClump->numPxls += cClump->numPxls;
-                            for(int n = 0; n < numSpecBands; ++n)
-                            {
-                                mClump->sumVals[n] += cClump->sumVals[n];
-                                mClump->meanVals[n] = mClump->sumVals[n] / mClump->numPxls;
-                            }
-                            
-                            for(std::list<rsgisClumpInfo*>::iterator iterNeigh = mClump->neighbours.begin(); iterNeigh != mClump->neighbours.end(); ++iterNeigh)
-                            {
-                                if((*iterNeigh)->clumpID == cClump->clumpID)
-                                {
-                                    mClump->neighbours.erase(iterNeigh);
-                                    break;
-                                }
-                            }
-                            
-                            for(std::list<rsgisClumpInfo*>::iterator iterNeighC = cClump->neighbours.begin(); iterNeighC != cClump->neighbours.end(); ++iterNeighC)
-                            {
-                                if((*iterNeighC)->clumpID != mClump->clumpID)
-                                {
-                                    found = false;
-                                    for(std::list<rsgisClumpInfo*>::iterator iterNeighM = mClump->neighbours.begin(); iterNeighM != mClump->neighbours.end(); ++iterNeighM)
-                                    {
-                                        if((*iterNeighM)->clumpID == (*iterNeighC)->clumpID)
-                                        {
-                                            found = true;
-                                            break;
-                                        }
-                                    }
-                                    if(!found)
-                                    {
-                                        mClump->neighbours.push_back(*iterNeighC);
-                                        found = false;
-                                        for(std::list<rsgisClumpInfo*>::iterator iterNeighSec = (*iterNeighC)->neighbours.begin(); iterNeighSec != (*iterNeighC)->neighbours.end(); ++iterNeighSec)
-                                        {
-                                            if((*iterNeighSec)->clumpID == mClump->clumpID)
-                                            {
-                                                found = true;
-                                                break;
-                                            }
-                                        }
-                                        if(!found)
-                                        {
-                                            (*iterNeighC)->neighbours.push_back(mClump);
-                                        }
-                                    }
-                                }
-                            }
-                            cClump->neighbours.clear();
-                        }
+                        numPxls[i] = sumCol[i] / meanCol[i];
                     }
                 }
+                delete[] meanCol;
+                delete[] sumCol;
             }
-            std::cout << "Completed Iterations\n";
-            
             
             int *clumpIDUp = new int[numRows];
-            for(size_t i = 0; i < clumps.size(); ++i)
-            {
-                cClump = clumps.at(i);
-                if(!cClump->removed)
-                {
-                    for(std::vector<unsigned int>::iterator iterClumpIDs = cClump->origClumpIDs.begin(); iterClumpIDs != cClump->origClumpIDs.end(); ++iterClumpIDs)
-                    {
-                        clumpIDUp[*iterClumpIDs] = cClump->clumpID;
-                    }
-                }
-            }
-            attUtils.writeIntColumn(rat, "OutClumpIDs", clumpIDUp, numRows);
-            
-            for(size_t i = 0; i < clumps.size(); ++i)
-            {
-                cClump = clumps.at(i);
-                cClump->neighbours.clear();
-                delete cClump->meanVals;
-                delete cClump->sumVals;
-                delete cClump;
-            }
-            clumps.clear();
+            this->mergeSelectedClumpsWithNeighbours(neighbours, selectCol, noDataCol, numSpecBands, &meanVals, &sumVals, &numPxls, clumpIDUp);
+            delete neighbours;
+            std::cout << "Completed Iterations\n";
             
+            attUtils.writeIntColumn(rat, "OutClumpIDs", clumpIDUp, numRows);
             
-            for(int i = 0; i < numSpecBands; ++i)
-            {
-                delete[] meanVals[i];
-                delete[] sumVals[i];
-            }
-            delete[] meanVals;
-            delete[] sumVals;
-            delete[] numPxls;
             delete[] selectCol;
             delete[] noDataCol;
             delete[] clumpIDUp;
@@ -349,14 +184,10 @@ namespace rsgis{namespace segment{
             size_t numRows = rat->GetRowCount();
             std::cout << "Number of clumps is " << numRows << "\n";
             
-            std::vector<std::vector<size_t>* > *neighbours = attUtils.getRATNeighbours(clumpsImage, 1);
+            rastergis::RSGISClumpNeighbourGraph *neighbours = attUtils.getRATNeighbours(clumpsImage, 1);
             
-            if(numRows != neighbours->size())
+            if(numRows != neighbours->getNumClumps())
             {
-                for(std::vector<std::vector<size_t>* >::iterator iterNeigh = neighbours->begin(); iterNeigh != neighbours->end(); ++iterNeigh)
-                {
-                    delete *iterNeigh;
-                }
                 delete neighbours;
                 
                 throw rsgis::RSGISAttributeTableException("RAT size is different to the number of neighbours retrieved.");
@@ -371,120 +202,227 @@ namespace rsgis{namespace segment{
             }
             
             
-            std::vector<rsgisClumpMergeInfo*> clumps;
-            for(size_t i = 0; i < numRows; ++i)
+            std::vector<int*> clumpVals(clumps2MergeCol, clumps2MergeCol + numCols);
+            int *clumpIDUp = new int[numRows];
+            std::cout << "Merge Equivalent Clumps\n";
+            this->mergeEquivalentNeighbours(neighbours, clumpVals, clumpIDUp);
+            delete neighbours;
+            
+            attUtils.writeIntColumn(rat, "OutClumpIDs", clumpIDUp, numRows);
+            delete[] clumpIDUp;
+            
+            for(size_t i = 0; i < numCols; ++i)
             {
-                rsgisClumpMergeInfo *clump = new rsgisClumpMergeInfo();
-                clump->clumpID = i;
-                clump->origClumpIDs.push_back(i);
-                for(size_t j = 0; j < numCols; ++j)
-                {
-                    clump->clumpVal.push_back(clumps2MergeCol[j][i]);
-                }
-                clump->merge = false;
-                clump->mergeTo = NULL;
-                clump->neighbours.clear();
-                clumps.push_back(clump);
+                delete[] clumps2MergeCol[i];
             }
-            for(size_t i = 0; i < numRows; ++i)
+            delete[] clumps2MergeCol;
+        }
+        catch(rsgis::img::RSGISImageCalcException &e)
+        {
+            throw e;
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw rsgis::img::RSGISImageCalcException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw rsgis::img::RSGISImageCalcException(e.what());
+        }
+    }
+    
+    void RSGISMergeSegments::mergeSelectedClumpsWithNeighbours(rastergis::RSGISClumpNeighbourGraph *neighbours, const int *selectCol, const int *noDataCol, unsigned int numSpecBands, std::vector<double> *meanVals, std::vector<double> *sumVals, std::vector<double> *numPxls, int *outClumpIDs)
+    {
+        size_t numClumps = neighbours->getNumClumps();
+        RSGISMergeNeighbourSets neighSets(neighbours);
+        std::vector<bool> removed(numClumps, false);
+        std::vector<size_t> mergeTo(numClumps);
+        for(size_t i = 0; i < numClumps; ++i)
+        {
+            mergeTo[i] = i;
+        }
+        double *means = meanVals->data();
+        double *sums = sumVals->data();
+        
+        // Candidate merges as (round, clump), so each round tests its clumps in clump order.
+        typedef std::pair<size_t, size_t> RoundClump;
+        std::priority_queue<RoundClump, std::vector<RoundClump>, std::greater<RoundClump> > candidates;
+        for(size_t i = 0; i < numClumps; ++i)
+        {
+            if(selectCol[i] == 1)
             {
-                for(size_t j = 0; j < neighbours->at(i)->size(); ++j)
-                {
-                    clumps.at(i)->neighbours.push_back(clumps.at(neighbours->at(i)->at(j)));
-                }
+                candidates.push(RoundClump(1, i));
             }
-            
-            std::cout << "Run Iterative Merge\n";
-            rsgis_tqdm pbar;
-            rsgisClumpMergeInfo *cClump;
-            unsigned int outIdx = 0;
-            for(size_t i = 0; i < clumps.size(); ++i)
+        }
+        
+        std::vector<std::pair<size_t, size_t> > roundMerges;
+        while(!candidates.empty())
+        {
+            size_t round = candidates.top().first;
+            std::cout << "Processing Iteration " << round << std::endl;
+            
+            // Choose the closest valid neighbour of each candidate, with the means at the start of
+            // the round, where ties go to the neighbour which was added first.
+            roundMerges.clear();
+            size_t lastClump = numClumps;
+            while((!candidates.empty()) && (candidates.top().first == round))
             {
-                pbar.progress(i, numRows);
-                
-                cClump = clumps.at(i);
+                size_t clump = candidates.top().second;
+                candidates.pop();
+                if((clump == lastClump) || removed[clump])
+                {
+                    continue;
+                }
+                lastClump = clump;
                 
-                if((!cClump->merge) && (cClump->neighbours.size() > 0))
+                bool first = true;
+                size_t minClump = 0;
+                size_t minOrder = 0;
+                double minVal = 0.0;
+                size_t numNeighs = neighSets.getNumNeighbours(clump);
+                for(size_t n = 0; n < numNeighs; ++n)
                 {
-                    cClump->clumpID = outIdx;
-                    cClump->merge = true;
-                    for(std::list<rsgisClumpMergeInfo*>::iterator iterNeigh = cClump->neighbours.begin(); iterNeigh != cClump->neighbours.end(); ++iterNeigh)
+                    rsgisMergeNeighbour neigh = neighSets.getNeighbour(clump, n);
+                    if((selectCol[neigh.clump] != 1) && (!removed[neigh.clump]) && (noDataCol[neigh.clump] != 1))
                     {
-                        if(!(*iterNeigh)->merge)
+                        double val = this->calcDist(means + (clump * numSpecBands), means + (neigh.clump * numSpecBands), numSpecBands);
+                        if(first || (val < minVal) || ((val == minVal) && (neigh.order < minOrder)))
                         {
-                            this->mergeClump2Neighbours(cClump, *iterNeigh, outIdx);
+                            minClump = neigh.clump;
+                            minOrder = neigh.order;
+                            minVal = val;
+                            first = false;
                         }
                     }
-                    ++outIdx;
                 }
-                else if(!cClump->merge)
+                if(!first)
                 {
-                    cClump->clumpID = outIdx;
-                    ++outIdx;
+                    roundMerges.push_back(std::pair<size_t, size_t>(clump, minClump));
                 }
             }
-            pbar.finish();
-            
-            int *clumpIDUp = new int[numRows];
-            for(size_t i = 0; i < clumps.size(); ++i)
-            {
-                cClump = clumps.at(i);
-                clumpIDUp[i] = cClump->clumpID;
-            }
-            attUtils.writeIntColumn(rat, "OutClumpIDs", clumpIDUp, numRows);
             
-            for(size_t i = 0; i < clumps.size(); ++i)
+            // Apply the merges in clump order.
+            for(std::vector<std::pair<size_t, size_t> >::iterator iterMerge = roundMerges.begin(); iterMerge != roundMerges.end(); ++iterMerge)
             {
-                cClump = clumps.at(i);
-                cClump->neighbours.clear();
-                delete cClump;
+                size_t clump = iterMerge->first;
+                size_t mClump = iterMerge->second;
+                removed[clump] = true;
+                mergeTo[clump] = mClump;
+                
+                (*numPxls)[mClump] += (*numPxls)[clump];
+                for(unsigned int n = 0; n < numSpecBands; ++n)
+                {
+                    sums[(mClump * numSpecBands) + n] += sums[(clump * numSpecBands) + n];
+                    means[(mClump * numSpecBands) + n] = sums[(mClump * numSpecBands) + n] / (*numPxls)[mClump];
+                }
+                
+                // The neighbours of the merged clump become neighbours of the clump it was merged into,
+                // where any selected clump gaining a neighbour is tested again in the next round.
+                neighSets.remove(mClump, clump);
+                std::vector<rsgisMergeNeighbour> clumpNeighs;
+                size_t numNeighs = neighSets.getNumNeighbours(clump);
+                clumpNeighs.reserve(numNeighs);
+                for(size_t n = 0; n < numNeighs; ++n)
+                {
+                    clumpNeighs.push_back(neighSets.getNeighbour(clump, n));
+                }
+                std::sort(clumpNeighs.begin(), clumpNeighs.end(), [](const rsgisMergeNeighbour &a, const rsgisMergeNeighbour &b){return a.order < b.order;});
+                for(std::vector<rsgisMergeNeighbour>::iterator iterNeigh = clumpNeighs.begin(); iterNeigh != clumpNeighs.end(); ++iterNeigh)
+                {
+                    size_t neigh = iterNeigh->clump;
+                    if((neigh == mClump) || removed[neigh] || neighSets.contains(mClump, neigh))
+                    {
+                        continue;
+                    }
+                    neighSets.add(mClump, neigh);
+                    if(!neighSets.contains(neigh, mClump))
+                    {
+                        neighSets.add(neigh, mClump);
+                        if(selectCol[neigh] == 1)
+                        {
+                            candidates.push(RoundClump(round+1, neigh));
+                        }
+                    }
+                }
+                neighSets.clear(clump);
             }
-            clumps.clear();
-
-            delete[] clumps2MergeCol;
         }
-        catch(rsgis::img::RSGISImageCalcException &e)
+        
+        // The clumps are only merged into unselected clumps, which are not merged themselves.
+        for(size_t i = 0; i < numClumps; ++i)
         {
-            throw e;
+            size_t outClump = mergeTo[i];
+            outClumpIDs[i] = (noDataCol[outClump] == 1)?0:outClump;
         }
-        catch (rsgis::RSGISException &e)
-        {
-            throw rsgis::img::RSGISImageCalcException(e.what());
-        }
-        catch (std::exception &e)
+    }
+    
+    // Find the root of a clump's set, halving the path to it.
+    static size_t rsgisFindMergeRoot(std::vector<size_t> &parents, size_t clump)
+    {
+        while(parents[clump] != clump)
         {
-            throw rsgis::img::RSGISImageCalcException(e.what());
+            parents[clump] = parents[parents[clump]];
+            clump = parents[clump];
         }
+        return clump;
     }
     
-    void RSGISMergeSegments::mergeClump2Neighbours(rsgisClumpMergeInfo *baseClump, rsgisClumpMergeInfo *testClump, unsigned int outIdx)
+    void RSGISMergeSegments::mergeEquivalentNeighbours(rastergis::RSGISClumpNeighbourGraph *neighbours, const std::vector<int*> &clumpVals, int *outClumpIDs)
     {
-        unsigned int numVals = baseClump->clumpVal.size();
-        bool sameVal = true;
-        for(unsigned int i = 0; i < numVals; ++i)
+        size_t numClumps = neighbours->getNumClumps();
+        size_t numCols = clumpVals.size();
+        std::vector<size_t> parents(numClumps);
+        for(size_t i = 0; i < numClumps; ++i)
         {
-            if(baseClump->clumpVal.at(i) != testClump->clumpVal.at(i))
-            {
-                sameVal = false;
-                break;
-            }
+            parents[i] = i;
         }
-        if(sameVal)
+        
+        rsgis_tqdm pbar;
+        for(size_t i = 0; i < numClumps; ++i)
         {
-            baseClump->origClumpIDs.push_back(testClump->clumpID);
-            testClump->merge = true;
-            testClump->mergeTo = baseClump;
-            testClump->clumpID = outIdx;
-            if(testClump->neighbours.size() > 0)
+            pbar.progress(i, numClumps);
+            size_t numNeighs = neighbours->getNumNeighbours(i);
+            for(size_t n = 0; n < numNeighs; ++n)
             {
-                for(std::list<rsgisClumpMergeInfo*>::iterator iterNeigh = testClump->neighbours.begin(); iterNeigh != testClump->neighbours.end(); ++iterNeigh)
+                size_t neigh = neighbours->getNeighbour(i, n);
+                bool sameVal = true;
+                for(size_t c = 0; c < numCols; ++c)
                 {
-                    if(!(*iterNeigh)->merge)
+                    if(clumpVals[c][i] != clumpVals[c][neigh])
                     {
-                        this->mergeClump2Neighbours(baseClump, *iterNeigh, outIdx);
+                        sameVal = false;
+                        break;
                     }
                 }
+                if(sameVal)
+                {
+                    // The root of each set is its lowest clump.
+                    size_t rootA = rsgisFindMergeRoot(parents, i);
+                    size_t rootB = rsgisFindMergeRoot(parents, neigh);
+                    if(rootA < rootB)
+                    {
+                        parents[rootB] = rootA;
+                    }
+                    else if(rootB < rootA)
+                    {
+                        parents[rootA] = rootB;
+                    }
+                }
+            }
+        }
+        pbar.finish();
+        
+        // Number the merged clumps in the order of their first (root) clump.
+        std::vector<int> outIdxs(numClumps, -1);
+        int outIdx = 0;
+        for(size_t i = 0; i < numClumps; ++i)
+        {
+            size_t root = rsgisFindMergeRoot(parents, i);
+            if(outIdxs[root] < 0)
+            {
+                outIdxs[root] = outIdx++;
             }
+            outClumpIDs[i] = outIdxs[root];
         }
     }
     
@@ -493,5 +431,96 @@ namespace rsgis{namespace segment{
         
     }
     
+    
+    RSGISMergeNeighbourSets::RSGISMergeNeighbourSets(rastergis::RSGISClumpNeighbourGraph *graph)
+    {
+        this->graph = graph;
+        this->setIdxs.assign(graph->getNumClumps(), std::numeric_limits<size_t>::max());
+    }
+    
+    size_t RSGISMergeNeighbourSets::getNumNeighbours(size_t clump)
+    {
+        if(this->setIdxs[clump] == std::numeric_limits<size_t>::max())
+        {
+            return this->graph->getNumNeighbours(clump);
+        }
+        return this->sets[this->setIdxs[clump]].size();
+    }
+    
+    rsgisMergeNeighbour RSGISMergeNeighbourSets::getNeighbour(size_t clump, size_t n)
+    {
+        if(this->setIdxs[clump] == std::numeric_limits<size_t>::max())
+        {
+            rsgisMergeNeighbour neigh;
+            neigh.clump = this->graph->getNeighbour(clump, n);
+            neigh.order = n;
+            return neigh;
+        }
+        return this->sets[this->setIdxs[clump]][n];
+    }
+    
+    static bool rsgisMergeNeighbourLess(const rsgisMergeNeighbour &neigh, size_t clump)
+    {
+        return neigh.clump < clump;
+    }
+    
+    bool RSGISMergeNeighbourSets::contains(size_t clump, size_t neighbour)
+    {
+        std::vector<rsgisMergeNeighbour> &set = this->getSet(clump);
+        std::vector<rsgisMergeNeighbour>::iterator iterNeigh = std::lower_bound(set.begin(), set.end(), neighbour, rsgisMergeNeighbourLess);
+        return (iterNeigh != set.end()) && (iterNeigh->clump == neighbour);
+    }
+    
+    void RSGISMergeNeighbourSets::add(size_t clump, size_t neighbour)
+    {
+        std::vector<rsgisMergeNeighbour> &set = this->getSet(clump);
+        std::vector<rsgisMergeNeighbour>::iterator iterNeigh = std::lower_bound(set.begin(), set.end(), neighbour, rsgisMergeNeighbourLess);
+        if((iterNeigh == set.end()) || (iterNeigh->clump != neighbour))
+        {
+            rsgisMergeNeighbour neigh;
+            neigh.clump = neighbour;
+            neigh.order = this->nextOrders[this->setIdxs[clump]]++;
+            set.insert(iterNeigh, neigh);
+        }
+    }
+    
+    void RSGISMergeNeighbourSets::remove(size_t clump, size_t neighbour)
+    {
+        std::vector<rsgisMergeNeighbour> &set = this->getSet(clump);
+        std::vector<rsgisMergeNeighbour>::iterator iterNeigh = std::lower_bound(set.begin(), set.end(), neighbour, rsgisMergeNeighbourLess);
+        if((iterNeigh != set.end()) && (iterNeigh->clump == neighbour))
+        {
+            set.erase(iterNeigh);
+        }
+    }
+    
+    void RSGISMergeNeighbourSets::clear(size_t clump)
+    {
+        std::vector<rsgisMergeNeighbour> &set = this->getSet(clump);
+        std::vector<rsgisMergeNeighbour>().swap(set);
+    }
+    
+    std::vector<rsgisMergeNeighbour>& RSGISMergeNeighbourSets::getSet(size_t clump)
+    {
+        if(this->setIdxs[clump] == std::numeric_limits<size_t>::max())
+        {
+            // Copy the neighbours from the graph, in the order they were read, to a set sorted by clump.
+            size_t numNeighs = this->graph->getNumNeighbours(clump);
+            std::vector<rsgisMergeNeighbour> set(numNeighs);
+            for(size_t n = 0; n < numNeighs; ++n)
+            {
+                set[n].clump = this->graph->getNeighbour(clump, n);
+                set[n].order = n;
+            }
+            std::sort(set.begin(), set.end(), [](const rsgisMergeNeighbour &a, const rsgisMergeNeighbour &b){return (a.clump < b.clump) || ((a.clump == b.clump) && (a.order < b.order));});
+            set.erase(std::unique(set.begin(), set.end(), [](const rsgisMergeNeighbour &a, const rsgisMergeNeighbour &b){return a.clump == b.clump;}), set.end());
+            this->setIdxs[clump] = this->sets.size();
+            this->sets.push_back(std::vector<rsgisMergeNeighbour>());
+            this->sets.back().swap(set);
+            this->nextOrders.push_back(numNeighs);
+        }
+        return this->sets[this->setIdxs[clump]];
+    }
+    
 }}
 
@@ -27,6 +27,11 @@
 #include <string>
 #include <cmath>
 #include <stdlib.h>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <limits>
 
 #include "common/rsgis-tqdm.h"
 #include "common/RSGISAttributeTableException.h"
@@ -48,6 +53,7 @@
 
 #include "rastergis/RSGISRasterAttUtils.h"
 #include "rastergis/RSGISFindClumpNeighbours.h"
+#include "rastergis/RSGISClumpNeighbourGraph.h"
 #include "rastergis/RSGISPopRATWithStats.h"
 
 // mark all exported classes/functions with DllExport to have
@@ -65,30 +71,39 @@
 
 namespace rsgis{namespace segment{
     
-    struct rsgisClumpInfo
+    /** A neighbour of a clump being merged, with the order in which it was added to the clump's neighbours. */
+    struct rsgisMergeNeighbour
     {
-        unsigned int clumpID;
-        std::vector<unsigned int> origClumpIDs;
-        double *meanVals;
-        double *sumVals;
-        double numPxls;
-        unsigned int numVals;
-        unsigned int selected;
-        unsigned int noDataRegion;
-        bool merge;
-        rsgisClumpInfo *mergeTo;
-        std::list<rsgisClumpInfo*> neighbours;
-        bool removed;
+        size_t clump;
+        size_t order;
     };
     
-    struct rsgisClumpMergeInfo
+    /**
+     * The neighbours of the clumps while they are merged. The neighbours of a clump
+     * are read from the (CSR) neighbour graph until they are first changed, when they
+     * are copied to a flat set (a vector sorted by clump index), so membership tests,
+     * additions and removals are a binary search rather than a list traversal. The
+     * order each neighbour was added is kept so ties can go to the earliest neighbour.
+     */
+    class DllExport RSGISMergeNeighbourSets
     {
-        unsigned int clumpID;
-        std::vector<unsigned int> origClumpIDs;
-        std::vector<long> clumpVal;
-        bool merge;
-        rsgisClumpMergeInfo *mergeTo;
-        std::list<rsgisClumpMergeInfo*> neighbours;
+    public:
+        RSGISMergeNeighbourSets(rastergis::RSGISClumpNeighbourGraph *graph);
+        size_t getNumNeighbours(size_t clump);
+        /** Get the n'th neighbour of a clump (in clump index order once the neighbours have been changed). */
+        rsgisMergeNeighbour getNeighbour(size_t clump, size_t n);
+        bool contains(size_t clump, size_t neighbour);
+        /** Add a neighbour (if not already a neighbour), which is ordered after the existing neighbours. */
+        void add(size_t clump, size_t neighbour);
+        void remove(size_t clump, size_t neighbour);
+        void clear(size_t clump);
+        ~RSGISMergeNeighbourSets(){};
+    protected:
+        std::vector<rsgisMergeNeighbour>& getSet(size_t clump);
+        rastergis::RSGISClumpNeighbourGraph *graph;
+        std::vector<size_t> setIdxs;
+        std::vector<std::vector<rsgisMergeNeighbour> > sets;
+        std::vector<size_t> nextOrders;
     };
     
     class DllExport RSGISMergeSegments
@@ -109,7 +124,21 @@ namespace rsgis{namespace segment{
             outVal = sqrt(outVal/numVals);
             return outVal;
         };
-        void mergeClump2Neighbours(rsgisClumpMergeInfo *baseClump, rsgisClumpMergeInfo *testClump, unsigned int outIdx);
+        /**
+         * Merge each selected clump with its (unselected, not no data) neighbour with the closest
+         * mean, in rounds where each clump's neighbour is chosen with the means at the start of
+         * the round and the merges are then applied in clump order. The selected clumps to be
+         * tested in each round are taken from a priority queue of (round, clump), so only the
+         * clumps which gained a neighbour in the last round are tested again. The means and sums
+         * (numSpecBands per clump) and pixel counts are updated and the output clump ID of each
+         * clump is written to outClumpIDs.
+         */
+        void mergeSelectedClumpsWithNeighbours(rastergis::RSGISClumpNeighbourGraph *neighbours, const int *selectCol, const int *noDataCol, unsigned int numSpecBands, std::vector<double> *meanVals, std::vector<double> *sumVals, std::vector<double> *numPxls, int *outClumpIDs);
+        /**
+         * Merge the neighbouring clumps with the same values in all the columns using union-find,
+         * numbering the merged clumps (from 0) in the order of the first clump of each.
+         */
+        void mergeEquivalentNeighbours(rastergis::RSGISClumpNeighbourGraph *neighbours, const std::vector<int*> &clumpVals, int *outClumpIDs);
     };
     
 
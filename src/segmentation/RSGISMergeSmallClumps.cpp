@@ -54,6 +54,8 @@ namespace rsgis{namespace segment{
             spectralVals[n] = new float[width];
         }
         GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
+        // The random neighbour reads and writes are within the clumps array, which is written back at the end.
+        RSGISClumpsArray clumpsArr(clumps, 1);
         
         unsigned long clumpIdx = 0;
         unsigned int uiPxlVal = 0;
@@ -63,7 +65,7 @@ namespace rsgis{namespace segment{
         {
             for(unsigned int j = 0; j < width; ++j)
             {
-                clumpBand->RasterIO(GF_Read, j, i, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                clumpIdx = clumpsArr.getValue(j, i);
                 if((i == 0) & (j == 0))
                 {
                     maxClumpIdx = clumpIdx;
@@ -80,11 +82,13 @@ namespace rsgis{namespace segment{
         
         rsgis::img::ImgClump *cClump = NULL;
         rsgis::img::ImgClump *tClump = NULL;
+        // The clumps and their band values are held in an arena which is released with the table.
+        rsgis::RSGISArena clumpArena;
         for(unsigned int i = 0; i < maxClumpIdx; ++i)
         {
-            cClump = new rsgis::img::ImgClump(i+1);
-            cClump->sumVals = new float[numSpecBands];
-            cClump->meanVals = new float[numSpecBands];
+            cClump = clumpArena.create<rsgis::img::ImgClump>(i+1);
+            cClump->sumVals = clumpArena.allocArray<float>(numSpecBands);
+            cClump->meanVals = clumpArena.allocArray<float>(numSpecBands);
             cClump->pxls = new std::vector<rsgis::img::PxlLoc>();
             cClump->active = true;
             for(unsigned int n = 0; n < numSpecBands; ++n)
@@ -132,7 +136,7 @@ namespace rsgis{namespace segment{
         std::cout << "There are " << clumpTable->size() << " clumps. " << smallClumps.size() << " are too small\n";
         
         rsgis::img::PxlLoc tLoc;
-        std::list<unsigned long> neighbours;
+        std::vector<unsigned long> neighbours;
         unsigned long closestNeighbour = 0;
         bool firstNeighbourTested = true;
         float closestNeighbourDist = 0;
@@ -151,14 +155,14 @@ namespace rsgis{namespace segment{
             // Check that the clump was not selected for a merging already and therefore over minimum size...
             if((cClump->active) & (cClump->pxls->size() < minClumpSize))
             {
-                // Get list of neighbours.
+                // Get the neighbours.
                 neighbours.clear();
                 for(std::vector<rsgis::img::PxlLoc>::iterator iterPxls = cClump->pxls->begin(); iterPxls != cClump->pxls->end(); ++iterPxls)
                 {
                     // Above
                     if(((long)(*iterPxls).yPos)-1 >= 0)
                     {
-                        clumpBand->RasterIO(GF_Read, (*iterPxls).xPos, (*iterPxls).yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                        uiPxlVal = clumpsArr.getValue((*iterPxls).xPos, (*iterPxls).yPos-1);
                         if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                         {
                             neighbours.push_back(uiPxlVal);
@@ -167,7 +171,7 @@ namespace rsgis{namespace segment{
                     // Below
                     if(((long)(*iterPxls).yPos)+1 < height)
                     {
-                        clumpBand->RasterIO(GF_Read, (*iterPxls).xPos, (*iterPxls).yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                        uiPxlVal = clumpsArr.getValue((*iterPxls).xPos, (*iterPxls).yPos+1);
                         if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                         {
                             neighbours.push_back(uiPxlVal);
@@ -176,7 +180,7 @@ namespace rsgis{namespace segment{
                     // Left
                     if(((long)(*iterPxls).xPos-1) >= 0)
                     {
-                        clumpBand->RasterIO(GF_Read, (*iterPxls).xPos-1, (*iterPxls).yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                        uiPxlVal = clumpsArr.getValue((*iterPxls).xPos-1, (*iterPxls).yPos);
                         if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                         {
                             neighbours.push_back(uiPxlVal);
@@ -185,19 +189,19 @@ namespace rsgis{namespace segment{
                     // Right
                     if(((long)(*iterPxls).xPos+1) < width)
                     {
-                        clumpBand->RasterIO(GF_Read, (*iterPxls).xPos+1, (*iterPxls).yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                        uiPxlVal = clumpsArr.getValue((*iterPxls).xPos+1, (*iterPxls).yPos);
                         if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                         {
                             neighbours.push_back(uiPxlVal);
                         }
                     }
                 }
-                neighbours.sort();
-                neighbours.unique();
+                std::sort(neighbours.begin(), neighbours.end());
+                neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
                 
                 // Decide on which neighbour to measure with.
                 firstNeighbourTested = true;
-                for(std::list<unsigned long>::iterator iterClumps = neighbours.begin(); iterClumps != neighbours.end(); ++iterClumps)
+                for(std::vector<unsigned long>::iterator iterClumps = neighbours.begin(); iterClumps != neighbours.end(); ++iterClumps)
                 {
                     if(firstNeighbourTested)
                     {
@@ -223,7 +227,7 @@ namespace rsgis{namespace segment{
                         tLoc = cClump->pxls->at(n);
                         tClump->pxls->push_back(tLoc);
                         // Update Pixel Values - in clump image.
-                        clumpBand->RasterIO(GF_Write, tLoc.xPos, tLoc.yPos, 1, 1, &closestNeighbour, 1, 1, GDT_UInt32, 0, 0);
+                        clumpsArr.setValue(tLoc.xPos, tLoc.yPos, closestNeighbour);
                     }
                     for(unsigned int b = 0; b < numSpecBands; ++b)
                     {
@@ -231,8 +235,6 @@ namespace rsgis{namespace segment{
                         tClump->meanVals[b] = tClump->sumVals[b]/tClump->pxls->size();
                     }
                     
-                    delete cClump->sumVals;
-                    delete cClump->meanVals;
                     delete cClump->pxls;
                     cClump->active = false;
                     
@@ -249,7 +251,7 @@ namespace rsgis{namespace segment{
         }
         std::cout << "Eliminated " << smallClumpsCounter << " small clumps\n";
         
-        
+        clumpsArr.flush();
         
         for(std::vector<rsgis::img::ImgClump*>::iterator iterClumps = clumpTable->begin(); iterClumps != clumpTable->end(); ++iterClumps)
         {
@@ -257,11 +259,8 @@ namespace rsgis{namespace segment{
             {
                 if((*iterClumps)->active)
                 {
-                    delete (*iterClumps)->sumVals;
-                    delete (*iterClumps)->meanVals;
                     delete (*iterClumps)->pxls;
                 }
-                delete (*iterClumps);
             }
         }
         delete clumpTable;
@@ -29,12 +29,17 @@
 #include <deque>
 #include <list>
 #include <cmath>
+#include <algorithm>
 
 #include "gdal_priv.h"
 
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISImageCalcException.h"
 
+#include "common/RSGISArena.h"
+
+#include "segmentation/RSGISClumpsArray.h"
+
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
 #undef DllExport
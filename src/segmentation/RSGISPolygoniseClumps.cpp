@@ -0,0 +1,440 @@
+/*
+ *  RSGISPolygoniseClumps.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISPolygoniseClumps.h"
+
+namespace rsgis{namespace segment{
+    
+    RSGISPolygoniseClumps::RSGISPolygoniseClumps()
+    {
+        rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+        this->numThreads = context.numThreads;
+        this->numIOBuffers = context.numIOBuffers;
+        this->stripMemoryMB = context.stripMemoryMB;
+    }
+    
+    void RSGISPolygoniseClumps::polygoniseClumps(GDALDataset *clumps, unsigned int band, OGRLayer *outLayer, std::string outField, bool use8Conn)
+    {
+        if((band == 0) || (band > ((unsigned int)clumps->GetRasterCount())))
+        {
+            throw rsgis::img::RSGISImageCalcException("The band specified is not within the clumps image.");
+        }
+        GDALRasterBand *clumpBand = clumps->GetRasterBand(band);
+        unsigned int width = clumps->GetRasterXSize();
+        unsigned int height = clumps->GetRasterYSize();
+        double transform[6];
+        clumps->GetGeoTransform(transform);
+        
+        int fieldIdx = outLayer->GetLayerDefn()->GetFieldIndex(outField.c_str());
+        if(fieldIdx < 0)
+        {
+            OGRFieldDefn fieldDefn(outField.c_str(), OFTInteger64);
+            if(outLayer->CreateField(&fieldDefn) != OGRERR_NONE)
+            {
+                throw rsgis::RSGISVectorException("Creating field '" + outField + "' has failed.");
+            }
+            fieldIdx = outLayer->GetLayerDefn()->GetFieldIndex(outField.c_str());
+        }
+        
+        if((width == 0) || (height == 0))
+        {
+            return;
+        }
+        
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        unsigned int nTileThreads = threadPool.getNumThreads();
+        
+        // Each strip is split into a tile per thread, allowing for the clump IDs and
+        // (about) two boundary edges per pixel.
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        clumpBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), width, height, sizeof(uint64_t) + (2 * sizeof(RSGISClumpBoundaryEdge)), this->stripMemoryMB);
+        unsigned int tileRows = std::max((stripRows + nTileThreads - 1) / nTileThreads, 1u);
+        size_t nStrips = (height + stripRows - 1) / stripRows;
+        
+        rsgis::RSGISStripIOPipeline ioPipeline(this->numIOBuffers);
+        unsigned int nBufs = ioPipeline.getNumBuffers();
+        // The strips are read with the row above and below so the tiles can be traced independently.
+        std::vector<std::vector<uint64_t> > clumpIDs(nBufs, std::vector<uint64_t>(((size_t)width) * (stripRows + 2)));
+        std::vector<std::vector<RSGISPolygoniseClumpsTile> > tiles(nBufs);
+        
+        // The edges of the clumps crossing the seams of the tiles processed so far.
+        std::unordered_map<uint64_t, std::vector<RSGISClumpBoundaryEdge> > openClumps;
+        std::vector<RSGISClumpPolygon> seamPolys;
+        
+        rsgis::utils::RSGISOGRFeatureSink featSink(outLayer);
+        rsgis_tqdm pbar;
+        ioPipeline.run(nStrips, [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            unsigned int bufRowStart = (rowStart > 0)?(rowStart - 1):0;
+            unsigned int bufRowEnd = std::min(rowStart + nRows + 1, height);
+            clumpBand->RasterIO(GF_Read, 0, bufRowStart, width, bufRowEnd - bufRowStart, clumpIDs[buf].data(), width, bufRowEnd - bufRowStart, GDT_UInt64, 0, 0);
+        },
+        [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            unsigned int bufRowStart = (rowStart > 0)?(rowStart - 1):0;
+            size_t nTiles = (nRows + tileRows - 1) / tileRows;
+            tiles[buf].clear();
+            tiles[buf].resize(nTiles);
+            const uint64_t *pxls = clumpIDs[buf].data();
+            threadPool.parallelFor(0, nTiles, [&](unsigned int threadIdx, size_t tStart, size_t tEnd)
+            {
+                for(size_t t = tStart; t < tEnd; ++t)
+                {
+                    unsigned int tileRowStart = rowStart + (t * tileRows);
+                    unsigned int tileRowEnd = std::min(tileRowStart + tileRows, rowStart + nRows);
+                    this->polygoniseTile(pxls, width, height, bufRowStart, tileRowStart, tileRowEnd, use8Conn, &tiles[buf][t]);
+                }
+            });
+        },
+        [&](size_t strip, unsigned int buf)
+        {
+            pbar.progress(strip * stripRows, height);
+            for(std::vector<RSGISPolygoniseClumpsTile>::iterator iterTile = tiles[buf].begin(); iterTile != tiles[buf].end(); ++iterTile)
+            {
+                for(std::vector<RSGISClumpPolygon>::iterator iterPoly = iterTile->polys.begin(); iterPoly != iterTile->polys.end(); ++iterPoly)
+                {
+                    writePolygon(*iterPoly, transform, fieldIdx, &featSink);
+                }
+                
+                // Merge the edges of the clumps on the seams, tracing those which do not continue into the next tile.
+                for(size_t i = 0; i < iterTile->seamClumpIDs.size(); ++i)
+                {
+                    std::vector<RSGISClumpBoundaryEdge> &clumpEdges = openClumps[iterTile->seamClumpIDs[i]];
+                    clumpEdges.insert(clumpEdges.end(), iterTile->seamEdges[i].begin(), iterTile->seamEdges[i].end());
+                }
+                for(size_t i = 0; i < iterTile->seamClumpIDs.size(); ++i)
+                {
+                    if(!iterTile->seamContinuesBelow[i])
+                    {
+                        std::unordered_map<uint64_t, std::vector<RSGISClumpBoundaryEdge> >::iterator iterClump = openClumps.find(iterTile->seamClumpIDs[i]);
+                        seamPolys.clear();
+                        buildClumpPolygons(iterClump->first, &iterClump->second, use8Conn, &seamPolys);
+                        openClumps.erase(iterClump);
+                        for(std::vector<RSGISClumpPolygon>::iterator iterPoly = seamPolys.begin(); iterPoly != seamPolys.end(); ++iterPoly)
+                        {
+                            writePolygon(*iterPoly, transform, fieldIdx, &featSink);
+                        }
+                    }
+                }
+            }
+            tiles[buf].clear();
+        });
+        featSink.close();
+        pbar.finish();
+        
+        if(!openClumps.empty())
+        {
+            throw rsgis::img::RSGISImageCalcException("The boundaries of clumps crossing the tile seams were not closed.");
+        }
+    }
+    
+    void RSGISPolygoniseClumps::polygoniseTile(const uint64_t *pxls, unsigned int width, unsigned int height, unsigned int bufRowStart, unsigned int rowStart, unsigned int rowEnd, bool use8Conn, RSGISPolygoniseClumpsTile *tile)
+    {
+        std::unordered_map<uint64_t, size_t> clumpIdxs;
+        std::vector<uint64_t> ids;
+        std::vector<std::vector<RSGISClumpBoundaryEdge> > edges;
+        std::vector<bool> continuesAbove;
+        std::vector<bool> continuesBelow;
+        
+        uint64_t lastVal = 0;
+        size_t lastIdx = 0;
+        for(unsigned int y = rowStart; y < rowEnd; ++y)
+        {
+            const uint64_t *row = pxls + (((size_t)(y - bufRowStart)) * width);
+            const uint64_t *rowAbove = (y > 0)?(row - width):NULL;
+            const uint64_t *rowBelow = ((y + 1) < height)?(row + width):NULL;
+            for(unsigned int x = 0; x < width; ++x)
+            {
+                uint64_t val = row[x];
+                if(val == 0)
+                {
+                    continue;
+                }
+                if((val != lastVal) || (ids.empty()))
+                {
+                    std::unordered_map<uint64_t, size_t>::iterator iterIdx = clumpIdxs.find(val);
+                    if(iterIdx == clumpIdxs.end())
+                    {
+                        lastIdx = ids.size();
+                        clumpIdxs[val] = lastIdx;
+                        ids.push_back(val);
+                        edges.push_back(std::vector<RSGISClumpBoundaryEdge>());
+                        continuesAbove.push_back(false);
+                        continuesBelow.push_back(false);
+                    }
+                    else
+                    {
+                        lastIdx = iterIdx->second;
+                    }
+                    lastVal = val;
+                }
+                
+                uint64_t upVal = (rowAbove != NULL)?rowAbove[x]:0;
+                uint64_t downVal = (rowBelow != NULL)?rowBelow[x]:0;
+                uint64_t leftVal = (x > 0)?row[x-1]:0;
+                uint64_t rightVal = ((x + 1) < width)?row[x+1]:0;
+                std::vector<RSGISClumpBoundaryEdge> &clumpEdges = edges[lastIdx];
+                if(upVal != val)
+                {
+                    clumpEdges.push_back(RSGISClumpBoundaryEdge{x+1, y, x, y});
+                }
+                if(leftVal != val)
+                {
+                    clumpEdges.push_back(RSGISClumpBoundaryEdge{x, y, x, y+1});
+                }
+                if(downVal != val)
+                {
+                    clumpEdges.push_back(RSGISClumpBoundaryEdge{x, y+1, x+1, y+1});
+                }
+                if(rightVal != val)
+                {
+                    clumpEdges.push_back(RSGISClumpBoundaryEdge{x+1, y+1, x+1, y});
+                }
+                
+                // Is the clump connected to the pixels in the tiles above or below?
+                if((y == rowStart) && (rowAbove != NULL))
+                {
+                    if((upVal == val) || (use8Conn && (((x > 0) && (rowAbove[x-1] == val)) || (((x + 1) < width) && (rowAbove[x+1] == val)))))
+                    {
+                        continuesAbove[lastIdx] = true;
+                    }
+                }
+                if(((y + 1) == rowEnd) && (rowBelow != NULL))
+                {
+                    if((downVal == val) || (use8Conn && (((x > 0) && (rowBelow[x-1] == val)) || (((x + 1) < width) && (rowBelow[x+1] == val)))))
+                    {
+                        continuesBelow[lastIdx] = true;
+                    }
+                }
+            }
+        }
+        
+        for(size_t i = 0; i < ids.size(); ++i)
+        {
+            if(continuesAbove[i] || continuesBelow[i])
+            {
+                tile->seamClumpIDs.push_back(ids[i]);
+                tile->seamEdges.push_back(std::vector<RSGISClumpBoundaryEdge>());
+                tile->seamEdges.back().swap(edges[i]);
+                tile->seamContinuesBelow.push_back(continuesBelow[i]);
+            }
+            else
+            {
+                buildClumpPolygons(ids[i], &edges[i], use8Conn, &tile->polys);
+                std::vector<RSGISClumpBoundaryEdge>().swap(edges[i]);
+            }
+        }
+    }
+    
+    void RSGISPolygoniseClumps::buildClumpPolygons(uint64_t clumpID, std::vector<RSGISClumpBoundaryEdge> *edges, bool use8Conn, std::vector<RSGISClumpPolygon> *polys)
+    {
+        size_t nEdges = edges->size();
+        if(nEdges == 0)
+        {
+            return;
+        }
+        
+        std::sort(edges->begin(), edges->end(), [](const RSGISClumpBoundaryEdge &a, const RSGISClumpBoundaryEdge &b)
+        {
+            return (a.x1 < b.x1) || ((a.x1 == b.x1) && (a.y1 < b.y1));
+        });
+        
+        // Find the edge following each edge. Where two pixels of the clump only touch at
+        // a corner there are two edges from the vertex; turning back around the pixel
+        // being followed keeps the pixels apart (4 connectivity) while continuing onto
+        // the other pixel joins them (8 connectivity).
+        std::vector<size_t> nextEdge(nEdges);
+        for(size_t i = 0; i < nEdges; ++i)
+        {
+            const RSGISClumpBoundaryEdge &edge = (*edges)[i];
+            RSGISClumpBoundaryEdge endVtx = RSGISClumpBoundaryEdge{edge.x2, edge.y2, 0, 0};
+            std::vector<RSGISClumpBoundaryEdge>::iterator iterNext = std::lower_bound(edges->begin(), edges->end(), endVtx, [](const RSGISClumpBoundaryEdge &a, const RSGISClumpBoundaryEdge &b)
+            {
+                return (a.x1 < b.x1) || ((a.x1 == b.x1) && (a.y1 < b.y1));
+            });
+            if((iterNext == edges->end()) || (iterNext->x1 != edge.x2) || (iterNext->y1 != edge.y2))
+            {
+                throw rsgis::img::RSGISImageCalcException("The boundary of a clump is not closed.");
+            }
+            nextEdge[i] = iterNext - edges->begin();
+            std::vector<RSGISClumpBoundaryEdge>::iterator iterAlt = iterNext + 1;
+            if((iterAlt != edges->end()) && (iterAlt->x1 == edge.x2) && (iterAlt->y1 == edge.y2))
+            {
+                long inDX = ((long)edge.x2) - ((long)edge.x1);
+                long inDY = ((long)edge.y2) - ((long)edge.y1);
+                long outDX = ((long)iterNext->x2) - ((long)iterNext->x1);
+                long outDY = ((long)iterNext->y2) - ((long)iterNext->y1);
+                bool nextTurnsBack = ((inDX * outDY) - (inDY * outDX)) < 0;
+                if(nextTurnsBack == use8Conn)
+                {
+                    nextEdge[i] = iterAlt - edges->begin();
+                }
+            }
+        }
+        
+        // Trace the rings, only keeping the vertices where the boundary changes direction.
+        std::vector<std::vector<std::pair<uint32_t, uint32_t> > > outerRings;
+        std::vector<double> outerAreas;
+        std::vector<std::vector<std::pair<uint32_t, uint32_t> > > holeRings;
+        std::vector<std::pair<double, double> > holePts;
+        std::vector<bool> used(nEdges, false);
+        for(size_t i = 0; i < nEdges; ++i)
+        {
+            if(used[i])
+            {
+                continue;
+            }
+            std::vector<std::pair<uint32_t, uint32_t> > ring;
+            double area2 = 0;
+            size_t e = i;
+            do
+            {
+                used[e] = true;
+                const RSGISClumpBoundaryEdge &edge = (*edges)[e];
+                const RSGISClumpBoundaryEdge &next = (*edges)[nextEdge[e]];
+                area2 += (((double)edge.x1) * ((double)edge.y2)) - (((double)edge.x2) * ((double)edge.y1));
+                if(((edge.x2 - edge.x1) != (next.x2 - next.x1)) || ((edge.y2 - edge.y1) != (next.y2 - next.y1)))
+                {
+                    ring.push_back(std::pair<uint32_t, uint32_t>(edge.x2, edge.y2));
+                }
+                e = nextEdge[e];
+            }
+            while(e != i);
+            
+            // The outer rings are anti-clockwise in pixel coordinates (a negative area), the holes clockwise.
+            if(area2 < 0)
+            {
+                outerRings.push_back(std::vector<std::pair<uint32_t, uint32_t> >());
+                outerRings.back().swap(ring);
+                outerAreas.push_back(-area2);
+            }
+            else
+            {
+                // The centre of the clump pixel on the first edge of the hole.
+                const RSGISClumpBoundaryEdge &edge = (*edges)[i];
+                double pxlX = std::min(edge.x1, edge.x2);
+                double pxlY = std::min(edge.y1, edge.y2);
+                if(edge.y2 < edge.y1)
+                {
+                    pxlX -= 1;
+                }
+                else if(edge.x2 > edge.x1)
+                {
+                    pxlY -= 1;
+                }
+                holeRings.push_back(std::vector<std::pair<uint32_t, uint32_t> >());
+                holeRings.back().swap(ring);
+                holePts.push_back(std::pair<double, double>(pxlX + 0.5, pxlY + 0.5));
+            }
+        }
+        
+        size_t firstPoly = polys->size();
+        for(size_t i = 0; i < outerRings.size(); ++i)
+        {
+            polys->push_back(RSGISClumpPolygon());
+            polys->back().clumpID = clumpID;
+            polys->back().rings.push_back(std::vector<std::pair<uint32_t, uint32_t> >());
+            polys->back().rings.back().swap(outerRings[i]);
+        }
+        
+        // Add each hole to the smallest outer ring containing the clump pixel on the hole.
+        for(size_t i = 0; i < holeRings.size(); ++i)
+        {
+            size_t outerIdx = 0;
+            if(outerAreas.size() > 1)
+            {
+                bool found = false;
+                for(size_t j = 0; j < outerAreas.size(); ++j)
+                {
+                    if(((!found) || (outerAreas[j] < outerAreas[outerIdx])) && pointInRing(holePts[i].first, holePts[i].second, (*polys)[firstPoly+j].rings[0]))
+                    {
+                        outerIdx = j;
+                        found = true;
+                    }
+                }
+                if(!found)
+                {
+                    throw rsgis::img::RSGISImageCalcException("A hole within a clump is not within an outer boundary of the clump.");
+                }
+            }
+            else if(outerAreas.empty())
+            {
+                throw rsgis::img::RSGISImageCalcException("A clump does not have an outer boundary.");
+            }
+            (*polys)[firstPoly+outerIdx].rings.push_back(std::vector<std::pair<uint32_t, uint32_t> >());
+            (*polys)[firstPoly+outerIdx].rings.back().swap(holeRings[i]);
+        }
+    }
+    
+    bool RSGISPolygoniseClumps::pointInRing(double x, double y, const std::vector<std::pair<uint32_t, uint32_t> > &ring)
+    {
+        bool inside = false;
+        size_t nPts = ring.size();
+        for(size_t i = 0, j = nPts - 1; i < nPts; j = i++)
+        {
+            double xi = ring[i].first;
+            double yi = ring[i].second;
+            double xj = ring[j].first;
+            double yj = ring[j].second;
+            if(((yi > y) != (yj > y)) && (x < (((xj - xi) * (y - yi)) / (yj - yi)) + xi))
+            {
+                inside = !inside;
+            }
+        }
+        return inside;
+    }
+    
+    void RSGISPolygoniseClumps::writePolygon(const RSGISClumpPolygon &poly, const double *transform, int fieldIdx, rsgis::utils::RSGISOGRFeatureSink *featSink)
+    {
+        OGRPolygon *ogrPoly = new OGRPolygon();
+        for(std::vector<std::vector<std::pair<uint32_t, uint32_t> > >::const_iterator iterRing = poly.rings.begin(); iterRing != poly.rings.end(); ++iterRing)
+        {
+            int nPts = iterRing->size();
+            OGRLinearRing ogrRing;
+            ogrRing.setNumPoints(nPts + 1);
+            for(int i = 0; i <= nPts; ++i)
+            {
+                double pxlX = (*iterRing)[i % nPts].first;
+                double pxlY = (*iterRing)[i % nPts].second;
+                ogrRing.setPoint(i, transform[0] + (pxlX * transform[1]) + (pxlY * transform[2]), transform[3] + (pxlX * transform[4]) + (pxlY * transform[5]));
+            }
+            ogrPoly->addRing(&ogrRing);
+        }
+        OGRFeature *feature = featSink->getFeature();
+        feature->SetField(fieldIdx, (GIntBig)poly.clumpID);
+        feature->SetGeometryDirectly(ogrPoly);
+        featSink->writeFeature(feature);
+    }
+    
+    RSGISPolygoniseClumps::~RSGISPolygoniseClumps()
+    {
+        
+    }
+    
+}}
@@ -0,0 +1,132 @@
+/*
+ *  RSGISPolygoniseClumps.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISPolygoniseClumps_h
+#define RSGISPolygoniseClumps_h
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <stdint.h>
+
+#include "gdal_priv.h"
+#include "ogrsf_frmts.h"
+
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISStripIOPipeline.h"
+#include "common/RSGISVectorException.h"
+#include "common/rsgis-tqdm.h"
+
+#include "img/RSGISImageCalcException.h"
+#include "utils/RSGISOGRFeatureSink.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_segmentation_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace segment{
+    
+    /**
+     * A unit edge between a clump pixel and a pixel with another value (or outside
+     * the image), in pixel corner coordinates. The edges are directed so that
+     * following them traces the boundary of the clump around each pixel as
+     * (x,y) -> (x,y+1) -> (x+1,y+1) -> (x+1,y) -> (x,y).
+     */
+    struct DllExport RSGISClumpBoundaryEdge
+    {
+        uint32_t x1;
+        uint32_t y1;
+        uint32_t x2;
+        uint32_t y2;
+    };
+    
+    /** A polygon of a clump as rings of pixel corner coordinates (x,y), the outer ring followed by the holes. */
+    struct DllExport RSGISClumpPolygon
+    {
+        uint64_t clumpID;
+        std::vector<std::vector<std::pair<uint32_t, uint32_t> > > rings;
+    };
+    
+    /**
+     * The polygons for the clumps within a tile which do not continue into the
+     * neighbouring tiles and the boundary edges (in first seen order) for those
+     * clumps which cross the tile seams.
+     */
+    struct DllExport RSGISPolygoniseClumpsTile
+    {
+        std::vector<RSGISClumpPolygon> polys;
+        std::vector<uint64_t> seamClumpIDs;
+        std::vector<std::vector<RSGISClumpBoundaryEdge> > seamEdges;
+        std::vector<bool> seamContinuesBelow;
+    };
+    
+    /**
+     * Polygonise a clumps image (clump 0 is no data) to a vector layer with a
+     * feature for each connected region of a clump. The image is split into tiles
+     * of rows which are polygonised concurrently by tracing the pixel edges on the
+     * boundary of each clump. Clumps which cross a tile seam have their edges held
+     * (by clump ID) until the last tile they reach has been processed, when the
+     * edges from all the tiles are traced as a whole, so the output polygons are
+     * the same whatever the tiling. Features are written through a
+     * RSGISOGRFeatureSink in tile order, using the threads, strip memory and I/O
+     * buffers of the default execution context.
+     */
+    class DllExport RSGISPolygoniseClumps
+    {
+    public:
+        RSGISPolygoniseClumps();
+        /**
+         * Polygonise the clumps band, writing the clump ID of each polygon to the field
+         * outField (created as a 64 bit integer field if not already within the layer).
+         * With use8Conn the pixels of a clump which only touch at a corner are part of the
+         * same polygon, otherwise (as with GDALPolygonize) they form separate polygons.
+         */
+        void polygoniseClumps(GDALDataset *clumps, unsigned int band, OGRLayer *outLayer, std::string outField, bool use8Conn=false);
+        ~RSGISPolygoniseClumps();
+    protected:
+        /** Trace the clumps within the rows [rowStart, rowEnd) of the image, where pxls holds the rows from bufRowStart (including the row above and below the tile where within the image). */
+        void polygoniseTile(const uint64_t *pxls, unsigned int width, unsigned int height, unsigned int bufRowStart, unsigned int rowStart, unsigned int rowEnd, bool use8Conn, RSGISPolygoniseClumpsTile *tile);
+        /** Trace the boundary edges of a clump into a polygon for each outer ring (the edges are sorted). */
+        static void buildClumpPolygons(uint64_t clumpID, std::vector<RSGISClumpBoundaryEdge> *edges, bool use8Conn, std::vector<RSGISClumpPolygon> *polys);
+        static bool pointInRing(double x, double y, const std::vector<std::pair<uint32_t, uint32_t> > &ring);
+        static void writePolygon(const RSGISClumpPolygon &poly, const double *transform, int fieldIdx, rsgis::utils::RSGISOGRFeatureSink *featSink);
+        unsigned int numThreads;
+        unsigned int numIOBuffers;
+        unsigned int stripMemoryMB;
+    };
+    
+}}
+
+#endif
@@ -26,7 +26,10 @@ namespace rsgis{namespace segment{
     
     RSGISRandomColourClumps::RSGISRandomColourClumps()
     {
-        
+        rsgis::RSGISExecutionContext context = rsgis::RSGISExecutionContextUtils::getDefaultContext();
+        this->numThreads = context.numThreads;
+        this->numIOBuffers = context.numIOBuffers;
+        this->stripMemoryMB = context.stripMemoryMB;
     }
         
     void RSGISRandomColourClumps::generateRandomColouredClump(GDALDataset *clumps, GDALDataset *colourImg, std::string inputLUTFile, bool importLUT, std::string exportLUTFile, bool exportLUT) 
@@ -44,117 +47,159 @@ namespace rsgis{namespace segment{
             throw rsgis::img::RSGISImageCalcException("Colour image needs to have 3 image bands.");
         }
         
-        rsgis::img::RSGISImageUtils imgUtils;
-        imgUtils.zerosUIntGDALDataset(colourImg);
-        
         unsigned int width = clumps->GetRasterXSize();
         unsigned int height = clumps->GetRasterYSize();
-        
-        unsigned int *clumpIdxs = new unsigned int[width];
-        int *clrRVals = new int[width];
-        int *clrGVals = new int[width];
-        int *clrBVals = new int[width];
 
         GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
         GDALRasterBand *rClrBand = colourImg->GetRasterBand(1);
         GDALRasterBand *gClrBand = colourImg->GetRasterBand(2);
         GDALRasterBand *bClrBand = colourImg->GetRasterBand(3);
         
-        unsigned long maxClumpIdx = 0;
-        for(unsigned int i = 0; i < height; ++i)
-        {
-            clumpBand->RasterIO(GF_Read, 0, i, width, 1, clumpIdxs, width, 1, GDT_UInt32, 0, 0);
-            for(unsigned int j = 0; j < width; ++j)
-            {
-                if((i == 0) & (j == 0))
-                {
-                    maxClumpIdx = clumpIdxs[j];
-                }
-                else if(clumpIdxs[j] > maxClumpIdx)
-                {
-                    maxClumpIdx = clumpIdxs[j];
-                }
-            }
-        }
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        clumpBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), width, height, sizeof(unsigned int)*4, this->stripMemoryMB);
+        size_t stripPxls = ((size_t)width) * stripRows;
         
-        ImgClumpRGB *cClump;
-        std::vector<ImgClumpRGB*> *clumpTab = NULL;
+        // Dense colour LUT indexed by clump ID, where clump 0 is coloured 0.
+        std::vector<int> red;
+        std::vector<int> green;
+        std::vector<int> blue;
         if(importLUT)
         {
             std::cout << "Importing Colours LUT\n";
-            clumpTab = this->importLUTFromFile(inputLUTFile);
+            this->importLUTFromFile(inputLUTFile, &red, &green, &blue);
         }
         else
         {
-            clumpTab = new std::vector<ImgClumpRGB*>();
-            clumpTab->reserve(maxClumpIdx);
+            unsigned int maxClumpIdx = this->findMaxClumpID(clumpBand, stripRows);
+            red.assign(((size_t)maxClumpIdx)+1, 0);
+            green.assign(((size_t)maxClumpIdx)+1, 0);
+            blue.assign(((size_t)maxClumpIdx)+1, 0);
             srand ( time(NULL) );
-            for(unsigned int i = 0; i < maxClumpIdx; ++i)
+            for(size_t i = 1; i <= maxClumpIdx; ++i)
             {
-                cClump = new ImgClumpRGB(i+1);
-                cClump->red = rand() % 255 + 1;
-                cClump->green = rand() % 255 + 1;
-                cClump->blue = rand() % 255 + 1;
-                clumpTab->push_back(cClump);
+                red[i] = rand() % 255 + 1;
+                green[i] = rand() % 255 + 1;
+                blue[i] = rand() % 255 + 1;
             }
         }
+        size_t lutSize = red.size();
         
-        for(unsigned int i = 0; i < height; ++i)
+        if((width > 0) && (height > 0))
         {
-            clumpBand->RasterIO(GF_Read, 0, i, width, 1, clumpIdxs, width, 1, GDT_UInt32, 0, 0);
+            size_t nStrips = (height + stripRows - 1) / stripRows;
+            rsgis::RSGISThreadPool threadPool(this->numThreads);
+            rsgis::RSGISStripIOPipeline ioPipeline(this->numIOBuffers);
+            unsigned int nBufs = ioPipeline.getNumBuffers();
+            std::vector<std::vector<unsigned int> > clumpIdxs(nBufs, std::vector<unsigned int>(stripPxls));
+            std::vector<std::vector<int> > clrRVals(nBufs, std::vector<int>(stripPxls));
+            std::vector<std::vector<int> > clrGVals(nBufs, std::vector<int>(stripPxls));
+            std::vector<std::vector<int> > clrBVals(nBufs, std::vector<int>(stripPxls));
             
-            for(unsigned int j = 0; j < width; ++j)
+            rsgis_tqdm pbar;
+            ioPipeline.run(nStrips, [&](size_t strip, unsigned int buf)
             {
-                if(clumpIdxs[j] != 0)
-                {
-                    cClump = clumpTab->at(clumpIdxs[j] - 1);
-                    
-                    clrRVals[j] = cClump->red;
-                    clrGVals[j] = cClump->green;
-                    clrBVals[j] = cClump->blue;
-                }
-                else
+                unsigned int rowStart = strip * stripRows;
+                unsigned int nRows = std::min(stripRows, height - rowStart);
+                clumpBand->RasterIO(GF_Read, 0, rowStart, width, nRows, clumpIdxs[buf].data(), width, nRows, GDT_UInt32, 0, 0);
+            },
+            [&](size_t strip, unsigned int buf)
+            {
+                unsigned int rowStart = strip * stripRows;
+                unsigned int nRows = std::min(stripRows, height - rowStart);
+                pbar.progress(rowStart, height);
+                const unsigned int *ids = clumpIdxs[buf].data();
+                int *rVals = clrRVals[buf].data();
+                int *gVals = clrGVals[buf].data();
+                int *bVals = clrBVals[buf].data();
+                threadPool.parallelFor(0, ((size_t)width) * nRows, [&](unsigned int threadIdx, size_t pStart, size_t pEnd)
                 {
-                    clrRVals[j] = 0;
-                    clrGVals[j] = 0;
-                    clrBVals[j] = 0;
-                }
-            }
-            
-            rClrBand->RasterIO(GF_Write, 0, i, width, 1, clrRVals, width, 1, GDT_UInt32, 0, 0);
-            gClrBand->RasterIO(GF_Write, 0, i, width, 1, clrGVals, width, 1, GDT_UInt32, 0, 0);
-            bClrBand->RasterIO(GF_Write, 0, i, width, 1, clrBVals, width, 1, GDT_UInt32, 0, 0);
+                    for(size_t i = pStart; i < pEnd; ++i)
+                    {
+                        unsigned int id = ids[i];
+                        if(id >= lutSize)
+                        {
+                            throw rsgis::img::RSGISImageCalcException("A clump ID is not within the colour LUT.");
+                        }
+                        rVals[i] = red[id];
+                        gVals[i] = green[id];
+                        bVals[i] = blue[id];
+                    }
+                });
+            },
+            [&](size_t strip, unsigned int buf)
+            {
+                unsigned int rowStart = strip * stripRows;
+                unsigned int nRows = std::min(stripRows, height - rowStart);
+                rClrBand->RasterIO(GF_Write, 0, rowStart, width, nRows, clrRVals[buf].data(), width, nRows, GDT_Int32, 0, 0);
+                gClrBand->RasterIO(GF_Write, 0, rowStart, width, nRows, clrGVals[buf].data(), width, nRows, GDT_Int32, 0, 0);
+                bClrBand->RasterIO(GF_Write, 0, rowStart, width, nRows, clrBVals[buf].data(), width, nRows, GDT_Int32, 0, 0);
+            });
+            pbar.finish();
         }
         
         if(exportLUT)
         {
-            this->exportLUT2File(exportLUTFile, clumpTab);
+            this->exportLUT2File(exportLUTFile, red, green, blue);
+        }
+    }
+    
+    unsigned int RSGISRandomColourClumps::findMaxClumpID(GDALRasterBand *clumpBand, unsigned int stripRows)
+    {
+        unsigned int width = clumpBand->GetXSize();
+        unsigned int height = clumpBand->GetYSize();
+        if((width == 0) || (height == 0))
+        {
+            return 0;
         }
         
-        delete[] clumpIdxs;
-        delete[] clrRVals;
-        delete[] clrGVals;
-        delete[] clrBVals;
+        size_t nStrips = (height + stripRows - 1) / stripRows;
+        rsgis::RSGISThreadPool threadPool(this->numThreads);
+        std::vector<unsigned int> threadMax(threadPool.getNumThreads(), 0);
+        rsgis::RSGISStripIOPipeline ioPipeline(this->numIOBuffers);
+        std::vector<std::vector<unsigned int> > clumpIdxs(ioPipeline.getNumBuffers(), std::vector<unsigned int>(((size_t)width) * stripRows));
         
-        for(std::vector<ImgClumpRGB*>::iterator iterClumps = clumpTab->begin(); iterClumps != clumpTab->end(); ++iterClumps)
+        ioPipeline.run(nStrips, [&](size_t strip, unsigned int buf)
         {
-            delete *iterClumps;
-        }
-        delete clumpTab;
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            clumpBand->RasterIO(GF_Read, 0, rowStart, width, nRows, clumpIdxs[buf].data(), width, nRows, GDT_UInt32, 0, 0);
+        },
+        [&](size_t strip, unsigned int buf)
+        {
+            unsigned int rowStart = strip * stripRows;
+            unsigned int nRows = std::min(stripRows, height - rowStart);
+            const unsigned int *ids = clumpIdxs[buf].data();
+            threadPool.parallelFor(0, ((size_t)width) * nRows, [&](unsigned int threadIdx, size_t pStart, size_t pEnd)
+            {
+                unsigned int maxID = threadMax[threadIdx];
+                for(size_t i = pStart; i < pEnd; ++i)
+                {
+                    maxID = std::max(maxID, ids[i]);
+                }
+                threadMax[threadIdx] = maxID;
+            });
+        },
+        [&](size_t strip, unsigned int buf){});
+        
+        return *std::max_element(threadMax.begin(), threadMax.end());
     }
     
-    std::vector<ImgClumpRGB*>* RSGISRandomColourClumps::importLUTFromFile(std::string inFile)
+    void RSGISRandomColourClumps::importLUTFromFile(std::string inFile, std::vector<int> *red, std::vector<int> *green, std::vector<int> *blue)
     {
-        std::vector<ImgClumpRGB*> *clumpTab = new std::vector<ImgClumpRGB*>();
         try 
         {
             rsgis::utils::RSGISTextUtils txtUtils;
             size_t numLines = txtUtils.countLines(inFile);
-            clumpTab->reserve(numLines);
+            red->assign(1, 0);
+            green->assign(1, 0);
+            blue->assign(1, 0);
+            red->reserve(numLines+1);
+            green->reserve(numLines+1);
+            blue->reserve(numLines+1);
             std::vector<std::string> *tokens = new std::vector<std::string>();
             std::string line = "";
-            size_t count = 1;
-            ImgClumpRGB *cRGB = NULL;
             rsgis::utils::RSGISTextFileLineReader reader;
             reader.openFile(inFile);
             while(!reader.endOfFile())
@@ -166,13 +211,12 @@ namespace rsgis{namespace segment{
                     if(tokens->size() != 3)
                     {
                         std::cout << "Line: " << line << std::endl;
+                        delete tokens;
                         throw rsgis::utils::RSGISTextException("Line must has 3 tokens");
                     }
-                    cRGB = new ImgClumpRGB(count++);
-                    cRGB->red = txtUtils.strto32bitInt(tokens->at(0));
-                    cRGB->green = txtUtils.strto32bitInt(tokens->at(1));
-                    cRGB->blue = txtUtils.strto32bitInt(tokens->at(2));
-                    clumpTab->push_back(cRGB);
+                    red->push_back(txtUtils.strto32bitInt(tokens->at(0)));
+                    green->push_back(txtUtils.strto32bitInt(tokens->at(1)));
+                    blue->push_back(txtUtils.strto32bitInt(tokens->at(2)));
                     tokens->clear();
                 }
             }
@@ -183,10 +227,9 @@ namespace rsgis{namespace segment{
         {
             throw e;
         }
-        return clumpTab;
     }
     
-    void RSGISRandomColourClumps::exportLUT2File(std::string outFile, std::vector<ImgClumpRGB*> *clumpTab)
+    void RSGISRandomColourClumps::exportLUT2File(std::string outFile, const std::vector<int> &red, const std::vector<int> &green, const std::vector<int> &blue)
     {
         try 
         {
@@ -195,9 +238,9 @@ namespace rsgis{namespace segment{
             
             if(outTxtFile.is_open())
             {
-                for(std::vector<ImgClumpRGB*>::iterator iterClumps = clumpTab->begin(); iterClumps != clumpTab->end(); ++iterClumps)
+                for(size_t i = 1; i < red.size(); ++i)
                 {
-                    outTxtFile << (*iterClumps)->red << "," << (*iterClumps)->green << "," << (*iterClumps)->blue << std::endl;
+                    outTxtFile << red[i] << "," << green[i] << "," << blue[i] << std::endl;
                 }
                 outTxtFile.flush();
                 outTxtFile.close();
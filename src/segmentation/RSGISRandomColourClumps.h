@@ -30,9 +30,15 @@
 #include <cmath>
 #include <stdlib.h>
 #include <time.h>
+#include <algorithm>
 
 #include "gdal_priv.h"
 
+#include "common/RSGISExecutionContext.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISStripIOPipeline.h"
+#include "common/rsgis-tqdm.h"
+
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISImageCalcException.h"
 #include "utils/RSGISTextUtils.h"
@@ -66,6 +72,13 @@ namespace rsgis{namespace segment{
     };
     
     
+    /**
+     * Colour a clumps image with a random (or imported) colour per clump. The colours
+     * are held as dense red, green and blue arrays indexed by clump ID (index 0 is
+     * no data, coloured 0) and each strip of the image is coloured by a gather from
+     * those arrays in parallel, using the threads, strip memory and I/O buffers of
+     * the default execution context.
+     */
     class DllExport RSGISRandomColourClumps
     {
     public:
@@ -73,8 +86,13 @@ namespace rsgis{namespace segment{
         void generateRandomColouredClump(GDALDataset *clumps, GDALDataset *colourImg, std::string inputLUTFile, bool importLUT, std::string exportLUTFile, bool exportLUT);
         ~RSGISRandomColourClumps();
     protected:
-        std::vector<ImgClumpRGB*>* importLUTFromFile(std::string inFile);
-        void exportLUT2File(std::string outFile, std::vector<ImgClumpRGB*> *clumpTab);
+        unsigned int findMaxClumpID(GDALRasterBand *clumpBand, unsigned int stripRows);
+        /** Read the colour of each clump (from 1) from a file with a 'r,g,b' line per clump. */
+        void importLUTFromFile(std::string inFile, std::vector<int> *red, std::vector<int> *green, std::vector<int> *blue);
+        void exportLUT2File(std::string outFile, const std::vector<int> &red, const std::vector<int> &green, const std::vector<int> &blue);
+        unsigned int numThreads;
+        unsigned int numIOBuffers;
+        unsigned int stripMemoryMB;
     };
     
 }}
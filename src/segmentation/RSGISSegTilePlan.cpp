@@ -0,0 +1,224 @@
+/*
+ *  RSGISSegTilePlan.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISSegTilePlan.h"
+
+namespace rsgis{namespace segment{
+
+    RSGISSegTilePlanInfo RSGISSegTilePlan::createPlan(unsigned int width, unsigned int height, unsigned int tileXSize, unsigned int tileYSize, unsigned int overlap, std::string tilesBase, std::string outFileExt)
+    {
+        if((width == 0) || (height == 0))
+        {
+            throw rsgis::RSGISException("The image must have at least one pixel.");
+        }
+        if((tileXSize == 0) || (tileYSize == 0))
+        {
+            throw rsgis::RSGISException("The tile size must be greater than zero.");
+        }
+
+        RSGISSegTilePlanInfo plan;
+        plan.tilesBase = tilesBase;
+        plan.outFileExt = outFileExt;
+        plan.width = width;
+        plan.height = height;
+        plan.tileXSize = tileXSize;
+        plan.tileYSize = tileYSize;
+        plan.overlap = overlap;
+
+        unsigned int numXTiles = (width + tileXSize - 1) / tileXSize;
+        unsigned int numYTiles = (height + tileYSize - 1) / tileYSize;
+        for(unsigned int tY = 0; tY < numYTiles; ++tY)
+        {
+            for(unsigned int tX = 0; tX < numXTiles; ++tX)
+            {
+                RSGISSegTileJob job;
+                job.id = (tY * numXTiles) + tX;
+                job.bodyXOff = tX * tileXSize;
+                job.bodyYOff = tY * tileYSize;
+                job.bodyXSize = std::min(tileXSize, width - job.bodyXOff);
+                job.bodyYSize = std::min(tileYSize, height - job.bodyYOff);
+
+                job.xOff = (job.bodyXOff > overlap)?(job.bodyXOff - overlap):0;
+                job.yOff = (job.bodyYOff > overlap)?(job.bodyYOff - overlap):0;
+                job.xSize = std::min(job.bodyXOff + job.bodyXSize + overlap, width) - job.xOff;
+                job.ySize = std::min(job.bodyYOff + job.bodyYSize + overlap, height) - job.yOff;
+
+                for(int nY = ((int)tY)-1; nY <= ((int)tY)+1; ++nY)
+                {
+                    for(int nX = ((int)tX)-1; nX <= ((int)tX)+1; ++nX)
+                    {
+                        if((nX < 0) || (nY < 0) || (nX >= (int)numXTiles) || (nY >= (int)numYTiles) || ((nX == (int)tX) && (nY == (int)tY)))
+                        {
+                            continue;
+                        }
+                        job.neighbours.push_back((nY * numXTiles) + nX);
+                    }
+                }
+
+                job.clumpsImage = RSGISSegTilePlan::getJobImage(plan, job.id, "clumps");
+                plan.jobs.push_back(job);
+            }
+        }
+        return plan;
+    }
+
+    void RSGISSegTilePlan::writeManifest(std::string manifestFile, const RSGISSegTilePlanInfo &plan)
+    {
+        std::ofstream outFile(manifestFile.c_str(), std::ios::out | std::ios::trunc);
+        if(!outFile.is_open())
+        {
+            throw rsgis::RSGISFileException("Could not open the manifest file: " + manifestFile);
+        }
+        // The paths are on their own lines so they can contain spaces.
+        outFile << "RSGISSegTilePlan 1\n";
+        outFile << "clusters " << plan.clustersImage << "\n";
+        outFile << "spectral " << plan.spectralImage << "\n";
+        outFile << "tilesbase " << plan.tilesBase << "\n";
+        outFile << "format " << plan.imageFormat << "\n";
+        outFile << "ext " << plan.outFileExt << "\n";
+        outFile << "image " << plan.width << " " << plan.height << "\n";
+        outFile << "tiles " << plan.tileXSize << " " << plan.tileYSize << " " << plan.overlap << "\n";
+        outFile << "jobs " << plan.jobs.size() << "\n";
+        for(std::vector<RSGISSegTileJob>::const_iterator iterJobs = plan.jobs.begin(); iterJobs != plan.jobs.end(); ++iterJobs)
+        {
+            outFile << "job " << (*iterJobs).id << " " << (*iterJobs).xOff << " " << (*iterJobs).yOff << " " << (*iterJobs).xSize << " " << (*iterJobs).ySize;
+            outFile << " " << (*iterJobs).bodyXOff << " " << (*iterJobs).bodyYOff << " " << (*iterJobs).bodyXSize << " " << (*iterJobs).bodyYSize;
+            outFile << " " << (*iterJobs).neighbours.size();
+            for(std::vector<unsigned int>::const_iterator iterNeigh = (*iterJobs).neighbours.begin(); iterNeigh != (*iterJobs).neighbours.end(); ++iterNeigh)
+            {
+                outFile << " " << (*iterNeigh);
+            }
+            outFile << "\n";
+            outFile << "clumps " << (*iterJobs).clumpsImage << "\n";
+        }
+        outFile.flush();
+        if(!outFile.good())
+        {
+            throw rsgis::RSGISFileException("Could not write the manifest file: " + manifestFile);
+        }
+        outFile.close();
+    }
+
+    /** Read a line "<key> <value>", returning the value (the rest of the line). */
+    static std::string readManifestValue(std::ifstream &inFile, std::string key)
+    {
+        std::string line;
+        if(!std::getline(inFile, line) || (line.compare(0, key.size()+1, key + " ") != 0))
+        {
+            throw rsgis::RSGISFileException("The manifest file is not valid; expected '" + key + "'.");
+        }
+        return line.substr(key.size()+1);
+    }
+
+    RSGISSegTilePlanInfo RSGISSegTilePlan::readManifest(std::string manifestFile)
+    {
+        std::ifstream inFile(manifestFile.c_str());
+        if(!inFile.is_open())
+        {
+            throw rsgis::RSGISFileException("Could not open the manifest file: " + manifestFile);
+        }
+        std::string header;
+        if(!std::getline(inFile, header) || (header != "RSGISSegTilePlan 1"))
+        {
+            throw rsgis::RSGISFileException("The file is not a segmentation tile plan: " + manifestFile);
+        }
+
+        RSGISSegTilePlanInfo plan;
+        plan.clustersImage = readManifestValue(inFile, "clusters");
+        plan.spectralImage = readManifestValue(inFile, "spectral");
+        plan.tilesBase = readManifestValue(inFile, "tilesbase");
+        plan.imageFormat = readManifestValue(inFile, "format");
+        plan.outFileExt = readManifestValue(inFile, "ext");
+
+        std::stringstream imageStr(readManifestValue(inFile, "image"));
+        std::stringstream tilesStr(readManifestValue(inFile, "tiles"));
+        std::stringstream jobsStr(readManifestValue(inFile, "jobs"));
+        size_t numJobs = 0;
+        if(!(imageStr >> plan.width >> plan.height) || !(tilesStr >> plan.tileXSize >> plan.tileYSize >> plan.overlap) || !(jobsStr >> numJobs))
+        {
+            throw rsgis::RSGISFileException("The manifest file is not valid: " + manifestFile);
+        }
+
+        for(size_t i = 0; i < numJobs; ++i)
+        {
+            RSGISSegTileJob job;
+            std::stringstream jobStr(readManifestValue(inFile, "job"));
+            size_t numNeighs = 0;
+            if(!(jobStr >> job.id >> job.xOff >> job.yOff >> job.xSize >> job.ySize >> job.bodyXOff >> job.bodyYOff >> job.bodyXSize >> job.bodyYSize >> numNeighs))
+            {
+                throw rsgis::RSGISFileException("The manifest file is not valid: " + manifestFile);
+            }
+            unsigned int neighID = 0;
+            for(size_t n = 0; n < numNeighs; ++n)
+            {
+                if(!(jobStr >> neighID))
+                {
+                    throw rsgis::RSGISFileException("The manifest file is not valid: " + manifestFile);
+                }
+                job.neighbours.push_back(neighID);
+            }
+            job.clumpsImage = readManifestValue(inFile, "clumps");
+            plan.jobs.push_back(job);
+        }
+        return plan;
+    }
+
+    const RSGISSegTileJob& RSGISSegTilePlan::getJob(const RSGISSegTilePlanInfo &plan, unsigned int jobID)
+    {
+        for(std::vector<RSGISSegTileJob>::const_iterator iterJobs = plan.jobs.begin(); iterJobs != plan.jobs.end(); ++iterJobs)
+        {
+            if((*iterJobs).id == jobID)
+            {
+                return (*iterJobs);
+            }
+        }
+        std::stringstream message;
+        message << "Job " << jobID << " is not within the plan.";
+        throw rsgis::RSGISException(message.str());
+    }
+
+    unsigned int RSGISSegTilePlan::getTilePxlPosition(const RSGISSegTilePlanInfo &plan, const RSGISSegTileJob &job, unsigned int x, unsigned int y)
+    {
+        unsigned int imgX = job.xOff + x;
+        unsigned int imgY = job.yOff + y;
+        if((imgX < job.bodyXOff) || (imgY < job.bodyYOff) || (imgX >= (job.bodyXOff + job.bodyXSize)) || (imgY >= (job.bodyYOff + job.bodyYSize)))
+        {
+            return RSGIS_SEGTILE_OVERLAP;
+        }
+        // Only the edges of the body shared with another tile are a boundary.
+        if(((imgX == job.bodyXOff) && (job.bodyXOff > 0)) || ((imgY == job.bodyYOff) && (job.bodyYOff > 0))
+           || ((imgX == (job.bodyXOff + job.bodyXSize - 1)) && ((job.bodyXOff + job.bodyXSize) < plan.width))
+           || ((imgY == (job.bodyYOff + job.bodyYSize - 1)) && ((job.bodyYOff + job.bodyYSize) < plan.height)))
+        {
+            return RSGIS_SEGTILE_BOUNDARY;
+        }
+        return RSGIS_SEGTILE_BODY;
+    }
+
+    std::string RSGISSegTilePlan::getJobImage(const RSGISSegTilePlanInfo &plan, unsigned int jobID, std::string name)
+    {
+        std::stringstream fileName;
+        fileName << plan.tilesBase << "_" << jobID << "_" << name << "." << plan.outFileExt;
+        return fileName.str();
+    }
+
+}}
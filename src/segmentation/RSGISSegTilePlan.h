@@ -0,0 +1,120 @@
+/*
+ *  RSGISSegTilePlan.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISSegTilePlan_H
+#define RSGISSegTilePlan_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <algorithm>
+
+#include "common/RSGISException.h"
+#include "common/RSGISFileException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_segmentation_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace segment{
+
+    /// The values of the tile position mask (and column) used to merge the tiles.
+    const unsigned int RSGIS_SEGTILE_BOUNDARY = 1;
+    const unsigned int RSGIS_SEGTILE_OVERLAP = 2;
+    const unsigned int RSGIS_SEGTILE_BODY = 3;
+
+    /** A tile of the plan; all the windows are in pixels of the whole image. */
+    struct DllExport RSGISSegTileJob
+    {
+        unsigned int id;
+        /// The window which is segmented (the body plus the overlap).
+        unsigned int xOff;
+        unsigned int yOff;
+        unsigned int xSize;
+        unsigned int ySize;
+        /// The window of the image which the tile is responsible for.
+        unsigned int bodyXOff;
+        unsigned int bodyYOff;
+        unsigned int bodyXSize;
+        unsigned int bodyYSize;
+        /// The jobs whose bodies touch this body, i.e., which share the border regions.
+        std::vector<unsigned int> neighbours;
+        /// The clumps image the job writes.
+        std::string clumpsImage;
+    };
+
+    struct DllExport RSGISSegTilePlanInfo
+    {
+        /// The image which is clumped (e.g., the k-means labelled pixels).
+        std::string clustersImage;
+        /// The image used to eliminate the small clumps.
+        std::string spectralImage;
+        /// The prefix (incl. directory) of the images written by the jobs.
+        std::string tilesBase;
+        std::string imageFormat;
+        std::string outFileExt;
+        unsigned int width;
+        unsigned int height;
+        unsigned int tileXSize;
+        unsigned int tileYSize;
+        unsigned int overlap;
+        std::vector<RSGISSegTileJob> jobs;
+    };
+
+    /**
+     * Defines a tiled segmentation as a set of independent tile jobs which can each
+     * be run by a separate process (e.g., a SLURM array task) and a final merge
+     * (reduce) step, and reads and writes the plan as a text manifest.
+     *
+     * Each job segments its body plus the overlap. The clumps within the body are
+     * kept, those only within the overlap are left to the neighbouring tile and those
+     * touching the boundary (the edge of the body shared with a neighbour) are masked
+     * and segmented again by the merge.
+     */
+    class DllExport RSGISSegTilePlan
+    {
+    public:
+        static RSGISSegTilePlanInfo createPlan(unsigned int width, unsigned int height, unsigned int tileXSize, unsigned int tileYSize, unsigned int overlap, std::string tilesBase, std::string outFileExt);
+        static void writeManifest(std::string manifestFile, const RSGISSegTilePlanInfo &plan);
+        static RSGISSegTilePlanInfo readManifest(std::string manifestFile);
+        static const RSGISSegTileJob& getJob(const RSGISSegTilePlanInfo &plan, unsigned int jobID);
+        /** The tile position (RSGIS_SEGTILE_*) of pixel (x, y) within the job window. */
+        static unsigned int getTilePxlPosition(const RSGISSegTilePlanInfo &plan, const RSGISSegTileJob &job, unsigned int x, unsigned int y);
+        /** The name of an intermediate image of the job (e.g., "clusters"). */
+        static std::string getJobImage(const RSGISSegTilePlanInfo &plan, unsigned int jobID, std::string name);
+    };
+
+}}
+
+#endif
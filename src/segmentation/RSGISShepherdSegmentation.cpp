@@ -0,0 +1,318 @@
+/*
+ *  RSGISShepherdSegmentation.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISShepherdSegmentation.h"
+
+namespace rsgis{namespace segment{
+    
+    void RSGISShepherdSegmentation::runSegmentation(GDALDataset *inputDS, std::string outputImage, std::string gdalFormat, const RSGISShepherdSegParams &params)
+    {
+        try
+        {
+            unsigned int width = inputDS->GetRasterXSize();
+            unsigned int height = inputDS->GetRasterYSize();
+            unsigned int numInBands = inputDS->GetRasterCount();
+            for(std::vector<unsigned int>::const_iterator iterBand = params.bands.begin(); iterBand != params.bands.end(); ++iterBand)
+            {
+                if(((*iterBand) == 0) || ((*iterBand) > numInBands))
+                {
+                    throw rsgis::RSGISImageException("A band to segment is not within the input image.");
+                }
+            }
+            
+            size_t memReq = estimateMemory(inputDS, params);
+            bool inMemory = (params.maxMemMB == 0) || (memReq <= (((size_t)params.maxMemMB) * 1024 * 1024));
+            std::string tmpBase = "";
+            if(inMemory)
+            {
+                std::cout << "Processing in Memory (" << (memReq/(1024 * 1024)) << " MB)\n";
+            }
+            else
+            {
+                std::cout << "Processing using Disk (" << (memReq/(1024 * 1024)) << " MB is required)\n";
+                tmpBase = std::string(CPLFormFilename(params.tmpDir.c_str(), CPLGetBasename(inputDS->GetDescription()), NULL));
+            }
+            std::vector<std::string> tmpImages;
+            
+            // Select the image bands.
+            GDALDataset *bandsDS = inputDS;
+            if(!params.bands.empty())
+            {
+                std::cout << "Subsetting the image bands\n";
+                unsigned int numBands = params.bands.size();
+                bandsDS = createIntermediate(inputDS, numBands, inputDS->GetRasterBand(1)->GetRasterDataType(), "bselect", inMemory, tmpBase, &tmpImages);
+                std::vector<double> row(width);
+                for(unsigned int n = 0; n < numBands; ++n)
+                {
+                    GDALRasterBand *inBand = inputDS->GetRasterBand(params.bands.at(n));
+                    GDALRasterBand *outBand = bandsDS->GetRasterBand(n+1);
+                    for(unsigned int y = 0; y < height; ++y)
+                    {
+                        inBand->RasterIO(GF_Read, 0, y, width, 1, row.data(), width, 1, GDT_Float64, 0, 0);
+                        outBand->RasterIO(GF_Write, 0, y, width, 1, row.data(), width, 1, GDT_Float64, 0, 0);
+                    }
+                }
+            }
+            unsigned int numBands = bandsDS->GetRasterCount();
+            
+            // Stretch the image, add 1 and mask the pixels where the first band is 0.
+            GDALDataset *segDS = bandsDS;
+            if(!params.noStretch)
+            {
+                std::cout << "Stretch Input Image\n";
+                double *imageMin = new double[numBands];
+                double *imageMax = new double[numBands];
+                double *outMin = new double[numBands];
+                double *outMax = new double[numBands];
+                calcStretch(bandsDS, params, imageMin, imageMax);
+                for(unsigned int n = 0; n < numBands; ++n)
+                {
+                    outMin[n] = 0;
+                    outMax[n] = 255;
+                }
+                
+                segDS = createIntermediate(bandsDS, numBands, GDT_Byte, "stchd", inMemory, tmpBase, &tmpImages);
+                rsgis::img::RSGISLinearStretchImage stretch(numBands, imageMax, imageMin, outMax, outMin, true, params.stretchNoData, 0);
+                RSGISShepherdStretchCalcImg calcStretchValue(numBands, &stretch);
+                rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&calcStretchValue, "", true);
+                calcImage.calcImage(&bandsDS, 1, segDS);
+                
+                delete[] imageMin;
+                delete[] imageMax;
+                delete[] outMin;
+                delete[] outMax;
+                
+                if(bandsDS != inputDS)
+                {
+                    GDALClose(bandsDS);
+                }
+            }
+            
+            // Cluster the image.
+            std::cout << "Performing KMeans\n";
+            rsgis::img::RSGISImageClustering imgClustering;
+            rsgis::math::Matrix *clusterCentres = imgClustering.findKMeansCentres(segDS, params.numClusters, params.maxKMeansIter, params.subSample, true, params.degreeOfChange, rsgis::math::init_diagonal_full_attach, params.numThreads);
+            rsgis::math::RSGISMatrices matrixUtils;
+            if(params.kMeansCentresFile != "")
+            {
+                matrixUtils.saveMatrix2GridTxt(clusterCentres, params.kMeansCentresFile);
+            }
+            
+            std::cout << "Apply KMeans to image\n";
+            GDALDataset *labelsDS = createIntermediate(segDS, 1, GDT_UInt32, "kmeans", inMemory, tmpBase, &tmpImages);
+            RSGISLabelPixelsUsingClusters labelPixels;
+            labelPixels.labelPixelsUsingClusters(&segDS, 1, labelsDS, clusterCentres, true);
+            matrixUtils.freeMatrix(clusterCentres);
+            
+            std::cout << "Eliminate Single Pixels\n";
+            RSGISEliminateSinglePixels elimSingles;
+            elimSingles.eliminateWorklist(segDS, labelsDS, labelsDS, 0, true, params.numThreads);
+            
+            std::cout << "Perform clump\n";
+            GDALDataset *clumpsDS = createIntermediate(segDS, 1, GDT_UInt32, "clumps", inMemory, tmpBase, &tmpImages);
+            RSGISClumpPxls clumpImg;
+            clumpImg.performClump(labelsDS, clumpsDS, true, 0, NULL, params.numThreads);
+            GDALClose(labelsDS);
+            
+            std::cout << "Eliminate small clumps\n";
+            RSGISEliminateSmallClumps elimClumps;
+            elimClumps.stepwiseEliminateSmallClumpsNoMean(segDS, clumpsDS, params.minClumpPxls, params.specDistThres, NULL, false);
+            if(segDS != inputDS)
+            {
+                GDALClose(segDS);
+            }
+            
+            std::cout << "Relabel clumps\n";
+            rsgis::img::RSGISImageUtils imgUtils;
+            GDALDataset *outDS = imgUtils.createCopy(inputDS, 1, outputImage, gdalFormat, GDT_UInt32, true, "");
+            RSGISRelabelClumps relabelImg;
+            relabelImg.relabelClumpsCalcImg(clumpsDS, outDS);
+            GDALClose(clumpsDS);
+            outDS->GetRasterBand(1)->SetMetadataItem("LAYER_TYPE", "thematic");
+            
+            if(params.calcStats)
+            {
+                std::cout << "Calculate image statistics and build pyramids\n";
+                rsgis::rastergis::RSGISPopulateWithImageStats popImageStats;
+                std::vector<unsigned int> ratBands;
+                ratBands.push_back(1);
+                popImageStats.populateImageWithRasterGISStatsAndPyramids(outDS, true, true, ratBands, params.numThreads);
+            }
+            GDALClose(outDS);
+            
+            if(!tmpImages.empty())
+            {
+                GDALDriver *gdalDriver = GetGDALDriverManager()->GetDriverByName("KEA");
+                if(gdalDriver == NULL)
+                {
+                    throw rsgis::RSGISImageException("KEA image driver is not available.");
+                }
+                for(std::vector<std::string>::iterator iterImg = tmpImages.begin(); iterImg != tmpImages.end(); ++iterImg)
+                {
+                    gdalDriver->Delete((*iterImg).c_str());
+                }
+            }
+        }
+        catch(rsgis::img::RSGISImageCalcException &e)
+        {
+            throw rsgis::RSGISImageException(e.what());
+        }
+        catch(rsgis::RSGISImageException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw rsgis::RSGISImageException(e.what());
+        }
+    }
+    
+    size_t RSGISShepherdSegmentation::estimateMemory(GDALDataset *inputDS, const RSGISShepherdSegParams &params)
+    {
+        size_t numPxls = ((size_t)inputDS->GetRasterXSize()) * ((size_t)inputDS->GetRasterYSize());
+        size_t numBands = params.bands.empty()?inputDS->GetRasterCount():params.bands.size();
+        // The labels and the clumps (the labels are released once clumped but the
+        // stepwise elimination of the clumps holds an equivalent amount).
+        size_t pxlBytes = 2 * sizeof(unsigned int);
+        if(!params.bands.empty())
+        {
+            pxlBytes += numBands * GDALGetDataTypeSizeBytes(inputDS->GetRasterBand(1)->GetRasterDataType());
+        }
+        if(!params.noStretch)
+        {
+            pxlBytes += numBands;
+        }
+        return numPxls * pxlBytes;
+    }
+    
+    GDALDataset* RSGISShepherdSegmentation::createIntermediate(GDALDataset *inputDS, unsigned int numBands, GDALDataType dataType, std::string name, bool inMemory, std::string tmpBase, std::vector<std::string> *tmpImages)
+    {
+        rsgis::img::RSGISImageUtils imgUtils;
+        GDALDataset *outDS = NULL;
+        if(inMemory)
+        {
+            outDS = imgUtils.createCopy(inputDS, numBands, "", "MEM", dataType, true, "");
+        }
+        else
+        {
+            std::string outImage = tmpBase + "_" + name + ".kea";
+            outDS = imgUtils.createCopy(inputDS, numBands, outImage, "KEA", dataType, true, "");
+            tmpImages->push_back(outImage);
+        }
+        return outDS;
+    }
+    
+    void RSGISShepherdSegmentation::calcStretch(GDALDataset *inputDS, const RSGISShepherdSegParams &params, double *imageMin, double *imageMax)
+    {
+        // The same statistics and range as RSGISStretchImage::executeLinearStdDevStretch(2).
+        unsigned int numBands = inputDS->GetRasterCount();
+        rsgis::img::ImageStats **stats = new rsgis::img::ImageStats*[numBands];
+        for(unsigned int n = 0; n < numBands; ++n)
+        {
+            stats[n] = new rsgis::img::ImageStats();
+        }
+        rsgis::img::RSGISImageStatistics calcImageStats;
+        calcImageStats.calcImageStatistics(&inputDS, 1, stats, numBands, true, true, params.stretchNoData, false);
+        
+        std::ofstream outTxtFile;
+        if(params.stretchStatsFile != "")
+        {
+            outTxtFile.open(params.stretchStatsFile.c_str());
+            if(!outTxtFile.is_open())
+            {
+                throw rsgis::img::RSGISImageCalcException("Output file for the statistics could not be opened.");
+            }
+            outTxtFile << "#stddev\n";
+            outTxtFile << "#band,img_min,img_max,out_min,out_max\n";
+        }
+        
+        for(unsigned int n = 0; n < numBands; ++n)
+        {
+            imageMin[n] = stats[n]->mean - (stats[n]->stddev * 2);
+            imageMax[n] = stats[n]->mean + (stats[n]->stddev * 2);
+            if(imageMin[n] < stats[n]->min)
+            {
+                imageMin[n] = stats[n]->min;
+            }
+            if(imageMax[n] > stats[n]->max)
+            {
+                imageMax[n] = stats[n]->max;
+            }
+            std::cout << "Band[" << n+1 << "] Min = " << stats[n]->min << " Mean = " << stats[n]->mean << " (Std Dev = " << stats[n]->stddev << ") max = " << stats[n]->max << std::endl;
+            
+            if(params.stretchStatsFile != "")
+            {
+                outTxtFile << n+1 << "," << imageMin[n] << "," << imageMax[n] << "," << 0 << "," << 255 << std::endl;
+            }
+            delete stats[n];
+        }
+        delete[] stats;
+        
+        if(params.stretchStatsFile != "")
+        {
+            outTxtFile.flush();
+            outTxtFile.close();
+        }
+    }
+    
+    
+    
+    RSGISShepherdStretchCalcImg::RSGISShepherdStretchCalcImg(int numberOutBands, rsgis::img::RSGISLinearStretchImage *stretch) : rsgis::img::RSGISCalcImageValue(numberOutBands)
+    {
+        this->stretch = stretch;
+    }
+    
+    void RSGISShepherdStretchCalcImg::calcImageValue(float *bandValues, int numBands, double *output)
+    {
+        if(bandValues[0] == 0)
+        {
+            for(int i = 0; i < numBands; ++i)
+            {
+                output[i] = 0;
+            }
+            return;
+        }
+        
+        this->stretch->calcImageValue(bandValues, numBands, output);
+        double outVal = 0;
+        for(int i = 0; i < numBands; ++i)
+        {
+            // Round to the 8 bit stretched image and then add 1, saturating at 255.
+            outVal = floor(output[i] + 0.5);
+            if(outVal < 0)
+            {
+                outVal = 0;
+            }
+            else if(outVal > 254)
+            {
+                outVal = 254;
+            }
+            output[i] = outVal + 1;
+        }
+    }
+    
+    RSGISShepherdStretchCalcImg::~RSGISShepherdStretchCalcImg()
+    {
+        
+    }
+    
+}}
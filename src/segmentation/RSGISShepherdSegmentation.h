@@ -0,0 +1,148 @@
+/*
+ *  RSGISShepherdSegmentation.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISShepherdSegmentation_H
+#define RSGISShepherdSegmentation_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include "common/RSGISImageException.h"
+#include "common/rsgis-tqdm.h"
+
+#include "img/RSGISImageUtils.h"
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISCalcImageValue.h"
+#include "img/RSGISCalcImage.h"
+#include "img/RSGISImageStatistics.h"
+#include "img/RSGISStretchImage.h"
+#include "img/RSGISImageClustering.h"
+
+#include "math/RSGISClustering.h"
+#include "math/RSGISMatrices.h"
+
+#include "segmentation/RSGISLabelPixelsUsingClusters.h"
+#include "segmentation/RSGISEliminateSinglePixels.h"
+#include "segmentation/RSGISClumpPxls.h"
+#include "segmentation/RSGISEliminateSmallClumps.h"
+
+#include "rastergis/RSGISCalcImageStatsAndPyramids.h"
+
+#include "gdal_priv.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_segmentation_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace segment{
+
+    struct DllExport RSGISShepherdSegParams
+    {
+        RSGISShepherdSegParams()
+        {
+            noStretch = false;
+            stretchNoData = 1;
+            stretchStatsFile = "";
+            numClusters = 60;
+            maxKMeansIter = 200;
+            subSample = 100;
+            degreeOfChange = 0.0025;
+            kMeansCentresFile = "";
+            minClumpPxls = 100;
+            specDistThres = 100;
+            calcStats = true;
+            maxMemMB = 0;
+            tmpDir = "";
+            numThreads = 1;
+        };
+        /// The (1-based) bands of the input image to segment; empty for all the bands.
+        std::vector<unsigned int> bands;
+        bool noStretch;
+        /// The no data value of the linear 2 standard deviation stretch (1 is the value run_shepherd_segmentation has always used).
+        float stretchNoData;
+        /// If not empty the stretch statistics are written to this file.
+        std::string stretchStatsFile;
+        unsigned int numClusters;
+        unsigned int maxKMeansIter;
+        unsigned int subSample;
+        float degreeOfChange;
+        /// If not empty the k-means centres are written to this file (with '.gmtxt' appended).
+        std::string kMeansCentresFile;
+        unsigned int minClumpPxls;
+        float specDistThres;
+        /// Populate the RAT of the output clumps and build the pyramids.
+        bool calcStats;
+        /// If greater than 0 and the intermediate images need more memory than this they are written to tmpDir (as KEA files).
+        unsigned long maxMemMB;
+        std::string tmpDir;
+        unsigned int numThreads;
+    };
+
+    /**
+     * Runs the segmentation of Shepherd et al. (2019) from the input image to the
+     * final clumps in one pass, i.e., the band selection, stretch (with the +1 offset
+     * and masking of the pixels where the first band is 0), k-means clustering, pixel
+     * labelling, single pixel elimination, clumping, stepwise elimination of the small
+     * clumps and relabelling. The intermediate images are held as GDAL MEM datasets
+     * (unless they exceed maxMemMB, when they are written to tmpDir) and only the final
+     * clumps (and their RAT) are written.
+     */
+    class DllExport RSGISShepherdSegmentation
+    {
+    public:
+        static void runSegmentation(GDALDataset *inputDS, std::string outputImage, std::string gdalFormat, const RSGISShepherdSegParams &params);
+        /** The memory (in bytes) required for the intermediate images of the segmentation. */
+        static size_t estimateMemory(GDALDataset *inputDS, const RSGISShepherdSegParams &params);
+    private:
+        static GDALDataset* createIntermediate(GDALDataset *inputDS, unsigned int numBands, GDALDataType dataType, std::string name, bool inMemory, std::string tmpBase, std::vector<std::string> *tmpImages);
+        static void calcStretch(GDALDataset *inputDS, const RSGISShepherdSegParams &params, double *imageMin, double *imageMax);
+    };
+
+    /**
+     * The linear stretch (to 0-255) of the segmentation plus 1, with the pixels where
+     * the first band is 0 set to 0 in all the bands.
+     */
+    class DllExport RSGISShepherdStretchCalcImg : public rsgis::img::RSGISCalcImageValue
+    {
+    public:
+        RSGISShepherdStretchCalcImg(int numberOutBands, rsgis::img::RSGISLinearStretchImage *stretch);
+        void calcImageValue(float *bandValues, int numBands, double *output);
+        ~RSGISShepherdStretchCalcImg();
+    protected:
+        rsgis::img::RSGISLinearStretchImage *stretch;
+    };
+
+}}
+
+#endif
@@ -28,7 +28,14 @@ namespace rsgis{namespace utils{
     
     RSGISExportColumnData2HDF::RSGISExportColumnData2HDF()
     {
-        
+        this->dataH5File = NULL;
+        this->numCols = 0;
+        this->blockSize = 0;
+        this->numColsWritten = 0;
+        this->bufferRowBytes = 0;
+        this->maxBufferRows = 0;
+        this->numBufferedRows = 0;
+        this->numDatasetRows = 0;
     }
 
     H5::DataType RSGISExportColumnData2HDF::getH5DataType(RSGISLibDataType rsgis_datatype)
@@ -81,7 +88,7 @@ namespace rsgis{namespace utils{
         return h5_dtype;
     }
     
-    void RSGISExportColumnData2HDF::createFile(std::string filePath, unsigned int numCols, std::string description, H5::DataType dataType)
+    void RSGISExportColumnData2HDF::createFile(std::string filePath, unsigned int numCols, std::string description, H5::DataType dataType, unsigned int chunkRows, unsigned int deflate, unsigned int bufferRows)
     {
         try
         {
@@ -117,15 +124,21 @@ namespace rsgis{namespace utils{
             datasetDescription.close();
             delete[] wStrdata;
             
-            this->blockSize = 1000;
-            int deflate = 1;
+            if(chunkRows == 0)
+            {
+                throw RSGISFileException("The number of rows within a chunk must be greater than zero.");
+            }
+            this->blockSize = chunkRows;
             int initFillVal = 0;
             
             hsize_t dimsDataChunk[] = { blockSize, numCols };
             H5::DSetCreatPropList initParamsData;
             initParamsData.setChunk(2, dimsDataChunk);
-            initParamsData.setShuffle();
-            initParamsData.setDeflate(deflate);
+            if(deflate > 0)
+            {
+                initParamsData.setShuffle();
+                initParamsData.setDeflate(deflate);
+            }
             initParamsData.setFillValue( H5::PredType::NATIVE_INT, &initFillVal);
             
             hsize_t initDataDims[] = { 0, numCols };
@@ -135,7 +148,18 @@ namespace rsgis{namespace utils{
             this->columnDataSet = this->dataH5File->createDataSet("/DATA/DATA", dataType, dataSpaceData, initParamsData);
             
             this->numColsWritten = 0;
-            this->numCols = numCols;            
+            this->numCols = numCols;
+            this->numDatasetRows = 0;
+            
+            // Buffer a whole number of chunks so the data is written chunk by chunk.
+            if(bufferRows < chunkRows)
+            {
+                bufferRows = chunkRows;
+            }
+            this->maxBufferRows = ((bufferRows + chunkRows - 1) / chunkRows) * chunkRows;
+            this->numBufferedRows = 0;
+            this->bufferRowBytes = 0;
+            this->rowBuffer.clear();
         }
         catch (rsgis::RSGISFileException &e)
         {
@@ -169,25 +193,28 @@ namespace rsgis{namespace utils{
         {
             H5::Exception::dontPrint();
             
-            hsize_t extendDatasetTo[2];
-            extendDatasetTo[0] = this->numColsWritten + 1;
-            extendDatasetTo[1] = this->numCols;
-            columnDataSet.extend( extendDatasetTo );
-            
-            hsize_t dataOffset[2];
-            dataOffset[0] = this->numColsWritten;
-            dataOffset[1] = 0;
-            hsize_t dataDims[2];
-            dataDims[0] = 1;
-            dataDims[1] = numCols;
+            if((this->numBufferedRows > 0) && (!(this->bufferDatatype == h5Datatype)))
+            {
+                this->flushBuffer();
+            }
             
-            H5::DataSpace colWriteDataSpace = columnDataSet.getSpace();
-            colWriteDataSpace.selectHyperslab(H5S_SELECT_SET, dataDims, dataOffset);
-            H5::DataSpace newDataspace = H5::DataSpace(2, dataDims);
+            if(this->numBufferedRows == 0)
+            {
+                this->bufferDatatype = h5Datatype;
+                this->bufferRowBytes = h5Datatype.getSize() * this->numCols;
+                if(this->rowBuffer.size() < (this->bufferRowBytes * this->maxBufferRows))
+                {
+                    this->rowBuffer.resize(this->bufferRowBytes * this->maxBufferRows);
+                }
+            }
             
-            columnDataSet.write(data, h5Datatype, newDataspace, colWriteDataSpace);
+            std::memcpy(&this->rowBuffer[this->numBufferedRows * this->bufferRowBytes], data, this->bufferRowBytes);
+            ++this->numBufferedRows;
             
-            ++this->numColsWritten;
+            if(this->numBufferedRows == this->maxBufferRows)
+            {
+                this->flushBuffer();
+            }
         }
         catch (rsgis::RSGISFileException &e)
         {
@@ -215,12 +242,100 @@ namespace rsgis{namespace utils{
         }
     }
     
+    void RSGISExportColumnData2HDF::flushBuffer()
+    {
+        if(this->numBufferedRows == 0)
+        {
+            return;
+        }
+        
+        hsize_t rowsNeeded = ((hsize_t)this->numColsWritten) + this->numBufferedRows;
+        if(rowsNeeded > this->numDatasetRows)
+        {
+            // Grow geometrically so the dataset is only extended a few times.
+            hsize_t newDatasetRows = this->numDatasetRows * 2;
+            if(newDatasetRows < rowsNeeded)
+            {
+                newDatasetRows = rowsNeeded;
+            }
+            newDatasetRows = ((newDatasetRows + this->blockSize - 1) / this->blockSize) * this->blockSize;
+            
+            hsize_t extendDatasetTo[2];
+            extendDatasetTo[0] = newDatasetRows;
+            extendDatasetTo[1] = this->numCols;
+            this->columnDataSet.extend( extendDatasetTo );
+            this->numDatasetRows = newDatasetRows;
+        }
+        
+        hsize_t dataOffset[2];
+        dataOffset[0] = this->numColsWritten;
+        dataOffset[1] = 0;
+        hsize_t dataDims[2];
+        dataDims[0] = this->numBufferedRows;
+        dataDims[1] = this->numCols;
+        
+        H5::DataSpace colWriteDataSpace = this->columnDataSet.getSpace();
+        colWriteDataSpace.selectHyperslab(H5S_SELECT_SET, dataDims, dataOffset);
+        H5::DataSpace newDataspace = H5::DataSpace(2, dataDims);
+        
+        this->columnDataSet.write(&this->rowBuffer[0], this->bufferDatatype, newDataspace, colWriteDataSpace);
+        
+        this->numColsWritten += this->numBufferedRows;
+        this->numBufferedRows = 0;
+    }
+    
     void RSGISExportColumnData2HDF::close()
     {
-        this->columnDataSet.close();
-        this->dataH5File->flush(H5F_SCOPE_GLOBAL);
-        this->dataH5File->close();
-        delete this->dataH5File;
+        try
+        {
+            H5::Exception::dontPrint();
+            
+            this->flushBuffer();
+            
+            // Trim the dataset back to the number of rows which have been added.
+            if(this->numDatasetRows != this->numColsWritten)
+            {
+                hsize_t datasetDims[2];
+                datasetDims[0] = this->numColsWritten;
+                datasetDims[1] = this->numCols;
+                if(H5Dset_extent(this->columnDataSet.getId(), datasetDims) < 0)
+                {
+                    throw RSGISFileException("Could not set the final size of the HDF5 dataset.");
+                }
+                this->numDatasetRows = this->numColsWritten;
+            }
+            
+            this->columnDataSet.close();
+            this->dataH5File->flush(H5F_SCOPE_GLOBAL);
+            this->dataH5File->close();
+            delete this->dataH5File;
+            this->dataH5File = NULL;
+            std::vector<char>().swap(this->rowBuffer);
+        }
+        catch (rsgis::RSGISFileException &e)
+        {
+            throw e;
+        }
+        catch (H5::FileIException &e)
+        {
+            throw RSGISFileException(e.getCDetailMsg());
+        }
+        catch (H5::DataSetIException &e)
+        {
+            throw RSGISFileException(e.getCDetailMsg());
+        }
+        catch (H5::DataSpaceIException &e)
+        {
+            throw RSGISFileException(e.getCDetailMsg());
+        }
+        catch (H5::DataTypeIException &e)
+        {
+            throw RSGISFileException(e.getCDetailMsg());
+        }
+        catch ( std::exception &e)
+        {
+            throw RSGISFileException(e.what());
+        }
     }
 		
     RSGISExportColumnData2HDF::~RSGISExportColumnData2HDF()
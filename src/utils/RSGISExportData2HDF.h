@@ -26,6 +26,8 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
+#include <cstring>
 
 #include <boost/cstdint.hpp>
 
@@ -64,22 +66,39 @@ namespace rsgis{namespace utils{
     static const hsize_t  HDF5_WRITE_META_BLOCKSIZE( 2048 );
     static const unsigned int HDF5_WRITE_DEFLATE( 1 );
     static const hsize_t HDF5_WRITE_CHUNK_SIZE( 250 ); //100
+    static const unsigned int HDF5_WRITE_COLDATA_CHUNK_ROWS( 1000 ); // matches the 1000 row blocks read when sampling
+    static const unsigned int HDF5_WRITE_COLDATA_BUFFER_ROWS( 10000 );
     
+    /**
+     * Writes rows of column data to a HDF5 file. Rows are accumulated in memory
+     * (bufferRows rows, rounded up to a whole number of chunks) and written as
+     * whole chunks, with the dataset grown geometrically and trimmed to the number
+     * of rows added when the file is closed. Each chunk holds chunkRows complete
+     * rows so blocks of rows can be read back while decompressing each chunk once.
+     * A deflate level of 0 disables the shuffle and deflate filters.
+     */
 	class DllExport RSGISExportColumnData2HDF
 	{
 	public:
 		RSGISExportColumnData2HDF();
         H5::DataType getH5DataType(RSGISLibDataType rsgis_datatype);
-        void createFile(std::string filePath, unsigned int numCols, std::string description, H5::DataType dataType);
+        void createFile(std::string filePath, unsigned int numCols, std::string description, H5::DataType dataType, unsigned int chunkRows=HDF5_WRITE_COLDATA_CHUNK_ROWS, unsigned int deflate=HDF5_WRITE_DEFLATE, unsigned int bufferRows=HDF5_WRITE_COLDATA_BUFFER_ROWS);
         void addDataRow(void *data, H5::DataType h5Datatype);
         void close();
 		~RSGISExportColumnData2HDF();
     protected:
+        void flushBuffer();
         H5::H5File *dataH5File;
         H5::DataSet columnDataSet;
         unsigned int numCols;
         unsigned int blockSize;
         unsigned int numColsWritten;
+        std::vector<char> rowBuffer;
+        H5::DataType bufferDatatype;
+        size_t bufferRowBytes;
+        unsigned int maxBufferRows;
+        unsigned int numBufferedRows;
+        hsize_t numDatasetRows;
 	};
     
     class DllExport RSGISReadHDFColumnData
@@ -0,0 +1,174 @@
+/*
+ *  RSGISOGRFeatureSink.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISOGRFeatureSink.h"
+
+namespace rsgis{namespace utils{
+
+    RSGISOGRFeatureSink::RSGISOGRFeatureSink(OGRLayer *layer, unsigned int transactionSize)
+    {
+        if(layer == NULL)
+        {
+            throw RSGISVectorException("The output vector layer is NULL.");
+        }
+        this->layer = layer;
+        this->feature = NULL;
+        this->transactionSize = transactionSize;
+        this->numFeaturesWritten = 0;
+        this->numInTransaction = 0;
+        this->inTransaction = false;
+    }
+
+    OGRFeature* RSGISOGRFeatureSink::getFeature()
+    {
+        if(this->feature == NULL)
+        {
+            this->feature = OGRFeature::CreateFeature(this->layer->GetLayerDefn());
+        }
+        else
+        {
+            // The driver sets the FID when the feature is written so reset it for the next feature.
+            this->feature->SetFID(OGRNullFID);
+            this->feature->SetGeometryDirectly(NULL);
+            for(int i = 0; i < this->feature->GetFieldCount(); ++i)
+            {
+                this->feature->UnsetField(i);
+            }
+        }
+        return this->feature;
+    }
+
+    void RSGISOGRFeatureSink::writeFeature(OGRFeature *feature)
+    {
+        if(!this->inTransaction)
+        {
+            this->layer->StartTransaction();
+            this->inTransaction = true;
+            this->numInTransaction = 0;
+        }
+
+        if( this->layer->CreateFeature(feature) != OGRERR_NONE )
+        {
+            throw RSGISVectorException("Failed to write feature to the vector layer.");
+        }
+        ++this->numFeaturesWritten;
+        ++this->numInTransaction;
+
+        // A transaction size of 0 writes all the features within a single transaction.
+        if((this->transactionSize > 0) && (this->numInTransaction >= this->transactionSize))
+        {
+            this->inTransaction = false;
+            if( this->layer->CommitTransaction() != OGRERR_NONE )
+            {
+                throw RSGISVectorException("Failed to commit the features written to the vector layer.");
+            }
+        }
+    }
+
+    void RSGISOGRFeatureSink::writeGeometryDirectly(OGRGeometry *geom)
+    {
+        OGRFeature *outFeature = this->getFeature();
+        outFeature->SetGeometryDirectly(geom);
+        this->writeFeature(outFeature);
+    }
+
+    void RSGISOGRFeatureSink::close()
+    {
+        if(this->feature != NULL)
+        {
+            OGRFeature::DestroyFeature(this->feature);
+            this->feature = NULL;
+        }
+        if(this->inTransaction)
+        {
+            this->inTransaction = false;
+            if( this->layer->CommitTransaction() != OGRERR_NONE )
+            {
+                throw RSGISVectorException("Failed to commit the features written to the vector layer.");
+            }
+        }
+    }
+
+    char** RSGISOGRFeatureSink::getDeferredSpatialIndexOptions(std::string driverName, char **layerOptions)
+    {
+        if(driverName == "GPKG")
+        {
+            layerOptions = CSLSetNameValue(layerOptions, "SPATIAL_INDEX", "NO");
+        }
+        else if(driverName == "PostgreSQL")
+        {
+            layerOptions = CSLSetNameValue(layerOptions, "SPATIAL_INDEX", "NONE");
+        }
+        return layerOptions;
+    }
+
+    void RSGISOGRFeatureSink::createDeferredSpatialIndex(GDALDataset *dataset, OGRLayer *layer, std::string driverName)
+    {
+        std::string layerName = std::string(layer->GetName());
+        std::string geomColName = std::string(layer->GetGeometryColumn());
+        std::string sql = "";
+        if(driverName == "GPKG")
+        {
+            sql = std::string("SELECT CreateSpatialIndex('") + std::string(CPLString(layerName).replaceAll("'", "''")) + std::string("', '") + std::string(CPLString(geomColName).replaceAll("'", "''")) + std::string("')");
+        }
+        else if(driverName == "PostgreSQL")
+        {
+            // The layer name can include the schema (i.e., schema.table).
+            std::string tableName = std::string("\"") + std::string(CPLString(layerName).replaceAll("\"", "\"\"")) + std::string("\"");
+            size_t sepIdx = layerName.find('.');
+            if(sepIdx != std::string::npos)
+            {
+                tableName = std::string("\"") + std::string(CPLString(layerName.substr(0, sepIdx)).replaceAll("\"", "\"\"")) + std::string("\".\"") + std::string(CPLString(layerName.substr(sepIdx+1)).replaceAll("\"", "\"\"")) + std::string("\"");
+            }
+            sql = std::string("CREATE INDEX ON ") + tableName + std::string(" USING GIST (\"") + std::string(CPLString(geomColName).replaceAll("\"", "\"\"")) + std::string("\")");
+        }
+        else
+        {
+            // The other drivers build the index themselves (or do not have one).
+            return;
+        }
+
+        CPLErrorReset();
+        OGRLayer *resultLayer = dataset->ExecuteSQL(sql.c_str(), NULL, NULL);
+        if(resultLayer != NULL)
+        {
+            dataset->ReleaseResultSet(resultLayer);
+        }
+        if(CPLGetLastErrorType() == CE_Failure)
+        {
+            throw RSGISVectorException(std::string("Failed to create the spatial index: ") + std::string(CPLGetLastErrorMsg()));
+        }
+    }
+
+    RSGISOGRFeatureSink::~RSGISOGRFeatureSink()
+    {
+        try
+        {
+            this->close();
+        }
+        catch(RSGISVectorException &e)
+        {
+            std::cerr << "WARNING: " << e.what() << std::endl;
+        }
+    }
+
+}}
@@ -0,0 +1,88 @@
+/*
+ *  RSGISOGRFeatureSink.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISOGRFeatureSink_H
+#define RSGISOGRFeatureSink_H
+
+#include <iostream>
+#include <string>
+
+#include "gdal_priv.h"
+#include "ogrsf_frmts.h"
+
+#include "common/RSGISVectorException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_utils_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace utils{
+
+    static const unsigned int RSGIS_OGR_SINK_TRANSACTION_SIZE( 20000 );
+
+    /**
+     * Writes new features to an OGR layer within transactions of transactionSize
+     * features (committed by close or when the sink is destroyed), reusing a single
+     * OGRFeature for the output features. For drivers which build a spatial index
+     * as features are added (GPKG and PostgreSQL) the layer can be created with
+     * getDeferredSpatialIndexOptions and the index built once the features have been
+     * written with createDeferredSpatialIndex.
+     */
+    class DllExport RSGISOGRFeatureSink
+    {
+    public:
+        RSGISOGRFeatureSink(OGRLayer *layer, unsigned int transactionSize=RSGIS_OGR_SINK_TRANSACTION_SIZE);
+        /** Get the feature to populate for the next output feature, its fields are unset and it has no geometry or FID. */
+        OGRFeature* getFeature();
+        /** Write a feature to the layer (either the feature from getFeature or one owned by the caller). */
+        void writeFeature(OGRFeature *feature);
+        /** Write a feature with the geometry, which is owned by the sink. */
+        void writeGeometryDirectly(OGRGeometry *geom);
+        /** Commit the features which have been written. */
+        void close();
+        size_t getNumFeaturesWritten(){return this->numFeaturesWritten;};
+        /** Add the layer creation options to build the spatial index on request for the driver (the options are returned). */
+        static char** getDeferredSpatialIndexOptions(std::string driverName, char **layerOptions=NULL);
+        /** Build the spatial index for a layer created with getDeferredSpatialIndexOptions. */
+        static void createDeferredSpatialIndex(GDALDataset *dataset, OGRLayer *layer, std::string driverName);
+        ~RSGISOGRFeatureSink();
+    protected:
+        OGRLayer *layer;
+        OGRFeature *feature;
+        unsigned int transactionSize;
+        size_t numFeaturesWritten;
+        size_t numInTransaction;
+        bool inTransaction;
+    };
+
+}}
+
+#endif
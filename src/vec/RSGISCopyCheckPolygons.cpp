@@ -24,6 +24,36 @@
 #include "RSGISCopyCheckPolygons.h"
 
 namespace rsgis{namespace vec{
+
+    struct RSGISCheckPolygonsBatch
+    {
+        std::vector<OGRFeature*> inFeatures;
+        std::vector<OGRFeature*> outFeatures;
+        std::vector<RSGISPolygonCheckStatus> status;
+        std::vector<std::string> errMsgs;
+        
+        void clear()
+        {
+            for(size_t i = 0; i < this->inFeatures.size(); ++i)
+            {
+                if(this->inFeatures[i] != NULL)
+                {
+                    OGRFeature::DestroyFeature(this->inFeatures[i]);
+                }
+            }
+            for(size_t i = 0; i < this->outFeatures.size(); ++i)
+            {
+                if(this->outFeatures[i] != NULL)
+                {
+                    OGRFeature::DestroyFeature(this->outFeatures[i]);
+                }
+            }
+            this->inFeatures.clear();
+            this->outFeatures.clear();
+            this->status.clear();
+            this->errMsgs.clear();
+        }
+    };
 	
 
 	RSGISCopyCheckPolygons::RSGISCopyCheckPolygons()
@@ -31,138 +61,223 @@ namespace rsgis{namespace vec{
 		
 	}
 	
-	void RSGISCopyCheckPolygons::copyCheckPolygons(OGRLayer *input, OGRLayer *output, bool printErrors)
+	void RSGISCopyCheckPolygons::copyCheckPolygons(OGRLayer *input, OGRLayer *output, bool printErrors, unsigned int numThreads)
 	{
-		RSGISVectorUtils vecUtils;
-		
-		OGRFeature *inFeature = NULL;
-		OGRFeature *outFeature = NULL;
-		OGRGeometry *geometry = NULL;
-		OGRPolygon *polygon = NULL;
-		OGRPolygon *nPolygon = NULL;
+		OGRFeatureDefn *inFeatureDefn = input->GetLayerDefn();
+		this->copyFeatureDefn(output, inFeatureDefn);
+		OGRFeatureDefn *outFeatureDefn = output->GetLayerDefn();
 		
-		bool nullGeometry = false;
-		bool polyOK = false;
+		GIntBig layerFeatCount = input->GetFeatureCount(true);
+		size_t numFeatures = (layerFeatCount > 0)?layerFeatCount:0;
+		// The last batch reads all the remaining features in case the count was not exact.
+		size_t nBatches = std::max<size_t>((numFeatures + checkBatchSize - 1) / checkBatchSize, 1);
 		
-		OGRFeatureDefn *inFeatureDefn = NULL;
-		OGRFeatureDefn *outFeatureDefn = NULL;
+		const unsigned int numBuffers = 3;
+		std::vector<RSGISCheckPolygonsBatch> batches(numBuffers);
+		bool inTransaction = false;
+		size_t nProcessed = 0;
+		size_t nWritten = 0;
+		// Number of features with each RSGISPolygonCheckStatus.
+		size_t statusCounts[5] = {0, 0, 0, 0, 0};
 		
-		long fid = 0;
-		long unsigned numOutputted = 0;
+		rsgis::RSGISThreadPool threadPool(numThreads);
+		rsgis::RSGISStripIOPipeline pipeline(numBuffers);
+		std::cout << "There are " << numFeatures << " to process using " << threadPool.getNumThreads() << " threads.\n";
+		rsgis_tqdm pbar;
 		
 		try
 		{
-			inFeatureDefn = input->GetLayerDefn();
-			this->copyFeatureDefn(output, inFeatureDefn);
-			outFeatureDefn = output->GetLayerDefn();
-			
-			unsigned long numFeatures = input->GetFeatureCount(true);
-			
-			std::cout << "There are " << numFeatures << " to process\n";
-			
-			unsigned long i = 0;
-            unsigned int transactionStep = 20000;
-            unsigned int nextTransaction = transactionStep;
-            bool openTransaction = false;
-			rsgis_tqdm pbar;
-			
 			input->ResetReading();
-			while( (inFeature = input->GetNextFeature()) != NULL )
+			pipeline.run(nBatches, [&](size_t b, unsigned int buf)
 			{
-				pbar.progress(i, numFeatures);
-				++i;
-
-                if(!openTransaction)
-                {
-                    output->StartTransaction();
-                    openTransaction = true;
-                }
-				
-				fid = inFeature->GetFID();
-				
-				// Get Geometry.
-				polyOK = false;
-				nullGeometry = false;
-				geometry = inFeature->GetGeometryRef();
-				if((geometry != nullptr) && (wkbFlatten(geometry->getGeometryType()) == wkbPolygon))
+				RSGISCheckPolygonsBatch *batch = &batches[buf];
+				batch->clear();
+				bool lastBatch = (b == (nBatches - 1));
+				OGRFeature *inFeature = NULL;
+				while((lastBatch || (batch->inFeatures.size() < checkBatchSize)) && ((inFeature = input->GetNextFeature()) != NULL))
 				{
-					polygon = (OGRPolygon *) geometry;
-					
-					try 
+					batch->inFeatures.push_back(inFeature);
+				}
+				batch->outFeatures.assign(batch->inFeatures.size(), NULL);
+				batch->status.assign(batch->inFeatures.size(), rsgis_polycheck_valid);
+				batch->errMsgs.assign(batch->inFeatures.size(), "");
+			},
+			[&](size_t b, unsigned int buf)
+			{
+				RSGISCheckPolygonsBatch *batch = &batches[buf];
+				threadPool.parallelFor(0, batch->inFeatures.size(), [&](unsigned int t, size_t start, size_t end)
+				{
+					for(size_t i = start; i < end; ++i)
 					{
-						nPolygon = vecUtils.checkCloseOGRPolygon(polygon);
-						polyOK = true;
+						OGRFeature *inFeature = batch->inFeatures[i];
+						OGRGeometry *outGeom = this->checkPolygon(inFeature, &batch->status[i], &batch->errMsgs[i]);
+						if(outGeom != NULL)
+						{
+							OGRFeature *outFeature = OGRFeature::CreateFeature(outFeatureDefn);
+							outFeature->SetGeometryDirectly(outGeom);
+							outFeature->SetFID(inFeature->GetFID());
+							this->copyFeatureData(inFeature, outFeature, inFeatureDefn, outFeatureDefn);
+							batch->outFeatures[i] = outFeature;
+						}
 					}
-					catch (RSGISVectorException &e) 
+				});
+			},
+			[&](size_t b, unsigned int buf)
+			{
+				RSGISCheckPolygonsBatch *batch = &batches[buf];
+				for(size_t i = 0; i < batch->inFeatures.size(); ++i)
+				{
+					++nProcessed;
+					statusCounts[batch->status[i]]++;
+					if(printErrors && (batch->status[i] != rsgis_polycheck_valid))
 					{
-                        if(printErrors)
-                        {
-                            std::cout << fid << ": " << e.what() << std::endl;
-                        }
-						polyOK = false;
+						std::cout << batch->inFeatures[i]->GetFID() << ": " << batch->errMsgs[i] << std::endl;
+					}
+					if(batch->outFeatures[i] == NULL)
+					{
+						continue;
 					}
 					
-				} 
-				else 
-				{
-					nullGeometry = true;
-                    if(printErrors)
-                    {
-                        std::cout << fid << ": Geometry was either the incorrect type or NULL." << std::endl;
-                    }
-				}
-				
-				if(polyOK && !nullGeometry)
-				{
-					outFeature = OGRFeature::CreateFeature(outFeatureDefn);
-					outFeature->SetGeometry(nPolygon);
-					outFeature->SetFID(fid);
-					this->copyFeatureData(inFeature, outFeature, inFeatureDefn, outFeatureDefn);
-					
-					if( output->CreateFeature(outFeature) != OGRERR_NONE )
+					if(!inTransaction)
+					{
+						output->StartTransaction();
+						inTransaction = true;
+					}
+					if( output->CreateFeature(batch->outFeatures[i]) != OGRERR_NONE )
 					{
 						throw RSGISVectorOutputException("Failed to write feature to the output shapefile.");
 					}
-					
-					OGRFeature::DestroyFeature(outFeature);
-					numOutputted++;
+					++nWritten;
+					if(((nWritten % checkTransactionSize) == 0) && inTransaction)
+					{
+						output->CommitTransaction();
+						inTransaction = false;
+					}
 				}
-				else 
+				batch->clear();
+				if(numFeatures > 0)
 				{
-                    if(printErrors)
-                    {
-                        std::cout << fid << ": Geometry is either NULL or not a polygon\n";
-                    }
+					pbar.progress((int)((std::min(nProcessed, numFeatures) * 100) / numFeatures), 100);
 				}
-
-                if(openTransaction && (i == nextTransaction))
-                {
-                    output->CommitTransaction();
-                    openTransaction = false;
-                    nextTransaction = nextTransaction + transactionStep;
-                }
-
-				OGRFeature::DestroyFeature(inFeature);
+			});
+			
+			if(inTransaction)
+			{
+				output->CommitTransaction();
+				inTransaction = false;
 			}
-
-            if(openTransaction)
-            {
-                output->CommitTransaction();
-                openTransaction = false;
-            }
 			pbar.finish();
-			
-			std::cout << numOutputted << " Polygons have been outputted from the " << numFeatures << " in the input file.\n";
-			std::cout << (numFeatures-numOutputted) << " features have been dropped during this process\n";
-			if(numOutputted != numFeatures)
+		}
+		catch(...)
+		{
+			for(size_t i = 0; i < batches.size(); ++i)
+			{
+				batches[i].clear();
+			}
+			if(inTransaction)
+			{
+				output->CommitTransaction();
+			}
+			throw;
+		}
+		
+		std::cout << nWritten << " Polygons have been outputted from the " << nProcessed << " in the input file.\n";
+		std::cout << "\t" << statusCounts[rsgis_polycheck_valid] << " polygons were valid.\n";
+		std::cout << "\t" << statusCounts[rsgis_polycheck_repaired] << " invalid polygons were repaired.\n";
+		std::cout << "\t" << statusCounts[rsgis_polycheck_unrepairable] << " invalid polygons could not be repaired and were dropped.\n";
+		std::cout << "\t" << statusCounts[rsgis_polycheck_badring] << " polygons had too few points and were dropped.\n";
+		std::cout << "\t" << statusCounts[rsgis_polycheck_nullgeom] << " geometries were either NULL or not a polygon and were dropped.\n";
+		if(nWritten != nProcessed)
+		{
+			std::cout << "** It is recommend that you check the output file before using for further processing ** \n";
+		}
+	}
+	
+	OGRGeometry* RSGISCopyCheckPolygons::checkPolygon(OGRFeature *inFeature, RSGISPolygonCheckStatus *status, std::string *errMsg)
+	{
+		RSGISVectorUtils vecUtils;
+		OGRGeometry *geometry = inFeature->GetGeometryRef();
+		if((geometry == NULL) || (wkbFlatten(geometry->getGeometryType()) != wkbPolygon))
+		{
+			*status = rsgis_polycheck_nullgeom;
+			*errMsg = "Geometry was either the incorrect type or NULL.";
+			return NULL;
+		}
+		
+		OGRPolygon *nPolygon = NULL;
+		try
+		{
+			nPolygon = vecUtils.checkCloseOGRPolygon((OGRPolygon *) geometry);
+		}
+		catch (RSGISVectorException &e)
+		{
+			*status = rsgis_polycheck_badring;
+			*errMsg = e.what();
+			return NULL;
+		}
+		
+		// Each IsValid / MakeValid call uses its own GEOS context so the
+		// features can be checked on several threads at once.
+		if(nPolygon->IsValid())
+		{
+			*status = rsgis_polycheck_valid;
+			return nPolygon;
+		}
+		
+		OGRGeometry *validGeom = nPolygon->MakeValid();
+		delete nPolygon;
+		
+		// Only keep the polygonal parts of the repaired geometry.
+		OGRMultiPolygon *polys = new OGRMultiPolygon();
+		if(validGeom != NULL)
+		{
+			std::vector<OGRGeometry*> parts;
+			parts.push_back(validGeom);
+			while(!parts.empty())
 			{
-				std::cout << "** It is recommend that you check the output file before using for further processing ** \n";
+				OGRGeometry *part = parts.back();
+				parts.pop_back();
+				OGRwkbGeometryType partType = wkbFlatten(part->getGeometryType());
+				if(partType == wkbPolygon)
+				{
+					polys->addGeometry(part);
+				}
+				else if((partType == wkbMultiPolygon) || (partType == wkbGeometryCollection))
+				{
+					OGRGeometryCollection *geomColl = (OGRGeometryCollection *) part;
+					for(int i = geomColl->getNumGeometries()-1; i >= 0; --i)
+					{
+						parts.push_back(geomColl->getGeometryRef(i));
+					}
+				}
 			}
+			delete validGeom;
+		}
+		
+		OGRGeometry *outGeom = NULL;
+		if(polys->getNumGeometries() == 1)
+		{
+			outGeom = polys->getGeometryRef(0)->clone();
+			delete polys;
 		}
-		catch(RSGISVectorException &e)
+		else if(polys->getNumGeometries() > 1)
+		{
+			outGeom = polys;
+		}
+		else
+		{
+			delete polys;
+		}
+		
+		if(outGeom == NULL)
 		{
-			throw e;
+			*status = rsgis_polycheck_unrepairable;
+			*errMsg = "Polygon is invalid and could not be repaired.";
+			return NULL;
 		}
+		*status = rsgis_polycheck_repaired;
+		*errMsg = "Polygon was invalid and has been repaired.";
+		return outGeom;
 	}
 	
 	void RSGISCopyCheckPolygons::copyFeatureDefn(OGRLayer *outputVecLayer, OGRFeatureDefn *inFeatureDefn)
@@ -27,11 +27,15 @@
 #include <iostream>
 #include <string>
 #include <list>
+#include <vector>
+#include <algorithm>
 
 #include "ogrsf_frmts.h"
 
 #include "common/rsgis-tqdm.h"
 #include "common/RSGISVectorException.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISStripIOPipeline.h"
 #include "vec/RSGISVectorOutputException.h"
 #include "vec/RSGISVectorUtils.h"
 
@@ -50,14 +54,36 @@
 
 namespace rsgis{namespace vec{
 	
+    enum RSGISPolygonCheckStatus
+    {
+        rsgis_polycheck_valid = 0,
+        rsgis_polycheck_repaired = 1,
+        rsgis_polycheck_unrepairable = 2,
+        rsgis_polycheck_badring = 3,
+        rsgis_polycheck_nullgeom = 4
+    };
+	
+    /**
+     * Copies the polygons of a layer to a new layer, closing the exterior rings and
+     * checking the validity of each polygon. Invalid polygons are repaired with
+     * MakeValid; features which cannot be repaired, are NULL or are not a polygon
+     * are dropped. Batches of features are read by one thread, checked in parallel
+     * by numThreads threads (0 uses all the available cores) and written in the
+     * input order, committing them in transactions.
+     */
 	class DllExport RSGISCopyCheckPolygons
 	{
 	public:
 		RSGISCopyCheckPolygons();
-		void copyCheckPolygons(OGRLayer *input, OGRLayer *output, bool printErrors);
+		void copyCheckPolygons(OGRLayer *input, OGRLayer *output, bool printErrors, unsigned int numThreads=1);
 		void copyFeatureDefn(OGRLayer *outputVecLayer, OGRFeatureDefn *inFeatureDefn);
 		void copyFeatureData(OGRFeature *inFeature, OGRFeature *outFeature, OGRFeatureDefn *inFeatureDefn, OGRFeatureDefn *outFeatureDefn);
 		~RSGISCopyCheckPolygons();
+    protected:
+        /** Check (and if needed repair) the geometry of a feature, returning the output geometry or NULL if the feature is dropped. */
+        OGRGeometry* checkPolygon(OGRFeature *inFeature, RSGISPolygonCheckStatus *status, std::string *errMsg);
+        static const unsigned int checkBatchSize = 1000;
+        static const unsigned int checkTransactionSize = 20000;
 	};
 	
 }}
@@ -0,0 +1,365 @@
+/*
+ *  RSGISCopyVecAtts2RATByOverlap.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISCopyVecAtts2RATByOverlap.h"
+
+namespace rsgis{namespace vec{
+
+    RSGISCopyVecAtts2RATByOverlap::RSGISCopyVecAtts2RATByOverlap()
+    {
+
+    }
+
+    void RSGISCopyVecAtts2RATByOverlap::copyVectorAtt2Rat(GDALDataset *clumpsImage, unsigned int ratBand, OGRLayer *vecLayer, std::vector<std::string> *colNames, float minPropOverlap, std::string outFIDCol)
+    {
+        try
+        {
+            if(ratBand == 0)
+            {
+                throw rsgis::RSGISAttributeTableException("RAT Band must be greater than zero.");
+            }
+            if(ratBand > clumpsImage->GetRasterCount())
+            {
+                throw rsgis::RSGISAttributeTableException("RAT Band is larger than the number of bands within the image.");
+            }
+
+            double *geoTransform = new double[6];
+            clumpsImage->GetGeoTransform(geoTransform);
+            if((geoTransform[2] != 0) || (geoTransform[4] != 0))
+            {
+                delete[] geoTransform;
+                throw rsgis::RSGISAttributeTableException("The clumps image cannot be rotated.");
+            }
+            unsigned int width = clumpsImage->GetRasterXSize();
+            unsigned int height = clumpsImage->GetRasterYSize();
+            RSGISPolygonScanlineRasteriser rasteriser(geoTransform, width, height);
+            delete[] geoTransform;
+
+            // Find the index and type of each of the columns.
+            OGRFeatureDefn *ogrFeatDef = vecLayer->GetLayerDefn();
+            std::vector<int> fieldIdxs;
+            std::vector<OGRFieldType> fieldTypes;
+            std::vector<size_t> fieldColIdxs;
+            unsigned int numIntCols = 0;
+            unsigned int numRealCols = 0;
+            unsigned int numStrCols = 0;
+            for(std::vector<std::string>::iterator iterColNames = colNames->begin(); iterColNames != colNames->end(); ++iterColNames)
+            {
+                int fieldIdx = ogrFeatDef->GetFieldIndex((*iterColNames).c_str());
+                if(fieldIdx < 0)
+                {
+                    throw RSGISAttributeTableException("The field '" + (*iterColNames) + "' is not within the vector layer.");
+                }
+                OGRFieldType fieldType = ogrFeatDef->GetFieldDefn(fieldIdx)->GetType();
+                if(fieldType == OFTInteger)
+                {
+                    fieldColIdxs.push_back(numIntCols++);
+                }
+                else if(fieldType == OFTReal)
+                {
+                    fieldColIdxs.push_back(numRealCols++);
+                }
+                else if(fieldType == OFTString)
+                {
+                    fieldColIdxs.push_back(numStrCols++);
+                }
+                else
+                {
+                    throw RSGISAttributeTableException("Data type could not be represented in RAT for field '" + (*iterColNames) + "'.");
+                }
+                fieldIdxs.push_back(fieldIdx);
+                fieldTypes.push_back(fieldType);
+            }
+
+            // Read the attributes and rasterise the polygons of every feature in a single pass of the layer.
+            std::cout << "Reading and rasterising the features\n";
+            std::vector< std::vector<int> > featIntVals(numIntCols);
+            std::vector< std::vector<double> > featRealVals(numRealCols);
+            std::vector< std::vector<std::string> > featStrVals(numStrCols);
+            std::vector<GIntBig> featFIDs;
+            // The feature of each polygon added to the rasteriser (a multi-polygon adds each part).
+            std::vector<unsigned int> polyFeatIdxs;
+            OGRFeature *feat = NULL;
+            vecLayer->ResetReading();
+            while( (feat = vecLayer->GetNextFeature()) != NULL )
+            {
+                unsigned int featIdx = featFIDs.size();
+                featFIDs.push_back(feat->GetFID());
+                for(size_t n = 0; n < fieldIdxs.size(); ++n)
+                {
+                    if(fieldTypes[n] == OFTInteger)
+                    {
+                        featIntVals[fieldColIdxs[n]].push_back(feat->GetFieldAsInteger(fieldIdxs[n]));
+                    }
+                    else if(fieldTypes[n] == OFTReal)
+                    {
+                        featRealVals[fieldColIdxs[n]].push_back(feat->GetFieldAsDouble(fieldIdxs[n]));
+                    }
+                    else
+                    {
+                        featStrVals[fieldColIdxs[n]].push_back(std::string(feat->GetFieldAsString(fieldIdxs[n])));
+                    }
+                }
+
+                OGRGeometry *geometry = feat->GetGeometryRef();
+                if((geometry != NULL) && (wkbFlatten(geometry->getGeometryType()) == wkbPolygon))
+                {
+                    rasteriser.addPolygon((OGRPolygon *) geometry);
+                    polyFeatIdxs.push_back(featIdx);
+                }
+                else if((geometry != NULL) && (wkbFlatten(geometry->getGeometryType()) == wkbMultiPolygon))
+                {
+                    OGRMultiPolygon *multiPoly = (OGRMultiPolygon *) geometry;
+                    for(int i = 0; i < multiPoly->getNumGeometries(); ++i)
+                    {
+                        rasteriser.addPolygon((OGRPolygon *) multiPoly->getGeometryRef(i));
+                        polyFeatIdxs.push_back(featIdx);
+                    }
+                }
+                else
+                {
+                    std::cout << "WARNING: NULL or non-polygon geometry present within input file - IGNORED\n";
+                }
+                OGRFeature::DestroyFeature(feat);
+            }
+            rasteriser.finalise();
+
+            // Read the clumps image in strips, counting the pixels of each clump and the number within each feature.
+            std::cout << "Calculating the overlap of the clumps and features\n";
+            GDALRasterBand *clumpsBand = clumpsImage->GetRasterBand(ratBand);
+            int xBlockSize = 0;
+            int yBlockSize = 0;
+            clumpsBand->GetBlockSize(&xBlockSize, &yBlockSize);
+            unsigned int stripRows = rsgis::RSGISExecutionContextUtils::calcStripRows(std::max(yBlockSize, 1), width, height, sizeof(unsigned int), rsgis::RSGISExecutionContextUtils::getDefaultContext().stripMemoryMB);
+
+            this->overlaps.clear();
+            std::vector<RSGISClumpFeatOverlap> stripOverlaps;
+            std::vector<size_t> clumpPxlCounts;
+            std::vector<unsigned int> stripVals;
+            rsgis_tqdm pbar;
+            for(unsigned int rowStart = 0; rowStart < height; rowStart += stripRows)
+            {
+                pbar.progress((int)((((size_t)rowStart) * 100) / height), 100);
+                unsigned int nStripRows = std::min(stripRows, height - rowStart);
+                stripVals.resize(((size_t)width) * nStripRows);
+                if(clumpsBand->RasterIO(GF_Read, 0, rowStart, width, nStripRows, stripVals.data(), width, nStripRows, GDT_UInt32, 0, 0) != CE_None)
+                {
+                    throw rsgis::RSGISAttributeTableException("Could not read the clumps image band.");
+                }
+
+                for(std::vector<unsigned int>::iterator iterVals = stripVals.begin(); iterVals != stripVals.end(); ++iterVals)
+                {
+                    if((*iterVals) >= clumpPxlCounts.size())
+                    {
+                        clumpPxlCounts.resize(((size_t)(*iterVals)) + 1, 0);
+                    }
+                    ++clumpPxlCounts[*iterVals];
+                }
+
+                for(unsigned int row = rowStart; row < (rowStart + nStripRows); ++row)
+                {
+                    size_t nSpans = 0;
+                    const RSGISPixelSpan *spans = rasteriser.getRowSpans(row, &nSpans);
+                    const unsigned int *rowVals = &stripVals[((size_t)(row - rowStart)) * width];
+                    for(size_t s = 0; s < nSpans; ++s)
+                    {
+                        // Record each run of pixels of the same clump within the span once.
+                        unsigned int featIdx = polyFeatIdxs[spans[s].featIdx];
+                        unsigned int x = spans[s].xStart;
+                        while(x < spans[s].xEnd)
+                        {
+                            unsigned int runStart = x;
+                            unsigned int clump = rowVals[x];
+                            while((x < spans[s].xEnd) && (rowVals[x] == clump))
+                            {
+                                ++x;
+                            }
+                            this->addOverlap(clump, featIdx, x - runStart, &stripOverlaps);
+                        }
+                    }
+                }
+
+                // Merge the overlaps of the strips once there are more than have been merged so the cost is amortised.
+                if(stripOverlaps.size() >= std::max<size_t>(this->overlaps.size(), 1048576))
+                {
+                    this->mergeOverlaps(&stripOverlaps);
+                }
+            }
+            this->mergeOverlaps(&stripOverlaps);
+            pbar.finish();
+
+            GDALRasterAttributeTable *rat = clumpsBand->GetDefaultRAT();
+            size_t numRows = rat->GetRowCount();
+            if(clumpPxlCounts.size() > numRows)
+            {
+                numRows = clumpPxlCounts.size();
+                rat->SetRowCount(numRows);
+            }
+
+            // Select the feature covering the most pixels of each clump (the first feature where they are equal).
+            const unsigned int noFeat = std::numeric_limits<unsigned int>::max();
+            std::vector<unsigned int> clumpFeatIdxs(numRows, noFeat);
+            std::vector<RSGISClumpFeatOverlap>::iterator iterOverlap = this->overlaps.begin();
+            while(iterOverlap != this->overlaps.end())
+            {
+                std::vector<RSGISClumpFeatOverlap>::iterator iterMax = iterOverlap;
+                size_t clump = (*iterOverlap).clump;
+                for(; (iterOverlap != this->overlaps.end()) && ((*iterOverlap).clump == clump); ++iterOverlap)
+                {
+                    if((*iterOverlap).numPxls > (*iterMax).numPxls)
+                    {
+                        iterMax = iterOverlap;
+                    }
+                }
+                if((((double)(*iterMax).numPxls) / ((double)clumpPxlCounts[clump])) >= minPropOverlap)
+                {
+                    clumpFeatIdxs[clump] = (*iterMax).featIdx;
+                }
+            }
+            this->overlaps.clear();
+
+            // Write the columns to the RAT.
+            std::cout << "Importing columns: \n";
+            rsgis::rastergis::RSGISRasterAttUtils ratUtils;
+            if(outFIDCol != "")
+            {
+                std::cout << outFIDCol << std::endl;
+                int *fidVals = new int[numRows];
+                for(size_t i = 0; i < numRows; ++i)
+                {
+                    fidVals[i] = (clumpFeatIdxs[i] == noFeat)?-1:((int)featFIDs[clumpFeatIdxs[i]]);
+                }
+                ratUtils.writeIntColumn(rat, outFIDCol, fidVals, numRows);
+                delete[] fidVals;
+            }
+            for(size_t n = 0; n < fieldIdxs.size(); ++n)
+            {
+                std::cout << colNames->at(n) << std::endl;
+                if(fieldTypes[n] == OFTInteger)
+                {
+                    std::vector<int> &vals = featIntVals[fieldColIdxs[n]];
+                    int *intDataVal = new int[numRows];
+                    for(size_t i = 0; i < numRows; ++i)
+                    {
+                        intDataVal[i] = (clumpFeatIdxs[i] == noFeat)?0:vals[clumpFeatIdxs[i]];
+                    }
+                    ratUtils.writeIntColumn(rat, colNames->at(n), intDataVal, numRows);
+                    delete[] intDataVal;
+                }
+                else if(fieldTypes[n] == OFTReal)
+                {
+                    std::vector<double> &vals = featRealVals[fieldColIdxs[n]];
+                    double *realDataVal = new double[numRows];
+                    for(size_t i = 0; i < numRows; ++i)
+                    {
+                        realDataVal[i] = (clumpFeatIdxs[i] == noFeat)?0:vals[clumpFeatIdxs[i]];
+                    }
+                    ratUtils.writeRealColumn(rat, colNames->at(n), realDataVal, numRows);
+                    delete[] realDataVal;
+                }
+                else
+                {
+                    std::vector<std::string> &vals = featStrVals[fieldColIdxs[n]];
+                    std::string *strDataVal = new std::string[numRows];
+                    for(size_t i = 0; i < numRows; ++i)
+                    {
+                        if(clumpFeatIdxs[i] != noFeat)
+                        {
+                            strDataVal[i] = vals[clumpFeatIdxs[i]];
+                        }
+                    }
+                    ratUtils.writeStrColumn(rat, colNames->at(n), strDataVal, numRows);
+                    delete[] strDataVal;
+                }
+            }
+        }
+        catch(rsgis::RSGISAttributeTableException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw rsgis::RSGISAttributeTableException(e.what());
+        }
+    }
+
+    void RSGISCopyVecAtts2RATByOverlap::addOverlap(size_t clump, unsigned int featIdx, size_t numPxls, std::vector<RSGISClumpFeatOverlap> *stripOverlaps)
+    {
+        if(clump == 0)
+        {
+            return;
+        }
+
+        // Consecutive runs of the same clump within the same feature are a single record.
+        if((!stripOverlaps->empty()) && (stripOverlaps->back().clump == clump) && (stripOverlaps->back().featIdx == featIdx))
+        {
+            stripOverlaps->back().numPxls += numPxls;
+        }
+        else
+        {
+            RSGISClumpFeatOverlap overlap;
+            overlap.clump = clump;
+            overlap.featIdx = featIdx;
+            overlap.numPxls = numPxls;
+            stripOverlaps->push_back(overlap);
+        }
+    }
+
+    static bool compareClumpFeatOverlaps(const RSGISClumpFeatOverlap &a, const RSGISClumpFeatOverlap &b)
+    {
+        return (a.clump < b.clump) || ((a.clump == b.clump) && (a.featIdx < b.featIdx));
+    }
+
+    void RSGISCopyVecAtts2RATByOverlap::mergeOverlaps(std::vector<RSGISClumpFeatOverlap> *stripOverlaps)
+    {
+        if(stripOverlaps->empty())
+        {
+            return;
+        }
+
+        std::vector<RSGISClumpFeatOverlap> mergedOverlaps;
+        mergedOverlaps.reserve(this->overlaps.size() + stripOverlaps->size());
+        std::sort(stripOverlaps->begin(), stripOverlaps->end(), compareClumpFeatOverlaps);
+        std::merge(this->overlaps.begin(), this->overlaps.end(), stripOverlaps->begin(), stripOverlaps->end(), std::back_inserter(mergedOverlaps), compareClumpFeatOverlaps);
+
+        // Sum the pixels of the records of the same clump and feature.
+        this->overlaps.clear();
+        for(std::vector<RSGISClumpFeatOverlap>::iterator iterOverlap = mergedOverlaps.begin(); iterOverlap != mergedOverlaps.end(); ++iterOverlap)
+        {
+            if((!this->overlaps.empty()) && (this->overlaps.back().clump == (*iterOverlap).clump) && (this->overlaps.back().featIdx == (*iterOverlap).featIdx))
+            {
+                this->overlaps.back().numPxls += (*iterOverlap).numPxls;
+            }
+            else
+            {
+                this->overlaps.push_back(*iterOverlap);
+            }
+        }
+        stripOverlaps->clear();
+    }
+
+    RSGISCopyVecAtts2RATByOverlap::~RSGISCopyVecAtts2RATByOverlap()
+    {
+
+    }
+
+}}
@@ -0,0 +1,100 @@
+/*
+ *  RSGISCopyVecAtts2RATByOverlap.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISCopyVecAtts2RATByOverlap_H
+#define RSGISCopyVecAtts2RATByOverlap_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <iterator>
+
+#include "gdal_priv.h"
+#include "ogrsf_frmts.h"
+
+#include "common/RSGISVectorException.h"
+#include "common/RSGISAttributeTableException.h"
+#include "common/RSGISExecutionContext.h"
+#include "common/rsgis-tqdm.h"
+
+#include "vec/RSGISPolygonScanlineRasteriser.h"
+
+#include "rastergis/RSGISRasterAttUtils.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_vec_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace vec{
+
+    /** The number of pixels of the clump which are within the feature featIdx. */
+    struct DllExport RSGISClumpFeatOverlap
+    {
+        size_t clump;
+        unsigned int featIdx;
+        size_t numPxls;
+    };
+
+    /**
+     * Copies the attributes of polygon features to the RAT of a clumps image where
+     * the features do not have a column of clump IDs (see
+     * rsgis::rastergis::RSGISInputShapefileAttributes2RAT). The polygons are
+     * rasterised once on to the grid of the clumps image (see
+     * RSGISPolygonScanlineRasteriser), the clumps image is read once, in strips, to
+     * count the pixels of each clump within each feature and each clump takes the
+     * attributes of the feature which covers most of its pixels. The attributes
+     * are read with a single pass of the layer and each column is written to the
+     * RAT in blocks.
+     */
+    class DllExport RSGISCopyVecAtts2RATByOverlap
+    {
+    public:
+        RSGISCopyVecAtts2RATByOverlap();
+        /**
+         * Copy the columns (colNames) of the features to the RAT. A clump is only given
+         * the attributes of a feature if the feature covers at least minPropOverlap (0-1)
+         * of the clump's pixels; clumps which are not given a feature have the value 0
+         * (or an empty string). If outFIDCol is not empty then the FID of the feature
+         * (or -1) is written to that column.
+         */
+        void copyVectorAtt2Rat(GDALDataset *clumpsImage, unsigned int ratBand, OGRLayer *vecLayer, std::vector<std::string> *colNames, float minPropOverlap=0.0, std::string outFIDCol="");
+        ~RSGISCopyVecAtts2RATByOverlap();
+    protected:
+        void addOverlap(size_t clump, unsigned int featIdx, size_t numPxls, std::vector<RSGISClumpFeatOverlap> *stripOverlaps);
+        void mergeOverlaps(std::vector<RSGISClumpFeatOverlap> *stripOverlaps);
+        std::vector<RSGISClumpFeatOverlap> overlaps;
+    };
+
+}}
+
+#endif
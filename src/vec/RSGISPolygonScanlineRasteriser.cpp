@@ -0,0 +1,255 @@
+/*
+ *  RSGISPolygonScanlineRasteriser.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISPolygonScanlineRasteriser.h"
+
+namespace rsgis{namespace vec{
+
+    RSGISPolygonScanlineRasteriser::RSGISPolygonScanlineRasteriser(double *geoTransform, unsigned int xSize, unsigned int ySize)
+    {
+        if((geoTransform[2] != 0) || (geoTransform[4] != 0))
+        {
+            throw RSGISVectorException("Polygons cannot be rasterised on to a rotated image.");
+        }
+        if((geoTransform[1] == 0) || (geoTransform[5] == 0))
+        {
+            throw RSGISVectorException("The image pixel size cannot be zero.");
+        }
+        this->tlX = geoTransform[0];
+        this->tlY = geoTransform[3];
+        this->pxlWidth = geoTransform[1];
+        this->pxlHeight = geoTransform[5];
+        this->xSize = xSize;
+        this->ySize = ySize;
+        this->finalised = false;
+        this->totalNumPxls = 0;
+    }
+
+    void RSGISPolygonScanlineRasteriser::addRingEdges(OGRLinearRing *ring, std::vector<RSGISScanlineEdge> *edges)
+    {
+        int nPts = ring->getNumPoints();
+        if(nPts < 3)
+        {
+            return;
+        }
+
+        RSGISScanlineEdge edge;
+        for(int i = 0; i < nPts; ++i)
+        {
+            // The ring is closed with the first point if it is not already.
+            int j = (i + 1) % nPts;
+            if((i == (nPts - 1)) && (ring->getX(i) == ring->getX(0)) && (ring->getY(i) == ring->getY(0)))
+            {
+                break;
+            }
+
+            // Pixel coordinates, with y increasing down the image.
+            double x1 = (ring->getX(i) - this->tlX) / this->pxlWidth;
+            double y1 = (ring->getY(i) - this->tlY) / this->pxlHeight;
+            double x2 = (ring->getX(j) - this->tlX) / this->pxlWidth;
+            double y2 = (ring->getY(j) - this->tlY) / this->pxlHeight;
+
+            if(y1 == y2)
+            {
+                // Horizontal edges never cross a scanline.
+                continue;
+            }
+            else if(y1 < y2)
+            {
+                edge.yMin = y1;
+                edge.yMax = y2;
+                edge.xAtYMin = x1;
+            }
+            else
+            {
+                edge.yMin = y2;
+                edge.yMax = y1;
+                edge.xAtYMin = x2;
+            }
+            edge.dxdy = (x2 - x1) / (y2 - y1);
+            edges->push_back(edge);
+        }
+    }
+
+    unsigned int RSGISPolygonScanlineRasteriser::addPolygon(OGRPolygon *poly)
+    {
+        if(this->finalised)
+        {
+            throw RSGISVectorException("Polygons cannot be added once the rasteriser has been finalised.");
+        }
+
+        unsigned int featIdx = this->numFeatPxls.size();
+        size_t numPxls = 0;
+
+        std::vector<RSGISScanlineEdge> edges;
+        OGRLinearRing *extRing = poly->getExteriorRing();
+        if(extRing != NULL)
+        {
+            this->addRingEdges(extRing, &edges);
+        }
+        for(int n = 0; n < poly->getNumInteriorRings(); ++n)
+        {
+            this->addRingEdges(poly->getInteriorRing(n), &edges);
+        }
+
+        if(!edges.empty())
+        {
+            std::sort(edges.begin(), edges.end(), [](const RSGISScanlineEdge &a, const RSGISScanlineEdge &b){return a.yMin < b.yMin;});
+            double yMinAll = edges.front().yMin;
+            double yMaxAll = edges.front().yMax;
+            for(std::vector<RSGISScanlineEdge>::iterator iterEdge = edges.begin(); iterEdge != edges.end(); ++iterEdge)
+            {
+                yMaxAll = std::max(yMaxAll, (*iterEdge).yMax);
+            }
+
+            // Rows whose pixel centres are within the polygon's y range.
+            double firstRow = std::max(std::ceil(yMinAll - 0.5), 0.0);
+            double endRow = std::min(std::floor(yMaxAll - 0.5) + 1, (double)this->ySize);
+
+            std::vector<size_t> activeEdges;
+            std::vector<double> xCrossings;
+            size_t nextEdge = 0;
+            RSGISPixelSpan span;
+            span.featIdx = featIdx;
+            for(double row = firstRow; row < endRow; row += 1)
+            {
+                double yCentre = row + 0.5;
+                while((nextEdge < edges.size()) && (edges[nextEdge].yMin <= yCentre))
+                {
+                    activeEdges.push_back(nextEdge++);
+                }
+
+                // An edge crosses the scanline if yMin <= yCentre < yMax.
+                xCrossings.clear();
+                size_t nActive = 0;
+                for(size_t i = 0; i < activeEdges.size(); ++i)
+                {
+                    RSGISScanlineEdge *edge = &edges[activeEdges[i]];
+                    if(edge->yMax > yCentre)
+                    {
+                        activeEdges[nActive++] = activeEdges[i];
+                        xCrossings.push_back(edge->xAtYMin + ((yCentre - edge->yMin) * edge->dxdy));
+                    }
+                }
+                activeEdges.resize(nActive);
+                std::sort(xCrossings.begin(), xCrossings.end());
+
+                // Pixels with centres in [xCrossings[k], xCrossings[k+1]) are inside.
+                for(size_t k = 0; (k + 1) < xCrossings.size(); k += 2)
+                {
+                    double xStart = std::max(std::ceil(xCrossings[k] - 0.5), 0.0);
+                    double xEnd = std::min(std::ceil(xCrossings[k+1] - 0.5), (double)this->xSize);
+                    if(xEnd > xStart)
+                    {
+                        span.xStart = (unsigned int)xStart;
+                        span.xEnd = (unsigned int)xEnd;
+                        this->addedSpanRows.push_back((unsigned int)row);
+                        this->addedSpans.push_back(span);
+                        numPxls += span.xEnd - span.xStart;
+                    }
+                }
+            }
+        }
+
+        this->numFeatPxls.push_back(numPxls);
+        this->totalNumPxls += numPxls;
+        return featIdx;
+    }
+
+    void RSGISPolygonScanlineRasteriser::finalise()
+    {
+        if(this->finalised)
+        {
+            return;
+        }
+
+        // Counting sort of the spans by row, which keeps them in feature order within a row.
+        this->rowSpanIdx.assign(((size_t)this->ySize) + 1, 0);
+        for(std::vector<unsigned int>::iterator iterRow = this->addedSpanRows.begin(); iterRow != this->addedSpanRows.end(); ++iterRow)
+        {
+            ++this->rowSpanIdx[(*iterRow) + 1];
+        }
+        for(size_t i = 1; i < this->rowSpanIdx.size(); ++i)
+        {
+            this->rowSpanIdx[i] += this->rowSpanIdx[i-1];
+        }
+
+        std::vector<size_t> rowNext(this->rowSpanIdx.begin(), this->rowSpanIdx.end() - 1);
+        this->spans.resize(this->addedSpans.size());
+        for(size_t i = 0; i < this->addedSpans.size(); ++i)
+        {
+            this->spans[rowNext[this->addedSpanRows[i]]++] = this->addedSpans[i];
+        }
+
+        std::vector<unsigned int>().swap(this->addedSpanRows);
+        std::vector<RSGISPixelSpan>().swap(this->addedSpans);
+        this->finalised = true;
+    }
+
+    const RSGISPixelSpan* RSGISPolygonScanlineRasteriser::getRowSpans(unsigned int row, size_t *nSpans)
+    {
+        if(!this->finalised)
+        {
+            throw RSGISVectorException("The rasteriser must be finalised before the spans are retrieved.");
+        }
+        if(row >= this->ySize)
+        {
+            throw RSGISVectorException("Row is not within the image.");
+        }
+        *nSpans = this->rowSpanIdx[row+1] - this->rowSpanIdx[row];
+        if(*nSpans == 0)
+        {
+            return NULL;
+        }
+        return &this->spans[this->rowSpanIdx[row]];
+    }
+
+    bool RSGISPolygonScanlineRasteriser::getSpansXRange(unsigned int rowStart, unsigned int rowEnd, unsigned int *xMin, unsigned int *xMax)
+    {
+        if(!this->finalised)
+        {
+            throw RSGISVectorException("The rasteriser must be finalised before the spans are retrieved.");
+        }
+        rowEnd = std::min(rowEnd, this->ySize);
+        if(rowStart >= rowEnd)
+        {
+            return false;
+        }
+
+        size_t startIdx = this->rowSpanIdx[rowStart];
+        size_t endIdx = this->rowSpanIdx[rowEnd];
+        if(startIdx == endIdx)
+        {
+            return false;
+        }
+
+        *xMin = this->xSize;
+        *xMax = 0;
+        for(size_t i = startIdx; i < endIdx; ++i)
+        {
+            *xMin = std::min(*xMin, this->spans[i].xStart);
+            *xMax = std::max(*xMax, this->spans[i].xEnd);
+        }
+        return true;
+    }
+
+}}
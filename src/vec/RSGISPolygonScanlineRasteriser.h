@@ -0,0 +1,113 @@
+/*
+ *  RSGISPolygonScanlineRasteriser.h
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISPolygonScanlineRasteriser_H
+#define RSGISPolygonScanlineRasteriser_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "ogrsf_frmts.h"
+
+#include "common/RSGISVectorException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_vec_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace vec{
+
+    /**
+     * A run of pixels (xStart to xEnd, exclusive) on a row of the image
+     * which are within the feature featIdx.
+     */
+    struct DllExport RSGISPixelSpan
+    {
+        unsigned int xStart;
+        unsigned int xEnd;
+        unsigned int featIdx;
+    };
+
+    /**
+     * Burns polygons on to the pixel grid of an image using scanline polygon
+     * filling, a pixel is within a polygon if its centre is inside the polygon
+     * (even-odd rule over the exterior and interior rings). Rather than writing
+     * a FID image the runs of pixels for each feature are stored by row, so the
+     * image can be read once, in strips, to extract the pixels of every feature
+     * and features which overlap each keep all their pixels.
+     */
+    class DllExport RSGISPolygonScanlineRasteriser
+    {
+    public:
+        /** The geoTransform is the GDAL transformation (6 values) of the image, which cannot be rotated. */
+        RSGISPolygonScanlineRasteriser(double *geoTransform, unsigned int xSize, unsigned int ySize);
+        /** Add a polygon, returning its feature index (the number of features previously added). */
+        unsigned int addPolygon(OGRPolygon *poly);
+        /** Sort the spans by row. Must be called after all the polygons have been added. */
+        void finalise();
+        unsigned int getNumFeatures(){return this->numFeatPxls.size();};
+        size_t getNumFeaturePxls(unsigned int featIdx){return this->numFeatPxls.at(featIdx);};
+        size_t getTotalNumPxls(){return this->totalNumPxls;};
+        /** Get the spans for a row of the image, ordered by feature and then x. */
+        const RSGISPixelSpan* getRowSpans(unsigned int row, size_t *nSpans);
+        /** Get the range of columns (xMax exclusive) used by the spans within the rows; returns false if there are no spans. */
+        bool getSpansXRange(unsigned int rowStart, unsigned int rowEnd, unsigned int *xMin, unsigned int *xMax);
+        ~RSGISPolygonScanlineRasteriser(){};
+    protected:
+        struct RSGISScanlineEdge
+        {
+            double yMin;
+            double yMax;
+            double xAtYMin;
+            double dxdy;
+        };
+        void addRingEdges(OGRLinearRing *ring, std::vector<RSGISScanlineEdge> *edges);
+        double tlX;
+        double tlY;
+        double pxlWidth;
+        double pxlHeight;
+        unsigned int xSize;
+        unsigned int ySize;
+        bool finalised;
+        size_t totalNumPxls;
+        std::vector<size_t> numFeatPxls;
+        std::vector<unsigned int> addedSpanRows;
+        std::vector<RSGISPixelSpan> addedSpans;
+        std::vector<size_t> rowSpanIdx;
+        std::vector<RSGISPixelSpan> spans;
+    };
+
+}}
+
+#endif
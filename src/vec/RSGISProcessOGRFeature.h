@@ -55,6 +55,23 @@ namespace rsgis{namespace vec{
 			virtual void processFeature(OGRFeature *inFeature, OGRFeature *outFeature, OGREnvelope *env, long fid)= 0;
 			virtual void processFeature(OGRFeature *feature, OGREnvelope *env, long fid)= 0;
 			virtual void createOutputLayerDefinition(OGRLayer *outputLayer, OGRFeatureDefn *inFeatureDefn) = 0;
+            /**
+             * Create an independent copy of this object which can process features on
+             * another thread at the same time as this object. It is called after
+             * createOutputLayerDefinition. Return NULL (the default) if the features
+             * cannot be processed in parallel (e.g., values are accumulated across features).
+             */
+            virtual RSGISProcessOGRFeature* clone(){return NULL;};
+            /**
+             * Process a batch of features in one call (e.g., reading the fields of the
+             * features into columns so they are calculated together), where outFeatures
+             * is NULL if the input features are updated in place. The features all have a
+             * geometry. Only called if supportsFeatureBatches returns true; return false
+             * to process the batch with processFeature instead.
+             */
+            virtual bool processFeatureBatch(OGRFeature **inFeatures, OGRFeature **outFeatures, size_t nFeats){return false;};
+            /** Return true if processFeatureBatch is implemented, so the batched processing is used even with a single thread. */
+            virtual bool supportsFeatureBatches(){return false;};
 			virtual ~RSGISProcessOGRFeature(){};
 		};
 }}
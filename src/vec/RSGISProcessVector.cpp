@@ -24,10 +24,40 @@
 #include "RSGISProcessVector.h"
 
 namespace rsgis{namespace vec{
+    
+    /// A batch of features passed through the processing pipeline.
+    struct RSGISOGRFeatureBatch
+    {
+        std::vector<OGRFeature*> inFeatures;
+        std::vector<OGRFeature*> outFeatures;
+        std::vector<char> nullGeometry;
+        
+        void clear()
+        {
+            for(size_t i = 0; i < this->inFeatures.size(); ++i)
+            {
+                if(this->inFeatures[i] != NULL)
+                {
+                    OGRFeature::DestroyFeature(this->inFeatures[i]);
+                }
+            }
+            for(size_t i = 0; i < this->outFeatures.size(); ++i)
+            {
+                if(this->outFeatures[i] != NULL)
+                {
+                    OGRFeature::DestroyFeature(this->outFeatures[i]);
+                }
+            }
+            this->inFeatures.clear();
+            this->outFeatures.clear();
+            this->nullGeometry.clear();
+        }
+    };
 	
-	RSGISProcessVector::RSGISProcessVector(RSGISProcessOGRFeature *processFeatures)
+	RSGISProcessVector::RSGISProcessVector(RSGISProcessOGRFeature *processFeatures, unsigned int numThreads)
 	{
 		this->processFeatures = processFeatures;
+        this->numThreads = numThreads;
 	}
 	
 	void RSGISProcessVector::processVectors(OGRLayer *inputLayer, OGRLayer *outputVecLayer, bool copyData, bool outVertical, bool newFirst)
@@ -56,6 +86,13 @@ namespace rsgis{namespace vec{
 			this->processFeatures->createOutputLayerDefinition(outputVecLayer, inFeatureDefn);
 			
 			outFeatureDefn = outputVecLayer->GetLayerDefn();
+            
+            std::vector<RSGISProcessOGRFeature*> processors;
+            if(this->createFeatureProcessors(&processors))
+            {
+                this->processVectorsPipeline(inputLayer, outputVecLayer, copyData, &processors);
+                return;
+            }
 			
 			int numFeatures = inputLayer->GetFeatureCount(TRUE);
 			
@@ -200,6 +237,13 @@ namespace rsgis{namespace vec{
 		try
 		{
 			inFeatureDefn = inputLayer->GetLayerDefn();
+            
+            std::vector<RSGISProcessOGRFeature*> processors;
+            if(this->createFeatureProcessors(&processors))
+            {
+                this->processVectorsPipeline(inputLayer, NULL, false, &processors);
+                return;
+            }
 			
 			int numFeatures = inputLayer->GetFeatureCount(TRUE);
 			
@@ -547,6 +591,289 @@ namespace rsgis{namespace vec{
         std::cout << std::endl;
     }
     
+    bool RSGISProcessVector::createFeatureProcessors(std::vector<RSGISProcessOGRFeature*> *processors)
+    {
+        unsigned int nThreads = this->numThreads;
+        if(nThreads == 0)
+        {
+            nThreads = rsgis::RSGISThreadPool::getNumHardwareThreads();
+        }
+        if(nThreads < 2)
+        {
+            if(this->processFeatures->supportsFeatureBatches())
+            {
+                // Use the pipeline with a single thread so the features are processed in batches.
+                processors->push_back(this->processFeatures);
+                return true;
+            }
+            return false;
+        }
+        
+        processors->push_back(this->processFeatures);
+        for(unsigned int i = 1; i < nThreads; ++i)
+        {
+            RSGISProcessOGRFeature *processor = this->processFeatures->clone();
+            if(processor == NULL)
+            {
+                // The processor cannot be used in parallel so process the features serially.
+                for(unsigned int j = 1; j < processors->size(); ++j)
+                {
+                    delete processors->at(j);
+                }
+                processors->clear();
+                return false;
+            }
+            processors->push_back(processor);
+        }
+        return true;
+    }
+    
+    OGREnvelope* RSGISProcessVector::getFeatureEnvelope(OGRFeature *inFeature, OGRFeature *outFeature)
+    {
+        RSGISVectorUtils vecUtils;
+        OGREnvelope *env = NULL;
+        OGRGeometry *geometry = inFeature->GetGeometryRef();
+        if( geometry != NULL && ((wkbFlatten(geometry->getGeometryType()) == wkbPolygon) ||
+                                 (wkbFlatten(geometry->getGeometryType()) == wkbMultiPolygon) ||
+                                 (wkbFlatten(geometry->getGeometryType()) == wkbPoint) ||
+                                 (wkbFlatten(geometry->getGeometryType()) == wkbLineString)) )
+        {
+            if(outFeature != NULL)
+            {
+                outFeature->SetGeometry(geometry);
+            }
+            env = vecUtils.getEnvelope(geometry);
+        }
+        else if(geometry != NULL)
+        {
+            std::string message = std::string("Unsupport data type: ") + std::string(geometry->getGeometryName());
+            throw RSGISVectorException(message);
+        }
+        return env;
+    }
+    
+    void RSGISProcessVector::processVectorsPipeline(OGRLayer *inputLayer, OGRLayer *outputVecLayer, bool copyData, std::vector<RSGISProcessOGRFeature*> *processors)
+    {
+        // Without an output layer the input features are processed and updated in place.
+        bool inPlace = (outputVecLayer == NULL);
+        OGRLayer *writeLayer = inPlace?inputLayer:outputVecLayer;
+        OGRFeatureDefn *inFeatureDefn = inputLayer->GetLayerDefn();
+        OGRFeatureDefn *outFeatureDefn = inPlace?NULL:outputVecLayer->GetLayerDefn();
+        
+        GIntBig layerFeatCount = inputLayer->GetFeatureCount(TRUE);
+        size_t numFeatures = (layerFeatCount > 0)?layerFeatCount:0;
+        // The last batch reads all the remaining features in case the count was not exact.
+        size_t nBatches = std::max<size_t>((numFeatures + pipelineBatchSize - 1) / pipelineBatchSize, 1);
+        
+        const unsigned int numBuffers = 3;
+        std::vector<RSGISOGRFeatureBatch> batches(numBuffers);
+        // Reading and writing the same layer cannot happen at the same time.
+        std::mutex layerMutex;
+        bool inTransaction = false;
+        size_t nWritten = 0;
+        
+        rsgis::RSGISThreadPool threadPool(processors->size());
+        rsgis::RSGISStripIOPipeline pipeline(numBuffers);
+        std::cout << "Started, " << numFeatures << " features to process using " << threadPool.getNumThreads() << " threads.\n";
+        rsgis_tqdm pbar;
+        
+        try
+        {
+            inputLayer->ResetReading();
+            pipeline.run(nBatches, [&](size_t b, unsigned int buf)
+            {
+                RSGISOGRFeatureBatch *batch = &batches[buf];
+                batch->clear();
+                std::unique_lock<std::mutex> lock(layerMutex, std::defer_lock);
+                if(inPlace)
+                {
+                    lock.lock();
+                }
+                bool lastBatch = (b == (nBatches - 1));
+                OGRFeature *inFeature = NULL;
+                while((lastBatch || (batch->inFeatures.size() < pipelineBatchSize)) && ((inFeature = inputLayer->GetNextFeature()) != NULL))
+                {
+                    batch->inFeatures.push_back(inFeature);
+                }
+                batch->outFeatures.assign(batch->inFeatures.size(), NULL);
+                batch->nullGeometry.assign(batch->inFeatures.size(), 0);
+            },
+            [&](size_t b, unsigned int buf)
+            {
+                RSGISOGRFeatureBatch *batch = &batches[buf];
+                threadPool.parallelFor(0, batch->inFeatures.size(), [&](unsigned int t, size_t start, size_t end)
+                {
+                    RSGISProcessOGRFeature *processor = processors->at(t);
+                    bool useFeatBatch = processor->supportsFeatureBatches();
+                    std::vector<OGRFeature*> featBatchIn;
+                    std::vector<OGRFeature*> featBatchOut;
+                    for(size_t i = start; i < end; ++i)
+                    {
+                        OGRFeature *inFeature = batch->inFeatures[i];
+                        long fid = inFeature->GetFID();
+                        OGRFeature *outFeature = NULL;
+                        if(!inPlace)
+                        {
+                            outFeature = OGRFeature::CreateFeature(outFeatureDefn);
+                            batch->outFeatures[i] = outFeature;
+                        }
+                        
+                        OGREnvelope *env = this->getFeatureEnvelope(inFeature, outFeature);
+                        if(env == NULL)
+                        {
+                            batch->nullGeometry[i] = 1;
+                            continue;
+                        }
+                        
+                        if(useFeatBatch)
+                        {
+                            // The features of the thread are processed together below.
+                            delete env;
+                            featBatchIn.push_back(inFeature);
+                            featBatchOut.push_back(outFeature);
+                            continue;
+                        }
+                        
+                        try
+                        {
+                            if(inPlace)
+                            {
+                                processor->processFeature(inFeature, env, fid);
+                            }
+                            else
+                            {
+                                processor->processFeature(inFeature, outFeature, env, fid);
+                                outFeature->SetFID(fid);
+                                if(copyData)
+                                {
+                                    this->copyFeatureData(inFeature, outFeature, inFeatureDefn, outFeatureDefn);
+                                }
+                            }
+                        }
+                        catch(...)
+                        {
+                            delete env;
+                            throw;
+                        }
+                        delete env;
+                    }
+                    
+                    if(featBatchIn.empty())
+                    {
+                        return;
+                    }
+                    if(!processor->processFeatureBatch(featBatchIn.data(), inPlace?NULL:featBatchOut.data(), featBatchIn.size()))
+                    {
+                        for(size_t i = 0; i < featBatchIn.size(); ++i)
+                        {
+                            OGREnvelope *env = this->getFeatureEnvelope(featBatchIn[i], NULL);
+                            try
+                            {
+                                if(inPlace)
+                                {
+                                    processor->processFeature(featBatchIn[i], env, featBatchIn[i]->GetFID());
+                                }
+                                else
+                                {
+                                    processor->processFeature(featBatchIn[i], featBatchOut[i], env, featBatchIn[i]->GetFID());
+                                }
+                            }
+                            catch(...)
+                            {
+                                delete env;
+                                throw;
+                            }
+                            delete env;
+                        }
+                    }
+                    if(!inPlace)
+                    {
+                        for(size_t i = 0; i < featBatchIn.size(); ++i)
+                        {
+                            featBatchOut[i]->SetFID(featBatchIn[i]->GetFID());
+                            if(copyData)
+                            {
+                                this->copyFeatureData(featBatchIn[i], featBatchOut[i], inFeatureDefn, outFeatureDefn);
+                            }
+                        }
+                    }
+                });
+            },
+            [&](size_t b, unsigned int buf)
+            {
+                RSGISOGRFeatureBatch *batch = &batches[buf];
+                std::unique_lock<std::mutex> lock(layerMutex, std::defer_lock);
+                if(inPlace)
+                {
+                    lock.lock();
+                }
+                for(size_t i = 0; i < batch->inFeatures.size(); ++i)
+                {
+                    if(!inTransaction)
+                    {
+                        writeLayer->StartTransaction();
+                        inTransaction = true;
+                    }
+                    
+                    if(batch->nullGeometry[i])
+                    {
+                        std::cout << "WARNING: NULL Geometry Present within input file - IGNORED\n";
+                    }
+                    else if(inPlace)
+                    {
+                        if( writeLayer->SetFeature(batch->inFeatures[i]) != OGRERR_NONE )
+                        {
+                            throw RSGISVectorOutputException("Failed to write feature to the vector layer.");
+                        }
+                    }
+                    else if( writeLayer->CreateFeature(batch->outFeatures[i]) != OGRERR_NONE )
+                    {
+                        throw RSGISVectorOutputException("Failed to write feature to the output shapefile.");
+                    }
+                    
+                    ++nWritten;
+                    if(((nWritten % pipelineTransactionSize) == 0) && inTransaction)
+                    {
+                        writeLayer->CommitTransaction();
+                        inTransaction = false;
+                    }
+                }
+                batch->clear();
+                if(numFeatures > 0)
+                {
+                    pbar.progress((int)((std::min(nWritten, numFeatures) * 100) / numFeatures), 100);
+                }
+            });
+            
+            if(inTransaction)
+            {
+                writeLayer->CommitTransaction();
+                inTransaction = false;
+            }
+            pbar.finish();
+        }
+        catch(...)
+        {
+            for(size_t i = 0; i < batches.size(); ++i)
+            {
+                batches[i].clear();
+            }
+            for(unsigned int j = 1; j < processors->size(); ++j)
+            {
+                delete processors->at(j);
+            }
+            processors->clear();
+            throw;
+        }
+        
+        for(unsigned int j = 1; j < processors->size(); ++j)
+        {
+            delete processors->at(j);
+        }
+        processors->clear();
+        std::cout << " Complete.\n";
+    }
+    
 	RSGISProcessVector::~RSGISProcessVector()
 	{
 		
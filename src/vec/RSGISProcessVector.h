@@ -27,11 +27,16 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <mutex>
+#include <algorithm>
 
 #include "ogrsf_frmts.h"
 
 #include "common/rsgis-tqdm.h"
 #include "common/RSGISVectorException.h"
+#include "common/RSGISThreadPool.h"
+#include "common/RSGISStripIOPipeline.h"
 
 #include "math/RSGISMathsUtils.h"
 
@@ -54,10 +59,18 @@
 
 namespace rsgis{namespace vec{
 	
+    /**
+     * Applies a RSGISProcessOGRFeature to each of the features of a layer. If
+     * numThreads is not 1 (0 uses all the available cores) and the processor can be
+     * cloned, processVectors runs as a pipeline: a reader thread fetches batches of
+     * features, the features of a batch are processed in parallel by clones of the
+     * processor and a writer thread writes the batches in order, committing them in
+     * transactions. The output layer must not belong to the input dataset.
+     */
 	class DllExport RSGISProcessVector
 		{
 		public:
-			RSGISProcessVector(RSGISProcessOGRFeature *processFeatures);
+			RSGISProcessVector(RSGISProcessOGRFeature *processFeatures, unsigned int numThreads=1);
 			void processVectors(OGRLayer *inputLayer, OGRLayer *outputVecLayer, bool copyData, bool outVertical, bool newFirst);
 			void processVectors(OGRLayer *inputLayer, bool outVertical, bool morefeedback=false);
 			void processVectorsNoOutput(OGRLayer *inputLayer, bool outVertical);
@@ -67,7 +80,13 @@ namespace rsgis{namespace vec{
 			void copyFeatureData(OGRFeature *inFeature, OGRFeature *outFeature, OGRFeatureDefn *inFeatureDefn, OGRFeatureDefn *outFeatureDefn);
             void printGeometry(OGRGeometry *geometry);
             void printRing(OGRLinearRing *inGeomRing);
+            bool createFeatureProcessors(std::vector<RSGISProcessOGRFeature*> *processors);
+            void processVectorsPipeline(OGRLayer *inputLayer, OGRLayer *outputVecLayer, bool copyData, std::vector<RSGISProcessOGRFeature*> *processors);
+            OGREnvelope* getFeatureEnvelope(OGRFeature *inFeature, OGRFeature *outFeature);
 			RSGISProcessOGRFeature *processFeatures;
+            unsigned int numThreads;
+            static const unsigned int pipelineBatchSize = 1000;
+            static const unsigned int pipelineTransactionSize = 20000;
 		};
 }}
 
@@ -22,6 +22,7 @@
  */
 
 #include "RSGISVectorIO.h"
+#include "common/RSGISGDALInit.h"
 
 namespace rsgis{namespace vec{
 
@@ -42,7 +43,7 @@ namespace rsgis{namespace vec{
             throw RSGISVectorOutputException("Coordinate lists are different sizes.");
         }
 
-        OGRRegisterAll();
+        rsgis::RSGISGDALInit::init();
         RSGISVectorUtils vecUtils;
         rsgis::utils::RSGISFileUtils fileUtils;
 
@@ -135,22 +136,15 @@ namespace rsgis{namespace vec{
 	{
 		try
 		{			
-			OGRFeatureDefn *outputDefn = outLayer->GetLayerDefn();
-			OGRFeature *featureOutput = NULL;
+			rsgis::utils::RSGISOGRFeatureSink featSink(outLayer);
 			
 			// Write Polygons to file
 			std::list<OGRPolygon*>::iterator iterPolys;
 			for(iterPolys = polys->begin(); iterPolys != polys->end(); iterPolys++)
 			{
-				featureOutput = OGRFeature::CreateFeature(outputDefn);
-				featureOutput->SetGeometryDirectly(*iterPolys);
-				
-				if( outLayer->CreateFeature(featureOutput) != OGRERR_NONE )
-				{
-					throw RSGISVectorOutputException("Failed to write feature to the output shapefile.");
-				}
-				OGRFeature::DestroyFeature(featureOutput);
+				featSink.writeGeometryDirectly(*iterPolys);
 			}
+			featSink.close();
 		}
 		catch(RSGISException &e)
 		{
@@ -162,8 +156,7 @@ namespace rsgis{namespace vec{
     {
         try
         {
-            OGRFeatureDefn *outputDefn = outLayer->GetLayerDefn();
-            OGRFeature *featureOutput = NULL;
+            rsgis::utils::RSGISOGRFeatureSink featSink(outLayer);
             
             // Write Polygons to layer
             if(pts->size() > 0)
@@ -172,17 +165,11 @@ namespace rsgis{namespace vec{
                 {
                     if((*iterPts) != NULL)
                     {
-                        featureOutput = OGRFeature::CreateFeature(outputDefn);
-                        featureOutput->SetGeometryDirectly(*iterPts);
-                        
-                        if( outLayer->CreateFeature(featureOutput) != OGRERR_NONE )
-                        {
-                            throw RSGISVectorOutputException("Failed to write feature to the output shapefile.");
-                        }
-                        OGRFeature::DestroyFeature(featureOutput);
+                        featSink.writeGeometryDirectly(*iterPts);
                     }
                 }
             }
+            featSink.close();
         }
         catch(RSGISException &e)
         {
@@ -34,6 +34,7 @@
 #include "common/RSGISVectorException.h"
 #include "vec/RSGISVectorOutputException.h"
 #include "vec/RSGISVectorUtils.h"
+#include "utils/RSGISOGRFeatureSink.h"
 
 
 // mark all exported classes/functions with DllExport to have
@@ -29,6 +29,7 @@ namespace rsgis{namespace vec{
 	{
 		this->variables = variables;
 		this->numVariables = numVariables;
+        this->mathsExpression = mathsExpression;
 		this->outHeading = outHeading;
 		
 		muParser = new mu::Parser();
@@ -38,12 +39,29 @@ namespace rsgis{namespace vec{
 			muParser->DefineVar(_T(variables[i]->name.c_str()), &inVals[i]);
 		}
 		muParser->SetExpr(mathsExpression.c_str());
+        this->bulkVarsDefined = false;
+        this->batchInDefn = NULL;
+        this->batchOutDefn = NULL;
+        this->batchOutFieldIdx = -1;
 	}
+    
+    void RSGISVectorMaths::defineScalarVars()
+    {
+        for(int i = 0; i < numVariables; ++i)
+        {
+            muParser->DefineVar(_T(variables[i]->name.c_str()), &inVals[i]);
+        }
+        this->bulkVarsDefined = false;
+    }
 	
 	void RSGISVectorMaths::processFeature(OGRFeature *inFeature, OGRFeature *outFeature, OGREnvelope *env, long fid)
 	{
 		try 
 		{
+            if(this->bulkVarsDefined)
+            {
+                this->defineScalarVars();
+            }
 			OGRFeatureDefn *inFeatureDefn = inFeature->GetDefnRef();
 			// Get variables
 			for(int i = 0; i < numVariables; ++i)
@@ -86,8 +104,100 @@ namespace rsgis{namespace vec{
 	}
 	
 	
+    int RSGISVectorMaths::getFieldIndex(OGRFeatureDefn *featDefn, std::string fieldName)
+    {
+        int fieldIdx = featDefn->GetFieldIndex(fieldName.c_str());
+        if(fieldIdx < 0)
+        {
+            std::string message = std::string("Could not find the field '") + fieldName + std::string("'.");
+            throw RSGISVectorException(message);
+        }
+        return fieldIdx;
+    }
+    
+    bool RSGISVectorMaths::processFeatureBatch(OGRFeature **inFeatures, OGRFeature **outFeatures, size_t nFeats)
+    {
+        if(nFeats == 0)
+        {
+            return true;
+        }
+        
+        try
+        {
+            // The field indexes only need to be found again if the layer definitions change.
+            OGRFeatureDefn *inFeatureDefn = inFeatures[0]->GetDefnRef();
+            if(inFeatureDefn != this->batchInDefn)
+            {
+                this->batchInFieldIdxs.resize(numVariables);
+                for(int i = 0; i < numVariables; ++i)
+                {
+                    this->batchInFieldIdxs[i] = this->getFieldIndex(inFeatureDefn, this->variables[i]->fieldName);
+                }
+                this->batchInDefn = inFeatureDefn;
+            }
+            OGRFeature **writeFeatures = (outFeatures != NULL)?outFeatures:inFeatures;
+            OGRFeatureDefn *outFeatureDefn = writeFeatures[0]->GetDefnRef();
+            if(outFeatureDefn != this->batchOutDefn)
+            {
+                this->batchOutFieldIdx = this->getFieldIndex(outFeatureDefn, this->outHeading);
+                this->batchOutDefn = outFeatureDefn;
+            }
+            
+            // The variables are bound to the arrays, so they only need to be
+            // redefined if the arrays have been reallocated.
+            if((!this->bulkVarsDefined) || (this->bulkResults.size() < nFeats))
+            {
+                this->bulkVals.resize(numVariables);
+                for(int i = 0; i < numVariables; ++i)
+                {
+                    if(this->bulkVals[i].size() < nFeats)
+                    {
+                        this->bulkVals[i].resize(nFeats);
+                    }
+                    muParser->DefineVar(_T(variables[i]->name.c_str()), this->bulkVals[i].data());
+                }
+                if(this->bulkResults.size() < nFeats)
+                {
+                    this->bulkResults.resize(nFeats);
+                }
+                this->bulkVarsDefined = true;
+            }
+            
+            for(int i = 0; i < numVariables; ++i)
+            {
+                int fieldIdx = this->batchInFieldIdxs[i];
+                mu::value_type *vals = this->bulkVals[i].data();
+                for(size_t f = 0; f < nFeats; ++f)
+                {
+                    vals[f] = inFeatures[f]->GetFieldAsDouble(fieldIdx);
+                }
+            }
+            
+            muParser->Eval(this->bulkResults.data(), (int)nFeats);
+            
+            const mu::value_type *results = this->bulkResults.data();
+            for(size_t f = 0; f < nFeats; ++f)
+            {
+                writeFeatures[f]->SetField(this->batchOutFieldIdx, results[f]);
+            }
+        }
+        catch (mu::ParserError &e)
+        {
+            std::string message = std::string("ERROR: ") + std::string(e.GetMsg()) + std::string(":\t \'") + std::string(e.GetExpr()) +std::string("\'");
+            throw RSGISVectorException(message);
+        }
+        return true;
+    }
+    
+    RSGISProcessOGRFeature* RSGISVectorMaths::clone()
+    {
+        // Each copy has its own parser and variables so it can be evaluated on another thread.
+        return new RSGISVectorMaths(this->variables, this->numVariables, this->mathsExpression, this->outHeading);
+    }
+	
 	RSGISVectorMaths::~RSGISVectorMaths()
 	{
-		
+		delete muParser;
+        delete[] inVals;
 	}
 }}
@@ -26,6 +26,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "vec/RSGISProcessOGRFeature.h"
 #include "muParser.h"
@@ -58,13 +59,32 @@ namespace rsgis{namespace vec{
 		virtual void processFeature(OGRFeature *inFeature, OGRFeature *outFeature, OGREnvelope *env, long fid);
 		virtual void processFeature(OGRFeature *feature, OGREnvelope *env, long fid){throw RSGISVectorException("Not Implemented");};
 		virtual void createOutputLayerDefinition(OGRLayer *outputLayer, OGRFeatureDefn *inFeatureDefn);
+        virtual RSGISProcessOGRFeature* clone();
+        /**
+         * Columnar evaluation of a batch of features: the fields (looked up by index,
+         * once for each layer definition) are read into an array for each variable
+         * and the expression is evaluated for the whole batch using the muParser
+         * bulk mode, rather than calling Eval() for each feature.
+         */
+        virtual bool processFeatureBatch(OGRFeature **inFeatures, OGRFeature **outFeatures, size_t nFeats);
+        virtual bool supportsFeatureBatches(){return true;};
 		~RSGISVectorMaths();
 	private:
+        void defineScalarVars();
+        int getFieldIndex(OGRFeatureDefn *featDefn, std::string fieldName);
 		VariableFields **variables;
 		int numVariables;
         mu::Parser *muParser;
         mu::value_type *inVals;
+        std::string mathsExpression;
         std::string outHeading;
+        bool bulkVarsDefined;
+        std::vector<std::vector<mu::value_type> > bulkVals;
+        std::vector<mu::value_type> bulkResults;
+        OGRFeatureDefn *batchInDefn;
+        OGRFeatureDefn *batchOutDefn;
+        std::vector<int> batchInFieldIdxs;
+        int batchOutFieldIdx;
 	};
 }}
 
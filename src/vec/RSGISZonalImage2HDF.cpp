@@ -34,6 +34,19 @@ namespace rsgis{namespace vec{
     {
         try
         {
+            if(pixelPolyOption == rsgis::img::polyContainsPixelCenter)
+            {
+                double *geoTransform = new double[6];
+                dataset->GetGeoTransform(geoTransform);
+                bool rotated = (geoTransform[2] != 0) || (geoTransform[4] != 0);
+                delete[] geoTransform;
+                if(!rotated)
+                {
+                    this->extractBandsToColumnsRasterised(dataset, vecLayer, outputFile);
+                    return;
+                }
+            }
+            
             unsigned int numImageBands = dataset->GetRasterCount();
             
             std::vector<float*> *pxlVals = new std::vector<float*>();
@@ -110,6 +123,134 @@ namespace rsgis{namespace vec{
         }
     }
 		
+    void RSGISZonalImage2HDF::extractBandsToColumnsRasterised(GDALDataset *dataset, OGRLayer *vecLayer, std::string outputFile)
+    {
+        try
+        {
+            unsigned int numImageBands = dataset->GetRasterCount();
+            unsigned int xSize = dataset->GetRasterXSize();
+            unsigned int ySize = dataset->GetRasterYSize();
+            double *geoTransform = new double[6];
+            dataset->GetGeoTransform(geoTransform);
+            RSGISPolygonScanlineRasteriser rasteriser(geoTransform, xSize, ySize);
+            delete[] geoTransform;
+            
+            std::cout << "Rasterising the polygons\n";
+            OGRGeometry *geometry = NULL;
+            OGRFeature *inFeature = NULL;
+            vecLayer->ResetReading();
+            while( (inFeature = vecLayer->GetNextFeature()) != NULL )
+            {
+                geometry = inFeature->GetGeometryRef();
+                if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPolygon )
+                {
+                    rasteriser.addPolygon((OGRPolygon *) geometry);
+                }
+                else
+                {
+                    std::cout << "WARNING: NULL Geometry Present within input file - IGNORED\n";
+                }
+                OGRFeature::DestroyFeature(inFeature);
+            }
+            rasteriser.finalise();
+            
+            // The pixels are stored feature by feature, as they were added.
+            unsigned int numFeats = rasteriser.getNumFeatures();
+            std::vector<size_t> featNextPxl(numFeats, 0);
+            size_t pxlCount = 0;
+            for(unsigned int i = 0; i < numFeats; ++i)
+            {
+                featNextPxl[i] = pxlCount;
+                pxlCount += rasteriser.getNumFeaturePxls(i);
+            }
+            std::vector<float> pxlVals(rasteriser.getTotalNumPxls() * numImageBands);
+            
+            std::vector<GDALRasterBand*> bands;
+            for(unsigned int n = 0; n < numImageBands; ++n)
+            {
+                bands.push_back(dataset->GetRasterBand(n+1));
+            }
+            
+            unsigned int stripRows = 1;
+            if(numImageBands > 0)
+            {
+                int xBlockSize = 0;
+                int yBlockSize = 0;
+                bands[0]->GetBlockSize(&xBlockSize, &yBlockSize);
+                stripRows = std::max(yBlockSize, 1);
+                size_t nBlockRows = maxStripVals / (((size_t)stripRows) * xSize * numImageBands);
+                if(nBlockRows > 1)
+                {
+                    stripRows = stripRows * nBlockRows;
+                }
+            }
+            
+            std::cout << "Extracting the pixel values\n";
+            rsgis_tqdm pbar;
+            std::vector<float> stripVals;
+            unsigned int xMin = 0;
+            unsigned int xMax = 0;
+            for(unsigned int rowStart = 0; (numImageBands > 0) && (rowStart < ySize); rowStart += stripRows)
+            {
+                pbar.progress((int)((((size_t)rowStart) * 100) / ySize), 100);
+                unsigned int rowEnd = std::min(rowStart + stripRows, ySize);
+                if(!rasteriser.getSpansXRange(rowStart, rowEnd, &xMin, &xMax))
+                {
+                    // No polygons within the strip so there is no need to read it.
+                    continue;
+                }
+                
+                size_t stripWidth = xMax - xMin;
+                size_t nStripRows = rowEnd - rowStart;
+                size_t bandVals = stripWidth * nStripRows;
+                if(stripVals.size() < (bandVals * numImageBands))
+                {
+                    stripVals.resize(bandVals * numImageBands);
+                }
+                for(unsigned int n = 0; n < numImageBands; ++n)
+                {
+                    if(bands[n]->RasterIO(GF_Read, xMin, rowStart, stripWidth, nStripRows, &stripVals[n*bandVals], stripWidth, nStripRows, GDT_Float32, 0, 0) != CE_None)
+                    {
+                        throw RSGISException("Could not read the image data.");
+                    }
+                }
+                
+                for(unsigned int row = rowStart; row < rowEnd; ++row)
+                {
+                    size_t nSpans = 0;
+                    const RSGISPixelSpan *spans = rasteriser.getRowSpans(row, &nSpans);
+                    size_t rowOff = (row - rowStart) * stripWidth;
+                    for(size_t s = 0; s < nSpans; ++s)
+                    {
+                        float *outVals = &pxlVals[featNextPxl[spans[s].featIdx] * numImageBands];
+                        for(unsigned int x = spans[s].xStart; x < spans[s].xEnd; ++x)
+                        {
+                            size_t idx = rowOff + (x - xMin);
+                            for(unsigned int n = 0; n < numImageBands; ++n)
+                            {
+                                *(outVals++) = stripVals[(n*bandVals) + idx];
+                            }
+                        }
+                        featNextPxl[spans[s].featIdx] += spans[s].xEnd - spans[s].xStart;
+                    }
+                }
+            }
+            pbar.finish();
+            
+            rsgis::utils::RSGISExportColumnData2HDF exportCols2HDF;
+            exportCols2HDF.createFile(outputFile, numImageBands, std::string("Pixels Extracted from ")+std::string(dataset->GetFileList()[0]), H5::PredType::IEEE_F32LE);
+            for(size_t j = 0; j < rasteriser.getTotalNumPxls(); ++j)
+            {
+                exportCols2HDF.addDataRow(&pxlVals[j * numImageBands], H5::PredType::NATIVE_FLOAT);
+            }
+            exportCols2HDF.close();
+        }
+        catch(RSGISException &e)
+        {
+            throw RSGISVectorZonalException(e.what());
+        }
+    }
+		
     RSGISZonalImage2HDF::~RSGISZonalImage2HDF()
     {
         
@@ -28,12 +28,15 @@
 #include <iostream>
 #include <string>
 #include <cmath>
+#include <vector>
+#include <algorithm>
 
 #include "gdal_priv.h"
 #include "ogrsf_frmts.h"
 
 #include "vec/RSGISVectorZonalException.h"
 #include "vec/RSGISVectorUtils.h"
+#include "vec/RSGISPolygonScanlineRasteriser.h"
 //#include "vec/RSGISVectorIO.h"
 
 //#include "vec/RSGISProcessOGRFeature.h"
@@ -46,6 +49,8 @@
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISPixelInPoly.h"
 
+#include "common/rsgis-tqdm.h"
+
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
 #undef DllExport
@@ -65,8 +70,22 @@ namespace rsgis{namespace vec{
 	{
 	public:
 		RSGISZonalImage2HDF();
+        /**
+         * Extract the pixel values within each polygon to the output HDF5 file, feature
+         * by feature. Where the pixel centre is used to select the pixels (and the image
+         * is not rotated) the polygons are rasterised once and the image is read once
+         * (see extractBandsToColumnsRasterised), otherwise each polygon is tested separately.
+         */
 		void extractBandsToColumns(GDALDataset *dataset, OGRLayer *vecLayer, std::string outputFile, rsgis::img::pixelInPolyOption pixelPolyOption);
+        /**
+         * Burn all the polygons on to the image grid with scanline polygon filling (pixel
+         * centre in polygon) and extract the pixel values of every feature in a single
+         * pass over the image, in strips, skipping strips which contain no polygons.
+         */
+        void extractBandsToColumnsRasterised(GDALDataset *dataset, OGRLayer *vecLayer, std::string outputFile);
 		~RSGISZonalImage2HDF();
+    protected:
+        static const size_t maxStripVals = 8388608;
 	};
     
     
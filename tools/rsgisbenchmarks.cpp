@@ -0,0 +1,385 @@
+/*
+ *  rsgisbenchmarks.cpp
+ *  RSGIS_LIB
+ *
+ *  Created by Pete Bunting on 14/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Throughput benchmarks of the core processing kernels on synthetic rasters
+ *  held in memory (/vsimem/), so the results are not dominated by the disk.
+ *  Built when cmake is run with -DRSGIS_BENCHMARKS=ON.
+ *
+ *  Usage: rsgis_benchmarks [--size pxls] [--repeats n] [--threads n] [--bench name] [--simd name]
+ *
+ *  Each benchmark is run repeats times and the fastest run is reported in
+ *  mega-pixels (of the size x size raster) per second.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <functional>
+#include <cstdlib>
+#include <algorithm>
+
+#include "gdal_priv.h"
+#include "ogr_spatialref.h"
+#include "cpl_vsi.h"
+
+#include "cmds/RSGISCmdException.h"
+#include "cmds/RSGISCmdImageCalc.h"
+#include "cmds/RSGISCmdFilterImages.h"
+#include "cmds/RSGISCmdImageMorphology.h"
+#include "cmds/RSGISCmdSegmentation.h"
+#include "cmds/RSGISCmdRasterGIS.h"
+#include "cmds/RSGISCmdImageUtils.h"
+#include "cmds/RSGISCmdElevationTools.h"
+
+#include "common/RSGISSIMDKernels.h"
+#include "common/RSGISGDALInit.h"
+
+struct RSGISBenchmark
+{
+    std::string name;
+    std::function<void()> run;
+};
+
+static const std::string benchDir = "/vsimem/rsgis_benchmarks/";
+
+// Create a synthetic image with the value of each pixel from pxlVal(x, y, band).
+static void createSyntheticImage(std::string fileName, unsigned int xSize, unsigned int ySize, unsigned int numBands, GDALDataType dataType, double tlX, double tlY, std::function<double(unsigned int, unsigned int, unsigned int)> pxlVal)
+{
+    GDALDriver *driver = GetGDALDriverManager()->GetDriverByName("GTiff");
+    if(driver == NULL)
+    {
+        throw rsgis::cmds::RSGISCmdException("The GTiff GDAL driver is not available.");
+    }
+    GDALDataset *dataset = driver->Create(fileName.c_str(), xSize, ySize, numBands, dataType, NULL);
+    if(dataset == NULL)
+    {
+        throw rsgis::cmds::RSGISCmdException("Could not create the image " + fileName);
+    }
+    double trans[6] = {tlX, 10.0, 0.0, tlY, 0.0, -10.0};
+    dataset->SetGeoTransform(trans);
+    OGRSpatialReference spatRef;
+    spatRef.importFromEPSG(32630);
+    char *wkt = NULL;
+    spatRef.exportToWkt(&wkt);
+    dataset->SetProjection(wkt);
+    CPLFree(wkt);
+
+    std::vector<double> row(xSize);
+    for(unsigned int b = 0; b < numBands; ++b)
+    {
+        GDALRasterBand *band = dataset->GetRasterBand(b+1);
+        for(unsigned int y = 0; y < ySize; ++y)
+        {
+            for(unsigned int x = 0; x < xSize; ++x)
+            {
+                row[x] = pxlVal(x, y, b);
+            }
+            if(band->RasterIO(GF_Write, 0, y, xSize, 1, row.data(), xSize, 1, GDT_Float64, 0, 0) != CE_None)
+            {
+                GDALClose(dataset);
+                throw rsgis::cmds::RSGISCmdException("Could not write the image " + fileName);
+            }
+        }
+    }
+    GDALClose(dataset);
+}
+
+static void printUsage()
+{
+    std::cout << "Usage: rsgis_benchmarks [--size pxls] [--repeats n] [--threads n] [--bench name] [--simd name]\n";
+    std::cout << "  --size     the width and height of the synthetic rasters (Default: 2048)\n";
+    std::cout << "  --repeats  the number of times each benchmark is run (Default: 3)\n";
+    std::cout << "  --threads  the number of threads used where supported (Default: 1)\n";
+    std::cout << "  --bench    only run the benchmark with this name (Default: all)\n";
+    std::cout << "  --simd     the instruction set of the kernels: scalar, avx2 or avx512 (Default: the widest supported)\n";
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int size = 2048;
+    unsigned int repeats = 3;
+    unsigned int numThreads = 1;
+    std::string benchName = "";
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if((arg == "--help") || (arg == "-h"))
+        {
+            printUsage();
+            return 0;
+        }
+        else if(((arg == "--size") || (arg == "--repeats") || (arg == "--threads") || (arg == "--bench") || (arg == "--simd")) && ((i+1) < argc))
+        {
+            std::string val = argv[++i];
+            if(arg == "--size")
+            {
+                size = std::atoi(val.c_str());
+            }
+            else if(arg == "--repeats")
+            {
+                repeats = std::atoi(val.c_str());
+            }
+            else if(arg == "--threads")
+            {
+                numThreads = std::atoi(val.c_str());
+            }
+            else if(arg == "--simd")
+            {
+                if(val == "scalar")
+                {
+                    rsgis::RSGISSIMDKernels::setLevel(rsgis::rsgis_simd_scalar);
+                }
+                else if(val == "avx2")
+                {
+                    rsgis::RSGISSIMDKernels::setLevel(rsgis::rsgis_simd_avx2);
+                }
+                else if(val == "avx512")
+                {
+                    rsgis::RSGISSIMDKernels::setLevel(rsgis::rsgis_simd_avx512);
+                }
+                else
+                {
+                    printUsage();
+                    return 1;
+                }
+            }
+            else
+            {
+                benchName = val;
+            }
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if((size < 16) || (repeats == 0))
+    {
+        std::cerr << "The size must be at least 16 and repeats at least 1." << std::endl;
+        return 1;
+    }
+
+    rsgis::RSGISGDALInit::init();
+
+    std::string floatImg = benchDir + "float_img.tif";
+    std::string catsImg = benchDir + "cats_img.tif";
+    std::string clumpsImg = benchDir + "clumps_img.tif";
+    std::string demImg = benchDir + "dem_img.tif";
+    std::string validImg = benchDir + "valid_img.tif";
+    std::string outImg = benchDir + "out_img.tif";
+    std::string outBase = benchDir + "out_img";
+    std::string mosaicTiles[4];
+
+    std::vector<RSGISBenchmark> benchmarks;
+    try
+    {
+        std::cout << "Creating the synthetic " << size << " x " << size << " rasters..." << std::endl;
+        double pi = 3.14159265358979;
+        // Three smoothly varying float bands with some high frequency texture.
+        createSyntheticImage(floatImg, size, size, 3, GDT_Float32, 0.0, size*10.0, [pi](unsigned int x, unsigned int y, unsigned int b)
+        {
+            return 100.0 + (50.0 * sin((x + (b * 37.0)) * pi / 64.0) * cos(y * pi / 48.0)) + ((x * 7 + y * 13 + b) % 11);
+        });
+        // Categories of irregular (i.e., non-rectangular) patches.
+        createSyntheticImage(catsImg, size, size, 1, GDT_UInt32, 0.0, size*10.0, [pi](unsigned int x, unsigned int y, unsigned int b)
+        {
+            return 1.0 + floor(2.5 + (2.5 * sin(x * pi / 23.0) * sin(y * pi / 17.0)));
+        });
+        // A DEM of ridges with many pits to be filled and a valid mask of the whole image.
+        createSyntheticImage(demImg, size, size, 1, GDT_Int32, 0.0, size*10.0, [pi](unsigned int x, unsigned int y, unsigned int b)
+        {
+            return floor(500.0 + (200.0 * sin(x * pi / 97.0) * sin(y * pi / 71.0)) + (10.0 * cos(x * pi / 5.0) * cos(y * pi / 7.0)));
+        });
+        createSyntheticImage(validImg, size, size, 1, GDT_Byte, 0.0, size*10.0, [](unsigned int x, unsigned int y, unsigned int b){return 1.0;});
+        // Four tiles (with a 16 pixel overlap) which mosaic to a size x size image.
+        unsigned int halfSize = size / 2;
+        for(unsigned int t = 0; t < 4; ++t)
+        {
+            mosaicTiles[t] = benchDir + "mosaic_tile_" + std::to_string(t) + ".tif";
+            unsigned int tX = (t % 2) * halfSize;
+            unsigned int tY = (t / 2) * halfSize;
+            unsigned int tWidth = std::min(halfSize + 16, size - tX);
+            unsigned int tHeight = std::min(halfSize + 16, size - tY);
+            createSyntheticImage(mosaicTiles[t], tWidth, tHeight, 3, GDT_Float32, tX*10.0, (size - tY)*10.0, [t](unsigned int x, unsigned int y, unsigned int b)
+            {
+                return (t * 100.0) + ((x + y + b) % 97);
+            });
+        }
+        rsgis::cmds::executeClump(catsImg, clumpsImg, "GTiff", true, false, 0, false, numThreads);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    benchmarks.push_back({"calcImage_bandmaths", [&]()
+    {
+        rsgis::cmds::VariableStruct vars[3];
+        std::string names[3] = {"b1", "b2", "b3"};
+        for(int i = 0; i < 3; ++i)
+        {
+            vars[i].image = floatImg;
+            vars[i].name = names[i];
+            vars[i].bandNum = i+1;
+        }
+        rsgis::cmds::executeBandMaths(vars, 3, outImg, "(b3-b2)/(b3+b2) + sqrt(b1)", "GTiff", rsgis::rsgis_32float, false);
+    }});
+
+    benchmarks.push_back({"calcImageWindowData_mean5x5", [&]()
+    {
+        rsgis::cmds::RSGISFilterParameters params;
+        params.type = "Mean";
+        params.fileEnding = "_mean";
+        params.option = "";
+        params.size = 5;
+        params.nLooks = 1;
+        params.stddev = 1;
+        params.stddevX = 1;
+        params.stddevY = 1;
+        params.angle = 0;
+        params.percentile = 50;
+        params.histMin = 0;
+        params.histMax = 0;
+        params.histBinWidth = 1;
+        std::vector<rsgis::cmds::RSGISFilterParameters*> filterParams;
+        filterParams.push_back(&params);
+        rsgis::cmds::executeFilter(floatImg, &filterParams, outBase, "GTiff", "tif", rsgis::rsgis_32float);
+    }});
+
+    benchmarks.push_back({"morphology_dilate3x3", [&]()
+    {
+        rsgis::cmds::executeImageDilate(floatImg, outImg, "", false, 3, "GTiff", rsgis::rsgis_32float);
+    }});
+
+    benchmarks.push_back({"morphology_erode3x3", [&]()
+    {
+        rsgis::cmds::executeImageErode(floatImg, outImg, "", false, 3, "GTiff", rsgis::rsgis_32float);
+    }});
+
+    benchmarks.push_back({"clump", [&]()
+    {
+        rsgis::cmds::executeClump(catsImg, outImg, "GTiff", false, false, 0, false, numThreads);
+    }});
+
+    benchmarks.push_back({"pop_rat_stats", [&]()
+    {
+        std::vector<rsgis::cmds::RSGISBandAttStatsCmds*> bandStats;
+        for(unsigned int b = 1; b <= 3; ++b)
+        {
+            rsgis::cmds::RSGISBandAttStatsCmds *stats = new rsgis::cmds::RSGISBandAttStatsCmds();
+            stats->band = b;
+            stats->calcMin = true;
+            stats->minField = "b" + std::to_string(b) + "Min";
+            stats->calcMax = true;
+            stats->maxField = "b" + std::to_string(b) + "Max";
+            stats->calcMean = true;
+            stats->meanField = "b" + std::to_string(b) + "Mean";
+            stats->calcStdDev = true;
+            stats->stdDevField = "b" + std::to_string(b) + "StdDev";
+            stats->calcSum = false;
+            stats->calcCount = false;
+            stats->calcMode = false;
+            stats->histMin = 0;
+            stats->histMax = 0;
+            bandStats.push_back(stats);
+        }
+        try
+        {
+            rsgis::cmds::executePopulateRATWithStatsSinglePass(floatImg, clumpsImg, &bandStats, 1, numThreads);
+        }
+        catch(rsgis::cmds::RSGISCmdException &e)
+        {
+            for(auto stats : bandStats)
+            {
+                delete stats;
+            }
+            throw e;
+        }
+        for(auto stats : bandStats)
+        {
+            delete stats;
+        }
+    }});
+
+    benchmarks.push_back({"mosaic", [&]()
+    {
+        rsgis::cmds::executeImageMosaic(mosaicTiles, 4, outImg, 0, -1, 0, 0, "GTiff", rsgis::rsgis_32float, numThreads);
+    }});
+
+    benchmarks.push_back({"dem_fill_priority_flood", [&]()
+    {
+        rsgis::cmds::executeDEMFillPriorityFlood(demImg, validImg, outImg, "GTiff");
+    }});
+
+    double mPxls = (((double)size) * ((double)size)) / 1e6;
+    std::vector<std::pair<std::string, double> > results;
+    int rtnVal = 0;
+    for(auto &bench : benchmarks)
+    {
+        if((benchName != "") && (bench.name != benchName))
+        {
+            continue;
+        }
+        double bestTime = -1;
+        try
+        {
+            for(unsigned int r = 0; r < repeats; ++r)
+            {
+                auto startTime = std::chrono::steady_clock::now();
+                bench.run();
+                double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+                if((bestTime < 0) || (time < bestTime))
+                {
+                    bestTime = time;
+                }
+            }
+            results.push_back(std::pair<std::string, double>(bench.name, bestTime));
+        }
+        catch(rsgis::cmds::RSGISCmdException &e)
+        {
+            std::cerr << "Error: " << bench.name << " failed: " << e.what() << std::endl;
+            rtnVal = 1;
+        }
+    }
+
+    std::cout << "\nBenchmark (" << size << " x " << size << " pxls, " << numThreads << " threads, " << rsgis::RSGISSIMDKernels::getLevelName(rsgis::RSGISSIMDKernels::getLevel()) << " kernels, best of " << repeats << ")\n";
+    std::cout << std::left << std::setw(32) << "name" << std::right << std::setw(12) << "time (s)" << std::setw(12) << "Mpx/s" << "\n";
+    for(auto &result : results)
+    {
+        std::cout << std::left << std::setw(32) << result.first << std::right << std::setw(12) << std::fixed << std::setprecision(4) << result.second << std::setw(12) << std::setprecision(2) << (mPxls / result.second) << "\n";
+    }
+    std::cout << std::flush;
+
+    char **files = VSIReadDir(benchDir.c_str());
+    if(files != NULL)
+    {
+        for(int i = 0; files[i] != NULL; ++i)
+        {
+            VSIUnlink((benchDir + files[i]).c_str());
+        }
+        CSLDestroy(files);
+    }
+    return rtnVal;
+}